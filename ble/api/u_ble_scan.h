@@ -0,0 +1,210 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_BLE_SCAN_H_
+#define _U_BLE_SCAN_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_device.h"
+
+/** \addtogroup _BLE
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the APIs that scan for BLE
+ * advertisers, e.g. beacons.  Rather than each advertising report
+ * being passed up to the application individually, reports are
+ * filtered as close to the radio as possible, duplicates from the
+ * same advertiser are merged, and the survivors are handed to the
+ * application in batches at an interval of its choosing.
+ *
+ * With a u-blox module the scan is performed in periods of the
+ * batch interval using AT+UBTD, the module itself filtering
+ * duplicates; note that the AT interface to the module is occupied
+ * for the whole of each period, so other BLE/Wi-Fi AT commands will
+ * wait until it ends.  Where BLE is internal to this MCU (e.g. NRF5x
+ * under Zephyr) the controller filters duplicates and the RSSI, UUID
+ * and manufacturer filters are applied in the porting layer, as the
+ * reports arrive from the BLE stack.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The size of a BLE address as a string, e.g. "0012F398DD12p",
+ * including the terminator.
+ */
+#define U_BLE_SCAN_ADDRESS_STRING_LENGTH_BYTES 14
+
+/** The maximum amount of advertising data in a scan result.
+ */
+#define U_BLE_SCAN_DATA_MAX_LENGTH_BYTES 31
+
+#ifndef U_BLE_SCAN_BATCH_MAX_NUM_RESULTS
+/** The maximum number of results in a batch; if more distinct
+ * advertisers than this are seen in one batch interval, reports from
+ * the extra ones are dropped until the batch has been delivered.
+ * Each result costs sizeof(uBleScanResult_t) of heap while scanning.
+ */
+# define U_BLE_SCAN_BATCH_MAX_NUM_RESULTS 32
+#endif
+
+#ifndef U_BLE_SCAN_TASK_STACK_SIZE_BYTES
+/** The stack size of the task that delivers batches of results
+ * (and, with a u-blox module, performs the scans).
+ */
+# define U_BLE_SCAN_TASK_STACK_SIZE_BYTES 2048
+#endif
+
+#ifndef U_BLE_SCAN_TASK_PRIORITY
+/** The priority of the task that delivers batches of results
+ * (and, with a u-blox module, performs the scans).
+ */
+# define U_BLE_SCAN_TASK_PRIORITY (U_CFG_OS_PRIORITY_MIN + 5)
+#endif
+
+/** The value of #uBleScanParams_t rssiMinDbm for no RSSI filter.
+ */
+#define U_BLE_SCAN_RSSI_NO_FILTER -128
+
+/** Default values for #uBleScanParams_t.
+ */
+#define U_BLE_SCAN_PARAMS_DEFAULT {true, /* activeScan */           \
+                                   true, /* filterDuplicates */     \
+                                   U_BLE_SCAN_RSSI_NO_FILTER,       \
+                                   0,    /* uuid16: any */          \
+                                   -1,   /* manufacturerId: any */  \
+                                   1000  /* batchIntervalMs */}
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The parameters of a scan.
+ */
+typedef struct {
+    bool activeScan;         /**< true to request scan responses,
+                                  false for a passive scan. */
+    bool filterDuplicates;   /**< true to have the BLE controller drop
+                                  repeated reports from the same
+                                  advertiser; whatever this is set to,
+                                  reports from the same advertiser
+                                  within a batch are merged into a
+                                  single result carrying the latest
+                                  RSSI and data. */
+    int32_t rssiMinDbm;      /**< reports weaker than this are dropped;
+                                  #U_BLE_SCAN_RSSI_NO_FILTER for no
+                                  filter. */
+    uint16_t uuid16;         /**< if non-zero, only reports advertising
+                                  this 16-bit service UUID (in a
+                                  complete or incomplete list of 16-bit
+                                  service UUIDs, or as service data) are
+                                  kept. */
+    int32_t manufacturerId;  /**< if not negative, only reports carrying
+                                  manufacturer-specific data with this
+                                  company identifier (e.g. 0x004C) are
+                                  kept. */
+    int32_t batchIntervalMs; /**< the interval at which batches are
+                                  delivered; with a u-blox module this
+                                  must be between 10 and 40000. */
+} uBleScanParams_t;
+
+/** A scan result.
+ */
+typedef struct {
+    char address[U_BLE_SCAN_ADDRESS_STRING_LENGTH_BYTES]; /**< the address
+                                                               of the advertiser,
+                                                               e.g. "0012F398DD12p". */
+    int32_t rssiDbm;         /**< the RSSI of the latest report. */
+    uint8_t data[U_BLE_SCAN_DATA_MAX_LENGTH_BYTES]; /**< the advertising data
+                                                         (or scan response data)
+                                                         of the latest report,
+                                                         raw AD structures. */
+    size_t dataLength;       /**< the number of bytes at data. */
+    bool isScanResponse;     /**< true if data is from a scan response. */
+    uint32_t numReports;     /**< the number of reports merged into this
+                                  result. */
+} uBleScanResult_t;
+
+/** Callback that receives a batch of scan results; it is called
+ * from a task of the scanner, not while anything is locked, and
+ * may call uBleScanStop() (which will then return with the scan
+ * stopped once the callback has returned).
+ *
+ * @param devHandle       the handle of the BLE instance.
+ * @param[in] pResults    the results; valid only for the duration
+ *                        of the callback.
+ * @param numResults      the number of results at pResults, never
+ *                        zero.
+ * @param[in] pParameter  the pParameter given to uBleScanStart().
+ */
+typedef void (*uBleScanCallback_t)(uDeviceHandle_t devHandle,
+                                   const uBleScanResult_t *pResults,
+                                   size_t numResults,
+                                   void *pParameter);
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Start scanning; scanning continues until uBleScanStop() is
+ * called.  Only one scan may be in progress at a time.  BLE must
+ * have been configured as central, see uBleCfgConfigure().
+ *
+ * @param devHandle       the handle of the BLE instance.
+ * @param[in] pParams     the scan parameters; if NULL
+ *                        #U_BLE_SCAN_PARAMS_DEFAULT will be used.
+ * @param[in] pCallback   the callback to receive batches of results,
+ *                        cannot be NULL.
+ * @param[in] pParameter  a parameter that will be passed to pCallback.
+ * @return                zero on success or negative error code;
+ *                        #U_ERROR_COMMON_NO_MEMORY if a scan is
+ *                        already in progress.
+ */
+int32_t uBleScanStart(uDeviceHandle_t devHandle,
+                      const uBleScanParams_t *pParams,
+                      uBleScanCallback_t pCallback,
+                      void *pParameter);
+
+/** Stop scanning: any results collected so far are delivered and,
+ * once this function has returned, the callback will not be called
+ * again.  With a u-blox module this may take up to the batch
+ * interval, as the current scan period is allowed to finish.
+ *
+ * @param devHandle  the handle of the BLE instance.
+ * @return           zero on success or negative error code.
+ */
+int32_t uBleScanStop(uDeviceHandle_t devHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_BLE_SCAN_H_
+
+// End of file
@@ -53,6 +53,44 @@ extern "C" {
 #define U_BLE_SPS_BUFFER_SIZE 1024
 #endif
 
+#ifndef U_BLE_SPS_RX_CREDITS_WATERMARK
+/** With flow control enabled, the minimum number of receive credits
+ *  that will be sent to the remote device in one credit update, unless
+ *  the remote device has run out of credits entirely, in which case
+ *  whatever credits are available are sent at once; increase this to
+ *  batch credit updates.  Note that the number of credits available
+ *  is at most #U_BLE_SPS_BUFFER_SIZE divided by the size of a packet.
+ *  Only used by the internal-module implementation.
+ */
+#define U_BLE_SPS_RX_CREDITS_WATERMARK 1
+#endif
+
+/** Size of the transmit queue of a connected data channel, used by
+ *  uBleSpsSendQueued(); it is allocated on the first call for that
+ *  channel.  Only used by the internal-module implementation.
+ */
+#ifndef U_BLE_SPS_TX_QUEUE_SIZE
+#define U_BLE_SPS_TX_QUEUE_SIZE 1024
+#endif
+
+/** The highest priority that may be given to a channel with
+ *  uBleSpsSetSendPriority().
+ */
+#ifndef U_BLE_SPS_TX_PRIORITY_MAX
+#define U_BLE_SPS_TX_PRIORITY_MAX 8
+#endif
+
+/** The number of remote SPS servers for which the discovered
+ *  server handles are remembered, so that uBleSpsConnectSps() can
+ *  skip service discovery when connecting to the same server again;
+ *  the least recently used entry is replaced when the cache is full.
+ *  Set to 0 to disable the cache.  Only used by the internal-module
+ *  implementation.
+ */
+#ifndef U_BLE_SPS_SERVER_HANDLES_CACHE_SIZE
+#define U_BLE_SPS_SERVER_HANDLES_CACHE_SIZE 4
+#endif
+
 /** Maximum number of simultaneous connections,
  *  server and client combined
  */
@@ -130,6 +168,27 @@ typedef struct {
     uint16_t     creditsCcc;
 } uBleSpsHandles_t;
 
+/** The negotiated parameters of an SPS connection's link,
+ *  see uBleSpsGetLinkInfo().
+ *
+ *  @param mtu          the ATT MTU; each packet carries up to this
+ *                      minus three bytes of data.
+ *  @param txPhy        the transmit PHY: 1 for 1M, 2 for 2M, 4 for coded,
+ *                      0 if not known.
+ *  @param rxPhy        the receive PHY, coded as txPhy.
+ *  @param txDataLength the maximum link-layer payload that is transmitted
+ *                      in bytes, 0 if not known.
+ *  @param rxDataLength the maximum link-layer payload that is received
+ *                      in bytes, 0 if not known.
+ */
+typedef struct {
+    int32_t mtu;
+    int32_t txPhy;
+    int32_t rxPhy;
+    int32_t txDataLength;
+    int32_t rxDataLength;
+} uBleSpsLinkInfo_t;
+
 /** Connection parameters.
  *
  *  @param scanInterval        scan interval (N*0.625 ms).
@@ -228,7 +287,9 @@ int32_t uBleSpsConnectSps(uDeviceHandle_t devHandle,
  */
 int32_t uBleSpsDisconnect(uDeviceHandle_t devHandle, int32_t connHandle);
 
-/**
+/** Receive data on a channel.  For an internal module (e.g. NINA-B4
+ * running ubxlib), a given channel must only be read from one task
+ * at a time, since the receive buffer is lock-free.
  *
  * @param devHandle  the handle of the u-blox device.
  * @param channel    channel to receive on, given in connection callback.
@@ -267,6 +328,54 @@ int32_t uBleSpsSend(uDeviceHandle_t devHandle, int32_t channel, const char *pDat
  */
 int32_t uBleSpsSetSendTimeout(uDeviceHandle_t devHandle, int32_t channel, uint32_t timeout);
 
+/** Queue data for sending without blocking.  The data is copied into
+ * the transmit queue of the channel, of size #U_BLE_SPS_TX_QUEUE_SIZE,
+ * and sent by a transmit task that goes round all of the channels with
+ * queued data in turn, each channel sending as many packets per turn
+ * as its priority (see uBleSpsSetSendPriority()) and, if flow control
+ * is enabled, as it has credits for; this way no channel can starve
+ * another.  Any data still queued when a channel is disconnected is
+ * lost.  Do not mix calls to this function and uBleSpsSend() on the
+ * same channel.  Only supported for an internal module (e.g. NINA-B4
+ * running ubxlib).
+ *
+ * @param devHandle the handle of the u-blox device.
+ * @param channel   the channel to send on.
+ * @param[in] pData pointer to the data, must not be NULL.
+ * @param length    length of data to send.
+ * @return          the number of bytes queued, which will be less than
+ *                  length if there is not room for all of it, else
+ *                  negative error code.
+ */
+int32_t uBleSpsSendQueued(uDeviceHandle_t devHandle, int32_t channel,
+                          const char *pData, int32_t length);
+
+/** Get the number of bytes that uBleSpsSendQueued() has queued on a
+ * channel and which have not yet been sent.  Only supported for an
+ * internal module.
+ *
+ * @param devHandle the handle of the u-blox device.
+ * @param channel   the channel.
+ * @return          the number of bytes waiting to be sent, else
+ *                  negative error code.
+ */
+int32_t uBleSpsSendQueuedSize(uDeviceHandle_t devHandle, int32_t channel);
+
+/** Set the transmit priority of a channel for uBleSpsSendQueued():
+ * the number of packets the channel may send each time the transmit
+ * task comes round to it.  Only supported for an internal module.
+ *
+ * @note this setting is per channel and thus has to be set after
+ * connecting; the default is 1.
+ *
+ * @param devHandle the handle of the u-blox device.
+ * @param channel   the channel.
+ * @param priority  the priority, 1 to #U_BLE_SPS_TX_PRIORITY_MAX.
+ * @return          zero on success, on failure negative error code.
+ */
+int32_t uBleSpsSetSendPriority(uDeviceHandle_t devHandle, int32_t channel,
+                               int32_t priority);
+
 /** Get server handles for channel connection
  *
  * By reading the server handles for a connection
@@ -288,6 +397,24 @@ int32_t uBleSpsSetSendTimeout(uDeviceHandle_t devHandle, int32_t channel, uint32
 int32_t uBleSpsGetSpsServerHandles(uDeviceHandle_t devHandle, int32_t channel,
                                    uBleSpsHandles_t *pHandles);
 
+/** Get the negotiated link parameters of an SPS connection.
+ *
+ * When the SPS connection is made, in either role, the 2M PHY
+ * and the maximum link-layer data length are requested and, as
+ * client, the largest MTU that the Bluetooth stack is configured
+ * for; the remote device may decline any of these.  Only
+ * supported for an internal module (e.g. NINA-B4 running ubxlib).
+ *
+ * @param devHandle      the handle of the u-blox device.
+ * @param channel        the channel of the SPS connection.
+ * @param[out] pLinkInfo a place to put the link parameters, cannot
+ *                       be NULL.
+ *
+ * @return               zero on success, on failure negative error code.
+ */
+int32_t uBleSpsGetLinkInfo(uDeviceHandle_t devHandle, int32_t channel,
+                           uBleSpsLinkInfo_t *pLinkInfo);
+
 /** Preset server handles before conneting
  *
  * By reading the server handles for a connection
@@ -300,6 +427,13 @@ int32_t uBleSpsGetSpsServerHandles(uDeviceHandle_t devHandle, int32_t channel,
  * If connecting side is peripheral it is up to the central device
  * to cache server handles.
  *
+ * @note For an internal module (e.g. NINA-B4 running ubxlib) the
+ * handles of the last #U_BLE_SPS_SERVER_HANDLES_CACHE_SIZE servers
+ * connected to are in any case cached automatically, keyed by
+ * address, and used when no handles have been preset; an entry is
+ * dropped if connecting with it fails, in which case the next
+ * connection to that server will perform discovery again.
+ *
  * @param devHandle    the handle of the u-blox device.
  * @param[in] pHandles pointer to struct with handles.
  *
@@ -307,6 +441,18 @@ int32_t uBleSpsGetSpsServerHandles(uDeviceHandle_t devHandle, int32_t channel,
  */
 int32_t uBleSpsPresetSpsServerHandles(uDeviceHandle_t devHandle, const uBleSpsHandles_t *pHandles);
 
+/** Empty the cache of server handles, see
+ * #U_BLE_SPS_SERVER_HANDLES_CACHE_SIZE; this should be called if
+ * the GATT database of a remote SPS server may have changed, e.g.
+ * after a firmware update of the remote device.  Only supported
+ * for an internal module (e.g. NINA-B4 running ubxlib).
+ *
+ * @param devHandle the handle of the u-blox device.
+ *
+ * @return          zero on success, on failure negative error code.
+ */
+int32_t uBleSpsFlushServerHandlesCache(uDeviceHandle_t devHandle);
+
 /** Disable flow control for next SPS connection
  *
  * Flow control is enabled by default. Flow control cannot be altered for
@@ -29,6 +29,7 @@
 #endif
 
 #include "string.h"
+#include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
 
@@ -38,6 +39,13 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+/** AD types used by the scan filters.
+ */
+#define U_BLE_PRIVATE_AD_TYPE_UUID16_INCOMPLETE 0x02
+#define U_BLE_PRIVATE_AD_TYPE_UUID16_COMPLETE   0x03
+#define U_BLE_PRIVATE_AD_TYPE_SERVICE_DATA16    0x16
+#define U_BLE_PRIVATE_AD_TYPE_MANUFACTURER_DATA 0xFF
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -104,4 +112,93 @@ void addrArrayToString(const uint8_t *pAddrIn, uPortBtLeAddressType_t addrType,
     *pAddrOut = '\0';
 }
 
+bool uBlePrivateScanReportWanted(const uBleScanParams_t *pParams,
+                                 int32_t rssiDbm, const uint8_t *pData,
+                                 size_t length)
+{
+    bool uuidFound = (pParams->uuid16 == 0);
+    bool manufacturerFound = (pParams->manufacturerId < 0);
+    size_t adLength;
+    uint8_t adType;
+    size_t x;
+
+    if (rssiDbm < pParams->rssiMinDbm) {
+        return false;
+    }
+
+    // Walk the AD structures: length, type, payload
+    while ((length >= 2) && (!uuidFound || !manufacturerFound)) {
+        adLength = *pData;
+        if ((adLength == 0) || (adLength >= length)) {
+            // Padding or a malformed structure: stop
+            break;
+        }
+        adType = *(pData + 1);
+        switch (adType) {
+            case U_BLE_PRIVATE_AD_TYPE_UUID16_INCOMPLETE:
+            case U_BLE_PRIVATE_AD_TYPE_UUID16_COMPLETE:
+                for (x = 2; x + 1 <= adLength; x += 2) {
+                    if ((*(pData + x) | (*(pData + x + 1) << 8)) == pParams->uuid16) {
+                        uuidFound = true;
+                    }
+                }
+                break;
+            case U_BLE_PRIVATE_AD_TYPE_SERVICE_DATA16:
+                if ((adLength >= 3) &&
+                    ((*(pData + 2) | (*(pData + 3) << 8)) == pParams->uuid16)) {
+                    uuidFound = true;
+                }
+                break;
+            case U_BLE_PRIVATE_AD_TYPE_MANUFACTURER_DATA:
+                if ((adLength >= 3) &&
+                    ((*(pData + 2) | (*(pData + 3) << 8)) == pParams->manufacturerId)) {
+                    manufacturerFound = true;
+                }
+                break;
+            default:
+                break;
+        }
+        pData += adLength + 1;
+        length -= adLength + 1;
+    }
+
+    return uuidFound && manufacturerFound;
+}
+
+bool uBlePrivateScanBatchAdd(uBlePrivateScanBatch_t *pBatch,
+                             const char *pAddress, int32_t rssiDbm,
+                             const uint8_t *pData, size_t length,
+                             bool isScanResponse)
+{
+    uBleScanResult_t *pResult = NULL;
+
+    for (size_t x = 0; (x < pBatch->numResults) && (pResult == NULL); x++) {
+        if ((pBatch->pResults[x].isScanResponse == isScanResponse) &&
+            (strcmp(pBatch->pResults[x].address, pAddress) == 0)) {
+            pResult = &(pBatch->pResults[x]);
+        }
+    }
+    if ((pResult == NULL) && (pBatch->numResults < U_BLE_SCAN_BATCH_MAX_NUM_RESULTS)) {
+        pResult = &(pBatch->pResults[pBatch->numResults]);
+        pBatch->numResults++;
+        strncpy(pResult->address, pAddress, sizeof(pResult->address) - 1);
+        pResult->address[sizeof(pResult->address) - 1] = '\0';
+        pResult->isScanResponse = isScanResponse;
+        pResult->numReports = 0;
+    }
+    if (pResult != NULL) {
+        if (length > sizeof(pResult->data)) {
+            length = sizeof(pResult->data);
+        }
+        if (length > 0) {
+            memcpy(pResult->data, pData, length);
+        }
+        pResult->dataLength = length;
+        pResult->rssiDbm = rssiDbm;
+        pResult->numReports++;
+    }
+
+    return (pResult != NULL);
+}
+
 // End of file
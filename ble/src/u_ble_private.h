@@ -18,6 +18,7 @@
 #define _U_BLE_PRIVATE_H_
 
 #include "u_port_gatt.h"
+#include "u_ble_scan.h"
 
 /** @file
  * @brief This header file defines types, functions and inclusions that
@@ -36,6 +37,13 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** A batch of scan results being collected.
+ */
+typedef struct {
+    uBleScanResult_t *pResults; /**< #U_BLE_SCAN_BATCH_MAX_NUM_RESULTS of them. */
+    size_t numResults;
+} uBlePrivateScanBatch_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -52,6 +60,16 @@ void uBleSpsPrivateInit(void);
  */
 void uBleSpsPrivateDeinit(void);
 
+/** Determine whether the server handles of an SPS connection made
+ * as client were taken from the cache of server handles, see
+ * #U_BLE_SPS_SERVER_HANDLES_CACHE_SIZE, rather than discovered;
+ * for testing only, only implemented for an internal module.
+ *
+ * @param channel  the channel of the SPS connection.
+ * @return         true if the server handles came from the cache.
+ */
+bool uBleSpsPrivateHandlesFromCache(int32_t channel);
+
 /** Translate MAC address in byte array to string
  *
  * @param[in] pAddrIn   pointer to byte array
@@ -62,6 +80,39 @@ void uBleSpsPrivateDeinit(void);
 void addrArrayToString(const uint8_t *pAddrIn, uPortBtLeAddressType_t addrType, bool msbLast,
                        char *pAddrOut);
 
+/** Check whether an advertising report passes the RSSI, UUID and
+ * manufacturer filters of a scan.
+ *
+ * @param[in] pParams  the scan parameters.
+ * @param rssiDbm      the RSSI of the report.
+ * @param[in] pData    the advertising data, raw AD structures.
+ * @param length       the number of bytes at pData.
+ * @return             true if the report should be kept.
+ */
+bool uBlePrivateScanReportWanted(const uBleScanParams_t *pParams,
+                                 int32_t rssiDbm, const uint8_t *pData,
+                                 size_t length);
+
+/** Add an advertising report to a batch of scan results, merging
+ * it with any result already in the batch for the same advertiser
+ * (and the same kind of data, advertising or scan response).
+ *
+ * @param[in] pBatch        the batch.
+ * @param[in] pAddress      the address of the advertiser as a string,
+ *                          e.g. "0012F398DD12p".
+ * @param rssiDbm           the RSSI of the report.
+ * @param[in] pData         the advertising data, raw AD structures;
+ *                          truncated to #U_BLE_SCAN_DATA_MAX_LENGTH_BYTES.
+ * @param length            the number of bytes at pData.
+ * @param isScanResponse    true if pData is from a scan response.
+ * @return                  true if the report was added, false if
+ *                          the batch is full.
+ */
+bool uBlePrivateScanBatchAdd(uBlePrivateScanBatch_t *pBatch,
+                             const char *pAddress, int32_t rssiDbm,
+                             const uint8_t *pData, size_t length,
+                             bool isScanResponse);
+
 #ifdef __cplusplus
 }
 #endif
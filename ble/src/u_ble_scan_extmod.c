@@ -0,0 +1,342 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the scan API for ble with a u-blox module:
+ * AT+UBTD is run for one batch interval at a time, the module
+ * filtering duplicates, and the reports are filtered and merged
+ * here before each batch is delivered.
+ */
+
+#ifndef U_CFG_BLE_MODULE_INTERNAL
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()
+
+#include "u_error_common.h"
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_port.h"
+#include "u_port_heap.h"
+#include "u_port_os.h"
+#include "u_task_registry.h"
+
+#include "u_hex_bin_convert.h"
+
+#include "u_at_client.h"
+
+#include "u_short_range_module_type.h"
+#include "u_short_range.h"
+#include "u_short_range_private.h"
+
+#include "u_ble_scan.h"
+#include "u_ble_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** AT+UBTD discovery type: all, each device reported only once.
+ */
+#define U_BLE_SCAN_DISCOVERY_TYPE_ALL_ONCE 4
+
+/** AT+UBTD discovery type: all, devices may be reported many times.
+ */
+#define U_BLE_SCAN_DISCOVERY_TYPE_ALL 1
+
+/** AT+UBTD mode: active scan.
+ */
+#define U_BLE_SCAN_MODE_ACTIVE 1
+
+/** AT+UBTD mode: passive scan.
+ */
+#define U_BLE_SCAN_MODE_PASSIVE 2
+
+/** AT+UBTD data type of a scan response.
+ */
+#define U_BLE_SCAN_DATA_TYPE_SCAN_RESPONSE 1
+
+/** The minimum and maximum discovery length of AT+UBTD.
+ */
+#define U_BLE_SCAN_INTERVAL_MIN_MS 10
+#define U_BLE_SCAN_INTERVAL_MAX_MS 40000
+
+/** How much longer than the discovery length to wait for the
+ * final "OK" of AT+UBTD.
+ */
+#define U_BLE_SCAN_AT_TIMEOUT_MARGIN_MS 5000
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The context of a scan.
+ */
+typedef struct {
+    uDeviceHandle_t devHandle;
+    uBleScanParams_t params;
+    uBleScanCallback_t pCallback;
+    void *pCallbackParam;
+    uBlePrivateScanBatch_t batch;
+    volatile bool stop;
+    bool freeOnExit; /**< set if uBleScanStop() was called from the callback. */
+    uPortTaskHandle_t taskHandle;
+    uPortMutexHandle_t taskRunningMutexHandle;
+} uBleScanContext_t;
+
+/* ----------------------------------------------------------------
+ * STATIC VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The scan in progress, protected by uShortRangeLock().
+ */
+static uBleScanContext_t *gpScan = NULL;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Free a scan context and its OS resources.
+static void scanFree(uBleScanContext_t *pScan)
+{
+    if (pScan->taskRunningMutexHandle != NULL) {
+        uPortMutexDelete(pScan->taskRunningMutexHandle);
+    }
+    uPortFree(pScan->batch.pResults);
+    uPortFree(pScan);
+}
+
+// Run AT+UBTD for one batch interval, adding what passes the
+// filters to the batch.
+static void scanOnce(uBleScanContext_t *pScan)
+{
+    uShortRangePrivateInstance_t *pInstance;
+    uAtClientHandle_t atHandle = NULL;
+    char address[U_BLE_SCAN_ADDRESS_STRING_LENGTH_BYTES];
+    char hex[(U_BLE_SCAN_DATA_MAX_LENGTH_BYTES * 2) + 1];
+    uint8_t data[U_BLE_SCAN_DATA_MAX_LENGTH_BYTES];
+    int32_t rssiDbm;
+    int32_t dataType;
+    int32_t length;
+
+    if (uShortRangeLock() == (int32_t) U_ERROR_COMMON_SUCCESS) {
+        pInstance = pUShortRangePrivateGetInstance(pScan->devHandle);
+        if (pInstance != NULL) {
+            atHandle = pInstance->atHandle;
+            uAtClientLock(atHandle);
+        }
+        // As in a Wi-Fi scan, the AT client lock is enough
+        // to keep us safe while the scan is running
+        uShortRangeUnlock();
+    }
+
+    if (atHandle != NULL) {
+        uAtClientTimeoutSet(atHandle, pScan->params.batchIntervalMs +
+                            U_BLE_SCAN_AT_TIMEOUT_MARGIN_MS);
+        uAtClientCommandStart(atHandle, "AT+UBTD=");
+        uAtClientWriteInt(atHandle, pScan->params.filterDuplicates ?
+                          U_BLE_SCAN_DISCOVERY_TYPE_ALL_ONCE :
+                          U_BLE_SCAN_DISCOVERY_TYPE_ALL);
+        uAtClientWriteInt(atHandle, pScan->params.activeScan ?
+                          U_BLE_SCAN_MODE_ACTIVE :
+                          U_BLE_SCAN_MODE_PASSIVE);
+        uAtClientWriteInt(atHandle, pScan->params.batchIntervalMs);
+        uAtClientCommandStop(atHandle);
+        // +UBTD:<bd_addr>,<rssi>,<device_name>,<data_type>,<data>
+        // until OK, ERROR or timeout
+        while (uAtClientResponseStart(atHandle, "+UBTD:") == 0) {
+            length = uAtClientReadString(atHandle, address, sizeof(address), false);
+            rssiDbm = uAtClientReadInt(atHandle);
+            // Skip the name, it is in the data if it was advertised
+            uAtClientSkipParameters(atHandle, 1);
+            dataType = uAtClientReadInt(atHandle);
+            if ((length > 0) && (dataType >= 0)) {
+                length = uAtClientReadString(atHandle, hex, sizeof(hex), false);
+                if (length >= 0) {
+                    length = (int32_t) uHexToBin(hex, length, (char *) data);
+                    if (uBlePrivateScanReportWanted(&(pScan->params), rssiDbm,
+                                                    data, length)) {
+                        // If the batch is full the report is dropped
+                        uBlePrivateScanBatchAdd(&(pScan->batch), address, rssiDbm,
+                                                data, length,
+                                                dataType == U_BLE_SCAN_DATA_TYPE_SCAN_RESPONSE);
+                    }
+                }
+            }
+        }
+        uAtClientResponseStop(atHandle);
+        if (uAtClientUnlock(atHandle) < 0) {
+            // Don't spin if the module is refusing, e.g. because
+            // BLE is not configured as central
+            uPortTaskBlock(pScan->params.batchIntervalMs);
+        }
+    } else {
+        // The instance has gone: nothing to do but wait to be stopped
+        uPortTaskBlock(pScan->params.batchIntervalMs);
+    }
+}
+
+// Task that scans and delivers batches of results.
+static void scanTask(void *pParam)
+{
+    uBleScanContext_t *pScan = (uBleScanContext_t *) pParam;
+    bool freeOnExit;
+
+    U_PORT_MUTEX_LOCK(pScan->taskRunningMutexHandle);
+
+    while (!pScan->stop) {
+        scanOnce(pScan);
+        if (pScan->batch.numResults > 0) {
+            // Nothing is locked here so the callback is free
+            // to do as it wishes, including stopping us
+            pScan->pCallback(pScan->devHandle, pScan->batch.pResults,
+                             pScan->batch.numResults, pScan->pCallbackParam);
+            pScan->batch.numResults = 0;
+        }
+    }
+
+    // Only we set this, from the callback, in which case
+    // there is no-one waiting for us and we must clear up
+    freeOnExit = pScan->freeOnExit;
+
+    U_PORT_MUTEX_UNLOCK(pScan->taskRunningMutexHandle);
+
+    if (freeOnExit) {
+        scanFree(pScan);
+    }
+
+    // Delete ourself
+    uTaskRegistryTaskDelete(NULL);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+int32_t uBleScanStart(uDeviceHandle_t devHandle,
+                      const uBleScanParams_t *pParams,
+                      uBleScanCallback_t pCallback,
+                      void *pParameter)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uBleScanParams_t paramsDefault = U_BLE_SCAN_PARAMS_DEFAULT;
+    uBleScanContext_t *pScan;
+
+    if (pParams == NULL) {
+        pParams = &paramsDefault;
+    }
+
+    if ((pCallback != NULL) &&
+        (pParams->batchIntervalMs >= U_BLE_SCAN_INTERVAL_MIN_MS) &&
+        (pParams->batchIntervalMs <= U_BLE_SCAN_INTERVAL_MAX_MS)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+        if (uShortRangeLock() == (int32_t) U_ERROR_COMMON_SUCCESS) {
+            errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            if (pUShortRangePrivateGetInstance(devHandle) != NULL) {
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                pScan = NULL;
+                if (gpScan == NULL) {
+                    pScan = (uBleScanContext_t *) pUPortMalloc(sizeof(*pScan));
+                }
+                if (pScan != NULL) {
+                    memset(pScan, 0, sizeof(*pScan));
+                    pScan->devHandle = devHandle;
+                    pScan->params = *pParams;
+                    pScan->pCallback = pCallback;
+                    pScan->pCallbackParam = pParameter;
+                    pScan->batch.pResults = (uBleScanResult_t *) pUPortMalloc(sizeof(uBleScanResult_t) *
+                                                                               U_BLE_SCAN_BATCH_MAX_NUM_RESULTS);
+                    if ((pScan->batch.pResults != NULL) &&
+                        (uPortMutexCreate(&(pScan->taskRunningMutexHandle)) == 0)) {
+                        errorCode = uTaskRegistryTaskCreate(scanTask, "bleScan",
+                                                            U_BLE_SCAN_TASK_STACK_SIZE_BYTES,
+                                                            pScan, U_BLE_SCAN_TASK_PRIORITY,
+                                                            &(pScan->taskHandle));
+                        if (errorCode == 0) {
+                            // Wait for the task to lock the mutex,
+                            // which shows it is running
+                            while (uPortMutexTryLock(pScan->taskRunningMutexHandle, 0) == 0) {
+                                uPortMutexUnlock(pScan->taskRunningMutexHandle);
+                                uPortTaskBlock(U_CFG_OS_YIELD_MS);
+                            }
+                            gpScan = pScan;
+                        }
+                    }
+                    if (errorCode != 0) {
+                        scanFree(pScan);
+                    }
+                }
+            }
+            uShortRangeUnlock();
+        }
+    }
+
+    return errorCode;
+}
+
+int32_t uBleScanStop(uDeviceHandle_t devHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uBleScanContext_t *pScan = NULL;
+
+    if (uShortRangeLock() == (int32_t) U_ERROR_COMMON_SUCCESS) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pUShortRangePrivateGetInstance(devHandle) != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            if ((gpScan != NULL) && (gpScan->devHandle == devHandle)) {
+                pScan = gpScan;
+                gpScan = NULL;
+                pScan->stop = true;
+                if (uPortTaskIsThis(pScan->taskHandle)) {
+                    // Called from the callback: the task
+                    // will free the context as it exits
+                    pScan->freeOnExit = true;
+                    pScan = NULL;
+                }
+            }
+        }
+        uShortRangeUnlock();
+    }
+
+    if (pScan != NULL) {
+        // Wait for the current scan period to end, the
+        // last batch to be delivered and the task to exit
+        U_PORT_MUTEX_LOCK(pScan->taskRunningMutexHandle);
+        U_PORT_MUTEX_UNLOCK(pScan->taskRunningMutexHandle);
+        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+        scanFree(pScan);
+    }
+
+    return errorCode;
+}
+
+#endif
+
+// End of file
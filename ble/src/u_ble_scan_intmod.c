@@ -0,0 +1,291 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the scan API for ble where BLE is internal
+ * to this MCU: the porting layer filters the reports, which are merged
+ * into a batch here and delivered from a task at the batch interval.
+ */
+
+#ifdef U_CFG_BLE_MODULE_INTERNAL
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset(), memcpy()
+
+#include "u_error_common.h"
+
+#include "u_device_shared.h"
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_port.h"
+#include "u_port_heap.h"
+#include "u_port_os.h"
+#include "u_port_gatt.h"
+#include "u_task_registry.h"
+
+#include "u_ble_scan.h"
+#include "u_ble_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The context of a scan.
+ */
+typedef struct {
+    uDeviceHandle_t devHandle;
+    int32_t batchIntervalMs;
+    uBleScanCallback_t pCallback;
+    void *pCallbackParam;
+    uBlePrivateScanBatch_t batch;     /**< filled from the BLE stack. */
+    uBleScanResult_t *pDeliver;       /**< what batch is copied into for the callback. */
+    uPortMutexHandle_t mutex;         /**< protects batch. */
+    uPortQueueHandle_t queueHandle;   /**< anything sent here stops the task. */
+    bool freeOnExit; /**< set if uBleScanStop() was called from the callback. */
+    uPortTaskHandle_t taskHandle;
+    uPortMutexHandle_t taskRunningMutexHandle;
+} uBleScanContext_t;
+
+/* ----------------------------------------------------------------
+ * STATIC VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The scan in progress.
+ */
+static uBleScanContext_t *gpScan = NULL;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Free a scan context and its OS resources.
+static void scanFree(uBleScanContext_t *pScan)
+{
+    if (pScan->taskRunningMutexHandle != NULL) {
+        uPortMutexDelete(pScan->taskRunningMutexHandle);
+    }
+    if (pScan->queueHandle != NULL) {
+        uPortQueueDelete(pScan->queueHandle);
+    }
+    if (pScan->mutex != NULL) {
+        uPortMutexDelete(pScan->mutex);
+    }
+    uPortFree(pScan->pDeliver);
+    uPortFree(pScan->batch.pResults);
+    uPortFree(pScan);
+}
+
+// Callback from the porting layer with a report that has
+// passed the filter.
+static void onScanReport(const uint8_t *pAddress,
+                         uPortBtLeAddressType_t addressType,
+                         int32_t rssiDbm, bool isScanResponse,
+                         const uint8_t *pData, size_t length,
+                         void *pParam)
+{
+    uBleScanContext_t *pScan = (uBleScanContext_t *) pParam;
+    char address[U_BLE_SCAN_ADDRESS_STRING_LENGTH_BYTES];
+
+    addrArrayToString(pAddress, addressType, true, address);
+    U_PORT_MUTEX_LOCK(pScan->mutex);
+    // If the batch is full the report is dropped
+    uBlePrivateScanBatchAdd(&(pScan->batch), address, rssiDbm,
+                            pData, length, isScanResponse);
+    U_PORT_MUTEX_UNLOCK(pScan->mutex);
+}
+
+// Hand whatever is in the batch to the callback.
+static void deliver(uBleScanContext_t *pScan)
+{
+    size_t numResults;
+
+    // Copy the batch out so that the BLE stack is
+    // held up only for as long as the copy takes
+    U_PORT_MUTEX_LOCK(pScan->mutex);
+    numResults = pScan->batch.numResults;
+    memcpy(pScan->pDeliver, pScan->batch.pResults,
+           numResults * sizeof(uBleScanResult_t));
+    pScan->batch.numResults = 0;
+    U_PORT_MUTEX_UNLOCK(pScan->mutex);
+
+    if (numResults > 0) {
+        pScan->pCallback(pScan->devHandle, pScan->pDeliver,
+                         numResults, pScan->pCallbackParam);
+    }
+}
+
+// Task that delivers batches of results.
+static void scanTask(void *pParam)
+{
+    uBleScanContext_t *pScan = (uBleScanContext_t *) pParam;
+    int32_t dummy;
+    bool freeOnExit;
+
+    U_PORT_MUTEX_LOCK(pScan->taskRunningMutexHandle);
+
+    // The queue is empty until we are stopped, the
+    // receive timing out being our batch interval
+    while (uPortQueueTryReceive(pScan->queueHandle,
+                                pScan->batchIntervalMs, &dummy) != 0) {
+        deliver(pScan);
+    }
+    deliver(pScan);
+
+    // Only we set this, from the callback, in which case
+    // there is no-one waiting for us and we must clear up
+    freeOnExit = pScan->freeOnExit;
+
+    U_PORT_MUTEX_UNLOCK(pScan->taskRunningMutexHandle);
+
+    if (freeOnExit) {
+        scanFree(pScan);
+    }
+
+    // Delete ourself
+    uTaskRegistryTaskDelete(NULL);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+int32_t uBleScanStart(uDeviceHandle_t devHandle,
+                      const uBleScanParams_t *pParams,
+                      uBleScanCallback_t pCallback,
+                      void *pParameter)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uBleScanParams_t paramsDefault = U_BLE_SCAN_PARAMS_DEFAULT;
+    uPortGattScanFilter_t filter;
+    uBleScanContext_t *pScan = NULL;
+
+    if (uDeviceGetDeviceType(devHandle) != (int32_t) U_DEVICE_TYPE_SHORT_RANGE_OPEN_CPU) {
+        return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+    }
+
+    if (pParams == NULL) {
+        pParams = &paramsDefault;
+    }
+
+    if ((pCallback != NULL) && (pParams->batchIntervalMs > 0)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        if (gpScan == NULL) {
+            pScan = (uBleScanContext_t *) pUPortMalloc(sizeof(*pScan));
+        }
+        if (pScan != NULL) {
+            memset(pScan, 0, sizeof(*pScan));
+            pScan->devHandle = devHandle;
+            pScan->batchIntervalMs = pParams->batchIntervalMs;
+            pScan->pCallback = pCallback;
+            pScan->pCallbackParam = pParameter;
+            pScan->batch.pResults = (uBleScanResult_t *) pUPortMalloc(sizeof(uBleScanResult_t) *
+                                                                       U_BLE_SCAN_BATCH_MAX_NUM_RESULTS);
+            pScan->pDeliver = (uBleScanResult_t *) pUPortMalloc(sizeof(uBleScanResult_t) *
+                                                                 U_BLE_SCAN_BATCH_MAX_NUM_RESULTS);
+            if ((pScan->batch.pResults != NULL) && (pScan->pDeliver != NULL) &&
+                (uPortMutexCreate(&(pScan->mutex)) == 0) &&
+                (uPortQueueCreate(1, sizeof(int32_t), &(pScan->queueHandle)) == 0) &&
+                (uPortMutexCreate(&(pScan->taskRunningMutexHandle)) == 0)) {
+                errorCode = uTaskRegistryTaskCreate(scanTask, "bleScan",
+                                                    U_BLE_SCAN_TASK_STACK_SIZE_BYTES,
+                                                    pScan, U_BLE_SCAN_TASK_PRIORITY,
+                                                    &(pScan->taskHandle));
+                if (errorCode == 0) {
+                    // Wait for the task to lock the mutex,
+                    // which shows it is running
+                    while (uPortMutexTryLock(pScan->taskRunningMutexHandle, 0) == 0) {
+                        uPortMutexUnlock(pScan->taskRunningMutexHandle);
+                        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+                    }
+                    filter.activeScan = pParams->activeScan;
+                    filter.filterDuplicates = pParams->filterDuplicates;
+                    filter.rssiMinDbm = pParams->rssiMinDbm;
+                    filter.uuid16 = pParams->uuid16;
+                    filter.manufacturerId = pParams->manufacturerId;
+                    errorCode = uPortGattScanStart(&filter, onScanReport, pScan);
+                    if (errorCode == 0) {
+                        gpScan = pScan;
+                    } else {
+                        // Nothing will have been delivered, so
+                        // the task can simply be told to go
+                        uPortQueueSend(pScan->queueHandle, &errorCode);
+                        U_PORT_MUTEX_LOCK(pScan->taskRunningMutexHandle);
+                        U_PORT_MUTEX_UNLOCK(pScan->taskRunningMutexHandle);
+                        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+                    }
+                }
+            }
+            if (errorCode != 0) {
+                scanFree(pScan);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+int32_t uBleScanStop(uDeviceHandle_t devHandle)
+{
+    uBleScanContext_t *pScan = gpScan;
+    int32_t dummy = 0;
+
+    if (uDeviceGetDeviceType(devHandle) != (int32_t) U_DEVICE_TYPE_SHORT_RANGE_OPEN_CPU) {
+        return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+    }
+
+    if ((pScan != NULL) && (pScan->devHandle == devHandle)) {
+        gpScan = NULL;
+        // Once this returns the BLE stack will add no more
+        uPortGattScanStop();
+        uPortQueueSend(pScan->queueHandle, &dummy);
+        if (uPortTaskIsThis(pScan->taskHandle)) {
+            // Called from the callback: the task
+            // will free the context as it exits
+            pScan->freeOnExit = true;
+        } else {
+            // Wait for the last batch to be delivered
+            // and the task to exit
+            U_PORT_MUTEX_LOCK(pScan->taskRunningMutexHandle);
+            U_PORT_MUTEX_UNLOCK(pScan->taskRunningMutexHandle);
+            uPortTaskBlock(U_CFG_OS_YIELD_MS);
+            scanFree(pScan);
+        }
+    }
+
+    return (int32_t) U_ERROR_COMMON_SUCCESS;
+}
+
+#endif
+
+// End of file
@@ -764,6 +764,43 @@ int32_t uBleSpsGetSpsServerHandles(uDeviceHandle_t devHandle, int32_t channel,
     return (int32_t)U_ERROR_COMMON_NOT_IMPLEMENTED;
 }
 
+int32_t uBleSpsSendQueued(uDeviceHandle_t devHandle, int32_t channel,
+                          const char *pData, int32_t length)
+{
+    (void)devHandle;
+    (void)channel;
+    (void)pData;
+    (void)length;
+    return (int32_t)U_ERROR_COMMON_NOT_IMPLEMENTED;
+}
+
+int32_t uBleSpsSendQueuedSize(uDeviceHandle_t devHandle, int32_t channel)
+{
+    (void)devHandle;
+    (void)channel;
+    return (int32_t)U_ERROR_COMMON_NOT_IMPLEMENTED;
+}
+
+int32_t uBleSpsSetSendPriority(uDeviceHandle_t devHandle, int32_t channel,
+                               int32_t priority)
+{
+    (void)devHandle;
+    (void)channel;
+    (void)priority;
+    return (int32_t)U_ERROR_COMMON_NOT_IMPLEMENTED;
+}
+
+//lint -esym(818, pLinkInfo) Suppress pLinkInfo could be const, need to
+// follow prototype
+int32_t uBleSpsGetLinkInfo(uDeviceHandle_t devHandle, int32_t channel,
+                           uBleSpsLinkInfo_t *pLinkInfo)
+{
+    (void)channel;
+    (void)devHandle;
+    (void)pLinkInfo;
+    return (int32_t)U_ERROR_COMMON_NOT_IMPLEMENTED;
+}
+
 int32_t uBleSpsPresetSpsServerHandles(uDeviceHandle_t devHandle, const uBleSpsHandles_t *pHandles)
 {
     (void)devHandle;
@@ -771,6 +808,12 @@ int32_t uBleSpsPresetSpsServerHandles(uDeviceHandle_t devHandle, const uBleSpsHa
     return (int32_t)U_ERROR_COMMON_NOT_IMPLEMENTED;
 }
 
+int32_t uBleSpsFlushServerHandlesCache(uDeviceHandle_t devHandle)
+{
+    (void)devHandle;
+    return (int32_t)U_ERROR_COMMON_NOT_IMPLEMENTED;
+}
+
 int32_t uBleSpsDisableFlowCtrlOnNext(uDeviceHandle_t devHandle)
 {
     (void)devHandle;
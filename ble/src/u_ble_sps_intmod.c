@@ -98,6 +98,16 @@ typedef enum {
     SPS_CLIENT
 } spsRole_t;
 
+/** An entry in the cache of SPS server handles, an entry with
+ * a service handle of zero being unused.
+ * */
+typedef struct {
+    uint8_t                address[6];
+    uPortBtLeAddressType_t addressType;
+    uBleSpsHandles_t       handles;
+    uint32_t               lastUsed;
+} spsServerHandlesCacheEntry_t;
+
 /** SPS Connection information
  * */
 typedef struct {
@@ -108,6 +118,7 @@ typedef struct {
             uBleSpsHandles_t       attHandle;
             uPortGattSubscribeParams_t creditSubscripe;
             uPortGattSubscribeParams_t fifoSubscripe;
+            bool                       handlesFromCache;
         } client;
         struct {
             uint16_t fifoClientConf;
@@ -124,6 +135,9 @@ typedef struct {
     uint32_t               dataSendTimeoutMs;
     spsRole_t              localSpsRole;
     bool                   flowCtrlEnabled;
+    char                  *pTxData; // Allocated by uBleSpsSendQueued()
+    uRingBuffer_t          txRingBuffer;
+    int32_t                txPriority;
 } spsConnection_t;
 
 /** SPS Client event
@@ -148,6 +162,7 @@ static void addReceivedDataToBuffer(int32_t spsConnHandle, const void *pData, ui
 static bool sendDataToRemoteFifo(const spsConnection_t *pSpsConn, const char *pData,
                                  uint16_t bytesToSendNow);
 static void updateRxCreditsOnRemote(spsConnection_t *pSpsConn);
+static void refreshServerMtu(spsConnection_t *pSpsConn);
 static void gapConnectionEvent(int32_t gapConnHandle, uPortGattGapConnStatus_t status,
                                void *pParameter);
 
@@ -174,6 +189,8 @@ static uPortGattIter_t onFifoCharDiscovery(int32_t gapConnHandle, uPortGattUuid_
 static uPortGattIter_t onSpsServiceDiscovery(int32_t gapConnHandle, uPortGattUuid_t *pUuid,
                                              uint16_t attrHandle, uint16_t endHandle);
 static void onBleSpsEvent(void *pParam, size_t eventSize);
+static void kickTxScheduler(void);
+static void onSpsTxEvent(void *pParam, size_t eventSize);
 
 /** SPS Server specific functions */
 static bool write16BitValue(const void *buf, uint16_t len, uint16_t offset, uint16_t *pVal);
@@ -191,11 +208,20 @@ static int32_t hexToInt(const char *pIn, uint8_t *pOut);
 static int32_t addrStringToArray(const char *pAddrIn, uint8_t *pAddrOut,
                                  uPortBtLeAddressType_t *pType);
 
+/** Server handles cache functions */
+static bool serverHandlesCacheGet(const uint8_t *pAddress, uPortBtLeAddressType_t addressType,
+                                  bool flowCtrlEnabled, uBleSpsHandles_t *pHandles);
+static void serverHandlesCachePut(const char *pAddress, const uBleSpsHandles_t *pHandles);
+static void serverHandlesCacheRemove(const char *pAddress);
+
 /* ----------------------------------------------------------------
  * STATIC VARIABLES
  * -------------------------------------------------------------- */
 static uPortMutexHandle_t gBleSpsMutex = NULL;
 static int32_t gSpsEventQueue = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+static int32_t gSpsTxQueue = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+static int32_t gSpsTxNextConnHandle = 0;
+static volatile bool gSpsTxKickPending = false;
 static uBleSpsConnectionStatusCallback_t gpSpsConnStatusCallback;
 static void *gpSpsConnStatusCallbackParam;
 static uBleSpsAvailableCallback_t gpSpsDataAvailableCallback;
@@ -203,6 +229,15 @@ static void *gpSpsDataAvailableCallbackParam;
 static spsConnection_t *gpSpsConnections[U_BLE_SPS_MAX_CONNECTIONS];
 static uBleSpsHandles_t gNextConnServerHandles;
 static bool gFlowCtrlOnNext = true;
+#if U_BLE_SPS_SERVER_HANDLES_CACHE_SIZE > 0
+// Deliberately not cleared by uBleSpsPrivateDeinit() so that
+// the contents survive closing and re-opening the device
+static spsServerHandlesCacheEntry_t gServerHandlesCache[U_BLE_SPS_SERVER_HANDLES_CACHE_SIZE];
+static uint32_t gServerHandlesCacheUseCount = 0;
+// Separate from gBleSpsMutex since the cache is also accessed
+// from the event queue, which gBleSpsMutex is held while sending to
+static uPortMutexHandle_t gServerHandlesCacheMutex = NULL;
+#endif
 
 static uPortGattUuid128_t gSpsCreditsCharUuid = {
     .type = U_PORT_GATT_UUID_TYPE_128,
@@ -329,6 +364,10 @@ static void freeSpsConnection(int32_t spsConnHandle)
     if (validSpsConnHandle(spsConnHandle)) {
         spsConnection_t *pSpsConn = gpSpsConnections[spsConnHandle];
         uRingBufferDelete(&pSpsConn->rxRingBuffer);
+        if (pSpsConn->pTxData != NULL) {
+            uRingBufferDelete(&pSpsConn->txRingBuffer);
+            uPortFree(pSpsConn->pTxData);
+        }
         uPortSemaphoreDelete(pSpsConn->txCreditsSemaphore);
         uPortFree(pSpsConn);
         gpSpsConnections[spsConnHandle] = NULL;
@@ -367,15 +406,20 @@ static spsConnection_t *initSpsConnection(int32_t spsConnHandle, int32_t gapConn
         pSpsConn->client.attHandle.fifoCcc = 0;
         pSpsConn->client.attHandle.creditsValue = 0;
         pSpsConn->client.attHandle.creditsCcc = 0;
+        pSpsConn->client.handlesFromCache = false;
         pSpsConn->server.fifoClientConf = 0;
         pSpsConn->server.creditsClientConf = 0;
         pSpsConn->spsState = SPS_STATE_DISCONNECTED;
         uPortSemaphoreCreate(&(pSpsConn->txCreditsSemaphore), 0, 1);
-        uRingBufferCreate(&pSpsConn->rxRingBuffer, pSpsConn->rxData, sizeof(pSpsConn->rxData));
+        // The Bluetooth stack is the sole producer and uBleSpsReceive()
+        // the sole consumer, so no locking is required on the data path
+        uRingBufferCreateSpsc(&pSpsConn->rxRingBuffer, pSpsConn->rxData, sizeof(pSpsConn->rxData));
         uRingBufferReset(&pSpsConn->rxRingBuffer);
         pSpsConn->dataSendTimeoutMs = U_BLE_SPS_DEFAULT_SEND_TIMEOUT_MS;
         pSpsConn->localSpsRole = localSpsRole;
         pSpsConn->flowCtrlEnabled = true;
+        pSpsConn->pTxData = NULL;
+        pSpsConn->txPriority = 1;
     }
 
     return gpSpsConnections[spsConnHandle];
@@ -392,8 +436,11 @@ static void addLocalTxCredits(int32_t spsConnHandle, uint8_t credits)
             // We have received more credits, dataSend function might
             // be waiting for the semaphore indicating the we now have TX credits
             uPortSemaphoreGive(pSpsConn->txCreditsSemaphore);
+            // ...and the transmit task may have queued data waiting
+            kickTxScheduler();
         }
         if ((pSpsConn->spsState == SPS_STATE_DISCONNECTED) && pSpsConn->flowCtrlEnabled) {
+            refreshServerMtu(pSpsConn);
             pSpsConn->spsState = SPS_STATE_CONNECTED;
             uPortLog("U_BLE_SPS: Connected as SPS server. Handle %d, remote addr: %s\n",
                      spsConnHandle, pSpsConn->remoteAddr);
@@ -455,13 +502,31 @@ static bool sendDataToRemoteFifo(const spsConnection_t *pSpsConn, const char *pD
     return success;
 }
 
+// As SPS server we are not told when the client exchanges MTU,
+// so read it from the stack
+static void refreshServerMtu(spsConnection_t *pSpsConn)
+{
+    int32_t mtu;
+
+    if (pSpsConn->localSpsRole == SPS_SERVER) {
+        mtu = uPortGattGetMtu(pSpsConn->gapConnHandle);
+        if (mtu > 0) {
+            pSpsConn->mtu = (uint16_t)mtu;
+        }
+    }
+}
+
 static void updateRxCreditsOnRemote(spsConnection_t *pSpsConn)
 {
     size_t avaibleBufferSize = uRingBufferAvailableSize(&(pSpsConn->rxRingBuffer));
     uint8_t availableRxCredits = 0;
-    size_t maxPacketDataSize = pSpsConn->mtu - U_BLE_PDU_HEADER_SIZE;
+    size_t maxPacketDataSize;
     int16_t rxCreditsWeCanSend;
 
+    // A credit must cover a full-size packet
+    refreshServerMtu(pSpsConn);
+    maxPacketDataSize = pSpsConn->mtu - U_BLE_PDU_HEADER_SIZE;
+
     // First we calculate how many full size packets would fit into the current buffer
     while ((avaibleBufferSize > maxPacketDataSize) && (availableRxCredits < 255)) {
         avaibleBufferSize -= maxPacketDataSize;
@@ -473,9 +538,12 @@ static void updateRxCreditsOnRemote(spsConnection_t *pSpsConn)
     // buffer space i.e. availableRxCredits = rxCreditsWeCanSend + rxCreditsOnRemote
     rxCreditsWeCanSend = (int16_t)availableRxCredits - (int16_t)(pSpsConn->rxCreditsOnRemote);
     // Only send new credits when we at least can double the amount available on the remote,
-    // to minimize credits traffic, i.e. when we can send more credits than exists on remote
+    // to minimize credits traffic, i.e. when we can send more credits than exists on remote,
+    // and then only in batches of U_BLE_SPS_RX_CREDITS_WATERMARK, unless the remote has none
     if ((rxCreditsWeCanSend > (int16_t)(pSpsConn->rxCreditsOnRemote)) &&
-        (rxCreditsWeCanSend > 0)) {
+        (rxCreditsWeCanSend > 0) &&
+        ((rxCreditsWeCanSend >= U_BLE_SPS_RX_CREDITS_WATERMARK) ||
+         (pSpsConn->rxCreditsOnRemote == 0))) {
         bool success = false;
 
         if (pSpsConn->localSpsRole == SPS_SERVER) {
@@ -518,6 +586,8 @@ static void gapConnectionEvent(int32_t gapConnHandle, uPortGattGapConnStatus_t s
                 // it means we initiated the connection and are SPS client
                 // In this case the SPS connection is alread initiated.
                 spsEvent_t event;
+                // Ask for the fastest link, this runs in the background
+                (void)uPortGattRequestFastLink(gapConnHandle);
                 event.type = EVENT_GAP_CONNECTED;
                 event.spsConnHandle = spsConnHandle;
                 uPortEventQueueSend(gSpsEventQueue, &event, sizeof(event));
@@ -565,6 +635,7 @@ static void gapConnectionEvent(int32_t gapConnHandle, uPortGattGapConnStatus_t s
                     spsConnection_t *pSpsConn = initSpsConnection(spsConnHandle, gapConnHandle, SPS_SERVER);
                     uPortGattGetRemoteAddress(gapConnHandle, addr, &addrType);
                     addrArrayToString(addr, addrType, true, pSpsConn->remoteAddr);
+                    (void)uPortGattRequestFastLink(gapConnHandle);
                     uPortLog("U_BLE_SPS: Remote GAP connected, SPS conn handle: %d\n", spsConnHandle);
                 } else {
                     uPortLog("U_BLE_SPS: We already have maximum nbr of allowed SPS connections!\n", spsConnHandle);
@@ -899,6 +970,11 @@ static void onBleSpsEvent(void *pParam, size_t eventSize)
             uPortLog("U_BLE_SPS: Connected as SPS client. Handle %d, remote addr: %s\n",
                      pEvent->spsConnHandle, pSpsConn->remoteAddr);
             pSpsConn->spsState = SPS_STATE_CONNECTED;
+            if (pSpsConn->flowCtrlEnabled && !pSpsConn->client.handlesFromCache) {
+                // Remember the handles for the next time; without flow
+                // control the credit handles were not discovered
+                serverHandlesCachePut(pSpsConn->remoteAddr, &(pSpsConn->client.attHandle));
+            }
             if (gpSpsConnStatusCallback != NULL) {
                 gpSpsConnStatusCallback(pEvent->spsConnHandle,
                                         pSpsConn->remoteAddr,
@@ -913,6 +989,13 @@ static void onBleSpsEvent(void *pParam, size_t eventSize)
             break;
 
         case EVENT_SPS_CONNECTING_FAILED:
+            if ((pSpsConn->localSpsRole == SPS_CLIENT) && pSpsConn->client.handlesFromCache) {
+                // The server may have changed its GATT database,
+                // discover it again the next time
+                uPortLog("U_BLE_SPS: Cached server handles for %s failed, removed\n",
+                         pSpsConn->remoteAddr);
+                serverHandlesCacheRemove(pSpsConn->remoteAddr);
+            }
             // Callback gapConnectionEvent will be
             // called later and then reset the SPS connection
             uPortGattDisconnectGap(pSpsConn->gapConnHandle);
@@ -955,6 +1038,7 @@ static int32_t remoteWritesFifoCcc(int32_t gapConnHandle, const void *buf, uint1
                 // Client has configured FIFO notifications without
                 // Credits notification, indicating a credit less SPS connection
                 pSpsConn->flowCtrlEnabled = false;
+                refreshServerMtu(pSpsConn);
                 pSpsConn->spsState = SPS_STATE_CONNECTED;
                 uPortLog("U_BLE_SPS: Connected as SPS server. Handle %d, remote addr: %s\n",
                          spsConnHandle, pSpsConn->remoteAddr);
@@ -1078,6 +1162,183 @@ static int32_t addrStringToArray(const char *pAddrIn, uint8_t *pAddrOut,
     return errorCode;
 }
 
+// Find the cached server handles for the given address, if there
+// are any; entries without the credit handles are only of use if
+// flow control is off.
+static bool serverHandlesCacheGet(const uint8_t *pAddress, uPortBtLeAddressType_t addressType,
+                                  bool flowCtrlEnabled, uBleSpsHandles_t *pHandles)
+{
+    bool found = false;
+#if U_BLE_SPS_SERVER_HANDLES_CACHE_SIZE > 0
+    spsServerHandlesCacheEntry_t *pEntry;
+
+    if (gServerHandlesCacheMutex != NULL) {
+        U_PORT_MUTEX_LOCK(gServerHandlesCacheMutex);
+        for (size_t x = 0; (x < U_BLE_SPS_SERVER_HANDLES_CACHE_SIZE) && !found; x++) {
+            pEntry = &(gServerHandlesCache[x]);
+            if ((pEntry->handles.service != 0) &&
+                (pEntry->addressType == addressType) &&
+                (memcmp(pEntry->address, pAddress, sizeof(pEntry->address)) == 0) &&
+                (!flowCtrlEnabled || (pEntry->handles.creditsValue != 0))) {
+                memcpy(pHandles, &(pEntry->handles), sizeof(*pHandles));
+                gServerHandlesCacheUseCount++;
+                pEntry->lastUsed = gServerHandlesCacheUseCount;
+                found = true;
+            }
+        }
+        U_PORT_MUTEX_UNLOCK(gServerHandlesCacheMutex);
+    }
+#else
+    (void)pAddress;
+    (void)addressType;
+    (void)flowCtrlEnabled;
+    (void)pHandles;
+#endif
+
+    return found;
+}
+
+// Add the server handles for the given address string to the
+// cache, replacing any existing entry for the address or else
+// the least recently used one.
+static void serverHandlesCachePut(const char *pAddress, const uBleSpsHandles_t *pHandles)
+{
+#if U_BLE_SPS_SERVER_HANDLES_CACHE_SIZE > 0
+    uint8_t address[6];
+    uPortBtLeAddressType_t addressType;
+    spsServerHandlesCacheEntry_t *pEntry;
+    spsServerHandlesCacheEntry_t *pVictim = NULL;
+
+    if ((gServerHandlesCacheMutex != NULL) &&
+        (addrStringToArray(pAddress, address, &addressType) == (int32_t)U_ERROR_COMMON_SUCCESS)) {
+        U_PORT_MUTEX_LOCK(gServerHandlesCacheMutex);
+        for (size_t x = 0; x < U_BLE_SPS_SERVER_HANDLES_CACHE_SIZE; x++) {
+            pEntry = &(gServerHandlesCache[x]);
+            if ((pEntry->handles.service != 0) &&
+                (pEntry->addressType == addressType) &&
+                (memcmp(pEntry->address, address, sizeof(pEntry->address)) == 0)) {
+                pVictim = pEntry;
+                break;
+            }
+            if ((pVictim == NULL) || (pEntry->handles.service == 0) ||
+                ((pVictim->handles.service != 0) && (pEntry->lastUsed < pVictim->lastUsed))) {
+                pVictim = pEntry;
+            }
+        }
+        if (pVictim != NULL) {
+            memcpy(pVictim->address, address, sizeof(pVictim->address));
+            pVictim->addressType = addressType;
+            memcpy(&(pVictim->handles), pHandles, sizeof(pVictim->handles));
+            gServerHandlesCacheUseCount++;
+            pVictim->lastUsed = gServerHandlesCacheUseCount;
+        }
+        U_PORT_MUTEX_UNLOCK(gServerHandlesCacheMutex);
+    }
+#else
+    (void)pAddress;
+    (void)pHandles;
+#endif
+}
+
+// Remove any cached server handles for the given address string.
+static void serverHandlesCacheRemove(const char *pAddress)
+{
+#if U_BLE_SPS_SERVER_HANDLES_CACHE_SIZE > 0
+    uint8_t address[6];
+    uPortBtLeAddressType_t addressType;
+    spsServerHandlesCacheEntry_t *pEntry;
+
+    if ((gServerHandlesCacheMutex != NULL) &&
+        (addrStringToArray(pAddress, address, &addressType) == (int32_t)U_ERROR_COMMON_SUCCESS)) {
+        U_PORT_MUTEX_LOCK(gServerHandlesCacheMutex);
+        for (size_t x = 0; x < U_BLE_SPS_SERVER_HANDLES_CACHE_SIZE; x++) {
+            pEntry = &(gServerHandlesCache[x]);
+            if ((pEntry->addressType == addressType) &&
+                (memcmp(pEntry->address, address, sizeof(pEntry->address)) == 0)) {
+                memset(pEntry, 0, sizeof(*pEntry));
+            }
+        }
+        U_PORT_MUTEX_UNLOCK(gServerHandlesCacheMutex);
+    }
+#else
+    (void)pAddress;
+#endif
+}
+
+// Wake up the transmit task, if there is one; only one wake-up
+// is kept pending so that the send can never block on a full
+// queue (which could otherwise happen with gBleSpsMutex locked).
+static void kickTxScheduler(void)
+{
+    int32_t dummy = 0;
+
+    if ((gSpsTxQueue >= 0) && !gSpsTxKickPending) {
+        gSpsTxKickPending = true;
+        (void)uPortEventQueueSend(gSpsTxQueue, &dummy, sizeof(dummy));
+    }
+}
+
+// Send one packet from the transmit queue of a connection, directly
+// from the queue's buffer; must be called with gBleSpsMutex locked.
+static bool sendQueuedPacket(spsConnection_t *pSpsConn)
+{
+    bool sent = false;
+    uRingBufferSpan_t span[2];
+    size_t bytesToSendNow;
+
+    if ((pSpsConn->pTxData != NULL) &&
+        (pSpsConn->spsState == SPS_STATE_CONNECTED) &&
+        (!pSpsConn->flowCtrlEnabled || (pSpsConn->txCredits > 0)) &&
+        (uRingBufferPeekSpan(&(pSpsConn->txRingBuffer), span) > 0)) {
+        bytesToSendNow = span[0].length;
+        if (bytesToSendNow > (size_t)(pSpsConn->mtu - U_BLE_PDU_HEADER_SIZE)) {
+            bytesToSendNow = pSpsConn->mtu - U_BLE_PDU_HEADER_SIZE;
+        }
+        if (sendDataToRemoteFifo(pSpsConn, span[0].pData, (uint16_t)bytesToSendNow)) {
+            uRingBufferRead(&(pSpsConn->txRingBuffer), NULL, bytesToSendNow);
+            if (pSpsConn->flowCtrlEnabled) {
+                pSpsConn->txCredits--;
+            }
+            sent = true;
+        }
+    }
+
+    return sent;
+}
+
+// The transmit task: go round the connections, starting at a
+// different one each time, letting each send as many packets as
+// its priority allows, until none can send any more.
+static void onSpsTxEvent(void *pParam, size_t eventSize)
+{
+    bool sent = true;
+    int32_t spsConnHandle;
+    spsConnection_t *pSpsConn;
+
+    (void)pParam;
+    (void)eventSize;
+
+    // Anything kicked from now on needs another go
+    gSpsTxKickPending = false;
+    while (sent) {
+        sent = false;
+        U_PORT_MUTEX_LOCK(gBleSpsMutex);
+        for (int32_t x = 0; x < U_BLE_SPS_MAX_CONNECTIONS; x++) {
+            spsConnHandle = (gSpsTxNextConnHandle + x) % U_BLE_SPS_MAX_CONNECTIONS;
+            if (validSpsConnHandle(spsConnHandle)) {
+                pSpsConn = pGetSpsConn(spsConnHandle);
+                refreshServerMtu(pSpsConn);
+                for (int32_t y = 0; (y < pSpsConn->txPriority) &&
+                     sendQueuedPacket(pSpsConn); y++) {
+                    sent = true;
+                }
+            }
+        }
+        gSpsTxNextConnHandle = (gSpsTxNextConnHandle + 1) % U_BLE_SPS_MAX_CONNECTIONS;
+        U_PORT_MUTEX_UNLOCK(gBleSpsMutex);
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -1085,6 +1346,9 @@ void uBleSpsPrivateInit(void)
 {
     if (gSpsEventQueue == (int32_t)U_ERROR_COMMON_NOT_INITIALISED) {
         uPortMutexCreate(&gBleSpsMutex);
+#if U_BLE_SPS_SERVER_HANDLES_CACHE_SIZE > 0
+        uPortMutexCreate(&gServerHandlesCacheMutex);
+#endif
         uPortGattSetGapConnStatusCallback(gapConnectionEvent, NULL);
 
         gSpsEventQueue = uPortEventQueueOpen(onBleSpsEvent,
@@ -1099,6 +1363,11 @@ void uBleSpsPrivateDeinit(void)
     if (gSpsEventQueue != (int32_t)U_ERROR_COMMON_NOT_INITIALISED) {
         uPortGattSetGapConnStatusCallback(NULL, NULL);
 
+        if (gSpsTxQueue >= 0) {
+            uPortEventQueueClose(gSpsTxQueue);
+            gSpsTxQueue = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+        }
+
         for (int32_t i = 0; i < U_BLE_SPS_MAX_CONNECTIONS; i++) {
             if (validSpsConnHandle(i)) {
                 spsConnection_t *pSpsConn = pGetSpsConn(i);
@@ -1111,9 +1380,30 @@ void uBleSpsPrivateDeinit(void)
         gSpsEventQueue = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
         uPortMutexDelete(gBleSpsMutex);
         gBleSpsMutex = NULL;
+#if U_BLE_SPS_SERVER_HANDLES_CACHE_SIZE > 0
+        uPortMutexDelete(gServerHandlesCacheMutex);
+        gServerHandlesCacheMutex = NULL;
+#endif
     }
 }
 
+bool uBleSpsPrivateHandlesFromCache(int32_t channel)
+{
+    bool fromCache = false;
+
+    if (gBleSpsMutex != NULL) {
+        U_PORT_MUTEX_LOCK(gBleSpsMutex);
+        if (validSpsConnHandle(channel)) {
+            spsConnection_t *pSpsConn = pGetSpsConn(channel);
+            fromCache = (pSpsConn->localSpsRole == SPS_CLIENT) &&
+                        pSpsConn->client.handlesFromCache;
+        }
+        U_PORT_MUTEX_UNLOCK(gBleSpsMutex);
+    }
+
+    return fromCache;
+}
+
 int32_t uBleSpsSetCallbackConnectionStatus(uDeviceHandle_t devHandle,
                                            uBleSpsConnectionStatusCallback_t pCallback,
                                            void *pCallbackParameter)
@@ -1171,6 +1461,13 @@ int32_t uBleSpsConnectSps(uDeviceHandle_t devHandle,
                         // Maybe disable flow control
                         pSpsConn->flowCtrlEnabled = gFlowCtrlOnNext;
                         gFlowCtrlOnNext = true;
+                        if (pSpsConn->client.attHandle.service == 0) {
+                            // Not preset: if we've connected to this server
+                            // before we may not need to discover anything
+                            pSpsConn->client.handlesFromCache = serverHandlesCacheGet(address, addrType,
+                                                                                      pSpsConn->flowCtrlEnabled,
+                                                                                      &(pSpsConn->client.attHandle));
+                        }
                         errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                     }
                 }
@@ -1238,6 +1535,9 @@ int32_t uBleSpsSend(uDeviceHandle_t devHandle, int32_t channel, const char *pDat
         uint32_t timeout = pSpsConn->dataSendTimeoutMs;
         int64_t time = startTime;
 
+        // Send packets that are as large as the MTU allows
+        refreshServerMtu(pSpsConn);
+
         while ((bytesLeftToSend > 0) && (time - startTime < timeout)) {
             int32_t bytesToSendNow = bytesLeftToSend;
             int32_t maxDataLength = pSpsConn->mtu - U_BLE_PDU_HEADER_SIZE;
@@ -1289,6 +1589,114 @@ int32_t uBleSpsSend(uDeviceHandle_t devHandle, int32_t channel, const char *pDat
     }
 }
 
+int32_t uBleSpsSendQueued(uDeviceHandle_t devHandle, int32_t channel,
+                          const char *pData, int32_t length)
+{
+    int32_t spsConnHandle = channel;
+    int32_t sizeOrErrorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+    spsConnection_t *pSpsConn;
+    size_t size;
+
+    if (uDeviceGetDeviceType(devHandle) != (int32_t)U_DEVICE_TYPE_SHORT_RANGE_OPEN_CPU) {
+        return (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+    }
+
+    if (gBleSpsMutex == NULL) {
+        return (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+    }
+
+    U_PORT_MUTEX_LOCK(gBleSpsMutex);
+
+    if ((pData != NULL) && (length >= 0) && validSpsConnHandle(spsConnHandle)) {
+        pSpsConn = pGetSpsConn(spsConnHandle);
+        sizeOrErrorCode = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+        if (pSpsConn->spsState == SPS_STATE_CONNECTED) {
+            if (gSpsTxQueue < 0) {
+                gSpsTxQueue = uPortEventQueueOpen(onSpsTxEvent,
+                                                  "uBleSpsTxQueue", sizeof(int32_t),
+                                                  U_PORT_EVENT_QUEUE_MIN_TASK_STACK_SIZE_BYTES,
+                                                  U_CFG_OS_APP_TASK_PRIORITY + 1,
+                                                  U_BLE_SPS_MAX_CONNECTIONS);
+            }
+            if ((pSpsConn->pTxData == NULL) && (gSpsTxQueue >= 0)) {
+                pSpsConn->pTxData = (char *)pUPortMalloc(U_BLE_SPS_TX_QUEUE_SIZE);
+                if ((pSpsConn->pTxData != NULL) &&
+                    (uRingBufferCreate(&(pSpsConn->txRingBuffer), pSpsConn->pTxData,
+                                       U_BLE_SPS_TX_QUEUE_SIZE) != 0)) {
+                    uPortFree(pSpsConn->pTxData);
+                    pSpsConn->pTxData = NULL;
+                }
+            }
+            sizeOrErrorCode = (int32_t)U_ERROR_COMMON_NO_MEMORY;
+            if ((gSpsTxQueue >= 0) && (pSpsConn->pTxData != NULL)) {
+                size = uRingBufferAvailableSize(&(pSpsConn->txRingBuffer));
+                if (size > (size_t)length) {
+                    size = length;
+                }
+                if ((size > 0) &&
+                    uRingBufferAdd(&(pSpsConn->txRingBuffer), pData, size)) {
+                    kickTxScheduler();
+                } else {
+                    size = 0;
+                }
+                sizeOrErrorCode = (int32_t)size;
+            }
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(gBleSpsMutex);
+
+    return sizeOrErrorCode;
+}
+
+int32_t uBleSpsSendQueuedSize(uDeviceHandle_t devHandle, int32_t channel)
+{
+    int32_t spsConnHandle = channel;
+    int32_t sizeOrErrorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+    spsConnection_t *pSpsConn;
+
+    if (uDeviceGetDeviceType(devHandle) != (int32_t)U_DEVICE_TYPE_SHORT_RANGE_OPEN_CPU) {
+        return (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+    }
+
+    if (gBleSpsMutex == NULL) {
+        return (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+    }
+
+    U_PORT_MUTEX_LOCK(gBleSpsMutex);
+
+    if (validSpsConnHandle(spsConnHandle)) {
+        pSpsConn = pGetSpsConn(spsConnHandle);
+        sizeOrErrorCode = 0;
+        if (pSpsConn->pTxData != NULL) {
+            sizeOrErrorCode = (int32_t)uRingBufferDataSize(&(pSpsConn->txRingBuffer));
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(gBleSpsMutex);
+
+    return sizeOrErrorCode;
+}
+
+int32_t uBleSpsSetSendPriority(uDeviceHandle_t devHandle, int32_t channel,
+                               int32_t priority)
+{
+    int32_t spsConnHandle = channel;
+
+    if ((uDeviceGetDeviceType(devHandle) != (int32_t)U_DEVICE_TYPE_SHORT_RANGE_OPEN_CPU) ||
+        (priority < 1) || (priority > U_BLE_SPS_TX_PRIORITY_MAX)) {
+        return (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+    }
+
+    if (!validSpsConnHandle(spsConnHandle)) {
+        return (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+    }
+
+    pGetSpsConn(spsConnHandle)->txPriority = priority;
+
+    return (int32_t)U_ERROR_COMMON_SUCCESS;
+}
+
 int32_t uBleSpsSetDataAvailableCallback(uDeviceHandle_t devHandle,
                                         uBleSpsAvailableCallback_t pCallback,
                                         void *pCallbackParameter)
@@ -1348,6 +1756,33 @@ int32_t uBleSpsGetSpsServerHandles(uDeviceHandle_t devHandle, int32_t channel,
     return returnValue;
 }
 
+int32_t uBleSpsGetLinkInfo(uDeviceHandle_t devHandle, int32_t channel,
+                           uBleSpsLinkInfo_t *pLinkInfo)
+{
+    int32_t spsConnHandle = channel;
+    uPortGattLinkInfo_t linkInfo;
+
+    if ((uDeviceGetDeviceType(devHandle) != (int32_t)U_DEVICE_TYPE_SHORT_RANGE_OPEN_CPU) ||
+        (pLinkInfo == NULL)) {
+        return (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+    }
+
+    int32_t returnValue = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+    if (validSpsConnHandle(spsConnHandle)) {
+        spsConnection_t *pSpsConn = pGetSpsConn(spsConnHandle);
+        returnValue = uPortGattGetLinkInfo(pSpsConn->gapConnHandle, &linkInfo);
+        if (returnValue == (int32_t)U_ERROR_COMMON_SUCCESS) {
+            pLinkInfo->mtu = linkInfo.mtu;
+            pLinkInfo->txPhy = linkInfo.txPhy;
+            pLinkInfo->rxPhy = linkInfo.rxPhy;
+            pLinkInfo->txDataLength = linkInfo.txDataLength;
+            pLinkInfo->rxDataLength = linkInfo.rxDataLength;
+        }
+    }
+
+    return returnValue;
+}
+
 int32_t uBleSpsPresetSpsServerHandles(uDeviceHandle_t devHandle, const uBleSpsHandles_t *pHandles)
 {
     if (uDeviceGetDeviceType(devHandle) != (int32_t)U_DEVICE_TYPE_SHORT_RANGE_OPEN_CPU) {
@@ -1359,6 +1794,25 @@ int32_t uBleSpsPresetSpsServerHandles(uDeviceHandle_t devHandle, const uBleSpsHa
     return (int32_t)U_ERROR_COMMON_SUCCESS;
 }
 
+int32_t uBleSpsFlushServerHandlesCache(uDeviceHandle_t devHandle)
+{
+    if (uDeviceGetDeviceType(devHandle) != (int32_t)U_DEVICE_TYPE_SHORT_RANGE_OPEN_CPU) {
+        return (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+    }
+
+#if U_BLE_SPS_SERVER_HANDLES_CACHE_SIZE > 0
+    if (gServerHandlesCacheMutex != NULL) {
+        U_PORT_MUTEX_LOCK(gServerHandlesCacheMutex);
+        memset(gServerHandlesCache, 0, sizeof(gServerHandlesCache));
+        U_PORT_MUTEX_UNLOCK(gServerHandlesCacheMutex);
+    } else {
+        memset(gServerHandlesCache, 0, sizeof(gServerHandlesCache));
+    }
+#endif
+
+    return (int32_t)U_ERROR_COMMON_SUCCESS;
+}
+
 int32_t uBleSpsDisableFlowCtrlOnNext(uDeviceHandle_t devHandle)
 {
     if (uDeviceGetDeviceType(devHandle) != (int32_t)U_DEVICE_TYPE_SHORT_RANGE_OPEN_CPU) {
@@ -0,0 +1,242 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the ble scan API: these should pass on all
+ * platforms that have a short range module connected to them or
+ * internal BLE; any advertisers nearby will be reported.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stdint.h"    // int32_t etc.
+
+// Must always be included before u_short_range_test_selector.h
+//lint -efile(766, u_ble_module_type.h)
+#include "u_ble_module_type.h"
+
+#include "u_short_range_test_selector.h"
+
+#if U_SHORT_RANGE_TEST_BLE() && defined(U_CFG_TEST_SHORT_RANGE_MODULE_TYPE)
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdbool.h"
+#include "string.h"    // strlen()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+#include "u_port_uart.h"
+
+#include "u_at_client.h"
+#include "u_short_range_pbuf.h"
+#include "u_short_range.h"
+#include "u_short_range_edm_stream.h"
+#include "u_ble.h"
+
+#include "u_ble_cfg.h"
+#include "u_ble_scan.h"
+
+#include "u_ble_test_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_BLE_SCAN_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+//lint -esym(843, gHandles) Suppress could be const, which will be the case if
+// U_CFG_TEST_SHORT_RANGE_MODULE_TYPE is not defined
+static uBleTestPrivate_t gHandles = { -1, -1, NULL, NULL };
+
+/** The number of batches received.
+ */
+static volatile int32_t gNumBatches = 0;
+
+/** The number of results received.
+ */
+static volatile int32_t gNumResults = 0;
+
+/** Set to true if a result looks wrong.
+ */
+static volatile bool gResultBad = false;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Callback for batches of scan results.
+static void scanCallback(uDeviceHandle_t devHandle,
+                         const uBleScanResult_t *pResults,
+                         size_t numResults, void *pParameter)
+{
+    if ((devHandle != gHandles.devHandle) || (pParameter != &gHandles) ||
+        (numResults == 0) || (numResults > U_BLE_SCAN_BATCH_MAX_NUM_RESULTS)) {
+        gResultBad = true;
+    }
+    for (size_t x = 0; x < numResults; x++) {
+        if ((strlen(pResults[x].address) != 13) ||
+            (pResults[x].dataLength > sizeof(pResults[x].data)) ||
+            (pResults[x].numReports == 0)) {
+            gResultBad = true;
+        }
+    }
+    gNumBatches++;
+    gNumResults += (int32_t) numResults;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+U_PORT_TEST_FUNCTION("[bleScan]", "bleScanBasic")
+{
+    int32_t heapUsed;
+    uBleCfg_t cfg;
+    uBleScanParams_t params = U_BLE_SCAN_PARAMS_DEFAULT;
+    uShortRangeUartConfig_t uart = { .uartPort = U_CFG_APP_SHORT_RANGE_UART,
+                                     .baudRate = U_SHORT_RANGE_UART_BAUD_RATE,
+                                     .pinTx = U_CFG_APP_PIN_SHORT_RANGE_TXD,
+                                     .pinRx = U_CFG_APP_PIN_SHORT_RANGE_RXD,
+                                     .pinCts = U_CFG_APP_PIN_SHORT_RANGE_CTS,
+                                     .pinRts = U_CFG_APP_PIN_SHORT_RANGE_RTS
+                                   };
+    heapUsed = uPortGetHeapFree();
+
+    U_PORT_TEST_ASSERT(uBleTestPrivatePreamble((uBleModuleType_t) U_CFG_TEST_SHORT_RANGE_MODULE_TYPE,
+                                               &uart,
+                                               &gHandles) == 0);
+
+    cfg.role = U_BLE_CFG_ROLE_CENTRAL;
+    cfg.spsServer = false;
+    U_PORT_TEST_ASSERT(uBleCfgConfigure(gHandles.devHandle, &cfg) == 0);
+
+    gNumBatches = 0;
+    gNumResults = 0;
+    gResultBad = false;
+    U_PORT_TEST_ASSERT(uBleScanStart(gHandles.devHandle, NULL, NULL, NULL) < 0);
+    U_TEST_PRINT_LINE("scanning with default parameters...");
+    U_PORT_TEST_ASSERT(uBleScanStart(gHandles.devHandle, &params,
+                                     scanCallback, &gHandles) == 0);
+    // Only one at a time
+    U_PORT_TEST_ASSERT(uBleScanStart(gHandles.devHandle, &params,
+                                     scanCallback, &gHandles) < 0);
+    uPortTaskBlock(params.batchIntervalMs * 4);
+    U_PORT_TEST_ASSERT(uBleScanStop(gHandles.devHandle) == 0);
+    U_TEST_PRINT_LINE("%d result(s) in %d batch(es).", gNumResults, gNumBatches);
+    U_PORT_TEST_ASSERT(!gResultBad);
+    // Nothing more once stopped
+    gNumBatches = 0;
+    uPortTaskBlock(params.batchIntervalMs * 2);
+    U_PORT_TEST_ASSERT(gNumBatches == 0);
+
+    // A manufacturer filter that nothing should match
+    params.manufacturerId = 0xFFFE;
+    gNumResults = 0;
+    U_PORT_TEST_ASSERT(uBleScanStart(gHandles.devHandle, &params,
+                                     scanCallback, &gHandles) == 0);
+    uPortTaskBlock(params.batchIntervalMs * 2);
+    U_PORT_TEST_ASSERT(uBleScanStop(gHandles.devHandle) == 0);
+    U_PORT_TEST_ASSERT(gNumResults == 0);
+    U_PORT_TEST_ASSERT(!gResultBad);
+
+    cfg.role = U_BLE_CFG_ROLE_PERIPHERAL;
+    cfg.spsServer = true;
+    U_PORT_TEST_ASSERT(uBleCfgConfigure(gHandles.devHandle, &cfg) == 0);
+
+    uBleTestPrivatePostamble(&gHandles);
+
+#ifndef __XTENSA__
+    // Check for memory leaks
+    // TODO: this if'ed out for ESP32 (xtensa compiler) at
+    // the moment as there is an issue with ESP32 hanging
+    // on to memory in the UART drivers that can't easily be
+    // accounted for.
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+#else
+    (void) heapUsed;
+#endif
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[bleScan]", "bleScanCleanUp")
+{
+    int32_t x;
+
+    uBleScanStop(gHandles.devHandle);
+    uBleDeinit();
+    if (gHandles.edmStreamHandle >= 0) {
+        uShortRangeEdmStreamClose(gHandles.edmStreamHandle);
+    }
+    uAtClientDeinit();
+    if (gHandles.uartHandle >= 0) {
+        uPortUartClose(gHandles.uartHandle);
+    }
+
+    x = uPortTaskStackMinFree(NULL);
+    if (x != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        U_TEST_PRINT_LINE("main task stack had a minimum of %d byte(s)"
+                          " free at the end of these tests.", x);
+        U_PORT_TEST_ASSERT(x >= U_CFG_TEST_OS_MAIN_TASK_MIN_FREE_STACK_BYTES);
+    }
+    uPortDeinit();
+
+    x = uPortGetHeapMinFree();
+    if (x >= 0) {
+        U_TEST_PRINT_LINE("heap had a minimum of %d byte(s) free"
+                          " at the end of these tests.", x);
+        U_PORT_TEST_ASSERT(x >= U_CFG_TEST_HEAP_MIN_FREE_BYTES);
+    }
+}
+
+#endif // U_SHORT_RANGE_TEST_BLE()
+
+// End of file
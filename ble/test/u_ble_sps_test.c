@@ -51,6 +51,7 @@
 //lint -efile(451, stddef.h)
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdbool.h"
+#include "string.h"    // memcmp()
 
 #include "u_cfg_sw.h"
 #include "u_cfg_app_platform_specific.h"
@@ -68,11 +69,13 @@
 #include "u_short_range.h"
 #include "u_short_range_edm_stream.h"
 #include "u_ble.h"
+#include "u_ble_cfg.h"
 
 #include "u_short_range_test_selector.h"
 
 #include "u_ble_sps.h"
 #include "u_ble_test_private.h"
+#include "u_ble_private.h" // uBleSpsPrivateHandlesFromCache()
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -86,6 +89,13 @@
  */
 #define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
 
+#ifndef U_BLE_SPS_TEST_TIMEOUT_MS
+/** How long to wait for the queued data to be sent and echoed
+ * back by the remote SPS peers.
+ */
+# define U_BLE_SPS_TEST_TIMEOUT_MS 10000
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -96,10 +106,133 @@
 
 static uBleTestPrivate_t gHandles = { -1, -1, NULL, NULL };
 
+#if defined(U_CFG_BLE_MODULE_INTERNAL) && (defined(U_BLE_TEST_CFG_REMOTE_SPS_CENTRAL) || \
+                                            defined(U_BLE_TEST_CFG_REMOTE_SPS_PERIPHERAL))
+/** The addresses of the BLE test peers, which echo back whatever
+ * is sent to them over SPS.
+ */
+static const char *const gpRemoteSpsAddress[] = {
+# ifdef U_BLE_TEST_CFG_REMOTE_SPS_CENTRAL
+    U_PORT_STRINGIFY_QUOTED(U_BLE_TEST_CFG_REMOTE_SPS_CENTRAL),
+# endif
+# ifdef U_BLE_TEST_CFG_REMOTE_SPS_PERIPHERAL
+    U_PORT_STRINGIFY_QUOTED(U_BLE_TEST_CFG_REMOTE_SPS_PERIPHERAL)
+# endif
+};
+
+/** The data sent, over and over, on each channel.
+ */
+static const char gTestData[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+/** Given by spsConnectionCallback().
+ */
+static uPortSemaphoreHandle_t gConnectionSem = NULL;
+
+/** The channel of the last SPS connection made.
+ */
+static volatile int32_t gChannel = -1;
+
+/** The number of SPS connections currently up.
+ */
+static volatile int32_t gNumConnected = 0;
+
+/** The number of bytes received on each channel.
+ */
+static volatile int32_t gBytesReceived[U_BLE_SPS_MAX_CONNECTIONS] = {0};
+
+/** The number of received bytes that were not as expected.
+ */
+static volatile int32_t gErrors = 0;
+#endif
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+#if defined(U_CFG_BLE_MODULE_INTERNAL) && (defined(U_BLE_TEST_CFG_REMOTE_SPS_CENTRAL) || \
+                                            defined(U_BLE_TEST_CFG_REMOTE_SPS_PERIPHERAL))
+
+// Connection callback: keep count of the connections.
+static void spsConnectionCallback(int32_t connHandle, char *pAddress, int32_t status,
+                                  int32_t channel, int32_t mtu, void *pParameters)
+{
+    (void) connHandle;
+    (void) pAddress;
+    (void) mtu;
+    (void) pParameters;
+
+    if (status == (int32_t) U_BLE_SPS_CONNECTED) {
+        gChannel = channel;
+        gNumConnected++;
+    } else if ((status == (int32_t) U_BLE_SPS_DISCONNECTED) &&
+               (connHandle != U_BLE_SPS_INVALID_HANDLE)) {
+        gNumConnected--;
+    }
+    if (gConnectionSem != NULL) {
+        uPortSemaphoreGive(gConnectionSem);
+    }
+}
+
+// Data available callback: check the echoed data against gTestData.
+static void spsReceiveCallback(int32_t channel, void *pParameters)
+{
+    char buffer[64];
+    int32_t length;
+
+    (void) pParameters;
+
+    if ((channel >= 0) && (channel < U_BLE_SPS_MAX_CONNECTIONS)) {
+        do {
+            length = uBleSpsReceive(gHandles.devHandle, channel, buffer, sizeof(buffer));
+            for (int32_t x = 0; x < length; x++) {
+                if (buffer[x] != gTestData[gBytesReceived[channel] % (sizeof(gTestData) - 1)]) {
+                    gErrors++;
+                }
+                gBytesReceived[channel]++;
+            }
+        } while (length > 0);
+    }
+}
+
+// Make an SPS connection to the given address, returning the channel.
+static int32_t connectSps(const char *pAddress)
+{
+    int32_t channel = -1;
+    int32_t numConnected = gNumConnected;
+
+    for (size_t tries = 0; (tries < 3) && (channel < 0); tries++) {
+        U_TEST_PRINT_LINE("connecting SPS: %s.", pAddress);
+        if (uBleSpsConnectSps(gHandles.devHandle, pAddress, NULL) == 0) {
+            uPortSemaphoreTryTake(gConnectionSem, 10000);
+            if (gNumConnected > numConnected) {
+                channel = gChannel;
+            }
+        } else {
+            // Just wait a bit and try again...
+            uPortTaskBlock(5000);
+        }
+    }
+    U_TEST_PRINT_LINE("channel %d.", channel);
+
+    return channel;
+}
+
+// Disconnect an SPS channel and wait for that to happen.
+static bool disconnectSps(int32_t channel)
+{
+    int32_t numConnected = gNumConnected;
+
+    if (uBleSpsDisconnect(gHandles.devHandle, channel) == 0) {
+        for (size_t x = 0; (x < 40) && (gNumConnected >= numConnected); x++) {
+            uPortTaskBlock(100);
+        }
+    }
+
+    return (gNumConnected < numConnected);
+}
+
+#endif
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -176,6 +309,243 @@ U_PORT_TEST_FUNCTION("[bleSps]", "bleSps")
 
 #endif
 
+#if defined(U_CFG_BLE_MODULE_INTERNAL) && defined(U_BLE_TEST_CFG_REMOTE_SPS_CENTRAL) && \
+    defined(U_BLE_TEST_CFG_REMOTE_SPS_PERIPHERAL)
+/** Test that uBleSpsSendQueued() shares the link fairly between
+ * two channels which have both queued data: connect to both BLE
+ * test peers, fill the transmit queues of both channels and check
+ * that, when one channel has emptied, the other has sent at least
+ * half of its data; then give the second channel the maximum
+ * priority and check that it empties first.
+ */
+U_PORT_TEST_FUNCTION("[bleSps]", "bleSpsSendQueuedFair")
+{
+    int32_t heapUsed;
+    uBleCfg_t cfg;
+    int32_t channel[2];
+    int32_t queued[2];
+    int32_t total[2];
+    int32_t x;
+    bool more;
+    int32_t startTimeMs;
+    size_t empty;
+    size_t other;
+
+    heapUsed = uPortGetHeapFree();
+
+    U_PORT_TEST_ASSERT(uBleTestPrivatePreamble(U_BLE_MODULE_TYPE_INTERNAL,
+                                               NULL,
+                                               &gHandles) == 0);
+    cfg.role = U_BLE_CFG_ROLE_CENTRAL;
+    cfg.spsServer = false;
+    U_PORT_TEST_ASSERT(uBleCfgConfigure(gHandles.devHandle, &cfg) == 0);
+
+    U_PORT_TEST_ASSERT(uPortSemaphoreCreate(&gConnectionSem, 0, 1) == 0);
+    gNumConnected = 0;
+    gErrors = 0;
+    memset((void *) gBytesReceived, 0, sizeof(gBytesReceived));
+    U_PORT_TEST_ASSERT(uBleSpsSetCallbackConnectionStatus(gHandles.devHandle,
+                                                          spsConnectionCallback,
+                                                          NULL) == 0);
+    U_PORT_TEST_ASSERT(uBleSpsSetDataAvailableCallback(gHandles.devHandle,
+                                                       spsReceiveCallback,
+                                                       NULL) == 0);
+
+    for (size_t y = 0; y < 2; y++) {
+        channel[y] = connectSps(gpRemoteSpsAddress[y]);
+        U_PORT_TEST_ASSERT(channel[y] >= 0);
+        total[y] = 0;
+    }
+    U_PORT_TEST_ASSERT(channel[0] != channel[1]);
+
+    // The priority must be in range
+    U_PORT_TEST_ASSERT(uBleSpsSetSendPriority(gHandles.devHandle, channel[0], 0) < 0);
+    U_PORT_TEST_ASSERT(uBleSpsSetSendPriority(gHandles.devHandle, channel[0],
+                                              U_BLE_SPS_TX_PRIORITY_MAX + 1) < 0);
+
+    // First with equal priority, then with the second channel
+    // favoured
+    for (int32_t round = 0; round < 2; round++) {
+        U_PORT_TEST_ASSERT(uBleSpsSetSendPriority(gHandles.devHandle, channel[0], 1) == 0);
+        U_PORT_TEST_ASSERT(uBleSpsSetSendPriority(gHandles.devHandle, channel[1],
+                                                  round == 0 ? 1 : U_BLE_SPS_TX_PRIORITY_MAX) == 0);
+        // Fill both transmit queues, a piece at a time on each
+        // so that neither gets a head start
+        queued[0] = 0;
+        queued[1] = 0;
+        do {
+            more = false;
+            for (size_t y = 0; y < 2; y++) {
+                if (queued[y] < U_BLE_SPS_TX_QUEUE_SIZE) {
+                    // Carry on from where the pattern left off
+                    x = total[y] % (int32_t) (sizeof(gTestData) - 1);
+                    x = uBleSpsSendQueued(gHandles.devHandle, channel[y], gTestData + x,
+                                          (int32_t) (sizeof(gTestData) - 1) - x);
+                    U_PORT_TEST_ASSERT(x >= 0);
+                    queued[y] += x;
+                    total[y] += x;
+                    if (x > 0) {
+                        more = true;
+                    }
+                }
+            }
+        } while (more);
+        U_TEST_PRINT_LINE("round %d: queued %d and %d byte(s).", round + 1,
+                          queued[0], queued[1]);
+        // Wait for one of them to empty
+        startTimeMs = uPortGetTickTimeMs();
+        do {
+            uPortTaskBlock(10);
+            for (size_t y = 0; y < 2; y++) {
+                queued[y] = uBleSpsSendQueuedSize(gHandles.devHandle, channel[y]);
+                U_PORT_TEST_ASSERT(queued[y] >= 0);
+            }
+        } while ((queued[0] > 0) && (queued[1] > 0) &&
+                 (uPortGetTickTimeMs() - startTimeMs < U_BLE_SPS_TEST_TIMEOUT_MS));
+        U_TEST_PRINT_LINE("round %d: %d and %d byte(s) still queued.", round + 1,
+                          queued[0], queued[1]);
+        empty = (queued[0] == 0) ? 0 : 1;
+        other = 1 - empty;
+        U_PORT_TEST_ASSERT(queued[empty] == 0);
+        if (round == 0) {
+            U_PORT_TEST_ASSERT(queued[other] <= U_BLE_SPS_TX_QUEUE_SIZE / 2);
+        } else {
+            U_PORT_TEST_ASSERT(empty == 1);
+        }
+        // Wait for everything to be sent and echoed back
+        startTimeMs = uPortGetTickTimeMs();
+        while (((gBytesReceived[channel[0]] < total[0]) ||
+                (gBytesReceived[channel[1]] < total[1])) &&
+               (uPortGetTickTimeMs() - startTimeMs < U_BLE_SPS_TEST_TIMEOUT_MS)) {
+            uPortTaskBlock(100);
+        }
+        U_TEST_PRINT_LINE("round %d: %d and %d byte(s) received, %d error(s).",
+                          round + 1, gBytesReceived[channel[0]],
+                          gBytesReceived[channel[1]], gErrors);
+        U_PORT_TEST_ASSERT(gBytesReceived[channel[0]] == total[0]);
+        U_PORT_TEST_ASSERT(gBytesReceived[channel[1]] == total[1]);
+        U_PORT_TEST_ASSERT(gErrors == 0);
+    }
+
+    for (size_t y = 0; y < 2; y++) {
+        U_PORT_TEST_ASSERT(disconnectSps(channel[y]));
+    }
+    U_PORT_TEST_ASSERT(gNumConnected == 0);
+
+    uBleSpsSetDataAvailableCallback(gHandles.devHandle, NULL, NULL);
+    uBleSpsSetCallbackConnectionStatus(gHandles.devHandle, NULL, NULL);
+    U_PORT_TEST_ASSERT(uPortSemaphoreDelete(gConnectionSem) == 0);
+    gConnectionSem = NULL;
+
+    cfg.role = U_BLE_CFG_ROLE_DISABLED;
+    U_PORT_TEST_ASSERT(uBleCfgConfigure(gHandles.devHandle, &cfg) == 0);
+
+    uBleTestPrivatePostamble(&gHandles);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+#endif
+
+#if defined(U_CFG_BLE_MODULE_INTERNAL) && (defined(U_BLE_TEST_CFG_REMOTE_SPS_CENTRAL) || \
+                                            defined(U_BLE_TEST_CFG_REMOTE_SPS_PERIPHERAL))
+/** Test the cache of SPS server handles: after a flush the first
+ * connection to a BLE test peer must perform discovery, a reconnect
+ * must take the same handles from the cache, preset handles must
+ * take precedence over the cache and, after another flush, discovery
+ * must be performed again.
+ */
+U_PORT_TEST_FUNCTION("[bleSps]", "bleSpsServerHandlesCache")
+{
+    int32_t heapUsed;
+    uBleCfg_t cfg;
+    int32_t channel;
+    int32_t startTimeMs;
+    uBleSpsHandles_t handlesDiscovered;
+    uBleSpsHandles_t handles;
+
+    heapUsed = uPortGetHeapFree();
+
+    U_PORT_TEST_ASSERT(uBleTestPrivatePreamble(U_BLE_MODULE_TYPE_INTERNAL,
+                                               NULL,
+                                               &gHandles) == 0);
+    cfg.role = U_BLE_CFG_ROLE_CENTRAL;
+    cfg.spsServer = false;
+    U_PORT_TEST_ASSERT(uBleCfgConfigure(gHandles.devHandle, &cfg) == 0);
+
+    U_PORT_TEST_ASSERT(uPortSemaphoreCreate(&gConnectionSem, 0, 1) == 0);
+    gNumConnected = 0;
+    U_PORT_TEST_ASSERT(uBleSpsSetCallbackConnectionStatus(gHandles.devHandle,
+                                                          spsConnectionCallback,
+                                                          NULL) == 0);
+
+    U_PORT_TEST_ASSERT(uBleSpsFlushServerHandlesCache(gHandles.devHandle) == 0);
+
+    // First connection: discovery
+    startTimeMs = uPortGetTickTimeMs();
+    channel = connectSps(gpRemoteSpsAddress[0]);
+    U_PORT_TEST_ASSERT(channel >= 0);
+    U_TEST_PRINT_LINE("connecting with discovery took %d ms.",
+                      uPortGetTickTimeMs() - startTimeMs);
+    U_PORT_TEST_ASSERT(!uBleSpsPrivateHandlesFromCache(channel));
+    U_PORT_TEST_ASSERT(uBleSpsGetSpsServerHandles(gHandles.devHandle, channel,
+                                                  &handlesDiscovered) == 0);
+    U_PORT_TEST_ASSERT(handlesDiscovered.service != 0);
+    U_PORT_TEST_ASSERT(disconnectSps(channel));
+
+    // Reconnect: the handles should come from the cache
+    startTimeMs = uPortGetTickTimeMs();
+    channel = connectSps(gpRemoteSpsAddress[0]);
+    U_PORT_TEST_ASSERT(channel >= 0);
+    U_TEST_PRINT_LINE("connecting with cached handles took %d ms.",
+                      uPortGetTickTimeMs() - startTimeMs);
+    U_PORT_TEST_ASSERT(uBleSpsPrivateHandlesFromCache(channel));
+    U_PORT_TEST_ASSERT(uBleSpsGetSpsServerHandles(gHandles.devHandle, channel,
+                                                  &handles) == 0);
+    U_PORT_TEST_ASSERT(memcmp(&handles, &handlesDiscovered, sizeof(handles)) == 0);
+    U_PORT_TEST_ASSERT(disconnectSps(channel));
+
+    // Preset handles take precedence over the cache
+    U_PORT_TEST_ASSERT(uBleSpsPresetSpsServerHandles(gHandles.devHandle,
+                                                     &handlesDiscovered) == 0);
+    channel = connectSps(gpRemoteSpsAddress[0]);
+    U_PORT_TEST_ASSERT(channel >= 0);
+    U_PORT_TEST_ASSERT(!uBleSpsPrivateHandlesFromCache(channel));
+    U_PORT_TEST_ASSERT(disconnectSps(channel));
+
+    // Flush: discovery again
+    U_PORT_TEST_ASSERT(uBleSpsFlushServerHandlesCache(gHandles.devHandle) == 0);
+    channel = connectSps(gpRemoteSpsAddress[0]);
+    U_PORT_TEST_ASSERT(channel >= 0);
+    U_PORT_TEST_ASSERT(!uBleSpsPrivateHandlesFromCache(channel));
+    U_PORT_TEST_ASSERT(uBleSpsGetSpsServerHandles(gHandles.devHandle, channel,
+                                                  &handles) == 0);
+    U_PORT_TEST_ASSERT(memcmp(&handles, &handlesDiscovered, sizeof(handles)) == 0);
+    U_PORT_TEST_ASSERT(disconnectSps(channel));
+    U_PORT_TEST_ASSERT(gNumConnected == 0);
+
+    uBleSpsSetCallbackConnectionStatus(gHandles.devHandle, NULL, NULL);
+    U_PORT_TEST_ASSERT(uPortSemaphoreDelete(gConnectionSem) == 0);
+    gConnectionSem = NULL;
+
+    cfg.role = U_BLE_CFG_ROLE_DISABLED;
+    U_PORT_TEST_ASSERT(uBleCfgConfigure(gHandles.devHandle, &cfg) == 0);
+
+    uBleTestPrivatePostamble(&gHandles);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+#endif
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
@@ -184,6 +554,13 @@ U_PORT_TEST_FUNCTION("[bleSps]", "bleSpsCleanUp")
 {
     int32_t x;
 
+#if defined(U_CFG_BLE_MODULE_INTERNAL) && (defined(U_BLE_TEST_CFG_REMOTE_SPS_CENTRAL) || \
+                                            defined(U_BLE_TEST_CFG_REMOTE_SPS_PERIPHERAL))
+    if (gConnectionSem != NULL) {
+        uPortSemaphoreDelete(gConnectionSem);
+        gConnectionSem = NULL;
+    }
+#endif
     uBleDeinit();
     if (gHandles.edmStreamHandle >= 0) {
         uShortRangeEdmStreamClose(gHandles.edmStreamHandle);
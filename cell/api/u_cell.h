@@ -202,7 +202,12 @@ void uCellDeinit();
  * is likely different to that from the MCU: check the
  * data sheet for the module to determine the mapping.
  *
- * @param moduleType       the cellular module type.
+ * @param moduleType       the cellular module type; if the driver
+ *                         is built with U_CFG_CELL_MODULE_FIXED
+ *                         defined (e.g. to #U_CELL_MODULE_TYPE_SARA_R5),
+ *                         so that the code for other module types
+ *                         may be removed by the compiler, this must
+ *                         be that module type.
  * @param atHandle         the handle of the AT client to use.  This must
  *                         already have been created by the caller with
  *                         a buffer of size #U_CELL_AT_BUFFER_LENGTH_BYTES.
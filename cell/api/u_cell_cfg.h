@@ -381,6 +381,24 @@ int32_t uCellCfgSetAutoBaudOn(uDeviceHandle_t cellHandle);
  */
 bool uCellCfgAutoBaudIsOn(uDeviceHandle_t cellHandle);
 
+/** Set the real-time clock of the cellular module (AT+CCLK) to the
+ * given UTC time, with a time zone of zero.  This is useful after
+ * a cold boot, where the module will otherwise not know the time
+ * until the network has provided it (NITZ), something that
+ * certificate validation for a secure connection may be waiting
+ * on; see uDeviceTimeSetFromGnss() for a way to do this from a
+ * GNSS device.  Note that the network may later overwrite the time.
+ *
+ * @param cellHandle   the handle of the cellular instance.
+ * @param timeUtc      the UTC time in seconds since midnight on
+ *                     1st January 1970; must be in the years 2000
+ *                     to 2099 since the module takes a two-digit
+ *                     year.
+ * @return             zero on success or negative error code on
+ *                     failure.
+ */
+int32_t uCellCfgSetTimeUtc(uDeviceHandle_t cellHandle, int64_t timeUtc);
+
 #ifdef __cplusplus
 }
 #endif
@@ -48,6 +48,20 @@ extern "C" {
  */
 #define U_CELL_FILE_NAME_MAX_LENGTH 248
 
+#ifndef U_CELL_FILE_STREAM_READ_CHUNK_SIZE_BYTES
+/** The size of each block requested from the module by
+ * uCellFileStreamRead() if a chunk size of zero is given.
+ */
+# define U_CELL_FILE_STREAM_READ_CHUNK_SIZE_BYTES 1024
+#endif
+
+#ifndef U_CELL_FILE_STREAM_WRITE_CHUNK_SIZE_BYTES
+/** The size of the buffer that uCellFileStreamWrite() allocates,
+ * and asks its callback to fill, if a chunk size of zero is given.
+ */
+# define U_CELL_FILE_STREAM_WRITE_CHUNK_SIZE_BYTES 256
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -109,6 +123,55 @@ int32_t uCellFileWrite(uDeviceHandle_t cellHandle,
                        const char *pData,
                        size_t dataSize);
 
+/** As uCellFileWrite() but, rather than the data being passed in
+ * all in one buffer, it is pulled from a callback a chunk at a time,
+ * so that large files (e.g. from flash) can be written to the file
+ * system of the module at the speed of the interface without
+ * needing RAM for the whole of it: a single buffer of chunkSize
+ * bytes is allocated for the duration.  The total size of the data
+ * must be known in advance.  If the callback is unable to supply
+ * all of the data there is no way to cancel the transfer; the
+ * module will eventually time out, in which case what it does
+ * with the file is module-dependent.  As for uCellFileWrite(), if
+ * the file already exists the data will be appended to it.
+ *
+ * IMPORTANT: the callback is called with the AT interface locked:
+ * it must NOT call any cellular API function.
+ *
+ * @param cellHandle      the handle of the cellular instance.
+ * @param[in] pFileName   a pointer to file name to be stored on file
+ *                        system. File name cannot contain these
+ *                        characters: / * : % | " < > ?.
+ * @param dataSize        the total number of bytes that will be
+ *                        written.
+ * @param[in] pCallback   the function that supplies the data; cannot
+ *                        be NULL.  The parameters are the cellular
+ *                        handle, a buffer to write the data into,
+ *                        the number of bytes wanted (never more than
+ *                        chunkSize), the offset of those bytes from
+ *                        the start of the data and pCallbackParam.
+ *                        The callback should return the number of
+ *                        bytes it has written to the buffer, which
+ *                        may be fewer than were asked for (though
+ *                        not zero) or a negative error code to give
+ *                        up, in which case that error code will be
+ *                        returned by this function.
+ * @param[in] pCallbackParam  a parameter that will be passed to
+ *                        pCallback as its last parameter; may be NULL.
+ * @param chunkSize       the size of buffer to pass to pCallback; use
+ *                        zero for #U_CELL_FILE_STREAM_WRITE_CHUNK_SIZE_BYTES.
+ * @return                on success the number of bytes written
+ *                        (i.e. dataSize), else negative error code.
+ */
+int32_t uCellFileStreamWrite(uDeviceHandle_t cellHandle,
+                             const char *pFileName,
+                             size_t dataSize,
+                             int32_t (*pCallback) (uDeviceHandle_t,
+                                                   char *, size_t,
+                                                   size_t, void *),
+                             void *pCallbackParam,
+                             size_t chunkSize);
+
 /** Read the contents of a file from the file system. If the file does not exist,
  * error will be return. In order to avoid character loss it is recommended
  * that flow control lines are connected on the interface to the module.
@@ -150,6 +213,51 @@ int32_t uCellFileBlockRead(uDeviceHandle_t cellHandle,
                            size_t offset,
                            size_t dataSize);
 
+/** Read the whole of a file from the file system, block by block,
+ * passing the contents to a callback as they arrive.  This is
+ * much faster than calling uCellFileBlockRead() repeatedly since
+ * the AT interface is held for the whole transfer, each AT+URDBLOCK
+ * following straight on from the previous one, and the data is
+ * passed to the callback directly from the receive buffer of the
+ * AT client, without being copied.  As for uCellFileBlockRead(),
+ * tags are NOT supported and it is recommended that the flow
+ * control lines are connected on the interface to the module.
+ *
+ * IMPORTANT: the callback is called with the AT interface locked:
+ * it must NOT call any cellular API function and should return
+ * quickly, e.g. by writing the data to storage.
+ *
+ * @param cellHandle      the handle of the cellular instance.
+ * @param[in] pFileName   a pointer to the name of the file to read.
+ *                        File name cannot contain these characters:
+ *                        / * : % | " < > ?.
+ * @param[in] pCallback   the function to call with each piece of
+ *                        data; cannot be NULL.  The parameters are
+ *                        the cellular handle, a pointer to the data
+ *                        (valid only for the duration of the call),
+ *                        the number of bytes at that pointer, which
+ *                        may be fewer than chunkSize since the receive
+ *                        buffer of the AT client may be smaller, the
+ *                        offset of the data from the start of the file
+ *                        and pCallbackParam.  The callback should return
+ *                        true to continue or false to stop the read.
+ * @param[in] pCallbackParam  a parameter that will be passed to
+ *                        pCallback as its last parameter; may be NULL.
+ * @param chunkSize       the number of bytes to request from the module
+ *                        in each AT+URDBLOCK; use zero for
+ *                        #U_CELL_FILE_STREAM_READ_CHUNK_SIZE_BYTES.
+ * @return                on success the number of bytes passed to
+ *                        pCallback, else negative error code.
+ */
+int32_t uCellFileStreamRead(uDeviceHandle_t cellHandle,
+                            const char *pFileName,
+                            bool (*pCallback) (uDeviceHandle_t,
+                                               const char *,
+                                               size_t, size_t,
+                                               void *),
+                            void *pCallbackParam,
+                            size_t chunkSize);
+
 /** Read size of file on the file system. If the file does not exists,
  * error will be return.
  *
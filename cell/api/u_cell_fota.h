@@ -132,6 +132,45 @@ typedef struct {
     } value;
 } uCellFotaStatus_t;
 
+/** The progress of a FOTA download, as worked out by this code
+ * from the timing of the download percentage reports of the module,
+ * see uCellFotaGetProgress().
+ */
+typedef struct {
+    int32_t percentage;         /**< the latest download percentage
+                                     reported by the module, -1 if
+                                     none has been reported yet. */
+    bool inProgress;            /**< true if a download has started
+                                     and has not yet completed or
+                                     failed. */
+    int32_t numStarts;          /**< the number of times the module
+                                     has reported the start of a
+                                     download since the status
+                                     callback was set; more than one
+                                     means that the download has been
+                                     interrupted and begun again. */
+    int32_t startPercentage;    /**< the first percentage reported
+                                     by the module for the current
+                                     download attempt, -1 if none
+                                     yet; if the module resumed an
+                                     interrupted download, rather than
+                                     starting it again from scratch,
+                                     this will be well above zero. */
+    int32_t elapsedMs;          /**< the time since the start of the
+                                     current download attempt. */
+    int32_t percentPerMinuteX100; /**< the rate of the current download
+                                       attempt in hundredths of a percent
+                                       per minute, -1 if not yet known. */
+    int32_t bytesPerSecond;     /**< the rate of the current download
+                                     attempt in bytes per second, -1
+                                     if not yet known or if the size
+                                     of the package was not given to
+                                     uCellFotaGetProgress(). */
+    int32_t etaSeconds;         /**< the estimated number of seconds
+                                     until the current download attempt
+                                     completes, -1 if not yet known. */
+} uCellFotaProgress_t;
+
 /** Function signature of the FOTA status callback.
  */
 typedef void (uCellFotaStatusCallback_t) (uDeviceHandle_t cellHandle,
@@ -173,6 +212,32 @@ int32_t uCellFotaSetStatusCallback(uDeviceHandle_t cellHandle,
                                    uCellFotaStatusCallback_t *pCallback,
                                    void *pCallbackParameter);
 
+/** Get the progress of a FOTA download: the rate and the estimated
+ * time to completion are worked out from the timing of the download
+ * percentage reports of the module, hence this only works while a
+ * callback is set with uCellFotaSetStatusCallback().  It may be
+ * called, for instance, from that callback each time a status of type
+ * #U_CELL_FOTA_STATUS_TYPE_PERCENTAGE_DOWNLOAD arrives, giving a
+ * progress stream that would allow an application to, say, defer a
+ * download that is going too slowly to a time of better coverage.
+ *
+ * Note that whether an interrupted download is resumed or started
+ * again from scratch is decided by the module and the FOTA server,
+ * there is no AT command to control it; the startPercentage
+ * and numStarts fields of #uCellFotaProgress_t show what happened.
+ *
+ * @param cellHandle       the handle of the cellular instance.
+ * @param packageSizeBytes the size of the firmware package, if known
+ *                         (e.g. from the FOTA server), in which case
+ *                         bytesPerSecond will be populated, else zero.
+ * @param[out] pProgress   a place to put the progress; cannot be NULL.
+ * @return                 zero on success or negative error code on
+ *                         failure.
+ */
+int32_t uCellFotaGetProgress(uDeviceHandle_t cellHandle,
+                             int32_t packageSizeBytes,
+                             uCellFotaProgress_t *pProgress);
+
 #ifdef __cplusplus
 }
 #endif
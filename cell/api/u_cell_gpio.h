@@ -55,6 +55,22 @@ extern "C" {
                                              (num) == 3 ? U_CELL_GPIO_3 : (num) == 4 ? U_CELL_GPIO_4 : \
                                              (num) == 5 ? U_CELL_GPIO_5 : (num) == 6 ? U_CELL_GPIO_6 : U_CELL_GPIO_UNKNOWN)
 
+/** Macro helper: form the bit representing the given GPIO ID in
+ * the masks used by uCellGpioSetMulti() and uCellGpioGetMulti(),
+ * e.g. U_CELL_GPIO_MASK(U_CELL_GPIO_1) | U_CELL_GPIO_MASK(U_CELL_GPIO_2).
+ */
+#define U_CELL_GPIO_MASK(gpioId) (1ULL << (gpioId))
+
+#ifndef U_CELL_GPIO_MULTI_PIPELINE_WINDOW
+/** The number of AT+UGPIOW/AT+UGPIOR commands that
+ * uCellGpioSetMulti() and uCellGpioGetMulti() will send to the
+ * module back-to-back, without waiting for a response, see
+ * uAtClientPipeline(); set this to 1 to send the commands one at
+ * a time.
+ */
+# define U_CELL_GPIO_MULTI_PIPELINE_WINDOW 8
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -153,6 +169,49 @@ int32_t uCellGpioSet(uDeviceHandle_t cellHandle, uCellGpioName_t gpioId,
  */
 int32_t uCellGpioGet(uDeviceHandle_t cellHandle, uCellGpioName_t gpioId);
 
+/** Set the state of several GPIOs of a cellular module in one go:
+ * the AT+UGPIOW commands are sent to the module back-to-back under
+ * a single AT lock, up to #U_CELL_GPIO_MULTI_PIPELINE_WINDOW at
+ * a time, so that the time taken is close to that of setting a
+ * single GPIO.  The GPIOs must already have been configured as
+ * outputs with uCellGpioConfig().  As with uCellGpioSet() the
+ * GPIO ID is used, NOT the number on the end of the pin name:
+ * use #U_CELL_GPIO_MASK to form the masks.  Should one of the
+ * GPIOs fail all the others are still set.
+ *
+ * @param cellHandle    the handle of the cellular instance.
+ * @param gpioMask      the GPIOs to set, a bit for each GPIO ID,
+ *                      bit 0 being GPIO ID 0.
+ * @param levelMask     the levels to set, a bit for each GPIO ID,
+ *                      set for high, clear for low; bits not in
+ *                      gpioMask are ignored.
+ * @return              zero on success else the negative error
+ *                      code of the first GPIO that could not be set.
+ */
+int32_t uCellGpioSetMulti(uDeviceHandle_t cellHandle, uint64_t gpioMask,
+                          uint64_t levelMask);
+
+/** Get the state of several GPIOs of a cellular module in one go:
+ * the AT+UGPIOR commands are sent to the module back-to-back under
+ * a single AT lock, up to #U_CELL_GPIO_MULTI_PIPELINE_WINDOW at
+ * a time.  As with uCellGpioGet() the GPIO ID is used, NOT the
+ * number on the end of the pin name: use #U_CELL_GPIO_MASK to
+ * form the mask.
+ *
+ * @param cellHandle      the handle of the cellular instance.
+ * @param gpioMask        the GPIOs to read, a bit for each GPIO ID,
+ *                        bit 0 being GPIO ID 0.
+ * @param[out] pLevelMask a place to put the levels read, a bit set
+ *                        for each GPIO in gpioMask that is high; bits
+ *                        not in gpioMask will be clear.  Cannot be NULL.
+ * @return                zero on success else the negative error
+ *                        code of the first GPIO that could not be
+ *                        read, in which case the bit for that GPIO
+ *                        in pLevelMask will be clear.
+ */
+int32_t uCellGpioGetMulti(uDeviceHandle_t cellHandle, uint64_t gpioMask,
+                          uint64_t *pLevelMask);
+
 /** Set the state of the CTS line: this may be used if the
  * serial handshaking lines are NOT being used (they were both
  * -1 in the #uNetworkCfgCell_t structure or the
@@ -58,10 +58,61 @@ extern "C" {
  */
 #define U_CELL_INFO_ICCID_BUFFER_SIZE 21
 
+#ifndef U_CELL_INFO_RADIO_SAMPLER_PERIOD_MIN_MS
+/** The minimum period that may be given to
+ * uCellInfoRadioSamplerStart(), in milliseconds.
+ */
+# define U_CELL_INFO_RADIO_SAMPLER_PERIOD_MIN_MS 1000
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** A snapshot of the radio parameters, as taken by the background
+ * sampler and returned by uCellInfoRadioSamplerGet().  The values
+ * have the same meaning as those returned by uCellInfoGetRssiDbm(),
+ * uCellInfoGetRsrpDbm() etc.
+ */
+typedef struct {
+    int32_t rssiDbm;   /**< the RSSI, 0 if not known. */
+    int32_t rsrpDbm;   /**< the RSRP, 0 if not known. */
+    int32_t rsrqDb;    /**< the RSRQ, 0x7FFFFFFF if not known. */
+    int32_t rxQual;    /**< the RxQual, -1 if not known. */
+    int32_t snrDb;     /**< the SNR, as uCellInfoGetSnrDb(), INT_MIN
+                            if it could not be calculated. */
+    int32_t cellId;    /**< the cell ID, -1 if not known. */
+    int32_t earfcn;    /**< the EARFCN, -1 if not known. */
+    int32_t errorCode; /**< the outcome of taking this sample: zero
+                            on success, #U_CELL_ERROR_NOT_REGISTERED
+                            if the module was not registered, else
+                            negative error code. */
+    int32_t timeMs;    /**< the value of uPortGetTickTimeMs() when
+                            the sample was completed. */
+    uint32_t count;    /**< the number of samples so far; this
+                            increments with each new sample. */
+} uCellInfoRadioSample_t;
+
+/** The storage for the snapshot maintained by the background
+ * sampler: the application must provide this, it must persist
+ * from uCellInfoRadioSamplerStart() until uCellInfoRadioSamplerStop()
+ * has returned and the contents should be treated as private.
+ */
+typedef struct {
+    volatile uint32_t sequence; /**< incremented before and after
+                                     the fields below are written. */
+    volatile int32_t rssiDbm;
+    volatile int32_t rsrpDbm;
+    volatile int32_t rsrqDb;
+    volatile int32_t rxQual;
+    volatile int32_t snrDb;
+    volatile int32_t cellId;
+    volatile int32_t earfcn;
+    volatile int32_t errorCode;
+    volatile int32_t timeMs;
+    volatile uint32_t count;
+} uCellInfoRadioSampler_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -167,7 +218,74 @@ int32_t uCellInfoGetCellId(uDeviceHandle_t cellHandle);
  */
 int32_t uCellInfoGetEarfcn(uDeviceHandle_t cellHandle);
 
-/** Get the IMEI of the cellular module.
+/** Start a background task which, every periodMs, takes a sample
+ * of the radio parameters, exactly as uCellInfoRefreshRadioParameters()
+ * would, and publishes it to pSampler, from where it may be read
+ * at any time with uCellInfoRadioSamplerGet() without waiting for
+ * the AT interface.  The task runs at a low priority and releases
+ * the cellular API between each AT command it sends so that
+ * application calls are held up by at most one AT command; if
+ * those calls keep the cellular API busy the sample is simply
+ * delayed.  The values returned by uCellInfoGetRssiDbm() etc. are
+ * also updated with each sample.  Only one sampler may be active
+ * per cellular instance and it must be stopped with
+ * uCellInfoRadioSamplerStop() before pSampler is released; it is
+ * stopped automatically if the cellular instance is removed.
+ *
+ * Note that uCellInfoRadioSamplerGet() avoids taking any locks,
+ * hence it will not block but it may, very rarely, return
+ * #U_ERROR_COMMON_TEMPORARY_FAILURE if it keeps catching the
+ * sampler in the act of writing.
+ *
+ * @param cellHandle          the handle of the cellular instance.
+ * @param[in] pSampler        storage for the snapshot, which must
+ *                            persist until uCellInfoRadioSamplerStop()
+ *                            has returned; cannot be NULL.
+ * @param periodMs            the interval between samples, must be
+ *                            at least #U_CELL_INFO_RADIO_SAMPLER_PERIOD_MIN_MS.
+ * @param[in] pCallback       a function to be called each time a
+ *                            new sample has been published, may be
+ *                            NULL; it is called from the sampler
+ *                            task, which has a small stack, and so
+ *                            should do no more than, for instance,
+ *                            call uCellInfoRadioSamplerGet() or
+ *                            signal a task of the application.
+ * @param[in] pCallbackParam  a parameter that will be passed to
+ *                            pCallback; may be NULL.
+ * @return                    zero on success else negative error code.
+ */
+int32_t uCellInfoRadioSamplerStart(uDeviceHandle_t cellHandle,
+                                   uCellInfoRadioSampler_t *pSampler,
+                                   int32_t periodMs,
+                                   void (*pCallback) (uDeviceHandle_t cellHandle,
+                                                      void *pCallbackParam),
+                                   void *pCallbackParam);
+
+/** Get the latest sample published by the background sampler;
+ * this does not communicate with the cellular module, takes no
+ * locks and may be called as often as required, from any task.
+ *
+ * @param[in] pSampler  the storage passed to uCellInfoRadioSamplerStart();
+ *                      cannot be NULL.
+ * @param[out] pSample  a place to put the sample; cannot be NULL.
+ * @return              zero on success, #U_ERROR_COMMON_NOT_FOUND if
+ *                      there is no sample yet, else negative error
+ *                      code.
+ */
+int32_t uCellInfoRadioSamplerGet(const uCellInfoRadioSampler_t *pSampler,
+                                 uCellInfoRadioSample_t *pSample);
+
+/** Stop the background sampler; once this has returned the storage
+ * passed to uCellInfoRadioSamplerStart() may be released, the latest
+ * sample remaining readable with uCellInfoRadioSamplerGet() until then.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ */
+void uCellInfoRadioSamplerStop(uDeviceHandle_t cellHandle);
+
+/** Get the IMEI of the cellular module.  The IMEI is read from
+ * the module once and then cached until the module is powered off
+ * or rebooted.
  *
  * @param cellHandle  the handle of the cellular instance.
  * @param[out] pImei  a pointer to #U_CELL_INFO_IMEI_SIZE bytes
@@ -181,7 +299,10 @@ int32_t uCellInfoGetEarfcn(uDeviceHandle_t cellHandle);
 int32_t uCellInfoGetImei(uDeviceHandle_t cellHandle,
                          char *pImei);
 
-/** Get the IMSI of the SIM in the cellular module.
+/** Get the IMSI of the SIM in the cellular module.  The IMSI
+ * is read from the module once and then cached until the module is
+ * powered off or rebooted or its radio is switched off (e.g. by
+ * uCellNetDisconnect()), since the SIM might then be changed.
  *
  * @param cellHandle  the handle of the cellular instance.
  * @param[out] pImsi  a pointer to #U_CELL_INFO_IMSI_SIZE bytes
@@ -199,7 +320,8 @@ int32_t uCellInfoGetImsi(uDeviceHandle_t cellHandle,
  * that, while the ICCID is all numeric digits, like the IMEI and
  * the IMSI, the length of the ICCID can vary between 19 and 20
  * digits; it is treated as a string here because of that variable
- * length.
+ * length.  The ICCID is cached in the same way as the IMSI, see
+ * uCellInfoGetImsi().
  *
  * @param cellHandle  the handle of the cellular instance.
  * @param[out] pStr   a pointer to size bytes of storage into which
@@ -219,7 +341,8 @@ int32_t uCellInfoGetIccidStr(uDeviceHandle_t cellHandle,
                              char *pStr, size_t size);
 
 /** Get the manufacturer identification string from the cellular
- * module.
+ * module.  The string is cached in the same way as the IMEI, see
+ * uCellInfoGetImei().
  *
  * @param cellHandle  the handle of the cellular instance.
  * @param[out] pStr   a pointer to size bytes of storage into which
@@ -238,6 +361,8 @@ int32_t uCellInfoGetManufacturerStr(uDeviceHandle_t cellHandle,
                                     char *pStr, size_t size);
 
 /** Get the model identification string from the cellular module.
+ * The string is cached in the same way as the IMEI, see
+ * uCellInfoGetImei().
  *
  * @param cellHandle  the handle of the cellular instance.
  * @param[out] pStr   a pointer to size bytes of storage into which
@@ -256,6 +381,9 @@ int32_t uCellInfoGetModelStr(uDeviceHandle_t cellHandle,
                              char *pStr, size_t size);
 
 /** Get the firmware version string from the cellular module.
+ * The string is cached in the same way as the IMEI, see
+ * uCellInfoGetImei(); this includes being cleared by the reboot
+ * that follows a firmware update.
  *
  * @param cellHandle  the handle of the cellular instance.
  * @param[out] pStr   a pointer to size bytes of storage into which
@@ -78,6 +78,14 @@ extern "C" {
 # define U_CELL_LOC_GNSS_ENABLE_DEFAULT true
 #endif
 
+#ifndef U_CELL_LOC_CACHE_MAX_AGE_DEFAULT_SECONDS
+/** The default maximum age of a cached location fix that may be
+ * returned in place of a new one, see uCellLocSetCacheMaxAge();
+ * zero means that a cached fix is never re-used.
+ */
+# define U_CELL_LOC_CACHE_MAX_AGE_DEFAULT_SECONDS 0
+#endif
+
 #ifndef U_CELL_LOC_BUFFER_LENGTH_BYTES
 /** The length of buffer to use for a Wifi tag string.
  * The maximum AT command-line length is usually 1024
@@ -205,6 +213,35 @@ void uCellLocSetGnssEnable(uDeviceHandle_t cellHandle, bool onNotOff);
  */
 bool uCellLocGetGnssEnable(uDeviceHandle_t cellHandle);
 
+/** Set how long a location fix may be re-used.  If this is non-zero
+ * then, when a location is requested with uCellLocGet() or
+ * uCellLocGetStart(), the serving cell is read from the module
+ * (using AT+UCGED, so this is only of benefit with modules that
+ * report a cell ID there, e.g. SARA-R4/R5) and, if the last
+ * successful fix was obtained in the same cell (same cell ID and
+ * EARFCN) less than maxAgeSeconds ago and its radius is no worse
+ * than the desired accuracy, that fix is returned immediately
+ * without contacting the Cell Locate service, saving the data and
+ * power a fresh fix would cost.  The cache is not cleared by
+ * changing this setting.
+ *
+ * @param cellHandle     the handle of the cellular instance.
+ * @param maxAgeSeconds  the maximum age of a cached fix in seconds;
+ *                       zero (the default, see
+ *                       #U_CELL_LOC_CACHE_MAX_AGE_DEFAULT_SECONDS)
+ *                       means always obtain a fresh fix.
+ */
+void uCellLocSetCacheMaxAge(uDeviceHandle_t cellHandle,
+                            int32_t maxAgeSeconds);
+
+/** Get the maximum age of a location fix that may be re-used.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @return            the maximum age of a cached fix in seconds
+ *                    or negative error code.
+ */
+int32_t uCellLocGetCacheMaxAge(uDeviceHandle_t cellHandle);
+
 /** Set the cellular module pin which enables power to the
  * GNSS chip.  This is the pin number of the cellular module so,
  * for instance, GPIO2 is cellular module pin 23 and hence 23 would
@@ -384,6 +421,36 @@ int32_t uCellLocGetStart(uDeviceHandle_t cellHandle,
                                             int32_t svs,
                                             int64_t timeUtc));
 
+/** Get the last successful location fix, whatever its age and
+ * whichever cell it was obtained in; this does not communicate
+ * with the module and so returns immediately.  It may be used,
+ * for instance, to provide a provisional answer while a fresh fix
+ * is being obtained with uCellLocGetStart().  Unlike the cache
+ * itself (see uCellLocSetCacheMaxAge()) this is always available.
+ *
+ * @param cellHandle                       the handle of the cellular instance.
+ * @param[out] pLatitudeX1e7               as uCellLocGet(); may be NULL.
+ * @param[out] pLongitudeX1e7              as uCellLocGet(); may be NULL.
+ * @param[out] pAltitudeMillimetres        as uCellLocGet(); may be NULL.
+ * @param[out] pRadiusMillimetres          as uCellLocGet(); may be NULL.
+ * @param[out] pSpeedMillimetresPerSecond  as uCellLocGet(); may be NULL.
+ * @param[out] pSvs                        as uCellLocGet(); may be NULL.
+ * @param[out] pTimeUtc                    as uCellLocGet(); may be NULL.
+ * @param[out] pAgeSeconds                 a place to put the time since the
+ *                                         fix was obtained in seconds; may
+ *                                         be NULL.
+ * @return                                 zero on success,
+ *                                         #U_ERROR_COMMON_NOT_FOUND if
+ *                                         there has been no successful fix,
+ *                                         else negative error code.
+ */
+int32_t uCellLocGetLast(uDeviceHandle_t cellHandle,
+                        int32_t *pLatitudeX1e7, int32_t *pLongitudeX1e7,
+                        int32_t *pAltitudeMillimetres, int32_t *pRadiusMillimetres,
+                        int32_t *pSpeedMillimetresPerSecond,
+                        int32_t *pSvs, int64_t *pTimeUtc,
+                        int32_t *pAgeSeconds);
+
 /** Get the last status of a location fix attempt.
  *
  * @param cellHandle  the handle of the cellular instance.
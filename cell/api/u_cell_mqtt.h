@@ -69,6 +69,16 @@ extern "C" {
 # define U_CELL_MQTT_PUBLISH_BIN_MAX_LENGTH_BYTES 1024
 #endif
 
+#ifndef U_CELL_MQTT_BINARY_PUBLISH_PROMPT_DELAY_MS
+/** On modules that support binary publish (all except SARA-R41x,
+ * and never for MQTT-SN) a message is published with AT+UMQTTC=9
+ * followed by the raw bytes, which are not sent until this long
+ * after the module has issued its '>' prompt.  This delay is the
+ * main fixed per-message overhead of binary publish.
+ */
+# define U_CELL_MQTT_BINARY_PUBLISH_PROMPT_DELAY_MS 50
+#endif
+
 #ifndef U_CELL_MQTT_WRITE_TOPIC_MAX_LENGTH_BYTES
 /** The maximum length of an MQTT topic used as a filter
  * or in a will message in bytes; this does NOT include
@@ -102,6 +112,66 @@ extern "C" {
 # define U_CELL_MQTT_RETRIES_DEFAULT 2
 #endif
 
+#ifndef U_CELL_MQTT_PUBLISH_ASYNC_QUEUE_LENGTH
+/** The maximum number of messages that may be queued, or be
+ * in progress, with uCellMqttPublishAsync(); each one costs a heap
+ * allocation of the size of the topic plus the message plus a
+ * few tens of bytes until its callback has been called.
+ */
+# define U_CELL_MQTT_PUBLISH_ASYNC_QUEUE_LENGTH 8
+#endif
+
+#ifndef U_CELL_MQTT_PUBLISH_WINDOW_MAX_NUM
+/** The largest publish window that may be set with
+ * uCellMqttSetPublishWindow(), i.e. the maximum number of
+ * messages from uCellMqttPublishAsync() that may be with the
+ * module at once, awaiting the outcome from the broker; each
+ * costs about 12 bytes of stack in the asynchronous publish task.
+ * Must be no more than 32.
+ */
+# define U_CELL_MQTT_PUBLISH_WINDOW_MAX_NUM 8
+#endif
+
+#ifndef U_CELL_MQTT_PUBLISH_WINDOW_DEFAULT
+/** The default publish window, see uCellMqttSetPublishWindow().
+ */
+# define U_CELL_MQTT_PUBLISH_WINDOW_DEFAULT 1
+#endif
+
+#ifndef U_CELL_MQTT_SN_TOPIC_CACHE_MAX_NUM
+/** The number of MQTT-SN normal topic registrations that are
+ * remembered across sessions, see uCellMqttSnRegisterNormalTopic();
+ * the cache is static, costing this many times a little more than
+ * #U_CELL_MQTT_SN_TOPIC_CACHE_NAME_MAX_LENGTH_BYTES of RAM.  Set
+ * to 0 to remove the cache.
+ */
+# define U_CELL_MQTT_SN_TOPIC_CACHE_MAX_NUM 8
+#endif
+
+#ifndef U_CELL_MQTT_SN_TOPIC_CACHE_NAME_MAX_LENGTH_BYTES
+/** The storage for a topic name in the MQTT-SN topic cache,
+ * including the null terminator; registrations of longer topic
+ * names are not cached.
+ */
+# define U_CELL_MQTT_SN_TOPIC_CACHE_NAME_MAX_LENGTH_BYTES 64
+#endif
+
+#ifndef U_CELL_MQTT_AUTO_FETCH_MAX_NUM
+/** The largest number of messages that may be held in the ring
+ * of messages fetched by uCellMqttSetAutoFetch().
+ */
+# define U_CELL_MQTT_AUTO_FETCH_MAX_NUM 8
+#endif
+
+#ifndef U_CELL_MQTT_AUTO_FETCH_MESSAGE_MAX_LENGTH_BYTES
+/** The storage for the message in each entry of the ring of
+ * messages fetched by uCellMqttSetAutoFetch(); longer messages are
+ * truncated.  Each entry also costs
+ * #U_CELL_MQTT_READ_TOPIC_MAX_LENGTH_BYTES plus a few bytes of heap.
+ */
+# define U_CELL_MQTT_AUTO_FETCH_MESSAGE_MAX_LENGTH_BYTES 512
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -153,6 +223,26 @@ typedef struct {
 // *INDENT-ON*
 } uCellMqttSnTopicName_t;
 
+/** Callback that receives a message fetched by the auto-fetch
+ * mechanism, see uCellMqttSetAutoFetch().
+ *
+ * @param cellHandle          the handle of the cellular instance.
+ * @param[in] pTopicNameStr   the null-terminated topic string of
+ *                            the message.
+ * @param[in] pMessage        the message, which may be binary;
+ *                            truncated to
+ *                            #U_CELL_MQTT_AUTO_FETCH_MESSAGE_MAX_LENGTH_BYTES.
+ * @param messageSizeBytes    the number of bytes at pMessage.
+ * @param qos                 the QoS of the message.
+ * @param[in] pCallbackParam  the pCallbackParam passed to
+ *                            uCellMqttSetAutoFetch().
+ */
+typedef void (uCellMqttAutoFetchCallback_t)(uDeviceHandle_t cellHandle,
+                                            const char *pTopicNameStr,
+                                            const char *pMessage,
+                                            size_t messageSizeBytes,
+                                            uCellMqttQos_t qos,
+                                            void *pCallbackParam);
 
 /* ----------------------------------------------------------------
  * FUNCTIONS: MQTT AND MQTT-SN
@@ -632,6 +722,162 @@ int32_t uCellMqttPublish(uDeviceHandle_t cellHandle, const char *pTopicNameStr,
                          size_t messageSizeBytes,
                          uCellMqttQos_t qos, bool retain);
 
+/** Publish an MQTT message without waiting for the publish to
+ * complete: the topic and message are copied into a queue, which
+ * is serviced by a task that is started the first time this function
+ * is called, and the outcome of each publish is reported to
+ * pCallback.  This allows the application to get on with gathering
+ * the next message while the module is exchanging the last one with
+ * the broker.  Messages are published, and their callbacks called,
+ * in the order they were queued.
+ *
+ * By default there is only ever one message outstanding with the
+ * module; uCellMqttSetPublishWindow() may be used to allow more
+ * than one, so that, for instance at QoS 1 over a long round-trip
+ * time, the next publish is sent while the broker is still to
+ * acknowledge the last.  The URC that indicates completion does not
+ * carry the MQTT packet identifier: the message ID given here is
+ * allocated by this API, is not the MQTT packet identifier, and is
+ * simply there to let the application match each callback with its
+ * call to this function.  Retries, and the wait for the broker,
+ * are as for uCellMqttPublish() except that, with a window of more
+ * than one, a publish that the broker fails, or does not respond to,
+ * is not retried.
+ *
+ * The queue is of length #U_CELL_MQTT_PUBLISH_ASYNC_QUEUE_LENGTH:
+ * if it is full #U_ERROR_COMMON_TEMPORARY_FAILURE is returned and the
+ * application should try again when a callback has been called, or
+ * when uCellMqttPublishAsyncGetFree() returns non-zero.  When
+ * uCellMqttDeinit() is called any messages still queued are not sent
+ * and their callbacks are called with #U_ERROR_COMMON_NOT_INITIALISED;
+ * in this case the callback must not call any cellular MQTT API.
+ *
+ * Only supported for MQTT, not MQTT-SN.
+ *
+ * @param cellHandle        the handle of the cellular instance to
+ *                          be used.
+ * @param[in] pTopicNameStr the null-terminated topic string
+ *                          for the message; cannot be NULL.
+ * @param[in] pMessage      a pointer to the message, which is
+ *                          copied and so need not persist once this
+ *                          function has returned; cannot be NULL.
+ * @param messageSizeBytes  the length of pMessage, limits as for
+ *                          uCellMqttPublish().
+ * @param qos               the MQTT QoS to use for this message.
+ * @param retain            if true the message will be retained
+ *                          by the broker across MQTT disconnects/
+ *                          connects.
+ * @param[in] pCallback     the callback to be called, from the
+ *                          task servicing the queue, when the publish
+ *                          has completed, with the message ID that
+ *                          this function returned, zero on success
+ *                          else negative error code and pCallbackParam.
+ *                          The callback may call uCellMqttPublishAsync()
+ *                          but must not call uCellMqttDeinit().
+ *                          May be NULL.
+ * @param[in] pCallbackParam user parameter which will be passed to
+ *                          pCallback; may be NULL.
+ * @return                  on success the message ID, a non-negative
+ *                          number that increments with each call,
+ *                          else negative error code.
+ */
+int32_t uCellMqttPublishAsync(uDeviceHandle_t cellHandle,
+                              const char *pTopicNameStr,
+                              const char *pMessage,
+                              size_t messageSizeBytes,
+                              uCellMqttQos_t qos, bool retain,
+                              void (*pCallback) (uDeviceHandle_t cellHandle,
+                                                 int32_t msgId,
+                                                 int32_t errorCode,
+                                                 void *pCallbackParam),
+                              void *pCallbackParam);
+
+/** Get the number of messages that could be passed to
+ * uCellMqttPublishAsync() right now without it returning
+ * #U_ERROR_COMMON_TEMPORARY_FAILURE.
+ *
+ * @param cellHandle  the handle of the cellular instance to be used.
+ * @return            on success the number of free entries in the
+ *                    asynchronous publish queue, else negative error
+ *                    code.
+ */
+int32_t uCellMqttPublishAsyncGetFree(uDeviceHandle_t cellHandle);
+
+/** Set the publish window for uCellMqttPublishAsync(): the number of
+ * messages that may be sent to the module before the outcome of the
+ * first has been indicated by the module.  The module indicates the
+ * outcomes, without any identifier, in the order the messages were
+ * sent, which is how they are matched; should no outcome arrive
+ * within #U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS, all of the messages
+ * outstanding are completed with #U_ERROR_COMMON_TIMEOUT.  If the
+ * module refuses a publish while others are outstanding, the window
+ * is reduced to the number it has accepted (until this function is
+ * called again) and the refused publish is sent again once one of
+ * those has completed; this means that a module that can only handle
+ * one publish at a time will fall back to that.  Messages published
+ * with uCellMqttPublish() while a window is in use wait until the
+ * messages outstanding have completed.
+ *
+ * Only supported for MQTT, not MQTT-SN, and not on SARA-R4 modules
+ * using the old AT syntax, where the outcome of a publish is only
+ * the response to the AT command.
+ *
+ * @param cellHandle  the handle of the cellular instance to be used.
+ * @param windowSize  the window size, from 1 (the default
+ *                    #U_CELL_MQTT_PUBLISH_WINDOW_DEFAULT, where each
+ *                    publish waits for the outcome of the last) to
+ *                    #U_CELL_MQTT_PUBLISH_WINDOW_MAX_NUM.
+ * @return            zero on success else negative error code.
+ */
+int32_t uCellMqttSetPublishWindow(uDeviceHandle_t cellHandle, size_t windowSize);
+
+/** Get the publish window set with uCellMqttSetPublishWindow().
+ *
+ * @param cellHandle  the handle of the cellular instance to be used.
+ * @return            on success the window size, else negative
+ *                    error code.
+ */
+int32_t uCellMqttGetPublishWindow(uDeviceHandle_t cellHandle);
+
+/** Switch auto-fetch on or off.  With auto-fetch on, as soon as the
+ * module indicates that messages are waiting they are read from the
+ * module, in the background, into a ring of up to numMessages
+ * entries and then handed one at a time to pCallback; this saves
+ * the application having to call uCellMqttGetUnread() and
+ * uCellMqttMessageRead() itself and empties the buffer in the
+ * module quickly when messages arrive in bursts.  Should the ring
+ * fill, the remaining messages are left in the module until
+ * pCallback has emptied it.
+ *
+ * The messages are fetched, and pCallback is called, from the AT
+ * client's callback task: pCallback is not called with anything
+ * locked and so may call this API (including this function, to
+ * switch auto-fetch off), but while it runs no other AT client
+ * callbacks, e.g. the callback set with uCellMqttSetMessageCallback(),
+ * are called; it should return reasonably quickly.
+ *
+ * Only supported for MQTT, not MQTT-SN, and not on SARA-R4 modules
+ * using the old AT syntax, where messages are delivered in a URC.
+ *
+ * @param cellHandle          the handle of the cellular instance to
+ *                            be used.
+ * @param numMessages         the number of messages that the ring
+ *                            may hold, up to
+ *                            #U_CELL_MQTT_AUTO_FETCH_MAX_NUM; use zero
+ *                            to switch auto-fetch off, freeing the
+ *                            ring.
+ * @param[in] pCallback       the callback that will receive messages;
+ *                            cannot be NULL unless numMessages is zero.
+ * @param[in] pCallbackParam  a parameter that will be passed to
+ *                            pCallback.
+ * @return                    zero on success else negative error
+ *                            code.
+ */
+int32_t uCellMqttSetAutoFetch(uDeviceHandle_t cellHandle,
+                              size_t numMessages,
+                              uCellMqttAutoFetchCallback_t *pCallback,
+                              void *pCallbackParam);
+
 /** Subscribe to an MQTT topic. The pKeepGoingCallback()
  * function set during initialisation will be called while
  * this function is waiting for a subscription to complete.
@@ -722,7 +968,18 @@ bool uCellMqttSnIsSupported(uDeviceHandle_t cellHandle);
  * Note that this does NOT subscribe to the topic, it just gets you
  * an ID, you need to call uCellMqttSnSubscribe() to do the subscribing.
  * Must be connected to an MQTT-SN broker for this to work.
-
+ *
+ * If session retention is on (see uCellMqttSetRetainOn()) the
+ * topic ID is remembered, in RAM of this MCU, against the broker
+ * name and client ID given to uCellMqttInit() (the IMEI if there was
+ * no client ID), and a later registration of the same topic name
+ * with the same broker and client ID, e.g. after the module has
+ * been asleep and MQTT-SN reconnected, will return the remembered
+ * ID without contacting the broker.  MQTT-SN provides no way to
+ * find out whether the MQTT-SN gateway has really kept the session,
+ * so only switch session retention on if you know that it does;
+ * should the gateway forget the registrations anyway, call
+ * uCellMqttSnTopicCacheClear() and register again.
  *
  * @param cellHandle         the handle of the cellular instance to
  *                           be used.
@@ -736,6 +993,17 @@ int32_t uCellMqttSnRegisterNormalTopic(uDeviceHandle_t cellHandle,
                                        const char *pTopicNameStr,
                                        uCellMqttSnTopicName_t *pTopicName);
 
+/** MQTT-SN only: forget the topic IDs remembered by
+ * uCellMqttSnRegisterNormalTopic() for the broker and client ID
+ * of the current MQTT-SN session, e.g. because the MQTT-SN gateway
+ * has rejected one of them; the next registration of each topic
+ * name will go to the broker.
+ *
+ * @param cellHandle  the handle of the cellular instance to be used.
+ * @return            zero on success, else negative error code.
+ */
+int32_t uCellMqttSnTopicCacheClear(uDeviceHandle_t cellHandle);
+
 /** MQTT-SN only: publish a message; this differs from uCellMqttPublish()
  * in that it uses an MQTT-SN topic name, which will be a predefined ID
  * or a short name or as returned by uCellMqttSnRegisterNormalTopic()/
@@ -0,0 +1,287 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_CELL_MUX_H_
+#define _U_CELL_MUX_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_device.h"
+
+/** \addtogroup _cell
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the u-blox API for running a
+ * 3GPP TS 27.010 multiplexer (CMUX, basic option) over the UART
+ * to a cellular module, so that several virtual serial channels
+ * share the one UART: for instance the AT commands of the
+ * cellular API on one channel and the UBX/NMEA stream of a GNSS
+ * chip inside or attached to the module on another, so that
+ * neither holds up the other.
+ *
+ * uCellMuxEnable() switches the module into multiplexer mode and
+ * moves the AT client of the cellular instance onto the AT channel,
+ * which is entirely transparent to the rest of the cellular API.
+ * Further channels may be opened with uCellMuxChannelOpen(); each
+ * returns a stream handle which may be passed to uAtClientAdd()
+ * with the stream type #U_AT_CLIENT_STREAM_TYPE_CMUX or used
+ * directly with uCellMuxStreamRead()/uCellMuxStreamWrite(), e.g.
+ * to populate a #uGnssVirtualSerial_t for the GNSS transport
+ * #U_GNSS_TRANSPORT_VIRTUAL_SERIAL.  How data is routed to a
+ * given channel inside the module (e.g. which channel carries
+ * GNSS) is module-specific: see the AT commands manual of your
+ * module.
+ *
+ * Each channel has its own receive buffer into which the payload
+ * of incoming frames is decoded directly; when the buffer of a
+ * channel nears full the module is asked, with the MSC control
+ * message, to stop sending on that channel, and the decoder stops
+ * taking data from the UART rather than drop any, so that the other
+ * channels, and the hardware flow control of the UART, take up the
+ * slack.  Likewise transmission on a channel is held off while the
+ * module has asked for that.  Transmit data is written to the UART
+ * straight from the caller's buffer, framed "on the fly".
+ *
+ * The multiplexer does not survive a power-off, reboot or sleep of
+ * the module; it is torn down by the cellular API when it powers
+ * off or reboots the module and uCellMuxEnable() must be called
+ * again afterwards.  UART power saving is not available while the
+ * multiplexer is enabled: if it is in use it must be disabled with
+ * uCellPwrDisableUartSleep() before uCellMuxEnable() is called.
+ *
+ * These functions are thread-safe with the exception of
+ * uCellMuxChannelClose(), which must not be called while a
+ * stream function is in progress on the same channel.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_CELL_MUX_CHANNEL_ID_AT
+/** The channel (DLCI) used for AT commands; 27.010 reserves
+ * channel 0 for control.
+ */
+# define U_CELL_MUX_CHANNEL_ID_AT 1
+#endif
+
+#ifndef U_CELL_MUX_MAX_CHANNELS
+/** The maximum number of channels, excluding the control channel
+ * but including the AT channel, that may be open at any one time
+ * across all cellular instances.
+ */
+# define U_CELL_MUX_MAX_CHANNELS 4
+#endif
+
+#ifndef U_CELL_MUX_MAX_FRAME_INFO_LENGTH_BYTES
+/** The maximum length of the information field of a frame, the
+ * N1 parameter of AT+CMUX; 127 or less keeps the length field of
+ * each frame to a single byte.
+ */
+# define U_CELL_MUX_MAX_FRAME_INFO_LENGTH_BYTES 127
+#endif
+
+#ifndef U_CELL_MUX_CHANNEL_BUFFER_LENGTH_BYTES
+/** The size of the receive buffer of each channel; must be at
+ * least twice #U_CELL_MUX_MAX_FRAME_INFO_LENGTH_BYTES.
+ */
+# define U_CELL_MUX_CHANNEL_BUFFER_LENGTH_BYTES 1024
+#endif
+
+#ifndef U_CELL_MUX_CHANNEL_OPEN_TIMEOUT_MS
+/** How long to wait for the module to acknowledge the opening
+ * (or closing) of a channel.
+ */
+# define U_CELL_MUX_CHANNEL_OPEN_TIMEOUT_MS 3000
+#endif
+
+#ifndef U_CELL_MUX_WRITE_TIMEOUT_MS
+/** How long uCellMuxStreamWrite() will wait for the module to
+ * permit transmission on a channel that it has flow-controlled
+ * off.
+ */
+# define U_CELL_MUX_WRITE_TIMEOUT_MS 5000
+#endif
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS: CONTROL
+ * -------------------------------------------------------------- */
+
+/** Enable the multiplexer: the module is switched into multiplexer
+ * mode with AT+CMUX, the control channel and the channel
+ * #U_CELL_MUX_CHANNEL_ID_AT are opened and the AT client of the
+ * cellular instance is moved onto the latter.  If the
+ * multiplexer is already enabled this does nothing.  The AT
+ * client of the cellular instance must be on a UART and UART
+ * power saving must not be enabled.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @return            zero on success else negative error code;
+ *                    on failure the AT client is left on the UART.
+ */
+int32_t uCellMuxEnable(uDeviceHandle_t cellHandle);
+
+/** Determine whether the multiplexer is enabled.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @return            true if the multiplexer is enabled, else false.
+ */
+bool uCellMuxIsEnabled(uDeviceHandle_t cellHandle);
+
+/** Disable the multiplexer: any channels opened with
+ * uCellMuxChannelOpen() must already have been closed.  The
+ * module is told to close down the multiplexer, returning it to
+ * AT command mode on the UART, and the AT client of the cellular
+ * instance is moved back onto the UART.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @return            zero on success else negative error code.
+ */
+int32_t uCellMuxDisable(uDeviceHandle_t cellHandle);
+
+/** Open an additional channel of the multiplexer, which must
+ * have been enabled with uCellMuxEnable().
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @param channel     the channel (DLCI) to open, 1 to 63,
+ *                    excluding #U_CELL_MUX_CHANNEL_ID_AT.
+ * @return            on success the stream handle of the channel,
+ *                    for use with uAtClientAdd() or the stream
+ *                    functions below, else negative error code.
+ */
+int32_t uCellMuxChannelOpen(uDeviceHandle_t cellHandle, int32_t channel);
+
+/** Close a channel opened with uCellMuxChannelOpen(); anything
+ * using the stream handle (e.g. an AT client) must have been
+ * removed first.
+ *
+ * @param cellHandle    the handle of the cellular instance.
+ * @param streamHandle  the stream handle returned by
+ *                      uCellMuxChannelOpen().
+ * @return              zero on success else negative error code.
+ */
+int32_t uCellMuxChannelClose(uDeviceHandle_t cellHandle,
+                             int32_t streamHandle);
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS: STREAM
+ * -------------------------------------------------------------- */
+
+/** Read from a channel; does not block.
+ *
+ * @param streamHandle  the stream handle of the channel.
+ * @param[out] pBuffer  a place to put the data; cannot be NULL.
+ * @param sizeBytes     the amount of storage at pBuffer.
+ * @return              the number of bytes read, else negative
+ *                      error code.
+ */
+int32_t uCellMuxStreamRead(int32_t streamHandle, void *pBuffer,
+                           size_t sizeBytes);
+
+/** Write to a channel: the data is framed and written to the
+ * UART, waiting up to #U_CELL_MUX_WRITE_TIMEOUT_MS if the module
+ * has flow-controlled the channel off.
+ *
+ * @param streamHandle  the stream handle of the channel.
+ * @param[in] pBuffer   the data to write; cannot be NULL.
+ * @param sizeBytes     the number of bytes at pBuffer.
+ * @return              the number of bytes written, else negative
+ *                      error code.
+ */
+int32_t uCellMuxStreamWrite(int32_t streamHandle, const void *pBuffer,
+                            size_t sizeBytes);
+
+/** Get the number of bytes waiting to be read from a channel.
+ *
+ * @param streamHandle  the stream handle of the channel.
+ * @return              the number of bytes waiting, else negative
+ *                      error code.
+ */
+int32_t uCellMuxStreamGetReceiveSize(int32_t streamHandle);
+
+/** Set a callback to be called when data is received on a
+ * channel, as for uPortUartEventCallbackSet(); the callback is
+ * run in a task of its own, one per channel, so that a callback
+ * which blocks does not hold up the other channels.
+ *
+ * @param streamHandle    the stream handle of the channel.
+ * @param[in] pFunction   the callback, where the first parameter
+ *                        is the stream handle, the second parameter
+ *                        #U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED
+ *                        and the third parameter pParam; cannot
+ *                        be NULL.
+ * @param[in] pParam      a parameter to pass to pFunction.
+ * @param stackSizeBytes  the stack size of the callback task.
+ * @param priority        the priority of the callback task.
+ * @return                zero on success else negative error code.
+ */
+int32_t uCellMuxStreamCallbackSet(int32_t streamHandle,
+                                  void (*pFunction)(int32_t, uint32_t, void *),
+                                  void *pParam,
+                                  size_t stackSizeBytes,
+                                  int32_t priority);
+
+/** Remove the callback set with uCellMuxStreamCallbackSet().
+ *
+ * @param streamHandle  the stream handle of the channel.
+ */
+void uCellMuxStreamCallbackRemove(int32_t streamHandle);
+
+/** Cause the callback of a channel to be called, as for
+ * uPortUartEventSend(); does not block.
+ *
+ * @param streamHandle  the stream handle of the channel.
+ * @param eventBitmask  the event, currently only
+ *                      #U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED.
+ * @return              zero on success else negative error code.
+ */
+int32_t uCellMuxStreamEventSend(int32_t streamHandle,
+                                uint32_t eventBitmask);
+
+/** Determine whether the caller is in the callback task of a
+ * channel.
+ *
+ * @param streamHandle  the stream handle of the channel.
+ * @return              true if the caller is in the callback task.
+ */
+bool uCellMuxStreamEventIsCallback(int32_t streamHandle);
+
+/** Get the minimum free stack of the callback task of a channel.
+ *
+ * @param streamHandle  the stream handle of the channel.
+ * @return              the minimum free stack in bytes, else
+ *                      negative error code.
+ */
+int32_t uCellMuxStreamEventStackMinFree(int32_t streamHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_CELL_MUX_H_
+
+// End of file
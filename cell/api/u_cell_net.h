@@ -123,6 +123,30 @@ extern "C" {
 # define U_CELL_NET_SCAN_TIME_SECONDS (60 * 3)
 #endif
 
+#ifndef U_CELL_NET_DATA_COUNTER_SAMPLER_PERIOD_MIN_MS
+/** The minimum period that may be given to
+ * uCellNetDataCounterSamplerStart(), in milliseconds.
+ */
+# define U_CELL_NET_DATA_COUNTER_SAMPLER_PERIOD_MIN_MS 1000
+#endif
+
+#ifndef U_CELL_NET_DATA_COUNTER_SAMPLER_RATE_DIVISOR
+/** The data rates maintained by the data counter sampler are
+ * exponential moving averages: each new measurement moves the
+ * average 1 / U_CELL_NET_DATA_COUNTER_SAMPLER_RATE_DIVISOR of the
+ * way towards it.
+ */
+# define U_CELL_NET_DATA_COUNTER_SAMPLER_RATE_DIVISOR 4
+#endif
+
+#ifndef U_CELL_NET_BAND_LEARN_MAX_NUM
+/** The number of MCC/RAT combinations that band learning, see
+ * uCellNetBandLearnStart(), remembers; the least recently used
+ * is forgotten when a new one arrives.
+ */
+# define U_CELL_NET_BAND_LEARN_MAX_NUM 8
+#endif
+
 /** Determine if a given cellular network status value means that
  * we're registered with the network.
  */
@@ -236,6 +260,70 @@ typedef enum {
     U_CELL_NET_REG_DOMAIN_MAX_NUM
 } uCellNetRegDomain_t;
 
+/** The route taken by the last successful call to uCellNetConnect(),
+ * as returned by uCellNetGetLastConnectPath(), for diagnostic
+ * purposes.
+ */
+typedef enum {
+    U_CELL_NET_CONNECT_PATH_NONE = 0,  /**< there has been no successful
+                                            call to uCellNetConnect(). */
+    U_CELL_NET_CONNECT_PATH_EXISTING,  /**< the module was registered with
+                                            a suitable PDP context already
+                                            active: nothing needed doing. */
+    U_CELL_NET_CONNECT_PATH_ACTIVATE,  /**< the module was registered and
+                                            attached, e.g. on return from
+                                            3GPP power saving, and only
+                                            the PDP context needed to be
+                                            activated. */
+    U_CELL_NET_CONNECT_PATH_FULL,      /**< the full sequence of registration
+                                            and PDP context activation was
+                                            required. */
+    U_CELL_NET_CONNECT_PATH_MAX_NUM
+} uCellNetConnectPath_t;
+
+/** A snapshot of the data counters, as maintained by the background
+ * sampler and returned by uCellNetDataCounterSamplerGet().
+ */
+typedef struct {
+    int32_t txBytes;          /**< the number of bytes transmitted since
+                                   uCellNetDataCounterSamplerStart()
+                                   was called; unlike the value returned
+                                   by uCellNetGetDataCounterTx() this
+                                   carries on across connections. */
+    int32_t rxBytes;          /**< as txBytes but for received bytes. */
+    int32_t txBytesPerSecond; /**< a moving average of the transmit
+                                   data rate, -1 if not yet known. */
+    int32_t rxBytesPerSecond; /**< a moving average of the receive
+                                   data rate, -1 if not yet known. */
+    int32_t errorCode;        /**< the outcome of reading the counters
+                                   for this sample: zero on success, else
+                                   negative error code, e.g. when there
+                                   is no connection; the other fields
+                                   then keep their previous values. */
+    int32_t timeMs;           /**< the value of uPortGetTickTimeMs() when
+                                   the sample was completed. */
+    uint32_t count;           /**< the number of samples so far; this
+                                   increments with each new sample. */
+} uCellNetDataCounterSample_t;
+
+/** The storage for the snapshot maintained by the background
+ * data counter sampler: the application must provide this, it must
+ * persist from uCellNetDataCounterSamplerStart() until
+ * uCellNetDataCounterSamplerStop() has returned and the contents
+ * should be treated as private.
+ */
+typedef struct {
+    volatile uint32_t sequence; /**< incremented before and after
+                                     the fields below are written. */
+    volatile int32_t txBytes;
+    volatile int32_t rxBytes;
+    volatile int32_t txBytesPerSecond;
+    volatile int32_t rxBytesPerSecond;
+    volatile int32_t errorCode;
+    volatile int32_t timeMs;
+    volatile uint32_t count;
+} uCellNetDataCounterSampler_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -249,6 +337,12 @@ typedef enum {
  * the current connection, in which case that PDP context will be
  * deactivated (and potentially deregistration may occur) then
  * [registration will occur and] the new context will be activated.
+ * If the module is registered and attached but there is no active
+ * PDP context, e.g. on return from 3GPP power saving, the PDP context
+ * already defined in the module is simply activated, avoiding
+ * the full registration sequence, provided it turns out to have the
+ * requested APN; in this case pMccMnc is not checked.  Use
+ * uCellNetGetLastConnectPath() to find out which route was taken.
  *
  * @param cellHandle             the handle of the cellular instance.
  * @param[in] pMccMnc            pointer to a string giving the MCC and
@@ -398,6 +492,57 @@ int32_t uCellNetActivate(uDeviceHandle_t cellHandle,
 int32_t uCellNetDeactivate(uDeviceHandle_t cellHandle,
                            bool (*pKeepGoingCallback) (uDeviceHandle_t));
 
+/** Activate a PDP context in addition to the one managed by
+ * uCellNetConnect()/uCellNetActivate(), e.g. so that management
+ * traffic and bulk data can use different APNs, with different
+ * QoS and charging, at the same time.  Sockets are bound to the
+ * additional PDP context by setting the option
+ * #U_SOCK_OPT_PDP_CONTEXT (level #U_SOCK_OPT_LEVEL_SOCK) to
+ * contextId with uSockOptionSet() before the socket is used.
+ *
+ * The module must already be registered with the network.  The
+ * internal module profile that goes with the PDP context is
+ * contextId - 1, which must not be the same as
+ * #U_CELL_NET_PROFILE_ID.  Only supported by modules that map PDP
+ * contexts to internal profiles with 3GPP commands, e.g. SARA-R5
+ * and LARA-R6; if the PDP context is already active it is simply
+ * [re]attached to its profile.
+ *
+ * @param cellHandle             the handle of the cellular instance.
+ * @param contextId              the PDP context ID to activate, in the
+ *                               range 1 to #U_CELL_NET_MAX_NUM_CONTEXTS,
+ *                               not #U_CELL_NET_CONTEXT_ID.
+ * @param[in] pApn               pointer to a string giving the APN to
+ *                               use; NULL or "" to let the network
+ *                               choose.  The APN database is not used.
+ * @param[in] pUsername          pointer to a string giving the user name
+ *                               for PPP authentication; may be NULL.
+ * @param[in] pPassword          pointer to a string giving the password
+ *                               for PPP authentication; ignored if
+ *                               pUsername is NULL, must be non-NULL if
+ *                               pUsername is non-NULL.
+ * @param[in] pKeepGoingCallback as for uCellNetActivate(); may be NULL.
+ * @return                       zero on success or negative error code on
+ *                               failure.
+ */
+int32_t uCellNetActivateContext(uDeviceHandle_t cellHandle,
+                                int32_t contextId, const char *pApn,
+                                const char *pUsername, const char *pPassword,
+                                bool (*pKeepGoingCallback) (uDeviceHandle_t));
+
+/** Deactivate a PDP context that was activated with
+ * uCellNetActivateContext(); the PDP context managed by
+ * uCellNetConnect()/uCellNetActivate() is not affected.  Any
+ * sockets bound to the PDP context should be closed first.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @param contextId   the PDP context ID to deactivate.
+ * @return            zero on success or negative error code on
+ *                    failure.
+ */
+int32_t uCellNetDeactivateContext(uDeviceHandle_t cellHandle,
+                                  int32_t contextId);
+
 /** Disconnect from the network. If there is an active PDP Context it
  * will be deactivated. The state of the module will be that the
  * radio is in airplane mode (AT+CFUN=4).
@@ -520,6 +665,51 @@ int32_t uCellNetScanGetNext(uDeviceHandle_t cellHandle,
  */
 void uCellNetScanGetLast(uDeviceHandle_t cellHandle);
 
+/** Perform a network scan, as uCellNetScanGetFirst(), but rather
+ * than storing the results pass each one to a callback as soon as
+ * it has been decoded; no memory is allocated for the results and
+ * the scan list used by uCellNetScanGetFirst()/uCellNetScanGetNext()
+ * is left untouched.  The callback may return false to stop being
+ * called, e.g. as soon as an acceptable network has been seen.
+ *
+ * Note that the module only reports the results once its scan
+ * is complete, as a single response to AT+COPS=?, hence this does
+ * not shorten the scan itself: use pKeepGoingCallback to abort
+ * the scan (no results are reported in that case) or configure
+ * fewer RATs/bands to shorten it.
+ *
+ * @param cellHandle             the handle of the cellular instance.
+ * @param[in] pCallback          the callback to be given each network
+ *                               found, in the order reported by the
+ *                               module; cannot be NULL (use
+ *                               uCellNetScanGetFirst() instead).  The
+ *                               parameters are the handle of the
+ *                               cellular instance, the name of the
+ *                               network, the MCC/MNC string of the
+ *                               network, the RAT of the network
+ *                               and pCallbackParam; the strings are
+ *                               valid only for the duration of the
+ *                               call.  The callback is called while
+ *                               the response from the module is being
+ *                               read and so must not call into the
+ *                               cellular API and should return
+ *                               promptly.  Return true to be given
+ *                               the next network, false to stop.
+ * @param[in] pCallbackParam     a parameter to pass to pCallback;
+ *                               may be NULL.
+ * @param[in] pKeepGoingCallback as for uCellNetScanGetFirst().
+ * @return                       the number of networks passed to
+ *                               pCallback or negative error code.
+ */
+int32_t uCellNetScan(uDeviceHandle_t cellHandle,
+                     bool (*pCallback) (uDeviceHandle_t cellHandle,
+                                        const char *pName,
+                                        const char *pMccMnc,
+                                        uCellNetRat_t rat,
+                                        void *pCallbackParam),
+                     void *pCallbackParam,
+                     bool (*pKeepGoingCallback) (uDeviceHandle_t cellHandle));
+
 /** Enable or disable the registration status call-back. This
  * call-back allows the application to know the various
  * states of the network scanning, registration and rejections
@@ -587,6 +777,23 @@ int32_t uCellNetSetBaseStationConnectionStatusCallback(uDeviceHandle_t cellHandl
                                                                           void *),
                                                        void *pCallbackParameter);
 
+/** Get the state of the connection to the base station (i.e. whether
+ * the radio is in RRC connected state) as last indicated by the
+ * module.  No AT command is sent: the state is only tracked while a
+ * callback has been set with
+ * uCellNetSetBaseStationConnectionStatusCallback(), which switches
+ * the indication on, and is unknown until the module has sent the
+ * first indication.  This is the basis on which, for instance,
+ * uSockWriteDeferred() decides that the radio is awake anyway.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @return            1 if connected, 0 if not connected, else
+ *                    negative error code, e.g.
+ *                    #U_ERROR_COMMON_UNKNOWN if the state is not
+ *                    known.
+ */
+int32_t uCellNetGetBaseStationConnection(uDeviceHandle_t cellHandle);
+
 /** Get the current network registration status.  If you
  * simply want to confirm that registration has been
  * achieved, use uCellNetIsRegistered() instead.
@@ -626,6 +833,14 @@ bool uCellNetIsRegistered(uDeviceHandle_t cellHandle);
  */
 uCellNetRat_t uCellNetGetActiveRat(uDeviceHandle_t cellHandle);
 
+/** Get the route taken by the last successful call to
+ * uCellNetConnect(), for diagnostic purposes.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @return            the connect path or negative error code.
+ */
+int32_t uCellNetGetLastConnectPath(uDeviceHandle_t cellHandle);
+
 /** Get the name of the operator on which the cellular module is
  * registered.  An error will be returned if the module is not
  * registered on the network at the time this is called.
@@ -770,6 +985,154 @@ int32_t uCellNetGetDataCounterRx(uDeviceHandle_t cellHandle);
  */
 int32_t uCellNetResetDataCounters(uDeviceHandle_t cellHandle);
 
+/** Start a background task which, every periodMs, reads the transmit
+ * and receive data counters of the module, accumulates them and
+ * maintains a moving average of the transmit and receive data rates,
+ * publishing the result to pSampler, from where it may be read at
+ * any time with uCellNetDataCounterSamplerGet() without waiting for
+ * the AT interface; this is intended for the application that must,
+ * for instance, keep within a data cap.  The task runs at a low
+ * priority and sends one AT command per sample; if the application
+ * keeps the cellular API busy the sample is simply delayed.  Calls
+ * to uCellNetGetDataCounterTx() and uCellNetGetDataCounterRx() also
+ * update the sampler, since they read the same counters.  A counter
+ * that goes backwards, because the connection was dropped or
+ * uCellNetResetDataCounters() was called, is taken to have started
+ * again from zero.  Only one data counter sampler may be active per
+ * cellular instance and it must be stopped with
+ * uCellNetDataCounterSamplerStop() before pSampler is released; it
+ * is stopped automatically if the cellular instance is removed.
+ *
+ * Note that uCellNetDataCounterSamplerGet() avoids taking any locks,
+ * hence it will not block but it may, very rarely, return
+ * #U_ERROR_COMMON_TEMPORARY_FAILURE if it keeps catching the
+ * sampler in the act of writing.
+ *
+ * @param cellHandle          the handle of the cellular instance.
+ * @param[in] pSampler        storage for the snapshot, which must
+ *                            persist until uCellNetDataCounterSamplerStop()
+ *                            has returned; cannot be NULL.
+ * @param periodMs            the interval between samples, must be
+ *                            at least #U_CELL_NET_DATA_COUNTER_SAMPLER_PERIOD_MIN_MS.
+ * @param thresholdBytes      the number of bytes, transmitted plus
+ *                            received, at which pCallback should be
+ *                            called, once; use zero or less to have
+ *                            pCallback called with every sample.
+ * @param[in] pCallback       a function to be called when thresholdBytes
+ *                            is reached, may be NULL; it is called from
+ *                            the sampler task, which has a small stack,
+ *                            and so should do no more than, for instance,
+ *                            call uCellNetDataCounterSamplerGet() or
+ *                            signal a task of the application.
+ * @param[in] pCallbackParam  a parameter that will be passed to
+ *                            pCallback; may be NULL.
+ * @return                    zero on success else negative error code.
+ */
+int32_t uCellNetDataCounterSamplerStart(uDeviceHandle_t cellHandle,
+                                        uCellNetDataCounterSampler_t *pSampler,
+                                        int32_t periodMs,
+                                        int32_t thresholdBytes,
+                                        void (*pCallback) (uDeviceHandle_t cellHandle,
+                                                           void *pCallbackParam),
+                                        void *pCallbackParam);
+
+/** Get the latest sample published by the background data counter
+ * sampler; this does not communicate with the cellular module, takes
+ * no locks and may be called as often as required, from any task.
+ *
+ * @param[in] pSampler  the storage passed to uCellNetDataCounterSamplerStart();
+ *                      cannot be NULL.
+ * @param[out] pSample  a place to put the sample; cannot be NULL.
+ * @return              zero on success, #U_ERROR_COMMON_NOT_FOUND if
+ *                      there is no sample yet, else negative error
+ *                      code.
+ */
+int32_t uCellNetDataCounterSamplerGet(const uCellNetDataCounterSampler_t *pSampler,
+                                      uCellNetDataCounterSample_t *pSample);
+
+/** Stop the background data counter sampler; once this has returned
+ * the storage passed to uCellNetDataCounterSamplerStart() may be
+ * released, the latest sample remaining readable with
+ * uCellNetDataCounterSamplerGet() until then.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ */
+void uCellNetDataCounterSamplerStop(uDeviceHandle_t cellHandle);
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS: BAND LEARNING
+ * -------------------------------------------------------------- */
+
+/** Start band learning.  With band learning on, each time
+ * uCellNetConnect() or uCellNetRegister() succeeds on an EUTRAN RAT
+ * (LTE, cat-M1 or NB1) the band that the module registered on,
+ * worked out from the EARFCN, is recorded against the MCC and RAT.
+ *
+ * When uCellNetDisconnect() succeeds the band mask of each RAT that
+ * has been learnt for the most recent MCC is narrowed to the learnt
+ * bands (within the band mask that was set before), so that when the
+ * module next boots it searches only those bands and registration is
+ * quicker and uses less energy.  Should uCellNetConnect() or
+ * uCellNetRegister() then fail, the band masks are widened again to
+ * what they were before, the module is rebooted and, if
+ * pKeepGoingCallback allows, the attempt is repeated; whatever band
+ * the module then registers on is learnt.  Since the band mask is
+ * only set at a disconnect, the module must be disconnected with
+ * uCellNetDisconnect(), rather than simply powered off, for the
+ * narrowing to happen.
+ *
+ * If pFileName is not NULL what has been learnt, including the band
+ * masks from before narrowing, is kept in that file on the file
+ * system of the module and read back from it here, so that it
+ * survives a restart of this MCU; without a file, if this MCU
+ * restarts while the band masks are narrowed, the band masks from
+ * before cannot be restored by this code.
+ *
+ * Band masks are set with uCellCfgSetBandMask() and so band learning
+ * is only useful on modules which support that.
+ *
+ * @param cellHandle     the handle of the cellular instance.
+ * @param[in] pFileName  the name of a file on the module file system
+ *                       in which to keep what is learnt, may be NULL.
+ * @return               zero on success or negative error code;
+ *                       #U_ERROR_COMMON_NO_MEMORY if band learning
+ *                       is already on.
+ */
+int32_t uCellNetBandLearnStart(uDeviceHandle_t cellHandle,
+                               const char *pFileName);
+
+/** Get the band mask that band learning has learnt for an MCC
+ * and RAT.
+ *
+ * @param cellHandle       the handle of the cellular instance.
+ * @param mcc              the MCC, e.g. 234.
+ * @param rat              the RAT.
+ * @param[out] pBandMask1  a place to put band mask 1, where bit 0
+ *                         is band 1 and bit 63 is band 64; cannot
+ *                         be NULL.
+ * @param[out] pBandMask2  a place to put band mask 2, where bit 0
+ *                         is band 65 and bit 63 is band 128; cannot
+ *                         be NULL.
+ * @return                 zero on success, #U_ERROR_COMMON_NOT_FOUND
+ *                         if nothing has been learnt for the MCC and
+ *                         RAT, else negative error code.
+ */
+int32_t uCellNetBandLearnGet(uDeviceHandle_t cellHandle,
+                             int32_t mcc, uCellNetRat_t rat,
+                             uint64_t *pBandMask1, uint64_t *pBandMask2);
+
+/** Stop band learning, restoring any band masks that were
+ * narrowed to what they were before; this must be done while the
+ * module is not registered with the network.  Any file given to
+ * uCellNetBandLearnStart() is left as it is.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @return            zero on success or negative error code; band
+ *                    learning is stopped even if the band masks
+ *                    could not be restored.
+ */
+int32_t uCellNetBandLearnStop(uDeviceHandle_t cellHandle);
+
 #ifdef __cplusplus
 }
 #endif
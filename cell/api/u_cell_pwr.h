@@ -242,6 +242,50 @@ typedef enum {
     U_CELL_PWR_3GPP_POWER_SAVING_STATE_MAX_NUM
 } uCellPwr3gppPowerSavingState_t;
 
+/** The power states that energy is accounted against, see
+ * uCellPwrEnergyStart().
+ */
+typedef enum {
+    U_CELL_PWR_ENERGY_STATE_OFF = 0,   /**< the module is powered off. */
+    U_CELL_PWR_ENERGY_STATE_PSM,       /**< the protocol stack of the module
+                                            is in 3GPP power saving or the
+                                            module is in deep sleep. */
+    U_CELL_PWR_ENERGY_STATE_IDLE,      /**< the module is on but has no
+                                            RRC connection with the network. */
+    U_CELL_PWR_ENERGY_STATE_CONNECTED, /**< the module has an RRC
+                                            connection with the network. */
+    U_CELL_PWR_ENERGY_STATE_MAX_NUM
+} uCellPwrEnergyState_t;
+
+/** The current drawn by the module in each of the power states,
+ * as measured or taken from the data sheet by the application;
+ * used to estimate energy, see uCellPwrEnergyStart().
+ */
+typedef struct {
+    int32_t currentMicroAmps[U_CELL_PWR_ENERGY_STATE_MAX_NUM]; /**< indexed
+                                                                    by
+                                                                    #uCellPwrEnergyState_t. */
+    int32_t supplyMillivolts; /**< the supply voltage of the module. */
+} uCellPwrCurrentTable_t;
+
+/** The energy accounts of a cellular instance, see
+ * uCellPwrEnergyGet().
+ */
+typedef struct {
+    int64_t timeMs[U_CELL_PWR_ENERGY_STATE_MAX_NUM]; /**< the time spent
+                                                          in each state,
+                                                          indexed by
+                                                          #uCellPwrEnergyState_t. */
+    uint64_t bytesSent;       /**< the bytes written to sockets. */
+    uint64_t bytesReceived;   /**< the bytes read from sockets. */
+    int64_t energyMicrojoules; /**< the estimated energy used, -1 if no
+                                    current table was given. */
+    int64_t energyPerByteNanojoules; /**< energyMicrojoules divided by
+                                          the sum of bytesSent and
+                                          bytesReceived, -1 if either
+                                          is not known. */
+} uCellPwrEnergy_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -283,7 +327,19 @@ bool uCellPwrIsAlive(uDeviceHandle_t cellHandle);
  * being controlled and there is no need to enable the power supply
  * to the module, then this function will check that the module
  * is responsive and then configure it for correct operation
- * with this driver.
+ * with this driver.  Settings which the module keeps in non-volatile
+ * memory are only written the first time this function is called
+ * for a given cellular instance, or after something in this API
+ * (e.g. uCellCfgSetMnoProfile(), uCellCfgSetUdconf() or
+ * uCellCfgFactoryReset()) may have changed them; if you change
+ * such settings behind the back of this driver, e.g. by sending
+ * AT commands directly, it is best to remove and re-add the
+ * cellular instance.  If the module has returned from deep sleep
+ * (woken automatically by the AT client, see
+ * uCellPwrWakeUpFromDeepSleep()) then everything it lost has
+ * already been restored and this function only checks, with a
+ * single AT command, that the module is alive; there is no need
+ * to avoid calling it on wake-up.
  *
  * @param cellHandle             the handle of the cellular instance.
  * @param[in] pSimPinCode        pointer to a string giving the PIN of
@@ -934,7 +990,15 @@ int32_t uCellPwrGetDeepSleepActive(uDeviceHandle_t cellHandle,
 /** Wake the module from deep sleep.  THERE SHOULD BE NO NEED
  * FOR THE USER TO CALL THIS; it will be called automatically by
  * the AT client if it needs to do something after the module
- * has entered deep sleep.
+ * has entered deep sleep.  Only the volatile configuration is
+ * written back to the module on wake-up: non-volatile settings
+ * and the 3GPP power saving settings are retained by the module
+ * and the network registration state, radio parameters and
+ * identity information held by this driver are kept; on EUTRAN
+ * the internal profile of the module is re-attached to the PDP
+ * context.  Sockets, MQTT sessions etc. in the module do not
+ * survive deep sleep; applications should re-open them from the
+ * callback set with uCellPwrSetDeepSleepWakeUpCallback().
  *
  * @param cellHandle             the handle of the cellular instance.
  * @param[in] pKeepGoingCallback waking from deep sleep usually takes
@@ -992,6 +1056,46 @@ int32_t uCellPwrEnableUartSleep(uDeviceHandle_t cellHandle);
  */
 bool uCellPwrUartSleepIsEnabled(uDeviceHandle_t cellHandle);
 
+/** Start accounting for the time the module spends in each power
+ * state (see #uCellPwrEnergyState_t) and for the bytes sent and
+ * received over sockets, so that the energy used per byte can be
+ * estimated with uCellPwrEnergyGet().  The accounts are reset.
+ *
+ * The RRC connection state is taken from the +CSCON URC, which the
+ * module only emits while a callback is set with
+ * uCellNetSetBaseStationConnectionStatusCallback(); if no such
+ * callback is set then time that the module is awake is counted as
+ * #U_CELL_PWR_ENERGY_STATE_IDLE.  3GPP power saving is taken from
+ * the +UUPSMR URC and deep sleep as for uCellPwrGetDeepSleepActive().
+ *
+ * @param cellHandle      the handle of the cellular instance.
+ * @param[in] pTable      the current drawn in each power state,
+ *                        which is copied; may be NULL, in which
+ *                        case no energy is estimated, only time.
+ * @return                zero on success or negative error code.
+ */
+int32_t uCellPwrEnergyStart(uDeviceHandle_t cellHandle,
+                            const uCellPwrCurrentTable_t *pTable);
+
+/** Get the energy accounts started by uCellPwrEnergyStart(), up to
+ * the time of this call.
+ *
+ * @param cellHandle      the handle of the cellular instance.
+ * @param[out] pEnergy    a place to put the accounts; cannot be NULL.
+ * @return                zero on success or negative error code,
+ *                        #U_ERROR_COMMON_NOT_INITIALISED if
+ *                        uCellPwrEnergyStart() has not been called.
+ */
+int32_t uCellPwrEnergyGet(uDeviceHandle_t cellHandle,
+                          uCellPwrEnergy_t *pEnergy);
+
+/** Stop energy accounting and free the memory it used; the
+ * +CSCON URC is left as it is.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ */
+void uCellPwrEnergyStop(uDeviceHandle_t cellHandle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -388,6 +388,44 @@ int32_t uCellSecZtpGetCertificateAuthorities(uDeviceHandle_t cellHandle,
                                              char *pData,
                                              size_t dataSizeBytes);
 
+/** Switch caching of the Zero Touch Provisioning items (device
+ * certificate, device private key and certificate authorities) on
+ * or off; caching is off by default.  Each item is several
+ * kilobytes of AT transfer, so code that configures a local TLS
+ * stack from them on every connection will benefit greatly from
+ * having the cache on.
+ *
+ * With the cache on, each item is kept in RAM the first time it
+ * is read completely: i.e. when read into a buffer larger than the
+ * item or, following the usual pattern of calling first with
+ * pData NULL to find the size, into a buffer of exactly the size
+ * returned.  Thereafter only the root of trust UID of the module
+ * is queried (a short AT exchange) and, if it is unchanged, the
+ * item is returned from the cache; should the UID differ (e.g.
+ * the module has been swapped) or not be readable, the cache is
+ * emptied and the item read from the module once more.  The cache
+ * is also emptied by a successful seal and is freed when caching
+ * is switched off or the instance is removed.
+ *
+ * IMPORTANT: the cache includes the device private key; only
+ * switch it on if holding that in RAM is acceptable for your
+ * application.
+ *
+ * @param cellHandle      the handle of the cellular instance.
+ * @param onNotOff        true to switch the cache on, false to
+ *                        switch it off and free it.
+ * @return                zero on success else negative error code.
+ */
+int32_t uCellSecZtpSetCache(uDeviceHandle_t cellHandle, bool onNotOff);
+
+/** Get whether caching of the Zero Touch Provisioning items is on;
+ * see uCellSecZtpSetCache().
+ *
+ * @param cellHandle      the handle of the cellular instance.
+ * @return                true if the cache is on, else false.
+ */
+bool uCellSecZtpCacheIsOn(uDeviceHandle_t cellHandle);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: END TO END ENCRYPTION
  * -------------------------------------------------------------- */
@@ -492,6 +530,59 @@ int32_t uCellSecPskGenerate(uDeviceHandle_t cellHandle,
  */
 int32_t uCellSecHeartbeatTrigger(uDeviceHandle_t cellHandle);
 
+/** Trigger a security heartbeat when the radio is awake anyway,
+ * rather than waking it up from 3GPP power saving just for the
+ * heartbeat.  The heartbeat is sent, as by
+ * uCellSecHeartbeatTrigger(), when the first of the following
+ * happens:
+ *
+ * - the deadline passes,
+ * - data is sent on a socket of the same cellular instance,
+ * - the module is seen to be connected to the base station; this
+ *   is only known if the +CSCON URC has been switched on with
+ *   uCellNetSetBaseStationConnectionStatusCallback().
+ *
+ * The heartbeat is sent straight away if deadlineMs is zero or
+ * less or the module is already known to be connected to the base
+ * station.  Only one heartbeat may be waiting at a time.  Since
+ * the deadline is kept with a timer this is not supported on
+ * platforms where uPortTimerCreate() is not implemented.
+ *
+ * @param cellHandle      the handle of the instance to  be used,
+ *                        for example obtained through uDeviceOpen().
+ * @param deadlineMs      the longest the heartbeat may be held back
+ *                        for, in milliseconds.
+ * @param[in] pCallback   a callback that will be called, from the
+ *                        AT client's callback task, with the outcome
+ *                        of the heartbeat: the cellular handle, the
+ *                        return value of uCellSecHeartbeatTrigger()
+ *                        (note the rate limiting described there)
+ *                        and pCallbackParam; may be NULL.
+ * @param pCallbackParam  a parameter that will be passed to
+ *                        pCallback.
+ * @return                zero on success, i.e. the heartbeat is
+ *                        waiting to be sent, else negative error
+ *                        code; #U_ERROR_COMMON_TEMPORARY_FAILURE
+ *                        if a heartbeat is already waiting.
+ */
+int32_t uCellSecHeartbeatTriggerDeferred(uDeviceHandle_t cellHandle,
+                                         int32_t deadlineMs,
+                                         void (*pCallback) (uDeviceHandle_t,
+                                                            int32_t,
+                                                            void *),
+                                         void *pCallbackParam);
+
+/** Cancel a heartbeat that is waiting to be sent after a call to
+ * uCellSecHeartbeatTriggerDeferred(); the callback passed to that
+ * function will not be called, unless the heartbeat was already
+ * being sent, in which case this has no effect.
+ *
+ * @param cellHandle the handle of the instance to  be used, for
+ *                   example obtained through uDeviceOpen().
+ * @return           zero on success else negative error code.
+ */
+int32_t uCellSecHeartbeatCancelDeferred(uDeviceHandle_t cellHandle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -472,6 +472,35 @@ int32_t uCellSecTlsSniSet(const uCellSecTlsContext_t *pContext,
 int32_t uCellSecTlsSniGet(const uCellSecTlsContext_t *pContext,
                           char *pSni, size_t size);
 
+/** Set whether TLS session resumption is enabled: if it is, the
+ * module keeps the session (session ID and, where the server offers
+ * one, session ticket) negotiated by a TLS connection using this
+ * security profile and offers it to the server when the next TLS
+ * connection using the same profile is made, which avoids a full
+ * handshake (and the certificate exchange that goes with it) if
+ * the server accepts it.  The session is held in the profile, so
+ * the profile must be kept for it to be of use; see
+ * uSecurityTlsRemove().  The SARA-U201 and SARA-R410M-02B modules
+ * do not support this feature.
+ *
+ * @param[in] pContext  a pointer to the security context.
+ * @param onNotOff      true to enable session resumption, false
+ *                      to disable it (the default).
+ * @return              zero on success else negative error code.
+ */
+int32_t uCellSecTlsSessionResumptionSet(const uCellSecTlsContext_t *pContext,
+                                        bool onNotOff);
+
+/** Get whether TLS session resumption is enabled.
+ * The SARA-U201 and SARA-R410M-02B modules do not support this
+ * feature.
+ *
+ * @param[in] pContext  a pointer to the security context.
+ * @return              true if session resumption is enabled,
+ *                      else false.
+ */
+bool uCellSecTlsIsSessionResumptionOn(const uCellSecTlsContext_t *pContext);
+
 #ifdef __cplusplus
 }
 #endif
@@ -55,6 +55,28 @@ extern "C" {
  */
 #define U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES 1024
 
+#ifndef U_CELL_SOCK_BINARY_PROMPT_DELAY_MS
+/** In binary mode (the default, see uCellSockHexModeOn()) data
+ * is written with AT+USOWR/AT+USOST followed by the raw bytes,
+ * which must not be sent until this long after the module has
+ * issued its '@' prompt; the u-blox AT manuals give 50 ms as the
+ * minimum.  This delay is the main per-segment overhead of binary
+ * mode.
+ */
+# define U_CELL_SOCK_BINARY_PROMPT_DELAY_MS 50
+#endif
+
+#ifndef U_CELL_SOCK_BATCH_PIPELINE_WINDOW
+/** The number of AT+USOST commands that uCellSockSendToBatch() may
+ * send to the module, in hex mode, before the response to the first
+ * has been received, see uAtClientPipeline(); set this to 1 to send
+ * the datagrams of a batch strictly one at a time.  Each command in
+ * the window is assembled in heap memory, at most twice
+ * #U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES per command.
+ */
+# define U_CELL_SOCK_BATCH_PIPELINE_WINDOW 4
+#endif
+
 #ifndef U_CELL_SOCK_TCP_RETRY_LIMIT
 /** The number of times to retry sending TCP data:
  * if the module is accepting less than
@@ -80,6 +102,29 @@ extern "C" {
 # define U_CELL_SOCK_DNS_LOOKUP_TIME_SECONDS 60
 #endif
 
+#ifndef U_CELL_SOCK_DIRECT_LINK_TIMEOUT_SECONDS
+/** The amount of time allowed for the module to enter or leave
+ * direct link mode, see uCellSockDirectLinkStart().
+ */
+# define U_CELL_SOCK_DIRECT_LINK_TIMEOUT_SECONDS 10
+#endif
+
+#ifndef U_CELL_SOCK_DIRECT_LINK_GUARD_TIME_MS
+/** The period of silence required before and after the "+++"
+ * escape sequence that takes the module out of direct link mode;
+ * the u-blox AT manuals give the guard time as 1 second, a little
+ * margin is added here.
+ */
+# define U_CELL_SOCK_DIRECT_LINK_GUARD_TIME_MS 1100
+#endif
+
+#ifndef U_CELL_SOCK_POOL_MAX_NUM
+/** The maximum number of sockets, of all protocols, that may be
+ * kept ready in the module, see uCellSockPoolSet().
+ */
+# define U_CELL_SOCK_POOL_MAX_NUM 4
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -151,6 +196,37 @@ int32_t uCellSockConnect(uDeviceHandle_t cellHandle,
                          int32_t sockHandle,
                          const uSockAddress_t *pRemoteAddress);
 
+/** Start connecting to a server without waiting for the connection
+ * to complete; not all modules support this.  The AT interface is
+ * only occupied for as long as it takes the module to accept the
+ * request, the outcome arriving later in a URC.
+ *
+ * @param cellHandle         the handle of the cellular instance.
+ * @param sockHandle         the handle of the socket.
+ * @param[in] pRemoteAddress the address of the server to
+ *                           connect to, including port number.
+ * @param[in] pCallback      the callback to be called when the
+ *                           connection attempt completes, cannot
+ *                           be NULL; the callback is called from
+ *                           the AT client callback task with the
+ *                           cellular handle, the socket handle and
+ *                           zero on success else the negated value
+ *                           of U_SOCK_Exxx from u_sock_errno.h.
+ * @return                   zero if the connection attempt has been
+ *                           started else negated value of U_SOCK_Exxx
+ *                           from u_sock_errno.h; in particular
+ *                           -U_SOCK_ENOSYS if the module does not
+ *                           support asynchronous connection, in
+ *                           which case uCellSockConnect() should be
+ *                           used.
+ */
+int32_t uCellSockConnectAsync(uDeviceHandle_t cellHandle,
+                              int32_t sockHandle,
+                              const uSockAddress_t *pRemoteAddress,
+                              void (*pCallback) (uDeviceHandle_t,
+                                                 int32_t,
+                                                 int32_t));
+
 /** Close a socket.
  *
  * @param cellHandle     the handle of the cellular instance.
@@ -184,6 +260,48 @@ int32_t uCellSockClose(uDeviceHandle_t cellHandle,
  */
 void uCellSockCleanup(uDeviceHandle_t cellHandle);
 
+/* ----------------------------------------------------------------
+ * FUNCTIONS: POOL
+ * -------------------------------------------------------------- */
+
+/** Keep a pool of sockets ready-created in the module so that
+ * uCellSockCreate() (and hence uSockCreate()) can hand one out
+ * without waiting for an AT+USOCR round trip.  The pool is filled
+ * in the background, from the AT client callback task, when this
+ * function is called, after a socket has been taken from it and
+ * when +CSCON indicates that the radio is connected; filling stops
+ * at the first failure (e.g. because there is no network yet) and
+ * is tried again on the next of those occasions.  A socket is only
+ * taken from the pool if no local port has been set with
+ * uCellSockSetNextLocalPort(); sockets in the pool use the default
+ * PDP context.  Note that sockets in the pool count against the
+ * #U_CELL_SOCK_MAX_NUM_SOCKETS that the module supports.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @param numTcp      the number of TCP sockets to keep ready.
+ * @param numUdp      the number of UDP sockets to keep ready;
+ *                    numTcp + numUdp cannot be more than
+ *                    #U_CELL_SOCK_POOL_MAX_NUM, use zero for
+ *                    both to close any sockets in the pool
+ *                    and stop filling it.
+ * @return            zero on success else negated value of
+ *                    U_SOCK_Exxx from u_sock_errno.h.
+ */
+int32_t uCellSockPoolSet(uDeviceHandle_t cellHandle,
+                         size_t numTcp, size_t numUdp);
+
+/** Get the number of sockets of the given protocol that are
+ * currently ready in the pool, see uCellSockPoolSet().
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @param protocol    the protocol.
+ * @return            on success the number of sockets in the
+ *                    pool, else negated value of U_SOCK_Exxx
+ *                    from u_sock_errno.h.
+ */
+int32_t uCellSockPoolGet(uDeviceHandle_t cellHandle,
+                         uSockProtocol_t protocol);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: CONFIGURE
  * -------------------------------------------------------------- */
@@ -218,6 +336,27 @@ bool uCellSockBlockingGet(uDeviceHandle_t cellHandle,
  * #U_SOCK_OPT_RCVTIMEO and then the option value would be
  * a pointer to a structure of type timeval.
  *
+ * #U_SOCK_OPT_RCVBUF at level #U_SOCK_OPT_LEVEL_SOCK, with an
+ * int32_t value, is handled locally rather than by the module:
+ * a non-zero value allocates a read-ahead buffer of that size for
+ * the socket, into which uCellSockRead() reads as much as the
+ * module has waiting each time it has to go to the module, serving
+ * subsequent small reads from memory without an AT round trip;
+ * zero, the default, frees the buffer again.  The buffer cannot be
+ * shrunk below the amount of data it is currently holding.  Only
+ * uCellSockRead() (i.e. TCP) makes use of the buffer.  When there
+ * is no read-ahead buffer uCellSockOptionGet() returns, for this
+ * option, the most that a single read from the module may return,
+ * #U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES, halved in hex mode.
+ * Data is only ever fetched from the module when the consumer reads,
+ * never on the arrival of a +UUSORD URC, hence this option is also
+ * the receive window of the socket on the host side: at most this
+ * many bytes (or, with no read-ahead buffer, the size of the
+ * consumer's own read buffer) are held in this MCU's RAM for the
+ * socket, the remainder staying in the module (and, once that is
+ * full, being held back by TCP flow control), so that many parallel
+ * downloads with slow consumers do not consume unbounded RAM.
+ *
  * @param cellHandle        the handle of the cellular instance.
  * @param sockHandle        the handle of the socket.
  * @param level             the option level
@@ -373,6 +512,26 @@ int32_t uCellSockSendTo(uDeviceHandle_t cellHandle,
                         const uSockAddress_t *pRemoteAddress,
                         const void *pData, size_t dataSizeBytes);
 
+/** Send a datagram gathered from several pieces of data in a
+ * single +USOST; the limit on the total length is as for
+ * uCellSockSendTo().
+ *
+ * @param cellHandle         the handle of the cellular instance.
+ * @param sockHandle         the handle of the socket.
+ * @param[in] pRemoteAddress the address of the server to
+ *                           send the datagram to, plus port
+ *                           number.  Cannot be NULL.
+ * @param[in] pIoVec         an array of ioVecCount pieces of data.
+ * @param ioVecCount         the number of entries at pIoVec.
+ * @return                   the number of bytes sent on
+ *                           success else negated value
+ *                           of U_SOCK_Exxx from u_sock_errno.h.
+ */
+int32_t uCellSockSendToV(uDeviceHandle_t cellHandle,
+                         int32_t sockHandle,
+                         const uSockAddress_t *pRemoteAddress,
+                         const uSockIoVec_t *pIoVec, size_t ioVecCount);
+
 /** Receive a datagram.
  *
  * @param cellHandle          the handle of the cellular instance.
@@ -400,6 +559,54 @@ int32_t uCellSockReceiveFrom(uDeviceHandle_t cellHandle,
                              uSockAddress_t *pRemoteAddress,
                              void *pData, size_t dataSizeBytes);
 
+/** Send several datagrams, each to the address in its entry, under
+ * a single lock of the AT interface.  The datagrams are checked
+ * before any are sent: if one is invalid (e.g. too long, see
+ * uCellSockSendTo()) only those before it are sent.  In hex mode
+ * (see uCellSockHexModeOn()) the AT+USOST commands are pipelined,
+ * up to #U_CELL_SOCK_BATCH_PIPELINE_WINDOW at a time, so the module
+ * turnaround time is not paid for every datagram; in binary mode
+ * the module must prompt for each datagram and so they are sent
+ * one after the other.  Sending stops at the first failure.
+ *
+ * @param cellHandle          the handle of the cellular instance.
+ * @param sockHandle          the handle of the socket.
+ * @param[in,out] pDatagrams  an array of count datagrams, the
+ *                            sizeBytes field of each one attempted
+ *                            being populated.
+ * @param count               the number of entries at pDatagrams.
+ * @return                    the number of datagrams sent else, if
+ *                            none were sent, negated value of
+ *                            U_SOCK_Exxx from u_sock_errno.h.
+ */
+int32_t uCellSockSendToBatch(uDeviceHandle_t cellHandle,
+                             int32_t sockHandle,
+                             uSockDatagram_t *pDatagrams,
+                             size_t count);
+
+/** Receive several datagrams under a single lock of the AT
+ * interface: datagrams are read back-to-back until count have
+ * been read or the module has no more, without waiting for
+ * more to arrive.  The pData, dataSizeBytes pair of each entry
+ * is as for uCellSockReceiveFrom() and pData cannot be NULL.
+ *
+ * @param cellHandle          the handle of the cellular instance.
+ * @param sockHandle          the handle of the socket.
+ * @param[in,out] pDatagrams  an array of count datagrams, the
+ *                            address and sizeBytes fields of those
+ *                            received being populated.
+ * @param count               the number of entries at pDatagrams.
+ * @return                    the number of datagrams received else,
+ *                            if none were received, negated value
+ *                            of U_SOCK_Exxx from u_sock_errno.h,
+ *                            -#U_SOCK_EWOULDBLOCK if there was
+ *                            nothing to receive.
+ */
+int32_t uCellSockReceiveFromBatch(uDeviceHandle_t cellHandle,
+                                  int32_t sockHandle,
+                                  uSockDatagram_t *pDatagrams,
+                                  size_t count);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: STREAM (TCP)
  * -------------------------------------------------------------- */
@@ -420,7 +627,29 @@ int32_t uCellSockWrite(uDeviceHandle_t cellHandle,
                        int32_t sockHandle,
                        const void *pData, size_t dataSizeBytes);
 
-/** Receive bytes on a connected socket.
+/** Send bytes gathered from several pieces of data over a
+ * connected socket: the pieces are sent in as few +USOWR commands
+ * as #U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES (or half this if hex mode
+ * is on) allows, i.e. small pieces share a single +USOWR.
+ *
+ * @param cellHandle     the handle of the cellular instance.
+ * @param sockHandle     the handle of the socket.
+ * @param[in] pIoVec     an array of ioVecCount pieces of data.
+ * @param ioVecCount     the number of entries at pIoVec.
+ * @return               the number of bytes sent on
+ *                       success else negated value
+ *                       of U_SOCK_Exxx from u_sock_errno.h.
+ */
+int32_t uCellSockWritev(uDeviceHandle_t cellHandle,
+                        int32_t sockHandle,
+                        const uSockIoVec_t *pIoVec, size_t ioVecCount);
+
+/** Receive bytes on a connected socket.  If a read-ahead buffer
+ * has been set with the #U_SOCK_OPT_RCVBUF socket option (see
+ * uCellSockOptionSet()) the read is served from that buffer where
+ * possible; should data be left in the buffer afterwards the data
+ * callback, if one is registered, is called again, since the module
+ * will not send a URC for data that has already been read from it.
  *
  * @param cellHandle     the handle of the cellular instance.
  * @param sockHandle     the handle of the socket.
@@ -435,11 +664,70 @@ int32_t uCellSockRead(uDeviceHandle_t cellHandle,
                       int32_t sockHandle,
                       void *pData, size_t dataSizeBytes);
 
+/* ----------------------------------------------------------------
+ * FUNCTIONS: DIRECT LINK
+ * -------------------------------------------------------------- */
+
+/** Put a connected socket into direct link mode (AT+USODL): the
+ * UART stream to the module then carries only the data of this
+ * socket, without any AT commands, framing or URCs, which allows
+ * bulk transfers at close to the rate of the UART.  While in
+ * direct link mode uCellSockWrite() and uCellSockRead() for this
+ * socket go straight to the UART and the AT client is kept locked,
+ * so it does not read the stream (hence any function set with
+ * uAtClientStreamInterceptRx() or uAtClientStreamInterceptTx()
+ * is not called either); this means that NO other function that
+ * sends AT commands to this cellular instance, including those
+ * for other sockets, may be called until uCellSockDirectLinkStop()
+ * has returned (if it were, it would block until then).  Only one
+ * socket per cellular instance may be in direct link mode and
+ * this is only possible where the module is connected to this
+ * MCU via a UART.  The data callback (see
+ * uCellSockRegisterCallbackData()) is not called in direct link
+ * mode, hence the caller must poll uCellSockRead().
+ *
+ * IMPORTANT: uCellSockDirectLinkStop() must be called from the
+ * same task that called this function since, on some platforms,
+ * a mutex may only be unlocked by the task that locked it.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @param sockHandle  the handle of the socket.
+ * @return            zero on success else negated value of
+ *                    U_SOCK_Exxx from u_sock_errno.h.
+ */
+int32_t uCellSockDirectLinkStart(uDeviceHandle_t cellHandle,
+                                 int32_t sockHandle);
+
+/** Take a socket out of direct link mode: once
+ * #U_CELL_SOCK_DIRECT_LINK_GUARD_TIME_MS has passed since the
+ * last write the "+++" escape sequence is sent, followed by the
+ * guard time again, then any socket data still arriving is
+ * discarded and the AT client is returned to command mode.  Note
+ * that some modules close the socket on leaving direct link mode
+ * (see the AT manual for your module), in which case the socket
+ * closed callback will be called, as usual.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @param sockHandle  the handle of the socket.
+ * @return            zero on success else negated value of
+ *                    U_SOCK_Exxx from u_sock_errno.h; even on
+ *                    failure the socket is no longer in direct
+ *                    link mode and the AT client is unlocked.
+ */
+int32_t uCellSockDirectLinkStop(uDeviceHandle_t cellHandle,
+                                int32_t sockHandle);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: ASYNC
  * -------------------------------------------------------------- */
 
-/** Register a callback on data being received.
+/** Register a callback on data being received.  The callback is
+ * called once when data arrives and is then not called again,
+ * however many more +UUSORD/+UUSORF URCs arrive from the module,
+ * until uCellSockRead(), uCellSockReceiveFrom() or
+ * uCellSockReceiveFromBatch() has been called for the socket;
+ * hence, on being called, the consumer should read until there
+ * is no more data.
  *
  * @param cellHandle    the handle of the cellular instance.
  * @param sockHandle    the handle of the socket.
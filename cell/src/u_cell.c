@@ -50,6 +50,11 @@
 #include "u_cell.h"         // Order is
 #include "u_cell_net.h"     // important here
 #include "u_cell_private.h" // don't change it
+#include "u_cell_mux_private.h"
+#include "u_cell_pwr.h"
+#include "u_cell_pwr_private.h"
+#include "u_cell_sec_private.h"
+#include "u_cell_sock_private.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -89,6 +94,9 @@ static void addCellInstance(uCellPrivateInstance_t *pInstance)
 {
     pInstance->pNext = gpUCellPrivateInstanceList;
     gpUCellPrivateInstanceList = pInstance;
+    // Point the device instance at us so that
+    // pUCellPrivateGetInstance() can find us directly
+    U_DEVICE_INSTANCE(pInstance->cellHandle)->pDriverInstance = pInstance;
 }
 
 // Remove a cell instance from the list.
@@ -117,12 +125,31 @@ static void removeCellInstance(uCellPrivateInstance_t *pInstance)
             uCellPrivateScanFree(&(pInstance->pScanResults));
             // Free any chip to chip security context
             uCellPrivateC2cRemoveContext(pInstance);
+            // Free any ZTP cache
+            uCellPrivateZtpCacheRemove(pInstance);
+            // Free any energy accounts
+            uCellPwrPrivateEnergyRemove(pInstance);
             // Free any location context and associated URC
             uCellPrivateLocRemoveContext(pInstance);
             // Free any sleep context
             uCellPrivateSleepRemoveContext(pInstance);
+            // Stop any radio parameter sampler
+            uCellPrivateRadioSamplerRemoveContext(pInstance);
+            // Stop any data counter sampler
+            uCellPrivateDataCounterSamplerRemoveContext(pInstance);
+            // Close down any multiplexer, putting the AT
+            // client back on the UART
+            uCellMuxPrivateRemoveContext(pInstance, true);
             // Free any FOTA context
             uPortFree(pInstance->pFotaContext);
+            // Free any band learning context
+            uPortFree(pInstance->pBandLearnContext);
+            // Free any deferred security heartbeat
+            uCellSecPrivateHeartbeatRemove(pInstance);
+            // Free any socket pool: the sockets in it
+            // go with the module
+            uCellSockPrivatePoolRemove(pInstance);
+            U_DEVICE_INSTANCE(pInstance->cellHandle)->pDriverInstance = NULL;
             uDeviceDestroyInstance(U_DEVICE_INSTANCE(pInstance->cellHandle));
             uPortFree(pInstance);
             pCurrent = NULL;
@@ -226,6 +253,10 @@ int32_t uCellAdd(uCellModuleType_t moduleType,
             // Check parameters
             handleOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
             if (((size_t) moduleType < gUCellPrivateModuleListSize) &&
+#ifdef U_CFG_CELL_MODULE_FIXED
+                // The driver is built for this module type only
+                (moduleType == (U_CFG_CELL_MODULE_FIXED)) &&
+#endif
                 (atHandle != NULL) &&
                 (pGetCellInstanceAtHandle(atHandle) == NULL)) {
                 handleOrErrorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
@@ -260,6 +291,7 @@ int32_t uCellAdd(uCellModuleType_t moduleType,
                     pInstance->pModule = &(gUCellPrivateModuleList[moduleType]);
                     pInstance->sockNextLocalPort = -1;
                     pInstance->deepSleepBlockedBy = -1;
+                    pInstance->baseStationConnection = -1;
 
                     // Now set up the pins
                     uPortLog("U_CELL: initialising with enable power pin ");
@@ -52,18 +52,58 @@ extern "C" {
  */
 #define _APN_GET(pCfg) *pCfg ? pCfg : NULL; pCfg  += strlen(pCfg) + 1
 
+/** Helper to generate an entry of #gApnLookUpTable: mcc is the mobile
+ * country code, mnc the mobile network code, mncDigits the number of
+ * digits, 2 or 3, in the MNC (since 26 and 026 are, in this context,
+ * different) and cfg the entry in #gApnConfig, a value from
+ * #uCellApnDbCfg_t.  The entry is packed into a uint32_t, key (see
+ * #U_CELL_APN_DB_KEY) uppermost, so that the look-up table, sorted,
+ * can be binary searched.
+ */
+#define U_CELL_APN_DB_ENTRY(mcc, mnc, mncDigits, cfg) ((U_CELL_APN_DB_KEY(mcc, mnc, mncDigits) << 11) | \
+                                                       ((uint32_t) (cfg)))
+
+/** Helper to form the key of an entry of #gApnLookUpTable, 21 bits.
+ */
+#define U_CELL_APN_DB_KEY(mcc, mnc, mncDigits) ((((uint32_t) (mcc)) << 11) |         \
+                                                ((mncDigits) == 3 ? (1UL << 10) : 0) | \
+                                                ((uint32_t) (mnc)))
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
-/** APN lookup structure.
+/** The APN configurations, indexes into #gApnConfig.
  */
-typedef struct {
-    const char *pMccMnc; /**< mobile country code (MCC) and
-                              mobile network code (MNC). */
-    const char *pCfg;    /**< APN configuration string, use
-                              _APN macro to generate. */
-} uCellNetApn_t;
+typedef enum {
+    U_CELL_APN_DB_CFG_TMOBILE_AT,
+    U_CELL_APN_DB_CFG_CN_MOBILE,
+    U_CELL_APN_DB_CFG_CN_UNICOM,
+    U_CELL_APN_DB_CFG_TMOBILE_DE,
+    U_CELL_APN_DB_CFG_TMOBILE_DE_M2M,
+    U_CELL_APN_DB_CFG_TIM_IT,
+    U_CELL_APN_DB_CFG_VODAFONE_IT,
+    U_CELL_APN_DB_CFG_WIND_IT,
+    U_CELL_APN_DB_CFG_SOFTBANK_JP,
+    U_CELL_APN_DB_CFG_NTT_DOCOMO_JP,
+    U_CELL_APN_DB_CFG_VODAFONE_NL,
+    U_CELL_APN_DB_CFG_SIMOBIL_SI,
+    U_CELL_APN_DB_CFG_TUSMOBIL_SI,
+    U_CELL_APN_DB_CFG_TELIA_SE,
+    U_CELL_APN_DB_CFG_TELENOR_SE,
+    U_CELL_APN_DB_CFG_TELE2_SE,
+    U_CELL_APN_DB_CFG_SWISSCOM_CH,
+    U_CELL_APN_DB_CFG_ORANGE_CH,
+    U_CELL_APN_DB_CFG_TELEFONICA_GB,
+    U_CELL_APN_DB_CFG_VODAFONE_GB,
+    U_CELL_APN_DB_CFG_THREE_GB,
+    U_CELL_APN_DB_CFG_JERSEY_GB,
+    U_CELL_APN_DB_CFG_TMOBILE_US,
+    U_CELL_APN_DB_CFG_ATT_US,
+    U_CELL_APN_DB_CFG_TRANSATEL_INT,
+    U_CELL_APN_DB_CFG_TELEFONICA_ES,
+    U_CELL_APN_DB_CFG_MAX_NUM
+} uCellApnDbCfg_t;
 
 /* ----------------------------------------------------------------
  * VARIABLES
@@ -73,113 +113,222 @@ typedef struct {
  */
 static const char *const pApnDefault = _APN("internet",,);
 
-/** List of special APNs for different network operators.
+/** The APN configurations of the network operators, in the order of
+ * #uCellApnDbCfg_t; each is stored once, however many MCC/MNC
+ * combinations of #gApnLookUpTable use it.
  *
  * No need to add default, "internet" will be used as a default if
  * no entry matches.
  * The APN without username/password have to be listed first.
  */
-static const uCellNetApn_t gApnLookUpTable[] = {
-// MCC Country
-//  { /* Operator */ "MCC-MNC[,MNC]" _APN(APN, USERNAME, PASSWORD) },
-// MCC must be 3 digits
-// MNC must be either 2 or 3 digits
-// MCC must be separated by '-' from MNC, multiple MNC can be separated by ','
+static const char *const gApnConfig[] = {
+    /* T-Mobile AT */   _APN("m2m.business",,),
+    /* CN Mobile */     _APN("cmnet",,)
+    _APN("cmwap",,),
+    /* Unicom */        _APN("3gnet",,)
+    _APN("uninet", "uninet", "uninet"),
+    /* T-Mobile DE */   _APN("internet.t-mobile", "t-mobile", "tm"),
+    /* T-Mobile DE */   _APN("m2m.business",,),
+    /* TIM */           _APN("ibox.tim.it",,),
+    /* Vodafone IT */   _APN("web.omnitel.it",,),
+    /* Wind */          _APN("internet.wind.biz",,),
+    /* Softbank */      _APN("open.softbank.ne.jp", "opensoftbank", "ebMNuX1FIHg9d3DA")
+    _APN("smile.world", "dna1trop", "so2t3k3m2a"),
+    /* NTTDoCoMo */     _APN("bmobilewap",,) /*BMobile*/
+    _APN("mpr2.bizho.net", "Mopera U",) /* DoCoMo */
+    _APN("bmobile.ne.jp", "bmobile@wifi2", "bmobile"), /*BMobile*/
+    /* Vodafone NL */   _APN("public4.m2minternet.com",,),
+    /* Si.mobil */      _APN("internet.simobil.si",,),
+    /* Tusmobil */      _APN("internet.tusmobil.si",,),
+    /* Telia */         _APN("online.telia.se",,),
+    /* Telenor */       _APN("services.telenor.se",,),
+    /* Tele2 */         _APN("mobileinternet.tele2.se",,),
+    /* Swisscom */      _APN("gprs.swisscom.ch",,),
+    /* Orange */        _APN("internet",,) /* contract */
+    _APN("click",,),    /* pre-pay */
+    /* Telefonica GB */ _APN("mobile.o2.co.uk", "faster", "web") /* contract */
+    _APN("mobile.o2.co.uk", "bypass", "web") /* pre-pay */
+    _APN("payandgo.o2.co.uk", "payandgo", "payandgo"),
+    /* Vodafone GB */   _APN("internet", "web", "web") /* contract */
+    _APN("pp.vodafone.co.uk", "wap", "wap"),  /* pre-pay */
+    /* Three */         _APN("three.co.uk",,),
+    /* Jersey */        _APN("jtm2m",,), /* as used on u-blox C030 U201 boards */
+    /* T-Mobile US */   _APN("epc.tmobile.com",,)
+    _APN("fast.tmobile.com",,), /* LTE */
+    /* AT&T */          _APN("phone",,)
+    _APN("wap.cingular", "WAP@CINGULARGPRS.COM", "CINGULAR1")
+    _APN("isp.cingular", "ISP@CINGULARGPRS.COM", "CINGULAR1"),
+    /* Transatel */     _APN("netgprs.com", "tsl", "tsl"),
+    /* Telefonica ES */ _APN("m2mtrial.telefonica.com",,) /* Cat-M1 */
+};
 
-// 232 Austria - AUT
-    { /* T-Mobile */ "232-03",  _APN("m2m.business",,) },
+/** Look-up table from MCC/MNC to APN configuration, binary searched
+ * and hence MUST be kept sorted by MCC, then by number of MNC digits,
+ * then by MNC; use #U_CELL_APN_DB_ENTRY to form an entry.  An
+ * MCC/MNC that appears more than once is matched to an unpredictable
+ * one of its entries, so don't do that.
+ */
+static const uint32_t gApnLookUpTable[] = {
+// 204 Netherlands - NL
+    U_CELL_APN_DB_ENTRY(204, 4, 2, U_CELL_APN_DB_CFG_VODAFONE_NL),
 
-// 460 China - CN
-    { /* CN Mobile */"460-00",  _APN("cmnet",,)
-        _APN("cmwap",,)
-    },
-    { /* Unicom */   "460-01",  _APN("3gnet",,)
-        _APN("uninet", "uninet", "uninet")
-    },
-
-// 262 Germany - DE
-    { /* T-Mobile */ "262-01",  _APN("internet.t-mobile", "t-mobile", "tm") },
-    { /* T-Mobile */ "262-02,06",
-        _APN("m2m.business",,)
-    },
+// 214 Spain - ES
+    U_CELL_APN_DB_ENTRY(214, 7, 2, U_CELL_APN_DB_CFG_TELEFONICA_ES),
 
 // 222 Italy - IT
-    { /* TIM */      "222-01",  _APN("ibox.tim.it",,) },
-    { /* Vodafone */ "222-10",  _APN("web.omnitel.it",,) },
-    { /* Wind */     "222-88",  _APN("internet.wind.biz",,) },
-
-// 440 Japan - JP
-//lint -e{786} Suppress concatenation within initialiser
-    { /* Softbank */ "440-04,06,20,40,41,42,43,44,45,46,47,48,90,91,92,93,94,95"
-        ",96,97,98",
-        _APN("open.softbank.ne.jp", "opensoftbank", "ebMNuX1FIHg9d3DA")
-        _APN("smile.world", "dna1trop", "so2t3k3m2a")
-    },
-//lint -e{786} Suppress concatenation within initialiser
-    { /* NTTDoCoMo */ "440-09,10,11,12,13,14,15,16,17,18,19,21,22,23,24,25,26,27,"
-        "28,29,30,31,32,33,34,35,36,37,38,39,58,59,60,61,62,63,"
-        "64,65,66,67,68,69,87,99",
-        _APN("bmobilewap",,) /*BMobile*/
-        _APN("mpr2.bizho.net", "Mopera U",) /* DoCoMo */
-        _APN("bmobile.ne.jp", "bmobile@wifi2", "bmobile") /*BMobile*/
-    },
+    U_CELL_APN_DB_ENTRY(222, 1, 2, U_CELL_APN_DB_CFG_TIM_IT),
+    U_CELL_APN_DB_ENTRY(222, 10, 2, U_CELL_APN_DB_CFG_VODAFONE_IT),
+    U_CELL_APN_DB_ENTRY(222, 88, 2, U_CELL_APN_DB_CFG_WIND_IT),
 
-// 204 Netherlands - NL
-    { /* Vodafone */ "204-04",  _APN("public4.m2minternet.com",,) },
+// 228 Switzerland - CH
+    U_CELL_APN_DB_ENTRY(228, 1, 2, U_CELL_APN_DB_CFG_SWISSCOM_CH),
+    U_CELL_APN_DB_ENTRY(228, 3, 2, U_CELL_APN_DB_CFG_ORANGE_CH),
 
-// 293 Slovenia - SI
-    { /* Si.mobil */ "293-40",  _APN("internet.simobil.si",,) },
-    { /* Tusmobil */ "293-70",  _APN("internet.tusmobil.si",,) },
+// 232 Austria - AUT
+    U_CELL_APN_DB_ENTRY(232, 3, 2, U_CELL_APN_DB_CFG_TMOBILE_AT),
 
-// 240 Sweden SE
-    { /* Telia */    "240-01",  _APN("online.telia.se",,) },
-    { /* Telenor */  "240-06,08",
-        _APN("services.telenor.se",,)
-    },
-    { /* Tele2 */    "240-07",  _APN("mobileinternet.tele2.se",,) },
+// 234 United Kingdom - GB
+    U_CELL_APN_DB_ENTRY(234, 2, 2, U_CELL_APN_DB_CFG_TELEFONICA_GB),
+    U_CELL_APN_DB_ENTRY(234, 10, 2, U_CELL_APN_DB_CFG_TELEFONICA_GB),
+    U_CELL_APN_DB_ENTRY(234, 11, 2, U_CELL_APN_DB_CFG_TELEFONICA_GB),
+    U_CELL_APN_DB_ENTRY(234, 15, 2, U_CELL_APN_DB_CFG_VODAFONE_GB),
+    U_CELL_APN_DB_ENTRY(234, 20, 2, U_CELL_APN_DB_CFG_THREE_GB),
+    U_CELL_APN_DB_ENTRY(234, 50, 2, U_CELL_APN_DB_CFG_JERSEY_GB),
+
+// 240 Sweden - SE
+    U_CELL_APN_DB_ENTRY(240, 1, 2, U_CELL_APN_DB_CFG_TELIA_SE),
+    U_CELL_APN_DB_ENTRY(240, 6, 2, U_CELL_APN_DB_CFG_TELENOR_SE),
+    U_CELL_APN_DB_ENTRY(240, 7, 2, U_CELL_APN_DB_CFG_TELE2_SE),
+    U_CELL_APN_DB_ENTRY(240, 8, 2, U_CELL_APN_DB_CFG_TELENOR_SE),
 
-// 228 Switzerland - CH
-    { /* Swisscom */ "228-01",  _APN("gprs.swisscom.ch",,) },
-    { /* Orange */   "228-03",  _APN("internet",,) /* contract */
-        _APN("click",,)    /* pre-pay */
-    },
+// 262 Germany - DE
+    U_CELL_APN_DB_ENTRY(262, 1, 2, U_CELL_APN_DB_CFG_TMOBILE_DE),
+    U_CELL_APN_DB_ENTRY(262, 2, 2, U_CELL_APN_DB_CFG_TMOBILE_DE_M2M),
+    U_CELL_APN_DB_ENTRY(262, 6, 2, U_CELL_APN_DB_CFG_TMOBILE_DE_M2M),
 
-// 234 United Kingdom - GB
-    { /* Telefonica */       "234-02,10,11",
-        _APN("mobile.o2.co.uk", "faster", "web") /* contract */
-        _APN("mobile.o2.co.uk", "bypass", "web") /* pre-pay */
-        _APN("payandgo.o2.co.uk", "payandgo", "payandgo")
-    },
-    { /* Vodafone */ "234-15",  _APN("internet", "web", "web") /* contract */
-        _APN("pp.vodafone.co.uk", "wap", "wap")  /* pre-pay */
-    },
-    { /* Three */    "234-20",  _APN("three.co.uk",,) },
-    { /* Jersey */   "234-50",  _APN("jtm2m",,) /* as used on u-blox C030 U201 boards */ },
+// 293 Slovenia - SI
+    U_CELL_APN_DB_ENTRY(293, 40, 2, U_CELL_APN_DB_CFG_SIMOBIL_SI),
+    U_CELL_APN_DB_ENTRY(293, 70, 2, U_CELL_APN_DB_CFG_TUSMOBIL_SI),
 
 // 310 United States of America - US
-    { /* T-Mobile */ "310-026,260,490",
-        _APN("epc.tmobile.com",,)
-        _APN("fast.tmobile.com",,) /* LTE */
-    },
-    { /* AT&T */     "310-030,150,170,260,410,560,680",
-        _APN("phone",,)
-        _APN("wap.cingular", "WAP@CINGULARGPRS.COM", "CINGULAR1")
-        _APN("isp.cingular", "ISP@CINGULARGPRS.COM", "CINGULAR1")
-    },
+    U_CELL_APN_DB_ENTRY(310, 26, 3, U_CELL_APN_DB_CFG_TMOBILE_US),
+    U_CELL_APN_DB_ENTRY(310, 30, 3, U_CELL_APN_DB_CFG_ATT_US),
+    U_CELL_APN_DB_ENTRY(310, 150, 3, U_CELL_APN_DB_CFG_ATT_US),
+    U_CELL_APN_DB_ENTRY(310, 170, 3, U_CELL_APN_DB_CFG_ATT_US),
+    U_CELL_APN_DB_ENTRY(310, 260, 3, U_CELL_APN_DB_CFG_TMOBILE_US),
+    U_CELL_APN_DB_ENTRY(310, 410, 3, U_CELL_APN_DB_CFG_ATT_US),
+    U_CELL_APN_DB_ENTRY(310, 490, 3, U_CELL_APN_DB_CFG_TMOBILE_US),
+    U_CELL_APN_DB_ENTRY(310, 560, 3, U_CELL_APN_DB_CFG_ATT_US),
+    U_CELL_APN_DB_ENTRY(310, 680, 3, U_CELL_APN_DB_CFG_ATT_US),
 
-// 901 International - INT
-    { /* Transatel */ "901-37", _APN("netgprs.com", "tsl", "tsl") },
+// 440 Japan - JP
+    U_CELL_APN_DB_ENTRY(440, 4, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 6, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 9, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 10, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 11, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 12, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 13, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 14, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 15, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 16, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 17, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 18, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 19, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 20, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 21, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 22, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 23, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 24, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 25, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 26, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 27, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 28, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 29, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 30, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 31, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 32, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 33, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 34, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 35, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 36, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 37, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 38, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 39, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 40, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 41, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 42, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 43, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 44, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 45, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 46, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 47, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 48, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 58, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 59, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 60, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 61, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 62, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 63, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 64, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 65, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 66, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 67, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 68, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 69, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 87, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
+    U_CELL_APN_DB_ENTRY(440, 90, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 91, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 92, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 93, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 94, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 95, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 96, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 97, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 98, 2, U_CELL_APN_DB_CFG_SOFTBANK_JP),
+    U_CELL_APN_DB_ENTRY(440, 99, 2, U_CELL_APN_DB_CFG_NTT_DOCOMO_JP),
 
-// 214 Spain
-    { /* Telefonica */       "214-07",
-        _APN("m2mtrial.telefonica.com",,) /* Cat-M1 */
-    },
+// 460 China - CN
+    U_CELL_APN_DB_ENTRY(460, 0, 2, U_CELL_APN_DB_CFG_CN_MOBILE),
+    U_CELL_APN_DB_ENTRY(460, 1, 2, U_CELL_APN_DB_CFG_CN_UNICOM),
+
+// 901 International - INT
+    U_CELL_APN_DB_ENTRY(901, 37, 2, U_CELL_APN_DB_CFG_TRANSATEL_INT),
 };
 
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
 
+/** Find the APN configuration for the given key, formed with
+ * #U_CELL_APN_DB_KEY, in #gApnLookUpTable.
+ *
+ * @param key  the key.
+ * @return     the APN configuration string, NULL if there is none.
+ */
+static const char *pApnFind(uint32_t key)
+{
+    const char *pConfig = NULL;
+    size_t lower = 0;
+    size_t upper = sizeof(gApnLookUpTable) / sizeof(gApnLookUpTable[0]);
+    size_t x;
+    uint32_t entryKey;
+
+    while ((lower < upper) && (pConfig == NULL)) {
+        x = lower + ((upper - lower) / 2);
+        entryKey = gApnLookUpTable[x] >> 11;
+        if (entryKey < key) {
+            lower = x + 1;
+        } else if (entryKey > key) {
+            upper = x;
+        } else {
+            pConfig = gApnConfig[gApnLookUpTable[x] & 0x7ff];
+        }
+    }
+
+    return pConfig;
+}
+
 /** Configuring APN by extraction from IMSI and matching the table.
  *
  * @param pImsi  string containing IMSI.
@@ -188,29 +337,27 @@ static const uCellNetApn_t gApnLookUpTable[] = {
 static const char *pApnGetConfig(const char *pImsi)
 {
     const char *pConfig = NULL;
-    const char *pStr;
-    size_t length;
-
-    if ((pImsi != NULL) && (*pImsi != '\0')) {
-        // Many carriers use internet without username and password,
-        // so use this as default now try to lookup the setting
-        // for our table
-        for (size_t x = 0; x < sizeof(gApnLookUpTable) / sizeof(*gApnLookUpTable) &&
-             !pConfig; x++) {
-            pStr = gApnLookUpTable[x].pMccMnc;
-            // Check the MCC
-            if (memcmp(pImsi, pStr, 3) == 0) {
-                pStr += 3;
-                // Check all the MNC, MNC length can be 2 or 3 digits
-                while (((*(pStr + 0) == '-') || (*(pStr + 0) == ',')) &&
-                       (*(pStr + 1) >= '0') && (*(pStr + 1) <= '9') &&
-                       (*(pStr + 2) >= '0') && (*(pStr + 2) <= '9') && !pConfig) {
-                    length = ((*(pStr + 3) >= '0') && (*(pStr + 3) <= '9')) ? 3 : 2;
-                    if (memcmp(pImsi + 3, pStr + 1, length) == 0) {
-                        pConfig = gApnLookUpTable[x].pCfg;
-                    }
-                    pStr += length + 1;
-                }
+    size_t digits = 0;
+    uint32_t mcc = 0;
+    uint32_t mnc = 0;
+
+    if (pImsi != NULL) {
+        // The MCC is 3 digits and the MNC 2 or 3
+        while ((digits < 6) && (*(pImsi + digits) >= '0') &&
+               (*(pImsi + digits) <= '9')) {
+            digits++;
+        }
+        if (digits >= 5) {
+            mcc = ((*(pImsi + 0) - '0') * 100) + ((*(pImsi + 1) - '0') * 10) +
+                  (*(pImsi + 2) - '0');
+            mnc = ((*(pImsi + 3) - '0') * 10) + (*(pImsi + 4) - '0');
+            // Many carriers use internet without username and password,
+            // so use this as default now try to lookup the setting
+            // for our table, two-digit MNC first
+            pConfig = pApnFind(U_CELL_APN_DB_KEY(mcc, mnc, 2));
+            if ((pConfig == NULL) && (digits == 6)) {
+                mnc = (mnc * 10) + (*(pImsi + 5) - '0');
+                pConfig = pApnFind(U_CELL_APN_DB_KEY(mcc, mnc, 3));
             }
         }
     }
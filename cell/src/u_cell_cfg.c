@@ -28,6 +28,7 @@
 # include "u_cfg_override.h" // For a customer's configuration override
 #endif
 
+#include "stdio.h"     // snprintf()
 #include "stdlib.h"    // strol(), atoi(), strol(), strtof()
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
@@ -43,6 +44,8 @@
 
 #include "u_at_client.h"
 
+#include "u_time.h"
+
 #include "u_cell_module_type.h"
 #include "u_cell_file.h"
 #include "u_cell.h"         // Order is
@@ -703,7 +706,7 @@ static int32_t setRatSaraRx(uCellPrivateInstance_t *pInstance,
     uAtClientHandle_t atHandle = pInstance->atHandle;
     int32_t cFunMode = -1;
 
-    if (pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_SARA_R5) {
+    if (U_CELL_PRIVATE_MODULE_IS(pInstance->pModule, U_CELL_MODULE_TYPE_SARA_R5)) {
         // For SARA-R5 the module has to be in state AT+CFUN=0
         cFunMode = uCellPrivateCFunGet(pInstance);
         if (cFunMode != 0) {
@@ -766,7 +769,7 @@ static int32_t setRatRankSaraRx(uCellPrivateInstance_t *pInstance,
         }
     }
 
-    if (pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_SARA_R5) {
+    if (U_CELL_PRIVATE_MODULE_IS(pInstance->pModule, U_CELL_MODULE_TYPE_SARA_R5)) {
         // For SARA-R5 the module has to be in state AT+CFUN=0
         cFunMode = uCellPrivateCFunGet(pInstance);
         if (cFunMode != 0) {
@@ -1006,7 +1009,7 @@ int32_t uCellCfgGetBandMask(uDeviceHandle_t cellHandle,
                 rats[x] = (int32_t) moduleRatBandMaskToCellRat(pInstance->pModule->moduleType, rats[x]);
             }
 
-            if (pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_LARA_R6) {
+            if (U_CELL_PRIVATE_MODULE_IS(pInstance->pModule, U_CELL_MODULE_TYPE_LARA_R6)) {
                 // LARA-R6 uses the same band-mask number for both 2G and 3G, which
                 // will have been converted to our 2G RAT number by
                 // moduleRatBandMaskToCellRat() so, if the user has asked for
@@ -1060,7 +1063,7 @@ int32_t uCellCfgSetRat(uDeviceHandle_t cellHandle,
                 // different between SARA-U2 versus
                 // SARA-R4/R5 so do them in separate
                 // functions
-                if (pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_SARA_U201) {
+                if (U_CELL_PRIVATE_MODULE_IS(pInstance->pModule, U_CELL_MODULE_TYPE_SARA_U201)) {
                     errorCode = setRatSaraU2(pInstance, rat);
                 } else {
                     // Do the mode change
@@ -1107,7 +1110,7 @@ int32_t uCellCfgSetRatRank(uDeviceHandle_t cellHandle,
                 // different between SARA-U2 versus
                 // SARA-R4/R5 so do them in separate
                 // functions
-                if (pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_SARA_U201) {
+                if (U_CELL_PRIVATE_MODULE_IS(pInstance->pModule, U_CELL_MODULE_TYPE_SARA_U201)) {
                     errorCode = setRatRankSaraU2(pInstance, rat, rank);
                 } else {
                     errorCode = setRatRankSaraRx(pInstance, rat, rank);
@@ -1147,7 +1150,7 @@ uCellNetRat_t uCellCfgGetRat(uDeviceHandle_t cellHandle,
             // different between SARA-U2 versus
             // SARA-R4/R5 so do them in separate
             // functions
-            if (pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_SARA_U201) {
+            if (U_CELL_PRIVATE_MODULE_IS(pInstance->pModule, U_CELL_MODULE_TYPE_SARA_U201)) {
                 errorCodeOrRat = (int32_t) getRatSaraU2(pInstance, rank);
             } else {
                 errorCodeOrRat = (int32_t) getRatSaraRx(pInstance, rank);
@@ -1181,7 +1184,7 @@ int32_t uCellCfgGetRatRank(uDeviceHandle_t cellHandle,
             // different between SARA-U2 versus
             // SARA-R4/R5 so do them in separate
             // functions
-            if (pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_SARA_U201) {
+            if (U_CELL_PRIVATE_MODULE_IS(pInstance->pModule, U_CELL_MODULE_TYPE_SARA_U201)) {
                 errorCodeOrRank = (int32_t) getRatRankSaraU2(pInstance, rat);
             } else {
                 errorCodeOrRank = (int32_t) getRatRankSaraRx(pInstance, rat);
@@ -1228,6 +1231,9 @@ int32_t uCellCfgSetMnoProfile(uDeviceHandle_t cellHandle,
                 errorCode = uAtClientUnlock(atHandle);
                 if (errorCode == 0) {
                     pInstance->rebootIsRequired = true;
+                    // Changing the MNO profile may change other
+                    // non-volatile settings
+                    pInstance->configFingerprint = 0;
                     uPortLog("U_CELL_CFG: MNO profile set to %d.\n",
                              mnoProfile);
                 } else {
@@ -1383,6 +1389,9 @@ int32_t uCellCfgSetUdconf(uDeviceHandle_t cellHandle, int32_t param1,
             }
             uAtClientCommandStopReadResponse(atHandle);
             errorCode = uAtClientUnlock(atHandle);
+            // Whatever the outcome, this may have hit one of
+            // the non-volatile settings written at power-on
+            pInstance->configFingerprint = 0;
             if (errorCode == 0) {
                 pInstance->rebootIsRequired = true;
             }
@@ -1471,6 +1480,9 @@ int32_t uCellCfgFactoryReset(uDeviceHandle_t cellHandle, int32_t fsRestoreType,
             uAtClientCommandStopReadResponse(atHandle);
             // Unlock mutex after using AT client.
             errorCode = uAtClientUnlock(atHandle);
+            // The non-volatile settings written at power-on
+            // will need writing again
+            pInstance->configFingerprint = 0;
             if (errorCode == 0) {
                 pInstance->rebootIsRequired = true;
             }
@@ -1688,5 +1700,47 @@ bool uCellCfgAutoBaudIsOn(uDeviceHandle_t cellHandle)
 
     return autoBaudOn;
 }
+// Set the real-time clock of the cellular module.
+int32_t uCellCfgSetTimeUtc(uDeviceHandle_t cellHandle, int64_t timeUtc)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uAtClientHandle_t atHandle;
+    uTimeBrokenDown_t brokenDown;
+    // Enough room for "yy/MM/dd,hh:mm:ss+00" and a terminator
+    // Room for "yy/MM/dd,hh:mm:ss+00" if each field were the
+    // longest possible int, so that the compiler can see there is
+    // no truncation, though in practice only 21 bytes are used
+    char buffer[(6 * 11) + 5 + 3 + 1];
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        uTimeSecondsUtcToBrokenDown(timeUtc, &brokenDown);
+        if ((pInstance != NULL) && (brokenDown.year >= 2000) &&
+            (brokenDown.year <= 2099)) {
+            atHandle = pInstance->atHandle;
+            snprintf(buffer, sizeof(buffer), "%02d/%02d/%02d,%02d:%02d:%02d+00",
+                     (int) (brokenDown.year - 2000), (int) brokenDown.month,
+                     (int) brokenDown.day, (int) brokenDown.hour,
+                     (int) brokenDown.minute, (int) brokenDown.second);
+            uAtClientLock(atHandle);
+            uAtClientCommandStart(atHandle, "AT+CCLK=");
+            uAtClientWriteString(atHandle, buffer, true);
+            uAtClientCommandStopReadResponse(atHandle);
+            errorCode = uAtClientUnlock(atHandle);
+            if (errorCode == 0) {
+                uPortLog("U_CELL_CFG: time set to %s.\n", buffer);
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
 
 // End of file
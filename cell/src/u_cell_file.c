@@ -39,6 +39,7 @@
 #include "u_error_common.h"
 #include "u_port.h"
 #include "u_port_os.h"
+#include "u_port_heap.h"
 #include "u_at_client.h"
 #include "u_cell_module_type.h"
 #include "u_cell_net.h"
@@ -58,6 +59,39 @@ static uCellPrivateFileListContainer_t *gpFileList = NULL;
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Get the size of a file: gUCellPrivateMutex must be locked
+// but the AT client must not be.
+static int32_t fileSize(const uCellPrivateInstance_t *pInstance,
+                        const char *pFileName)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    int32_t size;
+
+    // Do the ULSTFILE thang with the AT interface
+    uAtClientLock(atHandle);
+    uAtClientCommandStart(atHandle, "AT+ULSTFILE=");
+    // Write get file size op_code
+    uAtClientWriteInt(atHandle, 2);
+    // Write file name
+    uAtClientWriteString(atHandle, pFileName, true);
+    if (pInstance->pFileSystemTag != NULL) {
+        // Write tag
+        uAtClientWriteString(atHandle, pInstance->pFileSystemTag, true);
+    }
+    uAtClientCommandStop(atHandle);
+    // Grab the response
+    uAtClientResponseStart(atHandle, "+ULSTFILE:");
+    // Read file size
+    size = uAtClientReadInt(atHandle);
+    uAtClientResponseStop(atHandle);
+    if (uAtClientUnlock(atHandle) == 0) {
+        errorCode = size;
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -172,6 +206,110 @@ int32_t uCellFileWrite(uDeviceHandle_t cellHandle,
     return errorCode;
 }
 
+// Write data into a file, pulling it from a callback.
+int32_t uCellFileStreamWrite(uDeviceHandle_t cellHandle,
+                             const char *pFileName,
+                             size_t dataSize,
+                             int32_t (*pCallback) (uDeviceHandle_t,
+                                                   char *, size_t,
+                                                   size_t, void *),
+                             void *pCallbackParam,
+                             size_t chunkSize)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uAtClientHandle_t atHandle;
+    char *pBuffer = NULL;
+    int32_t thisSize;
+    int32_t callbackErrorOrSize = 0;
+    size_t bytesWritten = 0;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        // Check parameters
+        if ((pInstance != NULL) && (pCallback != NULL) && (pFileName != NULL) &&
+            (strlen(pFileName) <= U_CELL_FILE_NAME_MAX_LENGTH)) {
+            if (chunkSize == 0) {
+                chunkSize = U_CELL_FILE_STREAM_WRITE_CHUNK_SIZE_BYTES;
+            }
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pBuffer = (char *) pUPortMalloc(chunkSize);
+            if (pBuffer != NULL) {
+                errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+                atHandle = pInstance->atHandle;
+                // Same as uCellFileWrite() except that the data
+                // is fetched from the callback a chunk at a time
+                uAtClientLock(atHandle);
+                uAtClientCommandStart(atHandle, "AT+UDWNFILE=");
+                // Write file name
+                uAtClientWriteString(atHandle, pFileName, true);
+                // Write size of data to be written into the file
+                uAtClientWriteInt(atHandle, (int32_t) dataSize);
+                if (pInstance->pFileSystemTag != NULL) {
+                    // Write tag
+                    uAtClientWriteString(atHandle, pInstance->pFileSystemTag, true);
+                }
+                uAtClientCommandStop(atHandle);
+                // Wait for the prompt
+                if (uAtClientWaitCharacter(atHandle, '>') == 0) {
+                    // Allow plenty of time for this to complete
+                    uAtClientTimeoutSet(atHandle, 10000);
+                    uPortTaskBlock(50);
+                    while ((bytesWritten < dataSize) && (callbackErrorOrSize >= 0)) {
+                        thisSize = (int32_t) chunkSize;
+                        if ((size_t) thisSize > dataSize - bytesWritten) {
+                            thisSize = (int32_t) (dataSize - bytesWritten);
+                        }
+                        callbackErrorOrSize = pCallback(cellHandle, pBuffer,
+                                                        (size_t) thisSize,
+                                                        bytesWritten,
+                                                        pCallbackParam);
+                        if ((callbackErrorOrSize > 0) && (callbackErrorOrSize <= thisSize) &&
+                            (uAtClientWriteBytes(atHandle, pBuffer,
+                                                 (size_t) callbackErrorOrSize,
+                                                 true) == (size_t) callbackErrorOrSize)) {
+                            bytesWritten += (size_t) callbackErrorOrSize;
+                        } else if (callbackErrorOrSize >= 0) {
+                            // Nothing from the callback, too much from
+                            // the callback or the write failed
+                            callbackErrorOrSize = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+                        }
+                    }
+                    if (bytesWritten == dataSize) {
+                        // Grab the response
+                        uAtClientCommandStopReadResponse(atHandle);
+                    } else {
+                        // The module is still waiting for data:
+                        // there is no way to cancel, it will give up
+                        // and return an error in its own time
+                        uAtClientResponseStart(atHandle, NULL);
+                        uAtClientResponseStop(atHandle);
+                    }
+                    if ((uAtClientUnlock(atHandle) == 0) && (bytesWritten == dataSize)) {
+                        errorCode = (int32_t) bytesWritten;
+                    } else if (callbackErrorOrSize < 0) {
+                        errorCode = callbackErrorOrSize;
+                    }
+                } else {
+                    // Best to tidy whatever might have arrived instead
+                    // of the prompt before exiting
+                    uAtClientResponseStop(atHandle);
+                    errorCode = uAtClientUnlock(atHandle);
+                }
+                uPortFree(pBuffer);
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
 // Read data from file.
 int32_t uCellFileRead(uDeviceHandle_t cellHandle,
                       const char *pFileName,
@@ -340,14 +478,134 @@ int32_t uCellFileBlockRead(uDeviceHandle_t cellHandle,
     return errorCode;
 }
 
+// Stream the contents of a file, block by block.
+int32_t uCellFileStreamRead(uDeviceHandle_t cellHandle,
+                            const char *pFileName,
+                            bool (*pCallback) (uDeviceHandle_t,
+                                               const char *,
+                                               size_t, size_t,
+                                               void *),
+                            void *pCallbackParam,
+                            size_t chunkSize)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uAtClientHandle_t atHandle;
+    int32_t size;
+    int32_t thisSize;
+    int32_t indicatedReadSize;
+    int32_t peekSize;
+    const char *pData = NULL;
+    size_t offset = 0;
+    size_t totalSize = 0;
+    bool keepGoing = true;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        // Check parameters
+        if ((pInstance != NULL) && (pCallback != NULL) && (pFileName != NULL) &&
+            (strlen(pFileName) <= U_CELL_FILE_NAME_MAX_LENGTH)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            // As for uCellFileBlockRead(), no tags
+            if (pInstance->pFileSystemTag == NULL) {
+                if (chunkSize == 0) {
+                    chunkSize = U_CELL_FILE_STREAM_READ_CHUNK_SIZE_BYTES;
+                }
+                // Need the size so as not to ask for a block
+                // beyond the end of the file
+                size = fileSize(pInstance, pFileName);
+                errorCode = size;
+                if (size >= 0) {
+                    atHandle = pInstance->atHandle;
+                    // Keep the AT client locked for the whole transfer
+                    // so that each URDBLOCK follows straight on from
+                    // the last
+                    uAtClientLock(atHandle);
+                    while (keepGoing && (offset < (size_t) size) &&
+                           (uAtClientErrorGet(atHandle) == 0)) {
+                        thisSize = (int32_t) chunkSize;
+                        if (thisSize > size - (int32_t) offset) {
+                            thisSize = size - (int32_t) offset;
+                        }
+                        uAtClientCommandStart(atHandle, "AT+URDBLOCK=");
+                        uAtClientWriteString(atHandle, pFileName, true);
+                        uAtClientWriteInt(atHandle, (int32_t) offset);
+                        uAtClientWriteInt(atHandle, thisSize);
+                        uAtClientCommandStop(atHandle);
+                        if (U_CELL_PRIVATE_MODULE_IS_SARA_R4(pInstance->pModule->moduleType)) {
+                            // SARA-R4 only puts \n before the
+                            // response, not \r\n as it should
+                            uAtClientResponseStart(atHandle, "\n+URDBLOCK:");
+                        } else {
+                            uAtClientResponseStart(atHandle, "+URDBLOCK:");
+                        }
+                        // Skip the file name
+                        uAtClientSkipParameters(atHandle, 1);
+                        indicatedReadSize = uAtClientReadInt(atHandle);
+                        if (indicatedReadSize > thisSize) {
+                            // Don't believe it
+                            indicatedReadSize = -1;
+                        }
+                        if (indicatedReadSize > 0) {
+                            // Don't stop for anything!
+                            uAtClientIgnoreStopTag(atHandle);
+                            // Get the leading quote mark out of the way
+                            uAtClientReadBytes(atHandle, NULL, 1, true);
+                            // Hand the data to the callback straight
+                            // from the AT client's receive buffer
+                            while (indicatedReadSize > 0) {
+                                peekSize = uAtClientReadBytesPeek(atHandle, &pData,
+                                                                  (size_t) (unsigned) indicatedReadSize);
+                                if (peekSize <= 0) {
+                                    break;
+                                }
+                                if (keepGoing) {
+                                    keepGoing = pCallback(cellHandle, pData,
+                                                          (size_t) (unsigned) peekSize,
+                                                          offset, pCallbackParam);
+                                    totalSize += (size_t) (unsigned) peekSize;
+                                }
+                                // If the callback has had enough, pour
+                                // away what is left of the block so that
+                                // the AT client is left tidy
+                                uAtClientReadBytesConsume(atHandle, (size_t) (unsigned) peekSize);
+                                indicatedReadSize -= peekSize;
+                                offset += (size_t) (unsigned) peekSize;
+                            }
+                            // Make sure to wait for the stop tag before
+                            // the next block
+                            uAtClientRestoreStopTag(atHandle);
+                        } else {
+                            // The file has got shorter, or something
+                            // has gone wrong, either way we're done
+                            keepGoing = false;
+                        }
+                        uAtClientResponseStop(atHandle);
+                    }
+                    errorCode = uAtClientUnlock(atHandle);
+                    if (errorCode == 0) {
+                        errorCode = (int32_t) totalSize;
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
 // Read file size.
 int32_t uCellFileSize(uDeviceHandle_t cellHandle,
                       const char *pFileName)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance;
-    uAtClientHandle_t atHandle;
-    int32_t size = 0;
 
     if (gUCellPrivateMutex != NULL) {
 
@@ -358,28 +616,7 @@ int32_t uCellFileSize(uDeviceHandle_t cellHandle,
         // Check parameters
         if ((pInstance != NULL) && (pFileName != NULL) &&
             (strlen(pFileName) <= U_CELL_FILE_NAME_MAX_LENGTH)) {
-            errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
-            atHandle = pInstance->atHandle;
-            // Do the ULSTFILE thang with the AT interface
-            uAtClientLock(atHandle);
-            uAtClientCommandStart(atHandle, "AT+ULSTFILE=");
-            // Write get file size op_code
-            uAtClientWriteInt(atHandle, 2);
-            // Write file name
-            uAtClientWriteString(atHandle, pFileName, true);
-            if (pInstance->pFileSystemTag != NULL) {
-                // Write tag
-                uAtClientWriteString(atHandle, pInstance->pFileSystemTag, true);
-            }
-            uAtClientCommandStop(atHandle);
-            // Grab the response
-            uAtClientResponseStart(atHandle, "+ULSTFILE:");
-            // Read file size
-            size = uAtClientReadInt(atHandle);
-            uAtClientResponseStop(atHandle);
-            if (uAtClientUnlock(atHandle) == 0) {
-                errorCode = size;
-            }
+            errorCode = fileSize(pInstance, pFileName);
         }
 
         U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
@@ -32,6 +32,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
+#include "string.h"    // memset()
 
 #include "u_cfg_sw.h"
 
@@ -87,6 +88,13 @@ typedef struct {
 typedef struct {
     uCellFotaStatusCallback_t *pCallback;
     void *pCallbackParameter;
+    int32_t percentage;
+    bool inProgress;
+    int32_t numStarts;
+    int32_t startTimeMs;
+    int32_t startPercentage;
+    int32_t startPercentageTimeMs;
+    int32_t percentageTimeMs;
 } uCellPrivateFotaContext_t;
 
 /* ----------------------------------------------------------------
@@ -195,6 +203,43 @@ static void queueFotaStatus(uCellPrivateInstance_t *pInstance,
     }
 }
 
+// Keep track of the progress of a download as the status arrives.
+static void updateProgress(uCellPrivateInstance_t *pInstance,
+                           uCellFotaStatus_t *pStatus)
+{
+    uCellPrivateFotaContext_t *pContext = (uCellPrivateFotaContext_t *) pInstance->pFotaContext;
+    int32_t nowMs = uPortGetTickTimeMs();
+
+    if (pStatus->type == U_CELL_FOTA_STATUS_TYPE_DOWNLOAD) {
+        if (pStatus->value.download == U_CELL_FOTA_STATUS_DOWNLOAD_START) {
+            pContext->inProgress = true;
+            pContext->numStarts++;
+            pContext->startTimeMs = nowMs;
+            pContext->startPercentage = -1;
+        } else {
+            pContext->inProgress = false;
+            if (pStatus->value.download == U_CELL_FOTA_STATUS_DOWNLOAD_SUCCESS) {
+                pContext->percentage = 100;
+                pContext->percentageTimeMs = nowMs;
+            }
+        }
+    } else if (pStatus->type == U_CELL_FOTA_STATUS_TYPE_PERCENTAGE_DOWNLOAD) {
+        if (!pContext->inProgress) {
+            // Missed the start, treat this as the start
+            pContext->inProgress = true;
+            pContext->numStarts++;
+            pContext->startTimeMs = nowMs;
+            pContext->startPercentage = -1;
+        }
+        if (pContext->startPercentage < 0) {
+            pContext->startPercentage = (int32_t) pStatus->value.percentage;
+            pContext->startPercentageTimeMs = nowMs;
+        }
+        pContext->percentage = (int32_t) pStatus->value.percentage;
+        pContext->percentageTimeMs = nowMs;
+    }
+}
+
 // The UFOSTAT URC callback.
 static void UFOTASTAT_urc(uAtClientHandle_t atHandle,
                           void *pParameter)
@@ -252,6 +297,7 @@ static void UFOTASTAT_urc(uAtClientHandle_t atHandle,
         }
 
         if (urcIsGood) {
+            updateProgress(pInstance, &status);
             queueFotaStatus(pInstance, &status);
         }
     }
@@ -332,6 +378,11 @@ int32_t uCellFotaSetStatusCallback(uDeviceHandle_t cellHandle,
                     // cellular is closed down in order to
                     // ensure thread-safety of the callback
                     pContext = (uCellPrivateFotaContext_t *) pUPortMalloc(sizeof(uCellPrivateFotaContext_t));
+                    if (pContext != NULL) {
+                        memset(pContext, 0, sizeof(*pContext));
+                        pContext->percentage = -1;
+                        pContext->startPercentage = -1;
+                    }
                 }
                 if (pContext != NULL) {
                     pInstance->pFotaContext = pContext;
@@ -401,4 +452,77 @@ int32_t uCellFotaSetStatusCallback(uDeviceHandle_t cellHandle,
     return errorCode;
 }
 
+// Get the progress of a FOTA download.
+int32_t uCellFotaGetProgress(uDeviceHandle_t cellHandle,
+                             int32_t packageSizeBytes,
+                             uCellFotaProgress_t *pProgress)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellPrivateFotaContext_t context = {0};
+    int32_t durationMs;
+    int32_t percentageDone;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pInstance != NULL) && (pProgress != NULL) && (packageSizeBytes >= 0)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (U_CELL_PRIVATE_HAS(pInstance->pModule,
+                                   U_CELL_PRIVATE_FEATURE_FOTA)) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                context.percentage = -1;
+                context.startPercentage = -1;
+                if (pInstance->pFotaContext != NULL) {
+                    // Take a copy as the URC handler may update it
+                    context = *((uCellPrivateFotaContext_t *) pInstance->pFotaContext);
+                }
+                memset(pProgress, 0, sizeof(*pProgress));
+                pProgress->percentage = context.percentage;
+                pProgress->inProgress = context.inProgress;
+                pProgress->numStarts = context.numStarts;
+                pProgress->startPercentage = context.startPercentage;
+                pProgress->percentPerMinuteX100 = -1;
+                pProgress->bytesPerSecond = -1;
+                pProgress->etaSeconds = -1;
+                if (context.numStarts > 0) {
+                    if (context.inProgress) {
+                        pProgress->elapsedMs = uPortGetTickTimeMs() - context.startTimeMs;
+                    } else {
+                        pProgress->elapsedMs = context.percentageTimeMs - context.startTimeMs;
+                    }
+                }
+                // The rate is measured from the first percentage report
+                // of this attempt, so that a resumed download isn't
+                // credited with what was done before
+                durationMs = context.percentageTimeMs - context.startPercentageTimeMs;
+                percentageDone = context.percentage - context.startPercentage;
+                if ((context.startPercentage >= 0) && (durationMs > 0) &&
+                    (percentageDone > 0)) {
+                    pProgress->percentPerMinuteX100 = (int32_t) (((int64_t) percentageDone) *
+                                                                 100 * 60000 / durationMs);
+                    if (packageSizeBytes > 0) {
+                        pProgress->bytesPerSecond = (int32_t) (((int64_t) packageSizeBytes) *
+                                                               percentageDone * 1000 /
+                                                               (((int64_t) durationMs) * 100));
+                    }
+                    if (context.inProgress) {
+                        pProgress->etaSeconds = (int32_t) (((int64_t) (100 - context.percentage)) *
+                                                           durationMs / (((int64_t) percentageDone) * 1000));
+                    } else if (context.percentage >= 100) {
+                        pProgress->etaSeconds = 0;
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
 // End of file
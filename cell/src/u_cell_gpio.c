@@ -32,6 +32,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
+#include "stdio.h"     // snprintf()
 
 #include "u_cfg_sw.h"
 #include "u_cfg_os_platform_specific.h"  // For #define U_CFG_OS_CLIB_LEAKS
@@ -54,10 +55,31 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+/** The number of bits in the masks of uCellGpioSetMulti() and
+ * uCellGpioGetMulti().
+ */
+#define U_CELL_GPIO_MULTI_MAX_NUM 64
+
+/** Room for the longest of "AT+UGPIOW=<gpioId>,1" and
+ * "AT+UGPIOR=<gpioId>", plus a terminator, with gpioId formatted
+ * as the longest possible int, so that the compiler can see there
+ * is no truncation; in practice gpioId is at most 63.
+ */
+#define U_CELL_GPIO_MULTI_COMMAND_LENGTH_BYTES (10 + 11 + 2 + 1)
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** Storage for one window's worth of pipelined GPIO commands.
+ */
+typedef struct {
+    uAtClientPipelineCommand_t pipeline[U_CELL_GPIO_MULTI_PIPELINE_WINDOW];
+    char command[U_CELL_GPIO_MULTI_PIPELINE_WINDOW][U_CELL_GPIO_MULTI_COMMAND_LENGTH_BYTES];
+    int32_t level[U_CELL_GPIO_MULTI_PIPELINE_WINDOW];
+    int32_t gpioId[U_CELL_GPIO_MULTI_PIPELINE_WINDOW];
+} uCellGpioMulti_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -66,6 +88,92 @@
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Parse the response to AT+UGPIOR, called by uAtClientPipeline().
+static void ugpiorResponseParser(uAtClientHandle_t atHandle,
+                                 void *pParameter)
+{
+    // Skip the first integer parameter, which is
+    // just the GPIO ID again
+    uAtClientSkipParameters(atHandle, 1);
+    // Read the second integer parameter, which is the level
+    *((int32_t *) pParameter) = uAtClientReadInt(atHandle);
+}
+
+// Send AT+UGPIOW (if pLevelMask is NULL) or AT+UGPIOR for each
+// GPIO in gpioMask, pipelined, with the AT interface already locked;
+// returns zero on success else the error code of the first GPIO
+// that failed.  Where pLevelMask is not NULL the bit for each GPIO
+// that is read as high is set in it.
+static int32_t multi(uAtClientHandle_t atHandle, uint64_t gpioMask,
+                     uint64_t levelMask, uint64_t *pLevelMask)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    uCellGpioMulti_t *pMulti;
+    size_t numCommands;
+    int32_t gpioId = 0;
+
+    // Put this on the heap rather than the stack, it is not small
+    pMulti = (uCellGpioMulti_t *) pUPortMalloc(sizeof(*pMulti));
+    if (pMulti != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        while (gpioId < U_CELL_GPIO_MULTI_MAX_NUM) {
+            // Assemble up to a window's worth of commands
+            numCommands = 0;
+            for (; (gpioId < U_CELL_GPIO_MULTI_MAX_NUM) &&
+                 (numCommands < U_CELL_GPIO_MULTI_PIPELINE_WINDOW); gpioId++) {
+                if (gpioMask & U_CELL_GPIO_MASK(gpioId)) {
+                    pMulti->gpioId[numCommands] = gpioId;
+                    pMulti->level[numCommands] = -1;
+                    pMulti->pipeline[numCommands].pCommand = pMulti->command[numCommands];
+                    pMulti->pipeline[numCommands].errorCode = 0;
+                    if (pLevelMask == NULL) {
+                        snprintf(pMulti->command[numCommands],
+                                 sizeof(pMulti->command[numCommands]),
+                                 "AT+UGPIOW=%d,%d", (int) gpioId,
+                                 (levelMask & U_CELL_GPIO_MASK(gpioId)) ? 1 : 0);
+                        pMulti->pipeline[numCommands].pResponsePrefix = NULL;
+                        pMulti->pipeline[numCommands].pResponseParser = NULL;
+                        pMulti->pipeline[numCommands].pResponseParserParameter = NULL;
+                    } else {
+                        snprintf(pMulti->command[numCommands],
+                                 sizeof(pMulti->command[numCommands]),
+                                 "AT+UGPIOR=%d", (int) gpioId);
+                        // Note: need to use just +UGPIO" here since SARA-U201
+                        // returns "+UGPIO:" while all the other modules
+                        // return "+UGPIOR:"
+                        pMulti->pipeline[numCommands].pResponsePrefix = "+UGPIO";
+                        pMulti->pipeline[numCommands].pResponseParser = ugpiorResponseParser;
+                        pMulti->pipeline[numCommands].pResponseParserParameter = &(pMulti->level[numCommands]);
+                    }
+                    numCommands++;
+                }
+            }
+            if (numCommands > 0) {
+                uAtClientPipeline(atHandle, pMulti->pipeline, numCommands,
+                                  U_CELL_GPIO_MULTI_PIPELINE_WINDOW);
+                // Errors are collected per command, below, so that one
+                // bad GPIO doesn't prevent the others being done
+                uAtClientClearError(atHandle);
+                for (size_t x = 0; x < numCommands; x++) {
+                    if ((pMulti->pipeline[x].errorCode == 0) && (pLevelMask != NULL)) {
+                        if (pMulti->level[x] < 0) {
+                            pMulti->pipeline[x].errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+                        } else if (pMulti->level[x] > 0) {
+                            *pLevelMask |= U_CELL_GPIO_MASK(pMulti->gpioId[x]);
+                        }
+                    }
+                    if ((errorCode == 0) && (pMulti->pipeline[x].errorCode != 0)) {
+                        errorCode = pMulti->pipeline[x].errorCode;
+                    }
+                }
+            }
+        }
+        uPortFree(pMulti);
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -181,6 +289,59 @@ int32_t uCellGpioGet(uDeviceHandle_t cellHandle, uCellGpioName_t gpioId)
     return errorCode;
 }
 
+// Set the state of several GPIOs.
+int32_t uCellGpioSetMulti(uDeviceHandle_t cellHandle, uint64_t gpioMask,
+                          uint64_t levelMask)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uCellPrivateInstance_t *pInstance;
+    uAtClientHandle_t atHandle;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        if (pInstance != NULL) {
+            atHandle = pInstance->atHandle;
+            uAtClientLock(atHandle);
+            errorCode = multi(atHandle, gpioMask, levelMask, NULL);
+            uAtClientUnlock(atHandle);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Get the state of several GPIOs.
+int32_t uCellGpioGetMulti(uDeviceHandle_t cellHandle, uint64_t gpioMask,
+                          uint64_t *pLevelMask)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uCellPrivateInstance_t *pInstance;
+    uAtClientHandle_t atHandle;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        if ((pInstance != NULL) && (pLevelMask != NULL)) {
+            *pLevelMask = 0;
+            atHandle = pInstance->atHandle;
+            uAtClientLock(atHandle);
+            errorCode = multi(atHandle, gpioMask, 0, pLevelMask);
+            uAtClientUnlock(atHandle);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
 // Set the state of the CTS line.
 int32_t uCellGpioSetCts(uDeviceHandle_t cellHandle, int32_t level)
 {
@@ -34,7 +34,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // strlen()
+#include "string.h"    // strlen(), memcpy()
 #include "time.h"      // struct tm
 
 #include "u_cfg_sw.h"
@@ -43,10 +43,15 @@
 
 #include "u_port_clib_platform_specific.h" // strtok_r() and, in some cases, isblank()
 #include "u_port_clib_mktime64.h"
+#include "u_port_heap.h"
+#include "u_port.h"
 #include "u_port_debug.h"
 #include "u_port_os.h"
+#include "u_task_registry.h"
 #include "u_port_uart.h"
 
+#include "u_cfg_os_platform_specific.h"
+
 #include "u_at_client.h"
 
 #include "u_cell_module_type.h"
@@ -55,11 +60,48 @@
 #include "u_cell_net.h"     // important here
 #include "u_cell_private.h" // don't change it
 #include "u_cell_info.h"
+#include "u_cell_info_private.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_CELL_INFO_RADIO_SAMPLER_TASK_STACK_SIZE_BYTES
+/** The stack size of the radio parameter sampler task; this
+ * also has to accommodate any callback.
+ */
+# define U_CELL_INFO_RADIO_SAMPLER_TASK_STACK_SIZE_BYTES (1024 * 2)
+#endif
+
+#ifndef U_CELL_INFO_RADIO_SAMPLER_TASK_PRIORITY
+/** The priority of the radio parameter sampler task: low, it
+ * has nothing urgent to do.
+ */
+# define U_CELL_INFO_RADIO_SAMPLER_TASK_PRIORITY (U_CFG_OS_PRIORITY_MIN + 1)
+#endif
+
+#ifndef U_CELL_INFO_RADIO_SAMPLER_GAP_MS
+/** The gap the radio parameter sampler leaves between the AT
+ * commands of a sample, matching the gap used by
+ * uCellInfoRefreshRadioParameters().
+ */
+# define U_CELL_INFO_RADIO_SAMPLER_GAP_MS 500
+#endif
+
+#ifndef U_CELL_INFO_RADIO_SAMPLER_POLL_MS
+/** How often the radio parameter sampler task checks whether it
+ * has been asked to stop while it is waiting.
+ */
+# define U_CELL_INFO_RADIO_SAMPLER_POLL_MS 100
+#endif
+
+#ifndef U_CELL_INFO_RADIO_SAMPLER_GET_TRIES
+/** The number of times uCellInfoRadioSamplerGet() will try to
+ * read a consistent snapshot before giving up.
+ */
+# define U_CELL_INFO_RADIO_SAMPLER_GET_TRIES 10
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -170,6 +212,45 @@ static int32_t getString(uAtClientHandle_t atHandle,
     return errorCodeOrSize;
 }
 
+// Copy an identity string from the cache into the caller's buffer,
+// truncating it as uAtClientReadString() would, returning its
+// length or negative error code if it is not in the cache.
+static int32_t idCacheGet(const uCellPrivateIdCacheString_t *pCached,
+                          char *pStr, size_t size)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+    size_t length;
+
+    if (pCached->valid) {
+        length = pCached->length;
+        if (length > size - 1) {
+            length = size - 1;
+        }
+        memcpy(pStr, pCached->str, length);
+        *(pStr + length) = 0;
+        errorCodeOrSize = (int32_t) length;
+    }
+
+    return errorCodeOrSize;
+}
+
+// Put an identity string that has just been read into a caller's
+// buffer of the given size into the cache; nothing is cached if
+// the read failed or if the string might have been truncated.
+static void idCachePut(uCellPrivateIdCacheString_t *pCached,
+                       const char *pStr, size_t size,
+                       int32_t errorCodeOrSize)
+{
+    if ((errorCodeOrSize >= 0) &&
+        ((size_t) errorCodeOrSize + 1 < size) &&
+        ((size_t) errorCodeOrSize < sizeof(pCached->str))) {
+        memcpy(pCached->str, pStr, errorCodeOrSize);
+        pCached->str[errorCodeOrSize] = 0;
+        pCached->length = (size_t) errorCodeOrSize;
+        pCached->valid = true;
+    }
+}
+
 // Fill in the radio parameters the AT+CSQ way
 static int32_t getRadioParamsCsq(uAtClientHandle_t atHandle,
                                  uCellPrivateRadioParameters_t *pRadioParameters)
@@ -447,6 +528,221 @@ static int32_t getRadioParamsUcged5(uAtClientHandle_t atHandle,
     return uAtClientUnlock(atHandle);
 }
 
+// Fill in the radio parameters using whichever flavour of AT+UCGED
+// this module supports.
+static int32_t getRadioParamsUcged(const uCellPrivateInstance_t *pInstance,
+                                   uCellPrivateRadioParameters_t *pRadioParameters)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    uCellNetRat_t rat;
+
+    if (U_CELL_PRIVATE_HAS(pInstance->pModule, U_CELL_PRIVATE_FEATURE_UCGED5)) {
+        // SARA-R4 (except 422) only supports UCGED=5, and it only
+        // supports it in EUTRAN mode
+        rat = uCellPrivateGetActiveRat(pInstance);
+        if (U_CELL_PRIVATE_RAT_IS_EUTRAN(rat)) {
+            errorCode = getRadioParamsUcged5(atHandle, pRadioParameters);
+        }
+        // Otherwise can't use AT+UCGED, that's all we can get
+    } else {
+        // The AT+UCGED=2 formats are module-specific
+        switch (pInstance->pModule->moduleType) {
+            case U_CELL_MODULE_TYPE_SARA_R5:
+                errorCode = getRadioParamsUcged2SaraR5(atHandle, pRadioParameters);
+                break;
+            case U_CELL_MODULE_TYPE_SARA_R422:
+                errorCode = getRadioParamsUcged2SaraR422(atHandle, pRadioParameters);
+                break;
+            case U_CELL_MODULE_TYPE_LARA_R6:
+                errorCode = getRadioParamsUcged2LaraR6(atHandle, pRadioParameters);
+                break;
+            default:
+                break;
+        }
+    }
+
+    return errorCode;
+}
+
+// Work out the SNR from a set of radio parameters, see the comment
+// above uCellInfoGetSnrDb() for how the calculation was verified.
+static int32_t calculateSnrDb(const uCellPrivateRadioParameters_t *pRadioParameters,
+                              int32_t *pSnrDb)
+{
+    int32_t errorCode = (int32_t) U_CELL_ERROR_VALUE_OUT_OF_RANGE;
+
+    // SNR = RSRP / (RSSI - RSRP).
+    if ((pRadioParameters->rssiDbm != 0) &&
+        (pRadioParameters->rssiDbm <= pRadioParameters->rsrpDbm)) {
+        *pSnrDb = INT_MAX;
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    } else if ((pRadioParameters->rssiDbm != 0) && (pRadioParameters->rsrpDbm != 0)) {
+        int32_t ix = pRadioParameters->rssiDbm - (pRadioParameters->rsrpDbm + 1);
+        if (ix >= 0) {
+            const signed char snrLut[] = {6, 2, 0, -2, -3, -5, -6, -7, -8, -10};
+            *pSnrDb = (ix < (int32_t) sizeof(snrLut)) ? snrLut[ix] : (- ix - 1);
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Wait for up to waitMs, returning early, with false, if the radio
+// parameter sampler has been asked to stop.
+static bool radioSamplerWait(const uCellPrivateRadioSamplerContext_t *pContext,
+                             int32_t waitMs)
+{
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    while (pContext->keepGoing &&
+           (uPortGetTickTimeMs() - startTimeMs < waitMs)) {
+        uPortTaskBlock(U_CELL_INFO_RADIO_SAMPLER_POLL_MS);
+    }
+
+    return pContext->keepGoing;
+}
+
+// Lock gUCellPrivateMutex on behalf of the radio parameter sampler
+// and return the instance, giving up if the sampler is asked to stop.
+// TryLock is used since uCellPrivateRadioSamplerRemoveContext() is
+// called with gUCellPrivateMutex already locked and then waits
+// for this task to exit.  If the return value is non-NULL
+// gUCellPrivateMutex must be unlocked afterwards; if it is NULL
+// either the sampler is stopping or the instance has gone, in
+// which case gUCellPrivateMutex is unlocked already.
+static uCellPrivateInstance_t *pRadioSamplerLock(const uCellPrivateRadioSamplerContext_t *pContext)
+{
+    uCellPrivateInstance_t *pInstance = NULL;
+    bool locked = false;
+
+    while (pContext->keepGoing && !locked) {
+        locked = (uPortMutexTryLock(gUCellPrivateMutex,
+                                    U_CELL_INFO_RADIO_SAMPLER_POLL_MS) == 0);
+    }
+    if (locked) {
+        if (pContext->keepGoing) {
+            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+        }
+        if (pInstance == NULL) {
+            uPortMutexUnlock(gUCellPrivateMutex);
+        }
+    }
+
+    return pInstance;
+}
+
+// Publish a sample from the radio parameter sampler: there is only
+// one writer, this task, so it is sufficient to bump the sequence
+// number before and after the write.
+static void radioSamplerPublish(uCellInfoRadioSampler_t *pSampler,
+                                const uCellPrivateRadioParameters_t *pRadioParameters,
+                                int32_t errorCode)
+{
+    int32_t snrDb = INT_MIN;
+
+    if (errorCode == 0) {
+        calculateSnrDb(pRadioParameters, &snrDb);
+    }
+    pSampler->sequence++;
+    pSampler->rssiDbm = pRadioParameters->rssiDbm;
+    pSampler->rsrpDbm = pRadioParameters->rsrpDbm;
+    pSampler->rsrqDb = pRadioParameters->rsrqDb;
+    pSampler->rxQual = pRadioParameters->rxQual;
+    pSampler->snrDb = snrDb;
+    pSampler->cellId = pRadioParameters->cellId;
+    pSampler->earfcn = pRadioParameters->earfcn;
+    pSampler->errorCode = errorCode;
+    pSampler->timeMs = uPortGetTickTimeMs();
+    pSampler->count++;
+    pSampler->sequence++;
+}
+
+// The radio parameter sampler task: gUCellPrivateMutex is only
+// held for one AT command at a time so that the application
+// is never held up for long.
+static void radioSamplerTask(void *pParam)
+{
+    uCellPrivateRadioSamplerContext_t *pContext = (uCellPrivateRadioSamplerContext_t *) pParam;
+    uCellPrivateInstance_t *pInstance;
+    uCellPrivateRadioParameters_t radioParameters;
+    int32_t errorCode;
+
+    U_PORT_MUTEX_LOCK(pContext->taskRunningMutex);
+
+    while (pContext->keepGoing) {
+        uCellPrivateClearRadioParameters(&radioParameters);
+        radioParameters.rxQual = -1;
+        errorCode = (int32_t) U_CELL_ERROR_NOT_REGISTERED;
+        pInstance = pRadioSamplerLock(pContext);
+        if (pInstance != NULL) {
+            if (uCellPrivateIsRegistered(pInstance)) {
+                errorCode = getRadioParamsCsq(pInstance->atHandle, &radioParameters);
+            }
+            uPortMutexUnlock(gUCellPrivateMutex);
+            if ((errorCode == 0) &&
+                radioSamplerWait(pContext, U_CELL_INFO_RADIO_SAMPLER_GAP_MS)) {
+                pInstance = pRadioSamplerLock(pContext);
+                if (pInstance != NULL) {
+                    errorCode = (int32_t) U_CELL_ERROR_NOT_REGISTERED;
+                    if (uCellPrivateIsRegistered(pInstance)) {
+                        errorCode = getRadioParamsUcged(pInstance, &radioParameters);
+                    }
+                    if (errorCode == 0) {
+                        // Keep the uCellInfoGetXxx() functions in step
+                        pInstance->radioParameters = radioParameters;
+                    }
+                    uPortMutexUnlock(gUCellPrivateMutex);
+                }
+            }
+            if (pContext->keepGoing) {
+                radioSamplerPublish((uCellInfoRadioSampler_t *) pContext->pSampler,
+                                    &radioParameters, errorCode);
+                if (pContext->pCallback != NULL) {
+                    pContext->pCallback(pContext->cellHandle, pContext->pCallbackParam);
+                }
+            }
+        }
+        radioSamplerWait(pContext, pContext->periodMs);
+    }
+
+    U_PORT_MUTEX_UNLOCK(pContext->taskRunningMutex);
+
+    // Delete ourself
+    uTaskRegistryTaskDelete(NULL);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS THAT ARE PRIVATE TO CELLULAR
+ * -------------------------------------------------------------- */
+
+// Read the identity of the serving cell.
+int32_t uCellInfoPrivateGetServingCell(uCellPrivateInstance_t *pInstance,
+                                       int32_t *pCellId, int32_t *pEarfcn)
+{
+    int32_t errorCode = (int32_t) U_CELL_ERROR_NOT_REGISTERED;
+    uCellPrivateRadioParameters_t radioParameters;
+
+    if (uCellPrivateIsRegistered(pInstance)) {
+        uCellPrivateClearRadioParameters(&radioParameters);
+        errorCode = getRadioParamsUcged(pInstance, &radioParameters);
+        if (errorCode == 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+            if (radioParameters.cellId >= 0) {
+                // Keep uCellInfoGetCellId() etc. in step
+                pInstance->radioParameters.cellId = radioParameters.cellId;
+                pInstance->radioParameters.earfcn = radioParameters.earfcn;
+                *pCellId = radioParameters.cellId;
+                *pEarfcn = radioParameters.earfcn;
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -458,7 +754,6 @@ int32_t uCellInfoRefreshRadioParameters(uDeviceHandle_t cellHandle)
     uCellPrivateInstance_t *pInstance;
     uCellPrivateRadioParameters_t *pRadioParameters;
     uAtClientHandle_t atHandle;
-    uCellNetRat_t rat;
 
     if (gUCellPrivateMutex != NULL) {
 
@@ -483,33 +778,8 @@ int32_t uCellInfoRefreshRadioParameters(uDeviceHandle_t cellHandle)
                 // reporting answers.
                 // Allow a little sleepy-byes here, don't want to overtask
                 // the module if this is being called repeatedly
-                uPortTaskBlock(500);
-                if (U_CELL_PRIVATE_HAS(pInstance->pModule, U_CELL_PRIVATE_FEATURE_UCGED5)) {
-                    // SARA-R4 (except 422) only supports UCGED=5, and it only
-                    // supports it in EUTRAN mode
-                    rat = uCellPrivateGetActiveRat(pInstance);
-                    if (U_CELL_PRIVATE_RAT_IS_EUTRAN(rat)) {
-                        errorCode = getRadioParamsUcged5(atHandle, pRadioParameters);
-                    } else {
-                        // Can't use AT+UCGED, that's all we can get
-                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-                    }
-                } else {
-                    // The AT+UCGED=2 formats are module-specific
-                    switch (pInstance->pModule->moduleType) {
-                        case U_CELL_MODULE_TYPE_SARA_R5:
-                            errorCode = getRadioParamsUcged2SaraR5(atHandle, pRadioParameters);
-                            break;
-                        case U_CELL_MODULE_TYPE_SARA_R422:
-                            errorCode = getRadioParamsUcged2SaraR422(atHandle, pRadioParameters);
-                            break;
-                        case U_CELL_MODULE_TYPE_LARA_R6:
-                            errorCode = getRadioParamsUcged2LaraR6(atHandle, pRadioParameters);
-                            break;
-                        default:
-                            break;
-                    }
-                }
+                uPortTaskBlock(U_CELL_INFO_RADIO_SAMPLER_GAP_MS);
+                errorCode = getRadioParamsUcged(pInstance, pRadioParameters);
             }
 
             if (errorCode == 0) {
@@ -677,7 +947,6 @@ int32_t uCellInfoGetSnrDb(uDeviceHandle_t cellHandle, int32_t *pSnrDb)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance;
-    uCellPrivateRadioParameters_t *pRadioParameters;
 
     if (gUCellPrivateMutex != NULL) {
 
@@ -686,21 +955,7 @@ int32_t uCellInfoGetSnrDb(uDeviceHandle_t cellHandle, int32_t *pSnrDb)
         pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pSnrDb != NULL)) {
-            pRadioParameters = &(pInstance->radioParameters);
-            errorCode = (int32_t) U_CELL_ERROR_VALUE_OUT_OF_RANGE;
-            // SNR = RSRP / (RSSI - RSRP).
-            if ((pRadioParameters->rssiDbm != 0) &&
-                (pRadioParameters->rssiDbm <= pRadioParameters->rsrpDbm)) {
-                *pSnrDb = INT_MAX;
-                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-            } else if ((pRadioParameters->rssiDbm != 0) && (pRadioParameters->rsrpDbm != 0)) {
-                int32_t ix = pRadioParameters->rssiDbm - (pRadioParameters->rsrpDbm + 1);
-                if (ix >= 0) {
-                    const signed char snrLut[] = {6, 2, 0, -2, -3, -5, -6, -7, -8, -10};
-                    *pSnrDb = (ix < (int32_t) sizeof(snrLut)) ? snrLut[ix] : (- ix - 1);
-                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-                }
-            }
+            errorCode = calculateSnrDb(&(pInstance->radioParameters), pSnrDb);
         }
 
         U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
@@ -753,6 +1008,119 @@ int32_t uCellInfoGetEarfcn(uDeviceHandle_t cellHandle)
     return errorCodeOrValue;
 }
 
+// Start the background radio parameter sampler.
+int32_t uCellInfoRadioSamplerStart(uDeviceHandle_t cellHandle,
+                                   uCellInfoRadioSampler_t *pSampler,
+                                   int32_t periodMs,
+                                   void (*pCallback) (uDeviceHandle_t cellHandle,
+                                                      void *pCallbackParam),
+                                   void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellPrivateRadioSamplerContext_t *pContext;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pInstance != NULL) && (pSampler != NULL) &&
+            (periodMs >= U_CELL_INFO_RADIO_SAMPLER_PERIOD_MIN_MS) &&
+            (pInstance->pRadioSamplerContext == NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pContext = (uCellPrivateRadioSamplerContext_t *) pUPortMalloc(sizeof(*pContext));
+            if (pContext != NULL) {
+                memset(pContext, 0, sizeof(*pContext));
+                memset(pSampler, 0, sizeof(*pSampler));
+                pContext->cellHandle = cellHandle;
+                pContext->pSampler = pSampler;
+                pContext->periodMs = periodMs;
+                pContext->pCallback = pCallback;
+                pContext->pCallbackParam = pCallbackParam;
+                pContext->keepGoing = true;
+                errorCode = uPortMutexCreate(&(pContext->taskRunningMutex));
+                if (errorCode == 0) {
+                    errorCode = uTaskRegistryTaskCreate(radioSamplerTask, "cellRadioSampler",
+                                                        U_CELL_INFO_RADIO_SAMPLER_TASK_STACK_SIZE_BYTES,
+                                                        pContext,
+                                                        U_CELL_INFO_RADIO_SAMPLER_TASK_PRIORITY,
+                                                        &(pContext->taskHandle));
+                    if (errorCode == 0) {
+                        pInstance->pRadioSamplerContext = pContext;
+                    } else {
+                        uPortMutexDelete(pContext->taskRunningMutex);
+                    }
+                }
+                if (errorCode != 0) {
+                    uPortFree(pContext);
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Get the latest sample from the background radio parameter sampler.
+int32_t uCellInfoRadioSamplerGet(const uCellInfoRadioSampler_t *pSampler,
+                                 uCellInfoRadioSample_t *pSample)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uint32_t sequence;
+
+    if ((pSampler != NULL) && (pSample != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_TEMPORARY_FAILURE;
+        // Don't spin for ever: the sampler task may be of lower
+        // priority than the caller
+        for (size_t x = 0; (x < U_CELL_INFO_RADIO_SAMPLER_GET_TRIES) &&
+             (errorCode == (int32_t) U_ERROR_COMMON_TEMPORARY_FAILURE); x++) {
+            sequence = pSampler->sequence;
+            pSample->rssiDbm = pSampler->rssiDbm;
+            pSample->rsrpDbm = pSampler->rsrpDbm;
+            pSample->rsrqDb = pSampler->rsrqDb;
+            pSample->rxQual = pSampler->rxQual;
+            pSample->snrDb = pSampler->snrDb;
+            pSample->cellId = pSampler->cellId;
+            pSample->earfcn = pSampler->earfcn;
+            pSample->errorCode = pSampler->errorCode;
+            pSample->timeMs = pSampler->timeMs;
+            pSample->count = pSampler->count;
+            if (((sequence & 1) == 0) && (sequence == pSampler->sequence)) {
+                errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+                if (pSample->count > 0) {
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                }
+            } else {
+                uPortTaskBlock(1);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Stop the background radio parameter sampler.
+void uCellInfoRadioSamplerStop(uDeviceHandle_t cellHandle)
+{
+    uCellPrivateInstance_t *pInstance;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        if (pInstance != NULL) {
+            uCellPrivateRadioSamplerRemoveContext(pInstance);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+}
+
 // Get the IMEI of the cellular module.
 int32_t uCellInfoGetImei(uDeviceHandle_t cellHandle,
                          char *pImei)
@@ -767,7 +1135,16 @@ int32_t uCellInfoGetImei(uDeviceHandle_t cellHandle,
         pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pImei != NULL)) {
-            errorCode = uCellPrivateGetImei(pInstance, pImei);
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            if (pInstance->idCache.imeiValid) {
+                memcpy(pImei, pInstance->idCache.imei, sizeof(pInstance->idCache.imei));
+            } else {
+                errorCode = uCellPrivateGetImei(pInstance, pImei);
+                if (errorCode == 0) {
+                    memcpy(pInstance->idCache.imei, pImei, sizeof(pInstance->idCache.imei));
+                    pInstance->idCache.imeiValid = true;
+                }
+            }
             if (errorCode == 0) {
                 uPortLog("U_CELL_INFO: IMEI is %.*s.\n",
                          U_CELL_INFO_IMEI_SIZE, pImei);
@@ -796,7 +1173,16 @@ int32_t uCellInfoGetImsi(uDeviceHandle_t cellHandle,
         pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pImsi != NULL)) {
-            errorCode = uCellPrivateGetImsi(pInstance, pImsi);
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            if (pInstance->idCache.imsiValid) {
+                memcpy(pImsi, pInstance->idCache.imsi, sizeof(pInstance->idCache.imsi));
+            } else {
+                errorCode = uCellPrivateGetImsi(pInstance, pImsi);
+                if (errorCode == 0) {
+                    memcpy(pInstance->idCache.imsi, pImsi, sizeof(pInstance->idCache.imsi));
+                    pInstance->idCache.imsiValid = true;
+                }
+            }
             if (errorCode == 0) {
                 uPortLog("U_CELL_INFO: IMSI is %.*s.\n",
                          U_CELL_INFO_IMSI_SIZE, pImsi);
@@ -827,20 +1213,25 @@ int32_t uCellInfoGetIccidStr(uDeviceHandle_t cellHandle,
         pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pStr != NULL) && (size > 0)) {
-            atHandle = pInstance->atHandle;
-            uAtClientLock(atHandle);
-            uAtClientCommandStart(atHandle, "AT+CCID");
-            uAtClientCommandStop(atHandle);
-            uAtClientResponseStart(atHandle, "+CCID:");
-            bytesRead = uAtClientReadString(atHandle, pStr, size, false);
-            uAtClientResponseStop(atHandle);
-            errorCodeOrSize = uAtClientUnlock(atHandle);
-            if ((bytesRead >= 0) && (errorCodeOrSize == 0)) {
-                errorCodeOrSize = bytesRead;
-                uPortLog("U_CELL_INFO: ICCID is %s.\n", pStr);
-            } else {
-                errorCodeOrSize = (int32_t) U_CELL_ERROR_AT;
-                uPortLog("U_CELL_INFO: unable to read ICCID.\n");
+            errorCodeOrSize = idCacheGet(&(pInstance->idCache.iccid), pStr, size);
+            if (errorCodeOrSize < 0) {
+                atHandle = pInstance->atHandle;
+                uAtClientLock(atHandle);
+                uAtClientCommandStart(atHandle, "AT+CCID");
+                uAtClientCommandStop(atHandle);
+                uAtClientResponseStart(atHandle, "+CCID:");
+                bytesRead = uAtClientReadString(atHandle, pStr, size, false);
+                uAtClientResponseStop(atHandle);
+                errorCodeOrSize = uAtClientUnlock(atHandle);
+                if ((bytesRead >= 0) && (errorCodeOrSize == 0)) {
+                    errorCodeOrSize = bytesRead;
+                    uPortLog("U_CELL_INFO: ICCID is %s.\n", pStr);
+                    idCachePut(&(pInstance->idCache.iccid), pStr, size,
+                               errorCodeOrSize);
+                } else {
+                    errorCodeOrSize = (int32_t) U_CELL_ERROR_AT;
+                    uPortLog("U_CELL_INFO: unable to read ICCID.\n");
+                }
             }
         }
 
@@ -864,8 +1255,13 @@ int32_t uCellInfoGetManufacturerStr(uDeviceHandle_t cellHandle,
         pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pStr != NULL) && (size > 0)) {
-            errorCodeOrSize = getString(pInstance->atHandle, "AT+CGMI",
-                                        pStr, size);
+            errorCodeOrSize = idCacheGet(&(pInstance->idCache.manufacturer), pStr, size);
+            if (errorCodeOrSize < 0) {
+                errorCodeOrSize = getString(pInstance->atHandle, "AT+CGMI",
+                                            pStr, size);
+                idCachePut(&(pInstance->idCache.manufacturer), pStr, size,
+                           errorCodeOrSize);
+            }
         }
 
         U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
@@ -888,8 +1284,13 @@ int32_t uCellInfoGetModelStr(uDeviceHandle_t cellHandle,
         pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pStr != NULL) && (size > 0)) {
-            errorCodeOrSize = getString(pInstance->atHandle, "AT+CGMM",
-                                        pStr, size);
+            errorCodeOrSize = idCacheGet(&(pInstance->idCache.model), pStr, size);
+            if (errorCodeOrSize < 0) {
+                errorCodeOrSize = getString(pInstance->atHandle, "AT+CGMM",
+                                            pStr, size);
+                idCachePut(&(pInstance->idCache.model), pStr, size,
+                           errorCodeOrSize);
+            }
         }
 
         U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
@@ -913,8 +1314,13 @@ int32_t uCellInfoGetFirmwareVersionStr(uDeviceHandle_t cellHandle,
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pStr != NULL) && (size > 0)) {
             // Use ATI9 instead of AT+CGMR as it contains more information
-            errorCodeOrSize = getString(pInstance->atHandle, "ATI9",
-                                        pStr, size);
+            errorCodeOrSize = idCacheGet(&(pInstance->idCache.firmwareVersion), pStr, size);
+            if (errorCodeOrSize < 0) {
+                errorCodeOrSize = getString(pInstance->atHandle, "ATI9",
+                                            pStr, size);
+                idCachePut(&(pInstance->idCache.firmwareVersion), pStr, size,
+                           errorCodeOrSize);
+            }
         }
 
         U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_CELL_INFO_PRIVATE_H_
+#define _U_CELL_INFO_PRIVATE_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** @file
+ * @brief This header file defines the information function that is
+ * needed in an internal form inside the cellular API, so that the
+ * location API can tell whether the serving cell has changed while
+ * it already has gUCellPrivateMutex locked.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Read the identity of the serving cell from the module with a
+ * single AT+UCGED, updating the cell ID and EARFCN returned by
+ * uCellInfoGetCellId() and uCellInfoGetEarfcn() to match.
+ * Note: gUCellPrivateMutex should be locked before this is called.
+ *
+ * @param pInstance     a pointer to the instance.
+ * @param[out] pCellId  a place to put the cell ID; cannot be NULL.
+ * @param[out] pEarfcn  a place to put the EARFCN (or ARFCN/UARFCN
+ *                      outside LTE); cannot be NULL.
+ * @return              zero on success, #U_ERROR_COMMON_NOT_FOUND if
+ *                      the module does not report a cell ID, else
+ *                      negative error code.
+ */
+int32_t uCellInfoPrivateGetServingCell(uCellPrivateInstance_t *pInstance,
+                                       int32_t *pCellId, int32_t *pEarfcn);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_CELL_INFO_PRIVATE_H_
+
+// End of file
@@ -61,6 +61,7 @@
 #include "u_cell.h"
 #include "u_cell_net.h"     // Order is important
 #include "u_cell_private.h" // here don't change it
+#include "u_cell_info_private.h"
 
 #include "u_cell_loc.h"
 
@@ -74,7 +75,8 @@
 #define U_CELL_LOC_ENTRY_FUNCTION(cellHandle, ppInstance, pErrorCode) \
                                   { entryFunction(cellHandle, \
                                                   ppInstance, \
-                                                  pErrorCode)
+                                                  pErrorCode); \
+                                    U_CELL_PRIVATE_AT_STATS_TAG(*(ppInstance))
 
 /** Helper macro to make sure that the entry and exit functions
  * are always called.
@@ -162,6 +164,8 @@ typedef struct {
  */
 typedef struct {
     uCellPrivateLocContext_t *pContext;
+    bool fromCache; /**< true if fixDataStorageBlock came from
+                         the cache rather than from the module. */
     uCellLocFixDataStorageBlock_t fixDataStorageBlock;
 } uCellLocUrc_t;
 
@@ -169,6 +173,75 @@ typedef struct {
  * VARIABLES
  * -------------------------------------------------------------- */
 
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: CACHE
+ * -------------------------------------------------------------- */
+
+// Store a successful fix in the cache against the serving cell
+// it was requested in; fixDataStorageMutex should be locked.
+static void cacheStore(uCellPrivateLocContext_t *pContext,
+                       const uCellLocFixDataStorageBlock_t *pFixDataStorageBlock)
+{
+    uCellPrivateLocCache_t *pCache = &(pContext->cache);
+
+    pCache->cellId = pContext->fixCellId;
+    pCache->earfcn = pContext->fixEarfcn;
+    pCache->timeMs = uPortGetTickTimeMs();
+    pCache->latitudeX1e7 = pFixDataStorageBlock->latitudeX1e7;
+    pCache->longitudeX1e7 = pFixDataStorageBlock->longitudeX1e7;
+    pCache->altitudeMillimetres = pFixDataStorageBlock->altitudeMillimetres;
+    pCache->radiusMillimetres = pFixDataStorageBlock->radiusMillimetres;
+    pCache->speedMillimetresPerSecond = pFixDataStorageBlock->speedMillimetresPerSecond;
+    pCache->svs = pFixDataStorageBlock->svs;
+    pCache->timeUtc = pFixDataStorageBlock->timeUtc;
+    pCache->valid = true;
+}
+
+// Copy the cached fix into a fix data storage block.
+static void cacheCopy(const uCellPrivateLocCache_t *pCache,
+                      uDeviceHandle_t cellHandle,
+                      uCellLocFixDataStorageBlock_t *pFixDataStorageBlock)
+{
+    pFixDataStorageBlock->cellHandle = cellHandle;
+    pFixDataStorageBlock->errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    pFixDataStorageBlock->latitudeX1e7 = pCache->latitudeX1e7;
+    pFixDataStorageBlock->longitudeX1e7 = pCache->longitudeX1e7;
+    pFixDataStorageBlock->altitudeMillimetres = pCache->altitudeMillimetres;
+    pFixDataStorageBlock->radiusMillimetres = pCache->radiusMillimetres;
+    pFixDataStorageBlock->speedMillimetresPerSecond = pCache->speedMillimetresPerSecond;
+    pFixDataStorageBlock->svs = pCache->svs;
+    pFixDataStorageBlock->timeUtc = pCache->timeUtc;
+}
+
+// Find out the serving cell and, if the cache holds a fix obtained
+// in that same cell that is recent enough and accurate enough,
+// return true.  fixDataStorageMutex should be locked.
+static bool cacheCheck(uCellPrivateInstance_t *pInstance)
+{
+    uCellPrivateLocContext_t *pContext = pInstance->pLocContext;
+    const uCellPrivateLocCache_t *pCache = &(pContext->cache);
+    int32_t cellId = -1;
+    int32_t earfcn = -1;
+    bool usable = false;
+
+    pContext->fixCellId = -1;
+    pContext->fixEarfcn = -1;
+    // Only spend the AT+UCGED if the cache is in use
+    if ((pContext->cacheMaxAgeSeconds > 0) &&
+        (uCellInfoPrivateGetServingCell(pInstance, &cellId, &earfcn) == 0)) {
+        // Remember the cell so that the fix can be cached against it
+        pContext->fixCellId = cellId;
+        pContext->fixEarfcn = earfcn;
+        usable = pCache->valid && (pCache->cellId == cellId) &&
+                 (pCache->earfcn == earfcn) &&
+                 ((uPortGetTickTimeMs() - pCache->timeMs) / 1000 < pContext->cacheMaxAgeSeconds) &&
+                 (pCache->radiusMillimetres >= 0) &&
+                 (pCache->radiusMillimetres <= pContext->desiredAccuracyMillimetres);
+    }
+
+    return usable;
+}
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS: URC RELATED
  * -------------------------------------------------------------- */
@@ -236,6 +309,7 @@ static int32_t numberToX1e7(const char *pNumber)
 // the user callback or dumps the data into a data block it
 // was given for processing within this API. In
 // BOTH cases it free's pContext->pFixDataStorage.
+// A successful fix from the module is also kept in the cache.
 static void UULOC_urc_callback(uAtClientHandle_t atHandle, void *pParam)
 {
     uCellLocUrc_t *pUrcStorage = (uCellLocUrc_t *) pParam;
@@ -252,9 +326,13 @@ static void UULOC_urc_callback(uAtClientHandle_t atHandle, void *pParam)
             // Lock the data storage mutex while we use it
             U_PORT_MUTEX_LOCK(pContext->fixDataStorageMutex);
 
+            pFixDataStorageBlock = &(pUrcStorage->fixDataStorageBlock);
+            if (!pUrcStorage->fromCache && (pFixDataStorageBlock->errorCode == 0)) {
+                cacheStore(pContext, pFixDataStorageBlock);
+            }
+
             pFixDataStorage = (uCellLocFixDataStorage_t *) pContext->pFixDataStorage;
             if (pFixDataStorage != NULL) {
-                pFixDataStorageBlock = &(pUrcStorage->fixDataStorageBlock);
                 switch (pFixDataStorage->type) {
                     case U_CELL_LOC_FIX_DATA_STORAGE_TYPE_BLOCK:
                         if (pFixDataStorage->store.pBlock != NULL) {
@@ -406,6 +484,7 @@ static void UULOC_urc(uAtClientHandle_t atHandle, void *pParam)
             pUrcStorage = (uCellLocUrc_t *) pUPortMalloc(sizeof(*pUrcStorage));
             if (pUrcStorage != NULL) {
                 pUrcStorage->pContext = pContext;
+                pUrcStorage->fromCache = false;
                 pFixDataStorageBlock = &(pUrcStorage->fixDataStorageBlock);
                 pFixDataStorageBlock->latitudeX1e7 = latitudeX1e7;
                 pFixDataStorageBlock->longitudeX1e7 = longitudeX1e7;
@@ -502,6 +581,10 @@ static int32_t ensureContext(uCellPrivateInstance_t *pInstance)
                 pContext->desiredAccuracyMillimetres = U_CELL_LOC_DESIRED_ACCURACY_DEFAULT_MILLIMETRES;
                 pContext->desiredFixTimeoutSeconds = U_CELL_LOC_DESIRED_FIX_TIMEOUT_DEFAULT_SECONDS;
                 pContext->gnssEnable = U_CELL_LOC_GNSS_ENABLE_DEFAULT;
+                pContext->cacheMaxAgeSeconds = U_CELL_LOC_CACHE_MAX_AGE_DEFAULT_SECONDS;
+                pContext->fixCellId = -1;
+                pContext->fixEarfcn = -1;
+                pContext->cache.valid = false;
                 pContext->fixStatus = (int32_t) U_LOCATION_STATUS_UNKNOWN;
                 uAtClientSetUrcHandler(pInstance->atHandle,
                                        "+UULOCIND:", UULOCIND_urc,
@@ -627,6 +710,53 @@ static int32_t beginLocationFix(const uCellPrivateInstance_t *pInstance)
     return errorCode;
 }
 
+// Begin the process of getting a location fix or, if there is
+// a usable fix in the cache, deliver that instead: directly into
+// the block for the blocking case, via UULOC_urc_callback() (so
+// that the user callback is called in the same context as usual)
+// for the non-blocking case.  fixDataStorageMutex should be locked
+// and pContext->pFixDataStorage populated.
+static int32_t beginLocationFixOrUseCache(uCellPrivateInstance_t *pInstance)
+{
+    int32_t errorCode;
+    uCellPrivateLocContext_t *pContext = pInstance->pLocContext;
+    uCellLocFixDataStorage_t *pFixDataStorage = (uCellLocFixDataStorage_t *) pContext->pFixDataStorage;
+    uCellLocFixDataStorageBlock_t fixDataStorageBlock;
+    uCellLocUrc_t *pUrcStorage;
+
+    if (cacheCheck(pInstance)) {
+        uPortLog("U_CELL_LOC: using cached location.\n");
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (pFixDataStorage->type == U_CELL_LOC_FIX_DATA_STORAGE_TYPE_BLOCK) {
+            cacheCopy(&(pContext->cache), pInstance->cellHandle, &fixDataStorageBlock);
+            *pFixDataStorage->store.pBlock = fixDataStorageBlock;
+            uPortFree(pContext->pFixDataStorage);
+            pContext->pFixDataStorage = NULL;
+        } else {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            // Note: the callback will free the memory allocated here
+            //lint -esym(593, pUrcStorage) Suppress pUrcStorage not freed,
+            // the callback does that
+            pUrcStorage = (uCellLocUrc_t *) pUPortMalloc(sizeof(*pUrcStorage));
+            if (pUrcStorage != NULL) {
+                pUrcStorage->pContext = pContext;
+                pUrcStorage->fromCache = true;
+                cacheCopy(&(pContext->cache), pInstance->cellHandle,
+                          &(pUrcStorage->fixDataStorageBlock));
+                errorCode = uAtClientCallback(pInstance->atHandle,
+                                              UULOC_urc_callback, pUrcStorage);
+                if (errorCode != 0) {
+                    uPortFree(pUrcStorage);
+                }
+            }
+        }
+    } else {
+        errorCode = beginLocationFix(pInstance);
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: MISC
  * -------------------------------------------------------------- */
@@ -716,6 +846,39 @@ int32_t uCellLocGetDesiredFixTimeout(uDeviceHandle_t cellHandle)
     return errorCodeOrFixTimeout;
 }
 
+// Set the maximum age of a re-usable cached fix.
+void uCellLocSetCacheMaxAge(uDeviceHandle_t cellHandle,
+                            int32_t maxAgeSeconds)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance = NULL;
+
+    U_CELL_LOC_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCode);
+
+    if ((errorCode == 0) && (pInstance != NULL)) {
+        pInstance->pLocContext->cacheMaxAgeSeconds = maxAgeSeconds;
+    }
+
+    U_CELL_LOC_EXIT_FUNCTION();
+}
+
+// Get the maximum age of a re-usable cached fix.
+int32_t uCellLocGetCacheMaxAge(uDeviceHandle_t cellHandle)
+{
+    int32_t errorCodeOrMaxAge = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance = NULL;
+
+    U_CELL_LOC_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCodeOrMaxAge);
+
+    if ((errorCodeOrMaxAge == 0) && (pInstance != NULL)) {
+        errorCodeOrMaxAge = pInstance->pLocContext->cacheMaxAgeSeconds;
+    }
+
+    U_CELL_LOC_EXIT_FUNCTION();
+
+    return errorCodeOrMaxAge;
+}
+
 // Set whether a GNSS chip is used or not.
 void uCellLocSetGnssEnable(uDeviceHandle_t cellHandle, bool onNotOff)
 {
@@ -1037,7 +1200,7 @@ int32_t uCellLocGet(uDeviceHandle_t cellHandle,
                                            pInstance);
                     // Start the location fix
                     pContext->fixStatus = (int32_t) U_LOCATION_STATUS_UNKNOWN;
-                    errorCode = beginLocationFix(pInstance);
+                    errorCode = beginLocationFixOrUseCache(pInstance);
                     if (errorCode != 0) {
                         uAtClientRemoveUrcHandler(pInstance->atHandle, "+UULOC:");
                     }
@@ -1148,7 +1311,7 @@ int32_t uCellLocGetStart(uDeviceHandle_t cellHandle,
                     uAtClientRemoveUrcHandler(pInstance->atHandle, "+UULOC:");
                     uAtClientSetUrcHandler(pInstance->atHandle, "+UULOC:",
                                            UULOC_urc, pInstance);
-                    errorCode = beginLocationFix(pInstance);
+                    errorCode = beginLocationFixOrUseCache(pInstance);
                     if (errorCode != 0) {
                         uAtClientRemoveUrcHandler(pInstance->atHandle, "+UULOC:");
                     }
@@ -1164,6 +1327,64 @@ int32_t uCellLocGetStart(uDeviceHandle_t cellHandle,
     return errorCode;
 }
 
+// Get the last successful location fix.
+int32_t uCellLocGetLast(uDeviceHandle_t cellHandle,
+                        int32_t *pLatitudeX1e7, int32_t *pLongitudeX1e7,
+                        int32_t *pAltitudeMillimetres, int32_t *pRadiusMillimetres,
+                        int32_t *pSpeedMillimetresPerSecond,
+                        int32_t *pSvs, int64_t *pTimeUtc,
+                        int32_t *pAgeSeconds)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance = NULL;
+    uCellPrivateLocContext_t *pContext;
+    const uCellPrivateLocCache_t *pCache;
+
+    U_CELL_LOC_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCode);
+
+    if ((errorCode == 0) && (pInstance != NULL)) {
+        pContext = pInstance->pLocContext;
+        pCache = &(pContext->cache);
+
+        U_PORT_MUTEX_LOCK(pContext->fixDataStorageMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        if (pCache->valid) {
+            if (pLatitudeX1e7 != NULL) {
+                *pLatitudeX1e7 = pCache->latitudeX1e7;
+            }
+            if (pLongitudeX1e7 != NULL) {
+                *pLongitudeX1e7 = pCache->longitudeX1e7;
+            }
+            if (pAltitudeMillimetres != NULL) {
+                *pAltitudeMillimetres = pCache->altitudeMillimetres;
+            }
+            if (pRadiusMillimetres != NULL) {
+                *pRadiusMillimetres = pCache->radiusMillimetres;
+            }
+            if (pSpeedMillimetresPerSecond != NULL) {
+                *pSpeedMillimetresPerSecond = pCache->speedMillimetresPerSecond;
+            }
+            if (pSvs != NULL) {
+                *pSvs = pCache->svs;
+            }
+            if (pTimeUtc != NULL) {
+                *pTimeUtc = pCache->timeUtc;
+            }
+            if (pAgeSeconds != NULL) {
+                *pAgeSeconds = (uPortGetTickTimeMs() - pCache->timeMs) / 1000;
+            }
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK(pContext->fixDataStorageMutex);
+    }
+
+    U_CELL_LOC_EXIT_FUNCTION();
+
+    return errorCode;
+}
+
 // Get the last status of a location fix attempt.
 int32_t uCellLocGetStatus(uDeviceHandle_t cellHandle)
 {
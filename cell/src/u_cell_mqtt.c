@@ -37,6 +37,7 @@
 #include "stdio.h"     // snprintf()
 
 #include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
 
 #include "u_error_common.h"
 
@@ -50,6 +51,7 @@
 #include "u_port.h"
 #include "u_port_debug.h"
 #include "u_port_os.h"
+#include "u_task_registry.h"
 
 #include "u_hex_bin_convert.h"
 
@@ -89,6 +91,36 @@
 # define U_CELL_MQTT_CONNECT_DELAY_MILLISECONDS 1000
 #endif
 
+#ifndef U_CELL_MQTT_PUBLISH_URC_CHECK_INTERVAL_MS
+/** How often to check for the URC that indicates a publish
+ * has completed; the module is still poked with an "AT" only
+ * once a second, this just means that we don't hang around
+ * for up to a second after the broker has responded.
+ */
+# define U_CELL_MQTT_PUBLISH_URC_CHECK_INTERVAL_MS 20
+#endif
+
+#ifndef U_CELL_MQTT_PUBLISH_ASYNC_TASK_STACK_SIZE_BYTES
+/** The stack size for the asynchronous publish task; this calls
+ * publish() and then the user's callback, and if power saving
+ * may be on then additional stack will be used by the AT client.
+ */
+# define U_CELL_MQTT_PUBLISH_ASYNC_TASK_STACK_SIZE_BYTES (1024 * 3)
+#endif
+
+#ifndef U_CELL_MQTT_PUBLISH_ASYNC_TASK_PRIORITY
+/** The task priority for the asynchronous publish task.
+ */
+# define U_CELL_MQTT_PUBLISH_ASYNC_TASK_PRIORITY (U_CFG_OS_PRIORITY_MIN + 2)
+#endif
+
+#ifndef U_CELL_MQTT_PUBLISH_ASYNC_LOCK_TRY_MS
+/** How long the asynchronous publish task waits on the cellular
+ * mutex before checking whether it has been asked to exit.
+ */
+# define U_CELL_MQTT_PUBLISH_ASYNC_LOCK_TRY_MS 100
+#endif
+
 /** Helper macro to make sure that the entry and exit functions
  * are always called.
  */
@@ -96,7 +128,8 @@
                                    { entryFunction(cellHandle, \
                                                    ppInstance, \
                                                    pErrorCode, \
-                                                   mustBeInitialised)
+                                                   mustBeInitialised); \
+                                     U_CELL_PRIVATE_AT_STATS_TAG(*(ppInstance))
 
 /** Helper macro to make sure that the entry and exit functions
  * are always called.
@@ -254,6 +287,65 @@ typedef struct {
     bool messageRead;
 } uCellMqttUrcMessage_t;
 
+/** An entry in the asynchronous publish queue; the topic and
+ * the message are stored in the same allocation, immediately
+ * after the structure.
+ */
+typedef struct {
+    uDeviceHandle_t cellHandle;
+    int32_t msgId;
+    char *pTopicNameStr;
+    char *pMessage;
+    size_t messageSizeBytes;
+    uCellMqttQos_t qos;
+    bool retain;
+    void (*pCallback) (uDeviceHandle_t, int32_t, int32_t, void *);
+    void *pCallbackParam;
+    uint32_t urcIndex; /**< when sent through the publish window, the
+                            index of the URC that will carry the outcome. */
+    int32_t startTimeMs; /**< when sent through the publish window, the
+                              time it was sent. */
+} uCellMqttPublishAsync_t;
+
+/** An entry in the ring of messages fetched by auto-fetch.
+ */
+typedef struct {
+    char topicNameStr[U_CELL_MQTT_READ_TOPIC_MAX_LENGTH_BYTES + 1];
+    char message[U_CELL_MQTT_AUTO_FETCH_MESSAGE_MAX_LENGTH_BYTES];
+    size_t messageSizeBytes;
+    uCellMqttQos_t qos;
+} uCellMqttAutoFetchEntry_t;
+
+/** The auto-fetch context; the ring of entries is stored in the
+ * same allocation, immediately after the structure.
+ */
+typedef struct {
+    const uCellPrivateInstance_t *pInstance;
+    uCellMqttAutoFetchCallback_t *pCallback;
+    void *pCallbackParam;
+    uCellMqttAutoFetchEntry_t *pEntry;
+    size_t numEntries;
+    size_t readIndex;   /**< only touched by the fetch callback. */
+    size_t numInRing;   /**< only touched by the fetch callback. */
+    uint32_t numPosted; /**< incremented by the URC handler each time
+                             the fetch callback is posted. */
+    uint32_t numDone;   /**< incremented by the fetch callback each
+                             time it completes. */
+    bool freeOnExit;    /**< set if auto-fetch was switched off while
+                             the fetch callback was pending. */
+} uCellMqttAutoFetch_t;
+
+#if U_CELL_MQTT_SN_TOPIC_CACHE_MAX_NUM > 0
+/** An entry in the MQTT-SN topic cache.
+ */
+typedef struct {
+    uint32_t scopeHash;  /**< hash of the broker name and client ID. */
+    uint32_t lastUsed;   /**< for replacement, zero if the entry is empty. */
+    uint16_t topicId;
+    char topicNameStr[U_CELL_MQTT_SN_TOPIC_CACHE_NAME_MAX_LENGTH_BYTES];
+} uCellMqttSnTopicCacheEntry_t;
+#endif
+
 /** Struct bringing all of the above together.
  */
 typedef struct {
@@ -287,6 +379,38 @@ typedef struct {
                                                       required for SARA-R4. */
     size_t numTries; /**< The number of tries for a radio-related operation. */
     bool mqttSn; /**< true if this is an MQTT-SN session, else false. */
+    uPortQueueHandle_t publishAsyncQueue; /**< queue of pointers to
+                                               uCellMqttPublishAsync_t,
+                                               NULL if the asynchronous
+                                               publish task is not running. */
+    uPortTaskHandle_t publishAsyncTask; /**< the asynchronous publish task. */
+    uPortMutexHandle_t publishAsyncTaskMutex; /**< locked while the asynchronous
+                                                   publish task is running. */
+    bool publishAsyncKeepGoing; /**< set to false to make the asynchronous
+                                     publish task exit. */
+    size_t publishAsyncNumPending; /**< the number of asynchronous publishes
+                                        queued or in progress. */
+    int32_t publishAsyncNextMsgId; /**< the message ID for the next
+                                        asynchronous publish. */
+    size_t publishWindow;      /**< the publish window set with
+                                    uCellMqttSetPublishWindow(). */
+    size_t publishWindowLimit; /**< the publish window in use, which may
+                                    be less than publishWindow if the
+                                    module has refused a publish. */
+    uint32_t publishUrcNum;   /**< the number of publish URCs received. */
+    uint32_t publishUrcNumExpected; /**< the number of publish URCs
+                                         that should have been received. */
+    uint32_t publishUrcSuccessBitmap; /**< the outcome of the last 32
+                                           publish URCs, bit (n % 32) set
+                                           if URC n indicated success. */
+    bool sessionRetained; /**< true if session retention has been
+                               switched on, or found to be on. */
+    uint32_t snTopicCacheScopeHash; /**< hash of the broker name and
+                                         client ID, the scope of
+                                         entries in the MQTT-SN topic
+                                         cache for this session. */
+    uCellMqttAutoFetch_t *pAutoFetch; /**< the auto-fetch context, NULL
+                                           if auto-fetch is off. */
 } uCellMqttContext_t;
 
 /* ----------------------------------------------------------------
@@ -301,6 +425,93 @@ const int32_t gMqttRetryErrorCode[] = {33 /* Timeout */, 34 /* No radio service
  */
 const int32_t gMqttSnRetryErrorCode[] = {21 /* Timeout */, 22 /* No radio service */};
 
+#if U_CELL_MQTT_SN_TOPIC_CACHE_MAX_NUM > 0
+/** The MQTT-SN topic cache; static so that it outlives any one
+ * MQTT context, protected by the cellular API mutex.
+ */
+static uCellMqttSnTopicCacheEntry_t gSnTopicCache[U_CELL_MQTT_SN_TOPIC_CACHE_MAX_NUM];
+
+/** Incremented on each use of the MQTT-SN topic cache.
+ */
+static uint32_t gSnTopicCacheUseCount = 0;
+#endif
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: MQTT-SN TOPIC CACHE
+ * -------------------------------------------------------------- */
+
+// Add a string, including its terminator, to an FNV-1a hash.
+static uint32_t hashString(uint32_t hash, const char *pStr)
+{
+    do {
+        hash ^= (uint8_t) *pStr;
+        hash *= 16777619UL;
+    } while (*pStr++ != 0);
+
+    return hash;
+}
+
+// Work out the scope of the MQTT-SN topic cache entries for a session.
+static uint32_t snTopicCacheScopeHash(const char *pBrokerNameStr,
+                                      const char *pClientIdStr)
+{
+    uint32_t hash = hashString(2166136261UL, pBrokerNameStr);
+
+    if (pClientIdStr != NULL) {
+        hash = hashString(hash, pClientIdStr);
+    }
+
+    return hash;
+}
+
+#if U_CELL_MQTT_SN_TOPIC_CACHE_MAX_NUM > 0
+
+// Find a topic name in the MQTT-SN topic cache, NULL if not found.
+static uCellMqttSnTopicCacheEntry_t *pSnTopicCacheFind(uint32_t scopeHash,
+                                                       const char *pTopicNameStr)
+{
+    uCellMqttSnTopicCacheEntry_t *pEntry = NULL;
+
+    for (size_t x = 0; (x < U_CELL_MQTT_SN_TOPIC_CACHE_MAX_NUM) && (pEntry == NULL); x++) {
+        if ((gSnTopicCache[x].lastUsed > 0) &&
+            (gSnTopicCache[x].scopeHash == scopeHash) &&
+            (strcmp(gSnTopicCache[x].topicNameStr, pTopicNameStr) == 0)) {
+            pEntry = &(gSnTopicCache[x]);
+            gSnTopicCacheUseCount++;
+            pEntry->lastUsed = gSnTopicCacheUseCount;
+        }
+    }
+
+    return pEntry;
+}
+
+// Add a topic name to the MQTT-SN topic cache, replacing the
+// least recently used entry if the cache is full.
+static void snTopicCacheAdd(uint32_t scopeHash, const char *pTopicNameStr,
+                            uint16_t topicId)
+{
+    uCellMqttSnTopicCacheEntry_t *pEntry;
+
+    if (strlen(pTopicNameStr) < sizeof(gSnTopicCache[0].topicNameStr)) {
+        pEntry = pSnTopicCacheFind(scopeHash, pTopicNameStr);
+        if (pEntry == NULL) {
+            pEntry = &(gSnTopicCache[0]);
+            for (size_t x = 1; x < U_CELL_MQTT_SN_TOPIC_CACHE_MAX_NUM; x++) {
+                if (gSnTopicCache[x].lastUsed < pEntry->lastUsed) {
+                    pEntry = &(gSnTopicCache[x]);
+                }
+            }
+            pEntry->scopeHash = scopeHash;
+            strncpy(pEntry->topicNameStr, pTopicNameStr, sizeof(pEntry->topicNameStr));
+            gSnTopicCacheUseCount++;
+            pEntry->lastUsed = gSnTopicCacheUseCount;
+        }
+        pEntry->topicId = topicId;
+    }
+}
+
+#endif // U_CELL_MQTT_SN_TOPIC_CACHE_MAX_NUM > 0
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS: URCS AND RELATED FUNCTIONS
  * -------------------------------------------------------------- */
@@ -360,6 +571,115 @@ static void messageIndicationCallback(uAtClientHandle_t atHandle,
     U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
 }
 
+// Forward declaration of readMessage(), needed by autoFetchCallback().
+static int32_t readMessage(const uCellPrivateInstance_t *pInstance,
+                           char *pTopicNameStr,
+                           size_t topicNameSizeBytes,
+                           int32_t *pTopicNameType,
+                           char *pMessage, size_t *pMessageSizeBytes,
+                           uCellMqttQos_t *pQos);
+
+// Called via the AT parser's callback facility when the module has
+// indicated that there are messages to be read and auto-fetch is on:
+// reads as many as will fit into the ring, then empties the ring
+// into the user's callback, repeating until there are no more.
+static void autoFetchCallback(uAtClientHandle_t atHandle, void *pParam)
+{
+    uCellMqttAutoFetch_t *pAutoFetch = (uCellMqttAutoFetch_t *) pParam;
+    volatile uCellMqttContext_t *pContext;
+    uCellMqttAutoFetchEntry_t *pEntry;
+    size_t writeIndex;
+    bool keepGoing = true;
+
+    (void) atHandle;
+
+    while (keepGoing) {
+        // Fill the ring while holding the cellular API mutex,
+        // which readMessage() requires
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        pContext = (volatile uCellMqttContext_t *) pAutoFetch->pInstance->pMqttContext;
+        while (!pAutoFetch->freeOnExit && (pContext != NULL) &&
+               (pContext->numUnreadMessages > 0) &&
+               (pAutoFetch->numInRing < pAutoFetch->numEntries)) {
+            writeIndex = (pAutoFetch->readIndex + pAutoFetch->numInRing) %
+                         pAutoFetch->numEntries;
+            pEntry = pAutoFetch->pEntry + writeIndex;
+            pEntry->messageSizeBytes = sizeof(pEntry->message);
+            if (readMessage(pAutoFetch->pInstance, pEntry->topicNameStr,
+                            sizeof(pEntry->topicNameStr) - 1, NULL,
+                            pEntry->message, &(pEntry->messageSizeBytes),
+                            &(pEntry->qos)) == 0) {
+                pAutoFetch->numInRing++;
+            } else {
+                // Leave it for the next indication
+                pContext = NULL;
+            }
+        }
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+
+        // Deliver with nothing locked so that the callback
+        // may call back into this API
+        keepGoing = (pAutoFetch->numInRing > 0);
+        while ((pAutoFetch->numInRing > 0) && !pAutoFetch->freeOnExit) {
+            pEntry = pAutoFetch->pEntry + pAutoFetch->readIndex;
+            pAutoFetch->pCallback(pAutoFetch->pInstance->cellHandle,
+                                  pEntry->topicNameStr, pEntry->message,
+                                  pEntry->messageSizeBytes, pEntry->qos,
+                                  pAutoFetch->pCallbackParam);
+            pAutoFetch->readIndex = (pAutoFetch->readIndex + 1) % pAutoFetch->numEntries;
+            pAutoFetch->numInRing--;
+        }
+        keepGoing = keepGoing && !pAutoFetch->freeOnExit;
+    }
+
+    U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+    pAutoFetch->numDone++;
+    if (pAutoFetch->freeOnExit &&
+        (pAutoFetch->numDone == pAutoFetch->numPosted)) {
+        // Auto-fetch has been switched off and we are the last
+        uPortFreeTagged(pAutoFetch);
+    }
+    U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+}
+
+// Called from a URC handler when the number of unread messages
+// has gone up: if auto-fetch is on, kick off autoFetchCallback().
+static void autoFetchPost(uAtClientHandle_t atHandle,
+                          volatile uCellMqttContext_t *pContext)
+{
+    uCellMqttAutoFetch_t *pAutoFetch = pContext->pAutoFetch;
+
+    if ((pAutoFetch != NULL) && (pContext->numUnreadMessages > 0)) {
+        // Count it before posting as it may run at once
+        pAutoFetch->numPosted++;
+        if (uAtClientCallback(atHandle, autoFetchCallback, pAutoFetch) != 0) {
+            pAutoFetch->numPosted--;
+        }
+    }
+}
+
+// Switch auto-fetch off; the cellular API mutex must be locked.
+static void autoFetchStop(const uCellPrivateInstance_t *pInstance,
+                          volatile uCellMqttContext_t *pContext)
+{
+    uCellMqttAutoFetch_t *pAutoFetch = pContext->pAutoFetch;
+
+    if (pAutoFetch != NULL) {
+        // URC handlers run with the AT client locked, so
+        // this ensures that none is using pAutoFetch
+        uAtClientLock(pInstance->atHandle);
+        pContext->pAutoFetch = NULL;
+        uAtClientUnlock(pInstance->atHandle);
+        if (pAutoFetch->numDone == pAutoFetch->numPosted) {
+            uPortFreeTagged(pAutoFetch);
+        } else {
+            // The fetch callback is pending or running,
+            // leave it to free the context
+            pAutoFetch->freeOnExit = true;
+        }
+    }
+}
+
 // A local "trampoline" for the disconnect callback,
 // here so that it can call pDisconnectCallback
 // in a separate task.
@@ -451,7 +771,12 @@ static void UUMQTTC_UUMQTTSNC_urc(uAtClientHandle_t atHandle,
         if (urcParam1 == 1) {
             // Published
             pUrcStatus->flagsBitmap |= 1 << U_CELL_MQTT_URC_FLAG_PUBLISH_SUCCESS;
+            pContext->publishUrcSuccessBitmap |= 1UL << (pContext->publishUrcNum % 32);
+        } else {
+            pContext->publishUrcSuccessBitmap &= ~(1UL << (pContext->publishUrcNum % 32));
         }
+        // The outcome must be recorded before the count is incremented
+        pContext->publishUrcNum++;
         pUrcStatus->flagsBitmap |= 1 << U_CELL_MQTT_URC_FLAG_PUBLISH_UPDATED;
     } else if (urcType == MQTT_COMMAND_OPCODE_SUBSCRIBE(mqttSn)) {
         // Subscribe
@@ -495,6 +820,7 @@ static void UUMQTTC_UUMQTTSNC_urc(uAtClientHandle_t atHandle,
         // Read: urcParam1 contains the number of unread messages
         if (urcParam1 >= 0) {
             pContext->numUnreadMessages = urcParam1;
+            autoFetchPost(atHandle, pContext);
             if (pContext->pMessageIndicationCallback != NULL) {
                 // Launch our local callback via the AT
                 // parser's callback facility.
@@ -1239,6 +1565,9 @@ static int32_t setSessionRetain(uDeviceHandle_t cellHandle, bool onNotOff)
             uAtClientWriteInt(atHandle, MQTT_PROFILE_OPCODE_CLEAN_SESSION(mqttSn));
             uAtClientWriteInt(atHandle, (int32_t) !onNotOff);
             errorCode = atMqttStopCmdGetRespAndUnlock(pInstance);
+            if (errorCode == 0) {
+                pContext->sessionRetained = onNotOff;
+            }
         }
     }
 
@@ -1478,34 +1807,35 @@ static int32_t mqttSnTopicNameToStr(const uCellMqttSnTopicName_t *pTopicName,
  * STATIC FUNCTIONS: PUBLISH/SUBSCRIBE/UNSUBSCRIBE/READ
  * -------------------------------------------------------------- */
 
-// Publish a message, MQTT or MQTT-SN style.
-static int32_t publish(const uCellPrivateInstance_t *pInstance,
-                       const char *pTopicNameStr,
-                       int32_t topicNameType,
-                       const char *pMessage,
-                       size_t messageSizeBytes,
-                       uCellMqttQos_t qos, bool retain)
+// Check the parameters of a publish, MQTT or MQTT-SN style, and, if
+// the module is not able to publish the message as a binary blob,
+// allocate a copy of it as ASCII or hex text in *ppTextMessage,
+// which the caller must free.
+static int32_t publishPrepare(const uCellPrivateInstance_t *pInstance,
+                              const char *pTopicNameStr,
+                              const char *pMessage,
+                              size_t messageSizeBytes,
+                              uCellMqttQos_t qos,
+                              char **ppTextMessage, bool *pIsAscii)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
     volatile uCellMqttContext_t *pContext;
     bool mqttSn;
-    volatile uCellMqttUrcStatus_t *pUrcStatus;
-    uAtClientHandle_t atHandle;
     char *pTextMessage = NULL;
-    int32_t status = 1;
-    bool isAscii;
-    bool messageWritten = false;
-    int32_t startTimeMs;
-    size_t tryCount = 0;
+    bool isAscii = false;
+    bool binary;
 
     pContext = (volatile uCellMqttContext_t *) pInstance->pMqttContext;
     mqttSn = pContext->mqttSn;
-    pUrcStatus = &(pContext->urcStatus);
+    // Note: the MQTT-SN AT interface never supports binary
+    // publishing (even where the MQTT one does)
+    binary = !mqttSn && U_CELL_PRIVATE_HAS(pInstance->pModule,
+                                           U_CELL_PRIVATE_FEATURE_MQTT_BINARY_PUBLISH);
     if (mqttSn) {
         isAscii = isAllowedMqttSn(pMessage, messageSizeBytes);
-    } else {
-        // This will be ignored for module types that support binary
-        // publish, which eveything except SARA-R41x does
+    } else if (!binary) {
+        // Only SARA-R41x gets here: everything else supports binary
+        // publish and then there is no need to scan the message
         isAscii = isAllowedMqttSaraR41x(pMessage, messageSizeBytes);
     }
     //lint -e(568) Suppress value never being negative, who knows
@@ -1522,24 +1852,23 @@ static int32_t publish(const uCellPrivateInstance_t *pInstance,
                               U_CELL_PRIVATE_FEATURE_MQTT_BINARY_PUBLISH) &&
           ((isAscii && (messageSizeBytes <= U_CELL_MQTT_PUBLISH_HEX_MAX_LENGTH_BYTES * 2)) ||
            (messageSizeBytes <= U_CELL_MQTT_PUBLISH_HEX_MAX_LENGTH_BYTES))))) {
-        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-        if (!U_CELL_PRIVATE_HAS(pInstance->pModule,
-                                U_CELL_PRIVATE_FEATURE_MQTT_BINARY_PUBLISH) ||
-            mqttSn) {
-            // Note: the MQTT-SN AT interface never supports binary
-            // publishing (even where the MQTT one does)
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (!binary) {
             // If we aren't able to publish a message as a binary
             // blob then allocate space to publish it as a string,
             // either as hex or as ASCII with a terminator added
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
             if (isAscii) {
-                pTextMessage = (char *) pUPortMalloc(messageSizeBytes + 1);
+                pTextMessage = (char *) pUPortMallocTagged(U_PORT_HEAP_TAG_CELL_MQTT,
+                                                           messageSizeBytes + 1);
                 if (pTextMessage != NULL) {
                     // Just copy in the text and add a terminator
                     memcpy(pTextMessage, pMessage, messageSizeBytes);
                     *(pTextMessage + messageSizeBytes) = '\0';
                 }
             } else {
-                pTextMessage = (char *) pUPortMalloc((messageSizeBytes * 2) + 1);
+                pTextMessage = (char *) pUPortMallocTagged(U_PORT_HEAP_TAG_CELL_MQTT,
+                                                           (messageSizeBytes * 2) + 1);
                 if (pTextMessage != NULL) {
                     // Convert to hex
                     uBinToHex(pMessage, messageSizeBytes, pTextMessage);
@@ -1547,137 +1876,526 @@ static int32_t publish(const uCellPrivateInstance_t *pInstance,
                     *(pTextMessage + (messageSizeBytes * 2)) = '\0';
                 }
             }
+            if (pTextMessage != NULL) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
         }
+    }
 
-        if ((pTextMessage != NULL) ||
-            U_CELL_PRIVATE_HAS(pInstance->pModule,
-                               U_CELL_PRIVATE_FEATURE_MQTT_BINARY_PUBLISH)) {
-            errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
-            atHandle = pInstance->atHandle;
-            // We retry this if the failure was due to radio conditions
-            do {
-                uAtClientLock(atHandle);
-                pUrcStatus->flagsBitmap = 0;
-                if (U_CELL_PRIVATE_HAS(pInstance->pModule,
-                                       U_CELL_PRIVATE_FEATURE_MQTT_SARA_R4_OLD_SYNTAX)) {
-                    // In the old SARA-R4 syntax there's no URC
-                    // for a publish, so the timeout is that
-                    // of the AT command
-                    uAtClientTimeoutSet(atHandle,
-                                        U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000);
-                }
-                uAtClientCommandStart(atHandle, MQTT_COMMAND_AT_COMMAND_STRING(mqttSn));
-                // Publish the message
-                if (pTextMessage != NULL) {
-                    // ASCII or hex mode
-                    uAtClientWriteInt(atHandle, MQTT_COMMAND_OPCODE_PUBLISH_STRING(mqttSn));
-                } else {
-                    // Binary mode (not supported by MQTT-SN, hence we don't need a macro)
-                    uAtClientWriteInt(atHandle, 9);
-                }
-                // QoS
-                uAtClientWriteInt(atHandle, (int32_t) qos);
-                // Retention
-                uAtClientWriteInt(atHandle, (int32_t) retain);
-                if (pTextMessage != NULL) {
-                    // If we aren't doing binary mode...
-                    if (isAscii) {
-                        // ASCII mode
-                        uAtClientWriteInt(atHandle, 0);
-                    } else {
-                        // Hex mode
-                        uAtClientWriteInt(atHandle, 1);
+    *ppTextMessage = pTextMessage;
+    *pIsAscii = isAscii;
+
+    return errorCode;
+}
+
+// Send a publish command to the module, MQTT or MQTT-SN style, for
+// a message that has been through publishPrepare(); pTextMessage
+// is NULL if the message is to be written as a binary blob.  This
+// does NOT wait for the URC that carries the outcome of the
+// publish: zero is returned if the module has accepted the command.
+static int32_t publishWrite(const uCellPrivateInstance_t *pInstance,
+                            const char *pTopicNameStr,
+                            int32_t topicNameType,
+                            const char *pMessage,
+                            size_t messageSizeBytes,
+                            const char *pTextMessage, bool isAscii,
+                            uCellMqttQos_t qos, bool retain)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+    volatile uCellMqttContext_t *pContext;
+    bool mqttSn;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    int32_t status = 1;
+    bool messageWritten = false;
+
+    pContext = (volatile uCellMqttContext_t *) pInstance->pMqttContext;
+    mqttSn = pContext->mqttSn;
+
+    uAtClientLock(atHandle);
+    pContext->urcStatus.flagsBitmap = 0;
+    if (U_CELL_PRIVATE_HAS(pInstance->pModule,
+                           U_CELL_PRIVATE_FEATURE_MQTT_SARA_R4_OLD_SYNTAX)) {
+        // In the old SARA-R4 syntax there's no URC
+        // for a publish, so the timeout is that
+        // of the AT command
+        uAtClientTimeoutSet(atHandle,
+                            U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000);
+    }
+    uAtClientCommandStart(atHandle, MQTT_COMMAND_AT_COMMAND_STRING(mqttSn));
+    // Publish the message
+    if (pTextMessage != NULL) {
+        // ASCII or hex mode
+        uAtClientWriteInt(atHandle, MQTT_COMMAND_OPCODE_PUBLISH_STRING(mqttSn));
+    } else {
+        // Binary mode (not supported by MQTT-SN, hence we don't need a macro)
+        uAtClientWriteInt(atHandle, 9);
+    }
+    // QoS
+    uAtClientWriteInt(atHandle, (int32_t) qos);
+    // Retention
+    uAtClientWriteInt(atHandle, (int32_t) retain);
+    if (pTextMessage != NULL) {
+        // If we aren't doing binary mode...
+        if (isAscii) {
+            // ASCII mode
+            uAtClientWriteInt(atHandle, 0);
+        } else {
+            // Hex mode
+            uAtClientWriteInt(atHandle, 1);
+        }
+    }
+    if (mqttSn) {
+        // Specify the topic type for MQTT-SN
+        uAtClientWriteInt(atHandle, topicNameType);
+    }
+    // Topic
+    uAtClientWriteString(atHandle, pTopicNameStr, true);
+    if (pTextMessage == NULL) {
+        // The length of the binary message
+        uAtClientWriteInt(atHandle, (int32_t) messageSizeBytes);
+        uAtClientCommandStop(atHandle);
+        // Wait for the prompt
+        if (uAtClientWaitCharacter(atHandle, '>') == 0) {
+            // Allow plenty of time for this to complete
+            uAtClientTimeoutSet(atHandle, 10000);
+            // Wait for it...
+            uPortTaskBlock(U_CELL_MQTT_BINARY_PUBLISH_PROMPT_DELAY_MS);
+            // Write the binary message
+            messageWritten = (uAtClientWriteBytes(atHandle,
+                                                  pMessage,
+                                                  messageSizeBytes,
+                                                  true) == messageSizeBytes);
+        }
+    } else {
+        // ASCII or hex message
+        uAtClientWriteString(atHandle, pTextMessage, true);
+        messageWritten = true;
+        uAtClientCommandStop(atHandle);
+    }
+
+    if (messageWritten) {
+        if (U_CELL_PRIVATE_HAS(pInstance->pModule,
+                               U_CELL_PRIVATE_FEATURE_MQTT_SARA_R4_OLD_SYNTAX)) {
+            uAtClientResponseStart(atHandle, MQTT_COMMAND_AT_RESPONSE_STRING(mqttSn));
+            // Skip the first parameter, which is just
+            // our UMQTTC command number again
+            uAtClientSkipParameters(atHandle, 1);
+            status = uAtClientReadInt(atHandle);
+        } else {
+            uAtClientResponseStart(atHandle, NULL);
+        }
+    }
+    // If the message wasn't written this will tidy
+    // up any rubbish lying around in the AT buffer
+    uAtClientResponseStop(atHandle);
+
+    if ((uAtClientUnlock(atHandle) == 0) && (status == 1)) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (!U_CELL_PRIVATE_HAS(pInstance->pModule,
+                                U_CELL_PRIVATE_FEATURE_MQTT_SARA_R4_OLD_SYNTAX)) {
+            // There will be a URC for this publish
+            pContext->publishUrcNumExpected++;
+        }
+    }
+
+    return errorCode;
+}
+
+// Publish a message, MQTT or MQTT-SN style, and wait for the outcome.
+static int32_t publish(const uCellPrivateInstance_t *pInstance,
+                       const char *pTopicNameStr,
+                       int32_t topicNameType,
+                       const char *pMessage,
+                       size_t messageSizeBytes,
+                       uCellMqttQos_t qos, bool retain)
+{
+    int32_t errorCode;
+    volatile uCellMqttContext_t *pContext;
+    bool mqttSn;
+    volatile uCellMqttUrcStatus_t *pUrcStatus;
+    uAtClientHandle_t atHandle;
+    char *pTextMessage = NULL;
+    bool isAscii = false;
+    int32_t startTimeMs;
+    int32_t pokeTimeMs;
+    size_t tryCount = 0;
+
+    pContext = (volatile uCellMqttContext_t *) pInstance->pMqttContext;
+    mqttSn = pContext->mqttSn;
+    pUrcStatus = &(pContext->urcStatus);
+    atHandle = pInstance->atHandle;
+
+    errorCode = publishPrepare(pInstance, pTopicNameStr, pMessage, messageSizeBytes,
+                               qos, &pTextMessage, &isAscii);
+    if (errorCode == 0) {
+        // If publishes made through a window by the asynchronous
+        // publish task are still waiting for the broker, let them
+        // finish first so that the URC for this publish cannot be
+        // confused with one of theirs
+        startTimeMs = uPortGetTickTimeMs();
+        while (((int32_t) (pContext->publishUrcNumExpected - pContext->publishUrcNum) > 0) &&
+               (uPortGetTickTimeMs() - startTimeMs <
+                (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000))) {
+            uPortTaskBlock(U_CELL_MQTT_PUBLISH_URC_CHECK_INTERVAL_MS);
+        }
+        // We retry this if the failure was due to radio conditions
+        do {
+            errorCode = publishWrite(pInstance, pTopicNameStr, topicNameType,
+                                     pMessage, messageSizeBytes,
+                                     pTextMessage, isAscii, qos, retain);
+            if ((errorCode == 0) &&
+                !U_CELL_PRIVATE_HAS(pInstance->pModule,
+                                    U_CELL_PRIVATE_FEATURE_MQTT_SARA_R4_OLD_SYNTAX)) {
+                // For the old SARA-R4 syntax, that's it, otherwise
+                // wait for a URC to say that the publish has succeeded
+                errorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
+                startTimeMs = uPortGetTickTimeMs();
+                pokeTimeMs = startTimeMs;
+                while (((pUrcStatus->flagsBitmap & (1 << U_CELL_MQTT_URC_FLAG_PUBLISH_UPDATED)) == 0) &&
+                       (uPortGetTickTimeMs() - startTimeMs < (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000)) &&
+                       ((pContext->pKeepGoingCallback == NULL) ||
+                        pContext->pKeepGoingCallback())) {
+                    uPortTaskBlock(U_CELL_MQTT_PUBLISH_URC_CHECK_INTERVAL_MS);
+                    if (uPortGetTickTimeMs() - pokeTimeMs >= 1000) {
+                        // When UART power saving is switched on some
+                        // modules (e.g. SARA-R422) can somteimes
+                        // withhold URCs so poke the module here to be
+                        // sure that it has not gone to sleep on us
+                        uAtClientLock(atHandle);
+                        uAtClientCommandStart(atHandle, "AT");
+                        uAtClientCommandStopReadResponse(atHandle);
+                        uAtClientUnlock(atHandle);
+                        pokeTimeMs = uPortGetTickTimeMs();
                     }
                 }
-                if (mqttSn) {
-                    // Specify the topic type for MQTT-SN
-                    uAtClientWriteInt(atHandle, topicNameType);
-                }
-                // Topic
-                uAtClientWriteString(atHandle, pTopicNameStr, true);
-                if (pTextMessage == NULL) {
-                    // The length of the binary message
-                    uAtClientWriteInt(atHandle, (int32_t) messageSizeBytes);
-                    uAtClientCommandStop(atHandle);
-                    // Wait for the prompt
-                    if (uAtClientWaitCharacter(atHandle, '>') == 0) {
-                        // Allow plenty of time for this to complete
-                        uAtClientTimeoutSet(atHandle, 10000);
-                        // Wait for it...
-                        uPortTaskBlock(50);
-                        // Write the binary message
-                        messageWritten = (uAtClientWriteBytes(atHandle,
-                                                              pMessage,
-                                                              messageSizeBytes,
-                                                              true) == messageSizeBytes);
-                    }
-                } else {
-                    // ASCII or hex message
-                    uAtClientWriteString(atHandle, pTextMessage, true);
-                    messageWritten = true;
-                    uAtClientCommandStop(atHandle);
+                if ((pUrcStatus->flagsBitmap & (1 << U_CELL_MQTT_URC_FLAG_PUBLISH_SUCCESS)) != 0) {
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                 }
+            }
+            tryCount++;
+        } while ((errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) &&
+                 (tryCount < pContext->numTries) && mqttRetry(pInstance, mqttSn));
 
-                if (messageWritten) {
-                    if (U_CELL_PRIVATE_HAS(pInstance->pModule,
-                                           U_CELL_PRIVATE_FEATURE_MQTT_SARA_R4_OLD_SYNTAX)) {
-                        uAtClientResponseStart(atHandle, MQTT_COMMAND_AT_RESPONSE_STRING(mqttSn));
-                        // Skip the first parameter, which is just
-                        // our UMQTTC command number again
-                        uAtClientSkipParameters(atHandle, 1);
-                        status = uAtClientReadInt(atHandle);
-                    } else {
-                        uAtClientResponseStart(atHandle, NULL);
-                    }
-                }
-                // If the message wasn't written this will tidy
-                // up any rubbish lying around in the AT buffer
-                uAtClientResponseStop(atHandle);
+        uPortFreeTagged(pTextMessage);
 
-                if ((uAtClientUnlock(atHandle) == 0) && (status == 1)) {
-                    if (U_CELL_PRIVATE_HAS(pInstance->pModule,
-                                           U_CELL_PRIVATE_FEATURE_MQTT_SARA_R4_OLD_SYNTAX)) {
-                        // For the old SARA-R4 syntax, that's it
-                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-                    } else {
-                        // Wait for a URC to say that the publish
-                        // has succeeded
-                        errorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
-                        startTimeMs = uPortGetTickTimeMs();
-                        while (((pUrcStatus->flagsBitmap & (1 << U_CELL_MQTT_URC_FLAG_PUBLISH_UPDATED)) == 0) &&
-                               (uPortGetTickTimeMs() - startTimeMs < (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000)) &&
-                               ((pContext->pKeepGoingCallback == NULL) ||
-                                pContext->pKeepGoingCallback())) {
-                            uPortTaskBlock(1000);
-                            // When UART power saving is switched on some
-                            // modules (e.g. SARA-R422) can somteimes
-                            // withhold URCs so poke the module here to be
-                            // sure that it has not gone to sleep on us
-                            uAtClientLock(atHandle);
-                            uAtClientCommandStart(atHandle, "AT");
-                            uAtClientCommandStopReadResponse(atHandle);
-                            uAtClientUnlock(atHandle);
+        if (errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) {
+            printErrorCodes(pInstance);
+        }
+    }
+
+    return errorCode;
+}
+
+// Start an asynchronous publish through the publish window, i.e.
+// send it to the module without waiting for the outcome, which
+// publishWindowCollect() will pick up from the URC later.
+static int32_t publishWindowStart(const uCellPrivateInstance_t *pInstance,
+                                  uCellMqttPublishAsync_t *pPublish)
+{
+    int32_t errorCode;
+    volatile uCellMqttContext_t *pContext;
+    char *pTextMessage = NULL;
+    bool isAscii = false;
+
+    pContext = (volatile uCellMqttContext_t *) pInstance->pMqttContext;
+    errorCode = publishPrepare(pInstance, pPublish->pTopicNameStr,
+                               pPublish->pMessage, pPublish->messageSizeBytes,
+                               pPublish->qos, &pTextMessage, &isAscii);
+    if (errorCode == 0) {
+        // URCs arrive in the order the publishes were sent, so
+        // this publish's URC is the one after those expected so far
+        pPublish->urcIndex = pContext->publishUrcNumExpected;
+        pPublish->startTimeMs = uPortGetTickTimeMs();
+        errorCode = publishWrite(pInstance, pPublish->pTopicNameStr, -1,
+                                 pPublish->pMessage, pPublish->messageSizeBytes,
+                                 pTextMessage, isAscii,
+                                 pPublish->qos, pPublish->retain);
+        uPortFreeTagged(pTextMessage);
+    }
+
+    return errorCode;
+}
+
+// Move those publishes in the window whose URCs have arrived, or
+// which have timed out, to the done list in ppDone/pDoneErrorCode,
+// which must have room for U_CELL_MQTT_PUBLISH_WINDOW_MAX_NUM
+// entries beyond numDone; returns the new numDone.
+static size_t publishWindowCollect(volatile uCellMqttContext_t *pContext,
+                                   uCellMqttPublishAsync_t **ppInFlight,
+                                   size_t *pNumInFlight,
+                                   uCellMqttPublishAsync_t **ppDone,
+                                   int32_t *pDoneErrorCode,
+                                   size_t numDone)
+{
+    uCellMqttPublishAsync_t *pPublish;
+    int32_t errorCode;
+
+    while ((*pNumInFlight > 0) &&
+           ((int32_t) (pContext->publishUrcNum - (*ppInFlight)->urcIndex) > 0)) {
+        pPublish = *ppInFlight;
+        errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+        if ((pContext->publishUrcSuccessBitmap & (1UL << (pPublish->urcIndex % 32))) != 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+        *(ppDone + numDone) = pPublish;
+        *(pDoneErrorCode + numDone) = errorCode;
+        numDone++;
+        (*pNumInFlight)--;
+        memmove(ppInFlight, ppInFlight + 1, *pNumInFlight * sizeof(*ppInFlight));
+    }
+
+    if ((*pNumInFlight > 0) &&
+        (uPortGetTickTimeMs() - (*ppInFlight)->startTimeMs >=
+         (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000))) {
+        // The URC for the oldest publish has not arrived: give up on
+        // all of them, since there is no way to tell which of any
+        // URCs that turn up late belongs to which, and start counting
+        // URCs afresh
+        for (size_t x = 0; x < *pNumInFlight; x++) {
+            *(ppDone + numDone) = *(ppInFlight + x);
+            *(pDoneErrorCode + numDone) = (int32_t) U_ERROR_COMMON_TIMEOUT;
+            numDone++;
+        }
+        *pNumInFlight = 0;
+        pContext->publishUrcNum = pContext->publishUrcNumExpected;
+    }
+
+    return numDone;
+}
+
+// Call the callback of an asynchronous publish, if there is one,
+// and free it.
+static void publishAsyncComplete(uCellMqttPublishAsync_t *pPublish,
+                                 int32_t errorCode)
+{
+    if (pPublish->pCallback != NULL) {
+        pPublish->pCallback(pPublish->cellHandle, pPublish->msgId,
+                            errorCode, pPublish->pCallbackParam);
+    }
+    uPortFreeTagged(pPublish);
+}
+
+// Task to service the asynchronous publish queue.
+// Each publish is performed with gUCellPrivateMutex locked, so that
+// it is serialised with the other MQTT API calls, but the user's
+// callback is called with it unlocked.  Since publishAsyncStop() is
+// called with gUCellPrivateMutex locked, this task only ever tries to
+// lock it, checking in between whether it has been asked to exit.
+// If the publish window is greater than one, publishes are sent to
+// the module without waiting for the outcome, up to the window size,
+// and their outcomes are collected from the URCs as they arrive; if
+// the module refuses a publish while others are outstanding the
+// window is reduced to the number it had accepted and the refused
+// publish is sent again once one of those has completed.
+static void publishAsyncTask(void *pParameter)
+{
+    volatile uCellMqttContext_t *pContext = (volatile uCellMqttContext_t *) pParameter;
+    uCellMqttPublishAsync_t *pPublish = NULL;
+    uCellMqttPublishAsync_t *pHeld = NULL;
+    uCellMqttPublishAsync_t *pInFlight[U_CELL_MQTT_PUBLISH_WINDOW_MAX_NUM];
+    size_t numInFlight = 0;
+    uCellMqttPublishAsync_t *pDone[U_CELL_MQTT_PUBLISH_WINDOW_MAX_NUM + 1];
+    int32_t doneErrorCode[U_CELL_MQTT_PUBLISH_WINDOW_MAX_NUM + 1];
+    size_t numDone;
+    const uCellPrivateInstance_t *pInstance;
+    uAtClientHandle_t atHandle;
+    int32_t errorCode;
+    int32_t pokeTimeMs = 0;
+    bool locked;
+
+    // Lock the mutex to indicate that we're running
+    U_PORT_MUTEX_LOCK(pContext->publishAsyncTaskMutex);
+
+    while (pContext->publishAsyncKeepGoing) {
+        pPublish = NULL;
+        numDone = 0;
+        if ((pHeld != NULL) && (numInFlight < pContext->publishWindowLimit)) {
+            // Send the refused publish again
+            pPublish = pHeld;
+            pHeld = NULL;
+        } else if ((pHeld == NULL) && (numInFlight == 0)) {
+            // Nothing outstanding: wait for something to do
+            uPortQueueReceive(pContext->publishAsyncQueue, &pPublish);
+        } else if ((pHeld == NULL) && (numInFlight < pContext->publishWindowLimit)) {
+            // Room in the window: take a new publish if there is
+            // one, else just check for URCs
+            uPortQueueTryReceive(pContext->publishAsyncQueue,
+                                 U_CELL_MQTT_PUBLISH_URC_CHECK_INTERVAL_MS,
+                                 &pPublish);
+        } else {
+            // The window is full: wait for URCs
+            uPortTaskBlock(U_CELL_MQTT_PUBLISH_URC_CHECK_INTERVAL_MS);
+        }
+        if ((pPublish != NULL) || (numInFlight > 0)) {
+            locked = false;
+            while (!locked && pContext->publishAsyncKeepGoing) {
+                locked = (uPortMutexTryLock(gUCellPrivateMutex,
+                                            U_CELL_MQTT_PUBLISH_ASYNC_LOCK_TRY_MS) == 0);
+            }
+            if (locked) {
+                pInstance = pUCellPrivateGetInstance(pPublish != NULL ? pPublish->cellHandle :
+                                                     pInFlight[0]->cellHandle);
+                if ((pInstance != NULL) &&
+                    (pInstance->pMqttContext == (volatile void *) pContext)) {
+                    if (pPublish != NULL) {
+                        errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+                        if (pContext->publishWindowLimit > 1) {
+                            errorCode = publishWindowStart(pInstance, pPublish);
+                            if (errorCode == 0) {
+                                pInFlight[numInFlight] = pPublish;
+                                numInFlight++;
+                                pokeTimeMs = uPortGetTickTimeMs();
+                                pPublish = NULL;
+                            } else if ((errorCode == (int32_t) U_ERROR_COMMON_DEVICE_ERROR) &&
+                                       (numInFlight > 0)) {
+                                // The module won't take any more right now
+                                pContext->publishWindowLimit = numInFlight;
+                                pHeld = pPublish;
+                                pPublish = NULL;
+                            }
                         }
-                        if ((pUrcStatus->flagsBitmap & (1 << U_CELL_MQTT_URC_FLAG_PUBLISH_SUCCESS)) != 0) {
-                            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                        if ((pPublish != NULL) &&
+                            (errorCode == (int32_t) U_ERROR_COMMON_DEVICE_ERROR)) {
+                            // Not windowed, or the module refused it with
+                            // nothing else outstanding: do it the long
+                            // way, with retries
+                            errorCode = publish(pInstance, pPublish->pTopicNameStr, -1,
+                                                pPublish->pMessage,
+                                                pPublish->messageSizeBytes,
+                                                pPublish->qos, pPublish->retain);
                         }
+                        if (pPublish != NULL) {
+                            pDone[numDone] = pPublish;
+                            doneErrorCode[numDone] = errorCode;
+                            numDone++;
+                        }
+                    }
+                    if ((numInFlight > 0) && (uPortGetTickTimeMs() - pokeTimeMs >= 1000)) {
+                        // As in publish(), poke the module in case
+                        // it is withholding URCs
+                        atHandle = pInstance->atHandle;
+                        uAtClientLock(atHandle);
+                        uAtClientCommandStart(atHandle, "AT");
+                        uAtClientCommandStopReadResponse(atHandle);
+                        uAtClientUnlock(atHandle);
+                        pokeTimeMs = uPortGetTickTimeMs();
+                    }
+                    numDone = publishWindowCollect(pContext, pInFlight, &numInFlight,
+                                                   pDone, doneErrorCode, numDone);
+                } else {
+                    // The instance has gone: nothing can complete
+                    if (pPublish != NULL) {
+                        pDone[numDone] = pPublish;
+                        doneErrorCode[numDone] = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+                        numDone++;
+                    }
+                    for (size_t x = 0; x < numInFlight; x++) {
+                        pDone[numDone] = pInFlight[x];
+                        doneErrorCode[numDone] = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+                        numDone++;
                     }
+                    numInFlight = 0;
                 }
-                tryCount++;
-            } while ((errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) &&
-                     (tryCount < pContext->numTries) && mqttRetry(pInstance, mqttSn));
+                pContext->publishAsyncNumPending -= numDone;
+                uPortMutexUnlock(gUCellPrivateMutex);
+            } else if (pPublish != NULL) {
+                pDone[numDone] = pPublish;
+                doneErrorCode[numDone] = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+                numDone++;
+            }
+        }
+        for (size_t x = 0; x < numDone; x++) {
+            publishAsyncComplete(pDone[x], doneErrorCode[x]);
+        }
+    }
+
+    // Anything still outstanding or left in the queue will never be sent
+    for (size_t x = 0; x < numInFlight; x++) {
+        publishAsyncComplete(pInFlight[x], (int32_t) U_ERROR_COMMON_NOT_INITIALISED);
+    }
+    if (pHeld != NULL) {
+        publishAsyncComplete(pHeld, (int32_t) U_ERROR_COMMON_NOT_INITIALISED);
+    }
+    while (uPortQueueTryReceive(pContext->publishAsyncQueue, 0, &pPublish) == 0) {
+        if (pPublish != NULL) {
+            publishAsyncComplete(pPublish, (int32_t) U_ERROR_COMMON_NOT_INITIALISED);
+        }
+    }
 
-            uPortFree(pTextMessage);
+    U_PORT_MUTEX_UNLOCK(pContext->publishAsyncTaskMutex);
 
-            if (errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) {
-                printErrorCodes(pInstance);
+    // Delete ourselves
+    uTaskRegistryTaskDelete(NULL);
+}
+
+// Start the asynchronous publish task and its queue.
+static int32_t publishAsyncStart(volatile uCellMqttContext_t *pContext)
+{
+    int32_t errorCode;
+    uPortMutexHandle_t mutexHandle = NULL;
+    uPortQueueHandle_t queueHandle = NULL;
+    uPortTaskHandle_t taskHandle = NULL;
+
+    errorCode = uPortMutexCreate(&mutexHandle);
+    if (errorCode == 0) {
+        // One more than the queue length so that there is always
+        // room for the NULL that tells the task to exit
+        errorCode = uPortQueueCreate(U_CELL_MQTT_PUBLISH_ASYNC_QUEUE_LENGTH + 1,
+                                     sizeof(uCellMqttPublishAsync_t *),
+                                     &queueHandle);
+        if (errorCode == 0) {
+            pContext->publishAsyncTaskMutex = mutexHandle;
+            pContext->publishAsyncQueue = queueHandle;
+            pContext->publishAsyncKeepGoing = true;
+            //lint -e(1773) Suppress complaints about
+            // passing the pointer as non-volatile
+            errorCode = uTaskRegistryTaskCreate(publishAsyncTask,
+                                                "cellMqttPublish",
+                                                U_CELL_MQTT_PUBLISH_ASYNC_TASK_STACK_SIZE_BYTES,
+                                                (void *) pContext,
+                                                U_CELL_MQTT_PUBLISH_ASYNC_TASK_PRIORITY,
+                                                &taskHandle);
+            if (errorCode == 0) {
+                pContext->publishAsyncTask = taskHandle;
+            } else {
+                pContext->publishAsyncKeepGoing = false;
+                pContext->publishAsyncQueue = NULL;
+                pContext->publishAsyncTaskMutex = NULL;
+                uPortQueueDelete(queueHandle);
             }
         }
+        if (errorCode != 0) {
+            uPortMutexDelete(mutexHandle);
+        }
     }
 
     return errorCode;
 }
 
+// Stop the asynchronous publish task, if it is running; any
+// publishes still queued are completed with
+// U_ERROR_COMMON_NOT_INITIALISED.  MUST be called with
+// gUCellPrivateMutex locked.
+static void publishAsyncStop(volatile uCellMqttContext_t *pContext)
+{
+    uCellMqttPublishAsync_t *pPublish = NULL;
+
+    if (pContext->publishAsyncQueue != NULL) {
+        pContext->publishAsyncKeepGoing = false;
+        // Wake the task up in case it is waiting on the queue
+        uPortQueueSend(pContext->publishAsyncQueue, &pPublish);
+        // Wait for the task to exit
+        U_PORT_MUTEX_LOCK(pContext->publishAsyncTaskMutex);
+        U_PORT_MUTEX_UNLOCK(pContext->publishAsyncTaskMutex);
+        uPortMutexDelete(pContext->publishAsyncTaskMutex);
+        pContext->publishAsyncTaskMutex = NULL;
+        uPortQueueDelete(pContext->publishAsyncQueue);
+        pContext->publishAsyncQueue = NULL;
+        pContext->publishAsyncTask = NULL;
+        pContext->publishAsyncNumPending = 0;
+    }
+}
+
 // Subscribe to an MQTT topic, MQTT or MQTT-SN style.
 static int32_t subscribe(const uCellPrivateInstance_t *pInstance,
                          const char *pTopicFilterStr,
@@ -2060,6 +2778,7 @@ int32_t uCellMqttInit(uDeviceHandle_t cellHandle, const char *pBrokerNameStr,
     int32_t status = 1;
     bool keepGoing = true;
     char imei[U_CELL_INFO_IMEI_SIZE + 1];
+    const char *pScopeClientIdStr;
 
     U_CELL_MQTT_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCode, false);
 
@@ -2077,7 +2796,8 @@ int32_t uCellMqttInit(uDeviceHandle_t cellHandle, const char *pBrokerNameStr,
                  U_CELL_MQTT_BROKER_ADDRESS_STRING_MAX_LENGTH_BYTES)) {
                 errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
                 // Allocate memory for the MQTT context
-                pContext = (volatile uCellMqttContext_t *) pUPortMalloc(sizeof(*pContext));
+                pContext = (volatile uCellMqttContext_t *) pUPortMallocTagged(
+                           U_PORT_HEAP_TAG_CELL_MQTT, sizeof(*pContext));
                 if (pContext != NULL) {
                     pContext->pKeepGoingCallback = pKeepGoingCallback;
                     pContext->pMessageIndicationCallback = NULL;
@@ -2091,10 +2811,26 @@ int32_t uCellMqttInit(uDeviceHandle_t cellHandle, const char *pBrokerNameStr,
                     pContext->pUrcMessage = NULL;
                     pContext->numTries = U_CELL_MQTT_RETRIES_DEFAULT + 1;
                     pContext->mqttSn = mqttSn;
+                    pContext->publishAsyncQueue = NULL;
+                    pContext->publishAsyncTask = NULL;
+                    pContext->publishAsyncTaskMutex = NULL;
+                    pContext->publishAsyncKeepGoing = false;
+                    pContext->publishAsyncNumPending = 0;
+                    pContext->publishAsyncNextMsgId = 0;
+                    pContext->publishWindow = U_CELL_MQTT_PUBLISH_WINDOW_DEFAULT;
+                    pContext->publishWindowLimit = U_CELL_MQTT_PUBLISH_WINDOW_DEFAULT;
+                    pContext->publishUrcNum = 0;
+                    pContext->publishUrcNumExpected = 0;
+                    pContext->publishUrcSuccessBitmap = 0;
+                    pContext->sessionRetained = false;
+                    pContext->pAutoFetch = NULL;
+                    pContext->snTopicCacheScopeHash = 0;
                     pInstance->pMqttContext = pContext;
                     if (U_CELL_PRIVATE_MODULE_IS_SARA_R4(pInstance->pModule->moduleType)) {
                         // SARA-R4 requires a pUrcMessage as well
-                        pContext->pUrcMessage = (uCellMqttUrcMessage_t *) pUPortMalloc(sizeof(*(pContext->pUrcMessage)));
+                        pContext->pUrcMessage = (uCellMqttUrcMessage_t *) pUPortMallocTagged(
+                                                U_PORT_HEAP_TAG_CELL_MQTT,
+                                                sizeof(*(pContext->pUrcMessage)));
                     }
                     if ((pContext->pUrcMessage != NULL) ||
                         !U_CELL_PRIVATE_MODULE_IS_SARA_R4(pInstance->pModule->moduleType)) {
@@ -2102,8 +2838,9 @@ int32_t uCellMqttInit(uDeviceHandle_t cellHandle, const char *pBrokerNameStr,
                         // Deal with the broker name string
                         // Allocate space to fiddle with the
                         // server address, +1 for terminator
-                        pContext->pBrokerNameStr = (char *) pUPortMalloc(U_CELL_MQTT_BROKER_ADDRESS_STRING_MAX_LENGTH_BYTES
-                                                                         + 1);
+                        pContext->pBrokerNameStr = (char *) pUPortMallocTagged(
+                                                   U_PORT_HEAP_TAG_CELL_MQTT,
+                                                   U_CELL_MQTT_BROKER_ADDRESS_STRING_MAX_LENGTH_BYTES + 1);
                         if (pContext->pBrokerNameStr != NULL) {
                             errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
                             // Determine if the server name given
@@ -2157,7 +2894,7 @@ int32_t uCellMqttInit(uDeviceHandle_t cellHandle, const char *pBrokerNameStr,
                                 // We only need to  keep hold of the broker string
                                 // if we're using the old SARA-R4 syntax (since
                                 // the keep alive AT command needs it)
-                                uPortFree(pContext->pBrokerNameStr);
+                                uPortFreeTagged(pContext->pBrokerNameStr);
                                 pContext->pBrokerNameStr = NULL;
                             }
 
@@ -2188,6 +2925,19 @@ int32_t uCellMqttInit(uDeviceHandle_t cellHandle, const char *pBrokerNameStr,
                                         pClientIdStr = imei;
                                     }
                                 }
+                                if (mqttSn) {
+                                    // The scope of any MQTT-SN topic cache entries;
+                                    // if there is no client ID the IMEI is as good
+                                    // an identifier of this device as any
+                                    pScopeClientIdStr = pClientIdStr;
+                                    if ((pScopeClientIdStr == NULL) &&
+                                        (uCellPrivateGetImei(pInstance, imei) == 0)) {
+                                        imei[sizeof(imei) - 1] = 0;
+                                        pScopeClientIdStr = imei;
+                                    }
+                                    pContext->snTopicCacheScopeHash = snTopicCacheScopeHash(pBrokerNameStr,
+                                                                                            pScopeClientIdStr);
+                                }
                                 if (pClientIdStr != NULL) {
                                     uAtClientLock(atHandle);
                                     uAtClientCommandStart(atHandle, MQTT_PROFILE_AT_COMMAND_STRING(mqttSn));
@@ -2244,11 +2994,11 @@ int32_t uCellMqttInit(uDeviceHandle_t cellHandle, const char *pBrokerNameStr,
                             //lint -e(605) Suppress complaints about
                             // freeing a volatile pointer as well
                             volatile uCellMqttContext_t *pCtx = (volatile uCellMqttContext_t *)pInstance->pMqttContext;
-                            uPortFree((void *)pCtx->pUrcMessage);
+                            uPortFreeTagged((void *)pCtx->pUrcMessage);
                         }
                         //lint -e(605) Suppress complaints about
                         // freeing this volatile pointer as well
-                        uPortFree((void *)pInstance->pMqttContext);
+                        uPortFreeTagged((void *)pInstance->pMqttContext);
                         pInstance->pMqttContext = NULL;
                     }
                 }
@@ -2271,18 +3021,20 @@ void uCellMqttDeinit(uDeviceHandle_t cellHandle)
 
     if (pInstance != NULL) {
         pContext = (volatile uCellMqttContext_t *) pInstance->pMqttContext;
+        publishAsyncStop(pContext);
+        autoFetchStop(pInstance, pContext);
         if (pContext->connected) {
             (void)connect(pInstance, false);
         }
 
         uAtClientRemoveUrcHandler(pInstance->atHandle, "+UUMQTT");
-        uPortFree(pContext->pBrokerNameStr);
+        uPortFreeTagged(pContext->pBrokerNameStr);
         //lint -e(605) Suppress complaints about
         // freeing a volatile pointer as well
-        uPortFree((void *)pContext->pUrcMessage);
+        uPortFreeTagged((void *)pContext->pUrcMessage);
         //lint -e(605) Suppress complaints about
         // freeing this volatile pointer as well
-        uPortFree((void *)pContext);
+        uPortFreeTagged((void *)pContext);
         pInstance->pMqttContext = NULL;
     }
 
@@ -2589,8 +3341,11 @@ bool uCellMqttIsRetained(uDeviceHandle_t cellHandle)
                 uAtClientSkipParameters(atHandle, 1);
                 isRetained = uAtClientReadInt(atHandle) == 0;
                 uAtClientResponseStop(atHandle);
-                uAtClientUnlock(atHandle);
+                if (uAtClientUnlock(atHandle) != 0) {
+                    isRetained = false;
+                }
             }
+            pContext->sessionRetained = isRetained;
         }
     }
 
@@ -2670,7 +3425,8 @@ int32_t uCellMqttSetWill(uDeviceHandle_t cellHandle,
                     // For MQTT we can do it in hex, so allocate space
                     // to encode the hex version of the message
                     errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-                    pHexMessage = (char *) pUPortMalloc((messageSizeBytes * 2) + 1);
+                    pHexMessage = (char *) pUPortMallocTagged(U_PORT_HEAP_TAG_CELL_MQTT,
+                                                              (messageSizeBytes * 2) + 1);
                     if (pHexMessage != NULL) {
                         // Convert to hex
                         uBinToHex(pMessage, messageSizeBytes, pHexMessage);
@@ -2730,7 +3486,7 @@ int32_t uCellMqttSetWill(uDeviceHandle_t cellHandle,
                     errorCode = atMqttStopCmdGetRespAndUnlock(pInstance);
                 }
                 // Free memory
-                uPortFree(pHexMessage);
+                uPortFreeTagged(pHexMessage);
             }
         }
     }
@@ -2777,7 +3533,9 @@ int32_t uCellMqttGetWill(uDeviceHandle_t cellHandle, char *pTopicNameStr,
                     // in, since it may be larger than the user has
                     // asked for and we have to read in the lot
                     errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-                    pBuffer = (char *) pUPortMalloc(U_CELL_MQTT_READ_TOPIC_MAX_LENGTH_BYTES + 1);
+                    pBuffer = (char *) pUPortMallocTagged(
+                              U_PORT_HEAP_TAG_CELL_MQTT,
+                              U_CELL_MQTT_READ_TOPIC_MAX_LENGTH_BYTES + 1);
                     if (pBuffer != NULL) {
                         // Get the "will" topic name string
                         uAtClientLock(atHandle);
@@ -2805,7 +3563,7 @@ int32_t uCellMqttGetWill(uDeviceHandle_t cellHandle, char *pTopicNameStr,
                             }
                         }
                         // Free memory.
-                        uPortFree(pBuffer);
+                        uPortFreeTagged(pBuffer);
                     }
                 }
                 if ((errorCode == 0) && (pMessage != NULL)) {
@@ -3152,6 +3910,221 @@ int32_t uCellMqttPublish(uDeviceHandle_t cellHandle,
     return errorCode;
 }
 
+// Publish an MQTT message without waiting for it to complete.
+int32_t uCellMqttPublishAsync(uDeviceHandle_t cellHandle,
+                              const char *pTopicNameStr,
+                              const char *pMessage,
+                              size_t messageSizeBytes,
+                              uCellMqttQos_t qos, bool retain,
+                              void (*pCallback) (uDeviceHandle_t cellHandle,
+                                                 int32_t msgId,
+                                                 int32_t errorCode,
+                                                 void *pCallbackParam),
+                              void *pCallbackParam)
+{
+    int32_t errorCodeOrMsgId = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance = NULL;
+    volatile uCellMqttContext_t *pContext;
+    uCellMqttPublishAsync_t *pPublish;
+    size_t topicNameSizeBytes;
+
+    U_CELL_MQTT_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCodeOrMsgId, true);
+
+    if ((errorCodeOrMsgId == 0) && (pInstance != NULL)) {
+        errorCodeOrMsgId = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+        pContext = (volatile uCellMqttContext_t *) pInstance->pMqttContext;
+        if (U_CELL_PRIVATE_HAS(pInstance->pModule,
+                               U_CELL_PRIVATE_FEATURE_MQTT) &&
+            !pContext->mqttSn) {
+            errorCodeOrMsgId = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            // Only the basics are checked here, publish() checks
+            // the rest and any failure is reported to the callback
+            //lint -e(568) Suppress value never being negative, who knows
+            // what warnings levels a customer might compile with
+            if (((int32_t) qos >= 0) && (qos < U_CELL_MQTT_QOS_MAX_NUM) &&
+                (pTopicNameStr != NULL) &&
+                (strlen(pTopicNameStr) <= U_CELL_MQTT_WRITE_TOPIC_MAX_LENGTH_BYTES) &&
+                (pMessage != NULL) &&
+                (messageSizeBytes <= U_CELL_MQTT_PUBLISH_BIN_MAX_LENGTH_BYTES)) {
+                // This is the back-pressure: the caller should try again
+                // once one of its callbacks has been called
+                errorCodeOrMsgId = (int32_t) U_ERROR_COMMON_TEMPORARY_FAILURE;
+                if (pContext->publishAsyncNumPending < U_CELL_MQTT_PUBLISH_ASYNC_QUEUE_LENGTH) {
+                    errorCodeOrMsgId = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    if (pContext->publishAsyncQueue == NULL) {
+                        errorCodeOrMsgId = publishAsyncStart(pContext);
+                    }
+                    if (errorCodeOrMsgId == 0) {
+                        errorCodeOrMsgId = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                        topicNameSizeBytes = strlen(pTopicNameStr) + 1;
+                        pPublish = (uCellMqttPublishAsync_t *) pUPortMallocTagged(
+                                   U_PORT_HEAP_TAG_CELL_MQTT,
+                                   sizeof(*pPublish) + topicNameSizeBytes + messageSizeBytes);
+                        if (pPublish != NULL) {
+                            pPublish->cellHandle = cellHandle;
+                            pPublish->msgId = pContext->publishAsyncNextMsgId;
+                            pPublish->pTopicNameStr = ((char *) pPublish) + sizeof(*pPublish);
+                            memcpy(pPublish->pTopicNameStr, pTopicNameStr, topicNameSizeBytes);
+                            pPublish->pMessage = pPublish->pTopicNameStr + topicNameSizeBytes;
+                            memcpy(pPublish->pMessage, pMessage, messageSizeBytes);
+                            pPublish->messageSizeBytes = messageSizeBytes;
+                            pPublish->qos = qos;
+                            pPublish->retain = retain;
+                            pPublish->pCallback = pCallback;
+                            pPublish->pCallbackParam = pCallbackParam;
+                            // This won't block since publishAsyncNumPending
+                            // is less than the length of the queue
+                            errorCodeOrMsgId = uPortQueueSend(pContext->publishAsyncQueue,
+                                                              &pPublish);
+                            if (errorCodeOrMsgId == 0) {
+                                errorCodeOrMsgId = pPublish->msgId;
+                                pContext->publishAsyncNumPending++;
+                                pContext->publishAsyncNextMsgId++;
+                                if (pContext->publishAsyncNextMsgId < 0) {
+                                    // Wrap
+                                    pContext->publishAsyncNextMsgId = 0;
+                                }
+                            } else {
+                                uPortFreeTagged(pPublish);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    U_CELL_MQTT_EXIT_FUNCTION();
+
+    return errorCodeOrMsgId;
+}
+
+// Get the number of free entries in the asynchronous publish queue.
+int32_t uCellMqttPublishAsyncGetFree(uDeviceHandle_t cellHandle)
+{
+    int32_t errorCodeOrFree = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance = NULL;
+    volatile uCellMqttContext_t *pContext;
+
+    U_CELL_MQTT_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCodeOrFree, true);
+
+    if ((errorCodeOrFree == 0) && (pInstance != NULL)) {
+        pContext = (volatile uCellMqttContext_t *) pInstance->pMqttContext;
+        errorCodeOrFree = (int32_t) (U_CELL_MQTT_PUBLISH_ASYNC_QUEUE_LENGTH -
+                                     pContext->publishAsyncNumPending);
+    }
+
+    U_CELL_MQTT_EXIT_FUNCTION();
+
+    return errorCodeOrFree;
+}
+
+// Set the publish window.
+int32_t uCellMqttSetPublishWindow(uDeviceHandle_t cellHandle, size_t windowSize)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance = NULL;
+    volatile uCellMqttContext_t *pContext;
+
+    U_CELL_MQTT_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCode, true);
+
+    if ((errorCode == 0) && (pInstance != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pContext = (volatile uCellMqttContext_t *) pInstance->pMqttContext;
+        if ((windowSize > 0) && (windowSize <= U_CELL_MQTT_PUBLISH_WINDOW_MAX_NUM)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            // With the old SARA-R4 syntax there is no URC to
+            // carry the outcome of a publish, so no window
+            if ((windowSize == 1) ||
+                (!pContext->mqttSn &&
+                 !U_CELL_PRIVATE_HAS(pInstance->pModule,
+                                     U_CELL_PRIVATE_FEATURE_MQTT_SARA_R4_OLD_SYNTAX))) {
+                pContext->publishWindow = windowSize;
+                pContext->publishWindowLimit = windowSize;
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+    }
+
+    U_CELL_MQTT_EXIT_FUNCTION();
+
+    return errorCode;
+}
+
+// Get the publish window.
+int32_t uCellMqttGetPublishWindow(uDeviceHandle_t cellHandle)
+{
+    int32_t errorCodeOrWindow = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance = NULL;
+    volatile uCellMqttContext_t *pContext;
+
+    U_CELL_MQTT_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCodeOrWindow, true);
+
+    if ((errorCodeOrWindow == 0) && (pInstance != NULL)) {
+        pContext = (volatile uCellMqttContext_t *) pInstance->pMqttContext;
+        errorCodeOrWindow = (int32_t) pContext->publishWindow;
+    }
+
+    U_CELL_MQTT_EXIT_FUNCTION();
+
+    return errorCodeOrWindow;
+}
+
+// Switch auto-fetch on or off.
+int32_t uCellMqttSetAutoFetch(uDeviceHandle_t cellHandle,
+                              size_t numMessages,
+                              uCellMqttAutoFetchCallback_t *pCallback,
+                              void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance = NULL;
+    volatile uCellMqttContext_t *pContext;
+    uCellMqttAutoFetch_t *pAutoFetch;
+
+    U_CELL_MQTT_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCode, true);
+
+    if ((errorCode == 0) && (pInstance != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pContext = (volatile uCellMqttContext_t *) pInstance->pMqttContext;
+        if ((numMessages == 0) ||
+            ((numMessages <= U_CELL_MQTT_AUTO_FETCH_MAX_NUM) && (pCallback != NULL))) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (!pContext->mqttSn &&
+                !U_CELL_PRIVATE_HAS(pInstance->pModule,
+                                    U_CELL_PRIVATE_FEATURE_MQTT_SARA_R4_OLD_SYNTAX)) {
+                // Out with the old
+                autoFetchStop(pInstance, pContext);
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                if (numMessages > 0) {
+                    errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                    pAutoFetch = (uCellMqttAutoFetch_t *) pUPortMallocTagged(U_PORT_HEAP_TAG_CELL_MQTT,
+                                                                             sizeof(*pAutoFetch) +
+                                                                             (numMessages *
+                                                                              sizeof(uCellMqttAutoFetchEntry_t)));
+                    if (pAutoFetch != NULL) {
+                        memset(pAutoFetch, 0, sizeof(*pAutoFetch));
+                        pAutoFetch->pInstance = pInstance;
+                        pAutoFetch->pCallback = pCallback;
+                        pAutoFetch->pCallbackParam = pCallbackParam;
+                        pAutoFetch->pEntry = (uCellMqttAutoFetchEntry_t *) (pAutoFetch + 1);
+                        pAutoFetch->numEntries = numMessages;
+                        uAtClientLock(pInstance->atHandle);
+                        pContext->pAutoFetch = pAutoFetch;
+                        // Fetch anything that is already waiting
+                        autoFetchPost(pInstance->atHandle, pContext);
+                        uAtClientUnlock(pInstance->atHandle);
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    }
+                }
+            }
+        }
+    }
+
+    U_CELL_MQTT_EXIT_FUNCTION();
+
+    return errorCode;
+}
+
 // Subscribe to an MQTT topic.
 int32_t uCellMqttSubscribe(uDeviceHandle_t cellHandle,
                            const char *pTopicFilterStr,
@@ -3263,6 +4236,9 @@ int32_t uCellMqttSnRegisterNormalTopic(uDeviceHandle_t cellHandle,
     uAtClientHandle_t atHandle;
     int32_t startTimeMs;
     size_t tryCount = 0;
+#if U_CELL_MQTT_SN_TOPIC_CACHE_MAX_NUM > 0
+    const uCellMqttSnTopicCacheEntry_t *pCacheEntry;
+#endif
 
     U_CELL_MQTT_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCode, true);
 
@@ -3277,8 +4253,21 @@ int32_t uCellMqttSnRegisterNormalTopic(uDeviceHandle_t cellHandle,
             if ((pTopicNameStr != NULL) && (pTopicName != NULL)) {
                 errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
                 atHandle = pInstance->atHandle;
+#if U_CELL_MQTT_SN_TOPIC_CACHE_MAX_NUM > 0
+                if (pContext->sessionRetained) {
+                    pCacheEntry = pSnTopicCacheFind(pContext->snTopicCacheScopeHash,
+                                                    pTopicNameStr);
+                    if (pCacheEntry != NULL) {
+                        // The gateway still has it from a previous session
+                        pTopicName->name.id = pCacheEntry->topicId;
+                        pTopicName->type = U_CELL_MQTT_SN_TOPIC_NAME_TYPE_ID_NORMAL;
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    }
+                }
+#endif
                 // We retry this if the failure was due to radio conditions
-                do {
+                while ((errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) &&
+                       (tryCount < pContext->numTries)) {
                     uAtClientLock(atHandle);
                     pUrcStatus->flagsBitmap = 0;
                     // Don't need to worry about the MQTT form of the AT
@@ -3303,11 +4292,20 @@ int32_t uCellMqttSnRegisterNormalTopic(uDeviceHandle_t cellHandle,
                             pTopicName->name.id = (uint16_t) pUrcStatus->topicId;
                             pTopicName->type = U_CELL_MQTT_SN_TOPIC_NAME_TYPE_ID_NORMAL;
                             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+#if U_CELL_MQTT_SN_TOPIC_CACHE_MAX_NUM > 0
+                            if (pContext->sessionRetained) {
+                                snTopicCacheAdd(pContext->snTopicCacheScopeHash,
+                                                pTopicNameStr, pTopicName->name.id);
+                            }
+#endif
                         }
                     }
                     tryCount++;
-                } while ((errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) &&
-                         (tryCount < pContext->numTries) && mqttRetry(pInstance, true));
+                    if ((errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) &&
+                        (tryCount < pContext->numTries) && !mqttRetry(pInstance, true)) {
+                        break;
+                    }
+                }
 
                 if (errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) {
                     printErrorCodes(pInstance);
@@ -3321,6 +4319,35 @@ int32_t uCellMqttSnRegisterNormalTopic(uDeviceHandle_t cellHandle,
     return errorCode;
 }
 
+// Forget the cached MQTT-SN topic IDs of this session's scope.
+int32_t uCellMqttSnTopicCacheClear(uDeviceHandle_t cellHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance = NULL;
+    volatile uCellMqttContext_t *pContext;
+
+    U_CELL_MQTT_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCode, true);
+
+    if ((errorCode == 0) && (pInstance != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+        pContext = (volatile uCellMqttContext_t *) pInstance->pMqttContext;
+        if (pContext->mqttSn) {
+#if U_CELL_MQTT_SN_TOPIC_CACHE_MAX_NUM > 0
+            for (size_t x = 0; x < U_CELL_MQTT_SN_TOPIC_CACHE_MAX_NUM; x++) {
+                if (gSnTopicCache[x].scopeHash == pContext->snTopicCacheScopeHash) {
+                    gSnTopicCache[x].lastUsed = 0;
+                }
+            }
+#endif
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    U_CELL_MQTT_EXIT_FUNCTION();
+
+    return errorCode;
+}
+
 // Publish a message.
 int32_t uCellMqttSnPublish(uDeviceHandle_t cellHandle,
                            const uCellMqttSnTopicName_t *pTopicName,
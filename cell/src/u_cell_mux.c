@@ -0,0 +1,1543 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the 3GPP TS 27.010 multiplexer (CMUX,
+ * basic option) for cellular.
+ *
+ * The UART event task of the physical UART runs the frame
+ * decoder, which writes the payload of each data frame straight
+ * into the receive buffer of the channel it is for; the frame is
+ * only committed to that buffer once its FCS and closing flag
+ * have checked out.  Each channel that has a callback has an event
+ * queue of its own, so that a blocking callback (e.g. the URC
+ * handling of the AT client) on one channel does not hold up
+ * another.
+ *
+ * gMutex protects the channel table, the decoder and the receive
+ * buffers; each multiplexer also has a transmit mutex which keeps
+ * the frames written to the UART whole.  Where both are required
+ * gMutex is taken first.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcpy(), memset()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_heap.h"
+#include "u_port_os.h"
+#include "u_port_uart.h"
+#include "u_port_event_queue.h"
+
+#include "u_at_client.h"
+
+#include "u_cell_module_type.h"
+#include "u_cell_file.h"
+#include "u_cell.h"         // For some error codes
+#include "u_cell_net.h"     // Order is important here
+#include "u_cell_private.h" // don't change it
+#include "u_cell_mux.h"
+#include "u_cell_mux_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_CELL_MUX_TASK_STACK_SIZE_BYTES
+/** The stack size of the UART event task which runs the
+ * multiplexer frame decoder.
+ */
+# define U_CELL_MUX_TASK_STACK_SIZE_BYTES U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES
+#endif
+
+#ifndef U_CELL_MUX_TASK_PRIORITY
+/** The priority of the UART event task which runs the
+ * multiplexer frame decoder.
+ */
+# define U_CELL_MUX_TASK_PRIORITY U_AT_CLIENT_URC_TASK_PRIORITY
+#endif
+
+/** The length of the event queue of each channel: there is never
+ * more than one event waiting, see eventSend(), but one may be
+ * queued while another is being handled.
+ */
+#define U_CELL_MUX_EVENT_QUEUE_LENGTH 2
+
+/** The number of bytes read from the UART at a time.
+ */
+#define U_CELL_MUX_RX_CHUNK_LENGTH_BYTES 64
+
+/** The maximum length of the information field of a frame
+ * on the control channel that we keep; control messages are
+ * short.
+ */
+#define U_CELL_MUX_CONTROL_INFO_LENGTH_BYTES 16
+
+/** The number of times to try opening a channel.
+ */
+#define U_CELL_MUX_CHANNEL_OPEN_TRIES 3
+
+/** The opening and closing flag of a frame.
+ */
+#define U_CELL_MUX_FLAG 0xF9
+
+/** The extension bit of the address and length fields and of
+ * the type and length fields of a control message.
+ */
+#define U_CELL_MUX_EA 0x01
+
+/** The command/response bit of the address field and of the type
+ * field of a control message.
+ */
+#define U_CELL_MUX_CR 0x02
+
+/** The poll/final bit of the control field.
+ */
+#define U_CELL_MUX_PF 0x10
+
+/** Frame types, in the control field, without the P/F bit.
+ */
+#define U_CELL_MUX_FRAME_TYPE_SABM 0x2F
+#define U_CELL_MUX_FRAME_TYPE_UA   0x63
+#define U_CELL_MUX_FRAME_TYPE_DM   0x0F
+#define U_CELL_MUX_FRAME_TYPE_DISC 0x43
+#define U_CELL_MUX_FRAME_TYPE_UIH  0xEF
+
+/** Control message types, including the EA bit but without the
+ * C/R bit.
+ */
+#define U_CELL_MUX_MSG_TYPE_CLD   0xC1
+#define U_CELL_MUX_MSG_TYPE_TEST  0x21
+#define U_CELL_MUX_MSG_TYPE_FCON  0xA1
+#define U_CELL_MUX_MSG_TYPE_FCOFF 0x61
+#define U_CELL_MUX_MSG_TYPE_MSC   0xE1
+#define U_CELL_MUX_MSG_TYPE_NSC   0x11
+
+/** The flow control bit of the V.24 signals of an MSC message.
+ */
+#define U_CELL_MUX_MSC_FC 0x02
+
+/** The V.24 signals we send in an MSC message: EA, RTC and RTR.
+ */
+#define U_CELL_MUX_MSC_SIGNALS 0x0D
+
+/** The FCS of a frame, including the received FCS, is this if
+ * the frame is good.
+ */
+#define U_CELL_MUX_FCS_GOOD 0xCF
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The states of a channel.
+ */
+typedef enum {
+    U_CELL_MUX_CHANNEL_STATE_CLOSED,
+    U_CELL_MUX_CHANNEL_STATE_OPENING,
+    U_CELL_MUX_CHANNEL_STATE_OPEN,
+    U_CELL_MUX_CHANNEL_STATE_CLOSING,
+    U_CELL_MUX_CHANNEL_STATE_REFUSED
+} uCellMuxChannelState_t;
+
+/** The states of the frame decoder.
+ */
+typedef enum {
+    U_CELL_MUX_DECODER_STATE_SYNC,
+    U_CELL_MUX_DECODER_STATE_ADDRESS,
+    U_CELL_MUX_DECODER_STATE_CONTROL,
+    U_CELL_MUX_DECODER_STATE_LENGTH,
+    U_CELL_MUX_DECODER_STATE_LENGTH_2,
+    U_CELL_MUX_DECODER_STATE_INFO_START,
+    U_CELL_MUX_DECODER_STATE_INFO,
+    U_CELL_MUX_DECODER_STATE_FCS,
+    U_CELL_MUX_DECODER_STATE_END
+} uCellMuxDecoderState_t;
+
+struct uCellMuxContext_t;
+
+/** A channel.
+ */
+typedef struct {
+    struct uCellMuxContext_t *pContext;
+    uint8_t dlci;
+    volatile uCellMuxChannelState_t state;
+    char *pRxBuffer; /**< NULL for the control channel. */
+    volatile size_t rxReadIndex;
+    volatile size_t rxWriteIndex; /**< only advanced when a frame is good. */
+    bool rxFlowStopped; /**< true if we have asked the module to stop. */
+    volatile bool txFlowStopped; /**< true if the module has asked us to stop. */
+    void (*pCallback)(int32_t, uint32_t, void *);
+    void *pCallbackParam;
+    int32_t eventQueueHandle;
+    bool eventPending;
+} uCellMuxChannel_t;
+
+/** The context of a multiplexer, hooked into the cellular instance.
+ */
+typedef struct uCellMuxContext_t {
+    int32_t uartHandle;
+    uPortMutexHandle_t txMutex;
+    uCellMuxChannel_t control; /**< the control channel, not in gpChannel[]. */
+    int32_t atStreamHandle;
+    volatile bool txFlowStoppedAll; /**< set by FCoff from the module. */
+    volatile bool closedDown; /**< set when the module responds to CLD. */
+    uCellMuxDecoderState_t decoderState;
+    bool decoderPaused; /**< true if waiting for room in a receive buffer. */
+    uint8_t address;
+    uint8_t controlField;
+    uint8_t fcs;
+    size_t infoLength;
+    size_t infoIndex;
+    uCellMuxChannel_t *pDecoderChannel; /**< where the info field is going. */
+    size_t decoderWriteIndex;
+    char controlInfo[U_CELL_MUX_CONTROL_INFO_LENGTH_BYTES];
+    char rxChunk[U_CELL_MUX_RX_CHUNK_LENGTH_BYTES];
+    size_t rxChunkLength;
+    size_t rxChunkIndex;
+} uCellMuxContext_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Mutex to protect the channel table, the decoders and the
+ * receive buffers.
+ */
+static uPortMutexHandle_t gMutex = NULL;
+
+/** The channels, excluding the control channels, indexed by
+ * stream handle.
+ */
+static uCellMuxChannel_t *gpChannel[U_CELL_MUX_MAX_CHANNELS] = {NULL};
+
+/** The number of multiplexers in existence, so that gMutex can
+ * be deleted when there are none.
+ */
+static size_t gNumContexts = 0;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: FRAMING
+ * -------------------------------------------------------------- */
+
+// Add a byte to an FCS (a reversed CRC-8, polynomial 0x07).
+static uint8_t fcsAdd(uint8_t fcs, uint8_t byte)
+{
+    fcs ^= byte;
+    for (size_t x = 0; x < 8; x++) {
+        if (fcs & 0x01) {
+            fcs = (uint8_t) ((fcs >> 1) ^ 0xE0);
+        } else {
+            fcs >>= 1;
+        }
+    }
+
+    return fcs;
+}
+
+// Write all of a buffer to the UART.
+static bool uartWriteAll(int32_t uartHandle, const char *pData, size_t length)
+{
+    int32_t x = 0;
+
+    while ((length > 0) && (x >= 0)) {
+        x = uPortUartWrite(uartHandle, pData, length);
+        if (x > 0) {
+            pData += x;
+            length -= x;
+        } else {
+            x = -1;
+        }
+    }
+
+    return (length == 0);
+}
+
+// Write a frame: the information field is written straight from
+// pInfo, without being copied.  commandNotResponse sets the C/R
+// bit of the address field as it should be for us, the initiator.
+static int32_t writeFrame(uCellMuxContext_t *pContext, uint8_t dlci,
+                          uint8_t controlField, bool commandNotResponse,
+                          const char *pInfo, size_t length)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    char head[5];
+    char tail[2];
+    size_t headLength = 0;
+    uint8_t fcs = 0xFF;
+
+    if (length <= U_CELL_MUX_MAX_FRAME_INFO_LENGTH_BYTES) {
+        head[headLength++] = (char) U_CELL_MUX_FLAG;
+        head[headLength++] = (char) ((dlci << 2) | U_CELL_MUX_EA |
+                                     (commandNotResponse ? U_CELL_MUX_CR : 0));
+        head[headLength++] = (char) controlField;
+        if (length <= 0x7F) {
+            head[headLength++] = (char) ((length << 1) | U_CELL_MUX_EA);
+        } else {
+            head[headLength++] = (char) ((length & 0x7F) << 1);
+            head[headLength++] = (char) (length >> 7);
+        }
+        for (size_t x = 1; x < headLength; x++) {
+            fcs = fcsAdd(fcs, (uint8_t) head[x]);
+        }
+        if ((controlField & ~U_CELL_MUX_PF) != U_CELL_MUX_FRAME_TYPE_UIH) {
+            // For all but UIH frames the FCS covers the information field
+            for (size_t x = 0; x < length; x++) {
+                fcs = fcsAdd(fcs, (uint8_t) *(pInfo + x));
+            }
+        }
+        tail[0] = (char) (0xFF - fcs);
+        tail[1] = (char) U_CELL_MUX_FLAG;
+
+        errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+        U_PORT_MUTEX_LOCK(pContext->txMutex);
+        if (uartWriteAll(pContext->uartHandle, head, headLength) &&
+            ((length == 0) || uartWriteAll(pContext->uartHandle, pInfo, length)) &&
+            uartWriteAll(pContext->uartHandle, tail, sizeof(tail))) {
+            errorCode = (int32_t) length;
+        }
+        U_PORT_MUTEX_UNLOCK(pContext->txMutex);
+    }
+
+    return errorCode;
+}
+
+// Send a control message on the control channel.
+static int32_t writeControlMessage(uCellMuxContext_t *pContext,
+                                   uint8_t type, bool commandNotResponse,
+                                   const char *pValue, size_t length)
+{
+    char message[U_CELL_MUX_CONTROL_INFO_LENGTH_BYTES];
+
+    if (length > sizeof(message) - 2) {
+        length = sizeof(message) - 2;
+    }
+    message[0] = (char) (type | (commandNotResponse ? U_CELL_MUX_CR : 0));
+    message[1] = (char) ((length << 1) | U_CELL_MUX_EA);
+    memcpy(message + 2, pValue, length);
+
+    return writeFrame(pContext, 0, U_CELL_MUX_FRAME_TYPE_UIH, true,
+                      message, length + 2);
+}
+
+// Send an MSC command for a channel, setting flow control on or off.
+static int32_t writeMsc(uCellMuxContext_t *pContext, uint8_t dlci, bool flowStop)
+{
+    char value[2];
+
+    value[0] = (char) ((dlci << 2) | U_CELL_MUX_CR | U_CELL_MUX_EA);
+    value[1] = (char) (U_CELL_MUX_MSC_SIGNALS | (flowStop ? U_CELL_MUX_MSC_FC : 0));
+
+    return writeControlMessage(pContext, U_CELL_MUX_MSG_TYPE_MSC, true,
+                               value, sizeof(value));
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: CHANNELS
+ * -------------------------------------------------------------- */
+
+// The number of bytes in the receive buffer of a channel.
+static size_t rxUsed(const uCellMuxChannel_t *pChannel)
+{
+    return (pChannel->rxWriteIndex + U_CELL_MUX_CHANNEL_BUFFER_LENGTH_BYTES -
+            pChannel->rxReadIndex) % U_CELL_MUX_CHANNEL_BUFFER_LENGTH_BYTES;
+}
+
+// Get a channel from a stream handle.
+// gMutex must be locked before this is called.
+static uCellMuxChannel_t *pGetChannel(int32_t streamHandle)
+{
+    uCellMuxChannel_t *pChannel = NULL;
+
+    if ((streamHandle >= 0) && (streamHandle < U_CELL_MUX_MAX_CHANNELS)) {
+        pChannel = gpChannel[streamHandle];
+    }
+
+    return pChannel;
+}
+
+// Get a channel of a multiplexer from its DLCI, including the
+// control channel.
+// gMutex must be locked before this is called.
+static uCellMuxChannel_t *pGetChannelDlci(uCellMuxContext_t *pContext,
+                                          uint8_t dlci)
+{
+    uCellMuxChannel_t *pChannel = NULL;
+
+    if (dlci == 0) {
+        pChannel = &(pContext->control);
+    } else {
+        for (size_t x = 0; (x < U_CELL_MUX_MAX_CHANNELS) && (pChannel == NULL); x++) {
+            if ((gpChannel[x] != NULL) && (gpChannel[x]->pContext == pContext) &&
+                (gpChannel[x]->dlci == dlci)) {
+                pChannel = gpChannel[x];
+            }
+        }
+    }
+
+    return pChannel;
+}
+
+// Queue an event for the callback of a channel, if it has one
+// and there isn't one queued already; since there is then never
+// more than one event queued the send cannot block.
+// gMutex must be locked before this is called.
+static int32_t eventSend(uCellMuxChannel_t *pChannel)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t streamHandle;
+
+    if ((pChannel->eventQueueHandle >= 0) && !pChannel->eventPending) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        for (streamHandle = 0; (streamHandle < U_CELL_MUX_MAX_CHANNELS) &&
+             (gpChannel[streamHandle] != pChannel); streamHandle++) {}
+        if (streamHandle < U_CELL_MUX_MAX_CHANNELS) {
+            pChannel->eventPending = true;
+            errorCode = uPortEventQueueSend(pChannel->eventQueueHandle,
+                                            &streamHandle, sizeof(streamHandle));
+            if (errorCode != 0) {
+                pChannel->eventPending = false;
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// The event handler of a channel: calls the callback.
+static void eventHandler(void *pParam, size_t paramLength)
+{
+    int32_t streamHandle = *((int32_t *) pParam);
+    uCellMuxChannel_t *pChannel;
+    void (*pCallback)(int32_t, uint32_t, void *) = NULL;
+    void *pCallbackParam = NULL;
+
+    (void) paramLength;
+
+    U_PORT_MUTEX_LOCK(gMutex);
+    pChannel = pGetChannel(streamHandle);
+    if (pChannel != NULL) {
+        pChannel->eventPending = false;
+        pCallback = pChannel->pCallback;
+        pCallbackParam = pChannel->pCallbackParam;
+    }
+    U_PORT_MUTEX_UNLOCK(gMutex);
+
+    // Call the callback with the mutex unlocked since it
+    // is going to call back into here to read the data
+    if (pCallback != NULL) {
+        pCallback(streamHandle, U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                  pCallbackParam);
+    }
+}
+
+// Ask the module to open or close a channel and wait for it to agree.
+static int32_t channelOpenClose(uCellMuxContext_t *pContext,
+                                uCellMuxChannel_t *pChannel, bool open)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
+    uCellMuxChannelState_t waitingState = U_CELL_MUX_CHANNEL_STATE_CLOSING;
+    uint8_t frameType = U_CELL_MUX_FRAME_TYPE_DISC;
+    int32_t startTimeMs;
+
+    if (open) {
+        waitingState = U_CELL_MUX_CHANNEL_STATE_OPENING;
+        frameType = U_CELL_MUX_FRAME_TYPE_SABM;
+    }
+    for (size_t x = U_CELL_MUX_CHANNEL_OPEN_TRIES;
+         (x > 0) && (errorCode == (int32_t) U_ERROR_COMMON_TIMEOUT); x--) {
+        pChannel->state = waitingState;
+        if (writeFrame(pContext, pChannel->dlci, frameType | U_CELL_MUX_PF,
+                       true, NULL, 0) == 0) {
+            startTimeMs = uPortGetTickTimeMs();
+            while ((pChannel->state == waitingState) &&
+                   (uPortGetTickTimeMs() - startTimeMs <
+                    U_CELL_MUX_CHANNEL_OPEN_TIMEOUT_MS / U_CELL_MUX_CHANNEL_OPEN_TRIES)) {
+                uPortTaskBlock(10);
+            }
+        }
+        if (pChannel->state == U_CELL_MUX_CHANNEL_STATE_REFUSED) {
+            errorCode = (int32_t) U_CELL_ERROR_NOT_FOUND;
+        } else if (pChannel->state != waitingState) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+    if (!open) {
+        // Closed is closed, whatever the module thinks
+        pChannel->state = U_CELL_MUX_CHANNEL_STATE_CLOSED;
+    }
+    if ((errorCode == 0) && open && (pChannel->dlci != 0)) {
+        // Tell the module we're ready to go
+        writeMsc(pContext, pChannel->dlci, false);
+    }
+
+    return errorCode;
+}
+
+// Create a channel, with its receive buffer, and put it in the table.
+static int32_t channelCreate(uCellMuxContext_t *pContext, uint8_t dlci)
+{
+    int32_t errorCodeOrStreamHandle = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    uCellMuxChannel_t *pChannel;
+    int32_t streamHandle;
+
+    U_PORT_MUTEX_LOCK(gMutex);
+
+    for (streamHandle = 0; (streamHandle < U_CELL_MUX_MAX_CHANNELS) &&
+         (gpChannel[streamHandle] != NULL); streamHandle++) {}
+    if (streamHandle < U_CELL_MUX_MAX_CHANNELS) {
+        pChannel = (uCellMuxChannel_t *) pUPortMalloc(sizeof(*pChannel));
+        if (pChannel != NULL) {
+            memset(pChannel, 0, sizeof(*pChannel));
+            pChannel->pRxBuffer = (char *) pUPortMalloc(U_CELL_MUX_CHANNEL_BUFFER_LENGTH_BYTES);
+            if (pChannel->pRxBuffer != NULL) {
+                pChannel->pContext = pContext;
+                pChannel->dlci = dlci;
+                pChannel->eventQueueHandle = -1;
+                gpChannel[streamHandle] = pChannel;
+                errorCodeOrStreamHandle = streamHandle;
+            } else {
+                uPortFree(pChannel);
+            }
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(gMutex);
+
+    return errorCodeOrStreamHandle;
+}
+
+// Remove a channel from the table and free it.
+static void channelFree(int32_t streamHandle)
+{
+    uCellMuxChannel_t *pChannel;
+    int32_t eventQueueHandle = -1;
+
+    U_PORT_MUTEX_LOCK(gMutex);
+
+    pChannel = pGetChannel(streamHandle);
+    if (pChannel != NULL) {
+        gpChannel[streamHandle] = NULL;
+        eventQueueHandle = pChannel->eventQueueHandle;
+    }
+
+    U_PORT_MUTEX_UNLOCK(gMutex);
+
+    if (pChannel != NULL) {
+        // Close any event queue outside the lock since the
+        // event handler locks gMutex
+        if (eventQueueHandle >= 0) {
+            uPortEventQueueClose(eventQueueHandle);
+        }
+        uPortFree(pChannel->pRxBuffer);
+        uPortFree(pChannel);
+    }
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: DECODER
+ * -------------------------------------------------------------- */
+
+// Handle a control message received on the control channel.
+// gMutex must be locked before this is called.
+static void processControlMessage(uCellMuxContext_t *pContext)
+{
+    size_t length = pContext->infoLength;
+    const char *pInfo = pContext->controlInfo;
+    uint8_t type;
+    bool command;
+    size_t valueLength;
+    const char *pValue;
+    uCellMuxChannel_t *pChannel;
+    bool respond = false;
+
+    if (length > sizeof(pContext->controlInfo)) {
+        length = sizeof(pContext->controlInfo);
+    }
+    if (length >= 2) {
+        command = ((*pInfo & U_CELL_MUX_CR) != 0);
+        type = (uint8_t) (*pInfo & ~U_CELL_MUX_CR);
+        valueLength = ((uint8_t) * (pInfo + 1)) >> 1;
+        pValue = pInfo + 2;
+        if (valueLength > length - 2) {
+            valueLength = length - 2;
+        }
+        switch (type) {
+            case U_CELL_MUX_MSG_TYPE_MSC:
+                if (command && (valueLength >= 2)) {
+                    pChannel = pGetChannelDlci(pContext, ((uint8_t) * pValue) >> 2);
+                    if (pChannel != NULL) {
+                        pChannel->txFlowStopped = ((*(pValue + 1) & U_CELL_MUX_MSC_FC) != 0);
+                    }
+                }
+                respond = command;
+                break;
+            case U_CELL_MUX_MSG_TYPE_FCON:
+            case U_CELL_MUX_MSG_TYPE_FCOFF:
+                if (command) {
+                    pContext->txFlowStoppedAll = (type == U_CELL_MUX_MSG_TYPE_FCOFF);
+                }
+                respond = command;
+                break;
+            case U_CELL_MUX_MSG_TYPE_CLD:
+                pContext->closedDown = true;
+                respond = command;
+                break;
+            case U_CELL_MUX_MSG_TYPE_TEST:
+                respond = command;
+                break;
+            case U_CELL_MUX_MSG_TYPE_NSC:
+                break;
+            default:
+                if (command) {
+                    // Tell the module we don't understand
+                    writeControlMessage(pContext, U_CELL_MUX_MSG_TYPE_NSC, false,
+                                        pInfo, 1);
+                }
+                break;
+        }
+        if (respond) {
+            // The response is the command with C/R cleared
+            writeControlMessage(pContext, type, false, pValue, valueLength);
+        }
+    }
+}
+
+// Handle a good frame.
+// gMutex must be locked before this is called.
+static void processFrame(uCellMuxContext_t *pContext)
+{
+    uint8_t dlci = pContext->address >> 2;
+    uint8_t frameType = (uint8_t) (pContext->controlField & ~U_CELL_MUX_PF);
+    uCellMuxChannel_t *pChannel = pGetChannelDlci(pContext, dlci);
+
+    switch (frameType) {
+        case U_CELL_MUX_FRAME_TYPE_UIH:
+            if (dlci == 0) {
+                processControlMessage(pContext);
+            } else if (pContext->pDecoderChannel != NULL) {
+                pChannel = pContext->pDecoderChannel;
+                // Commit the data and let the reader know
+                pChannel->rxWriteIndex = pContext->decoderWriteIndex;
+                eventSend(pChannel);
+                if (!pChannel->rxFlowStopped &&
+                    (rxUsed(pChannel) > (U_CELL_MUX_CHANNEL_BUFFER_LENGTH_BYTES * 3) / 4)) {
+                    // Getting full, ask the module to hold off
+                    pChannel->rxFlowStopped = true;
+                    writeMsc(pContext, dlci, true);
+                }
+            }
+            break;
+        case U_CELL_MUX_FRAME_TYPE_UA:
+            if (pChannel != NULL) {
+                if (pChannel->state == U_CELL_MUX_CHANNEL_STATE_OPENING) {
+                    pChannel->state = U_CELL_MUX_CHANNEL_STATE_OPEN;
+                } else if (pChannel->state == U_CELL_MUX_CHANNEL_STATE_CLOSING) {
+                    pChannel->state = U_CELL_MUX_CHANNEL_STATE_CLOSED;
+                }
+            }
+            break;
+        case U_CELL_MUX_FRAME_TYPE_DM:
+            if (pChannel != NULL) {
+                if (pChannel->state == U_CELL_MUX_CHANNEL_STATE_OPENING) {
+                    pChannel->state = U_CELL_MUX_CHANNEL_STATE_REFUSED;
+                } else {
+                    pChannel->state = U_CELL_MUX_CHANNEL_STATE_CLOSED;
+                }
+            }
+            break;
+        case U_CELL_MUX_FRAME_TYPE_DISC:
+            writeFrame(pContext, dlci, U_CELL_MUX_FRAME_TYPE_UA | U_CELL_MUX_PF,
+                       false, NULL, 0);
+            if (pChannel != NULL) {
+                pChannel->state = U_CELL_MUX_CHANNEL_STATE_CLOSED;
+            }
+            break;
+        case U_CELL_MUX_FRAME_TYPE_SABM:
+            // We are the initiator, the module doesn't get to open channels
+            writeFrame(pContext, dlci, U_CELL_MUX_FRAME_TYPE_DM | U_CELL_MUX_PF,
+                       false, NULL, 0);
+            break;
+        default:
+            break;
+    }
+
+    pContext->pDecoderChannel = NULL;
+}
+
+// Work out where the information field of the frame being decoded
+// is to go, returning the next decoder state; if the receive buffer
+// it is destined for is too full the decoder is paused.
+// gMutex must be locked before this is called.
+static uCellMuxDecoderState_t infoStart(uCellMuxContext_t *pContext)
+{
+    uCellMuxDecoderState_t nextState = U_CELL_MUX_DECODER_STATE_INFO;
+    uint8_t dlci = pContext->address >> 2;
+    uCellMuxChannel_t *pChannel;
+
+    pContext->pDecoderChannel = NULL;
+    pContext->infoIndex = 0;
+    if (((pContext->controlField & ~U_CELL_MUX_PF) == U_CELL_MUX_FRAME_TYPE_UIH) &&
+        (dlci != 0)) {
+        pChannel = pGetChannelDlci(pContext, dlci);
+        if ((pChannel != NULL) && (pChannel->pRxBuffer != NULL)) {
+            if (pContext->infoLength >= U_CELL_MUX_CHANNEL_BUFFER_LENGTH_BYTES) {
+                // Can never fit: drop it
+                nextState = U_CELL_MUX_DECODER_STATE_SYNC;
+            } else if (U_CELL_MUX_CHANNEL_BUFFER_LENGTH_BYTES - 1 - rxUsed(pChannel) <
+                       pContext->infoLength) {
+                // Wait for the reader to make room
+                pContext->decoderPaused = true;
+                nextState = U_CELL_MUX_DECODER_STATE_INFO_START;
+            } else {
+                pContext->pDecoderChannel = pChannel;
+                pContext->decoderWriteIndex = pChannel->rxWriteIndex;
+            }
+        }
+    }
+    if ((nextState == U_CELL_MUX_DECODER_STATE_INFO) &&
+        (pContext->infoLength == 0)) {
+        nextState = U_CELL_MUX_DECODER_STATE_FCS;
+    }
+
+    return nextState;
+}
+
+// Decode received bytes, returning the number consumed.
+// gMutex must be locked before this is called.
+static size_t decode(uCellMuxContext_t *pContext, const char *pData,
+                     size_t length)
+{
+    size_t consumed = 1;
+    uint8_t byte = (uint8_t) *pData;
+    uCellMuxChannel_t *pChannel;
+    size_t x;
+
+    switch (pContext->decoderState) {
+        case U_CELL_MUX_DECODER_STATE_SYNC:
+            if (byte == U_CELL_MUX_FLAG) {
+                pContext->decoderState = U_CELL_MUX_DECODER_STATE_ADDRESS;
+            }
+            break;
+        case U_CELL_MUX_DECODER_STATE_ADDRESS:
+            // Ignore repeated flags
+            if (byte != U_CELL_MUX_FLAG) {
+                pContext->decoderState = U_CELL_MUX_DECODER_STATE_SYNC;
+                if (byte & U_CELL_MUX_EA) {
+                    pContext->address = byte;
+                    pContext->fcs = fcsAdd(0xFF, byte);
+                    pContext->decoderState = U_CELL_MUX_DECODER_STATE_CONTROL;
+                }
+            }
+            break;
+        case U_CELL_MUX_DECODER_STATE_CONTROL:
+            pContext->controlField = byte;
+            pContext->fcs = fcsAdd(pContext->fcs, byte);
+            pContext->decoderState = U_CELL_MUX_DECODER_STATE_LENGTH;
+            break;
+        case U_CELL_MUX_DECODER_STATE_LENGTH:
+            pContext->infoLength = byte >> 1;
+            pContext->fcs = fcsAdd(pContext->fcs, byte);
+            pContext->decoderState = U_CELL_MUX_DECODER_STATE_LENGTH_2;
+            if (byte & U_CELL_MUX_EA) {
+                pContext->decoderState = U_CELL_MUX_DECODER_STATE_INFO_START;
+            }
+            break;
+        case U_CELL_MUX_DECODER_STATE_LENGTH_2:
+            pContext->infoLength |= ((size_t) byte) << 7;
+            pContext->fcs = fcsAdd(pContext->fcs, byte);
+            pContext->decoderState = U_CELL_MUX_DECODER_STATE_INFO_START;
+            break;
+        case U_CELL_MUX_DECODER_STATE_INFO_START:
+            // Doesn't consume anything
+            consumed = 0;
+            pContext->decoderState = infoStart(pContext);
+            break;
+        case U_CELL_MUX_DECODER_STATE_INFO:
+            pChannel = pContext->pDecoderChannel;
+            if (pChannel != NULL) {
+                // Copy as much as we can straight into the receive buffer
+                consumed = pContext->infoLength - pContext->infoIndex;
+                if (consumed > length) {
+                    consumed = length;
+                }
+                x = U_CELL_MUX_CHANNEL_BUFFER_LENGTH_BYTES - pContext->decoderWriteIndex;
+                if (consumed > x) {
+                    consumed = x;
+                }
+                memcpy(pChannel->pRxBuffer + pContext->decoderWriteIndex, pData, consumed);
+                pContext->decoderWriteIndex = (pContext->decoderWriteIndex + consumed) %
+                                              U_CELL_MUX_CHANNEL_BUFFER_LENGTH_BYTES;
+            } else {
+                if (pContext->infoIndex < sizeof(pContext->controlInfo)) {
+                    pContext->controlInfo[pContext->infoIndex] = (char) byte;
+                }
+                if ((pContext->controlField & ~U_CELL_MUX_PF) != U_CELL_MUX_FRAME_TYPE_UIH) {
+                    pContext->fcs = fcsAdd(pContext->fcs, byte);
+                }
+            }
+            pContext->infoIndex += consumed;
+            if (pContext->infoIndex >= pContext->infoLength) {
+                pContext->decoderState = U_CELL_MUX_DECODER_STATE_FCS;
+            }
+            break;
+        case U_CELL_MUX_DECODER_STATE_FCS:
+            pContext->fcs = fcsAdd(pContext->fcs, byte);
+            pContext->decoderState = U_CELL_MUX_DECODER_STATE_END;
+            break;
+        case U_CELL_MUX_DECODER_STATE_END:
+            pContext->decoderState = U_CELL_MUX_DECODER_STATE_SYNC;
+            if (byte == U_CELL_MUX_FLAG) {
+                if (pContext->fcs == U_CELL_MUX_FCS_GOOD) {
+                    processFrame(pContext);
+                }
+                // The closing flag may also be the opening flag
+                // of the next frame
+                pContext->decoderState = U_CELL_MUX_DECODER_STATE_ADDRESS;
+            }
+            pContext->pDecoderChannel = NULL;
+            break;
+        default:
+            pContext->decoderState = U_CELL_MUX_DECODER_STATE_SYNC;
+            break;
+    }
+
+    return consumed;
+}
+
+// Callback for data received on the UART, runs the decoder.
+static void uartCallback(int32_t uartHandle, uint32_t eventBitmask,
+                         void *pParameters)
+{
+    uCellMuxContext_t *pContext = (uCellMuxContext_t *) pParameters;
+    bool uartEmpty = false;
+    const char *pSpan = NULL;
+    size_t spanIndex;
+    int32_t x;
+
+    if ((pContext != NULL) && (pContext->uartHandle == uartHandle) &&
+        (eventBitmask & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED)) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        while (!uartEmpty && !pContext->decoderPaused) {
+            if (pContext->rxChunkIndex >= pContext->rxChunkLength) {
+                // Where the platform supports it, decode straight out
+                // of the UART receive buffer, consuming only what the
+                // decoder used; anything left over while the decoder
+                // is paused simply stays in the UART buffer
+                x = uPortUartPeekSpan(uartHandle, &pSpan);
+                if (x > 0) {
+                    spanIndex = 0;
+                    while ((spanIndex < (size_t) x) && !pContext->decoderPaused) {
+                        spanIndex += decode(pContext, pSpan + spanIndex,
+                                            (size_t) x - spanIndex);
+                    }
+                    uPortUartConsume(uartHandle, spanIndex);
+                } else if (x == 0) {
+                    uartEmpty = true;
+                } else {
+                    // Not supported: bring in some more by copying;
+                    // anything unconsumed is kept in the chunk while
+                    // the decoder is paused
+                    pContext->rxChunkIndex = 0;
+                    pContext->rxChunkLength = 0;
+                    x = uPortUartRead(uartHandle, pContext->rxChunk,
+                                      sizeof(pContext->rxChunk));
+                    if (x > 0) {
+                        pContext->rxChunkLength = (size_t) x;
+                    } else {
+                        uartEmpty = true;
+                    }
+                }
+            }
+            while ((pContext->rxChunkIndex < pContext->rxChunkLength) &&
+                   !pContext->decoderPaused) {
+                pContext->rxChunkIndex += decode(pContext,
+                                                 pContext->rxChunk + pContext->rxChunkIndex,
+                                                 pContext->rxChunkLength - pContext->rxChunkIndex);
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+}
+
+// Kick the UART event task to get the decoder going again.
+static void decoderResume(const uCellMuxContext_t *pContext)
+{
+    int32_t sendErrorCode;
+
+    // As for the AT client, use the "try" version so as not to
+    // block, falling back to the blocking version if that
+    // is not supported on this platform
+    sendErrorCode = uPortUartEventTrySend(pContext->uartHandle,
+                                          U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                          0);
+    if ((sendErrorCode == (int32_t) U_ERROR_COMMON_NOT_IMPLEMENTED) ||
+        (sendErrorCode == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED)) {
+        uPortUartEventSend(pContext->uartHandle,
+                           U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED);
+    }
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: MISC
+ * -------------------------------------------------------------- */
+
+// Send AT+CMUX over the UART.
+static int32_t sendCmux(const uCellPrivateInstance_t *pInstance)
+{
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+
+    uAtClientLock(atHandle);
+    // Basic option, UIH frames, port speed unchanged,
+    // then our maximum frame size
+    uAtClientCommandStart(atHandle, "AT+CMUX=0,0,,");
+    uAtClientWriteInt(atHandle, U_CELL_MUX_MAX_FRAME_INFO_LENGTH_BYTES);
+    uAtClientCommandStopReadResponse(atHandle);
+    return uAtClientUnlock(atHandle);
+}
+
+// Check that the AT interface is working.
+static int32_t checkAt(const uCellPrivateInstance_t *pInstance)
+{
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+
+    uAtClientLock(atHandle);
+    uAtClientTimeoutSet(atHandle, pInstance->pModule->responseMaxWaitMs);
+    uAtClientCommandStart(atHandle, "AT");
+    uAtClientCommandStopReadResponse(atHandle);
+    return uAtClientUnlock(atHandle);
+}
+
+// Tear down a multiplexer locally, moving the AT client back
+// onto the UART, optionally telling the module to close the
+// multiplexer down first.
+// gUCellPrivateMutex must be locked before this is called.
+static int32_t removeContext(uCellPrivateInstance_t *pInstance,
+                             uCellMuxContext_t *pContext, bool closeDown)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t startTimeMs;
+    int32_t streamHandle;
+    uAtClientStream_t streamType = U_AT_CLIENT_STREAM_TYPE_MAX;
+
+    if (closeDown) {
+        errorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
+        pContext->closedDown = false;
+        if (writeControlMessage(pContext, U_CELL_MUX_MSG_TYPE_CLD,
+                                true, NULL, 0) >= 0) {
+            startTimeMs = uPortGetTickTimeMs();
+            while (!pContext->closedDown &&
+                   (uPortGetTickTimeMs() - startTimeMs < U_CELL_MUX_CHANNEL_OPEN_TIMEOUT_MS)) {
+                uPortTaskBlock(10);
+            }
+        }
+        if (pContext->closedDown) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    // Stop the decoder, then move the AT client back to the UART
+    uPortUartEventCallbackRemove(pContext->uartHandle);
+    streamHandle = uAtClientStreamGet(pInstance->atHandle, &streamType);
+    if ((streamType == U_AT_CLIENT_STREAM_TYPE_CMUX) &&
+        (streamHandle == pContext->atStreamHandle)) {
+        uAtClientStreamSet(pInstance->atHandle, pContext->uartHandle,
+                           U_AT_CLIENT_STREAM_TYPE_UART);
+    }
+
+    // Free all of the channels of this multiplexer
+    for (streamHandle = 0; streamHandle < U_CELL_MUX_MAX_CHANNELS; streamHandle++) {
+        if ((gpChannel[streamHandle] != NULL) &&
+            (gpChannel[streamHandle]->pContext == pContext)) {
+            channelFree(streamHandle);
+        }
+    }
+    uPortMutexDelete(pContext->txMutex);
+    uPortFree(pContext);
+    pInstance->pMuxContext = NULL;
+
+    if (gNumContexts > 0) {
+        gNumContexts--;
+    }
+    if ((gNumContexts == 0) && (gMutex != NULL)) {
+        uPortMutexDelete(gMutex);
+        gMutex = NULL;
+    }
+
+    return errorCode;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS THAT ARE PRIVATE TO CELLULAR
+ * -------------------------------------------------------------- */
+
+// Remove the multiplexer context of a cellular instance.
+void uCellMuxPrivateRemoveContext(uCellPrivateInstance_t *pInstance,
+                                  bool closeDown)
+{
+    if ((pInstance != NULL) && (pInstance->pMuxContext != NULL)) {
+        removeContext(pInstance, (uCellMuxContext_t *) pInstance->pMuxContext,
+                      closeDown);
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: CONTROL
+ * -------------------------------------------------------------- */
+
+// Enable the multiplexer.
+int32_t uCellMuxEnable(uDeviceHandle_t cellHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellMuxContext_t *pContext;
+    int32_t uartHandle;
+    uAtClientStream_t streamType = U_AT_CLIENT_STREAM_TYPE_MAX;
+    bool moduleInMux = false;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pInstance != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            uartHandle = uAtClientStreamGet(pInstance->atHandle, &streamType);
+            if (pInstance->pMuxContext == NULL) {
+                errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+                if ((streamType == U_AT_CLIENT_STREAM_TYPE_UART) &&
+                    !uAtClientWakeUpHandlerIsSet(pInstance->atHandle)) {
+                    errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                    if (gMutex == NULL) {
+                        uPortMutexCreate(&gMutex);
+                    }
+                    pContext = (uCellMuxContext_t *) pUPortMalloc(sizeof(*pContext));
+                    if ((gMutex != NULL) && (pContext != NULL)) {
+                        memset(pContext, 0, sizeof(*pContext));
+                        pContext->uartHandle = uartHandle;
+                        pContext->control.pContext = pContext;
+                        pContext->control.eventQueueHandle = -1;
+                        pContext->decoderState = U_CELL_MUX_DECODER_STATE_SYNC;
+                        pContext->atStreamHandle = -1;
+                        if (uPortMutexCreate(&(pContext->txMutex)) == 0) {
+                            gNumContexts++;
+                            pInstance->pMuxContext = pContext;
+                            pContext->atStreamHandle = channelCreate(pContext,
+                                                                     U_CELL_MUX_CHANNEL_ID_AT);
+                            errorCode = pContext->atStreamHandle;
+                        } else {
+                            uPortFree(pContext);
+                        }
+                    } else {
+                        uPortFree(pContext);
+                    }
+                    if (errorCode >= 0) {
+                        // Tell the module to switch to multiplexer mode
+                        errorCode = sendCmux(pInstance);
+                    }
+                    if (errorCode == 0) {
+                        moduleInMux = true;
+                        // Give the module a moment to switch over
+                        uPortTaskBlock(100);
+                        // Move the AT client onto the AT channel, which
+                        // lets go of the UART, then start the decoder
+                        errorCode = uAtClientStreamSet(pInstance->atHandle,
+                                                       pContext->atStreamHandle,
+                                                       U_AT_CLIENT_STREAM_TYPE_CMUX);
+                        if (errorCode == 0) {
+                            errorCode = uPortUartEventCallbackSet(uartHandle,
+                                                                  U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                                                  uartCallback, pContext,
+                                                                  U_CELL_MUX_TASK_STACK_SIZE_BYTES,
+                                                                  U_CELL_MUX_TASK_PRIORITY);
+                        }
+                    }
+                    if (errorCode == 0) {
+                        // Open the control channel and then the AT channel
+                        errorCode = channelOpenClose(pContext, &(pContext->control), true);
+                        if (errorCode == 0) {
+                            errorCode = channelOpenClose(pContext,
+                                                         gpChannel[pContext->atStreamHandle],
+                                                         true);
+                        }
+                    }
+                    if (errorCode == 0) {
+                        // Check that AT commands get through
+                        errorCode = checkAt(pInstance);
+                    }
+                    if ((errorCode != 0) && (pInstance->pMuxContext != NULL)) {
+                        // Clean up, telling the module to close down
+                        // if it got as far as multiplexer mode
+                        removeContext(pInstance, pContext, moduleInMux);
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Determine whether the multiplexer is enabled.
+bool uCellMuxIsEnabled(uDeviceHandle_t cellHandle)
+{
+    bool isEnabled = false;
+    uCellPrivateInstance_t *pInstance;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        if (pInstance != NULL) {
+            isEnabled = (pInstance->pMuxContext != NULL);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return isEnabled;
+}
+
+// Disable the multiplexer.
+int32_t uCellMuxDisable(uDeviceHandle_t cellHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellMuxContext_t *pContext;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pInstance != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            pContext = (uCellMuxContext_t *) pInstance->pMuxContext;
+            if (pContext != NULL) {
+                // Any channels other than the AT channel must
+                // have been closed by the application
+                for (size_t x = 0; x < U_CELL_MUX_MAX_CHANNELS; x++) {
+                    if ((gpChannel[x] != NULL) && (gpChannel[x]->pContext == pContext) &&
+                        ((int32_t) x != pContext->atStreamHandle)) {
+                        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+                    }
+                }
+                if (errorCode == 0) {
+                    errorCode = removeContext(pInstance, pContext, true);
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Open an additional channel.
+int32_t uCellMuxChannelOpen(uDeviceHandle_t cellHandle, int32_t channel)
+{
+    int32_t errorCodeOrStreamHandle = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellMuxContext_t *pContext;
+    int32_t errorCode;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCodeOrStreamHandle = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pInstance != NULL) && (pInstance->pMuxContext != NULL) &&
+            (channel > 0) && (channel <= 63) &&
+            (channel != U_CELL_MUX_CHANNEL_ID_AT)) {
+            pContext = (uCellMuxContext_t *) pInstance->pMuxContext;
+            U_PORT_MUTEX_LOCK(gMutex);
+            if (pGetChannelDlci(pContext, (uint8_t) channel) == NULL) {
+                errorCodeOrStreamHandle = 0;
+            }
+            U_PORT_MUTEX_UNLOCK(gMutex);
+            if (errorCodeOrStreamHandle == 0) {
+                errorCodeOrStreamHandle = channelCreate(pContext, (uint8_t) channel);
+                if (errorCodeOrStreamHandle >= 0) {
+                    errorCode = channelOpenClose(pContext, gpChannel[errorCodeOrStreamHandle],
+                                                 true);
+                    if (errorCode != 0) {
+                        channelFree(errorCodeOrStreamHandle);
+                        errorCodeOrStreamHandle = errorCode;
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCodeOrStreamHandle;
+}
+
+// Close a channel.
+int32_t uCellMuxChannelClose(uDeviceHandle_t cellHandle,
+                             int32_t streamHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellMuxContext_t *pContext;
+    uCellMuxChannel_t *pChannel = NULL;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pInstance != NULL) && (pInstance->pMuxContext != NULL)) {
+            pContext = (uCellMuxContext_t *) pInstance->pMuxContext;
+            U_PORT_MUTEX_LOCK(gMutex);
+            pChannel = pGetChannel(streamHandle);
+            U_PORT_MUTEX_UNLOCK(gMutex);
+            if ((pChannel != NULL) && (pChannel->pContext == pContext) &&
+                (streamHandle != pContext->atStreamHandle)) {
+                // Free the channel even if the module doesn't respond
+                errorCode = channelOpenClose(pContext, pChannel, false);
+                channelFree(streamHandle);
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: STREAM
+ * -------------------------------------------------------------- */
+
+// Read from a channel.
+int32_t uCellMuxStreamRead(int32_t streamHandle, void *pBuffer,
+                           size_t sizeBytes)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellMuxChannel_t *pChannel;
+    uCellMuxContext_t *pContext = NULL;
+    size_t x;
+    bool flowStart = false;
+    bool resume = false;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pChannel = pGetChannel(streamHandle);
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pChannel != NULL) && (pBuffer != NULL)) {
+            pContext = pChannel->pContext;
+            x = rxUsed(pChannel);
+            if (sizeBytes > x) {
+                sizeBytes = x;
+            }
+            sizeOrErrorCode = (int32_t) sizeBytes;
+            // Copy out in up to two pieces
+            x = U_CELL_MUX_CHANNEL_BUFFER_LENGTH_BYTES - pChannel->rxReadIndex;
+            if (x > sizeBytes) {
+                x = sizeBytes;
+            }
+            memcpy(pBuffer, pChannel->pRxBuffer + pChannel->rxReadIndex, x);
+            memcpy(((char *) pBuffer) + x, pChannel->pRxBuffer, sizeBytes - x);
+            pChannel->rxReadIndex = (pChannel->rxReadIndex + sizeBytes) %
+                                    U_CELL_MUX_CHANNEL_BUFFER_LENGTH_BYTES;
+            if (pChannel->rxFlowStopped &&
+                (rxUsed(pChannel) < U_CELL_MUX_CHANNEL_BUFFER_LENGTH_BYTES / 4)) {
+                pChannel->rxFlowStopped = false;
+                flowStart = true;
+            }
+            if ((sizeBytes > 0) && pContext->decoderPaused) {
+                pContext->decoderPaused = false;
+                resume = true;
+            }
+            if (flowStart) {
+                writeMsc(pContext, pChannel->dlci, false);
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+
+        if (resume) {
+            decoderResume(pContext);
+        }
+    }
+
+    return sizeOrErrorCode;
+}
+
+// Write to a channel.
+int32_t uCellMuxStreamWrite(int32_t streamHandle, const void *pBuffer,
+                            size_t sizeBytes)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellMuxChannel_t *pChannel;
+    uCellMuxContext_t *pContext;
+    uint8_t dlci;
+    const char *pData = (const char *) pBuffer;
+    size_t written = 0;
+    size_t thisLength;
+    int32_t startTimeMs;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pChannel = pGetChannel(streamHandle);
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pChannel != NULL) && (pBuffer != NULL)) {
+            pContext = pChannel->pContext;
+            dlci = pChannel->dlci;
+            sizeOrErrorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+            if (pChannel->state == U_CELL_MUX_CHANNEL_STATE_OPEN) {
+                sizeOrErrorCode = 0;
+                startTimeMs = uPortGetTickTimeMs();
+                while ((written < sizeBytes) && (sizeOrErrorCode >= 0)) {
+                    // The channel must still be the one we started with
+                    sizeOrErrorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+                    if ((pChannel != NULL) && (pChannel->pContext == pContext) &&
+                        (pChannel->dlci == dlci) &&
+                        (pChannel->state == U_CELL_MUX_CHANNEL_STATE_OPEN)) {
+                        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
+                        if (!pChannel->txFlowStopped && !pContext->txFlowStoppedAll) {
+                            thisLength = sizeBytes - written;
+                            if (thisLength > U_CELL_MUX_MAX_FRAME_INFO_LENGTH_BYTES) {
+                                thisLength = U_CELL_MUX_MAX_FRAME_INFO_LENGTH_BYTES;
+                            }
+                            sizeOrErrorCode = writeFrame(pContext, dlci,
+                                                         U_CELL_MUX_FRAME_TYPE_UIH, true,
+                                                         pData + written, thisLength);
+                            if (sizeOrErrorCode > 0) {
+                                written += (size_t) sizeOrErrorCode;
+                                startTimeMs = uPortGetTickTimeMs();
+                            }
+                        } else if (uPortGetTickTimeMs() - startTimeMs <
+                                   U_CELL_MUX_WRITE_TIMEOUT_MS) {
+                            // Wait while the module has us flow-controlled off,
+                            // letting go of gMutex so that the decoder can let
+                            // us go again; the channel may be closed, and freed,
+                            // while we wait, hence it is looked up again after
+                            U_PORT_MUTEX_UNLOCK(gMutex);
+                            uPortTaskBlock(10);
+                            U_PORT_MUTEX_LOCK(gMutex);
+                            pChannel = pGetChannel(streamHandle);
+                            sizeOrErrorCode = 0;
+                        }
+                    }
+                }
+                if (written > 0) {
+                    sizeOrErrorCode = (int32_t) written;
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return sizeOrErrorCode;
+}
+
+// Get the number of bytes waiting to be read from a channel.
+int32_t uCellMuxStreamGetReceiveSize(int32_t streamHandle)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellMuxChannel_t *pChannel;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pChannel = pGetChannel(streamHandle);
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pChannel != NULL) {
+            sizeOrErrorCode = (int32_t) rxUsed(pChannel);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return sizeOrErrorCode;
+}
+
+// Set a data callback for a channel.
+int32_t uCellMuxStreamCallbackSet(int32_t streamHandle,
+                                  void (*pFunction)(int32_t, uint32_t, void *),
+                                  void *pParam,
+                                  size_t stackSizeBytes,
+                                  int32_t priority)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellMuxChannel_t *pChannel;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pChannel = pGetChannel(streamHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pChannel != NULL) && (pFunction != NULL) &&
+            (pChannel->eventQueueHandle < 0)) {
+            errorCode = uPortEventQueueOpen(eventHandler, "cellMux",
+                                            sizeof(int32_t),
+                                            stackSizeBytes, priority,
+                                            U_CELL_MUX_EVENT_QUEUE_LENGTH);
+            if (errorCode >= 0) {
+                pChannel->eventQueueHandle = errorCode;
+                pChannel->pCallback = pFunction;
+                pChannel->pCallbackParam = pParam;
+                pChannel->eventPending = false;
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                if (rxUsed(pChannel) > 0) {
+                    // Let the callback know about anything already there
+                    eventSend(pChannel);
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCode;
+}
+
+// Remove the data callback of a channel.
+void uCellMuxStreamCallbackRemove(int32_t streamHandle)
+{
+    uCellMuxChannel_t *pChannel;
+    int32_t eventQueueHandle = -1;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pChannel = pGetChannel(streamHandle);
+        if (pChannel != NULL) {
+            eventQueueHandle = pChannel->eventQueueHandle;
+            pChannel->eventQueueHandle = -1;
+            pChannel->pCallback = NULL;
+            pChannel->pCallbackParam = NULL;
+            pChannel->eventPending = false;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+
+        // Close the event queue outside the lock since the
+        // event handler locks gMutex
+        if (eventQueueHandle >= 0) {
+            uPortEventQueueClose(eventQueueHandle);
+        }
+    }
+}
+
+// Cause the callback of a channel to be called.
+int32_t uCellMuxStreamEventSend(int32_t streamHandle,
+                                uint32_t eventBitmask)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellMuxChannel_t *pChannel;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pChannel = pGetChannel(streamHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pChannel != NULL) && (pChannel->eventQueueHandle >= 0) &&
+            // The only event we support right now
+            (eventBitmask == U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED)) {
+            errorCode = eventSend(pChannel);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCode;
+}
+
+// Determine whether we're in the callback task of a channel.
+bool uCellMuxStreamEventIsCallback(int32_t streamHandle)
+{
+    bool isEventCallback = false;
+    uCellMuxChannel_t *pChannel;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pChannel = pGetChannel(streamHandle);
+        if ((pChannel != NULL) && (pChannel->eventQueueHandle >= 0)) {
+            isEventCallback = uPortEventQueueIsTask(pChannel->eventQueueHandle);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return isEventCallback;
+}
+
+// Get the minimum free stack of the callback task of a channel.
+int32_t uCellMuxStreamEventStackMinFree(int32_t streamHandle)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellMuxChannel_t *pChannel;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pChannel = pGetChannel(streamHandle);
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pChannel != NULL) && (pChannel->eventQueueHandle >= 0)) {
+            sizeOrErrorCode = uPortEventQueueStackMinFree(pChannel->eventQueueHandle);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return sizeOrErrorCode;
+}
+
+// End of file
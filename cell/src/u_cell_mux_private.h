@@ -0,0 +1,59 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_CELL_MUX_PRIVATE_H_
+#define _U_CELL_MUX_PRIVATE_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** @file
+ * @brief This header file defines the multiplexer function that is
+ * needed in an internal form inside the cellular API, so that the
+ * multiplexer can be torn down when the module is powered off or
+ * rebooted, or the cellular instance is removed.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Remove the multiplexer context of a cellular instance, if there
+ * is one, moving the AT client of the instance back onto the UART.
+ * Note: gUCellPrivateMutex should be locked before this is called.
+ *
+ * @param pInstance  a pointer to the instance.
+ * @param closeDown  if true the module is told to close down the
+ *                   multiplexer first; set this to false if the
+ *                   module has already left multiplexer mode,
+ *                   e.g. because it has been powered off.
+ */
+void uCellMuxPrivateRemoveContext(uCellPrivateInstance_t *pInstance,
+                                  bool closeDown);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_CELL_MUX_PRIVATE_H_
+
+// End of file
@@ -49,6 +49,7 @@
 #include "u_port.h"
 #include "u_port_debug.h"
 #include "u_port_os.h"
+#include "u_task_registry.h"
 
 #include "u_at_client.h"
 
@@ -61,19 +62,16 @@
 #include "u_cell_apn_db.h"
 #include "u_cell_mno_db.h"
 
+#include "u_cell_pwr.h"
 #include "u_cell_pwr_private.h"
+#include "u_cell_sec_private.h"
+#include "u_cell_sock_private.h"
+#include "u_cell_cfg.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
-/** The length of temporary buffer to use when reading network scan
- * results, sufficient to store N of:
- *
- * (stat,long_name,short_name,numeric[,AcT])
- */
-#define U_CELL_NET_SCAN_LENGTH_BYTES (128 * 10)
-
 /** The type of CEREG to request; 4 to get the 3GPP sleep parameters
  * also.
  * IMPORTANT: if this value ever needs to change, because of the
@@ -91,6 +89,44 @@
 */
 #define U_CELL_NET_CREG_OR_CGREG_TYPE 2
 
+#ifndef U_CELL_NET_DATA_COUNTER_SAMPLER_TASK_STACK_SIZE_BYTES
+/** The stack size of the data counter sampler task; this
+ * also has to accommodate any callback.
+ */
+# define U_CELL_NET_DATA_COUNTER_SAMPLER_TASK_STACK_SIZE_BYTES (1024 * 2)
+#endif
+
+#ifndef U_CELL_NET_DATA_COUNTER_SAMPLER_TASK_PRIORITY
+/** The priority of the data counter sampler task: low, it
+ * has nothing urgent to do.
+ */
+# define U_CELL_NET_DATA_COUNTER_SAMPLER_TASK_PRIORITY (U_CFG_OS_PRIORITY_MIN + 1)
+#endif
+
+#ifndef U_CELL_NET_DATA_COUNTER_SAMPLER_POLL_MS
+/** How often the data counter sampler task checks whether it
+ * has been asked to stop while it is waiting.
+ */
+# define U_CELL_NET_DATA_COUNTER_SAMPLER_POLL_MS 100
+#endif
+
+#ifndef U_CELL_NET_DATA_COUNTER_SAMPLER_GET_TRIES
+/** The number of times uCellNetDataCounterSamplerGet() will try
+ * to read a consistent snapshot before giving up.
+ */
+# define U_CELL_NET_DATA_COUNTER_SAMPLER_GET_TRIES 10
+#endif
+
+/** The number of RATs that band learning handles, see
+ * gBandLearnRat[].
+ */
+#define U_CELL_NET_BAND_LEARN_NUM_RATS 3
+
+/** The version of uCellNetBandLearnStore_t, which is what goes
+ * into the band learning file; change it if the structure changes.
+ */
+#define U_CELL_NET_BAND_LEARN_STORE_VERSION 1
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -134,6 +170,48 @@ typedef struct {
     void *pCallbackParam;
 } uCellNet3gppPowerSavingCallback_t;
 
+/** A downlink EARFCN range and the band it belongs to,
+ * from 3GPP 36.101 table 5.7.3-1.
+ */
+typedef struct {
+    int32_t earfcnFirst;
+    int32_t earfcnLast;
+    int32_t band;
+} uCellNetEarfcnBand_t;
+
+/** What band learning knows about an MCC and RAT.
+ */
+typedef struct {
+    int32_t mcc; /**< zero if the entry is empty. */
+    int32_t rat; /**< a uCellNetRat_t, as an int32_t to
+                      keep the size of the file fixed. */
+    uint64_t bandMask1;
+    uint64_t bandMask2;
+} uCellNetBandLearnEntry_t;
+
+/** The part of the band learning context that goes into the file.
+ */
+typedef struct {
+    int32_t version;
+    uCellNetBandLearnEntry_t entry[U_CELL_NET_BAND_LEARN_MAX_NUM]; /**< most
+                                                                         recent
+                                                                         first. */
+    uint64_t wideBandMask1[U_CELL_NET_BAND_LEARN_NUM_RATS]; /**< the band masks
+                                                                 from before
+                                                                 narrowing. */
+    uint64_t wideBandMask2[U_CELL_NET_BAND_LEARN_NUM_RATS];
+    uint32_t narrowedBitmap; /**< bit x is set if the band mask of
+                                  gBandLearnRat[x] is narrowed. */
+} uCellNetBandLearnStore_t;
+
+/** Band learning context, hooked into the instance.
+ */
+typedef struct {
+    uCellNetBandLearnStore_t store;
+    char fileName[U_CELL_FILE_NAME_MAX_LENGTH + 1]; /**< empty if there
+                                                         is no file. */
+} uCellNetBandLearnContext_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -182,6 +260,41 @@ static const uCellNetRegTypes_t gRegTypes[] = {
     },
 };
 
+/** The RATs that band learning handles.
+ */
+static const uCellNetRat_t gBandLearnRat[U_CELL_NET_BAND_LEARN_NUM_RATS] = {
+    U_CELL_NET_RAT_CATM1,
+    U_CELL_NET_RAT_NB1,
+    U_CELL_NET_RAT_LTE
+};
+
+/** Downlink EARFCN to band, for the FDD bands that LTE, cat-M1
+ * and NB1 modules use.
+ */
+static const uCellNetEarfcnBand_t gEarfcnBand[] = {
+    {0, 599, 1},
+    {600, 1199, 2},
+    {1200, 1949, 3},
+    {1950, 2399, 4},
+    {2400, 2649, 5},
+    {2750, 3449, 7},
+    {3450, 3799, 8},
+    {5010, 5179, 12},
+    {5180, 5279, 13},
+    {5280, 5379, 14},
+    {5730, 5849, 17},
+    {5850, 5999, 18},
+    {6000, 6149, 19},
+    {6150, 6449, 20},
+    {8040, 8689, 25},
+    {8690, 9039, 26},
+    {9210, 9659, 28},
+    {9870, 9919, 31},
+    {66436, 67335, 66},
+    {68586, 68935, 71},
+    {70366, 70545, 85}
+};
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS: FORWARD DECLARATIONS
  * -------------------------------------------------------------- */
@@ -477,9 +590,9 @@ static inline uCellNetStatus_t CXREG_urc(uCellPrivateInstance_t *pInstance,
         // URC is different), an additional parameter is inserted (not added on
         // the end, inserted)/ which has to be skipped before the RAT can be read.
         if ((gRegTypes[2 /* CEREG */].type == 4) &&
-            (((pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_SARA_R410M_02B) ||
-              (pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_SARA_R412M_02B)) ||
-             ((pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_LARA_R6) &&
+            (U_CELL_PRIVATE_MODULE_IS(pInstance->pModule, U_CELL_MODULE_TYPE_SARA_R410M_02B) ||
+             U_CELL_PRIVATE_MODULE_IS(pInstance->pModule, U_CELL_MODULE_TYPE_SARA_R412M_02B) ||
+             (U_CELL_PRIVATE_MODULE_IS(pInstance->pModule, U_CELL_MODULE_TYPE_LARA_R6) &&
               responseToCommandNotUrc))) {
             skippedParameters++;
         }
@@ -623,14 +736,25 @@ static void connectionStatusCallback(uAtClientHandle_t atHandle,
 static void CSCON_urc(uAtClientHandle_t atHandle,
                       void *pParameter)
 {
-    const uCellPrivateInstance_t *pInstance = (uCellPrivateInstance_t *) pParameter;
+    uCellPrivateInstance_t *pInstance = (uCellPrivateInstance_t *) pParameter;
     bool isConnected;
     uCellNetConnectionStatus_t *pStatus;
 
     (void) atHandle;
 
-    // Read the status
+    // Read the status and keep it for
+    // uCellNetGetBaseStationConnection()
     isConnected = (uAtClientReadInt(atHandle) == 1);
+    pInstance->baseStationConnection = (int32_t) isConnected;
+    uCellPwrPrivateEnergyState(pInstance, isConnected ?
+                               U_CELL_PWR_ENERGY_STATE_CONNECTED :
+                               U_CELL_PWR_ENERGY_STATE_IDLE);
+    if (isConnected) {
+        // A good moment for any deferred security heartbeat
+        // and to top up the socket pool
+        uCellSecPrivateHeartbeatWake(pInstance);
+        uCellSockPrivatePoolWake(pInstance);
+    }
 
     if (pInstance->pConnectionStatusCallback != NULL) {
         // If the user has a callback for this, put all the
@@ -699,6 +823,8 @@ static int32_t radioOff(uCellPrivateInstance_t *pInstance)
     // Try three times to do this, would like to
     // get it right but sometimes modules fight back
     pInstance->profileState = U_CELL_PRIVATE_PROFILE_STATE_SHOULD_BE_DOWN;
+    // The SIM may be changed while the radio is off
+    uCellPrivateClearIdCache(pInstance, true);
     for (size_t x = 3; (x > 0) && (errorCode < 0); x--) {
         // Wait for flip time to expire
         while (uPortGetTickTimeMs() - pInstance->lastCfunFlipTimeMs <
@@ -865,77 +991,68 @@ static int32_t setAutomaticMode(const uCellPrivateInstance_t *pInstance)
     return errorCode;
 }
 
-// Store a network scan result and return the
-// number stored
-static int32_t storeNextScanItem(uCellPrivateInstance_t *pInstance,
-                                 char *pBuffer)
+// Handle one field of the response to AT+COPS=?, which is a
+// list of (<stat>,<long_name>,<short_name>,<numeric>[,<AcT>])
+// with, possibly, some gunk on the end, for instance the "test"
+// response ,(0-6),(0-2); pField is the field, null-terminated,
+// with any ")" that ended it removed and itemEnd set instead.
+// *pIndex tracks where we are in an item and must be set to -1
+// before the first field.  Returns true when pNet has been filled
+// in with a complete and valid item.
+static bool parseScanField(const uCellPrivateInstance_t *pInstance,
+                           char *pField, bool itemEnd,
+                           int32_t *pIndex, uCellPrivateNet_t *pNet)
 {
-    int32_t count = 0;
     bool success = false;
-    uCellPrivateNet_t *pNet;
-    uCellPrivateNet_t **ppTmp;
     int32_t copsRat;
-    size_t x;
-    char *pSaved;
-    char *pStr;
-
-    // Should have:
-    // (<stat>,<long_name>,<short_name>,<numeric>[,<AcT>]
-    // However, there can be  gunk on the end of the AT+COPS=?
-    // response string, for instance the "test" response:
-    // ,(0-6),(0-2)
-    // ...may appear there, so check for errors;
-    // the <stat> and <numeric> fields must be present, the
-    // rest could be absent or zero length strings
-    // Malloc() memory to store this item
-    pNet = (uCellPrivateNet_t *) pUPortMalloc(sizeof(*pNet));
-    if (pNet != NULL) {
-        // Check that "(<stat>" is there and throw it away
-        pStr = strtok_r(pBuffer, ",", &pSaved);
-        success = ((pStr != NULL) && (*pStr == '('));
-        if (success) {
-            success = false;
-            // Grab <long_name> and put it in name
-            pStr = strtok_r(NULL, ",", &pSaved);
-            if (pStr != NULL) {
-                x = strlen(pStr);
-                pNet->name[0] = '\0';
+    size_t x = strlen(pField);
+
+    if (*pField == '(') {
+        // Start of an item, "(<stat>", throw <stat> away
+        pNet->name[0] = '\0';
+        pNet->mcc = 0;
+        pNet->mnc = 0;
+        pNet->rat = U_CELL_NET_RAT_UNKNOWN_OR_NOT_USED;
+        pNet->pNext = NULL;
+        *pIndex = 0;
+    } else if (*pIndex >= 0) {
+        // The <stat> and <numeric> fields must be present, the
+        // rest could be absent or zero length strings; anything
+        // unexpected means that this is gunk
+        (*pIndex)++;
+        switch (*pIndex) {
+            case 1:
+                // Grab <long_name> and put it in name,
+                // > 1 since "" is the minimum we can have
                 if (x > 1) {
-                    // > 1 since "" is the minimum we can have
                     snprintf(pNet->name, sizeof(pNet->name), "%.*s",
-                             x - 2, pStr + 1);
-                    success = true;
+                             (int) (x - 2), pField + 1);
+                } else {
+                    *pIndex = -1;
                 }
-            }
-        }
-        if (success) {
-            // Check if <short_name> is there but
-            // don't store it
-            pStr = strtok_r(NULL, ",", &pSaved);
-            success = ((pStr != NULL) && (strlen(pStr) > 1));
-        }
-        if (success) {
-            success = false;
-            // Grab <numeric> and pluck the MCC/MNC from it
-            pStr = strtok_r(NULL, ",", &pSaved);
-            pNet->mcc = 0;
-            pNet->mnc = 0;
-            // +2 for the quotes at each end
-            if ((pStr != NULL) && (strlen(pStr) >= 5 + 2)) {
-                // +1 for the initial quotation mark
-                pNet->mnc = atoi(pStr + 3 + 1);
-                *(pStr + 3 + 1) = 0;
-                pNet->mcc = atoi(pStr + 1);
-                success = true;
-            }
-        }
-        if (success) {
-            // See if <AcT> is there
-            pNet->rat = U_CELL_NET_RAT_UNKNOWN_OR_NOT_USED;
-            pStr = strtok_r(NULL, ",", &pSaved);
-            if (pStr != NULL) {
-                // If it is convert it into a RAT value
-                copsRat = atoi(pStr);
+                break;
+            case 2:
+                // Check if <short_name> is there but
+                // don't store it
+                if (x <= 1) {
+                    *pIndex = -1;
+                }
+                break;
+            case 3:
+                // Grab <numeric> and pluck the MCC/MNC from it,
+                // +2 for the quotes at each end
+                if (x >= 5 + 2) {
+                    // +1 for the initial quotation mark
+                    pNet->mnc = atoi(pField + 3 + 1);
+                    *(pField + 3 + 1) = 0;
+                    pNet->mcc = atoi(pField + 1);
+                } else {
+                    *pIndex = -1;
+                }
+                break;
+            case 4:
+                // <AcT> is there: convert it into a RAT value
+                copsRat = atoi(pField);
                 if ((copsRat >= 0) &&
                     (copsRat < (int32_t) (sizeof(g3gppRatToCellRat) /
                                           sizeof(g3gppRatToCellRat[0])))) {
@@ -949,29 +1066,216 @@ static int32_t storeNextScanItem(uCellPrivateInstance_t *pInstance,
                         pNet->rat = U_CELL_NET_RAT_CATM1;
                     }
                 }
-            }
+                break;
+            default:
+                *pIndex = -1;
+                break;
         }
-        pNet->pNext = NULL;
     }
 
-    // Count the number of things already
-    // in the list
-    ppTmp = &(pInstance->pScanResults);
-    while (*ppTmp != NULL) {
-        ppTmp = &((*ppTmp)->pNext);
-        count++;
+    if (itemEnd) {
+        success = (*pIndex >= 3);
+        *pIndex = -1;
     }
 
-    if (success) {
+    return success;
+}
+
+// Store a network scan result on the end of the list
+// in the instance: this is the item callback for scan()
+// used by uCellNetScanGetFirst().
+static bool storeScanItem(uCellPrivateInstance_t *pInstance,
+                          const uCellPrivateNet_t *pNet,
+                          void *pParam)
+{
+    uCellPrivateNet_t *pStored;
+    uCellPrivateNet_t **ppTmp;
+
+    (void) pParam;
+
+    // Malloc() memory to store this item
+    pStored = (uCellPrivateNet_t *) pUPortMalloc(sizeof(*pStored));
+    if (pStored != NULL) {
+        *pStored = *pNet;
+        pStored->pNext = NULL;
         // Add the new entry to the end of the list
-        *ppTmp = pNet;
-        count++;
-    } else {
-        // Found gunk, just free the memory
-        uPortFree(pNet);
+        ppTmp = &(pInstance->pScanResults);
+        while (*ppTmp != NULL) {
+            ppTmp = &((*ppTmp)->pNext);
+        }
+        *ppTmp = pStored;
+    }
+
+    // Always carry on
+    return true;
+}
+
+// The parameters that uCellNetScan() passes through
+// scan() to streamScanItem().
+typedef struct {
+    bool (*pCallback) (uDeviceHandle_t, const char *, const char *,
+                       uCellNetRat_t, void *);
+    void *pCallbackParam;
+} uCellNetScanStream_t;
+
+// Pass a network scan result straight to the user: this is
+// the item callback for scan() used by uCellNetScan().
+static bool streamScanItem(uCellPrivateInstance_t *pInstance,
+                           const uCellPrivateNet_t *pNet,
+                           void *pParam)
+{
+    uCellNetScanStream_t *pStream = (uCellNetScanStream_t *) pParam;
+    char mccMnc[U_CELL_NET_MCC_MNC_LENGTH_BYTES];
+
+    snprintf(mccMnc, sizeof(mccMnc), "%03d%02d",
+             (int) pNet->mcc, (int) pNet->mnc);
+
+    return pStream->pCallback(pInstance->cellHandle, pNet->name,
+                              mccMnc, pNet->rat,
+                              pStream->pCallbackParam);
+}
+
+// Perform a network scan with AT+COPS=?, passing each
+// network found to pItemCallback, in the order they are
+// listed by the module, until pItemCallback returns false.
+// Returns the number of networks passed to pItemCallback
+// or negative error code.
+static int32_t scan(uCellPrivateInstance_t *pInstance,
+                    bool (*pItemCallback) (uCellPrivateInstance_t *,
+                                           const uCellPrivateNet_t *,
+                                           void *),
+                    void *pItemCallbackParam,
+                    bool (*pKeepGoingCallback) (uDeviceHandle_t))
+{
+    int32_t errorCodeOrNumber = (int32_t) U_CELL_ERROR_TEMPORARY_FAILURE;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    uAtClientSpan_t span;
+    // +2 for the quotes around a name, +1 for a terminator
+    char field[U_CELL_NET_MAX_NAME_LENGTH_BYTES + 2 + 1];
+    size_t fieldLength;
+    size_t length;
+    char lastCharacter;
+    int32_t fieldIndex;
+    int32_t spanLength;
+    int32_t mode;
+    int64_t innerStartTimeMs;
+    uAtClientDeviceError_t deviceError;
+    bool gotAnswer = false;
+    bool keepGoing = true;
+    uCellPrivateNet_t net;
+
+    // Ensure that we're powered up.
+    mode = uCellPrivateCFunOne(pInstance);
+    // Start a scan
+    // Do this three times: if the module
+    // is busy doing its own search when we ask it
+    // to do a network search, as it might be if
+    // we've just come out of airplane mode,
+    // it will ignore us and simply return the
+    // "test" response to the AT+COPS=? command,
+    // i.e.: +COPS: ,,(0-6),(0-2)
+    // ...which contains no valid items, so keep going
+    // until at least one has been found.
+    pInstance->startTimeMs = uPortGetTickTimeMs();
+    for (size_t x = U_CELL_NET_SCAN_RETRIES + 1;
+         (x > 0) && (errorCodeOrNumber <= 0) &&
+         ((pKeepGoingCallback == NULL) || (pKeepGoingCallback(pInstance->cellHandle)));
+         x--) {
+        uAtClientLock(atHandle);
+        // Set the timeout to a second so that we
+        // can spin around the loop
+        gotAnswer = false;
+        uAtClientTimeoutSet(atHandle, 1000);
+        uAtClientCommandStart(atHandle, "AT+COPS=?");
+        uAtClientCommandStop(atHandle);
+        // Will get back "+COPS:" then a single line consisting of
+        // comma delimited list of
+        // (<stat>,<long_name>,<short_name>,<numeric>[,<AcT>])
+        // ...plus some other stuff on the end.
+        // Sit in a loop waiting for the first field of a
+        // response of some form to arrive
+        spanLength = -1;
+        innerStartTimeMs = uPortGetTickTimeMs();
+        while (!gotAnswer &&
+               (uPortGetTickTimeMs() - innerStartTimeMs <
+                (U_CELL_NET_SCAN_TIME_SECONDS * 1000)) &&
+               ((pKeepGoingCallback == NULL) || (pKeepGoingCallback(pInstance->cellHandle)))) {
+            uAtClientResponseStart(atHandle, "+COPS:");
+            spanLength = uAtClientReadSpan(atHandle, &span, false);
+            // Check if an error has been returned by the module,
+            // e.g. +CME ERROR: Temporary Failure, in which case
+            // we will try AT+COPS=? again in the outer for() loop
+            uAtClientDeviceErrorGet(atHandle, &deviceError);
+            if ((spanLength >= 0) ||
+                (deviceError.type != U_AT_CLIENT_DEVICE_ERROR_TYPE_NO_ERROR)) {
+                // Got _something_ back, but it may still be the
+                // "test" response or a device error
+                gotAnswer = true;
+            } else {
+                uAtClientClearError(atHandle);
+                uPortTaskBlock(1000);
+            }
+        }
+        if (spanLength >= 0) {
+            // Got a real answer: process it field by field,
+            // straight out of the AT client's receive buffer,
+            // passing each item to pItemCallback as it completes
+            errorCodeOrNumber = 0;
+            fieldIndex = -1;
+            fieldLength = 0;
+            lastCharacter = 0;
+            while ((spanLength >= 0) && keepGoing) {
+                // A field may arrive in pieces: keep what will
+                // fit, which is all that matters
+                length = span.length;
+                if (length > sizeof(field) - 1 - fieldLength) {
+                    length = sizeof(field) - 1 - fieldLength;
+                }
+                memcpy(field + fieldLength, span.pData, length);
+                fieldLength += length;
+                if (span.length > 0) {
+                    lastCharacter = *(span.pData + span.length - 1);
+                }
+                if (!span.isPartial) {
+                    if ((lastCharacter == ')') && (fieldLength > 0) &&
+                        (field[fieldLength - 1] == ')')) {
+                        fieldLength--;
+                    }
+                    field[fieldLength] = 0;
+                    if (parseScanField(pInstance, field, lastCharacter == ')',
+                                       &fieldIndex, &net)) {
+                        errorCodeOrNumber++;
+                        keepGoing = pItemCallback(pInstance, &net,
+                                                  pItemCallbackParam);
+                    }
+                    fieldLength = 0;
+                    lastCharacter = 0;
+                }
+                spanLength = -1;
+                if (!span.isLast) {
+                    spanLength = uAtClientReadSpan(atHandle, &span, false);
+                }
+            }
+        }
+        uAtClientClearError(atHandle);
+        uAtClientResponseStop(atHandle);
+        uAtClientUnlock(atHandle);
+        if (!gotAnswer) {
+            // If we never got an answer, abort the
+            // command first.
+            abortCommand(pInstance);
+        }
+    }
+
+    // Put the mode back if it was not already 1
+    if ((mode >= 0) && (mode != 1)) {
+        uCellPrivateCFunMode(pInstance, mode);
+    }
+    if (!gotAnswer) {
+        errorCodeOrNumber = (int32_t) U_ERROR_COMMON_TIMEOUT;
     }
 
-    return count;
+    return errorCodeOrNumber;
 }
 
 // Return the next network scan result, freeing
@@ -1162,9 +1466,11 @@ static int32_t registerNetwork(uCellPrivateInstance_t *pInstance,
                 if (U_CELL_NET_STATUS_MEANS_REGISTERED(status)) {
                     // Skip <lac>, <ci>
                     if ((regType == 2 /* CEREG */) && (gRegTypes[regType].type == 4) &&
-                        (((pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_SARA_R410M_02B) ||
-                          (pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_SARA_R412M_02B)) ||
-                         ((pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_LARA_R6) &&
+                        (U_CELL_PRIVATE_MODULE_IS(pInstance->pModule,
+                                                  U_CELL_MODULE_TYPE_SARA_R410M_02B) ||
+                         U_CELL_PRIVATE_MODULE_IS(pInstance->pModule,
+                                                  U_CELL_MODULE_TYPE_SARA_R412M_02B) ||
+                         (U_CELL_PRIVATE_MODULE_IS(pInstance->pModule, U_CELL_MODULE_TYPE_LARA_R6) &&
                           !gotUrc))) {
                         // SARA-R41x-02B modules, and LARA-R6 modules but only in the
                         // non-URC case, sneak an extra <rac_or_mme> parameter in when
@@ -1357,7 +1663,7 @@ static int32_t setAuthenticationMode(const uCellPrivateInstance_t *pInstance,
     uAtClientWriteInt(atHandle, contextId);
     uAtClientWriteInt(atHandle, 3); // Automatic choice of authentication type
     if (!U_CELL_PRIVATE_MODULE_IS_SARA_R4(pInstance->pModule->moduleType) &&
-        (pInstance->pModule->moduleType != U_CELL_MODULE_TYPE_LARA_R6)) {
+        !U_CELL_PRIVATE_MODULE_IS(pInstance->pModule, U_CELL_MODULE_TYPE_LARA_R6)) {
         uAtClientWriteString(atHandle, pUsername, true);
         uAtClientWriteString(atHandle, pPassword, true);
     } else {
@@ -1682,11 +1988,13 @@ static int32_t deactivate(uCellPrivateInstance_t *pInstance,
     uAtClientHandle_t atHandle = pInstance->atHandle;
 
     if (isActive(pInstance, contextId)) {
-        pInstance->profileState = U_CELL_PRIVATE_PROFILE_STATE_SHOULD_BE_DOWN;
+        if (contextId == U_CELL_NET_CONTEXT_ID) {
+            pInstance->profileState = U_CELL_PRIVATE_PROFILE_STATE_SHOULD_BE_DOWN;
+        }
         uAtClientLock(atHandle);
         uAtClientCommandStart(atHandle, "AT+CGACT=");
         uAtClientWriteInt(atHandle, 0);
-        uAtClientWriteInt(atHandle, U_CELL_NET_CONTEXT_ID);
+        uAtClientWriteInt(atHandle, contextId);
         uAtClientCommandStopReadResponse(atHandle);
         errorCode = uAtClientUnlock(atHandle);
     }
@@ -1803,6 +2111,63 @@ static int32_t handleExistingContext(uCellPrivateInstance_t *pInstance,
     return errorCode;
 }
 
+// The fast path for uCellNetConnect(): if the module is registered
+// and attached but has no active PDP context, e.g. on return
+// from 3GPP power saving, simply activate the PDP context that is
+// already defined and check that it has the right APN.  This is
+// not done for modules which use AT+UPSD since there the APN etc.
+// are only set at activation.
+static int32_t activateExistingContext(uCellPrivateInstance_t *pInstance,
+                                       const char *pApn,
+                                       bool (pKeepGoingCallback) (uDeviceHandle_t))
+{
+    int32_t errorCode = (int32_t) U_CELL_ERROR_NOT_CONNECTED;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    bool attached = false;
+    char *pBuffer;
+
+    if (!U_CELL_PRIVATE_HAS(pInstance->pModule,
+                            U_CELL_PRIVATE_FEATURE_USE_UPSD_CONTEXT_ACTIVATION)) {
+        // Only worth it if we're attached already, otherwise do
+        // the whole thing properly
+        uAtClientLock(atHandle);
+        uAtClientCommandStart(atHandle, "AT+CGATT?");
+        uAtClientCommandStop(atHandle);
+        uAtClientResponseStart(atHandle, "+CGATT:");
+        attached = (uAtClientReadInt(atHandle) == 1);
+        uAtClientResponseStop(atHandle);
+        uAtClientUnlock(atHandle);
+        if (attached) {
+            pInstance->pKeepGoingCallback = pKeepGoingCallback;
+            pInstance->startTimeMs = uPortGetTickTimeMs();
+            errorCode = activateContext(pInstance, U_CELL_NET_CONTEXT_ID,
+                                        U_CELL_NET_PROFILE_ID);
+            if ((errorCode == 0) && (pApn != NULL)) {
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                pBuffer = (char *) pUPortMalloc(U_CELL_NET_MAX_APN_LENGTH_BYTES);
+                if (pBuffer != NULL) {
+                    errorCode = (int32_t) U_CELL_ERROR_NOT_CONNECTED;
+                    if ((getApnStr(pInstance, pBuffer,
+                                   U_CELL_NET_MAX_APN_LENGTH_BYTES) > 0) &&
+                        (strcmp(pApn, pBuffer) == 0)) {
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    }
+                    uPortFree(pBuffer);
+                }
+                if (errorCode != 0) {
+                    // Wrong APN: the full path will sort it out
+                    uPortLog("U_CELL_NET: activated PDP context has the wrong APN.\n");
+                    deactivate(pInstance, U_CELL_NET_CONTEXT_ID);
+                }
+            }
+            pInstance->pKeepGoingCallback = NULL;
+            pInstance->startTimeMs = 0;
+        }
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS: MISC
  * -------------------------------------------------------------- */
@@ -2010,49 +2375,554 @@ static int32_t getDnsStrUpsd(const uCellPrivateInstance_t *pInstance,
 }
 
 /* ----------------------------------------------------------------
- * PUBLIC FUNCTIONS
+ * STATIC FUNCTIONS: DATA COUNTERS
  * -------------------------------------------------------------- */
 
-// Register with the cellular network and activate a PDP context.
-int32_t uCellNetConnect(uDeviceHandle_t cellHandle,
-                        const char *pMccMnc,
-                        const char *pApn, const char *pUsername,
-                        const char *pPassword,
-                        bool (*pKeepGoingCallback) (uDeviceHandle_t cellHandle))
+// Read the transmit and receive data counters for our context.
+// Note: gUCellPrivateMutex should be locked before this is called.
+static int32_t getDataCounters(const uCellPrivateInstance_t *pInstance,
+                               int32_t *pTxBytes, int32_t *pRxBytes)
 {
-    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    int32_t errorCode = (int32_t) U_CELL_ERROR_AT;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    bool ours = false;
+    int32_t bytesSent = -1;
+    int32_t bytesReceived = -1;
+    int32_t y = 0;
+
+    uAtClientLock(atHandle);
+    uAtClientCommandStart(atHandle, "AT+UGCNTRD");
+    uAtClientCommandStop(atHandle);
+    for (size_t x = 0; (x < U_CELL_NET_MAX_NUM_CONTEXTS) &&
+         (y >= 0) && !ours; x++) {
+        uAtClientResponseStart(atHandle, "+UGCNTRD:");
+        // Check if this is our context ID
+        y = uAtClientReadInt(atHandle);
+        if (y == U_CELL_NET_CONTEXT_ID) {
+            ours = true;
+            // If it is, the next two are the sent and
+            // received counts for this session
+            bytesSent = uAtClientReadInt(atHandle);
+            bytesReceived = uAtClientReadInt(atHandle);
+        }
+    }
+    uAtClientResponseStop(atHandle);
+    if ((uAtClientUnlock(atHandle) == 0) && ours &&
+        (bytesSent >= 0) && (bytesReceived >= 0)) {
+        *pTxBytes = bytesSent;
+        *pRxBytes = bytesReceived;
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Move a moving average of data rate towards the rate given by
+// the number of bytes over the number of milliseconds.
+static int32_t dataCounterRateAverage(int32_t averageBytesPerSecond,
+                                      int32_t bytes, int32_t timeMs)
+{
+    int32_t bytesPerSecond = (int32_t) (((int64_t) bytes * 1000) / timeMs);
+
+    if (averageBytesPerSecond >= 0) {
+        bytesPerSecond = averageBytesPerSecond +
+                         ((bytesPerSecond - averageBytesPerSecond) /
+                          U_CELL_NET_DATA_COUNTER_SAMPLER_RATE_DIVISOR);
+    }
+
+    return bytesPerSecond;
+}
+
+// Update the data counter sampler with a new reading of the data
+// counters and publish the outcome. Readings may come from the
+// sampler task or from uCellNetGetDataCounterTx()/Rx() but either
+// way gUCellPrivateMutex is locked, so there is only one writer at
+// a time and it is sufficient to bump the sequence number before
+// and after the write.
+static void dataCounterSamplerUpdate(uCellPrivateDataCounterSamplerContext_t *pContext,
+                                     int32_t errorCode,
+                                     int32_t txBytes, int32_t rxBytes)
+{
+    uCellNetDataCounterSampler_t *pSampler = (uCellNetDataCounterSampler_t *) pContext->pSampler;
+    int32_t timeMs = uPortGetTickTimeMs();
+    int32_t elapsedMs;
+    int32_t x;
+
+    if (errorCode == 0) {
+        if (pContext->lastTxBytes >= 0) {
+            // A counter that has gone backwards has started again
+            x = txBytes - pContext->lastTxBytes;
+            pContext->txBytes += (x >= 0) ? x : txBytes;
+            x = rxBytes - pContext->lastRxBytes;
+            pContext->rxBytes += (x >= 0) ? x : rxBytes;
+            // Only work out a rate over a decent interval, since
+            // readings may arrive close together
+            elapsedMs = timeMs - pContext->rateTimeMs;
+            if (elapsedMs >= U_CELL_NET_DATA_COUNTER_SAMPLER_PERIOD_MIN_MS) {
+                pContext->txBytesPerSecond = dataCounterRateAverage(pContext->txBytesPerSecond,
+                                                                    pContext->txBytes -
+                                                                    pContext->rateTxBytes,
+                                                                    elapsedMs);
+                pContext->rxBytesPerSecond = dataCounterRateAverage(pContext->rxBytesPerSecond,
+                                                                    pContext->rxBytes -
+                                                                    pContext->rateRxBytes,
+                                                                    elapsedMs);
+                pContext->rateTimeMs = timeMs;
+                pContext->rateTxBytes = pContext->txBytes;
+                pContext->rateRxBytes = pContext->rxBytes;
+            }
+        } else {
+            // First reading: the starting point for the rates
+            pContext->rateTimeMs = timeMs;
+            pContext->rateTxBytes = pContext->txBytes;
+            pContext->rateRxBytes = pContext->rxBytes;
+        }
+        pContext->lastTxBytes = txBytes;
+        pContext->lastRxBytes = rxBytes;
+    }
+
+    pSampler->sequence++;
+    pSampler->txBytes = pContext->txBytes;
+    pSampler->rxBytes = pContext->rxBytes;
+    pSampler->txBytesPerSecond = pContext->txBytesPerSecond;
+    pSampler->rxBytesPerSecond = pContext->rxBytesPerSecond;
+    pSampler->errorCode = errorCode;
+    pSampler->timeMs = timeMs;
+    pSampler->count++;
+    pSampler->sequence++;
+}
+
+// Wait for up to waitMs, returning early, with false, if the data
+// counter sampler has been asked to stop.
+static bool dataCounterSamplerWait(const uCellPrivateDataCounterSamplerContext_t *pContext,
+                                   int32_t waitMs)
+{
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    while (pContext->keepGoing &&
+           (uPortGetTickTimeMs() - startTimeMs < waitMs)) {
+        uPortTaskBlock(U_CELL_NET_DATA_COUNTER_SAMPLER_POLL_MS);
+    }
+
+    return pContext->keepGoing;
+}
+
+// Lock gUCellPrivateMutex on behalf of the data counter sampler
+// and return the instance, giving up if the sampler is asked to
+// stop; see pRadioSamplerLock() in u_cell_info.c for why TryLock
+// is used.  If the return value is non-NULL gUCellPrivateMutex
+// must be unlocked afterwards.
+static uCellPrivateInstance_t *pDataCounterSamplerLock(const uCellPrivateDataCounterSamplerContext_t *pContext)
+{
+    uCellPrivateInstance_t *pInstance = NULL;
+    bool locked = false;
+
+    while (pContext->keepGoing && !locked) {
+        locked = (uPortMutexTryLock(gUCellPrivateMutex,
+                                    U_CELL_NET_DATA_COUNTER_SAMPLER_POLL_MS) == 0);
+    }
+    if (locked) {
+        if (pContext->keepGoing) {
+            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+        }
+        if (pInstance == NULL) {
+            uPortMutexUnlock(gUCellPrivateMutex);
+        }
+    }
+
+    return pInstance;
+}
+
+// The data counter sampler task.
+static void dataCounterSamplerTask(void *pParam)
+{
+    uCellPrivateDataCounterSamplerContext_t *pContext = (uCellPrivateDataCounterSamplerContext_t *) pParam;
     uCellPrivateInstance_t *pInstance;
-    char buffer[15];  // At least 15 characters for the IMSI
-    const char *pApnConfig = NULL;
+    int32_t errorCode;
+    int32_t txBytes = 0;
+    int32_t rxBytes = 0;
+    bool callNow;
 
-    if (gUCellPrivateMutex != NULL) {
+    U_PORT_MUTEX_LOCK(pContext->taskRunningMutex);
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+    while (pContext->keepGoing) {
+        pInstance = pDataCounterSamplerLock(pContext);
+        if (pInstance != NULL) {
+            errorCode = getDataCounters(pInstance, &txBytes, &rxBytes);
+            dataCounterSamplerUpdate(pContext, errorCode, txBytes, rxBytes);
+            callNow = (pContext->thresholdBytes <= 0);
+            if (!callNow && !pContext->thresholdReached &&
+                (pContext->txBytes + pContext->rxBytes >= pContext->thresholdBytes)) {
+                pContext->thresholdReached = true;
+                callNow = true;
+            }
+            uPortMutexUnlock(gUCellPrivateMutex);
+            if (callNow && pContext->keepGoing && (pContext->pCallback != NULL)) {
+                pContext->pCallback(pContext->cellHandle, pContext->pCallbackParam);
+            }
+        }
+        dataCounterSamplerWait(pContext, pContext->periodMs);
+    }
+
+    U_PORT_MUTEX_UNLOCK(pContext->taskRunningMutex);
+
+    // Delete ourself
+    uTaskRegistryTaskDelete(NULL);
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: BAND LEARNING
+ * -------------------------------------------------------------- */
+
+// Get the index of a RAT in gBandLearnRat[], -1 if it is not there.
+static int32_t bandLearnRatIndex(uCellNetRat_t rat)
+{
+    int32_t index = -1;
+
+    for (size_t x = 0; (x < sizeof(gBandLearnRat) / sizeof(gBandLearnRat[0])) &&
+         (index < 0); x++) {
+        if (gBandLearnRat[x] == rat) {
+            index = (int32_t) x;
+        }
+    }
+
+    return index;
+}
+
+// Get the band that a downlink EARFCN is in, -1 if not known.
+static int32_t bandFromEarfcn(int32_t earfcn)
+{
+    int32_t band = -1;
+
+    for (size_t x = 0; (x < sizeof(gEarfcnBand) / sizeof(gEarfcnBand[0])) &&
+         (band < 0); x++) {
+        if ((earfcn >= gEarfcnBand[x].earfcnFirst) &&
+            (earfcn <= gEarfcnBand[x].earfcnLast)) {
+            band = gEarfcnBand[x].band;
+        }
+    }
 
+    return band;
+}
+
+// Lock gUCellPrivateMutex and return the band learning context of
+// the given instance; if there isn't one, NULL is returned with
+// gUCellPrivateMutex unlocked.  Must be called with
+// gUCellPrivateMutex unlocked since the functions below call the
+// public uCellXxx() functions.
+static uCellNetBandLearnContext_t *pBandLearnLock(uDeviceHandle_t cellHandle)
+{
+    uCellNetBandLearnContext_t *pContext = NULL;
+    uCellPrivateInstance_t *pInstance;
+
+    if (gUCellPrivateMutex != NULL) {
+        uPortMutexLock(gUCellPrivateMutex);
         pInstance = pUCellPrivateGetInstance(cellHandle);
-        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        if ((pInstance != NULL) &&
-            ((pUsername == NULL) || (pPassword != NULL))) {
+        if (pInstance != NULL) {
+            pContext = (uCellNetBandLearnContext_t *) pInstance->pBandLearnContext;
+        }
+        if (pContext == NULL) {
+            uPortMutexUnlock(gUCellPrivateMutex);
+        }
+    }
 
-            errorCode = (int32_t) U_CELL_ERROR_NOT_CONNECTED;
-            if (uCellPrivateIsRegistered(pInstance)) {
-                // First deal with any existing context,
-                // which might turn out to be good enough
-                errorCode = handleExistingContext(pInstance, pApn,
-                                                  pKeepGoingCallback);
-            }
+    return pContext;
+}
 
-            if (errorCode != 0) {
-                // Nope, no free ride, do some work
-                errorCode = prepareConnect(pInstance);
-                if (errorCode == 0) {
-                    if ((pApn == NULL) &&
-                        !uCellMnoDbProfileHas(pInstance,
-                                              U_CELL_MNO_DB_FEATURE_NO_CGDCONT) &&
-                        (uCellPrivateGetImsi(pInstance, buffer) == 0)) {
-                        // Set up the APN look-up since none is specified
-                        pApnConfig = pApnGetConfig(buffer);
-                    }
+// Write a copy of the band learning store to the file, if
+// there is one; called with gUCellPrivateMutex unlocked.
+static void bandLearnSave(uDeviceHandle_t cellHandle,
+                          const uCellNetBandLearnStore_t *pStore,
+                          const char *pFileName)
+{
+    if (pFileName[0] != 0) {
+        // Writing appends, so delete what's there first
+        uCellFileDelete(cellHandle, pFileName);
+        if (uCellFileWrite(cellHandle, pFileName, (const char *) pStore,
+                           sizeof(*pStore)) != (int32_t) sizeof(*pStore)) {
+            uPortLog("U_CELL_NET: unable to write band learning file \"%s\".\n",
+                     pFileName);
+        }
+    }
+}
+
+// Learn the band that we have just registered on.
+static void bandLearnUpdate(uDeviceHandle_t cellHandle)
+{
+    uCellNetBandLearnContext_t *pContext;
+    uCellNetBandLearnStore_t store;
+    char fileName[U_CELL_FILE_NAME_MAX_LENGTH + 1];
+    uCellNetBandLearnEntry_t entry;
+    uCellNetRat_t rat;
+    int32_t mcc;
+    int32_t mnc;
+    int32_t band = -1;
+    uint64_t bit;
+    size_t x;
+    bool changed = false;
+
+    rat = uCellNetGetActiveRat(cellHandle);
+    pContext = pBandLearnLock(cellHandle);
+    if (pContext != NULL) {
+        // Only checking here that band learning is on
+        uPortMutexUnlock(gUCellPrivateMutex);
+        if ((bandLearnRatIndex(rat) >= 0) &&
+            (uCellNetGetMccMnc(cellHandle, &mcc, &mnc) == 0) &&
+            (uCellInfoRefreshRadioParameters(cellHandle) == 0)) {
+            band = bandFromEarfcn(uCellInfoGetEarfcn(cellHandle));
+        }
+    }
+    if (band > 0) {
+        pContext = pBandLearnLock(cellHandle);
+        if (pContext != NULL) {
+            // Find the entry for this MCC and RAT, else
+            // use the last (least recently used) one
+            for (x = 0; (x < U_CELL_NET_BAND_LEARN_MAX_NUM - 1) &&
+                 ((pContext->store.entry[x].mcc != mcc) ||
+                  (pContext->store.entry[x].rat != (int32_t) rat)); x++) {}
+            entry = pContext->store.entry[x];
+            if ((entry.mcc != mcc) || (entry.rat != (int32_t) rat)) {
+                memset(&entry, 0, sizeof(entry));
+                entry.mcc = mcc;
+                entry.rat = (int32_t) rat;
+                changed = true;
+            }
+            bit = 1ULL << ((band - 1) % 64);
+            if (band <= 64) {
+                changed |= ((entry.bandMask1 & bit) == 0);
+                entry.bandMask1 |= bit;
+            } else {
+                changed |= ((entry.bandMask2 & bit) == 0);
+                entry.bandMask2 |= bit;
+            }
+            if (x > 0) {
+                // Move it to the front
+                memmove(&(pContext->store.entry[1]), &(pContext->store.entry[0]),
+                        x * sizeof(pContext->store.entry[0]));
+                changed = true;
+            }
+            pContext->store.entry[0] = entry;
+            if (changed) {
+                store = pContext->store;
+                strncpy(fileName, pContext->fileName, sizeof(fileName));
+                uPortLog("U_CELL_NET: learnt band %d for MCC %d, RAT %d.\n",
+                         band, mcc, rat);
+            }
+            uPortMutexUnlock(gUCellPrivateMutex);
+            if (changed) {
+                bandLearnSave(cellHandle, &store, fileName);
+            }
+        }
+    }
+}
+
+// Narrow the band masks to those learnt for the most recent MCC.
+static void bandLearnNarrow(uDeviceHandle_t cellHandle)
+{
+    uCellNetBandLearnContext_t *pContext;
+    uCellNetBandLearnStore_t store;
+    char fileName[U_CELL_FILE_NAME_MAX_LENGTH + 1];
+    uint64_t learnt[U_CELL_NET_BAND_LEARN_NUM_RATS][2] = {0};
+    uint64_t wide[2];
+    uint64_t now[2];
+    uint64_t narrow[2];
+    uint32_t learntBitmap = 0;
+    uint32_t narrowedBitmap = 0;
+    int32_t index;
+    bool changed = false;
+
+    pContext = pBandLearnLock(cellHandle);
+    if (pContext != NULL) {
+        for (size_t x = 0; (x < U_CELL_NET_BAND_LEARN_MAX_NUM) &&
+             (pContext->store.entry[0].mcc != 0); x++) {
+            index = bandLearnRatIndex((uCellNetRat_t) pContext->store.entry[x].rat);
+            if ((pContext->store.entry[x].mcc == pContext->store.entry[0].mcc) &&
+                (index >= 0)) {
+                learnt[index][0] = pContext->store.entry[x].bandMask1;
+                learnt[index][1] = pContext->store.entry[x].bandMask2;
+                learntBitmap |= 1UL << index;
+            }
+        }
+        narrowedBitmap = pContext->store.narrowedBitmap;
+        uPortMutexUnlock(gUCellPrivateMutex);
+    }
+
+    for (size_t x = 0; x < U_CELL_NET_BAND_LEARN_NUM_RATS; x++) {
+        if (((learntBitmap & (1UL << x)) != 0) &&
+            (uCellCfgGetBandMask(cellHandle, gBandLearnRat[x],
+                                 &(now[0]), &(now[1])) == 0)) {
+            wide[0] = now[0];
+            wide[1] = now[1];
+            if ((narrowedBitmap & (1UL << x)) != 0) {
+                pContext = pBandLearnLock(cellHandle);
+                if (pContext != NULL) {
+                    wide[0] = pContext->store.wideBandMask1[x];
+                    wide[1] = pContext->store.wideBandMask2[x];
+                    uPortMutexUnlock(gUCellPrivateMutex);
+                }
+            }
+            narrow[0] = learnt[x][0] & wide[0];
+            narrow[1] = learnt[x][1] & wide[1];
+            // Only narrow to bands that were allowed before and
+            // don't write the band mask if it is already right
+            if (((narrow[0] != 0) || (narrow[1] != 0)) &&
+                ((narrow[0] != now[0]) || (narrow[1] != now[1])) &&
+                (uCellCfgSetBandMask(cellHandle, gBandLearnRat[x],
+                                     narrow[0], narrow[1]) == 0)) {
+                pContext = pBandLearnLock(cellHandle);
+                if (pContext != NULL) {
+                    pContext->store.wideBandMask1[x] = wide[0];
+                    pContext->store.wideBandMask2[x] = wide[1];
+                    pContext->store.narrowedBitmap |= 1UL << x;
+                    uPortMutexUnlock(gUCellPrivateMutex);
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    if (changed) {
+        pContext = pBandLearnLock(cellHandle);
+        if (pContext != NULL) {
+            store = pContext->store;
+            strncpy(fileName, pContext->fileName, sizeof(fileName));
+            uPortMutexUnlock(gUCellPrivateMutex);
+            uPortLog("U_CELL_NET: band masks narrowed to those learnt for"
+                     " MCC %d.\n", store.entry[0].mcc);
+            bandLearnSave(cellHandle, &store, fileName);
+        }
+    }
+}
+
+// Put any narrowed band masks back to what they were before,
+// returning zero if nothing was narrowed, a positive value if
+// band masks were widened, else negative error code.
+static int32_t bandLearnWiden(uDeviceHandle_t cellHandle)
+{
+    int32_t errorCodeOrWidened = 0;
+    uCellNetBandLearnContext_t *pContext;
+    uCellNetBandLearnStore_t store;
+    char fileName[U_CELL_FILE_NAME_MAX_LENGTH + 1];
+    int32_t x;
+
+    pContext = pBandLearnLock(cellHandle);
+    if (pContext != NULL) {
+        store = pContext->store;
+        uPortMutexUnlock(gUCellPrivateMutex);
+        for (size_t y = 0; y < U_CELL_NET_BAND_LEARN_NUM_RATS; y++) {
+            if ((store.narrowedBitmap & (1UL << y)) != 0) {
+                x = uCellCfgSetBandMask(cellHandle, gBandLearnRat[y],
+                                        store.wideBandMask1[y],
+                                        store.wideBandMask2[y]);
+                if (x == 0) {
+                    store.narrowedBitmap &= ~(1UL << y);
+                    if (errorCodeOrWidened >= 0) {
+                        errorCodeOrWidened++;
+                    }
+                } else {
+                    errorCodeOrWidened = x;
+                }
+            }
+        }
+        if (errorCodeOrWidened != 0) {
+            pContext = pBandLearnLock(cellHandle);
+            if (pContext != NULL) {
+                pContext->store.narrowedBitmap = store.narrowedBitmap;
+                store = pContext->store;
+                strncpy(fileName, pContext->fileName, sizeof(fileName));
+                uPortMutexUnlock(gUCellPrivateMutex);
+                uPortLog("U_CELL_NET: band masks widened again.\n");
+                bandLearnSave(cellHandle, &store, fileName);
+            }
+        }
+    }
+
+    return errorCodeOrWidened;
+}
+
+// Called after uCellNetConnect()/uCellNetRegister() with the
+// outcome: learns on success; on failure widens any narrowed band
+// masks and reboots the module, returning true if the attempt
+// should be repeated.
+static bool bandLearnOutcome(uDeviceHandle_t cellHandle, int32_t errorCode,
+                             bool (*pKeepGoingCallback) (uDeviceHandle_t))
+{
+    bool tryAgain = false;
+
+    if (errorCode == 0) {
+        bandLearnUpdate(cellHandle);
+    } else if ((errorCode != (int32_t) U_ERROR_COMMON_INVALID_PARAMETER) &&
+               (errorCode != (int32_t) U_ERROR_COMMON_NOT_INITIALISED) &&
+               (bandLearnWiden(cellHandle) > 0)) {
+        // The band masks only take effect after a reboot
+        tryAgain = ((pKeepGoingCallback == NULL) || pKeepGoingCallback(cellHandle)) &&
+                   (uCellPwrReboot(cellHandle, pKeepGoingCallback) == 0);
+    }
+
+    return tryAgain;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: CONNECT AND REGISTER
+ * -------------------------------------------------------------- */
+
+// Register with the cellular network and activate a PDP context:
+// the body of uCellNetConnect().
+static int32_t netConnect(uDeviceHandle_t cellHandle,
+                          const char *pMccMnc,
+                          const char *pApn, const char *pUsername,
+                          const char *pPassword,
+                          bool (*pKeepGoingCallback) (uDeviceHandle_t cellHandle))
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    char buffer[15];  // At least 15 characters for the IMSI
+    const char *pApnConfig = NULL;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pInstance != NULL) &&
+            ((pUsername == NULL) || (pPassword != NULL))) {
+
+            errorCode = (int32_t) U_CELL_ERROR_NOT_CONNECTED;
+            if (uCellPrivateIsRegistered(pInstance)) {
+                // First deal with any existing context,
+                // which might turn out to be good enough
+                errorCode = handleExistingContext(pInstance, pApn,
+                                                  pKeepGoingCallback);
+                if (errorCode == 0) {
+                    pInstance->lastConnectPath = U_CELL_NET_CONNECT_PATH_EXISTING;
+                } else if (uCellPrivateIsRegistered(pInstance)) {
+                    // Still registered, so there was either no
+                    // context or it has been deactivated: try
+                    // just activating the one we have
+                    errorCode = activateExistingContext(pInstance, pApn,
+                                                        pKeepGoingCallback);
+                    if (errorCode == 0) {
+                        pInstance->lastConnectPath = U_CELL_NET_CONNECT_PATH_ACTIVATE;
+                        pInstance->profileState = U_CELL_PRIVATE_PROFILE_STATE_SHOULD_BE_UP;
+                        pInstance->connectedAtMs = uPortGetTickTimeMs();
+                        uPortLog("U_CELL_NET: connected by activating the existing"
+                                 " PDP context.\n");
+                    }
+                }
+            }
+
+            if (errorCode != 0) {
+                // Nope, no free ride, do some work
+                errorCode = prepareConnect(pInstance);
+                if (errorCode == 0) {
+                    if ((pApn == NULL) &&
+                        !uCellMnoDbProfileHas(pInstance,
+                                              U_CELL_MNO_DB_FEATURE_NO_CGDCONT) &&
+                        (uCellPrivateGetImsi(pInstance, buffer) == 0)) {
+                        // Set up the APN look-up since none is specified
+                        pApnConfig = pApnGetConfig(buffer);
+                    }
                     pInstance->pKeepGoingCallback = pKeepGoingCallback;
                     pInstance->startTimeMs = uPortGetTickTimeMs();
                     // Now try to connect, potentially multiple times
@@ -2194,6 +3064,7 @@ int32_t uCellNetConnect(uDeviceHandle_t cellHandle,
                         }
                         pInstance->profileState = U_CELL_PRIVATE_PROFILE_STATE_SHOULD_BE_UP;
                         pInstance->connectedAtMs = uPortGetTickTimeMs();
+                        pInstance->lastConnectPath = U_CELL_NET_CONNECT_PATH_FULL;
                         uPortLog("U_CELL_NET: connected after %d second(s).\n",
                                  (int32_t) ((uPortGetTickTimeMs() -
                                              pInstance->startTimeMs) / 1000));
@@ -2211,7 +3082,7 @@ int32_t uCellNetConnect(uDeviceHandle_t cellHandle,
                     pInstance->startTimeMs = 0;
 
                 }
-            } else {
+            } else if (pInstance->lastConnectPath == U_CELL_NET_CONNECT_PATH_EXISTING) {
                 uPortLog("U_CELL_NET: already connected.\n");
             }
         }
@@ -2222,10 +3093,10 @@ int32_t uCellNetConnect(uDeviceHandle_t cellHandle,
     return errorCode;
 }
 
-// Register with the cellular network.
-int32_t uCellNetRegister(uDeviceHandle_t cellHandle,
-                         const char *pMccMnc,
-                         bool (*pKeepGoingCallback) (uDeviceHandle_t cellHandle))
+// Register with the cellular network: the body of uCellNetRegister().
+static int32_t netRegister(uDeviceHandle_t cellHandle,
+                           const char *pMccMnc,
+                           bool (*pKeepGoingCallback) (uDeviceHandle_t cellHandle))
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance;
@@ -2302,6 +3173,48 @@ int32_t uCellNetRegister(uDeviceHandle_t cellHandle,
     return errorCode;
 }
 
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Register with the cellular network and activate a PDP context.
+int32_t uCellNetConnect(uDeviceHandle_t cellHandle,
+                        const char *pMccMnc,
+                        const char *pApn, const char *pUsername,
+                        const char *pPassword,
+                        bool (*pKeepGoingCallback) (uDeviceHandle_t cellHandle))
+{
+    int32_t errorCode;
+
+    errorCode = netConnect(cellHandle, pMccMnc, pApn, pUsername,
+                           pPassword, pKeepGoingCallback);
+    if (bandLearnOutcome(cellHandle, errorCode, pKeepGoingCallback)) {
+        // Band masks were narrowed and have now been widened: again
+        errorCode = netConnect(cellHandle, pMccMnc, pApn, pUsername,
+                               pPassword, pKeepGoingCallback);
+        bandLearnOutcome(cellHandle, errorCode, pKeepGoingCallback);
+    }
+
+    return errorCode;
+}
+
+// Register with the cellular network.
+int32_t uCellNetRegister(uDeviceHandle_t cellHandle,
+                         const char *pMccMnc,
+                         bool (*pKeepGoingCallback) (uDeviceHandle_t cellHandle))
+{
+    int32_t errorCode;
+
+    errorCode = netRegister(cellHandle, pMccMnc, pKeepGoingCallback);
+    if (bandLearnOutcome(cellHandle, errorCode, pKeepGoingCallback)) {
+        // Band masks were narrowed and have now been widened: again
+        errorCode = netRegister(cellHandle, pMccMnc, pKeepGoingCallback);
+        bandLearnOutcome(cellHandle, errorCode, pKeepGoingCallback);
+    }
+
+    return errorCode;
+}
+
 // Activate the PDP context.
 int32_t uCellNetActivate(uDeviceHandle_t cellHandle,
                          const char *pApn, const char *pUsername,
@@ -2481,6 +3394,99 @@ int32_t uCellNetDeactivate(uDeviceHandle_t cellHandle,
     return errorCode;
 }
 
+// Activate an additional PDP context.
+int32_t uCellNetActivateContext(uDeviceHandle_t cellHandle,
+                                int32_t contextId, const char *pApn,
+                                const char *pUsername, const char *pPassword,
+                                bool (*pKeepGoingCallback) (uDeviceHandle_t))
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pInstance != NULL) && (contextId > 0) &&
+            (contextId <= U_CELL_NET_MAX_NUM_CONTEXTS) &&
+            (contextId != U_CELL_NET_CONTEXT_ID) &&
+            (U_CELL_PRIVATE_PROFILE_ID(contextId) != U_CELL_NET_PROFILE_ID) &&
+            ((pUsername == NULL) || (pPassword != NULL))) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (U_CELL_PRIVATE_HAS_MULTIPLE_CONTEXTS(pInstance->pModule)) {
+                errorCode = (int32_t) U_CELL_ERROR_NOT_REGISTERED;
+                if (uCellPrivateIsRegistered(pInstance)) {
+                    pInstance->pKeepGoingCallback = pKeepGoingCallback;
+                    pInstance->startTimeMs = uPortGetTickTimeMs();
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    if (!isActive(pInstance, contextId)) {
+                        // Can only define a context that is not active
+                        errorCode = defineContext(pInstance, contextId, pApn);
+                        if ((errorCode == 0) && (pUsername != NULL)) {
+                            errorCode = setAuthenticationMode(pInstance,
+                                                              contextId,
+                                                              pUsername,
+                                                              pPassword);
+                        }
+                    }
+                    if (errorCode == 0) {
+                        // This also attaches the context to its profile
+                        errorCode = activateContext(pInstance, contextId,
+                                                    U_CELL_PRIVATE_PROFILE_ID(contextId));
+                    }
+                    pInstance->pKeepGoingCallback = NULL;
+                    pInstance->startTimeMs = 0;
+                    if (errorCode == 0) {
+                        uPortLog("U_CELL_NET: activated PDP context %d.\n",
+                                 contextId);
+                    } else {
+                        uPortLog("U_CELL_NET: unable to activate PDP context %d.\n",
+                                 contextId);
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Deactivate an additional PDP context.
+int32_t uCellNetDeactivateContext(uDeviceHandle_t cellHandle,
+                                  int32_t contextId)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pInstance != NULL) && (contextId > 0) &&
+            (contextId <= U_CELL_NET_MAX_NUM_CONTEXTS) &&
+            (contextId != U_CELL_NET_CONTEXT_ID)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (U_CELL_PRIVATE_HAS_MULTIPLE_CONTEXTS(pInstance->pModule)) {
+                errorCode = deactivate(pInstance, contextId);
+                if (errorCode != 0) {
+                    uPortLog("U_CELL_NET: unable to deactivate PDP context %d.\n",
+                             contextId);
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
 // Disconnect from the network.
 int32_t uCellNetDisconnect(uDeviceHandle_t cellHandle,
                            bool (*pKeepGoingCallback) (uDeviceHandle_t cellHandle))
@@ -2523,6 +3529,11 @@ int32_t uCellNetDisconnect(uDeviceHandle_t cellHandle,
         }
 
         U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+
+        if (errorCode == 0) {
+            // Now is the time to set band masks, for the next boot
+            bandLearnNarrow(cellHandle);
+        }
     }
 
     return errorCode;
@@ -2536,15 +3547,6 @@ int32_t uCellNetScanGetFirst(uDeviceHandle_t cellHandle,
 {
     int32_t errorCodeOrNumber = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance;
-    uAtClientHandle_t atHandle;
-    char *pBuffer;
-    int32_t bytesRead;
-    int32_t mode;
-    int64_t innerStartTimeMs;
-    uAtClientDeviceError_t deviceError;
-    bool gotAnswer = false;
-    char *pSaved;
-    char *pStr;
 
     if (gUCellPrivateMutex != NULL) {
 
@@ -2554,116 +3556,48 @@ int32_t uCellNetScanGetFirst(uDeviceHandle_t cellHandle,
         errorCodeOrNumber = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) &&
             ((pName == NULL) || (nameSize > 0))) {
-            atHandle = pInstance->atHandle;
             // Free any previous scan results
             uCellPrivateScanFree(&(pInstance->pScanResults));
-            errorCodeOrNumber = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-            // Allocate some temporary storage
-            pBuffer = (char *) pUPortMalloc(U_CELL_NET_SCAN_LENGTH_BYTES);
-            if (pBuffer != NULL) {
-                errorCodeOrNumber = (int32_t) U_CELL_ERROR_TEMPORARY_FAILURE;
-                // Ensure that we're powered up.
-                mode = uCellPrivateCFunOne(pInstance);
-                // Start a scan
-                // Do this three times: if the module
-                // is busy doing its own search when we ask it
-                // to do a network search, as it might be if
-                // we've just come out of airplane mode,
-                // it will ignore us and simply return the
-                // "test" response to the AT+COPS=? command,
-                // i.e.: +COPS: ,,(0-6),(0-2)
-                // If we get the "test" response instead
-                // readBytes will be 12 whereas for the
-                // intended response of:
-                // (<stat>,<long_name>,<short_name>,<numeric>[,<AcT>])
-                // it will be at longer than that hence we set
-                // a threshold for readBytes of > 12 characters.
-                pInstance->startTimeMs = uPortGetTickTimeMs();
-                for (size_t x = U_CELL_NET_SCAN_RETRIES + 1;
-                     (x > 0) && (errorCodeOrNumber <= 0) &&
-                     ((pKeepGoingCallback == NULL) || (pKeepGoingCallback(cellHandle)));
-                     x--) {
-                    uAtClientLock(atHandle);
-                    // Set the timeout to a second so that we
-                    // can spin around the loop
-                    gotAnswer = false;
-                    uAtClientTimeoutSet(atHandle, 1000);
-                    uAtClientCommandStart(atHandle, "AT+COPS=?");
-                    uAtClientCommandStop(atHandle);
-                    // Will get back "+COPS:" then a single line consisting of
-                    // comma delimited list of
-                    // (<stat>,<long_name>,<short_name>,<numeric>[,<AcT>])
-                    // ...plus some other stuff on the end.
-                    // Sit in a loop waiting for a response
-                    // of some form to arrive
-                    bytesRead = -1;
-                    innerStartTimeMs = uPortGetTickTimeMs();
-                    while ((bytesRead <= 0) &&
-                           (uPortGetTickTimeMs() - innerStartTimeMs <
-                            (U_CELL_NET_SCAN_TIME_SECONDS * 1000)) &&
-                           ((pKeepGoingCallback == NULL) || (pKeepGoingCallback(cellHandle)))) {
-                        uAtClientResponseStart(atHandle, "+COPS:");
-                        // We use uAtClientReadBytes() here because the
-                        // thing we're reading contains quotation marks
-                        // but we do actually want to end up with a string,
-                        // so leave room to add a terminator
-                        bytesRead = uAtClientReadBytes(atHandle, pBuffer,
-                                                       U_CELL_NET_SCAN_LENGTH_BYTES - 1,
-                                                       false);
-                        if (bytesRead >= 0) {
-                            // Add a terminator
-                            *(pBuffer + bytesRead) = 0;
-                        }
-                        // Check if an error has been returned by the module,
-                        // e.g. +CME ERROR: Temporary Failure, and if
-                        // so exit the while() loop and try AT+COPS=? again.
-                        uAtClientDeviceErrorGet(atHandle, &deviceError);
-                        if (deviceError.type != U_AT_CLIENT_DEVICE_ERROR_TYPE_NO_ERROR) {
-                            // Purely to exit the while() loop and cause us to
-                            // try gain in the outer for() loop
-                            bytesRead = 1;
-                        }
-                        uAtClientClearError(atHandle);
-                        uPortTaskBlock(1000);
-                    }
-                    if (bytesRead > 0) {
-                        // Got _something_ back, but it may still be the
-                        // "test" response or a device error
-                        gotAnswer = true;
-                    }
-                    if (bytesRead > 12) {
-                        // Got a real answer: process it in
-                        // chunks delimited by ")"
-                        for (pStr = strtok_r(pBuffer, ")", &pSaved);
-                             pStr != NULL;
-                             pStr = strtok_r(NULL, ")", &pSaved)) {
-                            errorCodeOrNumber = storeNextScanItem(pInstance, pStr);
-                        }
-                    }
-                    uAtClientResponseStop(atHandle);
-                    uAtClientUnlock(atHandle);
-                    if (!gotAnswer) {
-                        // If we never got an answer, abort the
-                        // command first.
-                        abortCommand(pInstance);
-                    }
-                }
+            errorCodeOrNumber = scan(pInstance, storeScanItem, NULL,
+                                     pKeepGoingCallback);
+            if (errorCodeOrNumber != (int32_t) U_ERROR_COMMON_TIMEOUT) {
+                // Return the first thing from what we stored
+                readNextScanItem(pInstance, pMccMnc, pName,
+                                 nameSize, pRat);
+            }
+        }
 
-                // Free memory
-                uPortFree(pBuffer);
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
 
-                // Put the mode back if it was not already 1
-                if ((mode >= 0) && (mode != 1)) {
-                    uCellPrivateCFunMode(pInstance, mode);
-                }
-                if (gotAnswer) {
-                    // Return the first thing from what we stored
-                    readNextScanItem(pInstance, pMccMnc, pName,
-                                     nameSize, pRat);
-                } else {
-                    errorCodeOrNumber = (int32_t) U_ERROR_COMMON_TIMEOUT;
-                }
-            }
+    return errorCodeOrNumber;
+}
+
+// Perform a network scan, passing each result to a callback.
+int32_t uCellNetScan(uDeviceHandle_t cellHandle,
+                     bool (*pCallback) (uDeviceHandle_t cellHandle,
+                                        const char *pName,
+                                        const char *pMccMnc,
+                                        uCellNetRat_t rat,
+                                        void *pCallbackParam),
+                     void *pCallbackParam,
+                     bool (*pKeepGoingCallback) (uDeviceHandle_t cellHandle))
+{
+    int32_t errorCodeOrNumber = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellNetScanStream_t stream;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCodeOrNumber = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pInstance != NULL) && (pCallback != NULL)) {
+            stream.pCallback = pCallback;
+            stream.pCallbackParam = pCallbackParam;
+            errorCodeOrNumber = scan(pInstance, streamScanItem, &stream,
+                                     pKeepGoingCallback);
         }
 
         U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
@@ -2779,6 +3713,8 @@ int32_t uCellNetSetBaseStationConnectionStatusCallback(uDeviceHandle_t cellHandl
                 } else {
                     uAtClientRemoveUrcHandler(pInstance->atHandle, "+CSCON:");
                     pInstance->pConnectionStatusCallback = NULL;
+                    // No longer tracked
+                    pInstance->baseStationConnection = -1;
                 }
                 // Switch the URC on or off
                 uAtClientLock(atHandle);
@@ -2795,6 +3731,31 @@ int32_t uCellNetSetBaseStationConnectionStatusCallback(uDeviceHandle_t cellHandl
     return errorCode;
 }
 
+// Get the base station connection state last indicated by the module.
+int32_t uCellNetGetBaseStationConnection(uDeviceHandle_t cellHandle)
+{
+    int32_t errorCodeOrState = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCodeOrState = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pInstance != NULL) {
+            errorCodeOrState = (int32_t) U_ERROR_COMMON_UNKNOWN;
+            if (pInstance->baseStationConnection >= 0) {
+                errorCodeOrState = pInstance->baseStationConnection;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCodeOrState;
+}
+
 // Get the current network registration status.
 uCellNetStatus_t uCellNetGetNetworkStatus(uDeviceHandle_t cellHandle,
                                           uCellNetRegDomain_t domain)
@@ -2861,6 +3822,28 @@ uCellNetRat_t uCellNetGetActiveRat(uDeviceHandle_t cellHandle)
     return (uCellNetRat_t) errorCodeOrRat;
 }
 
+// Get the route taken by the last successful uCellNetConnect().
+int32_t uCellNetGetLastConnectPath(uDeviceHandle_t cellHandle)
+{
+    int32_t errorCodeOrPath = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCodeOrPath = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pInstance != NULL) {
+            errorCodeOrPath = (int32_t) pInstance->lastConnectPath;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCodeOrPath;
+}
+
 // Get the operator name.
 int32_t uCellNetGetOperatorStr(uDeviceHandle_t cellHandle,
                                char *pStr, size_t size)
@@ -3126,10 +4109,8 @@ int32_t uCellNetGetDataCounterTx(uDeviceHandle_t cellHandle)
 {
     int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance;
-    uAtClientHandle_t atHandle;
-    bool ours = false;
     int32_t bytesSent = 0;
-    int32_t y = 0;
+    int32_t bytesReceived = 0;
 
     if (gUCellPrivateMutex != NULL) {
 
@@ -3141,26 +4122,15 @@ int32_t uCellNetGetDataCounterTx(uDeviceHandle_t cellHandle)
             errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
             if (U_CELL_PRIVATE_HAS(pInstance->pModule,
                                    U_CELL_PRIVATE_FEATURE_DATA_COUNTERS)) {
-                errorCodeOrCount = (int32_t) U_CELL_ERROR_AT;
-                atHandle = pInstance->atHandle;
-                uAtClientLock(atHandle);
-                uAtClientCommandStart(atHandle, "AT+UGCNTRD");
-                uAtClientCommandStop(atHandle);
-                for (size_t x = 0; (x < U_CELL_NET_MAX_NUM_CONTEXTS) &&
-                     (y >= 0) && !ours; x++) {
-                    uAtClientResponseStart(atHandle, "+UGCNTRD:");
-                    // Check if this is our context ID
-                    y = uAtClientReadInt(atHandle);
-                    if (y == U_CELL_NET_CONTEXT_ID) {
-                        ours = true;
-                        // If it is, the next byte is the sent
-                        // count for this session
-                        bytesSent = uAtClientReadInt(atHandle);
+                errorCodeOrCount = getDataCounters(pInstance, &bytesSent,
+                                                   &bytesReceived);
+                if (errorCodeOrCount == 0) {
+                    if (pInstance->pDataCounterSamplerContext != NULL) {
+                        // Save the sampler the trouble
+                        dataCounterSamplerUpdate(pInstance->pDataCounterSamplerContext,
+                                                 errorCodeOrCount, bytesSent,
+                                                 bytesReceived);
                     }
-                }
-                uAtClientResponseStop(atHandle);
-                if ((uAtClientUnlock(atHandle) == 0) && ours &&
-                    (bytesSent >= 0)) {
                     errorCodeOrCount = bytesSent;
                 }
             }
@@ -3177,10 +4147,8 @@ int32_t uCellNetGetDataCounterRx(uDeviceHandle_t cellHandle)
 {
     int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance;
-    uAtClientHandle_t atHandle;
-    bool ours = false;
+    int32_t bytesSent = 0;
     int32_t bytesReceived = 0;
-    int32_t y = 0;
 
     if (gUCellPrivateMutex != NULL) {
 
@@ -3192,27 +4160,15 @@ int32_t uCellNetGetDataCounterRx(uDeviceHandle_t cellHandle)
             errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
             if (U_CELL_PRIVATE_HAS(pInstance->pModule,
                                    U_CELL_PRIVATE_FEATURE_DATA_COUNTERS)) {
-                errorCodeOrCount = (int32_t) U_CELL_ERROR_AT;
-                atHandle = pInstance->atHandle;
-                uAtClientLock(atHandle);
-                uAtClientCommandStart(atHandle, "AT+UGCNTRD");
-                uAtClientCommandStop(atHandle);
-                for (size_t x = 0; (x < U_CELL_NET_MAX_NUM_CONTEXTS) &&
-                     (y >= 0) && !ours; x++) {
-                    uAtClientResponseStart(atHandle, "+UGCNTRD:");
-                    // Check if this is our context ID
-                    y = uAtClientReadInt(atHandle);
-                    if (y == U_CELL_NET_CONTEXT_ID) {
-                        ours = true;
-                        // Skip the transmitted byte count
-                        uAtClientSkipParameters(atHandle, 1);
-                        // Get the received count for this session
-                        bytesReceived = uAtClientReadInt(atHandle);
+                errorCodeOrCount = getDataCounters(pInstance, &bytesSent,
+                                                   &bytesReceived);
+                if (errorCodeOrCount == 0) {
+                    if (pInstance->pDataCounterSamplerContext != NULL) {
+                        // Save the sampler the trouble
+                        dataCounterSamplerUpdate(pInstance->pDataCounterSamplerContext,
+                                                 errorCodeOrCount, bytesSent,
+                                                 bytesReceived);
                     }
-                }
-                uAtClientResponseStop(atHandle);
-                if ((uAtClientUnlock(atHandle) == 0) && ours &&
-                    (bytesReceived >= 0)) {
                     errorCodeOrCount = bytesReceived;
                 }
             }
@@ -3258,4 +4214,238 @@ int32_t uCellNetResetDataCounters(uDeviceHandle_t cellHandle)
     return errorCode;
 }
 
+// Start the background data counter sampler.
+int32_t uCellNetDataCounterSamplerStart(uDeviceHandle_t cellHandle,
+                                        uCellNetDataCounterSampler_t *pSampler,
+                                        int32_t periodMs,
+                                        int32_t thresholdBytes,
+                                        void (*pCallback) (uDeviceHandle_t cellHandle,
+                                                           void *pCallbackParam),
+                                        void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellPrivateDataCounterSamplerContext_t *pContext;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pInstance != NULL) && (pSampler != NULL) &&
+            (periodMs >= U_CELL_NET_DATA_COUNTER_SAMPLER_PERIOD_MIN_MS) &&
+            (pInstance->pDataCounterSamplerContext == NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (U_CELL_PRIVATE_HAS(pInstance->pModule,
+                                   U_CELL_PRIVATE_FEATURE_DATA_COUNTERS)) {
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                pContext = (uCellPrivateDataCounterSamplerContext_t *) pUPortMalloc(sizeof(*pContext));
+                if (pContext != NULL) {
+                    memset(pContext, 0, sizeof(*pContext));
+                    memset(pSampler, 0, sizeof(*pSampler));
+                    pContext->cellHandle = cellHandle;
+                    pContext->pSampler = pSampler;
+                    pContext->periodMs = periodMs;
+                    pContext->thresholdBytes = thresholdBytes;
+                    pContext->pCallback = pCallback;
+                    pContext->pCallbackParam = pCallbackParam;
+                    pContext->lastTxBytes = -1;
+                    pContext->lastRxBytes = -1;
+                    pContext->txBytesPerSecond = -1;
+                    pContext->rxBytesPerSecond = -1;
+                    pSampler->txBytesPerSecond = -1;
+                    pSampler->rxBytesPerSecond = -1;
+                    pContext->keepGoing = true;
+                    errorCode = uPortMutexCreate(&(pContext->taskRunningMutex));
+                    if (errorCode == 0) {
+                        errorCode = uTaskRegistryTaskCreate(dataCounterSamplerTask, "cellDataCounter",
+                                                            U_CELL_NET_DATA_COUNTER_SAMPLER_TASK_STACK_SIZE_BYTES,
+                                                            pContext,
+                                                            U_CELL_NET_DATA_COUNTER_SAMPLER_TASK_PRIORITY,
+                                                            &(pContext->taskHandle));
+                        if (errorCode == 0) {
+                            pInstance->pDataCounterSamplerContext = pContext;
+                        } else {
+                            uPortMutexDelete(pContext->taskRunningMutex);
+                        }
+                    }
+                    if (errorCode != 0) {
+                        uPortFree(pContext);
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Get the latest sample from the background data counter sampler.
+int32_t uCellNetDataCounterSamplerGet(const uCellNetDataCounterSampler_t *pSampler,
+                                      uCellNetDataCounterSample_t *pSample)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uint32_t sequence;
+
+    if ((pSampler != NULL) && (pSample != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_TEMPORARY_FAILURE;
+        // Don't spin for ever: the sampler task may be of lower
+        // priority than the caller
+        for (size_t x = 0; (x < U_CELL_NET_DATA_COUNTER_SAMPLER_GET_TRIES) &&
+             (errorCode == (int32_t) U_ERROR_COMMON_TEMPORARY_FAILURE); x++) {
+            sequence = pSampler->sequence;
+            pSample->txBytes = pSampler->txBytes;
+            pSample->rxBytes = pSampler->rxBytes;
+            pSample->txBytesPerSecond = pSampler->txBytesPerSecond;
+            pSample->rxBytesPerSecond = pSampler->rxBytesPerSecond;
+            pSample->errorCode = pSampler->errorCode;
+            pSample->timeMs = pSampler->timeMs;
+            pSample->count = pSampler->count;
+            if (((sequence & 1) == 0) && (sequence == pSampler->sequence)) {
+                errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+                if (pSample->count > 0) {
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                }
+            } else {
+                uPortTaskBlock(1);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Stop the background data counter sampler.
+void uCellNetDataCounterSamplerStop(uDeviceHandle_t cellHandle)
+{
+    uCellPrivateInstance_t *pInstance;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        if (pInstance != NULL) {
+            uCellPrivateDataCounterSamplerRemoveContext(pInstance);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: BAND LEARNING
+ * -------------------------------------------------------------- */
+
+// Start band learning.
+int32_t uCellNetBandLearnStart(uDeviceHandle_t cellHandle,
+                               const char *pFileName)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellNetBandLearnContext_t *pContext;
+
+    if (gUCellPrivateMutex != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pFileName == NULL) ||
+            (strlen(pFileName) <= U_CELL_FILE_NAME_MAX_LENGTH)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pContext = (uCellNetBandLearnContext_t *) pUPortMalloc(sizeof(*pContext));
+            if (pContext != NULL) {
+                memset(pContext, 0, sizeof(*pContext));
+                pContext->store.version = U_CELL_NET_BAND_LEARN_STORE_VERSION;
+                if (pFileName != NULL) {
+                    strncpy(pContext->fileName, pFileName, sizeof(pContext->fileName));
+                    // Read in what has been learnt before, the file
+                    // not being there being fine
+                    if ((uCellFileRead(cellHandle, pFileName, (char *) &(pContext->store),
+                                       sizeof(pContext->store)) != (int32_t) sizeof(pContext->store)) ||
+                        (pContext->store.version != U_CELL_NET_BAND_LEARN_STORE_VERSION)) {
+                        memset(&(pContext->store), 0, sizeof(pContext->store));
+                        pContext->store.version = U_CELL_NET_BAND_LEARN_STORE_VERSION;
+                    }
+                }
+
+                U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+                pInstance = pUCellPrivateGetInstance(cellHandle);
+                errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+                if (pInstance != NULL) {
+                    errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                    if (pInstance->pBandLearnContext == NULL) {
+                        pInstance->pBandLearnContext = pContext;
+                        pContext = NULL;
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    }
+                }
+
+                U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+
+                // Free it if it didn't get used
+                uPortFree(pContext);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Get the band mask that has been learnt for an MCC and RAT.
+int32_t uCellNetBandLearnGet(uDeviceHandle_t cellHandle,
+                             int32_t mcc, uCellNetRat_t rat,
+                             uint64_t *pBandMask1, uint64_t *pBandMask2)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uCellNetBandLearnContext_t *pContext;
+
+    if ((pBandMask1 != NULL) && (pBandMask2 != NULL)) {
+        pContext = pBandLearnLock(cellHandle);
+        if (pContext != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+            for (size_t x = 0; (x < U_CELL_NET_BAND_LEARN_MAX_NUM) &&
+                 (errorCode != 0); x++) {
+                if ((pContext->store.entry[x].mcc == mcc) && (mcc != 0) &&
+                    (pContext->store.entry[x].rat == (int32_t) rat)) {
+                    *pBandMask1 = pContext->store.entry[x].bandMask1;
+                    *pBandMask2 = pContext->store.entry[x].bandMask2;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                }
+            }
+            uPortMutexUnlock(gUCellPrivateMutex);
+        }
+    }
+
+    return errorCode;
+}
+
+// Stop band learning.
+int32_t uCellNetBandLearnStop(uDeviceHandle_t cellHandle)
+{
+    int32_t errorCode;
+    uCellPrivateInstance_t *pInstance;
+
+    errorCode = bandLearnWiden(cellHandle);
+    if (errorCode > 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        if (pInstance != NULL) {
+            uPortFree(pInstance->pBandLearnContext);
+            pInstance->pBandLearnContext = NULL;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
 // End of file
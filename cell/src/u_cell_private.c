@@ -47,12 +47,15 @@
 
 #include "u_security.h"
 
+#include "u_device_shared.h"
+
 #include "u_cell_module_type.h"
 #include "u_cell_file.h" // U_CELL_FILE_NAME_MAX_LENGTH
 #include "u_cell.h"         // Order is
 #include "u_cell_net.h"     // important here
 #include "u_cell_private.h" // don't change it
 #include "u_cell_sec_c2c.h"
+#include "u_cell_pwr.h"
 #include "u_cell_pwr_private.h"
 
 /* ----------------------------------------------------------------
@@ -86,18 +89,7 @@ const uCellPrivateModule_t gUCellPrivateModuleList[] = {
         2 /* Simultaneous RATs */,
         ((1ULL << (int32_t) U_CELL_NET_RAT_GSM_GPRS_EGPRS) |
          (1ULL << (int32_t) U_CELL_NET_RAT_UTRAN)) /* RATs */,
-        ((1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_USE_UPSD_CONTEXT_ACTIVATION) |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CONTEXT_MAPPING_REQUIRED)    |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_AUTO_BAUDING)                |
-         // In theory SARA-U201 does support DTR power saving however we do not
-         // have this in our regression test farm and hence it is not marked
-         // as supported for now
-         // (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_DTR_POWER_SAVING)
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_AT_PROFILES)                 |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CTS_CONTROL)                 |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SOCK_SET_LOCAL_PORT)         |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UART_POWER_SAVING) /* features */
-        )
+        U_CELL_PRIVATE_FEATURES_SARA_U201 /* features */
     },
     {
         U_CELL_MODULE_TYPE_SARA_R410M_02B, 300 /* Pwr On pull ms */, 2000 /* Pwr off pull ms */,
@@ -106,21 +98,7 @@ const uCellPrivateModule_t gUCellPrivateModuleList[] = {
         2 /* Simultaneous RATs */,
         ((1ULL << (int32_t) U_CELL_NET_RAT_CATM1)          |
          (1ULL << (int32_t) U_CELL_NET_RAT_NB1)) /* RATs */,
-        ((1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MNO_PROFILE)        |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_ASYNC_SOCK_CLOSE)   |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT)               |
-         // In theory SARA-R410M does support keep alive but I have been
-         // unable to make it work (always returns error) and hence this is
-         // not marked as supported for now
-         // (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_KEEP_ALIVE)         |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_SARA_R4_OLD_SYNTAX) |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UCGED5)                  |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FILE_SYSTEM_TAG)         |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_3GPP_POWER_SAVING)       |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_EDRX)                    |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FOTA)                    |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UART_POWER_SAVING) /* features */
-        )
+        U_CELL_PRIVATE_FEATURES_SARA_R410M_02B /* features */
     },
     {
         U_CELL_MODULE_TYPE_SARA_R412M_02B, 300 /* Pwr On pull ms */, 2000 /* Pwr off pull ms */,
@@ -130,25 +108,7 @@ const uCellPrivateModule_t gUCellPrivateModuleList[] = {
         ((1ULL << (int32_t) U_CELL_NET_RAT_GSM_GPRS_EGPRS) |
          (1ULL << (int32_t) U_CELL_NET_RAT_CATM1)          |
          (1ULL << (int32_t) U_CELL_NET_RAT_NB1)) /* RATs */,
-        ((1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MNO_PROFILE)                            |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CSCON)                                  |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_ASYNC_SOCK_CLOSE)                       |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SERVER_NAME_INDICATION)    |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT)                                |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_SARA_R4_OLD_SYNTAX)             |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_SET_LOCAL_PORT)                 |
-         // In theory SARA-R412M does support keep alive but I have been
-         // unable to make it work (always returns error) and hence this is
-         // not marked as supported for now
-         // (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_KEEP_ALIVE)                     |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_SESSION_RETAIN)                 |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UCGED5)                              |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FILE_SYSTEM_TAG)                     |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_3GPP_POWER_SAVING)                   |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_EDRX)                                |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FOTA)                                |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UART_POWER_SAVING) /* features */
-        )
+        U_CELL_PRIVATE_FEATURES_SARA_R412M_02B /* features */
     },
     {
         U_CELL_MODULE_TYPE_SARA_R412M_03B, 300 /* Pwr On pull ms */, 2000 /* Pwr off pull ms */,
@@ -158,16 +118,7 @@ const uCellPrivateModule_t gUCellPrivateModuleList[] = {
         ((1ULL << (int32_t) U_CELL_NET_RAT_GSM_GPRS_EGPRS) |
          (1ULL << (int32_t) U_CELL_NET_RAT_CATM1)          |
          (1ULL << (int32_t) U_CELL_NET_RAT_NB1)) /* RATs */,
-        ((1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MNO_PROFILE)                         |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CSCON)                               |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SERVER_NAME_INDICATION) |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UCGED5)                              |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FILE_SYSTEM_TAG)                     |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_DEEP_SLEEP_URC)                      |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_3GPP_POWER_SAVING)                   |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_EDRX)                                |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UART_POWER_SAVING) /* features */
-        )
+        U_CELL_PRIVATE_FEATURES_SARA_R412M_03B /* features */
     },
     {
         U_CELL_MODULE_TYPE_SARA_R5, 1500 /* Pwr On pull ms */, 2000 /* Pwr off pull ms */,
@@ -180,35 +131,7 @@ const uCellPrivateModule_t gUCellPrivateModuleList[] = {
         ((1ULL << (int32_t) U_CELL_NET_RAT_CATM1) |
          (1ULL << (int32_t) U_CELL_NET_RAT_NB1)) /* RATs */,
 #endif
-        ((1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MNO_PROFILE)                         |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CSCON)                               |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_ROOT_OF_TRUST)                       |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_C2C)                        |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_DATA_COUNTERS)                       |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_IANA_NUMBERING)         |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_CIPHER_LIST)            |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SERVER_NAME_INDICATION) |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT)                                |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_BINARY_PUBLISH)                 |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_WILL)                           |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_KEEP_ALIVE)                     |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_SECURITY)                       |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CONTEXT_MAPPING_REQUIRED)            |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_AUTO_BAUDING)                        |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_AT_PROFILES)                         |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_ZTP)                        |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FILE_SYSTEM_TAG)                     |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_DTR_POWER_SAVING)                    |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_DEEP_SLEEP_URC)                      |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_3GPP_POWER_SAVING)                   |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_3GPP_POWER_SAVING_PAGING_WINDOW_SET) |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_EDRX)                                |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTTSN)                              |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CTS_CONTROL)                         |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SOCK_SET_LOCAL_PORT)                 |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FOTA)                                |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UART_POWER_SAVING) /* features */
-        )
+        U_CELL_PRIVATE_FEATURES_SARA_R5 /* features */
     },
     {
         U_CELL_MODULE_TYPE_SARA_R410M_03B, 300 /* Pwr On pull ms */, 2000 /* Pwr off pull ms */,
@@ -217,19 +140,7 @@ const uCellPrivateModule_t gUCellPrivateModuleList[] = {
         2 /* Simultaneous RATs */,
         ((1ULL << (int32_t) U_CELL_NET_RAT_CATM1)          |
          (1ULL << (int32_t) U_CELL_NET_RAT_NB1)) /* RATs */,
-        ((1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MNO_PROFILE)                         |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CSCON)                               |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SERVER_NAME_INDICATION) |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT)                                |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_KEEP_ALIVE)                     |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_SECURITY)                       |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UCGED5)                              |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FILE_SYSTEM_TAG)                     |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_DEEP_SLEEP_URC)                      |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_3GPP_POWER_SAVING)                   |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_EDRX)                                |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UART_POWER_SAVING) /* features */
-        )
+        U_CELL_PRIVATE_FEATURES_SARA_R410M_03B /* features */
     },
     {
         U_CELL_MODULE_TYPE_SARA_R422, 300 /* Pwr On pull ms */, 2000 /* Pwr off pull ms */,
@@ -239,31 +150,7 @@ const uCellPrivateModule_t gUCellPrivateModuleList[] = {
         ((1ULL << (int32_t) U_CELL_NET_RAT_GSM_GPRS_EGPRS) |
          (1ULL << (int32_t) U_CELL_NET_RAT_CATM1)          |
          (1ULL << (int32_t) U_CELL_NET_RAT_NB1)) /* RATs */,
-        ((1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MNO_PROFILE)                         |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CSCON)                               |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_ROOT_OF_TRUST)                       |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_ASYNC_SOCK_CLOSE)                    |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_IANA_NUMBERING)         |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SERVER_NAME_INDICATION) |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT)                                |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_BINARY_PUBLISH)                 |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_WILL)                           |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_KEEP_ALIVE)                     |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_SECURITY)                       |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CONTEXT_MAPPING_REQUIRED)            |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FILE_SYSTEM_TAG)                     |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_DEEP_SLEEP_URC)                      |
-         // SARA-R422 _does_ support 3GPP power saving, however the tests fail at the
-         // moment because a second attempt to enter 3GPP power saving, after waking-up
-         // from sleep to do something, fails, hence the support is disabled until
-         // we determine why that is
-         //(1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_3GPP_POWER_SAVING)                   |
-         //(1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_3GPP_POWER_SAVING_PAGING_WINDOW_SET) |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_EDRX)                                  |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTTSN)                                |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FOTA)                                  |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UART_POWER_SAVING) /* features */
-        )
+        U_CELL_PRIVATE_FEATURES_SARA_R422 /* features */
     },
     {
         U_CELL_MODULE_TYPE_LARA_R6, 300 /* Pwr On pull ms */, 2000 /* Pwr off pull ms */,
@@ -273,22 +160,7 @@ const uCellPrivateModule_t gUCellPrivateModuleList[] = {
         ((1ULL << (int32_t) U_CELL_NET_RAT_GSM_GPRS_EGPRS) |
          (1ULL << (int32_t) U_CELL_NET_RAT_LTE)            |
          (1ULL << (int32_t) U_CELL_NET_RAT_UTRAN)) /* RATs */,
-        ((1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MNO_PROFILE)                         |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CSCON)                               |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_ROOT_OF_TRUST)                       |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_IANA_NUMBERING)         |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SERVER_NAME_INDICATION) |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT)                                |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_BINARY_PUBLISH)                 |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_WILL)                           |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_KEEP_ALIVE)                     |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_SECURITY)                       |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FILE_SYSTEM_TAG)                     |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_DTR_POWER_SAVING)                    |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTTSN)                              |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SOCK_SET_LOCAL_PORT)                 |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FOTA) /* features */
-        )
+        U_CELL_PRIVATE_FEATURES_LARA_R6 /* features */
     }
 };
 
@@ -478,17 +350,47 @@ bool uCellPrivateIsNumeric(const char *pBuffer, size_t bufferSize)
 }
 
 // Find a cellular instance in the list by instance handle.
-uCellPrivateInstance_t *pUCellPrivateGetInstance(uDeviceHandle_t cellHandle)
+// Note: the brackets around the name prevent the macro form
+// of pUCellPrivateGetInstance() from being expanded here.
+// This is called on every API call so, rather than searching
+// the list, the instance is taken directly from the device
+// instance, checking that it really does belong to us.
+uCellPrivateInstance_t *(pUCellPrivateGetInstance)(uDeviceHandle_t cellHandle)
 {
-    uCellPrivateInstance_t *pInstance = gpUCellPrivateInstanceList;
-
-    while ((pInstance != NULL) && (pInstance->cellHandle != cellHandle)) {
-        pInstance = pInstance->pNext;
+    uCellPrivateInstance_t *pInstance = NULL;
+    uDeviceInstance_t *pDevInstance = U_DEVICE_INSTANCE(cellHandle);
+
+    if (uDeviceIsValidInstance(pDevInstance) &&
+        (pDevInstance->deviceType == U_DEVICE_TYPE_CELL)) {
+        pInstance = (uCellPrivateInstance_t *) pDevInstance->pDriverInstance;
+        if ((pInstance != NULL) && (pInstance->cellHandle != cellHandle)) {
+            pInstance = NULL;
+        }
     }
 
     return pInstance;
 }
 
+// Find a cellular instance and tag its AT client.
+uCellPrivateInstance_t *pUCellPrivateGetInstanceTag(uDeviceHandle_t cellHandle,
+                                                    const char *pTag)
+{
+    uCellPrivateInstance_t *pInstance = (pUCellPrivateGetInstance)(cellHandle);
+
+    uCellPrivateAtStatsTag(pInstance, pTag);
+
+    return pInstance;
+}
+
+// Tag the AT client of an instance.
+void uCellPrivateAtStatsTag(const uCellPrivateInstance_t *pInstance,
+                            const char *pTag)
+{
+    if (pInstance != NULL) {
+        uAtClientStatsTagSet(pInstance->atHandle, pTag);
+    }
+}
+
 // Set the radio parameters back to defaults.
 void uCellPrivateClearRadioParameters(uCellPrivateRadioParameters_t *pParameters)
 {
@@ -500,8 +402,8 @@ void uCellPrivateClearRadioParameters(uCellPrivateRadioParameters_t *pParameters
 }
 
 // Clear the dynamic parameters of an instance,
-// so the network status, the active RAT and
-// the radio parameters.
+// so the network status, the active RAT, the
+// radio parameters and the identity cache.
 void uCellPrivateClearDynamicParameters(uCellPrivateInstance_t *pInstance)
 {
     for (size_t x = 0;
@@ -515,6 +417,20 @@ void uCellPrivateClearDynamicParameters(uCellPrivateInstance_t *pInstance)
         pInstance->rat[x] = U_CELL_NET_RAT_UNKNOWN_OR_NOT_USED;
     }
     uCellPrivateClearRadioParameters(&(pInstance->radioParameters));
+    uCellPrivateClearIdCache(pInstance, false);
+    pInstance->restoredFromDeepSleep = false;
+}
+
+// Clear the cached identity information of an instance.
+void uCellPrivateClearIdCache(uCellPrivateInstance_t *pInstance,
+                              bool simOnly)
+{
+    if (simOnly) {
+        pInstance->idCache.imsiValid = false;
+        pInstance->idCache.iccid.valid = false;
+    } else {
+        memset(&(pInstance->idCache), 0, sizeof(pInstance->idCache));
+    }
 }
 
 // Get the current CFUN mode.
@@ -590,6 +506,8 @@ void uCellPrivateCFunMode(uCellPrivateInstance_t *pInstance,
         // longer than your average response time
         uAtClientTimeoutSet(atHandle,
                             U_CELL_PRIVATE_AT_CFUN_OFF_RESPONSE_TIME_SECONDS * 1000);
+        // The SIM may be changed while the radio is off
+        uCellPrivateClearIdCache(pInstance, true);
     }
     uAtClientCommandStart(atHandle, "AT+CFUN=");
     uAtClientWriteInt(atHandle, mode);
@@ -761,13 +679,9 @@ void uCellPrivateScanFree(uCellPrivateNet_t **ppScanResults)
 // Get the module characteristics for a given instance.
 const uCellPrivateModule_t *pUCellPrivateGetModule(uDeviceHandle_t cellHandle)
 {
-    uCellPrivateInstance_t *pInstance = gpUCellPrivateInstanceList;
+    uCellPrivateInstance_t *pInstance = (pUCellPrivateGetInstance)(cellHandle);
     const uCellPrivateModule_t *pModule = NULL;
 
-    while ((pInstance != NULL) && (pInstance->cellHandle != cellHandle)) {
-        pInstance = pInstance->pNext;
-    }
-
     if (pInstance != NULL) {
         pModule = pInstance->pModule;
     }
@@ -802,6 +716,33 @@ void uCellPrivateC2cRemoveContext(uCellPrivateInstance_t *pInstance)
     }
 }
 
+// Empty a ZTP cache.
+void uCellPrivateZtpCacheFlush(uCellPrivateZtpCache_t *pCache)
+{
+    if (pCache != NULL) {
+        for (size_t x = 0; x < sizeof(pCache->pItem) / sizeof(pCache->pItem[0]); x++) {
+            if (pCache->pItem[x] != NULL) {
+                // For safety, since one of these is a private key
+                memset(pCache->pItem[x], 0, pCache->itemSizeBytes[x]);
+                uPortFree(pCache->pItem[x]);
+                pCache->pItem[x] = NULL;
+            }
+            pCache->itemSizeBytes[x] = 0;
+        }
+        pCache->rootOfTrustUidValid = false;
+    }
+}
+
+// Remove a ZTP cache.
+void uCellPrivateZtpCacheRemove(uCellPrivateInstance_t *pInstance)
+{
+    if (pInstance->pZtpCache != NULL) {
+        uCellPrivateZtpCacheFlush(pInstance->pZtpCache);
+        uPortFree(pInstance->pZtpCache);
+        pInstance->pZtpCache = NULL;
+    }
+}
+
 // Remove a location context.
 void uCellPrivateLocRemoveContext(uCellPrivateInstance_t *pInstance)
 {
@@ -834,6 +775,48 @@ void uCellPrivateSleepRemoveContext(uCellPrivateInstance_t *pInstance)
     }
 }
 
+// Stop the radio parameter sampler and remove its context.
+void uCellPrivateRadioSamplerRemoveContext(uCellPrivateInstance_t *pInstance)
+{
+    uCellPrivateRadioSamplerContext_t *pContext;
+
+    if (pInstance != NULL) {
+        pContext = pInstance->pRadioSamplerContext;
+        if (pContext != NULL) {
+            // Tell the task to stop and wait for it to let go
+            // of its mutex, which it does as it exits
+            pContext->keepGoing = false;
+            U_PORT_MUTEX_LOCK(pContext->taskRunningMutex);
+            U_PORT_MUTEX_UNLOCK(pContext->taskRunningMutex);
+            uPortMutexDelete(pContext->taskRunningMutex);
+            // Free the context
+            uPortFree(pContext);
+            pInstance->pRadioSamplerContext = NULL;
+        }
+    }
+}
+
+// Stop the data counter sampler and remove its context.
+void uCellPrivateDataCounterSamplerRemoveContext(uCellPrivateInstance_t *pInstance)
+{
+    uCellPrivateDataCounterSamplerContext_t *pContext;
+
+    if (pInstance != NULL) {
+        pContext = pInstance->pDataCounterSamplerContext;
+        if (pContext != NULL) {
+            // Tell the task to stop and wait for it to let go
+            // of its mutex, which it does as it exits
+            pContext->keepGoing = false;
+            U_PORT_MUTEX_LOCK(pContext->taskRunningMutex);
+            U_PORT_MUTEX_UNLOCK(pContext->taskRunningMutex);
+            uPortMutexDelete(pContext->taskRunningMutex);
+            // Free the context
+            uPortFree(pContext);
+            pInstance->pDataCounterSamplerContext = NULL;
+        }
+    }
+}
+
 // [Re]attach a PDP context to an internal module profile.
 int32_t uCellPrivateActivateProfile(const uCellPrivateInstance_t *pInstance,
                                     int32_t contextId, int32_t profileId, size_t tries,
@@ -867,7 +850,7 @@ int32_t uCellPrivateActivateProfile(const uCellPrivateInstance_t *pInstance,
             uAtClientCommandStopReadResponse(atHandle);
             errorCode = uAtClientUnlock(atHandle);
             if ((errorCode == 0) &&
-                (pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_SARA_R5)) {
+                U_CELL_PRIVATE_MODULE_IS(pInstance->pModule, U_CELL_MODULE_TYPE_SARA_R5)) {
                 errorCode = (int32_t) U_CELL_ERROR_CONTEXT_ACTIVATION_FAILURE;
                 // SARA-R5 pattern: the context also has to be
                 // activated and we're not actually done
@@ -907,6 +890,8 @@ bool uCellPrivateIsDeepSleepActive(uCellPrivateInstance_t *pInstance)
          (uPortGpioGet(pInstance->pinVInt) ==
           (int32_t) !U_CELL_PRIVATE_VINT_PIN_ON_STATE(pInstance->pinStates)))) {
         pInstance->deepSleepState = U_CELL_PRIVATE_DEEP_SLEEP_STATE_ASLEEP;
+        pInstance->restoredFromDeepSleep = false;
+        uCellPwrPrivateEnergyState(pInstance, U_CELL_PWR_ENERGY_STATE_PSM);
         // If we've configured sleep and VInt has gone to its off state,
         // then we are asleep.
         sleepActive = true;
@@ -64,6 +64,29 @@ extern "C" {
 # define U_CELL_PRIVATE_CPWROFF_WAIT_TIME_SECONDS 40
 #endif
 
+#ifndef U_CELL_PRIVATE_ID_CACHE_STRING_MAX_LENGTH_BYTES
+/** The storage for each identity string (ICCID, manufacturer,
+ * model and firmware version) cached in the instance, including
+ * room for a terminator; a longer string is read from the module
+ * every time.
+ */
+# define U_CELL_PRIVATE_ID_CACHE_STRING_MAX_LENGTH_BYTES 64
+#endif
+
+/** The number of Zero Touch Provisioning items that
+ * uCellSecZtpSetCache() may cache, indexed by the type used in
+ * AT+USECDEVCERT: 0 for the device private key, 1 for the device
+ * certificate and 2 for the certificate authorities.
+ */
+#define U_CELL_PRIVATE_ZTP_CACHE_NUM_ITEMS 3
+
+/** The length of the binary root of trust UID that the ZTP cache
+ * is validated against; must be the same as
+ * #U_SECURITY_ROOT_OF_TRUST_UID_LENGTH_BYTES, which is checked in
+ * u_cell_sec.c.
+ */
+#define U_CELL_PRIVATE_ZTP_CACHE_ROOT_OF_TRUST_UID_LENGTH_BYTES 8
+
 #ifndef U_CELL_PRIVATE_COPS_WAIT_TIME_SECONDS
 /** The amount of time to wait for AT+COPS=
  * command to return an OK or ERROR response.
@@ -71,14 +94,235 @@ extern "C" {
 # define U_CELL_PRIVATE_COPS_WAIT_TIME_SECONDS 30
 #endif
 
+/* The feature bitmaps of the modules are defined here, rather than
+ * directly in gUCellPrivateModuleList[], so that, where
+ * U_CFG_CELL_MODULE_FIXED is defined, U_CELL_PRIVATE_HAS() can
+ * evaluate to a compile-time constant.
+ */
+
+/** The features supported by SARA-U201.
+ */
+#define U_CELL_PRIVATE_FEATURES_SARA_U201                                                 \
+    ((1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_USE_UPSD_CONTEXT_ACTIVATION) |             \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CONTEXT_MAPPING_REQUIRED)    |             \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_AUTO_BAUDING)                |             \
+     /* In theory SARA-U201 does support DTR power saving however we do not */            \
+     /* have this in our regression test farm and hence it is not marked */               \
+     /* as supported for now */                                                           \
+     /* (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_DTR_POWER_SAVING) */                    \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_AT_PROFILES)                 |             \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CTS_CONTROL)                 |             \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SOCK_SET_LOCAL_PORT)         |             \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UART_POWER_SAVING)                         \
+    )
+
+/** The features supported by SARA-R410M-02B.
+ */
+#define U_CELL_PRIVATE_FEATURES_SARA_R410M_02B                                            \
+    ((1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MNO_PROFILE)        |                      \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_ASYNC_SOCK_CLOSE)   |                      \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT)               |                      \
+     /* In theory SARA-R410M does support keep alive but I have been */                   \
+     /* unable to make it work (always returns error) and hence this is */                \
+     /* not marked as supported for now */                                                \
+     /* (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_KEEP_ALIVE)         | */           \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_SARA_R4_OLD_SYNTAX) |                 \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UCGED5)                  |                 \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FILE_SYSTEM_TAG)         |                 \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_3GPP_POWER_SAVING)       |                 \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_EDRX)                    |                 \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FOTA)                    |                 \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UART_POWER_SAVING)                         \
+    )
+
+/** The features supported by SARA-R412M-02B.
+ */
+#define U_CELL_PRIVATE_FEATURES_SARA_R412M_02B                                            \
+    ((1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MNO_PROFILE)                            |  \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CSCON)                                  |  \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_ASYNC_SOCK_CLOSE)                       |  \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SERVER_NAME_INDICATION)    |  \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SESSION_RESUMPTION) |         \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT)                                |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_SARA_R4_OLD_SYNTAX)             |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_SET_LOCAL_PORT)                 |     \
+     /* In theory SARA-R412M does support keep alive but I have been */                   \
+     /* unable to make it work (always returns error) and hence this is */                \
+     /* not marked as supported for now */                                                \
+     /* (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_KEEP_ALIVE)                     | */ \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_SESSION_RETAIN)                 |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UCGED5)                              |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FILE_SYSTEM_TAG)                     |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_3GPP_POWER_SAVING)                   |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_EDRX)                                |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FOTA)                                |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UART_POWER_SAVING)                         \
+    )
+
+/** The features supported by SARA-R412M-03B.
+ */
+#define U_CELL_PRIVATE_FEATURES_SARA_R412M_03B                                            \
+    ((1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MNO_PROFILE)                         |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CSCON)                               |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SERVER_NAME_INDICATION) |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SESSION_RESUMPTION) |         \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UCGED5)                              |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FILE_SYSTEM_TAG)                     |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_DEEP_SLEEP_URC)                      |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_3GPP_POWER_SAVING)                   |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_EDRX)                                |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UART_POWER_SAVING)                         \
+    )
+
+/** The features supported by SARA-R5.
+ */
+#define U_CELL_PRIVATE_FEATURES_SARA_R5                                                   \
+    ((1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MNO_PROFILE)                         |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CSCON)                               |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_ROOT_OF_TRUST)                       |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_C2C)                        |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_DATA_COUNTERS)                       |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_IANA_NUMBERING)         |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_CIPHER_LIST)            |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SERVER_NAME_INDICATION) |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SESSION_RESUMPTION) |         \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SOCK_CONNECT_ASYNC)                  |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT)                                |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_BINARY_PUBLISH)                 |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_WILL)                           |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_KEEP_ALIVE)                     |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_SECURITY)                       |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CONTEXT_MAPPING_REQUIRED)            |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_AUTO_BAUDING)                        |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_AT_PROFILES)                         |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_ZTP)                        |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FILE_SYSTEM_TAG)                     |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_DTR_POWER_SAVING)                    |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_DEEP_SLEEP_URC)                      |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_3GPP_POWER_SAVING)                   |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_3GPP_POWER_SAVING_PAGING_WINDOW_SET) |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_EDRX)                                |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTTSN)                              |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CTS_CONTROL)                         |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SOCK_SET_LOCAL_PORT)                 |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FOTA)                                |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UART_POWER_SAVING)                         \
+    )
+
+/** The features supported by SARA-R410M-03B.
+ */
+#define U_CELL_PRIVATE_FEATURES_SARA_R410M_03B                                            \
+    ((1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MNO_PROFILE)                         |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CSCON)                               |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SERVER_NAME_INDICATION) |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SESSION_RESUMPTION) |         \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT)                                |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_KEEP_ALIVE)                     |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_SECURITY)                       |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UCGED5)                              |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FILE_SYSTEM_TAG)                     |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_DEEP_SLEEP_URC)                      |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_3GPP_POWER_SAVING)                   |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_EDRX)                                |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UART_POWER_SAVING)                         \
+    )
+
+/** The features supported by SARA-R422.
+ */
+#define U_CELL_PRIVATE_FEATURES_SARA_R422                                                 \
+    ((1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MNO_PROFILE)                         |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CSCON)                               |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_ROOT_OF_TRUST)                       |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_ASYNC_SOCK_CLOSE)                    |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_IANA_NUMBERING)         |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SERVER_NAME_INDICATION) |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SESSION_RESUMPTION) |         \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SOCK_CONNECT_ASYNC)                  |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT)                                |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_BINARY_PUBLISH)                 |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_WILL)                           |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_KEEP_ALIVE)                     |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_SECURITY)                       |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CONTEXT_MAPPING_REQUIRED)            |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FILE_SYSTEM_TAG)                     |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_DEEP_SLEEP_URC)                      |     \
+     /* SARA-R422 _does_ support 3GPP power saving, however the tests fail at the */      \
+     /* moment because a second attempt to enter 3GPP power saving, after waking-up */    \
+     /* from sleep to do something, fails, hence the support is disabled until */         \
+     /* we determine why that is */                                                       \
+     /* (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_3GPP_POWER_SAVING)                   | */ \
+     /* (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_3GPP_POWER_SAVING_PAGING_WINDOW_SET) | */ \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_EDRX)                                  |   \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTTSN)                                |   \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FOTA)                                  |   \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UART_POWER_SAVING)                         \
+    )
+
+/** The features supported by LARA-R6.
+ */
+#define U_CELL_PRIVATE_FEATURES_LARA_R6                                                   \
+    ((1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MNO_PROFILE)                         |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CSCON)                               |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_ROOT_OF_TRUST)                       |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_IANA_NUMBERING)         |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SERVER_NAME_INDICATION) |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SESSION_RESUMPTION) |         \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SOCK_CONNECT_ASYNC)                  |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT)                                |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_BINARY_PUBLISH)                 |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_WILL)                           |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_KEEP_ALIVE)                     |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTT_SECURITY)                       |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FILE_SYSTEM_TAG)                     |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_DTR_POWER_SAVING)                    |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_MQTTSN)                              |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SOCK_SET_LOCAL_PORT)                 |     \
+     (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_FOTA)                                      \
+    )
+
+/** Return the module type of an instance, given the moduleType
+ * member of its module; where U_CFG_CELL_MODULE_FIXED is defined
+ * (e.g. U_CFG_CELL_MODULE_FIXED=U_CELL_MODULE_TYPE_SARA_R5, for a
+ * product that only ever has the one module type) this is a
+ * compile-time constant and so the compiler can remove the code
+ * that handles any other module type; uCellAdd() will refuse any
+ * other module type.
+ */
+#ifdef U_CFG_CELL_MODULE_FIXED
+# define U_CELL_PRIVATE_MODULE_TYPE(moduleType) (U_CFG_CELL_MODULE_FIXED)
+#else
+# define U_CELL_PRIVATE_MODULE_TYPE(moduleType) (moduleType)
+#endif
+
+/** Return true if the pointed-to module is of the given type; see
+ * U_CELL_PRIVATE_MODULE_TYPE().
+ */
+#define U_CELL_PRIVATE_MODULE_IS(pModule, type) \
+    (U_CELL_PRIVATE_MODULE_TYPE((pModule)->moduleType) == (type))
+
 /** Return true if the given module type is SARA-R4-xx.
  */
-#define U_CELL_PRIVATE_MODULE_IS_SARA_R4(moduleType)      \
-    (((moduleType) == U_CELL_MODULE_TYPE_SARA_R410M_02B) || \
-     ((moduleType) == U_CELL_MODULE_TYPE_SARA_R412M_02B) || \
-     ((moduleType) == U_CELL_MODULE_TYPE_SARA_R412M_03B) || \
-     ((moduleType) == U_CELL_MODULE_TYPE_SARA_R410M_03B) || \
-     ((moduleType) == U_CELL_MODULE_TYPE_SARA_R422))
+#define U_CELL_PRIVATE_MODULE_IS_SARA_R4(moduleType)                                \
+    ((U_CELL_PRIVATE_MODULE_TYPE(moduleType) == U_CELL_MODULE_TYPE_SARA_R410M_02B) || \
+     (U_CELL_PRIVATE_MODULE_TYPE(moduleType) == U_CELL_MODULE_TYPE_SARA_R412M_02B) || \
+     (U_CELL_PRIVATE_MODULE_TYPE(moduleType) == U_CELL_MODULE_TYPE_SARA_R412M_03B) || \
+     (U_CELL_PRIVATE_MODULE_TYPE(moduleType) == U_CELL_MODULE_TYPE_SARA_R410M_03B) || \
+     (U_CELL_PRIVATE_MODULE_TYPE(moduleType) == U_CELL_MODULE_TYPE_SARA_R422))
+
+#ifdef U_CFG_CELL_MODULE_FIXED
+/** The feature bitmap of the module type U_CFG_CELL_MODULE_FIXED,
+ * a compile-time constant.
+ */
+# define U_CELL_PRIVATE_FEATURES_FIXED                                                                           \
+    (((U_CFG_CELL_MODULE_FIXED) == U_CELL_MODULE_TYPE_SARA_U201) ? U_CELL_PRIVATE_FEATURES_SARA_U201 :           \
+     ((U_CFG_CELL_MODULE_FIXED) == U_CELL_MODULE_TYPE_SARA_R410M_02B) ? U_CELL_PRIVATE_FEATURES_SARA_R410M_02B : \
+     ((U_CFG_CELL_MODULE_FIXED) == U_CELL_MODULE_TYPE_SARA_R412M_02B) ? U_CELL_PRIVATE_FEATURES_SARA_R412M_02B : \
+     ((U_CFG_CELL_MODULE_FIXED) == U_CELL_MODULE_TYPE_SARA_R412M_03B) ? U_CELL_PRIVATE_FEATURES_SARA_R412M_03B : \
+     ((U_CFG_CELL_MODULE_FIXED) == U_CELL_MODULE_TYPE_SARA_R5) ? U_CELL_PRIVATE_FEATURES_SARA_R5 :               \
+     ((U_CFG_CELL_MODULE_FIXED) == U_CELL_MODULE_TYPE_SARA_R410M_03B) ? U_CELL_PRIVATE_FEATURES_SARA_R410M_03B : \
+     ((U_CFG_CELL_MODULE_FIXED) == U_CELL_MODULE_TYPE_SARA_R422) ? U_CELL_PRIVATE_FEATURES_SARA_R422 :           \
+     ((U_CFG_CELL_MODULE_FIXED) == U_CELL_MODULE_TYPE_LARA_R6) ? U_CELL_PRIVATE_FEATURES_LARA_R6 : 0ULL)
+#endif
 
 /** Return true if the supported RATS bitmap includes LTE.
  */
@@ -102,8 +346,26 @@ extern "C" {
  */
 //lint --emacro((774), U_CELL_PRIVATE_HAS) Suppress left side always
 // evaluates to True
-#define U_CELL_PRIVATE_HAS(pModule, feature) \
+#ifdef U_CFG_CELL_MODULE_FIXED
+# define U_CELL_PRIVATE_HAS(pModule, feature) \
+    ((pModule != NULL) && (U_CELL_PRIVATE_FEATURES_FIXED & (1ULL << (int32_t) (feature))))
+#else
+# define U_CELL_PRIVATE_HAS(pModule, feature) \
     ((pModule != NULL) && ((pModule->featuresBitmap) & (1ULL << (int32_t) (feature))))
+#endif
+
+/** Return true if the pointed-to module can have more than one
+ * PDP context active at once, each mapped to an internal profile
+ * with 3GPP commands, see uCellNetActivateContext().
+ */
+#define U_CELL_PRIVATE_HAS_MULTIPLE_CONTEXTS(pModule)                                      \
+    (U_CELL_PRIVATE_HAS(pModule, U_CELL_PRIVATE_FEATURE_CONTEXT_MAPPING_REQUIRED) &&       \
+     !U_CELL_PRIVATE_HAS(pModule, U_CELL_PRIVATE_FEATURE_USE_UPSD_CONTEXT_ACTIVATION))
+
+/** The internal module profile ID that goes with a PDP context ID.
+ */
+#define U_CELL_PRIVATE_PROFILE_ID(contextId) \
+    (((contextId) == U_CELL_NET_CONTEXT_ID) ? U_CELL_NET_PROFILE_ID : (contextId) - 1)
 
 #ifndef U_CELL_PRIVATE_GREETING_STR
 /** A greeting string, a useful indication that the module
@@ -221,7 +483,9 @@ typedef enum {
     U_CELL_PRIVATE_FEATURE_CTS_CONTROL,
     U_CELL_PRIVATE_FEATURE_SOCK_SET_LOCAL_PORT,
     U_CELL_PRIVATE_FEATURE_FOTA,
-    U_CELL_PRIVATE_FEATURE_UART_POWER_SAVING
+    U_CELL_PRIVATE_FEATURE_UART_POWER_SAVING,
+    U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SESSION_RESUMPTION,
+    U_CELL_PRIVATE_FEATURE_SOCK_CONNECT_ASYNC
 } uCellPrivateFeature_t;
 
 /** The characteristics that may differ between cellular modules.
@@ -288,6 +552,29 @@ typedef struct {
     int32_t earfcn;   /**< The EARFCN of the serving cell. */
 } uCellPrivateRadioParameters_t;
 
+/** An identity string, as cached in #uCellPrivateIdCache_t.
+ */
+typedef struct {
+    char str[U_CELL_PRIVATE_ID_CACHE_STRING_MAX_LENGTH_BYTES]; /**< the string, null terminated. */
+    size_t length;  /**< the length of str, not including the terminator. */
+    bool valid;     /**< true if str has been populated. */
+} uCellPrivateIdCacheString_t;
+
+/** Identity information that does not change while the module
+ * is powered, cached so that reading it does not cost an AT
+ * command every time.  A zeroed structure is an empty cache.
+ */
+typedef struct {
+    char imei[15];  /**< the IMEI, as U_CELL_INFO_IMEI_SIZE. */
+    bool imeiValid; /**< true if imei has been populated. */
+    char imsi[15];  /**< the IMSI, as U_CELL_INFO_IMSI_SIZE. */
+    bool imsiValid; /**< true if imsi has been populated. */
+    uCellPrivateIdCacheString_t iccid;
+    uCellPrivateIdCacheString_t manufacturer;
+    uCellPrivateIdCacheString_t model;
+    uCellPrivateIdCacheString_t firmwareVersion;
+} uCellPrivateIdCache_t;
+
 /** Structure to hold a network name, MCC/MNC and RAT
  * as part of a linked list.
  */
@@ -299,6 +586,24 @@ typedef struct uCellPrivateNet_t {
     struct uCellPrivateNet_t *pNext;
 } uCellPrivateNet_t;
 
+/** The last successful location fix, kept by the cell loc API
+ * along with the serving cell it was obtained in.
+ */
+typedef struct {
+    bool valid;          /**< true if the fields below are populated. */
+    int32_t cellId;      /**< the serving cell ID when the fix was
+                              requested, -1 if not known. */
+    int32_t earfcn;      /**< the EARFCN of that serving cell. */
+    int32_t timeMs;      /**< uPortGetTickTimeMs() when the fix arrived. */
+    int32_t latitudeX1e7;
+    int32_t longitudeX1e7;
+    int32_t altitudeMillimetres;
+    int32_t radiusMillimetres;
+    int32_t speedMillimetresPerSecond;
+    int32_t svs;
+    int64_t timeUtc;
+} uCellPrivateLocCache_t;
+
 /** Context for the cell loc API.
  */
 typedef struct {
@@ -307,11 +612,62 @@ typedef struct {
     bool gnssEnable;                     /**< whether a GNSS chip attached
                                               to the cellular module should
                                               be used in the fix or not. */
-    uPortMutexHandle_t fixDataStorageMutex;  /**< protect manipulation of fix data storage. */
+    int32_t cacheMaxAgeSeconds;          /**< how old a cached fix may be
+                                              and still be re-used, zero
+                                              for never. */
+    uPortMutexHandle_t fixDataStorageMutex;  /**< protect manipulation of fix data
+                                                  storage and of cache. */
     void *pFixDataStorage;/**< pointer to data storage used when establishing a fix. */
     int32_t fixStatus;    /**< status of a location fix. */
+    int32_t fixCellId;    /**< the serving cell ID when the fix in progress
+                               was requested, -1 if not known. */
+    int32_t fixEarfcn;    /**< the EARFCN that goes with fixCellId. */
+    uCellPrivateLocCache_t cache; /**< the last successful fix. */
 } uCellPrivateLocContext_t;
 
+/** Context for the background radio parameter sampler, see
+ * uCellInfoRadioSamplerStart().
+ */
+typedef struct {
+    uDeviceHandle_t cellHandle;
+    void *pSampler;      /**< the uCellInfoRadioSampler_t provided by the
+                              application, lodged here as a void * to
+                              avoid spreading its types all over. */
+    int32_t periodMs;
+    void (*pCallback) (uDeviceHandle_t, void *);
+    void *pCallbackParam;
+    volatile bool keepGoing;   /**< set to false to stop the task. */
+    uPortTaskHandle_t taskHandle;
+    uPortMutexHandle_t taskRunningMutex; /**< held by the task while it runs. */
+} uCellPrivateRadioSamplerContext_t;
+
+/** Context for the background data counter sampler, see
+ * uCellNetDataCounterSamplerStart().
+ */
+typedef struct {
+    uDeviceHandle_t cellHandle;
+    void *pSampler;      /**< the uCellNetDataCounterSampler_t provided
+                              by the application, lodged here as a
+                              void * to avoid spreading its types all over. */
+    int32_t periodMs;
+    int32_t thresholdBytes;
+    bool thresholdReached;
+    void (*pCallback) (uDeviceHandle_t, void *);
+    void *pCallbackParam;
+    int32_t lastTxBytes; /**< last reading of the module's counter, -1 if none. */
+    int32_t lastRxBytes; /**< last reading of the module's counter, -1 if none. */
+    int32_t txBytes;     /**< accumulated since the sampler was started. */
+    int32_t rxBytes;     /**< accumulated since the sampler was started. */
+    int32_t rateTimeMs;  /**< when the rates were last worked out. */
+    int32_t rateTxBytes; /**< txBytes when the rates were last worked out. */
+    int32_t rateRxBytes; /**< rxBytes when the rates were last worked out. */
+    int32_t txBytesPerSecond; /**< moving average, -1 if not yet known. */
+    int32_t rxBytesPerSecond; /**< moving average, -1 if not yet known. */
+    volatile bool keepGoing;   /**< set to false to stop the task. */
+    uPortTaskHandle_t taskHandle;
+    uPortMutexHandle_t taskRunningMutex; /**< held by the task while it runs. */
+} uCellPrivateDataCounterSamplerContext_t;
+
 /** Type to keep track of the deep sleep state.
  */
 //lint -esym(769, uCellPrivateDeepSleepState_t::U_CELL_PRIVATE_MAX_NUM_SLEEP_STATES) Suppress not referenced
@@ -370,6 +726,21 @@ typedef struct uCellPrivateFileListContainer_t {
     struct uCellPrivateFileListContainer_t *pNext;
 } uCellPrivateFileListContainer_t;
 
+/** A cache of the Zero Touch Provisioning items read from the
+ * module, see uCellSecZtpSetCache().
+ */
+typedef struct {
+    /** True if rootOfTrustUid is populated. */
+    bool rootOfTrustUidValid;
+    /** The root of trust UID of the module that the items belong to. */
+    char rootOfTrustUid[U_CELL_PRIVATE_ZTP_CACHE_ROOT_OF_TRUST_UID_LENGTH_BYTES];
+    /** The items, NULL where not cached. */
+    char *pItem[U_CELL_PRIVATE_ZTP_CACHE_NUM_ITEMS];
+    /** The size of each item including the terminator, zero where
+     * not known; may be known without the item being cached. */
+    size_t itemSizeBytes[U_CELL_PRIVATE_ZTP_CACHE_NUM_ITEMS];
+} uCellPrivateZtpCache_t;
+
 /** Definition of a cellular instance.
  */
 typedef struct uCellPrivateInstance_t {
@@ -400,6 +771,7 @@ typedef struct uCellPrivateInstance_t {
     networkStatus[U_CELL_NET_REG_DOMAIN_MAX_NUM]; /**< Registation status in each domain. */
     uCellNetRat_t rat[U_CELL_NET_REG_DOMAIN_MAX_NUM];  /**< The active RAT for each domain. */
     uCellPrivateRadioParameters_t radioParameters; /**< The radio parameters. */
+    uCellPrivateIdCache_t idCache; /**< Cached identity information. */
     int32_t startTimeMs;     /**< Used while connecting and scanning. */
     int32_t connectedAtMs;   /**< When a connection was last established,
                                   can be used for offsetting from that time;
@@ -408,27 +780,65 @@ typedef struct uCellPrivateInstance_t {
                                   required, e.g. as a result of a configuration
                                   change. */
     int32_t mnoProfile;     /**< The active MNO profile, populated at boot. */
+    uCellNetConnectPath_t lastConnectPath; /**< The route taken by the last
+                                                successful uCellNetConnect(). */
+    uint32_t configFingerprint; /**< The fingerprint of the non-volatile
+                                     configuration last written to the
+                                     module by uCellPwrOn() etc., zero if
+                                     unknown: anything that might change
+                                     that configuration (e.g. AT+UDCONF,
+                                     AT+UMNOPROF) should set this to zero. */
     bool (*pKeepGoingCallback) (uDeviceHandle_t cellHandle);  /**< Used while connecting. */
     void (*pRegistrationStatusCallback) (uCellNetRegDomain_t, uCellNetStatus_t, void *);
     void *pRegistrationStatusCallbackParameter;
     void (*pConnectionStatusCallback) (bool, void *);
     void *pConnectionStatusCallbackParameter;
+    volatile int32_t baseStationConnection; /**< 1 if the last +CSCON URC
+                                                 indicated connected, 0 if
+                                                 not, -1 if unknown. */
     uCellPrivateNet_t *pScanResults;    /**< Anchor for list of network scan results. */
     int32_t sockNextLocalPort;
     void *pSecurityC2cContext;  /**< Hook for a chip to chip security context. */
+    uCellPrivateZtpCache_t *pZtpCache; /**< Hook for a Zero Touch Provisioning cache. */
     volatile void *pMqttContext; /**< Hook for MQTT context, volatile as it
                                       can be populared by a URC in a different thread. */
     uCellPrivateLocContext_t *pLocContext; /**< Hook for a location context. **/
+    uCellPrivateRadioSamplerContext_t *pRadioSamplerContext; /**< Hook for the radio
+                                                                  parameter sampler. */
+    uCellPrivateDataCounterSamplerContext_t *pDataCounterSamplerContext; /**< Hook for the
+                                                                              data counter
+                                                                              sampler. */
     bool socketsHexMode; /**< Set to true for sockets to use hex mode. */
     const char *pFileSystemTag; /**< The tagged area of the file system currently being addressed. */
     uCellPrivateDeepSleepState_t deepSleepState; /**< The current deep sleep state. */
     int32_t deepSleepBlockedBy; /** Set to a positive integer if an app on the module is blocking deep sleep. */
     bool inWakeUpCallback; /**< So that we can avoid recursion. */
+    bool restoredFromDeepSleep; /**< Set to true when the module has been
+                                     woken from deep sleep and restored by
+                                     uCellPwrPrivateOn(), cleared when it
+                                     sleeps, is powered off or is rebooted;
+                                     while true, uCellPwrOn() need only
+                                     check that the module is alive. */
     uCellPrivateSleep_t *pSleepContext; /**< Context for sleep stuff. */
     uCellPrivateUartSleepCache_t uartSleepCache; /**< Used only by uCellPwrEnable/DisableUartSleep(). */
     uCellPrivateProfileState_t profileState; /**< To track whether a profile is meant to be active. */
     void *pFotaContext; /**< FOTA context, lodged here as a void * to
                              avoid spreading its types all over. */
+    void *pMuxContext; /**< 27.010 multiplexer context, lodged here as
+                            a void * for the same reason. */
+    void *pEnergyContext; /**< Energy accounting context, see
+                               uCellPwrEnergyStart(), lodged here as
+                               a void * for the same reason. */
+    void *pBandLearnContext; /**< Band learning context, see
+                                  uCellNetBandLearnStart(), lodged here
+                                  as a void * for the same reason. */
+    void *pHeartbeatContext; /**< A security heartbeat waiting to be sent,
+                                  see uCellSecHeartbeatTriggerDeferred(),
+                                  lodged here as a void * for the same
+                                  reason. */
+    void *pSockPoolContext; /**< Sockets created in the module in advance,
+                                 see uCellSockPoolSet(), lodged here as a
+                                 void * for the same reason. */
     struct uCellPrivateInstance_t *pNext;
 } uCellPrivateInstance_t;
 
@@ -475,6 +885,44 @@ bool uCellPrivateIsNumeric(const char *pBuffer, size_t bufferSize);
  */
 uCellPrivateInstance_t *pUCellPrivateGetInstance(uDeviceHandle_t cellHandle);
 
+#ifdef U_CFG_AT_CLIENT_STATS
+/** When AT client statistics are collected, every function that
+ * finds its instance with pUCellPrivateGetInstance(), which is
+ * every public API function, tags the AT client with its own name,
+ * see uAtClientStatsTagSet(), so that the AT traffic of each API
+ * can be told apart.
+ */
+# define pUCellPrivateGetInstance(cellHandle) pUCellPrivateGetInstanceTag(cellHandle, __func__)
+
+/** Tag the AT client of an instance with the name of the calling
+ * function; for API functions that find their instance through a
+ * common entry function.
+ */
+# define U_CELL_PRIVATE_AT_STATS_TAG(pInstance) uCellPrivateAtStatsTag(pInstance, __func__)
+#else
+# define U_CELL_PRIVATE_AT_STATS_TAG(pInstance)
+#endif
+
+/** As pUCellPrivateGetInstance() but also tag the AT client of the
+ * instance, if found, for the AT client statistics.
+ * Note: gUCellPrivateMutex should be locked before this is called.
+ *
+ * @param cellHandle  the instance handle.
+ * @param[in] pTag    the tag, see uAtClientStatsTagSet().
+ * @return            a pointer to the instance.
+ */
+uCellPrivateInstance_t *pUCellPrivateGetInstanceTag(uDeviceHandle_t cellHandle,
+                                                    const char *pTag);
+
+/** Tag the AT client of an instance for the AT client statistics,
+ * see uAtClientStatsTagSet().
+ *
+ * @param[in] pInstance  a pointer to the instance, may be NULL.
+ * @param[in] pTag       the tag.
+ */
+void uCellPrivateAtStatsTag(const uCellPrivateInstance_t *pInstance,
+                            const char *pTag);
+
 /** Set the radio parameters back to defaults.
  *
  * @param pParameters pointer to a radio parameters structure.
@@ -482,13 +930,27 @@ uCellPrivateInstance_t *pUCellPrivateGetInstance(uDeviceHandle_t cellHandle);
 void uCellPrivateClearRadioParameters(uCellPrivateRadioParameters_t *pParameters);
 
 /** Clear the dynamic parameters of an instance, so the network
- * status, the active RAT and the radio parameters.  This should
- * be called when the module is being rebooted or powered off.
+ * status, the active RAT, the radio parameters and the identity
+ * cache.  This should be called when the module is being rebooted
+ * or powered off.
  *
  * @param pInstance a pointer to the instance.
  */
 void uCellPrivateClearDynamicParameters(uCellPrivateInstance_t *pInstance);
 
+/** Clear the cached identity information of an instance.  This
+ * is done by uCellPrivateClearDynamicParameters() but should also
+ * be done, with simOnly set to true, whenever the radio of the
+ * module is switched off (AT+CFUN=0/4), since that is when the SIM
+ * may be changed.
+ *
+ * @param pInstance a pointer to the instance.
+ * @param simOnly   if true, only the information that comes from
+ *                  the SIM (the IMSI and the ICCID) is cleared.
+ */
+void uCellPrivateClearIdCache(uCellPrivateInstance_t *pInstance,
+                              bool simOnly);
+
 /** Get the current AT+CFUN mode of the module.
  *
  * @param pInstance  pointer to the cellular instance.
@@ -604,6 +1066,21 @@ const uCellPrivateModule_t *pUCellPrivateGetModule(uDeviceHandle_t cellHandle);
  */
 void uCellPrivateC2cRemoveContext(uCellPrivateInstance_t *pInstance);
 
+/** Empty the Zero Touch Provisioning cache, freeing (and, for
+ * safety, clearing) the items in it but not the cache itself.
+ * Note: gUCellPrivateMutex should be locked before this is called.
+ *
+ * @param pCache   a pointer to the cache; may be NULL.
+ */
+void uCellPrivateZtpCacheFlush(uCellPrivateZtpCache_t *pCache);
+
+/** Remove the Zero Touch Provisioning cache for the given instance.
+ * Note: gUCellPrivateMutex should be locked before this is called.
+ *
+ * @param pInstance   a pointer to the cellular instance.
+ */
+void uCellPrivateZtpCacheRemove(uCellPrivateInstance_t *pInstance);
+
 /** Remove the location context for the given instance.
  * Note: gUCellPrivateMutex should be locked before this is called.
  *
@@ -618,6 +1095,26 @@ void uCellPrivateLocRemoveContext(uCellPrivateInstance_t *pInstance);
  */
 void uCellPrivateSleepRemoveContext(uCellPrivateInstance_t *pInstance);
 
+/** Stop the background radio parameter sampler, if there is one,
+ * and remove its context for the given instance.
+ * Note: gUCellPrivateMutex should be locked before this is called;
+ * the sampler task never waits on gUCellPrivateMutex while it has
+ * been asked to stop so this will not deadlock.
+ *
+ * @param pInstance   a pointer to the cellular instance.
+ */
+void uCellPrivateRadioSamplerRemoveContext(uCellPrivateInstance_t *pInstance);
+
+/** Stop the background data counter sampler, if there is one,
+ * and remove its context for the given instance.
+ * Note: gUCellPrivateMutex should be locked before this is called;
+ * the sampler task never waits on gUCellPrivateMutex while it has
+ * been asked to stop so this will not deadlock.
+ *
+ * @param pInstance   a pointer to the cellular instance.
+ */
+void uCellPrivateDataCounterSamplerRemoveContext(uCellPrivateInstance_t *pInstance);
+
 /** [Re]attach a PDP context to an internal module profile.  This
  * is required by some module types (e.g. SARA-R4 and SARA-R5 modules)
  * when a PDP context is either first established or has been lost, e.g.
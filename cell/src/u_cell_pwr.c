@@ -55,6 +55,7 @@
 #include "u_cell_private.h" // don't change it
 #include "u_cell_pwr.h"
 #include "u_cell_pwr_private.h"
+#include "u_cell_mux_private.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -69,6 +70,17 @@
  */
 #define U_CELL_PWR_CONFIGURATION_COMMAND_TRIES 3
 
+#ifndef U_CELL_PWR_CONFIGURATION_PIPELINE_WINDOW
+/** The number of configuration AT commands that may be sent to the
+ * module before the response to the first has been received, see
+ * uAtClientPipeline(); the default of 1 sends the configuration
+ * commands strictly one at a time, a larger value (e.g. 4) may
+ * shorten power-on considerably where the module turnaround time
+ * dominates.
+ */
+# define U_CELL_PWR_CONFIGURATION_PIPELINE_WINDOW 1
+#endif
+
 /** The UART power saving duration in GSM frames, needed for the
  * UART power saving AT command.
  */
@@ -118,14 +130,30 @@ typedef struct {
     void *pCallbackParam;
 } uCellPwrEDrxCallback_t;
 
+/** The energy accounts of a cellular instance, hooked into
+ * pEnergyContext of the instance by uCellPwrEnergyStart().
+ */
+typedef struct {
+    uPortMutexHandle_t mutex; /**< since states change in URCs. */
+    uCellPwrEnergyState_t state;
+    int32_t stateStartTimeMs;
+    int64_t timeMs[U_CELL_PWR_ENERGY_STATE_MAX_NUM];
+    uint64_t bytesSent;
+    uint64_t bytesReceived;
+    bool hasTable;
+    uCellPwrCurrentTable_t table;
+} uCellPwrEnergyContext_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
 
 /** Table of AT commands to send to all cellular module types
- * during configuration.
+ * during configuration; "ATE0" is not in here since it is sent,
+ * on its own, before these, which may be pipelined: with echo
+ * still on the responses to pipelined commands could be mis-parsed.
  */
-static const char *const gpConfigCommand[] = {"ATE0",      // Echo off
+static const char *const gpConfigCommand[] = {
 #ifdef U_CFG_CELL_ENABLE_NUMERIC_ERROR
 // With this compilation flag defined numeric errors will be
 // returned and so uAtClientDeviceErrorGet() will be able
@@ -141,20 +169,31 @@ static const char *const gpConfigCommand[] = {"ATE0",      // Echo off
 // to true.
                                               "AT+CMEE=2", // Extended errors on, verbose/text format
 #endif
+                                              "AT&C1",     // DCD circuit (109) changes with the carrier
+                                              "AT&D0"      // Ignore changes to DTR
+                                             };
+
+/** Table of AT commands to send to all cellular module types
+ * during configuration whose effect is stored in the non-volatile
+ * memory of the module: these are only sent if the fingerprint
+ * of this table, see configFingerprint(), is not the one stored
+ * in the instance from the last time they were sent.
+ */
+static const char *const gpConfigCommandNvm[] = {
 #ifdef U_CFG_1V8_SIM_WORKAROUND
 // This can be used to tell a SARA-R422 module that a 1.8V
 // SIM which does NOT include 1.8V in its answer-to-reset
 // really is a good 1.8V SIM.
-                                              "AT+UDCONF=92,1,1",
+    "AT+UDCONF=92,1,1",
 #endif
 // SARA-R5xxx-01B remembers whether sockets are in hex mode or
 // not so reset that here in order that all modules behave the
 // same way
-                                              "AT+UDCONF=1,0",
-                                              "ATI9",      // Firmware version
-                                              "AT&C1",     // DCD circuit (109) changes with the carrier
-                                              "AT&D0"      // Ignore changes to DTR
-                                             };
+    "AT+UDCONF=1,0",
+// Not a setting but the firmware version, which is only read
+// for the log, won't have changed either
+    "ATI9"
+};
 
 /** Array to convert the RAT emited by AT+CEDRXS to one of our RATs.
  */
@@ -805,6 +844,35 @@ static int32_t setEDrxUrc(const uCellPrivateInstance_t *pInstance)
     return errorCode;
 }
 
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: ENERGY ACCOUNTING
+ * -------------------------------------------------------------- */
+
+// Add the time spent in the current state to its account and
+// restart the clock: pContext->mutex must be locked.
+static void energyUpdate(uCellPwrEnergyContext_t *pContext)
+{
+    int32_t nowMs = uPortGetTickTimeMs();
+
+    pContext->timeMs[pContext->state] += (int32_t) ((uint32_t) nowMs -
+                                                    (uint32_t) pContext->stateStartTimeMs);
+    pContext->stateStartTimeMs = nowMs;
+}
+
+// The module is known to be awake: if the energy accounts have it
+// as off or in PSM then move them to idle, else leave them be
+// since the module may have an RRC connection.
+static void energyWake(const uCellPrivateInstance_t *pInstance)
+{
+    uCellPwrEnergyContext_t *pContext = (uCellPwrEnergyContext_t *) pInstance->pEnergyContext;
+
+    if ((pContext != NULL) &&
+        ((pContext->state == U_CELL_PWR_ENERGY_STATE_OFF) ||
+         (pContext->state == U_CELL_PWR_ENERGY_STATE_PSM))) {
+        uCellPwrPrivateEnergyState(pInstance, U_CELL_PWR_ENERGY_STATE_IDLE);
+    }
+}
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS: DEEP SLEEP
  * -------------------------------------------------------------- */
@@ -841,6 +909,9 @@ static void UUPSMR_urc(uAtClientHandle_t atHandle, void *pParameter)
     // 2 means sleep is blocked.
     if (x == 1) {
         pInstance->deepSleepState = U_CELL_PRIVATE_DEEP_SLEEP_STATE_PROTOCOL_STACK_ASLEEP;
+        uCellPwrPrivateEnergyState(pInstance, U_CELL_PWR_ENERGY_STATE_PSM);
+    } else if (x == 0) {
+        energyWake(pInstance);
     }
     pInstance->deepSleepBlockedBy = -1;
     if (x == 2) {
@@ -913,6 +984,31 @@ static bool moduleConfigureOne(uAtClientHandle_t atHandle,
     return success;
 }
 
+// Compute the fingerprint of the non-volatile configuration that
+// moduleConfigure() would write for this instance: an FNV-1a hash
+// of the module type and gpConfigCommandNvm[], never zero.
+static uint32_t configFingerprint(const uCellPrivateInstance_t *pInstance)
+{
+    uint32_t fingerprint = 2166136261U;
+    const char *pStr;
+
+    fingerprint ^= (uint32_t) pInstance->pModule->moduleType;
+    fingerprint *= 16777619U;
+    for (size_t x = 0; x < sizeof(gpConfigCommandNvm) / sizeof(gpConfigCommandNvm[0]); x++) {
+        for (pStr = gpConfigCommandNvm[x]; *pStr != 0; pStr++) {
+            fingerprint ^= (uint32_t) (uint8_t) *pStr;
+            fingerprint *= 16777619U;
+        }
+        // Separator, so that the command boundaries count
+        fingerprint *= 16777619U;
+    }
+    if (fingerprint == 0) {
+        fingerprint = 1;
+    }
+
+    return fingerprint;
+}
+
 // Configure the cellular module.
 static int32_t moduleConfigure(uCellPrivateInstance_t *pInstance,
                                bool andRadioOff, bool returningFromSleep)
@@ -924,18 +1020,47 @@ static int32_t moduleConfigure(uCellPrivateInstance_t *pInstance,
     uCellPwrPsvMode_t uartPowerSavingMode = U_CELL_PWR_PSV_MODE_DISABLED; // Assume no UART power saving
     uAtClientStream_t atStreamType;
     char buffer[20]; // Enough room for AT+UPSV=2,1300
-
-    // First send all the commands that everyone gets
-    for (size_t x = 0;
-         (x < sizeof(gpConfigCommand) / sizeof(gpConfigCommand[0])) &&
-         success; x++) {
-        success = moduleConfigureOne(atHandle, gpConfigCommand[x],
-                                     U_CELL_PWR_CONFIGURATION_COMMAND_TRIES);
+    uAtClientPipelineCommand_t pipeline[(sizeof(gpConfigCommand) / sizeof(gpConfigCommand[0])) +
+                                        (sizeof(gpConfigCommandNvm) / sizeof(gpConfigCommandNvm[0]))] = {0};
+    size_t numCommands = 0;
+    uint32_t fingerprint = configFingerprint(pInstance);
+    bool nvmConfigured = (pInstance->configFingerprint == fingerprint);
+
+    // Switch echo off on its own, before anything is pipelined
+    success = moduleConfigureOne(atHandle, "ATE0",
+                                 U_CELL_PWR_CONFIGURATION_COMMAND_TRIES);
+
+    // Then send all the commands that everyone gets, plus those
+    // which set non-volatile things if they may not already be
+    // set; these may be pipelined, see
+    // U_CELL_PWR_CONFIGURATION_PIPELINE_WINDOW
+    for (size_t x = 0; x < sizeof(gpConfigCommand) / sizeof(gpConfigCommand[0]); x++) {
+        pipeline[numCommands].pCommand = gpConfigCommand[x];
+        numCommands++;
+    }
+    if (!nvmConfigured) {
+        for (size_t x = 0; x < sizeof(gpConfigCommandNvm) / sizeof(gpConfigCommandNvm[0]); x++) {
+            pipeline[numCommands].pCommand = gpConfigCommandNvm[x];
+            numCommands++;
+        }
+    }
+    if (success) {
+        uAtClientLock(atHandle);
+        uAtClientPipeline(atHandle, pipeline, numCommands,
+                          U_CELL_PWR_CONFIGURATION_PIPELINE_WINDOW);
+        uAtClientUnlock(atHandle);
+    }
+    // Retry, one at a time, any that failed
+    for (size_t x = 0; (x < numCommands) && success; x++) {
+        if (pipeline[x].errorCode != 0) {
+            success = moduleConfigureOne(atHandle, pipeline[x].pCommand,
+                                         U_CELL_PWR_CONFIGURATION_COMMAND_TRIES - 1);
+        }
     }
 
     if (success &&
         (U_CELL_PRIVATE_MODULE_IS_SARA_R4(pInstance->pModule->moduleType) ||
-         (pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_LARA_R6))) {
+         U_CELL_PRIVATE_MODULE_IS(pInstance->pModule, U_CELL_MODULE_TYPE_LARA_R6))) {
         // SARA-R4 and LARA-R6 only: switch on the right UCGED mode
         // (SARA-R5 and SARA-U201 have a single mode and require no setting)
         if (U_CELL_PRIVATE_HAS(pInstance->pModule, U_CELL_PRIVATE_FEATURE_UCGED5)) {
@@ -1074,8 +1199,12 @@ static int32_t moduleConfigure(uCellPrivateInstance_t *pInstance,
         // Update the sleep parameters; note that we ask for the
         // requested 3GPP power saving state here, rather than the
         // assigned, since it might not be assigned by the network
-        // at this point but can come along later
-        uCellPwrPrivateGet3gppPowerSaving(pInstance, false, NULL, NULL, NULL);
+        // at this point but can come along later.  The settings
+        // are non-volatile and none can have changed while the
+        // module was asleep, so no need to ask on the way back
+        if (!returningFromSleep || (pInstance->pSleepContext == NULL)) {
+            uCellPwrPrivateGet3gppPowerSaving(pInstance, false, NULL, NULL, NULL);
+        }
         uCellPrivateSetDeepSleepState(pInstance);
         if (success &&
             U_CELL_PRIVATE_MODULE_IS_SARA_R4(pInstance->pModule->moduleType)) {
@@ -1086,15 +1215,22 @@ static int32_t moduleConfigure(uCellPrivateInstance_t *pInstance,
     }
 
     if (success) {
-        // Retrieve and store the current MNO profile
-        pInstance->mnoProfile = -1;
-        uAtClientLock(atHandle);
-        uAtClientCommandStart(atHandle, "AT+UMNOPROF?");
-        uAtClientCommandStop(atHandle);
-        uAtClientResponseStart(atHandle, "+UMNOPROF:");
-        pInstance->mnoProfile = uAtClientReadInt(atHandle);
-        uAtClientResponseStop(atHandle);
-        uAtClientUnlock(atHandle);
+        if (!nvmConfigured || (pInstance->mnoProfile < 0)) {
+            // Retrieve and store the current MNO profile; this is
+            // also non-volatile and anything that changes it
+            // invalidates the fingerprint, hence no need to read
+            // it again if the fingerprint matched
+            pInstance->mnoProfile = -1;
+            uAtClientLock(atHandle);
+            uAtClientCommandStart(atHandle, "AT+UMNOPROF?");
+            uAtClientCommandStop(atHandle);
+            uAtClientResponseStart(atHandle, "+UMNOPROF:");
+            pInstance->mnoProfile = uAtClientReadInt(atHandle);
+            uAtClientResponseStop(atHandle);
+            uAtClientUnlock(atHandle);
+        }
+        // The non-volatile settings are now known to be in place
+        pInstance->configFingerprint = fingerprint;
         if (andRadioOff) {
             // Switch the radio off until commanded to connect
             // Wait for flip time to expire
@@ -1102,6 +1238,8 @@ static int32_t moduleConfigure(uCellPrivateInstance_t *pInstance,
                    (U_CELL_PRIVATE_AT_CFUN_FLIP_DELAY_SECONDS * 1000)) {
                 uPortTaskBlock(1000);
             }
+            // The SIM may be changed while the radio is off
+            uCellPrivateClearIdCache(pInstance, true);
             uAtClientLock(atHandle);
             uAtClientCommandStart(atHandle, "AT+CFUN=");
             uAtClientWriteInt(atHandle,
@@ -1198,6 +1336,8 @@ static int32_t powerOff(uCellPrivateInstance_t *pInstance,
     // Remove any security context as these disappear
     // at power off
     uCellPrivateC2cRemoveContext(pInstance);
+    // ...and the multiplexer, which the module has left
+    uCellMuxPrivateRemoveContext(pInstance, false);
 
     return errorCode;
 }
@@ -1229,6 +1369,8 @@ static void quickPowerOff(uCellPrivateInstance_t *pInstance,
         // Remove any security context as these disappear
         // at power off
         uCellPrivateC2cRemoveContext(pInstance);
+        // ...and the multiplexer, which the module has left
+        uCellMuxPrivateRemoveContext(pInstance, false);
     }
 }
 
@@ -1255,11 +1397,22 @@ int32_t uCellPwrPrivateOn(uCellPrivateInstance_t *pInstance,
     uCellPrivateSleep_t *pSleepContext = pInstance->pSleepContext;
     uCellPwrDeepSleepWakeUpCallback_t *pCallback;
 
-    // We're powering on: set the sleep state to unknown, when
-    // we configure the module we will set the sleep state up
-    // correctly once more
-    pInstance->deepSleepState = U_CELL_PRIVATE_DEEP_SLEEP_STATE_UNKNOWN;
-    pInstance->deepSleepBlockedBy = -1;
+    // If the module has already been woken from deep sleep and
+    // restored (e.g. by the AT client wake-up handler, before
+    // the application got around to calling uCellPwrOn()) then
+    // everything the module lost in deep sleep has been put back
+    // and all that is required is to confirm it is still alive
+    if (!asleepAtStart && pInstance->restoredFromDeepSleep &&
+        (moduleIsAlive(pInstance, 1) == 0)) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    } else {
+        pInstance->restoredFromDeepSleep = false;
+        // We're powering on: set the sleep state to unknown, when
+        // we configure the module we will set the sleep state up
+        // correctly once more
+        pInstance->deepSleepState = U_CELL_PRIVATE_DEEP_SLEEP_STATE_UNKNOWN;
+        pInstance->deepSleepBlockedBy = -1;
+    }
 
     if (pInstance->pinEnablePower >= 0) {
         enablePowerAtStart = uPortGpioGet(pInstance->pinEnablePower);
@@ -1273,10 +1426,11 @@ int32_t uCellPwrPrivateOn(uCellPrivateInstance_t *pInstance,
     // Note: also doing this even if we were asleep because the module
     // might be asleep as far as the protocol stack is concerned but
     // not yet actually powered down.
-    if (((pInstance->pinVInt >= 0) &&
-         (uPortGpioGet(pInstance->pinVInt) == U_CELL_PRIVATE_VINT_PIN_ON_STATE(pInstance->pinStates))) ||
-        ((pInstance->pinVInt < 0) &&
-         (moduleIsAlive(pInstance, 1) == 0))) {
+    if ((errorCode != 0) &&
+        (((pInstance->pinVInt >= 0) &&
+          (uPortGpioGet(pInstance->pinVInt) == U_CELL_PRIVATE_VINT_PIN_ON_STATE(pInstance->pinStates))) ||
+         ((pInstance->pinVInt < 0) &&
+          (moduleIsAlive(pInstance, 1) == 0)))) {
         uPortLog("U_CELL_PWR: powering on, module is already on.\n");
         // Configure the module.  Since it was already
         // powered on we might have been called from
@@ -1368,6 +1522,10 @@ int32_t uCellPwrPrivateOn(uCellPrivateInstance_t *pInstance,
         quickPowerOff(pInstance, pKeepGoingCallback);
     }
 
+    if (asleepAtStart) {
+        pInstance->restoredFromDeepSleep = (errorCode == 0);
+    }
+
     // If we were successful, were asleep at the start and there is
     // a wake-up callback then call it
     if (asleepAtStart && (errorCode == 0) && (pSleepContext != NULL) &&
@@ -1385,6 +1543,10 @@ int32_t uCellPwrPrivateOn(uCellPrivateInstance_t *pInstance,
         }
     }
 
+    if (errorCode == 0) {
+        energyWake(pInstance);
+    }
+
     return errorCode;
 }
 
@@ -1675,6 +1837,53 @@ int32_t uCellPwrPrivateGetEDrx(const uCellPrivateInstance_t *pInstance,
     return errorCode;
 }
 
+// Move the energy accounts into the given state.
+void uCellPwrPrivateEnergyState(const uCellPrivateInstance_t *pInstance,
+                                uCellPwrEnergyState_t state)
+{
+    uCellPwrEnergyContext_t *pContext = (uCellPwrEnergyContext_t *) pInstance->pEnergyContext;
+
+    if ((pContext != NULL) && (state < U_CELL_PWR_ENERGY_STATE_MAX_NUM)) {
+        U_PORT_MUTEX_LOCK(pContext->mutex);
+        energyUpdate(pContext);
+        pContext->state = state;
+        U_PORT_MUTEX_UNLOCK(pContext->mutex);
+    }
+}
+
+// Add to the bytes sent or received in the energy accounts.
+void uCellPwrPrivateEnergyBytes(const uCellPrivateInstance_t *pInstance,
+                                bool sentNotReceived,
+                                int32_t negErrnoLocalOrSize)
+{
+    uCellPwrEnergyContext_t *pContext = (uCellPwrEnergyContext_t *) pInstance->pEnergyContext;
+
+    if ((pContext != NULL) && (negErrnoLocalOrSize > 0)) {
+        U_PORT_MUTEX_LOCK(pContext->mutex);
+        if (sentNotReceived) {
+            pContext->bytesSent += (uint64_t) negErrnoLocalOrSize;
+        } else {
+            pContext->bytesReceived += (uint64_t) negErrnoLocalOrSize;
+        }
+        U_PORT_MUTEX_UNLOCK(pContext->mutex);
+    }
+}
+
+// Free the energy accounts.
+void uCellPwrPrivateEnergyRemove(uCellPrivateInstance_t *pInstance)
+{
+    uCellPwrEnergyContext_t *pContext = (uCellPwrEnergyContext_t *) pInstance->pEnergyContext;
+
+    if (pContext != NULL) {
+        pInstance->pEnergyContext = NULL;
+        // Make sure no-one is still in there
+        U_PORT_MUTEX_LOCK(pContext->mutex);
+        U_PORT_MUTEX_UNLOCK(pContext->mutex);
+        uPortMutexDelete(pContext->mutex);
+        uPortFree(pContext);
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -1770,6 +1979,9 @@ int32_t uCellPwrOff(uDeviceHandle_t cellHandle,
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCode = powerOff(pInstance, pKeepGoingCallback);
+            if (errorCode == 0) {
+                uCellPwrPrivateEnergyState(pInstance, U_CELL_PWR_ENERGY_STATE_OFF);
+            }
         }
 
         U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
@@ -1805,6 +2017,8 @@ int32_t uCellPwrOffHard(uDeviceHandle_t cellHandle, bool trulyHard,
                 // Remove any security context as these disappear
                 // at power off
                 uCellPrivateC2cRemoveContext(pInstance);
+                // ...and the multiplexer, which the module has left
+                uCellMuxPrivateRemoveContext(pInstance, false);
                 errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
             } else {
                 if (pInstance->pinPwrOn >= 0) {
@@ -1838,9 +2052,14 @@ int32_t uCellPwrOffHard(uDeviceHandle_t cellHandle, bool trulyHard,
                     // Remove any security context as these disappear
                     // at power off
                     uCellPrivateC2cRemoveContext(pInstance);
+                    // ...and the multiplexer, which the module has left
+                    uCellMuxPrivateRemoveContext(pInstance, false);
                     errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                 }
             }
+            if (errorCode == 0) {
+                uCellPwrPrivateEnergyState(pInstance, U_CELL_PWR_ENERGY_STATE_OFF);
+            }
         }
 
         U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
@@ -1903,7 +2122,7 @@ int32_t uCellPwrReboot(uDeviceHandle_t cellHandle,
             // Clear the dynamic parameters
             uCellPrivateClearDynamicParameters(pInstance);
             uAtClientCommandStart(atHandle, "AT+CFUN=");
-            if (pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_SARA_R5) {
+            if (U_CELL_PRIVATE_MODULE_IS(pInstance->pModule, U_CELL_MODULE_TYPE_SARA_R5)) {
                 // SARA-R5 doesn't support 15 (which doesn't reset the SIM)
                 uAtClientWriteInt(atHandle, 16);
             } else {
@@ -1914,6 +2133,8 @@ int32_t uCellPwrReboot(uDeviceHandle_t cellHandle,
             if (errorCode == 0) {
                 // Remove any security context as these disappear at reboot
                 uCellPrivateC2cRemoveContext(pInstance);
+                // ...and the multiplexer, which the module has left
+                uCellMuxPrivateRemoveContext(pInstance, false);
                 // We have rebooted
                 pInstance->rebootIsRequired = false;
                 // Wait for the module to boot
@@ -1925,7 +2146,7 @@ int32_t uCellPwrReboot(uDeviceHandle_t cellHandle,
                 // to be entered at a power cycle
                 for (size_t x = 2; (x > 0) && (!success) &&
                      ((pKeepGoingCallback == NULL) || pKeepGoingCallback(cellHandle)); x--) {
-                    if (pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_SARA_R5) {
+                    if (U_CELL_PRIVATE_MODULE_IS(pInstance->pModule, U_CELL_MODULE_TYPE_SARA_R5)) {
                         // SARA-R5 chucks out a load of stuff after
                         // boot in its development version: flush it away
                         uAtClientFlush(atHandle);
@@ -2035,6 +2256,8 @@ int32_t uCellPwrResetHard(uDeviceHandle_t cellHandle, int32_t pinReset)
         if ((pInstance != NULL) && (pinReset >= 0)) {
             errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
             resetHoldMilliseconds = pInstance->pModule->resetHoldMilliseconds;
+            // A reset is as good as a reboot
+            uCellPrivateClearIdCache(pInstance, false);
             uPortLog("U_CELL_PWR: performing hard reset, this will take"
                      " at least %d milliseconds...\n", resetHoldMilliseconds +
                      (pInstance->pModule->rebootCommandWaitSeconds * 1000));
@@ -2052,6 +2275,8 @@ int32_t uCellPwrResetHard(uDeviceHandle_t cellHandle, int32_t pinReset)
                 if (platformError == 0) {
                     // Remove any security context as these disappear at reboot
                     uCellPrivateC2cRemoveContext(pInstance);
+                    // ...and the multiplexer, which the module has left
+                    uCellMuxPrivateRemoveContext(pInstance, false);
                     // We have rebooted
                     pInstance->rebootIsRequired = false;
                     startTime = uPortGetTickTimeMs();
@@ -2065,7 +2290,7 @@ int32_t uCellPwrResetHard(uDeviceHandle_t cellHandle, int32_t pinReset)
                     uPortGpioSet(pinReset, (int32_t) !U_CELL_RESET_PIN_TOGGLE_TO_STATE);
                     // Wait for the module to boot
                     uPortTaskBlock(pInstance->pModule->rebootCommandWaitSeconds * 1000);
-                    if (pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_SARA_R5) {
+                    if (U_CELL_PRIVATE_MODULE_IS(pInstance->pModule, U_CELL_MODULE_TYPE_SARA_R5)) {
                         // SARA-R5 chucks out a load of stuff after
                         // boot in its development version: flush it away
                         uAtClientFlush(pInstance->atHandle);
@@ -2901,5 +3126,122 @@ bool uCellPwrUartSleepIsEnabled(uDeviceHandle_t cellHandle)
     return isEnabled;
 }
 
+// Start energy accounting.
+int32_t uCellPwrEnergyStart(uDeviceHandle_t cellHandle,
+                            const uCellPwrCurrentTable_t *pTable)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellPwrEnergyContext_t *pContext;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pInstance != NULL) {
+            // Start from scratch
+            uCellPwrPrivateEnergyRemove(pInstance);
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pContext = (uCellPwrEnergyContext_t *) pUPortMalloc(sizeof(*pContext));
+            if (pContext != NULL) {
+                memset(pContext, 0, sizeof(*pContext));
+                errorCode = uPortMutexCreate(&(pContext->mutex));
+                if (errorCode == 0) {
+                    if (pTable != NULL) {
+                        pContext->table = *pTable;
+                        pContext->hasTable = true;
+                    }
+                    // Work out where we are starting from
+                    pContext->state = U_CELL_PWR_ENERGY_STATE_IDLE;
+                    if ((pInstance->deepSleepState == U_CELL_PRIVATE_DEEP_SLEEP_STATE_ASLEEP) ||
+                        (pInstance->deepSleepState == U_CELL_PRIVATE_DEEP_SLEEP_STATE_PROTOCOL_STACK_ASLEEP)) {
+                        pContext->state = U_CELL_PWR_ENERGY_STATE_PSM;
+                    } else if (pInstance->baseStationConnection == 1) {
+                        pContext->state = U_CELL_PWR_ENERGY_STATE_CONNECTED;
+                    }
+                    pContext->stateStartTimeMs = uPortGetTickTimeMs();
+                    pInstance->pEnergyContext = pContext;
+                } else {
+                    uPortFree(pContext);
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Get the energy accounts.
+int32_t uCellPwrEnergyGet(uDeviceHandle_t cellHandle,
+                          uCellPwrEnergy_t *pEnergy)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellPwrEnergyContext_t *pContext;
+    int64_t microjoules = 0;
+    uint64_t bytes;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pInstance != NULL) && (pEnergy != NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+            pContext = (uCellPwrEnergyContext_t *) pInstance->pEnergyContext;
+            if (pContext != NULL) {
+                U_PORT_MUTEX_LOCK(pContext->mutex);
+                energyUpdate(pContext);
+                memcpy(pEnergy->timeMs, pContext->timeMs, sizeof(pEnergy->timeMs));
+                pEnergy->bytesSent = pContext->bytesSent;
+                pEnergy->bytesReceived = pContext->bytesReceived;
+                U_PORT_MUTEX_UNLOCK(pContext->mutex);
+                pEnergy->energyMicrojoules = -1;
+                pEnergy->energyPerByteNanojoules = -1;
+                if (pContext->hasTable) {
+                    // ms * uA * mV is uJ * 1000000
+                    for (size_t x = 0; x < U_CELL_PWR_ENERGY_STATE_MAX_NUM; x++) {
+                        microjoules += (pEnergy->timeMs[x] *
+                                        pContext->table.currentMicroAmps[x] *
+                                        pContext->table.supplyMillivolts) / 1000000;
+                    }
+                    pEnergy->energyMicrojoules = microjoules;
+                    bytes = pEnergy->bytesSent + pEnergy->bytesReceived;
+                    if (bytes > 0) {
+                        pEnergy->energyPerByteNanojoules = (int64_t) (((uint64_t) microjoules * 1000) / bytes);
+                    }
+                }
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Stop energy accounting.
+void uCellPwrEnergyStop(uDeviceHandle_t cellHandle)
+{
+    uCellPrivateInstance_t *pInstance;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        if (pInstance != NULL) {
+            uCellPwrPrivateEnergyRemove(pInstance);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+}
 
 // End of file
@@ -159,6 +159,41 @@ int32_t uCellPwrPrivateGetEDrx(const uCellPrivateInstance_t *pInstance,
                                int32_t *pEDrxSeconds,
                                int32_t *pPagingWindowSeconds);
 
+/** Move the energy accounts of a cellular instance, if they have
+ * been started with uCellPwrEnergyStart(), into the given power
+ * state; does nothing if energy accounting is not running.  May be
+ * called from a URC.
+ *
+ * @param pInstance  a pointer to the cellular instance.
+ * @param state      the power state that the module is now in.
+ */
+void uCellPwrPrivateEnergyState(const uCellPrivateInstance_t *pInstance,
+                                uCellPwrEnergyState_t state);
+
+/** Add to the bytes sent or received in the energy accounts of a
+ * cellular instance; does nothing if energy accounting is not
+ * running.
+ *
+ * @param pInstance            a pointer to the cellular instance.
+ * @param sentNotReceived      true if the bytes were sent, false if
+ *                             they were received.
+ * @param negErrnoLocalOrSize  the return value of the socket
+ *                             function: values less than or equal
+ *                             to zero are ignored.
+ */
+void uCellPwrPrivateEnergyBytes(const uCellPrivateInstance_t *pInstance,
+                                bool sentNotReceived,
+                                int32_t negErrnoLocalOrSize);
+
+/** Free the energy accounts of a cellular instance, if there are
+ * any.
+ *
+ * Note: gUCellPrivateMutex should be locked before this is called.
+ *
+ * @param pInstance  a pointer to the cellular instance.
+ */
+void uCellPwrPrivateEnergyRemove(uCellPrivateInstance_t *pInstance);
+
 #ifdef __cplusplus
 }
 #endif
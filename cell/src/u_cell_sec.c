@@ -54,6 +54,7 @@
 
 #include "u_cell_sec.h"
 #include "u_cell_sec_c2c.h"
+#include "u_cell_sec_private.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -119,10 +120,28 @@
 # error U_SECURITY_PSK_MAX_LENGTH_BYTES is smaller than U_SECURITY_PSK_ID_MAX_LENGTH_BYTES.
 #endif
 
+// Check that the ZTP cache has room for the root of trust UID
+#if U_CELL_PRIVATE_ZTP_CACHE_ROOT_OF_TRUST_UID_LENGTH_BYTES != U_SECURITY_ROOT_OF_TRUST_UID_LENGTH_BYTES
+# error U_CELL_PRIVATE_ZTP_CACHE_ROOT_OF_TRUST_UID_LENGTH_BYTES not the same as U_SECURITY_ROOT_OF_TRUST_UID_LENGTH_BYTES.
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** A security heartbeat waiting to be sent, see
+ * uCellSecHeartbeatTriggerDeferred(); hooked into pHeartbeatContext
+ * of the instance.
+ */
+typedef struct {
+    uDeviceHandle_t cellHandle;
+    uAtClientHandle_t atHandle;
+    uPortTimerHandle_t timerHandle; /**< Expires at the deadline, NULL
+                                         if there is no deadline. */
+    void (*pCallback) (uDeviceHandle_t, int32_t, void *);
+    void *pCallbackParam;
+} uCellSecHeartbeatDeferred_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -168,12 +187,89 @@ static bool moduleIsSealed(const uCellPrivateInstance_t *pInstance)
     return isSealed;
 }
 
-// Read a certificate/key/authority generated/used during sealing.
+// Read the binary root of trust UID from a cellular module, a
+// single attempt; pRootOfTrustUid must point to storage of length
+// U_SECURITY_ROOT_OF_TRUST_UID_LENGTH_BYTES.
+static int32_t rootOfTrustUidRead(const uCellPrivateInstance_t *pInstance,
+                                  char *pRootOfTrustUid)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+    int32_t sizeOutBytes;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    char buffer[(U_SECURITY_ROOT_OF_TRUST_UID_LENGTH_BYTES * 2) + 1]; // * 2 for hex,  +1 for terminator
+
+    uAtClientLock(atHandle);
+    uAtClientTimeoutSet(atHandle,
+                        U_CELL_SEC_TRANSACTION_TIMEOUT_SECONDS * 1000);
+    uAtClientCommandStart(atHandle, "AT+USECROTUID");
+    uAtClientCommandStop(atHandle);
+    uAtClientResponseStart(atHandle, "+USECROTUID:");
+    sizeOutBytes = uAtClientReadString(atHandle, buffer,
+                                       sizeof(buffer),
+                                       false);
+    uAtClientResponseStop(atHandle);
+    if ((uAtClientUnlock(atHandle) == 0) &&
+        (sizeOutBytes == sizeof(buffer) - 1)) {
+        errorCodeOrSize = (int32_t) uHexToBin(buffer,
+                                              sizeOutBytes,
+                                              pRootOfTrustUid);
+    }
+
+    return errorCodeOrSize;
+}
+
+// Make sure that a ZTP cache belongs to the module it is attached
+// to, emptying it if it does not or if that cannot be determined.
+static void ztpCacheValidate(const uCellPrivateInstance_t *pInstance,
+                             uCellPrivateZtpCache_t *pCache)
+{
+    char rootOfTrustUid[U_SECURITY_ROOT_OF_TRUST_UID_LENGTH_BYTES];
+
+    if (rootOfTrustUidRead(pInstance, rootOfTrustUid) == sizeof(rootOfTrustUid)) {
+        if (!pCache->rootOfTrustUidValid ||
+            (memcmp(rootOfTrustUid, pCache->rootOfTrustUid,
+                    sizeof(rootOfTrustUid)) != 0)) {
+            uCellPrivateZtpCacheFlush(pCache);
+            memcpy(pCache->rootOfTrustUid, rootOfTrustUid, sizeof(pCache->rootOfTrustUid));
+            pCache->rootOfTrustUidValid = true;
+        }
+    } else {
+        // Can't tell, so nothing must be served from or added to the cache
+        uCellPrivateZtpCacheFlush(pCache);
+    }
+}
+
+// Copy a certificate/key/authority out of a ZTP cache, with the
+// same truncation behaviour as reading it from the module.
+static int32_t ztpCacheCopy(const uCellPrivateZtpCache_t *pCache, int32_t type,
+                            char *pData, size_t dataSizeBytes)
+{
+    int32_t size = (int32_t) pCache->itemSizeBytes[type];
+    size_t length = pCache->itemSizeBytes[type] - 1;
+
+    if (pData != NULL) {
+        size = 0;
+        if (dataSizeBytes > 0) {
+            if (length > dataSizeBytes - 1) {
+                length = dataSizeBytes - 1;
+            }
+            memcpy(pData, pCache->pItem[type], length);
+            *(pData + length) = 0;
+            size = (int32_t) length + 1;
+        }
+    }
+
+    return size;
+}
+
+// Read a certificate/key/authority generated/used during sealing,
+// from the ZTP cache if there is one and it has the item.
 static int32_t ztpGet(uDeviceHandle_t cellHandle, int32_t type,
                       char *pData, size_t dataSizeBytes)
 {
     int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance;
+    uCellPrivateZtpCache_t *pCache;
     uAtClientHandle_t atHandle;
     int32_t x;
 
@@ -187,28 +283,54 @@ static int32_t ztpGet(uDeviceHandle_t cellHandle, int32_t type,
             errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
             if (U_CELL_PRIVATE_HAS(pInstance->pModule,
                                    U_CELL_PRIVATE_FEATURE_SECURITY_ZTP)) {
-                atHandle = pInstance->atHandle;
-                uAtClientLock(atHandle);
-                uAtClientCommandStart(atHandle, "AT+USECDEVCERT=");
-                uAtClientWriteInt(atHandle, type);
-                uAtClientCommandStop(atHandle);
-                uAtClientResponseStart(atHandle, "+USECDEVCERT:");
-                // Skip the type that is sent back to us
-                uAtClientSkipParameters(atHandle, 1);
-                // Read the string that follows
-                if (pData == NULL) {
-                    // If the data is to be thrown away, make
-                    // sure all of it is thrown away
-                    dataSizeBytes = INT_MAX;
+                pCache = pInstance->pZtpCache;
+                if (pCache != NULL) {
+                    ztpCacheValidate(pInstance, pCache);
                 }
-                x = uAtClientReadString(atHandle, pData,
-                                        // Cast in two stages to keep Lint happy
-                                        (size_t)  (unsigned) dataSizeBytes,
-                                        false);
-                uAtClientResponseStop(atHandle);
-                errorCodeOrSize = uAtClientUnlock(atHandle);
-                if ((errorCodeOrSize == 0) && (x > 0)) {
-                    errorCodeOrSize = x + 1; // +1 to include the terminator in the count
+                if ((pCache != NULL) && (pCache->pItem[type] != NULL)) {
+                    errorCodeOrSize = ztpCacheCopy(pCache, type, pData, dataSizeBytes);
+                } else if ((pCache != NULL) && (pData == NULL) &&
+                           (pCache->itemSizeBytes[type] > 0)) {
+                    // Only the size was asked for and we know it
+                    errorCodeOrSize = (int32_t) pCache->itemSizeBytes[type];
+                } else {
+                    atHandle = pInstance->atHandle;
+                    uAtClientLock(atHandle);
+                    uAtClientCommandStart(atHandle, "AT+USECDEVCERT=");
+                    uAtClientWriteInt(atHandle, type);
+                    uAtClientCommandStop(atHandle);
+                    uAtClientResponseStart(atHandle, "+USECDEVCERT:");
+                    // Skip the type that is sent back to us
+                    uAtClientSkipParameters(atHandle, 1);
+                    // Read the string that follows
+                    if (pData == NULL) {
+                        // If the data is to be thrown away, make
+                        // sure all of it is thrown away
+                        dataSizeBytes = INT_MAX;
+                    }
+                    x = uAtClientReadString(atHandle, pData,
+                                            // Cast in two stages to keep Lint happy
+                                            (size_t)  (unsigned) dataSizeBytes,
+                                            false);
+                    uAtClientResponseStop(atHandle);
+                    errorCodeOrSize = uAtClientUnlock(atHandle);
+                    if ((errorCodeOrSize == 0) && (x > 0)) {
+                        errorCodeOrSize = x + 1; // +1 to include the terminator in the count
+                        if ((pCache != NULL) && pCache->rootOfTrustUidValid) {
+                            if (pData == NULL) {
+                                pCache->itemSizeBytes[type] = (size_t) errorCodeOrSize;
+                            } else if (((size_t) errorCodeOrSize < dataSizeBytes) ||
+                                       ((size_t) errorCodeOrSize == pCache->itemSizeBytes[type])) {
+                                // We know that we have all of it (rather than
+                                // it having been truncated to fit) so keep a copy
+                                pCache->pItem[type] = (char *) pUPortMalloc(errorCodeOrSize);
+                                if (pCache->pItem[type] != NULL) {
+                                    memcpy(pCache->pItem[type], pData, errorCodeOrSize);
+                                    pCache->itemSizeBytes[type] = (size_t) errorCodeOrSize;
+                                }
+                            }
+                        }
+                    }
                 }
             }
         }
@@ -315,6 +437,96 @@ static size_t encryptC2cConfirmationTag(const char *pC2cConfirmationTagHex,
     return length;
 }
 
+// Free a deferred heartbeat, stopping its timer.
+static void heartbeatDeferredFree(uCellSecHeartbeatDeferred_t *pContext)
+{
+    if (pContext->timerHandle != NULL) {
+        uPortTimerDelete(pContext->timerHandle);
+    }
+    uPortFree(pContext);
+}
+
+// Send a deferred heartbeat, called via uAtClientCallback().
+static void heartbeatDeferredSend(uAtClientHandle_t atHandle,
+                                  void *pParameter)
+{
+    uDeviceHandle_t cellHandle = (uDeviceHandle_t) pParameter;
+    uCellPrivateInstance_t *pInstance;
+    uCellSecHeartbeatDeferred_t *pContext = NULL;
+    int32_t errorCode;
+
+    (void) atHandle;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        if (pInstance != NULL) {
+            // Take the heartbeat off the instance; if it has
+            // been cancelled, or already sent by an earlier
+            // call to this function, there will be nothing
+            // to take
+            pContext = (uCellSecHeartbeatDeferred_t *) pInstance->pHeartbeatContext;
+            pInstance->pHeartbeatContext = NULL;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    if (pContext != NULL) {
+        errorCode = uCellSecHeartbeatTrigger(cellHandle);
+        if (pContext->pCallback != NULL) {
+            pContext->pCallback(cellHandle, errorCode, pContext->pCallbackParam);
+        }
+        heartbeatDeferredFree(pContext);
+    }
+}
+
+// Queue heartbeatDeferredSend(); this deliberately takes no
+// pointer to the heartbeat since, by the time the queued
+// function runs, the heartbeat may have been sent or cancelled.
+static int32_t heartbeatDeferredPost(uAtClientHandle_t atHandle,
+                                     uDeviceHandle_t cellHandle)
+{
+    return uAtClientCallback(atHandle, heartbeatDeferredSend,
+                             (void *) cellHandle);
+}
+
+// Callback for when the deadline of a deferred heartbeat expires.
+static void heartbeatDeferredTimerCallback(const uPortTimerHandle_t timerHandle,
+                                           void *pParameter)
+{
+    uCellSecHeartbeatDeferred_t *pContext = (uCellSecHeartbeatDeferred_t *) pParameter;
+
+    (void) timerHandle;
+
+    heartbeatDeferredPost(pContext->atHandle, pContext->cellHandle);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS THAT ARE PRIVATE TO CELLULAR
+ * -------------------------------------------------------------- */
+
+// Send a deferred heartbeat now that the radio is awake.
+void uCellSecPrivateHeartbeatWake(const uCellPrivateInstance_t *pInstance)
+{
+    if (pInstance->pHeartbeatContext != NULL) {
+        heartbeatDeferredPost(pInstance->atHandle, pInstance->cellHandle);
+    }
+}
+
+// Free a deferred heartbeat without sending it.
+void uCellSecPrivateHeartbeatRemove(uCellPrivateInstance_t *pInstance)
+{
+    uCellSecHeartbeatDeferred_t *pContext = (uCellSecHeartbeatDeferred_t *) pInstance->pHeartbeatContext;
+
+    if (pContext != NULL) {
+        pInstance->pHeartbeatContext = NULL;
+        heartbeatDeferredFree(pContext);
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: INFORMATION
  * -------------------------------------------------------------- */
@@ -420,10 +632,7 @@ int32_t uCellSecGetRootOfTrustUid(uDeviceHandle_t cellHandle,
                                   char *pRootOfTrustUid)
 {
     int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
-    int32_t sizeOutBytes;
     uCellPrivateInstance_t *pInstance;
-    uAtClientHandle_t atHandle;
-    char buffer[(U_SECURITY_ROOT_OF_TRUST_UID_LENGTH_BYTES * 2) + 1]; // * 2 for hex,  +1 for terminator
 
     if (gUCellPrivateMutex != NULL) {
 
@@ -440,23 +649,9 @@ int32_t uCellSecGetRootOfTrustUid(uDeviceHandle_t cellHandle,
                     // can take a little while if the module has just booted
                     errorCodeOrSize = (int32_t) U_ERROR_COMMON_TEMPORARY_FAILURE;
                     for (size_t x = 3; (x > 0) && (errorCodeOrSize < 0); x--) {
-                        atHandle = pInstance->atHandle;
-                        uAtClientLock(atHandle);
-                        uAtClientTimeoutSet(atHandle,
-                                            U_CELL_SEC_TRANSACTION_TIMEOUT_SECONDS * 1000);
-                        uAtClientCommandStart(atHandle, "AT+USECROTUID");
-                        uAtClientCommandStop(atHandle);
-                        uAtClientResponseStart(atHandle, "+USECROTUID:");
-                        sizeOutBytes = uAtClientReadString(atHandle, buffer,
-                                                           sizeof(buffer),
-                                                           false);
-                        uAtClientResponseStop(atHandle);
-                        if ((uAtClientUnlock(atHandle) == 0) &&
-                            (sizeOutBytes == sizeof(buffer) - 1)) {
-                            errorCodeOrSize = (int32_t) uHexToBin(buffer,
-                                                                  sizeOutBytes,
-                                                                  pRootOfTrustUid);
-                        } else {
+                        errorCodeOrSize = rootOfTrustUidRead(pInstance, pRootOfTrustUid);
+                        if (errorCodeOrSize < 0) {
+                            errorCodeOrSize = (int32_t) U_ERROR_COMMON_TEMPORARY_FAILURE;
                             uPortTaskBlock(5000);
                         }
                     }
@@ -808,6 +1003,8 @@ int32_t uCellSecSealSet(uDeviceHandle_t cellHandle,
                            ((pKeepGoingCallback == NULL) ||
                             pKeepGoingCallback())) {
                         if (moduleIsSealed(pInstance)) {
+                            // The ZTP items will be new
+                            uCellPrivateZtpCacheFlush(pInstance->pZtpCache);
                             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                         } else {
                             uPortTaskBlock(1000);
@@ -875,6 +1072,63 @@ int32_t uCellSecZtpGetCertificateAuthorities(uDeviceHandle_t cellHandle,
     return ztpGet(cellHandle, 2, pData, dataSizeBytes);
 }
 
+// Switch caching of the ZTP items on or off.
+int32_t uCellSecZtpSetCache(uDeviceHandle_t cellHandle, bool onNotOff)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellPrivateZtpCache_t *pCache;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pInstance != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (U_CELL_PRIVATE_HAS(pInstance->pModule,
+                                   U_CELL_PRIVATE_FEATURE_SECURITY_ZTP)) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                if (!onNotOff) {
+                    uCellPrivateZtpCacheRemove(pInstance);
+                } else if (pInstance->pZtpCache == NULL) {
+                    errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                    pCache = (uCellPrivateZtpCache_t *) pUPortMalloc(sizeof(*pCache));
+                    if (pCache != NULL) {
+                        memset(pCache, 0, sizeof(*pCache));
+                        pInstance->pZtpCache = pCache;
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Get whether caching of the ZTP items is on.
+bool uCellSecZtpCacheIsOn(uDeviceHandle_t cellHandle)
+{
+    bool isOn = false;
+    uCellPrivateInstance_t *pInstance;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        isOn = (pInstance != NULL) && (pInstance->pZtpCache != NULL);
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return isOn;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: END TO END ENCRYPTION
  * -------------------------------------------------------------- */
@@ -1140,4 +1394,91 @@ int32_t uCellSecHeartbeatTrigger(uDeviceHandle_t cellHandle)
     return errorCode;
 }
 
+// Trigger a security heartbeat when the radio is awake anyway.
+int32_t uCellSecHeartbeatTriggerDeferred(uDeviceHandle_t cellHandle,
+                                         int32_t deadlineMs,
+                                         void (*pCallback) (uDeviceHandle_t,
+                                                            int32_t,
+                                                            void *),
+                                         void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellSecHeartbeatDeferred_t *pContext;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pInstance != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (U_CELL_PRIVATE_HAS(pInstance->pModule,
+                                   U_CELL_PRIVATE_FEATURE_ROOT_OF_TRUST)) {
+                errorCode = (int32_t) U_ERROR_COMMON_TEMPORARY_FAILURE;
+                if (pInstance->pHeartbeatContext == NULL) {
+                    errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                    pContext = (uCellSecHeartbeatDeferred_t *) pUPortMalloc(sizeof(*pContext));
+                    if (pContext != NULL) {
+                        memset(pContext, 0, sizeof(*pContext));
+                        pContext->cellHandle = cellHandle;
+                        pContext->atHandle = pInstance->atHandle;
+                        pContext->pCallback = pCallback;
+                        pContext->pCallbackParam = pCallbackParam;
+                        // Hook the heartbeat in before starting anything
+                        // that might send it; it can't actually be sent
+                        // until we let go of gUCellPrivateMutex
+                        pInstance->pHeartbeatContext = pContext;
+                        if ((deadlineMs > 0) && (pInstance->baseStationConnection != 1)) {
+                            // Wait for the radio to wake up or the deadline
+                            errorCode = uPortTimerCreate(&(pContext->timerHandle),
+                                                         "cellHeartbeat",
+                                                         heartbeatDeferredTimerCallback,
+                                                         pContext, deadlineMs, false);
+                            if (errorCode == 0) {
+                                errorCode = uPortTimerStart(pContext->timerHandle);
+                            }
+                        } else {
+                            // No point in waiting
+                            errorCode = heartbeatDeferredPost(pInstance->atHandle,
+                                                              cellHandle);
+                        }
+                        if (errorCode != 0) {
+                            uCellSecPrivateHeartbeatRemove(pInstance);
+                        }
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Cancel a deferred security heartbeat.
+int32_t uCellSecHeartbeatCancelDeferred(uDeviceHandle_t cellHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pInstance != NULL) {
+            uCellSecPrivateHeartbeatRemove(pInstance);
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
 // End of file
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_CELL_SEC_PRIVATE_H_
+#define _U_CELL_SEC_PRIVATE_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** @file
+ * @brief This header file defines a few security functions that are
+ * needed in an internal form inside the cellular API, so that the
+ * net and sock parts of the cellular API can tell a deferred security
+ * heartbeat that the radio is awake.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Tell a security heartbeat waiting to be sent, if there is one,
+ * that the radio is known to be awake (e.g. because data has just
+ * been sent or +CSCON has indicated connected) and so it should be
+ * sent now; does nothing if there is no heartbeat waiting.  The
+ * heartbeat is sent via uAtClientCallback(), hence this may be
+ * called from a URC.
+ *
+ * @param pInstance  a pointer to the cellular instance.
+ */
+void uCellSecPrivateHeartbeatWake(const uCellPrivateInstance_t *pInstance);
+
+/** Free a security heartbeat waiting to be sent, if there is one,
+ * without sending it.
+ *
+ * Note: gUCellPrivateMutex should be locked before this is called.
+ *
+ * @param pInstance  a pointer to the cellular instance.
+ */
+void uCellSecPrivateHeartbeatRemove(uCellPrivateInstance_t *pInstance);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_CELL_SEC_PRIVATE_H_
+
+// End of file
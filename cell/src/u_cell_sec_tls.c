@@ -1250,4 +1250,84 @@ int32_t uCellSecTlsSniGet(const uCellSecTlsContext_t *pContext,
     return gLastErrorCode;
 }
 
+// Set whether TLS session resumption is enabled.
+int32_t uCellSecTlsSessionResumptionSet(const uCellSecTlsContext_t *pContext,
+                                        bool onNotOff)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uAtClientHandle_t atHandle;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pContext != NULL) {
+            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            if (pInstance != NULL) {
+                errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+                if (U_CELL_PRIVATE_HAS(pInstance->pModule,
+                                       U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SESSION_RESUMPTION)) {
+                    atHandle = pInstance->atHandle;
+                    uAtClientLock(atHandle);
+                    uAtClientCommandStart(atHandle, "AT+USECPRF=");
+                    uAtClientWriteInt(atHandle, pContext->profileId);
+                    // Operation 13 is the session resumption operation
+                    uAtClientWriteInt(atHandle, 13);
+                    uAtClientWriteInt(atHandle, onNotOff ? 1 : 0);
+                    uAtClientCommandStopReadResponse(atHandle);
+                    errorCode = uAtClientUnlock(atHandle);
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Get whether TLS session resumption is enabled.
+bool uCellSecTlsIsSessionResumptionOn(const uCellSecTlsContext_t *pContext)
+{
+    uCellPrivateInstance_t *pInstance;
+    uAtClientHandle_t atHandle;
+    int32_t x;
+    bool isOn = false;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        if (pContext != NULL) {
+            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            if ((pInstance != NULL) &&
+                U_CELL_PRIVATE_HAS(pInstance->pModule,
+                                   U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SESSION_RESUMPTION)) {
+                atHandle = pInstance->atHandle;
+                uAtClientLock(atHandle);
+                uAtClientCommandStart(atHandle, "AT+USECPRF=");
+                uAtClientWriteInt(atHandle, pContext->profileId);
+                uAtClientWriteInt(atHandle, 13);
+                uAtClientCommandStop(atHandle);
+                // The response is +USECPRF: 0,13,x
+                uAtClientResponseStart(atHandle, "+USECPRF:");
+                // Skip the first parameter, which is just 13
+                // coming back at us
+                uAtClientSkipParameters(atHandle, 1);
+                x = uAtClientReadInt(atHandle);
+                uAtClientResponseStop(atHandle);
+                if ((uAtClientUnlock(atHandle) == 0) && (x == 1)) {
+                    isOn = true;
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return isOn;
+}
+
 // End of file
@@ -41,6 +41,7 @@
 #include "u_port_heap.h"
 #include "u_port_debug.h"
 #include "u_port_os.h"
+#include "u_port_uart.h"
 
 #include "u_at_client.h"
 
@@ -54,6 +55,10 @@
 #include "u_cell_net.h"
 #include "u_cell_private.h"
 #include "u_cell_sock.h"
+#include "u_cell_pwr.h"
+#include "u_cell_pwr_private.h"
+#include "u_cell_sec_private.h"
+#include "u_cell_sock_private.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -98,6 +103,13 @@
 #define U_CELL_SOCK_SARA_R422_DNS_DELAY_MILLISECONDS 500
 #endif
 
+/** The most that an AT+USOST command sent in hex mode, excluding
+ * the hex-coded data, can occupy, including a null terminator:
+ * AT+USOST=<handle>,"<address>",<port>,<length>,"" with room for
+ * 32-bit integers and a little to spare.
+ */
+#define U_CELL_SOCK_USOST_HEX_OVERHEAD_BYTES (48 + U_SOCK_ADDRESS_STRING_MAX_LENGTH_BYTES)
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -115,15 +127,42 @@ typedef struct {
                                    uses for the socket instance.
                                    -1 if this socket is not in use. */
     volatile int32_t pendingBytes;
+    char *pReadAhead; /**< the read-ahead buffer, NULL if there isn't one,
+                           see U_SOCK_OPT_RCVBUF. */
+    size_t readAheadSizeBytes; /**< the amount of storage at pReadAhead. */
+    size_t readAheadStart; /**< the offset of the first unread byte at pReadAhead. */
+    size_t readAheadLength; /**< the number of unread bytes at pReadAhead. */
+    bool directLink; /**< true if this socket is in direct link mode,
+                          see uCellSockDirectLinkStart(). */
+    bool directLinkAtBuffered; /**< true if the AT client may still hold
+                                    data received in direct link mode. */
+    int32_t directLinkStreamHandle; /**< the UART handle used in direct link mode. */
+    int32_t directLinkLastTxMs; /**< the time of the last write in direct link mode. */
     void (*pAsyncClosedCallback) (uDeviceHandle_t, int32_t); /**< Set to NULL
                                                           if socket is
                                                           not in use. */
     void (*pDataCallback) (uDeviceHandle_t, int32_t); /**< Set to NULL if
                                                    socket is not
                                                    in use. */
+    volatile bool dataNotified; /**< true if pDataCallback has been
+                                     queued since the last read, in
+                                     which case further +UUSORD/+UUSORF
+                                     URCs only update pendingBytes. */
     void (*pClosedCallback) (uDeviceHandle_t, int32_t); /**< Set to NULL
                                                      if socket is
                                                      not in use. */
+    void (*pConnectCallback) (uDeviceHandle_t, int32_t, int32_t); /**< Set
+                                                              while an
+                                                              asynchronous
+                                                              connect is
+                                                              in progress. */
+    volatile int32_t connectNegErrno; /**< The outcome of an asynchronous
+                                           connect, from +UUSOCO. */
+    uSockProtocol_t protocol; /**< The protocol the socket was created with. */
+    int32_t localPort; /**< The local port the socket was created with,
+                            -1 if it was left to the IP stack. */
+    int32_t contextId; /**< The PDP context the socket uses,
+                            see U_SOCK_OPT_PDP_CONTEXT. */
 } uCellSockSocket_t;
 
 /** Definition of a URC handler.
@@ -133,6 +172,24 @@ typedef struct {
     void (*pHandler) (uAtClientHandle_t, void *);
 } uCellSockUrcHandler_t;
 
+/** The pool of sockets created in the module in advance for a
+ * cellular instance, see uCellSockPoolSet(); hooked into
+ * pSockPoolContext of the instance.
+ */
+typedef struct {
+    uPortMutexHandle_t mutex; /**< Protects the rest of this structure;
+                                   never held across an AT command. */
+    size_t numTcpWanted; /**< The number of TCP sockets to keep. */
+    size_t numUdpWanted; /**< The number of UDP sockets to keep. */
+    bool fillPosted; /**< True if poolFill() has been queued. */
+    int32_t sockHandleModule[U_CELL_SOCK_POOL_MAX_NUM]; /**< The module's
+                                                             handles for the
+                                                             sockets in the pool,
+                                                             -1 where empty. */
+    uSockProtocol_t protocol[U_CELL_SOCK_POOL_MAX_NUM]; /**< The protocol of
+                                                             each socket. */
+} uCellSockPool_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -197,6 +254,94 @@ static void doUsoer(uAtClientHandle_t atHandle)
     uAtClientUnlock(atHandle);
 }
 
+// Create a socket in the module with AT+USOCR, returning the
+// module's handle for it or negative error code; profileId is
+// the internal profile of the PDP context to use, -1 for the
+// default one.
+static int32_t createInModule(uAtClientHandle_t atHandle,
+                              uSockProtocol_t protocol,
+                              int32_t localPort, int32_t profileId)
+{
+    int32_t sockHandleModule;
+
+    uAtClientLock(atHandle);
+    uAtClientCommandStart(atHandle, "AT+USOCR=");
+    // Protocol is 6 for TCP or 17 for UDP
+    uAtClientWriteInt(atHandle, (int32_t) protocol);
+    // User-specified local port number
+    if (localPort >= 0) {
+        uAtClientWriteInt(atHandle, localPort);
+    } else if (profileId >= 0) {
+        uAtClientWriteString(atHandle, "", false);
+    }
+    if (profileId >= 0) {
+        // Leave the IP type as the default and give the profile
+        uAtClientWriteString(atHandle, "", false);
+        uAtClientWriteInt(atHandle, profileId);
+    }
+    uAtClientCommandStop(atHandle);
+    uAtClientResponseStart(atHandle, "+USOCR:");
+    sockHandleModule = uAtClientReadInt(atHandle);
+    uAtClientResponseStop(atHandle);
+    if (uAtClientUnlock(atHandle) != 0) {
+        sockHandleModule = -1;
+    }
+
+    return sockHandleModule;
+}
+
+// Read a quoted hex string of up to hexLength characters from
+// the AT stream, decoding it straight from the AT client receive
+// buffer into pData, which must have room for dataSizeBytes;
+// any hex beyond that is left for uAtClientResponseStop() to
+// throw away.  The stream must be locked and the stop tag
+// must be active.
+static void readHexDirect(uAtClientHandle_t atHandle, int32_t hexLength,
+                          char *pData, size_t dataSizeBytes)
+{
+    const char *pHex;
+    const char *pQuote;
+    char pair[2];
+    int32_t length = 0;
+
+    // Get the leading quote mark out of the way
+    uAtClientReadBytes(atHandle, NULL, 1, true);
+    while ((hexLength > 1) && (dataSizeBytes > 0) && (length >= 0)) {
+        length = uAtClientReadBytesPeek(atHandle, &pHex, hexLength);
+        if (length > 0) {
+            // Don't run past the closing quote, in case the
+            // module sent less than it said it would
+            pQuote = (const char *) memchr(pHex, '\"', length);
+            if (pQuote != NULL) {
+                length = (int32_t) (pQuote - pHex);
+                hexLength = length;
+            }
+            if (length == 1) {
+                // Half a hex pair, the rest yet to arrive:
+                // have the AT client copy the pair out
+                if (uAtClientReadBytes(atHandle, pair, sizeof(pair), true) == sizeof(pair)) {
+                    uHexToBin(pair, sizeof(pair), pData);
+                    pData++;
+                    dataSizeBytes--;
+                    hexLength -= (int32_t) sizeof(pair);
+                } else {
+                    length = -1;
+                }
+            } else {
+                length &= ~1;
+                if ((size_t) length > dataSizeBytes * 2) {
+                    length = (int32_t) dataSizeBytes * 2;
+                }
+                uHexToBin(pHex, length, pData);
+                uAtClientReadBytesConsume(atHandle, length);
+                pData += length / 2;
+                dataSizeBytes -= length / 2;
+                hexLength -= length;
+            }
+        }
+    }
+}
+
 // Create a socket entry in the list.
 static uCellSockSocket_t *pSockCreate(int32_t sockHandle,
                                       uDeviceHandle_t cellHandle,
@@ -219,9 +364,23 @@ static uCellSockSocket_t *pSockCreate(int32_t sockHandle,
         pSock->atHandle = atHandle;
         pSock->sockHandleModule = -1;
         pSock->pendingBytes = 0;
+        pSock->pReadAhead = NULL;
+        pSock->readAheadSizeBytes = 0;
+        pSock->readAheadStart = 0;
+        pSock->readAheadLength = 0;
+        pSock->directLink = false;
+        pSock->directLinkAtBuffered = false;
+        pSock->directLinkStreamHandle = -1;
+        pSock->directLinkLastTxMs = 0;
         pSock->pAsyncClosedCallback = NULL;
         pSock->pDataCallback = NULL;
+        pSock->dataNotified = false;
         pSock->pClosedCallback = NULL;
+        pSock->pConnectCallback = NULL;
+        pSock->connectNegErrno = 0;
+        pSock->protocol = U_SOCK_PROTOCOL_TCP;
+        pSock->localPort = -1;
+        pSock->contextId = U_CELL_NET_CONTEXT_ID;
     }
 
     return pSock;
@@ -241,11 +400,195 @@ static void sockFree(int32_t sockHandle)
             pSock->atHandle = NULL;
             pSock->sockHandleModule = -1;
             pSock->pendingBytes = 0;
+            uPortFreeTagged(pSock->pReadAhead);
+            pSock->pReadAhead = NULL;
+            pSock->readAheadSizeBytes = 0;
+            pSock->readAheadStart = 0;
+            pSock->readAheadLength = 0;
+            pSock->directLink = false;
+            pSock->directLinkAtBuffered = false;
+            pSock->directLinkStreamHandle = -1;
             pSock->pAsyncClosedCallback = NULL;
             pSock->pDataCallback = NULL;
+            pSock->dataNotified = false;
             pSock->pClosedCallback = NULL;
+            pSock->pConnectCallback = NULL;
+        }
+    }
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: POOL
+ * -------------------------------------------------------------- */
+
+// Close a socket in the module with AT+USOCL, no retries.
+static void closeInModule(uAtClientHandle_t atHandle,
+                          int32_t sockHandleModule)
+{
+    uAtClientLock(atHandle);
+    uAtClientTimeoutSet(atHandle, U_SOCK_CLOSE_TIMEOUT_SECONDS * 1000);
+    uAtClientCommandStart(atHandle, "AT+USOCL=");
+    uAtClientWriteInt(atHandle, sockHandleModule);
+    uAtClientCommandStopReadResponse(atHandle);
+    uAtClientUnlock(atHandle);
+}
+
+// Count the sockets of the given protocol in the pool.
+// pPool->mutex should be locked before this is called.
+static size_t poolCount(const uCellSockPool_t *pPool,
+                        uSockProtocol_t protocol)
+{
+    size_t count = 0;
+
+    for (size_t x = 0; x < U_CELL_SOCK_POOL_MAX_NUM; x++) {
+        if ((pPool->sockHandleModule[x] >= 0) &&
+            (pPool->protocol[x] == protocol)) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+// Work out which protocol, if any, the pool is short of.
+// pPool->mutex should be locked before this is called.
+static bool poolShort(const uCellSockPool_t *pPool,
+                      uSockProtocol_t *pProtocol)
+{
+    bool isShort = true;
+
+    if (poolCount(pPool, U_SOCK_PROTOCOL_TCP) < pPool->numTcpWanted) {
+        *pProtocol = U_SOCK_PROTOCOL_TCP;
+    } else if (poolCount(pPool, U_SOCK_PROTOCOL_UDP) < pPool->numUdpWanted) {
+        *pProtocol = U_SOCK_PROTOCOL_UDP;
+    } else {
+        isShort = false;
+    }
+
+    return isShort;
+}
+
+// Fill up the pool, called via uAtClientCallback(); this takes
+// the cellular handle rather than a pointer to the pool since the
+// pool may have gone by the time this is called.
+static void poolFill(uAtClientHandle_t atHandle, void *pParameter)
+{
+    uDeviceHandle_t cellHandle = (uDeviceHandle_t) pParameter;
+    uCellPrivateInstance_t *pInstance;
+    uCellSockPool_t *pPool;
+    uSockProtocol_t protocol = U_SOCK_PROTOCOL_TCP;
+    int32_t sockHandleModule = 0;
+    bool isShort;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        if ((pInstance != NULL) && (pInstance->pSockPoolContext != NULL)) {
+            pPool = (uCellSockPool_t *) pInstance->pSockPoolContext;
+            U_PORT_MUTEX_LOCK(pPool->mutex);
+            pPool->fillPosted = false;
+            isShort = poolShort(pPool, &protocol);
+            U_PORT_MUTEX_UNLOCK(pPool->mutex);
+            // One socket per AT command, letting go of the AT
+            // interface in between so that anyone else waiting
+            // for it gets a look in; stop at the first failure
+            // (e.g. no network or no more sockets in the module),
+            // the pool will be topped up on the next go
+            while (isShort && (sockHandleModule >= 0)) {
+                sockHandleModule = createInModule(atHandle, protocol, -1, -1);
+                U_PORT_MUTEX_LOCK(pPool->mutex);
+                if (sockHandleModule >= 0) {
+                    for (size_t x = 0; x < U_CELL_SOCK_POOL_MAX_NUM; x++) {
+                        if (pPool->sockHandleModule[x] < 0) {
+                            pPool->sockHandleModule[x] = sockHandleModule;
+                            pPool->protocol[x] = protocol;
+                            break;
+                        }
+                    }
+                }
+                isShort = poolShort(pPool, &protocol);
+                U_PORT_MUTEX_UNLOCK(pPool->mutex);
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+}
+
+// Queue poolFill() if the pool is short of sockets and
+// it has not already been queued.
+static void poolFillPost(const uCellPrivateInstance_t *pInstance)
+{
+    uCellSockPool_t *pPool = (uCellSockPool_t *) pInstance->pSockPoolContext;
+    uSockProtocol_t protocol;
+
+    if (pPool != NULL) {
+        U_PORT_MUTEX_LOCK(pPool->mutex);
+        if (!pPool->fillPosted && poolShort(pPool, &protocol) &&
+            (uAtClientCallback(pInstance->atHandle, poolFill,
+                               (void *) pInstance->cellHandle) == 0)) {
+            pPool->fillPosted = true;
+        }
+        U_PORT_MUTEX_UNLOCK(pPool->mutex);
+    }
+}
+
+// Take a socket of the given protocol from the pool, returning
+// the module's handle for it or -1 if there isn't one, and
+// queue the pool being topped up again.
+static int32_t poolTake(const uCellPrivateInstance_t *pInstance,
+                        uSockProtocol_t protocol)
+{
+    uCellSockPool_t *pPool = (uCellSockPool_t *) pInstance->pSockPoolContext;
+    int32_t sockHandleModule = -1;
+
+    if (pPool != NULL) {
+        U_PORT_MUTEX_LOCK(pPool->mutex);
+        for (size_t x = 0; (x < U_CELL_SOCK_POOL_MAX_NUM) &&
+             (sockHandleModule < 0); x++) {
+            if ((pPool->sockHandleModule[x] >= 0) &&
+                (pPool->protocol[x] == protocol)) {
+                sockHandleModule = pPool->sockHandleModule[x];
+                pPool->sockHandleModule[x] = -1;
+            }
+        }
+        U_PORT_MUTEX_UNLOCK(pPool->mutex);
+        poolFillPost(pInstance);
+    }
+
+    return sockHandleModule;
+}
+
+// Remove a socket that the module has closed from the pool of
+// whichever cellular instance uses the given AT handle; this is
+// called from a URC and so must not lock gUCellPrivateMutex.
+static bool poolRemoveClosed(const uAtClientHandle_t atHandle,
+                             int32_t sockHandleModule)
+{
+    uCellPrivateInstance_t *pInstance = gpUCellPrivateInstanceList;
+    uCellSockPool_t *pPool = NULL;
+    bool found = false;
+
+    while ((pInstance != NULL) && (pInstance->atHandle != atHandle)) {
+        pInstance = pInstance->pNext;
+    }
+    if (pInstance != NULL) {
+        pPool = (uCellSockPool_t *) pInstance->pSockPoolContext;
+    }
+    if (pPool != NULL) {
+        U_PORT_MUTEX_LOCK(pPool->mutex);
+        for (size_t x = 0; (x < U_CELL_SOCK_POOL_MAX_NUM) && !found; x++) {
+            if (pPool->sockHandleModule[x] == sockHandleModule) {
+                pPool->sockHandleModule[x] = -1;
+                found = true;
+            }
         }
+        U_PORT_MUTEX_UNLOCK(pPool->mutex);
     }
+
+    return found;
 }
 
 /* ----------------------------------------------------------------
@@ -274,6 +617,21 @@ static void dataCallback(const uAtClientHandle_t atHandle,
     }
 }
 
+// Queue a call to the user data callback via the trampoline,
+// unless one has already been queued since the consumer last
+// read from the socket: a fast download produces a stream of
+// +UUSORD/+UUSORF URCs and the consumer only needs to be told
+// once that there is something to read.
+static void dataNotify(uAtClientHandle_t atHandle,
+                       uCellSockSocket_t *pSocket)
+{
+    if ((pSocket->pDataCallback != NULL) && !pSocket->dataNotified) {
+        pSocket->dataNotified = true;
+        uAtClientCallback(atHandle, dataCallback,
+                          (void *) (pSocket->sockHandle));
+    }
+}
+
 // Callback trampoline for connection closed.
 static void closedCallback(const uAtClientHandle_t atHandle,
                            void *pParameter)
@@ -310,6 +668,34 @@ static void closedCallback(const uAtClientHandle_t atHandle,
     }
 }
 
+// Callback trampoline for an asynchronous connect completing.
+static void connectCallback(const uAtClientHandle_t atHandle,
+                            void *pParameter)
+{
+    //lint -e(507) Suppress size incompatibility: the compiler
+    // we use for Lint checking is 64 bit so has 8 byte pointers
+    // and Lint doesn't like them being used to carry 4 byte integers
+    int32_t sockHandle = (int32_t) pParameter;
+    uCellSockSocket_t *pSocket;
+    void (*pCallback) (uDeviceHandle_t, int32_t, int32_t);
+
+    (void) atHandle;
+
+    if (sockHandle >= 0) {
+        // Find the entry
+        pSocket = pFindBySockHandle(sockHandle);
+        if (pSocket != NULL) {
+            pCallback = pSocket->pConnectCallback;
+            // Only one outcome per connect
+            pSocket->pConnectCallback = NULL;
+            if (pCallback != NULL) {
+                pCallback(pSocket->cellHandle, sockHandle,
+                          pSocket->connectNegErrno);
+            }
+        }
+    }
+}
+
 // Socket Read/Read-From URC.
 static void UUSORD_UUSORF_urc(const uAtClientHandle_t atHandle,
                               void *pUnused)
@@ -329,14 +715,12 @@ static void UUSORD_UUSORF_urc(const uAtClientHandle_t atHandle,
         pSocket = pFindBySockHandleModule(atHandle,
                                           sockHandleModule);
         if (pSocket != NULL) {
-            // Call the user call-back via the trampoline
-            if ((dataSizeBytes > 0) &&
-                (pSocket->pDataCallback != NULL)) {
-                uAtClientCallback(atHandle,
-                                  dataCallback,
-                                  (void *) (pSocket->sockHandle));
-            }
             pSocket->pendingBytes = dataSizeBytes;
+            // Call the user call-back via the trampoline,
+            // if it has not already been called
+            if (dataSizeBytes > 0) {
+                dataNotify(atHandle, pSocket);
+            }
         }
     }
 }
@@ -352,7 +736,10 @@ static void UUSOCL_urc(const uAtClientHandle_t atHandle,
 
     // +UUSOCL: <socket>
     sockHandleModule = uAtClientReadInt(atHandle);
-    if (sockHandleModule >= 0) {
+    if ((sockHandleModule >= 0) &&
+        // A socket waiting in the pool is of no
+        // interest to anyone else
+        !poolRemoveClosed(atHandle, sockHandleModule)) {
         // Find the entry
         pSocket = pFindBySockHandleModule(atHandle,
                                           sockHandleModule);
@@ -366,6 +753,39 @@ static void UUSOCL_urc(const uAtClientHandle_t atHandle,
     }
 }
 
+// Asynchronous socket connect URC.
+static void UUSOCO_urc(const uAtClientHandle_t atHandle,
+                       void *pUnused)
+{
+    int32_t sockHandleModule;
+    int32_t socketError;
+    uCellSockSocket_t *pSocket = NULL;
+
+    (void) pUnused;
+
+    // +UUSOCO: <socket>,<socket_error>
+    sockHandleModule = uAtClientReadInt(atHandle);
+    socketError = uAtClientReadInt(atHandle);
+    if (sockHandleModule >= 0) {
+        // Find the entry
+        pSocket = pFindBySockHandleModule(atHandle,
+                                          sockHandleModule);
+        if ((pSocket != NULL) && (pSocket->pConnectCallback != NULL)) {
+            // The socket error is one of the BSD-style
+            // values of +USOER, which match U_SOCK_Exxx
+            pSocket->connectNegErrno = 0;
+            if (socketError != 0) {
+                pSocket->connectNegErrno = -U_SOCK_ECONNREFUSED;
+                if (socketError > 0) {
+                    pSocket->connectNegErrno = -socketError;
+                }
+            }
+            uAtClientCallback(atHandle, connectCallback,
+                              (void *) (pSocket->sockHandle));
+        }
+    }
+}
+
 /* ----------------------------------------------------------------
  * MORE VARIABLES
  * -------------------------------------------------------------- */
@@ -375,7 +795,8 @@ static void UUSOCL_urc(const uAtClientHandle_t atHandle,
 static const uCellSockUrcHandler_t gUrcHandlers[] = {
     {"+UUSORD:", UUSORD_UUSORF_urc},
     {"+UUSORF:", UUSORD_UUSORF_urc},
-    {"+UUSOCL:", UUSOCL_urc}
+    {"+UUSOCL:", UUSOCL_urc},
+    {"+UUSOCO:", UUSOCO_urc}
 };
 
 /* ----------------------------------------------------------------
@@ -473,6 +894,141 @@ static int32_t getOptionInt(const uCellSockSocket_t *pSocket,
     return errnoLocal;
 }
 
+// Set the size of the read-ahead buffer (the U_SOCK_OPT_RCVBUF
+// option), which is handled locally, returning a (non-negated)
+// value of U_SOCK_Exxx.
+static int32_t setOptionReadAhead(uCellSockSocket_t *pSocket,
+                                  const void *pOptionValue,
+                                  size_t optionValueLength)
+{
+    int32_t errnoLocal = U_SOCK_EINVAL;
+    int32_t sizeBytes;
+    char *pReadAhead = NULL;
+
+    if ((pOptionValue != NULL) &&
+        (optionValueLength >= sizeof(int32_t))) {
+        sizeBytes = *((const int32_t *) pOptionValue);
+        // Can't shrink the buffer below what is already in it
+        if ((sizeBytes >= 0) &&
+            ((size_t) sizeBytes >= pSocket->readAheadLength)) {
+            errnoLocal = U_SOCK_ENONE;
+            if (sizeBytes > 0) {
+                errnoLocal = U_SOCK_ENOMEM;
+                pReadAhead = (char *) pUPortMallocTagged(U_PORT_HEAP_TAG_CELL_SOCK, sizeBytes);
+                if (pReadAhead != NULL) {
+                    errnoLocal = U_SOCK_ENONE;
+                    if (pSocket->readAheadLength > 0) {
+                        memcpy(pReadAhead,
+                               pSocket->pReadAhead + pSocket->readAheadStart,
+                               pSocket->readAheadLength);
+                    }
+                }
+            }
+            if (errnoLocal == U_SOCK_ENONE) {
+                uPortFreeTagged(pSocket->pReadAhead);
+                pSocket->pReadAhead = pReadAhead;
+                pSocket->readAheadSizeBytes = (size_t) sizeBytes;
+                pSocket->readAheadStart = 0;
+            }
+        }
+    }
+
+    return errnoLocal;
+}
+
+// Get the size of the read-ahead buffer or, if there isn't one,
+// the most that a single read from the module can return,
+// returning a (non-negated) value of U_SOCK_Exxx.
+static int32_t getOptionReadAhead(const uCellSockSocket_t *pSocket,
+                                  bool hexMode,
+                                  void *pOptionValue,
+                                  size_t *pOptionValueLength)
+{
+    int32_t errnoLocal = U_SOCK_EINVAL;
+    int32_t sizeBytes = (int32_t) pSocket->readAheadSizeBytes;
+
+    if (sizeBytes == 0) {
+        sizeBytes = U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES;
+        if (hexMode) {
+            sizeBytes /= 2;
+        }
+    }
+
+    if (pOptionValueLength != NULL) {
+        if (pOptionValue != NULL) {
+            if (*pOptionValueLength >= sizeof(int32_t)) {
+                errnoLocal = U_SOCK_ENONE;
+                *((int32_t *) pOptionValue) = sizeBytes;
+                *pOptionValueLength = sizeof(int32_t);
+            }
+        } else {
+            errnoLocal = U_SOCK_ENONE;
+            // Caller just wants to know the length required
+            *pOptionValueLength = sizeof(int32_t);
+        }
+    }
+
+    return errnoLocal;
+}
+
+// Set the PDP context that a socket uses (the U_SOCK_OPT_PDP_CONTEXT
+// option), returning a (non-negated) value of U_SOCK_Exxx.  The
+// module binds a socket to a profile when the socket is created,
+// so the socket is created afresh in the module on the new profile
+// and the old one is closed; hence this can only be done before
+// the socket is used.
+static int32_t setOptionPdpContext(const uCellPrivateInstance_t *pInstance,
+                                   uCellSockSocket_t *pSocket,
+                                   const void *pOptionValue,
+                                   size_t optionValueLength)
+{
+    int32_t errnoLocal = U_SOCK_EINVAL;
+    uAtClientHandle_t atHandle = pSocket->atHandle;
+    int32_t contextId;
+    int32_t sockHandleModule;
+
+    if ((pOptionValue != NULL) &&
+        (optionValueLength >= sizeof(int32_t))) {
+        contextId = *((const int32_t *) pOptionValue);
+        if (contextId == pSocket->contextId) {
+            errnoLocal = U_SOCK_ENONE;
+        } else if ((contextId > 0) &&
+                   (contextId <= U_CELL_NET_MAX_NUM_CONTEXTS)) {
+            errnoLocal = U_SOCK_ENOSYS;
+            if (U_CELL_PRIVATE_HAS_MULTIPLE_CONTEXTS(pInstance->pModule)) {
+                errnoLocal = U_SOCK_EISCONN;
+                if ((pSocket->pendingBytes == 0) &&
+                    (pSocket->readAheadLength == 0) &&
+                    (pSocket->pConnectCallback == NULL) &&
+                    !pSocket->directLink) {
+                    errnoLocal = U_SOCK_ENOBUFS;
+                    // Create the new one first so that, if that
+                    // fails, the socket is left as it was
+                    sockHandleModule = createInModule(atHandle, pSocket->protocol,
+                                                      pSocket->localPort,
+                                                      U_CELL_PRIVATE_PROFILE_ID(contextId));
+                    if (sockHandleModule >= 0) {
+                        uAtClientLock(atHandle);
+                        uAtClientTimeoutSet(atHandle,
+                                            U_SOCK_CLOSE_TIMEOUT_SECONDS * 1000);
+                        uAtClientCommandStart(atHandle, "AT+USOCL=");
+                        uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
+                        uAtClientCommandStopReadResponse(atHandle);
+                        uAtClientUnlock(atHandle);
+                        pSocket->sockHandleModule = sockHandleModule;
+                        pSocket->contextId = contextId;
+                        errnoLocal = U_SOCK_ENONE;
+                    } else {
+                        doUsoer(atHandle);
+                    }
+                }
+            }
+        }
+    }
+
+    return errnoLocal;
+}
+
 // Set the linger socket option, returning a
 // (non-negated) value of U_SOCK_Exxx.
 static int32_t setOptionLinger(const uCellSockSocket_t *pSocket,
@@ -594,6 +1150,10 @@ int32_t setHexMode(uDeviceHandle_t cellHandle, bool hexModeOnNotOff)
         uAtClientWriteInt(atHandle, 1);
         uAtClientWriteInt(atHandle, state);
         uAtClientCommandStopReadResponse(atHandle);
+        // The module remembers this setting, which is also
+        // one of those written at power-on, so that will need
+        // to be done again
+        pInstance->configFingerprint = 0;
         if (uAtClientUnlock(atHandle) == 0) {
             pInstance->socketsHexMode = (state == 1);
             errnoLocal = U_SOCK_ENONE;
@@ -651,82 +1211,632 @@ static int32_t doUsoctl(uDeviceHandle_t cellHandle, int32_t sockHandle,
 }
 
 /* ----------------------------------------------------------------
- * PUBLIC FUNCTIONS: INIT/DEINIT
+ * STATIC FUNCTIONS: I/O VECTORS
  * -------------------------------------------------------------- */
 
-// Initialise the cellular sockets layer.
-int32_t uCellSockInit()
+// Move the position given by *pIndex and *pOffset in an I/O
+// vector on by size bytes.
+static void ioVecAdvance(const uSockIoVec_t *pIoVec, size_t ioVecCount,
+                         size_t *pIndex, size_t *pOffset, size_t size)
 {
-    uCellSockSocket_t *pSock = NULL;
+    size_t thisSize;
 
-    if (!gInitialised) {
-
-        // Clear the list
-        for (size_t x = 0; (x < sizeof(gSockets) / sizeof(gSockets[0])); x++) {
-            pSock = &(gSockets[x]);
-            pSock->cellHandle = NULL;
-            pSock->sockHandle = -1;
-            pSock->sockHandleModule = -1;
-            pSock->pendingBytes = 0;
-            pSock->pDataCallback = NULL;
-            pSock->pClosedCallback = NULL;
+    while ((size > 0) && (*pIndex < ioVecCount)) {
+        thisSize = pIoVec[*pIndex].dataSizeBytes - *pOffset;
+        if (thisSize > size) {
+            thisSize = size;
+        }
+        *pOffset += thisSize;
+        size -= thisSize;
+        if (*pOffset >= pIoVec[*pIndex].dataSizeBytes) {
+            (*pIndex)++;
+            *pOffset = 0;
         }
-
-        gInitialised = true;
     }
-
-    return U_SOCK_ENONE;
 }
 
-// Initialise the cellular sockets instance.
-int32_t uCellSockInitInstance(uDeviceHandle_t cellHandle)
+// Send size bytes of an I/O vector, starting at the position given
+// by index and offset, either as binary to the AT client or, if
+// pHexBuffer is not NULL, hex-coded into pHexBuffer, which is then
+// null terminated.
+static void ioVecSend(uAtClientHandle_t atHandle, char *pHexBuffer,
+                      const uSockIoVec_t *pIoVec, size_t ioVecCount,
+                      size_t index, size_t offset, size_t size)
 {
-    uCellPrivateInstance_t *pInstance;
-    int32_t errnoLocal = U_SOCK_EINVAL;
+    size_t thisSize;
+    const char *pData;
 
-    if (gInitialised) {
-        pInstance = pUCellPrivateGetInstance(cellHandle);
-        if (pInstance != NULL) {
-            errnoLocal = U_SOCK_ENONE;
-            // Set up the URCs
-            for (size_t x = 0; (x < sizeof(gUrcHandlers) /
-                                sizeof(gUrcHandlers[0])) &&
-                 (errnoLocal == U_SOCK_ENONE); x++) {
-                if (uAtClientSetUrcHandler(pInstance->atHandle,
-                                           gUrcHandlers[x].pPrefix,
-                                           gUrcHandlers[x].pHandler,
-                                           NULL) != 0) {
-                    errnoLocal = U_SOCK_ENOMEM;
-                }
+    while ((size > 0) && (index < ioVecCount)) {
+        thisSize = pIoVec[index].dataSizeBytes - offset;
+        if (thisSize > size) {
+            thisSize = size;
+        }
+        if (thisSize > 0) {
+            pData = ((const char *) pIoVec[index].pData) + offset;
+            if (pHexBuffer != NULL) {
+                pHexBuffer += uBinToHex(pData, thisSize, pHexBuffer);
+            } else {
+                uAtClientWriteBytes(atHandle, pData, thisSize, true);
             }
+            size -= thisSize;
         }
+        index++;
+        offset = 0;
     }
-
-    return -errnoLocal;
-}
-
-// Deinitialise the cellular sockets layer.
-void uCellSockDeinit()
-{
-    if (gInitialised) {
-        // Nothing to do, URCs will have been
-        // removed on close
-        gInitialised = false;
+    if (pHexBuffer != NULL) {
+        *pHexBuffer = 0;
     }
 }
 
 /* ----------------------------------------------------------------
- * PUBLIC FUNCTIONS: CREATE/OPEN/CLOSE/CLEAN-UP
+ * STATIC FUNCTIONS: DATAGRAMS
  * -------------------------------------------------------------- */
 
-// Create a socket.
-int32_t uCellSockCreate(uDeviceHandle_t cellHandle,
-                        uSockType_t type,
-                        uSockProtocol_t protocol)
+// Check that a datagram of dataSizeBytes may be sent to
+// pRemoteAddress, writing the IP address part of it into pBuffer,
+// of size U_SOCK_ADDRESS_STRING_MAX_LENGTH_BYTES, and setting
+// *ppRemoteIpAddress to point to it; returns zero or a negated
+// value of U_SOCK_Exxx.
+static int32_t sendToCheck(const uCellPrivateInstance_t *pInstance,
+                           const uSockAddress_t *pRemoteAddress,
+                           int32_t dataSizeBytes, char *pBuffer,
+                           char **ppRemoteIpAddress)
 {
-    int32_t negErrnoLocal = -U_SOCK_EINVAL;
-    uCellPrivateInstance_t *pInstance;
-    uAtClientHandle_t atHandle;
+    int32_t negErrnoLocal = -U_SOCK_EDESTADDRREQ;
+    int32_t dataLengthMax = U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES;
+
+    if (pInstance->socketsHexMode) {
+        dataLengthMax /= 2;
+    }
+    if (uSockAddressToString(pRemoteAddress, pBuffer,
+                             U_SOCK_ADDRESS_STRING_MAX_LENGTH_BYTES) > 0) {
+        *ppRemoteIpAddress = pUSockDomainRemovePort(pBuffer);
+        if (*ppRemoteIpAddress != NULL) {
+            negErrnoLocal = -U_SOCK_EMSGSIZE;
+            if (dataSizeBytes <= dataLengthMax) {
+                negErrnoLocal = 0;
+            }
+        }
+    }
+
+    return negErrnoLocal;
+}
+
+// Send a datagram with the AT interface already locked, the guts
+// of uCellSockSendToV(); in hex mode pHexBuffer must be given, with
+// room for dataSizeBytes * 2 + 1 characters, else it must be NULL.
+// Any AT error is cleared before returning so that further commands
+// may follow.
+static int32_t sendToLocked(uAtClientHandle_t atHandle,
+                            const uCellSockSocket_t *pSocket,
+                            const char *pRemoteIpAddress, uint16_t port,
+                            const uSockIoVec_t *pIoVec, size_t ioVecCount,
+                            int32_t dataSizeBytes, char *pHexBuffer)
+{
+    int32_t negErrnoLocalOrSize = -U_SOCK_EIO;
+    int32_t sentSize = -1;
+    bool written = false;
+
+    if (pHexBuffer != NULL) {
+        // Make the hex-coded null terminated string
+        ioVecSend(atHandle, pHexBuffer, pIoVec, ioVecCount,
+                  0, 0, dataSizeBytes);
+    }
+    if (pHexBuffer != NULL) {
+        uAtClientCommandStart(atHandle, "AT+USOST=");
+        // Write module socket handle
+        uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
+        // Write IP address
+        uAtClientWriteString(atHandle, pRemoteIpAddress, true);
+        // Write port number
+        uAtClientWriteInt(atHandle, port);
+        // Number of bytes to follow
+        uAtClientWriteInt(atHandle, dataSizeBytes);
+        // Send the hex mode data as a string
+        uAtClientWriteString(atHandle, pHexBuffer, true);
+        uAtClientCommandStop(atHandle);
+        written = true;
+    } else {
+        // Module socket handle, IP address, port number and
+        // number of bytes to follow, all in one write
+        uAtClientCommandf(atHandle, "AT+USOST=%d,\"%s\",%u,%d",
+                          (int) pSocket->sockHandleModule, pRemoteIpAddress,
+                          (unsigned) port, (int) dataSizeBytes);
+        // Not in hex mode, wait for the prompt
+        if (uAtClientWaitCharacter(atHandle, '@') == 0) {
+            // Wait for it...
+            uPortTaskBlock(U_CELL_SOCK_BINARY_PROMPT_DELAY_MS);
+            // Send the binary data, all the pieces
+            ioVecSend(atHandle, NULL, pIoVec, ioVecCount,
+                      0, 0, dataSizeBytes);
+            written = true;
+        }
+    }
+    if (written) {
+        // Grab the response
+        uAtClientResponseStart(atHandle, "+USOST:");
+        // Skip the socket ID
+        uAtClientSkipParameters(atHandle, 1);
+        // Bytes sent
+        sentSize = uAtClientReadInt(atHandle);
+        uAtClientResponseStop(atHandle);
+        if ((uAtClientErrorGet(atHandle) == 0) && (sentSize >= 0)) {
+            // All is good, probably
+            negErrnoLocalOrSize = sentSize;
+        }
+    }
+    uAtClientClearError(atHandle);
+
+    return negErrnoLocalOrSize;
+}
+
+// Parse the response to a pipelined AT+USOST, see
+// sendToBatchPipelined().
+static void usostResponseParser(uAtClientHandle_t atHandle,
+                                void *pParameter)
+{
+    // Skip the socket ID
+    uAtClientSkipParameters(atHandle, 1);
+    // Bytes sent
+    *((int32_t *) pParameter) = uAtClientReadInt(atHandle);
+}
+
+// Send count datagrams, all of which have been checked with
+// sendToCheck(), in hex mode with the AT interface already
+// locked, pipelining up to U_CELL_SOCK_BATCH_PIPELINE_WINDOW
+// AT+USOST commands at a time; returns the number of datagrams
+// sent or, if none were, a negated value of U_SOCK_Exxx.
+static int32_t sendToBatchPipelined(const uCellPrivateInstance_t *pInstance,
+                                    const uCellSockSocket_t *pSocket,
+                                    uSockDatagram_t *pDatagrams,
+                                    size_t count)
+{
+    int32_t negErrnoLocalOrCount = 0;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    uAtClientPipelineCommand_t pipeline[U_CELL_SOCK_BATCH_PIPELINE_WINDOW];
+    uSockDatagram_t *pDatagram;
+    uSockIoVec_t ioVec;
+    char buffer[U_SOCK_ADDRESS_STRING_MAX_LENGTH_BYTES];
+    char *pRemoteIpAddress;
+    char *pCommands;
+    char *pCommand;
+    size_t commandsSizeBytes;
+    size_t numThisTime;
+    size_t numCommands;
+    size_t numSent = 0;
+    int32_t x;
+
+    while ((numSent < count) && (negErrnoLocalOrCount == 0)) {
+        // Work out how much room the next window's worth
+        // of commands needs
+        numThisTime = count - numSent;
+        if (numThisTime > U_CELL_SOCK_BATCH_PIPELINE_WINDOW) {
+            numThisTime = U_CELL_SOCK_BATCH_PIPELINE_WINDOW;
+        }
+        commandsSizeBytes = 0;
+        for (size_t y = 0; y < numThisTime; y++) {
+            commandsSizeBytes += U_CELL_SOCK_USOST_HEX_OVERHEAD_BYTES +
+                                 (pDatagrams[numSent + y].dataSizeBytes * 2);
+        }
+        negErrnoLocalOrCount = -U_SOCK_ENOMEM;
+        pCommands = (char *) pUPortMallocTagged(U_PORT_HEAP_TAG_CELL_SOCK, commandsSizeBytes);
+        if (pCommands != NULL) {
+            negErrnoLocalOrCount = 0;
+            // Assemble the commands; a datagram with no data
+            // is "sent" without troubling the module
+            pCommand = pCommands;
+            numCommands = 0;
+            for (size_t y = 0; y < numThisTime; y++) {
+                pDatagram = &(pDatagrams[numSent + y]);
+                pDatagram->sizeBytes = 0;
+                if (pDatagram->dataSizeBytes > 0) {
+                    //lint -e(534) Ignore return value: already checked
+                    sendToCheck(pInstance, &(pDatagram->address),
+                                (int32_t) pDatagram->dataSizeBytes,
+                                buffer, &pRemoteIpAddress);
+                    x = snprintf(pCommand, U_CELL_SOCK_USOST_HEX_OVERHEAD_BYTES,
+                                 "AT+USOST=%d,\"%s\",%d,%d,\"",
+                                 (int) pSocket->sockHandleModule, pRemoteIpAddress,
+                                 (int) pDatagram->address.port,
+                                 (int) pDatagram->dataSizeBytes);
+                    ioVec.pData = pDatagram->pData;
+                    ioVec.dataSizeBytes = pDatagram->dataSizeBytes;
+                    ioVecSend(atHandle, pCommand + x, &ioVec, 1, 0, 0,
+                              pDatagram->dataSizeBytes);
+                    x += (int32_t) (pDatagram->dataSizeBytes * 2);
+                    *(pCommand + x) = '\"';
+                    x++;
+                    *(pCommand + x) = 0;
+                    pipeline[numCommands].pCommand = pCommand;
+                    pipeline[numCommands].pResponsePrefix = "+USOST:";
+                    pipeline[numCommands].pResponseParser = usostResponseParser;
+                    pipeline[numCommands].pResponseParserParameter = &(pDatagram->sizeBytes);
+                    pipeline[numCommands].errorCode = 0;
+                    // The parser overwrites this with the number of bytes sent
+                    pDatagram->sizeBytes = -U_SOCK_EIO;
+                    numCommands++;
+                    pCommand += x + 1;
+                }
+            }
+            if (numCommands > 0) {
+                uAtClientPipeline(atHandle, pipeline, numCommands, numCommands);
+                uAtClientClearError(atHandle);
+                for (size_t y = 0; y < numCommands; y++) {
+                    if ((pipeline[y].errorCode != 0) ||
+                        (*((int32_t *) pipeline[y].pResponseParserParameter) < 0)) {
+                        *((int32_t *) pipeline[y].pResponseParserParameter) = -U_SOCK_EIO;
+                    }
+                }
+            }
+            uPortFreeTagged(pCommands);
+            // Count the datagrams sent, stopping at the first failure
+            for (size_t y = 0; (y < numThisTime) && (negErrnoLocalOrCount == 0); y++) {
+                if (pDatagrams[numSent].sizeBytes >= 0) {
+                    numSent++;
+                } else {
+                    negErrnoLocalOrCount = pDatagrams[numSent].sizeBytes;
+                }
+            }
+        }
+    }
+
+    if (numSent > 0) {
+        negErrnoLocalOrCount = (int32_t) numSent;
+    }
+
+    return negErrnoLocalOrCount;
+}
+
+// Receive a datagram with the AT interface already locked, the guts
+// of uCellSockReceiveFrom().  Any AT error is cleared before returning
+// so that further commands may follow.
+static int32_t receiveFromLocked(const uCellPrivateInstance_t *pInstance,
+                                 uCellSockSocket_t *pSocket,
+                                 uSockAddress_t *pRemoteAddress,
+                                 void *pData, size_t dataSizeBytes)
+{
+    int32_t negErrnoLocalOrSize = -U_SOCK_EWOULDBLOCK;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    int32_t dataLengthMax = U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES;
+    char buffer[U_SOCK_ADDRESS_STRING_MAX_LENGTH_BYTES];
+    int32_t x;
+    int32_t port = -1;
+    int32_t receivedSize = -1;
+
+    buffer[0] = 0;  // In case of slip-ups
+    // A read cycle begins: data arriving from now
+    // on should be notified afresh
+    pSocket->dataNotified = false;
+
+    // Note: the real maximum length of UDP packet we can receive
+    // comes from fitting all of the following into one buffer:
+    //
+    // +USORF: xx,"max.len.ip.address.ipv4.or.ipv6",yyyyy,wwww,"the_data"\r\n
+    //
+    // where xx is the handle, max.len.ip.address.ipv4.or.ipv6 is NSAPI_IP_SIZE,
+    // yyyyy is the port number (max 65536), wwww is the length of the data and
+    // the_data is binary data. I make that 29 + 48 + len(the_data),
+    // so the overhead is 77 bytes.
+
+    if (pInstance->socketsHexMode) {
+        dataLengthMax /= 2;
+    }
+    if (pSocket->pendingBytes == 0) {
+        // If the URC has not filled in pendingBytes,
+        // ask the module directly if there is anything
+        // to read
+        // Zero bytes to read, just want to know the number
+        // of bytes waiting
+        uAtClientCommandf(atHandle, "AT+USORF=%d,0",
+                          (int) pSocket->sockHandleModule);
+        uAtClientResponseStart(atHandle, "+USORF:");
+        // Skip the socket ID
+        uAtClientSkipParameters(atHandle, 1);
+        // Read the amount of data
+        x = uAtClientReadInt(atHandle);
+        uAtClientResponseStop(atHandle);
+        // Update pending bytes here, before
+        // the AT interface is unlocked, as otherwise a data callback
+        // triggered by a URC could be sitting waiting
+        // to grab the AT lock and jump in before
+        // pending bytes has been updated, leading it
+        // back into here again, etc, etc.
+        if (x > 0) {
+            pSocket->pendingBytes = x;
+            // DON'T call the user data callback here:
+            // we already have the AT interface locked
+            // and a user might try to call back into
+            // here which would result in deadlock.
+            // They will get their received data, there
+            // is no need to worry.
+        }
+        uAtClientClearError(atHandle);
+    }
+    if (pSocket->pendingBytes > 0) {
+        // In the UDP case we HAVE to read the number
+        // of bytes pending as this will be the size
+        // of the next UDP packet in the module and the
+        // module can only deliver whole UDP packets.
+        // Number of bytes to read
+        uAtClientCommandf(atHandle, "AT+USORF=%d,%d",
+                          (int) pSocket->sockHandleModule, (int) dataLengthMax);
+        uAtClientResponseStart(atHandle, "+USORF:");
+        // Skip the socket ID
+        uAtClientSkipParameters(atHandle, 1);
+        // Read the IP address
+        uAtClientReadString(atHandle, buffer,
+                            sizeof(buffer), false);
+        // Read the port
+        port = uAtClientReadInt(atHandle);
+        // Read the amount of data
+        receivedSize = uAtClientReadInt(atHandle);
+        if (receivedSize > dataLengthMax) {
+            receivedSize = dataLengthMax;
+        }
+        if ((int32_t) dataSizeBytes > receivedSize) {
+            dataSizeBytes = receivedSize;
+        }
+        if (receivedSize > 0) {
+            if (pInstance->socketsHexMode) {
+                // In hex mode decode straight out of the
+                // AT client's receive buffer
+                //lint -e{647} Suppress suspicious truncation
+                readHexDirect(atHandle, receivedSize * 2,
+                              (char *) pData, dataSizeBytes);
+            } else {
+                // Binary mode, don't stop for anything!
+                uAtClientIgnoreStopTag(atHandle);
+                // Get the leading quote mark out of the way
+                uAtClientReadBytes(atHandle, NULL, 1, true);
+                // Now read out all the actual data,
+                // first the bit we want
+                uAtClientReadBytes(atHandle, (char *) pData,
+                                   dataSizeBytes, true);
+                if (receivedSize > (int32_t) dataSizeBytes) {
+                    //...and then the rest poured away to NULL
+                    uAtClientReadBytes(atHandle, NULL,
+                                       receivedSize -
+                                       dataSizeBytes, true);
+                }
+                // Make sure to wait for the stop tag before
+                // we finish
+                uAtClientRestoreStopTag(atHandle);
+            }
+        }
+        uAtClientResponseStop(atHandle);
+        // BEFORE the AT interface is unlocked, work out what's happened.
+        // This is to prevent a URC being processed that
+        // may indicate data left and over-write pendingBytes
+        // while we're also writing to it.
+        if ((uAtClientErrorGet(atHandle) == 0) &&
+            (receivedSize >= 0)) {
+            // Must use what +USORF returns here as it may be less
+            // or more than we asked for and also may be
+            // more than pendingBytes, depending on how
+            // the URCs landed
+            // This update of pendingBytes will be overwritten
+            // by the URC but we have to do something here
+            // 'cos we don't get a URC to tell us when pendingBytes
+            // has gone to zero.
+            if (receivedSize > pSocket->pendingBytes) {
+                pSocket->pendingBytes = 0;
+            } else {
+                pSocket->pendingBytes -= receivedSize;
+            }
+            negErrnoLocalOrSize = receivedSize;
+        }
+        uAtClientClearError(atHandle);
+    }
+
+    if ((negErrnoLocalOrSize >= 0) && (pRemoteAddress != NULL) && (port >= 0)) {
+        if (uSockStringToAddress(buffer, pRemoteAddress) == 0) {
+            pRemoteAddress->port = (uint16_t) port;
+        } else {
+            // If we can't decode the remote address this becomes
+            // an error, can't go receiving things from servers
+            // we know not who they are
+            negErrnoLocalOrSize = -U_SOCK_EIO;
+        }
+    }
+
+    uCellPwrPrivateEnergyBytes(pInstance, false, negErrnoLocalOrSize);
+
+    return negErrnoLocalOrSize;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: DIRECT LINK
+ * -------------------------------------------------------------- */
+
+// Find whether any socket using the given AT client is in
+// direct link mode.
+static bool directLinkActive(const uAtClientHandle_t atHandle)
+{
+    bool active = false;
+
+    for (size_t x = 0; (x < sizeof(gSockets) / sizeof(gSockets[0])) &&
+         !active; x++) {
+        if ((gSockets[x].sockHandle >= 0) &&
+            (gSockets[x].atHandle == atHandle) &&
+            gSockets[x].directLink) {
+            active = true;
+        }
+    }
+
+    return active;
+}
+
+// Write to a socket in direct link mode, returning the number
+// of bytes sent or a negated value of U_SOCK_Exxx.
+static int32_t directLinkWrite(uCellSockSocket_t *pSocket,
+                               const char *pData, size_t dataSizeBytes)
+{
+    int32_t negErrnoLocalOrSize = U_SOCK_ENONE;
+
+    if (dataSizeBytes > 0) {
+        negErrnoLocalOrSize = uPortUartWrite(pSocket->directLinkStreamHandle,
+                                             pData, dataSizeBytes);
+        // Remember when we last wrote: the escape sequence
+        // must be preceded by the guard time of silence
+        pSocket->directLinkLastTxMs = uPortGetTickTimeMs();
+        if (negErrnoLocalOrSize < 0) {
+            negErrnoLocalOrSize = -U_SOCK_EIO;
+        }
+    }
+
+    return negErrnoLocalOrSize;
+}
+
+// Read from a socket in direct link mode, returning the number
+// of bytes received or a negated value of U_SOCK_Exxx.
+static int32_t directLinkRead(uCellSockSocket_t *pSocket,
+                              char *pData, size_t dataSizeBytes)
+{
+    int32_t negErrnoLocalOrSize = U_SOCK_ENONE;
+    const char *pBuffered = NULL;
+    size_t totalReceivedSize = 0;
+    size_t x;
+
+    // Whatever is left in the read-ahead buffer from before
+    // direct link mode began comes first
+    x = pSocket->readAheadLength;
+    if (x > dataSizeBytes) {
+        x = dataSizeBytes;
+    }
+    if (x > 0) {
+        memcpy(pData, pSocket->pReadAhead + pSocket->readAheadStart, x);
+        pSocket->readAheadStart += x;
+        pSocket->readAheadLength -= x;
+        totalReceivedSize += x;
+        dataSizeBytes -= x;
+    }
+
+    if ((dataSizeBytes > 0) && pSocket->directLinkAtBuffered) {
+        // Then anything the AT client brought in after the
+        // CONNECT; the AT timeout was set to zero when direct
+        // link mode began so this will not block
+        negErrnoLocalOrSize = uAtClientReadBytesPeek(pSocket->atHandle,
+                                                     &pBuffered, dataSizeBytes);
+        if (negErrnoLocalOrSize > 0) {
+            memcpy(pData + totalReceivedSize, pBuffered, negErrnoLocalOrSize);
+            uAtClientReadBytesConsume(pSocket->atHandle, negErrnoLocalOrSize);
+            totalReceivedSize += negErrnoLocalOrSize;
+            dataSizeBytes -= negErrnoLocalOrSize;
+        } else {
+            // The AT client has nothing more: from now on
+            // read the stream directly
+            uAtClientClearError(pSocket->atHandle);
+            pSocket->directLinkAtBuffered = false;
+            negErrnoLocalOrSize = U_SOCK_ENONE;
+        }
+    }
+
+    if ((dataSizeBytes > 0) && !pSocket->directLinkAtBuffered) {
+        negErrnoLocalOrSize = uPortUartRead(pSocket->directLinkStreamHandle,
+                                            pData + totalReceivedSize,
+                                            dataSizeBytes);
+        if (negErrnoLocalOrSize > 0) {
+            totalReceivedSize += negErrnoLocalOrSize;
+        } else if (negErrnoLocalOrSize < 0) {
+            negErrnoLocalOrSize = -U_SOCK_EIO;
+        }
+    }
+
+    if (totalReceivedSize > 0) {
+        negErrnoLocalOrSize = (int32_t) totalReceivedSize;
+    } else if (negErrnoLocalOrSize == U_SOCK_ENONE) {
+        negErrnoLocalOrSize = -U_SOCK_EWOULDBLOCK;
+    }
+
+    return negErrnoLocalOrSize;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: INIT/DEINIT
+ * -------------------------------------------------------------- */
+
+// Initialise the cellular sockets layer.
+int32_t uCellSockInit()
+{
+    uCellSockSocket_t *pSock = NULL;
+
+    if (!gInitialised) {
+
+        // Clear the list
+        for (size_t x = 0; (x < sizeof(gSockets) / sizeof(gSockets[0])); x++) {
+            pSock = &(gSockets[x]);
+            pSock->cellHandle = NULL;
+            pSock->sockHandle = -1;
+            pSock->sockHandleModule = -1;
+            pSock->pendingBytes = 0;
+            pSock->pReadAhead = NULL;
+            pSock->readAheadSizeBytes = 0;
+            pSock->readAheadStart = 0;
+            pSock->readAheadLength = 0;
+            pSock->directLink = false;
+            pSock->directLinkAtBuffered = false;
+            pSock->directLinkStreamHandle = -1;
+            pSock->directLinkLastTxMs = 0;
+            pSock->pDataCallback = NULL;
+            pSock->pClosedCallback = NULL;
+            pSock->pConnectCallback = NULL;
+        }
+
+        gInitialised = true;
+    }
+
+    return U_SOCK_ENONE;
+}
+
+// Initialise the cellular sockets instance.
+int32_t uCellSockInitInstance(uDeviceHandle_t cellHandle)
+{
+    uCellPrivateInstance_t *pInstance;
+    int32_t errnoLocal = U_SOCK_EINVAL;
+
+    if (gInitialised) {
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        if (pInstance != NULL) {
+            errnoLocal = U_SOCK_ENONE;
+            // Set up the URCs
+            for (size_t x = 0; (x < sizeof(gUrcHandlers) /
+                                sizeof(gUrcHandlers[0])) &&
+                 (errnoLocal == U_SOCK_ENONE); x++) {
+                if (uAtClientSetUrcHandler(pInstance->atHandle,
+                                           gUrcHandlers[x].pPrefix,
+                                           gUrcHandlers[x].pHandler,
+                                           NULL) != 0) {
+                    errnoLocal = U_SOCK_ENOMEM;
+                }
+            }
+        }
+    }
+
+    return -errnoLocal;
+}
+
+// Deinitialise the cellular sockets layer.
+void uCellSockDeinit()
+{
+    if (gInitialised) {
+        // Nothing to do, URCs will have been
+        // removed on close
+        gInitialised = false;
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: CREATE/OPEN/CLOSE/CLEAN-UP
+ * -------------------------------------------------------------- */
+
+// Create a socket.
+int32_t uCellSockCreate(uDeviceHandle_t cellHandle,
+                        uSockType_t type,
+                        uSockProtocol_t protocol)
+{
+    int32_t negErrnoLocal = -U_SOCK_EINVAL;
+    uCellPrivateInstance_t *pInstance;
+    uAtClientHandle_t atHandle;
     uCellSockSocket_t *pSocket;
 
     (void) type;
@@ -744,20 +1854,19 @@ int32_t uCellSockCreate(uDeviceHandle_t cellHandle,
         }
         if (pSocket != NULL) {
             // Create the socket in the cellular module
-            uAtClientLock(atHandle);
-            uAtClientCommandStart(atHandle, "AT+USOCR=");
-            // Protocol is 6 for TCP or 17 for UDP
-            uAtClientWriteInt(atHandle, (int32_t) protocol);
-            // User-specified local port number
-            if (pInstance->sockNextLocalPort >= 0) {
-                uAtClientWriteInt(atHandle, pInstance->sockNextLocalPort);
-                pInstance->sockNextLocalPort = -1;
+            pSocket->protocol = protocol;
+            pSocket->localPort = pInstance->sockNextLocalPort;
+            pInstance->sockNextLocalPort = -1;
+            if (pSocket->localPort < 0) {
+                // No special requirements so take one
+                // that is ready and waiting, if there is one
+                pSocket->sockHandleModule = poolTake(pInstance, protocol);
             }
-            uAtClientCommandStop(atHandle);
-            uAtClientResponseStart(atHandle, "+USOCR:");
-            pSocket->sockHandleModule = uAtClientReadInt(atHandle);
-            uAtClientResponseStop(atHandle);
-            if (uAtClientUnlock(atHandle) == 0) {
+            if (pSocket->sockHandleModule < 0) {
+                pSocket->sockHandleModule = createInModule(atHandle, protocol,
+                                                           pSocket->localPort, -1);
+            }
+            if (pSocket->sockHandleModule >= 0) {
                 // All good
                 negErrnoLocal = pSocket->sockHandle;
             } else {
@@ -837,6 +1946,70 @@ int32_t uCellSockConnect(uDeviceHandle_t cellHandle,
     return -errnoLocal;
 }
 
+// Start an asynchronous connection to a server.
+int32_t uCellSockConnectAsync(uDeviceHandle_t cellHandle,
+                              int32_t sockHandle,
+                              const uSockAddress_t *pRemoteAddress,
+                              void (*pCallback) (uDeviceHandle_t,
+                                                 int32_t,
+                                                 int32_t))
+{
+    int32_t errnoLocal = U_SOCK_EINVAL;
+    uCellPrivateInstance_t *pInstance;
+    uAtClientHandle_t atHandle;
+    uCellSockSocket_t *pSocket;
+    char buffer[U_SOCK_ADDRESS_STRING_MAX_LENGTH_BYTES];
+    char *pRemoteIpAddress;
+
+    // Find the instance
+    pInstance = pUCellPrivateGetInstance(cellHandle);
+    if ((pInstance != NULL) && (pCallback != NULL)) {
+        errnoLocal = U_SOCK_ENOSYS;
+        if (U_CELL_PRIVATE_HAS(pInstance->pModule,
+                               U_CELL_PRIVATE_FEATURE_SOCK_CONNECT_ASYNC)) {
+            errnoLocal = U_SOCK_EINVAL;
+            atHandle = pInstance->atHandle;
+            // Find the entry
+            if (sockHandle >= 0) {
+                pSocket = pFindBySockHandle(sockHandle);
+                if ((pSocket != NULL) &&
+                    (uSockAddressToString(pRemoteAddress, buffer,
+                                          sizeof(buffer)) > 0)) {
+                    errnoLocal = U_SOCK_EALREADY;
+                    if (pSocket->pConnectCallback == NULL) {
+                        pRemoteIpAddress = pUSockDomainRemovePort(buffer);
+                        errnoLocal = U_SOCK_EHOSTUNREACH;
+                        // Set the callback first as the URC
+                        // could arrive at any time after the OK
+                        pSocket->pConnectCallback = pCallback;
+                        uAtClientLock(atHandle);
+                        uAtClientCommandStart(atHandle, "AT+USOCO=");
+                        // Write module socket handle
+                        uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
+                        // Write IP address
+                        uAtClientWriteString(atHandle, pRemoteIpAddress, true);
+                        // Write port number
+                        uAtClientWriteInt(atHandle, pRemoteAddress->port);
+                        // Asynchronous: the outcome arrives in +UUSOCO
+                        uAtClientWriteInt(atHandle, 1);
+                        uAtClientCommandStopReadResponse(atHandle);
+                        if (uAtClientUnlock(atHandle) == 0) {
+                            errnoLocal = U_SOCK_ENONE;
+                        } else {
+                            pSocket->pConnectCallback = NULL;
+                            // See what the module's socket error
+                            // number has to say for debug purposes
+                            doUsoer(atHandle);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return -errnoLocal;
+}
+
 // Close a socket.
 int32_t uCellSockClose(uDeviceHandle_t cellHandle,
                        int32_t sockHandle,
@@ -923,6 +2096,114 @@ void uCellSockCleanup(uDeviceHandle_t cellHandle)
     (void) cellHandle;
 }
 
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: POOL
+ * -------------------------------------------------------------- */
+
+// Set the number of sockets to keep ready in the module.
+int32_t uCellSockPoolSet(uDeviceHandle_t cellHandle,
+                         size_t numTcp, size_t numUdp)
+{
+    int32_t errnoLocal = U_SOCK_EINVAL;
+    uCellPrivateInstance_t *pInstance;
+    uCellSockPool_t *pPool;
+    int32_t surplus[U_CELL_SOCK_POOL_MAX_NUM];
+    size_t numSurplus = 0;
+    size_t numTcpKept = 0;
+    size_t numUdpKept = 0;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        if ((pInstance != NULL) &&
+            (numTcp + numUdp <= U_CELL_SOCK_POOL_MAX_NUM)) {
+            errnoLocal = U_SOCK_ENOMEM;
+            pPool = (uCellSockPool_t *) pInstance->pSockPoolContext;
+            if ((pPool == NULL) && (numTcp + numUdp > 0)) {
+                pPool = (uCellSockPool_t *) pUPortMalloc(sizeof(*pPool));
+                if (pPool != NULL) {
+                    memset(pPool, 0, sizeof(*pPool));
+                    for (size_t x = 0; x < U_CELL_SOCK_POOL_MAX_NUM; x++) {
+                        pPool->sockHandleModule[x] = -1;
+                    }
+                    if (uPortMutexCreate(&(pPool->mutex)) == 0) {
+                        pInstance->pSockPoolContext = pPool;
+                    } else {
+                        uPortFree(pPool);
+                        pPool = NULL;
+                    }
+                }
+            }
+            if (pPool != NULL) {
+                U_PORT_MUTEX_LOCK(pPool->mutex);
+                pPool->numTcpWanted = numTcp;
+                pPool->numUdpWanted = numUdp;
+                // Take out any sockets that are no longer wanted
+                for (size_t x = 0; x < U_CELL_SOCK_POOL_MAX_NUM; x++) {
+                    if (pPool->sockHandleModule[x] >= 0) {
+                        if ((pPool->protocol[x] == U_SOCK_PROTOCOL_TCP) &&
+                            (numTcpKept < numTcp)) {
+                            numTcpKept++;
+                        } else if ((pPool->protocol[x] == U_SOCK_PROTOCOL_UDP) &&
+                                   (numUdpKept < numUdp)) {
+                            numUdpKept++;
+                        } else {
+                            surplus[numSurplus] = pPool->sockHandleModule[x];
+                            numSurplus++;
+                            pPool->sockHandleModule[x] = -1;
+                        }
+                    }
+                }
+                U_PORT_MUTEX_UNLOCK(pPool->mutex);
+                for (size_t x = 0; x < numSurplus; x++) {
+                    closeInModule(pInstance->atHandle, surplus[x]);
+                }
+                // Fill the pool up in the background
+                poolFillPost(pInstance);
+                errnoLocal = U_SOCK_ENONE;
+            } else if (numTcp + numUdp == 0) {
+                // No pool and none wanted
+                errnoLocal = U_SOCK_ENONE;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return -errnoLocal;
+}
+
+// Get the number of sockets ready in the module.
+int32_t uCellSockPoolGet(uDeviceHandle_t cellHandle,
+                         uSockProtocol_t protocol)
+{
+    int32_t negErrnoLocalOrCount = -U_SOCK_EINVAL;
+    uCellPrivateInstance_t *pInstance;
+    uCellSockPool_t *pPool;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        if (pInstance != NULL) {
+            negErrnoLocalOrCount = 0;
+            pPool = (uCellSockPool_t *) pInstance->pSockPoolContext;
+            if (pPool != NULL) {
+                U_PORT_MUTEX_LOCK(pPool->mutex);
+                negErrnoLocalOrCount = (int32_t) poolCount(pPool, protocol);
+                U_PORT_MUTEX_UNLOCK(pPool->mutex);
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return negErrnoLocalOrCount;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: CONFIGURE
  * -------------------------------------------------------------- */
@@ -988,6 +2269,19 @@ int32_t uCellSockOptionSet(uDeviceHandle_t cellHandle,
                                     errnoLocal = setOptionLinger(pSocket, pOptionValue,
                                                                  optionValueLength);
                                     break;
+                                // The receive buffer size, which we
+                                // handle locally as a read-ahead buffer
+                                case U_SOCK_OPT_RCVBUF:
+                                    errnoLocal = setOptionReadAhead(pSocket, pOptionValue,
+                                                                    optionValueLength);
+                                    break;
+                                // The PDP context, handled by re-creating
+                                // the socket in the module
+                                case U_SOCK_OPT_PDP_CONTEXT:
+                                    errnoLocal = setOptionPdpContext(pInstance, pSocket,
+                                                                     pOptionValue,
+                                                                     optionValueLength);
+                                    break;
                                 default:
                                     break;
                             }
@@ -1074,6 +2368,29 @@ int32_t uCellSockOptionGet(uDeviceHandle_t cellHandle,
                                     errnoLocal = getOptionLinger(pSocket, pOptionValue,
                                                                  pOptionValueLength);
                                     break;
+                                case U_SOCK_OPT_RCVBUF:
+                                    errnoLocal = getOptionReadAhead(pSocket,
+                                                                    pInstance->socketsHexMode,
+                                                                    pOptionValue,
+                                                                    pOptionValueLength);
+                                    break;
+                                // The PDP context, which we know
+                                case U_SOCK_OPT_PDP_CONTEXT:
+                                    errnoLocal = U_SOCK_EINVAL;
+                                    if (pOptionValueLength != NULL) {
+                                        errnoLocal = U_SOCK_ENONE;
+                                        if (pOptionValue != NULL) {
+                                            errnoLocal = U_SOCK_EINVAL;
+                                            if (*pOptionValueLength >= sizeof(int32_t)) {
+                                                *((int32_t *) pOptionValue) = pSocket->contextId;
+                                                errnoLocal = U_SOCK_ENONE;
+                                            }
+                                        }
+                                        if (errnoLocal == U_SOCK_ENONE) {
+                                            *pOptionValueLength = sizeof(int32_t);
+                                        }
+                                    }
+                                    break;
                                 default:
                                     break;
                             }
@@ -1216,107 +2533,181 @@ int32_t uCellSockSetNextLocalPort(uDeviceHandle_t cellHandle,
  * PUBLIC FUNCTIONS: UDP ONLY
  * -------------------------------------------------------------- */
 
-// Send a datagram.
-int32_t uCellSockSendTo(uDeviceHandle_t cellHandle,
-                        int32_t sockHandle,
-                        const uSockAddress_t *pRemoteAddress,
-                        const void *pData, size_t dataSizeBytes)
+// Send a datagram.
+int32_t uCellSockSendTo(uDeviceHandle_t cellHandle,
+                        int32_t sockHandle,
+                        const uSockAddress_t *pRemoteAddress,
+                        const void *pData, size_t dataSizeBytes)
+{
+    uSockIoVec_t ioVec;
+
+    ioVec.pData = pData;
+    ioVec.dataSizeBytes = dataSizeBytes;
+
+    return uCellSockSendToV(cellHandle, sockHandle, pRemoteAddress,
+                            &ioVec, 1);
+}
+
+// Send a datagram gathered from several pieces of data.
+int32_t uCellSockSendToV(uDeviceHandle_t cellHandle,
+                         int32_t sockHandle,
+                         const uSockAddress_t *pRemoteAddress,
+                         const uSockIoVec_t *pIoVec, size_t ioVecCount)
+{
+    int32_t negErrnoLocalOrSize = -U_SOCK_EINVAL;
+    int32_t dataSizeBytes = uSockIoVecSize(pIoVec, ioVecCount);
+    uCellPrivateInstance_t *pInstance;
+    uAtClientHandle_t atHandle;
+    uCellSockSocket_t *pSocket;
+    char buffer[U_SOCK_ADDRESS_STRING_MAX_LENGTH_BYTES];
+    char *pRemoteIpAddress;
+    char *pHexBuffer = NULL;
+
+    // Find the instance
+    pInstance = pUCellPrivateGetInstance(cellHandle);
+    if ((pInstance != NULL) && (dataSizeBytes >= 0)) {
+        atHandle = pInstance->atHandle;
+        // Find the entry
+        if (sockHandle >= 0) {
+            pSocket = pFindBySockHandle(sockHandle);
+            if (pSocket != NULL) {
+                negErrnoLocalOrSize = sendToCheck(pInstance, pRemoteAddress,
+                                                  dataSizeBytes, buffer,
+                                                  &pRemoteIpAddress);
+                if (negErrnoLocalOrSize == 0) {
+                    if (pInstance->socketsHexMode) {
+                        negErrnoLocalOrSize = -U_SOCK_ENOMEM;
+                        // +1 for terminator
+                        pHexBuffer = (char *) pUPortMallocTagged(U_PORT_HEAP_TAG_CELL_SOCK,
+                                                                 dataSizeBytes * 2 + 1);
+                    }
+                    if (!pInstance->socketsHexMode || (pHexBuffer != NULL)) {
+                        uAtClientLock(atHandle);
+                        negErrnoLocalOrSize = sendToLocked(atHandle, pSocket,
+                                                           pRemoteIpAddress,
+                                                           pRemoteAddress->port,
+                                                           pIoVec, ioVecCount,
+                                                           dataSizeBytes,
+                                                           pHexBuffer);
+                        uAtClientUnlock(atHandle);
+                        // Free the buffer
+                        uPortFreeTagged(pHexBuffer);
+                        uCellPwrPrivateEnergyBytes(pInstance, true,
+                                                   negErrnoLocalOrSize);
+                        if (negErrnoLocalOrSize > 0) {
+                            // The radio is awake: send any deferred
+                            // security heartbeat along with the data
+                            uCellSecPrivateHeartbeatWake(pInstance);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return negErrnoLocalOrSize;
+}
+
+// Send several datagrams.
+int32_t uCellSockSendToBatch(uDeviceHandle_t cellHandle,
+                             int32_t sockHandle,
+                             uSockDatagram_t *pDatagrams,
+                             size_t count)
 {
-    int32_t negErrnoLocalOrSize = -U_SOCK_EINVAL;
+    int32_t negErrnoLocalOrCount = -U_SOCK_EINVAL;
     uCellPrivateInstance_t *pInstance;
     uAtClientHandle_t atHandle;
     uCellSockSocket_t *pSocket;
+    uSockDatagram_t *pDatagram;
+    uSockIoVec_t ioVec;
     char buffer[U_SOCK_ADDRESS_STRING_MAX_LENGTH_BYTES];
     char *pRemoteIpAddress;
-    size_t dataLengthMax = U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES;
-    int32_t sentSize = 0;
-    size_t x;
-    bool written = false;
-    char *pHexBuffer = NULL;
+    size_t numValid = 0;
+    size_t numSent = 0;
 
     // Find the instance
     pInstance = pUCellPrivateGetInstance(cellHandle);
-    if (pInstance != NULL) {
+    if ((pInstance != NULL) && (pDatagrams != NULL) && (count > 0)) {
         atHandle = pInstance->atHandle;
-        if (pInstance->socketsHexMode) {
-            dataLengthMax /= 2;
-        }
         // Find the entry
         if (sockHandle >= 0) {
             pSocket = pFindBySockHandle(sockHandle);
             if (pSocket != NULL) {
-                negErrnoLocalOrSize = -U_SOCK_EDESTADDRREQ;
-                if (uSockAddressToString(pRemoteAddress, buffer,
-                                         sizeof(buffer)) > 0) {
-                    pRemoteIpAddress = pUSockDomainRemovePort(buffer);
-                    if (pRemoteIpAddress != NULL) {
-                        negErrnoLocalOrSize = -U_SOCK_EMSGSIZE;
-                        if (dataSizeBytes <= dataLengthMax) {
-                            if (pInstance->socketsHexMode) {
-                                negErrnoLocalOrSize = -U_SOCK_ENOMEM;
-                                pHexBuffer = (char *) pUPortMalloc(dataSizeBytes * 2 + 1);  // +1 for terminator
-                                if (pHexBuffer != NULL) {
-                                    // Make the hex-coded null terminated string
-                                    x = uBinToHex((const char *) pData, dataSizeBytes, pHexBuffer);
-                                    *(pHexBuffer + x) = 0;
-                                }
+                // Check all of the datagrams first: only those
+                // before any bad one will be sent
+                negErrnoLocalOrCount = 0;
+                while ((numValid < count) && (negErrnoLocalOrCount == 0)) {
+                    pDatagram = &(pDatagrams[numValid]);
+                    negErrnoLocalOrCount = -U_SOCK_EINVAL;
+                    if ((pDatagram->pData != NULL) || (pDatagram->dataSizeBytes == 0)) {
+                        negErrnoLocalOrCount = sendToCheck(pInstance, &(pDatagram->address),
+                                                           (pDatagram->dataSizeBytes > INT_MAX) ?
+                                                           INT_MAX : (int32_t) pDatagram->dataSizeBytes,
+                                                           buffer, &pRemoteIpAddress);
+                    }
+                    if (negErrnoLocalOrCount == 0) {
+                        numValid++;
+                    } else {
+                        pDatagram->sizeBytes = negErrnoLocalOrCount;
+                    }
+                }
+                if (numValid > 0) {
+                    if (pInstance->socketsHexMode) {
+                        // The datagrams can be pipelined
+                        uAtClientLock(atHandle);
+                        negErrnoLocalOrCount = sendToBatchPipelined(pInstance,
+                                                                    pSocket,
+                                                                    pDatagrams,
+                                                                    numValid);
+                        uAtClientUnlock(atHandle);
+                    } else {
+                        // Binary mode: there's a prompt to wait for
+                        // with every datagram, so they must be sent
+                        // one at a time, but at least the AT interface
+                        // need only be locked once
+                        uAtClientLock(atHandle);
+                        negErrnoLocalOrCount = 0;
+                        while ((numSent < numValid) && (negErrnoLocalOrCount >= 0)) {
+                            pDatagram = &(pDatagrams[numSent]);
+                            negErrnoLocalOrCount = 0;
+                            if (pDatagram->dataSizeBytes > 0) {
+                                ioVec.pData = pDatagram->pData;
+                                ioVec.dataSizeBytes = pDatagram->dataSizeBytes;
+                                //lint -e(534) Ignore return value: already checked
+                                sendToCheck(pInstance, &(pDatagram->address),
+                                            (int32_t) pDatagram->dataSizeBytes,
+                                            buffer, &pRemoteIpAddress);
+                                negErrnoLocalOrCount = sendToLocked(atHandle, pSocket,
+                                                                    pRemoteIpAddress,
+                                                                    pDatagram->address.port,
+                                                                    &ioVec, 1,
+                                                                    (int32_t) pDatagram->dataSizeBytes,
+                                                                    NULL);
                             }
-                            if (!pInstance->socketsHexMode || (pHexBuffer != NULL)) {
-                                negErrnoLocalOrSize = -U_SOCK_EIO;
-                                uAtClientLock(atHandle);
-                                uAtClientCommandStart(atHandle, "AT+USOST=");
-                                // Write module socket handle
-                                uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
-                                // Write IP address
-                                uAtClientWriteString(atHandle, pRemoteIpAddress, true);
-                                // Write port number
-                                uAtClientWriteInt(atHandle, pRemoteAddress->port);
-                                // Number of bytes to follow
-                                uAtClientWriteInt(atHandle, (int32_t) dataSizeBytes);
-                                if (pHexBuffer) {
-                                    // Send the hex mode data as a string
-                                    uAtClientWriteString(atHandle, pHexBuffer, true);
-                                    uAtClientCommandStop(atHandle);
-                                    // Free the buffer
-                                    uPortFree(pHexBuffer);
-                                    written = true;
-                                } else {
-                                    // Not in hex mode, wait for the prompt
-                                    uAtClientCommandStop(atHandle);
-                                    if (uAtClientWaitCharacter(atHandle, '@') == 0) {
-                                        // Wait for it...
-                                        uPortTaskBlock(50);
-                                        // Send the binary data
-                                        uAtClientWriteBytes(atHandle, (const char *) pData,
-                                                            dataSizeBytes, true);
-                                        written = true;
-                                    }
-                                }
-                                if (written) {
-                                    // Grab the response
-                                    uAtClientResponseStart(atHandle, "+USOST:");
-                                    // Skip the socket ID
-                                    uAtClientSkipParameters(atHandle, 1);
-                                    // Bytes sent
-                                    sentSize = uAtClientReadInt(atHandle);
-                                    uAtClientResponseStop(atHandle);
-                                    if ((uAtClientUnlock(atHandle) == 0) &&
-                                        (sentSize >= 0)) {
-                                        // All is good, probably
-                                        negErrnoLocalOrSize = sentSize;
-                                    }
-                                } else {
-                                    uAtClientUnlock(atHandle);
-                                }
+                            pDatagram->sizeBytes = negErrnoLocalOrCount;
+                            if (negErrnoLocalOrCount >= 0) {
+                                numSent++;
                             }
                         }
+                        uAtClientUnlock(atHandle);
+                        if (numSent > 0) {
+                            negErrnoLocalOrCount = (int32_t) numSent;
+                        }
+                    }
+                    for (size_t x = 0; (negErrnoLocalOrCount > 0) &&
+                         (x < (size_t) negErrnoLocalOrCount); x++) {
+                        uCellPwrPrivateEnergyBytes(pInstance, true,
+                                                   pDatagrams[x].sizeBytes);
+                    }
+                    if (negErrnoLocalOrCount > 0) {
+                        uCellSecPrivateHeartbeatWake(pInstance);
                     }
                 }
             }
         }
     }
 
-    return negErrnoLocalOrSize;
+    return negErrnoLocalOrCount;
 }
 
 // Receive a datagram.
@@ -1329,183 +2720,76 @@ int32_t uCellSockReceiveFrom(uDeviceHandle_t cellHandle,
     uCellPrivateInstance_t *pInstance;
     uAtClientHandle_t atHandle;
     uCellSockSocket_t *pSocket;
-    int32_t dataLengthMax = U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES;
-    char buffer[U_SOCK_ADDRESS_STRING_MAX_LENGTH_BYTES];
-    int32_t x;
-    int32_t port = -1;
-    int32_t receivedSize = -1;
-    int32_t readLength;
-    char *pHexBuffer = NULL;
-
-    buffer[0] = 0;  // In case of slip-ups
-
-    // Note: the real maximum length of UDP packet we can receive
-    // comes from fitting all of the following into one buffer:
-    //
-    // +USORF: xx,"max.len.ip.address.ipv4.or.ipv6",yyyyy,wwww,"the_data"\r\n
-    //
-    // where xx is the handle, max.len.ip.address.ipv4.or.ipv6 is NSAPI_IP_SIZE,
-    // yyyyy is the port number (max 65536), wwww is the length of the data and
-    // the_data is binary data. I make that 29 + 48 + len(the_data),
-    // so the overhead is 77 bytes.
 
     // Find the instance
     pInstance = pUCellPrivateGetInstance(cellHandle);
     if (pInstance != NULL) {
         atHandle = pInstance->atHandle;
-        if (pInstance->socketsHexMode) {
-            dataLengthMax /= 2;
+        // Find the entry
+        if (sockHandle >= 0) {
+            pSocket = pFindBySockHandle(sockHandle);
+            if (pSocket != NULL) {
+                uAtClientLock(atHandle);
+                negErrnoLocalOrSize = receiveFromLocked(pInstance, pSocket,
+                                                        pRemoteAddress,
+                                                        pData, dataSizeBytes);
+                uAtClientUnlock(atHandle);
+            }
         }
+    }
+
+    return negErrnoLocalOrSize;
+}
+
+// Receive several datagrams.
+int32_t uCellSockReceiveFromBatch(uDeviceHandle_t cellHandle,
+                                  int32_t sockHandle,
+                                  uSockDatagram_t *pDatagrams,
+                                  size_t count)
+{
+    int32_t negErrnoLocalOrCount = -U_SOCK_EINVAL;
+    uCellPrivateInstance_t *pInstance;
+    uAtClientHandle_t atHandle;
+    uCellSockSocket_t *pSocket;
+    uSockDatagram_t *pDatagram;
+    int32_t negErrnoLocalOrSize = 0;
+    size_t numReceived = 0;
+
+    // Find the instance
+    pInstance = pUCellPrivateGetInstance(cellHandle);
+    if ((pInstance != NULL) && (pDatagrams != NULL) && (count > 0)) {
+        atHandle = pInstance->atHandle;
         // Find the entry
         if (sockHandle >= 0) {
             pSocket = pFindBySockHandle(sockHandle);
             if (pSocket != NULL) {
-                negErrnoLocalOrSize = -U_SOCK_EWOULDBLOCK;
-                if (pSocket->pendingBytes == 0) {
-                    // If the URC has not filled in pendingBytes,
-                    // ask the module directly if there is anything
-                    // to read
-                    uAtClientLock(atHandle);
-                    uAtClientCommandStart(atHandle, "AT+USORF=");
-                    uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
-                    // Zero bytes to read, just want to know the number
-                    // of bytes waiting
-                    uAtClientWriteInt(atHandle, 0);
-                    uAtClientCommandStop(atHandle);
-                    uAtClientResponseStart(atHandle, "+USORF:");
-                    // Skip the socket ID
-                    uAtClientSkipParameters(atHandle, 1);
-                    // Read the amount of data
-                    x = uAtClientReadInt(atHandle);
-                    uAtClientResponseStop(atHandle);
-                    // Update pending bytes here, before
-                    // unlocking, as otherwise a data callback
-                    // triggered by a URC could be sitting waiting
-                    // to grab the AT lock and jump in before
-                    // pending bytes has been updated, leading it
-                    // back into here again, etc, etc.
-                    if (x > 0) {
-                        pSocket->pendingBytes = x;
-                        // DON'T call the user data callback here:
-                        // we already have the AT interface locked
-                        // and a user might try to call back into
-                        // here which would result in deadlock.
-                        // They will get their received data, there
-                        // is no need to worry.
-                    }
-                    uAtClientUnlock(atHandle);
-                }
-                if (pSocket->pendingBytes > 0) {
-                    // In the UDP case we HAVE to read the number
-                    // of bytes pending as this will be the size
-                    // of the next UDP packet in the module and the
-                    // module can only deliver whole UDP packets.
-                    uAtClientLock(atHandle);
-                    uAtClientCommandStart(atHandle, "AT+USORF=");
-                    uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
-                    // Number of bytes to read
-                    uAtClientWriteInt(atHandle, dataLengthMax);
-                    uAtClientCommandStop(atHandle);
-                    uAtClientResponseStart(atHandle, "+USORF:");
-                    // Skip the socket ID
-                    uAtClientSkipParameters(atHandle, 1);
-                    // Read the IP address
-                    uAtClientReadString(atHandle, buffer,
-                                        sizeof(buffer), false);
-                    // Read the port
-                    port = uAtClientReadInt(atHandle);
-                    // Read the amount of data
-                    receivedSize = uAtClientReadInt(atHandle);
-                    if (receivedSize > dataLengthMax) {
-                        receivedSize = dataLengthMax;
-                    }
-                    if ((int32_t) dataSizeBytes > receivedSize) {
-                        dataSizeBytes = receivedSize;
-                    }
-                    if (receivedSize > 0) {
-                        if (pInstance->socketsHexMode) {
-                            // In hex mode we need a buffer to dump
-                            // the hex into and then we can decode it
-                            negErrnoLocalOrSize = -U_SOCK_ENOMEM;
-                            //lint -e{647} Suppress suspicious truncation
-                            pHexBuffer = (char *) pUPortMalloc(receivedSize * 2 + 1);  // +1 for terminator
-                        }
-                        if (!pInstance->socketsHexMode || (pHexBuffer != NULL)) {
-                            if (pHexBuffer != NULL) {
-                                // In hex mode we can read in the whole string
-                                //lint -e{647} Suppress suspicious truncation
-                                readLength = uAtClientReadString(atHandle, pHexBuffer,
-                                                                 receivedSize * 2 + 1, false);
-                                if (readLength > 0) {
-                                    x = (int32_t) dataSizeBytes * 2;
-                                    if (readLength > x) {
-                                        readLength = x;
-                                    }
-                                    uHexToBin(pHexBuffer, readLength, (char *) pData);
-                                }
-                                // Free memory
-                                uPortFree(pHexBuffer);
-                            } else {
-                                // Binary mode, don't stop for anything!
-                                uAtClientIgnoreStopTag(atHandle);
-                                // Get the leading quote mark out of the way
-                                uAtClientReadBytes(atHandle, NULL, 1, true);
-                                // Now read out all the actual data,
-                                // first the bit we want
-                                uAtClientReadBytes(atHandle, (char *) pData,
-                                                   dataSizeBytes, true);
-                                if (receivedSize > (int32_t) dataSizeBytes) {
-                                    //...and then the rest poured away to NULL
-                                    uAtClientReadBytes(atHandle, NULL,
-                                                       receivedSize -
-                                                       dataSizeBytes, true);
-                                }
-                                // Make sure to wait for the stop tag before
-                                // we finish
-                                uAtClientRestoreStopTag(atHandle);
-                            }
-                        }
+                // Read datagrams back-to-back until we run out
+                // of room or the module runs out of datagrams
+                uAtClientLock(atHandle);
+                while ((numReceived < count) && (negErrnoLocalOrSize >= 0)) {
+                    pDatagram = &(pDatagrams[numReceived]);
+                    negErrnoLocalOrSize = -U_SOCK_EINVAL;
+                    if ((pDatagram->pData != NULL) && (pDatagram->dataSizeBytes > 0)) {
+                        negErrnoLocalOrSize = receiveFromLocked(pInstance, pSocket,
+                                                                &(pDatagram->address),
+                                                                pDatagram->pData,
+                                                                pDatagram->dataSizeBytes);
                     }
-                    uAtClientResponseStop(atHandle);
-                    // BEFORE unlocking, work out what's happened.
-                    // This is to prevent a URC being processed that
-                    // may indicate data left and over-write pendingBytes
-                    // while we're also writing to it.
-                    if ((uAtClientErrorGet(atHandle) == 0) &&
-                        (receivedSize >= 0)) {
-                        // Must use what +USORF returns here as it may be less
-                        // or more than we asked for and also may be
-                        // more than pendingBytes, depending on how
-                        // the URCs landed
-                        // This update of pendingBytes will be overwritten
-                        // by the URC but we have to do something here
-                        // 'cos we don't get a URC to tell us when pendingBytes
-                        // has gone to zero.
-                        if (receivedSize > pSocket->pendingBytes) {
-                            pSocket->pendingBytes = 0;
-                        } else {
-                            pSocket->pendingBytes -= receivedSize;
-                        }
-                        negErrnoLocalOrSize = receivedSize;
+                    if (negErrnoLocalOrSize >= 0) {
+                        pDatagram->sizeBytes = negErrnoLocalOrSize;
+                        numReceived++;
                     }
-                    uAtClientUnlock(atHandle);
+                }
+                uAtClientUnlock(atHandle);
+                negErrnoLocalOrCount = negErrnoLocalOrSize;
+                if (numReceived > 0) {
+                    negErrnoLocalOrCount = (int32_t) numReceived;
                 }
             }
         }
     }
 
-    if ((negErrnoLocalOrSize >= 0) && (pRemoteAddress != NULL) && (port >= 0)) {
-        if (uSockStringToAddress(buffer, pRemoteAddress) == 0) {
-            pRemoteAddress->port = (uint16_t) port;
-        } else {
-            // If we can't decode the remote address this becomes
-            // an error, can't go receiving things from servers
-            // we know not who they are
-            negErrnoLocalOrSize = -U_SOCK_EIO;
-        }
-    }
-
-    return negErrnoLocalOrSize;
+    return negErrnoLocalOrCount;
 }
 
 /* ----------------------------------------------------------------
@@ -1516,14 +2800,29 @@ int32_t uCellSockReceiveFrom(uDeviceHandle_t cellHandle,
 int32_t uCellSockWrite(uDeviceHandle_t cellHandle,
                        int32_t sockHandle,
                        const void *pData, size_t dataSizeBytes)
+{
+    uSockIoVec_t ioVec;
+
+    ioVec.pData = pData;
+    ioVec.dataSizeBytes = dataSizeBytes;
+
+    return uCellSockWritev(cellHandle, sockHandle, &ioVec, 1);
+}
+
+// Send bytes gathered from several pieces over a connected socket.
+int32_t uCellSockWritev(uDeviceHandle_t cellHandle,
+                        int32_t sockHandle,
+                        const uSockIoVec_t *pIoVec, size_t ioVecCount)
 {
     int32_t negErrnoLocalOrSize = -U_SOCK_EINVAL;
     uCellPrivateInstance_t *pInstance;
     uAtClientHandle_t atHandle;
     uCellSockSocket_t *pSocket;
-    int32_t leftToSendSize = (int32_t) dataSizeBytes;
+    int32_t dataSizeBytes = uSockIoVecSize(pIoVec, ioVecCount);
+    int32_t leftToSendSize = dataSizeBytes;
     int32_t sentSize = 0;
-    int32_t dataOffset = 0;
+    size_t ioVecIndex = 0;
+    size_t ioVecOffset = 0;
     int32_t thisSendSize = U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES;
     size_t x = 0;
     bool written = true;
@@ -1531,17 +2830,33 @@ int32_t uCellSockWrite(uDeviceHandle_t cellHandle,
 
     // Find the instance
     pInstance = pUCellPrivateGetInstance(cellHandle);
-    if (pInstance != NULL) {
+    if ((pInstance != NULL) && (dataSizeBytes >= 0)) {
         atHandle = pInstance->atHandle;
         if (pInstance->socketsHexMode) {
             thisSendSize /= 2;
             negErrnoLocalOrSize = -U_SOCK_ENOMEM;
-            pHexBuffer = (char *)pUPortMalloc(thisSendSize * 2 + 1); // +1 for terminator
+            pHexBuffer = (char *)pUPortMallocTagged(U_PORT_HEAP_TAG_CELL_SOCK,
+                                                    thisSendSize * 2 + 1); // +1 for terminator
         }
         // Find the entry
         if (sockHandle >= 0) {
             pSocket = pFindBySockHandle(sockHandle);
-            if (pSocket != NULL) {
+            if ((pSocket != NULL) && pSocket->directLink) {
+                // No AT commands in direct link mode, just
+                // straight to the stream
+                negErrnoLocalOrSize = 0;
+                for (size_t y = 0; (y < ioVecCount) && (negErrnoLocalOrSize >= 0); y++) {
+                    sentSize = directLinkWrite(pSocket, (const char *) pIoVec[y].pData,
+                                               pIoVec[y].dataSizeBytes);
+                    if (sentSize >= 0) {
+                        negErrnoLocalOrSize += sentSize;
+                    } else {
+                        negErrnoLocalOrSize = sentSize;
+                    }
+                }
+                // For the sum at the end, should nothing be sent
+                leftToSendSize = dataSizeBytes - negErrnoLocalOrSize;
+            } else if (pSocket != NULL) {
                 if (!pInstance->socketsHexMode || (pHexBuffer != NULL)) {
                     negErrnoLocalOrSize = U_SOCK_ENONE;
                     x = 0;
@@ -1561,9 +2876,8 @@ int32_t uCellSockWrite(uDeviceHandle_t cellHandle,
                         written = false;
                         if (pHexBuffer) {
                             // Make the hex-coded null terminated string
-                            uBinToHex((const char *) pData + dataOffset,
-                                      thisSendSize, pHexBuffer);
-                            pHexBuffer[thisSendSize * 2] = 0;
+                            ioVecSend(atHandle, pHexBuffer, pIoVec, ioVecCount,
+                                      ioVecIndex, ioVecOffset, thisSendSize);
                             // Send the hex mode data as a string
                             //lint -e(679) Suppress suspicious truncation
                             uAtClientWriteString(atHandle, pHexBuffer, true);
@@ -1574,11 +2888,11 @@ int32_t uCellSockWrite(uDeviceHandle_t cellHandle,
                             // Wait for the prompt
                             if (uAtClientWaitCharacter(atHandle, '@') == 0) {
                                 // Wait for it...
-                                uPortTaskBlock(50);
-                                // Go!
-                                uAtClientWriteBytes(atHandle,
-                                                    (const char *) pData + dataOffset,
-                                                    thisSendSize, true);
+                                uPortTaskBlock(U_CELL_SOCK_BINARY_PROMPT_DELAY_MS);
+                                // Go!  All the pieces that fit in this
+                                // segment go in the one +USOWR
+                                ioVecSend(atHandle, NULL, pIoVec, ioVecCount,
+                                          ioVecIndex, ioVecOffset, thisSendSize);
                                 written = true;
                             }
                         }
@@ -1591,8 +2905,11 @@ int32_t uCellSockWrite(uDeviceHandle_t cellHandle,
                             sentSize = uAtClientReadInt(atHandle);
                             uAtClientResponseStop(atHandle);
                             if (uAtClientUnlock(atHandle) == 0) {
-                                dataOffset += sentSize;
-                                leftToSendSize -= sentSize;
+                                if (sentSize > 0) {
+                                    ioVecAdvance(pIoVec, ioVecCount, &ioVecIndex,
+                                                 &ioVecOffset, sentSize);
+                                    leftToSendSize -= sentSize;
+                                }
                                 // Technically, it should be OK to
                                 // send fewer bytes than asked for,
                                 // however if this happens a lot we'll
@@ -1617,12 +2934,155 @@ int32_t uCellSockWrite(uDeviceHandle_t cellHandle,
             }
         }
         // Free the buffer
-        uPortFree(pHexBuffer);
+        uPortFreeTagged(pHexBuffer);
     }
 
     if (negErrnoLocalOrSize == U_SOCK_ENONE) {
         // All is good
-        negErrnoLocalOrSize = ((int32_t) dataSizeBytes) - leftToSendSize;
+        negErrnoLocalOrSize = dataSizeBytes - leftToSendSize;
+    }
+    if (pInstance != NULL) {
+        uCellPwrPrivateEnergyBytes(pInstance, true, negErrnoLocalOrSize);
+        if (negErrnoLocalOrSize > 0) {
+            uCellSecPrivateHeartbeatWake(pInstance);
+        }
+    }
+
+    return negErrnoLocalOrSize;
+}
+
+// Receive bytes on a connected socket from the cellular module,
+// returning the number of bytes received or a negated value of
+// U_SOCK_Exxx.
+static int32_t sockReadModule(uCellPrivateInstance_t *pInstance,
+                              uCellSockSocket_t *pSocket,
+                              char *pData, size_t dataSizeBytes)
+{
+    int32_t negErrnoLocalOrSize;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    int32_t dataLengthMax = U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES;
+    int32_t x = -1;
+    int32_t thisWantedReceiveSize;
+    int32_t thisActualReceiveSize;
+    int32_t totalReceivedSize = 0;
+
+    if (pInstance->socketsHexMode) {
+        dataLengthMax /= 2;
+    }
+
+    negErrnoLocalOrSize = -U_SOCK_EWOULDBLOCK;
+    if (pSocket->pendingBytes == 0) {
+        // If the URC has not filled in pendingBytes,
+        // ask the module directly if there is anything
+        // to read
+        uAtClientLock(atHandle);
+        uAtClientCommandStart(atHandle, "AT+USORD=");
+        uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
+        // Zero bytes to read, just want to know the number
+        // of bytes waiting
+        uAtClientWriteInt(atHandle, 0);
+        uAtClientCommandStop(atHandle);
+        uAtClientResponseStart(atHandle, "+USORD:");
+        // Skip the socket ID
+        uAtClientSkipParameters(atHandle, 1);
+        // Read the amount of data
+        x = uAtClientReadInt(atHandle);
+        uAtClientResponseStop(atHandle);
+        // Update pending bytes here, before
+        // unlocking, as otherwise a data callback
+        // triggered by a URC could be sitting waiting
+        // to grab the AT lock and jump in before
+        // pending bytes has been updated, leading it
+        // back into here again, etc, etc.
+        if (x > 0) {
+            pSocket->pendingBytes = x;
+            // DON'T call the user data callback here:
+            // we already have the AT interface locked
+            // and a user might try to call back into
+            // here which would result in deadlock.
+            // They will get their received data, there
+            // is no need to worry.
+        }
+        uAtClientUnlock(atHandle);
+    }
+    if (pSocket->pendingBytes > 0) {
+        negErrnoLocalOrSize = U_SOCK_ENONE;
+        // Run around the loop until we run out of
+        // pending data or room in the buffer
+        while ((dataSizeBytes > 0) &&
+               (pSocket->pendingBytes > 0) &&
+               (negErrnoLocalOrSize == U_SOCK_ENONE)) {
+            thisWantedReceiveSize = dataLengthMax;
+            if (thisWantedReceiveSize > (int32_t) dataSizeBytes) {
+                thisWantedReceiveSize = (int32_t) dataSizeBytes;
+            }
+            uAtClientLock(atHandle);
+            uAtClientCommandStart(atHandle, "AT+USORD=");
+            uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
+            // Number of bytes to read
+            uAtClientWriteInt(atHandle, thisWantedReceiveSize);
+            uAtClientCommandStop(atHandle);
+            uAtClientResponseStart(atHandle, "+USORD:");
+            // Skip the socket ID
+            uAtClientSkipParameters(atHandle, 1);
+            // Read the amount of data
+            thisActualReceiveSize = uAtClientReadInt(atHandle);
+            if (thisActualReceiveSize > (int32_t) dataSizeBytes) {
+                thisActualReceiveSize = (int32_t) dataSizeBytes;
+            }
+            if (thisActualReceiveSize > 0) {
+                if (pInstance->socketsHexMode) {
+                    // In hex mode decode straight out of the
+                    // AT client's receive buffer
+                    //lint -e{647} Suppress suspicious truncation
+                    readHexDirect(atHandle, thisActualReceiveSize * 2,
+                                  pData + totalReceivedSize,
+                                  dataSizeBytes);
+                } else {
+                    // Binary mode, don't stop for anything!
+                    uAtClientIgnoreStopTag(atHandle);
+                    // Get the leading quote mark out of the way
+                    uAtClientReadBytes(atHandle, NULL, 1, true);
+                    // Now read out the available data
+                    uAtClientReadBytes(atHandle,
+                                       pData + totalReceivedSize,
+                                       thisActualReceiveSize, true);
+                    // Make sure we wait for the stop tag before
+                    // going around again
+                    uAtClientRestoreStopTag(atHandle);
+                }
+            }
+            uAtClientResponseStop(atHandle);
+            // BEFORE unlocking, work out what's happened.
+            // This is to prevent a URC being processed that
+            // may indicate data left and over-write pendingBytes
+            // while we're also writing to it.
+            if ((uAtClientErrorGet(atHandle) == 0) &&
+                (thisActualReceiveSize >= 0)) {
+                // Must use what +USORD returns here as it may be less
+                // or more than we asked for and also may be
+                // more than pendingBytes, depending on how
+                // the URCs landed
+                // This update of pendingBytes will be overwritten
+                // by the URC but we have to do something here
+                // 'cos we don't get a URC to tell us when pendingBytes
+                // has gone to zero.
+                if (thisActualReceiveSize > pSocket->pendingBytes) {
+                    pSocket->pendingBytes = 0;
+                } else {
+                    pSocket->pendingBytes -= thisActualReceiveSize;
+                }
+                totalReceivedSize += thisActualReceiveSize;
+                dataSizeBytes -= thisActualReceiveSize;
+            } else {
+                negErrnoLocalOrSize = -U_SOCK_EIO;
+            }
+            uAtClientUnlock(atHandle);
+        }
+    }
+
+    if (totalReceivedSize > 0) {
+        negErrnoLocalOrSize = totalReceivedSize;
     }
 
     return negErrnoLocalOrSize;
@@ -1635,155 +3095,79 @@ int32_t uCellSockRead(uDeviceHandle_t cellHandle,
 {
     int32_t negErrnoLocalOrSize = -U_SOCK_EINVAL;
     uCellPrivateInstance_t *pInstance;
-    uAtClientHandle_t atHandle;
     uCellSockSocket_t *pSocket;
-    int32_t dataLengthMax = U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES;
-    int32_t x = -1;
-    int32_t thisWantedReceiveSize;
-    int32_t thisActualReceiveSize;
-    int32_t totalReceivedSize = 0;
-    int32_t readLength;
-    char *pHexBuffer = NULL;
+    size_t totalReceivedSize = 0;
+    size_t x;
 
     // Find the instance
     pInstance = pUCellPrivateGetInstance(cellHandle);
     if (pInstance != NULL) {
-        atHandle = pInstance->atHandle;
-        if (pInstance->socketsHexMode) {
-            dataLengthMax /= 2;
-        }
         // Find the entry
         if (sockHandle >= 0) {
             pSocket = pFindBySockHandle(sockHandle);
-            if (pSocket != NULL) {
-                negErrnoLocalOrSize = -U_SOCK_EWOULDBLOCK;
-                if (pSocket->pendingBytes == 0) {
-                    // If the URC has not filled in pendingBytes,
-                    // ask the module directly if there is anything
-                    // to read
-                    uAtClientLock(atHandle);
-                    uAtClientCommandStart(atHandle, "AT+USORD=");
-                    uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
-                    // Zero bytes to read, just want to know the number
-                    // of bytes waiting
-                    uAtClientWriteInt(atHandle, 0);
-                    uAtClientCommandStop(atHandle);
-                    uAtClientResponseStart(atHandle, "+USORD:");
-                    // Skip the socket ID
-                    uAtClientSkipParameters(atHandle, 1);
-                    // Read the amount of data
-                    x = uAtClientReadInt(atHandle);
-                    uAtClientResponseStop(atHandle);
-                    // Update pending bytes here, before
-                    // unlocking, as otherwise a data callback
-                    // triggered by a URC could be sitting waiting
-                    // to grab the AT lock and jump in before
-                    // pending bytes has been updated, leading it
-                    // back into here again, etc, etc.
-                    if (x > 0) {
-                        pSocket->pendingBytes = x;
-                        // DON'T call the user data callback here:
-                        // we already have the AT interface locked
-                        // and a user might try to call back into
-                        // here which would result in deadlock.
-                        // They will get their received data, there
-                        // is no need to worry.
-                    }
-                    uAtClientUnlock(atHandle);
-                }
-                if (pSocket->pendingBytes > 0) {
-                    negErrnoLocalOrSize = U_SOCK_ENONE;
-                    // Run around the loop until we run out of
-                    // pending data or room in the buffer
-                    while ((dataSizeBytes > 0) &&
-                           (pSocket->pendingBytes > 0) &&
-                           (negErrnoLocalOrSize == U_SOCK_ENONE)) {
-                        thisWantedReceiveSize = dataLengthMax;
-                        if (thisWantedReceiveSize > (int32_t) dataSizeBytes) {
-                            thisWantedReceiveSize = (int32_t) dataSizeBytes;
+            if ((pSocket != NULL) && pSocket->directLink) {
+                negErrnoLocalOrSize = directLinkRead(pSocket, (char *) pData,
+                                                     dataSizeBytes);
+            } else if (pSocket != NULL) {
+                // A read cycle begins: data arriving from
+                // now on should be notified afresh
+                pSocket->dataNotified = false;
+                if (pSocket->pReadAhead == NULL) {
+                    negErrnoLocalOrSize = sockReadModule(pInstance, pSocket,
+                                                         (char *) pData, dataSizeBytes);
+                } else {
+                    negErrnoLocalOrSize = -U_SOCK_EWOULDBLOCK;
+                    // Serve what we can from the read-ahead buffer,
+                    // only going to the module if that can't satisfy
+                    // the read and the module has, or might have,
+                    // more
+                    do {
+                        x = pSocket->readAheadLength;
+                        if (x > dataSizeBytes) {
+                            x = dataSizeBytes;
                         }
-                        uAtClientLock(atHandle);
-                        uAtClientCommandStart(atHandle, "AT+USORD=");
-                        uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
-                        // Number of bytes to read
-                        uAtClientWriteInt(atHandle, thisWantedReceiveSize);
-                        uAtClientCommandStop(atHandle);
-                        uAtClientResponseStart(atHandle, "+USORD:");
-                        // Skip the socket ID
-                        uAtClientSkipParameters(atHandle, 1);
-                        // Read the amount of data
-                        thisActualReceiveSize = uAtClientReadInt(atHandle);
-                        if (thisActualReceiveSize > (int32_t) dataSizeBytes) {
-                            thisActualReceiveSize = (int32_t) dataSizeBytes;
+                        if (x > 0) {
+                            memcpy((char *) pData + totalReceivedSize,
+                                   pSocket->pReadAhead + pSocket->readAheadStart, x);
+                            pSocket->readAheadStart += x;
+                            pSocket->readAheadLength -= x;
+                            totalReceivedSize += x;
+                            dataSizeBytes -= x;
                         }
-                        if (thisActualReceiveSize > 0) {
-                            if (pInstance->socketsHexMode) {
-                                // In hex mode we need a buffer to dump
-                                // the hex into and then we can decode it
-                                negErrnoLocalOrSize = -U_SOCK_ENOMEM;
-                                //lint -e{647} Suppress suspicious truncation
-                                pHexBuffer = (char *) pUPortMalloc(thisActualReceiveSize * 2 + 1);  // +1 for terminator
-                            }
-                            if (!pInstance->socketsHexMode || (pHexBuffer != NULL)) {
-                                negErrnoLocalOrSize = U_SOCK_ENONE;
-                                if (pHexBuffer != NULL) {
-                                    // In hex mode we can read in the whole string
-                                    //lint -e{647} Suppress suspicious truncation
-                                    readLength = uAtClientReadString(atHandle, pHexBuffer,
-                                                                     thisActualReceiveSize * 2 + 1,
-                                                                     false);
-                                    if (readLength > 0) {
-                                        x = ((int32_t) dataSizeBytes) * 2;
-                                        if (readLength > x) {
-                                            readLength = x;
-                                        }
-                                        uHexToBin(pHexBuffer, readLength,
-                                                  (char *) pData + totalReceivedSize);
-                                    }
-                                    // Free memory
-                                    uPortFree(pHexBuffer);
-                                } else {
-                                    // Binary mode, don't stop for anything!
-                                    uAtClientIgnoreStopTag(atHandle);
-                                    // Get the leading quote mark out of the way
-                                    uAtClientReadBytes(atHandle, NULL, 1, true);
-                                    // Now read out the available data
-                                    uAtClientReadBytes(atHandle,
-                                                       (char *) pData +
-                                                       totalReceivedSize,
-                                                       thisActualReceiveSize, true);
-                                    // Make sure we wait for the stop tag before
-                                    // going around again
-                                    uAtClientRestoreStopTag(atHandle);
+                        if ((dataSizeBytes > 0) &&
+                            ((totalReceivedSize == 0) || (pSocket->pendingBytes > 0))) {
+                            if (dataSizeBytes >= pSocket->readAheadSizeBytes) {
+                                // No point in buffering, read straight
+                                // into the caller's buffer
+                                negErrnoLocalOrSize = sockReadModule(pInstance, pSocket,
+                                                                     (char *) pData + totalReceivedSize,
+                                                                     dataSizeBytes);
+                                if (negErrnoLocalOrSize > 0) {
+                                    totalReceivedSize += negErrnoLocalOrSize;
+                                    dataSizeBytes -= negErrnoLocalOrSize;
                                 }
-                            }
-                        }
-                        uAtClientResponseStop(atHandle);
-                        // BEFORE unlocking, work out what's happened.
-                        // This is to prevent a URC being processed that
-                        // may indicate data left and over-write pendingBytes
-                        // while we're also writing to it.
-                        if ((uAtClientErrorGet(atHandle) == 0) &&
-                            (thisActualReceiveSize >= 0)) {
-                            // Must use what +USORD returns here as it may be less
-                            // or more than we asked for and also may be
-                            // more than pendingBytes, depending on how
-                            // the URCs landed
-                            // This update of pendingBytes will be overwritten
-                            // by the URC but we have to do something here
-                            // 'cos we don't get a URC to tell us when pendingBytes
-                            // has gone to zero.
-                            if (thisActualReceiveSize > pSocket->pendingBytes) {
-                                pSocket->pendingBytes = 0;
                             } else {
-                                pSocket->pendingBytes -= thisActualReceiveSize;
+                                // Fill the read-ahead buffer and
+                                // go around again to copy from it
+                                pSocket->readAheadStart = 0;
+                                negErrnoLocalOrSize = sockReadModule(pInstance, pSocket,
+                                                                     pSocket->pReadAhead,
+                                                                     pSocket->readAheadSizeBytes);
+                                if (negErrnoLocalOrSize > 0) {
+                                    pSocket->readAheadLength = negErrnoLocalOrSize;
+                                }
                             }
-                            totalReceivedSize += thisActualReceiveSize;
-                            dataSizeBytes -= thisActualReceiveSize;
                         } else {
-                            negErrnoLocalOrSize = -U_SOCK_EIO;
+                            negErrnoLocalOrSize = U_SOCK_ENONE;
                         }
-                        uAtClientUnlock(atHandle);
+                    } while ((pSocket->readAheadLength > 0) && (dataSizeBytes > 0) &&
+                             (negErrnoLocalOrSize > 0));
+                    if (pSocket->readAheadLength > 0) {
+                        // There will be no URC from the module for
+                        // what remains in the read-ahead buffer so
+                        // call the user data callback via the
+                        // trampoline, as the URC would have done
+                        dataNotify(pInstance->atHandle, pSocket);
                     }
                 }
             }
@@ -1791,12 +3175,147 @@ int32_t uCellSockRead(uDeviceHandle_t cellHandle,
     }
 
     if (totalReceivedSize > 0) {
-        negErrnoLocalOrSize = totalReceivedSize;
+        negErrnoLocalOrSize = (int32_t) totalReceivedSize;
+    }
+    if (pInstance != NULL) {
+        uCellPwrPrivateEnergyBytes(pInstance, false, negErrnoLocalOrSize);
     }
 
     return negErrnoLocalOrSize;
 }
 
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: DIRECT LINK
+ * -------------------------------------------------------------- */
+
+// Put a socket into direct link mode.
+int32_t uCellSockDirectLinkStart(uDeviceHandle_t cellHandle,
+                                 int32_t sockHandle)
+{
+    int32_t negErrnoLocal = -U_SOCK_EINVAL;
+    uCellPrivateInstance_t *pInstance;
+    uAtClientHandle_t atHandle;
+    uCellSockSocket_t *pSocket;
+    uAtClientStream_t streamType = U_AT_CLIENT_STREAM_TYPE_MAX;
+    int32_t streamHandle;
+
+    // Find the instance
+    pInstance = pUCellPrivateGetInstance(cellHandle);
+    if (pInstance != NULL) {
+        atHandle = pInstance->atHandle;
+        // Find the entry
+        if (sockHandle >= 0) {
+            pSocket = pFindBySockHandle(sockHandle);
+            if (pSocket != NULL) {
+                negErrnoLocal = -U_SOCK_EALREADY;
+                if (!pSocket->directLink) {
+                    negErrnoLocal = -U_SOCK_EBUSY;
+                    if (!directLinkActive(atHandle)) {
+                        negErrnoLocal = -U_SOCK_EOPNOTSUPP;
+                        streamHandle = uAtClientStreamGet(atHandle, &streamType);
+                        if (streamType == U_AT_CLIENT_STREAM_TYPE_UART) {
+                            negErrnoLocal = -U_SOCK_EIO;
+                            uAtClientLock(atHandle);
+                            uAtClientTimeoutSet(atHandle,
+                                                U_CELL_SOCK_DIRECT_LINK_TIMEOUT_SECONDS * 1000);
+                            uAtClientCommandStart(atHandle, "AT+USODL=");
+                            uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
+                            uAtClientCommandStop(atHandle);
+                            if (uAtClientResponseStart(atHandle, "CONNECT") == 0) {
+                                // Consume the rest of the CONNECT line
+                                uAtClientReadString(atHandle, NULL, 32, false);
+                                // We're in: from here on everything from the
+                                // module is socket data, so switch off stop
+                                // tag detection and keep the AT client
+                                // locked, which stops it reading the stream
+                                // (hence no intercepts and no URCs) until
+                                // uCellSockDirectLinkStop() is called
+                                uAtClientIgnoreStopTag(atHandle);
+                                // Zero timeout so that directLinkRead()
+                                // may collect what the AT client already
+                                // has without blocking
+                                uAtClientTimeoutSet(atHandle, 0);
+                                pSocket->directLinkStreamHandle = streamHandle;
+                                pSocket->directLinkAtBuffered = true;
+                                pSocket->directLinkLastTxMs = uPortGetTickTimeMs();
+                                pSocket->directLink = true;
+                                negErrnoLocal = U_SOCK_ENONE;
+                            } else {
+                                uAtClientResponseStop(atHandle);
+                                uAtClientUnlock(atHandle);
+                                // See what the module's socket error
+                                // number has to say for debug purposes
+                                doUsoer(atHandle);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return negErrnoLocal;
+}
+
+// Take a socket out of direct link mode.
+int32_t uCellSockDirectLinkStop(uDeviceHandle_t cellHandle,
+                                int32_t sockHandle)
+{
+    int32_t negErrnoLocal = -U_SOCK_EINVAL;
+    uCellPrivateInstance_t *pInstance;
+    uAtClientHandle_t atHandle;
+    uCellSockSocket_t *pSocket;
+    int32_t silentMs;
+
+    // Find the instance
+    pInstance = pUCellPrivateGetInstance(cellHandle);
+    if (pInstance != NULL) {
+        atHandle = pInstance->atHandle;
+        // Find the entry
+        if (sockHandle >= 0) {
+            pSocket = pFindBySockHandle(sockHandle);
+            if (pSocket != NULL) {
+                negErrnoLocal = -U_SOCK_ENOTCONN;
+                if (pSocket->directLink) {
+                    negErrnoLocal = -U_SOCK_EIO;
+                    // The escape sequence must be preceded and
+                    // followed by the guard time of silence
+                    silentMs = uPortGetTickTimeMs() - pSocket->directLinkLastTxMs;
+                    if (silentMs < U_CELL_SOCK_DIRECT_LINK_GUARD_TIME_MS) {
+                        uPortTaskBlock(U_CELL_SOCK_DIRECT_LINK_GUARD_TIME_MS - silentMs);
+                    }
+                    uPortUartWrite(pSocket->directLinkStreamHandle, "+++", 3);
+                    uPortTaskBlock(U_CELL_SOCK_DIRECT_LINK_GUARD_TIME_MS);
+                    // Back to reading through the AT client: throw
+                    // away any socket data up to the DISCONNECT,
+                    // which not all modules send, hence the error
+                    // is cleared afterwards
+                    uAtClientClearError(atHandle);
+                    uAtClientTimeoutSet(atHandle,
+                                        U_CELL_SOCK_DIRECT_LINK_TIMEOUT_SECONDS * 1000);
+                    uAtClientResponseStart(atHandle, "DISCONNECT");
+                    uAtClientClearError(atHandle);
+                    uAtClientFlush(atHandle);
+                    // Check that the module is back in command mode
+                    uAtClientCommandStart(atHandle, "AT");
+                    uAtClientCommandStopReadResponse(atHandle);
+                    // The AT client was left locked by
+                    // uCellSockDirectLinkStart(): always unlock
+                    // it, whatever happened
+                    if (uAtClientUnlock(atHandle) == 0) {
+                        negErrnoLocal = U_SOCK_ENONE;
+                    }
+                    pSocket->directLink = false;
+                    pSocket->directLinkAtBuffered = false;
+                    pSocket->directLinkStreamHandle = -1;
+                }
+            }
+        }
+    }
+
+    return negErrnoLocal;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: ASYNC
  * -------------------------------------------------------------- */
@@ -1819,6 +3338,7 @@ void uCellSockRegisterCallbackData(uDeviceHandle_t cellHandle,
             if (pSocket != NULL) {
                 // Set the callback
                 pSocket->pDataCallback = pCallback;
+                pSocket->dataNotified = false;
             }
         }
     }
@@ -1934,7 +3454,7 @@ int32_t uCellSockGetHostByName(uDeviceHandle_t cellHandle,
         while ((atError < 0) &&
                (uPortGetTickTimeMs() - startTimeMs <
                 U_CELL_SOCK_DNS_SHOULD_RETRY_MS)) {
-            if (pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_SARA_R422) {
+            if (U_CELL_PRIVATE_MODULE_IS(pInstance->pModule, U_CELL_MODULE_TYPE_SARA_R422)) {
                 // SARA-R422 can get upset if UDNSRN is sent very quickly
                 // after a connection is made so we add a short delay here
                 while (uPortGetTickTimeMs() - pInstance->connectedAtMs <
@@ -2054,4 +3574,26 @@ int32_t uCellSockGetBytesReceived(uDeviceHandle_t cellHandle,
     return doUsoctl(cellHandle, sockHandle, 3);
 }
 
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS THAT ARE PRIVATE TO CELLULAR
+ * -------------------------------------------------------------- */
+
+// Top up the socket pool now that the radio is awake.
+void uCellSockPrivatePoolWake(const uCellPrivateInstance_t *pInstance)
+{
+    poolFillPost(pInstance);
+}
+
+// Free the socket pool.
+void uCellSockPrivatePoolRemove(uCellPrivateInstance_t *pInstance)
+{
+    uCellSockPool_t *pPool = (uCellSockPool_t *) pInstance->pSockPoolContext;
+
+    if (pPool != NULL) {
+        pInstance->pSockPoolContext = NULL;
+        uPortMutexDelete(pPool->mutex);
+        uPortFree(pPool);
+    }
+}
+
 // End of file
@@ -98,6 +98,10 @@
  */
 #define U_CELL_FILE_TEST_REENTRANT_STRING_SIZE 9
 
+/** The size of the buffer used by cellFileStreamRead().
+ */
+#define U_CELL_FILE_TEST_STREAM_BUFFER_SIZE 64
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -141,6 +145,47 @@ static bool checkTracker(bool *pTracker, size_t size)
     return isGood;
 }
 
+// Callback for uCellFileStreamWrite(), used by cellFileWrite():
+// supplies "DEADBEEF" repeated, at most two bytes at a time so that
+// the partial-supply case is exercised.
+static int32_t streamWriteCallback(uDeviceHandle_t cellHandle,
+                                   char *pBuffer, size_t size,
+                                   size_t offset, void *pParam)
+{
+    const char *pPattern = "DEADBEEF";
+
+    (void) cellHandle;
+    (void) pParam;
+
+    if (size > 2) {
+        size = 2;
+    }
+    for (size_t x = 0; x < size; x++) {
+        *(pBuffer + x) = *(pPattern + ((offset + x) % 8));
+    }
+
+    return (int32_t) size;
+}
+
+// Callback for uCellFileStreamRead(), used by cellFileStreamRead():
+// pParam points to a buffer of U_CELL_FILE_TEST_STREAM_BUFFER_SIZE
+// bytes, copy the data into it; the callback stops the read once the
+// buffer is full.
+static bool streamReadCallback(uDeviceHandle_t cellHandle,
+                               const char *pData, size_t size,
+                               size_t offset, void *pParam)
+{
+    char *pBuffer = (char *) pParam;
+
+    (void) cellHandle;
+
+    if (offset + size <= U_CELL_FILE_TEST_STREAM_BUFFER_SIZE) {
+        memcpy(pBuffer + offset, pData, size);
+    }
+
+    return (offset + size < U_CELL_FILE_TEST_STREAM_BUFFER_SIZE);
+}
+
 /* ----------------------------------------------------------------
 * PUBLIC FUNCTIONS
 * -------------------------------------------------------------- */
@@ -208,6 +253,16 @@ U_PORT_TEST_FUNCTION("[cellFile]", "cellFileWrite")
         }
     }
 
+    // Append the same again, this time pulled from a callback in
+    // small chunks
+    U_TEST_PRINT_LINE("streaming data into file...");
+    result = uCellFileStreamWrite(cellHandle, U_CELL_FILE_TEST_FILE_NAME,
+                                  length, streamWriteCallback, NULL, 3);
+    U_TEST_PRINT_LINE("number of bytes streamed into the file = %d.", result);
+    U_PORT_TEST_ASSERT(result == length);
+    U_PORT_TEST_ASSERT(uCellFileStreamWrite(cellHandle, U_CELL_FILE_TEST_FILE_NAME,
+                                            length, NULL, NULL, 0) < 0);
+
     // Do the standard postamble, leaving the module on for the next
     // test to speed things up
     uCellTestPrivatePostamble(&gHandles, false);
@@ -354,6 +409,65 @@ U_PORT_TEST_FUNCTION("[cellFile]", "cellFileBlockRead")
     U_PORT_TEST_ASSERT(heapUsed <= 0);
 }
 
+/** Test streaming a whole file.
+ */
+U_PORT_TEST_FUNCTION("[cellFile]", "cellFileStreamRead")
+{
+    int32_t heapUsed;
+    uDeviceHandle_t cellHandle;
+    int32_t size;
+    int32_t result;
+    char buffer[U_CELL_FILE_TEST_STREAM_BUFFER_SIZE];
+
+    // In case a previous test failed
+    uCellTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    // Do the standard preamble
+    U_PORT_TEST_ASSERT(uCellTestPrivatePreamble(U_CFG_TEST_CELL_MODULE_TYPE,
+                                                &gHandles, true) == 0);
+    cellHandle = gHandles.cellHandle;
+
+    // The file written by cellFileWrite is some number of "DEADBEEF"s
+    size = uCellFileSize(cellHandle, U_CELL_FILE_TEST_FILE_NAME);
+    U_TEST_PRINT_LINE("file is %d byte(s) long.", size);
+    U_PORT_TEST_ASSERT((size > 0) && (size < (int32_t) sizeof(buffer)));
+
+    // Stream it in chunks of an awkward size
+    U_TEST_PRINT_LINE("streaming data from file...");
+    memset(buffer, 0xaa, sizeof(buffer));
+    result = uCellFileStreamRead(cellHandle, U_CELL_FILE_TEST_FILE_NAME,
+                                 streamReadCallback, buffer, 5);
+    U_TEST_PRINT_LINE("number of bytes streamed = %d.", result);
+    U_PORT_TEST_ASSERT(result == size);
+    for (int32_t x = 0; x < size; x += 8) {
+        U_PORT_TEST_ASSERT(memcmp(buffer + x, "DEADBEEF", 8) == 0);
+    }
+    U_PORT_TEST_ASSERT(*(buffer + size) == (char) 0xaa);
+
+    // Check that the AT interface is still good afterwards
+    U_PORT_TEST_ASSERT(uCellFileSize(cellHandle, U_CELL_FILE_TEST_FILE_NAME) == size);
+
+    // Check for parameter errors
+    U_PORT_TEST_ASSERT(uCellFileStreamRead(cellHandle, U_CELL_FILE_TEST_FILE_NAME,
+                                           NULL, buffer, 0) < 0);
+    U_PORT_TEST_ASSERT(uCellFileStreamRead(cellHandle, NULL,
+                                           streamReadCallback, buffer, 0) < 0);
+
+    // Do the standard postamble, leaving the module on for the next
+    // test to speed things up
+    uCellTestPrivatePostamble(&gHandles, false);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
 /** Test reading whole file.
  */
 U_PORT_TEST_FUNCTION("[cellFile]", "cellFileRead")
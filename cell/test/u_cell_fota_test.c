@@ -119,6 +119,7 @@ U_PORT_TEST_FUNCTION("[cellFota]", "cellFotaVeryBasicIndeed")
     const uCellPrivateModule_t *pModule;
     int32_t heapUsed;
     int32_t heapFotaInitLoss = 0;
+    uCellFotaProgress_t progress;
     int32_t x;
 
     // In case a previous test failed
@@ -152,10 +153,22 @@ U_PORT_TEST_FUNCTION("[cellFota]", "cellFotaVeryBasicIndeed")
         heapFotaInitLoss -= uPortGetHeapFree();
         if (U_CELL_PRIVATE_HAS(pModule, U_CELL_PRIVATE_FEATURE_FOTA)) {
             U_PORT_TEST_ASSERT(x == 0);
+            // No download is going on so there should be no progress
+            U_PORT_TEST_ASSERT(uCellFotaGetProgress(cellHandle, 0, &progress) == 0);
+            U_PORT_TEST_ASSERT(progress.percentage == -1);
+            U_PORT_TEST_ASSERT(!progress.inProgress);
+            U_PORT_TEST_ASSERT(progress.numStarts == 0);
+            U_PORT_TEST_ASSERT(progress.startPercentage == -1);
+            U_PORT_TEST_ASSERT(progress.percentPerMinuteX100 == -1);
+            U_PORT_TEST_ASSERT(progress.bytesPerSecond == -1);
+            U_PORT_TEST_ASSERT(progress.etaSeconds == -1);
+            U_PORT_TEST_ASSERT(uCellFotaGetProgress(cellHandle, 0, NULL) < 0);
             x = uCellFotaSetStatusCallback(cellHandle, -1, NULL, NULL);
             U_PORT_TEST_ASSERT(x == 0);
         } else {
             U_PORT_TEST_ASSERT(x == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
+            U_PORT_TEST_ASSERT(uCellFotaGetProgress(cellHandle, 0,
+                                                    &progress) == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
         }
     } else {
         // The SARA-R410M and SARA-R412M modules we have under regression
@@ -115,6 +115,7 @@ U_PORT_TEST_FUNCTION("[cellGpio]", "cellGpioBasic")
     int32_t heapUsed;
     int32_t x;
     int32_t y;
+    uint64_t levelMask;
 
     // In case a previous test failed
     uCellTestPrivateCleanup(&gHandles);
@@ -146,6 +147,29 @@ U_PORT_TEST_FUNCTION("[cellGpio]", "cellGpioBasic")
     U_TEST_PRINT_LINE("GPIO ID %d is %d.", U_CFG_TEST_GPIO_NAME, x);
     U_PORT_TEST_ASSERT(x == 0);
 
+    // Do the same again with the multi-GPIO functions
+    U_TEST_PRINT_LINE("setting GPIO ID %d to 1 with uCellGpioSetMulti().",
+                      U_CFG_TEST_GPIO_NAME);
+    U_PORT_TEST_ASSERT(uCellGpioSetMulti(cellHandle, U_CELL_GPIO_MASK(U_CFG_TEST_GPIO_NAME),
+                                         U_CELL_GPIO_MASK(U_CFG_TEST_GPIO_NAME)) == 0);
+    x = uCellGpioGet(cellHandle, U_CFG_TEST_GPIO_NAME);
+    U_TEST_PRINT_LINE("GPIO ID %d is %d.", U_CFG_TEST_GPIO_NAME, x);
+    U_PORT_TEST_ASSERT(x == 1);
+    levelMask = 0;
+    U_PORT_TEST_ASSERT(uCellGpioGetMulti(cellHandle, U_CELL_GPIO_MASK(U_CFG_TEST_GPIO_NAME),
+                                         &levelMask) == 0);
+    U_PORT_TEST_ASSERT(levelMask == U_CELL_GPIO_MASK(U_CFG_TEST_GPIO_NAME));
+    U_PORT_TEST_ASSERT(uCellGpioSetMulti(cellHandle, U_CELL_GPIO_MASK(U_CFG_TEST_GPIO_NAME),
+                                         0) == 0);
+    levelMask = 0xFFFFFFFFFFFFFFFFULL;
+    U_PORT_TEST_ASSERT(uCellGpioGetMulti(cellHandle, U_CELL_GPIO_MASK(U_CFG_TEST_GPIO_NAME),
+                                         &levelMask) == 0);
+    U_PORT_TEST_ASSERT(levelMask == 0);
+    // An empty mask should do nothing, successfully
+    U_PORT_TEST_ASSERT(uCellGpioSetMulti(cellHandle, 0, 0) == 0);
+    U_PORT_TEST_ASSERT(uCellGpioGetMulti(cellHandle, 0, &levelMask) == 0);
+    U_PORT_TEST_ASSERT(levelMask == 0);
+
     // For toggling the CTS pin we need to know that it is not
     // already in use for flow control and this command is also not
     // supported on SARA-R4
@@ -99,6 +99,14 @@ static int64_t gStopTimeMs;
  */
 static uCellTestPrivate_t gHandles = U_CELL_TEST_PRIVATE_DEFAULTS;
 
+/** Storage for the radio parameter sampler.
+ */
+static uCellInfoRadioSampler_t gRadioSampler;
+
+/** Incremented by radioSamplerCallback().
+ */
+static volatile int32_t gRadioSamplerCallbackCount = 0;
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -117,6 +125,17 @@ static bool keepGoingCallback(uDeviceHandle_t unused)
     return keepGoing;
 }
 
+// Callback for the radio parameter sampler.
+static void radioSamplerCallback(uDeviceHandle_t cellHandle,
+                                 void *pCallbackParam)
+{
+    uDeviceHandle_t *pCellHandle = (uDeviceHandle_t *) pCallbackParam;
+
+    if ((pCellHandle != NULL) && (*pCellHandle == cellHandle)) {
+        gRadioSamplerCallbackCount++;
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -131,6 +150,7 @@ U_PORT_TEST_FUNCTION("[cellInfo]", "cellInfoImeiEtc")
 {
     uDeviceHandle_t cellHandle;
     char buffer[64];
+    char buffer2[64];
     int32_t bytesRead;
     int32_t heapUsed;
     bool isEnabled;
@@ -224,6 +244,24 @@ U_PORT_TEST_FUNCTION("[cellInfo]", "cellInfoImeiEtc")
                                             sizeof(buffer)) >= 0);
     U_PORT_TEST_ASSERT(strlen(buffer) <= U_CELL_INFO_ICCID_BUFFER_SIZE);
 
+    U_TEST_PRINT_LINE("checking that the cached values are returned...");
+    // The identity information is cached after the first read: the
+    // IMEI and the model string just read should come back the same
+    U_PORT_TEST_ASSERT(uCellInfoGetModelStr(cellHandle, buffer, sizeof(buffer)) > 0);
+    memset(buffer2, 0, sizeof(buffer2));
+    bytesRead = uCellInfoGetModelStr(cellHandle, buffer2, sizeof(buffer2));
+    U_PORT_TEST_ASSERT((bytesRead == strlen(buffer)) && (strcmp(buffer, buffer2) == 0));
+    // ...including the truncated case
+    memset(buffer2, 0, sizeof(buffer2));
+    bytesRead = uCellInfoGetModelStr(cellHandle, buffer2, 3);
+    U_PORT_TEST_ASSERT((bytesRead == 2) && (strlen(buffer2) == 2) &&
+                       (memcmp(buffer, buffer2, 2) == 0));
+    memset(buffer, 0, sizeof(buffer));
+    memset(buffer2, 0, sizeof(buffer2));
+    U_PORT_TEST_ASSERT(uCellInfoGetImei(cellHandle, buffer) >= 0);
+    U_PORT_TEST_ASSERT(uCellInfoGetImei(cellHandle, buffer2) >= 0);
+    U_PORT_TEST_ASSERT(memcmp(buffer, buffer2, sizeof(buffer)) == 0);
+
     U_TEST_PRINT_LINE("checking flow control lines...");
     isEnabled = uCellInfoIsRtsFlowControlEnabled(cellHandle);
 #if U_CFG_APP_PIN_CELL_RTS_GET >= 0
@@ -259,6 +297,8 @@ U_PORT_TEST_FUNCTION("[cellInfo]", "cellInfoRadioParameters")
     int32_t snrDb;
     size_t count;
     int32_t heapUsed;
+    uCellInfoRadioSample_t sample;
+    uint32_t sampleCount;
 
     // In case a previous test failed
     uCellTestPrivateCleanup(&gHandles);
@@ -327,6 +367,48 @@ U_PORT_TEST_FUNCTION("[cellInfo]", "cellInfoRadioParameters")
         U_PORT_TEST_ASSERT((x == 0) || (x == U_CELL_ERROR_VALUE_OUT_OF_RANGE));
     }
 
+    U_TEST_PRINT_LINE("testing the background radio parameter sampler...");
+    U_PORT_TEST_ASSERT(uCellInfoRadioSamplerStart(cellHandle, NULL,
+                                                  U_CELL_INFO_RADIO_SAMPLER_PERIOD_MIN_MS,
+                                                  NULL, NULL) < 0);
+    U_PORT_TEST_ASSERT(uCellInfoRadioSamplerStart(cellHandle, &gRadioSampler,
+                                                  U_CELL_INFO_RADIO_SAMPLER_PERIOD_MIN_MS - 1,
+                                                  NULL, NULL) < 0);
+    gRadioSamplerCallbackCount = 0;
+    U_PORT_TEST_ASSERT(uCellInfoRadioSamplerStart(cellHandle, &gRadioSampler,
+                                                  U_CELL_INFO_RADIO_SAMPLER_PERIOD_MIN_MS,
+                                                  radioSamplerCallback, &cellHandle) == 0);
+    // Only one at a time
+    U_PORT_TEST_ASSERT(uCellInfoRadioSamplerStart(cellHandle, &gRadioSampler,
+                                                  U_CELL_INFO_RADIO_SAMPLER_PERIOD_MIN_MS,
+                                                  NULL, NULL) < 0);
+    // The foreground API must remain usable while the sampler is running
+    for (count = 0; count < 5; count++) {
+        U_PORT_TEST_ASSERT(uCellNetIsRegistered(cellHandle));
+        uPortTaskBlock(1000);
+    }
+    for (count = 20; (gRadioSamplerCallbackCount < 2) && (count > 0); count--) {
+        uPortTaskBlock(1000);
+    }
+    U_TEST_PRINT_LINE("%d sample(s) taken.", gRadioSamplerCallbackCount);
+    U_PORT_TEST_ASSERT(gRadioSamplerCallbackCount >= 2);
+    U_PORT_TEST_ASSERT(uCellInfoRadioSamplerGet(&gRadioSampler, &sample) == 0);
+    U_TEST_PRINT_LINE("latest sample: error %d, RSSI %d dBm, RSRP %d dBm,"
+                      " RSRQ %d dB, cell ID %d, EARFCN %d.", sample.errorCode,
+                      sample.rssiDbm, sample.rsrpDbm, sample.rsrqDb,
+                      sample.cellId, sample.earfcn);
+    U_PORT_TEST_ASSERT(sample.count >= 2);
+    if (sample.errorCode == 0) {
+        U_PORT_TEST_ASSERT(uCellInfoGetEarfcn(cellHandle) == sample.earfcn);
+        U_PORT_TEST_ASSERT(uCellInfoGetCellId(cellHandle) == sample.cellId);
+    }
+    uCellInfoRadioSamplerStop(cellHandle);
+    sampleCount = sample.count;
+    U_PORT_TEST_ASSERT(uCellInfoRadioSamplerGet(&gRadioSampler, &sample) == 0);
+    U_PORT_TEST_ASSERT(sample.count >= sampleCount);
+    // Should be able to call stop again harmlessly
+    uCellInfoRadioSamplerStop(cellHandle);
+
     // Disconnect
     U_PORT_TEST_ASSERT(uCellNetDisconnect(cellHandle, NULL) == 0);
 
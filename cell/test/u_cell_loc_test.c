@@ -304,6 +304,19 @@ U_PORT_TEST_FUNCTION("[cellLoc]", "cellLocCfg")
     uCellLocSetGnssEnable(cellHandle, (bool) y);
     U_TEST_PRINT_LINE("GNSS returned to %s.", y ? "enabled" : "disabled");
 
+    // Check the cache maximum age
+    y = uCellLocGetCacheMaxAge(cellHandle);
+    U_TEST_PRINT_LINE("cache maximum age is %d second(s).", y);
+    U_PORT_TEST_ASSERT(y == U_CELL_LOC_CACHE_MAX_AGE_DEFAULT_SECONDS);
+    z = y + 1;
+    uCellLocSetCacheMaxAge(cellHandle, z);
+    z = uCellLocGetCacheMaxAge(cellHandle);
+    U_TEST_PRINT_LINE("cache maximum age is now %d second(s).", z);
+    U_PORT_TEST_ASSERT(z == y + 1);
+    // Put it back as it was
+    uCellLocSetCacheMaxAge(cellHandle, y);
+    U_TEST_PRINT_LINE("cache maximum age returned to %d second(s).", y);
+
 #if (U_CFG_APP_CELL_PIN_GNSS_POWER >= 0)
     if (!uCellLocGnssInsideCell(cellHandle)) {
         U_PORT_TEST_ASSERT(uCellLocSetPinGnssPwr(cellHandle,
@@ -367,6 +380,7 @@ U_PORT_TEST_FUNCTION("[cellLoc]", "cellLocLoc")
     int32_t svs = INT_MIN;
     int64_t timeUtc = LONG_MIN;
     int32_t x;
+    int32_t y;
     size_t badStatusCount;
     char prefix[2];
     int32_t whole[2];
@@ -477,7 +491,7 @@ U_PORT_TEST_FUNCTION("[cellLoc]", "cellLocLoc")
     // Try this a few times as the Cell Locate AT command can sometimes
     // (e.g. on SARA-R412M-02B) return "generic error" if asked to establish
     // location again quickly after returning an answer
-    for (int32_t y = 3; (y > 0) && (gErrorCode != 0); y--) {
+    for (y = 3; (y > 0) && (gErrorCode != 0); y--) {
         gErrorCode = 0xFFFFFFFF;
         gStopTimeMs = startTime + U_CELL_LOC_TEST_TIMEOUT_SECONDS * 1000;
         startTime = uPortGetTickTimeMs();
@@ -545,6 +559,45 @@ U_PORT_TEST_FUNCTION("[cellLoc]", "cellLocLoc")
     U_PORT_TEST_ASSERT(gErrorCode == 0);
     U_PORT_TEST_ASSERT(gTimeUtc > U_CELL_LOC_TEST_MIN_UTC_TIME);
 
+    // The last fix should always be available
+    x = uCellLocGetLast(cellHandle, NULL, NULL, NULL, NULL, NULL, NULL,
+                        &timeUtc, &y);
+    U_TEST_PRINT_LINE("last fix was %d second(s) ago.", y);
+    U_PORT_TEST_ASSERT(x == 0);
+    U_PORT_TEST_ASSERT(timeUtc == gTimeUtc);
+    U_PORT_TEST_ASSERT(y >= 0);
+
+    // Switch the cache on, accepting any accuracy, and get a fix
+    // which will be cached against the serving cell; a second fix
+    // should then, for modules that report the serving cell, come
+    // straight from the cache
+    x = uCellLocGetDesiredAccuracy(cellHandle);
+    uCellLocSetDesiredAccuracy(cellHandle, INT_MAX);
+    uCellLocSetCacheMaxAge(cellHandle, U_CELL_LOC_TEST_TIMEOUT_SECONDS);
+    U_TEST_PRINT_LINE("location establishment with cache.");
+    gStopTimeMs = uPortGetTickTimeMs() + U_CELL_LOC_TEST_TIMEOUT_SECONDS * 1000;
+    U_PORT_TEST_ASSERT(uCellLocGet(cellHandle, &latitudeX1e7, &longitudeX1e7,
+                                   NULL, NULL, NULL, NULL, &timeUtc,
+                                   keepGoingCallback) == 0);
+    startTime = uPortGetTickTimeMs();
+    gStopTimeMs = startTime + U_CELL_LOC_TEST_TIMEOUT_SECONDS * 1000;
+    U_PORT_TEST_ASSERT(uCellLocGet(cellHandle, &(whole[0]), &(whole[1]),
+                                   NULL, NULL, NULL, NULL, &gTimeUtc,
+                                   keepGoingCallback) == 0);
+    y = (int32_t) (uPortGetTickTimeMs() - startTime);
+    U_TEST_PRINT_LINE("second location establishment took %d ms.", y);
+    if (gTimeUtc == timeUtc) {
+        U_TEST_PRINT_LINE("second location came from the cache.");
+        U_PORT_TEST_ASSERT(whole[0] == latitudeX1e7);
+        U_PORT_TEST_ASSERT(whole[1] == longitudeX1e7);
+    }
+    if (U_CFG_TEST_CELL_MODULE_TYPE == U_CELL_MODULE_TYPE_SARA_R5) {
+        // SARA-R5 always reports the serving cell
+        U_PORT_TEST_ASSERT(gTimeUtc == timeUtc);
+    }
+    uCellLocSetCacheMaxAge(cellHandle, U_CELL_LOC_CACHE_MAX_AGE_DEFAULT_SECONDS);
+    uCellLocSetDesiredAccuracy(cellHandle, x);
+
 #if U_CFG_APP_PIN_CELL_PWR_ON < 0
     // The standard postamble would normally power the module off
     // but if there is no power-on pin it won't (for obvious reasons)
@@ -41,7 +41,8 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // memset(), strncpy()
+#include "stdio.h"     // snprintf()
+#include "string.h"    // memset(), strncpy(), strcmp(), memcmp()
 
 #include "u_cfg_sw.h"
 #include "u_cfg_os_platform_specific.h"
@@ -50,6 +51,9 @@
 
 #include "u_error_common.h"
 
+#include "u_port_clib_platform_specific.h" /* Integer stdio, must be included
+                                              before the other port files if
+                                              any print or scan function is used. */
 #include "u_port.h"
 #include "u_port_heap.h"
 #include "u_port_debug.h"
@@ -57,6 +61,9 @@
 
 #include "u_at_client.h"
 
+#include "u_mqtt_common.h"
+#include "u_mqtt_client.h" // U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS
+
 #include "u_cell_module_type.h"
 #include "u_cell.h"
 #include "u_cell_file.h"
@@ -116,6 +123,14 @@
 # define U_CELL_MQTT_TEST_MQTTSN_SERVER_IP_ADDRESS_SECURED  ubxlib.redirectme.net:8883
 #endif
 
+#ifndef U_CELL_MQTT_TEST_PUBLISH_ASYNC_TIMEOUT_SECONDS
+/** How long to wait for all of the asynchronous publishes
+ * to complete.
+ */
+# define U_CELL_MQTT_TEST_PUBLISH_ASYNC_TIMEOUT_SECONDS  (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * \
+                                                          U_CELL_MQTT_PUBLISH_ASYNC_QUEUE_LENGTH)
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -132,6 +147,28 @@ static int64_t gStopTimeMs;
  */
 static uCellTestPrivate_t gHandles = U_CELL_TEST_PRIVATE_DEFAULTS;
 
+/** The number of times publishAsyncCallback() has been called.
+ */
+static volatile int32_t gPublishAsyncCount = 0;
+
+/** The message ID that publishAsyncCallback() expects next.
+ */
+static volatile int32_t gPublishAsyncNextMsgId = 0;
+
+/** Any error seen by publishAsyncCallback(), zero if there
+ * was none.
+ */
+static volatile int32_t gPublishAsyncErrorCode = 0;
+
+/** The number of times autoFetchCallback() has been called.
+ */
+static volatile int32_t gAutoFetchCount = 0;
+
+/** Any error seen by autoFetchCallback(), zero if there
+ * was none.
+ */
+static volatile int32_t gAutoFetchErrorCode = 0;
+
 #ifdef U_CELL_MQTT_TEST_ENABLE_WILL_TEST
 /** A string of all possible characters, including strings
  * that might appear as terminators in an AT interface, that
@@ -167,6 +204,43 @@ static bool keepGoingCallback(uDeviceHandle_t unused)
     return keepGoing;
 }
 
+// Callback for uCellMqttPublishAsync().
+static void publishAsyncCallback(uDeviceHandle_t cellHandle,
+                                 int32_t msgId, int32_t errorCode,
+                                 void *pCallbackParam)
+{
+    if (cellHandle != *((uDeviceHandle_t *) pCallbackParam)) {
+        gPublishAsyncErrorCode = -1;
+    } else if (msgId != gPublishAsyncNextMsgId) {
+        // Callbacks must arrive in order
+        gPublishAsyncErrorCode = -2;
+    } else if (errorCode != 0) {
+        gPublishAsyncErrorCode = errorCode;
+    }
+    gPublishAsyncNextMsgId = msgId + 1;
+    gPublishAsyncCount++;
+}
+
+// Callback for uCellMqttSetAutoFetch().
+static void autoFetchCallback(uDeviceHandle_t cellHandle,
+                              const char *pTopicNameStr,
+                              const char *pMessage,
+                              size_t messageSizeBytes,
+                              uCellMqttQos_t qos,
+                              void *pCallbackParam)
+{
+    (void) qos;
+
+    if (cellHandle != *((uDeviceHandle_t *) pCallbackParam)) {
+        gAutoFetchErrorCode = -1;
+    } else if (strcmp(pTopicNameStr, "ubx_test/cellMqttAutoFetch") != 0) {
+        gAutoFetchErrorCode = -2;
+    } else if ((messageSizeBytes != 5) || (memcmp(pMessage, "fetch", 5) != 0)) {
+        gAutoFetchErrorCode = -3;
+    }
+    gAutoFetchCount++;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -187,6 +261,7 @@ U_PORT_TEST_FUNCTION("[cellMqtt]", "cellMqtt")
     char buffer2[32];
     int32_t x;
     int32_t y;
+    int32_t startTimeMs;
     size_t z;
     const char *pServerAddress = U_PORT_STRINGIFY_QUOTED(U_CELL_MQTT_TEST_MQTT_SERVER_IP_ADDRESS);
 #ifdef U_CELL_MQTT_TEST_ENABLE_WILL_TEST
@@ -408,6 +483,117 @@ U_PORT_TEST_FUNCTION("[cellMqtt]", "cellMqtt")
         U_TEST_PRINT_LINE("connecting to broker \"%s\"...", pServerAddress);
         U_PORT_TEST_ASSERT(uCellMqttConnect(cellHandle) == 0);
 
+        // While connected, fill the asynchronous publish queue,
+        // check for back-pressure and then wait for all of the
+        // publishes to complete
+        U_TEST_PRINT_LINE("testing asynchronous publish...");
+        gPublishAsyncCount = 0;
+        gPublishAsyncNextMsgId = 0;
+        gPublishAsyncErrorCode = 0;
+        U_PORT_TEST_ASSERT(uCellMqttPublishAsyncGetFree(cellHandle) ==
+                           U_CELL_MQTT_PUBLISH_ASYNC_QUEUE_LENGTH);
+        x = 0;
+        do {
+            snprintf(buffer1, sizeof(buffer1), "async %d", (int) x);
+            y = uCellMqttPublishAsync(cellHandle, "ubx_test/cellMqttAsync",
+                                      buffer1, strlen(buffer1),
+                                      U_CELL_MQTT_QOS_AT_LEAST_ONCE, false,
+                                      publishAsyncCallback, &cellHandle);
+            if (y >= 0) {
+                U_PORT_TEST_ASSERT(y == x);
+                x++;
+            }
+        } while ((y >= 0) && (x <= U_CELL_MQTT_PUBLISH_ASYNC_QUEUE_LENGTH));
+        // The first publish may already have completed, hence
+        // the queue may have taken one more than its length
+        U_TEST_PRINT_LINE("%d message(s) queued before back-pressure.", x);
+        U_PORT_TEST_ASSERT(y == (int32_t) U_ERROR_COMMON_TEMPORARY_FAILURE);
+        U_PORT_TEST_ASSERT(x >= U_CELL_MQTT_PUBLISH_ASYNC_QUEUE_LENGTH);
+        gStopTimeMs = uPortGetTickTimeMs() +
+                      (U_CELL_MQTT_TEST_PUBLISH_ASYNC_TIMEOUT_SECONDS * 1000);
+        while ((gPublishAsyncCount < x) && (uPortGetTickTimeMs() < gStopTimeMs)) {
+            uPortTaskBlock(100);
+        }
+        U_TEST_PRINT_LINE("%d asynchronous publish(es) completed, error code %d.",
+                          gPublishAsyncCount, gPublishAsyncErrorCode);
+        U_PORT_TEST_ASSERT(gPublishAsyncCount == x);
+        U_PORT_TEST_ASSERT(gPublishAsyncErrorCode == 0);
+        U_PORT_TEST_ASSERT(uCellMqttPublishAsyncGetFree(cellHandle) ==
+                           U_CELL_MQTT_PUBLISH_ASYNC_QUEUE_LENGTH);
+
+        // Do it again with a publish window, where supported
+        U_PORT_TEST_ASSERT(uCellMqttGetPublishWindow(cellHandle) ==
+                           U_CELL_MQTT_PUBLISH_WINDOW_DEFAULT);
+        U_PORT_TEST_ASSERT(uCellMqttSetPublishWindow(cellHandle, 0) < 0);
+        U_PORT_TEST_ASSERT(uCellMqttSetPublishWindow(cellHandle,
+                                                     U_CELL_MQTT_PUBLISH_WINDOW_MAX_NUM + 1) < 0);
+        if (!U_CELL_PRIVATE_HAS(pModule, U_CELL_PRIVATE_FEATURE_MQTT_SARA_R4_OLD_SYNTAX)) {
+            U_TEST_PRINT_LINE("testing asynchronous publish with a window of %d...",
+                              U_CELL_MQTT_PUBLISH_WINDOW_MAX_NUM);
+            U_PORT_TEST_ASSERT(uCellMqttSetPublishWindow(cellHandle,
+                                                         U_CELL_MQTT_PUBLISH_WINDOW_MAX_NUM) == 0);
+            U_PORT_TEST_ASSERT(uCellMqttGetPublishWindow(cellHandle) ==
+                               U_CELL_MQTT_PUBLISH_WINDOW_MAX_NUM);
+            gPublishAsyncCount = 0;
+            gPublishAsyncErrorCode = 0;
+            startTimeMs = uPortGetTickTimeMs();
+            for (x = 0; x < U_CELL_MQTT_PUBLISH_ASYNC_QUEUE_LENGTH; x++) {
+                snprintf(buffer1, sizeof(buffer1), "window %d", (int) x);
+                U_PORT_TEST_ASSERT(uCellMqttPublishAsync(cellHandle, "ubx_test/cellMqttAsync",
+                                                         buffer1, strlen(buffer1),
+                                                         U_CELL_MQTT_QOS_AT_LEAST_ONCE, false,
+                                                         publishAsyncCallback, &cellHandle) >= 0);
+            }
+            gStopTimeMs = uPortGetTickTimeMs() +
+                          (U_CELL_MQTT_TEST_PUBLISH_ASYNC_TIMEOUT_SECONDS * 1000);
+            while ((gPublishAsyncCount < x) && (uPortGetTickTimeMs() < gStopTimeMs)) {
+                uPortTaskBlock(100);
+            }
+            U_TEST_PRINT_LINE("%d windowed publish(es) completed in %d ms, error code %d.",
+                              gPublishAsyncCount, uPortGetTickTimeMs() - startTimeMs,
+                              gPublishAsyncErrorCode);
+            U_PORT_TEST_ASSERT(gPublishAsyncCount == x);
+            U_PORT_TEST_ASSERT(gPublishAsyncErrorCode == 0);
+            U_PORT_TEST_ASSERT(uCellMqttSetPublishWindow(cellHandle, 1) == 0);
+        } else {
+            U_PORT_TEST_ASSERT(uCellMqttSetPublishWindow(cellHandle, 2) < 0);
+        }
+
+        // Subscribe to a topic with auto-fetch on and a ring smaller
+        // than the number of messages, then publish to that topic
+        U_PORT_TEST_ASSERT(uCellMqttSetAutoFetch(cellHandle, 1, NULL, NULL) < 0);
+        U_PORT_TEST_ASSERT(uCellMqttSetAutoFetch(cellHandle, U_CELL_MQTT_AUTO_FETCH_MAX_NUM + 1,
+                                                 autoFetchCallback, &cellHandle) < 0);
+        if (!U_CELL_PRIVATE_HAS(pModule, U_CELL_PRIVATE_FEATURE_MQTT_SARA_R4_OLD_SYNTAX)) {
+            U_TEST_PRINT_LINE("testing auto-fetch...");
+            gAutoFetchCount = 0;
+            gAutoFetchErrorCode = 0;
+            U_PORT_TEST_ASSERT(uCellMqttSetAutoFetch(cellHandle, 2,
+                                                     autoFetchCallback, &cellHandle) == 0);
+            U_PORT_TEST_ASSERT(uCellMqttSubscribe(cellHandle, "ubx_test/cellMqttAutoFetch",
+                                                  U_CELL_MQTT_QOS_AT_LEAST_ONCE) >= 0);
+            for (x = 0; x < 3; x++) {
+                U_PORT_TEST_ASSERT(uCellMqttPublish(cellHandle, "ubx_test/cellMqttAutoFetch",
+                                                    "fetch", 5, U_CELL_MQTT_QOS_AT_LEAST_ONCE,
+                                                    false) == 0);
+            }
+            gStopTimeMs = uPortGetTickTimeMs() +
+                          (U_CELL_MQTT_TEST_PUBLISH_ASYNC_TIMEOUT_SECONDS * 1000);
+            while ((gAutoFetchCount < x) && (uPortGetTickTimeMs() < gStopTimeMs)) {
+                uPortTaskBlock(100);
+            }
+            U_TEST_PRINT_LINE("%d message(s) auto-fetched, error code %d.",
+                              gAutoFetchCount, gAutoFetchErrorCode);
+            U_PORT_TEST_ASSERT(gAutoFetchCount == x);
+            U_PORT_TEST_ASSERT(gAutoFetchErrorCode == 0);
+            U_PORT_TEST_ASSERT(uCellMqttGetUnread(cellHandle) == 0);
+            U_PORT_TEST_ASSERT(uCellMqttSetAutoFetch(cellHandle, 0, NULL, NULL) == 0);
+            U_PORT_TEST_ASSERT(uCellMqttUnsubscribe(cellHandle, "ubx_test/cellMqttAutoFetch") == 0);
+        } else {
+            U_PORT_TEST_ASSERT(uCellMqttSetAutoFetch(cellHandle, 1,
+                                                     autoFetchCallback, &cellHandle) < 0);
+        }
+
         if (U_CELL_PRIVATE_HAS(pModule, U_CELL_PRIVATE_FEATURE_MQTT_KEEP_ALIVE)) {
             // Try to set keep-alive on
             U_TEST_PRINT_LINE("trying to set keep-alive on (should fail)...");
@@ -0,0 +1,232 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the cellular 27.010 multiplexer API: these should
+ * pass on all platforms that have a cellular module connected to them
+ * over a UART.  They are only compiled if U_CFG_TEST_CELL_MODULE_TYPE
+ * is defined.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_TEST_CELL_MODULE_TYPE
+
+# ifdef U_CFG_OVERRIDE
+#  include "u_cfg_override.h" // For a customer's configuration override
+# endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"   // Required by u_cell_private.h
+#include "u_port_uart.h"
+
+#include "u_at_client.h"
+
+#include "u_cell_module_type.h"
+#include "u_cell.h"
+#include "u_cell_file.h"
+#include "u_cell_net.h"     // Required by u_cell_private.h
+#include "u_cell_private.h" // So that we can get at some innards
+#include "u_cell_pwr.h"
+#include "u_cell_info.h"
+#include "u_cell_mux.h"
+
+#include "u_cell_test_cfg.h"
+#include "u_cell_test_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_CELL_MUX_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_CELL_MUX_TEST_CHANNEL
+/** The additional channel to open, which must be an AT channel
+ * of the module under test.
+ */
+# define U_CELL_MUX_TEST_CHANNEL 2
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Handles.
+ */
+static uCellTestPrivate_t gHandles = U_CELL_TEST_PRIVATE_DEFAULTS;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Check that AT commands work, whatever is underneath.
+static void checkImei(uDeviceHandle_t cellHandle)
+{
+    char buffer[U_CELL_INFO_IMEI_SIZE + 1];
+
+    memset(buffer, 0, sizeof(buffer));
+    U_PORT_TEST_ASSERT(uCellInfoGetImei(cellHandle, buffer) >= 0);
+    for (size_t x = 0; x < U_CELL_INFO_IMEI_SIZE; x++) {
+        U_PORT_TEST_ASSERT((buffer[x] >= '0') && (buffer[x] <= '9'));
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Test enabling the multiplexer, running AT commands over it on
+ * the AT channel and on a second channel, then disabling it again.
+ *
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the
+ * U_PORT_TEST_FUNCTION() macro.
+ */
+U_PORT_TEST_FUNCTION("[cellMux]", "cellMuxBasic")
+{
+    uDeviceHandle_t cellHandle;
+    uAtClientHandle_t atHandle;
+    int32_t streamHandle;
+    int32_t heapUsed;
+    bool uartSleepWasEnabled = false;
+
+    // In case a previous test failed
+    uCellTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    // Do the standard preamble
+    U_PORT_TEST_ASSERT(uCellTestPrivatePreamble(U_CFG_TEST_CELL_MODULE_TYPE,
+                                                &gHandles, true) == 0);
+    cellHandle = gHandles.cellHandle;
+
+    // UART power saving gets in the way of the multiplexer
+    if (uCellPwrUartSleepIsEnabled(cellHandle)) {
+        U_PORT_TEST_ASSERT(uCellPwrDisableUartSleep(cellHandle) == 0);
+        uartSleepWasEnabled = true;
+    }
+
+    U_PORT_TEST_ASSERT(!uCellMuxIsEnabled(cellHandle));
+    U_TEST_PRINT_LINE("enabling the multiplexer...");
+    U_PORT_TEST_ASSERT(uCellMuxEnable(cellHandle) == 0);
+    U_PORT_TEST_ASSERT(uCellMuxIsEnabled(cellHandle));
+    // Enabling again should do nothing
+    U_PORT_TEST_ASSERT(uCellMuxEnable(cellHandle) == 0);
+
+    U_TEST_PRINT_LINE("AT commands on the AT channel...");
+    checkImei(cellHandle);
+
+    U_TEST_PRINT_LINE("opening channel %d...", U_CELL_MUX_TEST_CHANNEL);
+    U_PORT_TEST_ASSERT(uCellMuxChannelOpen(cellHandle, U_CELL_MUX_CHANNEL_ID_AT) < 0);
+    streamHandle = uCellMuxChannelOpen(cellHandle, U_CELL_MUX_TEST_CHANNEL);
+    U_PORT_TEST_ASSERT(streamHandle >= 0);
+    // Can't disable the multiplexer with a channel open
+    U_PORT_TEST_ASSERT(uCellMuxDisable(cellHandle) < 0);
+    atHandle = uAtClientAdd(streamHandle, U_AT_CLIENT_STREAM_TYPE_CMUX,
+                            NULL, U_CELL_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atHandle != NULL);
+    uAtClientLock(atHandle);
+    uAtClientCommandStart(atHandle, "AT");
+    uAtClientCommandStopReadResponse(atHandle);
+    U_PORT_TEST_ASSERT(uAtClientUnlock(atHandle) == 0);
+    // And the AT channel should still work at the same time
+    checkImei(cellHandle);
+    uAtClientRemove(atHandle);
+    U_PORT_TEST_ASSERT(uCellMuxChannelClose(cellHandle, streamHandle) == 0);
+
+    U_TEST_PRINT_LINE("disabling the multiplexer...");
+    U_PORT_TEST_ASSERT(uCellMuxDisable(cellHandle) == 0);
+    U_PORT_TEST_ASSERT(!uCellMuxIsEnabled(cellHandle));
+    // AT commands should now work over the UART once more
+    checkImei(cellHandle);
+
+    if (uartSleepWasEnabled) {
+        U_PORT_TEST_ASSERT(uCellPwrEnableUartSleep(cellHandle) == 0);
+    }
+
+    // Do the standard postamble, leaving the module on for the next
+    // test to speed things up
+    uCellTestPrivatePostamble(&gHandles, false);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[cellMux]", "cellMuxCleanUp")
+{
+    int32_t x;
+
+    uCellTestPrivateCleanup(&gHandles);
+
+    x = uPortTaskStackMinFree(NULL);
+    if (x != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        U_TEST_PRINT_LINE("main task stack had a minimum of %d"
+                          " byte(s) free at the end of these tests.", x);
+        U_PORT_TEST_ASSERT(x >= U_CFG_TEST_OS_MAIN_TASK_MIN_FREE_STACK_BYTES);
+    }
+
+    uPortDeinit();
+
+    x = uPortGetHeapMinFree();
+    if (x >= 0) {
+        U_TEST_PRINT_LINE("heap had a minimum of %d byte(s) free at the"
+                          " end of these tests.", x);
+        U_PORT_TEST_ASSERT(x >= U_CFG_TEST_HEAP_MIN_FREE_BYTES);
+    }
+}
+
+#endif // #ifdef U_CFG_TEST_CELL_MODULE_TYPE
+
+// End of file
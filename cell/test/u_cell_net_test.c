@@ -64,6 +64,7 @@
 #include "u_cell_net.h"     // Required by u_cell_private.h
 #include "u_cell_private.h" // So that we can get at some innards
 #include "u_cell_net.h"
+#include "u_cell_apn_db.h"  // So that we can check the APN database
 
 #include "u_cell_test_cfg.h"
 #include "u_cell_test_private.h"
@@ -113,6 +114,14 @@ static bool gHasBeenConnected = false;
  */
 static int32_t gCallbackErrorCode = 0;
 
+/** Storage for the data counter sampler.
+ */
+static uCellNetDataCounterSampler_t gDataCounterSampler;
+
+/** Incremented by dataCounterSamplerCallback().
+ */
+static volatile int32_t gDataCounterSamplerCallbackCount = 0;
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -133,6 +142,30 @@ static bool keepGoingCallback(uDeviceHandle_t cellHandle)
     return keepGoing;
 }
 
+// Callback for a streamed network scan: counts the networks
+// it is given in the int32_t pointed to by pCallbackParam and
+// asks to stop after the first one.
+static bool scanCallback(uDeviceHandle_t cellHandle,
+                         const char *pName, const char *pMccMnc,
+                         uCellNetRat_t rat, void *pCallbackParam)
+{
+    // Note: not using asserts here as, when they go
+    // off, the seem to cause stack overruns
+    if (cellHandle != gHandles.cellHandle) {
+        gCallbackErrorCode = 20;
+    }
+    if ((pName == NULL) || (pMccMnc == NULL) || (strlen(pMccMnc) == 0)) {
+        gCallbackErrorCode = 21;
+    }
+    if ((rat <= U_CELL_NET_RAT_UNKNOWN_OR_NOT_USED) ||
+        (rat >= U_CELL_NET_RAT_MAX_NUM)) {
+        gCallbackErrorCode = 22;
+    }
+    (*((int32_t *) pCallbackParam))++;
+
+    return false;
+}
+
 // Callback for registration status.
 static void registerCallback(uCellNetRegDomain_t domain,
                              uCellNetStatus_t status,
@@ -163,6 +196,17 @@ static void registerCallback(uCellNetRegDomain_t domain,
     }
 }
 
+// Callback for the data counter sampler.
+static void dataCounterSamplerCallback(uDeviceHandle_t cellHandle,
+                                       void *pCallbackParam)
+{
+    (void) pCallbackParam;
+
+    if (cellHandle == gHandles.cellHandle) {
+        gDataCounterSamplerCallbackCount++;
+    }
+}
+
 // Callback for base station connection status.
 static void connectCallback(bool isConnected, void *pParameter)
 {
@@ -205,6 +249,7 @@ U_PORT_TEST_FUNCTION("[cellNet]", "cellNetConnectDisconnectPlus")
     char parameter1[5]; // enough room for "Boo!"
     char parameter2[5]; // enough room for "Bah!"
     int32_t heapUsed;
+    uCellNetDataCounterSample_t dataCounterSample;
 
     strncpy(parameter1, "Boo!", sizeof(parameter1));
     strncpy(parameter2, "Bah!", sizeof(parameter2));
@@ -286,6 +331,10 @@ U_PORT_TEST_FUNCTION("[cellNet]", "cellNetConnectDisconnectPlus")
 #endif
                         keepGoingCallback);
     U_PORT_TEST_ASSERT (x == 0);
+    x = uCellNetGetLastConnectPath(cellHandle);
+    U_TEST_PRINT_LINE("connect path was %d.", x);
+    U_PORT_TEST_ASSERT((x > (int32_t) U_CELL_NET_CONNECT_PATH_NONE) &&
+                       (x < (int32_t) U_CELL_NET_CONNECT_PATH_MAX_NUM));
 
     // Check that we're registered
     U_PORT_TEST_ASSERT(uCellNetIsRegistered(cellHandle));
@@ -370,6 +419,53 @@ U_PORT_TEST_FUNCTION("[cellNet]", "cellNetConnectDisconnectPlus")
     U_PORT_TEST_ASSERT(x > 0);
     U_PORT_TEST_ASSERT(strlen(buffer) == x);
 
+    // Check the background data counter sampler
+    U_TEST_PRINT_LINE("testing the background data counter sampler...");
+    U_PORT_TEST_ASSERT(uCellNetDataCounterSamplerStart(cellHandle, &gDataCounterSampler,
+                                                       U_CELL_NET_DATA_COUNTER_SAMPLER_PERIOD_MIN_MS - 1,
+                                                       0, NULL, NULL) < 0);
+    gDataCounterSamplerCallbackCount = 0;
+    x = uCellNetDataCounterSamplerStart(cellHandle, &gDataCounterSampler,
+                                        U_CELL_NET_DATA_COUNTER_SAMPLER_PERIOD_MIN_MS,
+                                        0, dataCounterSamplerCallback, NULL);
+    if (U_CELL_PRIVATE_HAS(pModule, U_CELL_PRIVATE_FEATURE_DATA_COUNTERS)) {
+        U_PORT_TEST_ASSERT(x == 0);
+        // Only one at a time
+        U_PORT_TEST_ASSERT(uCellNetDataCounterSamplerStart(cellHandle, &gDataCounterSampler,
+                                                           U_CELL_NET_DATA_COUNTER_SAMPLER_PERIOD_MIN_MS,
+                                                           0, NULL, NULL) < 0);
+        for (x = 20; (gDataCounterSamplerCallbackCount < 3) && (x > 0); x--) {
+            uPortTaskBlock(1000);
+        }
+        U_TEST_PRINT_LINE("%d sample(s) taken.", gDataCounterSamplerCallbackCount);
+        U_PORT_TEST_ASSERT(gDataCounterSamplerCallbackCount >= 3);
+        U_PORT_TEST_ASSERT(uCellNetDataCounterSamplerGet(&gDataCounterSampler,
+                                                         &dataCounterSample) == 0);
+        U_TEST_PRINT_LINE("latest sample: error %d, %d byte(s) sent, %d byte(s)"
+                          " received, %d/%d bytes/second.",
+                          dataCounterSample.errorCode, dataCounterSample.txBytes,
+                          dataCounterSample.rxBytes, dataCounterSample.txBytesPerSecond,
+                          dataCounterSample.rxBytesPerSecond);
+        U_PORT_TEST_ASSERT(dataCounterSample.errorCode == 0);
+        U_PORT_TEST_ASSERT((dataCounterSample.txBytes >= 0) &&
+                           (dataCounterSample.rxBytes >= 0));
+        U_PORT_TEST_ASSERT((dataCounterSample.txBytesPerSecond >= 0) &&
+                           (dataCounterSample.rxBytesPerSecond >= 0));
+        // Reading the counters directly also updates the sampler
+        x = (int32_t) dataCounterSample.count;
+        U_PORT_TEST_ASSERT(uCellNetGetDataCounterTx(cellHandle) >= 0);
+        U_PORT_TEST_ASSERT(uCellNetDataCounterSamplerGet(&gDataCounterSampler,
+                                                         &dataCounterSample) == 0);
+        U_PORT_TEST_ASSERT((int32_t) dataCounterSample.count > x);
+        uCellNetDataCounterSamplerStop(cellHandle);
+        // Should be able to call stop again harmlessly
+        uCellNetDataCounterSamplerStop(cellHandle);
+    } else {
+        U_PORT_TEST_ASSERT(x < 0);
+        U_PORT_TEST_ASSERT(uCellNetDataCounterSamplerGet(&gDataCounterSampler,
+                                                         &dataCounterSample) < 0);
+    }
+
     // Check that we can connect again with the same APN,
     // should return pretty much immediately
     gStopTimeMs = uPortGetTickTimeMs() + 5000;
@@ -392,6 +488,9 @@ U_PORT_TEST_FUNCTION("[cellNet]", "cellNetConnectDisconnectPlus")
 #endif
                         keepGoingCallback);
     U_PORT_TEST_ASSERT(x == 0);
+    // ...and that should have been because we were
+    U_PORT_TEST_ASSERT(uCellNetGetLastConnectPath(cellHandle) ==
+                       (int32_t) U_CELL_NET_CONNECT_PATH_EXISTING);
 
     // Get the IP address to check that we're still there
     memset(buffer, '|', sizeof(buffer));
@@ -469,6 +568,7 @@ U_PORT_TEST_FUNCTION("[cellNet]", "cellNetScanRegActDeact")
     int32_t mcc = 0;
     int32_t mnc = 0;
     int32_t y = 0;
+    int32_t numStreamed = 0;
     uCellNetRat_t rat = U_CELL_NET_RAT_UNKNOWN_OR_NOT_USED;
     int32_t heapUsed;
 
@@ -527,6 +627,25 @@ U_PORT_TEST_FUNCTION("[cellNet]", "cellNetScanRegActDeact")
     // Must be at least one, can't guarantee more than that
     U_PORT_TEST_ASSERT(y > 0);
 
+    // Do it again, streaming the results this time, and
+    // check that the callback can stop them at the first one
+    y = 0;
+    gCallbackErrorCode = 0;
+    for (size_t x = 5; (x > 0) && (y <= 0); x--) {
+        U_TEST_PRINT_LINE("scanning for networks, streamed...");
+        gStopTimeMs = uPortGetTickTimeMs() +
+                      (U_CELL_TEST_CFG_CONNECT_TIMEOUT_SECONDS * 1000);
+        numStreamed = uCellNetScan(cellHandle, scanCallback, &y, keepGoingCallback);
+        U_TEST_PRINT_LINE("uCellNetScan() returned %d.", numStreamed);
+        if (y == 0) {
+            U_TEST_PRINT_LINE("*** WARNING *** RETRY SCAN.");
+            uPortTaskBlock(5000);
+        }
+    }
+    U_PORT_TEST_ASSERT(y == 1);
+    U_PORT_TEST_ASSERT(numStreamed == 1);
+    U_PORT_TEST_ASSERT(gCallbackErrorCode == 0);
+
     // Register with a very short time-out to show that aborts work
     gStopTimeMs = uPortGetTickTimeMs() + 1000;
     U_PORT_TEST_ASSERT(uCellNetRegister(cellHandle, NULL, keepGoingCallback) < 0);
@@ -811,6 +930,123 @@ U_PORT_TEST_FUNCTION("[cellNet]", "cellNetScanRegActDeact")
     U_PORT_TEST_ASSERT(heapUsed <= 0);
 }
 
+/** Test band learning: connect, check that the band has been
+ * learnt if the RAT is an EUTRAN one, disconnect, which narrows
+ * the band mask, then stop, which widens it again.
+ */
+U_PORT_TEST_FUNCTION("[cellNet]", "cellNetBandLearn")
+{
+    uDeviceHandle_t cellHandle;
+    uCellNetRat_t rat;
+    int32_t mcc = 0;
+    int32_t mnc = 0;
+    uint64_t bandMask1 = 0;
+    uint64_t bandMask2 = 0;
+    int32_t heapUsed;
+
+    // In case a previous test failed
+    uCellTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    // Do the standard preamble
+    U_PORT_TEST_ASSERT(uCellTestPrivatePreamble(U_CFG_TEST_CELL_MODULE_TYPE,
+                                                &gHandles, true) == 0);
+    cellHandle = gHandles.cellHandle;
+
+    U_PORT_TEST_ASSERT(uCellNetBandLearnStart(cellHandle, NULL) == 0);
+    U_PORT_TEST_ASSERT(uCellNetBandLearnStart(cellHandle, NULL) < 0);
+
+    gStopTimeMs = uPortGetTickTimeMs() +
+                  (U_CELL_TEST_CFG_CONNECT_TIMEOUT_SECONDS * 1000);
+    U_PORT_TEST_ASSERT(uCellNetConnect(cellHandle, NULL,
+#ifdef U_CELL_TEST_CFG_APN
+                                       U_PORT_STRINGIFY_QUOTED(U_CELL_TEST_CFG_APN),
+#else
+                                       NULL,
+#endif
+#ifdef U_CELL_TEST_CFG_USERNAME
+                                       U_PORT_STRINGIFY_QUOTED(U_CELL_TEST_CFG_USERNAME),
+#else
+                                       NULL,
+#endif
+#ifdef U_CELL_TEST_CFG_PASSWORD
+                                       U_PORT_STRINGIFY_QUOTED(U_CELL_TEST_CFG_PASSWORD),
+#else
+                                       NULL,
+#endif
+                                       keepGoingCallback) == 0);
+    rat = uCellNetGetActiveRat(cellHandle);
+    U_PORT_TEST_ASSERT(uCellNetGetMccMnc(cellHandle, &mcc, &mnc) == 0);
+    if (U_CELL_PRIVATE_RAT_IS_EUTRAN(rat)) {
+        U_PORT_TEST_ASSERT(uCellNetBandLearnGet(cellHandle, mcc, rat,
+                                                &bandMask1, &bandMask2) == 0);
+        U_TEST_PRINT_LINE("learnt band mask 0x%08x%08x %08x%08x for MCC %d, RAT %d.",
+                          (uint32_t) (bandMask2 >> 32), (uint32_t) bandMask2,
+                          (uint32_t) (bandMask1 >> 32), (uint32_t) bandMask1,
+                          mcc, rat);
+        U_PORT_TEST_ASSERT((bandMask1 != 0) || (bandMask2 != 0));
+    } else {
+        U_PORT_TEST_ASSERT(uCellNetBandLearnGet(cellHandle, mcc, rat,
+                                                &bandMask1, &bandMask2) < 0);
+    }
+
+    U_PORT_TEST_ASSERT(uCellNetDisconnect(cellHandle, NULL) == 0);
+    U_PORT_TEST_ASSERT(uCellNetBandLearnStop(cellHandle) == 0);
+    U_PORT_TEST_ASSERT(uCellNetBandLearnGet(cellHandle, mcc, rat,
+                                            &bandMask1, &bandMask2) < 0);
+
+    // Do the standard postamble, leaving the module on for the next
+    // test to speed things up
+    uCellTestPrivatePostamble(&gHandles, false);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+/** Test the APN database; no module is required.
+ */
+U_PORT_TEST_FUNCTION("[cellNet]", "cellNetApnDb")
+{
+    size_t numEntries = sizeof(gApnLookUpTable) / sizeof(gApnLookUpTable[0]);
+
+    U_TEST_PRINT_LINE("checking the %d entries of the APN database...",
+                      (int32_t) numEntries);
+    U_PORT_TEST_ASSERT(sizeof(gApnConfig) / sizeof(gApnConfig[0]) ==
+                       U_CELL_APN_DB_CFG_MAX_NUM);
+    for (size_t x = 0; x < numEntries; x++) {
+        // The look-up table must be sorted, with no repeats,
+        // for the binary search to work
+        if (x > 0) {
+            U_PORT_TEST_ASSERT((gApnLookUpTable[x] >> 11) >
+                               (gApnLookUpTable[x - 1] >> 11));
+        }
+        U_PORT_TEST_ASSERT((gApnLookUpTable[x] & 0x7ff) <
+                           U_CELL_APN_DB_CFG_MAX_NUM);
+    }
+
+    // Two and three digit MNCs, first and last entries
+    U_PORT_TEST_ASSERT(strcmp(pApnGetConfig("310260123456789"),
+                              "epc.tmobile.com") == 0);
+    U_PORT_TEST_ASSERT(strcmp(pApnGetConfig("310680123456789"),
+                              "phone") == 0);
+    U_PORT_TEST_ASSERT(strcmp(pApnGetConfig("440990123456789"),
+                              "bmobilewap") == 0);
+    U_PORT_TEST_ASSERT(strcmp(pApnGetConfig("204040123456789"),
+                              "public4.m2minternet.com") == 0);
+    U_PORT_TEST_ASSERT(strcmp(pApnGetConfig("901370123456789"),
+                              "netgprs.com") == 0);
+    // Not present, too short or not an IMSI: default
+    U_PORT_TEST_ASSERT(pApnGetConfig("999990123456789") == pApnDefault);
+    U_PORT_TEST_ASSERT(pApnGetConfig("310") == pApnDefault);
+    U_PORT_TEST_ASSERT(pApnGetConfig("31x260123456789") == pApnDefault);
+    U_PORT_TEST_ASSERT(pApnGetConfig("") == pApnDefault);
+    U_PORT_TEST_ASSERT(pApnGetConfig(NULL) == pApnDefault);
+}
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
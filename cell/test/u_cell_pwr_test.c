@@ -255,6 +255,9 @@ static void testPowerAliveVInt(uCellTestPrivate_t *pHandles,
     int32_t returnCode;
     bool trulyHardPowerOff = false;
     const uCellPrivateModule_t *pModule;
+    uCellPrivateInstance_t *pInstance;
+    uint32_t configFingerprint = 0;
+    int32_t mnoProfile = -1;
 #  if U_CFG_APP_PIN_CELL_VINT < 0
     int64_t timeMs;
 #  endif
@@ -332,6 +335,19 @@ static void testPowerAliveVInt(uCellTestPrivate_t *pHandles,
                                       NULL) == 0);
         U_TEST_PRINT_LINE("checking that module is alive...");
         U_PORT_TEST_ASSERT(uCellPwrIsAlive(cellHandle));
+        // The non-volatile configuration should now have been
+        // fingerprinted and, the second time around, should
+        // not have needed writing again, nor the MNO profile
+        // reading again
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        U_PORT_TEST_ASSERT(pInstance != NULL);
+        U_PORT_TEST_ASSERT(pInstance->configFingerprint != 0);
+        if (x > 0) {
+            U_PORT_TEST_ASSERT(pInstance->configFingerprint == configFingerprint);
+            U_PORT_TEST_ASSERT(pInstance->mnoProfile == mnoProfile);
+        }
+        configFingerprint = pInstance->configFingerprint;
+        mnoProfile = pInstance->mnoProfile;
         // Give the module time to sort itself out
         U_TEST_PRINT_LINE("waiting %d second(s) before powering off...",
                           pModule->minAwakeTimeSeconds);
@@ -776,6 +792,7 @@ U_PORT_TEST_FUNCTION("[cellPwr]", "cellPwrReboot")
 {
     int32_t heapUsed;
     int32_t heapClibLossOffset = (int32_t) gSystemHeapLost;
+    uCellPwrEnergy_t energy;
 
     // In case a previous test failed
     uCellTestPrivateCleanup(&gHandles);
@@ -791,11 +808,25 @@ U_PORT_TEST_FUNCTION("[cellPwr]", "cellPwrReboot")
     // that is ephemeral so that we know whether a reboot has
     // occurred.  Anyway, this will be tested in those tests that
     // change bandmask and RAT.
+    // Run the energy accounts, without a current table, across it
+    U_PORT_TEST_ASSERT(uCellPwrEnergyStart(gHandles.cellHandle, NULL) == 0);
     U_TEST_PRINT_LINE("rebooting cellular...");
     U_PORT_TEST_ASSERT(uCellPwrReboot(gHandles.cellHandle, NULL) == 0);
 
     U_PORT_TEST_ASSERT(uCellPwrIsAlive(gHandles.cellHandle));
 
+    U_PORT_TEST_ASSERT(uCellPwrEnergyGet(gHandles.cellHandle, &energy) == 0);
+    U_TEST_PRINT_LINE("energy accounts: idle %d ms, %d byte(s) sent.",
+                      (int32_t) energy.timeMs[U_CELL_PWR_ENERGY_STATE_IDLE],
+                      (int32_t) energy.bytesSent);
+    U_PORT_TEST_ASSERT(energy.timeMs[U_CELL_PWR_ENERGY_STATE_IDLE] > 0);
+    U_PORT_TEST_ASSERT(energy.bytesSent == 0);
+    U_PORT_TEST_ASSERT(energy.energyMicrojoules == -1);
+    U_PORT_TEST_ASSERT(energy.energyPerByteNanojoules == -1);
+    uCellPwrEnergyStop(gHandles.cellHandle);
+    U_PORT_TEST_ASSERT(uCellPwrEnergyGet(gHandles.cellHandle,
+                                         &energy) == U_ERROR_COMMON_NOT_INITIALISED);
+
     // Do the standard postamble, leaving the module on for the next
     // test to speed things up
     uCellTestPrivatePostamble(&gHandles, false);
@@ -1157,6 +1188,15 @@ U_PORT_TEST_FUNCTION("[cellPwr]", "cellPwrSaving3gpp")
         uPortTaskBlock(1000);
         U_PORT_TEST_ASSERT(wakeCallbackParam == 1);
 
+        // Since the module has been woken and restored already,
+        // powering it on should now just be a liveness check
+        x = (int32_t) uPortGetTickTimeMs();
+        U_PORT_TEST_ASSERT(uCellPwrOn(cellHandle, NULL, NULL) == 0);
+        x = (int32_t) uPortGetTickTimeMs() - x;
+        U_TEST_PRINT_LINE("power on after wake-up took %d ms.", x);
+        U_PORT_TEST_ASSERT(x < pModule->responseMaxWaitMs);
+        U_PORT_TEST_ASSERT(wakeCallbackParam == 1);
+
         // We should still be registered on an EUTRAN RAT
         rat = uCellNetGetActiveRat(cellHandle);
         U_PORT_TEST_ASSERT((rat == U_CELL_NET_RAT_LTE) || (rat == U_CELL_NET_RAT_CATM1) ||
@@ -405,6 +405,20 @@ U_PORT_TEST_FUNCTION("[cellSecTls]", "cellSecTlsSettings")
                                              U_CELL_SEC_TLS_TEST_NAME_LENGTH_BYTES + 1) < 0);
     }
 
+    if (U_CELL_PRIVATE_HAS(pModule,
+                           U_CELL_PRIVATE_FEATURE_SECURITY_TLS_SESSION_RESUMPTION)) {
+        // Check that session resumption can be switched on and off
+        U_TEST_PRINT_LINE("checking session resumption...");
+        U_PORT_TEST_ASSERT(!uCellSecTlsIsSessionResumptionOn(pContext));
+        U_PORT_TEST_ASSERT(uCellSecTlsSessionResumptionSet(pContext, true) == 0);
+        U_PORT_TEST_ASSERT(uCellSecTlsIsSessionResumptionOn(pContext));
+        U_PORT_TEST_ASSERT(uCellSecTlsSessionResumptionSet(pContext, false) == 0);
+        U_PORT_TEST_ASSERT(!uCellSecTlsIsSessionResumptionOn(pContext));
+    } else {
+        U_PORT_TEST_ASSERT(uCellSecTlsSessionResumptionSet(pContext, true) < 0);
+        U_PORT_TEST_ASSERT(!uCellSecTlsIsSessionResumptionOn(pContext));
+    }
+
     // TODO currently there are no automated tests of
     // uCellSecTlsUseDeviceCertificateSet() and uCellSecTlsIsUsingDeviceCertificate()
     // since none of the FW versions we have on the modules of the
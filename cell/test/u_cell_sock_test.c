@@ -57,6 +57,7 @@
 #include "u_at_client.h"
 
 #include "u_sock.h"
+#include "u_sock_errno.h"
 
 #include "u_cell_module_type.h"
 #include "u_cell.h"
@@ -328,6 +329,10 @@ static uCellSockTestOption_t gSupportedOptions[] = {
         (1UL << U_CELL_MODULE_TYPE_SARA_R422),
         U_SOCK_OPT_LEVEL_TCP, U_SOCK_OPT_TCP_KEEPIDLE, sizeof(int32_t), compareInt32, changeInt32Positive
     },
+    {
+        0, /* All modules: handled locally as the read-ahead buffer size */
+        U_SOCK_OPT_LEVEL_SOCK, U_SOCK_OPT_RCVBUF, sizeof(int32_t), compareInt32, changeMod256NonZero
+    },
 };
 
 /* ----------------------------------------------------------------
@@ -626,6 +631,17 @@ U_PORT_TEST_FUNCTION("[cellSock]", "cellSockBasic")
     // Add the port number we will use
     echoServerAddressTcp.port = U_SOCK_TEST_ECHO_TCP_SERVER_PORT;
 
+    // Have a socket of each protocol made ready in advance
+    // and wait for the pool to fill
+    U_PORT_TEST_ASSERT(uCellSockPoolSet(cellHandle, 1, 1) == 0);
+    for (size_t x = 0; (x < 10) &&
+         ((uCellSockPoolGet(cellHandle, U_SOCK_PROTOCOL_TCP) < 1) ||
+          (uCellSockPoolGet(cellHandle, U_SOCK_PROTOCOL_UDP) < 1)); x++) {
+        uPortTaskBlock(1000);
+    }
+    U_PORT_TEST_ASSERT(uCellSockPoolGet(cellHandle, U_SOCK_PROTOCOL_TCP) == 1);
+    U_PORT_TEST_ASSERT(uCellSockPoolGet(cellHandle, U_SOCK_PROTOCOL_UDP) == 1);
+
     // Create a UDP socket
     gSockHandleUdp = uCellSockCreate(cellHandle, U_SOCK_TYPE_DGRAM,
                                      U_SOCK_PROTOCOL_UDP);
@@ -742,6 +758,13 @@ U_PORT_TEST_FUNCTION("[cellSock]", "cellSockBasic")
         } else {
             U_PORT_TEST_ASSERT(uCellSockHexModeOn(cellHandle) == 0);
             U_PORT_TEST_ASSERT(uCellSockHexModeIsOn(cellHandle));
+            // Also receive through a read-ahead buffer this time,
+            // smaller than the echo data so that it is refilled
+            y = 128;
+            U_PORT_TEST_ASSERT(uCellSockOptionSet(cellHandle, gSockHandleTcp,
+                                                  U_SOCK_OPT_LEVEL_SOCK,
+                                                  U_SOCK_OPT_RCVBUF,
+                                                  &y, sizeof(y)) == 0);
         }
         // Send the TCP echo data in random sized chunks
         U_TEST_PRINT_LINE("sending %d byte(s) to %s:%d in random sized"
@@ -853,6 +876,12 @@ U_PORT_TEST_FUNCTION("[cellSock]", "cellSockBasic")
     U_PORT_TEST_ASSERT(gClosedCallbackCalledTcp);
     U_PORT_TEST_ASSERT(gCallbackErrorNum == 0);
 
+    // Empty the socket pool, which will have been topped
+    // up again after the sockets were taken from it
+    U_PORT_TEST_ASSERT(uCellSockPoolSet(cellHandle, 0, 0) == 0);
+    U_PORT_TEST_ASSERT(uCellSockPoolGet(cellHandle, U_SOCK_PROTOCOL_TCP) == 0);
+    U_PORT_TEST_ASSERT(uCellSockPoolGet(cellHandle, U_SOCK_PROTOCOL_UDP) == 0);
+
     // Deinit cell sockets
     uCellSockDeinit();
 
@@ -916,11 +945,144 @@ U_PORT_TEST_FUNCTION("[cellSock]", "cellSockBasic")
     U_PORT_TEST_ASSERT(heapUsed <= 0);
 }
 
+/** Test direct link mode.
+ */
+U_PORT_TEST_FUNCTION("[cellSock]", "cellSockDirectLink")
+{
+    uDeviceHandle_t cellHandle;
+    uSockAddress_t echoServerAddressTcp;
+    int32_t y;
+    int32_t z;
+    char *pBuffer;
+    int32_t heapUsed;
+
+    // In case a previous test failed
+    uCellSockDeinit();
+    uCellTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    memset(&echoServerAddressTcp, 0, sizeof(echoServerAddressTcp));
+
+    // Malloc a buffer to receive things into.
+    pBuffer = (char *) pUPortMalloc(U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES);
+    U_PORT_TEST_ASSERT(pBuffer != NULL);
+
+    // Do the standard preamble
+    U_PORT_TEST_ASSERT(uCellTestPrivatePreamble(U_CFG_TEST_CELL_MODULE_TYPE,
+                                                &gHandles, true) == 0);
+    cellHandle = gHandles.cellHandle;
+
+    // Connect to the network
+    gStopTimeMs = uPortGetTickTimeMs() +
+                  (U_CELL_TEST_CFG_CONNECT_TIMEOUT_SECONDS * 1000);
+    y = uCellNetConnect(cellHandle, NULL,
+#ifdef U_CELL_TEST_CFG_APN
+                        U_PORT_STRINGIFY_QUOTED(U_CELL_TEST_CFG_APN),
+#else
+                        NULL,
+#endif
+#ifdef U_CELL_TEST_CFG_USERNAME
+                        U_PORT_STRINGIFY_QUOTED(U_CELL_TEST_CFG_USERNAME),
+#else
+                        NULL,
+#endif
+#ifdef U_CELL_TEST_CFG_PASSWORD
+                        U_PORT_STRINGIFY_QUOTED(U_CELL_TEST_CFG_PASSWORD),
+#else
+                        NULL,
+#endif
+                        keepGoingCallback);
+    U_PORT_TEST_ASSERT(y == 0);
+
+    // Init cell sockets
+    U_PORT_TEST_ASSERT(uCellSockInit() == 0);
+    U_PORT_TEST_ASSERT(uCellSockInitInstance(cellHandle) == 0);
+
+    // Look up the address of the server we use for TCP echo
+    U_PORT_TEST_ASSERT(uCellSockGetHostByName(cellHandle,
+                                              U_SOCK_TEST_ECHO_TCP_SERVER_DOMAIN_NAME,
+                                              &(echoServerAddressTcp.ipAddress)) == 0);
+    echoServerAddressTcp.port = U_SOCK_TEST_ECHO_TCP_SERVER_PORT;
+
+    // Create and connect a TCP socket
+    gSockHandleTcp = uCellSockCreate(cellHandle, U_SOCK_TYPE_STREAM,
+                                     U_SOCK_PROTOCOL_TCP);
+    U_PORT_TEST_ASSERT(gSockHandleTcp >= 0);
+    U_PORT_TEST_ASSERT(uCellSockConnect(cellHandle, gSockHandleTcp,
+                                        &echoServerAddressTcp) == 0);
+
+    // Can't stop what hasn't been started
+    U_PORT_TEST_ASSERT(uCellSockDirectLinkStop(cellHandle, gSockHandleTcp) < 0);
+
+    // Enter direct link mode and check that it can't be entered twice
+    U_TEST_PRINT_LINE("entering direct link mode...");
+    U_PORT_TEST_ASSERT(uCellSockDirectLinkStart(cellHandle, gSockHandleTcp) == 0);
+    U_PORT_TEST_ASSERT(uCellSockDirectLinkStart(cellHandle,
+                                                gSockHandleTcp) == -U_SOCK_EALREADY);
+
+    // Send the data, which includes things that look like AT
+    // responses, in one go and get it back again
+    U_TEST_PRINT_LINE("sending %d byte(s) to %s:%d in direct link mode...",
+                      sizeof(gAllChars), U_SOCK_TEST_ECHO_TCP_SERVER_DOMAIN_NAME,
+                      U_SOCK_TEST_ECHO_TCP_SERVER_PORT);
+    U_PORT_TEST_ASSERT(uCellSockWrite(cellHandle, gSockHandleTcp,
+                                      gAllChars, sizeof(gAllChars)) == sizeof(gAllChars));
+    y = 0;
+    memset(pBuffer, 0, U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES);
+    for (size_t x = 0; (x < 100) && (y < sizeof(gAllChars)); x++) {
+        z = uCellSockRead(cellHandle, gSockHandleTcp, pBuffer + y,
+                          sizeof(gAllChars) - y);
+        if (z > 0) {
+            y += z;
+        } else {
+            U_PORT_TEST_ASSERT(z == -U_SOCK_EWOULDBLOCK);
+            uPortTaskBlock(100);
+        }
+    }
+    U_TEST_PRINT_LINE("%d byte(s) echoed in direct link mode.", y);
+    U_PORT_TEST_ASSERT(y == sizeof(gAllChars));
+    U_PORT_TEST_ASSERT(memcmp(pBuffer, gAllChars, sizeof(gAllChars)) == 0);
+
+    // Leave direct link mode: the AT interface should then work again
+    U_TEST_PRINT_LINE("leaving direct link mode...");
+    U_PORT_TEST_ASSERT(uCellSockDirectLinkStop(cellHandle, gSockHandleTcp) == 0);
+    U_PORT_TEST_ASSERT(uCellSockGetHostByName(cellHandle,
+                                              U_SOCK_TEST_ECHO_TCP_SERVER_DOMAIN_NAME,
+                                              &(echoServerAddressTcp.ipAddress)) == 0);
+
+    // Some modules close the socket on leaving direct link
+    // mode, hence the outcome of this is not checked
+    uCellSockClose(cellHandle, gSockHandleTcp, NULL);
+
+    // Deinit cell sockets
+    uCellSockDeinit();
+
+    // Disconnect
+    U_PORT_TEST_ASSERT(uCellNetDisconnect(cellHandle, NULL) == 0);
+
+    // Do the standard postamble, leaving the module on for the next
+    // test to speed things up
+    uCellTestPrivatePostamble(&gHandles, false);
+
+    // Free memory
+    uPortFree(pBuffer);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
 /** Test setting/getting socket options.
  */
 U_PORT_TEST_FUNCTION("[cellSock]", "cellSockOptionSetGet")
 {
     uDeviceHandle_t cellHandle;
+    const uCellPrivateModule_t *pModule;
     void *pValue;
     void *pValueSaved;
     size_t length = 0;
@@ -1030,6 +1192,46 @@ U_PORT_TEST_FUNCTION("[cellSock]", "cellSockOptionSetGet")
     uPortFree(pValue);
     uPortFree(pValueSaved);
 
+    // The socket should be on the PDP context of uCellNetConnect()
+    length = sizeof(y);
+    U_PORT_TEST_ASSERT(uCellSockOptionGet(cellHandle, gSockHandleTcp,
+                                          U_SOCK_OPT_LEVEL_SOCK,
+                                          U_SOCK_OPT_PDP_CONTEXT,
+                                          &y, &length) == 0);
+    U_PORT_TEST_ASSERT(length == sizeof(y));
+    U_PORT_TEST_ASSERT(y == U_CELL_NET_CONTEXT_ID);
+    pModule = pUCellPrivateGetModule(cellHandle);
+    U_PORT_TEST_ASSERT(pModule != NULL);
+    if (U_CELL_PRIVATE_HAS_MULTIPLE_CONTEXTS(pModule)) {
+        // Bring up a second PDP context on the same APN and move
+        // the socket, which has not yet been used, over to it
+        U_TEST_PRINT_LINE("activating PDP context %d...", U_CELL_NET_CONTEXT_ID + 1);
+        U_PORT_TEST_ASSERT(uCellNetActivateContext(cellHandle,
+                                                   U_CELL_NET_CONTEXT_ID + 1,
+#ifdef U_CELL_TEST_CFG_APN
+                                                   U_PORT_STRINGIFY_QUOTED(U_CELL_TEST_CFG_APN),
+#else
+                                                   NULL,
+#endif
+                                                   NULL, NULL, NULL) == 0);
+        y = U_CELL_NET_CONTEXT_ID + 1;
+        U_PORT_TEST_ASSERT(uCellSockOptionSet(cellHandle, gSockHandleTcp,
+                                              U_SOCK_OPT_LEVEL_SOCK,
+                                              U_SOCK_OPT_PDP_CONTEXT,
+                                              &y, sizeof(y)) == 0);
+        y = 0;
+        length = sizeof(y);
+        U_PORT_TEST_ASSERT(uCellSockOptionGet(cellHandle, gSockHandleTcp,
+                                              U_SOCK_OPT_LEVEL_SOCK,
+                                              U_SOCK_OPT_PDP_CONTEXT,
+                                              &y, &length) == 0);
+        U_PORT_TEST_ASSERT(y == U_CELL_NET_CONTEXT_ID + 1);
+    } else {
+        U_PORT_TEST_ASSERT(uCellNetActivateContext(cellHandle,
+                                                   U_CELL_NET_CONTEXT_ID + 1,
+                                                   NULL, NULL, NULL, NULL) < 0);
+    }
+
     // Close TCP socket, immediately since it was never
     // connected
     U_TEST_PRINT_LINE("closing sockets...");
@@ -1041,6 +1243,11 @@ U_PORT_TEST_FUNCTION("[cellSock]", "cellSockOptionSetGet")
     U_PORT_TEST_ASSERT(gClosedCallbackCalledTcp);
     U_PORT_TEST_ASSERT(gCallbackErrorNum == 0);
 
+    if (U_CELL_PRIVATE_HAS_MULTIPLE_CONTEXTS(pModule)) {
+        U_PORT_TEST_ASSERT(uCellNetDeactivateContext(cellHandle,
+                                                     U_CELL_NET_CONTEXT_ID + 1) == 0);
+    }
+
     // Deinit cell sockets
     uCellSockDeinit();
 
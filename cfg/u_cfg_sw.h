@@ -41,6 +41,52 @@
 # define U_CFG_ENABLE_LOGGING                 1
 #endif
 
+/* If U_CFG_HEAP_STATIC is defined then the default implementation of
+ * pUPortMalloc()/uPortFree() in port/u_port_heap.c never calls
+ * malloc(): all of the memory that ubxlib allocates (and anything
+ * else allocated with pUPortMalloc()) is instead taken from a set of
+ * fixed-block pools in a static array, the number of blocks of each
+ * size being set at compile time with the macros below, so that the
+ * RAM required is fixed and shows up in the .bss section of your
+ * build.  An allocation is satisfied from the pool with the smallest
+ * block size that is big enough and has a block free.  Use
+ * uPortHeapStaticGetStats() while running your application to tune
+ * the numbers.  Note that the RTOS of your platform may still allocate
+ * memory for its own objects (tasks, mutexes, queues etc.) from its
+ * own heap; see the documentation of your RTOS for how to make those
+ * static also.
+ */
+
+#ifndef U_CFG_HEAP_STATIC_NUM_BLOCKS_32
+/** The number of 32 byte blocks when #U_CFG_HEAP_STATIC is defined.
+ */
+# define U_CFG_HEAP_STATIC_NUM_BLOCKS_32      64
+#endif
+
+#ifndef U_CFG_HEAP_STATIC_NUM_BLOCKS_128
+/** The number of 128 byte blocks when #U_CFG_HEAP_STATIC is defined.
+ */
+# define U_CFG_HEAP_STATIC_NUM_BLOCKS_128     32
+#endif
+
+#ifndef U_CFG_HEAP_STATIC_NUM_BLOCKS_512
+/** The number of 512 byte blocks when #U_CFG_HEAP_STATIC is defined.
+ */
+# define U_CFG_HEAP_STATIC_NUM_BLOCKS_512     16
+#endif
+
+#ifndef U_CFG_HEAP_STATIC_NUM_BLOCKS_2048
+/** The number of 2048 byte blocks when #U_CFG_HEAP_STATIC is defined.
+ */
+# define U_CFG_HEAP_STATIC_NUM_BLOCKS_2048    4
+#endif
+
+#ifndef U_CFG_HEAP_STATIC_NUM_BLOCKS_8192
+/** The number of 8192 byte blocks when #U_CFG_HEAP_STATIC is defined.
+ */
+# define U_CFG_HEAP_STATIC_NUM_BLOCKS_8192    1
+#endif
+
 /** @}*/
 
 #endif // _U_CFG_SW_H_
@@ -86,6 +86,76 @@
 # define U_PACKED_STRUCT(NAME) struct __attribute__((packed)) NAME
 #endif
 
+/** U_MEMORY_BARRIER: a full memory barrier, preventing both the
+ * compiler and the processor from re-ordering memory accesses
+ * across it; use this where two contexts (e.g. a task and an
+ * interrupt) share data without a mutex.
+ */
+#ifdef _MSC_VER
+/** Microsoft Visual C++ definition: x86/x64 doesn't re-order
+ * stores with other stores or loads with other loads so a compiler
+ * barrier is sufficient.
+ */
+# include <intrin.h>
+# define U_MEMORY_BARRIER() _ReadWriteBarrier()
+#else
+/** Default (GCC) definition.
+ */
+# define U_MEMORY_BARRIER() __sync_synchronize()
+#endif
+
+/** U_ATOMIC_COMPARE_AND_SWAP: atomically set the uint32_t at pValue
+ * to newValue if it is currently oldValue, evaluating to true if
+ * that was done; this is a full memory barrier.  Use this where
+ * more than one context (e.g. tasks and interrupts) may modify the
+ * same value without a mutex.
+ */
+#ifdef _MSC_VER
+/** Microsoft Visual C++ definition.
+ */
+# define U_ATOMIC_COMPARE_AND_SWAP(pValue, oldValue, newValue) \
+    (_InterlockedCompareExchange((volatile long *) (pValue), (long) (newValue), \
+                                 (long) (oldValue)) == (long) (oldValue))
+#else
+/** Default (GCC) definition.
+ */
+# define U_ATOMIC_COMPARE_AND_SWAP(pValue, oldValue, newValue) \
+    __sync_bool_compare_and_swap(pValue, oldValue, newValue)
+#endif
+
+/** U_ATOMIC_ADD: atomically add amount to the uint32_t at pValue;
+ * this is a full memory barrier.  Use this where more than one
+ * context (e.g. tasks and interrupts) may add to the same value
+ * without a mutex.
+ */
+#ifdef _MSC_VER
+/** Microsoft Visual C++ definition.
+ */
+# define U_ATOMIC_ADD(pValue, amount) \
+    ((void) _InterlockedExchangeAdd((volatile long *) (pValue), (long) (amount)))
+#else
+/** Default (GCC) definition.
+ */
+# define U_ATOMIC_ADD(pValue, amount) ((void) __sync_fetch_and_add(pValue, amount))
+#endif
+
+/** U_PRINTF_FORMAT: attribute that tells the compiler a function
+ * takes a printf()-style format string as parameter formatIndex
+ * with the variable arguments starting at parameter argIndex
+ * (both counting from 1), so that the arguments are checked against
+ * the format specifiers at compile time.
+ */
+#ifdef _MSC_VER
+/** Microsoft Visual C++ definition: no equivalent attribute.
+ */
+# define U_PRINTF_FORMAT(formatIndex, argIndex)
+#else
+/** Default (GCC) definition.
+ */
+# define U_PRINTF_FORMAT(formatIndex, argIndex) \
+    __attribute__ ((format (__printf__, formatIndex, argIndex)))
+#endif
+
 #endif // _U_COMPILER_H_
 
 
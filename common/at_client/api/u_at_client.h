@@ -23,6 +23,8 @@
  * of another module should be included here; otherwise
  * please keep #includes to your .c files. */
 
+#include "u_compiler.h" // U_PRINTF_FORMAT
+
 /** \addtogroup _AT-client __AT Client
  *  @{
  */
@@ -294,6 +296,14 @@ extern "C" {
  */
 #define U_AT_CLIENT_CRLF_LENGTH_BYTES       2
 
+#ifndef U_AT_CLIENT_COMMANDF_MAX_LENGTH_BYTES
+/** The maximum length of an AT command formatted by
+ * uAtClientCommandf(), not including the command delimiter;
+ * this is allocated on the stack of the calling task.
+ */
+# define U_AT_CLIENT_COMMANDF_MAX_LENGTH_BYTES 128
+#endif
+
 #ifndef U_AT_CLIENT_DEFAULT_TIMEOUT_MS
 /** The default AT command time-out in milliseconds.
  */
@@ -315,6 +325,15 @@ extern "C" {
 # define U_AT_CLIENT_DEFAULT_DELAY_MS       25
 #endif
 
+#ifndef U_AT_CLIENT_ADAPTIVE_DELAY_STEP_MS
+/** When adaptive pacing is switched on with
+ * uAtClientDelayAdaptiveSet(), the amount by which the delay
+ * between AT commands is reduced each time a command receives
+ * a response from the AT server.
+ */
+# define U_AT_CLIENT_ADAPTIVE_DELAY_STEP_MS 1
+#endif
+
 #ifndef U_AT_CLIENT_URC_TIMEOUT_MS
 /** The AT timeout in milliseconds while running in the context
  * of a URC handler. URCs should be handled fast, if you add debug
@@ -336,6 +355,37 @@ extern "C" {
 # define U_AT_CLIENT_STREAM_READ_RETRY_DELAY_MS 10
 #endif
 
+#ifndef U_AT_CLIENT_STREAM_READ_EVENT_WAIT_MAX_MS
+/** When waiting for data to arrive on the input stream the AT
+ * client waits on a semaphore that is given by the stream's
+ * data-received event, rather than polling every
+ * U_AT_CLIENT_STREAM_READ_RETRY_DELAY_MS; this is the longest
+ * it will wait for such an event before checking the stream
+ * anyway, so that nothing is lost if an event is missed.
+ */
+# define U_AT_CLIENT_STREAM_READ_EVENT_WAIT_MAX_MS 100
+#endif
+
+#ifndef U_AT_CLIENT_STREAM_EVENT_DELIMITER
+/** Where the stream is a UART and the platform supports it (see
+ * uPortUartEventDelimiterSet()), the data received event is only
+ * passed to the AT client when this character, the end of an AT
+ * line, has been received, so that the AT client processes whole
+ * lines rather than a few characters at a time.  Set this to -1
+ * to process the stream on every data received event.
+ */
+# define U_AT_CLIENT_STREAM_EVENT_DELIMITER '\n'
+#endif
+
+#ifndef U_AT_CLIENT_STREAM_EVENT_DELIMITER_TIMEOUT_MS
+/** How long to wait for #U_AT_CLIENT_STREAM_EVENT_DELIMITER after
+ * data has been received before the AT client is given the data
+ * anyway, e.g. for a prompt character that is not followed by a
+ * line ending or for binary data.
+ */
+# define U_AT_CLIENT_STREAM_EVENT_DELIMITER_TIMEOUT_MS 10
+#endif
+
 #ifndef U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES
 /** The stack size for the URC task.  This is chosen to
  * work for all platforms, the governing factor being ESP32,
@@ -380,6 +430,48 @@ extern "C" {
 # define U_AT_CLIENT_MAX_NUM 5
 #endif
 
+#ifndef U_AT_CLIENT_RECEIVE_BUFFER_SHRINK_IDLE_MS
+/** Where the receive buffer of an AT client has been allowed to
+ * grow (see uAtClientReceiveBufferGrowSet()), the time for which the
+ * extra room must have gone unused before the receive buffer is
+ * shrunk back to the size it was given in uAtClientAdd().
+ */
+# define U_AT_CLIENT_RECEIVE_BUFFER_SHRINK_IDLE_MS 10000
+#endif
+
+#ifndef U_AT_CLIENT_STATS_NUM_COMMANDS
+/** The number of different AT commands for which latency
+ * statistics are kept when U_CFG_AT_CLIENT_STATS is defined;
+ * commands beyond this number are counted in
+ * uAtClientStats_t.numCommandsUntracked.
+ */
+# define U_AT_CLIENT_STATS_NUM_COMMANDS 16
+#endif
+
+#ifndef U_AT_CLIENT_STATS_COMMAND_PREFIX_MAX_LENGTH
+/** The maximum number of characters of an AT command, up to but
+ * not including any '=' or '?', used to identify it in the
+ * statistics, e.g. "AT+USOCTL" is 9 characters.
+ */
+# define U_AT_CLIENT_STATS_COMMAND_PREFIX_MAX_LENGTH 11
+#endif
+
+#ifndef U_AT_CLIENT_STATS_NUM_TAGS
+/** The number of different tags, see uAtClientStatsTagSet(), for
+ * which statistics are kept when U_CFG_AT_CLIENT_STATS is defined;
+ * use by tags beyond this number is counted in
+ * uAtClientStats_t.untagged.
+ */
+# define U_AT_CLIENT_STATS_NUM_TAGS 24
+#endif
+
+/** The number of bins in the per-command latency histogram: bin 0
+ * counts responses that took less than 16 ms, bin 1 less than 32 ms,
+ * and so on, doubling each time, with the last bin counting
+ * anything longer.
+ */
+#define U_AT_CLIENT_STATS_LATENCY_NUM_BINS 10
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -388,13 +480,16 @@ extern "C" {
  */
 typedef void *uAtClientHandle_t;
 
-/** The types of underlying stream APIs supported, currently
- * only UART.
+/** The types of underlying stream APIs supported.
  */
 //lint -estring(788, uAtClientStream_t::U_AT_CLIENT_STREAM_TYPE_MAX) Suppress not used within defaulted switch
 typedef enum {
     U_AT_CLIENT_STREAM_TYPE_UART,
     U_AT_CLIENT_STREAM_TYPE_EDM,
+    U_AT_CLIENT_STREAM_TYPE_CMUX,  /**< a 3GPP 27.010 multiplexer channel
+                                        of a cellular module, the stream
+                                        handle being that returned by
+                                        uCellMuxChannelOpen(). */
     U_AT_CLIENT_STREAM_TYPE_MAX
 } uAtClientStream_t;
 
@@ -415,6 +510,118 @@ typedef struct {
     int32_t code;
 } uAtClientDeviceError_t;
 
+/** One fragment of data for uAtClientWriteBytesV().
+ */
+typedef struct {
+    const char *pData;  /**< the start of the fragment. */
+    size_t lengthBytes; /**< the number of bytes at pData. */
+} uAtClientIoVec_t;
+
+/** A span of an AT response, as returned by uAtClientReadSpan();
+ * the bytes are in the receive buffer of the AT client.
+ */
+typedef struct {
+    const char *pData; /**< the start of the span; NOT null-terminated. */
+    size_t length;     /**< the number of bytes at pData. */
+    bool isPartial;    /**< true if the field (or line) continues in
+                            the next span, because it is longer than
+                            the receive buffer of the AT client. */
+    bool isLast;       /**< true if the span ended at the stop tag,
+                            i.e. there is nothing more in this line. */
+} uAtClientSpan_t;
+
+/** A single entry in a pipelined AT command sequence, see
+ * uAtClientPipeline().
+ */
+typedef struct {
+    const char *pCommand;        /**< the complete AT command, e.g.
+                                      "AT+CMEE=2", without a command
+                                      delimiter. */
+    const char *pResponsePrefix; /**< the prefix of the information
+                                      response expected, e.g. "+CGMI:",
+                                      or NULL if there is none. */
+    void (*pResponseParser) (uAtClientHandle_t atHandle,
+                             void *pParameter); /**< a function that
+                                                     reads the information
+                                                     response once the
+                                                     prefix has been
+                                                     matched, may be NULL. */
+    void *pResponseParserParameter; /**< passed to pResponseParser. */
+    int32_t errorCode;           /**< populated by uAtClientPipeline()
+                                      with the outcome of this command,
+                                      zero on success else negative error
+                                      code. */
+} uAtClientPipelineCommand_t;
+
+/** The statistics kept for one AT command, see uAtClientStats_t.
+ */
+typedef struct {
+    char prefix[U_AT_CLIENT_STATS_COMMAND_PREFIX_MAX_LENGTH + 1]; /**< the
+                                  start of the AT command, up to
+                                  any '=' or '?', e.g. "AT+CGMI";
+                                  an empty string if this entry
+                                  is unused. */
+    uint32_t count;            /**< the number of times the command
+                                    was completed. */
+    uint32_t errorCount;       /**< the number of those times that
+                                    ended in error or timeout. */
+    uint64_t totalUs;          /**< the total time from the command
+                                    being started to its response
+                                    ending in microseconds. */
+    uint32_t maxUs;            /**< the longest such time in
+                                    microseconds. */
+    uint32_t latencyHistogram[U_AT_CLIENT_STATS_LATENCY_NUM_BINS]; /**< see
+                                    U_AT_CLIENT_STATS_LATENCY_NUM_BINS. */
+} uAtClientStatsCommand_t;
+
+/** The statistics kept for one tag, see uAtClientStatsTagSet().
+ */
+typedef struct {
+    const char *pTag;          /**< the tag, NULL if this entry is
+                                    unused. */
+    uint32_t numLocks;         /**< the number of times the AT client
+                                    was locked under this tag. */
+    uint32_t numCommands;      /**< the number of AT commands started. */
+    uint32_t txBytes;          /**< bytes written to the stream. */
+    uint32_t rxBytes;          /**< bytes read from the stream. */
+    uint32_t lockedMs;         /**< the total time from lock to unlock. */
+    uint32_t lockWaitMs;       /**< the total time spent waiting for
+                                    the lock, i.e. for another user of
+                                    the AT client to finish. */
+} uAtClientStatsTag_t;
+
+/** Run-time statistics for an AT client, only collected if
+ * U_CFG_AT_CLIENT_STATS is defined; see uAtClientStatsGet().
+ * All times are in milliseconds.
+ */
+typedef struct {
+    uint32_t txBytes;          /**< bytes written to the stream, before
+                                    any transmit intercept function. */
+    uint32_t rxBytes;          /**< bytes read from the stream, before
+                                    any receive intercept function. */
+    uint32_t numUrcs;          /**< the number of URCs handled. */
+    uint32_t urcHandlerMs;     /**< the total time spent in URC handlers. */
+    uint32_t numBufferFull;    /**< the number of times the receive buffer
+                                    was found full and had to be reset,
+                                    losing data. */
+    uint32_t numReadStalls;    /**< the number of times a read from the
+                                    stream had to wait for data to
+                                    arrive. */
+    uint32_t readStallMs;      /**< the total time spent in those waits. */
+    uint32_t numCommandsUntracked; /**< the number of commands completed
+                                        for which there was no room in
+                                        command[]. */
+    uAtClientStatsCommand_t command[U_AT_CLIENT_STATS_NUM_COMMANDS]; /**< per
+                                                                          command
+                                                                          statistics. */
+    uAtClientStatsTag_t tag[U_AT_CLIENT_STATS_NUM_TAGS]; /**< per tag
+                                                              statistics. */
+    uAtClientStatsTag_t untagged; /**< statistics for use of the AT client
+                                       without a tag, or by a tag for which
+                                       there was no room in tag[]; pTag
+                                       is always NULL. */
+} uAtClientStats_t;
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: INITIALISATION AND CONFIGURATION
  * -------------------------------------------------------------- */
@@ -615,6 +822,76 @@ int32_t uAtClientDelayGet(const uAtClientHandle_t atHandle);
 void uAtClientDelaySet(uAtClientHandle_t atHandle,
                        int32_t delayMs);
 
+/** Switch adaptive pacing of AT commands on or off; it is off
+ * by default.  With adaptive pacing on, the delay between ending
+ * one AT command and starting the next starts out as the value
+ * set by uAtClientDelaySet() and is reduced by
+ * #U_AT_CLIENT_ADAPTIVE_DELAY_STEP_MS, down to minDelayMs, each
+ * time the AT server responds to a command (with `OK` or an error).
+ * Should a command time out the delay returns to the value set by
+ * uAtClientDelaySet(), since the AT server may not have been ready
+ * for it, and the reduction begins again.  Use this only with
+ * modules that are known to tolerate a delay of minDelayMs.
+ *
+ * @param atHandle    the handle of the AT client.
+ * @param minDelayMs  the minimum delay in milliseconds; use
+ *                    a negative value to switch adaptive pacing
+ *                    off.
+ */
+void uAtClientDelayAdaptiveSet(uAtClientHandle_t atHandle,
+                               int32_t minDelayMs);
+
+/** Allow the receive buffer of an AT client to grow beyond the
+ * size given to uAtClientAdd(); growth is off by default.  With
+ * growth on, when the receive buffer is found to be full in the
+ * middle of a line (e.g. a long URC or information response),
+ * rather than the line being lost or handed over in parts, the
+ * receive buffer is grown by stepSizeBytes, up to maxSizeBytes.
+ * Once the extra room has gone unused for
+ * #U_AT_CLIENT_RECEIVE_BUFFER_SHRINK_IDLE_MS the receive buffer is
+ * shrunk back to its original size, at the end of an AT command or
+ * URC.  This means that an AT client may be added with a receive
+ * buffer that suits the lines it usually sees, rather than the
+ * longest it might ever see; uAtClientReceiveBufferPeakGet() may
+ * be used to choose the sizes.
+ *
+ * Growth is only possible where the receive buffer was allocated
+ * by the AT client, i.e. pReceiveBuffer was NULL in the call to
+ * uAtClientAdd().  Note that a pointer obtained from
+ * uAtClientReadBytesPeek() or uAtClientReadSpan() is invalidated
+ * by any further read from the AT client, which may grow the
+ * receive buffer.
+ *
+ * @param atHandle      the handle of the AT client.
+ * @param maxSizeBytes  the largest the receive buffer may become,
+ *                      in the same terms as the receiveBufferSize
+ *                      parameter of uAtClientAdd(), i.e. including
+ *                      #U_AT_CLIENT_BUFFER_OVERHEAD_BYTES; use zero
+ *                      to switch growth off.
+ * @param stepSizeBytes the amount to grow the receive buffer by
+ *                      each time; cannot be zero unless
+ *                      maxSizeBytes is zero.
+ * @return              zero on success else negative error code;
+ *                      #U_ERROR_COMMON_NOT_SUPPORTED if the receive
+ *                      buffer was not allocated by the AT client.
+ */
+int32_t uAtClientReceiveBufferGrowSet(uAtClientHandle_t atHandle,
+                                      size_t maxSizeBytes,
+                                      size_t stepSizeBytes);
+
+/** Get the largest amount of the receive buffer of an AT client
+ * that has ever been in use, useful in choosing the receiveBufferSize
+ * parameter of uAtClientAdd() or the parameters of
+ * uAtClientReceiveBufferGrowSet().
+ *
+ * @param atHandle  the handle of the AT client.
+ * @return          the peak receive buffer usage in the same terms
+ *                  as the receiveBufferSize parameter of
+ *                  uAtClientAdd(), i.e. including
+ *                  #U_AT_CLIENT_BUFFER_OVERHEAD_BYTES.
+ */
+int32_t uAtClientReceiveBufferPeakGet(const uAtClientHandle_t atHandle);
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: SEND AN AT COMMAND
  * -------------------------------------------------------------- */
@@ -731,6 +1008,29 @@ size_t uAtClientWriteBytes(uAtClientHandle_t atHandle,
                            size_t lengthBytes,
                            bool standalone);
 
+/** As uAtClientWriteBytes() but writing a number of fragments of
+ * data, e.g. a header and a payload, as though they were one
+ * contiguous block, without the caller having to copy them
+ * together first.  If there is a transmit intercept function
+ * (see uAtClientStreamInterceptTx()) it is only flushed after
+ * the last fragment, so that an intercept function which frames
+ * data (e.g. EDM or chip-to-chip security) can send the lot as
+ * a single frame.
+ *
+ * @param atHandle     the handle of the AT client.
+ * @param[in] pIoVec   an array of fragments to write, in order;
+ *                     fragments with zero length are skipped.
+ * @param numIoVec     the number of entries in pIoVec.
+ * @param standalone   as for uAtClientWriteBytes(), a delimiter
+ *                     being inserted, if required, only before
+ *                     the first fragment.
+ * @return             the total number of bytes written.
+ */
+size_t uAtClientWriteBytesV(uAtClientHandle_t atHandle,
+                            const uAtClientIoVec_t *pIoVec,
+                            size_t numIoVec,
+                            bool standalone);
+
 
 /** Write a part of a string argument to AT command sequence.
  * Used after uAtClientCommandStart() has been called to
@@ -774,6 +1074,31 @@ void uAtClientWritePartialString(uAtClientHandle_t atHandle,
  */
 void uAtClientCommandStop(uAtClientHandle_t atHandle);
 
+/** Format a complete AT command, e.g. `AT+USOST=0,"1.2.3.4",5000,64`,
+ * and send it, with the command delimiter, in a single write; this
+ * is equivalent to uAtClientCommandStart() followed by the
+ * uAtClientWritexxx() calls for each parameter and then
+ * uAtClientCommandStop(), but costs one call into the stream (or
+ * intercept function) rather than one per parameter and delimiter.
+ * The format string and arguments are as for printf() and are
+ * checked against each other at compile time where the compiler
+ * supports it; note that the caller is responsible for the commas
+ * between parameters and for any quotes around string parameters.
+ * The formatted command, not including the delimiter, must be no
+ * longer than #U_AT_CLIENT_COMMANDF_MAX_LENGTH_BYTES, else nothing
+ * is sent and the AT client error is set to
+ * #U_ERROR_COMMON_NO_MEMORY.  Usually followed by
+ * uAtClientResponseStart() to read the response from the AT
+ * server.  The stream must be locked with a call to
+ * uAtClientLock() before this function is called.
+ *
+ * @param atHandle     the handle of the AT client.
+ * @param[in] pFormat  the printf()-style format string.
+ * @param ...          the arguments to pFormat.
+ */
+void uAtClientCommandf(uAtClientHandle_t atHandle,
+                       const char *pFormat, ...) U_PRINTF_FORMAT(2, 3);
+
 /** As uAtClientCommandStop() but ALSO terminates the
  * entire AT command sequence by looking for the `OK` or
  * `ERROR` response from the AT server.  Use this with
@@ -785,6 +1110,39 @@ void uAtClientCommandStop(uAtClientHandle_t atHandle);
  */
 void uAtClientCommandStopReadResponse(uAtClientHandle_t atHandle);
 
+/** Send a sequence of simple AT commands without waiting for the
+ * response to one command before sending the next: up to windowSize
+ * commands are written back-to-back and then the responses are
+ * matched, in order, against the outstanding commands, a new command
+ * being written each time a response is completed.  This removes the
+ * module turnaround time from every command but the first, which is
+ * useful for batches of configuration commands.
+ *
+ * Must be called between uAtClientLock() and uAtClientUnlock(); the
+ * AT timeout applies to each response separately.  An `ERROR` response
+ * to one command is recorded in the errorCode field of its entry and
+ * does not stop the sequence; a timeout does, all remaining entries
+ * being marked as failed and the error being left in place for
+ * uAtClientUnlock() to return.  Only use this with commands that do
+ * not change the state of the AT interface (e.g. baud rate) and where
+ * the module is known to buffer windowSize commands.
+ *
+ * @param atHandle       the handle of the AT client.
+ * @param[in,out] pCommands the commands to send, the errorCode fields
+ *                       of which will be populated.
+ * @param numCommands    the number of entries at pCommands.
+ * @param windowSize     the maximum number of commands that may be
+ *                       outstanding at any one time; 1 gives the same
+ *                       behaviour as sending the commands one by one.
+ * @return               zero if all of the commands succeeded, else
+ *                       the error code of the first command that
+ *                       failed.
+ */
+int32_t uAtClientPipeline(uAtClientHandle_t atHandle,
+                          uAtClientPipelineCommand_t *pCommands,
+                          size_t numCommands,
+                          size_t windowSize);
+
 /** Start waiting for the response to an AT command that
  * is more than a simple `OK` or `ERROR` (which would be
  * handled by calling uAtClientCommandStopReadResponse()).
@@ -920,6 +1278,86 @@ int32_t uAtClientReadBytes(uAtClientHandle_t atHandle,
                            char *pBuffer, size_t lengthBytes,
                            bool standalone);
 
+/** Borrow a pointer to the unread bytes of the received AT
+ * response stream rather than copying them out as
+ * uAtClientReadBytes() does; this allows, for instance,
+ * a large block of hex-encoded data to be decoded straight
+ * from the AT client receive buffer into an application
+ * buffer.  Neither delimiters nor stop tags are obeyed:
+ * use this only after uAtClientIgnoreStopTag() or when the
+ * bytes are known not to contain the stop tag (e.g. hex).
+ * If fewer than lengthBytes are currently unread the AT client
+ * will first try to bring more data into the receive buffer,
+ * blocking for up to the AT timeout only if nothing at all
+ * is unread.  The bytes are NOT consumed; call
+ * uAtClientReadBytesConsume() to do that.  The pointer
+ * returned is only valid while the stream remains locked
+ * and until the next call into the AT client for this
+ * atHandle other than uAtClientReadBytesConsume().
+ *
+ * @param atHandle     the handle of the AT client.
+ * @param[out] ppData  a pointer to a place to put the
+ *                     pointer to the unread bytes; cannot
+ *                     be NULL.
+ * @param lengthBytes  the maximum number of bytes wanted.
+ * @return             the number of contiguous bytes that
+ *                     may be read at *ppData, which may be
+ *                     less than lengthBytes, or negative
+ *                     error code.
+ */
+int32_t uAtClientReadBytesPeek(uAtClientHandle_t atHandle,
+                               const char **ppData,
+                               size_t lengthBytes);
+
+/** Consume bytes from the received AT response stream that
+ * were returned by uAtClientReadBytesPeek().
+ *
+ * @param atHandle     the handle of the AT client.
+ * @param lengthBytes  the number of bytes to consume; if this
+ *                     is larger than the number of bytes
+ *                     returned by the last call to
+ *                     uAtClientReadBytesPeek() only that
+ *                     number will be consumed.
+ */
+void uAtClientReadBytesConsume(uAtClientHandle_t atHandle,
+                               size_t lengthBytes);
+
+/** Read the next field (or, if wholeLine is true, the rest
+ * of the line) of an information response as a span that
+ * points straight into the receive buffer of the AT client,
+ * rather than copying it out as uAtClientReadString() does;
+ * this allows responses of any length, e.g. the lists returned
+ * by AT+COPS=? or AT+ULSTFILE=, to be parsed field by field
+ * with no intermediate storage and a small receive buffer.
+ * Should be called after uAtClientResponseStart(); the
+ * receive buffer is re-filled, blocking for up to the AT
+ * timeout, as necessary.  The bytes are returned raw,
+ * including any quotation marks, though a delimiter inside
+ * quotation marks does not end a field; neither the delimiter
+ * nor the stop tag is included.  If a field is longer than
+ * the receive buffer can hold it is returned in pieces, each
+ * but the last with isPartial set.  When a span is returned
+ * with isLast set the stop tag has been consumed: call
+ * uAtClientResponseStart() to move to the next line or
+ * uAtClientResponseStop() to finish.  The span is only valid
+ * while the stream remains locked and until the next call
+ * into the AT client for this atHandle.
+ *
+ * @param atHandle    the handle of the AT client.
+ * @param[out] pSpan  a place to put the span; cannot be NULL.
+ * @param wholeLine   if true then delimiters are ignored and
+ *                    the span runs to the stop tag.
+ * @return            the number of bytes in the span, which
+ *                    may be zero for an empty field, or
+ *                    negative error code; in particular
+ *                    #U_ERROR_COMMON_NOT_FOUND is returned,
+ *                    without setting the AT client error, if
+ *                    the stop tag has already been consumed.
+ */
+int32_t uAtClientReadSpan(uAtClientHandle_t atHandle,
+                          uAtClientSpan_t *pSpan,
+                          bool wholeLine);
+
 /** Marks the end of an AT response, should be called
  * after uAtClientResponseStart() when all of the
  * wanted parameters have been read.  The remainder of
@@ -1091,6 +1529,30 @@ int32_t uAtClientCallback(uAtClientHandle_t atHandle,
                           void (*pCallback) (uAtClientHandle_t, void *),
                           void *pCallbackParam);
 
+/** By default the callbacks of all AT clients, those queued with
+ * uAtClientCallback() and the consecutive timeouts callback, run
+ * in a single task that is shared between all AT clients, hence a
+ * burst of callbacks from one AT client (e.g. one talking to a
+ * Wi-Fi module) will hold up those of another (e.g. one talking
+ * to a cellular module).  Call this function to give an AT client
+ * a callback task of its own.  Note that URCs are already handled
+ * in a task belonging to each stream, this is only about the
+ * callbacks that URC handlers may launch.  Any callbacks still
+ * queued in a previous task of this AT client's own may be lost
+ * when it is closed, hence this is best called straight after
+ * uAtClientAdd().  Must not be called from a callback.
+ *
+ * @param atHandle        the handle of the AT client.
+ * @param stackSizeBytes  the stack size of the task; use zero to
+ *                        return to using the shared task.
+ * @param priority        the priority of the task, see
+ *                        #U_AT_CLIENT_CALLBACK_TASK_PRIORITY.
+ * @return                zero on success else negative error code.
+ */
+int32_t uAtClientCallbackTaskSet(uAtClientHandle_t atHandle,
+                                 size_t stackSizeBytes,
+                                 int32_t priority);
+
 /** Get the stack high watermark for the task at the end of the
  * AT callback event queue, the minimum amount of free stack
  * space.  If this gets close to zero you either need to do less
@@ -1197,6 +1659,23 @@ void uAtClientDeviceErrorGet(uAtClientHandle_t atHandle,
 int32_t uAtClientStreamGet(uAtClientHandle_t atHandle,
                            uAtClientStream_t *pStreamType);
 
+/** Change the underlying stream of an AT client, e.g. to move
+ * it from a UART onto a multiplexer channel carried over that
+ * UART; the URC handlers and all other settings of the AT client
+ * are retained but any received data not yet processed is
+ * discarded.  The caller must not have the AT client locked.
+ *
+ * @param atHandle      the handle of the AT client.
+ * @param streamHandle  the handle of the new stream.
+ * @param streamType    the type of the new stream.
+ * @return              zero on success else negative error code,
+ *                      in which case the AT client remains on its
+ *                      original stream.
+ */
+int32_t uAtClientStreamSet(uAtClientHandle_t atHandle,
+                           int32_t streamHandle,
+                           uAtClientStream_t streamType);
+
 /** Add a function that will intercept the transmitted
  * data before it is presented to the stream and may return
  * a modified buffer or hold onto the data until a whole
@@ -1432,6 +1911,47 @@ int32_t uAtClientSetActivityPin(uAtClientHandle_t atHandle,
  */
 int32_t uAtClientGetActivityPin(const uAtClientHandle_t atHandle);
 
+/** Get the run-time statistics of an AT client; these are only
+ * collected if U_CFG_AT_CLIENT_STATS is defined.  The latency of
+ * a command is measured from uAtClientCommandStart() to the end
+ * of uAtClientResponseStop(); for commands sent with
+ * uAtClientPipeline() it is measured from the end of the previous
+ * response, i.e. it is the effective cost of the command in the
+ * pipeline.
+ *
+ * @param atHandle     the handle of the AT client.
+ * @param[out] pStats  a place to put the statistics; cannot be NULL.
+ * @return             zero on success else negative error code;
+ *                     U_ERROR_COMMON_NOT_SUPPORTED if
+ *                     U_CFG_AT_CLIENT_STATS is not defined.
+ */
+int32_t uAtClientStatsGet(const uAtClientHandle_t atHandle,
+                          uAtClientStats_t *pStats);
+
+/** Reset the run-time statistics of an AT client to zero.
+ *
+ * @param atHandle  the handle of the AT client.
+ */
+void uAtClientStatsReset(uAtClientHandle_t atHandle);
+
+/** Tag subsequent use of an AT client by the calling task, so that
+ * the statistics (see uAtClientStats_t.tag[]) attribute the AT
+ * client locks, commands, bytes and time to, for instance, the
+ * public API function that uses them.  The tag applies to
+ * uAtClientLock()/uAtClientUnlock() pairs begun by the calling task
+ * until the tag is changed or another task sets a tag; use of the
+ * AT client by any other task (e.g. URC handlers) is counted in
+ * uAtClientStats_t.untagged.  Does nothing if U_CFG_AT_CLIENT_STATS
+ * is not defined.
+ *
+ * @param atHandle  the handle of the AT client.
+ * @param[in] pTag  the null-terminated tag, e.g. __func__; the
+ *                  pointer is stored so the string must remain
+ *                  valid while the statistics are in use, NULL to
+ *                  tag nothing.
+ */
+void uAtClientStatsTagSet(uAtClientHandle_t atHandle, const char *pTag);
+
 #ifdef __cplusplus
 }
 #endif
@@ -35,7 +35,8 @@
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
 #include "string.h"    // memcpy(), strcmp(), strcspn(), strspm()
-#include "stdio.h"     // snprintf()
+#include "stdio.h"     // snprintf(), vsnprintf()
+#include "stdarg.h"    // va_list
 #include "ctype.h"     // isprint()
 
 #include "u_cfg_sw.h"
@@ -61,6 +62,12 @@
 #include "u_short_range_module_type.h"
 #include "u_short_range.h"
 #include "u_short_range_edm_stream.h"
+#include "u_cell_mux.h"
+
+#ifdef U_CFG_AT_CLIENT_TRACE
+# include "u_log_ram.h"
+#endif
+#include "u_log_ram_trace.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -216,11 +223,29 @@
  */
 #define U_AT_CLIENT_MAGIC_NUMBER_START 1
 
+#ifndef U_AT_CLIENT_URC_HASH_TABLE_SIZE
+/** The number of buckets in the hash table used to find the URC
+ * handler for an incoming line; must be a power of two.
+ */
+# define U_AT_CLIENT_URC_HASH_TABLE_SIZE 16
+#endif
+
+/** The maximum number of characters from the start of a URC
+ * prefix that are hashed to select a bucket in the URC hash
+ * table; the number actually used is the length of the shortest
+ * registered URC prefix, capped at this value.
+ */
+#define U_AT_CLIENT_URC_HASH_KEY_MAX_LENGTH 8
+
 // Do some cross-checking
 #if (U_AT_CLIENT_CALLBACK_TASK_PRIORITY >= U_AT_CLIENT_URC_TASK_PRIORITY)
 # error U_AT_CLIENT_CALLBACK_TASK_PRIORITY must be less than U_AT_CLIENT_URC_TASK_PRIORITY
 #endif
 
+#if ((U_AT_CLIENT_URC_HASH_TABLE_SIZE & (U_AT_CLIENT_URC_HASH_TABLE_SIZE - 1)) != 0)
+# error U_AT_CLIENT_URC_HASH_TABLE_SIZE must be a power of two
+#endif
+
 #ifdef U_CFG_AT_CLIENT_DETAILED_DEBUG
 /** Macros for detailed debugging of buffering behaviour.
  * This one for use inside the bufferFill() function.
@@ -252,6 +277,46 @@
 # define LOG_IF(cond, place)
 #endif
 
+#ifdef U_CFG_AT_CLIENT_TRACE
+/** Macro to put an event into the binary trace, which is
+ * the RAM log of port/platform/common/log_ram; cheap enough
+ * to be left on in the field, the application must call
+ * uLogRamInit() for anything to be recorded.
+ */
+# define TRACE(event, parameter) uLogRam(U_LOG_RAM_EVENT_AT_##event, (int32_t) (parameter))
+#else
+# define TRACE(event, parameter)
+#endif
+
+#ifdef U_CFG_AT_CLIENT_STATS
+/** Macro to add to one of the fields of uAtClientStats_t.
+ */
+# define STATS_ADD(pClient, field, value) (pClient)->stats.field += (uint32_t) (value)
+
+/** Macro to record the start of an AT command in the statistics.
+ */
+# define STATS_COMMAND_START(pClient, pCommand) statsCommandStart(pClient, pCommand)
+
+/** Macro to record the end of an AT command in the statistics.
+ */
+# define STATS_COMMAND_STOP(pClient) statsCommandStop(pClient)
+
+/** Macro to add to one of the fields of uAtClientStats_t that is
+ * also kept per tag.
+ */
+# define STATS_ADD_TAGGED(pClient, field, value) {                                                   \
+                                                    (pClient)->stats.field += (uint32_t) (value);      \
+                                                    if ((pClient)->pStatsTagLocked != NULL) {          \
+                                                        (pClient)->pStatsTagLocked->field += (uint32_t) (value); \
+                                                    }                                                  \
+                                                }
+#else
+# define STATS_ADD(pClient, field, value)
+# define STATS_ADD_TAGGED(pClient, field, value)
+# define STATS_COMMAND_START(pClient, pCommand)
+# define STATS_COMMAND_STOP(pClient)
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -284,6 +349,7 @@ typedef struct uAtClientUrc_t {
     void (*pHandler) (uAtClientHandle_t, void *); /** The handler to call if pPrefix is matched. */
     void *pHandlerParam;       /** The parameter to pass to pHandler. */
     struct uAtClientUrc_t *pNext;
+    struct uAtClientUrc_t *pNextInBucket; /** The next URC in the same hash bucket. */
 } uAtClientUrc_t;
 
 /** The definition of a tag.
@@ -381,6 +447,11 @@ typedef struct uAtClientInstance_t {
     uPortMutexHandle_t mutex; /** Mutex for threadsafeness. */
     uPortMutexHandle_t streamMutex; /** Mutex for the data stream. */
     uPortMutexHandle_t urcPermittedMutex; /** Mutex that we can use to avoid trampling on a URC. */
+    int32_t eventQueueHandle; /** The event queue for callbacks from this AT client, negative
+                                  if the shared gEventQueueHandle is used. */
+    uPortSemaphoreHandle_t rxSemaphore; /** Given when data is received on the stream, NULL
+                                            if one could not be created, in which case
+                                            the stream is polled. */
     uAtClientReceiveBuffer_t *pReceiveBuffer; /** Pointer to the receive buffer structure. */
     bool debugOn; /** Whether general debug is on or off. */
     bool printAtOn; /** Whether printing of AT commands and responses is on or off. */
@@ -391,16 +462,30 @@ typedef struct uAtClientInstance_t {
     void (*pConsecutiveTimeoutsCallback) (uAtClientHandle_t, int32_t *);
     char delimiter; /** The delimiter used between parameters. */
     int32_t delayMs; /** The delay from ending one AT command to starting the next. */
+    int32_t delayMinMs; /** The minimum delay when pacing adaptively, negative if not. */
+    int32_t delayLearntMs; /** The delay currently in use when pacing adaptively. */
     uErrorCode_t error; /** The current error status. */
     uAtClientDeviceError_t deviceError; /** The error reported by the AT server. */
     uAtClientScope_t scope; /** The scope, where we're at in the AT command. */
     uAtClientTag_t stopTag; /** The stop tag for the current scope. */
+    bool spanInQuotes; /** True if uAtClientReadSpan() has returned part of a field that ended inside quotes. */
+    size_t peekLength; /** Bytes returned by uAtClientReadBytesPeek() not yet consumed. */
     uAtClientUrc_t *pUrcList; /** Linked-list anchor for URC handlers. */
+    uAtClientUrc_t *pUrcHashTable[U_AT_CLIENT_URC_HASH_TABLE_SIZE]; /** Hash buckets indexing pUrcList. */
+    size_t urcHashKeyLength; /** The number of prefix characters hashed to index pUrcHashTable. */
     int32_t lastResponseStopMs; /** The time the last response ended in milliseconds. */
     int32_t lockTimeMs; /** The time when the stream was locked. */
     int32_t lastTxTimeMs; /** The time when the last transmit activity was carried out, set to -1 initially. */
     size_t urcMaxStringLength; /** The longest URC string to monitor for. */
     size_t maxRespLength; /** The max length of OK, (CME) (CMS) ERROR and URCs. */
+    bool receiveBufferIsMalloced; /** True if the receive buffer was allocated by us, a copy
+                                      that can be read without locking the stream. */
+    size_t receiveBufferSizeInitial; /** The data buffer size as given to uAtClientAdd(). */
+    size_t receiveBufferSizeMax; /** The size the data buffer may grow to, zero for no growth. */
+    size_t receiveBufferStepSize; /** The amount to grow the data buffer by each time. */
+    size_t receiveBufferPeak; /** The most there has ever been in the data buffer. */
+    int32_t receiveBufferUsedMs; /** The time the data buffer was last fuller than
+                                     receiveBufferSizeInitial. */
     bool delimiterRequired; /** Is a delimiter to be inserted before the next parameter or not. */
     uAtClientMutexStack_t lockedStreamMutexStack; /** A place to store locked stream mutexes. */
     const char *(*pInterceptTx) (uAtClientHandle_t,
@@ -418,6 +503,19 @@ typedef struct uAtClientInstance_t {
                                    as its fourth parameter. */
     uAtClientWakeUp_t *pWakeUp; /** Pointer to a wake-up handler structure. */
     uAtClientActivityPin_t *pActivityPin; /** Pointer to an activity pin structure. */
+#ifdef U_CFG_AT_CLIENT_STATS
+    uAtClientStats_t stats; /** Run-time statistics. */
+    uAtClientStatsCommand_t *pStatsCommand; /** The entry in stats.command[] of the command
+                                                in progress, NULL if there is none. */
+    bool statsCommandInProgress; /** True if a command is in progress. */
+    int64_t statsCommandStartUs; /** The time the command in progress started. */
+    const char *pStatsTag; /** The tag set by uAtClientStatsTagSet(). */
+    uPortTaskHandle_t statsTagTask; /** The task that set pStatsTag. */
+    uAtClientStatsTag_t *pStatsTagLocked; /** The entry in stats.tag[], or stats.untagged,
+                                              of the current lock, NULL if not locked. */
+    int32_t statsLockDepth; /** Nesting count of uAtClientLock(). */
+    int32_t statsLockStartMs; /** The time the outermost lock was obtained. */
+#endif
     struct uAtClientInstance_t *pNext;
 } uAtClientInstance_t;
 
@@ -704,6 +802,67 @@ static void removeAtClientInstance(const uAtClientInstance_t *pClient)
     }
 }
 
+// Forward declaration.
+static void urcCallback(int32_t streamHandle, uint32_t eventBitmask,
+                        void *pParameters);
+
+// Set the event handler for characters received on the stream
+// of an AT client.
+static int32_t streamCallbackSet(uAtClientInstance_t *pClient)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    switch (pClient->streamType) {
+        case U_AT_CLIENT_STREAM_TYPE_UART:
+            errorCode = uPortUartEventCallbackSet(pClient->streamHandle,
+                                                  U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                                  urcCallback, pClient,
+                                                  U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES,
+                                                  U_AT_CLIENT_URC_TASK_PRIORITY);
+            if ((errorCode == 0) && (U_AT_CLIENT_STREAM_EVENT_DELIMITER >= 0)) {
+                // Wake up for whole lines where the platform can do
+                // that; if it can't, no matter
+                uPortUartEventDelimiterSet(pClient->streamHandle,
+                                           U_AT_CLIENT_STREAM_EVENT_DELIMITER,
+                                           U_AT_CLIENT_STREAM_EVENT_DELIMITER_TIMEOUT_MS);
+            }
+            break;
+        case U_AT_CLIENT_STREAM_TYPE_EDM:
+            errorCode = uShortRangeEdmStreamAtCallbackSet(pClient->streamHandle,
+                                                          urcCallback, pClient);
+            break;
+        case U_AT_CLIENT_STREAM_TYPE_CMUX:
+            errorCode = uCellMuxStreamCallbackSet(pClient->streamHandle,
+                                                  urcCallback, pClient,
+                                                  U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES,
+                                                  U_AT_CLIENT_URC_TASK_PRIORITY);
+            break;
+        default:
+            break;
+    }
+
+    return errorCode;
+}
+
+// Remove the event handler for characters received on the
+// stream of an AT client.
+static void streamCallbackRemove(const uAtClientInstance_t *pClient)
+{
+    switch (pClient->streamType) {
+        case U_AT_CLIENT_STREAM_TYPE_UART:
+            uPortUartEventCallbackRemove(pClient->streamHandle);
+            break;
+        case U_AT_CLIENT_STREAM_TYPE_EDM:
+            uShortRangeEdmStreamAtCallbackRemove(pClient->streamHandle);
+            break;
+        case U_AT_CLIENT_STREAM_TYPE_CMUX:
+            uCellMuxStreamCallbackRemove(pClient->streamHandle);
+            break;
+        default:
+            break;
+    }
+}
+
 // Remove an AT client.
 // gMutex should be locked before this is called.
 static void removeClient(uAtClientInstance_t *pClient)
@@ -733,15 +892,12 @@ static void removeClient(uAtClientInstance_t *pClient)
     // Remove the URC event handler, which may be running
     // asynchronous stuff and so has to be flushed and
     // closed before we mess with anything else
-    switch (pClient->streamType) {
-        case U_AT_CLIENT_STREAM_TYPE_UART:
-            uPortUartEventCallbackRemove(pClient->streamHandle);
-            break;
-        case U_AT_CLIENT_STREAM_TYPE_EDM:
-            uShortRangeEdmStreamAtCallbackRemove(pClient->streamHandle);
-            break;
-        default:
-            break;
+    streamCallbackRemove(pClient);
+
+    // Likewise any callback event queue of its own
+    if (pClient->eventQueueHandle >= 0) {
+        uPortEventQueueClose(pClient->eventQueueHandle);
+        pClient->eventQueueHandle = -1;
     }
 
     // Free any URC handlers it had.
@@ -754,6 +910,12 @@ static void removeClient(uAtClientInstance_t *pClient)
     // Remove any activity pin
     uPortFree(pClient->pActivityPin);
 
+    // The event handler is gone so no-one can
+    // give the receive semaphore any more
+    if (pClient->rxSemaphore != NULL) {
+        uPortSemaphoreDelete(pClient->rxSemaphore);
+    }
+
     // Free the receive buffer if it was allocated.
     if (pClient->pReceiveBuffer->isMalloced) {
         uPortFree(pClient->pReceiveBuffer);
@@ -1000,6 +1162,20 @@ static void clearError(uAtClientInstance_t *pClient)
     setError(pClient, U_ERROR_COMMON_SUCCESS);
 }
 
+// Get the event queue that callbacks for the given AT client
+// should be sent to.
+// gMutexEventQueue should be locked before this is called.
+static int32_t eventQueueHandleGet(const uAtClientInstance_t *pClient)
+{
+    int32_t eventQueueHandle = gEventQueueHandle;
+
+    if (pClient->eventQueueHandle >= 0) {
+        eventQueueHandle = pClient->eventQueueHandle;
+    }
+
+    return eventQueueHandle;
+}
+
 // Increment the number of consecutive timeouts
 // and call the callback if there is one
 static void consecutiveTimeout(uAtClientInstance_t *pClient)
@@ -1009,6 +1185,8 @@ static void consecutiveTimeout(uAtClientInstance_t *pClient)
     U_PORT_MUTEX_LOCK(gMutexEventQueue);
 
     pClient->numConsecutiveAtTimeouts++;
+    TRACE(TIMEOUT, pClient->numConsecutiveAtTimeouts);
+    U_LOG_RAM_TRACE_INSTANT(AT_CLIENT, AT_TIMEOUT, pClient->numConsecutiveAtTimeouts);
     if (pClient->pConsecutiveTimeoutsCallback != NULL) {
         // pConsecutiveTimeoutsCallback second parameter
         // is an int32_t pointer but of course the generic
@@ -1018,7 +1196,7 @@ static void consecutiveTimeout(uAtClientInstance_t *pClient)
         cb.atHandle = (uAtClientHandle_t) pClient;
         cb.pParam = &(pClient->numConsecutiveAtTimeouts);
         cb.atClientMagicNumber = pClient->magicNumber;
-        uPortEventQueueSend(gEventQueueHandle, &cb, sizeof(cb));
+        uPortEventQueueSend(eventQueueHandleGet(pClient), &cb, sizeof(cb));
     }
 
     U_PORT_MUTEX_UNLOCK(gMutexEventQueue);
@@ -1050,6 +1228,148 @@ static int32_t pollTimeRemaining(int32_t atTimeoutMs,
     return (int32_t) timeRemainingMs;
 }
 
+// Wait for more data to arrive on the stream, for at most
+// maxWaitMs.  This waits on rxSemaphore, which is given by
+// the stream's data-received event, unless we are running in
+// that event callback ourselves (in which case the semaphore
+// can't be given until we return) or there is no semaphore,
+// in which case we fall back to blocking for the retry delay.
+static void readWait(uAtClientInstance_t *pClient,
+                     bool eventIsCallback,
+                     int32_t maxWaitMs)
+{
+#ifdef U_CFG_AT_CLIENT_STATS
+    int32_t startMs = uPortGetTickTimeMs();
+#endif
+
+    if ((pClient->rxSemaphore != NULL) && !eventIsCallback) {
+        if (maxWaitMs > U_AT_CLIENT_STREAM_READ_EVENT_WAIT_MAX_MS) {
+            maxWaitMs = U_AT_CLIENT_STREAM_READ_EVENT_WAIT_MAX_MS;
+        }
+        uPortSemaphoreTryTake(pClient->rxSemaphore, maxWaitMs);
+    } else {
+        uPortTaskBlock(U_AT_CLIENT_STREAM_READ_RETRY_DELAY_MS);
+    }
+
+    STATS_ADD(pClient, numReadStalls, 1);
+    STATS_ADD(pClient, readStallMs, uPortGetTickTimeMs() - startMs);
+}
+
+#ifdef U_CFG_AT_CLIENT_STATS
+// Note the start of an AT command, finding or allocating
+// its entry in the statistics.
+static void statsCommandStart(uAtClientInstance_t *pClient,
+                              const char *pCommand)
+{
+    char prefix[U_AT_CLIENT_STATS_COMMAND_PREFIX_MAX_LENGTH + 1] = {0};
+    uAtClientStatsCommand_t *pEntry = NULL;
+    size_t length = 0;
+
+    if (pCommand != NULL) {
+        while ((length < sizeof(prefix) - 1) && (pCommand[length] != 0) &&
+               (pCommand[length] != '=') && (pCommand[length] != '?')) {
+            prefix[length] = pCommand[length];
+            length++;
+        }
+        for (size_t x = 0; (pEntry == NULL) &&
+             (x < sizeof(pClient->stats.command) / sizeof(pClient->stats.command[0])); x++) {
+            if (pClient->stats.command[x].prefix[0] == 0) {
+                // Unused entry: claim it
+                pEntry = &(pClient->stats.command[x]);
+                memcpy(pEntry->prefix, prefix, sizeof(pEntry->prefix));
+            } else if (strcmp(pClient->stats.command[x].prefix, prefix) == 0) {
+                pEntry = &(pClient->stats.command[x]);
+            }
+        }
+    }
+
+    pClient->pStatsCommand = pEntry;
+    pClient->statsCommandInProgress = true;
+    pClient->statsCommandStartUs = uPortGetTickTimeUs();
+    if (pClient->pStatsTagLocked != NULL) {
+        pClient->pStatsTagLocked->numCommands++;
+    }
+}
+
+// Note the end of an AT command in the statistics.
+static void statsCommandStop(uAtClientInstance_t *pClient)
+{
+    uAtClientStatsCommand_t *pEntry = pClient->pStatsCommand;
+    uint32_t durationUs;
+    uint32_t durationMs;
+    size_t bin = 0;
+
+    if (pClient->statsCommandInProgress) {
+        if (pEntry != NULL) {
+            durationUs = (uint32_t) (uPortGetTickTimeUs() - pClient->statsCommandStartUs);
+            pEntry->count++;
+            if (pClient->error != U_ERROR_COMMON_SUCCESS) {
+                pEntry->errorCount++;
+            }
+            pEntry->totalUs += durationUs;
+            if (durationUs > pEntry->maxUs) {
+                pEntry->maxUs = durationUs;
+            }
+            // Bin 0 is < 16 ms, each bin after that doubling
+            durationMs = (durationUs / 1000) >> 4;
+            while ((durationMs > 0) && (bin < U_AT_CLIENT_STATS_LATENCY_NUM_BINS - 1)) {
+                durationMs >>= 1;
+                bin++;
+            }
+            pEntry->latencyHistogram[bin]++;
+        } else {
+            pClient->stats.numCommandsUntracked++;
+        }
+        pClient->pStatsCommand = NULL;
+        pClient->statsCommandInProgress = false;
+    }
+}
+
+// Note that the AT client has been locked, having waited
+// lockWaitMs for it, finding or allocating the entry for
+// the tag of the calling task.
+static void statsLock(uAtClientInstance_t *pClient, int32_t lockWaitMs)
+{
+    uAtClientStatsTag_t *pEntry = &(pClient->stats.untagged);
+    const char *pTag = pClient->pStatsTag;
+
+    if (pClient->statsLockDepth == 0) {
+        if ((pTag != NULL) && uPortTaskIsThis(pClient->statsTagTask)) {
+            for (size_t x = 0; x < sizeof(pClient->stats.tag) / sizeof(pClient->stats.tag[0]); x++) {
+                if (pClient->stats.tag[x].pTag == NULL) {
+                    // Unused entry: claim it
+                    pEntry = &(pClient->stats.tag[x]);
+                    pEntry->pTag = pTag;
+                    break;
+                } else if ((pClient->stats.tag[x].pTag == pTag) ||
+                           (strcmp(pClient->stats.tag[x].pTag, pTag) == 0)) {
+                    pEntry = &(pClient->stats.tag[x]);
+                    break;
+                }
+            }
+        }
+        pEntry->numLocks++;
+        pEntry->lockWaitMs += (uint32_t) lockWaitMs;
+        pClient->pStatsTagLocked = pEntry;
+        pClient->statsLockStartMs = uPortGetTickTimeMs();
+    }
+    pClient->statsLockDepth++;
+}
+
+// Note that the AT client has been unlocked.
+static void statsUnlock(uAtClientInstance_t *pClient)
+{
+    if (pClient->statsLockDepth > 0) {
+        pClient->statsLockDepth--;
+        if ((pClient->statsLockDepth == 0) && (pClient->pStatsTagLocked != NULL)) {
+            pClient->pStatsTagLocked->lockedMs += (uint32_t) (uPortGetTickTimeMs() -
+                                                              pClient->statsLockStartMs);
+            pClient->pStatsTagLocked = NULL;
+        }
+    }
+}
+#endif
+
 // Zero the buffer.
 // totalReset also clears out any buffered data that
 // may be awaiting processing by a receive intercept
@@ -1123,10 +1443,85 @@ static void bufferRewind(const uAtClientInstance_t *pClient)
     }
 }
 
+// Move the receive buffer to a new allocation with a data buffer
+// of the given size, which must be able to hold what is buffered.
+// The stream mutex must be locked before this is called and, if it
+// returns true, any pointer into the old receive buffer is invalid.
+static bool bufferResize(uAtClientInstance_t *pClient,
+                         size_t dataBufferSize)
+{
+    uAtClientReceiveBuffer_t *pBuffer = pClient->pReceiveBuffer;
+    uAtClientReceiveBuffer_t *pBufferNew = NULL;
+
+    if (pBuffer->isMalloced && (pBuffer->lengthBuffered <= dataBufferSize)) {
+        pBufferNew = (uAtClientReceiveBuffer_t *) pUPortMalloc(dataBufferSize +
+                                                               U_AT_CLIENT_BUFFER_OVERHEAD_BYTES);
+        if (pBufferNew != NULL) {
+            // Copy the management structure, including the opening
+            // marker, and whatever is buffered, then put the closing
+            // marker on the new end
+            memcpy(pBufferNew, pBuffer,
+                   sizeof(uAtClientReceiveBuffer_t) + pBuffer->lengthBuffered);
+            pBufferNew->dataBufferSize = dataBufferSize;
+            memcpy(U_AT_CLIENT_DATA_BUFFER_PTR(pBufferNew) + dataBufferSize,
+                   U_AT_CLIENT_MARKER, U_AT_CLIENT_MARKER_SIZE);
+            U_ASSERT(U_AT_CLIENT_GUARD_CHECK(pBufferNew));
+            pClient->pReceiveBuffer = pBufferNew;
+            uPortFree(pBuffer);
+        }
+    }
+
+    return (pBufferNew != NULL);
+}
+
+// Grow the receive buffer by a step, if it is allowed to grow.
+// The stream mutex must be locked before this is called and, if it
+// returns true, any pointer into the old receive buffer is invalid.
+static bool bufferGrow(uAtClientInstance_t *pClient)
+{
+    size_t dataBufferSize = pClient->pReceiveBuffer->dataBufferSize;
+    bool grown = false;
+
+    if (dataBufferSize < pClient->receiveBufferSizeMax) {
+        dataBufferSize += pClient->receiveBufferStepSize;
+        if (dataBufferSize > pClient->receiveBufferSizeMax) {
+            dataBufferSize = pClient->receiveBufferSizeMax;
+        }
+        grown = bufferResize(pClient, dataBufferSize);
+        if (grown) {
+            pClient->receiveBufferUsedMs = uPortGetTickTimeMs();
+            if (pClient->debugOn) {
+                uPortLog("U_AT_CLIENT_%d-%d: receive buffer grown to %d byte(s).\n",
+                         pClient->streamType, pClient->streamHandle,
+                         dataBufferSize);
+            }
+        }
+    }
+
+    return grown;
+}
+
+// Shrink the receive buffer back to its original size if it
+// has grown and the extra room has not been needed for a while.
+// The stream mutex must be locked before this is called and
+// there must be no pointers into the receive buffer in use.
+static void bufferShrinkIfIdle(uAtClientInstance_t *pClient)
+{
+    if ((pClient->pReceiveBuffer->dataBufferSize > pClient->receiveBufferSizeInitial) &&
+        (uPortGetTickTimeMs() - pClient->receiveBufferUsedMs >
+         U_AT_CLIENT_RECEIVE_BUFFER_SHRINK_IDLE_MS)) {
+        // Move anything unread to the start first; if it still
+        // doesn't fit we'll try again next time
+        bufferRewind(pClient);
+        bufferResize(pClient, pClient->receiveBufferSizeInitial);
+    }
+}
+
 // Read from the UART interface in nice coherent lines.
 static int32_t uartReadNoStutter(uAtClientInstance_t *pClient,
                                  uAtClientBlockState_t blockState,
-                                 int32_t atTimeoutMs)
+                                 int32_t atTimeoutMs,
+                                 bool eventIsCallback)
 {
     int32_t readLength = 0;
     int32_t thisReadLength;
@@ -1138,6 +1533,12 @@ static int32_t uartReadNoStutter(uAtClientInstance_t *pClient,
 
     // Retry the read until we're sure there's nothing
     do {
+        if ((pClient->rxSemaphore != NULL) && !eventIsCallback) {
+            // Anything received so far is about to be read,
+            // so any event that has already given the semaphore
+            // is of no interest to readWait()
+            uPortSemaphoreTryTake(pClient->rxSemaphore, 0);
+        }
         thisReadLength = uPortUartRead(pClient->streamHandle,
                                        pBuffer, bufferSize);
         if (thisReadLength > 0) {
@@ -1147,7 +1548,8 @@ static int32_t uartReadNoStutter(uAtClientInstance_t *pClient,
             if (blockState == U_AT_CLIENT_BLOCK_STATE_NOTHING_RECEIVED) {
                 // Got something: now wait for more
                 blockState = U_AT_CLIENT_BLOCK_STATE_WAIT_FOR_MORE;
-                uPortTaskBlock(U_AT_CLIENT_STREAM_READ_RETRY_DELAY_MS);
+                readWait(pClient, eventIsCallback,
+                         U_AT_CLIENT_STREAM_READ_RETRY_DELAY_MS);
             }
         } else {
             if (blockState == U_AT_CLIENT_BLOCK_STATE_WAIT_FOR_MORE) {
@@ -1155,7 +1557,8 @@ static int32_t uartReadNoStutter(uAtClientInstance_t *pClient,
                 // so stop blocking now
                 blockState = U_AT_CLIENT_BLOCK_STATE_DO_NOT_BLOCK;
             } else {
-                uPortTaskBlock(U_AT_CLIENT_STREAM_READ_RETRY_DELAY_MS);
+                readWait(pClient, eventIsCallback,
+                         pollTimeRemaining(atTimeoutMs, pClient->lockTimeMs));
             }
 
         }
@@ -1194,6 +1597,9 @@ static bool bufferFill(uAtClientInstance_t *pClient,
         case U_AT_CLIENT_STREAM_TYPE_EDM:
             eventIsCallback = uShortRangeEdmStreamAtEventIsCallback(pClient->streamHandle);
             break;
+        case U_AT_CLIENT_STREAM_TYPE_CMUX:
+            eventIsCallback = uCellMuxStreamEventIsCallback(pClient->streamHandle);
+            break;
         default:
             break;
     }
@@ -1247,7 +1653,16 @@ static bool bufferFill(uAtClientInstance_t *pClient,
         }
     }
 
-    // Reset buffer if it has become full
+    // If the buffer has become full, move anything unread to
+    // the start of it and only if it is still full grow it,
+    // if it is allowed to, else reset it
+    if (pReceiveBuffer->lengthBuffered == pReceiveBuffer->dataBufferSize) {
+        bufferRewind(pClient);
+        if ((pReceiveBuffer->lengthBuffered == pReceiveBuffer->dataBufferSize) &&
+            bufferGrow(pClient)) {
+            pReceiveBuffer = pClient->pReceiveBuffer;
+        }
+    }
     if (pReceiveBuffer->lengthBuffered == pReceiveBuffer->dataBufferSize) {
 #if U_CFG_OS_CLIB_LEAKS
         // If the C library leaks then don't print
@@ -1264,6 +1679,8 @@ static bool bufferFill(uAtClientInstance_t *pClient,
         }
 #endif
         LOG_BUFFER_FILL(2);
+        STATS_ADD(pClient, numBufferFull, 1);
+        TRACE(BUFFER_OVERFLOW, pReceiveBuffer->lengthBuffered);
         bufferReset(pClient, true);
     }
 
@@ -1276,7 +1693,8 @@ static bool bufferFill(uAtClientInstance_t *pClient,
     do {
         switch (pClient->streamType) {
             case U_AT_CLIENT_STREAM_TYPE_UART:
-                readLength = uartReadNoStutter(pClient, blockState, atTimeoutMs);
+                readLength = uartReadNoStutter(pClient, blockState, atTimeoutMs,
+                                               eventIsCallback);
                 break;
             case U_AT_CLIENT_STREAM_TYPE_EDM:
                 readLength = uShortRangeEdmStreamAtRead(pClient->streamHandle,
@@ -1285,6 +1703,13 @@ static bool bufferFill(uAtClientInstance_t *pClient,
                                                         pReceiveBuffer->dataBufferSize -
                                                         pReceiveBuffer->length);
                 break;
+            case U_AT_CLIENT_STREAM_TYPE_CMUX:
+                readLength = uCellMuxStreamRead(pClient->streamHandle,
+                                                U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
+                                                pReceiveBuffer->length,
+                                                pReceiveBuffer->dataBufferSize -
+                                                pReceiveBuffer->length);
+                break;
             default:
                 break;
         }
@@ -1296,6 +1721,15 @@ static bool bufferFill(uAtClientInstance_t *pClient,
             // available in the buffer for the AT client as
             // there may be an intercept function in the way
             pReceiveBuffer->lengthBuffered += readLength;
+            if (pReceiveBuffer->lengthBuffered > pClient->receiveBufferPeak) {
+                pClient->receiveBufferPeak = pReceiveBuffer->lengthBuffered;
+            }
+            if (pReceiveBuffer->lengthBuffered > pClient->receiveBufferSizeInitial) {
+                pClient->receiveBufferUsedMs = uPortGetTickTimeMs();
+            }
+            STATS_ADD_TAGGED(pClient, rxBytes, readLength);
+            TRACE(BUFFER_FILL, readLength);
+            U_LOG_RAM_TRACE_INSTANT(AT_CLIENT, AT_BUFFER_FILL, readLength);
             // length starts out as the amount of data that has not yet
             // been successfully processed by the intercept function
             length += readLength;
@@ -1320,6 +1754,7 @@ static bool bufferFill(uAtClientInstance_t *pClient,
                 // length is now the length of the data that has been PROCESSED
                 // by the intercept function and is ready to be AT-parsed.
                 LOG_BUFFER_FILL(7);
+                TRACE(INTERCEPT_RX, (pData != NULL) ? length : 0);
                 U_ASSERT(U_AT_CLIENT_GUARD_CHECK(pReceiveBuffer));
 
                 // Safety check
@@ -1426,7 +1861,11 @@ static bool bufferFill(uAtClientInstance_t *pClient,
         }
 
         LOG_BUFFER_FILL(14);
-        uPortTaskBlock(U_AT_CLIENT_STREAM_READ_RETRY_DELAY_MS);
+        if ((readLength == 0) &&
+            (pollTimeRemaining(atTimeoutMs, pClient->lockTimeMs) > 0)) {
+            readWait(pClient, eventIsCallback,
+                     pollTimeRemaining(atTimeoutMs, pClient->lockTimeMs));
+        }
     } while ((readLength == 0) &&
              (pollTimeRemaining(atTimeoutMs, pClient->lockTimeMs) > 0));
 
@@ -1479,6 +1918,7 @@ static int32_t bufferReadChar(uAtClientInstance_t *pClient)
         bufferReset(pClient, false);
         if (bufferFill(pClient, true)) {
             // Read something, all good
+            pReceiveBuffer = pClient->pReceiveBuffer;
             character = (unsigned char) * (U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
                                            pReceiveBuffer->readIndex);
             pReceiveBuffer->readIndex++;
@@ -1548,6 +1988,7 @@ static void setScope(uAtClientInstance_t *pClient,
     if (pClient->scope != scope) {
         pClient->scope = scope;
         pStopTag->found = false;
+        pClient->spanInQuotes = false;
         switch (scope) {
             case U_AT_CLIENT_SCOPE_RESPONSE:
                 pStopTag->pTagDef = &gResponseStopTag;
@@ -1636,6 +2077,73 @@ static void informationResponseStop(uAtClientInstance_t *pClient)
     }
 }
 
+#if defined(U_CFG_AT_CLIENT_TRACE) || defined(U_CFG_LOG_RAM_TRACE)
+// Pack up to the first four characters of a URC prefix into
+// an int32_t for the trace, first character most significant.
+static int32_t urcPrefixPack(const char *pPrefix)
+{
+    uint32_t packed = 0;
+
+    for (size_t x = 0; x < sizeof(packed); x++) {
+        packed <<= 8;
+        if (*pPrefix != 0) {
+            packed |= (unsigned char) *pPrefix;
+            pPrefix++;
+        }
+    }
+
+    return (int32_t) packed;
+}
+#endif
+
+// Hash the first keyLength characters of a URC prefix, or of
+// the receive buffer, to give an index into pUrcHashTable.
+static size_t urcHash(const char *pKey, size_t keyLength)
+{
+    // FNV-1a, cheap and spreads the "+UUxxx" style prefixes well
+    uint32_t hash = 2166136261UL;
+
+    for (size_t x = 0; x < keyLength; x++) {
+        hash ^= (uint8_t) *pKey++;
+        hash *= 16777619UL;
+    }
+
+    return (size_t) (hash & (U_AT_CLIENT_URC_HASH_TABLE_SIZE - 1));
+}
+
+// Rebuild the URC hash table from pUrcList; must be called,
+// with urcPermittedMutex locked, whenever pUrcList changes.
+// Each bucket is chained in the same order as pUrcList so
+// that precedence between overlapping prefixes is unchanged.
+static void urcHashTableRebuild(uAtClientInstance_t *pClient)
+{
+    uAtClientUrc_t **ppEnd[U_AT_CLIENT_URC_HASH_TABLE_SIZE];
+    size_t keyLength = U_AT_CLIENT_URC_HASH_KEY_MAX_LENGTH;
+    size_t index;
+
+    // The key can be no longer than the shortest prefix
+    for (uAtClientUrc_t *pUrc = pClient->pUrcList; pUrc != NULL; pUrc = pUrc->pNext) {
+        if (pUrc->prefixLength < keyLength) {
+            keyLength = pUrc->prefixLength;
+        }
+    }
+    if (pClient->pUrcList == NULL) {
+        keyLength = 0;
+    }
+
+    for (size_t x = 0; x < U_AT_CLIENT_URC_HASH_TABLE_SIZE; x++) {
+        pClient->pUrcHashTable[x] = NULL;
+        ppEnd[x] = &(pClient->pUrcHashTable[x]);
+    }
+    for (uAtClientUrc_t *pUrc = pClient->pUrcList; pUrc != NULL; pUrc = pUrc->pNext) {
+        index = urcHash(pUrc->pPrefix, keyLength);
+        pUrc->pNextInBucket = NULL;
+        *(ppEnd[index]) = pUrc;
+        ppEnd[index] = &(pUrc->pNextInBucket);
+    }
+    pClient->urcHashKeyLength = keyLength;
+}
+
 // Iterate through URCs and check if one of them matches the current
 // contents of the receive buffer. If a URC is matched, set the
 // scope to information response and, after the URC's handler has
@@ -1647,16 +2155,27 @@ static bool bufferMatchOneUrc(uAtClientInstance_t *pClient)
     bool found = false;
     int32_t now;
     uErrorCode_t savedError;
+    uAtClientUrc_t *pUrc = NULL;
 
     bufferRewind(pClient);
 
-    for (uAtClientUrc_t *pUrc = pClient->pUrcList;
-         !found && (pUrc != NULL);
-         pUrc = pUrc->pNext) {
+    // Only the URCs in the bucket selected by the start of
+    // the received line can possibly match; if there isn't
+    // even enough received to form the hash key then
+    // no URC can match
+    if ((pClient->pUrcList != NULL) &&
+        (pClient->pReceiveBuffer->length >= pClient->urcHashKeyLength)) {
+        pUrc = pClient->pUrcHashTable[urcHash(U_AT_CLIENT_DATA_BUFFER_PTR(pClient->pReceiveBuffer),
+                                              pClient->urcHashKeyLength)];
+    }
+
+    for (; !found && (pUrc != NULL); pUrc = pUrc->pNextInBucket) {
         prefixLength = pUrc->prefixLength;
         if (pClient->pReceiveBuffer->length >= prefixLength) {
             if (bufferMatch(pClient, pUrc->pPrefix, prefixLength)) {
                 setScope(pClient, U_AT_CLIENT_SCOPE_INFORMATION);
+                TRACE(URC_START, urcPrefixPack(pUrc->pPrefix));
+                U_LOG_RAM_TRACE_BEGIN(AT_CLIENT, AT_URC, urcPrefixPack(pUrc->pPrefix));
                 now = uPortGetTickTimeMs();
                 // Before heading off into URCness, save
                 // the current error state and reset
@@ -1672,7 +2191,12 @@ static bool bufferMatchOneUrc(uAtClientInstance_t *pClient)
                 // Put the error state back again
                 // Add the amount of time spent in the URC
                 // world to the start time
-                pClient->lockTimeMs += uPortGetTickTimeMs() - now;
+                now = uPortGetTickTimeMs() - now;
+                pClient->lockTimeMs += now;
+                STATS_ADD(pClient, numUrcs, 1);
+                STATS_ADD(pClient, urcHandlerMs, now);
+                TRACE(URC_STOP, now);
+                U_LOG_RAM_TRACE_END(AT_CLIENT, AT_URC, now);
                 found = true;
             }
         }
@@ -1788,18 +2312,200 @@ static int32_t readString(uAtClientInstance_t *pClient,
     return lengthRead;
 }
 
+// Find the next field, or if wholeLine is true the rest of the
+// line, in the receive buffer, re-filling it as necessary, and
+// consume it; see uAtClientReadSpan() for the details.
+// The mutex should be locked before this is called.
+static int32_t readSpan(uAtClientInstance_t *pClient,
+                        uAtClientSpan_t *pSpan, bool wholeLine)
+{
+    uAtClientReceiveBuffer_t *pReceiveBuffer = pClient->pReceiveBuffer;
+    uAtClientTag_t *pStopTag = &(pClient->stopTag);
+    const char *pTag = pStopTag->pTagDef->pString;
+    size_t tagLength = pStopTag->pTagDef->length;
+    const char *pData;
+    size_t unreadLength;
+    size_t index = 0;
+    size_t spanLength = 0;
+    size_t consumeLength = 0;
+    bool done = false;
+    bool needMore;
+    char c;
+
+    pSpan->pData = NULL;
+    pSpan->length = 0;
+    pSpan->isPartial = false;
+    pSpan->isLast = false;
+
+    while (!done && (pClient->error == U_ERROR_COMMON_SUCCESS)) {
+        // index is relative to readIndex, so it survives the
+        // buffer being rewound below
+        pData = U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) + pReceiveBuffer->readIndex;
+        unreadLength = pReceiveBuffer->length - pReceiveBuffer->readIndex;
+        needMore = false;
+        while (!done && !needMore && (index < unreadLength)) {
+            c = *(pData + index);
+            if (!pClient->spanInQuotes && (tagLength > 0) && (c == *pTag)) {
+                // Could be the stop tag
+                if (unreadLength - index < tagLength) {
+                    // Can't tell yet: if what there is matches,
+                    // need more data to decide
+                    if (memcmp(pData + index, pTag, unreadLength - index) == 0) {
+                        needMore = true;
+                    } else {
+                        index++;
+                    }
+                } else if (memcmp(pData + index, pTag, tagLength) == 0) {
+                    spanLength = index;
+                    consumeLength = index + tagLength;
+                    pStopTag->found = true;
+                    pSpan->isLast = true;
+                    done = true;
+                } else {
+                    index++;
+                }
+            } else if (!pClient->spanInQuotes && !wholeLine &&
+                       (c == pClient->delimiter)) {
+                spanLength = index;
+                consumeLength = index + 1;
+                done = true;
+            } else {
+                if (c == '\"') {
+                    pClient->spanInQuotes = !pClient->spanInQuotes;
+                }
+                index++;
+            }
+        }
+        if (!done) {
+            // Got to the end of what has been received: move it
+            // to the start of the buffer and, if there is room,
+            // bring in more, growing the buffer if it is full
+            // and is allowed to grow
+            bufferRewind(pClient);
+            if ((pReceiveBuffer->lengthBuffered < pReceiveBuffer->dataBufferSize) ||
+                bufferGrow(pClient)) {
+                if (bufferFill(pClient, true)) {
+                    pClient->numConsecutiveAtTimeouts = 0;
+                } else {
+                    if (pClient->debugOn) {
+                        uPortLog("U_AT_CLIENT_%d-%d: timeout.\n",
+                                 pClient->streamType, pClient->streamHandle);
+                    }
+                    setError(pClient, U_ERROR_COMMON_DEVICE_ERROR);
+                    consecutiveTimeout(pClient);
+                }
+                pReceiveBuffer = pClient->pReceiveBuffer;
+            } else if (index > 0) {
+                // The buffer is full: hand over what we have
+                spanLength = index;
+                consumeLength = index;
+                pSpan->isPartial = true;
+                done = true;
+            } else {
+                // Nothing we can do with a full buffer
+                setError(pClient, U_ERROR_COMMON_NO_MEMORY);
+            }
+        }
+    }
+
+    if (done) {
+        if (!pSpan->isPartial) {
+            pClient->spanInQuotes = false;
+        }
+        pSpan->pData = U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
+                       pReceiveBuffer->readIndex;
+        pSpan->length = spanLength;
+        pReceiveBuffer->readIndex += consumeLength;
+    }
+
+    return done ? (int32_t) spanLength : (int32_t) pClient->error;
+}
+
+// Try to read a decimal integer parameter straight out of the
+// receive buffer, without a copy into a string first.  This only
+// works if the whole parameter, and the delimiter or stop tag
+// that follows it, has already been received and the parameter
+// is nothing more than up to maxDigits digits, preceded, if
+// pNegative is non-NULL, by optional spaces and an optional minus
+// sign (as strtol() would accept); otherwise nothing is consumed
+// and false is returned so that the caller can fall back to
+// readString().
+// The mutex should be locked before this is called.
+static bool readDecimalDirect(uAtClientInstance_t *pClient,
+                              size_t maxDigits, uint64_t *pValue,
+                              bool *pNegative)
+{
+    uAtClientReceiveBuffer_t *pReceiveBuffer = pClient->pReceiveBuffer;
+    const uAtClientTagDef_t *pTagDef = pClient->stopTag.pTagDef;
+    const char *pData = U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer);
+    size_t length = pReceiveBuffer->length;
+    size_t x = pReceiveBuffer->readIndex;
+    size_t numDigits = 0;
+    uint64_t value = 0;
+    bool negative = false;
+    bool success = false;
+
+    if (pNegative != NULL) {
+        while ((x < length) && (pData[x] == ' ')) {
+            x++;
+        }
+        if ((x < length) && (pData[x] == '-')) {
+            negative = true;
+            x++;
+        }
+    }
+    while ((x < length) && (numDigits < maxDigits) &&
+           (pData[x] >= '0') && (pData[x] <= '9')) {
+        value = (value * 10) + (pData[x] - '0');
+        numDigits++;
+        x++;
+    }
+
+    if ((numDigits > 0) && (x < length)) {
+        if (pData[x] == pClient->delimiter) {
+            // Consume the delimiter, just as readString() would
+            pReceiveBuffer->readIndex = x + 1;
+            success = true;
+        } else if ((pTagDef->length > 0) &&
+                   (length - x >= pTagDef->length) &&
+                   (memcmp(pData + x, pTagDef->pString, pTagDef->length) == 0)) {
+            // Consume the stop tag, just as readString() would
+            pReceiveBuffer->readIndex = x + pTagDef->length;
+            pClient->stopTag.found = true;
+            success = true;
+        }
+    }
+
+    if (success) {
+        *pValue = value;
+        if (pNegative != NULL) {
+            *pNegative = negative;
+        }
+    }
+
+    return success;
+}
+
 // Read an integer.
 // The mutex should be locked before this is called.
 static int32_t readInt(uAtClientInstance_t *pClient)
 {
     char buffer[32]; // Enough for an integer
     int32_t integerRead = -1;
+    uint64_t value;
+    bool negative;
 
     if ((pClient->error == U_ERROR_COMMON_SUCCESS) &&
-        !pClient->stopTag.found &&
-        (readString(pClient, buffer,
-                    sizeof(buffer), false) > 0)) {
-        integerRead = strtol(buffer, NULL, 10);
+        !pClient->stopTag.found) {
+        // Nearly all integers are already in the buffer and
+        // small, which is the fast case; anything else goes
+        // the long way round
+        if (readDecimalDirect(pClient, 9, &value, &negative)) {
+            integerRead = negative ? -((int32_t) value) : (int32_t) value;
+        } else if (readString(pClient, buffer,
+                              sizeof(buffer), false) > 0) {
+            integerRead = strtol(buffer, NULL, 10);
+        }
     }
 
     return integerRead;
@@ -2070,6 +2776,9 @@ static size_t write(uAtClientInstance_t *pClient,
                 pData = pDataStart + length;
                 andFlush = false;
             }
+            if (pClient->pInterceptTx != NULL) {
+                TRACE(INTERCEPT_TX, lengthToWrite);
+            }
             if ((pDataToWrite == NULL) && (lengthToWrite > 0)) {
                 setError(pClient, U_ERROR_COMMON_UNKNOWN);
             }
@@ -2085,6 +2794,10 @@ static size_t write(uAtClientInstance_t *pClient,
                     // Write handled in intercept
                     case U_AT_CLIENT_STREAM_TYPE_EDM:
                         break;
+                    case U_AT_CLIENT_STREAM_TYPE_CMUX:
+                        thisLengthWritten = uCellMuxStreamWrite(pClient->streamHandle,
+                                                                pDataToWrite, lengthToWrite);
+                        break;
                     default:
                         break;
                 }
@@ -2106,6 +2819,7 @@ static size_t write(uAtClientInstance_t *pClient,
     // if *everything* was written
     if (pClient->error == U_ERROR_COMMON_SUCCESS) {
         printAt(pClient, pDataStart, length);
+        STATS_ADD_TAGGED(pClient, txBytes, length);
     } else {
         length = 0;
     }
@@ -2113,6 +2827,22 @@ static size_t write(uAtClientInstance_t *pClient,
     return length;
 }
 
+// Wait out whatever remains of the delay between the end of the
+// last response and the start of a new AT command.
+static void commandDelay(const uAtClientInstance_t *pClient)
+{
+    int32_t delayMs = pClient->delayMs;
+
+    if (pClient->delayMinMs >= 0) {
+        delayMs = pClient->delayLearntMs;
+    }
+    // Constructed this way to be safe if uPortGetTickTimeMs() wraps
+    delayMs -= uPortGetTickTimeMs() - pClient->lastResponseStopMs;
+    if ((delayMs > 0) && (delayMs <= pClient->delayMs)) {
+        uPortTaskBlock(delayMs);
+    }
+}
+
 // Do common checks before sending parameters
 // and also deal with the need for a delimiter.
 static bool writeCheckAndDelimit(uAtClientInstance_t *pClient)
@@ -2207,6 +2937,11 @@ static void unlockNoDataCheck(uAtClientInstance_t *pClient,
             pClient->atTimeoutSavedMs = -1;
         }
 
+        // Nothing can be using the receive buffer now, so
+        // this is the time to give back any room it has
+        // grown into but no longer needs
+        bufferShrinkIfIdle(pClient);
+
         if (pClient->pActivityPin != NULL) {
             // If an activity pin is set then switch it off
             while (uPortGetTickTimeMs() - pClient->pActivityPin->lastToggleTime <
@@ -2301,6 +3036,9 @@ static int32_t getReceiveSizeForUrc(const uAtClientInstance_t *pClient)
             case U_AT_CLIENT_STREAM_TYPE_EDM:
                 receiveSize = uShortRangeEdmStreamAtGetReceiveSize(pClient->streamHandle);
                 break;
+            case U_AT_CLIENT_STREAM_TYPE_CMUX:
+                receiveSize = uCellMuxStreamGetReceiveSize(pClient->streamHandle);
+                break;
             default:
                 break;
         }
@@ -2315,12 +3053,18 @@ static void urcCallback(int32_t streamHandle, uint32_t eventBitmask,
                         void *pParameters)
 {
     uAtClientInstance_t *pClient;
-    uAtClientReceiveBuffer_t *pReceiveBuffer;
     uPortMutexHandle_t streamMutex;
     int32_t sizeOrError;
 
     pClient = (uAtClientInstance_t *) pParameters;
 
+    if ((pClient != NULL) && (pClient->rxSemaphore != NULL) &&
+        (pClient->streamHandle == streamHandle) &&
+        (eventBitmask & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED)) {
+        // Wake up anyone waiting in readWait()
+        uPortSemaphoreGive(pClient->rxSemaphore);
+    }
+
     if ((pClient != NULL) &&
         (pClient->streamHandle == streamHandle) &&
         (eventBitmask & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED) &&
@@ -2332,9 +3076,8 @@ static void urcCallback(int32_t streamHandle, uint32_t eventBitmask,
         streamMutex = tryLock(pClient);
         if (streamMutex != NULL) {
             // Loop until no received characters left to process
-            pReceiveBuffer = pClient->pReceiveBuffer;
             while (((sizeOrError = getReceiveSizeForUrc(pClient)) > 0) ||
-                   (pReceiveBuffer->readIndex < pReceiveBuffer->length)) {
+                   (pClient->pReceiveBuffer->readIndex < pClient->pReceiveBuffer->length)) {
 #if !U_CFG_OS_CLIB_LEAKS
                 // Don't do this if CLIB is leaky on this platform since it's
                 // the printf() that leaks
@@ -2342,7 +3085,7 @@ static void urcCallback(int32_t streamHandle, uint32_t eventBitmask,
                     uPortLog("U_AT_CLIENT_%d-%d: possible URC data readable %d,"
                              " already buffered %u.\n", pClient->streamType,
                              pClient->streamHandle, sizeOrError,
-                             pReceiveBuffer->length - pReceiveBuffer->readIndex);
+                             pClient->pReceiveBuffer->length - pClient->pReceiveBuffer->readIndex);
                 }
 #endif
                 pClient->scope = U_AT_CLIENT_SCOPE_NONE;
@@ -2352,15 +3095,15 @@ static void urcCallback(int32_t streamHandle, uint32_t eventBitmask,
                         // If there's a bufferMatch, see if more data is available
                         sizeOrError = getReceiveSizeForUrc(pClient);
                         if ((sizeOrError <= 0) &&
-                            (pReceiveBuffer->readIndex >=
-                             pReceiveBuffer->dataBufferSize)) {
+                            (pClient->pReceiveBuffer->readIndex >=
+                             pClient->pReceiveBuffer->dataBufferSize)) {
                             // We have no more data to process, leave this loop
                             break;
                         }
                         // If no bufferMatch was found, look for CR/LF
-                    } else if (pMemStr(U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
-                                       pReceiveBuffer->readIndex,
-                                       pReceiveBuffer->length,
+                    } else if (pMemStr(U_AT_CLIENT_DATA_BUFFER_PTR(pClient->pReceiveBuffer) +
+                                       pClient->pReceiveBuffer->readIndex,
+                                       pClient->pReceiveBuffer->length,
                                        U_AT_CLIENT_CRLF, U_AT_CLIENT_CRLF_LENGTH_BYTES) != NULL) {
                         // Consume everything up to the CR/LF
                         consumeToString(pClient, U_AT_CLIENT_CRLF);
@@ -2561,6 +3304,14 @@ uAtClientHandle_t uAtClientAdd(int32_t streamHandle,
                         pClient->delimiter = U_AT_CLIENT_DEFAULT_DELIMITER;
                         mutexStackInit(&(pClient->lockedStreamMutexStack));
                         pClient->delayMs = U_AT_CLIENT_DEFAULT_DELAY_MS;
+                        pClient->delayMinMs = -1;
+                        pClient->eventQueueHandle = -1;
+                        pClient->delayLearntMs = pClient->delayMs;
+                        // Not fatal if this fails, we just poll the
+                        // stream instead
+                        if (uPortSemaphoreCreate(&(pClient->rxSemaphore), 0, 1) != 0) {
+                            pClient->rxSemaphore = NULL;
+                        }
                         clearError(pClient);
                         // This will also set stopTag
                         setScope(pClient, U_AT_CLIENT_SCOPE_NONE);
@@ -2570,6 +3321,8 @@ uAtClientHandle_t uAtClientAdd(int32_t streamHandle,
                         // Set up the buffer and its protection markers
                         pClient->pReceiveBuffer->dataBufferSize = receiveBufferSize -
                                                                   U_AT_CLIENT_BUFFER_OVERHEAD_BYTES;
+                        pClient->receiveBufferIsMalloced = receiveBufferIsMalloced;
+                        pClient->receiveBufferSizeInitial = pClient->pReceiveBuffer->dataBufferSize;
                         bufferReset(pClient, true);
                         memcpy(pClient->pReceiveBuffer->mk0, U_AT_CLIENT_MARKER,
                                U_AT_CLIENT_MARKER_SIZE);
@@ -2578,21 +3331,7 @@ uAtClientHandle_t uAtClientAdd(int32_t streamHandle,
                                U_AT_CLIENT_MARKER, U_AT_CLIENT_MARKER_SIZE);
                         // Now add an event handler for characters
                         // received on the stream
-                        switch (streamType) {
-                            case U_AT_CLIENT_STREAM_TYPE_UART:
-                                errorCode = uPortUartEventCallbackSet(streamHandle,
-                                                                      U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
-                                                                      urcCallback, pClient,
-                                                                      U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES,
-                                                                      U_AT_CLIENT_URC_TASK_PRIORITY);
-                                break;
-                            case U_AT_CLIENT_STREAM_TYPE_EDM:
-                                errorCode = uShortRangeEdmStreamAtCallbackSet(streamHandle, urcCallback, pClient);
-                                break;
-                            default:
-                                // streamType is checked on entry
-                                break;
-                        }
+                        errorCode = streamCallbackSet(pClient);
                         if (errorCode == 0) {
                             // Add the instance to the list
                             addAtClientInstance(pClient);
@@ -2602,6 +3341,9 @@ uAtClientHandle_t uAtClientAdd(int32_t streamHandle,
 
                 if (errorCode != 0) {
                     // Clean up on failure
+                    if (pClient->rxSemaphore != NULL) {
+                        uPortSemaphoreDelete(pClient->rxSemaphore);
+                    }
                     if (pClient->urcPermittedMutex != NULL) {
                         uPortMutexDelete(pClient->urcPermittedMutex);
                     }
@@ -2787,9 +3529,62 @@ void uAtClientDelaySet(uAtClientHandle_t atHandle,
     // Keep Lint happy
     if (atHandle != NULL) {
         ((uAtClientInstance_t *) atHandle)->delayMs = delayMs;
+        ((uAtClientInstance_t *) atHandle)->delayLearntMs = delayMs;
     }
 }
 
+// Switch adaptive pacing on or off.
+void uAtClientDelayAdaptiveSet(uAtClientHandle_t atHandle,
+                               int32_t minDelayMs)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    pClient->delayMinMs = minDelayMs;
+    pClient->delayLearntMs = pClient->delayMs;
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+}
+
+// Allow the receive buffer to grow.
+int32_t uAtClientReceiveBufferGrowSet(uAtClientHandle_t atHandle,
+                                      size_t maxSizeBytes,
+                                      size_t stepSizeBytes)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    if ((maxSizeBytes == 0) ||
+        ((maxSizeBytes > U_AT_CLIENT_BUFFER_OVERHEAD_BYTES) && (stepSizeBytes > 0))) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+        if (pClient->receiveBufferIsMalloced) {
+            // Any growth already done is undone, once idle,
+            // by bufferShrinkIfIdle()
+            pClient->receiveBufferSizeMax = 0;
+            if (maxSizeBytes > 0) {
+                pClient->receiveBufferSizeMax = maxSizeBytes - U_AT_CLIENT_BUFFER_OVERHEAD_BYTES;
+            }
+            pClient->receiveBufferStepSize = stepSizeBytes;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+
+    return errorCode;
+}
+
+// Get the peak receive buffer usage.
+int32_t uAtClientReceiveBufferPeakGet(const uAtClientHandle_t atHandle)
+{
+    const uAtClientInstance_t *pClient = (const uAtClientInstance_t *) atHandle;
+
+    return (int32_t) (pClient->receiveBufferPeak + U_AT_CLIENT_BUFFER_OVERHEAD_BYTES);
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: SEND AN AT COMMAND
  * -------------------------------------------------------------- */
@@ -2799,6 +3594,9 @@ void uAtClientLock(uAtClientHandle_t atHandle)
 {
     uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
     uPortMutexHandle_t streamMutex;
+#ifdef U_CFG_AT_CLIENT_STATS
+    int32_t startMs = uPortGetTickTimeMs();
+#endif
 
     // IMPORTANT: this can't lock pClient->mutex as it
     // needs to wait on the stream mutex and if it locked
@@ -2807,6 +3605,9 @@ void uAtClientLock(uAtClientHandle_t atHandle)
     if ((pClient != NULL) && (pClient->streamMutex != NULL)) {
         streamMutex = streamLock(pClient);
         mutexStackPush(&(pClient->lockedStreamMutexStack), streamMutex);
+#ifdef U_CFG_AT_CLIENT_STATS
+        statsLock(pClient, uPortGetTickTimeMs() - startMs);
+#endif
         if (pClient->pActivityPin != NULL) {
             while (uPortGetTickTimeMs() - pClient->pActivityPin->lastToggleTime <
                    pClient->pActivityPin->hysteresisMs) {
@@ -2832,18 +3633,26 @@ int32_t uAtClientUnlock(uAtClientHandle_t atHandle)
     int32_t sizeBytes;
     uPortMutexHandle_t streamMutex;
     int32_t sendErrorCode;
+    bool unreadInBuffer;
 
     U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
 
     streamMutex = mutexStackPop(&(pClient->lockedStreamMutexStack));
     if (streamMutex != NULL) {
+#ifdef U_CFG_AT_CLIENT_STATS
+        statsUnlock(pClient);
+#endif
+        U_ASSERT(U_AT_CLIENT_GUARD_CHECK(pClient->pReceiveBuffer));
+        // Once the stream is unlocked the receive buffer may
+        // be moved by a URC callback (see bufferGrow()), hence
+        // this is read while the stream is still locked
+        unreadInBuffer = (pClient->pReceiveBuffer->readIndex < pClient->pReceiveBuffer->length);
         unlockNoDataCheck(pClient, streamMutex);
 
         switch (pClient->streamType) {
             case U_AT_CLIENT_STREAM_TYPE_UART:
                 sizeBytes = uPortUartGetReceiveSize(pClient->streamHandle);
-                if ((sizeBytes > 0) ||
-                    (pClient->pReceiveBuffer->readIndex < pClient->pReceiveBuffer->length)) {
+                if ((sizeBytes > 0) || unreadInBuffer) {
                     // Note: we use the "try" version of the UART event
                     // send function here, otherwise if the UART event queue
                     // is full we may get stuck since (a) this function has
@@ -2865,17 +3674,21 @@ int32_t uAtClientUnlock(uAtClientHandle_t atHandle)
                 break;
             case U_AT_CLIENT_STREAM_TYPE_EDM:
                 sizeBytes = uShortRangeEdmStreamAtGetReceiveSize(pClient->streamHandle);
-                if ((sizeBytes > 0) ||
-                    (pClient->pReceiveBuffer->readIndex < pClient->pReceiveBuffer->length)) {
+                if ((sizeBytes > 0) || unreadInBuffer) {
                     uShortRangeEdmStreamAtEventSend(pClient->streamHandle,
                                                     U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED);
                 }
                 break;
+            case U_AT_CLIENT_STREAM_TYPE_CMUX:
+                sizeBytes = uCellMuxStreamGetReceiveSize(pClient->streamHandle);
+                if ((sizeBytes > 0) || unreadInBuffer) {
+                    uCellMuxStreamEventSend(pClient->streamHandle,
+                                            U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED);
+                }
+                break;
             default:
                 break;
         }
-
-        U_ASSERT(U_AT_CLIENT_GUARD_CHECK(pClient->pReceiveBuffer));
     }
 
     U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
@@ -2892,13 +3705,12 @@ void uAtClientCommandStart(uAtClientHandle_t atHandle,
     U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
 
     if (pClient->error == U_ERROR_COMMON_SUCCESS) {
-        // Wait for delay period if required, constructed this way
-        // to be safe if uPortGetTickTimeMs() wraps
-        if (pClient->delayMs > 0) {
-            while (uPortGetTickTimeMs() - pClient->lastResponseStopMs < pClient->delayMs) {
-                uPortTaskBlock(10);
-            }
-        }
+        // Wait for the delay period if required
+        commandDelay(pClient);
+
+        STATS_COMMAND_START(pClient, pCommand);
+        TRACE(COMMAND_START, pClient->streamHandle);
+        U_LOG_RAM_TRACE_BEGIN(AT_CLIENT, AT_COMMAND, pClient->streamHandle);
 
         // Send the command, no delimiter at first
         pClient->delimiterRequired = false;
@@ -3007,6 +3819,41 @@ size_t uAtClientWriteBytes(uAtClientHandle_t atHandle,
     return writeLength;
 }
 
+// Write a sequence of fragments of bytes.
+size_t uAtClientWriteBytesV(uAtClientHandle_t atHandle,
+                            const uAtClientIoVec_t *pIoVec,
+                            size_t numIoVec,
+                            bool standalone)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    size_t writeLength = 0;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    // Do write check and delimit if required, else
+    // just check for errors
+    if ((pIoVec != NULL) &&
+        (standalone || writeCheckAndDelimit(pClient)) &&
+        (pClient->error == U_ERROR_COMMON_SUCCESS)) {
+        for (size_t x = 0; (x < numIoVec) &&
+             (pClient->error == U_ERROR_COMMON_SUCCESS); x++) {
+            if (pIoVec[x].lengthBytes > 0) {
+                // write() will set device error if there's a problem
+                writeLength += write(pClient, pIoVec[x].pData,
+                                     pIoVec[x].lengthBytes, false);
+            }
+        }
+        if (standalone && (pClient->error == U_ERROR_COMMON_SUCCESS)) {
+            // Flush everything out in one go
+            write(pClient, NULL, 0, true);
+        }
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+
+    return writeLength;
+}
+
 void uAtClientWritePartialString(uAtClientHandle_t atHandle,
                                  bool isFirst,
                                  const char *pParam)
@@ -3040,6 +3887,47 @@ void uAtClientCommandStop(uAtClientHandle_t atHandle)
     U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
 }
 
+// Format and send a complete AT command in one go.
+void uAtClientCommandf(uAtClientHandle_t atHandle,
+                       const char *pFormat, ...)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    // +1 for the delimiter, +1 for the terminator vsnprintf() adds
+    char buffer[U_AT_CLIENT_COMMANDF_MAX_LENGTH_BYTES +
+                U_AT_CLIENT_COMMAND_DELIMITER_LENGTH_BYTES + 1];
+    va_list args;
+    int32_t length;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    if (pClient->error == U_ERROR_COMMON_SUCCESS) {
+        va_start(args, pFormat);
+        length = vsnprintf(buffer, U_AT_CLIENT_COMMANDF_MAX_LENGTH_BYTES + 1,
+                           pFormat, args);
+        va_end(args);
+        if ((length >= 0) && (length <= U_AT_CLIENT_COMMANDF_MAX_LENGTH_BYTES)) {
+            // Wait for the delay period if required
+            commandDelay(pClient);
+
+            STATS_COMMAND_START(pClient, buffer);
+            TRACE(COMMAND_START, pClient->streamHandle);
+            U_LOG_RAM_TRACE_BEGIN(AT_CLIENT, AT_COMMAND, pClient->streamHandle);
+
+            // Add the delimiter and send the lot, flushing it out
+            // write() will set device error if there's a problem
+            memcpy(buffer + length, U_AT_CLIENT_COMMAND_DELIMITER,
+                   U_AT_CLIENT_COMMAND_DELIMITER_LENGTH_BYTES);
+            length += U_AT_CLIENT_COMMAND_DELIMITER_LENGTH_BYTES;
+            pClient->delimiterRequired = false;
+            write(pClient, buffer, length, true);
+        } else {
+            setError(pClient, U_ERROR_COMMON_NO_MEMORY);
+        }
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+}
+
 // Stop the outgoing part and deal with a simple response also.
 void uAtClientCommandStopReadResponse(uAtClientHandle_t atHandle)
 {
@@ -3048,6 +3936,105 @@ void uAtClientCommandStopReadResponse(uAtClientHandle_t atHandle)
     uAtClientResponseStop(atHandle);
 }
 
+// Send a sequence of commands, pipelined.
+int32_t uAtClientPipeline(uAtClientHandle_t atHandle,
+                          uAtClientPipelineCommand_t *pCommands,
+                          size_t numCommands,
+                          size_t windowSize)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uAtClientDeviceError_t deviceError = {.type = U_AT_CLIENT_DEVICE_ERROR_TYPE_NO_ERROR,
+                                          .code = 0
+                                         };
+    const char *pCommand;
+    size_t numWritten = 0;
+    bool aborted = false;
+
+    if ((pCommands != NULL) && (windowSize > 0)) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        for (size_t x = 0; x < numCommands; x++) {
+            U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+            // Top up the window of outstanding commands
+            while (!aborted && (numWritten < numCommands) &&
+                   (numWritten < x + windowSize)) {
+                if (pClient->error == U_ERROR_COMMON_SUCCESS) {
+                    // The inter-command delay is only required when
+                    // there is nothing outstanding, which is when the
+                    // module will have gone idle
+                    if (numWritten == x) {
+                        commandDelay(pClient);
+                    }
+                    pCommand = pCommands[numWritten].pCommand;
+                    // write() will set device error if there's a problem
+                    write(pClient, pCommand, strlen(pCommand), false);
+                    write(pClient, U_AT_CLIENT_COMMAND_DELIMITER,
+                          U_AT_CLIENT_COMMAND_DELIMITER_LENGTH_BYTES,
+                          true);
+                }
+                aborted = (pClient->error != U_ERROR_COMMON_SUCCESS);
+                numWritten++;
+            }
+            if (!aborted) {
+                // Each response gets the full AT timeout
+                pClient->lockTimeMs = uPortGetTickTimeMs();
+                STATS_COMMAND_START(pClient, pCommands[x].pCommand);
+            }
+            U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+
+            if (!aborted) {
+                // Can't hold pClient->mutex here since
+                // URC handlers may be called
+                if ((uAtClientResponseStart(atHandle,
+                                            pCommands[x].pResponsePrefix) == 0) &&
+                    (pCommands[x].pResponseParser != NULL)) {
+                    pCommands[x].pResponseParser(atHandle,
+                                                 pCommands[x].pResponseParserParameter);
+                }
+                uAtClientResponseStop(atHandle);
+            }
+
+            U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+            pCommands[x].errorCode = (int32_t) pClient->error;
+            if (aborted && (pCommands[x].errorCode == (int32_t) U_ERROR_COMMON_SUCCESS)) {
+                pCommands[x].errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+            }
+            if (pCommands[x].errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) {
+                if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+                    errorCode = pCommands[x].errorCode;
+                }
+                if (!aborted && (pClient->deviceError.type != U_AT_CLIENT_DEVICE_ERROR_TYPE_NO_ERROR)) {
+                    // The module said ERROR to this command: the
+                    // response is complete so remember the first such
+                    // error and carry on with the next command
+                    if (deviceError.type == U_AT_CLIENT_DEVICE_ERROR_TYPE_NO_ERROR) {
+                        deviceError = pClient->deviceError;
+                    }
+                    clearError(pClient);
+                } else {
+                    // A timeout or similar: we've lost track of
+                    // where we are, give up
+                    aborted = true;
+                }
+            }
+            U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+        }
+
+        U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+        if ((pClient->error == U_ERROR_COMMON_SUCCESS) &&
+            (deviceError.type != U_AT_CLIENT_DEVICE_ERROR_TYPE_NO_ERROR)) {
+            // Put back the first device error so that
+            // uAtClientUnlock() and uAtClientDeviceErrorGet()
+            // report it
+            pClient->deviceError = deviceError;
+            setError(pClient, U_ERROR_COMMON_DEVICE_ERROR);
+        }
+        U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+    }
+
+    return errorCode;
+}
+
 // Start the response part.
 int32_t uAtClientResponseStart(uAtClientHandle_t atHandle,
                                const char *pPrefix)
@@ -3110,19 +4097,27 @@ int32_t uAtClientReadUint64(uAtClientHandle_t atHandle,
     uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
     char buffer[32]; // Enough for an integer
     int32_t returnValue = -1;
+    uint64_t value;
 
     U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
 
     if ((pClient->error == U_ERROR_COMMON_SUCCESS) &&
-        !pClient->stopTag.found &&
-        (readString(pClient, buffer,
-                    sizeof(buffer), false) > 0)) {
-        // Would use sscanf() here but we cannot
-        // rely on there being 64 bit sscanf() support
-        // in the underlying library, hence
-        // we do our own thing
-        *pUint64 = stringToUint64(buffer);
-        returnValue = 0;
+        !pClient->stopTag.found) {
+        // 19 digits can't overflow a uint64_t; anything
+        // unusual goes the long way round to be treated
+        // exactly as stringToUint64() would
+        if (readDecimalDirect(pClient, 19, &value, NULL)) {
+            *pUint64 = value;
+            returnValue = 0;
+        } else if (readString(pClient, buffer,
+                              sizeof(buffer), false) > 0) {
+            // Would use sscanf() here but we cannot
+            // rely on there being 64 bit sscanf() support
+            // in the underlying library, hence
+            // we do our own thing
+            *pUint64 = stringToUint64(buffer);
+            returnValue = 0;
+        }
     }
 
     U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
@@ -3243,6 +4238,108 @@ int32_t uAtClientReadBytes(uAtClientHandle_t atHandle,
     return lengthRead;
 }
 
+// Borrow a pointer to the unread bytes in the receive buffer.
+int32_t uAtClientReadBytesPeek(uAtClientHandle_t atHandle,
+                               const char **ppData,
+                               size_t lengthBytes)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    uAtClientReceiveBuffer_t *pReceiveBuffer = pClient->pReceiveBuffer;
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    size_t unreadLength;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    pClient->peekLength = 0;
+    if (ppData != NULL) {
+        sizeOrErrorCode = (int32_t) pClient->error;
+        if (pClient->error == U_ERROR_COMMON_SUCCESS) {
+            unreadLength = pReceiveBuffer->length - pReceiveBuffer->readIndex;
+            if (unreadLength < lengthBytes) {
+                // Not enough to satisfy the caller: move what is
+                // unread to the start of the buffer and, provided there
+                // is room, see if there is more to be had, only
+                // blocking if there is nothing at all to give back
+                bufferRewind(pClient);
+                if ((pReceiveBuffer->lengthBuffered < pReceiveBuffer->dataBufferSize) &&
+                    !bufferFill(pClient, unreadLength == 0) && (unreadLength == 0)) {
+                    if (pClient->debugOn) {
+                        uPortLog("U_AT_CLIENT_%d-%d: timeout.\n",
+                                 pClient->streamType, pClient->streamHandle);
+                    }
+                    setError(pClient, U_ERROR_COMMON_DEVICE_ERROR);
+                    consecutiveTimeout(pClient);
+                }
+                pReceiveBuffer = pClient->pReceiveBuffer;
+                unreadLength = pReceiveBuffer->length - pReceiveBuffer->readIndex;
+            }
+            sizeOrErrorCode = (int32_t) pClient->error;
+            if (pClient->error == U_ERROR_COMMON_SUCCESS) {
+                if (unreadLength > lengthBytes) {
+                    unreadLength = lengthBytes;
+                }
+                *ppData = U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
+                          pReceiveBuffer->readIndex;
+                pClient->peekLength = unreadLength;
+                sizeOrErrorCode = (int32_t) unreadLength;
+            }
+        }
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+
+    return sizeOrErrorCode;
+}
+
+// Consume bytes previously borrowed with uAtClientReadBytesPeek().
+void uAtClientReadBytesConsume(uAtClientHandle_t atHandle,
+                               size_t lengthBytes)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    uAtClientReceiveBuffer_t *pReceiveBuffer = pClient->pReceiveBuffer;
+    size_t unreadLength;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    // Only what was returned by uAtClientReadBytesPeek() may be consumed
+    unreadLength = pReceiveBuffer->length - pReceiveBuffer->readIndex;
+    if (unreadLength > pClient->peekLength) {
+        unreadLength = pClient->peekLength;
+    }
+    if (lengthBytes > unreadLength) {
+        lengthBytes = unreadLength;
+    }
+    pReceiveBuffer->readIndex += lengthBytes;
+    pClient->peekLength -= lengthBytes;
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+}
+
+// Read the next field or line of a response in place.
+int32_t uAtClientReadSpan(uAtClientHandle_t atHandle,
+                          uAtClientSpan_t *pSpan,
+                          bool wholeLine)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    if (pSpan != NULL) {
+        sizeOrErrorCode = (int32_t) pClient->error;
+        if (pClient->error == U_ERROR_COMMON_SUCCESS) {
+            sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+            if (!pClient->stopTag.found) {
+                sizeOrErrorCode = readSpan(pClient, pSpan, wholeLine);
+            }
+        }
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+
+    return sizeOrErrorCode;
+}
+
 // Stop the response part of an AT sequence.
 void uAtClientResponseStop(uAtClientHandle_t atHandle)
 {
@@ -3260,6 +4357,22 @@ void uAtClientResponseStop(uAtClientHandle_t atHandle)
     }
 
     pClient->lastResponseStopMs = uPortGetTickTimeMs();
+    if (pClient->delayMinMs >= 0) {
+        if ((pClient->error == U_ERROR_COMMON_SUCCESS) ||
+            (pClient->deviceError.type != U_AT_CLIENT_DEVICE_ERROR_TYPE_NO_ERROR)) {
+            // The AT server responded, try it a little quicker next time
+            pClient->delayLearntMs -= U_AT_CLIENT_ADAPTIVE_DELAY_STEP_MS;
+            if (pClient->delayLearntMs < pClient->delayMinMs) {
+                pClient->delayLearntMs = pClient->delayMinMs;
+            }
+        } else {
+            // A timeout: maybe we were too quick, back off
+            pClient->delayLearntMs = pClient->delayMs;
+        }
+    }
+    STATS_COMMAND_STOP(pClient);
+    TRACE(RESPONSE_STOP, pClient->error);
+    U_LOG_RAM_TRACE_END(AT_CLIENT, AT_COMMAND, pClient->error);
 
     U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
 }
@@ -3375,7 +4488,6 @@ int32_t uAtClientWaitCharacter(uAtClientHandle_t atHandle,
 {
     uErrorCode_t errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
     uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
-    uAtClientReceiveBuffer_t *pReceiveBuffer = pClient->pReceiveBuffer;
     int32_t stopTimeMs;
     bool urcFound;
 
@@ -3428,7 +4540,7 @@ int32_t uAtClientWaitCharacter(uAtClientHandle_t atHandle,
                 } else {
                     // Remove the processed stuff from the buffer
                     bufferRewind(pClient);
-                    if (pReceiveBuffer->length == 0) {
+                    if (pClient->pReceiveBuffer->length == 0) {
                         // If there's nothing left, try to get more stuff
                         if (!bufferFill(pClient, true)) {
                             // If we don't get any data within
@@ -3512,6 +4624,7 @@ int32_t uAtClientSetUrcHandler(uAtClientHandle_t atHandle,
 
         pUrc->pNext = pClient->pUrcList;
         pClient->pUrcList = pUrc;
+        urcHashTableRebuild(pClient);
 
         U_PORT_MUTEX_UNLOCK(pClient->urcPermittedMutex);
     }
@@ -3543,6 +4656,7 @@ void uAtClientRemoveUrcHandler(uAtClientHandle_t atHandle,
             } else {
                 pClient->pUrcList = pCurrent->pNext;
             }
+            urcHashTableRebuild(pClient);
 
             U_PORT_MUTEX_UNLOCK(pClient->urcPermittedMutex);
 
@@ -3568,6 +4682,9 @@ int32_t uAtClientUrcHandlerStackMinFree(uAtClientHandle_t atHandle)
         case U_AT_CLIENT_STREAM_TYPE_EDM:
             stackMinFree = uShortRangeEdmStreamAtEventStackMinFree(pClient->streamHandle);
             break;
+        case U_AT_CLIENT_STREAM_TYPE_CMUX:
+            stackMinFree = uCellMuxStreamEventStackMinFree(pClient->streamHandle);
+            break;
         default:
             break;
     }
@@ -3590,7 +4707,8 @@ int32_t uAtClientCallback(uAtClientHandle_t atHandle,
         cb.atHandle = atHandle;
         cb.pParam = pCallbackParam;
         cb.atClientMagicNumber = ((uAtClientInstance_t *) atHandle)->magicNumber;
-        errorCode = uPortEventQueueSend(gEventQueueHandle, &cb, sizeof(cb));
+        errorCode = uPortEventQueueSend(eventQueueHandleGet((uAtClientInstance_t *) atHandle),
+                                        &cb, sizeof(cb));
     }
 
     U_PORT_MUTEX_UNLOCK(gMutexEventQueue);
@@ -3598,6 +4716,47 @@ int32_t uAtClientCallback(uAtClientHandle_t atHandle,
     return errorCode;
 }
 
+// Give an AT client its own callback task.
+int32_t uAtClientCallbackTaskSet(uAtClientHandle_t atHandle,
+                                 size_t stackSizeBytes,
+                                 int32_t priority)
+{
+    int32_t errorCodeOrHandle = (int32_t) U_ERROR_COMMON_SUCCESS;
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    int32_t oldEventQueueHandle;
+
+    if (stackSizeBytes > 0) {
+        errorCodeOrHandle = uPortEventQueueOpen(eventQueueCallback,
+                                                "atClientCallbacks",
+                                                sizeof(uAtClientCallback_t),
+                                                stackSizeBytes, priority,
+                                                U_AT_CLIENT_CALLBACK_QUEUE_LENGTH);
+    } else {
+        // Back to the shared event queue
+        errorCodeOrHandle = -1;
+    }
+
+    if ((errorCodeOrHandle >= 0) || (stackSizeBytes == 0)) {
+
+        U_PORT_MUTEX_LOCK(gMutexEventQueue);
+
+        oldEventQueueHandle = pClient->eventQueueHandle;
+        pClient->eventQueueHandle = errorCodeOrHandle;
+
+        U_PORT_MUTEX_UNLOCK(gMutexEventQueue);
+
+        // Close any previous event queue outside the mutex
+        // since a callback running in it may be calling
+        // uAtClientCallback()
+        if (oldEventQueueHandle >= 0) {
+            uPortEventQueueClose(oldEventQueueHandle);
+        }
+        errorCodeOrHandle = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCodeOrHandle;
+}
+
 // Get the stack high watermark for the AT callback task.
 int32_t uAtClientCallbackStackMinFree()
 {
@@ -3760,6 +4919,52 @@ int32_t uAtClientStreamGet(uAtClientHandle_t atHandle,
     return pClient->streamHandle;
 }
 
+// Change the underlying stream of an AT client.
+int32_t uAtClientStreamSet(uAtClientHandle_t atHandle,
+                           int32_t streamHandle,
+                           uAtClientStream_t streamType)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int32_t oldStreamHandle;
+    uAtClientStream_t oldStreamType;
+
+    U_PORT_MUTEX_LOCK(gMutex);
+
+    if ((pClient != NULL) && (streamType < U_AT_CLIENT_STREAM_TYPE_MAX) &&
+        (pGetAtClientInstance(streamHandle, streamType) == NULL)) {
+
+        // Avoid pulling the rug out from under a URC, then
+        // lock the stream and the client, as for removeClient()
+        U_PORT_MUTEX_LOCK(pClient->urcPermittedMutex);
+        U_PORT_MUTEX_LOCK(pClient->streamMutex);
+        U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+        streamCallbackRemove(pClient);
+        oldStreamHandle = pClient->streamHandle;
+        oldStreamType = pClient->streamType;
+        pClient->streamHandle = streamHandle;
+        pClient->streamType = streamType;
+        errorCode = streamCallbackSet(pClient);
+        if (errorCode != 0) {
+            // Put the old stream back
+            pClient->streamHandle = oldStreamHandle;
+            pClient->streamType = oldStreamType;
+            streamCallbackSet(pClient);
+        }
+        // Anything buffered belonged to the old stream
+        bufferReset(pClient, true);
+
+        U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+        U_PORT_MUTEX_UNLOCK(pClient->streamMutex);
+        U_PORT_MUTEX_UNLOCK(pClient->urcPermittedMutex);
+    }
+
+    U_PORT_MUTEX_UNLOCK(gMutex);
+
+    return errorCode;
+}
+
 // Add a transmit intercept function.
 void uAtClientStreamInterceptTx(uAtClientHandle_t atHandle,
                                 const char *(*pCallback) (uAtClientHandle_t,
@@ -3946,4 +5151,76 @@ int32_t uAtClientGetActivityPin(const uAtClientHandle_t atHandle)
 
     return activityPin;
 }
+
+// Get the run-time statistics.
+int32_t uAtClientStatsGet(const uAtClientHandle_t atHandle,
+                          uAtClientStats_t *pStats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+#ifdef U_CFG_AT_CLIENT_STATS
+    const uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+
+    errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    if (pStats != NULL) {
+
+        U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+        *pStats = pClient->stats;
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+
+        U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+    }
+#else
+    (void) atHandle;
+    (void) pStats;
+#endif
+
+    return errorCode;
+}
+
+// Reset the run-time statistics.
+void uAtClientStatsReset(uAtClientHandle_t atHandle)
+{
+#ifdef U_CFG_AT_CLIENT_STATS
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    memset(&(pClient->stats), 0, sizeof(pClient->stats));
+    pClient->pStatsCommand = NULL;
+    pClient->statsCommandInProgress = false;
+    if (pClient->pStatsTagLocked != NULL) {
+        // Locked at the moment: count the rest of it as untagged
+        pClient->pStatsTagLocked = &(pClient->stats.untagged);
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+#else
+    (void) atHandle;
+#endif
+}
+
+// Tag subsequent use of the AT client by the calling task.
+void uAtClientStatsTagSet(uAtClientHandle_t atHandle, const char *pTag)
+{
+#ifdef U_CFG_AT_CLIENT_STATS
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    uPortTaskHandle_t task = NULL;
+
+    if (pClient != NULL) {
+
+        U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+        uPortTaskGetHandle(&task);
+        pClient->pStatsTag = pTag;
+        pClient->statsTagTask = task;
+
+        U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+    }
+#else
+    (void) atHandle;
+    (void) pTag;
+#endif
+}
+
 // End of file
@@ -59,6 +59,10 @@
 #include "u_at_client_test.h"
 #include "u_at_client_test_data.h"
 
+#ifdef U_CFG_AT_CLIENT_TRACE
+# include "u_log_ram.h"
+#endif
+
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
@@ -164,6 +168,14 @@ static int32_t gUartBHandle = -1;
  */
 static int32_t gConsecutiveTimeout;
 
+/** The task that callbackTaskCallback() was last called in.
+ */
+static uPortTaskHandle_t gCallbackTaskHandle = NULL;
+
+/** The number of times callbackTaskCallback() has been called.
+ */
+static volatile int32_t gCallbackTaskCount = 0;
+
 /** For tracking heap lost to memory  lost by the C library.
  */
 static size_t gSystemHeapLost = 0;
@@ -209,6 +221,33 @@ static void consecutiveTimeoutCallback(uAtClientHandle_t atHandle,
     gConsecutiveTimeout = *pCount;
 }
 
+// Callback queued by callbackTaskGet(): remembers the task it is
+// called in.
+static void callbackTaskCallback(uAtClientHandle_t atHandle, void *pParam)
+{
+    (void) atHandle;
+    (void) pParam;
+
+    uPortTaskGetHandle(&gCallbackTaskHandle);
+    gCallbackTaskCount++;
+}
+
+// Queue a callback with uAtClientCallback(), wait for it to be
+// called and return the handle of the task it was called in.
+static uPortTaskHandle_t callbackTaskGet(uAtClientHandle_t atHandle)
+{
+    gCallbackTaskHandle = NULL;
+    gCallbackTaskCount = 0;
+    U_PORT_TEST_ASSERT(uAtClientCallback(atHandle, callbackTaskCallback, NULL) == 0);
+    for (size_t x = 0; (x < 100) && (gCallbackTaskCount == 0); x++) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(gCallbackTaskCount == 1);
+    U_PORT_TEST_ASSERT(gCallbackTaskHandle != NULL);
+
+    return gCallbackTaskHandle;
+}
+
 // Check the stack extents for the URC and callbacks tasks.
 static void checkStackExtents(uAtClientHandle_t atHandle)
 {
@@ -858,6 +897,197 @@ static char *pInterceptRx(uAtClientHandle_t atHandle,
     return pData;
 }
 
+#  ifdef U_CFG_AT_CLIENT_STATS
+// Check the statistics of an AT client once the first numCommands
+// commands of pTestSet have been run, all under the tag pTag, with
+// numUrcs URCs arriving; returns zero if all is as expected.
+static int32_t checkStats(uAtClientHandle_t atClientHandle,
+                          const uAtClientTestCommandResponse_t *pTestSet,
+                          size_t numCommands, size_t numUrcs,
+                          const char *pTag)
+{
+    int32_t lastError = 0;
+    uAtClientStats_t *pStats;
+    const uAtClientStatsCommand_t *pCommand;
+    const uAtClientStatsTag_t *pTagStats = NULL;
+    uint32_t numCompleted = 0;
+    uint32_t numErrors = 0;
+    uint32_t numErrorsExpected = 0;
+    uint32_t histogramCount;
+
+    for (size_t x = 0; x < numCommands; x++) {
+        if (pTestSet[x].response.type != U_AT_CLIENT_TEST_RESPONSE_OK) {
+            numErrorsExpected++;
+        }
+    }
+
+    // Too big for the stack
+    pStats = (uAtClientStats_t *) pUPortMalloc(sizeof(*pStats));
+    if (pStats == NULL) {
+        return -1;
+    }
+
+    if (uAtClientStatsGet(atClientHandle, pStats) == 0) {
+        U_TEST_PRINT_LINE("stats: %d byte(s) sent, %d byte(s) received, %d URC(s),"
+                          " %d read stall(s), %d command(s) untracked.",
+                          pStats->txBytes, pStats->rxBytes, pStats->numUrcs,
+                          pStats->numReadStalls, pStats->numCommandsUntracked);
+        if ((pStats->txBytes == 0) || (pStats->rxBytes == 0)) {
+            lastError = 2;
+        }
+        if (pStats->numUrcs != numUrcs) {
+            lastError = 3;
+        }
+        for (size_t x = 0; x < U_AT_CLIENT_STATS_NUM_COMMANDS; x++) {
+            pCommand = &(pStats->command[x]);
+            if (pCommand->prefix[0] != 0) {
+                histogramCount = 0;
+                for (size_t y = 0; y < U_AT_CLIENT_STATS_LATENCY_NUM_BINS; y++) {
+                    histogramCount += pCommand->latencyHistogram[y];
+                }
+                if (histogramCount != pCommand->count) {
+                    lastError = 4;
+                }
+                if (pCommand->errorCount > pCommand->count) {
+                    lastError = 5;
+                }
+                if ((pCommand->maxUs > pCommand->totalUs) ||
+                    (pCommand->totalUs > ((uint64_t) pCommand->maxUs) * pCommand->count)) {
+                    lastError = 6;
+                }
+                numCompleted += pCommand->count;
+                numErrors += pCommand->errorCount;
+            }
+        }
+        if (numCompleted + pStats->numCommandsUntracked != numCommands) {
+            lastError = 7;
+        }
+        // Errors can only be accounted for if every command was tracked
+        if ((pStats->numCommandsUntracked == 0) && (numErrors != numErrorsExpected)) {
+            U_TEST_PRINT_LINE("stats: %d command(s) ended in error, expected %d.",
+                              numErrors, numErrorsExpected);
+            lastError = 8;
+        }
+        for (size_t x = 0; (x < U_AT_CLIENT_STATS_NUM_TAGS) && (pTagStats == NULL); x++) {
+            if ((pStats->tag[x].pTag != NULL) && (strcmp(pStats->tag[x].pTag, pTag) == 0)) {
+                pTagStats = &(pStats->tag[x]);
+            }
+        }
+        if (pTagStats != NULL) {
+            U_TEST_PRINT_LINE("stats: tag \"%s\" %d lock(s), %d command(s), locked"
+                              " for %d ms.", pTag, pTagStats->numLocks,
+                              pTagStats->numCommands, pTagStats->lockedMs);
+            if ((pTagStats->numLocks != numCommands) ||
+                (pTagStats->numCommands != numCommands)) {
+                lastError = 10;
+            }
+            if ((pTagStats->txBytes == 0) || (pTagStats->txBytes > pStats->txBytes)) {
+                lastError = 11;
+            }
+        } else {
+            lastError = 9;
+        }
+    } else {
+        lastError = 1;
+    }
+
+    if (lastError != 0) {
+        U_TEST_PRINT_LINE("stats check failed (%d).", lastError);
+    }
+
+    uPortFree(pStats);
+
+    return lastError;
+}
+#  endif
+
+#  ifdef U_CFG_AT_CLIENT_TRACE
+// Check the binary trace of an AT client in the RAM log, emptying
+// the log, once numCommands commands have been run with numUrcs
+// URCs arriving and both intercept functions in place; returns zero
+// if all is as expected.  If the log has wrapped, losing the oldest
+// entries, the counts can only be checked for consistency.
+static int32_t checkTrace(size_t numCommands, size_t numUrcs)
+{
+    int32_t lastError = 0;
+    uLogRamEntry_t entries[16];
+    size_t numEntries;
+    size_t totalEntries = 0;
+    size_t numCommandStart = 0;
+    size_t numResponseStop = 0;
+    size_t numBufferFill = 0;
+    size_t numUrcStart = 0;
+    size_t numUrcStop = 0;
+    size_t numInterceptRx = 0;
+    size_t numInterceptTx = 0;
+
+    do {
+        numEntries = uLogRamGet(entries, sizeof(entries) / sizeof(entries[0]));
+        for (size_t x = 0; x < numEntries; x++) {
+            switch (entries[x].event) {
+                case U_LOG_RAM_EVENT_AT_COMMAND_START:
+                    numCommandStart++;
+                    break;
+                case U_LOG_RAM_EVENT_AT_RESPONSE_STOP:
+                    numResponseStop++;
+                    break;
+                case U_LOG_RAM_EVENT_AT_BUFFER_FILL:
+                    numBufferFill++;
+                    break;
+                case U_LOG_RAM_EVENT_AT_URC_START:
+                    numUrcStart++;
+                    break;
+                case U_LOG_RAM_EVENT_AT_URC_STOP:
+                    numUrcStop++;
+                    break;
+                case U_LOG_RAM_EVENT_AT_INTERCEPT_RX:
+                    numInterceptRx++;
+                    break;
+                case U_LOG_RAM_EVENT_AT_INTERCEPT_TX:
+                    numInterceptTx++;
+                    break;
+                default:
+                    break;
+            }
+        }
+        totalEntries += numEntries;
+    } while (numEntries > 0);
+
+    U_TEST_PRINT_LINE("trace: %d entries, %d command start(s), %d response"
+                      " stop(s), %d buffer fill(s), %d URC start(s), %d URC"
+                      " stop(s), %d intercept Rx, %d intercept Tx.",
+                      totalEntries, numCommandStart, numResponseStop,
+                      numBufferFill, numUrcStart, numUrcStop,
+                      numInterceptRx, numInterceptTx);
+    if ((numCommandStart == 0) || (numResponseStop == 0)) {
+        lastError = 1;
+    }
+    if ((numCommandStart > numCommands) || (numResponseStop > numCommands) ||
+        (numUrcStart > numUrcs)) {
+        lastError = 2;
+    }
+    // Start/stop pairs may only be split by the wrap
+    if ((numCommandStart > numResponseStop + 1) || (numResponseStop > numCommandStart + 1) ||
+        (numUrcStart > numUrcStop + 1) || (numUrcStop > numUrcStart + 1)) {
+        lastError = 3;
+    }
+    if ((totalEntries < U_LOG_RAM_ENTRIES_MAX_NUM - 1) &&
+        ((numCommandStart != numCommands) || (numResponseStop != numCommands) ||
+         (numUrcStart != numUrcs) || (numUrcStop != numUrcs))) {
+        lastError = 4;
+    }
+    if ((numBufferFill == 0) || (numInterceptRx == 0) || (numInterceptTx == 0)) {
+        lastError = 5;
+    }
+
+    if (lastError != 0) {
+        U_TEST_PRINT_LINE("trace check failed (%d).", lastError);
+    }
+
+    return lastError;
+}
+#  endif
+
 # endif
 #endif
 
@@ -1058,6 +1288,9 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientConfiguration")
     bool thingIsOn;
     int32_t x;
     char c;
+    uPortTaskHandle_t thisTaskHandle = NULL;
+    uPortTaskHandle_t sharedTaskHandle;
+    uPortTaskHandle_t taskHandle;
     int32_t heapUsed;
     int32_t heapClibLossOffset = (int32_t) gSystemHeapLost;
 
@@ -1134,6 +1367,27 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientConfiguration")
     U_TEST_PRINT_LINE("delay is now %d ms.", x);
     U_PORT_TEST_ASSERT(x == U_AT_CLIENT_DEFAULT_DELAY_MS + 1);
 
+    x = uAtClientReceiveBufferPeakGet(atClientHandle);
+    U_TEST_PRINT_LINE("peak receive buffer usage is %d byte(s).", x);
+    U_PORT_TEST_ASSERT((x >= (int32_t) U_AT_CLIENT_BUFFER_OVERHEAD_BYTES) &&
+                       (x <= (int32_t) U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES));
+
+    U_TEST_PRINT_LINE("allowing the receive buffer to grow...");
+    U_PORT_TEST_ASSERT(uAtClientReceiveBufferGrowSet(atClientHandle,
+                                                     U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES * 2,
+                                                     0) < 0);
+    U_PORT_TEST_ASSERT(uAtClientReceiveBufferGrowSet(atClientHandle,
+                                                     U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES * 2,
+                                                     64) == 0);
+    U_PORT_TEST_ASSERT(uAtClientReceiveBufferGrowSet(atClientHandle, 0, 0) == 0);
+
+#ifdef U_CFG_AT_CLIENT_STATS
+    U_PORT_TEST_ASSERT(uAtClientStatsGet(atClientHandle, NULL) < 0);
+#else
+    U_PORT_TEST_ASSERT(uAtClientStatsGet(atClientHandle, NULL) ==
+                       (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
+#endif
+
     // Can't do much with this other than set it
     U_TEST_PRINT_LINE("setting consecutive AT timeout callback...");
     uAtClientTimeoutCallbackSet(atClientHandle,
@@ -1142,6 +1396,24 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientConfiguration")
     // Check the stack extents for the URC and callbacks tasks
     checkStackExtents(atClientHandle);
 
+    U_TEST_PRINT_LINE("checking that callbacks run in the configured task...");
+    U_PORT_TEST_ASSERT(uPortTaskGetHandle(&thisTaskHandle) == 0);
+    sharedTaskHandle = callbackTaskGet(atClientHandle);
+    U_PORT_TEST_ASSERT(sharedTaskHandle != thisTaskHandle);
+    // Give the AT client a callback task of its own, twice,
+    // checking that callbacks move to it each time
+    for (size_t y = 0; y < 2; y++) {
+        U_PORT_TEST_ASSERT(uAtClientCallbackTaskSet(atClientHandle,
+                                                    U_AT_CLIENT_CALLBACK_TASK_STACK_SIZE_BYTES,
+                                                    U_AT_CLIENT_CALLBACK_TASK_PRIORITY) == 0);
+        taskHandle = callbackTaskGet(atClientHandle);
+        U_PORT_TEST_ASSERT(taskHandle != sharedTaskHandle);
+        U_PORT_TEST_ASSERT(taskHandle != thisTaskHandle);
+    }
+    // Back to the shared task
+    U_PORT_TEST_ASSERT(uAtClientCallbackTaskSet(atClientHandle, 0, 0) == 0);
+    U_PORT_TEST_ASSERT(callbackTaskGet(atClientHandle) == sharedTaskHandle);
+
     U_TEST_PRINT_LINE("removing AT client...");
     uAtClientRemove(atClientHandle);
     uAtClientDeinit();
@@ -1189,6 +1461,8 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientCommandSet1")
     char t = 'T';
     char r = 'R';
     bool restoreStopTag;
+    int32_t statsError = 0;
+    int32_t traceError = 0;
     int32_t heapUsed;
     int32_t heapClibLossOffset = (int32_t) gSystemHeapLost;
 
@@ -1234,6 +1508,15 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientCommandSet1")
     uAtClientStreamInterceptTx(atClientHandle, pInterceptTx, (void *) &t);
     uAtClientStreamInterceptRx(atClientHandle, pInterceptRx, (void *) &r);
 
+#ifdef U_CFG_AT_CLIENT_STATS
+    uAtClientStatsReset(atClientHandle);
+    uAtClientStatsTagSet(atClientHandle, "atClientCommandSet1");
+#endif
+#ifdef U_CFG_AT_CLIENT_TRACE
+    // Capture the binary trace of the AT client
+    U_PORT_TEST_ASSERT(uLogRamInit(NULL));
+#endif
+
     U_TEST_PRINT_LINE("%d command(s)/response(s) to execute.", gAtClientTestSetSize1);
     pCommandResponse = gAtClientTestSet1;
     for (x = 0; (x < gAtClientTestSetSize1) && (lastError == 0); x++) {
@@ -1505,6 +1788,16 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientCommandSet1")
                           checkUrc.lastError);
     }
 
+#ifdef U_CFG_AT_CLIENT_STATS
+    statsError = checkStats(atClientHandle, gAtClientTestSet1, x,
+                            checkUrc.count, "atClientCommandSet1");
+    uAtClientStatsTagSet(atClientHandle, NULL);
+#endif
+#ifdef U_CFG_AT_CLIENT_TRACE
+    traceError = checkTrace(x, checkUrc.count);
+    uLogRamDeinit();
+#endif
+
     // Check the stack extents for the URC and callbacks tasks
     checkStackExtents(atClientHandle);
 
@@ -1528,6 +1821,8 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientCommandSet1")
     U_PORT_TEST_ASSERT(checkUrc.count == U_AT_CLIENT_TEST_NUM_URCS_SET_1);
     U_PORT_TEST_ASSERT(checkUrc.passIndex == U_AT_CLIENT_TEST_NUM_URCS_SET_1);
     U_PORT_TEST_ASSERT(gConsecutiveTimeout == 0);
+    U_PORT_TEST_ASSERT(statsError == 0);
+    U_PORT_TEST_ASSERT(traceError == 0);
 
 #ifndef __XTENSA__
     // Check for memory leaks
@@ -0,0 +1,392 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Throughput benchmarks for the AT client, run against the
+ * virtual SARA module of port/platform/common/automation/scripts/
+ * u_virtual_modem.py on the end of U_CFG_APP_CELL_UART; only
+ * compiled if U_CFG_TEST_VIRTUAL_MODEM is defined, since a real
+ * module would need a network for the socket part.  Like
+ * u_utils_test_benchmark.c these don't pass or fail on speed, they
+ * print one line per benchmark, of the form:
+ *
+ * U_BENCHMARK,<name>,<bytes per op>,<ops>,<ms>,<ops per second>,<kbytes per second>,<CPU us/kbyte>
+ *
+ * ...where CPU time is that of the whole process, as returned by
+ * the C library clock(), which is meaningful on the Windows and
+ * Linux builds that the virtual modem is intended for; it is -1
+ * where clock() is not available.  Since the latency and bandwidth
+ * of the virtual modem are fixed by its command-line the results
+ * are deterministic enough to compare library changes with.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+#include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcmp(), memset()
+#include "time.h"      // clock()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+#include "u_port_uart.h"
+
+#include "u_at_client.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_AT_CLIENT_BENCHMARK_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_AT_CLIENT_TEST_BENCHMARK_DURATION_MS
+/** How long to run each benchmark for.
+ */
+#define U_AT_CLIENT_TEST_BENCHMARK_DURATION_MS 5000
+#endif
+
+#ifndef U_AT_CLIENT_TEST_BENCHMARK_BAUD_RATE
+/** The baud rate to open the UART at; the virtual modem sets the
+ * bandwidth actually achieved.
+ */
+#define U_AT_CLIENT_TEST_BENCHMARK_BAUD_RATE 115200
+#endif
+
+#ifndef U_AT_CLIENT_TEST_BENCHMARK_SOCKET_LENGTH_BYTES
+/** The amount of data to send in each +USOWR and read back in
+ * each +USORD, the largest a SARA-R5 module allows in binary mode.
+ */
+#define U_AT_CLIENT_TEST_BENCHMARK_SOCKET_LENGTH_BYTES 1024
+#endif
+
+#if defined(U_CFG_TEST_VIRTUAL_MODEM) && (U_CFG_APP_CELL_UART >= 0)
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A benchmark: performs one operation, returning the number of
+ * bytes of payload moved (which may be zero) or negative error code.
+ */
+typedef int32_t (*uAtClientTestBenchmarkFunction_t)(uAtClientHandle_t atHandle,
+                                                     int32_t socketId,
+                                                     char *pBuffer);
+
+/** A benchmark.
+ */
+typedef struct {
+    const char *pName;
+    uAtClientTestBenchmarkFunction_t pFunction;
+} uAtClientTestBenchmark_t;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: THE BENCHMARKS
+ * -------------------------------------------------------------- */
+
+// The simplest AT command there is: measures the overhead.
+static int32_t benchmarkAt(uAtClientHandle_t atHandle, int32_t socketId,
+                           char *pBuffer)
+{
+    (void) socketId;
+    (void) pBuffer;
+    uAtClientLock(atHandle);
+    uAtClientCommandStart(atHandle, "AT");
+    uAtClientCommandStopReadResponse(atHandle);
+    return uAtClientUnlock(atHandle);
+}
+
+// An AT command with an information response.
+static int32_t benchmarkAtInformation(uAtClientHandle_t atHandle, int32_t socketId,
+                                      char *pBuffer)
+{
+    int32_t errorCodeOrSize;
+
+    (void) socketId;
+    uAtClientLock(atHandle);
+    uAtClientCommandStart(atHandle, "AT+CGMI");
+    uAtClientCommandStop(atHandle);
+    uAtClientResponseStart(atHandle, NULL);
+    errorCodeOrSize = uAtClientReadString(atHandle, pBuffer,
+                                          U_AT_CLIENT_TEST_BENCHMARK_SOCKET_LENGTH_BYTES,
+                                          false);
+    uAtClientResponseStop(atHandle);
+    if (uAtClientUnlock(atHandle) < 0) {
+        errorCodeOrSize = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+    }
+
+    return errorCodeOrSize;
+}
+
+// Write a block of data to the loop-back socket in binary mode, as
+// u_cell_sock.c does, and read it back again, building the commands
+// either parameter by parameter or with uAtClientCommandf().
+static int32_t socketLoopBack(uAtClientHandle_t atHandle, int32_t socketId,
+                              char *pBuffer, bool useCommandf)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+    char *pReceive = pBuffer + U_AT_CLIENT_TEST_BENCHMARK_SOCKET_LENGTH_BYTES;
+    int32_t sentSize = -1;
+    int32_t receivedSize = -1;
+
+    uAtClientLock(atHandle);
+    if (useCommandf) {
+        uAtClientCommandf(atHandle, "AT+USOWR=%d,%d", (int) socketId,
+                          U_AT_CLIENT_TEST_BENCHMARK_SOCKET_LENGTH_BYTES);
+    } else {
+        uAtClientCommandStart(atHandle, "AT+USOWR=");
+        uAtClientWriteInt(atHandle, socketId);
+        uAtClientWriteInt(atHandle, U_AT_CLIENT_TEST_BENCHMARK_SOCKET_LENGTH_BYTES);
+        uAtClientCommandStop(atHandle);
+    }
+    if (uAtClientWaitCharacter(atHandle, '@') == 0) {
+        uAtClientWriteBytes(atHandle, pBuffer,
+                            U_AT_CLIENT_TEST_BENCHMARK_SOCKET_LENGTH_BYTES, true);
+        uAtClientResponseStart(atHandle, "+USOWR:");
+        uAtClientSkipParameters(atHandle, 1);
+        sentSize = uAtClientReadInt(atHandle);
+        uAtClientResponseStop(atHandle);
+    }
+    if ((uAtClientUnlock(atHandle) == 0) &&
+        (sentSize == U_AT_CLIENT_TEST_BENCHMARK_SOCKET_LENGTH_BYTES)) {
+        uAtClientLock(atHandle);
+        if (useCommandf) {
+            uAtClientCommandf(atHandle, "AT+USORD=%d,%d", (int) socketId,
+                              U_AT_CLIENT_TEST_BENCHMARK_SOCKET_LENGTH_BYTES);
+        } else {
+            uAtClientCommandStart(atHandle, "AT+USORD=");
+            uAtClientWriteInt(atHandle, socketId);
+            uAtClientWriteInt(atHandle, U_AT_CLIENT_TEST_BENCHMARK_SOCKET_LENGTH_BYTES);
+            uAtClientCommandStop(atHandle);
+        }
+        uAtClientResponseStart(atHandle, "+USORD:");
+        uAtClientSkipParameters(atHandle, 1);
+        receivedSize = uAtClientReadInt(atHandle);
+        if (receivedSize == U_AT_CLIENT_TEST_BENCHMARK_SOCKET_LENGTH_BYTES) {
+            // Binary mode, don't stop for anything, and get the
+            // leading quote mark out of the way
+            uAtClientIgnoreStopTag(atHandle);
+            uAtClientReadBytes(atHandle, NULL, 1, true);
+            uAtClientReadBytes(atHandle, pReceive, receivedSize, true);
+            uAtClientRestoreStopTag(atHandle);
+        }
+        uAtClientResponseStop(atHandle);
+        if ((uAtClientUnlock(atHandle) == 0) &&
+            (receivedSize == U_AT_CLIENT_TEST_BENCHMARK_SOCKET_LENGTH_BYTES) &&
+            (memcmp(pBuffer, pReceive, receivedSize) == 0)) {
+            errorCodeOrSize = sentSize + receivedSize;
+        }
+    }
+
+    return errorCodeOrSize;
+}
+
+// The socket loop-back with commands built parameter by parameter.
+static int32_t benchmarkSocketLoopBack(uAtClientHandle_t atHandle, int32_t socketId,
+                                       char *pBuffer)
+{
+    return socketLoopBack(atHandle, socketId, pBuffer, false);
+}
+
+// The socket loop-back with commands built by uAtClientCommandf().
+static int32_t benchmarkSocketLoopBackCommandf(uAtClientHandle_t atHandle,
+                                               int32_t socketId,
+                                               char *pBuffer)
+{
+    return socketLoopBack(atHandle, socketId, pBuffer, true);
+}
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The benchmarks.
+ */
+static const uAtClientTestBenchmark_t gBenchmark[] = {
+    {"at", benchmarkAt},
+    {"at_information", benchmarkAtInformation},
+    {"at_socket_loop_back", benchmarkSocketLoopBack},
+    {"at_socket_loop_back_commandf", benchmarkSocketLoopBackCommandf}
+};
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: MISC
+ * -------------------------------------------------------------- */
+
+// Run a benchmark and print the result.
+static bool run(const uAtClientTestBenchmark_t *pBenchmark,
+                uAtClientHandle_t atHandle, int32_t socketId,
+                char *pBuffer)
+{
+    bool success = true;
+    int32_t ops = 0;
+    int64_t bytes = 0;
+    int32_t cpuUsPerKbyte = -1;
+    int32_t durationMs;
+    int64_t startTimeMs;
+    clock_t startClock;
+    clock_t stopClock;
+    int32_t x;
+
+    startClock = clock();
+    startTimeMs = uPortGetTickTimeMs();
+    do {
+        x = pBenchmark->pFunction(atHandle, socketId, pBuffer);
+        success = (x >= 0);
+        if (success) {
+            bytes += x;
+            ops++;
+        }
+        durationMs = (int32_t) (uPortGetTickTimeMs() - startTimeMs);
+    } while (success && (durationMs < U_AT_CLIENT_TEST_BENCHMARK_DURATION_MS));
+    stopClock = clock();
+
+    if (success) {
+        if (durationMs <= 0) {
+            durationMs = 1;
+        }
+        if ((startClock != (clock_t) -1) && (stopClock != (clock_t) -1) && (bytes > 0)) {
+            //lint -e{647} Suppress suspicious truncation
+            cpuUsPerKbyte = (int32_t) ((((int64_t) (stopClock - startClock)) * 1000000 /
+                                        CLOCKS_PER_SEC) * 1024 / bytes);
+        }
+        uPortLog("U_BENCHMARK,%s,%d,%d,%d,%d,%d,%d\n", pBenchmark->pName,
+                 (int32_t) (bytes / ops), ops, durationMs,
+                 (int32_t) ((((int64_t) ops) * 1000) / durationMs),
+                 (int32_t) (bytes / durationMs), cpuUsPerKbyte);
+    } else {
+        U_TEST_PRINT_LINE("benchmark \"%s\" failed after %d operation(s).",
+                          pBenchmark->pName, ops);
+    }
+
+    return success;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TESTS
+ * -------------------------------------------------------------- */
+
+/** Run the benchmarks against a virtual SARA module.
+ */
+U_PORT_TEST_FUNCTION("[atClientBenchmark]", "atClientBenchmarkVirtualSara")
+{
+    int32_t heapUsed;
+    int32_t uartHandle;
+    uAtClientHandle_t atHandle;
+    char *pBuffer;
+    int32_t socketId = -1;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+
+    // Room to send from and, after it, to receive into
+    pBuffer = (char *) pUPortMalloc(U_AT_CLIENT_TEST_BENCHMARK_SOCKET_LENGTH_BYTES * 2);
+    U_PORT_TEST_ASSERT(pBuffer != NULL);
+    for (size_t x = 0; x < U_AT_CLIENT_TEST_BENCHMARK_SOCKET_LENGTH_BYTES; x++) {
+        *(pBuffer + x) = (char) (x * 7);
+    }
+
+    U_TEST_PRINT_LINE("virtual SARA module must be on UART %d.", U_CFG_APP_CELL_UART);
+    uartHandle = uPortUartOpen(U_CFG_APP_CELL_UART,
+                               U_AT_CLIENT_TEST_BENCHMARK_BAUD_RATE, NULL,
+                               U_CFG_TEST_UART_BUFFER_LENGTH_BYTES,
+                               U_CFG_APP_PIN_CELL_TXD,
+                               U_CFG_APP_PIN_CELL_RXD,
+                               U_CFG_APP_PIN_CELL_CTS,
+                               U_CFG_APP_PIN_CELL_RTS);
+    U_PORT_TEST_ASSERT(uartHandle >= 0);
+    atHandle = uAtClientAdd(uartHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                            NULL, U_AT_CLIENT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atHandle != NULL);
+    uAtClientPrintAtSet(atHandle, false);
+
+    // Switch echo off and open the loop-back socket
+    uAtClientLock(atHandle);
+    uAtClientCommandStart(atHandle, "ATE0");
+    uAtClientCommandStopReadResponse(atHandle);
+    uAtClientCommandStart(atHandle, "AT+USOCR=");
+    uAtClientWriteInt(atHandle, 6);
+    uAtClientCommandStop(atHandle);
+    uAtClientResponseStart(atHandle, "+USOCR:");
+    socketId = uAtClientReadInt(atHandle);
+    uAtClientResponseStop(atHandle);
+    U_PORT_TEST_ASSERT(uAtClientUnlock(atHandle) == 0);
+    U_PORT_TEST_ASSERT(socketId >= 0);
+
+    U_TEST_PRINT_LINE("running each benchmark for %d ms, results are lines"
+                      " beginning \"U_BENCHMARK,\".",
+                      U_AT_CLIENT_TEST_BENCHMARK_DURATION_MS);
+    uPortLog("U_BENCHMARK,name,bytes/op,ops,ms,ops/s,kbytes/s,cpu_us/kbyte\n");
+    for (size_t x = 0; x < sizeof(gBenchmark) / sizeof(gBenchmark[0]); x++) {
+        U_PORT_TEST_ASSERT(run(&(gBenchmark[x]), atHandle, socketId, pBuffer));
+        // Give any watchdog a bone
+        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+    }
+
+    uAtClientLock(atHandle);
+    uAtClientCommandStart(atHandle, "AT+USOCL=");
+    uAtClientWriteInt(atHandle, socketId);
+    uAtClientCommandStopReadResponse(atHandle);
+    U_PORT_TEST_ASSERT(uAtClientUnlock(atHandle) == 0);
+
+    uAtClientRemove(atHandle);
+    uPortUartClose(uartHandle);
+    uPortFree(pBuffer);
+    uAtClientDeinit();
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+#endif // #if defined(U_CFG_TEST_VIRTUAL_MODEM) && (U_CFG_APP_CELL_UART >= 0)
+
+// End of file
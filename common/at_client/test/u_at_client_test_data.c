@@ -111,16 +111,101 @@
  */
 #define U_AT_CLIENT_TEST_BYTES_TWO_LENGTH 3
 
+/** Ten characters, for building U_AT_CLIENT_TEST_ECHO_SPAN_LONG.
+ */
+#define U_AT_CLIENT_TEST_ECHO_SPAN_TEN "0123456789"
+
+/** A field that is longer than the receive buffer of the AT client
+ * used in these tests.
+ */
+#define U_AT_CLIENT_TEST_ECHO_SPAN_LONG U_AT_CLIENT_TEST_ECHO_SPAN_TEN U_AT_CLIENT_TEST_ECHO_SPAN_TEN \
+                                        U_AT_CLIENT_TEST_ECHO_SPAN_TEN U_AT_CLIENT_TEST_ECHO_SPAN_TEN \
+                                        U_AT_CLIENT_TEST_ECHO_SPAN_TEN U_AT_CLIENT_TEST_ECHO_SPAN_TEN \
+                                        U_AT_CLIENT_TEST_ECHO_SPAN_TEN U_AT_CLIENT_TEST_ECHO_SPAN_TEN \
+                                        U_AT_CLIENT_TEST_ECHO_SPAN_TEN U_AT_CLIENT_TEST_ECHO_SPAN_TEN \
+                                        U_AT_CLIENT_TEST_ECHO_SPAN_TEN U_AT_CLIENT_TEST_ECHO_SPAN_TEN \
+                                        U_AT_CLIENT_TEST_ECHO_SPAN_TEN U_AT_CLIENT_TEST_ECHO_SPAN_TEN \
+                                        U_AT_CLIENT_TEST_ECHO_SPAN_TEN U_AT_CLIENT_TEST_ECHO_SPAN_TEN \
+                                        U_AT_CLIENT_TEST_ECHO_SPAN_TEN U_AT_CLIENT_TEST_ECHO_SPAN_TEN \
+                                        U_AT_CLIENT_TEST_ECHO_SPAN_TEN U_AT_CLIENT_TEST_ECHO_SPAN_TEN \
+                                        U_AT_CLIENT_TEST_ECHO_SPAN_TEN U_AT_CLIENT_TEST_ECHO_SPAN_TEN \
+                                        U_AT_CLIENT_TEST_ECHO_SPAN_TEN U_AT_CLIENT_TEST_ECHO_SPAN_TEN \
+                                        U_AT_CLIENT_TEST_ECHO_SPAN_TEN U_AT_CLIENT_TEST_ECHO_SPAN_TEN \
+                                        U_AT_CLIENT_TEST_ECHO_SPAN_TEN U_AT_CLIENT_TEST_ECHO_SPAN_TEN \
+                                        U_AT_CLIENT_TEST_ECHO_SPAN_TEN U_AT_CLIENT_TEST_ECHO_SPAN_TEN
+
+/** Response string for checking uAtClientReadSpan(): has a quoted
+ * delimiter, something like an item of the AT+COPS=? response, an
+ * empty field and, at the end, a field that won't fit in the
+ * receive buffer.
+ */
+#define U_AT_CLIENT_TEST_ECHO_SPAN "\r\n" U_AT_CLIENT_TEST_PREFIX " string1,\"str,ing2\"," \
+                                   "(3,\"x\"),," U_AT_CLIENT_TEST_ECHO_SPAN_LONG "\r\nOK\r\n"
+
+/** The number of characters in U_AT_CLIENT_TEST_ECHO_SPAN.
+ */
+#define U_AT_CLIENT_TEST_ECHO_SPAN_LENGTH (sizeof(U_AT_CLIENT_TEST_ECHO_SPAN) - 1)
+
+/** Response string for checking the hashed dispatch of URCs: with
+ * the default U_AT_CLIENT_URC_HASH_TABLE_SIZE "+UCP:" falls into the
+ * same hash bucket as "+UTA", "+UTA" is a substring of "+UTAB:" and
+ * the URC handler for "+UTAB:" is only set once the response line
+ * has been read.
+ */
+#define U_AT_CLIENT_TEST_ECHO_URC_HASH "\r\n+UTA 0\r\n+UCP: 1\r\n" U_AT_CLIENT_TEST_PREFIX \
+                                       " 7\r\n+UTAB: 2\r\n+UTA 0\r\n+UCP: 1\r\nOK\r\n"
+
+/** The number of characters in U_AT_CLIENT_TEST_ECHO_URC_HASH.
+ */
+#define U_AT_CLIENT_TEST_ECHO_URC_HASH_LENGTH (sizeof(U_AT_CLIENT_TEST_ECHO_URC_HASH) - 1)
+
+/** The prefix of the response lines of the pipeline test.
+ */
+#define U_AT_CLIENT_TEST_PIPELINE_PREFIX "+PIPE:"
+
+/** Response string for checking uAtClientReadBytesPeek() and
+ * uAtClientReadBytesConsume(): the data is longer than the receive
+ * buffer so it can only be peeked at across a refill.
+ */
+#define U_AT_CLIENT_TEST_ECHO_PEEK "\r\n" U_AT_CLIENT_TEST_PREFIX " " \
+                                   U_AT_CLIENT_TEST_ECHO_SPAN_LONG "\r\nOK\r\n"
+
+/** The number of characters in U_AT_CLIENT_TEST_ECHO_PEEK.
+ */
+#define U_AT_CLIENT_TEST_ECHO_PEEK_LENGTH (sizeof(U_AT_CLIENT_TEST_ECHO_PEEK) - 1)
+
 /** When testing timeouts we start a timer when waiting for the
  * response whereas the timer actually starts when the AT client
  * is locked so allow a tolerance because of that.
  */
 #define U_AT_CLIENT_TEST_TIMEOUT_TOLERANCE_MS 5
 
+/** The tolerance on the delay between AT commands measured by
+ * handleDelayAdaptive().
+ */
+#define U_AT_CLIENT_TEST_DELAY_TOLERANCE_MS 10
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** Used by handleUrcHash() to keep track of what arrives at
+ * each URC handler.
+ */
+typedef struct {
+    size_t index; /** The index of the URC in uAtClientTestEchoUrcHash_t. */
+    size_t count; /** The number of times the URC handler has been called. */
+    size_t numWrong; /** The number of URCs meant for another URC handler. */
+} uAtClientTestUrcHashCheck_t;
+
+/** Used by handleWriteBytesV() to capture what the AT client writes.
+ */
+typedef struct {
+    char buffer[64]; /** The bytes written. */
+    size_t length; /** The number of bytes written, may exceed the size of buffer. */
+    size_t numFlushes; /** The number of times the transmit intercept was flushed. */
+} uAtClientTestWriteCapture_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -541,6 +626,73 @@ static const uAtClientTestEchoError_t gAtClientTestEchoTimeout = {1000,
                                                                   1500
                                                                  };
 
+/** Parameters for the span test, matches U_AT_CLIENT_TEST_ECHO_SPAN,
+ * to be referenced in gAtClientTestSet2.
+ */
+//lint -e{785} Suppress too few initialisers
+static const uAtClientTestEchoSpan_t gAtClientTestEchoSpan = {U_AT_CLIENT_TEST_PREFIX, 6, true,
+    {"string1", "\"str,ing2\"", "(3", "\"x\")", "", U_AT_CLIENT_TEST_ECHO_SPAN_LONG}
+};
+
+/** Somewhere to put the fields reassembled by handleSpan().
+ */
+static char gSpanField[sizeof(U_AT_CLIENT_TEST_ECHO_SPAN_LONG)];
+
+/** Parameters for the URC hash test, matches U_AT_CLIENT_TEST_ECHO_URC_HASH,
+ * to be referenced in gAtClientTestSet2.
+ */
+//lint -e{785} Suppress too few initialisers
+static const uAtClientTestEchoUrcHash_t gAtClientTestEchoUrcHash = {U_AT_CLIENT_TEST_PREFIX, 7, 3,
+    {{"+UTA", false, 2}, {"+UCP:", false, 2}, {"+UTAB:", true, 1}}
+};
+
+/** Parameters for the pipeline test, to be referenced in
+ * gAtClientTestSet2: there is an ERROR in the middle of the
+ * window, which should not stop the commands after it.
+ */
+static const uAtClientTestEchoPipeline_t gAtClientTestEchoPipeline = {
+    U_AT_CLIENT_TEST_PIPELINE_PREFIX, 5, 3,
+    {
+        "\r\n" U_AT_CLIENT_TEST_PIPELINE_PREFIX " 0\r\nOK\r\n",
+        "\r\n" U_AT_CLIENT_TEST_PIPELINE_PREFIX " 1\r\nOK\r\n",
+        "\r\n" U_AT_CLIENT_TEST_ERROR "\r\n",
+        "\r\n" U_AT_CLIENT_TEST_PIPELINE_PREFIX " 3\r\nOK\r\n",
+        "\r\n" U_AT_CLIENT_TEST_PIPELINE_PREFIX " 4\r\nOK\r\n"
+    },
+    {
+        (int32_t) U_ERROR_COMMON_SUCCESS, (int32_t) U_ERROR_COMMON_SUCCESS,
+        (int32_t) U_ERROR_COMMON_DEVICE_ERROR, (int32_t) U_ERROR_COMMON_SUCCESS,
+        (int32_t) U_ERROR_COMMON_SUCCESS
+    }
+};
+
+/** Parameters for the write bytes V test, to be referenced in
+ * gAtClientTestSet2: includes binary data and an empty fragment.
+ */
+//lint -e{785} Suppress too few initialisers
+static const uAtClientTestEchoWriteBytesV_t gAtClientTestEchoWriteBytesV = {5,
+    {
+        {"\r\n" U_AT_CLIENT_TEST_PREFIX " ", U_AT_CLIENT_TEST_PREFIX_LENGTH + 3},
+        {U_AT_CLIENT_TEST_BYTES_TWO, U_AT_CLIENT_TEST_BYTES_TWO_LENGTH},
+        {"", 0},
+        {U_AT_CLIENT_TEST_STRING_THREE, U_AT_CLIENT_TEST_STRING_THREE_LENGTH},
+        {"\r\nOK\r\n", 6}
+    }
+};
+
+/** Parameters for the adaptive delay test, to be referenced in
+ * gAtClientTestSet2: there are enough commands for the delay
+ * to have fallen to zero were it not held at the minimum.
+ */
+static const uAtClientTestEchoDelayAdaptive_t gAtClientTestEchoDelayAdaptive = {50, 25, 55, 500};
+
+/** Parameters for the peek test, matches U_AT_CLIENT_TEST_ECHO_PEEK,
+ * to be referenced in gAtClientTestSet2.
+ */
+static const uAtClientTestEchoPeek_t gAtClientTestEchoPeek = {U_AT_CLIENT_TEST_PREFIX,
+    U_AT_CLIENT_TEST_ECHO_SPAN_LONG, sizeof(U_AT_CLIENT_TEST_ECHO_SPAN_LONG) - 1, 4
+};
+
 /** Parameters for misc test, matches U_AT_CLIENT_TEST_ECHO_SKIP
  * and gAtClientUrc5, to be referenced in gAtClientTestSet2.
  */
@@ -851,6 +1003,571 @@ static int32_t handleNullBuffer(uAtClientHandle_t atClientHandle,
     return lastError;
 }
 
+// Function to check that the fields of a response can be read,
+// in place, with uAtClientReadSpan(), including one that is
+// longer than the receive buffer, referenced by gAtClientTestSet2.
+// pParameter is a pointer to uAtClientTestEchoSpan_t.
+// Returns zero on success, else error.
+static int32_t handleSpan(uAtClientHandle_t atClientHandle,
+                          size_t index, const void *pParameter)
+{
+    int32_t lastError = 0;
+    const uAtClientTestEchoSpan_t *pSpanTest;
+    uAtClientSpan_t span = {0};
+    size_t length;
+    bool partialSeen = false;
+    int32_t y;
+
+    pSpanTest = (const uAtClientTestEchoSpan_t *) pParameter;
+
+    U_TEST_PRINT_LINE_X("checking that %d field(s) can be read with"
+                        " uAtClientReadSpan().", index + 1,
+                        pSpanTest->numFields);
+
+    // Begin processing the response
+    uAtClientResponseStart(atClientHandle, pSpanTest->pPrefix);
+
+    for (size_t x = 0; (x < pSpanTest->numFields) && (lastError == 0); x++) {
+        // Put the field back together, piece by piece
+        length = 0;
+        do {
+            y = uAtClientReadSpan(atClientHandle, &span, false);
+            if (y < 0) {
+                U_TEST_PRINT_LINE_X("uAtClientReadSpan() returned %d for"
+                                    " field %d.", index + 1, y, x + 1);
+                lastError = 1;
+            } else if ((y != (int32_t) span.length) ||
+                       (length + span.length >= sizeof(gSpanField))) {
+                U_TEST_PRINT_LINE_X("field %d is too long (%d).", index + 1,
+                                    x + 1, length + span.length);
+                lastError = 2;
+            } else {
+                memcpy(gSpanField + length, span.pData, span.length);
+                length += span.length;
+                if (span.isPartial) {
+                    partialSeen = true;
+                }
+            }
+        } while ((lastError == 0) && span.isPartial);
+        if (lastError == 0) {
+            gSpanField[length] = 0;
+            if (strcmp(gSpanField, pSpanTest->pFields[x]) != 0) {
+                U_TEST_PRINT_LINE_X("field %d is \"%s\" when \"%s\" was"
+                                    " expected.", index + 1, x + 1,
+                                    gSpanField, pSpanTest->pFields[x]);
+                lastError = 3;
+            } else if (span.isLast != (x == pSpanTest->numFields - 1)) {
+                U_TEST_PRINT_LINE_X("field %d has isLast %d.", index + 1,
+                                    x + 1, span.isLast);
+                lastError = 4;
+            }
+        }
+    }
+
+    if (lastError == 0) {
+        if (partialSeen != pSpanTest->partialExpected) {
+            U_TEST_PRINT_LINE_X("partial span %sseen when it was%s expected.",
+                                index + 1, partialSeen ? "" : "not ",
+                                pSpanTest->partialExpected ? "" : " not");
+            lastError = 5;
+        } else if (uAtClientReadSpan(atClientHandle, &span, false) !=
+                   (int32_t) U_ERROR_COMMON_NOT_FOUND) {
+            U_TEST_PRINT_LINE_X("a span was read after the last field.",
+                                index + 1);
+            lastError = 6;
+        }
+    }
+
+    // Finish off
+    uAtClientResponseStop(atClientHandle);
+
+    return lastError;
+}
+
+// URC handler used by handleUrcHash(): the single parameter of
+// the URC should be the index of the URC it was meant for.
+// pParameter is a pointer to uAtClientTestUrcHashCheck_t.
+static void urcHashHandler(uAtClientHandle_t atClientHandle,
+                           void *pParameter)
+{
+    uAtClientTestUrcHashCheck_t *pCheck = (uAtClientTestUrcHashCheck_t *) pParameter;
+
+    if (uAtClientReadInt(atClientHandle) != (int32_t) pCheck->index) {
+        pCheck->numWrong++;
+    }
+    pCheck->count++;
+}
+
+// Function to check that URCs are dispatched to the right handler
+// where prefixes share a hash bucket or one prefix is a substring
+// of another, and where a URC handler is set after dispatch has
+// started, referenced by gAtClientTestSet2.
+// pParameter is a pointer to uAtClientTestEchoUrcHash_t.
+// Returns zero on success, else error.
+static int32_t handleUrcHash(uAtClientHandle_t atClientHandle,
+                             size_t index, const void *pParameter)
+{
+    int32_t lastError = 0;
+    const uAtClientTestEchoUrcHash_t *pUrcHashTest;
+    const uAtClientTestUrcHashUrc_t *pUrc;
+    uAtClientTestUrcHashCheck_t check[U_AT_CLIENT_TEST_MAX_NUM_URC_HASH];
+    int32_t y;
+
+    pUrcHashTest = (const uAtClientTestEchoUrcHash_t *) pParameter;
+    memset(check, 0, sizeof(check));
+
+    U_TEST_PRINT_LINE_X("checking that %d URC(s) are dispatched correctly.",
+                        index + 1, pUrcHashTest->numUrcs);
+
+    // Set the URC handlers, all but the late ones
+    for (size_t x = 0; (x < pUrcHashTest->numUrcs) && (lastError == 0); x++) {
+        check[x].index = x;
+        if (!pUrcHashTest->urc[x].late) {
+            lastError = uAtClientSetUrcHandler(atClientHandle,
+                                               pUrcHashTest->urc[x].pPrefix,
+                                               urcHashHandler,
+                                               (void *) &(check[x]));
+        }
+    }
+
+    if (lastError == 0) {
+        // Begin processing the response, which will dispatch
+        // the URCs ahead of the response line
+        uAtClientResponseStart(atClientHandle, pUrcHashTest->pPrefix);
+        y = uAtClientReadInt(atClientHandle);
+        if (y != pUrcHashTest->value) {
+            U_TEST_PRINT_LINE_X("response line parameter was %d when %d was"
+                                " expected.", index + 1, y, pUrcHashTest->value);
+            lastError = 1;
+        }
+        // Now that dispatch has started, set the late URC handlers
+        for (size_t x = 0; (x < pUrcHashTest->numUrcs) && (lastError == 0); x++) {
+            if (pUrcHashTest->urc[x].late &&
+                (uAtClientSetUrcHandler(atClientHandle,
+                                        pUrcHashTest->urc[x].pPrefix,
+                                        urcHashHandler,
+                                        (void *) &(check[x])) != 0)) {
+                lastError = 2;
+            }
+        }
+        // Finish off, which will dispatch the URCs
+        // between the response line and the "OK"
+        uAtClientResponseStop(atClientHandle);
+    }
+
+    // Check that each URC arrived where it should, as often as it should
+    for (size_t x = 0; (x < pUrcHashTest->numUrcs) && (lastError == 0); x++) {
+        pUrc = &(pUrcHashTest->urc[x]);
+        if (check[x].numWrong > 0) {
+            U_TEST_PRINT_LINE_X("URC handler for \"%s\" was given %d URC(s)"
+                                " meant for another.", index + 1,
+                                pUrc->pPrefix, check[x].numWrong);
+            lastError = 3;
+        } else if (check[x].count != pUrc->count) {
+            U_TEST_PRINT_LINE_X("URC \"%s\" arrived %d time(s) when %d was"
+                                " expected.", index + 1, pUrc->pPrefix,
+                                check[x].count, pUrc->count);
+            lastError = 4;
+        }
+    }
+
+    // Remove the URC handlers again
+    for (size_t x = 0; x < pUrcHashTest->numUrcs; x++) {
+        uAtClientRemoveUrcHandler(atClientHandle, pUrcHashTest->urc[x].pPrefix);
+    }
+
+    return lastError;
+}
+
+// Transmit intercept used by handleWriteBytesV(): copies what is
+// written into the uAtClientTestWriteCapture_t at pContext and
+// counts the flushes, passing the data on unchanged.
+static const char *writeCaptureInterceptTx(uAtClientHandle_t atClientHandle,
+                                           const char **ppData,
+                                           size_t *pLength,
+                                           void *pContext)
+{
+    uAtClientTestWriteCapture_t *pCapture = (uAtClientTestWriteCapture_t *) pContext;
+    const char *pDataToWrite = NULL;
+
+    (void) atClientHandle;
+
+    if (ppData != NULL) {
+        pDataToWrite = *ppData;
+        if (pCapture->length + *pLength <= sizeof(pCapture->buffer)) {
+            memcpy(pCapture->buffer + pCapture->length, *ppData, *pLength);
+        }
+        pCapture->length += *pLength;
+        *ppData += *pLength;
+    } else {
+        pCapture->numFlushes++;
+    }
+
+    return pDataToWrite;
+}
+
+// Send an AT command made of a parameter and then the fragments of
+// pWriteTest, either with uAtClientWriteBytesV() or as a sequence of
+// uAtClientWriteBytes() calls that should produce the same thing, and
+// read the echoed response; used by handleWriteBytesV().  What is
+// written is put in pCapture, the number of flushes up to the end of
+// the fragments in pNumFlushes, and the number of bytes reported
+// written is returned.
+static size_t writeBytesCapture(uAtClientHandle_t atClientHandle,
+                                const uAtClientTestEchoWriteBytesV_t *pWriteTest,
+                                bool useV, bool standalone,
+                                uAtClientTestWriteCapture_t *pCapture,
+                                size_t *pNumFlushes)
+{
+    size_t length = 0;
+
+    memset(pCapture, 0, sizeof(*pCapture));
+    uAtClientStreamInterceptTx(atClientHandle, writeCaptureInterceptTx,
+                               (void *) pCapture);
+
+    uAtClientCommandStart(atClientHandle, NULL);
+    // So that a delimiter is required before the fragments
+    uAtClientWriteInt(atClientHandle, 1);
+    if (useV) {
+        length = uAtClientWriteBytesV(atClientHandle, pWriteTest->ioVec,
+                                      pWriteTest->numIoVec, standalone);
+    } else {
+        for (size_t x = 0; x < pWriteTest->numIoVec; x++) {
+            // Only the first fragment may be delimited
+            length += uAtClientWriteBytes(atClientHandle,
+                                          pWriteTest->ioVec[x].pData,
+                                          pWriteTest->ioVec[x].lengthBytes,
+                                          standalone || (x > 0));
+        }
+    }
+    *pNumFlushes = pCapture->numFlushes;
+    uAtClientCommandStop(atClientHandle);
+    uAtClientResponseStart(atClientHandle, NULL);
+    uAtClientResponseStop(atClientHandle);
+
+    uAtClientStreamInterceptTx(atClientHandle, NULL, NULL);
+
+    return length;
+}
+
+// Send an AT command that will be echoed back as "OK" and read the
+// response, used by handleDelayAdaptive(); returns the time that
+// uAtClientCommandStart() took, which is the delay it applied.
+static int32_t commandDelayMeasure(uAtClientHandle_t atClientHandle)
+{
+    int32_t startTimeMs;
+    int32_t durationMs;
+
+    startTimeMs = uPortGetTickTimeMs();
+    uAtClientCommandStart(atClientHandle, "\r\nOK\r\n");
+    durationMs = uPortGetTickTimeMs() - startTimeMs;
+    uAtClientCommandStop(atClientHandle);
+    uAtClientResponseStart(atClientHandle, NULL);
+    uAtClientResponseStop(atClientHandle);
+
+    return durationMs;
+}
+
+// Function to check that, with adaptive pacing switched on, the
+// delay between AT commands is reduced with each response, is
+// held at the minimum and goes back to the uAtClientDelaySet()
+// value after a timeout, referenced by gAtClientTestSet2.
+// pParameter is a pointer to uAtClientTestEchoDelayAdaptive_t.
+// Returns zero on success, else error.
+static int32_t handleDelayAdaptive(uAtClientHandle_t atClientHandle,
+                                   size_t index, const void *pParameter)
+{
+    int32_t lastError = 0;
+    const uAtClientTestEchoDelayAdaptive_t *pDelayTest;
+    int32_t delayMs;
+    int32_t expectedMs;
+    int32_t durationMs;
+
+    pDelayTest = (const uAtClientTestEchoDelayAdaptive_t *) pParameter;
+
+    U_TEST_PRINT_LINE_X("checking that the delay between AT commands adapts"
+                        " from %d ms down to %d ms over %d command(s).",
+                        index + 1, pDelayTest->delayMs, pDelayTest->minDelayMs,
+                        pDelayTest->numCommands);
+
+    // Remember the delay so that it can be put back afterwards
+    delayMs = uAtClientDelayGet(atClientHandle);
+    uAtClientDelaySet(atClientHandle, pDelayTest->delayMs);
+    uAtClientDelayAdaptiveSet(atClientHandle, pDelayTest->minDelayMs);
+
+    for (size_t x = 0; (x < pDelayTest->numCommands) && (lastError == 0); x++) {
+        durationMs = commandDelayMeasure(atClientHandle);
+        expectedMs = pDelayTest->delayMs - (int32_t) (x * U_AT_CLIENT_ADAPTIVE_DELAY_STEP_MS);
+        if (expectedMs < pDelayTest->minDelayMs) {
+            expectedMs = pDelayTest->minDelayMs;
+        }
+        // The first command follows no response of ours
+        // so there is nothing to check for it
+        if ((x > 0) &&
+            ((durationMs < expectedMs - U_AT_CLIENT_TEST_DELAY_TOLERANCE_MS) ||
+             (durationMs > expectedMs + U_AT_CLIENT_TEST_DELAY_TOLERANCE_MS))) {
+            U_TEST_PRINT_LINE_X("delay before command %d was %d ms when %d ms"
+                                " was expected.", index + 1, x + 1, durationMs,
+                                expectedMs);
+            lastError = 1;
+        }
+        if ((lastError == 0) && (uAtClientErrorGet(atClientHandle) != 0)) {
+            U_TEST_PRINT_LINE_X("command %d failed.", index + 1, x + 1);
+            lastError = 2;
+        }
+    }
+
+    if (lastError == 0) {
+        // Send a command that gets no response: the
+        // timeout should put the delay back to the start
+        uAtClientTimeoutSet(atClientHandle, pDelayTest->atTimeoutMs);
+        uAtClientCommandStart(atClientHandle, NULL);
+        uAtClientCommandStop(atClientHandle);
+        uAtClientResponseStart(atClientHandle, NULL);
+        uAtClientResponseStop(atClientHandle);
+        if (uAtClientErrorGet(atClientHandle) == 0) {
+            U_TEST_PRINT_LINE_X("command without a response did not time out.",
+                                index + 1);
+            lastError = 3;
+        }
+        uAtClientClearError(atClientHandle);
+        if (lastError == 0) {
+            durationMs = commandDelayMeasure(atClientHandle);
+            if ((durationMs < pDelayTest->delayMs - U_AT_CLIENT_TEST_DELAY_TOLERANCE_MS) ||
+                (durationMs > pDelayTest->delayMs + U_AT_CLIENT_TEST_DELAY_TOLERANCE_MS)) {
+                U_TEST_PRINT_LINE_X("delay after a timeout was %d ms when %d ms"
+                                    " was expected.", index + 1, durationMs,
+                                    pDelayTest->delayMs);
+                lastError = 4;
+            }
+        }
+    }
+
+    // Put things back as they were
+    uAtClientDelayAdaptiveSet(atClientHandle, -1);
+    uAtClientDelaySet(atClientHandle, delayMs);
+
+    return lastError;
+}
+
+// Function to check that uAtClientWriteBytesV() writes exactly what
+// the equivalent sequence of uAtClientWriteBytes() calls would, with
+// and without standalone, flushing only once at the end if standalone,
+// referenced by gAtClientTestSet2.
+// pParameter is a pointer to uAtClientTestEchoWriteBytesV_t.
+// Returns zero on success, else error.
+static int32_t handleWriteBytesV(uAtClientHandle_t atClientHandle,
+                                 size_t index, const void *pParameter)
+{
+    int32_t lastError = 0;
+    const uAtClientTestEchoWriteBytesV_t *pWriteTest;
+    uAtClientTestWriteCapture_t captureSequence;
+    uAtClientTestWriteCapture_t captureV;
+    size_t numFlushes;
+    size_t lengthSequence;
+    size_t lengthV;
+    size_t lengthExpected = 0;
+    bool standalone;
+
+    pWriteTest = (const uAtClientTestEchoWriteBytesV_t *) pParameter;
+    for (size_t x = 0; x < pWriteTest->numIoVec; x++) {
+        lengthExpected += pWriteTest->ioVec[x].lengthBytes;
+    }
+
+    U_TEST_PRINT_LINE_X("checking that uAtClientWriteBytesV() of %d fragment(s)"
+                        " matches uAtClientWriteBytes().", index + 1,
+                        pWriteTest->numIoVec);
+
+    for (size_t x = 0; (x < 2) && (lastError == 0); x++) {
+        standalone = (x == 0);
+        lengthSequence = writeBytesCapture(atClientHandle, pWriteTest, false,
+                                           standalone, &captureSequence, &numFlushes);
+        lengthV = writeBytesCapture(atClientHandle, pWriteTest, true,
+                                    standalone, &captureV, &numFlushes);
+        if (uAtClientErrorGet(atClientHandle) != 0) {
+            U_TEST_PRINT_LINE_X("AT client error %d (standalone %d).", index + 1,
+                                uAtClientErrorGet(atClientHandle), standalone);
+            lastError = 1;
+        } else if ((lengthV != lengthExpected) || (lengthSequence != lengthExpected)) {
+            U_TEST_PRINT_LINE_X("%d byte(s) written with uAtClientWriteBytesV() and"
+                                " %d byte(s) with uAtClientWriteBytes() when %d"
+                                " were expected (standalone %d).", index + 1,
+                                lengthV, lengthSequence, lengthExpected, standalone);
+            lastError = 2;
+        } else if ((captureV.length != captureSequence.length) ||
+                   (captureV.length > sizeof(captureV.buffer)) ||
+                   (memcmp(captureV.buffer, captureSequence.buffer, captureV.length) != 0)) {
+            U_TEST_PRINT_LINE_X("output of uAtClientWriteBytesV() (%d byte(s)) does"
+                                " not match that of uAtClientWriteBytes() (%d"
+                                " byte(s)) (standalone %d).", index + 1,
+                                captureV.length, captureSequence.length, standalone);
+            lastError = 3;
+        } else if (numFlushes != (standalone ? 1 : 0)) {
+            U_TEST_PRINT_LINE_X("uAtClientWriteBytesV() flushed %d time(s)"
+                                " (standalone %d).", index + 1, numFlushes,
+                                standalone);
+            lastError = 4;
+        }
+    }
+
+    return lastError;
+}
+
+// Response parser used by handlePipeline(): reads the single
+// parameter of the response line into the int32_t at pParameter.
+static void pipelineParser(uAtClientHandle_t atClientHandle,
+                           void *pParameter)
+{
+    *((int32_t *) pParameter) = uAtClientReadInt(atClientHandle);
+}
+
+// Function to check that uAtClientPipeline() matches the responses
+// to the commands in order and that an ERROR in the middle of the
+// window is recorded against the right command without stopping
+// the rest, referenced by gAtClientTestSet2.
+// pParameter is a pointer to uAtClientTestEchoPipeline_t.
+// Returns zero on success, else error.
+static int32_t handlePipeline(uAtClientHandle_t atClientHandle,
+                              size_t index, const void *pParameter)
+{
+    int32_t lastError = 0;
+    const uAtClientTestEchoPipeline_t *pPipelineTest;
+    uAtClientPipelineCommand_t commands[U_AT_CLIENT_TEST_MAX_NUM_PIPELINE];
+    int32_t value[U_AT_CLIENT_TEST_MAX_NUM_PIPELINE];
+    int32_t expectedErrorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t y;
+
+    pPipelineTest = (const uAtClientTestEchoPipeline_t *) pParameter;
+
+    U_TEST_PRINT_LINE_X("checking that %d command(s) can be pipelined with"
+                        " a window of %d.", index + 1,
+                        pPipelineTest->numCommands, pPipelineTest->windowSize);
+
+    memset(commands, 0, sizeof(commands));
+    for (size_t x = 0; x < pPipelineTest->numCommands; x++) {
+        value[x] = -1;
+        commands[x].pCommand = pPipelineTest->pCommands[x];
+        commands[x].pResponsePrefix = pPipelineTest->pPrefix;
+        commands[x].pResponseParser = pipelineParser;
+        commands[x].pResponseParserParameter = (void *) &(value[x]);
+        if ((expectedErrorCode == (int32_t) U_ERROR_COMMON_SUCCESS) &&
+            (pPipelineTest->errorCode[x] != (int32_t) U_ERROR_COMMON_SUCCESS)) {
+            expectedErrorCode = pPipelineTest->errorCode[x];
+        }
+    }
+
+    y = uAtClientPipeline(atClientHandle, commands, pPipelineTest->numCommands,
+                          pPipelineTest->windowSize);
+    if (y != expectedErrorCode) {
+        U_TEST_PRINT_LINE_X("uAtClientPipeline() returned %d when %d was"
+                            " expected.", index + 1, y, expectedErrorCode);
+        lastError = 1;
+    }
+
+    // Check that each response went to its own command
+    for (size_t x = 0; (x < pPipelineTest->numCommands) && (lastError == 0); x++) {
+        if (commands[x].errorCode != pPipelineTest->errorCode[x]) {
+            U_TEST_PRINT_LINE_X("command %d has error code %d when %d was"
+                                " expected.", index + 1, x + 1,
+                                commands[x].errorCode, pPipelineTest->errorCode[x]);
+            lastError = 2;
+        } else if ((commands[x].errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) &&
+                   (value[x] != (int32_t) x)) {
+            U_TEST_PRINT_LINE_X("command %d was given the response to command"
+                                " %d.", index + 1, x + 1, value[x] + 1);
+            lastError = 3;
+        }
+    }
+
+    return lastError;
+}
+
+// Function to check that uAtClientReadBytesPeek() does not consume
+// anything, that uAtClientReadBytesConsume() consumes no more than
+// was peeked and that data longer than the receive buffer can be
+// peeked at across a refill, referenced by gAtClientTestSet2.
+// pParameter is a pointer to uAtClientTestEchoPeek_t.
+// Returns zero on success, else error.
+static int32_t handlePeek(uAtClientHandle_t atClientHandle,
+                          size_t index, const void *pParameter)
+{
+    int32_t lastError = 0;
+    const uAtClientTestEchoPeek_t *pPeekTest;
+    const char *pData = NULL;
+    const char *pDataAgain = NULL;
+    size_t offset = 0;
+    size_t numPeeks = 0;
+    int32_t x;
+    int32_t y;
+
+    pPeekTest = (const uAtClientTestEchoPeek_t *) pParameter;
+
+    U_TEST_PRINT_LINE_X("checking that %d byte(s) can be peeked at and consumed.",
+                        index + 1, pPeekTest->length);
+
+    // Begin processing the response
+    uAtClientResponseStart(atClientHandle, pPeekTest->pPrefix);
+
+    // Peek twice: the second peek should return the same data
+    // since the first consumed nothing
+    x = uAtClientReadBytesPeek(atClientHandle, &pData, pPeekTest->lengthPeek);
+    y = uAtClientReadBytesPeek(atClientHandle, &pDataAgain, pPeekTest->lengthPeek);
+    if ((x <= 0) || (x > (int32_t) pPeekTest->lengthPeek) || (y < x)) {
+        U_TEST_PRINT_LINE_X("uAtClientReadBytesPeek() returned %d and then %d.",
+                            index + 1, x, y);
+        lastError = 1;
+    } else if ((memcmp(pData, pPeekTest->pData, x) != 0) ||
+               (memcmp(pDataAgain, pPeekTest->pData, x) != 0)) {
+        U_TEST_PRINT_LINE_X("peeked data is not as expected.", index + 1);
+        lastError = 2;
+    }
+
+    if (lastError == 0) {
+        // Try to consume more than was peeked, twice: only what
+        // was peeked should go
+        uAtClientReadBytesConsume(atClientHandle, y + pPeekTest->lengthPeek);
+        uAtClientReadBytesConsume(atClientHandle, pPeekTest->lengthPeek);
+        offset = y;
+        x = uAtClientReadBytesPeek(atClientHandle, &pData, pPeekTest->lengthPeek);
+        if ((x <= 0) || (memcmp(pData, pPeekTest->pData + offset, x) != 0)) {
+            U_TEST_PRINT_LINE_X("after consuming %d byte(s) peek returned %d"
+                                " and/or the wrong data.", index + 1, offset, x);
+            lastError = 3;
+        }
+    }
+
+    // Now peek at and consume the rest, which will only fit
+    // in the receive buffer in pieces
+    while ((lastError == 0) && (offset < pPeekTest->length)) {
+        x = uAtClientReadBytesPeek(atClientHandle, &pData,
+                                   pPeekTest->length - offset);
+        if (x <= 0) {
+            U_TEST_PRINT_LINE_X("uAtClientReadBytesPeek() returned %d at"
+                                " offset %d.", index + 1, x, offset);
+            lastError = 4;
+        } else if (memcmp(pData, pPeekTest->pData + offset, x) != 0) {
+            U_TEST_PRINT_LINE_X("%d byte(s) peeked at offset %d are not as"
+                                " expected.", index + 1, x, offset);
+            lastError = 5;
+        } else {
+            uAtClientReadBytesConsume(atClientHandle, x);
+            offset += x;
+            numPeeks++;
+        }
+    }
+
+    if ((lastError == 0) && (numPeeks < 2)) {
+        U_TEST_PRINT_LINE_X("the data was peeked at in one go, it should"
+                            " not fit in the receive buffer.", index + 1);
+        lastError = 6;
+    }
+
+    // Finish off
+    uAtClientResponseStop(atClientHandle);
+
+    return lastError;
+}
+
 // Function to check that attempts to read parameters when
 // the AT server has returned an error fail correctly,
 // referenced by gAtClientTestSet2.
@@ -2063,10 +2780,40 @@ const uAtClientTestEcho_t gAtClientTestSet2[] = {
         "", 0, NULL, handleReadOnError, (const void *) &gAtClientTestEchoTimeout,
         (int32_t) U_ERROR_COMMON_DEVICE_ERROR
     },
+    {
+        U_AT_CLIENT_TEST_ECHO_URC_HASH, U_AT_CLIENT_TEST_ECHO_URC_HASH_LENGTH, NULL,
+        handleUrcHash, (const void *) &gAtClientTestEchoUrcHash,
+        (int32_t) U_ERROR_COMMON_SUCCESS
+    },
+    {
+        U_AT_CLIENT_TEST_ECHO_PEEK, U_AT_CLIENT_TEST_ECHO_PEEK_LENGTH, NULL,
+        handlePeek, (const void *) &gAtClientTestEchoPeek,
+        (int32_t) U_ERROR_COMMON_SUCCESS
+    },
+    {
+        // The commands are sent by handleWriteBytesV() itself
+        "", 0, NULL, handleWriteBytesV, (const void *) &gAtClientTestEchoWriteBytesV,
+        (int32_t) U_ERROR_COMMON_SUCCESS
+    },
+    {
+        // The commands are sent by handleDelayAdaptive() itself
+        "", 0, NULL, handleDelayAdaptive, (const void *) &gAtClientTestEchoDelayAdaptive,
+        (int32_t) U_ERROR_COMMON_SUCCESS
+    },
+    {
+        // The commands are sent by handlePipeline() itself
+        "", 0, NULL, handlePipeline, (const void *) &gAtClientTestEchoPipeline,
+        (int32_t) U_ERROR_COMMON_DEVICE_ERROR
+    },
     {
         U_AT_CLIENT_TEST_ECHO_SKIP, U_AT_CLIENT_TEST_ECHO_SKIP_LENGTH, &gAtClientUrc5,
         handleMiscUseLast, (const void *) &gAtClientTestEchoMisc,
         (int32_t) U_ERROR_COMMON_SUCCESS
+    },
+    {
+        U_AT_CLIENT_TEST_ECHO_SPAN, U_AT_CLIENT_TEST_ECHO_SPAN_LENGTH, NULL,
+        handleSpan, (const void *) &gAtClientTestEchoSpan,
+        (int32_t) U_ERROR_COMMON_SUCCESS
     }
 };
 
@@ -39,6 +39,18 @@ extern "C" {
  */
 #define U_AT_CLIENT_TEST_MAX_NUM_LINES      10
 
+/** The maximum number of URCs in a "URC hash" test.
+ */
+#define U_AT_CLIENT_TEST_MAX_NUM_URC_HASH 4
+
+/** The maximum number of commands in a "pipeline" test.
+ */
+#define U_AT_CLIENT_TEST_MAX_NUM_PIPELINE 5
+
+/** The maximum number of fragments in a "write bytes V" test.
+ */
+#define U_AT_CLIENT_TEST_MAX_NUM_IO_VEC 5
+
 /** The expected line ending for outgoing commands.
  */
 #define U_AT_CLIENT_TEST_COMMAND_TERMINATOR "\r"
@@ -201,6 +213,76 @@ typedef struct {
     const uAtClientTestResponseLine_t *pUrc; /** The URC interleaved with it. */
 } uAtClientTestEchoMisc_t;
 
+/** Definition of pParameters for a "span" test.
+ */
+typedef struct {
+    const char *pPrefix; /** The prefix at the start of the response. */
+    size_t numFields; /** The number of fields in the response. */
+    bool partialExpected; /** True if one of the fields will not fit in the receive buffer. */
+    /** The raw contents of the fields, as uAtClientReadSpan() should return them. */
+    const char *pFields[U_AT_CLIENT_TEST_MAX_NUM_PARAMETERS];
+} uAtClientTestEchoSpan_t;
+
+/** Definition of a URC in a "URC hash" test.
+ */
+typedef struct {
+    const char *pPrefix; /** The prefix of the URC. */
+    bool late; /** True if the URC handler is only set once dispatch has started. */
+    size_t count; /** The number of times the URC should be dispatched. */
+} uAtClientTestUrcHashUrc_t;
+
+/** Definition of pParameters for a "URC hash" test: each URC line
+ * carries, as its single parameter, the index in urc[] of the
+ * URC it should be dispatched to.
+ */
+typedef struct {
+    const char *pPrefix; /** The prefix of the response line. */
+    int32_t value; /** The integer parameter of the response line. */
+    size_t numUrcs; /** The number of URCs in urc[]. */
+    uAtClientTestUrcHashUrc_t urc[U_AT_CLIENT_TEST_MAX_NUM_URC_HASH];
+} uAtClientTestEchoUrcHash_t;
+
+/** Definition of pParameters for a "pipeline" test: each command
+ * is echoed back as its own response so it is the response, with,
+ * as the single parameter of the response line, the index of the
+ * command in pCommands[].
+ */
+typedef struct {
+    const char *pPrefix; /** The prefix of the response lines. */
+    size_t numCommands; /** The number of commands in pCommands[]. */
+    size_t windowSize; /** The pipeline window size to use. */
+    const char *pCommands[U_AT_CLIENT_TEST_MAX_NUM_PIPELINE];
+    /** The error code expected for each command. */
+    int32_t errorCode[U_AT_CLIENT_TEST_MAX_NUM_PIPELINE];
+} uAtClientTestEchoPipeline_t;
+
+/** Definition of pParameters for a "write bytes V" test: the
+ * fragments, which are echoed back, must end with a response
+ * stop tag.
+ */
+typedef struct {
+    size_t numIoVec; /** The number of fragments in ioVec[]. */
+    uAtClientIoVec_t ioVec[U_AT_CLIENT_TEST_MAX_NUM_IO_VEC];
+} uAtClientTestEchoWriteBytesV_t;
+
+/** Definition of pParameters for an "adaptive delay" test.
+ */
+typedef struct {
+    int32_t delayMs; /** The delay to set with uAtClientDelaySet(). */
+    int32_t minDelayMs; /** The minimum delay to set with uAtClientDelayAdaptiveSet(). */
+    size_t numCommands; /** The number of commands to send, enough to reach minDelayMs. */
+    int32_t atTimeoutMs; /** The AT timeout to use when checking that a timeout resets the delay. */
+} uAtClientTestEchoDelayAdaptive_t;
+
+/** Definition of pParameters for a "peek" test.
+ */
+typedef struct {
+    const char *pPrefix; /** The prefix at the start of the response. */
+    const char *pData; /** The data following the prefix, as it should be peeked. */
+    size_t length; /** The number of bytes at pData. */
+    size_t lengthPeek; /** The number of bytes to peek at, and over-consume by, at the start. */
+} uAtClientTestEchoPeek_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
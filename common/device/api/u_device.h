@@ -41,6 +41,21 @@ extern "C" {
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_DEVICE_OPEN_TASK_STACK_SIZE_BYTES
+/** The stack size of the task that uDeviceOpenAsync() creates to
+ * open a device; this has to cope with all that uDeviceOpen()
+ * does, including talking to the module through the AT client.
+ */
+# define U_DEVICE_OPEN_TASK_STACK_SIZE_BYTES 3072
+#endif
+
+#ifndef U_DEVICE_OPEN_TASK_PRIORITY
+/** The priority of the task that uDeviceOpenAsync() creates to
+ * open a device.
+ */
+# define U_DEVICE_OPEN_TASK_PRIORITY U_CFG_OS_APP_TASK_PRIORITY
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -245,6 +260,42 @@ typedef struct {
        against it might end with the clause "; if this
        field is populated then the version field of
        this structure must be set to 1 or higher". */
+    size_t ringBufferLengthBytes; /**< The length of the ring buffer into
+                                       which data streamed from the GNSS
+                                       device is placed; use 0 for the
+                                       default of
+                                       #U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES.
+                                       If this field is populated then the
+                                       version field of this structure must
+                                       be set to 1 or higher. */
+    size_t readChunkLengthBytes;  /**< The maximum amount of data to read
+                                       from the GNSS device in one go; use
+                                       0 for the default, see
+                                       uGnssAddWithBufferSize().  If this
+                                       field is populated then the version
+                                       field of this structure must be set
+                                       to 1 or higher. */
+    int32_t uartBaudRateUpgrade;  /**< Only relevant if the GNSS device is
+                                       connected via UART: if this is
+                                       non-zero and different to the
+                                       baudRate field of #uDeviceCfgUart_t
+                                       then, once the GNSS device has been
+                                       powered on, it will be switched to
+                                       this baud rate (e.g. 115200), the
+                                       UART re-opened at the new rate and
+                                       communication confirmed; should
+                                       that fail the original baud rate is
+                                       restored and uDeviceOpen() will still
+                                       succeed.  The new rate is stored
+                                       in the battery-backed RAM of the
+                                       GNSS device (from M9 onwards) and
+                                       hence uDeviceOpen() will try this
+                                       rate first, falling back to the
+                                       baudRate field of #uDeviceCfgUart_t
+                                       only if there is no response.  If
+                                       this field is populated then the
+                                       version field of this structure must
+                                       be set to 2 or higher. */
 } uDeviceCfgGnss_t;
 
 /** Short-range device configuration.
@@ -266,6 +317,20 @@ typedef struct {
        against it might end with the clause "; if this
        field is populated then the version field of
        this structure must be set to 1 or higher". */
+    int32_t uartBaudRateUpgrade; /**< Only relevant if the short range
+                                      module is connected via UART: if
+                                      this is greater than the baudRate
+                                      field of #uDeviceCfgUart_t then
+                                      the module is switched to, and
+                                      stores, the fastest baud rate up
+                                      to this value that it and the MCU
+                                      support, with flow control, see
+                                      uShortRangeOpenUartBaudrateUpgrade();
+                                      e.g. 3000000 for NINA-W1.  The
+                                      CTS and RTS pins must be connected.
+                                      If this field is populated then the
+                                      version field of this structure must
+                                      be set to 1 or higher. */
 } uDeviceCfgShortRange_t;
 
 /** The complete device configuration.
@@ -344,6 +409,67 @@ int32_t uDeviceGetDefaults(uDeviceType_t deviceType,
 int32_t uDeviceOpen(const uDeviceCfg_t *pDeviceCfg,
                     uDeviceHandle_t *pDeviceHandle);
 
+/** Open a device instance, as uDeviceOpen() does, but in a task of
+ * its own, returning immediately; pCallback is called from that
+ * task when the device has been opened, or has failed to open.
+ * This allows several devices, e.g. a cellular module, which can
+ * take ten seconds or more to power on, a short-range module and
+ * a GNSS module, to be brought up at the same time, each on its
+ * own task, so that the time taken is that of the slowest rather
+ * than the sum of them all; see also uDeviceOpenMulti().
+ *
+ * Devices of different types are opened concurrently; devices of
+ * the same type are opened one after the other.  uDeviceDeinit()
+ * must not be called until all of the callbacks have been called.
+ *
+ * @param[in] pDeviceCfg    device configuration, cannot be NULL;
+ *                          this must remain valid, along with
+ *                          anything it points to, until pCallback
+ *                          has been called.
+ * @param[in] pCallback     the function to call when the open has
+ *                          completed, cannot be NULL; the parameters
+ *                          are pDeviceCfg, the device handle (NULL
+ *                          on failure), the return value of
+ *                          uDeviceOpen() and pCallbackParam.  The
+ *                          callback is called in the context of the
+ *                          opening task and so should not block.
+ * @param[in] pCallbackParam a parameter to pass to pCallback; may
+ *                          be NULL.
+ * @return                  zero if the open has been started, in
+ *                          which case pCallback will be called,
+ *                          else negative error code.
+ */
+int32_t uDeviceOpenAsync(const uDeviceCfg_t *pDeviceCfg,
+                         void (*pCallback) (const uDeviceCfg_t *,
+                                            uDeviceHandle_t,
+                                            int32_t,
+                                            void *),
+                         void *pCallbackParam);
+
+/** Open several device instances at the same time using
+ * uDeviceOpenAsync(), blocking until they have all either been
+ * opened or failed to open.
+ *
+ * @param[in] pDeviceCfgs     an array of numDevices device
+ *                            configurations, cannot be NULL.
+ * @param numDevices          the number of entries in pDeviceCfgs.
+ * @param[out] pDeviceHandles an array of numDevices places to put
+ *                            the device handles, cannot be NULL;
+ *                            an entry is set to NULL if that device
+ *                            failed to open.
+ * @param[out] pErrorCodes    an array of numDevices places to put
+ *                            the outcome of opening each device,
+ *                            zero on success else negative error
+ *                            code; may be NULL.
+ * @return                    the number of devices that were
+ *                            opened successfully else negative
+ *                            error code.
+ */
+int32_t uDeviceOpenMulti(const uDeviceCfg_t *pDeviceCfgs,
+                         size_t numDevices,
+                         uDeviceHandle_t *pDeviceHandles,
+                         int32_t *pErrorCodes);
+
 /** Close an open device instance, optionally powering it down.
  *
  * @param devHandle handle to a previously opened device.
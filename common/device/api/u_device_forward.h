@@ -0,0 +1,186 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_DEVICE_FORWARD_H_
+#define _U_DEVICE_FORWARD_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_device.h"
+#include "u_gnss_type.h"
+#include "u_sock.h"
+
+/** \addtogroup device Device
+ *  @{
+ */
+
+/** @file
+ * @brief A forwarding stage which sends the messages from a GNSS
+ * device that match a filter to a TCP socket, e.g. RTCM from a base
+ * station to an NTRIP caster.  The messages of an epoch are batched
+ * so that they go in a single write to the socket, which for a
+ * cellular module is a single +USOWR, rather than one write per
+ * message.  The last message of the epoch is written straight from
+ * the ring buffer of the GNSS device, without a copy, the ones
+ * before it having been copied once into a buffer provided by the
+ * application.  When the uplink cannot keep up, messages are dropped,
+ * whole, and counted, rather than the GNSS message receive task being
+ * held up.
+ *
+ * The end of an epoch is recognised as follows:
+ *
+ * - RTCM: an MSM message (e.g. 1074, 1084, 1094, 1124) with the
+ *   "multiple message" bit clear, i.e. the last MSM message of the
+ *   epoch; other RTCM messages (e.g. 1005, 1230) are held until the
+ *   epoch ends,
+ * - UBX: UBX-NAV-EOE; other UBX messages are held until the epoch
+ *   ends, so switch UBX-NAV-EOE on if you forward UBX messages,
+ * - anything else (e.g. NMEA) is sent as soon as it arrives.
+ *
+ * Held messages are also sent when the buffer is full or when a
+ * message arrives more than #U_DEVICE_FORWARD_HOLD_MAX_MS after the
+ * first message being held.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_DEVICE_FORWARD_HOLD_MAX_MS
+/** The longest that a message may be held waiting for the end of
+ * its epoch, in milliseconds; this is only checked when a message
+ * arrives.
+ */
+# define U_DEVICE_FORWARD_HOLD_MAX_MS 1000
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Statistics for a forwarding stage, see uDeviceForwardStatsGet().
+ */
+typedef struct {
+    uint32_t numMessages;        /**< the number of messages that
+                                      matched the filter. */
+    uint32_t numMessagesDropped; /**< the number of messages that
+                                      were dropped because the uplink
+                                      could not keep up. */
+    uint32_t numBytesSent;       /**< the number of bytes written
+                                      to the socket. */
+    uint32_t numBytesDropped;    /**< the number of bytes dropped. */
+    uint32_t numWrites;          /**< the number of writes to the
+                                      socket. */
+    uint32_t numWritesShort;     /**< the number of writes to the
+                                      socket that did not send
+                                      everything, including those
+                                      that failed. */
+} uDeviceForwardStats_t;
+
+/** The context for a forwarding stage: the application must
+ * provide one of these to uDeviceForwardStart() and keep it, without
+ * touching the contents, until uDeviceForwardStop() has returned.
+ */
+typedef struct {
+    uDeviceHandle_t gnssHandle;   /**< the GNSS device. */
+    uSockDescriptor_t descriptor; /**< the socket. */
+    int32_t asyncHandle;          /**< the GNSS message receiver. */
+    char *pBuffer;                /**< the buffer for held messages. */
+    size_t bufferSize;            /**< the number of bytes at pBuffer. */
+    size_t length;                /**< the number of bytes held in pBuffer. */
+    int32_t holdStartTimeMs;      /**< when holding started. */
+    uDeviceForwardStats_t stats;  /**< the statistics. */
+} uDeviceForward_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Start forwarding the messages that match pMessageId from a GNSS
+ * device to a TCP socket.  The socket must already be connected;
+ * it is set to be non-blocking (see uSockBlockingSet()) so that a
+ * slow uplink causes messages to be dropped rather than the GNSS
+ * message receive task being held up.  Writes to the socket are made
+ * from the GNSS message receive task (see uGnssMsgReceiveStart()),
+ * hence that task needs enough stack for them.
+ *
+ * Data is only ever dropped as whole messages that have not been
+ * started, so that the stream arriving at the far end is not
+ * broken; this is why a message larger than bufferSize is always
+ * dropped, since the remainder could not be held if only part of it
+ * were sent.
+ *
+ * @param gnssHandle       the handle of the GNSS instance.
+ * @param[in] pMessageId   the messages to forward, e.g. type
+ *                         #U_GNSS_PROTOCOL_RTCM with the id set to
+ *                         #U_GNSS_RTCM_MESSAGE_ID_ALL for all RTCM
+ *                         messages; cannot be NULL.
+ * @param descriptor       the descriptor of a connected TCP socket.
+ * @param[in] pBuffer      storage for the messages of an epoch; this
+ *                         should be large enough for an epoch's worth
+ *                         of messages, and not less than the largest
+ *                         message (1029 bytes for RTCM), and must
+ *                         remain valid until uDeviceForwardStop() has
+ *                         returned; cannot be NULL.
+ * @param bufferSize       the number of bytes at pBuffer.
+ * @param[out] pForward    a pointer to the context for forwarding;
+ *                         cannot be NULL.
+ * @return                 zero on success else negative error code.
+ */
+int32_t uDeviceForwardStart(uDeviceHandle_t gnssHandle,
+                            const uGnssMessageId_t *pMessageId,
+                            uSockDescriptor_t descriptor,
+                            char *pBuffer, size_t bufferSize,
+                            uDeviceForward_t *pForward);
+
+/** Get the statistics of a forwarding stage; may be called at any
+ * time between uDeviceForwardStart() and uDeviceForwardStop().  The
+ * counts are read while forwarding may be going on, so they may be
+ * one message out of step with each other.
+ *
+ * @param[in] pForward  a pointer to the context that was passed to
+ *                      uDeviceForwardStart(); cannot be NULL.
+ * @param[out] pStats   a place to put the statistics; cannot be NULL.
+ */
+void uDeviceForwardStatsGet(const uDeviceForward_t *pForward,
+                            uDeviceForwardStats_t *pStats);
+
+/** Stop forwarding; anything still held is written to the socket,
+ * once, and whatever cannot be written is dropped.  The socket is
+ * left open, and non-blocking.
+ *
+ * @param[in] pForward  a pointer to the context that was passed to
+ *                      uDeviceForwardStart(); cannot be NULL.
+ * @return              zero on success else negative error code.
+ */
+int32_t uDeviceForwardStop(uDeviceForward_t *pForward);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_DEVICE_FORWARD_H_
+
+// End of file
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_DEVICE_METRICS_H_
+#define _U_DEVICE_METRICS_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup device Device
+ *  @{
+ */
+
+/** @file
+ * @brief A registry of metrics (counters, gauges and fixed-bucket
+ * histograms) with which any layer of ubxlib, or the application,
+ * may register, and which can be serialised in one go with
+ * uDeviceMetricsSnapshot(), e.g. to be sent to a fleet backend.
+ *
+ * The storage for a metric belongs to whoever registers it and
+ * would normally be static, initialised with one of the
+ * U_DEVICE_METRIC_xxx() macros below.  Updating a metric, with
+ * uDeviceMetricAdd(), uDeviceMetricSet() or uDeviceMetricSample(),
+ * takes no lock and costs just an atomic add, so these may be called
+ * from any task or from interrupt context.  Registration is also
+ * lock-free and needs no initialisation, so a metric may be
+ * registered at any time, even before uPortInit(), and registering
+ * one that is already registered does nothing.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_DEVICE_METRICS_MAX_NUM
+/** The maximum number of metrics that may be registered at any
+ * one time.
+ */
+# define U_DEVICE_METRICS_MAX_NUM 32
+#endif
+
+/** The version number written at the start of the binary form of
+ * uDeviceMetricsSnapshot(), incremented if that form changes.
+ */
+#define U_DEVICE_METRICS_BINARY_VERSION 1
+
+/** Initialiser for a counter metric; pName must be a string that
+ * remains valid while the metric is registered, made up of
+ * characters that need no escaping in JSON (e.g. "sock.tx_bytes")
+ * and no more than 255 characters long.
+ */
+#define U_DEVICE_METRIC_COUNTER(pName) {(pName), U_DEVICE_METRIC_TYPE_COUNTER, \
+                                        0, NULL, NULL, 0}
+
+/** Initialiser for a gauge metric; see #U_DEVICE_METRIC_COUNTER
+ * for the rules on pName.
+ */
+#define U_DEVICE_METRIC_GAUGE(pName) {(pName), U_DEVICE_METRIC_TYPE_GAUGE, \
+                                      0, NULL, NULL, 0}
+
+/** Initialiser for a histogram metric; see #U_DEVICE_METRIC_COUNTER
+ * for the rules on pName.  pBucketLimit must point to numBuckets - 1
+ * ascending int32_t values, the inclusive upper limit of each bucket
+ * but the last, which takes everything larger, and pBucketCount to
+ * an array of numBuckets uint32_t, which will be the counts; numBuckets
+ * must be at least 1 and no more than 255.
+ */
+#define U_DEVICE_METRIC_HISTOGRAM(pName, pBucketLimit, pBucketCount, numBuckets) \
+    {(pName), U_DEVICE_METRIC_TYPE_HISTOGRAM, 0, (pBucketLimit), (pBucketCount), (numBuckets)}
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The types of metric.
+ */
+typedef enum {
+    U_DEVICE_METRIC_TYPE_COUNTER,  /**< a uint32_t, added to, which wraps. */
+    U_DEVICE_METRIC_TYPE_GAUGE,    /**< an int32_t, set to a value. */
+    U_DEVICE_METRIC_TYPE_HISTOGRAM /**< a count per bucket of a sampled int32_t. */
+} uDeviceMetricType_t;
+
+/** A metric: initialise this with one of the U_DEVICE_METRIC_xxx()
+ * macros and then treat the contents as private, reading them
+ * through uDeviceMetricsSnapshot() or uDeviceMetricGet().
+ */
+typedef struct {
+    const char *pName;
+    uDeviceMetricType_t type;
+    volatile uint32_t value; /**< the count for a counter, the value
+                                  for a gauge (as a uint32_t) or the
+                                  number of samples for a histogram. */
+    const int32_t *pBucketLimit;
+    volatile uint32_t *pBucketCount;
+    size_t numBuckets;
+} uDeviceMetric_t;
+
+/** The forms that uDeviceMetricsSnapshot() can write.
+ */
+typedef enum {
+    /** JSON, a single object with a member per metric, the value
+     * of which is a number for a counter or gauge or an array of
+     * the bucket counts for a histogram, e.g.
+     * {"sock.tx_bytes":1024,"rsrp":-95,"latency":[3,10,0]}. */
+    U_DEVICE_METRICS_FORMAT_JSON,
+    /** A compact binary form: a byte of
+     * #U_DEVICE_METRICS_BINARY_VERSION and a byte giving the number
+     * of metrics then, for each metric, a byte of type
+     * (#uDeviceMetricType_t), a byte of name length, the name
+     * (not terminated) and then, for a counter or gauge, the
+     * four-byte little-endian value or, for a histogram, a byte
+     * giving the number of buckets followed by the four-byte
+     * little-endian count in each bucket. */
+    U_DEVICE_METRICS_FORMAT_BINARY
+} uDeviceMetricsFormat_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Register a metric; does nothing if the metric is already
+ * registered.  This may be called at any time.
+ *
+ * @param[in] pMetric a pointer to the metric, which must remain
+ *                    valid until it is deregistered; cannot be NULL.
+ * @return            zero on success else negative error code,
+ *                    #U_ERROR_COMMON_NO_MEMORY if there are already
+ *                    #U_DEVICE_METRICS_MAX_NUM metrics registered.
+ */
+int32_t uDeviceMetricRegister(uDeviceMetric_t *pMetric);
+
+/** Deregister a metric.  This must not be called while
+ * uDeviceMetricsSnapshot() is in progress in another task, since
+ * that may be reading the metric.
+ *
+ * @param[in] pMetric a pointer to the metric.
+ */
+void uDeviceMetricDeregister(const uDeviceMetric_t *pMetric);
+
+/** Add to a counter; this may be called from interrupt context
+ * and whether or not the counter is registered.
+ *
+ * @param[in] pMetric a pointer to a counter; cannot be NULL.
+ * @param amount      the amount to add.
+ */
+void uDeviceMetricAdd(uDeviceMetric_t *pMetric, uint32_t amount);
+
+/** Set the value of a gauge; this may be called from interrupt
+ * context and whether or not the gauge is registered.
+ *
+ * @param[in] pMetric a pointer to a gauge; cannot be NULL.
+ * @param value       the value.
+ */
+void uDeviceMetricSet(uDeviceMetric_t *pMetric, int32_t value);
+
+/** Add a sample to a histogram; this may be called from interrupt
+ * context and whether or not the histogram is registered.
+ *
+ * @param[in] pMetric a pointer to a histogram; cannot be NULL.
+ * @param value       the sample.
+ */
+void uDeviceMetricSample(uDeviceMetric_t *pMetric, int32_t value);
+
+/** Get the value of a metric: the count of a counter, the value
+ * of a gauge (cast to an int32_t) or the number of samples added
+ * to a histogram.
+ *
+ * @param[in] pMetric a pointer to the metric; cannot be NULL.
+ * @return            the value.
+ */
+uint32_t uDeviceMetricGet(const uDeviceMetric_t *pMetric);
+
+/** Serialise all of the registered metrics.  Each value is read
+ * atomically but the set is not frozen while it is read, so the
+ * buckets of a histogram that is being sampled at the same time
+ * may not add up exactly to its number of samples.  Counters are
+ * not reset: the receiver should treat them as wrapping 32-bit
+ * values and take differences.
+ *
+ * @param format          the form to write.
+ * @param[out] pBuffer    a place to put the serialised metrics;
+ *                        use NULL to just find out the length
+ *                        required.
+ * @param bufferLength    the amount of storage at pBuffer; ignored
+ *                        if pBuffer is NULL.
+ * @return                on success the number of bytes written
+ *                        (or, if pBuffer is NULL, the number of
+ *                        bytes that would be written), which for
+ *                        #U_DEVICE_METRICS_FORMAT_JSON INCLUDES a
+ *                        null terminator (strlen() + 1), else
+ *                        negative error code, #U_ERROR_COMMON_NO_MEMORY
+ *                        if bufferLength is too small, in which
+ *                        case the contents of pBuffer are undefined.
+ */
+int32_t uDeviceMetricsSnapshot(uDeviceMetricsFormat_t format,
+                               char *pBuffer, size_t bufferLength);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_DEVICE_METRICS_H_
+
+// End of file
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_DEVICE_TIME_H_
+#define _U_DEVICE_TIME_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_device.h"
+#include "u_gnss_time.h"
+
+/** \addtogroup device Device
+ *  @{
+ */
+
+/** @file
+ * @brief A helper that takes UTC time from a GNSS device and uses it
+ * to set the clock of the host and, optionally, that of a cellular
+ * module, so that, after a cold boot, neither has to wait for the
+ * network to provide the time (NITZ) or for an NTP round trip; the
+ * first secure connection, which needs a valid time for certificate
+ * validation, is then not held up.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_DEVICE_TIME_HOST_DRIFT_PPM
+/** The drift of the host clock, in parts per million, used when
+ * estimating how far the host time has moved away from the GNSS time
+ * since the sample passed to uDeviceTimeSetFromGnss() was taken.
+ */
+# define U_DEVICE_TIME_HOST_DRIFT_PPM 100
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The outcome of uDeviceTimeSetFromGnss().
+ */
+typedef struct {
+    int64_t timeUtcMs;      /**< the UTC time, in milliseconds since
+                                 midnight on 1st January 1970, that was
+                                 derived from GNSS. */
+    bool fromTimeSync;      /**< true if the time came from a time
+                                 synchronisation sample, false if it
+                                 came from uGnssInfoGetTimeUtc(). */
+    int32_t hostAccuracyMs; /**< the estimated accuracy of the host
+                                 clock, as now returned by
+                                 uTimeHostGetUtcMs(). */
+    int32_t cellAccuracyMs; /**< the estimated accuracy of the clock
+                                 of the cellular module, -1 if it was
+                                 not set. */
+} uDeviceTimeResult_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Obtain UTC time from a GNSS device and set the host clock (see
+ * uTimeHostSetUtcMs()) and, if cellHandle is not NULL, the clock of
+ * a cellular module (see uCellCfgSetTimeUtc()) from it.
+ *
+ * If pSync is not NULL and uGnssTimeSyncGet() has a sample that is
+ * on a UTC time base, with the host time of the sample taken from
+ * uPortGetTickTimeUs() (i.e. -1 was passed as hostTimeNs to
+ * uGnssTimeSyncPulseIsr()/uGnssTimeSyncMarkIsr()), then that is
+ * used, giving an accuracy of a millisecond or two; otherwise the
+ * time is read with uGnssInfoGetTimeUtc(), which has a resolution
+ * of one second and hence an accuracy of around half a second.
+ * uGnssInfoGetTimeUtc() will only work once the GNSS chip has
+ * obtained the leap-second information; see its description.
+ *
+ * Since the cellular module takes the time in whole seconds this
+ * function waits for up to a second so that the time is sent at the
+ * start of a second; the accuracy reported for the cellular module
+ * includes the time taken for it to respond.
+ *
+ * @param gnssHandle      the handle of the GNSS instance.
+ * @param[in] pSync       the time synchronisation context passed to
+ *                        uGnssTimeSyncStart(); may be NULL.
+ * @param cellHandle      the handle of the cellular instance whose
+ *                        clock should be set; may be NULL.
+ * @param[out] pResult    a place to put the outcome; may be NULL.
+ * @return                zero on success, else negative error code;
+ *                        if the host clock was set but the clock of
+ *                        the cellular module could not be then the
+ *                        error from uCellCfgSetTimeUtc() is returned
+ *                        and pResult will say so.
+ */
+int32_t uDeviceTimeSetFromGnss(uDeviceHandle_t gnssHandle,
+                               uGnssTimeSync_t *pSync,
+                               uDeviceHandle_t cellHandle,
+                               uDeviceTimeResult_t *pResult);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_DEVICE_TIME_H_
+
+// End of file
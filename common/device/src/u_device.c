@@ -28,7 +28,10 @@
 
 #include "u_error_common.h"
 
+#include "u_cfg_os_platform_specific.h"
+#include "u_port_heap.h"
 #include "u_port_os.h"
+#include "u_task_registry.h"
 
 #include "u_device.h"
 #include "u_device_shared.h"
@@ -59,14 +62,194 @@
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The context of a uDeviceOpenAsync() task.
+ */
+typedef struct {
+    const uDeviceCfg_t *pDeviceCfg;
+    void (*pCallback) (const uDeviceCfg_t *, uDeviceHandle_t, int32_t, void *);
+    void *pCallbackParam;
+} uDeviceOpenAsync_t;
+
+/** The context of a uDeviceOpenMulti() call.
+ */
+typedef struct {
+    const uDeviceCfg_t *pDeviceCfgs;
+    uDeviceHandle_t *pDeviceHandles;
+    int32_t *pErrorCodes;
+    uPortSemaphoreHandle_t semaphore;
+} uDeviceOpenMulti_t;
+
 /* ----------------------------------------------------------------
  * STATIC VARIABLES
  * -------------------------------------------------------------- */
 
+/** A mutex per device type, held while a device of that type is
+ * being opened or closed; this allows devices of different types
+ * to be opened at the same time without holding the device API
+ * mutex for the, possibly long, duration.  Where both are locked
+ * this mutex must be locked first.
+ */
+static uPortMutexHandle_t gMutexType[U_DEVICE_TYPE_MAX_NUM] = {NULL};
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Delete the per-device-type mutexes.
+static void typeMutexesDestroy()
+{
+    for (size_t x = 0; x < sizeof(gMutexType) / sizeof(gMutexType[0]); x++) {
+        if (gMutexType[x] != NULL) {
+            // Make sure the mutex isn't locked before
+            // we delete it
+            U_PORT_MUTEX_LOCK(gMutexType[x]);
+            U_PORT_MUTEX_UNLOCK(gMutexType[x]);
+            uPortMutexDelete(gMutexType[x]);
+            gMutexType[x] = NULL;
+        }
+    }
+}
+
+// Create the per-device-type mutexes.
+static int32_t typeMutexesCreate()
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+
+    for (size_t x = 0; (x < sizeof(gMutexType) / sizeof(gMutexType[0])) &&
+         (errorCode == 0); x++) {
+        if (gMutexType[x] == NULL) {
+            errorCode = uPortMutexCreate(&(gMutexType[x]));
+        }
+    }
+
+    if (errorCode != 0) {
+        typeMutexesDestroy();
+    }
+
+    return errorCode;
+}
+
+// Get the per-device-type mutex for a device type, NULL if there
+// is none.
+static uPortMutexHandle_t typeMutexGet(int32_t deviceType)
+{
+    uPortMutexHandle_t mutex = NULL;
+
+    if ((deviceType > (int32_t) U_DEVICE_TYPE_NONE) &&
+        (deviceType < (int32_t) U_DEVICE_TYPE_MAX_NUM)) {
+        mutex = gMutexType[deviceType];
+    }
+
+    return mutex;
+}
+
+// Do the work of opening a device, called with the mutex for the
+// device type locked; the device API mutex is only locked where
+// the addition touches state that is shared between device types.
+static int32_t deviceAdd(const uDeviceCfg_t *pDeviceCfg,
+                         uDeviceHandle_t *pDeviceHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    switch (pDeviceCfg->deviceType) {
+        case U_DEVICE_TYPE_CELL:
+            errorCode = uDevicePrivateCellAdd(pDeviceCfg, pDeviceHandle);
+            if (errorCode == 0) {
+                U_DEVICE_INSTANCE(*pDeviceHandle)->moduleType =
+                    pDeviceCfg->deviceCfg.cfgCell.moduleType;
+            }
+            break;
+        case U_DEVICE_TYPE_GNSS:
+            // The table of I2C HW blocks is shared with other devices
+            if (pDeviceCfg->transportType == U_DEVICE_TRANSPORT_TYPE_I2C) {
+                errorCode = uDeviceLock();
+            } else {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+            if (errorCode == 0) {
+                errorCode = uDevicePrivateGnssAdd(pDeviceCfg, pDeviceHandle);
+                if (errorCode == 0) {
+                    U_DEVICE_INSTANCE(*pDeviceHandle)->moduleType =
+                        pDeviceCfg->deviceCfg.cfgGnss.moduleType;
+                }
+                if (pDeviceCfg->transportType == U_DEVICE_TRANSPORT_TYPE_I2C) {
+                    uDeviceUnlock();
+                }
+            }
+            break;
+        case U_DEVICE_TYPE_SHORT_RANGE:
+            errorCode = uDevicePrivateShortRangeAdd(pDeviceCfg, pDeviceHandle);
+            if (errorCode == 0) {
+                U_DEVICE_INSTANCE(*pDeviceHandle)->moduleType =
+                    pDeviceCfg->deviceCfg.cfgSho.moduleType;
+            }
+            break;
+        case U_DEVICE_TYPE_SHORT_RANGE_OPEN_CPU:
+            errorCode = uDevicePrivateShortRangeOpenCpuAdd(pDeviceCfg, pDeviceHandle);
+            if (errorCode == 0) {
+                U_DEVICE_INSTANCE(*pDeviceHandle)->moduleType =
+                    pDeviceCfg->deviceCfg.cfgSho.moduleType;
+            }
+            break;
+        default:
+            break;
+    }
+
+    return errorCode;
+}
+
+// Determine whether any network on a device is being brought up;
+// must be called between uDeviceLock() and uDeviceUnlock().
+static bool deviceIsBusy(uDeviceHandle_t devHandle)
+{
+    uDeviceInstance_t *pInstance;
+    bool busy = false;
+
+    if (uDeviceGetInstance(devHandle, &pInstance) == 0) {
+        for (size_t x = 0; x < sizeof(pInstance->networkData) /
+             sizeof(pInstance->networkData[0]); x++) {
+            busy = busy || pInstance->networkData[x].busy;
+        }
+    }
+
+    return busy;
+}
+
+// The task that opens a device for uDeviceOpenAsync().
+static void openAsyncTask(void *pParameter)
+{
+    uDeviceOpenAsync_t *pOpenAsync = (uDeviceOpenAsync_t *) pParameter;
+    uDeviceHandle_t devHandle = NULL;
+    int32_t errorCode;
+
+    errorCode = uDeviceOpen(pOpenAsync->pDeviceCfg, &devHandle);
+    if (errorCode != 0) {
+        devHandle = NULL;
+    }
+    pOpenAsync->pCallback(pOpenAsync->pDeviceCfg, devHandle, errorCode,
+                          pOpenAsync->pCallbackParam);
+    uPortFree(pOpenAsync);
+
+    uTaskRegistryTaskDelete(NULL);
+}
+
+// The uDeviceOpenAsync() callback used by uDeviceOpenMulti().
+static void openMultiCallback(const uDeviceCfg_t *pDeviceCfg,
+                              uDeviceHandle_t devHandle,
+                              int32_t errorCode, void *pCallbackParam)
+{
+    uDeviceOpenMulti_t *pOpenMulti = (uDeviceOpenMulti_t *) pCallbackParam;
+    size_t index = (size_t) (pDeviceCfg - pOpenMulti->pDeviceCfgs);
+
+    // Each task writes only its own entry, the semaphore
+    // tells the caller when they have all done so
+    *(pOpenMulti->pDeviceHandles + index) = devHandle;
+    if (pOpenMulti->pErrorCodes != NULL) {
+        *(pOpenMulti->pErrorCodes + index) = errorCode;
+    }
+    uPortSemaphoreGive(pOpenMulti->semaphore);
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -100,6 +283,9 @@ int32_t uDeviceInit()
 {
     int32_t errorCode = uDeviceMutexCreate();
 
+    if (errorCode == 0) {
+        errorCode = typeMutexesCreate();
+    }
     if (errorCode == 0) {
         uDevicePrivateInit();
         errorCode = uDevicePrivateCellInit();
@@ -131,6 +317,7 @@ int32_t uDeviceInit()
         uDevicePrivateShortRangeDeinit();
         uDevicePrivateCellDeinit();
         uDevicePrivateGnssDeinit();
+        typeMutexesDestroy();
         uDeviceMutexDestroy();
     } else {
         errorCode = uDeviceCallback("init", NULL, NULL);
@@ -145,6 +332,7 @@ int32_t uDeviceDeinit()
     uDevicePrivateShortRangeDeinit();
     uDevicePrivateGnssDeinit();
     uDevicePrivateCellDeinit();
+    typeMutexesDestroy();
     uDeviceMutexDestroy();
     uDeviceCallback("deinit", NULL, NULL);
     return (int32_t) U_ERROR_COMMON_SUCCESS;
@@ -236,89 +424,184 @@ int32_t uDeviceGetDefaults(uDeviceType_t deviceType,
 
 int32_t uDeviceOpen(const uDeviceCfg_t *pDeviceCfg, uDeviceHandle_t *pDeviceHandle)
 {
-    // Lock the API
-    int32_t errorCode = uDeviceLock();
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortMutexHandle_t typeMutex = NULL;
 
-    if (errorCode == 0 && pDeviceCfg != NULL) {
-        errorCode = uDeviceCallback("open", (void *)pDeviceCfg->deviceType, NULL);
+    if ((pDeviceCfg != NULL) && (pDeviceCfg->version == 0) && (pDeviceHandle != NULL)) {
+        typeMutex = typeMutexGet((int32_t) pDeviceCfg->deviceType);
     }
 
+    if (typeMutex != NULL) {
+        // Lock the device type, which may be held for some time...
+        errorCode = uPortMutexLock(typeMutex);
+        if (errorCode == 0) {
+            // ...and the API just for the callback
+            errorCode = uDeviceLock();
+            if (errorCode == 0) {
+                errorCode = uDeviceCallback("open", (void *)pDeviceCfg->deviceType, NULL);
+                uDeviceUnlock();
+            }
+            if (errorCode == 0) {
+                errorCode = deviceAdd(pDeviceCfg, pDeviceHandle);
+            }
+
+            // ...and done
+            uPortMutexUnlock(typeMutex);
+        }
+    } else {
+        // Not something we can open but still lock the API, and
+        // call the callback if there is a configuration, so that
+        // the outcome is as it always has been
+        errorCode = uDeviceLock();
+        if (errorCode == 0) {
+            if (pDeviceCfg != NULL) {
+                errorCode = uDeviceCallback("open", (void *)pDeviceCfg->deviceType, NULL);
+            }
+            if (errorCode == 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            }
+            uDeviceUnlock();
+        }
+    }
+
+    return errorCode;
+}
+
+int32_t uDeviceOpenAsync(const uDeviceCfg_t *pDeviceCfg,
+                         void (*pCallback) (const uDeviceCfg_t *,
+                                            uDeviceHandle_t,
+                                            int32_t,
+                                            void *),
+                         void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uDeviceOpenAsync_t *pOpenAsync;
+    uPortTaskHandle_t taskHandle;
+
+    if ((pDeviceCfg != NULL) && (pCallback != NULL)) {
+        // Check that we're initialised
+        errorCode = uDeviceLock();
+        if (errorCode == 0) {
+            uDeviceUnlock();
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pOpenAsync = (uDeviceOpenAsync_t *) pUPortMalloc(sizeof(*pOpenAsync));
+            if (pOpenAsync != NULL) {
+                pOpenAsync->pDeviceCfg = pDeviceCfg;
+                pOpenAsync->pCallback = pCallback;
+                pOpenAsync->pCallbackParam = pCallbackParam;
+                errorCode = uTaskRegistryTaskCreate(openAsyncTask, "devOpen",
+                                                    U_DEVICE_OPEN_TASK_STACK_SIZE_BYTES,
+                                                    pOpenAsync, U_DEVICE_OPEN_TASK_PRIORITY,
+                                                    &taskHandle);
+                if (errorCode != 0) {
+                    uPortFree(pOpenAsync);
+                }
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+int32_t uDeviceOpenMulti(const uDeviceCfg_t *pDeviceCfgs,
+                         size_t numDevices,
+                         uDeviceHandle_t *pDeviceHandles,
+                         int32_t *pErrorCodes)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uDeviceOpenMulti_t openMulti;
+    size_t numStarted = 0;
+    int32_t x;
+
+    if ((pDeviceCfgs != NULL) && (numDevices > 0) && (pDeviceHandles != NULL)) {
+        openMulti.pDeviceCfgs = pDeviceCfgs;
+        openMulti.pDeviceHandles = pDeviceHandles;
+        openMulti.pErrorCodes = pErrorCodes;
+        errorCodeOrCount = uPortSemaphoreCreate(&(openMulti.semaphore), 0,
+                                                (uint32_t) numDevices);
+        if (errorCodeOrCount == 0) {
+            for (size_t y = 0; y < numDevices; y++) {
+                *(pDeviceHandles + y) = NULL;
+                x = uDeviceOpenAsync(pDeviceCfgs + y, openMultiCallback, &openMulti);
+                if (x == 0) {
+                    numStarted++;
+                } else if (pErrorCodes != NULL) {
+                    *(pErrorCodes + y) = x;
+                }
+            }
+            // Wait for all that were started to finish
+            for (size_t y = 0; y < numStarted; y++) {
+                uPortSemaphoreTake(openMulti.semaphore);
+            }
+            uPortSemaphoreDelete(openMulti.semaphore);
+            for (size_t y = 0; y < numDevices; y++) {
+                if (*(pDeviceHandles + y) != NULL) {
+                    errorCodeOrCount++;
+                }
+            }
+        }
+    }
+
+    return errorCodeOrCount;
+}
+
+int32_t uDeviceClose(uDeviceHandle_t devHandle, bool powerOff)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    uPortMutexHandle_t typeMutex = typeMutexGet(uDeviceGetDeviceType(devHandle));
+
+    // Lock the device type first, if it is valid...
+    if (typeMutex != NULL) {
+        errorCode = uPortMutexLock(typeMutex);
+        if (errorCode != 0) {
+            typeMutex = NULL;
+        }
+    }
     if (errorCode == 0) {
-        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        if ((pDeviceCfg != NULL) && (pDeviceCfg->version == 0) && (pDeviceHandle != NULL)) {
-            switch (pDeviceCfg->deviceType) {
+        // ...then the API
+        errorCode = uDeviceLock();
+    }
+
+    if (errorCode == 0) {
+        if (deviceIsBusy(devHandle)) {
+            // A network is on its way up, see uNetworkInterfaceUpAsync()
+            errorCode = (int32_t) U_ERROR_COMMON_TEMPORARY_FAILURE;
+        } else {
+            switch (uDeviceGetDeviceType(devHandle)) {
                 case U_DEVICE_TYPE_CELL:
-                    errorCode = uDevicePrivateCellAdd(pDeviceCfg, pDeviceHandle);
-                    if (errorCode == 0) {
-                        U_DEVICE_INSTANCE(*pDeviceHandle)->moduleType = pDeviceCfg->deviceCfg.cfgCell.moduleType;
-                    }
+                    errorCode = uDevicePrivateCellRemove(devHandle, powerOff);
                     break;
                 case U_DEVICE_TYPE_GNSS:
-                    errorCode = uDevicePrivateGnssAdd(pDeviceCfg, pDeviceHandle);
-                    if (errorCode == 0) {
-                        U_DEVICE_INSTANCE(*pDeviceHandle)->moduleType = pDeviceCfg->deviceCfg.cfgGnss.moduleType;
-                    }
+                    errorCode = uDevicePrivateGnssRemove(devHandle, powerOff);
                     break;
                 case U_DEVICE_TYPE_SHORT_RANGE:
-                    errorCode = uDevicePrivateShortRangeAdd(pDeviceCfg, pDeviceHandle);
-                    if (errorCode == 0) {
-                        U_DEVICE_INSTANCE(*pDeviceHandle)->moduleType = pDeviceCfg->deviceCfg.cfgSho.moduleType;
+                    if (!powerOff) {
+                        errorCode = uDevicePrivateShortRangeRemove(devHandle);
                     }
                     break;
                 case U_DEVICE_TYPE_SHORT_RANGE_OPEN_CPU:
-                    errorCode = uDevicePrivateShortRangeOpenCpuAdd(pDeviceCfg, pDeviceHandle);
-                    if (errorCode == 0) {
-                        U_DEVICE_INSTANCE(*pDeviceHandle)->moduleType = pDeviceCfg->deviceCfg.cfgSho.moduleType;
+                    if (!powerOff) {
+                        errorCode = uDevicePrivateShortRangeOpenCpuRemove(devHandle);
                     }
                     break;
                 default:
+                    errorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
                     break;
             }
-        }
 
-        // ...and done
-        uDeviceUnlock();
-    }
-
-    return errorCode;
-}
-
-int32_t uDeviceClose(uDeviceHandle_t devHandle, bool powerOff)
-{
-    // Lock the API
-    int32_t errorCode = uDeviceLock();
-
-    if (errorCode == 0) {
-        switch (uDeviceGetDeviceType(devHandle)) {
-            case U_DEVICE_TYPE_CELL:
-                errorCode = uDevicePrivateCellRemove(devHandle, powerOff);
-                break;
-            case U_DEVICE_TYPE_GNSS:
-                errorCode = uDevicePrivateGnssRemove(devHandle, powerOff);
-                break;
-            case U_DEVICE_TYPE_SHORT_RANGE:
-                if (!powerOff) {
-                    errorCode = uDevicePrivateShortRangeRemove(devHandle);
-                }
-                break;
-            case U_DEVICE_TYPE_SHORT_RANGE_OPEN_CPU:
-                if (!powerOff) {
-                    errorCode = uDevicePrivateShortRangeOpenCpuRemove(devHandle);
-                }
-                break;
-            default:
-                errorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
-                break;
-        }
-
-        if (errorCode == 0) {
-            errorCode = uDeviceCallback("close", (void *)(U_DEVICE_INSTANCE(devHandle)->deviceType),
-                                        (void *)powerOff);
+            if (errorCode == 0) {
+                errorCode = uDeviceCallback("close",
+                                            (void *)(U_DEVICE_INSTANCE(devHandle)->deviceType),
+                                            (void *)powerOff);
+            }
         }
 
         // ...and done
         uDeviceUnlock();
     }
+    if (typeMutex != NULL) {
+        uPortMutexUnlock(typeMutex);
+    }
 
     return errorCode;
 }
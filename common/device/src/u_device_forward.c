@@ -0,0 +1,346 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of forwarding messages from a GNSS device
+ * to a socket.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcpy(), memmove()
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+
+#include "u_ringbuffer.h"
+
+#include "u_device.h"
+
+#include "u_sock.h"
+
+#include "u_gnss_type.h"
+#include "u_gnss_msg.h"
+
+#include "u_device_forward.h"
+#include "u_device_forward_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The offset of the byte containing the "multiple message" bit
+ * in an RTCM MSM message, counting from the 0xD3 preamble: three
+ * bytes of frame header then 12 bits of message number, 12 bits of
+ * reference station ID and 30 bits of epoch time.
+ */
+#define U_DEVICE_FORWARD_RTCM_MSM_MULTIPLE_OFFSET 9
+
+/** The mask of the "multiple message" bit in the byte at
+ * #U_DEVICE_FORWARD_RTCM_MSM_MULTIPLE_OFFSET.
+ */
+#define U_DEVICE_FORWARD_RTCM_MSM_MULTIPLE_MASK 0x02
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The function used to write to the socket, only ever changed
+ * by tests.
+ */
+static uDeviceForwardPrivateWritev_t *gpWritev = uSockWritev;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Get the byte at the given offset into a message that is in two
+// spans, returning -1 if the message is not that long.
+static int32_t spanByte(const uRingBufferSpan_t *pSpan, size_t offset)
+{
+    int32_t byte = -1;
+
+    if (offset < pSpan[0].length) {
+        byte = (uint8_t) pSpan[0].pData[offset];
+    } else if (offset - pSpan[0].length < pSpan[1].length) {
+        byte = (uint8_t) pSpan[1].pData[offset - pSpan[0].length];
+    }
+
+    return byte;
+}
+
+// Return true if the given message ends an epoch.
+static bool isEpochEnd(const uGnssMessageId_t *pMessageId,
+                       const uRingBufferSpan_t *pSpan)
+{
+    bool epochEnd = true;
+    uint16_t rtcm;
+    int32_t byte;
+
+    if (pMessageId->type == U_GNSS_PROTOCOL_RTCM) {
+        epochEnd = false;
+        rtcm = pMessageId->id.rtcm;
+        // MSM messages are 1071 to 1137, MSM1 to MSM7 for each GNSS
+        if ((rtcm >= 1071) && (rtcm <= 1137) &&
+            (rtcm % 10 >= 1) && (rtcm % 10 <= 7)) {
+            byte = spanByte(pSpan, U_DEVICE_FORWARD_RTCM_MSM_MULTIPLE_OFFSET);
+            epochEnd = (byte >= 0) &&
+                       ((byte & U_DEVICE_FORWARD_RTCM_MSM_MULTIPLE_MASK) == 0);
+        }
+    } else if (pMessageId->type == U_GNSS_PROTOCOL_UBX) {
+        // UBX-NAV-EOE
+        epochEnd = (pMessageId->id.ubx == 0x0161);
+    }
+
+    return epochEnd;
+}
+
+// Copy a message from two spans into the held buffer, dropping
+// it if it won't fit; skip is the number of bytes at the start
+// of the message that are not to be copied.  Since messages
+// larger than the buffer are dropped before they get here, the
+// remainder of a partly sent message always fits.
+static void hold(uDeviceForward_t *pForward,
+                 const uRingBufferSpan_t *pSpan, size_t skip)
+{
+    size_t length = pSpan[0].length + pSpan[1].length - skip;
+    size_t x;
+
+    if (length <= pForward->bufferSize - pForward->length) {
+        if (pForward->length == 0) {
+            pForward->holdStartTimeMs = uPortGetTickTimeMs();
+        }
+        for (size_t y = 0; y < 2; y++) {
+            x = pSpan[y].length;
+            if (skip >= x) {
+                skip -= x;
+            } else {
+                memcpy(pForward->pBuffer + pForward->length,
+                       pSpan[y].pData + skip, x - skip);
+                pForward->length += x - skip;
+                skip = 0;
+            }
+        }
+    } else {
+        if (skip == 0) {
+            pForward->stats.numMessagesDropped++;
+        }
+        pForward->stats.numBytesDropped += length;
+    }
+}
+
+// Write what is held and, if pSpan is not NULL, the message in
+// pSpan, in one go, keeping or dropping whatever couldn't be sent.
+static void flush(uDeviceForward_t *pForward,
+                  const uRingBufferSpan_t *pSpan)
+{
+    uSockIoVec_t ioVec[3];
+    size_t ioVecCount = 0;
+    size_t total = pForward->length;
+    size_t sent;
+    int32_t errorCodeOrSize;
+
+    if (pForward->length > 0) {
+        ioVec[ioVecCount].pData = pForward->pBuffer;
+        ioVec[ioVecCount].dataSizeBytes = pForward->length;
+        ioVecCount++;
+    }
+    if (pSpan != NULL) {
+        for (size_t x = 0; x < 2; x++) {
+            if (pSpan[x].length > 0) {
+                ioVec[ioVecCount].pData = pSpan[x].pData;
+                ioVec[ioVecCount].dataSizeBytes = pSpan[x].length;
+                ioVecCount++;
+                total += pSpan[x].length;
+            }
+        }
+    }
+
+    if (total > 0) {
+        errorCodeOrSize = gpWritev(pForward->descriptor, ioVec, ioVecCount);
+        pForward->stats.numWrites++;
+        sent = 0;
+        if (errorCodeOrSize > 0) {
+            sent = (size_t) errorCodeOrSize;
+            pForward->stats.numBytesSent += sent;
+        }
+        if (sent < total) {
+            pForward->stats.numWritesShort++;
+        }
+        if (sent < pForward->length) {
+            // Keep what is left of the held data, which has to go
+            // first next time to keep the stream in order...
+            memmove(pForward->pBuffer, pForward->pBuffer + sent,
+                    pForward->length - sent);
+            pForward->length -= sent;
+            pForward->holdStartTimeMs = uPortGetTickTimeMs();
+            if (pSpan != NULL) {
+                // ...and hold the new message behind it, if it fits
+                hold(pForward, pSpan, 0);
+            }
+        } else {
+            sent -= pForward->length;
+            pForward->length = 0;
+            if ((pSpan != NULL) && (sent < pSpan[0].length + pSpan[1].length)) {
+                // Part, or none, of the new message was sent: hold
+                // the rest of it, since any part of it that has gone
+                // must be followed by the remainder
+                hold(pForward, pSpan, sent);
+            }
+        }
+    }
+}
+
+// Callback for the GNSS messages to be forwarded.
+static void messageCallback(uDeviceHandle_t gnssHandle,
+                            const uGnssMessageId_t *pMessageId,
+                            const uRingBufferSpan_t *pSpan,
+                            int32_t errorCodeOrLength,
+                            void *pCallbackParam)
+{
+    (void) gnssHandle;
+
+    if (errorCodeOrLength > 0) {
+        uDeviceForwardPrivateMessage((uDeviceForward_t *) pCallbackParam,
+                                     pMessageId, pSpan, (size_t) errorCodeOrLength);
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS THAT ARE PRIVATE TO DEVICE
+ * -------------------------------------------------------------- */
+
+// Return true if the given message ends an epoch.
+bool uDeviceForwardPrivateIsEpochEnd(const uGnssMessageId_t *pMessageId,
+                                     const uRingBufferSpan_t *pSpan)
+{
+    return isEpochEnd(pMessageId, pSpan);
+}
+
+// Forward a message.
+void uDeviceForwardPrivateMessage(uDeviceForward_t *pForward,
+                                  const uGnssMessageId_t *pMessageId,
+                                  const uRingBufferSpan_t *pSpan,
+                                  size_t length)
+{
+    pForward->stats.numMessages++;
+    if (length > pForward->bufferSize) {
+        // Too large to be sure of holding the remainder if only part
+        // of it were sent, which would break the stream, so drop it
+        pForward->stats.numMessagesDropped++;
+        pForward->stats.numBytesDropped += length;
+    } else if (isEpochEnd(pMessageId, pSpan) ||
+               (length > pForward->bufferSize - pForward->length)) {
+        // Send anything held plus this message, straight
+        // out of the ring buffer
+        flush(pForward, pSpan);
+    } else {
+        hold(pForward, pSpan, 0);
+        if (uPortGetTickTimeMs() - pForward->holdStartTimeMs > U_DEVICE_FORWARD_HOLD_MAX_MS) {
+            // Held for too long, send it anyway
+            flush(pForward, NULL);
+        }
+    }
+}
+
+// Replace the function used to write to the socket.
+void uDeviceForwardPrivateWritevSet(uDeviceForwardPrivateWritev_t *pWritev)
+{
+    gpWritev = pWritev;
+    if (gpWritev == NULL) {
+        gpWritev = uSockWritev;
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Start forwarding.
+int32_t uDeviceForwardStart(uDeviceHandle_t gnssHandle,
+                            const uGnssMessageId_t *pMessageId,
+                            uSockDescriptor_t descriptor,
+                            char *pBuffer, size_t bufferSize,
+                            uDeviceForward_t *pForward)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pMessageId != NULL) && (pBuffer != NULL) &&
+        (bufferSize > 0) && (pForward != NULL)) {
+        memset(pForward, 0, sizeof(*pForward));
+        pForward->gnssHandle = gnssHandle;
+        pForward->descriptor = descriptor;
+        pForward->pBuffer = pBuffer;
+        pForward->bufferSize = bufferSize;
+        uSockBlockingSet(descriptor, false);
+        errorCode = uGnssMsgReceiveStartSpan(gnssHandle, pMessageId,
+                                             messageCallback, pForward);
+        pForward->asyncHandle = errorCode;
+        if (errorCode >= 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Get the statistics of a forwarding stage.
+void uDeviceForwardStatsGet(const uDeviceForward_t *pForward,
+                            uDeviceForwardStats_t *pStats)
+{
+    if ((pForward != NULL) && (pStats != NULL)) {
+        *pStats = pForward->stats;
+    }
+}
+
+// Stop forwarding.
+int32_t uDeviceForwardStop(uDeviceForward_t *pForward)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pForward != NULL) && (pForward->asyncHandle >= 0)) {
+        // Once this returns our callback will not be called again
+        errorCode = uGnssMsgReceiveStop(pForward->gnssHandle,
+                                        pForward->asyncHandle);
+        pForward->asyncHandle = -1;
+        // One last go at sending anything held
+        flush(pForward, NULL);
+        if (pForward->length > 0) {
+            pForward->stats.numBytesDropped += pForward->length;
+            pForward->length = 0;
+        }
+    }
+
+    return errorCode;
+}
+
+// End of file
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_DEVICE_FORWARD_PRIVATE_H_
+#define _U_DEVICE_FORWARD_PRIVATE_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_ringbuffer.h"
+#include "u_gnss_msg.h"
+#include "u_device_forward.h"
+
+/** @file
+ * @brief The internals of the GNSS forwarding stage, exposed so that
+ * they can be tested without a GNSS device or a socket; these
+ * functions should not be called by an application.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A function with the same signature as uSockWritev(), see
+ * uDeviceForwardPrivateWritevSet().
+ */
+typedef int32_t (uDeviceForwardPrivateWritev_t)(uSockDescriptor_t descriptor,
+                                                const uSockIoVec_t *pIoVec,
+                                                size_t ioVecCount);
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Determine whether a message ends an epoch, see the description
+ * of u_device_forward.h.
+ *
+ * @param[in] pMessageId  the message ID; cannot be NULL.
+ * @param[in] pSpan       the message, as an array of two spans, the
+ *                        second of which may be of zero length;
+ *                        cannot be NULL.
+ * @return                true if the message ends an epoch.
+ */
+bool uDeviceForwardPrivateIsEpochEnd(const uGnssMessageId_t *pMessageId,
+                                     const uRingBufferSpan_t *pSpan);
+
+/** Forward a message: this is what is done with each message that
+ * arrives at the message receiver that uDeviceForwardStart() sets up.
+ *
+ * @param[in] pForward    the forwarding context; cannot be NULL.
+ * @param[in] pMessageId  the message ID; cannot be NULL.
+ * @param[in] pSpan       the message, as an array of two spans, the
+ *                        second of which may be of zero length;
+ *                        cannot be NULL.
+ * @param length          the length of the message, the sum of the
+ *                        lengths of the two spans.
+ */
+void uDeviceForwardPrivateMessage(uDeviceForward_t *pForward,
+                                  const uGnssMessageId_t *pMessageId,
+                                  const uRingBufferSpan_t *pSpan,
+                                  size_t length);
+
+/** Replace the function used to write to the socket; for testing
+ * only.
+ *
+ * @param[in] pWritev  the function to use, NULL to go back to
+ *                     uSockWritev().
+ */
+void uDeviceForwardPrivateWritevSet(uDeviceForwardPrivateWritev_t *pWritev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_DEVICE_FORWARD_PRIVATE_H_
+
+// End of file
@@ -0,0 +1,335 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the metrics registry.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcpy(), strlen()
+#include "stdio.h"     // snprintf()
+
+#include "u_compiler.h" // U_ATOMIC_xxx, U_MEMORY_BARRIER
+#include "u_error_common.h"
+
+#include "u_device_metrics.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+// The binary form uses a single byte for the number of metrics
+#if U_DEVICE_METRICS_MAX_NUM > 255
+# error U_DEVICE_METRICS_MAX_NUM must be no more than 255.
+#endif
+
+/** The state of a slot in the registry: free.
+ */
+#define U_DEVICE_METRICS_SLOT_FREE 0
+
+/** The state of a slot in the registry: claimed by a task that
+ * is registering or deregistering a metric.
+ */
+#define U_DEVICE_METRICS_SLOT_CLAIMED 1
+
+/** The state of a slot in the registry: holding a metric.
+ */
+#define U_DEVICE_METRICS_SLOT_READY 2
+
+/** The longest name that the binary form can carry.
+ */
+#define U_DEVICE_METRICS_BINARY_NAME_MAX_LENGTH 255
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A buffer being written by uDeviceMetricsSnapshot().
+ */
+typedef struct {
+    char *pBuffer;       /**< NULL if only the length is wanted. */
+    size_t bufferLength;
+    size_t length;       /**< the length written, or that would
+                              have been written had there been room. */
+} uDeviceMetricsBuffer_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The state of each slot in the registry, one of
+ * U_DEVICE_METRICS_SLOT_xxx; a slot is only changed by the task
+ * that has moved it to U_DEVICE_METRICS_SLOT_CLAIMED, which
+ * keeps registration lock-free.
+ */
+static volatile uint32_t gSlotState[U_DEVICE_METRICS_MAX_NUM] = {0};
+
+/** The metric in each slot of the registry, valid only when
+ * the slot state is U_DEVICE_METRICS_SLOT_READY.
+ */
+static uDeviceMetric_t *gpMetric[U_DEVICE_METRICS_MAX_NUM] = {0};
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Find the slot of a registered metric, -1 if it is not registered.
+static int32_t findSlot(const uDeviceMetric_t *pMetric)
+{
+    int32_t slot = -1;
+
+    for (size_t x = 0; (x < sizeof(gpMetric) / sizeof(gpMetric[0])) && (slot < 0); x++) {
+        if ((gSlotState[x] == U_DEVICE_METRICS_SLOT_READY) && (gpMetric[x] == pMetric)) {
+            slot = (int32_t) x;
+        }
+    }
+
+    return slot;
+}
+
+// Append data to a snapshot, counting it whether or not it fits.
+static void bufferWrite(uDeviceMetricsBuffer_t *pBuffer, const char *pData, size_t length)
+{
+    if ((pBuffer->pBuffer != NULL) &&
+        (pBuffer->length + length <= pBuffer->bufferLength)) {
+        memcpy(pBuffer->pBuffer + pBuffer->length, pData, length);
+    }
+    pBuffer->length += length;
+}
+
+// Append a byte to a snapshot.
+static void bufferWriteByte(uDeviceMetricsBuffer_t *pBuffer, size_t value)
+{
+    char byte = (char) value;
+
+    bufferWrite(pBuffer, &byte, 1);
+}
+
+// Append a uint32_t to a snapshot, as four little-endian bytes.
+static void bufferWriteUint32(uDeviceMetricsBuffer_t *pBuffer, uint32_t value)
+{
+    char bytes[4];
+
+    for (size_t x = 0; x < sizeof(bytes); x++) {
+        bytes[x] = (char) (value >> (x * 8));
+    }
+    bufferWrite(pBuffer, bytes, sizeof(bytes));
+}
+
+// Append a value to a snapshot in decimal, signed for a gauge.
+static void bufferWriteDecimal(uDeviceMetricsBuffer_t *pBuffer, uint32_t value, bool isSigned)
+{
+    char number[12]; // Enough for "-2147483648" plus terminator
+    int32_t length;
+
+    if (isSigned) {
+        length = snprintf(number, sizeof(number), "%d", (int) (int32_t) value);
+    } else {
+        length = snprintf(number, sizeof(number), "%u", (unsigned int) value);
+    }
+    if (length > 0) {
+        bufferWrite(pBuffer, number, (size_t) length);
+    }
+}
+
+// Append a metric to a JSON snapshot.
+static void writeJson(uDeviceMetricsBuffer_t *pBuffer, const uDeviceMetric_t *pMetric,
+                      bool isFirst)
+{
+    if (!isFirst) {
+        bufferWrite(pBuffer, ",", 1);
+    }
+    bufferWrite(pBuffer, "\"", 1);
+    bufferWrite(pBuffer, pMetric->pName, strlen(pMetric->pName));
+    bufferWrite(pBuffer, "\":", 2);
+    if (pMetric->type == U_DEVICE_METRIC_TYPE_HISTOGRAM) {
+        bufferWrite(pBuffer, "[", 1);
+        for (size_t x = 0; x < pMetric->numBuckets; x++) {
+            if (x > 0) {
+                bufferWrite(pBuffer, ",", 1);
+            }
+            bufferWriteDecimal(pBuffer, pMetric->pBucketCount[x], false);
+        }
+        bufferWrite(pBuffer, "]", 1);
+    } else {
+        bufferWriteDecimal(pBuffer, pMetric->value,
+                           pMetric->type == U_DEVICE_METRIC_TYPE_GAUGE);
+    }
+}
+
+// Append a metric to a binary snapshot.
+static void writeBinary(uDeviceMetricsBuffer_t *pBuffer, const uDeviceMetric_t *pMetric)
+{
+    size_t length = strlen(pMetric->pName);
+
+    if (length > U_DEVICE_METRICS_BINARY_NAME_MAX_LENGTH) {
+        length = U_DEVICE_METRICS_BINARY_NAME_MAX_LENGTH;
+    }
+    bufferWriteByte(pBuffer, (size_t) pMetric->type);
+    bufferWriteByte(pBuffer, length);
+    bufferWrite(pBuffer, pMetric->pName, length);
+    if (pMetric->type == U_DEVICE_METRIC_TYPE_HISTOGRAM) {
+        bufferWriteByte(pBuffer, pMetric->numBuckets);
+        for (size_t x = 0; x < pMetric->numBuckets; x++) {
+            bufferWriteUint32(pBuffer, pMetric->pBucketCount[x]);
+        }
+    } else {
+        bufferWriteUint32(pBuffer, pMetric->value);
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Register a metric.
+int32_t uDeviceMetricRegister(uDeviceMetric_t *pMetric)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pMetric != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (findSlot(pMetric) < 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            for (size_t x = 0; (x < sizeof(gpMetric) / sizeof(gpMetric[0])) &&
+                 (errorCode < 0); x++) {
+                if (U_ATOMIC_COMPARE_AND_SWAP(&(gSlotState[x]),
+                                              U_DEVICE_METRICS_SLOT_FREE,
+                                              U_DEVICE_METRICS_SLOT_CLAIMED)) {
+                    gpMetric[x] = pMetric;
+                    // Make sure the pointer is there before the slot is
+                    // seen as ready by uDeviceMetricsSnapshot()
+                    U_MEMORY_BARRIER();
+                    gSlotState[x] = U_DEVICE_METRICS_SLOT_READY;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                }
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Deregister a metric.
+void uDeviceMetricDeregister(const uDeviceMetric_t *pMetric)
+{
+    int32_t slot = findSlot(pMetric);
+
+    if ((slot >= 0) &&
+        U_ATOMIC_COMPARE_AND_SWAP(&(gSlotState[slot]),
+                                  U_DEVICE_METRICS_SLOT_READY,
+                                  U_DEVICE_METRICS_SLOT_CLAIMED)) {
+        gpMetric[slot] = NULL;
+        U_MEMORY_BARRIER();
+        gSlotState[slot] = U_DEVICE_METRICS_SLOT_FREE;
+    }
+}
+
+// Add to a counter.
+void uDeviceMetricAdd(uDeviceMetric_t *pMetric, uint32_t amount)
+{
+    U_ATOMIC_ADD(&(pMetric->value), amount);
+}
+
+// Set a gauge.
+void uDeviceMetricSet(uDeviceMetric_t *pMetric, int32_t value)
+{
+    // An aligned 32-bit store is atomic on all supported platforms
+    pMetric->value = (uint32_t) value;
+}
+
+// Add a sample to a histogram.
+void uDeviceMetricSample(uDeviceMetric_t *pMetric, int32_t value)
+{
+    size_t bucket = 0;
+
+    if (pMetric->numBuckets > 0) {
+        while ((bucket < pMetric->numBuckets - 1) &&
+               (value > pMetric->pBucketLimit[bucket])) {
+            bucket++;
+        }
+        U_ATOMIC_ADD(&(pMetric->pBucketCount[bucket]), 1);
+    }
+    U_ATOMIC_ADD(&(pMetric->value), 1);
+}
+
+// Get the value of a metric.
+uint32_t uDeviceMetricGet(const uDeviceMetric_t *pMetric)
+{
+    return pMetric->value;
+}
+
+// Serialise all of the registered metrics.
+int32_t uDeviceMetricsSnapshot(uDeviceMetricsFormat_t format,
+                               char *pBuffer, size_t bufferLength)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uDeviceMetricsBuffer_t buffer = {0};
+    const uDeviceMetric_t *pMetric;
+    size_t numMetrics = 0;
+
+    if ((format == U_DEVICE_METRICS_FORMAT_JSON) ||
+        (format == U_DEVICE_METRICS_FORMAT_BINARY)) {
+        buffer.pBuffer = pBuffer;
+        buffer.bufferLength = bufferLength;
+        if (format == U_DEVICE_METRICS_FORMAT_JSON) {
+            bufferWrite(&buffer, "{", 1);
+        } else {
+            bufferWriteByte(&buffer, U_DEVICE_METRICS_BINARY_VERSION);
+            // The number of metrics is filled in at the end
+            bufferWriteByte(&buffer, 0);
+        }
+        for (size_t x = 0; x < sizeof(gpMetric) / sizeof(gpMetric[0]); x++) {
+            if (gSlotState[x] == U_DEVICE_METRICS_SLOT_READY) {
+                pMetric = gpMetric[x];
+                if (pMetric != NULL) {
+                    if (format == U_DEVICE_METRICS_FORMAT_JSON) {
+                        writeJson(&buffer, pMetric, numMetrics == 0);
+                    } else {
+                        writeBinary(&buffer, pMetric);
+                    }
+                    numMetrics++;
+                }
+            }
+        }
+        if (format == U_DEVICE_METRICS_FORMAT_JSON) {
+            // Include the terminator
+            bufferWrite(&buffer, "}", 2);
+        } else if ((pBuffer != NULL) && (bufferLength > 1)) {
+            *(pBuffer + 1) = (char) numMetrics;
+        }
+        errorCodeOrLength = (int32_t) buffer.length;
+        if ((pBuffer != NULL) && (buffer.length > bufferLength)) {
+            errorCodeOrLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
+// End of file
@@ -100,6 +100,7 @@ static int32_t removeDevice(uDeviceHandle_t devHandle, bool powerOff)
 static int32_t addDevice(int32_t transportHandle,
                          uDeviceTransportType_t transportType,
                          const uDeviceCfgGnss_t *pCfgGnss,
+                         bool powerOn,
                          uDeviceHandle_t *pDeviceHandle)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
@@ -120,10 +121,19 @@ static int32_t addDevice(int32_t transportHandle,
         pContext->transportHandle = transportHandle;
         pContext->transportType = transportType;
         // Add the GNSS instance, which actually creates pDeviceHandle
-        errorCode = uGnssAdd((uGnssModuleType_t) pCfgGnss->moduleType,
-                             gnssTransportType, gnssTransportHandle,
-                             pCfgGnss->pinEnablePower, false,
-                             pDeviceHandle);
+        if (pCfgGnss->version >= 1) {
+            errorCode = uGnssAddWithBufferSize((uGnssModuleType_t) pCfgGnss->moduleType,
+                                               gnssTransportType, gnssTransportHandle,
+                                               pCfgGnss->pinEnablePower, false,
+                                               pCfgGnss->ringBufferLengthBytes,
+                                               pCfgGnss->readChunkLengthBytes,
+                                               pDeviceHandle);
+        } else {
+            errorCode = uGnssAdd((uGnssModuleType_t) pCfgGnss->moduleType,
+                                 gnssTransportType, gnssTransportHandle,
+                                 pCfgGnss->pinEnablePower, false,
+                                 pDeviceHandle);
+        }
         if (errorCode == 0) {
             if (pCfgGnss->i2cAddress > 0) {
                 uGnssSetI2cAddress(*pDeviceHandle, pCfgGnss->i2cAddress);
@@ -136,11 +146,16 @@ static int32_t addDevice(int32_t transportHandle,
 #endif
             // Attach the context
             U_DEVICE_INSTANCE(*pDeviceHandle)->pContext = pContext;
-            // Power on the GNSS chip
-            errorCode = uGnssPwrOn(*pDeviceHandle);
+            if (powerOn) {
+                // Power on the GNSS chip
+                errorCode = uGnssPwrOn(*pDeviceHandle);
+            }
             if (errorCode != 0) {
-                // If we failed to power on, clean up
+                // If we failed to power on, clean up, including
+                // the GNSS instance so that the transport may be
+                // used again
                 removeDevice(*pDeviceHandle, false);
+                uGnssRemove(*pDeviceHandle);
             }
         } else {
             uPortFree(pContext);
@@ -150,6 +165,82 @@ static int32_t addDevice(int32_t transportHandle,
     return errorCode;
 }
 
+// Remove a GNSS device that was added over UART without powering
+// it off and close the UART.
+static void removeDeviceUart(uDeviceHandle_t devHandle)
+{
+    uDeviceGnssInstance_t *pContext = (uDeviceGnssInstance_t *) U_DEVICE_INSTANCE(devHandle)->pContext;
+
+    if (pContext != NULL) {
+        uPortUartClose(pContext->transportHandle);
+        // This will destroy the instance
+        uGnssRemove(devHandle);
+        uPortFree(pContext);
+    }
+}
+
+// Open a UART at the given baud rate and add a GNSS device on it,
+// optionally powering it on; with no power-on, communication is
+// confirmed with uGnssPwrIsAlive().
+static int32_t addDeviceUart(const uDeviceCfgUart_t *pCfgUart,
+                             int32_t baudRate,
+                             const uDeviceCfgGnss_t *pCfgGnss,
+                             bool powerOn,
+                             uDeviceHandle_t *pDeviceHandle)
+{
+    int32_t errorCode;
+    int32_t transportHandle;
+
+    // Open a UART with the recommended buffer length
+    errorCode = uPortUartOpen(pCfgUart->uart,
+                              baudRate, NULL,
+                              U_GNSS_UART_BUFFER_LENGTH_BYTES,
+                              pCfgUart->pinTxd,
+                              pCfgUart->pinRxd,
+                              pCfgUart->pinCts,
+                              pCfgUart->pinRts);
+    if (errorCode >= 0) {
+        transportHandle = errorCode;
+        errorCode = addDevice(transportHandle, U_DEVICE_TRANSPORT_TYPE_UART,
+                              pCfgGnss, powerOn, pDeviceHandle);
+        if (errorCode < 0) {
+            // Clean up on error
+            uPortUartClose(transportHandle);
+        } else if (!powerOn && !uGnssPwrIsAlive(*pDeviceHandle)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_RESPONDING;
+            removeDeviceUart(*pDeviceHandle);
+        }
+    }
+
+    return errorCode;
+}
+
+// Switch a GNSS device that has been added over UART at the baud
+// rate of pCfgUart to a new baud rate, re-adding it at the new
+// rate or, if that fails, at the original rate once more; if the
+// GNSS device won't accept the change it is left as it is.
+static int32_t upgradeBaudRateUart(const uDeviceCfgUart_t *pCfgUart,
+                                   int32_t baudRate,
+                                   const uDeviceCfgGnss_t *pCfgGnss,
+                                   uDeviceHandle_t *pDeviceHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+
+    if (uGnssCfgSetUartBaudRate(*pDeviceHandle, baudRate, true) == 0) {
+        // The GNSS instance has to be re-added on the new UART handle
+        removeDeviceUart(*pDeviceHandle);
+        errorCode = addDeviceUart(pCfgUart, baudRate, pCfgGnss,
+                                  false, pDeviceHandle);
+        if (errorCode < 0) {
+            // Fall back to where we were
+            errorCode = addDeviceUart(pCfgUart, pCfgUart->baudRate,
+                                      pCfgGnss, false, pDeviceHandle);
+        }
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -172,6 +263,7 @@ int32_t uDevicePrivateGnssAdd(const uDeviceCfg_t *pDevCfg,
 {
     int32_t errorCodeOrHandle = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
     int32_t transportHandle;
+    int32_t baudRateUpgrade;
     int32_t x;
     const uDeviceCfgUart_t *pCfgUart;
     const uDeviceCfgI2c_t *pCfgI2c;
@@ -179,27 +271,31 @@ int32_t uDevicePrivateGnssAdd(const uDeviceCfg_t *pDevCfg,
 
     if ((pDevCfg != NULL) && (pDeviceHandle != NULL)) {
         pCfgGnss = &(pDevCfg->deviceCfg.cfgGnss);
-        if (pCfgGnss->version == 0) {
+        if (pCfgGnss->version <= 2) {
             switch (pDevCfg->transportType) {
                 case U_DEVICE_TRANSPORT_TYPE_UART:
                     pCfgUart = &(pDevCfg->transportCfg.cfgUart);
-                    // Open a UART with the recommended buffer length
-                    // and default baud rate.
-                    errorCodeOrHandle = uPortUartOpen(pCfgUart->uart,
-                                                      pCfgUart->baudRate, NULL,
-                                                      U_GNSS_UART_BUFFER_LENGTH_BYTES,
-                                                      pCfgUart->pinTxd,
-                                                      pCfgUart->pinRxd,
-                                                      pCfgUart->pinCts,
-                                                      pCfgUart->pinRts);
-                    if (errorCodeOrHandle >= 0) {
-                        transportHandle = errorCodeOrHandle;
-                        errorCodeOrHandle = addDevice(transportHandle,
-                                                      pDevCfg->transportType,
-                                                      pCfgGnss, pDeviceHandle);
-                        if (errorCodeOrHandle < 0) {
-                            // Clean up on error
-                            uPortUartClose(transportHandle);
+                    baudRateUpgrade = 0;
+                    errorCodeOrHandle = (int32_t) U_ERROR_COMMON_NOT_RESPONDING;
+                    if ((pCfgGnss->version >= 2) &&
+                        (pCfgGnss->uartBaudRateUpgrade > 0) &&
+                        (pCfgGnss->uartBaudRateUpgrade != pCfgUart->baudRate)) {
+                        baudRateUpgrade = pCfgGnss->uartBaudRateUpgrade;
+                        // The GNSS device may have retained the faster
+                        // rate from last time, so try that first
+                        errorCodeOrHandle = addDeviceUart(pCfgUart, baudRateUpgrade,
+                                                          pCfgGnss, true, pDeviceHandle);
+                        if ((errorCodeOrHandle == 0) && !uGnssPwrIsAlive(*pDeviceHandle)) {
+                            errorCodeOrHandle = (int32_t) U_ERROR_COMMON_NOT_RESPONDING;
+                            removeDeviceUart(*pDeviceHandle);
+                        }
+                    }
+                    if (errorCodeOrHandle < 0) {
+                        errorCodeOrHandle = addDeviceUart(pCfgUart, pCfgUart->baudRate,
+                                                          pCfgGnss, true, pDeviceHandle);
+                        if ((errorCodeOrHandle == 0) && (baudRateUpgrade > 0)) {
+                            errorCodeOrHandle = upgradeBaudRateUart(pCfgUart, baudRateUpgrade,
+                                                                    pCfgGnss, pDeviceHandle);
                         }
                     }
                     break;
@@ -211,7 +307,7 @@ int32_t uDevicePrivateGnssAdd(const uDeviceCfg_t *pDevCfg,
                         transportHandle = errorCodeOrHandle;
                         errorCodeOrHandle = addDevice(transportHandle,
                                                       pDevCfg->transportType,
-                                                      pCfgGnss, pDeviceHandle);
+                                                      pCfgGnss, true, pDeviceHandle);
                         if (errorCodeOrHandle > 0) {
                             // Log that the device is using the given I2C HW
                             x = uDevicePrivateI2cIsUsedBy(*pDeviceHandle, pCfgI2c);
@@ -105,16 +105,29 @@ int32_t uDevicePrivateShortRangeAdd(const uDeviceCfg_t *pDevCfg,
         (pDeviceHandle != NULL)) {
         pCfgUart = &(pDevCfg->transportCfg.cfgUart);
         pCfgSho = &(pDevCfg->deviceCfg.cfgSho);
-        if (pCfgSho->version == 0) {
+        if (pCfgSho->version <= 1) {
             uartCfg.uartPort = pCfgUart->uart;
             uartCfg.baudRate = pCfgUart->baudRate;
             uartCfg.pinTx = pCfgUart->pinTxd;
             uartCfg.pinRx = pCfgUart->pinRxd;
             uartCfg.pinCts = pCfgUart->pinCts;
             uartCfg.pinRts = pCfgUart->pinRts;
-            // Open the short range UART, which creates pDeviceHandle
-            errorCode = uShortRangeOpenUart(pCfgSho->moduleType, &uartCfg,
-                                            false, pDeviceHandle);
+            if ((pCfgSho->version >= 1) &&
+                (pCfgSho->uartBaudRateUpgrade > pCfgUart->baudRate)) {
+                // Open the short range UART at the fastest rate
+                // that can be achieved, which creates pDeviceHandle
+                errorCode = uShortRangeOpenUartBaudrateUpgrade(pCfgSho->moduleType,
+                                                               &uartCfg,
+                                                               pCfgSho->uartBaudRateUpgrade,
+                                                               pDeviceHandle);
+                if (errorCode > 0) {
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                }
+            } else {
+                // Open the short range UART, which creates pDeviceHandle
+                errorCode = uShortRangeOpenUart(pCfgSho->moduleType, &uartCfg,
+                                                false, pDeviceHandle);
+            }
         }
     }
 
@@ -72,6 +72,9 @@ typedef struct {
     const void *pCfg; /**< constant network configuration provided by application. */
     void *pContext; /**< optional context data for this network interface. */
     void *pStatusCallbackData; /**< optional status callback for this network interface. */
+    volatile bool busy; /**< true while the network is being brought up, which
+                             is done without the device API locked. */
+    volatile bool cancel; /**< set to cancel a bring-up that is in progress. */
 } uDeviceNetworkData_t;
 
 /** Internal data structure that uDeviceHandle_t points at.
@@ -83,6 +86,10 @@ typedef struct {
     uDeviceType_t deviceType;   /**< type of device. */
     int32_t moduleType;         /**< module identification (when applicable). */
     void *pContext;             /**< private instance data for the device. */
+    void *pDriverInstance;      /**< the driver's own instance for this device (e.g.
+                                     uCellPrivateInstance_t), set while the driver has
+                                     it in its list, so that it can be found directly
+                                     from the device handle rather than by a search. */
     uDeviceNetworkData_t networkData[U_DEVICE_NETWORKS_MAX_NUM]; /**< network cfg and private data. */
     // Note: In the future structs of function pointers for socket, MQTT etc.
     // implementations may be added here.
@@ -0,0 +1,184 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of setting the host and cellular clocks
+ * from GNSS time.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_debug.h"
+
+#include "u_time.h"
+
+#include "u_device.h"
+
+#include "u_gnss_type.h"
+#include "u_gnss_time.h"
+#include "u_gnss_info.h"
+
+#include "u_cell_net.h"
+#include "u_cell_cfg.h"
+
+#include "u_device_time.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The number of milliseconds from midnight on 1st January 1970 to
+ * midnight on 6th January 1980, the start of week zero of the GNSS
+ * time base in a time synchronisation sample.
+ */
+#define U_DEVICE_TIME_GNSS_EPOCH_UTC_MS 315964800000LL
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Get UTC time in milliseconds at host time *pTickTimeUs,
+// returning negative error code on failure.
+static int64_t getGnssTimeUtcMs(uDeviceHandle_t gnssHandle,
+                                uGnssTimeSync_t *pSync,
+                                int64_t *pTickTimeUs,
+                                int32_t *pAccuracyMs,
+                                bool *pFromTimeSync)
+{
+    int64_t errorCodeOrTimeMs = (int64_t) U_ERROR_COMMON_NOT_FOUND;
+    uGnssTimeSyncSample_t sample;
+    int64_t startTimeUs;
+    int32_t halfReadMs;
+
+    *pFromTimeSync = false;
+    if ((pSync != NULL) && (uGnssTimeSyncGet(pSync, &sample) == 0) &&
+        sample.utcNotGnss) {
+        // The offset converts host time to UTC weeks-since-1980
+        *pTickTimeUs = uPortGetTickTimeUs();
+        errorCodeOrTimeMs = ((*pTickTimeUs * 1000) + sample.offsetNs) / 1000000 +
+                            U_DEVICE_TIME_GNSS_EPOCH_UTC_MS;
+        // Allow a millisecond for rounding plus the drift of the
+        // host clock since the sample was taken
+        *pAccuracyMs = 1 + (int32_t) ((((*pTickTimeUs * 1000) - sample.hostTimeNs) / 1000000) *
+                                      U_DEVICE_TIME_HOST_DRIFT_PPM / 1000000);
+        *pFromTimeSync = true;
+    }
+
+    if (errorCodeOrTimeMs < 0) {
+        startTimeUs = uPortGetTickTimeUs();
+        errorCodeOrTimeMs = uGnssInfoGetTimeUtc(gnssHandle);
+        *pTickTimeUs = uPortGetTickTimeUs();
+        if (errorCodeOrTimeMs >= 0) {
+            // The time, in whole seconds, was read at some point
+            // during the call: take the middle of the possibilities
+            halfReadMs = (int32_t) ((*pTickTimeUs - startTimeUs) / 2000);
+            errorCodeOrTimeMs = (errorCodeOrTimeMs * 1000) + 500 + halfReadMs;
+            *pAccuracyMs = 500 + halfReadMs;
+        }
+    }
+
+    return errorCodeOrTimeMs;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Set the host and cellular clocks from GNSS.
+int32_t uDeviceTimeSetFromGnss(uDeviceHandle_t gnssHandle,
+                               uGnssTimeSync_t *pSync,
+                               uDeviceHandle_t cellHandle,
+                               uDeviceTimeResult_t *pResult)
+{
+    int32_t errorCode;
+    int64_t timeUtcMs;
+    int64_t tickTimeUs;
+    int64_t startTimeUs;
+    int32_t accuracyMs = 0;
+    int32_t waitMs;
+    bool fromTimeSync;
+
+    if (pResult != NULL) {
+        pResult->timeUtcMs = -1;
+        pResult->fromTimeSync = false;
+        pResult->hostAccuracyMs = -1;
+        pResult->cellAccuracyMs = -1;
+    }
+
+    timeUtcMs = getGnssTimeUtcMs(gnssHandle, pSync, &tickTimeUs,
+                                 &accuracyMs, &fromTimeSync);
+    errorCode = (int32_t) timeUtcMs;
+    if (timeUtcMs >= 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        // Set the host clock, moving the time on to now
+        timeUtcMs += (uPortGetTickTimeUs() - tickTimeUs) / 1000;
+        uTimeHostSetUtcMs(timeUtcMs, accuracyMs);
+        uPortLog("U_DEVICE_TIME: host clock set from GNSS%s, accuracy %d ms.\n",
+                 fromTimeSync ? " time synchronisation" : "", accuracyMs);
+        if (pResult != NULL) {
+            pResult->timeUtcMs = timeUtcMs;
+            pResult->fromTimeSync = fromTimeSync;
+            pResult->hostAccuracyMs = accuracyMs;
+        }
+        if (cellHandle != NULL) {
+            // The cellular module takes whole seconds, so wait for
+            // the start of the next one before sending the time
+            timeUtcMs = uTimeHostGetUtcMs(NULL);
+            waitMs = 1000 - (int32_t) (timeUtcMs % 1000);
+            uPortTaskBlock(waitMs);
+            startTimeUs = uPortGetTickTimeUs();
+            errorCode = uCellCfgSetTimeUtc(cellHandle, (timeUtcMs + waitMs) / 1000);
+            if (errorCode == 0) {
+                // Whenever, during the AT command, the module set its
+                // clock, it was set to the start of the second
+                accuracyMs += (int32_t) ((uPortGetTickTimeUs() - startTimeUs) / 1000);
+                uPortLog("U_DEVICE_TIME: cellular clock set from GNSS,"
+                         " accuracy %d ms.\n", accuracyMs);
+                if (pResult != NULL) {
+                    pResult->cellAccuracyMs = accuracyMs;
+                }
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// End of file
@@ -0,0 +1,412 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Test for the GNSS forwarding stage: epoch detection, holding
+ * and flushing, using synthetic messages and a stub in place of the
+ * socket, so no GNSS device or network is required.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset(), memcpy(), memcmp()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_heap.h"
+#include "u_port_os.h"
+
+#include "u_ringbuffer.h"
+
+#include "u_device.h"
+
+#include "u_sock.h"
+
+#include "u_gnss_type.h"
+#include "u_gnss_msg.h"
+
+#include "u_device_forward.h"
+#include "u_device_forward_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_DEVICE_FORWARD_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/** The socket descriptor that writevStub() expects.
+ */
+#define U_DEVICE_FORWARD_TEST_DESCRIPTOR 7
+
+/** The size of the buffers used to hold the stream that is written
+ * to the stub socket and the stream that is expected.
+ */
+#define U_DEVICE_FORWARD_TEST_STREAM_LENGTH_BYTES 512
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The number of bytes writevStub() accepts per call, negative to
+ * make it return that as an error.
+ */
+static int32_t gWritevAccept = INT32_MAX;
+
+/** The number of times writevStub() has been called.
+ */
+static size_t gWritevCalls = 0;
+
+/** Everything that writevStub() has accepted.
+ */
+static char gSent[U_DEVICE_FORWARD_TEST_STREAM_LENGTH_BYTES];
+
+/** The number of bytes at gSent.
+ */
+static size_t gSentLength = 0;
+
+/** The stream that should arrive at the far end.
+ */
+static char gExpected[U_DEVICE_FORWARD_TEST_STREAM_LENGTH_BYTES];
+
+/** The number of bytes at gExpected.
+ */
+static size_t gExpectedLength = 0;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Stand-in for uSockWritev(): accepts up to gWritevAccept bytes
+// into gSent.
+static int32_t writevStub(uSockDescriptor_t descriptor,
+                          const uSockIoVec_t *pIoVec, size_t ioVecCount)
+{
+    int32_t errorCodeOrSize = gWritevAccept;
+    size_t room;
+    size_t x;
+
+    gWritevCalls++;
+    if (descriptor != U_DEVICE_FORWARD_TEST_DESCRIPTOR) {
+        errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    }
+    if (errorCodeOrSize >= 0) {
+        room = (size_t) errorCodeOrSize;
+        errorCodeOrSize = 0;
+        for (size_t y = 0; (y < ioVecCount) && (room > 0); y++) {
+            x = pIoVec[y].dataSizeBytes;
+            if (x > room) {
+                x = room;
+            }
+            U_PORT_TEST_ASSERT(gSentLength + x <= sizeof(gSent));
+            memcpy(gSent + gSentLength, pIoVec[y].pData, x);
+            gSentLength += x;
+            room -= x;
+            errorCodeOrSize += (int32_t) x;
+        }
+    }
+
+    return errorCodeOrSize;
+}
+
+// Make a synthetic RTCM message of the given total length, including
+// the three byte frame header and three byte CRC (which is not
+// checked by the forwarding stage so is left as zero), filled with
+// a pattern that starts at seed.
+static void rtcmMake(char *pBuffer, size_t length, uint16_t number,
+                     bool multiple, char seed)
+{
+    size_t payloadLength = length - 6;
+
+    for (size_t x = 0; x < length; x++) {
+        *(pBuffer + x) = (char) (seed + x);
+    }
+    *pBuffer = (char) 0xd3;
+    *(pBuffer + 1) = (char) ((payloadLength >> 8) & 0x03);
+    *(pBuffer + 2) = (char) (payloadLength & 0xff);
+    *(pBuffer + 3) = (char) (number >> 4);
+    *(pBuffer + 4) = (char) ((*(pBuffer + 4) & 0x0f) | ((number & 0x0f) << 4));
+    if (length > 9) {
+        // The MSM "multiple message" bit
+        *(pBuffer + 9) = (char) (*(pBuffer + 9) & ~0x02);
+        if (multiple) {
+            *(pBuffer + 9) = (char) (*(pBuffer + 9) | 0x02);
+        }
+    }
+    memset(pBuffer + length - 3, 0, 3);
+}
+
+// Pass a message to the forwarding stage as two spans, the first
+// split bytes long, adding it to the expected stream if expected
+// is true.
+static void messageForward(uDeviceForward_t *pForward, const char *pMessage,
+                           size_t length, uint16_t number, size_t split,
+                           bool expected)
+{
+    uGnssMessageId_t messageId;
+    uRingBufferSpan_t span[2];
+
+    messageId.type = U_GNSS_PROTOCOL_RTCM;
+    messageId.id.rtcm = number;
+    span[0].pData = pMessage;
+    span[0].length = split;
+    span[1].pData = pMessage + split;
+    span[1].length = length - split;
+    uDeviceForwardPrivateMessage(pForward, &messageId, span, length);
+    if (expected) {
+        U_PORT_TEST_ASSERT(gExpectedLength + length <= sizeof(gExpected));
+        memcpy(gExpected + gExpectedLength, pMessage, length);
+        gExpectedLength += length;
+    }
+}
+
+// Reset the stub and the forwarding context, which would normally
+// be set up by uDeviceForwardStart().
+static void reset(uDeviceForward_t *pForward, char *pBuffer,
+                  size_t bufferSize)
+{
+    memset(pForward, 0, sizeof(*pForward));
+    pForward->descriptor = U_DEVICE_FORWARD_TEST_DESCRIPTOR;
+    pForward->asyncHandle = -1;
+    pForward->pBuffer = pBuffer;
+    pForward->bufferSize = bufferSize;
+    gWritevAccept = INT32_MAX;
+    gWritevCalls = 0;
+    gSentLength = 0;
+    gExpectedLength = 0;
+}
+
+// Check that what has been sent is what was expected.
+static void checkStream()
+{
+    U_TEST_PRINT_LINE("%d byte(s) sent, %d byte(s) expected.",
+                      (int32_t) gSentLength, (int32_t) gExpectedLength);
+    U_PORT_TEST_ASSERT(gSentLength == gExpectedLength);
+    U_PORT_TEST_ASSERT(memcmp(gSent, gExpected, gSentLength) == 0);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Test the recognition of the end of an epoch.
+ */
+U_PORT_TEST_FUNCTION("[deviceForward]", "deviceForwardEpochEnd")
+{
+    char message[32];
+    uGnssMessageId_t messageId;
+    uRingBufferSpan_t span[2];
+
+    messageId.type = U_GNSS_PROTOCOL_RTCM;
+
+    // An MSM7 message for GPS with the multiple message bit set,
+    // then clear, split across the two spans at every point
+    for (size_t x = 0; x <= sizeof(message); x++) {
+        for (size_t y = 0; y < 2; y++) {
+            rtcmMake(message, sizeof(message), 1077, (y == 0), 0x55);
+            messageId.id.rtcm = 1077;
+            span[0].pData = message;
+            span[0].length = x;
+            span[1].pData = message + x;
+            span[1].length = sizeof(message) - x;
+            U_PORT_TEST_ASSERT(uDeviceForwardPrivateIsEpochEnd(&messageId, span) == (y > 0));
+        }
+    }
+
+    // The first and last MSM messages, MSM1 and MSM7
+    rtcmMake(message, sizeof(message), 1071, false, 0);
+    span[0].pData = message;
+    span[0].length = sizeof(message);
+    span[1].pData = NULL;
+    span[1].length = 0;
+    messageId.id.rtcm = 1071;
+    U_PORT_TEST_ASSERT(uDeviceForwardPrivateIsEpochEnd(&messageId, span));
+    messageId.id.rtcm = 1137;
+    U_PORT_TEST_ASSERT(uDeviceForwardPrivateIsEpochEnd(&messageId, span));
+    // Not MSM: these never end an epoch, whatever the bit says
+    messageId.id.rtcm = 1005;
+    U_PORT_TEST_ASSERT(!uDeviceForwardPrivateIsEpochEnd(&messageId, span));
+    messageId.id.rtcm = 1070;
+    U_PORT_TEST_ASSERT(!uDeviceForwardPrivateIsEpochEnd(&messageId, span));
+    messageId.id.rtcm = 1078;
+    U_PORT_TEST_ASSERT(!uDeviceForwardPrivateIsEpochEnd(&messageId, span));
+    messageId.id.rtcm = 1230;
+    U_PORT_TEST_ASSERT(!uDeviceForwardPrivateIsEpochEnd(&messageId, span));
+    // An MSM message too short to contain the bit
+    messageId.id.rtcm = 1077;
+    span[0].length = 9;
+    U_PORT_TEST_ASSERT(!uDeviceForwardPrivateIsEpochEnd(&messageId, span));
+
+    // UBX: only UBX-NAV-EOE ends an epoch
+    messageId.type = U_GNSS_PROTOCOL_UBX;
+    messageId.id.ubx = 0x0161;
+    U_PORT_TEST_ASSERT(uDeviceForwardPrivateIsEpochEnd(&messageId, span));
+    messageId.id.ubx = 0x0107;
+    U_PORT_TEST_ASSERT(!uDeviceForwardPrivateIsEpochEnd(&messageId, span));
+
+    // Anything else is sent straight away
+    messageId.type = U_GNSS_PROTOCOL_NMEA;
+    messageId.id.pNmea = NULL;
+    U_PORT_TEST_ASSERT(uDeviceForwardPrivateIsEpochEnd(&messageId, span));
+}
+
+/** Test holding and flushing, including partial writes, failed
+ * writes and messages that are too large to hold.
+ */
+U_PORT_TEST_FUNCTION("[deviceForward]", "deviceForwardHoldFlush")
+{
+    int32_t heapUsed;
+    uDeviceForward_t forwardContext;
+    uDeviceForwardStats_t stats;
+    char buffer[100];
+    char a[20];
+    char b[30];
+    char c[30];
+    char big[120];
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    uDeviceForwardPrivateWritevSet(writevStub);
+
+    rtcmMake(a, sizeof(a), 1005, false, 0x10);
+    rtcmMake(b, sizeof(b), 1077, true, 0x40);
+    rtcmMake(c, sizeof(c), 1087, false, 0x70);
+    rtcmMake(big, sizeof(big), 1097, false, 0x20);
+
+    U_TEST_PRINT_LINE("messages of an epoch go in a single write.");
+    reset(&forwardContext, buffer, sizeof(buffer));
+    messageForward(&forwardContext, a, sizeof(a), 1005, 5, true);
+    messageForward(&forwardContext, b, sizeof(b), 1077, sizeof(b), true);
+    U_PORT_TEST_ASSERT(gWritevCalls == 0);
+    U_PORT_TEST_ASSERT(forwardContext.length == sizeof(a) + sizeof(b));
+    messageForward(&forwardContext, c, sizeof(c), 1087, 12, true);
+    U_PORT_TEST_ASSERT(gWritevCalls == 1);
+    U_PORT_TEST_ASSERT(forwardContext.length == 0);
+    checkStream();
+    uDeviceForwardStatsGet(&forwardContext, &stats);
+    U_PORT_TEST_ASSERT(stats.numMessages == 3);
+    U_PORT_TEST_ASSERT(stats.numWrites == 1);
+    U_PORT_TEST_ASSERT(stats.numWritesShort == 0);
+    U_PORT_TEST_ASSERT(stats.numBytesSent == sizeof(a) + sizeof(b) + sizeof(c));
+    U_PORT_TEST_ASSERT(stats.numMessagesDropped == 0);
+
+    U_TEST_PRINT_LINE("a short write of held data keeps the rest in order.");
+    reset(&forwardContext, buffer, sizeof(buffer));
+    messageForward(&forwardContext, a, sizeof(a), 1005, 0, true);
+    gWritevAccept = 10;
+    messageForward(&forwardContext, c, sizeof(c), 1087, 3, true);
+    // Half of a is left, with all of c held behind it
+    U_PORT_TEST_ASSERT(forwardContext.length == (sizeof(a) - 10) + sizeof(c));
+    gWritevAccept = INT32_MAX;
+    messageForward(&forwardContext, c, sizeof(c), 1087, sizeof(c), true);
+    U_PORT_TEST_ASSERT(forwardContext.length == 0);
+    checkStream();
+    uDeviceForwardStatsGet(&forwardContext, &stats);
+    U_PORT_TEST_ASSERT(stats.numWrites == 2);
+    U_PORT_TEST_ASSERT(stats.numWritesShort == 1);
+
+    U_TEST_PRINT_LINE("a short write part-way into a message keeps its remainder.");
+    reset(&forwardContext, buffer, sizeof(buffer));
+    messageForward(&forwardContext, a, sizeof(a), 1005, sizeof(a), true);
+    gWritevAccept = sizeof(a) + 5;
+    messageForward(&forwardContext, c, sizeof(c), 1087, 20, true);
+    U_PORT_TEST_ASSERT(forwardContext.length == sizeof(c) - 5);
+    gWritevAccept = INT32_MAX;
+    messageForward(&forwardContext, c, sizeof(c), 1087, 0, true);
+    U_PORT_TEST_ASSERT(forwardContext.length == 0);
+    checkStream();
+
+    U_TEST_PRINT_LINE("a failed write drops only whole, unstarted, messages.");
+    reset(&forwardContext, buffer, 40);
+    messageForward(&forwardContext, a, sizeof(a), 1005, sizeof(a), true);
+    gWritevAccept = (int32_t) U_ERROR_COMMON_UNKNOWN;
+    // a stays held and c doesn't fit behind it
+    messageForward(&forwardContext, c, sizeof(c), 1087, 10, false);
+    U_PORT_TEST_ASSERT(forwardContext.length == sizeof(a));
+    uDeviceForwardStatsGet(&forwardContext, &stats);
+    U_PORT_TEST_ASSERT(stats.numMessagesDropped == 1);
+    U_PORT_TEST_ASSERT(stats.numBytesDropped == sizeof(c));
+    U_PORT_TEST_ASSERT(stats.numWritesShort == 1);
+    gWritevAccept = INT32_MAX;
+    messageForward(&forwardContext, c, sizeof(c), 1087, sizeof(c), true);
+    checkStream();
+
+    U_TEST_PRINT_LINE("a message larger than the buffer is dropped whole.");
+    reset(&forwardContext, buffer, sizeof(buffer));
+    messageForward(&forwardContext, a, sizeof(a), 1005, 0, true);
+    // Even if the socket would take some of it, it must not be
+    // started since its remainder could not be held
+    gWritevAccept = 50;
+    messageForward(&forwardContext, big, sizeof(big), 1097, 60, false);
+    U_PORT_TEST_ASSERT(gWritevCalls == 0);
+    U_PORT_TEST_ASSERT(forwardContext.length == sizeof(a));
+    uDeviceForwardStatsGet(&forwardContext, &stats);
+    U_PORT_TEST_ASSERT(stats.numMessagesDropped == 1);
+    U_PORT_TEST_ASSERT(stats.numBytesDropped == sizeof(big));
+    gWritevAccept = INT32_MAX;
+    messageForward(&forwardContext, c, sizeof(c), 1087, 1, true);
+    checkStream();
+    // One that exactly fills the buffer is fine, even when only
+    // part of it is sent
+    reset(&forwardContext, buffer, sizeof(c));
+    gWritevAccept = 10;
+    messageForward(&forwardContext, c, sizeof(c), 1087, 15, true);
+    U_PORT_TEST_ASSERT(forwardContext.length == sizeof(c) - 10);
+    gWritevAccept = INT32_MAX;
+    messageForward(&forwardContext, c, sizeof(c), 1087, 0, true);
+    U_PORT_TEST_ASSERT(forwardContext.length == 0);
+    checkStream();
+
+    uDeviceForwardPrivateWritevSet(NULL);
+
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+// End of file
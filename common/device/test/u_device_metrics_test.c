@@ -0,0 +1,188 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Test for the metrics registry.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // strstr()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_heap.h"
+#include "u_port_os.h"
+
+#include "u_device_metrics.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_DEVICE_METRICS_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The bucket limits of the test histogram.
+ */
+static const int32_t gBucketLimit[] = {10, 100};
+
+/** The bucket counts of the test histogram.
+ */
+static uint32_t gBucketCount[(sizeof(gBucketLimit) / sizeof(gBucketLimit[0])) + 1];
+
+/** A test counter.
+ */
+static uDeviceMetric_t gCounter = U_DEVICE_METRIC_COUNTER("test.counter");
+
+/** A test gauge.
+ */
+static uDeviceMetric_t gGauge = U_DEVICE_METRIC_GAUGE("test.gauge");
+
+/** A test histogram.
+ */
+static uDeviceMetric_t gHistogram = U_DEVICE_METRIC_HISTOGRAM("test.histogram",
+                                                              gBucketLimit,
+                                                              gBucketCount,
+                                                              sizeof(gBucketCount) /
+                                                              sizeof(gBucketCount[0]));
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Test the metrics registry.
+ */
+U_PORT_TEST_FUNCTION("[deviceMetrics]", "deviceMetricsBasic")
+{
+    int32_t heapUsed;
+    int32_t length;
+    int32_t y;
+    char *pBuffer;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    U_TEST_PRINT_LINE("registering metrics.");
+    U_PORT_TEST_ASSERT(uDeviceMetricRegister(NULL) < 0);
+    U_PORT_TEST_ASSERT(uDeviceMetricRegister(&gCounter) == 0);
+    U_PORT_TEST_ASSERT(uDeviceMetricRegister(&gGauge) == 0);
+    U_PORT_TEST_ASSERT(uDeviceMetricRegister(&gHistogram) == 0);
+    // Registering again should do nothing
+    U_PORT_TEST_ASSERT(uDeviceMetricRegister(&gCounter) == 0);
+
+    uDeviceMetricAdd(&gCounter, 5);
+    uDeviceMetricAdd(&gCounter, 1);
+    U_PORT_TEST_ASSERT(uDeviceMetricGet(&gCounter) == 6);
+    uDeviceMetricSet(&gGauge, 3);
+    uDeviceMetricSet(&gGauge, -42);
+    U_PORT_TEST_ASSERT((int32_t) uDeviceMetricGet(&gGauge) == -42);
+    uDeviceMetricSample(&gHistogram, -1);
+    uDeviceMetricSample(&gHistogram, 10);
+    uDeviceMetricSample(&gHistogram, 11);
+    uDeviceMetricSample(&gHistogram, 1000);
+    uDeviceMetricSample(&gHistogram, 2000);
+    U_PORT_TEST_ASSERT(uDeviceMetricGet(&gHistogram) == 5);
+    U_PORT_TEST_ASSERT((gBucketCount[0] == 2) && (gBucketCount[1] == 1) &&
+                       (gBucketCount[2] == 2));
+
+    U_TEST_PRINT_LINE("checking JSON snapshot.");
+    U_PORT_TEST_ASSERT(uDeviceMetricsSnapshot((uDeviceMetricsFormat_t) 99, NULL, 0) < 0);
+    length = uDeviceMetricsSnapshot(U_DEVICE_METRICS_FORMAT_JSON, NULL, 0);
+    U_PORT_TEST_ASSERT(length > 0);
+    pBuffer = (char *) pUPortMalloc(length);
+    U_PORT_TEST_ASSERT(pBuffer != NULL);
+    U_PORT_TEST_ASSERT(uDeviceMetricsSnapshot(U_DEVICE_METRICS_FORMAT_JSON, pBuffer,
+                                              length - 1) == (int32_t) U_ERROR_COMMON_NO_MEMORY);
+    y = uDeviceMetricsSnapshot(U_DEVICE_METRICS_FORMAT_JSON, pBuffer, length);
+    U_PORT_TEST_ASSERT(y == length);
+    //lint -e(668) Suppress possible use of NULL pointer, it is checked above
+    U_TEST_PRINT_LINE("%s", pBuffer);
+    U_PORT_TEST_ASSERT(strlen(pBuffer) == (size_t) length - 1);
+    U_PORT_TEST_ASSERT(*pBuffer == '{');
+    U_PORT_TEST_ASSERT(*(pBuffer + length - 2) == '}');
+    U_PORT_TEST_ASSERT(strstr(pBuffer, "\"test.counter\":6") != NULL);
+    U_PORT_TEST_ASSERT(strstr(pBuffer, "\"test.gauge\":-42") != NULL);
+    U_PORT_TEST_ASSERT(strstr(pBuffer, "\"test.histogram\":[2,1,2]") != NULL);
+    uPortFree(pBuffer);
+
+    U_TEST_PRINT_LINE("checking binary snapshot.");
+    length = uDeviceMetricsSnapshot(U_DEVICE_METRICS_FORMAT_BINARY, NULL, 0);
+    // Version, count, at least the three metrics
+    U_PORT_TEST_ASSERT(length >= 2 + (2 + 12 + 4) + (2 + 10 + 4) + (2 + 14 + 1 + (3 * 4)));
+    pBuffer = (char *) pUPortMalloc(length);
+    U_PORT_TEST_ASSERT(pBuffer != NULL);
+    y = uDeviceMetricsSnapshot(U_DEVICE_METRICS_FORMAT_BINARY, pBuffer, length);
+    U_PORT_TEST_ASSERT(y == length);
+    //lint -e(668) Suppress possible use of NULL pointer, it is checked above
+    U_PORT_TEST_ASSERT(*pBuffer == U_DEVICE_METRICS_BINARY_VERSION);
+    U_PORT_TEST_ASSERT(*(pBuffer + 1) >= 3);
+    uPortFree(pBuffer);
+
+    U_TEST_PRINT_LINE("deregistering metrics.");
+    uDeviceMetricDeregister(&gCounter);
+    uDeviceMetricDeregister(&gGauge);
+    uDeviceMetricDeregister(&gHistogram);
+    length = uDeviceMetricsSnapshot(U_DEVICE_METRICS_FORMAT_JSON, NULL, 0);
+    U_PORT_TEST_ASSERT(length > 0);
+    pBuffer = (char *) pUPortMalloc(length);
+    U_PORT_TEST_ASSERT(pBuffer != NULL);
+    U_PORT_TEST_ASSERT(uDeviceMetricsSnapshot(U_DEVICE_METRICS_FORMAT_JSON, pBuffer,
+                                              length) == length);
+    U_PORT_TEST_ASSERT(strstr(pBuffer, "test.") == NULL);
+    uPortFree(pBuffer);
+
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+// End of file
@@ -0,0 +1,275 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_HTTP_CLIENT_H_
+#define _U_HTTP_CLIENT_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_security_tls.h"
+#include "u_device.h"
+
+/** \addtogroup HTTP-Client HTTP Client
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the u-blox HTTP client API.  The
+ * client runs HTTP/1.1 over a TCP socket of the sockets API
+ * (common/sock), optionally secured with TLS, and hence works with
+ * any device that the sockets API supports.  Request bodies are
+ * taken from a producer callback and response bodies are handed to
+ * a consumer callback as they arrive, a buffer of
+ * #U_HTTP_CLIENT_BUFFER_LENGTH_BYTES being all the RAM that is
+ * required whatever the size of the body; a consumer callback may,
+ * for instance, write the body to a file in the module with
+ * uCellFileWrite().  The connection to the server is kept open
+ * between requests (HTTP persistent connection, AKA keep-alive), so
+ * that repeated requests to the same server do not repeat TCP/TLS
+ * connection set-up.
+ *
+ * This API is thread-safe except for pUHttpClientOpen() and
+ * uHttpClientClose(), which should not be called simultaneously
+ * with any other HTTP client API function for the same context;
+ * requests on a given context are performed one at a time.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_HTTP_CLIENT_RESPONSE_WAIT_SECONDS
+/** The default amount of time to wait for a response from the
+ * HTTP server in seconds.
+ */
+# define U_HTTP_CLIENT_RESPONSE_WAIT_SECONDS 30
+#endif
+
+#ifndef U_HTTP_CLIENT_BUFFER_LENGTH_BYTES
+/** The size of the buffer, one per HTTP client context, used to
+ * assemble the request header, to carry the request body from the
+ * producer callback to the socket and to receive the response;
+ * the request line plus headers must fit into this buffer, as must
+ * any single response header line that is to be parsed.
+ */
+# define U_HTTP_CLIENT_BUFFER_LENGTH_BYTES 512
+#endif
+
+/** The defaults for an HTTP connection, see #uHttpClientConnection_t.
+ * Whenever an instance of uHttpClientConnection_t is created it
+ * should be assigned to this to ensure the correct default
+ * settings.
+ */
+#define U_HTTP_CLIENT_CONNECTION_DEFAULT {NULL,                                \
+                                          U_HTTP_CLIENT_RESPONSE_WAIT_SECONDS, \
+                                          true}
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The HTTP request types.
+ */
+typedef enum {
+    U_HTTP_CLIENT_REQUEST_GET,
+    U_HTTP_CLIENT_REQUEST_HEAD,
+    U_HTTP_CLIENT_REQUEST_POST,
+    U_HTTP_CLIENT_REQUEST_PUT,
+    U_HTTP_CLIENT_REQUEST_DELETE,
+    U_HTTP_CLIENT_REQUEST_MAX_NUM
+} uHttpClientRequestType_t;
+
+/** HTTP connection information.
+ * NOTE: if this structure is modified be sure to modify
+ * #U_HTTP_CLIENT_CONNECTION_DEFAULT to match.
+ */
+typedef struct {
+    const char *pServerName;   /**< the null-terminated name of the
+                                    HTTP server, a domain name or an
+                                    IP address, which may include a
+                                    port number, e.g. "myserver.com:8080";
+                                    if no port number is given then
+                                    80 is used, or 443 if TLS security
+                                    is requested. */
+    int32_t timeoutSeconds;    /**< the time to wait for a response
+                                    from the server. */
+    bool keepAlive;            /**< if true (the default) the
+                                    connection to the server is kept
+                                    open after a request, provided the
+                                    server agrees, so that the next
+                                    request need not set up the
+                                    connection again. */
+} uHttpClientConnection_t;
+
+/** Callback to produce a request body: the callback should write up
+ * to size bytes of the body to pBuffer and return the number of bytes
+ * written, zero when the body is complete, or a negative value to
+ * abandon the request.  The callback is called from within
+ * uHttpClientRequest(); it may block if it has no data to hand.
+ *
+ * @param[out] pBuffer  where to write the body data.
+ * @param size          the amount of storage at pBuffer.
+ * @param[in] pParam    the parameter passed to uHttpClientRequest().
+ * @return              the number of bytes written to pBuffer,
+ *                      zero at the end of the body, negative to
+ *                      abandon the request.
+ */
+typedef int32_t (uHttpClientBodyProducer_t)(char *pBuffer, size_t size,
+                                            void *pParam);
+
+/** Callback to consume a response body: called from within
+ * uHttpClientRequest() with each piece of the response body as it
+ * arrives (any chunked transfer encoding already removed); it is
+ * not called if the response has no body.
+ *
+ * @param statusCode  the HTTP status code of the response, e.g. 200.
+ * @param[in] pData   the body data; valid only for the duration of
+ *                    the call.
+ * @param size        the number of bytes at pData.
+ * @param[in] pParam  the parameter passed to uHttpClientRequest().
+ * @return            true to continue, false to abandon the response,
+ *                    in which case the connection to the server is
+ *                    closed.
+ */
+typedef bool (uHttpClientBodyConsumer_t)(int32_t statusCode,
+                                         const char *pData, size_t size,
+                                         void *pParam);
+
+/** HTTP client context data, used internally by this code and
+ * exposed here only so that it can be handed around by the
+ * caller.  The contents and, umm, structure of this structure
+ * may be changed without notice and should not be relied upon
+ * by the caller.
+ */
+typedef struct {
+    uDeviceHandle_t devHandle;
+    void *mutexHandle; /* No 'p' prefix as this should be treated as a handle,
+                          not using actual type to avoid customer having to drag
+                          more headers in for what is an internal structure. */
+    void *pPriv;       /* Holds the reference to the internal data structures. */
+} uHttpClientContext_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Open an HTTP client session; no connection is made to the server
+ * until the first request.  The network of the device must be up.
+ *
+ * @param devHandle                the device handle to be used,
+ *                                 for example obtained using uDeviceOpen().
+ * @param[in] pConnection          the connection information; cannot
+ *                                 be NULL and pServerName cannot be
+ *                                 NULL.  The string pServerName is
+ *                                 copied, the structure need not be
+ *                                 kept.
+ * @param[in] pSecurityTlsSettings a pointer to the security settings to
+ *                                 be applied, NULL for no security;
+ *                                 the structure is copied but any strings
+ *                                 or binary data it points to must remain
+ *                                 valid until uHttpClientClose() is called.
+ *                                 Consider setting enableSessionResumption
+ *                                 so that, should the server close the
+ *                                 connection, the next one is quicker.
+ * @return                         a pointer to the HTTP client context
+ *                                 or NULL on failure (in which case
+ *                                 uHttpClientOpenResetLastError() can
+ *                                 be called to obtain an error code).
+ */
+uHttpClientContext_t *pUHttpClientOpen(uDeviceHandle_t devHandle,
+                                       const uHttpClientConnection_t *pConnection,
+                                       const uSecurityTlsSettings_t *pSecurityTlsSettings);
+
+/** If pUHttpClientOpen() returned NULL this function can be
+ * called to find out why.  That error code is reset to "success"
+ * by calling this function.
+ *
+ * @return the last error code from a call to pUHttpClientOpen().
+ */
+int32_t uHttpClientOpenResetLastError();
+
+/** Close the given HTTP client session, closing any connection to
+ * the server and freeing memory.
+ *
+ * @param[in] pContext a pointer to the HTTP client context.
+ */
+void uHttpClientClose(uHttpClientContext_t *pContext);
+
+/** Perform an HTTP request, blocking until the response has been
+ * received or the timeout set in #uHttpClientConnection_t has passed
+ * without anything being received.  If none is open, a connection is
+ * made to the server.  Should a connection that has been kept open
+ * since a previous request turn out to have been closed by the server
+ * before any of the response is received, and the request has no
+ * body, the request is repeated once on a new connection.
+ *
+ * @param[in] pContext       a pointer to the HTTP client context.
+ * @param type               the request type.
+ * @param[in] pPath          the null-terminated path of the request,
+ *                           e.g. "/index.html"; cannot be NULL.
+ * @param[in] pContentType   the null-terminated content type of the
+ *                           request body, e.g. "application/json";
+ *                           ignored if pProducer is NULL, may be NULL.
+ * @param contentLength      the length of the request body, if known,
+ *                           in which case pProducer must produce exactly
+ *                           that many bytes, else -1, in which case
+ *                           the request body is sent with chunked
+ *                           transfer encoding; ignored if pProducer is
+ *                           NULL.
+ * @param[in] pProducer      the request body producer callback, NULL
+ *                           if the request has no body.
+ * @param[in] pProducerParam a parameter passed to pProducer.
+ * @param[in] pConsumer      the response body consumer callback,
+ *                           NULL to discard the response body.
+ * @param[in] pConsumerParam a parameter passed to pConsumer.
+ * @return                   on success the HTTP status code of the
+ *                           response, e.g. 200, else negative error
+ *                           code.
+ */
+int32_t uHttpClientRequest(uHttpClientContext_t *pContext,
+                           uHttpClientRequestType_t type,
+                           const char *pPath,
+                           const char *pContentType,
+                           int32_t contentLength,
+                           uHttpClientBodyProducer_t *pProducer,
+                           void *pProducerParam,
+                           uHttpClientBodyConsumer_t *pConsumer,
+                           void *pConsumerParam);
+
+/** Determine whether a connection to the server is currently open,
+ * i.e. whether the next request will avoid connection set-up.
+ *
+ * @param[in] pContext a pointer to the HTTP client context.
+ * @return             true if a connection is open, else false.
+ */
+bool uHttpClientIsConnected(const uHttpClientContext_t *pContext);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_HTTP_CLIENT_H_
+
+// End of file
@@ -0,0 +1,731 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the u-blox HTTP client API.
+ *
+ * This implementation runs HTTP/1.1 over a TCP socket of the
+ * sockets API, with the socket kept open between requests for as
+ * long as the server allows.  Nothing larger than
+ * #U_HTTP_CLIENT_BUFFER_LENGTH_BYTES is ever held in RAM: the request
+ * header is assembled in the buffer of the context, request body data
+ * is produced into the same buffer and written out from there and
+ * response data is read into it and handed to the consumer callback
+ * directly from there.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdlib.h"    // strtol()
+#include "string.h"    // strlen(), memcpy(), memmove()
+#include "stdio.h"     // snprintf()
+#include "ctype.h"     // tolower()
+#include "errno.h"
+
+#include "u_error_common.h"
+
+#include "u_port_clib_platform_specific.h" /* Integer stdio, must be included
+                                              before the other port files if
+                                              any print or scan function is used. */
+#include "u_port.h"
+#include "u_port_heap.h"
+#include "u_port_os.h"
+
+#include "u_sock.h"
+#include "u_sock_errno.h"
+#include "u_sock_security.h"
+
+#include "u_http_client.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The default port for HTTP.
+ */
+#define U_HTTP_CLIENT_PORT 80
+
+/** The default port for HTTPS.
+ */
+#define U_HTTP_CLIENT_PORT_SECURE 443
+
+/** Room to leave at the start of the buffer for the chunk
+ * size line when sending a body with chunked transfer encoding,
+ * "xxxx\r\n", which limits a chunk to 0xFFFF bytes.
+ */
+#define U_HTTP_CLIENT_CHUNK_HEADER_LENGTH_BYTES 6
+
+/** Room to leave at the end of the buffer for the CR/LF that
+ * follows a chunk.
+ */
+#define U_HTTP_CLIENT_CHUNK_TRAILER_LENGTH_BYTES 2
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The internal data of an HTTP client context.
+ */
+typedef struct {
+    char *pHost;            /**< the host name, without the port number. */
+    char *pHostHeader;      /**< the server name as given, for the Host header. */
+    uint16_t port;
+    int32_t timeoutSeconds;
+    bool keepAlive;
+    bool secure;            /**< true if securityTlsSettings is to be applied. */
+    uSecurityTlsSettings_t securityTlsSettings;
+    int32_t sock;           /**< the socket descriptor, -1 if there is no connection. */
+    size_t bufferLength;    /**< the number of received bytes in buffer. */
+    size_t bufferIndex;     /**< the next received byte in buffer to be used. */
+    int32_t receivedBytes;  /**< the number of bytes received for this response. */
+    int32_t stopTimeMs;     /**< the time at which to give up receiving. */
+    char buffer[U_HTTP_CLIENT_BUFFER_LENGTH_BYTES];
+} uHttpClientPrivate_t;
+
+/** What the headers of a response say about its body.
+ */
+typedef struct {
+    int32_t statusCode;
+    int32_t contentLength;  /**< -1 if there is no Content-Length header. */
+    bool chunked;
+    bool close;             /**< true if the server will close the connection. */
+} uHttpClientResponse_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The last error code from pUHttpClientOpen().
+ */
+static uErrorCode_t gLastOpenError = U_ERROR_COMMON_SUCCESS;
+
+/** The request type strings, in the order of uHttpClientRequestType_t.
+ */
+static const char *const gpRequestTypeStr[] = {"GET", "HEAD", "POST",
+                                               "PUT", "DELETE"
+                                              };
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: MISC
+ * -------------------------------------------------------------- */
+
+// Return true if the (not null-terminated) string at pStr begins
+// with the null-terminated string pPrefix, ignoring case.
+static bool startsWithNoCase(const char *pStr, size_t length,
+                             const char *pPrefix)
+{
+    bool match = true;
+    size_t x = 0;
+
+    for (; (pPrefix[x] != 0) && match; x++) {
+        if ((x >= length) ||
+            (tolower((int32_t) (uint8_t) pStr[x]) != tolower((int32_t) (uint8_t) pPrefix[x]))) {
+            match = false;
+        }
+    }
+
+    return match;
+}
+
+// Return true if the (not null-terminated) string at pStr contains
+// the null-terminated string pToken, ignoring case.
+static bool containsNoCase(const char *pStr, size_t length,
+                           const char *pToken)
+{
+    bool found = false;
+
+    for (size_t x = 0; (x < length) && !found; x++) {
+        found = startsWithNoCase(pStr + x, length - x, pToken);
+    }
+
+    return found;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: CONNECTION
+ * -------------------------------------------------------------- */
+
+// Close the connection to the server, if there is one.
+static void connectionClose(uHttpClientPrivate_t *pPriv)
+{
+    if (pPriv->sock >= 0) {
+        uSockShutdown(pPriv->sock, U_SOCK_SHUTDOWN_READ_WRITE);
+        uSockClose(pPriv->sock);
+        pPriv->sock = -1;
+    }
+    pPriv->bufferLength = 0;
+    pPriv->bufferIndex = 0;
+}
+
+// Open a connection to the server.
+static int32_t connectionOpen(uDeviceHandle_t devHandle,
+                              uHttpClientPrivate_t *pPriv)
+{
+    int32_t errorCode;
+    uSockAddress_t address;
+
+    memset(&address, 0, sizeof(address));
+    errorCode = uSockGetHostByName(devHandle, pPriv->pHost,
+                                   &(address.ipAddress));
+    if (errorCode == 0) {
+        address.port = pPriv->port;
+        errorCode = uSockCreate(devHandle, U_SOCK_TYPE_STREAM,
+                                U_SOCK_PROTOCOL_TCP);
+        if (errorCode >= 0) {
+            pPriv->sock = errorCode;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            if (pPriv->secure) {
+                errorCode = uSockSecurity(pPriv->sock,
+                                          &(pPriv->securityTlsSettings));
+            }
+            if (errorCode == 0) {
+                errorCode = uSockConnect(pPriv->sock, &address);
+            }
+            if (errorCode != 0) {
+                connectionClose(pPriv);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Write all of the given data to the server.
+static int32_t writeAll(const uHttpClientPrivate_t *pPriv,
+                        const char *pData, size_t size)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_SUCCESS;
+
+    while ((size > 0) && (errorCodeOrSize >= 0)) {
+        errorCodeOrSize = uSockWrite(pPriv->sock, pData, size);
+        if (errorCodeOrSize > 0) {
+            pData += errorCodeOrSize;
+            size -= errorCodeOrSize;
+        } else if (errorCodeOrSize == 0) {
+            errorCodeOrSize = (int32_t) U_ERROR_COMMON_TIMEOUT;
+        }
+    }
+
+    return (errorCodeOrSize < 0) ? errorCodeOrSize : (int32_t) U_ERROR_COMMON_SUCCESS;
+}
+
+// Make sure that there is at least one received byte in the buffer.
+static int32_t fill(uHttpClientPrivate_t *pPriv)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_SUCCESS;
+
+    while ((pPriv->bufferIndex >= pPriv->bufferLength) &&
+           (errorCodeOrSize == 0)) {
+        pPriv->bufferIndex = 0;
+        pPriv->bufferLength = 0;
+        // This blocks for the receive timeout of the socket
+        errorCodeOrSize = uSockRead(pPriv->sock, pPriv->buffer,
+                                    sizeof(pPriv->buffer));
+        if (errorCodeOrSize > 0) {
+            pPriv->bufferLength = errorCodeOrSize;
+            pPriv->receivedBytes += errorCodeOrSize;
+            pPriv->stopTimeMs = uPortGetTickTimeMs() + (pPriv->timeoutSeconds * 1000);
+            errorCodeOrSize = (int32_t) U_ERROR_COMMON_SUCCESS;
+        } else if ((errorCodeOrSize == 0) ||
+                   ((errno == U_SOCK_EWOULDBLOCK) || (errno == U_SOCK_EAGAIN))) {
+            // Nothing yet: keep going until the time is up
+            errorCodeOrSize = (int32_t) U_ERROR_COMMON_SUCCESS;
+            if (uPortGetTickTimeMs() - pPriv->stopTimeMs > 0) {
+                errorCodeOrSize = (int32_t) U_ERROR_COMMON_TIMEOUT;
+            }
+        }
+    }
+
+    return errorCodeOrSize;
+}
+
+// Read a line, terminated with LF, from the server, dropping the
+// line ending; if the line is longer than size - 1 the remainder is
+// discarded.  Returns the length of the null-terminated line at
+// pLine, else negative error code.
+static int32_t readLine(uHttpClientPrivate_t *pPriv, char *pLine, size_t size)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_SUCCESS;
+    size_t length = 0;
+    bool done = false;
+    char c;
+
+    while (!done && (errorCodeOrLength == 0)) {
+        errorCodeOrLength = fill(pPriv);
+        if (errorCodeOrLength == 0) {
+            c = pPriv->buffer[pPriv->bufferIndex];
+            pPriv->bufferIndex++;
+            if (c == '\n') {
+                done = true;
+            } else if ((c != '\r') && (length + 1 < size)) {
+                *(pLine + length) = c;
+                length++;
+            }
+        }
+    }
+
+    if (errorCodeOrLength == 0) {
+        *(pLine + length) = 0;
+        errorCodeOrLength = (int32_t) length;
+    }
+
+    return errorCodeOrLength;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: REQUEST AND RESPONSE
+ * -------------------------------------------------------------- */
+
+// Send a request header.
+static int32_t sendHeader(uHttpClientPrivate_t *pPriv,
+                          uHttpClientRequestType_t type,
+                          const char *pPath, const char *pContentType,
+                          int32_t contentLength, bool hasBody)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    size_t size = sizeof(pPriv->buffer);
+    int32_t x;
+    size_t y;
+
+    x = snprintf(pPriv->buffer, size, "%s %s HTTP/1.1\r\nHost: %s\r\n"
+                 "Connection: %s\r\n", gpRequestTypeStr[type], pPath,
+                 pPriv->pHostHeader, pPriv->keepAlive ? "keep-alive" : "close");
+    if ((x > 0) && ((size_t) x < size)) {
+        y = x;
+        if (hasBody) {
+            if (pContentType != NULL) {
+                x = snprintf(pPriv->buffer + y, size - y,
+                             "Content-Type: %s\r\n", pContentType);
+                y = ((x > 0) && ((size_t) x < size - y)) ? y + x : size;
+            }
+            if (y < size) {
+                if (contentLength >= 0) {
+                    x = snprintf(pPriv->buffer + y, size - y,
+                                 "Content-Length: %d\r\n", (int) contentLength);
+                } else {
+                    x = snprintf(pPriv->buffer + y, size - y,
+                                 "Transfer-Encoding: chunked\r\n");
+                }
+                y = ((x > 0) && ((size_t) x < size - y)) ? y + x : size;
+            }
+        } else if ((type == U_HTTP_CLIENT_REQUEST_POST) ||
+                   (type == U_HTTP_CLIENT_REQUEST_PUT)) {
+            x = snprintf(pPriv->buffer + y, size - y, "Content-Length: 0\r\n");
+            y = ((x > 0) && ((size_t) x < size - y)) ? y + x : size;
+        }
+        if (y + 2 <= size) {
+            *(pPriv->buffer + y) = '\r';
+            *(pPriv->buffer + y + 1) = '\n';
+            y += 2;
+            errorCode = writeAll(pPriv, pPriv->buffer, y);
+        }
+    }
+
+    return errorCode;
+}
+
+// Send a request body, produced by the given callback.
+static int32_t sendBody(uHttpClientPrivate_t *pPriv, int32_t contentLength,
+                        uHttpClientBodyProducer_t *pProducer,
+                        void *pProducerParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t total = 0;
+    int32_t x = 1;
+    size_t size;
+    char *pData = pPriv->buffer;
+
+    size = sizeof(pPriv->buffer);
+    if (contentLength < 0) {
+        // Leave room for the chunk size line and trailer
+        pData += U_HTTP_CLIENT_CHUNK_HEADER_LENGTH_BYTES;
+        size -= U_HTTP_CLIENT_CHUNK_HEADER_LENGTH_BYTES +
+                U_HTTP_CLIENT_CHUNK_TRAILER_LENGTH_BYTES;
+        if (size > 0xFFFF) {
+            size = 0xFFFF;
+        }
+    }
+
+    while ((x > 0) && (errorCode == 0)) {
+        if ((contentLength >= 0) && ((size_t) (contentLength - total) < size)) {
+            size = contentLength - total;
+        }
+        x = 0;
+        if (size > 0) {
+            x = pProducer(pData, size, pProducerParam);
+        }
+        if (x < 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        } else if ((size_t) x > size) {
+            errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        } else if (x > 0) {
+            total += x;
+            if (contentLength < 0) {
+                // Wrap the data up as a chunk and send it in one go
+                snprintf(pPriv->buffer, U_HTTP_CLIENT_CHUNK_HEADER_LENGTH_BYTES + 1,
+                         "%04x\r", (unsigned int) x);
+                *(pPriv->buffer + U_HTTP_CLIENT_CHUNK_HEADER_LENGTH_BYTES - 1) = '\n';
+                *(pData + x) = '\r';
+                *(pData + x + 1) = '\n';
+                errorCode = writeAll(pPriv, pPriv->buffer,
+                                     x + U_HTTP_CLIENT_CHUNK_HEADER_LENGTH_BYTES +
+                                     U_HTTP_CLIENT_CHUNK_TRAILER_LENGTH_BYTES);
+            } else {
+                errorCode = writeAll(pPriv, pData, x);
+            }
+        }
+    }
+
+    if (errorCode == 0) {
+        if (contentLength < 0) {
+            // Send the last chunk
+            errorCode = writeAll(pPriv, "0\r\n\r\n", 5);
+        } else if (total != contentLength) {
+            // Didn't get what we were promised
+            errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        }
+    }
+
+    return errorCode;
+}
+
+// Receive the status line and headers of a response, skipping
+// any interim (1xx) responses.
+static int32_t receiveHeader(uHttpClientPrivate_t *pPriv,
+                             uHttpClientResponse_t *pResponse)
+{
+    int32_t errorCodeOrLength;
+    char line[U_HTTP_CLIENT_BUFFER_LENGTH_BYTES / 4];
+    const char *pTmp;
+    bool done;
+
+    do {
+        pResponse->statusCode = -1;
+        pResponse->contentLength = -1;
+        pResponse->chunked = false;
+        pResponse->close = false;
+        // The status line, e.g. "HTTP/1.1 200 OK"
+        errorCodeOrLength = readLine(pPriv, line, sizeof(line));
+        if (errorCodeOrLength >= 0) {
+            errorCodeOrLength = (int32_t) U_ERROR_COMMON_UNKNOWN;
+            pTmp = strchr(line, ' ');
+            if (startsWithNoCase(line, sizeof(line), "HTTP/") && (pTmp != NULL)) {
+                pResponse->statusCode = strtol(pTmp + 1, NULL, 10);
+                // HTTP/1.0 closes the connection unless told otherwise
+                pResponse->close = startsWithNoCase(line, sizeof(line), "HTTP/1.0");
+                errorCodeOrLength = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+        // The headers, up to an empty line
+        done = false;
+        while ((errorCodeOrLength >= 0) && !done) {
+            errorCodeOrLength = readLine(pPriv, line, sizeof(line));
+            if (errorCodeOrLength == 0) {
+                done = true;
+            } else if (errorCodeOrLength > 0) {
+                if (startsWithNoCase(line, errorCodeOrLength, "Content-Length:")) {
+                    pResponse->contentLength = strtol(line + 15, NULL, 10);
+                } else if (startsWithNoCase(line, errorCodeOrLength, "Transfer-Encoding:")) {
+                    pResponse->chunked = containsNoCase(line, errorCodeOrLength, "chunked");
+                } else if (startsWithNoCase(line, errorCodeOrLength, "Connection:")) {
+                    if (containsNoCase(line, errorCodeOrLength, "close")) {
+                        pResponse->close = true;
+                    } else if (containsNoCase(line, errorCodeOrLength, "keep-alive")) {
+                        pResponse->close = false;
+                    }
+                }
+            }
+        }
+    } while ((errorCodeOrLength == 0) && (pResponse->statusCode >= 100) &&
+             (pResponse->statusCode < 200));
+
+    if ((errorCodeOrLength == 0) && (pResponse->statusCode < 0)) {
+        errorCodeOrLength = (int32_t) U_ERROR_COMMON_UNKNOWN;
+    }
+
+    return errorCodeOrLength;
+}
+
+// Hand up to size bytes of received body data to the consumer, or just
+// dump them if there is no consumer.  If size is negative, everything
+// up to the closure of the connection is delivered.
+static int32_t receiveBodyData(uHttpClientPrivate_t *pPriv,
+                               int32_t statusCode, int32_t size,
+                               uHttpClientBodyConsumer_t *pConsumer,
+                               void *pConsumerParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    size_t x;
+
+    while (((size > 0) || (size < 0)) && (errorCode == 0)) {
+        errorCode = fill(pPriv);
+        if (errorCode == 0) {
+            x = pPriv->bufferLength - pPriv->bufferIndex;
+            if ((size > 0) && (x > (size_t) size)) {
+                x = size;
+            }
+            if ((pConsumer != NULL) &&
+                !pConsumer(statusCode, pPriv->buffer + pPriv->bufferIndex,
+                           x, pConsumerParam)) {
+                errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+            }
+            pPriv->bufferIndex += x;
+            if (size > 0) {
+                size -= x;
+            }
+        } else if (size < 0) {
+            // The body ends with the connection
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            size = 0;
+        }
+    }
+
+    return errorCode;
+}
+
+// Receive a response body.
+static int32_t receiveBody(uHttpClientPrivate_t *pPriv,
+                           const uHttpClientResponse_t *pResponse,
+                           uHttpClientBodyConsumer_t *pConsumer,
+                           void *pConsumerParam)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_SUCCESS;
+    char line[32];
+    int32_t chunkLength = 1;
+
+    if (pResponse->chunked) {
+        while ((chunkLength > 0) && (errorCodeOrLength >= 0)) {
+            // The chunk size line, which may carry extensions
+            errorCodeOrLength = readLine(pPriv, line, sizeof(line));
+            if (errorCodeOrLength > 0) {
+                chunkLength = strtol(line, NULL, 16);
+                if (chunkLength > 0) {
+                    errorCodeOrLength = receiveBodyData(pPriv, pResponse->statusCode,
+                                                        chunkLength, pConsumer,
+                                                        pConsumerParam);
+                    if (errorCodeOrLength == 0) {
+                        // The CR/LF at the end of the chunk
+                        errorCodeOrLength = readLine(pPriv, line, sizeof(line));
+                    }
+                }
+            } else if (errorCodeOrLength == 0) {
+                errorCodeOrLength = (int32_t) U_ERROR_COMMON_UNKNOWN;
+            }
+        }
+        // Any trailers, up to an empty line
+        while (errorCodeOrLength > 0) {
+            errorCodeOrLength = readLine(pPriv, line, sizeof(line));
+        }
+    } else if (pResponse->contentLength > 0) {
+        errorCodeOrLength = receiveBodyData(pPriv, pResponse->statusCode,
+                                            pResponse->contentLength,
+                                            pConsumer, pConsumerParam);
+    } else if (pResponse->contentLength < 0) {
+        errorCodeOrLength = receiveBodyData(pPriv, pResponse->statusCode,
+                                            -1, pConsumer, pConsumerParam);
+    }
+
+    return errorCodeOrLength;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Open an HTTP client session.
+uHttpClientContext_t *pUHttpClientOpen(uDeviceHandle_t devHandle,
+                                       const uHttpClientConnection_t *pConnection,
+                                       const uSecurityTlsSettings_t *pSecurityTlsSettings)
+{
+    uHttpClientContext_t *pContext = NULL;
+    uHttpClientPrivate_t *pPriv;
+    size_t length;
+    int32_t port;
+
+    gLastOpenError = U_ERROR_COMMON_INVALID_PARAMETER;
+    if ((pConnection != NULL) && (pConnection->pServerName != NULL) &&
+        (pConnection->timeoutSeconds > 0)) {
+        gLastOpenError = U_ERROR_COMMON_NO_MEMORY;
+        length = strlen(pConnection->pServerName) + 1;
+        pContext = (uHttpClientContext_t *) pUPortMalloc(sizeof(*pContext));
+        if (pContext != NULL) {
+            memset(pContext, 0, sizeof(*pContext));
+            // The two copies of the server name go after the private data
+            pPriv = (uHttpClientPrivate_t *) pUPortMalloc(sizeof(*pPriv) +
+                                                          (length * 2));
+            if ((pPriv != NULL) &&
+                (uPortMutexCreate((uPortMutexHandle_t *) & (pContext->mutexHandle)) == 0)) {
+                memset(pPriv, 0, sizeof(*pPriv));
+                pPriv->pHostHeader = ((char *) pPriv) + sizeof(*pPriv);
+                memcpy(pPriv->pHostHeader, pConnection->pServerName, length);
+                pPriv->pHost = pPriv->pHostHeader + length;
+                memcpy(pPriv->pHost, pConnection->pServerName, length);
+                port = uSockDomainGetPort(pPriv->pHost);
+                pPriv->pHost = pUSockDomainRemovePort(pPriv->pHost);
+                if (pSecurityTlsSettings != NULL) {
+                    pPriv->secure = true;
+                    pPriv->securityTlsSettings = *pSecurityTlsSettings;
+                }
+                if (port < 0) {
+                    port = pPriv->secure ? U_HTTP_CLIENT_PORT_SECURE : U_HTTP_CLIENT_PORT;
+                }
+                pPriv->port = (uint16_t) port;
+                pPriv->timeoutSeconds = pConnection->timeoutSeconds;
+                pPriv->keepAlive = pConnection->keepAlive;
+                pPriv->sock = -1;
+                pContext->devHandle = devHandle;
+                pContext->pPriv = pPriv;
+                gLastOpenError = U_ERROR_COMMON_SUCCESS;
+            } else {
+                uPortFree(pPriv);
+                uPortFree(pContext);
+                pContext = NULL;
+            }
+        }
+    }
+
+    return pContext;
+}
+
+// Get the last error from pUHttpClientOpen().
+int32_t uHttpClientOpenResetLastError()
+{
+    uErrorCode_t errorCode = gLastOpenError;
+    gLastOpenError = U_ERROR_COMMON_SUCCESS;
+    return (int32_t) errorCode;
+}
+
+// Close the given HTTP client session.
+void uHttpClientClose(uHttpClientContext_t *pContext)
+{
+    if (pContext != NULL) {
+        if (pContext->mutexHandle != NULL) {
+            U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pContext->mutexHandle);
+            connectionClose((uHttpClientPrivate_t *) pContext->pPriv);
+            uPortFree(pContext->pPriv);
+            pContext->pPriv = NULL;
+            U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pContext->mutexHandle);
+            uPortMutexDelete((uPortMutexHandle_t) pContext->mutexHandle);
+        }
+        uPortFree(pContext);
+    }
+}
+
+// Perform an HTTP request.
+int32_t uHttpClientRequest(uHttpClientContext_t *pContext,
+                           uHttpClientRequestType_t type,
+                           const char *pPath,
+                           const char *pContentType,
+                           int32_t contentLength,
+                           uHttpClientBodyProducer_t *pProducer,
+                           void *pProducerParam,
+                           uHttpClientBodyConsumer_t *pConsumer,
+                           void *pConsumerParam)
+{
+    int32_t errorCodeOrStatus = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uHttpClientPrivate_t *pPriv;
+    uHttpClientResponse_t response = {0};
+    bool reused;
+    bool tryAgain = true;
+
+    if ((pContext != NULL) && (pPath != NULL) &&
+        ((int32_t) type >= 0) && (type < U_HTTP_CLIENT_REQUEST_MAX_NUM)) {
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pContext->mutexHandle);
+
+        pPriv = (uHttpClientPrivate_t *) pContext->pPriv;
+        while (tryAgain) {
+            tryAgain = false;
+            errorCodeOrStatus = (int32_t) U_ERROR_COMMON_SUCCESS;
+            reused = (pPriv->sock >= 0);
+            if (!reused) {
+                errorCodeOrStatus = connectionOpen(pContext->devHandle, pPriv);
+            }
+            if (errorCodeOrStatus == 0) {
+                // Anything left over from a previous response is junk
+                pPriv->bufferLength = 0;
+                pPriv->bufferIndex = 0;
+                pPriv->receivedBytes = 0;
+                errorCodeOrStatus = sendHeader(pPriv, type, pPath, pContentType,
+                                               contentLength, pProducer != NULL);
+                if ((errorCodeOrStatus == 0) && (pProducer != NULL)) {
+                    errorCodeOrStatus = sendBody(pPriv, contentLength,
+                                                 pProducer, pProducerParam);
+                }
+                if (errorCodeOrStatus == 0) {
+                    pPriv->stopTimeMs = uPortGetTickTimeMs() + (pPriv->timeoutSeconds * 1000);
+                    errorCodeOrStatus = receiveHeader(pPriv, &response);
+                    if ((errorCodeOrStatus == 0) &&
+                        (type != U_HTTP_CLIENT_REQUEST_HEAD) &&
+                        (response.statusCode != 204) && (response.statusCode != 304)) {
+                        errorCodeOrStatus = receiveBody(pPriv, &response,
+                                                        pConsumer, pConsumerParam);
+                        if ((errorCodeOrStatus == 0) && !response.chunked &&
+                            (response.contentLength < 0)) {
+                            // The body was ended by the server closing
+                            // the connection
+                            response.close = true;
+                        }
+                    }
+                }
+                if (errorCodeOrStatus == 0) {
+                    errorCodeOrStatus = response.statusCode;
+                    if (response.close || !pPriv->keepAlive) {
+                        connectionClose(pPriv);
+                    }
+                } else {
+                    // The state of the connection is unknown: drop it and,
+                    // if it was a kept connection that the server closed
+                    // while it was idle, and there is no body that can't
+                    // be produced again, have another go
+                    tryAgain = reused && (pPriv->receivedBytes == 0) && (pProducer == NULL);
+                    connectionClose(pPriv);
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pContext->mutexHandle);
+    }
+
+    return errorCodeOrStatus;
+}
+
+// Determine whether a connection to the server is currently open.
+bool uHttpClientIsConnected(const uHttpClientContext_t *pContext)
+{
+    bool isConnected = false;
+
+    if (pContext != NULL) {
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pContext->mutexHandle);
+        isConnected = (((uHttpClientPrivate_t *) pContext->pPriv)->sock >= 0);
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pContext->mutexHandle);
+    }
+
+    return isConnected;
+}
+
+// End of file
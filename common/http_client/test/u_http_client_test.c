@@ -0,0 +1,342 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Test for the u-blox HTTP client API: these should pass on
+ * all platforms that include the appropriate communications hardware,
+ * and will be run for all bearers for which the network API tests have
+ * configuration information and which support sockets.  The test
+ * server must support PUT, GET and DELETE of a file.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdio.h"     // snprintf()
+#include "string.h"    // memcmp()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port_clib_platform_specific.h" /* Integer stdio, must be included
+                                              before the other port files if
+                                              any print or scan function is used. */
+#include "u_port.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+
+#include "u_network.h"
+#include "u_network_test_shared_cfg.h"
+
+#include "u_sock.h"         // For uSockCleanUp()
+
+#include "u_security_tls.h"
+#include "u_security.h"     // For uSecurityGetSerialNumber()
+
+#include "u_http_client.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_HTTP_CLIENT_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_HTTP_CLIENT_TEST_SERVER_NAME
+/** Server to use for HTTP client testing.
+ */
+# define U_HTTP_CLIENT_TEST_SERVER_NAME "ubxlib.redirectme.net:8080"
+#endif
+
+#ifndef U_HTTP_CLIENT_TEST_DATA_LENGTH_BYTES
+/** The amount of data to PUT and GET back; deliberately more
+ * than #U_HTTP_CLIENT_BUFFER_LENGTH_BYTES.
+ */
+# define U_HTTP_CLIENT_TEST_DATA_LENGTH_BYTES ((U_HTTP_CLIENT_BUFFER_LENGTH_BYTES * 3) + 7)
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Track progress through the test data in a producer or
+ * consumer callback.
+ */
+typedef struct {
+    size_t index;
+    size_t numCalls;
+    bool isGood;
+} uHttpClientTestProgress_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The HTTP client context.
+ */
+static uHttpClientContext_t *gpHttpContext = NULL;
+
+/** A place to put the serial number of the module, used to
+ * stop parallel tests colliding at the server.
+ */
+static char gSerialNumber[U_SECURITY_SERIAL_NUMBER_MAX_LENGTH_BYTES];
+
+/** A place to put the path of the test file.
+ */
+static char gPath[U_SECURITY_SERIAL_NUMBER_MAX_LENGTH_BYTES + 32];
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// The test data: a repeating pattern.
+static char testData(size_t index)
+{
+    return (char) ('a' + (index % 26));
+}
+
+// Request body producer: produces the test data in
+// dribs and drabs.
+static int32_t producer(char *pBuffer, size_t size, void *pParam)
+{
+    uHttpClientTestProgress_t *pProgress = (uHttpClientTestProgress_t *) pParam;
+    size_t x = U_HTTP_CLIENT_TEST_DATA_LENGTH_BYTES - pProgress->index;
+
+    // Odd sizes to check the joins
+    if (x > 100) {
+        x = 100;
+    }
+    if (x > size) {
+        x = size;
+    }
+    for (size_t y = 0; y < x; y++) {
+        *pBuffer = testData(pProgress->index);
+        pBuffer++;
+        pProgress->index++;
+    }
+    pProgress->numCalls++;
+
+    return (int32_t) x;
+}
+
+// Response body consumer: checks the test data.
+static bool consumer(int32_t statusCode, const char *pData, size_t size,
+                     void *pParam)
+{
+    uHttpClientTestProgress_t *pProgress = (uHttpClientTestProgress_t *) pParam;
+
+    (void) statusCode;
+
+    for (size_t x = 0; x < size; x++) {
+        if ((pProgress->index >= U_HTTP_CLIENT_TEST_DATA_LENGTH_BYTES) ||
+            (*pData != testData(pProgress->index))) {
+            pProgress->isGood = false;
+        }
+        pData++;
+        pProgress->index++;
+    }
+    pProgress->numCalls++;
+
+    return true;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TESTS
+ * -------------------------------------------------------------- */
+
+/** Basic HTTP client test: PUT a file with a chunked body from a
+ * producer, GET it back twice through a consumer over the kept
+ * connection, then DELETE it.
+ */
+U_PORT_TEST_FUNCTION("[httpClient]", "httpClientBasic")
+{
+    uNetworkTestList_t *pList;
+    uDeviceHandle_t devHandle;
+    uHttpClientConnection_t connection = U_HTTP_CLIENT_CONNECTION_DEFAULT;
+    uHttpClientTestProgress_t progress;
+    int32_t x;
+
+    // In case a previous test failed
+    uNetworkTestCleanUp();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uDeviceInit() == 0);
+
+    // Add and bring up the devices that support sockets
+    pList = pUNetworkTestListAlloc(uNetworkTestHasSock);
+    if (pList == NULL) {
+        U_TEST_PRINT_LINE("*** WARNING *** nothing to do.");
+    }
+    for (uNetworkTestList_t *pTmp = pList; pTmp != NULL; pTmp = pTmp->pNext) {
+        if (*pTmp->pDevHandle == NULL) {
+            U_TEST_PRINT_LINE("adding device %s for network %s...",
+                              gpUNetworkTestDeviceTypeName[pTmp->pDeviceCfg->deviceType],
+                              gpUNetworkTestTypeName[pTmp->networkType]);
+            U_PORT_TEST_ASSERT(uDeviceOpen(pTmp->pDeviceCfg, pTmp->pDevHandle) == 0);
+        }
+    }
+
+    // Repeat for all bearers
+    for (uNetworkTestList_t *pTmp = pList; pTmp != NULL; pTmp = pTmp->pNext) {
+        devHandle = *pTmp->pDevHandle;
+        U_TEST_PRINT_LINE("bringing up %s...",
+                          gpUNetworkTestTypeName[pTmp->networkType]);
+        U_PORT_TEST_ASSERT(uNetworkInterfaceUp(devHandle,
+                                               pTmp->networkType,
+                                               pTmp->pNetworkCfg) == 0);
+
+        // Make a unique path to stop different boards colliding
+        U_PORT_TEST_ASSERT(uSecurityGetSerialNumber(devHandle,
+                                                    gSerialNumber) > 0);
+        snprintf(gPath, sizeof(gPath), "/ubxlib_test_%s.bin", gSerialNumber);
+
+        U_TEST_PRINT_LINE("opening HTTP client to %s...",
+                          U_HTTP_CLIENT_TEST_SERVER_NAME);
+        connection.pServerName = U_HTTP_CLIENT_TEST_SERVER_NAME;
+        gpHttpContext = pUHttpClientOpen(devHandle, &connection, NULL);
+        x = uHttpClientOpenResetLastError();
+        U_TEST_PRINT_LINE("opening HTTP client returned %d.", x);
+        U_PORT_TEST_ASSERT(x == 0);
+        U_PORT_TEST_ASSERT(gpHttpContext != NULL);
+        U_PORT_TEST_ASSERT(!uHttpClientIsConnected(gpHttpContext));
+
+        // PUT the test data, chunked
+        memset(&progress, 0, sizeof(progress));
+        U_TEST_PRINT_LINE("PUT %d byte(s) to %s...",
+                          U_HTTP_CLIENT_TEST_DATA_LENGTH_BYTES, gPath);
+        x = uHttpClientRequest(gpHttpContext, U_HTTP_CLIENT_REQUEST_PUT, gPath,
+                               "application/octet-stream", -1,
+                               producer, &progress, NULL, NULL);
+        U_TEST_PRINT_LINE("PUT returned %d.", x);
+        U_PORT_TEST_ASSERT((x >= 200) && (x < 300));
+        U_PORT_TEST_ASSERT(progress.index == U_HTTP_CLIENT_TEST_DATA_LENGTH_BYTES);
+
+        // GET it back twice, the second time over the
+        // same connection if the server has kept it open
+        for (size_t y = 0; y < 2; y++) {
+            if (y > 0) {
+                U_TEST_PRINT_LINE("connection is %s.",
+                                  uHttpClientIsConnected(gpHttpContext) ? "kept" : "closed");
+            }
+            memset(&progress, 0, sizeof(progress));
+            progress.isGood = true;
+            U_TEST_PRINT_LINE("GET %s...", gPath);
+            x = uHttpClientRequest(gpHttpContext, U_HTTP_CLIENT_REQUEST_GET, gPath,
+                                   NULL, -1, NULL, NULL, consumer, &progress);
+            U_TEST_PRINT_LINE("GET returned %d, %d byte(s) in %d call(s).",
+                              x, progress.index, progress.numCalls);
+            U_PORT_TEST_ASSERT(x == 200);
+            U_PORT_TEST_ASSERT(progress.isGood);
+            U_PORT_TEST_ASSERT(progress.index == U_HTTP_CLIENT_TEST_DATA_LENGTH_BYTES);
+        }
+
+        // Tidy up at the server
+        U_TEST_PRINT_LINE("DELETE %s...", gPath);
+        x = uHttpClientRequest(gpHttpContext, U_HTTP_CLIENT_REQUEST_DELETE, gPath,
+                               NULL, -1, NULL, NULL, NULL, NULL);
+        U_TEST_PRINT_LINE("DELETE returned %d.", x);
+        U_PORT_TEST_ASSERT((x >= 200) && (x < 300));
+
+        // Check that the file has gone
+        x = uHttpClientRequest(gpHttpContext, U_HTTP_CLIENT_REQUEST_GET, gPath,
+                               NULL, -1, NULL, NULL, NULL, NULL);
+        U_TEST_PRINT_LINE("GET after DELETE returned %d.", x);
+        U_PORT_TEST_ASSERT(x == 404);
+
+        U_TEST_PRINT_LINE("closing HTTP client...");
+        uHttpClientClose(gpHttpContext);
+        gpHttpContext = NULL;
+        uSockCleanUp();
+
+        U_TEST_PRINT_LINE("taking down %s...",
+                          gpUNetworkTestTypeName[pTmp->networkType]);
+        U_PORT_TEST_ASSERT(uNetworkInterfaceDown(devHandle,
+                                                 pTmp->networkType) == 0);
+    }
+
+    // Close the devices once more and free the list
+    for (uNetworkTestList_t *pTmp = pList; pTmp != NULL; pTmp = pTmp->pNext) {
+        if (*pTmp->pDevHandle != NULL) {
+            U_TEST_PRINT_LINE("closing device %s...",
+                              gpUNetworkTestDeviceTypeName[pTmp->pDeviceCfg->deviceType]);
+            U_PORT_TEST_ASSERT(uDeviceClose(*pTmp->pDevHandle, false) == 0);
+            *pTmp->pDevHandle = NULL;
+        }
+    }
+    uNetworkTestListFree();
+
+    uDeviceDeinit();
+    uPortDeinit();
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[httpClient]", "httpClientCleanUp")
+{
+    int32_t x;
+
+    if (gpHttpContext != NULL) {
+        uHttpClientClose(gpHttpContext);
+        gpHttpContext = NULL;
+    }
+
+    // The network test configuration is shared between
+    // the network, sockets, security and location tests
+    // so must reset the handles here in case the
+    // tests of one of the other APIs are coming next.
+    uNetworkTestCleanUp();
+    uDeviceDeinit();
+
+    x = uPortTaskStackMinFree(NULL);
+    if (x != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        U_TEST_PRINT_LINE("main task stack had a minimum of %d"
+                          " byte(s) free at the end of these tests.", x);
+        U_PORT_TEST_ASSERT(x >= U_CFG_TEST_OS_MAIN_TASK_MIN_FREE_STACK_BYTES);
+    }
+
+    uPortDeinit();
+
+    x = uPortGetHeapMinFree();
+    if (x >= 0) {
+        U_TEST_PRINT_LINE("heap had a minimum of %d byte(s) free"
+                          " at the end of these tests.", x);
+        U_PORT_TEST_ASSERT(x >= U_CFG_TEST_HEAP_MIN_FREE_BYTES);
+    }
+}
+
+// End of file
@@ -33,6 +33,15 @@ extern "C" {
 #include "stdarg.h"
 #include "u_error_common.h"
 
+#ifndef U_LIB_SYM_INDEX_SLOTS
+/** Number of slots in the hashed symbol index that uLibOpen() builds
+ * in the library handle, must be a power of two; if a library has
+ * more functions than fit, uLibSym() falls back to a linear search
+ * for those which were left out.
+ */
+# define U_LIB_SYM_INDEX_SLOTS 32
+#endif
+
 /** Utility macro for getting the library context from library handle */
 #define U_LIB_CTX(libHdl) ((libHdl)->ictx)
 
@@ -137,6 +146,13 @@ typedef struct {
     void *ictx;
     /** Last error */
     int error;
+    /** Hashed symbol index, built by uLibOpen(): for each slot the
+     * function descriptor index plus one, zero if the slot is empty */
+    uint16_t symIndex[U_LIB_SYM_INDEX_SLOTS];
+    /** Upper 16 bits of the hash of the name in each slot */
+    uint16_t symHash[U_LIB_SYM_INDEX_SLOTS];
+    /** Non-zero if not every function is in the symbol index */
+    int symIndexIncomplete;
 } uLibHdl_t;
 
 /**
@@ -202,7 +218,9 @@ int uLibClose(uLibHdl_t *pHdl);
 
 /**
  * Returns call address for given symbol or NULL on error. If NULL is returned,
- * see function uLibError.
+ * see function uLibError. The lookup uses the hashed symbol index built
+ * by uLibOpen(), so it costs one hash of sym and, usually, a single
+ * string compare; the address returned follows any uLibRelocate().
  * @param pHdl Pointer to library handle struct.
  * @param sym Function symbol name to find.
  * @return Address to function, or NULL on error
@@ -27,10 +27,92 @@
 #include "u_error_common.h"
 #include "string.h"
 
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The flags of a function that may be looked up with uLibSym(). */
+#define U_LIB_SYM_FLAGS_MASK (U_LIB_I_FDESC_FLAG_INIT | U_LIB_I_FDESC_FLAG_FINI | \
+                              U_LIB_I_FDESC_FLAG_FUNCTION)
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// 32-bit FNV-1a hash of a null-terminated string; the lower bits
+// select the index slot, the upper 16 bits are kept to filter out
+// mismatches without a strcmp().
+static uint32_t symHash(const char *sym)
+{
+    uint32_t hash = 2166136261UL;
+    while (*sym != 0) {
+        hash ^= (uint8_t) *sym;
+        hash *= 16777619UL;
+        sym++;
+    }
+    return hash;
+}
+
+// Empty the symbol index, leaving uLibSym() to search linearly.
+static void symIndexClear(uLibHdl_t *pHdl)
+{
+    memset(pHdl->symIndex, 0, sizeof(pHdl->symIndex));
+    memset(pHdl->symHash, 0, sizeof(pHdl->symHash));
+    pHdl->symIndexIncomplete = 1;
+}
+
+// Build the symbol index: open addressing with linear probing;
+// symbol offsets are relative to the code so the index remains
+// valid across uLibRelocate().
+static void symIndexBuild(uLibHdl_t *pHdl)
+{
+    uLibDescriptor_t *pDescr = (uLibDescriptor_t *)pHdl->puLibDescr;
+    uint32_t used = 0;
+    uint32_t hash;
+    uint32_t slot;
+
+    symIndexClear(pHdl);
+    pHdl->symIndexIncomplete = 0;
+    for (uint32_t i = 0; i < pDescr->hdr.count; i++) {
+        if ((pDescr->funcs[i].flags & U_LIB_SYM_FLAGS_MASK) == U_LIB_I_FDESC_FLAG_FUNCTION) {
+            // Keep one slot free so that a failed probe always ends
+            if ((used < U_LIB_SYM_INDEX_SLOTS - 1) && (i < UINT16_MAX)) {
+                hash = symHash(pDescr->funcs[i].name);
+                slot = hash & (U_LIB_SYM_INDEX_SLOTS - 1);
+                while (pHdl->symIndex[slot] != 0) {
+                    slot = (slot + 1) & (U_LIB_SYM_INDEX_SLOTS - 1);
+                }
+                pHdl->symIndex[slot] = (uint16_t) (i + 1);
+                pHdl->symHash[slot] = (uint16_t) (hash >> 16);
+                used++;
+            } else {
+                pHdl->symIndexIncomplete = 1;
+            }
+        }
+    }
+}
+
+// Find a symbol in the index, returning its function descriptor
+// index or -1 if it is not there.
+static int32_t symIndexFind(uLibHdl_t *pHdl, const char *sym)
+{
+    uLibDescriptor_t *pDescr = (uLibDescriptor_t *)pHdl->puLibDescr;
+    uint32_t hash = symHash(sym);
+    uint32_t slot = hash & (U_LIB_SYM_INDEX_SLOTS - 1);
+    int32_t funcIx = -1;
+    uint32_t i;
+
+    while ((funcIx < 0) && (pHdl->symIndex[slot] != 0)) {
+        i = pHdl->symIndex[slot] - 1;
+        if ((pHdl->symHash[slot] == (uint16_t) (hash >> 16)) &&
+            (strcmp(sym, pDescr->funcs[i].name) == 0)) {
+            funcIx = (int32_t) i;
+        }
+        slot = (slot + 1) & (U_LIB_SYM_INDEX_SLOTS - 1);
+    }
+    return funcIx;
+}
+
 static uint8_t *getCallAddress(uLibHdl_t *pHdl, uint32_t funcIx)
 {
     uLibDescriptor_t *pDescr = (uLibDescriptor_t *)pHdl->puLibDescr;
@@ -59,6 +141,7 @@ int uLibProbe(uLibHdl_t *pHdl, uLibHdr_t *pHdr, const void *puLib)
     if (pHdl != NULL) {
         pHdl->puLibDescr = puLib;
         pHdl->puLibCode = (void *)(&pDescr->funcs[pDescr->hdr.count]);
+        symIndexClear(pHdl);
     }
     return U_ERROR_COMMON_SUCCESS;
 }
@@ -83,6 +166,7 @@ int uLibOpen(uLibHdl_t *pHdl, const void *puLib,
     } else {
         pHdl->puLibCode = (void *)(&pDescr->funcs[pDescr->hdr.count]);
     }
+    symIndexBuild(pHdl);
     for (uint32_t i = 0; i < pDescr->hdr.count; i++) {
         if ((pDescr->funcs[i].flags & (U_LIB_I_FDESC_FLAG_INIT | U_LIB_I_FDESC_FLAG_FUNCTION))
             == (U_LIB_I_FDESC_FLAG_INIT | U_LIB_I_FDESC_FLAG_FUNCTION)) {
@@ -163,11 +247,19 @@ void *uLibSym(uLibHdl_t *pHdl, const char *sym)
         return 0;
     }
 
+    int32_t funcIx = symIndexFind(pHdl, sym);
+    if (funcIx >= 0) {
+        return (void *)getCallAddress(pHdl, (uint32_t) funcIx);
+    }
+    if (!pHdl->symIndexIncomplete) {
+        pHdl->error = U_ERROR_COMMON_NOT_FOUND;
+        return 0;
+    }
+
+    // Not everything is in the index, search the lot
     uLibDescriptor_t *pDescr = (uLibDescriptor_t *)pHdl->puLibDescr;
     for (uint32_t i = 0; i < pDescr->hdr.count; i++) {
-        if (((pDescr->funcs[i].flags & (U_LIB_I_FDESC_FLAG_INIT | U_LIB_I_FDESC_FLAG_FINI |
-                                        U_LIB_I_FDESC_FLAG_FUNCTION))
-             == U_LIB_I_FDESC_FLAG_FUNCTION) &&
+        if (((pDescr->funcs[i].flags & U_LIB_SYM_FLAGS_MASK) == U_LIB_I_FDESC_FLAG_FUNCTION) &&
             strcmp(sym, pDescr->funcs[i].name) == 0) {
             return (void *)getCallAddress(pHdl, i);
         }
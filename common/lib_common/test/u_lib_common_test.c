@@ -52,11 +52,13 @@
 #include "u_port_uart.h"
 
 #include "u_lib.h"
+#include "u_lib_internal.h" // U_LIB_I_OPEN_FUNC
 #include "u_lib_common_test.h"
 
 #include "string.h"
 
 #include "u_lib.h"
+#include "u_lib_internal.h" // U_LIB_I_OPEN_FUNC
 #include "lib_fibonacci.h"
 
 /* ----------------------------------------------------------------
@@ -156,6 +158,14 @@ static int32_t runLibTest(void)
     libFibTestHelloWorld = uLibSym(&libHdl, "libFibTestHelloWorld");
     U_PORT_TEST_ASSERT(libFibTestHelloWorld != NULL);
 
+    // the initialiser is not a symbol, neither is anything unknown
+    U_PORT_TEST_ASSERT(uLibSym(&libHdl, U_PORT_STRINGIFY_QUOTED(U_LIB_I_OPEN_FUNC)) == NULL);
+    U_PORT_TEST_ASSERT(uLibError(&libHdl) == U_ERROR_COMMON_NOT_FOUND);
+    U_PORT_TEST_ASSERT(uLibSym(&libHdl, "libFibTestCalcX") == NULL);
+    U_PORT_TEST_ASSERT(uLibError(&libHdl) == U_ERROR_COMMON_NOT_FOUND);
+    // a repeated lookup must give the same answer
+    U_PORT_TEST_ASSERT(uLibSym(&libHdl, "libFibTestCalc") == (void *) libFibTestCalc);
+
     uPortLogF("@libFibTestCalc:      %p\n", libFibTestCalc);
     uPortLogF("@libFibTestLastRes:   %p\n", libFibTestLastRes);
     uPortLogF("@libFibTestHelloWorld:%p\n\n", libFibTestHelloWorld);
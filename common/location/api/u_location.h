@@ -82,6 +82,33 @@ extern "C" {
 # define U_LOCATION_CLOUD_LOCATE_PSEUDORANGE_RMS_ERROR_INDEX_LIMIT 3
 #endif
 
+#ifndef U_LOCATION_CELL_LOCATE_RADIUS_MILLIMETRES
+/** The accuracy that Cell Locate can usually be expected to
+ * achieve from cellular information alone: when uLocationGetCached()
+ * is asked for a location no more accurate than this it will try
+ * Cell Locate, which is cheaper in power and time, before GNSS.
+ */
+# define U_LOCATION_CELL_LOCATE_RADIUS_MILLIMETRES 1000000
+#endif
+
+#ifndef U_LOCATION_CLOUD_LOCATE_RRLP_SVS_MAX
+/** The default maximum number of satellites to include in the RRLP
+ * information sent to Cloud Locate, see the rrlpSvsMax field of
+ * #uLocationAssist_t; -1 means that the RRLP information is sent
+ * as it is read from the GNSS chip.
+ */
+# define U_LOCATION_CLOUD_LOCATE_RRLP_SVS_MAX -1
+#endif
+
+#ifndef U_LOCATION_CLOUD_LOCATE_RRLP_ELEVATION_MIN_DEGREES
+/** The default minimum elevation of a satellite for its RRLP
+ * information to be sent to Cloud Locate, see the
+ * rrlpElevationMinDegrees field of #uLocationAssist_t; -1 for
+ * "don't care".
+ */
+# define U_LOCATION_CLOUD_LOCATE_RRLP_ELEVATION_MIN_DEGREES -1
+#endif
+
 #ifndef U_LOCATION_ASSIST_DEFAULTS
 /** Default values for #uLocationAssist_t.
  */
@@ -90,7 +117,9 @@ extern "C" {
                                      U_LOCATION_CLOUD_LOCATE_C_NO_THRESHOLD,                    \
                                      U_LOCATION_CLOUD_LOCATE_MULTIPATH_INDEX_LIMIT,             \
                                      U_LOCATION_CLOUD_LOCATE_PSEUDORANGE_RMS_ERROR_INDEX_LIMIT, \
-                                     NULL, NULL}
+                                     NULL, NULL,                                                \
+                                     U_LOCATION_CLOUD_LOCATE_RRLP_SVS_MAX,                      \
+                                     U_LOCATION_CLOUD_LOCATE_RRLP_ELEVATION_MIN_DEGREES}
 #endif
 
 /* ----------------------------------------------------------------
@@ -186,6 +215,29 @@ typedef struct {
                                    with the u-blox Cloud Locate service; the
                                    MQTT client MUST have been logged-in to the
                                    Cloud Locate service BEFORE calling this API. */
+    int32_t rrlpSvsMax;       /**< if greater than zero then, before the RRLP
+                                   information is sent to Cloud Locate, the
+                                   satellites that do not meet cNoThreshold,
+                                   multipathIndexLimit,
+                                   pseudorangeRmsErrorIndexLimit and
+                                   rrlpElevationMinDegrees are removed from it
+                                   and, of those left, only this many are kept,
+                                   those with the highest carrier to noise
+                                   ratio; this reduces the number of bytes sent
+                                   per fix (by 24 per satellite removed).  If
+                                   fewer than svsThreshold satellites would be
+                                   left, the RRLP information is sent unchanged.
+                                   A value of 8 to 12 is reasonable; use -1
+                                   (the default) or 0 to send the RRLP
+                                   information as it is read. */
+    int32_t rrlpElevationMinDegrees; /**< the minimum elevation of a satellite
+                                          for it to be kept when rrlpSvsMax
+                                          is greater than zero; getting the
+                                          elevations requires an extra
+                                          UBX-NAV-SAT poll of the GNSS chip,
+                                          though nothing more is sent over
+                                          the air.  Use -1 (the default) or
+                                          0 for "don't care". */
 } uLocationAssist_t;
 
 /** Definition of a location.
@@ -412,6 +464,94 @@ int32_t uLocationGetStatus(uDeviceHandle_t devHandle);
  */
 void uLocationGetStop(uDeviceHandle_t devHandle);
 
+/** Get a location that is no older than, and at least as accurate
+ * as, required, from the cache if possible, otherwise by performing
+ * a fix with the cheapest source that might meet the requirement.
+ * Every successful fix made through this API, by any source, is kept
+ * in the cache (one per #uLocationType_t) along with the time it was
+ * made, as are those given to uLocationCacheSet(), e.g. from a GNSS
+ * position stream.
+ *
+ * If there is no suitable fix in the cache then, for a cellular
+ * device, the sources are tried in this order, moving on if a
+ * source is not available or fails or its fix is not accurate
+ * enough:
+ * - Cell Locate, if pAuthenticationTokenStr is not NULL and
+ *   maxRadiusMillimetres is -1 or at least
+ *   #U_LOCATION_CELL_LOCATE_RADIUS_MILLIMETRES,
+ * - Cloud Locate, if a GNSS network is attached to the device and
+ *   pLocationAssist contains pMqttClientContext and pClientIdStr,
+ * - GNSS, using the GNSS network attached to the device if there
+ *   is one, else a GNSS chip inside or connected via the cellular
+ *   module.
+ *
+ * For a GNSS device only GNSS is used.  The parameters
+ * pLocationAssist, pAuthenticationTokenStr and pKeepGoingCallback
+ * are as for uLocationGet().
+ *
+ * @param devHandle               the device handle to use if a fix
+ *                                has to be made; may be NULL, in
+ *                                which case only the cache is used.
+ * @param maxAgeMs                the maximum age of a fix from the
+ *                                cache in milliseconds, -1 for any
+ *                                age, 0 to always perform a fix.
+ * @param maxRadiusMillimetres    the maximum radius of the location
+ *                                in millimetres, -1 for any radius.
+ * @param pLocationAssist         see uLocationGet(); may be NULL.
+ * @param pAuthenticationTokenStr see uLocationGet(); may be NULL.
+ * @param[out] pLocation          a place to put the location, the type
+ *                                field of which indicates the source;
+ *                                may be NULL.
+ * @param[in] pKeepGoingCallback  see uLocationGet(); may be NULL.
+ * @return                        zero on success,
+ *                                #U_ERROR_COMMON_NOT_FOUND if no suitable
+ *                                location could be obtained (in which
+ *                                case pLocation, if a fix was nevertheless
+ *                                made, is populated with the last fix),
+ *                                else negative error code.
+ */
+int32_t uLocationGetCached(uDeviceHandle_t devHandle,
+                           int32_t maxAgeMs, int32_t maxRadiusMillimetres,
+                           const uLocationAssist_t *pLocationAssist,
+                           const char *pAuthenticationTokenStr,
+                           uLocation_t *pLocation,
+                           bool (*pKeepGoingCallback) (uDeviceHandle_t));
+
+/** Get the most recent location fix in the cache that meets the
+ * given age and accuracy; this never performs a fix.
+ *
+ * @param maxAgeMs              the maximum age of the fix in
+ *                              milliseconds, -1 for any age.
+ * @param maxRadiusMillimetres  the maximum radius of the fix in
+ *                              millimetres, -1 for any radius.
+ * @param[out] pLocation        a place to put the location; may be
+ *                              NULL.
+ * @param[out] pAgeMs           a place to put the age of the fix in
+ *                              milliseconds; may be NULL.
+ * @return                      zero on success,
+ *                              #U_ERROR_COMMON_NOT_FOUND if there is
+ *                              no suitable fix, else negative error
+ *                              code.
+ */
+int32_t uLocationCacheGet(int32_t maxAgeMs, int32_t maxRadiusMillimetres,
+                          uLocation_t *pLocation, int32_t *pAgeMs);
+
+/** Put a location fix obtained by other means into the cache, e.g.
+ * each position delivered by uGnssPosGetStreamedStart(), so that
+ * uLocationGetCached() can use it; the fix replaces any in the
+ * cache of the same type and is taken to have been made now.
+ *
+ * @param[in] pLocation the location; the type field must be set
+ *                      (e.g. to #U_LOCATION_TYPE_GNSS); cannot be
+ *                      NULL.
+ * @return              zero on success else negative error code.
+ */
+int32_t uLocationCacheSet(const uLocation_t *pLocation);
+
+/** Empty the location cache.
+ */
+void uLocationCacheClear();
+
 #ifdef __cplusplus
 }
 #endif
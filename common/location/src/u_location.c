@@ -132,6 +132,9 @@ static void gnssPosCallback(uDeviceHandle_t devHandle,
                 // Time may be valid even if the error code is non-zero
                 location.timeUtc = timeUtc;
             }
+            if (errorCode == 0) {
+                uLocationSharedCacheStore(&location);
+            }
             pEntry->pCallback(devHandle, errorCode, &location);
         }
         uPortFree(pEntry);
@@ -169,6 +172,7 @@ static void cellLocCallback(uDeviceHandle_t devHandle,
                 location.speedMillimetresPerSecond = speedMillimetresPerSecond;
                 location.svs = svs;
                 location.timeUtc = timeUtc;
+                uLocationSharedCacheStore(&location);
                 pEntry->pCallback(devHandle, errorCode, &location);
             } else {
                 // No point in populating the location for
@@ -183,6 +187,37 @@ static void cellLocCallback(uDeviceHandle_t devHandle,
     }
 }
 
+// Perform a fix for uLocationGetCached(): returns zero if the
+// fix was made and is accurate enough, U_ERROR_COMMON_NOT_FOUND
+// if it was made but is not accurate enough (pLocation is still
+// populated) else negative error code.
+static int32_t fixTry(uDeviceHandle_t devHandle, uLocationType_t type,
+                      int32_t maxRadiusMillimetres,
+                      const uLocationAssist_t *pLocationAssist,
+                      const char *pAuthenticationTokenStr,
+                      uLocation_t *pLocation,
+                      bool (*pKeepGoingCallback) (uDeviceHandle_t))
+{
+    int32_t errorCode;
+    uLocation_t location;
+
+    errorCode = uLocationGet(devHandle, type, pLocationAssist,
+                             pAuthenticationTokenStr, &location,
+                             pKeepGoingCallback);
+    if (errorCode == 0) {
+        if ((maxRadiusMillimetres >= 0) &&
+            ((location.radiusMillimetres < 0) ||
+             (location.radiusMillimetres > maxRadiusMillimetres))) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        }
+        if (pLocation != NULL) {
+            *pLocation = location;
+        }
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -197,6 +232,7 @@ int32_t uLocationGet(uDeviceHandle_t devHandle, uLocationType_t type,
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uLocation_t location;
     uDeviceHandle_t gnssDeviceHandle;
+    bool locationValid = false;
 
     if (gULocationMutex != NULL) {
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
@@ -223,6 +259,7 @@ int32_t uLocationGet(uDeviceHandle_t devHandle, uLocationType_t type,
                                             &(location.svs),
                                             &(location.timeUtc),
                                             pKeepGoingCallback);
+                    locationValid = true;
                     if (pLocation != NULL) {
                         *pLocation = location;
                     }
@@ -240,8 +277,13 @@ int32_t uLocationGet(uDeviceHandle_t devHandle, uLocationType_t type,
                                                             pLocationAssist->cNoThreshold,
                                                             pLocationAssist->multipathIndexLimit,
                                                             pLocationAssist->pseudorangeRmsErrorIndexLimit,
+                                                            pLocationAssist->rrlpSvsMax,
+                                                            pLocationAssist->rrlpElevationMinDegrees,
                                                             pLocationAssist->pClientIdStr,
                                                             &location, pKeepGoingCallback);
+                    // The location is only returned if a client ID was given
+                    location.type = U_LOCATION_TYPE_CLOUD_CLOUD_LOCATE;
+                    locationValid = (pLocationAssist->pClientIdStr != NULL);
                     if (pLocation != NULL) {
                         *pLocation = location;
                     }
@@ -257,6 +299,7 @@ int32_t uLocationGet(uDeviceHandle_t devHandle, uLocationType_t type,
                                         &(location.svs),
                                         &(location.timeUtc),
                                         pKeepGoingCallback);
+                locationValid = true;
                 if (pLocation != NULL) {
                     pLocation->type = U_LOCATION_TYPE_GNSS;
                     *pLocation = location;
@@ -265,6 +308,7 @@ int32_t uLocationGet(uDeviceHandle_t devHandle, uLocationType_t type,
         } else if (devType == (int32_t) U_DEVICE_TYPE_GNSS) {
             // type, pLocationAssist and pAuthenticationTokenStr are
             // irrelevant in this case, we just ask GNSS
+            location.type = U_LOCATION_TYPE_GNSS;
             errorCode = uGnssPosGet(devHandle,
                                     &(location.latitudeX1e7),
                                     &(location.longitudeX1e7),
@@ -274,12 +318,17 @@ int32_t uLocationGet(uDeviceHandle_t devHandle, uLocationType_t type,
                                     &(location.svs),
                                     &(location.timeUtc),
                                     pKeepGoingCallback);
+            locationValid = true;
             if (pLocation != NULL) {
                 pLocation->type = U_LOCATION_TYPE_GNSS;
                 *pLocation = location;
             }
         }
 
+        if ((errorCode == 0) && locationValid) {
+            uLocationSharedCacheStore(&location);
+        }
+
         U_PORT_MUTEX_UNLOCK(gULocationMutex);
     }
 
@@ -392,4 +441,127 @@ void uLocationGetStop(uDeviceHandle_t devHandle)
     }
 }
 
+// Get a location from the cache or from the cheapest suitable source.
+int32_t uLocationGetCached(uDeviceHandle_t devHandle,
+                           int32_t maxAgeMs, int32_t maxRadiusMillimetres,
+                           const uLocationAssist_t *pLocationAssist,
+                           const char *pAuthenticationTokenStr,
+                           uLocation_t *pLocation,
+                           bool (*pKeepGoingCallback) (uDeviceHandle_t))
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uDeviceHandle_t gnssDevHandle;
+    int32_t devType;
+
+    if (gULocationMutex != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        if (maxAgeMs != 0) {
+            U_PORT_MUTEX_LOCK(gULocationMutex);
+            errorCode = uLocationSharedCacheFind(maxAgeMs, maxRadiusMillimetres,
+                                                 pLocation, NULL);
+            U_PORT_MUTEX_UNLOCK(gULocationMutex);
+        }
+        if ((errorCode != 0) && (devHandle != NULL)) {
+            // Nothing suitable in the cache: do a fix, cheapest
+            // source first; uLocationGet() locks the mutex itself
+            // and adds the fix to the cache
+            devType = uDeviceGetDeviceType(devHandle);
+            if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
+                gnssDevHandle = uNetworkGetDeviceHandle(devHandle, U_NETWORK_TYPE_GNSS);
+                if ((pAuthenticationTokenStr != NULL) &&
+                    ((maxRadiusMillimetres < 0) ||
+                     (maxRadiusMillimetres >= U_LOCATION_CELL_LOCATE_RADIUS_MILLIMETRES))) {
+                    errorCode = fixTry(devHandle, U_LOCATION_TYPE_CLOUD_CELL_LOCATE,
+                                       maxRadiusMillimetres, pLocationAssist,
+                                       pAuthenticationTokenStr, pLocation,
+                                       pKeepGoingCallback);
+                }
+                if ((errorCode != 0) && (gnssDevHandle != NULL) &&
+                    (pLocationAssist != NULL) &&
+                    (pLocationAssist->pMqttClientContext != NULL) &&
+                    (pLocationAssist->pClientIdStr != NULL)) {
+                    errorCode = fixTry(devHandle, U_LOCATION_TYPE_CLOUD_CLOUD_LOCATE,
+                                       maxRadiusMillimetres, pLocationAssist,
+                                       pAuthenticationTokenStr, pLocation,
+                                       pKeepGoingCallback);
+                }
+                if (errorCode != 0) {
+                    if (gnssDevHandle == NULL) {
+                        // Try a GNSS chip inside or connected via
+                        // the cellular module
+                        gnssDevHandle = devHandle;
+                    }
+                    errorCode = fixTry(gnssDevHandle, U_LOCATION_TYPE_GNSS,
+                                       maxRadiusMillimetres, pLocationAssist,
+                                       pAuthenticationTokenStr, pLocation,
+                                       pKeepGoingCallback);
+                }
+            } else if (devType == (int32_t) U_DEVICE_TYPE_GNSS) {
+                errorCode = fixTry(devHandle, U_LOCATION_TYPE_GNSS,
+                                   maxRadiusMillimetres, pLocationAssist,
+                                   pAuthenticationTokenStr, pLocation,
+                                   pKeepGoingCallback);
+            } else {
+                errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Get a location from the cache.
+int32_t uLocationCacheGet(int32_t maxAgeMs, int32_t maxRadiusMillimetres,
+                          uLocation_t *pLocation, int32_t *pAgeMs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+
+    if (gULocationMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gULocationMutex);
+
+        errorCode = uLocationSharedCacheFind(maxAgeMs, maxRadiusMillimetres,
+                                             pLocation, pAgeMs);
+
+        U_PORT_MUTEX_UNLOCK(gULocationMutex);
+    }
+
+    return errorCode;
+}
+
+// Put a location into the cache.
+int32_t uLocationCacheSet(const uLocation_t *pLocation)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+
+    if (gULocationMutex != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pLocation != NULL) && (pLocation->type > U_LOCATION_TYPE_NONE) &&
+            (pLocation->type < U_LOCATION_TYPE_MAX_NUM)) {
+
+            U_PORT_MUTEX_LOCK(gULocationMutex);
+
+            uLocationSharedCacheStore(pLocation);
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+
+            U_PORT_MUTEX_UNLOCK(gULocationMutex);
+        }
+    }
+
+    return errorCode;
+}
+
+// Empty the location cache.
+void uLocationCacheClear()
+{
+    if (gULocationMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gULocationMutex);
+
+        uLocationSharedCacheClear();
+
+        U_PORT_MUTEX_UNLOCK(gULocationMutex);
+    }
+}
+
 // End of file
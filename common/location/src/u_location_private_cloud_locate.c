@@ -49,7 +49,12 @@
 
 #include "u_time.h"
 
+#include "u_ubx_protocol.h"
+
+#include "u_gnss_type.h"
 #include "u_gnss_pos.h"
+#include "u_gnss_util.h" // uGnssUtilUbxTransparentSendReceive()
+#include "u_gnss_msg_ubx.h"
 
 #include "u_mqtt_common.h"
 #include "u_mqtt_client.h"
@@ -109,6 +114,30 @@
 # define U_LOCATION_PRIVATE_CLOUD_LOCATE_READ_MESSAGE_LENGTH_BYTES 512
 #endif
 
+#ifndef U_LOCATION_PRIVATE_CLOUD_LOCATE_NAV_SAT_LENGTH_BYTES
+/** The size of buffer to use when reading UBX-NAV-SAT in order
+ * to obtain the elevation of each satellite: 8 bytes of overhead,
+ * 8 bytes of body and 12 bytes per satellite, plus room for
+ * anything else that the GNSS chip might be emitting.  Only
+ * allocated if an elevation mask is being applied.
+ */
+# define U_LOCATION_PRIVATE_CLOUD_LOCATE_NAV_SAT_LENGTH_BYTES 1024
+#endif
+
+/** The offset of the number of satellites in the body of
+ * UBX-RXM-MEASX.
+ */
+#define U_LOCATION_PRIVATE_CLOUD_LOCATE_MEASX_NUM_SV_OFFSET 34
+
+/** The length of the body of UBX-RXM-MEASX, excluding the
+ * repeated blocks.
+ */
+#define U_LOCATION_PRIVATE_CLOUD_LOCATE_MEASX_BODY_LENGTH_BYTES 44
+
+/** The length of a repeated (per satellite) block of UBX-RXM-MEASX.
+ */
+#define U_LOCATION_PRIVATE_CLOUD_LOCATE_MEASX_SV_LENGTH_BYTES 24
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -326,10 +355,175 @@ static int32_t parseLocation(char *pStr, uLocation_t *pLocation)
     return pStr != NULL ? (int32_t) U_ERROR_COMMON_SUCCESS : (int32_t) U_ERROR_COMMON_UNKNOWN;
 }
 
+// Get the elevation of the given satellite from a UBX-NAV-SAT
+// message, INT_MIN if it is not there.
+static int32_t elevationGet(const char *pNavSat, size_t navSatLength,
+                            int32_t gnssId, int32_t svId)
+{
+    int32_t elevation = INT_MIN;
+    const uGnssMsgUbxNavSat_t *pBody = pUGnssMsgUbxNavSat(pNavSat, navSatLength);
+    const uGnssMsgUbxNavSatSv_t *pSv;
+
+    if (pBody != NULL) {
+        for (size_t x = 0; (x < pBody->numSvs) && (elevation == INT_MIN); x++) {
+            pSv = pUGnssMsgUbxNavSatSv(pNavSat, navSatLength, x);
+            if ((pSv != NULL) && (pSv->gnssId == gnssId) && (pSv->svId == svId)) {
+                elevation = pSv->elev;
+            }
+        }
+    }
+
+    return elevation;
+}
+
+// Poll UBX-NAV-SAT from the GNSS chip into pBuffer, returning a
+// pointer to the start of the message in pBuffer (or NULL) and
+// its length in *pLength.
+static const char *pNavSatGet(uDeviceHandle_t gnssDevHandle,
+                              char *pBuffer, size_t size,
+                              size_t *pLength)
+{
+    const char *pNavSat = NULL;
+    char command[U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+    const char *pStart = pBuffer;
+    const char *pEnd;
+    int32_t messageClass;
+    int32_t messageId;
+    int32_t bodyLength = 0;
+    int32_t length;
+
+    *pLength = 0;
+    length = uUbxProtocolEncode(U_GNSS_MSG_UBX_NAV_SAT_MESSAGE_ID >> 8,
+                                U_GNSS_MSG_UBX_NAV_SAT_MESSAGE_ID & 0xFF,
+                                NULL, 0, command);
+    if (length > 0) {
+        length = uGnssUtilUbxTransparentSendReceive(gnssDevHandle, command,
+                                                    length, pBuffer, size);
+    }
+    // The response is whatever the GNSS chip emitted after
+    // the poll, so find UBX-NAV-SAT in it
+    while ((pNavSat == NULL) && (length > 0) && (bodyLength >= 0)) {
+        bodyLength = uUbxProtocolDecode(pStart, length - (pStart - pBuffer),
+                                        &messageClass, &messageId,
+                                        NULL, 0, &pEnd);
+        if (bodyLength >= 0) {
+            if (((messageClass << 8) | messageId) == U_GNSS_MSG_UBX_NAV_SAT_MESSAGE_ID) {
+                *pLength = bodyLength + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES;
+                pNavSat = pEnd - *pLength;
+            }
+            pStart = pEnd;
+        }
+    }
+
+    return pNavSat;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Prune RRLP information in place.
+int32_t uLocationPrivateCloudLocateRrlpPrune(char *pBuffer, size_t length,
+                                             int32_t svsThreshold,
+                                             int32_t cNoThreshold,
+                                             int32_t multipathIndexLimit,
+                                             int32_t pseudorangeRmsErrorIndexLimit,
+                                             int32_t svsMax,
+                                             int32_t elevationMinDegrees,
+                                             const char *pNavSat,
+                                             size_t navSatLength)
+{
+    // Access the buffer as a uint8_t to avoid maths funnies with
+    // chars being signed or unsigned
+    uint8_t *pBody = (uint8_t *) pBuffer + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES;
+    uint8_t *pSv;
+    // One bit per satellite: numSv is a uint8_t
+    uint32_t keep[256 / 32] = {0};
+    int32_t svs = 0;
+    int32_t numKept = 0;
+    int32_t weakest;
+    int32_t weakestCNo;
+    int32_t elevation;
+    int32_t y = 0;
+
+    if ((pBuffer != NULL) && (svsMax > 0) &&
+        (length >= U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES +
+         U_LOCATION_PRIVATE_CLOUD_LOCATE_MEASX_BODY_LENGTH_BYTES)) {
+        svs = *(pBody + U_LOCATION_PRIVATE_CLOUD_LOCATE_MEASX_NUM_SV_OFFSET);
+        if (length < U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES +
+            U_LOCATION_PRIVATE_CLOUD_LOCATE_MEASX_BODY_LENGTH_BYTES +
+            ((size_t) svs * U_LOCATION_PRIVATE_CLOUD_LOCATE_MEASX_SV_LENGTH_BYTES)) {
+            // Not what we expected, leave well alone
+            svs = 0;
+        }
+    }
+
+    // Mark the satellites that meet the criteria; the offsets
+    // in the repeated block are those used by uGnssPosGetRrlp()
+    for (int32_t x = 0; x < svs; x++) {
+        pSv = pBody + U_LOCATION_PRIVATE_CLOUD_LOCATE_MEASX_BODY_LENGTH_BYTES +
+              (x * U_LOCATION_PRIVATE_CLOUD_LOCATE_MEASX_SV_LENGTH_BYTES);
+        if (((cNoThreshold < 0) || (*(pSv + 2) >= cNoThreshold)) &&
+            ((multipathIndexLimit < 0) || (*(pSv + 3) <= multipathIndexLimit)) &&
+            ((pseudorangeRmsErrorIndexLimit < 0) || (*(pSv + 21) <= pseudorangeRmsErrorIndexLimit))) {
+            elevation = INT_MIN;
+            if ((elevationMinDegrees > 0) && (pNavSat != NULL)) {
+                elevation = elevationGet(pNavSat, navSatLength, *pSv, *(pSv + 1));
+            }
+            // A satellite of unknown elevation is kept
+            if ((elevation == INT_MIN) || (elevation >= elevationMinDegrees)) {
+                keep[x >> 5] |= 1UL << (x & 0x1f);
+                numKept++;
+            }
+        }
+    }
+
+    // Drop the weakest until there are no more than svsMax
+    while (numKept > svsMax) {
+        weakest = 0;
+        weakestCNo = INT_MAX;
+        for (int32_t x = 0; x < svs; x++) {
+            pSv = pBody + U_LOCATION_PRIVATE_CLOUD_LOCATE_MEASX_BODY_LENGTH_BYTES +
+                  (x * U_LOCATION_PRIVATE_CLOUD_LOCATE_MEASX_SV_LENGTH_BYTES);
+            if ((keep[x >> 5] & (1UL << (x & 0x1f))) && (*(pSv + 2) < weakestCNo)) {
+                weakest = x;
+                weakestCNo = *(pSv + 2);
+            }
+        }
+        keep[weakest >> 5] &= ~(1UL << (weakest & 0x1f));
+        numKept--;
+    }
+
+    if ((numKept > 0) && (numKept < svs) &&
+        ((svsThreshold < 0) || (numKept >= svsThreshold))) {
+        // Move the satellites we're keeping down over the others,
+        // then re-write the count, length and checksum
+        for (int32_t x = 0; x < svs; x++) {
+            if (keep[x >> 5] & (1UL << (x & 0x1f))) {
+                if (y != x) {
+                    memmove(pBody + U_LOCATION_PRIVATE_CLOUD_LOCATE_MEASX_BODY_LENGTH_BYTES +
+                            (y * U_LOCATION_PRIVATE_CLOUD_LOCATE_MEASX_SV_LENGTH_BYTES),
+                            pBody + U_LOCATION_PRIVATE_CLOUD_LOCATE_MEASX_BODY_LENGTH_BYTES +
+                            (x * U_LOCATION_PRIVATE_CLOUD_LOCATE_MEASX_SV_LENGTH_BYTES),
+                            U_LOCATION_PRIVATE_CLOUD_LOCATE_MEASX_SV_LENGTH_BYTES);
+                }
+                y++;
+            }
+        }
+        *(pBody + U_LOCATION_PRIVATE_CLOUD_LOCATE_MEASX_NUM_SV_OFFSET) = (uint8_t) numKept;
+        y = uUbxProtocolEncodeInPlace(0x02, 0x14, pBuffer,
+                                      U_LOCATION_PRIVATE_CLOUD_LOCATE_MEASX_BODY_LENGTH_BYTES +
+                                      (numKept * U_LOCATION_PRIVATE_CLOUD_LOCATE_MEASX_SV_LENGTH_BYTES));
+        if (y > 0) {
+            uPortLog("U_LOCATION_PRIVATE_CLOUD_LOCATE: RRLP pruned from %d to %d"
+                     " satellite(s), %d to %d byte(s).\n", svs, numKept, (int32_t) length, y);
+            length = y;
+        }
+    }
+
+    return (int32_t) length;
+}
+
 // Run Cloud Locate.
 int32_t uLocationPrivateCloudLocate(uDeviceHandle_t devHandle,
                                     uDeviceHandle_t gnssDevHandle,
@@ -338,6 +532,8 @@ int32_t uLocationPrivateCloudLocate(uDeviceHandle_t devHandle,
                                     int32_t cNoThreshold,
                                     int32_t multipathIndexLimit,
                                     int32_t pseudorangeRmsErrorIndexLimit,
+                                    int32_t rrlpSvsMax,
+                                    int32_t rrlpElevationMinDegrees,
                                     const char *pClientIdStr,
                                     uLocation_t *pLocation,
                                     bool (*pKeepGoingCallback) (uDeviceHandle_t))
@@ -347,6 +543,9 @@ int32_t uLocationPrivateCloudLocate(uDeviceHandle_t devHandle,
     char topicBuffer[U_LOCATION_PRIVATE_CLOUD_LOCATE_SUBSCRIBE_TOPIC_LENGTH_BYTES];
     char *pTopicBufferRead;
     char *pMessageRead;
+    char *pNavSatBuffer = NULL;
+    const char *pNavSat = NULL;
+    size_t navSatLength = 0;
     int32_t startTimeMs = uPortGetTickTimeMs();
     bool subscribed = false;
     size_t z;
@@ -378,6 +577,27 @@ int32_t uLocationPrivateCloudLocate(uDeviceHandle_t devHandle,
                                             svsThreshold, cNoThreshold, multipathIndexLimit,
                                             pseudorangeRmsErrorIndexLimit,
                                             pKeepGoingCallback);
+                if ((errorCode >= 0) && (rrlpSvsMax > 0)) {
+                    if (rrlpElevationMinDegrees > 0) {
+                        // Need the elevations; if we can't get them
+                        // every satellite counts as being high enough
+                        pNavSatBuffer = (char *) pUPortMalloc(U_LOCATION_PRIVATE_CLOUD_LOCATE_NAV_SAT_LENGTH_BYTES);
+                        if (pNavSatBuffer != NULL) {
+                            pNavSat = pNavSatGet(gnssDevHandle, pNavSatBuffer,
+                                                 U_LOCATION_PRIVATE_CLOUD_LOCATE_NAV_SAT_LENGTH_BYTES,
+                                                 &navSatLength);
+                        }
+                    }
+                    // Only send what the Cloud Locate service needs
+                    errorCode = uLocationPrivateCloudLocateRrlpPrune(pBuffer, errorCode, svsThreshold,
+                                                                     cNoThreshold, multipathIndexLimit,
+                                                                     pseudorangeRmsErrorIndexLimit,
+                                                                     rrlpSvsMax, rrlpElevationMinDegrees,
+                                                                     pNavSat, navSatLength);
+                    if (pNavSatBuffer != NULL) {
+                        uPortFree(pNavSatBuffer);
+                    }
+                }
                 if (errorCode >= 0) {
                     // Send the RRLP data to the Cloud Locate service using MQTT
                     errorCode = uMqttClientPublish(pMqttClientContext,
@@ -44,6 +44,54 @@ extern "C" {
  * FUNCTIONS
  * -------------------------------------------------------------- */
 
+/** Prune RRLP information, as returned by uGnssPosGetRrlp(), in
+ * place: satellites that do not meet the criteria are removed and,
+ * of those that do, only the svsMax with the highest carrier to
+ * noise ratio are kept; the length, satellite count and checksum of
+ * the UBX-RXM-MEASX message are updated to match.  If fewer than
+ * svsThreshold (or one) satellites would be left, or the RRLP
+ * information is not as expected, it is left unchanged.
+ *
+ * @param[in,out] pBuffer               the RRLP information, starting
+ *                                      with the UBX header and ending
+ *                                      with the UBX checksum.
+ * @param length                        the number of bytes at pBuffer.
+ * @param svsThreshold                  the minimum number of satellites
+ *                                      that must be left; -1 for
+ *                                      "don't care".
+ * @param cNoThreshold                  the minimum carrier to noise ratio
+ *                                      of a satellite that is kept; -1
+ *                                      for "don't care".
+ * @param multipathIndexLimit           the maximum multipath index of a
+ *                                      satellite that is kept; -1 for
+ *                                      "don't care".
+ * @param pseudorangeRmsErrorIndexLimit the maximum pseudorange RMS error
+ *                                      index of a satellite that is kept;
+ *                                      -1 for "don't care".
+ * @param svsMax                        the maximum number of satellites
+ *                                      to keep; must be greater than zero.
+ * @param elevationMinDegrees           the minimum elevation of a satellite
+ *                                      that is kept; zero or less for
+ *                                      "don't care".
+ * @param[in] pNavSat                   a UBX-NAV-SAT message, starting with
+ *                                      the UBX header, from which to take
+ *                                      the elevations; may be NULL, and a
+ *                                      satellite that is not found in it
+ *                                      is kept.
+ * @param navSatLength                  the number of bytes at pNavSat.
+ * @return                              the length of the RRLP information
+ *                                      at pBuffer.
+ */
+int32_t uLocationPrivateCloudLocateRrlpPrune(char *pBuffer, size_t length,
+                                             int32_t svsThreshold,
+                                             int32_t cNoThreshold,
+                                             int32_t multipathIndexLimit,
+                                             int32_t pseudorangeRmsErrorIndexLimit,
+                                             int32_t svsMax,
+                                             int32_t elevationMinDegrees,
+                                             const char *pNavSat,
+                                             size_t navSatLength);
+
 /** Run Cloud Locate.
  *
  * @param devHandle                     the handle of the thing
@@ -94,6 +142,14 @@ extern "C" {
  *                                      to be considered valid, specify -1
  *                                      for "don't care".  The recommended
  *                                      value is 3.
+ * @param rrlpSvsMax                    if greater than zero the RRLP
+ *                                      information is pruned with
+ *                                      uLocationPrivateCloudLocateRrlpPrune()
+ *                                      to at most this many satellites
+ *                                      before it is sent.
+ * @param rrlpElevationMinDegrees       the minimum elevation of a
+ *                                      satellite kept when pruning;
+ *                                      zero or less for "don't care".
  * @param pClientIdStr                  the Thingstream device ID, obtained
  *                                      from the Thingstream portal, for
  *                                      this device; must be provided if
@@ -129,6 +185,8 @@ int32_t uLocationPrivateCloudLocate(uDeviceHandle_t devHandle,
                                     int32_t cNoThreshold,
                                     int32_t multipathIndexLimit,
                                     int32_t pseudorangeRmsErrorIndexLimit,
+                                    int32_t rrlpSvsMax,
+                                    int32_t rrlpElevationMinDegrees,
                                     const char *pClientIdStr,
                                     uLocation_t *pLocation,
                                     bool (*pKeepGoingCallback) (uDeviceHandle_t));
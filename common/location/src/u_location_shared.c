@@ -33,9 +33,11 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
+#include "string.h"    // memset()
 
 #include "u_error_common.h"
 
+#include "u_port.h"
 #include "u_port_heap.h"
 #include "u_port_os.h"
 
@@ -54,7 +56,7 @@
  * SHARED VARIABLES
  * -------------------------------------------------------------- */
 
-/** Mutex to protect the FIFO.
+/** Mutex to protect the FIFO and the cache.
  */
 uPortMutexHandle_t gULocationMutex = NULL;
 
@@ -70,6 +72,10 @@ static uLocationSharedFifoEntry_t *gpLocationGnssFifo = NULL;
  */
 static uLocationSharedFifoEntry_t *gpLocationCellLocateFifo = NULL;
 
+/** The cache of location fixes, indexed by location type.
+ */
+static uLocationSharedCacheEntry_t gCache[U_LOCATION_TYPE_MAX_NUM] = {0};
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -85,6 +91,7 @@ int32_t uLocationSharedInit()
 
     if (gULocationMutex == NULL) {
         errorCode = uPortMutexCreate(&gULocationMutex);
+        uLocationSharedCacheClear();
     }
 
     return errorCode;
@@ -105,6 +112,7 @@ void uLocationSharedDeinit()
                 uPortFree(pEntry);
             }
         }
+        uLocationSharedCacheClear();
         U_PORT_MUTEX_UNLOCK(gULocationMutex);
         uPortMutexDelete(gULocationMutex);
         gULocationMutex = NULL;
@@ -204,4 +212,65 @@ uLocationSharedFifoEntry_t *pULocationSharedRequestPop(uLocationType_t type)
     return pSaved;
 }
 
+// Store a location fix in the cache.
+void uLocationSharedCacheStore(const uLocation_t *pLocation)
+{
+    uLocationSharedCacheEntry_t *pEntry;
+
+    if ((pLocation != NULL) && (pLocation->type > U_LOCATION_TYPE_NONE) &&
+        (pLocation->type < U_LOCATION_TYPE_MAX_NUM)) {
+        pEntry = &(gCache[pLocation->type]);
+        pEntry->location = *pLocation;
+        pEntry->tickMs = uPortGetTickTimeMs();
+        pEntry->valid = true;
+    }
+}
+
+// Find the most recent suitable location fix in the cache.
+int32_t uLocationSharedCacheFind(int32_t maxAgeMs, int32_t maxRadiusMillimetres,
+                                 uLocation_t *pLocation, int32_t *pAgeMs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+    const uLocationSharedCacheEntry_t *pEntry;
+    const uLocationSharedCacheEntry_t *pBest = NULL;
+    int32_t bestAgeMs = 0;
+    int32_t ageMs;
+    int32_t nowMs = uPortGetTickTimeMs();
+
+    for (size_t x = 0; x < sizeof(gCache) / sizeof(gCache[0]); x++) {
+        pEntry = &(gCache[x]);
+        // Done as unsigned so that a wrap of the tick is not a problem
+        ageMs = (int32_t) (((uint32_t) nowMs) - ((uint32_t) pEntry->tickMs));
+        if (pEntry->valid && (ageMs >= 0) &&
+            ((maxAgeMs < 0) || (ageMs <= maxAgeMs)) &&
+            ((maxRadiusMillimetres < 0) ||
+             ((pEntry->location.radiusMillimetres >= 0) &&
+              (pEntry->location.radiusMillimetres <= maxRadiusMillimetres))) &&
+            ((pBest == NULL) || (ageMs < bestAgeMs) ||
+             ((ageMs == bestAgeMs) &&
+              (pEntry->location.radiusMillimetres < pBest->location.radiusMillimetres)))) {
+            pBest = pEntry;
+            bestAgeMs = ageMs;
+        }
+    }
+
+    if (pBest != NULL) {
+        if (pLocation != NULL) {
+            *pLocation = pBest->location;
+        }
+        if (pAgeMs != NULL) {
+            *pAgeMs = bestAgeMs;
+        }
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Empty the cache of location fixes.
+void uLocationSharedCacheClear()
+{
+    memset(gCache, 0, sizeof(gCache));
+}
+
 // End of file
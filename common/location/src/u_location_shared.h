@@ -51,11 +51,20 @@ typedef struct uLocationSharedFifoEntry_t {
     struct uLocationSharedFifoEntry_t *pNext;
 } uLocationSharedFifoEntry_t;
 
+/** An entry in the cache of location fixes, one per location type.
+ */
+typedef struct {
+    uLocation_t location;
+    int32_t tickMs;  /**< the value of uPortGetTickTimeMs() when the
+                          fix was stored. */
+    bool valid;
+} uLocationSharedCacheEntry_t;
+
 /* ----------------------------------------------------------------
  * SHARED VARIABLES
  * -------------------------------------------------------------- */
 
-/** Mutex to protect the FIFO.
+/** Mutex to protect the FIFO and the cache.
  */
 extern uPortMutexHandle_t gULocationMutex;
 
@@ -105,6 +114,41 @@ int32_t uLocationSharedRequestPush(uDeviceHandle_t devHandle,
  */
 uLocationSharedFifoEntry_t *pULocationSharedRequestPop(uLocationType_t type);
 
+/** Store a location fix in the cache, replacing any previous fix
+ * of the same type.
+ * IMPORTANT: gULocationMutex should be locked before this
+ * is called.
+ *
+ * @param pLocation the location; the type field must be set and
+ *                  a fix of type #U_LOCATION_TYPE_NONE is ignored.
+ */
+void uLocationSharedCacheStore(const uLocation_t *pLocation);
+
+/** Find the most recent location fix in the cache that meets the
+ * given age and accuracy.
+ * IMPORTANT: gULocationMutex should be locked before this
+ * is called.
+ *
+ * @param maxAgeMs              the maximum age of the fix in
+ *                              milliseconds, -1 for any age.
+ * @param maxRadiusMillimetres  the maximum radius of the fix in
+ *                              millimetres, -1 for any radius.
+ * @param[out] pLocation        a place to put the location; may be
+ *                              NULL.
+ * @param[out] pAgeMs           a place to put the age of the fix
+ *                              in milliseconds; may be NULL.
+ * @return                      zero on success, else
+ *                              #U_ERROR_COMMON_NOT_FOUND.
+ */
+int32_t uLocationSharedCacheFind(int32_t maxAgeMs, int32_t maxRadiusMillimetres,
+                                 uLocation_t *pLocation, int32_t *pAgeMs);
+
+/** Empty the cache of location fixes.
+ * IMPORTANT: gULocationMutex should be locked before this
+ * is called.
+ */
+void uLocationSharedCacheClear();
+
 #ifdef __cplusplus
 }
 #endif
@@ -36,6 +36,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
+#include "string.h"    // memset(), memcmp()
 
 #include "u_cfg_sw.h"
 #include "u_cfg_os_platform_specific.h"
@@ -49,11 +50,17 @@
 #include "u_port_os.h"
 #include "u_port_i2c.h"
 
+#include "u_ubx_protocol.h"
+
+#include "u_mqtt_common.h"
+#include "u_mqtt_client.h"
+
 #include "u_network.h"
 #include "u_network_test_shared_cfg.h"
 
 #include "u_location.h"
 #include "u_location_test_shared_cfg.h"
+#include "u_location_private_cloud_locate.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -67,6 +74,18 @@
  */
 #define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
 
+/** The number of satellites in the synthetic RRLP information
+ * used by the pruning test.
+ */
+#define U_LOCATION_TEST_PRUNE_NUM_SVS 6
+
+/** The length of the synthetic RRLP information used by the
+ * pruning test: a UBX-RXM-MEASX message with a 44 byte body
+ * and 24 bytes per satellite.
+ */
+#define U_LOCATION_TEST_PRUNE_RRLP_LENGTH_BYTES (U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES + 44 + \
+                                                 (U_LOCATION_TEST_PRUNE_NUM_SVS * 24))
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -75,6 +94,22 @@
  * VARIABLES
  * -------------------------------------------------------------- */
 
+/** The carrier to noise ratio of each satellite in the synthetic
+ * RRLP information used by the pruning test.
+ */
+static const uint8_t gPruneCNo[U_LOCATION_TEST_PRUNE_NUM_SVS] = {30, 15, 40, 25, 35, 20};
+
+/** The multipath index of each satellite in the synthetic RRLP
+ * information used by the pruning test.
+ */
+static const uint8_t gPruneMultipath[U_LOCATION_TEST_PRUNE_NUM_SVS] = {0, 0, 0, 2, 1, 1};
+
+/** The elevation of each of the satellites in the synthetic
+ * UBX-NAV-SAT message used by the pruning test; the last
+ * satellite is not in UBX-NAV-SAT.
+ */
+static const int8_t gPruneElevation[U_LOCATION_TEST_PRUNE_NUM_SVS - 1] = {5, 45, 60, 30, 15};
+
 /** Used for keepGoingCallback() timeout.
  */
 static int64_t gStopTimeMs;
@@ -157,6 +192,8 @@ static void testBlocking(uDeviceHandle_t devHandle,
                          const uLocationTestCfg_t *pLocationCfg)
 {
     uLocation_t location;
+    uLocation_t cachedLocation;
+    int32_t ageMs = -1;
     int64_t startTime;
     const uLocationAssist_t *pLocationAssist = NULL;
     const char *pAuthenticationTokenStr = NULL;
@@ -205,6 +242,30 @@ static void testBlocking(uDeviceHandle_t devHandle,
             U_TEST_PRINT_LINE("only able to get time (%d).", (int32_t) location.timeUtc);
         }
         U_PORT_TEST_ASSERT(location.timeUtc > U_LOCATION_TEST_MIN_UTC_TIME);
+        if ((locationType != U_LOCATION_TYPE_CLOUD_CLOUD_LOCATE) ||
+            ((pLocationAssist != NULL) && (pLocationAssist->pClientIdStr != NULL))) {
+            // The fix should now be in the cache and uLocationGetCached()
+            // should return it without performing another fix
+            U_TEST_PRINT_LINE("checking the location cache.");
+            uLocationTestResetLocation(&cachedLocation);
+            U_PORT_TEST_ASSERT(uLocationCacheGet(-1, -1, &cachedLocation, &ageMs) == 0);
+            U_PORT_TEST_ASSERT(ageMs >= 0);
+            U_PORT_TEST_ASSERT(cachedLocation.timeUtc == location.timeUtc);
+            U_PORT_TEST_ASSERT(cachedLocation.latitudeX1e7 == location.latitudeX1e7);
+            U_PORT_TEST_ASSERT(cachedLocation.longitudeX1e7 == location.longitudeX1e7);
+            uLocationTestResetLocation(&cachedLocation);
+            U_PORT_TEST_ASSERT(uLocationGetCached(devHandle, ageMs + 60000, -1,
+                                                  pLocationAssist,
+                                                  pAuthenticationTokenStr,
+                                                  &cachedLocation,
+                                                  keepGoingCallback) == 0);
+            U_PORT_TEST_ASSERT(cachedLocation.timeUtc == location.timeUtc);
+            uLocationCacheClear();
+            U_PORT_TEST_ASSERT(uLocationCacheGet(-1, -1, NULL,
+                                                 NULL) == (int32_t) U_ERROR_COMMON_NOT_FOUND);
+            U_PORT_TEST_ASSERT(uLocationGetCached(NULL, -1, -1, NULL, NULL, NULL,
+                                                  NULL) == (int32_t) U_ERROR_COMMON_NOT_FOUND);
+        }
     } else {
         if (!U_NETWORK_TEST_TYPE_HAS_LOCATION(networkType)) {
             U_PORT_TEST_ASSERT(uLocationGet(devHandle, locationType,
@@ -335,10 +396,121 @@ static void testNonBlocking(uDeviceHandle_t devHandle,
     }
 }
 
+// Assemble synthetic RRLP information, a UBX-RXM-MEASX message
+// with satellites of GPS SV ID 1 onwards, in pBuffer.
+static void pruneRrlpAssemble(char *pBuffer)
+{
+    char *pBody = pBuffer + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES;
+    char *pSv;
+
+    memset(pBuffer, 0, U_LOCATION_TEST_PRUNE_RRLP_LENGTH_BYTES);
+    *(pBody + 34) = U_LOCATION_TEST_PRUNE_NUM_SVS;
+    for (size_t x = 0; x < U_LOCATION_TEST_PRUNE_NUM_SVS; x++) {
+        pSv = pBody + 44 + (x * 24);
+        *(pSv + 1) = (char) (x + 1);
+        *(pSv + 2) = (char) gPruneCNo[x];
+        *(pSv + 3) = (char) gPruneMultipath[x];
+    }
+    U_PORT_TEST_ASSERT(uUbxProtocolEncodeInPlace(0x02, 0x14, pBuffer,
+                                                 U_LOCATION_TEST_PRUNE_RRLP_LENGTH_BYTES -
+                                                 U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES) ==
+                       U_LOCATION_TEST_PRUNE_RRLP_LENGTH_BYTES);
+}
+
+// Check that the RRLP information in pBuffer is a valid
+// UBX-RXM-MEASX message containing the given SV IDs.
+static void pruneRrlpCheck(const char *pBuffer, int32_t length,
+                           const int32_t *pSvId, size_t numSvs)
+{
+    char body[U_LOCATION_TEST_PRUNE_RRLP_LENGTH_BYTES];
+    int32_t messageClass = -1;
+    int32_t messageId = -1;
+
+    U_PORT_TEST_ASSERT(length == (int32_t) (U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES + 44 + (numSvs * 24)));
+    U_PORT_TEST_ASSERT(uUbxProtocolDecode(pBuffer, length, &messageClass, &messageId,
+                                          body, sizeof(body), NULL) == length -
+                       U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT((messageClass == 0x02) && (messageId == 0x14));
+    U_PORT_TEST_ASSERT(body[34] == (char) numSvs);
+    for (size_t x = 0; x < numSvs; x++) {
+        U_PORT_TEST_ASSERT(body[44 + (x * 24) + 1] == (char) *(pSvId + x));
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: TESTS
  * -------------------------------------------------------------- */
 
+/** Test the pruning of RRLP information for Cloud Locate; this
+ * needs no hardware.
+ */
+U_PORT_TEST_FUNCTION("[location]", "locationCloudLocatePrune")
+{
+    char rrlp[U_LOCATION_TEST_PRUNE_RRLP_LENGTH_BYTES];
+    char original[U_LOCATION_TEST_PRUNE_RRLP_LENGTH_BYTES];
+    char navSat[U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES + 8 + ((U_LOCATION_TEST_PRUNE_NUM_SVS - 1) * 12)];
+    char navSatBody[sizeof(navSat) - U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES] = {0};
+    const int32_t svIdsCriteria[] = {1, 3, 5};
+    const int32_t svIdsElevation[] = {3, 5, 6};
+    int32_t x;
+    int32_t heapUsed;
+
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // A UBX-NAV-SAT message with the elevations in it
+    navSatBody[5] = U_LOCATION_TEST_PRUNE_NUM_SVS - 1;
+    for (size_t y = 0; y < U_LOCATION_TEST_PRUNE_NUM_SVS - 1; y++) {
+        navSatBody[8 + (y * 12) + 1] = (char) (y + 1);
+        navSatBody[8 + (y * 12) + 3] = (char) gPruneElevation[y];
+    }
+    U_PORT_TEST_ASSERT(uUbxProtocolEncode(0x01, 0x35, navSatBody, sizeof(navSatBody),
+                                          navSat) == sizeof(navSat));
+
+    pruneRrlpAssemble(original);
+
+    U_TEST_PRINT_LINE("testing no pruning.");
+    memcpy(rrlp, original, sizeof(rrlp));
+    x = uLocationPrivateCloudLocateRrlpPrune(rrlp, sizeof(rrlp), -1, -1, -1, -1,
+                                             -1, -1, NULL, 0);
+    U_PORT_TEST_ASSERT(x == sizeof(rrlp));
+    U_PORT_TEST_ASSERT(memcmp(rrlp, original, sizeof(rrlp)) == 0);
+
+    U_TEST_PRINT_LINE("testing pruning on C/N0 and multipath.");
+    // Satellites 2 (C/N0) and 4 (multipath) fail the criteria,
+    // satellite 6 is then the weakest of the four left
+    x = uLocationPrivateCloudLocateRrlpPrune(rrlp, sizeof(rrlp), 3, 20, 1, -1,
+                                             3, -1, NULL, 0);
+    pruneRrlpCheck(rrlp, x, svIdsCriteria,
+                   sizeof(svIdsCriteria) / sizeof(svIdsCriteria[0]));
+
+    U_TEST_PRINT_LINE("testing pruning on elevation.");
+    // Satellite 1 is too low, satellite 6 is of unknown
+    // elevation and so is kept
+    memcpy(rrlp, original, sizeof(rrlp));
+    x = uLocationPrivateCloudLocateRrlpPrune(rrlp, sizeof(rrlp), 3, 20, 1, -1,
+                                             3, 10, navSat, sizeof(navSat));
+    pruneRrlpCheck(rrlp, x, svIdsElevation,
+                   sizeof(svIdsElevation) / sizeof(svIdsElevation[0]));
+
+    U_TEST_PRINT_LINE("testing that too few satellites means no pruning.");
+    memcpy(rrlp, original, sizeof(rrlp));
+    x = uLocationPrivateCloudLocateRrlpPrune(rrlp, sizeof(rrlp), 4, 20, 1, -1,
+                                             3, -1, NULL, 0);
+    U_PORT_TEST_ASSERT(x == sizeof(rrlp));
+    U_PORT_TEST_ASSERT(memcmp(rrlp, original, sizeof(rrlp)) == 0);
+
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
 /** Test the location API.
  *
  * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
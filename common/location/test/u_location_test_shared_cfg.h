@@ -89,6 +89,20 @@ extern "C" {
 # define U_LOCATION_TEST_CLOUD_LOCATE_PSEUDORANGE_RMS_ERROR_INDEX_LIMIT U_LOCATION_CLOUD_LOCATE_PSEUDORANGE_RMS_ERROR_INDEX_LIMIT
 #endif
 
+#ifndef U_LOCATION_TEST_CLOUD_LOCATE_RRLP_SVS_MAX
+/** The maximum number of satellites to send in the RRLP
+ * information when testing Cloud Locate.
+ */
+# define U_LOCATION_TEST_CLOUD_LOCATE_RRLP_SVS_MAX 12
+#endif
+
+#ifndef U_LOCATION_TEST_CLOUD_LOCATE_RRLP_ELEVATION_MIN_DEGREES
+/** The minimum elevation of a satellite sent in the RRLP
+ * information when testing Cloud Locate.
+ */
+# define U_LOCATION_TEST_CLOUD_LOCATE_RRLP_ELEVATION_MIN_DEGREES 10
+#endif
+
 #ifndef U_LOCATION_TEST_MQTT_INACTIVITY_TIMEOUT_SECONDS
 /** A bit of a balancing act this.  The MQTT server will not allow
  * a device to connect if it is already connected (e.g. it may have
@@ -60,6 +60,48 @@ extern "C" {
                                           -1, -1, false, false,    \
                                           NULL, NULL, false, 0}
 
+#ifndef U_MQTT_CLIENT_QUEUE_DRAIN_BATCH_SIZE
+/** When the outbound queue (see uMqttClientQueueEnable()) is
+ * being drained, the number of messages that are sent between
+ * updates of the copy of the queue on the file system of the
+ * module, if there is one; this is also the maximum number of
+ * messages that might be sent twice if the MCU is reset during
+ * a drain.
+ */
+# define U_MQTT_CLIENT_QUEUE_DRAIN_BATCH_SIZE 8
+#endif
+
+#ifndef U_MQTT_CLIENT_QUEUE_FILE_NAME_MAX_LENGTH_BYTES
+/** The maximum length of the name of the file used to keep a copy
+ * of the outbound queue on the file system of a cellular module,
+ * see uMqttClientQueueEnable(), excluding the null terminator.
+ */
+# define U_MQTT_CLIENT_QUEUE_FILE_NAME_MAX_LENGTH_BYTES 47
+#endif
+
+#ifndef U_MQTT_CLIENT_DISPATCH_TOPIC_MAX_LENGTH_BYTES
+/** The size of the buffer used by uMqttClientHandlerDispatch() to
+ * read the topic of a message into, including room for a null
+ * terminator.
+ */
+# define U_MQTT_CLIENT_DISPATCH_TOPIC_MAX_LENGTH_BYTES 128
+#endif
+
+#ifndef U_MQTT_CLIENT_DISPATCH_MESSAGE_MAX_LENGTH_BYTES
+/** The size of the buffer used by uMqttClientHandlerDispatch() to
+ * read a message into; a longer message is truncated.
+ */
+# define U_MQTT_CLIENT_DISPATCH_MESSAGE_MAX_LENGTH_BYTES 1024
+#endif
+
+#ifndef U_MQTT_CLIENT_DISPATCH_MATCH_MAX_NUM
+/** The maximum number of handlers, see uMqttClientHandlerAdd(),
+ * that uMqttClientHandlerDispatch() will call for a single message,
+ * i.e. the maximum number of overlapping topic filters.
+ */
+# define U_MQTT_CLIENT_DISPATCH_MATCH_MAX_NUM 8
+#endif
+
 /** The number of bytes required to store a short MQTT-SN topic name,
  * which will be of the form "xy", two characters plus a null terminator.
  */
@@ -195,8 +237,46 @@ typedef struct {
     uSecurityTlsContext_t *pSecurityContext;
     int32_t totalMessagesSent;      /* Total messages sent from MQTT client */
     int32_t totalMessagesReceived;  /* Total messages received by MQTT client */
+    void *pQueue; /* The outbound queue, NULL if there isn't one */
+    void *pHandlers; /* The root of the trie of message handlers */
 } uMqttClientContext_t;
 
+/** A message handler, see uMqttClientHandlerAdd().  The parameters
+ * are the null-terminated topic name of the message, a pointer to
+ * the message, the number of bytes at that pointer, the QoS of the
+ * message and the parameter that was given to uMqttClientHandlerAdd().
+ * The topic name and message are only valid for the duration of the
+ * call; the handler may call other MQTT client API functions.
+ */
+typedef void (*uMqttClientHandler_t) (const char *pTopicNameStr,
+                                      const char *pMessage,
+                                      size_t messageSizeBytes,
+                                      uMqttQos_t qos,
+                                      void *pHandlerParam);
+
+/** Statistics for the outbound queue of an MQTT client, see
+ * uMqttClientQueueGetStats().
+ */
+typedef struct {
+    size_t numMessages;           /**< the number of messages currently
+                                       queued. */
+    size_t numBytes;              /**< the number of bytes currently
+                                       queued, topics plus messages. */
+    size_t peakNumMessages;       /**< the largest number of messages
+                                       that have been queued at once. */
+    int32_t numDropped;           /**< the number of messages thrown away,
+                                       because the queue was full or the
+                                       broker rejected them while the
+                                       connection was up. */
+    int32_t numDrained;           /**< the number of queued messages that
+                                       have been sent. */
+    int32_t bytesDrained;         /**< the number of queued bytes, topics
+                                       plus messages, that have been sent. */
+    int32_t drainBytesPerSecond;  /**< the rate at which queued bytes
+                                       were sent during the most recent
+                                       drain, -1 if there has not been one. */
+} uMqttClientQueueStats_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: MQTT AND MQTT-SN
  * -------------------------------------------------------------- */
@@ -397,7 +477,11 @@ int32_t uMqttClientSetDisconnectCallback(const uMqttClientContext_t *pContext,
  * @param retain            if true the message will be kept
  *                          by the broker across MQTT disconnects/
  *                          connects, else it will be cleared.
- * @return                  zero on success else negative error code.
+ * @return                  zero on success else negative error code;
+ *                          if an outbound queue is enabled, see
+ *                          uMqttClientQueueEnable(), and the MQTT
+ *                          client is not connected, zero is returned
+ *                          once the message has been queued.
  */
 int32_t uMqttClientPublish(uMqttClientContext_t *pContext,
                            const char *pTopicNameStr,
@@ -473,6 +557,160 @@ int32_t uMqttClientMessageRead(uMqttClientContext_t *pContext,
                                size_t *pMessageSizeBytes,
                                uMqttQos_t *pQos);
 
+/** MQTT only: enable an outbound queue.  Once enabled, if
+ * uMqttClientPublish() is called while the MQTT client is not
+ * connected the message is queued, rather than an error being
+ * returned, and all queued messages are sent, in order, as fast as
+ * the module will take them, when uMqttClientConnect() next succeeds
+ * or when uMqttClientPublish() or uMqttClientQueueDrain() is next
+ * called while connected.  If the queue is full the oldest message
+ * is dropped to make room.  MQTT-SN messages are not queued.
+ *
+ * If pFileNameStr is non-NULL, and the MQTT client is on a cellular
+ * module, a copy of the queue is kept in the named file on the file
+ * system of the module so that it survives a reset of the MCU: any
+ * messages in that file are added to the queue by this function.
+ * The file is deleted when the queue has been drained.
+ *
+ * The queue takes (from the heap) around 16 bytes plus the length of
+ * the topic plus the length of the message per message queued.
+ *
+ * @param[in] pContext         a pointer to the internal MQTT context
+ *                             structure that was originally returned
+ *                             by pUMqttClientOpen().
+ * @param maxNumMessages       the maximum number of messages to
+ *                             queue; must be greater than zero.
+ * @param maxNumBytes          the maximum number of bytes to queue,
+ *                             topics plus messages; must be greater than
+ *                             zero.
+ * @param[in] pFileNameStr     the null-terminated name of the file to
+ *                             keep a copy of the queue in, no longer than
+ *                             #U_MQTT_CLIENT_QUEUE_FILE_NAME_MAX_LENGTH_BYTES;
+ *                             use NULL to keep the queue only in RAM.
+ * @return                     the number of messages in the queue on
+ *                             success, else negative error code; if
+ *                             a queue is already enabled
+ *                             #U_ERROR_COMMON_INVALID_PARAMETER is
+ *                             returned.
+ */
+int32_t uMqttClientQueueEnable(uMqttClientContext_t *pContext,
+                               size_t maxNumMessages,
+                               size_t maxNumBytes,
+                               const char *pFileNameStr);
+
+/** MQTT only: send whatever is in the outbound queue, if the MQTT
+ * client is connected; it is not usually necessary to call this
+ * since the queue is drained by uMqttClientConnect() and
+ * uMqttClientPublish().
+ *
+ * @param[in] pContext  a pointer to the internal MQTT context
+ *                      structure that was originally returned
+ *                      by pUMqttClientOpen().
+ * @return              the number of messages sent on success,
+ *                      else negative error code.
+ */
+int32_t uMqttClientQueueDrain(uMqttClientContext_t *pContext);
+
+/** MQTT only: throw away everything in the outbound queue,
+ * including any copy on the file system of the module.
+ *
+ * @param[in] pContext  a pointer to the internal MQTT context
+ *                      structure that was originally returned
+ *                      by pUMqttClientOpen().
+ * @return              the number of messages thrown away on
+ *                      success, else negative error code.
+ */
+int32_t uMqttClientQueueClear(uMqttClientContext_t *pContext);
+
+/** MQTT only: disable the outbound queue, freeing its memory.  Any
+ * messages in the queue are lost from RAM, but a copy on the file
+ * system of the module is left in place to be picked up by the next
+ * call to uMqttClientQueueEnable(); call uMqttClientQueueClear()
+ * first if that is not what you want.  uMqttClientClose() calls
+ * this.
+ *
+ * @param[in] pContext  a pointer to the internal MQTT context
+ *                      structure that was originally returned
+ *                      by pUMqttClientOpen().
+ */
+void uMqttClientQueueDisable(uMqttClientContext_t *pContext);
+
+/** MQTT only: get the statistics of the outbound queue.
+ *
+ * @param[in] pContext  a pointer to the internal MQTT context
+ *                      structure that was originally returned
+ *                      by pUMqttClientOpen().
+ * @param[out] pStats   a place to put the statistics; cannot be NULL.
+ * @return              zero on success else negative error code,
+ *                      e.g. #U_ERROR_COMMON_NOT_INITIALISED if no
+ *                      queue is enabled.
+ */
+int32_t uMqttClientQueueGetStats(const uMqttClientContext_t *pContext,
+                                 uMqttClientQueueStats_t *pStats);
+
+/** MQTT only: add a handler for messages whose topic matches the
+ * given topic filter; this does not subscribe to the topic, you still
+ * need to call uMqttClientSubscribe(), it just determines what
+ * uMqttClientHandlerDispatch() does with a message once it has
+ * arrived.  The handlers are kept in a trie, one node per topic
+ * level, so the cost of finding the handlers for a message depends
+ * on the number of levels in its topic, not on the number of
+ * handlers.  Adding a handler for a topic filter that already has
+ * one replaces it.
+ *
+ * @param[in] pContext         a pointer to the internal MQTT context
+ *                             structure that was originally returned
+ *                             by pUMqttClientOpen().
+ * @param[in] pTopicFilterStr  the null-terminated topic filter, e.g.
+ *                             "sensor/+/temperature" or "shadow/#"; as
+ *                             for MQTT, '+' matches any single level and
+ *                             '#', which must be the last level, matches
+ *                             any number of levels, including none, and,
+ *                             at the first level, neither matches a topic
+ *                             that begins with '$'.  Cannot be NULL.
+ * @param[in] pHandler         the handler; cannot be NULL.
+ * @param[in] pHandlerParam    a parameter that will be passed to
+ *                             pHandler; may be NULL.
+ * @return                     zero on success else negative error code.
+ */
+int32_t uMqttClientHandlerAdd(uMqttClientContext_t *pContext,
+                              const char *pTopicFilterStr,
+                              uMqttClientHandler_t pHandler,
+                              void *pHandlerParam);
+
+/** MQTT only: remove a handler added with uMqttClientHandlerAdd().
+ *
+ * @param[in] pContext         a pointer to the internal MQTT context
+ *                             structure that was originally returned
+ *                             by pUMqttClientOpen().
+ * @param[in] pTopicFilterStr  the null-terminated topic filter, exactly
+ *                             as passed to uMqttClientHandlerAdd().
+ * @return                     zero on success else negative error code,
+ *                             #U_ERROR_COMMON_NOT_FOUND if there is no
+ *                             handler for pTopicFilterStr.
+ */
+int32_t uMqttClientHandlerRemove(uMqttClientContext_t *pContext,
+                                 const char *pTopicFilterStr);
+
+/** MQTT only: read all of the unread messages and pass each one to
+ * the handlers, see uMqttClientHandlerAdd(), whose topic filter
+ * matches its topic.  Each message is read once, into a buffer of
+ * #U_MQTT_CLIENT_DISPATCH_MESSAGE_MAX_LENGTH_BYTES taken from the
+ * heap for the duration of the call, and handed to the handlers in
+ * place.  A message that matches no handler is thrown away.
+ *
+ * Call this from your own task, e.g. when the callback set with
+ * uMqttClientSetMessageCallback() tells you that there are unread
+ * messages, not from within that callback.
+ *
+ * @param[in] pContext  a pointer to the internal MQTT context
+ *                      structure that was originally returned
+ *                      by pUMqttClientOpen().
+ * @return              the number of messages that were passed to at
+ *                      least one handler, else negative error code.
+ */
+int32_t uMqttClientHandlerDispatch(uMqttClientContext_t *pContext);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: MQTT-SN ONLY
  * -------------------------------------------------------------- */
@@ -590,6 +828,16 @@ int32_t uMqttClientSnGetTopicNameShort(const uMqttSnTopicName_t *pTopicName,
  * subscribing.
  * Must be connected to an MQTT-SN broker for this to work.
  *
+ * If retain was set in the #uMqttClientConnection_t passed to
+ * uMqttClientSnConnect() the topic ID is remembered, in RAM of this MCU, against the broker
+ * name and client ID, and a later registration of the same topic
+ * name with the same broker and client ID, e.g. after a reconnection
+ * on waking up, returns the remembered ID without contacting the
+ * broker.  MQTT-SN provides no way to find out whether the MQTT-SN
+ * gateway has really kept the session, so only set retain if you
+ * know that it does; should the gateway forget the registrations
+ * anyway, call uMqttClientSnTopicCacheClear() and register again.
+ *
  * @param[in] pContext       a pointer to the internal MQTT context.
  * @param[in] pTopicNameStr  the null-terminated topic name string;
  *                           cannot be NULL.
@@ -601,6 +849,16 @@ int32_t uMqttClientSnRegisterNormalTopic(const uMqttClientContext_t *pContext,
                                          const char *pTopicNameStr,
                                          uMqttSnTopicName_t *pTopicName);
 
+/** MQTT-SN only: forget the topic IDs remembered by
+ * uMqttClientSnRegisterNormalTopic() for the broker and client ID
+ * of the current MQTT-SN connection, e.g. because the MQTT-SN
+ * gateway has rejected one of them.
+ *
+ * @param[in] pContext  a pointer to the internal MQTT context.
+ * @return              zero on success, else negative error code.
+ */
+int32_t uMqttClientSnTopicCacheClear(const uMqttClientContext_t *pContext);
+
 /** MQTT-SN only: publish a message; this differs from uMqttClientPublish()
  * in that it uses an MQTT-SN topic name, either created with
  * uMqttClientSnSetTopicIdPredefined()/ uMqttClientSnSetTopicNameShort()
@@ -47,12 +47,14 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // strlen(), strncpy()
+#include "string.h"    // strlen(), strncpy(), memcpy()
 
 #include "u_error_common.h"
 
 #include "u_device_shared.h"
+#include "u_device_metrics.h"
 
+#include "u_port.h"
 #include "u_port_heap.h"
 #include "u_port_os.h"
 
@@ -61,16 +63,90 @@
 
 #include "u_cell_sec_tls.h"
 #include "u_cell_mqtt.h"
+#include "u_cell_file.h"
 #include "u_wifi_mqtt.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+/** The length of the header of each message in the file copy of
+ * the outbound queue: two bytes of topic name length, two bytes of
+ * message length, one byte of QoS and one byte of retain flag.
+ */
+#define U_MQTT_CLIENT_QUEUE_FILE_HEADER_LENGTH_BYTES 6
+
+/** Get a pointer to the null-terminated topic name of an entry
+ * in the outbound queue.
+ */
+#define U_MQTT_CLIENT_QUEUE_ENTRY_TOPIC(pEntry) (((char *) (pEntry)) + sizeof(uMqttClientQueueEntry_t))
+
+/** Get a pointer to the message of an entry in the outbound queue.
+ */
+/** Get a pointer to the null-terminated topic level of a node in
+ * the trie of message handlers.
+ */
+#define U_MQTT_CLIENT_HANDLER_NODE_LEVEL(pNode) (((char *) (pNode)) + \
+                                                 sizeof(uMqttClientHandlerNode_t))
+
+/** Get a pointer to the message of an entry in the outbound queue.
+ */
+#define U_MQTT_CLIENT_QUEUE_ENTRY_MESSAGE(pEntry) (U_MQTT_CLIENT_QUEUE_ENTRY_TOPIC(pEntry) + \
+                                                   (pEntry)->topicNameLength + 1)
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** An entry in the outbound queue; the null-terminated topic name
+ * and then the message follow this structure in the same allocation.
+ */
+typedef struct uMqttClientQueueEntry_t {
+    struct uMqttClientQueueEntry_t *pNext;
+    uint16_t topicNameLength; // Not including the null terminator
+    uint16_t messageSizeBytes;
+    uMqttQos_t qos;
+    bool retain;
+} uMqttClientQueueEntry_t;
+
+/** The outbound queue, hooked into pQueue of the MQTT context.
+ */
+typedef struct {
+    uMqttClientQueueEntry_t *pHead;
+    uMqttClientQueueEntry_t *pTail;
+    size_t maxNumMessages;
+    size_t maxNumBytes;
+    char fileName[U_MQTT_CLIENT_QUEUE_FILE_NAME_MAX_LENGTH_BYTES + 1]; // Empty if there is no file
+    uMqttClientQueueStats_t stats;
+} uMqttClientQueue_t;
+
+/** A node in the trie of message handlers: one per topic level,
+ * the null-terminated level (which may be "+" or "#") following
+ * the structure in the same allocation.
+ */
+typedef struct uMqttClientHandlerNode_t {
+    struct uMqttClientHandlerNode_t *pChild;   // The first node of the next level
+    struct uMqttClientHandlerNode_t *pSibling; // The next node at this level
+    uMqttClientHandler_t pHandler; // NULL if no filter ends here
+    void *pHandlerParam;
+} uMqttClientHandlerNode_t;
+
+/** The handlers that match a message; copies are kept, rather than
+ * pointers to the nodes, since a handler may remove a handler.
+ */
+typedef struct {
+    uMqttClientHandler_t pHandler[U_MQTT_CLIENT_DISPATCH_MATCH_MAX_NUM];
+    void *pHandlerParam[U_MQTT_CLIENT_DISPATCH_MATCH_MAX_NUM];
+    size_t numHandlers;
+} uMqttClientHandlerMatch_t;
+
+/** Somewhere to read the file copy of the outbound queue into.
+ */
+typedef struct {
+    char *pBuffer;
+    size_t size;
+} uMqttClientQueueFileRead_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -79,6 +155,16 @@
  */
 static uErrorCode_t gLastOpenError = U_ERROR_COMMON_SUCCESS;
 
+/** The total number of messages sent by all MQTT clients,
+ * registered with the metrics registry by pUMqttClientOpen().
+ */
+static uDeviceMetric_t gMetricTxMessages = U_DEVICE_METRIC_COUNTER("mqtt.tx_messages");
+
+/** The total number of messages received by all MQTT clients,
+ * registered with the metrics registry by pUMqttClientOpen().
+ */
+static uDeviceMetric_t gMetricRxMessages = U_DEVICE_METRIC_COUNTER("mqtt.rx_messages");
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -148,6 +234,475 @@ int32_t cellConnect(uDeviceHandle_t devHandle,
     return errorCode;
 }
 
+// Publish a message using the underlying API.
+// The mutex for this session must be locked before this is called.
+static int32_t publish(uMqttClientContext_t *pContext,
+                       const char *pTopicNameStr,
+                       const char *pMessage,
+                       size_t messageSizeBytes,
+                       uMqttQos_t qos, bool retain)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+
+    if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
+        errorCode = uCellMqttPublish(pContext->devHandle,
+                                     pTopicNameStr,
+                                     pMessage, messageSizeBytes,
+                                     (uCellMqttQos_t) qos, retain);
+    } else if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_SHORT_RANGE)) {
+        errorCode = uWifiMqttPublish(pContext,
+                                     pTopicNameStr,
+                                     pMessage, messageSizeBytes,
+                                     (uMqttQos_t)qos, retain);
+    }
+    if (errorCode == 0) {
+        pContext->totalMessagesSent++;
+        uDeviceMetricAdd(&gMetricTxMessages, 1);
+    }
+
+    return errorCode;
+}
+
+// Determine whether an MQTT session is active using the underlying API.
+// The mutex for this session must be locked before this is called.
+static bool isConnected(const uMqttClientContext_t *pContext)
+{
+    bool connected = false;
+
+    if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
+        connected = uCellMqttIsConnected(pContext->devHandle);
+    } else if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_SHORT_RANGE)) {
+        connected = uWifiMqttIsConnected(pContext);
+    }
+
+    return connected;
+}
+
+// Remove the entry at the head of the outbound queue.
+static void queueRemoveHead(uMqttClientQueue_t *pQueue)
+{
+    uMqttClientQueueEntry_t *pEntry = pQueue->pHead;
+
+    if (pEntry != NULL) {
+        pQueue->pHead = pEntry->pNext;
+        if (pQueue->pHead == NULL) {
+            pQueue->pTail = NULL;
+        }
+        pQueue->stats.numMessages--;
+        pQueue->stats.numBytes -= pEntry->topicNameLength + pEntry->messageSizeBytes;
+        uPortFree(pEntry);
+    }
+}
+
+// Add a message to the end of the outbound queue, dropping the
+// oldest to make room if necessary; pTopicName need not be
+// null-terminated.  Returns the number of messages dropped,
+// else negative error code.
+static int32_t queueAdd(uMqttClientQueue_t *pQueue,
+                        const char *pTopicName, size_t topicNameLength,
+                        const char *pMessage, size_t messageSizeBytes,
+                        uMqttQos_t qos, bool retain)
+{
+    int32_t errorCodeOrDropped = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    uMqttClientQueueEntry_t *pEntry;
+    size_t numBytes = topicNameLength + messageSizeBytes;
+
+    if ((topicNameLength > UINT16_MAX) || (messageSizeBytes > UINT16_MAX) ||
+        (numBytes > pQueue->maxNumBytes)) {
+        // Never going to fit
+        pQueue->stats.numDropped++;
+    } else {
+        errorCodeOrDropped = 0;
+        while ((pQueue->stats.numMessages >= pQueue->maxNumMessages) ||
+               (pQueue->stats.numBytes + numBytes > pQueue->maxNumBytes)) {
+            queueRemoveHead(pQueue);
+            pQueue->stats.numDropped++;
+            errorCodeOrDropped++;
+        }
+        pEntry = (uMqttClientQueueEntry_t *) pUPortMalloc(sizeof(*pEntry) + numBytes + 1);
+        if (pEntry != NULL) {
+            pEntry->pNext = NULL;
+            pEntry->topicNameLength = (uint16_t) topicNameLength;
+            pEntry->messageSizeBytes = (uint16_t) messageSizeBytes;
+            pEntry->qos = qos;
+            pEntry->retain = retain;
+            memcpy(U_MQTT_CLIENT_QUEUE_ENTRY_TOPIC(pEntry), pTopicName, topicNameLength);
+            *(U_MQTT_CLIENT_QUEUE_ENTRY_TOPIC(pEntry) + topicNameLength) = 0;
+            memcpy(U_MQTT_CLIENT_QUEUE_ENTRY_MESSAGE(pEntry), pMessage, messageSizeBytes);
+            if (pQueue->pTail != NULL) {
+                pQueue->pTail->pNext = pEntry;
+            } else {
+                pQueue->pHead = pEntry;
+            }
+            pQueue->pTail = pEntry;
+            pQueue->stats.numMessages++;
+            pQueue->stats.numBytes += numBytes;
+            if (pQueue->stats.numMessages > pQueue->stats.peakNumMessages) {
+                pQueue->stats.peakNumMessages = pQueue->stats.numMessages;
+            }
+        } else {
+            pQueue->stats.numDropped++;
+            errorCodeOrDropped = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        }
+    }
+
+    return errorCodeOrDropped;
+}
+
+// Append an entry of the outbound queue to the file copy.
+static int32_t queueFileAppend(uDeviceHandle_t devHandle,
+                               const uMqttClientQueue_t *pQueue,
+                               const uMqttClientQueueEntry_t *pEntry)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    size_t length = U_MQTT_CLIENT_QUEUE_FILE_HEADER_LENGTH_BYTES +
+                    pEntry->topicNameLength + pEntry->messageSizeBytes;
+    char *pBuffer = (char *) pUPortMalloc(length);
+
+    if (pBuffer != NULL) {
+        *pBuffer = (char) (pEntry->topicNameLength & 0xFF);
+        *(pBuffer + 1) = (char) (pEntry->topicNameLength >> 8);
+        *(pBuffer + 2) = (char) (pEntry->messageSizeBytes & 0xFF);
+        *(pBuffer + 3) = (char) (pEntry->messageSizeBytes >> 8);
+        *(pBuffer + 4) = (char) pEntry->qos;
+        *(pBuffer + 5) = (char) pEntry->retain;
+        memcpy(pBuffer + U_MQTT_CLIENT_QUEUE_FILE_HEADER_LENGTH_BYTES,
+               U_MQTT_CLIENT_QUEUE_ENTRY_TOPIC(pEntry), pEntry->topicNameLength);
+        memcpy(pBuffer + U_MQTT_CLIENT_QUEUE_FILE_HEADER_LENGTH_BYTES + pEntry->topicNameLength,
+               U_MQTT_CLIENT_QUEUE_ENTRY_MESSAGE(pEntry), pEntry->messageSizeBytes);
+        errorCode = uCellFileWrite(devHandle, pQueue->fileName, pBuffer, length);
+        if (errorCode >= 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+        uPortFree(pBuffer);
+    }
+
+    return errorCode;
+}
+
+// Bring the file copy of the outbound queue up to date with RAM.
+static void queueFileRewrite(uDeviceHandle_t devHandle,
+                             const uMqttClientQueue_t *pQueue)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+
+    // Ignore the error: the file may not be there
+    uCellFileDelete(devHandle, pQueue->fileName);
+    for (uMqttClientQueueEntry_t *pEntry = pQueue->pHead;
+         (pEntry != NULL) && (errorCode == 0);
+         pEntry = pEntry->pNext) {
+        errorCode = queueFileAppend(devHandle, pQueue, pEntry);
+    }
+}
+
+// Callback for uCellFileStreamRead() when reading the file copy of
+// the outbound queue.
+static bool queueFileReadCallback(uDeviceHandle_t devHandle,
+                                  const char *pData, size_t size,
+                                  size_t offset, void *pParam)
+{
+    uMqttClientQueueFileRead_t *pFileRead = (uMqttClientQueueFileRead_t *) pParam;
+    bool keepGoing = false;
+
+    (void) devHandle;
+
+    if (offset + size <= pFileRead->size) {
+        memcpy(pFileRead->pBuffer + offset, pData, size);
+        keepGoing = true;
+    }
+
+    return keepGoing;
+}
+
+// Load the file copy of the outbound queue into RAM, returning
+// the number of messages dropped.
+static int32_t queueFileLoad(uDeviceHandle_t devHandle,
+                             uMqttClientQueue_t *pQueue)
+{
+    int32_t errorCodeOrDropped = 0;
+    int32_t size = uCellFileSize(devHandle, pQueue->fileName);
+    uMqttClientQueueFileRead_t fileRead = {0};
+    size_t offset = 0;
+    size_t topicNameLength;
+    size_t messageSizeBytes;
+    // Access the buffer as a uint8_t to avoid maths funnies with
+    // chars being signed or unsigned
+    const uint8_t *pRecord;
+    int32_t x;
+
+    if (size > 0) {
+        errorCodeOrDropped = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        fileRead.pBuffer = (char *) pUPortMalloc(size);
+        if (fileRead.pBuffer != NULL) {
+            fileRead.size = (size_t) size;
+            errorCodeOrDropped = uCellFileStreamRead(devHandle, pQueue->fileName,
+                                                     queueFileReadCallback,
+                                                     &fileRead, 0);
+            if (errorCodeOrDropped == size) {
+                errorCodeOrDropped = 0;
+                while ((errorCodeOrDropped >= 0) &&
+                       (offset + U_MQTT_CLIENT_QUEUE_FILE_HEADER_LENGTH_BYTES <= fileRead.size)) {
+                    pRecord = (const uint8_t *) fileRead.pBuffer + offset;
+                    topicNameLength = *pRecord | ((size_t) *(pRecord + 1) << 8);
+                    messageSizeBytes = *(pRecord + 2) | ((size_t) *(pRecord + 3) << 8);
+                    pRecord += U_MQTT_CLIENT_QUEUE_FILE_HEADER_LENGTH_BYTES;
+                    offset += U_MQTT_CLIENT_QUEUE_FILE_HEADER_LENGTH_BYTES +
+                              topicNameLength + messageSizeBytes;
+                    if (offset <= fileRead.size) {
+                        x = queueAdd(pQueue,
+                                     (const char *) pRecord, topicNameLength,
+                                     (const char *) pRecord + topicNameLength,
+                                     messageSizeBytes,
+                                     (uMqttQos_t) * (pRecord - 2), *(pRecord - 1) != 0);
+                        if (x >= 0) {
+                            errorCodeOrDropped += x;
+                        } else {
+                            errorCodeOrDropped = x;
+                        }
+                    }
+                }
+            }
+            uPortFree(fileRead.pBuffer);
+        }
+    }
+
+    return errorCodeOrDropped;
+}
+
+// Send what is in the outbound queue, returning the number of
+// messages sent or negative error code if the connection is lost.
+// The mutex for this session must be locked before this is called.
+static int32_t queueDrain(uMqttClientContext_t *pContext)
+{
+    int32_t errorCodeOrCount = 0;
+    uMqttClientQueue_t *pQueue = (uMqttClientQueue_t *) pContext->pQueue;
+    uMqttClientQueueEntry_t *pEntry;
+    int32_t startTimeMs = uPortGetTickTimeMs();
+    int32_t bytesSent = 0;
+    int32_t x;
+    size_t batch = 0;
+
+    if (pQueue != NULL) {
+        while ((pQueue->pHead != NULL) && (errorCodeOrCount >= 0)) {
+            pEntry = pQueue->pHead;
+            x = publish(pContext, U_MQTT_CLIENT_QUEUE_ENTRY_TOPIC(pEntry),
+                        U_MQTT_CLIENT_QUEUE_ENTRY_MESSAGE(pEntry),
+                        pEntry->messageSizeBytes, pEntry->qos, pEntry->retain);
+            if (x == 0) {
+                errorCodeOrCount++;
+                bytesSent += pEntry->topicNameLength + pEntry->messageSizeBytes;
+                pQueue->stats.numDrained++;
+                pQueue->stats.bytesDrained += pEntry->topicNameLength + pEntry->messageSizeBytes;
+                queueRemoveHead(pQueue);
+                batch++;
+            } else if (isConnected(pContext)) {
+                // The broker doesn't like this message, which
+                // it isn't going to like any better next time
+                pQueue->stats.numDropped++;
+                queueRemoveHead(pQueue);
+                batch++;
+            } else {
+                // Lost the connection, leave the rest for later
+                errorCodeOrCount = x;
+            }
+            if ((pQueue->fileName[0] != 0) && (batch > 0) &&
+                ((batch >= U_MQTT_CLIENT_QUEUE_DRAIN_BATCH_SIZE) ||
+                 (pQueue->pHead == NULL) || (errorCodeOrCount < 0))) {
+                queueFileRewrite(pContext->devHandle, pQueue);
+                batch = 0;
+            }
+        }
+        if (bytesSent > 0) {
+            x = uPortGetTickTimeMs() - startTimeMs;
+            if (x <= 0) {
+                x = 1;
+            }
+            pQueue->stats.drainBytesPerSecond = (int32_t) (((int64_t) bytesSent * 1000) / x);
+        }
+    }
+
+    return errorCodeOrCount;
+}
+
+// Free the outbound queue.
+static void queueFree(uMqttClientContext_t *pContext)
+{
+    uMqttClientQueue_t *pQueue = (uMqttClientQueue_t *) pContext->pQueue;
+
+    if (pQueue != NULL) {
+        while (pQueue->pHead != NULL) {
+            queueRemoveHead(pQueue);
+        }
+        uPortFree(pQueue);
+        pContext->pQueue = NULL;
+    }
+}
+
+// Return the length of the topic level at pLevel, which ends
+// at a '/' or a null terminator.
+static size_t levelLength(const char *pLevel)
+{
+    const char *pEnd = strchr(pLevel, '/');
+
+    return (pEnd != NULL) ? (size_t) (pEnd - pLevel) : strlen(pLevel);
+}
+
+// Check that a topic filter is valid: '+' and '#' must be
+// a whole level and '#' must be the last level.
+static bool topicFilterIsValid(const char *pTopicFilterStr)
+{
+    bool isValid = true;
+    size_t length;
+
+    while (isValid && (pTopicFilterStr != NULL)) {
+        length = levelLength(pTopicFilterStr);
+        if ((memchr(pTopicFilterStr, '+', length) != NULL) ||
+            (memchr(pTopicFilterStr, '#', length) != NULL)) {
+            isValid = (length == 1) &&
+                      ((*pTopicFilterStr == '+') || (*(pTopicFilterStr + 1) == 0));
+        }
+        pTopicFilterStr = (*(pTopicFilterStr + length) == '/') ?
+                          pTopicFilterStr + length + 1 : NULL;
+    }
+
+    return isValid;
+}
+
+// Check whether the topic level of a node in the trie of message
+// handlers is the same as the one at pLevel.
+static bool levelIsEqual(const uMqttClientHandlerNode_t *pNode,
+                         const char *pLevel, size_t length)
+{
+    const char *pNodeLevel = U_MQTT_CLIENT_HANDLER_NODE_LEVEL(pNode);
+
+    return (strncmp(pNodeLevel, pLevel, length) == 0) && (*(pNodeLevel + length) == 0);
+}
+
+// Find the node for the topic level at pLevel in the list at
+// *ppList, adding it to the end of the list if it is not there.
+static uMqttClientHandlerNode_t *pHandlerNodeGet(uMqttClientHandlerNode_t **ppList,
+                                                 const char *pLevel, size_t length)
+{
+    uMqttClientHandlerNode_t *pNode = NULL;
+
+    while ((pNode == NULL) && (*ppList != NULL)) {
+        if (levelIsEqual(*ppList, pLevel, length)) {
+            pNode = *ppList;
+        } else {
+            ppList = &((*ppList)->pSibling);
+        }
+    }
+    if (pNode == NULL) {
+        pNode = (uMqttClientHandlerNode_t *) pUPortMalloc(sizeof(*pNode) + length + 1);
+        if (pNode != NULL) {
+            memset(pNode, 0, sizeof(*pNode));
+            memcpy(U_MQTT_CLIENT_HANDLER_NODE_LEVEL(pNode), pLevel, length);
+            *(U_MQTT_CLIENT_HANDLER_NODE_LEVEL(pNode) + length) = 0;
+            *ppList = pNode;
+        }
+    }
+
+    return pNode;
+}
+
+// Remove the handler for the topic filter at pTopicFilterStr from
+// the list at *ppList, freeing any nodes that are no longer needed.
+static bool handlerRemove(uMqttClientHandlerNode_t **ppList,
+                          const char *pTopicFilterStr)
+{
+    bool found = false;
+    bool looking = true;
+    uMqttClientHandlerNode_t *pNode;
+    size_t length = levelLength(pTopicFilterStr);
+
+    while (looking && (*ppList != NULL)) {
+        pNode = *ppList;
+        if (levelIsEqual(pNode, pTopicFilterStr, length)) {
+            // Each level appears only once in a list
+            looking = false;
+            if (*(pTopicFilterStr + length) == '/') {
+                found = handlerRemove(&(pNode->pChild), pTopicFilterStr + length + 1);
+            } else if (pNode->pHandler != NULL) {
+                pNode->pHandler = NULL;
+                found = true;
+            }
+            if (found && (pNode->pHandler == NULL) && (pNode->pChild == NULL)) {
+                // Nothing hangs off this node any more
+                *ppList = pNode->pSibling;
+                uPortFree(pNode);
+            }
+        } else {
+            ppList = &(pNode->pSibling);
+        }
+    }
+
+    return found;
+}
+
+// Free a list of nodes in the trie of message handlers and
+// everything below them.
+static void handlerFree(uMqttClientHandlerNode_t *pList)
+{
+    uMqttClientHandlerNode_t *pNext;
+
+    while (pList != NULL) {
+        pNext = pList->pSibling;
+        handlerFree(pList->pChild);
+        uPortFree(pList);
+        pList = pNext;
+    }
+}
+
+// Add a node of the trie of message handlers to a match, if
+// it has a handler and there is room.
+static void handlerMatchAdd(uMqttClientHandlerMatch_t *pMatch,
+                            const uMqttClientHandlerNode_t *pNode)
+{
+    if ((pNode->pHandler != NULL) &&
+        (pMatch->numHandlers < sizeof(pMatch->pHandler) / sizeof(pMatch->pHandler[0]))) {
+        pMatch->pHandler[pMatch->numHandlers] = pNode->pHandler;
+        pMatch->pHandlerParam[pMatch->numHandlers] = pNode->pHandlerParam;
+        pMatch->numHandlers++;
+    }
+}
+
+// Find the handlers in the list pList, and below, which match the
+// topic whose level starts at pTopic.
+static void handlerMatch(const uMqttClientHandlerNode_t *pList,
+                         const char *pTopic, bool firstLevel,
+                         uMqttClientHandlerMatch_t *pMatch)
+{
+    size_t length = levelLength(pTopic);
+    bool lastLevel = (*(pTopic + length) == 0);
+    // Wildcards at the first level don't match topics beginning
+    // with '$', e.g. "$SYS"
+    bool wildcardsAllowed = !firstLevel || (*pTopic != '$');
+    const char *pNodeLevel;
+
+    for (const uMqttClientHandlerNode_t *pNode = pList; pNode != NULL; pNode = pNode->pSibling) {
+        pNodeLevel = U_MQTT_CLIENT_HANDLER_NODE_LEVEL(pNode);
+        if (strcmp(pNodeLevel, "#") == 0) {
+            if (wildcardsAllowed) {
+                handlerMatchAdd(pMatch, pNode);
+            }
+        } else if ((wildcardsAllowed && (strcmp(pNodeLevel, "+") == 0)) ||
+                   levelIsEqual(pNode, pTopic, length)) {
+            if (lastLevel) {
+                handlerMatchAdd(pMatch, pNode);
+                // "a/#" also matches "a"
+                for (const uMqttClientHandlerNode_t *pChild = pNode->pChild; pChild != NULL;
+                     pChild = pChild->pSibling) {
+                    if (strcmp(U_MQTT_CLIENT_HANDLER_NODE_LEVEL(pChild), "#") == 0) {
+                        handlerMatchAdd(pMatch, pChild);
+                    }
+                }
+            } else {
+                handlerMatch(pNode->pChild, pTopic + length + 1, false, pMatch);
+            }
+        }
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: MQTT AND MQTT-SN
  * -------------------------------------------------------------- */
@@ -182,6 +737,9 @@ uMqttClientContext_t *pUMqttClientOpen(uDeviceHandle_t devHandle,
     }
 
     if (gLastOpenError == U_ERROR_COMMON_SUCCESS) {
+        // Not finding room in the registry is not an error
+        uDeviceMetricRegister(&gMetricTxMessages);
+        uDeviceMetricRegister(&gMetricRxMessages);
         gLastOpenError = U_ERROR_COMMON_NO_MEMORY;
         pContext = (uMqttClientContext_t *) pUPortMalloc(sizeof(*pContext));
         if (pContext != NULL) {
@@ -191,6 +749,8 @@ uMqttClientContext_t *pUMqttClientOpen(uDeviceHandle_t devHandle,
             pContext->totalMessagesSent = 0;
             pContext->totalMessagesReceived = 0;
             pContext->pPriv = pPriv;
+            pContext->pQueue = NULL;
+            pContext->pHandlers = NULL;
             if (uPortMutexCreate((uPortMutexHandle_t *) & (pContext->mutexHandle)) == 0) {
                 gLastOpenError = U_ERROR_COMMON_SUCCESS;
                 if (pSecurityTlsSettings != NULL) {
@@ -254,6 +814,9 @@ void uMqttClientClose(uMqttClientContext_t *pContext)
             uSecurityTlsRemove(pContext->pSecurityContext);
         }
 
+        queueFree(pContext);
+        handlerFree((uMqttClientHandlerNode_t *) pContext->pHandlers);
+
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
         uPortMutexDelete((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -287,6 +850,12 @@ int32_t uMqttClientConnect(uMqttClientContext_t *pContext,
             errorCode = uWifiMqttConnect(pContext, pConnection);
         }
 
+        if (errorCode == 0) {
+            // Send anything that was queued while we were
+            // not connected
+            queueDrain(pContext);
+        }
+
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
     }
 
@@ -318,22 +887,18 @@ int32_t uMqttClientDisconnect(const uMqttClientContext_t *pContext)
 // Determine whether an MQTT session is active or not.
 bool uMqttClientIsConnected(const uMqttClientContext_t *pContext)
 {
-    bool isConnected = false;
+    bool connected = false;
 
     if (pContext != NULL) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            isConnected = uCellMqttIsConnected(pContext->devHandle);
-        } else if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_SHORT_RANGE)) {
-            isConnected = uWifiMqttIsConnected(pContext);
-        }
+        connected = isConnected(pContext);
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
     }
 
-    return isConnected;
+    return connected;
 }
 
 // Set a callback to be called on new message arrival.
@@ -470,26 +1035,39 @@ int32_t uMqttClientPublish(uMqttClientContext_t *pContext,
                            uMqttQos_t qos, bool retain)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uMqttClientQueue_t *pQueue;
+    bool queueIt = false;
 
     if ((pContext != NULL) && (pTopicNameStr != NULL) &&
         (pMessage != NULL) && (messageSizeBytes > 0)) {
-        errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            errorCode = uCellMqttPublish(pContext->devHandle,
-                                         pTopicNameStr,
-                                         pMessage, messageSizeBytes,
-                                         (uCellMqttQos_t) qos, retain);
-        } else if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_SHORT_RANGE)) {
-            errorCode = uWifiMqttPublish(pContext,
-                                         pTopicNameStr,
-                                         pMessage, messageSizeBytes,
-                                         (uMqttQos_t)qos, retain);
+        pQueue = (uMqttClientQueue_t *) pContext->pQueue;
+        if (pQueue != NULL) {
+            // Keep things in order: anything already queued
+            // must go first
+            queueIt = !isConnected(pContext) || (queueDrain(pContext) < 0);
         }
-        if (errorCode == 0) {
-            pContext->totalMessagesSent++;
+        if (!queueIt) {
+            errorCode = publish(pContext, pTopicNameStr, pMessage,
+                                messageSizeBytes, qos, retain);
+            queueIt = (errorCode < 0) && (pQueue != NULL) && !isConnected(pContext);
+        }
+        if (queueIt) {
+            errorCode = queueAdd(pQueue, pTopicNameStr, strlen(pTopicNameStr),
+                                 pMessage, messageSizeBytes, qos, retain);
+            if ((errorCode >= 0) && (pQueue->fileName[0] != 0)) {
+                if (errorCode > 0) {
+                    // Older messages were dropped, start again
+                    queueFileRewrite(pContext->devHandle, pQueue);
+                } else {
+                    queueFileAppend(pContext->devHandle, pQueue, pQueue->pTail);
+                }
+            }
+            if (errorCode > 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -584,7 +1162,190 @@ int32_t uMqttClientMessageRead(uMqttClientContext_t *pContext,
         }
         if (errorCode == 0) {
             pContext->totalMessagesReceived++;
+            uDeviceMetricAdd(&gMetricRxMessages, 1);
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+    }
+
+    return errorCode;
+}
+
+// Enable an outbound queue.
+int32_t uMqttClientQueueEnable(uMqttClientContext_t *pContext,
+                               size_t maxNumMessages,
+                               size_t maxNumBytes,
+                               const char *pFileNameStr)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uMqttClientQueue_t *pQueue;
+
+    if ((pContext != NULL) && (maxNumMessages > 0) && (maxNumBytes > 0) &&
+        ((pFileNameStr == NULL) ||
+         (strlen(pFileNameStr) <= U_MQTT_CLIENT_QUEUE_FILE_NAME_MAX_LENGTH_BYTES))) {
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+
+        errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pContext->pQueue == NULL) {
+            errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            // Only cellular modules have a file system we can use
+            if ((pFileNameStr == NULL) ||
+                U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
+                errorCodeOrCount = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                pQueue = (uMqttClientQueue_t *) pUPortMalloc(sizeof(*pQueue));
+                if (pQueue != NULL) {
+                    memset(pQueue, 0, sizeof(*pQueue));
+                    pQueue->maxNumMessages = maxNumMessages;
+                    pQueue->maxNumBytes = maxNumBytes;
+                    pQueue->stats.drainBytesPerSecond = -1;
+                    pContext->pQueue = pQueue;
+                    errorCodeOrCount = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    if (pFileNameStr != NULL) {
+                        strncpy(pQueue->fileName, pFileNameStr, sizeof(pQueue->fileName));
+                        // Pick up anything left from last time
+                        if (queueFileLoad(pContext->devHandle, pQueue) > 0) {
+                            // It didn't all fit, start the file again
+                            queueFileRewrite(pContext->devHandle, pQueue);
+                        }
+                    }
+                    errorCodeOrCount = (int32_t) pQueue->stats.numMessages;
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+    }
+
+    return errorCodeOrCount;
+}
+
+// Send whatever is in the outbound queue.
+int32_t uMqttClientQueueDrain(uMqttClientContext_t *pContext)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pContext != NULL) {
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+
+        errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+        if (pContext->pQueue != NULL) {
+            errorCodeOrCount = 0;
+            if (isConnected(pContext)) {
+                errorCodeOrCount = queueDrain(pContext);
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+    }
+
+    return errorCodeOrCount;
+}
+
+// Throw away everything in the outbound queue.
+int32_t uMqttClientQueueClear(uMqttClientContext_t *pContext)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uMqttClientQueue_t *pQueue;
+
+    if (pContext != NULL) {
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+
+        errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+        pQueue = (uMqttClientQueue_t *) pContext->pQueue;
+        if (pQueue != NULL) {
+            errorCodeOrCount = (int32_t) pQueue->stats.numMessages;
+            while (pQueue->pHead != NULL) {
+                queueRemoveHead(pQueue);
+            }
+            if (pQueue->fileName[0] != 0) {
+                // Ignore the error: the file may not be there
+                uCellFileDelete(pContext->devHandle, pQueue->fileName);
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+    }
+
+    return errorCodeOrCount;
+}
+
+// Disable the outbound queue.
+void uMqttClientQueueDisable(uMqttClientContext_t *pContext)
+{
+    if (pContext != NULL) {
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+
+        queueFree(pContext);
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+    }
+}
+
+// Get the statistics of the outbound queue.
+int32_t uMqttClientQueueGetStats(const uMqttClientContext_t *pContext,
+                                 uMqttClientQueueStats_t *pStats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uMqttClientQueue_t *pQueue;
+
+    if ((pContext != NULL) && (pStats != NULL)) {
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+        pQueue = (const uMqttClientQueue_t *) pContext->pQueue;
+        if (pQueue != NULL) {
+            *pStats = pQueue->stats;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+    }
+
+    return errorCode;
+}
+
+// Add a handler for messages on a topic filter.
+int32_t uMqttClientHandlerAdd(uMqttClientContext_t *pContext,
+                              const char *pTopicFilterStr,
+                              uMqttClientHandler_t pHandler,
+                              void *pHandlerParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uMqttClientHandlerNode_t **ppList;
+    uMqttClientHandlerNode_t *pNode = NULL;
+    size_t length;
+
+    if ((pContext != NULL) && (pTopicFilterStr != NULL) && (pHandler != NULL) &&
+        topicFilterIsValid(pTopicFilterStr)) {
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        ppList = (uMqttClientHandlerNode_t **) &(pContext->pHandlers);
+        // Walk down the trie one level at a time, adding
+        // nodes as necessary
+        while (ppList != NULL) {
+            length = levelLength(pTopicFilterStr);
+            pNode = pHandlerNodeGet(ppList, pTopicFilterStr, length);
+            ppList = NULL;
+            if ((pNode != NULL) && (*(pTopicFilterStr + length) == '/')) {
+                ppList = &(pNode->pChild);
+                pTopicFilterStr += length + 1;
+            }
+        }
+        if (pNode != NULL) {
+            pNode->pHandler = pHandler;
+            pNode->pHandlerParam = pHandlerParam;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
         }
+        // Note: if we ran out of memory part way down, the nodes
+        // that were added are left in place, unused, until the
+        // client is closed; they do no harm
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
     }
@@ -592,6 +1353,81 @@ int32_t uMqttClientMessageRead(uMqttClientContext_t *pContext,
     return errorCode;
 }
 
+// Remove a handler.
+int32_t uMqttClientHandlerRemove(uMqttClientContext_t *pContext,
+                                 const char *pTopicFilterStr)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pContext != NULL) && (pTopicFilterStr != NULL)) {
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        if (handlerRemove((uMqttClientHandlerNode_t **) &(pContext->pHandlers),
+                          pTopicFilterStr)) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+    }
+
+    return errorCode;
+}
+
+// Read all unread messages and pass them to the matching handlers.
+int32_t uMqttClientHandlerDispatch(uMqttClientContext_t *pContext)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    char *pTopicNameStr;
+    char *pMessage;
+    size_t messageSizeBytes;
+    uMqttQos_t qos;
+    uMqttClientHandlerMatch_t match;
+    int32_t x;
+
+    if (pContext != NULL) {
+        errorCodeOrCount = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        // One allocation for both topic and message
+        pTopicNameStr = (char *) pUPortMalloc(U_MQTT_CLIENT_DISPATCH_TOPIC_MAX_LENGTH_BYTES +
+                                              U_MQTT_CLIENT_DISPATCH_MESSAGE_MAX_LENGTH_BYTES);
+        if (pTopicNameStr != NULL) {
+            pMessage = pTopicNameStr + U_MQTT_CLIENT_DISPATCH_TOPIC_MAX_LENGTH_BYTES;
+            errorCodeOrCount = 0;
+            x = uMqttClientGetUnread(pContext);
+            while (x > 0) {
+                messageSizeBytes = U_MQTT_CLIENT_DISPATCH_MESSAGE_MAX_LENGTH_BYTES;
+                qos = U_MQTT_QOS_AT_MOST_ONCE;
+                x = uMqttClientMessageRead(pContext, pTopicNameStr,
+                                           U_MQTT_CLIENT_DISPATCH_TOPIC_MAX_LENGTH_BYTES,
+                                           pMessage, &messageSizeBytes, &qos);
+                if (x == 0) {
+                    // Find the handlers with the lock on but call
+                    // them with it off so that they may call us
+                    match.numHandlers = 0;
+                    U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+                    handlerMatch((const uMqttClientHandlerNode_t *) pContext->pHandlers,
+                                 pTopicNameStr, true, &match);
+                    U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+                    for (size_t y = 0; y < match.numHandlers; y++) {
+                        match.pHandler[y](pTopicNameStr, pMessage, messageSizeBytes,
+                                          qos, match.pHandlerParam[y]);
+                    }
+                    if (match.numHandlers > 0) {
+                        errorCodeOrCount++;
+                    }
+                    x = uMqttClientGetUnread(pContext);
+                } else {
+                    errorCodeOrCount = x;
+                }
+            }
+            uPortFree(pTopicNameStr);
+        }
+    }
+
+    return errorCodeOrCount;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: MQTT-SN ONLY
  * -------------------------------------------------------------- */
@@ -749,6 +1585,26 @@ int32_t uMqttClientSnRegisterNormalTopic(const uMqttClientContext_t *pContext,
     return errorCode;
 }
 
+// Forget remembered MQTT-SN topic IDs.
+int32_t uMqttClientSnTopicCacheClear(const uMqttClientContext_t *pContext)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pContext != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+
+        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
+            errorCode = uCellMqttSnTopicCacheClear(pContext->devHandle);
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+    }
+
+    return errorCode;
+}
+
 // Publish a message.
 int32_t uMqttClientSnPublish(uMqttClientContext_t *pContext,
                              const uMqttSnTopicName_t *pTopicName,
@@ -773,6 +1629,7 @@ int32_t uMqttClientSnPublish(uMqttClientContext_t *pContext,
         }
         if (errorCode == 0) {
             pContext->totalMessagesSent++;
+            uDeviceMetricAdd(&gMetricTxMessages, 1);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -902,6 +1759,7 @@ int32_t uMqttClientSnMessageRead(uMqttClientContext_t *pContext,
         }
         if (errorCode == 0) {
             pContext->totalMessagesReceived++;
+            uDeviceMetricAdd(&gMetricRxMessages, 1);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -257,6 +257,25 @@ static void disconnectCallback(int32_t errorCode, void *pParam)
 
     gDisconnectCallbackCalled = true;
 }
+
+// Message handler for uMqttClientHandlerDispatch(): the parameter
+// is a counter to increment.
+static void messageHandler(const char *pTopicNameStr,
+                           const char *pMessage,
+                           size_t messageSizeBytes,
+                           uMqttQos_t qos, void *pHandlerParam)
+{
+    int32_t *pCount = (int32_t *) pHandlerParam;
+
+    (void) pTopicNameStr;
+    (void) pMessage;
+    (void) qos;
+
+    if (messageSizeBytes == U_MQTT_CLIENT_TEST_PUBLISH_MAX_LENGTH_BYTES) {
+        (*pCount)++;
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: TESTS
  * -------------------------------------------------------------- */
@@ -271,6 +290,8 @@ U_PORT_TEST_FUNCTION("[mqttClient]", "mqttClient")
     int32_t heapXxxSecurityInitLoss = 0;
     uMqttClientConnection_t connection = U_MQTT_CLIENT_CONNECTION_DEFAULT;
     uSecurityTlsSettings_t tlsSettings = U_SECURITY_TLS_SETTINGS_DEFAULT;
+    uMqttClientQueueStats_t queueStats;
+    int32_t handlerCount[3];
     int32_t y;
     int32_t z;
     size_t s;
@@ -373,6 +394,18 @@ U_PORT_TEST_FUNCTION("[mqttClient]", "mqttClient")
                 }
                 connection.pKeepGoingCallback = keepGoingCallback;
 
+                if (noTls) {
+                    // Publishing while not connected should queue the message
+                    U_TEST_PRINT_LINE_MQTT("queueing a message while not connected...");
+                    U_PORT_TEST_ASSERT(uMqttClientQueueEnable(gpMqttContextA, 4, 512, NULL) == 0);
+                    U_PORT_TEST_ASSERT(uMqttClientPublish(gpMqttContextA, pTopicOut, gSendData,
+                                                          sizeof(gSendData) - 1,
+                                                          U_MQTT_QOS_AT_LEAST_ONCE, false) == 0);
+                    U_PORT_TEST_ASSERT(uMqttClientQueueGetStats(gpMqttContextA, &queueStats) == 0);
+                    U_PORT_TEST_ASSERT(queueStats.numMessages == 1);
+                    U_PORT_TEST_ASSERT(queueStats.numDrained == 0);
+                }
+
                 // Connect it
                 U_TEST_PRINT_LINE_MQTT("connecting to \"%s\"...", connection.pBrokerNameStr);
                 startTimeMs = uPortGetTickTimeMs();
@@ -391,6 +424,18 @@ U_PORT_TEST_FUNCTION("[mqttClient]", "mqttClient")
                     U_PORT_TEST_ASSERT(uMqttClientIsConnected(gpMqttContextA));
                     U_PORT_TEST_ASSERT(!gDisconnectCallbackCalled);
 
+                    if (noTls) {
+                        // Connecting should have sent the queued message; there
+                        // is no subscription yet so it won't come back to us
+                        U_PORT_TEST_ASSERT(uMqttClientQueueGetStats(gpMqttContextA, &queueStats) == 0);
+                        U_TEST_PRINT_LINE_MQTT("%d queued message(s) sent at %d byte(s)/second.",
+                                               queueStats.numDrained, queueStats.drainBytesPerSecond);
+                        U_PORT_TEST_ASSERT(queueStats.numMessages == 0);
+                        U_PORT_TEST_ASSERT(queueStats.numDrained == 1);
+                        U_PORT_TEST_ASSERT(queueStats.numDropped == 0);
+                        uMqttClientQueueDisable(gpMqttContextA);
+                    }
+
                     // Set the message indication callback
                     U_PORT_TEST_ASSERT(uMqttClientSetMessageCallback(gpMqttContextA,
                                                                      messageIndicationCallback,
@@ -509,6 +554,43 @@ U_PORT_TEST_FUNCTION("[mqttClient]", "mqttClient")
 
                     U_PORT_TEST_ASSERT(uMqttClientGetUnread(gpMqttContextA) == 0);
 
+                    // Do it again, this time through message handlers:
+                    // the first two should match, the last should not
+                    memset(handlerCount, 0, sizeof(handlerCount));
+                    U_PORT_TEST_ASSERT(uMqttClientHandlerAdd(gpMqttContextA, "ubx_test/+",
+                                                             messageHandler,
+                                                             &(handlerCount[0])) == 0);
+                    U_PORT_TEST_ASSERT(uMqttClientHandlerAdd(gpMqttContextA, "ubx_test/#",
+                                                             messageHandler,
+                                                             &(handlerCount[1])) == 0);
+                    U_PORT_TEST_ASSERT(uMqttClientHandlerAdd(gpMqttContextA, "ubx_test/+/x",
+                                                             messageHandler,
+                                                             &(handlerCount[2])) == 0);
+                    gNumUnread = 0;
+                    gStopTimeMs = uPortGetTickTimeMs() +
+                                  (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000);
+                    U_PORT_TEST_ASSERT(uMqttClientPublish(gpMqttContextA, pTopicOut,
+                                                          pMessageOut,
+                                                          U_MQTT_CLIENT_TEST_PUBLISH_MAX_LENGTH_BYTES,
+                                                          U_MQTT_QOS_EXACTLY_ONCE, false) == 0);
+                    startTimeMs = uPortGetTickTimeMs();
+                    while ((gNumUnread == 0) &&
+                           (uPortGetTickTimeMs() < startTimeMs +
+                            (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000))) {
+                        uPortTaskBlock(1000);
+                    }
+                    U_PORT_TEST_ASSERT(uMqttClientHandlerDispatch(gpMqttContextA) == 1);
+                    U_TEST_PRINT_LINE_MQTT("message handlers called %d, %d and %d time(s).",
+                                           handlerCount[0], handlerCount[1], handlerCount[2]);
+                    U_PORT_TEST_ASSERT((handlerCount[0] == 1) && (handlerCount[1] == 1) &&
+                                       (handlerCount[2] == 0));
+                    U_PORT_TEST_ASSERT(uMqttClientHandlerRemove(gpMqttContextA, "ubx_test/+") == 0);
+                    U_PORT_TEST_ASSERT(uMqttClientHandlerRemove(gpMqttContextA, "ubx_test/+") < 0);
+                    U_PORT_TEST_ASSERT(uMqttClientHandlerRemove(gpMqttContextA, "ubx_test/#") == 0);
+                    U_PORT_TEST_ASSERT(uMqttClientHandlerRemove(gpMqttContextA,
+                                                                "ubx_test/+/x") == 0);
+                    U_PORT_TEST_ASSERT(uMqttClientGetUnread(gpMqttContextA) == 0);
+
                     // Cancel the subscribe
                     U_TEST_PRINT_LINE_MQTT("unsubscribing from topic \"%s\"...", pTopicOut);
                     gStopTimeMs = uPortGetTickTimeMs() +
@@ -819,6 +901,14 @@ U_PORT_TEST_FUNCTION("[mqttClient]", "mqttClientSn")
                                            U_MQTT_SN_TOPIC_NAME_TYPE_ID_NORMAL);
                         U_PORT_TEST_ASSERT(uMqttClientSnGetTopicId(&topicNameOut) >= 0);
                         U_PORT_TEST_ASSERT(uMqttClientSnGetTopicNameShort(&topicNameOut, topicNameShortStr) < 0);
+                        // Registering the same topic again must give the same ID,
+                        // whether it comes from the broker or from the topic cache
+                        memset(&topicNameIn, 0xFF, sizeof(topicNameIn));
+                        U_PORT_TEST_ASSERT(uMqttClientSnRegisterNormalTopic(gpMqttContextA, pTopicNameOutMqtt,
+                                                                            &topicNameIn) == 0);
+                        U_PORT_TEST_ASSERT(uMqttClientSnGetTopicId(&topicNameIn) ==
+                                           uMqttClientSnGetTopicId(&topicNameOut));
+                        U_PORT_TEST_ASSERT(uMqttClientSnTopicCacheClear(gpMqttContextA) == 0);
                     }
                 }
 
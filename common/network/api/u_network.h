@@ -71,6 +71,21 @@ extern "C" {
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_NETWORK_UP_TASK_STACK_SIZE_BYTES
+/** The stack size of the task that uNetworkInterfaceUpAsync()
+ * creates to bring a network up; this has to cope with all that
+ * uNetworkInterfaceUp() does.
+ */
+# define U_NETWORK_UP_TASK_STACK_SIZE_BYTES 3072
+#endif
+
+#ifndef U_NETWORK_UP_TASK_PRIORITY
+/** The priority of the task that uNetworkInterfaceUpAsync()
+ * creates to bring a network up.
+ */
+# define U_NETWORK_UP_TASK_PRIORITY U_CFG_OS_APP_TASK_PRIORITY
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -228,11 +243,81 @@ typedef struct {
  *                         type and allow cross-checking.
  *                         Can be set to NULL on subsequent calls
  *                         if the configuration is unchanged.
- * @return                 zero on success else negative error code.
+ * @return                 zero on success else negative error code;
+ *                         #U_ERROR_COMMON_TEMPORARY_FAILURE if the
+ *                         network is already being brought up,
+ *                         e.g. by uNetworkInterfaceUpAsync().
  */
 int32_t uNetworkInterfaceUp(uDeviceHandle_t devHandle, uNetworkType_t netType,
                             const void *pCfg);
 
+/** Bring up the given network interface on a device, as
+ * uNetworkInterfaceUp() does, but in a task of its own, returning
+ * immediately; pCallback is called from that task with the outcome,
+ * i.e. the value uNetworkInterfaceUp() would have returned, which
+ * for cellular means that the PDP context is active and an IP
+ * address has been assigned.  Since the device API is not locked
+ * while a network is brought up, networks on different devices,
+ * e.g. cellular and Wi-Fi, may be brought up at the same time.
+ *
+ * Progress along the way is reported through uNetworkSetStatusCallback(),
+ * which may be called before the first bring-up for this purpose;
+ * for cellular the callback is called as registration is achieved
+ * on each domain, the packet-switched domain being registration for
+ * data (i.e. attach), and for Wi-Fi as the connection to the access
+ * point is made.
+ *
+ * While the bring-up is in progress uNetworkInterfaceDown() and
+ * uDeviceClose() will return #U_ERROR_COMMON_TEMPORARY_FAILURE;
+ * call uNetworkInterfaceUpCancel() and wait for pCallback to be
+ * called first.
+ *
+ * @param devHandle              the handle of the device carrying
+ *                               the network.
+ * @param netType                which of the network interfaces to
+ *                               bring up.
+ * @param[in] pCfg               a pointer to the configuration, as
+ *                               for uNetworkInterfaceUp().
+ * @param[in] pCallback          the function to call when the
+ *                               bring-up has completed, cannot be
+ *                               NULL; the parameters are devHandle,
+ *                               netType, zero on success else
+ *                               negative error code, and
+ *                               pCallbackParameter.  As for the
+ *                               status callback, ubxlib APIs should
+ *                               not be called from pCallback.
+ * @param[in] pCallbackParameter a parameter to pass to pCallback;
+ *                               may be NULL.
+ * @return                       zero if the bring-up has been
+ *                               started, in which case pCallback
+ *                               will be called, else negative
+ *                               error code.
+ */
+int32_t uNetworkInterfaceUpAsync(uDeviceHandle_t devHandle,
+                                 uNetworkType_t netType,
+                                 const void *pCfg,
+                                 void (*pCallback) (uDeviceHandle_t,
+                                                    uNetworkType_t,
+                                                    int32_t,
+                                                    void *),
+                                 void *pCallbackParameter);
+
+/** Cancel the bring-up of a network interface that is in progress,
+ * whether started by uNetworkInterfaceUpAsync() or by
+ * uNetworkInterfaceUp() in another task; the bring-up will fail
+ * as if it had timed out.  This is supported for cellular, where
+ * it takes effect at the next check of the keep-going callback,
+ * and Wi-Fi, where it takes effect within a second; BLE and GNSS
+ * are not cancelled since they do not wait on a network.
+ *
+ * @param devHandle the handle of the device carrying the network.
+ * @param netType   the network interface.
+ * @return          zero on success, including the case where
+ *                  nothing was being brought up, else negative
+ *                  error code.
+ */
+int32_t uNetworkInterfaceUpCancel(uDeviceHandle_t devHandle, uNetworkType_t netType);
+
 /** Take down the given network interface on a device, disconnecting
  * it from any peer entity.  After this function returns
  * uNetworkInterfaceUp() must be called once more to ensure that the
@@ -247,7 +332,10 @@ int32_t uNetworkInterfaceUp(uDeviceHandle_t devHandle, uNetworkType_t netType,
  * @param devHandle the handle of the device that is carrying the
  *                  network.
  * @param netType   which of the module interfaces to take down.
- * @return          zero on success else negative error code.
+ * @return          zero on success else negative error code;
+ *                  #U_ERROR_COMMON_TEMPORARY_FAILURE if the
+ *                  network is being brought up, see
+ *                  uNetworkInterfaceUpCancel().
  */
 int32_t uNetworkInterfaceDown(uDeviceHandle_t devHandle, uNetworkType_t netType);
 
@@ -295,7 +383,9 @@ int32_t uNetworkInterfaceDown(uDeviceHandle_t devHandle, uNetworkType_t netType)
  *
  * The callback will be called in a task with a stack of size
  * #U_AT_CLIENT_CALLBACK_TASK_STACK_SIZE_BYTES (see u_at_client.h).
- * Calling uNetworkInterfaceDown() will cancel the callback.
+ * Calling uNetworkInterfaceDown() will cancel the callback.  This
+ * function may be called before the network is first brought up,
+ * in order to follow the progress of the bring-up.
  *
  * @param devHandle               the handle of the device carrying
  *                                the network.
@@ -317,6 +407,53 @@ int32_t uNetworkSetStatusCallback(uDeviceHandle_t devHandle,
                                   uNetworkStatusCallback_t pCallback,
                                   void *pCallbackParameter);
 
+/** Set a hold-off on the network status callback of a cellular or
+ * Wi-Fi network, so that only stable status changes are delivered.
+ * In poor coverage registration may flap many times a second and,
+ * without a hold-off, every flap reaches the callback set with
+ * uNetworkSetStatusCallback().  With a hold-off, a status change
+ * is held until no further status change has arrived for holdOffMs;
+ * only then is the latest status delivered, and only if it differs
+ * from the status last delivered.  Status changes that are absorbed
+ * in this way are counted, see uNetworkGetStatusFlapCount().  For
+ * cellular the packet-switched and circuit-switched domains are
+ * coalesced separately.
+ *
+ * While a hold-off is set the status callback is called from a
+ * timer task rather than from the AT callback task; the stack size
+ * of the timer task is OS-specific so, as ever, keep the callback
+ * short and do NOT call ubxlib APIs from it.
+ *
+ * The hold-off may be set before or after uNetworkSetStatusCallback()
+ * is called; it is removed by uNetworkInterfaceDown().  This is not
+ * supported for BLE or GNSS.
+ *
+ * @param devHandle the handle of the device carrying the network.
+ * @param netType   the network interface, #U_NETWORK_TYPE_CELL or
+ *                  #U_NETWORK_TYPE_WIFI.
+ * @param holdOffMs the hold-off in milliseconds; use zero to deliver
+ *                  every status change as it happens, which is the
+ *                  default.
+ * @return          zero on success else negative error code.
+ */
+int32_t uNetworkSetStatusHoldOff(uDeviceHandle_t devHandle,
+                                 uNetworkType_t netType,
+                                 int32_t holdOffMs);
+
+/** Get the number of status changes of a network that have been
+ * absorbed by the hold-off set with uNetworkSetStatusHoldOff(),
+ * i.e. the number of times the up/down state of the network changed
+ * while a previous change was still being held.  The count is reset
+ * when a hold-off is set.
+ *
+ * @param devHandle the handle of the device carrying the network.
+ * @param netType   the network interface.
+ * @return          on success the flap count, else negative
+ *                  error code.
+ */
+int32_t uNetworkGetStatusFlapCount(uDeviceHandle_t devHandle,
+                                   uNetworkType_t netType);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,315 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_NETWORK_SELECT_H_
+#define _U_NETWORK_SELECT_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_device.h"
+#include "u_network.h" // uNetworkType_t
+#include "u_sock.h"    // uSockStats_t
+
+/** \addtogroup network Network
+ *  @{
+ */
+
+/** @file
+ * @brief Selection between several network bearers, e.g. a Wi-Fi
+ * network and a cellular network that are both up, based on how
+ * well each of them is measured to perform.  For each bearer an
+ * estimate of round-trip time and throughput is kept, smoothed over
+ * the samples that the application reports (directly, or from the
+ * #uSockStats_t of its sockets), along with the latest signal
+ * strength (e.g. from uCellInfoRadioSamplerGet()) and a relative
+ * cost set when the bearer is added.  From these a score is
+ * derived and uNetworkSelectGetBest() returns the device handle
+ * that new sockets or MQTT sessions should be opened on.
+ *
+ * Failover is driven by uNetworkSelectReportStatus(), which should
+ * be called from the callback set with uNetworkSetStatusCallback(),
+ * and by uNetworkSelectReportFailure(), which should be called when
+ * an operation on a bearer fails (e.g. a send times out): as soon
+ * as the selected bearer goes down, or fails
+ * #U_NETWORK_SELECT_FAILURES_MAX times in a row, the next best is
+ * selected and the callback set with uNetworkSelectSetCallback() is
+ * called, in which the application may close its sockets/MQTT
+ * sessions on the old bearer and re-open them on the new one,
+ * rather than waiting for TCP to time out.
+ *
+ * A bearer that is not selected is only switched to on performance
+ * when its score is better than that of the selected bearer by
+ * #U_NETWORK_SELECT_HYSTERESIS_PERCENT, to avoid flapping.
+ *
+ * These functions are thread-safe; they do not talk to any module,
+ * they only keep accounts.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_NETWORK_SELECT_MAX_NUM
+/** The maximum number of bearers that may be added.
+ */
+# define U_NETWORK_SELECT_MAX_NUM 4
+#endif
+
+#ifndef U_NETWORK_SELECT_SMOOTHING_FACTOR
+/** The smoothing applied to the round-trip time and throughput
+ * samples: each sample contributes 1/#U_NETWORK_SELECT_SMOOTHING_FACTOR
+ * to the estimate, as for the smoothed RTT of TCP.
+ */
+# define U_NETWORK_SELECT_SMOOTHING_FACTOR 8
+#endif
+
+#ifndef U_NETWORK_SELECT_DEFAULT_RTT_MS
+/** The round-trip time assumed for a bearer for which none has
+ * yet been reported.
+ */
+# define U_NETWORK_SELECT_DEFAULT_RTT_MS 500
+#endif
+
+#ifndef U_NETWORK_SELECT_DEFAULT_THROUGHPUT_BYTES_PER_SECOND
+/** The throughput assumed for a bearer for which none has yet been
+ * reported.
+ */
+# define U_NETWORK_SELECT_DEFAULT_THROUGHPUT_BYTES_PER_SECOND 10000
+#endif
+
+#ifndef U_NETWORK_SELECT_REFERENCE_LENGTH_BYTES
+/** The amount of data that the score of a bearer is based upon:
+ * the score is the time, in milliseconds, that it would take to
+ * move this much data, i.e. one round trip plus this length divided
+ * by the throughput, scaled by the cost.  Make it larger if your
+ * application moves bulk data, smaller if it is request/response.
+ */
+# define U_NETWORK_SELECT_REFERENCE_LENGTH_BYTES 1024
+#endif
+
+#ifndef U_NETWORK_SELECT_SIGNAL_WEAK_DBM
+/** A signal strength below which a bearer is considered weak, which
+ * doubles its score; this is intended to move traffic off a bearer
+ * before it fails rather than after.
+ */
+# define U_NETWORK_SELECT_SIGNAL_WEAK_DBM -110
+#endif
+
+#ifndef U_NETWORK_SELECT_FAILURES_MAX
+/** The number of consecutive failures reported with
+ * uNetworkSelectReportFailure() after which a bearer is no longer
+ * considered usable; it becomes usable again when a round-trip time
+ * or throughput is reported for it or it is reported as up.
+ */
+# define U_NETWORK_SELECT_FAILURES_MAX 2
+#endif
+
+#ifndef U_NETWORK_SELECT_HYSTERESIS_PERCENT
+/** The percentage by which the score of another bearer must be
+ * better than that of the selected bearer, while the selected
+ * bearer is still usable, for the selection to change.
+ */
+# define U_NETWORK_SELECT_HYSTERESIS_PERCENT 25
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The accounts kept for a bearer, as returned by uNetworkSelectGet().
+ */
+typedef struct {
+    uDeviceHandle_t devHandle;         /**< the device handle. */
+    uNetworkType_t netType;            /**< the network type. */
+    int32_t costPercent;               /**< the relative cost given to
+                                            uNetworkSelectAdd(). */
+    bool isUp;                         /**< the latest status reported
+                                            by uNetworkSelectReportStatus(),
+                                            true when first added. */
+    int32_t rttMs;                     /**< the smoothed round-trip time,
+                                            -1 if none has been reported. */
+    int32_t throughputBytesPerSecond;  /**< the smoothed throughput, -1 if
+                                            none has been reported. */
+    int32_t signalDbm;                 /**< the latest signal strength, 0 if
+                                            none has been reported. */
+    int32_t consecutiveFailures;       /**< the number of failures reported
+                                            since the last success. */
+    int32_t score;                     /**< the score, lower is better, -1
+                                            if the bearer is not usable. */
+} uNetworkSelectBearer_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Add a bearer; the network on it should already be up.  The first
+ * call to this function creates the mutex that protects the accounts
+ * so it must not be made from two tasks at once.
+ *
+ * @param devHandle    the handle of the device the network is on.
+ * @param netType      the type of network, e.g. #U_NETWORK_TYPE_CELL.
+ * @param costPercent  the relative cost of using this bearer, as a
+ *                     percentage added to its score, e.g. 0 for a
+ *                     free Wi-Fi network and 50 for a metered
+ *                     cellular one; must not be negative.
+ * @return             zero on success else negative error code; if
+ *                     the bearer has already been added its cost is
+ *                     updated.
+ */
+int32_t uNetworkSelectAdd(uDeviceHandle_t devHandle, uNetworkType_t netType,
+                          int32_t costPercent);
+
+/** Remove a bearer; if it was selected the next best is selected
+ * and the callback set with uNetworkSelectSetCallback() is called.
+ *
+ * @param devHandle the handle of the device.
+ * @return          zero on success else negative error code.
+ */
+int32_t uNetworkSelectRemove(uDeviceHandle_t devHandle);
+
+/** Report the status of a bearer; call this from the callback set
+ * with uNetworkSetStatusCallback().
+ *
+ * @param devHandle the handle of the device.
+ * @param isUp      true if the network is up, else false.
+ * @return          zero on success else negative error code.
+ */
+int32_t uNetworkSelectReportStatus(uDeviceHandle_t devHandle, bool isUp);
+
+/** Report a round-trip time measured over a bearer, e.g. the time
+ * between an MQTT publish and its acknowledgement; this also clears
+ * the count of consecutive failures.
+ *
+ * @param devHandle the handle of the device.
+ * @param rttMs     the round-trip time in milliseconds.
+ * @return          zero on success else negative error code.
+ */
+int32_t uNetworkSelectReportRtt(uDeviceHandle_t devHandle, int32_t rttMs);
+
+/** Report a throughput measured over a bearer; this also clears
+ * the count of consecutive failures.
+ *
+ * @param devHandle the handle of the device.
+ * @param lengthBytes the amount of data moved.
+ * @param timeMs      the time it took in milliseconds; must be
+ *                    greater than zero.
+ * @return            zero on success else negative error code.
+ */
+int32_t uNetworkSelectReportThroughput(uDeviceHandle_t devHandle,
+                                       uint32_t lengthBytes, int32_t timeMs);
+
+/** Report the statistics of a socket on a bearer, as returned by
+ * uSockStatsGet() (which requires U_CFG_SOCK_STATS): the connect
+ * time is taken as a round-trip time and the bytes sent over the
+ * time spent sending as a throughput.  Best called just before
+ * the socket is closed.
+ *
+ * @param devHandle the handle of the device.
+ * @param pStats    the socket statistics; cannot be NULL.
+ * @return          zero on success else negative error code.
+ */
+int32_t uNetworkSelectReportSockStats(uDeviceHandle_t devHandle,
+                                      const uSockStats_t *pStats);
+
+/** Report the signal strength of a bearer, e.g. the rsrpDbm
+ * field of a #uCellInfoRadioSample_t obtained with
+ * uCellInfoRadioSamplerGet(), or the RSSI of a Wi-Fi network.
+ *
+ * @param devHandle the handle of the device.
+ * @param signalDbm the signal strength in dBm, 0 if not known.
+ * @return          zero on success else negative error code.
+ */
+int32_t uNetworkSelectReportSignal(uDeviceHandle_t devHandle, int32_t signalDbm);
+
+/** Report that an operation over a bearer has failed, e.g. a
+ * socket send or an MQTT publish timed out; after
+ * #U_NETWORK_SELECT_FAILURES_MAX consecutive failures the bearer is
+ * no longer used.
+ *
+ * @param devHandle the handle of the device.
+ * @return          zero on success else negative error code.
+ */
+int32_t uNetworkSelectReportFailure(uDeviceHandle_t devHandle);
+
+/** Get the bearer that new connections should be made on.
+ *
+ * @param[out] pDevHandle a place to put the device handle; cannot
+ *                        be NULL.
+ * @param[out] pNetType   a place to put the network type; may be
+ *                        NULL.
+ * @return                zero on success, #U_ERROR_COMMON_NOT_FOUND
+ *                        if no bearer is usable, else negative error
+ *                        code.
+ */
+int32_t uNetworkSelectGetBest(uDeviceHandle_t *pDevHandle,
+                              uNetworkType_t *pNetType);
+
+/** Get the accounts kept for a bearer.
+ *
+ * @param devHandle     the handle of the device.
+ * @param[out] pBearer  a place to put the accounts; cannot be NULL.
+ * @return              zero on success else negative error code.
+ */
+int32_t uNetworkSelectGet(uDeviceHandle_t devHandle,
+                          uNetworkSelectBearer_t *pBearer);
+
+/** Set a callback to be called when the selected bearer changes.
+ * The callback is called in the context of the task that made the
+ * report which caused the change, with no lock held, so it may call
+ * any of these functions; it should move the application's
+ * connections from the old bearer to the new one, e.g. by calling
+ * uMqttClientClose() and then pUMqttClientOpen()/uMqttClientConnect()
+ * with the new device handle and re-subscribing.
+ *
+ * @param[in] pCallback     the callback: the first two parameters are
+ *                          the device handle and network type of the
+ *                          bearer that was selected (NULL if there
+ *                          was none), the next two those of the
+ *                          bearer now selected (NULL if there is
+ *                          none), the last is pCallbackParam; use
+ *                          NULL to remove a callback.
+ * @param[in] pCallbackParam a parameter to pass to the callback,
+ *                          may be NULL.
+ * @return                  zero on success else negative error code.
+ */
+int32_t uNetworkSelectSetCallback(void (*pCallback) (uDeviceHandle_t oldDevHandle,
+                                                     uNetworkType_t oldNetType,
+                                                     uDeviceHandle_t newDevHandle,
+                                                     uNetworkType_t newNetType,
+                                                     void *pCallbackParam),
+                                  void *pCallbackParam);
+
+/** Remove all bearers and the callback and free the mutex; should
+ * not be called at the same time as any of the other functions.
+ */
+void uNetworkSelectClear();
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_NETWORK_SELECT_H_
+
+// End of file
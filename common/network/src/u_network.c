@@ -35,16 +35,23 @@
 
 #include "u_error_common.h"
 
+#include "u_cfg_os_platform_specific.h"
+
 #include "u_device_shared.h"
 
 #include "u_network_shared.h"
 
 #include "u_port_heap.h"
 #include "u_port_os.h"
+#include "u_task_registry.h"
 
 #include "u_location.h"
 #include "u_location_shared.h"
 
+#include "u_sock.h"
+
+#include "u_security_tls.h"
+
 #include "u_network.h"
 #include "u_network_config_ble.h"
 #include "u_network_config_cell.h"
@@ -63,6 +70,16 @@
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The context of a uNetworkInterfaceUpAsync() task.
+ */
+typedef struct {
+    uDeviceHandle_t devHandle;
+    uNetworkType_t netType;
+    uDeviceNetworkData_t *pNetworkData;
+    void (*pCallback) (uDeviceHandle_t, uNetworkType_t, int32_t, void *);
+    void *pCallbackParameter;
+} uNetworkUpAsync_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -72,7 +89,9 @@
  * -------------------------------------------------------------- */
 
 // Bring a network up or down.
-// This must be called between uDeviceLock() and uDeviceUnlock().
+// This must be called between uDeviceLock() and uDeviceUnlock()
+// or, when bringing a network up, with the network data marked
+// as busy by networkUpClaim().
 static int32_t networkInterfaceChangeState(uDeviceHandle_t devHandle,
                                            uNetworkType_t netType,
                                            const void *pNetworkCfg,
@@ -132,13 +151,34 @@ static int32_t networkInterfaceChangeState(uDeviceHandle_t devHandle,
     return errorCode;
 }
 
-/* ----------------------------------------------------------------
- * PUBLIC FUNCTIONS
- * -------------------------------------------------------------- */
+// Get the network data for a network on a device, taking a free
+// entry if there is none yet; must be called between uDeviceLock()
+// and uDeviceUnlock().
+static uDeviceNetworkData_t *pNetworkDataGetOrAdd(uDeviceInstance_t *pInstance,
+                                                  uNetworkType_t netType)
+{
+    uDeviceNetworkData_t *pNetworkData = pUNetworkGetNetworkData(pInstance, netType);
 
-int32_t uNetworkInterfaceUp(uDeviceHandle_t devHandle,
-                            uNetworkType_t netType,
-                            const void *pCfg)
+    if (pNetworkData == NULL) {
+        // No network of this type has yet been brought up on
+        // this device
+        pNetworkData = pUNetworkGetNetworkData(pInstance, U_NETWORK_TYPE_NONE);
+        if (pNetworkData != NULL) {
+            pNetworkData->networkType = (int32_t) netType;
+        }
+    }
+
+    return pNetworkData;
+}
+
+// Check the parameters for bringing up a network and mark the
+// network as busy, so that the bring-up itself can be done without
+// the device API locked; on success *ppNetworkData is set and
+// networkUpRelease() must be called when done.
+static int32_t networkUpClaim(uDeviceHandle_t devHandle,
+                              uNetworkType_t netType,
+                              const void *pCfg,
+                              uDeviceNetworkData_t **ppNetworkData)
 {
     // Lock the API
     int32_t errorCode = uDeviceLock();
@@ -150,25 +190,23 @@ int32_t uNetworkInterfaceUp(uDeviceHandle_t devHandle,
         if ((uDeviceGetInstance(devHandle, &pInstance) == 0) &&
             (netType >= U_NETWORK_TYPE_NONE) &&
             (netType < U_NETWORK_TYPE_MAX_NUM)) {
-            pNetworkData = pUNetworkGetNetworkData(pInstance, netType);
-            if (pNetworkData == NULL) {
-                // No network of this type has yet been brought up on
-                // this device
-                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-                pNetworkData = pUNetworkGetNetworkData(pInstance, U_NETWORK_TYPE_NONE);
-            }
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pNetworkData = pNetworkDataGetOrAdd(pInstance, netType);
             if (pNetworkData != NULL) {
-                pNetworkData->networkType = (int32_t) netType;
                 errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
                 if (pCfg == NULL) {
                     // Use possible last set configuration
                     pCfg = pNetworkData->pCfg;
                 }
-                if (pCfg != NULL) {
+                if (pNetworkData->busy) {
+                    // Already on its way up
+                    errorCode = (int32_t) U_ERROR_COMMON_TEMPORARY_FAILURE;
+                } else if (pCfg != NULL) {
                     pNetworkData->pCfg = pCfg;
-                    errorCode = networkInterfaceChangeState(devHandle, netType,
-                                                            pNetworkData->pCfg,
-                                                            true);
+                    pNetworkData->cancel = false;
+                    pNetworkData->busy = true;
+                    *ppNetworkData = pNetworkData;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                 }
             }
         }
@@ -179,6 +217,124 @@ int32_t uNetworkInterfaceUp(uDeviceHandle_t devHandle,
     return errorCode;
 }
 
+// Release a network claimed with networkUpClaim().
+static void networkUpRelease(uDeviceNetworkData_t *pNetworkData)
+{
+    if (uDeviceLock() == 0) {
+        pNetworkData->busy = false;
+        pNetworkData->cancel = false;
+        uDeviceUnlock();
+    }
+}
+
+// The task that brings a network up for uNetworkInterfaceUpAsync().
+static void upAsyncTask(void *pParameter)
+{
+    uNetworkUpAsync_t *pUpAsync = (uNetworkUpAsync_t *) pParameter;
+    int32_t errorCode;
+
+    errorCode = networkInterfaceChangeState(pUpAsync->devHandle, pUpAsync->netType,
+                                            pUpAsync->pNetworkData->pCfg, true);
+    networkUpRelease(pUpAsync->pNetworkData);
+    pUpAsync->pCallback(pUpAsync->devHandle, pUpAsync->netType, errorCode,
+                        pUpAsync->pCallbackParameter);
+    uPortFree(pUpAsync);
+
+    uTaskRegistryTaskDelete(NULL);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+int32_t uNetworkInterfaceUp(uDeviceHandle_t devHandle,
+                            uNetworkType_t netType,
+                            const void *pCfg)
+{
+    uDeviceNetworkData_t *pNetworkData = NULL;
+    int32_t errorCode = networkUpClaim(devHandle, netType, pCfg, &pNetworkData);
+
+    if (errorCode == 0) {
+        // The device API is not locked while the network is
+        // brought up, which may take minutes, so that networks
+        // on other devices may be brought up at the same time
+        errorCode = networkInterfaceChangeState(devHandle, netType,
+                                                pNetworkData->pCfg,
+                                                true);
+        networkUpRelease(pNetworkData);
+    }
+
+    return errorCode;
+}
+
+int32_t uNetworkInterfaceUpAsync(uDeviceHandle_t devHandle,
+                                 uNetworkType_t netType,
+                                 const void *pCfg,
+                                 void (*pCallback) (uDeviceHandle_t,
+                                                    uNetworkType_t,
+                                                    int32_t,
+                                                    void *),
+                                 void *pCallbackParameter)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uDeviceNetworkData_t *pNetworkData = NULL;
+    uNetworkUpAsync_t *pUpAsync;
+    uPortTaskHandle_t taskHandle;
+
+    if (pCallback != NULL) {
+        errorCode = networkUpClaim(devHandle, netType, pCfg, &pNetworkData);
+        if (errorCode == 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pUpAsync = (uNetworkUpAsync_t *) pUPortMalloc(sizeof(*pUpAsync));
+            if (pUpAsync != NULL) {
+                pUpAsync->devHandle = devHandle;
+                pUpAsync->netType = netType;
+                pUpAsync->pNetworkData = pNetworkData;
+                pUpAsync->pCallback = pCallback;
+                pUpAsync->pCallbackParameter = pCallbackParameter;
+                errorCode = uTaskRegistryTaskCreate(upAsyncTask, "netUp",
+                                                    U_NETWORK_UP_TASK_STACK_SIZE_BYTES,
+                                                    pUpAsync, U_NETWORK_UP_TASK_PRIORITY,
+                                                    &taskHandle);
+                if (errorCode != 0) {
+                    uPortFree(pUpAsync);
+                }
+            }
+            if (errorCode != 0) {
+                networkUpRelease(pNetworkData);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+int32_t uNetworkInterfaceUpCancel(uDeviceHandle_t devHandle, uNetworkType_t netType)
+{
+    // Lock the API
+    int32_t errorCode = uDeviceLock();
+    uDeviceInstance_t *pInstance;
+    uDeviceNetworkData_t *pNetworkData;
+
+    if (errorCode == 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((uDeviceGetInstance(devHandle, &pInstance) == 0) &&
+            (netType >= U_NETWORK_TYPE_NONE) &&
+            (netType < U_NETWORK_TYPE_MAX_NUM)) {
+            // Nothing on its way up is not an error
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            pNetworkData = pUNetworkGetNetworkData(pInstance, netType);
+            if ((pNetworkData != NULL) && pNetworkData->busy) {
+                pNetworkData->cancel = true;
+            }
+        }
+        // ...and done
+        uDeviceUnlock();
+    }
+
+    return errorCode;
+}
+
 int32_t uNetworkInterfaceDown(uDeviceHandle_t devHandle, uNetworkType_t netType)
 {
     // Lock the API
@@ -195,12 +351,21 @@ int32_t uNetworkInterfaceDown(uDeviceHandle_t devHandle, uNetworkType_t netType)
             // been brought up, hence success
             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
             pNetworkData = pUNetworkGetNetworkData(pInstance, netType);
-            if (pNetworkData != NULL) {
+            if ((pNetworkData != NULL) && pNetworkData->busy) {
+                // Still on its way up: uNetworkInterfaceUpCancel()
+                // must be called and the bring-up allowed to finish
+                errorCode = (int32_t) U_ERROR_COMMON_TEMPORARY_FAILURE;
+            } else if (pNetworkData != NULL) {
                 errorCode = networkInterfaceChangeState(devHandle, netType,
                                                         pNetworkData->pCfg,
                                                         false);
-                uPortFree(pNetworkData->pStatusCallbackData);
-                pNetworkData->pStatusCallbackData = NULL;
+                uNetworkStatusCallbackDataFree(pNetworkData);
+                // Host names may resolve differently next time
+                uSockGetHostByNameCacheFlush(devHandle);
+                // ...pooled connections will have gone...
+                uSockPoolFlush(devHandle);
+                // ...and kept TLS sessions are of no further use
+                uSecurityTlsIdleFlush(devHandle);
             }
         }
         // ...and done
@@ -227,9 +392,11 @@ int32_t uNetworkSetStatusCallback(uDeviceHandle_t devHandle,
         if ((uDeviceGetInstance(devHandle, &pInstance) == 0) &&
             (netType >= U_NETWORK_TYPE_NONE) &&
             (netType < U_NETWORK_TYPE_MAX_NUM)) {
-            // If pNetworkData is NULL then this network has not
-            // been brought up
-            pNetworkData = pUNetworkGetNetworkData(pInstance, netType);
+            // If pNetworkData is NULL then this network has not yet
+            // been brought up: take an entry for it anyway, so that
+            // the callback can report the progress of the first
+            // bring-up (e.g. when uNetworkInterfaceUpAsync() is used)
+            pNetworkData = pNetworkDataGetOrAdd(pInstance, netType);
             if (pNetworkData != NULL) {
                 errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
                 // Allocate space for the status callback data
@@ -237,10 +404,7 @@ int32_t uNetworkSetStatusCallback(uDeviceHandle_t devHandle,
                 // the various callback functions can then
                 // obtain it from there with a call to
                 // pUNetworkGetNetworkData()
-                if (pNetworkData->pStatusCallbackData == NULL) {
-                    pNetworkData->pStatusCallbackData = pUPortMalloc(sizeof(uNetworkStatusCallbackData_t));
-                }
-                pStatusCallbackData = (uNetworkStatusCallbackData_t *) pNetworkData->pStatusCallbackData;
+                pStatusCallbackData = pUNetworkStatusCallbackDataGetOrAdd(pNetworkData);
                 if (pStatusCallbackData != NULL) {
                     pStatusCallbackData->pCallback = pCallback;
                     pStatusCallbackData->pCallbackParameter = pCallbackParameter;
@@ -262,8 +426,11 @@ int32_t uNetworkSetStatusCallback(uDeviceHandle_t devHandle,
                             break;
                     }
                     if (errorCode != 0) {
-                        uPortFree(pNetworkData->pStatusCallbackData);
-                        pNetworkData->pStatusCallbackData = NULL;
+                        uNetworkStatusCallbackDataFree(pNetworkData);
+                        if ((pNetworkData->pCfg == NULL) && !pNetworkData->busy) {
+                            // Never been brought up: give the entry back
+                            pNetworkData->networkType = (int32_t) U_NETWORK_TYPE_NONE;
+                        }
                     }
                 }
             }
@@ -275,4 +442,63 @@ int32_t uNetworkSetStatusCallback(uDeviceHandle_t devHandle,
     return errorCode;
 }
 
+// Set a hold-off on the network status callback.
+int32_t uNetworkSetStatusHoldOff(uDeviceHandle_t devHandle,
+                                 uNetworkType_t netType,
+                                 int32_t holdOffMs)
+{
+    // Lock the API
+    int32_t errorCode = uDeviceLock();
+    uDeviceInstance_t *pInstance;
+    uDeviceNetworkData_t *pNetworkData;
+
+    if (errorCode == 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((uDeviceGetInstance(devHandle, &pInstance) == 0) &&
+            ((netType == U_NETWORK_TYPE_CELL) || (netType == U_NETWORK_TYPE_WIFI)) &&
+            (holdOffMs >= 0)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            // As for uNetworkSetStatusCallback(), this may be
+            // called before the network is first brought up
+            pNetworkData = pNetworkDataGetOrAdd(pInstance, netType);
+            if (pNetworkData != NULL) {
+                errorCode = uNetworkStatusHoldOffSet(devHandle, netType,
+                                                     pNetworkData, holdOffMs);
+            }
+        }
+        // ...and done
+        uDeviceUnlock();
+    }
+
+    return errorCode;
+}
+
+// Get the number of status changes absorbed by the hold-off.
+int32_t uNetworkGetStatusFlapCount(uDeviceHandle_t devHandle,
+                                   uNetworkType_t netType)
+{
+    // Lock the API
+    int32_t errorCodeOrCount = uDeviceLock();
+    uDeviceInstance_t *pInstance;
+    uDeviceNetworkData_t *pNetworkData;
+
+    if (errorCodeOrCount == 0) {
+        errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((uDeviceGetInstance(devHandle, &pInstance) == 0) &&
+            (netType > U_NETWORK_TYPE_NONE) &&
+            (netType < U_NETWORK_TYPE_MAX_NUM)) {
+            // A network that has no entry has not flapped
+            errorCodeOrCount = 0;
+            pNetworkData = pUNetworkGetNetworkData(pInstance, netType);
+            if (pNetworkData != NULL) {
+                errorCodeOrCount = uNetworkStatusFlapCountGet(pNetworkData);
+            }
+        }
+        // ...and done
+        uDeviceUnlock();
+    }
+
+    return errorCodeOrCount;
+}
+
 // End of file
@@ -46,6 +46,8 @@
 #include "u_device_shared.h"
 #include "u_device_shared_cell.h"
 
+#include "u_sock.h"
+
 #include "u_network_shared.h"
 
 #include "u_cell_module_type.h"
@@ -73,18 +75,30 @@
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
-// Call-back for connect/disconnect timeout.
+// Call-back for connect/disconnect timeout, which also handles
+// uNetworkInterfaceUpCancel() and any keep-going callback of the user.
 static bool keepGoingCallback(uDeviceHandle_t devHandle)
 {
     uDeviceCellContext_t *pContext;
     uDeviceInstance_t *pDevInstance = NULL;
+    uDeviceNetworkData_t *pNetworkData;
+    const uNetworkCfgCell_t *pCfg = NULL;
     bool keepGoing = false;
 
-    if (uDeviceGetInstance(devHandle, &pDevInstance) == 0) {
-        pContext = (uDeviceCellContext_t *) pDevInstance->pContext;
-        if ((pContext == NULL) ||
-            (uPortGetTickTimeMs() < pContext->stopTimeMs)) {
-            keepGoing = true;
+    if ((uDeviceGetInstance(devHandle, &pDevInstance) == 0) &&
+        !uNetworkIsCancelled(devHandle, U_NETWORK_TYPE_CELL)) {
+        pNetworkData = pUNetworkGetNetworkData(pDevInstance, U_NETWORK_TYPE_CELL);
+        if (pNetworkData != NULL) {
+            pCfg = (const uNetworkCfgCell_t *) pNetworkData->pCfg;
+        }
+        if ((pCfg != NULL) && (pCfg->pKeepGoingCallback != NULL)) {
+            keepGoing = pCfg->pKeepGoingCallback(devHandle);
+        } else {
+            pContext = (uDeviceCellContext_t *) pDevInstance->pContext;
+            if ((pContext == NULL) ||
+                (uPortGetTickTimeMs() < pContext->stopTimeMs)) {
+                keepGoing = true;
+            }
         }
     }
 
@@ -100,7 +114,6 @@ static void statusCallback(uCellNetRegDomain_t domain,
 {
     uDeviceInstance_t *pInstance = (uDeviceInstance_t *) pParameter;
     uDeviceNetworkData_t *pNetworkData;
-    uNetworkStatusCallbackData_t *pStatusCallbackData;
     bool isUp;
     uNetworkStatus_t networkStatus;
 
@@ -115,16 +128,17 @@ static void statusCallback(uCellNetRegDomain_t domain,
     if (uDeviceIsValidInstance(pInstance)) {
         pNetworkData = pUNetworkGetNetworkData(pInstance, U_NETWORK_TYPE_CELL);
         if (pNetworkData != NULL) {
-            pStatusCallbackData = (uNetworkStatusCallbackData_t *) pNetworkData->pStatusCallbackData;
-            if ((pStatusCallbackData != NULL) &&
-                (pStatusCallbackData->pCallback)) {
-                isUp = U_CELL_NET_STATUS_MEANS_REGISTERED(status);
-                networkStatus.cell.domain = (int32_t) domain;
-                networkStatus.cell.status = (int32_t) status;
-                pStatusCallbackData->pCallback((uDeviceHandle_t) pInstance,
-                                               U_NETWORK_TYPE_CELL, isUp, &networkStatus,
-                                               pStatusCallbackData->pCallbackParameter);
-            }
+            // Whether the network has gone or come back, cached
+            // DNS look-ups, successful or otherwise, are suspect
+            uSockGetHostByNameCacheFlush((uDeviceHandle_t) pInstance);
+            isUp = U_CELL_NET_STATUS_MEANS_REGISTERED(status);
+            networkStatus.cell.domain = (int32_t) domain;
+            networkStatus.cell.status = (int32_t) status;
+            // Changes on each domain are held separately if there
+            // is a hold-off, hence the domain is the key
+            uNetworkStatusCallbackCall((uDeviceHandle_t) pInstance,
+                                       U_NETWORK_TYPE_CELL, pNetworkData,
+                                       (int32_t) domain, isUp, &networkStatus);
         }
     }
 }
@@ -141,18 +155,16 @@ int32_t uNetworkPrivateChangeStateCell(uDeviceHandle_t devHandle,
     uDeviceCellContext_t *pContext;
     uDeviceInstance_t *pDevInstance;
     int32_t errorCode = uDeviceGetInstance(devHandle, &pDevInstance);
-    bool (*pKeepGoingCallback)(uDeviceHandle_t devHandle) = keepGoingCallback;
 
     if (errorCode == 0) {
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         pContext = (uDeviceCellContext_t *) pDevInstance->pContext;
         if ((pCfg != NULL) && (pCfg->version == 0) &&
             (pCfg->type == U_NETWORK_TYPE_CELL) && (pContext != NULL)) {
-            if (pCfg->pKeepGoingCallback != NULL) {
-                // The user has given us a keep-going callback, so use it
-                pKeepGoingCallback = pCfg->pKeepGoingCallback;
-            } else {
-                // Set the stop time for the connect/disconnect calls
+            // If the user has given us a keep-going callback then
+            // keepGoingCallback() will call it, else set the stop
+            // time for the connect/disconnect calls
+            if (pCfg->pKeepGoingCallback == NULL) {
                 pContext->stopTimeMs = uPortGetTickTimeMs() +
                                        (((int64_t) pCfg->timeoutSeconds) * 1000);
             }
@@ -162,10 +174,10 @@ int32_t uNetworkPrivateChangeStateCell(uDeviceHandle_t devHandle,
                 errorCode = uCellNetConnect(devHandle, NULL,
                                             pCfg->pApn,
                                             NULL, NULL,
-                                            pKeepGoingCallback);
+                                            keepGoingCallback);
             } else {
                 // Disconnect
-                errorCode = uCellNetDisconnect(devHandle, pKeepGoingCallback);
+                errorCode = uCellNetDisconnect(devHandle, keepGoingCallback);
             }
         }
     }
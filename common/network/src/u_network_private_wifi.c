@@ -46,6 +46,8 @@
 
 #include "u_network_shared.h"
 
+#include "u_sock.h"
+
 #include "u_short_range_module_type.h"
 #include "u_short_range.h"
 
@@ -135,7 +137,6 @@ static void wifiConnectionCallback(uDeviceHandle_t devHandle,
 {
     uDeviceInstance_t *pInstance;
     uDeviceNetworkData_t *pNetworkData;
-    uNetworkStatusCallbackData_t *pStatusCallbackData;
     bool isUp;
     uNetworkStatus_t networkStatus;
     uPortQueueHandle_t queueHandle = getQueueHandle(devHandle);
@@ -163,22 +164,22 @@ static void wifiConnectionCallback(uDeviceHandle_t devHandle,
     if (uDeviceGetInstance(devHandle, &pInstance) == 0) {
         pNetworkData = pUNetworkGetNetworkData(pInstance, U_NETWORK_TYPE_WIFI);
         if (pNetworkData != NULL) {
-            pStatusCallbackData = (uNetworkStatusCallbackData_t *) pNetworkData->pStatusCallbackData;
-            if ((pStatusCallbackData != NULL) &&
-                (pStatusCallbackData->pCallback)) {
-                networkStatus.wifi.pBssid = NULL;
-                isUp = (status == (int32_t) U_WIFI_CON_STATUS_CONNECTED);
-                networkStatus.wifi.connId = connId;
-                networkStatus.wifi.status = status;
-                networkStatus.wifi.channel = channel;
-                if (isUp) {
-                    networkStatus.wifi.pBssid = pBssid;
-                }
-                networkStatus.wifi.disconnectReason = disconnectReason;
-                pStatusCallbackData->pCallback(devHandle, U_NETWORK_TYPE_WIFI,
-                                               isUp, &networkStatus,
-                                               pStatusCallbackData->pCallbackParameter);
+            // Whether the network has gone or come back, cached
+            // DNS look-ups, successful or otherwise, are suspect
+            uSockGetHostByNameCacheFlush(devHandle);
+            networkStatus.wifi.pBssid = NULL;
+            isUp = (status == (int32_t) U_WIFI_CON_STATUS_CONNECTED);
+            networkStatus.wifi.connId = connId;
+            networkStatus.wifi.status = status;
+            networkStatus.wifi.channel = channel;
+            if (isUp) {
+                networkStatus.wifi.pBssid = pBssid;
             }
+            networkStatus.wifi.disconnectReason = disconnectReason;
+            // The connection ID changes with each connection so
+            // it can't be the key for a hold-off: there is only one
+            uNetworkStatusCallbackCall(devHandle, U_NETWORK_TYPE_WIFI,
+                                       pNetworkData, 0, isUp, &networkStatus);
         }
     }
 
@@ -264,11 +265,15 @@ static inline int32_t statusQueueWaitForWifiDisabled(const uPortQueueHandle_t qu
     return (int32_t) U_ERROR_COMMON_TIMEOUT;
 }
 
-static inline int32_t statusQueueWaitForWifiConnected(const uPortQueueHandle_t queueHandle,
+// Note: a bring-up cancelled with uNetworkInterfaceUpCancel() ends
+// the wait as if it had timed out, within a second.
+static inline int32_t statusQueueWaitForWifiConnected(uDeviceHandle_t devHandle,
+                                                      const uPortQueueHandle_t queueHandle,
                                                       int32_t timeoutSec)
 {
     int32_t startTime = (int32_t)uPortGetTickTimeMs();
-    while ((int32_t)uPortGetTickTimeMs() - startTime < timeoutSec * 1000) {
+    while (((int32_t)uPortGetTickTimeMs() - startTime < timeoutSec * 1000) &&
+           !uNetworkIsCancelled(devHandle, U_NETWORK_TYPE_WIFI)) {
         uStatusMessage_t msg;
         int32_t errorCode = uPortQueueTryReceive(queueHandle, 1000, &msg);
         if ((errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) &&
@@ -279,14 +284,18 @@ static inline int32_t statusQueueWaitForWifiConnected(const uPortQueueHandle_t q
     return (int32_t) U_ERROR_COMMON_TIMEOUT;
 }
 
-static inline int32_t statusQueueWaitForNetworkUp(const uPortQueueHandle_t queueHandle,
+// Note: a bring-up cancelled with uNetworkInterfaceUpCancel() ends
+// the wait as if it had timed out, within a second.
+static inline int32_t statusQueueWaitForNetworkUp(uDeviceHandle_t devHandle,
+                                                  const uPortQueueHandle_t queueHandle,
                                                   int32_t timeoutSec)
 {
     static const uint32_t desiredNetStatusMask =
         U_WIFI_STATUS_MASK_IPV4_UP | U_WIFI_STATUS_MASK_IPV6_UP;
     uint32_t lastNetStatusMask = 0;
     int32_t startTime = (int32_t)uPortGetTickTimeMs();
-    while ((int32_t)uPortGetTickTimeMs() - startTime < timeoutSec * 1000) {
+    while (((int32_t)uPortGetTickTimeMs() - startTime < timeoutSec * 1000) &&
+           !uNetworkIsCancelled(devHandle, U_NETWORK_TYPE_WIFI)) {
         uStatusMessage_t msg;
         int32_t errorCode = uPortQueueTryReceive(queueHandle, 1000, &msg);
         if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
@@ -311,7 +320,8 @@ static inline int32_t statusQueueWaitForNetworkUp(const uPortQueueHandle_t queue
             }
         }
     }
-    if ((lastNetStatusMask & desiredNetStatusMask) > 0) {
+    if (((lastNetStatusMask & desiredNetStatusMask) > 0) &&
+        !uNetworkIsCancelled(devHandle, U_NETWORK_TYPE_WIFI)) {
         // If one of the network protocol is up we
         // return without failure since this could
         // be only a missconfiguration
@@ -371,9 +381,9 @@ int32_t uNetworkPrivateChangeStateWifi(uDeviceHandle_t devHandle,
                                             pCfg->pPassPhrase);
             if (errorCode == 0) {
                 // Wait until the network layer is up before return
-                errorCode = statusQueueWaitForWifiConnected(queueHandle, 20);
+                errorCode = statusQueueWaitForWifiConnected(devHandle, queueHandle, 20);
                 if (errorCode == 0) {
-                    errorCode = statusQueueWaitForNetworkUp(queueHandle,
+                    errorCode = statusQueueWaitForNetworkUp(devHandle, queueHandle,
                                                             U_NETWORK_PRIVATE_WIFI_NETWORK_TIMEOUT_SEC);
                 }
             }
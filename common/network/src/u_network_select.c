@@ -0,0 +1,544 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of selection between network bearers based
+ * on their measured performance.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()
+
+#include "u_error_common.h"
+
+#include "u_port_os.h"
+
+#include "u_device.h"
+#include "u_network.h"
+#include "u_sock.h"
+#include "u_network_select.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The callback called when the selection changes.
+ */
+typedef void (uNetworkSelectCallback_t)(uDeviceHandle_t oldDevHandle,
+                                        uNetworkType_t oldNetType,
+                                        uDeviceHandle_t newDevHandle,
+                                        uNetworkType_t newNetType,
+                                        void *pCallbackParam);
+
+/** A change of selection, to be told to the application once the
+ * mutex has been released.
+ */
+typedef struct {
+    uNetworkSelectCallback_t *pCallback;
+    void *pCallbackParam;
+    uDeviceHandle_t oldDevHandle;
+    uNetworkType_t oldNetType;
+    uDeviceHandle_t newDevHandle;
+    uNetworkType_t newNetType;
+} uNetworkSelectChange_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Mutex to protect the accounts.
+ */
+static uPortMutexHandle_t gMutex = NULL;
+
+/** The bearers: an entry is free if its devHandle is NULL.
+ */
+static uNetworkSelectBearer_t gBearer[U_NETWORK_SELECT_MAX_NUM] = {0};
+
+/** The index of the selected bearer in gBearer[], -1 if none.
+ */
+static int32_t gSelected = -1;
+
+/** The callback to call when the selection changes.
+ */
+static uNetworkSelectCallback_t *gpCallback = NULL;
+
+/** The parameter to pass to gpCallback.
+ */
+static void *gpCallbackParam = NULL;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Find a bearer in gBearer[], returning its index or -1.
+static int32_t bearerFind(uDeviceHandle_t devHandle)
+{
+    int32_t index = -1;
+
+    for (size_t x = 0; (x < sizeof(gBearer) / sizeof(gBearer[0])) &&
+         (index < 0); x++) {
+        if (gBearer[x].devHandle == devHandle) {
+            index = (int32_t) x;
+        }
+    }
+
+    return index;
+}
+
+// Fold a sample into a smoothed estimate.
+static int32_t smooth(int32_t estimate, int32_t sample)
+{
+    if (estimate < 0) {
+        estimate = sample;
+    } else {
+        estimate = (int32_t) ((((int64_t) estimate) * (U_NETWORK_SELECT_SMOOTHING_FACTOR - 1) +
+                               sample) / U_NETWORK_SELECT_SMOOTHING_FACTOR);
+    }
+
+    return estimate;
+}
+
+// Work out the score of a bearer: the time in milliseconds to move
+// U_NETWORK_SELECT_REFERENCE_LENGTH_BYTES, scaled by cost and
+// doubled if the signal is weak, or -1 if the bearer is not usable.
+static int32_t scoreCalculate(const uNetworkSelectBearer_t *pBearer)
+{
+    int64_t score = -1;
+    int64_t rttMs = U_NETWORK_SELECT_DEFAULT_RTT_MS;
+    int64_t throughput = U_NETWORK_SELECT_DEFAULT_THROUGHPUT_BYTES_PER_SECOND;
+
+    if (pBearer->isUp &&
+        (pBearer->consecutiveFailures < U_NETWORK_SELECT_FAILURES_MAX)) {
+        if (pBearer->rttMs >= 0) {
+            rttMs = pBearer->rttMs;
+        }
+        if (pBearer->throughputBytesPerSecond > 0) {
+            throughput = pBearer->throughputBytesPerSecond;
+        }
+        score = rttMs + (((int64_t) U_NETWORK_SELECT_REFERENCE_LENGTH_BYTES) * 1000) / throughput;
+        if ((pBearer->signalDbm != 0) &&
+            (pBearer->signalDbm < U_NETWORK_SELECT_SIGNAL_WEAK_DBM)) {
+            score *= 2;
+        }
+        score = (score * (100 + pBearer->costPercent)) / 100;
+        if (score > INT32_MAX) {
+            score = INT32_MAX;
+        }
+    }
+
+    return (int32_t) score;
+}
+
+// Re-score all of the bearers and re-evaluate the selection,
+// filling in pChange if it has changed; must be called with
+// gMutex locked.
+static void selectionUpdate(uNetworkSelectChange_t *pChange)
+{
+    int32_t best = -1;
+    int32_t selected = gSelected;
+    uNetworkSelectBearer_t *pBearer;
+
+    for (size_t x = 0; x < sizeof(gBearer) / sizeof(gBearer[0]); x++) {
+        pBearer = &(gBearer[x]);
+        if (pBearer->devHandle != NULL) {
+            pBearer->score = scoreCalculate(pBearer);
+            if ((pBearer->score >= 0) &&
+                ((best < 0) || (pBearer->score < gBearer[best].score))) {
+                best = (int32_t) x;
+            }
+        } else {
+            pBearer->score = -1;
+        }
+    }
+
+    if ((selected < 0) || (gBearer[selected].score < 0)) {
+        // Nothing selected or the selected bearer is no longer
+        // usable: take the best there is, if any
+        selected = best;
+    } else if ((best >= 0) && (best != selected) &&
+               (((int64_t) gBearer[best].score) * 100 <
+                ((int64_t) gBearer[selected].score) * (100 - U_NETWORK_SELECT_HYSTERESIS_PERCENT))) {
+        // The selected bearer is still usable but another is
+        // sufficiently better
+        selected = best;
+    }
+
+    if (selected != gSelected) {
+        memset(pChange, 0, sizeof(*pChange));
+        pChange->pCallback = gpCallback;
+        pChange->pCallbackParam = gpCallbackParam;
+        if (gSelected >= 0) {
+            pChange->oldDevHandle = gBearer[gSelected].devHandle;
+            pChange->oldNetType = gBearer[gSelected].netType;
+        }
+        if (selected >= 0) {
+            pChange->newDevHandle = gBearer[selected].devHandle;
+            pChange->newNetType = gBearer[selected].netType;
+        }
+        gSelected = selected;
+    }
+}
+
+// Tell the application about a change of selection; must be
+// called with gMutex unlocked.
+static void changeTell(const uNetworkSelectChange_t *pChange)
+{
+    if (pChange->pCallback != NULL) {
+        pChange->pCallback(pChange->oldDevHandle, pChange->oldNetType,
+                           pChange->newDevHandle, pChange->newNetType,
+                           pChange->pCallbackParam);
+    }
+}
+
+// Lock the mutex, find a bearer and, if it is found, call
+// pUpdate on it with the given values, re-evaluating the
+// selection afterwards.
+static int32_t bearerUpdate(uDeviceHandle_t devHandle,
+                            void (*pUpdate) (uNetworkSelectBearer_t *pBearer,
+                                             int32_t value1, int32_t value2),
+                            int32_t value1, int32_t value2)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uNetworkSelectChange_t change = {0};
+    int32_t index;
+
+    if ((gMutex != NULL) && (uPortMutexLock(gMutex) == 0)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        index = bearerFind(devHandle);
+        if ((devHandle != NULL) && (index >= 0)) {
+            pUpdate(&(gBearer[index]), value1, value2);
+            selectionUpdate(&change);
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+        uPortMutexUnlock(gMutex);
+        changeTell(&change);
+    }
+
+    return errorCode;
+}
+
+// The update functions passed to bearerUpdate().
+
+static void updateStatus(uNetworkSelectBearer_t *pBearer,
+                         int32_t isUp, int32_t unused)
+{
+    (void) unused;
+    pBearer->isUp = (isUp != 0);
+    if (pBearer->isUp) {
+        pBearer->consecutiveFailures = 0;
+    }
+}
+
+static void updateRtt(uNetworkSelectBearer_t *pBearer,
+                      int32_t rttMs, int32_t unused)
+{
+    (void) unused;
+    pBearer->rttMs = smooth(pBearer->rttMs, rttMs);
+    pBearer->consecutiveFailures = 0;
+}
+
+static void updateThroughput(uNetworkSelectBearer_t *pBearer,
+                             int32_t throughputBytesPerSecond, int32_t unused)
+{
+    (void) unused;
+    pBearer->throughputBytesPerSecond = smooth(pBearer->throughputBytesPerSecond,
+                                               throughputBytesPerSecond);
+    pBearer->consecutiveFailures = 0;
+}
+
+static void updateRttAndThroughput(uNetworkSelectBearer_t *pBearer,
+                                   int32_t rttMs, int32_t throughputBytesPerSecond)
+{
+    if (rttMs >= 0) {
+        updateRtt(pBearer, rttMs, 0);
+    }
+    if (throughputBytesPerSecond > 0) {
+        updateThroughput(pBearer, throughputBytesPerSecond, 0);
+    }
+}
+
+static void updateSignal(uNetworkSelectBearer_t *pBearer,
+                         int32_t signalDbm, int32_t unused)
+{
+    (void) unused;
+    pBearer->signalDbm = signalDbm;
+}
+
+static void updateFailure(uNetworkSelectBearer_t *pBearer,
+                          int32_t unused1, int32_t unused2)
+{
+    (void) unused1;
+    (void) unused2;
+    if (pBearer->consecutiveFailures < INT32_MAX) {
+        pBearer->consecutiveFailures++;
+    }
+}
+
+// Work out a throughput in bytes per second, -1 if there is none.
+static int32_t throughputCalculate(uint32_t lengthBytes, int64_t timeMs)
+{
+    int32_t throughput = -1;
+    int64_t x;
+
+    if ((lengthBytes > 0) && (timeMs > 0)) {
+        x = (((int64_t) lengthBytes) * 1000) / timeMs;
+        if (x > INT32_MAX) {
+            x = INT32_MAX;
+        }
+        throughput = (int32_t) x;
+        if (throughput == 0) {
+            throughput = 1;
+        }
+    }
+
+    return throughput;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Add a bearer.
+int32_t uNetworkSelectAdd(uDeviceHandle_t devHandle, uNetworkType_t netType,
+                          int32_t costPercent)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uNetworkSelectChange_t change = {0};
+    uNetworkSelectBearer_t *pBearer;
+    int32_t index;
+
+    if ((devHandle != NULL) && (netType > U_NETWORK_TYPE_NONE) &&
+        (netType < U_NETWORK_TYPE_MAX_NUM) && (costPercent >= 0)) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (gMutex == NULL) {
+            errorCode = uPortMutexCreate(&gMutex);
+        }
+        if ((errorCode == 0) && (uPortMutexLock(gMutex) == 0)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            index = bearerFind(devHandle);
+            if (index < 0) {
+                index = bearerFind(NULL);
+                if (index >= 0) {
+                    pBearer = &(gBearer[index]);
+                    memset(pBearer, 0, sizeof(*pBearer));
+                    pBearer->devHandle = devHandle;
+                    pBearer->isUp = true;
+                    pBearer->rttMs = -1;
+                    pBearer->throughputBytesPerSecond = -1;
+                }
+            }
+            if (index >= 0) {
+                gBearer[index].netType = netType;
+                gBearer[index].costPercent = costPercent;
+                selectionUpdate(&change);
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+            uPortMutexUnlock(gMutex);
+            changeTell(&change);
+        }
+    }
+
+    return errorCode;
+}
+
+// Remove a bearer.
+int32_t uNetworkSelectRemove(uDeviceHandle_t devHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uNetworkSelectChange_t change = {0};
+    int32_t index;
+
+    if ((gMutex != NULL) && (uPortMutexLock(gMutex) == 0)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        index = bearerFind(devHandle);
+        if ((devHandle != NULL) && (index >= 0)) {
+            // Mark it as unusable first so that, if it is
+            // selected, the change is reported as from it
+            gBearer[index].isUp = false;
+            selectionUpdate(&change);
+            memset(&(gBearer[index]), 0, sizeof(gBearer[index]));
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+        uPortMutexUnlock(gMutex);
+        changeTell(&change);
+    }
+
+    return errorCode;
+}
+
+// Report the status of a bearer.
+int32_t uNetworkSelectReportStatus(uDeviceHandle_t devHandle, bool isUp)
+{
+    return bearerUpdate(devHandle, updateStatus, isUp ? 1 : 0, 0);
+}
+
+// Report a round-trip time.
+int32_t uNetworkSelectReportRtt(uDeviceHandle_t devHandle, int32_t rttMs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (rttMs >= 0) {
+        errorCode = bearerUpdate(devHandle, updateRtt, rttMs, 0);
+    }
+
+    return errorCode;
+}
+
+// Report a throughput.
+int32_t uNetworkSelectReportThroughput(uDeviceHandle_t devHandle,
+                                       uint32_t lengthBytes, int32_t timeMs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int32_t throughput = throughputCalculate(lengthBytes, timeMs);
+
+    if (throughput > 0) {
+        errorCode = bearerUpdate(devHandle, updateThroughput, throughput, 0);
+    }
+
+    return errorCode;
+}
+
+// Report the statistics of a socket.
+int32_t uNetworkSelectReportSockStats(uDeviceHandle_t devHandle,
+                                      const uSockStats_t *pStats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int32_t throughput;
+
+    if (pStats != NULL) {
+        throughput = throughputCalculate(pStats->txBytes, pStats->txBlockedMs);
+        if ((pStats->connectMs >= 0) || (throughput > 0)) {
+            errorCode = bearerUpdate(devHandle, updateRttAndThroughput,
+                                     pStats->connectMs, throughput);
+        }
+    }
+
+    return errorCode;
+}
+
+// Report the signal strength of a bearer.
+int32_t uNetworkSelectReportSignal(uDeviceHandle_t devHandle, int32_t signalDbm)
+{
+    return bearerUpdate(devHandle, updateSignal, signalDbm, 0);
+}
+
+// Report a failure on a bearer.
+int32_t uNetworkSelectReportFailure(uDeviceHandle_t devHandle)
+{
+    return bearerUpdate(devHandle, updateFailure, 0, 0);
+}
+
+// Get the bearer to use.
+int32_t uNetworkSelectGetBest(uDeviceHandle_t *pDevHandle,
+                              uNetworkType_t *pNetType)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pDevHandle != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+        if ((gMutex != NULL) && (uPortMutexLock(gMutex) == 0)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+            if (gSelected >= 0) {
+                *pDevHandle = gBearer[gSelected].devHandle;
+                if (pNetType != NULL) {
+                    *pNetType = gBearer[gSelected].netType;
+                }
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+            uPortMutexUnlock(gMutex);
+        }
+    }
+
+    return errorCode;
+}
+
+// Get the accounts kept for a bearer.
+int32_t uNetworkSelectGet(uDeviceHandle_t devHandle,
+                          uNetworkSelectBearer_t *pBearer)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int32_t index;
+
+    if (pBearer != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+        if ((gMutex != NULL) && (uPortMutexLock(gMutex) == 0)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+            index = bearerFind(devHandle);
+            if ((devHandle != NULL) && (index >= 0)) {
+                *pBearer = gBearer[index];
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+            uPortMutexUnlock(gMutex);
+        }
+    }
+
+    return errorCode;
+}
+
+// Set the callback for a change of selection.
+int32_t uNetworkSelectSetCallback(void (*pCallback) (uDeviceHandle_t oldDevHandle,
+                                                     uNetworkType_t oldNetType,
+                                                     uDeviceHandle_t newDevHandle,
+                                                     uNetworkType_t newNetType,
+                                                     void *pCallbackParam),
+                                  void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+
+    if (gMutex == NULL) {
+        errorCode = uPortMutexCreate(&gMutex);
+    }
+    if ((errorCode == 0) && (uPortMutexLock(gMutex) == 0)) {
+        gpCallback = pCallback;
+        gpCallbackParam = pCallbackParam;
+        uPortMutexUnlock(gMutex);
+    }
+
+    return errorCode;
+}
+
+// Remove everything.
+void uNetworkSelectClear()
+{
+    if (gMutex != NULL) {
+        U_PORT_MUTEX_LOCK(gMutex);
+        memset(gBearer, 0, sizeof(gBearer));
+        gSelected = -1;
+        gpCallback = NULL;
+        gpCallbackParam = NULL;
+        U_PORT_MUTEX_UNLOCK(gMutex);
+        uPortMutexDelete(gMutex);
+        gMutex = NULL;
+    }
+}
+
+// End of file
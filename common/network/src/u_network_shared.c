@@ -32,6 +32,12 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
+#include "string.h"    // memset(), strncpy()
+
+#include "u_error_common.h"
+
+#include "u_port_os.h"
+#include "u_port_heap.h"
 
 #include "u_device_shared.h"
 #include "u_network_shared.h"
@@ -40,10 +46,54 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_NETWORK_STATUS_HOLD_OFF_KEYS_MAX_NUM
+/** The number of keys under which status changes are coalesced
+ * separately while a hold-off is set: two for the cellular
+ * circuit-switched and packet-switched domains.  Status changes
+ * for any further key are delivered without a hold-off.
+ */
+# define U_NETWORK_STATUS_HOLD_OFF_KEYS_MAX_NUM 2
+#endif
+
+/** Room for a Wi-Fi BSSID string held with a status change:
+ * twelve hex digits plus a null terminator.
+ */
+#define U_NETWORK_STATUS_BSSID_STRING_LENGTH_BYTES 13
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The held and delivered status for one key of a network.
+ */
+typedef struct {
+    int32_t key;
+    bool inUse;
+    bool pending; /**< true if status is yet to be delivered. */
+    bool isUp;
+    uNetworkStatus_t status;
+    char bssid[U_NETWORK_STATUS_BSSID_STRING_LENGTH_BYTES];
+    bool delivered; /**< true once anything has been delivered. */
+    bool deliveredIsUp;
+    int32_t deliveredStatus;
+} uNetworkStatusHoldOffKey_t;
+
+/** The status callback data of a network as allocated by
+ * pUNetworkStatusCallbackDataGetOrAdd(); callbackData MUST be
+ * the first member since pStatusCallbackData is also treated
+ * as a plain #uNetworkStatusCallbackData_t.
+ */
+typedef struct {
+    uNetworkStatusCallbackData_t callbackData;
+    uDeviceHandle_t devHandle;
+    uNetworkType_t netType;
+    int32_t holdOffMs;
+    uPortTimerHandle_t timerHandle;
+    uPortMutexHandle_t mutex;
+    int32_t flapCount;
+    uNetworkStatusHoldOffKey_t key[U_NETWORK_STATUS_HOLD_OFF_KEYS_MAX_NUM];
+} uNetworkStatusCallbackContext_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -52,6 +102,126 @@
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Get the status value, the thing beyond isUp that is worth
+// delivering a change of, for a network type.
+static int32_t statusValue(uNetworkType_t netType,
+                           const uNetworkStatus_t *pStatus)
+{
+    int32_t value = 0;
+
+    switch (netType) {
+        case U_NETWORK_TYPE_CELL:
+            value = pStatus->cell.status;
+            break;
+        case U_NETWORK_TYPE_WIFI:
+            value = pStatus->wifi.status;
+            break;
+        default:
+            break;
+    }
+
+    return value;
+}
+
+// Timer callback for the status hold-off: deliver whatever has
+// been stable for the hold-off period, if it is a change.
+static void holdOffTimerCallback(const uPortTimerHandle_t timerHandle,
+                                 void *pParameter)
+{
+    uNetworkStatusCallbackContext_t *pContext = (uNetworkStatusCallbackContext_t *) pParameter;
+    uNetworkStatusHoldOffKey_t deliver[U_NETWORK_STATUS_HOLD_OFF_KEYS_MAX_NUM];
+    size_t numDeliver = 0;
+    uNetworkStatusHoldOffKey_t *pKey;
+    uNetworkStatusCallback_t pCallback;
+
+    (void) timerHandle;
+
+    if (uPortMutexLock(pContext->mutex) == 0) {
+        for (size_t x = 0; x < sizeof(pContext->key) / sizeof(pContext->key[0]); x++) {
+            pKey = &(pContext->key[x]);
+            if (pKey->inUse && pKey->pending) {
+                pKey->pending = false;
+                if (!pKey->delivered || (pKey->isUp != pKey->deliveredIsUp) ||
+                    (statusValue(pContext->netType, &(pKey->status)) != pKey->deliveredStatus)) {
+                    pKey->delivered = true;
+                    pKey->deliveredIsUp = pKey->isUp;
+                    pKey->deliveredStatus = statusValue(pContext->netType, &(pKey->status));
+                    deliver[numDeliver] = *pKey;
+                    numDeliver++;
+                }
+            }
+        }
+        pCallback = pContext->callbackData.pCallback;
+        uPortMutexUnlock(pContext->mutex);
+
+        // Call the user outside the lock
+        for (size_t x = 0; (x < numDeliver) && (pCallback != NULL); x++) {
+            pKey = &(deliver[x]);
+            if ((pContext->netType == U_NETWORK_TYPE_WIFI) &&
+                (pKey->status.wifi.pBssid != NULL)) {
+                // Point at our copy of the BSSID
+                pKey->status.wifi.pBssid = pKey->bssid;
+            }
+            pCallback(pContext->devHandle, pContext->netType, pKey->isUp,
+                      &(pKey->status), pContext->callbackData.pCallbackParameter);
+        }
+    }
+}
+
+// Hold a status change, restarting the hold-off timer; returns
+// false if the change could not be held and so should be
+// delivered immediately.
+static bool holdOff(uNetworkStatusCallbackContext_t *pContext,
+                    int32_t key, bool isUp, const uNetworkStatus_t *pStatus)
+{
+    bool held = false;
+    uNetworkStatusHoldOffKey_t *pKey = NULL;
+    uNetworkStatusHoldOffKey_t *pFree = NULL;
+
+    if (uPortMutexLock(pContext->mutex) == 0) {
+        if (pContext->holdOffMs > 0) {
+            for (size_t x = 0; (pKey == NULL) &&
+                 (x < sizeof(pContext->key) / sizeof(pContext->key[0])); x++) {
+                if (!pContext->key[x].inUse) {
+                    if (pFree == NULL) {
+                        pFree = &(pContext->key[x]);
+                    }
+                } else if (pContext->key[x].key == key) {
+                    pKey = &(pContext->key[x]);
+                }
+            }
+            if ((pKey == NULL) && (pFree != NULL)) {
+                pKey = pFree;
+                memset(pKey, 0, sizeof(*pKey));
+                pKey->inUse = true;
+                pKey->key = key;
+            }
+            if (pKey != NULL) {
+                if (pKey->pending && (pKey->isUp != isUp)) {
+                    // A change on top of a change that has not
+                    // yet been delivered: a flap
+                    pContext->flapCount++;
+                }
+                pKey->pending = true;
+                pKey->isUp = isUp;
+                pKey->status = *pStatus;
+                if ((pContext->netType == U_NETWORK_TYPE_WIFI) &&
+                    (pStatus->wifi.pBssid != NULL)) {
+                    strncpy(pKey->bssid, pStatus->wifi.pBssid, sizeof(pKey->bssid));
+                    pKey->bssid[sizeof(pKey->bssid) - 1] = 0;
+                }
+                held = (uPortTimerStart(pContext->timerHandle) == 0);
+                if (!held) {
+                    pKey->pending = false;
+                }
+            }
+        }
+        uPortMutexUnlock(pContext->mutex);
+    }
+
+    return held;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -137,4 +307,135 @@ uDeviceNetworkData_t *pUNetworkGetNetworkData(uDeviceInstance_t *pInstance,
     return pNetworkData;
 }
 
+// Determine whether a network bring-up has been cancelled.
+bool uNetworkIsCancelled(uDeviceHandle_t devHandle, uNetworkType_t netType)
+{
+    bool cancelled = false;
+    uDeviceInstance_t *pInstance;
+    uDeviceNetworkData_t *pNetworkData;
+
+    if (uDeviceGetInstance(devHandle, &pInstance) == 0) {
+        pNetworkData = pUNetworkGetNetworkData(pInstance, netType);
+        cancelled = (pNetworkData != NULL) && pNetworkData->busy && pNetworkData->cancel;
+    }
+
+    return cancelled;
+}
+
+// Get the status callback data of a network, adding it if necessary.
+uNetworkStatusCallbackData_t *pUNetworkStatusCallbackDataGetOrAdd(uDeviceNetworkData_t *pNetworkData)
+{
+    uNetworkStatusCallbackContext_t *pContext;
+
+    if (pNetworkData->pStatusCallbackData == NULL) {
+        pContext = (uNetworkStatusCallbackContext_t *) pUPortMalloc(sizeof(*pContext));
+        if (pContext != NULL) {
+            memset(pContext, 0, sizeof(*pContext));
+            pNetworkData->pStatusCallbackData = pContext;
+        }
+    }
+
+    return (uNetworkStatusCallbackData_t *) pNetworkData->pStatusCallbackData;
+}
+
+// Free the status callback data of a network.
+void uNetworkStatusCallbackDataFree(uDeviceNetworkData_t *pNetworkData)
+{
+    uNetworkStatusCallbackContext_t *pContext = (uNetworkStatusCallbackContext_t *)
+                                                pNetworkData->pStatusCallbackData;
+
+    if (pContext != NULL) {
+        if (pContext->timerHandle != NULL) {
+            uPortTimerDelete(pContext->timerHandle);
+        }
+        if (pContext->mutex != NULL) {
+            uPortMutexDelete(pContext->mutex);
+        }
+        uPortFree(pContext);
+        pNetworkData->pStatusCallbackData = NULL;
+    }
+}
+
+// Set the status hold-off of a network.
+int32_t uNetworkStatusHoldOffSet(uDeviceHandle_t devHandle,
+                                 uNetworkType_t netType,
+                                 uDeviceNetworkData_t *pNetworkData,
+                                 int32_t holdOffMs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    uNetworkStatusCallbackContext_t *pContext;
+
+    pContext = (uNetworkStatusCallbackContext_t *) pUNetworkStatusCallbackDataGetOrAdd(pNetworkData);
+    if (pContext != NULL) {
+        pContext->devHandle = devHandle;
+        pContext->netType = netType;
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if ((holdOffMs > 0) && (pContext->mutex == NULL)) {
+            errorCode = uPortMutexCreate(&(pContext->mutex));
+        }
+        if ((errorCode == 0) && (holdOffMs > 0)) {
+            if (pContext->timerHandle == NULL) {
+                errorCode = uPortTimerCreate(&(pContext->timerHandle), "netHoldOff",
+                                             holdOffTimerCallback, pContext,
+                                             (uint32_t) holdOffMs, false);
+            } else {
+                uPortTimerStop(pContext->timerHandle);
+                errorCode = uPortTimerChange(pContext->timerHandle,
+                                             (uint32_t) holdOffMs);
+            }
+        }
+        if (pContext->mutex != NULL) {
+            U_PORT_MUTEX_LOCK(pContext->mutex);
+            if (errorCode == 0) {
+                pContext->holdOffMs = holdOffMs;
+                pContext->flapCount = 0;
+            } else {
+                pContext->holdOffMs = 0;
+            }
+            if (pContext->holdOffMs <= 0) {
+                // Anything held is dropped: the hold-off no longer applies
+                for (size_t x = 0; x < sizeof(pContext->key) / sizeof(pContext->key[0]); x++) {
+                    pContext->key[x].pending = false;
+                }
+            }
+            U_PORT_MUTEX_UNLOCK(pContext->mutex);
+        }
+    }
+
+    return errorCode;
+}
+
+// Get the flap count of a network.
+int32_t uNetworkStatusFlapCountGet(const uDeviceNetworkData_t *pNetworkData)
+{
+    int32_t flapCount = 0;
+    const uNetworkStatusCallbackContext_t *pContext = (const uNetworkStatusCallbackContext_t *)
+                                                      pNetworkData->pStatusCallbackData;
+
+    if (pContext != NULL) {
+        flapCount = pContext->flapCount;
+    }
+
+    return flapCount;
+}
+
+// Pass a status change to the status callback of a network.
+void uNetworkStatusCallbackCall(uDeviceHandle_t devHandle,
+                                uNetworkType_t netType,
+                                uDeviceNetworkData_t *pNetworkData,
+                                int32_t key, bool isUp,
+                                uNetworkStatus_t *pStatus)
+{
+    uNetworkStatusCallbackContext_t *pContext = (uNetworkStatusCallbackContext_t *)
+                                                pNetworkData->pStatusCallbackData;
+
+    if ((pContext != NULL) && (pContext->callbackData.pCallback != NULL)) {
+        if ((pContext->holdOffMs <= 0) || (pContext->mutex == NULL) ||
+            !holdOff(pContext, key, isUp, pStatus)) {
+            pContext->callbackData.pCallback(devHandle, netType, isUp, pStatus,
+                                             pContext->callbackData.pCallbackParameter);
+        }
+    }
+}
+
 // End of file
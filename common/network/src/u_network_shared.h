@@ -67,6 +67,83 @@ uDeviceHandle_t uNetworkGetDeviceHandle(uDeviceHandle_t devHandle,
 uDeviceNetworkData_t *pUNetworkGetNetworkData(uDeviceInstance_t *pInstance,
                                               uNetworkType_t netType);
 
+/** Determine whether uNetworkInterfaceUpCancel() has been called
+ * for a network that is being brought up; intended to be called
+ * by the code that brings a network up, from within
+ * uNetworkInterfaceUp(), in order to give up early.  The device
+ * API is not locked.
+ *
+ * @param devHandle the handle of the device.
+ * @param netType   the network type.
+ * @return          true if the bring-up should be abandoned.
+ */
+bool uNetworkIsCancelled(uDeviceHandle_t devHandle, uNetworkType_t netType);
+
+/** Get the status callback data of a network, allocating it if
+ * there is none yet; the returned structure is the first member of
+ * a larger one that also carries the hold-off state for
+ * uNetworkSetStatusHoldOff().  Must be called between uDeviceLock()
+ * and uDeviceUnlock().
+ *
+ * @param pNetworkData the network data.
+ * @return             a pointer to the status callback data or NULL
+ *                     if there is no memory.
+ */
+uNetworkStatusCallbackData_t *pUNetworkStatusCallbackDataGetOrAdd(uDeviceNetworkData_t *pNetworkData);
+
+/** Free the status callback data of a network, including any
+ * hold-off timer.  Must be called between uDeviceLock() and
+ * uDeviceUnlock().
+ *
+ * @param pNetworkData the network data.
+ */
+void uNetworkStatusCallbackDataFree(uDeviceNetworkData_t *pNetworkData);
+
+/** Set the status hold-off of a network, as described for
+ * uNetworkSetStatusHoldOff(), allocating the status callback data
+ * if there is none yet.  Must be called between uDeviceLock() and
+ * uDeviceUnlock().
+ *
+ * @param devHandle    the handle of the device.
+ * @param netType      the network type.
+ * @param pNetworkData the network data.
+ * @param holdOffMs    the hold-off in milliseconds, zero to remove it.
+ * @return             zero on success else negative error code.
+ */
+int32_t uNetworkStatusHoldOffSet(uDeviceHandle_t devHandle,
+                                 uNetworkType_t netType,
+                                 uDeviceNetworkData_t *pNetworkData,
+                                 int32_t holdOffMs);
+
+/** Get the number of status changes of a network absorbed by its
+ * hold-off.
+ *
+ * @param pNetworkData the network data.
+ * @return             the flap count.
+ */
+int32_t uNetworkStatusFlapCountGet(const uDeviceNetworkData_t *pNetworkData);
+
+/** Pass a status change to the status callback of a network, if
+ * there is one, either immediately or, if a hold-off has been set,
+ * once the status has been stable for the hold-off period.  To be
+ * called by the network-specific status callbacks in place of
+ * calling the user callback directly; the device API is not locked.
+ *
+ * @param devHandle    the handle of the device.
+ * @param netType      the network type.
+ * @param pNetworkData the network data.
+ * @param key          the key under which status changes are
+ *                     coalesced, e.g. the domain for cellular.
+ * @param isUp         true if the network is up.
+ * @param[in] pStatus  the detailed status; for Wi-Fi the BSSID
+ *                     string is copied if the change is held.
+ */
+void uNetworkStatusCallbackCall(uDeviceHandle_t devHandle,
+                                uNetworkType_t netType,
+                                uDeviceNetworkData_t *pNetworkData,
+                                int32_t key, bool isUp,
+                                uNetworkStatus_t *pStatus);
+
 #ifdef __cplusplus
 }
 #endif
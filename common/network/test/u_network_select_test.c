@@ -0,0 +1,256 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Test for the network bearer selection API: these tests
+ * need no hardware, the device handles are just tokens.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+
+#include "u_device.h"
+#include "u_network.h"
+#include "u_sock.h"
+#include "u_network_select.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_NETWORK_SELECT_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Something to take the address of for the "device handles".
+ */
+static int32_t gToken[2];
+
+/** The number of times selectCallback() has been called.
+ */
+static int32_t gCallbackCount = 0;
+
+/** The old device handle passed to selectCallback().
+ */
+static uDeviceHandle_t gOldDevHandle = NULL;
+
+/** The new device handle passed to selectCallback().
+ */
+static uDeviceHandle_t gNewDevHandle = NULL;
+
+/** The new network type passed to selectCallback().
+ */
+static uNetworkType_t gNewNetType = U_NETWORK_TYPE_NONE;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Callback for a change of selection.
+static void selectCallback(uDeviceHandle_t oldDevHandle,
+                           uNetworkType_t oldNetType,
+                           uDeviceHandle_t newDevHandle,
+                           uNetworkType_t newNetType,
+                           void *pCallbackParam)
+{
+    uDeviceHandle_t devHandle = NULL;
+
+    (void) oldNetType;
+    gOldDevHandle = oldDevHandle;
+    gNewDevHandle = newDevHandle;
+    gNewNetType = newNetType;
+    // Check that the API may be called from here
+    uNetworkSelectGetBest(&devHandle, NULL);
+    if ((devHandle == newDevHandle) && (pCallbackParam == &gCallbackCount)) {
+        gCallbackCount++;
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Test selection between two bearers and failover.
+ */
+U_PORT_TEST_FUNCTION("[networkSelect]", "networkSelectBasic")
+{
+    int32_t heapUsed;
+    uDeviceHandle_t wifiHandle = (uDeviceHandle_t) &(gToken[0]);
+    uDeviceHandle_t cellHandle = (uDeviceHandle_t) &(gToken[1]);
+    uDeviceHandle_t devHandle = NULL;
+    uNetworkType_t netType = U_NETWORK_TYPE_NONE;
+    uNetworkSelectBearer_t bearer;
+    uSockStats_t stats;
+    int32_t cellScore;
+    bool withinHysteresis = false;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    U_PORT_TEST_ASSERT(uNetworkSelectGetBest(&devHandle, NULL) < 0);
+    U_PORT_TEST_ASSERT(uNetworkSelectSetCallback(selectCallback, &gCallbackCount) == 0);
+
+    U_TEST_PRINT_LINE("adding Wi-Fi at no cost and cellular at a cost of 50%%.");
+    U_PORT_TEST_ASSERT(uNetworkSelectAdd(wifiHandle, U_NETWORK_TYPE_WIFI, 0) == 0);
+    U_PORT_TEST_ASSERT(gCallbackCount == 1);
+    U_PORT_TEST_ASSERT((gOldDevHandle == NULL) && (gNewDevHandle == wifiHandle));
+    U_PORT_TEST_ASSERT(gNewNetType == U_NETWORK_TYPE_WIFI);
+    U_PORT_TEST_ASSERT(uNetworkSelectAdd(cellHandle, U_NETWORK_TYPE_CELL, 50) == 0);
+    U_PORT_TEST_ASSERT(gCallbackCount == 1);
+    U_PORT_TEST_ASSERT(uNetworkSelectGetBest(&devHandle, &netType) == 0);
+    U_PORT_TEST_ASSERT((devHandle == wifiHandle) && (netType == U_NETWORK_TYPE_WIFI));
+
+    U_TEST_PRINT_LINE("measuring Wi-Fi as fast.");
+    U_PORT_TEST_ASSERT(uNetworkSelectReportRtt(wifiHandle, 50) == 0);
+    U_PORT_TEST_ASSERT(uNetworkSelectReportThroughput(wifiHandle, 100000, 1000) == 0);
+    U_PORT_TEST_ASSERT(uNetworkSelectGet(wifiHandle, &bearer) == 0);
+    U_PORT_TEST_ASSERT(bearer.isUp && (bearer.rttMs == 50));
+    U_PORT_TEST_ASSERT(bearer.throughputBytesPerSecond == 100000);
+
+    U_TEST_PRINT_LINE("measuring cellular.");
+    U_PORT_TEST_ASSERT(uNetworkSelectGet(cellHandle, &bearer) == 0);
+    U_PORT_TEST_ASSERT(bearer.isUp && (bearer.rttMs < 0) &&
+                       (bearer.throughputBytesPerSecond < 0));
+    U_PORT_TEST_ASSERT(bearer.costPercent == 50);
+    U_PORT_TEST_ASSERT(bearer.score > 0);
+    U_PORT_TEST_ASSERT(uNetworkSelectReportRtt(cellHandle, 100) == 0);
+    U_PORT_TEST_ASSERT(uNetworkSelectReportRtt(cellHandle, 900) == 0);
+    U_PORT_TEST_ASSERT(uNetworkSelectGet(cellHandle, &bearer) == 0);
+    U_PORT_TEST_ASSERT(bearer.rttMs == (100 * (U_NETWORK_SELECT_SMOOTHING_FACTOR - 1) + 900) /
+                       U_NETWORK_SELECT_SMOOTHING_FACTOR);
+    U_PORT_TEST_ASSERT(uNetworkSelectReportThroughput(cellHandle, 20000, 1000) == 0);
+    U_PORT_TEST_ASSERT(uNetworkSelectGet(cellHandle, &bearer) == 0);
+    U_PORT_TEST_ASSERT(bearer.throughputBytesPerSecond == 20000);
+    cellScore = bearer.score;
+    U_PORT_TEST_ASSERT(uNetworkSelectGetBest(&devHandle, NULL) == 0);
+    U_PORT_TEST_ASSERT(devHandle == wifiHandle);
+    U_PORT_TEST_ASSERT(gCallbackCount == 1);
+
+    U_TEST_PRINT_LINE("slowing Wi-Fi down gradually (cellular score %d).", cellScore);
+    memset(&stats, 0, sizeof(stats));
+    stats.connectMs = cellScore * 2;
+    for (size_t x = 0; (x < 50) && (gCallbackCount == 1); x++) {
+        U_PORT_TEST_ASSERT(uNetworkSelectReportSockStats(wifiHandle, &stats) == 0);
+        U_PORT_TEST_ASSERT(uNetworkSelectGet(wifiHandle, &bearer) == 0);
+        if (((int64_t) bearer.score) * (100 - U_NETWORK_SELECT_HYSTERESIS_PERCENT) <=
+            ((int64_t) cellScore) * 100) {
+            // Within hysteresis, Wi-Fi must still be selected
+            U_PORT_TEST_ASSERT(gCallbackCount == 1);
+            if (bearer.score > cellScore) {
+                withinHysteresis = true;
+            }
+        }
+    }
+    U_PORT_TEST_ASSERT(withinHysteresis);
+    U_PORT_TEST_ASSERT(gCallbackCount == 2);
+    U_PORT_TEST_ASSERT((gOldDevHandle == wifiHandle) && (gNewDevHandle == cellHandle));
+    U_PORT_TEST_ASSERT(gNewNetType == U_NETWORK_TYPE_CELL);
+    U_PORT_TEST_ASSERT(uNetworkSelectGetBest(&devHandle, &netType) == 0);
+    U_PORT_TEST_ASSERT((devHandle == cellHandle) && (netType == U_NETWORK_TYPE_CELL));
+
+    U_TEST_PRINT_LINE("recovering Wi-Fi.");
+    stats.connectMs = 10;
+    stats.txBytes = 100000;
+    stats.txBlockedMs = 1000;
+    for (size_t x = 0; (x < 50) && (gCallbackCount == 2); x++) {
+        U_PORT_TEST_ASSERT(uNetworkSelectReportSockStats(wifiHandle, &stats) == 0);
+    }
+    U_PORT_TEST_ASSERT(gCallbackCount == 3);
+    U_PORT_TEST_ASSERT((gOldDevHandle == cellHandle) && (gNewDevHandle == wifiHandle));
+
+    U_TEST_PRINT_LINE("failing over on Wi-Fi going down.");
+    U_PORT_TEST_ASSERT(uNetworkSelectReportStatus(wifiHandle, false) == 0);
+    U_PORT_TEST_ASSERT(gCallbackCount == 4);
+    U_PORT_TEST_ASSERT((gOldDevHandle == wifiHandle) && (gNewDevHandle == cellHandle));
+    U_PORT_TEST_ASSERT(uNetworkSelectGet(wifiHandle, &bearer) == 0);
+    U_PORT_TEST_ASSERT(!bearer.isUp && (bearer.score < 0));
+    U_PORT_TEST_ASSERT(uNetworkSelectReportStatus(wifiHandle, true) == 0);
+    U_PORT_TEST_ASSERT(gCallbackCount == 5);
+    U_PORT_TEST_ASSERT(gNewDevHandle == wifiHandle);
+
+    U_TEST_PRINT_LINE("failing over on repeated failures.");
+    for (size_t x = 0; x < U_NETWORK_SELECT_FAILURES_MAX; x++) {
+        U_PORT_TEST_ASSERT(gCallbackCount == 5);
+        U_PORT_TEST_ASSERT(uNetworkSelectReportFailure(wifiHandle) == 0);
+    }
+    U_PORT_TEST_ASSERT(gCallbackCount == 6);
+    U_PORT_TEST_ASSERT(gNewDevHandle == cellHandle);
+
+    U_TEST_PRINT_LINE("weak cellular signal and then nothing left.");
+    U_PORT_TEST_ASSERT(uNetworkSelectGet(cellHandle, &bearer) == 0);
+    cellScore = bearer.score;
+    U_PORT_TEST_ASSERT(uNetworkSelectReportSignal(cellHandle,
+                                                  U_NETWORK_SELECT_SIGNAL_WEAK_DBM - 1) == 0);
+    U_PORT_TEST_ASSERT(uNetworkSelectGet(cellHandle, &bearer) == 0);
+    U_PORT_TEST_ASSERT(bearer.signalDbm == U_NETWORK_SELECT_SIGNAL_WEAK_DBM - 1);
+    U_PORT_TEST_ASSERT(bearer.score > cellScore);
+    U_PORT_TEST_ASSERT(uNetworkSelectRemove(cellHandle) == 0);
+    U_PORT_TEST_ASSERT(gCallbackCount == 7);
+    U_PORT_TEST_ASSERT((gOldDevHandle == cellHandle) && (gNewDevHandle == NULL));
+    U_PORT_TEST_ASSERT(uNetworkSelectGetBest(&devHandle,
+                                             NULL) == (int32_t) U_ERROR_COMMON_NOT_FOUND);
+    U_PORT_TEST_ASSERT(uNetworkSelectGet(cellHandle, &bearer) < 0);
+
+    uNetworkSelectClear();
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+// End of file
@@ -110,6 +110,21 @@
  */
 #define U_TEST_PRINT_LINE_X(format, ...) uPortLog(U_TEST_PREFIX_X format "\n", ##__VA_ARGS__)
 
+#ifndef U_NETWORK_TEST_STATUS_HOLD_OFF_MS
+/** The status hold-off to apply to cellular and Wi-Fi in the
+ * second round of the networkOutage test.
+ */
+# define U_NETWORK_TEST_STATUS_HOLD_OFF_MS 1000
+#endif
+
+#ifndef U_NETWORK_TEST_OPEN_MULTI_MAX_NUM
+/** The maximum number of devices to open at once in the
+ * networkOpenMulti test, not including the deliberately
+ * invalid one.
+ */
+# define U_NETWORK_TEST_OPEN_MULTI_MAX_NUM 4
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -221,6 +236,30 @@ static uNetworkCfgWifi_t gNetworkCfgWifiNetStatus = {
 static uNetworkStatusCallbackParameters_t gNetworkStatusCallbackParameters[U_NETWORK_TYPE_MAX_NUM];
 #endif
 
+/** Given by upAsyncCallback() each time it is called.
+ */
+static uPortSemaphoreHandle_t gUpAsyncSemaphore = NULL;
+
+/** The last error code passed to upAsyncCallback().
+ */
+static volatile int32_t gUpAsyncErrorCode = 0;
+
+/** Given by openAsyncCallback() each time it is called.
+ */
+static uPortSemaphoreHandle_t gOpenAsyncSemaphore = NULL;
+
+/** The device configuration passed to openAsyncCallback().
+ */
+static const uDeviceCfg_t *volatile gpOpenAsyncDeviceCfg = NULL;
+
+/** The device handle passed to openAsyncCallback().
+ */
+static volatile uDeviceHandle_t gOpenAsyncDevHandle = NULL;
+
+/** The error code passed to openAsyncCallback().
+ */
+static volatile int32_t gOpenAsyncErrorCode = 0;
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -387,6 +426,38 @@ static bool keepGoingCallback(uDeviceHandle_t devHandle)
     return keepGoing;
 }
 
+// Callback for uNetworkInterfaceUpAsync().
+static void upAsyncCallback(uDeviceHandle_t devHandle,
+                            uNetworkType_t netType,
+                            int32_t errorCode,
+                            void *pParameter)
+{
+    (void) devHandle;
+    (void) pParameter;
+
+    if (errorCode != 0) {
+        gUpAsyncErrorCode = errorCode;
+    }
+    U_TEST_PRINT_LINE("%s up, asynchronously, with result %d.",
+                      gpUNetworkTestTypeName[netType], errorCode);
+    uPortSemaphoreGive(gUpAsyncSemaphore);
+}
+
+// Callback for uDeviceOpenAsync().
+static void openAsyncCallback(const uDeviceCfg_t *pDeviceCfg,
+                              uDeviceHandle_t devHandle,
+                              int32_t errorCode,
+                              void *pCallbackParam)
+{
+    gpOpenAsyncDeviceCfg = pDeviceCfg;
+    gOpenAsyncDevHandle = devHandle;
+    gOpenAsyncErrorCode = errorCode;
+    if (pCallbackParam != (void *) &gOpenAsyncSemaphore) {
+        gOpenAsyncErrorCode = -1000;
+    }
+    uPortSemaphoreGive(gOpenAsyncSemaphore);
+}
+
 #if defined(U_CFG_TEST_NET_STATUS_SHORT_RANGE) || defined(U_CFG_TEST_NET_STATUS_CELL)
 static void networkStatusCallback(uDeviceHandle_t devHandle,
                                   uNetworkType_t netType,
@@ -522,6 +593,7 @@ U_PORT_TEST_FUNCTION("[network]", "networkSock")
     uDeviceHandle_t devHandle;
     int32_t heapUsed;
     int32_t heapSockInitLoss = 0;
+    size_t numNetworks = 0;
 
     // Make sure we start fresh for this test case
     uNetworkTestCleanUp();
@@ -553,10 +625,36 @@ U_PORT_TEST_FUNCTION("[network]", "networkSock")
     // clear them up here
     uSockDeinit();
 
+    for (uNetworkTestList_t *pTmp = pList; pTmp != NULL; pTmp = pTmp->pNext) {
+        numNetworks++;
+    }
+    U_PORT_TEST_ASSERT(uPortSemaphoreCreate(&gUpAsyncSemaphore, 0,
+                                            (uint32_t) numNetworks + 1) == 0);
+    U_PORT_TEST_ASSERT(uNetworkInterfaceUpAsync(NULL, U_NETWORK_TYPE_CELL, NULL,
+                                                upAsyncCallback, NULL) < 0);
+
     // Do this twice to prove that we can go from down
-    // back to up again
+    // back to up again, the second time bringing all of
+    // the networks up at once with uNetworkInterfaceUpAsync()
     for (size_t a = 0; a < 2; a++) {
-        // Bring up each network configuration
+        if (a > 0) {
+            gUpAsyncErrorCode = 0;
+            for (uNetworkTestList_t *pTmp = pList; pTmp != NULL; pTmp = pTmp->pNext) {
+                U_TEST_PRINT_LINE("bringing up %s asynchronously...",
+                                  gpUNetworkTestTypeName[pTmp->networkType]);
+                U_PORT_TEST_ASSERT(uNetworkInterfaceUpAsync(*pTmp->pDevHandle,
+                                                            pTmp->networkType,
+                                                            pTmp->pNetworkCfg,
+                                                            upAsyncCallback,
+                                                            NULL) == 0);
+            }
+            for (size_t x = 0; x < numNetworks; x++) {
+                uPortSemaphoreTake(gUpAsyncSemaphore);
+            }
+            U_PORT_TEST_ASSERT(gUpAsyncErrorCode == 0);
+        }
+        // Bring up each network configuration, the second time
+        // around they are up already so this will do nothing
         for (uNetworkTestList_t *pTmp = pList; pTmp != NULL; pTmp = pTmp->pNext) {
             devHandle = *pTmp->pDevHandle;
 
@@ -588,6 +686,8 @@ U_PORT_TEST_FUNCTION("[network]", "networkSock")
         }
     }
     uNetworkTestListFree();
+    uPortSemaphoreDelete(gUpAsyncSemaphore);
+    gUpAsyncSemaphore = NULL;
 
     uDeviceDeinit();
     uPortDeinit();
@@ -616,6 +716,130 @@ U_PORT_TEST_FUNCTION("[network]", "networkSock")
 #endif
 }
 
+/** Test opening devices with uDeviceOpenMulti() and uDeviceOpenAsync().
+ */
+U_PORT_TEST_FUNCTION("[network]", "networkOpenMulti")
+{
+    uDeviceCfg_t deviceCfgs[U_NETWORK_TEST_OPEN_MULTI_MAX_NUM + 1];
+    uDeviceHandle_t *pDevHandles[U_NETWORK_TEST_OPEN_MULTI_MAX_NUM] = {0};
+    uDeviceHandle_t devHandles[U_NETWORK_TEST_OPEN_MULTI_MAX_NUM + 1];
+    int32_t errorCodes[U_NETWORK_TEST_OPEN_MULTI_MAX_NUM + 1];
+    size_t numDevices = 0;
+    bool found;
+    int32_t heapUsed;
+
+    // Make sure we start fresh for this test case
+    uNetworkTestCleanUp();
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uDeviceInit() == 0);
+
+    // Collect the distinct devices from the list of everything
+    for (uNetworkTestList_t *pTmp = pUNetworkTestListAlloc(NULL);
+         (pTmp != NULL) && (numDevices < U_NETWORK_TEST_OPEN_MULTI_MAX_NUM);
+         pTmp = pTmp->pNext) {
+        found = false;
+        for (size_t x = 0; (x < numDevices) && !found; x++) {
+            found = (pDevHandles[x] == pTmp->pDevHandle);
+        }
+        if (!found) {
+            deviceCfgs[numDevices] = *pTmp->pDeviceCfg;
+            pDevHandles[numDevices] = pTmp->pDevHandle;
+            numDevices++;
+        }
+    }
+    uNetworkTestListFree();
+    // Add one on the end which cannot be opened
+    memset(&(deviceCfgs[numDevices]), 0, sizeof(deviceCfgs[numDevices]));
+    deviceCfgs[numDevices].deviceType = U_DEVICE_TYPE_NONE;
+
+    // Parameter checks
+    U_PORT_TEST_ASSERT(uDeviceOpenMulti(NULL, 1, devHandles, errorCodes) < 0);
+    U_PORT_TEST_ASSERT(uDeviceOpenMulti(deviceCfgs, 0, devHandles, errorCodes) < 0);
+    U_PORT_TEST_ASSERT(uDeviceOpenMulti(deviceCfgs, 1, NULL, errorCodes) < 0);
+    U_PORT_TEST_ASSERT(uDeviceOpenAsync(NULL, openAsyncCallback,
+                                        (void *) &gOpenAsyncSemaphore) < 0);
+    U_PORT_TEST_ASSERT(uDeviceOpenAsync(deviceCfgs, NULL, NULL) < 0);
+
+    U_TEST_PRINT_LINE("opening %d device(s) at once, plus one invalid one...",
+                      (int32_t) numDevices);
+    memset(devHandles, 0xff, sizeof(devHandles));
+    memset(errorCodes, 0xff, sizeof(errorCodes));
+    U_PORT_TEST_ASSERT(uDeviceOpenMulti(deviceCfgs, numDevices + 1, devHandles,
+                                        errorCodes) == (int32_t) numDevices);
+    for (size_t x = 0; x < numDevices; x++) {
+        U_TEST_PRINT_LINE("device %d (%s): error code %d.", (int32_t) x,
+                          gpUNetworkTestDeviceTypeName[deviceCfgs[x].deviceType],
+                          errorCodes[x]);
+        U_PORT_TEST_ASSERT(errorCodes[x] == 0);
+        U_PORT_TEST_ASSERT(devHandles[x] != NULL);
+        for (size_t y = 0; y < x; y++) {
+            U_PORT_TEST_ASSERT(devHandles[y] != devHandles[x]);
+        }
+        // Store the handle where uNetworkTestCleanUp() will find it
+        *pDevHandles[x] = devHandles[x];
+    }
+    U_TEST_PRINT_LINE("invalid device: error code %d.", errorCodes[numDevices]);
+    U_PORT_TEST_ASSERT(errorCodes[numDevices] < 0);
+    U_PORT_TEST_ASSERT(devHandles[numDevices] == NULL);
+
+    // Close them all again and re-open each one with uDeviceOpenAsync()
+    U_PORT_TEST_ASSERT(uPortSemaphoreCreate(&gOpenAsyncSemaphore, 0, 1) == 0);
+    for (size_t x = 0; x < numDevices + 1; x++) {
+        if (x < numDevices) {
+            U_TEST_PRINT_LINE("closing device %d and opening it again asynchronously...",
+                              (int32_t) x);
+            U_PORT_TEST_ASSERT(uDeviceClose(*pDevHandles[x], false) == 0);
+            *pDevHandles[x] = NULL;
+        } else {
+            U_TEST_PRINT_LINE("opening the invalid device asynchronously...");
+        }
+        gpOpenAsyncDeviceCfg = NULL;
+        gOpenAsyncDevHandle = NULL;
+        gOpenAsyncErrorCode = 1;
+        U_PORT_TEST_ASSERT(uDeviceOpenAsync(&(deviceCfgs[x]), openAsyncCallback,
+                                            (void *) &gOpenAsyncSemaphore) == 0);
+        U_PORT_TEST_ASSERT(uPortSemaphoreTake(gOpenAsyncSemaphore) == 0);
+        U_TEST_PRINT_LINE("error code %d.", gOpenAsyncErrorCode);
+        U_PORT_TEST_ASSERT(gpOpenAsyncDeviceCfg == &(deviceCfgs[x]));
+        if (x < numDevices) {
+            U_PORT_TEST_ASSERT(gOpenAsyncErrorCode == 0);
+            U_PORT_TEST_ASSERT(gOpenAsyncDevHandle != NULL);
+            *pDevHandles[x] = gOpenAsyncDevHandle;
+            U_PORT_TEST_ASSERT(uDeviceClose(*pDevHandles[x], false) == 0);
+            *pDevHandles[x] = NULL;
+        } else {
+            U_PORT_TEST_ASSERT(gOpenAsyncErrorCode < 0);
+            U_PORT_TEST_ASSERT(gOpenAsyncDevHandle == NULL);
+        }
+    }
+    uPortSemaphoreDelete(gOpenAsyncSemaphore);
+    gOpenAsyncSemaphore = NULL;
+
+    uDeviceDeinit();
+    uPortDeinit();
+
+#ifndef __XTENSA__
+    // Check for memory leaks: see networkSock for why this is
+    // not done for ESP32
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("%d byte(s) of heap were lost to the C library"
+                      " during this test and we have leaked %d byte(s).",
+                      gSystemHeapLost, heapUsed - gSystemHeapLost);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed < 0) || (heapUsed <= (int32_t) gSystemHeapLost));
+#else
+    (void) heapUsed;
+#endif
+}
+
 #if defined(U_BLE_TEST_CFG_REMOTE_SPS_CENTRAL) || defined(U_BLE_TEST_CFG_REMOTE_SPS_PERIPHERAL)
 /** Test BLE network.
  */
@@ -1131,6 +1355,17 @@ U_PORT_TEST_FUNCTION("[network]", "networkOutage")
                                                          pTmp->networkType,
                                                          networkStatusCallback,
                                                          gNetworkStatusCallbackParameters) == 0);
+            if ((a > 0) && (pTmp->networkType != U_NETWORK_TYPE_BLE)) {
+                // Second time around, only deliver stable status changes
+                U_TEST_PRINT_LINE_X("setting a status hold-off of %d ms for %s...", a,
+                                    U_NETWORK_TEST_STATUS_HOLD_OFF_MS,
+                                    gpUNetworkTestTypeName[pTmp->networkType]);
+                U_PORT_TEST_ASSERT(uNetworkSetStatusHoldOff(devHandle,
+                                                            pTmp->networkType,
+                                                            U_NETWORK_TEST_STATUS_HOLD_OFF_MS) == 0);
+                U_PORT_TEST_ASSERT(uNetworkGetStatusFlapCount(devHandle,
+                                                              pTmp->networkType) == 0);
+            }
             switch (pTmp->networkType) {
                 case U_NETWORK_TYPE_BLE:
                     // For BLE, make a connection with our test peer
@@ -1287,6 +1522,8 @@ U_PORT_TEST_FUNCTION("[network]", "networkOutage")
                 U_TEST_PRINT_LINE_X("waiting for all network types to come back up...", a);
                 uPortTaskBlock(15000);
             } else {
+                // Allow any held status changes to be delivered
+                uPortTaskBlock(U_NETWORK_TEST_STATUS_HOLD_OFF_MS * 2);
                 for (uNetworkTestList_t *pTmp = pList; pTmp != NULL; pTmp = pTmp->pNext) {
                     pCallbackParameters = &(gNetworkStatusCallbackParameters[pTmp->networkType]);
                     U_TEST_PRINT_LINE_X("checking that the callback has been called for the"
@@ -1323,6 +1560,10 @@ U_PORT_TEST_FUNCTION("[network]", "networkOutage")
 
         // Remove each network type
         for (uNetworkTestList_t *pTmp = pList; pTmp != NULL; pTmp = pTmp->pNext) {
+            y = uNetworkGetStatusFlapCount(*pTmp->pDevHandle, pTmp->networkType);
+            U_TEST_PRINT_LINE_X("%s flapped %d time(s).", a,
+                                gpUNetworkTestTypeName[pTmp->networkType], y);
+            U_PORT_TEST_ASSERT(y >= 0);
             U_TEST_PRINT_LINE_X("taking down %s...", a,
                                 gpUNetworkTestTypeName[pTmp->networkType]);
             U_PORT_TEST_ASSERT(uNetworkInterfaceDown(*pTmp->pDevHandle,
@@ -1398,6 +1639,14 @@ U_PORT_TEST_FUNCTION("[network]", "networkCleanUp")
     // tests of one of the other APIs are coming next.
     uNetworkTestCleanUp();
     uDeviceDeinit();
+    if (gUpAsyncSemaphore != NULL) {
+        uPortSemaphoreDelete(gUpAsyncSemaphore);
+        gUpAsyncSemaphore = NULL;
+    }
+    if (gOpenAsyncSemaphore != NULL) {
+        uPortSemaphoreDelete(gOpenAsyncSemaphore);
+        gOpenAsyncSemaphore = NULL;
+    }
 
     y = uPortTaskStackMinFree(NULL);
     if (y != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
@@ -84,6 +84,14 @@ extern "C" {
  */
 #define U_SECURITY_E2E_HEADER_LENGTH_MIN_BYTES U_SECURITY_E2E_V2_HEADER_LENGTH_BYTES
 
+#ifndef U_SECURITY_E2E_SLICE_LENGTH_BYTES
+/** The default size of the slices that uSecurityE2eEncryptStream()
+ * divides the data to be encrypted into; the buffer it allocates
+ * is this plus #U_SECURITY_E2E_HEADER_LENGTH_MAX_BYTES.
+ */
+# define U_SECURITY_E2E_SLICE_LENGTH_BYTES 1024
+#endif
+
 /** The maximum amount of storage required for a generated
  * pre-shared key.
  */
@@ -483,6 +491,46 @@ int32_t uSecurityZtpGetCertificateAuthorities(uDeviceHandle_t devHandle,
                                               char *pData,
                                               size_t dataSizeBytes);
 
+/** Switch caching of the Zero Touch Provisioning items (device
+ * certificate, device private key and certificate authorities) on
+ * or off; caching is off by default.  Each item is several
+ * kilobytes of AT transfer, so code that configures a local TLS
+ * stack from them on every connection will benefit greatly from
+ * having the cache on.
+ *
+ * With the cache on, each item is kept in RAM the first time it
+ * is read completely: i.e. when read into a buffer larger than the
+ * item or, following the usual pattern of calling first with
+ * pData NULL to find the size, into a buffer of exactly the size
+ * returned.  Thereafter only the root of trust UID of the module
+ * is queried (a short AT exchange) and, if it is unchanged, the
+ * item is returned from the cache; should the UID differ (e.g.
+ * the module has been swapped) or not be readable, the cache is
+ * emptied and the item read from the module once more.  The cache
+ * is also emptied by a successful seal and is freed when caching
+ * is switched off or the instance is removed.
+ *
+ * IMPORTANT: the cache includes the device private key; only
+ * switch it on if holding that in RAM is acceptable for your
+ * application.
+ *
+ * @param devHandle       the handle of the instance to be used,
+ *                        for example obtained using uDeviceOpen().
+ * @param onNotOff        true to switch the cache on, false to
+ *                        switch it off and free it.
+ * @return                zero on success else negative error code.
+ */
+int32_t uSecurityZtpSetCache(uDeviceHandle_t devHandle, bool onNotOff);
+
+/** Get whether caching of the Zero Touch Provisioning items is on;
+ * see uSecurityZtpSetCache().
+ *
+ * @param devHandle       the handle of the instance to be used,
+ *                        for example obtained using uDeviceOpen().
+ * @return                true if the cache is on, else false.
+ */
+bool uSecurityZtpCacheIsOn(uDeviceHandle_t devHandle);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: END TO END ENCRYPTION
  * -------------------------------------------------------------- */
@@ -545,6 +593,68 @@ int32_t uSecurityE2eEncrypt(uDeviceHandle_t devHandle,
                             void *pDataOut,
                             size_t dataSizeBytes);
 
+/** Encrypt an amount of data that is too large to be held in RAM
+ * twice over, as uSecurityE2eEncrypt() requires.  The data is
+ * pulled from pReadCallback in slices of sliceSizeBytes, each slice
+ * is encrypted by the module and the result pushed to pWriteCallback
+ * (e.g. to be written to a socket or a file) before the next slice
+ * is read, so that only the one buffer of sliceSizeBytes +
+ * #U_SECURITY_E2E_HEADER_LENGTH_MAX_BYTES is needed, however large
+ * the data.
+ *
+ * IMPORTANT: the module has no way to continue an encryption
+ * across calls, hence each slice is encrypted separately and
+ * carries its own header: the receiver must decrypt each slice as
+ * a separate E2E block.  All slices except the last are exactly
+ * sliceSizeBytes long before encryption, and hence exactly
+ * sliceSizeBytes plus the header length (see uSecurityE2eEncrypt())
+ * long after it, each being passed in a single call to
+ * pWriteCallback, so the receiver can always find where one ends
+ * and the next begins.
+ *
+ * @param devHandle         the handle of the instance to be used,
+ *                          for example obtained using uDeviceOpen().
+ * @param sliceSizeBytes    the number of bytes of data to encrypt at
+ *                          a time, use zero for the default of
+ *                          #U_SECURITY_E2E_SLICE_LENGTH_BYTES; the
+ *                          module may limit this, consult the AT
+ *                          manual for your module, command
+ *                          AT+USECE2EDATAENC.
+ * @param[in] pReadCallback called to obtain the data to be encrypted,
+ *                          with a buffer of length bufferSizeBytes
+ *                          and pCallbackParam; it should copy up to
+ *                          bufferSizeBytes of data into the buffer
+ *                          and return the number of bytes copied,
+ *                          zero when there is no more data or a
+ *                          negative value to abandon the encryption.
+ *                          It is called again until the slice is
+ *                          full, so it need not fill the buffer
+ *                          in one go.  Cannot be NULL.
+ * @param[in] pWriteCallback called with each encrypted slice and
+ *                          pCallbackParam; it should return zero
+ *                          or a positive value to continue, or a
+ *                          negative value to abandon the encryption.
+ *                          Cannot be NULL.
+ * @param[in] pCallbackParam user parameter passed to both callbacks;
+ *                          may be NULL.
+ * @return                  on success the total number of bytes
+ *                          passed to pWriteCallback, else negative
+ *                          error code, which will be that returned by
+ *                          a callback if a callback abandoned the
+ *                          encryption.
+ */
+int32_t uSecurityE2eEncryptStream(uDeviceHandle_t devHandle,
+                                  size_t sliceSizeBytes,
+                                  int32_t (*pReadCallback) (uDeviceHandle_t devHandle,
+                                                            char *pBuffer,
+                                                            size_t bufferSizeBytes,
+                                                            void *pCallbackParam),
+                                  int32_t (*pWriteCallback) (uDeviceHandle_t devHandle,
+                                                             const char *pData,
+                                                             size_t dataSizeBytes,
+                                                             void *pCallbackParam),
+                                  void *pCallbackParam);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: PRE-SHARED KEY GENERATION
  * -------------------------------------------------------------- */
@@ -595,6 +705,48 @@ int32_t uSecurityPskGenerate(uDeviceHandle_t devHandle,
  */
 int32_t uSecurityHeartbeatTrigger(uDeviceHandle_t devHandle);
 
+/** Trigger a security heartbeat when the radio is awake anyway,
+ * rather than waking it up from power saving just for the
+ * heartbeat: the heartbeat is sent when data is next sent, when
+ * the radio is seen to be connected to the network or, at the
+ * latest, when the deadline passes, whichever is first; see
+ * uCellSecHeartbeatTriggerDeferred() for the details.  Only one
+ * heartbeat may be waiting at a time.
+ *
+ * @param devHandle       the handle of the instance to be used,
+ *                        for example obtained using uDeviceOpen().
+ * @param deadlineMs      the longest the heartbeat may be held back
+ *                        for, in milliseconds; zero or less to send
+ *                        it now.
+ * @param[in] pCallback   a callback that will be called with the
+ *                        device handle, the outcome of the heartbeat
+ *                        (as would have been returned by
+ *                        uSecurityHeartbeatTrigger()) and
+ *                        pCallbackParam; may be NULL.
+ * @param pCallbackParam  a parameter that will be passed to
+ *                        pCallback.
+ * @return                zero on success, i.e. the heartbeat is
+ *                        waiting to be sent, else negative error
+ *                        code.
+ */
+int32_t uSecurityHeartbeatTriggerDeferred(uDeviceHandle_t devHandle,
+                                          int32_t deadlineMs,
+                                          void (*pCallback) (uDeviceHandle_t,
+                                                             int32_t,
+                                                             void *),
+                                          void *pCallbackParam);
+
+/** Cancel a heartbeat that is waiting to be sent after a call to
+ * uSecurityHeartbeatTriggerDeferred(); the callback passed to that
+ * function will not be called, unless the heartbeat was already
+ * being sent.
+ *
+ * @param devHandle     the handle of the instance to be used,
+ *                      for example obtained using uDeviceOpen().
+ * @return              zero on success else negative error code.
+ */
+int32_t uSecurityHeartbeatCancelDeferred(uDeviceHandle_t devHandle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -124,6 +124,24 @@ typedef struct {
     int64_t expirationUtc;
 } uSecurityCredential_t;
 
+/** An entry in the list of credentials passed to
+ * uSecurityCredentialSync(): the fields are as for the parameters
+ * of the same names of uSecurityCredentialStore().
+ */
+typedef struct {
+    uSecurityCredentialType_t type; /**< the type of the credential. */
+    const char *pName;     /**< the null-terminated name of the credential. */
+    const char *pContents; /**< the credential, PEM or DER format. */
+    size_t size;           /**< the number of bytes at pContents. */
+    const char *pPassword; /**< the password of an encrypted private
+                                key, NULL if not required. */
+    const char *pMd5;      /**< the MD5 hash of the credential as
+                                stored in the module, e.g. as returned
+                                by a previous uSecurityCredentialStore(),
+                                if known; NULL to have it worked out
+                                from pContents. */
+} uSecurityCredentialSyncItem_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -309,6 +327,39 @@ int32_t uSecurityCredentialRemove(uDeviceHandle_t devHandle,
                                   uSecurityCredentialType_t type,
                                   const char *pName);
 
+/** Make sure that the module holds each of a list of X.509
+ * certificates or security keys, storing only those that are
+ * missing or different, so that a provisioning step which runs
+ * at every start-up need not send kilobytes of unchanged data over
+ * a slow interface each time.
+ *
+ * For each item the MD5 hash of the credential stored under that
+ * name, if there is one, is read from the module with
+ * uSecurityCredentialGetHash() and compared with the MD5 hash of
+ * the DER-format credential worked out locally: the base 64 body
+ * of a PEM-format credential is decoded, a DER-format one is used
+ * as it is.  Where the local hash cannot be worked out (the item
+ * has a password, the PEM has headers, e.g. because it is
+ * encrypted, or the platform does not support MD5) the item is
+ * stored unless pMd5 is given for it.  Note that the module may
+ * convert some formats (e.g. a PKCS8 private key) before storing
+ * them, in which case the hashes will never match and the item
+ * will always be stored; give pMd5 for such items, or use the
+ * format the module stores.
+ *
+ * @param devHandle  the handle of the instance to be used,
+ *                   for example obtained using uDeviceOpen().
+ * @param[in] pItems the list of credentials; cannot be NULL.
+ * @param numItems   the number of items at pItems.
+ * @return           the number of credentials that had to be
+ *                   stored, else negative error code, in which
+ *                   case the credentials after the one that
+ *                   failed have not been checked.
+ */
+int32_t uSecurityCredentialSync(uDeviceHandle_t devHandle,
+                                const uSecurityCredentialSyncItem_t *pItems,
+                                size_t numItems);
+
 #ifdef __cplusplus
 }
 #endif
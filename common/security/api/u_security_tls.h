@@ -78,6 +78,17 @@ extern "C" {
 # define U_SECURITY_TLS_SNI_MAX_LENGTH_BYTES 128
 #endif
 
+#ifndef U_SECURITY_TLS_IDLE_CONTEXTS_MAX_NUM
+/** The maximum number of TLS security contexts with session
+ * resumption enabled that uSecurityTlsRemove() will keep for
+ * re-use, rather than free, so that a subsequent connection to the
+ * same server with the same settings may resume the TLS session;
+ * each one ties up a security profile in the module.  Set this to
+ * zero to always free the TLS security context.
+ */
+# define U_SECURITY_TLS_IDLE_CONTEXTS_MAX_NUM 2
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -357,8 +368,15 @@ typedef struct {
                            negotiation, maximum length #U_SECURITY_TLS_SNI_MAX_LENGTH_BYTES;
                            this is optional on cellular modules while for Wifi modules it
                            is set automatically if the connect string is a URL. */
-    bool enableSessionResumption; /**< set to true to enable session resumption; currently
-                                       only false is supported. */
+    bool enableSessionResumption; /**< set to true to enable session resumption: the
+                                       session ID/ticket negotiated with the server is
+                                       kept and offered on the next connection with the
+                                       same settings, avoiding a full handshake if the
+                                       server accepts it; the security context is kept
+                                       for this purpose by uSecurityTlsRemove(), see
+                                       #U_SECURITY_TLS_IDLE_CONTEXTS_MAX_NUM.  Supported
+                                       on cellular modules only and not on SARA-U201
+                                       or SARA-R410M-02B. */
     bool useDeviceCertificate; /**< if this is set to true then pClientCertificateName should
                                     be set to NULL and instead, for a module that supports
                                     u-blox security and has been security sealed, the device
@@ -404,6 +422,10 @@ typedef struct uSecurityTlsContext_t {
                                  which will be passed to the BLE/Cellular/Wifi
                                  layer (appropriately cast) when this security
                                  context is used. */
+    uint32_t settingsHash;  /**< a hash of the settings, non-zero only if
+                                 session resumption is enabled, in which
+                                 case pNetworkSpecific may be kept for
+                                 re-use by uSecurityTlsRemove(). */
 } uSecurityTlsContext_t;
 
 /* ----------------------------------------------------------------
@@ -443,12 +465,68 @@ uSecurityTlsContext_t *pUSecurityTlsAdd(uDeviceHandle_t devHandle,
  * IMPORTANT: this function is NOT INTENDED FOR CUSTOMER USE.  It is
  * called internally by the ubxlib APIs (e.g. sock, MQTT) in order
  * to free a given TLS security context.
+ * If session resumption was enabled in the settings passed to
+ * pUSecurityTlsAdd() then, up to #U_SECURITY_TLS_IDLE_CONTEXTS_MAX_NUM,
+ * the network-specific part of the TLS security context (e.g. the
+ * security profile of a cellular module) is not freed but kept, so
+ * that a subsequent call to pUSecurityTlsAdd() with the same device
+ * and the same settings picks it up again, session and all; such kept
+ * contexts are freed by uSecurityTlsIdleFlush().
  *
  * @param pContext the TLS security context, as returned by
  *                 pUSecurityTlsAdd().
  */
 void uSecurityTlsRemove(uSecurityTlsContext_t *pContext);
 
+/** Free any TLS security contexts kept for re-use by
+ * uSecurityTlsRemove() because they had session resumption enabled;
+ * this is called by the network API when a network interface is
+ * taken down and by uSecurityTlsCleanUp().  This function is
+ * thread-safe.
+ *
+ * @param devHandle the handle of the device whose kept TLS security
+ *                  contexts are to be freed; use NULL to free all
+ *                  of them.
+ */
+void uSecurityTlsIdleFlush(uDeviceHandle_t devHandle);
+
+/** Compute a hash of the given TLS security settings, covering all
+ * of the settings that end up in a TLS security context, so that
+ * two sets of settings can be compared cheaply.
+ * IMPORTANT: this function is NOT INTENDED FOR CUSTOMER USE.  It is
+ * called internally by the ubxlib APIs (e.g. sock) in order to match
+ * a kept connection with a new request.
+ *
+ * @param[in] pSettings a pointer to the TLS security settings; cannot
+ *                      be NULL.
+ * @return              the hash, never zero.
+ */
+uint32_t uSecurityTlsSettingsHash(const uSecurityTlsSettings_t *pSettings);
+
+/** Derive, from the given TLS security settings, settings that use
+ * a pre-shared key in place of certificates: the certificate names,
+ * certificate checking, expected server URL and use of the device
+ * certificate are removed; if the given settings include a PSK and
+ * PSK ID (e.g. one obtained earlier with uSecurityPskGenerate() and
+ * cached by the application) they are kept, otherwise the PSK and
+ * PSK ID are to be generated by the root of trust in the module;
+ * if no cipher suites are given, a list of commonly supported PSK
+ * cipher suites is used.  The TLS version, SNI and session
+ * resumption settings are kept.
+ * IMPORTANT: this function is NOT INTENDED FOR CUSTOMER USE.  It is
+ * called internally by the ubxlib APIs (e.g. sock) in order to
+ * attempt a PSK handshake before falling back to certificates.
+ *
+ * @param[in] pSettings     a pointer to the TLS security settings
+ *                          to derive from; cannot be NULL.
+ * @param[out] pPskSettings a pointer to a place to put the derived
+ *                          settings; cannot be NULL.  Any pointers
+ *                          in the derived settings point into
+ *                          the same storage as those of pSettings.
+ */
+void uSecurityTlsSettingsPskDerive(const uSecurityTlsSettings_t *pSettings,
+                                   uSecurityTlsSettings_t *pPskSettings);
+
 /** Clean-up memory from TLS security contexts.
  * pUSecurityTlsAdd() creates a mutex, if not already created,
  * to ensure thread-safety.  This function may be called if
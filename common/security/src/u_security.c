@@ -137,6 +137,8 @@
 
 #include "u_error_common.h"
 
+#include "u_port_heap.h"
+
 #include "u_device_shared.h"
 
 #include "u_cell_sec.h"
@@ -373,6 +375,30 @@ int32_t uSecurityZtpGetCertificateAuthorities(uDeviceHandle_t devHandle,
     return errorCodeOrSize;
 }
 
+// Switch caching of the ZTP items on or off.
+int32_t uSecurityZtpSetCache(uDeviceHandle_t devHandle, bool onNotOff)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_IMPLEMENTED;
+
+    if (U_DEVICE_IS_TYPE(devHandle, U_DEVICE_TYPE_CELL)) {
+        errorCode = uCellSecZtpSetCache(devHandle, onNotOff);
+    }
+
+    return errorCode;
+}
+
+// Get whether caching of the ZTP items is on.
+bool uSecurityZtpCacheIsOn(uDeviceHandle_t devHandle)
+{
+    bool isOn = false;
+
+    if (U_DEVICE_IS_TYPE(devHandle, U_DEVICE_TYPE_CELL)) {
+        isOn = uCellSecZtpCacheIsOn(devHandle);
+    }
+
+    return isOn;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: END TO END ENCRYPTION
  * -------------------------------------------------------------- */
@@ -424,6 +450,82 @@ int32_t uSecurityE2eEncrypt(uDeviceHandle_t devHandle,
     return errorCode;
 }
 
+// Encrypt data, too large for uSecurityE2eEncrypt(), in slices.
+int32_t uSecurityE2eEncryptStream(uDeviceHandle_t devHandle,
+                                  size_t sliceSizeBytes,
+                                  int32_t (*pReadCallback) (uDeviceHandle_t devHandle,
+                                                            char *pBuffer,
+                                                            size_t bufferSizeBytes,
+                                                            void *pCallbackParam),
+                                  int32_t (*pWriteCallback) (uDeviceHandle_t devHandle,
+                                                             const char *pData,
+                                                             size_t dataSizeBytes,
+                                                             void *pCallbackParam),
+                                  void *pCallbackParam)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    char *pBuffer;
+    size_t length;
+    int32_t x;
+    int32_t totalSizeBytes = 0;
+    bool endOfData = false;
+
+    if (sliceSizeBytes == 0) {
+        sliceSizeBytes = U_SECURITY_E2E_SLICE_LENGTH_BYTES;
+    }
+    if ((pReadCallback != NULL) && (pWriteCallback != NULL)) {
+        errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_IMPLEMENTED;
+        if (U_DEVICE_IS_TYPE(devHandle, U_DEVICE_TYPE_CELL)) {
+            errorCodeOrSize = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pBuffer = (char *) pUPortMalloc(sliceSizeBytes +
+                                            U_SECURITY_E2E_HEADER_LENGTH_MAX_BYTES);
+            if (pBuffer != NULL) {
+                errorCodeOrSize = (int32_t) U_ERROR_COMMON_SUCCESS;
+                while (!endOfData && (errorCodeOrSize >= 0)) {
+                    // Fill a slice, so that all but the last are full
+                    length = 0;
+                    while (!endOfData && (length < sliceSizeBytes) &&
+                           (errorCodeOrSize >= 0)) {
+                        x = pReadCallback(devHandle, pBuffer + length,
+                                          sliceSizeBytes - length, pCallbackParam);
+                        if (x < 0) {
+                            errorCodeOrSize = x;
+                        } else if (x == 0) {
+                            endOfData = true;
+                        } else if ((size_t) x > sliceSizeBytes - length) {
+                            // The callback has overrun the buffer
+                            errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+                        } else {
+                            length += x;
+                        }
+                    }
+                    if ((errorCodeOrSize >= 0) && (length > 0)) {
+                        // Encrypt in place: the module is sent all
+                        // of the data before the encrypted data is
+                        // read back
+                        x = uCellSecE2eEncrypt(devHandle, pBuffer, pBuffer, length);
+                        if (x > 0) {
+                            totalSizeBytes += x;
+                            x = pWriteCallback(devHandle, pBuffer, x, pCallbackParam);
+                        } else if (x == 0) {
+                            x = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+                        }
+                        if (x < 0) {
+                            errorCodeOrSize = x;
+                        }
+                    }
+                }
+                if (errorCodeOrSize >= 0) {
+                    errorCodeOrSize = totalSizeBytes;
+                }
+                uPortFree(pBuffer);
+            }
+        }
+    }
+
+    return errorCodeOrSize;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: PRE-SHARED KEY GENERATION
  * -------------------------------------------------------------- */
@@ -464,4 +566,34 @@ int32_t uSecurityHeartbeatTrigger(uDeviceHandle_t devHandle)
     return errorCode;
 }
 
+// Trigger a security heartbeat when the radio is awake anyway.
+int32_t uSecurityHeartbeatTriggerDeferred(uDeviceHandle_t devHandle,
+                                          int32_t deadlineMs,
+                                          void (*pCallback) (uDeviceHandle_t,
+                                                             int32_t,
+                                                             void *),
+                                          void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_IMPLEMENTED;
+
+    if (U_DEVICE_IS_TYPE(devHandle, U_DEVICE_TYPE_CELL)) {
+        errorCode = uCellSecHeartbeatTriggerDeferred(devHandle, deadlineMs,
+                                                     pCallback, pCallbackParam);
+    }
+
+    return errorCode;
+}
+
+// Cancel a deferred security heartbeat.
+int32_t uSecurityHeartbeatCancelDeferred(uDeviceHandle_t devHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_IMPLEMENTED;
+
+    if (U_DEVICE_IS_TYPE(devHandle, U_DEVICE_TYPE_CELL)) {
+        errorCode = uCellSecHeartbeatCancelDeferred(devHandle);
+    }
+
+    return errorCode;
+}
+
 // End of file
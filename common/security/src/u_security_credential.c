@@ -49,6 +49,7 @@
 #include "u_port_heap.h"
 #include "u_port.h"
 #include "u_port_os.h"
+#include "u_port_crypto.h"
 
 #include "u_at_client.h"
 
@@ -61,6 +62,8 @@
 
 #include "u_short_range.h"
 
+#include "u_base64.h"
+
 #include "u_security_credential.h"
 
 /* ----------------------------------------------------------------
@@ -76,6 +79,11 @@
  */
 #define U_SECURITY_CREDENTIAL_EXPIRATION_DATE_LENGTH_BYTES 19
 
+/** The number of characters of base 64 to decode at a time when
+ * working out the hash of a PEM-format credential.
+ */
+#define U_SECURITY_CREDENTIAL_SYNC_BASE64_CHUNK_LENGTH_BYTES 64
+
 // Do some cross-checking
 #if U_SECURITY_CREDENTIAL_TYPE_LENGTH_BYTES > U_SECURITY_CREDENTIAL_EXPIRATION_DATE_LENGTH_BYTES
 #error U_SECURITY_CREDENTIAL_TYPE_LENGTH_BYTES  is greater than U_SECURITY_CREDENTIAL_EXPIRATION_DATE_LENGTH_BYTES, check code below
@@ -317,6 +325,108 @@ static size_t stripWhitespace(char *pString, size_t stringLength)
     return newLength;
 }
 
+// Feed a line of the base 64 body of a PEM-format credential,
+// without its line ending, into an MD5 calculation.
+static int32_t localHashLine(void *pMd5Context, uBase64Context_t *pBase64Context,
+                             const char *pLine, size_t lineLength)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_SUCCESS;
+    // Room for a chunk plus anything held over in the context
+    char buffer[((U_SECURITY_CREDENTIAL_SYNC_BASE64_CHUNK_LENGTH_BYTES + 3) / 4) * 3];
+    size_t length;
+
+    for (size_t x = 0; (x < lineLength) && (errorCodeOrLength >= 0); x += length) {
+        length = lineLength - x;
+        if (length > U_SECURITY_CREDENTIAL_SYNC_BASE64_CHUNK_LENGTH_BYTES) {
+            length = U_SECURITY_CREDENTIAL_SYNC_BASE64_CHUNK_LENGTH_BYTES;
+        }
+        errorCodeOrLength = uBase64DecodeUpdate(pBase64Context, pLine + x, length,
+                                                buffer, sizeof(buffer));
+        if (errorCodeOrLength >= 0) {
+            errorCodeOrLength = uPortCryptoMd5Update(pMd5Context, buffer,
+                                                     (size_t) errorCodeOrLength);
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
+// Work out the MD5 hash of the DER form of a credential as the
+// module would store it: if pContents is PEM format the base 64
+// between the "-----BEGIN" and "-----END" lines is decoded, else
+// pContents is taken to be DER format already.  A PEM with headers,
+// i.e. an encrypted one, is not supported.
+static int32_t localHash(const char *pContents, size_t size, char *pMd5)
+{
+    int32_t errorCode;
+    void *pMd5Context = NULL;
+    uBase64Context_t base64Context;
+    char buffer[3];
+    const char *pEnd = pContents + size;
+    const char *pLine = pContents;
+    const char *pLineEnd;
+    size_t lineLength;
+    bool isPem;
+    bool endFound = false;
+
+    while ((pLine < pEnd) && isspace((int32_t) (uint8_t) *pLine)) {
+        pLine++;
+    }
+    isPem = ((size_t) (pEnd - pLine) > 10) && (strncmp(pLine, "-----BEGIN", 10) == 0);
+
+    errorCode = uPortCryptoMd5Init(&pMd5Context);
+    if (errorCode == 0) {
+        if (!isPem) {
+            errorCode = uPortCryptoMd5Update(pMd5Context, pContents, size);
+        } else {
+            uBase64DecodeStart(&base64Context);
+            // Move past the "-----BEGIN" line
+            pLineEnd = (const char *) memchr(pLine, '\n', pEnd - pLine);
+            pLine = (pLineEnd != NULL) ? pLineEnd + 1 : pEnd;
+            while ((errorCode == 0) && !endFound && (pLine < pEnd)) {
+                pLineEnd = (const char *) memchr(pLine, '\n', pEnd - pLine);
+                if (pLineEnd == NULL) {
+                    pLineEnd = pEnd;
+                }
+                lineLength = pLineEnd - pLine;
+                // Lose any carriage return, trailing spaces or terminator
+                while ((lineLength > 0) &&
+                       (isspace((int32_t) (uint8_t) pLine[lineLength - 1]) ||
+                        (pLine[lineLength - 1] == 0))) {
+                    lineLength--;
+                }
+                if ((lineLength >= 5) && (strncmp(pLine, "-----", 5) == 0)) {
+                    endFound = true;
+                } else if (memchr(pLine, ':', lineLength) != NULL) {
+                    // A header line, e.g. "Proc-Type: 4,ENCRYPTED"
+                    errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+                } else {
+                    errorCode = localHashLine(pMd5Context, &base64Context,
+                                              pLine, lineLength);
+                }
+                pLine = pLineEnd + 1;
+            }
+            if ((errorCode == 0) && !endFound) {
+                errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            }
+            if (errorCode == 0) {
+                errorCode = uBase64DecodeFinish(&base64Context, buffer, sizeof(buffer));
+                if (errorCode >= 0) {
+                    errorCode = uPortCryptoMd5Update(pMd5Context, buffer, (size_t) errorCode);
+                }
+            }
+        }
+        if (errorCode == 0) {
+            errorCode = uPortCryptoMd5Final(pMd5Context, pMd5);
+        } else {
+            // Abandon the calculation
+            uPortCryptoMd5Final(pMd5Context, NULL);
+        }
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -658,4 +768,50 @@ int32_t uSecurityCredentialRemove(uDeviceHandle_t devHandle,
     return errorCode;
 }
 
+// Store only those of a list of credentials that are missing or different.
+int32_t uSecurityCredentialSync(uDeviceHandle_t devHandle,
+                                const uSecurityCredentialSyncItem_t *pItems,
+                                size_t numItems)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uSecurityCredentialSyncItem_t *pItem;
+    const char *pMd5;
+    char md5Local[U_SECURITY_CREDENTIAL_MD5_LENGTH_BYTES];
+    char md5Module[U_SECURITY_CREDENTIAL_MD5_LENGTH_BYTES];
+    int32_t errorCode;
+
+    if ((pItems != NULL) || (numItems == 0)) {
+        errorCodeOrCount = 0;
+        for (size_t x = 0; (x < numItems) && (errorCodeOrCount >= 0); x++) {
+            pItem = pItems + x;
+            pMd5 = pItem->pMd5;
+            // The hash of an encrypted key is that of the decrypted
+            // key, which can't be worked out here
+            if ((pMd5 == NULL) && (pItem->pPassword == NULL) &&
+                (pItem->pContents != NULL) &&
+                (localHash(pItem->pContents, pItem->size, md5Local) == 0)) {
+                pMd5 = md5Local;
+            }
+            // If the module doesn't have the credential the hash
+            // read will fail
+            if ((pMd5 == NULL) ||
+                (uSecurityCredentialGetHash(devHandle, pItem->type,
+                                            pItem->pName, md5Module) != 0) ||
+                (memcmp(pMd5, md5Module, sizeof(md5Module)) != 0)) {
+                errorCode = uSecurityCredentialStore(devHandle, pItem->type,
+                                                     pItem->pName, pItem->pContents,
+                                                     pItem->size, pItem->pPassword,
+                                                     NULL);
+                if (errorCode == 0) {
+                    errorCodeOrCount++;
+                } else {
+                    errorCodeOrCount = errorCode;
+                }
+            }
+        }
+    }
+
+    return errorCodeOrCount;
+}
+
 // End of file
@@ -34,7 +34,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // strlen()
+#include "string.h"    // strlen(), memmove()
 
 #include "u_error_common.h"
 
@@ -61,10 +61,32 @@
  * VARIABLES
  * -------------------------------------------------------------- */
 
+/** The cipher suites offered by uSecurityTlsSettingsPskDerive() if
+ * none are given, most preferred first.
+ */
+static const uSecurityTlsCipherSuiteIana_t gPskCipherSuites[] = {
+    U_SECURITY_TLS_CIPHER_SUITE_ECDHE_PSK_WITH_AES_128_CBC_SHA256,
+    U_SECURITY_TLS_CIPHER_SUITE_PSK_WITH_AES_128_GCM_SHA256,
+    U_SECURITY_TLS_CIPHER_SUITE_PSK_WITH_AES_128_CBC_SHA256,
+    U_SECURITY_TLS_CIPHER_SUITE_PSK_WITH_AES_128_CBC_SHA
+};
+
 /** Mutex for re-entrancy protection.
  */
 static uPortMutexHandle_t gMutex = NULL;
 
+#if U_SECURITY_TLS_IDLE_CONTEXTS_MAX_NUM > 0
+/** TLS security contexts with session resumption enabled that
+ * have been kept for re-use by uSecurityTlsRemove(), oldest first;
+ * only devHandle, pNetworkSpecific and settingsHash are used.
+ */
+static uSecurityTlsContext_t gIdle[U_SECURITY_TLS_IDLE_CONTEXTS_MAX_NUM] = {0};
+
+/** The number of entries in gIdle[] that are in use.
+ */
+static size_t gNumIdle = 0;
+#endif
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -110,14 +132,173 @@ static bool checkConfig(const uSecurityTlsSettings_t *pSettings)
          (strlen(pSettings->pExpectedServerUrl) <=
           U_SECURITY_TLS_EXPECTED_SERVER_URL_MAX_LENGTH_BYTES)) &&
         ((pSettings->pSni == NULL) || (strlen(pSettings->pSni) <=
-                                       U_SECURITY_TLS_SNI_MAX_LENGTH_BYTES)) &&
-        !pSettings->enableSessionResumption) {
+                                       U_SECURITY_TLS_SNI_MAX_LENGTH_BYTES))) {
         isGood = true;
     }
 
     return isGood;
 }
 
+// Add a block of memory to a 32-bit FNV-1a hash.
+static uint32_t hashAdd(uint32_t hash, const void *pData, size_t size)
+{
+    const uint8_t *pByte = (const uint8_t *) pData;
+
+    for (size_t x = 0; x < size; x++) {
+        hash ^= *pByte;
+        hash *= 16777619UL;
+        pByte++;
+    }
+
+    return hash;
+}
+
+// Add a string, which may be NULL, to a 32-bit FNV-1a hash;
+// the terminator is included so that NULL and "" differ from
+// each other and adjacent strings can't run into one another.
+static uint32_t hashAddString(uint32_t hash, const char *pString)
+{
+    uint8_t null = 0xFF;
+
+    if (pString != NULL) {
+        hash = hashAdd(hash, pString, strlen(pString) + 1);
+    } else {
+        hash = hashAdd(hash, &null, sizeof(null));
+    }
+
+    return hash;
+}
+
+// Compute a hash of all of the settings that end up in a security
+// context, used to match a kept security context with a new request;
+// never returns zero.
+static uint32_t hashSettings(const uSecurityTlsSettings_t *pSettings)
+{
+    uint32_t hash = 2166136261UL;
+    int32_t x;
+
+    x = (int32_t) pSettings->tlsVersionMin;
+    hash = hashAdd(hash, &x, sizeof(x));
+    hash = hashAddString(hash, pSettings->pRootCaCertificateName);
+    hash = hashAddString(hash, pSettings->pClientCertificateName);
+    hash = hashAddString(hash, pSettings->pClientPrivateKeyName);
+    hash = hashAddString(hash, pSettings->pClientPrivateKeyPassword);
+    x = (int32_t) pSettings->certificateCheck;
+    hash = hashAdd(hash, &x, sizeof(x));
+    hash = hashAdd(hash, &(pSettings->cipherSuites.num),
+                   sizeof(pSettings->cipherSuites.num));
+    hash = hashAdd(hash, pSettings->cipherSuites.suite,
+                   pSettings->cipherSuites.num * sizeof(pSettings->cipherSuites.suite[0]));
+    if (pSettings->psk.pBin != NULL) {
+        hash = hashAdd(hash, pSettings->psk.pBin, pSettings->psk.size);
+    }
+    hash = hashAdd(hash, &(pSettings->psk.size), sizeof(pSettings->psk.size));
+    if (pSettings->pskId.pBin != NULL) {
+        hash = hashAdd(hash, pSettings->pskId.pBin, pSettings->pskId.size);
+    }
+    hash = hashAdd(hash, &(pSettings->pskId.size), sizeof(pSettings->pskId.size));
+    hash = hashAdd(hash, &(pSettings->pskGeneratedByRoT),
+                   sizeof(pSettings->pskGeneratedByRoT));
+    hash = hashAddString(hash, pSettings->pExpectedServerUrl);
+    hash = hashAddString(hash, pSettings->pSni);
+    hash = hashAdd(hash, &(pSettings->useDeviceCertificate),
+                   sizeof(pSettings->useDeviceCertificate));
+    hash = hashAdd(hash, &(pSettings->includeCaCertificates),
+                   sizeof(pSettings->includeCaCertificates));
+    if (hash == 0) {
+        hash = 1;
+    }
+
+    return hash;
+}
+
+// Free a network-specific security context.
+static void networkSpecificFree(uDeviceHandle_t devHandle,
+                                void *pNetworkSpecific)
+{
+    int32_t devType = uDeviceGetDeviceType(devHandle);
+
+    if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
+        uShortRangeSecTlsRemove((uShortRangeSecTlsContext_t *) pNetworkSpecific);
+    } else if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
+        uCellSecTlsRemove((uCellSecTlsContext_t *) pNetworkSpecific);
+    }
+}
+
+// Take a kept network-specific security context with the given
+// settings hash out of the idle list; gMutex must be locked.
+static void *pIdleTake(uDeviceHandle_t devHandle, uint32_t settingsHash)
+{
+    void *pNetworkSpecific = NULL;
+
+#if U_SECURITY_TLS_IDLE_CONTEXTS_MAX_NUM > 0
+    for (size_t x = 0; (x < gNumIdle) && (pNetworkSpecific == NULL); x++) {
+        if ((gIdle[x].devHandle == devHandle) &&
+            (gIdle[x].settingsHash == settingsHash)) {
+            pNetworkSpecific = gIdle[x].pNetworkSpecific;
+            gNumIdle--;
+            memmove(&(gIdle[x]), &(gIdle[x + 1]), (gNumIdle - x) * sizeof(gIdle[0]));
+        }
+    }
+#else
+    (void) devHandle;
+    (void) settingsHash;
+#endif
+
+    return pNetworkSpecific;
+}
+
+// Put a network-specific security context into the idle list,
+// freeing the oldest entry if the list is full; gMutex must be
+// locked.  Returns false if the context could not be kept, in
+// which case it is up to the caller to free it.
+static bool idlePut(const uSecurityTlsContext_t *pContext)
+{
+    bool kept = false;
+
+#if U_SECURITY_TLS_IDLE_CONTEXTS_MAX_NUM > 0
+    if (gNumIdle >= sizeof(gIdle) / sizeof(gIdle[0])) {
+        networkSpecificFree(gIdle[0].devHandle, gIdle[0].pNetworkSpecific);
+        gNumIdle--;
+        memmove(&(gIdle[0]), &(gIdle[1]), gNumIdle * sizeof(gIdle[0]));
+    }
+    gIdle[gNumIdle] = *pContext;
+    gNumIdle++;
+    kept = true;
+#else
+    (void) pContext;
+#endif
+
+    return kept;
+}
+
+// Free the kept network-specific security contexts of the given
+// device, or of all devices if devHandle is NULL; gMutex must be
+// locked.  Returns the number freed.
+static size_t idleFree(uDeviceHandle_t devHandle)
+{
+    size_t numFreed = 0;
+
+#if U_SECURITY_TLS_IDLE_CONTEXTS_MAX_NUM > 0
+    size_t x = 0;
+
+    while (x < gNumIdle) {
+        if ((devHandle == NULL) || (gIdle[x].devHandle == devHandle)) {
+            networkSpecificFree(gIdle[x].devHandle, gIdle[x].pNetworkSpecific);
+            gNumIdle--;
+            memmove(&(gIdle[x]), &(gIdle[x + 1]), (gNumIdle - x) * sizeof(gIdle[0]));
+            numFreed++;
+        } else {
+            x++;
+        }
+    }
+#else
+    (void) devHandle;
+#endif
+
+    return numFreed;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -134,6 +315,7 @@ uSecurityTlsContext_t *pUSecurityTlsAdd(uDeviceHandle_t devHandle,
     const char *pClientPrivateKeyName = NULL;
     bool certificateCheckOn = false;
     uSecurityTlsVersion_t tlsVersionMin = U_SECURITY_TLS_VERSION_ANY;
+    uint32_t settingsHash = 0;
 
     if ((errorCode == 0) && (pContext != NULL)) {
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
@@ -150,8 +332,10 @@ uSecurityTlsContext_t *pUSecurityTlsAdd(uDeviceHandle_t devHandle,
                 if (pSettings != NULL) {
                     errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
                     // Only CA checking (not the URL and date versions)
-                    // are supported for short range
-                    if (pSettings->certificateCheck <= U_SECURITY_TLS_CERTIFICATE_CHECK_ROOT_CA) {
+                    // are supported for short range, and not session
+                    // resumption
+                    if ((pSettings->certificateCheck <= U_SECURITY_TLS_CERTIFICATE_CHECK_ROOT_CA) &&
+                        !pSettings->enableSessionResumption) {
                         errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                         pRootCaCertificateName = pSettings->pRootCaCertificateName;
                         pClientCertificateName = pSettings->pClientCertificateName;
@@ -175,75 +359,93 @@ uSecurityTlsContext_t *pUSecurityTlsAdd(uDeviceHandle_t devHandle,
                 }
             } else if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
                 errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-                // Allocate a cellular security context with
-                // default settings
-                pNetworkSpecific = (void *) pUCellSecSecTlsAdd(devHandle);
+                if ((pSettings != NULL) && pSettings->enableSessionResumption) {
+                    // Pick up a kept security context with the same
+                    // settings, if there is one, and with it the session
+                    settingsHash = hashSettings(pSettings);
+                    pNetworkSpecific = pIdleTake(devHandle, settingsHash);
+                }
                 if (pNetworkSpecific == NULL) {
-                    errorCode = uCellSecTlsResetLastError();
-                } else {
-                    if (pSettings != NULL) {
-                        // Looks like some specific settings have been
-                        // requested: set them
-                        if (pSettings->tlsVersionMin != U_SECURITY_TLS_VERSION_ANY) {
-                            // Set the TLS version (encoding is the
-                            // same in cellular)
-                            errorCode = uCellSecTlsVersionSet((uCellSecTlsContext_t *) pNetworkSpecific,
-                                                              (int32_t) pSettings->tlsVersionMin);
-                        }
-                        if ((errorCode == 0) &&
-                            (pSettings->pRootCaCertificateName != NULL)) {
-                            // Set the root CA certificate name
-                            errorCode = uCellSecTlsRootCaCertificateNameSet((uCellSecTlsContext_t *) pNetworkSpecific,
-                                                                            pSettings->pRootCaCertificateName);
-                        }
-                        if ((errorCode == 0) &&
-                            (pSettings->pClientCertificateName != NULL)) {
-                            // Set the client certificate name
-                            errorCode = uCellSecTlsClientCertificateNameSet((uCellSecTlsContext_t *) pNetworkSpecific,
-                                                                            pSettings->pClientCertificateName);
-                        }
-                        if ((errorCode == 0) &&
-                            (pSettings->pClientPrivateKeyName != NULL)) {
-                            // Set the client private key name
-                            errorCode = uCellSecTlsClientPrivateKeyNameSet((uCellSecTlsContext_t *) pNetworkSpecific,
-                                                                           pSettings->pClientPrivateKeyName,
-                                                                           pSettings->pClientPrivateKeyPassword);
-                        }
-                        if ((errorCode == 0) &&
-                            (pSettings->cipherSuites.num > 0)) {
-                            // Set the cipher suites
-                            for (size_t x = 0; (x < pSettings->cipherSuites.num) &&
-                                 (errorCode == 0); x++) {
-                                errorCode = uCellSecTlsCipherSuiteAdd((uCellSecTlsContext_t *) pNetworkSpecific,
-                                                                      (int32_t) pSettings->cipherSuites.suite[x]);
+                    // Allocate a cellular security context with
+                    // default settings
+                    pNetworkSpecific = (void *) pUCellSecSecTlsAdd(devHandle);
+                    if ((pNetworkSpecific == NULL) && (idleFree(devHandle) > 0)) {
+                        // The security profiles may all have been tied
+                        // up by kept security contexts: try again
+                        pNetworkSpecific = (void *) pUCellSecSecTlsAdd(devHandle);
+                    }
+                    if (pNetworkSpecific == NULL) {
+                        errorCode = uCellSecTlsResetLastError();
+                    } else {
+                        if (pSettings != NULL) {
+                            // Looks like some specific settings have been
+                            // requested: set them
+                            if (pSettings->tlsVersionMin != U_SECURITY_TLS_VERSION_ANY) {
+                                // Set the TLS version (encoding is the
+                                // same in cellular)
+                                errorCode = uCellSecTlsVersionSet((uCellSecTlsContext_t *) pNetworkSpecific,
+                                                                  (int32_t) pSettings->tlsVersionMin);
+                            }
+                            if ((errorCode == 0) &&
+                                (pSettings->pRootCaCertificateName != NULL)) {
+                                // Set the root CA certificate name
+                                errorCode = uCellSecTlsRootCaCertificateNameSet((uCellSecTlsContext_t *) pNetworkSpecific,
+                                                                                pSettings->pRootCaCertificateName);
+                            }
+                            if ((errorCode == 0) &&
+                                (pSettings->pClientCertificateName != NULL)) {
+                                // Set the client certificate name
+                                errorCode = uCellSecTlsClientCertificateNameSet((uCellSecTlsContext_t *) pNetworkSpecific,
+                                                                                pSettings->pClientCertificateName);
+                            }
+                            if ((errorCode == 0) &&
+                                (pSettings->pClientPrivateKeyName != NULL)) {
+                                // Set the client private key name
+                                errorCode = uCellSecTlsClientPrivateKeyNameSet((uCellSecTlsContext_t *) pNetworkSpecific,
+                                                                               pSettings->pClientPrivateKeyName,
+                                                                               pSettings->pClientPrivateKeyPassword);
+                            }
+                            if ((errorCode == 0) &&
+                                (pSettings->cipherSuites.num > 0)) {
+                                // Set the cipher suites
+                                for (size_t x = 0; (x < pSettings->cipherSuites.num) &&
+                                     (errorCode == 0); x++) {
+                                    errorCode = uCellSecTlsCipherSuiteAdd((uCellSecTlsContext_t *) pNetworkSpecific,
+                                                                          (int32_t) pSettings->cipherSuites.suite[x]);
+                                }
+                            }
+                            if ((errorCode == 0) &&
+                                (((pSettings->psk.pBin != NULL) && (pSettings->psk.size > 0) &&
+                                  (pSettings->pskId.pBin != NULL) && (pSettings->pskId.size > 0)) ||
+                                 pSettings->pskGeneratedByRoT)) {
+                                // Set the pre-shared key and accompanying ID
+                                errorCode = uCellSecTlsClientPskSet((uCellSecTlsContext_t *) pNetworkSpecific,
+                                                                    pSettings->psk.pBin, pSettings->psk.size,
+                                                                    pSettings->pskId.pBin, pSettings->pskId.size,
+                                                                    pSettings->pskGeneratedByRoT);
+                            }
+                            if (errorCode == 0) {
+                                // Set the certificate checking
+                                errorCode = uCellSecTlsCertificateCheckSet((uCellSecTlsContext_t *) pNetworkSpecific,
+                                                                           (uCellSecTlsCertficateCheck_t) pSettings->certificateCheck,
+                                                                           pSettings->pExpectedServerUrl);
+                            }
+                            if ((errorCode == 0) && (pSettings->pSni != NULL)) {
+                                // Set the Server Name Indication string
+                                errorCode = uCellSecTlsSniSet((uCellSecTlsContext_t *) pNetworkSpecific,
+                                                              pSettings->pSni);
+                            }
+                            if ((errorCode == 0) && (pSettings->useDeviceCertificate)) {
+                                // Set that the device certificate from security sealing
+                                // should be used as the client certificate
+                                errorCode = uCellSecTlsUseDeviceCertificateSet((uCellSecTlsContext_t *) pNetworkSpecific,
+                                                                               pSettings->includeCaCertificates);
+                            }
+                            if ((errorCode == 0) && pSettings->enableSessionResumption) {
+                                // Switch on session resumption
+                                errorCode = uCellSecTlsSessionResumptionSet((uCellSecTlsContext_t *) pNetworkSpecific,
+                                                                           true);
                             }
-                        }
-                        if ((errorCode == 0) &&
-                            (((pSettings->psk.pBin != NULL) && (pSettings->psk.size > 0) &&
-                              (pSettings->pskId.pBin != NULL) && (pSettings->pskId.size > 0)) ||
-                             pSettings->pskGeneratedByRoT)) {
-                            // Set the pre-shared key and accompanying ID
-                            errorCode = uCellSecTlsClientPskSet((uCellSecTlsContext_t *) pNetworkSpecific,
-                                                                pSettings->psk.pBin, pSettings->psk.size,
-                                                                pSettings->pskId.pBin, pSettings->pskId.size,
-                                                                pSettings->pskGeneratedByRoT);
-                        }
-                        if (errorCode == 0) {
-                            // Set the certificate checking
-                            errorCode = uCellSecTlsCertificateCheckSet((uCellSecTlsContext_t *) pNetworkSpecific,
-                                                                       (uCellSecTlsCertficateCheck_t) pSettings->certificateCheck,
-                                                                       pSettings->pExpectedServerUrl);
-                        }
-                        if ((errorCode == 0) && (pSettings->pSni != NULL)) {
-                            // Set the Server Name Indication string
-                            errorCode = uCellSecTlsSniSet((uCellSecTlsContext_t *) pNetworkSpecific,
-                                                          pSettings->pSni);
-                        }
-                        if ((errorCode == 0) && (pSettings->useDeviceCertificate)) {
-                            // Set that the device certificate from security sealing
-                            // should be used as the client certificate
-                            errorCode = uCellSecTlsUseDeviceCertificateSet((uCellSecTlsContext_t *) pNetworkSpecific,
-                                                                           pSettings->includeCaCertificates);
                         }
                     }
                 }
@@ -260,6 +462,7 @@ uSecurityTlsContext_t *pUSecurityTlsAdd(uDeviceHandle_t devHandle,
         pContext->errorCode = errorCode;
         pContext->devHandle = devHandle;
         pContext->pNetworkSpecific = pNetworkSpecific;
+        pContext->settingsHash = settingsHash;
     }
 
     return pContext;
@@ -272,11 +475,11 @@ void uSecurityTlsRemove(uSecurityTlsContext_t *pContext)
 
         U_PORT_MUTEX_LOCK(gMutex);
 
-        int32_t devType = uDeviceGetDeviceType(pContext->devHandle);
-        if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-            uShortRangeSecTlsRemove((uShortRangeSecTlsContext_t *) pContext->pNetworkSpecific);
-        } else if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-            uCellSecTlsRemove((uCellSecTlsContext_t *) pContext->pNetworkSpecific);
+        // A good security context with session resumption enabled
+        // is kept, if possible, so that the session may be resumed
+        if ((pContext->errorCode != 0) || (pContext->settingsHash == 0) ||
+            (pContext->pNetworkSpecific == NULL) || !idlePut(pContext)) {
+            networkSpecificFree(pContext->devHandle, pContext->pNetworkSpecific);
         }
         uPortFree(pContext);
 
@@ -284,11 +487,60 @@ void uSecurityTlsRemove(uSecurityTlsContext_t *pContext)
     }
 }
 
+// Free any kept TLS security contexts.
+void uSecurityTlsIdleFlush(uDeviceHandle_t devHandle)
+{
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        idleFree(devHandle);
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+}
+
+// Compute a hash of the given TLS security settings.
+uint32_t uSecurityTlsSettingsHash(const uSecurityTlsSettings_t *pSettings)
+{
+    return hashSettings(pSettings);
+}
+
+// Derive PSK-based TLS security settings.
+void uSecurityTlsSettingsPskDerive(const uSecurityTlsSettings_t *pSettings,
+                                   uSecurityTlsSettings_t *pPskSettings)
+{
+    if ((pSettings != NULL) && (pPskSettings != NULL)) {
+        *pPskSettings = *pSettings;
+        // No certificates are involved in a PSK handshake
+        pPskSettings->pRootCaCertificateName = NULL;
+        pPskSettings->pClientCertificateName = NULL;
+        pPskSettings->pClientPrivateKeyName = NULL;
+        pPskSettings->pClientPrivateKeyPassword = NULL;
+        pPskSettings->certificateCheck = U_SECURITY_TLS_CERTIFICATE_CHECK_NONE;
+        pPskSettings->pExpectedServerUrl = NULL;
+        pPskSettings->useDeviceCertificate = false;
+        pPskSettings->includeCaCertificates = false;
+        if ((pSettings->psk.pBin == NULL) || (pSettings->psk.size == 0) ||
+            (pSettings->pskId.pBin == NULL) || (pSettings->pskId.size == 0)) {
+            // No PSK to hand: have the module generate one
+            pPskSettings->pskGeneratedByRoT = true;
+        }
+        if (pPskSettings->cipherSuites.num == 0) {
+            for (size_t x = 0; x < sizeof(gPskCipherSuites) / sizeof(gPskCipherSuites[0]); x++) {
+                pPskSettings->cipherSuites.suite[x] = gPskCipherSuites[x];
+            }
+            pPskSettings->cipherSuites.num = sizeof(gPskCipherSuites) / sizeof(gPskCipherSuites[0]);
+        }
+    }
+}
+
 // Clean-up memory from TLS security contexts.
 void uSecurityTlsCleanUp()
 {
     if (gMutex != NULL) {
         U_PORT_MUTEX_LOCK(gMutex);
+        idleFree(NULL);
         U_PORT_MUTEX_UNLOCK(gMutex);
         uPortMutexDelete(gMutex);
         gMutex = NULL;
@@ -43,6 +43,7 @@
 #include "u_port.h"
 #include "u_port_debug.h"
 #include "u_port_os.h"
+#include "u_port_crypto.h"
 
 #ifdef U_CFG_TEST_CELL_MODULE_TYPE
 #include "u_cell_module_type.h"
@@ -214,6 +215,8 @@ U_PORT_TEST_FUNCTION("[securityCredential]", "securityCredentialTest")
     int32_t z;
     char hash[U_SECURITY_CREDENTIAL_MD5_LENGTH_BYTES];
     char buffer[U_SECURITY_CREDENTIAL_MD5_LENGTH_BYTES];
+    uSecurityCredentialSyncItem_t syncItem;
+    void *pMd5Context = NULL;
 
     // In case a previous test failed
     uNetworkTestCleanUp();
@@ -401,6 +404,36 @@ U_PORT_TEST_FUNCTION("[securityCredential]", "securityCredentialTest")
                                                      U_SECURITY_CREDENTIAL_CLIENT_X509,
                                                      "ubxlib_test_cert") == 0);
 
+        // Synchronise it: the first time it should be stored, the
+        // second time, if MD5 is supported locally, it should not
+        U_TEST_PRINT_LINE_X("synchronising certificate...", x);
+        syncItem.type = U_SECURITY_CREDENTIAL_CLIENT_X509;
+        syncItem.pName = "ubxlib_test_cert";
+        syncItem.pContents = (const char *) gUSecurityCredentialTestClientX509Pem;
+        syncItem.size = gUSecurityCredentialTestClientX509PemSize;
+        syncItem.pPassword = NULL;
+        syncItem.pMd5 = NULL;
+        U_PORT_TEST_ASSERT(uSecurityCredentialSync(devHandle, &syncItem, 1) == 1);
+        z = uSecurityCredentialSync(devHandle, &syncItem, 1);
+        U_TEST_PRINT_LINE_X("%d credential(s) stored on the second synchronisation.", x, z);
+        if (uPortCryptoMd5Init(&pMd5Context) == 0) {
+            uPortCryptoMd5Final(pMd5Context, NULL);
+            U_PORT_TEST_ASSERT(z == 0);
+        } else {
+            U_PORT_TEST_ASSERT(z == 1);
+        }
+        // Giving the hash should have the same effect, whether MD5 is
+        // supported or not
+        U_PORT_TEST_ASSERT(uSecurityCredentialGetHash(devHandle,
+                                                      U_SECURITY_CREDENTIAL_CLIENT_X509,
+                                                      "ubxlib_test_cert",
+                                                      buffer) == 0);
+        syncItem.pMd5 = buffer;
+        U_PORT_TEST_ASSERT(uSecurityCredentialSync(devHandle, &syncItem, 1) == 0);
+        U_PORT_TEST_ASSERT(uSecurityCredentialRemove(devHandle,
+                                                     U_SECURITY_CREDENTIAL_CLIENT_X509,
+                                                     "ubxlib_test_cert") == 0);
+
         // Check that it is no longer listed
         U_TEST_PRINT_LINE_X("listing credentials...", x);
         z = 0;
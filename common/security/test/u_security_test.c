@@ -145,10 +145,35 @@ extern void uAtClientDetailedDebugPrint();
 
 #endif
 
+#ifndef U_SECURITY_TEST_E2E_STREAM_SLICE_LENGTH_BYTES
+/** The slice size to use when testing uSecurityE2eEncryptStream(),
+ * chosen to not divide into the length of gAllChars.
+ */
+# define U_SECURITY_TEST_E2E_STREAM_SLICE_LENGTH_BYTES 50
+#endif
+
+#ifndef U_SECURITY_TEST_E2E_STREAM_READ_LENGTH_BYTES
+/** The most that the read callback of uSecurityE2eEncryptStream()
+ * provides at a time during testing, deliberately less than
+ * #U_SECURITY_TEST_E2E_STREAM_SLICE_LENGTH_BYTES.
+ */
+# define U_SECURITY_TEST_E2E_STREAM_READ_LENGTH_BYTES 7
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** Context for the uSecurityE2eEncryptStream() test callbacks.
+ */
+typedef struct {
+    size_t readOffset;
+    size_t writeOffset;
+    int32_t headerLengthBytes;
+    int32_t numSlices;
+    bool sliceSizesGood;
+} uSecurityTestE2eStream_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -159,6 +184,10 @@ extern void uAtClientDetailedDebugPrint();
 static int64_t gStopTimeMs;
 #endif
 
+/** Count of calls to heartbeatCallback().
+ */
+static volatile int32_t gHeartbeatCallbackCount = 0;
+
 // A string of all possible characters, used
 // when testing end to end encryption
 static const char gAllChars[] = "the quick brown fox jumps over the lazy dog "
@@ -209,6 +238,64 @@ char *gpBuffer = NULL;
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Callback for uSecurityHeartbeatTriggerDeferred().
+static void heartbeatCallback(uDeviceHandle_t devHandle,
+                              int32_t errorCode, void *pParam)
+{
+    (void) devHandle;
+    (void) errorCode;
+    (void) pParam;
+
+    gHeartbeatCallbackCount++;
+}
+
+// Read callback for uSecurityE2eEncryptStream(), providing
+// gAllChars a few bytes at a time.
+static int32_t e2eStreamReadCallback(uDeviceHandle_t devHandle,
+                                     char *pBuffer, size_t bufferSizeBytes,
+                                     void *pCallbackParam)
+{
+    uSecurityTestE2eStream_t *pStream = (uSecurityTestE2eStream_t *) pCallbackParam;
+    size_t length = sizeof(gAllChars) - pStream->readOffset;
+
+    (void) devHandle;
+
+    if (length > bufferSizeBytes) {
+        length = bufferSizeBytes;
+    }
+    if (length > U_SECURITY_TEST_E2E_STREAM_READ_LENGTH_BYTES) {
+        length = U_SECURITY_TEST_E2E_STREAM_READ_LENGTH_BYTES;
+    }
+    memcpy(pBuffer, gAllChars + pStream->readOffset, length);
+    pStream->readOffset += length;
+
+    return (int32_t) length;
+}
+
+// Write callback for uSecurityE2eEncryptStream(), checking that
+// each encrypted slice is of the expected size.
+static int32_t e2eStreamWriteCallback(uDeviceHandle_t devHandle,
+                                      const char *pData, size_t dataSizeBytes,
+                                      void *pCallbackParam)
+{
+    uSecurityTestE2eStream_t *pStream = (uSecurityTestE2eStream_t *) pCallbackParam;
+    size_t sliceSizeBytes = sizeof(gAllChars) - pStream->writeOffset;
+
+    (void) devHandle;
+    (void) pData;
+
+    if (sliceSizeBytes > U_SECURITY_TEST_E2E_STREAM_SLICE_LENGTH_BYTES) {
+        sliceSizeBytes = U_SECURITY_TEST_E2E_STREAM_SLICE_LENGTH_BYTES;
+    }
+    if (dataSizeBytes != sliceSizeBytes + pStream->headerLengthBytes) {
+        pStream->sliceSizesGood = false;
+    }
+    pStream->writeOffset += sliceSizeBytes;
+    pStream->numSlices++;
+
+    return 0;
+}
+
 #ifdef U_CFG_SECURITY_DEVICE_PROFILE_UID
 // Callback function for the security sealing processes.
 static bool keepGoingCallback()
@@ -1031,6 +1118,8 @@ U_PORT_TEST_FUNCTION("[security]", "securityE2eEncryption")
     void *pData;
     int32_t version;
     int32_t headerLengthBytes = U_SECURITY_E2E_V1_HEADER_LENGTH_BYTES;
+    uSecurityTestE2eStream_t stream;
+    int32_t numSlices;
 
     // Do the standard preamble to make sure there is
     // a network underneath us
@@ -1060,6 +1149,28 @@ U_PORT_TEST_FUNCTION("[security]", "securityE2eEncryption")
                 // disable while the problem is investigated.
                 //y = uSecurityHeartbeatTrigger(devHandle);
                 //U_TEST_PRINT_LINE("uSecurityHeartbeatTrigger() returned %d.", y);
+
+                // A deferred heartbeat can be scheduled and cancelled
+                // without one actually being sent, provided the radio is
+                // not known to be awake, which it isn't since the +CSCON
+                // URC is not switched on here; a platform without timers
+                // will refuse
+                gHeartbeatCallbackCount = 0;
+                y = uSecurityHeartbeatTriggerDeferred(devHandle, 3600000,
+                                                      heartbeatCallback, NULL);
+                U_TEST_PRINT_LINE("uSecurityHeartbeatTriggerDeferred() returned %d.", y);
+                if (y == 0) {
+                    U_PORT_TEST_ASSERT(uSecurityHeartbeatTriggerDeferred(devHandle, 3600000,
+                                                                         heartbeatCallback,
+                                                                         NULL) == (int32_t) U_ERROR_COMMON_TEMPORARY_FAILURE);
+                    U_PORT_TEST_ASSERT(uSecurityHeartbeatCancelDeferred(devHandle) == 0);
+                    uPortTaskBlock(100);
+                    U_PORT_TEST_ASSERT(gHeartbeatCallbackCount == 0);
+                } else {
+                    U_PORT_TEST_ASSERT(y == (int32_t) U_ERROR_COMMON_NOT_IMPLEMENTED);
+                }
+                U_PORT_TEST_ASSERT(uSecurityHeartbeatCancelDeferred(devHandle) == 0);
+
                 U_TEST_PRINT_LINE("testing end to end encryption...");
 
                 // First get the current E2E encryption version
@@ -1106,6 +1217,28 @@ U_PORT_TEST_FUNCTION("[security]", "securityE2eEncryption")
                 //lint -e(668) Suppress possible NULL pointer, it is checked above
                 U_PORT_TEST_ASSERT(memcmp(pData, gAllChars, sizeof(gAllChars)) != 0);
                 uPortFree(pData);
+
+                // Now do the same in slices
+                memset(&stream, 0, sizeof(stream));
+                stream.headerLengthBytes = headerLengthBytes;
+                stream.sliceSizesGood = true;
+                numSlices = (sizeof(gAllChars) +
+                             U_SECURITY_TEST_E2E_STREAM_SLICE_LENGTH_BYTES - 1) /
+                            U_SECURITY_TEST_E2E_STREAM_SLICE_LENGTH_BYTES;
+                U_TEST_PRINT_LINE("requesting end to end encryption of %d byte(s) of data"
+                                  " in slices of %d byte(s)...", sizeof(gAllChars),
+                                  U_SECURITY_TEST_E2E_STREAM_SLICE_LENGTH_BYTES);
+                y = uSecurityE2eEncryptStream(devHandle,
+                                              U_SECURITY_TEST_E2E_STREAM_SLICE_LENGTH_BYTES,
+                                              e2eStreamReadCallback,
+                                              e2eStreamWriteCallback,
+                                              &stream);
+                U_TEST_PRINT_LINE("%d byte(s) of data returned in %d slice(s).",
+                                  y, stream.numSlices);
+                U_PORT_TEST_ASSERT(stream.numSlices == numSlices);
+                U_PORT_TEST_ASSERT(stream.sliceSizesGood);
+                U_PORT_TEST_ASSERT(stream.readOffset == sizeof(gAllChars));
+                U_PORT_TEST_ASSERT(y == sizeof(gAllChars) + (numSlices * headerLengthBytes));
             } else {
                 U_TEST_PRINT_LINE("this device supports u-blox security but has not"
                                   " been security sealed, no testing of end to end"
@@ -1272,6 +1405,8 @@ U_PORT_TEST_FUNCTION("[security]", "securityZtp")
     int32_t z;
     int32_t heapUsed;
     char *pData;
+    char *pDataCached;
+    int64_t startTimeMs;
 #ifdef U_CFG_TEST_SECURITY_C2C_TE_SECRET
     char key[U_SECURITY_C2C_ENCRYPTION_KEY_LENGTH_BYTES];
     char hmac[U_SECURITY_C2C_HMAC_TAG_LENGTH_BYTES];
@@ -1373,6 +1508,45 @@ U_PORT_TEST_FUNCTION("[security]", "securityZtp")
                     U_TEST_PRINT_LINE("module does not support reading certificate authorities.");
                 }
 
+                // Read the device public certificate with the cache on:
+                // the second read should come from the cache
+                y = uSecurityZtpSetCache(devHandle, true);
+                U_PORT_TEST_ASSERT((y == 0) || (y == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED));
+                if (y == 0) {
+                    U_PORT_TEST_ASSERT(uSecurityZtpCacheIsOn(devHandle));
+                    y = uSecurityZtpGetDeviceCertificate(devHandle, NULL, 0);
+                    if (y > 0) {
+                        pData = (char *) pUPortMalloc(y);
+                        U_PORT_TEST_ASSERT(pData != NULL);
+                        pDataCached = (char *) pUPortMalloc(y);
+                        U_PORT_TEST_ASSERT(pDataCached != NULL);
+                        U_TEST_PRINT_LINE("getting device public X.509 certificate"
+                                          " with the cache on...");
+                        startTimeMs = uPortGetTickTimeMs();
+                        z = uSecurityZtpGetDeviceCertificate(devHandle, pData, y);
+                        U_TEST_PRINT_LINE("took %d ms.",
+                                          (int32_t) (uPortGetTickTimeMs() - startTimeMs));
+                        U_PORT_TEST_ASSERT(z == y);
+                        U_TEST_PRINT_LINE("getting it again, from the cache this time...");
+                        startTimeMs = uPortGetTickTimeMs();
+                        z = uSecurityZtpGetDeviceCertificate(devHandle, pDataCached, y);
+                        U_TEST_PRINT_LINE("took %d ms.",
+                                          (int32_t) (uPortGetTickTimeMs() - startTimeMs));
+                        U_PORT_TEST_ASSERT(z == y);
+                        //lint -e(668) Suppress possible use of NULL pointer
+                        U_PORT_TEST_ASSERT(memcmp(pData, pDataCached, y) == 0);
+                        // A short buffer should be treated as the module would
+                        z = uSecurityZtpGetDeviceCertificate(devHandle, pDataCached, 10);
+                        U_PORT_TEST_ASSERT(z == 10);
+                        U_PORT_TEST_ASSERT(strlen(pDataCached) == 9);
+                        U_PORT_TEST_ASSERT(memcmp(pData, pDataCached, 9) == 0);
+                        uPortFree(pDataCached);
+                        uPortFree(pData);
+                    }
+                    U_PORT_TEST_ASSERT(uSecurityZtpSetCache(devHandle, false) == 0);
+                    U_PORT_TEST_ASSERT(!uSecurityZtpCacheIsOn(devHandle));
+                }
+
 #ifdef U_CFG_TEST_SECURITY_C2C_TE_SECRET
                 U_TEST_PRINT_LINE("closing C2C session again...");
                 U_PORT_TEST_ASSERT(uSecurityC2cClose(devHandle) == 0);
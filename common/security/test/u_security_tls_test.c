@@ -50,6 +50,7 @@
 #include "u_network_test_shared_cfg.h"
 
 #include "u_sock.h"
+#include "u_sock_errno.h" // For U_SOCK_EINVAL
 #include "u_sock_security.h"
 #include "u_sock_test_shared_cfg.h"
 
@@ -229,6 +230,119 @@ static bool closeSock(uSockDescriptor_t descriptor)
  * PUBLIC FUNCTIONS: TESTS
  * -------------------------------------------------------------- */
 
+/** Check the PSK settings that uSockPskConnect() derives, using
+ * uSecurityTlsSettingsPskDerive(), from the caller's certificate-based
+ * settings, and the parameter checking of uSockPskConnect(); no
+ * module is required.
+ */
+U_PORT_TEST_FUNCTION("[securityTls]", "securityTlsPskDerive")
+{
+    uSecurityTlsSettings_t settings = U_SECURITY_TLS_SETTINGS_DEFAULT;
+    uSecurityTlsSettings_t pskSettings;
+    uSockAddress_t remoteAddress = {0};
+    char psk[] = "aPreSharedKey";
+    char pskId[] = "aPreSharedKeyId";
+    int32_t heapUsed;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    settings.tlsVersionMin = U_SECURITY_TLS_VERSION_1_2;
+    settings.pRootCaCertificateName = "rootCa";
+    settings.pClientCertificateName = "clientCert";
+    settings.pClientPrivateKeyName = "clientKey";
+    settings.pClientPrivateKeyPassword = "password";
+    settings.certificateCheck = U_SECURITY_TLS_CERTIFICATE_CHECK_ROOT_CA_URL;
+    settings.pExpectedServerUrl = "ubxlib.com";
+    settings.pSni = "sni.ubxlib.com";
+    settings.enableSessionResumption = true;
+    settings.useDeviceCertificate = true;
+    settings.includeCaCertificates = true;
+    settings.psk.pBin = psk;
+    settings.psk.size = sizeof(psk) - 1;
+    settings.pskId.pBin = pskId;
+    settings.pskId.size = sizeof(pskId) - 1;
+    settings.cipherSuites.suite[0] = U_SECURITY_TLS_CIPHER_SUITE_PSK_WITH_AES_256_CBC_SHA384;
+    settings.cipherSuites.num = 1;
+
+    U_TEST_PRINT_LINE("deriving PSK settings, caller's PSK and cipher suite...");
+    memset(&pskSettings, 0xa5, sizeof(pskSettings));
+    uSecurityTlsSettingsPskDerive(&settings, &pskSettings);
+    // The certificates and everything that goes with them are gone
+    U_PORT_TEST_ASSERT(pskSettings.pRootCaCertificateName == NULL);
+    U_PORT_TEST_ASSERT(pskSettings.pClientCertificateName == NULL);
+    U_PORT_TEST_ASSERT(pskSettings.pClientPrivateKeyName == NULL);
+    U_PORT_TEST_ASSERT(pskSettings.pClientPrivateKeyPassword == NULL);
+    U_PORT_TEST_ASSERT(pskSettings.certificateCheck == U_SECURITY_TLS_CERTIFICATE_CHECK_NONE);
+    U_PORT_TEST_ASSERT(pskSettings.pExpectedServerUrl == NULL);
+    U_PORT_TEST_ASSERT(!pskSettings.useDeviceCertificate);
+    U_PORT_TEST_ASSERT(!pskSettings.includeCaCertificates);
+    // The caller's PSK is kept, so the module need not generate one
+    U_PORT_TEST_ASSERT(pskSettings.psk.pBin == psk);
+    U_PORT_TEST_ASSERT(pskSettings.psk.size == sizeof(psk) - 1);
+    U_PORT_TEST_ASSERT(pskSettings.pskId.pBin == pskId);
+    U_PORT_TEST_ASSERT(pskSettings.pskId.size == sizeof(pskId) - 1);
+    U_PORT_TEST_ASSERT(!pskSettings.pskGeneratedByRoT);
+    // As are the caller's cipher suites and everything else
+    U_PORT_TEST_ASSERT(pskSettings.cipherSuites.num == 1);
+    U_PORT_TEST_ASSERT(pskSettings.cipherSuites.suite[0] ==
+                       U_SECURITY_TLS_CIPHER_SUITE_PSK_WITH_AES_256_CBC_SHA384);
+    U_PORT_TEST_ASSERT(pskSettings.tlsVersionMin == U_SECURITY_TLS_VERSION_1_2);
+    U_PORT_TEST_ASSERT(strcmp(pskSettings.pSni, "sni.ubxlib.com") == 0);
+    U_PORT_TEST_ASSERT(pskSettings.enableSessionResumption);
+    // The caller's settings are untouched
+    U_PORT_TEST_ASSERT(strcmp(settings.pRootCaCertificateName, "rootCa") == 0);
+    U_PORT_TEST_ASSERT(settings.certificateCheck == U_SECURITY_TLS_CERTIFICATE_CHECK_ROOT_CA_URL);
+
+    U_TEST_PRINT_LINE("deriving PSK settings, no PSK ID or cipher suites...");
+    settings.pskId.pBin = NULL;
+    settings.pskId.size = 0;
+    settings.cipherSuites.num = 0;
+    memset(&pskSettings, 0xa5, sizeof(pskSettings));
+    uSecurityTlsSettingsPskDerive(&settings, &pskSettings);
+    U_PORT_TEST_ASSERT(pskSettings.pRootCaCertificateName == NULL);
+    // Without both a PSK and a PSK ID the module generates them
+    U_PORT_TEST_ASSERT(pskSettings.pskGeneratedByRoT);
+    // The default PSK cipher suites are offered
+    U_PORT_TEST_ASSERT(pskSettings.cipherSuites.num == 4);
+    U_PORT_TEST_ASSERT(pskSettings.cipherSuites.suite[0] ==
+                       U_SECURITY_TLS_CIPHER_SUITE_ECDHE_PSK_WITH_AES_128_CBC_SHA256);
+    U_PORT_TEST_ASSERT(pskSettings.cipherSuites.suite[1] ==
+                       U_SECURITY_TLS_CIPHER_SUITE_PSK_WITH_AES_128_GCM_SHA256);
+    U_PORT_TEST_ASSERT(pskSettings.cipherSuites.suite[2] ==
+                       U_SECURITY_TLS_CIPHER_SUITE_PSK_WITH_AES_128_CBC_SHA256);
+    U_PORT_TEST_ASSERT(pskSettings.cipherSuites.suite[3] ==
+                       U_SECURITY_TLS_CIPHER_SUITE_PSK_WITH_AES_128_CBC_SHA);
+    U_PORT_TEST_ASSERT(settings.cipherSuites.num == 0);
+
+    // Nothing should happen with NULL parameters
+    uSecurityTlsSettingsPskDerive(NULL, &pskSettings);
+    uSecurityTlsSettingsPskDerive(&settings, NULL);
+
+    U_TEST_PRINT_LINE("checking uSockPskConnect() parameters...");
+    errno = 0;
+    U_PORT_TEST_ASSERT(uSockPskConnect(NULL, NULL, &settings) < 0);
+    U_PORT_TEST_ASSERT(errno == U_SOCK_EINVAL);
+    errno = 0;
+    U_PORT_TEST_ASSERT(uSockPskConnect(NULL, &remoteAddress, NULL) < 0);
+    U_PORT_TEST_ASSERT(errno == U_SOCK_EINVAL);
+    errno = 0;
+    uSockDeinit();
+
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
 /** TCP socket over a TLS connection.
  */
 U_PORT_TEST_FUNCTION("[securityTls]", "securityTlsSock")
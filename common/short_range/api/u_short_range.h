@@ -250,6 +250,40 @@ int32_t uShortRangeOpenUart(uShortRangeModuleType_t moduleType,
                             const uShortRangeUartConfig_t *pUartConfig,
                             bool restart, uDeviceHandle_t *pDevHandle);
 
+/** Open UART for a short range module, as uShortRangeOpenUart() with
+ * restart set to false, and then switch the module to the fastest of
+ * 3000000, 2000000, 1500000, 1000000, 921600, 460800 or 230400 baud,
+ * up to maxBaudRate, that it accepts and that then passes
+ * uShortRangeAttention(), with hardware flow control.  The new rate
+ * is stored in the module so that it is used from then on, hence
+ * this function first tries the fastest rate up to maxBaudRate and
+ * then the baud rate of pUartConfig, only trying the slower rates
+ * after that; opening is quickest if maxBaudRate is a rate that both
+ * the module and the MCU UART support, e.g. 3000000 for NINA-W1.
+ * If the pinCts or pinRts of pUartConfig is negative no upgrade is
+ * attempted, since flow control is required at these rates.  Any
+ * later call to uShortRangeSetBaudrate() should, of course, have
+ * the pUartConfig baud rate set to that returned by this function.
+ *
+ * Note: should the module accept a new rate that the MCU UART then
+ * cannot manage, the module is left at the new rate, without having
+ * stored it, and an error is returned; communication will be at the
+ * baud rate of pUartConfig again once the module has been power-cycled.
+ *
+ * @param moduleType       the short range module type.
+ * @param[in] pUartConfig  the UART configuration to be used; baudRate
+ *                         should be the rate the module uses by default.
+ * @param maxBaudRate      the maximum baud rate to upgrade to.
+ * @param[out] pDevHandle  a pointer to the output handle. Will only be
+ *                         set on success.
+ * @return                 on success the baud rate now in use, else
+ *                         negative error code.
+ */
+int32_t uShortRangeOpenUartBaudrateUpgrade(uShortRangeModuleType_t moduleType,
+                                           const uShortRangeUartConfig_t *pUartConfig,
+                                           int32_t maxBaudRate,
+                                           uDeviceHandle_t *pDevHandle);
+
 /** Closes and disconnects all associated handles, such as UART and EDM, for the short range instance
  *
  * @param devHandle         the short range device handle to close.
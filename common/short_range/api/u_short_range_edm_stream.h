@@ -22,6 +22,8 @@
  * of another module should be included here; otherwise
  * please keep #includes to your .c files. */
 
+#include "u_sock.h" // uSockIoVec_t
+
 /** \addtogroup _short-range
  *  @{
  */
@@ -46,6 +48,15 @@ extern "C" {
 #define U_EDM_STREAM_EVENT_QUEUE_SIZE 3
 #endif
 
+#ifndef U_SHORT_RANGE_EDM_STREAM_MAX_NUM
+/** The maximum number of EDM streams, i.e. short range modules
+ * connected over separate UARTs, that may be open at any one time.
+ * Each stream has its own lock and its own event queue (and hence
+ * task), so that the streams run independently of one another.
+ */
+# define U_SHORT_RANGE_EDM_STREAM_MAX_NUM 2
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -81,12 +92,15 @@ typedef void (*uEdmDataEventCallback_t)(int32_t edmStreamHandle,
  */
 int32_t uShortRangeEdmStreamInit();
 
-/** Shutdown stream handling.
+/** Shutdown stream handling; this does nothing while any stream
+ * is still open, allowing each user of a stream to call
+ * uShortRangeEdmStreamInit() and this function independently.
  */
 void uShortRangeEdmStreamDeinit();
 
 /** Open an instance. Needs an open UART instance that is not accessed
- * by any other module.
+ * by any other module.  Up to #U_SHORT_RANGE_EDM_STREAM_MAX_NUM
+ * instances may be open at once, each on a different UART.
  *
  * @param uartHandle       the UART HW block to use.
  * @return                 a stream handle else negative
@@ -162,6 +176,25 @@ int32_t uShortRangeEdmStreamWrite(int32_t handle, int32_t channel,
                                   const void *pBuffer, size_t sizeBytes,
                                   uint32_t timeoutMs);
 
+/** As uShortRangeEdmStreamWrite() but the data is gathered from
+ * several pieces, which are sent in a single EDM data frame (or,
+ * for a Bluetooth connection, as few frames as the frame size
+ * allows) without being copied into one buffer first.
+ *
+ * @param handle      the handle of the stream instance.
+ * @param channel     the number of for the connection channel given in
+ *                    the connected event callback.
+ * @param[in] pIoVec  an array of ioVecCount pieces of data to send.
+ * @param ioVecCount  the number of entries at pIoVec.
+ * @param timeoutMs   timeout in ms, as for uShortRangeEdmStreamWrite().
+ * @return            the number of bytes sent or negative
+ *                    error code.
+ */
+int32_t uShortRangeEdmStreamWritev(int32_t handle, int32_t channel,
+                                   const uSockIoVec_t *pIoVec,
+                                   size_t ioVecCount,
+                                   uint32_t timeoutMs);
+
 /** Set a callback to be called when an AT event occurs.
  * pFunction will be called asynchronously in its own task.
  *
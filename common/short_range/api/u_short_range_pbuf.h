@@ -56,6 +56,7 @@ extern "C" {
 typedef U_PACKED_STRUCT(uShortRangePbuf_t) {
     struct uShortRangePbuf_t *pNext; /**< Used for linked list of pBuf */
     uint16_t length; /**< Number of used bytes in the data buffer */
+    uint16_t size; /**< Size of the data buffer */
     char data[];  /**< Data buffer */
 } uShortRangePbuf_t;
 #ifdef _MSC_VER
@@ -88,9 +89,52 @@ typedef struct uShortRangePktList_t {
     int32_t pktCount;
 } uShortRangePktList_t;
 
+/** A pbuf size class, see uShortRangeMemPoolConfigure().
+ */
+typedef struct {
+    uint16_t dataSize; /**< the number of bytes of data that each
+                            pbuf of this class can hold. */
+    int32_t count;     /**< the number of pbufs of this class. */
+} uShortRangePbufPoolSize_t;
+
+/** Statistics for a pbuf size class, see uShortRangeMemPoolGetStats().
+ */
+typedef struct {
+    uint16_t dataSize;      /**< the number of bytes of data that each
+                                 pbuf of this class can hold. */
+    int32_t count;          /**< the number of pbufs of this class. */
+    int32_t usedCount;      /**< the number currently in use. */
+    int32_t peakUsedCount;  /**< the most that have been in use at once
+                                 since uShortRangeMemPoolInit(). */
+    int32_t allocFailCount; /**< the number of times that a pbuf of this
+                                 class was wanted but none was free. */
+} uShortRangePbufPoolStats_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
+/** Set the size classes of the pbuf pool; unlike the other
+ * functions here this may be called by the application, before
+ * the short range API is initialised, e.g. before uDeviceInit():
+ * it takes effect at the next uShortRangeMemPoolInit().  Received
+ * EDM data is put into pbufs of the smallest class that will hold
+ * it, larger transfers using few large pbufs while small events
+ * use small ones.  If this is not called the size classes are
+ * those of U_SHORT_RANGE_PBUF_POOL_SIZES in u_short_range_pbuf.c.
+ * Memory for a class is only allocated when its first pbuf is used.
+ *
+ * @param[in] pSizes the size classes, in ascending order of
+ *                   dataSize; between them they must be able to
+ *                   hold U_SHORT_RANGE_EDM_MAX_SIZE bytes.  The
+ *                   array is copied.  Use NULL, with numSizes
+ *                   zero, to return to the defaults.
+ * @param numSizes   the number of entries at pSizes, at most
+ *                   U_MEMPOOL_SLAB_MAX_NUM_SIZES.
+ * @return           zero on success else negative error code.
+ */
+int32_t uShortRangeMemPoolConfigure(const uShortRangePbufPoolSize_t *pSizes,
+                                    size_t numSizes);
+
 /** Initialize the memory pool for shortrange.
  *
  * @return zero on success else negative error code.
@@ -102,6 +146,26 @@ int32_t uShortRangeMemPoolInit(void);
  */
 void uShortRangeMemPoolDeInit(void);
 
+/** Get the usage statistics of the pbuf pool, one entry per
+ * size class, smallest first.
+ *
+ * @param[out] pStats a place to put the statistics; cannot be NULL.
+ * @param numStats    the number of entries at pStats.
+ * @return            the number of entries written to pStats,
+ *                    else negative error code.
+ */
+int32_t uShortRangeMemPoolGetStats(uShortRangePbufPoolStats_t *pStats,
+                                   size_t numStats);
+
+/** Get the amount of pbuf storage currently held in pbuf lists for
+ * the given EDM channel, i.e. the total size of the pbufs that have
+ * been appended to a pbuf list with that edmChannel and not yet freed.
+ *
+ * @param edmChannel the EDM channel.
+ * @return           the number of bytes of pbuf held for edmChannel.
+ */
+int32_t uShortRangePbufChannelBytes(int8_t edmChannel);
+
 /** Allocate fixed size memory from gEdmPayLoadPool memory pool.
  * Refer to gEdmPayLoadPool in u_short_range_pbuf.c
  * Memory pool should have been initialized before using this
@@ -113,6 +177,19 @@ void uShortRangeMemPoolDeInit(void);
  */
 int32_t uShortRangePbufAlloc(uShortRangePbuf_t **ppBuf);
 
+/** As uShortRangePbufAlloc() but allocate, if possible, a pbuf
+ * that will hold at least size bytes: the smallest size class
+ * that will hold size bytes is tried first, then the larger
+ * classes and finally the smaller ones.
+ *
+ * @param[out] ppBuf a double pointer to destination pbuf.
+ * @param size       the number of bytes of data wanted.
+ * @return           data size of the returned pbuf, which may
+ *                   be less than size, on failure negative
+ *                   error code.
+ */
+int32_t uShortRangePbufAllocSize(uShortRangePbuf_t **ppBuf, size_t size);
+
 /** Allocate memory for pbuf list from the pbuf list
  * memory pool. Refer to gPBufListPool in u_short_range_pbuf.c
  * Memory pool should have been initialized before using this
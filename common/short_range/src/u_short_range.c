@@ -87,6 +87,13 @@ static const uShortRangeModuleInfo_t gModuleInfo[] = {
 
 static const size_t gModuleInfoCount = sizeof(gModuleInfo) / sizeof(gModuleInfo[0]);
 
+/** The UART baud rates that uShortRangeOpenUartBaudrateUpgrade() will
+ * try, fastest first; 3000000 is the fastest that NINA-W1 offers.
+ */
+static const int32_t gBaudRateUpgrade[] = {3000000, 2000000, 1500000, 1000000,
+                                           921600, 460800, 230400
+                                          };
+
 #undef U_YES
 #undef U_NO
 #undef U_SHORT_RANGE_MODULE
@@ -158,6 +165,7 @@ static void removeShortRangeInstance(uShortRangePrivateInstance_t *pInstance)
         }
     }
 
+    uPortFree(pInstance->pWifiScanCache);
     uPortFree(pInstance);
 }
 
@@ -675,6 +683,84 @@ static void configureConnectionUrcHandlers(uShortRangePrivateInstance_t *pInstan
     }
 }
 
+// Return true if baudRate is one that may be used to upgrade from
+// the baud rate of pUartConfig, given a maximum of maxBaudRate.
+static bool isBaudRateUpgrade(int32_t baudRate,
+                              const uShortRangeUartConfig_t *pUartConfig,
+                              int32_t maxBaudRate)
+{
+    return (baudRate > pUartConfig->baudRate) && (baudRate <= maxBaudRate);
+}
+
+// Switch a short range module, opened at the baud rate of pUartConfig,
+// to the fastest rate up to maxBaudRate that it accepts and that can
+// then be verified, re-opening it at that rate, and store the rate in
+// the module so that it is used from power-on; returns the baud rate
+// now in use or negative error code, in which case *pDevHandle is NULL.
+static int32_t upgradeBaudRate(uShortRangeModuleType_t moduleType,
+                               const uShortRangeUartConfig_t *pUartConfig,
+                               int32_t maxBaudRate,
+                               uDeviceHandle_t *pDevHandle)
+{
+    int32_t errorCodeOrBaudRate = pUartConfig->baudRate;
+    uShortRangePrivateInstance_t *pInstance;
+    uShortRangeUartConfig_t uartConfig = *pUartConfig;
+    char atBuffer[48];
+
+    pInstance = pUShortRangePrivateGetInstance(*pDevHandle);
+    for (size_t x = 0; (x < sizeof(gBaudRateUpgrade) / sizeof(gBaudRateUpgrade[0])) &&
+         (errorCodeOrBaudRate == pUartConfig->baudRate); x++) {
+        if (isBaudRateUpgrade(gBaudRateUpgrade[x], pUartConfig, maxBaudRate)) {
+            // Flow control on: this must be used at these rates
+            snprintf(atBuffer, sizeof(atBuffer), "AT+UMRS=%d,1,8,1,1",
+                     (int) gBaudRateUpgrade[x]);
+            // An error here means the module doesn't support the rate
+            if (executeAtCommand(pInstance->atHandle, 1, atBuffer) == (int32_t) U_ERROR_COMMON_SUCCESS) {
+                // NINA-Bx requires a delay of 1 sec after changing baudrate
+                uPortTaskBlock(1000);
+                uShortRangeClose(*pDevHandle);
+                *pDevHandle = NULL;
+                uartConfig.baudRate = gBaudRateUpgrade[x];
+                if (uShortRangeOpenUart(moduleType, &uartConfig, false, pDevHandle) == 0) {
+                    if (uShortRangeAttention(*pDevHandle) == 0) {
+                        errorCodeOrBaudRate = uartConfig.baudRate;
+                    } else {
+                        uShortRangeClose(*pDevHandle);
+                        *pDevHandle = NULL;
+                    }
+                }
+                if (errorCodeOrBaudRate == pUartConfig->baudRate) {
+                    // The MCU end can't manage the new rate; since it was
+                    // not stored, on the next power-on the module will be
+                    // back at the original rate but, for now, all we can
+                    // do is try the original rate in case the module failed
+                    // to switch
+                    if (uShortRangeOpenUart(moduleType, pUartConfig, false, pDevHandle) == 0) {
+                        pInstance = pUShortRangePrivateGetInstance(*pDevHandle);
+                    } else {
+                        errorCodeOrBaudRate = (int32_t) U_SHORT_RANGE_ERROR_INIT_UART;
+                    }
+                }
+            }
+        }
+    }
+
+    if (errorCodeOrBaudRate != pUartConfig->baudRate) {
+        if (errorCodeOrBaudRate > 0) {
+            // Store the new rate so that the module starts with it
+            pInstance = pUShortRangePrivateGetInstance(*pDevHandle);
+            if (executeAtCommand(pInstance->atHandle, 1, "AT&W") != (int32_t) U_ERROR_COMMON_SUCCESS) {
+                uPortLog("U_SHORT_RANGE: unable to store baud rate %d.\n",
+                         errorCodeOrBaudRate);
+            }
+        } else {
+            *pDevHandle = NULL;
+        }
+    }
+
+    return errorCodeOrBaudRate;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -747,11 +833,6 @@ int32_t uShortRangeOpenUart(uShortRangeModuleType_t moduleType,
         return (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     }
 
-    // TODO: once we allow multiple edm streams this should be removed
-    if (gpUShortRangePrivateInstanceList != NULL) {
-        return (int32_t) U_SHORT_RANGE_ERROR_INIT_INTERNAL;
-    }
-
     if ((moduleType <= U_SHORT_RANGE_MODULE_TYPE_INTERNAL) ||
         (pUartConfig == NULL)) {
         return handleOrErrorCode;
@@ -846,6 +927,68 @@ int32_t uShortRangeOpenUart(uShortRangeModuleType_t moduleType,
     return (int32_t) U_ERROR_COMMON_SUCCESS;
 }
 
+int32_t uShortRangeOpenUartBaudrateUpgrade(uShortRangeModuleType_t moduleType,
+                                           const uShortRangeUartConfig_t *pUartConfig,
+                                           int32_t maxBaudRate,
+                                           uDeviceHandle_t *pDevHandle)
+{
+    int32_t errorCodeOrBaudRate = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uShortRangeUartConfig_t uartConfig;
+    bool flowControl;
+    size_t first = sizeof(gBaudRateUpgrade) / sizeof(gBaudRateUpgrade[0]);
+
+    if (gUShortRangePrivateMutex == NULL) {
+        return (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    }
+
+    if ((pUartConfig != NULL) && (pDevHandle != NULL)) {
+        uartConfig = *pUartConfig;
+        flowControl = (pUartConfig->pinCts >= 0) && (pUartConfig->pinRts >= 0);
+        errorCodeOrBaudRate = (int32_t) U_SHORT_RANGE_ERROR_INIT_INTERNAL;
+        if (flowControl) {
+            // The module will most likely have stored the fastest
+            // rate from a previous upgrade, so try that first
+            for (size_t x = 0; (x < sizeof(gBaudRateUpgrade) / sizeof(gBaudRateUpgrade[0])) &&
+                 (first == sizeof(gBaudRateUpgrade) / sizeof(gBaudRateUpgrade[0])); x++) {
+                if (isBaudRateUpgrade(gBaudRateUpgrade[x], pUartConfig, maxBaudRate)) {
+                    first = x;
+                    uartConfig.baudRate = gBaudRateUpgrade[x];
+                    if (uShortRangeOpenUart(moduleType, &uartConfig,
+                                            false, pDevHandle) == 0) {
+                        errorCodeOrBaudRate = uartConfig.baudRate;
+                    }
+                }
+            }
+        }
+        if (errorCodeOrBaudRate < 0) {
+            errorCodeOrBaudRate = uShortRangeOpenUart(moduleType, pUartConfig,
+                                                      false, pDevHandle);
+            if (errorCodeOrBaudRate == 0) {
+                errorCodeOrBaudRate = pUartConfig->baudRate;
+                if (flowControl) {
+                    errorCodeOrBaudRate = upgradeBaudRate(moduleType, pUartConfig,
+                                                          maxBaudRate, pDevHandle);
+                }
+            } else if (flowControl) {
+                // The module may have stored a slower rate than
+                // the fastest, try the remainder
+                for (size_t x = first + 1; (x < sizeof(gBaudRateUpgrade) / sizeof(gBaudRateUpgrade[0])) &&
+                     (errorCodeOrBaudRate < 0); x++) {
+                    if (isBaudRateUpgrade(gBaudRateUpgrade[x], pUartConfig, maxBaudRate)) {
+                        uartConfig.baudRate = gBaudRateUpgrade[x];
+                        if (uShortRangeOpenUart(moduleType, &uartConfig,
+                                                false, pDevHandle) == 0) {
+                            errorCodeOrBaudRate = uartConfig.baudRate;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return errorCodeOrBaudRate;
+}
+
 void uShortRangeClose(uDeviceHandle_t devHandle)
 {
     uShortRangePrivateInstance_t *pInstance;
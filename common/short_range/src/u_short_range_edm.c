@@ -27,6 +27,7 @@
 #include "u_assert.h"
 #include "u_short_range_module_type.h"
 #include "u_short_range_pbuf.h"
+#include "u_ringbuffer.h"
 #include "u_at_client.h"
 #include "u_short_range.h"
 #include "u_short_range_edm.h"
@@ -51,44 +52,50 @@
 #define U_SHORT_RANGE_EDM_CONNECTION_TYPE_BT      0x01
 #define U_SHORT_RANGE_EDM_CONNECTION_TYPE_IPv4    0x02
 #define U_SHORT_RANGE_EDM_CONNECTION_TYPE_IPv6    0x03
+
+#ifndef U_SHORT_RANGE_EDM_CHANNEL_PBUF_QUOTA
+// The number of bytes of pbuf that the received data of one EDM channel
+// may hold before further data packets on that channel are dropped
+// (AT and connection events are not affected); a packet that has
+// been started is always completed.  Set to 0 for no limit, in
+// which case a channel whose data is not consumed will eventually
+// stall reception on all channels.
+# define U_SHORT_RANGE_EDM_CHANNEL_PBUF_QUOTA (U_SHORT_RANGE_EDM_MAX_SIZE / 2)
+#endif
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
-typedef enum {
-    EDM_PARSER_STATE_PARSE_START_BYTE,
-    EDM_PARSER_STATE_PARSE_PAYLOAD_LENGTH,
-    EDM_PARSER_STATE_PARSE_HEADER_LENGTH,
-    EDM_PARSER_STATE_ALLOCATE_PBUFLIST,
-    EDM_PARSER_STATE_ALLOCATE_PAYLOAD,
-    EDM_PARSER_STATE_ACCUMULATE_PAYLOAD,
-    EDM_PARSER_STATE_PARSE_TAIL_BYTE,
-    EDM_PARSER_STATE_WAIT_FOR_EVENT_PROCESSING
-} edmParserState_t;
 
 /* ----------------------------------------------------------------
  * STATIC PROTOTYPES
  * -------------------------------------------------------------- */
 static int32_t getBtProfile(char value, uShortRangeBtProfile_t *profile);
 static int32_t getIpProtocol(char value, uShortRangeIpProtocol_t *protocol);
-static uShortRangeEdmEvent_t *allocateEdmEvent(void);
-static uShortRangeEdmEvent_t *parseConnectBtEvent(uint8_t channel, char *buffer,
+static uShortRangeEdmEvent_t *allocateEdmEvent(uShortRangeEdmParser_t *pParser);
+static uShortRangeEdmEvent_t *parseConnectBtEvent(uShortRangeEdmParser_t *pParser,
+                                                  uint8_t channel, char *buffer,
                                                   uint16_t payloadLength);
-static uShortRangeEdmEvent_t *parseConnectIpv4Event(uint8_t channel, char *buffer,
+static uShortRangeEdmEvent_t *parseConnectIpv4Event(uShortRangeEdmParser_t *pParser,
+                                                    uint8_t channel, char *buffer,
                                                     uint16_t payloadLength);
-static uShortRangeEdmEvent_t *parseConnectIpv6Event(uint8_t channel, char *buffer,
+static uShortRangeEdmEvent_t *parseConnectIpv6Event(uShortRangeEdmParser_t *pParser,
+                                                    uint8_t channel, char *buffer,
                                                     uint16_t payloadLength);
-static uShortRangeEdmEvent_t *parseConnectEvent(uint8_t channel, uShortRangePbufList_t *pBufList);
-static uShortRangeEdmEvent_t *parseDisconnectEvent(uint8_t channel);
-static uShortRangeEdmEvent_t *parseDataEvent(uint8_t channel, uShortRangePbufList_t *pBufList);
-static uShortRangeEdmEvent_t *parseAtResponseOrEvent(uShortRangePbufList_t *pBufList);
-static uShortRangeEdmEvent_t *parseEdmPayload(uint16_t idAndType, uint8_t channel,
+static uShortRangeEdmEvent_t *parseConnectEvent(uShortRangeEdmParser_t *pParser,
+                                                uint8_t channel, uShortRangePbufList_t *pBufList);
+static uShortRangeEdmEvent_t *parseDisconnectEvent(uShortRangeEdmParser_t *pParser,
+                                                   uint8_t channel);
+static uShortRangeEdmEvent_t *parseDataEvent(uShortRangeEdmParser_t *pParser,
+                                             uint8_t channel, uShortRangePbufList_t *pBufList);
+static uShortRangeEdmEvent_t *parseAtResponseOrEvent(uShortRangeEdmParser_t *pParser,
+                                                     uShortRangePbufList_t *pBufList);
+static uShortRangeEdmEvent_t *parseEdmPayload(uShortRangeEdmParser_t *pParser,
+                                              uint16_t idAndType, uint8_t channel,
                                               uShortRangePbufList_t *pBufList);
 
 /* ----------------------------------------------------------------
  * STATIC VARIABLES
  * -------------------------------------------------------------- */
-static edmParserState_t gEdmParserState = EDM_PARSER_STATE_PARSE_START_BYTE;
-static uShortRangePbufList_t *gCurPBufList = NULL;
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -130,14 +137,13 @@ static int32_t getIpProtocol(char value, uShortRangeIpProtocol_t *pProtocol)
     return U_SHORT_RANGE_EDM_OK;
 }
 
-static uShortRangeEdmEvent_t *allocateEdmEvent(void)
+static uShortRangeEdmEvent_t *allocateEdmEvent(uShortRangeEdmParser_t *pParser)
 {
-    static uShortRangeEdmEvent_t gEdmEvent;
-
-    return &gEdmEvent;
+    return &(pParser->event);
 }
 
-static uShortRangeEdmEvent_t *parseConnectBtEvent(uint8_t channel, char *pBuffer,
+static uShortRangeEdmEvent_t *parseConnectBtEvent(uShortRangeEdmParser_t *pParser,
+                                                  uint8_t channel, char *pBuffer,
                                                   uint16_t payloadLength)
 {
     uShortRangeEdmEvent_t *pEvent = NULL;
@@ -146,7 +152,7 @@ static uShortRangeEdmEvent_t *parseConnectBtEvent(uint8_t channel, char *pBuffer
 
     if ((payloadLength == 10) && (result == U_SHORT_RANGE_EDM_OK)) {
         uShortRangeEdmConnectionEventBt_t *pEvtData;
-        pEvent = allocateEdmEvent();
+        pEvent = allocateEdmEvent(pParser);
         pEvent->type = U_SHORT_RANGE_EDM_EVENT_CONNECT_BT;
         pEvtData = &pEvent->params.btConnectEvent;
         pEvtData->channel = channel;
@@ -159,7 +165,8 @@ static uShortRangeEdmEvent_t *parseConnectBtEvent(uint8_t channel, char *pBuffer
     return pEvent;
 }
 
-static uShortRangeEdmEvent_t *parseConnectIpv4Event(uint8_t channel, char *pBuffer,
+static uShortRangeEdmEvent_t *parseConnectIpv4Event(uShortRangeEdmParser_t *pParser,
+                                                    uint8_t channel, char *pBuffer,
                                                     uint16_t payloadLength)
 {
     uShortRangeEdmEvent_t *pEvent = NULL;
@@ -168,7 +175,7 @@ static uShortRangeEdmEvent_t *parseConnectIpv4Event(uint8_t channel, char *pBuff
 
     if ((payloadLength == 14) && (result == U_SHORT_RANGE_EDM_OK)) {
         uShortRangeEdmConnectionEventIpv4_t *pEvtData;
-        pEvent = allocateEdmEvent();
+        pEvent = allocateEdmEvent(pParser);
         pEvent->type = U_SHORT_RANGE_EDM_EVENT_CONNECT_IPv4;
         pEvtData = &pEvent->params.ipv4ConnectEvent;
         pEvtData->channel = channel;
@@ -186,7 +193,8 @@ static uShortRangeEdmEvent_t *parseConnectIpv4Event(uint8_t channel, char *pBuff
     return pEvent;
 }
 
-static uShortRangeEdmEvent_t *parseConnectIpv6Event(uint8_t channel, char *pBuffer,
+static uShortRangeEdmEvent_t *parseConnectIpv6Event(uShortRangeEdmParser_t *pParser,
+                                                    uint8_t channel, char *pBuffer,
                                                     uint16_t payloadLength)
 {
     uShortRangeEdmEvent_t *pEvent = NULL;
@@ -195,7 +203,7 @@ static uShortRangeEdmEvent_t *parseConnectIpv6Event(uint8_t channel, char *pBuff
 
     if ((payloadLength == 38) && (result == U_SHORT_RANGE_EDM_OK)) {
         uShortRangeEdmConnectionEventIpv6_t *pEvtData;
-        pEvent = allocateEdmEvent();
+        pEvent = allocateEdmEvent(pParser);
         pEvent->type = U_SHORT_RANGE_EDM_EVENT_CONNECT_IPv6;
         pEvtData = &pEvent->params.ipv6ConnectEvent;
         pEvtData->channel = channel;
@@ -213,7 +221,8 @@ static uShortRangeEdmEvent_t *parseConnectIpv6Event(uint8_t channel, char *pBuff
     return pEvent;
 }
 
-static uShortRangeEdmEvent_t *parseConnectEvent(uint8_t channel, uShortRangePbufList_t *pBufList)
+static uShortRangeEdmEvent_t *parseConnectEvent(uShortRangeEdmParser_t *pParser,
+                                                uint8_t channel, uShortRangePbufList_t *pBufList)
 {
     uShortRangeEdmEvent_t *pEvent = NULL;
     uint16_t payloadLength = 0;
@@ -229,15 +238,15 @@ static uShortRangeEdmEvent_t *parseConnectEvent(uint8_t channel, uShortRangePbuf
         switch (type) {
 
             case U_SHORT_RANGE_EDM_CONNECTION_TYPE_BT:
-                pEvent = parseConnectBtEvent(channel, pBuffer, payloadLength);
+                pEvent = parseConnectBtEvent(pParser, channel, pBuffer, payloadLength);
                 break;
 
             case U_SHORT_RANGE_EDM_CONNECTION_TYPE_IPv4:
-                pEvent = parseConnectIpv4Event(channel, pBuffer, payloadLength);
+                pEvent = parseConnectIpv4Event(pParser, channel, pBuffer, payloadLength);
                 break;
 
             case U_SHORT_RANGE_EDM_CONNECTION_TYPE_IPv6:
-                pEvent = parseConnectIpv6Event(channel, pBuffer, payloadLength);
+                pEvent = parseConnectIpv6Event(pParser, channel, pBuffer, payloadLength);
                 break;
 
             default:
@@ -248,23 +257,25 @@ static uShortRangeEdmEvent_t *parseConnectEvent(uint8_t channel, uShortRangePbuf
     return pEvent;
 }
 
-static uShortRangeEdmEvent_t *parseDisconnectEvent(uint8_t channel)
+static uShortRangeEdmEvent_t *parseDisconnectEvent(uShortRangeEdmParser_t *pParser,
+                                                   uint8_t channel)
 {
     uShortRangeEdmEvent_t *pEvent;
 
-    pEvent = allocateEdmEvent();
+    pEvent = allocateEdmEvent(pParser);
     pEvent->type = U_SHORT_RANGE_EDM_EVENT_DISCONNECT;
     pEvent->params.disconnectEvent.channel = channel;
 
     return pEvent;
 }
 
-static uShortRangeEdmEvent_t *parseDataEvent(uint8_t channel, uShortRangePbufList_t *pBufList)
+static uShortRangeEdmEvent_t *parseDataEvent(uShortRangeEdmParser_t *pParser,
+                                             uint8_t channel, uShortRangePbufList_t *pBufList)
 {
     uShortRangeEdmEvent_t *pEvent = NULL;
 
     if ((pBufList != NULL) && (pBufList->totalLen > 0)) {
-        pEvent = allocateEdmEvent();
+        pEvent = allocateEdmEvent(pParser);
         pEvent->type = U_SHORT_RANGE_EDM_EVENT_DATA;
         pEvent->params.dataEvent.channel = channel;
         pEvent->params.dataEvent.pBufList = pBufList;
@@ -273,15 +284,17 @@ static uShortRangeEdmEvent_t *parseDataEvent(uint8_t channel, uShortRangePbufLis
     return pEvent;
 }
 
-static uShortRangeEdmEvent_t *parseAtResponseOrEvent(uShortRangePbufList_t *pBufList)
+static uShortRangeEdmEvent_t *parseAtResponseOrEvent(uShortRangeEdmParser_t *pParser,
+                                                     uShortRangePbufList_t *pBufList)
 {
-    uShortRangeEdmEvent_t *pEvent = allocateEdmEvent();
+    uShortRangeEdmEvent_t *pEvent = allocateEdmEvent(pParser);
     pEvent->type = U_SHORT_RANGE_EDM_EVENT_AT;
     pEvent->params.atEvent.pBufList = pBufList;
     return pEvent;
 }
 
-static uShortRangeEdmEvent_t *parseEdmPayload(uint16_t idAndType, uint8_t channel,
+static uShortRangeEdmEvent_t *parseEdmPayload(uShortRangeEdmParser_t *pParser,
+                                              uint16_t idAndType, uint8_t channel,
                                               uShortRangePbufList_t *pBufList)
 {
     uShortRangeEdmEvent_t *pEvent = NULL;
@@ -289,26 +302,26 @@ static uShortRangeEdmEvent_t *parseEdmPayload(uint16_t idAndType, uint8_t channe
     switch (idAndType) {
 
         case U_SHORT_RANGE_EDM_TYPE_CONNECT_EVENT:
-            pEvent = parseConnectEvent(channel, pBufList);
+            pEvent = parseConnectEvent(pParser, channel, pBufList);
             uShortRangePbufListFree(pBufList);
             break;
 
         case U_SHORT_RANGE_EDM_TYPE_DISCONNECT_EVENT:
-            pEvent = parseDisconnectEvent(channel);
+            pEvent = parseDisconnectEvent(pParser, channel);
             uShortRangePbufListFree(pBufList);
             break;
 
         case U_SHORT_RANGE_EDM_TYPE_DATA_EVENT:
-            pEvent = parseDataEvent(channel, pBufList);
+            pEvent = parseDataEvent(pParser, channel, pBufList);
             break;
 
         case U_SHORT_RANGE_EDM_TYPE_AT_RESPONSE:
         case U_SHORT_RANGE_EDM_TYPE_AT_EVENT:
-            pEvent = parseAtResponseOrEvent(pBufList);
+            pEvent = parseAtResponseOrEvent(pParser, pBufList);
             break;
 
         case U_SHORT_RANGE_EDM_TYPE_START_EVENT:
-            pEvent = allocateEdmEvent();
+            pEvent = allocateEdmEvent(pParser);
             pEvent->type = U_SHORT_RANGE_EDM_EVENT_STARTUP;
             break;
         //lint -e825
@@ -325,88 +338,105 @@ static uShortRangeEdmEvent_t *parseEdmPayload(uint16_t idAndType, uint8_t channe
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
-bool uShortRangeEdmParserReady(void)
+bool uShortRangeEdmParserReady(const uShortRangeEdmParser_t *pParser)
 {
-    return (gEdmParserState != EDM_PARSER_STATE_WAIT_FOR_EVENT_PROCESSING);
+    return (pParser->state != EDM_PARSER_STATE_WAIT_FOR_EVENT_PROCESSING);
 }
 
-void uShortRangeEdmResetParser(void)
+void uShortRangeEdmResetParser(uShortRangeEdmParser_t *pParser)
 {
-    gEdmParserState = EDM_PARSER_STATE_PARSE_START_BYTE;
+    pParser->state = EDM_PARSER_STATE_PARSE_START_BYTE;
 }
 
-bool uShortRangeEdmParse(char c, uShortRangeEdmEvent_t **ppResultEvent, bool *pMemAvailable)
+bool uShortRangeEdmParse(uShortRangeEdmParser_t *pParser, char c,
+                         uShortRangeEdmEvent_t **ppResultEvent, bool *pMemAvailable)
 {
-    edmParserState_t newState = gEdmParserState;
-    static uint16_t payloadLength;
-    static uShortRangePbuf_t *pBuf;
-    static int32_t pBufSize;
-    static char header[U_SHORT_RANGE_EDM_HEADER_SIZE];
-    static uint32_t headerIndex;
-    static uint16_t idAndType;
-    static uint8_t channel;
+    uShortRangeEdmParserState_t newState = pParser->state;
     bool charConsumed = false;
     int32_t result;
 
     *pMemAvailable = true;
-    switch (gEdmParserState) {
+    switch (pParser->state) {
 
         case EDM_PARSER_STATE_PARSE_START_BYTE:
             if (c == U_SHORT_RANGE_EDM_HEAD) {
-                headerIndex = 0;
+                pParser->headerIndex = 0;
                 newState = EDM_PARSER_STATE_PARSE_PAYLOAD_LENGTH;
             }
             charConsumed = true;
             break;
 
         case EDM_PARSER_STATE_PARSE_PAYLOAD_LENGTH:
-            if (headerIndex == 0) {
-                payloadLength = (uint16_t)(uint8_t)c << 8;
-                headerIndex++;
+            if (pParser->headerIndex == 0) {
+                pParser->payloadLength = (uint16_t)(uint8_t)c << 8;
+                pParser->headerIndex++;
             } else {
-                payloadLength |= (uint16_t)(uint8_t)c;
-                if (payloadLength < 2) {
+                pParser->payloadLength |= (uint16_t)(uint8_t)c;
+                if (pParser->payloadLength < 2) {
                     // Something is wrong, start over
                     newState = EDM_PARSER_STATE_PARSE_START_BYTE;
                 } else {
-                    headerIndex = 0;
+                    pParser->headerIndex = 0;
                     newState = EDM_PARSER_STATE_PARSE_HEADER_LENGTH;
                 }
             }
             charConsumed = true;
             break;
         case EDM_PARSER_STATE_PARSE_HEADER_LENGTH:
-            header[headerIndex++] = c;
-            payloadLength--;
+            pParser->header[pParser->headerIndex++] = c;
+            pParser->payloadLength--;
 
-            if (headerIndex == 2) {
+            if (pParser->headerIndex == 2) {
 
-                idAndType = ((uint16_t)(uint8_t)header[0] << 8) | (uint16_t)(uint8_t)header[1];
+                pParser->idAndType = ((uint16_t)(uint8_t)pParser->header[0] << 8) |
+                                     (uint16_t)(uint8_t)pParser->header[1];
 
-                if ((idAndType == U_SHORT_RANGE_EDM_TYPE_AT_RESPONSE) ||
-                    (idAndType == U_SHORT_RANGE_EDM_TYPE_AT_EVENT)    ||
-                    (idAndType == U_SHORT_RANGE_EDM_TYPE_START_EVENT) ||
-                    (idAndType == U_SHORT_RANGE_EDM_TYPE_AT_REQUEST)) {
+                if ((pParser->idAndType == U_SHORT_RANGE_EDM_TYPE_AT_RESPONSE) ||
+                    (pParser->idAndType == U_SHORT_RANGE_EDM_TYPE_AT_EVENT)    ||
+                    (pParser->idAndType == U_SHORT_RANGE_EDM_TYPE_START_EVENT) ||
+                    (pParser->idAndType == U_SHORT_RANGE_EDM_TYPE_AT_REQUEST)) {
 
                     // Channel does not exist for these types so
                     // fill in -1
-                    header[headerIndex++] = -1;
+                    pParser->header[pParser->headerIndex++] = -1;
                 }
             }
 
-            if (headerIndex == U_SHORT_RANGE_EDM_HEADER_SIZE) {
-                channel = header[2];
-                // gCurPBufChain should always be NULL here
+            if (pParser->headerIndex == U_SHORT_RANGE_EDM_HEADER_SIZE) {
+                pParser->channel = pParser->header[2];
+                // pCurPBufList should always be NULL here
                 // If it's not we have a leak
-                U_ASSERT(gCurPBufList == NULL);
-                pBuf = NULL;
+                U_ASSERT(pParser->pCurPBufList == NULL);
+                pParser->pBuf = NULL;
                 newState = EDM_PARSER_STATE_ALLOCATE_PBUFLIST;
                 // For disconnect event there is no payload
                 // so directly head to parse tail byte
-                if ((idAndType == U_SHORT_RANGE_EDM_TYPE_DISCONNECT_EVENT) ||
-                    (idAndType == U_SHORT_RANGE_EDM_TYPE_START_EVENT)) {
+                if ((pParser->idAndType == U_SHORT_RANGE_EDM_TYPE_DISCONNECT_EVENT) ||
+                    (pParser->idAndType == U_SHORT_RANGE_EDM_TYPE_START_EVENT)) {
                     newState = EDM_PARSER_STATE_PARSE_TAIL_BYTE;
                 }
+                if ((pParser->pAtRingBuffer != NULL) &&
+                    ((pParser->idAndType == U_SHORT_RANGE_EDM_TYPE_AT_RESPONSE) ||
+                     (pParser->idAndType == U_SHORT_RANGE_EDM_TYPE_AT_EVENT))) {
+                    // AT payload goes straight into the AT ring buffer
+                    newState = EDM_PARSER_STATE_ACCUMULATE_AT_PAYLOAD;
+                    if (pParser->payloadLength == 0) {
+                        newState = EDM_PARSER_STATE_PARSE_TAIL_BYTE;
+                    }
+                }
+#if U_SHORT_RANGE_EDM_CHANNEL_PBUF_QUOTA > 0
+                if ((pParser->idAndType == U_SHORT_RANGE_EDM_TYPE_DATA_EVENT) &&
+                    (uShortRangePbufChannelBytes((int8_t) pParser->channel) >=
+                     U_SHORT_RANGE_EDM_CHANNEL_PBUF_QUOTA)) {
+                    // This channel is holding more than its share of
+                    // pbufs: drop the packet rather than stall everyone
+                    pParser->droppedCount++;
+                    newState = EDM_PARSER_STATE_DISCARD_PAYLOAD;
+                    if (pParser->payloadLength == 0) {
+                        newState = EDM_PARSER_STATE_PARSE_TAIL_BYTE;
+                    }
+                }
+#endif
             }
             charConsumed = true;
             break;
@@ -415,9 +445,9 @@ bool uShortRangeEdmParse(char c, uShortRangeEdmEvent_t **ppResultEvent, bool *pM
 
             // if allocation fails stay back until
             // we have some free memory in their respective pool
-            gCurPBufList = pUShortRangePbufListAlloc();
-            if (gCurPBufList != NULL) {
-                gCurPBufList->edmChannel = channel;
+            pParser->pCurPBufList = pUShortRangePbufListAlloc();
+            if (pParser->pCurPBufList != NULL) {
+                pParser->pCurPBufList->edmChannel = pParser->channel;
                 newState = EDM_PARSER_STATE_ALLOCATE_PAYLOAD;
             } else {
                 *pMemAvailable = false; // remain at same state, try again later
@@ -430,9 +460,11 @@ bool uShortRangeEdmParse(char c, uShortRangeEdmEvent_t **ppResultEvent, bool *pM
 
             // if allocation fails stay back until
             // we have some free memory in their respective pool
-            pBufSize = uShortRangePbufAlloc(&pBuf);
-            if (pBufSize > 0) {
-                headerIndex = 0;
+            // Ask for a pbuf big enough for the rest of the payload so
+            // that large packets are held in few pbufs
+            pParser->pBufSize = uShortRangePbufAllocSize(&pParser->pBuf, pParser->payloadLength);
+            if (pParser->pBufSize > 0) {
+                pParser->headerIndex = 0;
                 newState = EDM_PARSER_STATE_ACCUMULATE_PAYLOAD;
             } else {
                 *pMemAvailable = false; // remain at same state, try again later
@@ -443,25 +475,47 @@ bool uShortRangeEdmParse(char c, uShortRangeEdmEvent_t **ppResultEvent, bool *pM
 
         case EDM_PARSER_STATE_ACCUMULATE_PAYLOAD:
 
-            U_ASSERT(pBufSize > 0);
-            U_ASSERT(pBuf != NULL);
-            U_ASSERT(pBuf->length < pBufSize);
+            U_ASSERT(pParser->pBufSize > 0);
+            U_ASSERT(pParser->pBuf != NULL);
+            U_ASSERT(pParser->pBuf->length < pParser->pBufSize);
 
-            pBuf->data[pBuf->length++] = c;
-            payloadLength--;
+            pParser->pBuf->data[pParser->pBuf->length++] = c;
+            pParser->payloadLength--;
 
-            if ((pBuf->length == pBufSize) ||
-                (payloadLength == 0)) {
-                result = uShortRangePbufListAppend(gCurPBufList, pBuf);
+            if ((pParser->pBuf->length == pParser->pBufSize) ||
+                (pParser->payloadLength == 0)) {
+                result = uShortRangePbufListAppend(pParser->pCurPBufList, pParser->pBuf);
                 U_ASSERT(result == 0);
-                if (payloadLength == 0) {
+                if (pParser->payloadLength == 0) {
                     newState = EDM_PARSER_STATE_PARSE_TAIL_BYTE;
-                } else if (pBuf->length == pBufSize) {
+                } else if (pParser->pBuf->length == pParser->pBufSize) {
                     // we have some more data coming in
                     // so allocate memory for payload
                     newState = EDM_PARSER_STATE_ALLOCATE_PAYLOAD;
                 }
-                pBuf = NULL;
+                pParser->pBuf = NULL;
+            }
+            charConsumed = true;
+            break;
+
+        case EDM_PARSER_STATE_ACCUMULATE_AT_PAYLOAD:
+            // If the AT ring buffer is full stay here until
+            // the AT client has read some of it
+            if (uRingBufferAdd(pParser->pAtRingBuffer, &c, 1)) {
+                pParser->payloadLength--;
+                if (pParser->payloadLength == 0) {
+                    newState = EDM_PARSER_STATE_PARSE_TAIL_BYTE;
+                }
+                charConsumed = true;
+            } else {
+                *pMemAvailable = false;
+            }
+            break;
+
+        case EDM_PARSER_STATE_DISCARD_PAYLOAD:
+            pParser->payloadLength--;
+            if (pParser->payloadLength == 0) {
+                newState = EDM_PARSER_STATE_PARSE_TAIL_BYTE;
             }
             charConsumed = true;
             break;
@@ -470,7 +524,9 @@ bool uShortRangeEdmParse(char c, uShortRangeEdmEvent_t **ppResultEvent, bool *pM
             newState = EDM_PARSER_STATE_PARSE_START_BYTE;
             if (c == U_SHORT_RANGE_EDM_TAIL) {
                 if (ppResultEvent != NULL) {
-                    *ppResultEvent = parseEdmPayload(idAndType, channel, gCurPBufList);
+                    *ppResultEvent = parseEdmPayload(pParser, pParser->idAndType,
+                                                     pParser->channel,
+                                                     pParser->pCurPBufList);
                     if (*ppResultEvent == NULL) {
                         // No event was generated
                         // Reset parser
@@ -482,9 +538,9 @@ bool uShortRangeEdmParse(char c, uShortRangeEdmEvent_t **ppResultEvent, bool *pM
             }
             if (newState == EDM_PARSER_STATE_PARSE_START_BYTE) {
                 // Always de-allocate the buffer when we reset the parser
-                uShortRangePbufListFree(gCurPBufList);
+                uShortRangePbufListFree(pParser->pCurPBufList);
             }
-            gCurPBufList = NULL;
+            pParser->pCurPBufList = NULL;
             charConsumed = true;
             break;
 
@@ -496,11 +552,97 @@ bool uShortRangeEdmParse(char c, uShortRangeEdmEvent_t **ppResultEvent, bool *pM
             break;
     }
 
-    gEdmParserState = newState;
+    pParser->state = newState;
 
     return charConsumed;
 }
 
+size_t uShortRangeEdmParseSpan(uShortRangeEdmParser_t *pParser,
+                               const char *pData, size_t length,
+                               uShortRangeEdmEvent_t **ppResultEvent,
+                               bool *pMemAvailable)
+{
+    size_t consumed = 0;
+    size_t copyLength;
+    int32_t result;
+
+    *ppResultEvent = NULL;
+    *pMemAvailable = true;
+    while ((consumed < length) && (*ppResultEvent == NULL) && *pMemAvailable &&
+           uShortRangeEdmParserReady(pParser)) {
+        if ((pParser->state == EDM_PARSER_STATE_ACCUMULATE_PAYLOAD) &&
+            (pParser->payloadLength > 0)) {
+            // Bulk copy as much of the payload as the span and the
+            // current pbuf allow, rather than going character by character
+            copyLength = length - consumed;
+            if (copyLength > pParser->payloadLength) {
+                copyLength = pParser->payloadLength;
+            }
+            if (copyLength > (size_t) (pParser->pBufSize - pParser->pBuf->length)) {
+                copyLength = pParser->pBufSize - pParser->pBuf->length;
+            }
+            memcpy(pParser->pBuf->data + pParser->pBuf->length,
+                   pData + consumed, copyLength);
+            pParser->pBuf->length += (uint16_t) copyLength;
+            pParser->payloadLength -= (uint16_t) copyLength;
+            consumed += copyLength;
+            if ((pParser->pBuf->length == pParser->pBufSize) ||
+                (pParser->payloadLength == 0)) {
+                result = uShortRangePbufListAppend(pParser->pCurPBufList, pParser->pBuf);
+                U_ASSERT(result == 0);
+                (void) result;
+                if (pParser->payloadLength == 0) {
+                    pParser->state = EDM_PARSER_STATE_PARSE_TAIL_BYTE;
+                } else {
+                    pParser->state = EDM_PARSER_STATE_ALLOCATE_PAYLOAD;
+                }
+                pParser->pBuf = NULL;
+            }
+        } else if ((pParser->state == EDM_PARSER_STATE_ACCUMULATE_AT_PAYLOAD) &&
+                   (pParser->payloadLength > 0)) {
+            // Copy as much as will fit into the AT ring buffer
+            copyLength = length - consumed;
+            if (copyLength > pParser->payloadLength) {
+                copyLength = pParser->payloadLength;
+            }
+            if (copyLength > uRingBufferAvailableSize(pParser->pAtRingBuffer)) {
+                copyLength = uRingBufferAvailableSize(pParser->pAtRingBuffer);
+            }
+            if ((copyLength > 0) &&
+                uRingBufferAdd(pParser->pAtRingBuffer, pData + consumed, copyLength)) {
+                pParser->payloadLength -= (uint16_t) copyLength;
+                consumed += copyLength;
+                if (pParser->payloadLength == 0) {
+                    pParser->state = EDM_PARSER_STATE_PARSE_TAIL_BYTE;
+                }
+            } else {
+                *pMemAvailable = false;
+            }
+        } else if ((pParser->state == EDM_PARSER_STATE_DISCARD_PAYLOAD) &&
+                   (pParser->payloadLength > 0)) {
+            // Skip the lot
+            copyLength = length - consumed;
+            if (copyLength > pParser->payloadLength) {
+                copyLength = pParser->payloadLength;
+            }
+            pParser->payloadLength -= (uint16_t) copyLength;
+            consumed += copyLength;
+            if (pParser->payloadLength == 0) {
+                pParser->state = EDM_PARSER_STATE_PARSE_TAIL_BYTE;
+            }
+        } else {
+            // Header, tail or allocation: these are only a handful
+            // of characters per packet so just use the normal parser
+            if (uShortRangeEdmParse(pParser, pData[consumed],
+                                    ppResultEvent, pMemAvailable)) {
+                consumed++;
+            }
+        }
+    }
+
+    return consumed;
+}
+
 int32_t uShortRangeEdmZeroCopyHeadData(uint8_t channel, uint32_t size, char *pHead)
 {
     if (pHead == NULL || size > U_SHORT_RANGE_EDM_MAX_SIZE) {
@@ -21,6 +21,7 @@
  * of another module should be included here; otherwise
  * please keep #includes to your .c files. */
 #include "u_short_range.h"
+#include "u_ringbuffer.h"
 
 /** @file */
 
@@ -99,6 +100,53 @@ typedef struct {
     } params;
 } uShortRangeEdmEvent_t;
 
+/** The states of the EDM parser.
+ */
+typedef enum {
+    EDM_PARSER_STATE_PARSE_START_BYTE,
+    EDM_PARSER_STATE_PARSE_PAYLOAD_LENGTH,
+    EDM_PARSER_STATE_PARSE_HEADER_LENGTH,
+    EDM_PARSER_STATE_ALLOCATE_PBUFLIST,
+    EDM_PARSER_STATE_ALLOCATE_PAYLOAD,
+    EDM_PARSER_STATE_ACCUMULATE_PAYLOAD,
+    EDM_PARSER_STATE_ACCUMULATE_AT_PAYLOAD,
+    EDM_PARSER_STATE_DISCARD_PAYLOAD,
+    EDM_PARSER_STATE_PARSE_TAIL_BYTE,
+    EDM_PARSER_STATE_WAIT_FOR_EVENT_PROCESSING
+} uShortRangeEdmParserState_t;
+
+/** The context of an EDM parser: one is required for each EDM
+ * stream that is being parsed so that several streams may be
+ * parsed at the same time.  Must be zeroed before first use.
+ */
+typedef struct {
+    uShortRangeEdmParserState_t state;
+    uShortRangePbufList_t *pCurPBufList;
+    uShortRangePbuf_t *pBuf;
+    int32_t pBufSize;
+    uint16_t payloadLength;
+    char header[U_SHORT_RANGE_EDM_HEADER_SIZE];
+    uint32_t headerIndex;
+    uint16_t idAndType;
+    uint8_t channel;
+    uint32_t droppedCount;       /**< the number of data packets dropped
+                                      because their channel was over its
+                                      pbuf quota. */
+    uShortRangeEdmEvent_t event; /**< storage for the event returned
+                                      by uShortRangeEdmParse(), valid
+                                      until the parser is reset. */
+    uRingBuffer_t *pAtRingBuffer; /**< if not NULL, the payload of AT
+                                       responses and AT events is written
+                                       straight into this ring buffer,
+                                       rather than into pbufs, and the
+                                       AT event that is generated at the
+                                       end of the packet carries no pbuf
+                                       list; if the ring buffer is full
+                                       the parser stops, as if no memory
+                                       were available, until there is
+                                       room. */
+} uShortRangeEdmParser_t;
+
 /**
  *
  * @brief Check if EDM parser is available
@@ -106,16 +154,20 @@ typedef struct {
  * @note  Do not call the uShortRangeEdmParse function if this function
  *        returns false.
  *
+ * @param[in] pParser the parser.
+ *
  * @return True if EDM parser is available
  */
-bool uShortRangeEdmParserReady(void);
+bool uShortRangeEdmParserReady(const uShortRangeEdmParser_t *pParser);
 
 /**
  *
  * @brief Reset the parser. Do this every time the latest EDM event
  *        has been processed to make the parser available again.
+ *
+ * @param[in,out] pParser the parser.
  */
-void uShortRangeEdmResetParser(void);
+void uShortRangeEdmResetParser(uShortRangeEdmParser_t *pParser);
 
 /**
  *
@@ -123,7 +175,13 @@ void uShortRangeEdmResetParser(void);
  *
  * @note  Do not call this function if parser is not available,
  *        Check if parser is available with uShortRangeEdmParserAvailable
- *        If a packet is invalid it will be silently dropped.
+ *        If a packet is invalid it will be silently dropped.  A data
+ *        packet arriving on a channel that already holds
+ *        U_SHORT_RANGE_EDM_CHANNEL_PBUF_QUOTA bytes of pbuf is also dropped,
+ *        so that a channel whose data is not being consumed cannot
+ *        starve the others, including AT, of pbufs.
+ *
+ * @param[in,out] pParser the parser.
  *
  * @param c Input character.
  *
@@ -135,7 +193,37 @@ void uShortRangeEdmResetParser(void);
  *
  * @return True when input character c is consumed else false.
  */
-bool uShortRangeEdmParse(char c, uShortRangeEdmEvent_t **ppResultEvent, bool *pMemAvailable);
+bool uShortRangeEdmParse(uShortRangeEdmParser_t *pParser, char c,
+                         uShortRangeEdmEvent_t **ppResultEvent, bool *pMemAvailable);
+
+/**
+ *
+ * @brief Parse a span of binary EDM data; the same as calling
+ *        uShortRangeEdmParse() for each character but the payload
+ *        of a packet is copied into pbufs in one go rather than
+ *        character by character.
+ *
+ * @note  Parsing stops when an event is generated, when the parser
+ *        becomes unavailable or when no memory is available; the
+ *        caller should present the unconsumed characters again later.
+ *
+ * @param[in,out] pParser the parser.
+ *
+ * @param[in] pData Pointer to the input characters.
+ *
+ * @param length The number of characters at pData.
+ *
+ * @param[out] ppResultEvent Address of pointer to event, set to NULL if no
+ *             event was generated.
+ *
+ * @param[out] pMemAvailable Pointer to a boolean that indicates if memory was allocated successfully.
+ *
+ * @return The number of characters consumed from pData.
+ */
+size_t uShortRangeEdmParseSpan(uShortRangeEdmParser_t *pParser,
+                               const char *pData, size_t length,
+                               uShortRangeEdmEvent_t **ppResultEvent,
+                               bool *pMemAvailable);
 
 /**
  *
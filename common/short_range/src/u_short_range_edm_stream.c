@@ -41,11 +41,13 @@
 #include "u_port_debug.h"
 #include "u_at_client.h"
 #include "u_short_range_pbuf.h"
+#include "u_ringbuffer.h"
 #include "u_short_range_module_type.h"
 #include "u_short_range.h"
 #include "u_short_range_edm_stream.h"
 #include "u_short_range_edm.h"
-#include "string.h" // For memcpy()
+#include "u_log_ram_trace.h"
+#include "string.h" // For memcpy(), memset()
 
 // To enable anonymous unions inclusion for
 // ARM compiler
@@ -61,9 +63,28 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 #define U_SHORT_RANGE_EDM_STREAM_AT_COMMAND_LENGTH  200
-// TODO: is this value correct?
-#define U_SHORT_RANGE_EDM_STREAM_AT_RESPONSE_LENGTH 500
+#ifndef U_SHORT_RANGE_EDM_STREAM_AT_RESPONSE_LENGTH
+// The size of the ring buffer, allocated per stream, into which the
+// EDM parser writes the payload of AT responses and AT events for the
+// AT client to read; AT packets longer than this are passed through
+// it in pieces, the parser waiting for the AT client to make room.
+# define U_SHORT_RANGE_EDM_STREAM_AT_RESPONSE_LENGTH 512
+#endif
 #define U_SHORT_RANGE_EDM_STREAM_MAX_CONNECTIONS    9
+#ifndef U_SHORT_RANGE_EDM_STREAM_RX_BUFFER_LENGTH
+// The size of the ring buffer into which each stream reads from
+// its UART; the larger this is the fewer UART reads per EDM packet.
+# define U_SHORT_RANGE_EDM_STREAM_RX_BUFFER_LENGTH 512
+#endif
+
+#ifndef U_SHORT_RANGE_EDM_STREAM_TX_BUFFER_LENGTH
+// The size of the buffer, allocated per stream, in which the head,
+// data and tail of an EDM data packet are assembled so that they
+// go to the UART in one write; the default is such that a packet
+// of the IP MTU size needs only one write.
+# define U_SHORT_RANGE_EDM_STREAM_TX_BUFFER_LENGTH (U_SHORT_RANGE_EDM_MTU_IP_MAX_SIZE + \
+                                                    U_SHORT_RANGE_EDM_DATA_OVERHEAD)
+#endif
 
 #ifndef U_EDM_STREAM_TASK_STACK_SIZE_BYTES
 #define U_EDM_STREAM_TASK_STACK_SIZE_BYTES  U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES
@@ -150,7 +171,10 @@ typedef struct {
     uShortRangePbufList_t *pBufList;
 } uShortRangeEdmStreamDataEvent_t;
 
+struct uEdmStreamInstance_t;
+
 typedef struct {
+    struct uEdmStreamInstance_t *pEdmStream;
     uShortRangeEdmStreamEventType_t type;
     union {
         // no content in at event       at;
@@ -174,6 +198,7 @@ typedef struct {
 } uShortRangeEdmStreamConnections_t;
 
 typedef struct uEdmStreamInstance_t {
+    uPortMutexHandle_t mutex;
     bool ignoreUartCallback;
     int32_t handle;
     int32_t uartHandle;
@@ -195,18 +220,33 @@ typedef struct uEdmStreamInstance_t {
     void *pMqttDataCallbackParam;
     char *pAtCommandBuffer;
     int32_t atCommandCurrent;
-    char *pAtResponseBuffer;
-    int32_t atResponseLength;
-    int32_t atResponseRead;
+    char *pAtResponseBuffer; /**< Storage for atRingBuffer. */
+    uRingBuffer_t atRingBuffer; /**< Written by the EDM parser, read by
+                                     the AT client. */
+    volatile bool atEventPending; /**< True if an AT event has been queued
+                                       and not yet handled. */
+    char *pTxBuffer;
     uShortRangeEdmStreamConnections_t connections[U_SHORT_RANGE_EDM_STREAM_MAX_CONNECTIONS];
+    uShortRangeEdmParser_t parser;
+    char rxBuffer[U_SHORT_RANGE_EDM_STREAM_RX_BUFFER_LENGTH];
+    size_t rxBufferReadIndex;
+    size_t rxBufferCount;
 } uShortRangeEdmStreamInstance_t;
 
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
 
+/** Mutex protecting the allocation of entries in gEdmStream[];
+ * everything else about a stream is protected by the mutex of
+ * that stream.
+ */
 static uPortMutexHandle_t gMutex = NULL;
-static uShortRangeEdmStreamInstance_t gEdmStream;
+
+/** The stream instances, the handle of a stream being its index.
+ */
+static uShortRangeEdmStreamInstance_t gEdmStream[U_SHORT_RANGE_EDM_STREAM_MAX_NUM];
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -275,13 +315,14 @@ static const char *getProtocolText(uShortRangeIpProtocol_t protocol)
 #endif
 
 // Find connection from channel, use -1 to get the first free slot
-static uShortRangeEdmStreamConnections_t *findConnection(int32_t channel)
+static uShortRangeEdmStreamConnections_t *findConnection(uShortRangeEdmStreamInstance_t *pEdmStream,
+                                                         int32_t channel)
 {
     uShortRangeEdmStreamConnections_t *pConnection = NULL;
 
     for (uint32_t i = 0; i < U_SHORT_RANGE_EDM_STREAM_MAX_CONNECTIONS; i++) {
-        if (gEdmStream.connections[i].channel == channel) {
-            pConnection = &gEdmStream.connections[i];
+        if (pEdmStream->connections[i].channel == channel) {
+            pConnection = &pEdmStream->connections[i];
             break;
         }
     }
@@ -289,101 +330,130 @@ static uShortRangeEdmStreamConnections_t *findConnection(int32_t channel)
     return pConnection;
 }
 
-static void processedEvent(void)
+// Trigger an event from the uart to get parsing going again.
+static void kickParser(const uShortRangeEdmStreamInstance_t *pEdmStream)
 {
     int32_t sendErrorCode;
 
-    uShortRangeEdmResetParser();
-    // Trigger an event from the uart to get parsing going again
     // First use the "try" version so as not to block, which can
     // lead to mutex lock-outs if the queue is full: if the "try"
     // version is not supported on this platform then fall back
     // to the blocking version; there is no danger here since,
     // if there are already events in the UART queue, the URC
     // callback will certainly be run anyway.
-    sendErrorCode = uPortUartEventTrySend(gEdmStream.uartHandle,
+    sendErrorCode = uPortUartEventTrySend(pEdmStream->uartHandle,
                                           U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
                                           0);
     if ((sendErrorCode == (int32_t) U_ERROR_COMMON_NOT_IMPLEMENTED) ||
         (sendErrorCode == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED)) {
-        uPortUartEventSend(gEdmStream.uartHandle,
+        uPortUartEventSend(pEdmStream->uartHandle,
                            U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED);
     }
 }
 
-static void atEventHandler(void)
+static void processedEvent(uShortRangeEdmStreamInstance_t *pEdmStream)
 {
-    if (gEdmStream.pAtCallback != NULL) {
-        gEdmStream.pAtCallback(gEdmStream.handle,
-                               U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
-                               gEdmStream.pAtCallbackParam);
+    uShortRangeEdmResetParser(&(pEdmStream->parser));
+    kickParser(pEdmStream);
+}
+
+// Queue an event to tell the AT client that there is data in the
+// AT ring buffer, unless one is already queued: stream mutex must
+// be locked.
+static void atNotify(uShortRangeEdmStreamInstance_t *pEdmStream)
+{
+    uShortRangeEdmStreamEvent_t event;
+
+    if (!pEdmStream->atEventPending) {
+        event.pEdmStream = pEdmStream;
+        event.type = U_SHORT_RANGE_EDM_STREAM_EVENT_AT;
+        pEdmStream->atEventPending = true;
+        if (uPortEventQueueSend(pEdmStream->eventQueueHandle,
+                                &event, sizeof(uShortRangeEdmStreamEvent_t)) != 0) {
+            pEdmStream->atEventPending = false;
+            uPortLog("U_SHO_EDM_STREAM: Failed to enqueue message\n");
+        }
+    }
+}
+
+static void atEventHandler(uShortRangeEdmStreamInstance_t *pEdmStream)
+{
+    // Cleared first so that AT data arriving while the callback
+    // is running queues another event
+    pEdmStream->atEventPending = false;
+    if (pEdmStream->pAtCallback != NULL) {
+        pEdmStream->pAtCallback(pEdmStream->handle,
+                                U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                pEdmStream->pAtCallbackParam);
     }
-    // This event is not fully processed until uShortRangeEdmStreamAtRead has been called
-    // and all event data been read out
 }
 
 // Event handler, calls the user's event callback.
-static void btEventHandler(uShortRangeEdmStreamBtEvent_t *pBtEvent)
+static void btEventHandler(uShortRangeEdmStreamInstance_t *pEdmStream,
+                           uShortRangeEdmStreamBtEvent_t *pBtEvent)
 {
-    if (gEdmStream.pBtEventCallback != NULL) {
-        gEdmStream.pBtEventCallback(gEdmStream.handle, pBtEvent->channel, pBtEvent->type,
-                                    &pBtEvent->conData, gEdmStream.pBtEventCallbackParam);
+    if (pEdmStream->pBtEventCallback != NULL) {
+        pEdmStream->pBtEventCallback(pEdmStream->handle, pBtEvent->channel, pBtEvent->type,
+                                     &pBtEvent->conData, pEdmStream->pBtEventCallbackParam);
     }
     uEdmChLogLine(LOG_CH_BT, "processed");
-    processedEvent();
+    processedEvent(pEdmStream);
 }
 
 // Event handler, calls the user's event callback.
-static void ipEventHandler(uShortRangeEdmStreamIpEvent_t *pIpEvent)
+static void ipEventHandler(uShortRangeEdmStreamInstance_t *pEdmStream,
+                           uShortRangeEdmStreamIpEvent_t *pIpEvent)
 {
-    if (gEdmStream.pIpEventCallback != NULL) {
-        gEdmStream.pIpEventCallback(gEdmStream.handle, pIpEvent->channel, pIpEvent->type,
-                                    &pIpEvent->conData, gEdmStream.pIpEventCallbackParam);
+    if (pEdmStream->pIpEventCallback != NULL) {
+        pEdmStream->pIpEventCallback(pEdmStream->handle, pIpEvent->channel, pIpEvent->type,
+                                     &pIpEvent->conData, pEdmStream->pIpEventCallbackParam);
     }
 
     uEdmChLogLine(LOG_CH_IP, "processed");
-    processedEvent();
+    processedEvent(pEdmStream);
 }
 
 // Event handler, calls the user's event callback.
-static void mqttEventHandler(uShortRangeEdmStreamIpEvent_t *pMqttEvent)
+static void mqttEventHandler(uShortRangeEdmStreamInstance_t *pEdmStream,
+                             uShortRangeEdmStreamIpEvent_t *pMqttEvent)
 {
-    if (gEdmStream.pMqttEventCallback != NULL) {
-        gEdmStream.pMqttEventCallback(gEdmStream.handle, pMqttEvent->channel, pMqttEvent->type,
-                                      &pMqttEvent->conData, gEdmStream.pMqttEventCallbackParam);
+    if (pEdmStream->pMqttEventCallback != NULL) {
+        pEdmStream->pMqttEventCallback(pEdmStream->handle, pMqttEvent->channel, pMqttEvent->type,
+                                       &pMqttEvent->conData, pEdmStream->pMqttEventCallbackParam);
     }
     uEdmChLogLine(LOG_CH_IP, "processed");
-    processedEvent();
+    processedEvent(pEdmStream);
 }
 
-static void dataEventHandler(uShortRangeEdmStreamDataEvent_t *pDataEvent)
+static void dataEventHandler(uShortRangeEdmStreamInstance_t *pEdmStream,
+                             uShortRangeEdmStreamDataEvent_t *pDataEvent)
 {
     uShortRangeEdmStreamConnections_t *pConnection;
     volatile uEdmDataEventCallback_t pDataCallback = NULL;
     volatile void *pCallbackParam = NULL;
     volatile int32_t edmStreamHandle = -1;
 
-    uPortMutexLock(gMutex);
-    pConnection = findConnection(pDataEvent->channel);
+    uPortMutexLock(pEdmStream->mutex);
+    pConnection = findConnection(pEdmStream, pDataEvent->channel);
 
     if (pConnection != NULL) {
-        edmStreamHandle = gEdmStream.handle;
+        edmStreamHandle = pEdmStream->handle;
 
         switch (pConnection->type) {
 
             case U_SHORT_RANGE_CONNECTION_TYPE_BT:
-                pDataCallback = gEdmStream.pBtDataCallback;
-                pCallbackParam = gEdmStream.pBtDataCallbackParam;
+                pDataCallback = pEdmStream->pBtDataCallback;
+                pCallbackParam = pEdmStream->pBtDataCallbackParam;
                 break;
 
             case U_SHORT_RANGE_CONNECTION_TYPE_IP:
-                pDataCallback = gEdmStream.pIpDataCallback;
-                pCallbackParam = gEdmStream.pIpDataCallbackParam;
+                pDataCallback = pEdmStream->pIpDataCallback;
+                pCallbackParam = pEdmStream->pIpDataCallbackParam;
                 break;
 
             case U_SHORT_RANGE_CONNECTION_TYPE_MQTT:
-                pDataCallback = gEdmStream.pMqttDataCallback;
-                pCallbackParam = gEdmStream.pMqttDataCallbackParam;
+                pDataCallback = pEdmStream->pMqttDataCallback;
+                pCallbackParam = pEdmStream->pMqttDataCallbackParam;
                 break;
 
             case U_SHORT_RANGE_CONNECTION_TYPE_INVALID:
@@ -395,16 +465,16 @@ static void dataEventHandler(uShortRangeEdmStreamDataEvent_t *pDataEvent)
     if (pDataCallback != NULL) {
         // Make sure we release the lock before calling the callback
         // otherwise this may result in a deadlock
-        uPortMutexUnlock(gMutex);
+        uPortMutexUnlock(pEdmStream->mutex);
         //lint -e(1773) Suppress "attempt to cast away const"
         pDataCallback(edmStreamHandle, pDataEvent->channel, pDataEvent->pBufList,
                       (void *)pCallbackParam);
-        uPortMutexLock(gMutex);
+        uPortMutexLock(pEdmStream->mutex);
     }
 
     uEdmChLogLine(LOG_CH_DATA, "processed");
-    processedEvent();
-    uPortMutexUnlock(gMutex);
+    processedEvent(pEdmStream);
+    uPortMutexUnlock(pEdmStream->mutex);
 }
 
 static void eventHandler(void *pParam, size_t paramLength)
@@ -419,23 +489,23 @@ static void eventHandler(void *pParam, size_t paramLength)
     switch (pEvent->type) {
 
         case U_SHORT_RANGE_EDM_STREAM_EVENT_AT:
-            atEventHandler();
+            atEventHandler(pEvent->pEdmStream);
             break;
 
         case U_SHORT_RANGE_EDM_STREAM_EVENT_BT:
-            btEventHandler(&(pEvent->bt));
+            btEventHandler(pEvent->pEdmStream, &(pEvent->bt));
             break;
 
         case U_SHORT_RANGE_EDM_STREAM_EVENT_IP:
-            ipEventHandler(&(pEvent->ip));
+            ipEventHandler(pEvent->pEdmStream, &(pEvent->ip));
             break;
 
         case U_SHORT_RANGE_EDM_STREAM_EVENT_MQTT:
-            mqttEventHandler(&(pEvent->mqtt));
+            mqttEventHandler(pEvent->pEdmStream, &(pEvent->mqtt));
             break;
 
         case U_SHORT_RANGE_EDM_STREAM_EVENT_DATA:
-            dataEventHandler(&(pEvent->data));
+            dataEventHandler(pEvent->pEdmStream, &(pEvent->data));
             break;
 
         default:
@@ -443,47 +513,34 @@ static void eventHandler(void *pParam, size_t paramLength)
     }
 }
 
-static bool enqueueEdmAtEvent(uShortRangeEdmEvent_t *pEvent)
+static bool enqueueEdmAtEvent(uShortRangeEdmStreamInstance_t *pEdmStream,
+                              uShortRangeEdmEvent_t *pEvent)
 {
-    bool success = false;
-    uShortRangeEdmStreamEvent_t event;
-
-    uShortRangePbufList_t *pBufList = pEvent->params.atEvent.pBufList;
-    gEdmStream.atResponseLength = (int32_t)pBufList->totalLen;
-    gEdmStream.atResponseRead = 0;
-    uShortRangePbufListConsumeData(pBufList, gEdmStream.pAtResponseBuffer,
-                                   gEdmStream.atResponseLength);
-    uShortRangePbufListFree(pBufList);
-
-#ifdef U_CFG_SHORT_RANGE_EDM_STREAM_DEBUG
-    uEdmChLogStart(LOG_CH_AT_RX, "\"");
-    dumpAtData(gEdmStream.pAtResponseBuffer, gEdmStream.atResponseLength);
-    uEdmChLogEnd("\"");
-#endif
-
-    event.type = U_SHORT_RANGE_EDM_STREAM_EVENT_AT;
-    if (uPortEventQueueSend(gEdmStream.eventQueueHandle,
-                            &event, sizeof(uShortRangeEdmStreamEvent_t)) == 0) {
-        success = true;
-    } else {
-        uPortLog("U_SHO_EDM_STREAM: Failed to enqueue message\n");
-    }
-
-    return success;
+    // The parser has already written the AT payload into the AT
+    // ring buffer, so there is nothing to wait for: make the parser
+    // available again straight away, without a trip around the
+    // UART event queue, and let the AT client know there's data
+    (void) pEvent;
+    uShortRangeEdmResetParser(&(pEdmStream->parser));
+    atNotify(pEdmStream);
+
+    return true;
 }
 
-static bool enqueueEdmConnectBtEvent(uShortRangeEdmEvent_t *pEvent)
+static bool enqueueEdmConnectBtEvent(uShortRangeEdmStreamInstance_t *pEdmStream,
+                                     uShortRangeEdmEvent_t *pEvent)
 {
     bool success = false;
 
     uShortRangeEdmStreamConnections_t *pConnection =
-        findConnection(pEvent->params.btConnectEvent.channel);
+        findConnection(pEdmStream, pEvent->params.btConnectEvent.channel);
 
     if (pConnection == NULL) {
-        pConnection = findConnection(-1);
+        pConnection = findConnection(pEdmStream, -1);
     }
     if (pConnection != NULL) {
         uShortRangeEdmStreamEvent_t event;
+        event.pEdmStream = pEdmStream;
         pConnection->channel = pEvent->params.btConnectEvent.channel;
         pConnection->type = U_SHORT_RANGE_CONNECTION_TYPE_BT;
         pConnection->bt.frameSize = pEvent->params.btConnectEvent.connection.framesize;
@@ -499,7 +556,7 @@ static bool enqueueEdmConnectBtEvent(uShortRangeEdmEvent_t *pEvent)
         uEdmChLogEnd("");
 #endif
 
-        if (uPortEventQueueSend(gEdmStream.eventQueueHandle,
+        if (uPortEventQueueSend(pEdmStream->eventQueueHandle,
                                 &event, sizeof(uShortRangeEdmStreamEvent_t)) == 0) {
             success = true;
         } else {
@@ -510,18 +567,20 @@ static bool enqueueEdmConnectBtEvent(uShortRangeEdmEvent_t *pEvent)
     return success;
 }
 
-static bool enqueueEdmConnectIpv4Event(uShortRangeEdmEvent_t *pEvent)
+static bool enqueueEdmConnectIpv4Event(uShortRangeEdmStreamInstance_t *pEdmStream,
+                                       uShortRangeEdmEvent_t *pEvent)
 {
     bool success = false;
 
     uShortRangeEdmStreamConnections_t *pConnection =
-        findConnection(pEvent->params.ipv4ConnectEvent.channel);
+        findConnection(pEdmStream, pEvent->params.ipv4ConnectEvent.channel);
 
     if (pConnection == NULL) {
-        pConnection = findConnection(-1);
+        pConnection = findConnection(pEdmStream, -1);
     }
     if (pConnection != NULL) {
         uShortRangeEdmStreamEvent_t event;
+        event.pEdmStream = pEdmStream;
         uShortRangeEdmConnectionEventIpv4_t *ipv4Evt = &pEvent->params.ipv4ConnectEvent;
         uShortRangeIpProtocol_t protocol = ipv4Evt->connection.protocol;
         // IPv4 events are generated by TCP, UDP and MQTT connections
@@ -559,7 +618,7 @@ static bool enqueueEdmConnectIpv4Event(uShortRangeEdmEvent_t *pEvent)
                           rIp[0], rIp[1], rIp[2], rIp[3], rPort);
 #endif
 
-            if (uPortEventQueueSend(gEdmStream.eventQueueHandle,
+            if (uPortEventQueueSend(pEdmStream->eventQueueHandle,
                                     &event, sizeof(uShortRangeEdmStreamEvent_t)) == 0) {
                 success = true;
             } else {
@@ -571,18 +630,20 @@ static bool enqueueEdmConnectIpv4Event(uShortRangeEdmEvent_t *pEvent)
     return success;
 }
 
-static bool enqueueEdmConnectIpv6Event(uShortRangeEdmEvent_t *pEvent)
+static bool enqueueEdmConnectIpv6Event(uShortRangeEdmStreamInstance_t *pEdmStream,
+                                       uShortRangeEdmEvent_t *pEvent)
 {
     bool success = false;
 
     uShortRangeEdmStreamConnections_t *pConnection =
-        findConnection(pEvent->params.ipv6ConnectEvent.channel);
+        findConnection(pEdmStream, pEvent->params.ipv6ConnectEvent.channel);
 
     if (pConnection == NULL) {
-        pConnection = findConnection(-1);
+        pConnection = findConnection(pEdmStream, -1);
     }
     if (pConnection != NULL) {
         uShortRangeEdmStreamEvent_t event;
+        event.pEdmStream = pEdmStream;
         uShortRangeEdmConnectionEventIpv6_t *ipv6Evt = &pEvent->params.ipv6ConnectEvent;
         uShortRangeIpProtocol_t protocol = ipv6Evt->connection.protocol;
         // IPv4 events are generated by TCP, UDP and MQTT connections
@@ -615,7 +676,7 @@ static bool enqueueEdmConnectIpv6Event(uShortRangeEdmEvent_t *pEvent)
                           event.ip.channel, protocolTxt, lPort, rPort);
 #endif
 
-            if (uPortEventQueueSend(gEdmStream.eventQueueHandle,
+            if (uPortEventQueueSend(pEdmStream->eventQueueHandle,
                                     &event, sizeof(uShortRangeEdmStreamEvent_t)) == 0) {
                 success = true;
             } else {
@@ -627,15 +688,17 @@ static bool enqueueEdmConnectIpv6Event(uShortRangeEdmEvent_t *pEvent)
     return success;
 }
 
-static bool enqueueEdmDisconnectEvent(uShortRangeEdmEvent_t *pEvent)
+static bool enqueueEdmDisconnectEvent(uShortRangeEdmStreamInstance_t *pEdmStream,
+                                      uShortRangeEdmEvent_t *pEvent)
 {
     bool success = false;
 
     uint8_t channel = pEvent->params.disconnectEvent.channel;
-    uShortRangeEdmStreamConnections_t *pConnection = findConnection(channel);
+    uShortRangeEdmStreamConnections_t *pConnection = findConnection(pEdmStream, channel);
 
     if (pConnection != NULL) {
         uShortRangeEdmStreamEvent_t event;
+        event.pEdmStream = pEdmStream;
         switch (pConnection->type) {
             case U_SHORT_RANGE_CONNECTION_TYPE_BT:
                 event.type = U_SHORT_RANGE_EDM_STREAM_EVENT_BT;
@@ -644,7 +707,7 @@ static bool enqueueEdmDisconnectEvent(uShortRangeEdmEvent_t *pEvent)
 #ifdef U_CFG_SHORT_RANGE_EDM_STREAM_DEBUG
                 uEdmChLogLine(LOG_CH_BT, "ch: %d, disconnect", channel);
 #endif
-                if (uPortEventQueueSend(gEdmStream.eventQueueHandle,
+                if (uPortEventQueueSend(pEdmStream->eventQueueHandle,
                                         &event, sizeof(uShortRangeEdmStreamEvent_t)) == 0) {
                     success = true;
                 } else {
@@ -659,7 +722,7 @@ static bool enqueueEdmDisconnectEvent(uShortRangeEdmEvent_t *pEvent)
 #ifdef U_CFG_SHORT_RANGE_EDM_STREAM_DEBUG
                 uEdmChLogLine(LOG_CH_IP, "ch: %d, disconnect", channel);
 #endif
-                if (uPortEventQueueSend(gEdmStream.eventQueueHandle,
+                if (uPortEventQueueSend(pEdmStream->eventQueueHandle,
                                         &event, sizeof(uShortRangeEdmStreamEvent_t)) == 0) {
                     success = true;
                 } else {
@@ -674,7 +737,7 @@ static bool enqueueEdmDisconnectEvent(uShortRangeEdmEvent_t *pEvent)
 #ifdef U_CFG_SHORT_RANGE_EDM_STREAM_DEBUG
                 uEdmChLogLine(LOG_CH_IP, "ch: %d, disconnect", channel);
 #endif
-                if (uPortEventQueueSend(gEdmStream.eventQueueHandle,
+                if (uPortEventQueueSend(pEdmStream->eventQueueHandle,
                                         &event, sizeof(uShortRangeEdmStreamEvent_t)) == 0) {
                     success = true;
                 } else {
@@ -692,11 +755,13 @@ static bool enqueueEdmDisconnectEvent(uShortRangeEdmEvent_t *pEvent)
     return success;
 }
 
-static bool enqueueEdmDataEvent(uShortRangeEdmEvent_t *pEvent)
+static bool enqueueEdmDataEvent(uShortRangeEdmStreamInstance_t *pEdmStream,
+                                uShortRangeEdmEvent_t *pEvent)
 {
     bool success = false;
 
     uShortRangeEdmStreamEvent_t event;
+    event.pEdmStream = pEdmStream;
     event.type = U_SHORT_RANGE_EDM_STREAM_EVENT_DATA;
     event.data.channel = pEvent->params.dataEvent.channel;
     event.data.pBufList = pEvent->params.dataEvent.pBufList;
@@ -713,7 +778,7 @@ static bool enqueueEdmDataEvent(uShortRangeEdmEvent_t *pEvent)
 # endif
 #endif
     }
-    if (uPortEventQueueSend(gEdmStream.eventQueueHandle,
+    if (uPortEventQueueSend(pEdmStream->eventQueueHandle,
                             &event, sizeof(uShortRangeEdmStreamEvent_t)) == 0) {
         success = true;
     } else {
@@ -723,34 +788,37 @@ static bool enqueueEdmDataEvent(uShortRangeEdmEvent_t *pEvent)
     return success;
 }
 
-static void processEdmEvent(uShortRangeEdmEvent_t *pEvent)
+static void processEdmEvent(uShortRangeEdmStreamInstance_t *pEdmStream,
+                            uShortRangeEdmEvent_t *pEvent)
 {
     bool enqueued = false;
 
+    U_LOG_RAM_TRACE_INSTANT(EDM_STREAM, EDM_EVENT, pEvent->type);
+
     switch (pEvent->type) {
 
         case U_SHORT_RANGE_EDM_EVENT_AT:
-            enqueued = enqueueEdmAtEvent(pEvent);
+            enqueued = enqueueEdmAtEvent(pEdmStream, pEvent);
             break;
 
         case U_SHORT_RANGE_EDM_EVENT_CONNECT_BT:
-            enqueued = enqueueEdmConnectBtEvent(pEvent);
+            enqueued = enqueueEdmConnectBtEvent(pEdmStream, pEvent);
             break;
 
         case U_SHORT_RANGE_EDM_EVENT_DISCONNECT:
-            enqueued = enqueueEdmDisconnectEvent(pEvent);
+            enqueued = enqueueEdmDisconnectEvent(pEdmStream, pEvent);
             break;
 
         case U_SHORT_RANGE_EDM_EVENT_DATA:
-            enqueued = enqueueEdmDataEvent(pEvent);
+            enqueued = enqueueEdmDataEvent(pEdmStream, pEvent);
             break;
 
         case U_SHORT_RANGE_EDM_EVENT_CONNECT_IPv4:
-            enqueued = enqueueEdmConnectIpv4Event(pEvent);
+            enqueued = enqueueEdmConnectIpv4Event(pEdmStream, pEvent);
             break;
 
         case U_SHORT_RANGE_EDM_EVENT_CONNECT_IPv6:
-            enqueued = enqueueEdmConnectIpv6Event(pEvent);
+            enqueued = enqueueEdmConnectIpv6Event(pEdmStream, pEvent);
             break;
 
         case U_SHORT_RANGE_EDM_EVENT_INVALID: /* Intentional fallthrough */
@@ -762,70 +830,94 @@ static void processEdmEvent(uShortRangeEdmEvent_t *pEvent)
 
     if (!enqueued) {
         /* No event was enqueued to the event queue so we simply consume the event */
-        processedEvent();
+        processedEvent(pEdmStream);
     }
 }
 
 static void uartCallback(int32_t uartHandle, uint32_t eventBitmask,
                          void *pParameters)
 {
-    (void)pParameters;
+    uShortRangeEdmStreamInstance_t *pEdmStream = (uShortRangeEdmStreamInstance_t *) pParameters;
     bool memAvailable = true;
 
-    if ((gEdmStream.uartHandle == uartHandle) &&
-        !gEdmStream.ignoreUartCallback &&
+    if ((pEdmStream != NULL) && (pEdmStream->uartHandle == uartHandle) &&
+        !pEdmStream->ignoreUartCallback &&
         (eventBitmask == U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED)) {
         bool uartEmpty = false;
         // We don't want to read one character at the time from the uart driver since that will be
-        // quite an overhead when pumping a lot of data. Instead we read into a buffer
-        // and then comsume characters from that. But we might not consume all read characters
-        // before an EDM-event is generated by the parser which makes the parser unavailable
-        // and we have to leave this callback. When the parser later is available this
-        // uart-event will be placed on the queue again so that we come back here.
-        // We thus need a static buffer, and if there are unparsed characters left in it we move
-        // them to the beginning of the buffer befor leaving (instead of using a ring buffer).
-        U_PORT_MUTEX_LOCK(gMutex);
-        while (!uartEmpty && uShortRangeEdmParserReady() && memAvailable) {
+        // quite an overhead when pumping a lot of data. Instead we read into a ring buffer
+        // and hand contiguous spans of it to the parser, which copies EDM payload into pbufs
+        // in bulk. But we might not consume all read characters before an EDM-event is
+        // generated by the parser which makes the parser unavailable and we have to leave
+        // this callback. When the parser later is available this uart-event will be placed
+        // on the queue again so that we come back here and carry on from where we left off.
+        U_PORT_MUTEX_LOCK(pEdmStream->mutex);
+        U_LOG_RAM_TRACE_BEGIN(EDM_STREAM, EDM_RX, pEdmStream->rxBufferCount);
+        while (!uartEmpty && uShortRangeEdmParserReady(&(pEdmStream->parser)) && memAvailable) {
             // Loop until we couldn't read any more characters from uart
             // or EDM parser is unavailable
             // or no pbuf memory is available
-            static char buffer[128];
-            static size_t charsInBuffer = 0;
-            size_t consumed = 0;
-
-            // Check if there are any existing characters in the buffer and parse them
-            while (uShortRangeEdmParserReady() && (consumed < charsInBuffer) && memAvailable) {
-                //lint -esym(727, buffer)
+            char *buffer = pEdmStream->rxBuffer;
+            size_t readIndex = pEdmStream->rxBufferReadIndex;
+            size_t charsInBuffer = pEdmStream->rxBufferCount;
+            size_t writeIndex;
+            size_t length;
+
+            // Parse any existing characters in the buffer, a
+            // contiguous span at a time
+            while (uShortRangeEdmParserReady(&(pEdmStream->parser)) &&
+                   (charsInBuffer > 0) && memAvailable) {
                 uShortRangeEdmEvent_t *pEvent = NULL;
+                length = charsInBuffer;
+                if (readIndex + length > sizeof(pEdmStream->rxBuffer)) {
+                    length = sizeof(pEdmStream->rxBuffer) - readIndex;
+                }
                 // when there is no memory available in the pool to intake
-                // the data, this call would return false.In such
-                // cases hardware flow control will be triggered if
+                // the data, this call would return with memAvailable false.
+                // In such cases hardware flow control will be triggered if
                 // UART H/W Rx FIFO is full.
-                if (uShortRangeEdmParse(buffer[consumed], &pEvent, &memAvailable)) {
-                    consumed++;
-                }
+                length = uShortRangeEdmParseSpan(&(pEdmStream->parser), buffer + readIndex,
+                                                 length, &pEvent, &memAvailable);
+                readIndex = (readIndex + length) % sizeof(pEdmStream->rxBuffer);
+                charsInBuffer -= length;
                 if (pEvent != NULL) {
-                    processEdmEvent(pEvent);
+                    processEdmEvent(pEdmStream, pEvent);
+                }
+                if (!memAvailable &&
+                    (pEdmStream->parser.state == EDM_PARSER_STATE_ACCUMULATE_AT_PAYLOAD)) {
+                    // The AT ring buffer is full part way through a
+                    // packet: make sure the AT client comes to read it;
+                    // uShortRangeEdmStreamAtRead() will get us going again
+                    atNotify(pEdmStream);
                 }
             }
-            // Move unparsed data to beginning of buffer
-            if ((consumed > 0) && (charsInBuffer - consumed) > 0) {
-                memmove(buffer, buffer + consumed, charsInBuffer - consumed);
+            if (charsInBuffer == 0) {
+                // Start from the beginning again to keep reads large
+                readIndex = 0;
             }
-            charsInBuffer -= consumed;
 
-            // Read as much as possible from uart into rest of buffer
-            if (charsInBuffer < sizeof buffer) {
-                int32_t sizeOrError = uPortUartRead(gEdmStream.uartHandle, buffer + charsInBuffer,
-                                                    sizeof buffer - charsInBuffer);
+            // Read as much as possible from uart into the free
+            // contiguous space of the buffer
+            if (charsInBuffer < sizeof(pEdmStream->rxBuffer)) {
+                writeIndex = (readIndex + charsInBuffer) % sizeof(pEdmStream->rxBuffer);
+                if (writeIndex >= readIndex) {
+                    length = sizeof(pEdmStream->rxBuffer) - writeIndex;
+                } else {
+                    length = readIndex - writeIndex;
+                }
+                int32_t sizeOrError = uPortUartRead(pEdmStream->uartHandle,
+                                                    buffer + writeIndex, length);
                 if (sizeOrError > 0) {
                     charsInBuffer += sizeOrError;
                 } else {
                     uartEmpty = true;
                 }
             }
+            pEdmStream->rxBufferReadIndex = readIndex;
+            pEdmStream->rxBufferCount = charsInBuffer;
         }
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        U_LOG_RAM_TRACE_END(EDM_STREAM, EDM_RX, pEdmStream->rxBufferCount);
+        U_PORT_MUTEX_UNLOCK(pEdmStream->mutex);
     }
 }
 
@@ -840,12 +932,51 @@ static void flushUart(int32_t uartHandle)
     }
 }
 
-static int32_t uartWrite(const void *pData, size_t length)
+static int32_t uartWrite(const uShortRangeEdmStreamInstance_t *pEdmStream,
+                         const void *pData, size_t length)
 {
-    return uPortUartWrite(gEdmStream.uartHandle,
+    return uPortUartWrite(pEdmStream->uartHandle,
                           pData, length);
 }
 
+// Write data for an EDM data packet through the transmit buffer
+// of a stream, pTxCount being the number of bytes already in the
+// buffer.  The buffer is written to the UART when it is full or
+// when flush is true, whole buffer's worths of data being written
+// directly from pData; returns the number of bytes written to
+// the UART.
+static int32_t txWrite(const uShortRangeEdmStreamInstance_t *pEdmStream,
+                       const char *pData, size_t length,
+                       size_t *pTxCount, bool flush)
+{
+    int32_t written = 0;
+    size_t x;
+
+    while ((length > 0) || (flush && (*pTxCount > 0))) {
+        if ((*pTxCount == 0) && (length >= U_SHORT_RANGE_EDM_STREAM_TX_BUFFER_LENGTH)) {
+            // No point in copying
+            x = length - (length % U_SHORT_RANGE_EDM_STREAM_TX_BUFFER_LENGTH);
+            written += uartWrite(pEdmStream, pData, x);
+        } else {
+            x = U_SHORT_RANGE_EDM_STREAM_TX_BUFFER_LENGTH - *pTxCount;
+            if (x > length) {
+                x = length;
+            }
+            memcpy(pEdmStream->pTxBuffer + *pTxCount, pData, x);
+            *pTxCount += x;
+            if ((*pTxCount == U_SHORT_RANGE_EDM_STREAM_TX_BUFFER_LENGTH) ||
+                (flush && (x == length))) {
+                written += uartWrite(pEdmStream, pEdmStream->pTxBuffer, *pTxCount);
+                *pTxCount = 0;
+            }
+        }
+        pData += x;
+        length -= x;
+    }
+
+    return written;
+}
+
 // Do an EDM send.  Returns the amount written, including
 // EDM packet overhead.
 static int32_t edmSend(const uShortRangeEdmStreamInstance_t *pEdmStream)
@@ -867,7 +998,7 @@ static int32_t edmSend(const uShortRangeEdmStreamInstance_t *pEdmStream)
             uEdmChLogEnd("\"");
 #endif
             while (written < (uint32_t) sizeOrError) {
-                written += uartWrite((void *) (pPacket + written),
+                written += uartWrite(pEdmStream, (void *) (pPacket + written),
                                      (uint32_t) sizeOrError - written);
             }
         }
@@ -885,38 +1016,38 @@ static const char *pInterceptTx(uAtClientHandle_t atHandle,
                                 size_t *pLength,
                                 void *pContext)
 {
+    uShortRangeEdmStreamInstance_t *pEdmStream = (uShortRangeEdmStreamInstance_t *) pContext;
     int32_t x = 0;
 
-    (void) pContext;
     (void) atHandle;
 
     if ((*pLength != 0) || (ppData == NULL)) {
         if (ppData == NULL) {
             // We're being flushed, create and send EDM packet
-            edmSend(&gEdmStream);
+            edmSend(pEdmStream);
             // Reset buffer
-            gEdmStream.atCommandCurrent = 0;
+            pEdmStream->atCommandCurrent = 0;
         } else {
             // Send any whole buffer's worths we have
-            while ((*pLength + gEdmStream.atCommandCurrent > U_SHORT_RANGE_EDM_STREAM_AT_COMMAND_LENGTH) &&
+            while ((*pLength + pEdmStream->atCommandCurrent > U_SHORT_RANGE_EDM_STREAM_AT_COMMAND_LENGTH) &&
                    (x >= 0)) {
-                x = U_SHORT_RANGE_EDM_STREAM_AT_COMMAND_LENGTH - gEdmStream.atCommandCurrent;
-                memcpy(gEdmStream.pAtCommandBuffer + gEdmStream.atCommandCurrent, *ppData, x);
+                x = U_SHORT_RANGE_EDM_STREAM_AT_COMMAND_LENGTH - pEdmStream->atCommandCurrent;
+                memcpy(pEdmStream->pAtCommandBuffer + pEdmStream->atCommandCurrent, *ppData, x);
                 *pLength -= x;
                 *ppData += x;
-                gEdmStream.atCommandCurrent = U_SHORT_RANGE_EDM_STREAM_AT_COMMAND_LENGTH;
+                pEdmStream->atCommandCurrent = U_SHORT_RANGE_EDM_STREAM_AT_COMMAND_LENGTH;
                 // Send a chunk
-                x = edmSend(&gEdmStream);
+                x = edmSend(pEdmStream);
                 if (x < 0) {
                     // Error recovery: tell the caller we've consumed the lot
                     *ppData += *pLength;
                     *pLength = 0;
                 }
-                gEdmStream.atCommandCurrent = 0;
+                pEdmStream->atCommandCurrent = 0;
             }
             // Copy in any partial buffer, will be sent when we are flushed
-            memcpy(gEdmStream.pAtCommandBuffer + gEdmStream.atCommandCurrent, *ppData, *pLength);
-            gEdmStream.atCommandCurrent += (int32_t) * pLength;
+            memcpy(pEdmStream->pAtCommandBuffer + pEdmStream->atCommandCurrent, *ppData, *pLength);
+            pEdmStream->atCommandCurrent += (int32_t) * pLength;
             // Tell the caller what we've consumed.
             *ppData += *pLength;
         }
@@ -929,6 +1060,20 @@ static const char *pInterceptTx(uAtClientHandle_t atHandle,
     return 0;
 }
 
+// Get the stream for a handle, which need not be open, NULL
+// if the handle is out of range or we are not initialised.
+static uShortRangeEdmStreamInstance_t *pGetStream(int32_t handle)
+{
+    uShortRangeEdmStreamInstance_t *pEdmStream = NULL;
+
+    if ((gMutex != NULL) && (handle >= 0) &&
+        (handle < (int32_t) (sizeof(gEdmStream) / sizeof(gEdmStream[0])))) {
+        pEdmStream = &(gEdmStream[handle]);
+    }
+
+    return pEdmStream;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -939,106 +1084,177 @@ int32_t uShortRangeEdmStreamInit()
 
     if (gMutex == NULL) {
         errorCodeOrHandle = (uErrorCode_t)uPortMutexCreate(&gMutex);
+        for (size_t x = 0; (x < sizeof(gEdmStream) / sizeof(gEdmStream[0])) &&
+             (errorCodeOrHandle == U_ERROR_COMMON_SUCCESS); x++) {
+            memset(&(gEdmStream[x]), 0, sizeof(gEdmStream[x]));
+            gEdmStream[x].handle = -1;
+            gEdmStream[x].uartHandle = -1;
+            gEdmStream[x].eventQueueHandle = -1;
+            errorCodeOrHandle = (uErrorCode_t)uPortMutexCreate(&(gEdmStream[x].mutex));
+        }
 
         if (errorCodeOrHandle == U_ERROR_COMMON_SUCCESS) {
             errorCodeOrHandle = (uErrorCode_t)uShortRangeMemPoolInit();
         }
-        gEdmStream.handle = -1;
-        gEdmStream.ignoreUartCallback = false;
+        if (errorCodeOrHandle != U_ERROR_COMMON_SUCCESS) {
+            // Clean up on error
+            for (size_t x = 0; x < sizeof(gEdmStream) / sizeof(gEdmStream[0]); x++) {
+                if (gEdmStream[x].mutex != NULL) {
+                    uPortMutexDelete(gEdmStream[x].mutex);
+                    gEdmStream[x].mutex = NULL;
+                }
+            }
+            if (gMutex != NULL) {
+                uPortMutexDelete(gMutex);
+                gMutex = NULL;
+            }
+        }
     }
 
-    uShortRangeEdmResetParser();
-
     return (int32_t) errorCodeOrHandle;
 }
 
 void uShortRangeEdmStreamDeinit()
 {
-    uShortRangeEdmResetParser();
+    bool streamOpen = false;
 
     if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
-        uShortRangeMemPoolDeInit();
 
-        if (gEdmStream.eventQueueHandle >= 0) {
-            uPortEventQueueClose(gEdmStream.eventQueueHandle);
+        // Only tear down once the last stream has been closed,
+        // there may be several short range modules in use
+        for (size_t x = 0; x < sizeof(gEdmStream) / sizeof(gEdmStream[0]); x++) {
+            if (gEdmStream[x].handle >= 0) {
+                streamOpen = true;
+            }
+        }
+
+        if (!streamOpen) {
+            uShortRangeMemPoolDeInit();
+            for (size_t x = 0; x < sizeof(gEdmStream) / sizeof(gEdmStream[0]); x++) {
+                uPortMutexDelete(gEdmStream[x].mutex);
+                gEdmStream[x].mutex = NULL;
+            }
         }
-        gEdmStream.eventQueueHandle = -1;
 
         U_PORT_MUTEX_UNLOCK(gMutex);
-        uPortMutexDelete(gMutex);
-        gMutex = NULL;
+
+        if (!streamOpen) {
+            uPortMutexDelete(gMutex);
+            gMutex = NULL;
+        }
     }
 }
 
 int32_t uShortRangeEdmStreamOpen(int32_t uartHandle)
 {
     uErrorCode_t handleOrErrorCode = U_ERROR_COMMON_NOT_INITIALISED;
+    uShortRangeEdmStreamInstance_t *pEdmStream = NULL;
+    int32_t handle = -1;
 
     if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
         handleOrErrorCode = U_ERROR_COMMON_INVALID_PARAMETER;
 
-        if (uartHandle >= 0 && gEdmStream.handle == -1) {
+        if (uartHandle >= 0) {
+            // Find a free stream; a given UART can only be
+            // used by one of them
+            for (size_t x = 0; x < sizeof(gEdmStream) / sizeof(gEdmStream[0]); x++) {
+                if (gEdmStream[x].handle >= 0) {
+                    if (gEdmStream[x].uartHandle == uartHandle) {
+                        pEdmStream = NULL;
+                        break;
+                    }
+                } else if (pEdmStream == NULL) {
+                    pEdmStream = &(gEdmStream[x]);
+                    handle = (int32_t) x;
+                }
+            }
+        }
+
+        if (pEdmStream != NULL) {
+
+            U_PORT_MUTEX_LOCK(pEdmStream->mutex);
 
             int32_t errorCode = uPortUartEventCallbackSet(uartHandle,
                                                           U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
-                                                          uartCallback, NULL,
+                                                          uartCallback, pEdmStream,
                                                           U_EDM_STREAM_TASK_STACK_SIZE_BYTES,
                                                           U_EDM_STREAM_TASK_PRIORITY);
 
             if (errorCode == 0) {
-                gEdmStream.pAtCommandBuffer = (char *)pUPortMalloc(U_SHORT_RANGE_EDM_STREAM_AT_COMMAND_LENGTH);
-                memset(gEdmStream.pAtCommandBuffer, 0, U_SHORT_RANGE_EDM_STREAM_AT_COMMAND_LENGTH);
-                gEdmStream.pAtResponseBuffer = (char *)pUPortMalloc(U_SHORT_RANGE_EDM_STREAM_AT_RESPONSE_LENGTH);
-                memset(gEdmStream.pAtResponseBuffer, 0, U_SHORT_RANGE_EDM_STREAM_AT_RESPONSE_LENGTH);
-                if (gEdmStream.pAtCommandBuffer == NULL ||
-                    gEdmStream.pAtResponseBuffer == NULL) {
+                pEdmStream->pAtCommandBuffer = (char *)pUPortMalloc(U_SHORT_RANGE_EDM_STREAM_AT_COMMAND_LENGTH);
+                pEdmStream->pAtResponseBuffer = (char *)pUPortMalloc(U_SHORT_RANGE_EDM_STREAM_AT_RESPONSE_LENGTH);
+                pEdmStream->pTxBuffer = (char *)pUPortMalloc(U_SHORT_RANGE_EDM_STREAM_TX_BUFFER_LENGTH);
+                if (pEdmStream->pAtCommandBuffer == NULL ||
+                    pEdmStream->pAtResponseBuffer == NULL ||
+                    pEdmStream->pTxBuffer == NULL) {
                     handleOrErrorCode = U_ERROR_COMMON_NO_MEMORY;
                     uPortUartEventCallbackRemove(uartHandle);
+                    uPortFree(pEdmStream->pAtCommandBuffer);
+                    pEdmStream->pAtCommandBuffer = NULL;
+                    uPortFree(pEdmStream->pAtResponseBuffer);
+                    pEdmStream->pAtResponseBuffer = NULL;
+                    uPortFree(pEdmStream->pTxBuffer);
+                    pEdmStream->pTxBuffer = NULL;
                 } else {
-                    gEdmStream.eventQueueHandle
+                    memset(pEdmStream->pAtCommandBuffer, 0, U_SHORT_RANGE_EDM_STREAM_AT_COMMAND_LENGTH);
+                    uRingBufferCreateSpsc(&(pEdmStream->atRingBuffer),
+                                          pEdmStream->pAtResponseBuffer,
+                                          U_SHORT_RANGE_EDM_STREAM_AT_RESPONSE_LENGTH);
+                    // Each stream has its own event queue, and hence
+                    // its own task, so that a slow callback on one
+                    // stream does not hold up the others
+                    pEdmStream->eventQueueHandle
                         = uPortEventQueueOpen(eventHandler, "eventEdmStream",
                                               sizeof(uShortRangeEdmStreamEvent_t),
                                               U_EDM_STREAM_TASK_STACK_SIZE_BYTES,
                                               U_EDM_STREAM_TASK_PRIORITY,
                                               U_EDM_STREAM_EVENT_QUEUE_SIZE);
-                    if (gEdmStream.eventQueueHandle < 0) {
-                        gEdmStream.eventQueueHandle = -1;
+                    if (pEdmStream->eventQueueHandle < 0) {
+                        pEdmStream->eventQueueHandle = -1;
                     }
 
-                    gEdmStream.handle = 0;
-                    gEdmStream.uartHandle = uartHandle;
-                    gEdmStream.atHandle = NULL;
-                    gEdmStream.pAtCallback = NULL;
-                    gEdmStream.pAtCallbackParam = NULL;
-                    gEdmStream.pBtEventCallback = NULL;
-                    gEdmStream.pBtEventCallbackParam = NULL;
-                    gEdmStream.pBtDataCallback = NULL;
-                    gEdmStream.pBtDataCallbackParam = NULL;
-                    gEdmStream.pIpEventCallback = NULL;
-                    gEdmStream.pIpEventCallbackParam = NULL;
-                    gEdmStream.pIpDataCallback = NULL;
-                    gEdmStream.pIpDataCallbackParam = NULL;
-                    gEdmStream.pMqttEventCallback = NULL;
-                    gEdmStream.pMqttEventCallbackParam = NULL;
-                    gEdmStream.pMqttDataCallback = NULL;
-                    gEdmStream.pMqttDataCallbackParam = NULL;
-                    gEdmStream.atCommandCurrent = 0;
+                    pEdmStream->ignoreUartCallback = false;
+                    pEdmStream->handle = handle;
+                    pEdmStream->uartHandle = uartHandle;
+                    pEdmStream->atHandle = NULL;
+                    pEdmStream->pAtCallback = NULL;
+                    pEdmStream->pAtCallbackParam = NULL;
+                    pEdmStream->pBtEventCallback = NULL;
+                    pEdmStream->pBtEventCallbackParam = NULL;
+                    pEdmStream->pBtDataCallback = NULL;
+                    pEdmStream->pBtDataCallbackParam = NULL;
+                    pEdmStream->pIpEventCallback = NULL;
+                    pEdmStream->pIpEventCallbackParam = NULL;
+                    pEdmStream->pIpDataCallback = NULL;
+                    pEdmStream->pIpDataCallbackParam = NULL;
+                    pEdmStream->pMqttEventCallback = NULL;
+                    pEdmStream->pMqttEventCallbackParam = NULL;
+                    pEdmStream->pMqttDataCallback = NULL;
+                    pEdmStream->pMqttDataCallbackParam = NULL;
+                    pEdmStream->atCommandCurrent = 0;
+                    pEdmStream->atEventPending = false;
+                    pEdmStream->rxBufferReadIndex = 0;
+                    pEdmStream->rxBufferCount = 0;
+                    memset(&(pEdmStream->parser), 0, sizeof(pEdmStream->parser));
+                    pEdmStream->parser.pAtRingBuffer = &(pEdmStream->atRingBuffer);
 
                     for (uint32_t i = 0; i < U_SHORT_RANGE_EDM_STREAM_MAX_CONNECTIONS; i++) {
-                        gEdmStream.connections[i].channel = -1;
-                        gEdmStream.connections[i].type = U_SHORT_RANGE_CONNECTION_TYPE_INVALID;
+                        pEdmStream->connections[i].channel = -1;
+                        pEdmStream->connections[i].type = U_SHORT_RANGE_CONNECTION_TYPE_INVALID;
                     }
 
-                    handleOrErrorCode = (uErrorCode_t)gEdmStream.handle;
+                    handleOrErrorCode = (uErrorCode_t)pEdmStream->handle;
                     flushUart(uartHandle);
                 }
             }
+
+            U_PORT_MUTEX_UNLOCK(pEdmStream->mutex);
         }
-        uShortRangeEdmResetParser();
+
         U_PORT_MUTEX_UNLOCK(gMutex);
     }
 
@@ -1047,51 +1263,61 @@ int32_t uShortRangeEdmStreamOpen(int32_t uartHandle)
 
 void uShortRangeEdmStreamClose(int32_t handle)
 {
-    if (gMutex != NULL) {
-        gEdmStream.ignoreUartCallback = true;
-        uPortMutexLock(gMutex);
+    uShortRangeEdmStreamInstance_t *pEdmStream = pGetStream(handle);
+
+    if (pEdmStream != NULL) {
+        pEdmStream->ignoreUartCallback = true;
+        uPortMutexLock(pEdmStream->mutex);
 
-        if ((handle != -1) && (handle == gEdmStream.handle)) {
-            gEdmStream.handle = -1;
-            if (gEdmStream.uartHandle >= 0) {
-                uPortUartEventCallbackRemove(gEdmStream.uartHandle);
+        if ((handle != -1) && (handle == pEdmStream->handle)) {
+            pEdmStream->handle = -1;
+            if (pEdmStream->uartHandle >= 0) {
+                uPortUartEventCallbackRemove(pEdmStream->uartHandle);
             }
-            gEdmStream.uartHandle = -1;
-            if (gEdmStream.eventQueueHandle >= 0) {
-                uPortEventQueueClose(gEdmStream.eventQueueHandle);
+            pEdmStream->uartHandle = -1;
+            if (pEdmStream->eventQueueHandle >= 0) {
+                uPortEventQueueClose(pEdmStream->eventQueueHandle);
             }
-            gEdmStream.eventQueueHandle = -1;
-            if (gEdmStream.atHandle != NULL) {
-                uAtClientStreamInterceptTx(gEdmStream.atHandle, NULL, NULL);
+            pEdmStream->eventQueueHandle = -1;
+            if (pEdmStream->atHandle != NULL) {
+                uAtClientStreamInterceptTx(pEdmStream->atHandle, NULL, NULL);
             }
-            gEdmStream.atHandle = NULL;
-            gEdmStream.pAtCallback = NULL;
-            gEdmStream.pAtCallbackParam = NULL;
-            gEdmStream.pBtEventCallback = NULL;
-            gEdmStream.pBtEventCallbackParam = NULL;
-            gEdmStream.pBtDataCallback = NULL;
-            gEdmStream.pBtDataCallbackParam = NULL;
-            gEdmStream.pIpEventCallback = NULL;
-            gEdmStream.pIpEventCallbackParam = NULL;
-            gEdmStream.pIpDataCallback = NULL;
-            gEdmStream.pIpDataCallbackParam = NULL;
-            gEdmStream.pMqttEventCallback = NULL;
-            gEdmStream.pMqttEventCallbackParam = NULL;
-            gEdmStream.pMqttDataCallback = NULL;
-            gEdmStream.pMqttDataCallbackParam = NULL;
-            uPortFree(gEdmStream.pAtCommandBuffer);
-            gEdmStream.pAtCommandBuffer = NULL;
-            uPortFree(gEdmStream.pAtResponseBuffer);
-            gEdmStream.pAtResponseBuffer = NULL;
+            pEdmStream->atHandle = NULL;
+            pEdmStream->pAtCallback = NULL;
+            pEdmStream->pAtCallbackParam = NULL;
+            pEdmStream->pBtEventCallback = NULL;
+            pEdmStream->pBtEventCallbackParam = NULL;
+            pEdmStream->pBtDataCallback = NULL;
+            pEdmStream->pBtDataCallbackParam = NULL;
+            pEdmStream->pIpEventCallback = NULL;
+            pEdmStream->pIpEventCallbackParam = NULL;
+            pEdmStream->pIpDataCallback = NULL;
+            pEdmStream->pIpDataCallbackParam = NULL;
+            pEdmStream->pMqttEventCallback = NULL;
+            pEdmStream->pMqttEventCallbackParam = NULL;
+            pEdmStream->pMqttDataCallback = NULL;
+            pEdmStream->pMqttDataCallbackParam = NULL;
+            uPortFree(pEdmStream->pAtCommandBuffer);
+            pEdmStream->pAtCommandBuffer = NULL;
+            uRingBufferDelete(&(pEdmStream->atRingBuffer));
+            uPortFree(pEdmStream->pAtResponseBuffer);
+            pEdmStream->pAtResponseBuffer = NULL;
+            uPortFree(pEdmStream->pTxBuffer);
+            pEdmStream->pTxBuffer = NULL;
             for (uint32_t i = 0; i < U_SHORT_RANGE_EDM_STREAM_MAX_CONNECTIONS; i++) {
-                gEdmStream.connections[i].channel = -1;
-                gEdmStream.connections[i].type = U_SHORT_RANGE_CONNECTION_TYPE_INVALID;
+                pEdmStream->connections[i].channel = -1;
+                pEdmStream->connections[i].type = U_SHORT_RANGE_CONNECTION_TYPE_INVALID;
             }
+            if (pEdmStream->parser.pCurPBufList != NULL) {
+                uShortRangePbufListFree(pEdmStream->parser.pCurPBufList);
+            }
+            memset(&(pEdmStream->parser), 0, sizeof(pEdmStream->parser));
+            pEdmStream->rxBufferReadIndex = 0;
+            pEdmStream->rxBufferCount = 0;
         }
 
-        uShortRangeEdmResetParser();
-        uPortMutexUnlock(gMutex);
-        gEdmStream.ignoreUartCallback = false;
+        uPortMutexUnlock(pEdmStream->mutex);
+        pEdmStream->ignoreUartCallback = false;
     }
 }
 
@@ -1100,20 +1326,21 @@ int32_t uShortRangeEdmStreamAtCallbackSet(int32_t handle,
                                           uEdmAtEventCallback_t pFunction,
                                           void *pParam)
 {
+    uShortRangeEdmStreamInstance_t *pEdmStream = pGetStream(handle);
     uErrorCode_t errorCode = U_ERROR_COMMON_NOT_INITIALISED;
 
-    if (gMutex != NULL) {
+    if (pEdmStream != NULL) {
 
-        U_PORT_MUTEX_LOCK(gMutex);
+        U_PORT_MUTEX_LOCK(pEdmStream->mutex);
 
         errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
-        if ((handle == gEdmStream.handle) && (pFunction != NULL)) {
-            gEdmStream.pAtCallback = pFunction;
-            gEdmStream.pAtCallbackParam = pParam;
+        if ((handle == pEdmStream->handle) && (pFunction != NULL)) {
+            pEdmStream->pAtCallback = pFunction;
+            pEdmStream->pAtCallbackParam = pParam;
             errorCode = U_ERROR_COMMON_SUCCESS;
         }
 
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        U_PORT_MUTEX_UNLOCK(pEdmStream->mutex);
     }
 
     return (int32_t)errorCode;
@@ -1123,26 +1350,27 @@ int32_t uShortRangeEdmStreamIpEventCallbackSet(int32_t handle,
                                                uEdmIpConnectionStatusCallback_t pFunction,
                                                void *pParam)
 {
+    uShortRangeEdmStreamInstance_t *pEdmStream = pGetStream(handle);
     uErrorCode_t errorCode = U_ERROR_COMMON_NOT_INITIALISED;
 
-    if (gMutex != NULL) {
+    if (pEdmStream != NULL) {
 
-        U_PORT_MUTEX_LOCK(gMutex);
+        U_PORT_MUTEX_LOCK(pEdmStream->mutex);
 
         errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
-        if (handle == gEdmStream.handle) {
-            if (pFunction != NULL && gEdmStream.pIpEventCallback == NULL) {
-                gEdmStream.pIpEventCallback = pFunction;
-                gEdmStream.pIpEventCallbackParam = pParam;
+        if (handle == pEdmStream->handle) {
+            if (pFunction != NULL && pEdmStream->pIpEventCallback == NULL) {
+                pEdmStream->pIpEventCallback = pFunction;
+                pEdmStream->pIpEventCallbackParam = pParam;
                 errorCode = U_ERROR_COMMON_SUCCESS;
             } else if (pFunction == NULL) {
-                gEdmStream.pIpEventCallback = NULL;
-                gEdmStream.pIpEventCallbackParam = NULL;
+                pEdmStream->pIpEventCallback = NULL;
+                pEdmStream->pIpEventCallbackParam = NULL;
                 errorCode = U_ERROR_COMMON_SUCCESS;
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        U_PORT_MUTEX_UNLOCK(pEdmStream->mutex);
     }
 
     return (int32_t)errorCode;
@@ -1159,26 +1387,27 @@ int32_t uShortRangeEdmStreamMqttEventCallbackSet(int32_t handle,
                                                  uEdmIpConnectionStatusCallback_t pFunction,
                                                  void *pParam)
 {
+    uShortRangeEdmStreamInstance_t *pEdmStream = pGetStream(handle);
     uErrorCode_t errorCode = U_ERROR_COMMON_NOT_INITIALISED;
 
-    if (gMutex != NULL) {
+    if (pEdmStream != NULL) {
 
-        U_PORT_MUTEX_LOCK(gMutex);
+        U_PORT_MUTEX_LOCK(pEdmStream->mutex);
 
         errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
-        if (handle == gEdmStream.handle) {
-            if (pFunction != NULL && gEdmStream.pMqttEventCallback == NULL) {
-                gEdmStream.pMqttEventCallback = pFunction;
-                gEdmStream.pMqttEventCallbackParam = pParam;
+        if (handle == pEdmStream->handle) {
+            if (pFunction != NULL && pEdmStream->pMqttEventCallback == NULL) {
+                pEdmStream->pMqttEventCallback = pFunction;
+                pEdmStream->pMqttEventCallbackParam = pParam;
                 errorCode = U_ERROR_COMMON_SUCCESS;
             } else if (pFunction == NULL) {
-                gEdmStream.pMqttEventCallback = NULL;
-                gEdmStream.pMqttEventCallbackParam = NULL;
+                pEdmStream->pMqttEventCallback = NULL;
+                pEdmStream->pMqttEventCallbackParam = NULL;
                 errorCode = U_ERROR_COMMON_SUCCESS;
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        U_PORT_MUTEX_UNLOCK(pEdmStream->mutex);
     }
 
     return (int32_t)errorCode;
@@ -1196,27 +1425,28 @@ int32_t uShortRangeEdmStreamBtEventCallbackSet(int32_t handle,
                                                uEdmBtConnectionStatusCallback_t pFunction,
                                                void *pParam)
 {
+    uShortRangeEdmStreamInstance_t *pEdmStream = pGetStream(handle);
     uErrorCode_t errorCode = U_ERROR_COMMON_NOT_INITIALISED;
 
-    if (gMutex != NULL) {
+    if (pEdmStream != NULL) {
 
-        U_PORT_MUTEX_LOCK(gMutex);
+        U_PORT_MUTEX_LOCK(pEdmStream->mutex);
 
         errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
-        if (handle == gEdmStream.handle) {
-            if (pFunction != NULL && gEdmStream.pBtEventCallback == NULL) {
-                gEdmStream.pBtEventCallback = pFunction;
-                gEdmStream.pBtEventCallbackParam = pParam;
+        if (handle == pEdmStream->handle) {
+            if (pFunction != NULL && pEdmStream->pBtEventCallback == NULL) {
+                pEdmStream->pBtEventCallback = pFunction;
+                pEdmStream->pBtEventCallbackParam = pParam;
                 errorCode = U_ERROR_COMMON_SUCCESS;
             } else if (pFunction == NULL) {
-                gEdmStream.pBtEventCallback = NULL;
-                gEdmStream.pBtEventCallbackParam = NULL;
+                pEdmStream->pBtEventCallback = NULL;
+                pEdmStream->pBtEventCallbackParam = NULL;
                 errorCode = U_ERROR_COMMON_SUCCESS;
             }
 
         }
 
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        U_PORT_MUTEX_UNLOCK(pEdmStream->mutex);
     }
 
     return (int32_t)errorCode;
@@ -1234,48 +1464,49 @@ int32_t uShortRangeEdmStreamDataEventCallbackSet(int32_t handle,
                                                  uEdmDataEventCallback_t pFunction,
                                                  void *pParam)
 {
+    uShortRangeEdmStreamInstance_t *pEdmStream = pGetStream(handle);
     uErrorCode_t errorCode = U_ERROR_COMMON_NOT_INITIALISED;
 
-    if (gMutex != NULL) {
+    if (pEdmStream != NULL) {
 
-        U_PORT_MUTEX_LOCK(gMutex);
+        U_PORT_MUTEX_LOCK(pEdmStream->mutex);
 
         errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
-        if (handle == gEdmStream.handle) {
+        if (handle == pEdmStream->handle) {
             switch (type) {
 
                 case U_SHORT_RANGE_CONNECTION_TYPE_BT:
-                    if (pFunction != NULL && gEdmStream.pBtDataCallback == NULL) {
-                        gEdmStream.pBtDataCallback = pFunction;
-                        gEdmStream.pBtDataCallbackParam = pParam;
+                    if (pFunction != NULL && pEdmStream->pBtDataCallback == NULL) {
+                        pEdmStream->pBtDataCallback = pFunction;
+                        pEdmStream->pBtDataCallbackParam = pParam;
                         errorCode = U_ERROR_COMMON_SUCCESS;
                     } else if (pFunction == NULL) {
-                        gEdmStream.pBtDataCallback = NULL;
-                        gEdmStream.pBtDataCallbackParam = NULL;
+                        pEdmStream->pBtDataCallback = NULL;
+                        pEdmStream->pBtDataCallbackParam = NULL;
                         errorCode = U_ERROR_COMMON_SUCCESS;
                     }
                     break;
 
                 case U_SHORT_RANGE_CONNECTION_TYPE_IP:
-                    if (pFunction != NULL && gEdmStream.pIpDataCallback == NULL) {
-                        gEdmStream.pIpDataCallback = pFunction;
-                        gEdmStream.pIpDataCallbackParam = pParam;
+                    if (pFunction != NULL && pEdmStream->pIpDataCallback == NULL) {
+                        pEdmStream->pIpDataCallback = pFunction;
+                        pEdmStream->pIpDataCallbackParam = pParam;
                         errorCode = U_ERROR_COMMON_SUCCESS;
                     } else if (pFunction == NULL) {
-                        gEdmStream.pIpDataCallback = NULL;
-                        gEdmStream.pIpDataCallbackParam = NULL;
+                        pEdmStream->pIpDataCallback = NULL;
+                        pEdmStream->pIpDataCallbackParam = NULL;
                         errorCode = U_ERROR_COMMON_SUCCESS;
                     }
                     break;
 
                 case U_SHORT_RANGE_CONNECTION_TYPE_MQTT:
-                    if (pFunction != NULL && gEdmStream.pMqttDataCallback == NULL) {
-                        gEdmStream.pMqttDataCallback = pFunction;
-                        gEdmStream.pMqttDataCallbackParam = pParam;
+                    if (pFunction != NULL && pEdmStream->pMqttDataCallback == NULL) {
+                        pEdmStream->pMqttDataCallback = pFunction;
+                        pEdmStream->pMqttDataCallbackParam = pParam;
                         errorCode = U_ERROR_COMMON_SUCCESS;
                     } else if (pFunction == NULL) {
-                        gEdmStream.pMqttDataCallback = NULL;
-                        gEdmStream.pMqttDataCallbackParam = NULL;
+                        pEdmStream->pMqttDataCallback = NULL;
+                        pEdmStream->pMqttDataCallbackParam = NULL;
                         errorCode = U_ERROR_COMMON_SUCCESS;
                     }
                     break;
@@ -1285,7 +1516,7 @@ int32_t uShortRangeEdmStreamDataEventCallbackSet(int32_t handle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        U_PORT_MUTEX_UNLOCK(pEdmStream->mutex);
     }
 
     return (int32_t)errorCode;
@@ -1302,29 +1533,32 @@ void uShortRangeEdmStreamDataEventCallbackRemove(int32_t handle,
 
 void uShortRangeEdmStreamSetAtHandle(int32_t handle, void *atHandle)
 {
-    if (handle == gEdmStream.handle) {
-        uAtClientStreamInterceptTx(atHandle, pInterceptTx, NULL);
-        gEdmStream.atHandle = atHandle;
+    uShortRangeEdmStreamInstance_t *pEdmStream = pGetStream(handle);
+
+    if ((pEdmStream != NULL) && (handle == pEdmStream->handle)) {
+        uAtClientStreamInterceptTx(atHandle, pInterceptTx, pEdmStream);
+        pEdmStream->atHandle = atHandle;
     }
 }
 
 int32_t uShortRangeEdmStreamAtWrite(int32_t handle, const void *pBuffer,
                                     size_t sizeBytes)
 {
+    uShortRangeEdmStreamInstance_t *pEdmStream = pGetStream(handle);
     int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
 
-    if (gMutex != NULL) {
+    if (pEdmStream != NULL) {
 
-        U_PORT_MUTEX_LOCK(gMutex);
+        U_PORT_MUTEX_LOCK(pEdmStream->mutex);
         sizeOrErrorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
-        if (gEdmStream.handle == handle && pBuffer != NULL && sizeBytes != 0) {
+        if (pEdmStream->handle == handle && pBuffer != NULL && sizeBytes != 0) {
             sizeOrErrorCode = (int32_t)U_ERROR_COMMON_PLATFORM;
 
             int32_t result;
             uint32_t sent = 0;
 
             do {
-                result = uartWrite(pBuffer, sizeBytes);
+                result = uartWrite(pEdmStream, pBuffer, sizeBytes);
                 if (result > 0) {
                     sent += result;
                 }
@@ -1335,7 +1569,7 @@ int32_t uShortRangeEdmStreamAtWrite(int32_t handle, const void *pBuffer,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        U_PORT_MUTEX_UNLOCK(pEdmStream->mutex);
     }
 
     return sizeOrErrorCode;
@@ -1344,33 +1578,33 @@ int32_t uShortRangeEdmStreamAtWrite(int32_t handle, const void *pBuffer,
 int32_t uShortRangeEdmStreamAtRead(int32_t handle, void *pBuffer,
                                    size_t sizeBytes)
 {
+    uShortRangeEdmStreamInstance_t *pEdmStream = pGetStream(handle);
     int32_t sizeOrErrorCode = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
 
-    if (gMutex != NULL) {
+    if (pEdmStream != NULL) {
 
-        if (!gEdmStream.ignoreUartCallback) {
-            U_PORT_MUTEX_LOCK(gMutex);
+        if (!pEdmStream->ignoreUartCallback) {
+            U_PORT_MUTEX_LOCK(pEdmStream->mutex);
 
             sizeOrErrorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
-            if (gEdmStream.handle == handle && pBuffer != NULL && sizeBytes != 0) {
-                sizeOrErrorCode = (int32_t)(gEdmStream.atResponseLength - gEdmStream.atResponseRead);
+            if (pEdmStream->handle == handle && pBuffer != NULL && sizeBytes != 0) {
+                // Both spans of the AT ring buffer are copied out in one go
+                sizeOrErrorCode = (int32_t) uRingBufferRead(&(pEdmStream->atRingBuffer),
+                                                            (char *) pBuffer, sizeBytes);
                 if (sizeOrErrorCode > 0) {
-                    if (sizeBytes < (uint32_t)sizeOrErrorCode) {
-                        sizeOrErrorCode = (int32_t)sizeBytes;
-                    }
-                    memcpy(pBuffer, gEdmStream.pAtResponseBuffer + gEdmStream.atResponseRead, sizeOrErrorCode);
-                    gEdmStream.atResponseRead += sizeOrErrorCode;
-
-                    if (gEdmStream.atResponseRead >= gEdmStream.atResponseLength) {
-                        gEdmStream.atResponseLength = 0;
-                        gEdmStream.atResponseRead = 0;
-                        uEdmChLogLine(LOG_CH_AT_RX, "processed");
-                        processedEvent();
+#ifdef U_CFG_SHORT_RANGE_EDM_STREAM_DEBUG
+                    uEdmChLogStart(LOG_CH_AT_RX, "\"");
+                    dumpAtData((const char *) pBuffer, sizeOrErrorCode);
+                    uEdmChLogEnd("\"");
+#endif
+                    if (pEdmStream->parser.state == EDM_PARSER_STATE_ACCUMULATE_AT_PAYLOAD) {
+                        // The parser may have stopped for lack of room
+                        kickParser(pEdmStream);
                     }
                 }
             }
 
-            U_PORT_MUTEX_UNLOCK(gMutex);
+            U_PORT_MUTEX_UNLOCK(pEdmStream->mutex);
         } else {
             sizeOrErrorCode = 0;
         }
@@ -1383,19 +1617,43 @@ int32_t uShortRangeEdmStreamWrite(int32_t handle, int32_t channel,
                                   const void *pBuffer, size_t sizeBytes,
                                   uint32_t timeoutMs)
 {
+    uSockIoVec_t ioVec;
+
+    ioVec.pData = pBuffer;
+    ioVec.dataSizeBytes = sizeBytes;
+
+    return uShortRangeEdmStreamWritev(handle, channel, &ioVec, 1, timeoutMs);
+}
+
+int32_t uShortRangeEdmStreamWritev(int32_t handle, int32_t channel,
+                                   const uSockIoVec_t *pIoVec,
+                                   size_t ioVecCount,
+                                   uint32_t timeoutMs)
+{
+    uShortRangeEdmStreamInstance_t *pEdmStream = pGetStream(handle);
     int32_t sizeOrErrorCode = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+    size_t sizeBytes = 0;
 
-    if (gMutex != NULL) {
-        U_PORT_MUTEX_LOCK(gMutex);
+    if (pEdmStream != NULL) {
+        U_PORT_MUTEX_LOCK(pEdmStream->mutex);
         sizeOrErrorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
-        if (gEdmStream.handle == handle && channel >= 0 &&
-            pBuffer != NULL && sizeBytes != 0) {
-            uShortRangeEdmStreamConnections_t *pConnection = findConnection(channel);
+        for (size_t x = 0; (pIoVec != NULL) && (x < ioVecCount); x++) {
+            if (pIoVec[x].pData != NULL) {
+                sizeBytes += pIoVec[x].dataSizeBytes;
+            }
+        }
+        U_LOG_RAM_TRACE_BEGIN(EDM_STREAM, EDM_WRITE, sizeBytes);
+        if (pEdmStream->handle == handle && channel >= 0 &&
+            sizeBytes != 0 && sizeBytes <= INT32_MAX) {
+            uShortRangeEdmStreamConnections_t *pConnection = findConnection(pEdmStream, channel);
             if (pConnection != NULL) {
                 int32_t sent;
                 int32_t send;
                 char head[U_SHORT_RANGE_EDM_DATA_HEAD_SIZE];
                 char tail[U_SHORT_RANGE_EDM_TAIL_SIZE];
+                size_t ioVecIndex = 0;
+                size_t ioVecOffset = 0;
+                size_t txCount = 0;
                 sizeOrErrorCode = 0;
                 int64_t startTime = uPortGetTickTimeMs();
                 int64_t endTime;
@@ -1409,20 +1667,45 @@ int32_t uShortRangeEdmStreamWrite(int32_t handle, int32_t channel,
                     }
 
 #ifdef U_CFG_SHORT_RANGE_EDM_STREAM_DEBUG
-# ifdef U_CFG_SHORT_RANGE_EDM_STREAM_DEBUG_DUMP_DATA
-                    uEdmChLogStart(LOG_CH_DATA, "TX (%d bytes): ", send);
-                    dumpHexData(((const char *)pBuffer + sizeOrErrorCode), send);
-                    uEdmChLogEnd("");
-# else
+# ifndef U_CFG_SHORT_RANGE_EDM_STREAM_DEBUG_DUMP_DATA
                     uEdmChLogLine(LOG_CH_DATA, "TX (%d bytes)", send);
 # endif
 #endif
 
                     (void)uShortRangeEdmZeroCopyHeadData((uint8_t)channel, send, (char *)&head[0]);
-                    sent = uartWrite((void *)&head[0], U_SHORT_RANGE_EDM_DATA_HEAD_SIZE);
-                    sent += uartWrite((const void *)((const char *)pBuffer + sizeOrErrorCode), send);
+                    // The head, data and tail are gathered in the transmit
+                    // buffer so that, other than for large packets, they
+                    // go to the UART in one write
+                    sent = txWrite(pEdmStream, &head[0], U_SHORT_RANGE_EDM_DATA_HEAD_SIZE,
+                                   &txCount, false);
+                    // Write the pieces of data that make up this frame
+                    for (int32_t left = send; (left > 0) && (ioVecIndex < ioVecCount);) {
+                        int32_t thisSend = 0;
+                        const char *pThis = (const char *)pIoVec[ioVecIndex].pData;
+                        if (pThis != NULL) {
+                            thisSend = (int32_t)(pIoVec[ioVecIndex].dataSizeBytes - ioVecOffset);
+                            if (thisSend > left) {
+                                thisSend = left;
+                            }
+#if defined(U_CFG_SHORT_RANGE_EDM_STREAM_DEBUG) && defined(U_CFG_SHORT_RANGE_EDM_STREAM_DEBUG_DUMP_DATA)
+                            uEdmChLogStart(LOG_CH_DATA, "TX (%d bytes): ", thisSend);
+                            dumpHexData((const uint8_t *)(pThis + ioVecOffset), thisSend);
+                            uEdmChLogEnd("");
+#endif
+                            sent += txWrite(pEdmStream, pThis + ioVecOffset, thisSend,
+                                            &txCount, false);
+                            left -= thisSend;
+                            ioVecOffset += thisSend;
+                        }
+                        if ((pThis == NULL) ||
+                            (ioVecOffset >= pIoVec[ioVecIndex].dataSizeBytes)) {
+                            ioVecIndex++;
+                            ioVecOffset = 0;
+                        }
+                    }
                     (void)uShortRangeEdmZeroCopyTail((char *)&tail[0]);
-                    sent += uartWrite((void *)&tail[0], U_SHORT_RANGE_EDM_TAIL_SIZE);
+                    sent += txWrite(pEdmStream, &tail[0], U_SHORT_RANGE_EDM_TAIL_SIZE,
+                                    &txCount, true);
 
                     if (sent != (send + U_SHORT_RANGE_EDM_DATA_HEAD_SIZE + U_SHORT_RANGE_EDM_TAIL_SIZE)) {
                         sizeOrErrorCode = (int32_t)U_ERROR_COMMON_DEVICE_ERROR;
@@ -1431,11 +1714,23 @@ int32_t uShortRangeEdmStreamWrite(int32_t handle, int32_t channel,
                         sizeOrErrorCode += send;
                     }
                     endTime = uPortGetTickTimeMs();
+                    if ((int32_t)sizeBytes > sizeOrErrorCode) {
+                        // Let others at the stream between packets
+                        U_PORT_MUTEX_UNLOCK(pEdmStream->mutex);
+                        U_PORT_MUTEX_LOCK(pEdmStream->mutex);
+                        if ((pEdmStream->handle != handle) ||
+                            (findConnection(pEdmStream, channel) != pConnection)) {
+                            // Stream closed or connection gone meanwhile
+                            sizeOrErrorCode = (int32_t)U_ERROR_COMMON_DEVICE_ERROR;
+                            break;
+                        }
+                    }
                 } while (((int32_t)sizeBytes > sizeOrErrorCode) &&
                          (endTime - startTime < timeoutMs));
             }
         }
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        U_LOG_RAM_TRACE_END(EDM_STREAM, EDM_WRITE, sizeOrErrorCode);
+        U_PORT_MUTEX_UNLOCK(pEdmStream->mutex);
     }
 
     return sizeOrErrorCode;
@@ -1443,27 +1738,29 @@ int32_t uShortRangeEdmStreamWrite(int32_t handle, int32_t channel,
 
 int32_t uShortRangeEdmStreamAtEventSend(int32_t handle, uint32_t eventBitMap)
 {
+    uShortRangeEdmStreamInstance_t *pEdmStream = pGetStream(handle);
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
 
-    if (gMutex != NULL) {
+    if (pEdmStream != NULL) {
 
-        U_PORT_MUTEX_LOCK(gMutex);
+        U_PORT_MUTEX_LOCK(pEdmStream->mutex);
 
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        if ((handle == 0) &&
-            (gEdmStream.eventQueueHandle >= 0) &&
+        if ((handle == pEdmStream->handle) &&
+            (pEdmStream->eventQueueHandle >= 0) &&
             // The only event we support right now
             (eventBitMap == U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED)) {
             uShortRangeEdmStreamEvent_t event;
+            event.pEdmStream = pEdmStream;
             event.type = U_SHORT_RANGE_EDM_STREAM_EVENT_AT;
-            errorCode = uPortEventQueueSend(gEdmStream.eventQueueHandle,
+            errorCode = uPortEventQueueSend(pEdmStream->eventQueueHandle,
                                             &event, sizeof(uShortRangeEdmStreamEvent_t));
             if (errorCode != 0) {
                 uPortLog("U_SHO_EDM_STREAM: Failed to enqueue message\n");
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        U_PORT_MUTEX_UNLOCK(pEdmStream->mutex);
     }
 
     return errorCode;
@@ -1471,18 +1768,19 @@ int32_t uShortRangeEdmStreamAtEventSend(int32_t handle, uint32_t eventBitMap)
 
 bool uShortRangeEdmStreamAtEventIsCallback(int32_t handle)
 {
+    uShortRangeEdmStreamInstance_t *pEdmStream = pGetStream(handle);
     bool isEventCallback = false;
 
-    if (gMutex != NULL) {
+    if (pEdmStream != NULL) {
 
-        U_PORT_MUTEX_LOCK(gMutex);
+        U_PORT_MUTEX_LOCK(pEdmStream->mutex);
 
-        if ((handle == gEdmStream.handle) &&
-            (gEdmStream.eventQueueHandle >= 0)) {
-            isEventCallback = uPortEventQueueIsTask(gEdmStream.eventQueueHandle);
+        if ((handle == pEdmStream->handle) &&
+            (pEdmStream->eventQueueHandle >= 0)) {
+            isEventCallback = uPortEventQueueIsTask(pEdmStream->eventQueueHandle);
         }
 
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        U_PORT_MUTEX_UNLOCK(pEdmStream->mutex);
     }
 
     return isEventCallback;
@@ -1490,34 +1788,36 @@ bool uShortRangeEdmStreamAtEventIsCallback(int32_t handle)
 
 void uShortRangeEdmStreamAtCallbackRemove(int32_t handle)
 {
-    if (gMutex != NULL) {
+    uShortRangeEdmStreamInstance_t *pEdmStream = pGetStream(handle);
+    if (pEdmStream != NULL) {
 
-        U_PORT_MUTEX_LOCK(gMutex);
+        U_PORT_MUTEX_LOCK(pEdmStream->mutex);
 
-        if (handle == gEdmStream.handle) {
-            gEdmStream.pAtCallback = NULL;
+        if (handle == pEdmStream->handle) {
+            pEdmStream->pAtCallback = NULL;
         }
 
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        U_PORT_MUTEX_UNLOCK(pEdmStream->mutex);
     }
 }
 
 
 int32_t uShortRangeEdmStreamAtEventStackMinFree(int32_t handle)
 {
+    uShortRangeEdmStreamInstance_t *pEdmStream = pGetStream(handle);
     int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
 
-    if (gMutex != NULL) {
+    if (pEdmStream != NULL) {
 
-        U_PORT_MUTEX_LOCK(gMutex);
+        U_PORT_MUTEX_LOCK(pEdmStream->mutex);
 
         sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        if ((handle == gEdmStream.handle) &&
-            (gEdmStream.eventQueueHandle >= 0)) {
-            sizeOrErrorCode = uPortEventQueueStackMinFree(gEdmStream.eventQueueHandle);
+        if ((handle == pEdmStream->handle) &&
+            (pEdmStream->eventQueueHandle >= 0)) {
+            sizeOrErrorCode = uPortEventQueueStackMinFree(pEdmStream->eventQueueHandle);
         }
 
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        U_PORT_MUTEX_UNLOCK(pEdmStream->mutex);
     }
 
     return sizeOrErrorCode;
@@ -1525,18 +1825,19 @@ int32_t uShortRangeEdmStreamAtEventStackMinFree(int32_t handle)
 
 int32_t uShortRangeEdmStreamAtGetReceiveSize(int32_t handle)
 {
+    uShortRangeEdmStreamInstance_t *pEdmStream = pGetStream(handle);
     int32_t sizeOrErrorCode = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
 
-    if (gMutex != NULL) {
+    if (pEdmStream != NULL) {
 
-        U_PORT_MUTEX_LOCK(gMutex);
+        U_PORT_MUTEX_LOCK(pEdmStream->mutex);
 
         sizeOrErrorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
-        if (handle == gEdmStream.handle) {
-            sizeOrErrorCode = gEdmStream.atResponseLength - gEdmStream.atResponseRead;
+        if (handle == pEdmStream->handle) {
+            sizeOrErrorCode = (int32_t) uRingBufferDataSize(&(pEdmStream->atRingBuffer));
         }
 
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        U_PORT_MUTEX_UNLOCK(pEdmStream->mutex);
     }
 
     return sizeOrErrorCode;
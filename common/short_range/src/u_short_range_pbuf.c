@@ -36,8 +36,13 @@
 #define U_SHORT_RANGE_PBUFLIST_COUNT  (32)
 #endif
 
-#ifndef U_SHORT_RANGE_PBUF_COUNT
-#define U_SHORT_RANGE_PBUF_COUNT      (32)
+#ifndef U_SHORT_RANGE_PBUF_POOL_SIZES
+// The default pbuf size classes, {data size, count} in ascending
+// order of data size, see uShortRangeMemPoolConfigure(); between
+// them they will hold the largest EDM packet.
+# define U_SHORT_RANGE_PBUF_POOL_SIZES {{U_SHORT_RANGE_EDM_BLK_SIZE, 24}, \
+                                        {256, 6},                         \
+                                        {1024, 1}}
 #endif
 /* ----------------------------------------------------------------
  * TYPES
@@ -52,46 +57,152 @@
  * STATIC VARIABLES
  * -------------------------------------------------------------- */
 static uMemPoolDesc_t gPBufListPool;
-static uMemPoolDesc_t gPBufPool;
+static uMemPoolSlab_t gPBufSlab;
+// The default pbuf size classes
+static const uShortRangePbufPoolSize_t gDefaultPoolSizes[U_MEMPOOL_SLAB_MAX_NUM_SIZES] =
+    U_SHORT_RANGE_PBUF_POOL_SIZES;
+// The pbuf size classes set by uShortRangeMemPoolConfigure(),
+// gNumPoolSizes being zero if the defaults are to be used
+static uShortRangePbufPoolSize_t gPoolSizes[U_MEMPOOL_SLAB_MAX_NUM_SIZES];
+static size_t gNumPoolSizes = 0;
+// Mutex protecting gChannelBytes
+static uPortMutexHandle_t gMutex = NULL;
+// The number of bytes of pbuf held in pbuf lists, indexed by EDM channel
+static uint16_t gChannelBytes[256];
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
-static void freePbuf(uShortRangePbuf_t *pBuf, bool freeWholeChain)
+// Adjust the number of bytes of pbuf held for an EDM channel.
+static void channelBytesAdjust(int8_t edmChannel, int32_t adjust)
 {
+    int32_t count;
+
+    if (gMutex != NULL) {
+        U_PORT_MUTEX_LOCK(gMutex);
+        count = (int32_t) gChannelBytes[(uint8_t) edmChannel] + adjust;
+        if (count < 0) {
+            count = 0;
+        }
+        gChannelBytes[(uint8_t) edmChannel] = (uint16_t) count;
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+}
+
+// Free a pbuf or a chain of them, returning the number of
+// bytes of data storage freed.
+static int32_t freePbuf(uShortRangePbuf_t *pBuf, bool freeWholeChain)
+{
+    int32_t size = 0;
+
     if (freeWholeChain) {
         while (pBuf != NULL) {
             uShortRangePbuf_t *pNext = pBuf->pNext;
-            // Basic sanity check - pbuf length should never be longer than pool block size
-            U_ASSERT(pBuf->length <= gPBufPool.blockSize);
-            uMemPoolFreeMem(&gPBufPool, pBuf);
+            // Basic sanity check - pbuf length should never be longer than its size
+            U_ASSERT(pBuf->length <= pBuf->size);
+            size += pBuf->size;
+            uMemPoolSlabFreeMem(&gPBufSlab, pBuf);
             pBuf = pNext;
         }
     } else if (pBuf != NULL) {
-        // Basic sanity check - pbuf length should never be longer than pool block size
-        U_ASSERT(pBuf->length <= gPBufPool.blockSize);
-        uMemPoolFreeMem(&gPBufPool, pBuf);
+        // Basic sanity check - pbuf length should never be longer than its size
+        U_ASSERT(pBuf->length <= pBuf->size);
+        size += pBuf->size;
+        uMemPoolSlabFreeMem(&gPBufSlab, pBuf);
+    }
+
+    return size;
+}
+
+// Allocate a pbuf from the given pool of the slab.
+static int32_t allocPbuf(size_t poolIndex, uShortRangePbuf_t **ppBuf)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    uMemPoolDesc_t *pPool = &(gPBufSlab.pool[poolIndex]);
+
+    *ppBuf = (uShortRangePbuf_t *)uMemPoolAllocMem(pPool);
+    if (*ppBuf != NULL) {
+        (*ppBuf)->length = 0;
+        (*ppBuf)->size = (uint16_t) (pPool->blockSize - sizeof(uShortRangePbuf_t));
+        (*ppBuf)->pNext = NULL;
+        sizeOrErrorCode = (*ppBuf)->size;
     }
+
+    return sizeOrErrorCode;
 }
 
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+int32_t uShortRangeMemPoolConfigure(const uShortRangePbufPoolSize_t *pSizes,
+                                    size_t numSizes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    size_t totalSize = 0;
+
+    if ((pSizes == NULL) && (numSizes == 0)) {
+        // Back to the defaults
+        gNumPoolSizes = 0;
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    } else if ((pSizes != NULL) && (numSizes > 0) && (numSizes <= U_MEMPOOL_SLAB_MAX_NUM_SIZES)) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        for (size_t x = 0; (x < numSizes) && (errorCode == 0); x++) {
+            if ((pSizes[x].dataSize == 0) || (pSizes[x].count <= 0) ||
+                ((x > 0) && (pSizes[x].dataSize <= pSizes[x - 1].dataSize))) {
+                errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            }
+            totalSize += pSizes[x].dataSize * (size_t) pSizes[x].count;
+        }
+        // Must be able to hold the largest EDM packet
+        if ((errorCode == 0) && (totalSize >= U_SHORT_RANGE_EDM_MAX_SIZE)) {
+            memcpy(gPoolSizes, pSizes, numSizes * sizeof(pSizes[0]));
+            gNumPoolSizes = numSizes;
+        } else {
+            errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        }
+    }
+
+    return errorCode;
+}
+
 int32_t uShortRangeMemPoolInit(void)
 {
     int32_t err;
+    uMemPoolSlabSize_t slabSizes[U_MEMPOOL_SLAB_MAX_NUM_SIZES];
+    const uShortRangePbufPoolSize_t *pSizes = gPoolSizes;
+    size_t numSizes = gNumPoolSizes;
+
+    if (numSizes == 0) {
+        // Not configured: count the entries of the default
+        pSizes = gDefaultPoolSizes;
+        while ((numSizes < sizeof(gDefaultPoolSizes) / sizeof(gDefaultPoolSizes[0])) &&
+               (gDefaultPoolSizes[numSizes].dataSize > 0)) {
+            numSizes++;
+        }
+    }
+    for (size_t x = 0; x < numSizes; x++) {
+        slabSizes[x].blockSize = sizeof(uShortRangePbuf_t) + pSizes[x].dataSize;
+        slabSizes[x].numOfBlks = pSizes[x].count;
+    }
 
-    err = uMemPoolInit(&gPBufListPool, sizeof(uShortRangePbufList_t),
-                       U_SHORT_RANGE_PBUFLIST_COUNT);
+    memset(gChannelBytes, 0, sizeof(gChannelBytes));
+    err = uPortMutexCreate(&gMutex);
 
     if (err == 0) {
+        err = uMemPoolInit(&gPBufListPool, sizeof(uShortRangePbufList_t),
+                           U_SHORT_RANGE_PBUFLIST_COUNT);
+        if (err == 0) {
 
-        err = uMemPoolInit(&gPBufPool, sizeof(uShortRangePbuf_t) + U_SHORT_RANGE_EDM_BLK_SIZE,
-                           U_SHORT_RANGE_EDM_BLK_COUNT);
+            err = uMemPoolSlabInit(&gPBufSlab, slabSizes, numSizes);
 
+            if (err != (int32_t)U_ERROR_COMMON_SUCCESS) {
+                uMemPoolDeinit(&gPBufListPool);
+            }
+        }
         if (err != (int32_t)U_ERROR_COMMON_SUCCESS) {
-            uMemPoolDeinit(&gPBufListPool);
+            uPortMutexDelete(gMutex);
+            gMutex = NULL;
         }
     }
 
@@ -100,20 +211,80 @@ int32_t uShortRangeMemPoolInit(void)
 
 void uShortRangeMemPoolDeInit(void)
 {
-    uMemPoolDeinit(&gPBufPool);
+    uMemPoolSlabDeinit(&gPBufSlab);
     uMemPoolDeinit(&gPBufListPool);
+    if (gMutex != NULL) {
+        uPortMutexDelete(gMutex);
+        gMutex = NULL;
+    }
+}
+
+int32_t uShortRangeMemPoolGetStats(uShortRangePbufPoolStats_t *pStats,
+                                   size_t numStats)
+{
+    int32_t numOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uMemPoolDesc_t *pPool;
+
+    if (pStats != NULL) {
+        numOrErrorCode = 0;
+        for (size_t x = 0; (x < gPBufSlab.numPools) && (x < numStats); x++) {
+            pPool = &(gPBufSlab.pool[x]);
+            U_PORT_MUTEX_LOCK(pPool->mutex);
+            pStats[x].dataSize = pPool->blockSize - sizeof(uShortRangePbuf_t);
+            pStats[x].count = pPool->totalBlockCount;
+            pStats[x].usedCount = pPool->usedBlockCount;
+            pStats[x].peakUsedCount = pPool->peakUsedBlockCount;
+            pStats[x].allocFailCount = pPool->allocFailCount;
+            U_PORT_MUTEX_UNLOCK(pPool->mutex);
+            numOrErrorCode++;
+        }
+    }
+
+    return numOrErrorCode;
+}
+
+int32_t uShortRangePbufChannelBytes(int8_t edmChannel)
+{
+    int32_t count = 0;
+
+    if (gMutex != NULL) {
+        U_PORT_MUTEX_LOCK(gMutex);
+        count = gChannelBytes[(uint8_t) edmChannel];
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return count;
 }
 
 int32_t uShortRangePbufAlloc(uShortRangePbuf_t **ppBuf)
 {
-    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-    *ppBuf = (uShortRangePbuf_t *)uMemPoolAllocMem(&gPBufPool);
-    if (*ppBuf != NULL) {
-        (*ppBuf)->length = 0;
-        (*ppBuf)->pNext = NULL;
-        errorCode = gPBufPool.blockSize - sizeof(uShortRangePbuf_t);
+    return uShortRangePbufAllocSize(ppBuf, 0);
+}
+
+int32_t uShortRangePbufAllocSize(uShortRangePbuf_t **ppBuf, size_t size)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    size_t first = 0;
+
+    *ppBuf = NULL;
+    if (gPBufSlab.numPools > 0) {
+        // Find the smallest size class that holds size, or
+        // the largest if none do
+        while ((first + 1 < gPBufSlab.numPools) &&
+               (gPBufSlab.pool[first].blockSize - sizeof(uShortRangePbuf_t) < size)) {
+            first++;
+        }
+        // Try that and then the larger ones, then the smaller ones:
+        // it is better to chain smaller pbufs than to wait
+        for (size_t x = first; (x < gPBufSlab.numPools) && (*ppBuf == NULL); x++) {
+            sizeOrErrorCode = allocPbuf(x, ppBuf);
+        }
+        for (size_t x = first; (x > 0) && (*ppBuf == NULL); x--) {
+            sizeOrErrorCode = allocPbuf(x - 1, ppBuf);
+        }
     }
-    return errorCode;
+
+    return sizeOrErrorCode;
 }
 
 uShortRangePbufList_t *pUShortRangePbufListAlloc(void)
@@ -129,7 +300,8 @@ uShortRangePbufList_t *pUShortRangePbufListAlloc(void)
 void uShortRangePbufListFree(uShortRangePbufList_t *pBufList)
 {
     if (pBufList != NULL) {
-        freePbuf(pBufList->pBufHead, true);
+        channelBytesAdjust(pBufList->edmChannel,
+                           -freePbuf(pBufList->pBufHead, true));
         pBufList->totalLen = 0;
         uMemPoolFreeMem(&gPBufListPool, pBufList);
     }
@@ -147,6 +319,7 @@ int32_t uShortRangePbufListAppend(uShortRangePbufList_t *pBufList, uShortRangePb
         }
         pBufList->pBufTail = pBuf;
         pBufList->totalLen += pBuf->length;
+        channelBytesAdjust(pBufList->edmChannel, pBuf->size);
 
         err = (int32_t)U_ERROR_COMMON_SUCCESS;
     }
@@ -161,12 +334,24 @@ void uShortRangePbufListMerge(uShortRangePbufList_t *pOldList, uShortRangePbufLi
         (pOldList->totalLen > 0) &&
         (pNewList->totalLen > 0)) {
 
+        if (pNewList->edmChannel != pOldList->edmChannel) {
+            // Move the pbufs to the channel of the old list
+            int32_t size = 0;
+            for (uShortRangePbuf_t *pBuf = pNewList->pBufHead; pBuf != NULL; pBuf = pBuf->pNext) {
+                size += pBuf->size;
+            }
+            channelBytesAdjust(pNewList->edmChannel, -size);
+            channelBytesAdjust(pOldList->edmChannel, size);
+        }
+
         if (pOldList->pBufTail != NULL) {
             pOldList->pBufTail->pNext = pNewList->pBufHead;
             pOldList->pBufTail = pNewList->pBufTail;
             pOldList->totalLen += pNewList->totalLen;
         } else {
+            int8_t edmChannel = pOldList->edmChannel;
             *pOldList = *pNewList;
+            pOldList->edmChannel = edmChannel;
         }
 
         uMemPoolFreeMem(&gPBufListPool, pNewList);
@@ -183,8 +368,8 @@ size_t uShortRangePbufListConsumeData(uShortRangePbufList_t *pBufList, char *pDa
     if ((pBufList != NULL) && (pData != NULL)) {
 
         for (pTemp = pBufList->pBufHead; (len != 0 && pTemp != NULL); pTemp = pNext) {
-            // Basic sanity check - pbuf length should never be longer than pool block size
-            U_ASSERT(pTemp->length <= gPBufPool.blockSize);
+            // Basic sanity check - pbuf length should never be longer than its size
+            U_ASSERT(pTemp->length <= pTemp->size);
 
             if (pTemp->length <= len) {
                 // Copy the data to the given buffer
@@ -194,7 +379,7 @@ size_t uShortRangePbufListConsumeData(uShortRangePbufList_t *pBufList, char *pDa
                 len -= pTemp->length;
                 pNext = pTemp->pNext;
                 // We are done with this pbuf - put it back in the pool
-                freePbuf(pTemp, false);
+                channelBytesAdjust(pBufList->edmChannel, -freePbuf(pTemp, false));
                 pBufList->pBufHead = pNext;
                 if (pBufList->pBufHead == NULL) {
                     pBufList->pBufTail = NULL;
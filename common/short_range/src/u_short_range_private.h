@@ -126,6 +126,8 @@ typedef struct uShortRangePrivateInstance_t {
 //lint -esym(768, uShortRangePrivateInstance_t::pBtDataAvailableCallback)
     void (*pBtDataAvailableCallback)(int32_t, void *);
     void *pBtDataCallbackParameter;
+    void *pWifiScanCache; /**< the Wi-Fi scan cache, owned by u_wifi.c,
+                               freed with the instance. */
     struct uShortRangePrivateInstance_t *pNext;
 } uShortRangePrivateInstance_t;
 
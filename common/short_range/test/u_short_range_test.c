@@ -247,6 +247,58 @@ U_PORT_TEST_FUNCTION("[shortRange]", "shortRangeUartSetBaudrate")
     U_TEST_PRINT_LINE("shortRangeUartSetBaudrate succeded.");
 }
 
+#if (U_CFG_APP_PIN_SHORT_RANGE_CTS >= 0) && (U_CFG_APP_PIN_SHORT_RANGE_RTS >= 0)
+
+/** Short range baud rate upgrade on open test; requires flow control.
+ */
+U_PORT_TEST_FUNCTION("[shortRange]", "shortRangeUartBaudrateUpgrade")
+{
+    int32_t baudRate;
+    uShortRangeUartConfig_t uart = { .uartPort = U_CFG_APP_SHORT_RANGE_UART,
+                                     .baudRate = U_SHORT_RANGE_UART_BAUD_RATE,
+                                     .pinTx = U_CFG_APP_PIN_SHORT_RANGE_TXD,
+                                     .pinRx = U_CFG_APP_PIN_SHORT_RANGE_RXD,
+                                     .pinCts = U_CFG_APP_PIN_SHORT_RANGE_CTS,
+                                     .pinRts = U_CFG_APP_PIN_SHORT_RANGE_RTS
+                                   };
+    uPortDeinit();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+    U_PORT_TEST_ASSERT(uShortRangeInit() == 0);
+
+    U_TEST_PRINT_LINE("opening with baud rate upgrade to 460800.");
+    baudRate = uShortRangeOpenUartBaudrateUpgrade(U_CFG_TEST_SHORT_RANGE_MODULE_TYPE,
+                                                  &uart, 460800,
+                                                  &gHandles.devHandle);
+    U_TEST_PRINT_LINE("baud rate is now %d.", baudRate);
+    U_PORT_TEST_ASSERT(baudRate >= U_SHORT_RANGE_UART_BAUD_RATE);
+    U_PORT_TEST_ASSERT(uShortRangeAttention(gHandles.devHandle) == 0);
+
+    // Opening again should go straight to the stored rate
+    uShortRangeClose(gHandles.devHandle);
+    U_PORT_TEST_ASSERT(uShortRangeOpenUartBaudrateUpgrade(U_CFG_TEST_SHORT_RANGE_MODULE_TYPE,
+                                                          &uart, 460800,
+                                                          &gHandles.devHandle) == baudRate);
+    U_PORT_TEST_ASSERT(uShortRangeAttention(gHandles.devHandle) == 0);
+
+    if (baudRate != U_SHORT_RANGE_UART_BAUD_RATE) {
+        // Put the module back to the default rate, and store it,
+        // so as not to upset the other tests
+        U_PORT_TEST_ASSERT(uShortRangeSetBaudrate(&gHandles.devHandle, &uart) == 0);
+        U_PORT_TEST_ASSERT(uShortRangeAtClientHandleGet(gHandles.devHandle,
+                                                        &gHandles.atClientHandle) == 0);
+        uAtClientLock(gHandles.atClientHandle);
+        uAtClientCommandStart(gHandles.atClientHandle, "AT&W");
+        uAtClientCommandStopReadResponse(gHandles.atClientHandle);
+        U_PORT_TEST_ASSERT(uAtClientUnlock(gHandles.atClientHandle) == 0);
+    }
+    uShortRangeTestPrivateCleanup(&gHandles);
+    U_TEST_PRINT_LINE("shortRangeUartBaudrateUpgrade succeded.");
+}
+
+#endif
+
 #if defined(U_CFG_APP_PIN_SHORT_RANGE_RESET_TO_DEFAULTS) && (U_CFG_APP_PIN_SHORT_RANGE_RESET_TO_DEFAULTS >= 0)
 
 /** Short range reset to default UART settings test.
@@ -50,6 +50,7 @@
 #include "u_port_os.h"
 #include "u_mempool.h"
 #include "u_short_range_pbuf.h"
+#include "u_ringbuffer.h"
 #include "u_short_range_edm.h" // For U_SHORT_RANGE_EDM_BLK_SIZE
 
 /* ----------------------------------------------------------------
@@ -89,6 +90,30 @@ static int32_t generatePayLoad(uShortRangePbuf_t **ppBuf)
     }
     return errorCode;
 }
+
+// Build an EDM packet of the given type in pBuffer, a negative
+// channel meaning none (AT events); returns the packet length.
+static size_t makeEdmPacket(char *pBuffer, char type, int32_t channel,
+                            const char *pData, size_t length)
+{
+    size_t x = 0;
+    size_t edmLength = length + ((channel >= 0) ? 3 : 2);
+
+    pBuffer[x++] = (char) 0xAA;
+    pBuffer[x++] = (char) (edmLength >> 8);
+    pBuffer[x++] = (char) (edmLength & 0xFF);
+    pBuffer[x++] = 0x00;
+    pBuffer[x++] = type;
+    if (channel >= 0) {
+        pBuffer[x++] = (char) channel;
+    }
+    memcpy(pBuffer + x, pData, length);
+    x += length;
+    pBuffer[x++] = 0x55;
+
+    return x;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: TESTS
  * -------------------------------------------------------------- */
@@ -263,4 +288,365 @@ U_PORT_TEST_FUNCTION("[pbuf]", "pbufPktList")
     U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
 }
 
+U_PORT_TEST_FUNCTION("[pbuf]", "pbufPoolSizes")
+{
+    uShortRangePbufPoolSize_t badSizes[] = {{256, 8}, {64, 8}};
+    uShortRangePbufPoolSize_t tooSmallSizes[] = {{64, 8}, {256, 8}};
+    uShortRangePbufPoolSize_t sizes[] = {{64, 8}, {512, 8}};
+    uShortRangePbufPoolStats_t stats[U_MEMPOOL_SLAB_MAX_NUM_SIZES];
+    uShortRangePbuf_t *pBuf[9];
+    uShortRangePbuf_t *pSmallBuf;
+    int32_t heapUsed;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+
+    U_PORT_TEST_ASSERT(uShortRangeMemPoolConfigure(badSizes, 2) < 0);
+    U_PORT_TEST_ASSERT(uShortRangeMemPoolConfigure(tooSmallSizes, 2) < 0);
+    U_PORT_TEST_ASSERT(uShortRangeMemPoolConfigure(sizes, 2) == 0);
+    U_PORT_TEST_ASSERT(uShortRangeMemPoolInit() == 0);
+
+    // Each request should be met by the smallest class that fits
+    U_PORT_TEST_ASSERT(uShortRangePbufAllocSize(&pSmallBuf, 10) == 64);
+    U_PORT_TEST_ASSERT(uShortRangePbufAllocSize(&pBuf[0], 600) == 512);
+    U_PORT_TEST_ASSERT(uShortRangeMemPoolGetStats(stats, sizeof(stats) / sizeof(stats[0])) == 2);
+    U_PORT_TEST_ASSERT(stats[0].dataSize == 64);
+    U_PORT_TEST_ASSERT(stats[0].count == 8);
+    U_PORT_TEST_ASSERT(stats[0].usedCount == 1);
+    U_PORT_TEST_ASSERT(stats[1].dataSize == 512);
+    U_PORT_TEST_ASSERT(stats[1].usedCount == 1);
+
+    // Exhaust the large class: the next should come from the small one
+    for (size_t x = 1; x < 8; x++) {
+        U_PORT_TEST_ASSERT(uShortRangePbufAllocSize(&pBuf[x], 512) == 512);
+    }
+    U_PORT_TEST_ASSERT(uShortRangePbufAllocSize(&pBuf[8], 512) == 64);
+    for (size_t x = 0; x < sizeof(pBuf) / sizeof(pBuf[0]); x++) {
+        U_PORT_TEST_ASSERT(pBuf[x]->length == 0);
+    }
+    // Free them through a pbuf list
+    uShortRangePbufList_t *pList = pUShortRangePbufListAlloc();
+    U_PORT_TEST_ASSERT(pList != NULL);
+    for (size_t x = 0; x < sizeof(pBuf) / sizeof(pBuf[0]); x++) {
+        U_PORT_TEST_ASSERT(uShortRangePbufListAppend(pList, pBuf[x]) == 0);
+    }
+    U_PORT_TEST_ASSERT(uShortRangePbufChannelBytes(0) == (8 * 512) + 64);
+    uShortRangePbufListFree(pList);
+    U_PORT_TEST_ASSERT(uShortRangePbufChannelBytes(0) == 0);
+    pList = pUShortRangePbufListAlloc();
+    U_PORT_TEST_ASSERT(pList != NULL);
+    U_PORT_TEST_ASSERT(uShortRangePbufListAppend(pList, pSmallBuf) == 0);
+    uShortRangePbufListFree(pList);
+
+    U_PORT_TEST_ASSERT(uShortRangeMemPoolGetStats(stats, sizeof(stats) / sizeof(stats[0])) == 2);
+    U_TEST_PRINT_LINE("%d-byte pbufs: peak %d of %d, %d failure(s).", stats[0].dataSize,
+                      stats[0].peakUsedCount, stats[0].count, stats[0].allocFailCount);
+    U_TEST_PRINT_LINE("%d-byte pbufs: peak %d of %d, %d failure(s).", stats[1].dataSize,
+                      stats[1].peakUsedCount, stats[1].count, stats[1].allocFailCount);
+    U_PORT_TEST_ASSERT(stats[0].usedCount == 0);
+    U_PORT_TEST_ASSERT(stats[0].peakUsedCount == 2);
+    U_PORT_TEST_ASSERT(stats[1].usedCount == 0);
+    U_PORT_TEST_ASSERT(stats[1].peakUsedCount == 8);
+    U_PORT_TEST_ASSERT(stats[1].allocFailCount == 1);
+
+    uShortRangeMemPoolDeInit();
+    // Back to the defaults for everyone else
+    U_PORT_TEST_ASSERT(uShortRangeMemPoolConfigure(NULL, 0) == 0);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
+U_PORT_TEST_FUNCTION("[pbuf]", "pbufEdmParseSpan")
+{
+    int32_t errCode;
+    uShortRangeEdmParser_t *pParser;
+    uShortRangeEdmEvent_t *pEvent = NULL;
+    bool memAvailable = true;
+    int32_t heapUsed;
+    char *pFrames;
+    char *pBuffer;
+    size_t dataLen = 1000;
+    size_t frameLen = dataLen + U_SHORT_RANGE_EDM_DATA_OVERHEAD;
+    size_t totalLen = 1 + (frameLen * 2);
+    size_t offset = 0;
+    size_t length;
+    char *pFrame;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    rand();
+    heapUsed = uPortGetHeapFree();
+
+    errCode = uShortRangeMemPoolInit();
+    U_PORT_TEST_ASSERT(errCode == (int32_t)U_ERROR_COMMON_SUCCESS);
+
+    pParser = (uShortRangeEdmParser_t *)pUPortMalloc(sizeof(*pParser));
+    U_PORT_TEST_ASSERT(pParser != NULL);
+    memset(pParser, 0, sizeof(*pParser));
+
+    pBuffer = (char *)pUPortMalloc(dataLen);
+    U_PORT_TEST_ASSERT(pBuffer != NULL);
+
+    // A junk character followed by two identical EDM data
+    // events on channel 3 carrying random data
+    pFrames = (char *)pUPortMalloc(totalLen);
+    U_PORT_TEST_ASSERT(pFrames != NULL);
+    pFrames[0] = 0x12;
+    pFrame = pFrames + 1;
+    pFrame[0] = (char) 0xAA;
+    pFrame[1] = (char) ((dataLen + 3) >> 8);
+    pFrame[2] = (char) ((dataLen + 3) & 0xFF);
+    pFrame[3] = 0x00;
+    pFrame[4] = 0x31;
+    pFrame[5] = 0x03;
+    for (size_t x = 0; x < dataLen; x++) {
+        pFrame[U_SHORT_RANGE_EDM_DATA_HEAD_SIZE + x] = (char) (rand() % 256);
+    }
+    pFrame[frameLen - 1] = 0x55;
+    memcpy(pFrame + frameLen, pFrame, frameLen);
+
+    // Parse the first frame in small spans, which should
+    // stop exactly at the end of it
+    while ((pEvent == NULL) && (offset < totalLen)) {
+        length = totalLen - offset;
+        if (length > 37) {
+            length = 37;
+        }
+        offset += uShortRangeEdmParseSpan(pParser, pFrames + offset, length,
+                                          &pEvent, &memAvailable);
+        U_PORT_TEST_ASSERT(memAvailable);
+    }
+    U_TEST_PRINT_LINE("first event after %d character(s).", (int32_t) offset);
+    U_PORT_TEST_ASSERT(offset == 1 + frameLen);
+    U_PORT_TEST_ASSERT(pEvent != NULL);
+    U_PORT_TEST_ASSERT(pEvent->type == U_SHORT_RANGE_EDM_EVENT_DATA);
+    U_PORT_TEST_ASSERT(pEvent->params.dataEvent.channel == 3);
+    U_PORT_TEST_ASSERT(pEvent->params.dataEvent.pBufList->totalLen == dataLen);
+    memset(pBuffer, 0, dataLen);
+    length = uShortRangePbufListConsumeData(pEvent->params.dataEvent.pBufList,
+                                            pBuffer, dataLen);
+    U_PORT_TEST_ASSERT(length == dataLen);
+    U_PORT_TEST_ASSERT(memcmp(pBuffer, pFrame + U_SHORT_RANGE_EDM_DATA_HEAD_SIZE, dataLen) == 0);
+    uShortRangePbufListFree(pEvent->params.dataEvent.pBufList);
+
+    // The parser should refuse to consume anything until reset
+    U_PORT_TEST_ASSERT(!uShortRangeEdmParserReady(pParser));
+    U_PORT_TEST_ASSERT(uShortRangeEdmParseSpan(pParser, pFrames + offset, totalLen - offset,
+                                               &pEvent, &memAvailable) == 0);
+    uShortRangeEdmResetParser(pParser);
+
+    // Now the second frame in one go
+    offset += uShortRangeEdmParseSpan(pParser, pFrames + offset, totalLen - offset,
+                                      &pEvent, &memAvailable);
+    U_PORT_TEST_ASSERT(memAvailable);
+    U_PORT_TEST_ASSERT(offset == totalLen);
+    U_PORT_TEST_ASSERT(pEvent != NULL);
+    U_PORT_TEST_ASSERT(pEvent->type == U_SHORT_RANGE_EDM_EVENT_DATA);
+    memset(pBuffer, 0, dataLen);
+    length = uShortRangePbufListConsumeData(pEvent->params.dataEvent.pBufList,
+                                            pBuffer, dataLen);
+    U_PORT_TEST_ASSERT(length == dataLen);
+    U_PORT_TEST_ASSERT(memcmp(pBuffer, pFrame + U_SHORT_RANGE_EDM_DATA_HEAD_SIZE, dataLen) == 0);
+    uShortRangePbufListFree(pEvent->params.dataEvent.pBufList);
+    uShortRangeEdmResetParser(pParser);
+
+    uShortRangeMemPoolDeInit();
+    uPortFree(pFrames);
+    uPortFree(pBuffer);
+    uPortFree(pParser);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
+U_PORT_TEST_FUNCTION("[pbuf]", "pbufEdmChannelQuota")
+{
+    int32_t errCode;
+    uShortRangeEdmParser_t *pParser;
+    uShortRangeEdmEvent_t *pEvent = NULL;
+    uShortRangePbufList_t *pHeld[U_SHORT_RANGE_EDM_BLK_COUNT];
+    size_t numHeld = 0;
+    bool memAvailable = true;
+    int32_t heapUsed;
+    char data[200];
+    char *pPacket;
+    size_t length;
+    size_t consumed;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    rand();
+    heapUsed = uPortGetHeapFree();
+
+    errCode = uShortRangeMemPoolInit();
+    U_PORT_TEST_ASSERT(errCode == (int32_t)U_ERROR_COMMON_SUCCESS);
+
+    pParser = (uShortRangeEdmParser_t *)pUPortMalloc(sizeof(*pParser));
+    U_PORT_TEST_ASSERT(pParser != NULL);
+    memset(pParser, 0, sizeof(*pParser));
+    pPacket = (char *)pUPortMalloc(sizeof(data) + U_SHORT_RANGE_EDM_DATA_OVERHEAD);
+    U_PORT_TEST_ASSERT(pPacket != NULL);
+    for (size_t x = 0; x < sizeof(data); x++) {
+        data[x] = (char) (rand() % 256);
+    }
+
+    // Receive data on channel 3 and don't consume it: packets
+    // should be dropped before the pbuf pool runs dry
+    length = makeEdmPacket(pPacket, 0x31, 3, data, sizeof(data));
+    while ((pParser->droppedCount == 0) && (numHeld < sizeof(pHeld) / sizeof(pHeld[0]))) {
+        consumed = uShortRangeEdmParseSpan(pParser, pPacket, length,
+                                           &pEvent, &memAvailable);
+        U_PORT_TEST_ASSERT(memAvailable);
+        U_PORT_TEST_ASSERT(consumed == length);
+        if (pEvent != NULL) {
+            U_PORT_TEST_ASSERT(pEvent->type == U_SHORT_RANGE_EDM_EVENT_DATA);
+            pHeld[numHeld] = pEvent->params.dataEvent.pBufList;
+            numHeld++;
+            uShortRangeEdmResetParser(pParser);
+        }
+    }
+    U_TEST_PRINT_LINE("channel 3 holds %d byte(s) of pbuf in %d packet(s), %d dropped.",
+                      uShortRangePbufChannelBytes(3), (int32_t) numHeld,
+                      (int32_t) pParser->droppedCount);
+    U_PORT_TEST_ASSERT(pParser->droppedCount == 1);
+    U_PORT_TEST_ASSERT(pEvent == NULL);
+    U_PORT_TEST_ASSERT(uShortRangePbufChannelBytes(3) > 0);
+
+    // Data on another channel and AT should still get through
+    length = makeEdmPacket(pPacket, 0x31, 4, data, sizeof(data));
+    consumed = uShortRangeEdmParseSpan(pParser, pPacket, length, &pEvent, &memAvailable);
+    U_PORT_TEST_ASSERT(memAvailable);
+    U_PORT_TEST_ASSERT(consumed == length);
+    U_PORT_TEST_ASSERT(pEvent != NULL);
+    U_PORT_TEST_ASSERT(pEvent->type == U_SHORT_RANGE_EDM_EVENT_DATA);
+    U_PORT_TEST_ASSERT(pEvent->params.dataEvent.channel == 4);
+    U_PORT_TEST_ASSERT(uShortRangePbufChannelBytes(4) > 0);
+    uShortRangePbufListFree(pEvent->params.dataEvent.pBufList);
+    U_PORT_TEST_ASSERT(uShortRangePbufChannelBytes(4) == 0);
+    uShortRangeEdmResetParser(pParser);
+
+    length = makeEdmPacket(pPacket, 0x41, -1, "\r\nOK\r\n", 6);
+    consumed = uShortRangeEdmParseSpan(pParser, pPacket, length, &pEvent, &memAvailable);
+    U_PORT_TEST_ASSERT(memAvailable);
+    U_PORT_TEST_ASSERT(consumed == length);
+    U_PORT_TEST_ASSERT(pEvent != NULL);
+    U_PORT_TEST_ASSERT(pEvent->type == U_SHORT_RANGE_EDM_EVENT_AT);
+    uShortRangePbufListFree(pEvent->params.atEvent.pBufList);
+    uShortRangeEdmResetParser(pParser);
+
+    // Once channel 3 has been consumed its data flows again
+    for (size_t x = 0; x < numHeld; x++) {
+        uShortRangePbufListFree(pHeld[x]);
+    }
+    U_PORT_TEST_ASSERT(uShortRangePbufChannelBytes(3) == 0);
+    length = makeEdmPacket(pPacket, 0x31, 3, data, sizeof(data));
+    consumed = uShortRangeEdmParseSpan(pParser, pPacket, length, &pEvent, &memAvailable);
+    U_PORT_TEST_ASSERT(consumed == length);
+    U_PORT_TEST_ASSERT(pEvent != NULL);
+    U_PORT_TEST_ASSERT(pParser->droppedCount == 1);
+    uShortRangePbufListFree(pEvent->params.dataEvent.pBufList);
+    uShortRangeEdmResetParser(pParser);
+
+    uShortRangeMemPoolDeInit();
+    uPortFree(pPacket);
+    uPortFree(pParser);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
+U_PORT_TEST_FUNCTION("[pbuf]", "pbufEdmAtRing")
+{
+    int32_t errCode;
+    uShortRangeEdmParser_t *pParser;
+    uShortRangeEdmEvent_t *pEvent = NULL;
+    bool memAvailable = true;
+    int32_t heapUsed;
+    uRingBuffer_t ringBuffer;
+    char linearBuffer[16];
+    const char *pAt = "\r\n+UUWLE:0,0123456789AB,6\r\n";
+    char packet[64];
+    char buffer[64];
+    size_t length;
+    size_t consumed;
+    size_t offset = 0;
+    size_t received = 0;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    rand();
+    heapUsed = uPortGetHeapFree();
+
+    errCode = uShortRangeMemPoolInit();
+    U_PORT_TEST_ASSERT(errCode == (int32_t)U_ERROR_COMMON_SUCCESS);
+
+    pParser = (uShortRangeEdmParser_t *)pUPortMalloc(sizeof(*pParser));
+    U_PORT_TEST_ASSERT(pParser != NULL);
+    memset(pParser, 0, sizeof(*pParser));
+    U_PORT_TEST_ASSERT(uRingBufferCreateSpsc(&ringBuffer, linearBuffer,
+                                             sizeof(linearBuffer)) == 0);
+    pParser->pAtRingBuffer = &ringBuffer;
+
+    // An AT event that is longer than the ring buffer: the parser
+    // should write it straight into the ring buffer, stopping when
+    // the ring buffer is full and carrying on when it is read
+    length = makeEdmPacket(packet, 0x41, -1, pAt, strlen(pAt));
+    memset(buffer, 0, sizeof(buffer));
+    while ((pEvent == NULL) && (offset < length)) {
+        consumed = uShortRangeEdmParseSpan(pParser, packet + offset, length - offset,
+                                           &pEvent, &memAvailable);
+        offset += consumed;
+        if (pEvent == NULL) {
+            U_PORT_TEST_ASSERT(!memAvailable);
+            U_PORT_TEST_ASSERT(uRingBufferAvailableSize(&ringBuffer) == 0);
+        }
+        received += uRingBufferRead(&ringBuffer, buffer + received,
+                                    sizeof(buffer) - received);
+    }
+    U_PORT_TEST_ASSERT(offset == length);
+    U_PORT_TEST_ASSERT(pEvent != NULL);
+    U_PORT_TEST_ASSERT(pEvent->type == U_SHORT_RANGE_EDM_EVENT_AT);
+    // No pbufs involved
+    U_PORT_TEST_ASSERT(pEvent->params.atEvent.pBufList == NULL);
+    U_PORT_TEST_ASSERT(received == strlen(pAt));
+    U_PORT_TEST_ASSERT(memcmp(buffer, pAt, received) == 0);
+    uShortRangeEdmResetParser(pParser);
+
+    uRingBufferDelete(&ringBuffer);
+    uShortRangeMemPoolDeInit();
+    uPortFree(pParser);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
 // End of file
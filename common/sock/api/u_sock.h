@@ -77,6 +77,99 @@ extern "C" {
 # define U_SOCK_CLOSE_TIMEOUT_SECONDS 60
 #endif
 
+#ifndef U_SOCK_DNS_CACHE_NUM_ENTRIES
+/** The number of host names that uSockGetHostByName() will
+ * remember the result of, so that repeated look-ups of the same
+ * host name do not each go out to the network; the least
+ * recently used entry is replaced when the cache is full.  Set
+ * this to 0 to switch the cache off.
+ */
+# define U_SOCK_DNS_CACHE_NUM_ENTRIES 4
+#endif
+
+#ifndef U_SOCK_DNS_CACHE_TTL_SECONDS
+/** How long a successful look-up remains in the cache; the
+ * underlying network layers do not report the TTL of the DNS
+ * record, hence a fixed value is used.
+ */
+# define U_SOCK_DNS_CACHE_TTL_SECONDS 300
+#endif
+
+#ifndef U_SOCK_DNS_CACHE_NEGATIVE_TTL_SECONDS
+/** How long a look-up that failed because the host name could
+ * not be found remains in the cache.
+ */
+# define U_SOCK_DNS_CACHE_NEGATIVE_TTL_SECONDS 10
+#endif
+
+#ifndef U_SOCK_DNS_CACHE_HOST_NAME_MAX_LENGTH_BYTES
+/** The maximum length of a host name that will be cached,
+ * not including the null terminator; longer host names are
+ * always looked up.
+ */
+# define U_SOCK_DNS_CACHE_HOST_NAME_MAX_LENGTH_BYTES 64
+#endif
+
+#ifndef U_SOCK_ASYNC_TASK_STACK_SIZE_BYTES
+/** The stack size of the task in which the asynchronous socket
+ * operations, uSockConnectAsync(), uSockWriteAsync() and
+ * uSockReadAsync(), are performed and their callbacks called;
+ * the task is only created when one of those functions is first
+ * called.
+ */
+# define U_SOCK_ASYNC_TASK_STACK_SIZE_BYTES 2304
+#endif
+
+#ifndef U_SOCK_ASYNC_TASK_PRIORITY
+/** The priority of the task in which the asynchronous socket
+ * operations are performed and their callbacks called.
+ */
+# define U_SOCK_ASYNC_TASK_PRIORITY U_CFG_OS_APP_TASK_PRIORITY
+#endif
+
+#ifndef U_SOCK_POOL_MAX_NUM_SOCKETS
+/** The maximum number of sockets that may be kept open in the
+ * socket pool of uSockPoolConnect(); set this to 0 to disable
+ * pooling, in which case uSockPoolConnect() always makes a new
+ * connection.
+ */
+# define U_SOCK_POOL_MAX_NUM_SOCKETS 2
+#endif
+
+#ifndef U_SOCK_POOL_IDLE_TIMEOUT_SECONDS
+/** How long a socket may sit idle in the socket pool of
+ * uSockPoolConnect() before it is no longer re-used; this should
+ * be less than the time for which the server keeps an idle
+ * connection open.
+ */
+# define U_SOCK_POOL_IDLE_TIMEOUT_SECONDS 120
+#endif
+
+#ifndef U_SOCK_PSK_REFUSED_NUM_ENTRIES
+/** The number of servers that uSockPskConnect() remembers as having
+ * refused a PSK handshake, so that subsequent connections to them
+ * go straight to certificates; set this to 0 to always try PSK
+ * first.
+ */
+# define U_SOCK_PSK_REFUSED_NUM_ENTRIES 4
+#endif
+
+#ifndef U_SOCK_DEFERRED_MAX_NUM_BYTES
+/** The maximum amount of data that uSockWriteDeferred() will hold
+ * back on any one socket; the buffer is only allocated while
+ * there is data waiting to be sent.
+ */
+# define U_SOCK_DEFERRED_MAX_NUM_BYTES 512
+#endif
+
+#ifndef U_SOCK_DEFERRED_TICK_MS
+/** The interval at which the deadlines given to
+ * uSockWriteDeferred() are checked and hence the granularity
+ * with which they are met.
+ */
+# define U_SOCK_DEFERRED_TICK_MS 1000
+#endif
+
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS: SOCKET OPTIONS FOR SOCKET LEVEL (-1)
  * -------------------------------------------------------------- */
@@ -145,6 +238,10 @@ extern "C" {
 
 /** Socket option: receive buffer size. The value matches
  * LWIP which matches the BSD sockets API (see Stevens et al).
+ * For cellular this sets the size of a read-ahead buffer held
+ * in this MCU, which also bounds the amount of received data
+ * held in this MCU for the socket, the rest being left in the
+ * module until it is read; see uCellSockOptionSet().
  */
 #define U_SOCK_OPT_RCVBUF       0x1002
 
@@ -190,6 +287,15 @@ extern "C" {
  */
 #define U_SOCK_OPT_NO_CHECK     0x100a
 
+/** Socket option: the PDP context that the socket uses, an
+ * int32_t; this is not a BSD sockets option, it applies only to
+ * cellular modules where more than one PDP context may be active
+ * at once, see uCellNetActivateContext().  It must be set before
+ * the socket is connected or sent on; by default a socket uses the
+ * PDP context activated by uCellNetConnect()/uCellNetActivate().
+ */
+#define U_SOCK_OPT_PDP_CONTEXT  0x1101
+
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS: SOCKET OPTIONS FOR IP LEVEL (0)
  * -------------------------------------------------------------- */
@@ -265,6 +371,15 @@ extern "C" {
  */
 #define U_SOCK_RECEIVE_TIMEOUT_DEFAULT_MS 10000
 
+/** The number of bins in the read size histogram of
+ * #uSockStats_t: bin 0 counts reads that returned less than 16
+ * bytes, bin 1 less than 32 bytes, and so on, doubling each time,
+ * with the last bin counting anything larger; with the default
+ * of 8 the last bin counts reads of 1024 bytes or more, which is
+ * the largest segment a cellular module will return.
+ */
+#define U_SOCK_STATS_READ_SIZE_NUM_BINS 8
+
 /** Zero a file descriptor set.
  */
 #define U_SOCK_FD_ZERO(pSet) memset(*(pSet), 0, sizeof(*(pSet)))
@@ -285,10 +400,9 @@ extern "C" {
 
 /** Determine if the bit corresponding to a given file descriptor is set.
  */
-#define U_SOCK_FD_ISSET(d, pSet) if (((d) >= 0) &&                           \
-                                     ((d) < U_SOCK_DESCRIPTOR_SET_SIZE)) {   \
-                                     (*(pSet))[(d) / 8] & (1 << ((d) & 7));  \
-                                 }
+#define U_SOCK_FD_ISSET(d, pSet) ((((d) >= 0) &&                                  \
+                                   ((d) < U_SOCK_DESCRIPTOR_SET_SIZE)) &&         \
+                                  (((*(pSet))[(d) / 8] & (1 << ((d) & 7))) != 0))
 
 /* ----------------------------------------------------------------
  * TYPES
@@ -360,6 +474,74 @@ typedef struct {
     int32_t lingerSeconds;  //<! linger time in seconds.
 } uSockLinger_t;
 
+/** A piece of data for uSockWritev() or uSockSendToV(), similar
+ * to the BSD struct iovec.
+ */
+typedef struct {
+    const void *pData;     //<! the data, may be NULL if dataSizeBytes is zero.
+    size_t dataSizeBytes;  //<! the number of bytes at pData.
+} uSockIoVec_t;
+
+/** A datagram for uSockSendToBatch() or uSockReceiveFromBatch(),
+ * similar to the Linux struct mmsghdr.
+ */
+typedef struct {
+    uSockAddress_t address; //<! for uSockSendToBatch() the address
+                            //   to send to, for uSockReceiveFromBatch()
+                            //   populated with the address the datagram
+                            //   came from.
+    void *pData;            //<! the data to send or the buffer to
+                            //   receive into.
+    size_t dataSizeBytes;   //<! the number of bytes to send from, or
+                            //   of storage at, pData.
+    int32_t sizeBytes;      //<! populated with the number of bytes
+                            //   sent or received, else the negated
+                            //   value of errno from u_sock_errno.h.
+} uSockDatagram_t;
+
+/** Run-time statistics for a socket, only collected if
+ * U_CFG_SOCK_STATS is defined; see uSockStatsGet().  A "call"
+ * here is a call into the underlying cellular or Wi-Fi sockets
+ * layer, which for a cellular module usually costs at least one
+ * AT command round trip.  All times are in milliseconds.
+ */
+typedef struct {
+    uint32_t txBytes;        /**< bytes sent. */
+    uint32_t rxBytes;        /**< bytes received. */
+    uint32_t txSegments;     /**< the number of calls that sent data. */
+    uint32_t rxSegments;     /**< the number of calls that received data. */
+    uint32_t numCalls;       /**< the total number of calls, including those
+                                  that failed or found nothing to receive. */
+    uint32_t numWouldBlock;  /**< the number of times U_SOCK_EWOULDBLOCK
+                                  was returned to the application. */
+    uint32_t txBlockedMs;    /**< the total time spent in calls that send. */
+    int32_t connectMs;       /**< the time the last successful connect
+                                  took, -1 if there has been none. */
+    uint32_t numReadsFull;   /**< the number of receive calls that filled
+                                  the buffer they were given, suggesting
+                                  that a larger buffer might have saved a
+                                  call. */
+    uint32_t readSizeHistogram[U_SOCK_STATS_READ_SIZE_NUM_BINS]; /**< the
+                                  sizes of the reads counted in rxSegments,
+                                  see #U_SOCK_STATS_READ_SIZE_NUM_BINS. */
+} uSockStats_t;
+
+/** Completion callback for uSockConnectAsync(), uSockWriteAsync()
+ * and uSockReadAsync().
+ *
+ * @param descriptor      the descriptor of the socket.
+ * @param errorCodeOrSize for uSockConnectAsync() zero on success,
+ *                        for uSockWriteAsync() and uSockReadAsync()
+ *                        the number of bytes sent or received, else
+ *                        the negated value of errno from
+ *                        u_sock_errno.h, e.g. -#U_SOCK_ECONNREFUSED.
+ * @param pParameter      the parameter that was passed to the
+ *                        function that started the operation.
+ */
+typedef void (uSockAsyncCallback_t)(uSockDescriptor_t descriptor,
+                                    int32_t errorCodeOrSize,
+                                    void *pParameter);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: CREATE/OPEN/CLOSE/CLEAN-UP
  * -------------------------------------------------------------- */
@@ -403,6 +585,10 @@ int32_t uSockConnect(uSockDescriptor_t descriptor,
  * call-back using uSockRegisterCallbackClosed() before calling
  * uSockClose().  Also note that closing the socket does NOT
  * free the memory it occupied, see uSockCleanUp() for that.
+ * A socket obtained with uSockPoolConnect() may, rather than
+ * being closed, be kept open in the socket pool, see
+ * uSockPoolConnect(); either way the descriptor must not be used
+ * again by the caller.
  *
  * @param descriptor the descriptor of the socket to be closed.
  * @return           zero on success else negative error code
@@ -411,6 +597,17 @@ int32_t uSockConnect(uSockDescriptor_t descriptor,
  */
 int32_t uSockClose(uSockDescriptor_t descriptor);
 
+/** Close all of the sockets kept open in the socket pool of
+ * uSockPoolConnect() (see u_sock_security.h).  This is done
+ * automatically when a network is taken down with
+ * uNetworkInterfaceDown() and by uSockDeinit().
+ *
+ * @param devHandle the handle of the device whose pooled sockets
+ *                  should be closed; use NULL to close all of
+ *                  them.
+ */
+void uSockPoolFlush(uDeviceHandle_t devHandle);
+
 /** In order to maintain thread-safe operation, when a socket is
  * closed, either locally or by the remote host, it is only marked
  * as closed and the memory is retained, since some other thread
@@ -546,6 +743,25 @@ int32_t uSockSendTo(uSockDescriptor_t descriptor,
                     const uSockAddress_t *pRemoteAddress,
                     const void *pData, size_t dataSizeBytes);
 
+/** Send a single datagram, gathered from several pieces of data,
+ * to the given host: as uSockSendTo() but saves the caller copying
+ * the pieces into one buffer.  The total size of the pieces is
+ * subject to the same limit as for uSockSendTo().
+ *
+ * @param descriptor     the descriptor of the socket.
+ * @param pRemoteAddress the address of the remote host to send to;
+ *                       may be NULL, see uSockSendTo().
+ * @param[in] pIoVec     an array of ioVecCount pieces of data,
+ *                       sent in order.
+ * @param ioVecCount     the number of entries at pIoVec.
+ * @return               on success the number of bytes sent else
+ *                       negative error code (and errno will also
+ *                       be set to a value from u_sock_errno.h).
+ */
+int32_t uSockSendToV(uSockDescriptor_t descriptor,
+                     const uSockAddress_t *pRemoteAddress,
+                     const uSockIoVec_t *pIoVec, size_t ioVecCount);
+
 /** Receive a single datagram from the given host.
  *
  * @param descriptor     the descriptor of the socket.
@@ -571,6 +787,47 @@ int32_t uSockReceiveFrom(uSockDescriptor_t descriptor,
                          uSockAddress_t *pRemoteAddress,
                          void *pData, size_t dataSizeBytes);
 
+/** Send several datagrams, each to the address given in its entry,
+ * one after the other; the underlying layer may then avoid a round
+ * trip per datagram, e.g. a cellular module in hex mode (see
+ * uCellSockHexModeOn()) has the datagrams pipelined to it.  Sending
+ * stops at the first datagram that fails.
+ *
+ * @param descriptor        the descriptor of the socket.
+ * @param[in,out] pDatagrams an array of count datagrams; the
+ *                          sizeBytes field of each datagram that
+ *                          was attempted is populated.
+ * @param count             the number of entries at pDatagrams.
+ * @return                  on success the number of datagrams
+ *                          sent, which may be fewer than count,
+ *                          else negative error code (and errno
+ *                          will also be set to a value from
+ *                          u_sock_errno.h).
+ */
+int32_t uSockSendToBatch(uSockDescriptor_t descriptor,
+                         uSockDatagram_t *pDatagrams, size_t count);
+
+/** Receive several datagrams: as uSockReceiveFrom() for the first
+ * datagram, which is waited for if the socket is blocking, after
+ * which as many further datagrams as are already waiting, up to
+ * count, are read back-to-back without waiting.  The pData,
+ * dataSizeBytes pair of each entry is subject to the same rules as
+ * for uSockReceiveFrom() and pData cannot be NULL.
+ *
+ * @param descriptor        the descriptor of the socket.
+ * @param[in,out] pDatagrams an array of count datagrams, the
+ *                          address and sizeBytes fields of those
+ *                          received being populated.
+ * @param count             the number of entries at pDatagrams.
+ * @return                  on success the number of datagrams
+ *                          received, at least one, else negative
+ *                          error code (and errno will also be set
+ *                          to a value from u_sock_errno.h).
+ */
+int32_t uSockReceiveFromBatch(uSockDescriptor_t descriptor,
+                              uSockDatagram_t *pDatagrams,
+                              size_t count);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: STREAM (TCP)
  * -------------------------------------------------------------- */
@@ -587,6 +844,59 @@ int32_t uSockReceiveFrom(uSockDescriptor_t descriptor,
 int32_t uSockWrite(uSockDescriptor_t descriptor,
                    const void *pData, size_t dataSizeBytes);
 
+/** Send data gathered from several pieces: as uSockWrite() but the
+ * pieces are sent together, e.g. a header, payload and trailer
+ * going in a single +USOWR for cellular (up to the segment size of
+ * the module) and a single EDM data frame for Wi-Fi, without the
+ * caller having to copy them into one buffer.
+ *
+ * @param descriptor     the descriptor of the socket.
+ * @param[in] pIoVec     an array of ioVecCount pieces of data,
+ *                       sent in order.
+ * @param ioVecCount     the number of entries at pIoVec.
+ * @return               on success the number of bytes sent else
+ *                       negative error code (and errno will also
+ *                       be set to a value from u_sock_errno.h).
+ */
+int32_t uSockWritev(uSockDescriptor_t descriptor,
+                    const uSockIoVec_t *pIoVec, size_t ioVecCount);
+
+/** Send data that is not urgent: rather than waking the radio
+ * now the data is held back until something else wakes it, so
+ * that several transmissions share one radio wake-up, saving
+ * power.  Data held back is sent when the first of the following
+ * happens:
+ *
+ * - the deadline passes (checked every #U_SOCK_DEFERRED_TICK_MS),
+ * - data is sent, without deferral, or received on any socket of
+ *   the same device,
+ * - for cellular, the module is seen to be connected to the base
+ *   station anyway; this is only known if the +CSCON URC has been
+ *   switched on with uCellNetSetBaseStationConnectionStatusCallback(),
+ * - the socket is closed.
+ *
+ * The data is sent immediately if deadlineMs is zero or less, if
+ * it would not fit in the #U_SOCK_DEFERRED_MAX_NUM_BYTES held back
+ * for the socket or if the radio is already known to be awake,
+ * which is always the case for Wi-Fi.  Data on a socket stays in
+ * order: should data held back not all be sent when the radio
+ * wakes, uSockWrite() and uSockWritev() on that socket fail with
+ * U_SOCK_EWOULDBLOCK until it has.
+ *
+ * @param descriptor     the descriptor of the socket.
+ * @param pData          the data to send.
+ * @param dataSizeBytes  the number of bytes of data to send.
+ * @param deadlineMs     the longest the data may be held back for,
+ *                       in milliseconds.
+ * @return               on success the number of bytes sent or
+ *                       held back else negative error code (and
+ *                       errno will also be set to a value from
+ *                       u_sock_errno.h).
+ */
+int32_t uSockWriteDeferred(uSockDescriptor_t descriptor,
+                           const void *pData, size_t dataSizeBytes,
+                           int32_t deadlineMs);
+
 /** Receive data.
  *
  * @param descriptor     the descriptor of the socket.
@@ -664,6 +974,95 @@ void uSockRegisterCallbackClosed(uSockDescriptor_t descriptor,
                                  void (*pCallback) (void *),
                                  void *pCallbackParameter);
 
+/** Make an outgoing connection on the given socket without waiting
+ * for it to complete: pCallback is called when it does.  Where the
+ * module supports it (SARA-R5, SARA-R422 and LARA-R6) the module is
+ * asked to connect in the background, so that the AT interface
+ * remains free for other sockets in the mean time; otherwise the
+ * connection is made by uSockConnect() in the task where the
+ * asynchronous operations are performed (see
+ * #U_SOCK_ASYNC_TASK_STACK_SIZE_BYTES).  Only one of
+ * uSockConnectAsync() or uSockWriteAsync() may be outstanding on a
+ * socket at any one time.
+ *
+ * The callback is called from the task where the asynchronous
+ * operations are performed; it may call this API, including
+ * starting another asynchronous operation, but should not block
+ * for long as that would hold up the asynchronous operations
+ * of all other sockets.  Should uSockDeinit() be called while an
+ * asynchronous operation is outstanding its callback will not be
+ * called.
+ *
+ * @param descriptor         the descriptor of the socket.
+ * @param[in] pRemoteAddress the address of the remote host to
+ *                           connect to; the structure is copied.
+ * @param[in] pCallback      the callback to be called when the
+ *                           connection attempt completes; cannot
+ *                           be NULL.
+ * @param[in] pParameter     a parameter that will be passed to
+ *                           pCallback; may be NULL.
+ * @return                   zero if the connection attempt has
+ *                           been started else negative error code
+ *                           (and errno will also be set to a value
+ *                           from u_sock_errno.h, e.g. #U_SOCK_EALREADY
+ *                           if another operation is outstanding).
+ */
+int32_t uSockConnectAsync(uSockDescriptor_t descriptor,
+                          const uSockAddress_t *pRemoteAddress,
+                          uSockAsyncCallback_t *pCallback,
+                          void *pParameter);
+
+/** Send data on a TCP socket without waiting for it to be sent:
+ * pCallback is called with the outcome of uSockWrite() once the data
+ * has been handed to the module.  Only one of uSockConnectAsync() or
+ * uSockWriteAsync() may be outstanding on a socket at any one time;
+ * see uSockConnectAsync() for the context in which pCallback is
+ * called.
+ *
+ * @param descriptor     the descriptor of the socket.
+ * @param[in] pData      the data to send; must remain valid until
+ *                       pCallback has been called.
+ * @param dataSizeBytes  the number of bytes of data to send.
+ * @param[in] pCallback  the callback to be called when the data
+ *                       has been sent; cannot be NULL.
+ * @param[in] pParameter a parameter that will be passed to
+ *                       pCallback; may be NULL.
+ * @return               zero if the send has been started else
+ *                       negative error code (and errno will also
+ *                       be set to a value from u_sock_errno.h).
+ */
+int32_t uSockWriteAsync(uSockDescriptor_t descriptor,
+                        const void *pData, size_t dataSizeBytes,
+                        uSockAsyncCallback_t *pCallback,
+                        void *pParameter);
+
+/** Receive data on a TCP socket without waiting for it to arrive:
+ * pCallback is called once data has been received into pData, or
+ * with an error should the socket be closed first.  This is driven
+ * by the data indication from the module, there is no polling.
+ * Only one uSockReadAsync() may be outstanding on a socket at any
+ * one time; see uSockConnectAsync() for the context in which
+ * pCallback is called.
+ *
+ * @param descriptor     the descriptor of the socket.
+ * @param[out] pData     a buffer in which to store the arriving
+ *                       data; must remain valid until pCallback
+ *                       has been called.
+ * @param dataSizeBytes  the number of bytes of storage available
+ *                       at pData.
+ * @param[in] pCallback  the callback to be called when data has
+ *                       been received; cannot be NULL.
+ * @param[in] pParameter a parameter that will be passed to
+ *                       pCallback; may be NULL.
+ * @return               zero if the receive has been started else
+ *                       negative error code (and errno will also
+ *                       be set to a value from u_sock_errno.h).
+ */
+int32_t uSockReadAsync(uSockDescriptor_t descriptor,
+                       void *pData, size_t dataSizeBytes,
+                       uSockAsyncCallback_t *pCallback,
+                       void *pParameter);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: TCP INCOMING (TCP SERVER) ONLY
  * -------------------------------------------------------------- */
@@ -704,6 +1103,20 @@ int32_t uSockAccept(uSockDescriptor_t descriptor,
                     uSockAddress_t *pRemoteAddress);
 
 /** Select: wait for one of a set of sockets to become unblocked.
+ * Readiness is tracked locally from the data and closed indications
+ * of the underlying socket layer, so waiting in this function causes
+ * no traffic with the module.  A socket is ready for reading when
+ * data has arrived that has not yet been read, or when the socket has
+ * been shut down for reading or closed; since a read may not consume
+ * all of the data that has arrived, a socket may occasionally be
+ * reported as ready for reading when a read would find nothing, hence
+ * it is best to use non-blocking sockets with this function.  Writes
+ * never wait for buffer space and so a socket is always ready for
+ * writing.  A socket is in the exceptional condition when it has been
+ * closed; for closure by the remote host to be detected a closed
+ * callback must have been registered with uSockRegisterCallbackClosed(),
+ * which may be done with a NULL callback for this purpose.
+ * On return each set contains only the descriptors that are ready.
  *
  * @param maxDescriptor         the highest numbered descriptor in the
  *                              sets that follow to select on + 1.
@@ -716,10 +1129,14 @@ int32_t uSockAccept(uSockDescriptor_t descriptor,
  * @param pExceptDescriptorSet  the set of descriptors to check for
  *                              exceptional conditions. May be NULL.
  * @param timeMs                the timeout for the select operation
- *                              in milliseconds.
- * @return                      a positive value if an unblock
- *                              occurred, zero on timeout, negative
- *                              on any other error.  Use
+ *                              in milliseconds, zero to return
+ *                              immediately.
+ * @return                      the number of descriptors that are
+ *                              ready, summed across the three sets,
+ *                              if an unblock occurred, zero on
+ *                              timeout, negative on any other error
+ *                              (e.g. a descriptor in a set is not
+ *                              a socket, errno U_SOCK_EBADF).  Use
  *                              #U_SOCK_FD_ISSET() to determine
  *                              which descriptor(s) were unblocked.
  */
@@ -738,6 +1155,33 @@ int32_t uSockSelect(int32_t maxDescriptor,
 
 int32_t uSockGetTotalBytesSent(uSockDescriptor_t descriptor);
 
+/** Get the run-time statistics of a socket; these are only
+ * collected if U_CFG_SOCK_STATS is defined.  The statistics are
+ * reset when the socket is created.
+ *
+ * @param descriptor    the descriptor of the socket.
+ * @param[out] pStats   a place to put the statistics; cannot
+ *                      be NULL.
+ * @return              zero on success else negative error
+ *                      code (and errno will also be set to a
+ *                      value from u_sock_errno.h);
+ *                      U_ERROR_COMMON_NOT_SUPPORTED if
+ *                      U_CFG_SOCK_STATS is not defined.
+ */
+int32_t uSockStatsGet(uSockDescriptor_t descriptor,
+                      uSockStats_t *pStats);
+
+/** Reset the run-time statistics of a socket to zero.
+ *
+ * @param descriptor    the descriptor of the socket.
+ * @return              zero on success else negative error
+ *                      code (and errno will also be set to a
+ *                      value from u_sock_errno.h);
+ *                      U_ERROR_COMMON_NOT_SUPPORTED if
+ *                      U_CFG_SOCK_STATS is not defined.
+ */
+int32_t uSockStatsReset(uSockDescriptor_t descriptor);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: FINDING ADDRESSES
  * -------------------------------------------------------------- */
@@ -767,7 +1211,11 @@ int32_t uSockGetLocalAddress(uSockDescriptor_t descriptor,
 /** Get the IP address of the given host name.  If the host name
  * is already an IP address then the IP address is returned
  * straight away without any external action, hence this also
- * implements "get host by address".
+ * implements "get host by address".  The results of look-ups,
+ * including those where the host could not be found, are cached
+ * for #U_SOCK_DNS_CACHE_TTL_SECONDS (or
+ * #U_SOCK_DNS_CACHE_NEGATIVE_TTL_SECONDS), see
+ * uSockGetHostByNameCacheFlush().
  *
  * @param devHandle      the handle of the underlying network to
  *                       use for host name look-up.
@@ -784,6 +1232,18 @@ int32_t uSockGetLocalAddress(uSockDescriptor_t descriptor,
 int32_t uSockGetHostByName(uDeviceHandle_t devHandle, const char *pHostName,
                            uSockIpAddress_t *pHostIpAddress);
 
+/** Flush the cache of uSockGetHostByName().  This is done
+ * automatically when a network is taken down with
+ * uNetworkInterfaceDown(), when the status of a network for
+ * which a callback has been set with uNetworkSetStatusCallback()
+ * changes, and by uSockDeinit().
+ *
+ * @param devHandle      the handle of the network whose entries
+ *                       should be flushed; use NULL to flush
+ *                       all entries.
+ */
+void uSockGetHostByNameCacheFlush(uDeviceHandle_t devHandle);
+
 
 /* ----------------------------------------------------------------
  * FUNCTIONS: ADDRESS CONVERSION
@@ -866,6 +1326,22 @@ int32_t uSockDomainGetPort(char *pDomainString);
  */
 char *pUSockDomainRemovePort(char *pDomainString);
 
+/* ----------------------------------------------------------------
+ * FUNCTIONS: I/O VECTORS
+ * -------------------------------------------------------------- */
+
+/** Get the total number of bytes in an array of #uSockIoVec_t, as
+ * passed to uSockWritev() or uSockSendToV(), checking it on the way.
+ *
+ * @param[in] pIoVec  an array of ioVecCount pieces of data; may be
+ *                    NULL if ioVecCount is zero.
+ * @param ioVecCount  the number of entries at pIoVec.
+ * @return            the total number of bytes, else negative error
+ *                    code if an entry has a NULL pData but a non-zero
+ *                    dataSizeBytes or the total exceeds INT_MAX.
+ */
+int32_t uSockIoVecSize(const uSockIoVec_t *pIoVec, size_t ioVecCount);
+
 #ifdef __cplusplus
 }
 #endif
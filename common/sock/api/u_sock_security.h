@@ -64,6 +64,87 @@ extern "C" {
 int32_t uSockSecurity(uSockDescriptor_t descriptor,
                       const uSecurityTlsSettings_t *pSettings);
 
+/** Connect a TCP socket to the given server, optionally secured
+ * with TLS, re-using a connection from the socket pool if there is
+ * one: when a socket obtained with this function is closed with
+ * uSockClose() it is, rather than being closed, kept open in the
+ * pool (with U_SOCK_OPT_KEEPALIVE switched on, where supported) for
+ * up to #U_SOCK_POOL_IDLE_TIMEOUT_SECONDS, so that a subsequent call
+ * to this function with the same device, remote address and security
+ * settings can pick it up again, avoiding the cost of TCP and TLS
+ * connection set-up.  This suits applications that make repeated,
+ * short-lived connections to the same server (e.g. an HTTP(S)
+ * POST every few minutes), where the server is known to keep idle
+ * connections open.  Up to #U_SOCK_POOL_MAX_NUM_SOCKETS sockets are
+ * kept in the pool; a socket is not pooled if, when it is closed,
+ * there is unread data on it, an asynchronous operation is
+ * outstanding or it has been shut down.  Before a pooled socket is
+ * handed out it is checked for health: a pooled socket that has
+ * been closed by the server, has timed out or has received data
+ * is closed and a new connection is made.  A re-used socket has its
+ * blocking mode and receive timeout returned to the defaults but
+ * has no callbacks registered, just as a new one.  Pooled sockets
+ * count towards #U_SOCK_MAX_NUM_SOCKETS; they are closed by
+ * uSockPoolFlush(), uSockDeinit() and when the network is taken
+ * down with uNetworkInterfaceDown().
+ *
+ * Note that the server may still close a re-used connection at any
+ * moment, e.g. just after the health check, so the application must
+ * be prepared for a request on a re-used connection to fail and
+ * should, if the request can be repeated, repeat it on a fresh
+ * connection, e.g. after calling uSockPoolFlush().
+ *
+ * @param devHandle           the handle of the device to use.
+ * @param[in] pRemoteAddress  the address of the server; cannot be
+ *                            NULL.
+ * @param[in] pSettings       the TLS security settings to apply,
+ *                            NULL for no security; connections are
+ *                            only re-used where the settings match
+ *                            those of the original connection.
+ * @return                    the descriptor of the connected socket
+ *                            on success else negative error code (and
+ *                            errno will also be set to a value from
+ *                            u_sock_errno.h).
+ */
+int32_t uSockPoolConnect(uDeviceHandle_t devHandle,
+                         const uSockAddress_t *pRemoteAddress,
+                         const uSecurityTlsSettings_t *pSettings);
+
+/** Connect a TCP socket to the given server, secured with TLS,
+ * trying a handshake using a pre-shared key first: a PSK handshake
+ * involves no certificates and so is considerably quicker and
+ * smaller than a certificate-based one, which matters on a slow
+ * radio link such as LTE-M.  The PSK settings are derived from
+ * pSettings: the certificates are dropped, the PSK and PSK ID in
+ * pSettings are used if present (e.g. ones obtained earlier with
+ * uSecurityPskGenerate() and cached by the application), otherwise
+ * the root of trust in the module generates them, and a list of
+ * PSK cipher suites is offered if pSettings gives none.  Should the
+ * PSK connection fail, a connection is made with pSettings exactly
+ * as given; if that succeeds the server is remembered (up to
+ * #U_SOCK_PSK_REFUSED_NUM_ENTRIES of them) as not accepting PSK
+ * and later connections to it go straight to pSettings.
+ *
+ * Supported on cellular modules only, since PSK settings are only
+ * supported there; generation of the PSK by the root of trust
+ * further requires a module that supports u-blox security and has
+ * been security sealed.
+ *
+ * @param devHandle           the handle of the device to use.
+ * @param[in] pRemoteAddress  the address of the server; cannot be
+ *                            NULL.
+ * @param[in] pSettings       the TLS security settings to fall back
+ *                            to, from which the PSK settings are
+ *                            also derived; cannot be NULL.
+ * @return                    the descriptor of the connected socket
+ *                            on success else negative error code (and
+ *                            errno will also be set to a value from
+ *                            u_sock_errno.h).
+ */
+int32_t uSockPskConnect(uDeviceHandle_t devHandle,
+                        const uSockAddress_t *pRemoteAddress,
+                        const uSecurityTlsSettings_t *pSettings);
+
 #ifdef __cplusplus
 }
 #endif
@@ -319,10 +319,12 @@
 #include "sys/time.h"      // mktime() and struct timeval in most cases
 
 #include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h" // U_CFG_OS_APP_TASK_PRIORITY
 
 #include "u_error_common.h"
 
 #include "u_device_shared.h"
+#include "u_device_metrics.h"
 
 #include "u_port_clib_platform_specific.h" /* struct timeval in some cases and
                                               integer stdio, must be included
@@ -332,6 +334,9 @@
 #include "u_port_heap.h"
 #include "u_port_debug.h"
 #include "u_port_os.h"
+#include "u_port_event_queue.h"
+
+#include "u_log_ram_trace.h"
 
 #include "u_sock.h"
 #include "u_sock_security.h"
@@ -339,6 +344,7 @@
 
 #include "u_cell_sec_tls.h"
 #include "u_cell_sock.h"
+#include "u_cell_net.h" // uCellNetGetBaseStationConnection()
 #include "u_wifi_sock.h"
 
 /* ----------------------------------------------------------------
@@ -356,12 +362,38 @@
 # define U_SOCK_NUM_STATIC_SOCKETS     7
 #endif
 
-/** Increment a socket descriptor.
+/** The longest uSockSelect() waits on its semaphore before checking
+ * the descriptors again; the semaphore is binary and so, with more
+ * than one task in uSockSelect(), a task may miss a wake-up, the
+ * check costs no AT traffic.
+ */
+#define U_SOCK_SELECT_WAIT_MAX_MS U_SOCK_RECEIVE_POLL_INTERVAL_MS
+
+#ifdef U_CFG_SOCK_STATS
+/** Macro to mark the start of a timed call into the underlying
+ * socket layer in the statistics.
+ */
+# define STATS_START(pContainer) (pContainer)->socket.statsStartTimeMs = uPortGetTickTimeMs()
+
+/** Macro to record the outcome of a send in the statistics.
+ */
+# define STATS_SEND(pContainer, negErrnoOrSize) statsSend(pContainer, negErrnoOrSize)
+
+/** Macro to record the outcome of a receive in the statistics.
+ */
+# define STATS_RECEIVE(pContainer, negErrnoOrSize, sizeRequested) statsReceive(pContainer, \
+                                                                                negErrnoOrSize, \
+                                                                                sizeRequested)
+
+/** Macro to record the outcome of a connect in the statistics.
  */
-#define U_SOCK_INC_DESCRIPTOR(d)  (d)++;         \
-                                  if ((d) < 0) { \
-                                      d = 0;     \
-                                  }
+# define STATS_CONNECT(pContainer, negErrno) statsConnect(pContainer, negErrno)
+#else
+# define STATS_START(pContainer)
+# define STATS_SEND(pContainer, negErrnoOrSize)
+# define STATS_RECEIVE(pContainer, negErrnoOrSize, sizeRequested)
+# define STATS_CONNECT(pContainer, negErrno)
+#endif
 
 /* ----------------------------------------------------------------
  * TYPES
@@ -371,11 +403,16 @@
  */
 typedef enum {
     U_SOCK_STATE_CREATED,   /**< Freshly created, unsullied. */
+    U_SOCK_STATE_CONNECTING, /**< An asynchronous connect is in
+                                  progress in the module. */
     U_SOCK_STATE_CONNECTED, /**< TCP connected or UDP has an address. */
     U_SOCK_STATE_SHUTDOWN_FOR_READ,  /**< Block all reads. */
     U_SOCK_STATE_SHUTDOWN_FOR_WRITE, /**< Block all writes. */
     U_SOCK_STATE_SHUTDOWN_FOR_READ_WRITE, /**< Block all reads and
                                                writes. */
+    U_SOCK_STATE_POOLED, /**< Closed as far as the user is concerned
+                              but kept connected in the pool of
+                              uSockPoolConnect(). */
     U_SOCK_STATE_CLOSING, /**< Block all reads and writes, waiting
                                for far end to complete closure, can be
                                tidied up. */
@@ -383,6 +420,54 @@ typedef enum {
                                container may be re-used. */
 } uSockState_t;
 
+/** The types of asynchronous operation.
+ */
+typedef enum {
+    U_SOCK_ASYNC_TYPE_NONE,
+    U_SOCK_ASYNC_TYPE_CONNECT,
+    U_SOCK_ASYNC_TYPE_WRITE,
+    U_SOCK_ASYNC_TYPE_READ
+} uSockAsyncType_t;
+
+/** The slots for asynchronous operations on a socket: a read may
+ * be outstanding at the same time as a connect or a write.
+ */
+typedef enum {
+    U_SOCK_ASYNC_SLOT_READ,
+    U_SOCK_ASYNC_SLOT_CONNECT_WRITE,
+    U_SOCK_ASYNC_SLOT_MAX_NUM
+} uSockAsyncSlot_t;
+
+/** An asynchronous operation, protected by gMutexCallbacks.
+ */
+typedef struct {
+    uSockAsyncType_t type; /**< U_SOCK_ASYNC_TYPE_NONE if
+                                the slot is free. */
+    uSockAsyncCallback_t *pCallback;
+    void *pCallbackParameter;
+    void *pData; /**< Not const as it is also used for read. */
+    size_t dataSizeBytes;
+    uSockAddress_t remoteAddress; /**< For a connect. */
+    int32_t errorCodeOrSize; /**< The outcome of a connect
+                                  performed by the module. */
+    bool inModule; /**< True if a connect is being
+                        performed by the module. */
+    bool done; /**< True when the module has reported the
+                    outcome of a connect. */
+    bool posted; /**< True while an event for this slot is
+                      on the event queue. */
+} uSockAsyncOp_t;
+
+/** The parameter of an asynchronous event.
+ */
+typedef struct {
+    uSockDescriptor_t descriptor;
+    uSockAsyncSlot_t slot;
+    bool isDeferred; /**< If true this is not an operation but a
+                          prod to the deferred transmit scheduler,
+                          descriptor and slot are ignored. */
+} uSockAsyncEvent_t;
+
 /** A socket.
  */
 typedef struct {
@@ -403,6 +488,28 @@ typedef struct {
     void *pDataCallbackParameter;
     void (*pClosedCallback) (void *);
     void *pClosedCallbackParameter;
+    uSockAsyncOp_t asyncOp[U_SOCK_ASYNC_SLOT_MAX_NUM];
+#ifdef U_CFG_SOCK_STATS
+    uSockStats_t stats; /**< Run-time statistics. */
+    int32_t statsStartTimeMs; /**< The start time of a timed call into
+                                   the underlying socket layer. */
+#endif
+    char *pDeferred; /**< Data queued by uSockWriteDeferred(), NULL
+                          if there is none. */
+    size_t deferredLength; /**< The number of bytes at pDeferred. */
+    int32_t deferredDeadlineMs; /**< The tick time by which the data
+                                     at pDeferred must be sent. */
+    volatile bool deferredWake; /**< Set when the radio of the device
+                                     is known to be awake, so that the
+                                     data at pDeferred should be sent. */
+    uint32_t poolSettingsHash; /**< The hash of the TLS settings of a
+                                    poolable socket, zero if it is
+                                    not secured. */
+    int32_t pooledTimeMs; /**< When the socket entered the pool. */
+    bool poolable; /**< True if the socket came from
+                        uSockPoolConnect(). */
+    bool poolKeepAliveSet; /**< True once keep-alive has been
+                                switched on for the pool. */
     bool blocking; // At end to optimise structure packing
 } uSockSocket_t;
 
@@ -412,10 +519,33 @@ typedef struct uSockContainer_t {
     struct uSockContainer_t *pPrevious;
     uSockDescriptor_t descriptor;
     uSockSocket_t socket;
+    uPortMutexHandle_t mutex; /**< Held while this socket is in use,
+                                   created with the container and
+                                   kept when it is re-used. */
+    size_t lockCount; /**< The number of tasks that have, or
+                           are waiting for, mutex; protected by
+                           gMutexContainer, the container cannot
+                           be re-used or freed while non-zero. */
     struct uSockContainer_t *pNext;
     bool isStatic; // At end to optimise structure packing
+    volatile bool readReady; /**< Set by dataCallback(), cleared
+                                  when a read is attempted, used
+                                  by uSockSelect(). */
 } uSockContainer_t;
 
+#if U_SOCK_DNS_CACHE_NUM_ENTRIES > 0
+/** An entry in the cache of uSockGetHostByName().
+ */
+typedef struct {
+    uDeviceHandle_t devHandle; /**< NULL if the entry is not in use. */
+    char hostName[U_SOCK_DNS_CACHE_HOST_NAME_MAX_LENGTH_BYTES + 1];
+    uSockIpAddress_t ipAddress;
+    int32_t errnoLocal; /**< U_SOCK_ENONE or the errno of a failed look-up. */
+    int32_t timeMs; /**< when the look-up was performed. */
+    uint32_t lastUsed; /**< for least recently used replacement. */
+} uSockDnsCacheEntry_t;
+#endif
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -424,11 +554,26 @@ typedef struct uSockContainer_t {
  */
 static bool gInitialised = false;
 
-/** Mutex to protect the container list.
+/** The total number of bytes sent on all sockets, registered with
+ * the metrics registry at initialisation.
+ */
+static uDeviceMetric_t gMetricTxBytes = U_DEVICE_METRIC_COUNTER("sock.tx_bytes");
+
+/** The total number of bytes received on all sockets, registered
+ * with the metrics registry at initialisation.
+ */
+static uDeviceMetric_t gMetricRxBytes = U_DEVICE_METRIC_COUNTER("sock.rx_bytes");
+
+/** Mutex to protect the container list and table: the
+ * sockets themselves are protected by the mutex in each
+ * container, so that operations on different sockets can
+ * proceed in parallel.
  */
 static uPortMutexHandle_t gMutexContainer = NULL;
 
-/** Mutex to protect just the callbacks in the container list.
+/** Mutex to protect just the callbacks, including the
+ * asynchronous operations, in the container list, and
+ * gAsyncEventQueue.
  */
 static uPortMutexHandle_t gMutexCallbacks = NULL;
 
@@ -436,14 +581,78 @@ static uPortMutexHandle_t gMutexCallbacks = NULL;
  */
 static uSockContainer_t *gpContainerListHead = NULL;
 
-/** The next descriptor to use.
+/** The containers in use, indexed by descriptor, so that a
+ * container can be found without walking the list; since
+ * uSockCreate() always uses the lowest free descriptor, a
+ * descriptor is never more than U_SOCK_MAX_NUM_SOCKETS - 1.
+ * An entry is written only with gMutexContainer locked but may
+ * be read without it, e.g. from a callback; it may refer to a
+ * container whose socket has since been closed, hence the
+ * descriptor and state of the container must always be checked.
+ */
+static uSockContainer_t *gpContainerTable[U_SOCK_MAX_NUM_SOCKETS] = {0};
+
+/** Semaphore given by the callbacks to wake uSockSelect().
+ */
+static uPortSemaphoreHandle_t gSemaphoreSelect = NULL;
+
+/** The event queue in which asynchronous operations are
+ * performed, opened when first required.
+ */
+static int32_t gAsyncEventQueue = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+
+/** Timer that prods the deferred transmit scheduler every
+ * #U_SOCK_DEFERRED_TICK_MS while there is deferred data, created
+ * when first required.
+ */
+static uPortTimerHandle_t gDeferredTimer = NULL;
+
+/** True while there may be deferred data on a socket, i.e. while
+ * gDeferredTimer is running; protected by gMutexCallbacks.
+ */
+static volatile bool gDeferredActive = false;
+
+/** True while an event for the deferred transmit scheduler is on
+ * gAsyncEventQueue; protected by gMutexCallbacks.
  */
-static uSockDescriptor_t gNextDescriptor = 0;
+static bool gDeferredPosted = false;
 
 /** Containers for statically allocated sockets.
  */
 static uSockContainer_t gStaticContainers[U_SOCK_NUM_STATIC_SOCKETS];
 
+/** Mutex to protect the DNS cache: separate from gMutexContainer
+ * so that the cache can be flushed from a network status callback
+ * while a look-up is in progress.
+ */
+static uPortMutexHandle_t gMutexDnsCache = NULL;
+
+#if U_SOCK_DNS_CACHE_NUM_ENTRIES > 0
+/** The cache of uSockGetHostByName().
+ */
+static uSockDnsCacheEntry_t gDnsCache[U_SOCK_DNS_CACHE_NUM_ENTRIES];
+
+/** Incremented on every use of the DNS cache, for least recently
+ * used replacement.
+ */
+static uint32_t gDnsCacheUseCount = 0;
+#endif
+
+#if U_SOCK_PSK_REFUSED_NUM_ENTRIES > 0
+/** Servers that have refused a PSK handshake from uSockPskConnect(),
+ * protected by gMutexContainer.
+ */
+static uSockAddress_t gPskRefused[U_SOCK_PSK_REFUSED_NUM_ENTRIES];
+
+/** The number of entries in gPskRefused[] that are in use.
+ */
+static size_t gPskRefusedNum = 0;
+
+/** The entry of gPskRefused[] to replace next when it is full.
+ */
+static size_t gPskRefusedNext = 0;
+#endif
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS: MISC
  * -------------------------------------------------------------- */
@@ -464,6 +673,19 @@ static int32_t init()
     if ((errorCode == 0) && (gMutexCallbacks == NULL)) {
         errorCode = uPortMutexCreate(&gMutexCallbacks);
     }
+    if ((errorCode == 0) && (gMutexDnsCache == NULL)) {
+        errorCode = uPortMutexCreate(&gMutexDnsCache);
+    }
+    if ((errorCode == 0) && (gSemaphoreSelect == NULL)) {
+        errorCode = uPortSemaphoreCreate(&gSemaphoreSelect, 0, 1);
+    }
+    // As are the mutexes of the static containers
+    for (size_t x = 0; (errorCode == 0) &&
+         (x < sizeof(gStaticContainers) / sizeof(gStaticContainers[0])); x++) {
+        if (gStaticContainers[x].mutex == NULL) {
+            errorCode = uPortMutexCreate(&(gStaticContainers[x].mutex));
+        }
+    }
 
     if (errorCode == 0) {
         errnoLocal = U_SOCK_ENONE;
@@ -482,6 +704,7 @@ static int32_t init()
                     *ppContainer = &gStaticContainers[x];
                     (*ppContainer)->isStatic = true;
                     (*ppContainer)->socket.state = U_SOCK_STATE_CLOSED;
+                    (*ppContainer)->lockCount = 0;
                     (*ppContainer)->pNext = NULL;
                     if (ppPreviousNext != NULL) {
                         *ppPreviousNext = *ppContainer;
@@ -492,6 +715,9 @@ static int32_t init()
                     ppContainer = &((*ppContainer)->pNext);
                 }
 
+                // Not finding room in the registry is not an error
+                uDeviceMetricRegister(&gMetricTxBytes);
+                uDeviceMetricRegister(&gMetricRxBytes);
                 gInitialised = true;
             }
         }
@@ -504,7 +730,8 @@ static int32_t init()
 static void deinitButNotMutex()
 {
     if (gInitialised) {
-        // IMPORTANT: can't delete the mutexes here as we can't
+        // IMPORTANT: can't delete the mutexes (or the select
+        // semaphore) here as we can't
         // know if anyone has hold of them.  They just have
         // to remain.
 
@@ -515,25 +742,152 @@ static void deinitButNotMutex()
     }
 }
 
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: DNS CACHE
+ * -------------------------------------------------------------- */
+
+// Look up a host name in the DNS cache, returning true and
+// populating pHostIpAddress and pErrnoLocal if it is there and
+// has not expired.
+static bool dnsCacheGet(uDeviceHandle_t devHandle, const char *pHostName,
+                        uSockIpAddress_t *pHostIpAddress,
+                        int32_t *pErrnoLocal)
+{
+    bool found = false;
+#if U_SOCK_DNS_CACHE_NUM_ENTRIES > 0
+    uSockDnsCacheEntry_t *pEntry;
+    int32_t ttlMs;
+
+    U_PORT_MUTEX_LOCK(gMutexDnsCache);
+
+    for (size_t x = 0; (x < sizeof(gDnsCache) / sizeof(gDnsCache[0])) && !found; x++) {
+        pEntry = &(gDnsCache[x]);
+        if ((pEntry->devHandle != NULL) && (pEntry->devHandle == devHandle) &&
+            (strcmp(pEntry->hostName, pHostName) == 0)) {
+            ttlMs = U_SOCK_DNS_CACHE_TTL_SECONDS * 1000;
+            if (pEntry->errnoLocal != U_SOCK_ENONE) {
+                ttlMs = U_SOCK_DNS_CACHE_NEGATIVE_TTL_SECONDS * 1000;
+            }
+            if (uPortGetTickTimeMs() - pEntry->timeMs < ttlMs) {
+                found = true;
+                *pErrnoLocal = pEntry->errnoLocal;
+                if (pEntry->errnoLocal == U_SOCK_ENONE) {
+                    *pHostIpAddress = pEntry->ipAddress;
+                }
+                gDnsCacheUseCount++;
+                pEntry->lastUsed = gDnsCacheUseCount;
+            } else {
+                // Expired, free the entry
+                pEntry->devHandle = NULL;
+            }
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(gMutexDnsCache);
+#else
+    (void) devHandle;
+    (void) pHostName;
+    (void) pHostIpAddress;
+    (void) pErrnoLocal;
+#endif
+
+    return found;
+}
+
+// Add the result of a look-up to the DNS cache; only successes
+// and failures which mean that the host could not be found are
+// cached, not failures of the network or the module.
+static void dnsCacheSet(uDeviceHandle_t devHandle, const char *pHostName,
+                        const uSockIpAddress_t *pHostIpAddress,
+                        int32_t errnoLocal)
+{
+#if U_SOCK_DNS_CACHE_NUM_ENTRIES > 0
+    uSockDnsCacheEntry_t *pEntry = NULL;
+    uSockAddress_t address;
+    size_t length = strlen(pHostName);
+
+    if (((errnoLocal == U_SOCK_ENONE) || (errnoLocal == U_SOCK_ENXIO) ||
+         (errnoLocal == U_SOCK_EHOSTUNREACH)) &&
+        (length <= U_SOCK_DNS_CACHE_HOST_NAME_MAX_LENGTH_BYTES) &&
+        // No point in caching something that is already an IP address
+        (uSockStringToAddress(pHostName, &address) != 0)) {
+
+        U_PORT_MUTEX_LOCK(gMutexDnsCache);
+
+        // Use a free entry, else the least recently used one
+        for (size_t x = 0; x < sizeof(gDnsCache) / sizeof(gDnsCache[0]); x++) {
+            if ((pEntry == NULL) || (gDnsCache[x].devHandle == NULL) ||
+                ((pEntry->devHandle != NULL) &&
+                 (gDnsCacheUseCount - gDnsCache[x].lastUsed >
+                  gDnsCacheUseCount - pEntry->lastUsed))) {
+                pEntry = &(gDnsCache[x]);
+            }
+        }
+        pEntry->devHandle = devHandle;
+        memcpy(pEntry->hostName, pHostName, length + 1);
+        memset(&(pEntry->ipAddress), 0, sizeof(pEntry->ipAddress));
+        if (errnoLocal == U_SOCK_ENONE) {
+            pEntry->ipAddress = *pHostIpAddress;
+        }
+        pEntry->errnoLocal = errnoLocal;
+        pEntry->timeMs = uPortGetTickTimeMs();
+        gDnsCacheUseCount++;
+        pEntry->lastUsed = gDnsCacheUseCount;
+
+        U_PORT_MUTEX_UNLOCK(gMutexDnsCache);
+    }
+#else
+    (void) devHandle;
+    (void) pHostName;
+    (void) pHostIpAddress;
+    (void) errnoLocal;
+#endif
+}
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS: CONTAINER STUFF
  * -------------------------------------------------------------- */
 
+// Get the entry in the container table for the given descriptor,
+// checking that the entry still belongs to that descriptor;
+// returns NULL if there is none.
+// This does not need the mutex to be locked.
+static uSockContainer_t *pContainerTableGet(uSockDescriptor_t descriptor)
+{
+    uSockContainer_t *pContainer = NULL;
+
+    if ((descriptor >= 0) && (descriptor < U_SOCK_MAX_NUM_SOCKETS)) {
+        pContainer = gpContainerTable[descriptor];
+        if ((pContainer != NULL) && (pContainer->descriptor != descriptor)) {
+            pContainer = NULL;
+        }
+    }
+
+    return pContainer;
+}
+
+// Remove the given container from the container table.
+// This does NOT lock the mutex, you need to do that.
+static void containerTableRemove(const uSockContainer_t *pContainer)
+{
+    if ((pContainer->descriptor >= 0) &&
+        (pContainer->descriptor < U_SOCK_MAX_NUM_SOCKETS) &&
+        (gpContainerTable[pContainer->descriptor] == pContainer)) {
+        gpContainerTable[pContainer->descriptor] = NULL;
+    }
+}
+
 // Find the socket container for the given descriptor.
 // Will not find sockets in state CLOSED.
-// This does NOT lock the mutex, you need to do that.
+// This does not need the mutex to be locked but the caller
+// will usually want it locked to keep the socket stable.
 static uSockContainer_t *pContainerFindByDescriptor(uSockDescriptor_t descriptor)
 {
-    uSockContainer_t *pContainer = NULL;
-    uSockContainer_t *pContainerThis = gpContainerListHead;
+    uSockContainer_t *pContainer = pContainerTableGet(descriptor);
 
-    while ((pContainerThis != NULL) &&
-           (pContainer == NULL)) {
-        if ((pContainerThis->descriptor == descriptor) &&
-            (pContainerThis->socket.state != U_SOCK_STATE_CLOSED)) {
-            pContainer = pContainerThis;
-        }
-        pContainerThis = pContainerThis->pNext;
+    if ((pContainer != NULL) &&
+        (pContainer->socket.state == U_SOCK_STATE_CLOSED)) {
+        pContainer = NULL;
     }
 
     return pContainer;
@@ -543,22 +897,25 @@ static uSockContainer_t *pContainerFindByDescriptor(uSockDescriptor_t descriptor
 // and socket handle.  If sockHandle is less than zero,
 // returns the first entry for the given devHandle.
 // Will not find sockets in state CLOSED.
-// This does NOT lock the mutex, you need to do that.
+// This does not need the mutex to be locked, it is called
+// from the callbacks of the underlying socket layer.
 static uSockContainer_t *pContainerFindByDeviceHandle(uDeviceHandle_t devHandle,
                                                       int32_t sockHandle)
 {
     uSockContainer_t *pContainer = NULL;
-    uSockContainer_t *pContainerThis = gpContainerListHead;
-
-    while ((pContainerThis != NULL) &&
-           (pContainer == NULL)) {
-        if ((pContainerThis->socket.devHandle == devHandle) &&
+    uSockContainer_t *pContainerThis;
+
+    for (size_t x = 0; (x < sizeof(gpContainerTable) /
+                        sizeof(gpContainerTable[0])) &&
+         (pContainer == NULL); x++) {
+        pContainerThis = gpContainerTable[x];
+        if ((pContainerThis != NULL) &&
+            (pContainerThis->socket.devHandle == devHandle) &&
             ((pContainerThis->socket.sockHandle == sockHandle) ||
              (pContainerThis->socket.sockHandle < 0)) &&
             (pContainerThis->socket.state != U_SOCK_STATE_CLOSED)) {
             pContainer = pContainerThis;
         }
-        pContainerThis = pContainerThis->pNext;
     }
 
     return pContainer;
@@ -568,19 +925,59 @@ static uSockContainer_t *pContainerFindByDeviceHandle(uDeviceHandle_t devHandle,
 // This does NOT lock the mutex, you need to do that.
 static size_t numContainersInUse()
 {
-    uSockContainer_t *pContainer = gpContainerListHead;
     size_t numInUse = 0;
 
-    while (pContainer != NULL) {
-        if (pContainer->socket.state != U_SOCK_STATE_CLOSED) {
+    for (int32_t x = 0; x < U_SOCK_MAX_NUM_SOCKETS; x++) {
+        if (pContainerFindByDescriptor(x) != NULL) {
             numInUse++;
         }
-        pContainer = pContainer->pNext;
     }
 
     return numInUse;
 }
 
+// Find the container for the given descriptor and lock it, returning
+// NULL if there is no such socket or it is in the pool.  While locked the container will
+// not be re-used or freed.  Must NOT be called with gMutexContainer
+// locked, since the wait for the container may be long, e.g. while
+// another task does a blocking read on the same socket.
+static uSockContainer_t *pContainerLock(uSockDescriptor_t descriptor)
+{
+    uSockContainer_t *pContainer;
+
+    U_PORT_MUTEX_LOCK(gMutexContainer);
+    pContainer = pContainerFindByDescriptor(descriptor);
+    if (pContainer != NULL) {
+        pContainer->lockCount++;
+    }
+    U_PORT_MUTEX_UNLOCK(gMutexContainer);
+
+    if (pContainer != NULL) {
+        uPortMutexLock(pContainer->mutex);
+        if ((pContainer->socket.state == U_SOCK_STATE_CLOSED) ||
+            (pContainer->socket.state == U_SOCK_STATE_POOLED)) {
+            // Closed by someone else while we waited, or
+            // closed by the user and kept in the pool
+            uPortMutexUnlock(pContainer->mutex);
+            U_PORT_MUTEX_LOCK(gMutexContainer);
+            pContainer->lockCount--;
+            U_PORT_MUTEX_UNLOCK(gMutexContainer);
+            pContainer = NULL;
+        }
+    }
+
+    return pContainer;
+}
+
+// Unlock a container locked with pContainerLock().
+static void containerUnlock(uSockContainer_t *pContainer)
+{
+    uPortMutexUnlock(pContainer->mutex);
+    U_PORT_MUTEX_LOCK(gMutexContainer);
+    pContainer->lockCount--;
+    U_PORT_MUTEX_UNLOCK(gMutexContainer);
+}
+
 // Create a socket in a container with the given descriptor.
 // This does NOT lock the mutex, you need to do that.
 static uSockContainer_t *pSockContainerCreate(uSockDescriptor_t descriptor,
@@ -592,9 +989,11 @@ static uSockContainer_t *pSockContainerCreate(uSockDescriptor_t descriptor,
     uSockContainer_t **ppContainerThis = &gpContainerListHead;
 
     // Traverse the list, stopping if there is a container
-    // that holds a closed socket, which we could re-use
+    // that holds a closed socket, which we could re-use,
+    // provided no-one is still hanging on to it
     while ((*ppContainerThis != NULL) && (pContainer == NULL)) {
-        if ((*ppContainerThis)->socket.state == U_SOCK_STATE_CLOSED) {
+        if (((*ppContainerThis)->socket.state == U_SOCK_STATE_CLOSED) &&
+            ((*ppContainerThis)->lockCount == 0)) {
             pContainer = *ppContainerThis;
         }
         pContainerPrevious = *ppContainerThis;
@@ -607,16 +1006,29 @@ static uSockContainer_t *pSockContainerCreate(uSockDescriptor_t descriptor,
         // and add it to the list
         pContainer = (uSockContainer_t *) pUPortMalloc(sizeof (*pContainer));
         if (pContainer != NULL) {
-            pContainer->isStatic = false;
-            pContainer->pPrevious = pContainerPrevious;
-            pContainer->pNext = NULL;
-            *ppContainerThis = pContainer;
+            if (uPortMutexCreate(&(pContainer->mutex)) == 0) {
+                pContainer->isStatic = false;
+                pContainer->lockCount = 0;
+                pContainer->socket.pDeferred = NULL;
+                pContainer->pPrevious = pContainerPrevious;
+                pContainer->pNext = NULL;
+                *ppContainerThis = pContainer;
+            } else {
+                uPortFree(pContainer);
+                pContainer = NULL;
+            }
         }
     }
 
     // Set up the new container and socket
     if (pContainer != NULL) {
+        // A re-used container may still be in the table
+        // under its old descriptor
+        containerTableRemove(pContainer);
         pContainer->descriptor = descriptor;
+        // Deferred data of a socket closed by the far end
+        // is never sent, lose it now
+        uPortFree(pContainer->socket.pDeferred);
         memset(&(pContainer->socket), 0, sizeof(pContainer->socket));
         pContainer->socket.type = type;
         pContainer->socket.protocol = protocol;
@@ -630,46 +1042,42 @@ static uSockContainer_t *pSockContainerCreate(uSockDescriptor_t descriptor,
         pContainer->socket.pDataCallbackParameter = NULL;
         pContainer->socket.pClosedCallback = NULL;
         pContainer->socket.pClosedCallbackParameter = NULL;
+        pContainer->readReady = false;
+        gpContainerTable[descriptor] = pContainer;
     }
 
     return pContainer;
 }
 
-// Free the container corresponding to the descriptor.
-// Has no effect on static containers.
+// Free the container corresponding to the descriptor;
+// a static container is just marked as closed.
 // This does NOT lock the mutex, you need to do that.
 static bool containerFree(uSockDescriptor_t descriptor)
 {
-    uSockContainer_t **ppContainer = NULL;
-    uSockContainer_t **ppContainerThis = &gpContainerListHead;
+    uSockContainer_t *pContainer = pContainerTableGet(descriptor);
     bool success = false;
 
-    while ((*ppContainerThis != NULL) &&
-           (ppContainer == NULL)) {
-        if ((*ppContainerThis)->descriptor == descriptor) {
-            ppContainer = ppContainerThis;
-        } else {
-            ppContainerThis = &((*ppContainerThis)->pNext);
-        }
-    }
-
-    if ((ppContainer != NULL) && (*ppContainer != NULL)) {
-        if (!(*ppContainer)->isStatic) {
+    if (pContainer != NULL) {
+        containerTableRemove(pContainer);
+        if (!pContainer->isStatic) {
             // If we found it, and it wasn't static, free it
             // If there is a previous container, move its pNext
-            if ((*ppContainer)->pPrevious != NULL) {
-                (*ppContainer)->pPrevious->pNext = (*ppContainer)->pNext;
+            if (pContainer->pPrevious != NULL) {
+                pContainer->pPrevious->pNext = pContainer->pNext;
+            } else {
+                gpContainerListHead = pContainer->pNext;
             }
             // If there is a next container, move its pPrevious
-            if ((*ppContainer)->pNext != NULL) {
-                (*ppContainer)->pNext->pPrevious = (*ppContainer)->pPrevious;
+            if (pContainer->pNext != NULL) {
+                pContainer->pNext->pPrevious = pContainer->pPrevious;
             }
 
-            // Free the memory and NULL the pointer
-            uPortFree(*ppContainer);
-            *ppContainer = NULL;
+            // Free the memory
+            uPortMutexDelete(pContainer->mutex);
+            uPortFree(pContainer);
         } else {
-            // Nothing to do for a static container,
+            // A static container stays in the list for re-use
+            pContainer->socket.state = U_SOCK_STATE_CLOSED;
         }
 
         success = true;
@@ -678,10 +1086,144 @@ static bool containerFree(uSockDescriptor_t descriptor)
     return success;
 }
 
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: STATISTICS
+ * -------------------------------------------------------------- */
+
+#ifdef U_CFG_SOCK_STATS
+
+// Record the outcome of a send, started with STATS_START(),
+// in the statistics of a socket.
+static void statsSend(uSockContainer_t *pContainer,
+                      int32_t negErrnoOrSize)
+{
+    uSockStats_t *pStats = &(pContainer->socket.stats);
+
+    pStats->numCalls++;
+    pStats->txBlockedMs += (uint32_t) (uPortGetTickTimeMs() -
+                                       pContainer->socket.statsStartTimeMs);
+    if (negErrnoOrSize > 0) {
+        pStats->txBytes += (uint32_t) negErrnoOrSize;
+        pStats->txSegments++;
+    } else if (negErrnoOrSize == -U_SOCK_EWOULDBLOCK) {
+        pStats->numWouldBlock++;
+    }
+}
+
+// Record the receipt of size bytes into a buffer of sizeRequested
+// bytes in the statistics of a socket.
+static void statsRead(uSockContainer_t *pContainer,
+                      int32_t size, size_t sizeRequested)
+{
+    uSockStats_t *pStats = &(pContainer->socket.stats);
+    size_t bin = 0;
+
+    if (size > 0) {
+        pStats->rxBytes += (uint32_t) size;
+        pStats->rxSegments++;
+        if ((size_t) size >= sizeRequested) {
+            pStats->numReadsFull++;
+        }
+        while ((bin < U_SOCK_STATS_READ_SIZE_NUM_BINS - 1) &&
+               (size >= (16 << bin))) {
+            bin++;
+        }
+        pStats->readSizeHistogram[bin]++;
+    }
+}
+
+// Record the outcome of a receive into a buffer of sizeRequested
+// bytes in the statistics of a socket.
+static void statsReceive(uSockContainer_t *pContainer,
+                         int32_t negErrnoOrSize, size_t sizeRequested)
+{
+    pContainer->socket.stats.numCalls++;
+    statsRead(pContainer, negErrnoOrSize, sizeRequested);
+}
+
+// Record the outcome of a connect, started with STATS_START(),
+// in the statistics of a socket.
+static void statsConnect(uSockContainer_t *pContainer, int32_t negErrno)
+{
+    uSockStats_t *pStats = &(pContainer->socket.stats);
+
+    pStats->numCalls++;
+    if (negErrno == 0) {
+        pStats->connectMs = uPortGetTickTimeMs() -
+                            pContainer->socket.statsStartTimeMs;
+    }
+}
+
+// Reset the statistics of a socket.
+static void statsReset(uSockContainer_t *pContainer)
+{
+    memset(&(pContainer->socket.stats), 0, sizeof(pContainer->socket.stats));
+    pContainer->socket.stats.connectMs = -1;
+}
+
+#endif // #ifdef U_CFG_SOCK_STATS
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS: CALLBACKS
  * -------------------------------------------------------------- */
 
+// Post an event for the asynchronous operation in the given
+// slot of the given container, if there is one and an event
+// for it is not already on the queue.
+// gMutexCallbacks must be locked.
+static void asyncPost(uSockContainer_t *pContainer,
+                      uSockAsyncSlot_t slot)
+{
+    uSockAsyncOp_t *pOp = &(pContainer->socket.asyncOp[slot]);
+    uSockAsyncEvent_t event;
+
+    if ((pOp->type != U_SOCK_ASYNC_TYPE_NONE) && !pOp->posted &&
+        (gAsyncEventQueue >= 0)) {
+        event.descriptor = pContainer->descriptor;
+        event.slot = slot;
+        event.isDeferred = false;
+        if (uPortEventQueueSend(gAsyncEventQueue, &event, sizeof(event)) == 0) {
+            pOp->posted = true;
+        }
+    }
+}
+
+// Callback for when an asynchronous connect performed by
+// the underlying cell socket layer completes.
+static void connectCallback(uDeviceHandle_t devHandle,
+                            int32_t sockHandle, int32_t negErrno)
+{
+    uSockContainer_t *pContainer;
+    uSockAsyncOp_t *pOp;
+
+    // Don't lock the container mutex here, as for the
+    // other callbacks
+    pContainer = pContainerFindByDeviceHandle(devHandle,
+                                              sockHandle);
+    if (pContainer != NULL) {
+        U_PORT_MUTEX_LOCK(gMutexCallbacks);
+        pOp = &(pContainer->socket.asyncOp[U_SOCK_ASYNC_SLOT_CONNECT_WRITE]);
+        if ((pOp->type == U_SOCK_ASYNC_TYPE_CONNECT) &&
+            pOp->inModule && !pOp->done) {
+            pOp->errorCodeOrSize = negErrno;
+            pOp->done = true;
+            if (pContainer->socket.state == U_SOCK_STATE_CONNECTING) {
+                STATS_CONNECT(pContainer, negErrno);
+                pContainer->socket.state = U_SOCK_STATE_CREATED;
+                if (negErrno == 0) {
+                    memcpy(&pContainer->socket.remoteAddress,
+                           &(pOp->remoteAddress),
+                           sizeof(pContainer->socket.remoteAddress));
+                    pContainer->socket.state = U_SOCK_STATE_CONNECTED;
+                }
+            }
+            // Let the event queue call the user
+            asyncPost(pContainer, U_SOCK_ASYNC_SLOT_CONNECT_WRITE);
+        }
+        U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+    }
+}
+
 // Callback for when local socket closures at the underlying
 // cell/wifi socket layer happen asynchronously, either
 // due to local closure or by the remote host
@@ -707,7 +1249,58 @@ static void closedCallback(uDeviceHandle_t devHandle,
         // context
         uSecurityTlsRemove(pContainer->socket.pSecurityContext);
         pContainer->socket.pSecurityContext = NULL;
+        // Any asynchronous operations can now complete, with
+        // an error
+        for (size_t x = 0; x < U_SOCK_ASYNC_SLOT_MAX_NUM; x++) {
+            asyncPost(pContainer, (uSockAsyncSlot_t) x);
+        }
         U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+        // Wake up anyone in uSockSelect()
+        uPortSemaphoreGive(gSemaphoreSelect);
+    }
+}
+
+// Post an event to the deferred transmit scheduler, if one
+// is not already on the queue.
+// gMutexCallbacks must be locked.
+static void deferredPost()
+{
+    uSockAsyncEvent_t event;
+
+    if (!gDeferredPosted && (gAsyncEventQueue >= 0)) {
+        event.descriptor = -1;
+        event.slot = U_SOCK_ASYNC_SLOT_MAX_NUM;
+        event.isDeferred = true;
+        if (uPortEventQueueSend(gAsyncEventQueue, &event, sizeof(event)) == 0) {
+            gDeferredPosted = true;
+        }
+    }
+}
+
+// The radio of the given device is known to be awake, e.g.
+// because data has just been sent or received: mark any sockets
+// of the device with deferred data to be sent by the deferred
+// transmit scheduler and prod it.  This does not use the container
+// mutexes and so may be called from a callback.
+// gMutexCallbacks must be locked.
+static void deferredWakeDevice(uDeviceHandle_t devHandle)
+{
+    uSockContainer_t *pContainer;
+    bool wake = false;
+
+    if (gDeferredActive) {
+        for (size_t x = 0; x < U_SOCK_MAX_NUM_SOCKETS; x++) {
+            pContainer = gpContainerTable[x];
+            if ((pContainer != NULL) &&
+                (pContainer->socket.devHandle == devHandle) &&
+                (pContainer->socket.deferredLength > 0)) {
+                pContainer->socket.deferredWake = true;
+                wake = true;
+            }
+        }
+        if (wake) {
+            deferredPost();
+        }
     }
 }
 
@@ -724,11 +1317,19 @@ static void dataCallback(uDeviceHandle_t devHandle,
     pContainer = pContainerFindByDeviceHandle(devHandle,
                                               sockHandle);
     if (pContainer != NULL) {
+        pContainer->readReady = true;
         U_PORT_MUTEX_LOCK(gMutexCallbacks);
         if (pContainer->socket.pDataCallback != NULL) {
             pContainer->socket.pDataCallback(pContainer->socket.pDataCallbackParameter);
         }
+        // Have another go at any asynchronous read
+        asyncPost(pContainer, U_SOCK_ASYNC_SLOT_READ);
+        // The radio is evidently awake: a good moment
+        // to send any deferred data
+        deferredWakeDevice(devHandle);
         U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+        // Wake up anyone in uSockSelect()
+        uPortSemaphoreGive(gSemaphoreSelect);
     }
 }
 
@@ -1053,10 +1654,13 @@ static void printSocketOption(const void *pOptionValue,
  * STATIC FUNCTIONS: RECEIVING
  * -------------------------------------------------------------- */
 
-// Receive data on a socket, either UDP or TCP.
-static int32_t receive(const uSockContainer_t *pContainer,
+// Receive data on a socket, either UDP or TCP; if once is true
+// the underlying layer is asked just once, without any yield,
+// whether the socket is blocking or not.
+static int32_t receive(uSockContainer_t *pContainer,
                        uSockAddress_t *pRemoteAddress,
-                       void *pData, size_t dataSizeBytes)
+                       void *pData, size_t dataSizeBytes,
+                       bool once)
 {
     uDeviceHandle_t devHandle = pContainer->socket.devHandle;
     int32_t sockHandle = pContainer->socket.sockHandle;
@@ -1067,6 +1671,10 @@ static int32_t receive(const uSockContainer_t *pContainer,
     // Run around the loop until a packet of data turns up
     // or we time out or just once if we're non-blocking.
     do {
+        // Clear the flag used by uSockSelect() before
+        // reading: should data arrive while we are reading
+        // dataCallback() will set it again
+        pContainer->readReady = false;
         if (pContainer->socket.protocol == U_SOCK_PROTOCOL_UDP) {
             // UDP style
             if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
@@ -1096,59 +1704,954 @@ static int32_t receive(const uSockContainer_t *pContainer,
                                                dataSizeBytes);
             }
         }
+        STATS_RECEIVE(pContainer, negErrnoOrSize, dataSizeBytes);
+        if (negErrnoOrSize > 0) {
+            uDeviceMetricAdd(&gMetricRxBytes, (uint32_t) negErrnoOrSize);
+        }
         if (negErrnoOrSize < 0) {
-            // Yield for the poll interval
-            uPortTaskBlock(U_SOCK_RECEIVE_POLL_INTERVAL_MS);
+            if (!once) {
+                // Yield for the poll interval
+                uPortTaskBlock(U_SOCK_RECEIVE_POLL_INTERVAL_MS);
+            }
+        } else if ((pContainer->socket.protocol == U_SOCK_PROTOCOL_UDP) ||
+                   (negErrnoOrSize == (int32_t) dataSizeBytes)) {
+            // Another datagram may be waiting or, for TCP, the
+            // buffer was filled and so there may be more data
+            // in the underlying layer, which may not tell us
+            // about it again: err on the side of readiness
+            pContainer->readReady = true;
         }
-    } while ((negErrnoOrSize < 0) &&
+    } while ((negErrnoOrSize < 0) && !once &&
              (pContainer->socket.blocking) &&
              (uPortGetTickTimeMs() - startTimeMs <
               pContainer->socket.receiveTimeoutMs));
 
+#ifdef U_CFG_SOCK_STATS
+    if (negErrnoOrSize == -U_SOCK_EWOULDBLOCK) {
+        pContainer->socket.stats.numWouldBlock++;
+    }
+#endif
+
     return negErrnoOrSize;
 }
 
-/* ----------------------------------------------------------------
- * PUBLIC FUNCTIONS: CREATE/OPEN/CLOSE/CLEAN-UP
- * -------------------------------------------------------------- */
-
-// Create a socket.
-int32_t uSockCreate(uDeviceHandle_t devHandle, uSockType_t type,
-                    uSockProtocol_t protocol)
+// Receive data on a TCP socket, the guts of uSockRead(); if
+// once is true the underlying layer is asked just once, as
+// for receive().
+static int32_t sockRead(uSockDescriptor_t descriptor,
+                        void *pData, size_t dataSizeBytes,
+                        bool once)
 {
-    int32_t descriptorOrError = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_SUCCESS;
     int32_t errnoLocal;
     uSockContainer_t *pContainer = NULL;
-    uSockDescriptor_t descriptor = gNextDescriptor;
-    int32_t sockHandle = -U_SOCK_ENOSYS;
 
     errnoLocal = init();
     if (errnoLocal == U_SOCK_ENONE) {
-        // Check parameters
-        errnoLocal = U_SOCK_ENODEV;
-        if (uDeviceIsValidInstance(U_DEVICE_INSTANCE(devHandle))) {
-            errnoLocal = U_SOCK_EPROTONOSUPPORT;
-            if (((type == U_SOCK_TYPE_STREAM) && (protocol == U_SOCK_PROTOCOL_TCP)) ||
-                ((type == U_SOCK_TYPE_DGRAM) && (protocol == U_SOCK_PROTOCOL_UDP))) {
-                errnoLocal = U_SOCK_ENONE;
+        // Find and lock the container
+        errnoLocal = U_SOCK_EBADF;
+        pContainer = pContainerLock(descriptor);
+        if (pContainer != NULL) {
+            errnoLocal = U_SOCK_EPROTOTYPE;
+            if (pContainer->socket.protocol == U_SOCK_PROTOCOL_TCP) {
+                if (pContainer->socket.state == U_SOCK_STATE_CONNECTED) {
+                    errnoLocal = U_SOCK_EINVAL;
+                    if (((pData == NULL) && (dataSizeBytes > 0)) ||
+                        (dataSizeBytes > INT_MAX)) {
+                        // Invalid argument
+                    } else {
+                        errnoLocal = U_SOCK_ENONE;
+                        if ((pData != NULL) && (dataSizeBytes != 0)) {
+                            // Receive the datagram
+                            errorCodeOrSize = receive(pContainer,
+                                                      NULL, pData,
+                                                      dataSizeBytes,
+                                                      once);
+                            if (errorCodeOrSize < 0) {
+                                // Set errno
+                                errnoLocal = -errorCodeOrSize;
+                            }
+                        }
+                    }
+                } else {
+                    if ((pContainer->socket.state == U_SOCK_STATE_SHUTDOWN_FOR_READ) ||
+                        (pContainer->socket.state == U_SOCK_STATE_SHUTDOWN_FOR_READ_WRITE)) {
+                        // Socket is shut down
+                        errnoLocal = U_SOCK_ESHUTDOWN;
+                    } else if (pContainer->socket.state == U_SOCK_STATE_CLOSING) {
+                        // Not connected mate
+                        errnoLocal = U_SOCK_ENOTCONN;
+                    } else {
+                        // No route to host?
+                        errnoLocal = U_SOCK_EHOSTUNREACH;
+                    }
+                }
             }
+            containerUnlock(pContainer);
         }
     }
 
-    if (errnoLocal == U_SOCK_ENONE) {
-
-        U_PORT_MUTEX_LOCK(gMutexContainer);
-
+    if (errnoLocal != U_SOCK_ENONE) {
+        // Write the errno
+        errno = errnoLocal;
+        errorCodeOrSize = (int32_t) U_ERROR_COMMON_BSD_ERROR;
+    }
+
+    return errorCodeOrSize;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: SELECT
+ * -------------------------------------------------------------- */
+
+// Find the socket container for the given descriptor for
+// uSockSelect(): unlike pContainerFindByDescriptor() this WILL
+// find a socket in state CLOSED, since a socket closed by the
+// remote host should be reported by uSockSelect(), up until
+// uSockCleanUp() is called.
+// This does NOT lock the mutex, you need to do that.
+static uSockContainer_t *pContainerFindForSelect(uSockDescriptor_t descriptor)
+{
+    uSockContainer_t *pContainer = pContainerTableGet(descriptor);
+
+    if ((pContainer != NULL) && (pContainer->socket.devHandle == NULL)) {
+        pContainer = NULL;
+    }
+
+    return pContainer;
+}
+
+// Check the readiness of the descriptors in the input sets,
+// writing the ones that are ready to the output sets (which
+// must have been zeroed) and returning the number of bits set
+// in them, or negative errno.  Any of the set pointers may be
+// NULL, but if an input set pointer is non-NULL so must the
+// corresponding output set pointer be.  Writing to a socket
+// never waits for buffer space in the underlying layer and so
+// a socket is always ready for writing.
+// This does NOT lock the mutex, you need to do that.
+static int32_t selectCheck(int32_t maxDescriptor,
+                           const uSockDescriptorSet_t *pReadIn,
+                           const uSockDescriptorSet_t *pWriteIn,
+                           const uSockDescriptorSet_t *pExceptIn,
+                           uSockDescriptorSet_t *pReadOut,
+                           uSockDescriptorSet_t *pWriteOut,
+                           uSockDescriptorSet_t *pExceptOut)
+{
+    int32_t negErrnoOrCount = 0;
+    const uSockContainer_t *pContainer;
+    uint8_t mask;
+    size_t index;
+    bool closed;
+
+    for (int32_t d = 0; (d < maxDescriptor) && (negErrnoOrCount >= 0); d++) {
+        index = (size_t) d / 8;
+        mask = (uint8_t) (1U << (d & 7));
+        if (((pReadIn != NULL) && (((*pReadIn)[index] & mask) != 0)) ||
+            ((pWriteIn != NULL) && (((*pWriteIn)[index] & mask) != 0)) ||
+            ((pExceptIn != NULL) && (((*pExceptIn)[index] & mask) != 0))) {
+            pContainer = pContainerFindForSelect(d);
+            if (pContainer != NULL) {
+                // A read from a closed or shut-down socket
+                // returns immediately and so counts as ready
+                closed = (pContainer->socket.state == U_SOCK_STATE_CLOSING) ||
+                         (pContainer->socket.state == U_SOCK_STATE_CLOSED);
+                if ((pReadIn != NULL) && (((*pReadIn)[index] & mask) != 0) &&
+                    (closed || pContainer->readReady ||
+                     (pContainer->socket.state == U_SOCK_STATE_SHUTDOWN_FOR_READ) ||
+                     (pContainer->socket.state == U_SOCK_STATE_SHUTDOWN_FOR_READ_WRITE))) {
+                    (*pReadOut)[index] |= mask;
+                    negErrnoOrCount++;
+                }
+                if ((pWriteIn != NULL) && (((*pWriteIn)[index] & mask) != 0)) {
+                    (*pWriteOut)[index] |= mask;
+                    negErrnoOrCount++;
+                }
+                if ((pExceptIn != NULL) && (((*pExceptIn)[index] & mask) != 0) &&
+                    closed) {
+                    (*pExceptOut)[index] |= mask;
+                    negErrnoOrCount++;
+                }
+            } else {
+                negErrnoOrCount = -U_SOCK_EBADF;
+            }
+        }
+    }
+
+    return negErrnoOrCount;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: DEFERRED TRANSMISSION
+ * -------------------------------------------------------------- */
+
+// Check that the socket in the given container is in a state to
+// be written to, returning U_SOCK_ENONE or an errno value.
+static int32_t writeStateCheck(const uSockContainer_t *pContainer)
+{
+    int32_t errnoLocal = U_SOCK_ENONE;
+
+    if (pContainer->socket.state != U_SOCK_STATE_CONNECTED) {
+        if ((pContainer->socket.state == U_SOCK_STATE_SHUTDOWN_FOR_READ) ||
+            (pContainer->socket.state == U_SOCK_STATE_SHUTDOWN_FOR_READ_WRITE)) {
+            // Socket is shut down
+            errnoLocal = U_SOCK_ESHUTDOWN;
+        } else if (pContainer->socket.state == U_SOCK_STATE_CLOSING) {
+            // Not connected mate
+            errnoLocal = U_SOCK_ENOTCONN;
+        } else {
+            // No route to host?
+            errnoLocal = U_SOCK_EHOSTUNREACH;
+        }
+    }
+
+    return errnoLocal;
+}
+
+// Write data on a connected TCP socket through the underlying
+// cell/wifi socket layer, returning the number of bytes sent
+// or a negated value of errno from the U_SOCK_Exxx list.
+// The container must be locked.
+static int32_t writeLocked(uSockContainer_t *pContainer,
+                           const uSockIoVec_t *pIoVec, size_t ioVecCount)
+{
+    int32_t errorCodeOrSize = -U_SOCK_ENOSYS;
+    uDeviceHandle_t devHandle = pContainer->socket.devHandle;
+    int32_t sockHandle = pContainer->socket.sockHandle;
+    int32_t devType = uDeviceGetDeviceType(devHandle);
+
+    // uXxxSockWritev() returns the number of bytes sent
+    // or a negated value of errno from the U_SOCK_Exxx list
+    STATS_START(pContainer);
+    if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
+        errorCodeOrSize = uCellSockWritev(devHandle, sockHandle,
+                                          pIoVec, ioVecCount);
+    } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
+        errorCodeOrSize = uWifiSockWritev(devHandle, sockHandle,
+                                          pIoVec, ioVecCount);
+    }
+    STATS_SEND(pContainer, errorCodeOrSize);
+    if (errorCodeOrSize > 0) {
+        pContainer->socket.bytesSent += errorCodeOrSize;
+        uDeviceMetricAdd(&gMetricTxBytes, (uint32_t) errorCodeOrSize);
+    }
+
+    return errorCodeOrSize;
+}
+
+// Free any deferred data of the socket in the given container.
+// The container must be locked.
+static void deferredFree(uSockContainer_t *pContainer)
+{
+    uPortFree(pContainer->socket.pDeferred);
+    pContainer->socket.pDeferred = NULL;
+    pContainer->socket.deferredLength = 0;
+    pContainer->socket.deferredWake = false;
+}
+
+// Send as much as possible of the deferred data of the socket in
+// the given container, returning U_SOCK_ENONE or an errno value.
+// The container must be locked.
+static int32_t deferredFlushLocked(uSockContainer_t *pContainer)
+{
+    int32_t errnoLocal = U_SOCK_ENONE;
+    int32_t errorCodeOrSize;
+    uSockIoVec_t ioVec;
+
+    if (pContainer->socket.deferredLength > 0) {
+        errnoLocal = writeStateCheck(pContainer);
+        if (errnoLocal == U_SOCK_ENONE) {
+            ioVec.pData = pContainer->socket.pDeferred;
+            ioVec.dataSizeBytes = pContainer->socket.deferredLength;
+            errorCodeOrSize = writeLocked(pContainer, &ioVec, 1);
+            if (errorCodeOrSize > 0) {
+                pContainer->socket.deferredLength -= errorCodeOrSize;
+                memmove(pContainer->socket.pDeferred,
+                        pContainer->socket.pDeferred + errorCodeOrSize,
+                        pContainer->socket.deferredLength);
+            } else if (errorCodeOrSize < 0) {
+                errnoLocal = -errorCodeOrSize;
+            }
+        }
+        if (pContainer->socket.deferredLength == 0) {
+            // All gone, no need to keep the memory
+            deferredFree(pContainer);
+        }
+    }
+    pContainer->socket.deferredWake = false;
+
+    return errnoLocal;
+}
+
+// Return true if the radio of the given device is known to be
+// awake, in which case there is no penalty in sending now.
+static bool deferredRadioIsAwake(uDeviceHandle_t devHandle)
+{
+    bool isAwake = false;
+    int32_t devType = uDeviceGetDeviceType(devHandle);
+
+    if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
+        // Only known if the +CSCON URC is switched on
+        isAwake = (uCellNetGetBaseStationConnection(devHandle) == 1);
+    } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
+        // Wi-Fi has no such notion, no point in waiting
+        isAwake = true;
+    }
+
+    return isAwake;
+}
+
+// Callback for gDeferredTimer, called in the context of the
+// timer task: just prod the deferred transmit scheduler.
+static void deferredTimerCallback(const uPortTimerHandle_t timerHandle,
+                                  void *pParameter)
+{
+    (void) timerHandle;
+    (void) pParameter;
+
+    U_PORT_MUTEX_LOCK(gMutexCallbacks);
+    deferredPost();
+    U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+}
+
+// Stop and delete gDeferredTimer.
+static void deferredTimerDelete()
+{
+    U_PORT_MUTEX_LOCK(gMutexCallbacks);
+    if (gDeferredTimer != NULL) {
+        uPortTimerDelete(gDeferredTimer);
+        gDeferredTimer = NULL;
+    }
+    gDeferredActive = false;
+    U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+}
+
+// The deferred transmit scheduler, called in the asynchronous
+// event task: send the deferred data of any socket where the
+// radio is known to be awake or a deadline has been reached,
+// stopping gDeferredTimer if no deferred data remains.
+// Must NOT be called with gMutexContainer locked.
+static void deferredService()
+{
+    uSockContainer_t *pContainer;
+    bool anyLeft = false;
+
+    U_PORT_MUTEX_LOCK(gMutexCallbacks);
+    gDeferredPosted = false;
+    U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+
+    for (int32_t x = 0; x < U_SOCK_MAX_NUM_SOCKETS; x++) {
+        // Check without locking first, to avoid waiting on
+        // sockets that have nothing deferred
+        pContainer = pContainerTableGet(x);
+        if ((pContainer != NULL) && (pContainer->socket.deferredLength > 0)) {
+            pContainer = pContainerLock(x);
+            if (pContainer != NULL) {
+                if ((pContainer->socket.deferredLength > 0) &&
+                    (pContainer->socket.deferredWake ||
+                     (uPortGetTickTimeMs() - pContainer->socket.deferredDeadlineMs >= 0) ||
+                     deferredRadioIsAwake(pContainer->socket.devHandle))) {
+                    deferredFlushLocked(pContainer);
+                }
+                if (pContainer->socket.deferredLength > 0) {
+                    anyLeft = true;
+                }
+                containerUnlock(pContainer);
+            }
+        }
+    }
+
+    if (!anyLeft) {
+        U_PORT_MUTEX_LOCK(gMutexCallbacks);
+        // Check again under gMutexCallbacks, since
+        // uSockWriteDeferred() activates the timer
+        // under it only after queueing the data
+        for (int32_t x = 0; (x < U_SOCK_MAX_NUM_SOCKETS) && !anyLeft; x++) {
+            pContainer = pContainerTableGet(x);
+            if ((pContainer != NULL) && (pContainer->socket.deferredLength > 0)) {
+                anyLeft = true;
+            }
+        }
+        if (!anyLeft && gDeferredActive) {
+            uPortTimerStop(gDeferredTimer);
+            gDeferredActive = false;
+        }
+        U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+    }
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: ASYNCHRONOUS OPERATIONS
+ * -------------------------------------------------------------- */
+
+// Event handler, called in the event queue task, which performs
+// an asynchronous operation and calls the user's callback.
+static void asyncEventHandler(void *pParam, size_t paramLength)
+{
+    const uSockAsyncEvent_t *pEvent = (const uSockAsyncEvent_t *) pParam;
+    uSockDescriptor_t descriptor = pEvent->descriptor;
+    uSockContainer_t *pContainer;
+    uSockAsyncOp_t *pOp;
+    uSockAsyncOp_t op;
+    int32_t errorCodeOrSize = -U_SOCK_ENOSYS;
+    bool complete = true;
+
+    (void) paramLength;
+
+    op.type = U_SOCK_ASYNC_TYPE_NONE;
+    if (pEvent->isDeferred) {
+        // Not an operation, the deferred transmit scheduler
+        deferredService();
+    } else {
+        // Take a copy of the operation, since the
+        // mutexes can't be held while it is performed
+        U_PORT_MUTEX_LOCK(gMutexContainer);
+        U_PORT_MUTEX_LOCK(gMutexCallbacks);
+        pContainer = pContainerTableGet(descriptor);
+        if (pContainer != NULL) {
+            pOp = &(pContainer->socket.asyncOp[pEvent->slot]);
+            // An event may be left over from an operation that
+            // has since completed, in which case posted will
+            // have been cleared
+            if (pOp->posted) {
+                memcpy(&op, pOp, sizeof(op));
+                pOp->posted = false;
+            }
+        }
+        U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+        U_PORT_MUTEX_UNLOCK(gMutexContainer);
+    }
+
+    if (op.type != U_SOCK_ASYNC_TYPE_NONE) {
+        switch (op.type) {
+            case U_SOCK_ASYNC_TYPE_CONNECT:
+                if (op.inModule) {
+                    // We only get here before the module has
+                    // reported the outcome if the socket is closed
+                    errorCodeOrSize = -U_SOCK_ECONNABORTED;
+                    if (op.done) {
+                        errorCodeOrSize = op.errorCodeOrSize;
+                    }
+                } else {
+                    errorCodeOrSize = uSockConnect(descriptor,
+                                                   &(op.remoteAddress));
+                    if (errorCodeOrSize < 0) {
+                        errorCodeOrSize = -errno;
+                    }
+                }
+                break;
+            case U_SOCK_ASYNC_TYPE_WRITE:
+                errorCodeOrSize = uSockWrite(descriptor, op.pData,
+                                             op.dataSizeBytes);
+                if (errorCodeOrSize < 0) {
+                    errorCodeOrSize = -errno;
+                }
+                break;
+            case U_SOCK_ASYNC_TYPE_READ:
+                errorCodeOrSize = sockRead(descriptor, op.pData,
+                                           op.dataSizeBytes, true);
+                if (errorCodeOrSize < 0) {
+                    errorCodeOrSize = -errno;
+                }
+                // If there is nothing to read yet, wait
+                // for dataCallback() to post again
+                complete = (errorCodeOrSize != 0) &&
+                           (errorCodeOrSize != -U_SOCK_EWOULDBLOCK);
+                break;
+            default:
+                break;
+        }
+
+        if (complete) {
+            // Free the slot, provided it still holds
+            // the operation we performed
+            U_PORT_MUTEX_LOCK(gMutexContainer);
+            U_PORT_MUTEX_LOCK(gMutexCallbacks);
+            pContainer = pContainerTableGet(descriptor);
+            if (pContainer != NULL) {
+                pOp = &(pContainer->socket.asyncOp[pEvent->slot]);
+                if ((pOp->type == op.type) &&
+                    (pOp->pCallback == op.pCallback) &&
+                    (pOp->pCallbackParameter == op.pCallbackParameter)) {
+                    pOp->type = U_SOCK_ASYNC_TYPE_NONE;
+                    pOp->posted = false;
+                }
+            }
+            U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+            U_PORT_MUTEX_UNLOCK(gMutexContainer);
+            // Tell the user, with no mutexes held so that
+            // they may call back into this API
+            op.pCallback(descriptor, errorCodeOrSize,
+                         op.pCallbackParameter);
+        }
+    }
+}
+
+// Open the asynchronous event queue, if it is not already
+// open, returning errno.
+// gMutexCallbacks must be locked.
+static int32_t asyncQueueOpen()
+{
+    int32_t errnoLocal = U_SOCK_ENONE;
+
+    if (gAsyncEventQueue < 0) {
+        // Room for an event per slot, with the same again
+        // for events left over from completed operations,
+        // so that posting from within the event task (e.g.
+        // a callback starting another operation) never blocks,
+        // plus one for the deferred transmit scheduler
+        gAsyncEventQueue = uPortEventQueueOpen(asyncEventHandler,
+                                               "sockAsync",
+                                               sizeof(uSockAsyncEvent_t),
+                                               U_SOCK_ASYNC_TASK_STACK_SIZE_BYTES,
+                                               U_SOCK_ASYNC_TASK_PRIORITY,
+                                               (U_SOCK_MAX_NUM_SOCKETS *
+                                                U_SOCK_ASYNC_SLOT_MAX_NUM * 2) + 1);
+        if (gAsyncEventQueue < 0) {
+            errnoLocal = U_SOCK_ENOMEM;
+        }
+        // Any event that was on the old queue has gone
+        gDeferredPosted = false;
+    }
+
+    return errnoLocal;
+}
+
+// Put an asynchronous operation into the given slot of the
+// given container, opening the event queue if required and,
+// if post is true, posting an event for it; returns errno.
+// The container should be locked.
+static int32_t asyncStart(uSockContainer_t *pContainer,
+                          uSockAsyncSlot_t slot,
+                          const uSockAsyncOp_t *pOp, bool post)
+{
+    int32_t errnoLocal = U_SOCK_EALREADY;
+
+    U_PORT_MUTEX_LOCK(gMutexCallbacks);
+    if (pContainer->socket.asyncOp[slot].type == U_SOCK_ASYNC_TYPE_NONE) {
+        errnoLocal = asyncQueueOpen();
+        if (errnoLocal == U_SOCK_ENONE) {
+            memcpy(&(pContainer->socket.asyncOp[slot]), pOp,
+                   sizeof(pContainer->socket.asyncOp[slot]));
+            pContainer->socket.asyncOp[slot].posted = false;
+            if (post) {
+                asyncPost(pContainer, slot);
+            }
+        }
+    }
+    U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+
+    return errnoLocal;
+}
+
+// Close the asynchronous event queue, abandoning any
+// operations that are outstanding.
+// Must NOT be called with gMutexContainer locked.
+static void asyncClose()
+{
+    int32_t eventQueueHandle;
+
+    U_PORT_MUTEX_LOCK(gMutexCallbacks);
+    // Once the handle is reset no-one will post again
+    eventQueueHandle = gAsyncEventQueue;
+    gAsyncEventQueue = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+
+    if (eventQueueHandle >= 0) {
+        uPortEventQueueClose(eventQueueHandle);
+    }
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: CLOSING AND THE SOCKET POOL
+ * -------------------------------------------------------------- */
+
+// Close the socket in the given container at the underlying
+// socket layer, returning U_SOCK_ENONE or an errno value.
+// The container must be locked.
+static int32_t closeLocked(uSockContainer_t *pContainer)
+{
+    int32_t errorCode;
+    int32_t errnoLocal;
+    uDeviceHandle_t devHandle;
+    int32_t sockHandle;
+    uSockState_t finalState = U_SOCK_STATE_CLOSED;
+    void (*pAsyncClosedCallback) (uDeviceHandle_t, int32_t) = NULL;
+
+    // Talk to the underlying cell/wifi socket layer to
+    // close the socket there.
+    // If the underlying socket layer waits while it gets
+    // the ack for the ack for the ack at TCP level then
+    // give it a callback to call when it is done and
+    // set finalState to U_SOCK_STATE_CLOSING to mark
+    // the socket as closing, not closed.
+    // uXxxSockClose() returns a negated value of errno
+    // from the U_SOCK_Exxx list
+    devHandle = pContainer->socket.devHandle;
+    sockHandle = pContainer->socket.sockHandle;
+    errnoLocal = U_SOCK_ENONE;
+    errorCode = -U_SOCK_ENOSYS;
+    int32_t devType = uDeviceGetDeviceType(devHandle);
+    if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
+        // In the cellular case asynchronous TCP
+        // socket closure is used in some cases.
+        if (pContainer->socket.protocol == U_SOCK_PROTOCOL_TCP) {
+            finalState = U_SOCK_STATE_CLOSING;
+            pAsyncClosedCallback = closedCallback;
+        }
+        errorCode = uCellSockClose(devHandle,
+                                   sockHandle,
+                                   pAsyncClosedCallback);
+    } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
+        errorCode = uWifiSockClose(devHandle,
+                                   sockHandle,
+                                   pAsyncClosedCallback);
+    }
+    if (errorCode == 0) {
+        uPortLog("U_SOCK: socket with descriptor %d,"
+                 " network handle 0x%08x, socket handle %d,"
+                 " has been closed.\n",
+                 pContainer->descriptor, devHandle, sockHandle);
+        if (pContainer->socket.state != U_SOCK_STATE_CLOSED) {
+            // Now mark the socket as closed (or closing).
+            // Socket is only freed by a call to
+            // uSockCleanUp() in order to ensure
+            // thread-safeness
+            // Do the check for closed state above first as it
+            // is possible for the uXxxSockClose() function
+            // to call the callback to close the socket
+            // immediately, before it returns.
+            if (finalState == U_SOCK_STATE_CLOSED) {
+                // There was no hanging around, call the
+                // callback directly
+                closedCallback(devHandle, sockHandle);
+            } else {
+                // Just set the state and the callback
+                // will sort actual closing out later
+                pContainer->socket.state = finalState;
+                // Any asynchronous operations can
+                // complete now, with an error
+                U_PORT_MUTEX_LOCK(gMutexCallbacks);
+                for (size_t x = 0; x < U_SOCK_ASYNC_SLOT_MAX_NUM; x++) {
+                    asyncPost(pContainer, (uSockAsyncSlot_t) x);
+                }
+                U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+            }
+        }
+    } else {
+        errnoLocal = -errorCode;
+        uPortLog("U_SOCK: underlying socket layer returned"
+                 " errno %d on closing descriptor %d,"
+                 " network handle 0x%08x, socket handle %d.\n",
+                 errnoLocal, pContainer->descriptor, devHandle,
+                 sockHandle);
+    }
+
+    return errnoLocal;
+}
+
+// Return true if the two addresses are the same.
+static bool addressIsEqual(const uSockAddress_t *pAddress1,
+                           const uSockAddress_t *pAddress2)
+{
+    bool isEqual = (pAddress1->port == pAddress2->port) &&
+                   (pAddress1->ipAddress.type == pAddress2->ipAddress.type);
+
+    if (isEqual) {
+        if (pAddress1->ipAddress.type == U_SOCK_ADDRESS_TYPE_V6) {
+            isEqual = (memcmp(pAddress1->ipAddress.address.ipv6,
+                              pAddress2->ipAddress.address.ipv6,
+                              sizeof(pAddress1->ipAddress.address.ipv6)) == 0);
+        } else {
+            isEqual = (pAddress1->ipAddress.address.ipv4 ==
+                       pAddress2->ipAddress.address.ipv4);
+        }
+    }
+
+    return isEqual;
+}
+
+// Put the socket in the given container into the pool instead
+// of closing it, if it came from uSockPoolConnect(), is in a
+// fit state to be re-used and there is room; returns true if
+// the socket is now in the pool.  The container must be locked.
+static bool poolPut(uSockContainer_t *pContainer)
+{
+    bool isPooled = false;
+    bool isIdle = true;
+    size_t numPooled = 0;
+    int32_t keepAlive = 1;
+    uDeviceHandle_t devHandle = pContainer->socket.devHandle;
+    int32_t sockHandle = pContainer->socket.sockHandle;
+
+    if (pContainer->socket.poolable &&
+        (pContainer->socket.state == U_SOCK_STATE_CONNECTED) &&
+        !pContainer->readReady) {
+        U_PORT_MUTEX_LOCK(gMutexCallbacks);
+        for (size_t x = 0; x < U_SOCK_ASYNC_SLOT_MAX_NUM; x++) {
+            if (pContainer->socket.asyncOp[x].type != U_SOCK_ASYNC_TYPE_NONE) {
+                isIdle = false;
+            }
+        }
+        U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+        U_PORT_MUTEX_LOCK(gMutexContainer);
+        for (size_t x = 0; x < U_SOCK_MAX_NUM_SOCKETS; x++) {
+            if ((gpContainerTable[x] != NULL) &&
+                (gpContainerTable[x]->socket.state == U_SOCK_STATE_POOLED)) {
+                numPooled++;
+            }
+        }
+        U_PORT_MUTEX_UNLOCK(gMutexContainer);
+        if (isIdle && (numPooled < U_SOCK_POOL_MAX_NUM_SOCKETS)) {
+            if (!pContainer->socket.poolKeepAliveSet) {
+                // Ask for TCP keep-alive so that the connection is
+                // not dropped by a NAT along the way while pooled;
+                // best effort, not all modules support it
+                int32_t devType = uDeviceGetDeviceType(devHandle);
+                if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
+                    uCellSockOptionSet(devHandle, sockHandle,
+                                       U_SOCK_OPT_LEVEL_SOCK,
+                                       U_SOCK_OPT_KEEPALIVE,
+                                       (void *) &keepAlive,
+                                       sizeof(keepAlive));
+                } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
+                    uWifiSockOptionSet(devHandle, sockHandle,
+                                       U_SOCK_OPT_LEVEL_SOCK,
+                                       U_SOCK_OPT_KEEPALIVE,
+                                       (void *) &keepAlive,
+                                       sizeof(keepAlive));
+                }
+                pContainer->socket.poolKeepAliveSet = true;
+            }
+            // The user's callbacks go with the user
+            U_PORT_MUTEX_LOCK(gMutexCallbacks);
+            pContainer->socket.pDataCallback = NULL;
+            pContainer->socket.pDataCallbackParameter = NULL;
+            pContainer->socket.pClosedCallback = NULL;
+            pContainer->socket.pClosedCallbackParameter = NULL;
+            U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+            pContainer->socket.pooledTimeMs = uPortGetTickTimeMs();
+            pContainer->socket.state = U_SOCK_STATE_POOLED;
+            isPooled = true;
+            uPortLog("U_SOCK: socket with descriptor %d, network handle"
+                     " 0x%08x, socket handle %d, is in the pool.\n",
+                     pContainer->descriptor, devHandle, sockHandle);
+        }
+    }
+
+    return isPooled;
+}
+
+// Find a socket in the pool for the given device (NULL for any
+// device) and, if pRemoteAddress is not NULL, the given remote
+// address and TLS settings hash, returning its container locked
+// or NULL if there is none.  Must NOT be called with
+// gMutexContainer locked.
+static uSockContainer_t *pPoolLock(uDeviceHandle_t devHandle,
+                                   const uSockAddress_t *pRemoteAddress,
+                                   uint32_t settingsHash)
+{
+    uSockContainer_t *pContainer = NULL;
+    uSockContainer_t *pContainerThis;
+
+    do {
+        pContainerThis = NULL;
+        U_PORT_MUTEX_LOCK(gMutexContainer);
+        for (size_t x = 0; (x < U_SOCK_MAX_NUM_SOCKETS) &&
+             (pContainerThis == NULL); x++) {
+            if ((gpContainerTable[x] != NULL) &&
+                (gpContainerTable[x]->socket.state == U_SOCK_STATE_POOLED) &&
+                ((devHandle == NULL) ||
+                 (gpContainerTable[x]->socket.devHandle == devHandle)) &&
+                ((pRemoteAddress == NULL) ||
+                 ((gpContainerTable[x]->socket.poolSettingsHash == settingsHash) &&
+                  addressIsEqual(&(gpContainerTable[x]->socket.remoteAddress),
+                                 pRemoteAddress)))) {
+                pContainerThis = gpContainerTable[x];
+                pContainerThis->lockCount++;
+            }
+        }
+        U_PORT_MUTEX_UNLOCK(gMutexContainer);
+        if (pContainerThis != NULL) {
+            uPortMutexLock(pContainerThis->mutex);
+            if (pContainerThis->socket.state == U_SOCK_STATE_POOLED) {
+                pContainer = pContainerThis;
+            } else {
+                // Closed by the far end while we waited, try again
+                containerUnlock(pContainerThis);
+            }
+        }
+    } while ((pContainerThis != NULL) && (pContainer == NULL));
+
+    return pContainer;
+}
+
+// Check whether the pooled socket in the given container is
+// fit for re-use: it must not have been in the pool for too
+// long, nothing must have arrived on it (which would indicate
+// that the server is doing something unexpected) and, for
+// cellular, the module must still know of it.
+// The container must be locked.
+static bool poolIsHealthy(uSockContainer_t *pContainer)
+{
+    bool isHealthy = false;
+    uDeviceHandle_t devHandle = pContainer->socket.devHandle;
+
+    if ((uPortGetTickTimeMs() - pContainer->socket.pooledTimeMs <
+         U_SOCK_POOL_IDLE_TIMEOUT_SECONDS * 1000) &&
+        !pContainer->readReady) {
+        isHealthy = true;
+        if (uDeviceGetDeviceType(devHandle) == (int32_t) U_DEVICE_TYPE_CELL) {
+            // A cheap query which fails if the socket has gone
+            isHealthy = (uCellSockGetBytesSent(devHandle,
+                                               pContainer->socket.sockHandle) >= 0);
+        }
+    }
+
+    return isHealthy;
+}
+
+// Take a healthy socket matching the given device, remote address
+// and TLS settings hash out of the pool, returning its container
+// locked and in state U_SOCK_STATE_CONNECTED, or NULL if there is
+// none; unhealthy matching sockets are closed along the way.
+// Must NOT be called with gMutexContainer locked.
+static uSockContainer_t *pPoolTake(uDeviceHandle_t devHandle,
+                                   const uSockAddress_t *pRemoteAddress,
+                                   uint32_t settingsHash)
+{
+    uSockContainer_t *pContainer = NULL;
+    uSockContainer_t *pContainerThis;
+
+    do {
+        pContainerThis = pPoolLock(devHandle, pRemoteAddress, settingsHash);
+        if (pContainerThis != NULL) {
+            pContainerThis->socket.state = U_SOCK_STATE_CONNECTED;
+            if (poolIsHealthy(pContainerThis)) {
+                // Return the user-settable things to defaults
+                pContainerThis->socket.blocking = true;
+                pContainerThis->socket.receiveTimeoutMs = U_SOCK_DEFAULT_RECEIVE_TIMEOUT_MS;
+                pContainer = pContainerThis;
+            } else {
+                uPortLog("U_SOCK: pooled socket with descriptor %d is"
+                         " not fit for re-use, closing it.\n",
+                         pContainerThis->descriptor);
+                pContainerThis->socket.poolable = false;
+                closeLocked(pContainerThis);
+                containerUnlock(pContainerThis);
+            }
+        }
+    } while ((pContainerThis != NULL) && (pContainer == NULL));
+
+    return pContainer;
+}
+
+// Create a TCP socket, apply the given security settings, which
+// may be NULL, and connect it; returns the descriptor or negative
+// error code, in which case errno will have been set.
+static int32_t connectNew(uDeviceHandle_t devHandle,
+                          const uSockAddress_t *pRemoteAddress,
+                          const uSecurityTlsSettings_t *pSettings)
+{
+    int32_t descriptorOrError;
+    int32_t errnoLocal;
+
+    // These functions set errno themselves
+    descriptorOrError = uSockCreate(devHandle, U_SOCK_TYPE_STREAM,
+                                    U_SOCK_PROTOCOL_TCP);
+    if ((descriptorOrError >= 0) &&
+        (((pSettings != NULL) &&
+          (uSockSecurity(descriptorOrError, pSettings) != 0)) ||
+         (uSockConnect(descriptorOrError, pRemoteAddress) != 0))) {
+        // Keep the errno of the failure, not of the close
+        errnoLocal = errno;
+        uSockClose(descriptorOrError);
+        errno = errnoLocal;
+        descriptorOrError = (int32_t) U_ERROR_COMMON_BSD_ERROR;
+    }
+
+    return descriptorOrError;
+}
+
+// Return true if the given server is known to refuse PSK.
+static bool pskIsRefused(const uSockAddress_t *pRemoteAddress)
+{
+    bool isRefused = false;
+
+#if U_SOCK_PSK_REFUSED_NUM_ENTRIES > 0
+    U_PORT_MUTEX_LOCK(gMutexContainer);
+    for (size_t x = 0; (x < gPskRefusedNum) && !isRefused; x++) {
+        isRefused = addressIsEqual(&(gPskRefused[x]), pRemoteAddress);
+    }
+    U_PORT_MUTEX_UNLOCK(gMutexContainer);
+#else
+    (void) pRemoteAddress;
+#endif
+
+    return isRefused;
+}
+
+// Remember that the given server refuses PSK, replacing the
+// oldest entry if there is no room.
+static void pskRefusedAdd(const uSockAddress_t *pRemoteAddress)
+{
+#if U_SOCK_PSK_REFUSED_NUM_ENTRIES > 0
+    U_PORT_MUTEX_LOCK(gMutexContainer);
+    if (gPskRefusedNum < sizeof(gPskRefused) / sizeof(gPskRefused[0])) {
+        gPskRefused[gPskRefusedNum] = *pRemoteAddress;
+        gPskRefusedNum++;
+    } else {
+        gPskRefused[gPskRefusedNext] = *pRemoteAddress;
+        gPskRefusedNext = (gPskRefusedNext + 1) % (sizeof(gPskRefused) / sizeof(gPskRefused[0]));
+    }
+    U_PORT_MUTEX_UNLOCK(gMutexContainer);
+#else
+    (void) pRemoteAddress;
+#endif
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: CREATE/OPEN/CLOSE/CLEAN-UP
+ * -------------------------------------------------------------- */
+
+// Create a socket.
+int32_t uSockCreate(uDeviceHandle_t devHandle, uSockType_t type,
+                    uSockProtocol_t protocol)
+{
+    int32_t descriptorOrError = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t errnoLocal;
+    uSockContainer_t *pContainer = NULL;
+    uSockDescriptor_t descriptor = 0;
+    int32_t sockHandle = -U_SOCK_ENOSYS;
+
+    errnoLocal = init();
+    if (errnoLocal == U_SOCK_ENONE) {
+        // Check parameters
+        errnoLocal = U_SOCK_ENODEV;
+        if (uDeviceIsValidInstance(U_DEVICE_INSTANCE(devHandle))) {
+            errnoLocal = U_SOCK_EPROTONOSUPPORT;
+            if (((type == U_SOCK_TYPE_STREAM) && (protocol == U_SOCK_PROTOCOL_TCP)) ||
+                ((type == U_SOCK_TYPE_DGRAM) && (protocol == U_SOCK_PROTOCOL_UDP))) {
+                errnoLocal = U_SOCK_ENONE;
+            }
+        }
+    }
+
+    if (errnoLocal == U_SOCK_ENONE) {
+
+        U_PORT_MUTEX_LOCK(gMutexContainer);
+
         errnoLocal = U_SOCK_ENOBUFS;
         if (numContainersInUse() < U_SOCK_MAX_NUM_SOCKETS) {
-            // Find the next free descriptor
+            // Find the lowest free descriptor, as BSD sockets
+            // would; since fewer than U_SOCK_MAX_NUM_SOCKETS
+            // are in use this keeps descriptors within the
+            // range of a uSockDescriptorSet_t
             descriptorOrError = (int32_t) U_ERROR_COMMON_BSD_ERROR;
             while (descriptorOrError < 0) {
                 // Try the descriptor value, making sure
                 // each time that it can't be found.
                 if (pContainerFindByDescriptor(descriptor) == NULL) {
-                    gNextDescriptor = descriptor;
-                    U_SOCK_INC_DESCRIPTOR(gNextDescriptor);
                     // Found a free descriptor, now try to
                     // create the socket in a container
                     pContainer = pSockContainerCreate(descriptor,
@@ -1163,7 +2666,7 @@ int32_t uSockCreate(uDeviceHandle_t devHandle, uSockType_t type,
                         break;
                     }
                 }
-                U_SOCK_INC_DESCRIPTOR(descriptor);
+                descriptor++;
             }
 
             if ((descriptorOrError >= 0) && (pContainer != NULL)) {
@@ -1206,6 +2709,22 @@ int32_t uSockCreate(uDeviceHandle_t devHandle, uSockType_t type,
                         pContainer->socket.sockHandle = sockHandle;
                         pContainer->socket.devHandle = devHandle;
                         pContainer->socket.bytesSent = 0;
+#ifdef U_CFG_SOCK_STATS
+                        statsReset(pContainer);
+#endif
+                        // Always hook the data callback of the
+                        // underlying layer so that uSockSelect()
+                        // knows when data has arrived; this is
+                        // purely local, no AT traffic is involved
+                        if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
+                            uCellSockRegisterCallbackData(devHandle,
+                                                          sockHandle,
+                                                          dataCallback);
+                        } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
+                            uWifiSockRegisterCallbackData(devHandle,
+                                                          sockHandle,
+                                                          dataCallback);
+                        }
                         uPortLog("U_SOCK: socket created, descriptor %d,"
                                  " network handle 0x%08x, socket handle %d.\n",
                                  descriptorOrError, devHandle, sockHandle);
@@ -1251,11 +2770,8 @@ int32_t uSockConnect(uSockDescriptor_t descriptor,
         errnoLocal = U_SOCK_EINVAL;
         // Check that the remote IP address is sensible
         if (pRemoteAddress != NULL) {
-
-            U_PORT_MUTEX_LOCK(gMutexContainer);
-
-            // Find the container
-            pContainer = pContainerFindByDescriptor(descriptor);
+            // Find and lock the container
+            pContainer = pContainerLock(descriptor);
             errnoLocal = U_SOCK_EBADF;
             if (pContainer != NULL) {
                 errnoLocal = U_SOCK_EPERM;
@@ -1274,6 +2790,7 @@ int32_t uSockConnect(uSockDescriptor_t descriptor,
                                              buffer, sizeof(buffer)),
                              buffer);
                     int32_t devType = uDeviceGetDeviceType(devHandle);
+                    STATS_START(pContainer);
                     if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
                         errorCode = uCellSockConnect(devHandle,
                                                      sockHandle,
@@ -1283,6 +2800,7 @@ int32_t uSockConnect(uSockDescriptor_t descriptor,
                                                      sockHandle,
                                                      pRemoteAddress);
                     }
+                    STATS_CONNECT(pContainer, errorCode);
 
                     if (errorCode == 0) {
                         // All is good
@@ -1310,19 +2828,113 @@ int32_t uSockConnect(uSockDescriptor_t descriptor,
                                  sockHandle);
                     }
                 }
+                containerUnlock(pContainer);
+            }
+        }
+    }
+
+    if (errnoLocal != U_SOCK_ENONE) {
+        // Write the errno
+        errno = errnoLocal;
+        errorCode = (int32_t) U_ERROR_COMMON_BSD_ERROR;
+    }
+
+    return errorCode;
+}
+
+// Make an outgoing TCP connection, re-using one from the pool
+// if possible.
+int32_t uSockPoolConnect(uDeviceHandle_t devHandle,
+                         const uSockAddress_t *pRemoteAddress,
+                         const uSecurityTlsSettings_t *pSettings)
+{
+    int32_t descriptorOrError = (int32_t) U_ERROR_COMMON_BSD_ERROR;
+    int32_t errnoLocal;
+    uSockContainer_t *pContainer;
+    uint32_t settingsHash = 0;
+
+    errnoLocal = init();
+    if (errnoLocal == U_SOCK_ENONE) {
+        errnoLocal = U_SOCK_EINVAL;
+        if (pRemoteAddress != NULL) {
+            errnoLocal = U_SOCK_ENONE;
+            if (pSettings != NULL) {
+                settingsHash = uSecurityTlsSettingsHash(pSettings);
+            }
+            pContainer = pPoolTake(devHandle, pRemoteAddress, settingsHash);
+            if (pContainer != NULL) {
+                descriptorOrError = pContainer->descriptor;
+                uPortLog("U_SOCK: re-using pooled socket with"
+                         " descriptor %d.\n", descriptorOrError);
+                containerUnlock(pContainer);
+            }
+        }
+    }
+
+    if ((errnoLocal == U_SOCK_ENONE) && (descriptorOrError < 0)) {
+        // Nothing suitable in the pool, make a new connection;
+        // this sets errno itself
+        descriptorOrError = connectNew(devHandle, pRemoteAddress, pSettings);
+        if (descriptorOrError >= 0) {
+            // Mark the socket as one for the pool
+            pContainer = pContainerLock(descriptorOrError);
+            if (pContainer != NULL) {
+                pContainer->socket.poolable = true;
+                pContainer->socket.poolSettingsHash = settingsHash;
+                containerUnlock(pContainer);
+            }
+        }
+    }
+
+    if (errnoLocal != U_SOCK_ENONE) {
+        // Write the errno
+        errno = errnoLocal;
+    }
+
+    return descriptorOrError;
+}
+
+// Make an outgoing TLS connection, trying PSK first.
+int32_t uSockPskConnect(uDeviceHandle_t devHandle,
+                        const uSockAddress_t *pRemoteAddress,
+                        const uSecurityTlsSettings_t *pSettings)
+{
+    int32_t descriptorOrError = (int32_t) U_ERROR_COMMON_BSD_ERROR;
+    int32_t errnoLocal;
+    uSecurityTlsSettings_t pskSettings;
+    bool pskTried = false;
+
+    errnoLocal = init();
+    if (errnoLocal == U_SOCK_ENONE) {
+        errnoLocal = U_SOCK_EINVAL;
+        if ((pRemoteAddress != NULL) && (pSettings != NULL)) {
+            errnoLocal = U_SOCK_ENONE;
+            if (!pskIsRefused(pRemoteAddress)) {
+                uSecurityTlsSettingsPskDerive(pSettings, &pskSettings);
+                // This sets errno itself
+                descriptorOrError = connectNew(devHandle, pRemoteAddress, &pskSettings);
+                pskTried = true;
+            }
+            if (descriptorOrError < 0) {
+                if (pskTried) {
+                    uPortLog("U_SOCK: PSK connection failed (errno %d), falling"
+                             " back to the given security settings.\n", errno);
+                }
+                descriptorOrError = connectNew(devHandle, pRemoteAddress, pSettings);
+                if ((descriptorOrError >= 0) && pskTried) {
+                    // The server is there but wouldn't do PSK
+                    pskRefusedAdd(pRemoteAddress);
+                }
             }
-
-            U_PORT_MUTEX_UNLOCK(gMutexContainer);
         }
     }
 
     if (errnoLocal != U_SOCK_ENONE) {
         // Write the errno
         errno = errnoLocal;
-        errorCode = (int32_t) U_ERROR_COMMON_BSD_ERROR;
     }
 
-    return errorCode;
+    return descriptorOrError;
 }
 
 // Close a socket.
@@ -1331,84 +2943,23 @@ int32_t uSockClose(uSockDescriptor_t descriptor)
     int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
     int32_t errnoLocal;
     uSockContainer_t *pContainer = NULL;
-    uDeviceHandle_t devHandle;
-    int32_t sockHandle;
-    uSockState_t finalState = U_SOCK_STATE_CLOSED;
-    void (*pAsyncClosedCallback) (uDeviceHandle_t, int32_t) = NULL;
 
     errnoLocal = init();
     if (errnoLocal == U_SOCK_ENONE) {
-
-        U_PORT_MUTEX_LOCK(gMutexContainer);
-
-        // Find the container
+        // Find and lock the container
         errnoLocal = U_SOCK_EBADF;
-        pContainer = pContainerFindByDescriptor(descriptor);
+        pContainer = pContainerLock(descriptor);
         if (pContainer != NULL) {
-            // We have found the container, talk to the underlying
-            // cell/wifi socket layer to close the socket there.
-            // If the underlying socket layer waits while it gets
-            // the ack for the ack for the ack at TCP level then
-            // give it a callback to call when it is done and
-            // set finalState to U_SOCK_STATE_CLOSING to mark
-            // the socket as closing, not closed.
-            // uXxxSockClose() returns a negated value of errno
-            // from the U_SOCK_Exxx list
-            devHandle = pContainer->socket.devHandle;
-            sockHandle = pContainer->socket.sockHandle;
+            // Send any deferred data while we still can;
+            // whatever can't be sent is lost
+            deferredFlushLocked(pContainer);
+            deferredFree(pContainer);
             errnoLocal = U_SOCK_ENONE;
-            errorCode = -U_SOCK_ENOSYS;
-            int32_t devType = uDeviceGetDeviceType(devHandle);
-            if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                // In the cellular case asynchronous TCP
-                // socket closure is used in some cases.
-                if (pContainer->socket.protocol == U_SOCK_PROTOCOL_TCP) {
-                    finalState = U_SOCK_STATE_CLOSING;
-                    pAsyncClosedCallback = closedCallback;
-                }
-                errorCode = uCellSockClose(devHandle,
-                                           sockHandle,
-                                           pAsyncClosedCallback);
-            } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                errorCode = uWifiSockClose(devHandle,
-                                           sockHandle,
-                                           pAsyncClosedCallback);
-            }
-            if (errorCode == 0) {
-                uPortLog("U_SOCK: socket with descriptor %d,"
-                         " network handle 0x%08x, socket handle %d,"
-                         " has been closed.\n",
-                         descriptor, devHandle, sockHandle);
-                if (pContainer->socket.state != U_SOCK_STATE_CLOSED) {
-                    // Now mark the socket as closed (or closing).
-                    // Socket is only freed by a call to
-                    // uSockCleanUp() in order to ensure
-                    // thread-safeness
-                    // Do the check for closed state above first as it
-                    // is possible for the uXxxSockClose() function
-                    // to call the callback to close the socket
-                    // immediately, before it returns.
-                    if (finalState == U_SOCK_STATE_CLOSED) {
-                        // There was no hanging around, call the
-                        // callback directly
-                        closedCallback(devHandle, sockHandle);
-                    } else {
-                        // Just set the state and the callback
-                        // will sort actual closing out later
-                        pContainer->socket.state = finalState;
-                    }
-                }
-            } else {
-                errnoLocal = -errorCode;
-                uPortLog("U_SOCK: underlying socket layer returned"
-                         " errno %d on closing descriptor %d,"
-                         " network handle 0x%08x, socket handle %d.\n",
-                         errnoLocal, descriptor, devHandle,
-                         sockHandle);
+            if (!poolPut(pContainer)) {
+                errnoLocal = closeLocked(pContainer);
             }
+            containerUnlock(pContainer);
         }
-
-        U_PORT_MUTEX_UNLOCK(gMutexContainer);
     }
 
     if (errnoLocal != U_SOCK_ENONE) {
@@ -1420,6 +2971,24 @@ int32_t uSockClose(uSockDescriptor_t descriptor)
     return errorCode;
 }
 
+// Close all of the sockets in the pool.
+void uSockPoolFlush(uDeviceHandle_t devHandle)
+{
+    uSockContainer_t *pContainer;
+
+    if (gInitialised) {
+        do {
+            pContainer = pPoolLock(devHandle, NULL, 0);
+            if (pContainer != NULL) {
+                pContainer->socket.state = U_SOCK_STATE_CONNECTED;
+                pContainer->socket.poolable = false;
+                closeLocked(pContainer);
+                containerUnlock(pContainer);
+            }
+        } while (pContainer != NULL);
+    }
+}
+
 // Free memory from any sockets that are no longer in use.
 void uSockCleanUp()
 {
@@ -1427,6 +2996,7 @@ void uSockCleanUp()
     uSockContainer_t *pTmp;
     size_t numNonClosedSockets = 0;
     uDeviceHandle_t devHandle;
+    bool deinitialised = false;
 
     if (gInitialised) {
 
@@ -1434,8 +3004,11 @@ void uSockCleanUp()
 
         // Move through the list removing closed sockets
         while (pContainer != NULL) {
-            if ((pContainer->socket.state == U_SOCK_STATE_CLOSED) ||
-                (pContainer->socket.state == U_SOCK_STATE_CLOSING)) {
+            if (((pContainer->socket.state == U_SOCK_STATE_CLOSED) ||
+                 (pContainer->socket.state == U_SOCK_STATE_CLOSING)) &&
+                (pContainer->lockCount == 0)) {
+                containerTableRemove(pContainer);
+                deferredFree(pContainer);
                 if (!(pContainer->isStatic)) {
                     // If this socket is not static, uncouple it
                     // If there is a previous container, move its pNext
@@ -1458,6 +3031,7 @@ void uSockCleanUp()
                     devHandle = pContainer->socket.devHandle;
 
                     // Free the memory
+                    uPortMutexDelete(pContainer->mutex);
                     uPortFree(pContainer);
                     // Move to the next entry
                     pContainer = pTmp;
@@ -1480,7 +3054,8 @@ void uSockCleanUp()
                     }
                 }
             } else {
-                // Move on but count the number of non-closed sockets
+                // Move on but count the number of non-closed
+                // (or still locked) sockets
                 numNonClosedSockets++;
                 pContainer = pContainer->pNext;
             }
@@ -1489,26 +3064,53 @@ void uSockCleanUp()
         // If everything has been closed, we can deinit();
         if (numNonClosedSockets == 0) {
             deinitButNotMutex();
+            deinitialised = true;
         }
 
         U_PORT_MUTEX_UNLOCK(gMutexContainer);
+
+        if (deinitialised) {
+            // No sockets, hence no need for the asynchronous
+            // event task or the deferred transmit timer either
+            asyncClose();
+            deferredTimerDelete();
+        }
     }
 }
 
 // Close all sockets and free resource.
 void uSockDeinit()
 {
-    uSockContainer_t *pContainer = gpContainerListHead;
+    uSockContainer_t *pContainer;
     uSockContainer_t *pTmp;
     uDeviceHandle_t devHandle;
     int32_t sockHandle;
 
     if (gInitialised) {
 
+        // Stop performing asynchronous operations first as the
+        // event task needs gMutexContainer
+        asyncClose();
+        deferredTimerDelete();
+
         U_PORT_MUTEX_LOCK(gMutexContainer);
 
+        // Let any operations in progress on a socket finish
+        pContainer = gpContainerListHead;
+        while (pContainer != NULL) {
+            if (pContainer->lockCount > 0) {
+                uPortMutexUnlock(gMutexContainer);
+                uPortTaskBlock(U_SOCK_RECEIVE_POLL_INTERVAL_MS);
+                uPortMutexLock(gMutexContainer);
+                pContainer = gpContainerListHead;
+            } else {
+                pContainer = pContainer->pNext;
+            }
+        }
+
         // Move through the list closing and
         // removing sockets
+        pContainer = gpContainerListHead;
         while (pContainer != NULL) {
             if ((pContainer->socket.state != U_SOCK_STATE_CLOSING) &&
                 (pContainer->socket.state != U_SOCK_STATE_CLOSED)) {
@@ -1526,6 +3128,8 @@ void uSockDeinit()
                 }
             }
 
+            containerTableRemove(pContainer);
+            deferredFree(pContainer);
             if (!(pContainer->isStatic)) {
                 // If this socket is not static, uncouple it
                 // If there is a previous container, move its pNext
@@ -1546,6 +3150,7 @@ void uSockDeinit()
                 pTmp = pContainer->pNext;
 
                 // Free the memory
+                uPortMutexDelete(pContainer->mutex);
                 uPortFree(pContainer);
                 // Move to the next entry
                 pContainer = pTmp;
@@ -1560,6 +3165,9 @@ void uSockDeinit()
         deinitButNotMutex();
 
         U_PORT_MUTEX_UNLOCK(gMutexContainer);
+
+        // Forget any DNS look-ups
+        uSockGetHostByNameCacheFlush(NULL);
     }
 }
 
@@ -1575,18 +3183,14 @@ void uSockBlockingSet(uSockDescriptor_t descriptor, bool isBlocking)
 
     errnoLocal = init();
     if (errnoLocal == U_SOCK_ENONE) {
-
-        U_PORT_MUTEX_LOCK(gMutexContainer);
-
-        // Find the container
-        pContainer = pContainerFindByDescriptor(descriptor);
+        // Find and lock the container
+        pContainer = pContainerLock(descriptor);
         errnoLocal = U_SOCK_EBADF;
         if (pContainer != NULL) {
             errnoLocal = U_SOCK_ENONE;
             pContainer->socket.blocking = isBlocking;
+            containerUnlock(pContainer);
         }
-
-        U_PORT_MUTEX_UNLOCK(gMutexContainer);
     }
 
     if (errnoLocal != U_SOCK_ENONE) {
@@ -1604,18 +3208,14 @@ bool uSockBlockingGet(uSockDescriptor_t descriptor)
 
     errnoLocal = init();
     if (errnoLocal == U_SOCK_ENONE) {
-
-        U_PORT_MUTEX_LOCK(gMutexContainer);
-
-        // Find the container
+        // Find and lock the container
         errnoLocal = U_SOCK_EBADF;
-        pContainer = pContainerFindByDescriptor(descriptor);
+        pContainer = pContainerLock(descriptor);
         if (pContainer != NULL) {
             errnoLocal = U_SOCK_ENONE;
             isBlocking = pContainer->socket.blocking;
+            containerUnlock(pContainer);
         }
-
-        U_PORT_MUTEX_UNLOCK(gMutexContainer);
     }
 
     if (errnoLocal != U_SOCK_ENONE) {
@@ -1646,12 +3246,9 @@ int32_t uSockOptionSet(uSockDescriptor_t descriptor,
 
     errnoLocal = init();
     if (errnoLocal == U_SOCK_ENONE) {
-
-        U_PORT_MUTEX_LOCK(gMutexContainer);
-
-        // Find the container
+        // Find and lock the container
         errnoLocal = U_SOCK_EBADF;
-        pContainer = pContainerFindByDescriptor(descriptor);
+        pContainer = pContainerLock(descriptor);
         if (pContainer != NULL) {
             errnoLocal = U_SOCK_EINVAL;
             // Check parameters
@@ -1718,9 +3315,8 @@ int32_t uSockOptionSet(uSockDescriptor_t descriptor,
                              sockHandle);
                 }
             }
+            containerUnlock(pContainer);
         }
-
-        U_PORT_MUTEX_UNLOCK(gMutexContainer);
     }
 
     if (errnoLocal != U_SOCK_ENONE) {
@@ -1746,12 +3342,9 @@ int32_t uSockOptionGet(uSockDescriptor_t descriptor,
 
     errnoLocal = init();
     if (errnoLocal == U_SOCK_ENONE) {
-
-        U_PORT_MUTEX_LOCK(gMutexContainer);
-
-        // Find the container
+        // Find and lock the container
         errnoLocal = U_SOCK_EBADF;
-        pContainer = pContainerFindByDescriptor(descriptor);
+        pContainer = pContainerLock(descriptor);
         if (pContainer != NULL) {
             errnoLocal = U_SOCK_EINVAL;
             // If there's an optionValue then there must be a length
@@ -1826,9 +3419,8 @@ int32_t uSockOptionGet(uSockDescriptor_t descriptor,
                     }
                 }
             }
+            containerUnlock(pContainer);
         }
-
-        U_PORT_MUTEX_UNLOCK(gMutexContainer);
     }
 
     if (errnoLocal != U_SOCK_ENONE) {
@@ -1852,12 +3444,9 @@ int32_t uSockSecurity(uSockDescriptor_t descriptor,
 
     errnoLocal = init();
     if (errnoLocal == U_SOCK_ENONE) {
-
-        U_PORT_MUTEX_LOCK(gMutexContainer);
-
-        // Find the container
+        // Find and lock the container
         errnoLocal = U_SOCK_EBADF;
-        pContainer = pContainerFindByDescriptor(descriptor);
+        pContainer = pContainerLock(descriptor);
         if (pContainer != NULL) {
             errnoLocal = U_SOCK_ENONE;
             // Talk to the common security layer
@@ -1892,9 +3481,8 @@ int32_t uSockSecurity(uSockDescriptor_t descriptor,
                                                   ((uCellSecTlsContext_t *) (pContainer->socket.pSecurityContext->pNetworkSpecific))->profileId);
                 }
             }
+            containerUnlock(pContainer);
         }
-
-        U_PORT_MUTEX_UNLOCK(gMutexContainer);
     }
 
     if (errnoLocal != U_SOCK_ENONE) {
@@ -1950,21 +3538,34 @@ int32_t uSockSetNextLocalPort(uDeviceHandle_t devHandle, int32_t port)
 int32_t uSockSendTo(uSockDescriptor_t descriptor,
                     const uSockAddress_t *pRemoteAddress,
                     const void *pData, size_t dataSizeBytes)
+{
+    uSockIoVec_t ioVec;
+
+    ioVec.pData = pData;
+    ioVec.dataSizeBytes = dataSizeBytes;
+
+    return uSockSendToV(descriptor, pRemoteAddress, &ioVec, 1);
+}
+
+// Send a datagram gathered from several pieces of data.
+int32_t uSockSendToV(uSockDescriptor_t descriptor,
+                     const uSockAddress_t *pRemoteAddress,
+                     const uSockIoVec_t *pIoVec, size_t ioVecCount)
 {
     int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t dataSizeBytes = uSockIoVecSize(pIoVec, ioVecCount);
     int32_t errnoLocal;
     uSockContainer_t *pContainer = NULL;
     uDeviceHandle_t devHandle;
     int32_t sockHandle;
 
+    U_LOG_RAM_TRACE_BEGIN(SOCK, SOCK_SEND_TO, descriptor);
+
     errnoLocal = init();
     if (errnoLocal == U_SOCK_ENONE) {
-
-        U_PORT_MUTEX_LOCK(gMutexContainer);
-
-        // Find the container
+        // Find and lock the container
         errnoLocal = U_SOCK_EBADF;
-        pContainer = pContainerFindByDescriptor(descriptor);
+        pContainer = pContainerLock(descriptor);
         if (pContainer != NULL) {
             // Check address and state
             if (pRemoteAddress != NULL) {
@@ -1997,11 +3598,11 @@ int32_t uSockSendTo(uSockDescriptor_t descriptor,
                 if ((pContainer->socket.protocol == U_SOCK_PROTOCOL_UDP) ||
                     (pContainer->socket.protocol == U_SOCK_PROTOCOL_TCP)) {
                     errnoLocal = U_SOCK_EINVAL;
-                    if ((pData == NULL) && (dataSizeBytes > 0)) {
+                    if (dataSizeBytes < 0) {
                         // Invalid argument
                     } else {
                         errnoLocal = U_SOCK_ENONE;
-                        if ((pData != NULL) && (dataSizeBytes > 0)) {
+                        if (dataSizeBytes > 0) {
                             // Talk to the underlying cell/wifi
                             // socket layer to send the datagram.
                             // uXxxSockSendTo() returns the number of
@@ -2011,25 +3612,29 @@ int32_t uSockSendTo(uSockDescriptor_t descriptor,
                             sockHandle = pContainer->socket.sockHandle;
                             errorCodeOrSize = -U_SOCK_ENOSYS;
                             int32_t devType = uDeviceGetDeviceType(devHandle);
+                            STATS_START(pContainer);
                             if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                                errorCodeOrSize = uCellSockSendTo(devHandle,
-                                                                  sockHandle,
-                                                                  pRemoteAddress,
-                                                                  pData,
-                                                                  dataSizeBytes);
+                                errorCodeOrSize = uCellSockSendToV(devHandle,
+                                                                   sockHandle,
+                                                                   pRemoteAddress,
+                                                                   pIoVec,
+                                                                   ioVecCount);
                                 if (errorCodeOrSize > 0) {
                                     pContainer->socket.bytesSent += errorCodeOrSize;
+                                    uDeviceMetricAdd(&gMetricTxBytes, (uint32_t) errorCodeOrSize);
                                 }
                             } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                                errorCodeOrSize = uWifiSockSendTo(devHandle,
-                                                                  sockHandle,
-                                                                  pRemoteAddress,
-                                                                  pData,
-                                                                  dataSizeBytes);
+                                errorCodeOrSize = uWifiSockSendToV(devHandle,
+                                                                   sockHandle,
+                                                                   pRemoteAddress,
+                                                                   pIoVec,
+                                                                   ioVecCount);
                                 if (errorCodeOrSize > 0) {
                                     pContainer->socket.bytesSent += errorCodeOrSize;
+                                    uDeviceMetricAdd(&gMetricTxBytes, (uint32_t) errorCodeOrSize);
                                 }
                             }
+                            STATS_SEND(pContainer, errorCodeOrSize);
 
                             if (errorCodeOrSize < 0) {
                                 // Set errno
@@ -2039,9 +3644,8 @@ int32_t uSockSendTo(uSockDescriptor_t descriptor,
                     }
                 }
             }
+            containerUnlock(pContainer);
         }
-
-        U_PORT_MUTEX_UNLOCK(gMutexContainer);
     }
 
     if (errnoLocal != U_SOCK_ENONE) {
@@ -2050,6 +3654,8 @@ int32_t uSockSendTo(uSockDescriptor_t descriptor,
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_BSD_ERROR;
     }
 
+    U_LOG_RAM_TRACE_END(SOCK, SOCK_SEND_TO, errorCodeOrSize);
+
     return errorCodeOrSize;
 }
 
@@ -2067,6 +3673,77 @@ int32_t uSockGetTotalBytesSent(uSockDescriptor_t descriptor)
     return errorCodeOrTotalBytesSent;
 }
 
+// Get the run-time statistics of a socket.
+int32_t uSockStatsGet(uSockDescriptor_t descriptor,
+                      uSockStats_t *pStats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+#ifdef U_CFG_SOCK_STATS
+    int32_t errnoLocal;
+    uSockContainer_t *pContainer;
+
+    errnoLocal = init();
+    if (errnoLocal == U_SOCK_ENONE) {
+        errnoLocal = U_SOCK_EINVAL;
+        if (pStats != NULL) {
+            // Find and lock the container
+            errnoLocal = U_SOCK_EBADF;
+            pContainer = pContainerLock(descriptor);
+            if (pContainer != NULL) {
+                *pStats = pContainer->socket.stats;
+                errnoLocal = U_SOCK_ENONE;
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                containerUnlock(pContainer);
+            }
+        }
+    }
+
+    if (errnoLocal != U_SOCK_ENONE) {
+        // Write the errno
+        errno = errnoLocal;
+        errorCode = (int32_t) U_ERROR_COMMON_BSD_ERROR;
+    }
+#else
+    (void) descriptor;
+    (void) pStats;
+#endif
+
+    return errorCode;
+}
+
+// Reset the run-time statistics of a socket.
+int32_t uSockStatsReset(uSockDescriptor_t descriptor)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+#ifdef U_CFG_SOCK_STATS
+    int32_t errnoLocal;
+    uSockContainer_t *pContainer;
+
+    errnoLocal = init();
+    if (errnoLocal == U_SOCK_ENONE) {
+        // Find and lock the container
+        errnoLocal = U_SOCK_EBADF;
+        pContainer = pContainerLock(descriptor);
+        if (pContainer != NULL) {
+            statsReset(pContainer);
+            errnoLocal = U_SOCK_ENONE;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            containerUnlock(pContainer);
+        }
+    }
+
+    if (errnoLocal != U_SOCK_ENONE) {
+        // Write the errno
+        errno = errnoLocal;
+        errorCode = (int32_t) U_ERROR_COMMON_BSD_ERROR;
+    }
+#else
+    (void) descriptor;
+#endif
+
+    return errorCode;
+}
+
 // Receive a single datagram from the given host.
 int32_t uSockReceiveFrom(uSockDescriptor_t descriptor,
                          uSockAddress_t *pRemoteAddress,
@@ -2076,14 +3753,13 @@ int32_t uSockReceiveFrom(uSockDescriptor_t descriptor,
     int32_t errnoLocal;
     uSockContainer_t *pContainer = NULL;
 
+    U_LOG_RAM_TRACE_BEGIN(SOCK, SOCK_RECEIVE_FROM, descriptor);
+
     errnoLocal = init();
     if (errnoLocal == U_SOCK_ENONE) {
-
-        U_PORT_MUTEX_LOCK(gMutexContainer);
-
-        // Find the container
+        // Find and lock the container
         errnoLocal = U_SOCK_EBADF;
-        pContainer = pContainerFindByDescriptor(descriptor);
+        pContainer = pContainerLock(descriptor);
         if (pContainer != NULL) {
             errnoLocal = U_SOCK_EPROTOTYPE;
             // It is OK to receive UDP-style on a TCP socket
@@ -2107,7 +3783,8 @@ int32_t uSockReceiveFrom(uSockDescriptor_t descriptor,
                                 errorCodeOrSize = receive(pContainer,
                                                           pRemoteAddress,
                                                           pData,
-                                                          dataSizeBytes);
+                                                          dataSizeBytes,
+                                                          false);
                                 if (errorCodeOrSize < 0) {
                                     // Set errno
                                     errnoLocal = -errorCodeOrSize;
@@ -2117,9 +3794,8 @@ int32_t uSockReceiveFrom(uSockDescriptor_t descriptor,
                     }
                 }
             }
+            containerUnlock(pContainer);
         }
-
-        U_PORT_MUTEX_UNLOCK(gMutexContainer);
     }
 
     if (errnoLocal != U_SOCK_ENONE) {
@@ -2128,9 +3804,234 @@ int32_t uSockReceiveFrom(uSockDescriptor_t descriptor,
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_BSD_ERROR;
     }
 
+    U_LOG_RAM_TRACE_END(SOCK, SOCK_RECEIVE_FROM, errorCodeOrSize);
+
     return errorCodeOrSize;
 }
 
+// Send several datagrams.
+int32_t uSockSendToBatch(uSockDescriptor_t descriptor,
+                         uSockDatagram_t *pDatagrams, size_t count)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t errnoLocal;
+    uSockContainer_t *pContainer = NULL;
+    uSockDatagram_t *pDatagram;
+    uDeviceHandle_t devHandle;
+    int32_t sockHandle;
+    int32_t devType;
+    size_t numSent = 0;
+
+    errnoLocal = init();
+    if (errnoLocal == U_SOCK_ENONE) {
+        // Find and lock the container
+        errnoLocal = U_SOCK_EBADF;
+        pContainer = pContainerLock(descriptor);
+        if (pContainer != NULL) {
+            errnoLocal = U_SOCK_EPROTOTYPE;
+            // It is OK to send UDP packets on a TCP socket
+            if ((pContainer->socket.protocol == U_SOCK_PROTOCOL_UDP) ||
+                (pContainer->socket.protocol == U_SOCK_PROTOCOL_TCP)) {
+                errnoLocal = U_SOCK_ESHUTDOWN;
+                if ((pContainer->socket.state != U_SOCK_STATE_SHUTDOWN_FOR_WRITE) &&
+                    (pContainer->socket.state != U_SOCK_STATE_SHUTDOWN_FOR_READ_WRITE)) {
+                    errnoLocal = U_SOCK_EINVAL;
+                    if ((pDatagrams != NULL) || (count == 0)) {
+                        errnoLocal = U_SOCK_ENONE;
+                        if (count > 0) {
+                            // Talk to the underlying cell/wifi
+                            // socket layer to send the datagrams.
+                            // uXxxSockSendToBatch() returns the
+                            // number of datagrams sent or a negated
+                            // value of errno from the U_SOCK_Exxx list.
+                            devHandle = pContainer->socket.devHandle;
+                            sockHandle = pContainer->socket.sockHandle;
+                            errorCodeOrCount = -U_SOCK_ENOSYS;
+                            devType = uDeviceGetDeviceType(devHandle);
+                            STATS_START(pContainer);
+                            if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
+                                errorCodeOrCount = uCellSockSendToBatch(devHandle,
+                                                                        sockHandle,
+                                                                        pDatagrams,
+                                                                        count);
+                                // Count the batch as one call
+                                STATS_SEND(pContainer, (errorCodeOrCount > 0) ? 0 : errorCodeOrCount);
+                                for (int32_t x = 0; x < errorCodeOrCount; x++) {
+                                    pContainer->socket.bytesSent += pDatagrams[x].sizeBytes;
+                                    uDeviceMetricAdd(&gMetricTxBytes,
+                                                     (uint32_t) pDatagrams[x].sizeBytes);
+#ifdef U_CFG_SOCK_STATS
+                                    pContainer->socket.stats.txBytes += (uint32_t) pDatagrams[x].sizeBytes;
+                                    pContainer->socket.stats.txSegments++;
+#endif
+                                }
+                            } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
+                                // The Wi-Fi layer has no batch call,
+                                // send the datagrams in turn
+                                errorCodeOrCount = 0;
+                                while ((numSent < count) && (errorCodeOrCount >= 0)) {
+                                    pDatagram = &(pDatagrams[numSent]);
+                                    errorCodeOrCount = -U_SOCK_EINVAL;
+                                    if (pDatagram->dataSizeBytes > INT_MAX) {
+                                        // Invalid argument
+                                    } else if (pDatagram->dataSizeBytes == 0) {
+                                        errorCodeOrCount = 0;
+                                    } else if (pDatagram->pData != NULL) {
+                                        STATS_START(pContainer);
+                                        errorCodeOrCount = uWifiSockSendTo(devHandle,
+                                                                           sockHandle,
+                                                                           &(pDatagram->address),
+                                                                           pDatagram->pData,
+                                                                           pDatagram->dataSizeBytes);
+                                        STATS_SEND(pContainer, errorCodeOrCount);
+                                    }
+                                    pDatagram->sizeBytes = errorCodeOrCount;
+                                    if (errorCodeOrCount >= 0) {
+                                        pContainer->socket.bytesSent += errorCodeOrCount;
+                                        uDeviceMetricAdd(&gMetricTxBytes,
+                                                         (uint32_t) errorCodeOrCount);
+                                        numSent++;
+                                    }
+                                }
+                                if (numSent > 0) {
+                                    errorCodeOrCount = (int32_t) numSent;
+                                }
+                            }
+
+                            if (errorCodeOrCount < 0) {
+                                // Set errno
+                                errnoLocal = -errorCodeOrCount;
+                            }
+                        }
+                    }
+                }
+            }
+            containerUnlock(pContainer);
+        }
+    }
+
+    if (errnoLocal != U_SOCK_ENONE) {
+        // Write the errno
+        errno = errnoLocal;
+        errorCodeOrCount = (int32_t) U_ERROR_COMMON_BSD_ERROR;
+    }
+
+    return errorCodeOrCount;
+}
+
+// Receive several datagrams.
+int32_t uSockReceiveFromBatch(uSockDescriptor_t descriptor,
+                              uSockDatagram_t *pDatagrams,
+                              size_t count)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t errnoLocal;
+    uSockContainer_t *pContainer = NULL;
+    uSockDatagram_t *pDatagram;
+    int32_t negErrnoOrSize;
+    int32_t negErrnoOrCount;
+    size_t numReceived = 0;
+
+    errnoLocal = init();
+    if (errnoLocal == U_SOCK_ENONE) {
+        // Find and lock the container
+        errnoLocal = U_SOCK_EBADF;
+        pContainer = pContainerLock(descriptor);
+        if (pContainer != NULL) {
+            errnoLocal = U_SOCK_EPROTOTYPE;
+            // It is OK to receive UDP-style on a TCP socket
+            if ((pContainer->socket.protocol == U_SOCK_PROTOCOL_UDP) ||
+                (pContainer->socket.protocol == U_SOCK_PROTOCOL_TCP)) {
+                errnoLocal = U_SOCK_ENOTCONN;
+                if (pContainer->socket.state != U_SOCK_STATE_CLOSING) {
+                    errnoLocal = U_SOCK_ESHUTDOWN;
+                    if ((pContainer->socket.state != U_SOCK_STATE_SHUTDOWN_FOR_READ) &&
+                        (pContainer->socket.state != U_SOCK_STATE_SHUTDOWN_FOR_READ_WRITE)) {
+                        errnoLocal = U_SOCK_EINVAL;
+                        if ((pDatagrams != NULL) && (count > 0)) {
+                            errnoLocal = U_SOCK_ENONE;
+                            for (size_t x = 0; (x < count) &&
+                                 (errnoLocal == U_SOCK_ENONE); x++) {
+                                if ((pDatagrams[x].pData == NULL) ||
+                                    (pDatagrams[x].dataSizeBytes == 0)) {
+                                    // Invalid argument
+                                    errnoLocal = U_SOCK_EINVAL;
+                                }
+                            }
+                        }
+                        if (errnoLocal == U_SOCK_ENONE) {
+                            // Receive the first datagram in the
+                            // usual way, so that the blocking
+                            // rules are obeyed
+                            pDatagram = &(pDatagrams[0]);
+                            negErrnoOrSize = receive(pContainer,
+                                                     &(pDatagram->address),
+                                                     pDatagram->pData,
+                                                     pDatagram->dataSizeBytes,
+                                                     false);
+                            if (negErrnoOrSize >= 0) {
+                                pDatagram->sizeBytes = negErrnoOrSize;
+                                numReceived = 1;
+                                // Now take whatever else is
+                                // already waiting
+                                if ((count > 1) &&
+                                    (uDeviceGetDeviceType(pContainer->socket.devHandle) ==
+                                     (int32_t) U_DEVICE_TYPE_CELL)) {
+                                    negErrnoOrCount = uCellSockReceiveFromBatch(pContainer->socket.devHandle,
+                                                                                pContainer->socket.sockHandle,
+                                                                                pDatagrams + 1,
+                                                                                count - 1);
+                                    if (negErrnoOrCount > 0) {
+                                        numReceived += (size_t) negErrnoOrCount;
+                                    }
+                                    for (size_t x = 1; x < numReceived; x++) {
+                                        uDeviceMetricAdd(&gMetricRxBytes,
+                                                         (uint32_t) pDatagrams[x].sizeBytes);
+                                    }
+#ifdef U_CFG_SOCK_STATS
+                                    // Count the batch as one call
+                                    pContainer->socket.stats.numCalls++;
+                                    for (size_t x = 1; x < numReceived; x++) {
+                                        statsRead(pContainer, pDatagrams[x].sizeBytes,
+                                                  pDatagrams[x].dataSizeBytes);
+                                    }
+#endif
+                                } else {
+                                    while ((numReceived < count) && (negErrnoOrSize >= 0)) {
+                                        pDatagram = &(pDatagrams[numReceived]);
+                                        negErrnoOrSize = receive(pContainer,
+                                                                 &(pDatagram->address),
+                                                                 pDatagram->pData,
+                                                                 pDatagram->dataSizeBytes,
+                                                                 true);
+                                        if (negErrnoOrSize >= 0) {
+                                            pDatagram->sizeBytes = negErrnoOrSize;
+                                            numReceived++;
+                                        }
+                                    }
+                                }
+                                errorCodeOrCount = (int32_t) numReceived;
+                            } else {
+                                // Set errno
+                                errnoLocal = -negErrnoOrSize;
+                            }
+                        }
+                    }
+                }
+            }
+            containerUnlock(pContainer);
+        }
+    }
+
+    if (errnoLocal != U_SOCK_ENONE) {
+        // Write the errno
+        errno = errnoLocal;
+        errorCodeOrCount = (int32_t) U_ERROR_COMMON_BSD_ERROR;
+    }
+
+    return errorCodeOrCount;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: STREAM (TCP)
  * -------------------------------------------------------------- */
@@ -2138,82 +4039,70 @@ int32_t uSockReceiveFrom(uSockDescriptor_t descriptor,
 // Send data.
 int32_t uSockWrite(uSockDescriptor_t descriptor,
                    const void *pData, size_t dataSizeBytes)
+{
+    uSockIoVec_t ioVec;
+
+    ioVec.pData = pData;
+    ioVec.dataSizeBytes = dataSizeBytes;
+
+    return uSockWritev(descriptor, &ioVec, 1);
+}
+
+// Send data gathered from several pieces.
+int32_t uSockWritev(uSockDescriptor_t descriptor,
+                    const uSockIoVec_t *pIoVec, size_t ioVecCount)
 {
     int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t dataSizeBytes = uSockIoVecSize(pIoVec, ioVecCount);
     int32_t errnoLocal;
     uSockContainer_t *pContainer = NULL;
     uDeviceHandle_t devHandle;
-    int32_t sockHandle;
+
+    U_LOG_RAM_TRACE_BEGIN(SOCK, SOCK_WRITE, descriptor);
 
     errnoLocal = init();
     if (errnoLocal == U_SOCK_ENONE) {
-
-        U_PORT_MUTEX_LOCK(gMutexContainer);
-
-        // Find the container
+        // Find and lock the container
         errnoLocal = U_SOCK_EBADF;
-        pContainer = pContainerFindByDescriptor(descriptor);
+        pContainer = pContainerLock(descriptor);
         if (pContainer != NULL) {
             errnoLocal = U_SOCK_EPROTOTYPE;
             if (pContainer->socket.protocol == U_SOCK_PROTOCOL_TCP) {
-                if (pContainer->socket.state == U_SOCK_STATE_CONNECTED) {
+                errnoLocal = writeStateCheck(pContainer);
+                if (errnoLocal == U_SOCK_ENONE) {
                     errnoLocal = U_SOCK_EINVAL;
-                    if (((pData == NULL) && (dataSizeBytes > 0)) ||
-                        (dataSizeBytes > INT_MAX)) {
+                    if (dataSizeBytes < 0) {
                         // Invalid argument
                     } else {
-                        errnoLocal = U_SOCK_ENONE;
-                        if ((pData != NULL) && (dataSizeBytes != 0)) {
+                        // Anything deferred must go first, to
+                        // keep the stream in order
+                        errnoLocal = deferredFlushLocked(pContainer);
+                        if ((errnoLocal == U_SOCK_ENONE) &&
+                            (pContainer->socket.deferredLength > 0)) {
+                            errnoLocal = U_SOCK_EWOULDBLOCK;
+                        }
+                        if ((errnoLocal == U_SOCK_ENONE) && (dataSizeBytes > 0)) {
                             // Talk to the underlying cell/wifi
-                            // socket layer to send the datagram.
-                            // uXxxSockWrite() returns the number
-                            // of bytes sent or a negated value of
-                            // errno from the U_SOCK_Exxx list.
+                            // socket layer to send the data
                             devHandle = pContainer->socket.devHandle;
-                            sockHandle = pContainer->socket.sockHandle;
-                            errorCodeOrSize = -U_SOCK_ENOSYS;
-                            int32_t devType = uDeviceGetDeviceType(devHandle);
-                            if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                                errorCodeOrSize = uCellSockWrite(devHandle,
-                                                                 sockHandle,
-                                                                 pData,
-                                                                 dataSizeBytes);
-                                if (errorCodeOrSize > 0) {
-                                    pContainer->socket.bytesSent += errorCodeOrSize;
-                                }
-                            } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                                errorCodeOrSize = uWifiSockWrite(devHandle,
-                                                                 sockHandle,
-                                                                 pData,
-                                                                 dataSizeBytes);
-                                if (errorCodeOrSize > 0) {
-                                    pContainer->socket.bytesSent += errorCodeOrSize;
-                                }
-                            }
-
+                            errorCodeOrSize = writeLocked(pContainer, pIoVec,
+                                                          ioVecCount);
                             if (errorCodeOrSize < 0) {
                                 // Set errno
                                 errnoLocal = -errorCodeOrSize;
+                            } else {
+                                // The radio is now awake, let any
+                                // other deferred data go too
+                                U_PORT_MUTEX_LOCK(gMutexCallbacks);
+                                deferredWakeDevice(devHandle);
+                                U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
                             }
                         }
                     }
-                } else {
-                    if ((pContainer->socket.state == U_SOCK_STATE_SHUTDOWN_FOR_READ) ||
-                        (pContainer->socket.state == U_SOCK_STATE_SHUTDOWN_FOR_READ_WRITE)) {
-                        // Socket is shut down
-                        errnoLocal = U_SOCK_ESHUTDOWN;
-                    } else if (pContainer->socket.state == U_SOCK_STATE_CLOSING) {
-                        // Not connected mate
-                        errnoLocal = U_SOCK_ENOTCONN;
-                    } else {
-                        // No route to host?
-                        errnoLocal = U_SOCK_EHOSTUNREACH;
-                    }
                 }
             }
+            containerUnlock(pContainer);
         }
-
-        U_PORT_MUTEX_UNLOCK(gMutexContainer);
     }
 
     if (errnoLocal != U_SOCK_ENONE) {
@@ -2222,63 +4111,113 @@ int32_t uSockWrite(uSockDescriptor_t descriptor,
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_BSD_ERROR;
     }
 
+    U_LOG_RAM_TRACE_END(SOCK, SOCK_WRITE, errorCodeOrSize);
+
     return errorCodeOrSize;
 }
 
-// Receive data.
-int32_t uSockRead(uSockDescriptor_t descriptor,
-                  void *pData, size_t dataSizeBytes)
+// Send data when the radio is awake anyway.
+int32_t uSockWriteDeferred(uSockDescriptor_t descriptor,
+                           const void *pData, size_t dataSizeBytes,
+                           int32_t deadlineMs)
 {
     int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_SUCCESS;
     int32_t errnoLocal;
     uSockContainer_t *pContainer = NULL;
+    uDeviceHandle_t devHandle;
+    bool sendNow = true;
+    int32_t deadlineTimeMs;
+    uSockIoVec_t ioVec;
 
     errnoLocal = init();
     if (errnoLocal == U_SOCK_ENONE) {
-
-        U_PORT_MUTEX_LOCK(gMutexContainer);
-
-        // Find the container
+        // Find and lock the container
         errnoLocal = U_SOCK_EBADF;
-        pContainer = pContainerFindByDescriptor(descriptor);
+        pContainer = pContainerLock(descriptor);
         if (pContainer != NULL) {
             errnoLocal = U_SOCK_EPROTOTYPE;
             if (pContainer->socket.protocol == U_SOCK_PROTOCOL_TCP) {
-                if (pContainer->socket.state == U_SOCK_STATE_CONNECTED) {
+                errnoLocal = writeStateCheck(pContainer);
+                if ((errnoLocal == U_SOCK_ENONE) &&
+                    (pData == NULL) && (dataSizeBytes > 0)) {
                     errnoLocal = U_SOCK_EINVAL;
-                    if (((pData == NULL) && (dataSizeBytes > 0)) ||
-                        (dataSizeBytes > INT_MAX)) {
-                        // Invalid argument
+                }
+                if ((errnoLocal == U_SOCK_ENONE) && (dataSizeBytes > 0)) {
+                    devHandle = pContainer->socket.devHandle;
+                    errorCodeOrSize = (int32_t) dataSizeBytes;
+                    if (deadlineMs > 0) {
+                        // Deferral needs the event task and the timer
+                        U_PORT_MUTEX_LOCK(gMutexCallbacks);
+                        if ((asyncQueueOpen() == U_SOCK_ENONE) &&
+                            (gDeferredTimer == NULL)) {
+                            uPortTimerCreate(&gDeferredTimer, "sockDeferred",
+                                             deferredTimerCallback, NULL,
+                                             U_SOCK_DEFERRED_TICK_MS, true);
+                        }
+                        sendNow = (gAsyncEventQueue < 0) || (gDeferredTimer == NULL);
+                        U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+                    }
+                    if (!sendNow) {
+                        // No point in waiting if the data won't
+                        // fit or the radio is awake anyway
+                        sendNow = (pContainer->socket.deferredLength + dataSizeBytes >
+                                   U_SOCK_DEFERRED_MAX_NUM_BYTES) ||
+                                  deferredRadioIsAwake(devHandle);
+                    }
+                    if (!sendNow && (pContainer->socket.pDeferred == NULL)) {
+                        pContainer->socket.pDeferred = (char *) pUPortMalloc(U_SOCK_DEFERRED_MAX_NUM_BYTES);
+                        sendNow = (pContainer->socket.pDeferred == NULL);
+                    }
+                    if (!sendNow) {
+                        // Queue the data, keeping the earliest deadline
+                        deadlineTimeMs = uPortGetTickTimeMs() + deadlineMs;
+                        if ((pContainer->socket.deferredLength == 0) ||
+                            (deadlineTimeMs - pContainer->socket.deferredDeadlineMs < 0)) {
+                            pContainer->socket.deferredDeadlineMs = deadlineTimeMs;
+                        }
+                        memcpy(pContainer->socket.pDeferred + pContainer->socket.deferredLength,
+                               pData, dataSizeBytes);
+                        pContainer->socket.deferredLength += dataSizeBytes;
+                        // Start the timer only now that the data is
+                        // queued, see deferredService()
+                        U_PORT_MUTEX_LOCK(gMutexCallbacks);
+                        if (!gDeferredActive &&
+                            (uPortTimerStart(gDeferredTimer) == 0)) {
+                            gDeferredActive = true;
+                        }
+                        sendNow = !gDeferredActive;
+                        U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+                        if (sendNow) {
+                            // Can't wait without a timer
+                            deferredFlushLocked(pContainer);
+                        }
                     } else {
-                        errnoLocal = U_SOCK_ENONE;
-                        if ((pData != NULL) && (dataSizeBytes != 0)) {
-                            // Receive the datagram
-                            errorCodeOrSize = receive(pContainer,
-                                                      NULL, pData,
-                                                      dataSizeBytes);
+                        // Send anything already queued, to keep the
+                        // stream in order, and then this
+                        errnoLocal = deferredFlushLocked(pContainer);
+                        if ((errnoLocal == U_SOCK_ENONE) &&
+                            (pContainer->socket.deferredLength > 0)) {
+                            errnoLocal = U_SOCK_EWOULDBLOCK;
+                        }
+                        if (errnoLocal == U_SOCK_ENONE) {
+                            ioVec.pData = pData;
+                            ioVec.dataSizeBytes = dataSizeBytes;
+                            errorCodeOrSize = writeLocked(pContainer, &ioVec, 1);
                             if (errorCodeOrSize < 0) {
-                                // Set errno
                                 errnoLocal = -errorCodeOrSize;
+                            } else {
+                                // The radio is now awake, let any
+                                // other deferred data go too
+                                U_PORT_MUTEX_LOCK(gMutexCallbacks);
+                                deferredWakeDevice(devHandle);
+                                U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
                             }
                         }
                     }
-                } else {
-                    if ((pContainer->socket.state == U_SOCK_STATE_SHUTDOWN_FOR_READ) ||
-                        (pContainer->socket.state == U_SOCK_STATE_SHUTDOWN_FOR_READ_WRITE)) {
-                        // Socket is shut down
-                        errnoLocal = U_SOCK_ESHUTDOWN;
-                    } else if (pContainer->socket.state == U_SOCK_STATE_CLOSING) {
-                        // Not connected mate
-                        errnoLocal = U_SOCK_ENOTCONN;
-                    } else {
-                        // No route to host?
-                        errnoLocal = U_SOCK_EHOSTUNREACH;
-                    }
                 }
             }
+            containerUnlock(pContainer);
         }
-
-        U_PORT_MUTEX_UNLOCK(gMutexContainer);
     }
 
     if (errnoLocal != U_SOCK_ENONE) {
@@ -2290,6 +4229,19 @@ int32_t uSockRead(uSockDescriptor_t descriptor,
     return errorCodeOrSize;
 }
 
+// Receive data.
+int32_t uSockRead(uSockDescriptor_t descriptor,
+                  void *pData, size_t dataSizeBytes)
+{
+    int32_t errorCodeOrSize;
+
+    U_LOG_RAM_TRACE_BEGIN(SOCK, SOCK_READ, descriptor);
+    errorCodeOrSize = sockRead(descriptor, pData, dataSizeBytes, false);
+    U_LOG_RAM_TRACE_END(SOCK, SOCK_READ, errorCodeOrSize);
+
+    return errorCodeOrSize;
+}
+
 // Prepare a TCP socket for being closed.
 // Note: this does not need to reference the underlying
 // cell/wifi socket layer.
@@ -2302,12 +4254,9 @@ int32_t uSockShutdown(uSockDescriptor_t descriptor,
 
     errnoLocal = init();
     if (errnoLocal == U_SOCK_ENONE) {
-
-        U_PORT_MUTEX_LOCK(gMutexContainer);
-
-        // Find the container
+        // Find and lock the container
         errnoLocal = U_SOCK_EBADF;
-        pContainer = pContainerFindByDescriptor(descriptor);
+        pContainer = pContainerLock(descriptor);
         if (pContainer != NULL) {
             // Set the socket state
             switch (how) {
@@ -2327,9 +4276,8 @@ int32_t uSockShutdown(uSockDescriptor_t descriptor,
                     errnoLocal = U_SOCK_EINVAL;
                     break;
             }
+            containerUnlock(pContainer);
         }
-
-        U_PORT_MUTEX_UNLOCK(gMutexContainer);
     }
 
     if (errnoLocal != U_SOCK_ENONE) {
@@ -2357,12 +4305,9 @@ void uSockRegisterCallbackData(uSockDescriptor_t descriptor,
 
     errnoLocal = init();
     if (errnoLocal == U_SOCK_ENONE) {
-
-        U_PORT_MUTEX_LOCK(gMutexContainer);
-
-        // Find the container
+        // Find and lock the container
         errnoLocal = U_SOCK_EBADF;
-        pContainer = pContainerFindByDescriptor(descriptor);
+        pContainer = pContainerLock(descriptor);
         if (pContainer != NULL) {
             U_PORT_MUTEX_LOCK(gMutexCallbacks);
 
@@ -2389,9 +4334,8 @@ void uSockRegisterCallbackData(uSockDescriptor_t descriptor,
             }
 
             U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+            containerUnlock(pContainer);
         }
-
-        U_PORT_MUTEX_UNLOCK(gMutexContainer);
     }
 
     if (errnoLocal != U_SOCK_ENONE) {
@@ -2412,12 +4356,9 @@ void uSockRegisterCallbackClosed(uSockDescriptor_t descriptor,
 
     errnoLocal = init();
     if (errnoLocal == U_SOCK_ENONE) {
-
-        U_PORT_MUTEX_LOCK(gMutexContainer);
-
-        // Find the container
+        // Find and lock the container
         errnoLocal = U_SOCK_EBADF;
-        pContainer = pContainerFindByDescriptor(descriptor);
+        pContainer = pContainerLock(descriptor);
         if (pContainer != NULL) {
 
             U_PORT_MUTEX_LOCK(gMutexCallbacks);
@@ -2445,15 +4386,195 @@ void uSockRegisterCallbackClosed(uSockDescriptor_t descriptor,
             }
 
             U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+            containerUnlock(pContainer);
         }
+    }
 
-        U_PORT_MUTEX_UNLOCK(gMutexContainer);
+    if (errnoLocal != U_SOCK_ENONE) {
+        // Write the errno
+        errno = errnoLocal;
+    }
+}
+
+// Make an outgoing connection asynchronously.
+int32_t uSockConnectAsync(uSockDescriptor_t descriptor,
+                          const uSockAddress_t *pRemoteAddress,
+                          uSockAsyncCallback_t *pCallback,
+                          void *pParameter)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t errnoLocal;
+    uSockContainer_t *pContainer = NULL;
+    uSockAsyncOp_t op;
+    uDeviceHandle_t devHandle;
+    int32_t sockHandle;
+
+    errnoLocal = init();
+    if (errnoLocal == U_SOCK_ENONE) {
+        errnoLocal = U_SOCK_EINVAL;
+        if ((pRemoteAddress != NULL) && (pCallback != NULL)) {
+            // Find and lock the container
+            pContainer = pContainerLock(descriptor);
+            errnoLocal = U_SOCK_EBADF;
+            if (pContainer != NULL) {
+                errnoLocal = U_SOCK_EPERM;
+                if (pContainer->socket.state == U_SOCK_STATE_CREATED) {
+                    devHandle = pContainer->socket.devHandle;
+                    sockHandle = pContainer->socket.sockHandle;
+                    memset(&op, 0, sizeof(op));
+                    op.type = U_SOCK_ASYNC_TYPE_CONNECT;
+                    op.pCallback = pCallback;
+                    op.pCallbackParameter = pParameter;
+                    memcpy(&(op.remoteAddress), pRemoteAddress,
+                           sizeof(op.remoteAddress));
+                    // A cellular module may be able to connect in
+                    // the background: mark the operation as such
+                    // before asking, since the outcome may be
+                    // reported before uCellSockConnectAsync() returns
+                    op.inModule = (uDeviceGetDeviceType(devHandle) ==
+                                   (int32_t) U_DEVICE_TYPE_CELL);
+                    errnoLocal = asyncStart(pContainer,
+                                            U_SOCK_ASYNC_SLOT_CONNECT_WRITE,
+                                            &op, !op.inModule);
+                    if ((errnoLocal == U_SOCK_ENONE) && op.inModule) {
+                        pContainer->socket.state = U_SOCK_STATE_CONNECTING;
+                        STATS_START(pContainer);
+                        // uCellSockConnectAsync() returns a negated
+                        // value of errno from the U_SOCK_Exxx list
+                        errorCode = uCellSockConnectAsync(devHandle,
+                                                          sockHandle,
+                                                          pRemoteAddress,
+                                                          connectCallback);
+                        if (errorCode < 0) {
+                            pContainer->socket.state = U_SOCK_STATE_CREATED;
+                            U_PORT_MUTEX_LOCK(gMutexCallbacks);
+                            if (errorCode == -U_SOCK_ENOSYS) {
+                                // Not supported by this module, perform
+                                // a uSockConnect() in the event task
+                                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                                pContainer->socket.asyncOp[U_SOCK_ASYNC_SLOT_CONNECT_WRITE].inModule = false;
+                                asyncPost(pContainer, U_SOCK_ASYNC_SLOT_CONNECT_WRITE);
+                            } else {
+                                // Set errno
+                                errnoLocal = -errorCode;
+                                pContainer->socket.asyncOp[U_SOCK_ASYNC_SLOT_CONNECT_WRITE].type =
+                                    U_SOCK_ASYNC_TYPE_NONE;
+                            }
+                            U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+                        }
+                    }
+                }
+                containerUnlock(pContainer);
+            }
+        }
+    }
+
+    if (errnoLocal != U_SOCK_ENONE) {
+        // Write the errno
+        errno = errnoLocal;
+        errorCode = (int32_t) U_ERROR_COMMON_BSD_ERROR;
+    }
+
+    return errorCode;
+}
+
+// Send data asynchronously.
+int32_t uSockWriteAsync(uSockDescriptor_t descriptor,
+                        const void *pData, size_t dataSizeBytes,
+                        uSockAsyncCallback_t *pCallback,
+                        void *pParameter)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t errnoLocal;
+    uSockContainer_t *pContainer = NULL;
+    uSockAsyncOp_t op;
+
+    errnoLocal = init();
+    if (errnoLocal == U_SOCK_ENONE) {
+        errnoLocal = U_SOCK_EINVAL;
+        if ((pCallback != NULL) && (dataSizeBytes <= INT_MAX) &&
+            ((pData != NULL) || (dataSizeBytes == 0))) {
+            // Find and lock the container
+            pContainer = pContainerLock(descriptor);
+            errnoLocal = U_SOCK_EBADF;
+            if (pContainer != NULL) {
+                errnoLocal = U_SOCK_EPROTOTYPE;
+                if (pContainer->socket.protocol == U_SOCK_PROTOCOL_TCP) {
+                    memset(&op, 0, sizeof(op));
+                    op.type = U_SOCK_ASYNC_TYPE_WRITE;
+                    op.pCallback = pCallback;
+                    op.pCallbackParameter = pParameter;
+                    //lint -e(605) Suppress increase in pointer capability:
+                    // the data is only ever passed to uSockWrite()
+                    op.pData = (void *) pData;
+                    op.dataSizeBytes = dataSizeBytes;
+                    // Any checking of the socket state is
+                    // done by uSockWrite() in the event task
+                    errnoLocal = asyncStart(pContainer,
+                                            U_SOCK_ASYNC_SLOT_CONNECT_WRITE,
+                                            &op, true);
+                }
+                containerUnlock(pContainer);
+            }
+        }
+    }
+
+    if (errnoLocal != U_SOCK_ENONE) {
+        // Write the errno
+        errno = errnoLocal;
+        errorCode = (int32_t) U_ERROR_COMMON_BSD_ERROR;
+    }
+
+    return errorCode;
+}
+
+// Receive data asynchronously.
+int32_t uSockReadAsync(uSockDescriptor_t descriptor,
+                       void *pData, size_t dataSizeBytes,
+                       uSockAsyncCallback_t *pCallback,
+                       void *pParameter)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t errnoLocal;
+    uSockContainer_t *pContainer = NULL;
+    uSockAsyncOp_t op;
+
+    errnoLocal = init();
+    if (errnoLocal == U_SOCK_ENONE) {
+        errnoLocal = U_SOCK_EINVAL;
+        if ((pCallback != NULL) && (pData != NULL) &&
+            (dataSizeBytes > 0) && (dataSizeBytes <= INT_MAX)) {
+            // Find and lock the container
+            pContainer = pContainerLock(descriptor);
+            errnoLocal = U_SOCK_EBADF;
+            if (pContainer != NULL) {
+                errnoLocal = U_SOCK_EPROTOTYPE;
+                if (pContainer->socket.protocol == U_SOCK_PROTOCOL_TCP) {
+                    memset(&op, 0, sizeof(op));
+                    op.type = U_SOCK_ASYNC_TYPE_READ;
+                    op.pCallback = pCallback;
+                    op.pCallbackParameter = pParameter;
+                    op.pData = pData;
+                    op.dataSizeBytes = dataSizeBytes;
+                    // Post straight away as data may already
+                    // be waiting; if not the event task will
+                    // wait for dataCallback() to post again
+                    errnoLocal = asyncStart(pContainer,
+                                            U_SOCK_ASYNC_SLOT_READ,
+                                            &op, true);
+                }
+                containerUnlock(pContainer);
+            }
+        }
     }
 
     if (errnoLocal != U_SOCK_ENONE) {
         // Write the errno
         errno = errnoLocal;
+        errorCode = (int32_t) U_ERROR_COMMON_BSD_ERROR;
     }
+
+    return errorCode;
 }
 
 /* ----------------------------------------------------------------
@@ -2494,20 +4615,83 @@ int32_t uSockAccept(uSockDescriptor_t descriptor,
 }
 
 // Select: wait for one of a set of sockets to become unblocked.
+// Note: this does not need to reference the underlying
+// cell/wifi socket layer, readiness is tracked through the
+// callbacks, hence no AT traffic results while waiting.
 int32_t uSockSelect(int32_t maxDescriptor,
                     uSockDescriptorSet_t *pReadDescriptorSet,
-                    uSockDescriptorSet_t *pWriteDescriptoreSet,
+                    uSockDescriptorSet_t *pWriteDescriptorSet,
                     uSockDescriptorSet_t *pExceptDescriptorSet,
                     int32_t timeMs)
 {
-    // TODO
-    (void) maxDescriptor;
-    (void) pReadDescriptorSet;
-    (void) pWriteDescriptoreSet;
-    (void) pExceptDescriptorSet;
-    (void) timeMs;
-    errno = U_SOCK_ENOSYS;
-    return (int32_t) U_ERROR_COMMON_NOT_IMPLEMENTED;
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t errnoLocal;
+    uSockDescriptorSet_t readSet;
+    uSockDescriptorSet_t writeSet;
+    uSockDescriptorSet_t exceptSet;
+    int32_t startTimeMs;
+    int32_t waitMs;
+
+    errnoLocal = init();
+    if (errnoLocal == U_SOCK_ENONE) {
+        errnoLocal = U_SOCK_EINVAL;
+        if ((maxDescriptor >= 0) &&
+            (maxDescriptor <= U_SOCK_DESCRIPTOR_SET_SIZE) &&
+            (timeMs >= 0)) {
+            errnoLocal = U_SOCK_ENONE;
+            startTimeMs = uPortGetTickTimeMs();
+            do {
+                U_SOCK_FD_ZERO(&readSet);
+                U_SOCK_FD_ZERO(&writeSet);
+                U_SOCK_FD_ZERO(&exceptSet);
+
+                U_PORT_MUTEX_LOCK(gMutexContainer);
+                errorCodeOrCount = selectCheck(maxDescriptor,
+                                               pReadDescriptorSet,
+                                               pWriteDescriptorSet,
+                                               pExceptDescriptorSet,
+                                               &readSet, &writeSet,
+                                               &exceptSet);
+                U_PORT_MUTEX_UNLOCK(gMutexContainer);
+
+                if (errorCodeOrCount == 0) {
+                    // Nothing is ready: wait for a callback
+                    // to wake us up or for the timeout
+                    waitMs = timeMs - (uPortGetTickTimeMs() - startTimeMs);
+                    if (waitMs > U_SOCK_SELECT_WAIT_MAX_MS) {
+                        waitMs = U_SOCK_SELECT_WAIT_MAX_MS;
+                    }
+                    if (waitMs > 0) {
+                        uPortSemaphoreTryTake(gSemaphoreSelect, waitMs);
+                    }
+                }
+            } while ((errorCodeOrCount == 0) &&
+                     (uPortGetTickTimeMs() - startTimeMs < timeMs));
+
+            if (errorCodeOrCount >= 0) {
+                // Return the result in the caller's sets
+                if (pReadDescriptorSet != NULL) {
+                    memcpy(*pReadDescriptorSet, readSet, sizeof(readSet));
+                }
+                if (pWriteDescriptorSet != NULL) {
+                    memcpy(*pWriteDescriptorSet, writeSet, sizeof(writeSet));
+                }
+                if (pExceptDescriptorSet != NULL) {
+                    memcpy(*pExceptDescriptorSet, exceptSet, sizeof(exceptSet));
+                }
+            } else {
+                errnoLocal = -errorCodeOrCount;
+            }
+        }
+    }
+
+    if (errnoLocal != U_SOCK_ENONE) {
+        // Write the errno
+        errno = errnoLocal;
+        errorCodeOrCount = (int32_t) U_ERROR_COMMON_BSD_ERROR;
+    }
+
+    return errorCodeOrCount;
 }
 
 /* ----------------------------------------------------------------
@@ -2529,12 +4713,9 @@ int32_t uSockGetRemoteAddress(uSockDescriptor_t descriptor,
         errnoLocal = U_SOCK_EINVAL;
         // Check parameters
         if (pRemoteAddress != NULL) {
-
-            U_PORT_MUTEX_LOCK(gMutexContainer);
-
-            // Find the container
+            // Find and lock the container
             errnoLocal = U_SOCK_EBADF;
-            pContainer = pContainerFindByDescriptor(descriptor);
+            pContainer = pContainerLock(descriptor);
             if (pContainer != NULL) {
                 errnoLocal = U_SOCK_EHOSTUNREACH;
                 if (pContainer->socket.state == U_SOCK_STATE_CONNECTED) {
@@ -2543,9 +4724,8 @@ int32_t uSockGetRemoteAddress(uSockDescriptor_t descriptor,
                            sizeof(*pRemoteAddress));
                     errnoLocal = U_SOCK_ENONE;
                 }
+                containerUnlock(pContainer);
             }
-
-            U_PORT_MUTEX_UNLOCK(gMutexContainer);
         }
     }
 
@@ -2574,11 +4754,9 @@ int32_t uSockGetLocalAddress(uSockDescriptor_t descriptor,
         // Check parameters
         if (pLocalAddress != NULL) {
 
-            U_PORT_MUTEX_LOCK(gMutexContainer);
-
             // Check that the descriptor is at least valid
             errnoLocal = U_SOCK_EBADF;
-            pContainer = pContainerFindByDescriptor(descriptor);
+            pContainer = pContainerLock(descriptor);
             if (pContainer != NULL) {
                 // Talk to the underlying cell/wifi
                 // socket layer to get the local address.
@@ -2597,9 +4775,8 @@ int32_t uSockGetLocalAddress(uSockDescriptor_t descriptor,
                                                            sockHandle,
                                                            pLocalAddress);
                 }
+                containerUnlock(pContainer);
             }
-
-            U_PORT_MUTEX_UNLOCK(gMutexContainer);
         }
     }
 
@@ -2625,27 +4802,30 @@ int32_t uSockGetHostByName(uDeviceHandle_t devHandle,
         errnoLocal = U_SOCK_EINVAL;
         // Check parameters
         if ((pHostName != NULL) && (pHostIpAddress != NULL)) {
-
-            U_PORT_MUTEX_LOCK(gMutexContainer);
-
+            // Note: no need to lock gMutexContainer here, the
+            // DNS cache has its own mutex and the look-up
+            // itself involves no socket
             int32_t devType = uDeviceGetDeviceType(devHandle);
 
-            // Talk to the underlying cell/wifi
-            // socket layer to do the DNS look-up.
-            // uXxxSockGetHostByName() returns a negated
-            // value from the U_SOCK_Exxx list.
-            errnoLocal = U_SOCK_ENOSYS;
-            if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                errnoLocal = -uCellSockGetHostByName(devHandle,
-                                                     pHostName,
-                                                     pHostIpAddress);
-            } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                errnoLocal = -uWifiSockGetHostByName(devHandle,
-                                                     pHostName,
-                                                     pHostIpAddress);
+            if (!dnsCacheGet(devHandle, pHostName, pHostIpAddress, &errnoLocal)) {
+                // Talk to the underlying cell/wifi
+                // socket layer to do the DNS look-up.
+                // uXxxSockGetHostByName() returns a negated
+                // value from the U_SOCK_Exxx list.
+                errnoLocal = U_SOCK_ENOSYS;
+                if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
+                    errnoLocal = -uCellSockGetHostByName(devHandle,
+                                                         pHostName,
+                                                         pHostIpAddress);
+                } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
+                    errnoLocal = -uWifiSockGetHostByName(devHandle,
+                                                         pHostName,
+                                                         pHostIpAddress);
+                }
+                if (errnoLocal != U_SOCK_ENOSYS) {
+                    dnsCacheSet(devHandle, pHostName, pHostIpAddress, errnoLocal);
+                }
             }
-
-            U_PORT_MUTEX_UNLOCK(gMutexContainer);
         }
     }
 
@@ -2658,6 +4838,29 @@ int32_t uSockGetHostByName(uDeviceHandle_t devHandle,
     return errorCode;
 }
 
+// Flush the cache of uSockGetHostByName().
+void uSockGetHostByNameCacheFlush(uDeviceHandle_t devHandle)
+{
+#if U_SOCK_DNS_CACHE_NUM_ENTRIES > 0
+    // No need to call init(); here, if the mutex doesn't
+    // exist there is nothing in the cache
+    if (gMutexDnsCache != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutexDnsCache);
+
+        for (size_t x = 0; x < sizeof(gDnsCache) / sizeof(gDnsCache[0]); x++) {
+            if ((devHandle == NULL) || (gDnsCache[x].devHandle == devHandle)) {
+                gDnsCache[x].devHandle = NULL;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutexDnsCache);
+    }
+#else
+    (void) devHandle;
+#endif
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: ADDRESS CONVERSION
  * -------------------------------------------------------------- */
@@ -2770,4 +4973,28 @@ char *pUSockDomainRemovePort(char *pDomainString)
     return pDomainString;
 }
 
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: I/O VECTORS
+ * -------------------------------------------------------------- */
+
+// Get the total number of bytes in an I/O vector.
+int32_t uSockIoVecSize(const uSockIoVec_t *pIoVec, size_t ioVecCount)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pIoVec != NULL) || (ioVecCount == 0)) {
+        errorCodeOrSize = 0;
+        for (size_t x = 0; (x < ioVecCount) && (errorCodeOrSize >= 0); x++) {
+            if (((pIoVec[x].pData == NULL) && (pIoVec[x].dataSizeBytes > 0)) ||
+                (pIoVec[x].dataSizeBytes > (size_t) (INT_MAX - errorCodeOrSize))) {
+                errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            } else {
+                errorCodeOrSize += (int32_t) pIoVec[x].dataSizeBytes;
+            }
+        }
+    }
+
+    return errorCodeOrSize;
+}
+
 // End of file
@@ -42,7 +42,7 @@
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
 #include "sys/time.h"      // struct timeval in most cases
-#include "string.h"        // strncpy(), strcmp(), memcpy(), memset()
+#include "string.h"        // strncpy(), strcmp(), memcpy(), memset(), memcmp()
 
 #include "u_cfg_sw.h"
 #include "u_cfg_app_platform_specific.h"
@@ -63,6 +63,7 @@
 
 #include "u_sock_errno.h" // For U_SOCK_EWOULDBLOCK
 #include "u_sock.h"
+#include "u_sock_security.h" // For uSockPoolConnect()
 #include "u_sock_test_shared_cfg.h"
 
 /* ----------------------------------------------------------------
@@ -119,6 +120,19 @@
 # define U_SOCK_TEST_MAX_UDP_PACKET_SIZE 500
 #endif
 
+#ifndef U_SOCK_TEST_DEFERRED_DEADLINE_MS
+/** The deadline to use when testing uSockWriteDeferred().
+ */
+# define U_SOCK_TEST_DEFERRED_DEADLINE_MS 3000
+#endif
+
+#ifndef U_SOCK_TEST_DEFERRED_SIZE_BYTES
+/** The amount of data to send with uSockWriteDeferred(); must
+ * be no more than #U_SOCK_DEFERRED_MAX_NUM_BYTES.
+ */
+# define U_SOCK_TEST_DEFERRED_SIZE_BYTES 100
+#endif
+
 #ifndef U_SOCK_TEST_MAX_TCP_READ_WRITE_SIZE
 /** The maximum TCP read/write size to use during testing.
  */
@@ -140,6 +154,13 @@
 # define U_SOCK_TEST_NON_BLOCKING_TIME_MS (U_SOCK_RECEIVE_POLL_INTERVAL_MS + 250)
 #endif
 
+#ifndef U_SOCK_TEST_SELECT_ECHO_WAIT_MS
+/** How long to wait in uSockSelect() for echoed data to
+ * arrive during testing.
+ */
+# define U_SOCK_TEST_SELECT_ECHO_WAIT_MS 10000
+#endif
+
 #ifndef U_SOCK_TEST_TIME_MARGIN_PLUS_MS
 /** Positive margin on timers during sockets testing.
  * This has to be pretty sloppy because any AT command
@@ -203,6 +224,13 @@ typedef struct {
     int32_t eventQueueHandle;
 } uSockTestConfig_t;
 
+/** Struct to pass to asyncResultCallback().
+ */
+typedef struct {
+    volatile bool called;
+    volatile int32_t errorCodeOrSize;
+} uSockTestAsyncResult_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -744,6 +772,37 @@ static void setBoolCallback(void *pParameter)
     }
 }
 
+// Callback for the asynchronous socket functions, records the
+// outcome in the uSockTestAsyncResult_t pointed to by pParameter.
+static void asyncResultCallback(uSockDescriptor_t descriptor,
+                                int32_t errorCodeOrSize,
+                                void *pParameter)
+{
+    uSockTestAsyncResult_t *pResult = (uSockTestAsyncResult_t *) pParameter;
+
+    (void) descriptor;
+
+    if (pResult != NULL) {
+        pResult->errorCodeOrSize = errorCodeOrSize;
+        pResult->called = true;
+    }
+}
+
+// Wait for an asynchronous socket function to call
+// asyncResultCallback().
+static bool asyncResultWait(const uSockTestAsyncResult_t *pResult,
+                            int32_t timeoutMs)
+{
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    while (!pResult->called &&
+           (uPortGetTickTimeMs() - startTimeMs < timeoutMs)) {
+        uPortTaskBlock(100);
+    }
+
+    return pResult->called;
+}
+
 // Callback to send to event queue triggered by
 // data arriving.
 //lint -e{818} Suppress could be const, need to follow
@@ -913,6 +972,9 @@ U_PORT_TEST_FUNCTION("[sock]", "sockBasicUdp")
     uSockDescriptor_t descriptor;
     bool dataCallbackCalled;
     size_t sizeBytes;
+    uSockDatagram_t datagrams[3];
+    char *pBatchBuffer;
+    int32_t received;
     bool success = false;
     int32_t heapUsed;
     int32_t heapSockInitLoss = 0;
@@ -955,6 +1017,24 @@ U_PORT_TEST_FUNCTION("[sock]", "sockBasicUdp")
                                               &(remoteAddress.ipAddress)) == 0);
         heapSockInitLoss -= uPortGetHeapFree();
 
+        // A second look-up should come from the cache, another
+        // following a flush from the network, and they should
+        // all give the same answer
+        U_TEST_PRINT_LINE("checking the DNS cache...");
+        memset(&address, 0xFF, sizeof(address));
+        U_PORT_TEST_ASSERT(uSockGetHostByName(devHandle,
+                                              U_SOCK_TEST_ECHO_UDP_SERVER_DOMAIN_NAME,
+                                              &(address.ipAddress)) == 0);
+        U_PORT_TEST_ASSERT(memcmp(&(address.ipAddress), &(remoteAddress.ipAddress),
+                                  sizeof(address.ipAddress)) == 0);
+        uSockGetHostByNameCacheFlush(devHandle);
+        memset(&address, 0xFF, sizeof(address));
+        U_PORT_TEST_ASSERT(uSockGetHostByName(devHandle,
+                                              U_SOCK_TEST_ECHO_UDP_SERVER_DOMAIN_NAME,
+                                              &(address.ipAddress)) == 0);
+        U_PORT_TEST_ASSERT(memcmp(&(address.ipAddress), &(remoteAddress.ipAddress),
+                                  sizeof(address.ipAddress)) == 0);
+
         // Add the port number we will use
         remoteAddress.port = U_SOCK_TEST_ECHO_UDP_SERVER_PORT;
 
@@ -1023,6 +1103,44 @@ U_PORT_TEST_FUNCTION("[sock]", "sockBasicUdp")
                 }
             }
 
+            U_TEST_PRINT_LINE("echo a batch of datagrams...");
+            // Send datagrams of 10, 20 and 30 bytes and expect
+            // 60 bytes back, in whatever order they turn up
+            for (size_t y = 0; y < sizeof(datagrams) / sizeof(datagrams[0]); y++) {
+                datagrams[y].address = remoteAddress;
+                datagrams[y].pData = (void *) gSendData;
+                datagrams[y].dataSizeBytes = (y + 1) * 10;
+                datagrams[y].sizeBytes = -1;
+            }
+            if (uSockSendToBatch(descriptor, datagrams,
+                                 sizeof(datagrams) / sizeof(datagrams[0])) != 3) {
+                success = false;
+            }
+            pBatchBuffer = (char *) pUPortMalloc(U_SOCK_TEST_MAX_UDP_PACKET_SIZE *
+                                                 (sizeof(datagrams) / sizeof(datagrams[0])));
+            U_PORT_TEST_ASSERT(pBatchBuffer != NULL);
+            for (size_t y = 0; y < sizeof(datagrams) / sizeof(datagrams[0]); y++) {
+                datagrams[y].pData = pBatchBuffer + (y * U_SOCK_TEST_MAX_UDP_PACKET_SIZE);
+                datagrams[y].dataSizeBytes = U_SOCK_TEST_MAX_UDP_PACKET_SIZE;
+            }
+            sizeBytes = 0;
+            for (size_t y = 0; (y < 3) && (sizeBytes < 60); y++) {
+                received = uSockReceiveFromBatch(descriptor, datagrams,
+                                                 sizeof(datagrams) / sizeof(datagrams[0]));
+                for (int32_t z = 0; z < received; z++) {
+                    U_PORT_TEST_ASSERT(memcmp(datagrams[z].pData, gSendData,
+                                              datagrams[z].sizeBytes) == 0);
+                    addressAssert(&remoteAddress, &(datagrams[z].address), true);
+                    sizeBytes += datagrams[z].sizeBytes;
+                }
+            }
+            errno = 0;
+            uPortFree(pBatchBuffer);
+            U_TEST_PRINT_LINE("%d byte(s) of the batch were echoed.", (int32_t) sizeBytes);
+            if (sizeBytes != 60) {
+                success = false;
+            }
+
             U_TEST_PRINT_LINE("check that uSockGetRemoteAddress() fails...");
             U_PORT_TEST_ASSERT(uSockGetRemoteAddress(descriptor,
                                                      &address) < 0);
@@ -1104,6 +1222,7 @@ U_PORT_TEST_FUNCTION("[sock]", "sockBasicTcp")
     int32_t y;
     char *pDataReceived;
     int32_t startTimeMs;
+    uSockStats_t stats;
     int32_t heapUsed;
     int32_t heapSockInitLoss = 0;
     int32_t heapXxxSockInitLoss = 0;
@@ -1264,6 +1383,70 @@ U_PORT_TEST_FUNCTION("[sock]", "sockBasicTcp")
                                                 pDataReceived,
                                                 sizeBytes));
 
+        U_TEST_PRINT_LINE("checking socket statistics...");
+#ifdef U_CFG_SOCK_STATS
+        U_PORT_TEST_ASSERT(uSockStatsGet(descriptor, &stats) == 0);
+        U_TEST_PRINT_LINE("%d byte(s) out in %d segment(s), %d byte(s) in"
+                          " in %d segment(s), %d call(s), connect took %d ms.",
+                          stats.txBytes, stats.txSegments, stats.rxBytes,
+                          stats.rxSegments, stats.numCalls, stats.connectMs);
+        U_PORT_TEST_ASSERT(stats.txBytes == sizeof(gSendData) - 1);
+        U_PORT_TEST_ASSERT(stats.rxBytes == sizeBytes);
+        U_PORT_TEST_ASSERT(stats.txSegments > 0);
+        U_PORT_TEST_ASSERT(stats.rxSegments > 0);
+        U_PORT_TEST_ASSERT(stats.numCalls >= stats.txSegments + stats.rxSegments);
+        U_PORT_TEST_ASSERT(stats.connectMs >= 0);
+        y = 0;
+        for (size_t x = 0; x < sizeof(stats.readSizeHistogram) /
+             sizeof(stats.readSizeHistogram[0]); x++) {
+            y += (int32_t) stats.readSizeHistogram[x];
+        }
+        U_PORT_TEST_ASSERT(y == (int32_t) stats.rxSegments);
+        U_PORT_TEST_ASSERT(uSockStatsReset(descriptor) == 0);
+        U_PORT_TEST_ASSERT(uSockStatsGet(descriptor, &stats) == 0);
+        U_PORT_TEST_ASSERT((stats.txBytes == 0) && (stats.rxBytes == 0) &&
+                           (stats.connectMs < 0));
+#else
+        U_PORT_TEST_ASSERT(uSockStatsGet(descriptor, &stats) ==
+                           (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
+#endif
+
+        U_TEST_PRINT_LINE("sending data deferred by up to %d ms...",
+                          U_SOCK_TEST_DEFERRED_DEADLINE_MS);
+        U_PORT_TEST_ASSERT(uSockWriteDeferred(descriptor, gSendData,
+                                              U_SOCK_TEST_DEFERRED_SIZE_BYTES,
+                                              U_SOCK_TEST_DEFERRED_DEADLINE_MS) ==
+                           U_SOCK_TEST_DEFERRED_SIZE_BYTES);
+        startTimeMs = uPortGetTickTimeMs();
+        offset = 0;
+        while ((offset < U_SOCK_TEST_DEFERRED_SIZE_BYTES) &&
+               (uPortGetTickTimeMs() - startTimeMs < U_SOCK_TEST_DEFERRED_DEADLINE_MS +
+                U_SOCK_DEFERRED_TICK_MS + 20000)) {
+            y = uSockRead(descriptor,
+                          pDataReceived + offset + U_SOCK_TEST_GUARD_LENGTH_SIZE_BYTES,
+                          U_SOCK_TEST_DEFERRED_SIZE_BYTES - offset);
+            if (y > 0) {
+                offset += y;
+            }
+        }
+        U_TEST_PRINT_LINE("%d byte(s) of deferred data back after %d ms.",
+                          (int32_t) offset,
+                          (int32_t) (uPortGetTickTimeMs() - startTimeMs));
+        U_PORT_TEST_ASSERT(offset == U_SOCK_TEST_DEFERRED_SIZE_BYTES);
+        U_PORT_TEST_ASSERT(memcmp(pDataReceived + U_SOCK_TEST_GUARD_LENGTH_SIZE_BYTES,
+                                  gSendData, offset) == 0);
+        // With no deadline the data should go straight away
+        U_PORT_TEST_ASSERT(uSockWriteDeferred(descriptor, gSendData, 1, 0) == 1);
+        U_PORT_TEST_ASSERT(errno == 0);
+        startTimeMs = uPortGetTickTimeMs();
+        y = 0;
+        while ((y <= 0) && (uPortGetTickTimeMs() - startTimeMs < 20000)) {
+            y = uSockRead(descriptor,
+                          pDataReceived + U_SOCK_TEST_GUARD_LENGTH_SIZE_BYTES, 1);
+        }
+        U_PORT_TEST_ASSERT(y == 1);
+        errno = 0;
+
         U_TEST_PRINT_LINE("shutting down socket for read...");
         errorCode = uSockShutdown(descriptor,
                                   U_SOCK_SHUTDOWN_READ);
@@ -1827,6 +2010,12 @@ U_PORT_TEST_FUNCTION("[sock]", "sockNonBlocking")
     bool isBlocking;
     struct timeval timeout;
     char *pData[1];
+    uSockDescriptorSet_t readSet;
+    uSockDescriptorSet_t writeSet;
+    uSockDescriptorSet_t exceptSet;
+    char selectBuffer[6];
+    uSockIoVec_t ioVec[3] = {{"wr", 2}, {"it", 2}, {"ev", 2}};
+    int32_t received;
     int32_t startTimeMs;
     int32_t timeoutMs;
     int32_t elapsedMs;
@@ -1975,6 +2164,92 @@ U_PORT_TEST_FUNCTION("[sock]", "sockNonBlocking")
         U_PORT_TEST_ASSERT(elapsedMs < U_SOCK_TEST_NON_BLOCKING_TIME_MS +
                            U_SOCK_TEST_TIME_MARGIN_PLUS_MS);
 
+        U_TEST_PRINT_LINE("check select with nothing to read...");
+        U_SOCK_FD_ZERO(&readSet);
+        U_SOCK_FD_SET(descriptor, &readSet);
+        U_SOCK_FD_ZERO(&writeSet);
+        U_SOCK_FD_SET(descriptor, &writeSet);
+        U_SOCK_FD_ZERO(&exceptSet);
+        U_SOCK_FD_SET(descriptor, &exceptSet);
+        startTimeMs = uPortGetTickTimeMs();
+        // Always ready for write
+        U_PORT_TEST_ASSERT(uSockSelect(descriptor + 1, &readSet, &writeSet,
+                                       &exceptSet, timeoutMs) == 1);
+        elapsedMs = uPortGetTickTimeMs() - startTimeMs;
+        U_PORT_TEST_ASSERT(!U_SOCK_FD_ISSET(descriptor, &readSet));
+        U_PORT_TEST_ASSERT(U_SOCK_FD_ISSET(descriptor, &writeSet));
+        U_PORT_TEST_ASSERT(!U_SOCK_FD_ISSET(descriptor, &exceptSet));
+        U_PORT_TEST_ASSERT(elapsedMs < U_SOCK_TEST_TIME_MARGIN_PLUS_MS);
+        U_SOCK_FD_SET(descriptor, &readSet);
+        startTimeMs = uPortGetTickTimeMs();
+        U_PORT_TEST_ASSERT(uSockSelect(descriptor + 1, &readSet, NULL,
+                                       NULL, timeoutMs) == 0);
+        elapsedMs = uPortGetTickTimeMs() - startTimeMs;
+        U_TEST_PRINT_LINE("uSockSelect() for read of nothing took %d"
+                          " millisecond(s)...", (int32_t) elapsedMs);
+        U_PORT_TEST_ASSERT(!U_SOCK_FD_ISSET(descriptor, &readSet));
+        U_PORT_TEST_ASSERT(elapsedMs > timeoutMs -
+                           U_SOCK_TEST_TIME_MARGIN_MINUS_MS);
+        U_PORT_TEST_ASSERT(elapsedMs < timeoutMs +
+                           U_SOCK_TEST_TIME_MARGIN_PLUS_MS);
+        // A descriptor that is not a socket is an error
+        U_SOCK_FD_SET(descriptor + 1, &readSet);
+        U_PORT_TEST_ASSERT(uSockSelect(descriptor + 2, &readSet, NULL,
+                                       NULL, 0) < 0);
+        U_PORT_TEST_ASSERT(errno == U_SOCK_EBADF);
+        errno = 0;
+
+        U_TEST_PRINT_LINE("check select unblocks on echoed data...");
+        U_PORT_TEST_ASSERT(uSockWrite(descriptor, "select",
+                                      6) == 6);
+        U_SOCK_FD_ZERO(&readSet);
+        U_SOCK_FD_SET(descriptor, &readSet);
+        U_PORT_TEST_ASSERT(uSockSelect(descriptor + 1, &readSet, NULL,
+                                       NULL, U_SOCK_TEST_SELECT_ECHO_WAIT_MS) == 1);
+        U_PORT_TEST_ASSERT(U_SOCK_FD_ISSET(descriptor, &readSet));
+        received = 0;
+        while ((received < (int32_t) sizeof(selectBuffer)) &&
+               (uSockSelect(descriptor + 1, &readSet, NULL, NULL,
+                            U_SOCK_TEST_SELECT_ECHO_WAIT_MS) == 1)) {
+            errorCode = uSockRead(descriptor, selectBuffer + received,
+                                  sizeof(selectBuffer) - received);
+            if (errorCode > 0) {
+                received += errorCode;
+            }
+            U_SOCK_FD_SET(descriptor, &readSet);
+        }
+        // A read may have found nothing
+        errno = 0;
+        U_PORT_TEST_ASSERT(received == (int32_t) sizeof(selectBuffer));
+        U_PORT_TEST_ASSERT(memcmp(selectBuffer, "select", 6) == 0);
+
+        U_TEST_PRINT_LINE("check a vectored write is echoed whole...");
+        // An entry with no data but a length is invalid
+        ioVec[1].pData = NULL;
+        U_PORT_TEST_ASSERT(uSockWritev(descriptor, ioVec, 3) < 0);
+        U_PORT_TEST_ASSERT(errno == U_SOCK_EINVAL);
+        errno = 0;
+        ioVec[1].pData = "it";
+        U_PORT_TEST_ASSERT(uSockIoVecSize(ioVec, 3) == 6);
+        U_PORT_TEST_ASSERT(uSockWritev(descriptor, ioVec, 3) == 6);
+        memset(selectBuffer, 0, sizeof(selectBuffer));
+        U_SOCK_FD_ZERO(&readSet);
+        U_SOCK_FD_SET(descriptor, &readSet);
+        received = 0;
+        while ((received < (int32_t) sizeof(selectBuffer)) &&
+               (uSockSelect(descriptor + 1, &readSet, NULL, NULL,
+                            U_SOCK_TEST_SELECT_ECHO_WAIT_MS) == 1)) {
+            errorCode = uSockRead(descriptor, selectBuffer + received,
+                                  sizeof(selectBuffer) - received);
+            if (errorCode > 0) {
+                received += errorCode;
+            }
+            U_SOCK_FD_SET(descriptor, &readSet);
+        }
+        errno = 0;
+        U_PORT_TEST_ASSERT(received == (int32_t) sizeof(selectBuffer));
+        U_PORT_TEST_ASSERT(memcmp(selectBuffer, "writev", 6) == 0);
+
         U_TEST_PRINT_LINE("set blocking again...");
         uSockBlockingSet(descriptor, true);
         U_PORT_TEST_ASSERT(uSockBlockingGet(descriptor));
@@ -2756,6 +3031,240 @@ U_PORT_TEST_FUNCTION("[sock]", "sockAsyncTcpEcho")
     uNetworkTestListFree();
 }
 
+/** Test the asynchronous socket API: connect, write and read
+ * with completion callbacks, then close with a read outstanding.
+ */
+U_PORT_TEST_FUNCTION("[sock]", "sockAsyncApi")
+{
+    uNetworkTestList_t *pList;
+    uDeviceHandle_t devHandle;
+    uSockAddress_t remoteAddress;
+    uSockDescriptor_t descriptor;
+    uSockTestAsyncResult_t connectResult;
+    uSockTestAsyncResult_t writeResult;
+    uSockTestAsyncResult_t readResult;
+    char buffer[6];
+    int32_t received;
+    int32_t heapUsed;
+    int32_t heapSockInitLoss = 0;
+    int32_t heapXxxSockInitLoss = 0;
+
+    // Call clean up to release OS resources that may
+    // have been left hanging by a previous failed test
+    osCleanup();
+
+    // Do the standard preamble to make sure there is
+    // a network underneath us
+    pList = pStdPreamble();
+
+    // Repeat for all bearers
+    for (uNetworkTestList_t *pTmp = pList; pTmp != NULL; pTmp = pTmp->pNext) {
+        devHandle = *pTmp->pDevHandle;
+        // Get the initial-ish heap
+        heapUsed = uPortGetHeapFree();
+
+        U_TEST_PRINT_LINE("testing asynchronous API on %s.",
+                          gpUNetworkTestTypeName[pTmp->networkType]);
+        // The first call to a sockets API needs to
+        // initialise the underlying sockets layer; take
+        // account of that initialisation heap cost here.
+        heapSockInitLoss = uPortGetHeapFree();
+        U_PORT_TEST_ASSERT(uSockGetHostByName(devHandle,
+                                              U_SOCK_TEST_ECHO_TCP_SERVER_DOMAIN_NAME,
+                                              &(remoteAddress.ipAddress)) == 0);
+        heapSockInitLoss -= uPortGetHeapFree();
+        remoteAddress.port = U_SOCK_TEST_ECHO_TCP_SERVER_PORT;
+
+        heapXxxSockInitLoss += uPortGetHeapFree();
+        descriptor = uSockCreate(devHandle, U_SOCK_TYPE_STREAM,
+                                 U_SOCK_PROTOCOL_TCP);
+        heapXxxSockInitLoss -= uPortGetHeapFree();
+        U_PORT_TEST_ASSERT(descriptor >= 0);
+
+        U_TEST_PRINT_LINE("connecting asynchronously to \"%s:%d\"...",
+                          U_SOCK_TEST_ECHO_TCP_SERVER_DOMAIN_NAME,
+                          U_SOCK_TEST_ECHO_TCP_SERVER_PORT);
+        memset(&connectResult, 0, sizeof(connectResult));
+        U_PORT_TEST_ASSERT(uSockConnectAsync(descriptor, &remoteAddress,
+                                             asyncResultCallback,
+                                             &connectResult) == 0);
+        U_PORT_TEST_ASSERT(asyncResultWait(&connectResult,
+                                           U_SOCK_TEST_SELECT_ECHO_WAIT_MS));
+        U_TEST_PRINT_LINE("connect callback result %d.",
+                          connectResult.errorCodeOrSize);
+        U_PORT_TEST_ASSERT(connectResult.errorCodeOrSize == 0);
+
+        U_TEST_PRINT_LINE("echoing data asynchronously...");
+        memset(&readResult, 0, sizeof(readResult));
+        memset(buffer, 0, sizeof(buffer));
+        U_PORT_TEST_ASSERT(uSockReadAsync(descriptor, buffer, sizeof(buffer),
+                                          asyncResultCallback,
+                                          &readResult) == 0);
+        // Only one read at a time
+        U_PORT_TEST_ASSERT(uSockReadAsync(descriptor, buffer, sizeof(buffer),
+                                          asyncResultCallback,
+                                          &readResult) < 0);
+        U_PORT_TEST_ASSERT(errno == U_SOCK_EALREADY);
+        errno = 0;
+        memset(&writeResult, 0, sizeof(writeResult));
+        U_PORT_TEST_ASSERT(uSockWriteAsync(descriptor, "async!", 6,
+                                           asyncResultCallback,
+                                           &writeResult) == 0);
+        U_PORT_TEST_ASSERT(asyncResultWait(&writeResult,
+                                           U_SOCK_TEST_SELECT_ECHO_WAIT_MS));
+        U_PORT_TEST_ASSERT(writeResult.errorCodeOrSize == 6);
+        received = 0;
+        while (received < (int32_t) sizeof(buffer)) {
+            U_PORT_TEST_ASSERT(asyncResultWait(&readResult,
+                                               U_SOCK_TEST_SELECT_ECHO_WAIT_MS));
+            U_TEST_PRINT_LINE("read callback result %d.",
+                              readResult.errorCodeOrSize);
+            U_PORT_TEST_ASSERT(readResult.errorCodeOrSize > 0);
+            received += readResult.errorCodeOrSize;
+            if (received < (int32_t) sizeof(buffer)) {
+                // The echo may arrive in pieces
+                memset(&readResult, 0, sizeof(readResult));
+                U_PORT_TEST_ASSERT(uSockReadAsync(descriptor, buffer + received,
+                                                  sizeof(buffer) - received,
+                                                  asyncResultCallback,
+                                                  &readResult) == 0);
+            }
+        }
+        U_PORT_TEST_ASSERT(memcmp(buffer, "async!", 6) == 0);
+
+        U_TEST_PRINT_LINE("closing with a read outstanding...");
+        memset(&readResult, 0, sizeof(readResult));
+        U_PORT_TEST_ASSERT(uSockReadAsync(descriptor, buffer, sizeof(buffer),
+                                          asyncResultCallback,
+                                          &readResult) == 0);
+        U_PORT_TEST_ASSERT(uSockClose(descriptor) == 0);
+        U_PORT_TEST_ASSERT(asyncResultWait(&readResult,
+                                           U_SOCK_TEST_TCP_CLOSE_SECONDS * 1000));
+        U_TEST_PRINT_LINE("read callback result %d.",
+                          readResult.errorCodeOrSize);
+        U_PORT_TEST_ASSERT(readResult.errorCodeOrSize < 0);
+        uSockCleanUp();
+
+        // Check for memory leaks
+        heapUsed -= uPortGetHeapFree();
+        U_TEST_PRINT_LINE("during this part of the test %d byte(s) were"
+                          " lost to sockets initialisation; we have"
+                          " leaked %d byte(s).",
+                          heapSockInitLoss + heapXxxSockInitLoss,
+                          heapUsed - (heapSockInitLoss + heapXxxSockInitLoss));
+        U_PORT_TEST_ASSERT(heapUsed <= heapSockInitLoss + heapXxxSockInitLoss);
+    }
+
+    // Remove each network type
+    for (uNetworkTestList_t *pTmp = pList; pTmp != NULL; pTmp = pTmp->pNext) {
+        U_TEST_PRINT_LINE("taking down %s...",
+                          gpUNetworkTestTypeName[pTmp->networkType]);
+        U_PORT_TEST_ASSERT(uNetworkInterfaceDown(*pTmp->pDevHandle,
+                                                 pTmp->networkType) == 0);
+    }
+
+    // To speed things up, do not close the device
+    uNetworkTestListFree();
+}
+
+/** Test the socket pool of uSockPoolConnect().
+ */
+U_PORT_TEST_FUNCTION("[sock]", "sockPool")
+{
+    uNetworkTestList_t *pList;
+    uDeviceHandle_t devHandle;
+    uSockAddress_t remoteAddress;
+    uSockDescriptor_t descriptor;
+    uSockDescriptor_t descriptorPooled;
+    char buffer[4];
+    int32_t received;
+    int32_t y;
+
+    // Call clean up to release OS resources that may
+    // have been left hanging by a previous failed test
+    osCleanup();
+
+    // Do the standard preamble to make sure there is
+    // a network underneath us
+    pList = pStdPreamble();
+
+    // Repeat for all bearers
+    for (uNetworkTestList_t *pTmp = pList; pTmp != NULL; pTmp = pTmp->pNext) {
+        devHandle = *pTmp->pDevHandle;
+
+        U_TEST_PRINT_LINE("testing socket pool on %s.",
+                          gpUNetworkTestTypeName[pTmp->networkType]);
+        U_PORT_TEST_ASSERT(uSockGetHostByName(devHandle,
+                                              U_SOCK_TEST_ECHO_TCP_SERVER_DOMAIN_NAME,
+                                              &(remoteAddress.ipAddress)) == 0);
+        remoteAddress.port = U_SOCK_TEST_ECHO_TCP_SERVER_PORT;
+
+        U_PORT_TEST_ASSERT(uSockPoolConnect(devHandle, NULL, NULL) < 0);
+        U_PORT_TEST_ASSERT(errno == U_SOCK_EINVAL);
+        errno = 0;
+
+        descriptorPooled = -1;
+        for (size_t x = 0; x < 2; x++) {
+            U_TEST_PRINT_LINE("pool connect %d to \"%s:%d\"...", (int32_t) (x + 1),
+                              U_SOCK_TEST_ECHO_TCP_SERVER_DOMAIN_NAME,
+                              U_SOCK_TEST_ECHO_TCP_SERVER_PORT);
+            descriptor = uSockPoolConnect(devHandle, &remoteAddress, NULL);
+            U_PORT_TEST_ASSERT(descriptor >= 0);
+            if (descriptorPooled >= 0) {
+                // The second time around the connection should
+                // have come from the pool
+                U_PORT_TEST_ASSERT(descriptor == descriptorPooled);
+            }
+            U_PORT_TEST_ASSERT(uSockWrite(descriptor, "pool", 4) == 4);
+            received = 0;
+            memset(buffer, 0, sizeof(buffer));
+            for (y = 0; (y < 10) && (received < (int32_t) sizeof(buffer)); y++) {
+                // The echo may arrive in pieces
+                int32_t z = uSockRead(descriptor, buffer + received,
+                                      sizeof(buffer) - received);
+                if (z > 0) {
+                    received += z;
+                }
+            }
+            U_PORT_TEST_ASSERT(received == (int32_t) sizeof(buffer));
+            U_PORT_TEST_ASSERT(memcmp(buffer, "pool", 4) == 0);
+            // Closing puts the socket into the pool
+            U_PORT_TEST_ASSERT(uSockClose(descriptor) == 0);
+            // ...so that it can no longer be used directly
+            U_PORT_TEST_ASSERT(uSockWrite(descriptor, "pool", 4) < 0);
+            U_PORT_TEST_ASSERT(errno == U_SOCK_EBADF);
+            errno = 0;
+            descriptorPooled = descriptor;
+        }
+
+        // A different remote address must not pick up
+        // the pooled connection
+        remoteAddress.port++;
+        descriptor = uSockPoolConnect(devHandle, &remoteAddress, NULL);
+        U_PORT_TEST_ASSERT(descriptor != descriptorPooled);
+        if (descriptor >= 0) {
+            uSockClose(descriptor);
+        }
+        errno = 0;
+
+        U_TEST_PRINT_LINE("flushing the pool...");
+        uSockPoolFlush(devHandle);
+        uSockPoolFlush(NULL);
+        uSockCleanUp();
+    }
+
+    // Remove each network type
+    for (uNetworkTestList_t *pTmp = pList; pTmp != NULL; pTmp = pTmp->pNext) {
+        U_TEST_PRINT_LINE("taking down %s...",
+                          gpUNetworkTestTypeName[pTmp->networkType]);
+        U_PORT_TEST_ASSERT(uNetworkInterfaceDown(*pTmp->pDevHandle,
+                                                 pTmp->networkType) == 0);
+    }
+
+    // To speed things up, do not close the device
+    uNetworkTestListFree();
+}
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
@@ -22,6 +22,8 @@
  * of another module should be included here; otherwise
  * please keep #includes to your .c files. */
 
+#include "u_spartn_crc.h"
+
 /** \addtogroup __spartn __SPARTN
  *  @{
  */
@@ -56,10 +58,103 @@ extern "C" {
  */
 #define U_SPARTN_MESSAGE_LENGTH_MAX_BYTES (4 + 8 + 1024 + 64 + 4)
 
+/** The maximum size of a SPARTN message header: FRAME START +
+ * largest PAYLOAD DESCRIPTION (i.e. 32-bit GNSS time tag plus
+ * ENCRYPT/AUTH); this many bytes are always sufficient to determine
+ * the length of a SPARTN message.
+ */
+#define U_SPARTN_HEADER_LENGTH_MAX_BYTES (4 + 6 + 2)
+
+#ifndef U_SPARTN_FILTER_HISTORY_LENGTH
+/** The number of recently-passed messages that a SPARTN filter
+ * remembers in order to detect duplicates, see uSpartnFilterInit().
+ */
+# define U_SPARTN_FILTER_HISTORY_LENGTH 32
+#endif
+
+#ifndef U_SPARTN_FILTER_NUM_MESSAGE_TYPES
+/** The number of SPARTN message types (TF002), starting at zero,
+ * that a SPARTN filter can filter by message sub-type; messages
+ * of a higher type are always passed by the sub-type filter.
+ */
+# define U_SPARTN_FILTER_NUM_MESSAGE_TYPES 8
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The decoded header of a SPARTN message, see uSpartnDecodeHeader().
+ */
+typedef struct {
+    int32_t messageType;         /**< TF002, e.g. 0 for OCB, 1 for HPAC, 2 for GAD. */
+    int32_t messageSubtype;      /**< TF007, e.g. 0 for GPS, 1 for GLONASS. */
+    size_t payloadLengthBytes;   /**< TF003. */
+    bool encryptedAuthenticated; /**< TF004. */
+    uSpartnCrcType_t crcType;    /**< TF005. */
+    bool timeTag32Bit;           /**< TF008. */
+    uint32_t timeTag;            /**< TF009. */
+    int32_t solutionId;          /**< TF010. */
+    int32_t solutionProcessorId; /**< TF011. */
+} uSpartnHeader_t;
+
+/** The counters of a SPARTN filter, see uSpartnFilterGetCounters().
+ */
+typedef struct {
+    uint32_t numPassed;             /**< messages passed. */
+    uint32_t numDroppedInvalid;     /**< messages dropped because they
+                                         were not valid SPARTN messages. */
+    uint32_t numDroppedSubtype;     /**< messages dropped because of their
+                                         message type/sub-type. */
+    uint32_t numDroppedDuplicate;   /**< messages dropped because they were
+                                         duplicates. */
+} uSpartnFilterCounters_t;
+
+/** An entry in the history of a SPARTN filter: private.
+ */
+typedef struct {
+    uSpartnHeader_t header;
+    uint32_t messageCrc;
+    int32_t timePassedMs;
+    bool inUse;
+} uSpartnFilterEntry_t;
+
+/** A SPARTN filter, see uSpartnFilterInit(); the contents are private.
+ */
+typedef struct {
+    int32_t windowMs;
+    bool matchHeaderOnly;
+    uint16_t dropSubtypeMask[U_SPARTN_FILTER_NUM_MESSAGE_TYPES];
+    uSpartnFilterEntry_t history[U_SPARTN_FILTER_HISTORY_LENGTH];
+    size_t nextEntry;
+    uSpartnFilterCounters_t counters;
+} uSpartnFilter_t;
+
+/** Callback called by uSpartnReassemblerFeed() with each complete,
+ * CRC-checked, SPARTN message.
+ *
+ * @param[in] pMessage         the entire message, TF001 to TF018, still
+ *                             encrypted; only valid for the duration
+ *                             of the callback.
+ * @param messageLengthBytes   the length of the message at pMessage.
+ * @param[in] pCallbackParam   the parameter given to uSpartnReassemblerInit().
+ */
+typedef void (*uSpartnReassemblerCallback_t)(const char *pMessage,
+                                             size_t messageLengthBytes,
+                                             void *pCallbackParam);
+
+/** A SPARTN message reassembler, see uSpartnReassemblerInit(); the
+ * contents are private.
+ */
+typedef struct {
+    char *pBuffer;
+    size_t bufferSize;
+    size_t length;
+    size_t messageLength;
+    uSpartnReassemblerCallback_t pCallback;
+    void *pCallbackParam;
+} uSpartnReassembler_t;
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -145,6 +240,153 @@ int32_t uSpartnDetect(const char *pBuffer, size_t bufferLengthBytes,
 int32_t uSpartnValidate(const char *pBuffer, size_t bufferLengthBytes,
                         const char **ppMessage);
 
+/** Decode the header of a SPARTN message.
+ *
+ * @param[in] pMessage          a pointer to a SPARTN message, as
+ *                              returned by uSpartnValidate(); only the
+ *                              header need be present.
+ * @param messageLengthBytes    the amount of data at pMessage.
+ * @param[out] pHeader          a place to put the decoded header, cannot
+ *                              be NULL.
+ * @return                      zero on success else negative error code;
+ *                              #U_ERROR_COMMON_TIMEOUT if there is not
+ *                              yet enough of the message to decode the
+ *                              header.
+ */
+int32_t uSpartnDecodeHeader(const char *pMessage, size_t messageLengthBytes,
+                            uSpartnHeader_t *pHeader);
+
+/** Initialise a SPARTN filter.  A SPARTN filter may be used to stop
+ * unwanted or duplicate SPARTN messages reaching a GNSS device,
+ * e.g. where the same corrections are received both over L-band and
+ * over IP.  A good pattern would be to call uSpartnFilterCheck() from
+ * the callback of a SPARTN reassembler (see uSpartnReassemblerInit())
+ * and only send the message on to the GNSS device (e.g. with
+ * uGnssMsgSend()) if it returns true.
+ *
+ * By default the filter passes all message types/sub-types; call
+ * uSpartnFilterSetSubtype() to drop those that are not required.
+ * Note that filtering on the contents of the payload (e.g. the
+ * GAD area ID) is not possible since the payload is normally
+ * encrypted; if you do not need GAD messages at all then drop
+ * message type 2.
+ *
+ * A message is considered a duplicate if it has the same message
+ * type, sub-type, time tag, solution ID and solution processor ID
+ * as a message passed within the last windowMs; if matchHeaderOnly
+ * is false then the payload length and the message CRC must also
+ * match.  Use matchHeaderOnly only if the sources being
+ * de-duplicated produce differently-encrypted copies of the same
+ * message; it would not be correct for a message type that is split
+ * across several messages with the same time tag.  Up to
+ * #U_SPARTN_FILTER_HISTORY_LENGTH messages are remembered.
+ *
+ * The filter may be used with one stream of data at a time, it
+ * is up to the caller to prevent simultaneous calls with the same
+ * filter.
+ *
+ * @param[out] pFilter          a pointer to the filter to initialise,
+ *                              cannot be NULL.
+ * @param windowMs              the time window within which a message
+ *                              is treated as a duplicate; zero switches
+ *                              de-duplication off.
+ * @param matchHeaderOnly       if true then only the header fields are
+ *                              compared when looking for duplicates.
+ * @return                      zero on success else negative error code.
+ */
+int32_t uSpartnFilterInit(uSpartnFilter_t *pFilter, int32_t windowMs,
+                          bool matchHeaderOnly);
+
+/** Set whether a SPARTN filter passes a given message type/sub-type.
+ *
+ * @param[in] pFilter           a pointer to the filter.
+ * @param messageType           the message type (TF002), must be less than
+ *                              #U_SPARTN_FILTER_NUM_MESSAGE_TYPES.
+ * @param messageSubtype        the message sub-type (TF007), -1 for all
+ *                              message sub-types of messageType.
+ * @param pass                  true to pass the message type/sub-type,
+ *                              false to drop it.
+ * @return                      zero on success else negative error code.
+ */
+int32_t uSpartnFilterSetSubtype(uSpartnFilter_t *pFilter, int32_t messageType,
+                                int32_t messageSubtype, bool pass);
+
+/** Check a SPARTN message against a filter.  If the message is
+ * passed it will be remembered for de-duplication.
+ *
+ * @param[in] pFilter           a pointer to the filter.
+ * @param[in] pMessage          a pointer to a complete SPARTN message,
+ *                              e.g. as returned by uSpartnValidate().
+ * @param messageLengthBytes    the length of the message at pMessage.
+ * @return                      true if the message should be passed on,
+ *                              else false.
+ */
+bool uSpartnFilterCheck(uSpartnFilter_t *pFilter, const char *pMessage,
+                        size_t messageLengthBytes);
+
+/** Get the counters of a SPARTN filter.
+ *
+ * @param[in] pFilter           a pointer to the filter.
+ * @param[out] pCounters        a place to put the counters, cannot be NULL.
+ * @param reset                 if true the counters are reset to zero
+ *                              after they have been read.
+ * @return                      zero on success else negative error code.
+ */
+int32_t uSpartnFilterGetCounters(uSpartnFilter_t *pFilter,
+                                 uSpartnFilterCounters_t *pCounters,
+                                 bool reset);
+
+/** Initialise a SPARTN message reassembler.  Where uSpartnValidate()
+ * needs a buffer containing a whole message, a reassembler may be
+ * fed data in fragments of any size, e.g. as they arrive over MQTT
+ * or TCP, and will call pCallback with each complete message whose
+ * message CRC is good; data that is not part of a SPARTN message is
+ * thrown away as it arrives.  Only as much data as is needed to
+ * reassemble a single message is held, in a buffer provided by the
+ * caller.  The reassembler handles one stream of data, it is up to
+ * the caller to prevent simultaneous calls with the same reassembler.
+ *
+ * @param[out] pReassembler    a pointer to the reassembler to initialise,
+ *                             cannot be NULL.
+ * @param[in] pBuffer          storage for the message being reassembled,
+ *                             which must remain valid while the
+ *                             reassembler is in use, cannot be NULL.
+ * @param bufferSize           the amount of storage at pBuffer, at least
+ *                             #U_SPARTN_HEADER_LENGTH_MAX_BYTES; messages
+ *                             longer than this will be ignored, so use
+ *                             #U_SPARTN_MESSAGE_LENGTH_MAX_BYTES to be
+ *                             sure of receiving any SPARTN message.
+ * @param pCallback            the callback to be called with each complete
+ *                             message, cannot be NULL.
+ * @param[in] pCallbackParam   a parameter that will be passed to pCallback.
+ * @return                     zero on success else negative error code.
+ */
+int32_t uSpartnReassemblerInit(uSpartnReassembler_t *pReassembler,
+                               char *pBuffer, size_t bufferSize,
+                               uSpartnReassemblerCallback_t pCallback,
+                               void *pCallbackParam);
+
+/** Feed data to a SPARTN message reassembler; pCallback, as passed
+ * to uSpartnReassemblerInit(), will be called with each message that
+ * this data completes before the function returns.
+ *
+ * @param[in] pReassembler     a pointer to the reassembler, as passed to
+ *                             uSpartnReassemblerInit().
+ * @param[in] pData            the data.
+ * @param length               the amount of data at pData.
+ * @return                     the number of complete messages passed to
+ *                             the callback, else negative error code.
+ */
+int32_t uSpartnReassemblerFeed(uSpartnReassembler_t *pReassembler,
+                               const char *pData, size_t length);
+
+/** Reset a SPARTN message reassembler, throwing away any partial
+ * message.
+ *
+ * @param[in] pReassembler     a pointer to the reassembler.
+ */
+void uSpartnReassemblerReset(uSpartnReassembler_t *pReassembler);
+
 #ifdef __cplusplus
 }
 #endif
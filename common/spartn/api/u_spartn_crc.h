@@ -41,6 +41,17 @@ extern "C" {
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_SPARTN_CRC_SLICE_BYTES
+/** The number of bytes that uSpartnCrc16(), uSpartnCrc24() and
+ * uSpartnCrc32() process per iteration: 1 is the classic
+ * one-table-lookup-per-byte approach, needing 2.5 kbytes of tables;
+ * 4 or 8 use the "slicing" technique, which is considerably faster
+ * on long messages at the cost of 12 kbytes or 24 kbytes of tables
+ * in flash.
+ */
+# define U_SPARTN_CRC_SLICE_BYTES 1
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -102,7 +113,9 @@ uint16_t uSpartnCrc16(const char *pData, size_t size);
  */
 uint32_t uSpartnCrc24(const char *pData, size_t size);
 
-/** Perform a CRC32 calculation on a block of data.
+/** Perform a CRC32 calculation on a block of data; if
+ * uPortCrc32Mpeg2() is implemented by the platform then hardware
+ * will be used for this.
  *
  * @param pData  a pointer to the data to be checked.
  * @param size   the number of bytes pointed to by pData.
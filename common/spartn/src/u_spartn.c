@@ -97,6 +97,8 @@
 
 #include "u_error_common.h"
 
+#include "u_port.h" // uPortGetTickTimeMs()
+
 #include "u_spartn.h"
 #include "u_spartn_crc.h"
 
@@ -122,6 +124,136 @@
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Decode a SPARTN message header that begins at pBuffer, which must
+// be pointing at a 0x73, supplying the message CRC position and type.
+static int32_t decodeHeaderAt(const char *pBuffer, size_t bufferLengthBytes,
+                              const char **ppMessageCrcStart,
+                              uSpartnCrcType_t *pMessageCrcType)
+{
+    // Potentially a FRAME START
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
+    // Use a uint8_t pointer for maths, more certain of its behaviour than char
+    const uint8_t *pInput = (const uint8_t *) pBuffer;
+    uint8_t frameBuffer[4];
+    size_t lengthHeader;
+    size_t lengthBeyondHeader;
+    size_t crcType;
+
+    if (bufferLengthBytes >= U_SPARTN_HEADER_LENGTH_MIN_BYTES) {
+        // Have enough data to work on the header; confirm that this
+        // is a FRAME START by doing a frame CRC check on it
+        // Copy everything from FRAME START except TF001 into a buffer
+        memcpy(&frameBuffer, pInput + 1, 3);
+        frameBuffer[3] = 0;
+
+        // frameBuffer now contains, in order of bit-arrival:
+        //
+        // bytes:    |      0     |     1     |      2      |     3     |
+        // contents: |<---T7---><-----L10------->E1-MCT2-FC4|           |
+        // meaning:  |M       L M |           |L    M L  M L|           |
+
+        // Remove the frame CRC that is in the lower four
+        // bits of byte 2, giving us 20 bits in the buffer with
+        // zero-fill elsewhere
+        frameBuffer[2] &= 0xf0;
+        // Compute the CRC-4 over 24 bits and check it against the frame CRC (TF006)
+        if (uSpartnCrc4((const char *) frameBuffer, 3) == (*(pInput + 3) & 0x0f)) {
+            lengthHeader = U_SPARTN_HEADER_LENGTH_MIN_BYTES;
+            // So far so good, now parse the PAYLOAD DESCRIPTION to work out
+            // how long it is; check if the TF008 (GNSS time tag type) bit is set
+            if (*(pInput + 4) & 0x08) {
+                // The GNSS time tag is 32 bits instead of 16, so account for that
+                lengthHeader += 2;
+            }
+            // Work out the length beyond the message header
+            // First the length of the payload from the 10-bit TF003 field,
+            // which is splattered across the three bytes of frameBuffer
+            lengthBeyondHeader = ((((size_t) frameBuffer[0]) & 0x01) << 9) +
+                                 (((size_t) frameBuffer[1]) << 1) +
+                                 ((((size_t) frameBuffer[2]) & 0x80) >> 7);
+            // Add the length of the message CRC by looking at
+            // the 2-bit message CRC type field (TF005).  Since we have
+            // 0: CRC-8, 1: CRC-16, 2: CRC-24, 3: CRC-32 it is easy
+            // to calculate
+            crcType = (frameBuffer[2] & 0x30) >> 4;
+            lengthBeyondHeader += crcType + 1;
+            if (pMessageCrcType != NULL) {
+                *pMessageCrcType = (uSpartnCrcType_t) crcType;
+            }
+            // Work out the additions as a consequence of encryption/authentication
+            // being switched on
+            if (frameBuffer[2] & 0x40) {
+                // TF004 is set, so we need the ENCRYPT/AUTH fields to work
+                // out the message length; see if they are in the buffer
+                if ((int32_t) bufferLengthBytes - (int32_t) lengthHeader >= 2) {
+                    // The ENCRYPT/AUTH fields are in the buffer
+                    lengthHeader += 2;
+                    // To work out how big the AUTHENTICATION field is we
+                    // need to check if the authentication indicator field
+                    // (TF014) in PAYLOAD DESCRIPTION is greater than 1.
+                    // This is in the final byte of the header so we
+                    // can use lengthHeader, which is now pointing
+                    // at the start of the payload, to index to it
+                    if (((*(pInput + lengthHeader - 1) & 0x38) >> 3) > 1) {
+                        // AUTHENTICATION is present, find out how
+                        // big it is from the 3-bit authentication
+                        // length (TF015) at the beginning of the same
+                        // byte
+                        switch (*(pInput + lengthHeader - 1) & 0x07) {
+                            case 0: // 64 bits
+                                lengthBeyondHeader += 64 / 8;
+                                break;
+                            case 1: // 96 bits
+                                lengthBeyondHeader += 96 / 8;
+                                break;
+                            case 2: // 128 bits
+                                lengthBeyondHeader += 128 / 8;
+                                break;
+                            case 3: // 256 bits
+                                lengthBeyondHeader += 256 / 8;
+                                break;
+                            case 4: // 512 bits
+                                lengthBeyondHeader += 512 / 8;
+                                break;
+                            default:
+                                // Error case: not a supported message
+                                sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+                                lengthHeader = 0;
+                                break;
+                        }
+                    }
+                } else {
+                    // Might be a message but we don't yet have enough
+                    // data to work out its length; set the length
+                    // of the header to zero to flag this
+                    lengthHeader = 0;
+                }
+            }
+            if (lengthHeader > 0) {
+                // We have a header length, so (a) there are no errors and (b)
+                // we have all the data we need to determine the message length,
+                // then we are done; otherwise sizeOrErrorCode is left at
+                // U_ERROR_COMMON_TIMEOUT (or U_ERROR_COMMON_NOT_FOUND if there
+                // was an error)
+                sizeOrErrorCode = (int32_t) (lengthHeader + lengthBeyondHeader);
+                if (ppMessageCrcStart != NULL) {
+                    *ppMessageCrcStart = (const char *) pInput + lengthHeader + lengthBeyondHeader - (crcType + 1);
+                }
+            }
+        } else {
+            // Not a SPARTN message
+            sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        }
+    } else {
+        // Might be a SPARTN message but we don't yet have all of
+        // the header and hence can't work out the message
+        // length; leave sizeOrErrorCode at U_ERROR_COMMON_TIMEOUT
+        // so that the caller knows we need more data
+    }
+
+    return sizeOrErrorCode;
+}
+
 // Look for a SPARTN message header in a buffer and supply its position,
 // plus the message CRC position and type.
 static int32_t decodeHeader(const char *pBuffer, size_t bufferLengthBytes,
@@ -130,133 +262,17 @@ static int32_t decodeHeader(const char *pBuffer, size_t bufferLengthBytes,
                             uSpartnCrcType_t *pMessageCrcType)
 {
     int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-    // Use a uint8_t pointer for maths, more certain of its behaviour than char
-    const uint8_t *pInput = (const uint8_t *) pBuffer;
-    const uint8_t *pMessage = NULL;
-    uint8_t frameBuffer[4];
-    size_t lengthHeader;
-    size_t lengthBeyondHeader;
-    size_t crcType;
+    const char *pInput = pBuffer;
+    const char *pMessage = NULL;
 
     if (pInput != NULL) {
         sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
         while ((sizeOrErrorCode < 0) && (sizeOrErrorCode != (int32_t) U_ERROR_COMMON_TIMEOUT) &&
                (bufferLengthBytes > 0)) {
             if (*pInput == 0x73) {
-                // Potentially a FRAME START
-                sizeOrErrorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
+                sizeOrErrorCode = decodeHeaderAt(pInput, bufferLengthBytes,
+                                                 ppMessageCrcStart, pMessageCrcType);
                 pMessage = pInput;
-                if (bufferLengthBytes >= U_SPARTN_HEADER_LENGTH_MIN_BYTES) {
-                    // Have enough data to work on the header; confirm that this
-                    // is a FRAME START by doing a frame CRC check on it
-                    // Copy everything from FRAME START except TF001 into a buffer
-                    memcpy(&frameBuffer, pInput + 1, 3);
-                    frameBuffer[3] = 0;
-
-                    // frameBuffer now contains, in order of bit-arrival:
-                    //
-                    // bytes:    |      0     |     1     |      2      |     3     |
-                    // contents: |<---T7---><-----L10------->E1-MCT2-FC4|           |
-                    // meaning:  |M       L M |           |L    M L  M L|           |
-
-                    // Remove the frame CRC that is in the lower four
-                    // bits of byte 2, giving us 20 bits in the buffer with
-                    // zero-fill elsewhere
-                    frameBuffer[2] &= 0xf0;
-                    // Compute the CRC-4 over 24 bits and check it against the frame CRC (TF006)
-                    if (uSpartnCrc4((const char *) frameBuffer, 3) == (*(pInput + 3) & 0x0f)) {
-                        lengthHeader = U_SPARTN_HEADER_LENGTH_MIN_BYTES;
-                        // So far so good, now parse the PAYLOAD DESCRIPTION to work out
-                        // how long it is; check if the TF008 (GNSS time tag type) bit is set
-                        if (*(pInput + 4) & 0x08) {
-                            // The GNSS time tag is 32 bits instead of 16, so account for that
-                            lengthHeader += 2;
-                        }
-                        // Work out the length beyond the message header
-                        // First the length of the payload from the 10-bit TF003 field,
-                        // which is splattered across the three bytes of frameBuffer
-                        lengthBeyondHeader = ((((size_t) frameBuffer[0]) & 0x01) << 9) +
-                                             (((size_t) frameBuffer[1]) << 1) +
-                                             ((((size_t) frameBuffer[2]) & 0x80) >> 7);
-                        // Add the length of the message CRC by looking at
-                        // the 2-bit message CRC type field (TF005).  Since we have
-                        // 0: CRC-8, 1: CRC-16, 2: CRC-24, 3: CRC-32 it is easy
-                        // to calculate
-                        crcType = (frameBuffer[2] & 0x30) >> 4;
-                        lengthBeyondHeader += crcType + 1;
-                        if (pMessageCrcType != NULL) {
-                            *pMessageCrcType = (uSpartnCrcType_t) crcType;
-                        }
-                        // Work out the additions as a consequence of encryption/authentication
-                        // being switched on
-                        if (frameBuffer[2] & 0x40) {
-                            // TF004 is set, so we need the ENCRYPT/AUTH fields to work
-                            // out the message length; see if they are in the buffer
-                            if ((int32_t) bufferLengthBytes - (int32_t) lengthHeader >= 2) {
-                                // The ENCRYPT/AUTH fields are in the buffer
-                                lengthHeader += 2;
-                                // To work out how big the AUTHENTICATION field is we
-                                // need to check if the authentication indicator field
-                                // (TF014) in PAYLOAD DESCRIPTION is greater than 1.
-                                // This is in the final byte of the header so we
-                                // can use lengthHeader, which is now pointing
-                                // at the start of the payload, to index to it
-                                if (((*(pInput + lengthHeader - 1) & 0x38) >> 3) > 1) {
-                                    // AUTHENTICATION is present, find out how
-                                    // big it is from the 3-bit authentication
-                                    // length (TF015) at the beginning of the same
-                                    // byte
-                                    switch (*(pInput + lengthHeader - 1) & 0x07) {
-                                        case 0: // 64 bits
-                                            lengthBeyondHeader += 64 / 8;
-                                            break;
-                                        case 1: // 96 bits
-                                            lengthBeyondHeader += 96 / 8;
-                                            break;
-                                        case 2: // 128 bits
-                                            lengthBeyondHeader += 128 / 8;
-                                            break;
-                                        case 3: // 256 bits
-                                            lengthBeyondHeader += 256 / 8;
-                                            break;
-                                        case 4: // 512 bits
-                                            lengthBeyondHeader += 512 / 8;
-                                            break;
-                                        default:
-                                            // Error case: not a supported message
-                                            sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
-                                            lengthHeader = 0;
-                                            break;
-                                    }
-                                }
-                            } else {
-                                // Might be a message but we don't yet have enough
-                                // data to work out its length; set the length
-                                // of the header to zero to flag this
-                                lengthHeader = 0;
-                            }
-                        }
-                        if (lengthHeader > 0) {
-                            // We have a header length, so (a) there are no errors and (b)
-                            // we have all the data we need to determine the message length,
-                            // then we are done; otherwise sizeOrErrorCode is left at
-                            // U_ERROR_COMMON_TIMEOUT (or U_ERROR_COMMON_NOT_FOUND if there
-                            // was an error)
-                            sizeOrErrorCode = (int32_t) (lengthHeader + lengthBeyondHeader);
-                            if (ppMessageCrcStart != NULL) {
-                                *ppMessageCrcStart = (const char *) pMessage + lengthHeader + lengthBeyondHeader - (crcType + 1);
-                            }
-                        }
-                    } else {
-                        // Not a SPARTN message
-                        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
-                    }
-                } else {
-                    // Might be a SPARTN message but we don't yet have all of
-                    // the header and hence can't work out the message
-                    // length; leave sizeOrErrorCode at U_ERROR_COMMON_TIMEOUT
-                    // so that the caller knows we need more data
-                }
             }
 
             // Move along
@@ -266,12 +282,120 @@ static int32_t decodeHeader(const char *pBuffer, size_t bufferLengthBytes,
     }
 
     if ((sizeOrErrorCode >= 0) && (ppMessage != NULL)) {
-        *ppMessage = (const char *) pMessage;
+        *ppMessage = pMessage;
     }
 
     return sizeOrErrorCode;
 }
 
+// Get numBits, up to 32, starting bitOffset bits into pData, where
+// the data is MSB first.
+static uint32_t getBits(const uint8_t *pData, size_t bitOffset, size_t numBits)
+{
+    uint32_t value = 0;
+
+    pData += bitOffset >> 3;
+    bitOffset &= 0x07;
+    while (numBits > 0) {
+        value = (value << 1) | ((*pData >> (7 - bitOffset)) & 0x01);
+        bitOffset++;
+        if (bitOffset > 7) {
+            bitOffset = 0;
+            pData++;
+        }
+        numBits--;
+    }
+
+    return value;
+}
+
+// Return true if two messages are duplicates as far as a filter
+// is concerned.
+static bool filterIsDuplicate(const uSpartnFilter_t *pFilter,
+                              const uSpartnFilterEntry_t *pEntry,
+                              const uSpartnHeader_t *pHeader,
+                              uint32_t messageCrc)
+{
+    bool isDuplicate = (pEntry->header.messageType == pHeader->messageType) &&
+                       (pEntry->header.messageSubtype == pHeader->messageSubtype) &&
+                       (pEntry->header.timeTag == pHeader->timeTag) &&
+                       (pEntry->header.solutionId == pHeader->solutionId) &&
+                       (pEntry->header.solutionProcessorId == pHeader->solutionProcessorId);
+
+    if (isDuplicate && !pFilter->matchHeaderOnly) {
+        isDuplicate = (pEntry->header.payloadLengthBytes == pHeader->payloadLengthBytes) &&
+                      (pEntry->messageCrc == messageCrc);
+    }
+
+    return isDuplicate;
+}
+
+// Throw away the first byte in a reassembler's buffer, which must
+// not be empty, and everything up to the next possible FRAME START.
+static void reassemblerResync(uSpartnReassembler_t *pReassembler)
+{
+    const char *pStart;
+    size_t x = pReassembler->length;
+
+    pStart = (const char *) memchr(pReassembler->pBuffer + 1, 0x73,
+                                   pReassembler->length - 1);
+    if (pStart != NULL) {
+        x = pStart - pReassembler->pBuffer;
+    }
+    pReassembler->length -= x;
+    memmove(pReassembler->pBuffer, pReassembler->pBuffer + x, pReassembler->length);
+    pReassembler->messageLength = 0;
+}
+
+// Process whatever is in the buffer of a reassembler, returning
+// the number of messages passed to the callback.
+static int32_t reassemblerProcess(uSpartnReassembler_t *pReassembler)
+{
+    int32_t count = 0;
+    int32_t x;
+    const char *pMessage;
+    bool needMoreData = false;
+
+    while ((pReassembler->length > 0) && !needMoreData) {
+        if (pReassembler->messageLength == 0) {
+            // Don't have a header yet
+            x = decodeHeaderAt(pReassembler->pBuffer, pReassembler->length, NULL, NULL);
+            if (x == (int32_t) U_ERROR_COMMON_TIMEOUT) {
+                needMoreData = true;
+            } else if ((x <= 0) || ((size_t) x > pReassembler->bufferSize)) {
+                // Not a SPARTN message, or too big for us: move on
+                reassemblerResync(pReassembler);
+            } else {
+                pReassembler->messageLength = (size_t) x;
+            }
+        } else if (pReassembler->length < pReassembler->messageLength) {
+            needMoreData = true;
+        } else {
+            // Have a whole message: check it
+            x = uSpartnValidate(pReassembler->pBuffer, pReassembler->messageLength,
+                                &pMessage);
+            if ((x == (int32_t) pReassembler->messageLength) &&
+                (pMessage == pReassembler->pBuffer)) {
+                pReassembler->pCallback(pMessage, pReassembler->messageLength,
+                                        pReassembler->pCallbackParam);
+                count++;
+                // Keep anything left over, will only be a few bytes
+                pReassembler->length -= pReassembler->messageLength;
+                memmove(pReassembler->pBuffer,
+                        pReassembler->pBuffer + pReassembler->messageLength,
+                        pReassembler->length);
+                pReassembler->messageLength = 0;
+            } else {
+                // Message CRC failure, the real start of a message
+                // may be somewhere in what we have
+                reassemblerResync(pReassembler);
+            }
+        }
+    }
+
+    return count;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -352,4 +476,235 @@ int32_t uSpartnValidate(const char *pBuffer, size_t bufferLengthBytes,
     return sizeOrErrorCode;
 }
 
+// Decode the header of a SPARTN message.
+int32_t uSpartnDecodeHeader(const char *pMessage, size_t messageLengthBytes,
+                            uSpartnHeader_t *pHeader)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uint8_t *pInput = (const uint8_t *) pMessage;
+    size_t bitOffset;
+    size_t timeTagBits = 16;
+
+    if ((pMessage != NULL) && (*pMessage == 0x73) && (pHeader != NULL)) {
+        errorCode = decodeHeaderAt(pMessage, messageLengthBytes, NULL, NULL);
+        if (errorCode > 0) {
+            // The bit offsets are those in the diagram at the top of this file
+            pHeader->messageType = (int32_t) getBits(pInput, 8, 7);
+            pHeader->payloadLengthBytes = getBits(pInput, 15, 10);
+            pHeader->encryptedAuthenticated = (getBits(pInput, 25, 1) != 0);
+            pHeader->crcType = (uSpartnCrcType_t) getBits(pInput, 26, 2);
+            pHeader->messageSubtype = (int32_t) getBits(pInput, 32, 4);
+            pHeader->timeTag32Bit = (getBits(pInput, 36, 1) != 0);
+            if (pHeader->timeTag32Bit) {
+                timeTagBits = 32;
+            }
+            bitOffset = 37;
+            pHeader->timeTag = getBits(pInput, bitOffset, timeTagBits);
+            bitOffset += timeTagBits;
+            pHeader->solutionId = (int32_t) getBits(pInput, bitOffset, 7);
+            bitOffset += 7;
+            pHeader->solutionProcessorId = (int32_t) getBits(pInput, bitOffset, 4);
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Initialise a SPARTN filter.
+int32_t uSpartnFilterInit(uSpartnFilter_t *pFilter, int32_t windowMs,
+                          bool matchHeaderOnly)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pFilter != NULL) && (windowMs >= 0)) {
+        memset(pFilter, 0, sizeof(*pFilter));
+        pFilter->windowMs = windowMs;
+        pFilter->matchHeaderOnly = matchHeaderOnly;
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Set whether a SPARTN filter passes a message type/sub-type.
+int32_t uSpartnFilterSetSubtype(uSpartnFilter_t *pFilter, int32_t messageType,
+                                int32_t messageSubtype, bool pass)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uint16_t mask = 0xFFFF;
+
+    if ((pFilter != NULL) && (messageType >= 0) &&
+        (messageType < U_SPARTN_FILTER_NUM_MESSAGE_TYPES) &&
+        (messageSubtype >= -1) && (messageSubtype < 16)) {
+        if (messageSubtype >= 0) {
+            mask = (uint16_t) (1U << messageSubtype);
+        }
+        if (pass) {
+            pFilter->dropSubtypeMask[messageType] &= (uint16_t) ~mask;
+        } else {
+            pFilter->dropSubtypeMask[messageType] |= mask;
+        }
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Check a SPARTN message against a filter.
+bool uSpartnFilterCheck(uSpartnFilter_t *pFilter, const char *pMessage,
+                        size_t messageLengthBytes)
+{
+    bool pass = false;
+    uSpartnHeader_t header;
+    uSpartnFilterEntry_t *pEntry;
+    const uint8_t *pCrc;
+    uint32_t messageCrc = 0;
+    int32_t timeNowMs;
+
+    if (pFilter != NULL) {
+        if ((pMessage != NULL) &&
+            (uSpartnDecodeHeader(pMessage, messageLengthBytes, &header) == 0) &&
+            (messageLengthBytes >= (size_t) header.crcType + 1)) {
+            if ((header.messageType < U_SPARTN_FILTER_NUM_MESSAGE_TYPES) &&
+                ((pFilter->dropSubtypeMask[header.messageType] &
+                  (1U << header.messageSubtype)) != 0)) {
+                pFilter->counters.numDroppedSubtype++;
+            } else {
+                pass = true;
+                if (pFilter->windowMs > 0) {
+                    // The message CRC is the last 1 to 4 bytes
+                    pCrc = (const uint8_t *) pMessage + messageLengthBytes -
+                           (header.crcType + 1);
+                    for (size_t x = 0; x < (size_t) header.crcType + 1; x++) {
+                        messageCrc = (messageCrc << 8) | *(pCrc + x);
+                    }
+                    timeNowMs = uPortGetTickTimeMs();
+                    for (size_t x = 0; pass && (x < U_SPARTN_FILTER_HISTORY_LENGTH); x++) {
+                        pEntry = &(pFilter->history[x]);
+                        if (pEntry->inUse &&
+                            (timeNowMs - pEntry->timePassedMs < pFilter->windowMs) &&
+                            filterIsDuplicate(pFilter, pEntry, &header, messageCrc)) {
+                            pass = false;
+                        }
+                    }
+                    if (pass) {
+                        // Remember this one, overwriting the oldest
+                        pEntry = &(pFilter->history[pFilter->nextEntry]);
+                        pEntry->header = header;
+                        pEntry->messageCrc = messageCrc;
+                        pEntry->timePassedMs = timeNowMs;
+                        pEntry->inUse = true;
+                        pFilter->nextEntry++;
+                        if (pFilter->nextEntry >= U_SPARTN_FILTER_HISTORY_LENGTH) {
+                            pFilter->nextEntry = 0;
+                        }
+                    } else {
+                        pFilter->counters.numDroppedDuplicate++;
+                    }
+                }
+                if (pass) {
+                    pFilter->counters.numPassed++;
+                }
+            }
+        } else {
+            pFilter->counters.numDroppedInvalid++;
+        }
+    }
+
+    return pass;
+}
+
+// Get the counters of a SPARTN filter.
+int32_t uSpartnFilterGetCounters(uSpartnFilter_t *pFilter,
+                                 uSpartnFilterCounters_t *pCounters,
+                                 bool reset)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pFilter != NULL) && (pCounters != NULL)) {
+        *pCounters = pFilter->counters;
+        if (reset) {
+            memset(&(pFilter->counters), 0, sizeof(pFilter->counters));
+        }
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Initialise a SPARTN message reassembler.
+int32_t uSpartnReassemblerInit(uSpartnReassembler_t *pReassembler,
+                               char *pBuffer, size_t bufferSize,
+                               uSpartnReassemblerCallback_t pCallback,
+                               void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pReassembler != NULL) && (pBuffer != NULL) &&
+        (bufferSize >= U_SPARTN_HEADER_LENGTH_MAX_BYTES) && (pCallback != NULL)) {
+        memset(pReassembler, 0, sizeof(*pReassembler));
+        pReassembler->pBuffer = pBuffer;
+        pReassembler->bufferSize = bufferSize;
+        pReassembler->pCallback = pCallback;
+        pReassembler->pCallbackParam = pCallbackParam;
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Feed data to a SPARTN message reassembler.
+int32_t uSpartnReassemblerFeed(uSpartnReassembler_t *pReassembler,
+                               const char *pData, size_t length)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const char *pStart;
+    size_t x;
+
+    if ((pReassembler != NULL) && ((pData != NULL) || (length == 0))) {
+        errorCodeOrCount = 0;
+        while (length > 0) {
+            if (pReassembler->length == 0) {
+                // Nothing held, skip straight to a possible FRAME
+                // START without copying anything
+                pStart = (const char *) memchr(pData, 0x73, length);
+                if (pStart == NULL) {
+                    pStart = pData + length;
+                }
+                length -= pStart - pData;
+                pData = pStart;
+            }
+            if (length > 0) {
+                // Copy in no more than is needed to get the header
+                // or, if we have the header, to complete the message
+                if (pReassembler->messageLength > 0) {
+                    x = pReassembler->messageLength - pReassembler->length;
+                } else {
+                    x = U_SPARTN_HEADER_LENGTH_MAX_BYTES - pReassembler->length;
+                }
+                if (x > length) {
+                    x = length;
+                }
+                memcpy(pReassembler->pBuffer + pReassembler->length, pData, x);
+                pReassembler->length += x;
+                pData += x;
+                length -= x;
+                errorCodeOrCount += reassemblerProcess(pReassembler);
+            }
+        }
+    }
+
+    return errorCodeOrCount;
+}
+
+// Reset a SPARTN message reassembler.
+void uSpartnReassemblerReset(uSpartnReassembler_t *pReassembler)
+{
+    if (pReassembler != NULL) {
+        pReassembler->length = 0;
+        pReassembler->messageLength = 0;
+    }
+}
+
 // End of file
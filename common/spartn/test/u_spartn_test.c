@@ -181,6 +181,11 @@ static const uSpartnTestCrc_t gCrc32Ccitt = {
  */
 static const uSpartnTestCrc_t *gpTestData[] = {&gCrc4Ccitt, &gCrc8Ccitt, &gCrc16Ccitt, &gCrc32Ccitt};
 
+/** Buffer for checking the CRC-16/24/32 calculations over many
+ * lengths and alignments.
+ */
+static char gpSpartnCrcInput[64];
+
 #ifndef __ZEPHYR__
 
 /** A shortish valid SPARTN message.
@@ -247,6 +252,52 @@ static crc24 crc_octets(unsigned char *octets, size_t len)
     return crc & 0xFFFFFFL;
 }
 
+#ifndef __ZEPHYR__
+
+// Callback for the reassembler test: check that what we've
+// been given is a valid SPARTN message and count it.
+static void reassemblerCallback(const char *pMessage,
+                                size_t messageLengthBytes,
+                                void *pCallbackParam)
+{
+    const char *pTmp = NULL;
+
+    if ((uSpartnValidate(pMessage, messageLengthBytes, &pTmp) ==
+         (int32_t) messageLengthBytes) && (pTmp == pMessage)) {
+        (*((int32_t *) pCallbackParam))++;
+    }
+}
+
+#endif // __ZEPHYR__
+
+// A bit-wise implementation of a non-reflected CRC of up to 32 bits,
+// used to check the table-driven CRC code over lengths that exercise
+// all of the paths through it.
+static uint32_t crcBitwise(size_t width, uint32_t polynomial,
+                           uint32_t initial, uint32_t finalXor,
+                           const char *pData, size_t size)
+{
+    uint32_t topBit = 1UL << (width - 1);
+    uint32_t mask = topBit | (topBit - 1);
+    uint32_t crc = initial;
+
+    while (size > 0) {
+        crc ^= ((uint32_t) (uint8_t) *pData) << (width - 8);
+        for (size_t x = 0; x < 8; x++) {
+            if (crc & topBit) {
+                crc = (crc << 1) ^ polynomial;
+            } else {
+                crc <<= 1;
+            }
+        }
+        crc &= mask;
+        pData++;
+        size--;
+    }
+
+    return (crc ^ finalXor) & mask;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: TESTS
  * -------------------------------------------------------------- */
@@ -307,6 +358,29 @@ U_PORT_TEST_FUNCTION("[spartn]", "spartnCrc")
     U_TEST_PRINT_LINE("CRC-24: calculated 0x%08x, expected 0x%08x.", calculated, expected);
     U_PORT_TEST_ASSERT(calculated == expected);
 
+    // Check CRC-16, CRC-24 and CRC-32 against a bit-wise calculation
+    // for all lengths and alignments of a longer block of data, so
+    // that whatever slicing is configured is properly exercised
+    U_TEST_PRINT_LINE("testing CRC-16/24/32 (%d-byte slicing) against bit-wise"
+                      " calculations.", U_SPARTN_CRC_SLICE_BYTES);
+    for (size_t x = 0; x < sizeof(gpSpartnCrcInput); x++) {
+        gpSpartnCrcInput[x] = (char) (x * 37 + 0x5a);
+    }
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t size = 0; size <= sizeof(gpSpartnCrcInput) - offset; size++) {
+            calculated = uSpartnCrc16(gpSpartnCrcInput + offset, size);
+            expected = crcBitwise(16, 0x1021, 0, 0, gpSpartnCrcInput + offset, size);
+            U_PORT_TEST_ASSERT(calculated == expected);
+            calculated = uSpartnCrc24(gpSpartnCrcInput + offset, size);
+            expected = crcBitwise(24, 0x864CFB, 0, 0, gpSpartnCrcInput + offset, size);
+            U_PORT_TEST_ASSERT(calculated == expected);
+            calculated = uSpartnCrc32(gpSpartnCrcInput + offset, size);
+            expected = crcBitwise(32, 0x04C11DB7, 0xFFFFFFFF, 0xFFFFFFFF,
+                                  gpSpartnCrcInput + offset, size);
+            U_PORT_TEST_ASSERT(calculated == expected);
+        }
+    }
+
     // Check for memory leaks
     heapUsed -= uPortGetHeapFree();
     U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
@@ -451,6 +525,170 @@ U_PORT_TEST_FUNCTION("[spartn]", "spartnMessage")
     U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
 }
 
+/** Testing of the SPARTN message reassembler, feeding it the SPARTN
+ * message data kept in u_spartn_test_data.c in random-sized fragments.
+ */
+U_PORT_TEST_FUNCTION("[spartn]", "spartnReassembler")
+{
+    int32_t heapUsed;
+    uSpartnReassembler_t reassembler;
+    int32_t goodCount = 0;
+    int32_t messageCount = 0;
+    int32_t x;
+    size_t y;
+    size_t z;
+    const char *pData;
+    char *pBuffer;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+
+    U_TEST_PRINT_LINE("testing SPARTN message reassembly.");
+
+    pBuffer = (char *) pUPortMalloc(U_SPARTN_MESSAGE_LENGTH_MAX_BYTES);
+    U_PORT_TEST_ASSERT(pBuffer != NULL);
+
+    // Check parameters
+    U_PORT_TEST_ASSERT(uSpartnReassemblerInit(&reassembler, pBuffer,
+                                              U_SPARTN_HEADER_LENGTH_MAX_BYTES - 1,
+                                              reassemblerCallback, &goodCount) < 0);
+    U_PORT_TEST_ASSERT(uSpartnReassemblerInit(&reassembler, pBuffer,
+                                              U_SPARTN_MESSAGE_LENGTH_MAX_BYTES,
+                                              NULL, &goodCount) < 0);
+    U_PORT_TEST_ASSERT(uSpartnReassemblerInit(&reassembler, pBuffer,
+                                              U_SPARTN_MESSAGE_LENGTH_MAX_BYTES,
+                                              reassemblerCallback, &goodCount) == 0);
+
+    // Feed in the test data in fragments of random length
+    pData = gUSpartnTestData;
+    while (pData < gUSpartnTestData + gUSpartnTestDataSize) {
+        y = (rand() % 100) + 1;
+        if (pData + y > gUSpartnTestData + gUSpartnTestDataSize) {
+            y = gUSpartnTestData + gUSpartnTestDataSize - pData;
+        }
+        x = uSpartnReassemblerFeed(&reassembler, pData, y);
+        U_PORT_TEST_ASSERT(x >= 0);
+        messageCount += x;
+        pData += y;
+    }
+    U_TEST_PRINT_LINE("reassembled %d message(s) out of %d.", messageCount,
+                      gUSpartnTestDataNumMessages);
+    U_PORT_TEST_ASSERT(messageCount == (int32_t) gUSpartnTestDataNumMessages);
+    U_PORT_TEST_ASSERT(goodCount == messageCount);
+
+    // Now feed in a known message, a byte at a time, preceded
+    // by random rubbish that doesn't include a 0x73, so can't
+    // be taken for a FRAME START, and a partial message that
+    // should be thrown away by a reset
+    goodCount = 0;
+    messageCount = 0;
+    for (size_t w = 0; w < 10; w++) {
+        for (y = 0; y < U_SPARTN_TEST_BUFFER_EXTRA_SIZE_BYTES; y++) {
+            *(pBuffer + y) = (char) rand();
+            if (*(pBuffer + y) == 0x73) {
+                *(pBuffer + y) = 0;
+            }
+        }
+        U_PORT_TEST_ASSERT(uSpartnReassemblerFeed(&reassembler, pBuffer, y) == 0);
+        U_PORT_TEST_ASSERT(uSpartnReassemblerFeed(&reassembler, gpSpartnMessage,
+                                                  sizeof(gpSpartnMessage) / 2) == 0);
+        uSpartnReassemblerReset(&reassembler);
+        for (z = 0; z < sizeof(gpSpartnMessage); z++) {
+            x = uSpartnReassemblerFeed(&reassembler, gpSpartnMessage + z, 1);
+            U_PORT_TEST_ASSERT(x >= 0);
+            messageCount += x;
+        }
+    }
+    U_PORT_TEST_ASSERT(messageCount == 10);
+    U_PORT_TEST_ASSERT(goodCount == messageCount);
+
+    // Free memory
+    uPortFree(pBuffer);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
+/** Testing of SPARTN header decoding and of the SPARTN filter.
+ */
+U_PORT_TEST_FUNCTION("[spartn]", "spartnFilter")
+{
+    uSpartnHeader_t header;
+    uSpartnFilter_t *pFilter;
+    uSpartnFilterCounters_t counters;
+    char buffer[sizeof(gpSpartnMessage)];
+
+    U_TEST_PRINT_LINE("testing SPARTN filtering.");
+
+    // The filter is quite large so allocate it
+    pFilter = (uSpartnFilter_t *) pUPortMalloc(sizeof(*pFilter));
+    U_PORT_TEST_ASSERT(pFilter != NULL);
+
+    // Check header decoding
+    U_PORT_TEST_ASSERT(uSpartnDecodeHeader(gpSpartnMessage, 4, &header) ==
+                       (int32_t) U_ERROR_COMMON_TIMEOUT);
+    U_PORT_TEST_ASSERT(uSpartnDecodeHeader(gpSpartnMessage, sizeof(gpSpartnMessage),
+                                           &header) == 0);
+    U_PORT_TEST_ASSERT(header.messageType == 1);
+    U_PORT_TEST_ASSERT(header.messageSubtype == 2);
+    U_PORT_TEST_ASSERT(header.payloadLengthBytes == 483);
+    U_PORT_TEST_ASSERT(header.encryptedAuthenticated);
+    U_PORT_TEST_ASSERT(header.crcType == U_SPARTN_CRC_TYPE_24);
+    U_PORT_TEST_ASSERT(header.timeTag32Bit);
+
+    // Duplicates should be dropped
+    U_PORT_TEST_ASSERT(uSpartnFilterInit(pFilter, 60000, false) == 0);
+    U_PORT_TEST_ASSERT(uSpartnFilterCheck(pFilter, gpSpartnMessage, sizeof(gpSpartnMessage)));
+    U_PORT_TEST_ASSERT(!uSpartnFilterCheck(pFilter, gpSpartnMessage, sizeof(gpSpartnMessage)));
+    // ...but not if the CRC is different, unless only the header is matched
+    memcpy(buffer, gpSpartnMessage, sizeof(buffer));
+    buffer[sizeof(buffer) - 1]++;
+    U_PORT_TEST_ASSERT(uSpartnFilterCheck(pFilter, buffer, sizeof(buffer)));
+    // Unwanted sub-types should be dropped
+    U_PORT_TEST_ASSERT(uSpartnFilterSetSubtype(pFilter, U_SPARTN_FILTER_NUM_MESSAGE_TYPES,
+                                               -1, false) < 0);
+    U_PORT_TEST_ASSERT(uSpartnFilterSetSubtype(pFilter, header.messageType,
+                                               header.messageSubtype, false) == 0);
+    buffer[sizeof(buffer) - 1]++;
+    U_PORT_TEST_ASSERT(!uSpartnFilterCheck(pFilter, buffer, sizeof(buffer)));
+    U_PORT_TEST_ASSERT(uSpartnFilterSetSubtype(pFilter, header.messageType, -1, true) == 0);
+    U_PORT_TEST_ASSERT(uSpartnFilterCheck(pFilter, buffer, sizeof(buffer)));
+    // Rubbish is dropped
+    buffer[0] = 0;
+    U_PORT_TEST_ASSERT(!uSpartnFilterCheck(pFilter, buffer, sizeof(buffer)));
+    U_PORT_TEST_ASSERT(uSpartnFilterGetCounters(pFilter, &counters, true) == 0);
+    U_TEST_PRINT_LINE("%d passed, %d duplicate(s), %d sub-type(s), %d invalid.",
+                      counters.numPassed, counters.numDroppedDuplicate,
+                      counters.numDroppedSubtype, counters.numDroppedInvalid);
+    U_PORT_TEST_ASSERT(counters.numPassed == 3);
+    U_PORT_TEST_ASSERT(counters.numDroppedDuplicate == 1);
+    U_PORT_TEST_ASSERT(counters.numDroppedSubtype == 1);
+    U_PORT_TEST_ASSERT(counters.numDroppedInvalid == 1);
+    U_PORT_TEST_ASSERT(uSpartnFilterGetCounters(pFilter, &counters, false) == 0);
+    U_PORT_TEST_ASSERT(counters.numPassed == 0);
+
+    // Matching on the header only
+    U_PORT_TEST_ASSERT(uSpartnFilterInit(pFilter, 60000, true) == 0);
+    memcpy(buffer, gpSpartnMessage, sizeof(buffer));
+    buffer[sizeof(buffer) - 1]++;
+    U_PORT_TEST_ASSERT(uSpartnFilterCheck(pFilter, gpSpartnMessage, sizeof(gpSpartnMessage)));
+    U_PORT_TEST_ASSERT(!uSpartnFilterCheck(pFilter, buffer, sizeof(buffer)));
+
+    // With no window there is no de-duplication
+    U_PORT_TEST_ASSERT(uSpartnFilterInit(pFilter, 0, false) == 0);
+    U_PORT_TEST_ASSERT(uSpartnFilterCheck(pFilter, gpSpartnMessage, sizeof(gpSpartnMessage)));
+    U_PORT_TEST_ASSERT(uSpartnFilterCheck(pFilter, gpSpartnMessage, sizeof(gpSpartnMessage)));
+
+    uPortFree(pFilter);
+}
+
 #endif // __ZEPHYR__
 
 /** Clean-up to be run at the end of this round of tests, just
@@ -56,6 +56,43 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** Callback called by uUbxProtocolDecoderFeed() with each complete
+ * UBX message.
+ *
+ * @param messageClass     the UBX message class.
+ * @param messageId        the UBX message ID.
+ * @param[in] pBody        the message body, which is only valid for
+ *                         the duration of the callback.
+ * @param bodyLengthBytes  the length of the message body; if this is
+ *                         larger than the bodySize given to
+ *                         uUbxProtocolDecoderInit() then only
+ *                         bodySize bytes are at pBody.
+ * @param[in] pCallbackParam the parameter given to uUbxProtocolDecoderInit().
+ */
+typedef void (*uUbxProtocolDecoderCallback_t)(int32_t messageClass,
+                                              int32_t messageId,
+                                              const char *pBody,
+                                              size_t bodyLengthBytes,
+                                              void *pCallbackParam);
+
+/** A streaming UBX message decoder, see uUbxProtocolDecoderInit();
+ * the contents are private.
+ */
+typedef struct {
+    char *pBody;
+    size_t bodySize;
+    uUbxProtocolDecoderCallback_t pCallback;
+    void *pCallbackParam;
+    int32_t state;
+    uint8_t ca;
+    uint8_t cb;
+    uint8_t messageClass;
+    uint8_t messageId;
+    size_t bodyLength;
+    size_t count;
+    bool complete;
+} uUbxProtocolDecoder_t;
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -143,7 +180,14 @@ uint64_t uUbxProtocolUint64Encode(uint64_t uint64);
  *                                message is to be stored; at least
  *                                messageLengthBytes +
  *                                #U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES
- *                                must be allowed.
+ *                                must be allowed.  If the message body
+ *                                has already been written at
+ *                                pBuffer + #U_UBX_PROTOCOL_HEADER_LENGTH_BYTES
+ *                                then pMessageBody may be set to that
+ *                                address; the body is then not copied,
+ *                                only the header and checksum are
+ *                                written around it, see also
+ *                                uUbxProtocolEncodeInPlace().
  * @return                        on success the number of bytes written
  *                                to pBuffer, else negative error code.
  */
@@ -151,6 +195,27 @@ int32_t uUbxProtocolEncode(int32_t messageClass, int32_t messageId,
                            const char *pMessageBody, size_t messageBodyLengthBytes,
                            char *pBuffer);
 
+/** Encode a UBX protocol message whose body has been assembled by
+ * the caller at pBuffer + #U_UBX_PROTOCOL_HEADER_LENGTH_BYTES: the
+ * header is written into the #U_UBX_PROTOCOL_HEADER_LENGTH_BYTES
+ * bytes reserved before the body and the checksum into the two
+ * bytes after it, avoiding the need for a second buffer and a copy.
+ *
+ * @param messageClass            the UBX protocol message class.
+ * @param messageId               the UBX protocol message ID.
+ * @param[in,out] pBuffer         the buffer, which must be at least
+ *                                messageBodyLengthBytes +
+ *                                #U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES
+ *                                long, with the message body at
+ *                                offset #U_UBX_PROTOCOL_HEADER_LENGTH_BYTES.
+ * @param messageBodyLengthBytes  the length of the message body.
+ * @return                        on success the length of the encoded
+ *                                message at pBuffer, else negative
+ *                                error code.
+ */
+int32_t uUbxProtocolEncodeInPlace(int32_t messageClass, int32_t messageId,
+                                  char *pBuffer, size_t messageBodyLengthBytes);
+
 /** Decode a UBX protocol message.  Call this function with a buffer
  * and it will return the first valid UBX format message it finds
  * in the buffer. ppBufferOut will be set to the first position in
@@ -229,6 +294,82 @@ int32_t uUbxProtocolDecode(const char *pBufferIn, size_t bufferLengthBytes,
                            char *pMessageBody, size_t maxMessageBodyLengthBytes,
                            const char **ppBufferOut);
 
+/** Initialise a streaming UBX message decoder.  Unlike
+ * uUbxProtocolDecode(), which needs a whole message in one buffer,
+ * a streaming decoder may be fed data in fragments of any size, e.g.
+ * as they arrive over a UART, with the checksum calculated as the
+ * data goes by; each byte is examined just once.  The decoder
+ * handles one stream of data, it is up to the caller to prevent
+ * simultaneous calls with the same decoder.
+ *
+ * @param[out] pDecoder    a pointer to the decoder to initialise,
+ *                         cannot be NULL.
+ * @param[in] pBody        storage for the body of a message, which
+ *                         must remain valid while the decoder is in
+ *                         use; may be NULL if bodySize is zero, in
+ *                         which case message bodies are not stored,
+ *                         just checked.
+ * @param bodySize         the amount of storage at pBody.
+ * @param pCallback        the callback to be called with each complete
+ *                         message; may be NULL, in which case
+ *                         uUbxProtocolDecoderFeed() stops after each
+ *                         complete message and the message should be
+ *                         retrieved with uUbxProtocolDecoderGet().
+ * @param[in] pCallbackParam a parameter that will be passed to pCallback.
+ * @return                 zero on success else negative error code.
+ */
+int32_t uUbxProtocolDecoderInit(uUbxProtocolDecoder_t *pDecoder,
+                                char *pBody, size_t bodySize,
+                                uUbxProtocolDecoderCallback_t pCallback,
+                                void *pCallbackParam);
+
+/** Feed data to a streaming UBX message decoder.  Anything that is
+ * not a valid UBX message is discarded.
+ *
+ * @param[in] pDecoder     a pointer to the decoder, as passed to
+ *                         uUbxProtocolDecoderInit().
+ * @param[in] pData        the data.
+ * @param length           the amount of data at pData.
+ * @return                 on success the number of bytes of pData
+ *                         consumed, else negative error code; this
+ *                         will be length unless no callback was given
+ *                         to uUbxProtocolDecoderInit(), in which case
+ *                         it may be less if a complete message was
+ *                         found: the message should be retrieved with
+ *                         uUbxProtocolDecoderGet() and the remaining
+ *                         data should then be fed in.
+ */
+int32_t uUbxProtocolDecoderFeed(uUbxProtocolDecoder_t *pDecoder,
+                                const char *pData, size_t length);
+
+/** Get the complete message from a streaming UBX message decoder
+ * that has no callback; the message remains available until the
+ * next call to uUbxProtocolDecoderFeed().
+ *
+ * @param[in] pDecoder       a pointer to the decoder.
+ * @param[out] pMessageClass a place to put the message class; may be NULL.
+ * @param[out] pMessageId    a place to put the message ID; may be NULL.
+ * @param[out] ppBody        a place to put a pointer to the message body,
+ *                           which will be the pBody given to
+ *                           uUbxProtocolDecoderInit(); may be NULL.
+ * @return                   the length of the message body (which may
+ *                           be larger than the bodySize given to
+ *                           uUbxProtocolDecoderInit(), in which case
+ *                           only bodySize bytes were stored) or
+ *                           #U_ERROR_COMMON_TIMEOUT if there is no
+ *                           complete message.
+ */
+int32_t uUbxProtocolDecoderGet(uUbxProtocolDecoder_t *pDecoder,
+                               int32_t *pMessageClass, int32_t *pMessageId,
+                               const char **ppBody);
+
+/** Reset a streaming UBX message decoder, throwing away any
+ * partial message.
+ *
+ * @param[in] pDecoder     a pointer to the decoder.
+ */
+void uUbxProtocolDecoderReset(uUbxProtocolDecoder_t *pDecoder);
+
 #ifdef __cplusplus
 }
 #endif
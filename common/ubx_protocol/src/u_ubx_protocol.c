@@ -45,6 +45,20 @@
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The states of a streaming decoder.
+ */
+typedef enum {
+    U_UBX_PROTOCOL_DECODER_STATE_SYNC_1 = 0,
+    U_UBX_PROTOCOL_DECODER_STATE_SYNC_2,
+    U_UBX_PROTOCOL_DECODER_STATE_CLASS,
+    U_UBX_PROTOCOL_DECODER_STATE_ID,
+    U_UBX_PROTOCOL_DECODER_STATE_LENGTH_1,
+    U_UBX_PROTOCOL_DECODER_STATE_LENGTH_2,
+    U_UBX_PROTOCOL_DECODER_STATE_BODY,
+    U_UBX_PROTOCOL_DECODER_STATE_CK_A,
+    U_UBX_PROTOCOL_DECODER_STATE_CK_B
+} uUbxProtocolDecoderState_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -53,6 +67,36 @@
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Add length bytes at pData to the Fletcher-8 checksum ca/cb, four
+// bytes at a time for as long as possible.
+static void fletcher(const uint8_t *pData, size_t length,
+                     uint8_t *pCa, uint8_t *pCb)
+{
+    uint32_t ca = *pCa;
+    uint32_t cb = *pCb;
+
+    while (length >= 4) {
+        // Over four bytes ca gains d0 + d1 + d2 + d3 while cb gains
+        // four times the starting ca plus d0 * 4 + d1 * 3 + d2 * 2 + d3;
+        // everything is truncated to 8 bits at the end so the 32-bit
+        // sums can't overflow in a way that matters
+        cb += (ca << 2) + (((uint32_t) *pData) << 2) + (((uint32_t) *(pData + 1)) * 3) +
+              (((uint32_t) *(pData + 2)) << 1) + *(pData + 3);
+        ca += (uint32_t) *pData + *(pData + 1) + *(pData + 2) + *(pData + 3);
+        pData += 4;
+        length -= 4;
+    }
+    while (length > 0) {
+        ca += *pData;
+        cb += ca;
+        pData++;
+        length--;
+    }
+
+    *pCa = (uint8_t) ca;
+    *pCb = (uint8_t) cb;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -170,8 +214,8 @@ int32_t uUbxProtocolEncode(int32_t messageClass, int32_t messageId,
     int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
     // Use a uint8_t pointer for maths, more certain of its behaviour than char
     uint8_t *pWrite = (uint8_t *) pBuffer;
-    int32_t ca = 0;
-    int32_t cb = 0;
+    uint8_t ca = 0;
+    uint8_t cb = 0;
 
     if (((messageBodyLengthBytes == 0) || (pMessage != NULL)) &&
         (pBuffer != NULL)) {
@@ -184,24 +228,19 @@ int32_t uUbxProtocolEncode(int32_t messageClass, int32_t messageId,
         *pWrite++ = (uint8_t) (messageBodyLengthBytes & (uint8_t) 0xff);
         *pWrite++ = (uint8_t) (messageBodyLengthBytes >> 8);
 
-        if (pMessage != NULL) {
-            // Copy in the message body
+        if ((pMessage != NULL) && (pMessage != (const char *) pWrite)) {
+            // Copy in the message body, if it is not already there
             memcpy(pWrite, pMessage, messageBodyLengthBytes);
-            pWrite += messageBodyLengthBytes;
         }
+        pWrite += messageBodyLengthBytes;
 
         // Work out the CRC over the variable elements of the
         // header and the body
-        pBuffer += 2;
-        for (size_t x = 0; x < messageBodyLengthBytes + 4; x++) {
-            ca += (uint8_t) *pBuffer; // *NOPAD*
-            cb += ca;
-            pBuffer++;
-        }
+        fletcher((const uint8_t *) pBuffer + 2, messageBodyLengthBytes + 4, &ca, &cb);
 
         // Write in the CRC
-        *pWrite++ = (uint8_t) (ca & (uint8_t) 0xff);
-        *pWrite = (uint8_t) (cb & (uint8_t) 0xff);
+        *pWrite++ = ca;
+        *pWrite = cb;
 
         errorCodeOrLength = (int32_t) (U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES + messageBodyLengthBytes);
     }
@@ -209,6 +248,21 @@ int32_t uUbxProtocolEncode(int32_t messageClass, int32_t messageId,
     return errorCodeOrLength;
 }
 
+// Encode a UBX protocol message whose body is already in place.
+int32_t uUbxProtocolEncodeInPlace(int32_t messageClass, int32_t messageId,
+                                  char *pBuffer, size_t messageBodyLengthBytes)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pBuffer != NULL) {
+        errorCodeOrLength = uUbxProtocolEncode(messageClass, messageId,
+                                               pBuffer + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES,
+                                               messageBodyLengthBytes, pBuffer);
+    }
+
+    return errorCodeOrLength;
+}
+
 // Decode a UBX protocol message.
 int32_t uUbxProtocolDecode(const char *pBufferIn, size_t bufferLengthBytes,
                            int32_t *pMessageClass, int32_t *pMessageId,
@@ -343,4 +397,175 @@ int32_t uUbxProtocolDecode(const char *pBufferIn, size_t bufferLengthBytes,
     return sizeOrErrorCode;
 }
 
+// Initialise a streaming decoder.
+int32_t uUbxProtocolDecoderInit(uUbxProtocolDecoder_t *pDecoder,
+                                char *pBody, size_t bodySize,
+                                uUbxProtocolDecoderCallback_t pCallback,
+                                void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pDecoder != NULL) && ((pBody != NULL) || (bodySize == 0))) {
+        memset(pDecoder, 0, sizeof(*pDecoder));
+        pDecoder->pBody = pBody;
+        pDecoder->bodySize = bodySize;
+        pDecoder->pCallback = pCallback;
+        pDecoder->pCallbackParam = pCallbackParam;
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Feed data to a streaming decoder.
+int32_t uUbxProtocolDecoderFeed(uUbxProtocolDecoder_t *pDecoder,
+                                const char *pData, size_t length)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    // Use a uint8_t pointer for maths, more certain of its behaviour than char
+    const uint8_t *pInput = (const uint8_t *) pData;
+    const uint8_t *pEnd = pInput + length;
+    const uint8_t *pTmp;
+    size_t x;
+    size_t y;
+
+    if ((pDecoder != NULL) && ((pData != NULL) || (length == 0))) {
+        // Any message from last time has been dealt with
+        pDecoder->complete = false;
+        while ((pInput < pEnd) && !pDecoder->complete) {
+            switch (pDecoder->state) {
+                case U_UBX_PROTOCOL_DECODER_STATE_SYNC_1:
+                    //lint -e{650} Suppress warning about 0xb5 being out of range for char
+                    pTmp = (const uint8_t *) memchr(pInput, 0xb5, pEnd - pInput);
+                    if (pTmp != NULL) {
+                        pInput = pTmp + 1;
+                        pDecoder->state = U_UBX_PROTOCOL_DECODER_STATE_SYNC_2;
+                    } else {
+                        pInput = pEnd;
+                    }
+                    break;
+                case U_UBX_PROTOCOL_DECODER_STATE_SYNC_2:
+                    // If this is not 0x62 then don't consume it, it
+                    // may be the start of a message
+                    pDecoder->state = U_UBX_PROTOCOL_DECODER_STATE_SYNC_1;
+                    if (*pInput == 0x62) {
+                        pDecoder->ca = 0;
+                        pDecoder->cb = 0;
+                        pDecoder->state = U_UBX_PROTOCOL_DECODER_STATE_CLASS;
+                        pInput++;
+                    }
+                    break;
+                case U_UBX_PROTOCOL_DECODER_STATE_CLASS:
+                case U_UBX_PROTOCOL_DECODER_STATE_ID:
+                case U_UBX_PROTOCOL_DECODER_STATE_LENGTH_1:
+                case U_UBX_PROTOCOL_DECODER_STATE_LENGTH_2:
+                    // These all go into the checksum
+                    pDecoder->ca += *pInput;
+                    pDecoder->cb += pDecoder->ca;
+                    if (pDecoder->state == U_UBX_PROTOCOL_DECODER_STATE_CLASS) {
+                        pDecoder->messageClass = *pInput;
+                    } else if (pDecoder->state == U_UBX_PROTOCOL_DECODER_STATE_ID) {
+                        pDecoder->messageId = *pInput;
+                    } else if (pDecoder->state == U_UBX_PROTOCOL_DECODER_STATE_LENGTH_1) {
+                        pDecoder->bodyLength = *pInput;
+                    } else {
+                        pDecoder->bodyLength += ((size_t) *pInput) << 8; // *NOPAD*
+                        pDecoder->count = 0;
+                    }
+                    pDecoder->state++;
+                    if ((pDecoder->state == U_UBX_PROTOCOL_DECODER_STATE_BODY) &&
+                        (pDecoder->bodyLength == 0)) {
+                        pDecoder->state = U_UBX_PROTOCOL_DECODER_STATE_CK_A;
+                    }
+                    pInput++;
+                    break;
+                case U_UBX_PROTOCOL_DECODER_STATE_BODY:
+                    // Do as much of the body as we have in one go
+                    x = pDecoder->bodyLength - pDecoder->count;
+                    if (x > (size_t) (pEnd - pInput)) {
+                        x = pEnd - pInput;
+                    }
+                    if (pDecoder->count < pDecoder->bodySize) {
+                        y = pDecoder->bodySize - pDecoder->count;
+                        if (y > x) {
+                            y = x;
+                        }
+                        memcpy(pDecoder->pBody + pDecoder->count, pInput, y);
+                    }
+                    pDecoder->count += x;
+                    fletcher(pInput, x, &(pDecoder->ca), &(pDecoder->cb));
+                    pInput += x;
+                    if (pDecoder->count >= pDecoder->bodyLength) {
+                        pDecoder->state = U_UBX_PROTOCOL_DECODER_STATE_CK_A;
+                    }
+                    break;
+                case U_UBX_PROTOCOL_DECODER_STATE_CK_A:
+                    pDecoder->state = U_UBX_PROTOCOL_DECODER_STATE_CK_B;
+                    if (*pInput != pDecoder->ca) {
+                        pDecoder->state = U_UBX_PROTOCOL_DECODER_STATE_SYNC_1;
+                    }
+                    pInput++;
+                    break;
+                case U_UBX_PROTOCOL_DECODER_STATE_CK_B:
+                    pDecoder->state = U_UBX_PROTOCOL_DECODER_STATE_SYNC_1;
+                    if (*pInput == pDecoder->cb) {
+                        if (pDecoder->pCallback != NULL) {
+                            pDecoder->pCallback(pDecoder->messageClass,
+                                                pDecoder->messageId,
+                                                pDecoder->pBody,
+                                                pDecoder->bodyLength,
+                                                pDecoder->pCallbackParam);
+                        } else {
+                            // Stop here for uUbxProtocolDecoderGet()
+                            pDecoder->complete = true;
+                        }
+                    }
+                    pInput++;
+                    break;
+                default:
+                    pDecoder->state = U_UBX_PROTOCOL_DECODER_STATE_SYNC_1;
+                    break;
+            }
+        }
+        errorCodeOrLength = (int32_t) (pInput - (const uint8_t *) pData);
+    }
+
+    return errorCodeOrLength;
+}
+
+// Get the complete message from a streaming decoder.
+int32_t uUbxProtocolDecoderGet(uUbxProtocolDecoder_t *pDecoder,
+                               int32_t *pMessageClass, int32_t *pMessageId,
+                               const char **ppBody)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pDecoder != NULL) {
+        errorCodeOrLength = (int32_t) U_ERROR_COMMON_TIMEOUT;
+        if (pDecoder->complete) {
+            if (pMessageClass != NULL) {
+                *pMessageClass = pDecoder->messageClass;
+            }
+            if (pMessageId != NULL) {
+                *pMessageId = pDecoder->messageId;
+            }
+            if (ppBody != NULL) {
+                *ppBody = pDecoder->pBody;
+            }
+            errorCodeOrLength = (int32_t) pDecoder->bodyLength;
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
+// Reset a streaming decoder.
+void uUbxProtocolDecoderReset(uUbxProtocolDecoder_t *pDecoder)
+{
+    if (pDecoder != NULL) {
+        pDecoder->state = U_UBX_PROTOCOL_DECODER_STATE_SYNC_1;
+        pDecoder->complete = false;
+    }
+}
+
 // End of file
@@ -68,10 +68,24 @@
 # define U_UBX_PROTOCOL_TEST_MAX_BODY_SIZE 1024
 #endif
 
+#ifndef U_UBX_PROTOCOL_TEST_STREAM_NUM_MESSAGES
+/** The number of messages to put in the stream for the streaming
+ * decoder test.
+ */
+# define U_UBX_PROTOCOL_TEST_STREAM_NUM_MESSAGES 20
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** Context for the streaming decoder test callback.
+ */
+typedef struct {
+    int32_t numMessages;
+    int32_t numErrors;
+} uUbxProtocolTestStream_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -80,6 +94,41 @@
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Check that a message from the streaming decoder is the one
+// expected: the nth message has class n, ID n + 1, a body of
+// length n * 10 and body contents of the byte index plus n, of
+// which storedLengthBytes are checked.
+static bool checkStreamMessage(int32_t n, int32_t messageClass,
+                               int32_t messageId, const char *pBody,
+                               size_t bodyLengthBytes,
+                               size_t storedLengthBytes)
+{
+    bool good = (messageClass == n) && (messageId == n + 1) &&
+                (bodyLengthBytes == (size_t) n * 10);
+
+    for (size_t x = 0; good && (x < storedLengthBytes); x++) {
+        good = (*(pBody + x) == (char) (x + n));
+    }
+
+    return good;
+}
+
+// Callback for the streaming decoder test.
+static void streamCallback(int32_t messageClass, int32_t messageId,
+                           const char *pBody, size_t bodyLengthBytes,
+                           void *pCallbackParam)
+{
+    uUbxProtocolTestStream_t *pStream = (uUbxProtocolTestStream_t *) pCallbackParam;
+
+    // Only every other message in the stream is valid
+    if (!checkStreamMessage(pStream->numMessages * 2, messageClass,
+                            messageId, pBody, bodyLengthBytes,
+                            bodyLengthBytes)) {
+        pStream->numErrors++;
+    }
+    pStream->numMessages++;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: TESTS
  * -------------------------------------------------------------- */
@@ -101,7 +150,10 @@ U_PORT_TEST_FUNCTION("[ubxProtocol]", "ubxProtocolBackToBack")
 
     pBodyIn = (char *) pUPortMalloc(U_UBX_PROTOCOL_TEST_MAX_BODY_SIZE);
     U_PORT_TEST_ASSERT(pBodyIn != NULL);
-    pBodyOut = (char *) pUPortMalloc(U_UBX_PROTOCOL_TEST_MAX_BODY_SIZE);
+    // Room for a whole encoded message in pBodyOut, it is also used
+    // to check the in-place encode
+    pBodyOut = (char *) pUPortMalloc(U_UBX_PROTOCOL_TEST_MAX_BODY_SIZE +
+                                     U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
     U_PORT_TEST_ASSERT(pBodyOut != NULL);
     pBuffer = (char *) pUPortMalloc(U_UBX_PROTOCOL_TEST_MAX_BODY_SIZE +
                                     U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
@@ -139,6 +191,14 @@ U_PORT_TEST_FUNCTION("[ubxProtocol]", "ubxProtocolBackToBack")
             //lint -e(650) Suppress constant out of range; it isn't
             U_PORT_TEST_ASSERT(*(pBodyOut + y) == (char) 0xff);
         }
+        // Encoding in place, with the body already in the buffer,
+        // should give exactly the same result
+        memcpy(pBodyOut, pBuffer, x + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+        memset(pBuffer, 0xff, x + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+        memcpy(pBuffer + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES, pBodyIn, x);
+        U_PORT_TEST_ASSERT(uUbxProtocolEncodeInPlace(classIn, idIn, pBuffer,
+                                                     x) == x + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+        U_PORT_TEST_ASSERT(memcmp(pBuffer, pBodyOut, x + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES) == 0);
         // No very good way to test CRC here but check that changing it
         // in the encoded message causes a decode failure
         (*(pBuffer + x + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES - 1))++;
@@ -172,6 +232,105 @@ U_PORT_TEST_FUNCTION("[ubxProtocol]", "ubxProtocolBackToBack")
     uPortFree(pBuffer);
 }
 
+/** Test of the streaming UBX protocol decoder.
+ */
+U_PORT_TEST_FUNCTION("[ubxProtocol]", "ubxProtocolStream")
+{
+    char *pBuffer;
+    char *pBody;
+    char *pStreamBuffer;
+    size_t streamLength = 0;
+    size_t bufferLength = 0;
+    size_t fragmentLength;
+    int32_t x;
+    int32_t y;
+    int32_t messageClass;
+    int32_t messageId;
+    const char *pTmp;
+    uUbxProtocolDecoder_t decoder;
+    uUbxProtocolTestStream_t stream = {0};
+
+    //lint -e{647} Suppress suspicious truncation
+    bufferLength = U_UBX_PROTOCOL_TEST_STREAM_NUM_MESSAGES *
+                   (U_UBX_PROTOCOL_TEST_STREAM_NUM_MESSAGES * 10 +
+                    U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES + 3);
+    pStreamBuffer = (char *) pUPortMalloc(bufferLength);
+    U_PORT_TEST_ASSERT(pStreamBuffer != NULL);
+    pBody = (char *) pUPortMalloc(U_UBX_PROTOCOL_TEST_STREAM_NUM_MESSAGES * 10);
+    U_PORT_TEST_ASSERT(pBody != NULL);
+    pBuffer = pStreamBuffer;
+
+    // Build a stream of messages, each preceded by some junk which
+    // includes a false start, with every odd-numbered message
+    // corrupted so that it should be rejected
+    for (x = 0; x < U_UBX_PROTOCOL_TEST_STREAM_NUM_MESSAGES; x++) {
+        //lint -e(650) Suppress constant out of range; it isn't
+        *pBuffer++ = (char) 0xb5;
+        *pBuffer++ = (char) x;
+        *pBuffer++ = (char) 0xb5;
+        for (y = 0; y < x * 10; y++) {
+            *(pBody + y) = (char) (y + x);
+        }
+        y = uUbxProtocolEncode(x, x + 1, pBody, x * 10, pBuffer);
+        U_PORT_TEST_ASSERT(y == x * 10 + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+        if (x & 1) {
+            (*(pBuffer + y - 1))++;
+        }
+        pBuffer += y;
+    }
+    streamLength = pBuffer - pStreamBuffer;
+    U_PORT_TEST_ASSERT(streamLength <= bufferLength);
+
+    // Feed the stream to a decoder with a callback in fragments of
+    // all sizes from one byte upwards
+    for (fragmentLength = 1; fragmentLength < 32; fragmentLength++) {
+        memset(&stream, 0, sizeof(stream));
+        U_PORT_TEST_ASSERT(uUbxProtocolDecoderInit(&decoder, pBody,
+                                                   U_UBX_PROTOCOL_TEST_STREAM_NUM_MESSAGES * 10,
+                                                   streamCallback, &stream) == 0);
+        for (size_t z = 0; z < streamLength; z += fragmentLength) {
+            y = (int32_t) fragmentLength;
+            if (z + y > streamLength) {
+                y = (int32_t) (streamLength - z);
+            }
+            U_PORT_TEST_ASSERT(uUbxProtocolDecoderFeed(&decoder, pStreamBuffer + z, y) == y);
+        }
+        U_PORT_TEST_ASSERT(stream.numMessages == (U_UBX_PROTOCOL_TEST_STREAM_NUM_MESSAGES + 1) / 2);
+        U_PORT_TEST_ASSERT(stream.numErrors == 0);
+    }
+
+    // Now without a callback, with a body buffer too small for
+    // most of the messages
+    U_PORT_TEST_ASSERT(uUbxProtocolDecoderInit(&decoder, pBody, 10, NULL, NULL) == 0);
+    U_PORT_TEST_ASSERT(uUbxProtocolDecoderGet(&decoder, NULL, NULL, NULL) < 0);
+    pBuffer = pStreamBuffer;
+    x = 0;
+    while (pBuffer < pStreamBuffer + streamLength) {
+        y = uUbxProtocolDecoderFeed(&decoder, pBuffer, pStreamBuffer + streamLength - pBuffer);
+        U_PORT_TEST_ASSERT(y > 0);
+        pBuffer += y;
+        y = uUbxProtocolDecoderGet(&decoder, &messageClass, &messageId, &pTmp);
+        if (y >= 0) {
+            U_PORT_TEST_ASSERT(pTmp == pBody);
+            U_PORT_TEST_ASSERT(checkStreamMessage(x, messageClass, messageId,
+                                                  pTmp, y, y < 10 ? y : 10));
+            x += 2;
+        }
+    }
+    U_PORT_TEST_ASSERT(x == ((U_UBX_PROTOCOL_TEST_STREAM_NUM_MESSAGES + 1) / 2) * 2);
+
+    // Check that a reset throws away a partial message
+    uUbxProtocolDecoderReset(&decoder);
+    y = uUbxProtocolEncode(1, 2, NULL, 0, pStreamBuffer);
+    U_PORT_TEST_ASSERT(uUbxProtocolDecoderFeed(&decoder, pStreamBuffer, y - 1) == y - 1);
+    uUbxProtocolDecoderReset(&decoder);
+    U_PORT_TEST_ASSERT(uUbxProtocolDecoderFeed(&decoder, pStreamBuffer + y - 1, 1) == 1);
+    U_PORT_TEST_ASSERT(uUbxProtocolDecoderGet(&decoder, NULL, NULL, NULL) < 0);
+
+    uPortFree(pBody);
+    uPortFree(pStreamBuffer);
+}
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
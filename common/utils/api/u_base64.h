@@ -42,6 +42,17 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** Context for a streaming base 64 encode or decode, see
+ * uBase64EncodeStart()/uBase64DecodeStart(); the contents
+ * are private.
+ */
+typedef struct {
+    char carry[4];      /**< input held over from the last update
+                             because it was not a whole group. */
+    size_t carryLength; /**< the number of bytes at carry. */
+    bool padded;        /**< decode only: padding has been seen. */
+} uBase64Context_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -87,6 +98,107 @@ int32_t uBase64Encode(const char *pBinary, size_t binaryLengthBytes,
 int32_t uBase64Decode(const char *pBase64, size_t base64LengthBytes,
                       char *pBinary, size_t binaryLengthBytes);
 
+/** Start a streaming base 64 encode: the binary data may then be
+ * passed to uBase64EncodeUpdate() in pieces of any size, followed
+ * by a call to uBase64EncodeFinish(); the output is the same as
+ * that of uBase64Encode() on the whole data.
+ *
+ * @param[out] pContext     a pointer to the context to start, cannot
+ *                          be NULL.
+ */
+void uBase64EncodeStart(uBase64Context_t *pContext);
+
+/** Encode a piece of binary data in a streaming base 64 encode;
+ * up to two bytes may be held over in the context until there are
+ * enough to encode.
+ *
+ * @param[in] pContext      a pointer to the context, as passed to
+ *                          uBase64EncodeStart(), cannot be NULL.
+ * @param[in] pBinary       the binary data to be encoded.
+ * @param binaryLengthBytes the amount of binary data.
+ * @param[out] pBase64      a place to store the base 64 encoded
+ *                          data; set this to NULL to simply
+ *                          obtain the length that the encoded data
+ *                          would occupy without doing an encoding,
+ *                          in which case the context is not changed.
+ *                          Note that no null-terminator is included.
+ * @param base64LengthBytes the amount of storage at pBase64.
+ * @return                  the number of bytes stored at pBase64,
+ *                          or the number of bytes that _would_ be
+ *                          stored at pBase64 if it were NULL, else
+ *                          negative error code; if there is not
+ *                          enough storage at pBase64 nothing is
+ *                          encoded and #U_ERROR_COMMON_NO_MEMORY is
+ *                          returned.
+ */
+int32_t uBase64EncodeUpdate(uBase64Context_t *pContext,
+                            const char *pBinary, size_t binaryLengthBytes,
+                            char *pBase64, size_t base64LengthBytes);
+
+/** Finish a streaming base 64 encode, writing out any held-over
+ * bytes with padding.
+ *
+ * @param[in] pContext      a pointer to the context, cannot be NULL.
+ * @param[out] pBase64      a place to store the final base 64
+ *                          encoded data, at most four bytes; may be
+ *                          NULL to obtain the length only.
+ * @param base64LengthBytes the amount of storage at pBase64.
+ * @return                  the number of bytes stored at pBase64 (or
+ *                          that would be), else negative error code.
+ */
+int32_t uBase64EncodeFinish(uBase64Context_t *pContext,
+                            char *pBase64, size_t base64LengthBytes);
+
+/** Start a streaming base 64 decode: the base 64 data may then be
+ * passed to uBase64DecodeUpdate() in pieces of any size, followed
+ * by a call to uBase64DecodeFinish().
+ *
+ * @param[out] pContext     a pointer to the context to start, cannot
+ *                          be NULL.
+ */
+void uBase64DecodeStart(uBase64Context_t *pContext);
+
+/** Decode a piece of base 64 data in a streaming base 64 decode;
+ * up to three characters may be held over in the context until
+ * there are enough to decode.  Any data after padding is ignored.
+ *
+ * @param[in] pContext      a pointer to the context, as passed to
+ *                          uBase64DecodeStart(), cannot be NULL.
+ * @param[in] pBase64       the base 64 data to be decoded.
+ * @param base64LengthBytes the amount of base 64 data.
+ * @param[out] pBinary      a place to store the decoded data; set
+ *                          this to NULL to simply obtain the length
+ *                          that the decoded data would occupy, in
+ *                          which case the context is not changed.
+ *                          pBinary may be the same as pBase64
+ *                          provided that nothing is held over in
+ *                          the context, e.g. if every piece is a
+ *                          multiple of four characters long.
+ * @param binaryLengthBytes the amount of storage at pBinary.
+ * @return                  the number of bytes stored at pBinary,
+ *                          or that would be, else negative error
+ *                          code; if there is not enough storage at
+ *                          pBinary nothing is decoded and
+ *                          #U_ERROR_COMMON_NO_MEMORY is returned.
+ */
+int32_t uBase64DecodeUpdate(uBase64Context_t *pContext,
+                            const char *pBase64, size_t base64LengthBytes,
+                            char *pBinary, size_t binaryLengthBytes);
+
+/** Finish a streaming base 64 decode, decoding any held-over
+ * characters of unpadded base 64.
+ *
+ * @param[in] pContext      a pointer to the context, cannot be NULL.
+ * @param[out] pBinary      a place to store the final decoded data,
+ *                          at most two bytes; may be NULL to obtain
+ *                          the length only.
+ * @param binaryLengthBytes the amount of storage at pBinary.
+ * @return                  the number of bytes stored at pBinary (or
+ *                          that would be), else negative error code.
+ */
+int32_t uBase64DecodeFinish(uBase64Context_t *pContext,
+                            char *pBinary, size_t binaryLengthBytes);
+
 #ifdef __cplusplus
 }
 #endif
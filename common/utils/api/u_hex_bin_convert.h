@@ -68,7 +68,10 @@ size_t uBinToHex(const char *pBin, size_t binLength, char *pHex);
  * @param pHex      a pointer to the ASCII hex data.
  * @param hexLength the number of bytes pointed to by pHex.
  * @param pBin      a pointer to a buffer of length half hexLength
- *                  bytes to store the binary version.
+ *                  bytes to store the binary version; this may
+ *                  be the same as pHex, i.e. the conversion may
+ *                  be done in place, with the binary overwriting
+ *                  the start of the hex.
  * @return          the number of bytes at pBin.
  */
 size_t uHexToBin(const char *pHex, size_t hexLength, char *pBin);
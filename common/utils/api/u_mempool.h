@@ -40,6 +40,12 @@ extern "C" {
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_MEMPOOL_SLAB_MAX_NUM_SIZES
+/** The maximum number of size classes in a slab, see uMemPoolSlabInit().
+ */
+# define U_MEMPOOL_SLAB_MAX_NUM_SIZES 4
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -51,8 +57,27 @@ typedef struct {
     struct uMemPoolFree *pFreeList; /**< linked list of free blocks. */
     uint8_t *pBuffer; /**< data buffer (sub-divided into blocks). */
     uPortMutexHandle_t mutex; /**< mutex for thread protection. */
+    int32_t peakUsedBlockCount; /**< the high-water mark of usedBlockCount. */
+    int32_t allocFailCount; /**< the number of times an allocation failed
+                                 because there was no free block. */
 } uMemPoolDesc_t;
 
+/** A size class of a slab, see uMemPoolSlabInit().
+ */
+typedef struct {
+    uint32_t blockSize; /**< the size of each block. */
+    int32_t numOfBlks;  /**< the number of blocks of blockSize. */
+} uMemPoolSlabSize_t;
+
+/** A slab: a set of memory pools of different block sizes,
+ * allocating from the smallest that fits.
+ */
+typedef struct {
+    uMemPoolDesc_t pool[U_MEMPOOL_SLAB_MAX_NUM_SIZES]; /**< the pools, smallest
+                                                            block size first. */
+    size_t numPools; /**< the number of entries in pool[] that are in use. */
+} uMemPoolSlab_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -98,6 +123,54 @@ void uMemPoolFreeMem(uMemPoolDesc_t *pMemPool, void *ptr);
  */
 void uMemPoolFreeAllMem(uMemPoolDesc_t *pMemPool);
 
+/* ----------------------------------------------------------------
+ * FUNCTIONS: SLAB
+ * -------------------------------------------------------------- */
+
+/** Initialise a slab, a set of memory pools of different block
+ * sizes; uMemPoolSlabAllocMem() allocates a block from the pool
+ * with the smallest block size that will fit the allocation, moving
+ * up to the next size if that pool is exhausted, so fragmentation
+ * of the heap is avoided and allocation/free take a bounded time.
+ * As with uMemPoolInit() the memory for each pool is only allocated
+ * when the first block is taken from that pool.  Like uMemPoolInit(),
+ * this function is not thread-safe.
+ *
+ * @param[out] pSlab    a pointer to the slab to initialise, cannot be NULL.
+ * @param[in] pSizes    the size classes, in ascending order of
+ *                      blockSize, cannot be NULL.
+ * @param numSizes      the number of entries at pSizes, at most
+ *                      #U_MEMPOOL_SLAB_MAX_NUM_SIZES.
+ * @return              zero on success else negative error code.
+ */
+int32_t uMemPoolSlabInit(uMemPoolSlab_t *pSlab,
+                         const uMemPoolSlabSize_t *pSizes,
+                         size_t numSizes);
+
+/** Deinitialise a slab, freeing all of its memory.  Like
+ *  uMemPoolDeinit(), this function is not thread-safe.
+ *
+ * @param[in] pSlab     a pointer to the slab.
+ */
+void uMemPoolSlabDeinit(uMemPoolSlab_t *pSlab);
+
+/** Allocate memory from a slab.
+ *
+ * @param[in] pSlab     a pointer to the slab.
+ * @param size          the number of bytes required.
+ * @return              a pointer to a block of at least size bytes,
+ *                      NULL if size is larger than the largest block
+ *                      size of the slab or no suitable block is free.
+ */
+void *uMemPoolSlabAllocMem(uMemPoolSlab_t *pSlab, size_t size);
+
+/** Free memory allocated with uMemPoolSlabAllocMem().
+ *
+ * @param[in] pSlab     a pointer to the slab.
+ * @param[in] ptr       the memory to free; may be NULL.
+ */
+void uMemPoolSlabFreeMem(uMemPoolSlab_t *pSlab, void *ptr);
+
 #ifdef __cplusplus
 }
 #endif
@@ -29,7 +29,9 @@
 /** @file
  * @brief Ring buffer wrapper API for linear buffer.
  * All functions except uRingBufferCreate() and uRingBufferDelete()
- * are thread-safe.
+ * are thread-safe.  A ring buffer created with uRingBufferCreateSpsc()
+ * is instead lock-free, for a single producer and a single consumer,
+ * e.g. an interrupt and a task; see that function for the rules.
  */
 
 #ifdef __cplusplus
@@ -40,6 +42,13 @@ extern "C" {
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_RING_BUFFER_PARSER_STATE_LENGTH_BYTES
+/** The number of bytes of storage a parser gets from
+ * pURingBufferParserStateUnprotected().
+ */
+# define U_RING_BUFFER_PARSER_STATE_LENGTH_BYTES 16
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -99,11 +108,86 @@ typedef struct {
                                          as a result of add or forced add
                                          being unable to write into the
                                          ring buffer. */
+    bool isSpsc;                    /**< true if the ring buffer was created
+                                         with uRingBufferCreateSpsc(), in
+                                         which case pDataRead[0] is written
+                                         only by the consumer, pDataWrite
+                                         only by the producer, and the
+                                         mutex is not used on the data
+                                         path. */
+    size_t reservedLength;          /**< the length handed out by
+                                         uRingBufferReserve()/
+                                         uRingBufferForceReserve(), zero
+                                         if there is no reservation. */
+    bool reserveIsForced;           /**< true if the reservation was made
+                                         with uRingBufferForceReserve(). */
+    void *pParseResume;             /**< storage for parser state, one per
+                                         read pointer, allocated on first
+                                         use of uRingBufferParseHandle(). */
+    void *pNotify;                  /**< storage for notification settings,
+                                         one per read pointer, allocated on
+                                         first use of
+                                         uRingBufferSetNotifyHandle(). */
 } uRingBuffer_t;
 
+/** The notifications that may be requested for a read handle with
+ * uRingBufferSetNotifyHandle().
+ */
+typedef enum {
+    U_RING_BUFFER_NOTIFY_WATERMARK, /**< the unread data at the read
+                                         handle has risen to the
+                                         watermark. */
+    U_RING_BUFFER_NOTIFY_LAGGING    /**< the free space ahead of the read
+                                         handle has fallen below the lag
+                                         threshold, or data has been lost
+                                         from it: uRingBufferForceAdd()
+                                         is about to discard, or has
+                                         discarded, unread data. */
+} uRingBufferNotify_t;
+
+/** Notification callback, see uRingBufferSetNotifyHandle().  It is
+ * called in the context of whoever added the data, i.e. the caller
+ * of uRingBufferAdd(), uRingBufferForceAdd() or uRingBufferCommit(),
+ * with the ring buffer NOT locked, so it may call any of the ring
+ * buffer functions; it should be quick though, e.g. give a semaphore
+ * or send to a queue that wakes the reader.
+ *
+ * @param[in] pRingBuffer     the ring buffer.
+ * @param handle              the read handle.
+ * @param notify              what has happened.
+ * @param[in] pCallbackParam  the parameter passed to
+ *                            uRingBufferSetNotifyHandle().
+ */
+typedef void (*uRingBufferNotifyCallback_t)(uRingBuffer_t *pRingBuffer,
+                                            int32_t handle,
+                                            uRingBufferNotify_t notify,
+                                            void *pCallbackParam);
+
+/** Storage for the state of a parser, see
+ * pURingBufferParserStateUnprotected(); a union to ensure alignment.
+ */
+typedef union {
+    uint8_t bytes[U_RING_BUFFER_PARSER_STATE_LENGTH_BYTES];
+    uint32_t words[(U_RING_BUFFER_PARSER_STATE_LENGTH_BYTES + 3) / 4];
+} uRingBufferParserState_t;
+
+/** A contiguous span of data in a ring buffer, as returned by
+ * uRingBufferPeekSpan()/uRingBufferPeekSpanHandle(); a
+ * ring buffer's data is at most two such spans since
+ * it may wrap once.
+ */
+typedef struct {
+    const char *pData;
+    size_t length;
+} uRingBufferSpan_t;
+
 typedef void *uParseHandle_t; //!< Parser handle.
 
 /** Parser function prototype, used with uRingBufferParseHandle().
+ * A parser would normally start with uRingBufferSyncUnprotected(),
+ * so that unsynchronised data is skipped quickly, and may then use
+ * uRingBufferGetByteUnprotected() and uRingBufferGetSpanUnprotected()
+ * to read the message.
  *
  * @param parseHandle     the parser handle used to access the ring buffer.
  * @param[in] pUserParam  a user parameter, passed in via uRingBufferParseHandle().
@@ -148,6 +232,32 @@ void uRingBufferDump(uRingBuffer_t *pRingBuffer);
 int32_t uRingBufferCreate(uRingBuffer_t *pRingBuffer, char *pLinearBuffer,
                           size_t size);
 
+/** Create a new lock-free single-producer/single-consumer ring buffer
+ * from a linear buffer.  uRingBufferAdd(), uRingBufferReserve() and
+ * uRingBufferCommit() may be called by exactly one producer and
+ * uRingBufferRead(), uRingBufferPeek(), uRingBufferPeekSpan() and
+ * uRingBufferFlush() by exactly one consumer, without either taking
+ * the mutex; this means that the producer may, for instance, be a UART
+ * interrupt.  uRingBufferDataSize(), uRingBufferAvailableSize(),
+ * uRingBufferStatReadLoss() and uRingBufferStatAddLoss() are similarly
+ * lock-free and may be called from either side.  Since the producer cannot move the consumer's read
+ * pointer, uRingBufferForceAdd() behaves exactly like uRingBufferAdd()
+ * (and uRingBufferForceReserve() like uRingBufferReserve()), and
+ * since there is only one consumer no read handles are available.
+ * uRingBufferReset() and uRingBufferDump() must only be called while
+ * neither the producer nor the consumer is active.
+ *
+ * @param[in] pRingBuffer   a pointer to a ring buffer, cannot be NULL.
+ * @param[in] pLinearBuffer a pointer to the linear buffer.
+ * @param size              the size of the linear buffer in bytes; the
+ *                          ring buffer will be of maximum size this
+ *                          number minus one as one byte is used to
+ *                          prevent pointer-wrap.
+ * @return                  zero on success else negative error code.
+ */
+int32_t uRingBufferCreateSpsc(uRingBuffer_t *pRingBuffer, char *pLinearBuffer,
+                              size_t size);
+
 /** Delete a ring buffer.
  *
  * @param[in] pRingBuffer   a pointer to the ring buffer, cannot be NULL.
@@ -207,6 +317,76 @@ size_t uRingBufferRead(uRingBuffer_t *pRingBuffer, char *pData, size_t length);
 size_t uRingBufferPeek(uRingBuffer_t *pRingBuffer, char *pData, size_t length,
                        size_t offset);
 
+/** Like uRingBufferPeek() but, rather than copying the data, return
+ * pointers to it in the ring buffer: since the data may wrap around
+ * the end of the linear buffer it is described by up to two contiguous
+ * spans, the second of which will be of zero length if there is no
+ * wrap.  Once the data has been dealt with, uRingBufferRead() with
+ * pData set to NULL may be used to move the read pointer on.  Note that
+ * the data pointed to may be overwritten by uRingBufferForceAdd()
+ * at any time.
+ *
+ * @param[in] pRingBuffer a pointer to the ring buffer, cannot be NULL.
+ * @param[out] pSpan      a pointer to an array of TWO spans, cannot be
+ *                        NULL.
+ * @return                the total number of bytes in the two spans.
+ */
+size_t uRingBufferPeekSpan(uRingBuffer_t *pRingBuffer, uRingBufferSpan_t *pSpan);
+
+/** Reserve the largest contiguous region of the ring buffer that
+ * uRingBufferAdd() could write to, allowing data to be written directly
+ * into the ring buffer (e.g. by a UART or I2C driver) without first being
+ * copied into a temporary buffer.  Once the data has been written,
+ * uRingBufferCommit() must be called to add it to the ring buffer.
+ * Note that, since the region may stop at the end of the linear buffer,
+ * the size returned may be less than uRingBufferAvailableSize(): simply
+ * call this function again after the commit to get the remainder.
+ *
+ * IMPORTANT: if this function returns non-zero then, unless the ring
+ * buffer was created with uRingBufferCreateSpsc(), the ring buffer mutex
+ * REMAINS LOCKED until uRingBufferCommit() is called, which must be done
+ * by the same task and as soon as possible; no other ring buffer function
+ * may be called by that task in the meantime.
+ *
+ * @param[in] pRingBuffer a pointer to the ring buffer, cannot be NULL.
+ * @param[out] ppData     a place to put a pointer to the start of the
+ *                        reserved region, cannot be NULL.
+ * @return                the size of the reserved region; if this is
+ *                        zero there is nothing to commit and
+ *                        uRingBufferCommit() must NOT be called.
+ */
+size_t uRingBufferReserve(uRingBuffer_t *pRingBuffer, char **ppData);
+
+/** As uRingBufferReserve() but the region returned is that which
+ * uRingBufferForceAdd() could write to, i.e. it may include data that
+ * is waiting at an unlocked read pointer; that data is lost, just as
+ * with uRingBufferForceAdd(), when uRingBufferCommit() is called.
+ * The same rules on calling uRingBufferCommit() apply.
+ *
+ * @param[in] pRingBuffer a pointer to the ring buffer, cannot be NULL.
+ * @param[out] ppData     a place to put a pointer to the start of the
+ *                        reserved region, cannot be NULL.
+ * @return                the size of the reserved region; if this is
+ *                        zero there is nothing to commit and
+ *                        uRingBufferCommit() must NOT be called.
+ */
+size_t uRingBufferForceReserve(uRingBuffer_t *pRingBuffer, char **ppData);
+
+/** Commit data that was written into the region returned by
+ * uRingBufferReserve() or uRingBufferForceReserve(), ending
+ * the reservation.
+ *
+ * @param[in] pRingBuffer a pointer to the ring buffer, cannot be NULL.
+ * @param length          the number of bytes written into the reserved
+ *                        region, which may be less than was reserved,
+ *                        including zero.
+ * @return                true if the data was added; false if length
+ *                        is larger than was reserved, in which case
+ *                        nothing is added but the reservation is
+ *                        still ended.
+ */
+bool uRingBufferCommit(uRingBuffer_t *pRingBuffer, size_t length);
+
 /** Get the amount of data available in a ring buffer; see also
  * uRingBufferDataSizeHandle(). If uRingBufferSetReadRequiresHandle()
  * is true then this will return zero.
@@ -409,6 +589,23 @@ size_t uRingBufferPeekHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
  */
 size_t uRingBufferDataSizeHandle(const uRingBuffer_t *pRingBuffer, int32_t handle);
 
+/** Like uRingBufferPeekSpan() except for use by an entity that has
+ * previously obtained a read handle by calling uRingBufferTakeReadHandle().
+ * Lock the read handle with uRingBufferLockReadHandle() while using
+ * the spans if the data must not be overwritten by uRingBufferForceAdd(),
+ * then use uRingBufferReadHandle() with pData set to NULL to move
+ * the read pointer on.
+ *
+ * @param[in] pRingBuffer a pointer to the ring buffer, cannot be NULL.
+ * @param handle          a read handle, as originally returned by
+ *                        uRingBufferTakeReadHandle().
+ * @param[out] pSpan      a pointer to an array of TWO spans, cannot be
+ *                        NULL.
+ * @return                the total number of bytes in the two spans.
+ */
+size_t uRingBufferPeekSpanHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
+                                 uRingBufferSpan_t *pSpan);
+
 /** Like uRingBufferAvailableSize() but ignores any read handles that
  * are unlocked, so the amount of buffer space available to
  * uRingBufferForceAdd().
@@ -441,11 +638,54 @@ void uRingBufferFlushHandle(uRingBuffer_t *pRingBuffer, int32_t handle);
 size_t uRingBufferStatReadLossHandle(uRingBuffer_t *pRingBuffer,
                                      int32_t handle);
 
+/** Ask to be notified when data arrives at a read handle, rather
+ * than polling uRingBufferDataSizeHandle(), and when the reader is
+ * falling so far behind that uRingBufferForceAdd() will shortly start
+ * throwing its data away.  Notifications are edge-triggered: pCallback
+ * is called with #U_RING_BUFFER_NOTIFY_WATERMARK when an add takes the
+ * unread data at the handle from below watermarkBytes to at or above
+ * it, and with #U_RING_BUFFER_NOTIFY_LAGGING when an add takes the
+ * free space ahead of the handle from at or above lagBytes to below it
+ * or when data is discarded from under the handle.  A reader that
+ * sleeps until notified should therefore read until there is less than
+ * watermarkBytes left before sleeping again.  The settings are dropped
+ * when the handle is given back with uRingBufferGiveReadHandle().
+ *
+ * @param[in] pRingBuffer     a pointer to the ring buffer, cannot be
+ *                            NULL.
+ * @param handle              a read handle, as originally returned by
+ *                            uRingBufferTakeReadHandle().
+ * @param watermarkBytes      the watermark, zero for no watermark
+ *                            notifications; 1 means notify as soon as
+ *                            there is any data.
+ * @param lagBytes            the free space below which the reader
+ *                            is lagging, zero for no lagging
+ *                            notifications other than when data is
+ *                            actually lost.
+ * @param[in] pCallback       the callback, NULL to switch notifications
+ *                            off for this handle.
+ * @param[in] pCallbackParam  a parameter that will be passed to
+ *                            pCallback.
+ * @return                    zero on success else negative error code.
+ */
+int32_t uRingBufferSetNotifyHandle(uRingBuffer_t *pRingBuffer,
+                                   int32_t handle,
+                                   size_t watermarkBytes,
+                                   size_t lagBytes,
+                                   uRingBufferNotifyCallback_t pCallback,
+                                   void *pCallbackParam);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: PARSER
  * -------------------------------------------------------------- */
 
-/** Run a set of parsers over the contents of the ring buffer.
+/** Run a set of parsers over the contents of the ring buffer.  If a
+ * parser returns #U_ERROR_COMMON_TIMEOUT part-way through a message
+ * and has left state behind (see pURingBufferParserStateUnprotected())
+ * then, next time this is called for the same read handle, that parser
+ * is called first and carries on from where it left off, rather than
+ * every parser starting again from the read pointer; the same parser
+ * list must be used each time.
  *
  * @param[in] pRingBuffer a pointer to the ring buffer, cannot be NULL.
  * @param handle          a read handle, as originally returned by
@@ -472,6 +712,77 @@ size_t uRingBufferParseHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
  */
 bool uRingBufferGetByteUnprotected(uParseHandle_t parseHandle, void *p);
 
+/** Get a contiguous span of up to length bytes from the ring buffer
+ * while in a parser function, moving the parse position on by the
+ * number of bytes returned; this is much more efficient than calling
+ * uRingBufferGetByteUnprotected() repeatedly, e.g. when running a
+ * checksum over a message body.  Since the data may wrap around the
+ * end of the linear buffer fewer than length bytes may be returned
+ * even if more are available: just call this function again to get
+ * the remainder.
+ *
+ * IMPORTANT: unlike all of the other ring-buffer functions, this function
+ * is NOT thread-safe, it is ONLY intended to be used from within a
+ * U_RING_BUFFER_PARSER_f function that will be called by uRingBufferParseHandle()
+ * (which adds thread-safety).
+ *
+ * @param parseHandle     the parser handle used to access the ring buffer.
+ * @param[out] ppData     a place to put a pointer to the span, cannot be NULL.
+ * @param length          the maximum number of bytes wanted.
+ * @return                the number of bytes in the span, zero if there
+ *                        are no more.
+ */
+size_t uRingBufferGetSpanUnprotected(uParseHandle_t parseHandle,
+                                     const char **ppData, size_t length);
+
+/** Check for a message's sync byte while in a parser function.  If
+ * the byte at the parse position is syncByte it is consumed, as if by
+ * uRingBufferGetByteUnprotected(), and true is returned.  If not, the
+ * data is searched forward for syncByte using memchr() and false is
+ * returned; if the parser then returns #U_ERROR_COMMON_NOT_FOUND,
+ * uRingBufferParseHandle() will skip straight to the point where the
+ * next sync byte of any of the parsers in the list might be, rather
+ * than trying every parser again at every byte.  A parser should
+ * therefore call this first, instead of checking its first byte with
+ * uRingBufferGetByteUnprotected().
+ *
+ * IMPORTANT: unlike all of the other ring-buffer functions, this function
+ * is NOT thread-safe, it is ONLY intended to be used from within a
+ * U_RING_BUFFER_PARSER_f function that will be called by uRingBufferParseHandle()
+ * (which adds thread-safety).
+ *
+ * @param parseHandle     the parser handle used to access the ring buffer.
+ * @param syncByte        the byte that starts a message for this parser.
+ * @return                true if the byte at the parse position was
+ *                        syncByte, else false.
+ */
+bool uRingBufferSyncUnprotected(uParseHandle_t parseHandle, char syncByte);
+
+/** Get the state storage of a parser while in a parser function, so
+ * that a parser can carry on from where it left off rather than
+ * re-parsing a partially-received message from the beginning.  The
+ * storage is #U_RING_BUFFER_PARSER_STATE_LENGTH_BYTES long, 32-bit
+ * aligned and all zeroes when the parser is called at the start of
+ * a potential message.  If the parser returns #U_ERROR_COMMON_TIMEOUT
+ * with the FIRST byte of the storage non-zero then the storage, along
+ * with the parse position (i.e. everything retrieved with
+ * uRingBufferGetByteUnprotected()/uRingBufferGetSpanUnprotected()
+ * so far), is kept and the parser is called with it the next time
+ * uRingBufferParseHandle() is called for the read handle; the parser
+ * must of course have dealt with all of the bytes it retrieved before
+ * returning.  If the first byte is zero the parser will start again
+ * from the beginning of the message next time.
+ *
+ * IMPORTANT: unlike all of the other ring-buffer functions, this function
+ * is NOT thread-safe, it is ONLY intended to be used from within a
+ * U_RING_BUFFER_PARSER_f function that will be called by uRingBufferParseHandle()
+ * (which adds thread-safety).
+ *
+ * @param parseHandle     the parser handle used to access the ring buffer.
+ * @return                a pointer to the state storage.
+ */
+void *pURingBufferParserStateUnprotected(uParseHandle_t parseHandle);
+
 /** Number of bytes in the ring buffer while in a parser function.
  *
  * IMPORTANT: unlike all of the other ring-buffer functions, this function
@@ -28,7 +28,12 @@
 
 /** @file
  * @brief This header file defines functions to help with time
- * manipulation.
+ * manipulation.  The conversions between a civil (year/month/day)
+ * date and a count of days are closed-form, using the algorithms
+ * of Howard Hinnant (http://howardhinnant.github.io/date_algorithms.html),
+ * so they run in constant time, and are valid for any date in the
+ * proleptic Gregorian calendar that fits the types.  A host UTC
+ * clock, set with uTimeHostSetUtcMs(), is also kept here.
  */
 
 #ifdef __cplusplus
@@ -43,6 +48,19 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** A broken-down UTC time.
+ */
+typedef struct {
+    int32_t year;    /**< the year, e.g. 2023. */
+    int32_t month;   /**< the month, 1 to 12. */
+    int32_t day;     /**< the day of the month, 1 to 31. */
+    int32_t hour;    /**< the hour, 0 to 23. */
+    int32_t minute;  /**< the minute, 0 to 59. */
+    int32_t second;  /**< the second, 0 to 59. */
+    int32_t weekDay; /**< the day of the week, 0 (Sunday) to 6. */
+    int32_t yearDay; /**< the day of the year, 0 to 365. */
+} uTimeBrokenDown_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -66,12 +84,80 @@ bool uTimeIsLeapYear(int32_t year);
  * into a UTC time.
  *
  * @param monthsUtc the number of months since the start of
- *                  1970, counting from zero.
+ *                  1970, counting from zero; may be negative.
  * @return          the number of seconds in the given number
  *                  of months, taking into account leap years.
  */
 int64_t uTimeMonthsToSecondsUtc(int32_t monthsUtc);
 
+/** Return the number of days from 1st January 1970 to the given
+ * date.
+ *
+ * @param year  the year, e.g. 2023.
+ * @param month the month, 1 to 12.
+ * @param day   the day of the month, 1 to 31; values outside this
+ *              range simply add or subtract days.
+ * @return      the number of days since 1st January 1970, negative
+ *              for dates before then.
+ */
+int64_t uTimeDaysFromCivil(int32_t year, int32_t month, int32_t day);
+
+/** The inverse of uTimeDaysFromCivil(): return the date that is
+ * the given number of days from 1st January 1970.
+ *
+ * @param days        the number of days since 1st January 1970,
+ *                    may be negative.
+ * @param[out] pYear  a place to put the year; may be NULL.
+ * @param[out] pMonth a place to put the month, 1 to 12; may be NULL.
+ * @param[out] pDay   a place to put the day of the month, 1 to 31;
+ *                    may be NULL.
+ */
+void uTimeCivilFromDays(int64_t days, int32_t *pYear,
+                        int32_t *pMonth, int32_t *pDay);
+
+/** Convert a broken-down UTC time into UTC seconds, i.e. seconds
+ * since midnight on 1st January 1970.  weekDay and yearDay are
+ * ignored; the other fields may be out of range, e.g. a month of
+ * 13 or a second of 60, in which case they simply carry.
+ *
+ * @param[in] pBrokenDown the broken-down time; cannot be NULL.
+ * @return                the time in UTC seconds.
+ */
+int64_t uTimeBrokenDownToSecondsUtc(const uTimeBrokenDown_t *pBrokenDown);
+
+/** Convert UTC seconds, i.e. seconds since midnight on 1st January
+ * 1970, into a broken-down UTC time.
+ *
+ * @param secondsUtc        the time in UTC seconds, may be negative.
+ * @param[out] pBrokenDown  a place to put the broken-down time;
+ *                          cannot be NULL.
+ */
+void uTimeSecondsUtcToBrokenDown(int64_t secondsUtc,
+                                 uTimeBrokenDown_t *pBrokenDown);
+
+/** Set the UTC time of the host, e.g. from GNSS with
+ * uDeviceTimeSetFromGnss().  The time is held as an offset from
+ * uPortGetTickTimeUs() and so shares its caveats: in particular it
+ * is lost if the port is re-initialised, e.g. after the processor
+ * has been in deep sleep, and must be set again.
+ *
+ * @param timeUtcMs   the UTC time now, in milliseconds since
+ *                    midnight on 1st January 1970.
+ * @param accuracyMs  the accuracy of timeUtcMs in milliseconds,
+ *                    which is returned by uTimeHostGetUtcMs().
+ */
+void uTimeHostSetUtcMs(int64_t timeUtcMs, int32_t accuracyMs);
+
+/** Get the UTC time of the host as set by uTimeHostSetUtcMs().
+ *
+ * @param[out] pAccuracyMs  a place to put the accuracy that was
+ *                          passed to uTimeHostSetUtcMs(); may be NULL.
+ * @return                  the UTC time in milliseconds since
+ *                          midnight on 1st January 1970, -1 if
+ *                          uTimeHostSetUtcMs() has not been called.
+ */
+int64_t uTimeHostGetUtcMs(int32_t *pAccuracyMs);
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,6 +30,10 @@
 
 #include "stddef.h"    // size_t
 #include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcpy()
+
+#include "u_error_common.h"
 
 #include "u_base64.h"
 
@@ -55,6 +59,95 @@
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Encode whole groups of three bytes, returning the number of
+// characters written, which will be four times the number of groups.
+static size_t encodeGroups(const unsigned char *pIn, size_t numGroups, char *pOut)
+{
+    char *pStart = pOut;
+    uint32_t word;
+
+    while (numGroups > 0) {
+        word = (((uint32_t) pIn[0]) << 16) | (((uint32_t) pIn[1]) << 8) | pIn[2];
+        pOut[0] = b64[word >> 18];
+        pOut[1] = b64[(word >> 12) & 0x3f];
+        pOut[2] = b64[(word >> 6) & 0x3f];
+        pOut[3] = b64[word & 0x3f];
+        pIn += 3;
+        pOut += 4;
+        numGroups--;
+    }
+
+    return pOut - pStart;
+}
+
+// Decode a group of four base 64 characters, which may include
+// padding, returning the number of bytes (1 to 3) written or that
+// would be written if pOut is NULL.
+static size_t decodeGroup(const unsigned char *pIn, char *pOut)
+{
+    size_t length = 3;
+    uint32_t word;
+
+    if (pIn[3] == '=') {
+        length--;
+        if (pIn[2] == '=') {
+            length--;
+        }
+    }
+    if (pOut != NULL) {
+        word = (((uint32_t) unb64[pIn[0]]) << 18) |
+               (((uint32_t) unb64[pIn[1]]) << 12) |
+               (((uint32_t) unb64[pIn[2]]) << 6) |
+               unb64[pIn[3]];
+        pOut[0] = (char) (word >> 16);
+        if (length > 1) {
+            pOut[1] = (char) (word >> 8);
+        }
+        if (length > 2) {
+            pOut[2] = (char) word;
+        }
+    }
+
+    return length;
+}
+
+// Decode as much base 64 as possible, updating the context and
+// returning the number of bytes written, or that would be written
+// if pOut is NULL.
+static size_t decode(uBase64Context_t *pContext, const unsigned char *pIn,
+                     size_t length, char *pOut)
+{
+    size_t count = 0;
+    size_t x;
+
+    while ((length > 0) && !pContext->padded) {
+        if ((pContext->carryLength == 0) && (length >= 4)) {
+            // A whole group straight from the input
+            x = decodeGroup(pIn, (pOut != NULL) ? pOut + count : NULL);
+            pIn += 4;
+            length -= 4;
+        } else {
+            x = 0;
+            pContext->carry[pContext->carryLength] = (char) *pIn;
+            pContext->carryLength++;
+            pIn++;
+            length--;
+            if (pContext->carryLength == sizeof(pContext->carry)) {
+                x = decodeGroup((const unsigned char *) pContext->carry,
+                                (pOut != NULL) ? pOut + count : NULL);
+                pContext->carryLength = 0;
+            }
+        }
+        count += x;
+        if ((x > 0) && (x < 3)) {
+            // Padding: this is the end
+            pContext->padded = true;
+        }
+    }
+
+    return count;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -101,4 +194,144 @@ int32_t uBase64Decode(const char *pBase64, size_t base64LengthBytes,
     return bytesDecoded;
 }
 
+// Start a streaming base 64 encode.
+void uBase64EncodeStart(uBase64Context_t *pContext)
+{
+    if (pContext != NULL) {
+        memset(pContext, 0, sizeof(*pContext));
+    }
+}
+
+// Encode a piece of a streaming base 64 encode.
+int32_t uBase64EncodeUpdate(uBase64Context_t *pContext,
+                            const char *pBinary, size_t binaryLengthBytes,
+                            char *pBase64, size_t base64LengthBytes)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    size_t numGroups;
+    size_t x;
+    char *pOut = pBase64;
+
+    if ((pContext != NULL) && (pContext->carryLength < 3) &&
+        ((pBinary != NULL) || (binaryLengthBytes == 0))) {
+        numGroups = (pContext->carryLength + binaryLengthBytes) / 3;
+        errorCodeOrLength = (int32_t) (numGroups * 4);
+        if (pBase64 != NULL) {
+            if (base64LengthBytes < numGroups * 4) {
+                errorCodeOrLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            } else {
+                if ((numGroups > 0) && (pContext->carryLength > 0)) {
+                    // Complete the held-over group first
+                    x = 3 - pContext->carryLength;
+                    memcpy(pContext->carry + pContext->carryLength, pBinary, x);
+                    pOut += encodeGroups((const unsigned char *) pContext->carry, 1, pOut);
+                    pBinary += x;
+                    binaryLengthBytes -= x;
+                    pContext->carryLength = 0;
+                    numGroups--;
+                }
+                pOut += encodeGroups((const unsigned char *) pBinary, numGroups, pOut);
+                pBinary += numGroups * 3;
+                binaryLengthBytes -= numGroups * 3;
+                // Hold over what's left
+                memcpy(pContext->carry + pContext->carryLength, pBinary, binaryLengthBytes);
+                pContext->carryLength += binaryLengthBytes;
+            }
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
+// Finish a streaming base 64 encode.
+int32_t uBase64EncodeFinish(uBase64Context_t *pContext,
+                            char *pBase64, size_t base64LengthBytes)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int flen = 0;
+
+    if ((pContext != NULL) && (pContext->carryLength < 3)) {
+        base64(pContext->carry, (int) pContext->carryLength, &flen, NULL);
+        errorCodeOrLength = flen;
+        if (pBase64 != NULL) {
+            if ((int32_t) base64LengthBytes < flen) {
+                errorCodeOrLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            } else {
+                // This deals with the padding
+                base64(pContext->carry, (int) pContext->carryLength, &flen, pBase64);
+                pContext->carryLength = 0;
+            }
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
+// Start a streaming base 64 decode.
+void uBase64DecodeStart(uBase64Context_t *pContext)
+{
+    if (pContext != NULL) {
+        memset(pContext, 0, sizeof(*pContext));
+    }
+}
+
+// Decode a piece of a streaming base 64 decode.
+int32_t uBase64DecodeUpdate(uBase64Context_t *pContext,
+                            const char *pBase64, size_t base64LengthBytes,
+                            char *pBinary, size_t binaryLengthBytes)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uBase64Context_t context;
+
+    if ((pContext != NULL) && (pContext->carryLength < sizeof(pContext->carry)) &&
+        ((pBase64 != NULL) || (base64LengthBytes == 0))) {
+        // Work out the length on a copy of the context first
+        context = *pContext;
+        errorCodeOrLength = (int32_t) decode(&context, (const unsigned char *) pBase64,
+                                             base64LengthBytes, NULL);
+        if (pBinary != NULL) {
+            if ((int32_t) binaryLengthBytes < errorCodeOrLength) {
+                errorCodeOrLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            } else {
+                decode(pContext, (const unsigned char *) pBase64,
+                       base64LengthBytes, pBinary);
+            }
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
+// Finish a streaming base 64 decode.
+int32_t uBase64DecodeFinish(uBase64Context_t *pContext,
+                            char *pBinary, size_t binaryLengthBytes)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    char group[4] = {'=', '=', '=', '='};
+    size_t length = 0;
+
+    if ((pContext != NULL) && (pContext->carryLength < 4)) {
+        // Two characters give one byte and three two bytes,
+        // a single character is not valid base 64 and is dropped
+        if (pContext->carryLength > 1) {
+            length = pContext->carryLength - 1;
+        }
+        errorCodeOrLength = (int32_t) length;
+        if (pBinary != NULL) {
+            if (binaryLengthBytes < length) {
+                errorCodeOrLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            } else {
+                if (length > 0) {
+                    memcpy(group, pContext->carry, pContext->carryLength);
+                    decodeGroup((const unsigned char *) group, pBinary);
+                }
+                pContext->carryLength = 0;
+                pContext->padded = false;
+            }
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
 // End of file
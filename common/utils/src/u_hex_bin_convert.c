@@ -53,57 +53,105 @@ static const char gHex[] = {'0', '1', '2', '3', '4', '5', '6', '7',
                             '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
                            };
 
+/** Map from ASCII to the value of a hex digit, 0xff if the
+ * character is not a hex digit.
+ */
+static const uint8_t gHexValue[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
 /* ----------------------------------------------------------------
- * STATIC FUNCTIONS
+ * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Convert a buffer into the ASCII hex equivalent.
 size_t uBinToHex(const char *pBin, size_t binLength, char *pHex)
 {
+    const unsigned char *pIn = (const unsigned char *) pBin;
+
     U_ASSERT(pHex != NULL);
 
-    for (size_t x = 0; x < binLength; x++) {
-        *pHex = gHex[((unsigned char) * pBin) >> 4];
-        pHex++;
-        *pHex = gHex[*pBin & 0x0f];
-        pHex++;
-        pBin++;
+    // Four bytes at a time while we can
+    for (size_t x = binLength / 4; x > 0; x--) {
+        pHex[0] = gHex[pIn[0] >> 4];
+        pHex[1] = gHex[pIn[0] & 0x0f];
+        pHex[2] = gHex[pIn[1] >> 4];
+        pHex[3] = gHex[pIn[1] & 0x0f];
+        pHex[4] = gHex[pIn[2] >> 4];
+        pHex[5] = gHex[pIn[2] & 0x0f];
+        pHex[6] = gHex[pIn[3] >> 4];
+        pHex[7] = gHex[pIn[3] & 0x0f];
+        pHex += 8;
+        pIn += 4;
+    }
+    for (size_t x = binLength % 4; x > 0; x--) {
+        pHex[0] = gHex[*pIn >> 4];
+        pHex[1] = gHex[*pIn & 0x0f];
+        pHex += 2;
+        pIn++;
     }
 
     return binLength * 2;
 }
 
+// Convert a buffer of ASCII hex into the binary equivalent.
 size_t uHexToBin(const char *pHex, size_t hexLength, char *pBin)
 {
-    bool success = true;
-    size_t length;
-    char z[2];
+    const unsigned char *pIn = (const unsigned char *) pHex;
+    size_t length = 0;
+    size_t pairs = hexLength / 2;
+    uint8_t v[8];
+    uint8_t invalid;
 
     U_ASSERT(pBin != NULL);
 
-    for (length = 0; (length < hexLength / 2) && success; length++) {
-        z[0] = *pHex - '0';
-        pHex++;
-        z[1] = *pHex - '0';
-        pHex++;
-        for (size_t y = 0; (y < sizeof(z)) && success; y++) {
-            if (z[y] > 9) {
-                // Must be A to F or a to f
-                z[y] -= 'A' - '0';
-                z[y] += 10;
-            }
-            if (z[y] > 15) {
-                // Must be a to f
-                z[y] -= 'a' - 'A';
-            }
-            // Cast here to shut-up a warning under ESP-IDF
-            // which appears to have chars as unsigned and
-            // hence thinks the first condition is always true
-            success = ((signed char) z[y] >= 0) && (z[y] <= 15);
+    // Four pairs at a time while we can: a non-hex character
+    // maps to 0xff so ORing the values shows up any of them,
+    // in which case the remainder is done a pair at a time
+    // below to find exactly where conversion stops.  One byte
+    // is written for every two read so this works in place.
+    invalid = 0;
+    while ((pairs - length >= 4) && (invalid == 0)) {
+        for (size_t x = 0; x < sizeof(v); x++) {
+            v[x] = gHexValue[pIn[x]];
+            invalid |= v[x];
+        }
+        invalid &= 0xf0;
+        if (invalid == 0) {
+            pBin[0] = (char) ((v[0] << 4) | v[1]);
+            pBin[1] = (char) ((v[2] << 4) | v[3]);
+            pBin[2] = (char) ((v[4] << 4) | v[5]);
+            pBin[3] = (char) ((v[6] << 4) | v[7]);
+            pBin += 4;
+            pIn += sizeof(v);
+            length += 4;
         }
-        if (success) {
-            *pBin = (char) (((z[0] & 0x0f) << 4) | z[1]);
-            pBin++;
+    }
+    while (length < pairs) {
+        v[0] = gHexValue[pIn[0]];
+        v[1] = gHexValue[pIn[1]];
+        if ((v[0] | v[1]) & 0xf0) {
+            break;
         }
+        *pBin = (char) ((v[0] << 4) | v[1]);
+        pBin++;
+        pIn += 2;
+        length++;
     }
 
     return length;
@@ -51,11 +51,16 @@
 # define U_MEMPOOL_USE_BUF_FENCE 1
 #endif
 
+// Blocks are rounded up to a multiple of the size of a pointer
+// so that every block, and the free-list pointer in it, is aligned.
+#define U_ALIGN_BLOCK_SIZE(size) \
+    (((size) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
 #if U_MEMPOOL_USE_BUF_FENCE
 # define U_REAL_BLOCK_SIZE(userBlockSize) \
-    (userBlockSize + sizeof(uint16_t))
+    U_ALIGN_BLOCK_SIZE(userBlockSize + sizeof(uint16_t))
 #else
-# define U_REAL_BLOCK_SIZE(userBlockSize) (userBlockSize)
+# define U_REAL_BLOCK_SIZE(userBlockSize) U_ALIGN_BLOCK_SIZE(userBlockSize)
 #endif
 
 #define U_BUFFER_SIZE(pMemPool) \
@@ -160,6 +165,11 @@ void *uMemPoolAllocMem(uMemPoolDesc_t *pMemPool)
             pAllocMem = pMemPool->pFreeList;
             pMemPool->pFreeList = pMemPool->pFreeList->pNext;
             pMemPool->usedBlockCount++;
+            if (pMemPool->usedBlockCount > pMemPool->peakUsedBlockCount) {
+                pMemPool->peakUsedBlockCount = pMemPool->usedBlockCount;
+            }
+        } else {
+            pMemPool->allocFailCount++;
         }
 
 #if U_MEMPOOL_USE_BUF_FENCE
@@ -184,7 +194,6 @@ void uMemPoolFreeMem(uMemPoolDesc_t *pMemPool, void *pMem)
     if ((pMemPool != NULL) && (pMem != NULL) && (pMemPool->mutex != NULL)) {
         U_PORT_MUTEX_LOCK(pMemPool->mutex);
         // Make sure the memory segment is within our buffer
-        uPortLog("pMem: %08x\n", pMem);
         U_ASSERT((uint8_t *)pMem >= pMemPool->pBuffer);
         U_ASSERT((uint8_t *)pMem < (pMemPool->pBuffer + U_BUFFER_SIZE(pMemPool)));
 
@@ -215,4 +224,81 @@ void uMemPoolFreeAllMem(uMemPoolDesc_t *pMemPool)
     }
 }
 
+int32_t uMemPoolSlabInit(uMemPoolSlab_t *pSlab,
+                         const uMemPoolSlabSize_t *pSizes,
+                         size_t numSizes)
+{
+    int32_t err = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pSlab != NULL) && (pSizes != NULL) && (numSizes > 0) &&
+        (numSizes <= U_MEMPOOL_SLAB_MAX_NUM_SIZES)) {
+        memset(pSlab, 0, sizeof(uMemPoolSlab_t));
+        err = (int32_t)U_ERROR_COMMON_SUCCESS;
+        for (size_t i = 0; (i < numSizes) && (err == 0); i++) {
+            if ((i > 0) && (pSizes[i].blockSize <= pSizes[i - 1].blockSize)) {
+                err = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+            } else {
+                err = uMemPoolInit(&pSlab->pool[i], pSizes[i].blockSize,
+                                   pSizes[i].numOfBlks);
+                if (err == 0) {
+                    pSlab->numPools++;
+                }
+            }
+        }
+        if (err != 0) {
+            uMemPoolSlabDeinit(pSlab);
+        }
+    }
+
+    return err;
+}
+
+void uMemPoolSlabDeinit(uMemPoolSlab_t *pSlab)
+{
+    if (pSlab != NULL) {
+        for (size_t i = 0; i < pSlab->numPools; i++) {
+            uMemPoolDeinit(&pSlab->pool[i]);
+        }
+        pSlab->numPools = 0;
+    }
+}
+
+void *uMemPoolSlabAllocMem(uMemPoolSlab_t *pSlab, size_t size)
+{
+    void *pAllocMem = NULL;
+
+    if (pSlab != NULL) {
+        // Smallest block size that fits first, then larger ones
+        // if that pool is exhausted
+        for (size_t i = 0; (i < pSlab->numPools) && (pAllocMem == NULL); i++) {
+            if (size <= pSlab->pool[i].blockSize) {
+                pAllocMem = uMemPoolAllocMem(&pSlab->pool[i]);
+            }
+        }
+    }
+
+    return pAllocMem;
+}
+
+void uMemPoolSlabFreeMem(uMemPoolSlab_t *pSlab, void *pMem)
+{
+    uMemPoolDesc_t *pMemPool;
+    bool found = false;
+
+    if ((pSlab != NULL) && (pMem != NULL)) {
+        // Find the pool the block came from: pBuffer of a pool
+        // only changes in uMemPoolDeinit(), hence it is safe to
+        // check it without the pool mutex
+        for (size_t i = 0; (i < pSlab->numPools) && !found; i++) {
+            pMemPool = &pSlab->pool[i];
+            if ((pMemPool->pBuffer != NULL) && ((uint8_t *)pMem >= pMemPool->pBuffer) &&
+                ((uint8_t *)pMem < pMemPool->pBuffer + U_BUFFER_SIZE(pMemPool))) {
+                uMemPoolFreeMem(pMemPool, pMem);
+                found = true;
+            }
+        }
+        U_ASSERT(found);
+    }
+}
+
 // End of file
@@ -34,7 +34,7 @@
 #include "stdio.h"    // snprintf()
 
 #include "u_cfg_sw.h"
-#include "u_compiler.h" // For U_INLINE
+#include "u_compiler.h" // For U_INLINE and U_MEMORY_BARRIER
 
 #include "u_error_common.h"
 #include "u_assert.h"
@@ -46,6 +46,8 @@
 #include "u_port_os.h"
 #include "u_port_debug.h"
 
+#include "u_log_ram_trace.h"
+
 #include "u_ringbuffer.h"
 
 /* ----------------------------------------------------------------
@@ -56,6 +58,25 @@
  */
 #define U_RINGBUFFER_PREFIX "U_RINGBUFFER: "
 
+#ifdef U_CFG_LOG_RAM_TRACE
+/** Put the outcome of an add into the RAM trace.
+ */
+# define TRACE_ADD(added, length) if (added) {                          \
+        U_LOG_RAM_TRACE_INSTANT(RING_BUFFER, RING_BUFFER_ADD, length);  \
+    } else {                                                            \
+        U_LOG_RAM_TRACE_INSTANT(RING_BUFFER, RING_BUFFER_FULL, length); \
+    }
+
+/** Put the outcome of a read into the RAM trace.
+ */
+# define TRACE_READ(length) if ((length) > 0) {                         \
+        U_LOG_RAM_TRACE_INSTANT(RING_BUFFER, RING_BUFFER_READ, length); \
+    }
+#else
+# define TRACE_ADD(added, length)
+# define TRACE_READ(length)
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -68,8 +89,47 @@ typedef struct {
     size_t bytesAvailable;
     size_t bytesParsed;
     size_t bytesDiscard;
+    size_t bytesSkip; /**< how far uRingBufferParseHandle() may move on
+                           if the parser returns #U_ERROR_COMMON_NOT_FOUND,
+                           see uRingBufferSyncUnprotected(). */
+    uRingBufferParserState_t state;
 } uRingBufferParseContext_t;
 
+/** Where uRingBufferParseHandle() keeps the state of a parser that
+ * returned #U_ERROR_COMMON_TIMEOUT part-way through a message, so
+ * that it can carry on from there next time; there is one of these
+ * per read pointer.
+ */
+typedef struct {
+    int32_t parserIndex;  /**< the index of the parser in the list, -1
+                               if there is nothing to resume. */
+    size_t bytesDiscard;  /**< the offset of the start of the message
+                               from the read pointer. */
+    size_t bytesParsed;   /**< the number of bytes of the message that
+                               the parser has already dealt with. */
+    uRingBufferParserState_t state;
+} uRingBufferParseResume_t;
+
+/** The notification settings of a read pointer, see
+ * uRingBufferSetNotifyHandle(); there is one of these per read
+ * pointer.
+ */
+typedef struct {
+    size_t watermarkBytes;
+    size_t lagBytes;
+    uRingBufferNotifyCallback_t pCallback;
+    void *pCallbackParam;
+} uRingBufferNotifySettings_t;
+
+/** The notifications raised by an add, to be delivered once the
+ * ring buffer's mutex has been unlocked; bit (x - 1) represents
+ * read pointer x, as for dataReadLockBitmap.
+ */
+typedef struct {
+    uint64_t watermarkBitmap;
+    uint64_t laggingBitmap;
+} uRingBufferNotifyEvents_t;
+
 /* ----------------------------------------------------------------
  * PROTOTYPES
  * -------------------------------------------------------------- */
@@ -118,6 +178,25 @@ static U_INLINE const char *pPtrOffset(const char *pData, size_t offset,
     return pData;
 }
 
+// Forget any parser state for a read pointer that has moved by
+// the given amount, or entirely if length is the size of the
+// buffer.  The ring buffer's mutex should be locked before this
+// is called.
+static void parseResumeMove(uRingBuffer_t *pRingBuffer, size_t handle, size_t length)
+{
+    uRingBufferParseResume_t *pResume = (uRingBufferParseResume_t *) pRingBuffer->pParseResume;
+
+    if ((pResume != NULL) && (handle < pRingBuffer->maxNumReadPointers)) {
+        pResume += handle;
+        if (length <= pResume->bytesDiscard) {
+            // Only junk in front of the message has gone
+            pResume->bytesDiscard -= length;
+        } else {
+            pResume->parserIndex = -1;
+        }
+    }
+}
+
 // The ring buffer's mutex should be locked before this is called
 static void bufferReset(uRingBuffer_t *pRingBuffer)
 {
@@ -129,6 +208,7 @@ static void bufferReset(uRingBuffer_t *pRingBuffer)
         if (pRingBuffer->pDataRead[x] != NULL) {
             pRingBuffer->pDataRead[x] = pRingBuffer->pBuffer;
         }
+        parseResumeMove(pRingBuffer, x, pRingBuffer->size);
     }
     pRingBuffer->pDataWrite = pRingBuffer->pBuffer;
     // The default handle-less read pointer can always be set
@@ -171,19 +251,84 @@ static size_t read(uRingBuffer_t *pRingBuffer, int32_t handle, char *pData,
         }
         if (destructive) {
             pRingBuffer->pDataRead[handle] = pSource;
+            if (bytesRead > 0) {
+                parseResumeMove(pRingBuffer, handle, bytesRead);
+            }
         }
     }
 
     return bytesRead;
 }
 
-// The ring buffer's mutex should be locked before this is called
+// Work out which read pointers with notifications set have been
+// pushed over their thresholds by the addition of length bytes.
+// The ring buffer's mutex should be locked before this is called.
+static void notifyCheck(const uRingBuffer_t *pRingBuffer, size_t length,
+                        uRingBufferNotifyEvents_t *pEvents)
+{
+    const uRingBufferNotifySettings_t *pSettings = (const uRingBufferNotifySettings_t *) pRingBuffer->pNotify;
+    size_t used;
+    size_t freeBytes;
+
+    if (pSettings != NULL) {
+        // Entry 0, the "normal" read pointer, can't have notifications
+        for (size_t x = 1; x < pRingBuffer->maxNumReadPointers; x++) {
+            pSettings++;
+            if ((pRingBuffer->pDataRead[x] != NULL) && (pSettings->pCallback != NULL)) {
+                used = ptrDiff(pRingBuffer->pDataRead[x], pRingBuffer->pDataWrite,
+                               pRingBuffer->size);
+                // Can't have the pointers overlap, hence the - 1
+                freeBytes = pRingBuffer->size - used - 1;
+                if ((pSettings->watermarkBytes > 0) && (used >= pSettings->watermarkBytes) &&
+                    ((used < length) || (used - length < pSettings->watermarkBytes))) {
+                    pEvents->watermarkBitmap |= 1ULL << (x - 1);
+                }
+                if ((freeBytes < pSettings->lagBytes) &&
+                    (freeBytes + length >= pSettings->lagBytes)) {
+                    pEvents->laggingBitmap |= 1ULL << (x - 1);
+                }
+            }
+        }
+    }
+}
+
+// Deliver the notifications raised by an add; the ring buffer's
+// mutex must NOT be locked when this is called.
+static void notifyCall(uRingBuffer_t *pRingBuffer,
+                       const uRingBufferNotifyEvents_t *pEvents)
+{
+    const uRingBufferNotifySettings_t *pSettings = (const uRingBufferNotifySettings_t *) pRingBuffer->pNotify;
+    uRingBufferNotifyCallback_t pCallback;
+
+    for (size_t x = 1; (pSettings != NULL) && (x < pRingBuffer->maxNumReadPointers) &&
+         ((pEvents->watermarkBitmap | pEvents->laggingBitmap) >> (x - 1)); x++) {
+        // Take a copy in case notifications are switched off meanwhile
+        pCallback = pSettings[x].pCallback;
+        if (pCallback != NULL) {
+            if (pEvents->laggingBitmap & (1ULL << (x - 1))) {
+                pCallback(pRingBuffer, (int32_t) x, U_RING_BUFFER_NOTIFY_LAGGING,
+                          pSettings[x].pCallbackParam);
+            }
+            if (pEvents->watermarkBitmap & (1ULL << (x - 1))) {
+                pCallback(pRingBuffer, (int32_t) x, U_RING_BUFFER_NOTIFY_WATERMARK,
+                          pSettings[x].pCallbackParam);
+            }
+        }
+    }
+}
+
+// The ring buffer's mutex should be locked before this is called;
+// if pData is NULL the data is assumed to already be at pDataWrite.
+// Any notifications raised are added to pEvents, to be delivered
+// with notifyCall() once the mutex has been unlocked.
 static bool add(uRingBuffer_t *pRingBuffer, const char *pData,
-                size_t length, bool destructive)
+                size_t length, bool destructive,
+                uRingBufferNotifyEvents_t *pEvents)
 {
     bool dataFitsInBuffer = true;
     size_t lost;
     size_t used;
+    size_t addLength = length;
 
     if (length >= pRingBuffer->size) {
         dataFitsInBuffer = false;
@@ -205,6 +350,9 @@ static bool add(uRingBuffer_t *pRingBuffer, const char *pData,
                             pRingBuffer->statReadLossNormalBytes += lost;
                         } else {
                             pRingBuffer->statReadLossBytes[x] += lost;
+                            if (lost > 0) {
+                                pEvents->laggingBitmap |= 1ULL << (x - 1);
+                            }
                         }
                     } else {
                         dataFitsInBuffer = false;
@@ -215,6 +363,14 @@ static bool add(uRingBuffer_t *pRingBuffer, const char *pData,
     }
 
     if (dataFitsInBuffer) {
+        if (pData == NULL) {
+            // The data is already in place, written through
+            // uRingBufferReserve(), just move the write pointer on
+            pRingBuffer->pDataWrite = (char *) pPtrOffset(pRingBuffer->pDataWrite, length,
+                                                          pRingBuffer->pBuffer,
+                                                          pRingBuffer->size);
+            length = 0;
+        }
         while (length > 0) {
             *(pRingBuffer->pDataWrite) = *pData;
             pRingBuffer->pDataWrite = (char *) pPtrInc(pRingBuffer->pDataWrite, pRingBuffer->pBuffer,
@@ -222,6 +378,7 @@ static bool add(uRingBuffer_t *pRingBuffer, const char *pData,
             length--;
             pData++;
         }
+        notifyCheck(pRingBuffer, addLength, pEvents);
     } else {
         pRingBuffer->statAddLossBytes += length;
     }
@@ -229,6 +386,89 @@ static bool add(uRingBuffer_t *pRingBuffer, const char *pData,
     return dataFitsInBuffer;
 }
 
+// Read from the consumer side of an SPSC ring buffer: no mutex required.
+static size_t spscRead(uRingBuffer_t *pRingBuffer, char *pData,
+                       size_t length, size_t offset, bool destructive)
+{
+    size_t bytesRead = 0;
+    // The read pointer is only ever written by us, the consumer,
+    // while the write pointer is moved on by the producer
+    const char *pSource = pRingBuffer->pDataRead[0];
+    const char *pWrite = *((const char *volatile *) & (pRingBuffer->pDataWrite));
+    size_t available;
+    size_t x;
+
+    // Don't let the data be read before the write pointer
+    U_MEMORY_BARRIER();
+    available = ptrDiff(pSource, (char *) pWrite, pRingBuffer->size);
+    if (offset < available) {
+        available -= offset;
+        pSource = pPtrOffset(pSource, offset, pRingBuffer->pBuffer, pRingBuffer->size);
+        if (length > available) {
+            length = available;
+        }
+        if (pData != NULL) {
+            // Copy up to the end of the linear buffer and then from the start
+            x = pRingBuffer->pBuffer + pRingBuffer->size - pSource;
+            if (x > length) {
+                x = length;
+            }
+            memcpy(pData, pSource, x);
+            memcpy(pData + x, pRingBuffer->pBuffer, length - x);
+        }
+        bytesRead = length;
+        if (destructive) {
+            pSource = pPtrOffset(pSource, length, pRingBuffer->pBuffer, pRingBuffer->size);
+            // The data must have been read before the producer
+            // is given the space back
+            U_MEMORY_BARRIER();
+            *((const char *volatile *) & (pRingBuffer->pDataRead[0])) = pSource;
+        }
+    }
+
+    return bytesRead;
+}
+
+// Add to the producer side of an SPSC ring buffer: no mutex required.
+static bool spscAdd(uRingBuffer_t *pRingBuffer, const char *pData, size_t length)
+{
+    bool dataFitsInBuffer = false;
+    // The write pointer is only ever written by us, the producer,
+    // while the read pointer is moved on by the consumer
+    char *pWrite = pRingBuffer->pDataWrite;
+    const char *pRead = *((const char *volatile *) & (pRingBuffer->pDataRead[0]));
+    size_t x;
+
+    // Can't have the pointers overlap, hence "<"
+    if (length < pRingBuffer->size - ptrDiff(pRead, pWrite, pRingBuffer->size)) {
+        // Copy up to the end of the linear buffer and then from the start
+        x = pRingBuffer->pBuffer + pRingBuffer->size - pWrite;
+        if (x > length) {
+            x = length;
+        }
+        memcpy(pWrite, pData, x);
+        memcpy(pRingBuffer->pBuffer, pData + x, length - x);
+        pWrite = (char *) pPtrOffset(pWrite, length, pRingBuffer->pBuffer, pRingBuffer->size);
+        // The data must be in place before the consumer can see it
+        U_MEMORY_BARRIER();
+        *((char *volatile *) & (pRingBuffer->pDataWrite)) = pWrite;
+        dataFitsInBuffer = true;
+    } else {
+        pRingBuffer->statAddLossBytes += length;
+    }
+
+    return dataFitsInBuffer;
+}
+
+// Get the amount of data in an SPSC ring buffer, callable from either side.
+static size_t spscDataSize(const uRingBuffer_t *pRingBuffer)
+{
+    const char *pRead = *((const char *const volatile *) & (pRingBuffer->pDataRead[0]));
+    char *pWrite = *((char *const volatile *) & (pRingBuffer->pDataWrite));
+
+    return ptrDiff(pRead, pWrite, pRingBuffer->size);
+}
+
 // This function does the ring buffer mutex locking itself.
 static size_t lock(uRingBuffer_t *pRingBuffer, int32_t handle, bool lockNotUnlock)
 {
@@ -253,52 +493,114 @@ static size_t lock(uRingBuffer_t *pRingBuffer, int32_t handle, bool lockNotUnloc
     return dataSize;
 }
 
+// The ring buffer's mutex should be locked before this is called.
+static size_t availableSizeUnlocked(const uRingBuffer_t *pRingBuffer, bool max)
+{
+    size_t size = pRingBuffer->size;
+    size_t y = 0;
+    bool foundADataReadPointer = false;
+
+    for (size_t x = 0; x < pRingBuffer->maxNumReadPointers; x++) {
+        // If a read handle is required we ignore the data behind
+        // the "normal" read pointer as it's not possible to get
+        // at it
+        if ((pRingBuffer->pDataRead[x] != NULL) &&
+            ((x > 0) || !pRingBuffer->readHandleRequired)) {
+            // If we're doing max then we only take into account
+            // locked data buffer pointers and we ignore 0 since
+            // it is not lockable
+            if (!max || ((x > 0) && (pRingBuffer->dataReadLockBitmap & (1ULL << (x - 1))))) {
+                y = pRingBuffer->size - ptrDiff(pRingBuffer->pDataRead[x], pRingBuffer->pDataWrite,
+                                                pRingBuffer->size);
+                if (y < size) {
+                    size = y;
+                }
+                foundADataReadPointer = true;
+            }
+        }
+    }
+
+    if (!max && !foundADataReadPointer) {
+        // If we didn't find a single data read pointer,
+        // and we're not doing max, report what is in the
+        // buffer anyway
+        size = pRingBuffer->size - ptrDiff(pRingBuffer->pBuffer, pRingBuffer->pDataWrite,
+                                           pRingBuffer->size);
+    }
+    if (size > 0) {
+        //  Must keep one to prevent pointer wrap
+        size--;
+    }
+
+    return size;
+}
+
 // This function does the ring buffer mutex locking itself.
 static size_t availableSize(const uRingBuffer_t *pRingBuffer, bool max)
 {
     size_t size = 0;
-    size_t y = 0;
-    bool foundADataReadPointer = false;
 
-    if (pRingBuffer->pBuffer != NULL) {
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        // Must keep one to prevent pointer wrap
+        size = pRingBuffer->size - spscDataSize(pRingBuffer) - 1;
+    } else if (pRingBuffer->pBuffer != NULL) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
-        size = pRingBuffer->size;
-        for (size_t x = 0; x < pRingBuffer->maxNumReadPointers; x++) {
-            // If a read handle is required we ignore the data behind
-            // the "normal" read pointer as it's not possible to get
-            // at it
-            if ((pRingBuffer->pDataRead[x] != NULL) &&
-                ((x > 0) || !pRingBuffer->readHandleRequired)) {
-                // If we're doing max then we only take into account
-                // locked data buffer pointers and we ignore 0 since
-                // it is not lockable
-                if (!max || ((x > 0) && (pRingBuffer->dataReadLockBitmap & (1ULL << (x - 1))))) {
-                    y = pRingBuffer->size - ptrDiff(pRingBuffer->pDataRead[x], pRingBuffer->pDataWrite,
-                                                    pRingBuffer->size);
-                    if (y < size) {
-                        size = y;
-                    }
-                    foundADataReadPointer = true;
-                }
-            }
-        }
+        size = availableSizeUnlocked(pRingBuffer, max);
 
-        if (!max && !foundADataReadPointer) {
-            // If we didn't find a single data read pointer,
-            // and we're not doing max, report what is in the
-            // buffer anyway
-            size = pRingBuffer->size - ptrDiff(pRingBuffer->pBuffer, pRingBuffer->pDataWrite,
-                                               pRingBuffer->size);
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+    }
+
+    return size;
+}
+
+// Reserve the largest contiguous writable region: if this returns
+// non-zero then, other than in the SPSC case, the ring buffer's mutex
+// is left locked, to be unlocked by uRingBufferCommit().
+static size_t reserve(uRingBuffer_t *pRingBuffer, char **ppData, bool forced)
+{
+    size_t size = 0;
+    size_t contiguous;
+
+    if ((pRingBuffer->pBuffer != NULL) && (ppData != NULL)) {
+        if (pRingBuffer->isSpsc) {
+            size = pRingBuffer->size - spscDataSize(pRingBuffer) - 1;
+        } else {
+            uPortMutexLock((uPortMutexHandle_t) pRingBuffer->mutex);
+            size = availableSizeUnlocked(pRingBuffer, forced);
+        }
+        // Only the producer moves the write pointer so this is safe
+        contiguous = pRingBuffer->pBuffer + pRingBuffer->size - pRingBuffer->pDataWrite;
+        if (size > contiguous) {
+            size = contiguous;
         }
         if (size > 0) {
-            //  Must keep one to prevent pointer wrap
-            size--;
+            *ppData = pRingBuffer->pDataWrite;
+            pRingBuffer->reservedLength = size;
+            pRingBuffer->reserveIsForced = forced;
+        } else if (!pRingBuffer->isSpsc) {
+            uPortMutexUnlock((uPortMutexHandle_t) pRingBuffer->mutex);
         }
+    }
 
-        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+    return size;
+}
+
+// Fill in the (up to) two contiguous spans of data between pRead and pWrite.
+static size_t peekSpan(const uRingBuffer_t *pRingBuffer, const char *pRead,
+                       const char *pWrite, uRingBufferSpan_t *pSpan)
+{
+    size_t size = ptrDiff(pRead, (char *) pWrite, pRingBuffer->size);
+    size_t contiguous = pRingBuffer->pBuffer + pRingBuffer->size - pRead;
+
+    if (contiguous > size) {
+        contiguous = size;
     }
+    pSpan[0].pData = pRead;
+    pSpan[0].length = contiguous;
+    pSpan[1].pData = pRingBuffer->pBuffer;
+    pSpan[1].length = size - contiguous;
 
     return size;
 }
@@ -400,6 +702,19 @@ int32_t uRingBufferCreate(uRingBuffer_t *pRingBuffer, char *pLinearBuffer, size_
     return createCommon(pRingBuffer, pLinearBuffer, size);
 }
 
+int32_t uRingBufferCreateSpsc(uRingBuffer_t *pRingBuffer, char *pLinearBuffer, size_t size)
+{
+    int32_t errorCode = uRingBufferCreate(pRingBuffer, pLinearBuffer, size);
+
+    if (errorCode == 0) {
+        // The mutex is retained for the functions which are not
+        // on the data path (e.g. uRingBufferReset())
+        pRingBuffer->isSpsc = true;
+    }
+
+    return errorCode;
+}
+
 void uRingBufferDelete(uRingBuffer_t *pRingBuffer)
 {
     if ((pRingBuffer != NULL) && (pRingBuffer->mutex != NULL)) {
@@ -409,6 +724,10 @@ void uRingBufferDelete(uRingBuffer_t *pRingBuffer)
             uPortFree(pRingBuffer->statReadLossBytes);
             pRingBuffer->statReadLossBytes = NULL;
         }
+        uPortFree(pRingBuffer->pParseResume);
+        pRingBuffer->pParseResume = NULL;
+        uPortFree(pRingBuffer->pNotify);
+        pRingBuffer->pNotify = NULL;
         pRingBuffer->maxNumReadPointers = 0;
         uPortMutexDelete((uPortMutexHandle_t) pRingBuffer->mutex);
         pRingBuffer->mutex = NULL;
@@ -419,32 +738,47 @@ void uRingBufferDelete(uRingBuffer_t *pRingBuffer)
 bool uRingBufferAdd(uRingBuffer_t *pRingBuffer, const char *pData, size_t length)
 {
     bool dataFitsInBuffer = false;
+    uRingBufferNotifyEvents_t events = {0};
 
-    if (pRingBuffer->pBuffer != NULL) {
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        dataFitsInBuffer = spscAdd(pRingBuffer, pData, length);
+    } else if (pRingBuffer->pBuffer != NULL) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
-        dataFitsInBuffer = add(pRingBuffer, pData, length, false);
+        dataFitsInBuffer = add(pRingBuffer, pData, length, false, &events);
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+
+        notifyCall(pRingBuffer, &events);
     }
 
+    TRACE_ADD(dataFitsInBuffer, length);
+
     return dataFitsInBuffer;
 }
 
 bool uRingBufferForceAdd(uRingBuffer_t *pRingBuffer, const char *pData, size_t length)
 {
     bool dataFitsInBuffer = false;
+    uRingBufferNotifyEvents_t events = {0};
 
-    if (pRingBuffer->pBuffer != NULL) {
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        // The producer can't move the consumer's read pointer
+        dataFitsInBuffer = spscAdd(pRingBuffer, pData, length);
+    } else if (pRingBuffer->pBuffer != NULL) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
-        dataFitsInBuffer = add(pRingBuffer, pData, length, true);
+        dataFitsInBuffer = add(pRingBuffer, pData, length, true, &events);
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+
+        notifyCall(pRingBuffer, &events);
     }
 
+    TRACE_ADD(dataFitsInBuffer, length);
+
     return dataFitsInBuffer;
 }
 
@@ -452,7 +786,9 @@ size_t uRingBufferRead(uRingBuffer_t *pRingBuffer, char *pData, size_t length)
 {
     size_t bytesRead = 0;
 
-    if ((pRingBuffer->pBuffer != NULL) && !pRingBuffer->readHandleRequired) {
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        bytesRead = spscRead(pRingBuffer, pData, length, 0, true);
+    } else if ((pRingBuffer->pBuffer != NULL) && !pRingBuffer->readHandleRequired) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
@@ -461,6 +797,8 @@ size_t uRingBufferRead(uRingBuffer_t *pRingBuffer, char *pData, size_t length)
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
     }
 
+    TRACE_READ(bytesRead);
+
     return bytesRead;
 }
 
@@ -469,7 +807,9 @@ size_t uRingBufferPeek(uRingBuffer_t *pRingBuffer, char *pData, size_t length,
 {
     size_t bytesRead = 0;
 
-    if ((pRingBuffer->pBuffer != NULL) && !pRingBuffer->readHandleRequired) {
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        bytesRead = spscRead(pRingBuffer, pData, length, offset, false);
+    } else if ((pRingBuffer->pBuffer != NULL) && !pRingBuffer->readHandleRequired) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
@@ -481,11 +821,82 @@ size_t uRingBufferPeek(uRingBuffer_t *pRingBuffer, char *pData, size_t length,
     return bytesRead;
 }
 
+size_t uRingBufferPeekSpan(uRingBuffer_t *pRingBuffer, uRingBufferSpan_t *pSpan)
+{
+    size_t size = 0;
+    const char *pWrite;
+
+    if ((pRingBuffer->pBuffer != NULL) && (pSpan != NULL)) {
+        pSpan[0].length = 0;
+        pSpan[1].length = 0;
+        if (pRingBuffer->isSpsc) {
+            pWrite = *((char *volatile *) & (pRingBuffer->pDataWrite));
+            // Don't let the data be read before the write pointer
+            U_MEMORY_BARRIER();
+            size = peekSpan(pRingBuffer, pRingBuffer->pDataRead[0], pWrite, pSpan);
+        } else if (!pRingBuffer->readHandleRequired) {
+
+            U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+
+            size = peekSpan(pRingBuffer, pRingBuffer->pDataRead[0],
+                            pRingBuffer->pDataWrite, pSpan);
+
+            U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        }
+    }
+
+    return size;
+}
+
+size_t uRingBufferReserve(uRingBuffer_t *pRingBuffer, char **ppData)
+{
+    return reserve(pRingBuffer, ppData, false);
+}
+
+size_t uRingBufferForceReserve(uRingBuffer_t *pRingBuffer, char **ppData)
+{
+    // In the SPSC case the producer can't move the consumer's read
+    // pointer, so a forced reserve is the same as a normal one
+    return reserve(pRingBuffer, ppData, !pRingBuffer->isSpsc);
+}
+
+bool uRingBufferCommit(uRingBuffer_t *pRingBuffer, size_t length)
+{
+    bool success = false;
+    uRingBufferNotifyEvents_t events = {0};
+
+    if ((pRingBuffer->pBuffer != NULL) && (pRingBuffer->reservedLength > 0)) {
+        success = (length <= pRingBuffer->reservedLength);
+        pRingBuffer->reservedLength = 0;
+        if (pRingBuffer->isSpsc) {
+            if (success) {
+                // The data must be in place before the consumer can see it
+                U_MEMORY_BARRIER();
+                *((char *volatile *) & (pRingBuffer->pDataWrite)) =
+                    (char *) pPtrOffset(pRingBuffer->pDataWrite, length,
+                                        pRingBuffer->pBuffer, pRingBuffer->size);
+            }
+        } else {
+            // Mutex was locked by reserve()
+            if (success) {
+                success = add(pRingBuffer, NULL, length, pRingBuffer->reserveIsForced,
+                              &events);
+            }
+            uPortMutexUnlock((uPortMutexHandle_t) pRingBuffer->mutex);
+            notifyCall(pRingBuffer, &events);
+        }
+    }
+
+    return success;
+}
+
 size_t uRingBufferDataSize(const uRingBuffer_t *pRingBuffer)
 {
     size_t dataSize = 0;
 
-    if (pRingBuffer->pBuffer != NULL) {
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        dataSize = spscDataSize(pRingBuffer);
+    } else if (pRingBuffer->pBuffer != NULL) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
@@ -507,11 +918,17 @@ size_t uRingBufferAvailableSize(const uRingBuffer_t *pRingBuffer)
 
 void uRingBufferFlush(uRingBuffer_t *pRingBuffer)
 {
-    if (pRingBuffer->pBuffer != NULL) {
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        // Consumer side: just catch up with the producer
+        *((const char *volatile *) & (pRingBuffer->pDataRead[0])) =
+            *((char *volatile *) & (pRingBuffer->pDataWrite));
+        parseResumeMove(pRingBuffer, 0, pRingBuffer->size);
+    } else if (pRingBuffer->pBuffer != NULL) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
         pRingBuffer->pDataRead[0] = pRingBuffer->pDataWrite;
+        parseResumeMove(pRingBuffer, 0, pRingBuffer->size);
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
     }
@@ -533,7 +950,9 @@ size_t uRingBufferStatReadLoss(uRingBuffer_t *pRingBuffer)
 {
     size_t bytesLost = 0;
 
-    if (pRingBuffer->pBuffer != NULL) {
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        bytesLost = *((volatile size_t *) & (pRingBuffer->statReadLossNormalBytes));
+    } else if (pRingBuffer->pBuffer != NULL) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
@@ -549,7 +968,9 @@ size_t uRingBufferStatAddLoss(uRingBuffer_t *pRingBuffer)
 {
     size_t bytesLost = 0;
 
-    if (pRingBuffer->pBuffer != NULL) {
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        bytesLost = *((volatile size_t *) & (pRingBuffer->statAddLossBytes));
+    } else if (pRingBuffer->pBuffer != NULL) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
@@ -606,6 +1027,7 @@ void uRingBufferSetReadRequiresHandle(uRingBuffer_t *pRingBuffer, bool onNotOff)
             // it off, set the non-handled read
             // pointer so that it gets sensible data
             pRingBuffer->pDataRead[0] = pRingBuffer->pDataWrite;
+            parseResumeMove(pRingBuffer, 0, pRingBuffer->size);
         }
         pRingBuffer->readHandleRequired = onNotOff;
 
@@ -634,6 +1056,7 @@ int32_t uRingBufferTakeReadHandle(uRingBuffer_t *pRingBuffer)
             if (pRingBuffer->pDataRead[x] == NULL) {
                 pRingBuffer->pDataRead[x] = pRingBuffer->pDataWrite;
                 pRingBuffer->statReadLossBytes[x] = 0;
+                parseResumeMove(pRingBuffer, x, pRingBuffer->size);
                 readHandle = x;
             }
         }
@@ -653,6 +1076,10 @@ void uRingBufferGiveReadHandle(uRingBuffer_t *pRingBuffer, int32_t handle)
         if ((handle >= 1) && (handle < (int32_t) pRingBuffer->maxNumReadPointers)) {
             pRingBuffer->pDataRead[handle] = NULL;
             pRingBuffer->dataReadLockBitmap &= ~(1ULL << (handle - 1));
+            if (pRingBuffer->pNotify != NULL) {
+                memset(((uRingBufferNotifySettings_t *) pRingBuffer->pNotify) + handle, 0,
+                       sizeof(uRingBufferNotifySettings_t));
+            }
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
@@ -705,6 +1132,8 @@ size_t uRingBufferReadHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
     }
 
+    TRACE_READ(bytesRead);
+
     return bytesRead;
 }
 
@@ -744,6 +1173,29 @@ size_t uRingBufferDataSizeHandle(const uRingBuffer_t *pRingBuffer, int32_t handl
     return dataSize;
 }
 
+size_t uRingBufferPeekSpanHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
+                                 uRingBufferSpan_t *pSpan)
+{
+    size_t size = 0;
+
+    if ((pRingBuffer->pBuffer != NULL) && (pSpan != NULL)) {
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+
+        pSpan[0].length = 0;
+        pSpan[1].length = 0;
+        if ((handle >= 1) && (handle < (int32_t) pRingBuffer->maxNumReadPointers) &&
+            (pRingBuffer->pDataRead[handle] != NULL)) {
+            size = peekSpan(pRingBuffer, pRingBuffer->pDataRead[handle],
+                            pRingBuffer->pDataWrite, pSpan);
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+    }
+
+    return size;
+}
+
 size_t uRingBufferAvailableSizeMax(const uRingBuffer_t *pRingBuffer)
 {
     return availableSize(pRingBuffer, true);
@@ -758,6 +1210,7 @@ void uRingBufferFlushHandle(uRingBuffer_t *pRingBuffer, int32_t handle)
         if ((handle >= 1) && (handle < (int32_t) pRingBuffer->maxNumReadPointers) &&
             (pRingBuffer->pDataRead[handle] != NULL)) {
             pRingBuffer->pDataRead[handle] = pRingBuffer->pDataWrite;
+            parseResumeMove(pRingBuffer, handle, pRingBuffer->size);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
@@ -784,6 +1237,52 @@ size_t uRingBufferStatReadLossHandle(uRingBuffer_t *pRingBuffer,
     return bytesLost;
 }
 
+int32_t uRingBufferSetNotifyHandle(uRingBuffer_t *pRingBuffer,
+                                   int32_t handle,
+                                   size_t watermarkBytes,
+                                   size_t lagBytes,
+                                   uRingBufferNotifyCallback_t pCallback,
+                                   void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uRingBufferNotifySettings_t *pSettings;
+
+    if (pRingBuffer->pBuffer != NULL) {
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((handle >= 1) && (handle < (int32_t) pRingBuffer->maxNumReadPointers) &&
+            (pRingBuffer->pDataRead[handle] != NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            if ((pRingBuffer->pNotify == NULL) && (pCallback != NULL)) {
+                // Allocate storage for all read pointers since that's simplest
+                pRingBuffer->pNotify = pUPortMalloc(pRingBuffer->maxNumReadPointers *
+                                                    sizeof(uRingBufferNotifySettings_t));
+                if (pRingBuffer->pNotify != NULL) {
+                    memset(pRingBuffer->pNotify, 0,
+                           pRingBuffer->maxNumReadPointers * sizeof(uRingBufferNotifySettings_t));
+                }
+            }
+            if (pRingBuffer->pNotify != NULL) {
+                pSettings = ((uRingBufferNotifySettings_t *) pRingBuffer->pNotify) + handle;
+                pSettings->watermarkBytes = watermarkBytes;
+                pSettings->lagBytes = lagBytes;
+                pSettings->pCallbackParam = pCallbackParam;
+                pSettings->pCallback = pCallback;
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            } else if (pCallback == NULL) {
+                // Nothing to switch off
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: PARSER
  * -------------------------------------------------------------- */
@@ -792,31 +1291,87 @@ size_t uRingBufferParseHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
                               U_RING_BUFFER_PARSER_f *pParserList, void *pUserParam)
 {
     size_t errorCodeOrLength = U_ERROR_COMMON_INVALID_PARAMETER;
+    uRingBufferParseResume_t *pResume;
+    uRingBufferParseResume_t resume = {.parserIndex = -1};
+    uRingBufferParseContext_t ctx;
 
     if (pRingBuffer->pBuffer != NULL) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
+        if (pRingBuffer->pParseResume == NULL) {
+            // Allocate storage to resume parsing, for all read pointers
+            // since that's simplest; if this fails we just don't resume
+            pRingBuffer->pParseResume = pUPortMalloc(pRingBuffer->maxNumReadPointers *
+                                                     sizeof(uRingBufferParseResume_t));
+            if (pRingBuffer->pParseResume != NULL) {
+                pResume = (uRingBufferParseResume_t *) pRingBuffer->pParseResume;
+                for (size_t x = 0; x < pRingBuffer->maxNumReadPointers; x++) {
+                    (pResume + x)->parserIndex = -1;
+                }
+            }
+        }
+
         if ((handle >= 0) && (handle < (int32_t) pRingBuffer->maxNumReadPointers) &&
             (pRingBuffer->pDataRead[handle] != NULL)) {
             const char *pOffset = pPtrOffset(pRingBuffer->pDataRead[handle], 0, pRingBuffer->pBuffer,
                                              pRingBuffer->size);
             size_t bytesAvailable = ptrDiff(pOffset, pRingBuffer->pDataWrite, pRingBuffer->size);
             size_t bytesDiscard  = 0;
+            size_t bytesSkip;
+            size_t firstParser = 0;
+            pResume = (uRingBufferParseResume_t *) pRingBuffer->pParseResume;
+            if (pResume != NULL) {
+                pResume += handle;
+                if ((pResume->parserIndex >= 0) &&
+                    (pResume->bytesDiscard + pResume->bytesParsed <= bytesAvailable)) {
+                    // A parser was part-way through a message last time,
+                    // jump straight back to it
+                    resume = *pResume;
+                    bytesDiscard = resume.bytesDiscard;
+                    pOffset = pPtrOffset(pOffset, bytesDiscard, pRingBuffer->pBuffer, pRingBuffer->size);
+                    bytesAvailable -= bytesDiscard;
+                    firstParser = (size_t) resume.parserIndex;
+                }
+                pResume->parserIndex = -1;
+            }
             errorCodeOrLength = U_ERROR_COMMON_TIMEOUT;
             while (bytesAvailable) {
-                U_RING_BUFFER_PARSER_f *pParser = pParserList;
+                U_RING_BUFFER_PARSER_f *pParser = pParserList + firstParser;
                 // find the right protocol
                 errorCodeOrLength = U_ERROR_COMMON_NOT_FOUND;
+                bytesSkip = bytesAvailable;
+                if (firstParser > 0) {
+                    // Don't know how far the parsers we've
+                    // not called could skip
+                    bytesSkip = 1;
+                }
+                firstParser = 0;
                 while (*pParser) {
-                    uRingBufferParseContext_t ctx = {
-                        .pRingBuffer    = pRingBuffer,
-                        .pSource        = pOffset,
-                        .bytesAvailable = bytesAvailable,
-                        .bytesParsed    = 0,
-                        .bytesDiscard   = bytesDiscard
-                    };
+                    memset(&ctx, 0, sizeof(ctx));
+                    ctx.pRingBuffer = pRingBuffer;
+                    ctx.pSource = pOffset;
+                    ctx.bytesAvailable = bytesAvailable;
+                    ctx.bytesDiscard = bytesDiscard;
+                    ctx.bytesSkip = 1;
+                    if (resume.parserIndex >= 0) {
+                        // Carry on from where the parser left off
+                        ctx.pSource = pPtrOffset(pOffset, resume.bytesParsed,
+                                                 pRingBuffer->pBuffer, pRingBuffer->size);
+                        ctx.bytesAvailable -= resume.bytesParsed;
+                        ctx.bytesParsed = resume.bytesParsed;
+                        ctx.state = resume.state;
+                        resume.parserIndex = -1;
+                    }
                     errorCodeOrLength = (*pParser)(&ctx, pUserParam);
+                    if ((errorCodeOrLength == (size_t) U_ERROR_COMMON_TIMEOUT) &&
+                        (pResume != NULL) && (ctx.state.bytes[0] != 0)) {
+                        // The parser would like to resume from here
+                        pResume->parserIndex = (int32_t) (pParser - pParserList);
+                        pResume->bytesDiscard = bytesDiscard;
+                        pResume->bytesParsed = ctx.bytesParsed;
+                        pResume->state = ctx.state;
+                    }
                     pParser ++;
                     if (errorCodeOrLength == U_ERROR_COMMON_SUCCESS) {
                         errorCodeOrLength = ctx.bytesParsed;
@@ -824,13 +1379,18 @@ size_t uRingBufferParseHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
                     if (errorCodeOrLength != U_ERROR_COMMON_NOT_FOUND) {
                         break;
                     }
+                    // We can only move on as far as the parser
+                    // that could next find something allows
+                    if (ctx.bytesSkip < bytesSkip) {
+                        bytesSkip = ctx.bytesSkip;
+                    }
                 }
                 if (errorCodeOrLength != U_ERROR_COMMON_NOT_FOUND) {
                     break;
                 }
-                pOffset = pPtrInc(pOffset, pRingBuffer->pBuffer, pRingBuffer->size);
-                bytesDiscard ++;
-                bytesAvailable --;
+                pOffset = pPtrOffset(pOffset, bytesSkip, pRingBuffer->pBuffer, pRingBuffer->size);
+                bytesDiscard += bytesSkip;
+                bytesAvailable -= bytesSkip;
             }
             if (bytesDiscard > 0) {
                 errorCodeOrLength = bytesDiscard;
@@ -843,6 +1403,11 @@ size_t uRingBufferParseHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
     return errorCodeOrLength;
 }
 
+void *pURingBufferParserStateUnprotected(uParseHandle_t parseHandle)
+{
+    uRingBufferParseContext_t *pCtx = (uRingBufferParseContext_t *)parseHandle;
+    return &(pCtx->state);
+}
 
 bool uRingBufferGetByteUnprotected(uParseHandle_t parseHandle, void *p)
 {
@@ -858,6 +1423,66 @@ bool uRingBufferGetByteUnprotected(uParseHandle_t parseHandle, void *p)
     return true;
 }
 
+size_t uRingBufferGetSpanUnprotected(uParseHandle_t parseHandle,
+                                     const char **ppData, size_t length)
+{
+    uRingBufferParseContext_t *pCtx = (uRingBufferParseContext_t *)parseHandle;
+    size_t contiguous = pCtx->pRingBuffer->pBuffer + pCtx->pRingBuffer->size - pCtx->pSource;
+
+    if (length > pCtx->bytesAvailable) {
+        length = pCtx->bytesAvailable;
+    }
+    if (length > contiguous) {
+        length = contiguous;
+    }
+    *ppData = pCtx->pSource;
+    pCtx->pSource = pPtrOffset(pCtx->pSource, length, pCtx->pRingBuffer->pBuffer,
+                               pCtx->pRingBuffer->size);
+    pCtx->bytesParsed += length;
+    pCtx->bytesAvailable -= length;
+    return length;
+}
+
+bool uRingBufferSyncUnprotected(uParseHandle_t parseHandle, char syncByte)
+{
+    uRingBufferParseContext_t *pCtx = (uRingBufferParseContext_t *)parseHandle;
+    const char *pBuffer = pCtx->pRingBuffer->pBuffer;
+    size_t bufferSize = pCtx->pRingBuffer->size;
+    const char *pData;
+    const char *pFound = NULL;
+    size_t offset = 1;
+    size_t contiguous;
+
+    if (1 > pCtx->bytesAvailable) {
+        return false;
+    }
+    if (*pCtx->pSource == syncByte) {
+        pCtx->pSource = pPtrInc(pCtx->pSource, pBuffer, bufferSize);
+        pCtx->bytesParsed ++;
+        pCtx->bytesAvailable --;
+        return true;
+    }
+    // Not synchronised: find the next sync byte with memchr(),
+    // at most two goes since the data can only wrap once
+    pData = pPtrInc(pCtx->pSource, pBuffer, bufferSize);
+    while ((offset < pCtx->bytesAvailable) && (pFound == NULL)) {
+        contiguous = pBuffer + bufferSize - pData;
+        if (contiguous > pCtx->bytesAvailable - offset) {
+            contiguous = pCtx->bytesAvailable - offset;
+        }
+        pFound = (const char *) memchr(pData, syncByte, contiguous);
+        if (pFound != NULL) {
+            offset += pFound - pData;
+        } else {
+            offset += contiguous;
+            pData = pBuffer;
+        }
+    }
+    // Nothing before offset can be the start of a message of this type
+    pCtx->bytesSkip = offset;
+    return false;
+}
+
 size_t uRingBufferBytesAvailableUnprotected(uParseHandle_t parseHandle)
 {
     uRingBufferParseContext_t *pCtx = (uRingBufferParseContext_t *)parseHandle;
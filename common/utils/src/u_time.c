@@ -28,15 +28,31 @@
 # include "u_cfg_override.h" // For a customer's configuration override
 #endif
 
+#include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
 
+#include "u_port.h"
+
 #include "u_time.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+/** The number of seconds in a day.
+ */
+#define U_TIME_SECONDS_PER_DAY (3600 * 24)
+
+/** The number of days in a 400 year era of the Gregorian calendar.
+ */
+#define U_TIME_DAYS_PER_ERA 146097
+
+/** The number of days from 1st March of year 0 (the start of
+ * an era, counting each year from March) to 1st January 1970.
+ */
+#define U_TIME_DAYS_FROM_YEAR_0_TO_1970 719468
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -45,47 +61,147 @@
  * STATIC VARIABLES
  * -------------------------------------------------------------- */
 
-static const char gDaysInMonth[] = {31, 28, 31, 30, 31, 30, 31,
-                                    31, 30, 31, 30, 31
-                                   };
-static const char gDaysInMonthLeapYear[] = {31, 29, 31, 30, 31, 30,
-                                            31, 31, 30, 31, 30, 31
-                                           };
+/** UTC time in microseconds minus uPortGetTickTimeUs(), see
+ * uTimeHostSetUtcMs().
+ */
+static int64_t gHostOffsetUs = 0;
+
+/** The accuracy passed to uTimeHostSetUtcMs(), -1 if it has
+ * not been called.
+ */
+static int32_t gHostAccuracyMs = -1;
 
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Divide, rounding towards minus infinity rather than towards zero.
+static int64_t floorDiv(int64_t numerator, int64_t denominator)
+{
+    int64_t quotient = numerator / denominator;
+
+    if ((numerator % denominator) < 0) {
+        quotient--;
+    }
+
+    return quotient;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
 
 bool uTimeIsLeapYear(int32_t year)
 {
-    bool isLeapYear = false;
+    return ((year % 4) == 0) && (((year % 100) != 0) || ((year % 400) == 0));
+}
 
-    if (year % 400 == 0) {
-        isLeapYear = true;
-    } else if (year % 4 == 0) {
-        isLeapYear = true;
+int64_t uTimeMonthsToSecondsUtc(int32_t monthsUtc)
+{
+    int64_t years = floorDiv(monthsUtc, 12);
+
+    return uTimeDaysFromCivil((int32_t) (years + 1970),
+                              (int32_t) (monthsUtc - (years * 12)) + 1,
+                              1) * U_TIME_SECONDS_PER_DAY;
+}
+
+int64_t uTimeDaysFromCivil(int32_t year, int32_t month, int32_t day)
+{
+    int64_t y = year;
+    int64_t era;
+    int64_t yearOfEra;
+    int64_t dayOfYear;
+    int64_t dayOfEra;
+
+    // Count years from March, so that the leap day is at the end
+    if (month <= 2) {
+        y--;
     }
+    era = floorDiv(y, 400);
+    yearOfEra = y - (era * 400); // 0 to 399
+    // Months from March: 153 days in every five months
+    dayOfYear = ((153 * (month + ((month > 2) ? -3 : 9)) + 2) / 5) + day - 1; // 0 to 365
+    dayOfEra = (yearOfEra * 365) + (yearOfEra / 4) - (yearOfEra / 100) + dayOfYear;
 
-    return isLeapYear;
+    return (era * U_TIME_DAYS_PER_ERA) + dayOfEra - U_TIME_DAYS_FROM_YEAR_0_TO_1970;
 }
 
-int64_t uTimeMonthsToSecondsUtc(int32_t monthsUtc)
+void uTimeCivilFromDays(int64_t days, int32_t *pYear,
+                        int32_t *pMonth, int32_t *pDay)
+{
+    int64_t era;
+    int64_t dayOfEra;
+    int64_t yearOfEra;
+    int64_t dayOfYear;
+    int64_t monthFromMarch;
+    int32_t month;
+
+    days += U_TIME_DAYS_FROM_YEAR_0_TO_1970;
+    era = floorDiv(days, U_TIME_DAYS_PER_ERA);
+    dayOfEra = days - (era * U_TIME_DAYS_PER_ERA); // 0 to 146096
+    yearOfEra = (dayOfEra - (dayOfEra / 1460) + (dayOfEra / 36524) -
+                 (dayOfEra / (U_TIME_DAYS_PER_ERA - 1))) / 365; // 0 to 399
+    dayOfYear = dayOfEra - ((365 * yearOfEra) + (yearOfEra / 4) - (yearOfEra / 100));
+    monthFromMarch = ((5 * dayOfYear) + 2) / 153; // 0 to 11
+    month = (int32_t) ((monthFromMarch < 10) ? monthFromMarch + 3 : monthFromMarch - 9);
+    if (pYear != NULL) {
+        *pYear = (int32_t) (yearOfEra + (era * 400) + ((month <= 2) ? 1 : 0));
+    }
+    if (pMonth != NULL) {
+        *pMonth = month;
+    }
+    if (pDay != NULL) {
+        *pDay = (int32_t) (dayOfYear - (((153 * monthFromMarch) + 2) / 5) + 1);
+    }
+}
+
+int64_t uTimeBrokenDownToSecondsUtc(const uTimeBrokenDown_t *pBrokenDown)
+{
+    // Let the month carry into the year
+    int64_t years = floorDiv(((int64_t) pBrokenDown->month) - 1, 12);
+
+    return (uTimeDaysFromCivil((int32_t) (pBrokenDown->year + years),
+                               (int32_t) (pBrokenDown->month - (years * 12)),
+                               pBrokenDown->day) * U_TIME_SECONDS_PER_DAY) +
+           (((int64_t) pBrokenDown->hour) * 3600) +
+           (((int64_t) pBrokenDown->minute) * 60) +
+           pBrokenDown->second;
+}
+
+void uTimeSecondsUtcToBrokenDown(int64_t secondsUtc,
+                                 uTimeBrokenDown_t *pBrokenDown)
+{
+    int64_t days = floorDiv(secondsUtc, U_TIME_SECONDS_PER_DAY);
+    int32_t secondOfDay = (int32_t) (secondsUtc - (days * U_TIME_SECONDS_PER_DAY));
+
+    uTimeCivilFromDays(days, &(pBrokenDown->year), &(pBrokenDown->month),
+                       &(pBrokenDown->day));
+    pBrokenDown->hour = secondOfDay / 3600;
+    pBrokenDown->minute = (secondOfDay % 3600) / 60;
+    pBrokenDown->second = secondOfDay % 60;
+    // 1st January 1970 was a Thursday
+    pBrokenDown->weekDay = (int32_t) (days - (floorDiv(days + 4, 7) * 7) + 4);
+    pBrokenDown->yearDay = (int32_t) (days - uTimeDaysFromCivil(pBrokenDown->year, 1, 1));
+}
+
+void uTimeHostSetUtcMs(int64_t timeUtcMs, int32_t accuracyMs)
 {
-    int64_t secondsUtc = 0;
-
-    for (int32_t x = 0; x < monthsUtc; x++) {
-        if (uTimeIsLeapYear((x / 12) + 1970)) {
-            secondsUtc += gDaysInMonthLeapYear[x % 12] * 3600 * 24;
-        } else {
-            secondsUtc += gDaysInMonth[x % 12] * 3600 * 24;
-        }
+    gHostOffsetUs = (timeUtcMs * 1000) - uPortGetTickTimeUs();
+    gHostAccuracyMs = (accuracyMs >= 0) ? accuracyMs : 0;
+}
+
+int64_t uTimeHostGetUtcMs(int32_t *pAccuracyMs)
+{
+    int64_t timeUtcMs = -1;
+
+    if (gHostAccuracyMs >= 0) {
+        timeUtcMs = (uPortGetTickTimeUs() + gHostOffsetUs) / 1000;
+    }
+    if (pAccuracyMs != NULL) {
+        *pAccuracyMs = gHostAccuracyMs;
     }
 
-    return secondsUtc;
+    return timeUtcMs;
 }
 
 // End of file
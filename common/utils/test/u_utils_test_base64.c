@@ -0,0 +1,256 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Test for the base 64 API: checks that the streaming
+ * encode/decode gives the same answer as the one-shot functions.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdlib.h"    // rand()
+#include "string.h"    // memcmp()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+
+#include "u_base64.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_BASE64_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_TEST_UTILS_BASE64_MAX_LENGTH_BYTES
+/** The longest binary data to encode; every length from zero up
+ * to this is tried, so all of the possible tails are covered.
+ */
+# define U_TEST_UTILS_BASE64_MAX_LENGTH_BYTES 100
+#endif
+
+#ifndef U_TEST_UTILS_BASE64_ITERATIONS
+/** The number of times to encode/decode each length, each time
+ * with different random piece sizes.
+ */
+# define U_TEST_UTILS_BASE64_ITERATIONS 10
+#endif
+
+/** Room for the base 64 encoding of the longest binary data.
+ */
+#define U_TEST_UTILS_BASE64_ENCODED_LENGTH_BYTES \
+    (((U_TEST_UTILS_BASE64_MAX_LENGTH_BYTES + 2) / 3) * 4)
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The binary data to encode.
+ */
+static char gBinary[U_TEST_UTILS_BASE64_MAX_LENGTH_BYTES];
+
+/** The one-shot encoding of gBinary.
+ */
+static char gBase64[U_TEST_UTILS_BASE64_ENCODED_LENGTH_BYTES];
+
+/** The streamed encoding of gBinary.
+ */
+static char gBase64Streamed[U_TEST_UTILS_BASE64_ENCODED_LENGTH_BYTES];
+
+/** The one-shot decoding of gBase64.
+ */
+static char gDecoded[U_TEST_UTILS_BASE64_MAX_LENGTH_BYTES];
+
+/** The streamed decoding of gBase64.
+ */
+static char gDecodedStreamed[U_TEST_UTILS_BASE64_MAX_LENGTH_BYTES];
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Return a random piece size of at least one and at most remaining.
+static size_t pieceSize(size_t remaining)
+{
+    return ((size_t) rand() % remaining) + 1;
+}
+
+// Encode pBinary in random-sized pieces, returning the total
+// length of the base 64 written to pBase64.
+static int32_t encodeStreamed(const char *pBinary, size_t binaryLengthBytes,
+                              char *pBase64, size_t base64LengthBytes)
+{
+    uBase64Context_t context;
+    size_t offset = 0;
+    size_t length;
+    int32_t total = 0;
+    int32_t x;
+    int32_t y;
+
+    uBase64EncodeStart(&context);
+    while (offset < binaryLengthBytes) {
+        length = pieceSize(binaryLengthBytes - offset);
+        // Asking for the length only must not change the context
+        x = uBase64EncodeUpdate(&context, pBinary + offset, length, NULL, 0);
+        y = uBase64EncodeUpdate(&context, pBinary + offset, length,
+                                pBase64 + total, base64LengthBytes - total);
+        U_PORT_TEST_ASSERT(y >= 0);
+        U_PORT_TEST_ASSERT(y == x);
+        total += y;
+        offset += length;
+    }
+    x = uBase64EncodeFinish(&context, pBase64 + total, base64LengthBytes - total);
+    U_PORT_TEST_ASSERT(x >= 0);
+
+    return total + x;
+}
+
+// Decode pBase64 in random-sized pieces, returning the total
+// length of the binary written to pBinary.
+static int32_t decodeStreamed(const char *pBase64, size_t base64LengthBytes,
+                              char *pBinary, size_t binaryLengthBytes)
+{
+    uBase64Context_t context;
+    size_t offset = 0;
+    size_t length;
+    int32_t total = 0;
+    int32_t x;
+    int32_t y;
+
+    uBase64DecodeStart(&context);
+    while (offset < base64LengthBytes) {
+        length = pieceSize(base64LengthBytes - offset);
+        // Asking for the length only must not change the context
+        x = uBase64DecodeUpdate(&context, pBase64 + offset, length, NULL, 0);
+        y = uBase64DecodeUpdate(&context, pBase64 + offset, length,
+                                pBinary + total, binaryLengthBytes - total);
+        U_PORT_TEST_ASSERT(y >= 0);
+        U_PORT_TEST_ASSERT(y == x);
+        total += y;
+        offset += length;
+    }
+    x = uBase64DecodeFinish(&context, pBinary + total, binaryLengthBytes - total);
+    U_PORT_TEST_ASSERT(x >= 0);
+
+    return total + x;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Encode and decode every length of data up to
+ * U_TEST_UTILS_BASE64_MAX_LENGTH_BYTES, so that both the
+ * one and the two byte tails are covered, streaming it in
+ * random-sized pieces and comparing the outcome with that of
+ * uBase64Encode()/uBase64Decode().
+ */
+U_PORT_TEST_FUNCTION("[base64]", "base64Streaming")
+{
+    int32_t heapUsed;
+    int32_t encodedLength;
+    int32_t decodedLength;
+    int32_t x;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    for (size_t z = 0; z < sizeof(gBinary); z++) {
+        gBinary[z] = (char) rand();
+    }
+
+    U_TEST_PRINT_LINE("encoding/decoding 0 to %d byte(s), %d time(s) each.",
+                      U_TEST_UTILS_BASE64_MAX_LENGTH_BYTES,
+                      U_TEST_UTILS_BASE64_ITERATIONS);
+    for (size_t length = 0; length <= sizeof(gBinary); length++) {
+        encodedLength = uBase64Encode(gBinary, length, gBase64, sizeof(gBase64));
+        U_PORT_TEST_ASSERT(encodedLength == (int32_t) (((length + 2) / 3) * 4));
+        // The tail of one or two bytes must be padded
+        if (length % 3 == 1) {
+            U_PORT_TEST_ASSERT(memcmp(gBase64 + encodedLength - 2, "==", 2) == 0);
+        } else if (length % 3 == 2) {
+            U_PORT_TEST_ASSERT(gBase64[encodedLength - 1] == '=');
+            U_PORT_TEST_ASSERT(gBase64[encodedLength - 2] != '=');
+        }
+        decodedLength = uBase64Decode(gBase64, encodedLength, gDecoded, sizeof(gDecoded));
+        U_PORT_TEST_ASSERT(decodedLength == (int32_t) length);
+        U_PORT_TEST_ASSERT(memcmp(gDecoded, gBinary, length) == 0);
+        for (size_t y = 0; y < U_TEST_UTILS_BASE64_ITERATIONS; y++) {
+            x = encodeStreamed(gBinary, length, gBase64Streamed, sizeof(gBase64Streamed));
+            if ((x != encodedLength) || (memcmp(gBase64Streamed, gBase64, x) != 0)) {
+                U_TEST_PRINT_LINE("streamed encode of %d byte(s) gave %d byte(s),"
+                                  " expected %d byte(s).", (int) length, x, encodedLength);
+                //lint -e(774) suppress always true
+                U_PORT_TEST_ASSERT(false);
+            }
+            x = decodeStreamed(gBase64, encodedLength, gDecodedStreamed,
+                               sizeof(gDecodedStreamed));
+            if ((x != decodedLength) || (memcmp(gDecodedStreamed, gDecoded, x) != 0)) {
+                U_TEST_PRINT_LINE("streamed decode of %d byte(s) gave %d byte(s),"
+                                  " expected %d byte(s).", encodedLength, x,
+                                  decodedLength);
+                //lint -e(774) suppress always true
+                U_PORT_TEST_ASSERT(false);
+            }
+        }
+    }
+
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+// End of file
@@ -0,0 +1,446 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Micro-benchmarks for the utilities and protocol codecs:
+ * these don't pass or fail on speed, they print one line per
+ * function measured, of the form:
+ *
+ * U_BENCHMARK,<name>,<bytes per op>,<ops>,<ms>,<ops per second>,<kbytes per second>,<cycles per byte>
+ *
+ * ...so that the results can be picked out of the test log (grep for
+ * "U_BENCHMARK,") and compared between releases.  Cycles per byte is
+ * given to two decimal places and only if U_CFG_TEST_BENCHMARK_CPU_HZ
+ * is defined to the clock rate of the processor, otherwise it is -1.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcmp(), memset()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+
+#include "u_ringbuffer.h"
+#include "u_base64.h"
+#include "u_hex_bin_convert.h"
+#include "u_ubx_protocol.h"
+#include "u_spartn_crc.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_UTILS_BENCHMARK_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_UTILS_TEST_BENCHMARK_DURATION_MS
+/** How long to run each benchmark for.
+ */
+# define U_UTILS_TEST_BENCHMARK_DURATION_MS 250
+#endif
+
+#ifndef U_UTILS_TEST_BENCHMARK_DATA_LENGTH_BYTES
+/** The size of the block of data that each operation works on.
+ */
+# define U_UTILS_TEST_BENCHMARK_DATA_LENGTH_BYTES 256
+#endif
+
+/** The number of operations between looks at the clock.
+ */
+#define U_UTILS_TEST_BENCHMARK_BATCH 16
+
+/** Room for the largest output of any benchmark: hex is twice
+ * the size of the input.
+ */
+#define U_UTILS_TEST_BENCHMARK_BUFFER_LENGTH_BYTES (U_UTILS_TEST_BENCHMARK_DATA_LENGTH_BYTES * 2 + \
+                                                    U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES)
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The data that a benchmark works on.
+ */
+typedef struct {
+    char *pIn;            /**< the input data. */
+    size_t inLength;      /**< the amount of input data. */
+    char *pOut;           /**< somewhere to put the output. */
+    size_t outLength;     /**< the amount of storage at pOut. */
+    uRingBuffer_t *pRingBuffer;
+} uUtilsTestBenchmarkData_t;
+
+/** A benchmark: performs one operation, returning false on failure.
+ */
+typedef bool (*uUtilsTestBenchmarkFunction_t)(uUtilsTestBenchmarkData_t *pData);
+
+/** Where a benchmark gets its input from.
+ */
+typedef enum {
+    U_UTILS_TEST_BENCHMARK_INPUT_FRESH,           /**< a block of test data. */
+    U_UTILS_TEST_BENCHMARK_INPUT_PREVIOUS_OUTPUT, /**< the output of the
+                                                       previous benchmark. */
+    U_UTILS_TEST_BENCHMARK_INPUT_PREVIOUS_INPUT   /**< the same input as the
+                                                       previous benchmark. */
+} uUtilsTestBenchmarkInput_t;
+
+/** A benchmark.
+ */
+typedef struct {
+    const char *pName;
+    uUtilsTestBenchmarkFunction_t pFunction;
+    uUtilsTestBenchmarkInput_t input;
+    size_t (*pOutputLength)(size_t inLength); /**< returns the amount of output
+                                                   for the given amount of input,
+                                                   required where the output is
+                                                   the input of the next benchmark. */
+} uUtilsTestBenchmark_t;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: THE BENCHMARKS
+ * -------------------------------------------------------------- */
+
+static bool benchmarkRingBufferAddRead(uUtilsTestBenchmarkData_t *pData)
+{
+    return uRingBufferAdd(pData->pRingBuffer, pData->pIn, pData->inLength) &&
+           (uRingBufferRead(pData->pRingBuffer, pData->pOut,
+                            pData->outLength) == pData->inLength);
+}
+
+// A parser that finds UBX messages, for the ring buffer parse benchmark.
+static int32_t parseUbx(uParseHandle_t parseHandle, void *pUserParam)
+{
+    const char *pSpan;
+    size_t spanLength;
+    size_t length;
+    uint8_t cka = 0;
+    uint8_t ckb = 0;
+    uint8_t header[4];
+    uint8_t ck[2];
+
+    (void) pUserParam;
+    if (!uRingBufferSyncUnprotected(parseHandle, (char) 0xb5)) {
+        return (int32_t) U_ERROR_COMMON_NOT_FOUND;
+    }
+    if (!uRingBufferGetByteUnprotected(parseHandle, header) || (header[0] != 0x62)) {
+        return (int32_t) U_ERROR_COMMON_NOT_FOUND;
+    }
+    if (uRingBufferBytesAvailableUnprotected(parseHandle) < sizeof(header)) {
+        return (int32_t) U_ERROR_COMMON_TIMEOUT;
+    }
+    for (size_t x = 0; x < sizeof(header); x++) {
+        uRingBufferGetByteUnprotected(parseHandle, header + x);
+        cka += header[x];
+        ckb += cka;
+    }
+    length = header[2] + (((size_t) header[3]) << 8);
+    if (uRingBufferBytesAvailableUnprotected(parseHandle) < length + sizeof(ck)) {
+        return (int32_t) U_ERROR_COMMON_TIMEOUT;
+    }
+    while (length > 0) {
+        spanLength = uRingBufferGetSpanUnprotected(parseHandle, &pSpan, length);
+        length -= spanLength;
+        while (spanLength--) {
+            cka += (uint8_t) *pSpan++;
+            ckb += cka;
+        }
+    }
+    uRingBufferGetByteUnprotected(parseHandle, ck);
+    uRingBufferGetByteUnprotected(parseHandle, ck + 1);
+    if ((ck[0] != cka) || (ck[1] != ckb)) {
+        return (int32_t) U_ERROR_COMMON_NOT_FOUND;
+    }
+    return (int32_t) U_ERROR_COMMON_SUCCESS;
+}
+
+static bool benchmarkRingBufferParseHandle(uUtilsTestBenchmarkData_t *pData)
+{
+    U_RING_BUFFER_PARSER_f parserList[] = {parseUbx, NULL};
+
+    return uRingBufferAdd(pData->pRingBuffer, pData->pIn, pData->inLength) &&
+           (uRingBufferParseHandle(pData->pRingBuffer, 0, parserList,
+                                   NULL) == pData->inLength) &&
+           (uRingBufferRead(pData->pRingBuffer, NULL, pData->inLength) == pData->inLength);
+}
+
+static bool benchmarkBase64Encode(uUtilsTestBenchmarkData_t *pData)
+{
+    return uBase64Encode(pData->pIn, pData->inLength,
+                         pData->pOut, pData->outLength) > 0;
+}
+
+static bool benchmarkBase64Decode(uUtilsTestBenchmarkData_t *pData)
+{
+    return uBase64Decode(pData->pIn, pData->inLength,
+                         pData->pOut, pData->outLength) > 0;
+}
+
+static bool benchmarkBinToHex(uUtilsTestBenchmarkData_t *pData)
+{
+    return uBinToHex(pData->pIn, pData->inLength,
+                     pData->pOut) == pData->inLength * 2;
+}
+
+static bool benchmarkHexToBin(uUtilsTestBenchmarkData_t *pData)
+{
+    return uHexToBin(pData->pIn, pData->inLength,
+                     pData->pOut) == pData->inLength / 2;
+}
+
+static bool benchmarkUbxProtocolEncode(uUtilsTestBenchmarkData_t *pData)
+{
+    return uUbxProtocolEncode(0x01, 0x02, pData->pIn, pData->inLength,
+                              pData->pOut) == (int32_t) (pData->inLength +
+                                                         U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+}
+
+static bool benchmarkUbxProtocolDecode(uUtilsTestBenchmarkData_t *pData)
+{
+    int32_t messageClass;
+    int32_t messageId;
+
+    return uUbxProtocolDecode(pData->pIn, pData->inLength,
+                              &messageClass, &messageId,
+                              pData->pOut, pData->outLength,
+                              NULL) == (int32_t) (pData->inLength - U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+}
+
+static bool benchmarkSpartnCrc4(uUtilsTestBenchmarkData_t *pData)
+{
+    // Store the result so that the call can't be optimised out
+    *pData->pOut = (char) uSpartnCrc4(pData->pIn, pData->inLength);
+    return true;
+}
+
+static bool benchmarkSpartnCrc8(uUtilsTestBenchmarkData_t *pData)
+{
+    *pData->pOut = (char) uSpartnCrc8(pData->pIn, pData->inLength);
+    return true;
+}
+
+static bool benchmarkSpartnCrc16(uUtilsTestBenchmarkData_t *pData)
+{
+    *pData->pOut = (char) uSpartnCrc16(pData->pIn, pData->inLength);
+    return true;
+}
+
+static bool benchmarkSpartnCrc24(uUtilsTestBenchmarkData_t *pData)
+{
+    *pData->pOut = (char) uSpartnCrc24(pData->pIn, pData->inLength);
+    return true;
+}
+
+static bool benchmarkSpartnCrc32(uUtilsTestBenchmarkData_t *pData)
+{
+    *pData->pOut = (char) uSpartnCrc32(pData->pIn, pData->inLength);
+    return true;
+}
+
+static size_t base64Length(size_t inLength)
+{
+    return (size_t) uBase64Encode(NULL, inLength, NULL, 0);
+}
+
+static size_t hexLength(size_t inLength)
+{
+    return inLength * 2;
+}
+
+static size_t ubxLength(size_t inLength)
+{
+    return inLength + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES;
+}
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The benchmarks, in the order they are run.
+ */
+static const uUtilsTestBenchmark_t gBenchmark[] = {
+    {"uRingBufferAdd+Read", benchmarkRingBufferAddRead, U_UTILS_TEST_BENCHMARK_INPUT_FRESH, NULL},
+    {"uBase64Encode", benchmarkBase64Encode, U_UTILS_TEST_BENCHMARK_INPUT_FRESH, base64Length},
+    {"uBase64Decode", benchmarkBase64Decode, U_UTILS_TEST_BENCHMARK_INPUT_PREVIOUS_OUTPUT, NULL},
+    {"uBinToHex", benchmarkBinToHex, U_UTILS_TEST_BENCHMARK_INPUT_FRESH, hexLength},
+    {"uHexToBin", benchmarkHexToBin, U_UTILS_TEST_BENCHMARK_INPUT_PREVIOUS_OUTPUT, NULL},
+    {"uUbxProtocolEncode", benchmarkUbxProtocolEncode, U_UTILS_TEST_BENCHMARK_INPUT_FRESH, ubxLength},
+    {"uUbxProtocolDecode", benchmarkUbxProtocolDecode, U_UTILS_TEST_BENCHMARK_INPUT_PREVIOUS_OUTPUT, NULL},
+    {"uRingBufferParseHandle", benchmarkRingBufferParseHandle, U_UTILS_TEST_BENCHMARK_INPUT_PREVIOUS_INPUT, NULL},
+    {"uSpartnCrc4", benchmarkSpartnCrc4, U_UTILS_TEST_BENCHMARK_INPUT_FRESH, NULL},
+    {"uSpartnCrc8", benchmarkSpartnCrc8, U_UTILS_TEST_BENCHMARK_INPUT_FRESH, NULL},
+    {"uSpartnCrc16", benchmarkSpartnCrc16, U_UTILS_TEST_BENCHMARK_INPUT_FRESH, NULL},
+    {"uSpartnCrc24", benchmarkSpartnCrc24, U_UTILS_TEST_BENCHMARK_INPUT_FRESH, NULL},
+    {"uSpartnCrc32", benchmarkSpartnCrc32, U_UTILS_TEST_BENCHMARK_INPUT_FRESH, NULL}
+};
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: MISC
+ * -------------------------------------------------------------- */
+
+// Run a benchmark for U_UTILS_TEST_BENCHMARK_DURATION_MS and print
+// the result, returning false if the benchmark failed.
+static bool run(const uUtilsTestBenchmark_t *pBenchmark,
+                uUtilsTestBenchmarkData_t *pData)
+{
+    bool success = true;
+    int32_t ops = 0;
+    int32_t durationMs;
+    int32_t startTimeMs;
+    int32_t cyclesPerByteX100 = -1;
+    int64_t bytes;
+
+    startTimeMs = uPortGetTickTimeMs();
+    do {
+        for (size_t x = 0; (x < U_UTILS_TEST_BENCHMARK_BATCH) && success; x++) {
+            success = pBenchmark->pFunction(pData);
+        }
+        ops += U_UTILS_TEST_BENCHMARK_BATCH;
+        durationMs = uPortGetTickTimeMs() - startTimeMs;
+    } while (success && (durationMs < U_UTILS_TEST_BENCHMARK_DURATION_MS));
+
+    if (success) {
+        if (durationMs <= 0) {
+            durationMs = 1;
+        }
+        bytes = ((int64_t) ops) * pData->inLength;
+#ifdef U_CFG_TEST_BENCHMARK_CPU_HZ
+        cyclesPerByteX100 = (int32_t) ((((int64_t) U_CFG_TEST_BENCHMARK_CPU_HZ) *
+                                        durationMs / 10) / bytes);
+#endif
+        uPortLog("U_BENCHMARK,%s,%d,%d,%d,%d,%d,", pBenchmark->pName,
+                 (int32_t) pData->inLength, ops, durationMs,
+                 (int32_t) ((((int64_t) ops) * 1000) / durationMs),
+                 (int32_t) (bytes / durationMs));
+        if (cyclesPerByteX100 >= 0) {
+            uPortLog("%d.%02d\n", cyclesPerByteX100 / 100, cyclesPerByteX100 % 100);
+        } else {
+            uPortLog("-1\n");
+        }
+    } else {
+        U_TEST_PRINT_LINE("benchmark \"%s\" failed after %d operation(s).",
+                          pBenchmark->pName, ops);
+    }
+
+    return success;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TESTS
+ * -------------------------------------------------------------- */
+
+/** Run the benchmarks.
+ */
+U_PORT_TEST_FUNCTION("[utilsBenchmark]", "utilsBenchmarkCodecs")
+{
+    int32_t heapUsed;
+    uRingBuffer_t ringBuffer;
+    char *pLinearBuffer;
+    char *pBuffer[2];
+    uUtilsTestBenchmarkData_t data;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+
+    // Two buffers, each of which is alternately input and output
+    pBuffer[0] = (char *) pUPortMalloc(U_UTILS_TEST_BENCHMARK_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(pBuffer[0] != NULL);
+    pBuffer[1] = (char *) pUPortMalloc(U_UTILS_TEST_BENCHMARK_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(pBuffer[1] != NULL);
+    // Room for the largest input plus one, since a ring
+    // buffer can't be completely filled
+    pLinearBuffer = (char *) pUPortMalloc(U_UTILS_TEST_BENCHMARK_BUFFER_LENGTH_BYTES + 1);
+    U_PORT_TEST_ASSERT(pLinearBuffer != NULL);
+    U_PORT_TEST_ASSERT(uRingBufferCreate(&ringBuffer, pLinearBuffer,
+                                         U_UTILS_TEST_BENCHMARK_BUFFER_LENGTH_BYTES + 1) == 0);
+
+    U_TEST_PRINT_LINE("running each benchmark for %d ms on blocks of %d byte(s),"
+                      " results are lines beginning \"U_BENCHMARK,\".",
+                      U_UTILS_TEST_BENCHMARK_DURATION_MS,
+                      U_UTILS_TEST_BENCHMARK_DATA_LENGTH_BYTES);
+    uPortLog("U_BENCHMARK,name,bytes/op,ops,ms,ops/s,kbytes/s,cycles/byte\n");
+
+    memset(&data, 0, sizeof(data));
+    data.pRingBuffer = &ringBuffer;
+    for (size_t y = 0; y < sizeof(gBenchmark) / sizeof(gBenchmark[0]); y++) {
+        switch (gBenchmark[y].input) {
+            case U_UTILS_TEST_BENCHMARK_INPUT_PREVIOUS_OUTPUT:
+                // Work on what the last benchmark produced
+                U_PORT_TEST_ASSERT(gBenchmark[y - 1].pOutputLength != NULL);
+                data.inLength = gBenchmark[y - 1].pOutputLength(data.inLength);
+                data.pIn = data.pOut;
+                break;
+            case U_UTILS_TEST_BENCHMARK_INPUT_PREVIOUS_INPUT:
+                break;
+            default:
+                data.pIn = pBuffer[0];
+                data.inLength = U_UTILS_TEST_BENCHMARK_DATA_LENGTH_BYTES;
+                for (size_t z = 0; z < data.inLength; z++) {
+                    *(data.pIn + z) = (char) (z * 7);
+                }
+                break;
+        }
+        data.pOut = (data.pIn == pBuffer[0]) ? pBuffer[1] : pBuffer[0];
+        data.outLength = U_UTILS_TEST_BENCHMARK_BUFFER_LENGTH_BYTES;
+        U_PORT_TEST_ASSERT(run(&(gBenchmark[y]), &data));
+        // Give any watchdog a bone
+        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+    }
+
+    uRingBufferDelete(&ringBuffer);
+    uPortFree(pLinearBuffer);
+    uPortFree(pBuffer[1]);
+    uPortFree(pBuffer[0]);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
+// End of file
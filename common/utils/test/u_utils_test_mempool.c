@@ -227,4 +227,77 @@ U_PORT_TEST_FUNCTION("[mempool]", "mempoolFreeAllMem")
 
 }
 
-// End of file
\ No newline at end of file
+U_PORT_TEST_FUNCTION("[mempool]", "mempoolSlab")
+{
+    int32_t errCode;
+    uMemPoolSlab_t slab;
+    const uMemPoolSlabSize_t sizes[] = {{TEST_BLOCK_SIZE / 2, 2},
+        {TEST_BLOCK_SIZE, TEST_BLOCK_COUNT}
+    };
+    const uMemPoolSlabSize_t badSizes[] = {{TEST_BLOCK_SIZE, 1},
+        {TEST_BLOCK_SIZE / 2, 1}
+    };
+    uint8_t *pBuf[TEST_BLOCK_COUNT + 2];
+    int32_t heapUsed;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_TEST_PRINT_LINE("heap used at start %d.", heapUsed);
+
+    // Sizes must be in ascending order
+    errCode = uMemPoolSlabInit(&slab, badSizes, sizeof(badSizes) / sizeof(badSizes[0]));
+    U_PORT_TEST_ASSERT(errCode == U_ERROR_COMMON_INVALID_PARAMETER);
+
+    errCode = uMemPoolSlabInit(&slab, sizes, sizeof(sizes) / sizeof(sizes[0]));
+    U_PORT_TEST_ASSERT(errCode == U_ERROR_COMMON_SUCCESS);
+
+    // Too big
+    U_PORT_TEST_ASSERT(uMemPoolSlabAllocMem(&slab, TEST_BLOCK_SIZE + 1) == NULL);
+    U_PORT_TEST_ASSERT(slab.pool[0].pBuffer == NULL);
+    U_PORT_TEST_ASSERT(slab.pool[1].pBuffer == NULL);
+
+    // Small allocations come from the small pool until it is
+    // exhausted, then from the larger pool, until that is exhausted
+    for (int32_t i = 0; i < TEST_BLOCK_COUNT + 2; i++) {
+        pBuf[i] = (uint8_t *)uMemPoolSlabAllocMem(&slab, 1);
+        U_PORT_TEST_ASSERT(pBuf[i] != NULL);
+        U_PORT_TEST_ASSERT(((uintptr_t) pBuf[i] & (sizeof(void *) - 1)) == 0);
+        memset(pBuf[i], i, 1);
+    }
+    U_PORT_TEST_ASSERT(slab.pool[0].usedBlockCount == 2);
+    U_PORT_TEST_ASSERT(slab.pool[1].usedBlockCount == TEST_BLOCK_COUNT);
+    U_PORT_TEST_ASSERT(uMemPoolSlabAllocMem(&slab, 1) == NULL);
+    U_PORT_TEST_ASSERT(slab.pool[1].allocFailCount == 1);
+
+    // Free them all and check the high-water marks
+    for (int32_t i = 0; i < TEST_BLOCK_COUNT + 2; i++) {
+        U_PORT_TEST_ASSERT(*pBuf[i] == (uint8_t) i);
+        uMemPoolSlabFreeMem(&slab, (void *)pBuf[i]);
+    }
+    U_PORT_TEST_ASSERT(slab.pool[0].usedBlockCount == 0);
+    U_PORT_TEST_ASSERT(slab.pool[1].usedBlockCount == 0);
+    U_PORT_TEST_ASSERT(slab.pool[0].peakUsedBlockCount == 2);
+    U_PORT_TEST_ASSERT(slab.pool[1].peakUsedBlockCount == TEST_BLOCK_COUNT);
+
+    // A larger allocation comes from the larger pool
+    pBuf[0] = (uint8_t *)uMemPoolSlabAllocMem(&slab, TEST_BLOCK_SIZE);
+    U_PORT_TEST_ASSERT(pBuf[0] != NULL);
+    U_PORT_TEST_ASSERT(slab.pool[1].usedBlockCount == 1);
+    memset(pBuf[0], 0xAA, TEST_BLOCK_SIZE);
+    uMemPoolSlabFreeMem(&slab, (void *)pBuf[0]);
+    uMemPoolSlabFreeMem(&slab, NULL);
+
+    uMemPoolSlabDeinit(&slab);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
+// End of file
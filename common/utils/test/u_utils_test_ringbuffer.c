@@ -83,6 +83,14 @@
  * VARIABLES
  * -------------------------------------------------------------- */
 
+/** Count of watermark notifications received by notifyCallback().
+ */
+static int32_t gNotifyWatermarkCount = 0;
+
+/** Count of lagging notifications received by notifyCallback().
+ */
+static int32_t gNotifyLaggingCount = 0;
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -107,10 +115,76 @@ static void printBuffer(const char *pTitle, const char *pStr, size_t length)
     uPortTaskBlock(10);
 }
 
+// A parser for the test: a message is 'A' followed by three bytes
+// that sum to the value of the fourth.  The parser carries on from
+// where it left off if the message is incomplete and, if pUserParam
+// is not NULL, it is taken as a pointer to a size_t which is
+// incremented by the number of bytes examined.
+static int32_t parseTest(uParseHandle_t parseHandle, void *pUserParam)
+{
+    char *pState = (char *) pURingBufferParserStateUnprotected(parseHandle);
+    size_t *pBytesExamined = (size_t *) pUserParam;
+    const char *pSpan;
+    size_t spanLength;
+    char c;
+
+    // pState[0] is the phase, pState[1] the number of bytes
+    // left to sum and pState[2] the sum so far
+    if (pState[0] == 0) {
+        if (!uRingBufferSyncUnprotected(parseHandle, 'A')) {
+            return (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        }
+        if (pBytesExamined != NULL) {
+            (*pBytesExamined)++;
+        }
+        pState[0] = 1;
+        pState[1] = 3;
+    }
+    while (pState[1] > 0) {
+        spanLength = uRingBufferGetSpanUnprotected(parseHandle, &pSpan, pState[1]);
+        if (spanLength == 0) {
+            return (int32_t) U_ERROR_COMMON_TIMEOUT;
+        }
+        if (pBytesExamined != NULL) {
+            *pBytesExamined += spanLength;
+        }
+        pState[1] = (char) (pState[1] - spanLength);
+        while (spanLength--) {
+            pState[2] = (char) (pState[2] + *pSpan++);
+        }
+    }
+    if (!uRingBufferGetByteUnprotected(parseHandle, &c)) {
+        return (int32_t) U_ERROR_COMMON_TIMEOUT;
+    }
+    if (pBytesExamined != NULL) {
+        (*pBytesExamined)++;
+    }
+    if (c != pState[2]) {
+        return (int32_t) U_ERROR_COMMON_NOT_FOUND;
+    }
+    return (int32_t) U_ERROR_COMMON_SUCCESS;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: TESTS
  * -------------------------------------------------------------- */
 
+// Notification callback, counts notifications of each type
+// for the read handle passed in as the parameter.
+static void notifyCallback(uRingBuffer_t *pRingBuffer, int32_t handle,
+                           uRingBufferNotify_t notify, void *pCallbackParam)
+{
+    (void) pRingBuffer;
+
+    if (handle == *((int32_t *) pCallbackParam)) {
+        if (notify == U_RING_BUFFER_NOTIFY_WATERMARK) {
+            gNotifyWatermarkCount++;
+        } else if (notify == U_RING_BUFFER_NOTIFY_LAGGING) {
+            gNotifyLaggingCount++;
+        }
+    }
+}
+
 U_PORT_TEST_FUNCTION("[ringbuffer]", "ringbufferBasic")
 {
     int32_t heapUsed;
@@ -123,8 +197,12 @@ U_PORT_TEST_FUNCTION("[ringbuffer]", "ringbufferBasic")
     size_t readLoss = 0;
     size_t readLossHandle[U_TEST_UTILS_RINGBUFFER_READ_HANDLES_MAX_NUM] = {0};
     char b = ~U_TEST_UTILS_RINGBUFFER_FILL_CHAR;
+    char *pReserve = NULL;
+    uRingBufferSpan_t span[2];
+    U_RING_BUFFER_PARSER_f parserList[] = {parseTest, NULL};
     size_t y;
     size_t z;
+    int32_t notifyHandle;
 
     // Whatever called us likely initialised the
     // port so deinitialise it here to obtain the
@@ -874,6 +952,178 @@ U_PORT_TEST_FUNCTION("[ringbuffer]", "ringbufferBasic")
     U_TEST_PRINT_LINE("deleting ring buffer...");
     uRingBufferDelete(&ringBuffer);
 
+    // Now the SPSC version, wrapping around the end of the buffer
+    U_TEST_PRINT_LINE("testing SPSC version...");
+    memset(&ringBuffer, 0, sizeof(ringBuffer));
+    memset(linearBuffer, 0, sizeof(linearBuffer));
+    U_PORT_TEST_ASSERT(uRingBufferCreateSpsc(&ringBuffer, linearBuffer, sizeof(linearBuffer)) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSize(&ringBuffer) == sizeof(linearBuffer) - 1);
+    U_PORT_TEST_ASSERT(uRingBufferTakeReadHandle(&ringBuffer) < 0);
+    // Full, then one more should fail and be counted
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, sizeof(bufferIn) - 1));
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSize(&ringBuffer) == 0);
+    U_PORT_TEST_ASSERT(!uRingBufferAdd(&ringBuffer, bufferIn, 1));
+    U_PORT_TEST_ASSERT(!uRingBufferForceAdd(&ringBuffer, bufferIn, 1));
+    U_PORT_TEST_ASSERT(uRingBufferStatAddLoss(&ringBuffer) == 2);
+    // Read some out, add some more so that it wraps
+    y = sizeof(bufferIn) / 2;
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, bufferOut, y) == y);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn, y) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, y));
+    z = sizeof(bufferIn) - 1;
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == z);
+    // Peek across the wrap then read everything out
+    memset(bufferOut, U_TEST_UTILS_RINGBUFFER_FILL_CHAR, sizeof(bufferOut));
+    U_PORT_TEST_ASSERT(uRingBufferPeek(&ringBuffer, bufferOut, y, z - y) == y);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn, y) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferPeek(&ringBuffer, bufferOut, 1, z) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, bufferOut, sizeof(bufferOut)) == z);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn + y, z - y) == 0);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut + z - y, bufferIn, y) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSize(&ringBuffer) == sizeof(linearBuffer) - 1);
+    // Flush
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, y));
+    uRingBufferFlush(&ringBuffer);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 0);
+    U_TEST_PRINT_LINE("deleting ring buffer...");
+    uRingBufferDelete(&ringBuffer);
+
+    // Reserve/commit and peek-span, with the write pointer part-way
+    // along so that both the reserve and the data wrap
+    U_TEST_PRINT_LINE("testing reserve/commit and peek-span...");
+    memset(&ringBuffer, 0, sizeof(ringBuffer));
+    U_PORT_TEST_ASSERT(uRingBufferCreate(&ringBuffer, linearBuffer, sizeof(linearBuffer)) == 0);
+    y = sizeof(bufferIn) / 2;
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, y));
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, NULL, y) == y);
+    z = uRingBufferReserve(&ringBuffer, &pReserve);
+    U_PORT_TEST_ASSERT(z == sizeof(linearBuffer) - y);
+    U_PORT_TEST_ASSERT(pReserve == linearBuffer + y);
+    memcpy(pReserve, bufferIn, z);
+    // Committing more than was reserved should fail
+    U_PORT_TEST_ASSERT(!uRingBufferCommit(&ringBuffer, z + 1));
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 0);
+    z = uRingBufferReserve(&ringBuffer, &pReserve);
+    U_PORT_TEST_ASSERT(uRingBufferCommit(&ringBuffer, z));
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == z);
+    // The remainder is at the start of the linear buffer
+    U_PORT_TEST_ASSERT(uRingBufferReserve(&ringBuffer, &pReserve) == y - 1);
+    U_PORT_TEST_ASSERT(pReserve == linearBuffer);
+    memcpy(pReserve, bufferIn + z, y - 1);
+    U_PORT_TEST_ASSERT(uRingBufferCommit(&ringBuffer, y - 1));
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSize(&ringBuffer) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferReserve(&ringBuffer, &pReserve) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferPeekSpan(&ringBuffer, span) == sizeof(linearBuffer) - 1);
+    U_PORT_TEST_ASSERT(span[0].pData == linearBuffer + y);
+    U_PORT_TEST_ASSERT(span[0].length == z);
+    U_PORT_TEST_ASSERT(span[1].pData == linearBuffer);
+    U_PORT_TEST_ASSERT(span[1].length == y - 1);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, bufferOut, sizeof(bufferOut)) == z + y - 1);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn, z + y - 1) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferPeekSpan(&ringBuffer, span) == 0);
+    U_PORT_TEST_ASSERT((span[0].length == 0) && (span[1].length == 0));
+
+    // Parse, with the message wrapping around the end of the buffer
+    // and junk, including a bad message, in front of it
+    U_TEST_PRINT_LINE("testing parsing...");
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, "xA\1\2x", 5));
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, "A\1\2\3\6", 5));
+    // uRingBufferParseHandle() returns the number of bytes to discard
+    U_PORT_TEST_ASSERT(uRingBufferParseHandle(&ringBuffer, 0, parserList, NULL) == 5);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, NULL, 5) == 5);
+    // ...and then the length of the message
+    U_PORT_TEST_ASSERT(uRingBufferParseHandle(&ringBuffer, 0, parserList, NULL) == 5);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, NULL, 5) == 5);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, "zA\1\2", 4));
+    // Incomplete
+    U_PORT_TEST_ASSERT(uRingBufferParseHandle(&ringBuffer, 0, parserList, NULL) == 1);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, NULL, 1) == 1);
+    U_PORT_TEST_ASSERT((int32_t) uRingBufferParseHandle(&ringBuffer, 0, parserList,
+                                                        NULL) == (int32_t) U_ERROR_COMMON_TIMEOUT);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, "\3\6", 2));
+    U_PORT_TEST_ASSERT(uRingBufferParseHandle(&ringBuffer, 0, parserList, NULL) == 5);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, NULL, 5) == 5);
+    // Add a message a byte at a time, with junk in front of it,
+    // and check that the parser picks up where it left off
+    // rather than examining the same bytes again
+    y = 0;
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, "zz", 2));
+    for (size_t x = 0; x < 4; x++) {
+        U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, "A\1\2\3" + x, 1));
+        U_PORT_TEST_ASSERT((int32_t) uRingBufferParseHandle(&ringBuffer, 0, parserList,
+                                                            &y) == 2);
+    }
+    U_PORT_TEST_ASSERT(y == 4);
+    // Junk in front of the message can go without losing the place
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, NULL, 2) == 2);
+    U_PORT_TEST_ASSERT((int32_t) uRingBufferParseHandle(&ringBuffer, 0, parserList,
+                                                        &y) == (int32_t) U_ERROR_COMMON_TIMEOUT);
+    U_PORT_TEST_ASSERT(y == 4);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, "\6", 1));
+    U_PORT_TEST_ASSERT(uRingBufferParseHandle(&ringBuffer, 0, parserList, &y) == 5);
+    U_PORT_TEST_ASSERT(y == 5);
+    // Reading into the message means starting again
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, NULL, 5) == 5);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, "A\1\1\1", 4));
+    U_PORT_TEST_ASSERT((int32_t) uRingBufferParseHandle(&ringBuffer, 0, parserList,
+                                                        NULL) == (int32_t) U_ERROR_COMMON_TIMEOUT);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, NULL, 1) == 1);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, "\3A\1\1\1\3", 6));
+    U_PORT_TEST_ASSERT(uRingBufferParseHandle(&ringBuffer, 0, parserList, NULL) == 4);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, NULL, 4) == 4);
+    U_PORT_TEST_ASSERT(uRingBufferParseHandle(&ringBuffer, 0, parserList, NULL) == 5);
+    U_TEST_PRINT_LINE("deleting ring buffer...");
+    uRingBufferDelete(&ringBuffer);
+
+    // Notifications, with a watermark of 4 bytes and lagging
+    // when there are fewer than 3 bytes of free space
+    U_TEST_PRINT_LINE("testing notifications...");
+    U_PORT_TEST_ASSERT(uRingBufferCreateWithReadHandle(&ringBuffer, linearBuffer, sizeof(linearBuffer),
+                                                       U_TEST_UTILS_RINGBUFFER_READ_HANDLES_MAX_NUM) == 0);
+    // So that the "normal" read pointer doesn't fill up
+    uRingBufferSetReadRequiresHandle(&ringBuffer, true);
+    notifyHandle = uRingBufferTakeReadHandle(&ringBuffer);
+    U_PORT_TEST_ASSERT(notifyHandle >= 0);
+    // Not a taken handle
+    U_PORT_TEST_ASSERT(uRingBufferSetNotifyHandle(&ringBuffer, notifyHandle + 1, 4, 3,
+                                                  notifyCallback, &notifyHandle) < 0);
+    U_PORT_TEST_ASSERT(uRingBufferSetNotifyHandle(&ringBuffer, notifyHandle, 4, 3,
+                                                  notifyCallback, &notifyHandle) == 0);
+    gNotifyWatermarkCount = 0;
+    gNotifyLaggingCount = 0;
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 3));
+    U_PORT_TEST_ASSERT((gNotifyWatermarkCount == 0) && (gNotifyLaggingCount == 0));
+    // Crossing the watermark
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 2));
+    U_PORT_TEST_ASSERT((gNotifyWatermarkCount == 1) && (gNotifyLaggingCount == 0));
+    // Above the watermark already, so no more
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 1));
+    U_PORT_TEST_ASSERT((gNotifyWatermarkCount == 1) && (gNotifyLaggingCount == 0));
+    // Now 6 bytes in, 4 free: take the free space down to 2
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 2));
+    U_PORT_TEST_ASSERT((gNotifyWatermarkCount == 1) && (gNotifyLaggingCount == 1));
+    // Read down below the watermark and add again: notified again
+    U_PORT_TEST_ASSERT(uRingBufferReadHandle(&ringBuffer, notifyHandle, NULL, 6) == 6);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 2));
+    U_PORT_TEST_ASSERT((gNotifyWatermarkCount == 2) && (gNotifyLaggingCount == 1));
+    // Fill the buffer with a forced add, losing data from the handle
+    gNotifyLaggingCount = 0;
+    U_PORT_TEST_ASSERT(uRingBufferForceAdd(&ringBuffer, bufferIn, U_TEST_UTILS_RINGBUFFER_SIZE));
+    U_PORT_TEST_ASSERT(uRingBufferStatReadLossHandle(&ringBuffer, notifyHandle) > 0);
+    U_PORT_TEST_ASSERT(gNotifyLaggingCount == 1);
+    // Switch notifications off
+    U_PORT_TEST_ASSERT(uRingBufferSetNotifyHandle(&ringBuffer, notifyHandle, 0, 0,
+                                                  NULL, NULL) == 0);
+    uRingBufferFlushHandle(&ringBuffer, notifyHandle);
+    gNotifyWatermarkCount = 0;
+    gNotifyLaggingCount = 0;
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, U_TEST_UTILS_RINGBUFFER_SIZE));
+    U_PORT_TEST_ASSERT((gNotifyWatermarkCount == 0) && (gNotifyLaggingCount == 0));
+    uRingBufferGiveReadHandle(&ringBuffer, notifyHandle);
+    uRingBufferDelete(&ringBuffer);
+
     // Check for memory leaks
     heapUsed -= uPortGetHeapFree();
     U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
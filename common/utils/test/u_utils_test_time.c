@@ -0,0 +1,203 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Test for the time API
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+
+#include "u_cfg_sw.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+
+#include "u_time.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_TIME_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_TEST_UTILS_TIME_START_YEAR
+/** The year to start the exhaustive day-by-day check from.
+ */
+# define U_TEST_UTILS_TIME_START_YEAR 1900
+#endif
+
+#ifndef U_TEST_UTILS_TIME_END_YEAR
+/** The year to end the exhaustive day-by-day check at,
+ * inclusive.
+ */
+# define U_TEST_UTILS_TIME_END_YEAR 2200
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A broken-down time and the UTC seconds it should map to.
+ */
+typedef struct {
+    uTimeBrokenDown_t brokenDown;
+    int64_t secondsUtc;
+} uTimeTestData_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Known times.
+ */
+static const uTimeTestData_t gTestData[] = {
+    {{1970,  1,  1,  0,  0,  0, 4,   0}, 0},
+    {{1969, 12, 31, 23, 59, 59, 3, 364}, -1},
+    {{2000,  2, 29, 12,  0,  0, 2,  59}, 951825600LL},
+    {{2038,  1, 19,  3, 14,  7, 2,  18}, 2147483647LL},
+    {{2038,  1, 19,  3, 14,  8, 2,  18}, 2147483648LL},
+    {{2100,  3,  1,  0,  0,  0, 1,  59}, 4107542400LL},
+    {{1900,  1,  1,  0,  0,  0, 1,   0}, -2208988800LL},
+    {{2023, 12, 31, 23, 59, 59, 0, 364}, 1704067199LL}
+};
+
+/** The number of days in each month of a non-leap year.
+ */
+static const int32_t gDaysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Test the time conversion functions.
+ */
+U_PORT_TEST_FUNCTION("[time]", "timeBasic")
+{
+    int32_t heapUsed;
+    uTimeBrokenDown_t brokenDown;
+    const uTimeBrokenDown_t *pExpected;
+    int64_t days;
+    int64_t daysExpected;
+    int32_t daysInMonth;
+    int32_t year;
+    int32_t month;
+    int32_t day;
+    int64_t timeUtcMs;
+    int32_t accuracyMs;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    U_TEST_PRINT_LINE("testing leap years.");
+    U_PORT_TEST_ASSERT(uTimeIsLeapYear(2000));
+    U_PORT_TEST_ASSERT(uTimeIsLeapYear(2024));
+    U_PORT_TEST_ASSERT(!uTimeIsLeapYear(2023));
+    U_PORT_TEST_ASSERT(!uTimeIsLeapYear(1900));
+    U_PORT_TEST_ASSERT(!uTimeIsLeapYear(2100));
+
+    U_TEST_PRINT_LINE("testing known times.");
+    for (size_t x = 0; x < sizeof(gTestData) / sizeof(gTestData[0]); x++) {
+        pExpected = &(gTestData[x].brokenDown);
+        U_PORT_TEST_ASSERT(uTimeBrokenDownToSecondsUtc(pExpected) == gTestData[x].secondsUtc);
+        uTimeSecondsUtcToBrokenDown(gTestData[x].secondsUtc, &brokenDown);
+        U_PORT_TEST_ASSERT(brokenDown.year == pExpected->year);
+        U_PORT_TEST_ASSERT(brokenDown.month == pExpected->month);
+        U_PORT_TEST_ASSERT(brokenDown.day == pExpected->day);
+        U_PORT_TEST_ASSERT(brokenDown.hour == pExpected->hour);
+        U_PORT_TEST_ASSERT(brokenDown.minute == pExpected->minute);
+        U_PORT_TEST_ASSERT(brokenDown.second == pExpected->second);
+        U_PORT_TEST_ASSERT(brokenDown.weekDay == pExpected->weekDay);
+        U_PORT_TEST_ASSERT(brokenDown.yearDay == pExpected->yearDay);
+    }
+
+    // Out of range fields carry
+    brokenDown.year = 2022;
+    brokenDown.month = 14;
+    brokenDown.day = 0;
+    brokenDown.hour = 24;
+    brokenDown.minute = 0;
+    brokenDown.second = 60;
+    U_PORT_TEST_ASSERT(uTimeBrokenDownToSecondsUtc(&brokenDown) ==
+                       uTimeDaysFromCivil(2023, 2, 1) * 3600 * 24 + 60);
+
+    U_TEST_PRINT_LINE("checking every day from %d to %d.",
+                      U_TEST_UTILS_TIME_START_YEAR, U_TEST_UTILS_TIME_END_YEAR);
+    daysExpected = uTimeDaysFromCivil(U_TEST_UTILS_TIME_START_YEAR, 1, 1);
+    for (int32_t y = U_TEST_UTILS_TIME_START_YEAR; y <= U_TEST_UTILS_TIME_END_YEAR; y++) {
+        // Months since 1970 must agree with the days
+        U_PORT_TEST_ASSERT(uTimeMonthsToSecondsUtc((y - 1970) * 12) == daysExpected * 3600 * 24);
+        for (int32_t m = 1; m <= 12; m++) {
+            daysInMonth = gDaysInMonth[m - 1];
+            if ((m == 2) && uTimeIsLeapYear(y)) {
+                daysInMonth++;
+            }
+            for (int32_t d = 1; d <= daysInMonth; d++) {
+                days = uTimeDaysFromCivil(y, m, d);
+                U_PORT_TEST_ASSERT(days == daysExpected);
+                uTimeCivilFromDays(days, &year, &month, &day);
+                U_PORT_TEST_ASSERT((year == y) && (month == m) && (day == d));
+                daysExpected++;
+            }
+        }
+    }
+
+    U_TEST_PRINT_LINE("checking the host clock.");
+    uTimeHostSetUtcMs(uTimeDaysFromCivil(2024, 3, 1) * 3600 * 24 * 1000, 5);
+    uPortTaskBlock(100);
+    timeUtcMs = uTimeHostGetUtcMs(&accuracyMs);
+    timeUtcMs -= uTimeDaysFromCivil(2024, 3, 1) * 3600 * 24 * 1000;
+    U_TEST_PRINT_LINE("host clock moved on by %d ms.", (int32_t) timeUtcMs);
+    U_PORT_TEST_ASSERT(accuracyMs == 5);
+    U_PORT_TEST_ASSERT((timeUtcMs >= 50) && (timeUtcMs < 1000));
+
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+// End of file
@@ -0,0 +1,115 @@
+#!/usr/bin/env python
+
+# Copyright 2019-2022 u-blox
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#  http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+'''Companion server for the sockets benchmark example, main_benchmark.c.
+
+Listens on the same port for TCP and UDP.
+
+TCP: the first line sent on a connection selects the workload:
+  "U <bytes>\\n": read <bytes>, then reply with "<bytes received>\\n",
+  "D <bytes> <chunk>\\n": send <bytes> in writes of <chunk>,
+  "E\\n": echo everything until the connection is closed.
+
+UDP: the first character of each datagram selects the workload:
+  'U': count the length of the datagram against the sender,
+  'C': reply with "<bytes counted>\\n" for the sender and reset the count,
+  'D': "D <bytes> <chunk>\\n", send <bytes> in datagrams of <chunk>,
+  'E': echo the datagram.
+'''
+
+import argparse
+import socket
+import socketserver
+import threading
+
+DEFAULT_PORT = 5070
+
+class TcpHandler(socketserver.StreamRequestHandler):
+    '''Handle one TCP connection.'''
+
+    def handle(self):
+        line = self.rfile.readline().decode("ascii", "replace").split()
+        if not line:
+            return
+        if line[0] == "U" and len(line) > 1:
+            remaining = int(line[1])
+            received = 0
+            while remaining > 0:
+                data = self.rfile.read1(min(remaining, 65536))
+                if not data:
+                    break
+                received += len(data)
+                remaining -= len(data)
+            self.wfile.write(f"{received}\n".encode("ascii"))
+        elif line[0] == "D" and len(line) > 2:
+            remaining = int(line[1])
+            chunk = b"D" * int(line[2])
+            while remaining > 0:
+                size = min(remaining, len(chunk))
+                self.wfile.write(chunk[:size])
+                remaining -= size
+        elif line[0] == "E":
+            while True:
+                data = self.request.recv(65536)
+                if not data:
+                    break
+                self.request.sendall(data)
+
+class ThreadedTcpServer(socketserver.ThreadingMixIn, socketserver.TCPServer):
+    '''A TCP server with a thread per connection.'''
+    allow_reuse_address = True
+    daemon_threads = True
+
+def udp_server(port):
+    '''Run the UDP side of the server, forever.'''
+    counts = {}
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(("", port))
+    while True:
+        data, address = sock.recvfrom(65536)
+        if not data:
+            continue
+        if data[:1] == b"U":
+            counts[address] = counts.get(address, 0) + len(data)
+        elif data[:1] == b"C":
+            sock.sendto(f"{counts.pop(address, 0)}\n".encode("ascii"), address)
+        elif data[:1] == b"D":
+            fields = data.decode("ascii", "replace").split()
+            if len(fields) > 2:
+                remaining = int(fields[1])
+                chunk = b"D" * int(fields[2])
+                while remaining > 0:
+                    size = min(remaining, len(chunk))
+                    sock.sendto(chunk[:size], address)
+                    remaining -= size
+        elif data[:1] == b"E":
+            sock.sendto(data, address)
+
+def main():
+    '''Entry point.'''
+    parser = argparse.ArgumentParser(description="Companion server for"
+                                     " the ubxlib sockets benchmark example.")
+    parser.add_argument("-p", "--port", type=int, default=DEFAULT_PORT,
+                        help=f"the TCP and UDP port to listen on, default {DEFAULT_PORT}.")
+    args = parser.parse_args()
+
+    threading.Thread(target=udp_server, args=(args.port,), daemon=True).start()
+    with ThreadedTcpServer(("", args.port), TcpHandler) as server:
+        print(f"Benchmark server listening on TCP and UDP port {args.port}.")
+        server.serve_forever()
+
+if __name__ == "__main__":
+    main()
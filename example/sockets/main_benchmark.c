@@ -0,0 +1,683 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @brief This example measures sockets throughput over a u-blox
+ * module: it brings up a network, opens a number of sockets to the
+ * companion server benchmark_server.py and runs upload, download and
+ * echo round-trip workloads, printing the results as a single line of
+ * JSON that begins with "BENCHMARK_JSON: ", so that results from
+ * different firmware versions, baud rates or configurations on the
+ * same hardware can be compared by a script.
+ *
+ * The choice of module and the choice of platform on which this
+ * code runs is made at build time, see the README.md for
+ * instructions.
+ */
+
+// Bring in all of the ubxlib public header files
+#include "ubxlib.h"
+
+// Bring in the application settings
+#include "u_cfg_app_platform_specific.h"
+
+// For U_SHORT_RANGE_TEST_WIFI()
+#include "u_short_range_test_selector.h"
+
+#ifndef U_CFG_DISABLE_TEST_AUTOMATION
+// This purely for internal u-blox testing
+# include "u_cfg_test_platform_specific.h"
+# include "u_wifi_test_cfg.h"
+#endif
+
+#include "stdlib.h"    // qsort()
+#include "stdio.h"     // snprintf()
+#include "string.h"    // memset(), strlen()
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef BENCHMARK_SERVER_NAME
+/** The host running benchmark_server.py; the benchmark is skipped
+ * if this is an empty string, since there is no public server.
+ */
+# define BENCHMARK_SERVER_NAME ""
+#endif
+
+#ifndef BENCHMARK_SERVER_PORT
+/** The port that benchmark_server.py listens on, for both TCP
+ * and UDP.
+ */
+# define BENCHMARK_SERVER_PORT 5070
+#endif
+
+#ifndef BENCHMARK_PROTOCOL
+/** The protocol to benchmark, U_SOCK_PROTOCOL_TCP or
+ * U_SOCK_PROTOCOL_UDP.
+ */
+# define BENCHMARK_PROTOCOL U_SOCK_PROTOCOL_TCP
+#endif
+
+#ifndef BENCHMARK_NUM_SOCKETS
+/** The number of sockets to run the upload and download workloads
+ * over at the same time.
+ */
+# define BENCHMARK_NUM_SOCKETS 2
+#endif
+
+#ifndef BENCHMARK_UPLOAD_BYTES
+/** The number of bytes to upload on each socket.
+ */
+# define BENCHMARK_UPLOAD_BYTES (32 * 1024)
+#endif
+
+#ifndef BENCHMARK_DOWNLOAD_BYTES
+/** The number of bytes to download on each socket.
+ */
+# define BENCHMARK_DOWNLOAD_BYTES (32 * 1024)
+#endif
+
+#ifndef BENCHMARK_CHUNK_SIZE
+/** The size of each write or read; for UDP this is the datagram
+ * size and so must be no larger than #U_SOCK_MAX_UDP_PACKET_SIZE.
+ */
+# define BENCHMARK_CHUNK_SIZE 1024
+#endif
+
+#ifndef BENCHMARK_RTT_COUNT
+/** The number of echo round trips to time.
+ */
+# define BENCHMARK_RTT_COUNT 20
+#endif
+
+#ifndef BENCHMARK_RTT_SIZE
+/** The size of each echo round trip.
+ */
+# define BENCHMARK_RTT_SIZE 32
+#endif
+
+#ifndef BENCHMARK_TIMEOUT_MS
+/** Give up on a workload if nothing has moved for this long.
+ */
+# define BENCHMARK_TIMEOUT_MS 10000
+#endif
+
+// For u-blox internal testing only
+#ifdef U_PORT_TEST_ASSERT
+# define EXAMPLE_FINAL_STATE(x) U_PORT_TEST_ASSERT(x);
+#else
+# define EXAMPLE_FINAL_STATE(x)
+#endif
+
+#ifndef U_PORT_TEST_FUNCTION
+# error if you are not using the unit test framework to run this code you must ensure that the platform clocks/RTOS are set up and either define U_PORT_TEST_FUNCTION yourself or replace it as necessary.
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The outcome of a throughput workload.
+ */
+typedef struct {
+    int32_t bytes;
+    int32_t durationMs;
+    int64_t cpuUs;
+} benchmarkResult_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+// Below is the module configuration
+// When U_CFG_TEST_CELL_MODULE_TYPE is set this example will setup a cellular
+// link using uNetworkConfigurationCell_t.
+// When U_CFG_TEST_SHORT_RANGE_MODULE_TYPE is set this example will instead use
+// uNetworkConfigurationWifi_t config to setup a Wifi connection.
+
+#if U_SHORT_RANGE_TEST_WIFI()
+
+// DEVICE i.e. module/chip configuration: in this case a short-range
+// module connected via UART
+static const uDeviceCfg_t gDeviceCfg = {
+    .deviceType = U_DEVICE_TYPE_SHORT_RANGE,
+    .deviceCfg = {
+        .cfgSho = {
+            .moduleType = U_CFG_TEST_SHORT_RANGE_MODULE_TYPE
+        },
+    },
+    .transportType = U_DEVICE_TRANSPORT_TYPE_UART,
+    .transportCfg = {
+        .cfgUart = {
+            .uart = U_CFG_APP_SHORT_RANGE_UART,
+            .baudRate = U_SHORT_RANGE_UART_BAUD_RATE,
+            .pinTxd = U_CFG_APP_PIN_SHORT_RANGE_TXD,
+            .pinRxd = U_CFG_APP_PIN_SHORT_RANGE_RXD,
+            .pinCts = U_CFG_APP_PIN_SHORT_RANGE_CTS,
+            .pinRts = U_CFG_APP_PIN_SHORT_RANGE_RTS
+        },
+    },
+};
+// NETWORK configuration for Wi-Fi
+static const uNetworkCfgWifi_t gNetworkCfg = {
+    .type = U_NETWORK_TYPE_WIFI,
+    .pSsid = U_PORT_STRINGIFY_QUOTED(U_WIFI_TEST_CFG_SSID), /* Wifi SSID - replace with your SSID */
+    .authentication = U_WIFI_TEST_CFG_AUTHENTICATION, /* Authentication mode (see uWifiAuth_t in wifi/api/u_wifi.h) */
+    .pPassPhrase = U_PORT_STRINGIFY_QUOTED(U_WIFI_TEST_CFG_WPA2_PASSPHRASE) /* WPA2 passphrase */
+};
+static const uNetworkType_t gNetType = U_NETWORK_TYPE_WIFI;
+
+#elif defined(U_CFG_TEST_CELL_MODULE_TYPE)
+
+// DEVICE i.e. module/chip configuration: in this case a cellular
+// module connected via UART
+static const uDeviceCfg_t gDeviceCfg = {
+    .deviceType = U_DEVICE_TYPE_CELL,
+    .deviceCfg = {
+        .cfgCell = {
+            .moduleType = U_CFG_TEST_CELL_MODULE_TYPE,
+            .pSimPinCode = NULL, /* SIM pin */
+            .pinEnablePower = U_CFG_APP_PIN_CELL_ENABLE_POWER,
+            .pinPwrOn = U_CFG_APP_PIN_CELL_PWR_ON,
+            .pinVInt = U_CFG_APP_PIN_CELL_VINT,
+            .pinDtrPowerSaving = U_CFG_APP_PIN_CELL_DTR
+        },
+    },
+    .transportType = U_DEVICE_TRANSPORT_TYPE_UART,
+    .transportCfg = {
+        .cfgUart = {
+            .uart = U_CFG_APP_CELL_UART,
+            .baudRate = U_CELL_UART_BAUD_RATE,
+            .pinTxd = U_CFG_APP_PIN_CELL_TXD,
+            .pinRxd = U_CFG_APP_PIN_CELL_RXD,
+            .pinCts = U_CFG_APP_PIN_CELL_CTS,
+            .pinRts = U_CFG_APP_PIN_CELL_RTS
+        },
+    },
+};
+// NETWORK configuration for cellular
+static const uNetworkCfgCell_t gNetworkCfg = {
+    .type = U_NETWORK_TYPE_CELL,
+    .pApn = NULL, /* APN: NULL to accept default.  If using a Thingstream SIM enter "tsiot" here */
+    .timeoutSeconds = 240 /* Connection timeout in seconds */
+};
+static const uNetworkType_t gNetType = U_NETWORK_TYPE_CELL;
+#else
+// No module available - set some dummy values to make test system happy
+static const uDeviceCfg_t gDeviceCfg = {.deviceType = U_DEVICE_TYPE_NONE};
+static const uNetworkCfgCell_t gNetworkCfg = {.type = U_NETWORK_TYPE_NONE};
+static const uNetworkType_t gNetType = U_NETWORK_TYPE_CELL;
+#endif
+
+// Buffer for the data that is written and read.
+static char gBuffer[BENCHMARK_CHUNK_SIZE];
+
+// The round trip times in milliseconds.
+static int32_t gRttMs[BENCHMARK_RTT_COUNT];
+
+// Cycle counter for the processor time of the workloads; it
+// doesn't count while the core sleeps, so the cycles counted while
+// waiting on a socket are those of the other tasks (e.g. the AT
+// client) that are doing the work.
+static uPortPerfCounter_t gCpuCounter;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Start timing a socket call.
+static void cpuStart()
+{
+    uPortPerfCounterStart(&gCpuCounter);
+}
+
+// Stop timing a socket call; each call is timed separately since
+// the cycle counter may wrap in tens of seconds.
+static void cpuStop()
+{
+    uPortPerfCounterStop(&gCpuCounter);
+}
+
+// Compare two int32_t values for qsort().
+static int compareInt32(const void *pA, const void *pB)
+{
+    int32_t a = *((const int32_t *) pA);
+    int32_t b = *((const int32_t *) pB);
+
+    return (a > b) - (a < b);
+}
+
+// Write a whole buffer to a socket, or send it as one datagram.
+static int32_t sendAll(uSockDescriptor_t sock, const uSockAddress_t *pAddress,
+                       const char *pData, size_t size)
+{
+    int32_t x = 0;
+    size_t sent = 0;
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    while ((x >= 0) && (sent < size) &&
+           (uPortGetTickTimeMs() - startTimeMs < BENCHMARK_TIMEOUT_MS)) {
+        cpuStart();
+        if (BENCHMARK_PROTOCOL == U_SOCK_PROTOCOL_UDP) {
+            x = uSockSendTo(sock, pAddress, pData + sent, size - sent);
+        } else {
+            x = uSockWrite(sock, pData + sent, size - sent);
+        }
+        cpuStop();
+        if (x > 0) {
+            sent += x;
+        }
+    }
+
+    return (sent == size) ? (int32_t) sent : -1;
+}
+
+// Read a line (TCP) or a datagram (UDP) from the server, e.g. the
+// number of bytes it received, null terminated.
+static int32_t receiveReply(uSockDescriptor_t sock, char *pBuffer, size_t size)
+{
+    int32_t x = 0;
+    size_t received = 0;
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    while ((x >= 0) && (received < size - 1) &&
+           ((received == 0) || (pBuffer[received - 1] != '\n')) &&
+           (uPortGetTickTimeMs() - startTimeMs < BENCHMARK_TIMEOUT_MS)) {
+        cpuStart();
+        if (BENCHMARK_PROTOCOL == U_SOCK_PROTOCOL_UDP) {
+            x = uSockReceiveFrom(sock, NULL, pBuffer, size - 1);
+        } else {
+            x = uSockRead(sock, pBuffer + received, 1);
+        }
+        cpuStop();
+        if (x > 0) {
+            received += x;
+        } else if (x == -U_SOCK_EWOULDBLOCK) {
+            x = 0;
+            uPortTaskBlock(10);
+        }
+    }
+    pBuffer[received] = 0;
+
+    return (int32_t) received;
+}
+
+// Open the sockets, connecting them for TCP; returns the number
+// opened.
+static size_t openSockets(uDeviceHandle_t devHandle,
+                          const uSockAddress_t *pAddress,
+                          uSockDescriptor_t *pSock, size_t numSockets)
+{
+    size_t numOpen = 0;
+    uSockType_t type = (BENCHMARK_PROTOCOL == U_SOCK_PROTOCOL_UDP) ?
+                       U_SOCK_TYPE_DGRAM : U_SOCK_TYPE_STREAM;
+
+    for (size_t x = 0; x < numSockets; x++) {
+        pSock[x] = uSockCreate(devHandle, type, BENCHMARK_PROTOCOL);
+        if ((pSock[x] >= 0) && ((BENCHMARK_PROTOCOL == U_SOCK_PROTOCOL_UDP) ||
+                                (uSockConnect(pSock[x], pAddress) == 0))) {
+            numOpen++;
+        } else if (pSock[x] >= 0) {
+            uSockClose(pSock[x]);
+            pSock[x] = -1;
+        }
+    }
+
+    return numOpen;
+}
+
+// Close the sockets.
+static void closeSockets(uSockDescriptor_t *pSock, size_t numSockets)
+{
+    for (size_t x = 0; x < numSockets; x++) {
+        if (pSock[x] >= 0) {
+            uSockClose(pSock[x]);
+            pSock[x] = -1;
+        }
+    }
+}
+
+// Upload BENCHMARK_UPLOAD_BYTES on each socket, round-robin, and
+// ask the server how much arrived: for TCP each socket begins with
+// "U <bytes>\n" and the server replies with the count once it has
+// it all, for UDP each datagram begins with 'U' and a "C" datagram
+// asks the server for the count.
+static void upload(uSockDescriptor_t *pSock, size_t numSockets,
+                   const uSockAddress_t *pAddress, benchmarkResult_t *pResult)
+{
+    int32_t sent[BENCHMARK_NUM_SOCKETS] = {0};
+    bool going = true;
+    int32_t x;
+    int32_t thisSize;
+    int32_t startTimeMs;
+    uint64_t startCycles;
+    char reply[16];
+
+    memset(gBuffer, 'U', sizeof(gBuffer));
+    startCycles = uPortPerfCounterRead(&gCpuCounter);
+    startTimeMs = uPortGetTickTimeMs();
+    if (BENCHMARK_PROTOCOL == U_SOCK_PROTOCOL_TCP) {
+        for (size_t y = 0; y < numSockets; y++) {
+            x = snprintf(reply, sizeof(reply), "U %d\n", BENCHMARK_UPLOAD_BYTES);
+            if (sendAll(pSock[y], pAddress, reply, x) < 0) {
+                sent[y] = BENCHMARK_UPLOAD_BYTES;
+            }
+        }
+    }
+    while (going) {
+        going = false;
+        for (size_t y = 0; y < numSockets; y++) {
+            if (sent[y] < BENCHMARK_UPLOAD_BYTES) {
+                thisSize = BENCHMARK_UPLOAD_BYTES - sent[y];
+                if (thisSize > (int32_t) sizeof(gBuffer)) {
+                    thisSize = sizeof(gBuffer);
+                }
+                if (sendAll(pSock[y], pAddress, gBuffer, thisSize) > 0) {
+                    sent[y] += thisSize;
+                    going = true;
+                } else {
+                    // Give up on this socket
+                    sent[y] = BENCHMARK_UPLOAD_BYTES;
+                }
+            }
+        }
+    }
+    // Find out what actually arrived
+    for (size_t y = 0; y < numSockets; y++) {
+        if (BENCHMARK_PROTOCOL == U_SOCK_PROTOCOL_UDP) {
+            sendAll(pSock[y], pAddress, "C", 1);
+        }
+        if (receiveReply(pSock[y], reply, sizeof(reply)) > 0) {
+            pResult->bytes += atoi(reply);
+        }
+    }
+    pResult->durationMs = uPortGetTickTimeMs() - startTimeMs;
+    pResult->cpuUs = uPortPerfCounterCyclesToUs(uPortPerfCounterRead(&gCpuCounter) -
+                                                startCycles);
+}
+
+// Download BENCHMARK_DOWNLOAD_BYTES on each socket, reading
+// round-robin: the server is asked with "D <bytes> <chunk size>\n"
+// (sent as a datagram for UDP, where it sends chunk-sized datagrams).
+static void download(uSockDescriptor_t *pSock, size_t numSockets,
+                     const uSockAddress_t *pAddress, benchmarkResult_t *pResult)
+{
+    int32_t received[BENCHMARK_NUM_SOCKETS] = {0};
+    int32_t x;
+    int32_t startTimeMs;
+    int32_t lastRxTimeMs;
+    uint64_t startCycles;
+    char request[32];
+    bool going = true;
+
+    startCycles = uPortPerfCounterRead(&gCpuCounter);
+    startTimeMs = uPortGetTickTimeMs();
+    for (size_t y = 0; y < numSockets; y++) {
+        uSockBlockingSet(pSock[y], false);
+        x = snprintf(request, sizeof(request), "D %d %d\n",
+                     BENCHMARK_DOWNLOAD_BYTES, BENCHMARK_CHUNK_SIZE);
+        if (sendAll(pSock[y], pAddress, request, x) < 0) {
+            received[y] = BENCHMARK_DOWNLOAD_BYTES;
+        }
+    }
+    lastRxTimeMs = uPortGetTickTimeMs();
+    while (going && (uPortGetTickTimeMs() - lastRxTimeMs < BENCHMARK_TIMEOUT_MS)) {
+        going = false;
+        for (size_t y = 0; y < numSockets; y++) {
+            if (received[y] < BENCHMARK_DOWNLOAD_BYTES) {
+                going = true;
+                cpuStart();
+                if (BENCHMARK_PROTOCOL == U_SOCK_PROTOCOL_UDP) {
+                    x = uSockReceiveFrom(pSock[y], NULL, gBuffer, sizeof(gBuffer));
+                } else {
+                    x = uSockRead(pSock[y], gBuffer, sizeof(gBuffer));
+                }
+                cpuStop();
+                if (x > 0) {
+                    received[y] += x;
+                    pResult->bytes += x;
+                    lastRxTimeMs = uPortGetTickTimeMs();
+                }
+            }
+        }
+        if (going) {
+            // Let the data arrive
+            uPortTaskBlock(1);
+        }
+    }
+    pResult->durationMs = lastRxTimeMs - startTimeMs;
+    pResult->cpuUs = uPortPerfCounterCyclesToUs(uPortPerfCounterRead(&gCpuCounter) -
+                                                startCycles);
+    for (size_t y = 0; y < numSockets; y++) {
+        uSockBlockingSet(pSock[y], true);
+    }
+}
+
+// Time echo round trips on a socket: for TCP the socket begins with
+// "E\n", for UDP each datagram begins with 'E'; returns the number
+// of round trips timed.
+static size_t echo(uSockDescriptor_t sock, const uSockAddress_t *pAddress)
+{
+    size_t numRtt = 0;
+    int32_t received;
+    int32_t x;
+    int32_t startTimeMs;
+
+    memset(gBuffer, 'E', BENCHMARK_RTT_SIZE);
+    if ((BENCHMARK_PROTOCOL == U_SOCK_PROTOCOL_UDP) ||
+        (sendAll(sock, pAddress, "E\n", 2) > 0)) {
+        for (size_t y = 0; y < sizeof(gRttMs) / sizeof(gRttMs[0]); y++) {
+            startTimeMs = uPortGetTickTimeMs();
+            received = 0;
+            if (sendAll(sock, pAddress, gBuffer, BENCHMARK_RTT_SIZE) > 0) {
+                x = 0;
+                while ((x >= 0) && (received < BENCHMARK_RTT_SIZE) &&
+                       (uPortGetTickTimeMs() - startTimeMs < BENCHMARK_TIMEOUT_MS)) {
+                    cpuStart();
+                    if (BENCHMARK_PROTOCOL == U_SOCK_PROTOCOL_UDP) {
+                        x = uSockReceiveFrom(sock, NULL, gBuffer + received,
+                                             BENCHMARK_RTT_SIZE - received);
+                    } else {
+                        x = uSockRead(sock, gBuffer + received,
+                                      BENCHMARK_RTT_SIZE - received);
+                    }
+                    cpuStop();
+                    if (x > 0) {
+                        received += x;
+                    }
+                }
+            }
+            if (received == BENCHMARK_RTT_SIZE) {
+                gRttMs[numRtt] = uPortGetTickTimeMs() - startTimeMs;
+                numRtt++;
+            }
+        }
+    }
+
+    return numRtt;
+}
+
+// Print a throughput result as a JSON object.
+static void printResult(const char *pName, const benchmarkResult_t *pResult)
+{
+    int32_t bytesPerSecond = 0;
+    int32_t cpuPercent = 0;
+
+    if (pResult->durationMs > 0) {
+        bytesPerSecond = (int32_t) (((int64_t) pResult->bytes) * 1000 / pResult->durationMs);
+        cpuPercent = (int32_t) (pResult->cpuUs / (((int64_t) pResult->durationMs) * 10));
+    }
+    uPortLog("\"%s\":{\"bytes\":%d,\"ms\":%d,\"bytes_per_s\":%d,\"cpu_percent\":%d},",
+             pName, pResult->bytes, pResult->durationMs, bytesPerSecond, cpuPercent);
+}
+
+// Print the AT client statistics as a JSON object; for Wi-Fi
+// these are AT commands carried over EDM.
+static void printAtStats(uDeviceHandle_t devHandle)
+{
+    uAtClientHandle_t atHandle = NULL;
+    uAtClientStats_t *pStats;
+    uint32_t numCommands = 0;
+
+    if (gNetType == U_NETWORK_TYPE_CELL) {
+        uCellAtClientHandleGet(devHandle, &atHandle);
+    } else {
+        uShortRangeAtClientHandleGet(devHandle, &atHandle);
+    }
+    // uAtClientStats_t is too large for the stack
+    pStats = (uAtClientStats_t *) pUPortMalloc(sizeof(*pStats));
+    if ((atHandle != NULL) && (pStats != NULL) &&
+        (uAtClientStatsGet(atHandle, pStats) == 0)) {
+        numCommands = pStats->untagged.numCommands;
+        for (size_t x = 0; x < sizeof(pStats->tag) / sizeof(pStats->tag[0]); x++) {
+            numCommands += pStats->tag[x].numCommands;
+        }
+        uPortLog("\"at\":{\"commands\":%u,\"tx_bytes\":%u,\"rx_bytes\":%u,"
+                 "\"urcs\":%u,\"read_stalls\":%u}",
+                 numCommands, pStats->txBytes, pStats->rxBytes,
+                 pStats->numUrcs, pStats->numReadStalls);
+    } else {
+        // Define U_CFG_AT_CLIENT_STATS to get these
+        uPortLog("\"at\":null");
+    }
+    uPortFree(pStats);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: THE EXAMPLE
+ * -------------------------------------------------------------- */
+
+// The entry point, main(): before this is called the system
+// clocks must have been started and the RTOS must be running;
+// we are in task space.
+U_PORT_TEST_FUNCTION("[example]", "exampleBenchmarkSockets")
+{
+    uDeviceHandle_t devHandle = NULL;
+    uSockDescriptor_t sock[BENCHMARK_NUM_SOCKETS];
+    uSockAddress_t address;
+    uAtClientHandle_t atHandle = NULL;
+    benchmarkResult_t uploadResult = {0};
+    benchmarkResult_t downloadResult = {0};
+    size_t numSockets = 0;
+    size_t numRtt = 0;
+    int32_t returnCode;
+
+    if (strlen(BENCHMARK_SERVER_NAME) == 0) {
+        uPortLog("Set BENCHMARK_SERVER_NAME to the host running"
+                 " benchmark_server.py to run this example.\n");
+        return;
+    }
+
+    // Initialise the APIs we will need
+    uPortInit();
+    uDeviceInit();
+    uPortPerfCounterReset(&gCpuCounter);
+
+    // Open the device
+    returnCode = uDeviceOpen(&gDeviceCfg, &devHandle);
+    uPortLog("Opened device with return code %d.\n", returnCode);
+
+    // Bring up the network interface
+    uPortLog("Bringing up the network...\n");
+    if (uNetworkInterfaceUp(devHandle, gNetType,
+                            &gNetworkCfg) == 0) {
+
+        // Only count the AT traffic of the benchmark itself
+        if (gNetType == U_NETWORK_TYPE_CELL) {
+            uCellAtClientHandleGet(devHandle, &atHandle);
+        } else {
+            uShortRangeAtClientHandleGet(devHandle, &atHandle);
+        }
+        if (atHandle != NULL) {
+            uAtClientStatsReset(atHandle);
+        }
+
+        uPortLog("Looking up server address...\n");
+        memset(&address, 0, sizeof(address));
+        if (uSockGetHostByName(devHandle, BENCHMARK_SERVER_NAME,
+                               &(address.ipAddress)) == 0) {
+            address.port = BENCHMARK_SERVER_PORT;
+
+            uPortLog("Uploading %d byte(s) on %d socket(s)...\n",
+                     BENCHMARK_UPLOAD_BYTES, BENCHMARK_NUM_SOCKETS);
+            numSockets = openSockets(devHandle, &address, sock, BENCHMARK_NUM_SOCKETS);
+            upload(sock, numSockets, &address, &uploadResult);
+            closeSockets(sock, BENCHMARK_NUM_SOCKETS);
+
+            uPortLog("Downloading %d byte(s) on %d socket(s)...\n",
+                     BENCHMARK_DOWNLOAD_BYTES, BENCHMARK_NUM_SOCKETS);
+            numSockets = openSockets(devHandle, &address, sock, BENCHMARK_NUM_SOCKETS);
+            download(sock, numSockets, &address, &downloadResult);
+            closeSockets(sock, BENCHMARK_NUM_SOCKETS);
+
+            uPortLog("Timing %d echo round trip(s)...\n", BENCHMARK_RTT_COUNT);
+            if (openSockets(devHandle, &address, sock, 1) == 1) {
+                numRtt = echo(sock[0], &address);
+            }
+            closeSockets(sock, 1);
+            uSockCleanUp();
+
+            // Print everything on one line for a script to pick up
+            qsort(gRttMs, numRtt, sizeof(gRttMs[0]), compareInt32);
+            uPortLog("BENCHMARK_JSON: {\"bearer\":\"%s\",\"protocol\":\"%s\","
+                     "\"sockets\":%d,\"chunk\":%d,",
+                     (gNetType == U_NETWORK_TYPE_CELL) ? "cell" : "wifi",
+                     (BENCHMARK_PROTOCOL == U_SOCK_PROTOCOL_UDP) ? "udp" : "tcp",
+                     numSockets, BENCHMARK_CHUNK_SIZE);
+            printResult("upload", &uploadResult);
+            printResult("download", &downloadResult);
+            if (numRtt > 0) {
+                uPortLog("\"rtt_ms\":{\"count\":%d,\"p50\":%d,\"p90\":%d,"
+                         "\"p99\":%d,\"max\":%d},", numRtt,
+                         gRttMs[(numRtt * 50) / 100], gRttMs[(numRtt * 90) / 100],
+                         gRttMs[(numRtt * 99) / 100], gRttMs[numRtt - 1]);
+            } else {
+                uPortLog("\"rtt_ms\":null,");
+            }
+            uPortLog("\"heap_min_free\":%d,", uPortGetHeapMinFree());
+            printAtStats(devHandle);
+            uPortLog("}\n");
+        } else {
+            uPortLog("Unable to look up \"%s\"!\n", BENCHMARK_SERVER_NAME);
+        }
+
+        // When finished with the network layer
+        uPortLog("Taking down network...\n");
+        uNetworkInterfaceDown(devHandle, gNetType);
+    } else {
+        uPortLog("Unable to bring up the network!\n");
+    }
+
+    // Close the device
+    // Note: we don't power the device down here in order
+    // to speed up testing; you may prefer to power it off
+    // by setting the second parameter to true.
+    uDeviceClose(devHandle, false);
+
+    // Tidy up
+    uDeviceDeinit();
+    uPortDeinit();
+
+    uPortLog("Done.\n");
+
+#if defined(U_CFG_TEST_CELL_MODULE_TYPE) || U_SHORT_RANGE_TEST_WIFI()
+    // For u-blox internal testing only
+    EXAMPLE_FINAL_STATE((uploadResult.bytes > 0) && (downloadResult.bytes > 0) &&
+                        (numRtt > 0));
+#endif
+}
+
+// End of file
@@ -46,6 +46,15 @@ extern "C" {
 # define U_GNSS_I2C_ADDRESS 0x42
 #endif
 
+#ifndef U_GNSS_DATA_READY_THRESHOLD
+/** The threshold that is configured into the GNSS chip by
+ * uGnssSetPinDataReady(): the TX-ready (Data Ready) pin of the
+ * GNSS chip is asserted when at least this amount of data is
+ * waiting to be read, in units of 8 bytes.
+ */
+# define U_GNSS_DATA_READY_THRESHOLD 1
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -78,12 +87,20 @@ void uGnssDeinit();
 
 /** Add a GNSS instance.
  *
- * @param moduleType         the GNSS module type.
+ * @param moduleType         the GNSS module type; if the driver is
+ *                           built with U_CFG_GNSS_MODULE_FIXED defined
+ *                           (e.g. to #U_GNSS_MODULE_TYPE_M9), so that
+ *                           the code for other module types may be
+ *                           removed by the compiler, this must be that
+ *                           module type.
  * @param transportType      the type of transport that has been set up
  *                           to talk with the GNSS module.
  * @param transportHandle    the handle of the transport to use to
  *                           talk with the GNSS module.  This must
- *                           already have been created by the caller.
+ *                           already have been created by the caller;
+ *                           for #U_GNSS_TRANSPORT_VIRTUAL_SERIAL all of
+ *                           the functions of the uGnssVirtualSerial_t
+ *                           must be populated.
  * @param pinGnssEnablePower the pin of the MCU that enables power to the
  *                           GNSS module; use -1 if there is no such
  *                           connection.  If there is an inverter between
@@ -105,6 +122,50 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
                  bool leavePowerAlone,
                  uDeviceHandle_t *pGnssHandle);
 
+/** As uGnssAdd() but with the sizes of the buffers used for the data
+ * streamed from the GNSS module (e.g. over UART or I2C) given for
+ * this instance, rather than taken from the compile-time defaults;
+ * an instance running at high rate with lots of messages enabled
+ * might have large buffers, while a low-rate instance can stay small.
+ * If uGnssMsgReceiveStatStreamLoss() reports loss then either of
+ * these values may be increased.
+ *
+ * @param moduleType            the GNSS module type.
+ * @param transportType         the type of transport that has been set up
+ *                              to talk with the GNSS module.
+ * @param transportHandle       the handle of the transport to use to
+ *                              talk with the GNSS module.  This must
+ *                              already have been created by the caller.
+ * @param pinGnssEnablePower    as for uGnssAdd().
+ * @param leavePowerAlone       as for uGnssAdd().
+ * @param ringBufferLengthBytes the length of the ring buffer into which
+ *                              data streamed from the GNSS module is
+ *                              placed; must be big enough to hold a few
+ *                              of the longest messages you expect; use 0
+ *                              for #U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES.
+ *                              Ignored for #U_GNSS_TRANSPORT_AT.
+ * @param readChunkLengthBytes  the maximum amount of data to read from
+ *                              the GNSS module in one go, the ring buffer
+ *                              being locked while that happens; use 0 for
+ *                              #U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES if
+ *                              ringBufferLengthBytes is also 0, else an
+ *                              eighth of ringBufferLengthBytes.  Use
+ *                              ringBufferLengthBytes to read in bursts of
+ *                              up to the full free space of the ring buffer.
+ * @param[out] pGnssHandle      a pointer to the output handle. Will only
+ *                              be set on success.
+ * @return                      zero on success or negative error code on
+ *                              failure.
+ */
+int32_t uGnssAddWithBufferSize(uGnssModuleType_t moduleType,
+                               uGnssTransportType_t transportType,
+                               const uGnssTransportHandle_t transportHandle,
+                               int32_t pinGnssEnablePower,
+                               bool leavePowerAlone,
+                               size_t ringBufferLengthBytes,
+                               size_t readChunkLengthBytes,
+                               uDeviceHandle_t *pGnssHandle);
+
 /** Set the I2C address at which the GNSS device can be expected to
  * be found.  If not called the default #U_GNSS_I2C_ADDRESS is assumed.
  * Note that this does not _configure_ the I2C address inside the GNSS
@@ -183,6 +244,40 @@ void uGnssSetAtPinPwr(uDeviceHandle_t gnssHandle, int32_t pin);
  */
 void uGnssSetAtPinDataReady(uDeviceHandle_t gnssHandle, int32_t pin);
 
+/** If the transport type is I2C and a pin of this MCU is connected
+ * to the TX-ready (Data Ready) pin of the GNSS chip, then this
+ * function may be called to configure the GNSS chip to signal
+ * Data Ready on that pin; the code that pulls data from the
+ * GNSS chip, including the task started by uGnssMsgReceiveStart(),
+ * will then only ask the GNSS chip how much data it has waiting,
+ * an I2C transaction, when the pin is asserted, rather than all
+ * the time, saving I2C bandwidth and CPU.  Once the pin has been
+ * seen asserted data is read until the GNSS chip reports that it
+ * has no more, so data below #U_GNSS_DATA_READY_THRESHOLD is not
+ * left behind.
+ *
+ * The GNSS chip must support configuration via UBX-CFG-VALSET
+ * (i.e. M9 modules and later) and the configuration is stored in
+ * RAM only, hence this function should be called again after
+ * the GNSS chip has been power-cycled.  Note that the Data Ready
+ * pin of many GNSS modules shares a function with other things
+ * (e.g. SAFEBOOT_N or EXTINT), check the data sheet of your
+ * module to determine which GNSS-side pin number to use.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ * @param pin         the pin of this MCU that is connected to
+ *                    the Data Ready pin of the GNSS chip; OR with
+ *                    #U_GNSS_PIN_INVERTED if the pin is to be
+ *                    active-low rather than active-high. Use -1
+ *                    to stop using Data Ready (which is the default),
+ *                    in which case gnssPin is ignored.
+ * @param gnssPin     the pin number, GNSS-side, that the GNSS
+ *                    chip should use for Data Ready.
+ * @return            zero on success else negative error code.
+ */
+int32_t uGnssSetPinDataReady(uDeviceHandle_t gnssHandle, int32_t pin,
+                             int32_t gnssPin);
+
 /** Get the maximum time to wait for a response from the
  * GNSS chip for general API calls; does not apply to the
  * positioning calls, where #U_GNSS_POS_TIMEOUT_SECONDS and
@@ -38,6 +38,25 @@ extern "C" {
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_GNSS_CFG_VAL_GET_LIST_BUFFER_LENGTH_BYTES
+/** The size of the buffer, on the stack of the calling task, that
+ * uGnssCfgValGet() and uGnssCfgValGetList() use for the UBX-CFG-VALGET
+ * exchange with the GNSS chip: it must be at least 4 plus the sum of
+ * #U_GNSS_CFG_VAL_KEY_ITEM_LENGTH_BYTES for the keys requested in one
+ * go.  The default is enough for ten eight-byte values or twenty-four
+ * one-byte values.
+ */
+# define U_GNSS_CFG_VAL_GET_LIST_BUFFER_LENGTH_BYTES 128
+#endif
+
+#ifndef U_GNSS_CFG_UART_BAUD_RATE_CHANGE_DELAY_MS
+/** How long uGnssCfgSetUartBaudRate() waits, after sending the
+ * change, for the GNSS chip to switch its UART over to the new
+ * baud rate.
+ */
+# define U_GNSS_CFG_UART_BAUD_RATE_CHANGE_DELAY_MS 100
+#endif
+
 /** A helper macro to set a single value without a transaction and
  * with less typing: if you are using one of the key IDs from
  * u_gnss_cfg_val_key.h, you may use this macro as follows:
@@ -172,6 +191,40 @@ typedef enum {
     U_GNSS_CFG_VAL_LAYER_MAX_NUM
 } uGnssCfgValLayer_t;
 
+/** Structure in which to accumulate configuration values that are
+ * to be set in one go with uGnssCfgValBatchCommit(); initialise it
+ * with uGnssCfgValBatchBegin() and add values with
+ * uGnssCfgValBatchAdd().  The contents should be treated as private.
+ */
+typedef struct {
+    uGnssCfgVal_t *pList;  /**< storage for the values, provided by the caller. */
+    size_t maxNumValues;   /**< the number of items of storage at pList. */
+    size_t numValues;      /**< the number of items currently at pList. */
+    uint32_t layers;       /**< the layers the values are to be set in. */
+    int32_t errorCode;     /**< the first error from uGnssCfgValBatchAdd(),
+                                returned by uGnssCfgValBatchCommit(). */
+} uGnssCfgValBatch_t;
+
+/** Callback that is called when uGnssCfgValGetAsync() completes.
+ *
+ * @param gnssHandle          the handle of the GNSS instance.
+ * @param errorCode           zero on success, #U_GNSS_ERROR_NACK if
+ *                            the GNSS chip rejected the request (e.g.
+ *                            because the key ID is not known to it),
+ *                            #U_ERROR_COMMON_TIMEOUT if there was no
+ *                            response within uGnssGetTimeout(), else
+ *                            negative error code.
+ * @param keyId               the key ID that was asked for.
+ * @param value               the value, valid only if errorCode is zero.
+ * @param[in] pCallbackParam  the pCallbackParam passed to
+ *                            uGnssCfgValGetAsync().
+ */
+typedef void (uGnssCfgValGetCallback_t)(uDeviceHandle_t gnssHandle,
+                                        int32_t errorCode,
+                                        uint32_t keyId,
+                                        uint64_t value,
+                                        void *pCallbackParam);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: SPECIFIC CONFIGURATION FUNCTIONS
  * -------------------------------------------------------------- */
@@ -265,6 +318,35 @@ int32_t uGnssCfgSetProtocolOut(uDeviceHandle_t gnssHandle,
                                uGnssProtocol_t protocol,
                                bool onNotOff);
 
+/** Set the baud rate of the UART of the GNSS chip that this MCU is
+ * connected to; only relevant where the transport is
+ * #U_GNSS_TRANSPORT_UART or #U_GNSS_TRANSPORT_UBX_UART.  The change
+ * is not acknowledged (any UBX-ACK-ACK would be sent at the new baud
+ * rate) and so this function cannot tell whether it has been applied;
+ * it returns once the change has been sent and
+ * #U_GNSS_CFG_UART_BAUD_RATE_CHANGE_DELAY_MS has elapsed.  After
+ * this the application must close the UART, re-open it at the new
+ * baud rate, remove the GNSS instance and add it again on the new
+ * UART handle, then confirm communication with uGnssPwrIsAlive();
+ * uDeviceOpen() can do all of this for you, see the
+ * uartBaudRateUpgrade field of #uDeviceCfgGnss_t.
+ *
+ * @param gnssHandle the handle of the GNSS instance.
+ * @param baudRate   the new baud rate, e.g. 115200.
+ * @param persist    if true the new baud rate is also stored in
+ *                   battery-backed RAM, so that it is retained when
+ *                   the GNSS chip is next powered up (provided that
+ *                   it has a backup supply), else it applies only
+ *                   until the GNSS chip is next powered off.  This
+ *                   is ignored for M8 modules, which do not support
+ *                   UBX-CFG-VALSET: for those the change always
+ *                   applies only until the GNSS chip is powered off.
+ * @return           zero if the change was sent, else negative
+ *                   error code.
+ */
+int32_t uGnssCfgSetUartBaudRate(uDeviceHandle_t gnssHandle,
+                                int32_t baudRate, bool persist);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: GENERIC CONFIGURATION USING VALGET/VALSET/VALDEL, FROM M9
  * -------------------------------------------------------------- */
@@ -301,6 +383,40 @@ int32_t uGnssCfgValGet(uDeviceHandle_t gnssHandle, uint32_t keyId,
                        void *pValue, size_t size,
                        uGnssCfgValLayer_t layer);
 
+/** A non-blocking version of uGnssCfgValGet(): the UBX-CFG-VALGET
+ * poll is sent and this function returns; the response is picked up
+ * by the message receive task (see uGnssMsgReceiveStartOneShot())
+ * and passed to pCallback, so the calling task does not wait out the
+ * round trip to the GNSS chip.  Several requests, for different keys,
+ * may be outstanding at once, up to the limit imposed by
+ * #U_GNSS_MSG_RECEIVER_MAX_NUM, though note that a NACK cannot be
+ * attributed to a particular UBX-CFG-VALGET request and so will
+ * complete all of those outstanding.  The configuration cache (see
+ * uGnssCfgSetCacheSize()) is neither consulted nor updated.  Only
+ * supported where the GNSS chip is connected directly to this MCU
+ * via a streaming transport (UART or I2C).
+ *
+ * @param gnssHandle          the handle of the GNSS instance.
+ * @param keyId               the ID of the key to get, as for
+ *                            uGnssCfgValGet(); wild-cards are NOT
+ *                            permitted.
+ * @param layer               the layer to get the value from.
+ * @param[in] pCallback       the callback that will be called with
+ *                            the outcome, in the context of the
+ *                            message receive task and hence subject
+ *                            to the same rules as the callback of
+ *                            uGnssMsgReceiveStart(); cannot be NULL.
+ * @param[in] pCallbackParam  a parameter to pass to pCallback; may
+ *                            be NULL.
+ * @return                    zero if the request has been sent, in
+ *                            which case pCallback will be called
+ *                            exactly once, else negative error code.
+ */
+int32_t uGnssCfgValGetAsync(uDeviceHandle_t gnssHandle, uint32_t keyId,
+                            uGnssCfgValLayer_t layer,
+                            uGnssCfgValGetCallback_t *pCallback,
+                            void *pCallbackParam);
+
 /** Get the value of a configuration item; only applicable
  * to M9 modules and beyond, uses the UBX-CFG-VALGET mechanism.
  *
@@ -373,6 +489,43 @@ int32_t uGnssCfgValGetListAlloc(uDeviceHandle_t gnssHandle,
                                 uGnssCfgVal_t **pList,
                                 uGnssCfgValLayer_t layer);
 
+/** Get the value of several specific configuration items at once
+ * without allocating any memory: the values are written to storage
+ * provided by the caller, e.g. on the stack; only applicable to M9
+ * modules and beyond, uses the UBX-CFG-VALGET mechanism.  Since the
+ * storage size of each value is encoded in its key ID, the size of
+ * the response is known before the request is sent: if it would not
+ * fit into #U_GNSS_CFG_VAL_GET_LIST_BUFFER_LENGTH_BYTES nothing is
+ * sent and #U_ERROR_COMMON_NO_MEMORY is returned, in which case either
+ * request fewer keys at a time, increase
+ * #U_GNSS_CFG_VAL_GET_LIST_BUFFER_LENGTH_BYTES or use
+ * uGnssCfgValGetListAlloc().
+ *
+ * @param gnssHandle     the handle of the GNSS instance.
+ * @param[in] pKeyIdList a pointer to an array of key IDs to get;
+ *                       cannot be NULL.  Wild-cards are NOT permitted:
+ *                       please use uGnssCfgValGetListAlloc() if you
+ *                       want to use wild-cards.
+ * @param numKeyIds      the number of items in the array pointed-to
+ *                       by pKeyIdList, at least one.
+ * @param[out] pList     a pointer to an array of at least numKeyIds
+ *                       entries in which the values will be placed;
+ *                       cannot be NULL.  The value of a key is, as
+ *                       for uGnssCfgValGetListAlloc(), an unsigned
+ *                       integer of #U_GNSS_CFG_VAL_KEY_SIZE_BYTES,
+ *                       to be interpreted according to the type of
+ *                       the key (see #U_GNSS_CFG_VAL_KEY_TYPE).
+ * @param layer          the layer to get the values from: use
+ *                       #U_GNSS_CFG_VAL_LAYER_RAM to get the currently
+ *                       applied values.
+ * @return               on success the number of items written to
+ *                       pList, else negative error code.
+ */
+int32_t uGnssCfgValGetList(uDeviceHandle_t gnssHandle,
+                           const uint32_t *pKeyIdList, size_t numKeyIds,
+                           uGnssCfgVal_t *pList,
+                           uGnssCfgValLayer_t layer);
+
 /** Set the value of a configuration item; only applicable to M9
  * modules and beyond, using the UBX-CFG-VALSET mechanism.
  *
@@ -465,6 +618,11 @@ int32_t uGnssCfgValSet(uDeviceHandle_t gnssHandle,
  *                     connected to the GNSS chip); if you are using a transaction
  *                     then the set of layers used for ALL of the operations in
  *                     that transaction MUST be the same.
+ *                     If this is #U_GNSS_CFG_VAL_TRANSACTION_NONE and there
+ *                     are more values than will fit into a single UBX-CFG-VALSET
+ *                     message (64) then the list is automatically split across
+ *                     several messages, sent as a single transaction, so that
+ *                     the values are still applied all at once.
  * @return             zero on success else negative error code.
  */
 int32_t uGnssCfgValSetList(uDeviceHandle_t gnssHandle,
@@ -608,6 +766,195 @@ int32_t uGnssCfgValDelListX(uDeviceHandle_t gnssHandle,
                             uGnssCfgValTransaction_t transaction,
                             uint32_t layers);
 
+/* ----------------------------------------------------------------
+ * FUNCTIONS: BATCHED CONFIGURATION USING VALSET, FROM M9
+ * -------------------------------------------------------------- */
+
+/** Begin a batch of configuration values to be set: rather than
+ * calling uGnssCfgValSet() for each key, each of which is a full
+ * send/acknowledge round trip with the GNSS chip, add the values to
+ * a batch with uGnssCfgValBatchAdd() and then send them all with
+ * uGnssCfgValBatchCommit(), which packs them into as few
+ * UBX-CFG-VALSET messages as possible.  No communication with the
+ * GNSS chip takes place until uGnssCfgValBatchCommit() is called.
+ *
+ * @param[out] pBatch    a pointer to the batch to initialise; cannot
+ *                       be NULL.
+ * @param[in] pStorage   storage for the values that will be added to
+ *                       the batch, which must remain valid until
+ *                       uGnssCfgValBatchCommit() has returned; cannot
+ *                       be NULL.
+ * @param maxNumValues   the number of items of storage at pStorage;
+ *                       must be greater than zero.
+ * @param layers         the layers to set the values in, a bit-map of
+ *                       #uGnssCfgValLayer_t values OR'ed together, as
+ *                       for uGnssCfgValSet().
+ * @return               zero on success else negative error code.
+ */
+int32_t uGnssCfgValBatchBegin(uGnssCfgValBatch_t *pBatch,
+                              uGnssCfgVal_t *pStorage,
+                              size_t maxNumValues,
+                              uint32_t layers);
+
+/** Add a value to a batch that was begun with uGnssCfgValBatchBegin().
+ * If keyId is already in the batch its value is replaced, so each key
+ * is only sent to the GNSS chip once.  Should there be no room left in
+ * the batch then an error is returned and that error will also be
+ * returned by uGnssCfgValBatchCommit(), which will then send nothing,
+ * so it is sufficient to check the return value of
+ * uGnssCfgValBatchCommit() only.
+ *
+ * @param[in] pBatch    a pointer to the batch; cannot be NULL.
+ * @param keyId         the key ID of the configuration value to set,
+ *                      as for uGnssCfgValSet().
+ * @param value         the value to set, of size defined by keyId.
+ * @return              on success the number of values in the batch,
+ *                      else negative error code.
+ */
+int32_t uGnssCfgValBatchAdd(uGnssCfgValBatch_t *pBatch,
+                            uint32_t keyId, uint64_t value);
+
+/** Send a batch of values to the GNSS chip: the values are packed
+ * into UBX-CFG-VALSET messages of up to 64 values each and, where
+ * more than one message is required, sent as a single transaction
+ * so that they are applied all at once when the last message is
+ * received.  Whatever the outcome the batch is emptied, ready for
+ * re-use with the same storage and layers.  Only applicable to M9
+ * modules and beyond.
+ *
+ * @param gnssHandle   the handle of the GNSS instance.
+ * @param[in] pBatch   a pointer to the batch; cannot be NULL.
+ * @return             zero on success else negative error code.
+ */
+int32_t uGnssCfgValBatchCommit(uDeviceHandle_t gnssHandle,
+                               uGnssCfgValBatch_t *pBatch);
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS: CONFIGURATION SNAPSHOT, FROM M9
+ * -------------------------------------------------------------- */
+
+/** Take a snapshot of the configuration of the GNSS chip, e.g. so
+ * that it may be stored and applied to other GNSS chips with
+ * uGnssCfgRestore().  The snapshot is a compact binary blob: a four
+ * byte header followed by each key ID and its value, packed to the
+ * storage size given by the key ID, all little-endian, i.e. in the
+ * same form as the body of a UBX-CFG-VALGET response.  Only
+ * applicable to M9 modules and beyond, uses the UBX-CFG-VALGET
+ * mechanism.
+ *
+ * IMPORTANT: this function allocates memory for the snapshot, it is
+ * up to the caller to uPortFree(*ppBlob) when done.
+ *
+ * @param gnssHandle     the handle of the GNSS instance.
+ * @param[in] pKeyIdList a pointer to an array of key IDs to include
+ *                       in the snapshot; wild-cards may be included in
+ *                       any of the entries in the list.  Use NULL to
+ *                       include absolutely everything.
+ * @param numKeyIds      the number of items in the array pointed-to
+ *                       by pKeyIdList; ignored if pKeyIdList is NULL.
+ * @param[out] ppBlob    a pointer to a place to put the snapshot;
+ *                       cannot be NULL.  If this function returns
+ *                       success it is UP TO THE CALLER to
+ *                       uPortFree(*ppBlob) when done.
+ * @param layer          the layer to take the values from: use
+ *                       #U_GNSS_CFG_VAL_LAYER_RAM to capture the
+ *                       currently applied values.
+ * @return               on success the size of the snapshot at
+ *                       *ppBlob in bytes, else negative error code.
+ */
+int32_t uGnssCfgSnapshot(uDeviceHandle_t gnssHandle,
+                         const uint32_t *pKeyIdList, size_t numKeyIds,
+                         char **ppBlob, uGnssCfgValLayer_t layer);
+
+/** Apply a snapshot taken with uGnssCfgSnapshot() to the GNSS chip.
+ * The values in the snapshot are first read back from the given
+ * layers of the GNSS chip and only those that differ, or are not
+ * present, are written; they are written as UBX-CFG-VALSET messages
+ * containing as many values as the message will carry, sent as a
+ * single transaction so that they are all applied at once.  Only
+ * applicable to M9 modules and beyond.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ * @param[in] pBlob   the snapshot; cannot be NULL.
+ * @param size        the number of bytes at pBlob.
+ * @param layers      the layers to restore the values to, a bit-map
+ *                    of #uGnssCfgValLayer_t values OR'ed together,
+ *                    as for uGnssCfgValSetList(); a value is written
+ *                    to all of the layers if it differs in any one
+ *                    of them.
+ * @return            on success the number of values that had to be
+ *                    written (zero if the GNSS chip already matched
+ *                    the snapshot), else negative error code.
+ */
+int32_t uGnssCfgRestore(uDeviceHandle_t gnssHandle,
+                        const char *pBlob, size_t size,
+                        uint32_t layers);
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS: CONFIGURATION CACHE
+ * -------------------------------------------------------------- */
+
+/** Set the size of the configuration cache of a GNSS instance; by
+ * default there is no configuration cache.  When there is one, the
+ * current (i.e. RAM layer) values read or written by this API, with
+ * uGnssCfgValGet(), uGnssCfgValSet(), uGnssCfgGetDynamic(),
+ * uGnssCfgSetFixMode(), uGnssCfgGetProtocolOut() etc., are kept in
+ * it so that:
+ *
+ * - reading a value which is in the cache, where the layer is
+ *   #U_GNSS_CFG_VAL_LAYER_RAM and the key ID is not a wildcard,
+ *   does not involve the GNSS chip,
+ * - setting a value, or a list of values, in the RAM layer only and
+ *   without a transaction, where the value(s) in the cache are
+ *   already the same, does not involve the GNSS chip.
+ *
+ * Once full, the oldest entries are replaced.  The cache is emptied
+ * when the GNSS chip is powered off (uGnssPwrOff() or
+ * uGnssPwrOffBackup()), when the protocol output is changed with
+ * uGnssCfgSetProtocolOut() and when a UBX-CFG message is sent with
+ * uGnssMsgSend(); if the configuration of the GNSS chip might have
+ * been changed in any other way (e.g. it has been reset by some
+ * external means) you should call uGnssCfgInvalidateCache().
+ *
+ * Calling this function replaces any existing cache with an empty
+ * one; the hit/miss counters are also reset.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ * @param numEntries  the maximum number of configuration values to
+ *                    cache; each entry occupies 16 bytes of heap.
+ *                    Use zero to remove the cache and free its
+ *                    memory.
+ * @return            zero on success else negative error code.
+ */
+int32_t uGnssCfgSetCacheSize(uDeviceHandle_t gnssHandle, size_t numEntries);
+
+/** Get the hit and miss counters of the configuration cache, see
+ * uGnssCfgSetCacheSize().
+ *
+ * @param gnssHandle    the handle of the GNSS instance.
+ * @param[out] pHits    a place to put the number of times a value
+ *                      was found in the cache; may be NULL.
+ * @param[out] pMisses  a place to put the number of times a value
+ *                      was looked for in the cache but not found;
+ *                      may be NULL.
+ * @param reset         if true the counters are reset to zero after
+ *                      they have been read.
+ * @return              zero on success else negative error code;
+ *                      #U_ERROR_COMMON_NOT_FOUND is returned if there
+ *                      is no configuration cache.
+ */
+int32_t uGnssCfgGetCacheCounters(uDeviceHandle_t gnssHandle,
+                                 uint32_t *pHits, uint32_t *pMisses,
+                                 bool reset);
+
+/** Empty the configuration cache, see uGnssCfgSetCacheSize(); the
+ * hit/miss counters are not affected.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ * @return            zero on success else negative error code.
+ */
+int32_t uGnssCfgInvalidateCache(uDeviceHandle_t gnssHandle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -33,7 +33,11 @@
  * at the end of this file, which can be used as keyId when calling the
  * uGnssCfgValGet()/uGnssCfgValSet()/uGnssCfgValDel() functions and in
  * the #uGnssCfgVal_t structure when calling the uGnssCfgValSetList()/
- * uGnssCfgValDelList() functions.
+ * uGnssCfgValDelList() functions.  Alongside each of those is a
+ * U_GNSS_CFG_VAL_KEY_TYPE_ID_XXX macro giving the type of the value
+ * of the key and, since the storage size of a value is encoded in
+ * its key ID, #U_GNSS_CFG_VAL_KEY_SIZE_BYTES gives its size at compile
+ * time; together they allow storage for values to be sized up-front.
  */
 
 /* NOTE TO MAINTAINERS: when updating this file modify/add enumerations
@@ -85,6 +89,35 @@ extern "C" {
                                                    (((uint32_t) (groupId) & 0xFFF) << 16) | \
                                                    (((uint32_t) (itemId)) & 0xFFFF))
 
+/** Macro to get the number of bytes that the value of a key occupies,
+ * given the storage size (#uGnssCfgValKeySize_t); a one-bit value
+ * occupies a whole byte.
+ */
+#define U_GNSS_CFG_VAL_KEY_SIZE_TO_BYTES(size) ((size_t) ((((size) < 1) || ((size) > 5)) ? 0 : \
+                                                          (((size) < 3) ? 1 : (1U << ((size) - 2)))))
+
+/** Macro to get the number of bytes that the value of a key occupies,
+ * given the key ID; since the storage size is encoded in the key ID
+ * this is a compile-time constant for any of the U_GNSS_CFG_VAL_KEY_ID_XXX
+ * macros below and so can be used to size storage, e.g. on the stack,
+ * for values that are to be read with uGnssCfgValGet() or
+ * uGnssCfgValGetList().
+ */
+#define U_GNSS_CFG_VAL_KEY_SIZE_BYTES(keyId) U_GNSS_CFG_VAL_KEY_SIZE_TO_BYTES((((uint32_t) (keyId)) >> 28) & 0x07)
+
+/** Macro to get the number of bytes that a key and its value occupy
+ * in the body of a UBX-CFG-VALSET or UBX-CFG-VALGET message.
+ */
+#define U_GNSS_CFG_VAL_KEY_ITEM_LENGTH_BYTES(keyId) (4 + U_GNSS_CFG_VAL_KEY_SIZE_BYTES(keyId))
+
+/** Macro to get the type (#uGnssCfgValKeyType_t) of the value of a key
+ * given the name of the key ID macro with the U_GNSS_CFG_VAL_KEY_ID_
+ * prefix removed, e.g. U_GNSS_CFG_VAL_KEY_TYPE(ANA_USE_ANA_L) is
+ * #U_GNSS_CFG_VAL_KEY_TYPE_L; the type cannot be derived from the key
+ * ID itself.
+ */
+#define U_GNSS_CFG_VAL_KEY_TYPE(keyIdStripped) U_GNSS_CFG_VAL_KEY_TYPE_ID_##keyIdStripped
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -105,6 +138,27 @@ typedef enum {
     U_GNSS_CFG_VAL_KEY_SIZE_EIGHT_BYTES = 0x05
 } uGnssCfgValKeySize_t;
 
+/** The types of the values of keys, named after the letter used in the
+ * u-blox GNSS reference manual, which also appears at the end of each
+ * of the U_GNSS_CFG_VAL_KEY_ID_XXX macros; the generated
+ * U_GNSS_CFG_VAL_KEY_TYPE_ID_XXX macros at the end of this file, best
+ * used through #U_GNSS_CFG_VAL_KEY_TYPE, give the type for each key.
+ * Values are returned by uGnssCfgValGet() and friends as unsigned
+ * integers of #U_GNSS_CFG_VAL_KEY_SIZE_BYTES, which the type tells
+ * you how to interpret.
+ */
+typedef enum {
+    U_GNSS_CFG_VAL_KEY_TYPE_L, /**< boolean. */
+    U_GNSS_CFG_VAL_KEY_TYPE_U, /**< unsigned integer. */
+    U_GNSS_CFG_VAL_KEY_TYPE_I, /**< signed (two's complement) integer,
+                                    to be sign-extended from its size. */
+    U_GNSS_CFG_VAL_KEY_TYPE_E, /**< enumeration, an unsigned integer. */
+    U_GNSS_CFG_VAL_KEY_TYPE_X, /**< bit-field or bytes. */
+    U_GNSS_CFG_VAL_KEY_TYPE_R  /**< IEEE 754 floating point: single
+                                    precision if four bytes, double
+                                    precision if eight bytes. */
+} uGnssCfgValKeyType_t;
+
 /* The name of this enum MUST be uGnssCfgValKeyGroupId_t, every
  * entry must begin with U_GNSS_CFG_VAL_KEY_GROUP_ID_ and all entries
  * must have a hard-coded value, otherwise the u_gnss_cfg_val_key.py
@@ -3185,6 +3239,965 @@ typedef enum {
 #define U_GNSS_CFG_VAL_KEY_ID_USBOUTPROT_NMEA_L                  0x10780002
 #define U_GNSS_CFG_VAL_KEY_ID_USBOUTPROT_RTCM3X_L                0x10780004
 
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_ANA_USE_ANA_L                      U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_ANA_ORBMAXERR_U2                   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_BATCH_ENABLE_L                     U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_BATCH_PIOENABLE_L                  U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_BATCH_MAXENTRIES_U2                U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_BATCH_WARNTHRS_U2                  U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_BATCH_PIOACTIVELOW_L               U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_BATCH_PIOID_U1                     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_BATCH_EXTRAPVT_L                   U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_BATCH_EXTRAODO_L                   U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_BDS_USE_GEO_PRN_L                  U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_GEOFENCE_CONFLVL_E1                U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_GEOFENCE_USE_PIO_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_GEOFENCE_PINPOL_E1                 U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_GEOFENCE_PIN_U1                    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_GEOFENCE_USE_FENCE1_L              U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_GEOFENCE_FENCE1_LAT_I4             U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_GEOFENCE_FENCE1_LON_I4             U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_GEOFENCE_FENCE1_RAD_U4             U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_GEOFENCE_USE_FENCE2_L              U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_GEOFENCE_FENCE2_LAT_I4             U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_GEOFENCE_FENCE2_LON_I4             U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_GEOFENCE_FENCE2_RAD_U4             U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_GEOFENCE_USE_FENCE3_L              U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_GEOFENCE_FENCE3_LAT_I4             U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_GEOFENCE_FENCE3_LON_I4             U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_GEOFENCE_FENCE3_RAD_U4             U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_GEOFENCE_USE_FENCE4_L              U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_GEOFENCE_FENCE4_LAT_I4             U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_GEOFENCE_FENCE4_LON_I4             U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_GEOFENCE_FENCE4_RAD_U4             U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_HW_ANT_CFG_VOLTCTRL_L              U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_HW_ANT_CFG_SHORTDET_L              U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_HW_ANT_CFG_SHORTDET_POL_L          U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_HW_ANT_CFG_OPENDET_L               U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_HW_ANT_CFG_OPENDET_POL_L           U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_HW_ANT_CFG_PWRDOWN_L               U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_HW_ANT_CFG_PWRDOWN_POL_L           U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_HW_ANT_CFG_RECOVER_L               U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_HW_ANT_SUP_SWITCH_PIN_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_HW_ANT_SUP_SHORT_PIN_U1            U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_HW_ANT_SUP_OPEN_PIN_U1             U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_HW_ANT_SUP_ENGINE_E1               U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_HW_ANT_SUP_SHORT_THR_U1            U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_HW_ANT_SUP_OPEN_THR_U1             U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_I2C_ADDRESS_U1                     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_I2C_EXTENDEDTIMEOUT_L              U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_I2C_ENABLED_L                      U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_I2CINPROT_UBX_L                    U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_I2CINPROT_NMEA_L                   U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_I2CINPROT_RTCM3X_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_I2CINPROT_SPARTN_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_I2COUTPROT_UBX_L                   U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_I2COUTPROT_NMEA_L                  U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_I2COUTPROT_RTCM3X_L                U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_INFMSG_UBX_I2C_X1                  U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_INFMSG_UBX_UART1_X1                U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_INFMSG_UBX_UART2_X1                U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_INFMSG_UBX_USB_X1                  U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_INFMSG_UBX_SPI_X1                  U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_INFMSG_NMEA_I2C_X1                 U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_INFMSG_NMEA_UART1_X1               U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_INFMSG_NMEA_UART2_X1               U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_INFMSG_NMEA_USB_X1                 U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_INFMSG_NMEA_SPI_X1                 U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_ITFM_BBTHRESHOLD_U1                U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_ITFM_CWTHRESHOLD_U1                U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_ITFM_ENABLE_L                      U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_ITFM_ANTSETTING_E1                 U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_ITFM_ENABLE_AUX_L                  U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_LOGFILTER_RECORD_ENA_L             U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_LOGFILTER_ONCE_PER_WAKE_UP_ENA_L   U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_LOGFILTER_APPLY_ALL_FILTERS_L      U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_LOGFILTER_MIN_INTERVAL_U2          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_LOGFILTER_TIME_THRS_U2             U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_LOGFILTER_SPEED_THRS_U2            U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_LOGFILTER_POSITION_THRS_U4         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MOT_GNSSSPEED_THRS_U1              U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MOT_GNSSDIST_THRS_U2               U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_DTM_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_DTM_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_DTM_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_DTM_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_DTM_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GBS_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GBS_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GBS_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GBS_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GBS_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GGA_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GGA_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GGA_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GGA_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GGA_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GLL_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GLL_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GLL_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GLL_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GLL_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GNS_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GNS_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GNS_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GNS_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GNS_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GRS_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GRS_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GRS_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GRS_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GRS_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GSA_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GSA_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GSA_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GSA_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GSA_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GST_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GST_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GST_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GST_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GST_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GSV_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GSV_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GSV_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GSV_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_GSV_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_RLM_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_RLM_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_RLM_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_RLM_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_RLM_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_RMC_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_RMC_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_RMC_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_RMC_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_RMC_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_VLW_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_VLW_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_VLW_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_VLW_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_VLW_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_VTG_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_VTG_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_VTG_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_VTG_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_VTG_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_ZDA_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_ZDA_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_ZDA_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_ZDA_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_ID_ZDA_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_GGA_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_GGA_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_GGA_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_GGA_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_GGA_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_GLL_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_GLL_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_GLL_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_GLL_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_GLL_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_GNS_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_GNS_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_GNS_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_GNS_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_GNS_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_GSA_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_GSA_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_GSA_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_GSA_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_GSA_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_RMC_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_RMC_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_RMC_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_RMC_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_RMC_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_VTG_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_VTG_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_VTG_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_VTG_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_VTG_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_ZDA_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_ZDA_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_ZDA_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_ZDA_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_NMEA_NAV2_ID_ZDA_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_PUBX_ID_POLYP_I2C_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_PUBX_ID_POLYP_SPI_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_PUBX_ID_POLYP_UART1_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_PUBX_ID_POLYP_UART2_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_PUBX_ID_POLYP_USB_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_PUBX_ID_POLYS_I2C_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_PUBX_ID_POLYS_SPI_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_PUBX_ID_POLYS_UART1_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_PUBX_ID_POLYS_UART2_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_PUBX_ID_POLYS_USB_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_PUBX_ID_POLYT_I2C_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_PUBX_ID_POLYT_SPI_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_PUBX_ID_POLYT_UART1_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_PUBX_ID_POLYT_UART2_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_PUBX_ID_POLYT_USB_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1005_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1005_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1005_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1005_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1005_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1074_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1074_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1074_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1074_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1074_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1077_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1077_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1077_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1077_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1077_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1084_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1084_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1084_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1084_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1084_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1087_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1087_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1087_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1087_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1087_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1094_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1094_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1094_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1094_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1094_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1097_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1097_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1097_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1097_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1097_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1124_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1124_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1124_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1124_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1124_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1127_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1127_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1127_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1127_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1127_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1230_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1230_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1230_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1230_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE1230_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE4072_0_I2C_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE4072_0_SPI_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE4072_0_UART1_U1 U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_RTCM_3X_TYPE4072_0_UART2_U1 U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_ALG_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_ALG_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_ALG_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_ALG_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_ALG_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_INS_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_INS_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_INS_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_INS_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_INS_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_MEAS_I2C_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_MEAS_SPI_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_MEAS_UART1_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_MEAS_UART2_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_MEAS_USB_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_RAW_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_RAW_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_RAW_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_RAW_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_RAW_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_STATUS_I2C_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_STATUS_SPI_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_STATUS_UART1_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_STATUS_UART2_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_ESF_STATUS_USB_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_LOG_INFO_I2C_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_LOG_INFO_SPI_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_LOG_INFO_UART1_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_LOG_INFO_UART2_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_LOG_INFO_USB_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_COMMS_I2C_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_COMMS_SPI_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_COMMS_UART1_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_COMMS_UART2_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_COMMS_USB_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_HW2_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_HW2_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_HW2_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_HW2_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_HW2_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_HW3_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_HW3_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_HW3_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_HW3_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_HW3_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_HW_I2C_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_HW_SPI_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_HW_UART1_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_HW_UART2_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_HW_USB_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_IO_I2C_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_IO_SPI_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_IO_UART1_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_IO_UART2_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_IO_USB_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_MSGPP_I2C_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_MSGPP_SPI_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_MSGPP_UART1_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_MSGPP_UART2_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_MSGPP_USB_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_RF_I2C_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_RF_SPI_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_RF_UART1_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_RF_UART2_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_RF_USB_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_RXBUF_I2C_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_RXBUF_SPI_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_RXBUF_UART1_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_RXBUF_UART2_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_RXBUF_USB_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_RXR_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_RXR_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_RXR_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_RXR_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_RXR_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_SPAN_I2C_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_SPAN_SPI_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_SPAN_UART1_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_SPAN_UART2_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_SPAN_USB_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_SYS_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_SYS_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_SYS_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_SYS_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_SYS_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_TXBUF_I2C_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_TXBUF_SPI_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_TXBUF_UART1_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_TXBUF_UART2_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_MON_TXBUF_USB_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_CLOCK_I2C_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_CLOCK_SPI_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_CLOCK_UART1_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_CLOCK_UART2_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_CLOCK_USB_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_COV_I2C_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_COV_SPI_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_COV_UART1_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_COV_UART2_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_COV_USB_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_DOP_I2C_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_DOP_SPI_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_DOP_UART1_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_DOP_UART2_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_DOP_USB_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_EOE_I2C_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_EOE_SPI_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_EOE_UART1_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_EOE_UART2_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_EOE_USB_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_ODO_I2C_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_ODO_SPI_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_ODO_UART1_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_ODO_UART2_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_ODO_USB_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_POSECEF_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_POSECEF_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_POSECEF_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_POSECEF_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_POSECEF_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_POSLLH_I2C_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_POSLLH_SPI_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_POSLLH_UART1_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_POSLLH_UART2_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_POSLLH_USB_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_PVT_I2C_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_PVT_SPI_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_PVT_UART1_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_PVT_UART2_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_PVT_USB_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SAT_I2C_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SAT_SPI_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SAT_UART1_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SAT_UART2_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SAT_USB_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SBAS_I2C_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SBAS_SPI_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SBAS_UART1_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SBAS_UART2_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SBAS_USB_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SIG_I2C_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SIG_SPI_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SIG_UART1_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SIG_UART2_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SIG_USB_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SLAS_I2C_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SLAS_SPI_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SLAS_UART1_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SLAS_UART2_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SLAS_USB_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_STATUS_I2C_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_STATUS_SPI_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_STATUS_UART1_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_STATUS_UART2_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_STATUS_USB_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SVIN_I2C_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SVIN_SPI_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SVIN_UART1_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SVIN_UART2_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_SVIN_USB_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEBDS_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEBDS_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEBDS_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEBDS_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEBDS_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEGAL_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEGAL_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEGAL_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEGAL_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEGAL_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEGLO_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEGLO_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEGLO_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEGLO_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEGLO_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEGPS_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEGPS_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEGPS_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEGPS_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEGPS_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMELS_I2C_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMELS_SPI_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMELS_UART1_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMELS_UART2_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMELS_USB_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEQZSS_I2C_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEQZSS_SPI_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEQZSS_UART1_U1  U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEQZSS_UART2_U1  U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEQZSS_USB_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEUTC_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEUTC_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEUTC_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEUTC_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_TIMEUTC_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_VELECEF_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_VELECEF_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_VELECEF_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_VELECEF_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_VELECEF_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_VELNED_I2C_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_VELNED_SPI_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_VELNED_UART1_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_VELNED_UART2_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV2_VELNED_USB_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_AOPSTATUS_I2C_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_AOPSTATUS_SPI_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_AOPSTATUS_UART1_U1  U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_AOPSTATUS_UART2_U1  U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_AOPSTATUS_USB_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_CLOCK_I2C_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_CLOCK_SPI_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_CLOCK_UART1_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_CLOCK_UART2_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_CLOCK_USB_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_COV_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_COV_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_COV_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_COV_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_COV_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_DOP_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_DOP_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_DOP_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_DOP_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_DOP_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_EOE_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_EOE_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_EOE_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_EOE_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_EOE_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_GEOFENCE_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_GEOFENCE_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_GEOFENCE_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_GEOFENCE_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_GEOFENCE_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_HPPOSECEF_I2C_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_HPPOSECEF_SPI_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_HPPOSECEF_UART1_U1  U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_HPPOSECEF_UART2_U1  U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_HPPOSECEF_USB_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_HPPOSLLH_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_HPPOSLLH_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_HPPOSLLH_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_HPPOSLLH_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_HPPOSLLH_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_ODO_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_ODO_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_ODO_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_ODO_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_ODO_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_ORB_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_ORB_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_ORB_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_ORB_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_ORB_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_PL_I2C_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_PL_SPI_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_PL_UART1_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_PL_UART2_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_PL_USB_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_POSECEF_I2C_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_POSECEF_SPI_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_POSECEF_UART1_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_POSECEF_UART2_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_POSECEF_USB_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_POSLLH_I2C_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_POSLLH_SPI_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_POSLLH_UART1_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_POSLLH_UART2_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_POSLLH_USB_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_PVT_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_PVT_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_PVT_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_PVT_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_PVT_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_RELPOSNED_I2C_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_RELPOSNED_SPI_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_RELPOSNED_UART1_U1  U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_RELPOSNED_UART2_U1  U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_RELPOSNED_USB_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SAT_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SAT_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SAT_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SAT_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SAT_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SBAS_I2C_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SBAS_SPI_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SBAS_UART1_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SBAS_UART2_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SBAS_USB_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SIG_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SIG_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SIG_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SIG_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SIG_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SLAS_I2C_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SLAS_SPI_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SLAS_UART1_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SLAS_UART2_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SLAS_USB_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_STATUS_I2C_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_STATUS_SPI_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_STATUS_UART1_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_STATUS_UART2_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_STATUS_USB_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SVIN_I2C_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SVIN_SPI_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SVIN_UART1_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SVIN_UART2_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_SVIN_USB_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEBDS_I2C_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEBDS_SPI_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEBDS_UART1_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEBDS_UART2_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEBDS_USB_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEGAL_I2C_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEGAL_SPI_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEGAL_UART1_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEGAL_UART2_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEGAL_USB_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEGLO_I2C_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEGLO_SPI_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEGLO_UART1_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEGLO_UART2_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEGLO_USB_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEGPS_I2C_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEGPS_SPI_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEGPS_UART1_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEGPS_UART2_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEGPS_USB_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMELS_I2C_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMELS_SPI_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMELS_UART1_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMELS_UART2_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMELS_USB_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEQZSS_I2C_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEQZSS_SPI_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEQZSS_UART1_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEQZSS_UART2_U1   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEQZSS_USB_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEUTC_I2C_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEUTC_SPI_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEUTC_UART1_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEUTC_UART2_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_TIMEUTC_USB_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_VELECEF_I2C_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_VELECEF_SPI_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_VELECEF_UART1_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_VELECEF_UART2_U1    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_VELECEF_USB_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_VELNED_I2C_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_VELNED_SPI_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_VELNED_UART1_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_VELNED_UART2_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_NAV_VELNED_USB_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_COR_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_COR_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_COR_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_COR_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_COR_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_MEASX_I2C_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_MEASX_SPI_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_MEASX_UART1_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_MEASX_UART2_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_MEASX_USB_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_PMP_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_PMP_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_PMP_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_PMP_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_PMP_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_QZSSL6_UART1_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_QZSSL6_UART2_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_QZSSL6_USB_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_QZSSL6_I2C_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_QZSSL6_SPI_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_RAWX_I2C_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_RAWX_SPI_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_RAWX_UART1_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_RAWX_UART2_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_RAWX_USB_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_RLM_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_RLM_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_RLM_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_RLM_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_RLM_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_RTCM_I2C_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_RTCM_SPI_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_RTCM_UART1_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_RTCM_UART2_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_RTCM_USB_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_SFRBX_I2C_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_SFRBX_SPI_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_SFRBX_UART1_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_SFRBX_UART2_U1      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_SFRBX_USB_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_SPARTN_I2C_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_SPARTN_SPI_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_SPARTN_UART1_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_SPARTN_UART2_U1     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_RXM_SPARTN_USB_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_TIM_TM2_I2C_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_TIM_TM2_SPI_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_TIM_TM2_UART1_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_TIM_TM2_UART2_U1        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_TIM_TM2_USB_U1          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_TIM_TP_I2C_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_TIM_TP_SPI_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_TIM_TP_UART1_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_TIM_TP_UART2_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_TIM_TP_USB_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_TIM_VRFY_I2C_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_TIM_VRFY_SPI_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_TIM_VRFY_UART1_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_TIM_VRFY_UART2_U1       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_MSGOUT_UBX_TIM_VRFY_USB_U1         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAV2_OUT_ENABLED_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAV2_SBAS_USE_INTEGRITY_L          U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVHPG_DGNSSMODE_E1                U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_FIXMODE_E1                  U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_INIFIX3D_L                  U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_WKNROLLOVER_U2              U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_USE_PPP_L                   U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_UTCSTANDARD_E1              U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_DYNMODEL_E1                 U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_ACKAIDING_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_USRDAT_L                    U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_USRDAT_MAJA_R8              U_GNSS_CFG_VAL_KEY_TYPE_R
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_USRDAT_FLAT_R8              U_GNSS_CFG_VAL_KEY_TYPE_R
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_USRDAT_DX_R4                U_GNSS_CFG_VAL_KEY_TYPE_R
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_USRDAT_DY_R4                U_GNSS_CFG_VAL_KEY_TYPE_R
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_USRDAT_DZ_R4                U_GNSS_CFG_VAL_KEY_TYPE_R
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_USRDAT_ROTX_R4              U_GNSS_CFG_VAL_KEY_TYPE_R
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_USRDAT_ROTY_R4              U_GNSS_CFG_VAL_KEY_TYPE_R
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_USRDAT_ROTZ_R4              U_GNSS_CFG_VAL_KEY_TYPE_R
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_USRDAT_SCALE_R4             U_GNSS_CFG_VAL_KEY_TYPE_R
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_INFIL_MINSVS_U1             U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_INFIL_MAXSVS_U1             U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_INFIL_MINCNO_U1             U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_INFIL_MINELEV_I1            U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_INFIL_NCNOTHRS_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_INFIL_CNOTHRS_U1            U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_OUTFIL_PDOP_U2              U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_OUTFIL_TDOP_U2              U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_OUTFIL_PACC_U2              U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_OUTFIL_TACC_U2              U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_OUTFIL_FACC_U2              U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_CONSTR_ALT_I4               U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_CONSTR_ALTVAR_U4            U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_CONSTR_DGNSSTO_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_SIGATTCOMP_E1               U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NAVSPG_PL_ENA_L                    U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_PROTVER_E1                    U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_MAXSVS_E1                     U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_COMPAT_L                      U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_CONSIDER_L                    U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_LIMIT82_L                     U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_HIGHPREC_L                    U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_SVNUMBERING_E1                U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_FILT_GPS_L                    U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_FILT_SBAS_L                   U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_FILT_GAL_L                    U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_FILT_QZSS_L                   U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_FILT_GLO_L                    U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_FILT_BDS_L                    U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_OUT_INVFIX_L                  U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_OUT_MSKFIX_L                  U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_OUT_INVTIME_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_OUT_INVDATE_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_OUT_ONLYGPS_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_OUT_FROZENCOG_L               U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_MAINTALKERID_E1               U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_GSVTALKERID_E1                U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_NMEA_BDSTALKERID_U2                U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_ODO_USE_ODO_L                      U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_ODO_USE_COG_L                      U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_ODO_OUTLPVEL_L                     U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_ODO_OUTLPCOG_L                     U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_ODO_PROFILE_E1                     U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_ODO_COGMAXSPEED_U1                 U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_ODO_COGMAXPOSACC_U1                U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_ODO_VELLPGAIN_U1                   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_ODO_COGLPGAIN_U1                   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PM_OPERATEMODE_E1                  U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PM_POSUPDATEPERIOD_U4              U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PM_ACQPERIOD_U4                    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PM_GRIDOFFSET_U4                   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PM_ONTIME_U2                       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PM_MINACQTIME_U1                   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PM_MAXACQTIME_U1                   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PM_ONOTENTEROFF_L                  U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PM_WAITTIMEFIX_L                   U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PM_UPDATEEPH_L                     U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PM_EXTINTSEL_E1                    U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PM_EXTINTWAKE_L                    U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PM_EXTINTBACKUP_L                  U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PM_EXTINTINACTIVE_L                U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PM_EXTINTINACTIVITY_U4             U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PM_LIMITPEAKCURR_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PMP_CENTER_FREQUENCY_U4            U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PMP_SEARCH_WINDOW_U2               U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PMP_USE_SERVICE_ID_L               U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PMP_SERVICE_ID_U2                  U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PMP_DATA_RATE_E2                   U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PMP_USE_DESCRAMBLER_L              U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PMP_DESCRAMBLER_INIT_U2            U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PMP_USE_PRESCRAMBLING_L            U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_PMP_UNIQUE_WORD_U8                 U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_QZSS_USE_SLAS_DGNSS_L              U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_QZSS_USE_SLAS_TESTMODE_L           U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_QZSS_USE_SLAS_RAIM_UNCORR_L        U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_QZSS_SLAS_MAX_BASELINE_U2          U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_QZSS_L6_SVIDA_I1                   U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_QZSS_L6_SVIDB_I1                   U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_QZSS_L6_MSGA_E1                    U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_QZSS_L6_MSGB_E1                    U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_QZSS_L6_RSDECODER_E1               U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_RATE_MEAS_U2                       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_RATE_NAV_U2                        U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_RATE_TIMEREF_E1                    U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_RINV_DUMP_L                        U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_RINV_BINARY_L                      U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_RINV_DATA_SIZE_U1                  U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_RINV_CHUNK0_X8                     U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_RINV_CHUNK1_X8                     U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_RINV_CHUNK2_X8                     U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_RINV_CHUNK3_X8                     U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_RTCM_DF003_OUT_U2                  U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_RTCM_DF003_IN_U2                   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_RTCM_DF003_IN_FILTER_E1            U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SBAS_USE_TESTMODE_L                U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SBAS_USE_RANGING_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SBAS_USE_DIFFCORR_L                U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SBAS_USE_INTEGRITY_L               U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SBAS_PRNSCANMASK_X8                U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SEC_CFG_LOCK_L                     U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SEC_CFG_LOCK_UNLOCKGRP1_U2         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SEC_CFG_LOCK_UNLOCKGRP2_U2         U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFCORE_USE_SF_L                    U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFIMU_GYRO_TC_UPDATE_PERIOD_U2     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFIMU_GYRO_RMSTHDL_U1              U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFIMU_GYRO_FREQUENCY_U1            U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFIMU_GYRO_LATENCY_U2              U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFIMU_GYRO_ACCURACY_U2             U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFIMU_ACCEL_RMSTHDL_U1             U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFIMU_ACCEL_FREQUENCY_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFIMU_ACCEL_LATENCY_U2             U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFIMU_ACCEL_ACCURACY_U2            U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFIMU_IMU_EN_L                     U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFIMU_IMU_I2C_SCL_PIO_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFIMU_IMU_I2C_SDA_PIO_U1           U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFIMU_AUTO_MNTALG_ENA_L            U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFIMU_IMU_MNTALG_YAW_U4            U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFIMU_IMU_MNTALG_PITCH_I2          U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFIMU_IMU_MNTALG_ROLL_I2           U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFODO_COMBINE_TICKS_L              U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFODO_USE_SPEED_L                  U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFODO_DIS_AUTOCOUNTMAX_L           U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFODO_DIS_AUTODIRPINPOL_L          U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFODO_DIS_AUTOSPEED_L              U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFODO_FACTOR_U4                    U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFODO_QUANT_ERROR_U4               U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFODO_COUNT_MAX_U4                 U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFODO_LATENCY_U2                   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFODO_FREQUENCY_U1                 U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFODO_CNT_BOTH_EDGES_L             U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFODO_SPEED_BAND_U2                U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFODO_USE_WT_PIN_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFODO_DIR_PINPOL_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SFODO_DIS_AUTOSW_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SIGNAL_GPS_ENA_L                   U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SIGNAL_GPS_L1CA_ENA_L              U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SIGNAL_GPS_L2C_ENA_L               U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SIGNAL_SBAS_ENA_L                  U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SIGNAL_SBAS_L1CA_ENA_L             U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SIGNAL_GAL_ENA_L                   U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SIGNAL_GAL_E1_ENA_L                U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SIGNAL_GAL_E5B_ENA_L               U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SIGNAL_BDS_ENA_L                   U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SIGNAL_BDS_B1_ENA_L                U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SIGNAL_BDS_B2_ENA_L                U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SIGNAL_QZSS_ENA_L                  U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SIGNAL_QZSS_L1CA_ENA_L             U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SIGNAL_QZSS_L1S_ENA_L              U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SIGNAL_QZSS_L2C_ENA_L              U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SIGNAL_GLO_ENA_L                   U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SIGNAL_GLO_L1_ENA_L                U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SIGNAL_GLO_L2_ENA_L                U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SPARTN_USE_SOURCE_E1               U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SPI_MAXFF_U1                       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SPI_CPOLARITY_L                    U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SPI_CPHASE_L                       U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SPI_EXTENDEDTIMEOUT_L              U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SPI_ENABLED_L                      U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SPIINPROT_UBX_L                    U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SPIINPROT_NMEA_L                   U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SPIINPROT_RTCM3X_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SPIINPROT_SPARTN_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SPIOUTPROT_UBX_L                   U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SPIOUTPROT_NMEA_L                  U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_SPIOUTPROT_RTCM3X_L                U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TMODE_MODE_E1                      U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TMODE_POS_TYPE_E1                  U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TMODE_ECEF_X_I4                    U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TMODE_ECEF_Y_I4                    U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TMODE_ECEF_Z_I4                    U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TMODE_ECEF_X_HP_I1                 U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TMODE_ECEF_Y_HP_I1                 U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TMODE_ECEF_Z_HP_I1                 U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TMODE_LAT_I4                       U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TMODE_LON_I4                       U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TMODE_HEIGHT_I4                    U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TMODE_LAT_HP_I1                    U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TMODE_LON_HP_I1                    U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TMODE_HEIGHT_HP_I1                 U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TMODE_FIXED_POS_ACC_U4             U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TMODE_SVIN_MIN_DUR_U4              U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TMODE_SVIN_ACC_LIMIT_U4            U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_PULSE_DEF_E1                    U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_PULSE_LENGTH_DEF_E1             U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_ANT_CABLEDELAY_I2               U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_PERIOD_TP1_U4                   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_PERIOD_LOCK_TP1_U4              U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_FREQ_TP1_U4                     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_FREQ_LOCK_TP1_U4                U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_LEN_TP1_U4                      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_LEN_LOCK_TP1_U4                 U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_DUTY_TP1_R8                     U_GNSS_CFG_VAL_KEY_TYPE_R
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_DUTY_LOCK_TP1_R8                U_GNSS_CFG_VAL_KEY_TYPE_R
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_USER_DELAY_TP1_I4               U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_TP1_ENA_L                       U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_SYNC_GNSS_TP1_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_USE_LOCKED_TP1_L                U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_ALIGN_TO_TOW_TP1_L              U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_POL_TP1_L                       U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_TIMEGRID_TP1_E1                 U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_DRSTR_TP1_E1                    U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_PERIOD_TP2_U4                   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_PERIOD_LOCK_TP2_U4              U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_FREQ_TP2_U4                     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_FREQ_LOCK_TP2_U4                U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_LEN_TP2_U4                      U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_LEN_LOCK_TP2_U4                 U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_DUTY_TP2_R8                     U_GNSS_CFG_VAL_KEY_TYPE_R
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_DUTY_LOCK_TP2_R8                U_GNSS_CFG_VAL_KEY_TYPE_R
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_USER_DELAY_TP2_I4               U_GNSS_CFG_VAL_KEY_TYPE_I
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_TP2_ENA_L                       U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_SYNC_GNSS_TP2_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_USE_LOCKED_TP2_L                U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_ALIGN_TO_TOW_TP2_L              U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_POL_TP2_L                       U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_TIMEGRID_TP2_E1                 U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TP_DRSTR_TP2_E1                    U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TXREADY_ENABLED_L                  U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TXREADY_POLARITY_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TXREADY_PIN_U1                     U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TXREADY_THRESHOLD_U2               U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_TXREADY_INTERFACE_E1               U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART1_BAUDRATE_U4                  U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART1_STOPBITS_E1                  U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART1_DATABITS_E1                  U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART1_PARITY_E1                    U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART1_ENABLED_L                    U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART1INPROT_UBX_L                  U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART1INPROT_NMEA_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART1INPROT_RTCM3X_L               U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART1INPROT_SPARTN_L               U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART1OUTPROT_UBX_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART1OUTPROT_NMEA_L                U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART1OUTPROT_RTCM3X_L              U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART2_BAUDRATE_U4                  U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART2_STOPBITS_E1                  U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART2_DATABITS_E1                  U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART2_PARITY_E1                    U_GNSS_CFG_VAL_KEY_TYPE_E
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART2_ENABLED_L                    U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART2INPROT_UBX_L                  U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART2INPROT_NMEA_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART2INPROT_RTCM3X_L               U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART2INPROT_SPARTN_L               U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART2OUTPROT_UBX_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART2OUTPROT_NMEA_L                U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_UART2OUTPROT_RTCM3X_L              U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USB_ENABLED_L                      U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USB_SELFPOW_L                      U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USB_VENDOR_ID_U2                   U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USB_PRODUCT_ID_U2                  U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USB_POWER_U2                       U_GNSS_CFG_VAL_KEY_TYPE_U
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USB_VENDOR_STR0_X8                 U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USB_VENDOR_STR1_X8                 U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USB_VENDOR_STR2_X8                 U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USB_VENDOR_STR3_X8                 U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USB_PRODUCT_STR0_X8                U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USB_PRODUCT_STR1_X8                U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USB_PRODUCT_STR2_X8                U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USB_PRODUCT_STR3_X8                U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USB_SERIAL_NO_STR0_X8              U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USB_SERIAL_NO_STR1_X8              U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USB_SERIAL_NO_STR2_X8              U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USB_SERIAL_NO_STR3_X8              U_GNSS_CFG_VAL_KEY_TYPE_X
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USBINPROT_UBX_L                    U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USBINPROT_NMEA_L                   U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USBINPROT_RTCM3X_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USBINPROT_SPARTN_L                 U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USBOUTPROT_UBX_L                   U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USBOUTPROT_NMEA_L                  U_GNSS_CFG_VAL_KEY_TYPE_L
+#define U_GNSS_CFG_VAL_KEY_TYPE_ID_USBOUTPROT_RTCM3X_L                U_GNSS_CFG_VAL_KEY_TYPE_L
+
 // *** DO NOT MODIFY THIS LINE OR ABOVE: DO NOT MODIFY AREA ENDS ***
 
 #ifdef __cplusplus
@@ -42,6 +42,12 @@ import platform # Figure out current OS
 #
 #    #define U_GNSS_CFG_VAL_KEY_ID_ANA_USE_ANA_L 0x10230001
 #
+#    ...and a macro giving the type of the value (a member of
+#    the enum uGnssCfgValKeyType_t, taken from the letter of the
+#    size indicator, L in this case), e.g.:
+#
+#    #define U_GNSS_CFG_VAL_KEY_TYPE_ID_ANA_USE_ANA_L U_GNSS_CFG_VAL_KEY_TYPE_L
+#
 # 5. It looks for two markers in the file:
 #
 #    // *** DO NOT MODIFY THIS LINE OR BELOW: AUTO-GENERATED BY u_gnss_cfg_val_key.py ***
@@ -84,6 +90,16 @@ ENUM_NAME_POSTFIX = "_t"
 # The prefix to expect on every item
 ENUM_ENTRY_PREFIX_ITEMS = ENUM_ENTRY_PREFIX_ALL + "ITEM_"
 
+# The prefix of the generated key ID macros
+MACRO_PREFIX_KEY_ID = ENUM_ENTRY_PREFIX_ALL + "ID_"
+
+# The prefix of the generated key type macros
+MACRO_PREFIX_KEY_TYPE = ENUM_ENTRY_PREFIX_ALL + "TYPE_ID_"
+
+# The prefix of the entries in the key type enum, uGnssCfgValKeyType_t,
+# each of which is followed by the letter of the size indicator
+ENUM_ENTRY_PREFIX_KEY_TYPE = ENUM_ENTRY_PREFIX_ALL + "TYPE_"
+
 # The marker to look for, beyond which we can re-write the target
 # file up to FILE_REWRITE_MARKER_END
 FILE_REWRITE_MARKER_START = "// *** DO NOT MODIFY THIS LINE OR BELOW: AUTO-GENERATED BY u_gnss_cfg_val_key.py ***"
@@ -211,6 +227,11 @@ def convert_group_id_to_items(group_id_name):
 
     return enum_name_items, enum_entry_prefix_items + "_"
 
+def get_key_type(item_tuple):
+    ''' Get the uGnssCfgValKeyType_t entry for an item tuple from its size indicator '''
+    bits = item_tuple[0].split("_")
+    return ENUM_ENTRY_PREFIX_KEY_TYPE + bits[len(bits) - 1][0]
+
 def create_key_id(item_tuple, group_id_value, key_size_list):
     ''' Create a key ID from an item tuple, the group ID value and the key size enum '''
     key_id = -1
@@ -251,6 +272,8 @@ def rewrite_line_list(key_id_list, input_line_list):
         # Run through the list to determine the column offset for the value field
         if len(key_id_tuple[0]) > column_offset:
             column_offset = len(key_id_tuple[0])
+    # The type macros have a longer prefix, keep them lined up among themselves
+    column_offset_type = column_offset + len(MACRO_PREFIX_KEY_TYPE) - len(MACRO_PREFIX_KEY_ID)
 
     for idx, line in enumerate(input_line_list):
         # Make a list of all lines up to and include the start marker
@@ -267,6 +290,14 @@ def rewrite_line_list(key_id_list, input_line_list):
             for _ in range(len(key_id_tuple[0]), column_offset):
                 output_line += " "
             output_line_list_two.append(output_line + hex(key_id_tuple[1]) + "\n")
+        # Then the type macros, after a blank line
+        output_line_list_two.append("\n")
+        for key_id_tuple in key_id_list:
+            name = key_id_tuple[0].replace(MACRO_PREFIX_KEY_ID, MACRO_PREFIX_KEY_TYPE, 1)
+            output_line = "#define " + name + " "
+            for _ in range(len(name), column_offset_type):
+                output_line += " "
+            output_line_list_two.append(output_line + key_id_tuple[2] + "\n")
         # Make a list of all lines from [including] the end marker to the end of the list
         for idx, line in enumerate(input_line_list[start_marker_index:]):
             if end_marker_index < 0 and line.startswith(FILE_REWRITE_MARKER_END):
@@ -359,7 +390,8 @@ def main(target_file):
                                 key_id = create_key_id(item_tuple, group_id_tuple[1], key_size_list)
                                 if key_id >= 0:
                                     key_id_list.append((enum_entry_prefix_items.replace("ITEM", "ID") + \
-                                                       item_tuple[0], key_id))
+                                                       item_tuple[0], key_id,                        \
+                                                       get_key_type(item_tuple)))
                                 else: 
                                     print("Could not find key size for item \"{}\";"      \
                                           " does it have an _X on the end, where X"       \
@@ -389,7 +421,7 @@ def main(target_file):
                    format(ENUM_NAME_KEY_SIZE, target_file))
 
         if key_id_list:
-            print(f"{len(key_id_list)} key ID macros created, re-writing file...")
+            print(f"{len(key_id_list)} key ID and key type macros created, re-writing file...")
             # Have a list of key IDs, re-write the line-list using it
             line_list = rewrite_line_list(key_id_list, line_list)
             if line_list:
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_GEOFENCE_H_
+#define _U_GNSS_GEOFENCE_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_device.h"
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the GNSS APIs that configure the
+ * geofences of the GNSS chip itself: up to four circles which the
+ * GNSS chip checks each position against, reporting whether it is
+ * inside or outside them in UBX-NAV-GEOFENCE and, optionally, on a
+ * PIO pin.  This means that, rather than polling uGnssPosGet() and
+ * working out distances itself, the application may be told only
+ * when a boundary is crossed; if the PIO pin is wired to a wake-up
+ * interrupt of this MCU then this MCU may sleep in the meantime.
+ *
+ * These functions are only supported for GNSS chips that support
+ * CFG-VALSET (e.g. M9) and, since they rely on message receive, only
+ * where the GNSS chip is connected directly to this MCU.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The maximum number of geofences that a GNSS chip supports.
+ */
+#define U_GNSS_GEOFENCE_MAX_NUM 4
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A geofence: a circle.
+ */
+typedef struct {
+    int32_t latitudeX1e7;       /**< the latitude of the centre in ten
+                                     millionths of a degree. */
+    int32_t longitudeX1e7;      /**< the longitude of the centre in ten
+                                     millionths of a degree. */
+    uint32_t radiusCentimetres; /**< the radius in centimetres. */
+} uGnssGeofence_t;
+
+/** The confidence with which the GNSS chip must be inside or
+ * outside a geofence for it to report that state, otherwise the
+ * state is unknown; the values match those of CFG-GEOFENCE-CONFLVL.
+ */
+typedef enum {
+    U_GNSS_GEOFENCE_CONFIDENCE_0 = 0,         /**< no confidence required. */
+    U_GNSS_GEOFENCE_CONFIDENCE_68 = 1,        /**< 68%. */
+    U_GNSS_GEOFENCE_CONFIDENCE_95 = 2,        /**< 95%. */
+    U_GNSS_GEOFENCE_CONFIDENCE_99_7 = 3,      /**< 99.7%. */
+    U_GNSS_GEOFENCE_CONFIDENCE_99_99 = 4,     /**< 99.99%. */
+    U_GNSS_GEOFENCE_CONFIDENCE_99_9999 = 5,   /**< 99.9999%. */
+    U_GNSS_GEOFENCE_CONFIDENCE_MAX_NUM
+} uGnssGeofenceConfidence_t;
+
+/** The state of a geofence; the values match those of
+ * UBX-NAV-GEOFENCE.
+ */
+typedef enum {
+    U_GNSS_GEOFENCE_STATE_UNKNOWN = 0,
+    U_GNSS_GEOFENCE_STATE_INSIDE = 1,
+    U_GNSS_GEOFENCE_STATE_OUTSIDE = 2
+} uGnssGeofenceState_t;
+
+/** Callback that is called when the state of any of the geofences
+ * changes, from the task of the GNSS message receiver (see
+ * uGnssMsgReceiveStart()); it should return quickly and must not
+ * call back into the GNSS API.
+ *
+ * @param gnssHandle          the handle of the GNSS instance.
+ * @param combinedState       the combined state of all of the
+ *                            geofences: inside if the position
+ *                            is inside any of them, outside if it
+ *                            is outside all of them.
+ * @param[in] pState          the state of each geofence, in the
+ *                            order they were given to uGnssGeofenceSet().
+ * @param numFences           the number of entries at pState.
+ * @param[in] pCallbackParam  the pCallbackParam passed to
+ *                            uGnssGeofenceSet().
+ */
+typedef void (uGnssGeofenceCallback_t)(uDeviceHandle_t gnssHandle,
+                                       uGnssGeofenceState_t combinedState,
+                                       const uGnssGeofenceState_t *pState,
+                                       size_t numFences,
+                                       void *pCallbackParam);
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Set the geofences of the GNSS chip, replacing any that were
+ * there before.  The settings are made in the RAM layer, i.e. they
+ * are lost if the GNSS chip is reset or powered off.
+ *
+ * If pCallback is not NULL then UBX-NAV-GEOFENCE output is switched
+ * on for the port this MCU is connected to and pCallback is called
+ * each time the state of any geofence changes, including when the
+ * first UBX-NAV-GEOFENCE message arrives.
+ *
+ * @param gnssHandle          the handle of the GNSS instance.
+ * @param[in] pFence          an array of geofences; cannot be NULL.
+ * @param numFences           the number of geofences at pFence,
+ *                            1 to #U_GNSS_GEOFENCE_MAX_NUM.
+ * @param confidence          the confidence required to report a
+ *                            state of inside or outside.
+ * @param pin                 the PIO pin of the GNSS chip on which
+ *                            to output the combined state, -1 for
+ *                            none.
+ * @param pinLowMeansInside   true if the pin should be low when the
+ *                            combined state is inside, false if it
+ *                            should be high; ignored if pin is -1.
+ * @param[in] pCallback       the callback for changes of state, may
+ *                            be NULL.
+ * @param[in] pCallbackParam  a parameter that will be passed to
+ *                            pCallback.
+ * @return                    zero on success or negative error code.
+ */
+int32_t uGnssGeofenceSet(uDeviceHandle_t gnssHandle,
+                         const uGnssGeofence_t *pFence,
+                         size_t numFences,
+                         uGnssGeofenceConfidence_t confidence,
+                         int32_t pin, bool pinLowMeansInside,
+                         uGnssGeofenceCallback_t *pCallback,
+                         void *pCallbackParam);
+
+/** Switch off all of the geofences of the GNSS chip, and the PIO pin
+ * output and UBX-NAV-GEOFENCE output that go with them; once this
+ * returns the callback passed to uGnssGeofenceSet() will not be
+ * called again.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ * @return            zero on success or negative error code.
+ */
+int32_t uGnssGeofenceClear(uDeviceHandle_t gnssHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_GEOFENCE_H_
+
+// End of file
@@ -55,6 +55,23 @@ typedef struct {
     char mod[27];   //<! Module  Variant
 } uGnssVersionType_t; //!< return structs with different information
 
+/** Callback that is called when uGnssInfoGetVersionsAsync() completes.
+ *
+ * @param gnssHandle          the handle of the GNSS instance.
+ * @param errorCode           zero on success, #U_ERROR_COMMON_TIMEOUT
+ *                            if there was no response within
+ *                            uGnssGetTimeout(), else negative error code.
+ * @param[in] pVer            the version information, valid only for
+ *                            the duration of the callback; NULL if
+ *                            errorCode is not zero.
+ * @param[in] pCallbackParam  the pCallbackParam passed to
+ *                            uGnssInfoGetVersionsAsync().
+ */
+typedef void (uGnssInfoVersionsCallback_t)(uDeviceHandle_t gnssHandle,
+                                           int32_t errorCode,
+                                           const uGnssVersionType_t *pVer,
+                                           void *pCallbackParam);
+
 /** Array of communications as seen by the GNSS chip.
  */
 typedef struct {
@@ -120,6 +137,30 @@ int32_t uGnssInfoGetFirmwareVersionStr(uDeviceHandle_t gnssHandle,
 int32_t uGnssInfoGetVersions(uDeviceHandle_t gnssHandle,
                              uGnssVersionType_t *pVer);
 
+/** A non-blocking version of uGnssInfoGetVersions(): the UBX-MON-VER
+ * poll is sent and this function returns; the response is picked up
+ * by the message receive task (see uGnssMsgReceiveStartOneShot())
+ * and passed to pCallback, so the calling task does not wait out the
+ * round trip to the GNSS chip.  Only supported where the GNSS chip is
+ * connected directly to this MCU via a streaming transport (UART or
+ * I2C).
+ *
+ * @param gnssHandle          the handle of the GNSS instance.
+ * @param[in] pCallback       the callback that will be called with
+ *                            the outcome, in the context of the
+ *                            message receive task and hence subject
+ *                            to the same rules as the callback of
+ *                            uGnssMsgReceiveStart(); cannot be NULL.
+ * @param[in] pCallbackParam  a parameter to pass to pCallback; may
+ *                            be NULL.
+ * @return                    zero if the request has been sent, in
+ *                            which case pCallback will be called
+ *                            exactly once, else negative error code.
+ */
+int32_t uGnssInfoGetVersionsAsync(uDeviceHandle_t gnssHandle,
+                                  uGnssInfoVersionsCallback_t *pCallback,
+                                  void *pCallbackParam);
+
 /** Get the chip ID from the GNSS chip.
  *
  * @param gnssHandle  the handle of the GNSS instance.
@@ -0,0 +1,226 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_MGA_H_
+#define _U_GNSS_MGA_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_device.h"
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the multiple GNSS assistance (MGA)
+ * API of GNSS, which may be used to write AssistNow Online or
+ * AssistNow Offline data, or data previously read from the GNSS
+ * chip with UBX-MGA-DBD, to the GNSS chip in order to reduce the
+ * time to first fix.  The data, a sequence of UBX-MGA-XXX messages,
+ * must be obtained by the application, e.g. from an HTTP GET request
+ * to the u-blox AssistNow service; it may be provided either in a
+ * single buffer, with uGnssMgaSend(), or in chunks through a read
+ * callback, with uGnssMgaSendRead(), so that the data can be fed from
+ * a file or straight from a socket without having to hold all of it
+ * in RAM.  These functions are only supported where the GNSS chip
+ * is connected directly to this MCU via a streaming transport (UART
+ * or I2C).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_GNSS_MGA_MESSAGE_BODY_MAX_LENGTH_BYTES
+/** The maximum length of the body of a UBX-MGA-XXX message that
+ * can be sent; this much heap will be allocated, plus UBX protocol
+ * overhead, while uGnssMgaSend() or uGnssMgaSendRead() is running.
+ * UBX-MGA-XXX messages from the AssistNow services are all
+ * well within this limit; any longer message is skipped.
+ */
+# define U_GNSS_MGA_MESSAGE_BODY_MAX_LENGTH_BYTES 256
+#endif
+
+#ifndef U_GNSS_MGA_READ_CHUNK_LENGTH_BYTES
+/** The size of the chunk that uGnssMgaSendRead() asks the read
+ * callback for; this much heap will be allocated in addition
+ * to #U_GNSS_MGA_MESSAGE_BODY_MAX_LENGTH_BYTES while
+ * uGnssMgaSendRead() is running.
+ */
+# define U_GNSS_MGA_READ_CHUNK_LENGTH_BYTES 128
+#endif
+
+#ifndef U_GNSS_MGA_ACK_RETRIES
+/** The number of times a UBX-MGA-XXX message is re-sent if it
+ * is not acknowledged with UBX-MGA-ACK when the flow control
+ * is #U_GNSS_MGA_FLOW_CONTROL_ACK.
+ */
+# define U_GNSS_MGA_ACK_RETRIES 2
+#endif
+
+#ifndef U_GNSS_MGA_INTER_MESSAGE_DELAY_MS
+/** The delay between UBX-MGA-XXX messages when the flow control
+ * is #U_GNSS_MGA_FLOW_CONTROL_WAIT; the GNSS chip has a limited
+ * amount of input buffer and so, if the messages are not
+ * acknowledged, the rate at which they are sent must be limited.
+ */
+# define U_GNSS_MGA_INTER_MESSAGE_DELAY_MS 20
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The flow control to use when sending UBX-MGA-XXX messages
+ * to the GNSS chip.
+ */
+typedef enum {
+    U_GNSS_MGA_FLOW_CONTROL_ACK, /**< switch on acknowledgement of
+                                      assistance data in the GNSS chip
+                                      (in RAM only) and wait for
+                                      UBX-MGA-ACK after each message,
+                                      re-sending it up to
+                                      #U_GNSS_MGA_ACK_RETRIES times if
+                                      there is no UBX-MGA-ACK; this is
+                                      the safest option.  The only
+                                      exception is UBX-MGA-DBD, which
+                                      the GNSS chip does not acknowledge
+                                      and which is hence sent as for
+                                      #U_GNSS_MGA_FLOW_CONTROL_WAIT. */
+    U_GNSS_MGA_FLOW_CONTROL_WAIT, /**< wait for
+                                       #U_GNSS_MGA_INTER_MESSAGE_DELAY_MS
+                                       between messages. */
+    U_GNSS_MGA_FLOW_CONTROL_NONE, /**< send the messages as fast as
+                                       possible: only use this if the
+                                       data rate of the transport is
+                                       low compared with the rate at
+                                       which the GNSS chip can process
+                                       the messages, or if the
+                                       application does its own pacing
+                                       in the read callback. */
+    U_GNSS_MGA_FLOW_CONTROL_MAX_NUM
+} uGnssMgaFlowControl_t;
+
+/** Callback that provides a chunk of UBX-MGA-XXX data to
+ * uGnssMgaSendRead(), e.g. from a file or a socket.  The data
+ * need not be split on message boundaries.
+ *
+ * @param gnssHandle          the handle of the GNSS instance.
+ * @param[out] pBuffer        a place to put the data, never NULL.
+ * @param size                the amount of storage at pBuffer.
+ * @param[in] pCallbackParam  the pReadCallbackParam passed to
+ *                            uGnssMgaSendRead().
+ * @return                    the number of bytes written to
+ *                            pBuffer, zero when there is no more
+ *                            data, or negative error code, which
+ *                            will stop uGnssMgaSendRead().
+ */
+typedef int32_t (uGnssMgaReadCallback_t)(uDeviceHandle_t gnssHandle,
+                                          char *pBuffer, size_t size,
+                                          void *pCallbackParam);
+
+/** Callback that is called by uGnssMgaSend()/uGnssMgaSendRead()
+ * after each UBX-MGA-XXX message has been sent.
+ *
+ * @param gnssHandle          the handle of the GNSS instance.
+ * @param errorCode           zero if the message was sent (and, where
+ *                            the flow control is #U_GNSS_MGA_FLOW_CONTROL_ACK,
+ *                            accepted), #U_GNSS_ERROR_NACK if
+ *                            the GNSS chip did not use the message
+ *                            (e.g. because it did not yet know the
+ *                            time), else negative error code.
+ * @param messageCount        the number of messages that have been
+ *                            sent so far, including this one.
+ * @param[in] pCallbackParam  the pProgressCallbackParam passed to
+ *                            uGnssMgaSend()/uGnssMgaSendRead().
+ * @return                    true to continue, false to stop sending.
+ */
+typedef bool (uGnssMgaProgressCallback_t)(uDeviceHandle_t gnssHandle,
+                                          int32_t errorCode,
+                                          size_t messageCount,
+                                          void *pCallbackParam);
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Send a buffer of UBX-MGA-XXX messages, e.g. the response to an
+ * AssistNow Online request, to the GNSS chip.  Anything in the buffer
+ * that is not a valid UBX-format UBX-MGA-XXX message is ignored.  The
+ * GNSS API mutex is released between messages so other GNSS
+ * operations may take place while this function is running.  The
+ * GNSS chip must be connected directly to this MCU via a streaming
+ * transport (UART or I2C).
+ *
+ * @param gnssHandle              the handle of the GNSS instance.
+ * @param[in] pBuffer             the UBX-MGA-XXX messages; cannot be NULL.
+ * @param size                    the amount of data at pBuffer.
+ * @param flowControl             the flow control to use.
+ * @param[in] pProgressCallback   a callback that will be called after
+ *                                each message is sent; may be NULL.
+ * @param[in] pProgressCallbackParam a parameter to pass to
+ *                                pProgressCallback; may be NULL.
+ * @return                        the number of UBX-MGA-XXX messages
+ *                                sent, else negative error code.
+ */
+int32_t uGnssMgaSend(uDeviceHandle_t gnssHandle,
+                     const char *pBuffer, size_t size,
+                     uGnssMgaFlowControl_t flowControl,
+                     uGnssMgaProgressCallback_t *pProgressCallback,
+                     void *pProgressCallbackParam);
+
+/** As uGnssMgaSend() but the UBX-MGA-XXX messages are read, in
+ * chunks of up to #U_GNSS_MGA_READ_CHUNK_LENGTH_BYTES, through a
+ * callback, e.g. from a file or from a socket connected to the
+ * AssistNow service.
+ *
+ * @param gnssHandle              the handle of the GNSS instance.
+ * @param[in] pReadCallback       the callback that provides the
+ *                                data; cannot be NULL.
+ * @param[in] pReadCallbackParam  a parameter to pass to pReadCallback;
+ *                                may be NULL.
+ * @param flowControl             the flow control to use.
+ * @param[in] pProgressCallback   a callback that will be called after
+ *                                each message is sent; may be NULL.
+ * @param[in] pProgressCallbackParam a parameter to pass to
+ *                                pProgressCallback; may be NULL.
+ * @return                        the number of UBX-MGA-XXX messages
+ *                                sent, else negative error code.
+ */
+int32_t uGnssMgaSendRead(uDeviceHandle_t gnssHandle,
+                         uGnssMgaReadCallback_t *pReadCallback,
+                         void *pReadCallbackParam,
+                         uGnssMgaFlowControl_t flowControl,
+                         uGnssMgaProgressCallback_t *pProgressCallback,
+                         void *pProgressCallbackParam);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_MGA_H_
+
+// End of file
@@ -58,25 +58,30 @@ extern "C" {
  * streamed (e.g. over I2C or UART) from the GNSS chip.  Should
  * be big enough to hold a few long messages from the device
  * while these are read asynchronously in task-space by the
- * application.
+ * application.  This is the default: the size may be chosen
+ * per instance with uGnssAddWithBufferSize().
  */
 # define U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES 2048
 #endif
 
 #ifndef U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES
-/** A temporary buffer, used as a staging post to
- * get stuff from a streaming source (e.g. I2C or UART)
- * into the ring buffer; must be less than
- * U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES - 1 but, since this
- * is just a "chunking" temporary buffer, a rather smaller
- * value is usually a good idea anyway.
+/** The maximum amount of data read from a streaming source
+ * (e.g. I2C or UART) into the ring buffer in one go; the
+ * data is read directly into the ring buffer, which is
+ * locked while that happens, hence this should be less than
+ * U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES - 1 and a rather smaller
+ * value is usually a good idea anyway.  The name is historical:
+ * there is no longer a temporary buffer.  This is the default:
+ * the size may be chosen per instance with uGnssAddWithBufferSize().
  */
 # define U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES (U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES / 8)
 #endif
 
 #ifndef U_GNSS_MSG_RECEIVER_MAX_NUM
 /** The maximum number of receivers that can be listening to the
- * message stream from the GNSS chip at any one time.
+ * message stream from the GNSS chip at any one time; beyond this
+ * uGnssMsgReceiveStart() will return #U_ERROR_COMMON_NO_MEMORY.
+ * Cannot be more than 32.
  */
 # define U_GNSS_MSG_RECEIVER_MAX_NUM 10
 #endif
@@ -93,6 +98,18 @@ extern "C" {
 # define U_GNSS_MSG_RECEIVE_TASK_STACK_SIZE_BYTES (1024 * 3)
 #endif
 
+/* By default each GNSS instance on which uGnssMsgReceiveStart() is
+ * called gets a task of its own to run the callbacks.  If
+ * U_GNSS_MSG_RECEIVE_TASK_SHARED is defined then a single task, with
+ * a stack of U_GNSS_MSG_RECEIVE_TASK_STACK_SIZE_BYTES, services all
+ * such instances instead, each in turn, taking a different instance
+ * first on each pass so that none is kept waiting behind the others;
+ * each instance retains its own ring buffer.  This saves RAM and
+ * context switches where several GNSS chips are connected (e.g. for
+ * a multi-antenna heading solution) but note that a slow callback
+ * for one instance will then delay the callbacks of all the others.
+ */
+
 #ifndef U_GNSS_MSG_RECEIVE_TASK_QUEUE_LENGTH
 /** The length of the queue controlling the message receive
  * task: just need the one.
@@ -162,6 +179,168 @@ typedef void (*uGnssMsgReceiveCallback_t)(uDeviceHandle_t gnssHandle,
                                           int32_t errorCodeOrLength,
                                           void *pCallbackParam);
 
+/** A zero-copy version of #uGnssMsgReceiveCallback_t, used by
+ * uGnssMsgReceiveStartSpan(): rather than copying the message out
+ * of the ring buffer with uGnssMsgReceiveCallbackRead(), the callback
+ * is given up to two spans which point directly at the message in the
+ * internal ring buffer; two spans are required only when the message
+ * wraps around the end of the ring buffer, otherwise the second span
+ * will have zero length.  The spans are valid ONLY for the duration
+ * of the callback: if you need the message afterwards you must copy
+ * it.  The same constraints as for #uGnssMsgReceiveCallback_t apply: be
+ * quick and the ONLY GNSS API calls that may be made are
+ * uGnssMsgReceiveCallbackRead() / uGnssMsgReceiveCallbackExtract();
+ * note that if you call uGnssMsgReceiveCallbackExtract() the spans
+ * will then no longer describe unread data.
+ * A simple construction might be:
+ *
+ * ```
+ * void myCallback(uDeviceHandle_t gnssHandle,
+ *                 const uGnssMessageId_t *pMessageId,
+ *                 const uRingBufferSpan_t *pSpan,
+ *                 int32_t errorCodeOrLength,
+ *                 void *pCallbackParam)
+ * {
+ *     (void) gnssHandle;
+ *     (void) pMessageId;
+ *     (void) pCallbackParam;
+ *     if (errorCodeOrLength > 0) {
+ *         for (size_t x = 0; x < 2; x++) {
+ *             myParse(pSpan[x].pData, pSpan[x].length);
+ *         }
+ *     }
+ * }
+ * ```
+ *
+ * @param gnssHandle             the handle of the GNSS instance.
+ * @param[out] pMessageId        a pointer to the message ID that was
+ *                               detected.
+ * @param[in] pSpan              a pointer to an array of TWO spans which,
+ *                               concatenated, contain the message, with
+ *                               any header, $, checksum, etc.; the total
+ *                               length of the spans will be
+ *                               errorCodeOrLength (or zero if
+ *                               errorCodeOrLength is not positive).
+ * @param errorCodeOrLength      the size of the message or, if
+ *                               pMessageId specifies a particular
+ *                               UBX-format message (i.e. no wild-cards)
+ *                               and a NACK was received for that
+ *                               message, then #U_GNSS_ERROR_NACK
+ *                               (and the spans will be empty).
+ * @param[in,out] pCallbackParam the callback parameter that was originally
+ *                               given to uGnssMsgReceiveStartSpan().
+ */
+typedef void (*uGnssMsgReceiveSpanCallback_t)(uDeviceHandle_t gnssHandle,
+                                              const uGnssMessageId_t *pMessageId,
+                                              const uRingBufferSpan_t *pSpan,
+                                              int32_t errorCodeOrLength,
+                                              void *pCallbackParam);
+
+/** The callback of a one-shot reader, see uGnssMsgReceiveStartOneShot().
+ * The same constraints as for #uGnssMsgReceiveCallback_t apply.
+ *
+ * @param gnssHandle             the handle of the GNSS instance.
+ * @param[out] pMessageId        a pointer to the message ID that was
+ *                               detected or, if errorCodeOrLength is
+ *                               #U_ERROR_COMMON_TIMEOUT, the message ID
+ *                               that was being waited for.
+ * @param errorCodeOrLength      the size of the message, which may be
+ *                               read with uGnssMsgReceiveCallbackRead(),
+ *                               #U_GNSS_ERROR_NACK if pMessageId specifies
+ *                               a particular UBX-format message (i.e. no
+ *                               wild-cards) and a NACK was received for
+ *                               that message, or #U_ERROR_COMMON_TIMEOUT
+ *                               if nothing arrived in time, in which case
+ *                               the return value is ignored.
+ * @param[in,out] pCallbackParam the callback parameter that was originally
+ *                               given to uGnssMsgReceiveStartOneShot().
+ * @return                       true if the reader is done, in which case
+ *                               it will be removed, false to keep waiting
+ *                               (e.g. because the message, once read, turns
+ *                               out to be the response to someone else's
+ *                               request).
+ */
+typedef bool (*uGnssMsgReceiveOneShotCallback_t)(uDeviceHandle_t gnssHandle,
+                                                 const uGnssMessageId_t *pMessageId,
+                                                 int32_t errorCodeOrLength,
+                                                 void *pCallbackParam);
+
+/** Timing statistics for one protocol type, part of #uGnssMsgStats_t.
+ */
+typedef struct {
+    uint32_t messageCount;     /**< the number of messages of this
+                                    protocol decoded by the non-blocking
+                                    message receive task. */
+    uint64_t decodeTimeTotalUs; /**< the total time spent decoding
+                                     those messages in microseconds. */
+    int32_t decodeTimeMaxUs;   /**< the longest time taken to decode
+                                    one message in microseconds. */
+} uGnssMsgStatsProtocol_t;
+
+/** Transport statistics for a GNSS instance, as returned by
+ * uGnssMsgReceiveStatGet(), intended to help size the ring buffer
+ * and the read chunk (see uGnssSetRingBufferSize()) and to find
+ * callbacks that are taking up too much time.  All times are in
+ * milliseconds, that being the resolution of the tick timer
+ * available on all platforms: where a message is decoded or a
+ * callback returns in less than a millisecond the time recorded
+ * will be zero, hence the totals are more useful than the maxima
+ * for short operations.  The byte counts and ring buffer high-water
+ * mark are collected whenever data is read from a streaming transport
+ * (UART or I2C); everything else only while a uGnssMsgReceiveStart()
+ * is active.
+ */
+typedef struct {
+    int32_t periodMs;        /**< the time over which bytesReceived
+                                  was counted, from the first byte
+                                  received after start or after
+                                  uGnssMsgReceiveStatReset(). */
+    uint32_t bytesReceived;  /**< the number of bytes read from the
+                                  GNSS chip into the ring buffer. */
+    int32_t bytesPerSecond;  /**< bytesReceived over periodMs. */
+    size_t ringBufferHighWaterMark; /**< the largest amount of unread
+                                         data there has been in the
+                                         ring buffer. */
+    uGnssMsgStatsProtocol_t protocol[U_GNSS_PROTOCOL_MAX_NUM]; /**< decode
+                                                                    statistics,
+                                                                    indexed
+                                                                    by
+                                                                    #uGnssProtocol_t. */
+    uint32_t callbackCount;  /**< the number of message receive
+                                  callbacks that have been called. */
+    uint64_t callbackTimeTotalUs; /**< the total time spent in those
+                                       callbacks in microseconds. */
+    int32_t callbackTimeMaxUs; /**< the longest time spent in one
+                                    callback in microseconds. */
+    uint64_t latencyTotalUs; /**< the total, over callbackCount callbacks,
+                                  of the time from the message receive
+                                  task finding data in the ring buffer
+                                  to a callback being called with a
+                                  message from that data; this includes
+                                  time spent in the callbacks of
+                                  earlier messages in the same data,
+                                  in microseconds. */
+    int32_t latencyMaxUs;    /**< the largest such time in microseconds. */
+} uGnssMsgStats_t;
+
+/** One of the UBX messages to be polled by uGnssMsgPollUbx().
+ */
+typedef struct {
+    uint16_t messageId;        /**< the UBX message class (upper byte)
+                                    and ID (lower byte) to poll, e.g.
+                                    #U_GNSS_MSG_UBX_NAV_PVT_MESSAGE_ID;
+                                    the poll is sent with an empty body. */
+    char *pBody;               /**< a place to put the body of the
+                                    response; may be NULL. */
+    size_t bodySize;           /**< the amount of storage at pBody. */
+    int32_t errorCodeOrLength; /**< on return, the number of bytes in
+                                    the body of the response (irrespective
+                                    of bodySize) or negative error code:
+                                    #U_ERROR_COMMON_TIMEOUT if no response
+                                    arrived, #U_GNSS_ERROR_NACK if the GNSS
+                                    chip rejected the poll. */
+} uGnssMsgUbxPoll_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: MISC
  * -------------------------------------------------------------- */
@@ -324,6 +503,31 @@ int32_t uGnssMsgReceive(uDeviceHandle_t gnssHandle,
                         int32_t timeoutMs,
                         bool (*pKeepGoingCallback)(uDeviceHandle_t gnssHandle));
 
+/** Poll several UBX messages in one go, e.g. UBX-MON-VER, UBX-MON-HW,
+ * UBX-NAV-STATUS and UBX-NAV-PVT for a status snapshot: all of the
+ * polls are sent back-to-back and the responses are collected, in
+ * whatever order they arrive, within a single timeout, so the whole
+ * thing takes roughly one round trip rather than one per message.
+ * Where the GNSS chip is connected via an intermediate [e.g. cellular]
+ * module the polls are, of necessity, made one at a time.
+ *
+ * Only messages that respond to a poll with an empty body with a
+ * message of the same class and ID may be polled in this way.
+ *
+ * @param gnssHandle      the handle of the GNSS instance.
+ * @param[in,out] pPoll   an array of the messages to poll, in which
+ *                        the outcome of each is returned; cannot be
+ *                        NULL.
+ * @param numPolls        the number of entries at pPoll.
+ * @param timeoutMs       the time to wait for all of the responses in
+ *                        milliseconds.
+ * @return                the number of polls that were answered,
+ *                        else negative error code.
+ */
+int32_t uGnssMsgPollUbx(uDeviceHandle_t gnssHandle,
+                        uGnssMsgUbxPoll_t *pPoll, size_t numPolls,
+                        int32_t timeoutMs);
+
 /** Monitor the output of the GNSS chip for the given message,
  * non-blocking (see uGnssMsgReceive() for the blocking version).
  * This may be called multiple times; to stop listening for a given
@@ -372,6 +576,72 @@ int32_t uGnssMsgReceiveStart(uDeviceHandle_t gnssHandle,
                              uGnssMsgReceiveCallback_t pCallback,
                              void *pCallbackParam);
 
+/** As uGnssMsgReceiveStart() but the callback is passed the message
+ * in place, as spans pointing into the internal ring buffer, rather
+ * than having to copy it out with uGnssMsgReceiveCallbackRead(); this
+ * is more efficient where several readers are interested in the
+ * same messages.  Readers started with this function and with
+ * uGnssMsgReceiveStart() may be mixed freely and are stopped in the
+ * same way, with uGnssMsgReceiveStop().
+ *
+ * @param gnssHandle             the handle of the GNSS instance.
+ * @param[in] pMessageId         a pointer to the message ID to capture;
+ *                               a copy will be taken so this may be
+ *                               on the stack; cannot be NULL.
+ * @param[in] pCallback          the callback to be called when a
+ *                               matching message arrives, see
+ *                               #uGnssMsgReceiveSpanCallback_t for the
+ *                               rules it must obey; cannot be NULL.
+ * @param[in] pCallbackParam     will be passed to pCallback as its last
+ *                               parameter.
+ * @return                       a handle for this asynchronous reader on
+ *                               success, else negative error code.
+ */
+int32_t uGnssMsgReceiveStartSpan(uDeviceHandle_t gnssHandle,
+                                 const uGnssMessageId_t *pMessageId,
+                                 uGnssMsgReceiveSpanCallback_t pCallback,
+                                 void *pCallbackParam);
+
+/** As uGnssMsgReceiveStart() but for a single message, e.g. the
+ * response to a poll that has been sent with uGnssMsgSend(): the
+ * reader removes itself once pCallback returns true or, if no
+ * wanted message has arrived within timeoutMs, after calling
+ * pCallback with #U_ERROR_COMMON_TIMEOUT.  This is the basis of the
+ * non-blocking query functions, e.g. uGnssCfgValGetAsync(), which
+ * complete through a callback rather than holding up the calling
+ * task for the round trip to the GNSS chip.  Note that the
+ * message receive task, once started, keeps running until
+ * uGnssMsgReceiveStopAll() is called (or a non-one-shot reader
+ * is stopped and no readers remain).
+ *
+ * @param gnssHandle             the handle of the GNSS instance.
+ * @param[in] pMessageId         a pointer to the message ID to capture;
+ *                               a copy will be taken so this may be
+ *                               on the stack; cannot be NULL.
+ * @param[in] pCallback          the callback to be called when a
+ *                               matching message arrives or on timeout,
+ *                               see #uGnssMsgReceiveOneShotCallback_t;
+ *                               cannot be NULL.
+ * @param[in] pCallbackParam     will be passed to pCallback as its last
+ *                               parameter.
+ * @param timeoutMs              the time to wait for the message in
+ *                               milliseconds; the resolution is that of
+ *                               the loop of the message receive task, see
+ *                               U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS.
+ * @return                       a handle for this asynchronous reader on
+ *                               success, else negative error code; the
+ *                               handle may be passed to uGnssMsgReceiveStop()
+ *                               to abandon the reader before it is done, in
+ *                               which case pCallback will not be called
+ *                               again, but note that the handle becomes
+ *                               invalid as soon as the reader is done.
+ */
+int32_t uGnssMsgReceiveStartOneShot(uDeviceHandle_t gnssHandle,
+                                    const uGnssMessageId_t *pMessageId,
+                                    uGnssMsgReceiveOneShotCallback_t pCallback,
+                                    void *pCallbackParam,
+                                    int32_t timeoutMs);
+
 /** To be called from the pCallback of uGnssMsgReceiveStart() to take
  * a peek at the message data from the internal ring buffer, copying it
  * into your buffer but NOT REMOVING IT from the internal ring buffer,
@@ -474,6 +744,28 @@ size_t uGnssMsgReceiveStatReadLoss(uDeviceHandle_t gnssHandle);
  */
 size_t uGnssMsgReceiveStatStreamLoss(uDeviceHandle_t gnssHandle);
 
+/** Get the transport statistics for a GNSS instance, see
+ * #uGnssMsgStats_t.  The statistics are updated by the
+ * non-blocking message receive task without locking, so if that
+ * task is running the values may be mutually inconsistent by the
+ * odd message.
+ *
+ * @param gnssHandle   the handle of the GNSS instance.
+ * @param[out] pStats  a place to put the statistics; cannot be NULL.
+ * @return             zero on success else negative error code.
+ */
+int32_t uGnssMsgReceiveStatGet(uDeviceHandle_t gnssHandle,
+                               uGnssMsgStats_t *pStats);
+
+/** Reset the transport statistics for a GNSS instance to zero; this
+ * does not affect uGnssMsgReceiveStatReadLoss() or
+ * uGnssMsgReceiveStatStreamLoss().
+ *
+ * @param gnssHandle   the handle of the GNSS instance.
+ * @return             zero on success else negative error code.
+ */
+int32_t uGnssMsgReceiveStatReset(uDeviceHandle_t gnssHandle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,246 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_MSG_NMEA_H_
+#define _U_GNSS_MSG_NMEA_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_ringbuffer.h" // uRingBufferSpan_t
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines functions which provide a
+ * read-only view of an NMEA sentence, as received with
+ * uGnssMsgReceive(), uGnssMsgReceiveStart() or
+ * uGnssMsgReceiveStartSpan(), without copying or modifying it: the
+ * checksum is validated and the offset of each field is recorded
+ * once, in a #uGnssMsgNmea_t, after which fields may be fetched by
+ * index and only those that are asked for are parsed; for example:
+ *
+ * ```
+ * uGnssMsgNmea_t nmea;
+ * int32_t latitudeX1e7;
+ * if ((uGnssMsgNmeaIndex(pBuffer, size, &nmea) >= 0) &&
+ *     uGnssMsgNmeaIsType(&nmea, "GGA") &&
+ *     (uGnssMsgNmeaGetLatLong(&nmea, 2, &latitudeX1e7) == 0)) {
+ *     ...
+ * }
+ * ```
+ *
+ * The sentence must remain in place, unchanged, for as long as the
+ * #uGnssMsgNmea_t is in use; in the case of the spans passed to a
+ * #uGnssMsgReceiveSpanCallback_t that means only within the callback.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_GNSS_MSG_NMEA_MAX_NUM_FIELDS
+/** The maximum number of fields of an NMEA sentence that may be
+ * indexed, where field zero is the address field (e.g. "GPGGA");
+ * fields beyond this are not accessible.  21 is enough for all of
+ * the standard NMEA sentences output by u-blox GNSS chips (GSV
+ * being the longest).
+ */
+# define U_GNSS_MSG_NMEA_MAX_NUM_FIELDS 21
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The index of an NMEA sentence, populated by uGnssMsgNmeaIndex()
+ * or uGnssMsgNmeaIndexSpan(); the contents should be treated as
+ * private.
+ */
+typedef struct {
+    uRingBufferSpan_t span[2]; /**< the sentence, which may be split
+                                    across two spans. */
+    size_t numFields;          /**< the number of fields indexed. */
+    uint16_t fieldOffset[U_GNSS_MSG_NMEA_MAX_NUM_FIELDS + 1]; /**< the
+                                    offset of the start of each field,
+                                    from the '$'; the entry after the
+                                    last field is one beyond the
+                                    delimiter that ends the last field. */
+} uGnssMsgNmea_t;
+
+/** The fix quality, as returned by uGnssMsgNmeaGetFixQuality(); the
+ * values match those of the quality field of a GGA sentence.
+ */
+typedef enum {
+    U_GNSS_MSG_NMEA_FIX_QUALITY_NONE = 0,         /**< no fix. */
+    U_GNSS_MSG_NMEA_FIX_QUALITY_AUTONOMOUS = 1,   /**< autonomous GNSS fix. */
+    U_GNSS_MSG_NMEA_FIX_QUALITY_DIFFERENTIAL = 2, /**< differential GNSS fix. */
+    U_GNSS_MSG_NMEA_FIX_QUALITY_RTK_FIXED = 4,    /**< RTK fixed. */
+    U_GNSS_MSG_NMEA_FIX_QUALITY_RTK_FLOAT = 5,    /**< RTK float. */
+    U_GNSS_MSG_NMEA_FIX_QUALITY_ESTIMATED = 6     /**< dead-reckoning fix. */
+} uGnssMsgNmeaFixQuality_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Validate an NMEA sentence in a single buffer and index its fields;
+ * nothing is copied.
+ *
+ * @param[in] pBuffer  the sentence, starting with '$', including the
+ *                     "*" and two-character checksum; any CR/LF after
+ *                     that is ignored.  Cannot be NULL.
+ * @param size         the number of bytes at pBuffer.
+ * @param[out] pNmea   a place to put the index; cannot be NULL.
+ * @return             the number of fields indexed, including the
+ *                     address field, #U_GNSS_ERROR_CRC if the checksum
+ *                     is wrong, else negative error code.
+ */
+int32_t uGnssMsgNmeaIndex(const char *pBuffer, size_t size,
+                          uGnssMsgNmea_t *pNmea);
+
+/** As uGnssMsgNmeaIndex() but the sentence is given as the two spans
+ * passed to a #uGnssMsgReceiveSpanCallback_t, i.e. straight from the
+ * ring buffer; the second span may be empty.
+ *
+ * @param[in] pSpan    a pointer to an array of TWO spans which,
+ *                     concatenated, contain the sentence; cannot
+ *                     be NULL.
+ * @param[out] pNmea   a place to put the index; cannot be NULL.
+ * @return             the number of fields indexed, including the
+ *                     address field, #U_GNSS_ERROR_CRC if the checksum
+ *                     is wrong, else negative error code.
+ */
+int32_t uGnssMsgNmeaIndexSpan(const uRingBufferSpan_t *pSpan,
+                              uGnssMsgNmea_t *pNmea);
+
+/** Check the sentence formatter of an indexed NMEA sentence, i.e. the
+ * address field with the two-character talker ID removed, so "GGA"
+ * will match both "GPGGA" and "GNGGA".
+ *
+ * @param[in] pNmea       the index of the sentence; cannot be NULL.
+ * @param[in] pFormatter  the null-terminated sentence formatter, e.g.
+ *                        "GGA"; cannot be NULL.
+ * @return                true if the sentence is of that type.
+ */
+bool uGnssMsgNmeaIsType(const uGnssMsgNmea_t *pNmea, const char *pFormatter);
+
+/** Get a pointer to a field of an indexed NMEA sentence, in place.
+ * The field is NOT null-terminated: it ends with a ',' or '*'.
+ * Where the sentence was indexed from two spans a field may straddle
+ * them, in which case #U_ERROR_COMMON_NOT_SUPPORTED is returned and
+ * uGnssMsgNmeaFieldCopy() must be used instead.
+ *
+ * @param[in] pNmea     the index of the sentence; cannot be NULL.
+ * @param fieldIndex    the index of the field, where zero is the
+ *                      address field.
+ * @param[out] ppField  a place to put the pointer to the field;
+ *                      cannot be NULL.
+ * @return              the length of the field, which may be zero,
+ *                      else negative error code.
+ */
+int32_t uGnssMsgNmeaField(const uGnssMsgNmea_t *pNmea, size_t fieldIndex,
+                          const char **ppField);
+
+/** Copy a field of an indexed NMEA sentence into a buffer and
+ * null-terminate it.
+ *
+ * @param[in] pNmea     the index of the sentence; cannot be NULL.
+ * @param fieldIndex    the index of the field, where zero is the
+ *                      address field.
+ * @param[out] pBuffer  a place to put the field; cannot be NULL.
+ * @param size          the amount of storage at pBuffer, including
+ *                      room for the terminator.
+ * @return              the length of the field, not including the
+ *                      terminator, else negative error code; if
+ *                      there is insufficient room the field is
+ *                      not copied and #U_ERROR_COMMON_NO_MEMORY is
+ *                      returned.
+ */
+int32_t uGnssMsgNmeaFieldCopy(const uGnssMsgNmea_t *pNmea, size_t fieldIndex,
+                              char *pBuffer, size_t size);
+
+/** Get the value of a field of an indexed NMEA sentence that is an
+ * integer, e.g. the number of satellites in GGA.
+ *
+ * @param[in] pNmea    the index of the sentence; cannot be NULL.
+ * @param fieldIndex   the index of the field.
+ * @param[out] pValue  a place to put the value; cannot be NULL.
+ * @return             zero on success, #U_ERROR_COMMON_NOT_FOUND
+ *                     if the field is empty, else negative error code.
+ */
+int32_t uGnssMsgNmeaGetInt(const uGnssMsgNmea_t *pNmea, size_t fieldIndex,
+                           int32_t *pValue);
+
+/** Get a latitude or longitude from an indexed NMEA sentence, i.e.
+ * a field of the form [d]ddmm.mmmmm followed by a field containing
+ * N, S, E or W.
+ *
+ * @param[in] pNmea    the index of the sentence; cannot be NULL.
+ * @param fieldIndex   the index of the [d]ddmm.mmmmm field, e.g. 2
+ *                     for the latitude in GGA, 4 for the longitude.
+ * @param[out] pX1e7   a place to put the value in ten millionths
+ *                     of a degree, negative for S or W; cannot be
+ *                     NULL.
+ * @return             zero on success, #U_ERROR_COMMON_NOT_FOUND
+ *                     if there is no value (e.g. there is no fix),
+ *                     else negative error code.
+ */
+int32_t uGnssMsgNmeaGetLatLong(const uGnssMsgNmea_t *pNmea, size_t fieldIndex,
+                               int32_t *pX1e7);
+
+/** Get a UTC time of day from an indexed NMEA sentence, i.e. a field
+ * of the form hhmmss.ss.
+ *
+ * @param[in] pNmea    the index of the sentence; cannot be NULL.
+ * @param fieldIndex   the index of the field, e.g. 1 for GGA and RMC.
+ * @param[out] pMs     a place to put the time of day in milliseconds;
+ *                     cannot be NULL.
+ * @return             zero on success, #U_ERROR_COMMON_NOT_FOUND
+ *                     if there is no value, else negative error code.
+ */
+int32_t uGnssMsgNmeaGetTimeOfDayMs(const uGnssMsgNmea_t *pNmea, size_t fieldIndex,
+                                   int32_t *pMs);
+
+/** Get the fix quality from an indexed GGA, RMC, GNS or GLL sentence;
+ * the position mode indicator of the latter three is mapped to the
+ * GGA quality values.
+ *
+ * @param[in] pNmea  the index of the sentence; cannot be NULL.
+ * @return           the fix quality, a value from
+ *                   #uGnssMsgNmeaFixQuality_t, on success,
+ *                   #U_ERROR_COMMON_NOT_SUPPORTED if the sentence is not
+ *                   one of those types, else negative error code.
+ */
+int32_t uGnssMsgNmeaGetFixQuality(const uGnssMsgNmea_t *pNmea);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_MSG_NMEA_H_
+
+// End of file
@@ -0,0 +1,487 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_MSG_UBX_H_
+#define _U_GNSS_MSG_UBX_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_compiler.h" // U_PACKED_STRUCT
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines packed structures which may be
+ * laid over the body of commonly used UBX messages, as received with
+ * uGnssMsgReceive() or uGnssMsgReceiveStart(), so that the fields
+ * may be read directly without any copying or allocation; for
+ * example:
+ *
+ * ```
+ * const uGnssMsgUbxNavPvt_t *pNavPvt = pUGnssMsgUbxNavPvt(pBuffer, size);
+ * if (pNavPvt != NULL) {
+ *     int32_t latitudeX1e7 = pNavPvt->lat;
+ * }
+ * ```
+ *
+ * The structures reflect the little-endian wire format of UBX and
+ * hence may only be used on a little-endian MCU; the members are
+ * not necessarily aligned and so the compiler will generate
+ * unaligned accesses where required.  The checksum of the message
+ * is NOT checked: messages delivered by uGnssMsgReceive() and
+ * uGnssMsgReceiveStart() have already been checked.
+ */
+
+/* NOTE TO MAINTAINERS: do NOT edit the area that is marked for
+ * automatic update, instead add/modify the message descriptions in the
+ * u_gnss_msg_ubx.py Python script and run it: it will update that
+ * part automagically.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__) && \
+    (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+# error The UBX message structures in u_gnss_msg_ubx.h require a little-endian MCU.
+#endif
+
+/** The number of bytes of UBX header (0xb5 0x62, class, ID and a
+ * two-byte length) before the body of a UBX message.
+ */
+#define U_GNSS_MSG_UBX_HEADER_LENGTH_BYTES 6
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Check that the given buffer contains an entire UBX message with
+ * the given message class/ID and a body of at least the given length
+ * and, if so, return a pointer to the body.  Usually this is not
+ * called directly, instead use the message-specific macros below,
+ * e.g. pUGnssMsgUbxNavPvt().
+ *
+ * @param[in] pMessage      a pointer to a buffer containing a UBX
+ *                          message, starting with the 0xb5 0x62
+ *                          header, as returned by uGnssMsgReceive()
+ *                          or passed to a #uGnssMsgReceiveCallback_t;
+ *                          may be NULL.
+ * @param size              the number of bytes at pMessage.
+ * @param messageId         the expected message class in the upper
+ *                          byte and the expected message ID in the
+ *                          lower byte.
+ * @param bodyMinLength     the minimum length of the message body;
+ *                          a longer body (e.g. a newer version of a
+ *                          message that has had fields added to the
+ *                          end) is accepted.
+ * @return                  a pointer to the body of the message, or
+ *                          NULL if the message is not as expected.
+ */
+const void *pUGnssMsgUbxBody(const char *pMessage, size_t size,
+                             uint16_t messageId, size_t bodyMinLength);
+
+/** As pUGnssMsgUbxBody() but for a UBX message which has a fixed part
+ * followed by a number of repeated blocks (e.g. one per satellite),
+ * returning a pointer to the block with the given index.  Usually
+ * this is not called directly, instead use the message-specific
+ * macros below, e.g. pUGnssMsgUbxNavSatSv().
+ *
+ * @param[in] pMessage      a pointer to a buffer containing a UBX
+ *                          message, starting with the 0xb5 0x62
+ *                          header; may be NULL.
+ * @param size              the number of bytes at pMessage.
+ * @param messageId         the expected message class in the upper
+ *                          byte and the expected message ID in the
+ *                          lower byte.
+ * @param fixedLength       the length of the fixed part of the body,
+ *                          before the first repeated block.
+ * @param blockLength       the length of a repeated block.
+ * @param index             the index of the repeated block to return,
+ *                          starting at zero.
+ * @return                  a pointer to the repeated block, or NULL if
+ *                          the message is not as expected or does not
+ *                          contain the block at index.
+ */
+const void *pUGnssMsgUbxBlock(const char *pMessage, size_t size,
+                              uint16_t messageId, size_t fixedLength,
+                              size_t blockLength, size_t index);
+
+/* ----------------------------------------------------------------
+ * TYPES AND DECODE MACROS: AUTO-GENERATED, DO NOT EDIT BY HAND
+ * -------------------------------------------------------------- */
+
+// *** DO NOT MODIFY THIS LINE OR BELOW: AUTO-GENERATED BY u_gnss_msg_ubx.py ***
+
+// *INDENT-OFF*
+
+/* ----- UBX-NAV-STATUS ----- */
+
+/** The message class (upper byte) and ID (lower byte) of UBX-NAV-STATUS.
+ */
+#define U_GNSS_MSG_UBX_NAV_STATUS_MESSAGE_ID 0x0103
+
+/** The length of the body of UBX-NAV-STATUS.
+ */
+#define U_GNSS_MSG_UBX_NAV_STATUS_BODY_LENGTH_BYTES 16
+
+/** The body of UBX-NAV-STATUS, 16 bytes, laid out as it is on the wire.
+ */
+typedef U_PACKED_STRUCT(uGnssMsgUbxNavStatus_t) {
+    uint32_t iTOW;   /**< offset 0: GPS time of week of the navigation epoch in milliseconds. */
+    uint8_t gpsFix;  /**< offset 4: GPS fix type: 0 no fix, 1 dead-reckoning only, 2 2D, 3 3D, 4 GPS + dead-reckoning, 5 time only. */
+    uint8_t flags;   /**< offset 5: navigation status flags, bit 0 gpsFixOk. */
+    uint8_t fixStat; /**< offset 6: fix status information. */
+    uint8_t flags2;  /**< offset 7: further information about navigation output. */
+    uint32_t ttff;   /**< offset 8: time to first fix in milliseconds. */
+    uint32_t msss;   /**< offset 12: milliseconds since start-up/reset. */
+} uGnssMsgUbxNavStatus_t;
+
+/** Get a pointer to the body of a UBX-NAV-STATUS message, in place,
+ * see pUGnssMsgUbxBody().
+ */
+#define pUGnssMsgUbxNavStatus(pMessage, size) ((const uGnssMsgUbxNavStatus_t *) pUGnssMsgUbxBody(pMessage, size, U_GNSS_MSG_UBX_NAV_STATUS_MESSAGE_ID, sizeof(uGnssMsgUbxNavStatus_t)))
+
+/* ----- UBX-NAV-PVT ----- */
+
+/** The message class (upper byte) and ID (lower byte) of UBX-NAV-PVT.
+ */
+#define U_GNSS_MSG_UBX_NAV_PVT_MESSAGE_ID 0x0107
+
+/** The length of the body of UBX-NAV-PVT.
+ */
+#define U_GNSS_MSG_UBX_NAV_PVT_BODY_LENGTH_BYTES 92
+
+/** The body of UBX-NAV-PVT, 92 bytes, laid out as it is on the wire.
+ */
+typedef U_PACKED_STRUCT(uGnssMsgUbxNavPvt_t) {
+    uint32_t iTOW;        /**< offset 0: GPS time of week of the navigation epoch in milliseconds. */
+    uint16_t year;        /**< offset 4: year (UTC). */
+    uint8_t month;        /**< offset 6: month (UTC), 1 to 12. */
+    uint8_t day;          /**< offset 7: day of month (UTC), 1 to 31. */
+    uint8_t hour;         /**< offset 8: hour of day (UTC), 0 to 23. */
+    uint8_t minute;       /**< offset 9: minute of hour (UTC), 0 to 59; "min" in the interface description. */
+    uint8_t sec;          /**< offset 10: seconds of minute (UTC), 0 to 60. */
+    uint8_t valid;        /**< offset 11: validity flags, bit 0 validDate, bit 1 validTime. */
+    uint32_t tAcc;        /**< offset 12: time accuracy estimate (UTC) in nanoseconds. */
+    int32_t nano;         /**< offset 16: fraction of second (UTC) in nanoseconds, -1e9 to 1e9. */
+    uint8_t fixType;      /**< offset 20: GNSS fix type: 0 no fix, 1 dead-reckoning only, 2 2D, 3 3D, 4 GNSS + dead-reckoning, 5 time only. */
+    uint8_t flags;        /**< offset 21: fix status flags, bit 0 gnssFixOK. */
+    uint8_t flags2;       /**< offset 22: additional flags. */
+    uint8_t numSV;        /**< offset 23: number of satellites used in the navigation solution. */
+    int32_t lon;          /**< offset 24: longitude in degrees * 1e7. */
+    int32_t lat;          /**< offset 28: latitude in degrees * 1e7. */
+    int32_t height;       /**< offset 32: height above the ellipsoid in millimetres. */
+    int32_t hMSL;         /**< offset 36: height above mean sea level in millimetres. */
+    uint32_t hAcc;        /**< offset 40: horizontal accuracy estimate in millimetres. */
+    uint32_t vAcc;        /**< offset 44: vertical accuracy estimate in millimetres. */
+    int32_t velN;         /**< offset 48: NED north velocity in millimetres per second. */
+    int32_t velE;         /**< offset 52: NED east velocity in millimetres per second. */
+    int32_t velD;         /**< offset 56: NED down velocity in millimetres per second. */
+    int32_t gSpeed;       /**< offset 60: ground speed (2D) in millimetres per second. */
+    int32_t headMot;      /**< offset 64: heading of motion (2D) in degrees * 1e5. */
+    uint32_t sAcc;        /**< offset 68: speed accuracy estimate in millimetres per second. */
+    uint32_t headAcc;     /**< offset 72: heading accuracy estimate (motion and vehicle) in degrees * 1e5. */
+    uint16_t pDOP;        /**< offset 76: position DOP * 100. */
+    uint16_t flags3;      /**< offset 78: additional flags. */
+    uint8_t reserved0[4]; /**< offset 80: reserved. */
+    int32_t headVeh;      /**< offset 84: heading of vehicle (2D) in degrees * 1e5. */
+    int16_t magDec;       /**< offset 88: magnetic declination in degrees * 1e2. */
+    uint16_t magAcc;      /**< offset 90: magnetic declination accuracy in degrees * 1e2. */
+} uGnssMsgUbxNavPvt_t;
+
+/** Get a pointer to the body of a UBX-NAV-PVT message, in place,
+ * see pUGnssMsgUbxBody().
+ */
+#define pUGnssMsgUbxNavPvt(pMessage, size) ((const uGnssMsgUbxNavPvt_t *) pUGnssMsgUbxBody(pMessage, size, U_GNSS_MSG_UBX_NAV_PVT_MESSAGE_ID, sizeof(uGnssMsgUbxNavPvt_t)))
+
+/* ----- UBX-NAV-SAT ----- */
+
+/** The message class (upper byte) and ID (lower byte) of UBX-NAV-SAT.
+ */
+#define U_GNSS_MSG_UBX_NAV_SAT_MESSAGE_ID 0x0135
+
+/** The length of the body of UBX-NAV-SAT, excluding the repeated blocks.
+ */
+#define U_GNSS_MSG_UBX_NAV_SAT_BODY_LENGTH_BYTES 8
+
+/** The body of UBX-NAV-SAT, 8 bytes, laid out as it is on the wire.
+ */
+typedef U_PACKED_STRUCT(uGnssMsgUbxNavSat_t) {
+    uint32_t iTOW;        /**< offset 0: GPS time of week of the navigation epoch in milliseconds. */
+    uint8_t version;      /**< offset 4: message version. */
+    uint8_t numSvs;       /**< offset 5: number of satellites, i.e. repeated blocks, that follow. */
+    uint8_t reserved0[2]; /**< offset 6: reserved. */
+} uGnssMsgUbxNavSat_t;
+
+/** Get a pointer to the body of a UBX-NAV-SAT message, in place,
+ * see pUGnssMsgUbxBody().
+ */
+#define pUGnssMsgUbxNavSat(pMessage, size) ((const uGnssMsgUbxNavSat_t *) pUGnssMsgUbxBody(pMessage, size, U_GNSS_MSG_UBX_NAV_SAT_MESSAGE_ID, sizeof(uGnssMsgUbxNavSat_t)))
+
+/** The length of a repeated block of UBX-NAV-SAT.
+ */
+#define U_GNSS_MSG_UBX_NAV_SAT_SV_LENGTH_BYTES 12
+
+/** A repeated block of UBX-NAV-SAT, 12 bytes, laid out as it is on the wire.
+ */
+typedef U_PACKED_STRUCT(uGnssMsgUbxNavSatSv_t) {
+    uint8_t gnssId; /**< offset 0: GNSS identifier. */
+    uint8_t svId;   /**< offset 1: satellite identifier. */
+    uint8_t cno;    /**< offset 2: carrier to noise ratio in dBHz. */
+    int8_t elev;    /**< offset 3: elevation in degrees, -90 to +90. */
+    int16_t azim;   /**< offset 4: azimuth in degrees, 0 to 360. */
+    int16_t prRes;  /**< offset 6: pseudorange residual in metres * 10. */
+    uint32_t flags; /**< offset 8: bitmask of quality, health, orbit source, etc. */
+} uGnssMsgUbxNavSatSv_t;
+
+/** Get a pointer to a repeated block of a UBX-NAV-SAT message,
+ * in place, see pUGnssMsgUbxBlock().
+ */
+#define pUGnssMsgUbxNavSatSv(pMessage, size, index) ((const uGnssMsgUbxNavSatSv_t *) pUGnssMsgUbxBlock(pMessage, size, U_GNSS_MSG_UBX_NAV_SAT_MESSAGE_ID, sizeof(uGnssMsgUbxNavSat_t), sizeof(uGnssMsgUbxNavSatSv_t), index))
+
+/* ----- UBX-NAV-GEOFENCE ----- */
+
+/** The message class (upper byte) and ID (lower byte) of UBX-NAV-GEOFENCE.
+ */
+#define U_GNSS_MSG_UBX_NAV_GEOFENCE_MESSAGE_ID 0x0139
+
+/** The length of the body of UBX-NAV-GEOFENCE, excluding the repeated blocks.
+ */
+#define U_GNSS_MSG_UBX_NAV_GEOFENCE_BODY_LENGTH_BYTES 8
+
+/** The body of UBX-NAV-GEOFENCE, 8 bytes, laid out as it is on the wire.
+ */
+typedef U_PACKED_STRUCT(uGnssMsgUbxNavGeofence_t) {
+    uint32_t iTOW;     /**< offset 0: GPS time of week of the navigation epoch in milliseconds. */
+    uint8_t version;   /**< offset 4: message version. */
+    uint8_t status;    /**< offset 5: geofencing status: 0 not available, 1 active. */
+    uint8_t numFences; /**< offset 6: number of geofences, i.e. repeated blocks, that follow. */
+    uint8_t combState; /**< offset 7: combined state of all geofences: 0 unknown, 1 inside, 2 outside. */
+} uGnssMsgUbxNavGeofence_t;
+
+/** Get a pointer to the body of a UBX-NAV-GEOFENCE message, in place,
+ * see pUGnssMsgUbxBody().
+ */
+#define pUGnssMsgUbxNavGeofence(pMessage, size) ((const uGnssMsgUbxNavGeofence_t *) pUGnssMsgUbxBody(pMessage, size, U_GNSS_MSG_UBX_NAV_GEOFENCE_MESSAGE_ID, sizeof(uGnssMsgUbxNavGeofence_t)))
+
+/** The length of a repeated block of UBX-NAV-GEOFENCE.
+ */
+#define U_GNSS_MSG_UBX_NAV_GEOFENCE_FENCE_LENGTH_BYTES 2
+
+/** A repeated block of UBX-NAV-GEOFENCE, 2 bytes, laid out as it is on the wire.
+ */
+typedef U_PACKED_STRUCT(uGnssMsgUbxNavGeofenceFence_t) {
+    uint8_t state;     /**< offset 0: geofence state: 0 unknown, 1 inside, 2 outside. */
+    uint8_t reserved1; /**< offset 1: reserved. */
+} uGnssMsgUbxNavGeofenceFence_t;
+
+/** Get a pointer to a repeated block of a UBX-NAV-GEOFENCE message,
+ * in place, see pUGnssMsgUbxBlock().
+ */
+#define pUGnssMsgUbxNavGeofenceFence(pMessage, size, index) ((const uGnssMsgUbxNavGeofenceFence_t *) pUGnssMsgUbxBlock(pMessage, size, U_GNSS_MSG_UBX_NAV_GEOFENCE_MESSAGE_ID, sizeof(uGnssMsgUbxNavGeofence_t), sizeof(uGnssMsgUbxNavGeofenceFence_t), index))
+
+/* ----- UBX-RXM-RAWX ----- */
+
+/** The message class (upper byte) and ID (lower byte) of UBX-RXM-RAWX.
+ */
+#define U_GNSS_MSG_UBX_RXM_RAWX_MESSAGE_ID 0x0215
+
+/** The length of the body of UBX-RXM-RAWX, excluding the repeated blocks.
+ */
+#define U_GNSS_MSG_UBX_RXM_RAWX_BODY_LENGTH_BYTES 16
+
+/** The body of UBX-RXM-RAWX, 16 bytes, laid out as it is on the wire.
+ */
+typedef U_PACKED_STRUCT(uGnssMsgUbxRxmRawx_t) {
+    double rcvTow;        /**< offset 0: measurement time of week in receiver local time in seconds. */
+    uint16_t week;        /**< offset 8: GPS week number in receiver local time. */
+    int8_t leapS;         /**< offset 10: GPS leap seconds (GPS-UTC). */
+    uint8_t numMeas;      /**< offset 11: number of measurements, i.e. repeated blocks, that follow. */
+    uint8_t recStat;      /**< offset 12: receiver tracking status bitfield. */
+    uint8_t version;      /**< offset 13: message version. */
+    uint8_t reserved0[2]; /**< offset 14: reserved. */
+} uGnssMsgUbxRxmRawx_t;
+
+/** Get a pointer to the body of a UBX-RXM-RAWX message, in place,
+ * see pUGnssMsgUbxBody().
+ */
+#define pUGnssMsgUbxRxmRawx(pMessage, size) ((const uGnssMsgUbxRxmRawx_t *) pUGnssMsgUbxBody(pMessage, size, U_GNSS_MSG_UBX_RXM_RAWX_MESSAGE_ID, sizeof(uGnssMsgUbxRxmRawx_t)))
+
+/** The length of a repeated block of UBX-RXM-RAWX.
+ */
+#define U_GNSS_MSG_UBX_RXM_RAWX_MEAS_LENGTH_BYTES 32
+
+/** A repeated block of UBX-RXM-RAWX, 32 bytes, laid out as it is on the wire.
+ */
+typedef U_PACKED_STRUCT(uGnssMsgUbxRxmRawxMeas_t) {
+    double prMes;      /**< offset 0: pseudorange measurement in metres. */
+    double cpMes;      /**< offset 8: carrier phase measurement in cycles. */
+    float doMes;       /**< offset 16: Doppler measurement in Hz. */
+    uint8_t gnssId;    /**< offset 20: GNSS identifier. */
+    uint8_t svId;      /**< offset 21: satellite identifier. */
+    uint8_t sigId;     /**< offset 22: signal identifier. */
+    uint8_t freqId;    /**< offset 23: GLONASS frequency slot + 7, else zero. */
+    uint16_t locktime; /**< offset 24: carrier phase locktime counter in milliseconds. */
+    uint8_t cno;       /**< offset 26: carrier to noise ratio in dBHz. */
+    uint8_t prStdev;   /**< offset 27: estimated pseudorange measurement standard deviation. */
+    uint8_t cpStdev;   /**< offset 28: estimated carrier phase measurement standard deviation. */
+    uint8_t doStdev;   /**< offset 29: estimated Doppler measurement standard deviation. */
+    uint8_t trkStat;   /**< offset 30: tracking status bitfield. */
+    uint8_t reserved1; /**< offset 31: reserved. */
+} uGnssMsgUbxRxmRawxMeas_t;
+
+/** Get a pointer to a repeated block of a UBX-RXM-RAWX message,
+ * in place, see pUGnssMsgUbxBlock().
+ */
+#define pUGnssMsgUbxRxmRawxMeas(pMessage, size, index) ((const uGnssMsgUbxRxmRawxMeas_t *) pUGnssMsgUbxBlock(pMessage, size, U_GNSS_MSG_UBX_RXM_RAWX_MESSAGE_ID, sizeof(uGnssMsgUbxRxmRawx_t), sizeof(uGnssMsgUbxRxmRawxMeas_t), index))
+
+/* ----- UBX-MON-HW ----- */
+
+/** The message class (upper byte) and ID (lower byte) of UBX-MON-HW.
+ */
+#define U_GNSS_MSG_UBX_MON_HW_MESSAGE_ID 0x0a09
+
+/** The length of the body of UBX-MON-HW.
+ */
+#define U_GNSS_MSG_UBX_MON_HW_BODY_LENGTH_BYTES 60
+
+/** The body of UBX-MON-HW, 60 bytes, laid out as it is on the wire.
+ */
+typedef U_PACKED_STRUCT(uGnssMsgUbxMonHw_t) {
+    uint32_t pinSel;      /**< offset 0: mask of pins set as peripheral/PIO. */
+    uint32_t pinBank;     /**< offset 4: mask of pins set as bank A/B. */
+    uint32_t pinDir;      /**< offset 8: mask of pins set as input/output. */
+    uint32_t pinVal;      /**< offset 12: mask of pins value low/high. */
+    uint16_t noisePerMS;  /**< offset 16: noise level as measured by the GPS core. */
+    uint16_t agcCnt;      /**< offset 18: AGC monitor, 0 to 8191. */
+    uint8_t aStatus;      /**< offset 20: status of the antenna supervisor state machine. */
+    uint8_t aPower;       /**< offset 21: current power status of the antenna. */
+    uint8_t flags;        /**< offset 22: flags, including the jamming state in bits 2 and 3. */
+    uint8_t reserved0;    /**< offset 23: reserved. */
+    uint32_t usedMask;    /**< offset 24: mask of pins that are used by the virtual pin manager. */
+    uint8_t VP[17];       /**< offset 28: array of pin mappings for each of the 17 physical pins. */
+    uint8_t jamInd;       /**< offset 45: CW jamming indicator, 0 (no CW jamming) to 255 (strong CW jamming). */
+    uint8_t reserved1[2]; /**< offset 46: reserved. */
+    uint32_t pinIrq;      /**< offset 48: mask of pins value using the PIO IRQ. */
+    uint32_t pullH;       /**< offset 52: mask of pins value using the PIO pull high resistor. */
+    uint32_t pullL;       /**< offset 56: mask of pins value using the PIO pull low resistor. */
+} uGnssMsgUbxMonHw_t;
+
+/** Get a pointer to the body of a UBX-MON-HW message, in place,
+ * see pUGnssMsgUbxBody().
+ */
+#define pUGnssMsgUbxMonHw(pMessage, size) ((const uGnssMsgUbxMonHw_t *) pUGnssMsgUbxBody(pMessage, size, U_GNSS_MSG_UBX_MON_HW_MESSAGE_ID, sizeof(uGnssMsgUbxMonHw_t)))
+
+/* ----- UBX-MON-RXR ----- */
+
+/** The message class (upper byte) and ID (lower byte) of UBX-MON-RXR.
+ */
+#define U_GNSS_MSG_UBX_MON_RXR_MESSAGE_ID 0x0a21
+
+/** The length of the body of UBX-MON-RXR.
+ */
+#define U_GNSS_MSG_UBX_MON_RXR_BODY_LENGTH_BYTES 1
+
+/** The body of UBX-MON-RXR, 1 bytes, laid out as it is on the wire.
+ */
+typedef U_PACKED_STRUCT(uGnssMsgUbxMonRxr_t) {
+    uint8_t flags; /**< offset 0: flags, bit 0 set if the receiver is awake. */
+} uGnssMsgUbxMonRxr_t;
+
+/** Get a pointer to the body of a UBX-MON-RXR message, in place,
+ * see pUGnssMsgUbxBody().
+ */
+#define pUGnssMsgUbxMonRxr(pMessage, size) ((const uGnssMsgUbxMonRxr_t *) pUGnssMsgUbxBody(pMessage, size, U_GNSS_MSG_UBX_MON_RXR_MESSAGE_ID, sizeof(uGnssMsgUbxMonRxr_t)))
+
+/* ----- UBX-TIM-TP ----- */
+
+/** The message class (upper byte) and ID (lower byte) of UBX-TIM-TP.
+ */
+#define U_GNSS_MSG_UBX_TIM_TP_MESSAGE_ID 0x0d01
+
+/** The length of the body of UBX-TIM-TP.
+ */
+#define U_GNSS_MSG_UBX_TIM_TP_BODY_LENGTH_BYTES 16
+
+/** The body of UBX-TIM-TP, 16 bytes, laid out as it is on the wire.
+ */
+typedef U_PACKED_STRUCT(uGnssMsgUbxTimTp_t) {
+    uint32_t towMS;    /**< offset 0: time pulse time of week in milliseconds. */
+    uint32_t towSubMS; /**< offset 4: sub-millisecond part of towMS in milliseconds * 2^-32. */
+    int32_t qErr;      /**< offset 8: quantization error of the time pulse in picoseconds. */
+    uint16_t week;     /**< offset 12: time pulse week number. */
+    uint8_t flags;     /**< offset 14: flags, including the time base and UTC availability. */
+    uint8_t refInfo;   /**< offset 15: time reference information. */
+} uGnssMsgUbxTimTp_t;
+
+/** Get a pointer to the body of a UBX-TIM-TP message, in place,
+ * see pUGnssMsgUbxBody().
+ */
+#define pUGnssMsgUbxTimTp(pMessage, size) ((const uGnssMsgUbxTimTp_t *) pUGnssMsgUbxBody(pMessage, size, U_GNSS_MSG_UBX_TIM_TP_MESSAGE_ID, sizeof(uGnssMsgUbxTimTp_t)))
+
+/* ----- UBX-TIM-TM2 ----- */
+
+/** The message class (upper byte) and ID (lower byte) of UBX-TIM-TM2.
+ */
+#define U_GNSS_MSG_UBX_TIM_TM2_MESSAGE_ID 0x0d03
+
+/** The length of the body of UBX-TIM-TM2.
+ */
+#define U_GNSS_MSG_UBX_TIM_TM2_BODY_LENGTH_BYTES 28
+
+/** The body of UBX-TIM-TM2, 28 bytes, laid out as it is on the wire.
+ */
+typedef U_PACKED_STRUCT(uGnssMsgUbxTimTm2_t) {
+    uint8_t ch;         /**< offset 0: the channel (i.e. EXTINT) upon which the pulse was measured. */
+    uint8_t flags;      /**< offset 1: flags, including new falling edge (bit 2), time base (bits 3 and 4), time valid (bit 6) and new rising edge (bit 7). */
+    uint16_t count;     /**< offset 2: rising edge counter. */
+    uint16_t wnR;       /**< offset 4: week number of the last rising edge. */
+    uint16_t wnF;       /**< offset 6: week number of the last falling edge. */
+    uint32_t towMsR;    /**< offset 8: time of week of the rising edge in milliseconds. */
+    uint32_t towSubMsR; /**< offset 12: sub-millisecond part of towMsR in nanoseconds. */
+    uint32_t towMsF;    /**< offset 16: time of week of the falling edge in milliseconds. */
+    uint32_t towSubMsF; /**< offset 20: sub-millisecond part of towMsF in nanoseconds. */
+    uint32_t accEst;    /**< offset 24: accuracy estimate in nanoseconds. */
+} uGnssMsgUbxTimTm2_t;
+
+/** Get a pointer to the body of a UBX-TIM-TM2 message, in place,
+ * see pUGnssMsgUbxBody().
+ */
+#define pUGnssMsgUbxTimTm2(pMessage, size) ((const uGnssMsgUbxTimTm2_t *) pUGnssMsgUbxBody(pMessage, size, U_GNSS_MSG_UBX_TIM_TM2_MESSAGE_ID, sizeof(uGnssMsgUbxTimTm2_t)))
+
+// *INDENT-ON*
+
+// *** DO NOT MODIFY THIS LINE OR ABOVE: DO NOT MODIFY AREA ENDS ***
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_MSG_UBX_H_
+
+// End of file
@@ -0,0 +1,480 @@
+#!/usr/bin/env python
+
+'''Update the file u_gnss_msg_ubx.h with UBX message structures.'''
+
+from multiprocessing import Process, freeze_support # Needed to make Windows behave
+                                                    # when run under multiprocessing,
+from signal import signal, SIGINT   # For CTRL-C handling
+import os
+import sys # For exit() and stdout
+import argparse
+import subprocess
+import platform # Figure out current OS
+
+# This script re-writes the end of the file u_gnss_msg_ubx.h
+# with packed structures, message ID/length macros and in-place
+# decode macros generated from the message descriptions in
+# MESSAGE_LIST below.
+#
+# It works like this:
+#
+# 1. Each entry in MESSAGE_LIST describes one UBX message: its
+#    name (e.g. NAV_PVT, which becomes UBX-NAV-PVT), its class and
+#    ID, the fields of the fixed part of the message body, in order,
+#    and, optionally, the fields of a block that is repeated (e.g. once
+#    per satellite) after the fixed part.
+#
+# 2. Each field is a tuple of UBX type (e.g. "U4", "I2", "R8", "X1",
+#    or "U1[4]" for an array), field name and a comment; the field
+#    names are those of the u-blox interface description except
+#    where a name would clash with something common in C (e.g. "min",
+#    which is a macro in some Windows headers).
+#
+# 3. For each message it creates:
+#
+#    - a macro U_GNSS_MSG_UBX_<NAME>_MESSAGE_ID, the class in the
+#      upper byte and the ID in the lower byte, for use with
+#      uGnssMsgReceive() etc.,
+#    - a macro U_GNSS_MSG_UBX_<NAME>_BODY_LENGTH_BYTES, the length
+#      of the fixed part of the message body,
+#    - a packed structure, e.g. uGnssMsgUbxNavPvt_t, which may be
+#      laid over the message body in place,
+#    - a macro, e.g. pUGnssMsgUbxNavPvt(), which checks a received
+#      message and returns a pointer to its body as that structure,
+#
+#    ...and, if there is a repeated block, the same for the block
+#    with the block name appended (e.g. uGnssMsgUbxNavSatSv_t and
+#    pUGnssMsgUbxNavSatSv(), which takes an index as well).
+#
+# 4. It looks for two markers in the file:
+#
+#    // *** DO NOT MODIFY THIS LINE OR BELOW: AUTO-GENERATED BY u_gnss_msg_ubx.py ***
+#
+#   ...and
+#
+#    // *** DO NOT MODIFY THIS LINE OR ABOVE: DO NOT MODIFY AREA ENDS ***
+#
+#    ...erases anything between them and and writes all of the
+#    generated code there instead.  A backup is made of the
+#    current file, just in case.
+
+# The file to be read/modified
+TARGET_FILE_NAME = "u_gnss_msg_ubx.h"
+
+# The file extension to be used for the back-up of the file
+BACKUP_EXTENSION = "_bak"
+
+# The prefix for all macros
+MACRO_PREFIX = "U_GNSS_MSG_UBX_"
+
+# The prefix for all types
+TYPE_PREFIX = "uGnssMsgUbx"
+
+# The prefix for all decode macros
+DECODE_PREFIX = "pUGnssMsgUbx"
+
+# The marker to look for, beyond which we can re-write the target
+# file up to FILE_REWRITE_MARKER_END
+FILE_REWRITE_MARKER_START = "// *** DO NOT MODIFY THIS LINE OR BELOW: AUTO-GENERATED BY u_gnss_msg_ubx.py ***"
+
+# The marker up to which the target file can be re-written
+FILE_REWRITE_MARKER_END = "// *** DO NOT MODIFY THIS LINE OR ABOVE: DO NOT MODIFY AREA ENDS ***"
+
+# The UBX types, the C type each corresponds to and its size in bytes
+TYPE_LIST = {"U1": ("uint8_t", 1),
+             "I1": ("int8_t", 1),
+             "X1": ("uint8_t", 1),
+             "U2": ("uint16_t", 2),
+             "I2": ("int16_t", 2),
+             "X2": ("uint16_t", 2),
+             "U4": ("uint32_t", 4),
+             "I4": ("int32_t", 4),
+             "X4": ("uint32_t", 4),
+             "R4": ("float", 4),
+             "R8": ("double", 8)}
+
+# The message descriptions: add to this list (and re-run this script)
+# to support more messages
+MESSAGE_LIST = [
+    {"name": "NAV_STATUS", "class": 0x01, "id": 0x03,
+     "fields": [("U4", "iTOW", "GPS time of week of the navigation epoch in milliseconds."),
+                ("U1", "gpsFix", "GPS fix type: 0 no fix, 1 dead-reckoning only, 2 2D, 3 3D, 4 GPS + dead-reckoning, 5 time only."),
+                ("X1", "flags", "navigation status flags, bit 0 gpsFixOk."),
+                ("X1", "fixStat", "fix status information."),
+                ("X1", "flags2", "further information about navigation output."),
+                ("U4", "ttff", "time to first fix in milliseconds."),
+                ("U4", "msss", "milliseconds since start-up/reset.")]},
+    {"name": "NAV_PVT", "class": 0x01, "id": 0x07,
+     "fields": [("U4", "iTOW", "GPS time of week of the navigation epoch in milliseconds."),
+                ("U2", "year", "year (UTC)."),
+                ("U1", "month", "month (UTC), 1 to 12."),
+                ("U1", "day", "day of month (UTC), 1 to 31."),
+                ("U1", "hour", "hour of day (UTC), 0 to 23."),
+                ("U1", "minute", "minute of hour (UTC), 0 to 59; \"min\" in the interface description."),
+                ("U1", "sec", "seconds of minute (UTC), 0 to 60."),
+                ("X1", "valid", "validity flags, bit 0 validDate, bit 1 validTime."),
+                ("U4", "tAcc", "time accuracy estimate (UTC) in nanoseconds."),
+                ("I4", "nano", "fraction of second (UTC) in nanoseconds, -1e9 to 1e9."),
+                ("U1", "fixType", "GNSS fix type: 0 no fix, 1 dead-reckoning only, 2 2D, 3 3D, 4 GNSS + dead-reckoning, 5 time only."),
+                ("X1", "flags", "fix status flags, bit 0 gnssFixOK."),
+                ("X1", "flags2", "additional flags."),
+                ("U1", "numSV", "number of satellites used in the navigation solution."),
+                ("I4", "lon", "longitude in degrees * 1e7."),
+                ("I4", "lat", "latitude in degrees * 1e7."),
+                ("I4", "height", "height above the ellipsoid in millimetres."),
+                ("I4", "hMSL", "height above mean sea level in millimetres."),
+                ("U4", "hAcc", "horizontal accuracy estimate in millimetres."),
+                ("U4", "vAcc", "vertical accuracy estimate in millimetres."),
+                ("I4", "velN", "NED north velocity in millimetres per second."),
+                ("I4", "velE", "NED east velocity in millimetres per second."),
+                ("I4", "velD", "NED down velocity in millimetres per second."),
+                ("I4", "gSpeed", "ground speed (2D) in millimetres per second."),
+                ("I4", "headMot", "heading of motion (2D) in degrees * 1e5."),
+                ("U4", "sAcc", "speed accuracy estimate in millimetres per second."),
+                ("U4", "headAcc", "heading accuracy estimate (motion and vehicle) in degrees * 1e5."),
+                ("U2", "pDOP", "position DOP * 100."),
+                ("X2", "flags3", "additional flags."),
+                ("U1[4]", "reserved0", "reserved."),
+                ("I4", "headVeh", "heading of vehicle (2D) in degrees * 1e5."),
+                ("I2", "magDec", "magnetic declination in degrees * 1e2."),
+                ("U2", "magAcc", "magnetic declination accuracy in degrees * 1e2.")]},
+    {"name": "NAV_SAT", "class": 0x01, "id": 0x35,
+     "fields": [("U4", "iTOW", "GPS time of week of the navigation epoch in milliseconds."),
+                ("U1", "version", "message version."),
+                ("U1", "numSvs", "number of satellites, i.e. repeated blocks, that follow."),
+                ("U1[2]", "reserved0", "reserved.")],
+     "block": {"name": "SV", "fields": [("U1", "gnssId", "GNSS identifier."),
+                                        ("U1", "svId", "satellite identifier."),
+                                        ("U1", "cno", "carrier to noise ratio in dBHz."),
+                                        ("I1", "elev", "elevation in degrees, -90 to +90."),
+                                        ("I2", "azim", "azimuth in degrees, 0 to 360."),
+                                        ("I2", "prRes", "pseudorange residual in metres * 10."),
+                                        ("X4", "flags", "bitmask of quality, health, orbit source, etc.")]}},
+    {"name": "NAV_GEOFENCE", "class": 0x01, "id": 0x39,
+     "fields": [("U4", "iTOW", "GPS time of week of the navigation epoch in milliseconds."),
+                ("U1", "version", "message version."),
+                ("U1", "status", "geofencing status: 0 not available, 1 active."),
+                ("U1", "numFences", "number of geofences, i.e. repeated blocks, that follow."),
+                ("U1", "combState", "combined state of all geofences: 0 unknown, 1 inside, 2 outside.")],
+     "block": {"name": "FENCE", "fields": [("U1", "state", "geofence state: 0 unknown, 1 inside, 2 outside."),
+                                           ("U1", "reserved1", "reserved.")]}},
+    {"name": "RXM_RAWX", "class": 0x02, "id": 0x15,
+     "fields": [("R8", "rcvTow", "measurement time of week in receiver local time in seconds."),
+                ("U2", "week", "GPS week number in receiver local time."),
+                ("I1", "leapS", "GPS leap seconds (GPS-UTC)."),
+                ("U1", "numMeas", "number of measurements, i.e. repeated blocks, that follow."),
+                ("X1", "recStat", "receiver tracking status bitfield."),
+                ("U1", "version", "message version."),
+                ("U1[2]", "reserved0", "reserved.")],
+     "block": {"name": "MEAS", "fields": [("R8", "prMes", "pseudorange measurement in metres."),
+                                          ("R8", "cpMes", "carrier phase measurement in cycles."),
+                                          ("R4", "doMes", "Doppler measurement in Hz."),
+                                          ("U1", "gnssId", "GNSS identifier."),
+                                          ("U1", "svId", "satellite identifier."),
+                                          ("U1", "sigId", "signal identifier."),
+                                          ("U1", "freqId", "GLONASS frequency slot + 7, else zero."),
+                                          ("U2", "locktime", "carrier phase locktime counter in milliseconds."),
+                                          ("U1", "cno", "carrier to noise ratio in dBHz."),
+                                          ("X1", "prStdev", "estimated pseudorange measurement standard deviation."),
+                                          ("X1", "cpStdev", "estimated carrier phase measurement standard deviation."),
+                                          ("X1", "doStdev", "estimated Doppler measurement standard deviation."),
+                                          ("X1", "trkStat", "tracking status bitfield."),
+                                          ("U1", "reserved1", "reserved.")]}},
+    {"name": "MON_HW", "class": 0x0a, "id": 0x09,
+     "fields": [("X4", "pinSel", "mask of pins set as peripheral/PIO."),
+                ("X4", "pinBank", "mask of pins set as bank A/B."),
+                ("X4", "pinDir", "mask of pins set as input/output."),
+                ("X4", "pinVal", "mask of pins value low/high."),
+                ("U2", "noisePerMS", "noise level as measured by the GPS core."),
+                ("U2", "agcCnt", "AGC monitor, 0 to 8191."),
+                ("U1", "aStatus", "status of the antenna supervisor state machine."),
+                ("U1", "aPower", "current power status of the antenna."),
+                ("X1", "flags", "flags, including the jamming state in bits 2 and 3."),
+                ("U1", "reserved0", "reserved."),
+                ("X4", "usedMask", "mask of pins that are used by the virtual pin manager."),
+                ("U1[17]", "VP", "array of pin mappings for each of the 17 physical pins."),
+                ("U1", "jamInd", "CW jamming indicator, 0 (no CW jamming) to 255 (strong CW jamming)."),
+                ("U1[2]", "reserved1", "reserved."),
+                ("X4", "pinIrq", "mask of pins value using the PIO IRQ."),
+                ("X4", "pullH", "mask of pins value using the PIO pull high resistor."),
+                ("X4", "pullL", "mask of pins value using the PIO pull low resistor.")]},
+    {"name": "MON_RXR", "class": 0x0a, "id": 0x21,
+     "fields": [("X1", "flags", "flags, bit 0 set if the receiver is awake.")]},
+    {"name": "TIM_TP", "class": 0x0d, "id": 0x01,
+     "fields": [("U4", "towMS", "time pulse time of week in milliseconds."),
+                ("U4", "towSubMS", "sub-millisecond part of towMS in milliseconds * 2^-32."),
+                ("I4", "qErr", "quantization error of the time pulse in picoseconds."),
+                ("U2", "week", "time pulse week number."),
+                ("X1", "flags", "flags, including the time base and UTC availability."),
+                ("X1", "refInfo", "time reference information.")]},
+    {"name": "TIM_TM2", "class": 0x0d, "id": 0x03,
+     "fields": [("U1", "ch", "the channel (i.e. EXTINT) upon which the pulse was measured."),
+                ("X1", "flags", "flags, including new falling edge (bit 2), time base (bits 3 and 4), time valid (bit 6) and new rising edge (bit 7)."),
+                ("U2", "count", "rising edge counter."),
+                ("U2", "wnR", "week number of the last rising edge."),
+                ("U2", "wnF", "week number of the last falling edge."),
+                ("U4", "towMsR", "time of week of the rising edge in milliseconds."),
+                ("U4", "towSubMsR", "sub-millisecond part of towMsR in nanoseconds."),
+                ("U4", "towMsF", "time of week of the falling edge in milliseconds."),
+                ("U4", "towSubMsF", "sub-millisecond part of towMsF in nanoseconds."),
+                ("U4", "accEst", "accuracy estimate in nanoseconds.")]}
+]
+
+def signal_handler(sig, frame):
+    '''CTRL-C Handler'''
+    del sig
+    del frame
+    sys.stdout.write('\n')
+    print("CTRL-C received, EXITING.")
+    sys.exit(-1)
+
+# subprocess arguments behaves a little differently on Linux and Windows
+# depending if a shell is used or not, which can be read here:
+# https://stackoverflow.com/a/15109975
+# This function will compensate for these deviations
+def subprocess_osify(cmd, shell=True):
+    '''Expects an array of strings being [command, param, ...]'''
+    if platform.system() != "Windows" and shell:
+        line = ""
+        for command in cmd:
+            # Put everything in a single string and quote args containing spaces
+            if " " in command:
+                line += f"\"{command}\" "
+            else:
+                line += f"{command} "
+        cmd = line
+    return cmd
+
+def camel_case(name):
+    '''Convert an upper/snake case name (e.g. NAV_PVT) to camel case (e.g. NavPvt)'''
+    camel = ""
+    for bit in name.split("_"):
+        camel += bit[0].upper() + bit[1:].lower()
+    return camel
+
+def ubx_name(name):
+    '''Convert an upper/snake case name (e.g. NAV_PVT) to a UBX name (e.g. UBX-NAV-PVT)'''
+    return "UBX-" + name.replace("_", "-")
+
+def field_to_c(field):
+    '''Convert a field tuple into a C type, a member declaration and a size, or None on error'''
+    type_string = field[0]
+    count = 1
+    array = ""
+    if "[" in type_string:
+        bits = type_string.split("[")
+        type_string = bits[0]
+        try:
+            count = int(bits[1].split("]")[0], 0)
+        except ValueError:
+            return None
+        array = f"[{count}]"
+    if type_string not in TYPE_LIST:
+        return None
+    c_type, size = TYPE_LIST[type_string]
+    return c_type, field[1] + array, size * count
+
+def create_struct(type_name, description, field_list):
+    '''Create the lines of a packed structure from a field list, returning the lines and the length'''
+    line_list = []
+    member_list = []
+    length = 0
+    column_offset = 0
+
+    for field in field_list:
+        c_field = field_to_c(field)
+        if c_field is None:
+            print(f"Field \"{field[1]}\" of {type_name} has unknown type \"{field[0]}\", stopping.")
+            return [], -1
+        member = f"    {c_field[0]} {c_field[1]};"
+        if len(member) > column_offset:
+            column_offset = len(member)
+        member_list.append((member, field[2], length))
+        length += c_field[2]
+
+    line_list.append(f"/** {description}, {length} bytes, laid out as it is on the wire.\n")
+    line_list.append(" */\n")
+    line_list.append(f"typedef U_PACKED_STRUCT({type_name}) {{\n")
+    for member in member_list:
+        line = member[0]
+        for _ in range(len(member[0]), column_offset):
+            line += " "
+        line_list.append(f"{line} /**< offset {member[2]}: {member[1]} */\n")
+    line_list.append(f"}} {type_name};\n")
+
+    return line_list, length
+
+def create_message(message):
+    '''Create the lines for a message'''
+    line_list = []
+    name = message["name"]
+    macro_prefix = MACRO_PREFIX + name
+    type_name = TYPE_PREFIX + camel_case(name) + "_t"
+    decode_name = DECODE_PREFIX + camel_case(name)
+    message_id = (message["class"] << 8) | message["id"]
+
+    line_list.append(f"/* ----- {ubx_name(name)} ----- */\n")
+    line_list.append("\n")
+    line_list.append(f"/** The message class (upper byte) and ID (lower byte) of {ubx_name(name)}.\n")
+    line_list.append(" */\n")
+    line_list.append(f"#define {macro_prefix}_MESSAGE_ID 0x{message_id:04x}\n")
+    line_list.append("\n")
+    struct_list, length = create_struct(type_name, f"The body of {ubx_name(name)}", message["fields"])
+    if length < 0:
+        return []
+    line_list.append(f"/** The length of the body of {ubx_name(name)}")
+    if "block" in message:
+        line_list.append(", excluding the repeated blocks")
+    line_list.append(".\n")
+    line_list.append(" */\n")
+    line_list.append(f"#define {macro_prefix}_BODY_LENGTH_BYTES {length}\n")
+    line_list.append("\n")
+    line_list += struct_list
+    line_list.append("\n")
+    line_list.append(f"/** Get a pointer to the body of a {ubx_name(name)} message, in place,\n")
+    line_list.append(" * see pUGnssMsgUbxBody().\n")
+    line_list.append(" */\n")
+    line_list.append(f"#define {decode_name}(pMessage, size) ((const {type_name} *) "
+                     f"pUGnssMsgUbxBody(pMessage, size, {macro_prefix}_MESSAGE_ID, "
+                     f"sizeof({type_name})))\n")
+    if "block" in message:
+        block = message["block"]
+        block_type_name = TYPE_PREFIX + camel_case(name) + camel_case(block["name"]) + "_t"
+        block_macro_prefix = macro_prefix + "_" + block["name"]
+        struct_list, length = create_struct(block_type_name,
+                                            f"A repeated block of {ubx_name(name)}",
+                                            block["fields"])
+        if length < 0:
+            return []
+        line_list.append("\n")
+        line_list.append(f"/** The length of a repeated block of {ubx_name(name)}.\n")
+        line_list.append(" */\n")
+        line_list.append(f"#define {block_macro_prefix}_LENGTH_BYTES {length}\n")
+        line_list.append("\n")
+        line_list += struct_list
+        line_list.append("\n")
+        line_list.append(f"/** Get a pointer to a repeated block of a {ubx_name(name)} message,\n")
+        line_list.append(" * in place, see pUGnssMsgUbxBlock().\n")
+        line_list.append(" */\n")
+        line_list.append(f"#define {decode_name}{camel_case(block['name'])}(pMessage, size, index) "
+                         f"((const {block_type_name} *) "
+                         f"pUGnssMsgUbxBlock(pMessage, size, {macro_prefix}_MESSAGE_ID, "
+                         f"sizeof({type_name}), sizeof({block_type_name}), index))\n")
+    line_list.append("\n")
+
+    return line_list
+
+def rewrite_line_list(generated_line_list, input_line_list):
+    '''Re-write the line_list with the generated lines'''
+    output_line_list = []
+    start_marker_index = -1
+    end_marker_index = -1
+    output_line_list_one = []
+    output_line_list_three = []
+
+    for idx, line in enumerate(input_line_list):
+        # Make a list of all lines up to and include the start marker
+        output_line_list_one.append(line)
+        if line.startswith(FILE_REWRITE_MARKER_START):
+            start_marker_index = idx
+            break
+
+    if start_marker_index >= 0:
+        # Make a list of all lines from [including] the end marker to the end of the list
+        for idx, line in enumerate(input_line_list[start_marker_index:]):
+            if end_marker_index < 0 and line.startswith(FILE_REWRITE_MARKER_END):
+                end_marker_index = idx
+            if end_marker_index >= 0:
+                output_line_list_three.append(line)
+
+    if start_marker_index < 0:
+        print("Could not find the start marker \"{}\" in the file, stopping.".  \
+              format(FILE_REWRITE_MARKER_START))
+    else:
+        if end_marker_index < 0:
+            print("Could not find the end marker \"{}\" in the file, stopping.".  \
+                  format(FILE_REWRITE_MARKER_END))
+        else:
+            # Combine the three lists
+            output_line_list = output_line_list_one + ["\n", "// *INDENT-OFF*\n", "\n"] + \
+                               generated_line_list + ["// *INDENT-ON*\n", "\n"] +         \
+                               output_line_list_three
+
+    return output_line_list
+
+def copy_file(source, destination):
+    '''Copy a file from source to destination using OS commands'''
+    success = False
+
+    call_list = []
+    if platform.system() == "Windows":
+        call_list.append("copy")
+        call_list.append("/Y")
+    else:
+        call_list.append("cp")
+    call_list.append(source)
+    call_list.append(destination)
+    try:
+        print(f"Copying {source} to {destination}...")
+        subprocess.check_output(subprocess_osify(call_list), shell=True)
+        success = True
+    except subprocess.CalledProcessError as error:
+        print(f"Error when copying {source} to {destination}," \
+              f"{error.cmd} {error.returncode}: \"{ error.output}\"")
+    return success
+
+def main(target_file):
+    '''Main as a function'''
+    return_value = 1
+    line_list = []
+    generated_line_list = []
+
+    signal(SIGINT, signal_handler)
+
+    if os.path.isfile(target_file):
+        with open(target_file, "r", encoding="utf8") as file:
+            # Read the lot in
+            print(f"Reading file {target_file}...")
+            line_list = file.readlines()
+        for message in MESSAGE_LIST:
+            message_line_list = create_message(message)
+            if not message_line_list:
+                generated_line_list = []
+                break
+            generated_line_list += message_line_list
+        if generated_line_list:
+            print(f"{len(MESSAGE_LIST)} message(s) described, re-writing file...")
+            line_list = rewrite_line_list(generated_line_list, line_list)
+            if line_list:
+                # Done everything; make a back-up copy of the file
+                if copy_file(target_file, target_file + BACKUP_EXTENSION):
+                    #... and write line_list back to the file
+                    with open(target_file, "w", encoding="utf8") as file:
+                        file.writelines(line_list)
+                        print("{} has been re-written.".format(target_file))
+                        return_value = 0
+    else:
+        print(f"\"{target_file}\" is not a file.")
+
+    return return_value
+
+if __name__ == "__main__":
+    PARSER = argparse.ArgumentParser(description="A script to"      \
+                                     " update the UBX message"      \
+                                     " structures in " + TARGET_FILE_NAME + ".\n")
+    PARSER.add_argument("-f", default=TARGET_FILE_NAME, help="the" \
+                        " file name to update, default " + TARGET_FILE_NAME)
+    ARGS = PARSER.parse_args()
+
+    # Call main()
+    RETURN_VALUE = main(ARGS.f)
+
+    sys.exit(RETURN_VALUE)
+
+# A main is required because Windows needs it in order to
+# behave when this module is called during multiprocessing
+# see https://docs.python.org/2/library/multiprocessing.html#windows
+if __name__ == '__main__':
+    freeze_support()
+    PROCESS = Process(target=main)
+    PROCESS.start()
@@ -188,6 +188,68 @@ int32_t uGnssPosGetStart(uDeviceHandle_t gnssHandle,
  */
 void uGnssPosGetStop(uDeviceHandle_t gnssHandle);
 
+/** Get position streamed from the GNSS chip: rather than the MCU
+ * polling for position, as uGnssPosGet() and uGnssPosGetStart() do,
+ * the GNSS chip is configured to emit UBX-NAV-PVT at the given rate
+ * and pCallback is called each time one arrives, which may be up to
+ * the maximum navigation rate of the GNSS chip (e.g. 25 Hz).  The
+ * measurement rate and UBX-NAV-PVT output are set with
+ * uGnssCfgValSetList() in the RAM layer only; call
+ * uGnssPosGetStreamedStop() to stop the stream.  Only one streamed
+ * position may be active at any one time: call
+ * uGnssPosGetStreamedStop() before starting another, otherwise
+ * #U_ERROR_COMMON_NO_MEMORY will be returned.
+ *
+ * Only supported on M9 modules and beyond, which support the
+ * CFG-VALSET mechanism, and, since it uses uGnssMsgReceiveStart(),
+ * only where the GNSS chip is connected directly to this MCU, i.e.
+ * NOT via an intermediate [e.g. cellular] module.  This uses one of
+ * the #U_GNSS_MSG_RECEIVER_MAX_NUM message receivers.
+ *
+ * @param gnssHandle     the handle of the GNSS instance to use.
+ * @param rateMs         the desired measurement period in milliseconds,
+ *                       e.g. 1000 for 1 Hz, 40 for 25 Hz; must be
+ *                       greater than zero and no more than 65535, the
+ *                       GNSS chip may reject values outside its own
+ *                       limits.  The navigation rate (the number of
+ *                       measurements per navigation solution) is not
+ *                       modified.
+ * @param[in] pCallback  a callback that will be called for each
+ *                       UBX-NAV-PVT message received, with parameters
+ *                       as described for uGnssPosGetStart(); errorCode
+ *                       will be #U_ERROR_COMMON_TIMEOUT, with the
+ *                       position values set to their "unknown" values,
+ *                       until a fix is achieved.  pCallback is run in
+ *                       the context of the message receive task and
+ *                       hence the rules described for the pCallback
+ *                       of uGnssMsgReceiveStart() apply: in particular,
+ *                       do NOT call back into the GNSS API from it.
+ *                       Cannot be NULL.
+ * @return               zero on success or negative error code on
+ *                       failure.
+ */
+int32_t uGnssPosGetStreamedStart(uDeviceHandle_t gnssHandle,
+                                 int32_t rateMs,
+                                 void (*pCallback) (uDeviceHandle_t gnssHandle,
+                                                    int32_t errorCode,
+                                                    int32_t latitudeX1e7,
+                                                    int32_t longitudeX1e7,
+                                                    int32_t altitudeMillimetres,
+                                                    int32_t radiusMillimetres,
+                                                    int32_t speedMillimetresPerSecond,
+                                                    int32_t svs,
+                                                    int64_t timeUtc));
+
+/** Stop streamed position that was started with
+ * uGnssPosGetStreamedStart(); once this function returns pCallback
+ * will no longer be called.  UBX-NAV-PVT output is switched off
+ * again in the RAM layer but the measurement rate is left as it was
+ * set by uGnssPosGetStreamedStart().
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ */
+void uGnssPosGetStreamedStop(uDeviceHandle_t gnssHandle);
+
 /** Get the binary RRLP information directly from the GNSS chip,
  * as returned by the UBX-RXM-MEASX command of the UBX protocol.  This
  * is more efficient, both in terms of power and time, than asking
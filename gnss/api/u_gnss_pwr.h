@@ -103,10 +103,169 @@ extern "C" {
 # define U_GNSS_AT_POWER_ON_RETRY_INTERVAL_SECONDS 10
 #endif
 
+#ifndef U_GNSS_PWR_SAVE_STATE_TIMEOUT_SECONDS
+/** How long to wait for the GNSS chip to confirm that it has
+ * written its state to flash when uGnssPwrSaveState() is called
+ * with no callback.
+ */
+# define U_GNSS_PWR_SAVE_STATE_TIMEOUT_SECONDS 10
+#endif
+
+#ifndef U_GNSS_PWR_SAVE_STATE_MESSAGE_TIMEOUT_MS
+/** When uGnssPwrSaveState() is reading the state of the GNSS
+ * chip back to this MCU, as a sequence of UBX-MGA-DBD messages,
+ * how long to wait for the next message before deciding that
+ * there are no more.
+ */
+# define U_GNSS_PWR_SAVE_STATE_MESSAGE_TIMEOUT_MS 1000
+#endif
+
+#ifndef U_GNSS_PWR_PSM_CYCLIC_TRACKING_MAX_PERIOD_MS
+/** The longest update period that cyclic tracking can provide, in
+ * milliseconds; beyond this the GNSS chip has to switch off between
+ * fixes, i.e. ON/OFF operation, see #U_GNSS_PWR_PSM_MODE_ON_OFF.
+ */
+# define U_GNSS_PWR_PSM_CYCLIC_TRACKING_MAX_PERIOD_MS 10000
+#endif
+
+#ifndef U_GNSS_PWR_PSM_ON_OFF_MIN_PERIOD_MS
+/** The shortest update period for which ON/OFF operation makes
+ * sense, in milliseconds; for anything shorter use cyclic tracking,
+ * see #U_GNSS_PWR_PSM_MODE_CYCLIC_TRACKING.
+ */
+# define U_GNSS_PWR_PSM_ON_OFF_MIN_PERIOD_MS 5000
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The outcome of the GNSS chip restoring its state from flash at
+ * start-up, as returned by uGnssPwrRestoreState(); the values match
+ * those of the response field of UBX-UPD-SOS.
+ */
+typedef enum {
+    U_GNSS_PWR_RESTORE_RESULT_UNKNOWN = 0,
+    U_GNSS_PWR_RESTORE_RESULT_FAILED = 1,
+    U_GNSS_PWR_RESTORE_RESULT_RESTORED = 2,
+    U_GNSS_PWR_RESTORE_RESULT_NO_BACKUP = 3
+} uGnssPwrRestoreResult_t;
+
+/** The power states that energy is accounted against, see
+ * uGnssPwrEnergyStart().
+ */
+typedef enum {
+    U_GNSS_PWR_ENERGY_STATE_OFF = 0,     /**< the GNSS chip is powered off. */
+    U_GNSS_PWR_ENERGY_STATE_BACKUP,      /**< the GNSS chip is in back-up
+                                              mode, see uGnssPwrOffBackup(). */
+    U_GNSS_PWR_ENERGY_STATE_ACQUISITION, /**< the GNSS chip is on but
+                                              does not have a fix. */
+    U_GNSS_PWR_ENERGY_STATE_TRACKING,    /**< the GNSS chip is on and has
+                                              a fix. */
+    U_GNSS_PWR_ENERGY_STATE_MAX_NUM
+} uGnssPwrEnergyState_t;
+
+/** The current drawn by the GNSS chip in each of the power states,
+ * as measured or taken from the data sheet by the application;
+ * used to estimate energy, see uGnssPwrEnergyStart().
+ */
+typedef struct {
+    int32_t currentMicroAmps[U_GNSS_PWR_ENERGY_STATE_MAX_NUM]; /**< indexed
+                                                                    by
+                                                                    #uGnssPwrEnergyState_t. */
+    int32_t supplyMillivolts; /**< the supply voltage of the GNSS chip. */
+} uGnssPwrCurrentTable_t;
+
+/** The energy accounts of a GNSS instance, see uGnssPwrEnergyGet().
+ */
+typedef struct {
+    int64_t timeMs[U_GNSS_PWR_ENERGY_STATE_MAX_NUM]; /**< the time spent
+                                                          in each state,
+                                                          indexed by
+                                                          #uGnssPwrEnergyState_t. */
+    uint32_t fixes;                 /**< the number of position fixes
+                                         obtained. */
+    int64_t energyMicrojoules;      /**< the estimated energy used, -1 if
+                                         no current table was given. */
+    int64_t energyPerFixMicrojoules; /**< energyMicrojoules divided by
+                                          fixes, -1 if either is not
+                                          known. */
+} uGnssPwrEnergy_t;
+
+/** The power save modes that a GNSS chip may be put into with
+ * uGnssPwrSetPsm(); the values match those of CFG-PM-OPERATEMODE.
+ */
+typedef enum {
+    U_GNSS_PWR_PSM_MODE_CONTINUOUS = 0,      /**< full power, tracking
+                                                  continuously. */
+    U_GNSS_PWR_PSM_MODE_ON_OFF = 1,          /**< the GNSS chip switches
+                                                  off between fixes, for
+                                                  update periods of
+                                                  #U_GNSS_PWR_PSM_ON_OFF_MIN_PERIOD_MS
+                                                  or more. */
+    U_GNSS_PWR_PSM_MODE_CYCLIC_TRACKING = 2, /**< the GNSS chip stays
+                                                  on but only tracks
+                                                  for part of each
+                                                  update period, for
+                                                  update periods of up to
+                                                  #U_GNSS_PWR_PSM_CYCLIC_TRACKING_MAX_PERIOD_MS. */
+    U_GNSS_PWR_PSM_MODE_MAX_NUM
+} uGnssPwrPsmMode_t;
+
+/** A power save configuration, see uGnssPwrSetPsm().
+ */
+typedef struct {
+    uGnssPwrPsmMode_t mode; /**< the mode. */
+    int32_t updatePeriodMs; /**< the target period between position
+                                 updates in milliseconds; for
+                                 #U_GNSS_PWR_PSM_MODE_CONTINUOUS zero
+                                 leaves the measurement rate alone,
+                                 for #U_GNSS_PWR_PSM_MODE_ON_OFF this
+                                 must be a whole number of seconds. */
+    int32_t maxLatencyMs;   /**< only used for #U_GNSS_PWR_PSM_MODE_ON_OFF:
+                                 the longest that the GNSS chip may
+                                 spend trying to obtain a fix after
+                                 waking up before it gives up and
+                                 goes back to sleep until the next
+                                 update period, in milliseconds,
+                                 rounded down to whole seconds and at
+                                 most 255 seconds; zero means no limit. */
+} uGnssPwrPsmConfig_t;
+
+/** The duty cycle that a power save mode has achieved, see
+ * uGnssPwrGetPsmDutyCycle().
+ */
+typedef struct {
+    int32_t awakePermille; /**< the time that the GNSS chip was awake
+                                as a proportion of monitoredMs, in
+                                thousandths; -1 if not yet known. */
+    int64_t monitoredMs;   /**< the time over which the duty cycle
+                                has been measured, from the first
+                                UBX-MON-RXR message after
+                                uGnssPwrSetPsm() was called. */
+    uint32_t wakeUps;      /**< the number of times the GNSS chip
+                                has woken up. */
+} uGnssPwrPsmDutyCycle_t;
+
+/** Callback that is given the state of the GNSS chip, as a sequence
+ * of UBX-MGA-DBD messages, by uGnssPwrSaveState().  The callback is
+ * called with the GNSS API locked and so must NOT call back into the
+ * GNSS API.
+ *
+ * @param gnssHandle          the handle of the GNSS instance.
+ * @param[in] pMessage        one complete UBX-MGA-DBD message, including
+ *                            the UBX header and checksum; the messages
+ *                            should be stored one after the other so
+ *                            that they can be passed to
+ *                            uGnssPwrRestoreState() later.
+ * @param size                the number of bytes at pMessage.
+ * @param[in] pCallbackParam  the pCallbackParam passed to
+ *                            uGnssPwrSaveState().
+ */
+typedef void (uGnssPwrSaveCallback_t)(uDeviceHandle_t gnssHandle,
+                                      const char *pMessage, size_t size,
+                                      void *pCallbackParam);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -156,6 +315,157 @@ int32_t uGnssPwrOff(uDeviceHandle_t gnssHandle);
  */
 int32_t uGnssPwrOffBackup(uDeviceHandle_t gnssHandle);
 
+/** Save the navigation state (ephemeris, almanac, last position,
+ * etc.) of a GNSS chip so that it can be hot-started even after a
+ * complete loss of power.  If pCallback is NULL the GNSS chip is
+ * stopped and asked, with UBX-UPD-SOS, to write its state to its
+ * own flash memory, from where it will restore it automatically at
+ * the next start-up; the outcome of that can be checked by calling
+ * uGnssPwrRestoreState() with a NULL buffer once the GNSS chip has
+ * been powered on again.  Since the GNSS chip is left stopped you
+ * should power it off, e.g. with uGnssPwrOff(), after this.  Note
+ * that not all GNSS chips have flash memory.
+ *
+ * If pCallback is non-NULL the navigation database of the GNSS chip
+ * is instead read back to this MCU, as a sequence of UBX-MGA-DBD
+ * messages, each passed to pCallback; the GNSS chip is not stopped.
+ * The stored messages may be written back to the GNSS chip with
+ * uGnssPwrRestoreState().
+ *
+ * Neither form is supported if the GNSS chip is connected via an
+ * intermediate [e.g. cellular] module.
+ *
+ * @param gnssHandle          the handle of the GNSS instance.
+ * @param[in] pCallback       the callback to receive the state; may
+ *                            be NULL to save the state to the flash
+ *                            memory of the GNSS chip.
+ * @param[in] pCallbackParam  a parameter that will be passed to
+ *                            pCallback; may be NULL.
+ * @return                    if pCallback is NULL, zero if the GNSS
+ *                            chip confirmed that the state has been
+ *                            written to flash, else negative error code,
+ *                            #U_GNSS_ERROR_NACK if the GNSS chip
+ *                            refused; if pCallback is non-NULL, the
+ *                            number of UBX-MGA-DBD messages passed to
+ *                            pCallback, else negative error code.
+ */
+int32_t uGnssPwrSaveState(uDeviceHandle_t gnssHandle,
+                          uGnssPwrSaveCallback_t *pCallback,
+                          void *pCallbackParam);
+
+/** Restore the navigation state of a GNSS chip that was saved with
+ * uGnssPwrSaveState(), or check the outcome of the GNSS chip's own
+ * restoration from flash; call this after uGnssPwrOn().  Not supported
+ * if the GNSS chip is connected via an intermediate [e.g. cellular]
+ * module.
+ *
+ * @param gnssHandle          the handle of the GNSS instance.
+ * @param[in] pBuffer         the UBX-MGA-DBD messages that were passed
+ *                            to the callback of uGnssPwrSaveState(), one
+ *                            after the other; use NULL to instead obtain,
+ *                            with UBX-UPD-SOS, the outcome of the GNSS
+ *                            chip restoring its state from its own flash
+ *                            memory at start-up.
+ * @param size                the number of bytes at pBuffer.
+ * @return                    if pBuffer is NULL, the outcome of
+ *                            restoration from flash (a value from
+ *                            #uGnssPwrRestoreResult_t), else the number
+ *                            of UBX-MGA-DBD messages written to the
+ *                            GNSS chip; negative error code on failure.
+ */
+int32_t uGnssPwrRestoreState(uDeviceHandle_t gnssHandle,
+                             const char *pBuffer, size_t size);
+
+/** Start accounting for the time the GNSS chip spends in each power
+ * state (see #uGnssPwrEnergyState_t) and for the position fixes
+ * obtained, so that the energy used per fix can be estimated with
+ * uGnssPwrEnergyGet().  The accounts are reset.
+ *
+ * Power state changes are taken from uGnssPwrOn(), uGnssPwrOff() and
+ * uGnssPwrOffBackup(); the GNSS chip is taken to be tracking from the
+ * time a position is obtained, through uGnssPosGet(),
+ * uGnssPosGetStart() or uGnssPosGetStreamedStart(), until a position
+ * request finds that there is no fix, when it is taken to be
+ * acquiring again.  When this function is called the GNSS chip is
+ * assumed to be acquiring.
+ *
+ * @param gnssHandle      the handle of the GNSS instance.
+ * @param[in] pTable      the current drawn in each power state,
+ *                        which is copied; may be NULL, in which
+ *                        case no energy is estimated, only time.
+ * @return                zero on success or negative error code.
+ */
+int32_t uGnssPwrEnergyStart(uDeviceHandle_t gnssHandle,
+                            const uGnssPwrCurrentTable_t *pTable);
+
+/** Get the energy accounts started by uGnssPwrEnergyStart(), up to
+ * the time of this call.
+ *
+ * @param gnssHandle      the handle of the GNSS instance.
+ * @param[out] pEnergy    a place to put the accounts; cannot be NULL.
+ * @return                zero on success or negative error code,
+ *                        #U_ERROR_COMMON_NOT_INITIALISED if
+ *                        uGnssPwrEnergyStart() has not been called.
+ */
+int32_t uGnssPwrEnergyGet(uDeviceHandle_t gnssHandle,
+                          uGnssPwrEnergy_t *pEnergy);
+
+/** Stop energy accounting and free the memory it used.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ */
+void uGnssPwrEnergyStop(uDeviceHandle_t gnssHandle);
+
+/** Put the GNSS chip into a power save mode, trading latency and
+ * availability of position for power: cyclic tracking for update
+ * periods of up to #U_GNSS_PWR_PSM_CYCLIC_TRACKING_MAX_PERIOD_MS,
+ * ON/OFF operation for update periods of
+ * #U_GNSS_PWR_PSM_ON_OFF_MIN_PERIOD_MS or more, or back to
+ * continuous operation.  The setting is made in the RAM layer, i.e.
+ * it is lost if the GNSS chip is reset or powered off.
+ *
+ * When a power save mode is set, UBX-MON-RXR output is switched on
+ * for the port this MCU is connected to and the changes between
+ * awake and asleep that it reports are counted to give the duty cycle
+ * that is actually achieved, see uGnssPwrGetPsmDutyCycle(); this
+ * stops when continuous operation is set.
+ *
+ * Not all GNSS modules support all combinations: those that cannot be
+ * configured through CFG-PM (e.g. M8) or which are connected via an
+ * intermediate AT module will return #U_ERROR_COMMON_NOT_SUPPORTED,
+ * and an update period that is not in range for the mode will return
+ * #U_ERROR_COMMON_INVALID_PARAMETER.
+ *
+ * @param gnssHandle   the handle of the GNSS instance.
+ * @param[in] pConfig  the configuration to set; cannot be NULL.
+ * @return             zero on success or negative error code.
+ */
+int32_t uGnssPwrSetPsm(uDeviceHandle_t gnssHandle,
+                       const uGnssPwrPsmConfig_t *pConfig);
+
+/** Get the power save configuration of the GNSS chip, as read from
+ * the RAM layer; maxLatencyMs is only populated for
+ * #U_GNSS_PWR_PSM_MODE_ON_OFF.
+ *
+ * @param gnssHandle    the handle of the GNSS instance.
+ * @param[out] pConfig  a place to put the configuration; cannot be NULL.
+ * @return              zero on success or negative error code.
+ */
+int32_t uGnssPwrGetPsm(uDeviceHandle_t gnssHandle,
+                       uGnssPwrPsmConfig_t *pConfig);
+
+/** Get the duty cycle that the power save mode set by uGnssPwrSetPsm()
+ * has achieved so far.
+ *
+ * @param gnssHandle       the handle of the GNSS instance.
+ * @param[out] pDutyCycle  a place to put the duty cycle; cannot be NULL.
+ * @return                 zero on success or negative error code,
+ *                         #U_ERROR_COMMON_NOT_INITIALISED if no power
+ *                         save mode has been set with uGnssPwrSetPsm().
+ */
+int32_t uGnssPwrGetPsmDutyCycle(uDeviceHandle_t gnssHandle,
+                                uGnssPwrPsmDutyCycle_t *pDutyCycle);
+
 #ifdef __cplusplus
 }
 #endif
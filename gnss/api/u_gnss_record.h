@@ -0,0 +1,179 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_RECORD_H_
+#define _U_GNSS_RECORD_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_device.h"
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the raw stream recorder of GNSS,
+ * which makes a complete copy of the byte stream from the GNSS chip,
+ * e.g. UBX-RXM-RAWX and UBX-RXM-SFRBX at 10 Hz for post-processing
+ * (PPK), without the per-message overhead of a message receiver.
+ *
+ * The bytes are copied, as they are read from the transport into
+ * the ring buffer of the GNSS instance, into one half of a double
+ * buffer; when that half is full it is passed to a sink, a callback
+ * of yours, in a task of its own, while the other half fills.  The
+ * transport is never held up by the sink: if the sink is still busy
+ * with one half when the other fills, further bytes are dropped,
+ * and counted, until it is done.  Size the buffer so that half of
+ * it holds more than the stream brings in while the sink writes
+ * the other half.
+ *
+ * The sink may write to anything; to a file on a Windows or Linux
+ * host, for instance:
+ *
+ * ```
+ * int32_t mySinkHostFile(uDeviceHandle_t gnssHandle,
+ *                        const char *pData, size_t size,
+ *                        void *pSinkParam)
+ * {
+ *     (void) gnssHandle;
+ *     return fwrite(pData, 1, size, (FILE *) pSinkParam) == size ? 0 : -1;
+ * }
+ * ```
+ *
+ * ...or to the file system of a cellular module, which appends
+ * each block to the file:
+ *
+ * ```
+ * int32_t mySinkCellFile(uDeviceHandle_t gnssHandle,
+ *                        const char *pData, size_t size,
+ *                        void *pSinkParam)
+ * {
+ *     (void) gnssHandle;
+ *     return uCellFileWrite(gCellHandle, (const char *) pSinkParam, pData, size);
+ * }
+ * ```
+ *
+ * Recording only sees what is read from the transport, so some
+ * other activity must be pulling data in: a message receiver
+ * started with uGnssMsgReceiveStart() for the messages of interest
+ * will do.  Recording is not supported where the GNSS chip is
+ * connected via an intermediate AT module.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_GNSS_RECORD_TASK_STACK_SIZE_BYTES
+/** The stack size of the task that calls the sink; this is
+ * large enough for a sink that sends AT commands to a cellular
+ * module, e.g. with uCellFileWrite().
+ */
+# define U_GNSS_RECORD_TASK_STACK_SIZE_BYTES (1024 * 3)
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The sink for recorded data, called from the task of the
+ * recorder each time a half of the buffer is full and when
+ * recording stops.
+ *
+ * @param gnssHandle      the handle of the GNSS instance.
+ * @param[in] pData       the data.
+ * @param size            the number of bytes at pData.
+ * @param[in] pSinkParam  the parameter passed to uGnssRecordStart().
+ * @return                zero or a positive value on success, else
+ *                        negative error code, in which case the
+ *                        data is counted as dropped.
+ */
+typedef int32_t (*uGnssRecordSink_t)(uDeviceHandle_t gnssHandle,
+                                     const char *pData, size_t size,
+                                     void *pSinkParam);
+
+/** Statistics for the recorder, see uGnssRecordStatsGet().
+ */
+typedef struct {
+    uint32_t bytesRecorded;  /**< the number of bytes that the sink
+                                  has taken. */
+    uint32_t bytesDropped;   /**< the number of bytes that were lost
+                                  through overruns or sink errors. */
+    uint32_t numOverruns;    /**< the number of gaps in the recording
+                                  caused by the sink not keeping up. */
+    uint32_t numSinkErrors;  /**< the number of times the sink
+                                  returned an error. */
+} uGnssRecordStats_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Start recording the raw byte stream from the GNSS chip.  Only
+ * one recording may be in progress per GNSS instance.
+ *
+ * @param gnssHandle       the handle of the GNSS instance.
+ * @param bufferSizeBytes  the size of the double buffer that will
+ *                         be allocated, each half being half this
+ *                         size; must be at least two.
+ * @param[in] pSink        the sink, cannot be NULL.
+ * @param[in] pSinkParam   a parameter that will be passed to pSink.
+ * @return                 zero on success else negative error code;
+ *                         #U_ERROR_COMMON_NO_MEMORY if a recording
+ *                         is already in progress.
+ */
+int32_t uGnssRecordStart(uDeviceHandle_t gnssHandle,
+                         size_t bufferSizeBytes,
+                         uGnssRecordSink_t pSink,
+                         void *pSinkParam);
+
+/** Get the statistics of the recording in progress.
+ *
+ * @param gnssHandle   the handle of the GNSS instance.
+ * @param[out] pStats  a place to put the statistics, cannot be NULL.
+ * @return             zero on success else negative error code.
+ */
+int32_t uGnssRecordStatsGet(uDeviceHandle_t gnssHandle,
+                            uGnssRecordStats_t *pStats);
+
+/** Stop recording: whatever has been collected is passed to the
+ * sink, and the sink is not called again once this returns.
+ *
+ * @param gnssHandle   the handle of the GNSS instance.
+ * @param[out] pStats  a place to put the final statistics, may
+ *                     be NULL.
+ * @return             zero on success else negative error code.
+ */
+int32_t uGnssRecordStop(uDeviceHandle_t gnssHandle,
+                        uGnssRecordStats_t *pStats);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_RECORD_H_
+
+// End of file
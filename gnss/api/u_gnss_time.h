@@ -0,0 +1,226 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_TIME_H_
+#define _U_GNSS_TIME_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_device.h"
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the high-precision time API of
+ * GNSS, which maintains the offset between a host clock and GNSS
+ * time, for time-synchronisation applications.  The GNSS chip is
+ * asked to emit UBX-TIM-TP, which gives the GNSS time of the next
+ * timepulse and its quantisation error, and optionally UBX-TIM-TM2,
+ * which gives the GNSS time of an edge on an EXTINT pin.  The
+ * application connects the timepulse output of the GNSS chip to
+ * an interrupt-capable input of this MCU and, in the interrupt, calls
+ * uGnssTimeSyncPulseIsr() with the host time of the edge; likewise
+ * for uGnssTimeSyncMarkIsr() if it drives an EXTINT pin.  Each edge is
+ * then correlated with the message describing it and the result,
+ * a #uGnssTimeSyncSample_t, may be read at any time, without any
+ * access to the GNSS chip, with uGnssTimeSyncGet().
+ *
+ * These functions are only supported where the GNSS chip is M9 or
+ * later and is connected directly to this MCU (i.e. not via an
+ * intermediate AT module).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The result of correlating an edge at the host with the GNSS
+ * time of that edge, as returned by uGnssTimeSyncGet().
+ */
+typedef struct {
+    int64_t hostTimeNs;   /**< the host time of the edge, as passed to
+                               uGnssTimeSyncPulseIsr() or
+                               uGnssTimeSyncMarkIsr(). */
+    int64_t gnssTimeNs;   /**< the GNSS time of the same edge, in
+                               nanoseconds since the start of week zero
+                               of the time base (see utcNotGnss), with
+                               the quantisation error of the timepulse
+                               already applied. */
+    int64_t offsetNs;     /**< gnssTimeNs minus hostTimeNs: add this to
+                               a host time to get GNSS time. */
+    int32_t qErrPs;       /**< the quantisation error of the timepulse
+                               in picoseconds, as reported by the GNSS
+                               chip and applied to gnssTimeNs; zero for
+                               a time mark or if the GNSS chip reported
+                               the value as invalid. */
+    bool utcNotGnss;      /**< true if the time base is UTC, false
+                               if it is GNSS (e.g. GPS) time. */
+    bool markNotPulse;    /**< true if this sample came from a time mark
+                               (UBX-TIM-TM2), false if it came from the
+                               timepulse (UBX-TIM-TP). */
+    uint32_t count;       /**< the number of samples so far; this
+                               increments with each new sample. */
+} uGnssTimeSyncSample_t;
+
+/** The context for time synchronisation: the application must
+ * provide the storage, which must persist from uGnssTimeSyncStart()
+ * until uGnssTimeSyncStop() has returned; the contents should be
+ * treated as private.
+ */
+typedef struct {
+    volatile uint32_t pulseSequence;  /**< incremented before and after
+                                           pulseHostTimeNs is written. */
+    volatile int64_t pulseHostTimeNs; /**< the host time of the last timepulse. */
+    volatile uint32_t markSequence;   /**< incremented before and after
+                                           markHostTimeNs is written. */
+    volatile int64_t markHostTimeNs;  /**< the host time of the last time mark. */
+    bool pulsePending;                /**< true if pulseGnssTimeNs etc. describe
+                                           a timepulse yet to occur. */
+    uint32_t pulsePendingSequence;    /**< pulseSequence when the pending
+                                           UBX-TIM-TP arrived. */
+    int64_t pulseGnssTimeNs;          /**< the GNSS time of the pending timepulse. */
+    int32_t pulseQErrPs;              /**< the quantisation error of the pending timepulse. */
+    bool pulseUtcNotGnss;             /**< the time base of the pending timepulse. */
+    uint32_t markLastSequence;        /**< markSequence when the last
+                                           UBX-TIM-TM2 arrived. */
+    int32_t markCount;                /**< the rising edge count of the last
+                                           UBX-TIM-TM2, -1 if there isn't one. */
+    uGnssTimeSyncSample_t sample;     /**< the latest sample. */
+    int32_t asyncHandleTp;            /**< the message receiver for UBX-TIM-TP. */
+    int32_t asyncHandleTm2;           /**< the message receiver for UBX-TIM-TM2,
+                                           -1 if there isn't one. */
+    uint32_t msgOutKeyIdTp;           /**< the CFG-MSGOUT key ID for UBX-TIM-TP. */
+    uint32_t msgOutKeyIdTm2;          /**< the CFG-MSGOUT key ID for UBX-TIM-TM2,
+                                           zero if not in use. */
+} uGnssTimeSync_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Start time synchronisation: UBX-TIM-TP output (and, if
+ * useTimeMark is true, UBX-TIM-TM2 output) is switched on, in RAM,
+ * on the port of the GNSS chip that this MCU is connected to and the
+ * messages are captured using the message receive API, hence this
+ * uses one (or two) of the #U_GNSS_MSG_RECEIVER_MAX_NUM message
+ * receivers.  The timepulse itself should already be configured
+ * (by default it is one pulse per second, aligned to GPS time, on
+ * the rising edge); if you change the time base of the timepulse to
+ * UTC with CFG-TP-TIMEGRID_TP1 the time in the samples will follow.
+ * Only one time synchronisation may be active per GNSS instance.
+ *
+ * @param gnssHandle   the handle of the GNSS instance.
+ * @param[in] pSync    storage for the context, which must persist
+ *                     until uGnssTimeSyncStop() has returned; cannot
+ *                     be NULL.
+ * @param useTimeMark  if true, UBX-TIM-TM2 is also used, in which
+ *                     case the application must drive (or capture)
+ *                     the EXTINT pin of the GNSS chip and call
+ *                     uGnssTimeSyncMarkIsr() at each rising edge.
+ * @return             zero on success else negative error code.
+ */
+int32_t uGnssTimeSyncStart(uDeviceHandle_t gnssHandle,
+                           uGnssTimeSync_t *pSync,
+                           bool useTimeMark);
+
+/** Tell the time synchronisation that a timepulse edge has occurred;
+ * this is intended to be called from the interrupt of the MCU pin
+ * connected to the timepulse output of the GNSS chip: it does no more
+ * than store the time.  Call it on the edge that the timepulse is
+ * configured to be aligned to (by default the rising edge).
+ *
+ * @param[in] pSync    the context passed to uGnssTimeSyncStart(); cannot
+ *                     be NULL.
+ * @param hostTimeNs   the host time of the edge in nanoseconds, e.g.
+ *                     from a hardware capture timer; use -1 to have
+ *                     uPortGetTickTimeUs() read here instead.
+ */
+void uGnssTimeSyncPulseIsr(uGnssTimeSync_t *pSync, int64_t hostTimeNs);
+
+/** As uGnssTimeSyncPulseIsr() but for a rising edge on the EXTINT
+ * pin of the GNSS chip; only relevant if uGnssTimeSyncStart() was
+ * called with useTimeMark set to true.
+ *
+ * @param[in] pSync    the context passed to uGnssTimeSyncStart(); cannot
+ *                     be NULL.
+ * @param hostTimeNs   the host time of the edge in nanoseconds; use -1
+ *                     to have uPortGetTickTimeUs() read here instead.
+ */
+void uGnssTimeSyncMarkIsr(uGnssTimeSync_t *pSync, int64_t hostTimeNs);
+
+/** Process a UBX-TIM-TP or UBX-TIM-TM2 message; this is done for
+ * you by the message receivers set up by uGnssTimeSyncStart() and
+ * so need only be called if the application obtains these messages
+ * itself, in which case uGnssTimeSyncStart() need not be called but
+ * the context must be zeroed before first use.  A UBX-TIM-TP message
+ * is correlated with the first timepulse edge to follow it, a
+ * UBX-TIM-TM2 message with the time mark edge that preceded it;
+ * where more than one edge has occurred between messages the
+ * correlation is ambiguous and no sample is produced.
+ *
+ * @param[in] pSync     the context; cannot be NULL.
+ * @param[in] pMessage  the whole UBX message, including the header
+ *                      and checksum; cannot be NULL.
+ * @param size          the number of bytes at pMessage.
+ * @return              true if a new sample was produced.
+ */
+bool uGnssTimeSyncProcessMessage(uGnssTimeSync_t *pSync,
+                                 const char *pMessage, size_t size);
+
+/** Get the latest time synchronisation sample; this does not
+ * communicate with the GNSS chip and may be called as often as
+ * required.
+ *
+ * @param[in] pSync     the context; cannot be NULL.
+ * @param[out] pSample  a place to put the sample; cannot be NULL.
+ * @return              zero on success, #U_ERROR_COMMON_NOT_FOUND if
+ *                      there is no sample yet, else negative error
+ *                      code.
+ */
+int32_t uGnssTimeSyncGet(uGnssTimeSync_t *pSync,
+                         uGnssTimeSyncSample_t *pSample);
+
+/** Stop time synchronisation: the message receivers are stopped and
+ * UBX-TIM-TP/UBX-TIM-TM2 output switched off again.  Once this has
+ * returned the context may be freed; the last sample remains
+ * readable with uGnssTimeSyncGet() until then.
+ *
+ * @param gnssHandle   the handle of the GNSS instance.
+ */
+void uGnssTimeSyncStop(uDeviceHandle_t gnssHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_TIME_H_
+
+// End of file
@@ -144,6 +144,14 @@ typedef enum {
                                      PLEASE USE #U_GNSS_TRANSPORT_I2C instead and
                                      use uGnssCfgSetProtocolOut() to switch off NMEA
                                      message output if required. */
+    U_GNSS_TRANSPORT_VIRTUAL_SERIAL, /**< the transport handle should be a pointer
+                                          to a #uGnssVirtualSerial_t, e.g. a
+                                          multiplexer channel through a cellular
+                                          module to a GNSS chip attached to it;
+                                          UBX and NMEA messages are streamed exactly
+                                          as they would be over #U_GNSS_TRANSPORT_UART,
+                                          rather than being hex-encoded into AT
+                                          commands as for #U_GNSS_TRANSPORT_AT. */
     U_GNSS_TRANSPORT_MAX_NUM_WITH_UBX,
     U_GNSS_TRANSPORT_UBX_AT = U_GNSS_TRANSPORT_AT,      /**< \deprecated the transport handle should be an AT client
                                                              handle over which UBX commands will be
@@ -162,6 +170,47 @@ typedef enum {
     U_GNSS_TRANSPORT_MAX_NUM
 } uGnssTransportType_t;
 
+/** A virtual serial port, for transport type
+ * #U_GNSS_TRANSPORT_VIRTUAL_SERIAL: a set of functions, provided by
+ * the application or by another ubxlib module, that move bytes to
+ * and from a GNSS chip over something that behaves like a UART but
+ * is not one, e.g. a multiplexer channel of a cellular module.  The
+ * functions are called with the GNSS transport mutex locked, from the
+ * calling task or from the message receive task, and must not block
+ * for longer than is necessary to move the data.  The structure must
+ * remain valid until the GNSS instance has been removed.
+ */
+typedef struct uGnssVirtualSerial_t {
+    /** Get the number of bytes waiting to be read; must not be NULL.
+     *
+     * @param[in] pVirtualSerial  a pointer to this structure.
+     * @return                    the number of bytes that may be read,
+     *                            else negative error code.
+     */
+    int32_t (*pGetReceiveSize)(struct uGnssVirtualSerial_t *pVirtualSerial);
+    /** Read bytes; must not be NULL.
+     *
+     * @param[in] pVirtualSerial  a pointer to this structure.
+     * @param[out] pBuffer        a place to put the bytes, never NULL.
+     * @param sizeBytes           the amount of storage at pBuffer.
+     * @return                    the number of bytes read, else
+     *                            negative error code.
+     */
+    int32_t (*pRead)(struct uGnssVirtualSerial_t *pVirtualSerial,
+                     char *pBuffer, size_t sizeBytes);
+    /** Write bytes; must not be NULL.
+     *
+     * @param[in] pVirtualSerial  a pointer to this structure.
+     * @param[in] pBuffer         the bytes to write, never NULL.
+     * @param sizeBytes           the number of bytes at pBuffer.
+     * @return                    the number of bytes written, else
+     *                            negative error code.
+     */
+    int32_t (*pWrite)(struct uGnssVirtualSerial_t *pVirtualSerial,
+                      const char *pBuffer, size_t sizeBytes);
+    void *pContext; /**< for use by the provider of the functions. */
+} uGnssVirtualSerial_t;
+
 /** The handle for the transport with types implied by
  * uGnssTransportType_t.
  */
@@ -169,6 +218,8 @@ typedef union {
     void *pAt;      /**< for transport type #U_GNSS_TRANSPORT_AT. */
     int32_t uart;   /**< for transport type #U_GNSS_TRANSPORT_UART. */
     int32_t i2c;    /**< for transport type #U_GNSS_TRANSPORT_I2C. */
+    uGnssVirtualSerial_t *pVirtualSerial; /**< for transport type
+                                               #U_GNSS_TRANSPORT_VIRTUAL_SERIAL. */
 } uGnssTransportHandle_t;
 
 /** The port type on the GNSS chip itself; this is different
@@ -49,6 +49,8 @@
 #include "u_gnss_type.h"
 #include "u_gnss.h"
 #include "u_gnss_msg.h"
+#include "u_gnss_cfg_val_key.h"
+#include "u_gnss_cfg.h"
 #include "u_gnss_private.h"
 
 /* ----------------------------------------------------------------
@@ -72,7 +74,8 @@ static const char *const gpTransportTypeText[] = {"None",       // U_GNSS_TRANSP
                                                   "AT",         // U_GNSS_TRANSPORT_AT
                                                   "I2C",        // U_GNSS_TRANSPORT_I2C
                                                   "UBX UART",   // U_GNSS_TRANSPORT_UBX_UART
-                                                  "UBX I2C"     // U_GNSS_TRANSPORT_UBX_I2C
+                                                  "UBX I2C",    // U_GNSS_TRANSPORT_UBX_I2C
+                                                  "virtual serial" // U_GNSS_TRANSPORT_VIRTUAL_SERIAL
                                                  };
 
 /* ----------------------------------------------------------------
@@ -105,6 +108,9 @@ static uGnssPrivateInstance_t *pGetGnssInstanceTransportHandle(uGnssTransportTyp
                 case U_GNSS_TRANSPORT_UBX_I2C:
                     match = (pInstance->transportHandle.i2c == transportHandle.i2c);
                     break;
+                case U_GNSS_TRANSPORT_VIRTUAL_SERIAL:
+                    match = (pInstance->transportHandle.pVirtualSerial == transportHandle.pVirtualSerial);
+                    break;
                 default:
                     break;
             }
@@ -124,6 +130,9 @@ static void addGnssInstance(uGnssPrivateInstance_t *pInstance)
 {
     pInstance->pNext = gpUGnssPrivateInstanceList;
     gpUGnssPrivateInstanceList = pInstance;
+    // Point the device instance at us so that
+    // pUGnssPrivateGetInstance() can find us directly
+    U_DEVICE_INSTANCE(pInstance->gnssHandle)->pDriverInstance = pInstance;
 }
 
 // Remove a GNSS instance from the list.
@@ -140,16 +149,32 @@ static void deleteGnssInstance(uGnssPrivateInstance_t *pInstance)
             uGnssPrivateCleanUpPosTask(pInstance);
             // Stop asynchronus message receive from happening
             uGnssPrivateStopMsgReceive(pInstance);
+            // Stop any recording, now that the fill path which
+            // tees into it is no longer running
+            uGnssPrivateRecordRemove(pInstance);
+            // Free any streamed position context, the message
+            // receiver it was using having now been stopped
+            uPortFree(pInstance->pStreamedPosition);
+            // Free any configuration cache
+            if (pInstance->pCfgCache != NULL) {
+                uPortFree(pInstance->pCfgCache->pEntry);
+                uPortFree(pInstance->pCfgCache);
+            }
+            // Free any power save duty cycle monitor and geofence
+            // callback, their message receivers having now been stopped
+            uGnssPrivatePsmRemove(pInstance);
+            uGnssPrivateGeofenceRemove(pInstance);
+            // Free any energy accounts
+            uGnssPrivateEnergyRemove(pInstance);
             if (pInstance->pLinearBuffer != NULL) {
                 // Free the streaming buffer
                 uRingBufferDelete(&(pInstance->ringBuffer));
-                uPortFree(pInstance->pLinearBuffer);
+                uPortFreeTagged(pInstance->pLinearBuffer);
             }
-            // This can go now too
-            uPortFree(pInstance->pTemporaryBuffer);
             // Delete the transport mutex
             uPortMutexDelete(pInstance->transportMutex);
             // Deallocate the uDevice instance
+            U_DEVICE_INSTANCE(pInstance->gnssHandle)->pDriverInstance = NULL;
             uDeviceDestroyInstance(U_DEVICE_INSTANCE(pInstance->gnssHandle));
             // Unlink the instance from the list
             if (pPrev != NULL) {
@@ -159,7 +184,7 @@ static void deleteGnssInstance(uGnssPrivateInstance_t *pInstance)
             }
             pCurrent = NULL;
             // Free the instance
-            uPortFree(pInstance);
+            uPortFreeTagged(pInstance);
         } else {
             pPrev = pCurrent;
             pCurrent = pPrev->pNext;
@@ -212,6 +237,23 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
                  int32_t pinGnssEnablePower,
                  bool leavePowerAlone,
                  uDeviceHandle_t *pGnssHandle)
+{
+    return uGnssAddWithBufferSize(moduleType, transportType, transportHandle,
+                                  pinGnssEnablePower, leavePowerAlone,
+                                  0, 0, pGnssHandle);
+}
+
+// Add a GNSS instance with the given buffer sizes.
+//lint -esym(1746, transportHandle) Suppress could
+// be made const: it is!
+int32_t uGnssAddWithBufferSize(uGnssModuleType_t moduleType,
+                               uGnssTransportType_t transportType,
+                               const uGnssTransportHandle_t transportHandle,
+                               int32_t pinGnssEnablePower,
+                               bool leavePowerAlone,
+                               size_t ringBufferLengthBytes,
+                               size_t readChunkLengthBytes,
+                               uDeviceHandle_t *pGnssHandle)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uGnssPrivateInstance_t *pInstance = NULL;
@@ -222,6 +264,18 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
     uPortGpioDriveMode_t pinGnssEnablePowerDriveMode;
 
     pinGnssEnablePower &= ~U_GNSS_PIN_INVERTED;
+    if (ringBufferLengthBytes == 0) {
+        ringBufferLengthBytes = U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES;
+        if (readChunkLengthBytes == 0) {
+            readChunkLengthBytes = U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES;
+        }
+    }
+    if (readChunkLengthBytes == 0) {
+        readChunkLengthBytes = ringBufferLengthBytes / 8;
+        if (readChunkLengthBytes == 0) {
+            readChunkLengthBytes = 1;
+        }
+    }
 
 #ifdef U_GNSS_PIN_ENABLE_POWER_DRIVE_MODE
     // User override
@@ -253,14 +307,24 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
             // Check parameters
             errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
             if (((size_t) moduleType < gUGnssPrivateModuleListSize) &&
+#ifdef U_CFG_GNSS_MODULE_FIXED
+                // The driver is built for this module type only
+                (moduleType == (U_CFG_GNSS_MODULE_FIXED)) &&
+#endif
                 ((transportType > U_GNSS_TRANSPORT_NONE) &&
                  (transportType < U_GNSS_TRANSPORT_MAX_NUM_WITH_UBX)) &&
+                ((transportType != U_GNSS_TRANSPORT_VIRTUAL_SERIAL) ||
+                 ((transportHandle.pVirtualSerial != NULL) &&
+                  (transportHandle.pVirtualSerial->pGetReceiveSize != NULL) &&
+                  (transportHandle.pVirtualSerial->pRead != NULL) &&
+                  (transportHandle.pVirtualSerial->pWrite != NULL))) &&
                 ((transportType == U_GNSS_TRANSPORT_I2C) ||
                  (transportType == U_GNSS_TRANSPORT_UBX_I2C) ||
                  (pGetGnssInstanceTransportHandle(transportType, transportHandle) == NULL))) {
                 errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
                 // Allocate memory for the instance
-                pInstance = (uGnssPrivateInstance_t *) pUPortMalloc(sizeof(uGnssPrivateInstance_t));
+                pInstance = (uGnssPrivateInstance_t *) pUPortMallocTagged(
+                            U_PORT_HEAP_TAG_GNSS, sizeof(uGnssPrivateInstance_t));
                 if (pInstance != NULL) {
                     // Fill the values in
                     memset(pInstance, 0, sizeof(*pInstance));
@@ -272,7 +336,7 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
                     if (errorCode == 0) {
                         pInstance->transportType = transportType;
                         pInstance->pLinearBuffer = NULL;
-                        pInstance->pTemporaryBuffer = NULL;
+                        pInstance->readChunkLengthBytes = readChunkLengthBytes;
                         pInstance->ringBufferReadHandlePrivate = -1;
                         pInstance->ringBufferReadHandleMsgReceive = -1;
                         pInstance->pModule = &(gUGnssPrivateModuleList[moduleType]);
@@ -283,6 +347,7 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
                         pInstance->pinGnssEnablePower = pinGnssEnablePower;
                         pInstance->atModulePinPwr = -1;
                         pInstance->atModulePinDataReady = -1;
+                        pInstance->pinDataReady = -1;
                         pInstance->portNumber = U_GNSS_PORT_I2C;
                         if ((transportType == U_GNSS_TRANSPORT_UART) ||
                             (transportType == U_GNSS_TRANSPORT_UBX_UART)) {
@@ -300,6 +365,9 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
                         pInstance->posMutex = NULL;
                         pInstance->posTaskFlags = 0;
                         pInstance->pMsgReceive = NULL;
+                        pInstance->pStreamedPosition = NULL;
+                        pInstance->pTimeSync = NULL;
+                        pInstance->pCfgCache = NULL;
                         pInstance->pNext = NULL;
 
                         // Now set up the pins
@@ -348,36 +416,32 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
                             // Provided we're not on AT transport, i.e. we're on
                             // a streaming transport, then set up the buffer into
                             // which we stream messages received from the module
-                            pInstance->pLinearBuffer = (char *) pUPortMalloc(U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES);
+                            pInstance->pLinearBuffer = (char *) pUPortMallocTagged(
+                                                       U_PORT_HEAP_TAG_GNSS, ringBufferLengthBytes);
                             if (pInstance->pLinearBuffer != NULL) {
-                                // Also need a temporary buffer to get stuff out
-                                // of the UART/I2C in the first place
-                                pInstance->pTemporaryBuffer = (char *) pUPortMalloc(U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES);
-                                if (pInstance->pTemporaryBuffer != NULL) {
-                                    // +2 below to keep one for ourselves and one for the
-                                    // blocking transparent receive function
-                                    errorCode = uRingBufferCreateWithReadHandle(&(pInstance->ringBuffer),
-                                                                                pInstance->pLinearBuffer,
-                                                                                U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES,
-                                                                                U_GNSS_MSG_RECEIVER_MAX_NUM + 2);
-                                    if (errorCode == 0) {
-                                        // No sneaky uRingBufferRead()'s allowed
-                                        uRingBufferSetReadRequiresHandle(&(pInstance->ringBuffer), true);
-                                        // Reserve a handle for us
+                                // +2 below to keep one for ourselves and one for the
+                                // blocking transparent receive function
+                                errorCode = uRingBufferCreateWithReadHandle(&(pInstance->ringBuffer),
+                                                                            pInstance->pLinearBuffer,
+                                                                            ringBufferLengthBytes,
+                                                                            U_GNSS_MSG_RECEIVER_MAX_NUM + 2);
+                                if (errorCode == 0) {
+                                    // No sneaky uRingBufferRead()'s allowed
+                                    uRingBufferSetReadRequiresHandle(&(pInstance->ringBuffer), true);
+                                    // Reserve a handle for us
+                                    errorCode = uRingBufferTakeReadHandle(&(pInstance->ringBuffer));
+                                    if (errorCode >= 0) {
+                                        pInstance->ringBufferReadHandlePrivate = errorCode;
+                                        // ...and one for uGnssMsgReceive()
                                         errorCode = uRingBufferTakeReadHandle(&(pInstance->ringBuffer));
                                         if (errorCode >= 0) {
-                                            pInstance->ringBufferReadHandlePrivate = errorCode;
-                                            // ...and one for uGnssMsgReceive()
-                                            errorCode = uRingBufferTakeReadHandle(&(pInstance->ringBuffer));
-                                            if (errorCode >= 0) {
-                                                pInstance->ringBufferReadHandleMsgReceive = errorCode;
-                                                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-                                            } else {
-                                                uRingBufferDelete(&(pInstance->ringBuffer));
-                                            }
+                                            pInstance->ringBufferReadHandleMsgReceive = errorCode;
+                                            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                                         } else {
                                             uRingBufferDelete(&(pInstance->ringBuffer));
                                         }
+                                    } else {
+                                        uRingBufferDelete(&(pInstance->ringBuffer));
                                     }
                                 }
                             }
@@ -393,15 +457,12 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
                         // If we hit an error, free memory again
                         if (pInstance->pLinearBuffer != NULL) {
                             uRingBufferDelete(&(pInstance->ringBuffer));
-                            uPortFree(pInstance->pLinearBuffer);
-                        }
-                        if (pInstance->pTemporaryBuffer != NULL) {
-                            uPortFree(pInstance->pTemporaryBuffer);
+                            uPortFreeTagged(pInstance->pLinearBuffer);
                         }
                         if (pInstance->transportMutex != NULL) {
                             uPortMutexDelete(pInstance->transportMutex);
                         }
-                        uPortFree(pInstance);
+                        uPortFreeTagged(pInstance);
                     }
                 }
             }
@@ -549,6 +610,82 @@ void uGnssSetAtPinDataReady(uDeviceHandle_t gnssHandle, int32_t pin)
     }
 }
 
+// Set the MCU pin that is connected to the GNSS data ready pin.
+int32_t uGnssSetPinDataReady(uDeviceHandle_t gnssHandle, int32_t pin,
+                             int32_t gnssPin)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    int32_t pinAssertedState = (pin & U_GNSS_PIN_INVERTED) ? 0 : 1;
+    uPortGpioConfig_t gpioConfig = U_PORT_GPIO_CONFIG_DEFAULT;
+    uGnssCfgVal_t cfgVal[] = {{U_GNSS_CFG_VAL_KEY_ID_TXREADY_ENABLED_L, false},
+        {U_GNSS_CFG_VAL_KEY_ID_TXREADY_POLARITY_L, 0},
+        {U_GNSS_CFG_VAL_KEY_ID_TXREADY_PIN_U1, 0},
+        {U_GNSS_CFG_VAL_KEY_ID_TXREADY_THRESHOLD_U2, U_GNSS_DATA_READY_THRESHOLD},
+        {U_GNSS_CFG_VAL_KEY_ID_TXREADY_INTERFACE_E1, U_GNSS_CFG_VAL_KEY_ITEM_VALUE_TXREADY_INTERFACE_I2C}
+    };
+    size_t numValues = sizeof(cfgVal) / sizeof(cfgVal[0]);
+
+    if (pin >= 0) {
+        pin &= ~U_GNSS_PIN_INVERTED;
+    }
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && ((pin < 0) || (gnssPin >= 0))) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if ((uGnssPrivateGetStreamType(pInstance->transportType) == U_GNSS_PRIVATE_STREAM_TYPE_I2C) &&
+                U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                if (pin >= 0) {
+                    gpioConfig.pin = pin;
+                    gpioConfig.direction = U_PORT_GPIO_DIRECTION_INPUT;
+                    errorCode = uPortGpioConfig(&gpioConfig);
+                } else {
+                    // Stop using the pin before the GNSS chip
+                    // stops driving it
+                    pInstance->pinDataReady = -1;
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+
+        if ((errorCode == 0) && (pin >= 0)) {
+            cfgVal[0].value = true;
+            cfgVal[1].value = (pinAssertedState == 0);
+            cfgVal[2].value = gnssPin;
+        } else if (errorCode == 0) {
+            // Just switch TX ready off
+            numValues = 1;
+        }
+        if (errorCode == 0) {
+            // Can't hold gUGnssPrivateMutex while doing this
+            errorCode = uGnssCfgValSetList(gnssHandle, cfgVal, numValues,
+                                           U_GNSS_CFG_VAL_TRANSACTION_NONE,
+                                           U_GNSS_CFG_VAL_LAYER_RAM);
+        }
+        if ((errorCode == 0) && (pin >= 0)) {
+
+            U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+            pInstance = pUGnssPrivateGetInstance(gnssHandle);
+            if (pInstance != NULL) {
+                pInstance->pinDataReadyAssertedState = pinAssertedState;
+                pInstance->pinDataReady = pin;
+            }
+
+            U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+        }
+    }
+
+    return errorCode;
+}
+
 // Get the maximum time to wait for a response from the GNSS chip.
 int32_t uGnssGetTimeout(uDeviceHandle_t gnssHandle)
 {
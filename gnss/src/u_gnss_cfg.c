@@ -31,7 +31,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // memcpy()
+#include "string.h"    // memcpy(), memset()
 
 #include "u_compiler.h" // U_INLINE
 #include "u_error_common.h"
@@ -67,6 +67,16 @@
 # define U_GNSS_CFG_MAX_NUM_VAL_GET_SEGMENTS 50
 #endif
 
+/** The version byte at the start of a configuration snapshot, the
+ * same as that of the body of a UBX-CFG-VALGET response, which is
+ * what the rest of the snapshot resembles.
+ */
+#define U_GNSS_CFG_SNAPSHOT_VERSION 0x01
+
+/** The size of the header of a configuration snapshot.
+ */
+#define U_GNSS_CFG_SNAPSHOT_HEADER_LENGTH_BYTES 4
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -80,6 +90,15 @@ typedef struct {
     size_t itemCount;
 } uGnssCfgValGetMessageBody_t;
 
+/** The context of a uGnssCfgValGetAsync() request.
+ */
+typedef struct {
+    uint32_t keyId;
+    int32_t encodedLayer;
+    uGnssCfgValGetCallback_t *pCallback;
+    void *pCallbackParam;
+} uGnssCfgValGetAsync_t;
+
 /* ----------------------------------------------------------------
  * STATIC VARIABLES
  * -------------------------------------------------------------- */
@@ -157,10 +176,108 @@ static int32_t setUbxCfgNav5(uDeviceHandle_t gnssHandle,
     return errorCode;
 }
 
+// Look up a value in the configuration cache.
+static bool cacheGet(uDeviceHandle_t gnssHandle, uint32_t keyId,
+                     uint64_t *pValue)
+{
+    bool found = false;
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            found = uGnssPrivateCfgCacheGet(pInstance, keyId, pValue);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return found;
+}
+
+// Put a value into the configuration cache.
+static void cacheSet(uDeviceHandle_t gnssHandle, uint32_t keyId,
+                     uint64_t value)
+{
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            uGnssPrivateCfgCacheSet(pInstance, keyId, value);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+}
+
+// Get a one-byte field of UBX-CFG-NAV5, which is equivalent to
+// the VALGET key ID keyId, from the configuration cache or,
+// failing that, from the GNSS chip.
+static int32_t getNav5Value(uDeviceHandle_t gnssHandle, uint32_t keyId,
+                            size_t offset)
+{
+    int32_t errorCodeOrValue;
+    uint64_t value;
+    // Enough room for the body of the UBX-CFG-NAV5 message
+    char message[36];
+
+    if (cacheGet(gnssHandle, keyId, &value)) {
+        errorCodeOrValue = (int32_t) value;
+    } else {
+        errorCodeOrValue = getUbxCfgNav5(gnssHandle, message);
+        if (errorCodeOrValue == 0) {
+            errorCodeOrValue = message[offset];
+            // May as well cache all of the fields we know about
+            cacheSet(gnssHandle, U_GNSS_CFG_VAL_KEY_ID_NAVSPG_DYNMODEL_E1,
+                     (uint8_t) message[2]);
+            cacheSet(gnssHandle, U_GNSS_CFG_VAL_KEY_ID_NAVSPG_FIXMODE_E1,
+                     (uint8_t) message[3]);
+            cacheSet(gnssHandle, U_GNSS_CFG_VAL_KEY_ID_NAVSPG_UTCSTANDARD_E1,
+                     (uint8_t) message[30]);
+        }
+    }
+
+    return errorCodeOrValue;
+}
+
+// Set a one-byte field of UBX-CFG-NAV5, which is equivalent to
+// the VALGET key ID keyId, unless the configuration cache shows
+// that the GNSS chip already has that value.
+static int32_t setNav5Value(uDeviceHandle_t gnssHandle, uint32_t keyId,
+                            uint16_t mask, uint8_t value, size_t offset)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    uint64_t cachedValue;
+
+    if (!cacheGet(gnssHandle, keyId, &cachedValue) || (cachedValue != value)) {
+        errorCode = setUbxCfgNav5(gnssHandle, mask, (const char *) &value,
+                                  1, offset);
+        if (errorCode == 0) {
+            cacheSet(gnssHandle, keyId, value);
+        }
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS: VALGET/VALSET/VALDEL
  * -------------------------------------------------------------- */
 
+// Return true if a key ID contains a wildcard.
+static bool keyIdIsWild(uint32_t keyId)
+{
+    return (U_GNSS_CFG_VAL_KEY_GET_GROUP_ID(keyId) == U_GNSS_CFG_VAL_KEY_GROUP_ID_ALL) ||
+           (U_GNSS_CFG_VAL_KEY_GET_ITEM_ID(keyId) == U_GNSS_CFG_VAL_KEY_ITEM_ID_ALL);
+}
+
 // Encode a layer enum into the value for a VALGET message.
 static int32_t encodeLayerForGet(uGnssCfgValLayer_t layer)
 {
@@ -213,21 +330,42 @@ static U_INLINE size_t getStorageSizeBytes(uGnssCfgValKeySize_t storageSize)
     return size;
 }
 
-// Pack a value from a configuration item into a buffer.
+// Truncate a value to the storage size of the given key ID, i.e.
+// to what the GNSS chip would store and return.
+static uint64_t truncateValue(uint32_t keyId, uint64_t value)
+{
+    size_t storageSizeBytes = getStorageSizeBytes(U_GNSS_CFG_VAL_KEY_GET_SIZE(keyId));
+
+    if (storageSizeBytes < sizeof(value)) {
+        value &= (((uint64_t) 1) << (storageSizeBytes * 8)) - 1;
+    }
+
+    return value;
+}
+
+// Pack a value from a configuration item into a buffer; the buffer
+// need not be aligned.
 static U_INLINE void packValue(char *pBuffer, const uint64_t *pValue, size_t storageSizeBytes)
 {
+    uint16_t value16;
+    uint32_t value32;
+    uint64_t value64;
+
     switch (storageSizeBytes) {
         case 1:
             *(uint8_t *) pBuffer = *((const uint8_t *) pValue);
             break;
         case 2:
-            *(uint16_t *) pBuffer = uUbxProtocolUint16Encode(*(const uint16_t *) pValue);
+            value16 = uUbxProtocolUint16Encode(*(const uint16_t *) pValue);
+            memcpy(pBuffer, &value16, sizeof(value16));
             break;
         case 4:
-            *(uint32_t *) pBuffer =  uUbxProtocolUint32Encode(*(const uint32_t *) pValue);
+            value32 = uUbxProtocolUint32Encode(*(const uint32_t *) pValue);
+            memcpy(pBuffer, &value32, sizeof(value32));
             break;
         case 8:
-            *(uint64_t *) pBuffer =  uUbxProtocolUint64Encode(*(const uint64_t *) pValue);
+            value64 = uUbxProtocolUint64Encode(*(const uint64_t *) pValue);
+            memcpy(pBuffer, &value64, sizeof(value64));
             break;
         default:
             break;
@@ -239,11 +377,13 @@ static void packMessage(const uGnssCfgVal_t *pCfgItem, size_t numValues,
                         char *pBuffer, size_t size)
 {
     size_t storageSizeBytes;
+    uint32_t keyId;
 
     for (size_t x = 0; x < numValues; x++) {
         // Store the key ID
         U_ASSERT(size >= sizeof(pCfgItem->keyId));
-        *((uint32_t *) pBuffer) = uUbxProtocolUint32Encode(pCfgItem->keyId);
+        keyId = uUbxProtocolUint32Encode(pCfgItem->keyId);
+        memcpy(pBuffer, &keyId, sizeof(keyId));
         size -= sizeof(pCfgItem->keyId);
         pBuffer += sizeof(pCfgItem->keyId);
         // Add the value
@@ -377,6 +517,8 @@ static int32_t valGetListAlloc(uDeviceHandle_t gnssHandle,
     size_t messageOutSize = 4 + (4 * numKeyIds);
     uGnssCfgValGetMessageBody_t messageIn[U_GNSS_CFG_MAX_NUM_VAL_GET_SEGMENTS] = {0};
     size_t messageInCount = 0;
+    bool cacheable = (layer == U_GNSS_CFG_VAL_LAYER_RAM);
+    uint64_t value;
 
     if (gUGnssPrivateMutex != NULL) {
 
@@ -386,11 +528,31 @@ static int32_t valGetListAlloc(uDeviceHandle_t gnssHandle,
         pInstance = pUGnssPrivateGetInstance(gnssHandle);
         if ((pInstance != NULL) && (pKeyIdList != NULL) && (numKeyIds > 0) &&
             (pList != NULL) && (encodedLayer >= 0)) {
+            // Only the current value of specific keys is cached;
+            // the results of wildcard requests are not, they
+            // would just flush out everything else
+            for (size_t x = 0; (x < numKeyIds) && cacheable; x++) {
+                cacheable = !keyIdIsWild(*(pKeyIdList + x));
+            }
             errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
             if (U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
                 errorCodeOrCount = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                if (cacheable && (numKeyIds == 1) &&
+                    uGnssPrivateCfgCacheGet(pInstance, *pKeyIdList, &value)) {
+                    // Cache hit: no need to talk to the GNSS chip
+                    *pList = (uGnssCfgVal_t *) pUPortMalloc(sizeof(uGnssCfgVal_t));
+                    if (*pList != NULL) {
+                        (*pList)->keyId = *pKeyIdList;
+                        (*pList)->value = value;
+                        errorCodeOrCount = 1;
+                    }
+                    // Skip the VALGET below
+                    messageOutSize = 0;
+                }
                 // Get memory for the body of the UBX-CFG-VALGET message
-                pMessageOut = (char *) pUPortMalloc(messageOutSize);
+                if (messageOutSize > 0) {
+                    pMessageOut = (char *) pUPortMalloc(messageOutSize);
+                }
                 if (pMessageOut != NULL) {
                     // Assemble the message
                     *pMessageOut       = 0; // Version
@@ -425,6 +587,12 @@ static int32_t valGetListAlloc(uDeviceHandle_t gnssHandle,
                     // an error code
                     if (messageInCount > 0) {
                         errorCodeOrCount = unpackMessageAlloc(messageIn, messageInCount, pList);
+                        if (cacheable) {
+                            for (int32_t x = 0; x < errorCodeOrCount; x++) {
+                                uGnssPrivateCfgCacheSet(pInstance, (*pList + x)->keyId,
+                                                        (*pList + x)->value);
+                            }
+                        }
                         // Free the memory that was allocated by the send/receive calls
                         for (size_t x = 0; x < messageInCount; x++) {
                             uPortFree(messageIn[x].pBody);
@@ -443,6 +611,145 @@ static int32_t valGetListAlloc(uDeviceHandle_t gnssHandle,
     return errorCodeOrCount;
 }
 
+// Get a list of specific configuration items using VALGET into
+// storage provided by the caller: the size of the response is known
+// from the key IDs, so the exchange is done in a buffer on the stack
+// rather than in allocated memory.
+static int32_t valGetList(uDeviceHandle_t gnssHandle,
+                          const uint32_t *pKeyIdList, size_t numKeyIds,
+                          uGnssCfgVal_t *pList,
+                          uGnssCfgValLayer_t layer)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    int32_t encodedLayer = encodeLayerForGet(layer);
+    // Room for the UBX-CFG-VALGET poll, encoded in place, and then
+    // for the body of the response, which is never shorter
+    char buffer[U_GNSS_CFG_VAL_GET_LIST_BUFFER_LENGTH_BYTES + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+    char *pBody = buffer + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES;
+    size_t responseBodySize = 4;
+    bool isWild = false;
+    const char *pCfgData;
+    size_t size;
+    int32_t count = 0;
+    int32_t y;
+    uint32_t keyId;
+    uint64_t value;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pKeyIdList != NULL) && (numKeyIds > 0) &&
+            (numKeyIds <= U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES) &&
+            (pList != NULL) && (encodedLayer >= 0)) {
+            for (size_t x = 0; (x < numKeyIds) && !isWild; x++) {
+                isWild = keyIdIsWild(*(pKeyIdList + x));
+                responseBodySize += U_GNSS_CFG_VAL_KEY_ITEM_LENGTH_BYTES(*(pKeyIdList + x));
+            }
+            errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (!isWild && U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
+                errorCodeOrCount = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                if ((layer == U_GNSS_CFG_VAL_LAYER_RAM) && (numKeyIds == 1) &&
+                    uGnssPrivateCfgCacheGet(pInstance, *pKeyIdList, &value)) {
+                    // Cache hit: no need to talk to the GNSS chip
+                    pList->keyId = *pKeyIdList;
+                    pList->value = value;
+                    errorCodeOrCount = 1;
+                } else if (responseBodySize <= U_GNSS_CFG_VAL_GET_LIST_BUFFER_LENGTH_BYTES) {
+                    // Assemble the poll: version zero, the layer,
+                    // position zero, then the key IDs
+                    memset(pBody, 0, 4);
+                    *(pBody + 1) = (char) encodedLayer;
+                    for (size_t x = 0; x < numKeyIds; x++) {
+                        keyId = uUbxProtocolUint32Encode(*(pKeyIdList + x));
+                        memcpy(pBody + 4 + (x << 2), &keyId, sizeof(keyId));
+                    }
+                    errorCodeOrCount = uGnssPrivateSendReceiveUbxMessageInPlace(pInstance,
+                                                                                0x06, 0x8b,
+                                                                                buffer,
+                                                                                4 + (numKeyIds << 2),
+                                                                                buffer,
+                                                                                U_GNSS_CFG_VAL_GET_LIST_BUFFER_LENGTH_BYTES);
+                    if (errorCodeOrCount >= 0) {
+                        size = (size_t) errorCodeOrCount;
+                        errorCodeOrCount = (int32_t) U_ERROR_COMMON_UNKNOWN;
+                        // Check the version and size of the response
+                        if ((size == responseBodySize) && (*buffer == 0x01)) {
+                            // Skip to the configuration data and unpack it
+                            pCfgData = buffer + 4;
+                            size -= 4;
+                            do {
+                                y = (int32_t) unpackItem(pCfgData, size, &value);
+                                if (y > 0) {
+                                    (pList + count)->keyId = uUbxProtocolUint32Decode(pCfgData);
+                                    (pList + count)->value = value;
+                                    if (layer == U_GNSS_CFG_VAL_LAYER_RAM) {
+                                        uGnssPrivateCfgCacheSet(pInstance, (pList + count)->keyId,
+                                                                value);
+                                    }
+                                    count++;
+                                }
+                                pCfgData += y;
+                                size -= y;
+                            } while ((y > 0) && (count < (int32_t) numKeyIds));
+                            errorCodeOrCount = count;
+                        }
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCodeOrCount;
+}
+
+// The one-shot message receive callback for uGnssCfgValGetAsync().
+static bool valGetAsyncCallback(uDeviceHandle_t gnssHandle,
+                                const uGnssMessageId_t *pMessageId,
+                                int32_t errorCodeOrLength,
+                                void *pCallbackParam)
+{
+    uGnssCfgValGetAsync_t *pContext = (uGnssCfgValGetAsync_t *) pCallbackParam;
+    bool done = true;
+    uint64_t value = 0;
+    size_t storageSizeBytes = getStorageSizeBytes(U_GNSS_CFG_VAL_KEY_GET_SIZE(pContext->keyId));
+    // Room for a UBX-CFG-VALGET response containing a single item
+    char buffer[U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES + 4 + 4 + 8];
+    const char *pBody = buffer + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES;
+
+    (void) pMessageId;
+
+    if (errorCodeOrLength > 0) {
+        // Only if the response is of the length for our single key,
+        // in our layer, with our key in it, is it ours: otherwise
+        // it is the response to someone else's request
+        done = false;
+        if ((errorCodeOrLength == (int32_t) (U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES +
+                                             4 + 4 + storageSizeBytes)) &&
+            (uGnssMsgReceiveCallbackRead(gnssHandle, buffer,
+                                         sizeof(buffer)) == errorCodeOrLength) &&
+            (*pBody == 0x01) && (*(pBody + 1) == (char) pContext->encodedLayer) &&
+            (uUbxProtocolUint32Decode(pBody + 4) == pContext->keyId)) {
+            unpackItem(pBody + 4, 4 + storageSizeBytes, &value);
+            errorCodeOrLength = (int32_t) U_ERROR_COMMON_SUCCESS;
+            done = true;
+        }
+    }
+
+    if (done) {
+        pContext->pCallback(gnssHandle, errorCodeOrLength, pContext->keyId,
+                            value, pContext->pCallbackParam);
+        uPortFree(pContext);
+    }
+
+    return done;
+}
+
 // Set a list of configuration items using VALSET.
 static int32_t valSetList(uDeviceHandle_t gnssHandle,
                           const uGnssCfgVal_t *pList, size_t numValues,
@@ -451,8 +758,11 @@ static int32_t valSetList(uDeviceHandle_t gnssHandle,
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uGnssPrivateInstance_t *pInstance;
-    char *pMessage = NULL;
+    char *pBuffer = NULL;
+    char *pMessage;
     size_t messageSize = 4 + (4 * numValues);
+    bool unchanged = false;
+    uint64_t value;
 
     if (gUGnssPrivateMutex != NULL) {
 
@@ -466,7 +776,20 @@ static int32_t valSetList(uDeviceHandle_t gnssHandle,
             ((numValues == 0) ||
              ((layers > 0) && ((layers & ~U_GNSS_CFG_VAL_LAYER_DEFAULT) == 0)))) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
-            if (U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
+            if ((pInstance->pCfgCache != NULL) && (numValues > 0) &&
+                (transaction == U_GNSS_CFG_VAL_TRANSACTION_NONE) &&
+                (layers == U_GNSS_CFG_VAL_LAYER_RAM)) {
+                // If the cache says that all of the values are already
+                // set in RAM then there is nothing to do
+                unchanged = true;
+                for (size_t x = 0; (x < numValues) && unchanged; x++) {
+                    unchanged = uGnssPrivateCfgCacheGet(pInstance, (pList + x)->keyId, &value) &&
+                                (value == truncateValue((pList + x)->keyId, (pList + x)->value));
+                }
+            }
+            if (unchanged) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            } else if (U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
                 errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
                 // Work out how much memory we need for the message;
                 // we already have the overhead and the amount per key ID,
@@ -474,9 +797,12 @@ static int32_t valSetList(uDeviceHandle_t gnssHandle,
                 for (size_t x = 0; x < numValues; x++) {
                     messageSize += getStorageSizeBytes(U_GNSS_CFG_VAL_KEY_GET_SIZE((pList + x)->keyId));
                 }
-                // Get memory for the body of the UBX-CFG-VALSET message
-                pMessage = (char *) pUPortMalloc(messageSize);
-                if (pMessage != NULL) {
+                // Get memory for the whole UBX-CFG-VALSET message, the
+                // body being assembled after room for the UBX header
+                // so that it can be encoded in place
+                pBuffer = (char *) pUPortMalloc(messageSize + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+                if (pBuffer != NULL) {
+                    pMessage = pBuffer + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES;
                     // Assemble the message
                     *pMessage       = 0; // Version
                     *(pMessage + 1) = layers;
@@ -485,10 +811,25 @@ static int32_t valSetList(uDeviceHandle_t gnssHandle,
                     // Add the values
                     packMessage(pList, numValues, pMessage + 4, messageSize - 4);
                     // Send them all off
-                    errorCode = uGnssPrivateSendUbxMessage(pInstance, 0x06, 0x8a,
-                                                           pMessage, messageSize);
+                    errorCode = uGnssPrivateSendUbxMessageInPlace(pInstance, 0x06, 0x8a,
+                                                                  pBuffer, messageSize);
+                    if (layers & U_GNSS_CFG_VAL_LAYER_RAM) {
+                        // Keep the cache in step with RAM; values that
+                        // are part of a transaction are not applied until
+                        // it is executed so just forget about those
+                        for (size_t x = 0; x < numValues; x++) {
+                            if ((errorCode == 0) &&
+                                (transaction == U_GNSS_CFG_VAL_TRANSACTION_NONE)) {
+                                uGnssPrivateCfgCacheSet(pInstance, (pList + x)->keyId,
+                                                        truncateValue((pList + x)->keyId,
+                                                                      (pList + x)->value));
+                            } else {
+                                uGnssPrivateCfgCacheDelete(pInstance, (pList + x)->keyId);
+                            }
+                        }
+                    }
                     // Free memory
-                    uPortFree(pMessage);
+                    uPortFree(pBuffer);
                 }
             }
         }
@@ -499,6 +840,48 @@ static int32_t valSetList(uDeviceHandle_t gnssHandle,
     return errorCode;
 }
 
+// Set a list of configuration items using VALSET, splitting the
+// list across as many VALSET messages as necessary, sent as one
+// transaction, if it is too long to fit into one.
+static int32_t valSetListChunked(uDeviceHandle_t gnssHandle,
+                                 const uGnssCfgVal_t *pList, size_t numValues,
+                                 uGnssCfgValTransaction_t transaction,
+                                 int32_t layers)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    size_t numThisTime;
+
+    if ((transaction != U_GNSS_CFG_VAL_TRANSACTION_NONE) ||
+        (numValues <= U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES)) {
+        // No need to chunk or the caller is managing the transaction
+        errorCode = valSetList(gnssHandle, pList, numValues, transaction, layers);
+    } else if (pList != NULL) {
+        transaction = U_GNSS_CFG_VAL_TRANSACTION_BEGIN;
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        while ((numValues > 0) && (errorCode == 0)) {
+            numThisTime = numValues;
+            if (numThisTime > U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES) {
+                numThisTime = U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES;
+            }
+            if (numThisTime == numValues) {
+                // The last one applies the lot
+                transaction = U_GNSS_CFG_VAL_TRANSACTION_EXCUTE;
+            }
+            errorCode = valSetList(gnssHandle, pList, numThisTime, transaction, layers);
+            transaction = U_GNSS_CFG_VAL_TRANSACTION_CONTINUE;
+            pList += numThisTime;
+            numValues -= numThisTime;
+        }
+        if (errorCode != 0) {
+            // A transactionless VALSET with no values cancels
+            // the transaction we have started in the GNSS chip
+            valSetList(gnssHandle, NULL, 0, U_GNSS_CFG_VAL_TRANSACTION_NONE, layers);
+        }
+    }
+
+    return errorCode;
+}
+
 // Delete a list of configuration items using VALDEL.
 static int32_t valDelList(uDeviceHandle_t gnssHandle,
                           const uint32_t *pKeyIdList, size_t numKeyIds,
@@ -507,9 +890,10 @@ static int32_t valDelList(uDeviceHandle_t gnssHandle,
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uGnssPrivateInstance_t *pInstance;
-    char *pMessage = NULL;
+    char *pBuffer = NULL;
+    char *pMessage;
     int32_t messageSize = 4 + (4 * numKeyIds);
-    uint32_t *pUintBuffer;
+    uint32_t keyId;
 
     if (gUGnssPrivateMutex != NULL) {
 
@@ -526,26 +910,29 @@ static int32_t valDelList(uDeviceHandle_t gnssHandle,
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
             if (U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
                 errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-                // Get memory for the body of the UBX-CFG-VALDEL message
-                pMessage = pUPortMalloc(messageSize);
-                if (pMessage != NULL) {
+                // Get memory for the whole UBX-CFG-VALDEL message, the
+                // body being assembled after room for the UBX header
+                // so that it can be encoded in place
+                pBuffer = (char *) pUPortMalloc(messageSize + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+                if (pBuffer != NULL) {
+                    pMessage = pBuffer + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES;
                     // Assemble the message
                     *pMessage       = 0x01; // Version
                     *(pMessage + 1) = layers;
                     *(pMessage + 2) = transaction;
                     *(pMessage + 3) = 0; // Reserved
-                    // Add the key IDs
-                    pUintBuffer = (uint32_t *) (pMessage + 4);
+                    // Add the key IDs; the body is no longer 32-bit
+                    // aligned so these are copied in rather than written
                     for (size_t x = 0; x < numKeyIds; x++) {
-                        *pUintBuffer = uUbxProtocolUint32Encode(*pKeyIdList);
+                        keyId = uUbxProtocolUint32Encode(*pKeyIdList);
+                        memcpy(pMessage + 4 + (x << 2), &keyId, sizeof(keyId));
                         pKeyIdList++;
-                        pUintBuffer++;
                     }
                     // Send them all off
-                    errorCode = uGnssPrivateSendUbxMessage(pInstance, 0x06, 0x8c,
-                                                           pMessage, messageSize);
+                    errorCode = uGnssPrivateSendUbxMessageInPlace(pInstance, 0x06, 0x8c,
+                                                                  pBuffer, messageSize);
                     // Free memory
-                    uPortFree(pMessage);
+                    uPortFree(pBuffer);
                 }
             }
         }
@@ -557,83 +944,128 @@ static int32_t valDelList(uDeviceHandle_t gnssHandle,
 }
 
 /* ----------------------------------------------------------------
- * PUBLIC FUNCTIONS: SPECIFIC CONFIGURATION FUNCTIONS
+ * STATIC FUNCTIONS: SNAPSHOT
  * -------------------------------------------------------------- */
 
-// Get the dynamic platform model from the GNSS chip.
-int32_t uGnssCfgGetDynamic(uDeviceHandle_t gnssHandle)
+// Unpack the items of a configuration snapshot into pList, which may
+// be NULL to just count them; returns the number of items or
+// negative error code if the snapshot is not properly formed.
+static int32_t snapshotUnpack(const char *pBlob, size_t size,
+                              uGnssCfgVal_t *pList)
 {
-    int32_t errorCodeOrDynamic;
-    // Enough room for the body of the UBX-CFG-NAV5 message
-    char message[36];
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int32_t count = 0;
+    size_t y;
+    uint64_t value = 0;
+
+    if ((size >= U_GNSS_CFG_SNAPSHOT_HEADER_LENGTH_BYTES) &&
+        (*pBlob == U_GNSS_CFG_SNAPSHOT_VERSION)) {
+        pBlob += U_GNSS_CFG_SNAPSHOT_HEADER_LENGTH_BYTES;
+        size -= U_GNSS_CFG_SNAPSHOT_HEADER_LENGTH_BYTES;
+        do {
+            y = unpackItem(pBlob, size, &value);
+            if ((y > 0) && (pList != NULL)) {
+                (pList + count)->keyId = uUbxProtocolUint32Decode(pBlob);
+                (pList + count)->value = value;
+            }
+            if (y > 0) {
+                count++;
+            }
+            pBlob += y;
+            size -= y;
+        } while (y > 0);
+        // Anything left over means that the snapshot is corrupt
+        if (size == 0) {
+            errorCodeOrCount = count;
+        }
+    }
+
+    return errorCodeOrCount;
+}
+
+// Compare the values of up to U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES
+// items in pList with those in the given layer of the GNSS chip,
+// setting pChanged for each that differs or is not present.
+static void snapshotDiff(uDeviceHandle_t gnssHandle,
+                         const uGnssCfgVal_t *pList, size_t numValues,
+                         uGnssCfgValLayer_t layer, bool *pChanged)
+{
+    uint32_t keyId[U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES];
+    uGnssCfgVal_t *pCurrent = NULL;
+    int32_t numCurrent;
+    bool found;
 
-    errorCodeOrDynamic = getUbxCfgNav5(gnssHandle, message);
-    if (errorCodeOrDynamic == 0) {
-        // The dynamic platform model is at offset 2
-        errorCodeOrDynamic = message[2];
+    U_ASSERT(numValues <= U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES);
+
+    for (size_t x = 0; x < numValues; x++) {
+        keyId[x] = (pList + x)->keyId;
     }
+    // If none of the keys are present in a layer the GNSS chip NACKs
+    // the request: either way, anything not read back is changed
+    numCurrent = valGetListAlloc(gnssHandle, keyId, numValues, &pCurrent, layer);
+    for (size_t x = 0; x < numValues; x++) {
+        found = false;
+        for (int32_t y = 0; (y < numCurrent) && !found; y++) {
+            found = ((pCurrent + y)->keyId == (pList + x)->keyId) &&
+                    ((pCurrent + y)->value == (pList + x)->value);
+        }
+        if (!found) {
+            *(pChanged + x) = true;
+        }
+    }
+    if (numCurrent > 0) {
+        uPortFree(pCurrent);
+    }
+}
 
-    return errorCodeOrDynamic;
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: SPECIFIC CONFIGURATION FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Get the dynamic platform model from the GNSS chip.
+int32_t uGnssCfgGetDynamic(uDeviceHandle_t gnssHandle)
+{
+    // The dynamic platform model is at offset 2
+    return getNav5Value(gnssHandle, U_GNSS_CFG_VAL_KEY_ID_NAVSPG_DYNMODEL_E1, 2);
 }
 
 // Set the dynamic platform model of the GNSS chip.
 int32_t uGnssCfgSetDynamic(uDeviceHandle_t gnssHandle, uGnssDynamic_t dynamic)
 {
-    return setUbxCfgNav5(gnssHandle,
-                         0x01, /* Mask for dynamic model */
-                         (char *) &dynamic,
-                         1, 2 /* One byte at offset 2 */);
+    return setNav5Value(gnssHandle, U_GNSS_CFG_VAL_KEY_ID_NAVSPG_DYNMODEL_E1,
+                        0x01, /* Mask for dynamic model */
+                        (uint8_t) dynamic, 2 /* One byte at offset 2 */);
 }
 
 // Get the fix mode from the GNSS chip.
 int32_t uGnssCfgGetFixMode(uDeviceHandle_t gnssHandle)
 {
-    int32_t errorCodeOrFixMode;
-    // Enough room for the body of the UBX-CFG-NAV5 message
-    char message[36];
-
-    errorCodeOrFixMode = getUbxCfgNav5(gnssHandle, message);
-    if (errorCodeOrFixMode == 0) {
-        // The fix mode is at offset 3
-        errorCodeOrFixMode = message[3];
-    }
-
-    return errorCodeOrFixMode;
+    // The fix mode is at offset 3
+    return getNav5Value(gnssHandle, U_GNSS_CFG_VAL_KEY_ID_NAVSPG_FIXMODE_E1, 3);
 }
 
 // Set the fix mode of the GNSS chip.
 int32_t uGnssCfgSetFixMode(uDeviceHandle_t gnssHandle, uGnssFixMode_t fixMode)
 {
-    return setUbxCfgNav5(gnssHandle,
-                         0x04, /* Mask for fix mode */
-                         (char *) &fixMode,
-                         1, 3 /* One byte at offset 3 */);
+    return setNav5Value(gnssHandle, U_GNSS_CFG_VAL_KEY_ID_NAVSPG_FIXMODE_E1,
+                        0x04, /* Mask for fix mode */
+                        (uint8_t) fixMode, 3 /* One byte at offset 3 */);
 }
 
 // Get the UTC standard from the GNSS chip.
 int32_t uGnssCfgGetUtcStandard(uDeviceHandle_t gnssHandle)
 {
-    int32_t errorCodeOrUtcStandard;
-    // Enough room for the body of the UBX-CFG-NAV5 message
-    char message[36];
-
-    errorCodeOrUtcStandard = getUbxCfgNav5(gnssHandle, message);
-    if (errorCodeOrUtcStandard == 0) {
-        // The UTC standard is at offset 30
-        errorCodeOrUtcStandard = message[30];
-    }
-
-    return errorCodeOrUtcStandard;
+    // The UTC standard is at offset 30
+    return getNav5Value(gnssHandle, U_GNSS_CFG_VAL_KEY_ID_NAVSPG_UTCSTANDARD_E1, 30);
 }
 
 // Set the UTC standard of the GNSS chip.
 int32_t uGnssCfgSetUtcStandard(uDeviceHandle_t gnssHandle,
                                uGnssUtcStandard_t utcStandard)
 {
-    return setUbxCfgNav5(gnssHandle,
-                         0x0400, /* Mask for UTC standard */
-                         (char *) &utcStandard,
-                         1, 30 /* One byte at offset 30 */);
+    return setNav5Value(gnssHandle, U_GNSS_CFG_VAL_KEY_ID_NAVSPG_UTCSTANDARD_E1,
+                        0x0400, /* Mask for UTC standard */
+                        (uint8_t) utcStandard, 30 /* One byte at offset 30 */);
 }
 
 // Get the protocol types output by the GNSS chip.
@@ -648,7 +1080,19 @@ int32_t uGnssCfgGetProtocolOut(uDeviceHandle_t gnssHandle)
 
         pInstance = pUGnssPrivateGetInstance(gnssHandle);
         if (pInstance != NULL) {
-            errorCodeOrBitMap = uGnssPrivateGetProtocolOut(pInstance);
+            if ((pInstance->pCfgCache != NULL) &&
+                (pInstance->pCfgCache->protocolOut >= 0)) {
+                errorCodeOrBitMap = pInstance->pCfgCache->protocolOut;
+                pInstance->pCfgCache->hits++;
+            } else {
+                errorCodeOrBitMap = uGnssPrivateGetProtocolOut(pInstance);
+                if (pInstance->pCfgCache != NULL) {
+                    pInstance->pCfgCache->misses++;
+                    if (errorCodeOrBitMap >= 0) {
+                        pInstance->pCfgCache->protocolOut = errorCodeOrBitMap;
+                    }
+                }
+            }
         }
 
         U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
@@ -674,6 +1118,80 @@ int32_t uGnssCfgSetProtocolOut(uDeviceHandle_t gnssHandle,
             errorCode = uGnssPrivateSetProtocolOut(pInstance,
                                                    protocol,
                                                    onNotOff);
+            // This may change any number of port configuration values
+            uGnssPrivateCfgCacheInvalidate(pInstance);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Set the baud rate of the UART of the GNSS chip.
+int32_t uGnssCfgSetUartBaudRate(uDeviceHandle_t gnssHandle,
+                                int32_t baudRate, bool persist)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    // Message buffer big enough for a UBX-CFG-PRT message, which
+    // is larger than our single-value UBX-CFG-VALSET message
+    char message[20] = {0};
+    uint32_t value;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (baudRate > 0)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if ((pInstance->transportType == U_GNSS_TRANSPORT_UART) ||
+                (pInstance->transportType == U_GNSS_TRANSPORT_UBX_UART)) {
+                if (U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
+                    // UBX-CFG-VALSET with the one value CFG-UART1-BAUDRATE;
+                    // this is sent without waiting for an ack since the ack
+                    // would be sent at the new baud rate
+                    message[0] = 0; // Version
+                    message[1] = U_GNSS_CFG_VAL_LAYER_RAM;
+                    if (persist) {
+                        message[1] |= U_GNSS_CFG_VAL_LAYER_BBRAM;
+                    }
+                    value = uUbxProtocolUint32Encode(U_GNSS_CFG_VAL_KEY_ID_UART1_BAUDRATE_U4);
+                    memcpy(message + 4, &value, sizeof(value));
+                    value = uUbxProtocolUint32Encode((uint32_t) baudRate);
+                    memcpy(message + 8, &value, sizeof(value));
+                    errorCode = uGnssPrivateSendOnlyStreamUbxMessage(pInstance,
+                                                                     0x06, 0x8a,
+                                                                     message, 12);
+                } else {
+                    errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+                    // Poll UBX-CFG-PRT for the port we are connected on,
+                    // modify the baud rate at offset 8 and send it back,
+                    // again not waiting for an ack
+                    message[0] = (char) pInstance->portNumber;
+                    if (uGnssPrivateSendReceiveUbxMessage(pInstance,
+                                                          0x06, 0x00,
+                                                          message, 1,
+                                                          message,
+                                                          sizeof(message)) == sizeof(message)) {
+                        value = uUbxProtocolUint32Encode((uint32_t) baudRate);
+                        memcpy(message + 8, &value, sizeof(value));
+                        errorCode = uGnssPrivateSendOnlyStreamUbxMessage(pInstance,
+                                                                         0x06, 0x00,
+                                                                         message,
+                                                                         sizeof(message));
+                    }
+                }
+                if (errorCode > 0) {
+                    // Give the GNSS chip time to switch over
+                    uPortTaskBlock(U_GNSS_CFG_UART_BAUD_RATE_CHANGE_DELAY_MS);
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                }
+                // The port configuration is no longer what we knew
+                uGnssPrivateCfgCacheInvalidate(pInstance);
+            }
         }
 
         U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
@@ -692,25 +1210,106 @@ int32_t uGnssCfgValGet(uDeviceHandle_t gnssHandle, uint32_t keyId,
                        uGnssCfgValLayer_t layer)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-    uGnssCfgVal_t *pList = NULL;
+    uGnssCfgVal_t cfgVal;
     size_t storageSizeBytes;
 
-    if ((U_GNSS_CFG_VAL_KEY_GET_GROUP_ID(keyId) != U_GNSS_CFG_VAL_KEY_GROUP_ID_ALL) &&
-        (U_GNSS_CFG_VAL_KEY_GET_ITEM_ID(keyId) != U_GNSS_CFG_VAL_KEY_ITEM_ID_ALL) &&
-        ((pValue != NULL) || (size == 0))) {
-        errorCode = valGetListAlloc(gnssHandle, &keyId, 1, &pList, layer);
+    if (!keyIdIsWild(keyId) && ((pValue != NULL) || (size == 0))) {
+        errorCode = valGetList(gnssHandle, &keyId, 1, &cfgVal, layer);
         if (errorCode > 0) {
             errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-            storageSizeBytes = getStorageSizeBytes(U_GNSS_CFG_VAL_KEY_GET_SIZE(keyId));
+            storageSizeBytes = U_GNSS_CFG_VAL_KEY_SIZE_BYTES(keyId);
             if ((pValue == NULL) || (size >= storageSizeBytes)) {
                 errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                 if (pValue != NULL) {
-                    memcpy(pValue, &(pList->value), storageSizeBytes);
+                    memcpy(pValue, &(cfgVal.value), storageSizeBytes);
                 }
             }
         }
-        // Free memory
-        uPortFree(pList);
+    }
+
+    return errorCode;
+}
+
+// Get the value of a single configuration item without blocking.
+int32_t uGnssCfgValGetAsync(uDeviceHandle_t gnssHandle, uint32_t keyId,
+                            uGnssCfgValLayer_t layer,
+                            uGnssCfgValGetCallback_t *pCallback,
+                            void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    int32_t encodedLayer = encodeLayerForGet(layer);
+    uGnssCfgValGetAsync_t *pContext = NULL;
+    int32_t timeoutMs = 0;
+    uGnssMessageId_t messageId = {0};
+    int32_t asyncHandle;
+    // Version, layer, position and a single key ID
+    char message[4 + 4] = {0};
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && !keyIdIsWild(keyId) &&
+            (encodedLayer >= 0) && (pCallback != NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX) &&
+                (uGnssPrivateGetStreamType(pInstance->transportType) >= 0)) {
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                pContext = (uGnssCfgValGetAsync_t *) pUPortMalloc(sizeof(*pContext));
+                if (pContext != NULL) {
+                    pContext->keyId = keyId;
+                    pContext->encodedLayer = encodedLayer;
+                    pContext->pCallback = pCallback;
+                    pContext->pCallbackParam = pCallbackParam;
+                    timeoutMs = pInstance->timeoutMs;
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+
+        if (pContext != NULL) {
+            // Set up to catch the response before sending the poll;
+            // the one-shot reader locks gUGnssPrivateMutex itself
+            messageId.type = U_GNSS_PROTOCOL_UBX;
+            messageId.id.ubx = 0x068b;
+            asyncHandle = uGnssMsgReceiveStartOneShot(gnssHandle, &messageId,
+                                                      valGetAsyncCallback,
+                                                      pContext, timeoutMs);
+            errorCode = asyncHandle;
+            if (asyncHandle >= 0) {
+
+                U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+                errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+                pInstance = pUGnssPrivateGetInstance(gnssHandle);
+                if (pInstance != NULL) {
+                    // Version zero, the layer, position zero, the key ID
+                    message[1] = (char) encodedLayer;
+                    *((uint32_t *) (message + 4)) = uUbxProtocolUint32Encode(keyId);
+                    errorCode = uGnssPrivateSendOnlyStreamUbxMessage(pInstance,
+                                                                     0x06, 0x8b,
+                                                                     message,
+                                                                     sizeof(message));
+                }
+
+                U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+
+                if (errorCode >= 0) {
+                    // pContext now belongs to valGetAsyncCallback()
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    pContext = NULL;
+                } else if (uGnssMsgReceiveStop(gnssHandle, asyncHandle) != 0) {
+                    // Too late, the reader has already been and gone
+                    // and has freed pContext
+                    pContext = NULL;
+                }
+            }
+            uPortFree(pContext);
+        }
     }
 
     return errorCode;
@@ -733,6 +1332,16 @@ int32_t uGnssCfgValGetListAlloc(uDeviceHandle_t gnssHandle,
     return valGetListAlloc(gnssHandle, pKeyIdList, numKeyIds, pList, layer);
 }
 
+// Get the value of a list of specific configuration items without
+// allocating memory.
+int32_t uGnssCfgValGetList(uDeviceHandle_t gnssHandle,
+                           const uint32_t *pKeyIdList, size_t numKeyIds,
+                           uGnssCfgVal_t *pList,
+                           uGnssCfgValLayer_t layer)
+{
+    return valGetList(gnssHandle, pKeyIdList, numKeyIds, pList, layer);
+}
+
 // Set the value of a configuration item.
 int32_t uGnssCfgValSet(uDeviceHandle_t gnssHandle,
                        uint32_t keyId, uint64_t value,
@@ -753,7 +1362,7 @@ int32_t uGnssCfgValSetList(uDeviceHandle_t gnssHandle,
                            uGnssCfgValTransaction_t transaction,
                            uint32_t layers)
 {
-    return valSetList(gnssHandle, pList, numValues, transaction, layers);
+    return valSetListChunked(gnssHandle, pList, numValues, transaction, layers);
 }
 
 // Delete a configuration item.
@@ -805,4 +1414,303 @@ int32_t uGnssCfgValDelListX(uDeviceHandle_t gnssHandle,
     return errorCode;
 }
 
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: BATCHED CONFIGURATION USING VALSET
+ * -------------------------------------------------------------- */
+
+// Begin a batch of configuration values.
+int32_t uGnssCfgValBatchBegin(uGnssCfgValBatch_t *pBatch,
+                              uGnssCfgVal_t *pStorage,
+                              size_t maxNumValues,
+                              uint32_t layers)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pBatch != NULL) && (pStorage != NULL) && (maxNumValues > 0)) {
+        pBatch->pList = pStorage;
+        pBatch->maxNumValues = maxNumValues;
+        pBatch->numValues = 0;
+        pBatch->layers = layers;
+        pBatch->errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Add a value to a batch.
+int32_t uGnssCfgValBatchAdd(uGnssCfgValBatch_t *pBatch,
+                            uint32_t keyId, uint64_t value)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssCfgVal_t *pCfgVal = NULL;
+
+    if ((pBatch != NULL) && (pBatch->pList != NULL)) {
+        // Replace the value if the key is already there
+        for (size_t x = 0; (x < pBatch->numValues) && (pCfgVal == NULL); x++) {
+            if ((pBatch->pList + x)->keyId == keyId) {
+                pCfgVal = pBatch->pList + x;
+            }
+        }
+        if ((pCfgVal == NULL) && (pBatch->numValues < pBatch->maxNumValues)) {
+            pCfgVal = pBatch->pList + pBatch->numValues;
+            pCfgVal->keyId = keyId;
+            pBatch->numValues++;
+        }
+        if (pCfgVal != NULL) {
+            pCfgVal->value = value;
+            errorCodeOrCount = (int32_t) pBatch->numValues;
+        } else {
+            errorCodeOrCount = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            if (pBatch->errorCode == 0) {
+                pBatch->errorCode = errorCodeOrCount;
+            }
+        }
+    }
+
+    return errorCodeOrCount;
+}
+
+// Send a batch of values to the GNSS chip.
+int32_t uGnssCfgValBatchCommit(uDeviceHandle_t gnssHandle,
+                               uGnssCfgValBatch_t *pBatch)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pBatch != NULL) && (pBatch->pList != NULL)) {
+        errorCode = pBatch->errorCode;
+        if ((errorCode == 0) && (pBatch->numValues > 0)) {
+            errorCode = valSetListChunked(gnssHandle, pBatch->pList,
+                                          pBatch->numValues,
+                                          U_GNSS_CFG_VAL_TRANSACTION_NONE,
+                                          (int32_t) pBatch->layers);
+        }
+        pBatch->numValues = 0;
+        pBatch->errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: CONFIGURATION SNAPSHOT
+ * -------------------------------------------------------------- */
+
+// Take a snapshot of the configuration.
+int32_t uGnssCfgSnapshot(uDeviceHandle_t gnssHandle,
+                         const uint32_t *pKeyIdList, size_t numKeyIds,
+                         char **ppBlob, uGnssCfgValLayer_t layer)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uint32_t keyIdAll = U_GNSS_CFG_VAL_KEY(U_GNSS_CFG_VAL_KEY_GROUP_ID_ALL,
+                                           U_GNSS_CFG_VAL_KEY_ITEM_ID_ALL, 0);
+    uGnssCfgVal_t *pList = NULL;
+    int32_t numValues;
+    size_t size = U_GNSS_CFG_SNAPSHOT_HEADER_LENGTH_BYTES;
+
+    if (ppBlob != NULL) {
+        if (pKeyIdList == NULL) {
+            pKeyIdList = &keyIdAll;
+            numKeyIds = 1;
+        }
+        numValues = valGetListAlloc(gnssHandle, pKeyIdList, numKeyIds, &pList, layer);
+        errorCodeOrSize = numValues;
+        if (numValues > 0) {
+            for (int32_t x = 0; x < numValues; x++) {
+                size += U_GNSS_CFG_VAL_KEY_ITEM_LENGTH_BYTES((pList + x)->keyId);
+            }
+            errorCodeOrSize = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            *ppBlob = (char *) pUPortMalloc(size);
+            if (*ppBlob != NULL) {
+                **ppBlob = U_GNSS_CFG_SNAPSHOT_VERSION;
+                *(*ppBlob + 1) = (char) layer;
+                *(*ppBlob + 2) = 0; // Reserved
+                *(*ppBlob + 3) = 0; // Reserved
+                packMessage(pList, numValues,
+                            *ppBlob + U_GNSS_CFG_SNAPSHOT_HEADER_LENGTH_BYTES,
+                            size - U_GNSS_CFG_SNAPSHOT_HEADER_LENGTH_BYTES);
+                errorCodeOrSize = (int32_t) size;
+            }
+            uPortFree(pList);
+        }
+    }
+
+    return errorCodeOrSize;
+}
+
+// Apply a snapshot of the configuration.
+int32_t uGnssCfgRestore(uDeviceHandle_t gnssHandle,
+                        const char *pBlob, size_t size,
+                        uint32_t layers)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssCfgVal_t *pList;
+    int32_t numValues = 0;
+    size_t numChanged = 0;
+    size_t numThisTime;
+    bool changed[U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES];
+    uint32_t layer;
+
+    if ((pBlob != NULL) && (layers > 0) &&
+        ((layers & ~U_GNSS_CFG_VAL_LAYER_DEFAULT) == 0)) {
+        numValues = snapshotUnpack(pBlob, size, NULL);
+        errorCodeOrCount = numValues;
+    }
+    if (numValues > 0) {
+        errorCodeOrCount = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pList = (uGnssCfgVal_t *) pUPortMalloc(numValues * sizeof(uGnssCfgVal_t));
+        if (pList != NULL) {
+            snapshotUnpack(pBlob, size, pList);
+            // Work through the list a VALGET's worth at a time, moving
+            // the values that need to be written down to the start
+            // of the list, which is then sent with as few VALSETs
+            // as possible
+            for (size_t x = 0; x < (size_t) numValues; x += numThisTime) {
+                numThisTime = numValues - x;
+                if (numThisTime > U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES) {
+                    numThisTime = U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES;
+                }
+                memset(changed, 0, sizeof(changed));
+                for (layer = U_GNSS_CFG_VAL_LAYER_RAM;
+                     layer <= U_GNSS_CFG_VAL_LAYER_FLASH; layer <<= 1) {
+                    if (layers & layer) {
+                        snapshotDiff(gnssHandle, pList + x, numThisTime,
+                                     (uGnssCfgValLayer_t) layer, changed);
+                    }
+                }
+                for (size_t y = 0; y < numThisTime; y++) {
+                    if (changed[y]) {
+                        *(pList + numChanged) = *(pList + x + y);
+                        numChanged++;
+                    }
+                }
+            }
+            errorCodeOrCount = (int32_t) U_ERROR_COMMON_SUCCESS;
+            if (numChanged > 0) {
+                errorCodeOrCount = valSetListChunked(gnssHandle, pList, numChanged,
+                                                     U_GNSS_CFG_VAL_TRANSACTION_NONE,
+                                                     (int32_t) layers);
+            }
+            if (errorCodeOrCount == 0) {
+                errorCodeOrCount = (int32_t) numChanged;
+            }
+            uPortFree(pList);
+        }
+    }
+
+    return errorCodeOrCount;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: CONFIGURATION CACHE
+ * -------------------------------------------------------------- */
+
+// Set the size of the configuration cache.
+int32_t uGnssCfgSetCacheSize(uDeviceHandle_t gnssHandle, size_t numEntries)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPrivateCfgCache_t *pCfgCache = NULL;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            if (numEntries > 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                pCfgCache = (uGnssPrivateCfgCache_t *) pUPortMalloc(sizeof(*pCfgCache));
+                if (pCfgCache != NULL) {
+                    memset(pCfgCache, 0, sizeof(*pCfgCache));
+                    pCfgCache->pEntry = (uGnssPrivateCfgCacheEntry_t *) pUPortMalloc(numEntries *
+                                                                                       sizeof(uGnssPrivateCfgCacheEntry_t));
+                    if (pCfgCache->pEntry != NULL) {
+                        pCfgCache->maxNumEntries = numEntries;
+                        pCfgCache->protocolOut = -1;
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    } else {
+                        uPortFree(pCfgCache);
+                        pCfgCache = NULL;
+                    }
+                }
+            }
+            if (errorCode == 0) {
+                // Out with the old, in with the new
+                if (pInstance->pCfgCache != NULL) {
+                    uPortFree(pInstance->pCfgCache->pEntry);
+                    uPortFree(pInstance->pCfgCache);
+                }
+                pInstance->pCfgCache = pCfgCache;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Get the hit/miss counters of the configuration cache.
+int32_t uGnssCfgGetCacheCounters(uDeviceHandle_t gnssHandle,
+                                 uint32_t *pHits, uint32_t *pMisses,
+                                 bool reset)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+            if (pInstance->pCfgCache != NULL) {
+                if (pHits != NULL) {
+                    *pHits = pInstance->pCfgCache->hits;
+                }
+                if (pMisses != NULL) {
+                    *pMisses = pInstance->pCfgCache->misses;
+                }
+                if (reset) {
+                    pInstance->pCfgCache->hits = 0;
+                    pInstance->pCfgCache->misses = 0;
+                }
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Empty the configuration cache.
+int32_t uGnssCfgInvalidateCache(uDeviceHandle_t gnssHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            uGnssPrivateCfgCacheInvalidate(pInstance);
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
 // End of file
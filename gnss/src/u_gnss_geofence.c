@@ -0,0 +1,425 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief This source file contains the implementation of the
+ * geofencing API of GNSS, see u_gnss_geofence.h.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()
+
+#include "u_cfg_sw.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_heap.h"
+#include "u_port_os.h"  // Required by u_gnss_private.h
+
+#include "u_ubx_protocol.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss_private.h"
+#include "u_gnss_msg.h"
+#include "u_gnss_msg_ubx.h"
+#include "u_gnss_cfg_val_key.h"
+#include "u_gnss_cfg.h"
+#include "u_gnss_geofence.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The number of configuration values needed to set up the
+ * geofences: confidence, three for the PIO pin, four for each
+ * geofence and one for message output.
+ */
+#define U_GNSS_GEOFENCE_NUM_CFG_VALUES (1 + 3 + (4 * U_GNSS_GEOFENCE_MAX_NUM) + 1)
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The context of a geofence callback, hooked into
+ * pGeofenceContext of the instance by uGnssGeofenceSet().  It
+ * is only touched from the message receive task so needs no mutex.
+ */
+typedef struct {
+    uGnssGeofenceCallback_t *pCallback;
+    void *pCallbackParam;
+    int32_t asyncHandle;  /**< the UBX-NAV-GEOFENCE message receiver. */
+    size_t numFences;
+    bool reported;        /**< true once the callback has been called. */
+    uGnssGeofenceState_t combinedState;
+    uGnssGeofenceState_t state[U_GNSS_GEOFENCE_MAX_NUM];
+} uGnssGeofenceContext_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The CFG-GEOFENCE key IDs for each geofence: use, latitude,
+ * longitude and radius.
+ */
+static const uint32_t gKeyIdFence[U_GNSS_GEOFENCE_MAX_NUM][4] = {
+    {
+        U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_USE_FENCE1_L, U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_FENCE1_LAT_I4,
+        U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_FENCE1_LON_I4, U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_FENCE1_RAD_U4
+    },
+    {
+        U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_USE_FENCE2_L, U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_FENCE2_LAT_I4,
+        U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_FENCE2_LON_I4, U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_FENCE2_RAD_U4
+    },
+    {
+        U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_USE_FENCE3_L, U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_FENCE3_LAT_I4,
+        U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_FENCE3_LON_I4, U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_FENCE3_RAD_U4
+    },
+    {
+        U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_USE_FENCE4_L, U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_FENCE4_LAT_I4,
+        U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_FENCE4_LON_I4, U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_FENCE4_RAD_U4
+    }
+};
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Return the CFG-MSGOUT key ID that controls UBX-NAV-GEOFENCE
+// output on the given port.
+static uint32_t msgOutKeyId(uGnssPort_t port)
+{
+    uint32_t keyId = U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_NAV_GEOFENCE_I2C_U1;
+
+    switch (port) {
+        case U_GNSS_PORT_UART:
+            keyId = U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_NAV_GEOFENCE_UART1_U1;
+            break;
+        case U_GNSS_PORT_UART2:
+            keyId = U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_NAV_GEOFENCE_UART2_U1;
+            break;
+        case U_GNSS_PORT_USB:
+            keyId = U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_NAV_GEOFENCE_USB_U1;
+            break;
+        case U_GNSS_PORT_SPI:
+            keyId = U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_NAV_GEOFENCE_SPI_U1;
+            break;
+        default:
+            break;
+    }
+
+    return keyId;
+}
+
+// Convert a state from UBX-NAV-GEOFENCE.
+static uGnssGeofenceState_t decodeState(uint8_t value)
+{
+    uGnssGeofenceState_t state = U_GNSS_GEOFENCE_STATE_UNKNOWN;
+
+    if ((value == (uint8_t) U_GNSS_GEOFENCE_STATE_INSIDE) ||
+        (value == (uint8_t) U_GNSS_GEOFENCE_STATE_OUTSIDE)) {
+        state = (uGnssGeofenceState_t) value;
+    }
+
+    return state;
+}
+
+// Callback for UBX-NAV-GEOFENCE: call the user only if something
+// has changed.
+static void messageCallback(uDeviceHandle_t gnssHandle,
+                            const uGnssMessageId_t *pMessageId,
+                            int32_t errorCodeOrLength,
+                            void *pCallbackParam)
+{
+    uGnssGeofenceContext_t *pContext = (uGnssGeofenceContext_t *) pCallbackParam;
+    // Enough room for the largest number of geofences
+    char message[U_GNSS_MSG_UBX_NAV_GEOFENCE_BODY_LENGTH_BYTES +
+                 (U_GNSS_MSG_UBX_NAV_GEOFENCE_FENCE_LENGTH_BYTES * U_GNSS_GEOFENCE_MAX_NUM) +
+                 U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+    int32_t changed;
+
+    (void) pMessageId;
+
+    if ((errorCodeOrLength > 0) && (errorCodeOrLength <= (int32_t) sizeof(message)) &&
+        (uGnssMsgReceiveCallbackRead(gnssHandle, message,
+                                     (size_t) errorCodeOrLength) == errorCodeOrLength)) {
+        changed = uGnssPrivateGeofenceUpdate(message, (size_t) errorCodeOrLength,
+                                             pContext->numFences,
+                                             &(pContext->combinedState),
+                                             pContext->state);
+        // Always report the first valid message
+        if ((changed > 0) || ((changed == 0) && !pContext->reported)) {
+            pContext->reported = true;
+            pContext->pCallback(gnssHandle, pContext->combinedState,
+                                pContext->state, pContext->numFences,
+                                pContext->pCallbackParam);
+        }
+    }
+}
+
+// Take the geofence context out of an instance, stop its message
+// receiver and free it; gUGnssPrivateMutex must NOT be locked.
+static void contextStop(uDeviceHandle_t gnssHandle)
+{
+    uGnssPrivateInstance_t *pInstance;
+    uGnssGeofenceContext_t *pContext = NULL;
+
+    U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+    pInstance = pUGnssPrivateGetInstance(gnssHandle);
+    if (pInstance != NULL) {
+        pContext = (uGnssGeofenceContext_t *) pInstance->pGeofenceContext;
+        pInstance->pGeofenceContext = NULL;
+    }
+    U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+
+    if (pContext != NULL) {
+        // Once this returns our callback will not be called again
+        uGnssMsgReceiveStop(gnssHandle, pContext->asyncHandle);
+        uPortFree(pContext);
+    }
+}
+
+// Check that geofencing is supported for the given instance,
+// returning the CFG-MSGOUT key ID for UBX-NAV-GEOFENCE in
+// *pMsgOutKeyId.
+static int32_t checkSupported(uDeviceHandle_t gnssHandle,
+                              uint32_t *pMsgOutKeyId)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            // Message receive only works for a GNSS chip that is
+            // directly connected and CFG-GEOFENCE can only be
+            // set with CFG-VALSET
+            if ((pInstance->transportType != U_GNSS_TRANSPORT_AT) &&
+                U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
+                *pMsgOutKeyId = msgOutKeyId(pInstance->portNumber);
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS THAT ARE PRIVATE TO GNSS
+ * -------------------------------------------------------------- */
+
+// Free the geofence callback context.
+void uGnssPrivateGeofenceRemove(uGnssPrivateInstance_t *pInstance)
+{
+    uPortFree(pInstance->pGeofenceContext);
+    pInstance->pGeofenceContext = NULL;
+}
+
+// Update geofence states from a UBX-NAV-GEOFENCE message.
+int32_t uGnssPrivateGeofenceUpdate(const char *pMessage, size_t size,
+                                   size_t numFences,
+                                   uGnssGeofenceState_t *pCombinedState,
+                                   uGnssGeofenceState_t *pState)
+{
+    int32_t errorCodeOrChanged = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uGnssMsgUbxNavGeofence_t *pNavGeofence;
+    const uGnssMsgUbxNavGeofenceFence_t *pFence;
+    uGnssGeofenceState_t fenceState;
+
+    pNavGeofence = pUGnssMsgUbxNavGeofence(pMessage, size);
+    if ((pNavGeofence != NULL) && (pNavGeofence->status == 1)) {
+        errorCodeOrChanged = 0;
+        fenceState = decodeState(pNavGeofence->combState);
+        if (fenceState != *pCombinedState) {
+            *pCombinedState = fenceState;
+            errorCodeOrChanged = 1;
+        }
+        for (size_t x = 0; (x < numFences) && (x < pNavGeofence->numFences); x++) {
+            pFence = pUGnssMsgUbxNavGeofenceFence(pMessage, size, x);
+            if (pFence != NULL) {
+                fenceState = decodeState(pFence->state);
+                if (fenceState != *(pState + x)) {
+                    *(pState + x) = fenceState;
+                    errorCodeOrChanged = 1;
+                }
+            }
+        }
+    }
+
+    return errorCodeOrChanged;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Set the geofences.
+int32_t uGnssGeofenceSet(uDeviceHandle_t gnssHandle,
+                         const uGnssGeofence_t *pFence,
+                         size_t numFences,
+                         uGnssGeofenceConfidence_t confidence,
+                         int32_t pin, bool pinLowMeansInside,
+                         uGnssGeofenceCallback_t *pCallback,
+                         void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssGeofenceContext_t *pContext = NULL;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssMessageId_t messageId;
+    uGnssCfgVal_t cfgVal[U_GNSS_GEOFENCE_NUM_CFG_VALUES];
+    size_t numValues = 0;
+    uint32_t keyIdMsgOut = 0;
+
+    if ((pFence != NULL) && (numFences > 0) &&
+        (numFences <= U_GNSS_GEOFENCE_MAX_NUM) &&
+        ((int32_t) confidence >= 0) &&
+        (confidence < U_GNSS_GEOFENCE_CONFIDENCE_MAX_NUM) &&
+        (pin <= 255)) {
+        errorCode = checkSupported(gnssHandle, &keyIdMsgOut);
+    }
+
+    if (errorCode == 0) {
+        // The remaining calls are to public GNSS APIs, which lock
+        // gUGnssPrivateMutex themselves; start by getting rid of any
+        // previous callback
+        contextStop(gnssHandle);
+        cfgVal[numValues].keyId = U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_CONFLVL_E1;
+        cfgVal[numValues].value = (uint64_t) confidence;
+        numValues++;
+        cfgVal[numValues].keyId = U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_USE_PIO_L;
+        cfgVal[numValues].value = (pin >= 0);
+        numValues++;
+        if (pin >= 0) {
+            cfgVal[numValues].keyId = U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_PINPOL_E1;
+            cfgVal[numValues].value = pinLowMeansInside ? 0 : 1;
+            numValues++;
+            cfgVal[numValues].keyId = U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_PIN_U1;
+            cfgVal[numValues].value = (uint64_t) pin;
+            numValues++;
+        }
+        for (size_t x = 0; x < U_GNSS_GEOFENCE_MAX_NUM; x++) {
+            cfgVal[numValues].keyId = gKeyIdFence[x][0];
+            cfgVal[numValues].value = (x < numFences);
+            numValues++;
+            if (x < numFences) {
+                // Signed values are sign-extended into the uint64_t,
+                // the GNSS API takes only as many bytes as the key
+                // says it needs
+                cfgVal[numValues].keyId = gKeyIdFence[x][1];
+                cfgVal[numValues].value = (uint64_t) (int64_t) pFence[x].latitudeX1e7;
+                numValues++;
+                cfgVal[numValues].keyId = gKeyIdFence[x][2];
+                cfgVal[numValues].value = (uint64_t) (int64_t) pFence[x].longitudeX1e7;
+                numValues++;
+                cfgVal[numValues].keyId = gKeyIdFence[x][3];
+                cfgVal[numValues].value = pFence[x].radiusCentimetres;
+                numValues++;
+            }
+        }
+        cfgVal[numValues].keyId = keyIdMsgOut;
+        cfgVal[numValues].value = (pCallback != NULL);
+        numValues++;
+        errorCode = uGnssCfgValSetList(gnssHandle, cfgVal, numValues,
+                                       U_GNSS_CFG_VAL_TRANSACTION_NONE,
+                                       U_GNSS_CFG_VAL_LAYER_RAM);
+        if ((errorCode == 0) && (pCallback != NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pContext = (uGnssGeofenceContext_t *) pUPortMalloc(sizeof(*pContext));
+            if (pContext != NULL) {
+                memset(pContext, 0, sizeof(*pContext));
+                pContext->pCallback = pCallback;
+                pContext->pCallbackParam = pCallbackParam;
+                pContext->numFences = numFences;
+                messageId.type = U_GNSS_PROTOCOL_UBX;
+                messageId.id.ubx = U_GNSS_MSG_UBX_NAV_GEOFENCE_MESSAGE_ID;
+                errorCode = uGnssMsgReceiveStart(gnssHandle, &messageId,
+                                                 messageCallback, pContext);
+                if (errorCode >= 0) {
+                    pContext->asyncHandle = errorCode;
+                    errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+                    U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+                    pInstance = pUGnssPrivateGetInstance(gnssHandle);
+                    if (pInstance != NULL) {
+                        pInstance->pGeofenceContext = pContext;
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    }
+                    U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+                    if (errorCode != 0) {
+                        uGnssMsgReceiveStop(gnssHandle, pContext->asyncHandle);
+                    }
+                }
+                if (errorCode != 0) {
+                    uPortFree(pContext);
+                }
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Switch off all of the geofences.
+int32_t uGnssGeofenceClear(uDeviceHandle_t gnssHandle)
+{
+    int32_t errorCode;
+    uGnssCfgVal_t cfgVal[U_GNSS_GEOFENCE_MAX_NUM + 2];
+    size_t numValues = 0;
+    uint32_t keyIdMsgOut = 0;
+
+    errorCode = checkSupported(gnssHandle, &keyIdMsgOut);
+    if (errorCode == 0) {
+        contextStop(gnssHandle);
+        for (size_t x = 0; x < U_GNSS_GEOFENCE_MAX_NUM; x++) {
+            cfgVal[numValues].keyId = gKeyIdFence[x][0];
+            cfgVal[numValues].value = 0;
+            numValues++;
+        }
+        cfgVal[numValues].keyId = U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_USE_PIO_L;
+        cfgVal[numValues].value = 0;
+        numValues++;
+        cfgVal[numValues].keyId = keyIdMsgOut;
+        cfgVal[numValues].value = 0;
+        numValues++;
+        errorCode = uGnssCfgValSetList(gnssHandle, cfgVal, numValues,
+                                       U_GNSS_CFG_VAL_TRANSACTION_NONE,
+                                       U_GNSS_CFG_VAL_LAYER_RAM);
+    }
+
+    return errorCode;
+}
+
+// End of file
@@ -63,10 +63,39 @@
  */
 #define U_GNSS_INFO_MESSAGE_BODY_LENGTH_UBX_MON_COMMS (8 + (40 * U_GNSS_PORT_MAX_NUM))
 
+/** The length of the software version string in the body of a
+ * UBX-MON-VER message.
+ */
+#define U_GNSS_INFO_UBX_MON_VER_SW_LENGTH_BYTES 30
+
+/** The length of the hardware version string in the body of a
+ * UBX-MON-VER message.
+ */
+#define U_GNSS_INFO_UBX_MON_VER_HW_LENGTH_BYTES 10
+
+/** The length of each extension string in the body of a
+ * UBX-MON-VER message.
+ */
+#define U_GNSS_INFO_UBX_MON_VER_EXT_LENGTH_BYTES 30
+
+/** The maximum number of extension strings in the body of a
+ * UBX-MON-VER message that we handle.
+ */
+#define U_GNSS_INFO_UBX_MON_VER_EXT_MAX_NUM 10
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The context of a uGnssInfoGetVersionsAsync() request.
+ */
+typedef struct {
+    uGnssInfoVersionsCallback_t *pCallback;
+    void *pCallbackParam;
+    uGnssVersionType_t versions; /**< kept here rather than on the
+                                      stack of the message receive task. */
+} uGnssInfoVersionsAsync_t;
+
 /* ----------------------------------------------------------------
  * STATIC VARIABLES
  * -------------------------------------------------------------- */
@@ -75,6 +104,79 @@
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Decode the body of a UBX-MON-VER message into *pVer.
+static int32_t versionsDecode(const char *pBody, size_t size,
+                              uGnssVersionType_t *pVer)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_RESPONDING;
+    const char *pExt = pBody + U_GNSS_INFO_UBX_MON_VER_SW_LENGTH_BYTES +
+                       U_GNSS_INFO_UBX_MON_VER_HW_LENGTH_BYTES;
+    size_t n;
+
+    if (size > U_GNSS_INFO_UBX_MON_VER_SW_LENGTH_BYTES + U_GNSS_INFO_UBX_MON_VER_HW_LENGTH_BYTES) {
+        memset(pVer, 0, sizeof(*pVer));
+        strncpy(pVer->ver, pBody, sizeof(pVer->ver));
+        strncpy(pVer->hw, pBody + U_GNSS_INFO_UBX_MON_VER_SW_LENGTH_BYTES, sizeof(pVer->hw));
+        n = (size - U_GNSS_INFO_UBX_MON_VER_SW_LENGTH_BYTES - U_GNSS_INFO_UBX_MON_VER_HW_LENGTH_BYTES) /
+            U_GNSS_INFO_UBX_MON_VER_EXT_LENGTH_BYTES;
+        if (n > U_GNSS_INFO_UBX_MON_VER_EXT_MAX_NUM) {
+            n = U_GNSS_INFO_UBX_MON_VER_EXT_MAX_NUM;
+        }
+        for (size_t i = 0; i < n; i++, pExt += U_GNSS_INFO_UBX_MON_VER_EXT_LENGTH_BYTES) {
+            if (0 == strncmp(pExt, "ROM BASE ", 9)) {
+                strncpy(pVer->rom, pExt + 9, sizeof(pVer->rom));
+            } else if (0 == strncmp(pExt, "FWVER=", 6)) {
+                strncpy(pVer->fw, pExt + 6, sizeof(pVer->fw));
+            } else if (0 == strncmp(pExt, "PROTVER=", 8)) {
+                strncpy(pVer->prot, pExt + 8, sizeof(pVer->prot));
+            } else if (0 == strncmp(pExt, "MOD=", 4)) {
+                strncpy(pVer->mod, pExt + 4, sizeof(pVer->mod));
+            }
+        }
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// The one-shot message receive callback for uGnssInfoGetVersionsAsync().
+static bool versionsAsyncCallback(uDeviceHandle_t gnssHandle,
+                                  const uGnssMessageId_t *pMessageId,
+                                  int32_t errorCodeOrLength,
+                                  void *pCallbackParam)
+{
+    uGnssInfoVersionsAsync_t *pContext = (uGnssInfoVersionsAsync_t *) pCallbackParam;
+    char *pBuffer;
+
+    (void) pMessageId;
+
+    if (errorCodeOrLength > 0) {
+        // UBX-MON-VER is too large for the stack of the message
+        // receive task, hence the heap
+        pBuffer = (char *) pUPortMalloc(errorCodeOrLength);
+        if (pBuffer != NULL) {
+            if (uGnssMsgReceiveCallbackRead(gnssHandle, pBuffer,
+                                            errorCodeOrLength) == errorCodeOrLength) {
+                errorCodeOrLength = versionsDecode(pBuffer + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES,
+                                                   errorCodeOrLength - U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES,
+                                                   &(pContext->versions));
+            } else {
+                errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_RESPONDING;
+            }
+            uPortFree(pBuffer);
+        } else {
+            errorCodeOrLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        }
+    }
+
+    pContext->pCallback(gnssHandle, errorCodeOrLength,
+                        errorCodeOrLength == 0 ? &(pContext->versions) : NULL,
+                        pContext->pCallbackParam);
+    uPortFree(pContext);
+
+    return true;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -128,35 +230,16 @@ int32_t uGnssInfoGetVersions(uDeviceHandle_t gnssHandle,
         if ((pInstance != NULL) && (NULL != pVer)) {
             // Poll with the message class and ID of the UBX-MON-VER
             // message and pass the message body directly back
-            struct {
-                char sw[30];
-                char hw[10];
-                char ext[10][30];
-            } message;
+            char message[U_GNSS_INFO_UBX_MON_VER_SW_LENGTH_BYTES +
+                         U_GNSS_INFO_UBX_MON_VER_HW_LENGTH_BYTES +
+                         (U_GNSS_INFO_UBX_MON_VER_EXT_LENGTH_BYTES *
+                          U_GNSS_INFO_UBX_MON_VER_EXT_MAX_NUM)];
             errorCodeOrLength = uGnssPrivateSendReceiveUbxMessage(pInstance,
                                                                   0x0a, 0x04,
                                                                   NULL, 0,
-                                                                  (char *)&message, sizeof(message));
-            // Add a terminator
-            if (errorCodeOrLength > sizeof(message.sw) + sizeof(message.hw)) {
-                memset(pVer, 0, sizeof(*pVer));
-                strncpy(pVer->ver, message.sw, sizeof(pVer->ver));
-                strncpy(pVer->hw, message.hw, sizeof(pVer->hw));
-                size_t n = (errorCodeOrLength - sizeof(message.sw) + sizeof(message.hw)) / sizeof(message.ext[0]);
-                for (size_t i = 0; i < n; i++) {
-                    if (0 == strncmp(message.ext[i], "ROM BASE ", 9)) {
-                        strncpy(pVer->rom, message.ext[i] + 9, sizeof(pVer->rom));
-                    } else if (0 == strncmp(message.ext[i], "FWVER=", 6)) {
-                        strncpy(pVer->fw, message.ext[i] + 6, sizeof(pVer->fw));
-                    } else if (0 == strncmp(message.ext[i], "PROTVER=", 8)) {
-                        strncpy(pVer->prot, message.ext[i] + 8, sizeof(pVer->prot));
-                    } else if (0 == strncmp(message.ext[i], "MOD=", 4)) {
-                        strncpy(pVer->mod, message.ext[i] + 4, sizeof(pVer->mod));
-                    }
-                }
-                errorCodeOrLength = U_ERROR_COMMON_SUCCESS;
-            } else if (errorCodeOrLength >= 0) {
-                errorCodeOrLength = U_ERROR_COMMON_NOT_RESPONDING;
+                                                                  message, sizeof(message));
+            if (errorCodeOrLength >= 0) {
+                errorCodeOrLength = versionsDecode(message, errorCodeOrLength, pVer);
             }
         }
 
@@ -166,6 +249,80 @@ int32_t uGnssInfoGetVersions(uDeviceHandle_t gnssHandle,
     return errorCodeOrLength;
 }
 
+// Get the various information from the GNSS chip without blocking.
+int32_t uGnssInfoGetVersionsAsync(uDeviceHandle_t gnssHandle,
+                                  uGnssInfoVersionsCallback_t *pCallback,
+                                  void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssInfoVersionsAsync_t *pContext = NULL;
+    int32_t timeoutMs = 0;
+    uGnssMessageId_t messageId = {0};
+    int32_t asyncHandle;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pCallback != NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (uGnssPrivateGetStreamType(pInstance->transportType) >= 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                pContext = (uGnssInfoVersionsAsync_t *) pUPortMalloc(sizeof(*pContext));
+                if (pContext != NULL) {
+                    pContext->pCallback = pCallback;
+                    pContext->pCallbackParam = pCallbackParam;
+                    timeoutMs = pInstance->timeoutMs;
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+
+        if (pContext != NULL) {
+            // Set up to catch the response before sending the poll;
+            // the one-shot reader locks gUGnssPrivateMutex itself
+            messageId.type = U_GNSS_PROTOCOL_UBX;
+            messageId.id.ubx = 0x0a04;
+            asyncHandle = uGnssMsgReceiveStartOneShot(gnssHandle, &messageId,
+                                                      versionsAsyncCallback,
+                                                      pContext, timeoutMs);
+            errorCode = asyncHandle;
+            if (asyncHandle >= 0) {
+
+                U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+                errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+                pInstance = pUGnssPrivateGetInstance(gnssHandle);
+                if (pInstance != NULL) {
+                    // Poll with the message class and ID of the UBX-MON-VER message
+                    errorCode = uGnssPrivateSendOnlyStreamUbxMessage(pInstance,
+                                                                     0x0a, 0x04,
+                                                                     NULL, 0);
+                }
+
+                U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+
+                if (errorCode >= 0) {
+                    // pContext now belongs to versionsAsyncCallback()
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    pContext = NULL;
+                } else if (uGnssMsgReceiveStop(gnssHandle, asyncHandle) != 0) {
+                    // Too late, the reader has already been and gone
+                    // and has freed pContext
+                    pContext = NULL;
+                }
+            }
+            uPortFree(pContext);
+        }
+    }
+
+    return errorCode;
+}
+
 
 // Get the chip ID from the GNSS chip.
 int32_t uGnssInfoGetIdStr(uDeviceHandle_t gnssHandle,
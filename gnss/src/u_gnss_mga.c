@@ -0,0 +1,419 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief This source file contains the implementation of the
+ * multiple GNSS assistance (MGA) API of GNSS.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcmp()
+
+#include "u_cfg_sw.h"
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_heap.h"
+#include "u_port_os.h"  // Required by u_gnss_private.h
+#include "u_port_debug.h"
+
+#include "u_at_client.h"
+
+#include "u_ubx_protocol.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss.h"
+#include "u_gnss_cfg_val_key.h"
+#include "u_gnss_cfg.h"
+#include "u_gnss_private.h"
+#include "u_gnss_mga.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The UBX message class of all UBX-MGA-XXX messages.
+ */
+#define U_GNSS_MGA_MESSAGE_CLASS 0x13
+
+/** The UBX message ID of UBX-MGA-ACK.
+ */
+#define U_GNSS_MGA_MESSAGE_ID_ACK 0x60
+
+/** The UBX message ID of UBX-MGA-DBD, which is not acknowledged.
+ */
+#define U_GNSS_MGA_MESSAGE_ID_DBD 0x80
+
+/** The length of the body of UBX-MGA-ACK.
+ */
+#define U_GNSS_MGA_ACK_BODY_LENGTH_BYTES 8
+
+/** The number of bytes of the body of the acknowledged message
+ * that UBX-MGA-ACK echoes back.
+ */
+#define U_GNSS_MGA_ACK_PAYLOAD_START_LENGTH_BYTES 4
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The context for a send operation.
+ */
+typedef struct {
+    uDeviceHandle_t gnssHandle;
+    uGnssMgaFlowControl_t flowControl;
+    uGnssMgaProgressCallback_t *pProgressCallback;
+    void *pProgressCallbackParam;
+    uUbxProtocolDecoder_t decoder;
+    size_t messageCount;
+    bool keepGoing;
+} uGnssMgaContext_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Switch on acknowledgement of assistance data in the GNSS chip,
+// RAM only.  gUGnssPrivateMutex must NOT be locked.
+static int32_t enableAck(uDeviceHandle_t gnssHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    bool cfgVal = false;
+    // Enough room for version 3 of UBX-CFG-NAVX5
+    char message[44];
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            cfgVal = U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX);
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            if (!cfgVal) {
+                // Poll UBX-CFG-NAVX5, then write it back with only
+                // the ackAid bit (bit 10) of mask1 set, and none of
+                // mask2, so that nothing else is changed, and
+                // ackAiding (offset 17) set
+                errorCode = uGnssPrivateSendReceiveUbxMessage(pInstance,
+                                                              0x06, 0x23,
+                                                              NULL, 0,
+                                                              message,
+                                                              sizeof(message));
+                if (errorCode >= 40) {
+                    message[2] = 0;
+                    message[3] = 0x04;
+                    memset(message + 4, 0, 4);
+                    message[17] = 1;
+                    errorCode = uGnssPrivateSendUbxMessage(pInstance,
+                                                           0x06, 0x23,
+                                                           message,
+                                                           errorCode);
+                } else if (errorCode >= 0) {
+                    errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+
+        if ((errorCode == 0) && cfgVal) {
+            // Can't hold gUGnssPrivateMutex while doing this
+            errorCode = uGnssCfgValSet(gnssHandle,
+                                       U_GNSS_CFG_VAL_KEY_ID_NAVSPG_ACKAIDING_L,
+                                       1, U_GNSS_CFG_VAL_TRANSACTION_NONE,
+                                       U_GNSS_CFG_VAL_LAYER_RAM);
+        }
+    }
+
+    return errorCode;
+}
+
+// Send one UBX-MGA-XXX message, applying the flow control,
+// returning zero on success, U_GNSS_ERROR_NACK if the GNSS chip
+// didn't use the message, else negative error code.
+static int32_t sendMessage(const uGnssMgaContext_t *pContext,
+                           int32_t messageId, const char *pBody,
+                           size_t bodyLength)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    bool ack = (pContext->flowControl == U_GNSS_MGA_FLOW_CONTROL_ACK) &&
+               (messageId != U_GNSS_MGA_MESSAGE_ID_DBD);
+    char ackBody[U_GNSS_MGA_ACK_BODY_LENGTH_BYTES];
+    size_t compareLength = bodyLength;
+    int32_t x;
+
+    if (compareLength > U_GNSS_MGA_ACK_PAYLOAD_START_LENGTH_BYTES) {
+        compareLength = U_GNSS_MGA_ACK_PAYLOAD_START_LENGTH_BYTES;
+    }
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        // Get the instance each time as the mutex has been
+        // released since the last message
+        pInstance = pUGnssPrivateGetInstance(pContext->gnssHandle);
+        if (pInstance != NULL) {
+            if (ack) {
+                errorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
+                for (size_t y = 0; (y <= U_GNSS_MGA_ACK_RETRIES) &&
+                     (errorCode == (int32_t) U_ERROR_COMMON_TIMEOUT); y++) {
+                    x = uGnssPrivateSendReceiveUbxMessageResponse(pInstance,
+                                                                  U_GNSS_MGA_MESSAGE_CLASS,
+                                                                  messageId,
+                                                                  pBody, bodyLength,
+                                                                  U_GNSS_MGA_MESSAGE_CLASS,
+                                                                  U_GNSS_MGA_MESSAGE_ID_ACK,
+                                                                  ackBody, sizeof(ackBody));
+                    // UBX-MGA-ACK contains the type (1 for "used") at
+                    // offset 0, the ID of the message being acknowledged
+                    // at offset 3 and the start of its body at offset 4
+                    if ((x == sizeof(ackBody)) &&
+                        (ackBody[3] == (char) messageId) &&
+                        (memcmp(ackBody + 4, pBody, compareLength) == 0)) {
+                        errorCode = (int32_t) U_GNSS_ERROR_NACK;
+                        if (ackBody[0] == 1) {
+                            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                        } else if (pInstance->printUbxMessages) {
+                            uPortLog("U_GNSS_MGA: UBX-MGA 0x%02x not used, info code %d.\n",
+                                     messageId, ackBody[2]);
+                        }
+                    } else if ((x >= 0) || (x == (int32_t) U_ERROR_COMMON_TIMEOUT)) {
+                        // Missing or wrong ack, try again
+                        errorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
+                    } else {
+                        errorCode = x;
+                    }
+                }
+            } else {
+                x = uGnssPrivateSendOnlyStreamUbxMessage(pInstance,
+                                                         U_GNSS_MGA_MESSAGE_CLASS,
+                                                         messageId,
+                                                         pBody, bodyLength);
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                if (x < 0) {
+                    errorCode = x;
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+
+        if ((errorCode == 0) && !ack &&
+            (pContext->flowControl != U_GNSS_MGA_FLOW_CONTROL_NONE)) {
+            uPortTaskBlock(U_GNSS_MGA_INTER_MESSAGE_DELAY_MS);
+        }
+    }
+
+    return errorCode;
+}
+
+// Feed data to the decoder, sending each UBX-MGA-XXX message found.
+static int32_t feed(uGnssMgaContext_t *pContext,
+                    const char *pData, size_t length)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t messageClass;
+    int32_t messageId;
+    const char *pBody;
+    int32_t x;
+
+    while ((length > 0) && (errorCode == 0) && pContext->keepGoing) {
+        x = uUbxProtocolDecoderFeed(&(pContext->decoder), pData, length);
+        if (x >= 0) {
+            pData += x;
+            length -= x;
+            x = uUbxProtocolDecoderGet(&(pContext->decoder),
+                                       &messageClass, &messageId, &pBody);
+            // Anything that isn't UBX-MGA-XXX or is too large to
+            // have been stored is ignored, as is UBX-MGA-ACK
+            if ((x >= 0) && (messageClass == U_GNSS_MGA_MESSAGE_CLASS) &&
+                (messageId != U_GNSS_MGA_MESSAGE_ID_ACK) &&
+                (x <= U_GNSS_MGA_MESSAGE_BODY_MAX_LENGTH_BYTES)) {
+                x = sendMessage(pContext, messageId, pBody, x);
+                if ((x == 0) || (x == (int32_t) U_GNSS_ERROR_NACK)) {
+                    // A NACK only means that the GNSS chip didn't want
+                    // the message, e.g. because it doesn't know the
+                    // time yet, not that anything is broken
+                    pContext->messageCount++;
+                } else {
+                    errorCode = x;
+                }
+                if ((pContext->pProgressCallback != NULL) &&
+                    !pContext->pProgressCallback(pContext->gnssHandle, x,
+                                                 pContext->messageCount,
+                                                 pContext->pProgressCallbackParam)) {
+                    pContext->keepGoing = false;
+                }
+            }
+        } else {
+            errorCode = x;
+        }
+    }
+
+    return errorCode;
+}
+
+// Set up the context, and the memory for it, for a send operation.
+static int32_t contextInit(uGnssMgaContext_t *pContext,
+                           uDeviceHandle_t gnssHandle,
+                           uGnssMgaFlowControl_t flowControl,
+                           uGnssMgaProgressCallback_t *pProgressCallback,
+                           void *pProgressCallbackParam,
+                           char **ppBody)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && ((int32_t) flowControl >= 0) &&
+            (flowControl < U_GNSS_MGA_FLOW_CONTROL_MAX_NUM)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (uGnssPrivateGetStreamType(pInstance->transportType) >= 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                *ppBody = (char *) pUPortMalloc(U_GNSS_MGA_MESSAGE_BODY_MAX_LENGTH_BYTES);
+                if (*ppBody != NULL) {
+                    memset(pContext, 0, sizeof(*pContext));
+                    pContext->gnssHandle = gnssHandle;
+                    pContext->flowControl = flowControl;
+                    pContext->pProgressCallback = pProgressCallback;
+                    pContext->pProgressCallbackParam = pProgressCallbackParam;
+                    pContext->keepGoing = true;
+                    errorCode = uUbxProtocolDecoderInit(&(pContext->decoder), *ppBody,
+                                                        U_GNSS_MGA_MESSAGE_BODY_MAX_LENGTH_BYTES,
+                                                        NULL, NULL);
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+
+        if ((errorCode == 0) && (flowControl == U_GNSS_MGA_FLOW_CONTROL_ACK)) {
+            // Can't hold gUGnssPrivateMutex while doing this
+            errorCode = enableAck(gnssHandle);
+        }
+    }
+
+    return errorCode;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Send a buffer of UBX-MGA-XXX messages to the GNSS chip.
+int32_t uGnssMgaSend(uDeviceHandle_t gnssHandle,
+                     const char *pBuffer, size_t size,
+                     uGnssMgaFlowControl_t flowControl,
+                     uGnssMgaProgressCallback_t *pProgressCallback,
+                     void *pProgressCallbackParam)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssMgaContext_t context;
+    char *pBody = NULL;
+
+    if (pBuffer != NULL) {
+        errorCodeOrCount = contextInit(&context, gnssHandle, flowControl,
+                                       pProgressCallback, pProgressCallbackParam,
+                                       &pBody);
+        if (errorCodeOrCount == 0) {
+            errorCodeOrCount = feed(&context, pBuffer, size);
+            if (errorCodeOrCount == 0) {
+                errorCodeOrCount = (int32_t) context.messageCount;
+            }
+        }
+        uPortFree(pBody);
+    }
+
+    return errorCodeOrCount;
+}
+
+// Send UBX-MGA-XXX messages, provided by a read callback, to the GNSS chip.
+int32_t uGnssMgaSendRead(uDeviceHandle_t gnssHandle,
+                         uGnssMgaReadCallback_t *pReadCallback,
+                         void *pReadCallbackParam,
+                         uGnssMgaFlowControl_t flowControl,
+                         uGnssMgaProgressCallback_t *pProgressCallback,
+                         void *pProgressCallbackParam)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssMgaContext_t context;
+    char *pBody = NULL;
+    char *pChunk = NULL;
+    int32_t x = 0;
+
+    if (pReadCallback != NULL) {
+        errorCodeOrCount = contextInit(&context, gnssHandle, flowControl,
+                                       pProgressCallback, pProgressCallbackParam,
+                                       &pBody);
+        if (errorCodeOrCount == 0) {
+            errorCodeOrCount = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pChunk = (char *) pUPortMalloc(U_GNSS_MGA_READ_CHUNK_LENGTH_BYTES);
+            if (pChunk != NULL) {
+                errorCodeOrCount = (int32_t) U_ERROR_COMMON_SUCCESS;
+                do {
+                    x = pReadCallback(gnssHandle, pChunk,
+                                      U_GNSS_MGA_READ_CHUNK_LENGTH_BYTES,
+                                      pReadCallbackParam);
+                    if (x > U_GNSS_MGA_READ_CHUNK_LENGTH_BYTES) {
+                        x = U_GNSS_MGA_READ_CHUNK_LENGTH_BYTES;
+                    }
+                    if (x > 0) {
+                        errorCodeOrCount = feed(&context, pChunk, x);
+                    } else if (x < 0) {
+                        errorCodeOrCount = x;
+                    }
+                } while ((x > 0) && (errorCodeOrCount == 0) && context.keepGoing);
+                if (errorCodeOrCount == 0) {
+                    errorCodeOrCount = (int32_t) context.messageCount;
+                }
+            }
+        }
+        uPortFree(pChunk);
+        uPortFree(pBody);
+    }
+
+    return errorCodeOrCount;
+}
+
+// End of file
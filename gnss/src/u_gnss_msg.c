@@ -72,6 +72,7 @@
 #include "u_port.h"
 #include "u_port_heap.h"
 #include "u_port_os.h"  // Required by u_gnss_private.h
+#include "u_task_registry.h"
 #include "u_port_debug.h"
 #include "u_port_uart.h"
 #include "u_port_i2c.h"
@@ -123,6 +124,25 @@
 # error U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS must be at least as big as U_CFG_OS_YIELD_MS
 #endif
 
+#if U_GNSS_MSG_RECEIVER_MAX_NUM > 32
+/* Each reader has a bit in the uint32_t masks of uGnssPrivateMsgIndex_t.
+ */
+# error U_GNSS_MSG_RECEIVER_MAX_NUM cannot be more than 32
+#endif
+
+#if (U_GNSS_PRIVATE_MSG_INDEX_NUM_BUCKETS & (U_GNSS_PRIVATE_MSG_INDEX_NUM_BUCKETS - 1)) != 0
+# error U_GNSS_PRIVATE_MSG_INDEX_NUM_BUCKETS must be a power of two
+#endif
+
+/** The FNV-1a offset basis, used when hashing message IDs into the
+ * index of readers.
+ */
+#define U_GNSS_MSG_INDEX_HASH_START ((uint32_t) 2166136261U)
+
+/** Add a byte to an FNV-1a hash.
+ */
+#define U_GNSS_MSG_INDEX_HASH_ADD(hash, byte) ((uint32_t) (((uint32_t) (hash) ^ (uint8_t) (byte)) * 16777619U))
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -131,24 +151,456 @@
  * STATIC VARIABLES
  * -------------------------------------------------------------- */
 
+#ifdef U_GNSS_MSG_RECEIVE_TASK_SHARED
+
+/** The handle of the message receive task shared between all
+ * GNSS instances.
+ */
+static uPortTaskHandle_t gSharedTaskHandle = NULL;
+
+/** Locked by the shared message receive task while it is running.
+ */
+static uPortMutexHandle_t gSharedTaskRunningMutexHandle = NULL;
+
+/** Queue used to make the shared message receive task exit.
+ */
+static uPortQueueHandle_t gSharedTaskExitQueueHandle = NULL;
+
+/** Protects gpSharedList; held by the shared message receive task
+ * while it services the instances.
+ */
+static uPortMutexHandle_t gSharedMutexHandle = NULL;
+
+/** The GNSS instances serviced by the shared message receive task,
+ * linked through pSharedNext in their pMsgReceive.
+ */
+static uGnssPrivateInstance_t *gpSharedList = NULL;
+
+/** The position in gpSharedList of the instance that the shared
+ * message receive task last serviced first.
+ */
+static size_t gSharedFirst = 0;
+
+#endif
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
-// Task that runs the non-blocking message receive.
-static void msgReceiveTask(void *pParam)
+// Return the index hash bucket for a UBX or RTCM message ID.
+static size_t indexBucketId(uGnssProtocol_t protocol, uint16_t id)
+{
+    uint32_t hash = U_GNSS_MSG_INDEX_HASH_ADD(U_GNSS_MSG_INDEX_HASH_START, protocol);
+
+    hash = U_GNSS_MSG_INDEX_HASH_ADD(hash, id >> 8);
+    hash = U_GNSS_MSG_INDEX_HASH_ADD(hash, id);
+
+    return hash & (U_GNSS_PRIVATE_MSG_INDEX_NUM_BUCKETS - 1);
+}
+
+// Rebuild the index of readers of the message receive task; must
+// be called with the reader mutex locked.
+static void indexRebuild(uGnssPrivateMsgReceive_t *pMsgReceive)
+{
+    uGnssPrivateMsgIndex_t *pIndex = &(pMsgReceive->index);
+    const uGnssPrivateMsgReader_t *pReader;
+    const uGnssPrivateMessageId_t *pId;
+    uint32_t bit;
+    uint32_t hash;
+
+    memset(pIndex, 0, sizeof(*pIndex));
+    for (size_t x = 0; x < U_GNSS_MSG_RECEIVER_MAX_NUM; x++) {
+        pReader = pMsgReceive->pReaderSlot[x];
+        if (pReader != NULL) {
+            bit = 1UL << x;
+            pId = &(pReader->privateMessageId);
+            switch (pId->type) {
+                case U_GNSS_PROTOCOL_ANY:
+                    pIndex->any |= bit;
+                    break;
+                case U_GNSS_PROTOCOL_ALL:
+                    pIndex->all |= bit;
+                    break;
+                case U_GNSS_PROTOCOL_UBX:
+                    if (pId->id.ubx == U_GNSS_UBX_MESSAGE_ALL) {
+                        pIndex->protocol[U_GNSS_PROTOCOL_UBX] |= bit;
+                    } else {
+                        // Class or ID wild-cards are looked up as such
+                        pIndex->bucket[indexBucketId(U_GNSS_PROTOCOL_UBX, pId->id.ubx)] |= bit;
+                    }
+                    break;
+                case U_GNSS_PROTOCOL_RTCM:
+                    if (pId->id.rtcm == U_GNSS_RTCM_MESSAGE_ID_ALL) {
+                        pIndex->protocol[U_GNSS_PROTOCOL_RTCM] |= bit;
+                    } else {
+                        pIndex->bucket[indexBucketId(U_GNSS_PROTOCOL_RTCM, pId->id.rtcm)] |= bit;
+                    }
+                    break;
+                case U_GNSS_PROTOCOL_NMEA:
+                    if ((pId->id.nmea[0] == 0) || (strchr(pId->id.nmea, '?') != NULL)) {
+                        pIndex->protocol[U_GNSS_PROTOCOL_NMEA] |= bit;
+                    } else {
+                        // A wanted NMEA ID matches any actual ID that it is
+                        // a prefix of, so hash it as it stands and the
+                        // actual ID is looked up at every length
+                        hash = U_GNSS_MSG_INDEX_HASH_ADD(U_GNSS_MSG_INDEX_HASH_START,
+                                                         U_GNSS_PROTOCOL_NMEA);
+                        for (const char *pTmp = pId->id.nmea; *pTmp != 0; pTmp++) {
+                            hash = U_GNSS_MSG_INDEX_HASH_ADD(hash, *pTmp);
+                        }
+                        pIndex->bucket[hash & (U_GNSS_PRIVATE_MSG_INDEX_NUM_BUCKETS - 1)] |= bit;
+                    }
+                    break;
+                case U_GNSS_PROTOCOL_UNKNOWN:
+                    pIndex->protocol[U_GNSS_PROTOCOL_UNKNOWN] |= bit;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+// Return a mask of the readers that might want the given message
+// ID, from the index of readers of the message receive task.
+static uint32_t indexCandidates(const uGnssPrivateMsgIndex_t *pIndex,
+                                const uGnssPrivateMessageId_t *pId)
+{
+    uint32_t candidates = pIndex->any;
+    uint32_t hash;
+
+    if ((pId->type >= 0) && (pId->type < U_GNSS_PROTOCOL_MAX_NUM)) {
+        candidates |= pIndex->protocol[pId->type];
+        if (pId->type != U_GNSS_PROTOCOL_UNKNOWN) {
+            candidates |= pIndex->all;
+        }
+    }
+    switch (pId->type) {
+        case U_GNSS_PROTOCOL_UBX:
+            candidates |= pIndex->bucket[indexBucketId(U_GNSS_PROTOCOL_UBX, pId->id.ubx)];
+            candidates |= pIndex->bucket[indexBucketId(U_GNSS_PROTOCOL_UBX,
+                                                       pId->id.ubx | U_GNSS_UBX_MESSAGE_ID_ALL)];
+            candidates |= pIndex->bucket[indexBucketId(U_GNSS_PROTOCOL_UBX,
+                                                       pId->id.ubx | (U_GNSS_UBX_MESSAGE_CLASS_ALL << 8))];
+            break;
+        case U_GNSS_PROTOCOL_RTCM:
+            candidates |= pIndex->bucket[indexBucketId(U_GNSS_PROTOCOL_RTCM, pId->id.rtcm)];
+            break;
+        case U_GNSS_PROTOCOL_NMEA:
+            hash = U_GNSS_MSG_INDEX_HASH_ADD(U_GNSS_MSG_INDEX_HASH_START,
+                                             U_GNSS_PROTOCOL_NMEA);
+            for (size_t x = 0; (x < U_GNSS_NMEA_MESSAGE_MATCH_LENGTH_CHARACTERS) &&
+                 (pId->id.nmea[x] != 0); x++) {
+                hash = U_GNSS_MSG_INDEX_HASH_ADD(hash, pId->id.nmea[x]);
+                candidates |= pIndex->bucket[hash & (U_GNSS_PRIVATE_MSG_INDEX_NUM_BUCKETS - 1)];
+            }
+            break;
+        default:
+            break;
+    }
+
+    return candidates;
+}
+
+// Fill in the (two) spans that point at the unread part of the
+// current message in the ring buffer of the message receive task;
+// must be called with the read handle of the task locked.
+static void spanMessage(uGnssPrivateInstance_t *pInstance,
+                        uRingBufferSpan_t *pSpan)
+{
+    uGnssPrivateMsgReceive_t *pMsgReceive = pInstance->pMsgReceive;
+    size_t length = pMsgReceive->msgBytesLeftToRead;
+
+    uRingBufferPeekSpanHandle(&(pInstance->ringBuffer),
+                              pMsgReceive->ringBufferReadHandle,
+                              pSpan);
+    // The spans cover everything that is unread, limit
+    // them to the message
+    if (pSpan[0].length > length) {
+        pSpan[0].length = length;
+    }
+    length -= pSpan[0].length;
+    if (pSpan[1].length > length) {
+        pSpan[1].length = length;
+    }
+}
+
+// Update the decode statistics for a message of the given type.
+static void updateStatsDecode(uGnssMsgStats_t *pStats,
+                              uGnssProtocol_t protocol,
+                              int32_t timeUs)
+{
+    uGnssMsgStatsProtocol_t *pProtocol;
+
+    if ((size_t) protocol < (size_t) U_GNSS_PROTOCOL_MAX_NUM) {
+        pProtocol = &(pStats->protocol[protocol]);
+        pProtocol->messageCount++;
+        pProtocol->decodeTimeTotalUs += timeUs;
+        if (timeUs > pProtocol->decodeTimeMaxUs) {
+            pProtocol->decodeTimeMaxUs = timeUs;
+        }
+    }
+}
+
+// Update the callback statistics after a callback has been called.
+static void updateStatsCallback(uGnssMsgStats_t *pStats,
+                                int32_t latencyUs, int32_t timeUs)
+{
+    pStats->callbackCount++;
+    pStats->callbackTimeTotalUs += timeUs;
+    if (timeUs > pStats->callbackTimeMaxUs) {
+        pStats->callbackTimeMaxUs = timeUs;
+    }
+    pStats->latencyTotalUs += latencyUs;
+    if (latencyUs > pStats->latencyMaxUs) {
+        pStats->latencyMaxUs = latencyUs;
+    }
+}
+
+// Remove the reader with the given handle from the list of readers
+// of the message receive task, returning true if it was found; must
+// be called with the reader mutex locked.
+static bool readerRemove(uGnssPrivateMsgReceive_t *pMsgReceive,
+                         int32_t asyncHandle)
+{
+    bool found = false;
+    uGnssPrivateMsgReader_t *pCurrent = pMsgReceive->pReaderList;
+    uGnssPrivateMsgReader_t *pPrev = NULL;
+
+    while ((pCurrent != NULL) && !found) {
+        if (pCurrent->handle == asyncHandle) {
+            if (pPrev != NULL) {
+                pPrev->pNext = pCurrent->pNext;
+            } else {
+                pMsgReceive->pReaderList = pCurrent->pNext;
+            }
+            pMsgReceive->pReaderSlot[pCurrent->slot] = NULL;
+            indexRebuild(pMsgReceive);
+            uPortFree(pCurrent);
+            found = true;
+        } else {
+            pPrev = pCurrent;
+            pCurrent = pPrev->pNext;
+        }
+    }
+
+    return found;
+}
+
+// Call a reader's callback, whatever kind it is.
+static void readerCall(uGnssPrivateInstance_t *pInstance,
+                       uGnssPrivateMsgReader_t *pReader,
+                       const uGnssMessageId_t *pMessageId,
+                       int32_t errorCodeOrLength)
+{
+    uRingBufferSpan_t span[2];
+
+    if (pReader->oneShot) {
+        pReader->oneShotDone = ((uGnssMsgReceiveOneShotCallback_t) pReader->pCallback)(pInstance->gnssHandle,
+                                                                                      pMessageId,
+                                                                                      errorCodeOrLength,
+                                                                                      pReader->pCallbackParam);
+    } else if (pReader->spanCallback) {
+        // Point the reader straight at the message
+        // in the ring buffer; done afresh for each
+        // reader in case a previous one extracted
+        memset(span, 0, sizeof(span));
+        if (errorCodeOrLength > 0) {
+            spanMessage(pInstance, span);
+        }
+        ((uGnssMsgReceiveSpanCallback_t) pReader->pCallback)(pInstance->gnssHandle,
+                                                             pMessageId,
+                                                             span,
+                                                             errorCodeOrLength,
+                                                             pReader->pCallbackParam);
+    } else {
+        ((uGnssMsgReceiveCallback_t) pReader->pCallback)(pInstance->gnssHandle,
+                                                         pMessageId,
+                                                         errorCodeOrLength,
+                                                         pReader->pCallbackParam);
+    }
+}
+
+// The message receive task decodes everything, so a UBX-ACK-NAK
+// is just another message to it; this checks if the UBX-ACK-NAK
+// that is at the front of the ring buffer is for a message
+// that a one-shot reader is waiting for and, if so, calls its
+// callback with U_GNSS_ERROR_NACK; must be called with the reader
+// mutex locked.
+static void oneShotNack(uGnssPrivateInstance_t *pInstance)
+{
+    uGnssPrivateMsgReceive_t *pMsgReceive = pInstance->pMsgReceive;
+    uGnssPrivateMsgReader_t *pReader;
+    uGnssMessageId_t messageId;
+    uint16_t ubxId;
+    char buffer[U_UBX_PROTOCOL_HEADER_LENGTH_BYTES + 2];
+
+    if (uRingBufferPeekHandle(&(pInstance->ringBuffer),
+                              pMsgReceive->ringBufferReadHandle,
+                              buffer, sizeof(buffer), 0) == sizeof(buffer)) {
+        // The body of UBX-ACK-NAK is the class and ID NACKed
+        ubxId = (uint16_t) ((((uint16_t) (uint8_t) buffer[U_UBX_PROTOCOL_HEADER_LENGTH_BYTES]) << 8) |
+                            (uint8_t) buffer[U_UBX_PROTOCOL_HEADER_LENGTH_BYTES + 1]);
+        for (size_t x = 0; x < U_GNSS_MSG_RECEIVER_MAX_NUM; x++) {
+            pReader = pMsgReceive->pReaderSlot[x];
+            if ((pReader != NULL) && pReader->oneShot && !pReader->oneShotDone &&
+                (pReader->privateMessageId.type == U_GNSS_PROTOCOL_UBX) &&
+                (pReader->privateMessageId.id.ubx == ubxId)) {
+                messageId.type = U_GNSS_PROTOCOL_UBX;
+                messageId.id.ubx = ubxId;
+                readerCall(pInstance, pReader, &messageId, (int32_t) U_GNSS_ERROR_NACK);
+            }
+        }
+    }
+}
+
+// Remove the one-shot readers that are done, calling the callback
+// of any that have timed out first.
+static void oneShotReap(uGnssPrivateInstance_t *pInstance)
 {
-    uGnssPrivateInstance_t *pInstance = (uGnssPrivateInstance_t *) pParam;
-    char queueItem[U_GNSS_MSG_RECEIVE_TASK_QUEUE_ITEM_SIZE_BYTES];
     uGnssPrivateMsgReceive_t *pMsgReceive = pInstance->pMsgReceive;
     uGnssPrivateMsgReader_t *pReader;
-    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_UNKNOWN;
+    uGnssMessageId_t messageId;
+    char nmeaId[U_GNSS_NMEA_MESSAGE_MATCH_LENGTH_CHARACTERS + 1];
+
+    U_PORT_MUTEX_LOCK(pMsgReceive->readerMutexHandle);
+
+    for (size_t x = 0; x < U_GNSS_MSG_RECEIVER_MAX_NUM; x++) {
+        pReader = pMsgReceive->pReaderSlot[x];
+        if ((pReader != NULL) && pReader->oneShot) {
+            if (!pReader->oneShotDone &&
+                (uPortGetTickTimeMs() - pReader->oneShotStartTimeMs > pReader->oneShotTimeoutMs)) {
+                memset(&messageId, 0, sizeof(messageId));
+                uGnssPrivateMessageIdToPublic(&(pReader->privateMessageId),
+                                              &messageId, nmeaId);
+                readerCall(pInstance, pReader, &messageId,
+                           (int32_t) U_ERROR_COMMON_TIMEOUT);
+                pReader->oneShotDone = true;
+            }
+            if (pReader->oneShotDone) {
+                readerRemove(pMsgReceive, pReader->handle);
+            }
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(pMsgReceive->readerMutexHandle);
+}
+
+// Service the message stream of one GNSS instance once: pull data
+// into the ring buffer, decode what is there and call any interested
+// readers; returns true if there was nothing to do, i.e. the caller
+// may relax for longer before calling this again.
+static bool msgReceiveService(uGnssPrivateInstance_t *pInstance)
+{
+    uGnssPrivateMsgReceive_t *pMsgReceive = pInstance->pMsgReceive;
+    uGnssPrivateMsgReader_t *pReader;
+    int32_t errorCodeOrLength;
     int32_t receiveSize;
-    int32_t yieldTimeMs;
-    size_t discardSize = 0;
     uGnssMessageId_t messageId;
     uGnssPrivateMessageId_t privateMessageId;
     char nmeaId[U_GNSS_NMEA_MESSAGE_MATCH_LENGTH_CHARACTERS + 1];
+    uint32_t candidates;
+    uGnssMsgStats_t *pStats = &(pInstance->stats);
+    int64_t startTimeUs;
+
+    // Note that this does NOT lock gUGnssPrivateMutex: it doesn't need to,
+    // provided the task is brought up and torn down in an organised way
+
+    // Pull stuff into the ring buffer
+    receiveSize = uGnssPrivateStreamFillRingBuffer(pInstance, 0, 0);
+    // Deal with any discard from a previous run around this loop
+    pMsgReceive->discardSize -= uRingBufferReadHandle(&(pInstance->ringBuffer),
+                                                      pMsgReceive->ringBufferReadHandle,
+                                                      NULL, pMsgReceive->discardSize);
+    errorCodeOrLength = 0;
+    if (pMsgReceive->discardSize == 0) {
+        errorCodeOrLength = uRingBufferDataSizeHandle(&(pInstance->ringBuffer),
+                                                      pMsgReceive->ringBufferReadHandle);
+        if ((errorCodeOrLength > 0) && (pMsgReceive->arrivalTimeUs < 0)) {
+            // For the latency statistic
+            pMsgReceive->arrivalTimeUs = uPortGetTickTimeUs();
+        }
+        // Run around a loop processing the data from the ring buffer
+        // for as long as we're still finding messages in it
+        while (errorCodeOrLength > 0) {
+            privateMessageId.type = U_GNSS_PROTOCOL_ALL;
+            // Attempt to decode a message of any type from the ring buffer
+            startTimeUs = uPortGetTickTimeUs();
+            errorCodeOrLength = uGnssPrivateStreamDecodeRingBuffer(&(pInstance->ringBuffer),
+                                                                   pMsgReceive->ringBufferReadHandle,
+                                                                   &privateMessageId);
+            if ((errorCodeOrLength > 0) || (errorCodeOrLength == (int32_t) U_GNSS_ERROR_NACK)) {
+                updateStatsDecode(pStats, privateMessageId.type,
+                                  (int32_t) (uPortGetTickTimeUs() - startTimeUs));
+                // Remember how long the message is
+                pMsgReceive->msgBytesLeftToRead = 0;
+                if (errorCodeOrLength > 0) {
+                    pMsgReceive->msgBytesLeftToRead = errorCodeOrLength;
+                }
+
+                if (uGnssPrivateMessageIdToPublic(&privateMessageId, &messageId, nmeaId) == 0) {
+                    // Got something, with a message ID now in public form;
+                    // go through the list of readers looking for those interested
+
+                    U_PORT_MUTEX_LOCK(pMsgReceive->readerMutexHandle);
+
+                    // Only the readers that the index says might be
+                    // interested need be matched against the message
+                    candidates = indexCandidates(&(pMsgReceive->index), &privateMessageId);
+                    for (size_t x = 0; (candidates != 0) && (x < U_GNSS_MSG_RECEIVER_MAX_NUM); x++) {
+                        pReader = pMsgReceive->pReaderSlot[x];
+                        if (((candidates & (1UL << x)) != 0) && (pReader != NULL) &&
+                            !pReader->oneShotDone &&
+                            uGnssPrivateMessageIdIsWanted(&privateMessageId,
+                                                          &(pReader->privateMessageId))) {
+                            // This reader is interested, call the callback
+                            startTimeUs = uPortGetTickTimeUs();
+                            readerCall(pInstance, pReader, &messageId, errorCodeOrLength);
+                            updateStatsCallback(pStats, (int32_t) (startTimeUs - pMsgReceive->arrivalTimeUs),
+                                                (int32_t) (uPortGetTickTimeUs() - startTimeUs));
+                        }
+                        candidates &= ~(1UL << x);
+                    }
+                    if ((privateMessageId.type == U_GNSS_PROTOCOL_UBX) &&
+                        (privateMessageId.id.ubx == 0x0500) &&
+                        (errorCodeOrLength == U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES + 2)) {
+                        // UBX-ACK-NAK, which a one-shot reader may be waiting for
+                        oneShotNack(pInstance);
+                    }
+
+                    U_PORT_MUTEX_UNLOCK(pMsgReceive->readerMutexHandle);
+                }
+
+                // Clear out any remaining data
+                uRingBufferReadHandle(&(pInstance->ringBuffer),
+                                      pMsgReceive->ringBufferReadHandle, NULL,
+                                      pMsgReceive->msgBytesLeftToRead);
+            }
+        }
+        if (uRingBufferDataSizeHandle(&(pInstance->ringBuffer),
+                                      pMsgReceive->ringBufferReadHandle) == 0) {
+            // All caught up
+            pMsgReceive->arrivalTimeUs = -1;
+        }
+    }
+
+    // Tidy up any one-shot readers that are done or have timed out
+    oneShotReap(pInstance);
+
+    // Idle if we received nothing and aren't desperately seeking
+    // more data
+    return (receiveSize == 0) && (errorCodeOrLength != (int32_t) U_ERROR_COMMON_TIMEOUT);
+}
+
+#ifndef U_GNSS_MSG_RECEIVE_TASK_SHARED
+
+// Task that runs the non-blocking message receive.
+static void msgReceiveTask(void *pParam)
+{
+    uGnssPrivateInstance_t *pInstance = (uGnssPrivateInstance_t *) pParam;
+    char queueItem[U_GNSS_MSG_RECEIVE_TASK_QUEUE_ITEM_SIZE_BYTES];
+    uGnssPrivateMsgReceive_t *pMsgReceive = pInstance->pMsgReceive;
+    int32_t yieldTimeMs;
 
     U_PORT_MUTEX_LOCK(pMsgReceive->taskRunningMutexHandle);
 
@@ -159,86 +611,183 @@ static void msgReceiveTask(void *pParam)
     // Continue until we receive something on the queue, which
     // will cause us to exit
     while (uPortQueueTryReceive(pMsgReceive->taskExitQueueHandle, 0, queueItem) < 0) {
+        // Relax to let others in; relax for twice as long if there
+        // was nothing to do, in order to allow some data to build up
+        yieldTimeMs = U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS;
+        if (msgReceiveService(pInstance)) {
+            yieldTimeMs *= 2;
+        }
+        uPortTaskBlock(yieldTimeMs);
+    }
 
-        // Note that this does NOT lock gUGnssPrivateMutex: it doesn't need to,
-        // provided this task is brought up and torn down in an organised way
-
-        // Pull stuff into the ring buffer
-        receiveSize = uGnssPrivateStreamFillRingBuffer(pInstance, 0, 0);
-        // Deal with any discard from a previous run around this loop
-        discardSize -= uRingBufferReadHandle(&(pInstance->ringBuffer),
-                                             pMsgReceive->ringBufferReadHandle,
-                                             NULL, discardSize);
-        errorCodeOrLength = 0;
-        if (discardSize == 0) {
-            errorCodeOrLength = uRingBufferDataSizeHandle(&(pInstance->ringBuffer),
-                                                          pMsgReceive->ringBufferReadHandle);
-            // Run around a loop processing the data from the ring buffer
-            // for as long as we're still finding messages in it
-            while (errorCodeOrLength > 0) {
-                privateMessageId.type = U_GNSS_PROTOCOL_ALL;
-                // Attempt to decode a message of any type from the ring buffer
-                errorCodeOrLength = uGnssPrivateStreamDecodeRingBuffer(&(pInstance->ringBuffer),
-                                                                       pMsgReceive->ringBufferReadHandle,
-                                                                       &privateMessageId);
-                if ((errorCodeOrLength > 0) || (errorCodeOrLength == (int32_t) U_GNSS_ERROR_NACK)) {
-                    // Remember how long the message is
-                    pMsgReceive->msgBytesLeftToRead = 0;
-                    if (errorCodeOrLength > 0) {
-                        pMsgReceive->msgBytesLeftToRead = errorCodeOrLength;
-                    }
+    // Now we can unlock our ring buffer read handle.  Phew.
+    uRingBufferUnlockReadHandle(&(pInstance->ringBuffer),
+                                pMsgReceive->ringBufferReadHandle);
 
-                    if (uGnssPrivateMessageIdToPublic(&privateMessageId, &messageId, nmeaId) == 0) {
-                        // Got something, with a message ID now in public form;
-                        // go through the list of readers looking for those interested
-
-                        U_PORT_MUTEX_LOCK(pMsgReceive->readerMutexHandle);
-
-                        pReader = pMsgReceive->pReaderList;
-                        while (pReader != NULL) {
-                            if (uGnssPrivateMessageIdIsWanted(&privateMessageId,
-                                                              &(pReader->privateMessageId))) {
-                                // This reader is interested, call the callback
-                                ((uGnssMsgReceiveCallback_t) pReader->pCallback)(pInstance->gnssHandle,
-                                                                                 &messageId,
-                                                                                 errorCodeOrLength,
-                                                                                 pReader->pCallbackParam);
-                            }
-                            // Next!
-                            pReader = pReader->pNext;
-                        }
+    U_PORT_MUTEX_UNLOCK(pMsgReceive->taskRunningMutexHandle);
 
-                        U_PORT_MUTEX_UNLOCK(pMsgReceive->readerMutexHandle);
-                    }
+    // Delete ourself
+    uTaskRegistryTaskDelete(NULL);
+}
 
-                    // Clear out any remaining data
-                    uRingBufferReadHandle(&(pInstance->ringBuffer),
-                                          pMsgReceive->ringBufferReadHandle, NULL,
-                                          pMsgReceive->msgBytesLeftToRead);
-                }
+#else
+
+// Task that runs the non-blocking message receive for all of the
+// GNSS instances that have joined it.
+static void msgReceiveSharedTask(void *pParam)
+{
+    char queueItem[U_GNSS_MSG_RECEIVE_TASK_QUEUE_ITEM_SIZE_BYTES];
+    uGnssPrivateInstance_t *pFirst;
+    uGnssPrivateInstance_t *pInstance;
+    size_t count;
+    bool idle;
+    int32_t yieldTimeMs;
+
+    (void) pParam;
+
+    U_PORT_MUTEX_LOCK(gSharedTaskRunningMutexHandle);
+
+    // Continue until we receive something on the queue, which
+    // will cause us to exit
+    while (uPortQueueTryReceive(gSharedTaskExitQueueHandle, 0, queueItem) < 0) {
+        idle = true;
+
+        U_PORT_MUTEX_LOCK(gSharedMutexHandle);
+
+        count = 0;
+        for (pInstance = gpSharedList; pInstance != NULL;
+             pInstance = pInstance->pMsgReceive->pSharedNext) {
+            count++;
+        }
+        if (count > 0) {
+            // Service each instance once, starting with a different
+            // one each time around so that no instance is always
+            // kept waiting behind the others
+            gSharedFirst = (gSharedFirst + 1) % count;
+            pFirst = gpSharedList;
+            for (size_t x = 0; x < gSharedFirst; x++) {
+                pFirst = pFirst->pMsgReceive->pSharedNext;
             }
+            pInstance = pFirst;
+            do {
+                if (!msgReceiveService(pInstance)) {
+                    idle = false;
+                }
+                pInstance = pInstance->pMsgReceive->pSharedNext;
+                if (pInstance == NULL) {
+                    pInstance = gpSharedList;
+                }
+            } while (pInstance != pFirst);
         }
 
-        // Relax to let others in; relax for twice as long if we last
-        // received nothing and aren't desperately seeking more data,
-        // in order to allow some data to build up
+        U_PORT_MUTEX_UNLOCK(gSharedMutexHandle);
+
+        // Relax to let others in; relax for twice as long if no
+        // instance had anything to do
         yieldTimeMs = U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS;
-        if ((receiveSize == 0) && (errorCodeOrLength != (int32_t) U_ERROR_COMMON_TIMEOUT))  {
+        if (idle) {
             yieldTimeMs *= 2;
         }
         uPortTaskBlock(yieldTimeMs);
     }
 
-    // Now we can unlock our ring buffer read handle.  Phew.
-    uRingBufferUnlockReadHandle(&(pInstance->ringBuffer),
-                                pMsgReceive->ringBufferReadHandle);
-
-    U_PORT_MUTEX_UNLOCK(pMsgReceive->taskRunningMutexHandle);
+    U_PORT_MUTEX_UNLOCK(gSharedTaskRunningMutexHandle);
 
     // Delete ourself
-    uPortTaskDelete(NULL);
+    uTaskRegistryTaskDelete(NULL);
+}
+
+// Stop the shared message receive task, if it is running, and
+// free the OS resources that go with it.
+static void sharedStop()
+{
+    char queueItem[U_GNSS_MSG_RECEIVE_TASK_QUEUE_ITEM_SIZE_BYTES] = {0};
+
+    if (gSharedTaskHandle != NULL) {
+        // Sending the task anything will cause it to exit
+        uPortQueueSend(gSharedTaskExitQueueHandle, queueItem);
+        U_PORT_MUTEX_LOCK(gSharedTaskRunningMutexHandle);
+        U_PORT_MUTEX_UNLOCK(gSharedTaskRunningMutexHandle);
+        // Wait for the task to actually exit, see uGnssPrivateStopMsgReceive()
+        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+        gSharedTaskHandle = NULL;
+    }
+    if (gSharedTaskRunningMutexHandle != NULL) {
+        uPortMutexDelete(gSharedTaskRunningMutexHandle);
+        gSharedTaskRunningMutexHandle = NULL;
+    }
+    if (gSharedTaskExitQueueHandle != NULL) {
+        uPortQueueDelete(gSharedTaskExitQueueHandle);
+        gSharedTaskExitQueueHandle = NULL;
+    }
+    if (gSharedMutexHandle != NULL) {
+        uPortMutexDelete(gSharedMutexHandle);
+        gSharedMutexHandle = NULL;
+    }
+}
+
+// Add a GNSS instance to those serviced by the shared message
+// receive task, starting the task if it is not already running;
+// gUGnssPrivateMutex must be locked before this is called.
+static int32_t sharedJoin(uGnssPrivateInstance_t *pInstance)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    uGnssPrivateMsgReceive_t *pMsgReceive = pInstance->pMsgReceive;
+
+    if (gSharedTaskHandle == NULL) {
+        // Create the mutex that protects the list of instances
+        errorCode = uPortMutexCreate(&gSharedMutexHandle);
+        if (errorCode == 0) {
+            // Create the queue that allows us to get the task to exit
+            errorCode = uPortQueueCreate(U_GNSS_MSG_RECEIVE_TASK_QUEUE_LENGTH,
+                                         U_GNSS_MSG_RECEIVE_TASK_QUEUE_ITEM_SIZE_BYTES,
+                                         &gSharedTaskExitQueueHandle);
+            if (errorCode == 0) {
+                // Create the mutex for task running status
+                errorCode = uPortMutexCreate(&gSharedTaskRunningMutexHandle);
+                if (errorCode == 0) {
+                    //... and then the task
+                    errorCode = uTaskRegistryTaskCreate(msgReceiveSharedTask,
+                                                        "gnssMsgRx",
+                                                        U_GNSS_MSG_RECEIVE_TASK_STACK_SIZE_BYTES,
+                                                        NULL, U_GNSS_MSG_RECEIVE_TASK_PRIORITY,
+                                                        &gSharedTaskHandle);
+                    if (errorCode == 0) {
+                        // Wait for the task to lock the mutex,
+                        // which shows it is running
+                        while (uPortMutexTryLock(gSharedTaskRunningMutexHandle, 0) == 0) {
+                            uPortMutexUnlock(gSharedTaskRunningMutexHandle);
+                            uPortTaskBlock(U_CFG_OS_YIELD_MS);
+                        }
+                    } else {
+                        gSharedTaskHandle = NULL;
+                    }
+                }
+            }
+        }
+        if (errorCode != 0) {
+            // Tidy up if we couldn't get OS resources
+            sharedStop();
+        }
+    }
+
+    if (errorCode == 0) {
+        U_PORT_MUTEX_LOCK(gSharedMutexHandle);
+        // Lock our ring buffer read handle for as long as the
+        // shared task is looking after us
+        uRingBufferLockReadHandle(&(pInstance->ringBuffer),
+                                  pMsgReceive->ringBufferReadHandle);
+        pMsgReceive->pSharedNext = gpSharedList;
+        gpSharedList = pInstance;
+        pMsgReceive->taskHandle = gSharedTaskHandle;
+        U_PORT_MUTEX_UNLOCK(gSharedMutexHandle);
+    }
+
+    return errorCode;
 }
 
+#endif // #ifndef U_GNSS_MSG_RECEIVE_TASK_SHARED
+
 // Read a message from the ring buffer into a user's buffer.
 int32_t msgReceiveCallbackRead(uDeviceHandle_t gnssHandle,
                                char *pBuffer, size_t size,
@@ -277,6 +826,196 @@ int32_t msgReceiveCallbackRead(uDeviceHandle_t gnssHandle,
     return errorCodeOrLength;
 }
 
+// Start an asynchronous message reader, the engine of
+// uGnssMsgReceiveStart(), uGnssMsgReceiveStartSpan() and
+// uGnssMsgReceiveStartOneShot(); oneShotTimeoutMs should be
+// negative for anything other than a one-shot reader.
+static int32_t msgReceiveStart(uDeviceHandle_t gnssHandle,
+                               const uGnssMessageId_t *pMessageId,
+                               void *pCallback, bool spanCallback,
+                               void *pCallbackParam,
+                               int32_t oneShotTimeoutMs)
+{
+    int32_t errorCodeOrHandle = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPrivateMsgReceive_t *pMsgReceive;
+    uGnssPrivateMsgReader_t *pReader;
+    const char *pTaskName = "gnssMsgRx";
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCodeOrHandle = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pMessageId != NULL) && (pCallback != NULL)) {
+            errorCodeOrHandle = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pReader = (uGnssPrivateMsgReader_t *) pUPortMalloc(sizeof(uGnssPrivateMsgReader_t));
+            if (pReader != NULL) {
+                memset(pReader, 0, sizeof(*pReader));
+                // If the message receive task is not running
+                // at the moment, start it
+                if (pInstance->pMsgReceive == NULL) {
+                    pInstance->pMsgReceive = (uGnssPrivateMsgReceive_t *) pUPortMalloc(sizeof(
+                                                                                           uGnssPrivateMsgReceive_t));
+                    if (pInstance->pMsgReceive != NULL) {
+                        pMsgReceive = pInstance->pMsgReceive;
+                        memset(pMsgReceive, 0, sizeof(*pMsgReceive));
+                        pMsgReceive->arrivalTimeUs = -1;
+                        // Take a "master" read handle
+                        pMsgReceive->ringBufferReadHandle = uRingBufferTakeReadHandle(&(pInstance->ringBuffer));
+                        if (pMsgReceive->ringBufferReadHandle >= 0) {
+                            // Create the mutex that controls access to the linked-list of readers
+                            errorCodeOrHandle = uPortMutexCreate(&(pMsgReceive->readerMutexHandle));
+#ifdef U_GNSS_MSG_RECEIVE_TASK_SHARED
+                            if (errorCodeOrHandle == 0) {
+                                // Join the task that serves all instances
+                                (void) pTaskName;
+                                errorCodeOrHandle = sharedJoin(pInstance);
+                            }
+#else
+                            if (errorCodeOrHandle == 0) {
+                                // Create the queue that allows us to get the task to exit
+                                errorCodeOrHandle = uPortQueueCreate(U_GNSS_MSG_RECEIVE_TASK_QUEUE_LENGTH,
+                                                                     U_GNSS_MSG_RECEIVE_TASK_QUEUE_ITEM_SIZE_BYTES,
+                                                                     &(pMsgReceive->taskExitQueueHandle));
+                                if (errorCodeOrHandle == 0) {
+                                    // Create the mutex for task running status
+                                    errorCodeOrHandle = uPortMutexCreate(&(pMsgReceive->taskRunningMutexHandle));
+                                    if (errorCodeOrHandle == 0) {
+                                        //... and then the task
+                                        errorCodeOrHandle = uTaskRegistryTaskCreate(msgReceiveTask,
+                                                                                    pTaskName,
+                                                                                    U_GNSS_MSG_RECEIVE_TASK_STACK_SIZE_BYTES,
+                                                                                    pInstance, U_GNSS_MSG_RECEIVE_TASK_PRIORITY,
+                                                                                    &(pMsgReceive->taskHandle));
+                                        if (errorCodeOrHandle == 0) {
+                                            // Wait for the task to lock the mutex,
+                                            // which shows it is running
+                                            while (uPortMutexTryLock(pMsgReceive->taskRunningMutexHandle, 0) == 0) {
+                                                uPortMutexUnlock(pMsgReceive->taskRunningMutexHandle);
+                                                uPortTaskBlock(U_CFG_OS_YIELD_MS);
+                                            }
+                                        }
+                                    }
+                                }
+                            }
+#endif
+                            if (errorCodeOrHandle != 0) {
+                                // Tidy up if we couldn't get OS resources
+                                if (pMsgReceive->taskHandle != NULL) {
+                                    uTaskRegistryTaskDelete(pMsgReceive->taskHandle);
+                                }
+                                if (pMsgReceive->taskRunningMutexHandle != NULL) {
+                                    uPortMutexDelete(pMsgReceive->taskRunningMutexHandle);
+                                }
+                                if (pMsgReceive->taskExitQueueHandle != NULL) {
+                                    uPortQueueDelete(pMsgReceive->taskExitQueueHandle);
+                                }
+                                if (pMsgReceive->readerMutexHandle != NULL) {
+                                    uPortMutexDelete(pMsgReceive->readerMutexHandle);
+                                }
+                                uRingBufferGiveReadHandle(&(pInstance->ringBuffer),
+                                                          pMsgReceive->ringBufferReadHandle);
+                                uPortFree(pInstance->pMsgReceive);
+                                pInstance->pMsgReceive = NULL;
+                            }
+                        } else {
+                            // Out of handles already
+                            uPortFree(pInstance->pMsgReceive);
+                            pInstance->pMsgReceive = NULL;
+                        }
+                    }
+                }
+                if (pInstance->pMsgReceive == NULL) {
+                    // Clean up on error
+                    uPortFree(pReader);
+                    pReader = NULL;
+                }
+            }
+            if (pReader != NULL) {
+                // The task etc. must be running, we have a read handle,
+                // now populate the rest of the reader structure
+                // and add it to the front of the list
+                pMsgReceive = pInstance->pMsgReceive;
+                uGnssPrivateMessageIdToPrivate(pMessageId, &(pReader->privateMessageId));
+                pReader->pCallback = pCallback;
+                pReader->spanCallback = spanCallback;
+                pReader->pCallbackParam = pCallbackParam;
+                if (oneShotTimeoutMs >= 0) {
+                    pReader->oneShot = true;
+                    pReader->oneShotStartTimeMs = uPortGetTickTimeMs();
+                    pReader->oneShotTimeoutMs = oneShotTimeoutMs;
+                }
+
+                U_PORT_MUTEX_LOCK(pMsgReceive->readerMutexHandle);
+
+                // Find a free slot for the reader in the index
+                errorCodeOrHandle = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                for (size_t x = 0; (errorCodeOrHandle < 0) && (x < U_GNSS_MSG_RECEIVER_MAX_NUM); x++) {
+                    if (pMsgReceive->pReaderSlot[x] == NULL) {
+                        pReader->slot = x;
+                        pReader->handle = pMsgReceive->nextHandle;
+                        pMsgReceive->nextHandle++;
+                        pReader->pNext = pMsgReceive->pReaderList;
+                        pMsgReceive->pReaderList = pReader;
+                        pMsgReceive->pReaderSlot[x] = pReader;
+                        indexRebuild(pMsgReceive);
+                        // Return the handle
+                        errorCodeOrHandle = pReader->handle;
+                    }
+                }
+
+                U_PORT_MUTEX_UNLOCK(pMsgReceive->readerMutexHandle);
+
+                if (errorCodeOrHandle < 0) {
+                    // Already have the maximum number of readers
+                    uPortFree(pReader);
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCodeOrHandle;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS THAT ARE PRIVATE TO GNSS
+ * -------------------------------------------------------------- */
+
+#ifdef U_GNSS_MSG_RECEIVE_TASK_SHARED
+// Take a GNSS instance out of the shared message receive task.
+void uGnssPrivateMsgReceiveSharedLeave(uGnssPrivateInstance_t *pInstance)
+{
+    uGnssPrivateMsgReceive_t *pMsgReceive = pInstance->pMsgReceive;
+    uGnssPrivateInstance_t **ppThis;
+
+    if ((pMsgReceive != NULL) && (gSharedMutexHandle != NULL)) {
+        // Once we have the mutex the shared task cannot be
+        // in the middle of servicing this instance
+        U_PORT_MUTEX_LOCK(gSharedMutexHandle);
+        ppThis = &gpSharedList;
+        while ((*ppThis != NULL) && (*ppThis != pInstance)) {
+            ppThis = &((*ppThis)->pMsgReceive->pSharedNext);
+        }
+        if (*ppThis != NULL) {
+            *ppThis = pMsgReceive->pSharedNext;
+            uRingBufferUnlockReadHandle(&(pInstance->ringBuffer),
+                                        pMsgReceive->ringBufferReadHandle);
+        }
+        pMsgReceive->pSharedNext = NULL;
+        pMsgReceive->taskHandle = NULL;
+        U_PORT_MUTEX_UNLOCK(gSharedMutexHandle);
+        if (gpSharedList == NULL) {
+            // Last one out turns off the lights
+            sharedStop();
+        }
+    }
+}
+#endif
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: MISC
  * -------------------------------------------------------------- */
@@ -352,6 +1091,7 @@ int32_t uGnssMsgSend(uDeviceHandle_t gnssHandle, const char *pBuffer, size_t siz
     uGnssPrivateInstance_t *pInstance;
     int32_t streamType;
     int32_t streamHandle = -1;
+    uGnssVirtualSerial_t *pVirtualSerial = NULL;
 
     if (gUGnssPrivateMutex != NULL) {
 
@@ -373,6 +1113,12 @@ int32_t uGnssMsgSend(uDeviceHandle_t gnssHandle, const char *pBuffer, size_t siz
                 case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
                     streamHandle = pInstance->transportHandle.i2c;
                     break;
+                case U_GNSS_PRIVATE_STREAM_TYPE_VIRTUAL_SERIAL:
+                    // No integer handle here, the virtual serial
+                    // functions are reached through pInstance
+                    streamHandle = 0;
+                    pVirtualSerial = pInstance->transportHandle.pVirtualSerial;
+                    break;
                 default:
                     break;
             }
@@ -392,10 +1138,20 @@ int32_t uGnssMsgSend(uDeviceHandle_t gnssHandle, const char *pBuffer, size_t siz
                             errorCodeOrLength = (int32_t) size;
                         }
                         break;
+                    case U_GNSS_PRIVATE_STREAM_TYPE_VIRTUAL_SERIAL:
+                        errorCodeOrLength = pVirtualSerial->pWrite(pVirtualSerial,
+                                                                   pBuffer, size);
+                        break;
                     default:
                         break;
                 }
                 if (errorCodeOrLength == size) {
+                    if ((size > 2) && (*pBuffer == (char) 0xb5) &&
+                        (*(pBuffer + 1) == 0x62) && (*(pBuffer + 2) == 0x06)) {
+                        // A UBX-CFG message from the application may
+                        // change anything, so empty the configuration cache
+                        uGnssPrivateCfgCacheInvalidate(pInstance);
+                    }
                     if (pInstance->printUbxMessages) {
                         uPortLog("U_GNSS: sent message");
                         uGnssPrivatePrintBuffer(pBuffer, size);
@@ -445,130 +1201,65 @@ int32_t uGnssMsgReceive(uDeviceHandle_t gnssHandle,
     return errorCodeOrLength;
 }
 
-// Monitor the output of the GNSS chip for a message, async version.
-int32_t uGnssMsgReceiveStart(uDeviceHandle_t gnssHandle,
-                             const uGnssMessageId_t *pMessageId,
-                             uGnssMsgReceiveCallback_t pCallback,
-                             void *pCallbackParam)
+// Poll several UBX messages in one go.
+int32_t uGnssMsgPollUbx(uDeviceHandle_t gnssHandle,
+                        uGnssMsgUbxPoll_t *pPoll, size_t numPolls,
+                        int32_t timeoutMs)
 {
-    int32_t errorCodeOrHandle = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uGnssPrivateInstance_t *pInstance;
-    uGnssPrivateMsgReceive_t *pMsgReceive;
-    uGnssPrivateMsgReader_t *pReader;
-    const char *pTaskName = "gnssMsgRx";
 
     if (gUGnssPrivateMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
 
-        errorCodeOrHandle = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         pInstance = pUGnssPrivateGetInstance(gnssHandle);
-        if ((pInstance != NULL) && (pMessageId != NULL) && (pCallback != NULL)) {
-            errorCodeOrHandle = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-            pReader = (uGnssPrivateMsgReader_t *) pUPortMalloc(sizeof(uGnssPrivateMsgReader_t));
-            if (pReader != NULL) {
-                memset(pReader, 0, sizeof(*pReader));
-                // If the message receive task is not running
-                // at the moment, start it
-                if (pInstance->pMsgReceive == NULL) {
-                    pInstance->pMsgReceive = (uGnssPrivateMsgReceive_t *) pUPortMalloc(sizeof(
-                                                                                           uGnssPrivateMsgReceive_t));
-                    if (pInstance->pMsgReceive != NULL) {
-                        pMsgReceive = pInstance->pMsgReceive;
-                        memset(pMsgReceive, 0, sizeof(*pMsgReceive));
-                        // Take a "master" read handle
-                        pMsgReceive->ringBufferReadHandle = uRingBufferTakeReadHandle(&(pInstance->ringBuffer));
-                        if (pMsgReceive->ringBufferReadHandle >= 0) {
-                            // Allocate a temporary buffer that we can use to pull data
-                            // from the streaming source into the ring-buffer from our
-                            // asynchronous task
-                            pMsgReceive->pTemporaryBuffer = (char *) pUPortMalloc(U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES);
-                            if (pMsgReceive->pTemporaryBuffer != NULL) {
-                                // Create the mutex that controls access to the linked-list of readers
-                                errorCodeOrHandle = uPortMutexCreate(&(pMsgReceive->readerMutexHandle));
-                                if (errorCodeOrHandle == 0) {
-                                    // Create the queue that allows us to get the task to exit
-                                    errorCodeOrHandle = uPortQueueCreate(U_GNSS_MSG_RECEIVE_TASK_QUEUE_LENGTH,
-                                                                         U_GNSS_MSG_RECEIVE_TASK_QUEUE_ITEM_SIZE_BYTES,
-                                                                         &(pMsgReceive->taskExitQueueHandle));
-                                    if (errorCodeOrHandle == 0) {
-                                        // Create the mutex for task running status
-                                        errorCodeOrHandle = uPortMutexCreate(&(pMsgReceive->taskRunningMutexHandle));
-                                        if (errorCodeOrHandle == 0) {
-                                            //... and then the task
-                                            errorCodeOrHandle = uPortTaskCreate(msgReceiveTask,
-                                                                                pTaskName,
-                                                                                U_GNSS_MSG_RECEIVE_TASK_STACK_SIZE_BYTES,
-                                                                                pInstance, U_GNSS_MSG_RECEIVE_TASK_PRIORITY,
-                                                                                &(pMsgReceive->taskHandle));
-                                            if (errorCodeOrHandle == 0) {
-                                                // Wait for the task to lock the mutex,
-                                                // which shows it is running
-                                                while (uPortMutexTryLock(pMsgReceive->taskRunningMutexHandle, 0) == 0) {
-                                                    uPortMutexUnlock(pMsgReceive->taskRunningMutexHandle);
-                                                    uPortTaskBlock(U_CFG_OS_YIELD_MS);
-                                                }
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                            if (errorCodeOrHandle != 0) {
-                                // Tidy up if we couldn't get OS resources
-                                if (pMsgReceive->taskHandle != NULL) {
-                                    uPortTaskDelete(msgReceiveTask);
-                                }
-                                if (pMsgReceive->taskRunningMutexHandle != NULL) {
-                                    uPortMutexDelete(pMsgReceive->taskRunningMutexHandle);
-                                }
-                                if (pMsgReceive->taskExitQueueHandle != NULL) {
-                                    uPortQueueDelete(pMsgReceive->taskExitQueueHandle);
-                                }
-                                if (pMsgReceive->readerMutexHandle != NULL) {
-                                    uPortMutexDelete(pMsgReceive->readerMutexHandle);
-                                }
-                                uPortFree(pInstance->pTemporaryBuffer);
-                                uRingBufferGiveReadHandle(&(pInstance->ringBuffer),
-                                                          pMsgReceive->ringBufferReadHandle);
-                                uPortFree(pInstance->pMsgReceive);
-                                pInstance->pMsgReceive = NULL;
-                            }
-                        } else {
-                            // Out of handles already
-                            uPortFree(pInstance->pMsgReceive);
-                            pInstance->pMsgReceive = NULL;
-                        }
-                    }
-                }
-                if (pInstance->pMsgReceive == NULL) {
-                    // Clean up on error
-                    uPortFree(pReader);
-                    pReader = NULL;
-                }
-            }
-            if (pReader != NULL) {
-                // The task etc. must be running, we have a read handle,
-                // now populate the rest of the reader structure
-                // and add it to the front of the list
-                pReader->handle = pInstance->pMsgReceive->nextHandle;
-                pInstance->pMsgReceive->nextHandle++;
-                uGnssPrivateMessageIdToPrivate(pMessageId, &(pReader->privateMessageId));
-                pReader->pCallback = (void *) pCallback;
-                pReader->pCallbackParam = pCallbackParam;
-                pReader->pNext = pInstance->pMsgReceive->pReaderList;
+        if (pInstance != NULL) {
+            errorCodeOrCount = uGnssPrivateSendReceiveUbxMessageBatch(pInstance,
+                                                                      pPoll, numPolls,
+                                                                      timeoutMs);
+        }
 
-                U_PORT_MUTEX_LOCK(pInstance->pMsgReceive->readerMutexHandle);
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
 
-                pInstance->pMsgReceive->pReaderList = pReader;
+    return errorCodeOrCount;
+}
 
-                U_PORT_MUTEX_UNLOCK(pInstance->pMsgReceive->readerMutexHandle);
+// Monitor the output of the GNSS chip for a message, async version.
+int32_t uGnssMsgReceiveStart(uDeviceHandle_t gnssHandle,
+                             const uGnssMessageId_t *pMessageId,
+                             uGnssMsgReceiveCallback_t pCallback,
+                             void *pCallbackParam)
+{
+    return msgReceiveStart(gnssHandle, pMessageId, (void *) pCallback,
+                           false, pCallbackParam, -1);
+}
 
-                // Return the handle
-                errorCodeOrHandle = pReader->handle;
-            }
-        }
+// Monitor the output of the GNSS chip for a message, async zero-copy
+// version.
+int32_t uGnssMsgReceiveStartSpan(uDeviceHandle_t gnssHandle,
+                                 const uGnssMessageId_t *pMessageId,
+                                 uGnssMsgReceiveSpanCallback_t pCallback,
+                                 void *pCallbackParam)
+{
+    return msgReceiveStart(gnssHandle, pMessageId, (void *) pCallback,
+                           true, pCallbackParam, -1);
+}
 
-        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+// Monitor the output of the GNSS chip for a single message.
+int32_t uGnssMsgReceiveStartOneShot(uDeviceHandle_t gnssHandle,
+                                    const uGnssMessageId_t *pMessageId,
+                                    uGnssMsgReceiveOneShotCallback_t pCallback,
+                                    void *pCallbackParam,
+                                    int32_t timeoutMs)
+{
+    int32_t errorCodeOrHandle = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (timeoutMs >= 0) {
+        errorCodeOrHandle = msgReceiveStart(gnssHandle, pMessageId, (void *) pCallback,
+                                            false, pCallbackParam, timeoutMs);
     }
 
     return errorCodeOrHandle;
@@ -602,8 +1293,6 @@ int32_t uGnssMsgReceiveStop(uDeviceHandle_t gnssHandle, int32_t asyncHandle)
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uGnssPrivateInstance_t *pInstance;
     uGnssPrivateMsgReceive_t *pMsgReceive;
-    uGnssPrivateMsgReader_t *pCurrent;
-    uGnssPrivateMsgReader_t *pPrev = NULL;
 
     if (gUGnssPrivateMutex != NULL) {
 
@@ -620,21 +1309,8 @@ int32_t uGnssMsgReceiveStop(uDeviceHandle_t gnssHandle, int32_t asyncHandle)
 
                 // Remove the entry from the list
                 errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
-                pCurrent = pMsgReceive->pReaderList;
-                while (pCurrent != NULL) {
-                    if (pCurrent->handle == asyncHandle) {
-                        if (pPrev != NULL) {
-                            pPrev->pNext = pCurrent->pNext;
-                        } else {
-                            pMsgReceive->pReaderList = pCurrent->pNext;
-                        }
-                        uPortFree(pCurrent);
-                        pCurrent = NULL;
-                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-                    } else {
-                        pPrev = pCurrent;
-                        pCurrent = pPrev->pNext;
-                    }
+                if (readerRemove(pMsgReceive, asyncHandle)) {
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                 }
 
                 U_PORT_MUTEX_UNLOCK(pMsgReceive->readerMutexHandle);
@@ -742,4 +1418,60 @@ size_t uGnssMsgReceiveStatStreamLoss(uDeviceHandle_t gnssHandle)
     return bytesLost;
 }
 
+// Get the transport statistics.
+int32_t uGnssMsgReceiveStatGet(uDeviceHandle_t gnssHandle,
+                               uGnssMsgStats_t *pStats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pStats != NULL)) {
+            *pStats = pInstance->stats;
+            pStats->periodMs = 0;
+            pStats->bytesPerSecond = 0;
+            if (pStats->bytesReceived > 0) {
+                pStats->periodMs = uPortGetTickTimeMs() - pInstance->statsStartTimeMs;
+                if (pStats->periodMs > 0) {
+                    pStats->bytesPerSecond = (int32_t) (((uint64_t) pStats->bytesReceived) * 1000 /
+                                                        pStats->periodMs);
+                }
+            }
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Reset the transport statistics.
+int32_t uGnssMsgReceiveStatReset(uDeviceHandle_t gnssHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            memset(&(pInstance->stats), 0, sizeof(pInstance->stats));
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
 // End of file
@@ -0,0 +1,521 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief This source file contains the implementation of the
+ * field-indexed NMEA sentence functions of the GNSS API, see
+ * u_gnss_msg_nmea.h.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // strlen()
+
+#include "u_error_common.h"
+
+#include "u_device.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss.h"    // U_GNSS_ERROR_CRC
+#include "u_gnss_msg_nmea.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The number of decimal places of a minute that are used when
+ * converting a latitude/longitude; seven is enough for 1e-7
+ * degree resolution.
+ */
+#define U_GNSS_MSG_NMEA_MINUTES_DECIMAL_PLACES 7
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Get the character at the given offset into the sentence, which
+// must be within the sentence.
+static char charAt(const uGnssMsgNmea_t *pNmea, size_t offset)
+{
+    if (offset < pNmea->span[0].length) {
+        return *(pNmea->span[0].pData + offset);
+    }
+
+    return *(pNmea->span[1].pData + offset - pNmea->span[0].length);
+}
+
+// Convert a hex character to a value, -1 if it is not hex.
+static int32_t hexValue(char c)
+{
+    int32_t value = -1;
+
+    if ((c >= '0') && (c <= '9')) {
+        value = c - '0';
+    } else if ((c >= 'A') && (c <= 'F')) {
+        value = c - 'A' + 10;
+    } else if ((c >= 'a') && (c <= 'f')) {
+        value = c - 'a' + 10;
+    }
+
+    return value;
+}
+
+// Index the sentence in pNmea->span[], which must already be
+// populated: check the '$', find the '*', check the checksum and
+// record the start of each field.
+static int32_t indexSentence(uGnssMsgNmea_t *pNmea)
+{
+    int32_t errorCodeOrNumFields = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    size_t size = pNmea->span[0].length + pNmea->span[1].length;
+    uint8_t checksum = 0;
+    int32_t high;
+    int32_t low;
+    char c;
+
+    if (size > UINT16_MAX) {
+        // Not an NMEA sentence, can't index it
+        size = 0;
+    }
+    pNmea->numFields = 0;
+    if ((size > 0) && (charAt(pNmea, 0) == '$')) {
+        pNmea->fieldOffset[0] = 1;
+        for (size_t x = 1; (x < size) &&
+             (errorCodeOrNumFields == (int32_t) U_ERROR_COMMON_INVALID_PARAMETER); x++) {
+            c = charAt(pNmea, x);
+            if ((c == ',') || (c == '*')) {
+                if (pNmea->numFields < U_GNSS_MSG_NMEA_MAX_NUM_FIELDS) {
+                    pNmea->numFields++;
+                    pNmea->fieldOffset[pNmea->numFields] = (uint16_t) (x + 1);
+                }
+            }
+            if (c == '*') {
+                // Two hex digits of checksum must follow
+                if (x + 2 < size) {
+                    high = hexValue(charAt(pNmea, x + 1));
+                    low = hexValue(charAt(pNmea, x + 2));
+                    if ((high >= 0) && (low >= 0)) {
+                        errorCodeOrNumFields = (int32_t) U_GNSS_ERROR_CRC;
+                        if (((high << 4) | low) == checksum) {
+                            errorCodeOrNumFields = (int32_t) pNmea->numFields;
+                        }
+                    }
+                }
+                // Either way, that's the end
+                break;
+            }
+            checksum ^= (uint8_t) c;
+        }
+    }
+
+    if (errorCodeOrNumFields < 0) {
+        pNmea->numFields = 0;
+    }
+
+    return errorCodeOrNumFields;
+}
+
+// Get the offset and length of a field.
+static int32_t field(const uGnssMsgNmea_t *pNmea, size_t fieldIndex,
+                     size_t *pOffset)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pNmea != NULL) && (fieldIndex < pNmea->numFields)) {
+        *pOffset = pNmea->fieldOffset[fieldIndex];
+        errorCodeOrLength = (int32_t) pNmea->fieldOffset[fieldIndex + 1] -
+                            pNmea->fieldOffset[fieldIndex] - 1;
+    }
+
+    return errorCodeOrLength;
+}
+
+// Parse an unsigned decimal number of at most maxNumDigits digits
+// from offset, stopping at the first non-digit or at end, returning
+// the number of digits parsed.
+static size_t parseDigits(const uGnssMsgNmea_t *pNmea, size_t offset,
+                          size_t end, size_t maxNumDigits,
+                          int64_t *pValue)
+{
+    size_t numDigits = 0;
+    char c;
+
+    *pValue = 0;
+    for (; (offset < end) && (numDigits < maxNumDigits); offset++) {
+        c = charAt(pNmea, offset);
+        if ((c < '0') || (c > '9')) {
+            break;
+        }
+        *pValue = (*pValue * 10) + (c - '0');
+        numDigits++;
+    }
+
+    return numDigits;
+}
+
+// Parse an unsigned decimal fraction, the offset being that of the
+// '.' (if there is one), scaled to numDecimalPlaces; extra digits
+// are ignored and missing ones are taken as zero.
+static int64_t parseFraction(const uGnssMsgNmea_t *pNmea, size_t offset,
+                             size_t end, size_t numDecimalPlaces)
+{
+    int64_t value = 0;
+    size_t numDigits = 0;
+
+    if ((offset < end) && (charAt(pNmea, offset) == '.')) {
+        numDigits = parseDigits(pNmea, offset + 1, end, numDecimalPlaces, &value);
+    }
+    for (; numDigits < numDecimalPlaces; numDigits++) {
+        value *= 10;
+    }
+
+    return value;
+}
+
+// Map an NMEA position mode indicator character to a fix quality.
+static int32_t modeToFixQuality(char mode)
+{
+    int32_t fixQuality = (int32_t) U_GNSS_MSG_NMEA_FIX_QUALITY_NONE;
+
+    switch (mode) {
+        case 'A':
+            fixQuality = (int32_t) U_GNSS_MSG_NMEA_FIX_QUALITY_AUTONOMOUS;
+            break;
+        case 'D':
+            fixQuality = (int32_t) U_GNSS_MSG_NMEA_FIX_QUALITY_DIFFERENTIAL;
+            break;
+        case 'R':
+            fixQuality = (int32_t) U_GNSS_MSG_NMEA_FIX_QUALITY_RTK_FIXED;
+            break;
+        case 'F':
+            fixQuality = (int32_t) U_GNSS_MSG_NMEA_FIX_QUALITY_RTK_FLOAT;
+            break;
+        case 'E':
+            fixQuality = (int32_t) U_GNSS_MSG_NMEA_FIX_QUALITY_ESTIMATED;
+            break;
+        default:
+            break;
+    }
+
+    return fixQuality;
+}
+
+// Rank a fix quality so that the best of several can be chosen.
+static int32_t fixQualityRank(int32_t fixQuality)
+{
+    int32_t rank = 0;
+
+    switch (fixQuality) {
+        case U_GNSS_MSG_NMEA_FIX_QUALITY_ESTIMATED:
+            rank = 1;
+            break;
+        case U_GNSS_MSG_NMEA_FIX_QUALITY_AUTONOMOUS:
+            rank = 2;
+            break;
+        case U_GNSS_MSG_NMEA_FIX_QUALITY_DIFFERENTIAL:
+            rank = 3;
+            break;
+        case U_GNSS_MSG_NMEA_FIX_QUALITY_RTK_FLOAT:
+            rank = 4;
+            break;
+        case U_GNSS_MSG_NMEA_FIX_QUALITY_RTK_FIXED:
+            rank = 5;
+            break;
+        default:
+            break;
+    }
+
+    return rank;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Index an NMEA sentence in a single buffer.
+int32_t uGnssMsgNmeaIndex(const char *pBuffer, size_t size,
+                          uGnssMsgNmea_t *pNmea)
+{
+    int32_t errorCodeOrNumFields = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pBuffer != NULL) && (pNmea != NULL)) {
+        pNmea->span[0].pData = pBuffer;
+        pNmea->span[0].length = size;
+        pNmea->span[1].pData = NULL;
+        pNmea->span[1].length = 0;
+        errorCodeOrNumFields = indexSentence(pNmea);
+    }
+
+    return errorCodeOrNumFields;
+}
+
+// Index an NMEA sentence split across two spans.
+int32_t uGnssMsgNmeaIndexSpan(const uRingBufferSpan_t *pSpan,
+                              uGnssMsgNmea_t *pNmea)
+{
+    int32_t errorCodeOrNumFields = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pSpan != NULL) && (pNmea != NULL) &&
+        ((pSpan->pData != NULL) || (pSpan->length == 0)) &&
+        (((pSpan + 1)->pData != NULL) || ((pSpan + 1)->length == 0))) {
+        pNmea->span[0] = *pSpan;
+        pNmea->span[1] = *(pSpan + 1);
+        errorCodeOrNumFields = indexSentence(pNmea);
+    }
+
+    return errorCodeOrNumFields;
+}
+
+// Check the sentence formatter.
+bool uGnssMsgNmeaIsType(const uGnssMsgNmea_t *pNmea, const char *pFormatter)
+{
+    bool isType = false;
+    size_t offset = 0;
+    int32_t length = field(pNmea, 0, &offset);
+    size_t formatterLength;
+
+    if ((length > 0) && (pFormatter != NULL)) {
+        formatterLength = strlen(pFormatter);
+        if ((formatterLength > 0) && ((size_t) length >= formatterLength)) {
+            // Compare the end of the address field
+            offset += (size_t) length - formatterLength;
+            isType = true;
+            for (size_t x = 0; isType && (x < formatterLength); x++) {
+                isType = (charAt(pNmea, offset + x) == *(pFormatter + x));
+            }
+        }
+    }
+
+    return isType;
+}
+
+// Get a pointer to a field in place.
+int32_t uGnssMsgNmeaField(const uGnssMsgNmea_t *pNmea, size_t fieldIndex,
+                          const char **ppField)
+{
+    size_t offset = 0;
+    int32_t errorCodeOrLength = field(pNmea, fieldIndex, &offset);
+
+    if (errorCodeOrLength >= 0) {
+        if (ppField == NULL) {
+            errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        } else if (offset + (size_t) errorCodeOrLength <= pNmea->span[0].length) {
+            *ppField = pNmea->span[0].pData + offset;
+        } else if (offset >= pNmea->span[0].length) {
+            *ppField = pNmea->span[1].pData + offset - pNmea->span[0].length;
+        } else {
+            // Straddles the two spans
+            errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
+// Copy a field out and null-terminate it.
+int32_t uGnssMsgNmeaFieldCopy(const uGnssMsgNmea_t *pNmea, size_t fieldIndex,
+                              char *pBuffer, size_t size)
+{
+    size_t offset = 0;
+    int32_t errorCodeOrLength = field(pNmea, fieldIndex, &offset);
+
+    if (errorCodeOrLength >= 0) {
+        if (pBuffer == NULL) {
+            errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        } else if ((size_t) errorCodeOrLength >= size) {
+            errorCodeOrLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        } else {
+            for (int32_t x = 0; x < errorCodeOrLength; x++) {
+                *(pBuffer + x) = charAt(pNmea, offset + x);
+            }
+            *(pBuffer + errorCodeOrLength) = 0;
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
+// Get an integer field.
+int32_t uGnssMsgNmeaGetInt(const uGnssMsgNmea_t *pNmea, size_t fieldIndex,
+                           int32_t *pValue)
+{
+    size_t offset = 0;
+    int32_t errorCode = field(pNmea, fieldIndex, &offset);
+    size_t end = offset + (size_t) errorCode;
+    bool negative = false;
+    int64_t value;
+
+    if (errorCode == 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+    } else if (errorCode > 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pValue != NULL) {
+            if ((charAt(pNmea, offset) == '-') || (charAt(pNmea, offset) == '+')) {
+                negative = (charAt(pNmea, offset) == '-');
+                offset++;
+            }
+            // Nine digits can't overflow an int32_t
+            if (parseDigits(pNmea, offset, end, 9, &value) > 0) {
+                if (negative) {
+                    value = -value;
+                }
+                *pValue = (int32_t) value;
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Get a latitude or longitude.
+int32_t uGnssMsgNmeaGetLatLong(const uGnssMsgNmea_t *pNmea, size_t fieldIndex,
+                               int32_t *pX1e7)
+{
+    size_t offset = 0;
+    size_t hemisphereOffset = 0;
+    int32_t errorCode = field(pNmea, fieldIndex, &offset);
+    int32_t hemisphereLength = field(pNmea, fieldIndex + 1, &hemisphereOffset);
+    size_t end = offset + (size_t) errorCode;
+    size_t numDigits;
+    int64_t degreesMinutes;
+    int64_t value;
+    char hemisphere;
+
+    if (hemisphereLength < 0) {
+        errorCode = hemisphereLength;
+    }
+    if ((errorCode == 0) || (hemisphereLength == 0)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+    } else if (errorCode > 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        hemisphere = charAt(pNmea, hemisphereOffset);
+        // Four digits for latitude (ddmm), five for longitude (dddmm)
+        numDigits = parseDigits(pNmea, offset, end, 5, &degreesMinutes);
+        if ((pX1e7 != NULL) && (numDigits >= 4) &&
+            ((hemisphere == 'N') || (hemisphere == 'S') ||
+             (hemisphere == 'E') || (hemisphere == 'W'))) {
+            // Minutes, scaled to the decimal places, then to degrees
+            value = ((degreesMinutes % 100) * 10000000LL) +
+                    parseFraction(pNmea, offset + numDigits, end,
+                                  U_GNSS_MSG_NMEA_MINUTES_DECIMAL_PLACES);
+            value = ((degreesMinutes / 100) * 10000000LL) + ((value + 30) / 60);
+            if ((hemisphere == 'S') || (hemisphere == 'W')) {
+                value = -value;
+            }
+            *pX1e7 = (int32_t) value;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Get a UTC time of day.
+int32_t uGnssMsgNmeaGetTimeOfDayMs(const uGnssMsgNmea_t *pNmea, size_t fieldIndex,
+                                   int32_t *pMs)
+{
+    size_t offset = 0;
+    int32_t errorCode = field(pNmea, fieldIndex, &offset);
+    size_t end = offset + (size_t) errorCode;
+    int64_t hhmmss;
+    int64_t hours;
+    int64_t minutes;
+    int64_t seconds;
+
+    if (errorCode == 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+    } else if (errorCode > 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pMs != NULL) && (parseDigits(pNmea, offset, end, 6, &hhmmss) == 6)) {
+            hours = hhmmss / 10000;
+            minutes = (hhmmss / 100) % 100;
+            seconds = hhmmss % 100;
+            // Allow 60 seconds for a leap second
+            if ((hours < 24) && (minutes < 60) && (seconds <= 60)) {
+                *pMs = (int32_t) ((((hours * 60) + minutes) * 60 + seconds) * 1000 +
+                                  parseFraction(pNmea, offset + 6, end, 3));
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Get the fix quality.
+int32_t uGnssMsgNmeaGetFixQuality(const uGnssMsgNmea_t *pNmea)
+{
+    int32_t errorCodeOrFixQuality = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int32_t fixQuality;
+    size_t offset = 0;
+    int32_t length;
+
+    if (pNmea != NULL) {
+        errorCodeOrFixQuality = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+        if (uGnssMsgNmeaIsType(pNmea, "GGA")) {
+            // The GGA quality field is already what we want
+            errorCodeOrFixQuality = uGnssMsgNmeaGetInt(pNmea, 6, &fixQuality);
+            if (errorCodeOrFixQuality == 0) {
+                errorCodeOrFixQuality = fixQuality;
+            }
+        } else if (uGnssMsgNmeaIsType(pNmea, "RMC") ||
+                   uGnssMsgNmeaIsType(pNmea, "GLL") ||
+                   uGnssMsgNmeaIsType(pNmea, "GNS")) {
+            // A position mode indicator: GNS has one character
+            // per constellation, of which the best is taken
+            length = field(pNmea, uGnssMsgNmeaIsType(pNmea, "RMC") ? 12 :
+                           uGnssMsgNmeaIsType(pNmea, "GLL") ? 7 : 6,
+                           &offset);
+            errorCodeOrFixQuality = length;
+            if (length == 0) {
+                // Older NMEA versions have no position mode indicator
+                errorCodeOrFixQuality = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+            } else if (length > 0) {
+                errorCodeOrFixQuality = (int32_t) U_GNSS_MSG_NMEA_FIX_QUALITY_NONE;
+                for (int32_t x = 0; x < length; x++) {
+                    fixQuality = modeToFixQuality(charAt(pNmea, offset + x));
+                    if (fixQualityRank(fixQuality) > fixQualityRank(errorCodeOrFixQuality)) {
+                        errorCodeOrFixQuality = fixQuality;
+                    }
+                }
+            }
+        }
+    }
+
+    return errorCodeOrFixQuality;
+}
+
+// End of file
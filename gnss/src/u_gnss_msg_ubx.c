@@ -0,0 +1,118 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief This source file contains the implementation of the in-place
+ * UBX message decode functions of the GNSS API, see u_gnss_msg_ubx.h.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+
+#include "u_gnss_msg_ubx.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Check that pMessage contains an entire UBX message with the given
+// class/ID and return the length of its body, else -1.
+static int32_t bodyLength(const char *pMessage, size_t size,
+                          uint16_t messageId)
+{
+    int32_t length = -1;
+
+    if ((pMessage != NULL) &&
+        (size >= U_GNSS_MSG_UBX_HEADER_LENGTH_BYTES) &&
+        (*pMessage == (char) 0xb5) && (*(pMessage + 1) == (char) 0x62) &&
+        (*(pMessage + 2) == (char) (messageId >> 8)) &&
+        (*(pMessage + 3) == (char) messageId)) {
+        // Length is little-endian
+        length = (int32_t) (uint8_t) *(pMessage + 4) +
+                 (((int32_t) (uint8_t) *(pMessage + 5)) << 8);
+        if ((size_t) length + U_GNSS_MSG_UBX_HEADER_LENGTH_BYTES > size) {
+            // Truncated
+            length = -1;
+        }
+    }
+
+    return length;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Get a pointer to the body of a UBX message.
+const void *pUGnssMsgUbxBody(const char *pMessage, size_t size,
+                             uint16_t messageId, size_t bodyMinLength)
+{
+    const void *pBody = NULL;
+    int32_t length = bodyLength(pMessage, size, messageId);
+
+    if ((length >= 0) && ((size_t) length >= bodyMinLength)) {
+        pBody = pMessage + U_GNSS_MSG_UBX_HEADER_LENGTH_BYTES;
+    }
+
+    return pBody;
+}
+
+// Get a pointer to a repeated block of a UBX message.
+const void *pUGnssMsgUbxBlock(const char *pMessage, size_t size,
+                              uint16_t messageId, size_t fixedLength,
+                              size_t blockLength, size_t index)
+{
+    const void *pBlock = NULL;
+    int32_t length = bodyLength(pMessage, size, messageId);
+    size_t offset;
+
+    if ((length >= 0) && (blockLength > 0) &&
+        ((size_t) length >= fixedLength)) {
+        // Check the index against the number of blocks rather than
+        // multiplying it out, so that a silly index can't wrap
+        if (index < ((size_t) length - fixedLength) / blockLength) {
+            offset = fixedLength + (index * blockLength);
+            pBlock = pMessage + U_GNSS_MSG_UBX_HEADER_LENGTH_BYTES + offset;
+        }
+    }
+
+    return pBlock;
+}
+
+// End of file
@@ -42,6 +42,7 @@
 #include "u_port.h"
 #include "u_port_heap.h"
 #include "u_port_os.h"  // Required by u_gnss_private.h
+#include "u_task_registry.h"
 #include "u_port_debug.h"
 
 #include "u_time.h"
@@ -51,7 +52,11 @@
 #include "u_gnss_module_type.h"
 #include "u_gnss_type.h"
 #include "u_gnss_private.h"
+#include "u_gnss_msg.h"
+#include "u_gnss_cfg_val_key.h"
+#include "u_gnss_cfg.h"
 #include "u_gnss_pos.h"
+#include "u_gnss_pwr.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -85,6 +90,12 @@
 #define U_GNSS_POS_RRLP_HEADER_SIZE_BYTES (U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES - 2)
 #endif
 
+#ifndef U_GNSS_POS_NAV_PVT_BODY_LENGTH_BYTES
+/** The length of the body of a UBX-NAV-PVT message.
+ */
+# define U_GNSS_POS_NAV_PVT_BODY_LENGTH_BYTES 92
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -113,116 +124,137 @@ typedef struct {
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
-// Establish position.
-static int32_t posGet(uGnssPrivateInstance_t *pInstance,
-                      int32_t *pLatitudeX1e7, int32_t *pLongitudeX1e7,
-                      int32_t *pAltitudeMillimetres,
-                      int32_t *pRadiusMillimetres,
-                      int32_t *pSpeedMillimetresPerSecond,
-                      int32_t *pSvs, int64_t *pTimeUtc, bool printIt)
+// Decode the body of a UBX-NAV-PVT message, which must be
+// U_GNSS_POS_NAV_PVT_BODY_LENGTH_BYTES long.
+static int32_t posDecode(const char *message,
+                         int32_t *pLatitudeX1e7, int32_t *pLongitudeX1e7,
+                         int32_t *pAltitudeMillimetres,
+                         int32_t *pRadiusMillimetres,
+                         int32_t *pSpeedMillimetresPerSecond,
+                         int32_t *pSvs, int64_t *pTimeUtc, bool printIt)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
-    // Enough room for the body of the UBX-NAV-PVT message
-    char message[92] = {0};
     int32_t months;
     int32_t year;
     int32_t y;
     int64_t t = -1;
 
-    y = uGnssPrivateSendReceiveUbxMessage(pInstance,
-                                          0x01, 0x07, NULL, 0,
-                                          message, sizeof(message));
-    if (y == sizeof(message)) {
-        // Got the correct message body length, process it
-        if ((message[11] & 0x03) == 0x03) {
-            // Time and date are valid; we don't indicate
-            // success based on this but we report it anyway
-            // if it is valid
-            t = 0;
-            // Year is 1999-2099, so need to adjust to get year since 1970
-            year = ((int32_t) uUbxProtocolUint16Decode(message + 4) - 1999) + 29;
-            // Month (1 to 12), so take away 1 to make it zero-based
-            months = message[6] - 1;
-            months += year * 12;
-            // Work out the number of seconds due to the year/month count
-            t += uTimeMonthsToSecondsUtc(months);
-            // Day (1 to 31)
-            t += ((int32_t) message[7] - 1) * 3600 * 24;
-            // Hour (0 to 23)
-            t += ((int32_t) message[8]) * 3600;
-            // Minute (0 to 59)
-            t += ((int32_t) message[9]) * 60;
-            // Second (0 to 60)
-            t += message[10];
-            if (printIt) {
-                uPortLog("U_GNSS_POS: UTC time = %d.\n", (int32_t) t);
-            }
+    if ((message[11] & 0x03) == 0x03) {
+        // Time and date are valid; we don't indicate
+        // success based on this but we report it anyway
+        // if it is valid
+        t = 0;
+        // Year is 1999-2099, so need to adjust to get year since 1970
+        year = ((int32_t) uUbxProtocolUint16Decode(message + 4) - 1999) + 29;
+        // Month (1 to 12), so take away 1 to make it zero-based
+        months = message[6] - 1;
+        months += year * 12;
+        // Work out the number of seconds due to the year/month count
+        t += uTimeMonthsToSecondsUtc(months);
+        // Day (1 to 31)
+        t += ((int32_t) message[7] - 1) * 3600 * 24;
+        // Hour (0 to 23)
+        t += ((int32_t) message[8]) * 3600;
+        // Minute (0 to 59)
+        t += ((int32_t) message[9]) * 60;
+        // Second (0 to 60)
+        t += message[10];
+        if (printIt) {
+            uPortLog("U_GNSS_POS: UTC time = %d.\n", (int32_t) t);
         }
-        if (pTimeUtc != NULL) {
-            *pTimeUtc = t;
+    }
+    if (pTimeUtc != NULL) {
+        *pTimeUtc = t;
+    }
+    // From here onwards Lint complains about accesses
+    // into message[] and it doesn't seem to be possible
+    // to suppress those warnings with -esym(690, message)
+    // or even -e(690), hence do it the blunt way
+    //lint -save -e690
+    if (message[21] & 0x01) {
+        if (printIt) {
+            uPortLog("U_GNSS_POS: %dD fix achieved.\n", message[20]);
         }
-        // From here onwards Lint complains about accesses
-        // into message[] and it doesn't seem to be possible
-        // to suppress those warnings with -esym(690, message)
-        // or even -e(690), hence do it the blunt way
-        //lint -save -e690
-        if (message[21] & 0x01) {
-            if (printIt) {
-                uPortLog("U_GNSS_POS: %dD fix achieved.\n", message[20]);
-            }
-            y = (int32_t) message[23];
-            if (printIt) {
-                uPortLog("U_GNSS_POS: satellite(s) = %d.\n", y);
-            }
-            if (pSvs != NULL) {
-                *pSvs = y;
-            }
-            y = (int32_t) uUbxProtocolUint32Decode(message + 24);
-            if (printIt) {
-                uPortLog("U_GNSS_POS: longitude = %d (degrees * 10^7).\n", y);
-            }
-            if (pLongitudeX1e7 != NULL) {
-                *pLongitudeX1e7 = y;
-            }
-            y = (int32_t) uUbxProtocolUint32Decode(message + 28);
-            if (printIt) {
-                uPortLog("U_GNSS_POS: latitude = %d (degrees * 10^7).\n", y);
-            }
-            if (pLatitudeX1e7 != NULL) {
-                *pLatitudeX1e7 = y;
-            }
-            y = INT_MIN;
-            if (message[20] == 0x03) {
-                y = (int32_t) uUbxProtocolUint32Decode(message + 36);
-                if (printIt) {
-                    uPortLog("U_GNSS_POS: altitude = %d (mm).\n", y);
-                }
-            }
-            if (pAltitudeMillimetres != NULL) {
-                *pAltitudeMillimetres = y;
-            }
-            y = (int32_t) uUbxProtocolUint32Decode(message + 40);
-            if (printIt) {
-                uPortLog("U_GNSS_POS: radius = %d (mm).\n", y);
-            }
-            if (pRadiusMillimetres != NULL) {
-                *pRadiusMillimetres = y;
-            }
-            y = (int32_t) uUbxProtocolUint32Decode(message + 60);
+        y = (int32_t) message[23];
+        if (printIt) {
+            uPortLog("U_GNSS_POS: satellite(s) = %d.\n", y);
+        }
+        if (pSvs != NULL) {
+            *pSvs = y;
+        }
+        y = (int32_t) uUbxProtocolUint32Decode(message + 24);
+        if (printIt) {
+            uPortLog("U_GNSS_POS: longitude = %d (degrees * 10^7).\n", y);
+        }
+        if (pLongitudeX1e7 != NULL) {
+            *pLongitudeX1e7 = y;
+        }
+        y = (int32_t) uUbxProtocolUint32Decode(message + 28);
+        if (printIt) {
+            uPortLog("U_GNSS_POS: latitude = %d (degrees * 10^7).\n", y);
+        }
+        if (pLatitudeX1e7 != NULL) {
+            *pLatitudeX1e7 = y;
+        }
+        y = INT_MIN;
+        if (message[20] == 0x03) {
+            y = (int32_t) uUbxProtocolUint32Decode(message + 36);
             if (printIt) {
-                uPortLog("U_GNSS_POS: speed = %d (mm/s).\n", y);
+                uPortLog("U_GNSS_POS: altitude = %d (mm).\n", y);
             }
-            if (pSpeedMillimetresPerSecond != NULL) {
-                *pSpeedMillimetresPerSecond = y;
-            }
-            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-            //lint -restore
         }
-    } else {
-        errorCode = y;
-        if (errorCode >= 0) {
-            errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+        if (pAltitudeMillimetres != NULL) {
+            *pAltitudeMillimetres = y;
+        }
+        y = (int32_t) uUbxProtocolUint32Decode(message + 40);
+        if (printIt) {
+            uPortLog("U_GNSS_POS: radius = %d (mm).\n", y);
+        }
+        if (pRadiusMillimetres != NULL) {
+            *pRadiusMillimetres = y;
+        }
+        y = (int32_t) uUbxProtocolUint32Decode(message + 60);
+        if (printIt) {
+            uPortLog("U_GNSS_POS: speed = %d (mm/s).\n", y);
         }
+        if (pSpeedMillimetresPerSecond != NULL) {
+            *pSpeedMillimetresPerSecond = y;
+        }
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        //lint -restore
+    }
+
+    return errorCode;
+}
+
+// Establish position.
+static int32_t posGet(uGnssPrivateInstance_t *pInstance,
+                      int32_t *pLatitudeX1e7, int32_t *pLongitudeX1e7,
+                      int32_t *pAltitudeMillimetres,
+                      int32_t *pRadiusMillimetres,
+                      int32_t *pSpeedMillimetresPerSecond,
+                      int32_t *pSvs, int64_t *pTimeUtc, bool printIt)
+{
+    int32_t errorCode;
+    // Enough room for the body of the UBX-NAV-PVT message
+    char message[U_GNSS_POS_NAV_PVT_BODY_LENGTH_BYTES] = {0};
+
+    errorCode = uGnssPrivateSendReceiveUbxMessage(pInstance,
+                                                  0x01, 0x07, NULL, 0,
+                                                  message, sizeof(message));
+    if (errorCode == sizeof(message)) {
+        // Got the correct message body length, process it
+        errorCode = posDecode(message, pLatitudeX1e7, pLongitudeX1e7,
+                              pAltitudeMillimetres, pRadiusMillimetres,
+                              pSpeedMillimetresPerSecond, pSvs, pTimeUtc,
+                              printIt);
+        if (errorCode == 0) {
+            uGnssPrivateEnergyState(pInstance, (int32_t) U_GNSS_PWR_ENERGY_STATE_TRACKING, true);
+        } else if (errorCode == (int32_t) U_ERROR_COMMON_TIMEOUT) {
+            uGnssPrivateEnergyState(pInstance, (int32_t) U_GNSS_PWR_ENERGY_STATE_ACQUISITION, false);
+        }
+    } else if (errorCode >= 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
     }
 
     return errorCode;
@@ -276,7 +308,80 @@ static void posGetTask(void *pParameter)
     U_PORT_MUTEX_UNLOCK(taskParameters.pInstance->posMutex);
 
     // Delete ourselves
-    uPortTaskDelete(NULL);
+    uTaskRegistryTaskDelete(NULL);
+}
+
+// Message receive callback for streamed position: decode each
+// UBX-NAV-PVT message as it arrives and pass it on to the user.
+// Note: this is called from the message receive task, which holds
+// no GNSS mutex, hence pCallbackParam points at the streamed
+// position context, which is guaranteed to persist until the
+// message receiver has been stopped.
+static void streamedPosCallback(uDeviceHandle_t gnssHandle,
+                                const uGnssMessageId_t *pMessageId,
+                                int32_t errorCodeOrLength,
+                                void *pCallbackParam)
+{
+    uGnssPrivateStreamedPosition_t *pStreamedPosition = (uGnssPrivateStreamedPosition_t *) pCallbackParam;
+    // Enough room for the whole UBX-NAV-PVT message
+    char message[U_GNSS_POS_NAV_PVT_BODY_LENGTH_BYTES + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+    int32_t errorCode;
+    int32_t latitudeX1e7 = INT_MIN;
+    int32_t longitudeX1e7 = INT_MIN;
+    int32_t altitudeMillimetres = INT_MIN;
+    int32_t radiusMillimetres = -1;
+    int32_t speedMillimetresPerSecond = INT_MIN;
+    int32_t svs = -1;
+    int64_t timeUtc = -1;
+
+    (void) pMessageId;
+
+    if ((errorCodeOrLength == sizeof(message)) &&
+        (uGnssMsgReceiveCallbackRead(gnssHandle, message,
+                                     sizeof(message)) == sizeof(message))) {
+        errorCode = posDecode(message + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES,
+                              &latitudeX1e7, &longitudeX1e7,
+                              &altitudeMillimetres, &radiusMillimetres,
+                              &speedMillimetresPerSecond, &svs,
+                              &timeUtc, false);
+        if (errorCode == 0) {
+            uGnssPrivateEnergyState(pStreamedPosition->pInstance,
+                                    (int32_t) U_GNSS_PWR_ENERGY_STATE_TRACKING, true);
+        } else if (errorCode == (int32_t) U_ERROR_COMMON_TIMEOUT) {
+            uGnssPrivateEnergyState(pStreamedPosition->pInstance,
+                                    (int32_t) U_GNSS_PWR_ENERGY_STATE_ACQUISITION, false);
+        }
+        pStreamedPosition->pCallback(gnssHandle, errorCode, latitudeX1e7,
+                                     longitudeX1e7, altitudeMillimetres,
+                                     radiusMillimetres,
+                                     speedMillimetresPerSecond, svs, timeUtc);
+    }
+}
+
+// Return the CFG-MSGOUT key ID that controls UBX-NAV-PVT output
+// on the given port.
+static uint32_t navPvtMsgOutKeyId(uGnssPort_t port)
+{
+    uint32_t keyId = U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_NAV_PVT_I2C_U1;
+
+    switch (port) {
+        case U_GNSS_PORT_UART:
+            keyId = U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_NAV_PVT_UART1_U1;
+            break;
+        case U_GNSS_PORT_UART2:
+            keyId = U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_NAV_PVT_UART2_U1;
+            break;
+        case U_GNSS_PORT_USB:
+            keyId = U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_NAV_PVT_USB_U1;
+            break;
+        case U_GNSS_PORT_SPI:
+            keyId = U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_NAV_PVT_SPI_U1;
+            break;
+        default:
+            break;
+    }
+
+    return keyId;
 }
 
 /* ----------------------------------------------------------------
@@ -410,12 +515,12 @@ int32_t uGnssPosGetStart(uDeviceHandle_t gnssHandle,
                         pParameters->gnssHandle = gnssHandle;
                         pParameters->pInstance = pInstance;
                         pParameters->pCallback = pCallback;
-                        errorCode = uPortTaskCreate(posGetTask,
-                                                    "gnssPosCallback",
-                                                    U_GNSS_POS_CALLBACK_TASK_STACK_SIZE_BYTES,
-                                                    (void *) pParameters,
-                                                    U_GNSS_POS_CALLBACK_TASK_PRIORITY,
-                                                    &(pInstance->posTask));
+                        errorCode = uTaskRegistryTaskCreate(posGetTask,
+                                                            "gnssPosCallback",
+                                                            U_GNSS_POS_CALLBACK_TASK_STACK_SIZE_BYTES,
+                                                            (void *) pParameters,
+                                                            U_GNSS_POS_CALLBACK_TASK_PRIORITY,
+                                                            &(pInstance->posTask));
                         if (errorCode >= 0) {
                             while (!(pInstance->posTaskFlags & U_GNSS_POS_TASK_FLAG_HAS_RUN)) {
                                 // Make sure the task has run before we
@@ -465,6 +570,132 @@ void uGnssPosGetStop(uDeviceHandle_t gnssHandle)
     }
 }
 
+// Get position streamed at the given rate.
+int32_t uGnssPosGetStreamedStart(uDeviceHandle_t gnssHandle,
+                                 int32_t rateMs,
+                                 void (*pCallback) (uDeviceHandle_t gnssHandle,
+                                                    int32_t errorCode,
+                                                    int32_t latitudeX1e7,
+                                                    int32_t longitudeX1e7,
+                                                    int32_t altitudeMillimetres,
+                                                    int32_t radiusMillimetres,
+                                                    int32_t speedMillimetresPerSecond,
+                                                    int32_t svs,
+                                                    int64_t timeUtc))
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPrivateStreamedPosition_t *pStreamedPosition = NULL;
+    uGnssMessageId_t messageId;
+    uGnssCfgVal_t cfgVal[2];
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pCallback != NULL) &&
+            (rateMs > 0) && (rateMs <= UINT16_MAX)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            // Message receive only works for a GNSS chip that is
+            // directly connected and the rate/message output can
+            // only be configured with CFG-VALSET
+            if ((pInstance->transportType != U_GNSS_TRANSPORT_AT) &&
+                U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                if (pInstance->pStreamedPosition == NULL) {
+                    pStreamedPosition = (uGnssPrivateStreamedPosition_t *) pUPortMalloc(sizeof(*pStreamedPosition));
+                    if (pStreamedPosition != NULL) {
+                        pStreamedPosition->asyncHandle = -1;
+                        pStreamedPosition->msgOutKeyId = navPvtMsgOutKeyId(pInstance->portNumber);
+                        pStreamedPosition->pCallback = pCallback;
+                        pStreamedPosition->pInstance = pInstance;
+                        // Claim the slot while we still have the mutex
+                        pInstance->pStreamedPosition = pStreamedPosition;
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+
+        // The remaining calls are to public GNSS APIs, which lock
+        // gUGnssPrivateMutex themselves
+        if (errorCode == 0) {
+            // Set the measurement rate and switch on UBX-NAV-PVT
+            // output on our port, once per navigation solution
+            cfgVal[0].keyId = U_GNSS_CFG_VAL_KEY_ID_RATE_MEAS_U2;
+            cfgVal[0].value = (uint64_t) rateMs;
+            cfgVal[1].keyId = pStreamedPosition->msgOutKeyId;
+            cfgVal[1].value = 1;
+            errorCode = uGnssCfgValSetList(gnssHandle, cfgVal,
+                                           sizeof(cfgVal) / sizeof(cfgVal[0]),
+                                           U_GNSS_CFG_VAL_TRANSACTION_NONE,
+                                           U_GNSS_CFG_VAL_LAYER_RAM);
+            if (errorCode == 0) {
+                messageId.type = U_GNSS_PROTOCOL_UBX;
+                messageId.id.ubx = 0x0107;
+                errorCode = uGnssMsgReceiveStart(gnssHandle, &messageId,
+                                                 streamedPosCallback,
+                                                 pStreamedPosition);
+                if (errorCode >= 0) {
+                    pStreamedPosition->asyncHandle = errorCode;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                } else {
+                    // Switch UBX-NAV-PVT output off again
+                    uGnssCfgValSet(gnssHandle, pStreamedPosition->msgOutKeyId, 0,
+                                   U_GNSS_CFG_VAL_TRANSACTION_NONE,
+                                   U_GNSS_CFG_VAL_LAYER_RAM);
+                }
+            }
+            if (errorCode < 0) {
+                // Give the slot back
+                U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+                pInstance->pStreamedPosition = NULL;
+                U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+                uPortFree(pStreamedPosition);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Stop streamed position.
+void uGnssPosGetStreamedStop(uDeviceHandle_t gnssHandle)
+{
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPrivateStreamedPosition_t *pStreamedPosition = NULL;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            pStreamedPosition = pInstance->pStreamedPosition;
+            pInstance->pStreamedPosition = NULL;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+
+        if (pStreamedPosition != NULL) {
+            // Once the message receiver is stopped our callback
+            // can no longer be called and it is safe to free
+            // the context
+            if (pStreamedPosition->asyncHandle >= 0) {
+                uGnssMsgReceiveStop(gnssHandle, pStreamedPosition->asyncHandle);
+            }
+            uGnssCfgValSet(gnssHandle, pStreamedPosition->msgOutKeyId, 0,
+                           U_GNSS_CFG_VAL_TRANSACTION_NONE,
+                           U_GNSS_CFG_VAL_LAYER_RAM);
+            uPortFree(pStreamedPosition);
+        }
+    }
+}
+
 // Get RRLP information from the GNSS chip.
 int32_t uGnssPosGetRrlp(uDeviceHandle_t gnssHandle, char *pBuffer,
                         size_t sizeBytes, int32_t svsThreshold,
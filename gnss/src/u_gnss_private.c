@@ -48,8 +48,11 @@
 #include "u_port_os.h"
 #include "u_port_uart.h"
 #include "u_port_i2c.h"
+#include "u_port_gpio.h"
 #include "u_port_debug.h"
 
+#include "u_log_ram_trace.h"
+
 #include "u_hex_bin_convert.h"
 
 #include "u_at_client.h"
@@ -99,6 +102,39 @@ typedef struct {
                           CRC calculation will fail. */
 } uGnssPrivateUbxReceiveMessage_t;
 
+/** State of parseUbx(), kept by the ring buffer between calls
+ * while a message is partially received.
+ */
+typedef struct {
+    uint8_t phase;     /**< 0 for the header, 1 for the body; must be first. */
+    uint8_t cka;
+    uint8_t ckb;
+    uint8_t cls;
+    uint8_t id;
+    uint16_t bodyLeft; /**< body bytes yet to be checksummed. */
+} uGnssPrivateParseUbxState_t;
+
+/** State of parseNmea(), kept by the ring buffer between calls
+ * while a message is partially received.
+ */
+typedef struct {
+    uint8_t phase;     /**< 0 for the start, 1 for the message ID,
+                            2 for the body; must be first. */
+    char crc;
+    uint8_t idLength;
+    char id[U_GNSS_NMEA_MESSAGE_MATCH_LENGTH_CHARACTERS];
+} uGnssPrivateParseNmeaState_t;
+
+/** State of parseRtcm(), kept by the ring buffer between calls
+ * while a message is partially received.
+ */
+typedef struct {
+    uint8_t phase;     /**< 0 for the header, 1 for the body; must be first. */
+    uint16_t id;
+    uint16_t bodyLeft; /**< body bytes yet to be CRC'ed. */
+    uint32_t crc;
+} uGnssPrivateParseRtcmState_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES THAT ARE SHARED THROUGHOUT THE GNSS IMPLEMENTATION
  * -------------------------------------------------------------- */
@@ -117,12 +153,10 @@ uPortMutexHandle_t gUGnssPrivateMutex = NULL;
  */
 const uGnssPrivateModule_t gUGnssPrivateModuleList[] = {
     {
-        U_GNSS_MODULE_TYPE_M8, 0 /* features */
+        U_GNSS_MODULE_TYPE_M8, U_GNSS_PRIVATE_FEATURES_M8 /* features */
     },
     {
-        U_GNSS_MODULE_TYPE_M9,
-        ((1UL << (int32_t) U_GNSS_PRIVATE_FEATURE_CFGVALXXX) /* features */
-        )
+        U_GNSS_MODULE_TYPE_M9, U_GNSS_PRIVATE_FEATURES_M9 /* features */
     }
 };
 
@@ -145,7 +179,8 @@ const uGnssPrivateStreamType_t gGnssPrivateTransportTypeToStream[] = {
     U_GNSS_PRIVATE_STREAM_TYPE_NONE, // U_GNSS_TRANSPORT_AT
     U_GNSS_PRIVATE_STREAM_TYPE_I2C,  // U_GNSS_TRANSPORT_I2C
     U_GNSS_PRIVATE_STREAM_TYPE_UART, // U_GNSS_TRANSPORT_UBX_UART
-    U_GNSS_PRIVATE_STREAM_TYPE_I2C   // U_GNSS_TRANSPORT_UBX_I2C
+    U_GNSS_PRIVATE_STREAM_TYPE_I2C,  // U_GNSS_TRANSPORT_UBX_I2C
+    U_GNSS_PRIVATE_STREAM_TYPE_VIRTUAL_SERIAL // U_GNSS_TRANSPORT_VIRTUAL_SERIAL
 };
 
 /* ----------------------------------------------------------------
@@ -252,26 +287,55 @@ static int32_t streamGetFromRingBuffer(uGnssPrivateInstance_t *pInstance,
     return errorCodeOrLength;
 }
 
-// Send a message over UART or I2C.
-static int32_t sendMessageStream(int32_t streamHandle,
-                                 uGnssPrivateStreamType_t streamType,
-                                 uint16_t i2cAddress,
+// Update the transport statistics after receiveSize bytes have
+// been committed to the ring buffer.
+static void updateStatsFill(uGnssPrivateInstance_t *pInstance,
+                            int32_t receiveSize)
+{
+    uGnssMsgStats_t *pStats = &(pInstance->stats);
+    size_t dataSize;
+
+    if (pStats->bytesReceived == 0) {
+        pInstance->statsStartTimeMs = uPortGetTickTimeMs();
+    }
+    pStats->bytesReceived += receiveSize;
+    // The largest amount of data waiting for a locked read handle
+    // (e.g. that of the message receive task), which is the data
+    // that a forced add will not overwrite; one byte of the ring
+    // buffer is always kept free to prevent pointer wrap
+    dataSize = pInstance->ringBuffer.size - 1 -
+               uRingBufferAvailableSizeMax(&(pInstance->ringBuffer));
+    if (dataSize > pStats->ringBufferHighWaterMark) {
+        pStats->ringBufferHighWaterMark = dataSize;
+    }
+}
+
+// Send a message over UART, I2C or virtual serial.
+static int32_t sendMessageStream(const uGnssPrivateInstance_t *pInstance,
                                  const char *pMessage,
                                  size_t messageLengthBytes, bool printIt)
 {
     int32_t errorCodeOrSentLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssVirtualSerial_t *pVirtualSerial;
 
-    switch (streamType) {
+    switch (uGnssPrivateGetStreamType(pInstance->transportType)) {
         case U_GNSS_PRIVATE_STREAM_TYPE_UART:
-            errorCodeOrSentLength = uPortUartWrite(streamHandle, pMessage, messageLengthBytes);
+            errorCodeOrSentLength = uPortUartWrite(pInstance->transportHandle.uart,
+                                                   pMessage, messageLengthBytes);
             break;
         case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
-            errorCodeOrSentLength = uPortI2cControllerSend(streamHandle, i2cAddress,
+            errorCodeOrSentLength = uPortI2cControllerSend(pInstance->transportHandle.i2c,
+                                                           pInstance->i2cAddress,
                                                            pMessage, messageLengthBytes, false);
             if (errorCodeOrSentLength == 0) {
                 errorCodeOrSentLength = messageLengthBytes;
             }
             break;
+        case U_GNSS_PRIVATE_STREAM_TYPE_VIRTUAL_SERIAL:
+            pVirtualSerial = pInstance->transportHandle.pVirtualSerial;
+            errorCodeOrSentLength = pVirtualSerial->pWrite(pVirtualSerial, pMessage,
+                                                           messageLengthBytes);
+            break;
         default:
             break;
     }
@@ -494,25 +558,33 @@ static int32_t sendReceiveUbxMessageAt(const uAtClientHandle_t atHandle,
  * -------------------------------------------------------------- */
 
 // Send a UBX format message to the GNSS module and receive
-// the response.
+// the response; if pBufferInPlace is non-NULL then pMessageBody
+// is ignored and the body is taken to be already at offset
+// U_UBX_PROTOCOL_HEADER_LENGTH_BYTES in pBufferInPlace, which has
+// room for the UBX overhead, and it is encoded there.
 static int32_t sendReceiveUbxMessage(uGnssPrivateInstance_t *pInstance,
                                      int32_t messageClass,
                                      int32_t messageId,
                                      const char *pMessageBody,
                                      size_t messageBodyLengthBytes,
+                                     char *pBufferInPlace,
                                      uGnssPrivateUbxReceiveMessage_t *pResponse)
 {
     int32_t errorCodeOrResponseLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
     int32_t bytesToSend = 0;
-    char *pBuffer;
+    char *pBuffer = pBufferInPlace;
 
     if ((pInstance != NULL) &&
         (((pMessageBody == NULL) && (messageBodyLengthBytes == 0)) ||
          (messageBodyLengthBytes > 0)) &&
         ((pResponse->bodySize == 0) || (pResponse->ppBody != NULL))) {
         errorCodeOrResponseLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-        // Allocate a buffer big enough to encode the outgoing message
-        pBuffer = (char *) pUPortMalloc(messageBodyLengthBytes + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+        if (pBuffer == NULL) {
+            // Allocate a buffer big enough to encode the outgoing message
+            pBuffer = (char *) pUPortMalloc(messageBodyLengthBytes + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+        } else {
+            pMessageBody = pBuffer + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES;
+        }
         if (pBuffer != NULL) {
             errorCodeOrResponseLength = (int32_t) U_GNSS_ERROR_TRANSPORT;
             bytesToSend = uUbxProtocolEncode(messageClass, messageId,
@@ -542,23 +614,13 @@ static int32_t sendReceiveUbxMessage(uGnssPrivateInstance_t *pInstance,
                     case U_GNSS_TRANSPORT_UART:
                     //lint -fallthrough
                     case U_GNSS_TRANSPORT_UBX_UART:
-                        errorCodeOrResponseLength = sendMessageStream(pInstance->transportHandle.uart,
-                                                                      U_GNSS_PRIVATE_STREAM_TYPE_UART,
-                                                                      pInstance->i2cAddress,
-                                                                      pBuffer, bytesToSend,
-                                                                      pInstance->printUbxMessages);
-                        if (errorCodeOrResponseLength >= 0) {
-                            errorCodeOrResponseLength = receiveUbxMessageStream(pInstance, pResponse,
-                                                                                pInstance->timeoutMs,
-                                                                                pInstance->printUbxMessages);
-                        }
-                        break;
+                    //lint -fallthrough
                     case U_GNSS_TRANSPORT_I2C:
                     //lint -fallthrough
                     case U_GNSS_TRANSPORT_UBX_I2C:
-                        errorCodeOrResponseLength = sendMessageStream(pInstance->transportHandle.i2c,
-                                                                      U_GNSS_PRIVATE_STREAM_TYPE_I2C,
-                                                                      pInstance->i2cAddress,
+                    //lint -fallthrough
+                    case U_GNSS_TRANSPORT_VIRTUAL_SERIAL:
+                        errorCodeOrResponseLength = sendMessageStream(pInstance,
                                                                       pBuffer, bytesToSend,
                                                                       pInstance->printUbxMessages);
                         if (errorCodeOrResponseLength >= 0) {
@@ -585,14 +647,55 @@ static int32_t sendReceiveUbxMessage(uGnssPrivateInstance_t *pInstance,
                 U_PORT_MUTEX_UNLOCK(pInstance->transportMutex);
             }
 
-            // Free memory
-            uPortFree(pBuffer);
+            if (pBuffer != pBufferInPlace) {
+                // Free memory
+                uPortFree(pBuffer);
+            }
         }
     }
 
     return errorCodeOrResponseLength;
 }
 
+// Send a UBX format message to the GNSS module that only has an
+// Ack response and check that it is Acked; pBufferInPlace is as
+// for sendReceiveUbxMessage().
+static int32_t sendUbxMessageAck(uGnssPrivateInstance_t *pInstance,
+                                 int32_t messageClass,
+                                 int32_t messageId,
+                                 const char *pMessageBody,
+                                 size_t messageBodyLengthBytes,
+                                 char *pBufferInPlace)
+{
+    int32_t errorCode;
+    uGnssPrivateUbxReceiveMessage_t response;
+    char ackBody[2] = {0};
+    char *pBody = &(ackBody[0]);
+
+    // Fill the response structure in with the message class
+    // and ID we expect to get back and the buffer passed in.
+    response.cls = 0x05;
+    response.id = -1;
+    response.ppBody = &pBody;
+    response.bodySize = sizeof(ackBody);
+
+    errorCode = sendReceiveUbxMessage(pInstance, messageClass, messageId,
+                                      pMessageBody, messageBodyLengthBytes,
+                                      pBufferInPlace, &response);
+    if ((errorCode == 2) && (response.cls == 0x05) &&
+        (ackBody[0] == (char) messageClass) &&
+        (ackBody[1] == (char) messageId)) {
+        errorCode = (int32_t) U_GNSS_ERROR_NACK;
+        if (response.id == 0x01) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    } else {
+        errorCode = (int32_t) U_ERROR_COMMON_UNKNOWN;
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS: MESSAGE PARSERS
  * -------------------------------------------------------------- */
@@ -606,60 +709,62 @@ static int32_t sendReceiveUbxMessage(uGnssPrivateInstance_t *pInstance,
 static int32_t parseUbx(uParseHandle_t parseHandle, void *pUserParam)
 {
     uGnssPrivateMessageId_t *pMsgId = (uGnssPrivateMessageId_t *) pUserParam;
+    uGnssPrivateParseUbxState_t *pState = (uGnssPrivateParseUbxState_t *)
+                                          pURingBufferParserStateUnprotected(parseHandle);
     uint8_t by = 0;
-    if (!uRingBufferGetByteUnprotected(parseHandle, &by)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    if (0xB5 != by) {
-        return U_ERROR_COMMON_NOT_FOUND;    // = µ, 0xB5
-    }
-    if (!uRingBufferGetByteUnprotected(parseHandle, &by)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    if (0x62 != by) {
-        return U_ERROR_COMMON_NOT_FOUND;    // = b
-    }
-    if (4 > uRingBufferBytesAvailableUnprotected(parseHandle)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    uint8_t ckb = 0;
-    uint8_t cka = 0;
-    uint8_t cls, id;
-    uRingBufferGetByteUnprotected(parseHandle, &cls); // cls
-    cka += cls;
-    ckb += cka;
-    uRingBufferGetByteUnprotected(parseHandle, &id); // id
-    cka += id;
-    ckb += cka;
-    pMsgId->id.ubx = (cls << 8) + id;
-    uRingBufferGetByteUnprotected(parseHandle, &by); // len low
-    cka += by;
-    ckb += cka;
-    uint16_t l = by;
-    uRingBufferGetByteUnprotected(parseHandle, &by); // len high
-    cka += by;
-    ckb += cka;
-    l += (by << 8);
-    if (l > uRingBufferBytesAvailableUnprotected(parseHandle)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    while (l --) {
-        uRingBufferGetByteUnprotected(parseHandle, &by);
-        cka += by;
-        ckb += cka;
+    const char *pSpan;
+    size_t spanLength;
+    if (pState->phase == 0) {
+        if (!uRingBufferSyncUnprotected(parseHandle, (char) 0xB5)) {
+            return U_ERROR_COMMON_NOT_FOUND;    // = µ, 0xB5
+        }
+        if (!uRingBufferGetByteUnprotected(parseHandle, &by)) {
+            return U_ERROR_COMMON_TIMEOUT;
+        }
+        if (0x62 != by) {
+            return U_ERROR_COMMON_NOT_FOUND;    // = b
+        }
+        if (4 > uRingBufferBytesAvailableUnprotected(parseHandle)) {
+            return U_ERROR_COMMON_TIMEOUT;
+        }
+        uRingBufferGetByteUnprotected(parseHandle, &(pState->cls)); // cls
+        pState->cka += pState->cls;
+        pState->ckb += pState->cka;
+        uRingBufferGetByteUnprotected(parseHandle, &(pState->id)); // id
+        pState->cka += pState->id;
+        pState->ckb += pState->cka;
+        uRingBufferGetByteUnprotected(parseHandle, &by); // len low
+        pState->cka += by;
+        pState->ckb += pState->cka;
+        pState->bodyLeft = by;
+        uRingBufferGetByteUnprotected(parseHandle, &by); // len high
+        pState->cka += by;
+        pState->ckb += pState->cka;
+        pState->bodyLeft += (by << 8);
+        // From here on we can carry on where we left off
+        pState->phase = 1;
+    }
+    pMsgId->id.ubx = (pState->cls << 8) + pState->id;
+    while (pState->bodyLeft > 0) {
+        spanLength = uRingBufferGetSpanUnprotected(parseHandle, &pSpan, pState->bodyLeft);
+        if (spanLength == 0) {
+            return U_ERROR_COMMON_TIMEOUT;
+        }
+        pState->bodyLeft -= (uint16_t) spanLength;
+        while (spanLength--) {
+            pState->cka += (uint8_t) *pSpan++;
+            pState->ckb += pState->cka;
+        }
     }
-    cka = cka & 0xFF;
-    ckb = ckb & 0xFF;
-    if (!uRingBufferGetByteUnprotected(parseHandle, &by)) {
+    if (2 > uRingBufferBytesAvailableUnprotected(parseHandle)) {
         return U_ERROR_COMMON_TIMEOUT;
     }
-    if (by != cka) {
+    uRingBufferGetByteUnprotected(parseHandle, &by);
+    if (by != pState->cka) {
         return U_ERROR_COMMON_NOT_FOUND;
     }
-    if (!uRingBufferGetByteUnprotected(parseHandle, &by)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    if (by != ckb) {
+    uRingBufferGetByteUnprotected(parseHandle, &by);
+    if (by != pState->ckb) {
         return U_ERROR_COMMON_NOT_FOUND;
     }
     // We can only claim this as a UBX-format message if
@@ -679,60 +784,72 @@ static int32_t parseUbx(uParseHandle_t parseHandle, void *pUserParam)
 static int32_t parseNmea(uParseHandle_t parseHandle, void *pUserParam)
 {
     uGnssPrivateMessageId_t *pMsgId = (uGnssPrivateMessageId_t *) pUserParam;
+    uGnssPrivateParseNmeaState_t localState = {0};
+    uGnssPrivateParseNmeaState_t *pState = &localState;
     char ch = 0;
     const char *hex = "0123456789ABCDEF";
-    if (!uRingBufferGetByteUnprotected(parseHandle, &ch)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    if ('$' != ch) {
-        return U_ERROR_COMMON_NOT_FOUND;
+    if (sizeof(*pState) <= U_RING_BUFFER_PARSER_STATE_LENGTH_BYTES) {
+        // Only resume if the state fits in what the ring buffer keeps,
+        // which depends on U_GNSS_NMEA_MESSAGE_MATCH_LENGTH_CHARACTERS
+        pState = (uGnssPrivateParseNmeaState_t *) pURingBufferParserStateUnprotected(parseHandle);
     }
-    char crc = 0;
-    int i = 0;
-    while (uRingBufferGetByteUnprotected(parseHandle, &ch)) {
-        crc ^= ch;
-        if (',' == ch) {
-            break;
-        }
-        if (i >= U_GNSS_NMEA_MESSAGE_MATCH_LENGTH_CHARACTERS) {
+    if (pState->phase == 0) {
+        if (!uRingBufferSyncUnprotected(parseHandle, '$')) {
             return U_ERROR_COMMON_NOT_FOUND;
         }
-        if (('0' > ch) || ('Z' < ch) || (('9' < ch) && ('A' > ch))) {
-            return U_ERROR_COMMON_NOT_FOUND;    // A-Z, 0-9
+        pState->phase = 1;
+    }
+    if (pState->phase == 1) {
+        while (pState->phase == 1) {
+            if (!uRingBufferGetByteUnprotected(parseHandle, &ch)) {
+                return U_ERROR_COMMON_TIMEOUT;
+            }
+            pState->crc ^= ch;
+            if (',' == ch) {
+                pState->phase = 2;
+            } else {
+                if (pState->idLength >= U_GNSS_NMEA_MESSAGE_MATCH_LENGTH_CHARACTERS) {
+                    return U_ERROR_COMMON_NOT_FOUND;
+                }
+                if (('0' > ch) || ('Z' < ch) || (('9' < ch) && ('A' > ch))) {
+                    return U_ERROR_COMMON_NOT_FOUND;    // A-Z, 0-9
+                }
+                pState->id[pState->idLength++] = ch;
+            }
         }
-        pMsgId->id.nmea[i++] = ch;
     }
-    pMsgId->id.nmea[i] = '\0';
-    while (uRingBufferGetByteUnprotected(parseHandle, &ch)) {
+    memcpy(pMsgId->id.nmea, pState->id, pState->idLength);
+    pMsgId->id.nmea[pState->idLength] = '\0';
+    while (pState->phase == 2) {
+        if (!uRingBufferGetByteUnprotected(parseHandle, &ch)) {
+            return U_ERROR_COMMON_TIMEOUT;
+        }
         if ((' ' > ch) || ('~' < ch)) {
             return U_ERROR_COMMON_NOT_FOUND;    // not in printable range 32 - 126
         }
         if ('*' == ch) {
-            break;    // *
+            pState->phase = 3;
+        } else {
+            pState->crc ^= ch;
         }
-        crc ^= ch;
     }
-    if (!uRingBufferGetByteUnprotected(parseHandle, &ch)) {
+    // Two hex digits of CRC then \r\n
+    if (4 > uRingBufferBytesAvailableUnprotected(parseHandle)) {
         return U_ERROR_COMMON_TIMEOUT;
     }
-    if (hex[(crc >> 4) & 0xF] != ch) {
+    uRingBufferGetByteUnprotected(parseHandle, &ch);
+    if (hex[(pState->crc >> 4) & 0xF] != ch) {
         return U_ERROR_COMMON_NOT_FOUND;
     }
-    if (!uRingBufferGetByteUnprotected(parseHandle, &ch)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    if (hex[crc & 0xF] != ch) {
+    uRingBufferGetByteUnprotected(parseHandle, &ch);
+    if (hex[pState->crc & 0xF] != ch) {
         return U_ERROR_COMMON_NOT_FOUND;
     }
-    if (!uRingBufferGetByteUnprotected(parseHandle, &ch)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
+    uRingBufferGetByteUnprotected(parseHandle, &ch);
     if ('\r' != ch) {
         return U_ERROR_COMMON_NOT_FOUND;
     }
-    if (!uRingBufferGetByteUnprotected(parseHandle, &ch)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
+    uRingBufferGetByteUnprotected(parseHandle, &ch);
     if ('\n' != ch) {
         return U_ERROR_COMMON_NOT_FOUND;
     }
@@ -753,12 +870,13 @@ static int32_t parseNmea(uParseHandle_t parseHandle, void *pUserParam)
 static int32_t parseRtcm(uParseHandle_t parseHandle, void *pUserParam)
 {
     uGnssPrivateMessageId_t *pMsgId = (uGnssPrivateMessageId_t *) pUserParam;
-    uint8_t by;
+    uGnssPrivateParseRtcmState_t *pState = (uGnssPrivateParseRtcmState_t *)
+                                           pURingBufferParserStateUnprotected(parseHandle);
+    uint8_t by = 0xD3;
     uint32_t crc = 0;
-    if (!uRingBufferGetByteUnprotected(parseHandle, &by)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    if (0xD3 != by) {
+    const char *pSpan;
+    size_t spanLength;
+    if ((pState->phase == 0) && !uRingBufferSyncUnprotected(parseHandle, (char) by)) {
         return U_ERROR_COMMON_NOT_FOUND;
     }
     // CRC24Q check
@@ -797,47 +915,63 @@ static int32_t parseRtcm(uParseHandle_t parseHandle, void *pUserParam)
         /* f8 */ 0x42fa2f, 0xc4b6d4, 0xc82f22, 0x4e63d9, 0xd11cce, 0x575035, 0x5bc9c3, 0xdd8538
     };
 #define RTCM_CRC(crc, by) (crc << 8) ^ _crc24qTable[(by ^ (crc >> 16)) & 0xff]
-    // CRC is over the entire message, 0xD3 included
-    crc = RTCM_CRC(crc, by);
-    if (!uRingBufferGetByteUnprotected(parseHandle, &by)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    if ((0xFC & by) != 0) {
-        return U_ERROR_COMMON_NOT_FOUND;
-    }
-    uint16_t l = (by & 0x3) << 8;
-    crc = RTCM_CRC(crc, by);
-    if (!uRingBufferGetByteUnprotected(parseHandle, &by)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    l += by;
-    // Length includes the two-byte message ID and the message
-    // body, i.e. up to the start of the 3-byte CRC, i.e.
-    // the total message length - 6.
-    if (l > uRingBufferBytesAvailableUnprotected(parseHandle) + 3) {
-        return U_ERROR_COMMON_TIMEOUT;
+    if (pState->phase == 0) {
+        // CRC is over the entire message, 0xD3 included
+        crc = RTCM_CRC(crc, by);
+        if (!uRingBufferGetByteUnprotected(parseHandle, &by)) {
+            return U_ERROR_COMMON_TIMEOUT;
+        }
+        if ((0xFC & by) != 0) {
+            return U_ERROR_COMMON_NOT_FOUND;
+        }
+        uint16_t l = (by & 0x3) << 8;
+        crc = RTCM_CRC(crc, by);
+        // Length, the two-byte message ID
+        if (3 > uRingBufferBytesAvailableUnprotected(parseHandle)) {
+            return U_ERROR_COMMON_TIMEOUT;
+        }
+        uRingBufferGetByteUnprotected(parseHandle, &by);
+        l += by;
+        // Length includes the two-byte message ID and the message
+        // body, i.e. up to the start of the 3-byte CRC, i.e.
+        // the total message length - 6.
+        if (l < 2) {
+            return U_ERROR_COMMON_NOT_FOUND;
+        }
+        crc = RTCM_CRC(crc, by);
+        uint8_t idLo, idHi;
+        uRingBufferGetByteUnprotected(parseHandle, &idLo);
+        crc = RTCM_CRC(crc, idLo);
+        uRingBufferGetByteUnprotected(parseHandle, &idHi);
+        crc = RTCM_CRC(crc, idHi);
+        pState->id = (idHi >> 4) + (idLo << 4);
+        pState->bodyLeft = l - 2;
+        // From here on we can carry on where we left off
+        pState->phase = 1;
+    } else {
+        crc = pState->crc;
     }
-    crc = RTCM_CRC(crc, by);
-    uint8_t idLo, idHi;
-    if (!uRingBufferGetByteUnprotected(parseHandle, &idLo)) {
-        return U_ERROR_COMMON_TIMEOUT;
+    pMsgId->id.rtcm = pState->id;
+    while (pState->bodyLeft > 0) {
+        spanLength = uRingBufferGetSpanUnprotected(parseHandle, &pSpan, pState->bodyLeft);
+        if (spanLength == 0) {
+            pState->crc = crc;
+            return U_ERROR_COMMON_TIMEOUT;
+        }
+        pState->bodyLeft -= (uint16_t) spanLength;
+        while (spanLength--) {
+            crc = RTCM_CRC(crc, (uint8_t) *pSpan++);
+        }
     }
-    l--;
-    crc = RTCM_CRC(crc, idLo);
-    if (!uRingBufferGetByteUnprotected(parseHandle, &idHi)) {
+    pState->crc = crc;
+    // Compare CRC
+    if (3 > uRingBufferBytesAvailableUnprotected(parseHandle)) {
         return U_ERROR_COMMON_TIMEOUT;
     }
-    l--;
-    crc = RTCM_CRC(crc, idHi);
-    pMsgId->id.rtcm = (idHi >> 4) + (idLo << 4);
-    while (l--) {
+    for (int32_t x = 2; x >= 0; x--) {
         uRingBufferGetByteUnprotected(parseHandle, &by);
-        crc = RTCM_CRC(crc, by);
-    }
-    // Compare CRC
-    for (int32_t x = 2; (x >= 0) && uRingBufferGetByteUnprotected(parseHandle, &by); x--) {
         if (by != (uint8_t) (crc >> (8 * x))) {
-            return U_ERROR_COMMON_TIMEOUT;
+            return U_ERROR_COMMON_NOT_FOUND;
         }
     }
     // We can only claim this as an RTCM-format message if
@@ -853,20 +987,33 @@ static int32_t parseRtcm(uParseHandle_t parseHandle, void *pUserParam)
  * -------------------------------------------------------------- */
 
 // Find a GNSS instance in the list by instance handle.
+// This is called on every API call so, rather than searching
+// the list, the instance is taken directly from the device
+// instance, checking that it really does belong to us; the
+// network API is only asked to map the handle if it is not
+// a GNSS device handle already.
 uGnssPrivateInstance_t *pUGnssPrivateGetInstance(uDeviceHandle_t handle)
 {
-    uGnssPrivateInstance_t *pInstance = gpUGnssPrivateInstanceList;
-    uDeviceHandle_t gnssHandle = uNetworkGetDeviceHandle(handle,
-                                                         U_NETWORK_TYPE_GNSS);
-
-    if (gnssHandle == NULL) {
-        // If the network function returned nothing then the handle
-        // we were given wasn't obtained through the network API,
-        // just use what we were given
-        gnssHandle = handle;
+    uGnssPrivateInstance_t *pInstance = NULL;
+    uDeviceHandle_t gnssHandle = handle;
+    uDeviceInstance_t *pDevInstance = U_DEVICE_INSTANCE(handle);
+
+    if (uDeviceIsValidInstance(pDevInstance) &&
+        (pDevInstance->deviceType != U_DEVICE_TYPE_GNSS)) {
+        // Might be, e.g., a cellular device handle with GNSS
+        // inside it, obtained through the network API
+        gnssHandle = uNetworkGetDeviceHandle(handle, U_NETWORK_TYPE_GNSS);
+        if (gnssHandle == NULL) {
+            gnssHandle = handle;
+        }
+        pDevInstance = U_DEVICE_INSTANCE(gnssHandle);
     }
-    while ((pInstance != NULL) && (pInstance->gnssHandle != gnssHandle)) {
-        pInstance = pInstance->pNext;
+    if (uDeviceIsValidInstance(pDevInstance) &&
+        (pDevInstance->deviceType == U_DEVICE_TYPE_GNSS)) {
+        pInstance = (uGnssPrivateInstance_t *) pDevInstance->pDriverInstance;
+        if ((pInstance != NULL) && (pInstance->gnssHandle != gnssHandle)) {
+            pInstance = NULL;
+        }
     }
 
     return pInstance;
@@ -875,13 +1022,9 @@ uGnssPrivateInstance_t *pUGnssPrivateGetInstance(uDeviceHandle_t handle)
 // Get the module characteristics for a given instance.
 const uGnssPrivateModule_t *pUGnssPrivateGetModule(uDeviceHandle_t gnssHandle)
 {
-    uGnssPrivateInstance_t *pInstance = gpUGnssPrivateInstanceList;
+    uGnssPrivateInstance_t *pInstance = pUGnssPrivateGetInstance(gnssHandle);
     const uGnssPrivateModule_t *pModule = NULL;
 
-    while ((pInstance != NULL) && (pInstance->gnssHandle != gnssHandle)) {
-        pInstance = pInstance->pNext;
-    }
-
     if (pInstance != NULL) {
         pModule = pInstance->pModule;
     }
@@ -1020,6 +1163,94 @@ int32_t uGnssPrivateGetProtocolOut(uGnssPrivateInstance_t *pInstance)
     return errorCodeOrBitMap;
 }
 
+// Look up a value in the configuration cache.
+bool uGnssPrivateCfgCacheGet(uGnssPrivateInstance_t *pInstance,
+                             uint32_t keyId, uint64_t *pValue)
+{
+    bool found = false;
+    uGnssPrivateCfgCache_t *pCfgCache = pInstance->pCfgCache;
+
+    if (pCfgCache != NULL) {
+        for (size_t x = 0; (x < pCfgCache->numEntries) && !found; x++) {
+            if ((pCfgCache->pEntry + x)->keyId == keyId) {
+                *pValue = (pCfgCache->pEntry + x)->value;
+                found = true;
+            }
+        }
+        if (found) {
+            pCfgCache->hits++;
+        } else {
+            pCfgCache->misses++;
+        }
+    }
+
+    return found;
+}
+
+// Put a value into the configuration cache.
+void uGnssPrivateCfgCacheSet(uGnssPrivateInstance_t *pInstance,
+                             uint32_t keyId, uint64_t value)
+{
+    uGnssPrivateCfgCache_t *pCfgCache = pInstance->pCfgCache;
+    uGnssPrivateCfgCacheEntry_t *pEntry = NULL;
+
+    if (pCfgCache != NULL) {
+        for (size_t x = 0; (x < pCfgCache->numEntries) && (pEntry == NULL); x++) {
+            if ((pCfgCache->pEntry + x)->keyId == keyId) {
+                pEntry = pCfgCache->pEntry + x;
+            }
+        }
+        if (pEntry == NULL) {
+            if (pCfgCache->numEntries < pCfgCache->maxNumEntries) {
+                pEntry = pCfgCache->pEntry + pCfgCache->numEntries;
+                pCfgCache->numEntries++;
+            } else {
+                // Full: replace entries in the order they were added
+                pEntry = pCfgCache->pEntry + pCfgCache->nextEntry;
+                pCfgCache->nextEntry++;
+                if (pCfgCache->nextEntry >= pCfgCache->maxNumEntries) {
+                    pCfgCache->nextEntry = 0;
+                }
+            }
+            pEntry->keyId = keyId;
+        }
+        pEntry->value = value;
+    }
+}
+
+// Remove a value from the configuration cache.
+void uGnssPrivateCfgCacheDelete(uGnssPrivateInstance_t *pInstance,
+                                uint32_t keyId)
+{
+    uGnssPrivateCfgCache_t *pCfgCache = pInstance->pCfgCache;
+
+    if (pCfgCache != NULL) {
+        for (size_t x = 0; x < pCfgCache->numEntries; x++) {
+            if ((pCfgCache->pEntry + x)->keyId == keyId) {
+                // Move the last entry into the gap
+                pCfgCache->numEntries--;
+                *(pCfgCache->pEntry + x) = *(pCfgCache->pEntry + pCfgCache->numEntries);
+                if (pCfgCache->nextEntry >= pCfgCache->numEntries) {
+                    pCfgCache->nextEntry = 0;
+                }
+                break;
+            }
+        }
+    }
+}
+
+// Empty the configuration cache.
+void uGnssPrivateCfgCacheInvalidate(uGnssPrivateInstance_t *pInstance)
+{
+    uGnssPrivateCfgCache_t *pCfgCache = pInstance->pCfgCache;
+
+    if (pCfgCache != NULL) {
+        pCfgCache->numEntries = 0;
+        pCfgCache->nextEntry = 0;
+        pCfgCache->protocolOut = -1;
+    }
+}
+
 // Shut down and free memory from a running pos task.
 void uGnssPrivateCleanUpPosTask(uGnssPrivateInstance_t *pInstance)
 {
@@ -1081,6 +1312,12 @@ void uGnssPrivateStopMsgReceive(uGnssPrivateInstance_t *pInstance)
     if ((pInstance != NULL) && (pInstance->pMsgReceive != NULL)) {
         pMsgReceive = pInstance->pMsgReceive;
 
+#ifdef U_GNSS_MSG_RECEIVE_TASK_SHARED
+        // The task is shared: just leave it, which will stop
+        // it if we were the last one using it
+        (void) queueItem;
+        uGnssPrivateMsgReceiveSharedLeave(pInstance);
+#else
         // Sending the task anything will cause it to exit
         uPortQueueSend(pMsgReceive->taskExitQueueHandle, queueItem);
         U_PORT_MUTEX_LOCK(pMsgReceive->taskRunningMutexHandle);
@@ -1088,6 +1325,7 @@ void uGnssPrivateStopMsgReceive(uGnssPrivateInstance_t *pInstance)
         // Wait for the task to actually exit: the STM32F4 platform
         // needs this additional delay for some reason or it stalls here
         uPortTaskBlock(U_CFG_OS_YIELD_MS);
+#endif
 
         // Free all the readers; no need to lock the reader mutex since
         // we've shut the task down
@@ -1098,9 +1336,11 @@ void uGnssPrivateStopMsgReceive(uGnssPrivateInstance_t *pInstance)
         }
 
         // Free all OS resources
+#ifndef U_GNSS_MSG_RECEIVE_TASK_SHARED
         uPortTaskDelete(pMsgReceive->taskHandle);
         uPortMutexDelete(pMsgReceive->taskRunningMutexHandle);
         uPortQueueDelete(pMsgReceive->taskExitQueueHandle);
+#endif
         uPortMutexDelete(pMsgReceive->readerMutexHandle);
 
         // Pause here to allow the deletions
@@ -1108,9 +1348,6 @@ void uGnssPrivateStopMsgReceive(uGnssPrivateInstance_t *pInstance)
         // required by some RTOSs (e.g. FreeRTOS)
         uPortTaskBlock(U_CFG_OS_YIELD_MS);
 
-        // Free the temporary buffer
-        uPortFree(pMsgReceive->pTemporaryBuffer);
-
         // Give the ring buffer handle back
         uRingBufferGiveReadHandle(&(pInstance->ringBuffer),
                                   pMsgReceive->ringBufferReadHandle);
@@ -1249,16 +1486,21 @@ int32_t uGnssPrivateGetStreamType(uGnssTransportType_t transportType)
 // effect on the instance data since it is called by
 // uGnssPrivateStreamFillRingBuffer() which may be called at any time by
 // the message receive task over in u_gnss_msg.c
-int32_t uGnssPrivateStreamGetReceiveSize(int32_t streamHandle,
-                                         uGnssPrivateStreamType_t streamType,
-                                         uint16_t i2cAddress)
+int32_t uGnssPrivateStreamGetReceiveSize(const uGnssPrivateInstance_t *pInstance)
 {
     int32_t errorCodeOrReceiveSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int32_t streamHandle = pInstance->transportHandle.i2c;
+    uint16_t i2cAddress = pInstance->i2cAddress;
+    uGnssVirtualSerial_t *pVirtualSerial;
     char buffer[2];
 
-    switch (streamType) {
+    switch (uGnssPrivateGetStreamType(pInstance->transportType)) {
         case U_GNSS_PRIVATE_STREAM_TYPE_UART:
-            errorCodeOrReceiveSize = uPortUartGetReceiveSize(streamHandle);
+            errorCodeOrReceiveSize = uPortUartGetReceiveSize(pInstance->transportHandle.uart);
+            break;
+        case U_GNSS_PRIVATE_STREAM_TYPE_VIRTUAL_SERIAL:
+            pVirtualSerial = pInstance->transportHandle.pVirtualSerial;
+            errorCodeOrReceiveSize = pVirtualSerial->pGetReceiveSize(pVirtualSerial);
             break;
         case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
             // The number of bytes waiting for us is available by a read of
@@ -1363,21 +1605,17 @@ int32_t uGnssPrivateStreamFillRingBuffer(uGnssPrivateInstance_t *pInstance,
     int32_t startTimeMs;
     int32_t streamType;
     int32_t streamHandle = -1;
-    int32_t receiveSize;
+    int32_t receiveSize = 0;
+    int32_t receiveSizeLast;
     int32_t totalReceiveSize = 0;
     int32_t ringBufferAvailableSize;
-    char *pTemporaryBuffer;
+    int32_t x;
+    char *pData;
+    uGnssVirtualSerial_t *pVirtualSerial;
+
+    U_LOG_RAM_TRACE_BEGIN(GNSS, GNSS_FILL, timeoutMs);
 
     if (pInstance != NULL) {
-        pTemporaryBuffer = pInstance->pTemporaryBuffer;
-        if ((pInstance->pMsgReceive != NULL) &&
-            uPortTaskIsThis(pInstance->pMsgReceive->taskHandle)) {
-            // If we're being called from the message receive task,
-            // which does not lock gUGnssPrivateMutex, we use its
-            // temporary buffer in order to avoid clashes with
-            // the main application task
-            pTemporaryBuffer = pInstance->pMsgReceive->pTemporaryBuffer;
-        }
         errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
         streamType = uGnssPrivateGetStreamType(pInstance->transportType);
         switch (streamType) {
@@ -1387,6 +1625,11 @@ int32_t uGnssPrivateStreamFillRingBuffer(uGnssPrivateInstance_t *pInstance,
             case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
                 streamHandle = pInstance->transportHandle.i2c;
                 break;
+            case U_GNSS_PRIVATE_STREAM_TYPE_VIRTUAL_SERIAL:
+                // No integer handle here, the virtual serial
+                // functions are reached through pInstance
+                streamHandle = 0;
+                break;
             default:
                 break;
         }
@@ -1396,9 +1639,17 @@ int32_t uGnssPrivateStreamFillRingBuffer(uGnssPrivateInstance_t *pInstance,
             // This is constructed as a do()/while() so that
             // it always has one go even with a zero timeout
             do {
-                receiveSize = uGnssPrivateStreamGetReceiveSize(streamHandle,
-                                                               (uGnssPrivateStreamType_t) streamType,
-                                                               pInstance->i2cAddress);
+                receiveSizeLast = receiveSize;
+                receiveSize = 0;
+                // If there is a Data Ready pin, only ask the GNSS chip how
+                // much it has for us if the pin is asserted or if we've
+                // already begun reading, in which case keep going until the
+                // GNSS chip has nothing left, since the pin will drop when the
+                // amount waiting falls below the threshold
+                if ((pInstance->pinDataReady < 0) || (receiveSizeLast > 0) ||
+                    (uPortGpioGet(pInstance->pinDataReady) == pInstance->pinDataReadyAssertedState)) {
+                    receiveSize = uGnssPrivateStreamGetReceiveSize(pInstance);
+                }
                 // Don't try to read in more than uRingBufferForceAdd()
                 // can put into the ring buffer
                 ringBufferAvailableSize = uRingBufferAvailableSizeMax(&(pInstance->ringBuffer));
@@ -1406,46 +1657,70 @@ int32_t uGnssPrivateStreamFillRingBuffer(uGnssPrivateInstance_t *pInstance,
                     receiveSize = ringBufferAvailableSize;
                 }
                 if (receiveSize > 0) {
-                    // Read into a temporary buffer
-                    if (receiveSize > U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES) {
-                        receiveSize = U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES;
+                    // Read straight into the ring buffer; we use a forced
+                    // reserve: it is up to this MCU to keep up, we don't want
+                    // to block data from the GNSS chip, after all it has
+                    // no UART flow control lines that we can stop it with.
+                    // Note that the region returned may be less than we
+                    // asked for if it hits the end of the linear buffer,
+                    // in which case we get the rest next time around
+                    x = (int32_t) uRingBufferForceReserve(&(pInstance->ringBuffer), &pData);
+                    if (x > (int32_t) pInstance->readChunkLengthBytes) {
+                        // Limit the amount read in one go, since the
+                        // ring buffer is locked while we read into it
+                        x = (int32_t) pInstance->readChunkLengthBytes;
                     }
-                    switch (streamType) {
-                        case U_GNSS_PRIVATE_STREAM_TYPE_UART:
-                            // For UART we ask for as much data as we can, it will just
-                            // bring in more if more has arrived between the "receive
-                            // size" call above and now
-                            receiveSize = uPortUartRead(streamHandle, pTemporaryBuffer,
-                                                        U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES);
-                            break;
-                        case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
-                            // For I2C we need to ask for the amount we know is there since
-                            // the I2C buffer is effectively on the GNSS chip and I2C drivers
-                            // often don't say how much they've read, just giving us back
-                            // the number we asked for on a successful read
-                            receiveSize = uPortI2cControllerSendReceive(streamHandle,
-                                                                        pInstance->i2cAddress,
-                                                                        NULL, 0,
-                                                                        pTemporaryBuffer,
-                                                                        receiveSize);
-                            break;
-                        default:
-                            break;
+                    if (receiveSize > x) {
+                        receiveSize = x;
                     }
-                    if (receiveSize >= 0) {
-                        totalReceiveSize += receiveSize;
-                        errorCodeOrLength = totalReceiveSize;
-                        // Now stuff this into the ring buffer; we use a forced
-                        // add: it is up to this MCU to keep up, we don't want
-                        // to block data from the GNSS chip, after all it has
-                        // no UART flow control lines that we can stop it with
-                        if (!uRingBufferForceAdd(&(pInstance->ringBuffer),
-                                                 pTemporaryBuffer, receiveSize)) {
+                    if (receiveSize > 0) {
+                        switch (streamType) {
+                            case U_GNSS_PRIVATE_STREAM_TYPE_UART:
+                                // For UART we ask for as much data as we can, it will just
+                                // bring in more if more has arrived between the "receive
+                                // size" call above and now
+                                receiveSize = uPortUartRead(streamHandle, pData, x);
+                                break;
+                            case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
+                                // For I2C we need to ask for the amount we know is there since
+                                // the I2C buffer is effectively on the GNSS chip and I2C drivers
+                                // often don't say how much they've read, just giving us back
+                                // the number we asked for on a successful read
+                                receiveSize = uPortI2cControllerSendReceive(streamHandle,
+                                                                            pInstance->i2cAddress,
+                                                                            NULL, 0,
+                                                                            pData,
+                                                                            receiveSize);
+                                break;
+                            case U_GNSS_PRIVATE_STREAM_TYPE_VIRTUAL_SERIAL:
+                                // As for UART, ask for as much as we can take
+                                pVirtualSerial = pInstance->transportHandle.pVirtualSerial;
+                                receiveSize = pVirtualSerial->pRead(pVirtualSerial, pData, x);
+                                break;
+                            default:
+                                break;
+                        }
+                        if (receiveSize > 0) {
+                            // Copy to any raw recording before the data
+                            // is made available to the readers
+                            uGnssPrivateRecordTee(pInstance, pData, receiveSize);
+                        }
+                        if (!uRingBufferCommit(&(pInstance->ringBuffer),
+                                               receiveSize > 0 ? receiveSize : 0)) {
                             errorCodeOrLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                        } else if (receiveSize >= 0) {
+                            totalReceiveSize += receiveSize;
+                            errorCodeOrLength = totalReceiveSize;
+                            if (receiveSize > 0) {
+                                updateStatsFill(pInstance, receiveSize);
+                            }
+                        } else {
+                            // Error case
+                            errorCodeOrLength = receiveSize;
                         }
                     } else {
-                        // Error case
-                        errorCodeOrLength = receiveSize;
+                        // Nothing reserved, so nothing to commit
+                        errorCodeOrLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
                     }
                 } else if ((ringBufferAvailableSize > 0) && (timeoutMs > 0)) {
                     // Relax while we're waiting for more data to arrive
@@ -1468,6 +1743,8 @@ int32_t uGnssPrivateStreamFillRingBuffer(uGnssPrivateInstance_t *pInstance,
         errorCodeOrLength = totalReceiveSize;
     }
 
+    U_LOG_RAM_TRACE_END(GNSS, GNSS_FILL, errorCodeOrLength);
+
     return errorCodeOrLength;
 }
 
@@ -1492,7 +1769,7 @@ int32_t uGnssPrivateStreamPeekRingBuffer(uGnssPrivateInstance_t *pInstance,
                                    offset, maxTimeMs, false);
 }
 
-// Send a UBX format message over UART or I2C.
+// Send a UBX format message over UART, I2C or virtual serial.
 int32_t uGnssPrivateSendOnlyStreamUbxMessage(const uGnssPrivateInstance_t *pInstance,
                                              int32_t messageClass,
                                              int32_t messageId,
@@ -1501,7 +1778,6 @@ int32_t uGnssPrivateSendOnlyStreamUbxMessage(const uGnssPrivateInstance_t *pInst
 {
     int32_t errorCodeOrSentLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
     int32_t transportTypeStream;
-    int32_t streamHandle = -1;
     int32_t bytesToSend = 0;
     char *pBuffer;
 
@@ -1521,20 +1797,7 @@ int32_t uGnssPrivateSendOnlyStreamUbxMessage(const uGnssPrivateInstance_t *pInst
 
                 U_PORT_MUTEX_LOCK(pInstance->transportMutex);
 
-                switch (transportTypeStream) {
-                    case U_GNSS_PRIVATE_STREAM_TYPE_UART:
-                        streamHandle = pInstance->transportHandle.uart;
-                        break;
-                    case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
-                        streamHandle = pInstance->transportHandle.i2c;
-                        break;
-                    default:
-                        break;
-                }
-
-                errorCodeOrSentLength = sendMessageStream(streamHandle,
-                                                          (uGnssPrivateStreamType_t) transportTypeStream,
-                                                          pInstance->i2cAddress,
+                errorCodeOrSentLength = sendMessageStream(pInstance,
                                                           pBuffer, bytesToSend,
                                                           pInstance->printUbxMessages);
 
@@ -1724,7 +1987,149 @@ int32_t uGnssPrivateSendReceiveUbxMessage(uGnssPrivateInstance_t *pInstance,
 
     return sendReceiveUbxMessage(pInstance, messageClass, messageId,
                                  pMessageBody, messageBodyLengthBytes,
-                                 &response);
+                                 NULL, &response);
+}
+
+// Poll several UBX messages in one go.
+int32_t uGnssPrivateSendReceiveUbxMessageBatch(uGnssPrivateInstance_t *pInstance,
+                                               uGnssMsgUbxPoll_t *pPoll,
+                                               size_t numPolls,
+                                               int32_t timeoutMs)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    char message[U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+    uGnssPrivateMessageId_t privateMessageId;
+    char *pBuffer;
+    size_t numOutstanding = 0;
+    int32_t startTimeMs;
+    int32_t x;
+    uint16_t ubxId;
+    bool nack;
+
+    if ((pInstance != NULL) && (pPoll != NULL)) {
+        errorCodeOrCount = 0;
+        for (size_t y = 0; y < numPolls; y++) {
+            pPoll[y].errorCodeOrLength = (int32_t) U_ERROR_COMMON_TIMEOUT;
+        }
+        if (uGnssPrivateGetStreamType(pInstance->transportType) < 0) {
+            // Only one response can be outstanding: one at a time
+            for (size_t y = 0; y < numPolls; y++) {
+                pPoll[y].errorCodeOrLength = uGnssPrivateSendReceiveUbxMessage(pInstance,
+                                                                               pPoll[y].messageId >> 8,
+                                                                               pPoll[y].messageId & 0xff,
+                                                                               NULL, 0,
+                                                                               pPoll[y].pBody,
+                                                                               pPoll[y].bodySize);
+                if (pPoll[y].errorCodeOrLength >= 0) {
+                    errorCodeOrCount++;
+                }
+            }
+        } else {
+
+            U_PORT_MUTEX_LOCK(pInstance->transportMutex);
+
+            // As in sendReceiveUbxMessage(), clear out history and lock
+            // our read pointer before sending so as not to lose responses
+            uGnssPrivateStreamFillRingBuffer(pInstance,
+                                             U_GNSS_RING_BUFFER_MIN_FILL_TIME_MS,
+                                             U_GNSS_RING_BUFFER_MAX_FILL_TIME_MS);
+            uRingBufferLockReadHandle(&(pInstance->ringBuffer),
+                                      pInstance->ringBufferReadHandlePrivate);
+            uRingBufferFlushHandle(&(pInstance->ringBuffer),
+                                   pInstance->ringBufferReadHandlePrivate);
+            // Send all of the polls back-to-back
+            for (size_t y = 0; y < numPolls; y++) {
+                x = uUbxProtocolEncode(pPoll[y].messageId >> 8, pPoll[y].messageId & 0xff,
+                                       NULL, 0, message);
+                if (x > 0) {
+                    x = sendMessageStream(pInstance, message, x,
+                                          pInstance->printUbxMessages);
+                }
+                if (x < 0) {
+                    pPoll[y].errorCodeOrLength = x;
+                } else {
+                    numOutstanding++;
+                }
+            }
+            // Collect the responses in whatever order they arrive
+            startTimeMs = uPortGetTickTimeMs();
+            while ((numOutstanding > 0) &&
+                   (uPortGetTickTimeMs() - startTimeMs < timeoutMs)) {
+                privateMessageId.type = U_GNSS_PROTOCOL_UBX;
+                privateMessageId.id.ubx = (U_GNSS_UBX_MESSAGE_CLASS_ALL << 8) | U_GNSS_UBX_MESSAGE_ID_ALL;
+                pBuffer = NULL;
+                x = uGnssPrivateReceiveStreamMessage(pInstance, &privateMessageId,
+                                                     pInstance->ringBufferReadHandlePrivate,
+                                                     &pBuffer, 0,
+                                                     timeoutMs - (uPortGetTickTimeMs() - startTimeMs),
+                                                     NULL);
+                if (x >= U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES) {
+                    x -= U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES;
+                    ubxId = privateMessageId.id.ubx;
+                    // A UBX-ACK-NAK carries the class and ID of the
+                    // message that was rejected
+                    nack = (ubxId == 0x0500) && (x >= 2);
+                    if (nack) {
+                        ubxId = (uint16_t) ((((uint8_t) pBuffer[U_UBX_PROTOCOL_HEADER_LENGTH_BYTES]) << 8) |
+                                            (uint8_t) pBuffer[U_UBX_PROTOCOL_HEADER_LENGTH_BYTES + 1]);
+                    }
+                    for (size_t y = 0; y < numPolls; y++) {
+                        if ((pPoll[y].messageId == ubxId) &&
+                            (pPoll[y].errorCodeOrLength == (int32_t) U_ERROR_COMMON_TIMEOUT)) {
+                            if (nack) {
+                                pPoll[y].errorCodeOrLength = (int32_t) U_GNSS_ERROR_NACK;
+                            } else {
+                                if (pPoll[y].pBody != NULL) {
+                                    memcpy(pPoll[y].pBody, pBuffer + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES,
+                                           ((size_t) x < pPoll[y].bodySize) ? (size_t) x : pPoll[y].bodySize);
+                                }
+                                pPoll[y].errorCodeOrLength = x;
+                                errorCodeOrCount++;
+                            }
+                            numOutstanding--;
+                            break;
+                        }
+                    }
+                }
+                uPortFree(pBuffer);
+            }
+
+            uRingBufferUnlockReadHandle(&(pInstance->ringBuffer),
+                                        pInstance->ringBufferReadHandlePrivate);
+
+            U_PORT_MUTEX_UNLOCK(pInstance->transportMutex);
+        }
+    }
+
+    return errorCodeOrCount;
+}
+
+// Send a UBX format message and receive a response of known length
+// with a different message class/ID.
+int32_t uGnssPrivateSendReceiveUbxMessageResponse(uGnssPrivateInstance_t *pInstance,
+                                                  int32_t messageClass,
+                                                  int32_t messageId,
+                                                  const char *pMessageBody,
+                                                  size_t messageBodyLengthBytes,
+                                                  int32_t responseMessageClass,
+                                                  int32_t responseMessageId,
+                                                  char *pResponseBody,
+                                                  size_t maxResponseBodyLengthBytes)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssPrivateUbxReceiveMessage_t response;
+
+    if ((pResponseBody != NULL) && (maxResponseBodyLengthBytes > 0)) {
+        response.cls = responseMessageClass;
+        response.id = responseMessageId;
+        response.ppBody = &pResponseBody;
+        response.bodySize = maxResponseBodyLengthBytes;
+        errorCodeOrLength = sendReceiveUbxMessage(pInstance, messageClass, messageId,
+                                                  pMessageBody, messageBodyLengthBytes,
+                                                  NULL, &response);
+    }
+
+    return errorCodeOrLength;
 }
 
 // Send a UBX format message and receive a response of unknown length.
@@ -1746,7 +2151,7 @@ int32_t uGnssPrivateSendReceiveUbxMessageAlloc(uGnssPrivateInstance_t *pInstance
 
     return sendReceiveUbxMessage(pInstance, messageClass, messageId,
                                  pMessageBody, messageBodyLengthBytes,
-                                 &response);
+                                 NULL, &response);
 }
 
 // Send a UBX format message to the GNSS module that only has an
@@ -1757,33 +2162,54 @@ int32_t uGnssPrivateSendUbxMessage(uGnssPrivateInstance_t *pInstance,
                                    const char *pMessageBody,
                                    size_t messageBodyLengthBytes)
 {
-    int32_t errorCode;
-    uGnssPrivateUbxReceiveMessage_t response;
-    char ackBody[2] = {0};
-    char *pBody = &(ackBody[0]);
+    return sendUbxMessageAck(pInstance, messageClass, messageId,
+                             pMessageBody, messageBodyLengthBytes, NULL);
+}
 
-    // Fill the response structure in with the message class
-    // and ID we expect to get back and the buffer passed in.
-    response.cls = 0x05;
-    response.id = -1;
-    response.ppBody = &pBody;
-    response.bodySize = sizeof(ackBody);
+// As uGnssPrivateSendUbxMessage() but with the body already in place.
+int32_t uGnssPrivateSendUbxMessageInPlace(uGnssPrivateInstance_t *pInstance,
+                                          int32_t messageClass,
+                                          int32_t messageId,
+                                          char *pBuffer,
+                                          size_t messageBodyLengthBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
 
-    errorCode = sendReceiveUbxMessage(pInstance, messageClass, messageId,
-                                      pMessageBody, messageBodyLengthBytes,
-                                      &response);
-    if ((errorCode == 2) && (response.cls == 0x05) &&
-        (ackBody[0] == (char) messageClass) &&
-        (ackBody[1] == (char) messageId)) {
-        errorCode = (int32_t) U_GNSS_ERROR_NACK;
-        if (response.id == 0x01) {
-            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-        }
-    } else {
-        errorCode = (int32_t) U_ERROR_COMMON_UNKNOWN;
+    if (pBuffer != NULL) {
+        errorCode = sendUbxMessageAck(pInstance, messageClass, messageId,
+                                      NULL, messageBodyLengthBytes, pBuffer);
     }
 
     return errorCode;
 }
 
+// As uGnssPrivateSendReceiveUbxMessage() but with the body already in place.
+int32_t uGnssPrivateSendReceiveUbxMessageInPlace(uGnssPrivateInstance_t *pInstance,
+                                                 int32_t messageClass,
+                                                 int32_t messageId,
+                                                 char *pBuffer,
+                                                 size_t messageBodyLengthBytes,
+                                                 char *pResponseBody,
+                                                 size_t maxResponseBodyLengthBytes)
+{
+    int32_t errorCodeOrResponseLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssPrivateUbxReceiveMessage_t response;
+
+    if (pBuffer != NULL) {
+        response.cls = messageClass;
+        response.id = messageId;
+        response.ppBody = NULL;
+        response.bodySize = 0;
+        if (pResponseBody != NULL) {
+            response.ppBody = &pResponseBody;
+            response.bodySize = maxResponseBodyLengthBytes;
+        }
+        errorCodeOrResponseLength = sendReceiveUbxMessage(pInstance, messageClass, messageId,
+                                                          NULL, messageBodyLengthBytes,
+                                                          pBuffer, &response);
+    }
+
+    return errorCodeOrResponseLength;
+}
+
 // End of file
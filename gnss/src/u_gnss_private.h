@@ -24,6 +24,8 @@
 
 #include "u_device.h"
 #include "u_ringbuffer.h"
+#include "u_gnss_msg.h" // U_GNSS_MSG_RECEIVER_MAX_NUM
+#include "u_gnss_geofence.h" // uGnssGeofenceState_t
 
 /** @file
  * @brief This header file defines types, functions and inclusions that
@@ -75,6 +77,40 @@ extern "C" {
 # define U_GNSS_RING_BUFFER_MIN_FILL_TIME_MS 100
 #endif
 
+#ifndef U_GNSS_PRIVATE_MSG_INDEX_NUM_BUCKETS
+/** The number of hash buckets in the index that the message receive
+ * task uses to find the readers that might want a message; must be
+ * a power of two.
+ */
+# define U_GNSS_PRIVATE_MSG_INDEX_NUM_BUCKETS 32
+#endif
+
+/** The features supported by M8.
+ */
+#define U_GNSS_PRIVATE_FEATURES_M8 0UL
+
+/** The features supported by M9.
+ */
+#define U_GNSS_PRIVATE_FEATURES_M9                              \
+    ((1UL << (int32_t) U_GNSS_PRIVATE_FEATURE_CFGVALXXX) |      \
+     (1UL << (int32_t) U_GNSS_PRIVATE_FEATURE_CFG_PM))
+
+/** Return true if the pointed-to module is of the given type; where
+ * U_CFG_GNSS_MODULE_FIXED is defined (e.g.
+ * U_CFG_GNSS_MODULE_FIXED=U_GNSS_MODULE_TYPE_M9, for a product that
+ * only ever has the one module type) this, and U_GNSS_PRIVATE_HAS(),
+ * are compile-time constants, allowing the compiler to remove the
+ * code that handles any other module type; uGnssAdd() will refuse
+ * any other module type.
+ */
+#ifdef U_CFG_GNSS_MODULE_FIXED
+# define U_GNSS_PRIVATE_MODULE_IS(pModule, type) \
+    ((U_CFG_GNSS_MODULE_FIXED) == (type))
+#else
+# define U_GNSS_PRIVATE_MODULE_IS(pModule, type) \
+    ((pModule)->moduleType == (type))
+#endif
+
 /** Determine if the given feature is supported or not
  * by the pointed-to module.
  */
@@ -82,8 +118,15 @@ extern "C" {
 // evaluates to True
 //lint -esym(755, U_GNSS_PRIVATE_HAS) Suppress macro not
 // referenced it may be conditionally compiled-out.
-#define U_GNSS_PRIVATE_HAS(pModule, feature) \
+#ifdef U_CFG_GNSS_MODULE_FIXED
+# define U_GNSS_PRIVATE_HAS(pModule, feature)                                        \
+    ((pModule != NULL) &&                                                            \
+     ((((U_CFG_GNSS_MODULE_FIXED) == U_GNSS_MODULE_TYPE_M9) ? U_GNSS_PRIVATE_FEATURES_M9 : \
+       U_GNSS_PRIVATE_FEATURES_M8) & (1UL << (int32_t) (feature))))
+#else
+# define U_GNSS_PRIVATE_HAS(pModule, feature) \
     ((pModule != NULL) && ((pModule->featuresBitmap) & (1UL << (int32_t) (feature))))
+#endif
 
 /** Flag to indicate that the pos task has run (for synchronisation
  * purposes.
@@ -104,7 +147,9 @@ extern "C" {
 //lint -esym(756, uGnssPrivateFeature_t) Suppress not referenced,
 // Lint can't seem to find it inside macros.
 typedef enum {
-    U_GNSS_PRIVATE_FEATURE_CFGVALXXX
+    U_GNSS_PRIVATE_FEATURE_CFGVALXXX,
+    U_GNSS_PRIVATE_FEATURE_CFG_PM   /**< power save modes can be set
+                                         through CFG-PM. */
 } uGnssPrivateFeature_t;
 
 /** The characteristics that may differ between GNSS modules.
@@ -126,6 +171,7 @@ typedef enum {
     U_GNSS_PRIVATE_STREAM_TYPE_NONE,
     U_GNSS_PRIVATE_STREAM_TYPE_UART,
     U_GNSS_PRIVATE_STREAM_TYPE_I2C,
+    U_GNSS_PRIVATE_STREAM_TYPE_VIRTUAL_SERIAL,
     U_GNSS_PRIVATE_STREAM_TYPE_MAX_NUM
 } uGnssPrivateStreamType_t;
 
@@ -159,25 +205,111 @@ typedef struct uGnssPrivateMsgReader_t {
     void *pCallback; /**< stored as a void * to avoid having to bring
                           all the types of uGnssTransparentReceiveCallback_t
                           into everything. */
+    bool spanCallback; /**< true if pCallback is a
+                            uGnssMsgReceiveSpanCallback_t. */
+    bool oneShot; /**< true if pCallback is a
+                       uGnssMsgReceiveOneShotCallback_t. */
+    bool oneShotDone; /**< set when a one-shot reader is done, it is
+                           then removed by the message receive task. */
+    int32_t oneShotStartTimeMs;
+    int32_t oneShotTimeoutMs;
+    size_t slot; /**< the index of this reader in pReaderSlot[]
+                      of uGnssPrivateMsgReceive_t. */
     void *pCallbackParam;
     struct uGnssPrivateMsgReader_t *pNext;
 } uGnssPrivateMsgReader_t;
 
+/** An index over the readers of the message receive task, rebuilt
+ * whenever a reader is added or removed, so that the task can find
+ * the readers that might want a message without matching the message
+ * against every one of them.  Bit n of each mask represents the reader
+ * in pReaderSlot[n] of uGnssPrivateMsgReceive_t; a set bit only makes
+ * that reader a candidate, uGnssPrivateMessageIdIsWanted() still has
+ * the final say since hashes may collide.
+ */
+typedef struct {
+    uint32_t any; /**< readers of #U_GNSS_PROTOCOL_ANY. */
+    uint32_t all; /**< readers of #U_GNSS_PROTOCOL_ALL. */
+    uint32_t protocol[U_GNSS_PROTOCOL_MAX_NUM]; /**< readers of every message
+                                                     of a protocol, or with a
+                                                     pattern that can't be
+                                                     hashed (NMEA with '?'). */
+    uint32_t bucket[U_GNSS_PRIVATE_MSG_INDEX_NUM_BUCKETS]; /**< readers of a
+                                                                specific message
+                                                                ID, by hash. */
+} uGnssPrivateMsgIndex_t;
+
 /** Structure to hold the data associated with the task running
  * the non-blocking message receive utility functions.
  */
 typedef struct {
     int32_t nextHandle;
     uPortTaskHandle_t taskHandle;
-    char *pTemporaryBuffer;
     uPortMutexHandle_t taskRunningMutexHandle;
     uPortQueueHandle_t taskExitQueueHandle;
     uPortMutexHandle_t readerMutexHandle;
     int32_t ringBufferReadHandle;
     size_t msgBytesLeftToRead;
     uGnssPrivateMsgReader_t *pReaderList;
+    uGnssPrivateMsgReader_t *pReaderSlot[U_GNSS_MSG_RECEIVER_MAX_NUM]; /**< the
+                                                                            readers
+                                                                            in pReaderList,
+                                                                            by slot. */
+    uGnssPrivateMsgIndex_t index;
+    int64_t arrivalTimeUs; /**< when the data now being handled arrived,
+                                -1 if there is none, for the latency
+                                statistic. */
+    size_t discardSize;
+    struct uGnssPrivateInstance_t *pSharedNext; /**< the next instance serviced
+                                                     by the shared message
+                                                     receive task, only used if
+                                                     U_GNSS_MSG_RECEIVE_TASK_SHARED
+                                                     is defined. */
 } uGnssPrivateMsgReceive_t;
 
+/** A configuration value held in the configuration cache.
+ */
+typedef struct {
+    uint32_t keyId;
+    uint64_t value;
+} uGnssPrivateCfgCacheEntry_t;
+
+/** A cache of configuration values that are known to be current in
+ * the RAM layer of the GNSS chip, see uGnssCfgSetCacheSize().
+ */
+typedef struct {
+    uGnssPrivateCfgCacheEntry_t *pEntry; /**< storage for maxNumEntries entries. */
+    size_t maxNumEntries;
+    size_t numEntries;
+    size_t nextEntry;    /**< the entry to replace when the cache is full. */
+    int32_t protocolOut; /**< the cached uGnssCfgGetProtocolOut() bit-map,
+                              -1 if not known. */
+    uint32_t hits;
+    uint32_t misses;
+} uGnssPrivateCfgCache_t;
+
+/** Structure to hold the data associated with a streamed position
+ * request, see uGnssPosGetStreamedStart().
+ */
+typedef struct {
+    int32_t asyncHandle; /**< the handle of the message receiver
+                              capturing UBX-NAV-PVT, -1 if there isn't one. */
+    uint32_t msgOutKeyId; /**< the CFG-MSGOUT key ID used to switch
+                               UBX-NAV-PVT output on for our port. */
+    void (*pCallback) (uDeviceHandle_t gnssHandle,
+                       int32_t errorCode,
+                       int32_t latitudeX1e7,
+                       int32_t longitudeX1e7,
+                       int32_t altitudeMillimetres,
+                       int32_t radiusMillimetres,
+                       int32_t speedMillimetresPerSecond,
+                       int32_t svs,
+                       int64_t timeUtc);
+    struct uGnssPrivateInstance_t *pInstance; /**< the instance that owns
+                                                   this context, for the
+                                                   energy accounts. */
+} uGnssPrivateStreamedPosition_t;
+
 /** Definition of a GNSS instance.
  * Note: a pointer to this structure is passed to the asynchronous
  * "get position" function (posGetTask()) which does NOT lock the
@@ -194,7 +326,7 @@ typedef struct uGnssPrivateInstance_t {
     uGnssTransportHandle_t transportHandle; /**< the handle of the transport to use. */
     uRingBuffer_t ringBuffer; /**< the ring buffer where we put messages from the GNSS chip. */
     char *pLinearBuffer; /**< the linear buffer that will be used by ringBuffer. */
-    char *pTemporaryBuffer; /**< a temporary buffer, used to get stuff into ringBuffer. */
+    size_t readChunkLengthBytes; /**< the maximum amount of data to read into ringBuffer in one go. */
     int32_t ringBufferReadHandlePrivate; /**< the read handle for this code to use, -1 if there isn't one. */
     int32_t ringBufferReadHandleMsgReceive; /**< the read handle for uGnssUtilTransparentReceive(). */
     uint16_t i2cAddress; /**< the I2C address of the GNSS chip, only relevant if the transport is I2C. */
@@ -204,6 +336,8 @@ typedef struct uGnssPrivateInstance_t {
     int32_t pinGnssEnablePowerOnState; /**< the value to set pinGnssEnablePower to for "on". */
     int32_t atModulePinPwr; /**< the pin of the AT module that enables power to the GNSS chip (only relevant for transport type AT). */
     int32_t atModulePinDataReady; /**< the pin of the AT module that is connected to the Data Ready pin of the GNSS chip (only relevant for transport type AT). */
+    int32_t pinDataReady; /**< the pin of this MCU that is connected to the Data Ready pin of the GNSS chip, -1 if there isn't one (only relevant for I2C). */
+    int32_t pinDataReadyAssertedState; /**< the value that pinDataReady reads as when it is asserted. */
     uGnssPort_t portNumber; /**< the internal port number of the GNSS device that we are connected on. */
     uPortMutexHandle_t transportMutex; /**< mutex so that we can have an asynchronous
                                             task use the transport. */
@@ -212,8 +346,30 @@ typedef struct uGnssPrivateInstance_t {
     uPortMutexHandle_t posMutex; /**< handle for mutex associated with
                                       non-blocking position establishment. */
     volatile uint8_t posTaskFlags; /**< flags to synchronisation the pos task. */
+    uGnssPrivateStreamedPosition_t *pStreamedPosition; /**< context for streamed position,
+                                                            NULL if not active. */
+    void *pTimeSync; /**< the uGnssTimeSync_t context of time synchronisation,
+                          owned by the application, NULL if not active. */
+    uGnssPrivateCfgCache_t *pCfgCache; /**< the configuration cache, NULL if
+                                            there isn't one. */
     uGnssPrivateMsgReceive_t *pMsgReceive; /**< stuff associated with the asychronous
                                                 message receive utility functions. */
+    uGnssMsgStats_t stats; /**< transport statistics, see uGnssMsgReceiveStatGet();
+                                periodMs is not maintained here. */
+    int32_t statsStartTimeMs; /**< the time at which stats.bytesReceived started counting. */
+    void *pEnergyContext; /**< the energy accounts, see uGnssPwrEnergyStart(),
+                               NULL if not active; a void * to keep the
+                               types of u_gnss_pwr.h out of here. */
+    void *pPsmContext; /**< the duty cycle monitor of a power save mode, see
+                            uGnssPwrSetPsm(), NULL if not active. */
+    void *pGeofenceContext; /**< the geofence callback, see uGnssGeofenceSet(),
+                                 NULL if not active. */
+    void *volatile pRecord; /**< the raw stream recording, see uGnssRecordStart(),
+                                 NULL if not active. */
+    uPortMutexHandle_t recordMutex; /**< protects pRecord; created with the first
+                                         recording and kept until the instance
+                                         is removed, so that the fill path can
+                                         always lock it. */
     struct uGnssPrivateInstance_t *pNext;
 } uGnssPrivateInstance_t;
 // *INDENT-ON*
@@ -310,6 +466,57 @@ int32_t uGnssPrivateSetProtocolOut(uGnssPrivateInstance_t *pInstance,
                                    uGnssProtocol_t protocol,
                                    bool onNotOff);
 
+/** Look up a configuration value in the configuration cache of
+ * an instance, counting a hit or a miss; does nothing if there is
+ * no configuration cache.
+ *
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param[in] pInstance  a pointer to the GNSS instance, cannot be NULL.
+ * @param keyId          the key ID to look up.
+ * @param[out] pValue    a place to put the value; cannot be NULL.
+ * @return               true if the value was found, else false.
+ */
+bool uGnssPrivateCfgCacheGet(uGnssPrivateInstance_t *pInstance,
+                             uint32_t keyId, uint64_t *pValue);
+
+/** Put a configuration value into the configuration cache of an
+ * instance, replacing any existing value for the key or, if the cache
+ * is full, the oldest entry; does nothing if there is no configuration
+ * cache.
+ *
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param[in] pInstance  a pointer to the GNSS instance, cannot be NULL.
+ * @param keyId          the key ID.
+ * @param value          the value, which should already have been
+ *                       truncated to the storage size of keyId.
+ */
+void uGnssPrivateCfgCacheSet(uGnssPrivateInstance_t *pInstance,
+                             uint32_t keyId, uint64_t value);
+
+/** Remove a configuration value from the configuration cache of an
+ * instance; does nothing if there is no configuration cache or the
+ * value is not in it.
+ *
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param[in] pInstance  a pointer to the GNSS instance, cannot be NULL.
+ * @param keyId          the key ID.
+ */
+void uGnssPrivateCfgCacheDelete(uGnssPrivateInstance_t *pInstance,
+                                uint32_t keyId);
+
+/** Empty the configuration cache of an instance, e.g. because the
+ * GNSS chip has been powered off; the hit/miss counters are not
+ * affected.  Does nothing if there is no configuration cache.
+ *
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param[in] pInstance  a pointer to the GNSS instance, cannot be NULL.
+ */
+void uGnssPrivateCfgCacheInvalidate(uGnssPrivateInstance_t *pInstance);
+
 /** Shut down and free memory from a [potentially] running pos task.
  *
  * Note: gUGnssPrivateMutex should be locked before this is called.
@@ -330,6 +537,95 @@ void uGnssPrivateCleanUpPosTask(uGnssPrivateInstance_t *pInstance);
 */
 bool uGnssPrivateIsInsideCell(const uGnssPrivateInstance_t *pInstance);
 
+/** Move the energy accounts of an instance, if uGnssPwrEnergyStart()
+ * has been called, into the given power state; does nothing if
+ * energy accounting is not running.  This may be called without
+ * gUGnssPrivateMutex locked, e.g. from the position task.
+ *
+ * @param[in] pInstance  a pointer to the GNSS instance, cannot be NULL.
+ * @param state          the state, a value from #uGnssPwrEnergyState_t.
+ * @param isFix          true if the state is being entered because
+ *                       a position fix has been obtained, in which
+ *                       case the fix is counted.
+ */
+void uGnssPrivateEnergyState(const uGnssPrivateInstance_t *pInstance,
+                             int32_t state, bool isFix);
+
+/** Free the energy accounts of an instance, if there are any.
+ *
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param[in] pInstance  a pointer to the GNSS instance, cannot be NULL.
+ */
+void uGnssPrivateEnergyRemove(uGnssPrivateInstance_t *pInstance);
+
+/** Free the duty cycle monitor of any power save mode of an
+ * instance; the mode of the GNSS chip is not changed.  The message
+ * receiver that the monitor uses must already have been stopped.
+ *
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param[in] pInstance  a pointer to the GNSS instance, cannot be NULL.
+ */
+void uGnssPrivatePsmRemove(uGnssPrivateInstance_t *pInstance);
+
+/** Free the geofence callback context of an instance, if there is
+ * one; the geofences of the GNSS chip are not changed.  The message
+ * receiver that the callback uses must already have been stopped.
+ *
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param[in] pInstance  a pointer to the GNSS instance, cannot be NULL.
+ */
+void uGnssPrivateGeofenceRemove(uGnssPrivateInstance_t *pInstance);
+
+/** Decode a UBX-NAV-GEOFENCE message and update the given geofence
+ * states from it.  A message that reports geofencing as not being
+ * active (status 0) is ignored.
+ *
+ * @param[in] pMessage           the complete UBX-NAV-GEOFENCE message,
+ *                               including header and checksum, cannot
+ *                               be NULL.
+ * @param size                   the number of bytes at pMessage.
+ * @param numFences              the number of entries at pState.
+ * @param[in,out] pCombinedState the combined state, updated by this
+ *                               function, cannot be NULL.
+ * @param[in,out] pState         an array of numFences states, updated
+ *                               by this function, cannot be NULL.
+ * @return                       1 if a state has changed, 0 if
+ *                               none have changed, else negative
+ *                               error code if the message was not
+ *                               a valid UBX-NAV-GEOFENCE message
+ *                               with geofencing active.
+ */
+int32_t uGnssPrivateGeofenceUpdate(const char *pMessage, size_t size,
+                                   size_t numFences,
+                                   uGnssGeofenceState_t *pCombinedState,
+                                   uGnssGeofenceState_t *pState);
+
+/** Copy data that has just been read from the transport into the
+ * raw stream recording, if there is one; this never waits for the
+ * sink of the recording.  Called from the fill path, which does not
+ * lock gUGnssPrivateMutex.
+ *
+ * @param[in] pInstance  a pointer to the GNSS instance, cannot be NULL.
+ * @param[in] pData      the data.
+ * @param size           the number of bytes at pData.
+ */
+void uGnssPrivateRecordTee(const uGnssPrivateInstance_t *pInstance,
+                           const char *pData, size_t size);
+
+/** Stop any raw stream recording of an instance and free it,
+ * along with the mutex that protects it; the fill path must no
+ * longer be running, i.e. uGnssPrivateStopMsgReceive() must have
+ * been called.
+ *
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param[in] pInstance  a pointer to the GNSS instance, cannot be NULL.
+ */
+void uGnssPrivateRecordRemove(uGnssPrivateInstance_t *pInstance);
+
 /** Stop the asynchronous message receive task; kept here so that
  * GNSS deinitialisation can call it.
  *
@@ -339,6 +635,19 @@ bool uGnssPrivateIsInsideCell(const uGnssPrivateInstance_t *pInstance);
  */
 void uGnssPrivateStopMsgReceive(uGnssPrivateInstance_t *pInstance);
 
+#ifdef U_GNSS_MSG_RECEIVE_TASK_SHARED
+/** Take an instance out of the set serviced by the message receive
+ * task that is shared between all GNSS instances, stopping that task
+ * if no instance is left; called by uGnssPrivateStopMsgReceive() and
+ * implemented in u_gnss_msg.c, where the shared task lives.
+ *
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param[in] pInstance  a pointer to the GNSS instance, cannot  be NULL.
+ */
+void uGnssPrivateMsgReceiveSharedLeave(uGnssPrivateInstance_t *pInstance);
+#endif
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: MESSAGE RELATED
  * -------------------------------------------------------------- */
@@ -398,19 +707,13 @@ bool uGnssPrivateMessageIdIsWanted(uGnssPrivateMessageId_t *pMessageId,
 int32_t uGnssPrivateGetStreamType(uGnssTransportType_t transportType);
 
 /** Get the number of bytes waiting for us from the GNSS chip when using
- * a streaming transport (e.g. UART or I2C).
+ * a streaming transport (e.g. UART, I2C or virtual serial).
  *
- * @param streamHandle  the handle of the streaming transport.
- * @param streamType    the streaming transport type.
- * @param i2cAddress    the I2C address of the GNSS device, must be
- *                      populated if streamType is
- *                      #U_GNSS_PRIVATE_STREAM_TYPE_I2C.
+ * @param[in] pInstance a pointer to the GNSS instance, cannot be NULL.
  * @return              the number of bytes available to be received,
  *                      else negative error code.
  */
-int32_t uGnssPrivateStreamGetReceiveSize(int32_t streamHandle,
-                                         uGnssPrivateStreamType_t streamType,
-                                         uint16_t i2cAddress);
+int32_t uGnssPrivateStreamGetReceiveSize(const uGnssPrivateInstance_t *pInstance);
 
 /** Fill the internal ring buffer with as much data as possible from
  * the GNSS chip when using a streaming transport (e.g. UART or I2C).
@@ -687,6 +990,42 @@ int32_t uGnssPrivateSendReceiveUbxMessage(uGnssPrivateInstance_t *pInstance,
                                           char *pResponseBody,
                                           size_t maxResponseBodyLengthBytes);
 
+/** As uGnssPrivateSendReceiveUbxMessage() but for the case where the
+ * response has a different message class/ID to the message sent,
+ * e.g. a UBX-MGA-XXX message which is acknowledged with UBX-MGA-ACK.
+ *
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param[in] pInstance              a pointer to the GNSS instance, cannot
+ *                                   be NULL.
+ * @param messageClass               the UBX message class to send.
+ * @param messageId                  the UBX message ID to send.
+ * @param[in] pMessageBody           the body of the message to send; may be
+ *                                   NULL.
+ * @param messageBodyLengthBytes     the amount of data at pMessageBody; must
+ *                                   be non-zero if pMessageBody is non-NULL.
+ * @param responseMessageClass       the UBX message class of the expected
+ *                                   response, -1 for any.
+ * @param responseMessageId          the UBX message ID of the expected
+ *                                   response, -1 for any.
+ * @param[out] pResponseBody         a pointer to somewhere to store the
+ *                                   response body, cannot be NULL.
+ * @param maxResponseBodyLengthBytes the amount of storage at pResponseBody;
+ *                                   must be non-zero.
+ * @return                           the number of bytes in the body of the
+ *                                   response from the GNSS module, else
+ *                                   negative error code.
+ */
+int32_t uGnssPrivateSendReceiveUbxMessageResponse(uGnssPrivateInstance_t *pInstance,
+                                                  int32_t messageClass,
+                                                  int32_t messageId,
+                                                  const char *pMessageBody,
+                                                  size_t messageBodyLengthBytes,
+                                                  int32_t responseMessageClass,
+                                                  int32_t responseMessageId,
+                                                  char *pResponseBody,
+                                                  size_t maxResponseBodyLengthBytes);
+
 /** Send a UBX format message to the GNSS module and receive a response of
  * unknown length, allocating memory to do so. IT IS UP TO THE CALLER TO
  * FREE THIS MEMORY WHEN DONE.  May be used with any transport.  For a
@@ -741,6 +1080,93 @@ int32_t uGnssPrivateSendUbxMessage(uGnssPrivateInstance_t *pInstance,
                                    const char *pMessageBody,
                                    size_t messageBodyLengthBytes);
 
+/** As uGnssPrivateSendUbxMessage() but the caller has assembled the
+ * message body in pBuffer at offset #U_UBX_PROTOCOL_HEADER_LENGTH_BYTES,
+ * leaving room for the UBX header before it and the checksum after it,
+ * so that the message can be encoded in place without a copy; useful
+ * for long messages, e.g. UBX-CFG-VALSET.
+ *
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param[in] pInstance              a pointer to the GNSS instance, cannot
+ *                                   be NULL.
+ * @param messageClass               the UBX message class.
+ * @param messageId                  the UBX message ID.
+ * @param[in,out] pBuffer            the buffer containing the message body,
+ *                                   at least messageBodyLengthBytes +
+ *                                   #U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES
+ *                                   in size; cannot be NULL.  The contents
+ *                                   outside the message body are overwritten.
+ * @param messageBodyLengthBytes     the length of the message body in pBuffer.
+ * @return                           zero on success else negative error code;
+ *                                   if the message has been nacked by the GNSS
+ *                                   module #U_GNSS_ERROR_NACK will be returned.
+ */
+int32_t uGnssPrivateSendUbxMessageInPlace(uGnssPrivateInstance_t *pInstance,
+                                          int32_t messageClass,
+                                          int32_t messageId,
+                                          char *pBuffer,
+                                          size_t messageBodyLengthBytes);
+
+/** As uGnssPrivateSendReceiveUbxMessage() but with the message body
+ * already in place in pBuffer, as for uGnssPrivateSendUbxMessageInPlace(),
+ * so that no memory need be allocated for the outgoing message.  The
+ * response may be written to the same buffer, since the outgoing
+ * message has been sent by the time the response is received.
+ *
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param[in] pInstance              a pointer to the GNSS instance, cannot
+ *                                   be NULL.
+ * @param messageClass               the UBX message class.
+ * @param messageId                  the UBX message ID.
+ * @param[in,out] pBuffer            the buffer containing the message body,
+ *                                   as for uGnssPrivateSendUbxMessageInPlace();
+ *                                   cannot be NULL.
+ * @param messageBodyLengthBytes     the length of the message body in pBuffer.
+ * @param[out] pResponseBody         a pointer to somewhere to store the
+ *                                   response body; may be NULL, may be pBuffer.
+ * @param maxResponseBodyLengthBytes the amount of storage at pResponseBody;
+ *                                   must be non-zero if pResponseBody is non-NULL.
+ * @return                           the number of bytes in the body of the response
+ *                                   from the GNSS module (irrespective of the value
+ *                                   of maxResponseBodyLengthBytes), else negative
+ *                                   error code.
+ */
+int32_t uGnssPrivateSendReceiveUbxMessageInPlace(uGnssPrivateInstance_t *pInstance,
+                                                 int32_t messageClass,
+                                                 int32_t messageId,
+                                                 char *pBuffer,
+                                                 size_t messageBodyLengthBytes,
+                                                 char *pResponseBody,
+                                                 size_t maxResponseBodyLengthBytes);
+
+/** Poll several UBX messages, each with an empty body, and collect
+ * the responses, which must have the same class and ID as the poll,
+ * in whatever order they arrive within a single timeout.  For a
+ * streamed transport all of the polls are sent before any response
+ * is waited for; for an AT transport the polls are made one at a
+ * time with uGnssPrivateSendReceiveUbxMessage(), since only one
+ * response can be outstanding, and timeoutMs is not used.
+ *
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param[in] pInstance   a pointer to the GNSS instance, cannot
+ *                        be NULL.
+ * @param[in,out] pPoll   the messages to poll, in which the outcome
+ *                        of each is returned, see #uGnssMsgUbxPoll_t;
+ *                        cannot be NULL.
+ * @param numPolls        the number of entries at pPoll.
+ * @param timeoutMs       the time to wait for all of the responses
+ *                        in milliseconds.
+ * @return                the number of polls that were answered,
+ *                        else negative error code.
+ */
+int32_t uGnssPrivateSendReceiveUbxMessageBatch(uGnssPrivateInstance_t *pInstance,
+                                               uGnssMsgUbxPoll_t *pPoll,
+                                               size_t numPolls,
+                                               int32_t timeoutMs);
+
 #ifdef __cplusplus
 }
 #endif
@@ -37,6 +37,7 @@
 #include "u_error_common.h"
 
 #include "u_port.h"
+#include "u_port_heap.h"
 #include "u_port_os.h"  // Required by u_gnss_private.h
 #include "u_port_gpio.h"
 #include "u_port_debug.h"
@@ -47,7 +48,13 @@
 
 #include "u_gnss_module_type.h"
 #include "u_gnss_type.h"
+#include "u_gnss.h"
 #include "u_gnss_private.h"
+#include "u_gnss_mga.h"
+#include "u_gnss_msg.h"
+#include "u_gnss_msg_ubx.h"
+#include "u_gnss_cfg_val_key.h"
+#include "u_gnss_cfg.h"
 #include "u_gnss_pwr.h"
 
 /* ----------------------------------------------------------------
@@ -78,6 +85,33 @@
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The energy accounts of a GNSS instance, hooked into
+ * pEnergyContext of the instance by uGnssPwrEnergyStart().
+ */
+typedef struct {
+    uPortMutexHandle_t mutex; /**< since fixes arrive from other tasks. */
+    uGnssPwrEnergyState_t state;
+    int32_t stateStartTimeMs;
+    int64_t timeMs[U_GNSS_PWR_ENERGY_STATE_MAX_NUM];
+    uint32_t fixes;
+    bool hasTable;
+    uGnssPwrCurrentTable_t table;
+} uGnssPwrEnergyContext_t;
+
+/** The duty cycle monitor of a power save mode, hooked into
+ * pPsmContext of the instance by uGnssPwrSetPsm().
+ */
+typedef struct {
+    uPortMutexHandle_t mutex; /**< since UBX-MON-RXR arrives in another task. */
+    int32_t asyncHandle;      /**< the UBX-MON-RXR message receiver. */
+    bool started;             /**< true once the first UBX-MON-RXR has arrived. */
+    bool awake;
+    int32_t startTimeMs;
+    int32_t lastTimeMs;
+    int64_t awakeMs;
+    uint32_t wakeUps;
+} uGnssPwrPsmContext_t;
+
 /* ----------------------------------------------------------------
  * STATIC VARIABLES
  * -------------------------------------------------------------- */
@@ -86,6 +120,315 @@
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Add the time spent in the current state to its account and
+// restart the clock: pContext->mutex must be locked.
+static void energyUpdate(uGnssPwrEnergyContext_t *pContext)
+{
+    int32_t nowMs = uPortGetTickTimeMs();
+
+    pContext->timeMs[pContext->state] += (int32_t) ((uint32_t) nowMs -
+                                                    (uint32_t) pContext->stateStartTimeMs);
+    pContext->stateStartTimeMs = nowMs;
+}
+
+// Stop the GNSS chip and ask it to save its state to flash with
+// UBX-UPD-SOS; gUGnssPrivateMutex must be locked.
+static int32_t saveStateFlash(uGnssPrivateInstance_t *pInstance)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+    int32_t timeoutMs;
+    // Enough room for the body of UBX-CFG-RST, the body of a
+    // UBX-UPD-SOS command and the body of the UBX-UPD-SOS response
+    char message[8] = {0};
+
+    // Stop GNSS first with UBX-CFG-RST, which is not acknowledged
+    message[2] = 0x08; // Controlled GNSS stop
+    if (uGnssPrivateSendOnlyCheckStreamUbxMessage(pInstance,
+                                                  0x06, 0x04,
+                                                  message, 4) > 0) {
+        // Writing to flash can take a while
+        timeoutMs = pInstance->timeoutMs;
+        pInstance->timeoutMs = U_GNSS_PWR_SAVE_STATE_TIMEOUT_SECONDS * 1000;
+        // UBX-UPD-SOS with command 0 creates the backup; the response
+        // is UBX-UPD-SOS with command 2 and, at offset 4, 1 for success
+        memset(message, 0, sizeof(message));
+        errorCode = uGnssPrivateSendReceiveUbxMessage(pInstance,
+                                                      0x09, 0x14,
+                                                      message, 4,
+                                                      message,
+                                                      sizeof(message));
+        pInstance->timeoutMs = timeoutMs;
+        if (errorCode == sizeof(message)) {
+            errorCode = (int32_t) U_GNSS_ERROR_NACK;
+            if ((message[0] == 2) && (message[4] == 1)) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        } else if (errorCode >= 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+        }
+        // The configuration in RAM may not survive what comes next
+        uGnssPrivateCfgCacheInvalidate(pInstance);
+    }
+
+    return errorCode;
+}
+
+// Read the navigation database of the GNSS chip as a sequence of
+// UBX-MGA-DBD messages, passing each to pCallback, returning the
+// number of messages; gUGnssPrivateMutex must be locked.
+static int32_t saveStateHost(uGnssPrivateInstance_t *pInstance,
+                             uGnssPwrSaveCallback_t *pCallback,
+                             void *pCallbackParam)
+{
+    int32_t errorCodeOrCount;
+    uGnssPrivateMessageId_t privateMessageId;
+    int32_t readHandle = pInstance->ringBufferReadHandlePrivate;
+    char *pBuffer;
+    int32_t x;
+
+    // As in sendReceiveUbxMessage(), clear out any historical data
+    // and lock our read pointer before sending the poll so that
+    // nothing is lost
+    uGnssPrivateStreamFillRingBuffer(pInstance,
+                                     U_GNSS_RING_BUFFER_MIN_FILL_TIME_MS,
+                                     U_GNSS_RING_BUFFER_MAX_FILL_TIME_MS);
+    uRingBufferLockReadHandle(&(pInstance->ringBuffer), readHandle);
+    uRingBufferFlushHandle(&(pInstance->ringBuffer), readHandle);
+
+    // Poll UBX-MGA-DBD
+    errorCodeOrCount = uGnssPrivateSendOnlyStreamUbxMessage(pInstance,
+                                                            0x13, 0x80,
+                                                            NULL, 0);
+    if (errorCodeOrCount >= 0) {
+        errorCodeOrCount = 0;
+        // Give the first message the normal timeout, after that
+        // stop once the messages stop coming
+        x = pInstance->timeoutMs;
+        do {
+            privateMessageId.type = U_GNSS_PROTOCOL_UBX;
+            privateMessageId.id.ubx = 0x1380;
+            pBuffer = NULL;
+            x = uGnssPrivateReceiveStreamMessage(pInstance, &privateMessageId,
+                                                 readHandle, &pBuffer, 0,
+                                                 x, NULL);
+            if (x > 0) {
+                pCallback(pInstance->gnssHandle, pBuffer, (size_t) x, pCallbackParam);
+                errorCodeOrCount++;
+                x = U_GNSS_PWR_SAVE_STATE_MESSAGE_TIMEOUT_MS;
+            } else if ((x != (int32_t) U_ERROR_COMMON_TIMEOUT) ||
+                       (errorCodeOrCount == 0)) {
+                // Error, or nothing at all came back
+                errorCodeOrCount = x;
+            }
+            uPortFree(pBuffer);
+        } while (x > 0);
+    }
+
+    uRingBufferUnlockReadHandle(&(pInstance->ringBuffer), readHandle);
+
+    return errorCodeOrCount;
+}
+
+// Return the CFG-MSGOUT key ID that controls UBX-MON-RXR output
+// on the given port.
+static uint32_t psmMsgOutKeyId(uGnssPort_t port)
+{
+    uint32_t keyId = U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_MON_RXR_I2C_U1;
+
+    switch (port) {
+        case U_GNSS_PORT_UART:
+            keyId = U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_MON_RXR_UART1_U1;
+            break;
+        case U_GNSS_PORT_UART2:
+            keyId = U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_MON_RXR_UART2_U1;
+            break;
+        case U_GNSS_PORT_USB:
+            keyId = U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_MON_RXR_USB_U1;
+            break;
+        case U_GNSS_PORT_SPI:
+            keyId = U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_MON_RXR_SPI_U1;
+            break;
+        default:
+            break;
+    }
+
+    return keyId;
+}
+
+// Add the time since the last update to the awake account, if
+// awake, and restart the clock: pContext->mutex must be locked.
+static void psmUpdate(uGnssPwrPsmContext_t *pContext, int32_t nowMs)
+{
+    if (pContext->started && pContext->awake) {
+        pContext->awakeMs += nowMs - pContext->lastTimeMs;
+    }
+    pContext->lastTimeMs = nowMs;
+}
+
+// Callback for UBX-MON-RXR, which the GNSS chip emits each time it
+// wakes up or goes to sleep.
+static void psmMessageCallback(uDeviceHandle_t gnssHandle,
+                               const uGnssMessageId_t *pMessageId,
+                               int32_t errorCodeOrLength,
+                               void *pCallbackParam)
+{
+    uGnssPwrPsmContext_t *pContext = (uGnssPwrPsmContext_t *) pCallbackParam;
+    char message[U_GNSS_MSG_UBX_MON_RXR_BODY_LENGTH_BYTES + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+    const uGnssMsgUbxMonRxr_t *pMonRxr;
+    int32_t nowMs;
+    bool awake;
+
+    (void) pMessageId;
+
+    if ((errorCodeOrLength > 0) && (errorCodeOrLength <= (int32_t) sizeof(message)) &&
+        (uGnssMsgReceiveCallbackRead(gnssHandle, message,
+                                     (size_t) errorCodeOrLength) == errorCodeOrLength)) {
+        pMonRxr = pUGnssMsgUbxMonRxr(message, (size_t) errorCodeOrLength);
+        if (pMonRxr != NULL) {
+            nowMs = uPortGetTickTimeMs();
+            awake = ((pMonRxr->flags & 0x01) != 0);
+            U_PORT_MUTEX_LOCK(pContext->mutex);
+            psmUpdate(pContext, nowMs);
+            if (!pContext->started) {
+                pContext->started = true;
+                pContext->startTimeMs = nowMs;
+            } else if (awake && !pContext->awake) {
+                pContext->wakeUps++;
+            }
+            pContext->awake = awake;
+            U_PORT_MUTEX_UNLOCK(pContext->mutex);
+        }
+    }
+}
+
+// Free a duty cycle monitor, the message receiver of which
+// must already have been stopped.
+static void psmFree(uGnssPwrPsmContext_t *pContext)
+{
+    if (pContext != NULL) {
+        // Make sure no-one is still in there
+        U_PORT_MUTEX_LOCK(pContext->mutex);
+        U_PORT_MUTEX_UNLOCK(pContext->mutex);
+        uPortMutexDelete(pContext->mutex);
+        uPortFree(pContext);
+    }
+}
+
+// Check a power save configuration and fill in the list of values
+// that apply it, returning the number of values or negative error
+// code; cfgVal must have room for five values.
+static int32_t psmCfgVal(const uGnssPwrPsmConfig_t *pConfig,
+                         uGnssCfgVal_t *pCfgVal)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    size_t numValues = 0;
+
+    switch (pConfig->mode) {
+        case U_GNSS_PWR_PSM_MODE_CONTINUOUS:
+            if (pConfig->updatePeriodMs >= 0) {
+                if (pConfig->updatePeriodMs > 0) {
+                    pCfgVal[numValues].keyId = U_GNSS_CFG_VAL_KEY_ID_RATE_MEAS_U2;
+                    pCfgVal[numValues].value = (uint64_t) pConfig->updatePeriodMs;
+                    numValues++;
+                }
+                errorCodeOrCount = 0;
+            }
+            break;
+        case U_GNSS_PWR_PSM_MODE_CYCLIC_TRACKING:
+            // The update period of cyclic tracking is the
+            // measurement period
+            if ((pConfig->updatePeriodMs >= 1000) &&
+                (pConfig->updatePeriodMs <= U_GNSS_PWR_PSM_CYCLIC_TRACKING_MAX_PERIOD_MS)) {
+                pCfgVal[numValues].keyId = U_GNSS_CFG_VAL_KEY_ID_RATE_MEAS_U2;
+                pCfgVal[numValues].value = (uint64_t) pConfig->updatePeriodMs;
+                numValues++;
+                errorCodeOrCount = 0;
+            }
+            break;
+        case U_GNSS_PWR_PSM_MODE_ON_OFF:
+            // CFG-PM works in whole seconds, up to a week
+            if ((pConfig->updatePeriodMs >= U_GNSS_PWR_PSM_ON_OFF_MIN_PERIOD_MS) &&
+                (pConfig->updatePeriodMs % 1000 == 0) &&
+                (pConfig->updatePeriodMs / 1000 < 604800) &&
+                (pConfig->maxLatencyMs >= 0) &&
+                (pConfig->maxLatencyMs / 1000 <= 255)) {
+                pCfgVal[numValues].keyId = U_GNSS_CFG_VAL_KEY_ID_PM_POSUPDATEPERIOD_U4;
+                pCfgVal[numValues].value = (uint64_t) (pConfig->updatePeriodMs / 1000);
+                numValues++;
+                // Retry after a failed acquisition at the same rate
+                pCfgVal[numValues].keyId = U_GNSS_CFG_VAL_KEY_ID_PM_ACQPERIOD_U4;
+                pCfgVal[numValues].value = (uint64_t) (pConfig->updatePeriodMs / 1000);
+                numValues++;
+                pCfgVal[numValues].keyId = U_GNSS_CFG_VAL_KEY_ID_PM_MAXACQTIME_U1;
+                pCfgVal[numValues].value = (uint64_t) (pConfig->maxLatencyMs / 1000);
+                numValues++;
+                // Go back to sleep as soon as there is a fix
+                pCfgVal[numValues].keyId = U_GNSS_CFG_VAL_KEY_ID_PM_ONTIME_U2;
+                pCfgVal[numValues].value = 0;
+                numValues++;
+                errorCodeOrCount = 0;
+            }
+            break;
+        default:
+            break;
+    }
+
+    if (errorCodeOrCount == 0) {
+        pCfgVal[numValues].keyId = U_GNSS_CFG_VAL_KEY_ID_PM_OPERATEMODE_E1;
+        pCfgVal[numValues].value = (uint64_t) pConfig->mode;
+        numValues++;
+        errorCodeOrCount = (int32_t) numValues;
+    }
+
+    return errorCodeOrCount;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS THAT ARE PRIVATE TO GNSS
+ * -------------------------------------------------------------- */
+
+// Move the energy accounts into the given state.
+void uGnssPrivateEnergyState(const uGnssPrivateInstance_t *pInstance,
+                             int32_t state, bool isFix)
+{
+    uGnssPwrEnergyContext_t *pContext = (uGnssPwrEnergyContext_t *) pInstance->pEnergyContext;
+
+    if ((pContext != NULL) && (state >= 0) &&
+        (state < (int32_t) U_GNSS_PWR_ENERGY_STATE_MAX_NUM)) {
+        U_PORT_MUTEX_LOCK(pContext->mutex);
+        energyUpdate(pContext);
+        pContext->state = (uGnssPwrEnergyState_t) state;
+        if (isFix) {
+            pContext->fixes++;
+        }
+        U_PORT_MUTEX_UNLOCK(pContext->mutex);
+    }
+}
+
+// Free the energy accounts.
+void uGnssPrivateEnergyRemove(uGnssPrivateInstance_t *pInstance)
+{
+    uGnssPwrEnergyContext_t *pContext = (uGnssPwrEnergyContext_t *) pInstance->pEnergyContext;
+
+    if (pContext != NULL) {
+        pInstance->pEnergyContext = NULL;
+        // Make sure no-one is still in there
+        U_PORT_MUTEX_LOCK(pContext->mutex);
+        U_PORT_MUTEX_UNLOCK(pContext->mutex);
+        uPortMutexDelete(pContext->mutex);
+        uPortFree(pContext);
+    }
+}
+
+// Free the duty cycle monitor of a power save mode.
+void uGnssPrivatePsmRemove(uGnssPrivateInstance_t *pInstance)
+{
+    uGnssPwrPsmContext_t *pContext = (uGnssPwrPsmContext_t *) pInstance->pPsmContext;
+
+    pInstance->pPsmContext = NULL;
+    psmFree(pContext);
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -204,7 +547,7 @@ int32_t uGnssPwrOn(uDeviceHandle_t gnssHandle)
                                                                   0x06, 0x04,
                                                                   message, 4) > 0) {
                         errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-                        if (pInstance->pModule->moduleType == U_GNSS_MODULE_TYPE_M8) {
+                        if (U_GNSS_PRIVATE_MODULE_IS(pInstance->pModule, U_GNSS_MODULE_TYPE_M8)) {
                             errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
                             // From the M8 receiver description, a HW reset is also
                             // required at this point if Galileo is enabled,
@@ -248,6 +591,15 @@ int32_t uGnssPwrOn(uDeviceHandle_t gnssHandle)
                 uPortGpioSet(pInstance->pinGnssEnablePower,
                              (int32_t) !pInstance->pinGnssEnablePowerOnState);
             }
+
+            if ((errorCode == 0) && (pInstance->pEnergyContext != NULL) &&
+                (((uGnssPwrEnergyContext_t *) pInstance->pEnergyContext)->state <
+                 U_GNSS_PWR_ENERGY_STATE_ACQUISITION)) {
+                // Was off or in back-up, now looking for a fix
+                uGnssPrivateEnergyState(pInstance,
+                                        (int32_t) U_GNSS_PWR_ENERGY_STATE_ACQUISITION,
+                                        false);
+            }
         }
 
         U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
@@ -336,11 +688,19 @@ int32_t uGnssPwrOff(uDeviceHandle_t gnssHandle)
                 }
             }
 
+            // The configuration in RAM may not survive
+            uGnssPrivateCfgCacheInvalidate(pInstance);
+
             if (pInstance->pinGnssEnablePower >= 0) {
                 // Let this overwrite any other errors
                 errorCode = uPortGpioSet(pInstance->pinGnssEnablePower,
                                          (int32_t) !pInstance->pinGnssEnablePowerOnState);
             }
+
+            if (errorCode == 0) {
+                uGnssPrivateEnergyState(pInstance, (int32_t) U_GNSS_PWR_ENERGY_STATE_OFF,
+                                        false);
+            }
         }
 
         U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
@@ -366,6 +726,8 @@ int32_t uGnssPwrOffBackup(uDeviceHandle_t gnssHandle)
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
             if (pInstance->transportType != U_GNSS_TRANSPORT_AT) {
+                // The configuration in RAM may not survive
+                uGnssPrivateCfgCacheInvalidate(pInstance);
                 // Put the GNSS chip into backup mode with UBX-RXM-PMREQ
                 // This message is not acknowledged and fiddling with the
                 // GNSS chip after this will wake it up again, so we just
@@ -384,6 +746,383 @@ int32_t uGnssPwrOffBackup(uDeviceHandle_t gnssHandle)
                     errorCode = uPortGpioSet(pInstance->pinGnssEnablePower,
                                              (int32_t) !pInstance->pinGnssEnablePowerOnState);
                 }
+                if (errorCode == 0) {
+                    uGnssPrivateEnergyState(pInstance,
+                                            (int32_t) U_GNSS_PWR_ENERGY_STATE_BACKUP,
+                                            false);
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Save the navigation state of a GNSS chip.
+int32_t uGnssPwrSaveState(uDeviceHandle_t gnssHandle,
+                          uGnssPwrSaveCallback_t *pCallback,
+                          void *pCallbackParam)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (uGnssPrivateGetStreamType(pInstance->transportType) >= 0) {
+                if (pCallback == NULL) {
+                    errorCodeOrCount = saveStateFlash(pInstance);
+                } else {
+                    errorCodeOrCount = saveStateHost(pInstance, pCallback,
+                                                     pCallbackParam);
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCodeOrCount;
+}
+
+// Restore the navigation state of a GNSS chip.
+int32_t uGnssPwrRestoreState(uDeviceHandle_t gnssHandle,
+                             const char *pBuffer, size_t size)
+{
+    int32_t errorCodeOrResult = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    // The body of the UBX-UPD-SOS response
+    char message[8] = {0};
+
+    if (pBuffer != NULL) {
+        // Everything is in UBX-MGA-DBD messages, which are
+        // not acknowledged, hence the flow control
+        errorCodeOrResult = uGnssMgaSend(gnssHandle, pBuffer, size,
+                                         U_GNSS_MGA_FLOW_CONTROL_WAIT,
+                                         NULL, NULL);
+    } else if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCodeOrResult = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            errorCodeOrResult = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (uGnssPrivateGetStreamType(pInstance->transportType) >= 0) {
+                // Poll UBX-UPD-SOS: the response has command 3 and,
+                // at offset 4, the restore result
+                errorCodeOrResult = uGnssPrivateSendReceiveUbxMessage(pInstance,
+                                                                      0x09, 0x14,
+                                                                      NULL, 0,
+                                                                      message,
+                                                                      sizeof(message));
+                if (errorCodeOrResult == sizeof(message)) {
+                    errorCodeOrResult = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+                    if ((message[0] == 3) &&
+                        ((uint8_t) message[4] <= (uint8_t) U_GNSS_PWR_RESTORE_RESULT_NO_BACKUP)) {
+                        errorCodeOrResult = (int32_t) (uint8_t) message[4];
+                    }
+                } else if (errorCodeOrResult >= 0) {
+                    errorCodeOrResult = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCodeOrResult;
+}
+// Start energy accounting.
+int32_t uGnssPwrEnergyStart(uDeviceHandle_t gnssHandle,
+                            const uGnssPwrCurrentTable_t *pTable)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPwrEnergyContext_t *pContext;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            // Start from scratch
+            uGnssPrivateEnergyRemove(pInstance);
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pContext = (uGnssPwrEnergyContext_t *) pUPortMalloc(sizeof(*pContext));
+            if (pContext != NULL) {
+                memset(pContext, 0, sizeof(*pContext));
+                errorCode = uPortMutexCreate(&(pContext->mutex));
+                if (errorCode == 0) {
+                    if (pTable != NULL) {
+                        pContext->table = *pTable;
+                        pContext->hasTable = true;
+                    }
+                    pContext->state = U_GNSS_PWR_ENERGY_STATE_ACQUISITION;
+                    pContext->stateStartTimeMs = uPortGetTickTimeMs();
+                    pInstance->pEnergyContext = pContext;
+                } else {
+                    uPortFree(pContext);
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Get the energy accounts.
+int32_t uGnssPwrEnergyGet(uDeviceHandle_t gnssHandle,
+                          uGnssPwrEnergy_t *pEnergy)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPwrEnergyContext_t *pContext;
+    int64_t microjoules = 0;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pEnergy != NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+            pContext = (uGnssPwrEnergyContext_t *) pInstance->pEnergyContext;
+            if (pContext != NULL) {
+                U_PORT_MUTEX_LOCK(pContext->mutex);
+                energyUpdate(pContext);
+                memcpy(pEnergy->timeMs, pContext->timeMs, sizeof(pEnergy->timeMs));
+                pEnergy->fixes = pContext->fixes;
+                U_PORT_MUTEX_UNLOCK(pContext->mutex);
+                pEnergy->energyMicrojoules = -1;
+                pEnergy->energyPerFixMicrojoules = -1;
+                if (pContext->hasTable) {
+                    // ms * uA * mV is uJ * 1000000
+                    for (size_t x = 0; x < U_GNSS_PWR_ENERGY_STATE_MAX_NUM; x++) {
+                        microjoules += (pEnergy->timeMs[x] *
+                                        pContext->table.currentMicroAmps[x] *
+                                        pContext->table.supplyMillivolts) / 1000000;
+                    }
+                    pEnergy->energyMicrojoules = microjoules;
+                    if (pEnergy->fixes > 0) {
+                        pEnergy->energyPerFixMicrojoules = microjoules / pEnergy->fixes;
+                    }
+                }
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Stop energy accounting.
+void uGnssPwrEnergyStop(uDeviceHandle_t gnssHandle)
+{
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            uGnssPrivateEnergyRemove(pInstance);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+}
+
+// Set a power save mode.
+int32_t uGnssPwrSetPsm(uDeviceHandle_t gnssHandle,
+                       const uGnssPwrPsmConfig_t *pConfig)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPwrPsmContext_t *pOldContext = NULL;
+    uGnssPwrPsmContext_t *pContext = NULL;
+    uGnssMessageId_t messageId;
+    // Room for the values of psmCfgVal() plus CFG-MSGOUT
+    uGnssCfgVal_t cfgVal[6];
+    size_t numValues = 0;
+    uint32_t msgOutKeyId = 0;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pConfig != NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            // The duty cycle monitor relies on message receive, which
+            // only works for a GNSS chip that is directly connected,
+            // and the modes can only be set through CFG-PM
+            if ((pInstance->transportType != U_GNSS_TRANSPORT_AT) &&
+                U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX) &&
+                U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFG_PM)) {
+                errorCode = psmCfgVal(pConfig, cfgVal);
+                if (errorCode >= 0) {
+                    numValues = (size_t) errorCode;
+                    msgOutKeyId = psmMsgOutKeyId(pInstance->portNumber);
+                    // Take any existing monitor out, we will start afresh
+                    pOldContext = (uGnssPwrPsmContext_t *) pInstance->pPsmContext;
+                    pInstance->pPsmContext = NULL;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+
+        // The remaining calls are to public GNSS APIs, which lock
+        // gUGnssPrivateMutex themselves
+        if (pOldContext != NULL) {
+            uGnssMsgReceiveStop(gnssHandle, pOldContext->asyncHandle);
+            psmFree(pOldContext);
+        }
+        if ((errorCode == 0) && (pConfig->mode != U_GNSS_PWR_PSM_MODE_CONTINUOUS)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pContext = (uGnssPwrPsmContext_t *) pUPortMalloc(sizeof(*pContext));
+            if (pContext != NULL) {
+                memset(pContext, 0, sizeof(*pContext));
+                pContext->asyncHandle = -1;
+                errorCode = uPortMutexCreate(&(pContext->mutex));
+                if (errorCode != 0) {
+                    uPortFree(pContext);
+                    pContext = NULL;
+                }
+            }
+        }
+        if (errorCode == 0) {
+            // UBX-MON-RXR is only wanted while power saving
+            cfgVal[numValues].keyId = msgOutKeyId;
+            cfgVal[numValues].value = (pContext != NULL) ? 1 : 0;
+            numValues++;
+            errorCode = uGnssCfgValSetList(gnssHandle, cfgVal, numValues,
+                                           U_GNSS_CFG_VAL_TRANSACTION_NONE,
+                                           U_GNSS_CFG_VAL_LAYER_RAM);
+            if ((errorCode == 0) && (pContext != NULL)) {
+                messageId.type = U_GNSS_PROTOCOL_UBX;
+                messageId.id.ubx = U_GNSS_MSG_UBX_MON_RXR_MESSAGE_ID;
+                errorCode = uGnssMsgReceiveStart(gnssHandle, &messageId,
+                                                 psmMessageCallback, pContext);
+                if (errorCode >= 0) {
+                    pContext->asyncHandle = errorCode;
+                    errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+                    U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+                    pInstance = pUGnssPrivateGetInstance(gnssHandle);
+                    if (pInstance != NULL) {
+                        pInstance->pPsmContext = pContext;
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    }
+                    U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+                }
+            }
+        }
+        if ((errorCode < 0) && (pContext != NULL)) {
+            if (pContext->asyncHandle >= 0) {
+                uGnssMsgReceiveStop(gnssHandle, pContext->asyncHandle);
+            }
+            psmFree(pContext);
+        }
+    }
+
+    return errorCode;
+}
+
+// Get the power save mode.
+int32_t uGnssPwrGetPsm(uDeviceHandle_t gnssHandle,
+                       uGnssPwrPsmConfig_t *pConfig)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uint8_t mode = 0;
+    uint16_t rateMs = 0;
+    uint32_t periodSeconds = 0;
+    uint8_t maxAcqTimeSeconds = 0;
+
+    if (pConfig != NULL) {
+        memset(pConfig, 0, sizeof(*pConfig));
+        errorCode = uGnssCfgValGet(gnssHandle, U_GNSS_CFG_VAL_KEY_ID_PM_OPERATEMODE_E1,
+                                   &mode, sizeof(mode), U_GNSS_CFG_VAL_LAYER_RAM);
+        if (errorCode == 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_UNKNOWN;
+            if (mode < (uint8_t) U_GNSS_PWR_PSM_MODE_MAX_NUM) {
+                pConfig->mode = (uGnssPwrPsmMode_t) mode;
+                if (pConfig->mode == U_GNSS_PWR_PSM_MODE_ON_OFF) {
+                    errorCode = uGnssCfgValGet(gnssHandle,
+                                               U_GNSS_CFG_VAL_KEY_ID_PM_POSUPDATEPERIOD_U4,
+                                               &periodSeconds, sizeof(periodSeconds),
+                                               U_GNSS_CFG_VAL_LAYER_RAM);
+                    if (errorCode == 0) {
+                        pConfig->updatePeriodMs = (int32_t) (periodSeconds * 1000);
+                        errorCode = uGnssCfgValGet(gnssHandle,
+                                                   U_GNSS_CFG_VAL_KEY_ID_PM_MAXACQTIME_U1,
+                                                   &maxAcqTimeSeconds,
+                                                   sizeof(maxAcqTimeSeconds),
+                                                   U_GNSS_CFG_VAL_LAYER_RAM);
+                        pConfig->maxLatencyMs = (int32_t) maxAcqTimeSeconds * 1000;
+                    }
+                } else {
+                    errorCode = uGnssCfgValGet(gnssHandle, U_GNSS_CFG_VAL_KEY_ID_RATE_MEAS_U2,
+                                               &rateMs, sizeof(rateMs),
+                                               U_GNSS_CFG_VAL_LAYER_RAM);
+                    pConfig->updatePeriodMs = rateMs;
+                }
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Get the duty cycle achieved by a power save mode.
+int32_t uGnssPwrGetPsmDutyCycle(uDeviceHandle_t gnssHandle,
+                                uGnssPwrPsmDutyCycle_t *pDutyCycle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPwrPsmContext_t *pContext;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pDutyCycle != NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+            pContext = (uGnssPwrPsmContext_t *) pInstance->pPsmContext;
+            if (pContext != NULL) {
+                pDutyCycle->awakePermille = -1;
+                pDutyCycle->monitoredMs = 0;
+                U_PORT_MUTEX_LOCK(pContext->mutex);
+                if (pContext->started) {
+                    psmUpdate(pContext, uPortGetTickTimeMs());
+                    pDutyCycle->monitoredMs = pContext->lastTimeMs - pContext->startTimeMs;
+                    if (pDutyCycle->monitoredMs > 0) {
+                        pDutyCycle->awakePermille = (int32_t) ((pContext->awakeMs * 1000) /
+                                                               pDutyCycle->monitoredMs);
+                    }
+                }
+                pDutyCycle->wakeUps = pContext->wakeUps;
+                U_PORT_MUTEX_UNLOCK(pContext->mutex);
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
             }
         }
 
@@ -0,0 +1,388 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief This source file contains the implementation of the raw
+ * stream recorder of GNSS, see u_gnss_record.h.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset(), memcpy()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_heap.h"
+#include "u_port_os.h"  // Required by u_gnss_private.h
+#include "u_task_registry.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss_private.h"
+#include "u_gnss_record.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_GNSS_RECORD_TASK_PRIORITY
+/** The priority of the task that calls the sink: below that of
+ * the GNSS message receive task, which must keep pulling data in.
+ */
+# define U_GNSS_RECORD_TASK_PRIORITY (U_CFG_OS_PRIORITY_MAX - 6)
+#endif
+
+/** The length of the queue to the recorder task: one entry for
+ * each half of the buffer plus one to make it exit.
+ */
+#define U_GNSS_RECORD_QUEUE_LENGTH 3
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The context of a recording.
+ */
+typedef struct {
+    uDeviceHandle_t gnssHandle;
+    uGnssRecordSink_t pSink;
+    void *pSinkParam;
+    char *pBuffer;            /**< the two halves, one after the other. */
+    size_t halfSize;
+    size_t length[2];         /**< the amount in each half. */
+    bool full[2];             /**< true if a half is with the sink. */
+    size_t fillIndex;         /**< the half being filled. */
+    bool overrun;             /**< true while bytes are being dropped. */
+    uPortMutexHandle_t mutex; /**< protects all of the above and stats, is
+                                   recordMutex of the GNSS instance. */
+    uPortQueueHandle_t queueHandle;
+    uPortTaskHandle_t taskHandle;
+    uPortMutexHandle_t taskRunningMutexHandle;
+    uGnssRecordStats_t stats;
+} uGnssRecord_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Give a half of the buffer to the sink and then take it back.
+static void sink(uGnssRecord_t *pRecord, size_t index)
+{
+    int32_t errorCode;
+    size_t length = pRecord->length[index];
+
+    // The half belongs to us while it is marked as full,
+    // or, at the end, once nothing is adding to it, so no
+    // need to lock the mutex while calling the sink
+    errorCode = pRecord->pSink(pRecord->gnssHandle,
+                               pRecord->pBuffer + (index * pRecord->halfSize),
+                               length, pRecord->pSinkParam);
+
+    U_PORT_MUTEX_LOCK(pRecord->mutex);
+    if (errorCode >= 0) {
+        pRecord->stats.bytesRecorded += length;
+    } else {
+        pRecord->stats.numSinkErrors++;
+        pRecord->stats.bytesDropped += length;
+    }
+    pRecord->length[index] = 0;
+    pRecord->full[index] = false;
+    U_PORT_MUTEX_UNLOCK(pRecord->mutex);
+}
+
+// Task that passes full halves of the buffer to the sink.
+static void recordTask(void *pParam)
+{
+    uGnssRecord_t *pRecord = (uGnssRecord_t *) pParam;
+    int32_t index = 0;
+
+    U_PORT_MUTEX_LOCK(pRecord->taskRunningMutexHandle);
+
+    // A negative index is the signal to exit
+    while ((uPortQueueReceive(pRecord->queueHandle, &index) == 0) && (index >= 0)) {
+        sink(pRecord, (size_t) index);
+    }
+
+    // Whatever is in the half being filled goes too
+    if (!pRecord->full[pRecord->fillIndex] &&
+        (pRecord->length[pRecord->fillIndex] > 0)) {
+        sink(pRecord, pRecord->fillIndex);
+    }
+
+    U_PORT_MUTEX_UNLOCK(pRecord->taskRunningMutexHandle);
+
+    // Delete ourself
+    uTaskRegistryTaskDelete(NULL);
+}
+
+// Free a recording context and its OS resources.
+static void recordFree(uGnssRecord_t *pRecord)
+{
+    if (pRecord->taskRunningMutexHandle != NULL) {
+        uPortMutexDelete(pRecord->taskRunningMutexHandle);
+    }
+    if (pRecord->queueHandle != NULL) {
+        uPortQueueDelete(pRecord->queueHandle);
+    }
+    uPortFree(pRecord->pBuffer);
+    uPortFree(pRecord);
+}
+
+// Stop a recording, if there is one, returning its final
+// statistics if pStats is not NULL, and free it.
+static void recordStop(uGnssPrivateInstance_t *pInstance,
+                       uGnssRecordStats_t *pStats)
+{
+    uGnssRecord_t *pRecord = (uGnssRecord_t *) pInstance->pRecord;
+    int32_t index = -1;
+
+    if (pRecord != NULL) {
+        // uGnssPrivateRecordTee() only looks at pRecord with
+        // recordMutex locked so, once this is done, nothing
+        // will touch the recording from the fill path
+        U_PORT_MUTEX_LOCK(pInstance->recordMutex);
+        pInstance->pRecord = NULL;
+        U_PORT_MUTEX_UNLOCK(pInstance->recordMutex);
+        // Get the task to empty the buffer and exit; it does
+        // not touch pRecord after unlocking taskRunningMutexHandle
+        uPortQueueSend(pRecord->queueHandle, &index);
+        U_PORT_MUTEX_LOCK(pRecord->taskRunningMutexHandle);
+        U_PORT_MUTEX_UNLOCK(pRecord->taskRunningMutexHandle);
+        if (pStats != NULL) {
+            *pStats = pRecord->stats;
+        }
+        recordFree(pRecord);
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS THAT ARE PRIVATE TO GNSS
+ * -------------------------------------------------------------- */
+
+// Copy data read from the transport into the recording.
+void uGnssPrivateRecordTee(const uGnssPrivateInstance_t *pInstance,
+                           const char *pData, size_t size)
+{
+    uGnssRecord_t *pRecord;
+    size_t x;
+    int32_t index;
+
+    // recordMutex is only ever deleted once the fill
+    // path has stopped, so if it is there it can be locked
+    if (pInstance->recordMutex != NULL) {
+        // Held only for a copy, never while the sink is writing
+        U_PORT_MUTEX_LOCK(pInstance->recordMutex);
+        pRecord = (uGnssRecord_t *) pInstance->pRecord;
+        if (pRecord == NULL) {
+            size = 0;
+        }
+        while (size > 0) {
+            if (pRecord->full[pRecord->fillIndex]) {
+                // Both halves are with the sink: drop the rest
+                if (!pRecord->overrun) {
+                    pRecord->stats.numOverruns++;
+                    pRecord->overrun = true;
+                }
+                pRecord->stats.bytesDropped += size;
+                size = 0;
+            } else {
+                pRecord->overrun = false;
+                x = pRecord->halfSize - pRecord->length[pRecord->fillIndex];
+                if (x > size) {
+                    x = size;
+                }
+                memcpy(pRecord->pBuffer + (pRecord->fillIndex * pRecord->halfSize) +
+                       pRecord->length[pRecord->fillIndex], pData, x);
+                pRecord->length[pRecord->fillIndex] += x;
+                pData += x;
+                size -= x;
+                if (pRecord->length[pRecord->fillIndex] == pRecord->halfSize) {
+                    // Hand this half to the sink and move to the other;
+                    // the queue has room for both halves so this
+                    // will not block
+                    pRecord->full[pRecord->fillIndex] = true;
+                    index = (int32_t) pRecord->fillIndex;
+                    uPortQueueSend(pRecord->queueHandle, &index);
+                    pRecord->fillIndex = 1 - pRecord->fillIndex;
+                }
+            }
+        }
+        U_PORT_MUTEX_UNLOCK(pInstance->recordMutex);
+    }
+}
+
+// Stop any recording and free it.
+void uGnssPrivateRecordRemove(uGnssPrivateInstance_t *pInstance)
+{
+    recordStop(pInstance, NULL);
+    if (pInstance->recordMutex != NULL) {
+        uPortMutexDelete(pInstance->recordMutex);
+        pInstance->recordMutex = NULL;
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Start recording.
+int32_t uGnssRecordStart(uDeviceHandle_t gnssHandle,
+                         size_t bufferSizeBytes,
+                         uGnssRecordSink_t pSink,
+                         void *pSinkParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssRecord_t *pRecord;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (bufferSizeBytes >= 2) && (pSink != NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (pInstance->transportType != U_GNSS_TRANSPORT_AT) {
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                pRecord = NULL;
+                if ((pInstance->pRecord == NULL) &&
+                    ((pInstance->recordMutex != NULL) ||
+                     (uPortMutexCreate(&(pInstance->recordMutex)) == 0))) {
+                    pRecord = (uGnssRecord_t *) pUPortMalloc(sizeof(*pRecord));
+                }
+                if (pRecord != NULL) {
+                    memset(pRecord, 0, sizeof(*pRecord));
+                    pRecord->gnssHandle = gnssHandle;
+                    pRecord->pSink = pSink;
+                    pRecord->pSinkParam = pSinkParam;
+                    pRecord->halfSize = bufferSizeBytes / 2;
+                    pRecord->mutex = pInstance->recordMutex;
+                    pRecord->pBuffer = (char *) pUPortMalloc(pRecord->halfSize * 2);
+                    if ((pRecord->pBuffer != NULL) &&
+                        (uPortQueueCreate(U_GNSS_RECORD_QUEUE_LENGTH, sizeof(int32_t),
+                                          &(pRecord->queueHandle)) == 0) &&
+                        (uPortMutexCreate(&(pRecord->taskRunningMutexHandle)) == 0)) {
+                        errorCode = uTaskRegistryTaskCreate(recordTask, "gnssRecord",
+                                                            U_GNSS_RECORD_TASK_STACK_SIZE_BYTES,
+                                                            pRecord, U_GNSS_RECORD_TASK_PRIORITY,
+                                                            &(pRecord->taskHandle));
+                        if (errorCode == 0) {
+                            // Wait for the task to lock the mutex,
+                            // which shows it is running
+                            while (uPortMutexTryLock(pRecord->taskRunningMutexHandle, 0) == 0) {
+                                uPortMutexUnlock(pRecord->taskRunningMutexHandle);
+                                uPortTaskBlock(U_CFG_OS_YIELD_MS);
+                            }
+                            // From here on the fill path will tee into it
+                            U_PORT_MUTEX_LOCK(pInstance->recordMutex);
+                            pInstance->pRecord = pRecord;
+                            U_PORT_MUTEX_UNLOCK(pInstance->recordMutex);
+                        }
+                    }
+                    if (errorCode != 0) {
+                        recordFree(pRecord);
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Get the statistics of the recording in progress.
+int32_t uGnssRecordStatsGet(uDeviceHandle_t gnssHandle,
+                            uGnssRecordStats_t *pStats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssRecord_t *pRecord;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pStats != NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+            pRecord = (uGnssRecord_t *) pInstance->pRecord;
+            if (pRecord != NULL) {
+                U_PORT_MUTEX_LOCK(pRecord->mutex);
+                *pStats = pRecord->stats;
+                U_PORT_MUTEX_UNLOCK(pRecord->mutex);
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Stop recording.
+int32_t uGnssRecordStop(uDeviceHandle_t gnssHandle,
+                        uGnssRecordStats_t *pStats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssRecord_t *pRecord;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+            pRecord = (uGnssRecord_t *) pInstance->pRecord;
+            if (pRecord != NULL) {
+                recordStop(pInstance, pStats);
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// End of file
@@ -0,0 +1,491 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief This source file contains the implementation of the
+ * high-precision time API of GNSS, see u_gnss_time.h.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"  // Required by u_gnss_private.h
+
+#include "u_ubx_protocol.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss_private.h"
+#include "u_gnss_msg.h"
+#include "u_gnss_msg_ubx.h"
+#include "u_gnss_cfg_val_key.h"
+#include "u_gnss_cfg.h"
+#include "u_gnss_time.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The number of nanoseconds in a GNSS week.
+ */
+#define U_GNSS_TIME_NANOSECONDS_PER_WEEK (604800LL * 1000000000LL)
+
+/** The bit in the flags field of UBX-TIM-TP that indicates UTC
+ * rather than GNSS time base.
+ */
+#define U_GNSS_TIME_TIM_TP_FLAGS_UTC 0x01
+
+/** The bit in the flags field of UBX-TIM-TP that indicates that
+ * qErr is not valid.
+ */
+#define U_GNSS_TIME_TIM_TP_FLAGS_QERR_INVALID 0x10
+
+/** The bits in the flags field of UBX-TIM-TM2 that must both be
+ * set for a new, valid, rising edge: time valid and new rising edge.
+ */
+#define U_GNSS_TIME_TIM_TM2_FLAGS_NEW_RISING_VALID 0xc0
+
+/** The mask for the time base in the flags field of UBX-TIM-TM2.
+ */
+#define U_GNSS_TIME_TIM_TM2_FLAGS_TIME_BASE_MASK 0x18
+
+/** The value of the time base in the flags field of UBX-TIM-TM2
+ * that indicates UTC.
+ */
+#define U_GNSS_TIME_TIM_TM2_FLAGS_TIME_BASE_UTC 0x10
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Record the host time of an edge; called from an ISR.  The sequence
+// number is odd while the write is in progress so that a reader,
+// which can never interrupt us, can tell if it was interrupted.
+static void edgeWrite(volatile uint32_t *pSequence,
+                      volatile int64_t *pHostTimeNs, int64_t hostTimeNs)
+{
+    if (hostTimeNs < 0) {
+        hostTimeNs = uPortGetTickTimeUs() * 1000;
+    }
+    (*pSequence)++;
+    *pHostTimeNs = hostTimeNs;
+    (*pSequence)++;
+}
+
+// Read the host time of the last edge and the sequence number
+// that goes with it, consistently.
+static uint32_t edgeRead(volatile uint32_t *pSequence,
+                         volatile int64_t *pHostTimeNs,
+                         int64_t *pHostTimeNsOut)
+{
+    uint32_t sequence;
+
+    do {
+        sequence = *pSequence;
+        *pHostTimeNsOut = *pHostTimeNs;
+    } while ((sequence & 1) || (sequence != *pSequence));
+
+    return sequence;
+}
+
+// Publish a new sample.
+static void samplePublish(uGnssTimeSync_t *pSync, int64_t hostTimeNs,
+                          int64_t gnssTimeNs, int32_t qErrPs,
+                          bool utcNotGnss, bool markNotPulse)
+{
+    // The reader may be in another task, hence the critical section
+    uPortEnterCritical();
+    pSync->sample.hostTimeNs = hostTimeNs;
+    pSync->sample.gnssTimeNs = gnssTimeNs;
+    pSync->sample.offsetNs = gnssTimeNs - hostTimeNs;
+    pSync->sample.qErrPs = qErrPs;
+    pSync->sample.utcNotGnss = utcNotGnss;
+    pSync->sample.markNotPulse = markNotPulse;
+    pSync->sample.count++;
+    uPortExitCritical();
+}
+
+// Process the body of a UBX-TIM-TP message: this describes the NEXT
+// timepulse, so pair any previous UBX-TIM-TP with the edge that
+// followed it and then keep this one for the next time.
+static bool timTpProcess(uGnssTimeSync_t *pSync,
+                         const uGnssMsgUbxTimTp_t *pTimTp)
+{
+    bool newSample = false;
+    int64_t hostTimeNs;
+    uint32_t sequence;
+
+    sequence = edgeRead(&pSync->pulseSequence, &pSync->pulseHostTimeNs,
+                        &hostTimeNs);
+    // Exactly one edge (two increments of the sequence number)
+    // since the pending UBX-TIM-TP arrived, else it's ambiguous
+    if (pSync->pulsePending &&
+        (sequence - pSync->pulsePendingSequence == 2)) {
+        samplePublish(pSync, hostTimeNs, pSync->pulseGnssTimeNs,
+                      pSync->pulseQErrPs, pSync->pulseUtcNotGnss, false);
+        newSample = true;
+    }
+
+    // towSubMS is in units of milliseconds * 2^-32
+    pSync->pulseGnssTimeNs = ((int64_t) pTimTp->week) * U_GNSS_TIME_NANOSECONDS_PER_WEEK +
+                             ((int64_t) pTimTp->towMS) * 1000000 +
+                             (int64_t) ((((uint64_t) pTimTp->towSubMS) * 1000000) >> 32);
+    pSync->pulseQErrPs = 0;
+    if ((pTimTp->flags & U_GNSS_TIME_TIM_TP_FLAGS_QERR_INVALID) == 0) {
+        // qErr is how far the actual edge is from the ideal one,
+        // round it to the nearest nanosecond
+        pSync->pulseQErrPs = pTimTp->qErr;
+        if (pTimTp->qErr >= 0) {
+            pSync->pulseGnssTimeNs += (pTimTp->qErr + 500) / 1000;
+        } else {
+            pSync->pulseGnssTimeNs += (pTimTp->qErr - 500) / 1000;
+        }
+    }
+    pSync->pulseUtcNotGnss = ((pTimTp->flags & U_GNSS_TIME_TIM_TP_FLAGS_UTC) != 0);
+    pSync->pulsePendingSequence = sequence;
+    pSync->pulsePending = true;
+
+    return newSample;
+}
+
+// Process the body of a UBX-TIM-TM2 message: this describes the
+// time mark edge that has just happened.
+static bool timTm2Process(uGnssTimeSync_t *pSync,
+                          const uGnssMsgUbxTimTm2_t *pTimTm2)
+{
+    bool newSample = false;
+    int64_t hostTimeNs;
+    int64_t gnssTimeNs;
+    uint32_t sequence;
+
+    if (((pTimTm2->flags & U_GNSS_TIME_TIM_TM2_FLAGS_NEW_RISING_VALID) ==
+         U_GNSS_TIME_TIM_TM2_FLAGS_NEW_RISING_VALID) &&
+        ((int32_t) pTimTm2->count != pSync->markCount)) {
+        sequence = edgeRead(&pSync->markSequence, &pSync->markHostTimeNs,
+                            &hostTimeNs);
+        // Must be exactly one edge at our end and, if we've seen
+        // one before, exactly one edge at the GNSS end
+        if ((sequence - pSync->markLastSequence == 2) &&
+            ((pSync->markCount < 0) ||
+             (pTimTm2->count == (uint16_t) (pSync->markCount + 1)))) {
+            // towSubMsR is in nanoseconds
+            gnssTimeNs = ((int64_t) pTimTm2->wnR) * U_GNSS_TIME_NANOSECONDS_PER_WEEK +
+                         ((int64_t) pTimTm2->towMsR) * 1000000 +
+                         (int64_t) pTimTm2->towSubMsR;
+            samplePublish(pSync, hostTimeNs, gnssTimeNs, 0,
+                          (pTimTm2->flags & U_GNSS_TIME_TIM_TM2_FLAGS_TIME_BASE_MASK) ==
+                          U_GNSS_TIME_TIM_TM2_FLAGS_TIME_BASE_UTC, true);
+            newSample = true;
+        }
+        pSync->markLastSequence = sequence;
+        pSync->markCount = pTimTm2->count;
+    }
+
+    return newSample;
+}
+
+// Message receive callback for UBX-TIM-TP and UBX-TIM-TM2.
+// Note: this is called from the message receive task, which holds
+// no GNSS mutex, hence pCallbackParam points at the context, which
+// the application guarantees persists until the message receivers
+// have been stopped.
+static void messageCallback(uDeviceHandle_t gnssHandle,
+                            const uGnssMessageId_t *pMessageId,
+                            int32_t errorCodeOrLength,
+                            void *pCallbackParam)
+{
+    // Enough room for the bigger of the two messages
+    char message[U_GNSS_MSG_UBX_TIM_TM2_BODY_LENGTH_BYTES + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+
+    (void) pMessageId;
+
+    if ((errorCodeOrLength > 0) && (errorCodeOrLength <= (int32_t) sizeof(message)) &&
+        (uGnssMsgReceiveCallbackRead(gnssHandle, message,
+                                     (size_t) errorCodeOrLength) == errorCodeOrLength)) {
+        uGnssTimeSyncProcessMessage((uGnssTimeSync_t *) pCallbackParam,
+                                    message, (size_t) errorCodeOrLength);
+    }
+}
+
+// Return the CFG-MSGOUT key ID that controls UBX-TIM-TP, or
+// UBX-TIM-TM2, output on the given port.
+static uint32_t msgOutKeyId(uGnssPort_t port, bool tm2NotTp)
+{
+    uint32_t keyId = tm2NotTp ? U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_TIM_TM2_I2C_U1 :
+                     U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_TIM_TP_I2C_U1;
+
+    switch (port) {
+        case U_GNSS_PORT_UART:
+            keyId = tm2NotTp ? U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_TIM_TM2_UART1_U1 :
+                    U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_TIM_TP_UART1_U1;
+            break;
+        case U_GNSS_PORT_UART2:
+            keyId = tm2NotTp ? U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_TIM_TM2_UART2_U1 :
+                    U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_TIM_TP_UART2_U1;
+            break;
+        case U_GNSS_PORT_USB:
+            keyId = tm2NotTp ? U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_TIM_TM2_USB_U1 :
+                    U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_TIM_TP_USB_U1;
+            break;
+        case U_GNSS_PORT_SPI:
+            keyId = tm2NotTp ? U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_TIM_TM2_SPI_U1 :
+                    U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_TIM_TP_SPI_U1;
+            break;
+        default:
+            break;
+    }
+
+    return keyId;
+}
+
+// Stop the message receivers and switch the messages off.
+static void stopAndSwitchOff(uDeviceHandle_t gnssHandle,
+                             uGnssTimeSync_t *pSync)
+{
+    uGnssCfgVal_t cfgVal[2];
+    size_t numValues = 0;
+
+    if (pSync->asyncHandleTp >= 0) {
+        uGnssMsgReceiveStop(gnssHandle, pSync->asyncHandleTp);
+        pSync->asyncHandleTp = -1;
+    }
+    if (pSync->asyncHandleTm2 >= 0) {
+        uGnssMsgReceiveStop(gnssHandle, pSync->asyncHandleTm2);
+        pSync->asyncHandleTm2 = -1;
+    }
+    cfgVal[numValues].keyId = pSync->msgOutKeyIdTp;
+    cfgVal[numValues].value = 0;
+    numValues++;
+    if (pSync->msgOutKeyIdTm2 != 0) {
+        cfgVal[numValues].keyId = pSync->msgOutKeyIdTm2;
+        cfgVal[numValues].value = 0;
+        numValues++;
+    }
+    uGnssCfgValSetList(gnssHandle, cfgVal, numValues,
+                       U_GNSS_CFG_VAL_TRANSACTION_NONE,
+                       U_GNSS_CFG_VAL_LAYER_RAM);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Start time synchronisation.
+int32_t uGnssTimeSyncStart(uDeviceHandle_t gnssHandle,
+                           uGnssTimeSync_t *pSync,
+                           bool useTimeMark)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssMessageId_t messageId;
+    uGnssCfgVal_t cfgVal[2];
+    size_t numValues = 0;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pSync != NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            // Message receive only works for a GNSS chip that is
+            // directly connected and the message output can
+            // only be configured with CFG-VALSET
+            if ((pInstance->transportType != U_GNSS_TRANSPORT_AT) &&
+                U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                if (pInstance->pTimeSync == NULL) {
+                    memset(pSync, 0, sizeof(*pSync));
+                    pSync->markCount = -1;
+                    pSync->asyncHandleTp = -1;
+                    pSync->asyncHandleTm2 = -1;
+                    pSync->msgOutKeyIdTp = msgOutKeyId(pInstance->portNumber, false);
+                    if (useTimeMark) {
+                        pSync->msgOutKeyIdTm2 = msgOutKeyId(pInstance->portNumber, true);
+                    }
+                    // Claim the slot while we still have the mutex
+                    pInstance->pTimeSync = pSync;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+
+        // The remaining calls are to public GNSS APIs, which lock
+        // gUGnssPrivateMutex themselves
+        if (errorCode == 0) {
+            // Switch on the message(s) on our port, once per
+            // navigation solution, which is once per timepulse
+            // by default
+            cfgVal[numValues].keyId = pSync->msgOutKeyIdTp;
+            cfgVal[numValues].value = 1;
+            numValues++;
+            if (pSync->msgOutKeyIdTm2 != 0) {
+                cfgVal[numValues].keyId = pSync->msgOutKeyIdTm2;
+                cfgVal[numValues].value = 1;
+                numValues++;
+            }
+            errorCode = uGnssCfgValSetList(gnssHandle, cfgVal, numValues,
+                                           U_GNSS_CFG_VAL_TRANSACTION_NONE,
+                                           U_GNSS_CFG_VAL_LAYER_RAM);
+            if (errorCode == 0) {
+                messageId.type = U_GNSS_PROTOCOL_UBX;
+                messageId.id.ubx = U_GNSS_MSG_UBX_TIM_TP_MESSAGE_ID;
+                errorCode = uGnssMsgReceiveStart(gnssHandle, &messageId,
+                                                 messageCallback, pSync);
+                if (errorCode >= 0) {
+                    pSync->asyncHandleTp = errorCode;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    if (pSync->msgOutKeyIdTm2 != 0) {
+                        messageId.id.ubx = U_GNSS_MSG_UBX_TIM_TM2_MESSAGE_ID;
+                        errorCode = uGnssMsgReceiveStart(gnssHandle, &messageId,
+                                                         messageCallback, pSync);
+                        if (errorCode >= 0) {
+                            pSync->asyncHandleTm2 = errorCode;
+                            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                        }
+                    }
+                }
+                if (errorCode < 0) {
+                    stopAndSwitchOff(gnssHandle, pSync);
+                }
+            }
+            if (errorCode < 0) {
+                // Give the slot back
+                U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+                pInstance->pTimeSync = NULL;
+                U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Record the host time of a timepulse edge.
+void uGnssTimeSyncPulseIsr(uGnssTimeSync_t *pSync, int64_t hostTimeNs)
+{
+    if (pSync != NULL) {
+        edgeWrite(&pSync->pulseSequence, &pSync->pulseHostTimeNs, hostTimeNs);
+    }
+}
+
+// Record the host time of a time mark edge.
+void uGnssTimeSyncMarkIsr(uGnssTimeSync_t *pSync, int64_t hostTimeNs)
+{
+    if (pSync != NULL) {
+        edgeWrite(&pSync->markSequence, &pSync->markHostTimeNs, hostTimeNs);
+    }
+}
+
+// Process a UBX-TIM-TP or UBX-TIM-TM2 message.
+bool uGnssTimeSyncProcessMessage(uGnssTimeSync_t *pSync,
+                                 const char *pMessage, size_t size)
+{
+    bool newSample = false;
+    const uGnssMsgUbxTimTp_t *pTimTp;
+    const uGnssMsgUbxTimTm2_t *pTimTm2;
+
+    if (pSync != NULL) {
+        pTimTp = pUGnssMsgUbxTimTp(pMessage, size);
+        if (pTimTp != NULL) {
+            newSample = timTpProcess(pSync, pTimTp);
+        } else {
+            pTimTm2 = pUGnssMsgUbxTimTm2(pMessage, size);
+            if (pTimTm2 != NULL) {
+                newSample = timTm2Process(pSync, pTimTm2);
+            }
+        }
+    }
+
+    return newSample;
+}
+
+// Get the latest sample.
+int32_t uGnssTimeSyncGet(uGnssTimeSync_t *pSync,
+                         uGnssTimeSyncSample_t *pSample)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pSync != NULL) && (pSample != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        uPortEnterCritical();
+        if (pSync->sample.count > 0) {
+            *pSample = pSync->sample;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+        uPortExitCritical();
+    }
+
+    return errorCode;
+}
+
+// Stop time synchronisation.
+void uGnssTimeSyncStop(uDeviceHandle_t gnssHandle)
+{
+    uGnssPrivateInstance_t *pInstance;
+    uGnssTimeSync_t *pSync = NULL;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            pSync = (uGnssTimeSync_t *) pInstance->pTimeSync;
+            pInstance->pTimeSync = NULL;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+
+        if (pSync != NULL) {
+            // Once the message receivers are stopped our callback
+            // can no longer be called and the application may
+            // free the context
+            stopAndSwitchOff(gnssHandle, pSync);
+        }
+    }
+}
+
+// End of file
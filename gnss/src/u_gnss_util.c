@@ -102,6 +102,7 @@ int32_t uGnssUtilUbxTransparentSendReceive(uDeviceHandle_t gnssHandle,
     size_t bufferLengthBytes;
     char *pTmp = NULL;
     uAtClientHandle_t atHandle;
+    uGnssVirtualSerial_t *pVirtualSerial = NULL;
 
     if (gUGnssPrivateMutex != NULL) {
 
@@ -127,6 +128,12 @@ int32_t uGnssUtilUbxTransparentSendReceive(uDeviceHandle_t gnssHandle,
                 case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
                     streamHandle = pInstance->transportHandle.i2c;
                     break;
+                case U_GNSS_PRIVATE_STREAM_TYPE_VIRTUAL_SERIAL:
+                    // No integer handle here, the virtual serial
+                    // functions are reached through pInstance
+                    streamHandle = 0;
+                    pVirtualSerial = pInstance->transportHandle.pVirtualSerial;
+                    break;
                 default:
                     break;
             }
@@ -146,6 +153,11 @@ int32_t uGnssUtilUbxTransparentSendReceive(uDeviceHandle_t gnssHandle,
                             errorCodeOrResponseLength = commandLengthBytes;
                         }
                         break;
+                    case U_GNSS_PRIVATE_STREAM_TYPE_VIRTUAL_SERIAL:
+                        errorCodeOrResponseLength = pVirtualSerial->pWrite(pVirtualSerial,
+                                                                           pCommand,
+                                                                           commandLengthBytes);
+                        break;
                     default:
                         break;
                 }
@@ -161,8 +173,7 @@ int32_t uGnssUtilUbxTransparentSendReceive(uDeviceHandle_t gnssHandle,
                         startTimeMs = uPortGetTickTimeMs();
                         // Wait for something to start coming back
                         while ((bytesRead < (int32_t) maxResponseLengthBytes) &&
-                               ((x = uGnssPrivateStreamGetReceiveSize(streamHandle, streamType,
-                                                                      pInstance->i2cAddress)) <= 0) &&
+                               ((x = uGnssPrivateStreamGetReceiveSize(pInstance)) <= 0) &&
                                (uPortGetTickTimeMs() - startTimeMs < pInstance->timeoutMs)) {
                             // Relax a little
                             uPortTaskBlock(U_GNSS_UTIL_TRANSPARENT_RECEIVE_DELAY_MS);
@@ -171,8 +182,7 @@ int32_t uGnssUtilUbxTransparentSendReceive(uDeviceHandle_t gnssHandle,
                             // Got something; continue receiving until nothing arrives for
                             // U_GNSS_UTIL_TRANSPARENT_RECEIVE_DELAY_MS
                             while ((bytesRead < (int32_t) maxResponseLengthBytes) &&
-                                   ((x = uGnssPrivateStreamGetReceiveSize(streamHandle, streamType,
-                                                                          pInstance->i2cAddress)) > 0) &&
+                                   ((x = uGnssPrivateStreamGetReceiveSize(pInstance)) > 0) &&
                                    (uPortGetTickTimeMs() - startTimeMs < pInstance->timeoutMs)) {
                                 if (x > 0) {
                                     if (x > ((int32_t) maxResponseLengthBytes) - bytesRead) {
@@ -187,6 +197,9 @@ int32_t uGnssUtilUbxTransparentSendReceive(uDeviceHandle_t gnssHandle,
                                             x = uPortI2cControllerSendReceive(streamHandle, pInstance->i2cAddress,
                                                                               NULL, 0, pResponse + bytesRead, x);
                                             break;
+                                        case U_GNSS_PRIVATE_STREAM_TYPE_VIRTUAL_SERIAL:
+                                            x = pVirtualSerial->pRead(pVirtualSerial, pResponse + bytesRead, x);
+                                            break;
                                         default:
                                             break;
                                     }
@@ -0,0 +1,252 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Throughput benchmarks for GNSS, run against the virtual M9
+ * module of port/platform/common/automation/scripts/u_virtual_modem.py
+ * on the end of U_CFG_APP_GNSS_UART, ideally with "nav_rate_hz=-1"
+ * so that it streams UBX-NAV-PVT as fast as the link allows; only
+ * compiled if U_CFG_TEST_VIRTUAL_MODEM is defined.  The results are
+ * printed in the same "U_BENCHMARK," form as those of
+ * u_at_client_test_benchmark.c.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()
+#include "time.h"      // clock()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+#include "u_port_uart.h"
+
+#include "u_ringbuffer.h" // Required by u_gnss_msg.h
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss.h"
+#include "u_gnss_info.h"
+#include "u_gnss_msg.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_GNSS_BENCHMARK_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_GNSS_TEST_BENCHMARK_DURATION_MS
+/** How long to run each benchmark for.
+ */
+# define U_GNSS_TEST_BENCHMARK_DURATION_MS 5000
+#endif
+
+#ifndef U_GNSS_TEST_BENCHMARK_BAUD_RATE
+/** The baud rate to open the UART at; the virtual modem sets the
+ * bandwidth actually achieved.
+ */
+# define U_GNSS_TEST_BENCHMARK_BAUD_RATE 115200
+#endif
+
+#if defined(U_CFG_TEST_VIRTUAL_MODEM) && (U_CFG_APP_GNSS_UART >= 0)
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The number of messages received by the message receive callback.
+ */
+static volatile int32_t gMessageCount = 0;
+
+/** The number of bytes received by the message receive callback.
+ */
+static volatile int32_t gMessageBytes = 0;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Message receive callback: just counts.
+static void messageCallback(uDeviceHandle_t gnssHandle,
+                            const uGnssMessageId_t *pMessageId,
+                            const uRingBufferSpan_t *pSpan,
+                            int32_t errorCodeOrLength,
+                            void *pCallbackParam)
+{
+    (void) gnssHandle;
+    (void) pMessageId;
+    (void) pSpan;
+    (void) pCallbackParam;
+
+    if (errorCodeOrLength > 0) {
+        gMessageCount++;
+        gMessageBytes += errorCodeOrLength;
+    }
+}
+
+// Print a benchmark result.
+static void printResult(const char *pName, int32_t ops, int64_t bytes,
+                        int32_t durationMs, clock_t startClock, clock_t stopClock)
+{
+    int32_t cpuUsPerKbyte = -1;
+
+    if (durationMs <= 0) {
+        durationMs = 1;
+    }
+    if ((startClock != (clock_t) -1) && (stopClock != (clock_t) -1) && (bytes > 0)) {
+        //lint -e{647} Suppress suspicious truncation
+        cpuUsPerKbyte = (int32_t) ((((int64_t) (stopClock - startClock)) * 1000000 /
+                                    CLOCKS_PER_SEC) * 1024 / bytes);
+    }
+    uPortLog("U_BENCHMARK,%s,%d,%d,%d,%d,%d,%d\n", pName,
+             (ops > 0) ? (int32_t) (bytes / ops) : 0, ops, durationMs,
+             (int32_t) ((((int64_t) ops) * 1000) / durationMs),
+             (int32_t) (bytes / durationMs), cpuUsPerKbyte);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TESTS
+ * -------------------------------------------------------------- */
+
+/** Run the benchmarks against a virtual M9 module.
+ */
+U_PORT_TEST_FUNCTION("[gnssBenchmark]", "gnssBenchmarkVirtualM9")
+{
+    int32_t heapUsed;
+    uGnssTransportHandle_t transportHandle;
+    uDeviceHandle_t gnssHandle = NULL;
+    uGnssMessageId_t messageId;
+    char buffer[64];
+    int32_t asyncHandle;
+    int32_t ops = 0;
+    int64_t bytes = 0;
+    int32_t durationMs;
+    int64_t startTimeMs;
+    clock_t startClock;
+    int32_t x;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uGnssInit() == 0);
+
+    U_TEST_PRINT_LINE("virtual M9 module must be on UART %d.", U_CFG_APP_GNSS_UART);
+    transportHandle.uart = uPortUartOpen(U_CFG_APP_GNSS_UART,
+                                         U_GNSS_TEST_BENCHMARK_BAUD_RATE, NULL,
+                                         U_GNSS_UART_BUFFER_LENGTH_BYTES,
+                                         U_CFG_APP_PIN_GNSS_TXD,
+                                         U_CFG_APP_PIN_GNSS_RXD,
+                                         U_CFG_APP_PIN_GNSS_CTS,
+                                         U_CFG_APP_PIN_GNSS_RTS);
+    U_PORT_TEST_ASSERT(transportHandle.uart >= 0);
+    // Leave power alone: there is nothing to power
+    U_PORT_TEST_ASSERT(uGnssAdd(U_GNSS_MODULE_TYPE_M9, U_GNSS_TRANSPORT_UART,
+                                transportHandle, -1, true, &gnssHandle) == 0);
+    uGnssSetUbxMessagePrint(gnssHandle, false);
+
+    U_TEST_PRINT_LINE("running each benchmark for %d ms, results are lines"
+                      " beginning \"U_BENCHMARK,\".",
+                      U_GNSS_TEST_BENCHMARK_DURATION_MS);
+    uPortLog("U_BENCHMARK,name,bytes/op,ops,ms,ops/s,kbytes/s,cpu_us/kbyte\n");
+
+    // UBX-MON-VER request/response transactions
+    startClock = clock();
+    startTimeMs = uPortGetTickTimeMs();
+    do {
+        x = uGnssInfoGetFirmwareVersionStr(gnssHandle, buffer, sizeof(buffer));
+        if (x > 0) {
+            bytes += x;
+            ops++;
+        }
+        durationMs = (int32_t) (uPortGetTickTimeMs() - startTimeMs);
+    } while ((x > 0) && (durationMs < U_GNSS_TEST_BENCHMARK_DURATION_MS));
+    U_PORT_TEST_ASSERT(x > 0);
+    printResult("gnss_ubx_poll_mon_ver", ops, bytes, durationMs, startClock, clock());
+    uPortTaskBlock(U_CFG_OS_YIELD_MS);
+
+    // Streamed UBX-NAV-PVT, received asynchronously
+    memset(&messageId, 0, sizeof(messageId));
+    messageId.type = U_GNSS_PROTOCOL_UBX;
+    messageId.id.ubx = 0x0107;
+    gMessageCount = 0;
+    gMessageBytes = 0;
+    startClock = clock();
+    startTimeMs = uPortGetTickTimeMs();
+    asyncHandle = uGnssMsgReceiveStartSpan(gnssHandle, &messageId,
+                                           messageCallback, NULL);
+    U_PORT_TEST_ASSERT(asyncHandle >= 0);
+    uPortTaskBlock(U_GNSS_TEST_BENCHMARK_DURATION_MS);
+    U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gnssHandle, asyncHandle) == 0);
+    durationMs = (int32_t) (uPortGetTickTimeMs() - startTimeMs);
+    printResult("gnss_ubx_nav_pvt_stream", gMessageCount, gMessageBytes,
+                durationMs, startClock, clock());
+    if (gMessageCount == 0) {
+        U_TEST_PRINT_LINE("no UBX-NAV-PVT messages received, is the virtual"
+                          " M9 module streaming them?");
+    }
+    U_PORT_TEST_ASSERT(gMessageCount > 0);
+
+    uGnssRemove(gnssHandle);
+    uGnssDeinit();
+    uPortUartClose(transportHandle.uart);
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+#endif // #if defined(U_CFG_TEST_VIRTUAL_MODEM) && (U_CFG_APP_GNSS_UART >= 0)
+
+// End of file
@@ -38,6 +38,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
+#include "string.h"    // memset()
 
 #include "u_cfg_sw.h"
 #include "u_cfg_os_platform_specific.h"
@@ -55,9 +56,11 @@
 #include "u_gnss_module_type.h"
 #include "u_gnss_type.h"
 #include "u_gnss.h"
+#include "u_gnss_pwr.h" // uGnssPwrIsAlive()
 #include "u_gnss_msg.h" // uGnssMsgReceiveStatStreamLoss()
 #include "u_gnss_cfg.h"
 #include "u_gnss_cfg_val_key.h"
+#include "u_gnss_geofence.h"
 #include "u_gnss_private.h"
 
 #include "u_gnss_test_private.h"
@@ -85,6 +88,14 @@
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The outcome of a uGnssCfgValGetAsync() request.
+ */
+typedef struct {
+    volatile int32_t errorCode; /**< INT32_MIN until the callback is called. */
+    uint32_t keyId;
+    uint64_t value;
+} uGnssCfgTestAsync_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -139,10 +150,95 @@ static const uint32_t gKeyIdGeofence[] = {U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_CONFLVL
                                           U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_FENCE4_RAD_U4
                                          };
 
+/** The geofences used by the gnssCfgGeofence test, one in
+ * each quarter of the globe so that all of the signs are covered.
+ */
+static const uGnssGeofence_t gGeofence[U_GNSS_GEOFENCE_MAX_NUM] = {
+    {522053000, 1403000, 10000},        // Thalwil-ish, 100 metres
+    {-338688000, 1512093000, 250000},   // Sydney, 2.5 km
+    {-229068000, -431729000, 100},      // Rio de Janeiro, 1 metre
+    {406413000, -737781000, 100000000}  // JFK, 1000 km
+};
+
+/** The number of times the geofence callback has been called.
+ */
+static volatile int32_t gGeofenceCallbackCount = 0;
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Callback for uGnssGeofenceSet().
+static void geofenceCallback(uDeviceHandle_t gnssHandle,
+                             uGnssGeofenceState_t combinedState,
+                             const uGnssGeofenceState_t *pState,
+                             size_t numFences,
+                             void *pCallbackParam)
+{
+    (void) gnssHandle;
+    (void) pState;
+    (void) numFences;
+    (void) pCallbackParam;
+
+    U_TEST_PRINT_LINE("geofence callback: combined state %d.", combinedState);
+    gGeofenceCallbackCount++;
+}
+
+// Check that the CFG-GEOFENCE values in the RAM layer match the
+// given geofences and confidence, with the PIO pin output off.
+static void checkGeofence(uDeviceHandle_t gnssHandle,
+                          const uGnssGeofence_t *pFence, size_t numFences,
+                          uGnssGeofenceConfidence_t confidence)
+{
+    uint64_t value;
+
+    value = UINT64_MAX;
+    U_PORT_TEST_ASSERT(uGnssCfgValGet(gnssHandle, U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_CONFLVL_E1,
+                                      &value, 1, U_GNSS_CFG_VAL_LAYER_RAM) == 0);
+    U_PORT_TEST_ASSERT((uint8_t) value == (uint8_t) confidence);
+    value = UINT64_MAX;
+    U_PORT_TEST_ASSERT(uGnssCfgValGet(gnssHandle, U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_USE_PIO_L,
+                                      &value, 1, U_GNSS_CFG_VAL_LAYER_RAM) == 0);
+    U_PORT_TEST_ASSERT((uint8_t) value == 0);
+    for (size_t x = 0; x < U_GNSS_GEOFENCE_MAX_NUM; x++) {
+        // The four keys of each geofence follow the four general
+        // ones in gKeyIdGeofence[]: use, latitude, longitude, radius
+        value = UINT64_MAX;
+        U_PORT_TEST_ASSERT(uGnssCfgValGet(gnssHandle, gKeyIdGeofence[4 + (x * 4)],
+                                          &value, 1, U_GNSS_CFG_VAL_LAYER_RAM) == 0);
+        U_TEST_PRINT_LINE("geofence %d is %s.", (int32_t) x + 1, (uint8_t) value ? "on" : "off");
+        U_PORT_TEST_ASSERT((uint8_t) value == (x < numFences));
+        if (x < numFences) {
+            value = 0;
+            U_PORT_TEST_ASSERT(uGnssCfgValGet(gnssHandle, gKeyIdGeofence[4 + (x * 4) + 1],
+                                              &value, 4, U_GNSS_CFG_VAL_LAYER_RAM) == 0);
+            U_PORT_TEST_ASSERT((int32_t) (uint32_t) value == pFence[x].latitudeX1e7);
+            value = 0;
+            U_PORT_TEST_ASSERT(uGnssCfgValGet(gnssHandle, gKeyIdGeofence[4 + (x * 4) + 2],
+                                              &value, 4, U_GNSS_CFG_VAL_LAYER_RAM) == 0);
+            U_PORT_TEST_ASSERT((int32_t) (uint32_t) value == pFence[x].longitudeX1e7);
+            value = 0;
+            U_PORT_TEST_ASSERT(uGnssCfgValGet(gnssHandle, gKeyIdGeofence[4 + (x * 4) + 3],
+                                              &value, 4, U_GNSS_CFG_VAL_LAYER_RAM) == 0);
+            U_PORT_TEST_ASSERT((uint32_t) value == pFence[x].radiusCentimetres);
+        }
+    }
+}
+
+// Callback for uGnssCfgValGetAsync().
+static void valGetAsyncCallback(uDeviceHandle_t gnssHandle, int32_t errorCode,
+                                uint32_t keyId, uint64_t value,
+                                void *pCallbackParam)
+{
+    uGnssCfgTestAsync_t *pAsync = (uGnssCfgTestAsync_t *) pCallbackParam;
+
+    (void) gnssHandle;
+
+    pAsync->keyId = keyId;
+    pAsync->value = value;
+    pAsync->errorCode = errorCode;
+}
+
 // Get the size in bytes required to store the value of the given key.
 static size_t storageSizeBytes(uint32_t keyId)
 {
@@ -431,10 +527,29 @@ U_PORT_TEST_FUNCTION("[gnssCfg]", "gnssCfgValBasic")
     uint32_t keyId;
     uint64_t value;
     uint64_t savedValue;
+    int32_t z;
     uGnssCfgVal_t *pCfgValList = NULL;
     int32_t numValues;
+    uGnssCfgValBatch_t batch;
+    uGnssCfgVal_t batchStorage[sizeof(gKeyIdGeofence) / sizeof(gKeyIdGeofence[0])];
+    uGnssCfgVal_t listStorage[sizeof(gKeyIdGeofence) / sizeof(gKeyIdGeofence[0])];
+    size_t listLengthBytes;
     size_t iterations;
     uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM_WITH_UBX];
+    char *pBlob = NULL;
+    int32_t blobSize;
+
+    // The key metadata is available at compile time
+    U_PORT_TEST_ASSERT(U_GNSS_CFG_VAL_KEY_SIZE_BYTES(U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_USE_PIO_L) == 1);
+    U_PORT_TEST_ASSERT(U_GNSS_CFG_VAL_KEY_SIZE_BYTES(U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_FENCE1_LAT_I4) == 4);
+    U_PORT_TEST_ASSERT(U_GNSS_CFG_VAL_KEY_SIZE_BYTES(U_GNSS_CFG_VAL_KEY_ID_USB_VENDOR_STR0_X8) == 8);
+    U_PORT_TEST_ASSERT(U_GNSS_CFG_VAL_KEY_TYPE(GEOFENCE_USE_PIO_L) == U_GNSS_CFG_VAL_KEY_TYPE_L);
+    U_PORT_TEST_ASSERT(U_GNSS_CFG_VAL_KEY_TYPE(GEOFENCE_FENCE1_LAT_I4) == U_GNSS_CFG_VAL_KEY_TYPE_I);
+    U_PORT_TEST_ASSERT(U_GNSS_CFG_VAL_KEY_TYPE(TP_DUTY_TP1_R8) == U_GNSS_CFG_VAL_KEY_TYPE_R);
+    for (size_t x = 0; x < sizeof(gKeyIdGeofence) / sizeof(gKeyIdGeofence[0]); x++) {
+        U_PORT_TEST_ASSERT(U_GNSS_CFG_VAL_KEY_SIZE_BYTES(gKeyIdGeofence[x]) ==
+                           storageSizeBytes(gKeyIdGeofence[x]));
+    }
 
     // In case a previous test failed
     uGnssTestPrivateCleanup(&gHandles);
@@ -535,6 +650,39 @@ U_PORT_TEST_FUNCTION("[gnssCfg]", "gnssCfgValBasic")
                 uPortTaskBlock(10);
             }
 
+            // Read them again, without allocating memory, as many at a time
+            // as will fit into U_GNSS_CFG_VAL_GET_LIST_BUFFER_LENGTH_BYTES
+            U_TEST_PRINT_LINE("reading back the modified GEOFENCE values without"
+                              " allocating memory.");
+            y = 0;
+            while (y < numValues) {
+                z = 0;
+                listLengthBytes = 4;
+                while ((y + z < numValues) &&
+                       (listLengthBytes + U_GNSS_CFG_VAL_KEY_ITEM_LENGTH_BYTES(gKeyIdGeofence[y + z]) <=
+                        U_GNSS_CFG_VAL_GET_LIST_BUFFER_LENGTH_BYTES)) {
+                    listLengthBytes += U_GNSS_CFG_VAL_KEY_ITEM_LENGTH_BYTES(gKeyIdGeofence[y + z]);
+                    z++;
+                }
+                U_PORT_TEST_ASSERT(z > 0);
+                if (y + z < numValues) {
+                    // One more would be too many
+                    U_PORT_TEST_ASSERT(uGnssCfgValGetList(gnssHandle, &(gKeyIdGeofence[y]), z + 1,
+                                                          listStorage,
+                                                          U_GNSS_CFG_VAL_LAYER_RAM) ==
+                                       (int32_t) U_ERROR_COMMON_NO_MEMORY);
+                }
+                memset(listStorage, 0, sizeof(listStorage));
+                U_PORT_TEST_ASSERT(uGnssCfgValGetList(gnssHandle, &(gKeyIdGeofence[y]), z,
+                                                      listStorage, U_GNSS_CFG_VAL_LAYER_RAM) == z);
+                for (int32_t w = 0; w < z; w++) {
+                    U_PORT_TEST_ASSERT(listStorage[w].keyId == gKeyIdGeofence[y + w]);
+                    U_PORT_TEST_ASSERT(valueMatches(listStorage[w].keyId, listStorage[w].value,
+                                                    pCfgValList, numValues));
+                }
+                y += z;
+            }
+
             // Now modify one value, non-list style, using the helper macro
             value = 0xFFFFFFFF;
             U_TEST_PRINT_LINE("modifying one GEOFENCE value 0x%08x to 0x%08x.",
@@ -676,6 +824,63 @@ U_PORT_TEST_FUNCTION("[gnssCfg]", "gnssCfgValBasic")
                 uPortTaskBlock(10);
             }
 
+            // Now do the same with a batch, adding a duplicate which
+            // should replace, rather than add to, what is there
+            U_TEST_PRINT_LINE("writing GEOFENCE values to BBRAM as a batch.");
+            U_PORT_TEST_ASSERT(uGnssCfgValBatchBegin(&batch, batchStorage,
+                                                     sizeof(batchStorage) / sizeof(batchStorage[0]),
+                                                     U_GNSS_CFG_VAL_LAYER_BBRAM) == 0);
+            U_PORT_TEST_ASSERT(uGnssCfgValBatchAdd(&batch, pCfgValList->keyId,
+                                                   ~pCfgValList->value) == 1);
+            for (size_t x = 0; x < sizeof(gKeyIdGeofence) / sizeof(gKeyIdGeofence[0]); x++) {
+                U_PORT_TEST_ASSERT(uGnssCfgValBatchAdd(&batch, (pCfgValList + x)->keyId,
+                                                       (pCfgValList + x)->value) == (int32_t) x + 1);
+            }
+            // The batch is now full
+            U_PORT_TEST_ASSERT(uGnssCfgValBatchAdd(&batch,
+                                                   U_GNSS_CFG_VAL_KEY_ID_USB_PRODUCT_STR3_X8,
+                                                   0) == (int32_t) U_ERROR_COMMON_NO_MEMORY);
+            // ...and so committing it should fail and clear the error
+            U_PORT_TEST_ASSERT(uGnssCfgValBatchCommit(gnssHandle, &batch) ==
+                               (int32_t) U_ERROR_COMMON_NO_MEMORY);
+            for (size_t x = 0; x < sizeof(gKeyIdGeofence) / sizeof(gKeyIdGeofence[0]); x++) {
+                U_PORT_TEST_ASSERT(uGnssCfgValBatchAdd(&batch, (pCfgValList + x)->keyId,
+                                                       (pCfgValList + x)->value) == (int32_t) x + 1);
+            }
+            U_PORT_TEST_ASSERT(uGnssCfgValBatchCommit(gnssHandle, &batch) == 0);
+            U_TEST_PRINT_LINE("checking that GEOFENCE values can now be read from BBRAM.");
+            for (size_t x = 0; x < sizeof(gKeyIdGeofence) / sizeof(gKeyIdGeofence[0]); x++) {
+                value = 0;
+                U_PORT_TEST_ASSERT(uGnssCfgValGet(gnssHandle, gKeyIdGeofence[x],
+                                                  &value, storageSizeBytes(gKeyIdGeofence[x]),
+                                                  U_GNSS_CFG_VAL_LAYER_BBRAM) == 0);
+                U_PORT_TEST_ASSERT(valueMatches(gKeyIdGeofence[x], value,  pCfgValList, numValues));
+                // Don't overload logging
+                uPortTaskBlock(10);
+            }
+            U_TEST_PRINT_LINE("deleting GEOFENCE values from BBRAM.");
+            U_PORT_TEST_ASSERT(uGnssCfgValDelList(gnssHandle, gKeyIdGeofence,
+                                                  sizeof(gKeyIdGeofence) / sizeof(gKeyIdGeofence[0]),
+                                                  U_GNSS_CFG_VAL_TRANSACTION_NONE,
+                                                  U_GNSS_CFG_VAL_LAYER_BBRAM) == 0);
+
+            // Take a snapshot of the GEOFENCE values in RAM and restore
+            // it: since nothing has changed nothing should be written
+            U_TEST_PRINT_LINE("taking a snapshot of the GEOFENCE values in RAM.");
+            blobSize = uGnssCfgSnapshot(gnssHandle, gKeyIdGeofence,
+                                        sizeof(gKeyIdGeofence) / sizeof(gKeyIdGeofence[0]),
+                                        &pBlob, U_GNSS_CFG_VAL_LAYER_RAM);
+            U_TEST_PRINT_LINE("snapshot is %d byte(s).", blobSize);
+            U_PORT_TEST_ASSERT(blobSize > 0);
+            U_PORT_TEST_ASSERT(pBlob != NULL);
+            U_PORT_TEST_ASSERT(uGnssCfgRestore(gnssHandle, pBlob, blobSize,
+                                               U_GNSS_CFG_VAL_LAYER_RAM) == 0);
+            // A truncated snapshot should be rejected
+            U_PORT_TEST_ASSERT(uGnssCfgRestore(gnssHandle, pBlob, blobSize - 1,
+                                               U_GNSS_CFG_VAL_LAYER_RAM) ==
+                               (int32_t) U_ERROR_COMMON_INVALID_PARAMETER);
+            uPortFree(pBlob);
+
             // Free memory
             uPortFree(pCfgValList);
 
@@ -700,6 +905,308 @@ U_PORT_TEST_FUNCTION("[gnssCfg]", "gnssCfgValBasic")
     U_PORT_TEST_ASSERT(heapUsed <= 0);
 }
 
+/** Test getting configuration values without blocking.
+ */
+U_PORT_TEST_FUNCTION("[gnssCfg]", "gnssCfgValAsync")
+{
+    uDeviceHandle_t gnssHandle;
+    const uGnssPrivateModule_t *pModule;
+    int32_t heapUsed;
+    int32_t y;
+    uint64_t value;
+    // Two keys of different sizes, requested at the same time
+    const uint32_t keyId[] = {U_GNSS_CFG_VAL_KEY_ID_NAVSPG_DYNMODEL_E1,
+                              U_GNSS_CFG_VAL_KEY_ID_GEOFENCE_FENCE1_LAT_I4
+                             };
+    uGnssCfgTestAsync_t async[sizeof(keyId) / sizeof(keyId[0])];
+    bool done;
+    size_t iterations;
+    uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM_WITH_UBX];
+
+    // In case a previous test failed
+    uGnssTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    // Repeat for all transport types
+    iterations = uGnssTestPrivateTransportTypesSet(transportTypes, U_CFG_APP_GNSS_UART,
+                                                   U_CFG_APP_GNSS_I2C);
+    for (size_t x = 0; x < iterations; x++) {
+        // Do the standard preamble
+        U_TEST_PRINT_LINE("testing on transport %s...",
+                          pGnssTestPrivateTransportTypeName(transportTypes[x]));
+        U_PORT_TEST_ASSERT(uGnssTestPrivatePreamble(U_CFG_TEST_GNSS_MODULE_TYPE,
+                                                    transportTypes[x], &gHandles, true,
+                                                    U_CFG_APP_CELL_PIN_GNSS_POWER,
+                                                    U_CFG_APP_CELL_PIN_GNSS_DATA_READY) == 0);
+        gnssHandle = gHandles.gnssHandle;
+
+        pModule = pUGnssPrivateGetModule(gnssHandle);
+        U_PORT_TEST_ASSERT(pModule != NULL);
+        if (transportTypes[x] == U_GNSS_TRANSPORT_AT) {
+            U_PORT_TEST_ASSERT(uGnssCfgValGetAsync(gnssHandle, keyId[0],
+                                                   U_GNSS_CFG_VAL_LAYER_RAM,
+                                                   valGetAsyncCallback,
+                                                   &(async[0])) < 0);
+        } else if (U_GNSS_PRIVATE_HAS(pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
+            // Wild-cards are not allowed
+            U_PORT_TEST_ASSERT(uGnssCfgValGetAsync(gnssHandle,
+                                                   U_GNSS_CFG_VAL_KEY(U_GNSS_CFG_VAL_KEY_GROUP_ID_ALL,
+                                                                      U_GNSS_CFG_VAL_KEY_ITEM_ID_ALL,
+                                                                      U_GNSS_CFG_VAL_KEY_SIZE_EIGHT_BYTES),
+                                                   U_GNSS_CFG_VAL_LAYER_RAM,
+                                                   valGetAsyncCallback,
+                                                   &(async[0])) < 0);
+            memset(async, 0, sizeof(async));
+            for (size_t z = 0; z < sizeof(keyId) / sizeof(keyId[0]); z++) {
+                async[z].errorCode = INT32_MIN;
+                U_PORT_TEST_ASSERT(uGnssCfgValGetAsync(gnssHandle, keyId[z],
+                                                       U_GNSS_CFG_VAL_LAYER_RAM,
+                                                       valGetAsyncCallback,
+                                                       &(async[z])) == 0);
+            }
+            // Wait for both to complete
+            done = false;
+            for (size_t z = 0; !done && (z < (size_t) uGnssGetTimeout(gnssHandle) / 100 + 10); z++) {
+                uPortTaskBlock(100);
+                done = true;
+                for (size_t w = 0; w < sizeof(async) / sizeof(async[0]); w++) {
+                    if (async[w].errorCode == INT32_MIN) {
+                        done = false;
+                    }
+                }
+            }
+            // Check the outcome against the blocking version
+            for (size_t z = 0; z < sizeof(keyId) / sizeof(keyId[0]); z++) {
+                U_TEST_PRINT_LINE("key ID 0x%08x: async error code %d, value 0x%08x%08x.",
+                                  keyId[z], async[z].errorCode,
+                                  (uint32_t) (async[z].value >> 32), (uint32_t) async[z].value);
+                U_PORT_TEST_ASSERT(async[z].errorCode == 0);
+                U_PORT_TEST_ASSERT(async[z].keyId == keyId[z]);
+                value = 0;
+                U_PORT_TEST_ASSERT(uGnssCfgValGet(gnssHandle, keyId[z], &value,
+                                                  storageSizeBytes(keyId[z]),
+                                                  U_GNSS_CFG_VAL_LAYER_RAM) == 0);
+                U_PORT_TEST_ASSERT(value == async[z].value);
+            }
+            // The message receive task stays up after a one-shot
+            // reader has gone, stop it to free its memory
+            U_PORT_TEST_ASSERT(uGnssMsgReceiveStopAll(gnssHandle) == 0);
+
+            // Check that we haven't dropped any incoming data
+            y = uGnssMsgReceiveStatStreamLoss(gnssHandle);
+            U_TEST_PRINT_LINE("%d byte(s) lost at the input to the ring-buffer during that test.", y);
+            U_PORT_TEST_ASSERT(y == 0);
+        } else {
+            U_TEST_PRINT_LINE("this module does not support VALXXX messages, not testing them.");
+        }
+
+        // Do the standard postamble, leaving the module on for the next
+        // test to speed things up
+        uGnssTestPrivatePostamble(&gHandles, false);
+    }
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+/** Test setting and clearing geofences, checking the CFG-GEOFENCE
+ * values that are read back from the GNSS chip.
+ */
+U_PORT_TEST_FUNCTION("[gnssCfg]", "gnssCfgGeofence")
+{
+    uDeviceHandle_t gnssHandle;
+    const uGnssPrivateModule_t *pModule;
+    int32_t heapUsed;
+    uint32_t keyIdMsgOut;
+    uint64_t value;
+    size_t iterations;
+    uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM_WITH_UBX];
+
+    // In case a previous test failed
+    uGnssTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    // Repeat for all transport types
+    iterations = uGnssTestPrivateTransportTypesSet(transportTypes, U_CFG_APP_GNSS_UART,
+                                                   U_CFG_APP_GNSS_I2C);
+    for (size_t x = 0; x < iterations; x++) {
+        // Do the standard preamble
+        U_TEST_PRINT_LINE("testing on transport %s...",
+                          pGnssTestPrivateTransportTypeName(transportTypes[x]));
+        U_PORT_TEST_ASSERT(uGnssTestPrivatePreamble(U_CFG_TEST_GNSS_MODULE_TYPE,
+                                                    transportTypes[x], &gHandles, true,
+                                                    U_CFG_APP_CELL_PIN_GNSS_POWER,
+                                                    U_CFG_APP_CELL_PIN_GNSS_DATA_READY) == 0);
+        gnssHandle = gHandles.gnssHandle;
+
+        pModule = pUGnssPrivateGetModule(gnssHandle);
+        U_PORT_TEST_ASSERT(pModule != NULL);
+        if ((transportTypes[x] != U_GNSS_TRANSPORT_AT) &&
+            U_GNSS_PRIVATE_HAS(pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
+            // So that we can see what we're doing
+            uGnssSetUbxMessagePrint(gnssHandle, true);
+
+            // Parameter checks
+            U_PORT_TEST_ASSERT(uGnssGeofenceSet(gnssHandle, NULL, 1,
+                                                U_GNSS_GEOFENCE_CONFIDENCE_0,
+                                                -1, false, NULL, NULL) < 0);
+            U_PORT_TEST_ASSERT(uGnssGeofenceSet(gnssHandle, gGeofence, 0,
+                                                U_GNSS_GEOFENCE_CONFIDENCE_0,
+                                                -1, false, NULL, NULL) < 0);
+            U_PORT_TEST_ASSERT(uGnssGeofenceSet(gnssHandle, gGeofence,
+                                                U_GNSS_GEOFENCE_MAX_NUM + 1,
+                                                U_GNSS_GEOFENCE_CONFIDENCE_0,
+                                                -1, false, NULL, NULL) < 0);
+            U_PORT_TEST_ASSERT(uGnssGeofenceSet(gnssHandle, gGeofence, 1,
+                                                U_GNSS_GEOFENCE_CONFIDENCE_MAX_NUM,
+                                                -1, false, NULL, NULL) < 0);
+            U_PORT_TEST_ASSERT(uGnssGeofenceSet(gnssHandle, gGeofence, 1,
+                                                U_GNSS_GEOFENCE_CONFIDENCE_0,
+                                                256, false, NULL, NULL) < 0);
+
+            // Set each number of geofences in turn, with a different
+            // confidence level each time, and read them back
+            for (size_t y = 1; y <= U_GNSS_GEOFENCE_MAX_NUM; y++) {
+                U_TEST_PRINT_LINE("setting %d geofence(s), confidence %d.",
+                                  (int32_t) y, (int32_t) y);
+                U_PORT_TEST_ASSERT(uGnssGeofenceSet(gnssHandle, gGeofence, y,
+                                                    (uGnssGeofenceConfidence_t) y,
+                                                    -1, false, NULL, NULL) == 0);
+                checkGeofence(gnssHandle, gGeofence, y, (uGnssGeofenceConfidence_t) y);
+            }
+            // Setting fewer must switch the others off
+            U_PORT_TEST_ASSERT(uGnssGeofenceSet(gnssHandle, &(gGeofence[1]), 1,
+                                                U_GNSS_GEOFENCE_CONFIDENCE_0,
+                                                -1, false, NULL, NULL) == 0);
+            checkGeofence(gnssHandle, &(gGeofence[1]), 1, U_GNSS_GEOFENCE_CONFIDENCE_0);
+
+            // Now with a callback, which should switch UBX-NAV-GEOFENCE
+            // on for the port we are connected to
+            keyIdMsgOut = U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_NAV_GEOFENCE_I2C_U1;
+            if (transportTypes[x] == U_GNSS_TRANSPORT_UART) {
+                keyIdMsgOut = U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_NAV_GEOFENCE_UART1_U1;
+            }
+            gGeofenceCallbackCount = 0;
+            U_PORT_TEST_ASSERT(uGnssGeofenceSet(gnssHandle, gGeofence, 2,
+                                                U_GNSS_GEOFENCE_CONFIDENCE_95,
+                                                -1, false, geofenceCallback, NULL) == 0);
+            checkGeofence(gnssHandle, gGeofence, 2, U_GNSS_GEOFENCE_CONFIDENCE_95);
+            value = 0;
+            U_PORT_TEST_ASSERT(uGnssCfgValGet(gnssHandle, keyIdMsgOut, &value, 1,
+                                              U_GNSS_CFG_VAL_LAYER_RAM) == 0);
+            U_PORT_TEST_ASSERT((uint8_t) value == 1);
+            // Whether the callback is called depends on whether the
+            // GNSS chip has a fix, so just report it
+            uPortTaskBlock(5000);
+            U_TEST_PRINT_LINE("geofence callback was called %d time(s).",
+                              gGeofenceCallbackCount);
+
+            // Clear the geofences: everything should be off
+            U_TEST_PRINT_LINE("clearing geofences.");
+            U_PORT_TEST_ASSERT(uGnssGeofenceClear(gnssHandle) == 0);
+            checkGeofence(gnssHandle, NULL, 0, U_GNSS_GEOFENCE_CONFIDENCE_95);
+            value = UINT64_MAX;
+            U_PORT_TEST_ASSERT(uGnssCfgValGet(gnssHandle, keyIdMsgOut, &value, 1,
+                                              U_GNSS_CFG_VAL_LAYER_RAM) == 0);
+            U_PORT_TEST_ASSERT((uint8_t) value == 0);
+
+            // The message receive task stays up after the geofence
+            // receiver has gone, stop it to free its memory
+            U_PORT_TEST_ASSERT(uGnssMsgReceiveStopAll(gnssHandle) == 0);
+        } else {
+            U_TEST_PRINT_LINE("geofencing is not supported on this module/transport.");
+            U_PORT_TEST_ASSERT(uGnssGeofenceSet(gnssHandle, gGeofence, 1,
+                                                U_GNSS_GEOFENCE_CONFIDENCE_0,
+                                                -1, false, NULL, NULL) < 0);
+            U_PORT_TEST_ASSERT(uGnssGeofenceClear(gnssHandle) < 0);
+        }
+
+        // Do the standard postamble, leaving the module on for the next
+        // test to speed things up
+        uGnssTestPrivatePostamble(&gHandles, false);
+    }
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+/** Test changing the baud rate of the GNSS chip's UART: only
+ * relevant where the GNSS chip is connected via UART.
+ */
+U_PORT_TEST_FUNCTION("[gnssCfg]", "gnssCfgUartBaudRate")
+{
+    uGnssTransportHandle_t transportHandle;
+    int32_t heapUsed;
+    // Switch up and then back to where we started
+    const int32_t baudRate[] = {115200, U_GNSS_UART_BAUD_RATE};
+
+    // In case a previous test failed
+    uGnssTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    if (U_CFG_APP_GNSS_UART >= 0) {
+        // Do the standard preamble
+        U_PORT_TEST_ASSERT(uGnssTestPrivatePreamble(U_CFG_TEST_GNSS_MODULE_TYPE,
+                                                    U_GNSS_TRANSPORT_UART, &gHandles, true,
+                                                    U_CFG_APP_CELL_PIN_GNSS_POWER,
+                                                    U_CFG_APP_CELL_PIN_GNSS_DATA_READY) == 0);
+
+        for (size_t x = 0; x < sizeof(baudRate) / sizeof(baudRate[0]); x++) {
+            U_TEST_PRINT_LINE("switching GNSS UART to %d baud...", baudRate[x]);
+            // Don't persist the change so that, should this test fail,
+            // a power-cycle will put things back as they were
+            U_PORT_TEST_ASSERT(uGnssCfgSetUartBaudRate(gHandles.gnssHandle,
+                                                       baudRate[x], false) == 0);
+            // Re-open the UART at the new rate and re-add the GNSS instance
+            uGnssRemove(gHandles.gnssHandle);
+            gHandles.gnssHandle = NULL;
+            uPortUartClose(gHandles.streamHandle);
+            gHandles.streamHandle = uPortUartOpen(U_CFG_APP_GNSS_UART,
+                                                  baudRate[x], NULL,
+                                                  U_GNSS_UART_BUFFER_LENGTH_BYTES,
+                                                  U_CFG_APP_PIN_GNSS_TXD,
+                                                  U_CFG_APP_PIN_GNSS_RXD,
+                                                  U_CFG_APP_PIN_GNSS_CTS,
+                                                  U_CFG_APP_PIN_GNSS_RTS);
+            U_PORT_TEST_ASSERT(gHandles.streamHandle >= 0);
+            transportHandle.uart = gHandles.streamHandle;
+            U_PORT_TEST_ASSERT(uGnssAdd(U_CFG_TEST_GNSS_MODULE_TYPE,
+                                        U_GNSS_TRANSPORT_UART, transportHandle,
+                                        U_CFG_APP_PIN_GNSS_ENABLE_POWER, false,
+                                        &gHandles.gnssHandle) == 0);
+            // Confirm that we can still talk to the GNSS chip
+            U_PORT_TEST_ASSERT(uGnssPwrIsAlive(gHandles.gnssHandle));
+        }
+
+        // Do the standard postamble, leaving the module on for the next
+        // test to speed things up
+        uGnssTestPrivatePostamble(&gHandles, false);
+    } else {
+        U_TEST_PRINT_LINE("GNSS is not connected via UART, not testing baud rate change.");
+    }
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
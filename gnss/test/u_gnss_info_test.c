@@ -105,10 +105,32 @@
  */
 static uGnssTestPrivate_t gHandles = U_GNSS_TEST_PRIVATE_DEFAULTS;
 
+/** The error code passed to versionsCallback(), INT32_MIN until called.
+ */
+static volatile int32_t gVersionsErrorCode = INT32_MIN;
+
+/** The version information passed to versionsCallback().
+ */
+static uGnssVersionType_t gVersions;
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Callback for uGnssInfoGetVersionsAsync().
+static void versionsCallback(uDeviceHandle_t gnssHandle, int32_t errorCode,
+                             const uGnssVersionType_t *pVer,
+                             void *pCallbackParam)
+{
+    (void) gnssHandle;
+    (void) pCallbackParam;
+
+    if (pVer != NULL) {
+        gVersions = *pVer;
+    }
+    gVersionsErrorCode = errorCode;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -223,6 +245,24 @@ U_PORT_TEST_FUNCTION("[gnssInfo]", "gnssInfoStatic")
                  version.rom, version.fw,
                  version.prot, version.mod);
 
+        if (transportTypes[w] != U_GNSS_TRANSPORT_AT) {
+            // Do the same without blocking
+            gVersionsErrorCode = INT32_MIN;
+            memset(&gVersions, 0, sizeof(gVersions));
+            U_PORT_TEST_ASSERT(uGnssInfoGetVersionsAsync(gnssHandle, versionsCallback, NULL) == 0);
+            for (size_t x = 0; (gVersionsErrorCode == INT32_MIN) &&
+                 (x < (size_t) uGnssGetTimeout(gnssHandle) / 100 + 10); x++) {
+                uPortTaskBlock(100);
+            }
+            U_TEST_PRINT_LINE("uGnssInfoGetVersionsAsync() returned %d.", gVersionsErrorCode);
+            U_PORT_TEST_ASSERT(gVersionsErrorCode == 0);
+            U_PORT_TEST_ASSERT(strcmp(gVersions.ver, version.ver) == 0);
+            U_PORT_TEST_ASSERT(strcmp(gVersions.hw, version.hw) == 0);
+            // The message receive task stays up after a one-shot
+            // reader has gone, stop it to free its memory
+            U_PORT_TEST_ASSERT(uGnssMsgReceiveStopAll(gnssHandle) == 0);
+        }
+
         // Free memory
         uPortFree(pBuffer);
 
@@ -0,0 +1,344 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the GNSS multiple GNSS assistance (MGA) API: these
+ * should pass on all platforms that have a GNSS module connected to
+ * them.  They are only compiled if U_CFG_TEST_GNSS_MODULE_TYPE is
+ * defined.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_TEST_GNSS_MODULE_TYPE
+
+# ifdef U_CFG_OVERRIDE
+#  include "u_cfg_override.h" // For a customer's configuration override
+# endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port_clib_platform_specific.h" /* Integer stdio, must be included
+                                              before the other port files if
+                                              any print or scan function is used. */
+#include "u_port.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"   // Required by u_gnss_private.h
+#include "u_port_uart.h"
+
+#include "u_ubx_protocol.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss.h"
+#include "u_gnss_mga.h"
+#include "u_gnss_private.h"
+
+#include "u_gnss_test_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_GNSS_MGA_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/** The length of the body of UBX-MGA-INI-TIME_UTC.
+ */
+#define U_GNSS_MGA_TEST_INI_TIME_UTC_BODY_LENGTH_BYTES 24
+
+/** The number of bytes to return from each call of the read
+ * callback: deliberately small and odd so that messages are
+ * split across reads.
+ */
+#define U_GNSS_MGA_TEST_READ_LENGTH_BYTES 7
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Context for the read callback.
+ */
+typedef struct {
+    const char *pBuffer;
+    size_t size;
+    size_t offset;
+} uGnssMgaTestRead_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Handles.
+ */
+static uGnssTestPrivate_t gHandles = U_GNSS_TEST_PRIVATE_DEFAULTS;
+
+/** The number of times the progress callback has been called.
+ */
+static size_t gProgressCount = 0;
+
+/** The message count last passed to the progress callback.
+ */
+static size_t gProgressMessageCount = 0;
+
+/** Set to a negative value if the progress callback is passed an
+ * error code other than success or #U_GNSS_ERROR_NACK.
+ */
+static int32_t gProgressErrorCode = 0;
+
+/** The number of calls to the progress callback after which it should
+ * return false, zero for never.
+ */
+static size_t gProgressStopCount = 0;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Progress callback.
+static bool progressCallback(uDeviceHandle_t gnssHandle, int32_t errorCode,
+                             size_t messageCount, void *pCallbackParam)
+{
+    (void) pCallbackParam;
+
+    if (gnssHandle != gHandles.gnssHandle) {
+        gProgressErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    }
+    if ((errorCode != 0) && (errorCode != (int32_t) U_GNSS_ERROR_NACK)) {
+        gProgressErrorCode = errorCode;
+    }
+    gProgressMessageCount = messageCount;
+    gProgressCount++;
+
+    return (gProgressStopCount == 0) || (gProgressCount < gProgressStopCount);
+}
+
+// Read callback, returning a few bytes at a time from a buffer.
+static int32_t readCallback(uDeviceHandle_t gnssHandle, char *pBuffer,
+                            size_t size, void *pCallbackParam)
+{
+    uGnssMgaTestRead_t *pRead = (uGnssMgaTestRead_t *) pCallbackParam;
+    size_t length = pRead->size - pRead->offset;
+
+    (void) gnssHandle;
+
+    if (length > U_GNSS_MGA_TEST_READ_LENGTH_BYTES) {
+        length = U_GNSS_MGA_TEST_READ_LENGTH_BYTES;
+    }
+    if (length > size) {
+        length = size;
+    }
+    memcpy(pBuffer, pRead->pBuffer + pRead->offset, length);
+    pRead->offset += length;
+
+    return (int32_t) length;
+}
+
+// Reset the progress callback variables.
+static void progressReset(size_t stopCount)
+{
+    gProgressCount = 0;
+    gProgressMessageCount = 0;
+    gProgressErrorCode = 0;
+    gProgressStopCount = stopCount;
+}
+
+// Encode a UBX-MGA-INI-TIME_UTC message with a coarse, one hour,
+// accuracy into pBuffer, returning the number of bytes written.
+static size_t encodeIniTimeUtc(char *pBuffer)
+{
+    char body[U_GNSS_MGA_TEST_INI_TIME_UTC_BODY_LENGTH_BYTES] = {0};
+    uint16_t year = uUbxProtocolUint16Encode(2022);
+    uint16_t accuracySeconds = uUbxProtocolUint16Encode(3600);
+
+    body[0] = 0x10;  // Type: UTC time
+    body[3] = (char) -128; // Leap seconds unknown
+    memcpy(body + 4, &year, sizeof(year));
+    body[6] = 6;     // Month
+    body[7] = 1;     // Day
+    body[8] = 12;    // Hour
+    memcpy(body + 16, &accuracySeconds, sizeof(accuracySeconds));
+
+    return (size_t) uUbxProtocolEncode(0x13, 0x40, body, sizeof(body), pBuffer);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Send assistance data to the GNSS chip.
+ */
+U_PORT_TEST_FUNCTION("[gnssMga]", "gnssMgaBasic")
+{
+    uDeviceHandle_t gnssHandle;
+    int32_t heapUsed;
+    // Room for two UBX-MGA-INI-TIME_UTC messages, a UBX-MON-VER poll
+    // and some rubbish
+    char buffer[((U_GNSS_MGA_TEST_INI_TIME_UTC_BODY_LENGTH_BYTES +
+                  U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES) * 2) +
+                U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES + 3];
+    size_t size = 0;
+    uGnssMgaTestRead_t read;
+    size_t iterations;
+    uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM_WITH_UBX];
+
+    // In case a previous test failed
+    uGnssTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    // Make up the data: rubbish, an assistance message, something
+    // that isn't an assistance message, then another assistance message
+    buffer[size++] = (char) 0xb5;
+    buffer[size++] = 'x';
+    buffer[size++] = 0x62;
+    size += encodeIniTimeUtc(buffer + size);
+    size += (size_t) uUbxProtocolEncode(0x0a, 0x04, NULL, 0, buffer + size);
+    size += encodeIniTimeUtc(buffer + size);
+    U_PORT_TEST_ASSERT(size == sizeof(buffer));
+
+    iterations = uGnssTestPrivateTransportTypesSet(transportTypes, U_CFG_APP_GNSS_UART,
+                                                   U_CFG_APP_GNSS_I2C);
+    for (size_t w = 0; w < iterations; w++) {
+        // Do the standard preamble
+        U_TEST_PRINT_LINE("testing on transport %s...",
+                          pGnssTestPrivateTransportTypeName(transportTypes[w]));
+        U_PORT_TEST_ASSERT(uGnssTestPrivatePreamble(U_CFG_TEST_GNSS_MODULE_TYPE,
+                                                    transportTypes[w], &gHandles, true,
+                                                    U_CFG_APP_CELL_PIN_GNSS_POWER,
+                                                    U_CFG_APP_CELL_PIN_GNSS_DATA_READY) == 0);
+        gnssHandle = gHandles.gnssHandle;
+
+        // So that we can see what we're doing
+        uGnssSetUbxMessagePrint(gnssHandle, true);
+
+        U_PORT_TEST_ASSERT(uGnssMgaSend(gnssHandle, NULL, 0, U_GNSS_MGA_FLOW_CONTROL_ACK,
+                                        NULL, NULL) < 0);
+        U_PORT_TEST_ASSERT(uGnssMgaSendRead(gnssHandle, NULL, NULL, U_GNSS_MGA_FLOW_CONTROL_ACK,
+                                            NULL, NULL) < 0);
+        U_PORT_TEST_ASSERT(uGnssMgaSend(gnssHandle, buffer, size, U_GNSS_MGA_FLOW_CONTROL_MAX_NUM,
+                                        NULL, NULL) < 0);
+
+        if (transportTypes[w] == U_GNSS_TRANSPORT_AT) {
+            U_TEST_PRINT_LINE("MGA is not supported on AT transport.");
+            U_PORT_TEST_ASSERT(uGnssMgaSend(gnssHandle, buffer, size,
+                                            U_GNSS_MGA_FLOW_CONTROL_ACK,
+                                            NULL, NULL) == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
+        } else {
+            // Send from the buffer, with acknowledgement
+            U_TEST_PRINT_LINE("sending from a buffer with ack flow control...");
+            progressReset(0);
+            U_PORT_TEST_ASSERT(uGnssMgaSend(gnssHandle, buffer, size,
+                                            U_GNSS_MGA_FLOW_CONTROL_ACK,
+                                            progressCallback, NULL) == 2);
+            U_PORT_TEST_ASSERT(gProgressCount == 2);
+            U_PORT_TEST_ASSERT(gProgressMessageCount == 2);
+            U_PORT_TEST_ASSERT(gProgressErrorCode == 0);
+
+            // Send through the read callback, with a fixed wait
+            U_TEST_PRINT_LINE("sending from a read callback with wait flow control...");
+            progressReset(0);
+            memset(&read, 0, sizeof(read));
+            read.pBuffer = buffer;
+            read.size = size;
+            U_PORT_TEST_ASSERT(uGnssMgaSendRead(gnssHandle, readCallback, &read,
+                                                U_GNSS_MGA_FLOW_CONTROL_WAIT,
+                                                progressCallback, NULL) == 2);
+            U_PORT_TEST_ASSERT(read.offset == size);
+            U_PORT_TEST_ASSERT(gProgressCount == 2);
+            U_PORT_TEST_ASSERT(gProgressErrorCode == 0);
+
+            // Check that the progress callback can stop things
+            U_TEST_PRINT_LINE("stopping after the first message...");
+            progressReset(1);
+            memset(&read, 0, sizeof(read));
+            read.pBuffer = buffer;
+            read.size = size;
+            U_PORT_TEST_ASSERT(uGnssMgaSendRead(gnssHandle, readCallback, &read,
+                                                U_GNSS_MGA_FLOW_CONTROL_NONE,
+                                                progressCallback, NULL) == 1);
+            U_PORT_TEST_ASSERT(read.offset < size);
+            U_PORT_TEST_ASSERT(gProgressCount == 1);
+            U_PORT_TEST_ASSERT(gProgressErrorCode == 0);
+        }
+
+        // Do the standard postamble, powering the module off so that
+        // the assistance data doesn't hang around for the next test
+        uGnssTestPrivatePostamble(&gHandles, true);
+    }
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[gnssMga]", "gnssMgaCleanUp")
+{
+    int32_t x;
+
+    uGnssTestPrivateCleanup(&gHandles);
+
+    x = uPortTaskStackMinFree(NULL);
+    if (x != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        U_TEST_PRINT_LINE("main task stack had a minimum of %d byte(s)"
+                          " free at the end of these tests.", x);
+        U_PORT_TEST_ASSERT(x >= U_CFG_TEST_OS_MAIN_TASK_MIN_FREE_STACK_BYTES);
+    }
+
+    uPortDeinit();
+
+    x = uPortGetHeapMinFree();
+    if (x >= 0) {
+        U_TEST_PRINT_LINE("heap had a minimum of %d byte(s) free"
+                          " at the end of these tests.", x);
+        U_PORT_TEST_ASSERT(x >= U_CFG_TEST_HEAP_MIN_FREE_BYTES);
+    }
+}
+
+#endif // #ifdef U_CFG_TEST_GNSS_MODULE_TYPE
+
+// End of file
@@ -66,6 +66,8 @@
 #include "u_gnss_info.h"  // For uGnssInfoGetFirmwareVersionStr() and uGnssInfoGetCommunicationStats()
 #include "u_gnss_pos.h"   // For uGnssPosGetStart()
 #include "u_gnss_msg.h"
+#include "u_gnss_msg_ubx.h" // For the UBX message IDs and lengths
+#include "u_gnss_record.h"
 #include "u_gnss_private.h"
 
 #include "u_gnss_test_private.h"
@@ -131,6 +133,34 @@
 # define U_GNSS_MSG_TEST_MESSAGE_RECEIVE_NON_BLOCKING_POLL_DELAY_SECONDS 3
 #endif
 
+#ifndef U_GNSS_MSG_TEST_RECORD_BUFFER_SIZE_BYTES
+/** The buffer size to use when testing the raw stream recorder:
+ * small, so that the sink is called often.
+ */
+# define U_GNSS_MSG_TEST_RECORD_BUFFER_SIZE_BYTES 256
+#endif
+
+#ifndef U_GNSS_MSG_TEST_RECORD_NUM_CYCLES
+/** The number of times to start and stop the raw stream recorder
+ * in quick succession while message receive is running.
+ */
+# define U_GNSS_MSG_TEST_RECORD_NUM_CYCLES 20
+#endif
+
+#ifndef U_GNSS_MSG_TEST_SHARED_BUFFER_LENGTH_BYTES
+/** The size of the loop-back buffer behind each of the virtual
+ * serial ports used by gnssMsgReceiveShared.
+ */
+# define U_GNSS_MSG_TEST_SHARED_BUFFER_LENGTH_BYTES 64
+#endif
+
+#ifndef U_GNSS_MSG_TEST_SHARED_TIMEOUT_MS
+/** How long to wait for a looped-back message to reach its
+ * message receiver in gnssMsgReceiveShared.
+ */
+# define U_GNSS_MSG_TEST_SHARED_TIMEOUT_MS 5000
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -151,12 +181,28 @@ typedef struct {
     size_t numWhenStopped;
     size_t numNotWanted;
     bool useNmeaComprehender;
+    bool useSpan;
     void *pNmeaComprehenderContext;
     bool nmeaSequenceHasBegun;
     size_t numNmeaSequence;
     size_t numNmeaBadSequence;
 } uGnssMsgTestReceive_t;
 
+#ifdef U_GNSS_MSG_RECEIVE_TASK_SHARED
+/** A GNSS instance on a loop-back virtual serial port, as used by
+ * gnssMsgReceiveShared: whatever is sent to the instance comes back
+ * to its message receiver.
+ */
+typedef struct {
+    uGnssVirtualSerial_t virtualSerial;
+    char buffer[U_GNSS_MSG_TEST_SHARED_BUFFER_LENGTH_BYTES];
+    size_t length;
+    uDeviceHandle_t gnssHandle;
+    uint16_t classAndId;
+    volatile size_t numReceived;
+} uGnssMsgTestShared_t;
+#endif
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -173,6 +219,20 @@ static uGnssTestPrivate_t gHandles = U_GNSS_TEST_PRIVATE_DEFAULTS;
  */
 static int32_t gCallbackErrorCode = 0;
 
+/** The number of bytes passed to recordSink().
+ */
+static volatile size_t gRecordBytes = 0;
+
+/** The number of NMEA messages that arrived at recordMessageCallback().
+ */
+static volatile size_t gRecordNumMessages = 0;
+
+#ifdef U_GNSS_MSG_RECEIVE_TASK_SHARED
+/** The two GNSS instances used by gnssMsgReceiveShared.
+ */
+static uGnssMsgTestShared_t gShared[2];
+#endif
+
 #ifndef U_CFG_TEST_USING_NRF5SDK
 
 /** Array of message receivers.
@@ -247,18 +307,207 @@ static void checkMessageReceive(uGnssMessageId_t *pMessageId,
     }
 }
 
+// Sink for the raw stream recorder: just counts the bytes.
+static int32_t recordSink(uDeviceHandle_t gnssHandle,
+                          const char *pData, size_t size,
+                          void *pSinkParam)
+{
+    if ((gnssHandle != gHandles.gnssHandle) ||
+        (pSinkParam != (void *) &gRecordBytes)) {
+        gCallbackErrorCode = 8;
+    }
+    if ((pData == NULL) || (size == 0)) {
+        gCallbackErrorCode = 9;
+    }
+    gRecordBytes += size;
+
+    return (int32_t) size;
+}
+
+// Message receive callback used while recording: keeps the data
+// flowing in from the transport, which is what feeds the recorder.
+static void recordMessageCallback(uDeviceHandle_t gnssHandle,
+                                  const uGnssMessageId_t *pMessageId,
+                                  int32_t errorCodeOrLength,
+                                  void *pCallbackParam)
+{
+    (void) gnssHandle;
+    (void) pMessageId;
+    (void) errorCodeOrLength;
+    (void) pCallbackParam;
+
+    gRecordNumMessages++;
+}
+
+#ifdef U_GNSS_MSG_RECEIVE_TASK_SHARED
+
+// Virtual serial loop-back: get the number of bytes waiting.
+static int32_t sharedGetReceiveSize(uGnssVirtualSerial_t *pVirtualSerial)
+{
+    uGnssMsgTestShared_t *pShared = (uGnssMsgTestShared_t *) pVirtualSerial->pContext;
+
+    return (int32_t) pShared->length;
+}
+
+// Virtual serial loop-back: read back what was written.
+static int32_t sharedRead(uGnssVirtualSerial_t *pVirtualSerial,
+                          char *pBuffer, size_t sizeBytes)
+{
+    uGnssMsgTestShared_t *pShared = (uGnssMsgTestShared_t *) pVirtualSerial->pContext;
+
+    if (sizeBytes > pShared->length) {
+        sizeBytes = pShared->length;
+    }
+    memcpy(pBuffer, pShared->buffer, sizeBytes);
+    pShared->length -= sizeBytes;
+    memmove(pShared->buffer, pShared->buffer + sizeBytes, pShared->length);
+
+    return (int32_t) sizeBytes;
+}
+
+// Virtual serial loop-back: write.
+static int32_t sharedWrite(uGnssVirtualSerial_t *pVirtualSerial,
+                           const char *pBuffer, size_t sizeBytes)
+{
+    uGnssMsgTestShared_t *pShared = (uGnssMsgTestShared_t *) pVirtualSerial->pContext;
+
+    if (sizeBytes > sizeof(pShared->buffer) - pShared->length) {
+        sizeBytes = sizeof(pShared->buffer) - pShared->length;
+    }
+    memcpy(pShared->buffer + pShared->length, pBuffer, sizeBytes);
+    pShared->length += sizeBytes;
+
+    return (int32_t) sizeBytes;
+}
+
+// Message receive callback for gnssMsgReceiveShared: checks that
+// the message belongs to the instance it arrived on and that it
+// can be read, which is only allowed from the task that is
+// servicing that instance.
+static void sharedMessageCallback(uDeviceHandle_t gnssHandle,
+                                  const uGnssMessageId_t *pMessageId,
+                                  int32_t errorCodeOrLength,
+                                  void *pCallbackParam)
+{
+    uGnssMsgTestShared_t *pShared = (uGnssMsgTestShared_t *) pCallbackParam;
+    char buffer[U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+
+    if (gnssHandle != pShared->gnssHandle) {
+        gCallbackErrorCode = 10;
+    } else if ((pMessageId->type != U_GNSS_PROTOCOL_UBX) ||
+               (pMessageId->id.ubx != pShared->classAndId)) {
+        gCallbackErrorCode = 11;
+    } else if ((errorCodeOrLength != sizeof(buffer)) ||
+               (uGnssMsgReceiveCallbackRead(gnssHandle, buffer,
+                                            sizeof(buffer)) != sizeof(buffer))) {
+        gCallbackErrorCode = 12;
+    }
+    pShared->numReceived++;
+}
+
+// Send a body-less UBX message to a loop-back instance of
+// gnssMsgReceiveShared.
+static void sharedSend(uGnssMsgTestShared_t *pShared)
+{
+    char message[U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+
+    U_PORT_TEST_ASSERT(uUbxProtocolEncode(pShared->classAndId >> 8,
+                                          pShared->classAndId & 0xFF,
+                                          NULL, 0, message) == sizeof(message));
+    U_PORT_TEST_ASSERT(uGnssMsgSend(pShared->gnssHandle, message,
+                                    sizeof(message)) == sizeof(message));
+}
+
+// Wait for the message receivers of gnssMsgReceiveShared to have
+// received the given numbers of messages.
+static bool sharedWait(size_t numReceived0, size_t numReceived1)
+{
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    while (((gShared[0].numReceived < numReceived0) ||
+            (gShared[1].numReceived < numReceived1)) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_GNSS_MSG_TEST_SHARED_TIMEOUT_MS)) {
+        uPortTaskBlock(10);
+    }
+    U_TEST_PRINT_LINE("instance 0 received %d message(s), instance 1 %d.",
+                      (int32_t) gShared[0].numReceived,
+                      (int32_t) gShared[1].numReceived);
+
+    return (gShared[0].numReceived == numReceived0) &&
+           (gShared[1].numReceived == numReceived1);
+}
+
+// Return the handle of the task servicing the message receivers
+// of a GNSS instance, NULL if there is none.
+static uPortTaskHandle_t sharedTaskHandle(uDeviceHandle_t gnssHandle)
+{
+    uPortTaskHandle_t taskHandle = NULL;
+    uGnssPrivateInstance_t *pInstance = pUGnssPrivateGetInstance(gnssHandle);
+
+    if ((pInstance != NULL) && (pInstance->pMsgReceive != NULL)) {
+        taskHandle = pInstance->pMsgReceive->taskHandle;
+    }
+
+    return taskHandle;
+}
+
+#endif // #ifdef U_GNSS_MSG_RECEIVE_TASK_SHARED
+
 // NRF52, which we use NRF5SDK on, doesn't have enough heap for this test
 #ifndef U_CFG_TEST_USING_NRF5SDK
 
-// Callback for the non-blocking message receives.
-static void messageReceiveCallback(uDeviceHandle_t gnssHandle,
-                                   const uGnssMessageId_t *pMessageId,
-                                   int32_t errorCodeOrLength,
-                                   void *pCallbackParam)
+// Process a message that has been read into the buffer of a
+// non-blocking message receiver.
+static void messageReceiveProcess(uGnssMsgTestReceive_t *pMsgReceive,
+                                  int32_t length)
 {
-    uGnssMsgTestReceive_t *pMsgReceive = (uGnssMsgTestReceive_t *) pCallbackParam;
     int32_t nmeaComprehenderErrorCode;
 
+    pMsgReceive->numRead++;
+    pMsgReceive->numDecoded++;
+    // NOTE: uGnssTestPrivateNmeaComprehender() currently only supports
+    // M9, hence this check
+    if ((pMsgReceive->messageId.type == U_GNSS_PROTOCOL_NMEA) &&
+        (pMsgReceive->moduleType == U_GNSS_MODULE_TYPE_M9) &&
+        (pMsgReceive->useNmeaComprehender)) {
+#ifdef U_GNSS_MSG_TEST_MESSAGE_RECEIVE_NON_BLOCKING_PRINT
+        // It's often useful to see these messages but the load is
+        // heavy so we don't enable printing unless required
+        U_TEST_PRINT_LINE("%.*s", length - 2, pMsgReceive->pBuffer);
+#endif
+        // This is an NMEA message, pass it to the comprehender
+        nmeaComprehenderErrorCode = uGnssTestPrivateNmeaComprehender(pMsgReceive->pBuffer,
+                                                                     length,
+                                                                     &(pMsgReceive->pNmeaComprehenderContext),
+                                                                     !U_CFG_OS_CLIB_LEAKS);
+        if (pMsgReceive->nmeaSequenceHasBegun) {
+            if (nmeaComprehenderErrorCode == (int32_t) U_ERROR_COMMON_NOT_FOUND) {
+                // NMEA sequence is not as expected
+                pMsgReceive->numNmeaBadSequence++;
+                pMsgReceive->nmeaSequenceHasBegun = false;
+            } else if (nmeaComprehenderErrorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+                // An NMEA sequence has been completed, well done
+                pMsgReceive->nmeaSequenceHasBegun = false;
+            }
+        } else {
+            if (nmeaComprehenderErrorCode == (int32_t) U_ERROR_COMMON_TIMEOUT) {
+                // An NMEA sequence has started
+                pMsgReceive->nmeaSequenceHasBegun = true;
+                pMsgReceive->numNmeaSequence++;
+            }
+        }
+    }
+}
+
+// Check the parameters passed to a non-blocking message receive
+// callback and, if all is good, update the counts of the receiver.
+static bool messageReceiveCheck(uDeviceHandle_t gnssHandle,
+                                const uGnssMessageId_t *pMessageId,
+                                int32_t errorCodeOrLength,
+                                uGnssMsgTestReceive_t *pMsgReceive)
+{
+    bool readIt = false;
+
     if (gnssHandle != gHandles.gnssHandle) {
         gCallbackErrorCode = 1;
     }
@@ -268,7 +517,7 @@ static void messageReceiveCallback(uDeviceHandle_t gnssHandle,
     if (errorCodeOrLength < 0) {
         gCallbackErrorCode = 3;
     }
-    if (pCallbackParam == NULL) {
+    if (pMsgReceive == NULL) {
         gCallbackErrorCode = 4;
     }
 
@@ -282,44 +531,7 @@ static void messageReceiveCallback(uDeviceHandle_t gnssHandle,
         }
         if ((errorCodeOrLength > 0) &&
             (errorCodeOrLength <= U_GNSS_MSG_TEST_MESSAGE_RECEIVE_NON_BLOCKING_BUFFER_SIZE_BYTES)) {
-            if (uGnssMsgReceiveCallbackRead(gnssHandle,
-                                            pMsgReceive->pBuffer,
-                                            errorCodeOrLength) == errorCodeOrLength) {
-                pMsgReceive->numRead++;
-                pMsgReceive->numDecoded++;
-                // NOTE: uGnssTestPrivateNmeaComprehender() currently only supports
-                // M9, hence this check
-                if ((pMsgReceive->messageId.type == U_GNSS_PROTOCOL_NMEA) &&
-                    (pMsgReceive->moduleType == U_GNSS_MODULE_TYPE_M9) &&
-                    (pMsgReceive->useNmeaComprehender)) {
-#ifdef U_GNSS_MSG_TEST_MESSAGE_RECEIVE_NON_BLOCKING_PRINT
-                    // It's often useful to see these messages but the load is
-                    // heavy so we don't enable printing unless required
-                    U_TEST_PRINT_LINE("%.*s", errorCodeOrLength - 2, pMsgReceive->pBuffer);
-#endif
-                    // This is an NMEA message, pass it to the comprehender
-                    nmeaComprehenderErrorCode = uGnssTestPrivateNmeaComprehender(pMsgReceive->pBuffer,
-                                                                                 errorCodeOrLength,
-                                                                                 &(pMsgReceive->pNmeaComprehenderContext),
-                                                                                 !U_CFG_OS_CLIB_LEAKS);
-                    if (pMsgReceive->nmeaSequenceHasBegun) {
-                        if (nmeaComprehenderErrorCode == (int32_t) U_ERROR_COMMON_NOT_FOUND) {
-                            // NMEA sequence is not as expected
-                            pMsgReceive->numNmeaBadSequence++;
-                            pMsgReceive->nmeaSequenceHasBegun = false;
-                        } else if (nmeaComprehenderErrorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
-                            // An NMEA sequence has been completed, well done
-                            pMsgReceive->nmeaSequenceHasBegun = false;
-                        }
-                    } else {
-                        if (nmeaComprehenderErrorCode == (int32_t) U_ERROR_COMMON_TIMEOUT) {
-                            // An NMEA sequence has started
-                            pMsgReceive->nmeaSequenceHasBegun = true;
-                            pMsgReceive->numNmeaSequence++;
-                        }
-                    }
-                }
-            }
+            readIt = true;
         } else {
             // Not an error: some messages might just be too large
             pMsgReceive->numOutsize++;
@@ -328,6 +540,50 @@ static void messageReceiveCallback(uDeviceHandle_t gnssHandle,
             pMsgReceive->numWhenStopped++;
         }
     }
+
+    return readIt;
+}
+
+// Callback for the non-blocking message receives.
+static void messageReceiveCallback(uDeviceHandle_t gnssHandle,
+                                   const uGnssMessageId_t *pMessageId,
+                                   int32_t errorCodeOrLength,
+                                   void *pCallbackParam)
+{
+    uGnssMsgTestReceive_t *pMsgReceive = (uGnssMsgTestReceive_t *) pCallbackParam;
+
+    if (messageReceiveCheck(gnssHandle, pMessageId, errorCodeOrLength, pMsgReceive) &&
+        (uGnssMsgReceiveCallbackRead(gnssHandle,
+                                     pMsgReceive->pBuffer,
+                                     errorCodeOrLength) == errorCodeOrLength)) {
+        messageReceiveProcess(pMsgReceive, errorCodeOrLength);
+    }
+}
+
+// Callback for the non-blocking, zero-copy, message receives.
+static void messageReceiveSpanCallback(uDeviceHandle_t gnssHandle,
+                                       const uGnssMessageId_t *pMessageId,
+                                       const uRingBufferSpan_t *pSpan,
+                                       int32_t errorCodeOrLength,
+                                       void *pCallbackParam)
+{
+    uGnssMsgTestReceive_t *pMsgReceive = (uGnssMsgTestReceive_t *) pCallbackParam;
+
+    if (pSpan == NULL) {
+        gCallbackErrorCode = 6;
+    } else if (messageReceiveCheck(gnssHandle, pMessageId, errorCodeOrLength, pMsgReceive)) {
+        if (pSpan[0].length + pSpan[1].length == (size_t) errorCodeOrLength) {
+            // Only copying the message out here so that it can
+            // be checked in the same way as for a normal callback
+            memcpy(pMsgReceive->pBuffer, pSpan[0].pData, pSpan[0].length);
+            if (pSpan[1].length > 0) {
+                memcpy(pMsgReceive->pBuffer + pSpan[0].length, pSpan[1].pData, pSpan[1].length);
+            }
+            messageReceiveProcess(pMsgReceive, errorCodeOrLength);
+        } else {
+            gCallbackErrorCode = 7;
+        }
+    }
 }
 
 #endif // #ifndef U_CFG_TEST_USING_NRF5SDK 
@@ -350,6 +606,7 @@ U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgReceiveBlocking")
     // Enough room to encode the poll for a UBX-MON-VER message
     char command[U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
     uGnssMessageId_t messageId;
+    uGnssMsgUbxPoll_t poll[3];
     size_t iterations;
     uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM_WITH_UBX];
 
@@ -392,6 +649,25 @@ U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgReceiveBlocking")
                                                U_GNSS_MSG_TEST_MESSAGE_RECEIVE_BUFFER_SIZE_BYTES);
             U_PORT_TEST_ASSERT(y > 0);
 
+            // Poll UBX-MON-VER along with UBX-NAV-STATUS and UBX-MON-HW
+            // in one go, UBX-MON-VER last so that it is not first to
+            // arrive
+            U_TEST_PRINT_LINE("polling three UBX messages in one go...");
+            memset(poll, 0, sizeof(poll));
+            poll[0].messageId = U_GNSS_MSG_UBX_NAV_STATUS_MESSAGE_ID;
+            poll[1].messageId = U_GNSS_MSG_UBX_MON_HW_MESSAGE_ID;
+            poll[2].messageId = 0x0a04;
+            poll[2].pBody = pBuffer2;
+            poll[2].bodySize = U_GNSS_MSG_TEST_MESSAGE_RECEIVE_BUFFER_SIZE_BYTES;
+            x = uGnssMsgPollUbx(gnssHandle, poll, sizeof(poll) / sizeof(poll[0]),
+                                U_GNSS_MSG_TEST_MESSAGE_RECEIVE_TIMEOUT_MS);
+            U_TEST_PRINT_LINE("%d poll(s) answered.", x);
+            U_PORT_TEST_ASSERT(x == sizeof(poll) / sizeof(poll[0]));
+            U_PORT_TEST_ASSERT(poll[0].errorCodeOrLength == U_GNSS_MSG_UBX_NAV_STATUS_BODY_LENGTH_BYTES);
+            U_PORT_TEST_ASSERT(poll[1].errorCodeOrLength == U_GNSS_MSG_UBX_MON_HW_BODY_LENGTH_BYTES);
+            U_PORT_TEST_ASSERT(poll[2].errorCodeOrLength == y);
+            U_PORT_TEST_ASSERT(memcmp(pBuffer1, pBuffer2, y) == 0);
+
             // Now manually encode a request for the version string using the
             // message class and ID of the UBX-MON-VER command
             memset(pBuffer2, 0x66, U_GNSS_MSG_TEST_MESSAGE_RECEIVE_BUFFER_SIZE_BYTES);
@@ -486,6 +762,7 @@ U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgReceiveNonBlocking")
     size_t iterations;
     uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM_WITH_UBX];
     uGnssCommunicationStats_t communicationStats;
+    uGnssMsgStats_t msgStats;
     const char *pProtocolName;
 
     // In case a previous test failed
@@ -524,14 +801,17 @@ U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgReceiveNonBlocking")
 
             // Note that we don't switch on message printing here, just too much man
 
-            // Do this twice - once asking for loads of nice long RRLP messages to add
-            // stress, then a second time doing just NMEA messages and checking that
-            // none go missing
-            for (size_t z = 0; z < 2; z++) {
+            // Do this three times - once asking for loads of nice long RRLP messages
+            // to add stress, then a second time doing just NMEA messages and checking
+            // that none go missing, then a third time as the second but with
+            // zero-copy receivers
+            for (size_t z = 0; z < 3; z++) {
                 if (z == 0) {
                     U_TEST_PRINT_LINE("run %d, with nice long RRLP messages to decode.", z + 1);
-                } else {
+                } else if (z == 1) {
                     U_TEST_PRINT_LINE("run %d, just NMEA.", z + 1);
+                } else {
+                    U_TEST_PRINT_LINE("run %d, just NMEA, zero-copy.", z + 1);
                 }
                 // Allocate memory for all the transparent receivers
                 for (size_t x = 0; x < sizeof(gpMessageReceive) / sizeof(gpMessageReceive[0]); x++) {
@@ -553,23 +833,40 @@ U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgReceiveNonBlocking")
                             pTmp->numDecodedMin = U_GNSS_MSG_TEST_MESSAGE_RECEIVE_NON_BLOCKING_MIN_STEPS;
                         }
                     } else  {
-                        // Just NMEA this time
+                        // Just NMEA this time, zero-copy on the last run
                         pTmp->useNmeaComprehender = true;
+                        pTmp->useSpan = (z == 2);
                     }
                 }
 
+                // Start the transport statistics afresh for this run
+                U_PORT_TEST_ASSERT(uGnssMsgReceiveStatReset(gnssHandle) == 0);
+
                 // Hook them in, passing a pointer to the entry as the callback parameter
                 gCallbackErrorCode = 0;
                 for (size_t x = 0; x < sizeof(gpMessageReceive) / sizeof(gpMessageReceive[0]); x++) {
                     pTmp = gpMessageReceive[x];
-                    pTmp->asyncHandle = uGnssMsgReceiveStart(gnssHandle,
-                                                             &(pTmp->messageId),
-                                                             messageReceiveCallback,
-                                                             (void *) pTmp);
+                    if (pTmp->useSpan) {
+                        pTmp->asyncHandle = uGnssMsgReceiveStartSpan(gnssHandle,
+                                                                     &(pTmp->messageId),
+                                                                     messageReceiveSpanCallback,
+                                                                     (void *) pTmp);
+                    } else {
+                        pTmp->asyncHandle = uGnssMsgReceiveStart(gnssHandle,
+                                                                 &(pTmp->messageId),
+                                                                 messageReceiveCallback,
+                                                                 (void *) pTmp);
+                    }
                     pTmp->moduleType = pModule->moduleType;
                     U_PORT_TEST_ASSERT(pTmp->asyncHandle >= 0);
                 }
 
+                // There should be no room for another
+                U_PORT_TEST_ASSERT(uGnssMsgReceiveStart(gnssHandle,
+                                                        &(gpMessageReceive[0]->messageId),
+                                                        messageReceiveCallback,
+                                                        (void *) gpMessageReceive[0]) < 0);
+
                 // Messages should now start arriving at our callback
                 U_PORT_TEST_ASSERT(uUbxProtocolEncode(0x02, 0x14, NULL, 0, command) == sizeof(command));
                 for (size_t x = 0; x < U_GNSS_MSG_TEST_MESSAGE_RECEIVE_NON_BLOCKING_MIN_STEPS; x++) {
@@ -608,6 +905,7 @@ U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgReceiveNonBlocking")
                 uPortTaskBlock(100);
                 c = uGnssMsgReceiveStatStreamLoss(gnssHandle);
                 d = uGnssMsgReceiveStatReadLoss(gnssHandle);
+                U_PORT_TEST_ASSERT(uGnssMsgReceiveStatGet(gnssHandle, &msgStats) == 0);
 
                 // Print the outcome prettilyish
                 U_TEST_PRINT_LINE("run %d done, results are:", z + 1);
@@ -696,6 +994,22 @@ U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgReceiveNonBlocking")
                     U_TEST_PRINT_LINE("the minimum stack of the callback task  was %d.", a);
                 }
                 U_TEST_PRINT_LINE("the callback error code was %d.", gCallbackErrorCode);
+                U_TEST_PRINT_LINE("%d byte(s) received in %d ms (%d bytes/second), ring buffer"
+                                  " high-water mark %d byte(s).", (int32_t) msgStats.bytesReceived,
+                                  msgStats.periodMs, msgStats.bytesPerSecond,
+                                  (int32_t) msgStats.ringBufferHighWaterMark);
+                for (size_t x = 0; x < sizeof(msgStats.protocol) / sizeof(msgStats.protocol[0]); x++) {
+                    pProtocolName = pGnssTestPrivateProtocolName((uGnssProtocol_t) x);
+                    U_TEST_PRINT_LINE("%d %s message(s) decoded, total decode time %d us, max %d us.",
+                                      (int32_t) msgStats.protocol[x].messageCount,
+                                      pProtocolName != NULL ? pProtocolName : "?",
+                                      (int32_t) msgStats.protocol[x].decodeTimeTotalUs,
+                                      msgStats.protocol[x].decodeTimeMaxUs);
+                }
+                U_TEST_PRINT_LINE("%d callback(s), total time %d us, max %d us, total latency %d us,"
+                                  " max %d us.", (int32_t) msgStats.callbackCount,
+                                  (int32_t) msgStats.callbackTimeTotalUs, msgStats.callbackTimeMaxUs,
+                                  (int32_t) msgStats.latencyTotalUs, msgStats.latencyMaxUs);
 
                 // Now do the asserting
                 U_PORT_TEST_ASSERT(!bad);
@@ -705,6 +1019,11 @@ U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgReceiveNonBlocking")
                 U_PORT_TEST_ASSERT(c == 0);
                 U_PORT_TEST_ASSERT(d == 0);
                 U_PORT_TEST_ASSERT(gCallbackErrorCode == 0);
+                U_PORT_TEST_ASSERT(msgStats.bytesReceived > 0);
+                U_PORT_TEST_ASSERT(msgStats.periodMs > 0);
+                U_PORT_TEST_ASSERT(msgStats.ringBufferHighWaterMark > 0);
+                U_PORT_TEST_ASSERT(msgStats.protocol[U_GNSS_PROTOCOL_NMEA].messageCount > 0);
+                U_PORT_TEST_ASSERT(msgStats.callbackCount > 0);
 
                 // Switch message printing on for this bit
                 uGnssSetUbxMessagePrint(gnssHandle, true);
@@ -773,6 +1092,230 @@ U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgReceiveNonBlocking")
 
 #endif // U_CFG_TEST_USING_NRF5SDK 
 
+/** Record the raw stream from the GNSS chip with a sink that
+ * counts bytes, and start/stop recording repeatedly while message
+ * receive is running, which is when the fill path is busy teeing
+ * data into the recording.
+ */
+U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgRecord")
+{
+    uDeviceHandle_t gnssHandle;
+    int32_t heapUsed;
+    int32_t asyncHandle;
+    uGnssMessageId_t messageId = {0};
+    uGnssRecordStats_t stats;
+    size_t recordBytes;
+    size_t iterations;
+    uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM_WITH_UBX];
+
+    // In case a previous test failed
+    uGnssTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    // Repeat for all transport types except U_GNSS_TRANSPORT_AT,
+    // which the recorder does not support
+    iterations = uGnssTestPrivateTransportTypesSet(transportTypes, U_CFG_APP_GNSS_UART,
+                                                   U_CFG_APP_GNSS_I2C);
+    for (size_t w = 0; w < iterations; w++) {
+        if ((transportTypes[w] == U_GNSS_TRANSPORT_UART) ||
+            (transportTypes[w] == U_GNSS_TRANSPORT_I2C)) {
+            // Do the standard preamble
+            U_TEST_PRINT_LINE("testing on transport %s...",
+                              pGnssTestPrivateTransportTypeName(transportTypes[w]));
+            U_PORT_TEST_ASSERT(uGnssTestPrivatePreamble(U_CFG_TEST_GNSS_MODULE_TYPE,
+                                                        transportTypes[w], &gHandles, true,
+                                                        U_CFG_APP_CELL_PIN_GNSS_POWER,
+                                                        U_CFG_APP_CELL_PIN_GNSS_DATA_READY) == 0);
+            gnssHandle = gHandles.gnssHandle;
+
+            // Make sure NMEA is on, so that there is a stream to record
+            U_PORT_TEST_ASSERT(uGnssCfgSetProtocolOut(gnssHandle, U_GNSS_PROTOCOL_NMEA, true) == 0);
+
+            // Nothing to stop yet
+            U_PORT_TEST_ASSERT(uGnssRecordStop(gnssHandle, NULL) < 0);
+            U_PORT_TEST_ASSERT(uGnssRecordStatsGet(gnssHandle, &stats) < 0);
+
+            // Start a message receiver for all NMEA messages to pull data in
+            gCallbackErrorCode = 0;
+            gRecordNumMessages = 0;
+            messageId.type = U_GNSS_PROTOCOL_NMEA; // pNmea left at NULL is "all"
+            asyncHandle = uGnssMsgReceiveStart(gnssHandle, &messageId,
+                                               recordMessageCallback, NULL);
+            U_PORT_TEST_ASSERT(asyncHandle >= 0);
+
+            U_TEST_PRINT_LINE("recording for a few seconds...");
+            gRecordBytes = 0;
+            U_PORT_TEST_ASSERT(uGnssRecordStart(gnssHandle,
+                                                U_GNSS_MSG_TEST_RECORD_BUFFER_SIZE_BYTES,
+                                                recordSink, (void *) &gRecordBytes) == 0);
+            // Only one recording at a time
+            U_PORT_TEST_ASSERT(uGnssRecordStart(gnssHandle,
+                                                U_GNSS_MSG_TEST_RECORD_BUFFER_SIZE_BYTES,
+                                                recordSink, (void *) &gRecordBytes) < 0);
+            uPortTaskBlock(5000);
+            U_PORT_TEST_ASSERT(uGnssRecordStatsGet(gnssHandle, &stats) == 0);
+            U_TEST_PRINT_LINE("%d byte(s) recorded so far.", (int32_t) stats.bytesRecorded);
+            memset(&stats, 0xff, sizeof(stats));
+            U_PORT_TEST_ASSERT(uGnssRecordStop(gnssHandle, &stats) == 0);
+            recordBytes = gRecordBytes;
+            U_TEST_PRINT_LINE("%d NMEA message(s) received, %d byte(s) recorded,"
+                              " %d byte(s) dropped, %d overrun(s), %d sink error(s).",
+                              (int32_t) gRecordNumMessages, (int32_t) recordBytes,
+                              (int32_t) stats.bytesDropped, (int32_t) stats.numOverruns,
+                              (int32_t) stats.numSinkErrors);
+            U_PORT_TEST_ASSERT(gCallbackErrorCode == 0);
+            U_PORT_TEST_ASSERT(gRecordNumMessages > 0);
+            U_PORT_TEST_ASSERT(recordBytes > 0);
+            U_PORT_TEST_ASSERT(stats.bytesRecorded == (uint32_t) recordBytes);
+            U_PORT_TEST_ASSERT(stats.numSinkErrors == 0);
+            // The sink must not be called once recording has stopped
+            uPortTaskBlock(1000);
+            U_PORT_TEST_ASSERT(gRecordBytes == recordBytes);
+            U_PORT_TEST_ASSERT(uGnssRecordStop(gnssHandle, NULL) < 0);
+
+            U_TEST_PRINT_LINE("starting and stopping recording %d times while"
+                              " message receive is running...",
+                              U_GNSS_MSG_TEST_RECORD_NUM_CYCLES);
+            for (size_t x = 0; x < U_GNSS_MSG_TEST_RECORD_NUM_CYCLES; x++) {
+                U_PORT_TEST_ASSERT(uGnssRecordStart(gnssHandle,
+                                                    U_GNSS_MSG_TEST_RECORD_BUFFER_SIZE_BYTES,
+                                                    recordSink, (void *) &gRecordBytes) == 0);
+                uPortTaskBlock(x * 10);
+                gRecordBytes = 0;
+                U_PORT_TEST_ASSERT(uGnssRecordStop(gnssHandle, &stats) == 0);
+                U_PORT_TEST_ASSERT(gCallbackErrorCode == 0);
+            }
+
+            U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gnssHandle, asyncHandle) == 0);
+
+            // Do the standard postamble
+            uGnssTestPrivatePostamble(&gHandles, true);
+        }
+    }
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+#ifdef U_GNSS_MSG_RECEIVE_TASK_SHARED
+/** Check that, with U_GNSS_MSG_RECEIVE_TASK_SHARED defined, two GNSS
+ * instances join the one message receive task, that each only gets
+ * its own messages, that the task carries on serving one instance
+ * after the other has left and that it can be started again once
+ * the last instance has left.  The instances are on loop-back
+ * virtual serial ports, so no GNSS module is involved.
+ */
+U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgReceiveShared")
+{
+    uGnssTransportHandle_t transportHandle;
+    uGnssMessageId_t messageId = {0};
+    uPortTaskHandle_t taskHandle;
+    int32_t asyncHandle[2];
+    int32_t heapUsed;
+
+    // In case a previous test failed
+    uGnssTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uGnssInit() == 0);
+    gCallbackErrorCode = 0;
+
+    // Add two GNSS instances, each on its own loop-back
+    for (size_t x = 0; x < sizeof(gShared) / sizeof(gShared[0]); x++) {
+        memset(&gShared[x], 0, sizeof(gShared[x]));
+        gShared[x].virtualSerial.pGetReceiveSize = sharedGetReceiveSize;
+        gShared[x].virtualSerial.pRead = sharedRead;
+        gShared[x].virtualSerial.pWrite = sharedWrite;
+        gShared[x].virtualSerial.pContext = (void *) &gShared[x];
+        // UBX-MON-VER for one, UBX-MON-HW for the other
+        gShared[x].classAndId = (x == 0) ? 0x0a04 : 0x0a09;
+        transportHandle.pVirtualSerial = &gShared[x].virtualSerial;
+        U_PORT_TEST_ASSERT(uGnssAdd(U_CFG_TEST_GNSS_MODULE_TYPE,
+                                    U_GNSS_TRANSPORT_VIRTUAL_SERIAL,
+                                    transportHandle, -1, true,
+                                    &gShared[x].gnssHandle) == 0);
+    }
+
+    U_TEST_PRINT_LINE("both instances join the shared task...");
+    messageId.type = U_GNSS_PROTOCOL_UBX;
+    for (size_t x = 0; x < sizeof(gShared) / sizeof(gShared[0]); x++) {
+        messageId.id.ubx = gShared[x].classAndId;
+        asyncHandle[x] = uGnssMsgReceiveStart(gShared[x].gnssHandle, &messageId,
+                                              sharedMessageCallback,
+                                              (void *) &gShared[x]);
+        U_PORT_TEST_ASSERT(asyncHandle[x] >= 0);
+    }
+    taskHandle = sharedTaskHandle(gShared[0].gnssHandle);
+    U_PORT_TEST_ASSERT(taskHandle != NULL);
+    U_PORT_TEST_ASSERT(sharedTaskHandle(gShared[1].gnssHandle) == taskHandle);
+    sharedSend(&gShared[0]);
+    sharedSend(&gShared[1]);
+    U_PORT_TEST_ASSERT(sharedWait(1, 1));
+    U_PORT_TEST_ASSERT(gCallbackErrorCode == 0);
+
+    U_TEST_PRINT_LINE("instance 0 leaves, instance 1 should carry on...");
+    U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gShared[0].gnssHandle, asyncHandle[0]) == 0);
+    U_PORT_TEST_ASSERT(sharedTaskHandle(gShared[0].gnssHandle) == NULL);
+    U_PORT_TEST_ASSERT(sharedTaskHandle(gShared[1].gnssHandle) == taskHandle);
+    // The message for instance 0 stays in its loop-back
+    sharedSend(&gShared[0]);
+    sharedSend(&gShared[1]);
+    U_PORT_TEST_ASSERT(sharedWait(1, 2));
+    U_PORT_TEST_ASSERT(gCallbackErrorCode == 0);
+
+    U_TEST_PRINT_LINE("instance 0 joins the running task again...");
+    messageId.id.ubx = gShared[0].classAndId;
+    asyncHandle[0] = uGnssMsgReceiveStart(gShared[0].gnssHandle, &messageId,
+                                          sharedMessageCallback,
+                                          (void *) &gShared[0]);
+    U_PORT_TEST_ASSERT(asyncHandle[0] >= 0);
+    U_PORT_TEST_ASSERT(sharedTaskHandle(gShared[0].gnssHandle) == taskHandle);
+    // Now the message waiting in the loop-back of instance 0 arrives
+    U_PORT_TEST_ASSERT(sharedWait(2, 2));
+    U_PORT_TEST_ASSERT(gCallbackErrorCode == 0);
+
+    U_TEST_PRINT_LINE("both instances leave, stopping the shared task...");
+    for (size_t x = 0; x < sizeof(gShared) / sizeof(gShared[0]); x++) {
+        U_PORT_TEST_ASSERT(uGnssMsgReceiveStopAll(gShared[x].gnssHandle) == 0);
+        U_PORT_TEST_ASSERT(sharedTaskHandle(gShared[x].gnssHandle) == NULL);
+    }
+
+    U_TEST_PRINT_LINE("instance 1 starts the shared task afresh...");
+    messageId.id.ubx = gShared[1].classAndId;
+    asyncHandle[1] = uGnssMsgReceiveStart(gShared[1].gnssHandle, &messageId,
+                                          sharedMessageCallback,
+                                          (void *) &gShared[1]);
+    U_PORT_TEST_ASSERT(asyncHandle[1] >= 0);
+    U_PORT_TEST_ASSERT(sharedTaskHandle(gShared[1].gnssHandle) != NULL);
+    sharedSend(&gShared[1]);
+    U_PORT_TEST_ASSERT(sharedWait(2, 3));
+    U_PORT_TEST_ASSERT(gCallbackErrorCode == 0);
+    U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gShared[1].gnssHandle, asyncHandle[1]) == 0);
+
+    for (size_t x = 0; x < sizeof(gShared) / sizeof(gShared[0]); x++) {
+        uGnssRemove(gShared[x].gnssHandle);
+        gShared[x].gnssHandle = NULL;
+    }
+    uGnssDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+#endif // #ifdef U_GNSS_MSG_RECEIVE_TASK_SHARED
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
@@ -88,6 +88,19 @@
 #define U_GNSS_POS_TEST_TIMEOUT_SECONDS 180
 #endif
 
+#ifndef U_GNSS_POS_TEST_STREAMED_RATE_MS
+/** The measurement period to use when testing streamed position.
+ */
+#define U_GNSS_POS_TEST_STREAMED_RATE_MS 250
+#endif
+
+#ifndef U_GNSS_POS_TEST_STREAMED_MIN_COUNT
+/** The minimum number of streamed positions to wait for, after a
+ * fix has been achieved, when testing streamed position.
+ */
+#define U_GNSS_POS_TEST_STREAMED_MIN_COUNT 10
+#endif
+
 #ifndef U_GNSS_POS_RRLP_SIZE_BYTES
 /** The number of bytes of buffer to allow for storing the RRLP
  * information.
@@ -171,6 +184,16 @@ static int32_t gSvs = 0;
  */
 static int64_t gTimeUtc = LONG_MIN;
 
+/** Count of the number of times posStreamedCallback() has been
+ * called.
+ */
+static volatile int32_t gStreamedCount = 0;
+
+/** Count of the number of times posStreamedCallback() has been
+ * called with a valid fix.
+ */
+static volatile int32_t gStreamedFixCount = 0;
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -210,6 +233,26 @@ static void posCallback(uDeviceHandle_t gnssHandle,
     gTimeUtc = timeUtc;
 }
 
+// Callback function for the streamed position API.
+static void posStreamedCallback(uDeviceHandle_t gnssHandle,
+                                int32_t errorCode,
+                                int32_t latitudeX1e7,
+                                int32_t longitudeX1e7,
+                                int32_t altitudeMillimetres,
+                                int32_t radiusMillimetres,
+                                int32_t speedMillimetresPerSecond,
+                                int32_t svs,
+                                int64_t timeUtc)
+{
+    posCallback(gnssHandle, errorCode, latitudeX1e7, longitudeX1e7,
+                altitudeMillimetres, radiusMillimetres,
+                speedMillimetresPerSecond, svs, timeUtc);
+    gStreamedCount++;
+    if (errorCode == 0) {
+        gStreamedFixCount++;
+    }
+}
+
 // Convert a lat/long into a whole number and a
 // bit-after-the-decimal-point that can be printed
 // without having to invoke floating point operations,
@@ -400,6 +443,109 @@ U_PORT_TEST_FUNCTION("[gnssPos]", "gnssPosPos")
     U_PORT_TEST_ASSERT(heapUsed <= 0);
 }
 
+/** Test streamed position.
+ */
+U_PORT_TEST_FUNCTION("[gnssPos]", "gnssPosStreamed")
+{
+    uDeviceHandle_t gnssHandle;
+    const uGnssPrivateModule_t *pModule;
+    int32_t y;
+    int64_t startTime;
+    int32_t heapUsed;
+    size_t iterations;
+    uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM_WITH_UBX];
+
+    // In case a previous test failed
+    uGnssTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    // Repeat for all transport types
+    iterations = uGnssTestPrivateTransportTypesSet(transportTypes, U_CFG_APP_GNSS_UART,
+                                                   U_CFG_APP_GNSS_I2C);
+    for (size_t x = 0; x < iterations; x++) {
+        // Do the standard preamble
+        U_TEST_PRINT_LINE("testing streamed position on transport %s...",
+                          pGnssTestPrivateTransportTypeName(transportTypes[x]));
+        U_PORT_TEST_ASSERT(uGnssTestPrivatePreamble(U_CFG_TEST_GNSS_MODULE_TYPE,
+                                                    transportTypes[x], &gHandles, true,
+                                                    U_CFG_APP_CELL_PIN_GNSS_POWER,
+                                                    U_CFG_APP_CELL_PIN_GNSS_DATA_READY) == 0);
+        gnssHandle = gHandles.gnssHandle;
+
+        pModule = pUGnssPrivateGetModule(gnssHandle);
+        U_PORT_TEST_ASSERT(pModule != NULL);
+
+        // Check parameters
+        U_PORT_TEST_ASSERT(uGnssPosGetStreamedStart(gnssHandle, 0,
+                                                    posStreamedCallback) < 0);
+        U_PORT_TEST_ASSERT(uGnssPosGetStreamedStart(gnssHandle,
+                                                    U_GNSS_POS_TEST_STREAMED_RATE_MS,
+                                                    NULL) < 0);
+
+        if ((transportTypes[x] == U_GNSS_TRANSPORT_AT) ||
+            !U_GNSS_PRIVATE_HAS(pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
+            U_TEST_PRINT_LINE("streamed position is not supported here.");
+            U_PORT_TEST_ASSERT(uGnssPosGetStreamedStart(gnssHandle,
+                                                        U_GNSS_POS_TEST_STREAMED_RATE_MS,
+                                                        posStreamedCallback) ==
+                               (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
+        } else {
+            gStreamedCount = 0;
+            gStreamedFixCount = 0;
+            gErrorCode = 0xFFFFFFFF;
+            startTime = uPortGetTickTimeMs();
+            gStopTimeMs = startTime + U_GNSS_POS_TEST_TIMEOUT_SECONDS * 1000;
+            U_PORT_TEST_ASSERT(uGnssPosGetStreamedStart(gnssHandle,
+                                                        U_GNSS_POS_TEST_STREAMED_RATE_MS,
+                                                        posStreamedCallback) == 0);
+            // Can't start a second one
+            U_PORT_TEST_ASSERT(uGnssPosGetStreamedStart(gnssHandle,
+                                                        U_GNSS_POS_TEST_STREAMED_RATE_MS,
+                                                        posStreamedCallback) < 0);
+            U_TEST_PRINT_LINE("waiting up to %d second(s) for %d streamed fixes...",
+                              U_GNSS_POS_TEST_TIMEOUT_SECONDS,
+                              U_GNSS_POS_TEST_STREAMED_MIN_COUNT);
+            while ((gStreamedFixCount < U_GNSS_POS_TEST_STREAMED_MIN_COUNT) &&
+                   (uPortGetTickTimeMs() < gStopTimeMs)) {
+                uPortTaskBlock(100);
+            }
+            y = (int32_t) (uPortGetTickTimeMs() - startTime);
+            uGnssPosGetStreamedStop(gnssHandle);
+            U_TEST_PRINT_LINE("%d streamed position(s), %d with a fix, in %d ms.",
+                              gStreamedCount, gStreamedFixCount, y);
+            U_PORT_TEST_ASSERT(gGnssHandle == gnssHandle);
+            U_PORT_TEST_ASSERT(gStreamedFixCount >= U_GNSS_POS_TEST_STREAMED_MIN_COUNT);
+            U_PORT_TEST_ASSERT(gErrorCode == 0);
+            U_PORT_TEST_ASSERT(gLatitudeX1e7 > INT_MIN);
+            U_PORT_TEST_ASSERT(gLongitudeX1e7 > INT_MIN);
+            U_PORT_TEST_ASSERT(gTimeUtc > 0);
+
+            // Make sure that the callback is no longer called
+            y = gStreamedCount;
+            uPortTaskBlock(U_GNSS_POS_TEST_STREAMED_RATE_MS * 4);
+            U_PORT_TEST_ASSERT(gStreamedCount == y);
+
+            // Check that we haven't dropped any incoming data
+            y = uGnssMsgReceiveStatStreamLoss(gnssHandle);
+            U_TEST_PRINT_LINE("%d byte(s) lost at the input to the ring-buffer during that test.", y);
+            U_PORT_TEST_ASSERT(y == 0);
+        }
+
+        // Do the standard postamble, leaving the module on for the next
+        // test to speed things up
+        uGnssTestPrivatePostamble(&gHandles, false);
+    }
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
 /** Test retrieving RRLP information.
  */
 U_PORT_TEST_FUNCTION("[gnssPos]", "gnssPosRrlp")
@@ -61,6 +61,9 @@
 #include "u_gnss_type.h"
 #include "u_gnss.h"
 #include "u_gnss_private.h"
+#include "u_gnss_msg_ubx.h"
+#include "u_gnss_msg_nmea.h"
+#include "u_gnss_time.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -912,6 +915,437 @@ U_PORT_TEST_FUNCTION("[gnss]", "gnssPrivateUbx")
 
 #endif // #ifndef __ZEPHYR__
 
+/** Test the configuration cache functions; this needs no GNSS chip.
+ */
+U_PORT_TEST_FUNCTION("[gnss]", "gnssPrivateCfgCache")
+{
+    uGnssPrivateInstance_t instance;
+    uGnssPrivateCfgCache_t cfgCache;
+    uGnssPrivateCfgCacheEntry_t entry[4];
+    uint64_t value = 0;
+
+    memset(&instance, 0, sizeof(instance));
+    memset(&cfgCache, 0, sizeof(cfgCache));
+
+    // With no cache nothing should be found or counted
+    uGnssPrivateCfgCacheSet(&instance, 1, 1);
+    U_PORT_TEST_ASSERT(!uGnssPrivateCfgCacheGet(&instance, 1, &value));
+    uGnssPrivateCfgCacheDelete(&instance, 1);
+    uGnssPrivateCfgCacheInvalidate(&instance);
+
+    cfgCache.pEntry = entry;
+    cfgCache.maxNumEntries = sizeof(entry) / sizeof(entry[0]);
+    cfgCache.protocolOut = -1;
+    instance.pCfgCache = &cfgCache;
+
+    // Fill the cache up
+    U_PORT_TEST_ASSERT(!uGnssPrivateCfgCacheGet(&instance, 1, &value));
+    for (size_t x = 0; x < sizeof(entry) / sizeof(entry[0]); x++) {
+        uGnssPrivateCfgCacheSet(&instance, (uint32_t) x + 1, x + 100);
+    }
+    for (size_t x = 0; x < sizeof(entry) / sizeof(entry[0]); x++) {
+        U_PORT_TEST_ASSERT(uGnssPrivateCfgCacheGet(&instance, (uint32_t) x + 1, &value));
+        U_PORT_TEST_ASSERT(value == x + 100);
+    }
+    U_PORT_TEST_ASSERT(cfgCache.hits == sizeof(entry) / sizeof(entry[0]));
+    U_PORT_TEST_ASSERT(cfgCache.misses == 1);
+
+    // Replacing a value should not take a new entry
+    uGnssPrivateCfgCacheSet(&instance, 2, 200);
+    U_PORT_TEST_ASSERT(cfgCache.numEntries == sizeof(entry) / sizeof(entry[0]));
+    U_PORT_TEST_ASSERT(uGnssPrivateCfgCacheGet(&instance, 2, &value));
+    U_PORT_TEST_ASSERT(value == 200);
+
+    // Adding a new key when full should replace the oldest entry
+    uGnssPrivateCfgCacheSet(&instance, 5, 500);
+    U_PORT_TEST_ASSERT(!uGnssPrivateCfgCacheGet(&instance, 1, &value));
+    U_PORT_TEST_ASSERT(uGnssPrivateCfgCacheGet(&instance, 5, &value));
+    U_PORT_TEST_ASSERT(value == 500);
+    U_PORT_TEST_ASSERT(uGnssPrivateCfgCacheGet(&instance, 2, &value));
+
+    // Delete one
+    uGnssPrivateCfgCacheDelete(&instance, 3);
+    U_PORT_TEST_ASSERT(cfgCache.numEntries == sizeof(entry) / sizeof(entry[0]) - 1);
+    U_PORT_TEST_ASSERT(!uGnssPrivateCfgCacheGet(&instance, 3, &value));
+    U_PORT_TEST_ASSERT(uGnssPrivateCfgCacheGet(&instance, 4, &value));
+    U_PORT_TEST_ASSERT(value == 103);
+    U_PORT_TEST_ASSERT(uGnssPrivateCfgCacheGet(&instance, 5, &value));
+    uGnssPrivateCfgCacheSet(&instance, 6, 600);
+    U_PORT_TEST_ASSERT(cfgCache.numEntries == sizeof(entry) / sizeof(entry[0]));
+    U_PORT_TEST_ASSERT(uGnssPrivateCfgCacheGet(&instance, 6, &value));
+    U_PORT_TEST_ASSERT(value == 600);
+
+    // Invalidate the lot
+    cfgCache.protocolOut = 1;
+    uGnssPrivateCfgCacheInvalidate(&instance);
+    U_PORT_TEST_ASSERT(cfgCache.numEntries == 0);
+    U_PORT_TEST_ASSERT(cfgCache.protocolOut < 0);
+    for (size_t x = 0; x < 6; x++) {
+        U_PORT_TEST_ASSERT(!uGnssPrivateCfgCacheGet(&instance, (uint32_t) x + 1, &value));
+    }
+}
+
+/** Test the in-place UBX message decode macros/functions; this
+ * needs no GNSS chip.
+ */
+U_PORT_TEST_FUNCTION("[gnss]", "gnssPrivateMsgUbx")
+{
+    // NAV-PVT is the largest body used here
+    char body[U_GNSS_MSG_UBX_NAV_PVT_BODY_LENGTH_BYTES];
+    char message[U_GNSS_MSG_UBX_NAV_PVT_BODY_LENGTH_BYTES + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+    const uGnssMsgUbxNavPvt_t *pNavPvt;
+    const uGnssMsgUbxNavSat_t *pNavSat;
+    const uGnssMsgUbxNavSatSv_t *pNavSatSv;
+    int32_t size;
+
+    // The structures must match the wire lengths exactly
+    U_PORT_TEST_ASSERT(sizeof(uGnssMsgUbxNavStatus_t) == U_GNSS_MSG_UBX_NAV_STATUS_BODY_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(sizeof(uGnssMsgUbxNavPvt_t) == U_GNSS_MSG_UBX_NAV_PVT_BODY_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(sizeof(uGnssMsgUbxNavSat_t) == U_GNSS_MSG_UBX_NAV_SAT_BODY_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(sizeof(uGnssMsgUbxNavSatSv_t) == U_GNSS_MSG_UBX_NAV_SAT_SV_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(sizeof(uGnssMsgUbxRxmRawx_t) == U_GNSS_MSG_UBX_RXM_RAWX_BODY_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(sizeof(uGnssMsgUbxRxmRawxMeas_t) == U_GNSS_MSG_UBX_RXM_RAWX_MEAS_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(sizeof(uGnssMsgUbxMonHw_t) == U_GNSS_MSG_UBX_MON_HW_BODY_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(sizeof(uGnssMsgUbxTimTp_t) == U_GNSS_MSG_UBX_TIM_TP_BODY_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(sizeof(uGnssMsgUbxTimTm2_t) == U_GNSS_MSG_UBX_TIM_TM2_BODY_LENGTH_BYTES);
+
+    // Make a NAV-PVT with a few known fields: numSV at offset 23,
+    // lat (little-endian) at offset 28 and magAcc at offset 90
+    memset(body, 0, sizeof(body));
+    body[23] = 12;
+    body[28] = 0x78;
+    body[29] = 0x56;
+    body[30] = 0x34;
+    body[31] = (char) 0xf2;
+    body[90] = 0x34;
+    body[91] = 0x12;
+    size = uUbxProtocolEncode(0x01, 0x07, body, U_GNSS_MSG_UBX_NAV_PVT_BODY_LENGTH_BYTES, message);
+    U_PORT_TEST_ASSERT(size == U_GNSS_MSG_UBX_NAV_PVT_BODY_LENGTH_BYTES + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+    pNavPvt = pUGnssMsgUbxNavPvt(message, size);
+    U_PORT_TEST_ASSERT(pNavPvt == (const uGnssMsgUbxNavPvt_t *) (message + U_GNSS_MSG_UBX_HEADER_LENGTH_BYTES));
+    U_PORT_TEST_ASSERT(pNavPvt->numSV == 12);
+    U_PORT_TEST_ASSERT(pNavPvt->lat == (int32_t) 0xf2345678);
+    U_PORT_TEST_ASSERT(pNavPvt->magAcc == 0x1234);
+    // Wrong message, truncated message, no message
+    U_PORT_TEST_ASSERT(pUGnssMsgUbxNavStatus(message, size) == NULL);
+    U_PORT_TEST_ASSERT(pUGnssMsgUbxNavPvt(message, size - 3) == NULL);
+    U_PORT_TEST_ASSERT(pUGnssMsgUbxNavPvt(NULL, size) == NULL);
+    // Body too short for the structure
+    size = uUbxProtocolEncode(0x01, 0x07, body, U_GNSS_MSG_UBX_NAV_PVT_BODY_LENGTH_BYTES - 1, message);
+    U_PORT_TEST_ASSERT(pUGnssMsgUbxNavPvt(message, size) == NULL);
+
+    // Make a NAV-SAT with two repeated blocks, the second
+    // with azim (little-endian) at offset 4 into the block
+    memset(body, 0, sizeof(body));
+    body[5] = 2;
+    body[U_GNSS_MSG_UBX_NAV_SAT_BODY_LENGTH_BYTES + 1] = 3;
+    body[U_GNSS_MSG_UBX_NAV_SAT_BODY_LENGTH_BYTES + U_GNSS_MSG_UBX_NAV_SAT_SV_LENGTH_BYTES + 1] = 4;
+    body[U_GNSS_MSG_UBX_NAV_SAT_BODY_LENGTH_BYTES + U_GNSS_MSG_UBX_NAV_SAT_SV_LENGTH_BYTES + 4] = 0x0e;
+    body[U_GNSS_MSG_UBX_NAV_SAT_BODY_LENGTH_BYTES + U_GNSS_MSG_UBX_NAV_SAT_SV_LENGTH_BYTES + 5] = 0x01;
+    size = uUbxProtocolEncode(0x01, 0x35, body,
+                              U_GNSS_MSG_UBX_NAV_SAT_BODY_LENGTH_BYTES +
+                              (U_GNSS_MSG_UBX_NAV_SAT_SV_LENGTH_BYTES * 2),
+                              message);
+    pNavSat = pUGnssMsgUbxNavSat(message, size);
+    U_PORT_TEST_ASSERT(pNavSat != NULL);
+    U_PORT_TEST_ASSERT(pNavSat->numSvs == 2);
+    pNavSatSv = pUGnssMsgUbxNavSatSv(message, size, 0);
+    U_PORT_TEST_ASSERT(pNavSatSv != NULL);
+    U_PORT_TEST_ASSERT(pNavSatSv->svId == 3);
+    pNavSatSv = pUGnssMsgUbxNavSatSv(message, size, 1);
+    U_PORT_TEST_ASSERT(pNavSatSv != NULL);
+    U_PORT_TEST_ASSERT(pNavSatSv->svId == 4);
+    U_PORT_TEST_ASSERT(pNavSatSv->azim == 270);
+    U_PORT_TEST_ASSERT(pUGnssMsgUbxNavSatSv(message, size, 2) == NULL);
+    U_PORT_TEST_ASSERT(pUGnssMsgUbxNavSatSv(message, size, SIZE_MAX) == NULL);
+}
+
+/** Test the decoding of UBX-NAV-GEOFENCE and the detection of
+ * a change of geofence state; this needs no GNSS chip.
+ */
+U_PORT_TEST_FUNCTION("[gnss]", "gnssPrivateGeofence")
+{
+    char body[U_GNSS_MSG_UBX_NAV_GEOFENCE_BODY_LENGTH_BYTES +
+              (U_GNSS_MSG_UBX_NAV_GEOFENCE_FENCE_LENGTH_BYTES * U_GNSS_GEOFENCE_MAX_NUM)];
+    char message[sizeof(body) + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+    char *pFence = body + U_GNSS_MSG_UBX_NAV_GEOFENCE_BODY_LENGTH_BYTES;
+    uGnssGeofenceState_t combinedState = U_GNSS_GEOFENCE_STATE_UNKNOWN;
+    uGnssGeofenceState_t state[U_GNSS_GEOFENCE_MAX_NUM + 1];
+    int32_t size;
+
+    U_PORT_TEST_ASSERT(sizeof(uGnssMsgUbxNavGeofence_t) ==
+                       U_GNSS_MSG_UBX_NAV_GEOFENCE_BODY_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(sizeof(uGnssMsgUbxNavGeofenceFence_t) ==
+                       U_GNSS_MSG_UBX_NAV_GEOFENCE_FENCE_LENGTH_BYTES);
+    for (size_t x = 0; x < sizeof(state) / sizeof(state[0]); x++) {
+        state[x] = U_GNSS_GEOFENCE_STATE_UNKNOWN;
+    }
+
+    // A UBX-NAV-GEOFENCE with two fences, the first inside
+    // (state 1), the second outside (state 2), combined inside;
+    // status at offset 5, numFences at offset 6, combState at
+    // offset 7
+    memset(body, 0, sizeof(body));
+    body[5] = 1;
+    body[6] = 2;
+    body[7] = 1;
+    pFence[0] = 1;
+    pFence[U_GNSS_MSG_UBX_NAV_GEOFENCE_FENCE_LENGTH_BYTES] = 2;
+    size = uUbxProtocolEncode(0x01, 0x39, body,
+                              U_GNSS_MSG_UBX_NAV_GEOFENCE_BODY_LENGTH_BYTES +
+                              (U_GNSS_MSG_UBX_NAV_GEOFENCE_FENCE_LENGTH_BYTES * 2),
+                              message);
+    U_PORT_TEST_ASSERT(size > 0);
+    U_PORT_TEST_ASSERT(uGnssPrivateGeofenceUpdate(message, size, 2,
+                                                  &combinedState, state) == 1);
+    U_PORT_TEST_ASSERT(combinedState == U_GNSS_GEOFENCE_STATE_INSIDE);
+    U_PORT_TEST_ASSERT(state[0] == U_GNSS_GEOFENCE_STATE_INSIDE);
+    U_PORT_TEST_ASSERT(state[1] == U_GNSS_GEOFENCE_STATE_OUTSIDE);
+    // The same again is not a change
+    U_PORT_TEST_ASSERT(uGnssPrivateGeofenceUpdate(message, size, 2,
+                                                  &combinedState, state) == 0);
+    // A change of only the second fence is a change
+    pFence[U_GNSS_MSG_UBX_NAV_GEOFENCE_FENCE_LENGTH_BYTES] = 1;
+    size = uUbxProtocolEncode(0x01, 0x39, body,
+                              U_GNSS_MSG_UBX_NAV_GEOFENCE_BODY_LENGTH_BYTES +
+                              (U_GNSS_MSG_UBX_NAV_GEOFENCE_FENCE_LENGTH_BYTES * 2),
+                              message);
+    U_PORT_TEST_ASSERT(uGnssPrivateGeofenceUpdate(message, size, 2,
+                                                  &combinedState, state) == 1);
+    U_PORT_TEST_ASSERT(combinedState == U_GNSS_GEOFENCE_STATE_INSIDE);
+    U_PORT_TEST_ASSERT(state[0] == U_GNSS_GEOFENCE_STATE_INSIDE);
+    U_PORT_TEST_ASSERT(state[1] == U_GNSS_GEOFENCE_STATE_INSIDE);
+    // A change of only the combined state is a change, and a
+    // state value that is not known is taken as unknown
+    body[7] = 2;
+    pFence[0] = 7;
+    size = uUbxProtocolEncode(0x01, 0x39, body,
+                              U_GNSS_MSG_UBX_NAV_GEOFENCE_BODY_LENGTH_BYTES +
+                              (U_GNSS_MSG_UBX_NAV_GEOFENCE_FENCE_LENGTH_BYTES * 2),
+                              message);
+    U_PORT_TEST_ASSERT(uGnssPrivateGeofenceUpdate(message, size, 2,
+                                                  &combinedState, state) == 1);
+    U_PORT_TEST_ASSERT(combinedState == U_GNSS_GEOFENCE_STATE_OUTSIDE);
+    U_PORT_TEST_ASSERT(state[0] == U_GNSS_GEOFENCE_STATE_UNKNOWN);
+    U_PORT_TEST_ASSERT(state[1] == U_GNSS_GEOFENCE_STATE_INSIDE);
+    // Fences that we didn't ask for are ignored and a message with
+    // fewer fences than we asked for leaves the others alone
+    U_PORT_TEST_ASSERT(uGnssPrivateGeofenceUpdate(message, size, 1,
+                                                  &combinedState, state) == 0);
+    U_PORT_TEST_ASSERT(uGnssPrivateGeofenceUpdate(message, size, 3,
+                                                  &combinedState, state) == 0);
+    U_PORT_TEST_ASSERT(state[2] == U_GNSS_GEOFENCE_STATE_UNKNOWN);
+    // Geofencing not active (status 0) is ignored
+    body[5] = 0;
+    body[7] = 1;
+    size = uUbxProtocolEncode(0x01, 0x39, body,
+                              U_GNSS_MSG_UBX_NAV_GEOFENCE_BODY_LENGTH_BYTES +
+                              (U_GNSS_MSG_UBX_NAV_GEOFENCE_FENCE_LENGTH_BYTES * 2),
+                              message);
+    U_PORT_TEST_ASSERT(uGnssPrivateGeofenceUpdate(message, size, 2,
+                                                  &combinedState, state) < 0);
+    U_PORT_TEST_ASSERT(combinedState == U_GNSS_GEOFENCE_STATE_OUTSIDE);
+    // Wrong message, truncated message, no message
+    body[5] = 1;
+    size = uUbxProtocolEncode(0x01, 0x07, body,
+                              U_GNSS_MSG_UBX_NAV_GEOFENCE_BODY_LENGTH_BYTES, message);
+    U_PORT_TEST_ASSERT(uGnssPrivateGeofenceUpdate(message, size, 2,
+                                                  &combinedState, state) < 0);
+    size = uUbxProtocolEncode(0x01, 0x39, body,
+                              U_GNSS_MSG_UBX_NAV_GEOFENCE_BODY_LENGTH_BYTES, message);
+    U_PORT_TEST_ASSERT(uGnssPrivateGeofenceUpdate(message, size - 1, 2,
+                                                  &combinedState, state) < 0);
+    U_PORT_TEST_ASSERT(uGnssPrivateGeofenceUpdate(NULL, size, 2,
+                                                  &combinedState, state) < 0);
+    U_PORT_TEST_ASSERT(combinedState == U_GNSS_GEOFENCE_STATE_OUTSIDE);
+}
+
+/** Test the field-indexed NMEA sentence functions; this needs no
+ * GNSS chip.
+ */
+U_PORT_TEST_FUNCTION("[gnss]", "gnssPrivateMsgNmea")
+{
+    const char *pGga = "$GPGGA,092725.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,*5B\r\n";
+    const char *pRmc = "$GNRMC,083559.00,A,4717.11437,N,00833.91522,W,0.004,77.52,091202,,,R,V*32";
+    const char *pGns = "$GNGNS,103600.01,5114.51176,S,00012.29380,W,ANNN,07,1.18,111.5,45.6,,,V*1D";
+    const char *pGgaNoFix = "$GPGGA,,,,,,0,00,99.99,,,,,,*48";
+    uGnssMsgNmea_t nmea;
+    uRingBufferSpan_t span[2];
+    char buffer[16];
+    const char *pField = NULL;
+    int32_t value;
+
+    // A GGA sentence, including a CR/LF at the end, in one buffer
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaIndex(pGga, strlen(pGga), &nmea) == 15);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaIsType(&nmea, "GGA"));
+    U_PORT_TEST_ASSERT(!uGnssMsgNmeaIsType(&nmea, "RMC"));
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaField(&nmea, 1, &pField) == 9);
+    U_PORT_TEST_ASSERT(pField == pGga + 7);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaField(&nmea, 14, &pField) == 0);
+    U_PORT_TEST_ASSERT(*pField == '*');
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaField(&nmea, 15, &pField) < 0);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaFieldCopy(&nmea, 9, buffer, sizeof(buffer)) == 5);
+    U_PORT_TEST_ASSERT(strcmp(buffer, "499.6") == 0);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaFieldCopy(&nmea, 9, buffer, 5) == (int32_t) U_ERROR_COMMON_NO_MEMORY);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaGetInt(&nmea, 7, &value) == 0);
+    U_PORT_TEST_ASSERT(value == 8);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaGetInt(&nmea, 13, &value) == (int32_t) U_ERROR_COMMON_NOT_FOUND);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaGetTimeOfDayMs(&nmea, 1, &value) == 0);
+    U_PORT_TEST_ASSERT(value == 34045000);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaGetLatLong(&nmea, 2, &value) == 0);
+    U_PORT_TEST_ASSERT(value == 472852332);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaGetLatLong(&nmea, 4, &value) == 0);
+    U_PORT_TEST_ASSERT(value == 85652650);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaGetLatLong(&nmea, 1, &value) < 0);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaGetFixQuality(&nmea) == (int32_t) U_GNSS_MSG_NMEA_FIX_QUALITY_AUTONOMOUS);
+
+    // Bad checksum, truncated, not NMEA
+    memcpy(buffer, "$GPTXT,A*00", 12);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaIndex(buffer, strlen(buffer), &nmea) == (int32_t) U_GNSS_ERROR_CRC);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaField(&nmea, 0, &pField) < 0);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaIndex(pGga, 20, &nmea) == (int32_t) U_ERROR_COMMON_INVALID_PARAMETER);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaIndex(pGga + 1, strlen(pGga) - 1,
+                                         &nmea) == (int32_t) U_ERROR_COMMON_INVALID_PARAMETER);
+
+    // The same GGA sentence split across two spans, as it would be
+    // passed to a uGnssMsgReceiveSpanCallback_t, such that the
+    // latitude straddles the two
+    span[0].pData = pGga;
+    span[0].length = 20;
+    span[1].pData = pGga + 20;
+    span[1].length = strlen(pGga) - 20;
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaIndexSpan(span, &nmea) == 15);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaField(&nmea, 1, &pField) == 9);
+    U_PORT_TEST_ASSERT(pField == pGga + 7);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaField(&nmea, 2,
+                                         &pField) == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaField(&nmea, 3, &pField) == 1);
+    U_PORT_TEST_ASSERT(pField == pGga + 28);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaFieldCopy(&nmea, 2, buffer, sizeof(buffer)) == 10);
+    U_PORT_TEST_ASSERT(strcmp(buffer, "4717.11399") == 0);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaGetLatLong(&nmea, 2, &value) == 0);
+    U_PORT_TEST_ASSERT(value == 472852332);
+
+    // RMC and GNS: position mode indicators, southern/western hemispheres
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaIndex(pRmc, strlen(pRmc), &nmea) == 14);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaIsType(&nmea, "RMC"));
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaGetFixQuality(&nmea) == (int32_t) U_GNSS_MSG_NMEA_FIX_QUALITY_RTK_FIXED);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaGetLatLong(&nmea, 5, &value) == 0);
+    U_PORT_TEST_ASSERT(value < 0);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaIndex(pGns, strlen(pGns), &nmea) == 14);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaGetFixQuality(&nmea) == (int32_t) U_GNSS_MSG_NMEA_FIX_QUALITY_AUTONOMOUS);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaGetLatLong(&nmea, 2, &value) == 0);
+    U_PORT_TEST_ASSERT(value == -512418627);
+
+    // GGA with no fix: fields are empty
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaIndex(pGgaNoFix, strlen(pGgaNoFix), &nmea) == 15);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaGetFixQuality(&nmea) == (int32_t) U_GNSS_MSG_NMEA_FIX_QUALITY_NONE);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaGetLatLong(&nmea, 2, &value) == (int32_t) U_ERROR_COMMON_NOT_FOUND);
+    U_PORT_TEST_ASSERT(uGnssMsgNmeaGetTimeOfDayMs(&nmea, 1, &value) == (int32_t) U_ERROR_COMMON_NOT_FOUND);
+}
+
+/** Test the correlation of timepulse and time mark edges with
+ * UBX-TIM-TP and UBX-TIM-TM2 messages; this needs no GNSS chip.
+ */
+U_PORT_TEST_FUNCTION("[gnss]", "gnssPrivateTimeSync")
+{
+    uGnssTimeSync_t sync;
+    uGnssTimeSyncSample_t sample;
+    uGnssMsgUbxTimTp_t timTp;
+    uGnssMsgUbxTimTm2_t timTm2;
+    char message[U_GNSS_MSG_UBX_TIM_TM2_BODY_LENGTH_BYTES + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+    int32_t size;
+    int64_t gnssTimeNs;
+
+    // Critical sections are used, hence the port must be initialised
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    memset(&sync, 0, sizeof(sync));
+    sync.markCount = -1;
+    U_PORT_TEST_ASSERT(uGnssTimeSyncGet(&sync, &sample) == (int32_t) U_ERROR_COMMON_NOT_FOUND);
+
+    // A UBX-TIM-TP describes the NEXT pulse, so nothing from the first;
+    // 1000.5 ms into week 2200 and a quantisation error of 1.4 ns
+    memset(&timTp, 0, sizeof(timTp));
+    timTp.week = 2200;
+    timTp.towMS = 1000;
+    timTp.towSubMS = 0x80000000;
+    timTp.qErr = 1400;
+    size = uUbxProtocolEncode(0x0d, 0x01, (const char *) &timTp, sizeof(timTp), message);
+    U_PORT_TEST_ASSERT(!uGnssTimeSyncProcessMessage(&sync, message, size));
+    // Then the pulse arrives and the next UBX-TIM-TP completes the pair
+    uGnssTimeSyncPulseIsr(&sync, 5000000000LL);
+    timTp.towMS = 2000;
+    size = uUbxProtocolEncode(0x0d, 0x01, (const char *) &timTp, sizeof(timTp), message);
+    U_PORT_TEST_ASSERT(uGnssTimeSyncProcessMessage(&sync, message, size));
+    U_PORT_TEST_ASSERT(uGnssTimeSyncGet(&sync, &sample) == 0);
+    gnssTimeNs = (2200LL * 604800LL * 1000000000LL) + 1000500001LL;
+    U_PORT_TEST_ASSERT(sample.hostTimeNs == 5000000000LL);
+    U_PORT_TEST_ASSERT(sample.gnssTimeNs == gnssTimeNs);
+    U_PORT_TEST_ASSERT(sample.offsetNs == gnssTimeNs - 5000000000LL);
+    U_PORT_TEST_ASSERT(sample.qErrPs == 1400);
+    U_PORT_TEST_ASSERT(!sample.utcNotGnss);
+    U_PORT_TEST_ASSERT(!sample.markNotPulse);
+    U_PORT_TEST_ASSERT(sample.count == 1);
+
+    // Two pulses between messages is ambiguous
+    uGnssTimeSyncPulseIsr(&sync, 6000000000LL);
+    uGnssTimeSyncPulseIsr(&sync, 7000000000LL);
+    // This time UTC and with qErr marked as invalid
+    timTp.towMS = 3000;
+    timTp.flags = 0x11;
+    size = uUbxProtocolEncode(0x0d, 0x01, (const char *) &timTp, sizeof(timTp), message);
+    U_PORT_TEST_ASSERT(!uGnssTimeSyncProcessMessage(&sync, message, size));
+    U_PORT_TEST_ASSERT(uGnssTimeSyncGet(&sync, &sample) == 0);
+    U_PORT_TEST_ASSERT(sample.count == 1);
+    uGnssTimeSyncPulseIsr(&sync, 8000000000LL);
+    timTp.towMS = 4000;
+    size = uUbxProtocolEncode(0x0d, 0x01, (const char *) &timTp, sizeof(timTp), message);
+    U_PORT_TEST_ASSERT(uGnssTimeSyncProcessMessage(&sync, message, size));
+    U_PORT_TEST_ASSERT(uGnssTimeSyncGet(&sync, &sample) == 0);
+    U_PORT_TEST_ASSERT(sample.hostTimeNs == 8000000000LL);
+    U_PORT_TEST_ASSERT(sample.gnssTimeNs == (2200LL * 604800LL * 1000000000LL) + 3000500000LL);
+    U_PORT_TEST_ASSERT(sample.qErrPs == 0);
+    U_PORT_TEST_ASSERT(sample.utcNotGnss);
+    U_PORT_TEST_ASSERT(sample.count == 2);
+
+    // A time mark: UBX-TIM-TM2 follows the edge it describes
+    memset(&timTm2, 0, sizeof(timTm2));
+    timTm2.flags = 0xc0 | 0x10;
+    timTm2.count = 5;
+    timTm2.wnR = 2200;
+    timTm2.towMsR = 9000;
+    timTm2.towSubMsR = 123;
+    uGnssTimeSyncMarkIsr(&sync, 9000000000LL);
+    size = uUbxProtocolEncode(0x0d, 0x03, (const char *) &timTm2, sizeof(timTm2), message);
+    U_PORT_TEST_ASSERT(uGnssTimeSyncProcessMessage(&sync, message, size));
+    U_PORT_TEST_ASSERT(uGnssTimeSyncGet(&sync, &sample) == 0);
+    U_PORT_TEST_ASSERT(sample.hostTimeNs == 9000000000LL);
+    U_PORT_TEST_ASSERT(sample.gnssTimeNs == (2200LL * 604800LL * 1000000000LL) + 9000000123LL);
+    U_PORT_TEST_ASSERT(sample.utcNotGnss);
+    U_PORT_TEST_ASSERT(sample.markNotPulse);
+    U_PORT_TEST_ASSERT(sample.count == 3);
+    // The same message again, or one where the GNSS chip has counted
+    // an edge we didn't see, is ignored
+    U_PORT_TEST_ASSERT(!uGnssTimeSyncProcessMessage(&sync, message, size));
+    uGnssTimeSyncMarkIsr(&sync, 10000000000LL);
+    timTm2.count = 7;
+    size = uUbxProtocolEncode(0x0d, 0x03, (const char *) &timTm2, sizeof(timTm2), message);
+    U_PORT_TEST_ASSERT(!uGnssTimeSyncProcessMessage(&sync, message, size));
+    uGnssTimeSyncMarkIsr(&sync, 11000000000LL);
+    timTm2.count = 8;
+    size = uUbxProtocolEncode(0x0d, 0x03, (const char *) &timTm2, sizeof(timTm2), message);
+    U_PORT_TEST_ASSERT(uGnssTimeSyncProcessMessage(&sync, message, size));
+    U_PORT_TEST_ASSERT(uGnssTimeSyncGet(&sync, &sample) == 0);
+    U_PORT_TEST_ASSERT(sample.hostTimeNs == 11000000000LL);
+    U_PORT_TEST_ASSERT(sample.count == 4);
+
+    // Not a message we know about
+    U_PORT_TEST_ASSERT(!uGnssTimeSyncProcessMessage(&sync, message, size - 1));
+
+    uPortDeinit();
+}
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
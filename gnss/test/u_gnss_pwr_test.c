@@ -38,6 +38,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
+#include "string.h"    // memset(), memcpy()
 
 #include "u_cfg_sw.h"
 #include "u_cfg_os_platform_specific.h"
@@ -47,6 +48,7 @@
 #include "u_error_common.h"
 
 #include "u_port.h"
+#include "u_port_heap.h"
 #include "u_port_debug.h"
 #include "u_port_os.h"   // Required by u_gnss_private.h
 #include "u_port_uart.h"
@@ -76,10 +78,26 @@
  */
 #define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
 
+#ifndef U_GNSS_PWR_TEST_STATE_BUFFER_LENGTH_BYTES
+/** The amount of storage for the UBX-MGA-DBD messages read by
+ * uGnssPwrSaveState().
+ */
+# define U_GNSS_PWR_TEST_STATE_BUFFER_LENGTH_BYTES (1024 * 8)
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** Storage for the state read by uGnssPwrSaveState().
+ */
+typedef struct {
+    char *pBuffer;
+    size_t size;
+    size_t numMessages;
+    bool overflow;
+} uGnssPwrTestState_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -92,6 +110,25 @@ static uGnssTestPrivate_t gHandles = U_GNSS_TEST_PRIVATE_DEFAULTS;
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Callback for uGnssPwrSaveState(), storing the messages one after
+// the other.
+static void saveCallback(uDeviceHandle_t gnssHandle,
+                         const char *pMessage, size_t size,
+                         void *pCallbackParam)
+{
+    uGnssPwrTestState_t *pState = (uGnssPwrTestState_t *) pCallbackParam;
+
+    (void) gnssHandle;
+
+    if (pState->size + size <= U_GNSS_PWR_TEST_STATE_BUFFER_LENGTH_BYTES) {
+        memcpy(pState->pBuffer + pState->size, pMessage, size);
+        pState->size += size;
+        pState->numMessages++;
+    } else {
+        pState->overflow = true;
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -105,6 +142,8 @@ U_PORT_TEST_FUNCTION("[gnssPwr]", "gnssPwrBasic")
     size_t iterations;
     uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM_WITH_UBX];
     int32_t y;
+    uGnssPwrCurrentTable_t currentTable = {{10, 30, 25000, 20000}, 3300};
+    uGnssPwrEnergy_t energy;
 
     // Whatever called us likely initialised the
     // port so deinitialise it here to obtain the
@@ -125,6 +164,9 @@ U_PORT_TEST_FUNCTION("[gnssPwr]", "gnssPwrBasic")
                                                     U_CFG_APP_CELL_PIN_GNSS_DATA_READY) == 0);
         gnssHandle = gHandles.gnssHandle;
 
+        U_PORT_TEST_ASSERT(uGnssPwrEnergyGet(gnssHandle, &energy) == U_ERROR_COMMON_NOT_INITIALISED);
+        U_PORT_TEST_ASSERT(uGnssPwrEnergyStart(gnssHandle, &currentTable) == 0);
+
         U_TEST_PRINT_LINE("powering on GNSS...");
         U_PORT_TEST_ASSERT(uGnssPwrOn(gnssHandle) == 0);
 
@@ -134,6 +176,20 @@ U_PORT_TEST_FUNCTION("[gnssPwr]", "gnssPwrBasic")
         U_TEST_PRINT_LINE("powering off GNSS...");
         U_PORT_TEST_ASSERT(uGnssPwrOff(gnssHandle) == 0);
 
+        // There has been no position request so no fix and
+        // everything up to now counts as acquisition
+        U_PORT_TEST_ASSERT(uGnssPwrEnergyGet(gnssHandle, &energy) == 0);
+        U_TEST_PRINT_LINE("energy accounts: acquisition %d ms, off %d ms, %d fix(es), %d uJ.",
+                          (int32_t) energy.timeMs[U_GNSS_PWR_ENERGY_STATE_ACQUISITION],
+                          (int32_t) energy.timeMs[U_GNSS_PWR_ENERGY_STATE_OFF],
+                          (int32_t) energy.fixes, (int32_t) energy.energyMicrojoules);
+        U_PORT_TEST_ASSERT(energy.timeMs[U_GNSS_PWR_ENERGY_STATE_ACQUISITION] > 0);
+        U_PORT_TEST_ASSERT(energy.timeMs[U_GNSS_PWR_ENERGY_STATE_TRACKING] == 0);
+        U_PORT_TEST_ASSERT(energy.fixes == 0);
+        U_PORT_TEST_ASSERT(energy.energyMicrojoules >= 0);
+        U_PORT_TEST_ASSERT(energy.energyPerFixMicrojoules == -1);
+        // Leave the accounts running: the postamble should free them
+
         switch (transportTypes[x]) {
             case U_GNSS_TRANSPORT_UART:
             //lint -fallthrough
@@ -181,6 +237,240 @@ U_PORT_TEST_FUNCTION("[gnssPwr]", "gnssPwrBasic")
     U_PORT_TEST_ASSERT(heapUsed <= 0);
 }
 
+/** Save and restore the navigation state of a GNSS chip.
+ */
+U_PORT_TEST_FUNCTION("[gnssPwr]", "gnssPwrSaveRestore")
+{
+    uDeviceHandle_t gnssHandle;
+    int32_t heapUsed;
+    size_t iterations;
+    uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM_WITH_UBX];
+    uGnssPwrTestState_t state;
+    int32_t y;
+
+    // In case a previous test failed
+    uGnssTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    // Repeat for all transport types
+    iterations = uGnssTestPrivateTransportTypesSet(transportTypes, U_CFG_APP_GNSS_UART,
+                                                   U_CFG_APP_GNSS_I2C);
+    for (size_t x = 0; x < iterations; x++) {
+        // Do the standard preamble
+        U_TEST_PRINT_LINE("testing on transport %s...",
+                          pGnssTestPrivateTransportTypeName(transportTypes[x]));
+        U_PORT_TEST_ASSERT(uGnssTestPrivatePreamble(U_CFG_TEST_GNSS_MODULE_TYPE,
+                                                    transportTypes[x], &gHandles, true,
+                                                    U_CFG_APP_CELL_PIN_GNSS_POWER,
+                                                    U_CFG_APP_CELL_PIN_GNSS_DATA_READY) == 0);
+        gnssHandle = gHandles.gnssHandle;
+
+        memset(&state, 0, sizeof(state));
+        state.pBuffer = (char *) pUPortMalloc(U_GNSS_PWR_TEST_STATE_BUFFER_LENGTH_BYTES);
+        U_PORT_TEST_ASSERT(state.pBuffer != NULL);
+
+        if (transportTypes[x] == U_GNSS_TRANSPORT_AT) {
+            U_PORT_TEST_ASSERT(uGnssPwrSaveState(gnssHandle, saveCallback,
+                                                 &state) == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
+            U_PORT_TEST_ASSERT(uGnssPwrSaveState(gnssHandle, NULL,
+                                                 NULL) == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
+            U_PORT_TEST_ASSERT(uGnssPwrRestoreState(gnssHandle, NULL,
+                                                    0) == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
+        } else {
+            // Read the state back to here
+            U_TEST_PRINT_LINE("reading navigation state from GNSS...");
+            y = uGnssPwrSaveState(gnssHandle, saveCallback, &state);
+            U_TEST_PRINT_LINE("%d UBX-MGA-DBD message(s), %d byte(s), read.", y, (int32_t) state.size);
+            U_PORT_TEST_ASSERT(y > 0);
+            U_PORT_TEST_ASSERT(state.overflow || ((size_t) y == state.numMessages));
+
+            // Write it back again
+            U_TEST_PRINT_LINE("writing navigation state back to GNSS...");
+            y = uGnssPwrRestoreState(gnssHandle, state.pBuffer, state.size);
+            U_TEST_PRINT_LINE("%d UBX-MGA-DBD message(s) written.", y);
+            U_PORT_TEST_ASSERT((size_t) y == state.numMessages);
+
+            // Not all GNSS chips have flash, so just report the
+            // outcome of any restoration from flash
+            y = uGnssPwrRestoreState(gnssHandle, NULL, 0);
+            U_TEST_PRINT_LINE("restore from flash at start-up gave %d.", y);
+        }
+
+        uPortFree(state.pBuffer);
+
+        // Do the standard postamble
+        uGnssTestPrivatePostamble(&gHandles, false);
+    }
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+/** Set each power save mode and read it back, and check that
+ * out-of-range configurations are rejected.
+ */
+U_PORT_TEST_FUNCTION("[gnssPwr]", "gnssPwrPsm")
+{
+    uDeviceHandle_t gnssHandle;
+    const uGnssPrivateModule_t *pModule;
+    int32_t heapUsed;
+    size_t iterations;
+    uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM_WITH_UBX];
+    uGnssPwrPsmConfig_t initial;
+    uGnssPwrPsmConfig_t config;
+    uGnssPwrPsmConfig_t readBack;
+    uGnssPwrPsmDutyCycle_t dutyCycle;
+    // Configurations that should be accepted, and what should be read back
+    const uGnssPwrPsmConfig_t good[][2] = {
+        {{U_GNSS_PWR_PSM_MODE_CONTINUOUS, 500, 0}, {U_GNSS_PWR_PSM_MODE_CONTINUOUS, 500, 0}},
+        {
+            {U_GNSS_PWR_PSM_MODE_CYCLIC_TRACKING, 1000, 0},
+            {U_GNSS_PWR_PSM_MODE_CYCLIC_TRACKING, 1000, 0}
+        },
+        {
+            {U_GNSS_PWR_PSM_MODE_CYCLIC_TRACKING, U_GNSS_PWR_PSM_CYCLIC_TRACKING_MAX_PERIOD_MS, 0},
+            {U_GNSS_PWR_PSM_MODE_CYCLIC_TRACKING, U_GNSS_PWR_PSM_CYCLIC_TRACKING_MAX_PERIOD_MS, 0}
+        },
+        {{U_GNSS_PWR_PSM_MODE_ON_OFF, 10000, 0}, {U_GNSS_PWR_PSM_MODE_ON_OFF, 10000, 0}},
+        // maxLatencyMs is rounded down to whole seconds
+        {{U_GNSS_PWR_PSM_MODE_ON_OFF, 60000, 30500}, {U_GNSS_PWR_PSM_MODE_ON_OFF, 60000, 30000}},
+        // Continuous with zero leaves the measurement rate alone
+        {{U_GNSS_PWR_PSM_MODE_CONTINUOUS, 0, 0}, {U_GNSS_PWR_PSM_MODE_CONTINUOUS, 1000, 0}}
+    };
+    // Configurations that psmCfgVal() should reject
+    const uGnssPwrPsmConfig_t bad[] = {
+        {U_GNSS_PWR_PSM_MODE_MAX_NUM, 1000, 0},
+        {U_GNSS_PWR_PSM_MODE_CONTINUOUS, -1, 0},
+        {U_GNSS_PWR_PSM_MODE_CYCLIC_TRACKING, 999, 0},
+        {U_GNSS_PWR_PSM_MODE_CYCLIC_TRACKING, U_GNSS_PWR_PSM_CYCLIC_TRACKING_MAX_PERIOD_MS + 1, 0},
+        {U_GNSS_PWR_PSM_MODE_ON_OFF, U_GNSS_PWR_PSM_ON_OFF_MIN_PERIOD_MS - 1000, 0},
+        {U_GNSS_PWR_PSM_MODE_ON_OFF, 10500, 0},
+        {U_GNSS_PWR_PSM_MODE_ON_OFF, 604800000, 0},
+        {U_GNSS_PWR_PSM_MODE_ON_OFF, 10000, -1},
+        {U_GNSS_PWR_PSM_MODE_ON_OFF, 10000, 256000}
+    };
+
+    // In case a previous test failed
+    uGnssTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    // Repeat for all transport types
+    iterations = uGnssTestPrivateTransportTypesSet(transportTypes, U_CFG_APP_GNSS_UART,
+                                                   U_CFG_APP_GNSS_I2C);
+    for (size_t x = 0; x < iterations; x++) {
+        // Do the standard preamble
+        U_TEST_PRINT_LINE("testing on transport %s...",
+                          pGnssTestPrivateTransportTypeName(transportTypes[x]));
+        U_PORT_TEST_ASSERT(uGnssTestPrivatePreamble(U_CFG_TEST_GNSS_MODULE_TYPE,
+                                                    transportTypes[x], &gHandles, true,
+                                                    U_CFG_APP_CELL_PIN_GNSS_POWER,
+                                                    U_CFG_APP_CELL_PIN_GNSS_DATA_READY) == 0);
+        gnssHandle = gHandles.gnssHandle;
+
+        pModule = pUGnssPrivateGetModule(gnssHandle);
+        U_PORT_TEST_ASSERT(pModule != NULL);
+        // No power save mode has been set yet
+        U_PORT_TEST_ASSERT(uGnssPwrGetPsmDutyCycle(gnssHandle, &dutyCycle) < 0);
+        if ((transportTypes[x] != U_GNSS_TRANSPORT_AT) &&
+            U_GNSS_PRIVATE_HAS(pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX) &&
+            U_GNSS_PRIVATE_HAS(pModule, U_GNSS_PRIVATE_FEATURE_CFG_PM)) {
+            // So that we can see what we're doing
+            uGnssSetUbxMessagePrint(gnssHandle, true);
+
+            U_PORT_TEST_ASSERT(uGnssPwrGetPsm(gnssHandle, NULL) < 0);
+            U_PORT_TEST_ASSERT(uGnssPwrGetPsm(gnssHandle, &initial) == 0);
+            U_TEST_PRINT_LINE("initial power save mode %d, update period %d ms.",
+                              initial.mode, initial.updatePeriodMs);
+            U_PORT_TEST_ASSERT(initial.mode == U_GNSS_PWR_PSM_MODE_CONTINUOUS);
+
+            // Start from a known measurement rate, which the last
+            // entry of good[] relies upon
+            config.mode = U_GNSS_PWR_PSM_MODE_CONTINUOUS;
+            config.updatePeriodMs = 1000;
+            config.maxLatencyMs = 0;
+            U_PORT_TEST_ASSERT(uGnssPwrSetPsm(gnssHandle, &config) == 0);
+
+            // Out of range configurations must be rejected and
+            // must change nothing
+            U_PORT_TEST_ASSERT(uGnssPwrSetPsm(gnssHandle, NULL) < 0);
+            for (size_t y = 0; y < sizeof(bad) / sizeof(bad[0]); y++) {
+                U_TEST_PRINT_LINE("checking that mode %d, update period %d ms, max"
+                                  " latency %d ms is rejected.", bad[y].mode,
+                                  bad[y].updatePeriodMs, bad[y].maxLatencyMs);
+                U_PORT_TEST_ASSERT(uGnssPwrSetPsm(gnssHandle, &(bad[y])) ==
+                                   (int32_t) U_ERROR_COMMON_INVALID_PARAMETER);
+            }
+            U_PORT_TEST_ASSERT(uGnssPwrGetPsm(gnssHandle, &readBack) == 0);
+            U_PORT_TEST_ASSERT(readBack.mode == U_GNSS_PWR_PSM_MODE_CONTINUOUS);
+            U_PORT_TEST_ASSERT(readBack.updatePeriodMs == 1000);
+            U_PORT_TEST_ASSERT(uGnssPwrGetPsmDutyCycle(gnssHandle, &dutyCycle) < 0);
+
+            // Set each good configuration and read it back
+            for (size_t y = 0; y < sizeof(good) / sizeof(good[0]); y++) {
+                U_TEST_PRINT_LINE("setting mode %d, update period %d ms, max"
+                                  " latency %d ms.", good[y][0].mode,
+                                  good[y][0].updatePeriodMs, good[y][0].maxLatencyMs);
+                U_PORT_TEST_ASSERT(uGnssPwrSetPsm(gnssHandle, &(good[y][0])) == 0);
+                memset(&readBack, 0xff, sizeof(readBack));
+                U_PORT_TEST_ASSERT(uGnssPwrGetPsm(gnssHandle, &readBack) == 0);
+                U_TEST_PRINT_LINE("read back mode %d, update period %d ms, max"
+                                  " latency %d ms.", readBack.mode,
+                                  readBack.updatePeriodMs, readBack.maxLatencyMs);
+                U_PORT_TEST_ASSERT(readBack.mode == good[y][1].mode);
+                U_PORT_TEST_ASSERT(readBack.updatePeriodMs == good[y][1].updatePeriodMs);
+                U_PORT_TEST_ASSERT(readBack.maxLatencyMs == good[y][1].maxLatencyMs);
+                // The duty cycle is only monitored while power saving
+                if (good[y][0].mode == U_GNSS_PWR_PSM_MODE_CONTINUOUS) {
+                    U_PORT_TEST_ASSERT(uGnssPwrGetPsmDutyCycle(gnssHandle, &dutyCycle) < 0);
+                } else {
+                    U_PORT_TEST_ASSERT(uGnssPwrGetPsmDutyCycle(gnssHandle, &dutyCycle) == 0);
+                    U_TEST_PRINT_LINE("duty cycle %d permille over %d ms, %d wake-up(s).",
+                                      dutyCycle.awakePermille,
+                                      (int32_t) dutyCycle.monitoredMs, (int32_t) dutyCycle.wakeUps);
+                    U_PORT_TEST_ASSERT((dutyCycle.awakePermille >= -1) &&
+                                       (dutyCycle.awakePermille <= 1000));
+                    U_PORT_TEST_ASSERT(dutyCycle.monitoredMs >= 0);
+                }
+            }
+
+            // Put things back as they were
+            config.mode = U_GNSS_PWR_PSM_MODE_CONTINUOUS;
+            config.updatePeriodMs = initial.updatePeriodMs;
+            config.maxLatencyMs = 0;
+            U_PORT_TEST_ASSERT(uGnssPwrSetPsm(gnssHandle, &config) == 0);
+            U_PORT_TEST_ASSERT(uGnssPwrGetPsmDutyCycle(gnssHandle, &dutyCycle) < 0);
+
+            // The message receive task stays up after the duty cycle
+            // receiver has gone, stop it to free its memory
+            U_PORT_TEST_ASSERT(uGnssMsgReceiveStopAll(gnssHandle) == 0);
+        } else {
+            U_TEST_PRINT_LINE("power save modes are not supported on this module/transport.");
+            config.mode = U_GNSS_PWR_PSM_MODE_CYCLIC_TRACKING;
+            config.updatePeriodMs = 1000;
+            config.maxLatencyMs = 0;
+            U_PORT_TEST_ASSERT(uGnssPwrSetPsm(gnssHandle, &config) < 0);
+        }
+
+        // Do the standard postamble
+        uGnssTestPrivatePostamble(&gHandles, false);
+    }
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
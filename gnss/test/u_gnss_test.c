@@ -55,11 +55,12 @@
 #include "u_gnss_module_type.h"
 #include "u_gnss_type.h"
 #include "u_gnss.h"
+#include "u_gnss_msg.h"    // U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES, uGnssMsgReceiveStatStreamLoss()
+#include "u_gnss_util.h"   // uGnssUtilUbxTransparentSendReceive()
 
 #if (U_CFG_APP_GNSS_I2C >= 0) && defined(U_GNSS_TEST_I2C_ADDRESS_EXTRA)
 # include "u_gnss_pwr.h"  // So that we can do something with the extra address
 # include "u_gnss_info.h" // To print something GNSS-module specific, show that we're not accidentally using address 0x42
-# include "u_gnss_msg.h"  // uGnssMsgReceiveStatStreamLoss()
 #endif
 
 /* ----------------------------------------------------------------
@@ -82,10 +83,25 @@
 # endif
 #endif
 
+#ifndef U_GNSS_TEST_VIRTUAL_SERIAL_BUFFER_LENGTH_BYTES
+/** The size of the loop-back buffer used by gnssVirtualSerial.
+ */
+# define U_GNSS_TEST_VIRTUAL_SERIAL_BUFFER_LENGTH_BYTES 64
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** Context for the loop-back virtual serial port used by
+ * gnssVirtualSerial: whatever is written can be read back.
+ */
+typedef struct {
+    char buffer[U_GNSS_TEST_VIRTUAL_SERIAL_BUFFER_LENGTH_BYTES];
+    size_t length;
+    size_t writeCount;
+} uGnssTestVirtualSerialLoopback_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -106,6 +122,49 @@ static int32_t gUartBHandle = -1;
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Virtual serial loop-back: get the number of bytes waiting.
+static int32_t virtualSerialGetReceiveSize(uGnssVirtualSerial_t *pVirtualSerial)
+{
+    uGnssTestVirtualSerialLoopback_t *pLoopback = (uGnssTestVirtualSerialLoopback_t *)
+                                                  pVirtualSerial->pContext;
+
+    return (int32_t) pLoopback->length;
+}
+
+// Virtual serial loop-back: read back what was written.
+static int32_t virtualSerialRead(uGnssVirtualSerial_t *pVirtualSerial,
+                                 char *pBuffer, size_t sizeBytes)
+{
+    uGnssTestVirtualSerialLoopback_t *pLoopback = (uGnssTestVirtualSerialLoopback_t *)
+                                                  pVirtualSerial->pContext;
+
+    if (sizeBytes > pLoopback->length) {
+        sizeBytes = pLoopback->length;
+    }
+    memcpy(pBuffer, pLoopback->buffer, sizeBytes);
+    pLoopback->length -= sizeBytes;
+    memmove(pLoopback->buffer, pLoopback->buffer + sizeBytes, pLoopback->length);
+
+    return (int32_t) sizeBytes;
+}
+
+// Virtual serial loop-back: write.
+static int32_t virtualSerialWrite(uGnssVirtualSerial_t *pVirtualSerial,
+                                  const char *pBuffer, size_t sizeBytes)
+{
+    uGnssTestVirtualSerialLoopback_t *pLoopback = (uGnssTestVirtualSerialLoopback_t *)
+                                                  pVirtualSerial->pContext;
+
+    if (sizeBytes > sizeof(pLoopback->buffer) - pLoopback->length) {
+        sizeBytes = sizeof(pLoopback->buffer) - pLoopback->length;
+    }
+    memcpy(pLoopback->buffer + pLoopback->length, pBuffer, sizeBytes);
+    pLoopback->length += sizeBytes;
+    pLoopback->writeCount++;
+
+    return (int32_t) sizeBytes;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -211,6 +270,12 @@ U_PORT_TEST_FUNCTION("[gnss]", "gnssAddStream")
         U_PORT_TEST_ASSERT(uGnssGetUbxMessagePrint(gnssHandleA));
     }
 
+    // Data Ready requires I2C and UBX-CFG-VALSET, which an M8
+    // doesn't have, so this should be rejected without
+    // touching anything
+    U_PORT_TEST_ASSERT(uGnssSetPinDataReady(gnssHandleA, 0, 0) ==
+                       (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
+
 # if (U_CFG_APP_GNSS_I2C < 0)
     U_TEST_PRINT_LINE("adding another instance on the same UART"
                       " port, should fail...");
@@ -296,6 +361,32 @@ U_PORT_TEST_FUNCTION("[gnss]", "gnssAddStream")
             break;
     }
 
+    U_TEST_PRINT_LINE("removing it again...");
+    uGnssRemove(gnssHandleA);
+
+    U_TEST_PRINT_LINE("adding it with a %d byte ring buffer read in"
+                      " full bursts...", U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES * 2);
+    errorCode = uGnssAddWithBufferSize(U_GNSS_MODULE_TYPE_M8,
+                                       gTransportTypeA,
+                                       transportHandleA,
+                                       -1, false,
+                                       U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES * 2,
+                                       U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES * 2,
+                                       &gnssHandleA);
+    U_PORT_TEST_ASSERT_EQUAL((int32_t) U_ERROR_COMMON_SUCCESS, errorCode);
+    transportType = U_GNSS_TRANSPORT_NONE;
+    transportHandle.uart = -1;
+    transportHandle.i2c = -1;
+    U_PORT_TEST_ASSERT(uGnssGetTransportHandle(gnssHandleA,
+                                               &transportType,
+                                               &transportHandle) == 0);
+    U_PORT_TEST_ASSERT(transportType == gTransportTypeA);
+    if (gTransportTypeA == U_GNSS_TRANSPORT_UBX_I2C) {
+        U_PORT_TEST_ASSERT(transportHandle.i2c == transportHandleA.i2c);
+    } else {
+        U_PORT_TEST_ASSERT(transportHandle.uart == transportHandleA.uart);
+    }
+
     U_TEST_PRINT_LINE("deinitialising GNSS API...");
     uGnssDeinit();
 
@@ -480,6 +571,89 @@ U_PORT_TEST_FUNCTION("[gnss]", "gnssI2cAddress")
 }
 #endif
 
+/** Add a GNSS instance on a loop-back virtual serial port, as
+ * would be used for a multiplexer channel through a cellular
+ * module, and check that data goes out and comes back through it
+ * without any AT-command encoding.  No GNSS module is needed.
+ */
+U_PORT_TEST_FUNCTION("[gnss]", "gnssVirtualSerial")
+{
+    uGnssTestVirtualSerialLoopback_t loopback = {0};
+    uGnssVirtualSerial_t virtualSerial = {0};
+    uGnssTransportHandle_t transportHandle;
+    uGnssTransportType_t transportType;
+    uDeviceHandle_t gnssHandle = NULL;
+    uDeviceHandle_t dummyHandle;
+    // A UBX-MON-VER poll
+    const char message[] = {(char) 0xb5, 0x62, 0x0a, 0x04, 0x00, 0x00, 0x0e, 0x34};
+    char buffer[sizeof(message)];
+    int32_t heapUsed;
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uGnssInit() == 0);
+
+    transportHandle.pVirtualSerial = &virtualSerial;
+    U_TEST_PRINT_LINE("adding a GNSS instance on an incomplete virtual serial"
+                      " port, should fail...");
+    U_PORT_TEST_ASSERT(uGnssAdd(U_GNSS_MODULE_TYPE_M8,
+                                U_GNSS_TRANSPORT_VIRTUAL_SERIAL,
+                                transportHandle, -1, true,
+                                &dummyHandle) < 0);
+
+    virtualSerial.pGetReceiveSize = virtualSerialGetReceiveSize;
+    virtualSerial.pRead = virtualSerialRead;
+    virtualSerial.pWrite = virtualSerialWrite;
+    virtualSerial.pContext = (void *) &loopback;
+    U_TEST_PRINT_LINE("adding a GNSS instance on a virtual serial port...");
+    U_PORT_TEST_ASSERT(uGnssAdd(U_GNSS_MODULE_TYPE_M8,
+                                U_GNSS_TRANSPORT_VIRTUAL_SERIAL,
+                                transportHandle, -1, true,
+                                &gnssHandle) == 0);
+    transportType = U_GNSS_TRANSPORT_NONE;
+    transportHandle.pVirtualSerial = NULL;
+    U_PORT_TEST_ASSERT(uGnssGetTransportHandle(gnssHandle,
+                                               &transportType,
+                                               &transportHandle) == 0);
+    U_PORT_TEST_ASSERT(transportType == U_GNSS_TRANSPORT_VIRTUAL_SERIAL);
+    U_PORT_TEST_ASSERT(transportHandle.pVirtualSerial == &virtualSerial);
+
+    U_TEST_PRINT_LINE("adding another instance on the same virtual serial"
+                      " port, should fail...");
+    U_PORT_TEST_ASSERT(uGnssAdd(U_GNSS_MODULE_TYPE_M8,
+                                U_GNSS_TRANSPORT_VIRTUAL_SERIAL,
+                                transportHandle, -1, true,
+                                &dummyHandle) < 0);
+
+    U_TEST_PRINT_LINE("sending a message...");
+    U_PORT_TEST_ASSERT(uGnssMsgSend(gnssHandle, message,
+                                    sizeof(message)) == sizeof(message));
+    U_PORT_TEST_ASSERT(loopback.writeCount == 1);
+    U_PORT_TEST_ASSERT(loopback.length == sizeof(message));
+    U_PORT_TEST_ASSERT(memcmp(loopback.buffer, message, sizeof(message)) == 0);
+    loopback.length = 0;
+
+    U_TEST_PRINT_LINE("sending a message and reading it back...");
+    memset(buffer, 0, sizeof(buffer));
+    U_PORT_TEST_ASSERT(uGnssUtilUbxTransparentSendReceive(gnssHandle,
+                                                          message, sizeof(message),
+                                                          buffer,
+                                                          sizeof(buffer)) == sizeof(message));
+    U_PORT_TEST_ASSERT(loopback.writeCount == 2);
+    U_PORT_TEST_ASSERT(memcmp(buffer, message, sizeof(message)) == 0);
+
+    uGnssRemove(gnssHandle);
+    uGnssDeinit();
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
@@ -113,6 +113,18 @@ void uPortDeinit();
  */
 int32_t uPortGetTickTimeMs();
 
+/** Get the current time in microseconds from the highest resolution
+ * timer that the platform offers, e.g. for time-stamping an event
+ * in an interrupt; this may be called from interrupt context.  The
+ * resolution is platform-dependent: where there is no timer better
+ * than the OS tick this is simply uPortGetTickTimeMs() multiplied
+ * by 1000.  The same caveats as for uPortGetTickTimeMs() apply but,
+ * being 64 bits wide, it will not wrap.
+ *
+ * @return the current time in microseconds.
+ */
+int64_t uPortGetTickTimeUs();
+
 /** Get the heap high watermark, the minimum amount of heap
  * free, ever.
  *
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_PORT_CRC_H_
+#define _U_PORT_CRC_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup __port __Port
+ *  @{
+ */
+
+/** @file
+ * @brief Hardware CRC API.  A default implementation of this function,
+ * which returns #U_ERROR_COMMON_NOT_SUPPORTED, is provided in
+ * u_port_crc.c; a platform that has a CRC peripheral may override it,
+ * in which case ubxlib (e.g. uSpartnCrc32()) will use the hardware in
+ * place of a software CRC calculation.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Calculate a CRC-32/MPEG-2 over a block of data, i.e.
+ * polynomial 0x04C11DB7, not reflected, initial value 0xFFFFFFFF
+ * and no final XOR; this is the CRC calculated by the CRC
+ * peripheral of, for instance, the STM32 series of MCUs.  The
+ * implementation must be thread-safe.
+ *
+ * @param[in] pData  a pointer to the data.
+ * @param size       the number of bytes at pData.
+ * @param[out] pCrc  a place to put the CRC, cannot be NULL.
+ * @return           zero on success else negative error code;
+ *                   #U_ERROR_COMMON_NOT_SUPPORTED if there is no
+ *                   hardware CRC on this platform.
+ */
+int32_t uPortCrc32Mpeg2(const char *pData, size_t size, uint32_t *pCrc);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_PORT_CRC_H_
+
+// End of file
@@ -29,6 +29,26 @@
 /** @file
  * @brief Porting layer for cryptographic functions, mapped to
  * mbedTLS on most platforms.  These functions are thread-safe.
+ *
+ * In the mbedTLS implementation uPortCryptoAes128CbcEncrypt() and
+ * uPortCryptoAes128CbcDecrypt() are weakly linked: where the MCU
+ * has an AES engine (e.g. the CryptoCell of an nRF52840 or the AES
+ * peripheral of an STM32), which may be fed by DMA, a platform or an
+ * application may provide its own implementation of these two
+ * functions to use it.  Chip to chip security, for instance, passes
+ * an entire frame to each call.
+ *
+ * For data that is not all in RAM at once, e.g. a large file, the
+ * SHA256, HMAC SHA256 and AES 128 CBC calculations (and MD5, which
+ * is only available in this form) may instead be
+ * performed in pieces with the xxxInit()/xxxUpdate()/xxxFinal()
+ * functions, which keep the state of the calculation in a context
+ * allocated by the port.  In the mbedTLS implementation these are
+ * also weakly linked, so that a platform may map them to a hardware
+ * engine (e.g. the STM32 HASH/CRYP peripherals); note that where
+ * mbedTLS is itself built to use a hardware engine, as it is by
+ * default on ESP32 and on nRF52840 with nRF Connect SDK, the
+ * mbedTLS implementation already uses the hardware.
  */
 
 #ifdef __cplusplus
@@ -43,6 +63,10 @@ extern "C" {
  */
 #define U_PORT_CRYPTO_SHA256_OUTPUT_LENGTH_BYTES 32
 
+/** The size of output buffer required for an MD5 calculation.
+ */
+#define U_PORT_CRYPTO_MD5_OUTPUT_LENGTH_BYTES 16
+
 /** The size of initialisation vector required for an AES 128
  * calculation.
  */
@@ -150,6 +174,167 @@ int32_t uPortCryptoAes128CbcDecrypt(const char *pKey,
                                     size_t lengthBytes,
                                     char *pOutput);
 
+/** Start a SHA256 calculation that is to be performed in pieces.
+ * Each successful call to this function MUST be matched by a call
+ * to uPortCryptoSha256Final(), which frees the context.
+ *
+ * @param[out] ppContext a place to put a pointer to the context of
+ *                       the calculation; cannot be NULL.
+ * @return               zero on success else negative error code.
+ */
+int32_t uPortCryptoSha256Init(void **ppContext);
+
+/** Add a piece of data to a SHA256 calculation.
+ *
+ * @param pContext         the context from uPortCryptoSha256Init().
+ * @param pInput           a pointer to the input data; cannot be
+ *                         NULL unless inputLengthBytes is zero.
+ * @param inputLengthBytes the length of the input data.
+ * @return                 zero on success else negative error code.
+ */
+int32_t uPortCryptoSha256Update(void *pContext,
+                                const char *pInput,
+                                size_t inputLengthBytes);
+
+/** Finish a SHA256 calculation and free its context.
+ *
+ * @param pContext     the context from uPortCryptoSha256Init();
+ *                     this is always freed and must not be used
+ *                     again.
+ * @param[out] pOutput a pointer to at least 32 bytes of space
+ *                     to which the output will be written; may be
+ *                     NULL to abandon the calculation.
+ * @return             zero on success else negative error code.
+ */
+int32_t uPortCryptoSha256Final(void *pContext, char *pOutput);
+
+/** Start a HMAC SHA256 calculation that is to be performed in
+ * pieces.  Each successful call to this function MUST be matched
+ * by a call to uPortCryptoHmacSha256Final(), which frees the
+ * context.
+ *
+ * @param[out] ppContext a place to put a pointer to the context of
+ *                       the calculation; cannot be NULL.
+ * @param pKey           a pointer to the key; cannot be NULL.
+ * @param keyLengthBytes the length of the key.
+ * @return               zero on success else negative error code.
+ */
+int32_t uPortCryptoHmacSha256Init(void **ppContext,
+                                  const char *pKey,
+                                  size_t keyLengthBytes);
+
+/** Add a piece of data to a HMAC SHA256 calculation.
+ *
+ * @param pContext         the context from
+ *                         uPortCryptoHmacSha256Init().
+ * @param pInput           a pointer to the input data; cannot be
+ *                         NULL unless inputLengthBytes is zero.
+ * @param inputLengthBytes the length of the input data.
+ * @return                 zero on success else negative error code.
+ */
+int32_t uPortCryptoHmacSha256Update(void *pContext,
+                                    const char *pInput,
+                                    size_t inputLengthBytes);
+
+/** Finish a HMAC SHA256 calculation and free its context.
+ *
+ * @param pContext     the context from uPortCryptoHmacSha256Init();
+ *                     this is always freed and must not be used
+ *                     again.
+ * @param[out] pOutput a pointer to at least 32 bytes of space
+ *                     to which the output will be written; may be
+ *                     NULL to abandon the calculation.
+ * @return             zero on success else negative error code.
+ */
+int32_t uPortCryptoHmacSha256Final(void *pContext, char *pOutput);
+
+/** Start an MD5 calculation that is to be performed in pieces.
+ * MD5 is NOT secure and is provided only so that a hash reported
+ * by a module (e.g. that of a stored security credential) can be
+ * compared with local data.  Each successful call to this function
+ * MUST be matched by a call to uPortCryptoMd5Final(), which frees
+ * the context.
+ *
+ * @param[out] ppContext a place to put a pointer to the context of
+ *                       the calculation; cannot be NULL.
+ * @return               zero on success else negative error code,
+ *                       #U_ERROR_COMMON_NOT_SUPPORTED if the
+ *                       platform's cryptographic library has been
+ *                       built without MD5.
+ */
+int32_t uPortCryptoMd5Init(void **ppContext);
+
+/** Add a piece of data to an MD5 calculation.
+ *
+ * @param pContext         the context from uPortCryptoMd5Init().
+ * @param pInput           a pointer to the input data; cannot be
+ *                         NULL unless inputLengthBytes is zero.
+ * @param inputLengthBytes the length of the input data.
+ * @return                 zero on success else negative error code.
+ */
+int32_t uPortCryptoMd5Update(void *pContext,
+                             const char *pInput,
+                             size_t inputLengthBytes);
+
+/** Finish an MD5 calculation and free its context.
+ *
+ * @param pContext     the context from uPortCryptoMd5Init();
+ *                     this is always freed and must not be used
+ *                     again.
+ * @param[out] pOutput a pointer to at least
+ *                     #U_PORT_CRYPTO_MD5_OUTPUT_LENGTH_BYTES of
+ *                     space to which the output will be written;
+ *                     may be NULL to abandon the calculation.
+ * @return             zero on success else negative error code.
+ */
+int32_t uPortCryptoMd5Final(void *pContext, char *pOutput);
+
+/** Start an AES 128 CBC encryption or decryption that is to be
+ * performed in pieces.  Each successful call to this function
+ * MUST be matched by a call to uPortCryptoAes128CbcFinal(), which
+ * frees the context.
+ *
+ * @param[out] ppContext a place to put a pointer to the context of
+ *                       the calculation; cannot be NULL.
+ * @param pKey           a pointer to the key; cannot be NULL.
+ * @param keyLengthBytes the length of the key; must be 16, 24
+ *                       or 32 bytes.
+ * @param pInitVector    a pointer to the 16 byte initialisation
+ *                       vector; cannot be NULL.  A copy is taken,
+ *                       the vector pointed-to is not modified.
+ * @param encrypt        true to encrypt, false to decrypt.
+ * @return               zero on success else negative error code.
+ */
+int32_t uPortCryptoAes128CbcInit(void **ppContext,
+                                 const char *pKey,
+                                 size_t keyLengthBytes,
+                                 const char *pInitVector,
+                                 bool encrypt);
+
+/** Encrypt or decrypt a piece of data with AES 128 CBC, carrying
+ * on from where the previous piece left off.
+ *
+ * @param pContext     the context from uPortCryptoAes128CbcInit().
+ * @param[in] pInput   a pointer to the input data; cannot be NULL.
+ * @param lengthBytes  the length of the input data; must be
+ *                     a multiple of 16 bytes.
+ * @param[out] pOutput a pointer to at least lengthBytes bytes of
+ *                     space to which the output will be written.
+ * @return             zero on success else negative error code.
+ */
+int32_t uPortCryptoAes128CbcUpdate(void *pContext,
+                                   const char *pInput,
+                                   size_t lengthBytes,
+                                   char *pOutput);
+
+/** Finish an AES 128 CBC encryption or decryption, zeroing and
+ * freeing its context.
+ *
+ * @param pContext the context from uPortCryptoAes128CbcInit();
+ *                 this must not be used again.
+ */
+void uPortCryptoAes128CbcFinal(void *pContext);
+
 #ifdef __cplusplus
 }
 #endif
@@ -39,12 +39,20 @@ extern "C" {
  * -------------------------------------------------------------- */
 
 /** Define #U_CFG_ENABLE_LOGGING to enable debug prints.  How they
- * leave the building is dictated by the platform.
+ * leave the building is dictated by the platform.  Define
+ * U_CFG_LOG_DEFERRED as well to have the formatting done later,
+ * in a low-priority task: see u_port_log_deferred.h.
  */
 #if U_CFG_ENABLE_LOGGING
-# define uPortLog(format, ...) \
+# ifdef U_CFG_LOG_DEFERRED
+#  define uPortLog(format, ...) \
+             /*lint -e{507} suppress size incompatibility warnings in printf() */ \
+             uPortLogDeferredF(format, ##__VA_ARGS__)
+# else
+#  define uPortLog(format, ...) \
              /*lint -e{507} suppress size incompatibility warnings in printf() */ \
              uPortLogF(format, ##__VA_ARGS__)
+# endif
 #else
 # define uPortLog(...)
 #endif
@@ -66,6 +74,18 @@ extern "C" {
  */
 void uPortLogF(const char *pFormat, ...);
 
+/** As uPortLogF() but, if uPortLogDeferredStart() has been called,
+ * the formatting and output are deferred to a low-priority task;
+ * this function is not usually called directly, it is what the
+ * uPortLog() macro maps to if U_CFG_LOG_DEFERRED is defined; see
+ * u_port_log_deferred.h.
+ *
+ * @param[in] pFormat a printf() style format string; must be a
+ *                    string literal.
+ * @param ...        variable argument list.
+ */
+void uPortLogDeferredF(const char *pFormat, ...);
+
 /** Switch logging off, so that it has no effect; it is NOT a requirement
  * that this API is implemented: where it is not implemented
  * #U_ERROR_COMMON_NOT_IMPLEMENTED should be returned.
@@ -31,8 +31,8 @@
  * function in its own task context, driven asynchronously, with
  * parameters sent through an OS queue.  These functions are
  * thread-safe except that an event queue should not be closed
- * while uPortEventQueueSend() or uPortEventQueueSendIrq() are
- * in progress.
+ * while uPortEventQueueSend(), uPortEventQueueSendIrq() or their
+ * pointer-passing equivalents are in progress.
  *
  * It works like this.  If you have function of the form, say:
  *
@@ -83,6 +83,31 @@
  * repeated as necessary. `uPortEventQueueSendIrq()` is
  * a version which is safe to call from an interrupt.
  *
+ * Where the parameter block is large, or is already sitting in
+ * a buffer of your own, `uPortEventQueueSendPtr()` (or
+ * `uPortEventQueueSendPtrIrq()`) may be used instead: only a
+ * pointer is put on the queue, `myFunction()` is called with
+ * that pointer and then the release function you provided is
+ * called with it, e.g. to return the buffer to a pool; the
+ * parameter block is not copied at all and need not fit within
+ * `paramMaxLengthBytes`.  Pointer and copied events may be sent
+ * to the same event queue; a queue that is only to be used for
+ * pointer events can be opened with `paramMaxLengthBytes` of zero,
+ * its items then being just big enough to carry a pointer.
+ *
+ * Where there are many event queues, each needing a task and
+ * hence a stack, RAM may be saved by opening the queues in a pool
+ * instead: `uPortEventQueuePoolOpen()` creates a single task and
+ * `uPortEventQueueOpenInPool()` opens an event queue, with a
+ * priority, that is served by that task.  Each time the pool task
+ * is free it takes an event from the highest priority member queue
+ * that has one, member queues of equal priority being served
+ * round-robin; the functions of a pool's member queues are hence
+ * called one at a time, never simultaneously.  The send, close etc.
+ * functions work the same for a queue in a pool as for any other.
+ * More than one pool may be opened, e.g. at different task
+ * priorities.
+ *
  * `uPortEventQueueClose()` shuts down the queue and deletes
  * the task.  This is a cooperative process: your function
  * must have emptied the queue and exited for shut-down to
@@ -110,6 +135,12 @@ extern "C" {
 # define U_PORT_EVENT_QUEUE_MAX_PARAM_LENGTH_BYTES 128
 #endif
 
+#ifndef U_PORT_EVENT_QUEUE_POOL_MAX_NUM
+/** The maximum number of event queue pools.
+ */
+# define U_PORT_EVENT_QUEUE_POOL_MAX_NUM 4
+#endif
+
 /** The length of uEventQueueControlOrSize_t (see implementation).
  */
 #define U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES 4
@@ -141,7 +172,10 @@ extern "C" {
  * @param paramMaxLengthBytes  the maximum length of the parameters
  *                             structure to pass to the function,
  *                             cannot be larger than
- *                             #U_PORT_EVENT_QUEUE_MAX_PARAM_LENGTH_BYTES.
+ *                             #U_PORT_EVENT_QUEUE_MAX_PARAM_LENGTH_BYTES;
+ *                             use zero if only uPortEventQueueSendPtr()
+ *                             or uPortEventQueueSendPtrIrq() will be
+ *                             used with this queue.
  * @param stackSizeBytes       the stack size of the task that the
  *                             function will be run in, must be
  *                             at least
@@ -183,6 +217,65 @@ int32_t uPortEventQueueOpen(void (*pFunction) (void *, size_t),
                             int32_t priority,
                             size_t queueLength);
 
+/** Open an event queue pool: a task which serves any number of
+ * event queues opened with uPortEventQueueOpenInPool().  A pool
+ * is closed with uPortEventQueuePoolClose() or by
+ * uPortEventQueueDeinit().
+ *
+ * @param[in] pName      a name to give the task, may be NULL.
+ * @param stackSizeBytes the stack size of the task, which must be
+ *                       enough for the function of any event queue
+ *                       in the pool; must be at least
+ *                       #U_PORT_EVENT_QUEUE_MIN_TASK_STACK_SIZE_BYTES.
+ * @param priority       the priority of the task; see the notes
+ *                       on uPortEventQueueOpen().
+ * @return               a handle for the pool on success, else
+ *                       negative error code.
+ */
+int32_t uPortEventQueuePoolOpen(const char *pName,
+                                size_t stackSizeBytes,
+                                int32_t priority);
+
+/** Open an event queue in a pool, see uPortEventQueuePoolOpen();
+ * the queue has no task of its own, its function being called by
+ * the task of the pool.  The returned handle is used with the
+ * event queue functions exactly as one from uPortEventQueueOpen().
+ * Note that an event queue in a pool must not be closed from the
+ * function of any event queue in the same pool, since closure
+ * waits upon the task of the pool.
+ *
+ * @param poolHandle          the handle of the pool.
+ * @param[in] pFunction       the function that will be called by
+ *                            the pool task for events on this queue,
+ *                            cannot be NULL.
+ * @param paramMaxLengthBytes the maximum length of the parameter
+ *                            block, as for uPortEventQueueOpen().
+ * @param queuePriority       the priority of this queue within the
+ *                            pool, higher numbers being served first;
+ *                            queues of equal priority are served
+ *                            round-robin.  This is independent of
+ *                            any OS task priority.
+ * @param queueLength         the number of items to let onto the
+ *                            queue before blocking or returning an
+ *                            error, must be at least 1.
+ * @return                    a handle for the event queue on success,
+ *                            else negative error code.
+ */
+int32_t uPortEventQueueOpenInPool(int32_t poolHandle,
+                                  void (*pFunction) (void *, size_t),
+                                  size_t paramMaxLengthBytes,
+                                  int32_t queuePriority,
+                                  size_t queueLength);
+
+/** Close an event queue pool, closing any event queues that
+ * are still open in it.  Must not be called from the function
+ * of an event queue in the pool.
+ *
+ * @param poolHandle the handle of the pool.
+ * @return           zero on success else negative error code.
+ */
+int32_t uPortEventQueuePoolClose(int32_t poolHandle);
+
 /** Send to an event queue.  The data at pParam will be copied
  * onto the queue.  If the queue is full this function will block
  * until room is available.  An event queue should not be closed
@@ -205,7 +298,8 @@ int32_t uPortEventQueueSend(int32_t handle, const void *pParam,
  * pParam will be copied onto the queue.  If the queue is full
  * the event will not be sent and an error will be returned.
  * Note: you must ensure that your interrupt stack is large
- * enough to hold an array of size paramLengthBytes +
+ * enough to hold an item of the queue, which is the larger of
+ * paramMaxLengthBytes and three pointers, plus
  * #U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES. An event
  * queue should not be closed while this function is in
  * progress.
@@ -223,6 +317,82 @@ int32_t uPortEventQueueSend(int32_t handle, const void *pParam,
 int32_t uPortEventQueueSendIrq(int32_t handle, const void *pParam,
                                size_t paramLengthBytes);
 
+/** As uPortEventQueueSendIrq() but coalescing: if an event sent
+ * with this function is already on the queue, i.e. the function
+ * given to uPortEventQueueOpen() has not yet been called for it,
+ * nothing is sent and zero is returned; this is decided with a
+ * single atomic compare-and-swap, no interrupts are masked, so
+ * it is the cheapest way for an interrupt to say "there is
+ * something to do", e.g. "data has been received", where the
+ * event function deals with everything that has happened since
+ * it was last called.  Events must carry the same meaning each
+ * time since those which are coalesced are simply not sent.
+ *
+ * @param handle            the handle for the event queue.
+ * @param[in] pParam        a pointer to the parameters structure
+ *                          to send.  May be NULL, in which case
+ *                          paramLengthBytes must be zero.
+ * @param paramLengthBytes  the length of the parameters
+ *                          structure.  Must be less than or
+ *                          equal to paramMaxLengthBytes as
+ *                          given to uPortEventQueueOpen().
+ * @return                  zero on success (including the case
+ *                          where the event was coalesced with
+ *                          one already queued) else negative
+ *                          error code.
+ */
+int32_t uPortEventQueueSendIrqOnce(int32_t handle, const void *pParam,
+                                   size_t paramLengthBytes);
+
+/** Send a parameter block to an event queue by pointer rather
+ * than by copying it: the function given to uPortEventQueueOpen()
+ * will be called with pParam and paramLengthBytes and, when it
+ * returns, pRelease (if not NULL) will be called with pParam.
+ * On success ownership of the parameter block passes to the event
+ * queue until pRelease is called; on failure ownership remains with
+ * the caller.  Pointer events still on the queue when it is closed
+ * are handled (and released) before the close completes.  If the
+ * queue is full this function will block until room is available.
+ * An event queue should not be closed while this function is in
+ * progress.
+ *
+ * @param handle            the handle for the event queue.
+ * @param[in] pParam        a pointer to the parameter block, cannot
+ *                          be NULL.
+ * @param paramLengthBytes  the length of the parameter block, which
+ *                          is simply passed on; it need not be less
+ *                          than paramMaxLengthBytes as given to
+ *                          uPortEventQueueOpen().
+ * @param[in] pRelease      the function to call with pParam once the
+ *                          event has been handled, e.g. uPortFree()
+ *                          or one that returns the block to a pool;
+ *                          may be NULL.
+ * @return                  zero on success else negative error code.
+ */
+int32_t uPortEventQueueSendPtr(int32_t handle, void *pParam,
+                               size_t paramLengthBytes,
+                               void (*pRelease) (void *));
+
+/** As uPortEventQueueSendPtr() but for use from an interrupt: if
+ * the queue is full the event will not be sent and an error will
+ * be returned.  Your interrupt stack must be large enough to hold
+ * an item of the queue, which is the larger of paramMaxLengthBytes
+ * and three pointers, plus
+ * #U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES.  Note that pRelease
+ * is called from the event task, not from interrupt context.
+ *
+ * @param handle            the handle for the event queue.
+ * @param[in] pParam        a pointer to the parameter block, cannot
+ *                          be NULL.
+ * @param paramLengthBytes  the length of the parameter block.
+ * @param[in] pRelease      the function to call with pParam once the
+ *                          event has been handled; may be NULL.
+ * @return                  zero on success else negative error code.
+ */
+int32_t uPortEventQueueSendPtrIrq(int32_t handle, void *pParam,
+                                  size_t paramLengthBytes,
+                                  void (*pRelease) (void *));
+
 /** Detect whether the task currently executing is the
  * event task for the given event queue.  Useful if you
  * have code which is called a few levels down from the
@@ -237,7 +407,8 @@ bool uPortEventQueueIsTask(int32_t handle);
 
 /** Get the stack high watermark, the minimum free
  * stack, for the task at the end of the given event
- * queue in bytes.
+ * queue in bytes; for an event queue in a pool this
+ * is the task of the pool.
  *
  * @param handle   the handle of the queue to check.
  * @return         the minimum stack free for the lifetime
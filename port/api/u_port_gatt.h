@@ -124,6 +124,25 @@ typedef struct {
     uint32_t linkLossTimeout;
 } uPortGattGapParams_t;
 
+/** The parameters of a connection's link, see uPortGattGetLinkInfo().
+ *
+ *  @param mtu          the ATT MTU.
+ *  @param txPhy        the transmit PHY: 1 for 1M, 2 for 2M, 4 for coded,
+ *                      0 if not known.
+ *  @param rxPhy        the receive PHY, coded as txPhy.
+ *  @param txDataLength the maximum link-layer payload that is transmitted
+ *                      in bytes, 0 if not known.
+ *  @param rxDataLength the maximum link-layer payload that is received
+ *                      in bytes, 0 if not known.
+ */
+typedef struct {
+    int32_t mtu;
+    int32_t txPhy;
+    int32_t rxPhy;
+    int32_t txDataLength;
+    int32_t rxDataLength;
+} uPortGattLinkInfo_t;
+
 /** GATT characteristic descriptor type
  */
 typedef enum {
@@ -340,6 +359,61 @@ typedef uPortGattIter_t (*uPortGattDescriptorDiscoveryCallback_t)(int32_t connHa
                                                                   uPortGattUuid_t *pUuid,
                                                                   uint16_t attrHandle);
 
+/** A notification in a batch, see uPortGattNotifyBatch().
+ */
+typedef struct {
+    int32_t connHandle;                      /**< connection handle. */
+    const uPortGattCharacteristic_t *pChar;  /**< the characteristic. */
+    const void *pData;                       /**< the notification data. */
+    uint16_t len;                            /**< the length of pData. */
+} uPortGattNotifyBatchEntry_t;
+
+/** Callback when all of the notifications of a batch that were
+ * queued have been sent, called from the context of the BLE stack.
+ *
+ * @param numSent    the number of notifications that were sent.
+ * @param numFailed  the number of notifications that could not be
+ *                   queued or were lost, e.g. to a disconnection.
+ * @param[in] pParam the pParam passed to uPortGattNotifyBatch().
+ */
+typedef void (*uPortGattNotifyBatchCallback_t)(int32_t numSent,
+                                               int32_t numFailed,
+                                               void *pParam);
+
+/** The filter for a scan, applied by the porting layer before a
+ * report is passed on.
+ */
+typedef struct {
+    bool activeScan;         /**< true to request scan responses. */
+    bool filterDuplicates;   /**< true to have the controller drop
+                                  repeated reports from the same
+                                  advertiser. */
+    int32_t rssiMinDbm;      /**< reports weaker than this are dropped. */
+    uint16_t uuid16;         /**< if non-zero, only reports advertising
+                                  this 16-bit service UUID are passed on. */
+    int32_t manufacturerId;  /**< if not negative, only reports carrying
+                                  manufacturer-specific data with this
+                                  company identifier are passed on. */
+} uPortGattScanFilter_t;
+
+/** Scan report callback, called from the context of the BLE stack;
+ * it should be quick.
+ *
+ * @param[in] pAddress     the address of the advertiser, 6 bytes,
+ *                         least significant byte first.
+ * @param addressType      public or random address.
+ * @param rssiDbm          the RSSI of the report.
+ * @param isScanResponse   true if pData is from a scan response.
+ * @param[in] pData        the advertising data, raw AD structures.
+ * @param length           the number of bytes at pData.
+ * @param[in] pParam       the pParam passed to uPortGattScanStart().
+ */
+typedef void (*uPortGattScanCallback_t)(const uint8_t *pAddress,
+                                        uPortBtLeAddressType_t addressType,
+                                        int32_t rssiDbm, bool isScanResponse,
+                                        const uint8_t *pData, size_t length,
+                                        void *pParam);
+
 extern const uPortGattGapParams_t uPortGattGapParamsDefault;
 
 /* ----------------------------------------------------------------
@@ -419,6 +493,26 @@ int32_t uPortGattGetMtu(int32_t connHandle);
 int32_t uPortGattExchangeMtu(int32_t connHandle,
                              mtuXchangeRespCallback_t respCallback);
 
+/** Ask for the fastest link the remote device will accept: the
+ * 2M PHY and the maximum link-layer data length.  The procedures
+ * run in the background and the remote device may decline them,
+ * use uPortGattGetLinkInfo() to see the outcome.
+ *
+ * @param connHandle connection handle.
+ * @return           zero if one or other procedure was started,
+ *                   else negative error code.
+ */
+int32_t uPortGattRequestFastLink(int32_t connHandle);
+
+/** Get the current link parameters of a connection.
+ *
+ * @param connHandle      connection handle.
+ * @param[out] pLinkInfo  a place to put the link parameters, cannot
+ *                        be NULL.
+ * @return                zero on success else negative error code.
+ */
+int32_t uPortGattGetLinkInfo(int32_t connHandle, uPortGattLinkInfo_t *pLinkInfo);
+
 /** Send characteristic notification.
  *
  * @param connHandle     connection handle.
@@ -430,6 +524,26 @@ int32_t uPortGattNotify(int32_t connHandle,
                         const uPortGattCharacteristic_t *pChar,
                         const void *data, uint16_t len);
 
+/** Send a batch of characteristic notifications, to one or more
+ * connections, in one go: all of them are handed to the BLE stack
+ * before this returns, without waiting for any to be sent, so that
+ * the controller can put as many as it is able into each connection
+ * event.  The data is copied, it need not be kept once this returns.
+ *
+ * @param[in] pEntries   the notifications.
+ * @param numEntries     the number of entries at pEntries.
+ * @param pCallback      callback for when all of those queued have
+ *                       been sent, may be NULL.
+ * @param[in] pParam     a parameter that will be passed to pCallback.
+ * @return               the number of notifications queued, in which
+ *                       case pCallback will be called, else negative
+ *                       error code, in which case it will not.
+ */
+int32_t uPortGattNotifyBatch(const uPortGattNotifyBatchEntry_t *pEntries,
+                             size_t numEntries,
+                             uPortGattNotifyBatchCallback_t pCallback,
+                             void *pParam);
+
 /** Connect GAP.
  *
  * @param[in] pAddress    pointer to array with address (6 bytes).
@@ -519,6 +633,22 @@ int32_t uPortGattStartDescriptorDiscovery(int32_t connHandle,
                                           uint16_t startHandle,
                                           uPortGattDescriptorDiscoveryCallback_t callback);
 
+/** Start scanning for advertisers.
+ *
+ * @param[in] pFilter   the filter to apply, cannot be NULL.
+ * @param pCallback     the callback for reports that pass the filter.
+ * @param[in] pParam    a parameter that will be passed to pCallback.
+ * @return              zero on success else negative error code.
+ */
+int32_t uPortGattScanStart(const uPortGattScanFilter_t *pFilter,
+                           uPortGattScanCallback_t pCallback,
+                           void *pParam);
+
+/** Stop scanning; once this returns the callback passed to
+ * uPortGattScanStart() will not be called again.
+ */
+void uPortGattScanStop(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -33,6 +33,14 @@
  * port code, or you may just leave them as they are (in which case
  * malloc() and free() for your platform will be called by the
  * default implementation).
+ *
+ * Tagged versions, pUPortMallocTagged() and uPortFreeTagged(), are
+ * also provided: these keep a count of the memory currently, and at
+ * peak, allocated for each tag, see uPortHeapTagGetStats(), and the
+ * memory for a tag may be taken from an arena of your choice, e.g.
+ * a fixed-block pool in a particular RAM bank, see
+ * uPortHeapTagSetArena() and uPortHeapPoolInit().  Memory allocated
+ * with pUPortMallocTagged() MUST be freed with uPortFreeTagged().
  */
 
 #ifdef __cplusplus
@@ -47,6 +55,69 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The tags that heap allocations may be made with, used by ubxlib
+ * internally; #U_PORT_HEAP_TAG_APP and onwards are free for
+ * application use.
+ */
+typedef enum {
+    U_PORT_HEAP_TAG_GNSS,
+    U_PORT_HEAP_TAG_CELL_SOCK,
+    U_PORT_HEAP_TAG_CELL_MQTT,
+    U_PORT_HEAP_TAG_APP,
+    U_PORT_HEAP_TAG_APP_1,
+    U_PORT_HEAP_TAG_APP_2,
+    U_PORT_HEAP_TAG_APP_3,
+    U_PORT_HEAP_TAG_MAX_NUM
+} uPortHeapTag_t;
+
+/** The state of one of the fixed-block pools of the static heap,
+ * see uPortHeapStaticGetStats().
+ */
+typedef struct {
+    size_t blockSizeBytes; /**< the size of a block in this pool. */
+    size_t numBlocks;      /**< the number of blocks in this pool. */
+    size_t numFree;        /**< the number of blocks currently free. */
+    size_t minFree;        /**< the minimum number of blocks ever free. */
+    size_t numFailed;      /**< the number of allocations that would
+                                have been from this pool, but failed
+                                because no block was free here or in
+                                any pool of larger block size. */
+} uPortHeapStaticStats_t;
+
+/** The accounting for a heap tag, see uPortHeapTagGetStats().  The
+ * byte counts are of the memory requested, i.e. not including any
+ * overhead.
+ */
+typedef struct {
+    size_t currentBytes;       /**< the memory currently allocated. */
+    size_t peakBytes;          /**< the most memory ever allocated. */
+    size_t currentAllocations; /**< the number of blocks currently allocated. */
+    size_t failedAllocations;  /**< the number of allocations that failed. */
+} uPortHeapTagStats_t;
+
+/** An arena from which the memory for a heap tag is taken, see
+ * uPortHeapTagSetArena(); the functions must be thread-safe.
+ */
+typedef struct {
+    /** Allocate memory: must return at least sizeBytes of memory,
+     * aligned for the worst-case structure type, or NULL. */
+    void *(*pMalloc)(void *pContext, size_t sizeBytes);
+    /** Free memory that was returned by pMalloc(), never NULL. */
+    void (*pFree)(void *pContext, void *pMemory);
+    /** The context passed to pMalloc() and pFree(). */
+    void *pContext;
+} uPortHeapArena_t;
+
+/** A fixed-block pool, see uPortHeapPoolInit(): a deterministic
+ * arena for a heap tag.  The contents of this structure should
+ * not be relied upon by the caller.
+ */
+typedef struct {
+    void *pFreeList;       /**< the first free block. */
+    size_t blockSizeBytes; /**< the size of a block, including overhead. */
+    size_t numFree;        /**< the number of blocks free. */
+} uPortHeapPool_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -72,6 +143,105 @@ void *pUPortMalloc(size_t sizeBytes);
  */
 void uPortFree(void *pMemory);
 
+/** Get the state of one of the fixed-block pools of the static heap,
+ * see #U_CFG_HEAP_STATIC in u_cfg_sw.h.  Pools with no blocks are
+ * not reported.
+ *
+ * @param index       the index of the pool, starting at zero with
+ *                    the pool of smallest block size.
+ * @param[out] pStats a place to put the state of the pool, cannot
+ *                    be NULL.
+ * @return            zero on success else negative error code:
+ *                    #U_ERROR_COMMON_NOT_SUPPORTED if #U_CFG_HEAP_STATIC
+ *                    is not defined, #U_ERROR_COMMON_INVALID_PARAMETER
+ *                    if index is beyond the last pool.
+ */
+int32_t uPortHeapStaticGetStats(size_t index, uPortHeapStaticStats_t *pStats);
+
+/** Allocate memory for a given tag: as pUPortMalloc() but the memory
+ * is accounted for against the tag and is taken from the arena set
+ * for that tag with uPortHeapTagSetArena(), else from pUPortMalloc().
+ * There is an overhead of a few bytes, for alignment, per allocation.
+ *
+ * @param tag       the tag to allocate the memory for.
+ * @param sizeBytes the amount of memory required in bytes.
+ * @return          a pointer to at least sizeBytes of memory,
+ *                  aligned for the worst-case structure-type
+ *                  alignment, else NULL.
+ */
+void *pUPortMallocTagged(uPortHeapTag_t tag, size_t sizeBytes);
+
+/** Free memory that was allocated by pUPortMallocTagged(); memory
+ * allocated with pUPortMalloc() must NOT be passed to this function.
+ *
+ * @param[in] pMemory a pointer to a block of memory that was
+ *                    returned by pUPortMallocTagged(); may be NULL.
+ */
+void uPortFreeTagged(void *pMemory);
+
+/** Set the arena that the memory for a tag is to be taken from;
+ * this may only be done while nothing is allocated for the tag.
+ *
+ * @param tag          the tag.
+ * @param[in] pArena   the arena, which is copied; use NULL to
+ *                     return to using pUPortMalloc()/uPortFree().
+ * @return             zero on success else negative error code;
+ *                     #U_ERROR_COMMON_TEMPORARY_FAILURE if memory is currently
+ *                     allocated for the tag.
+ */
+int32_t uPortHeapTagSetArena(uPortHeapTag_t tag,
+                             const uPortHeapArena_t *pArena);
+
+/** Get the accounting for a tag.
+ *
+ * @param tag          the tag.
+ * @param[out] pStats  a place to put the accounting, cannot be NULL.
+ * @return             zero on success else negative error code.
+ */
+int32_t uPortHeapTagGetStats(uPortHeapTag_t tag,
+                             uPortHeapTagStats_t *pStats);
+
+/** Initialise a fixed-block pool in the given buffer, for use as
+ * the arena of a tag: allocation from, and freeing to, the pool
+ * takes a fixed, short, time and an allocation of more than
+ * blockSizeBytes always fails.  Use the pool with a tag by setting
+ * the pMalloc and pFree members of #uPortHeapArena_t to
+ * pUPortHeapPoolMalloc() and uPortHeapPoolFree(), and pContext to
+ * pPool.  Note that pUPortMallocTagged() adds its overhead to the
+ * size requested of the arena, hence blockSizeBytes should be a
+ * few bytes larger than the largest block you expect to allocate.
+ *
+ * @param[out] pPool        the pool, cannot be NULL.
+ * @param[in] pBuffer       the memory for the pool, which must remain
+ *                          valid while the pool is in use and must
+ *                          be aligned for the worst-case structure
+ *                          type; cannot be NULL.
+ * @param bufferSizeBytes   the amount of memory at pBuffer.
+ * @param blockSizeBytes    the size of each block; will be rounded up
+ *                          for alignment.
+ * @return                  the number of blocks in the pool, else
+ *                          negative error code.
+ */
+int32_t uPortHeapPoolInit(uPortHeapPool_t *pPool, void *pBuffer,
+                          size_t bufferSizeBytes, size_t blockSizeBytes);
+
+/** Allocate a block from a pool, for use as the pMalloc member
+ * of #uPortHeapArena_t.
+ *
+ * @param[in] pContext a pointer to the uPortHeapPool_t.
+ * @param sizeBytes    the amount of memory required in bytes.
+ * @return             a pointer to the block, else NULL.
+ */
+void *pUPortHeapPoolMalloc(void *pContext, size_t sizeBytes);
+
+/** Free a block to a pool, for use as the pFree member of
+ * #uPortHeapArena_t.
+ *
+ * @param[in] pContext a pointer to the uPortHeapPool_t.
+ * @param[in] pMemory  the block, as returned by pUPortHeapPoolMalloc().
+ */
+void uPortHeapPoolFree(void *pContext, void *pMemory);
+
 #ifdef __cplusplus
 }
 #endif
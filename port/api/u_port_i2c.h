@@ -56,10 +56,55 @@ extern "C" {
 # define U_PORT_I2C_TIMEOUT_MILLISECONDS 10
 #endif
 
+#ifndef U_PORT_I2C_ASYNC_MAX_NUM
+/** The maximum number of I2C instances that may have
+ * uPortI2cControllerSendReceiveAsync() operations in use at any
+ * one time.
+ */
+# define U_PORT_I2C_ASYNC_MAX_NUM 2
+#endif
+
+#ifndef U_PORT_I2C_ASYNC_QUEUE_LENGTH
+/** The number of uPortI2cControllerSendReceiveAsync() operations
+ * that may be outstanding on an I2C instance at any one time; a
+ * further call will block until there is room.
+ */
+# define U_PORT_I2C_ASYNC_QUEUE_LENGTH 4
+#endif
+
+#ifndef U_PORT_I2C_ASYNC_TASK_STACK_SIZE_BYTES
+/** The stack size of the task, one per I2C instance, that
+ * performs uPortI2cControllerSendReceiveAsync() operations and
+ * calls the completion callback.
+ */
+# define U_PORT_I2C_ASYNC_TASK_STACK_SIZE_BYTES 1536
+#endif
+
+#ifndef U_PORT_I2C_ASYNC_TASK_PRIORITY
+/** The priority of the task, one per I2C instance, that
+ * performs uPortI2cControllerSendReceiveAsync() operations and
+ * calls the completion callback.
+ */
+# define U_PORT_I2C_ASYNC_TASK_PRIORITY (U_CFG_OS_PRIORITY_MAX - 5)
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** Callback that is called when a
+ * uPortI2cControllerSendReceiveAsync() operation has completed.
+ *
+ * @param handle             the handle of the I2C instance.
+ * @param errorCodeOrLength  what uPortI2cControllerSendReceive()
+ *                           would have returned.
+ * @param[in] pParam         the parameter that was passed to
+ *                           uPortI2cControllerSendReceiveAsync().
+ */
+typedef void (uPortI2cCallback_t)(int32_t handle,
+                                  int32_t errorCodeOrLength,
+                                  void *pParam);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -252,6 +297,43 @@ int32_t uPortI2cControllerSendReceive(int32_t handle, uint16_t address,
                                       const char *pSend, size_t bytesToSend,
                                       char *pReceive, size_t bytesToReceive);
 
+/** As uPortI2cControllerSendReceive() but without waiting for
+ * the transfer to complete: the transfer is performed, in order
+ * with any other uPortI2cControllerSendReceiveAsync() operations
+ * on the same I2C instance, by a task of its own, where the
+ * underlying driver may use DMA or interrupts, and pCallback is
+ * called from that task once the transfer has completed.  The
+ * buffers at pSend and pReceive must remain valid until pCallback
+ * has been called.  Other I2C operations on the same I2C instance
+ * may be performed while an asynchronous transfer is outstanding,
+ * they simply wait their turn.  Any outstanding transfers are
+ * completed before the I2C instance is closed.
+ *
+ * @param handle             the handle of the I2C instance.
+ * @param address            the I2C address, as for
+ *                           uPortI2cControllerSendReceive().
+ * @param pSend              a pointer to the data to send, as for
+ *                           uPortI2cControllerSendReceive().
+ * @param bytesToSend        the number of bytes to send, as for
+ *                           uPortI2cControllerSendReceive().
+ * @param pReceive           a pointer to the receive buffer, as for
+ *                           uPortI2cControllerSendReceive().
+ * @param bytesToReceive     the size of the buffer pointed to by
+ *                           pReceive, as for
+ *                           uPortI2cControllerSendReceive().
+ * @param[in] pCallback      the callback to be called when the transfer
+ *                           has completed, may be NULL.
+ * @param[in] pCallbackParam a parameter that will be passed to
+ *                           pCallback.
+ * @return                   zero if the transfer has been queued
+ *                           else negative error code.
+ */
+int32_t uPortI2cControllerSendReceiveAsync(int32_t handle, uint16_t address,
+                                           const char *pSend, size_t bytesToSend,
+                                           char *pReceive, size_t bytesToReceive,
+                                           uPortI2cCallback_t *pCallback,
+                                           void *pCallbackParam);
+
 /** Perform just a send over the I2C interface as a controller, with the
  * option of omitting the stop marker on the end.
  * Note that the NRF52 and NRF53 chips require the buffer to be in RAM.
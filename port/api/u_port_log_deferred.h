@@ -0,0 +1,125 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_PORT_LOG_DEFERRED_H_
+#define _U_PORT_LOG_DEFERRED_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup __port
+ *  @{
+ */
+
+/** @file
+ * @brief Deferred logging.  If #U_CFG_LOG_DEFERRED is defined then
+ * uPortLog() maps to uPortLogDeferredF() which, rather than
+ * formatting the log print there and then, copies the format string
+ * pointer and the raw arguments onto an OS queue; a low-priority task,
+ * started with uPortLogDeferredStart(), takes them off the queue,
+ * formats them and sends them out through uPortLogF().  This takes
+ * the cost of formatting, and of a slow console, out of the timing
+ * of the code that is logging.
+ *
+ * The format string must be a string literal (as all those in ubxlib
+ * are), since only the pointer is queued; strings passed as
+ * arguments for "%s" are copied, truncated if the arguments would
+ * not otherwise fit into #U_PORT_LOG_DEFERRED_ARGS_MAX_LENGTH_BYTES;
+ * arguments beyond that are replaced by "...".  "%n" is not
+ * supported.
+ *
+ * Until uPortLogDeferredStart() has been called, and after
+ * uPortLogDeferredStop(), uPortLogDeferredF() formats in the
+ * context of the caller, as uPortLogF() does.  Calls made directly
+ * to uPortLogF() are never deferred and so may appear out of order
+ * with respect to deferred ones.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_PORT_LOG_DEFERRED_ARGS_MAX_LENGTH_BYTES
+/** The room for the arguments of a single log print, including
+ * the copies of any strings.
+ */
+# define U_PORT_LOG_DEFERRED_ARGS_MAX_LENGTH_BYTES 56
+#endif
+
+#ifndef U_PORT_LOG_DEFERRED_QUEUE_LENGTH
+/** The number of log prints that may be waiting to be formatted;
+ * each occupies a little more than
+ * #U_PORT_LOG_DEFERRED_ARGS_MAX_LENGTH_BYTES.
+ */
+# define U_PORT_LOG_DEFERRED_QUEUE_LENGTH 32
+#endif
+
+#ifndef U_PORT_LOG_DEFERRED_TASK_STACK_SIZE_BYTES
+/** The stack size of the task that formats the log prints; this
+ * must be large enough for the platform's printf().
+ */
+# define U_PORT_LOG_DEFERRED_TASK_STACK_SIZE_BYTES 2048
+#endif
+
+#ifndef U_PORT_LOG_DEFERRED_TASK_PRIORITY
+/** The priority of the task that formats the log prints: as low
+ * as possible.
+ */
+# define U_PORT_LOG_DEFERRED_TASK_PRIORITY U_CFG_OS_PRIORITY_MIN
+#endif
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Start deferred logging; uPortInit() must have been called.
+ * Should not be called at the same time as uPortLogDeferredStop().
+ *
+ * @param dropWhenFull if true then, when the queue is full, a log
+ *                     print is dropped (and counted, see
+ *                     uPortLogDeferredGetDropped()) rather than the
+ *                     caller being blocked until there is room.
+ * @return             zero on success else negative error code.
+ */
+int32_t uPortLogDeferredStart(bool dropWhenFull);
+
+/** Stop deferred logging, printing everything that has been queued
+ * first; must be called before uPortDeinit().
+ */
+void uPortLogDeferredStop();
+
+/** Get the number of log prints that have been dropped since
+ * uPortLogDeferredStart() was called.
+ *
+ * @return the number of dropped log prints.
+ */
+int32_t uPortLogDeferredGetDropped();
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_PORT_LOG_DEFERRED_H_
+
+// End of file
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_PORT_PERF_COUNTER_H_
+#define _U_PORT_PERF_COUNTER_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup __port
+ *  @{
+ */
+
+/** @file
+ * @brief Porting layer for the CPU cycle counter, for measuring
+ * the processor time taken by a piece of code as opposed to the
+ * wall-clock time that uPortGetTickTimeUs() gives.  The counter
+ * is the DWT CYCCNT register on Cortex-M (STM32F4, nRF52), CCOUNT
+ * on ESP32, the k_cycle_get_32() counter of the system timer on
+ * Zephyr (which, depending on the SoC, may run at less than the CPU
+ * clock rate, e.g. 32,768 Hz on nRF5x) and the performance counter
+ * on Windows; uPortPerfCounterGetFrequencyHz() tells you the rate.
+ *
+ * The counter is a free-running 32-bit value, enabled by
+ * uPortInit(), that wraps: at 240 MHz that is every 18 seconds,
+ * so intervals measured with it must be shorter than that.  Note
+ * that it counts all cycles of the CPU, including those spent in
+ * other tasks or interrupts during the interval, though it does
+ * not count while the core is asleep (e.g. in WFI when idle on
+ * Cortex-M); to separate processor time from waiting, stop the
+ * counter across the waits with uPortPerfCounterStop() and start
+ * it again afterwards with uPortPerfCounterStart().
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A cycle counter which accumulates over any number of
+ * start/stop intervals; initialise it with
+ * uPortPerfCounterReset() (or to all zeroes) before use.
+ */
+typedef struct {
+    uint64_t totalCycles;  /**< the total cycles over the intervals
+                                that have been stopped. */
+    uint32_t startCycles;  /**< the cycle count at the start of the
+                                current interval. */
+    uint32_t numIntervals; /**< the number of intervals stopped. */
+    bool running;          /**< true if an interval is in progress. */
+} uPortPerfCounter_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS: PLATFORM SPECIFIC
+ * -------------------------------------------------------------- */
+
+/** Get the current value of the cycle counter of the platform;
+ * this may be called from interrupt context.  If the platform has
+ * no cycle counter zero is returned.
+ *
+ * @return the current cycle count.
+ */
+uint32_t uPortPerfCounterGetCycles();
+
+/** Get the rate at which the value returned by
+ * uPortPerfCounterGetCycles() increments.
+ *
+ * @return the frequency of the counter in Hertz else negative
+ *         error code, e.g. #U_ERROR_COMMON_NOT_SUPPORTED if
+ *         the platform has no cycle counter.
+ */
+int32_t uPortPerfCounterGetFrequencyHz();
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS: GENERIC
+ * -------------------------------------------------------------- */
+
+/** Reset a cycle counter to zero, stopping it if it is running.
+ *
+ * @param[out] pCounter the counter; cannot be NULL.
+ */
+void uPortPerfCounterReset(uPortPerfCounter_t *pCounter);
+
+/** Start an interval on a cycle counter; does nothing if the
+ * counter is already running.
+ *
+ * @param[in,out] pCounter the counter; cannot be NULL.
+ */
+void uPortPerfCounterStart(uPortPerfCounter_t *pCounter);
+
+/** Stop the interval in progress on a cycle counter and add it
+ * to the total; does nothing if the counter is not running.
+ *
+ * @param[in,out] pCounter the counter; cannot be NULL.
+ * @return                 the cycles in the interval just
+ *                         stopped, zero if the counter was not
+ *                         running.
+ */
+uint32_t uPortPerfCounterStop(uPortPerfCounter_t *pCounter);
+
+/** Read the total cycles accumulated by a cycle counter,
+ * including any interval in progress.
+ *
+ * @param[in] pCounter the counter; cannot be NULL.
+ * @return             the total cycles.
+ */
+uint64_t uPortPerfCounterRead(const uPortPerfCounter_t *pCounter);
+
+/** Convert a number of cycles to microseconds using
+ * uPortPerfCounterGetFrequencyHz().
+ *
+ * @param cycles the number of cycles.
+ * @return       the number of microseconds, zero if the platform
+ *               has no cycle counter.
+ */
+int64_t uPortPerfCounterCyclesToUs(uint64_t cycles);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_PORT_PERF_COUNTER_H_
+
+// End of file
@@ -58,6 +58,37 @@ extern "C" {
 # define U_PORT_UART_WRITE_TIMEOUT_MS 30000
 #endif
 
+#ifndef U_PORT_UART_WRITE_ASYNC_MAX_NUM
+/** The maximum number of UART instances that may have
+ * uPortUartWriteAsync() operations in use at any one time.
+ */
+# define U_PORT_UART_WRITE_ASYNC_MAX_NUM 4
+#endif
+
+#ifndef U_PORT_UART_WRITE_ASYNC_QUEUE_LENGTH
+/** The number of uPortUartWriteAsync() operations that may be
+ * outstanding on a UART instance at any one time; a further
+ * call to uPortUartWriteAsync() will block until there is room.
+ */
+# define U_PORT_UART_WRITE_ASYNC_QUEUE_LENGTH 8
+#endif
+
+#ifndef U_PORT_UART_WRITE_ASYNC_TASK_STACK_SIZE_BYTES
+/** The stack size of the task, one per UART instance, that
+ * performs uPortUartWriteAsync() operations and calls the
+ * completion callback.
+ */
+# define U_PORT_UART_WRITE_ASYNC_TASK_STACK_SIZE_BYTES 1536
+#endif
+
+#ifndef U_PORT_UART_WRITE_ASYNC_TASK_PRIORITY
+/** The priority of the task, one per UART instance, that
+ * performs uPortUartWriteAsync() operations and calls the
+ * completion callback.
+ */
+# define U_PORT_UART_WRITE_ASYNC_TASK_PRIORITY (U_CFG_OS_PRIORITY_MAX - 5)
+#endif
+
 /** The event which means that received data is available; this
  * will be sent if the receive buffer goes from empty to containing
  * one or more bytes of received data. It is used as a bit-mask.
@@ -69,6 +100,27 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** Callback that is called when a uPortUartWriteAsync() operation
+ * has completed.
+ *
+ * @param handle           the handle of the UART instance.
+ * @param sizeOrErrorCode  the number of bytes sent or negative
+ *                         error code, as uPortUartWrite() would
+ *                         have returned.
+ * @param[in] pParam       the parameter that was passed to
+ *                         uPortUartWriteAsync().
+ */
+typedef void (uPortUartWriteCallback_t)(int32_t handle,
+                                        int32_t sizeOrErrorCode,
+                                        void *pParam);
+
+/** A piece of data to be sent by uPortUartWriteV().
+ */
+typedef struct {
+    const void *pBuffer;
+    size_t sizeBytes;
+} uPortUartWriteVector_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -178,6 +230,46 @@ int32_t uPortUartGetReceiveSize(int32_t handle);
 int32_t uPortUartRead(int32_t handle, void *pBuffer,
                       size_t sizeBytes);
 
+/** Get a pointer to data received by the given UART instance
+ * WITHOUT copying it out of the UART's receive buffer, allowing
+ * the data to be parsed in place; non-blocking.  The span
+ * returned starts with the oldest received byte and is
+ * contiguous: where the data in the receive buffer wraps around
+ * the end of the buffer only the data up to the end is returned,
+ * call this function again after uPortUartConsume() to get the
+ * rest.  The data remains in the receive buffer, and the pointer
+ * remains valid, until it is consumed with uPortUartConsume();
+ * calling uPortUartPeekSpan() again before then returns the same
+ * span, potentially longer if more data has arrived.  Use either
+ * this function or uPortUartRead() on a given UART, not both at
+ * the same time, and from a single task.  Note that NOT ALL
+ * PLATFORMS support this API: where it is not implemented
+ * #U_ERROR_COMMON_NOT_SUPPORTED will be returned, in which
+ * case use uPortUartRead().
+ *
+ * @param handle      the handle of the UART instance.
+ * @param[out] ppData a place to put a pointer to the received
+ *                    data; cannot be NULL.  Set to NULL if
+ *                    there is no data.
+ * @return            the number of contiguous bytes at *ppData,
+ *                    else negative error code.
+ */
+int32_t uPortUartPeekSpan(int32_t handle, const char **ppData);
+
+/** Free space in the receive buffer of the given UART instance
+ * that is occupied by data obtained with uPortUartPeekSpan();
+ * after this call the data may be overwritten.  Note that NOT ALL
+ * PLATFORMS support this API: where it is not implemented
+ * #U_ERROR_COMMON_NOT_SUPPORTED will be returned.
+ *
+ * @param handle    the handle of the UART instance.
+ * @param sizeBytes the number of bytes to consume, cannot be more
+ *                  than the number obtained from the last call to
+ *                  uPortUartPeekSpan().
+ * @return          zero on success else negative error code.
+ */
+int32_t uPortUartConsume(int32_t handle, size_t sizeBytes);
+
 /** Write to the given UART interface.  Will block until
  * all of the data has been written or an error has occurred.
  *
@@ -190,6 +282,54 @@ int32_t uPortUartRead(int32_t handle, void *pBuffer,
 int32_t uPortUartWrite(int32_t handle, const void *pBuffer,
                        size_t sizeBytes);
 
+/** Write to the given UART interface without waiting for the
+ * data to be sent: the data is sent, in order with the data of
+ * any other uPortUartWriteAsync() operations on the same UART
+ * instance, by a task of its own, where the underlying driver
+ * may use DMA or interrupts, and pCallback is called from that
+ * task once the send has completed.  This allows, for instance,
+ * the caller to prepare for the response while a large block of
+ * data is being transmitted.  The data at pBuffer must remain
+ * valid until pCallback has been called.  uPortUartWrite() should
+ * not be called on the same UART instance while a
+ * uPortUartWriteAsync() operation is outstanding, since the
+ * order in which the data is sent would then be undefined.
+ * Any outstanding operations are completed before the UART
+ * instance is closed.
+ *
+ * @param handle             the handle of the UART instance.
+ * @param[in] pBuffer        a pointer to a buffer of data to send;
+ *                           cannot be NULL.
+ * @param sizeBytes          the number of bytes in pBuffer.
+ * @param[in] pCallback      the callback to be called when the send
+ *                           has completed, may be NULL.
+ * @param[in] pCallbackParam a parameter that will be passed to
+ *                           pCallback.
+ * @return                   zero if the write has been queued else
+ *                           negative error code.
+ */
+int32_t uPortUartWriteAsync(int32_t handle, const void *pBuffer,
+                            size_t sizeBytes,
+                            uPortUartWriteCallback_t *pCallback,
+                            void *pCallbackParam);
+
+/** Write a number of separate buffers to the given UART interface,
+ * one after the other, blocking in the same way as uPortUartWrite();
+ * this saves the caller assembling the data into a single buffer.
+ * Note that another task writing to the same UART instance at the
+ * same time may have its data sent between the buffers.
+ *
+ * @param handle        the handle of the UART instance.
+ * @param[in] pVector   an array of the buffers to send; cannot
+ *                      be NULL.
+ * @param count         the number of entries in pVector.
+ * @return              the total number of bytes sent or negative
+ *                      error code.
+ */
+int32_t uPortUartWriteV(int32_t handle,
+                        const uPortUartWriteVector_t *pVector,
+                        size_t count);
+
 /** Set a callback to be called when a UART event occurs.
  * pFunction will be called asynchronously in its own task,
  * for which the stack size and priority can be specified.
@@ -334,6 +474,32 @@ bool uPortUartEventIsCallback(int32_t handle);
  */
 int32_t uPortUartEventStackMinFree(int32_t handle);
 
+/** Ask that #U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED is only
+ * passed to the event callback of the given UART instance once
+ * a delimiter character (e.g. '\n', the end of an AT line) has
+ * been received, rather than each time a few characters have
+ * arrived; this reduces the number of times the event callback
+ * runs when the received data is line-based.  If data is received
+ * but no delimiter follows within timeoutMs the event is passed
+ * on anyway, so nothing is left sitting in the receive buffer.
+ * Events sent with uPortUartEventSend()/uPortUartEventTrySend()
+ * are not affected.  This may only be called while an event
+ * callback is set; the delimiter is forgotten when the event
+ * callback is removed.  Note that NOT ALL PLATFORMS support this
+ * API: where it is not implemented #U_ERROR_COMMON_NOT_SUPPORTED
+ * will be returned and the event callback behaves as normal.
+ *
+ * @param handle    the handle of the UART instance.
+ * @param delimiter the delimiter character, 0 to 255, or negative
+ *                  to go back to passing on all data events.
+ * @param timeoutMs how long to wait for a delimiter after data
+ *                  is received before passing the event on anyway;
+ *                  ignored if delimiter is negative.
+ * @return          zero on success else negative error code.
+ */
+int32_t uPortUartEventDelimiterSet(int32_t handle, int32_t delimiter,
+                                   int32_t timeoutMs);
+
 /** Determine if RTS flow control, that is a signal from
  * the module to this software that the module is ready to
  * receive data, is enabled.
@@ -15,18 +15,20 @@
  */
 
 /** @file
- * @brief an implementation of mktime() with a 64-bit return value.
+ * @brief an implementation of mktime() with a 64-bit return value
+ * and of its inverse, gmtime64_r().
  */
 
 #ifdef U_CFG_OVERRIDE
 # include "u_cfg_override.h" // For a customer's configuration override
 #endif
 
+#include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
 #include "time.h"      // struct tm
 
-#include "u_time.h"    // uTimeMonthsToSecondsUtc()
+#include "u_time.h"    // uTimeBrokenDownToSecondsUtc(), uTimeSecondsUtcToBrokenDown()
 
 #include "u_port_clib_mktime64.h"
 
@@ -54,30 +56,45 @@
 // const, need to follow function signature.
 int64_t mktime64(struct tm *pTm)
 {
-    int64_t answer = 0;
-    int32_t year;
-    int32_t months;
-
-    // TM has years since 1900, so convert to since 1970
-    year = pTm->tm_year - 70;
-    // Months since January 0-11
-    months = pTm->tm_mon;
-    months += year * 12;
-    // Work out the number of seconds due to the year/month count
-    answer += uTimeMonthsToSecondsUtc(months);
-    // Day (1 to 31)
-    answer += (((int64_t) pTm->tm_mday) - 1) * 3600 * 24;
-    // Hours (0 to 23)
-    answer += ((int64_t) pTm->tm_hour) * 3600;
-    // Minutes (0 to 59)
-    answer += ((int64_t) pTm->tm_min) * 60;
-    // Seconds (0 to 59ish)
-    answer += pTm->tm_sec;
+    uTimeBrokenDown_t brokenDown;
+
+    // TM has years since 1900 and months since January 0-11;
+    // out of range values simply carry, as before
+    brokenDown.year = pTm->tm_year + 1900;
+    brokenDown.month = pTm->tm_mon + 1;
+    brokenDown.day = pTm->tm_mday;
+    brokenDown.hour = pTm->tm_hour;
+    brokenDown.minute = pTm->tm_min;
+    brokenDown.second = pTm->tm_sec;
     // Since this function returns local time
     // the Daylight Saving Time flag has no
     // effect on the answer.
 
-    return answer;
+    return uTimeBrokenDownToSecondsUtc(&brokenDown);
+}
+
+// The inverse of mktime64(): convert seconds since 1970 into a
+// struct tm, in constant time.
+struct tm *gmtime64_r(const int64_t *pTime, struct tm *pTm)
+{
+    uTimeBrokenDown_t brokenDown;
+
+    if ((pTime != NULL) && (pTm != NULL)) {
+        uTimeSecondsUtcToBrokenDown(*pTime, &brokenDown);
+        pTm->tm_year = brokenDown.year - 1900;
+        pTm->tm_mon = brokenDown.month - 1;
+        pTm->tm_mday = brokenDown.day;
+        pTm->tm_hour = brokenDown.hour;
+        pTm->tm_min = brokenDown.minute;
+        pTm->tm_sec = brokenDown.second;
+        pTm->tm_wday = brokenDown.weekDay;
+        pTm->tm_yday = brokenDown.yearDay;
+        pTm->tm_isdst = 0;
+    } else {
+        pTm = NULL;
+    }
+
+    return pTm;
 }
 
 // End of file
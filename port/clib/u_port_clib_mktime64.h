@@ -49,6 +49,17 @@ extern "C" {
  */
 int64_t mktime64(struct tm *pTm);
 
+/** The inverse of mktime64(): gmtime_r() with a guaranteed 64-bit
+ * input.  Runs in constant time.
+ *
+ * @param[in] pTime the number of seconds since midnight on
+ *                  1st January 1970; cannot be NULL.
+ * @param[out] pTm  a place to put the broken-down time; cannot be
+ *                  NULL.
+ * @return          pTm, or NULL if either parameter was NULL.
+ */
+struct tm *gmtime64_r(const int64_t *pTime, struct tm *pTm);
+
 #ifdef __cplusplus
 }
 #endif
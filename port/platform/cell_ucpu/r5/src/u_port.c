@@ -36,6 +36,7 @@
 #include "u_port.h"
 #include "u_port_os.h"
 #include "u_port_uart.h"
+#include "u_port_perf_counter.h"
 #include "u_port_event_queue_private.h"
 #include "u_port_private.h"
 #include "u_assert.h"
@@ -206,6 +207,26 @@ int32_t uPortGetTickTimeMs()
     return tx_time_get();
 }
 
+// Get the current high resolution time in microseconds: there
+// is nothing better than the OS tick here.
+int64_t uPortGetTickTimeUs()
+{
+    return (int64_t) tx_time_get() * 1000;
+}
+
+// Get the current value of the cycle counter: not available
+// to a uCPU application.
+uint32_t uPortPerfCounterGetCycles()
+{
+    return 0;
+}
+
+// Get the frequency of the cycle counter.
+int32_t uPortPerfCounterGetFrequencyHz()
+{
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
 // Get the minimum amount of heap free, ever, in bytes.
 int32_t uPortGetHeapMinFree()
 {
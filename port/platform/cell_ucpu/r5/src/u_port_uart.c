@@ -31,6 +31,7 @@
 #include "u_port_os.h"
 #include "u_port_uart.h"
 #include "u_port_event_queue.h"
+#include "u_port_uart_async_private.h"
 #include "u_port_clib_platform_specific.h"
 
 #include "ucpu_sdk_modem_uart.h"
@@ -231,12 +232,19 @@ int32_t uPortUartInit()
         }
     }
 
+    if (errorCode == U_ERROR_COMMON_SUCCESS) {
+        errorCode = uPortUartAsyncPrivateInit();
+    }
+
     return errorCode;
 }
 
 // Deinitialise the UART driver.
 void uPortUartDeinit()
 {
+    // Complete any asynchronous writes first, they need the mutex
+    uPortUartAsyncPrivateDeinit();
+
     if (gModemUartMutex != NULL) {
         U_PORT_MUTEX_LOCK(gModemUartMutex);
         // First, mark UART instances for deletion
@@ -402,6 +410,9 @@ void uPortUartClose(int32_t handle)
 {
     int32_t errorCode;
 
+    // Complete any asynchronous writes first, they need the mutex
+    uPortUartAsyncPrivateClose(handle);
+
     if ((handle > 0) &&
         (gModemUartMutex != NULL) &&
         (!gModemUartContext.markedForDeletion)) {
@@ -559,6 +570,22 @@ int32_t uPortUartRead(int32_t handle, void *pBuffer,
     return errorCodeOrSize;
 }
 
+// Get the contiguous span of received data: not supported.
+int32_t uPortUartPeekSpan(int32_t handle, const char **ppData)
+{
+    (void) handle;
+    (void) ppData;
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
+// Consume received data: not supported.
+int32_t uPortUartConsume(int32_t handle, size_t sizeBytes)
+{
+    (void) handle;
+    (void) sizeBytes;
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
 // Write to the given UART interface.
 int32_t uPortUartWrite(int32_t handle,
                        const void *pBuffer,
@@ -861,6 +888,19 @@ int32_t uPortUartEventStackMinFree(int32_t handle)
     return sizeOrErrorCode;
 }
 
+// Set a delimiter for the data received event.
+int32_t uPortUartEventDelimiterSet(int32_t handle, int32_t delimiter,
+                                   int32_t timeoutMs)
+{
+    (void) handle;
+    (void) delimiter;
+    (void) timeoutMs;
+
+    // Not supported on this platform: events are passed on
+    // as they arrive
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
 // Determine if RTS flow control is enabled.
 bool uPortUartIsRtsFlowControlEnabled(int32_t handle)
 {
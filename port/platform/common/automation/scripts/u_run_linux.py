@@ -4,7 +4,7 @@
 import os                    # For sep(), getcwd(), listdir()
 from logging import Logger
 from tasks import nrfconnect
-from scripts import u_connection, u_monitor, u_report, u_utils
+from scripts import u_connection, u_monitor, u_report, u_utils, u_virtual_modem
 from scripts.u_logging import ULog
 
 # Prefix to put at the start of all prints
@@ -39,6 +39,11 @@ UART_TO_DEVICE_REGEX = r"(?:^UART_([0-9]*) connected to pseudotty: (.*?))$"
 # List of device redirections that need to be terminated when done
 DEVICE_REDIRECTS = []
 
+# A U_CFG_APP_xxx_UART_DEV which starts with this is not a real
+# device but a virtual modem, see u_virtual_modem.py, e.g.
+# U_CFG_APP_CELL_UART_DEV=virtual:sara,latency_ms=2
+VIRTUAL_MODEM_PREFIX = "virtual:"
+
 # The baud rate to use: this is necessary since the redirection process
 # doesn't seem to work for real TTYs unless it is given as a parameter
 # to the socat utility which does the redirection
@@ -163,6 +168,20 @@ def callback(match, uart_to_device_list, results, reporter):
                             device_b = uart_to_device["device_from"]
                             # Mark it as done
                             uart_to_device["done"] = True
+                elif uart_to_device["device_to"].startswith(VIRTUAL_MODEM_PREFIX):
+                    # Rather than a real device, put a virtual modem
+                    # on the end of this UART
+                    message = uart_to_device["type"] + ": " + \
+                              uart_to_device["device_from"] + " (UART_" + \
+                              uart_to_device["uart"] + ") will be connected to " + \
+                              uart_to_device["device_to"]
+                    terminate_queue = u_virtual_modem.start(uart_to_device["device_from"],
+                                                            uart_to_device["device_to"],
+                                                            logger=U_LOG)
+                    if terminate_queue:
+                        DEVICE_REDIRECTS.append(terminate_queue)
+                    # Mark it as done
+                    uart_to_device["done"] = True
                 else:
                     # This is not a looped-back one, it is a simple
                     # forwarding case
@@ -0,0 +1,564 @@
+#!/usr/bin/env python
+
+'''A virtual SARA/NINA/M9 module on the end of a serial port.
+
+This answers AT, EDM and UBX traffic well enough for the host-side
+(Linux/Windows) build of ubxlib to be benchmarked without real
+hardware: connect the ubxlib UART to one end of a virtual serial
+port pair (e.g. a /dev/pts device of the Linux build, which
+u_run_linux.py will do automatically when the UART "device" is
+given as "virtual:sara", or one of a com0com pair on Windows) and
+run this on the other end.  The latency before each response and
+the bandwidth of the link are configurable so that results are
+deterministic.
+
+The responders are deliberately simple: SARA answers the common
+identification commands, supports a loop-back socket through the
++USOCR/+USOWR/+USORD/+USOCL commands (binary or hex mode) and
+answers "OK" (or "ERROR", see --unknown) to anything else; NINA
+does the same in AT mode, switches to EDM on ATO2, answers EDM AT
+requests and echoes EDM data commands back as data events on the
+same channel; M9 ACKs UBX-CFG messages, answers a UBX-MON-VER
+poll and streams UBX-NAV-PVT (and optionally NMEA GGA) at a
+configurable rate, or as fast as the link allows.'''
+
+import sys
+import queue
+import struct
+import argparse
+import threading
+from time import sleep, time
+import serial                   # Pyserial (make sure to do pip install pyserial)
+
+# Prefix to put at the start of all prints
+PROMPT = "u_virtual_modem: "
+
+# The modem types, mapped to their responder classes below
+MODEM_TYPES = ["sara", "nina", "m9"]
+
+# The time to wait for received data in each loop, seconds
+READ_TIMEOUT_SECONDS = 0.01
+
+# How long SARA waits before sending the binary-mode "@" prompt,
+# like the real thing
+SARA_BINARY_PROMPT_DELAY_SECONDS = 0.05
+
+# The maximum number of sockets SARA supports
+SARA_SOCKETS_MAX_NUM = 7
+
+# EDM framing
+EDM_HEAD = 0xAA
+EDM_TAIL = 0x55
+EDM_TYPE_DATA_EVENT = 0x31
+EDM_TYPE_DATA_COMMAND = 0x36
+EDM_TYPE_AT_REQUEST = 0x44
+EDM_TYPE_AT_RESPONSE = 0x45
+EDM_TYPE_START_EVENT = 0x71
+
+# UBX framing
+UBX_SYNC = b"\xb5\x62"
+UBX_CLASS_ACK = 0x05
+UBX_CLASS_CFG = 0x06
+UBX_ID_CFG_VALGET = 0x8b
+UBX_CLASS_MON = 0x0a
+UBX_ID_MON_VER = 0x04
+UBX_CLASS_NAV = 0x01
+UBX_ID_NAV_PVT = 0x07
+UBX_NAV_PVT_LENGTH = 92
+
+class Link():
+    '''A serial port with an emulated latency and bandwidth'''
+    def __init__(self, port, baud_rate, latency_ms, trace=False):
+        self._port = port
+        self._latency_seconds = latency_ms / 1000
+        # 10 bits per byte on the wire
+        self._seconds_per_byte = 0
+        if baud_rate > 0:
+            self._seconds_per_byte = 10 / baud_rate
+        self._trace = trace
+        self.bytes_sent = 0
+        self.bytes_received = 0
+
+    def read(self):
+        '''Read whatever has arrived'''
+        data = self._port.read(max(1, self._port.in_waiting))
+        self.bytes_received += len(data)
+        if self._trace and data:
+            print(PROMPT + "<< {}".format(data))
+        return data
+
+    def write(self, data, delay=True):
+        '''Write data, after the latency and at the bandwidth of the link'''
+        if delay and self._latency_seconds > 0:
+            sleep(self._latency_seconds)
+        if self._trace:
+            print(PROMPT + ">> {}".format(data))
+        self._port.write(data)
+        self.bytes_sent += len(data)
+        if self._seconds_per_byte > 0:
+            sleep(len(data) * self._seconds_per_byte)
+
+class AtResponder():
+    '''The AT command interpreter common to SARA and NINA'''
+    def __init__(self, link, unknown_ok=True):
+        self._link = link
+        self._unknown_ok = unknown_ok
+        self._line = b""
+        self.echo = True
+        self.identity = {"AT+CGMI": "u-blox",
+                         "AT+CGMR": "1.0",
+                         "AT+CGSN": "004999010640000"}
+        self.commands = 0
+
+    def send(self, text, delay=True):
+        '''Send an AT response'''
+        if isinstance(text, str):
+            text = text.encode("latin-1")
+        self._link.write(text, delay)
+
+    def respond(self, command):
+        '''Return the response to a command, None if it was not recognised'''
+        response = None
+        upper = command.upper()
+        if upper in ("AT", "AT&F", "ATZ") or upper.startswith("AT+CMEE") or \
+           upper.startswith("AT&K") or upper.startswith("AT+IPR"):
+            response = "\r\nOK\r\n"
+        elif upper in ("ATE0", "ATE1"):
+            self.echo = upper.endswith("1")
+            response = "\r\nOK\r\n"
+        elif upper in self.identity:
+            response = "\r\n" + self.identity[upper] + "\r\n\r\nOK\r\n"
+        return response
+
+    def command(self, command):
+        '''Handle a complete command line'''
+        self.commands += 1
+        response = self.respond(command)
+        if response is None:
+            response = "\r\nOK\r\n" if self._unknown_ok else "\r\nERROR\r\n"
+        if response:
+            self.send(response)
+
+    def feed(self, data):
+        '''Handle received characters'''
+        for index, byte in enumerate(data):
+            character = bytes([byte])
+            if self.echo:
+                self.send(character, False)
+            if character == b"\r":
+                line = self._line.decode("latin-1").strip()
+                self._line = b""
+                if line:
+                    self.command(line)
+                    # The command may have changed the mode
+                    remaining = data[index + 1:]
+                    if remaining and self.taken_over():
+                        self.feed(remaining)
+                        break
+            elif character != b"\n":
+                self._line += character
+
+    def taken_over(self):
+        '''True if something other than AT now handles received data'''
+        return False
+
+    def tick(self):
+        '''Called periodically'''
+
+    def report(self):
+        '''Return a summary of what has been done'''
+        return "{} AT command(s)".format(self.commands)
+
+class SaraResponder(AtResponder):
+    '''A virtual SARA cellular module with loop-back sockets'''
+    def __init__(self, link, unknown_ok=True):
+        super().__init__(link, unknown_ok)
+        self.identity.update({"AT+CGMM": "SARA-R510M8S",
+                              "AT+CIMI": "222107701772423",
+                              "AT+CCID": "+CCID: 8939107900010087330"})
+        self._hex_mode = False
+        self._sockets = {}
+        self._binary_socket = None
+        self._binary_remaining = 0
+        self._binary_data = b""
+        self.socket_bytes = 0
+
+    def _socket_write(self, socket_id, data):
+        '''Loop data back into a socket and tell the host about it'''
+        self._sockets[socket_id] += data
+        self.socket_bytes += len(data)
+        self.send("\r\n+USOWR: {},{}\r\n\r\nOK\r\n".format(socket_id, len(data)))
+        self.send("\r\n+UUSORD: {},{}\r\n".format(socket_id,
+                                                  len(self._sockets[socket_id])))
+
+    def respond(self, command):
+        response = super().respond(command)
+        if response is None:
+            upper = command.upper()
+            params = command.split("=", 1)[1].split(",") if "=" in command else []
+            if upper.startswith("AT+UDCONF=1,"):
+                self._hex_mode = params[1].strip() == "1"
+                response = "\r\nOK\r\n"
+            elif upper == "AT+UDCONF=1":
+                response = "\r\n+UDCONF: 1,{}\r\n\r\nOK\r\n".format(int(self._hex_mode))
+            elif upper.startswith("AT+USOCR="):
+                response = "\r\nERROR\r\n"
+                for socket_id in range(SARA_SOCKETS_MAX_NUM):
+                    if socket_id not in self._sockets:
+                        self._sockets[socket_id] = b""
+                        response = "\r\n+USOCR: {}\r\n\r\nOK\r\n".format(socket_id)
+                        break
+            elif upper.startswith("AT+USOCL="):
+                self._sockets.pop(int(params[0]), None)
+                response = "\r\nOK\r\n"
+            elif upper.startswith("AT+USOWR=") and len(params) >= 2 and \
+                 int(params[0]) in self._sockets:
+                socket_id = int(params[0])
+                if len(params) > 2:
+                    # Data given in the command, as hex
+                    self._socket_write(socket_id,
+                                       bytes.fromhex(params[2].strip().strip('"')))
+                else:
+                    # Binary mode: prompt for the data
+                    self._binary_socket = socket_id
+                    self._binary_remaining = int(params[1])
+                    self._binary_data = b""
+                    sleep(SARA_BINARY_PROMPT_DELAY_SECONDS)
+                    self.send("@", False)
+                response = ""
+            elif upper.startswith("AT+USORD=") and len(params) >= 2 and \
+                 int(params[0]) in self._sockets:
+                socket_id = int(params[0])
+                length = int(params[1])
+                if length == 0:
+                    response = "\r\n+USORD: {},{}\r\n\r\nOK\r\n". \
+                               format(socket_id, len(self._sockets[socket_id]))
+                else:
+                    data = self._sockets[socket_id][:length]
+                    self._sockets[socket_id] = self._sockets[socket_id][length:]
+                    if self._hex_mode:
+                        payload = data.hex().upper().encode("latin-1")
+                    else:
+                        payload = data
+                    response = "\r\n+USORD: {},{},\"".format(socket_id, len(data)). \
+                               encode("latin-1") + payload + b"\"\r\n\r\nOK\r\n"
+        return response
+
+    def feed(self, data):
+        if self._binary_remaining > 0:
+            taken = data[:self._binary_remaining]
+            self._binary_data += taken
+            self._binary_remaining -= len(taken)
+            data = data[len(taken):]
+            if self._binary_remaining == 0:
+                self._socket_write(self._binary_socket, self._binary_data)
+                self._binary_data = b""
+        if data:
+            super().feed(data)
+
+    def taken_over(self):
+        return self._binary_remaining > 0
+
+    def report(self):
+        return super().report() + ", {} socket byte(s) looped back".format(self.socket_bytes)
+
+class NinaResponder(AtResponder):
+    '''A virtual NINA short-range module, AT and then EDM'''
+    def __init__(self, link, unknown_ok=True):
+        super().__init__(link, unknown_ok)
+        self.identity.update({"AT+CGMM": "NINA-W15X"})
+        self._edm = False
+        self._edm_sending = False
+        self._edm_buffer = b""
+        self.data_bytes = 0
+
+    @staticmethod
+    def edm_frame(edm_type, payload):
+        '''Return an EDM packet'''
+        length = len(payload) + 2
+        return bytes([EDM_HEAD, (length >> 8) & 0x0F, length & 0xFF, 0x00, edm_type]) + \
+               payload + bytes([EDM_TAIL])
+
+    def send(self, text, delay=True):
+        if self._edm_sending:
+            if isinstance(text, str):
+                text = text.encode("latin-1")
+            text = self.edm_frame(EDM_TYPE_AT_RESPONSE, text)
+        super().send(text, delay)
+
+    def respond(self, command):
+        response = super().respond(command)
+        if response is None and command.upper() == "ATO2":
+            self.send("\r\nOK\r\n")
+            self._edm = True
+            self.echo = False
+            self._link.write(self.edm_frame(EDM_TYPE_START_EVENT, b""))
+            response = ""
+        return response
+
+    def taken_over(self):
+        return self._edm
+
+    def feed(self, data):
+        if not self._edm:
+            super().feed(data)
+        else:
+            self._edm_buffer += data
+            keep_going = True
+            while keep_going:
+                start = self._edm_buffer.find(bytes([EDM_HEAD]))
+                keep_going = False
+                if start >= 0:
+                    self._edm_buffer = self._edm_buffer[start:]
+                    if len(self._edm_buffer) >= 3:
+                        length = ((self._edm_buffer[1] & 0x0F) << 8) + self._edm_buffer[2]
+                        if len(self._edm_buffer) >= length + 4:
+                            keep_going = True
+                            if self._edm_buffer[length + 3] == EDM_TAIL and length >= 2:
+                                self._edm_packet(self._edm_buffer[4],
+                                                 self._edm_buffer[5:length + 3])
+                                self._edm_buffer = self._edm_buffer[length + 4:]
+                            else:
+                                # Not a packet after all, move on
+                                self._edm_buffer = self._edm_buffer[1:]
+                else:
+                    self._edm_buffer = b""
+
+    def _edm_packet(self, edm_type, payload):
+        '''Handle a received EDM packet'''
+        if edm_type == EDM_TYPE_AT_REQUEST:
+            self._edm_sending = True
+            self.command(payload.decode("latin-1").strip())
+            self._edm_sending = False
+        elif edm_type == EDM_TYPE_DATA_COMMAND and payload:
+            # Echo the data back on the same channel
+            self.data_bytes += len(payload) - 1
+            self._link.write(self.edm_frame(EDM_TYPE_DATA_EVENT, payload))
+
+    def report(self):
+        return super().report() + ", {} EDM data byte(s) echoed".format(self.data_bytes)
+
+class M9Responder():
+    '''A virtual M9 GNSS module'''
+    def __init__(self, link, nav_rate_hz=1, nmea=False):
+        self._link = link
+        self._buffer = b""
+        self._nmea = nmea
+        self._period_seconds = 0
+        if nav_rate_hz > 0:
+            self._period_seconds = 1 / nav_rate_hz
+        self._flood = nav_rate_hz < 0
+        self._next_time = time()
+        self._itow = 0
+        self.messages_received = 0
+        self.messages_sent = 0
+
+    @staticmethod
+    def ubx_frame(message_class, message_id, payload):
+        '''Return a UBX message'''
+        body = bytes([message_class, message_id]) + struct.pack("<H", len(payload)) + payload
+        ck_a = 0
+        ck_b = 0
+        for byte in body:
+            ck_a = (ck_a + byte) & 0xFF
+            ck_b = (ck_b + ck_a) & 0xFF
+        return UBX_SYNC + body + bytes([ck_a, ck_b])
+
+    @staticmethod
+    def nmea_sentence(body):
+        '''Return an NMEA sentence'''
+        checksum = 0
+        for character in body.encode("ascii"):
+            checksum ^= character
+        return "${}*{:02X}\r\n".format(body, checksum).encode("ascii")
+
+    def _ubx_message(self, message_class, message_id, payload):
+        '''Handle a received UBX message'''
+        self.messages_received += 1
+        if message_class == UBX_CLASS_CFG:
+            # ACK everything except VALGET, for which we have no values
+            ack_id = 0x01 if message_id != UBX_ID_CFG_VALGET else 0x00
+            self._link.write(self.ubx_frame(UBX_CLASS_ACK, ack_id,
+                                            bytes([message_class, message_id])))
+        elif (message_class == UBX_CLASS_MON) and (message_id == UBX_ID_MON_VER) and \
+             not payload:
+            body = b"ROM SPG 5.10 (7b202e)".ljust(30, b"\0") + \
+                   b"000A0000".ljust(10, b"\0") + \
+                   b"PROTVER=34.10".ljust(30, b"\0") + \
+                   b"MOD=NEO-M9N-0".ljust(30, b"\0")
+            self._link.write(self.ubx_frame(message_class, message_id, body))
+
+    def feed(self, data):
+        '''Handle received bytes: only UBX is of interest'''
+        self._buffer += data
+        keep_going = True
+        while keep_going:
+            keep_going = False
+            start = self._buffer.find(UBX_SYNC)
+            if start >= 0:
+                self._buffer = self._buffer[start:]
+                if len(self._buffer) >= 6:
+                    length = struct.unpack_from("<H", self._buffer, 4)[0]
+                    if len(self._buffer) >= length + 8:
+                        self._ubx_message(self._buffer[2], self._buffer[3],
+                                          self._buffer[6:length + 6])
+                        self._buffer = self._buffer[length + 8:]
+                        keep_going = True
+            else:
+                # Keep a trailing 0xB5 in case it is the start of a message
+                self._buffer = self._buffer[-1:] if self._buffer.endswith(UBX_SYNC[:1]) else b""
+
+    def tick(self):
+        '''Send the navigation output if it is due'''
+        now = time()
+        if self._flood or (self._period_seconds > 0 and now >= self._next_time):
+            self._next_time += self._period_seconds
+            if self._next_time < now:
+                self._next_time = now + self._period_seconds
+            self._itow += 1000 if self._period_seconds <= 0 else int(self._period_seconds * 1000)
+            payload = bytearray(UBX_NAV_PVT_LENGTH)
+            struct.pack_into("<I", payload, 0, self._itow & 0xFFFFFFFF)
+            # 3D fix, lat/long of Cambridge, UK
+            payload[20] = 3
+            struct.pack_into("<ii", payload, 24, 1195850, 522236000)
+            self._link.write(self.ubx_frame(UBX_CLASS_NAV, UBX_ID_NAV_PVT, bytes(payload)),
+                             False)
+            self.messages_sent += 1
+            if self._nmea:
+                self._link.write(self.nmea_sentence("GNGGA,000000.00,5213.41600,N,"
+                                                    "00007.17510,E,1,12,0.5,20.0,M,"
+                                                    "47.0,M,,"), False)
+                self.messages_sent += 1
+
+    def report(self):
+        '''Return a summary of what has been done'''
+        return "{} UBX message(s) received, {} message(s) sent". \
+               format(self.messages_received, self.messages_sent)
+
+def responder_create(modem_type, link, unknown_ok=True, nav_rate_hz=1, nmea=False):
+    '''Create the responder for a modem type'''
+    responder = None
+    if modem_type == "sara":
+        responder = SaraResponder(link, unknown_ok)
+    elif modem_type == "nina":
+        responder = NinaResponder(link, unknown_ok)
+    elif modem_type == "m9":
+        responder = M9Responder(link, nav_rate_hz, nmea)
+    return responder
+
+def run(device, modem_type, baud_rate=115200, latency_ms=0, unknown_ok=True,
+        nav_rate_hz=1, nmea=False, terminate_queue=None, logger=None, trace=False):
+    '''Run a virtual modem on a device until terminate_queue has something on it'''
+    return_value = -1
+    terminated = False
+    if logger:
+        logger.info(f"virtual {modem_type} on {device}, {baud_rate} bits/s"
+                    f" (0 = unlimited), {latency_ms} ms latency.")
+    try:
+        with serial.Serial(device, baud_rate if baud_rate > 0 else 115200,
+                           timeout=READ_TIMEOUT_SECONDS) as port:
+            link = Link(port, baud_rate, latency_ms, trace)
+            responder = responder_create(modem_type, link, unknown_ok, nav_rate_hz, nmea)
+            if responder:
+                return_value = 0
+                while not terminated:
+                    data = link.read()
+                    if data:
+                        responder.feed(data)
+                    responder.tick()
+                    if terminate_queue:
+                        try:
+                            terminate_queue.get(block=False)
+                            terminated = True
+                        except queue.Empty:
+                            pass
+                if logger:
+                    logger.info(f"virtual {modem_type}: {responder.report()}, {link.bytes_received}"
+                                f" byte(s) received, {link.bytes_sent} byte(s) sent.")
+    except (serial.SerialException, OSError) as ex:
+        if logger:
+            logger.error(f"virtual {modem_type} on {device}: {ex}.")
+    return return_value
+
+def spec_parse(spec):
+    '''Parse a spec of the form "virtual:sara,latency_ms=5,baud_rate=115200"'''
+    kwargs = {}
+    parts = spec.split(":", 1)[-1].split(",")
+    modem_type = parts[0].strip().lower()
+    for part in parts[1:]:
+        if "=" in part:
+            (key, value) = part.split("=", 1)
+            key = key.strip()
+            if key in ("baud_rate", "latency_ms", "nav_rate_hz"):
+                kwargs[key] = int(value)
+            elif key in ("unknown_ok", "nmea"):
+                kwargs[key] = value.strip().lower() in ("1", "true", "yes")
+    return (modem_type, kwargs)
+
+def start(device, spec, logger=None):
+    '''Start a virtual modem thread on a device, returning a queue which, when
+       passed to u_utils.device_redirect_stop(), will stop it; spec is of the
+       form "virtual:sara,latency_ms=5,baud_rate=115200"'''
+    terminate_queue = None
+    (modem_type, kwargs) = spec_parse(spec)
+    if modem_type in MODEM_TYPES:
+        terminate_queue = queue.Queue()
+        kwargs["terminate_queue"] = terminate_queue
+        kwargs["logger"] = logger
+        threading.Thread(target=run, args=(device, modem_type), kwargs=kwargs).start()
+    elif logger:
+        logger.error(f"unknown virtual modem type \"{modem_type}\" (must be"
+                     f" one of {MODEM_TYPES}).")
+    return terminate_queue
+
+class PrintLogger():
+    '''Just enough of a logger to print to the console'''
+    @staticmethod
+    def info(text):
+        '''Print information'''
+        print(PROMPT + text)
+
+    @staticmethod
+    def error(text):
+        '''Print an error'''
+        print(PROMPT + "*** ERROR " + text)
+
+if __name__ == "__main__":
+    PARSER = argparse.ArgumentParser(description="A virtual SARA/NINA/M9 module"
+                                     " on the end of a serial port; CTRL-C to stop.")
+    PARSER.add_argument("type", choices=MODEM_TYPES, help="the module to pretend to be.")
+    PARSER.add_argument("device", help="the serial port, e.g. /dev/pts/5 or COM12.")
+    PARSER.add_argument("-b", "--baud-rate", type=int, default=115200,
+                        help="the line rate to emulate in bits/s, 10 bits per byte,"
+                        " 0 for unlimited, default 115200.")
+    PARSER.add_argument("-l", "--latency-ms", type=int, default=0,
+                        help="the delay before each response in milliseconds, default 0.")
+    PARSER.add_argument("-u", "--unknown", choices=["ok", "error"], default="ok",
+                        help="what to respond to an AT command that is not"
+                        " recognised, default \"ok\".")
+    PARSER.add_argument("-r", "--nav-rate-hz", type=int, default=1,
+                        help="M9 only: the rate at which to send UBX-NAV-PVT, 0 for"
+                        " never, -1 for as fast as the link allows, default 1.")
+    PARSER.add_argument("-n", "--nmea", action="store_true",
+                        help="M9 only: send an NMEA GGA sentence with each UBX-NAV-PVT.")
+    PARSER.add_argument("-t", "--trace", action="store_true",
+                        help="print all of the traffic.")
+    ARGS = PARSER.parse_args()
+    TERMINATE_QUEUE = queue.Queue()
+    THREAD = threading.Thread(target=run, args=(ARGS.device, ARGS.type),
+                              kwargs={"baud_rate": ARGS.baud_rate,
+                                      "latency_ms": ARGS.latency_ms,
+                                      "unknown_ok": ARGS.unknown == "ok",
+                                      "nav_rate_hz": ARGS.nav_rate_hz,
+                                      "nmea": ARGS.nmea,
+                                      "terminate_queue": TERMINATE_QUEUE,
+                                      "logger": PrintLogger(),
+                                      "trace": ARGS.trace})
+    THREAD.start()
+    try:
+        while THREAD.is_alive():
+            THREAD.join(1)
+    except KeyboardInterrupt:
+        TERMINATE_QUEUE.put("Terminate")
+        THREAD.join()
+    sys.exit(0)
@@ -24,6 +24,13 @@
  * protection) but, most importantly, means that no loop is required
  * to find a queue, ensuring the lowest possible latency so that
  * send-to-queue can safely be called from an interrupt.
+ *
+ * An event queue either has a task of its own or is a member of
+ * a pool, where one task serves all of the member queues: each
+ * send to a member queue gives the pool's counting semaphore and,
+ * for each take of that semaphore, the pool task handles one item
+ * from the highest priority member queue that has something on
+ * it, members of equal priority being served round-robin.
  */
 
 #ifdef U_CFG_OVERRIDE
@@ -35,11 +42,14 @@
 #include "string.h"    // memcpy()
 
 #include "u_cfg_os_platform_specific.h"
+#include "u_compiler.h" // U_ATOMIC_COMPARE_AND_SWAP, U_MEMORY_BARRIER
 #include "u_error_common.h"
 #include "u_assert.h"
 #include "u_port_heap.h"
 #include "u_port_os.h"
 
+#include "u_task_registry.h"
+
 #include "u_port_event_queue_private.h"
 #include "u_port_event_queue.h"
 
@@ -52,6 +62,19 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+/** The largest parameter block that can be carried in an item on
+ * an OS queue: usually #U_PORT_EVENT_QUEUE_MAX_PARAM_LENGTH_BYTES
+ * but never less than a uEventQueuePointer_t.
+ */
+#define U_EVENT_QUEUE_ITEM_PARAM_MAX_LENGTH_BYTES                       \
+    ((U_PORT_EVENT_QUEUE_MAX_PARAM_LENGTH_BYTES > sizeof(uEventQueuePointer_t)) ? \
+     U_PORT_EVENT_QUEUE_MAX_PARAM_LENGTH_BYTES : sizeof(uEventQueuePointer_t))
+
+/** The limit of the counting semaphore of a pool, which is also
+ * the limit on the total length of the queues in a pool.
+ */
+#define U_EVENT_QUEUE_POOL_SEMAPHORE_LIMIT 0x7FFF
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -62,10 +85,35 @@ typedef struct uEventQueue_t {
     void (*pFunction)(void *, size_t); /** The function to be called. */
     int32_t handle;            /** Handle for this event queue. */
     uPortQueueHandle_t queue; /** Handle for the OS queue. */
-    size_t paramMaxLengthBytes; /** Max length of an item on this OS queue. */
+    size_t paramMaxLengthBytes; /** Max length of a parameter block copied onto this queue. */
+    size_t itemLengthBytes; /** Length of an item on the OS queue, including the control word. */
+    uPortTaskHandle_t task; /** Handle for the OS task, that of the pool if in one. */
+    uPortMutexHandle_t taskRunningMutex; /** Mutex to determine if task has exited,
+                                             NULL if in a pool. */
+    struct uEventQueuePool_t *pPool; /** The pool this queue is in, NULL if none. */
+    int32_t priority; /** Priority of this queue within the pool. */
+    size_t queueLength; /** Length of the OS queue. */
+    struct uEventQueue_t *pNextInPool; /** Next member of the pool. */
+    volatile bool exited; /** Set by the pool task when it has handled the exit. */
+    int32_t queueMinFree; /** The fewest free entries seen on the OS queue, -1 if not known. */
+    volatile uint32_t irqOncePending; /** Non-zero while an event sent by
+                                          uPortEventQueueSendIrqOnce() has
+                                          not yet been dispatched. */
+} uEventQueue_t;
+
+/** The info for an event queue pool.
+ */
+typedef struct uEventQueuePool_t {
+    int32_t handle; /** Handle for this pool. */
     uPortTaskHandle_t task; /** Handle for the OS task. */
     uPortMutexHandle_t taskRunningMutex; /** Mutex to determine if task has exited. */
-} uEventQueue_t;
+    uPortSemaphoreHandle_t semaphore; /** Given for each item sent to a member queue. */
+    uPortMutexHandle_t mutex; /** Protects the member list. */
+    uEventQueue_t *pFirst; /** The member list, highest priority first. */
+    uEventQueue_t *volatile pCurrent; /** The member being handled, NULL if none. */
+    size_t totalQueueLength; /** The sum of the lengths of the member queues. */
+    volatile bool exitNow; /** Set to get the task to exit. */
+} uEventQueuePool_t;
 
 /** The control/size word, prefixed to the parameter block sent to
  * the queue. Negative values are a control word, else this is the
@@ -77,9 +125,20 @@ typedef enum {
                                                * be 32 bit so that it can
                                                * also be used as a size. */
     U_EVENT_CONTROL_NONE = 0,
-    U_EVENT_CONTROL_EXIT_NOW = -1
+    U_EVENT_CONTROL_EXIT_NOW = -1,
+    U_EVENT_CONTROL_POINTER = -2  /* The parameter block is a
+                                   * uEventQueuePointer_t. */
 } uEventQueueControlOrSize_t;
 
+/** What is sent on the OS queue, after the control word, by
+ * uPortEventQueueSendPtr() and uPortEventQueueSendPtrIrq().
+ */
+typedef struct {
+    void *pParam;
+    size_t paramLengthBytes;
+    void (*pRelease) (void *);
+} uEventQueuePointer_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -93,19 +152,65 @@ static uPortMutexHandle_t gMutex = NULL;
  */
 static uEventQueue_t *gpEventQueue[U_PORT_EVENT_QUEUE_MAX_NUM];
 
+/** The event queue pools.
+ */
+static uEventQueuePool_t *gpEventQueuePool[U_PORT_EVENT_QUEUE_POOL_MAX_NUM];
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Handle an item received from the OS queue of an event queue,
+// calling the user function as required; returns false if the
+// item was the instruction to exit.
+static bool eventDispatch(uEventQueue_t *pEventQueue, char *pItem)
+{
+    uEventQueueControlOrSize_t *pControlOrSize = (uEventQueueControlOrSize_t *) pItem;
+    uEventQueuePointer_t pointer;
+
+    // Allow uPortEventQueueSendIrqOnce() to send again; this is
+    // done before the user function is called so that nothing
+    // which arrives while it runs can go unsignalled.  It may
+    // be cleared by an item that was not sent "once", in which
+    // case a second "once" item may be queued: harmless
+    pEventQueue->irqOncePending = 0;
+    U_MEMORY_BARRIER();
+
+    // If this is not a control message, call the
+    // user function with the parameter block,
+    // skipping the "control or size" word at the
+    // start and passing it in instead as the size
+    // parameter
+    if ((int32_t) *pControlOrSize >= 0) {
+        if ((int32_t) *pControlOrSize > 0) {
+            pEventQueue->pFunction((void *) (pItem + U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES),
+                                   // Cast in two stages to keep Lint happy
+                                   (size_t) (int32_t) *pControlOrSize);
+        } else {
+            pEventQueue->pFunction(NULL, 0);
+        }
+    } else if (*pControlOrSize == U_EVENT_CONTROL_POINTER) {
+        // The parameter block is elsewhere: call the user
+        // function with it directly and then hand it back
+        memcpy(&pointer, pItem + U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES,
+               sizeof(pointer));
+        pEventQueue->pFunction(pointer.pParam, pointer.paramLengthBytes);
+        if (pointer.pRelease != NULL) {
+            pointer.pRelease(pointer.pParam);
+        }
+    }
+
+    return (*pControlOrSize != U_EVENT_CONTROL_EXIT_NOW);
+}
+
 // Run the user function.  This will be run multiple times in a
 // task of its own.
 static void eventQueueTask(void *pParam)
 {
     uEventQueue_t *pEventQueue = (uEventQueue_t *) pParam;
     char param[U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES +
-                                                               U_PORT_EVENT_QUEUE_MAX_PARAM_LENGTH_BYTES];
-    uEventQueueControlOrSize_t *pControlOrSize = (uEventQueueControlOrSize_t *)
-                                                 & (param[0]);
+                                                               U_EVENT_QUEUE_ITEM_PARAM_MAX_LENGTH_BYTES];
+    bool keepGoing = true;
 
     U_PORT_MUTEX_LOCK(pEventQueue->taskRunningMutex);
 #if defined(__NEWLIB__) && defined(_REENT_SMALL) && \
@@ -122,31 +227,98 @@ static void eventQueueTask(void *pParam)
     uPortLog("");
 #endif
 
-    *pControlOrSize = U_EVENT_CONTROL_NONE;
     // Continue until we're told to exit
-    while (*pControlOrSize != U_EVENT_CONTROL_EXIT_NOW) {
+    while (keepGoing) {
         if (uPortQueueReceive(pEventQueue->queue, param) == 0) {
-            // If this is not a control message, call the
-            // user function with the parameter block,
-            // skipping the "control or size" word at the
-            // start and passing it in instead as the size
-            // parameter
-            if ((int32_t) *pControlOrSize >= 0) {
-                if ((int32_t) *pControlOrSize > 0) {
-                    pEventQueue->pFunction((void *) & (param[U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES]),
-                                           // Cast in two stages to keep Lint happy
-                                           (size_t) (int32_t) *pControlOrSize);
-                } else {
-                    pEventQueue->pFunction(NULL, 0);
+            keepGoing = eventDispatch(pEventQueue, param);
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(pEventQueue->taskRunningMutex);
+
+    // Delete ourself
+    uTaskRegistryTaskDelete(NULL);
+}
+
+// Add an event queue to the member list of a pool, after all of
+// the members of the same or higher priority.
+// The pool mutex must be locked before this is called.
+static void poolListAdd(uEventQueuePool_t *pPool, uEventQueue_t *pEventQueue)
+{
+    uEventQueue_t **ppNext = &(pPool->pFirst);
+
+    while ((*ppNext != NULL) && ((*ppNext)->priority >= pEventQueue->priority)) {
+        ppNext = &((*ppNext)->pNextInPool);
+    }
+    pEventQueue->pNextInPool = *ppNext;
+    *ppNext = pEventQueue;
+}
+
+// Remove an event queue from the member list of a pool.
+// The pool mutex must be locked before this is called.
+static void poolListRemove(uEventQueuePool_t *pPool, const uEventQueue_t *pEventQueue)
+{
+    uEventQueue_t **ppNext = &(pPool->pFirst);
+
+    while ((*ppNext != NULL) && (*ppNext != pEventQueue)) {
+        ppNext = &((*ppNext)->pNextInPool);
+    }
+    if (*ppNext != NULL) {
+        *ppNext = pEventQueue->pNextInPool;
+    }
+}
+
+// The task of an event queue pool, handling one item from a
+// member queue each time the semaphore is given.
+static void eventQueuePoolTask(void *pParam)
+{
+    uEventQueuePool_t *pPool = (uEventQueuePool_t *) pParam;
+    char item[U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES +
+                                                              U_EVENT_QUEUE_ITEM_PARAM_MAX_LENGTH_BYTES];
+    uEventQueue_t *pEventQueue;
+    bool keepGoing;
+
+    U_PORT_MUTEX_LOCK(pPool->taskRunningMutex);
+#if defined(__NEWLIB__) && defined(_REENT_SMALL) && \
+    !defined(_REENT_GLOBAL_STDIO_STREAMS) && !defined(_UNBUF_STREAM_OPT)
+    // See eventQueueTask()
+    uPortLog("");
+#endif
+
+    while (!pPool->exitNow) {
+        if ((uPortSemaphoreTake(pPool->semaphore) == 0) && !pPool->exitNow) {
+            U_PORT_MUTEX_LOCK(pPool->mutex);
+            // The member list is in priority order so the first
+            // member with something queued is the one to serve
+            pEventQueue = pPool->pFirst;
+            while ((pEventQueue != NULL) &&
+                   (uPortQueueTryReceive(pEventQueue->queue, 0, item) != 0)) {
+                pEventQueue = pEventQueue->pNextInPool;
+            }
+            if (pEventQueue != NULL) {
+                // Move it behind the others of the same priority
+                // so that they are served round-robin
+                poolListRemove(pPool, pEventQueue);
+                poolListAdd(pPool, pEventQueue);
+                pPool->pCurrent = pEventQueue;
+            }
+            U_PORT_MUTEX_UNLOCK(pPool->mutex);
+
+            if (pEventQueue != NULL) {
+                keepGoing = eventDispatch(pEventQueue, item);
+                pPool->pCurrent = NULL;
+                if (!keepGoing) {
+                    // Let eventQueueClose() know it can finish
+                    pEventQueue->exited = true;
                 }
             }
         }
     }
 
-    U_PORT_MUTEX_UNLOCK(pEventQueue->taskRunningMutex);
+    U_PORT_MUTEX_UNLOCK(pPool->taskRunningMutex);
 
     // Delete ourself
-    uPortTaskDelete(NULL);
+    uTaskRegistryTaskDelete(NULL);
 }
 
 // Get the next free event handle.
@@ -179,8 +351,7 @@ static int32_t eventQueueClose(uEventQueue_t *pEventQueue)
     // given that data size, hence we allocate the block,
     // put U_EVENT_CONTROL_EXIT_NOW at the start of it and
     // then free it once it is sent
-    pControl = pUPortMalloc(pEventQueue->paramMaxLengthBytes +
-                            U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES);
+    pControl = pUPortMalloc(pEventQueue->itemLengthBytes);
 
     if (pControl != NULL) {
         *((uEventQueueControlOrSize_t *) pControl) = U_EVENT_CONTROL_EXIT_NOW;
@@ -189,11 +360,25 @@ static int32_t eventQueueClose(uEventQueue_t *pEventQueue)
             uPortTaskBlock(10);
         }
         uPortFree(pControl);
-        U_PORT_MUTEX_LOCK(pEventQueue->taskRunningMutex);
-        U_PORT_MUTEX_UNLOCK(pEventQueue->taskRunningMutex);
+        if (pEventQueue->pPool == NULL) {
+            U_PORT_MUTEX_LOCK(pEventQueue->taskRunningMutex);
+            U_PORT_MUTEX_UNLOCK(pEventQueue->taskRunningMutex);
+            uPortMutexDelete(pEventQueue->taskRunningMutex);
+        } else {
+            // Tell the pool task there is something to do and wait
+            // for it to get to the exit, which ensures that anything
+            // sent before it has been handled
+            uPortSemaphoreGive(pEventQueue->pPool->semaphore);
+            while (!pEventQueue->exited) {
+                uPortTaskBlock(U_CFG_OS_YIELD_MS);
+            }
+            U_PORT_MUTEX_LOCK(pEventQueue->pPool->mutex);
+            poolListRemove(pEventQueue->pPool, pEventQueue);
+            pEventQueue->pPool->totalQueueLength -= pEventQueue->queueLength;
+            U_PORT_MUTEX_UNLOCK(pEventQueue->pPool->mutex);
+        }
 
         // Tidy up
-        uPortMutexDelete(pEventQueue->taskRunningMutex);
         errorCode = uPortQueueDelete(pEventQueue->queue);
 
         // Pause here to allow the deletions
@@ -223,6 +408,101 @@ static inline uEventQueue_t *pEventQueueGet(int32_t handle)
     return pEventQueue;
 }
 
+// Having sent to the OS queue of an event queue, update the task
+// registry if the queue has become fuller than it has ever been;
+// not done for a queue in a pool since the task is shared.
+static void queueMinFreeUpdate(uEventQueue_t *pEventQueue)
+{
+    int32_t numFree;
+
+    if (pEventQueue->pPool == NULL) {
+        numFree = uPortQueueGetFree(pEventQueue->queue);
+        if ((numFree >= 0) &&
+            ((pEventQueue->queueMinFree < 0) || (numFree < pEventQueue->queueMinFree))) {
+            pEventQueue->queueMinFree = numFree;
+            uTaskRegistryQueueUpdate(pEventQueue->task, pEventQueue->queueLength,
+                                     pEventQueue->itemLengthBytes, numFree);
+        }
+    }
+}
+
+// Find an event queue pool's structure in the table.
+// The mutex must be locked before this is called.
+static inline uEventQueuePool_t *pEventQueuePoolGet(int32_t handle)
+{
+    uEventQueuePool_t *pPool = NULL;
+
+    if ((handle >= 0) &&
+        (handle < (int32_t) (sizeof(gpEventQueuePool) / sizeof(gpEventQueuePool[0])))) {
+        pPool = gpEventQueuePool[handle];
+    }
+
+    return pPool;
+}
+
+// Free an event queue pool structure and whatever OS resources it
+// has, though not the task.
+static void eventQueuePoolFree(uEventQueuePool_t *pPool)
+{
+    if (pPool->semaphore != NULL) {
+        uPortSemaphoreDelete(pPool->semaphore);
+    }
+    if (pPool->mutex != NULL) {
+        uPortMutexDelete(pPool->mutex);
+    }
+    if (pPool->taskRunningMutex != NULL) {
+        uPortMutexDelete(pPool->taskRunningMutex);
+    }
+    uPortFree(pPool);
+}
+
+// Close an event queue pool, and all of the queues in it.
+// The mutex must be locked before this is called.
+static int32_t eventQueuePoolClose(uEventQueuePool_t *pPool)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+
+    // Close the member queues first, while the task is running
+    while ((pPool->pFirst != NULL) && (errorCode == 0)) {
+        errorCode = eventQueueClose(pPool->pFirst);
+    }
+
+    if (errorCode == 0) {
+        // Get the task to exit and wait for it to be done
+        pPool->exitNow = true;
+        uPortSemaphoreGive(pPool->semaphore);
+        U_PORT_MUTEX_LOCK(pPool->taskRunningMutex);
+        U_PORT_MUTEX_UNLOCK(pPool->taskRunningMutex);
+
+        // Pause here to allow the task deletion to actually
+        // occur in the idle thread, required by some RTOSs
+        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+
+        gpEventQueuePool[pPool->handle] = NULL;
+        eventQueuePoolFree(pPool);
+    }
+
+    return errorCode;
+}
+
+// Fill in the OS queue item for a pointer event; pBlock must
+// be at least itemLengthBytes of the event queue in size.
+static void pointerBlockFill(char *pBlock, void *pParam, size_t paramLengthBytes,
+                             void (*pRelease) (void *))
+{
+    uEventQueuePointer_t pointer;
+
+    //lint -e(826) Suppress area too small; the size of pBlock is always
+    // at least U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES in size
+    *((uEventQueueControlOrSize_t *) pBlock) = U_EVENT_CONTROL_POINTER;
+    pointer.pParam = pParam;
+    pointer.paramLengthBytes = paramLengthBytes;
+    pointer.pRelease = pRelease;
+    // memcpy() since the structure will not be aligned in the block
+    memcpy(pBlock + U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES,
+           &pointer, sizeof(pointer));
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: BUT ONES THAT SHOULD BE CALLED INTERNALLY ONLY
  * -------------------------------------------------------------- */
@@ -243,6 +523,11 @@ int32_t uPortEventQueuePrivateInit(void)
              x++) {
             gpEventQueue[x] = NULL;
         }
+        for (size_t x = 0;
+             x < sizeof(gpEventQueuePool) / sizeof(gpEventQueuePool[0]);
+             x++) {
+            gpEventQueuePool[x] = NULL;
+        }
         // Allocate the mutex to protect the table
         errorCode = uPortMutexCreate(&gMutex);
     }
@@ -270,6 +555,14 @@ void uPortEventQueuePrivateDeinit(void)
                 U_ASSERT(eventQueueClose(gpEventQueue[x]) == 0);
             }
         }
+        // ...and then the pools, now empty
+        for (size_t x = 0;
+             x < sizeof(gpEventQueuePool) / sizeof(gpEventQueuePool[0]);
+             x++) {
+            if (gpEventQueuePool[x] != NULL) {
+                U_ASSERT(eventQueuePoolClose(gpEventQueuePool[x]) == 0);
+            }
+        }
 
         U_PORT_MUTEX_UNLOCK(gMutex);
 
@@ -315,12 +608,20 @@ int32_t uPortEventQueueOpen(void (*pFunction) (void *, size_t),
                 // Malloc a structure to represent the event queue
                 pEventQueue = (uEventQueue_t *) pUPortMalloc(sizeof(uEventQueue_t));
                 if (pEventQueue != NULL) {
+                    memset(pEventQueue, 0, sizeof(*pEventQueue));
                     pEventQueue->pFunction = pFunction;
                     pEventQueue->paramMaxLengthBytes = paramMaxLengthBytes;
+                    pEventQueue->queueLength = queueLength;
+                    pEventQueue->queueMinFree = -1;
+                    // An item must always be able to carry a pointer event
+                    pEventQueue->itemLengthBytes = paramMaxLengthBytes;
+                    if (pEventQueue->itemLengthBytes < sizeof(uEventQueuePointer_t)) {
+                        pEventQueue->itemLengthBytes = sizeof(uEventQueuePointer_t);
+                    }
+                    pEventQueue->itemLengthBytes += U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES;
                     // Create the queue
                     handleOrError = (uErrorCode_t) uPortQueueCreate(queueLength,
-                                                                    paramMaxLengthBytes +
-                                                                    U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES,
+                                                                    pEventQueue->itemLengthBytes,
                                                                     &(pEventQueue->queue));
                     if (handleOrError == U_ERROR_COMMON_SUCCESS) {
                         // Create the mutex for task running status
@@ -330,13 +631,15 @@ int32_t uPortEventQueueOpen(void (*pFunction) (void *, size_t),
                             if (pName != NULL) {
                                 pTaskName = pName;
                             }
-                            handleOrError = (uErrorCode_t) uPortTaskCreate(eventQueueTask,
-                                                                           pTaskName,
-                                                                           stackSizeBytes,
-                                                                           (void *) pEventQueue,
-                                                                           priority,
-                                                                           &(pEventQueue->task));
+                            handleOrError = (uErrorCode_t) uTaskRegistryTaskCreate(eventQueueTask,
+                                                                                   pTaskName,
+                                                                                   stackSizeBytes,
+                                                                                   (void *) pEventQueue,
+                                                                                   priority,
+                                                                                   &(pEventQueue->task));
                             if (handleOrError == U_ERROR_COMMON_SUCCESS) {
+                                uTaskRegistryQueueUpdate(pEventQueue->task, queueLength,
+                                                         pEventQueue->itemLengthBytes, -1);
                                 // Wait for the eventQueueTask to lock the mutex,
                                 // which shows it is running
                                 while (uPortMutexTryLock(pEventQueue->taskRunningMutex, 0) == 0) {
@@ -383,6 +686,7 @@ int32_t uPortEventQueueSend(int32_t handle, const void *pParam,
     uEventQueue_t *pEventQueue;
     char *pBlock = NULL;
     uPortQueueHandle_t queue = NULL;
+    uPortSemaphoreHandle_t semaphore = NULL;
 
     if (gMutex != NULL) {
 
@@ -394,14 +698,15 @@ int32_t uPortEventQueueSend(int32_t handle, const void *pParam,
             (paramLengthBytes <= pEventQueue->paramMaxLengthBytes) &&
             ((pParam != NULL) || (paramLengthBytes == 0))) {
             queue = pEventQueue->queue;
+            if (pEventQueue->pPool != NULL) {
+                semaphore = pEventQueue->pPool->semaphore;
+            }
             errorCode = U_ERROR_COMMON_NO_MEMORY;
             // We need to add the control word to the start, so pUPortMalloc
-            // a block that is paramMaxLengthBytes (i.e. paramMaxLengthBytes
-            // of the queue, not just the paramLengthBytes passed in, since
-            // uPortQueueSend() will expect to copy the full length) plus
-            // plus the control word length
-            pBlock = (char *) pUPortMalloc(pEventQueue->paramMaxLengthBytes +
-                                           U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES);
+            // a block that is the item length of the queue (i.e. not just
+            // the paramLengthBytes passed in plus the control word length,
+            // since uPortQueueSend() will expect to copy the full length)
+            pBlock = (char *) pUPortMalloc(pEventQueue->itemLengthBytes);
             if (pBlock != NULL) {
                 // Copy in the control word, which is actually just
                 // the size in this case
@@ -427,6 +732,13 @@ int32_t uPortEventQueueSend(int32_t handle, const void *pParam,
             if (queue != NULL) {
                 // Send it off
                 errorCode = (uErrorCode_t) uPortQueueSend(queue, pBlock);
+                if (errorCode == U_ERROR_COMMON_SUCCESS) {
+                    if (semaphore != NULL) {
+                        // Tell the pool task
+                        uPortSemaphoreGive(semaphore);
+                    }
+                    queueMinFreeUpdate(pEventQueue);
+                }
             }
             // Free memory again
             uPortFree(pBlock);
@@ -436,6 +748,34 @@ int32_t uPortEventQueueSend(int32_t handle, const void *pParam,
     return (int32_t) errorCode;
 }
 
+// Send to an event queue from an interrupt, unless an event sent
+// in the same way is still waiting.
+int32_t uPortEventQueueSendIrqOnce(int32_t handle, const void *pParam,
+                                   size_t paramLengthBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uEventQueue_t *pEventQueue;
+
+    if (gMutex != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pEventQueue = pEventQueueGet(handle);
+        if (pEventQueue != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            // The fast path, with nothing to do if an event is
+            // already waiting, masks no interrupts at all
+            if (U_ATOMIC_COMPARE_AND_SWAP(&(pEventQueue->irqOncePending), 0, 1)) {
+                errorCode = uPortEventQueueSendIrq(handle, pParam, paramLengthBytes);
+                if (errorCode != 0) {
+                    // Nothing was sent, so nothing is pending
+                    pEventQueue->irqOncePending = 0;
+                }
+            }
+        }
+    }
+
+    return errorCode;
+}
+
 // Send to an event queue from an interrupt.
 int32_t uPortEventQueueSendIrq(int32_t handle, const void *pParam,
                                size_t paramLengthBytes)
@@ -443,8 +783,6 @@ int32_t uPortEventQueueSendIrq(int32_t handle, const void *pParam,
 #ifndef _WIN32
     uErrorCode_t errorCode = U_ERROR_COMMON_NOT_INITIALISED;
     uEventQueue_t *pEventQueue;
-    char block[paramLengthBytes +
-                                U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES];
 
     if (gMutex != NULL) {
         // Can't lock the mutex, we're in an interrupt.
@@ -453,6 +791,8 @@ int32_t uPortEventQueueSendIrq(int32_t handle, const void *pParam,
         if ((pEventQueue != NULL) &&
             (paramLengthBytes <= pEventQueue->paramMaxLengthBytes) &&
             ((pParam != NULL) || (paramLengthBytes == 0))) {
+            // The whole item is copied by uPortQueueSendIrq()
+            char block[pEventQueue->itemLengthBytes];
             // Copy in the control word, which is actually just
             // the size in this case
             //lint -e(826) Suppress area too small; the size of pBlock is always
@@ -467,6 +807,9 @@ int32_t uPortEventQueueSendIrq(int32_t handle, const void *pParam,
             // Send it off
             errorCode = (uErrorCode_t) uPortQueueSendIrq(pEventQueue->queue,
                                                          block);
+            if ((errorCode == U_ERROR_COMMON_SUCCESS) && (pEventQueue->pPool != NULL)) {
+                uPortSemaphoreGiveIrq(pEventQueue->pPool->semaphore);
+            }
         }
     }
 #else
@@ -486,6 +829,98 @@ int32_t uPortEventQueueSendIrq(int32_t handle, const void *pParam,
     return (int32_t) errorCode;
 }
 
+// Send a pointer to an event queue.
+int32_t uPortEventQueueSendPtr(int32_t handle, void *pParam,
+                               size_t paramLengthBytes,
+                               void (*pRelease) (void *))
+{
+    uErrorCode_t errorCode = U_ERROR_COMMON_NOT_INITIALISED;
+    uEventQueue_t *pEventQueue;
+    char block[U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES +
+                                                               sizeof(uEventQueuePointer_t)];
+    char *pBlock = NULL;
+    uPortQueueHandle_t queue = NULL;
+    uPortSemaphoreHandle_t semaphore = NULL;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
+        pEventQueue = pEventQueueGet(handle);
+        if ((pEventQueue != NULL) && (pParam != NULL)) {
+            queue = pEventQueue->queue;
+            if (pEventQueue->pPool != NULL) {
+                semaphore = pEventQueue->pPool->semaphore;
+            }
+            errorCode = U_ERROR_COMMON_NO_MEMORY;
+            // Only a queue that also carries parameter blocks larger
+            // than a pointer event needs a bigger block than this
+            pBlock = block;
+            if (pEventQueue->itemLengthBytes > sizeof(block)) {
+                pBlock = (char *) pUPortMalloc(pEventQueue->itemLengthBytes);
+            }
+            if (pBlock != NULL) {
+                pointerBlockFill(pBlock, pParam, paramLengthBytes, pRelease);
+            }
+        }
+
+        // Release the mutex before sending, as uPortEventQueueSend() does
+        U_PORT_MUTEX_UNLOCK(gMutex);
+
+        if (pBlock != NULL) {
+            errorCode = (uErrorCode_t) uPortQueueSend(queue, pBlock);
+            if (errorCode == U_ERROR_COMMON_SUCCESS) {
+                if (semaphore != NULL) {
+                    uPortSemaphoreGive(semaphore);
+                }
+                queueMinFreeUpdate(pEventQueue);
+            }
+            if (pBlock != block) {
+                uPortFree(pBlock);
+            }
+        }
+    }
+
+    return (int32_t) errorCode;
+}
+
+// Send a pointer to an event queue from an interrupt.
+int32_t uPortEventQueueSendPtrIrq(int32_t handle, void *pParam,
+                                  size_t paramLengthBytes,
+                                  void (*pRelease) (void *))
+{
+#ifndef _WIN32
+    uErrorCode_t errorCode = U_ERROR_COMMON_NOT_INITIALISED;
+    uEventQueue_t *pEventQueue;
+
+    if (gMutex != NULL) {
+        // Can't lock the mutex, we're in an interrupt.
+        errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
+        pEventQueue = pEventQueueGet(handle);
+        if ((pEventQueue != NULL) && (pParam != NULL)) {
+            char block[pEventQueue->itemLengthBytes];
+            pointerBlockFill(block, pParam, paramLengthBytes, pRelease);
+            errorCode = (uErrorCode_t) uPortQueueSendIrq(pEventQueue->queue,
+                                                         block);
+            if ((errorCode == U_ERROR_COMMON_SUCCESS) && (pEventQueue->pPool != NULL)) {
+                uPortSemaphoreGiveIrq(pEventQueue->pPool->semaphore);
+            }
+        }
+    }
+#else
+    // See uPortEventQueueSendIrq() for why this is not supported on Windows
+    uErrorCode_t errorCode = U_ERROR_COMMON_NOT_SUPPORTED;
+
+    (void) handle;
+    (void) pParam;
+    (void) paramLengthBytes;
+    (void) pRelease;
+#endif
+
+    return (int32_t) errorCode;
+}
+
 // Return whether we're in the event queue's task.
 bool uPortEventQueueIsTask(int32_t handle)
 {
@@ -498,7 +933,11 @@ bool uPortEventQueueIsTask(int32_t handle)
 
         pEventQueue = pEventQueueGet(handle);
         if (pEventQueue != NULL) {
-            isEventTask = uPortTaskIsThis(pEventQueue->task);
+            // The task of a pool is only the event task of
+            // the member queue it is currently handling
+            isEventTask = uPortTaskIsThis(pEventQueue->task) &&
+                          ((pEventQueue->pPool == NULL) ||
+                           (pEventQueue->pPool->pCurrent == pEventQueue));
         }
 
         U_PORT_MUTEX_UNLOCK(gMutex);
@@ -551,6 +990,159 @@ int32_t uPortEventQueueClose(int32_t handle)
     return errorCode;
 }
 
+// Open an event queue pool.
+int32_t uPortEventQueuePoolOpen(const char *pName,
+                                size_t stackSizeBytes,
+                                int32_t priority)
+{
+    uEventQueuePool_t *pPool;
+    int32_t handleOrError = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    int32_t handle = -1;
+    const char *pTaskName = "eventQueuePoolTask";
+
+    if (gMutex != NULL) {
+        handleOrError = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((stackSizeBytes >= U_PORT_EVENT_QUEUE_MIN_TASK_STACK_SIZE_BYTES) &&
+            (priority >= U_CFG_OS_PRIORITY_MIN) &&
+            (priority <= U_CFG_OS_PRIORITY_MAX)) {
+
+            U_PORT_MUTEX_LOCK(gMutex);
+
+            handleOrError = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            for (size_t x = 0; (handle < 0) &&
+                 (x < sizeof(gpEventQueuePool) / sizeof(gpEventQueuePool[0])); x++) {
+                if (gpEventQueuePool[x] == NULL) {
+                    handle = (int32_t) x;
+                }
+            }
+            if (handle >= 0) {
+                pPool = (uEventQueuePool_t *) pUPortMalloc(sizeof(uEventQueuePool_t));
+                if (pPool != NULL) {
+                    memset(pPool, 0, sizeof(*pPool));
+                    pPool->handle = handle;
+                    handleOrError = uPortSemaphoreCreate(&(pPool->semaphore), 0,
+                                                         U_EVENT_QUEUE_POOL_SEMAPHORE_LIMIT);
+                    if (handleOrError == 0) {
+                        handleOrError = uPortMutexCreate(&(pPool->mutex));
+                    }
+                    if (handleOrError == 0) {
+                        handleOrError = uPortMutexCreate(&(pPool->taskRunningMutex));
+                    }
+                    if (handleOrError == 0) {
+                        if (pName != NULL) {
+                            pTaskName = pName;
+                        }
+                        handleOrError = uTaskRegistryTaskCreate(eventQueuePoolTask, pTaskName,
+                                                                stackSizeBytes, (void *) pPool,
+                                                                priority, &(pPool->task));
+                    }
+                    if (handleOrError == 0) {
+                        // Wait for the task to lock the mutex,
+                        // which shows it is running
+                        while (uPortMutexTryLock(pPool->taskRunningMutex, 0) == 0) {
+                            uPortMutexUnlock(pPool->taskRunningMutex);
+                            uPortTaskBlock(U_CFG_OS_YIELD_MS);
+                        }
+                        gpEventQueuePool[handle] = pPool;
+                        handleOrError = handle;
+                    } else {
+                        eventQueuePoolFree(pPool);
+                    }
+                }
+            }
+
+            U_PORT_MUTEX_UNLOCK(gMutex);
+        }
+    }
+
+    return handleOrError;
+}
+
+// Open an event queue in a pool.
+int32_t uPortEventQueueOpenInPool(int32_t poolHandle,
+                                  void (*pFunction) (void *, size_t),
+                                  size_t paramMaxLengthBytes,
+                                  int32_t queuePriority,
+                                  size_t queueLength)
+{
+    uEventQueue_t *pEventQueue;
+    uEventQueuePool_t *pPool;
+    int32_t handleOrError = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    int32_t handle;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        handleOrError = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pPool = pEventQueuePoolGet(poolHandle);
+        if ((pPool != NULL) && (pFunction != NULL) &&
+            (paramMaxLengthBytes <= U_PORT_EVENT_QUEUE_MAX_PARAM_LENGTH_BYTES) &&
+            (queueLength > 0) &&
+            (pPool->totalQueueLength + queueLength <= U_EVENT_QUEUE_POOL_SEMAPHORE_LIMIT)) {
+            handleOrError = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            handle = nextEventHandleGet();
+            if (handle >= 0) {
+                pEventQueue = (uEventQueue_t *) pUPortMalloc(sizeof(uEventQueue_t));
+                if (pEventQueue != NULL) {
+                    memset(pEventQueue, 0, sizeof(*pEventQueue));
+                    pEventQueue->pFunction = pFunction;
+                    pEventQueue->paramMaxLengthBytes = paramMaxLengthBytes;
+                    pEventQueue->queueLength = queueLength;
+                    pEventQueue->itemLengthBytes = paramMaxLengthBytes;
+                    if (pEventQueue->itemLengthBytes < sizeof(uEventQueuePointer_t)) {
+                        pEventQueue->itemLengthBytes = sizeof(uEventQueuePointer_t);
+                    }
+                    pEventQueue->itemLengthBytes += U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES;
+                    handleOrError = uPortQueueCreate(queueLength,
+                                                     pEventQueue->itemLengthBytes,
+                                                     &(pEventQueue->queue));
+                    if (handleOrError == 0) {
+                        pEventQueue->handle = handle;
+                        pEventQueue->task = pPool->task;
+                        pEventQueue->pPool = pPool;
+                        pEventQueue->priority = queuePriority;
+                        U_PORT_MUTEX_LOCK(pPool->mutex);
+                        poolListAdd(pPool, pEventQueue);
+                        pPool->totalQueueLength += queueLength;
+                        U_PORT_MUTEX_UNLOCK(pPool->mutex);
+                        gpEventQueue[handle] = pEventQueue;
+                        handleOrError = handle;
+                    } else {
+                        uPortFree(pEventQueue);
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return handleOrError;
+}
+
+// Close an event queue pool.
+int32_t uPortEventQueuePoolClose(int32_t poolHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uEventQueuePool_t *pPool;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pPool = pEventQueuePoolGet(poolHandle);
+        if (pPool != NULL) {
+            errorCode = eventQueuePoolClose(pPool);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCode;
+}
+
 // Get the number of entries free on the given event queue.
 int32_t uPortEventQueueGetFree(int32_t handle)
 {
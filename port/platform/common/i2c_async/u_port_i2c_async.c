@@ -0,0 +1,298 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ * @brief Implementation of uPortI2cControllerSendReceiveAsync() on
+ * top of uPortI2cControllerSendReceive(); this will run on any
+ * platform.
+ *
+ * The structure is the same as that of the asynchronous UART write
+ * code in uart_async: each I2C instance that is given an asynchronous
+ * transfer gets an event queue of its own, opened on first use and
+ * closed when the I2C instance is closed; the task of the event queue
+ * calls uPortI2cControllerSendReceive(), which, where the platform
+ * uses DMA or interrupts, blocks on the completion of the transfer,
+ * and then calls the user's completion callback.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdio.h"     // snprintf()
+#include "string.h"    // memcpy()
+
+#include "u_cfg_os_platform_specific.h"
+#include "u_error_common.h"
+#include "u_port_os.h"
+#include "u_port_event_queue.h"
+#include "u_port_i2c.h"
+
+#include "u_port_i2c_async_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The asynchronous transfer state of an I2C instance.
+ */
+typedef struct {
+    int32_t i2cHandle;
+    int32_t eventQueueHandle;
+} uPortI2cAsync_t;
+
+/** An asynchronous transfer, as sent to the event queue.
+ */
+typedef struct {
+    int32_t i2cHandle;
+    uint16_t address;
+    const char *pSend;
+    size_t bytesToSend;
+    char *pReceive;
+    size_t bytesToReceive;
+    uPortI2cCallback_t *pCallback;
+    void *pCallbackParam;
+} uPortI2cAsyncTransfer_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Mutex to protect gI2cAsync.
+ */
+static uPortMutexHandle_t gMutex = NULL;
+
+/** The asynchronous transfer state of each I2C instance that has
+ * been given an asynchronous transfer; an entry is free if
+ * eventQueueHandle is negative.
+ */
+static uPortI2cAsync_t gI2cAsync[U_PORT_I2C_ASYNC_MAX_NUM];
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Event queue callback: perform a transfer and call the callback.
+static void eventHandler(void *pParam, size_t paramLength)
+{
+    uPortI2cAsyncTransfer_t transfer;
+    int32_t errorCodeOrLength;
+
+    (void) paramLength;
+
+    // Copy the transfer out since pParam is not guaranteed to be
+    // aligned for a structure containing pointers
+    memcpy(&transfer, pParam, sizeof(transfer));
+    errorCodeOrLength = uPortI2cControllerSendReceive(transfer.i2cHandle,
+                                                      transfer.address,
+                                                      transfer.pSend,
+                                                      transfer.bytesToSend,
+                                                      transfer.pReceive,
+                                                      transfer.bytesToReceive);
+    if (transfer.pCallback != NULL) {
+        transfer.pCallback(transfer.i2cHandle, errorCodeOrLength,
+                           transfer.pCallbackParam);
+    }
+}
+
+// Find the entry for the given I2C handle, or a free one
+// if there is none and findFree is true.
+// Note: gMutex should be locked before this is called.
+static uPortI2cAsync_t *pFindEntry(int32_t i2cHandle, bool findFree)
+{
+    uPortI2cAsync_t *pEntry = NULL;
+    uPortI2cAsync_t *pFree = NULL;
+
+    for (size_t x = 0; (pEntry == NULL) &&
+         (x < sizeof(gI2cAsync) / sizeof(gI2cAsync[0])); x++) {
+        if (gI2cAsync[x].eventQueueHandle >= 0) {
+            if (gI2cAsync[x].i2cHandle == i2cHandle) {
+                pEntry = &(gI2cAsync[x]);
+            }
+        } else if (pFree == NULL) {
+            pFree = &(gI2cAsync[x]);
+        }
+    }
+
+    if ((pEntry == NULL) && findFree) {
+        pEntry = pFree;
+    }
+
+    return pEntry;
+}
+
+// Remove an entry, returning its event queue handle, which the
+// caller should close once gMutex has been unlocked.
+// Note: gMutex should be locked before this is called.
+static int32_t entryRemove(uPortI2cAsync_t *pEntry)
+{
+    int32_t eventQueueHandle = pEntry->eventQueueHandle;
+
+    pEntry->i2cHandle = -1;
+    pEntry->eventQueueHandle = -1;
+
+    return eventQueueHandle;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS THAT ARE PRIVATE TO THE PORT LAYER
+ * -------------------------------------------------------------- */
+
+// Initialise asynchronous I2C transfers.
+int32_t uPortI2cAsyncPrivateInit(void)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+
+    if (gMutex == NULL) {
+        for (size_t x = 0; x < sizeof(gI2cAsync) / sizeof(gI2cAsync[0]); x++) {
+            gI2cAsync[x].i2cHandle = -1;
+            gI2cAsync[x].eventQueueHandle = -1;
+        }
+        errorCode = uPortMutexCreate(&gMutex);
+    }
+
+    return errorCode;
+}
+
+// Deinitialise asynchronous I2C transfers.
+void uPortI2cAsyncPrivateDeinit(void)
+{
+    int32_t eventQueueHandle;
+
+    if (gMutex != NULL) {
+        for (size_t x = 0; x < sizeof(gI2cAsync) / sizeof(gI2cAsync[0]); x++) {
+            U_PORT_MUTEX_LOCK(gMutex);
+            eventQueueHandle = entryRemove(&(gI2cAsync[x]));
+            U_PORT_MUTEX_UNLOCK(gMutex);
+            if (eventQueueHandle >= 0) {
+                // Closing the event queue completes any
+                // outstanding transfers
+                uPortEventQueueClose(eventQueueHandle);
+            }
+        }
+        uPortMutexDelete(gMutex);
+        gMutex = NULL;
+    }
+}
+
+// Complete and free asynchronous transfers on an I2C instance.
+void uPortI2cAsyncPrivateClose(int32_t handle)
+{
+    uPortI2cAsync_t *pEntry;
+    int32_t eventQueueHandle = -1;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pEntry = pFindEntry(handle, false);
+        if (pEntry != NULL) {
+            eventQueueHandle = entryRemove(pEntry);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+
+        if (eventQueueHandle >= 0) {
+            // Closing the event queue completes any
+            // outstanding transfers
+            uPortEventQueueClose(eventQueueHandle);
+        }
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Send and/or receive over the I2C interface without waiting.
+int32_t uPortI2cControllerSendReceiveAsync(int32_t handle, uint16_t address,
+                                           const char *pSend, size_t bytesToSend,
+                                           char *pReceive, size_t bytesToReceive,
+                                           uPortI2cCallback_t *pCallback,
+                                           void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uPortI2cAsync_t *pEntry;
+    uPortI2cAsyncTransfer_t transfer;
+    int32_t eventQueueHandle = -1;
+    char name[16];
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (((pSend != NULL) || (bytesToSend == 0)) &&
+            ((pReceive != NULL) || (bytesToReceive == 0))) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pEntry = pFindEntry(handle, true);
+            if (pEntry != NULL) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                if (pEntry->eventQueueHandle < 0) {
+                    // First asynchronous transfer on this I2C
+                    // instance: check that the handle is valid,
+                    // which is all uPortI2cGetClock() is used for
+                    // here (it is not supported for an adopted
+                    // instance), and open an event queue for it
+                    errorCode = uPortI2cGetClock(handle);
+                    if ((errorCode >= 0) ||
+                        (errorCode == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED)) {
+                        snprintf(name, sizeof(name), "i2cXfer_%d", (int) handle);
+                        errorCode = uPortEventQueueOpen(eventHandler, name,
+                                                        sizeof(uPortI2cAsyncTransfer_t),
+                                                        U_PORT_I2C_ASYNC_TASK_STACK_SIZE_BYTES,
+                                                        U_PORT_I2C_ASYNC_TASK_PRIORITY,
+                                                        U_PORT_I2C_ASYNC_QUEUE_LENGTH);
+                    }
+                    if (errorCode >= 0) {
+                        pEntry->i2cHandle = handle;
+                        pEntry->eventQueueHandle = errorCode;
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    }
+                }
+                eventQueueHandle = pEntry->eventQueueHandle;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+
+        if (errorCode == 0) {
+            // Send outside the mutex since this may block
+            // if the queue is full
+            transfer.i2cHandle = handle;
+            transfer.address = address;
+            transfer.pSend = pSend;
+            transfer.bytesToSend = bytesToSend;
+            transfer.pReceive = pReceive;
+            transfer.bytesToReceive = bytesToReceive;
+            transfer.pCallback = pCallback;
+            transfer.pCallbackParam = pCallbackParam;
+            errorCode = uPortEventQueueSend(eventQueueHandle,
+                                            &transfer, sizeof(transfer));
+        }
+    }
+
+    return errorCode;
+}
+
+// End of file
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_PORT_I2C_ASYNC_PRIVATE_H_
+#define _U_PORT_I2C_ASYNC_PRIVATE_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** @file
+ * @brief private API for asynchronous I2C transfers: initialisation,
+ * deinitialisation and close, which should be called internally by
+ * the I2C porting layer of each platform.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Initialise asynchronous I2C transfers; should be called by
+ * uPortI2cInit().
+ *
+ * @return  zero on success else negative error code.
+ */
+int32_t uPortI2cAsyncPrivateInit(void);
+
+/** Deinitialise asynchronous I2C transfers, completing any that
+ * are outstanding; should be called by uPortI2cDeinit() BEFORE its
+ * own mutex is locked since outstanding transfers will need it.
+ */
+void uPortI2cAsyncPrivateDeinit(void);
+
+/** Complete any outstanding asynchronous transfers on the given
+ * I2C instance and free the resources associated with them; should
+ * be called by uPortI2cClose() and uPortI2cCloseRecoverBus() BEFORE
+ * their own mutex is locked since outstanding transfers will need it.
+ *
+ * @param handle  the handle of the I2C instance.
+ */
+void uPortI2cAsyncPrivateClose(int32_t handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_PORT_I2C_ASYNC_PRIVATE_H_
+
+// End of file
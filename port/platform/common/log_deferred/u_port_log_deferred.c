@@ -0,0 +1,657 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of deferred logging.  A log print is queued
+ * as a record containing the format string pointer followed by the
+ * raw arguments, packed back to back in the order in which they are
+ * consumed; the format string is parsed once when the record is
+ * made, to know what to take off the variable argument list, and
+ * once again when it is printed, to know what to take out of the
+ * record.  Each conversion is then printed with a call to uPortLogF()
+ * using a copy of just that conversion specification as the format,
+ * so that no line buffer is required.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t, ptrdiff_t etc.
+#include "stdint.h"    // int32_t, intmax_t etc.
+#include "stdbool.h"
+#include "stdarg.h"    // va_list
+#include "stdio.h"     // snprintf()
+#include "string.h"    // memcpy(), strlen()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port_clib_platform_specific.h" /* Integer stdio, must be included
+                                              before the other port files if
+                                              any print or scan function is used. */
+
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+#include "u_port_log_deferred.h"
+
+#include "u_task_registry.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The maximum length of a single conversion specification,
+ * e.g. "%-08.3lld", including room for a null terminator and for
+ * "*" to have been replaced by a number.
+ */
+#define U_PORT_LOG_DEFERRED_SPEC_MAX_LENGTH_BYTES 32
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The type of argument that a conversion specification consumes.
+ */
+typedef enum {
+    U_PORT_LOG_DEFERRED_ARG_NONE,   /**< "%%" or not understood. */
+    U_PORT_LOG_DEFERRED_ARG_INT,
+    U_PORT_LOG_DEFERRED_ARG_LONG,
+    U_PORT_LOG_DEFERRED_ARG_LONG_LONG,
+    U_PORT_LOG_DEFERRED_ARG_SIZE,
+    U_PORT_LOG_DEFERRED_ARG_INTMAX,
+    U_PORT_LOG_DEFERRED_ARG_PTRDIFF,
+    U_PORT_LOG_DEFERRED_ARG_DOUBLE,
+    U_PORT_LOG_DEFERRED_ARG_LONG_DOUBLE,
+    U_PORT_LOG_DEFERRED_ARG_POINTER,
+    U_PORT_LOG_DEFERRED_ARG_STRING
+} uPortLogDeferredArg_t;
+
+/** A parsed conversion specification.
+ */
+typedef struct {
+    uPortLogDeferredArg_t arg; /**< the type of argument consumed. */
+    int32_t numStars;          /**< the number of "*" int arguments that
+                                    come before it. */
+    int32_t precision;         /**< a numeric precision, -1 if none
+                                    or if the precision is "*". */
+    bool precisionIsStar;      /**< true if the precision is "*". */
+    size_t length;             /**< the length of the specification
+                                    including the "%". */
+} uPortLogDeferredSpec_t;
+
+/** A log print, as queued.
+ */
+typedef struct {
+    const char *pFormat; /**< NULL means the task should exit. */
+    size_t argsLength;   /**< the number of bytes used in args. */
+    bool truncated;      /**< true if not all of the arguments fitted. */
+    char args[U_PORT_LOG_DEFERRED_ARGS_MAX_LENGTH_BYTES];
+} uPortLogDeferredRecord_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The queue of log prints, NULL if deferred logging is not
+ * running.
+ */
+static uPortQueueHandle_t volatile gQueue = NULL;
+
+/** The task that prints the log.
+ */
+static uPortTaskHandle_t gTask = NULL;
+
+/** Mutex held by the task while it is running.
+ */
+static uPortMutexHandle_t gTaskRunningMutex = NULL;
+
+/** Whether log prints are dropped when the queue is full.
+ */
+static bool gDropWhenFull = false;
+
+/** The number of log prints dropped.
+ */
+static volatile int32_t gDropped = 0;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Parse the conversion specification at pFormat, which must point
+// at a '%'.
+static void specParse(const char *pFormat, uPortLogDeferredSpec_t *pSpec)
+{
+    const char *p = pFormat + 1;
+    int32_t longs = 0;
+    char lengthModifier = 0;
+
+    memset(pSpec, 0, sizeof(*pSpec));
+    pSpec->arg = U_PORT_LOG_DEFERRED_ARG_NONE;
+    pSpec->precision = -1;
+    // Flags
+    while ((*p == '-') || (*p == '+') || (*p == ' ') || (*p == '#') || (*p == '0')) {
+        p++;
+    }
+    // Width
+    if (*p == '*') {
+        pSpec->numStars++;
+        p++;
+    } else {
+        while ((*p >= '0') && (*p <= '9')) {
+            p++;
+        }
+    }
+    // Precision
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            pSpec->numStars++;
+            pSpec->precisionIsStar = true;
+            p++;
+        } else {
+            pSpec->precision = 0;
+            while ((*p >= '0') && (*p <= '9')) {
+                pSpec->precision = (pSpec->precision * 10) + (*p - '0');
+                p++;
+            }
+        }
+    }
+    // Length modifier
+    while ((*p == 'h') || (*p == 'l') || (*p == 'z') ||
+           (*p == 'j') || (*p == 't') || (*p == 'L')) {
+        if (*p == 'l') {
+            longs++;
+        }
+        lengthModifier = *p;
+        p++;
+    }
+    // Conversion
+    switch (*p) {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+        case 'c':
+            pSpec->arg = U_PORT_LOG_DEFERRED_ARG_INT;
+            if (longs == 1) {
+                pSpec->arg = U_PORT_LOG_DEFERRED_ARG_LONG;
+            } else if (longs > 1) {
+                pSpec->arg = U_PORT_LOG_DEFERRED_ARG_LONG_LONG;
+            } else if (lengthModifier == 'z') {
+                pSpec->arg = U_PORT_LOG_DEFERRED_ARG_SIZE;
+            } else if (lengthModifier == 'j') {
+                pSpec->arg = U_PORT_LOG_DEFERRED_ARG_INTMAX;
+            } else if (lengthModifier == 't') {
+                pSpec->arg = U_PORT_LOG_DEFERRED_ARG_PTRDIFF;
+            }
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            pSpec->arg = U_PORT_LOG_DEFERRED_ARG_DOUBLE;
+            if (lengthModifier == 'L') {
+                pSpec->arg = U_PORT_LOG_DEFERRED_ARG_LONG_DOUBLE;
+            }
+            break;
+        case 'p':
+            pSpec->arg = U_PORT_LOG_DEFERRED_ARG_POINTER;
+            break;
+        case 's':
+            pSpec->arg = U_PORT_LOG_DEFERRED_ARG_STRING;
+            break;
+        default:
+            // "%%" or something we don't understand, which
+            // will be printed as it is
+            pSpec->numStars = 0;
+            break;
+    }
+    if (*p != 0) {
+        p++;
+    }
+    pSpec->length = p - pFormat;
+}
+
+// Add an argument to a record.
+static bool argAdd(uPortLogDeferredRecord_t *pRecord, const void *pData,
+                   size_t length)
+{
+    bool success = false;
+
+    if (!pRecord->truncated &&
+        (pRecord->argsLength + length <= sizeof(pRecord->args))) {
+        memcpy(pRecord->args + pRecord->argsLength, pData, length);
+        pRecord->argsLength += length;
+        success = true;
+    } else {
+        pRecord->truncated = true;
+    }
+
+    return success;
+}
+
+// Take an argument out of a record.
+static bool argGet(const uPortLogDeferredRecord_t *pRecord, size_t *pOffset,
+                   void *pData, size_t length)
+{
+    bool success = false;
+
+    if (*pOffset + length <= pRecord->argsLength) {
+        memcpy(pData, pRecord->args + *pOffset, length);
+        *pOffset += length;
+        success = true;
+    }
+
+    return success;
+}
+
+// Add a string to a record, truncating it to fit.
+static void stringAdd(uPortLogDeferredRecord_t *pRecord, const char *pString,
+                      int32_t maxLength)
+{
+    size_t room;
+    size_t length = 0;
+    char *pCopy = pRecord->args + pRecord->argsLength;
+
+    if (pString == NULL) {
+        pString = "(null)";
+    }
+    if (!pRecord->truncated && (pRecord->argsLength < sizeof(pRecord->args))) {
+        // Leave room for the terminator
+        room = sizeof(pRecord->args) - pRecord->argsLength - 1;
+        if ((maxLength >= 0) && ((size_t) maxLength < room)) {
+            room = (size_t) maxLength;
+        }
+        while ((length < room) && (*(pString + length) != 0)) {
+            *(pCopy + length) = *(pString + length);
+            length++;
+        }
+        *(pCopy + length) = 0;
+        pRecord->argsLength += length + 1;
+    } else {
+        pRecord->truncated = true;
+    }
+}
+
+// Fill a record from a variable argument list.
+static void recordFill(uPortLogDeferredRecord_t *pRecord, const char *pFormat,
+                       va_list args)
+{
+    uPortLogDeferredSpec_t spec;
+    const char *p = pFormat;
+    int32_t star = -1;
+    int intValue;
+    long longValue;
+    long long longLongValue;
+    size_t sizeValue;
+    intmax_t intmaxValue;
+    ptrdiff_t ptrdiffValue;
+    double doubleValue;
+    long double longDoubleValue;
+    void *pValue;
+
+    pRecord->pFormat = pFormat;
+    pRecord->argsLength = 0;
+    pRecord->truncated = false;
+    while ((*p != 0) && !pRecord->truncated) {
+        if (*p == '%') {
+            specParse(p, &spec);
+            for (int32_t x = 0; x < spec.numStars; x++) {
+                intValue = va_arg(args, int);
+                star = intValue;
+                argAdd(pRecord, &intValue, sizeof(intValue));
+            }
+            switch (spec.arg) {
+                case U_PORT_LOG_DEFERRED_ARG_INT:
+                    intValue = va_arg(args, int);
+                    argAdd(pRecord, &intValue, sizeof(intValue));
+                    break;
+                case U_PORT_LOG_DEFERRED_ARG_LONG:
+                    longValue = va_arg(args, long);
+                    argAdd(pRecord, &longValue, sizeof(longValue));
+                    break;
+                case U_PORT_LOG_DEFERRED_ARG_LONG_LONG:
+                    longLongValue = va_arg(args, long long);
+                    argAdd(pRecord, &longLongValue, sizeof(longLongValue));
+                    break;
+                case U_PORT_LOG_DEFERRED_ARG_SIZE:
+                    sizeValue = va_arg(args, size_t);
+                    argAdd(pRecord, &sizeValue, sizeof(sizeValue));
+                    break;
+                case U_PORT_LOG_DEFERRED_ARG_INTMAX:
+                    intmaxValue = va_arg(args, intmax_t);
+                    argAdd(pRecord, &intmaxValue, sizeof(intmaxValue));
+                    break;
+                case U_PORT_LOG_DEFERRED_ARG_PTRDIFF:
+                    ptrdiffValue = va_arg(args, ptrdiff_t);
+                    argAdd(pRecord, &ptrdiffValue, sizeof(ptrdiffValue));
+                    break;
+                case U_PORT_LOG_DEFERRED_ARG_DOUBLE:
+                    doubleValue = va_arg(args, double);
+                    argAdd(pRecord, &doubleValue, sizeof(doubleValue));
+                    break;
+                case U_PORT_LOG_DEFERRED_ARG_LONG_DOUBLE:
+                    longDoubleValue = va_arg(args, long double);
+                    argAdd(pRecord, &longDoubleValue, sizeof(longDoubleValue));
+                    break;
+                case U_PORT_LOG_DEFERRED_ARG_POINTER:
+                    pValue = va_arg(args, void *);
+                    argAdd(pRecord, &pValue, sizeof(pValue));
+                    break;
+                case U_PORT_LOG_DEFERRED_ARG_STRING:
+                    pValue = va_arg(args, void *);
+                    if (spec.precisionIsStar) {
+                        spec.precision = star;
+                    }
+                    stringAdd(pRecord, (const char *) pValue, spec.precision);
+                    break;
+                default:
+                    break;
+            }
+            p += spec.length;
+        } else {
+            p++;
+        }
+    }
+}
+
+// Copy a conversion specification, putting in the values of any
+// "*"s, and print the argument it consumes with it.
+static bool specPrint(const uPortLogDeferredRecord_t *pRecord, const char *pFormat,
+                      const uPortLogDeferredSpec_t *pSpec, size_t *pOffset)
+{
+    bool success = true;
+    char buffer[U_PORT_LOG_DEFERRED_SPEC_MAX_LENGTH_BYTES];
+    size_t length = 0;
+    int intValue;
+    long longValue;
+    long long longLongValue;
+    size_t sizeValue;
+    intmax_t intmaxValue;
+    ptrdiff_t ptrdiffValue;
+    double doubleValue;
+    long double longDoubleValue;
+    void *pValue;
+
+    for (size_t x = 0; (x < pSpec->length) && success; x++) {
+        if (*(pFormat + x) == '*') {
+            success = argGet(pRecord, pOffset, &intValue, sizeof(intValue)) &&
+                      (length + 12 < sizeof(buffer));
+            if (success) {
+                length += snprintf(buffer + length, sizeof(buffer) - length, "%d", intValue);
+            }
+        } else {
+            success = (length + 1 < sizeof(buffer));
+            if (success) {
+                buffer[length] = *(pFormat + x);
+                length++;
+            }
+        }
+    }
+    if (success) {
+        buffer[length] = 0;
+        switch (pSpec->arg) {
+            case U_PORT_LOG_DEFERRED_ARG_INT:
+                success = argGet(pRecord, pOffset, &intValue, sizeof(intValue));
+                if (success) {
+                    uPortLogF(buffer, intValue);
+                }
+                break;
+            case U_PORT_LOG_DEFERRED_ARG_LONG:
+                success = argGet(pRecord, pOffset, &longValue, sizeof(longValue));
+                if (success) {
+                    uPortLogF(buffer, longValue);
+                }
+                break;
+            case U_PORT_LOG_DEFERRED_ARG_LONG_LONG:
+                success = argGet(pRecord, pOffset, &longLongValue, sizeof(longLongValue));
+                if (success) {
+                    uPortLogF(buffer, longLongValue);
+                }
+                break;
+            case U_PORT_LOG_DEFERRED_ARG_SIZE:
+                success = argGet(pRecord, pOffset, &sizeValue, sizeof(sizeValue));
+                if (success) {
+                    uPortLogF(buffer, sizeValue);
+                }
+                break;
+            case U_PORT_LOG_DEFERRED_ARG_INTMAX:
+                success = argGet(pRecord, pOffset, &intmaxValue, sizeof(intmaxValue));
+                if (success) {
+                    uPortLogF(buffer, intmaxValue);
+                }
+                break;
+            case U_PORT_LOG_DEFERRED_ARG_PTRDIFF:
+                success = argGet(pRecord, pOffset, &ptrdiffValue, sizeof(ptrdiffValue));
+                if (success) {
+                    uPortLogF(buffer, ptrdiffValue);
+                }
+                break;
+            case U_PORT_LOG_DEFERRED_ARG_DOUBLE:
+                success = argGet(pRecord, pOffset, &doubleValue, sizeof(doubleValue));
+                if (success) {
+                    uPortLogF(buffer, doubleValue);
+                }
+                break;
+            case U_PORT_LOG_DEFERRED_ARG_LONG_DOUBLE:
+                success = argGet(pRecord, pOffset, &longDoubleValue, sizeof(longDoubleValue));
+                if (success) {
+                    uPortLogF(buffer, longDoubleValue);
+                }
+                break;
+            case U_PORT_LOG_DEFERRED_ARG_POINTER:
+                success = argGet(pRecord, pOffset, &pValue, sizeof(pValue));
+                if (success) {
+                    uPortLogF(buffer, pValue);
+                }
+                break;
+            case U_PORT_LOG_DEFERRED_ARG_STRING:
+                // The string itself is in the record
+                success = (*pOffset < pRecord->argsLength);
+                if (success) {
+                    uPortLogF(buffer, pRecord->args + *pOffset);
+                    *pOffset += strlen(pRecord->args + *pOffset) + 1;
+                }
+                break;
+            default:
+                if ((pSpec->length == 2) && (*(pFormat + 1) == '%')) {
+                    uPortLogF("%%");
+                } else {
+                    // Not understood: print it as it is
+                    uPortLogF("%.*s", (int) pSpec->length, pFormat);
+                }
+                break;
+        }
+    }
+
+    return success;
+}
+
+// Print a record.
+static void recordPrint(const uPortLogDeferredRecord_t *pRecord)
+{
+    uPortLogDeferredSpec_t spec;
+    const char *p = pRecord->pFormat;
+    const char *pLiteral = p;
+    size_t offset = 0;
+    bool keepGoing = true;
+
+    while ((*p != 0) && keepGoing) {
+        if (*p == '%') {
+            if (p > pLiteral) {
+                uPortLogF("%.*s", (int) (p - pLiteral), pLiteral);
+            }
+            specParse(p, &spec);
+            keepGoing = specPrint(pRecord, p, &spec, &offset);
+            p += spec.length;
+            pLiteral = p;
+        } else {
+            p++;
+        }
+    }
+    if (keepGoing) {
+        if (p > pLiteral) {
+            uPortLogF("%s", pLiteral);
+        }
+    } else {
+        // Ran out of arguments
+        uPortLogF("...\n");
+    }
+}
+
+// The task that prints the log.
+static void logTask(void *pParam)
+{
+    uPortLogDeferredRecord_t record;
+    bool keepGoing = true;
+
+    (void) pParam;
+
+    U_PORT_MUTEX_LOCK(gTaskRunningMutex);
+
+    while (keepGoing) {
+        if (uPortQueueReceive(gQueue, &record) == 0) {
+            if (record.pFormat != NULL) {
+                recordPrint(&record);
+            } else {
+                keepGoing = false;
+            }
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(gTaskRunningMutex);
+
+    // Delete ourself
+    uTaskRegistryTaskDelete(NULL);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Start deferred logging.
+int32_t uPortLogDeferredStart(bool dropWhenFull)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    uPortQueueHandle_t queue = NULL;
+
+    if (gQueue == NULL) {
+        gDropWhenFull = dropWhenFull;
+        gDropped = 0;
+        errorCode = uPortQueueCreate(U_PORT_LOG_DEFERRED_QUEUE_LENGTH,
+                                     sizeof(uPortLogDeferredRecord_t), &queue);
+        if (errorCode == 0) {
+            errorCode = uPortMutexCreate(&gTaskRunningMutex);
+            if (errorCode == 0) {
+                gQueue = queue;
+                errorCode = uTaskRegistryTaskCreate(logTask, "logDeferred",
+                                                    U_PORT_LOG_DEFERRED_TASK_STACK_SIZE_BYTES,
+                                                    NULL, U_PORT_LOG_DEFERRED_TASK_PRIORITY,
+                                                    &gTask);
+                if (errorCode == 0) {
+                    // Wait for the task to lock the mutex,
+                    // which shows it is running
+                    while (uPortMutexTryLock(gTaskRunningMutex, 0) == 0) {
+                        uPortMutexUnlock(gTaskRunningMutex);
+                        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+                    }
+                } else {
+                    gQueue = NULL;
+                    uPortMutexDelete(gTaskRunningMutex);
+                    gTaskRunningMutex = NULL;
+                }
+            }
+            if (errorCode != 0) {
+                uPortQueueDelete(queue);
+            }
+        }
+    } else {
+        gDropWhenFull = dropWhenFull;
+    }
+
+    return errorCode;
+}
+
+// Stop deferred logging.
+void uPortLogDeferredStop()
+{
+    uPortLogDeferredRecord_t record;
+    uPortQueueHandle_t queue = gQueue;
+
+    if (queue != NULL) {
+        // Log prints from here on are not deferred
+        gQueue = NULL;
+        // Everything queued so far is printed before
+        // the task gets to this
+        memset(&record, 0, sizeof(record));
+        uPortQueueSend(queue, &record);
+        U_PORT_MUTEX_LOCK(gTaskRunningMutex);
+        U_PORT_MUTEX_UNLOCK(gTaskRunningMutex);
+        uPortMutexDelete(gTaskRunningMutex);
+        gTaskRunningMutex = NULL;
+        gTask = NULL;
+        // Allow the task to be deleted before the queue is
+        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+        uPortQueueDelete(queue);
+    }
+}
+
+// Get the number of log prints dropped.
+int32_t uPortLogDeferredGetDropped()
+{
+    return gDropped;
+}
+
+// Queue a log print, or print it if deferred logging is not running.
+void uPortLogDeferredF(const char *pFormat, ...)
+{
+    uPortLogDeferredRecord_t record;
+    uPortQueueHandle_t queue = gQueue;
+    va_list args;
+
+    if (pFormat != NULL) {
+        va_start(args, pFormat);
+        recordFill(&record, pFormat, args);
+        va_end(args);
+        if (queue != NULL) {
+            if (gDropWhenFull && (uPortQueueGetFree(queue) == 0)) {
+                gDropped++;
+            } else {
+                uPortQueueSend(queue, &record);
+            }
+        } else {
+            recordPrint(&record);
+        }
+    }
+}
+
+// End of file
@@ -0,0 +1,118 @@
+#!/usr/bin/env python
+
+'''Decode a binary RAM log, as captured by u_log_ram.c, on the host.
+
+The input file may either be a sequence of uLogRamEntry_t structures,
+e.g. as returned by uLogRamGet() and written to a file by the
+application, or, with --store, a raw memory dump of the whole
+U_LOG_RAM_STORE_SIZE buffer that was passed to uLogRamInit(), e.g.
+read out with a debugger after a crash.  The event strings are taken
+from u_log_ram_string.c and u_log_ram_string_user.h so that the output
+matches that of uLogRamPrint().'''
+
+import os
+import re
+import struct
+import argparse
+
+# The directory of this script, where the C files live
+LOG_RAM_DIR = os.path.dirname(os.path.abspath(__file__))
+
+# The magic word at the start of uLogRamContext_t
+MAGIC_WORD = 0x123456
+
+# The format of a uLogRamEntry_t: int32_t timestamp, uint32_t event,
+# int32_t parameter
+ENTRY_FORMAT = "iIi"
+
+# The format of a uLogRamContext_t on a 32-bit target: magicWord,
+# version, pLog, pLogNextEmpty, pLogFirstFull, numLogItems,
+# logEntriesOverwritten, lastLogTime
+CONTEXT_FORMAT = "IiIIIIIi"
+
+def read_strings(directory):
+    '''Read the event strings, in order, from u_log_ram_string.c'''
+    strings = []
+    with open(os.path.join(directory, "u_log_ram_string.c"), "r") as file:
+        text = file.read()
+    # Only interested in the body of the array
+    match = re.search(r"gULogRamString\[\]\s*=\s*\{(.*?)\};", text, re.DOTALL)
+    if match:
+        for line in match.group(1).splitlines():
+            include = re.match(r'\s*#include\s+"(.+)"', line)
+            if include:
+                with open(os.path.join(directory, include.group(1)), "r") as file:
+                    for include_line in file:
+                        strings.extend(re.findall(r'^\s*"(.*)"', include_line))
+            else:
+                strings.extend(re.findall(r'^\s*"(.*)"', line))
+    return strings
+
+def entries_from_store(data, endian):
+    '''Return the entries, oldest first, from a raw store dump'''
+    entries = []
+    context_size = struct.calcsize(endian + CONTEXT_FORMAT)
+    entry_size = struct.calcsize(endian + ENTRY_FORMAT)
+    (magic_word, version, p_log, p_next_empty, p_first_full,
+     _, overwritten, _) = struct.unpack_from(endian + CONTEXT_FORMAT, data)
+    if magic_word != MAGIC_WORD:
+        print("*** WARNING: magic word is 0x{:x}, expected 0x{:x},"
+              " this may not be a RAM log.".format(magic_word, MAGIC_WORD))
+    print("Log version {}, {} entries overwritten.".format(version, overwritten))
+    num_entries = (len(data) - context_size) // entry_size
+    if num_entries > 0:
+        index = ((p_first_full - p_log) // entry_size) % num_entries
+        index_end = ((p_next_empty - p_log) // entry_size) % num_entries
+        while index != index_end:
+            entries.append(struct.unpack_from(endian + ENTRY_FORMAT, data,
+                                              context_size + (index * entry_size)))
+            index = (index + 1) % num_entries
+    return entries
+
+def entries_from_array(data, endian):
+    '''Return the entries from a plain array of uLogRamEntry_t'''
+    entry_size = struct.calcsize(endian + ENTRY_FORMAT)
+    return [struct.unpack_from(endian + ENTRY_FORMAT, data, x)
+            for x in range(0, len(data) - entry_size + 1, entry_size)]
+
+def decode(entries, strings):
+    '''Print the entries in the same form as uLogRamPrint()'''
+    last_timestamp = None
+    print("------------- uLogRam starts -------------")
+    for index, (timestamp, event, parameter) in enumerate(entries):
+        delta = ""
+        if last_timestamp is not None:
+            delta = " (+{} ms)".format(timestamp - last_timestamp)
+        last_timestamp = timestamp
+        if event >= len(strings):
+            print("{:10d}: out of range event at entry {} ({} when max is {})."
+                  .format(timestamp, index, event, len(strings)))
+        else:
+            print("{:10d}: [{:3d}] {} {} ({:#x}){}"
+                  .format(timestamp, event, strings[event], parameter,
+                          parameter & 0xFFFFFFFF, delta))
+    print("-------------- uLogRam ends --------------")
+
+if __name__ == "__main__":
+    PARSER = argparse.ArgumentParser(description="Decode a binary RAM log"
+                                     " captured by u_log_ram.c.")
+    PARSER.add_argument("file", help="the binary file to decode.")
+    PARSER.add_argument("--store", action="store_true",
+                        help="the file is a raw dump of the whole log store"
+                        " (context plus entries) from a 32-bit target rather"
+                        " than an array of uLogRamEntry_t.")
+    PARSER.add_argument("--big-endian", action="store_true",
+                        help="the target is big-endian.")
+    PARSER.add_argument("--dir", default=LOG_RAM_DIR,
+                        help="the directory containing u_log_ram_string.c,"
+                        " defaults to the directory of this script.")
+    ARGS = PARSER.parse_args()
+
+    ENDIAN = ">" if ARGS.big_endian else "<"
+    with open(ARGS.file, "rb") as INPUT:
+        DATA = INPUT.read()
+    if ARGS.store:
+        ENTRIES = entries_from_store(DATA, ENDIAN)
+    else:
+        ENTRIES = entries_from_array(DATA, ENDIAN)
+    decode(ENTRIES, read_strings(ARGS.dir))
@@ -37,7 +37,7 @@ extern "C" {
 
 /** Increment this variable if you make any changes to the enum below.
  */
-#define U_LOG_RAM_VERSION 0
+#define U_LOG_RAM_VERSION 1
 
 /* ----------------------------------------------------------------
  * TYPES
@@ -66,6 +66,22 @@ typedef enum {
     U_LOG_RAM_EVENT_USER_7,
     U_LOG_RAM_EVENT_USER_8,
     U_LOG_RAM_EVENT_USER_9,
+    // Log points for the AT client, only used if
+    // U_CFG_AT_CLIENT_TRACE is defined
+    U_LOG_RAM_EVENT_AT_COMMAND_START,   /**< parameter is the stream handle. */
+    U_LOG_RAM_EVENT_AT_RESPONSE_STOP,   /**< parameter is the AT client error code. */
+    U_LOG_RAM_EVENT_AT_BUFFER_FILL,     /**< parameter is the number of bytes read. */
+    U_LOG_RAM_EVENT_AT_BUFFER_OVERFLOW, /**< parameter is the buffered length discarded. */
+    U_LOG_RAM_EVENT_AT_TIMEOUT,         /**< parameter is the number of consecutive timeouts. */
+    U_LOG_RAM_EVENT_AT_URC_START,       /**< parameter is up to the first four characters
+                                             of the URC prefix, first character in the
+                                             most significant byte. */
+    U_LOG_RAM_EVENT_AT_URC_STOP,        /**< parameter is the time spent in the URC
+                                             handler in milliseconds. */
+    U_LOG_RAM_EVENT_AT_INTERCEPT_RX,    /**< parameter is the length the receive intercept
+                                             made available. */
+    U_LOG_RAM_EVENT_AT_INTERCEPT_TX,    /**< parameter is the length the transmit intercept
+                                             returned for sending. */
     // Add your own named log points in u_log_ram_enum_user.h
 #include "u_log_ram_enum_user.h"
 } uLogRamEvent_t;
@@ -53,6 +53,16 @@ const char *gULogRamString[] = {
     "  USER_7",
     "  USER_8",
     "  USER_9",
+    // AT client log points, do not change
+    "  AT command start on stream",
+    "  AT response stop, error",
+    "  AT buffer fill, bytes read",
+    "* AT receive buffer overflow, bytes lost",
+    "* AT timeout, consecutive count",
+    "  AT URC start, prefix",
+    "  AT URC stop, handler ms",
+    "  AT receive intercept, length",
+    "  AT transmit intercept, length",
     // Specific log points defined by the user
 #include "u_log_ram_string_user.h"
 };
@@ -0,0 +1,339 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief The implementation of the RAM trace utility.  The ring
+ * is a bounded multi-producer/single-consumer queue: each entry
+ * carries a sequence number which tells a producer whether the
+ * entry is free for it to claim and tells the consumer whether the
+ * producer has finished writing it.  A producer claims an entry by
+ * advancing the write index with a compare-and-swap, so producers
+ * never wait for one another and no lock is required.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcpy()/memset()
+
+#include "u_cfg_sw.h"
+#include "u_compiler.h" // U_MEMORY_BARRIER, U_ATOMIC_COMPARE_AND_SWAP
+
+#include "u_port.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+#include "u_port_perf_counter.h"
+
+#include "u_log_ram_trace.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The magic word at the start of a trace store.
+ */
+#define U_LOG_RAM_TRACE_MAGIC_WORD 0x7ACE0001
+
+/** Get a pointer to the entry for the given index.
+ */
+#define U_LOG_RAM_TRACE_ENTRY(pContext, index) (((uLogRamTraceEntry_t *) ((pContext) + 1)) + \
+                                                ((index) & (U_LOG_RAM_TRACE_ENTRIES_MAX_NUM - 1)))
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** A pointer to the trace context.
+ */
+static uLogRamTraceContext_t *volatile gpTraceContext = NULL;
+
+/** Keep track of whether we allocated gpTraceContext.
+ */
+static bool gTraceContextMalloced = false;
+
+/** The subsystems as strings; must be kept in line with the
+ * uLogRamTraceSubsystem_t enum in u_log_ram_trace.h.
+ */
+const char *gULogRamTraceSubsystemString[] = {
+    "AT_CLIENT",
+    "EDM_STREAM",
+    "RING_BUFFER",
+    "SOCK",
+    "GNSS",
+    "USER"
+};
+
+/** The trace points as strings; must be kept in line with the
+ * uLogRamTracePoint_t enum in u_log_ram_trace.h.
+ */
+const char *gULogRamTracePointString[] = {
+    "NONE",
+    "AT_COMMAND",
+    "AT_URC",
+    "AT_BUFFER_FILL",
+    "AT_TIMEOUT",
+    "EDM_RX",
+    "EDM_EVENT",
+    "EDM_WRITE",
+    "RING_BUFFER_ADD",
+    "RING_BUFFER_FULL",
+    "RING_BUFFER_READ",
+    "SOCK_WRITE",
+    "SOCK_READ",
+    "SOCK_SEND_TO",
+    "SOCK_RECEIVE_FROM",
+    "GNSS_FILL",
+    "USER_0",
+    "USER_1",
+    "USER_2",
+    "USER_3"
+};
+
+/** The type of an entry as a string.
+ */
+static const char *const gpTypeString[] = {"instant", "begin", "end"};
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Read a sequence number, which may be modified by another context.
+static uint32_t getSequence(const uLogRamTraceEntry_t *pEntry)
+{
+    return *((const volatile uint32_t *) & (pEntry->sequence));
+}
+
+// Print a single entry.
+static void printEntry(const uLogRamTraceEntry_t *pEntry)
+{
+    uint32_t point = pEntry->id & 0xFFFF;
+    uint32_t subsystem = (pEntry->id >> 16) & 0xFF;
+    uint32_t type = pEntry->id >> 24;
+
+    if ((point >= sizeof(gULogRamTracePointString) / sizeof(gULogRamTracePointString[0])) ||
+        (subsystem >= sizeof(gULogRamTraceSubsystemString) /
+         sizeof(gULogRamTraceSubsystemString[0])) ||
+        (type >= sizeof(gpTypeString) / sizeof(gpTypeString[0]))) {
+        uPortLog("%10u: out of range entry (%#x).\n", pEntry->timestampUs, pEntry->id);
+    } else {
+        uPortLog("%10u: %-11s %-17s %-7s %d (%#x) @%u\n", pEntry->timestampUs,
+                 gULogRamTraceSubsystemString[subsystem],
+                 gULogRamTracePointString[point], gpTypeString[type],
+                 pEntry->parameter, pEntry->parameter, pEntry->cycles);
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Initialise tracing.
+bool uLogRamTraceInit(void *pBuffer, uint32_t enableMask)
+{
+    uLogRamTraceContext_t *pContext;
+
+    if (gpTraceContext == NULL) {
+        if (pBuffer == NULL) {
+            pBuffer = pUPortMalloc(U_LOG_RAM_TRACE_STORE_SIZE);
+            gTraceContextMalloced = (pBuffer != NULL);
+        }
+        if (pBuffer != NULL) {
+            memset(pBuffer, 0, U_LOG_RAM_TRACE_STORE_SIZE);
+            pContext = (uLogRamTraceContext_t *) pBuffer;
+            pContext->magicWord = U_LOG_RAM_TRACE_MAGIC_WORD;
+            pContext->version = U_LOG_RAM_TRACE_VERSION;
+            // An entry is free for the producer with write
+            // index N when its sequence number is N
+            for (uint32_t x = 0; x < U_LOG_RAM_TRACE_ENTRIES_MAX_NUM; x++) {
+                U_LOG_RAM_TRACE_ENTRY(pContext, x)->sequence = x;
+            }
+            pContext->enableMask = enableMask;
+            // Make sure all of the above is visible before
+            // any producer can see the context
+            U_MEMORY_BARRIER();
+            gpTraceContext = pContext;
+        }
+    } else {
+        gpTraceContext->enableMask = enableMask;
+    }
+
+    return (gpTraceContext != NULL);
+}
+
+// Stop tracing.
+void uLogRamTraceDeinit()
+{
+    uLogRamTraceContext_t *pContext = gpTraceContext;
+
+    if (pContext != NULL) {
+        gpTraceContext = NULL;
+        U_MEMORY_BARRIER();
+        if (gTraceContextMalloced) {
+            uPortFree(pContext);
+            gTraceContextMalloced = false;
+        }
+    }
+}
+
+// Set the subsystems that are traced.
+void uLogRamTraceEnable(uint32_t enableMask)
+{
+    uLogRamTraceContext_t *pContext = gpTraceContext;
+
+    if (pContext != NULL) {
+        pContext->enableMask = enableMask;
+    }
+}
+
+// Add an entry to the trace.
+void uLogRamTrace(uLogRamTraceSubsystem_t subsystem,
+                  uLogRamTraceType_t type,
+                  uLogRamTracePoint_t point,
+                  int32_t parameter)
+{
+    uLogRamTraceContext_t *pContext = gpTraceContext;
+    uLogRamTraceEntry_t *pEntry = NULL;
+    uint32_t timestampUs;
+    uint32_t cycles;
+    uint32_t index = 0;
+    uint32_t sequence;
+    uint32_t numDropped;
+    bool keepGoing = true;
+
+    if ((pContext != NULL) &&
+        ((pContext->enableMask & U_LOG_RAM_TRACE_SUBSYSTEM_BIT(subsystem)) != 0)) {
+        timestampUs = (uint32_t) uPortGetTickTimeUs();
+        cycles = uPortPerfCounterGetCycles();
+        while (keepGoing) {
+            index = pContext->writeIndex;
+            pEntry = U_LOG_RAM_TRACE_ENTRY(pContext, index);
+            sequence = getSequence(pEntry);
+            if (sequence == index) {
+                // The entry is free: claim it, unless another
+                // producer has done so meanwhile, in which case
+                // go around again
+                if (U_ATOMIC_COMPARE_AND_SWAP(&(pContext->writeIndex), index, index + 1)) {
+                    keepGoing = false;
+                }
+            } else if ((int32_t) (sequence - index) < 0) {
+                // The consumer has not yet read this entry
+                // from the last time around: the trace is full
+                pEntry = NULL;
+                do {
+                    numDropped = pContext->numDropped;
+                } while (!U_ATOMIC_COMPARE_AND_SWAP(&(pContext->numDropped),
+                                                    numDropped, numDropped + 1));
+                keepGoing = false;
+            }
+            // Otherwise another producer has claimed the
+            // entry since we read the write index: try again
+        }
+        if (pEntry != NULL) {
+            pEntry->timestampUs = timestampUs;
+            pEntry->id = ((uint32_t) point & 0xFFFF) |
+                         (((uint32_t) subsystem & 0xFF) << 16) |
+                         ((uint32_t) type << 24);
+            pEntry->parameter = parameter;
+            pEntry->cycles = cycles;
+            // Hand the entry to the consumer
+            U_MEMORY_BARRIER();
+            pEntry->sequence = index + 1;
+        }
+    }
+}
+
+// Get trace entries.
+size_t uLogRamTraceGet(uLogRamTraceEntry_t *pEntries, size_t numEntries)
+{
+    uLogRamTraceContext_t *pContext = gpTraceContext;
+    uLogRamTraceEntry_t *pEntry;
+    uint32_t index;
+    size_t count = 0;
+    bool keepGoing = true;
+
+    if ((pContext != NULL) && (pEntries != NULL)) {
+        while (keepGoing && (count < numEntries)) {
+            index = pContext->readIndex;
+            pEntry = U_LOG_RAM_TRACE_ENTRY(pContext, index);
+            if (getSequence(pEntry) == index + 1) {
+                // The producer has finished with the entry
+                U_MEMORY_BARRIER();
+                memcpy(pEntries, pEntry, sizeof(*pEntries));
+                U_MEMORY_BARRIER();
+                // Free the entry for the producer the
+                // next time around
+                pEntry->sequence = index + U_LOG_RAM_TRACE_ENTRIES_MAX_NUM;
+                pContext->readIndex = index + 1;
+                pEntries++;
+                count++;
+            } else {
+                keepGoing = false;
+            }
+        }
+    }
+
+    return count;
+}
+
+// Get the number of dropped entries.
+int32_t uLogRamTraceGetNumDropped()
+{
+    uLogRamTraceContext_t *pContext = gpTraceContext;
+    uint32_t numDropped = 0;
+
+    if (pContext != NULL) {
+        do {
+            numDropped = pContext->numDropped;
+        } while (!U_ATOMIC_COMPARE_AND_SWAP(&(pContext->numDropped), numDropped, 0));
+    }
+
+    return (int32_t) numDropped;
+}
+
+// Print out the trace.
+void uLogRamTracePrint()
+{
+    uLogRamTraceEntry_t entry;
+    int32_t numDropped;
+
+    if (gpTraceContext != NULL) {
+        uPortLog("------------- uLogRamTrace starts -------------\n");
+        while (uLogRamTraceGet(&entry, 1) > 0) {
+            printEntry(&entry);
+        }
+        numDropped = uLogRamTraceGetNumDropped();
+        if (numDropped > 0) {
+            uPortLog("* %d entries dropped.\n", numDropped);
+        }
+        uPortLog("-------------- uLogRamTrace ends --------------\n");
+    }
+}
+
+// End of file
@@ -0,0 +1,293 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_LOG_RAM_TRACE_H_
+#define _U_LOG_RAM_TRACE_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "stddef.h"
+
+/** @file
+ * @brief A binary trace facility built alongside the RAM log: each
+ * trace entry carries a microsecond time-stamp, the subsystem it
+ * belongs to, a trace point, whether it is the beginning or end of
+ * a span or an instant, a 32-bit parameter and the value of the CPU
+ * cycle counter (see u_port_perf_counter.h), so that the processor
+ * time of a span can be told apart from its wall-clock time.  Entries are put
+ * into a lock-free ring that any number of tasks or interrupts may
+ * write to and a single consumer (uLogRamTraceGet()) may read from;
+ * when the ring is full new entries are dropped, and counted, rather
+ * than overwriting old ones.  Tracing of each subsystem may be
+ * switched on or off at run-time with uLogRamTraceEnable().
+ *
+ * The trace points in the library code (AT client, EDM stream,
+ * ring buffer, sockets and GNSS streamed fill) are only compiled in
+ * if U_CFG_LOG_RAM_TRACE is defined; nothing is recorded until
+ * uLogRamTraceInit() has been called.  Use u_log_ram_trace_json.py
+ * to convert the entries to Chrome trace/Perfetto JSON on the host.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The number of trace entries; must be a power of two.
+ */
+#ifndef U_LOG_RAM_TRACE_ENTRIES_MAX_NUM
+# define U_LOG_RAM_TRACE_ENTRIES_MAX_NUM 256
+#endif
+
+/** Increment this if you make any changes to the enums below or
+ * to the structure of the trace entry.
+ */
+#define U_LOG_RAM_TRACE_VERSION 2
+
+/** The bit in an enable mask for the given subsystem, e.g.
+ * U_LOG_RAM_TRACE_SUBSYSTEM_BIT(U_LOG_RAM_TRACE_SUBSYSTEM_SOCK).
+ */
+#define U_LOG_RAM_TRACE_SUBSYSTEM_BIT(subsystem) (1UL << (uint32_t) (subsystem))
+
+/** An enable mask with all subsystems enabled.
+ */
+#define U_LOG_RAM_TRACE_SUBSYSTEM_ALL 0xFFFFFFFFUL
+
+#ifdef U_CFG_LOG_RAM_TRACE
+/** Mark the beginning of a span, e.g.:
+ *
+ * U_LOG_RAM_TRACE_BEGIN(SOCK, SOCK_WRITE, descriptor);
+ */
+# define U_LOG_RAM_TRACE_BEGIN(subsystem, point, parameter)        \
+    uLogRamTrace(U_LOG_RAM_TRACE_SUBSYSTEM_##subsystem,            \
+                 U_LOG_RAM_TRACE_TYPE_BEGIN,                       \
+                 U_LOG_RAM_TRACE_POINT_##point, (int32_t) (parameter))
+
+/** Mark the end of a span begun with U_LOG_RAM_TRACE_BEGIN().
+ */
+# define U_LOG_RAM_TRACE_END(subsystem, point, parameter)          \
+    uLogRamTrace(U_LOG_RAM_TRACE_SUBSYSTEM_##subsystem,            \
+                 U_LOG_RAM_TRACE_TYPE_END,                         \
+                 U_LOG_RAM_TRACE_POINT_##point, (int32_t) (parameter))
+
+/** Mark an instant.
+ */
+# define U_LOG_RAM_TRACE_INSTANT(subsystem, point, parameter)      \
+    uLogRamTrace(U_LOG_RAM_TRACE_SUBSYSTEM_##subsystem,            \
+                 U_LOG_RAM_TRACE_TYPE_INSTANT,                     \
+                 U_LOG_RAM_TRACE_POINT_##point, (int32_t) (parameter))
+#else
+# define U_LOG_RAM_TRACE_BEGIN(subsystem, point, parameter)
+# define U_LOG_RAM_TRACE_END(subsystem, point, parameter)
+# define U_LOG_RAM_TRACE_INSTANT(subsystem, point, parameter)
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The subsystems that may be traced; if you add an item here
+ * don't forget to add it to gULogRamTraceSubsystemString (in
+ * u_log_ram_trace.c) also.
+ */
+typedef enum {
+    U_LOG_RAM_TRACE_SUBSYSTEM_AT_CLIENT,
+    U_LOG_RAM_TRACE_SUBSYSTEM_EDM_STREAM,
+    U_LOG_RAM_TRACE_SUBSYSTEM_RING_BUFFER,
+    U_LOG_RAM_TRACE_SUBSYSTEM_SOCK,
+    U_LOG_RAM_TRACE_SUBSYSTEM_GNSS,
+    U_LOG_RAM_TRACE_SUBSYSTEM_USER,
+    U_LOG_RAM_TRACE_SUBSYSTEM_MAX_NUM
+} uLogRamTraceSubsystem_t;
+
+/** The type of a trace entry.
+ */
+typedef enum {
+    U_LOG_RAM_TRACE_TYPE_INSTANT,
+    U_LOG_RAM_TRACE_TYPE_BEGIN,
+    U_LOG_RAM_TRACE_TYPE_END,
+    U_LOG_RAM_TRACE_TYPE_MAX_NUM
+} uLogRamTraceType_t;
+
+/** The trace points; if you add an item here don't forget to add
+ * it to gULogRamTracePointString (in u_log_ram_trace.c) also.
+ */
+typedef enum {
+    U_LOG_RAM_TRACE_POINT_NONE,
+    U_LOG_RAM_TRACE_POINT_AT_COMMAND,        /**< span, begin parameter is the stream handle,
+                                                  end parameter the AT client error code. */
+    U_LOG_RAM_TRACE_POINT_AT_URC,            /**< span, begin parameter is up to the first
+                                                  four characters of the URC prefix, end
+                                                  parameter the handler time in ms. */
+    U_LOG_RAM_TRACE_POINT_AT_BUFFER_FILL,    /**< instant, parameter is the number of
+                                                  bytes read. */
+    U_LOG_RAM_TRACE_POINT_AT_TIMEOUT,        /**< instant, parameter is the number of
+                                                  consecutive timeouts. */
+    U_LOG_RAM_TRACE_POINT_EDM_RX,            /**< span, begin parameter is the number of
+                                                  bytes already buffered, end parameter
+                                                  the number left unparsed. */
+    U_LOG_RAM_TRACE_POINT_EDM_EVENT,         /**< instant, parameter is the EDM event type. */
+    U_LOG_RAM_TRACE_POINT_EDM_WRITE,         /**< span, begin parameter is the length,
+                                                  end parameter the size or error code. */
+    U_LOG_RAM_TRACE_POINT_RING_BUFFER_ADD,   /**< instant, parameter is the length added. */
+    U_LOG_RAM_TRACE_POINT_RING_BUFFER_FULL,  /**< instant, parameter is the length that
+                                                  could not be added. */
+    U_LOG_RAM_TRACE_POINT_RING_BUFFER_READ,  /**< instant, parameter is the length read. */
+    U_LOG_RAM_TRACE_POINT_SOCK_WRITE,        /**< span, begin parameter is the descriptor,
+                                                  end parameter the size or error code. */
+    U_LOG_RAM_TRACE_POINT_SOCK_READ,         /**< span, begin parameter is the descriptor,
+                                                  end parameter the size or error code. */
+    U_LOG_RAM_TRACE_POINT_SOCK_SEND_TO,      /**< span, begin parameter is the descriptor,
+                                                  end parameter the size or error code. */
+    U_LOG_RAM_TRACE_POINT_SOCK_RECEIVE_FROM, /**< span, begin parameter is the descriptor,
+                                                  end parameter the size or error code. */
+    U_LOG_RAM_TRACE_POINT_GNSS_FILL,         /**< span, begin parameter is the timeout
+                                                  in ms, end parameter the number of
+                                                  bytes received or error code. */
+    U_LOG_RAM_TRACE_POINT_USER_0,
+    U_LOG_RAM_TRACE_POINT_USER_1,
+    U_LOG_RAM_TRACE_POINT_USER_2,
+    U_LOG_RAM_TRACE_POINT_USER_3,
+    U_LOG_RAM_TRACE_POINT_MAX_NUM
+} uLogRamTracePoint_t;
+
+/** A trace entry; all 32-bit values so that it is easy to decode
+ * on another platform.
+ */
+typedef struct {
+    uint32_t sequence;    /**< used internally to hand the entry from
+                               producer to consumer. */
+    uint32_t timestampUs; /**< the low 32 bits of uPortGetTickTimeUs(),
+                               hence wraps every 71 minutes or so. */
+    uint32_t id;          /**< the trace point in the least significant
+                               16 bits, then the subsystem, then the
+                               type in the most significant 8 bits. */
+    int32_t parameter;
+    uint32_t cycles;      /**< uPortPerfCounterGetCycles(), zero if the
+                               platform has no cycle counter; the
+                               difference between the end and the
+                               beginning of a span is the cycles it
+                               took, provided it took less than a
+                               wrap of the counter. */
+} uLogRamTraceEntry_t;
+
+/** Type used to store the trace context, followed in memory by
+ * #U_LOG_RAM_TRACE_ENTRIES_MAX_NUM entries.
+ */
+typedef struct {
+    uint32_t magicWord;
+    int32_t version;
+    volatile uint32_t writeIndex;
+    volatile uint32_t readIndex;
+    volatile uint32_t numDropped;
+    volatile uint32_t enableMask;
+} uLogRamTraceContext_t;
+
+/** The size of the trace store.
+ */
+#define U_LOG_RAM_TRACE_STORE_SIZE (sizeof(uLogRamTraceContext_t) +                   \
+                                    (sizeof(uLogRamTraceEntry_t) *                   \
+                                     U_LOG_RAM_TRACE_ENTRIES_MAX_NUM))
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Initialise tracing; tracing begins immediately for the
+ * subsystems in enableMask.  If tracing is already initialised
+ * this just sets the enable mask.
+ *
+ * @param pBuffer    must point to #U_LOG_RAM_TRACE_STORE_SIZE bytes
+ *                   of storage, aligned for a uint32_t; if pBuffer is
+ *                   NULL then memory will be allocated and will be
+ *                   free'ed on deinitialisation.
+ * @param enableMask the subsystems to trace, a bit-map of
+ *                   U_LOG_RAM_TRACE_SUBSYSTEM_BIT() values, e.g.
+ *                   #U_LOG_RAM_TRACE_SUBSYSTEM_ALL.
+ * @return           true if successful, else false.
+ */
+bool uLogRamTraceInit(void *pBuffer, uint32_t enableMask);
+
+/** Stop tracing, freeing memory if it was allocated by
+ * uLogRamTraceInit(); must not be called while anything might
+ * still be calling uLogRamTrace().
+ */
+void uLogRamTraceDeinit();
+
+/** Set the subsystems that are traced.
+ *
+ * @param enableMask the subsystems to trace, a bit-map of
+ *                   U_LOG_RAM_TRACE_SUBSYSTEM_BIT() values;
+ *                   use 0 to pause tracing.
+ */
+void uLogRamTraceEnable(uint32_t enableMask);
+
+/** Add an entry to the trace; this is lock-free and may be called
+ * from any task or from an interrupt, provided that
+ * uPortGetTickTimeUs() may be called from an interrupt on your
+ * platform.  Usually you will use the U_LOG_RAM_TRACE_BEGIN(),
+ * U_LOG_RAM_TRACE_END() or U_LOG_RAM_TRACE_INSTANT() macros rather
+ * than calling this directly.
+ *
+ * @param subsystem the subsystem.
+ * @param type      the type of entry.
+ * @param point     the trace point.
+ * @param parameter the parameter.
+ */
+void uLogRamTrace(uLogRamTraceSubsystem_t subsystem,
+                  uLogRamTraceType_t type,
+                  uLogRamTracePoint_t point,
+                  int32_t parameter);
+
+/** Get trace entries, oldest first, removing them from the trace;
+ * there may be only one consumer, i.e. this must not be called
+ * from more than one task at a time.
+ *
+ * @param[out] pEntries a pointer to the place to store the entries.
+ * @param numEntries    the number of entries pointed to by pEntries.
+ * @return              the number of entries returned.
+ */
+size_t uLogRamTraceGet(uLogRamTraceEntry_t *pEntries, size_t numEntries);
+
+/** Get the number of entries that have been dropped because the
+ * trace was full; the count is zeroed by this call.
+ *
+ * @return the number of dropped entries.
+ */
+int32_t uLogRamTraceGetNumDropped();
+
+/** Print out, and remove, the entries currently in the trace;
+ * the same restriction as uLogRamTraceGet() applies.
+ */
+void uLogRamTracePrint();
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_LOG_RAM_TRACE_H_
+
+// End of file
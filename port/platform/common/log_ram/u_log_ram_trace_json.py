@@ -0,0 +1,170 @@
+#!/usr/bin/env python
+
+'''Convert a binary trace, as captured by u_log_ram_trace.c, into
+Chrome trace/Perfetto JSON on the host.
+
+The input file may either be a sequence of uLogRamTraceEntry_t
+structures, e.g. as returned by uLogRamTraceGet() and written to a
+file by the application, or, with --store, a raw memory dump of the
+whole U_LOG_RAM_TRACE_STORE_SIZE buffer that was passed to
+uLogRamTraceInit(), e.g. read out with a debugger.  Load the output
+into chrome://tracing or https://ui.perfetto.dev.  Each subsystem is
+shown as a separate track; spans are output as async events since
+the beginning and end of a span may be recorded by different tasks.
+The end event of a span carries, in "cycles", the CPU cycle counter
+difference from the beginning of the span, which may be compared with
+its duration to tell processor time from waiting.  Use --frequency to
+also have that converted to microseconds.
+Subsystem and trace point names are taken from u_log_ram_trace.c.'''
+
+import os
+import re
+import json
+import struct
+import argparse
+
+# The directory of this script, where the C files live
+LOG_RAM_DIR = os.path.dirname(os.path.abspath(__file__))
+
+# The magic word at the start of uLogRamTraceContext_t
+MAGIC_WORD = 0x7ACE0001
+
+# The format of a uLogRamTraceEntry_t: uint32_t sequence,
+# uint32_t timestampUs, uint32_t id, int32_t parameter,
+# uint32_t cycles
+ENTRY_FORMAT = "IIIiI"
+
+# The format of a uLogRamTraceContext_t: magicWord, version,
+# writeIndex, readIndex, numDropped, enableMask
+CONTEXT_FORMAT = "IiIIII"
+
+# The types of entry, in the order of uLogRamTraceType_t
+TYPE_INSTANT = 0
+TYPE_BEGIN = 1
+TYPE_END = 2
+
+def read_strings(directory, name):
+    '''Read the strings, in order, of the named array in u_log_ram_trace.c'''
+    with open(os.path.join(directory, "u_log_ram_trace.c"), "r") as file:
+        text = file.read()
+    match = re.search(name + r"\[\]\s*=\s*\{(.*?)\};", text, re.DOTALL)
+    if match:
+        return re.findall(r'"(.*?)"', match.group(1))
+    return []
+
+def entries_from_store(data, endian):
+    '''Return the entries, oldest first, from a raw store dump'''
+    entries = []
+    context_size = struct.calcsize(endian + CONTEXT_FORMAT)
+    entry_size = struct.calcsize(endian + ENTRY_FORMAT)
+    (magic_word, version, write_index, read_index,
+     num_dropped, _) = struct.unpack_from(endian + CONTEXT_FORMAT, data)
+    if magic_word != MAGIC_WORD:
+        print("*** WARNING: magic word is 0x{:x}, expected 0x{:x},"
+              " this may not be a trace store.".format(magic_word, MAGIC_WORD))
+    print("Trace version {}, {} entries dropped.".format(version, num_dropped))
+    num_entries = (len(data) - context_size) // entry_size
+    index = read_index
+    while (num_entries > 0) and (index != write_index):
+        entry = struct.unpack_from(endian + ENTRY_FORMAT, data,
+                                   context_size + ((index % num_entries) * entry_size))
+        # Only entries that the producer had finished writing
+        if entry[0] == (index + 1) & 0xFFFFFFFF:
+            entries.append(entry)
+        index = (index + 1) & 0xFFFFFFFF
+    return entries
+
+def entries_from_array(data, endian):
+    '''Return the entries from a plain array of uLogRamTraceEntry_t'''
+    entry_size = struct.calcsize(endian + ENTRY_FORMAT)
+    return [struct.unpack_from(endian + ENTRY_FORMAT, data, x)
+            for x in range(0, len(data) - entry_size + 1, entry_size)]
+
+def name_of(strings, index):
+    '''Return a name from a list of strings, coping with out of range'''
+    if index < len(strings):
+        return strings[index]
+    return "UNKNOWN_{}".format(index)
+
+def convert(entries, subsystems, points, frequency):
+    '''Return the entries as a Chrome trace/Perfetto JSON object'''
+    events = []
+    timestamp_offset = 0
+    last_timestamp = None
+    # The cycle count at the beginning of each open span,
+    # indexed by subsystem and trace point
+    begin_cycles = {}
+    for subsystem, name in enumerate(subsystems):
+        events.append({"name": "thread_name", "ph": "M", "pid": 0,
+                       "tid": subsystem, "args": {"name": name}})
+    for (_, timestamp, entry_id, parameter, cycles) in entries:
+        # The timestamp is the low 32 bits of a microsecond
+        # count, unwrap it, assuming no gaps of more than
+        # 71 minutes
+        if (last_timestamp is not None) and (timestamp < last_timestamp) and \
+           (last_timestamp - timestamp > 0x80000000):
+            timestamp_offset += 0x100000000
+        last_timestamp = timestamp
+        point = entry_id & 0xFFFF
+        subsystem = (entry_id >> 16) & 0xFF
+        entry_type = entry_id >> 24
+        event = {"name": name_of(points, point),
+                 "cat": name_of(subsystems, subsystem),
+                 "ts": timestamp + timestamp_offset,
+                 "pid": 0, "tid": subsystem,
+                 "args": {"parameter": parameter}}
+        if entry_type == TYPE_BEGIN:
+            event["ph"] = "b"
+            event["id"] = point
+            begin_cycles[(subsystem, point)] = cycles
+        elif entry_type == TYPE_END:
+            event["ph"] = "e"
+            event["id"] = point
+            if (subsystem, point) in begin_cycles:
+                # The counter is 32 bits wide and wraps
+                span_cycles = (cycles - begin_cycles.pop((subsystem, point))) & 0xFFFFFFFF
+                event["args"]["cycles"] = span_cycles
+                if frequency > 0:
+                    event["args"]["cpu_us"] = (span_cycles * 1000000) // frequency
+        else:
+            event["ph"] = "i"
+            event["s"] = "t"
+        events.append(event)
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+if __name__ == "__main__":
+    PARSER = argparse.ArgumentParser(description="Convert a binary trace"
+                                     " captured by u_log_ram_trace.c to"
+                                     " Chrome trace/Perfetto JSON.")
+    PARSER.add_argument("file", help="the binary file to convert.")
+    PARSER.add_argument("output", help="the JSON file to write.")
+    PARSER.add_argument("--store", action="store_true",
+                        help="the file is a raw dump of the whole trace store"
+                        " (context plus entries) rather than an array of"
+                        " uLogRamTraceEntry_t.")
+    PARSER.add_argument("--big-endian", action="store_true",
+                        help="the target is big-endian.")
+    PARSER.add_argument("--frequency", type=int, default=0,
+                        help="the frequency of the cycle counter in Hertz,"
+                        " as returned by uPortPerfCounterGetFrequencyHz(),"
+                        " if the cycles of a span should be converted to"
+                        " microseconds.")
+    PARSER.add_argument("--dir", default=LOG_RAM_DIR,
+                        help="the directory containing u_log_ram_trace.c,"
+                        " defaults to the directory of this script.")
+    ARGS = PARSER.parse_args()
+
+    ENDIAN = ">" if ARGS.big_endian else "<"
+    with open(ARGS.file, "rb") as INPUT:
+        DATA = INPUT.read()
+    if ARGS.store:
+        ENTRIES = entries_from_store(DATA, ENDIAN)
+    else:
+        ENTRIES = entries_from_array(DATA, ENDIAN)
+    TRACE = convert(ENTRIES,
+                    read_strings(ARGS.dir, "gULogRamTraceSubsystemString"),
+                    read_strings(ARGS.dir, "gULogRamTracePointString"),
+                    ARGS.frequency)
+    with open(ARGS.output, "w") as OUTPUT:
+        json.dump(TRACE, OUTPUT, indent=1)
+    print("{} entries written to {}.".format(len(ENTRIES), ARGS.output))
@@ -25,14 +25,18 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
+#include "string.h"    // memcpy(), memset()
 
 #include "mbedtls/sha256.h"
 #include "mbedtls/md.h"
 #include "mbedtls/aes.h"
+#include "mbedtls/md5.h"
 
+#include "u_compiler.h" // U_WEAK
 #include "u_error_common.h"
 
 #include "u_port.h"
+#include "u_port_heap.h"
 #include "u_port_crypto.h"
 
 /* ----------------------------------------------------------------
@@ -43,6 +47,14 @@
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The context of an AES 128 CBC calculation performed in pieces.
+ */
+typedef struct {
+    mbedtls_aes_context aes;
+    unsigned char initVector[U_PORT_CRYPTO_AES128_INITIALISATION_VECTOR_LENGTH_BYTES];
+    int mode;
+} uPortCryptoAes128CbcContext_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -94,7 +106,9 @@ int32_t uPortCryptoHmacSha256(const char *pKey,
                            (unsigned char *) pOutput);
 }
 
-// Perform AES 128 CBC encryption of a block of data.
+// Perform AES 128 CBC encryption of a block of data; weak so that
+// a platform may substitute a hardware AES engine.
+U_WEAK
 int32_t uPortCryptoAes128CbcEncrypt(const char *pKey,
                                     size_t keyLengthBytes,
                                     char *pInitVector,
@@ -105,6 +119,7 @@ int32_t uPortCryptoAes128CbcEncrypt(const char *pKey,
     int32_t errorCode;
     mbedtls_aes_context context;
 
+    mbedtls_aes_init(&context);
     errorCode = mbedtls_aes_setkey_enc(&context,
                                        (const unsigned char *) pKey,
                                        keyLengthBytes * 8);
@@ -116,11 +131,15 @@ int32_t uPortCryptoAes128CbcEncrypt(const char *pKey,
                                           (const unsigned char *) pInput,
                                           (unsigned char *) pOutput);
     }
+    // Zeroes the key schedule
+    mbedtls_aes_free(&context);
 
     return errorCode;
 }
 
-// Perform AES 128 CBC decryption of a block of data.
+// Perform AES 128 CBC decryption of a block of data; weak so that
+// a platform may substitute a hardware AES engine.
+U_WEAK
 int32_t uPortCryptoAes128CbcDecrypt(const char *pKey,
                                     size_t keyLengthBytes,
                                     char *pInitVector,
@@ -131,6 +150,7 @@ int32_t uPortCryptoAes128CbcDecrypt(const char *pKey,
     int32_t errorCode;
     mbedtls_aes_context context;
 
+    mbedtls_aes_init(&context);
     errorCode = mbedtls_aes_setkey_dec(&context,
                                        (const unsigned char *) pKey,
                                        keyLengthBytes * 8);
@@ -142,8 +162,301 @@ int32_t uPortCryptoAes128CbcDecrypt(const char *pKey,
                                           (const unsigned char *) pInput,
                                           (unsigned char *) pOutput);
     }
+    // Zeroes the key schedule
+    mbedtls_aes_free(&context);
+
+    return errorCode;
+}
+
+// Start a SHA256 calculation in pieces; weak so that a platform
+// may substitute a hardware hash engine.
+U_WEAK
+int32_t uPortCryptoSha256Init(void **ppContext)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    mbedtls_sha256_context *pContext;
+
+    if (ppContext != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pContext = (mbedtls_sha256_context *) pUPortMalloc(sizeof(*pContext));
+        if (pContext != NULL) {
+            mbedtls_sha256_init(pContext);
+            // Not the _ret() versions, for the same
+            // reason as in uPortCryptoSha256()
+            mbedtls_sha256_starts(pContext, 0);
+            *ppContext = (void *) pContext;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Add a piece of data to a SHA256 calculation.
+U_WEAK
+int32_t uPortCryptoSha256Update(void *pContext,
+                                const char *pInput,
+                                size_t inputLengthBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pContext != NULL) &&
+        ((pInput != NULL) || (inputLengthBytes == 0))) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        mbedtls_sha256_update((mbedtls_sha256_context *) pContext,
+                              (const unsigned char *) pInput,
+                              inputLengthBytes);
+    }
+
+    return errorCode;
+}
+
+// Finish a SHA256 calculation.
+U_WEAK
+int32_t uPortCryptoSha256Final(void *pContext, char *pOutput)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pContext != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (pOutput != NULL) {
+            mbedtls_sha256_finish((mbedtls_sha256_context *) pContext,
+                                  (unsigned char *) pOutput);
+        }
+        mbedtls_sha256_free((mbedtls_sha256_context *) pContext);
+        uPortFree(pContext);
+    }
+
+    return errorCode;
+}
+
+// Start an MD5 calculation in pieces; weak so that a platform
+// may substitute a hardware hash engine.
+U_WEAK
+int32_t uPortCryptoMd5Init(void **ppContext)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+#ifdef MBEDTLS_MD5_C
+    mbedtls_md5_context *pContext;
+
+    if (ppContext != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pContext = (mbedtls_md5_context *) pUPortMalloc(sizeof(*pContext));
+        if (pContext != NULL) {
+            mbedtls_md5_init(pContext);
+            // Not the _ret() versions, for the same
+            // reason as in uPortCryptoSha256()
+            mbedtls_md5_starts(pContext);
+            *ppContext = (void *) pContext;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+#else
+    (void) ppContext;
+    errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+#endif
+
+    return errorCode;
+}
+
+// Add a piece of data to an MD5 calculation.
+U_WEAK
+int32_t uPortCryptoMd5Update(void *pContext,
+                             const char *pInput,
+                             size_t inputLengthBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pContext != NULL) &&
+        ((pInput != NULL) || (inputLengthBytes == 0))) {
+#ifdef MBEDTLS_MD5_C
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        mbedtls_md5_update((mbedtls_md5_context *) pContext,
+                           (const unsigned char *) pInput,
+                           inputLengthBytes);
+#else
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+#endif
+    }
+
+    return errorCode;
+}
+
+// Finish an MD5 calculation.
+U_WEAK
+int32_t uPortCryptoMd5Final(void *pContext, char *pOutput)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pContext != NULL) {
+#ifdef MBEDTLS_MD5_C
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (pOutput != NULL) {
+            mbedtls_md5_finish((mbedtls_md5_context *) pContext,
+                               (unsigned char *) pOutput);
+        }
+        mbedtls_md5_free((mbedtls_md5_context *) pContext);
+#else
+        (void) pOutput;
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+#endif
+        uPortFree(pContext);
+    }
+
+    return errorCode;
+}
+
+// Start a HMAC SHA256 calculation in pieces; weak so that a
+// platform may substitute a hardware hash engine.
+U_WEAK
+int32_t uPortCryptoHmacSha256Init(void **ppContext,
+                                  const char *pKey,
+                                  size_t keyLengthBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    mbedtls_md_context_t *pContext;
+
+    if ((ppContext != NULL) && (pKey != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pContext = (mbedtls_md_context_t *) pUPortMalloc(sizeof(*pContext));
+        if (pContext != NULL) {
+            mbedtls_md_init(pContext);
+            // 1 to allocate the HMAC part of the context
+            errorCode = mbedtls_md_setup(pContext,
+                                         mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
+                                         1);
+            if (errorCode == 0) {
+                errorCode = mbedtls_md_hmac_starts(pContext,
+                                                   (const unsigned char *) pKey,
+                                                   keyLengthBytes);
+            }
+            if (errorCode == 0) {
+                *ppContext = (void *) pContext;
+            } else {
+                mbedtls_md_free(pContext);
+                uPortFree(pContext);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Add a piece of data to a HMAC SHA256 calculation.
+U_WEAK
+int32_t uPortCryptoHmacSha256Update(void *pContext,
+                                    const char *pInput,
+                                    size_t inputLengthBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pContext != NULL) &&
+        ((pInput != NULL) || (inputLengthBytes == 0))) {
+        errorCode = mbedtls_md_hmac_update((mbedtls_md_context_t *) pContext,
+                                           (const unsigned char *) pInput,
+                                           inputLengthBytes);
+    }
+
+    return errorCode;
+}
+
+// Finish a HMAC SHA256 calculation.
+U_WEAK
+int32_t uPortCryptoHmacSha256Final(void *pContext, char *pOutput)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pContext != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (pOutput != NULL) {
+            errorCode = mbedtls_md_hmac_finish((mbedtls_md_context_t *) pContext,
+                                               (unsigned char *) pOutput);
+        }
+        // Zeroes the key
+        mbedtls_md_free((mbedtls_md_context_t *) pContext);
+        uPortFree(pContext);
+    }
+
+    return errorCode;
+}
+
+// Start an AES 128 CBC calculation in pieces; weak so that a
+// platform may substitute a hardware AES engine.
+U_WEAK
+int32_t uPortCryptoAes128CbcInit(void **ppContext,
+                                 const char *pKey,
+                                 size_t keyLengthBytes,
+                                 const char *pInitVector,
+                                 bool encrypt)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortCryptoAes128CbcContext_t *pContext;
+
+    if ((ppContext != NULL) && (pKey != NULL) && (pInitVector != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pContext = (uPortCryptoAes128CbcContext_t *) pUPortMalloc(sizeof(*pContext));
+        if (pContext != NULL) {
+            mbedtls_aes_init(&(pContext->aes));
+            if (encrypt) {
+                pContext->mode = MBEDTLS_AES_ENCRYPT;
+                errorCode = mbedtls_aes_setkey_enc(&(pContext->aes),
+                                                   (const unsigned char *) pKey,
+                                                   keyLengthBytes * 8);
+            } else {
+                pContext->mode = MBEDTLS_AES_DECRYPT;
+                errorCode = mbedtls_aes_setkey_dec(&(pContext->aes),
+                                                   (const unsigned char *) pKey,
+                                                   keyLengthBytes * 8);
+            }
+            if (errorCode == 0) {
+                memcpy(pContext->initVector, pInitVector, sizeof(pContext->initVector));
+                *ppContext = (void *) pContext;
+            } else {
+                mbedtls_aes_free(&(pContext->aes));
+                uPortFree(pContext);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Encrypt or decrypt a piece of data with AES 128 CBC.
+U_WEAK
+int32_t uPortCryptoAes128CbcUpdate(void *pContext,
+                                   const char *pInput,
+                                   size_t lengthBytes,
+                                   char *pOutput)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortCryptoAes128CbcContext_t *pAesContext = (uPortCryptoAes128CbcContext_t *) pContext;
+
+    if ((pAesContext != NULL) && (pInput != NULL) && (pOutput != NULL)) {
+        // This updates the initialisation vector in the
+        // context, ready for the next piece
+        errorCode = mbedtls_aes_crypt_cbc(&(pAesContext->aes),
+                                          pAesContext->mode,
+                                          lengthBytes,
+                                          pAesContext->initVector,
+                                          (const unsigned char *) pInput,
+                                          (unsigned char *) pOutput);
+    }
 
     return errorCode;
 }
 
+// Finish an AES 128 CBC calculation.
+U_WEAK
+void uPortCryptoAes128CbcFinal(void *pContext)
+{
+    uPortCryptoAes128CbcContext_t *pAesContext = (uPortCryptoAes128CbcContext_t *) pContext;
+
+    if (pAesContext != NULL) {
+        // Zeroes the key schedule
+        mbedtls_aes_free(&(pAesContext->aes));
+        memset(pAesContext->initVector, 0, sizeof(pAesContext->initVector));
+        uPortFree(pAesContext);
+    }
+}
+
 // End of file
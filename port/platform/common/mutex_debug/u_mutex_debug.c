@@ -27,7 +27,7 @@
 
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // memset()
+#include "string.h"    // memset(), strcmp()
 
 #include "u_cfg_sw.h"
 #include "u_cfg_os_platform_specific.h"
@@ -88,6 +88,23 @@ typedef struct uMutexFunctionInfo_t {
     struct uMutexFunctionInfo_t *pNext;
 } uMutexFunctionInfo_t;
 
+#ifdef U_CFG_MUTEX_DEBUG_PROFILE
+/** Lock contention statistics for a mutex creation point.
+ */
+typedef struct {
+    const char *pFile; // If this is NULL the entry is not in use.
+    int32_t line;
+    int32_t numMutexes;
+    int32_t numAcquisitions;
+    int32_t numContended;
+    int32_t numTimeouts;
+    int64_t waitTotalUs;
+    int64_t waitMaxUs;
+    int64_t holdTotalUs;
+    int64_t holdMaxUs;
+} uMutexProfileInfo_t;
+#endif
+
 /** A structure to keep track of a mutex as part of a linked list.
  * Note that the handle MUST be the first member of the structure.
  * This is because, when simulating critical sections under Windows,
@@ -99,6 +116,10 @@ typedef struct uMutexInfo_t {
     uMutexFunctionInfo_t *pCreator; // If this is NULL the entry is not in use.
     uMutexFunctionInfo_t *pLocker;
     uMutexFunctionInfo_t *pWaiting;
+#ifdef U_CFG_MUTEX_DEBUG_PROFILE
+    uMutexProfileInfo_t *pProfile; // May be NULL if the profile table is full.
+    int64_t lockedTimeUs;
+#endif
     struct uMutexInfo_t *pNext;
 } uMutexInfo_t;
 
@@ -149,6 +170,17 @@ static uMutexInfo_t gMutexInfo[U_MUTEX_DEBUG_MUTEX_INFO_MAX_NUM];
  */
 static uMutexFunctionInfo_t gMutexFunctionInfo[U_MUTEX_DEBUG_FUNCTION_INFO_MAX_NUM];
 
+#ifdef U_CFG_MUTEX_DEBUG_PROFILE
+/** Array of lock contention statistics, one per mutex creation point.
+ */
+static uMutexProfileInfo_t gMutexProfileInfo[U_MUTEX_DEBUG_PROFILE_INFO_MAX_NUM];
+
+/** The number of mutexes that could not be profiled because
+ * gMutexProfileInfo[] was full.
+ */
+static int32_t gMutexProfileNumNotProfiled = 0;
+#endif
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS; ONES THAT DO NOT LOCK THE LIST MUTEX
  * -------------------------------------------------------------- */
@@ -203,6 +235,46 @@ static uMutexInfo_t *pAllocMutexInformationBlock()
     return pMutexInfo;
 }
 
+#ifdef U_CFG_MUTEX_DEBUG_PROFILE
+// Find the profile entry for a mutex creation point, allocating
+// one if there is none; returns NULL if the table is full.
+// gMutexList should be locked before this is called.
+static uMutexProfileInfo_t *pFindProfileInformationBlock(const char *pFile,
+                                                         int32_t line)
+{
+    uMutexProfileInfo_t *pProfile = NULL;
+    uMutexProfileInfo_t *pFree = NULL;
+
+    for (size_t x = 0; (x < sizeof(gMutexProfileInfo) / sizeof(gMutexProfileInfo[0])) &&
+         (pProfile == NULL); x++) {
+        if (gMutexProfileInfo[x].pFile == NULL) {
+            if (pFree == NULL) {
+                pFree = &(gMutexProfileInfo[x]);
+            }
+        } else if ((gMutexProfileInfo[x].line == line) &&
+                   ((gMutexProfileInfo[x].pFile == pFile) ||
+                    (strcmp(gMutexProfileInfo[x].pFile, pFile) == 0))) {
+            pProfile = &(gMutexProfileInfo[x]);
+        }
+    }
+
+    if ((pProfile == NULL) && (pFree != NULL)) {
+        pProfile = pFree;
+        memset(pProfile, 0, sizeof(*pProfile));
+        pProfile->pFile = pFile;
+        pProfile->line = line;
+    }
+
+    if (pProfile != NULL) {
+        pProfile->numMutexes++;
+    } else {
+        gMutexProfileNumNotProfiled++;
+    }
+
+    return pProfile;
+}
+#endif
+
 // Free a mutex information block.
 // gMutexList should be locked before this is called.
 static void freeMutexInformationBlock(uMutexInfo_t *pMutexInfo)
@@ -322,16 +394,47 @@ static uMutexFunctionInfo_t *pLockAddWaiting(uMutexInfo_t *pMutexInfo,
     return pWaiting;
 }
 
-// Move a waiting entry to become a locker entry.
+// Move a waiting entry to become a locker entry; waitStartUs
+// is the time at which the wait for the lock began, or -1 if the
+// mutex was obtained without waiting (only used for profiling).
 static bool lockMoveWaitingToLocker(uMutexInfo_t *pMutexInfo,
-                                    uMutexFunctionInfo_t *pWaiting)
+                                    uMutexFunctionInfo_t *pWaiting,
+                                    int64_t waitStartUs)
 {
     bool success = false;
+#ifdef U_CFG_MUTEX_DEBUG_PROFILE
+    uMutexProfileInfo_t *pProfile;
+    int64_t waitUs = 0;
+#endif
 
     if ((gMutexList != NULL) && (pMutexInfo != NULL)) {
 
+#ifdef U_CFG_MUTEX_DEBUG_PROFILE
+        // We own the underlying mutex now so this is safe
+        pMutexInfo->lockedTimeUs = uPortGetTickTimeUs();
+        if (waitStartUs >= 0) {
+            waitUs = pMutexInfo->lockedTimeUs - waitStartUs;
+        }
+#else
+        (void) waitStartUs;
+#endif
+
         U_MUTEX_DEBUG_PORT_MUTEX_LOCK(gMutexList);
 
+#ifdef U_CFG_MUTEX_DEBUG_PROFILE
+        pProfile = pMutexInfo->pProfile;
+        if (pProfile != NULL) {
+            pProfile->numAcquisitions++;
+            if (waitStartUs >= 0) {
+                pProfile->numContended++;
+                pProfile->waitTotalUs += waitUs;
+                if (waitUs > pProfile->waitMaxUs) {
+                    pProfile->waitMaxUs = waitUs;
+                }
+            }
+        }
+#endif
+
         // If there is a locker, free it, it's gone
         freeFunctionInformationBlock(pMutexInfo->pLocker);
         // Unlink the waiting entry in the list, noting
@@ -353,14 +456,24 @@ static bool lockMoveWaitingToLocker(uMutexInfo_t *pMutexInfo,
     return success;
 }
 
-// Free a waiting entry.
+// Free a waiting entry; timedOut is set to true if this is
+// because a try-lock timed out (only used for profiling).
 static void lockFreeWaiting(uMutexInfo_t *pMutexInfo,
-                            uMutexFunctionInfo_t *pWaiting)
+                            uMutexFunctionInfo_t *pWaiting,
+                            bool timedOut)
 {
     if ((gMutexList != NULL) && (pMutexInfo != NULL)) {
 
         U_MUTEX_DEBUG_PORT_MUTEX_LOCK(gMutexList);
 
+#ifdef U_CFG_MUTEX_DEBUG_PROFILE
+        if (timedOut && (pMutexInfo->pProfile != NULL)) {
+            pMutexInfo->pProfile->numTimeouts++;
+        }
+#else
+        (void) timedOut;
+#endif
+
         // Find the waiting entry in the list and free it
         unlinkWaiting(pMutexInfo, pWaiting);
         freeFunctionInformationBlock(pWaiting);
@@ -466,6 +579,10 @@ int32_t uMutexDebugCreate(uPortMutexHandle_t *pMutexHandle,
                 pMutexInfo->pLocker = NULL;
                 pMutexInfo->pWaiting = NULL;
                 if (_uPortMutexCreate(&(pMutexInfo->handle)) == 0) {
+#ifdef U_CFG_MUTEX_DEBUG_PROFILE
+                    pMutexInfo->pProfile = pFindProfileInformationBlock(pFile, line);
+                    pMutexInfo->lockedTimeUs = 0;
+#endif
                     // Add the entry to the front of the list
                     pTmp = gpMutexInfoList;
                     gpMutexInfoList = pMutexInfo;
@@ -514,6 +631,7 @@ int32_t uMutexDebugLock(uPortMutexHandle_t mutexHandle,
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uMutexInfo_t *pMutexInfo = (uMutexInfo_t *) mutexHandle;
     uMutexFunctionInfo_t *pWaiting;
+    int64_t waitStartUs = -1;
 
     if (gMutexList != NULL) {
 
@@ -524,13 +642,22 @@ int32_t uMutexDebugLock(uPortMutexHandle_t mutexHandle,
         errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
         pWaiting = pLockAddWaiting(pMutexInfo, pFile, line);
         if (pWaiting != NULL) {
+#ifdef U_CFG_MUTEX_DEBUG_PROFILE
+            // Find out if the mutex is contended before waiting on it
+            errorCode = _uPortMutexTryLock(pMutexInfo->handle, 0);
+            if (errorCode != 0) {
+                waitStartUs = uPortGetTickTimeUs();
+                errorCode = _uPortMutexLock(pMutexInfo->handle);
+            }
+#else
             errorCode = _uPortMutexLock(pMutexInfo->handle);
+#endif
             if (errorCode == 0) {
-                if (!lockMoveWaitingToLocker(pMutexInfo, pWaiting)) {
-                    lockFreeWaiting(pMutexInfo, pWaiting);
+                if (!lockMoveWaitingToLocker(pMutexInfo, pWaiting, waitStartUs)) {
+                    lockFreeWaiting(pMutexInfo, pWaiting, false);
                 }
             } else {
-                lockFreeWaiting(pMutexInfo, pWaiting);
+                lockFreeWaiting(pMutexInfo, pWaiting, false);
             }
         }
     }
@@ -547,6 +674,7 @@ int32_t uMutexDebugTryLock(uPortMutexHandle_t mutexHandle,
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uMutexInfo_t *pMutexInfo = (uMutexInfo_t *) mutexHandle;
     uMutexFunctionInfo_t *pWaiting;
+    int64_t waitStartUs = -1;
 
     if (gMutexList != NULL) {
 
@@ -557,13 +685,22 @@ int32_t uMutexDebugTryLock(uPortMutexHandle_t mutexHandle,
         errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
         pWaiting = pLockAddWaiting(pMutexInfo, pFile, line);
         if (pWaiting != NULL) {
+#ifdef U_CFG_MUTEX_DEBUG_PROFILE
+            // Find out if the mutex is contended before waiting on it
+            errorCode = _uPortMutexTryLock(pMutexInfo->handle, 0);
+            if ((errorCode != 0) && (delayMs > 0)) {
+                waitStartUs = uPortGetTickTimeUs();
+                errorCode = _uPortMutexTryLock(pMutexInfo->handle, delayMs);
+            }
+#else
             errorCode = _uPortMutexTryLock(pMutexInfo->handle, delayMs);
+#endif
             if (errorCode == 0) {
-                if (!lockMoveWaitingToLocker(pMutexInfo, pWaiting)) {
-                    lockFreeWaiting(pMutexInfo, pWaiting);
+                if (!lockMoveWaitingToLocker(pMutexInfo, pWaiting, waitStartUs)) {
+                    lockFreeWaiting(pMutexInfo, pWaiting, false);
                 }
             } else {
-                lockFreeWaiting(pMutexInfo, pWaiting);
+                lockFreeWaiting(pMutexInfo, pWaiting, true);
             }
         }
     }
@@ -576,11 +713,27 @@ int32_t uMutexDebugUnlock(uPortMutexHandle_t mutexHandle)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uMutexInfo_t *pMutexInfo = (uMutexInfo_t *) mutexHandle;
+#ifdef U_CFG_MUTEX_DEBUG_PROFILE
+    uMutexProfileInfo_t *pProfile;
+    int64_t holdUs;
+#endif
 
     if (gMutexList != NULL) {
 
         U_MUTEX_DEBUG_PORT_MUTEX_LOCK(gMutexList);
 
+#ifdef U_CFG_MUTEX_DEBUG_PROFILE
+        // Only count the hold time if we believe we are locked
+        pProfile = pMutexInfo->pProfile;
+        if ((pProfile != NULL) && (pMutexInfo->pLocker != NULL)) {
+            holdUs = uPortGetTickTimeUs() - pMutexInfo->lockedTimeUs;
+            pProfile->holdTotalUs += holdUs;
+            if (holdUs > pProfile->holdMaxUs) {
+                pProfile->holdMaxUs = holdUs;
+            }
+        }
+#endif
+
         // Unlock the mutex and free the locker entry
         errorCode = _uPortMutexUnlock(pMutexInfo->handle);
         freeFunctionInformationBlock(pMutexInfo->pLocker);
@@ -604,6 +757,10 @@ int32_t uMutexDebugInit(void)
     if (gMutexList == NULL) {
         memset(gMutexInfo, 0, sizeof(gMutexInfo));
         memset(gMutexFunctionInfo, 0, sizeof(gMutexFunctionInfo));
+#ifdef U_CFG_MUTEX_DEBUG_PROFILE
+        memset(gMutexProfileInfo, 0, sizeof(gMutexProfileInfo));
+        gMutexProfileNumNotProfiled = 0;
+#endif
         errorCode = _uPortMutexCreate(&gMutexList);
     }
 
@@ -749,6 +906,126 @@ void uMutexDebugPrint(void *pParam)
     }
 }
 
+// Print out the lock contention statistics.
+void uMutexDebugProfilePrint(void *pParam)
+{
+#ifdef U_CFG_MUTEX_DEBUG_PROFILE
+    int32_t entries = 0;
+    int32_t acquisitions = 0;
+    int32_t contended = 0;
+    uMutexProfileInfo_t *pProfile;
+
+    (void) pParam;
+
+    if (gMutexList != NULL) {
+
+        U_MUTEX_DEBUG_PORT_MUTEX_LOCK(gMutexList);
+
+        for (size_t x = 0; x < sizeof(gMutexProfileInfo) / sizeof(gMutexProfileInfo[0]); x++) {
+            pProfile = &(gMutexProfileInfo[x]);
+            if (pProfile->pFile != NULL) {
+                uPortLog("U_MUTEX_DEBUG_PROFILE: %s:%d (%d mutex(es)): %d lock(s),"
+                         " %d contended, %d timeout(s), wait total %d ms max %d us,"
+                         " hold total %d ms max %d us.\n",
+                         pProfile->pFile, pProfile->line, pProfile->numMutexes,
+                         pProfile->numAcquisitions, pProfile->numContended,
+                         pProfile->numTimeouts,
+                         (int32_t) (pProfile->waitTotalUs / 1000),
+                         (int32_t) pProfile->waitMaxUs,
+                         (int32_t) (pProfile->holdTotalUs / 1000),
+                         (int32_t) pProfile->holdMaxUs);
+                acquisitions += pProfile->numAcquisitions;
+                contended += pProfile->numContended;
+                entries++;
+            }
+        }
+
+        uPortLog("U_MUTEX_DEBUG_PROFILE: %d creation point(s), %d lock(s), %d contended,"
+                 " %d mutex(es) not profiled.\n", entries, acquisitions, contended,
+                 gMutexProfileNumNotProfiled);
+
+        U_MUTEX_DEBUG_PORT_MUTEX_UNLOCK(gMutexList);
+    }
+#else
+    (void) pParam;
+    uPortLog("U_MUTEX_DEBUG_PROFILE: define U_CFG_MUTEX_DEBUG_PROFILE to profile mutexes.\n");
+#endif
+}
+
+// Reset the lock contention statistics.
+void uMutexDebugProfileReset(void)
+{
+#ifdef U_CFG_MUTEX_DEBUG_PROFILE
+    uMutexProfileInfo_t *pProfile;
+
+    if (gMutexList != NULL) {
+
+        U_MUTEX_DEBUG_PORT_MUTEX_LOCK(gMutexList);
+
+        // Keep the identity of each entry, since live
+        // mutexes point to them, and zero the rest
+        for (size_t x = 0; x < sizeof(gMutexProfileInfo) / sizeof(gMutexProfileInfo[0]); x++) {
+            pProfile = &(gMutexProfileInfo[x]);
+            pProfile->numAcquisitions = 0;
+            pProfile->numContended = 0;
+            pProfile->numTimeouts = 0;
+            pProfile->waitTotalUs = 0;
+            pProfile->waitMaxUs = 0;
+            pProfile->holdTotalUs = 0;
+            pProfile->holdMaxUs = 0;
+        }
+        gMutexProfileNumNotProfiled = 0;
+
+        U_MUTEX_DEBUG_PORT_MUTEX_UNLOCK(gMutexList);
+    }
+#endif
+}
+
+// Get the lock contention statistics for a mutex creation point.
+int32_t uMutexDebugProfileGet(const char *pFile, int32_t line,
+                              uMutexDebugProfile_t *pProfile)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+#ifdef U_CFG_MUTEX_DEBUG_PROFILE
+    const uMutexProfileInfo_t *pInfo;
+
+    errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    if (gMutexList != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pFile != NULL) && (pProfile != NULL)) {
+
+            U_MUTEX_DEBUG_PORT_MUTEX_LOCK(gMutexList);
+
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+            for (size_t x = 0; (x < sizeof(gMutexProfileInfo) / sizeof(gMutexProfileInfo[0])) &&
+                 (errorCode != 0); x++) {
+                pInfo = &(gMutexProfileInfo[x]);
+                if ((pInfo->pFile != NULL) && (pInfo->line == line) &&
+                    ((pInfo->pFile == pFile) || (strcmp(pInfo->pFile, pFile) == 0))) {
+                    pProfile->numMutexes = pInfo->numMutexes;
+                    pProfile->numAcquisitions = pInfo->numAcquisitions;
+                    pProfile->numContended = pInfo->numContended;
+                    pProfile->numTimeouts = pInfo->numTimeouts;
+                    pProfile->waitTotalUs = pInfo->waitTotalUs;
+                    pProfile->waitMaxUs = pInfo->waitMaxUs;
+                    pProfile->holdTotalUs = pInfo->holdTotalUs;
+                    pProfile->holdMaxUs = pInfo->holdMaxUs;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                }
+            }
+
+            U_MUTEX_DEBUG_PORT_MUTEX_UNLOCK(gMutexList);
+        }
+    }
+#else
+    (void) pFile;
+    (void) line;
+    (void) pProfile;
+#endif
+
+    return errorCode;
+}
+
 #endif // U_CFG_MUTEX_DEBUG
 
 // End of file
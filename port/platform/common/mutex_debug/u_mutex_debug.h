@@ -90,6 +90,26 @@
  * U_MUTEX_DEBUG_0x2000a7e8: created by C:/projects/ubxlib/port/platform/stm32cube/src/u_port_uart.c:892 approx. 12 second(s) ago is not locked.
  * U_MUTEX_DEBUG_0x2000a840: created by C:/projects/ubxlib/port/platform/common/event_queue/u_port_event_queue.c:229 approx. 12 second(s) ago is not locked.
  * U_MUTEX_DEBUG: 3 mutex(es), 1 locked, a maximum of 1 waiting, max waiting time approx. 12 second(s).
+ *
+ * If, in addition, U_CFG_MUTEX_DEBUG_PROFILE is defined then the
+ * lock and unlock intermediates here also keep lock contention
+ * statistics, measured with uPortGetTickTimeUs(); these are kept
+ * per mutex creation point (file and line), so all of the mutexes
+ * created at the same line are counted together and the statistics
+ * survive the mutexes being deleted.  For each creation point the
+ * number of acquisitions, the number of those acquisitions which
+ * found the mutex already locked (contended), the total and
+ * maximum time spent waiting for a lock and the total and maximum
+ * time the mutex was held are recorded, along with the number of
+ * timed-out uPortMutexTryLock() calls.  Call uMutexDebugProfilePrint()
+ * at any time to print them out, e.g.:
+ *
+ * U_MUTEX_DEBUG_PROFILE: C:/projects/ubxlib/port/platform/common/event_queue/u_port_event_queue.c:229 (1 mutex(es)): 3079 lock(s), 12 contended, 0 timeout(s), wait total 1 ms max 213 us, hold total 31 ms max 396 us.
+ *
+ * ...and uMutexDebugProfileReset() to start counting again.  Note
+ * that the profile uses a zero timeout uPortMutexTryLock() of the
+ * underlying mutex in order to detect contention, so when profiling
+ * is enabled a lock involves one additional OS call.
  */
 
 #ifdef __cplusplus
@@ -127,10 +147,34 @@ extern "C" {
 # define U_MUTEX_DEBUG_WATCHDOG_MAX_BARK_SECONDS 10
 #endif
 
+#ifndef U_MUTEX_DEBUG_PROFILE_INFO_MAX_NUM
+/** The maximum number of mutex creation points (file and line)
+ * for which lock contention statistics are kept when
+ * U_CFG_MUTEX_DEBUG_PROFILE is defined; mutexes created at
+ * further points are simply not profiled.
+ */
+# define U_MUTEX_DEBUG_PROFILE_INFO_MAX_NUM 48
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The lock contention statistics for a mutex creation point, see
+ * uMutexDebugProfileGet().
+ */
+typedef struct {
+    int32_t numMutexes;      /**< the number of mutexes created at this point. */
+    int32_t numAcquisitions; /**< the number of times they were locked. */
+    int32_t numContended;    /**< the number of those locks which found
+                                  the mutex already locked. */
+    int32_t numTimeouts;     /**< the number of timed-out try-locks. */
+    int64_t waitTotalUs;     /**< the total time spent waiting for a lock. */
+    int64_t waitMaxUs;       /**< the longest time spent waiting for a lock. */
+    int64_t holdTotalUs;     /**< the total time the mutexes were held. */
+    int64_t holdMaxUs;       /**< the longest time a mutex was held. */
+} uMutexDebugProfile_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: INTERMEDIATES FOR THE uPortMutex* FUNCTIONS
  * -------------------------------------------------------------- */
@@ -279,6 +323,39 @@ int32_t uMutexDebugWatchdog(void (*pCallback) (void *),
  */
 void uMutexDebugPrint(void *pParam);
 
+/** Print out the lock contention statistics gathered so far for
+ * each mutex creation point; only does anything useful if
+ * U_CFG_MUTEX_DEBUG_PROFILE is defined.  May be passed as a callback
+ * to uMutexDebugWatchdog().
+ *
+ * @param pParam  a dummy parameter so that this function matches
+ *                the function signature for uMutexDebugWatchdog().
+ */
+void uMutexDebugProfilePrint(void *pParam);
+
+/** Reset the lock contention statistics, e.g. after start-up, so
+ * that only what follows is profiled; only does anything if
+ * U_CFG_MUTEX_DEBUG_PROFILE is defined.
+ */
+void uMutexDebugProfileReset(void);
+
+/** Get the lock contention statistics for a mutex creation point;
+ * only supported if U_CFG_MUTEX_DEBUG_PROFILE is defined.
+ *
+ * @param[in] pFile     the file the mutexes were created in, as
+ *                      given by __FILE__ at the point of creation;
+ *                      cannot be NULL.
+ * @param line          the line in pFile they were created at.
+ * @param[out] pProfile a place to put the statistics; cannot be NULL.
+ * @return              zero on success, U_ERROR_COMMON_NOT_FOUND if
+ *                      no mutex has been profiled at that point,
+ *                      U_ERROR_COMMON_NOT_SUPPORTED if
+ *                      U_CFG_MUTEX_DEBUG_PROFILE is not defined, else
+ *                      negative error code.
+ */
+int32_t uMutexDebugProfileGet(const char *pFile, int32_t line,
+                              uMutexDebugProfile_t *pProfile);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief The platform-independent part of the cycle counter API:
+ * accumulation of start/stop intervals on top of the free-running
+ * counter provided by each platform in uPortPerfCounterGetCycles().
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()
+
+#include "u_port_perf_counter.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Reset a cycle counter.
+void uPortPerfCounterReset(uPortPerfCounter_t *pCounter)
+{
+    memset(pCounter, 0, sizeof(*pCounter));
+}
+
+// Start an interval.
+void uPortPerfCounterStart(uPortPerfCounter_t *pCounter)
+{
+    if (!pCounter->running) {
+        pCounter->startCycles = uPortPerfCounterGetCycles();
+        pCounter->running = true;
+    }
+}
+
+// Stop an interval.
+uint32_t uPortPerfCounterStop(uPortPerfCounter_t *pCounter)
+{
+    uint32_t cycles = 0;
+
+    if (pCounter->running) {
+        // Unsigned arithmetic takes care of a single wrap
+        cycles = uPortPerfCounterGetCycles() - pCounter->startCycles;
+        pCounter->totalCycles += cycles;
+        pCounter->numIntervals++;
+        pCounter->running = false;
+    }
+
+    return cycles;
+}
+
+// Read the total.
+uint64_t uPortPerfCounterRead(const uPortPerfCounter_t *pCounter)
+{
+    uint64_t cycles = pCounter->totalCycles;
+
+    if (pCounter->running) {
+        cycles += (uint32_t) (uPortPerfCounterGetCycles() - pCounter->startCycles);
+    }
+
+    return cycles;
+}
+
+// Convert cycles to microseconds.
+int64_t uPortPerfCounterCyclesToUs(uint64_t cycles)
+{
+    int64_t microseconds = 0;
+    int32_t frequencyHz = uPortPerfCounterGetFrequencyHz();
+
+    if (frequencyHz > 0) {
+        // Whole seconds first to avoid overflow
+        microseconds = (int64_t) (cycles / (uint32_t) frequencyHz) * 1000000 +
+                       (int64_t) (((cycles % (uint32_t) frequencyHz) * 1000000) /
+                                  (uint32_t) frequencyHz);
+    }
+
+    return microseconds;
+}
+
+// End of file
@@ -0,0 +1,379 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief The implementation of the task registry.  There is no
+ * mutex, since the registry has to work before uPortInit() and
+ * after uPortDeinit(); instead a simple spin-lock, backed off with
+ * uPortTaskBlock(), protects the static storage.  The lock is held
+ * across the call to uPortTaskCreate() so that a task which deletes
+ * itself immediately is guaranteed to find itself in the live table.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset(), strncpy(), strncmp()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h" // U_CFG_OS_YIELD_MS
+#include "u_compiler.h" // U_MEMORY_BARRIER, U_ATOMIC_COMPARE_AND_SWAP
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+
+#include "u_task_registry.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The prefix for prints from this module.
+ */
+#define U_TASK_REGISTRY_PREFIX "U_TASK_REGISTRY: "
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A task that is currently running.
+ */
+typedef struct {
+    uPortTaskHandle_t handle; /**< NULL if this row is free. */
+    int32_t entryIndex;       /**< the index into gEntry. */
+} uTaskRegistryLive_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The spin-lock protecting everything below.
+ */
+static volatile uint32_t gLock = 0;
+
+/** The registry entries; the suggested values are only filled
+ * in when an entry is copied out.
+ */
+static uTaskRegistryEntry_t gEntry[U_TASK_REGISTRY_MAX_NUM];
+
+/** The number of entries in use in gEntry.
+ */
+static size_t gNumEntries = 0;
+
+/** The tasks that are currently running.
+ */
+static uTaskRegistryLive_t gLive[U_TASK_REGISTRY_LIVE_MAX_NUM];
+
+/** The percentage by which to reduce stack sizes.
+ */
+static int32_t gShrinkPercent = 0;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Take the lock.
+static void lock()
+{
+    while (!U_ATOMIC_COMPARE_AND_SWAP(&gLock, 0, 1)) {
+        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+    }
+}
+
+// Give the lock back.
+static void unlock()
+{
+    U_MEMORY_BARRIER();
+    gLock = 0;
+}
+
+// Find an entry by name, adding it if it's not there; returns
+// -1 if the registry is full.  Must be called with the lock held.
+static int32_t entryFindOrAdd(const char *pName)
+{
+    int32_t index = -1;
+
+    if (pName == NULL) {
+        pName = "";
+    }
+    for (size_t x = 0; (x < gNumEntries) && (index < 0); x++) {
+        if (strncmp(gEntry[x].name, pName, sizeof(gEntry[x].name) - 1) == 0) {
+            index = (int32_t) x;
+        }
+    }
+    if ((index < 0) && (gNumEntries < sizeof(gEntry) / sizeof(gEntry[0]))) {
+        index = (int32_t) gNumEntries;
+        memset(&(gEntry[index]), 0, sizeof(gEntry[index]));
+        strncpy(gEntry[index].name, pName, sizeof(gEntry[index].name) - 1);
+        gEntry[index].stackMinFreeBytes = -1;
+        gEntry[index].queueMinFree = -1;
+        gNumEntries++;
+    }
+
+    return index;
+}
+
+// Find a live task by handle, NULL meaning the current task;
+// returns -1 if not found.  Must be called with the lock held.
+static int32_t liveFind(const uPortTaskHandle_t handle)
+{
+    int32_t index = -1;
+
+    for (size_t x = 0; (x < sizeof(gLive) / sizeof(gLive[0])) && (index < 0); x++) {
+        if ((gLive[x].handle != NULL) &&
+            (((handle != NULL) && (gLive[x].handle == handle)) ||
+             ((handle == NULL) && uPortTaskIsThis(gLive[x].handle)))) {
+            index = (int32_t) x;
+        }
+    }
+
+    return index;
+}
+
+// Sample the stack high-water mark of a live task.  Must be called
+// with the lock held.
+static void liveSample(const uTaskRegistryLive_t *pLive)
+{
+    uTaskRegistryEntry_t *pEntry = &(gEntry[pLive->entryIndex]);
+    int32_t minFree = uPortTaskStackMinFree(pLive->handle);
+
+    if ((minFree >= 0) &&
+        ((pEntry->stackMinFreeBytes < 0) || (minFree < pEntry->stackMinFreeBytes))) {
+        pEntry->stackMinFreeBytes = minFree;
+    }
+}
+
+// Copy an entry out, filling in the suggestions.  Must be called
+// with the lock held.
+static void entryCopy(const uTaskRegistryEntry_t *pEntry,
+                      uTaskRegistryEntry_t *pCopy)
+{
+    size_t used;
+
+    *pCopy = *pEntry;
+    if ((pEntry->stackMinFreeBytes >= 0) &&
+        ((size_t) pEntry->stackMinFreeBytes <= pEntry->stackSizeBytes)) {
+        used = pEntry->stackSizeBytes - (size_t) pEntry->stackMinFreeBytes;
+        // Add the margin and round up to a multiple of eight
+        used += U_TASK_REGISTRY_STACK_MARGIN_BYTES + 7;
+        pCopy->stackSizeSuggestedBytes = used - (used % 8);
+    }
+    if ((pEntry->queueLength > 0) && (pEntry->queueMinFree >= 0) &&
+        ((size_t) pEntry->queueMinFree <= pEntry->queueLength)) {
+        // One more than the most that was ever used
+        pCopy->queueLengthSuggested = pEntry->queueLength - (size_t) pEntry->queueMinFree + 1;
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Create a task and record it in the registry.
+int32_t uTaskRegistryTaskCreate(void (*pFunction)(void *),
+                                const char *pName,
+                                size_t stackSizeBytes,
+                                void *pParameter,
+                                int32_t priority,
+                                uPortTaskHandle_t *pTaskHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    size_t size = stackSizeBytes;
+    int32_t entryIndex;
+    bool done = false;
+
+    if (pTaskHandle != NULL) {
+        lock();
+        if (gShrinkPercent > 0) {
+            size = (stackSizeBytes * (size_t) (100 - gShrinkPercent)) / 100;
+            if (size < U_TASK_REGISTRY_STACK_MIN_BYTES) {
+                size = U_TASK_REGISTRY_STACK_MIN_BYTES;
+            }
+            if (size > stackSizeBytes) {
+                size = stackSizeBytes;
+            }
+        }
+        // Lock held across task creation, see file header
+        errorCode = uPortTaskCreate(pFunction, pName, size,
+                                    pParameter, priority, pTaskHandle);
+        if (errorCode == 0) {
+            entryIndex = entryFindOrAdd(pName);
+            if (entryIndex >= 0) {
+                if (stackSizeBytes > gEntry[entryIndex].stackSizeConfiguredBytes) {
+                    gEntry[entryIndex].stackSizeConfiguredBytes = stackSizeBytes;
+                }
+                if (size != gEntry[entryIndex].stackSizeBytes) {
+                    // The high-water mark is relative to the stack size
+                    gEntry[entryIndex].stackSizeBytes = size;
+                    gEntry[entryIndex].stackMinFreeBytes = -1;
+                }
+                gEntry[entryIndex].instancesCreated++;
+                gEntry[entryIndex].instancesRunning++;
+                for (size_t x = 0; (x < sizeof(gLive) / sizeof(gLive[0])) && !done; x++) {
+                    if (gLive[x].handle == NULL) {
+                        gLive[x].handle = *pTaskHandle;
+                        gLive[x].entryIndex = entryIndex;
+                        done = true;
+                    }
+                }
+            }
+        }
+        unlock();
+    }
+
+    return errorCode;
+}
+
+// Delete a task created with uTaskRegistryTaskCreate().
+int32_t uTaskRegistryTaskDelete(const uPortTaskHandle_t taskHandle)
+{
+    int32_t liveIndex;
+
+    lock();
+    liveIndex = liveFind(taskHandle);
+    if (liveIndex >= 0) {
+        liveSample(&(gLive[liveIndex]));
+        if (gEntry[gLive[liveIndex].entryIndex].instancesRunning > 0) {
+            gEntry[gLive[liveIndex].entryIndex].instancesRunning--;
+        }
+        gLive[liveIndex].handle = NULL;
+    }
+    // Must unlock before deleting since, if this is
+    // the current task, uPortTaskDelete() won't return
+    unlock();
+
+    return uPortTaskDelete(taskHandle);
+}
+
+// Record the queue served by a task.
+int32_t uTaskRegistryQueueUpdate(const uPortTaskHandle_t taskHandle,
+                                 size_t queueLength, size_t itemSizeBytes,
+                                 int32_t minFree)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uTaskRegistryEntry_t *pEntry;
+    int32_t liveIndex;
+
+    if (taskHandle != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        lock();
+        liveIndex = liveFind(taskHandle);
+        if (liveIndex >= 0) {
+            pEntry = &(gEntry[gLive[liveIndex].entryIndex]);
+            if (queueLength != pEntry->queueLength) {
+                pEntry->queueLength = queueLength;
+                pEntry->queueMinFree = -1;
+            }
+            pEntry->queueItemSizeBytes = itemSizeBytes;
+            if ((minFree >= 0) &&
+                ((pEntry->queueMinFree < 0) || (minFree < pEntry->queueMinFree))) {
+                pEntry->queueMinFree = minFree;
+            }
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+        unlock();
+    }
+
+    return errorCode;
+}
+
+// Get the contents of the registry.
+int32_t uTaskRegistryGet(uTaskRegistryEntry_t *pEntries, size_t numEntries)
+{
+    int32_t numEntriesOrError;
+
+    lock();
+    for (size_t x = 0; x < sizeof(gLive) / sizeof(gLive[0]); x++) {
+        if (gLive[x].handle != NULL) {
+            liveSample(&(gLive[x]));
+        }
+    }
+    for (size_t x = 0; (pEntries != NULL) && (x < gNumEntries) && (x < numEntries); x++) {
+        entryCopy(&(gEntry[x]), pEntries + x);
+    }
+    numEntriesOrError = (int32_t) gNumEntries;
+    unlock();
+
+    return numEntriesOrError;
+}
+
+// Print the contents of the registry.
+void uTaskRegistryPrint()
+{
+    uTaskRegistryEntry_t entry;
+    int32_t numEntries;
+
+    // Call this to sample the tasks that are running
+    numEntries = uTaskRegistryGet(NULL, 0);
+    uPortLog(U_TASK_REGISTRY_PREFIX "%d task(s), stack shrink %d%%.\n",
+             numEntries, gShrinkPercent);
+    for (int32_t x = 0; x < numEntries; x++) {
+        // One at a time to keep stack usage down
+        lock();
+        entryCopy(&(gEntry[x]), &entry);
+        unlock();
+        uPortLog(U_TASK_REGISTRY_PREFIX "\"%s\": created %d, running %d, stack"
+                 " configured %d, actual %d, min free %d, suggested %d",
+                 entry.name, entry.instancesCreated, entry.instancesRunning,
+                 (int32_t) entry.stackSizeConfiguredBytes, (int32_t) entry.stackSizeBytes,
+                 entry.stackMinFreeBytes, (int32_t) entry.stackSizeSuggestedBytes);
+        if (entry.queueLength > 0) {
+            uPortLog(", queue length %d (item %d byte(s)), min free %d,"
+                     " suggested %d", (int32_t) entry.queueLength,
+                     (int32_t) entry.queueItemSizeBytes, entry.queueMinFree,
+                     (int32_t) entry.queueLengthSuggested);
+        }
+        uPortLog(".\n");
+    }
+}
+
+// Set the stack shrink percentage.
+int32_t uTaskRegistryShrinkSet(int32_t percent)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((percent >= 0) && (percent < 100)) {
+        gShrinkPercent = percent;
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Clear the registry.
+void uTaskRegistryClear()
+{
+    lock();
+    memset(gEntry, 0, sizeof(gEntry));
+    gNumEntries = 0;
+    memset(gLive, 0, sizeof(gLive));
+    unlock();
+}
+
+// End of file
@@ -0,0 +1,224 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_TASK_REGISTRY_H_
+#define _U_TASK_REGISTRY_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "stdint.h"
+#include "stddef.h"
+#include "stdbool.h"
+
+#include "u_port_os.h"
+
+/** @file
+ * @brief A registry of the tasks, and their queues, that ubxlib
+ * creates: for each one (by name) it keeps the stack size that was
+ * asked for, the stack size actually used, the stack high-water
+ * mark, sampled when the task is deleted or when uTaskRegistryGet()
+ * is called, and, where the task serves a queue, the queue length
+ * and the minimum number of free queue entries seen.  From these a
+ * suggested stack size and queue length are derived, so that the
+ * U_CFG_xxx_STACK_SIZE_BYTES/U_CFG_xxx_QUEUE_LENGTH values of an
+ * application can be tuned after a representative run by calling
+ * uTaskRegistryPrint().
+ *
+ * uTaskRegistryShrinkSet() may be used to reduce every stack by a
+ * percentage at run-time, without a rebuild, in order to find out
+ * how far the stacks can be brought down before things go wrong.
+ *
+ * The registry uses static storage only, it requires no
+ * initialisation and its contents persist across uPortDeinit(),
+ * so that the high-water marks of tasks that have exited are not
+ * lost.  The functions are thread-safe but must not be called
+ * from an interrupt.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_TASK_REGISTRY_MAX_NUM
+/** The maximum number of distinct task names that may be recorded
+ * in the registry; tasks beyond this are still created, they are
+ * just not recorded.
+ */
+# define U_TASK_REGISTRY_MAX_NUM 16
+#endif
+
+#ifndef U_TASK_REGISTRY_LIVE_MAX_NUM
+/** The maximum number of tasks that may be tracked while they are
+ * running; tasks beyond this are still created, their high-water
+ * mark just won't be sampled.
+ */
+# define U_TASK_REGISTRY_LIVE_MAX_NUM 16
+#endif
+
+#ifndef U_TASK_REGISTRY_NAME_MAX_LENGTH_BYTES
+/** The maximum length of a task name stored in the registry,
+ * including room for a null terminator; longer names are
+ * truncated.
+ */
+# define U_TASK_REGISTRY_NAME_MAX_LENGTH_BYTES 24
+#endif
+
+#ifndef U_TASK_REGISTRY_STACK_MARGIN_BYTES
+/** The margin to add to the stack actually used by a task when
+ * suggesting a stack size.
+ */
+# define U_TASK_REGISTRY_STACK_MARGIN_BYTES 256
+#endif
+
+#ifndef U_TASK_REGISTRY_STACK_MIN_BYTES
+/** The smallest stack size that uTaskRegistryShrinkSet() will
+ * reduce a stack to.
+ */
+# define U_TASK_REGISTRY_STACK_MIN_BYTES 512
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** An entry in the task registry, as returned by uTaskRegistryGet().
+ */
+typedef struct {
+    char name[U_TASK_REGISTRY_NAME_MAX_LENGTH_BYTES]; /**< the task name. */
+    size_t stackSizeConfiguredBytes; /**< the largest stack size asked for. */
+    size_t stackSizeBytes;           /**< the stack size the task was
+                                          created with, after any shrink. */
+    int32_t stackMinFreeBytes;       /**< the minimum stack free seen
+                                          across all instances of the task,
+                                          -1 if not (yet) known. */
+    size_t stackSizeSuggestedBytes;  /**< the suggested stack size, zero
+                                          if not (yet) known. */
+    size_t queueLength;              /**< the length of the queue served
+                                          by the task, zero if none. */
+    size_t queueItemSizeBytes;       /**< the size of an item on that
+                                          queue. */
+    int32_t queueMinFree;            /**< the minimum number of free
+                                          queue entries seen, -1 if not
+                                          known. */
+    size_t queueLengthSuggested;     /**< the suggested queue length,
+                                          zero if not known. */
+    int32_t instancesCreated;        /**< the number of times a task
+                                          of this name was created. */
+    int32_t instancesRunning;        /**< the number of instances of the
+                                          task still running. */
+} uTaskRegistryEntry_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Create a task and record it in the registry: a drop-in
+ * replacement for uPortTaskCreate(), the parameters of which
+ * are identical.  If uTaskRegistryShrinkSet() has been called
+ * the stack size is reduced accordingly.
+ *
+ * @param pFunction        the function that forms the task.
+ * @param pName            a null-terminated string naming the task,
+ *                         may be NULL.
+ * @param stackSizeBytes   the number of bytes of memory to dynamically
+ *                         allocate for stack.
+ * @param pParameter       a pointer that will be passed to pFunction
+ *                         when the task is started; may be NULL.
+ * @param priority         the priority at which to run the task.
+ * @param[out] pTaskHandle a place to put the handle of the created
+ *                         task.
+ * @return                 zero on success else negative error code.
+ */
+int32_t uTaskRegistryTaskCreate(void (*pFunction)(void *),
+                                const char *pName,
+                                size_t stackSizeBytes,
+                                void *pParameter,
+                                int32_t priority,
+                                uPortTaskHandle_t *pTaskHandle);
+
+/** Delete a task created with uTaskRegistryTaskCreate(), first
+ * sampling its stack high-water mark: a drop-in replacement for
+ * uPortTaskDelete().
+ *
+ * @param taskHandle  the handle of the task to be deleted; use
+ *                    NULL to delete the current task.
+ * @return            zero on success else negative error code.
+ */
+int32_t uTaskRegistryTaskDelete(const uPortTaskHandle_t taskHandle);
+
+/** Record the queue served by a task created with
+ * uTaskRegistryTaskCreate(); may be called as often as required,
+ * queueMinFree is only ever reduced.
+ *
+ * @param taskHandle     the handle of the task.
+ * @param queueLength    the length of the queue.
+ * @param itemSizeBytes  the size of an item on the queue.
+ * @param minFree        the number of free entries on the queue
+ *                       just seen, use -1 if not known.
+ * @return               zero on success else negative error code.
+ */
+int32_t uTaskRegistryQueueUpdate(const uPortTaskHandle_t taskHandle,
+                                 size_t queueLength, size_t itemSizeBytes,
+                                 int32_t minFree);
+
+/** Get the contents of the registry, sampling the stack
+ * high-water mark of any tasks still running first.
+ *
+ * @param[out] pEntries a place to put the entries; may be NULL,
+ *                      in which case just the number of entries
+ *                      is returned.
+ * @param numEntries    the number of entries pEntries can hold.
+ * @return              the number of entries in the registry (which
+ *                      may be more than numEntries) else negative
+ *                      error code.
+ */
+int32_t uTaskRegistryGet(uTaskRegistryEntry_t *pEntries, size_t numEntries);
+
+/** Print the contents of the registry, with suggested stack sizes
+ * and queue lengths, using uPortLog().
+ */
+void uTaskRegistryPrint();
+
+/** Set the percentage by which the stack size of all tasks
+ * subsequently created through uTaskRegistryTaskCreate() is
+ * reduced, e.g. 25 to make every stack three-quarters of the
+ * size asked for; stacks are never reduced below
+ * #U_TASK_REGISTRY_STACK_MIN_BYTES.  The default is zero.
+ *
+ * @param percent the percentage, 0 to 99.
+ * @return        zero on success else negative error code.
+ */
+int32_t uTaskRegistryShrinkSet(int32_t percent);
+
+/** Clear the registry; should only be called when no tasks created
+ * through uTaskRegistryTaskCreate() are running.
+ */
+void uTaskRegistryClear();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_TASK_REGISTRY_H_
+
+// End of file
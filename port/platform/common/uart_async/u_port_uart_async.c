@@ -0,0 +1,318 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ * @brief Implementation of uPortUartWriteAsync() and uPortUartWriteV()
+ * on top of uPortUartWrite(); this will run on any platform.
+ *
+ * Each UART instance that is given an asynchronous write gets an
+ * event queue of its own, opened on first use and closed when the
+ * UART instance is closed; the task of the event queue calls
+ * uPortUartWrite(), which, where the platform sends using DMA or
+ * interrupts, blocks on the completion of the transfer, and then
+ * calls the user's completion callback.  Since an event queue is
+ * drained before it is closed, closing a UART instance completes
+ * any outstanding writes.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdio.h"     // snprintf()
+#include "string.h"    // memcpy()
+
+#include "u_cfg_os_platform_specific.h"
+#include "u_error_common.h"
+#include "u_port_os.h"
+#include "u_port_event_queue.h"
+#include "u_port_uart.h"
+
+#include "u_port_uart_async_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The asynchronous write state of a UART instance.
+ */
+typedef struct {
+    int32_t uartHandle;
+    int32_t eventQueueHandle;
+} uPortUartAsync_t;
+
+/** An asynchronous write, as sent to the event queue.
+ */
+typedef struct {
+    int32_t uartHandle;
+    const void *pBuffer;
+    size_t sizeBytes;
+    uPortUartWriteCallback_t *pCallback;
+    void *pCallbackParam;
+} uPortUartAsyncWrite_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Mutex to protect gUartAsync.
+ */
+static uPortMutexHandle_t gMutex = NULL;
+
+/** The asynchronous write state of each UART instance that has
+ * been given an asynchronous write; an entry is free if
+ * eventQueueHandle is negative.
+ */
+static uPortUartAsync_t gUartAsync[U_PORT_UART_WRITE_ASYNC_MAX_NUM];
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Event queue callback: perform a write and call the callback.
+static void eventHandler(void *pParam, size_t paramLength)
+{
+    uPortUartAsyncWrite_t write;
+    int32_t sizeOrErrorCode;
+
+    (void) paramLength;
+
+    // Copy the write out since pParam is not guaranteed to be
+    // aligned for a structure containing pointers
+    memcpy(&write, pParam, sizeof(write));
+    sizeOrErrorCode = uPortUartWrite(write.uartHandle,
+                                     write.pBuffer,
+                                     write.sizeBytes);
+    if (write.pCallback != NULL) {
+        write.pCallback(write.uartHandle, sizeOrErrorCode,
+                        write.pCallbackParam);
+    }
+}
+
+// Find the entry for the given UART handle, or a free one
+// if there is none and findFree is true.
+// Note: gMutex should be locked before this is called.
+static uPortUartAsync_t *pFindEntry(int32_t uartHandle, bool findFree)
+{
+    uPortUartAsync_t *pEntry = NULL;
+    uPortUartAsync_t *pFree = NULL;
+
+    for (size_t x = 0; (pEntry == NULL) &&
+         (x < sizeof(gUartAsync) / sizeof(gUartAsync[0])); x++) {
+        if (gUartAsync[x].eventQueueHandle >= 0) {
+            if (gUartAsync[x].uartHandle == uartHandle) {
+                pEntry = &(gUartAsync[x]);
+            }
+        } else if (pFree == NULL) {
+            pFree = &(gUartAsync[x]);
+        }
+    }
+
+    if ((pEntry == NULL) && findFree) {
+        pEntry = pFree;
+    }
+
+    return pEntry;
+}
+
+// Remove an entry, returning its event queue handle, which the
+// caller should close once gMutex has been unlocked.
+// Note: gMutex should be locked before this is called.
+static int32_t entryRemove(uPortUartAsync_t *pEntry)
+{
+    int32_t eventQueueHandle = pEntry->eventQueueHandle;
+
+    pEntry->uartHandle = -1;
+    pEntry->eventQueueHandle = -1;
+
+    return eventQueueHandle;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS THAT ARE PRIVATE TO THE PORT LAYER
+ * -------------------------------------------------------------- */
+
+// Initialise asynchronous UART writes.
+int32_t uPortUartAsyncPrivateInit(void)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+
+    if (gMutex == NULL) {
+        for (size_t x = 0; x < sizeof(gUartAsync) / sizeof(gUartAsync[0]); x++) {
+            gUartAsync[x].uartHandle = -1;
+            gUartAsync[x].eventQueueHandle = -1;
+        }
+        errorCode = uPortMutexCreate(&gMutex);
+    }
+
+    return errorCode;
+}
+
+// Deinitialise asynchronous UART writes.
+void uPortUartAsyncPrivateDeinit(void)
+{
+    int32_t eventQueueHandle;
+
+    if (gMutex != NULL) {
+        for (size_t x = 0; x < sizeof(gUartAsync) / sizeof(gUartAsync[0]); x++) {
+            U_PORT_MUTEX_LOCK(gMutex);
+            eventQueueHandle = entryRemove(&(gUartAsync[x]));
+            U_PORT_MUTEX_UNLOCK(gMutex);
+            if (eventQueueHandle >= 0) {
+                // Closing the event queue completes any
+                // outstanding writes
+                uPortEventQueueClose(eventQueueHandle);
+            }
+        }
+        uPortMutexDelete(gMutex);
+        gMutex = NULL;
+    }
+}
+
+// Complete and free asynchronous writes on a UART instance.
+void uPortUartAsyncPrivateClose(int32_t handle)
+{
+    uPortUartAsync_t *pEntry;
+    int32_t eventQueueHandle = -1;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pEntry = pFindEntry(handle, false);
+        if (pEntry != NULL) {
+            eventQueueHandle = entryRemove(pEntry);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+
+        if (eventQueueHandle >= 0) {
+            // Closing the event queue completes any
+            // outstanding writes
+            uPortEventQueueClose(eventQueueHandle);
+        }
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Write to the given UART interface without waiting.
+int32_t uPortUartWriteAsync(int32_t handle, const void *pBuffer,
+                            size_t sizeBytes,
+                            uPortUartWriteCallback_t *pCallback,
+                            void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uPortUartAsync_t *pEntry;
+    uPortUartAsyncWrite_t write;
+    int32_t eventQueueHandle = -1;
+    char name[16];
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pBuffer != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pEntry = pFindEntry(handle, true);
+            if (pEntry != NULL) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                if (pEntry->eventQueueHandle < 0) {
+                    // First asynchronous write on this UART: check
+                    // that the handle is valid, which is all
+                    // uPortUartGetReceiveSize() is used for here,
+                    // and open an event queue for it
+                    errorCode = uPortUartGetReceiveSize(handle);
+                    if (errorCode >= 0) {
+                        snprintf(name, sizeof(name), "uartTx_%d", (int) handle);
+                        errorCode = uPortEventQueueOpen(eventHandler, name,
+                                                        sizeof(uPortUartAsyncWrite_t),
+                                                        U_PORT_UART_WRITE_ASYNC_TASK_STACK_SIZE_BYTES,
+                                                        U_PORT_UART_WRITE_ASYNC_TASK_PRIORITY,
+                                                        U_PORT_UART_WRITE_ASYNC_QUEUE_LENGTH);
+                    }
+                    if (errorCode >= 0) {
+                        pEntry->uartHandle = handle;
+                        pEntry->eventQueueHandle = errorCode;
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    }
+                }
+                eventQueueHandle = pEntry->eventQueueHandle;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+
+        if (errorCode == 0) {
+            // Send outside the mutex since this may block
+            // if the queue is full
+            write.uartHandle = handle;
+            write.pBuffer = pBuffer;
+            write.sizeBytes = sizeBytes;
+            write.pCallback = pCallback;
+            write.pCallbackParam = pCallbackParam;
+            errorCode = uPortEventQueueSend(eventQueueHandle,
+                                            &write, sizeof(write));
+        }
+    }
+
+    return errorCode;
+}
+
+// Write a number of buffers to the given UART interface.
+int32_t uPortUartWriteV(int32_t handle,
+                        const uPortUartWriteVector_t *pVector,
+                        size_t count)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    bool keepGoing = true;
+    int32_t x;
+
+    if (pVector != NULL) {
+        sizeOrErrorCode = 0;
+        for (size_t y = 0; (y < count) && keepGoing; y++) {
+            if (pVector[y].sizeBytes > 0) {
+                x = uPortUartWrite(handle, pVector[y].pBuffer,
+                                   pVector[y].sizeBytes);
+                if (x >= 0) {
+                    sizeOrErrorCode += x;
+                    // Give up on a short write
+                    keepGoing = ((size_t) x == pVector[y].sizeBytes);
+                } else {
+                    if (sizeOrErrorCode == 0) {
+                        // Nothing sent at all, return the error
+                        sizeOrErrorCode = x;
+                    }
+                    keepGoing = false;
+                }
+            }
+        }
+    }
+
+    return sizeOrErrorCode;
+}
+
+// End of file
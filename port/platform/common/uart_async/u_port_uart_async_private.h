@@ -0,0 +1,75 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_PORT_UART_ASYNC_PRIVATE_H_
+#define _U_PORT_UART_ASYNC_PRIVATE_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** @file
+ * @brief private API for asynchronous UART writes: initialisation,
+ * deinitialisation and close, which should be called internally by
+ * the UART porting layer of each platform.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Initialise asynchronous UART writes; should be called by
+ * uPortUartInit().
+ *
+ * @return  zero on success else negative error code.
+ */
+int32_t uPortUartAsyncPrivateInit(void);
+
+/** Deinitialise asynchronous UART writes, completing any that are
+ * outstanding; should be called by uPortUartDeinit() BEFORE its
+ * own mutex is locked since outstanding writes will need it.
+ */
+void uPortUartAsyncPrivateDeinit(void);
+
+/** Complete any outstanding asynchronous writes on the given UART
+ * instance and free the resources associated with them; should be
+ * called by uPortUartClose() BEFORE its own mutex is locked since
+ * outstanding writes will need it.
+ *
+ * @param handle  the handle of the UART instance.
+ */
+void uPortUartAsyncPrivateClose(int32_t handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_PORT_UART_ASYNC_PRIVATE_H_
+
+// End of file
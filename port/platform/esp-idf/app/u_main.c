@@ -113,6 +113,10 @@ static void appTask(void *pParam)
     // called deinit so call init again here.
     uPortInit();
 
+#ifdef U_CFG_MUTEX_DEBUG_PROFILE
+    uMutexDebugProfilePrint(NULL);
+#endif
+
     UNITY_END();
 
     uPortDeinit();
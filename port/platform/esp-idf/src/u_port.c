@@ -30,6 +30,7 @@
 #include "u_port.h"
 #include "u_port_os.h"
 #include "u_port_uart.h"
+#include "u_port_perf_counter.h"
 #include "u_port_event_queue_private.h"
 #include "u_port_private.h"
 
@@ -38,6 +39,8 @@
 
 #include "esp_timer.h" // For esp_timer_get_time()
 #include "esp_system.h" // For esp_get_minimum_free_heap_size()
+#include "hal/cpu_hal.h" // For cpu_hal_get_cycle_count()
+#include "esp32/clk.h"   // For esp_clk_cpu_freq()
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -138,6 +141,25 @@ int32_t uPortGetTickTimeMs()
     return esp_timer_get_time() / 1000;
 }
 
+// Get the current high resolution time in microseconds.
+int64_t uPortGetTickTimeUs()
+{
+    return esp_timer_get_time();
+}
+
+// Get the current value of the cycle counter: CCOUNT, which
+// is always running and is per-core.
+uint32_t uPortPerfCounterGetCycles()
+{
+    return cpu_hal_get_cycle_count();
+}
+
+// Get the frequency of the cycle counter.
+int32_t uPortPerfCounterGetFrequencyHz()
+{
+    return (int32_t) esp_clk_cpu_freq();
+}
+
 // Get the minimum amount of heap free, ever, in bytes.
 int32_t uPortGetHeapMinFree()
 {
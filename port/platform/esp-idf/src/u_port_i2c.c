@@ -29,6 +29,7 @@
 #include "u_port_debug.h"
 #include "u_port_os.h"
 #include "u_port_i2c.h"
+#include "u_port_i2c_async_private.h"
 
 #include "driver/i2c.h"
 
@@ -252,12 +253,19 @@ int32_t uPortI2cInit()
         }
     }
 
+    if (errorCode == 0) {
+        errorCode = uPortI2cAsyncPrivateInit();
+    }
+
     return errorCode;
 }
 
 // Shutdown I2C handling.
 void uPortI2cDeinit()
 {
+    // Complete any asynchronous transfers first, they need the mutex
+    uPortI2cAsyncPrivateDeinit();
+
     if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
@@ -289,6 +297,9 @@ int32_t uPortI2cAdopt(int32_t i2c, bool controller)
 // Close an I2C instance.
 void uPortI2cClose(int32_t handle)
 {
+    // Complete any asynchronous transfers first, they need the mutex
+    uPortI2cAsyncPrivateClose(handle);
+
     if ((gMutex != NULL) && (handle >= 0) &&
         (handle < sizeof(gI2cData) / sizeof(gI2cData[0]))) {
 
@@ -305,6 +316,9 @@ int32_t uPortI2cCloseRecoverBus(int32_t handle)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
 
+    // Complete any asynchronous transfers first, they need the mutex
+    uPortI2cAsyncPrivateClose(handle);
+
     if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
@@ -261,9 +261,11 @@ int32_t uPortQueueSendIrq(const uPortQueueHandle_t queueHandle,
         }
     }
 
-    // Required for correct FreeRTOS operation
+    // Required for correct FreeRTOS operation: a task switch
+    // from an interrupt must be requested with portYIELD_FROM_ISR(),
+    // taskYIELD() is not interrupt-safe
     if (yield) {
-        taskYIELD();
+        portYIELD_FROM_ISR();
     }
 
     return (int32_t) errorCode;
@@ -528,9 +530,11 @@ int32_t uPortSemaphoreGiveIrq(const uPortSemaphoreHandle_t semaphoreHandle)
         }
     }
 
-    // Required for correct FreeRTOS operation
+    // Required for correct FreeRTOS operation: a task switch
+    // from an interrupt must be requested with portYIELD_FROM_ISR(),
+    // taskYIELD() is not interrupt-safe
     if (yield) {
-        taskYIELD();
+        portYIELD_FROM_ISR();
     }
 
     return (int32_t) errorCode;
@@ -34,6 +34,7 @@
 #include "u_port.h"
 #include "u_port_os.h"
 #include "u_port_uart.h"
+#include "u_port_uart_async_private.h"
 
 #include "driver/uart.h"
 
@@ -66,6 +67,8 @@ typedef struct {
     uint32_t eventFilter;
     void (*pEventCallback)(int32_t, uint32_t, void *);
     void *pEventCallbackParam;
+    int32_t eventDelimiter; /**< Negative if not set. */
+    int32_t eventDelimiterTimeoutMs;
 } uPortUartData_t;
 
 /* ----------------------------------------------------------------
@@ -153,6 +156,46 @@ static void uartCloseRequiresMutex(int32_t handle)
     }
 }
 
+// Get one of our UART events from an ESP32 UART event when a
+// delimiter has been set: data is only passed on when the
+// pattern-detect interrupt has seen the delimiter, the receive
+// buffer is full or the event was sent by uPortUartEventSend()
+// (which sets size to zero); *pPending is set if there is data
+// which has yet to be passed on.
+static uint32_t getEventFromEsp32EventDelimited(int32_t handle,
+                                                const uart_event_t *pEsp32Event,
+                                                bool *pPending)
+{
+    uint32_t event = 0;
+    int32_t position;
+
+    switch (pEsp32Event->type) {
+        case UART_PATTERN_DET:
+            // We don't need the positions but the driver stops
+            // detecting the pattern if its queue of them fills up
+            do {
+                position = uart_pattern_pop_pos(handle);
+            } while (position >= 0);
+        // fall-through
+        case UART_BUFFER_FULL:
+            event = U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED;
+            *pPending = false;
+            break;
+        case UART_DATA:
+            if (pEsp32Event->size == 0) {
+                event = U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED;
+                *pPending = false;
+            } else {
+                *pPending = true;
+            }
+            break;
+        default:
+            break;
+    }
+
+    return event;
+}
+
 // Event handler.  If an event callback is registered for a UART
 // this will be run in a task of its own for that UART.
 static void eventTask(void *pParam)
@@ -160,20 +203,54 @@ static void eventTask(void *pParam)
     uart_event_t event;
     int32_t handle = (int32_t) pParam;
     uint32_t eventBitMask;
+    bool pending = false;
+    bool wasPending;
+    int32_t pendingStartMs = 0;
+    int32_t waitMs;
+    int32_t errorCode;
 
     U_PORT_MUTEX_LOCK(gUartData[handle].eventTaskRunningMutex);
 
     do {
-        if (uPortQueueReceive((const uPortQueueHandle_t) gUartData[handle].queue,
-                              &event) == 0) {
-            // Check if it is in the filter
-            eventBitMask = getEventFromEsp32Event(event.type);
-            if (eventBitMask & gUartData[handle].eventFilter) {
-                // Call the callback
-                if (gUartData[handle].pEventCallback != NULL) {
-                    gUartData[handle].pEventCallback(handle, eventBitMask,
-                                                     gUartData[handle].pEventCallbackParam);
+        eventBitMask = 0;
+        if (pending) {
+            // Data has been received but no delimiter yet: only
+            // wait the rest of the delimiter timeout for one
+            waitMs = pendingStartMs + gUartData[handle].eventDelimiterTimeoutMs -
+                     uPortGetTickTimeMs();
+            if (waitMs < 0) {
+                waitMs = 0;
+            }
+            errorCode = uPortQueueTryReceive((const uPortQueueHandle_t) gUartData[handle].queue,
+                                             waitMs, &event);
+            if (errorCode != 0) {
+                // Pass the data on without a delimiter
+                event.type = UART_DATA;
+                eventBitMask = U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED;
+                pending = false;
+            }
+        } else {
+            errorCode = uPortQueueReceive((const uPortQueueHandle_t) gUartData[handle].queue,
+                                          &event);
+        }
+        if (errorCode == 0) {
+            if (gUartData[handle].eventDelimiter >= 0) {
+                wasPending = pending;
+                eventBitMask = getEventFromEsp32EventDelimited(handle, &event, &pending);
+                if (pending && !wasPending) {
+                    pendingStartMs = uPortGetTickTimeMs();
                 }
+            } else {
+                eventBitMask = getEventFromEsp32Event(event.type);
+                pending = false;
+            }
+        }
+        // Check if it is in the filter
+        if (eventBitMask & gUartData[handle].eventFilter) {
+            // Call the callback
+            if (gUartData[handle].pEventCallback != NULL) {
+                gUartData[handle].pEventCallback(handle, eventBitMask,
+                                                 gUartData[handle].pEventCallbackParam);
             }
         }
     } while (event.type < UART_EVENT_MAX);
@@ -201,12 +278,19 @@ int32_t uPortUartInit()
         }
     }
 
+    if (errorCode == U_ERROR_COMMON_SUCCESS) {
+        errorCode = uPortUartAsyncPrivateInit();
+    }
+
     return errorCode;
 }
 
 // Deinitialise the UART driver.
 void uPortUartDeinit()
 {
+    // Complete any asynchronous writes first, they need the mutex
+    uPortUartAsyncPrivateDeinit();
+
     if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
@@ -269,6 +353,8 @@ int32_t uPortUartOpen(int32_t uart, int32_t baudRate,
             gUartData[uart].pEventCallback = NULL;
             gUartData[uart].pEventCallbackParam = NULL;
             gUartData[uart].eventFilter = 0;
+            gUartData[uart].eventDelimiter = -1;
+            gUartData[uart].eventDelimiterTimeoutMs = 0;
 
             // Set the things that won't change
             config.data_bits  = UART_DATA_8_BITS;
@@ -339,6 +425,9 @@ void uPortUartClose(int32_t handle)
 {
     bool closeIt = false;
 
+    // Complete any asynchronous writes first, they need the mutex
+    uPortUartAsyncPrivateClose(handle);
+
     if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
@@ -421,6 +510,22 @@ int32_t uPortUartRead(int32_t handle, void *pBuffer,
     return sizeOrErrorCode;
 }
 
+// Get the contiguous span of received data: not supported.
+int32_t uPortUartPeekSpan(int32_t handle, const char **ppData)
+{
+    (void) handle;
+    (void) ppData;
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
+// Consume received data: not supported.
+int32_t uPortUartConsume(int32_t handle, size_t sizeBytes)
+{
+    (void) handle;
+    (void) sizeBytes;
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
 // Write to the given UART interface.
 int32_t uPortUartWrite(int32_t handle,
                        const void *pBuffer,
@@ -540,6 +645,13 @@ void uPortUartEventCallbackRemove(int32_t handle)
         if (removeIt) {
             // Delete the event task and it's associated gubbins
             deleteEventTaskRequiresMutex(handle);
+            // The delimiter goes with the event callback
+            U_PORT_MUTEX_LOCK(gMutex);
+            if (gUartData[handle].eventDelimiter >= 0) {
+                uart_disable_pattern_det_intr(handle);
+                gUartData[handle].eventDelimiter = -1;
+            }
+            U_PORT_MUTEX_UNLOCK(gMutex);
         }
     }
 }
@@ -667,6 +779,49 @@ int32_t uPortUartEventTrySend(int32_t handle, uint32_t eventBitMap,
     return errorCode;
 }
 
+// Set a delimiter for the data received event.
+int32_t uPortUartEventDelimiterSet(int32_t handle, int32_t delimiter,
+                                   int32_t timeoutMs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((handle >= 0) &&
+            (handle < sizeof(gUartData) / sizeof(gUartData[0])) &&
+            !gUartData[handle].markedForDeletion &&
+            (gUartData[handle].eventTaskRunningMutex != NULL) &&
+            (delimiter <= 0xFF) && ((delimiter < 0) || (timeoutMs >= 0))) {
+            errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+            if (delimiter >= 0) {
+                // A pattern of a single character with no idle
+                // time required either side of it; the position
+                // queue has to be set up for pattern detection
+                // to work
+                if ((uart_enable_pattern_det_baud_intr(handle, (char) delimiter,
+                                                       1, 9, 0, 0) == ESP_OK) &&
+                    (uart_pattern_queue_reset(handle, U_PORT_UART_EVENT_QUEUE_SIZE) == ESP_OK)) {
+                    gUartData[handle].eventDelimiterTimeoutMs = timeoutMs;
+                    gUartData[handle].eventDelimiter = delimiter;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                }
+            } else {
+                if (uart_disable_pattern_det_intr(handle) == ESP_OK) {
+                    gUartData[handle].eventDelimiter = -1;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCode;
+}
+
 // Return true if we're in an event callback.
 bool uPortUartEventIsCallback(int32_t handle)
 {
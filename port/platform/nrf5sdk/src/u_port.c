@@ -36,6 +36,7 @@
 #include "u_port_os.h"
 #include "u_port_gpio.h"
 #include "u_port_uart.h"
+#include "u_port_perf_counter.h"
 #include "u_port_private.h"
 #include "u_port_event_queue_private.h"
 
@@ -46,6 +47,7 @@
 #include "FreeRTOS.h"
 #include "task.h"
 
+#include "nrf.h" // For DWT and SystemCoreClock
 #include "nrf_drv_clock.h"
 #include "nrf_log.h"
 #include "nrf_log_ctrl.h"
@@ -70,6 +72,13 @@ static bool gInitialised = false;
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Enable the DWT cycle counter for uPortPerfCounterGetCycles().
+static void perfCounterEnable()
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -142,6 +151,9 @@ int32_t uPortInit()
             }
         }
         gInitialised = (errorCode == 0);
+        if (gInitialised) {
+            perfCounterEnable();
+        }
     }
 
     return errorCode;
@@ -170,6 +182,30 @@ int32_t uPortGetTickTimeMs()
     return tickTime;
 }
 
+// Get the current high resolution time in microseconds.
+int64_t uPortGetTickTimeUs()
+{
+    int64_t tickTime = 0;
+
+    if (gInitialised) {
+        tickTime = uPortPrivateGetTickTimeUs();
+    }
+
+    return tickTime;
+}
+
+// Get the current value of the cycle counter: the DWT cycle counter.
+uint32_t uPortPerfCounterGetCycles()
+{
+    return DWT->CYCCNT;
+}
+
+// Get the frequency of the cycle counter.
+int32_t uPortPerfCounterGetFrequencyHz()
+{
+    return (int32_t) SystemCoreClock;
+}
+
 // Get the minimum amount of heap free, ever, in bytes.
 int32_t uPortGetHeapMinFree()
 {
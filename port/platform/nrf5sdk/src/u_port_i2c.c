@@ -33,6 +33,7 @@
 #include "u_port.h"
 #include "u_port_os.h"
 #include "u_port_i2c.h"
+#include "u_port_i2c_async_private.h"
 #include "u_port_private.h"
 
 #include "FreeRTOS.h"
@@ -277,6 +278,10 @@ int32_t uPortI2cInit()
         }
     }
 
+    if (errorCode == 0) {
+        errorCode = uPortI2cAsyncPrivateInit();
+    }
+
     return errorCode;
 #else
     return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -286,6 +291,9 @@ int32_t uPortI2cInit()
 // Shutdown I2C handling.
 void uPortI2cDeinit()
 {
+    // Complete any asynchronous transfers first, they need the mutex
+    uPortI2cAsyncPrivateDeinit();
+
     if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
@@ -317,6 +325,9 @@ int32_t uPortI2cAdopt(int32_t i2c, bool controller)
 // Close an I2C instance.
 void uPortI2cClose(int32_t handle)
 {
+    // Complete any asynchronous transfers first, they need the mutex
+    uPortI2cAsyncPrivateClose(handle);
+
     if ((gMutex != NULL) && (handle >= 0) &&
         (handle < sizeof(gI2cData) / sizeof(gI2cData[0]))) {
 
@@ -335,6 +346,9 @@ int32_t uPortI2cCloseRecoverBus(int32_t handle)
     int32_t pinSda;
     int32_t pinSdc;
 
+    // Complete any asynchronous transfers first, they need the mutex
+    uPortI2cAsyncPrivateClose(handle);
+
     if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
@@ -268,10 +268,10 @@ int32_t uPortQueueSendIrq(const uPortQueueHandle_t queueHandle,
         }
     }
 
-    // Required for correct FreeRTOS operation
-    if (yield) {
-        taskYIELD();
-    }
+    // Required for correct FreeRTOS operation: a task switch
+    // from an interrupt must be requested with portEND_SWITCHING_ISR(),
+    // taskYIELD() is not interrupt-safe
+    portEND_SWITCHING_ISR(yield);
 
     return (int32_t) errorCode;
 }
@@ -535,10 +535,10 @@ int32_t uPortSemaphoreGiveIrq(const uPortSemaphoreHandle_t semaphoreHandle)
         }
     }
 
-    // Required for correct FreeRTOS operation
-    if (yield) {
-        taskYIELD();
-    }
+    // Required for correct FreeRTOS operation: a task switch
+    // from an interrupt must be requested with portEND_SWITCHING_ISR(),
+    // taskYIELD() is not interrupt-safe
+    portEND_SWITCHING_ISR(yield);
 
     return (int32_t) errorCode;
 }
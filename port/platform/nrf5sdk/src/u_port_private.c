@@ -483,6 +483,33 @@ int64_t uPortPrivateGetTickTimeMs()
     return tickTimerValue;
 }
 
+// Get the current tick time in microseconds: the same as
+// uPortPrivateGetTickTimeMs() but without throwing away the
+// 32 us resolution of the timer.
+int64_t uPortPrivateGetTickTimeUs()
+{
+    int64_t tickTimerValue = 0;
+
+    // Read the timer
+    tickTimerValue = nrfx_timer_capture(&gTickTimer,
+                                        U_PORT_TICK_TIMER_CAPTURE_CHANNEL);
+
+    // Add any offset from converting to UART mode.
+    tickTimerValue += gTickTimerOffset;
+
+    // One tick every 32 us, so shift left 5
+    tickTimerValue = ((uint64_t) tickTimerValue) << 5;
+    if (gTickTimerUartMode) {
+        // Each overflow of the 11 bit timer is 65536 microseconds
+        tickTimerValue += ((uint64_t) gTickTimerOverflowCount) << 16;
+    } else {
+        // Each overflow of the 24 bit timer is 2 ^ 29 microseconds
+        tickTimerValue += ((uint64_t) gTickTimerOverflowCount) << 29;
+    }
+
+    return tickTimerValue;
+}
+
 // Add a timer entry to the list.
 int32_t uPortPrivateTimerCreate(uPortTimerHandle_t *pHandle,
                                 const char *pName,
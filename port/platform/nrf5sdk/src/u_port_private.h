@@ -123,6 +123,11 @@ void uPortPrivateDeinit();
  */
 int64_t uPortPrivateGetTickTimeMs();
 
+/** Get the current tick time in microseconds, with the best
+ * resolution the tick source offers.
+ */
+int64_t uPortPrivateGetTickTimeUs();
+
 /** Register a callback to be called when tick timer
  * overflow interrupt occurs.
  *
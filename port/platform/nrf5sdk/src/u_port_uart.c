@@ -55,6 +55,7 @@
 #include "u_port_os.h"
 #include "u_port_event_queue.h"
 #include "u_port_uart.h"
+#include "u_port_uart_async_private.h"
 #include "u_port_private.h"
 
 #include "FreeRTOS.h"
@@ -301,6 +302,9 @@ static void uartClose(int32_t handle)
         }
     }
 }
+// Let the user know that data has been received; if an event is
+// already waiting there is no need to send another, the user will
+// read all the data.
 static void userNotify(uPortUartData_t *pUartData)
 {
 
@@ -309,8 +313,8 @@ static void userNotify(uPortUartData_t *pUartData)
         uPortUartEvent_t event;
         event.uartHandle = pUartData->uartHandle;
         event.eventBitMap = U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED;
-        uPortEventQueueSendIrq(pUartData->eventQueueHandle,
-                               &event, sizeof(event));
+        uPortEventQueueSendIrqOnce(pUartData->eventQueueHandle,
+                                   &event, sizeof(event));
     }
 }
 
@@ -542,12 +546,19 @@ int32_t uPortUartInit()
         }
     }
 
+    if (errorCode == U_ERROR_COMMON_SUCCESS) {
+        errorCode = (uErrorCode_t) uPortUartAsyncPrivateInit();
+    }
+
     return (int32_t) errorCode;
 }
 
 // Deinitialise the UART driver.
 void uPortUartDeinit()
 {
+    // Complete any asynchronous writes first, they need the mutex
+    uPortUartAsyncPrivateDeinit();
+
     if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
@@ -677,6 +688,9 @@ int32_t uPortUartOpen(int32_t uart, int32_t baudRate,
 // Close a UART instance.
 void uPortUartClose(int32_t handle)
 {
+    // Complete any asynchronous writes first, they need the mutex
+    uPortUartAsyncPrivateClose(handle);
+
     if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
@@ -759,6 +773,22 @@ int32_t uPortUartRead(int32_t handle, void *pBuffer,
     return (int32_t) sizeOrErrorCode;
 }
 
+// Get the contiguous span of received data: not supported.
+int32_t uPortUartPeekSpan(int32_t handle, const char **ppData)
+{
+    (void) handle;
+    (void) ppData;
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
+// Consume received data: not supported.
+int32_t uPortUartConsume(int32_t handle, size_t sizeBytes)
+{
+    (void) handle;
+    (void) sizeBytes;
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
 // Write to the given UART interface.
 int32_t uPortUartWrite(int32_t handle, const void *pBuffer,
                        size_t sizeBytes)
@@ -1027,6 +1057,19 @@ int32_t uPortUartEventStackMinFree(int32_t handle)
     return sizeOrErrorCode;
 }
 
+// Set a delimiter for the data received event.
+int32_t uPortUartEventDelimiterSet(int32_t handle, int32_t delimiter,
+                                   int32_t timeoutMs)
+{
+    (void) handle;
+    (void) delimiter;
+    (void) timeoutMs;
+
+    // Not supported on this platform: events are passed on
+    // as they arrive
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
 // Determine if RTS flow control is enabled.
 bool uPortUartIsRtsFlowControlEnabled(int32_t handle)
 {
@@ -25,11 +25,13 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
+#include "u_error_common.h"
 #include "u_port.h"
 #include "u_port_debug.h"
 #include "u_port_os.h"
 #include "u_port_gpio.h"
 #include "u_port_uart.h"
+#include "u_port_perf_counter.h"
 #include "u_port_i2c.h"
 #include "u_port_event_queue.h"
 #include "u_port_crypto.h"
@@ -57,6 +59,18 @@ int32_t uPortGetTickTimeMs()
 {
     return 0;
 }
+int64_t uPortGetTickTimeUs()
+{
+    return 0;
+}
+uint32_t uPortPerfCounterGetCycles()
+{
+    return 0;
+}
+int32_t uPortPerfCounterGetFrequencyHz()
+{
+    return 0;
+}
 int32_t uPortGetHeapMinFree()
 {
     return 0;
@@ -348,6 +362,18 @@ int32_t uPortUartRead(int32_t handle, void *pBuffer,
     (void) sizeBytes;
     return 0;
 }
+int32_t uPortUartPeekSpan(int32_t handle, const char **ppData)
+{
+    (void) handle;
+    (void) ppData;
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+int32_t uPortUartConsume(int32_t handle, size_t sizeBytes)
+{
+    (void) handle;
+    (void) sizeBytes;
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
 int32_t uPortUartWrite(int32_t handle, const void *pBuffer,
                        size_t sizeBytes)
 {
@@ -411,6 +437,14 @@ int32_t uPortUartEventStackMinFree(int32_t handle)
     (void) handle;
     return 0;
 }
+int32_t uPortUartEventDelimiterSet(int32_t handle, int32_t delimiter,
+                                   int32_t timeoutMs)
+{
+    (void) handle;
+    (void) delimiter;
+    (void) timeoutMs;
+    return 0;
+}
 bool uPortUartIsRtsFlowControlEnabled(int32_t handle)
 {
     (void) handle;
@@ -562,5 +596,97 @@ int32_t uPortCryptoAes128CbcDecrypt(const char *pKey,
     (void) pOutput;
     return 0;
 }
+int32_t uPortCryptoSha256Init(void **ppContext)
+{
+    (void) ppContext;
+    return 0;
+}
+int32_t uPortCryptoSha256Update(void *pContext,
+                                const char *pInput,
+                                size_t inputLengthBytes)
+{
+    (void) pContext;
+    (void) pInput;
+    (void) inputLengthBytes;
+    return 0;
+}
+int32_t uPortCryptoSha256Final(void *pContext, char *pOutput)
+{
+    (void) pContext;
+    (void) pOutput;
+    return 0;
+}
+int32_t uPortCryptoHmacSha256Init(void **ppContext,
+                                  const char *pKey,
+                                  size_t keyLengthBytes)
+{
+    (void) ppContext;
+    (void) pKey;
+    (void) keyLengthBytes;
+    return 0;
+}
+int32_t uPortCryptoHmacSha256Update(void *pContext,
+                                    const char *pInput,
+                                    size_t inputLengthBytes)
+{
+    (void) pContext;
+    (void) pInput;
+    (void) inputLengthBytes;
+    return 0;
+}
+int32_t uPortCryptoHmacSha256Final(void *pContext, char *pOutput)
+{
+    (void) pContext;
+    (void) pOutput;
+    return 0;
+}
+int32_t uPortCryptoMd5Init(void **ppContext)
+{
+    (void) ppContext;
+    return 0;
+}
+int32_t uPortCryptoMd5Update(void *pContext,
+                             const char *pInput,
+                             size_t inputLengthBytes)
+{
+    (void) pContext;
+    (void) pInput;
+    (void) inputLengthBytes;
+    return 0;
+}
+int32_t uPortCryptoMd5Final(void *pContext, char *pOutput)
+{
+    (void) pContext;
+    (void) pOutput;
+    return 0;
+}
+int32_t uPortCryptoAes128CbcInit(void **ppContext,
+                                 const char *pKey,
+                                 size_t keyLengthBytes,
+                                 const char *pInitVector,
+                                 bool encrypt)
+{
+    (void) ppContext;
+    (void) pKey;
+    (void) keyLengthBytes;
+    (void) pInitVector;
+    (void) encrypt;
+    return 0;
+}
+int32_t uPortCryptoAes128CbcUpdate(void *pContext,
+                                   const char *pInput,
+                                   size_t lengthBytes,
+                                   char *pOutput)
+{
+    (void) pContext;
+    (void) pInput;
+    (void) lengthBytes;
+    (void) pOutput;
+    return 0;
+}
+void uPortCryptoAes128CbcFinal(void *pContext)
+{
+    (void) pContext;
+}
 
 // End of file
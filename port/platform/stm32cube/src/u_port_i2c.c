@@ -28,6 +28,7 @@
 #include "u_port_os.h"
 #include "u_port_gpio.h" // For unblocking
 #include "u_port_i2c.h"
+#include "u_port_i2c_async_private.h"
 
 #include "stm32f4xx_ll_bus.h"
 #include "stm32f4xx_ll_gpio.h"
@@ -661,12 +662,19 @@ int32_t uPortI2cInit()
         }
     }
 
+    if (errorCode == 0) {
+        errorCode = uPortI2cAsyncPrivateInit();
+    }
+
     return errorCode;
 }
 
 // Shutdown I2C handling.
 void uPortI2cDeinit()
 {
+    // Complete any asynchronous transfers first, they need the mutex
+    uPortI2cAsyncPrivateDeinit();
+
     if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
@@ -700,6 +708,9 @@ int32_t uPortI2cAdopt(int32_t i2c, bool controller)
 void uPortI2cClose(int32_t handle)
 {
     // > 0 rather than >= 0 below 'cos ST number their UARTs from 1
+    // Complete any asynchronous transfers first, they need the mutex
+    uPortI2cAsyncPrivateClose(handle);
+
     if ((gMutex != NULL) && (handle > 0) &&
         (handle < sizeof(gI2cData) / sizeof(gI2cData[0]))) {
 
@@ -718,6 +729,9 @@ int32_t uPortI2cCloseRecoverBus(int32_t handle)
     int32_t pinSda;
     int32_t pinSdc;
 
+    // Complete any asynchronous transfers first, they need the mutex
+    uPortI2cAsyncPrivateClose(handle);
+
     if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
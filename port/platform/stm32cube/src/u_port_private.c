@@ -424,6 +424,35 @@ int64_t uPortPrivateGetTickTimeMs()
     return gTickTimerRtosCount;
 }
 
+// Get the current tick time in microseconds: the millisecond count
+// from the SysTick interrupt plus how far SysTick has counted down
+// towards the next one.
+int64_t uPortPrivateGetTickTimeUs()
+{
+    volatile int32_t *pTickCount = &gTickTimerRtosCount;
+    uint32_t load = SysTick->LOAD + 1;
+    int64_t tickTimeMs;
+    uint32_t value;
+    bool pending;
+
+    do {
+        tickTimeMs = *pTickCount;
+        value = SysTick->VAL;
+        pending = ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0);
+        // Go again if the SysTick interrupt ran in the meantime
+    } while (tickTimeMs != *pTickCount);
+
+    if (pending && (value > load / 2)) {
+        // SysTick has reloaded but its interrupt has not yet run
+        // (e.g. we are in a critical section or an interrupt),
+        // so the millisecond count is one behind
+        tickTimeMs++;
+    }
+
+    // SysTick counts down from LOAD to zero, once a millisecond
+    return (tickTimeMs * 1000) + ((((uint64_t) (load - 1 - value)) * 1000) / load);
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS SPECIFIC TO THIS PORT: MISC
  * -------------------------------------------------------------- */
@@ -71,6 +71,11 @@ void uPortPrivateDeinit();
  */
 int64_t uPortPrivateGetTickTimeMs();
 
+/** Get the current tick time in microseconds, with the best
+ * resolution the tick source offers.
+ */
+int64_t uPortPrivateGetTickTimeUs();
+
 /** Return the address of the port register for a given GPIO pin.
  *
  * @param pin the pin number.
@@ -42,6 +42,7 @@
 #include "u_port_os.h"
 #include "u_port_event_queue.h"
 #include "u_port_uart.h"
+#include "u_port_uart_async_private.h"
 
 #include "stm32f4xx_ll_bus.h"
 #include "stm32f4xx_ll_gpio.h"
@@ -622,14 +623,15 @@ static inline void dataIrqHandler(uPortUartData_t *pUartData,
                                     pUartData->rxBufferSizeBytes;
     }
 
-    // Let the user know
+    // Let the user know; if an event is already waiting there is
+    // no need to send another, the user will read all the data
     if ((uartSizeOrError > 0) && (pUartData->eventQueueHandle >= 0) &&
         (pUartData->eventFilter & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED)) {
         uPortUartEvent_t event;
         event.uartHandle = pUartData->uartHandle;
         event.eventBitMap = U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED;
-        uPortEventQueueSendIrq(pUartData->eventQueueHandle,
-                               &event, sizeof(event));
+        uPortEventQueueSendIrqOnce(pUartData->eventQueueHandle,
+                                   &event, sizeof(event));
     }
 }
 
@@ -909,12 +911,19 @@ int32_t uPortUartInit()
         errorCode = uPortMutexCreate(&gMutex);
     }
 
+    if (errorCode == U_ERROR_COMMON_SUCCESS) {
+        errorCode = (uErrorCode_t) uPortUartAsyncPrivateInit();
+    }
+
     return (int32_t) errorCode;
 }
 
 // Deinitialise the UART driver.
 void uPortUartDeinit()
 {
+    // Complete any asynchronous writes first, they need the mutex
+    uPortUartAsyncPrivateDeinit();
+
     if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
@@ -1167,6 +1176,9 @@ int32_t uPortUartOpen(int32_t uart, int32_t baudRate,
 // Close a UART instance.
 void uPortUartClose(int32_t handle)
 {
+    // Complete any asynchronous writes first, they need the mutex
+    uPortUartAsyncPrivateClose(handle);
+
     if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
@@ -1286,6 +1298,87 @@ int32_t uPortUartRead(int32_t handle, void *pBuffer,
     return (int32_t) sizeOrErrorCode;
 }
 
+// Get the contiguous span of received data at the read pointer.
+int32_t uPortUartPeekSpan(int32_t handle, const char **ppData)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uPortUartData_t *pUartData;
+    const volatile char *pRxBufferWrite;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pUartData = pGetUartDataByHandle(handle);
+        if ((pUartData != NULL) && (ppData != NULL)) {
+            pRxBufferWrite = pUartData->pRxBufferWrite;
+            sizeOrErrorCode = 0;
+            if (pUartData->pRxBufferRead < pRxBufferWrite) {
+                // Read pointer is behind write, the span is
+                // simply the difference
+                sizeOrErrorCode = pRxBufferWrite - pUartData->pRxBufferRead;
+            } else if (pUartData->pRxBufferRead > pRxBufferWrite) {
+                // Read pointer is ahead of write, the span is
+                // up to the end of the buffer
+                sizeOrErrorCode = pUartData->pRxBufferStart +
+                                  pUartData->rxBufferSizeBytes -
+                                  pUartData->pRxBufferRead;
+            }
+            *ppData = NULL;
+            if (sizeOrErrorCode > 0) {
+                *ppData = pUartData->pRxBufferRead;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return sizeOrErrorCode;
+}
+
+// Consume received data obtained with uPortUartPeekSpan().
+int32_t uPortUartConsume(int32_t handle, size_t sizeBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uPortUartData_t *pUartData;
+    const volatile char *pRxBufferWrite;
+    size_t spanSize = 0;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pUartData = pGetUartDataByHandle(handle);
+        if (pUartData != NULL) {
+            // Work out the span as uPortUartPeekSpan() does;
+            // it can only have grown since
+            pRxBufferWrite = pUartData->pRxBufferWrite;
+            if (pUartData->pRxBufferRead < pRxBufferWrite) {
+                spanSize = pRxBufferWrite - pUartData->pRxBufferRead;
+            } else if (pUartData->pRxBufferRead > pRxBufferWrite) {
+                spanSize = pUartData->pRxBufferStart +
+                           pUartData->rxBufferSizeBytes -
+                           pUartData->pRxBufferRead;
+            }
+            if (sizeBytes <= spanSize) {
+                // Move the read pointer on, wrapping as necessary
+                pUartData->pRxBufferRead += sizeBytes;
+                if (pUartData->pRxBufferRead >= pUartData->pRxBufferStart +
+                    pUartData->rxBufferSizeBytes) {
+                    pUartData->pRxBufferRead = pUartData->pRxBufferStart;
+                }
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCode;
+}
+
 // Write to the given UART interface.
 int32_t uPortUartWrite(int32_t handle,
                        const void *pBuffer,
@@ -1578,6 +1671,19 @@ int32_t uPortUartEventStackMinFree(int32_t handle)
     return sizeOrErrorCode;
 }
 
+// Set a delimiter for the data received event.
+int32_t uPortUartEventDelimiterSet(int32_t handle, int32_t delimiter,
+                                   int32_t timeoutMs)
+{
+    (void) handle;
+    (void) delimiter;
+    (void) timeoutMs;
+
+    // Not supported on this platform: events are passed on
+    // as they arrive
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
 // Determine if RTS flow control is enabled.
 bool uPortUartIsRtsFlowControlEnabled(int32_t handle)
 {
@@ -40,6 +40,7 @@
 #include "u_port.h"
 #include "u_port_os.h"
 #include "u_port_uart.h"
+#include "u_port_perf_counter.h"
 #include "u_port_private.h"
 #include "u_port_event_queue_private.h"
 
@@ -149,6 +150,52 @@ int32_t uPortGetTickTimeMs()
     return GetTickCount() % INT_MAX;
 }
 
+// Get the current high resolution time in microseconds.
+int64_t uPortGetTickTimeUs()
+{
+    int64_t timeUs = (int64_t) uPortGetTickTimeMs() * 1000;
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER count;
+
+    if (QueryPerformanceFrequency(&frequency) && (frequency.QuadPart > 0) &&
+        QueryPerformanceCounter(&count)) {
+        // Split the conversion to avoid overflow
+        timeUs = ((count.QuadPart / frequency.QuadPart) * 1000000) +
+                 (((count.QuadPart % frequency.QuadPart) * 1000000) / frequency.QuadPart);
+    }
+
+    return timeUs;
+}
+
+// Get the current value of the cycle counter: there is no
+// portable way to read CPU cycles under Windows so the
+// performance counter is used instead.
+uint32_t uPortPerfCounterGetCycles()
+{
+    uint32_t cycles = 0;
+    LARGE_INTEGER count;
+
+    if (QueryPerformanceCounter(&count)) {
+        cycles = (uint32_t) count.QuadPart;
+    }
+
+    return cycles;
+}
+
+// Get the frequency of the cycle counter.
+int32_t uPortPerfCounterGetFrequencyHz()
+{
+    int32_t errorCodeOrFrequency = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+    LARGE_INTEGER frequency;
+
+    if (QueryPerformanceFrequency(&frequency) && (frequency.QuadPart > 0) &&
+        (frequency.QuadPart <= INT_MAX)) {
+        errorCodeOrFrequency = (int32_t) frequency.QuadPart;
+    }
+
+    return errorCodeOrFrequency;
+}
+
 // Get the minimum amount of heap free, ever, in bytes.
 int32_t uPortGetHeapMinFree()
 {
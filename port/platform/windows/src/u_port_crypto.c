@@ -25,6 +25,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
+#include "string.h"    // memcpy(), memset()
 
 #include "windows.h"
 #include "bcrypt.h"
@@ -33,6 +34,7 @@
 #include "u_error_common.h"
 
 #include "u_port.h"
+#include "u_port_heap.h"
 #include "u_port_crypto.h"
 
 /* ----------------------------------------------------------------
@@ -43,6 +45,24 @@
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The context of a SHA256, HMAC SHA256 or MD5 calculation performed
+ * in pieces.
+ */
+typedef struct {
+    BCRYPT_ALG_HANDLE algorithmHandle;
+    BCRYPT_HASH_HANDLE hashHandle;
+    ULONG outputLengthBytes;
+} uPortCryptoHashContext_t;
+
+/** The context of an AES 128 CBC calculation performed in pieces.
+ */
+typedef struct {
+    BCRYPT_ALG_HANDLE algorithmHandle;
+    BCRYPT_KEY_HANDLE keyHandle;
+    UCHAR initVector[U_PORT_CRYPTO_AES128_INITIALISATION_VECTOR_LENGTH_BYTES];
+    bool encrypt;
+} uPortCryptoAes128CbcContext_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -51,6 +71,86 @@
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Start a hash in pieces, pAlgorithm being BCRYPT_SHA256_ALGORITHM
+// or BCRYPT_MD5_ALGORITHM, with an output of outputLengthBytes, and
+// flags being BCRYPT_ALG_HANDLE_HMAC_FLAG for HMAC, in which case
+// pKey/keyLengthBytes give the key.
+static int32_t hashInit(void **ppContext, LPCWSTR pAlgorithm,
+                        ULONG outputLengthBytes, ULONG flags,
+                        const char *pKey, size_t keyLengthBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortCryptoHashContext_t *pContext;
+
+    if (ppContext != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pContext = (uPortCryptoHashContext_t *) pUPortMalloc(sizeof(*pContext));
+        if (pContext != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+            pContext->outputLengthBytes = outputLengthBytes;
+            if (BCryptOpenAlgorithmProvider(&(pContext->algorithmHandle),
+                                            pAlgorithm, NULL, flags) >= 0) {
+                // Create the hash object, letting Windows allocate
+                // the memory for it
+                if (BCryptCreateHash(pContext->algorithmHandle,
+                                     &(pContext->hashHandle),
+                                     NULL, 0, (PUCHAR) pKey,
+                                     (ULONG) keyLengthBytes, 0) >= 0) {
+                    *ppContext = (void *) pContext;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                } else {
+                    BCryptCloseAlgorithmProvider(pContext->algorithmHandle, 0);
+                }
+            }
+            if (errorCode != 0) {
+                uPortFree(pContext);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Add a piece of data to a hash.
+static int32_t hashUpdate(void *pContext, const char *pInput,
+                          size_t inputLengthBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortCryptoHashContext_t *pHashContext = (uPortCryptoHashContext_t *) pContext;
+
+    if ((pHashContext != NULL) &&
+        ((pInput != NULL) || (inputLengthBytes == 0))) {
+        errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+        if (BCryptHashData(pHashContext->hashHandle, (PBYTE) pInput,
+                           (ULONG) inputLengthBytes, 0) >= 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Finish a hash and free its context.
+static int32_t hashFinal(void *pContext, char *pOutput)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortCryptoHashContext_t *pHashContext = (uPortCryptoHashContext_t *) pContext;
+
+    if (pHashContext != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if ((pOutput != NULL) &&
+            (BCryptFinishHash(pHashContext->hashHandle, (PUCHAR) pOutput,
+                              pHashContext->outputLengthBytes, 0) < 0)) {
+            errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+        }
+        BCryptDestroyHash(pHashContext->hashHandle);
+        BCryptCloseAlgorithmProvider(pHashContext->algorithmHandle, 0);
+        uPortFree(pHashContext);
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -228,4 +328,172 @@ int32_t uPortCryptoAes128CbcDecrypt(const char *pKey,
     return errorCode;
 }
 
+// Start a SHA256 calculation in pieces.
+int32_t uPortCryptoSha256Init(void **ppContext)
+{
+    return hashInit(ppContext, BCRYPT_SHA256_ALGORITHM,
+                    U_PORT_CRYPTO_SHA256_OUTPUT_LENGTH_BYTES, 0, NULL, 0);
+}
+
+// Add a piece of data to a SHA256 calculation.
+int32_t uPortCryptoSha256Update(void *pContext,
+                                const char *pInput,
+                                size_t inputLengthBytes)
+{
+    return hashUpdate(pContext, pInput, inputLengthBytes);
+}
+
+// Finish a SHA256 calculation.
+int32_t uPortCryptoSha256Final(void *pContext, char *pOutput)
+{
+    return hashFinal(pContext, pOutput);
+}
+
+// Start a HMAC SHA256 calculation in pieces.
+int32_t uPortCryptoHmacSha256Init(void **ppContext,
+                                  const char *pKey,
+                                  size_t keyLengthBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pKey != NULL) {
+        errorCode = hashInit(ppContext, BCRYPT_SHA256_ALGORITHM,
+                             U_PORT_CRYPTO_SHA256_OUTPUT_LENGTH_BYTES,
+                             BCRYPT_ALG_HANDLE_HMAC_FLAG,
+                             pKey, keyLengthBytes);
+    }
+
+    return errorCode;
+}
+
+// Add a piece of data to a HMAC SHA256 calculation.
+int32_t uPortCryptoHmacSha256Update(void *pContext,
+                                    const char *pInput,
+                                    size_t inputLengthBytes)
+{
+    return hashUpdate(pContext, pInput, inputLengthBytes);
+}
+
+// Finish a HMAC SHA256 calculation.
+int32_t uPortCryptoHmacSha256Final(void *pContext, char *pOutput)
+{
+    return hashFinal(pContext, pOutput);
+}
+
+// Start an MD5 calculation in pieces.
+int32_t uPortCryptoMd5Init(void **ppContext)
+{
+    return hashInit(ppContext, BCRYPT_MD5_ALGORITHM,
+                    U_PORT_CRYPTO_MD5_OUTPUT_LENGTH_BYTES, 0, NULL, 0);
+}
+
+// Add a piece of data to an MD5 calculation.
+int32_t uPortCryptoMd5Update(void *pContext,
+                             const char *pInput,
+                             size_t inputLengthBytes)
+{
+    return hashUpdate(pContext, pInput, inputLengthBytes);
+}
+
+// Finish an MD5 calculation.
+int32_t uPortCryptoMd5Final(void *pContext, char *pOutput)
+{
+    return hashFinal(pContext, pOutput);
+}
+
+// Start an AES 128 CBC calculation in pieces.
+int32_t uPortCryptoAes128CbcInit(void **ppContext,
+                                 const char *pKey,
+                                 size_t keyLengthBytes,
+                                 const char *pInitVector,
+                                 bool encrypt)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortCryptoAes128CbcContext_t *pContext;
+
+    if ((ppContext != NULL) && (pKey != NULL) && (pInitVector != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pContext = (uPortCryptoAes128CbcContext_t *) pUPortMalloc(sizeof(*pContext));
+        if (pContext != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+            if (BCryptOpenAlgorithmProvider(&(pContext->algorithmHandle),
+                                            BCRYPT_AES_ALGORITHM,
+                                            NULL, 0) >= 0) {
+                if ((BCryptSetProperty(pContext->algorithmHandle, BCRYPT_CHAINING_MODE,
+                                       (PBYTE) BCRYPT_CHAIN_MODE_CBC,
+                                       sizeof(BCRYPT_CHAIN_MODE_CBC),
+                                       0) >= 0) &&
+                    (BCryptGenerateSymmetricKey(pContext->algorithmHandle,
+                                                &(pContext->keyHandle), NULL, 0,
+                                                (PUCHAR) pKey, (ULONG) keyLengthBytes,
+                                                0) >= 0)) {
+                    memcpy(pContext->initVector, pInitVector,
+                           sizeof(pContext->initVector));
+                    pContext->encrypt = encrypt;
+                    *ppContext = (void *) pContext;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                } else {
+                    BCryptCloseAlgorithmProvider(pContext->algorithmHandle, 0);
+                }
+            }
+            if (errorCode != 0) {
+                uPortFree(pContext);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Encrypt or decrypt a piece of data with AES 128 CBC.
+int32_t uPortCryptoAes128CbcUpdate(void *pContext,
+                                   const char *pInput,
+                                   size_t lengthBytes,
+                                   char *pOutput)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortCryptoAes128CbcContext_t *pAesContext = (uPortCryptoAes128CbcContext_t *) pContext;
+    DWORD resultLength = 0;
+    NTSTATUS status;
+
+    if ((pAesContext != NULL) && (pInput != NULL) && (pOutput != NULL)) {
+        // Both of these update the initialisation vector in
+        // the context, ready for the next piece
+        if (pAesContext->encrypt) {
+            status = BCryptEncrypt(pAesContext->keyHandle, (PUCHAR) pInput,
+                                   (ULONG) lengthBytes, NULL,
+                                   pAesContext->initVector,
+                                   sizeof(pAesContext->initVector),
+                                   (PUCHAR) pOutput, (ULONG) lengthBytes,
+                                   &resultLength, 0);
+        } else {
+            status = BCryptDecrypt(pAesContext->keyHandle, (PUCHAR) pInput,
+                                   (ULONG) lengthBytes, NULL,
+                                   pAesContext->initVector,
+                                   sizeof(pAesContext->initVector),
+                                   (PUCHAR) pOutput, (ULONG) lengthBytes,
+                                   &resultLength, 0);
+        }
+        errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+        if (status >= 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Finish an AES 128 CBC calculation.
+void uPortCryptoAes128CbcFinal(void *pContext)
+{
+    uPortCryptoAes128CbcContext_t *pAesContext = (uPortCryptoAes128CbcContext_t *) pContext;
+
+    if (pAesContext != NULL) {
+        BCryptDestroyKey(pAesContext->keyHandle);
+        BCryptCloseAlgorithmProvider(pAesContext->algorithmHandle, 0);
+        memset(pAesContext->initVector, 0, sizeof(pAesContext->initVector));
+        uPortFree(pAesContext);
+    }
+}
+
 // End of file
@@ -42,6 +42,7 @@
 #include "u_port_os.h"
 #include "u_port_uart.h"
 #include "u_port_event_queue.h"
+#include "u_port_uart_async_private.h"
 #include "u_port_private.h"
 
 /* ----------------------------------------------------------------
@@ -496,6 +497,10 @@ int32_t uPortUartInit()
         errorCode = uPortMutexCreate(&gMutex);
     }
 
+    if (errorCode == U_ERROR_COMMON_SUCCESS) {
+        errorCode = (uErrorCode_t) uPortUartAsyncPrivateInit();
+    }
+
     return (int32_t) errorCode;
 }
 
@@ -504,6 +509,9 @@ void uPortUartDeinit()
 {
     uPortUartData_t *pTmp = gpUartListRoot;
 
+    // Complete any asynchronous writes first, they need the mutex
+    uPortUartAsyncPrivateDeinit();
+
     if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
@@ -678,6 +686,9 @@ void uPortUartClose(int32_t handle)
 {
     uPortUartData_t *pUartData = NULL;
 
+    // Complete any asynchronous writes first, they need the mutex
+    uPortUartAsyncPrivateClose(handle);
+
     if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
@@ -806,6 +817,22 @@ int32_t uPortUartRead(int32_t handle, void *pBuffer,
     return (int32_t) sizeOrErrorCode;
 }
 
+// Get the contiguous span of received data: not supported.
+int32_t uPortUartPeekSpan(int32_t handle, const char **ppData)
+{
+    (void) handle;
+    (void) ppData;
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
+// Consume received data: not supported.
+int32_t uPortUartConsume(int32_t handle, size_t sizeBytes)
+{
+    (void) handle;
+    (void) sizeBytes;
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
 // Write to the given UART interface.
 int32_t uPortUartWrite(int32_t handle, const void *pBuffer,
                        size_t sizeBytes)
@@ -1060,6 +1087,19 @@ int32_t uPortUartEventStackMinFree(int32_t handle)
     return sizeOrErrorCode;
 }
 
+// Set a delimiter for the data received event.
+int32_t uPortUartEventDelimiterSet(int32_t handle, int32_t delimiter,
+                                   int32_t timeoutMs)
+{
+    (void) handle;
+    (void) delimiter;
+    (void) timeoutMs;
+
+    // Not supported on this platform: events are passed on
+    // as they arrive
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
 // Determine if RTS flow control is enabled.
 bool uPortUartIsRtsFlowControlEnabled(int32_t handle)
 {
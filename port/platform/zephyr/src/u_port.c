@@ -36,6 +36,7 @@
 #include "u_port_os.h"
 #include "u_port_gpio.h"
 #include "u_port_uart.h"
+#include "u_port_perf_counter.h"
 #include "u_port_event_queue_private.h"
 #include "u_port_private.h"
 
@@ -54,10 +55,16 @@
  * VARIABLES
  * -------------------------------------------------------------- */
 
-/** Key for Zephyr's irq_lock().
+/** Key for Zephyr's irq_lock(), that of the outermost
+ * uPortEnterCritical().
  */
 static uint32_t gIrqLockKey;
 
+/** The nesting depth of uPortEnterCritical(); only changed with
+ * interrupts locked.
+ */
+static int32_t gIrqLockDepth = 0;
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -118,6 +125,32 @@ int32_t uPortGetTickTimeMs()
     return k_uptime_get();
 }
 
+// Get the current high resolution time in microseconds.
+int64_t uPortGetTickTimeUs()
+{
+#ifdef CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER
+    // The hardware cycle counter is better than the tick, which
+    // may be as coarse as 100 Hz
+    return (int64_t) k_cyc_to_us_floor64(k_cycle_get_64());
+#else
+    // The 32-bit cycle counter may wrap in seconds, stick with the tick
+    return (int64_t) k_ticks_to_us_floor64(k_uptime_ticks());
+#endif
+}
+
+// Get the current value of the cycle counter: that of the
+// system timer, which may not run at the CPU clock rate.
+uint32_t uPortPerfCounterGetCycles()
+{
+    return k_cycle_get_32();
+}
+
+// Get the frequency of the cycle counter.
+int32_t uPortPerfCounterGetFrequencyHz()
+{
+    return (int32_t) sys_clock_hw_cycles_per_sec();
+}
+
 // Get the minimum amount of heap free, ever, in bytes.
 int32_t uPortGetHeapMinFree()
 {
@@ -150,14 +183,28 @@ int32_t uPortGetHeapFree()
 // Enter a critical section.
 U_INLINE int32_t uPortEnterCritical()
 {
-    gIrqLockKey = irq_lock();
+    uint32_t key = irq_lock();
+
+    // Only keep the key of the outermost lock: were a nested
+    // call to overwrite it, the outermost uPortExitCritical()
+    // would leave interrupts locked
+    if (gIrqLockDepth == 0) {
+        gIrqLockKey = key;
+    }
+    gIrqLockDepth++;
+
     return (int32_t) U_ERROR_COMMON_SUCCESS;
 }
 
 // Leave a critical section.
 U_INLINE void uPortExitCritical()
 {
-    irq_unlock(gIrqLockKey);
+    if (gIrqLockDepth > 0) {
+        gIrqLockDepth--;
+        if (gIrqLockDepth == 0) {
+            irq_unlock(gIrqLockKey);
+        }
+    }
 }
 
 static int ubxlib_preinit(const struct device *arg)
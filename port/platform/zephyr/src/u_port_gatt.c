@@ -45,6 +45,7 @@
 #include <bluetooth/conn.h>
 #include <bluetooth/uuid.h>
 #include <bluetooth/gatt.h>
+#include <sys/byteorder.h> // sys_get_le16()
 
 #include "string.h" // For memcpy()
 
@@ -75,6 +76,11 @@
 #define U_PORT_GATT_MAX_NBR_OF_SUBSCRIBTIONS 4
 #endif
 
+/** @brief Maximum number of notification batches in flight. **/
+#ifndef U_PORT_GATT_MAX_NBR_OF_NOTIFY_BATCHES
+#define U_PORT_GATT_MAX_NBR_OF_NOTIFY_BATCHES 4
+#endif
+
 #define U_PORT_GATT_CHRC_DESC_EXT_PROP_UUID                 0x2900
 #define U_PORT_GATT_CHRC_DESC_USER_DESCR_UUID               0x2901
 #define U_PORT_GATT_CHRC_DESC_CLIENT_CHAR_CONF_UUID         0x2902
@@ -105,6 +111,16 @@ typedef struct {
     struct bt_gatt_discover_params discoverParams;
 } gattConnection_t;
 
+typedef struct {
+    bool                           inUse;
+    bool                           submitting;
+    uint16_t                       pending[CONFIG_BT_MAX_CONN];
+    int32_t                        numSent;
+    int32_t                        numFailed;
+    uPortGattNotifyBatchCallback_t pCallback;
+    void                          *pParam;
+} notifyBatch_t;
+
 /* ----------------------------------------------------------------
  * Static Prototypes
  * -------------------------------------------------------------- */
@@ -160,6 +176,7 @@ static struct bt_gatt_service gService[U_PORT_GATT_MAX_NBR_OF_USER_SERVICES];
 static uint32_t gNextFreeServiceIndex = 0;
 static struct bt_gatt_attr gAttrPool[U_PORT_GATT_MAX_NBR_OF_ATTRIBUTES];
 static struct bt_gatt_attr *gpNextFreeAttr = gAttrPool;
+static notifyBatch_t gNotifyBatch[U_PORT_GATT_MAX_NBR_OF_NOTIFY_BATCHES];
 static struct bt_gatt_chrc gChrcPool[U_PORT_GATT_MAX_NBR_OF_CHARACTERISTICS];
 static struct bt_gatt_chrc *gpNextFreeChrc = gChrcPool;
 static struct bt_data gScanResponseData[U_PORT_GATT_MAX_NBR_OF_USER_SERVICES];
@@ -178,6 +195,11 @@ static struct bt_conn_cb conn_callbacks = {
 static uPortGattGapConnStatusCallback_t pGapConnStatusCallback;
 static void *pGapConnStatusParam;
 
+// Scan variables
+static uPortGattScanFilter_t gScanFilter;
+static uPortGattScanCallback_t gpScanCallback = NULL;
+static void *gpScanCallbackParam = NULL;
+
 
 static const struct bt_uuid_16 primaryServiceUuid   = {{BT_UUID_TYPE_16}, 0x2800};
 // not used for the moment: static const struct bt_uuid_16 secondaryServiceUuid = {{BT_UUID_TYPE_16}, 0x2801};
@@ -320,6 +342,98 @@ static bool validConnHandle(int32_t connHandle)
     }
 }
 
+// Find the zephyr value attribute in the attribute pool that goes
+// with a porting layer characteristic.
+static struct bt_gatt_attr *pFindValueAttr(const uPortGattCharacteristic_t *pChar)
+{
+    struct bt_gatt_attr *pAtt = gAttrPool;
+
+    while ((pAtt != gpNextFreeAttr) && (pAtt->user_data != &(pChar->valueAtt))) {
+        pAtt++;
+    }
+
+    return (pAtt != gpNextFreeAttr) ? pAtt : NULL;
+}
+
+// If a notification batch has nothing more to wait for, free it
+// and return its callback; must be called with interrupts locked.
+static uPortGattNotifyBatchCallback_t notifyBatchDone(notifyBatch_t *pBatch)
+{
+    uPortGattNotifyBatchCallback_t pCallback = NULL;
+    bool done = !pBatch->submitting;
+
+    for (size_t x = 0; (x < CONFIG_BT_MAX_CONN) && done; x++) {
+        done = (pBatch->pending[x] == 0);
+    }
+    if (done) {
+        pCallback = pBatch->pCallback;
+        pBatch->inUse = false;
+    }
+
+    return pCallback;
+}
+
+// Called by zephyr when a notification of a batch has been sent.
+static void onNotifyBatchSent(struct bt_conn *conn, void *pUserData)
+{
+    notifyBatch_t *pBatch = (notifyBatch_t *) pUserData;
+    uPortGattNotifyBatchCallback_t pCallback = NULL;
+    int32_t numSent = 0;
+    int32_t numFailed = 0;
+    void *pParam = NULL;
+    int32_t connHandle;
+    unsigned int key;
+
+    key = irq_lock();
+    connHandle = findConnHandle(conn);
+    // A notification that completes after its connection has been
+    // written off by notifyBatchConnLost() is ignored
+    if (pBatch->inUse && (connHandle != U_PORT_GATT_GAP_INVALID_CONNHANDLE) &&
+        (pBatch->pending[connHandle] > 0)) {
+        pBatch->pending[connHandle]--;
+        pBatch->numSent++;
+        numSent = pBatch->numSent;
+        numFailed = pBatch->numFailed;
+        pParam = pBatch->pParam;
+        pCallback = notifyBatchDone(pBatch);
+    }
+    irq_unlock(key);
+
+    if (pCallback != NULL) {
+        pCallback(numSent, numFailed, pParam);
+    }
+}
+
+// Count whatever notifications of any batch are pending on
+// a connection that has been lost as failed.
+static void notifyBatchConnLost(int32_t connHandle)
+{
+    notifyBatch_t *pBatch;
+    uPortGattNotifyBatchCallback_t pCallback;
+    int32_t numSent;
+    int32_t numFailed;
+    void *pParam;
+    unsigned int key;
+
+    for (size_t x = 0; x < U_PORT_GATT_MAX_NBR_OF_NOTIFY_BATCHES; x++) {
+        pBatch = &(gNotifyBatch[x]);
+        pCallback = NULL;
+        key = irq_lock();
+        if (pBatch->inUse && (pBatch->pending[connHandle] > 0)) {
+            pBatch->numFailed += pBatch->pending[connHandle];
+            pBatch->pending[connHandle] = 0;
+            numSent = pBatch->numSent;
+            numFailed = pBatch->numFailed;
+            pParam = pBatch->pParam;
+            pCallback = notifyBatchDone(pBatch);
+        }
+        irq_unlock(key);
+        if (pCallback != NULL) {
+            pCallback(numSent, numFailed, pParam);
+        }
+    }
+}
+
 static void gapConnected(struct bt_conn *conn, uint8_t err)
 {
     char addr[BT_ADDR_LE_STR_LEN];
@@ -377,6 +491,7 @@ static void gapDisconnected(struct bt_conn *conn, uint8_t reason)
         if (pGapConnStatusCallback != NULL) {
             pGapConnStatusCallback(connHandle, U_PORT_GATT_GAP_DISCONNECTED, pGapConnStatusParam);
         }
+        notifyBatchConnLost(connHandle);
         bt_conn_unref(conn);
         gCurrentConnections[connHandle].pConn = NULL;
         deleteAllSubscriptions(connHandle);
@@ -668,6 +783,76 @@ static void gattXchangeMtuRsp(struct bt_conn *conn, uint8_t err,
     }
 }
 
+// bt_data_parse() callback: look for the UUID and manufacturer of
+// the scan filter, clearing the flags in pUserData as they are found.
+static bool scanFilterAdCallback(struct bt_data *pData, void *pUserData)
+{
+    bool *pNeeded = (bool *) pUserData; // [0] UUID, [1] manufacturer
+    size_t x;
+
+    switch (pData->type) {
+        case BT_DATA_UUID16_SOME:
+        case BT_DATA_UUID16_ALL:
+            for (x = 0; x + 1 < pData->data_len; x += 2) {
+                if (sys_get_le16(pData->data + x) == gScanFilter.uuid16) {
+                    pNeeded[0] = false;
+                }
+            }
+            break;
+        case BT_DATA_SVC_DATA16:
+            if ((pData->data_len >= 2) &&
+                (sys_get_le16(pData->data) == gScanFilter.uuid16)) {
+                pNeeded[0] = false;
+            }
+            break;
+        case BT_DATA_MANUFACTURER_DATA:
+            if ((pData->data_len >= 2) &&
+                (sys_get_le16(pData->data) == gScanFilter.manufacturerId)) {
+                pNeeded[1] = false;
+            }
+            break;
+        default:
+            break;
+    }
+
+    // Keep going while there is something left to find
+    return pNeeded[0] || pNeeded[1];
+}
+
+// Scan callback from Zephyr: apply the filter here so that only
+// the reports that are wanted go any further.
+static void onScanReport(const bt_addr_le_t *pAddr, int8_t rssi,
+                         uint8_t advType, struct net_buf_simple *pAd)
+{
+    uPortGattScanCallback_t pCallback = gpScanCallback;
+    struct net_buf_simple_state state;
+    bool needed[2];
+    uPortBtLeAddressType_t addressType = U_PORT_BT_LE_ADDRESS_TYPE_PUBLIC;
+
+    if ((pCallback == NULL) || (rssi < gScanFilter.rssiMinDbm)) {
+        return;
+    }
+
+    needed[0] = (gScanFilter.uuid16 != 0);
+    needed[1] = (gScanFilter.manufacturerId >= 0);
+    if (needed[0] || needed[1]) {
+        // bt_data_parse() consumes the buffer, we want it back
+        net_buf_simple_save(pAd, &state);
+        bt_data_parse(pAd, scanFilterAdCallback, needed);
+        net_buf_simple_restore(pAd, &state);
+    }
+
+    if (!needed[0] && !needed[1]) {
+        if ((pAddr->type == BT_ADDR_LE_RANDOM) ||
+            (pAddr->type == BT_ADDR_LE_RANDOM_ID)) {
+            addressType = U_PORT_BT_LE_ADDRESS_TYPE_RANDOM;
+        }
+        pCallback(pAddr->a.val, addressType, rssi,
+                  advType == BT_GAP_ADV_TYPE_SCAN_RSP,
+                  pAd->data, pAd->len, gpScanCallbackParam);
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -832,11 +1017,63 @@ int32_t uPortGattExchangeMtu(int32_t connHandle, mtuXchangeRespCallback_t respCa
     return errorCode;
 }
 
+int32_t uPortGattRequestFastLink(int32_t connHandle)
+{
+    int32_t errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (validConnHandle(connHandle)) {
+        errorCode = U_ERROR_COMMON_NOT_SUPPORTED;
+#ifdef CONFIG_BT_USER_PHY_UPDATE
+        if (bt_conn_le_phy_update(gCurrentConnections[connHandle].pConn,
+                                  BT_CONN_LE_PHY_PARAM_2M) == 0) {
+            errorCode = U_ERROR_COMMON_SUCCESS;
+        }
+#endif
+#ifdef CONFIG_BT_USER_DATA_LEN_UPDATE
+        if (bt_conn_le_data_len_update(gCurrentConnections[connHandle].pConn,
+                                       BT_LE_DATA_LEN_PARAM_MAX) == 0) {
+            errorCode = U_ERROR_COMMON_SUCCESS;
+        }
+#endif
+    }
+
+    return errorCode;
+}
+
+int32_t uPortGattGetLinkInfo(int32_t connHandle, uPortGattLinkInfo_t *pLinkInfo)
+{
+    int32_t errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
+    struct bt_conn_info info;
+
+    if (validConnHandle(connHandle) && (pLinkInfo != NULL)) {
+        errorCode = U_ERROR_COMMON_UNKNOWN;
+        memset(pLinkInfo, 0, sizeof(*pLinkInfo));
+        if (bt_conn_get_info(gCurrentConnections[connHandle].pConn, &info) == 0) {
+            pLinkInfo->mtu = bt_gatt_get_mtu(gCurrentConnections[connHandle].pConn);
+#ifdef CONFIG_BT_USER_PHY_UPDATE
+            if (info.le.phy != NULL) {
+                pLinkInfo->txPhy = info.le.phy->tx_phy;
+                pLinkInfo->rxPhy = info.le.phy->rx_phy;
+            }
+#endif
+#ifdef CONFIG_BT_USER_DATA_LEN_UPDATE
+            if (info.le.data_len != NULL) {
+                pLinkInfo->txDataLength = info.le.data_len->tx_max_len;
+                pLinkInfo->rxDataLength = info.le.data_len->rx_max_len;
+            }
+#endif
+            errorCode = U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
 int32_t uPortGattNotify(int32_t connHandle, const uPortGattCharacteristic_t *pChar,
                         const void *data, uint16_t len)
 {
     int32_t returnValue = U_ERROR_COMMON_UNKNOWN;
-    struct bt_gatt_attr *pAtt = gAttrPool;
+    struct bt_gatt_attr *pAtt;
 
     if (!validConnHandle(connHandle) || (pChar == NULL) || (data == NULL) || (len == 0)) {
         return U_ERROR_COMMON_INVALID_PARAMETER;
@@ -848,17 +1085,110 @@ int32_t uPortGattNotify(int32_t connHandle, const uPortGattCharacteristic_t *pCh
 
     // We are given a pointer to the porting layer characteristic struct
     // but we need to find the corresponding zephyr attribute in the attribute pool.
-    while ((pAtt != gpNextFreeAttr) && (pAtt->user_data != &(pChar->valueAtt))) {
-        pAtt++;
-    }
-
-    if (pAtt != gpNextFreeAttr) {
+    pAtt = pFindValueAttr(pChar);
+    if (pAtt != NULL) {
         returnValue = bt_gatt_notify(gCurrentConnections[connHandle].pConn, pAtt, data, len);
     }
 
     return returnValue;
 }
 
+int32_t uPortGattNotifyBatch(const uPortGattNotifyBatchEntry_t *pEntries,
+                             size_t numEntries,
+                             uPortGattNotifyBatchCallback_t pCallback,
+                             void *pParam)
+{
+    int32_t numQueued = 0;
+    notifyBatch_t *pBatch = NULL;
+    struct bt_gatt_notify_params params;
+    const uPortGattNotifyBatchEntry_t *pEntry;
+    uPortGattNotifyBatchCallback_t pDoneCallback;
+    int32_t numSent = 0;
+    int32_t numFailed = 0;
+    unsigned int key;
+
+    if ((pEntries == NULL) || (numEntries == 0)) {
+        return U_ERROR_COMMON_INVALID_PARAMETER;
+    }
+
+    key = irq_lock();
+    for (size_t x = 0; (x < U_PORT_GATT_MAX_NBR_OF_NOTIFY_BATCHES) && (pBatch == NULL); x++) {
+        if (!gNotifyBatch[x].inUse) {
+            pBatch = &(gNotifyBatch[x]);
+            memset(pBatch, 0, sizeof(*pBatch));
+            pBatch->inUse = true;
+            // Stops the batch completing before we have
+            // finished handing it over
+            pBatch->submitting = true;
+            pBatch->pCallback = pCallback;
+            pBatch->pParam = pParam;
+        }
+    }
+    irq_unlock(key);
+
+    if (pBatch == NULL) {
+        return U_ERROR_COMMON_NO_MEMORY;
+    }
+
+    // Hand everything to zephyr without waiting for any of it to
+    // go out: zephyr copies the data into its TX buffers, only
+    // blocking if those are all full, so the controller always
+    // has the next notification to hand at a connection event
+    for (size_t x = 0; x < numEntries; x++) {
+        pEntry = pEntries + x;
+        memset(&params, 0, sizeof(params));
+        if (validConnHandle(pEntry->connHandle) && (pEntry->pChar != NULL) &&
+            (pEntry->pData != NULL) && (pEntry->len > 0)) {
+            params.attr = pFindValueAttr(pEntry->pChar);
+        }
+        params.data = pEntry->pData;
+        params.len = pEntry->len;
+        params.func = onNotifyBatchSent;
+        params.user_data = pBatch;
+        key = irq_lock();
+        // Counted as pending first as it may complete before
+        // bt_gatt_notify_cb() returns
+        if (params.attr != NULL) {
+            pBatch->pending[pEntry->connHandle]++;
+        }
+        irq_unlock(key);
+        if ((params.attr != NULL) &&
+            (bt_gatt_notify_cb(gCurrentConnections[pEntry->connHandle].pConn, &params) == 0)) {
+            numQueued++;
+        } else {
+            key = irq_lock();
+            if ((params.attr != NULL) && (pBatch->pending[pEntry->connHandle] > 0)) {
+                pBatch->pending[pEntry->connHandle]--;
+            }
+            pBatch->numFailed++;
+            irq_unlock(key);
+        }
+    }
+
+    key = irq_lock();
+    pBatch->submitting = false;
+    numSent = pBatch->numSent;
+    numFailed = pBatch->numFailed;
+    if (numQueued == 0) {
+        // Nothing to wait for and the callback is not called
+        pBatch->inUse = false;
+        pDoneCallback = NULL;
+    } else {
+        pDoneCallback = notifyBatchDone(pBatch);
+    }
+    irq_unlock(key);
+
+    if (numQueued == 0) {
+        return U_ERROR_COMMON_UNKNOWN;
+    }
+    if (pDoneCallback != NULL) {
+        // Everything went out while we were still submitting
+        pDoneCallback(numSent, numFailed, pParam);
+    }
+
+    return numQueued;
+}
+
 static struct bt_conn *connectGapAsPeripheral(const bt_addr_le_t *peer, int32_t *pErrorCode)
 {
     struct bt_conn *pConn;
@@ -1067,4 +1397,43 @@ int32_t uPortGattStartDescriptorDiscovery(int32_t connHandle, uPortGattCharDescr
                           0xffff, callback, BT_GATT_DISCOVER_DESCRIPTOR);
 }
 
+int32_t uPortGattScanStart(const uPortGattScanFilter_t *pFilter,
+                           uPortGattScanCallback_t pCallback,
+                           void *pParam)
+{
+    int32_t errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
+    struct bt_le_scan_param param = {
+        .type     = BT_LE_SCAN_TYPE_PASSIVE,
+        .options  = BT_LE_SCAN_OPT_NONE,
+        .interval = BT_GAP_SCAN_FAST_INTERVAL,
+        .window   = BT_GAP_SCAN_FAST_WINDOW,
+    };
+
+    if ((pFilter != NULL) && (pCallback != NULL)) {
+        if (pFilter->activeScan) {
+            param.type = BT_LE_SCAN_TYPE_ACTIVE;
+        }
+        if (pFilter->filterDuplicates) {
+            // Done by the controller, so duplicates never reach the host
+            param.options |= BT_LE_SCAN_OPT_FILTER_DUPLICATE;
+        }
+        gScanFilter = *pFilter;
+        gpScanCallbackParam = pParam;
+        gpScanCallback = pCallback;
+        errorCode = U_ERROR_COMMON_SUCCESS;
+        if (bt_le_scan_start(&param, onScanReport) != 0) {
+            gpScanCallback = NULL;
+            errorCode = U_ERROR_COMMON_UNKNOWN;
+        }
+    }
+
+    return errorCode;
+}
+
+void uPortGattScanStop(void)
+{
+    bt_le_scan_stop();
+    gpScanCallback = NULL;
+}
+
 // End of file
@@ -34,6 +34,7 @@
 #include "u_port.h"
 #include "u_port_os.h"
 #include "u_port_i2c.h"
+#include "u_port_i2c_async_private.h"
 #include "version.h"
 
 /* ----------------------------------------------------------------
@@ -188,12 +189,19 @@ int32_t uPortI2cInit()
         }
     }
 
+    if (errorCode == 0) {
+        errorCode = uPortI2cAsyncPrivateInit();
+    }
+
     return errorCode;
 }
 
 // Shutdown I2C handling.
 void uPortI2cDeinit()
 {
+    // Complete any asynchronous transfers first, they need the mutex
+    uPortI2cAsyncPrivateDeinit();
+
     if (gMutex != NULL) {
         // Zephyr doesn't have an I2C deinitialisation
         // API so nothing in particular to do here
@@ -221,6 +229,9 @@ int32_t uPortI2cAdopt(int32_t i2c, bool controller)
 // Close an I2C instance.
 void uPortI2cClose(int32_t handle)
 {
+    // Complete any asynchronous transfers first, they need the mutex
+    uPortI2cAsyncPrivateClose(handle);
+
     if ((gMutex != NULL) && (handle >= 0) && (handle < sizeof(gI2cData) / sizeof(gI2cData[0]))) {
 
         U_PORT_MUTEX_LOCK(gMutex);
@@ -240,6 +251,9 @@ int32_t uPortI2cCloseRecoverBus(int32_t handle)
     const struct device *pDevice = NULL;
     int32_t x;
 
+    // Complete any asynchronous transfers first, they need the mutex
+    uPortI2cAsyncPrivateClose(handle);
+
     if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
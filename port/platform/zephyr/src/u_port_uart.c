@@ -20,6 +20,13 @@
  * target and the Linux/Posix versions: this is because the Zephyr
  * Linux/Posix platform does not support the interrupt-driven UART API;
  * interrupts are supported, just not that UART API.
+ *
+ * On the embedded target, if CONFIG_UART_ASYNC_API is set and the
+ * driver for a given UART supports it, the Zephyr asynchronous
+ * (DMA) UART API is used for that UART, otherwise the
+ * interrupt-driven API is used.  With the asynchronous API the
+ * driver receives directly into chunks of the receive buffer,
+ * two at a time, and transmits straight from the caller's buffer.
  */
 
 #ifdef U_CFG_OVERRIDE
@@ -48,6 +55,7 @@
 #include "u_port_os.h"
 #include "u_port_event_queue.h"
 #include "u_port_uart.h"
+#include "u_port_uart_async_private.h"
 #include "version.h"
 
 #include "string.h" // For memcpy()
@@ -64,6 +72,55 @@
 #define U_PORT_UART_MAX_NUM 4
 #endif
 
+#ifdef CONFIG_UART_ASYNC_API
+
+# ifndef U_PORT_UART_ASYNC_RX_CHUNK_MAX_BYTES
+/** When the asynchronous UART API is used, the maximum size of
+ * a chunk of the receive buffer handed to the driver; a chunk is
+ * also limited to half of the receive buffer so that the driver
+ * can always have the next one ready.  Reduce this to 255 on
+ * chips where the DMA count register is only eight bits wide
+ * (e.g. NRF52832).
+ */
+#  define U_PORT_UART_ASYNC_RX_CHUNK_MAX_BYTES 1024
+# endif
+
+# ifndef U_PORT_UART_ASYNC_RX_TIMEOUT_US
+/** When the asynchronous UART API is used, how long the receive
+ * line must be idle before the driver passes on what it has
+ * received into a chunk that is not yet full.
+ */
+#  define U_PORT_UART_ASYNC_RX_TIMEOUT_US 500
+# endif
+
+# ifndef U_PORT_UART_ASYNC_RX_STOP_TIMEOUT_MS
+/** When the asynchronous UART API is used, how long to wait
+ * for the driver to give back the receive buffer on closing
+ * the UART.
+ */
+#  define U_PORT_UART_ASYNC_RX_STOP_TIMEOUT_MS 100
+# endif
+
+# ifndef U_PORT_UART_ASYNC_TX_BOUNCE_BUFFER_BYTES
+/** When the asynchronous UART API is used, the size of the RAM
+ * buffer through which data to be transmitted is copied if the
+ * driver can't send it from where it is (e.g. because it is in
+ * flash and the DMA engine can only read RAM).
+ */
+#  define U_PORT_UART_ASYNC_TX_BOUNCE_BUFFER_BYTES 32
+# endif
+
+# if KERNEL_VERSION_MAJOR < 3
+// Before Zephyr 3 the asynchronous UART API timeouts were in milliseconds
+#  define U_PORT_UART_ASYNC_RX_TIMEOUT ((U_PORT_UART_ASYNC_RX_TIMEOUT_US + 999) / 1000)
+#  define U_PORT_UART_ASYNC_TX_TIMEOUT SYS_FOREVER_MS
+# else
+#  define U_PORT_UART_ASYNC_RX_TIMEOUT U_PORT_UART_ASYNC_RX_TIMEOUT_US
+#  define U_PORT_UART_ASYNC_TX_TIMEOUT SYS_FOREVER_US
+# endif
+
+#endif // #ifdef CONFIG_UART_ASYNC_API
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -88,6 +145,15 @@ typedef struct {
     struct k_fifo fifoTxData;
     uint32_t txWritten;
     struct k_sem txSem;
+# ifdef CONFIG_UART_ASYNC_API
+    bool async;
+    volatile size_t rxHandedBytes;
+    volatile bool rxEnabled;
+    volatile bool rxBufferRequested;
+    volatile bool rxStopping;
+    struct k_sem rxStoppedSem;
+    char txBounce[U_PORT_UART_ASYNC_TX_BOUNCE_BUFFER_BYTES];
+# endif
 #else
     struct k_timer pollTimer;
 #endif
@@ -145,14 +211,36 @@ static void eventHandler(void *pParam, size_t paramLength)
 // Note: gMutex should be locked before this is called.
 static void uartClose(int32_t handle)
 {
-    k_free(gUartData[handle].pBuffer);
-    gUartData[handle].pBuffer = NULL;
 #ifdef CONFIG_UART_INTERRUPT_DRIVEN
-    uart_irq_rx_disable(gUartData[handle].pDevice);
-    uart_irq_tx_disable(gUartData[handle].pDevice);
+    bool async = false;
+# ifdef CONFIG_UART_ASYNC_API
+    unsigned int key;
+    bool rxEnabled;
+
+    async = gUartData[handle].async;
+    if (async) {
+        // The driver must have given back the receive
+        // buffer before it can be freed
+        key = irq_lock();
+        gUartData[handle].rxStopping = true;
+        rxEnabled = gUartData[handle].rxEnabled;
+        irq_unlock(key);
+        if (rxEnabled && (uart_rx_disable(gUartData[handle].pDevice) == 0)) {
+            k_sem_take(&gUartData[handle].rxStoppedSem,
+                       K_MSEC(U_PORT_UART_ASYNC_RX_STOP_TIMEOUT_MS));
+        }
+        gUartData[handle].async = false;
+    }
+# endif
+    if (!async) {
+        uart_irq_rx_disable(gUartData[handle].pDevice);
+        uart_irq_tx_disable(gUartData[handle].pDevice);
+    }
 #else
     k_timer_stop(&gUartData[handle].pollTimer);
 #endif
+    k_free(gUartData[handle].pBuffer);
+    gUartData[handle].pBuffer = NULL;
 
     gUartData[handle].bufferRead = 0;
     gUartData[handle].bufferWrite = 0;
@@ -167,20 +255,78 @@ static void uartClose(int32_t handle)
 #endif
 }
 
-static void rxTimer(struct k_timer *timer_id)
+// Return the number of received bytes that are contiguous in the
+// buffer starting at the read index.
+// Note: gMutex should be locked before this is called.
+static int32_t uartContiguousSize(int32_t handle)
 {
-    uint32_t uart = (uint32_t)(timer_id->user_data);
+    int32_t size = 0;
+    int32_t bufferWrite = gUartData[handle].bufferWrite;
+
+    if (gUartData[handle].bufferFull ||
+        (bufferWrite < (int32_t) gUartData[handle].bufferRead)) {
+        // Either full or wrapped: the span is up to the end of the buffer
+        size = gUartData[handle].receiveBufferSizeBytes - gUartData[handle].bufferRead;
+    } else {
+        size = bufferWrite - gUartData[handle].bufferRead;
+    }
+
+    return size;
+}
 
-    if ((gUartData[uart].eventQueueHandle >= 0) &&
-        (gUartData[uart].eventFilter & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED)) {
-        uPortUartEvent_t event;
-        event.uartHandle = uart;
+// Return the number of free bytes in the receive buffer that are
+// contiguous starting at the write index, or, when the asynchronous
+// UART API is used, starting after what has already been handed to
+// the driver, and a pointer to the first of them.
+// Note: called from interrupt context or with interrupts locked.
+static size_t rxContiguousFree(int32_t handle, char **ppStart)
+{
+    size_t size = gUartData[handle].receiveBufferSizeBytes;
+    size_t used = size;
+    size_t handed = 0;
+    size_t start;
+    size_t available;
+
+#ifdef CONFIG_UART_ASYNC_API
+    handed = gUartData[handle].rxHandedBytes;
+#endif
+    if (!gUartData[handle].bufferFull) {
+        used = ((size_t) gUartData[handle].bufferWrite + size -
+                gUartData[handle].bufferRead) % size;
+    }
+    start = ((size_t) gUartData[handle].bufferWrite + handed) % size;
+    available = size - used - handed;
+    if (available > size - start) {
+        available = size - start;
+    }
+    *ppStart = gUartData[handle].pBuffer + start;
+
+    return available;
+}
+
+// Send a data received event, if wanted, from interrupt context;
+// if an event is already waiting there is no need to send another,
+// the user will read all the data.
+static void rxEventSendIrq(int32_t handle)
+{
+    uPortUartEvent_t event;
+
+    if ((gUartData[handle].eventQueueHandle >= 0) &&
+        (gUartData[handle].eventFilter & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED)) {
+        event.uartHandle = handle;
         event.eventBitMap = U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED;
-        uPortEventQueueSendIrq(gUartData[uart].eventQueueHandle,
-                               &event, sizeof(event));
+        uPortEventQueueSendIrqOnce(gUartData[handle].eventQueueHandle,
+                                   &event, sizeof(event));
     }
 }
 
+static void rxTimer(struct k_timer *timer_id)
+{
+    uint32_t uart = (uint32_t)(timer_id->user_data);
+
+    rxEventSendIrq(uart);
+}
+
 #ifdef CONFIG_UART_INTERRUPT_DRIVEN
 // uartCb called by the interrupt-based UART driver.
 static void uartCb(const struct device *uart, void *user_data)
@@ -204,29 +350,28 @@ static void uartCb(const struct device *uart, void *user_data)
     if (uart_irq_rx_ready(uart)) {
         bool read = false;
         if (!gUartData[i].bufferFull) {
-            while (uart_fifo_read(uart, (gUartData[i].pBuffer + gUartData[i].bufferWrite), 1) != 0) {
-                gUartData[i].bufferWrite++;
-                gUartData[i].bufferWrite %= gUartData[i].receiveBufferSizeBytes;
-                read = true;
-
-                if (gUartData[i].bufferWrite == gUartData[i].bufferRead) {
-                    gUartData[i].bufferFull = true;
-                    uart_irq_rx_disable(uart);
-                    k_timer_stop(&gUartData[i].rxTimer);
-                    if ((gUartData[i].eventQueueHandle >= 0) &&
-                        (gUartData[i].eventFilter & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED)) {
-                        uPortUartEvent_t event;
-                        event.uartHandle = i;
-                        event.eventBitMap = U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED;
-                        uPortEventQueueSendIrq(gUartData[i].eventQueueHandle,
-                                               &event, sizeof(event));
+            char *pStart;
+            int32_t size;
+            int32_t length;
+            do {
+                // Read as much as will fit contiguously, i.e. up to
+                // the read index or the end of the buffer, in one go
+                size = (int32_t) rxContiguousFree(i, &pStart);
+                length = uart_fifo_read(uart, (uint8_t *) pStart, size);
+                if (length > 0) {
+                    gUartData[i].bufferWrite += length;
+                    gUartData[i].bufferWrite %= gUartData[i].receiveBufferSizeBytes;
+                    read = true;
+                    if (gUartData[i].bufferWrite == gUartData[i].bufferRead) {
+                        gUartData[i].bufferFull = true;
+                        uart_irq_rx_disable(uart);
+                        k_timer_stop(&gUartData[i].rxTimer);
+                        rxEventSendIrq(i);
                     }
-                    break;
-                } else {
-
                 }
-
-            }
+                // If the span was filled there may be more in the
+                // FIFO for the start of the buffer
+            } while ((length == size) && !gUartData[i].bufferFull);
 
             if (read) {
                 k_timer_start(&gUartData[i].rxTimer, K_MSEC(1), K_NO_WAIT);
@@ -264,6 +409,133 @@ static void uartCb(const struct device *uart, void *user_data)
     }
 }
 
+# ifdef CONFIG_UART_ASYNC_API
+
+// Hand the next chunk of free space in the receive buffer to the
+// asynchronous UART driver, either to start reception or in response
+// to a request for the next buffer; returns true if there was space
+// and the driver took it.
+// Note: called from interrupt context or with interrupts locked.
+static bool rxAsyncChunkGive(int32_t handle, bool start)
+{
+    char *pStart;
+    size_t length = rxContiguousFree(handle, &pStart);
+    size_t chunkMax = gUartData[handle].receiveBufferSizeBytes / 2;
+    bool given = false;
+
+    if (chunkMax == 0) {
+        chunkMax = gUartData[handle].receiveBufferSizeBytes;
+    }
+    if (chunkMax > U_PORT_UART_ASYNC_RX_CHUNK_MAX_BYTES) {
+        chunkMax = U_PORT_UART_ASYNC_RX_CHUNK_MAX_BYTES;
+    }
+    if (length > chunkMax) {
+        length = chunkMax;
+    }
+    if (length > 0) {
+        if (start) {
+            given = (uart_rx_enable(gUartData[handle].pDevice, (uint8_t *) pStart,
+                                    length, U_PORT_UART_ASYNC_RX_TIMEOUT) == 0);
+            gUartData[handle].rxEnabled = given;
+        } else {
+            given = (uart_rx_buf_rsp(gUartData[handle].pDevice,
+                                     (uint8_t *) pStart, length) == 0);
+        }
+        if (given) {
+            gUartData[handle].rxHandedBytes += length;
+        }
+    }
+
+    return given;
+}
+
+// uartAsyncCb called by the asynchronous UART driver.
+static void uartAsyncCb(const struct device *uart, struct uart_event *pEvent,
+                        void *user_data)
+{
+    int32_t i = (int32_t) user_data;
+
+    (void) uart;
+
+    switch (pEvent->type) {
+        case UART_TX_DONE:
+        case UART_TX_ABORTED:
+            k_sem_give(&gUartData[i].txSem);
+            break;
+        case UART_RX_RDY:
+            // The data is already in place in the receive
+            // buffer, just need to move the write index on
+            if (pEvent->data.rx.len > 0) {
+                gUartData[i].bufferWrite += pEvent->data.rx.len;
+                gUartData[i].bufferWrite %= gUartData[i].receiveBufferSizeBytes;
+                gUartData[i].rxHandedBytes -= pEvent->data.rx.len;
+                if (gUartData[i].bufferWrite == gUartData[i].bufferRead) {
+                    gUartData[i].bufferFull = true;
+                    k_timer_stop(&gUartData[i].rxTimer);
+                    rxEventSendIrq(i);
+                }
+                k_timer_start(&gUartData[i].rxTimer, K_MSEC(1), K_NO_WAIT);
+            }
+            break;
+        case UART_RX_BUF_REQUEST:
+            // If there is no room the driver stops receiving,
+            // flowing the far end off, once the current chunk
+            // is full; rxResume() picks things up again
+            gUartData[i].rxBufferRequested = !rxAsyncChunkGive(i, false);
+            break;
+        case UART_RX_DISABLED:
+            // The driver has now given back all that it was handed
+            gUartData[i].rxEnabled = false;
+            gUartData[i].rxHandedBytes = 0;
+            gUartData[i].rxBufferRequested = false;
+            if (gUartData[i].rxStopping) {
+                k_sem_give(&gUartData[i].rxStoppedSem);
+            } else {
+                // Stopped through lack of room or a line
+                // error: start again if there is room
+                rxAsyncChunkGive(i, true);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// Transmit using the asynchronous UART driver, blocking until done;
+// the data is sent from where it is if the driver can do that, else
+// it is copied through txBounce.
+// Note: gMutex should be locked before this is called.
+static bool txAsync(int32_t handle, const char *pData, size_t sizeBytes)
+{
+    size_t length;
+    bool success = true;
+
+    if (uart_tx(gUartData[handle].pDevice, (const uint8_t *) pData,
+                sizeBytes, U_PORT_UART_ASYNC_TX_TIMEOUT) == 0) {
+        k_sem_take(&gUartData[handle].txSem, K_FOREVER);
+    } else {
+        while (success && (sizeBytes > 0)) {
+            length = sizeBytes;
+            if (length > sizeof(gUartData[handle].txBounce)) {
+                length = sizeof(gUartData[handle].txBounce);
+            }
+            memcpy(gUartData[handle].txBounce, pData, length);
+            success = (uart_tx(gUartData[handle].pDevice,
+                               (const uint8_t *) gUartData[handle].txBounce,
+                               length, U_PORT_UART_ASYNC_TX_TIMEOUT) == 0);
+            if (success) {
+                k_sem_take(&gUartData[handle].txSem, K_FOREVER);
+                pData += length;
+                sizeBytes -= length;
+            }
+        }
+    }
+
+    return success;
+}
+
+# endif // #ifdef CONFIG_UART_ASYNC_API
+
 #else
 
 // Polled receive for when an interrupt-driven UART driver
@@ -287,14 +559,7 @@ static void pollTimer(struct k_timer *timer_id)
         if (gUartData[uart].bufferWrite == gUartData[uart].bufferRead) {
             gUartData[uart].bufferFull = true;
             k_timer_stop(&gUartData[uart].rxTimer);
-            if ((gUartData[uart].eventQueueHandle >= 0) &&
-                (gUartData[uart].eventFilter & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED)) {
-                uPortUartEvent_t event;
-                event.uartHandle = uart;
-                event.eventBitMap = U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED;
-                uPortEventQueueSendIrq(gUartData[uart].eventQueueHandle,
-                                       &event, sizeof(event));
-            }
+            rxEventSendIrq(uart);
         }
     }
 
@@ -305,6 +570,35 @@ static void pollTimer(struct k_timer *timer_id)
 
 #endif // #ifdef CONFIG_UART_INTERRUPT_DRIVEN
 
+// Make sure that reception is running, e.g. once room has been
+// made in the receive buffer.
+// Note: gMutex should be locked before this is called.
+static void rxResume(int32_t handle)
+{
+#ifdef CONFIG_UART_INTERRUPT_DRIVEN
+    bool async = false;
+# ifdef CONFIG_UART_ASYNC_API
+    unsigned int key;
+
+    async = gUartData[handle].async;
+    if (async) {
+        key = irq_lock();
+        if (!gUartData[handle].rxEnabled) {
+            rxAsyncChunkGive(handle, true);
+        } else if (gUartData[handle].rxBufferRequested) {
+            gUartData[handle].rxBufferRequested = !rxAsyncChunkGive(handle, false);
+        }
+        irq_unlock(key);
+    }
+# endif
+    if (!async) {
+        uart_irq_rx_enable(gUartData[handle].pDevice);
+    }
+#else
+    (void) handle;
+#endif
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -356,11 +650,18 @@ int32_t uPortUartInit()
         }
     }
 
+    if (errorCode == U_ERROR_COMMON_SUCCESS) {
+        errorCode = (uErrorCode_t) uPortUartAsyncPrivateInit();
+    }
+
     return (int32_t)errorCode;
 }
 
 void uPortUartDeinit()
 {
+    // Complete any asynchronous writes first, they need the mutex
+    uPortUartAsyncPrivateDeinit();
+
     if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
@@ -439,8 +740,26 @@ int32_t uPortUartOpen(int32_t uart, int32_t baudRate,
                 gUartData[uart].config.baudrate = baudRate;
                 uart_configure(gUartData[uart].pDevice, &gUartData[uart].config);
 #ifdef CONFIG_UART_INTERRUPT_DRIVEN
-                uart_irq_callback_user_data_set(gUartData[uart].pDevice, uartCb, NULL);
-                uart_irq_rx_enable(gUartData[uart].pDevice);
+                bool async = false;
+# ifdef CONFIG_UART_ASYNC_API
+                gUartData[uart].rxHandedBytes = 0;
+                gUartData[uart].rxEnabled = false;
+                gUartData[uart].rxBufferRequested = false;
+                gUartData[uart].rxStopping = false;
+                k_sem_init(&gUartData[uart].rxStoppedSem, 0, 1);
+                // Use the asynchronous API if the driver
+                // for this UART supports it
+                async = (uart_callback_set(gUartData[uart].pDevice,
+                                           uartAsyncCb, (void *) uart) == 0);
+                gUartData[uart].async = async;
+                if (async) {
+                    rxResume(uart);
+                }
+# endif
+                if (!async) {
+                    uart_irq_callback_user_data_set(gUartData[uart].pDevice, uartCb, NULL);
+                    uart_irq_rx_enable(gUartData[uart].pDevice);
+                }
 #else
                 k_timer_init(&gUartData[uart].pollTimer, pollTimer, NULL);
                 k_timer_user_data_set(&gUartData[uart].pollTimer, (void *)uart);
@@ -458,6 +777,9 @@ int32_t uPortUartOpen(int32_t uart, int32_t baudRate,
 
 void uPortUartClose(int32_t handle)
 {
+    // Complete any asynchronous writes first, they need the mutex
+    uPortUartAsyncPrivateClose(handle);
+
     if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
@@ -554,9 +876,32 @@ int32_t uPortUartRead(int32_t handle, void *pBuffer,
                 }
 
                 gUartData[handle].bufferFull = false;
-#ifdef CONFIG_UART_INTERRUPT_DRIVEN
-                uart_irq_rx_enable(gUartData[handle].pDevice);
-#endif
+                rxResume(handle);
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return (int32_t) sizeOrErrorCode;
+}
+
+int32_t uPortUartPeekSpan(int32_t handle, const char **ppData)
+{
+    uErrorCode_t sizeOrErrorCode = U_ERROR_COMMON_NOT_INITIALISED;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        sizeOrErrorCode = U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((ppData != NULL) && (handle >= 0) &&
+            (handle < sizeof(gUartData) / sizeof(gUartData[0])) &&
+            (gUartData[handle].pDevice != NULL)) {
+            sizeOrErrorCode = uartContiguousSize(handle);
+            *ppData = NULL;
+            if (sizeOrErrorCode > 0) {
+                *ppData = gUartData[handle].pBuffer + gUartData[handle].bufferRead;
             }
         }
 
@@ -566,6 +911,34 @@ int32_t uPortUartRead(int32_t handle, void *pBuffer,
     return (int32_t) sizeOrErrorCode;
 }
 
+int32_t uPortUartConsume(int32_t handle, size_t sizeBytes)
+{
+    uErrorCode_t errorCode = U_ERROR_COMMON_NOT_INITIALISED;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((handle >= 0) &&
+            (handle < sizeof(gUartData) / sizeof(gUartData[0])) &&
+            (gUartData[handle].pDevice != NULL) &&
+            (sizeBytes <= uartContiguousSize(handle))) {
+            if (sizeBytes > 0) {
+                gUartData[handle].bufferRead += sizeBytes;
+                gUartData[handle].bufferRead %= gUartData[handle].receiveBufferSizeBytes;
+                gUartData[handle].bufferFull = false;
+                rxResume(handle);
+            }
+            errorCode = U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return (int32_t) errorCode;
+}
+
 int32_t uPortUartWrite(int32_t handle, const void *pBuffer,
                        size_t sizeBytes)
 {
@@ -590,15 +963,24 @@ int32_t uPortUartWrite(int32_t handle, const void *pBuffer,
             // was wrong and it's not connected to the right
             // thing.
 #ifdef CONFIG_UART_INTERRUPT_DRIVEN
-            struct uartData_t data;
-            data.handle = handle;
-            data.pData = (void *)pBuffer;
-            data.len = sizeBytes;
-
-            k_fifo_put(&gUartData[handle].fifoTxData, &data);
-            uart_irq_tx_enable(gUartData[handle].pDevice);
-            // UART write is async to wait here to make this function synchronous
-            k_sem_take(&gUartData[handle].txSem, K_FOREVER);
+            bool async = false;
+# ifdef CONFIG_UART_ASYNC_API
+            async = gUartData[handle].async;
+            if (async && !txAsync(handle, (const char *) pBuffer, sizeBytes)) {
+                errorCode = U_ERROR_COMMON_PLATFORM;
+            }
+# endif
+            if (!async) {
+                struct uartData_t data;
+                data.handle = handle;
+                data.pData = (void *)pBuffer;
+                data.len = sizeBytes;
+
+                k_fifo_put(&gUartData[handle].fifoTxData, &data);
+                uart_irq_tx_enable(gUartData[handle].pDevice);
+                // UART write is async to wait here to make this function synchronous
+                k_sem_take(&gUartData[handle].txSem, K_FOREVER);
+            }
 #else
             // When we have no interrupts we can block right here
             const unsigned char *pBufferUnsignedChar = (const unsigned char *) pBuffer;
@@ -848,6 +1230,19 @@ int32_t uPortUartEventStackMinFree(int32_t handle)
     return sizeOrErrorCode;
 }
 
+// Set a delimiter for the data received event.
+int32_t uPortUartEventDelimiterSet(int32_t handle, int32_t delimiter,
+                                   int32_t timeoutMs)
+{
+    (void) handle;
+    (void) delimiter;
+    (void) timeoutMs;
+
+    // Not supported on this platform: events are passed on
+    // as they arrive
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
 bool uPortUartIsRtsFlowControlEnabled(int32_t handle)
 {
     bool rtsFlowControlIsEnabled = false;
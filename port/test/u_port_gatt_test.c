@@ -218,6 +218,8 @@ static uPortBtLeAddressType_t gRemoteSpsPeripheralType;
 static uPortBtLeAddressType_t gRemoteSpsCentralType;
 static volatile uPortGattIter_t gGattIterReturnValue;
 static uPortQueueHandle_t gEvtQueue = NULL;
+static volatile int32_t gNotifyBatchNumSent = -1;
+static volatile int32_t gNotifyBatchNumFailed = -1;
 
 static uPortGattUuid16_t gAppearanceCharUuid = {
     .type = U_PORT_GATT_UUID_TYPE_16,
@@ -732,6 +734,14 @@ static int32_t remoteWritesCreditCcc(int32_t gapConnHandle, const void *pBuf, ui
     return len;
 }
 
+static void notifyBatchCallback(int32_t numSent, int32_t numFailed, void *pParam)
+{
+    if (pParam == gGattCallbackParamIn) {
+        gNotifyBatchNumFailed = numFailed;
+        gNotifyBatchNumSent = numSent;
+    }
+}
+
 static bool parseSpsCccWriteData(spsWriteEvt_t *evt, uint16_t *data)
 {
     if ((evt->length == 2) && (evt->offset == 0)) {
@@ -1545,6 +1555,26 @@ U_PORT_TEST_FUNCTION("[portGatt]", "portGattServerConf")
         U_PORT_TEST_ASSERT_EQUAL(notify->length, sizeof(notify->data));
         U_PORT_TEST_ASSERT(memcmp(notify->data, "abcd", sizeof(notify->data)) == 0);
 
+        uPortGattNotifyBatchEntry_t batch[] = {
+            {connHandle, &gSpsCreditsChar, &credits, 1},
+            {connHandle, &gSpsFifoChar, "efgh", 4},
+            {connHandle, NULL, "ijkl", 4}
+        };
+        U_TEST_PRINT_LINE("uPortGattNotifyBatch() - no entries.");
+        errorCode = uPortGattNotifyBatch(batch, 0, notifyBatchCallback, gGattCallbackParamIn);
+        U_PORT_TEST_ASSERT_EQUAL(errorCode, (int32_t)U_ERROR_COMMON_INVALID_PARAMETER);
+        U_TEST_PRINT_LINE("notify credits and data to remote client in one batch.");
+        errorCode = uPortGattNotifyBatch(batch, sizeof(batch) / sizeof(batch[0]),
+                                         notifyBatchCallback, gGattCallbackParamIn);
+        // The last entry has no characteristic so should not be queued
+        U_PORT_TEST_ASSERT_EQUAL(errorCode, 2);
+        U_TEST_PRINT_LINE("wait for data to echo back.");
+        U_PORT_TEST_ASSERT(waitForEvt(GATT_EVT_SPS_WRITE_FIFO_CHAR, &evt, CONNECTION_SETUP_TIMEOUT));
+        U_PORT_TEST_ASSERT_EQUAL(notify->length, sizeof(notify->data));
+        U_PORT_TEST_ASSERT(memcmp(notify->data, "efgh", sizeof(notify->data)) == 0);
+        U_PORT_TEST_ASSERT_EQUAL(gNotifyBatchNumSent, 2);
+        U_PORT_TEST_ASSERT_EQUAL(gNotifyBatchNumFailed, 1);
+
         U_TEST_PRINT_LINE("disconnect.");
         U_PORT_TEST_ASSERT_EQUAL(uPortGattDisconnectGap(connHandle), 0);
         U_PORT_TEST_ASSERT(waitForEvt(GATT_EVT_CONN_STATUS, &evt, WAIT_FOR_CALLBACK_TIMEOUT));
@@ -63,6 +63,8 @@
 #endif
 #include "u_port_crypto.h"
 #include "u_port_event_queue.h"
+#include "u_port_log_deferred.h"
+#include "u_port_perf_counter.h"
 #include "u_error_common.h"
 
 #ifdef CONFIG_IRQ_OFFLOAD
@@ -174,6 +176,37 @@
  */
 #define U_PORT_TEST_OS_EVENT_QUEUE_ITERATIONS 100
 
+/** The number of pointer events to send in the event queue test.
+ */
+#define U_PORT_TEST_OS_EVENT_QUEUE_PTR_ITERATIONS 10
+
+/** The size of the blocks sent as pointer events in the event
+ * queue test: deliberately larger than any copied event can be.
+ */
+#define U_PORT_TEST_OS_EVENT_QUEUE_PTR_LENGTH_BYTES (U_PORT_EVENT_QUEUE_MAX_PARAM_LENGTH_BYTES * 2)
+
+/** The number of event queues in the event queue pool test: one
+ * low priority queue and the rest at a higher priority.
+ */
+#define U_PORT_TEST_OS_EVENT_QUEUE_POOL_NUM_QUEUES 3
+
+/** The number of events sent to each queue of the event queue
+ * pool test, must be less than 100.
+ */
+#define U_PORT_TEST_OS_EVENT_QUEUE_POOL_NUM_EVENTS 3
+
+/** The number of events recorded in the event queue pool test:
+ * those sent to each queue plus one to hold the pool task.
+ */
+#define U_PORT_TEST_OS_EVENT_QUEUE_POOL_NUM_RECORDED ((U_PORT_TEST_OS_EVENT_QUEUE_POOL_NUM_QUEUES * \
+                                                      U_PORT_TEST_OS_EVENT_QUEUE_POOL_NUM_EVENTS) + 1)
+
+/** The size of block, and number of blocks, of the fixed-block
+ * pool in the tagged heap test.
+ */
+#define U_PORT_TEST_HEAP_POOL_BLOCK_SIZE_BYTES 64
+#define U_PORT_TEST_HEAP_POOL_NUM_BLOCKS 4
+
 /** The minimum item size for the event queue test: we used
  * to fix this at 1 however there are some OS's which, internally,
  * allocate space in words, hence it is 4 for greater compatibility.
@@ -232,6 +265,13 @@
 # define U_PORT_TEST_CRITICAL_SECTION_TEST_WAIT_LOOPS 1000000
 #endif
 
+#ifndef U_PORT_TEST_MUTEX_PROFILE_HOLD_MS
+/** How long each side of the mutex profile test holds the mutex
+ * while the other waits for it.
+ */
+# define U_PORT_TEST_MUTEX_PROFILE_HOLD_MS 100
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -266,6 +306,12 @@ typedef struct {
 // OS test mutex handle.
 static uPortMutexHandle_t gMutexHandle = NULL;
 
+#if defined(U_CFG_MUTEX_DEBUG) && defined(U_CFG_MUTEX_DEBUG_PROFILE)
+/** Set by mutexProfileTestTask() once it has locked the mutex.
+ */
+static volatile bool gMutexProfileTaskLocked = false;
+#endif
+
 // OS test semaphore handle.
 static uPortSemaphoreHandle_t gSemaphoreHandle = NULL;
 
@@ -311,6 +357,36 @@ static int32_t gEventQueueMinErrorFlag;
 // Counter for event queue callback min length
 static int32_t gEventQueueMinCounter;
 
+// Error flag for event queue callback with pointer events
+static int32_t gEventQueuePtrErrorFlag;
+
+// Counter for event queue callback with pointer events
+static int32_t gEventQueuePtrCounter;
+
+// Number of pointer event blocks released
+static int32_t gEventQueuePtrReleaseCount;
+
+// Handles of the event queues in the event queue pool test.
+static int32_t gEventQueuePoolHandle[U_PORT_TEST_OS_EVENT_QUEUE_POOL_NUM_QUEUES];
+
+// Set to make the event queue pool function hold on to the pool task.
+static volatile bool gEventQueuePoolHold;
+
+// Error flag for the event queue pool function.
+static volatile int32_t gEventQueuePoolErrorFlag;
+
+// The events received by the event queue pool function, in order.
+static int32_t gEventQueuePoolEvent[U_PORT_TEST_OS_EVENT_QUEUE_POOL_NUM_RECORDED];
+
+// Number of events received by the event queue pool function.
+static volatile int32_t gEventQueuePoolCount;
+
+// Set to make the event queue "once" function hold on to its task.
+static volatile bool gEventQueueOnceHold;
+
+// Number of events received by the event queue "once" function.
+static volatile int32_t gEventQueueOnceCount;
+
 #if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B < 0)
 
 // The data to send during UART testing.
@@ -349,6 +425,10 @@ static char gUartBuffer[(U_CFG_TEST_UART_BUFFER_LENGTH_BYTES / 2) +
  * I2C buses can easily get stuck, it would seem.
  */
 static int32_t gI2cHandle = -1;
+
+/** The result of an asynchronous I2C transfer.
+ */
+static volatile int32_t gI2cAsyncResult = INT32_MIN;
 #endif
 
 /** Data for mktime64() testing.
@@ -388,6 +468,16 @@ static const char gSha256Output[] =
     "\x03\x80\x51\xe9\xc3\x24\x39\x3b\xd1\xca\x19\x78\xdd\x09\x52\xc2"
     "\xaa\x37\x42\xca\x4f\x1b\xd5\xcd\x46\x11\xce\xa8\x38\x92\xd3\x82";
 
+/** MD5 test vector, input, from the test suite in:
+ * https://www.rfc-editor.org/rfc/rfc1321#appendix-A.5
+ */
+static const char gMd5Input[] = "message digest";
+
+/** MD5 test vector, output.
+ */
+static const char gMd5Output[] =
+    "\xf9\x6b\x69\x7d\x7c\xb7\x93\x8d\x52\x5a\x2f\x31\xaa\xf1\x61\xd0";
+
 /** HMAC SHA256 test vector, key, test 1 from:
  * https://tools.ietf.org/html/rfc4231#page-3
  */
@@ -852,6 +942,93 @@ static void eventQueueMinFunction(void *pParam,
     gEventQueueMinCounter++;
 }
 
+// Event queue function for pointer events.
+static void eventQueuePtrFunction(void *pParam,
+                                  size_t paramLength)
+{
+    // We expect paramLength of U_PORT_TEST_OS_EVENT_QUEUE_PTR_LENGTH_BYTES
+    // with the first and last bytes containing a count of the
+    // number of times we've been called, the block not yet released
+    if ((pParam == NULL) ||
+        (paramLength != U_PORT_TEST_OS_EVENT_QUEUE_PTR_LENGTH_BYTES)) {
+        gEventQueuePtrErrorFlag = 1;
+    } else if ((*((uint8_t *) pParam) != (uint8_t) gEventQueuePtrCounter) ||
+               (*((uint8_t *) pParam + paramLength - 1) != (uint8_t) gEventQueuePtrCounter)) {
+        gEventQueuePtrErrorFlag = 2;
+    } else if (gEventQueuePtrReleaseCount != gEventQueuePtrCounter) {
+        gEventQueuePtrErrorFlag = 3;
+    }
+
+    gEventQueuePtrCounter++;
+}
+
+// Release function for pointer events.
+static void eventQueuePtrRelease(void *pParam)
+{
+    gEventQueuePtrReleaseCount++;
+    uPortFree(pParam);
+}
+
+// Event queue function for the event queues of the pool test;
+// the event is an int32_t, the index of the queue it was sent on
+// times 100 plus a number, negative meaning "hold the pool task".
+static void eventQueuePoolFunction(void *pParam,
+                                   size_t paramLength)
+{
+    int32_t event;
+    int32_t index;
+
+    if ((pParam == NULL) || (paramLength != sizeof(event))) {
+        gEventQueuePoolErrorFlag = 1;
+    } else {
+        memcpy(&event, pParam, sizeof(event));
+        index = event / 100;
+        if (event < 0) {
+            index = 0;
+        }
+        if ((index >= U_PORT_TEST_OS_EVENT_QUEUE_POOL_NUM_QUEUES) ||
+            !uPortEventQueueIsTask(gEventQueuePoolHandle[index])) {
+            gEventQueuePoolErrorFlag = 2;
+        }
+        // No need to lock: the functions of the queues in a
+        // pool are never called simultaneously
+        if (gEventQueuePoolCount < (int32_t) (sizeof(gEventQueuePoolEvent) /
+                                              sizeof(gEventQueuePoolEvent[0]))) {
+            gEventQueuePoolEvent[gEventQueuePoolCount] = event;
+        }
+        gEventQueuePoolCount++;
+        while ((event < 0) && gEventQueuePoolHold) {
+            uPortTaskBlock(10);
+        }
+    }
+}
+
+// Event queue function for the uPortEventQueueSendIrqOnce() test:
+// holds on to the event queue task on the first call.
+static void eventQueueOnceFunction(void *pParam, size_t paramLength)
+{
+    (void) pParam;
+    (void) paramLength;
+
+    gEventQueueOnceCount++;
+    while ((gEventQueueOnceCount == 1) && gEventQueueOnceHold) {
+        uPortTaskBlock(10);
+    }
+}
+
+#if (U_CFG_APP_GNSS_I2C >= 0)
+// Callback for uPortI2cControllerSendReceiveAsync() completion.
+static void i2cAsyncCallback(int32_t i2cHandle, int32_t errorCodeOrLength,
+                             void *pParam)
+{
+    int32_t *pErrorCodeOrLength = (int32_t *) pParam;
+
+    (void) i2cHandle;
+
+    *pErrorCodeOrLength = errorCodeOrLength;
+}
+#endif
+
 #if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B < 0)
 
 // Callback that is called when data arrives at the UART
@@ -1041,6 +1218,15 @@ static void runUartTest(int32_t size, int32_t speed, bool flowControlOn)
                        (x == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED));
     uPortUartCtsResume(uartHandle);
 
+    if (flowControlOn) {
+        // Where it is supported, ask for data received events only
+        // at line endings: there are none in the test data so this
+        // checks that the timeout passes the data on regardless
+        x = uPortUartEventDelimiterSet(uartHandle, '\n', 10);
+        U_PORT_TEST_ASSERT((x == 0) ||
+                           (x == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED));
+    }
+
     // Manually send an Rx event and check that it caused
     // the callback to be called
     U_PORT_TEST_ASSERT(eventCallbackData.callCount == 0);
@@ -1130,6 +1316,151 @@ static void runUartTest(int32_t size, int32_t speed, bool flowControlOn)
     uPortUartClose(uartHandle);
 }
 
+// Check uPortUartPeekSpan()/uPortUartConsume(), where supported,
+// by looping back a block of test data and reading it with no copy.
+static void runUartPeekTest()
+{
+    int32_t uartHandle;
+    const char *pData = NULL;
+    size_t received = 0;
+    // Keep well within the receive buffer so that it can't fill
+    size_t length = 100;
+    int32_t x;
+
+    U_TEST_PRINT_LINE("testing UART zero-copy read...");
+    uartHandle = uPortUartOpen(U_CFG_TEST_UART_A,
+                               115200, NULL,
+                               U_CFG_TEST_UART_BUFFER_LENGTH_BYTES,
+                               U_CFG_TEST_PIN_UART_A_TXD,
+                               U_CFG_TEST_PIN_UART_A_RXD,
+                               -1, -1);
+    U_PORT_TEST_ASSERT(uartHandle >= 0);
+
+    x = uPortUartPeekSpan(uartHandle, &pData);
+    if (x == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        U_TEST_PRINT_LINE("zero-copy read not supported on this platform.");
+    } else {
+        // Nothing should have been received yet
+        U_PORT_TEST_ASSERT(x == 0);
+        U_PORT_TEST_ASSERT(pData == NULL);
+        U_PORT_TEST_ASSERT(uPortUartConsume(uartHandle, 1) < 0);
+        U_PORT_TEST_ASSERT(uPortUartWrite(uartHandle, gUartTestData,
+                                          length) == length);
+        uPortTaskBlock(U_PORT_TEST_UART_TIME_TO_ARRIVE_MS);
+        // The data may arrive as more than one span if it
+        // wraps around the end of the receive buffer
+        do {
+            x = uPortUartPeekSpan(uartHandle, &pData);
+            U_PORT_TEST_ASSERT(x >= 0);
+            U_PORT_TEST_ASSERT(received + (size_t) x <= length);
+            if (x > 0) {
+                U_PORT_TEST_ASSERT(pData != NULL);
+                U_PORT_TEST_ASSERT(memcmp(pData, gUartTestData + received, x) == 0);
+                // Can't consume more than the span
+                U_PORT_TEST_ASSERT(uPortUartConsume(uartHandle, x + 1) < 0);
+                U_PORT_TEST_ASSERT(uPortUartConsume(uartHandle, x) == 0);
+                received += x;
+            }
+        } while (x > 0);
+        U_TEST_PRINT_LINE("%d byte(s) received with no copy.", (int32_t) received);
+        U_PORT_TEST_ASSERT(received == length);
+        U_PORT_TEST_ASSERT(uPortUartGetReceiveSize(uartHandle) == 0);
+    }
+
+    uPortUartClose(uartHandle);
+}
+
+// Callback for uPortUartWriteAsync() completion.
+static void uartWriteAsyncCallback(int32_t uartHandle,
+                                   int32_t sizeOrErrorCode,
+                                   void *pParam)
+{
+    int32_t *pSizeOrErrorCode = (int32_t *) pParam;
+
+    (void) uartHandle;
+
+    *pSizeOrErrorCode = sizeOrErrorCode;
+}
+
+// Read the given amount of looped-back data from the UART and
+// check that it matches the start of gUartTestData.
+static void uartCheckLoopBack(int32_t uartHandle, size_t length)
+{
+    size_t received = 0;
+    int32_t startTimeMs = uPortGetTickTimeMs();
+    int32_t x;
+
+    while ((received < length) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_PORT_TEST_UART_TIME_TO_ARRIVE_MS)) {
+        x = uPortUartRead(uartHandle, gUartBuffer + received,
+                          sizeof(gUartBuffer) - received);
+        U_PORT_TEST_ASSERT(x >= 0);
+        received += x;
+        if (x == 0) {
+            uPortTaskBlock(10);
+        }
+    }
+    U_PORT_TEST_ASSERT(received == length);
+    U_PORT_TEST_ASSERT(memcmp(gUartBuffer, gUartTestData, length) == 0);
+}
+
+// Check uPortUartWriteV() and uPortUartWriteAsync() by looping
+// back blocks of test data.
+static void runUartWriteAsyncTest()
+{
+    int32_t uartHandle;
+    uPortUartWriteVector_t vector[3];
+    volatile int32_t sizeOrErrorCode = INT32_MIN;
+    // Keep well within the receive buffer so that it can't fill
+    size_t length = 100;
+    int32_t startTimeMs;
+
+    U_TEST_PRINT_LINE("testing UART gather and asynchronous write...");
+    uartHandle = uPortUartOpen(U_CFG_TEST_UART_A,
+                               115200, NULL,
+                               U_CFG_TEST_UART_BUFFER_LENGTH_BYTES,
+                               U_CFG_TEST_PIN_UART_A_TXD,
+                               U_CFG_TEST_PIN_UART_A_RXD,
+                               -1, -1);
+    U_PORT_TEST_ASSERT(uartHandle >= 0);
+
+    // Gather write, including an empty entry
+    vector[0].pBuffer = gUartTestData;
+    vector[0].sizeBytes = 10;
+    vector[1].pBuffer = NULL;
+    vector[1].sizeBytes = 0;
+    vector[2].pBuffer = gUartTestData + 10;
+    vector[2].sizeBytes = length - 10;
+    U_PORT_TEST_ASSERT(uPortUartWriteV(uartHandle, NULL, 1) < 0);
+    U_PORT_TEST_ASSERT(uPortUartWriteV(uartHandle, vector,
+                                       sizeof(vector) / sizeof(vector[0])) == (int32_t) length);
+    uartCheckLoopBack(uartHandle, length);
+
+    // Asynchronous write
+    U_PORT_TEST_ASSERT(uPortUartWriteAsync(uartHandle, NULL, length,
+                                           uartWriteAsyncCallback,
+                                           (void *) &sizeOrErrorCode) < 0);
+    U_PORT_TEST_ASSERT(uPortUartWriteAsync(uartHandle, gUartTestData, length,
+                                           uartWriteAsyncCallback,
+                                           (void *) &sizeOrErrorCode) == 0);
+    startTimeMs = uPortGetTickTimeMs();
+    while ((sizeOrErrorCode == INT32_MIN) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_PORT_TEST_UART_TIME_TO_ARRIVE_MS)) {
+        uPortTaskBlock(10);
+    }
+    U_TEST_PRINT_LINE("asynchronous write completed with %d.", sizeOrErrorCode);
+    U_PORT_TEST_ASSERT(sizeOrErrorCode == (int32_t) length);
+    uartCheckLoopBack(uartHandle, length);
+
+    // Closing the UART should complete an outstanding write
+    sizeOrErrorCode = INT32_MIN;
+    U_PORT_TEST_ASSERT(uPortUartWriteAsync(uartHandle, gUartTestData, length,
+                                           uartWriteAsyncCallback,
+                                           (void *) &sizeOrErrorCode) == 0);
+    uPortUartClose(uartHandle);
+    U_PORT_TEST_ASSERT(sizeOrErrorCode == (int32_t) length);
+}
+
 #endif // (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B < 0)
 
 // Timer callback
@@ -1163,6 +1494,23 @@ static void criticalSectionTestTask(void *pParameter)
     uPortTaskDelete(NULL);
 }
 
+#if defined(U_CFG_MUTEX_DEBUG) && defined(U_CFG_MUTEX_DEBUG_PROFILE)
+// The test task for the mutex profile: lock the mutex passed
+// in pParameter, which the test is holding, then hold it for a
+// while before unlocking it and exiting
+static void mutexProfileTestTask(void *pParameter)
+{
+    uPortMutexHandle_t mutexHandle = (uPortMutexHandle_t) pParameter;
+
+    uPortMutexLock(mutexHandle);
+    gMutexProfileTaskLocked = true;
+    uPortTaskBlock(U_PORT_TEST_MUTEX_PROFILE_HOLD_MS);
+    uPortMutexUnlock(mutexHandle);
+
+    uPortTaskDelete(NULL);
+}
+#endif
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: TESTS
  * -------------------------------------------------------------- */
@@ -1346,6 +1694,8 @@ U_PORT_TEST_FUNCTION("[port]", "portOs")
 //lint -esym(550, startTimeMs, timeNowMs) measuring time delays
     int32_t startTimeMs;
     int32_t timeNowMs;
+    int64_t startTimeUs;
+    int64_t timeNowUs;
     int32_t stackMinFreeBytes;
     int32_t y = -1;
     int32_t z;
@@ -1361,6 +1711,7 @@ U_PORT_TEST_FUNCTION("[port]", "portOs")
     U_PORT_TEST_ASSERT(uPortInit() == 0);
 
     startTimeMs = uPortGetTickTimeMs();
+    startTimeUs = uPortGetTickTimeUs();
     U_TEST_PRINT_LINE("tick time now is %d.", (int32_t) startTimeMs);
 
     U_TEST_PRINT_LINE("creating a mutex...");
@@ -1505,11 +1856,19 @@ U_PORT_TEST_FUNCTION("[port]", "portOs")
     U_PORT_TEST_ASSERT(uPortQueueDelete(queueHandle) == 0);
 
     timeNowMs = uPortGetTickTimeMs() - startTimeMs;
+    timeNowUs = uPortGetTickTimeUs() - startTimeUs;
     U_TEST_PRINT_LINE("according to uPortGetTickTimeMs()"
                       " the test took %d ms.", (int32_t) timeNowMs);
+    U_TEST_PRINT_LINE("according to uPortGetTickTimeUs()"
+                      " the test took %d us.", (int32_t) timeNowUs);
+    // The high resolution time must move forwards
+    U_PORT_TEST_ASSERT(timeNowUs > 0);
 #ifdef U_PORT_TEST_CHECK_TIME_TAKEN
     U_PORT_TEST_ASSERT((timeNowMs > 0) &&
                        (timeNowMs < U_PORT_TEST_OS_GUARD_DURATION_MS));
+    // ...and agree with the OS tick, to within a tick or two
+    U_PORT_TEST_ASSERT((timeNowUs / 1000 > timeNowMs - 50) &&
+                       (timeNowUs / 1000 < timeNowMs + 50));
 #endif
 
     uPortDeinit();
@@ -1870,6 +2229,8 @@ U_PORT_TEST_FUNCTION("[port]", "portEventQueue")
     int32_t stackMinFreeBytes;
     int32_t heapUsed;
     int32_t heapClibLossOffset = (int32_t) gSystemHeapLost;
+    int32_t ptrHandle;
+    uint8_t *pBlock;
 
     // Whatever called us likely initialised the
     // port so deinitialise it here to obtain the
@@ -1882,6 +2243,9 @@ U_PORT_TEST_FUNCTION("[port]", "portEventQueue")
     gEventQueueMaxCounter = 0;
     gEventQueueMinErrorFlag = 0;
     gEventQueueMinCounter = 0;
+    gEventQueuePtrErrorFlag = 0;
+    gEventQueuePtrCounter = 0;
+    gEventQueuePtrReleaseCount = 0;
 
     U_PORT_TEST_ASSERT(uPortInit() == 0);
 
@@ -2017,6 +2381,44 @@ U_PORT_TEST_FUNCTION("[port]", "portEventQueue")
         U_PORT_TEST_ASSERT(stackMinFreeBytes > 0);
     }
 
+    // Now pass blocks by pointer, larger than could ever be copied,
+    // on a queue which has no room for anything else
+    U_TEST_PRINT_LINE("sending %d pointer event(s)...",
+                      U_PORT_TEST_OS_EVENT_QUEUE_PTR_ITERATIONS);
+    ptrHandle = uPortEventQueueOpen(eventQueuePtrFunction, "ptr", 0,
+                                    U_PORT_EVENT_QUEUE_MIN_TASK_STACK_SIZE_BYTES,
+                                    U_CFG_TEST_OS_TASK_PRIORITY,
+                                    U_PORT_TEST_QUEUE_LENGTH);
+    U_PORT_TEST_ASSERT(ptrHandle >= 0);
+    U_PORT_TEST_ASSERT(uPortEventQueueSendPtr(ptrHandle, NULL, 0, NULL) < 0);
+    // Only pointer events fit on this queue
+    U_PORT_TEST_ASSERT(uPortEventQueueSend(ptrHandle, pParam, 1) < 0);
+    for (x = 0; x < U_PORT_TEST_OS_EVENT_QUEUE_PTR_ITERATIONS; x++) {
+        pBlock = (uint8_t *) pUPortMalloc(U_PORT_TEST_OS_EVENT_QUEUE_PTR_LENGTH_BYTES);
+        U_PORT_TEST_ASSERT(pBlock != NULL);
+        *pBlock = (uint8_t) x;
+        *(pBlock + U_PORT_TEST_OS_EVENT_QUEUE_PTR_LENGTH_BYTES - 1) = (uint8_t) x;
+        y = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+        if (x & 1) {
+            y = uPortEventQueueSendPtrIrq(ptrHandle, pBlock,
+                                          U_PORT_TEST_OS_EVENT_QUEUE_PTR_LENGTH_BYTES,
+                                          eventQueuePtrRelease);
+        }
+        if (y == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+            y = uPortEventQueueSendPtr(ptrHandle, pBlock,
+                                       U_PORT_TEST_OS_EVENT_QUEUE_PTR_LENGTH_BYTES,
+                                       eventQueuePtrRelease);
+        }
+        U_PORT_TEST_ASSERT(y == 0);
+    }
+    // Closing the queue should handle everything still on it
+    U_PORT_TEST_ASSERT(uPortEventQueueClose(ptrHandle) == 0);
+    U_TEST_PRINT_LINE("%d pointer event(s) received, %d released.",
+                      gEventQueuePtrCounter, gEventQueuePtrReleaseCount);
+    U_PORT_TEST_ASSERT(gEventQueuePtrErrorFlag == 0);
+    U_PORT_TEST_ASSERT(gEventQueuePtrCounter == U_PORT_TEST_OS_EVENT_QUEUE_PTR_ITERATIONS);
+    U_PORT_TEST_ASSERT(gEventQueuePtrReleaseCount == U_PORT_TEST_OS_EVENT_QUEUE_PTR_ITERATIONS);
+
     U_TEST_PRINT_LINE("closing the event queues...");
     U_PORT_TEST_ASSERT(uPortEventQueueClose(gEventQueueMaxHandle) == 0);
     U_PORT_TEST_ASSERT(uPortEventQueueClose(gEventQueueMinHandle) == 0);
@@ -2049,6 +2451,331 @@ U_PORT_TEST_FUNCTION("[port]", "portEventQueue")
                        (heapUsed <= ((int32_t) gSystemHeapLost) - heapClibLossOffset));
 }
 
+/** Test: event queues in a pool.
+ */
+U_PORT_TEST_FUNCTION("[port]", "portEventQueuePool")
+{
+    int32_t poolHandle;
+    int32_t event;
+    int32_t lastEvent[U_PORT_TEST_OS_EVENT_QUEUE_POOL_NUM_QUEUES];
+    int32_t lastIndex = -1;
+    int32_t index;
+    int32_t y;
+    int32_t heapUsed;
+    int32_t heapClibLossOffset = (int32_t) gSystemHeapLost;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+
+    gEventQueuePoolErrorFlag = 0;
+    gEventQueuePoolCount = 0;
+    gEventQueuePoolHold = true;
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    U_TEST_PRINT_LINE("opening an event queue pool...");
+    poolHandle = uPortEventQueuePoolOpen("eventQueuePoolTest",
+                                         U_PORT_EVENT_QUEUE_MIN_TASK_STACK_SIZE_BYTES,
+                                         U_CFG_OS_APP_TASK_PRIORITY);
+    U_PORT_TEST_ASSERT(poolHandle >= 0);
+    U_PORT_TEST_ASSERT(uPortEventQueueOpenInPool(poolHandle + 1, eventQueuePoolFunction,
+                                                 sizeof(event), 0, 1) < 0);
+    U_PORT_TEST_ASSERT(uPortEventQueueOpenInPool(poolHandle, NULL,
+                                                 sizeof(event), 0, 1) < 0);
+    // The first queue is the low priority one, the rest higher
+    for (size_t x = 0; x < U_PORT_TEST_OS_EVENT_QUEUE_POOL_NUM_QUEUES; x++) {
+        gEventQueuePoolHandle[x] = uPortEventQueueOpenInPool(poolHandle,
+                                                             eventQueuePoolFunction,
+                                                             sizeof(event),
+                                                             x > 0 ? 1 : 0,
+                                                             U_PORT_TEST_OS_EVENT_QUEUE_POOL_NUM_EVENTS + 1);
+        U_PORT_TEST_ASSERT(gEventQueuePoolHandle[x] >= 0);
+        U_PORT_TEST_ASSERT(!uPortEventQueueIsTask(gEventQueuePoolHandle[x]));
+        y = uPortEventQueueStackMinFree(gEventQueuePoolHandle[x]);
+        U_PORT_TEST_ASSERT((y > 0) || (y == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED));
+        lastEvent[x] = (((int32_t) x) * 100) - 1;
+    }
+
+    // Hold the pool task and then queue up events on all of the
+    // queues, low priority first
+    event = -1;
+    U_PORT_TEST_ASSERT(uPortEventQueueSend(gEventQueuePoolHandle[0], &event,
+                                           sizeof(event)) == 0);
+    for (y = 0; (gEventQueuePoolCount == 0) && (y < 100); y++) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(gEventQueuePoolCount == 1);
+    for (size_t x = 0; x < U_PORT_TEST_OS_EVENT_QUEUE_POOL_NUM_QUEUES; x++) {
+        for (int32_t z = 0; z < U_PORT_TEST_OS_EVENT_QUEUE_POOL_NUM_EVENTS; z++) {
+            event = (((int32_t) x) * 100) + z;
+            U_PORT_TEST_ASSERT(uPortEventQueueSend(gEventQueuePoolHandle[x], &event,
+                                                   sizeof(event)) == 0);
+        }
+    }
+    gEventQueuePoolHold = false;
+    for (y = 0; (gEventQueuePoolCount < U_PORT_TEST_OS_EVENT_QUEUE_POOL_NUM_RECORDED) &&
+         (y < 100); y++) {
+        uPortTaskBlock(10);
+    }
+    U_TEST_PRINT_LINE("%d event(s) received.", gEventQueuePoolCount);
+    U_PORT_TEST_ASSERT(gEventQueuePoolErrorFlag == 0);
+    U_PORT_TEST_ASSERT(gEventQueuePoolCount == U_PORT_TEST_OS_EVENT_QUEUE_POOL_NUM_RECORDED);
+
+    // The higher priority queues should have been emptied first,
+    // alternately, then the low priority queue, each in order
+    U_PORT_TEST_ASSERT(gEventQueuePoolEvent[0] == -1);
+    for (size_t x = 1; x < U_PORT_TEST_OS_EVENT_QUEUE_POOL_NUM_RECORDED; x++) {
+        event = gEventQueuePoolEvent[x];
+        index = event / 100;
+        U_PORT_TEST_ASSERT((event >= 0) && (index < U_PORT_TEST_OS_EVENT_QUEUE_POOL_NUM_QUEUES));
+        U_PORT_TEST_ASSERT((index == 0) ==
+                           (x > (U_PORT_TEST_OS_EVENT_QUEUE_POOL_NUM_QUEUES - 1) *
+                            U_PORT_TEST_OS_EVENT_QUEUE_POOL_NUM_EVENTS));
+        if (index > 0) {
+            U_PORT_TEST_ASSERT(index != lastIndex);
+        }
+        U_PORT_TEST_ASSERT(event == lastEvent[index] + 1);
+        lastEvent[index] = event;
+        lastIndex = index;
+    }
+
+    // Close one queue directly and leave the others to the pool
+    U_PORT_TEST_ASSERT(uPortEventQueueClose(gEventQueuePoolHandle[0]) == 0);
+    U_PORT_TEST_ASSERT(uPortEventQueueSend(gEventQueuePoolHandle[0], &event,
+                                           sizeof(event)) < 0);
+    U_TEST_PRINT_LINE("closing the event queue pool...");
+    U_PORT_TEST_ASSERT(uPortEventQueuePoolClose(poolHandle) == 0);
+    U_PORT_TEST_ASSERT(uPortEventQueuePoolClose(poolHandle) < 0);
+    for (size_t x = 0; x < U_PORT_TEST_OS_EVENT_QUEUE_POOL_NUM_QUEUES; x++) {
+        U_PORT_TEST_ASSERT(uPortEventQueueSend(gEventQueuePoolHandle[x], &event,
+                                               sizeof(event)) < 0);
+    }
+
+    uPortDeinit();
+
+    // Give the RTOS idle task time to tidy-away the tasks
+    uPortTaskBlock(1000);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("%d byte(s) of heap were lost to the C library"
+                      " during this test and we have leaked %d byte(s).",
+                      gSystemHeapLost - heapClibLossOffset,
+                      heapUsed - (gSystemHeapLost - heapClibLossOffset));
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed < 0) ||
+                       (heapUsed <= ((int32_t) gSystemHeapLost) - heapClibLossOffset));
+}
+
+/** Test: uPortEventQueueSendIrqOnce(), called from a task here
+ * since the coalescing is all that is being tested.
+ */
+U_PORT_TEST_FUNCTION("[port]", "portEventQueueIrqOnce")
+{
+    int32_t handle;
+    int32_t event = 0;
+    int32_t y;
+    int32_t heapUsed;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    gEventQueueOnceCount = 0;
+    gEventQueueOnceHold = true;
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    U_PORT_TEST_ASSERT(uPortEventQueueSendIrqOnce(0, &event, sizeof(event)) < 0);
+    handle = uPortEventQueueOpen(eventQueueOnceFunction, "once", sizeof(event),
+                                 U_PORT_EVENT_QUEUE_MIN_TASK_STACK_SIZE_BYTES,
+                                 U_CFG_TEST_OS_TASK_PRIORITY,
+                                 U_PORT_TEST_QUEUE_LENGTH);
+    U_PORT_TEST_ASSERT(handle >= 0);
+    U_PORT_TEST_ASSERT(uPortEventQueueSendIrqOnce(handle, &event, sizeof(event) + 1) < 0);
+
+    y = uPortEventQueueSendIrqOnce(handle, &event, sizeof(event));
+    if (y == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        U_TEST_PRINT_LINE("uPortEventQueueSendIrq() not supported, skipping.");
+    } else {
+        U_PORT_TEST_ASSERT(y == 0);
+        // Wait for the event queue function to be holding on to the
+        // task: the pending flag has been cleared by then
+        for (size_t x = 0; (x < 100) && (gEventQueueOnceCount == 0); x++) {
+            uPortTaskBlock(10);
+        }
+        U_PORT_TEST_ASSERT(gEventQueueOnceCount == 1);
+        // Only the first of these should make it onto the queue
+        for (size_t x = 0; x < U_PORT_TEST_QUEUE_LENGTH * 2; x++) {
+            U_PORT_TEST_ASSERT(uPortEventQueueSendIrqOnce(handle, &event,
+                                                          sizeof(event)) == 0);
+        }
+        y = uPortEventQueueGetFree(handle);
+        U_TEST_PRINT_LINE("%d entries free on \"once\" event queue.", y);
+        U_PORT_TEST_ASSERT((y == U_PORT_TEST_QUEUE_LENGTH - 1) ||
+                           (y == (int32_t) U_ERROR_COMMON_NOT_IMPLEMENTED));
+        gEventQueueOnceHold = false;
+        for (size_t x = 0; (x < 100) && (gEventQueueOnceCount < 2); x++) {
+            uPortTaskBlock(10);
+        }
+        uPortTaskBlock(100);
+        U_TEST_PRINT_LINE("\"once\" event queue function called %d time(s).",
+                          gEventQueueOnceCount);
+        U_PORT_TEST_ASSERT(gEventQueueOnceCount == 2);
+    }
+    gEventQueueOnceHold = false;
+
+    U_PORT_TEST_ASSERT(uPortEventQueueClose(handle) == 0);
+
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+/** Test: tagged heap allocations and the fixed-block pool.
+ */
+U_PORT_TEST_FUNCTION("[port]", "portHeapTagged")
+{
+    // Type long long so that the buffer is aligned for the pool
+    long long poolBuffer[(U_PORT_TEST_HEAP_POOL_BLOCK_SIZE_BYTES *
+                          U_PORT_TEST_HEAP_POOL_NUM_BLOCKS) / sizeof(long long)];
+    uPortHeapPool_t pool;
+    uPortHeapArena_t arena = {pUPortHeapPoolMalloc, uPortHeapPoolFree, &pool};
+    uPortHeapTagStats_t stats;
+    char *pBlock[U_PORT_TEST_HEAP_POOL_NUM_BLOCKS + 1];
+    size_t size;
+    int32_t heapUsed;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    U_TEST_PRINT_LINE("testing tagged heap allocations...");
+    U_PORT_TEST_ASSERT(uPortHeapTagGetStats(U_PORT_HEAP_TAG_MAX_NUM, &stats) < 0);
+    U_PORT_TEST_ASSERT(uPortHeapTagGetStats(U_PORT_HEAP_TAG_APP, NULL) < 0);
+    U_PORT_TEST_ASSERT(pUPortMallocTagged(U_PORT_HEAP_TAG_MAX_NUM, 1) == NULL);
+    U_PORT_TEST_ASSERT(uPortHeapTagGetStats(U_PORT_HEAP_TAG_APP, &stats) == 0);
+    U_PORT_TEST_ASSERT(stats.currentBytes == 0);
+    U_PORT_TEST_ASSERT(stats.currentAllocations == 0);
+
+    // Allocate from the normal heap and check the accounting
+    pBlock[0] = (char *) pUPortMallocTagged(U_PORT_HEAP_TAG_APP, 100);
+    pBlock[1] = (char *) pUPortMallocTagged(U_PORT_HEAP_TAG_APP, 50);
+    U_PORT_TEST_ASSERT((pBlock[0] != NULL) && (pBlock[1] != NULL));
+    memset(pBlock[0], 0xAA, 100);
+    memset(pBlock[1], 0x55, 50);
+    U_PORT_TEST_ASSERT(uPortHeapTagGetStats(U_PORT_HEAP_TAG_APP, &stats) == 0);
+    U_PORT_TEST_ASSERT(stats.currentBytes == 150);
+    U_PORT_TEST_ASSERT(stats.peakBytes >= 150);
+    U_PORT_TEST_ASSERT(stats.currentAllocations == 2);
+    // Can't change the arena while something is allocated
+    U_PORT_TEST_ASSERT(uPortHeapTagSetArena(U_PORT_HEAP_TAG_APP, &arena) < 0);
+    uPortFreeTagged(pBlock[0]);
+    uPortFreeTagged(pBlock[1]);
+    uPortFreeTagged(NULL);
+    U_PORT_TEST_ASSERT(uPortHeapTagGetStats(U_PORT_HEAP_TAG_APP, &stats) == 0);
+    U_PORT_TEST_ASSERT(stats.currentBytes == 0);
+    U_PORT_TEST_ASSERT(stats.currentAllocations == 0);
+
+    U_TEST_PRINT_LINE("testing a fixed-block pool as an arena...");
+    U_PORT_TEST_ASSERT(uPortHeapPoolInit(&pool, NULL, sizeof(poolBuffer),
+                                         U_PORT_TEST_HEAP_POOL_BLOCK_SIZE_BYTES) < 0);
+    U_PORT_TEST_ASSERT(uPortHeapPoolInit(&pool, poolBuffer, sizeof(poolBuffer),
+                                         U_PORT_TEST_HEAP_POOL_BLOCK_SIZE_BYTES) ==
+                       U_PORT_TEST_HEAP_POOL_NUM_BLOCKS);
+    U_PORT_TEST_ASSERT(uPortHeapTagSetArena(U_PORT_HEAP_TAG_APP, &arena) == 0);
+    // Fill the pool; the block after that must fail
+    size = U_PORT_TEST_HEAP_POOL_BLOCK_SIZE_BYTES / 2;
+    for (size_t x = 0; x < sizeof(pBlock) / sizeof(pBlock[0]); x++) {
+        pBlock[x] = (char *) pUPortMallocTagged(U_PORT_HEAP_TAG_APP, size);
+        if (x < U_PORT_TEST_HEAP_POOL_NUM_BLOCKS) {
+            U_PORT_TEST_ASSERT(pBlock[x] != NULL);
+            U_PORT_TEST_ASSERT((pBlock[x] >= (char *) poolBuffer) &&
+                               (pBlock[x] + size <= ((char *) poolBuffer) + sizeof(poolBuffer)));
+            memset(pBlock[x], (int) x, size);
+        } else {
+            U_PORT_TEST_ASSERT(pBlock[x] == NULL);
+        }
+    }
+    // Too big for a block
+    U_PORT_TEST_ASSERT(pUPortMallocTagged(U_PORT_HEAP_TAG_APP,
+                                          U_PORT_TEST_HEAP_POOL_BLOCK_SIZE_BYTES) == NULL);
+    U_PORT_TEST_ASSERT(uPortHeapTagGetStats(U_PORT_HEAP_TAG_APP, &stats) == 0);
+    U_TEST_PRINT_LINE("%d byte(s) in %d block(s) allocated, %d failed.",
+                      (int32_t) stats.currentBytes, (int32_t) stats.currentAllocations,
+                      (int32_t) stats.failedAllocations);
+    U_PORT_TEST_ASSERT(stats.currentBytes == size * U_PORT_TEST_HEAP_POOL_NUM_BLOCKS);
+    U_PORT_TEST_ASSERT(stats.currentAllocations == U_PORT_TEST_HEAP_POOL_NUM_BLOCKS);
+    U_PORT_TEST_ASSERT(stats.failedAllocations >= 2);
+    // Free one, check that it can be allocated again
+    uPortFreeTagged(pBlock[1]);
+    pBlock[1] = (char *) pUPortMallocTagged(U_PORT_HEAP_TAG_APP, size);
+    U_PORT_TEST_ASSERT(pBlock[1] != NULL);
+    memset(pBlock[1], 1, size);
+    for (size_t x = 0; x < U_PORT_TEST_HEAP_POOL_NUM_BLOCKS; x++) {
+        U_PORT_TEST_ASSERT((pBlock[x][0] == (char) x) && (pBlock[x][size - 1] == (char) x));
+        uPortFreeTagged(pBlock[x]);
+    }
+    U_PORT_TEST_ASSERT(uPortHeapTagGetStats(U_PORT_HEAP_TAG_APP, &stats) == 0);
+    U_PORT_TEST_ASSERT(stats.currentBytes == 0);
+    U_PORT_TEST_ASSERT(stats.currentAllocations == 0);
+    U_PORT_TEST_ASSERT(uPortHeapTagSetArena(U_PORT_HEAP_TAG_APP, NULL) == 0);
+
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+/** Test: the static heap, if it is in use.
+ */
+U_PORT_TEST_FUNCTION("[port]", "portHeapStatic")
+{
+    uPortHeapStaticStats_t stats;
+    size_t lastBlockSizeBytes = 0;
+    size_t x = 0;
+    int32_t y;
+
+    y = uPortHeapStaticGetStats(x, &stats);
+    if (y != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        U_PORT_TEST_ASSERT(uPortHeapStaticGetStats(x, NULL) < 0);
+        while (y == 0) {
+            U_TEST_PRINT_LINE("static heap pool %d: %d block(s) of %d byte(s),"
+                              " %d free, minimum %d free, %d failure(s).", (int32_t) x,
+                              (int32_t) stats.numBlocks, (int32_t) stats.blockSizeBytes,
+                              (int32_t) stats.numFree, (int32_t) stats.minFree,
+                              (int32_t) stats.numFailed);
+            U_PORT_TEST_ASSERT(stats.blockSizeBytes > lastBlockSizeBytes);
+            U_PORT_TEST_ASSERT(stats.numBlocks > 0);
+            U_PORT_TEST_ASSERT(stats.numFree <= stats.numBlocks);
+            U_PORT_TEST_ASSERT(stats.minFree <= stats.numFree);
+            lastBlockSizeBytes = stats.blockSizeBytes;
+            x++;
+            y = uPortHeapStaticGetStats(x, &stats);
+        }
+        U_PORT_TEST_ASSERT(x > 0);
+    } else {
+        U_TEST_PRINT_LINE("the static heap is not in use.");
+    }
+}
+
 /** Test: strtok_r since we have our own implementation on
  * some platforms.
  */
@@ -2118,6 +2845,8 @@ U_PORT_TEST_FUNCTION("[port]", "portStrtok_r")
 U_PORT_TEST_FUNCTION("[port]", "portMktime64")
 {
     int32_t heapUsed;
+    struct tm timeStruct;
+    int64_t t;
 
     // Whatever called us likely initialised the
     // port so deinitialise it here to obtain the
@@ -2134,6 +2863,22 @@ U_PORT_TEST_FUNCTION("[port]", "portMktime64")
                            gMktime64TestData[x].time);
     }
 
+    U_TEST_PRINT_LINE("testing gmtime64_r()...");
+
+    for (size_t x = 0; x < sizeof(gMktime64TestData) /
+         sizeof(gMktime64TestData[0]); x++) {
+        U_PORT_TEST_ASSERT(gmtime64_r(&gMktime64TestData[x].time, &timeStruct) == &timeStruct);
+        U_PORT_TEST_ASSERT(mktime64(&timeStruct) == gMktime64TestData[x].time);
+        U_PORT_TEST_ASSERT((timeStruct.tm_sec >= 0) && (timeStruct.tm_sec <= 59));
+        U_PORT_TEST_ASSERT((timeStruct.tm_mon >= 0) && (timeStruct.tm_mon <= 11));
+    }
+    // 1st January 2037, a Thursday
+    t = 2114380800LL;
+    U_PORT_TEST_ASSERT(gmtime64_r(&t, &timeStruct) == &timeStruct);
+    U_PORT_TEST_ASSERT((timeStruct.tm_year == 137) && (timeStruct.tm_mon == 0) &&
+                       (timeStruct.tm_mday == 1) && (timeStruct.tm_wday == 4) &&
+                       (timeStruct.tm_yday == 0));
+
     uPortDeinit();
 
     // Check for memory leaks
@@ -2316,6 +3061,9 @@ U_PORT_TEST_FUNCTION("[port]", "portUartRequiresSpecificWiring")
     }
 #endif
 
+    runUartPeekTest();
+    runUartWriteAsyncTest();
+
     uPortDeinit();
 
     // Check for memory leaks
@@ -2471,6 +3219,23 @@ U_PORT_TEST_FUNCTION("[port]", "portI2cRequiresSpecificWiring")
     U_TEST_PRINT_LINE("read of number of bytes waiting returned 0x[%02x][%02x] (%d).", buffer1[0],
                       buffer1[1], y);
     U_PORT_TEST_ASSERT(y == 10);
+    // Read the number of bytes waiting again, this time with an
+    // asynchronous receive, which should leave the register address
+    // in the same place
+    buffer1[0] = 0xFD;
+    U_PORT_TEST_ASSERT(uPortI2cControllerSend(gI2cHandle, U_PORT_TEST_I2C_ADDRESS, buffer1, 1,
+                                              true) == 0);
+    gI2cAsyncResult = INT32_MIN;
+    U_PORT_TEST_ASSERT(uPortI2cControllerSendReceiveAsync(gI2cHandle, U_PORT_TEST_I2C_ADDRESS,
+                                                          NULL, 0, buffer1, 2,
+                                                          i2cAsyncCallback,
+                                                          (void *) &gI2cAsyncResult) == 0);
+    for (size_t x = 0; (x < 100) && (gI2cAsyncResult == INT32_MIN); x++) {
+        uPortTaskBlock(10);
+    }
+    U_TEST_PRINT_LINE("asynchronous receive returned %d.", gI2cAsyncResult);
+    U_PORT_TEST_ASSERT(gI2cAsyncResult == 2);
+    U_PORT_TEST_ASSERT((int32_t) ((((uint32_t) buffer1[0]) << 8) + (uint32_t) buffer1[1]) == y);
     // With the register address auto-incremented to 0xFF we can now just read out the ack
     memset(buffer1, 0xFF, sizeof(buffer1));
     memset(buffer2, 0xFF, sizeof(buffer2));
@@ -2519,6 +3284,7 @@ U_PORT_TEST_FUNCTION("[port]", "portCrypto")
 {
     char buffer[64];
     char iv[U_PORT_CRYPTO_AES128_INITIALISATION_VECTOR_LENGTH_BYTES];
+    void *pContext = NULL;
     int32_t heapUsed;
     int32_t x;
 
@@ -2587,6 +3353,82 @@ U_PORT_TEST_FUNCTION("[port]", "portCrypto")
         U_TEST_PRINT_LINE("AES CBC 128 decryption not supported.");
     }
 
+    U_TEST_PRINT_LINE("testing SHA256 in pieces...");
+    memset(buffer, 0, sizeof(buffer));
+    x = uPortCryptoSha256Init(&pContext);
+    if (x != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        U_PORT_TEST_ASSERT(x == (int32_t) U_ERROR_COMMON_SUCCESS);
+        // Deliberately split at a non-block boundary
+        U_PORT_TEST_ASSERT(uPortCryptoSha256Update(pContext, gSha256Input, 7) == 0);
+        U_PORT_TEST_ASSERT(uPortCryptoSha256Update(pContext, gSha256Input + 7,
+                                                   sizeof(gSha256Input) - 1 - 7) == 0);
+        U_PORT_TEST_ASSERT(uPortCryptoSha256Final(pContext, buffer) == 0);
+        U_PORT_TEST_ASSERT(memcmp(buffer, gSha256Output,
+                                  U_PORT_CRYPTO_SHA256_OUTPUT_LENGTH_BYTES) == 0);
+        // Abandoning a calculation must also free the context
+        U_PORT_TEST_ASSERT(uPortCryptoSha256Init(&pContext) == 0);
+        U_PORT_TEST_ASSERT(uPortCryptoSha256Final(pContext, NULL) == 0);
+    } else {
+        U_TEST_PRINT_LINE("SHA256 in pieces not supported.");
+    }
+
+    U_TEST_PRINT_LINE("testing HMAC SHA256 in pieces...");
+    memset(buffer, 0, sizeof(buffer));
+    x = uPortCryptoHmacSha256Init(&pContext, gHmacSha256Key,
+                                  sizeof(gHmacSha256Key) - 1);
+    if (x != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        U_PORT_TEST_ASSERT(x == (int32_t) U_ERROR_COMMON_SUCCESS);
+        U_PORT_TEST_ASSERT(uPortCryptoHmacSha256Update(pContext, gHmacSha256Input, 3) == 0);
+        U_PORT_TEST_ASSERT(uPortCryptoHmacSha256Update(pContext, gHmacSha256Input + 3,
+                                                       sizeof(gHmacSha256Input) - 1 - 3) == 0);
+        U_PORT_TEST_ASSERT(uPortCryptoHmacSha256Final(pContext, buffer) == 0);
+        U_PORT_TEST_ASSERT(memcmp(buffer, gHmacSha256Output,
+                                  U_PORT_CRYPTO_SHA256_OUTPUT_LENGTH_BYTES) == 0);
+    } else {
+        U_TEST_PRINT_LINE("HMAC SHA256 in pieces not supported.");
+    }
+
+    U_TEST_PRINT_LINE("testing MD5 in pieces...");
+    memset(buffer, 0, sizeof(buffer));
+    x = uPortCryptoMd5Init(&pContext);
+    if (x != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        U_PORT_TEST_ASSERT(x == (int32_t) U_ERROR_COMMON_SUCCESS);
+        U_PORT_TEST_ASSERT(uPortCryptoMd5Update(pContext, gMd5Input, 5) == 0);
+        U_PORT_TEST_ASSERT(uPortCryptoMd5Update(pContext, gMd5Input + 5,
+                                                sizeof(gMd5Input) - 1 - 5) == 0);
+        U_PORT_TEST_ASSERT(uPortCryptoMd5Final(pContext, buffer) == 0);
+        U_PORT_TEST_ASSERT(memcmp(buffer, gMd5Output,
+                                  U_PORT_CRYPTO_MD5_OUTPUT_LENGTH_BYTES) == 0);
+    } else {
+        U_TEST_PRINT_LINE("MD5 not supported.");
+    }
+
+    U_TEST_PRINT_LINE("testing AES CBC 128 in pieces...");
+    memset(buffer, 0, sizeof(buffer));
+    x = uPortCryptoAes128CbcInit(&pContext, gAes128CbcKey,
+                                 sizeof(gAes128CbcKey) - 1,
+                                 gAes128CbcIV, true);
+    if (x != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        U_PORT_TEST_ASSERT(x == (int32_t) U_ERROR_COMMON_SUCCESS);
+        U_PORT_TEST_ASSERT(uPortCryptoAes128CbcUpdate(pContext, gAes128CbcClear,
+                                                      sizeof(gAes128CbcClear) - 1,
+                                                      buffer) == 0);
+        uPortCryptoAes128CbcFinal(pContext);
+        U_PORT_TEST_ASSERT(memcmp(buffer, gAes128CbcEncrypted,
+                                  sizeof(gAes128CbcEncrypted) - 1) == 0);
+        U_PORT_TEST_ASSERT(uPortCryptoAes128CbcInit(&pContext, gAes128CbcKey,
+                                                    sizeof(gAes128CbcKey) - 1,
+                                                    gAes128CbcIV, false) == 0);
+        U_PORT_TEST_ASSERT(uPortCryptoAes128CbcUpdate(pContext, gAes128CbcEncrypted,
+                                                      sizeof(gAes128CbcEncrypted) - 1,
+                                                      buffer) == 0);
+        uPortCryptoAes128CbcFinal(pContext);
+        U_PORT_TEST_ASSERT(memcmp(buffer, gAes128CbcClear,
+                                  sizeof(gAes128CbcClear) - 1) == 0);
+    } else {
+        U_TEST_PRINT_LINE("AES CBC 128 in pieces not supported.");
+    }
+
     uPortDeinit();
 
     // Check for memory leaks
@@ -2839,6 +3681,189 @@ U_PORT_TEST_FUNCTION("[port]", "portCriticalSection")
     U_PORT_TEST_ASSERT(heapUsed <= 0);
 }
 
+/** Test deferred logging.
+ */
+U_PORT_TEST_FUNCTION("[port]", "portLogDeferred")
+{
+    int32_t heapUsed;
+    int32_t x;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // Before deferred logging is started, prints go straight out
+    uPortLogDeferredF(U_TEST_PREFIX "not deferred: %d \"%s\" %c 0x%08x %%.\n",
+                      -1, "string", 'c', 0xdeadbeef);
+
+    // Start it without dropping: nothing should be lost
+    U_PORT_TEST_ASSERT(uPortLogDeferredStart(false) == 0);
+    for (x = 0; x < U_PORT_LOG_DEFERRED_QUEUE_LENGTH * 2; x++) {
+        uPortLogDeferredF(U_TEST_PREFIX "deferred %d: \"%.*s\" %5u|%-5d|.\n",
+                          x, 3, "string", (unsigned int) x, (int) x);
+    }
+    uPortLogDeferredStop();
+    U_PORT_TEST_ASSERT(uPortLogDeferredGetDropped() == 0);
+
+    // Start it with dropping and flood it
+    U_PORT_TEST_ASSERT(uPortLogDeferredStart(true) == 0);
+    for (x = 0; x < U_PORT_LOG_DEFERRED_QUEUE_LENGTH * 4; x++) {
+        uPortLogDeferredF(U_TEST_PREFIX "flood %d.\n", x);
+    }
+    uPortLogDeferredStop();
+    x = uPortLogDeferredGetDropped();
+    U_TEST_PRINT_LINE("%d deferred log print(s) dropped.", x);
+    U_PORT_TEST_ASSERT((x >= 0) && (x < U_PORT_LOG_DEFERRED_QUEUE_LENGTH * 4));
+
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+/** Test the cycle counter.
+ */
+U_PORT_TEST_FUNCTION("[port]", "portPerfCounter")
+{
+    uPortPerfCounter_t counter;
+    int32_t frequencyHz;
+    int64_t startTimeUs;
+    int64_t cpuTimeUs;
+    uint32_t cycles;
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    uPortPerfCounterReset(&counter);
+    U_PORT_TEST_ASSERT(uPortPerfCounterRead(&counter) == 0);
+    // Stopping a counter that isn't running does nothing
+    U_PORT_TEST_ASSERT(uPortPerfCounterStop(&counter) == 0);
+    U_PORT_TEST_ASSERT(counter.numIntervals == 0);
+
+    frequencyHz = uPortPerfCounterGetFrequencyHz();
+    U_TEST_PRINT_LINE("cycle counter frequency %d Hz.", frequencyHz);
+    if (frequencyHz > 0) {
+        // Spin for a while in two intervals, with a gap
+        // which should not be counted
+        for (size_t x = 0; x < 2; x++) {
+            uPortPerfCounterStart(&counter);
+            startTimeUs = uPortGetTickTimeUs();
+            while (uPortGetTickTimeUs() - startTimeUs < 10000) {}
+            cycles = uPortPerfCounterStop(&counter);
+            U_PORT_TEST_ASSERT(cycles > 0);
+            uPortTaskBlock(100);
+        }
+        U_PORT_TEST_ASSERT(counter.numIntervals == 2);
+        U_PORT_TEST_ASSERT(uPortPerfCounterRead(&counter) == counter.totalCycles);
+        cpuTimeUs = uPortPerfCounterCyclesToUs(uPortPerfCounterRead(&counter));
+        U_TEST_PRINT_LINE("%u cycles, %d us, counted over 20 ms of spinning.",
+                          (uint32_t) counter.totalCycles, (int32_t) cpuTimeUs);
+        U_PORT_TEST_ASSERT((cpuTimeUs > 10000) && (cpuTimeUs < 40000));
+    } else {
+        U_TEST_PRINT_LINE("no cycle counter on this platform.");
+        U_PORT_TEST_ASSERT(uPortPerfCounterCyclesToUs(1000) == 0);
+    }
+
+    uPortDeinit();
+}
+
+#if defined(U_CFG_MUTEX_DEBUG) && defined(U_CFG_MUTEX_DEBUG_PROFILE)
+/** Test the lock contention profile of mutex debug: create a
+ * mutex, lock it, have a task wait for it, fail to try-lock it
+ * while the task holds it, then wait for it in turn, and check
+ * that the profile for the creation point of the mutex records
+ * all of that.  The profile is not reset, since that would lose
+ * what has been gathered for the other tests, so the counts are
+ * checked as differences.
+ */
+U_PORT_TEST_FUNCTION("[port]", "portMutexProfile")
+{
+    uPortMutexHandle_t mutexHandle = NULL;
+    uPortTaskHandle_t taskHandle = NULL;
+    uMutexDebugProfile_t before;
+    uMutexDebugProfile_t after;
+    int32_t line;
+    int32_t heapUsed;
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    heapUsed = uPortGetHeapFree();
+
+    // The creation point identifies the mutex in the profile
+    line = __LINE__ + 1;
+    U_PORT_TEST_ASSERT(uPortMutexCreate(&mutexHandle) == 0);
+    U_PORT_TEST_ASSERT(uMutexDebugProfileGet(__FILE__, line, &before) == 0);
+    U_PORT_TEST_ASSERT(before.numMutexes > 0);
+    U_PORT_TEST_ASSERT(uMutexDebugProfileGet(__FILE__, line, NULL) < 0);
+    U_PORT_TEST_ASSERT(uMutexDebugProfileGet(__FILE__, -1, &after) ==
+                       (int32_t) U_ERROR_COMMON_NOT_FOUND);
+
+    // Uncontended
+    U_PORT_TEST_ASSERT(uPortMutexLock(mutexHandle) == 0);
+    // Contended by the task
+    gMutexProfileTaskLocked = false;
+    U_PORT_TEST_ASSERT(uPortTaskCreate(mutexProfileTestTask, "mutexProfileTestTask",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                       (void *) mutexHandle,
+                                       U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+    uPortTaskBlock(U_PORT_TEST_MUTEX_PROFILE_HOLD_MS);
+    U_PORT_TEST_ASSERT(uPortMutexUnlock(mutexHandle) == 0);
+    for (size_t x = 0; (x < 100) && !gMutexProfileTaskLocked; x++) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(gMutexProfileTaskLocked);
+    // A timeout while the task holds it
+    U_PORT_TEST_ASSERT(uPortMutexTryLock(mutexHandle, 10) != 0);
+    // Contended by us
+    U_PORT_TEST_ASSERT(uPortMutexTryLock(mutexHandle,
+                                         U_PORT_TEST_MUTEX_PROFILE_HOLD_MS * 10) == 0);
+    U_PORT_TEST_ASSERT(uPortMutexUnlock(mutexHandle) == 0);
+    // Let the task exit
+    uPortTaskBlock(U_CFG_OS_YIELD_MS + 100);
+
+    U_PORT_TEST_ASSERT(uMutexDebugProfileGet(__FILE__, line, &after) == 0);
+    U_TEST_PRINT_LINE("mutex profile: %d lock(s), %d contended, %d timeout(s),"
+                      " wait total %d us max %d us, hold total %d us max %d us.",
+                      after.numAcquisitions - before.numAcquisitions,
+                      after.numContended - before.numContended,
+                      after.numTimeouts - before.numTimeouts,
+                      (int32_t) (after.waitTotalUs - before.waitTotalUs),
+                      (int32_t) after.waitMaxUs,
+                      (int32_t) (after.holdTotalUs - before.holdTotalUs),
+                      (int32_t) after.holdMaxUs);
+    U_PORT_TEST_ASSERT(after.numMutexes == before.numMutexes);
+    U_PORT_TEST_ASSERT(after.numAcquisitions - before.numAcquisitions == 3);
+    U_PORT_TEST_ASSERT(after.numContended - before.numContended == 2);
+    U_PORT_TEST_ASSERT(after.numTimeouts - before.numTimeouts == 1);
+    // Each side waited for roughly the time that the other held it
+    U_PORT_TEST_ASSERT(after.waitTotalUs - before.waitTotalUs >=
+                       U_PORT_TEST_MUTEX_PROFILE_HOLD_MS * 1000);
+    U_PORT_TEST_ASSERT(after.waitMaxUs >= U_PORT_TEST_MUTEX_PROFILE_HOLD_MS * 1000 / 2);
+    U_PORT_TEST_ASSERT(after.holdTotalUs - before.holdTotalUs >=
+                       U_PORT_TEST_MUTEX_PROFILE_HOLD_MS * 1000 * 2);
+    U_PORT_TEST_ASSERT(after.holdMaxUs >= U_PORT_TEST_MUTEX_PROFILE_HOLD_MS * 1000 / 2);
+
+    // The profile outlives the mutex
+    uPortMutexDelete(mutexHandle);
+    U_PORT_TEST_ASSERT(uMutexDebugProfileGet(__FILE__, line, &after) == 0);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+
+    uPortDeinit();
+}
+#endif
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
@@ -15,7 +15,10 @@
  */
 
 /** @file
- * @brief Default implementation of pUPortMalloc() / uPortFree().
+ * @brief Default implementation of pUPortMalloc() / uPortFree(),
+ * either over malloc()/free() or, if U_CFG_HEAP_STATIC is defined,
+ * over a static array, plus the tagged versions and the fixed-block
+ * pool.
  */
 
 #ifdef U_CFG_OVERRIDE
@@ -26,29 +29,149 @@
  * INCLUDE FILES
  * -------------------------------------------------------------- */
 
+#include "stddef.h"      // NULL, size_t etc.
+#include "stdint.h"      // int32_t etc.
+#include "stdbool.h"
 #include "stdlib.h"      // malloc()/free().
+#include "string.h"      // memcpy()
+
 #include "u_compiler.h"
 
+#include "u_cfg_sw.h"
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_heap.h"
+
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+/** The total size of the static heap, used if U_CFG_HEAP_STATIC
+ * is defined.
+ */
+#define U_PORT_HEAP_STATIC_SIZE_BYTES ((32 * U_CFG_HEAP_STATIC_NUM_BLOCKS_32) +     \
+                                       (128 * U_CFG_HEAP_STATIC_NUM_BLOCKS_128) +   \
+                                       (512 * U_CFG_HEAP_STATIC_NUM_BLOCKS_512) +   \
+                                       (2048 * U_CFG_HEAP_STATIC_NUM_BLOCKS_2048) + \
+                                       (8192 * U_CFG_HEAP_STATIC_NUM_BLOCKS_8192))
+
+#if defined(U_CFG_HEAP_STATIC) && (U_PORT_HEAP_STATIC_SIZE_BYTES <= 0)
+# error U_CFG_HEAP_STATIC is defined but the U_CFG_HEAP_STATIC_NUM_BLOCKS_x values give no memory.
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The header placed in front of a tagged allocation, a union
+ * so that what follows it is aligned for the worst case.
+ */
+typedef union {
+    struct {
+        int32_t tag;
+        size_t sizeBytes;
+    } info;
+    long long alignLongLong;
+    double alignDouble;
+    void *pAlign;
+} uPortHeapTagHeader_t;
+
+/** A fixed-block pool of the static heap; the blocks of each pool
+ * are contiguous in gHeapStatic[].
+ */
+typedef struct {
+    size_t blockSizeBytes;
+    size_t numBlocks;
+    char *pStart;       /** NULL until the static heap is initialised. */
+    void *pFreeList;
+    size_t numFree;
+    size_t minFree;
+    size_t numFailed;
+} uPortHeapStaticPool_t;
+
+/** The state of a heap tag.
+ */
+typedef struct {
+    uPortHeapArena_t arena; /** pMalloc is NULL if there is no arena. */
+    uPortHeapTagStats_t stats;
+} uPortHeapTagState_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
 
+/** The state of each heap tag.
+ */
+static uPortHeapTagState_t gHeapTag[U_PORT_HEAP_TAG_MAX_NUM] = {0};
+
+#ifdef U_CFG_HEAP_STATIC
+
+/** The static heap, type long long so that it is aligned for the
+ * worst case.
+ */
+static long long gHeapStatic[U_PORT_HEAP_STATIC_SIZE_BYTES / sizeof(long long)];
+
+/** The pools of the static heap, smallest block size first.
+ */
+static uPortHeapStaticPool_t gHeapStaticPool[] = {
+    {32, U_CFG_HEAP_STATIC_NUM_BLOCKS_32, NULL, NULL, 0, 0, 0},
+    {128, U_CFG_HEAP_STATIC_NUM_BLOCKS_128, NULL, NULL, 0, 0, 0},
+    {512, U_CFG_HEAP_STATIC_NUM_BLOCKS_512, NULL, NULL, 0, 0, 0},
+    {2048, U_CFG_HEAP_STATIC_NUM_BLOCKS_2048, NULL, NULL, 0, 0, 0},
+    {8192, U_CFG_HEAP_STATIC_NUM_BLOCKS_8192, NULL, NULL, 0, 0, 0}
+};
+
+#endif
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Enter a critical section for the accounting; returns true
+// if uPortExitCritical() must be called to leave it.  Where
+// critical sections are not available the accounting is
+// not thread-safe but will likely only be wrong transiently.
+static bool criticalEnter()
+{
+    return (uPortEnterCritical() == 0);
+}
+
+#ifdef U_CFG_HEAP_STATIC
+
+// Set up the pools of the static heap.  Must be called from
+// within a critical section, if there is one.
+static void heapStaticInit()
+{
+    char *pStart = (char *) gHeapStatic;
+    uPortHeapStaticPool_t *pPool;
+    char *pBlock;
+
+    for (size_t x = 0; x < sizeof(gHeapStaticPool) / sizeof(gHeapStaticPool[0]); x++) {
+        pPool = &(gHeapStaticPool[x]);
+        pPool->pStart = pStart;
+        pPool->pFreeList = NULL;
+        // Link the blocks, last first, so that the first
+        // comes off the free list first
+        for (size_t y = pPool->numBlocks; y > 0; y--) {
+            pBlock = pStart + ((y - 1) * pPool->blockSizeBytes);
+            memcpy(pBlock, &(pPool->pFreeList), sizeof(pPool->pFreeList));
+            pPool->pFreeList = pBlock;
+        }
+        pPool->numFree = pPool->numBlocks;
+        pPool->minFree = pPool->numBlocks;
+        pStart += pPool->numBlocks * pPool->blockSizeBytes;
+    }
+}
+
+#endif
+
 /* ----------------------------------------------------------------
- * PUBLIC FUNCTIONS
+ * PUBLIC FUNCTIONS: HEAP
  * -------------------------------------------------------------- */
 
+#ifndef U_CFG_HEAP_STATIC
+
 U_WEAK void *pUPortMalloc(size_t sizeBytes)
 {
     return malloc(sizeBytes);
@@ -59,5 +182,294 @@ U_WEAK void uPortFree(void *pMemory)
     free(pMemory);
 }
 
+int32_t uPortHeapStaticGetStats(size_t index, uPortHeapStaticStats_t *pStats)
+{
+    (void) index;
+    (void) pStats;
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
+#else
+
+U_WEAK void *pUPortMalloc(size_t sizeBytes)
+{
+    void *pBlock = NULL;
+    uPortHeapStaticPool_t *pPool;
+    uPortHeapStaticPool_t *pFirstPool = NULL;
+    bool critical;
+
+    critical = criticalEnter();
+    if (gHeapStaticPool[0].pStart == NULL) {
+        heapStaticInit();
+    }
+    for (size_t x = 0; (pBlock == NULL) &&
+         (x < sizeof(gHeapStaticPool) / sizeof(gHeapStaticPool[0])); x++) {
+        pPool = &(gHeapStaticPool[x]);
+        if ((sizeBytes <= pPool->blockSizeBytes) && (pPool->numBlocks > 0)) {
+            if (pFirstPool == NULL) {
+                pFirstPool = pPool;
+            }
+            pBlock = pPool->pFreeList;
+            if (pBlock != NULL) {
+                memcpy(&(pPool->pFreeList), pBlock, sizeof(pPool->pFreeList));
+                pPool->numFree--;
+                if (pPool->numFree < pPool->minFree) {
+                    pPool->minFree = pPool->numFree;
+                }
+            }
+        }
+    }
+    if ((pBlock == NULL) && (pFirstPool != NULL)) {
+        pFirstPool->numFailed++;
+    }
+    if (critical) {
+        uPortExitCritical();
+    }
+
+    return pBlock;
+}
+
+U_WEAK void uPortFree(void *pMemory)
+{
+    uPortHeapStaticPool_t *pPool;
+    bool critical;
+
+    if (pMemory != NULL) {
+        critical = criticalEnter();
+        // Find the pool from the address
+        for (size_t x = sizeof(gHeapStaticPool) / sizeof(gHeapStaticPool[0]); x > 0; x--) {
+            pPool = &(gHeapStaticPool[x - 1]);
+            if ((pPool->numBlocks > 0) && ((char *) pMemory >= pPool->pStart)) {
+                memcpy(pMemory, &(pPool->pFreeList), sizeof(pPool->pFreeList));
+                pPool->pFreeList = pMemory;
+                pPool->numFree++;
+                break;
+            }
+        }
+        if (critical) {
+            uPortExitCritical();
+        }
+    }
+}
+
+int32_t uPortHeapStaticGetStats(size_t index, uPortHeapStaticStats_t *pStats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uPortHeapStaticPool_t *pPool;
+    bool critical;
+
+    if (pStats != NULL) {
+        critical = criticalEnter();
+        if (gHeapStaticPool[0].pStart == NULL) {
+            heapStaticInit();
+        }
+        // Count only the pools that have blocks
+        for (size_t x = 0; (errorCode < 0) &&
+             (x < sizeof(gHeapStaticPool) / sizeof(gHeapStaticPool[0])); x++) {
+            pPool = &(gHeapStaticPool[x]);
+            if (pPool->numBlocks > 0) {
+                if (index == 0) {
+                    pStats->blockSizeBytes = pPool->blockSizeBytes;
+                    pStats->numBlocks = pPool->numBlocks;
+                    pStats->numFree = pPool->numFree;
+                    pStats->minFree = pPool->minFree;
+                    pStats->numFailed = pPool->numFailed;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                }
+                index--;
+            }
+        }
+        if (critical) {
+            uPortExitCritical();
+        }
+    }
+
+    return errorCode;
+}
+
+#endif
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TAGGED HEAP
+ * -------------------------------------------------------------- */
+
+// Allocate memory for a tag.
+void *pUPortMallocTagged(uPortHeapTag_t tag, size_t sizeBytes)
+{
+    uPortHeapTagHeader_t *pHeader = NULL;
+    uPortHeapTagState_t *pTag;
+    bool critical;
+
+    if (((int32_t) tag >= 0) && (tag < U_PORT_HEAP_TAG_MAX_NUM) &&
+        (sizeBytes <= SIZE_MAX - sizeof(*pHeader))) {
+        pTag = &(gHeapTag[tag]);
+        if (pTag->arena.pMalloc != NULL) {
+            pHeader = (uPortHeapTagHeader_t *) pTag->arena.pMalloc(pTag->arena.pContext,
+                                                                  sizeof(*pHeader) + sizeBytes);
+        } else {
+            pHeader = (uPortHeapTagHeader_t *) pUPortMalloc(sizeof(*pHeader) + sizeBytes);
+        }
+        critical = criticalEnter();
+        if (pHeader != NULL) {
+            pHeader->info.tag = (int32_t) tag;
+            pHeader->info.sizeBytes = sizeBytes;
+            pTag->stats.currentBytes += sizeBytes;
+            if (pTag->stats.currentBytes > pTag->stats.peakBytes) {
+                pTag->stats.peakBytes = pTag->stats.currentBytes;
+            }
+            pTag->stats.currentAllocations++;
+            // Skip the header
+            pHeader++;
+        } else {
+            pTag->stats.failedAllocations++;
+        }
+        if (critical) {
+            uPortExitCritical();
+        }
+    }
+
+    return (void *) pHeader;
+}
+
+// Free memory that was allocated for a tag.
+void uPortFreeTagged(void *pMemory)
+{
+    uPortHeapTagHeader_t *pHeader;
+    uPortHeapTagState_t *pTag;
+    bool critical;
+
+    if (pMemory != NULL) {
+        pHeader = ((uPortHeapTagHeader_t *) pMemory) - 1;
+        pTag = &(gHeapTag[pHeader->info.tag]);
+        critical = criticalEnter();
+        pTag->stats.currentBytes -= pHeader->info.sizeBytes;
+        pTag->stats.currentAllocations--;
+        if (critical) {
+            uPortExitCritical();
+        }
+        if (pTag->arena.pMalloc != NULL) {
+            pTag->arena.pFree(pTag->arena.pContext, (void *) pHeader);
+        } else {
+            uPortFree((void *) pHeader);
+        }
+    }
+}
+
+// Set the arena for a tag.
+int32_t uPortHeapTagSetArena(uPortHeapTag_t tag,
+                             const uPortHeapArena_t *pArena)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortHeapTagState_t *pTag;
+
+    if (((int32_t) tag >= 0) && (tag < U_PORT_HEAP_TAG_MAX_NUM) &&
+        ((pArena == NULL) || ((pArena->pMalloc != NULL) && (pArena->pFree != NULL)))) {
+        pTag = &(gHeapTag[tag]);
+        errorCode = (int32_t) U_ERROR_COMMON_TEMPORARY_FAILURE;
+        if (pTag->stats.currentAllocations == 0) {
+            if (pArena != NULL) {
+                pTag->arena = *pArena;
+            } else {
+                memset(&(pTag->arena), 0, sizeof(pTag->arena));
+            }
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Get the accounting for a tag.
+int32_t uPortHeapTagGetStats(uPortHeapTag_t tag,
+                             uPortHeapTagStats_t *pStats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    bool critical;
+
+    if (((int32_t) tag >= 0) && (tag < U_PORT_HEAP_TAG_MAX_NUM) &&
+        (pStats != NULL)) {
+        critical = criticalEnter();
+        *pStats = gHeapTag[tag].stats;
+        if (critical) {
+            uPortExitCritical();
+        }
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Initialise a fixed-block pool.
+int32_t uPortHeapPoolInit(uPortHeapPool_t *pPool, void *pBuffer,
+                          size_t bufferSizeBytes, size_t blockSizeBytes)
+{
+    int32_t errorCodeOrNumBlocks = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    char *pBlock = (char *) pBuffer;
+    size_t numBlocks;
+
+    if ((pPool != NULL) && (pBuffer != NULL) && (blockSizeBytes > 0)) {
+        // Each free block holds a pointer to the next, and the
+        // blocks must all be aligned as for a tagged allocation
+        if (blockSizeBytes < sizeof(void *)) {
+            blockSizeBytes = sizeof(void *);
+        }
+        blockSizeBytes = ((blockSizeBytes + sizeof(uPortHeapTagHeader_t) - 1) /
+                          sizeof(uPortHeapTagHeader_t)) * sizeof(uPortHeapTagHeader_t);
+        numBlocks = bufferSizeBytes / blockSizeBytes;
+        pPool->pFreeList = NULL;
+        pPool->blockSizeBytes = blockSizeBytes;
+        pPool->numFree = numBlocks;
+        // Link the blocks together, starting from the last so
+        // that the first block comes off the free list first
+        for (size_t x = numBlocks; x > 0; x--) {
+            memcpy(pBlock + ((x - 1) * blockSizeBytes), &(pPool->pFreeList),
+                   sizeof(pPool->pFreeList));
+            pPool->pFreeList = pBlock + ((x - 1) * blockSizeBytes);
+        }
+        errorCodeOrNumBlocks = (int32_t) numBlocks;
+    }
+
+    return errorCodeOrNumBlocks;
+}
+
+// Allocate a block from a pool.
+void *pUPortHeapPoolMalloc(void *pContext, size_t sizeBytes)
+{
+    uPortHeapPool_t *pPool = (uPortHeapPool_t *) pContext;
+    void *pBlock = NULL;
+    bool critical;
+
+    if ((pPool != NULL) && (sizeBytes <= pPool->blockSizeBytes)) {
+        critical = criticalEnter();
+        pBlock = pPool->pFreeList;
+        if (pBlock != NULL) {
+            memcpy(&(pPool->pFreeList), pBlock, sizeof(pPool->pFreeList));
+            pPool->numFree--;
+        }
+        if (critical) {
+            uPortExitCritical();
+        }
+    }
+
+    return pBlock;
+}
+
+// Free a block to a pool.
+void uPortHeapPoolFree(void *pContext, void *pMemory)
+{
+    uPortHeapPool_t *pPool = (uPortHeapPool_t *) pContext;
+    bool critical;
+
+    if ((pPool != NULL) && (pMemory != NULL)) {
+        critical = criticalEnter();
+        memcpy(pMemory, &(pPool->pFreeList), sizeof(pPool->pFreeList));
+        pPool->pFreeList = pMemory;
+        pPool->numFree++;
+        if (critical) {
+            uPortExitCritical();
+        }
+    }
+}
+
 
 // End of file
@@ -88,6 +88,7 @@ u_add_module_dir(base ${UBXLIB_BASE}/common/error)
 u_add_module_dir(base ${UBXLIB_BASE}/common/assert)
 u_add_module_dir(base ${UBXLIB_BASE}/common/location)
 u_add_module_dir(base ${UBXLIB_BASE}/common/mqtt_client)
+u_add_module_dir(base ${UBXLIB_BASE}/common/http_client)
 u_add_module_dir(base ${UBXLIB_BASE}/common/security)
 u_add_module_dir(base ${UBXLIB_BASE}/common/sock)
 u_add_module_dir(base ${UBXLIB_BASE}/common/ubx_protocol)
@@ -99,6 +100,11 @@ u_add_module_dir(base ${UBXLIB_BASE}/port/platform/common/debug_utils)
 u_add_source_dir(base ${UBXLIB_BASE}/port/platform/common/event_queue)
 u_add_source_dir(base ${UBXLIB_BASE}/port/platform/common/mutex_debug)
 u_add_source_dir(base ${UBXLIB_BASE}/port/platform/common/log_ram)
+u_add_source_dir(base ${UBXLIB_BASE}/port/platform/common/task_registry)
+u_add_source_dir(base ${UBXLIB_BASE}/port/platform/common/log_deferred)
+u_add_source_dir(base ${UBXLIB_BASE}/port/platform/common/perf_counter)
+u_add_source_dir(base ${UBXLIB_BASE}/port/platform/common/uart_async)
+u_add_source_dir(base ${UBXLIB_BASE}/port/platform/common/i2c_async)
 
 # Additional include directories
 list(APPEND UBXLIB_INC
@@ -111,22 +117,32 @@ list(APPEND UBXLIB_PRIVATE_INC
   ${UBXLIB_BASE}/port/platform/common/event_queue
   ${UBXLIB_BASE}/port/platform/common/mutex_debug
   ${UBXLIB_BASE}/port/platform/common/log_ram
+  ${UBXLIB_BASE}/port/platform/common/task_registry
+  ${UBXLIB_BASE}/port/platform/common/uart_async
+  ${UBXLIB_BASE}/port/platform/common/i2c_async
 )
 
 # Device and network require special care since they contains stub & optional files
 list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/common/network/src/u_network.c)
 list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/common/network/src/u_network_shared.c)
+list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/common/network/src/u_network_select.c)
 list(APPEND UBXLIB_INC ${UBXLIB_BASE}/common/network/api)
 list(APPEND UBXLIB_PRIVATE_INC ${UBXLIB_BASE}/common/network/src)
 list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/common/device/src/u_device.c)
 list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/common/device/src/u_device_shared.c)
 list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/common/device/src/u_device_private.c)
+list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/common/device/src/u_device_metrics.c)
+list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/common/device/src/u_device_time.c)
+list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/common/device/src/u_device_forward.c)
 list(APPEND UBXLIB_INC ${UBXLIB_BASE}/common/device/api)
 list(APPEND UBXLIB_PRIVATE_INC ${UBXLIB_BASE}/common/device/src)
 
 # Default malloc()/free() implementation
 list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/port/u_port_heap.c)
 
+# Default (no hardware) CRC implementation
+list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/port/u_port_crc.c)
+
 # Optional features
 
 # short range
@@ -161,6 +177,7 @@ list(APPEND UBXLIB_TEST_INC
 u_add_test_source_dir(base ${UBXLIB_BASE}/port/platform/common/test)
 u_add_test_source_dir(base ${UBXLIB_BASE}/port/test)
 u_add_test_source_dir(base ${UBXLIB_BASE}/common/network/test)
+u_add_test_source_dir(base ${UBXLIB_BASE}/common/device/test)
 # Examples are compiled as tests
 u_add_test_source_dir(base ${UBXLIB_BASE}/example/sockets)
 u_add_test_source_dir(base ${UBXLIB_BASE}/example/security/e2e)
@@ -12,6 +12,7 @@ UBXLIB_MODULE_DIRS = \
 	${UBXLIB_BASE}/common/assert \
 	${UBXLIB_BASE}/common/location \
 	${UBXLIB_BASE}/common/mqtt_client \
+	${UBXLIB_BASE}/common/http_client \
 	${UBXLIB_BASE}/common/security \
 	${UBXLIB_BASE}/common/sock \
 	${UBXLIB_BASE}/common/ubx_protocol \
@@ -23,7 +24,12 @@ UBXLIB_MODULE_DIRS = \
 UBXLIB_SRC_DIRS += \
 	${UBXLIB_BASE}/port/platform/common/event_queue \
 	${UBXLIB_BASE}/port/platform/common/mutex_debug \
-	${UBXLIB_BASE}/port/platform/common/log_ram
+	${UBXLIB_BASE}/port/platform/common/log_ram \
+	${UBXLIB_BASE}/port/platform/common/task_registry \
+	${UBXLIB_BASE}/port/platform/common/log_deferred \
+	${UBXLIB_BASE}/port/platform/common/perf_counter \
+	${UBXLIB_BASE}/port/platform/common/uart_async \
+	${UBXLIB_BASE}/port/platform/common/i2c_async
 
 
 # Additional include directories
@@ -36,22 +42,32 @@ UBXLIB_PRIVATE_INC += \
 	${UBXLIB_BASE}/port/platform/common/event_queue \
 	${UBXLIB_BASE}/port/platform/common/mutex_debug \
 	${UBXLIB_BASE}/port/platform/common/debug_utils/src/freertos/additions \
-	${UBXLIB_BASE}/port/platform/common/log_ram
+	${UBXLIB_BASE}/port/platform/common/log_ram \
+	${UBXLIB_BASE}/port/platform/common/task_registry \
+	${UBXLIB_BASE}/port/platform/common/uart_async \
+	${UBXLIB_BASE}/port/platform/common/i2c_async
 
 # Device and network require special care since they contain stub & optional files
 UBXLIB_SRC += ${UBXLIB_BASE}/common/network/src/u_network.c
 UBXLIB_SRC += ${UBXLIB_BASE}/common/network/src/u_network_shared.c
+UBXLIB_SRC += ${UBXLIB_BASE}/common/network/src/u_network_select.c
 UBXLIB_INC += ${UBXLIB_BASE}/common/network/api
 UBXLIB_PRIVATE_INC += ${UBXLIB_BASE}/common/network/src
 UBXLIB_SRC += ${UBXLIB_BASE}/common/device/src/u_device.c
 UBXLIB_SRC += ${UBXLIB_BASE}/common/device/src/u_device_shared.c
 UBXLIB_SRC += ${UBXLIB_BASE}/common/device/src/u_device_private.c
+UBXLIB_SRC += ${UBXLIB_BASE}/common/device/src/u_device_metrics.c
+UBXLIB_SRC += ${UBXLIB_BASE}/common/device/src/u_device_time.c
+UBXLIB_SRC += ${UBXLIB_BASE}/common/device/src/u_device_forward.c
 UBXLIB_INC += ${UBXLIB_BASE}/common/device/api
 UBXLIB_PRIVATE_INC += ${UBXLIB_BASE}/common/device/src
 
 # Default malloc()/free() implementation
 UBXLIB_SRC += ${UBXLIB_BASE}/port/u_port_heap.c
 
+# Default (no hardware) CRC implementation
+UBXLIB_SRC += ${UBXLIB_BASE}/port/u_port_crc.c
+
 # Optional short range related files and directories
 ifneq ($(filter short_range,$(UBXLIB_FEATURES)),)
 UBXLIB_MODULE_DIRS += \
@@ -94,7 +110,8 @@ UBXLIB_TEST_DIRS += \
 	${UBXLIB_BASE}/port/platform/common/runner \
 	${UBXLIB_BASE}/port/platform/common/test \
 	${UBXLIB_BASE}/port/test \
-	${UBXLIB_BASE}/common/network/test
+	${UBXLIB_BASE}/common/network/test \
+	${UBXLIB_BASE}/common/device/test
 # Examples are compiled as tests
 UBXLIB_TEST_DIRS += \
 	${UBXLIB_BASE}/example/sockets \
@@ -60,6 +60,8 @@
 #include <u_port_os.h>
 #include <u_port_uart.h>
 #include <u_port_i2c.h>
+#include <u_port_log_deferred.h>
+#include <u_port_perf_counter.h>
 
 // Module types: used in common APIs hence must come first
 #include <u_ble_module_type.h>
@@ -74,6 +76,7 @@
 #include <u_network_config_cell.h>
 #include <u_network_config_gnss.h>
 #include <u_network_config_wifi.h>
+#include <u_network_select.h>
 #include <u_base64.h>
 #include <u_hex_bin_convert.h>
 #include <u_mempool.h>
@@ -89,6 +92,7 @@
 #include <u_sock_security.h>
 #include <u_mqtt_common.h>
 #include <u_mqtt_client.h>
+#include <u_http_client.h>
 #include <u_location.h>
 #include <u_ubx_protocol.h>
 #include <u_spartn.h>
@@ -116,6 +120,7 @@
 #include <u_cell_sec_tls.h>
 #include <u_cell_sock.h>
 #include <u_cell_fota.h>
+#include <u_cell_mux.h>
 #include <u_gnss_type.h>
 #include <u_gnss.h>
 #include <u_gnss_cfg_val_key.h>
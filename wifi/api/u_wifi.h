@@ -41,6 +41,10 @@ extern "C" {
 
 #define U_WIFI_BSSID_SIZE 6        /**< binary BSSID size. */
 #define U_WIFI_SSID_SIZE (32 + 1)  /**< null-terminated SSID string size. */
+#define U_WIFI_BSSID_STR_SIZE ((U_WIFI_BSSID_SIZE * 2) + 1) /**< null-terminated
+                                                                  hex BSSID string size. */
+#define U_WIFI_IPV4_ADDRESS_STR_SIZE (15 + 1) /**< null-terminated IPv4 address
+                                                   string size. */
 
 /** Wifi connection status codes used by #uWifiConnectionStatusCallback_t */
 #define U_WIFI_CON_STATUS_DISCONNECTED 0
@@ -70,6 +74,20 @@ extern "C" {
 #define U_WIFI_AUTH_MASK_WPA2          (1 << 4)
 #define U_WIFI_AUTH_MASK_WPA3          (1 << 5)
 
+#ifndef U_WIFI_SCAN_CACHE_MAX_NUM_RESULTS
+/** The maximum number of results kept from the last scan, see
+ * uWifiStationScanCacheGet(); if a scan finds more APs than this
+ * the ones with the weakest signal are not kept.
+ */
+# define U_WIFI_SCAN_CACHE_MAX_NUM_RESULTS 16
+#endif
+
+/** The defaults for a scan filter, see #uWifiScanFilter_t: whenever
+ * an instance of uWifiScanFilter_t is created it should be assigned
+ * to this to ensure the correct default settings, i.e. no filtering.
+ */
+#define U_WIFI_SCAN_FILTER_DEFAULT {NULL, 0, 0, NULL, 0}
+
 /** #uWifiScanResult_t values for .uniCipherBitmask and .grpCipherBitmask */
 #define U_WIFI_CIPHER_MASK_WEP64       (1 << 0)
 #define U_WIFI_CIPHER_MASK_WEP128      (1 << 1)
@@ -115,6 +133,48 @@ typedef struct {
 } uWifiScanResult_t;
 
 
+/** A filter for scan results, see uWifiStationScanFilter() and
+ * uWifiStationScanCacheGet(); a result must pass all of the
+ * conditions that are set.
+ * NOTE: if this structure is modified be sure to modify
+ * #U_WIFI_SCAN_FILTER_DEFAULT to match.
+ */
+typedef struct {
+    const char *const *ppSsid; /**< an array of numSsids null-terminated
+                                    SSIDs, one of which a result must
+                                    match; NULL for any SSID. */
+    size_t numSsids;           /**< the number of entries at ppSsid. */
+    int32_t rssiMinDbm;        /**< the minimum RSSI of a result, e.g.
+                                    -80; zero for any RSSI. */
+    const int32_t *pChannels;  /**< an array of numChannels Wi-Fi channels,
+                                    one of which a result must be on;
+                                    NULL for any channel. */
+    size_t numChannels;        /**< the number of entries at pChannels. */
+} uWifiScanFilter_t;
+
+/** The parameters of a station connection, as returned by
+ * uWifiStationFastConnectGet(), which may be passed to
+ * uWifiStationConnectFast() to connect again more quickly; the
+ * structure contains no pointers and so may be stored, e.g. in
+ * non-volatile memory, across a restart.
+ */
+typedef struct {
+    char bssid[U_WIFI_BSSID_STR_SIZE];     /**< the BSSID of the AP, as a
+                                                null-terminated hex string. */
+    int32_t channel;                       /**< the Wi-Fi channel of the AP. */
+    char ipV4Address[U_WIFI_IPV4_ADDRESS_STR_SIZE]; /**< the IPv4 address that
+                                                         was obtained, an empty
+                                                         string if there was
+                                                         none, in which case
+                                                         DHCP is used. */
+    char subnetMask[U_WIFI_IPV4_ADDRESS_STR_SIZE];  /**< the subnet mask. */
+    char gateway[U_WIFI_IPV4_ADDRESS_STR_SIZE];     /**< the default gateway. */
+    char dns1[U_WIFI_IPV4_ADDRESS_STR_SIZE];        /**< the primary DNS server,
+                                                         may be empty. */
+    char dns2[U_WIFI_IPV4_ADDRESS_STR_SIZE];        /**< the secondary DNS server,
+                                                         may be empty. */
+} uWifiStationFastConnect_t;
+
 /** Scan result callback type.
  *
  * This callback will be called once for each entry found.
@@ -190,6 +250,53 @@ void uWifiDeinit();
 int32_t uWifiStationConnect(uDeviceHandle_t devHandle, const char *pSsid,
                             uWifiAuth_t authentication, const char *pPassPhrase);
 
+/** Connect to a Wifi access point re-using the parameters of a
+ * previous connection, as obtained with uWifiStationFastConnectGet():
+ * the IPv4 address, subnet mask, gateway and DNS servers of that
+ * connection are configured statically, so that the connection
+ * does not have to wait for DHCP, which accounts for most of the
+ * time taken to connect.  This is intended for a device that
+ * reconnects often to the same network; the lease must still be
+ * valid, i.e. the network must not since have given the address to
+ * another device.  If the connection fails, or the network turns out
+ * not to accept the address, call uWifiStationConnect(), which
+ * configures DHCP again, and then uWifiStationFastConnectGet() to
+ * obtain new parameters.  The BSSID and channel are for reference
+ * only: the module chooses the AP for the SSID itself, permitting
+ * roaming between APs.
+ *
+ * @param devHandle         the handle of the wifi instance.
+ * @param[in] pSsid         the Service Set Identifier.
+ * @param authentication    the authentication type.
+ * @param[in] pPassPhrase   the passphrase (8-63 ASCII characters as a
+ *                          string) for WPA/WPA2/WPA3.
+ * @param[in] pFastConnect  the parameters of a previous connection to
+ *                          the same SSID; if NULL, or if the
+ *                          ipV4Address field is an empty string,
+ *                          this function behaves as
+ *                          uWifiStationConnect().
+ * @return                  zero on successful, else negative error code.
+ *                          Note: there is no actual connection until the
+ *                          Wifi callback reports connected.
+ */
+int32_t uWifiStationConnectFast(uDeviceHandle_t devHandle, const char *pSsid,
+                                uWifiAuth_t authentication, const char *pPassPhrase,
+                                const uWifiStationFastConnect_t *pFastConnect);
+
+/** Get the parameters of the current station connection, for use
+ * with uWifiStationConnectFast() the next time.  Should be called
+ * once the network status callback has reported that IPv4 is up.
+ *
+ * @param devHandle          the handle of the wifi instance.
+ * @param[out] pFastConnect  a place to put the parameters; cannot be
+ *                           NULL.
+ * @return                   zero on successful, else negative error
+ *                           code; #U_WIFI_ERROR_NOT_FOUND if there is
+ *                           no station connection with an IPv4 address.
+ */
+int32_t uWifiStationFastConnectGet(uDeviceHandle_t devHandle,
+                                   uWifiStationFastConnect_t *pFastConnect);
+
 /** Disconnect from Wifi access point
  *
  * @param devHandle the handle of the wifi instance.
@@ -227,6 +334,8 @@ int32_t uWifiSetNetworkStatusCallback(uDeviceHandle_t devHandle,
  *
  * Please note that this function will block until the scan process is completed.
  * During this time pCallback will be called for each scan result entry found.
+ * The results also replace the contents of the scan cache, see
+ * uWifiStationScanFilter().
  *
  * @param devHandle     the handle of the wifi instance.
  * @param[in] pSsid     optional SSID to search for. Set to NULL to search for any SSID.
@@ -239,6 +348,56 @@ int32_t uWifiSetNetworkStatusCallback(uDeviceHandle_t devHandle,
 int32_t uWifiStationScan(uDeviceHandle_t devHandle, const char *pSsid,
                          uWifiScanResultCallback_t pCallback);
 
+/** As uWifiStationScan() but with a filter.  pCallback is called as
+ * each result arrives from the module, for those results that pass
+ * the filter.  All of the results of the scan, filtered or not, up
+ * to #U_WIFI_SCAN_CACHE_MAX_NUM_RESULTS of them, replace the contents
+ * of the scan cache when the scan completes successfully, so that
+ * uWifiStationScanCacheGet() can re-use them without another scan.
+ * Note that where the filter contains exactly one SSID the module
+ * is asked to scan only for that SSID, hence only that SSID will
+ * be in the cache.
+ *
+ * @param devHandle     the handle of the wifi instance.
+ * @param[in] pFilter   the filter to apply to the results, NULL
+ *                      for none.
+ * @param[in] pCallback callback for handling a scan result entry,
+ *                      may be NULL if only the cache is of interest.
+ *                      IMPORTANT: the callback will be called while
+ *                      the AT lock is held hence you are not allowed
+ *                      to call other u-blox module APIs directly from
+ *                      this callback.
+ * @return              zero on successful, else negative error code.
+ */
+int32_t uWifiStationScanFilter(uDeviceHandle_t devHandle,
+                               const uWifiScanFilter_t *pFilter,
+                               uWifiScanResultCallback_t pCallback);
+
+/** Get results from the cache of the last successful scan, strongest
+ * signal first, e.g. to find the strongest known SSID without
+ * scanning again.
+ *
+ * @param devHandle        the handle of the wifi instance.
+ * @param[in] pFilter      the filter to apply to the cached results,
+ *                         NULL for none.
+ * @param[out] pResults    a place to put the results, may be NULL
+ *                         if maxNumResults is zero, e.g. to find
+ *                         out the age of the cache.
+ * @param maxNumResults    the number of entries at pResults.
+ * @param[out] pAgeMs      a place to put the age of the cache in
+ *                         milliseconds, i.e. the time since the scan
+ *                         was completed; may be NULL.
+ * @return                 the number of results written to pResults,
+ *                         else negative error code;
+ *                         #U_WIFI_ERROR_NOT_FOUND if there has been no
+ *                         successful scan.
+ */
+int32_t uWifiStationScanCacheGet(uDeviceHandle_t devHandle,
+                                 const uWifiScanFilter_t *pFilter,
+                                 uWifiScanResult_t *pResults,
+                                 size_t maxNumResults,
+                                 int32_t *pAgeMs);
+
 #ifdef __cplusplus
 }
 #endif
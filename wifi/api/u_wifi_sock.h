@@ -93,12 +93,52 @@ extern "C" {
 #define U_WIFI_SOCK_WRITE_TIMEOUT_MS 500
 #endif
 
+#ifndef U_WIFI_SOCK_TCP_COALESCE_MS
+/** If greater than zero, writes of less than
+ * #U_WIFI_SOCK_MAX_SEGMENT_SIZE_BYTES to a TCP socket that has the
+ * option U_SOCK_OPT_TCP_NODELAY at its default of zero are gathered
+ * into a buffer of #U_WIFI_SOCK_MAX_SEGMENT_SIZE_BYTES, allocated
+ * while there is data in it, and sent to the module as one EDM data
+ * frame when the buffer is full, after at most this many
+ * milliseconds, before a write that doesn't fit or when the socket
+ * is closed.  This reduces EDM and TCP overhead where an application
+ * writes many small messages, at the cost of latency; data accepted
+ * into the buffer is counted as sent even though it has not yet
+ * reached the module.  Zero, the default, switches coalescing off.
+ */
+# define U_WIFI_SOCK_TCP_COALESCE_MS 0
+#endif
+
+#ifndef U_WIFI_SOCK_UDP_QUEUE_DEPTH
+/** The maximum number of received datagrams that are queued on a
+ * UDP socket waiting to be read; a datagram that arrives when the
+ * queue is full is dropped and counted, see
+ * uWifiSockUdpQueueStatsGet().  Datagrams are queued in the buffers
+ * they were received into, which come from a pool shared by all
+ * sockets, so a deep queue on one socket may starve another.
+ */
+# define U_WIFI_SOCK_UDP_QUEUE_DEPTH 8
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
 typedef void (*uWifiSockCallback_t)(uDeviceHandle_t devHandle, int32_t sockHandle);
 
+/** Statistics for the receive queue of a UDP socket, see
+ * uWifiSockUdpQueueStatsGet().
+ */
+typedef struct {
+    size_t numDatagramsQueued;    /**< the number of datagrams currently
+                                       waiting to be read. */
+    uint32_t numDatagramsDropped; /**< the number of datagrams that were
+                                       dropped because the queue was
+                                       full. */
+    uint32_t numBytesDropped;     /**< the number of bytes in the
+                                       dropped datagrams. */
+} uWifiSockUdpQueueStats_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: INIT/DEINIT
  * -------------------------------------------------------------- */
@@ -329,6 +369,26 @@ int32_t uWifiSockSendTo(uDeviceHandle_t devHandle,
                         const void *pData,
                         size_t dataSizeBytes);
 
+/** Send a datagram gathered from several pieces of data to IP
+ * address, as a single EDM data frame; the limit on the total
+ * length is as for uWifiSockSendTo().
+ *
+ * @param devHandle          the handle of the wifi instance.
+ * @param sockHandle         the handle of the socket.
+ * @param[in] pRemoteAddress the address of the server to
+ *                           send the datagram to, plus port
+ *                           number.  Cannot be NULL.
+ * @param[in] pIoVec         an array of ioVecCount pieces of data.
+ * @param ioVecCount         the number of entries at pIoVec.
+ * @return                   the number of bytes sent on
+ *                           success else negated value
+ *                           of U_SOCK_Exxx from u_sock_errno.h.
+ */
+int32_t uWifiSockSendToV(uDeviceHandle_t devHandle,
+                         int32_t sockHandle,
+                         const uSockAddress_t *pRemoteAddress,
+                         const uSockIoVec_t *pIoVec, size_t ioVecCount);
+
 /** Receive a datagram from IP address.
  *
  *  NOTE: Short range modules have very limited UDP support and can
@@ -360,11 +420,75 @@ int32_t uWifiSockReceiveFrom(uDeviceHandle_t devHandle,
                              uSockAddress_t *pRemoteAddress,
                              void *pData, size_t dataSizeBytes);
 
+/** Receive a datagram from IP address without copying it: instead
+ * of copying the datagram into a buffer of yours, as
+ * uWifiSockReceiveFrom() does, this lends you the buffers that it
+ * was received into, as an array of spans.  The spans remain valid
+ * until uWifiSockReceiveFromNoCopyRelease() is called, the next
+ * call to this function for the socket or until the socket is closed,
+ * whichever comes first; only one datagram may be lent per socket
+ * at a time and, while it is lent, it occupies buffers that are
+ * shared with all other sockets, so please release it promptly.
+ *
+ * The same restrictions on the remote address apply as for
+ * uWifiSockReceiveFrom().
+ *
+ * @param devHandle           the handle of the wifi instance.
+ * @param sockHandle          the handle of the socket.
+ * @param[out] pRemoteAddress a place to put the address of the remote
+ *                            host from which the datagram was received;
+ *                            may be NULL.
+ * @param[out] pIoVec         an array in which to put the spans of
+ *                            the datagram; cannot be NULL.
+ * @param[in,out] pIoVecCount on entry the number of elements at
+ *                            pIoVec, on return the number of them that
+ *                            were populated; cannot be NULL.  A
+ *                            datagram is usually in a single span.  If
+ *                            there are not enough elements then
+ *                            -#U_SOCK_EMSGSIZE is returned, the
+ *                            datagram is left in the queue and this is
+ *                            set to the number required.
+ * @return                    the number of bytes in the datagram else
+ *                            negated value of U_SOCK_Exxx from
+ *                            u_sock_errno.h.
+ */
+int32_t uWifiSockReceiveFromNoCopy(uDeviceHandle_t devHandle,
+                                   int32_t sockHandle,
+                                   uSockAddress_t *pRemoteAddress,
+                                   uSockIoVec_t *pIoVec,
+                                   size_t *pIoVecCount);
+
+/** Release the datagram lent by uWifiSockReceiveFromNoCopy(),
+ * returning its buffers to the pool; does nothing if no datagram
+ * is lent.
+ *
+ * @param devHandle   the handle of the wifi instance.
+ * @param sockHandle  the handle of the socket.
+ * @return            zero on success else negated value of
+ *                    U_SOCK_Exxx from u_sock_errno.h.
+ */
+int32_t uWifiSockReceiveFromNoCopyRelease(uDeviceHandle_t devHandle,
+                                          int32_t sockHandle);
+
+/** Get the statistics of the receive queue of a UDP socket; the
+ * drop counts accumulate for as long as the socket is open.
+ *
+ * @param devHandle   the handle of the wifi instance.
+ * @param sockHandle  the handle of the socket.
+ * @param[out] pStats a place to put the statistics; cannot be NULL.
+ * @return            zero on success else negated value of
+ *                    U_SOCK_Exxx from u_sock_errno.h.
+ */
+int32_t uWifiSockUdpQueueStatsGet(uDeviceHandle_t devHandle,
+                                  int32_t sockHandle,
+                                  uWifiSockUdpQueueStats_t *pStats);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: STREAM (TCP)
  * -------------------------------------------------------------- */
 
-/** Send bytes over a connected socket.
+/** Send bytes over a connected socket; see also
+ * #U_WIFI_SOCK_TCP_COALESCE_MS.
  *
  * @param devHandle     the handle of the wifi instance.
  * @param sockHandle    the handle of the socket.
@@ -380,6 +504,21 @@ int32_t uWifiSockWrite(uDeviceHandle_t devHandle,
                        int32_t sockHandle,
                        const void *pData, size_t dataSizeBytes);
 
+/** Send bytes gathered from several pieces of data over a
+ * connected socket, as a single EDM data frame.
+ *
+ * @param devHandle     the handle of the wifi instance.
+ * @param sockHandle    the handle of the socket.
+ * @param[in] pIoVec    an array of ioVecCount pieces of data.
+ * @param ioVecCount    the number of entries at pIoVec.
+ * @return              the number of bytes sent on
+ *                      success else negated value
+ *                      of U_SOCK_Exxx from u_sock_errno.h.
+ */
+int32_t uWifiSockWritev(uDeviceHandle_t devHandle,
+                        int32_t sockHandle,
+                        const uSockIoVec_t *pIoVec, size_t ioVecCount);
+
 /** Receive bytes on a connected socket.
  *
  * @param devHandle     the handle of the wifi instance.
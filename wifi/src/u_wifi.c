@@ -36,6 +36,7 @@
 
 #include "u_error_common.h"
 
+#include "u_port.h"
 #include "u_port_heap.h"
 #include "u_port_os.h"
 #include "u_port_debug.h"
@@ -92,6 +93,15 @@ typedef struct {
     int32_t interfaceId;
 } uWifiworkEvent_t;
 
+/** The results of the last scan, pointed to by pWifiScanCache in
+ * the short range instance.
+ */
+typedef struct {
+    int32_t timeMs; /**< the tick time at the end of the scan. */
+    size_t numResults;
+    uWifiScanResult_t results[U_WIFI_SCAN_CACHE_MAX_NUM_RESULTS]; /**< strongest first. */
+} uWifiScanCache_t;
+
 //lint -esym(749, uWifiStaCfgAction_t::STA_ACTION_RESET) Suppress not referenced
 //lint -esym(749, uWifiStaCfgAction_t::STA_ACTION_LOAD) Suppress not referenced
 //lint -esym(749, uWifiStaCfgAction_t::STA_ACTION_STORE) Suppress not referenced
@@ -262,6 +272,161 @@ static int32_t readIfaceStatusString(uAtClientHandle_t atHandle,
     return retValue;
 }
 
+/** Helper function for configuring the IPv4 settings of the Wifi
+ * station, static if pFastConnect holds an IPv4 address, else DHCP */
+static int32_t writeWifiStaCfgIpV4(uAtClientHandle_t atHandle,
+                                   const uWifiStationFastConnect_t *pFastConnect)
+{
+    int32_t errorCode;
+
+    if ((pFastConnect != NULL) && (pFastConnect->ipV4Address[0] != '\0')) {
+        // Set IP mode to static IP
+        errorCode = writeWifiStaCfgInt(atHandle, 0, 100, 1);
+        if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+            errorCode = writeWifiStaCfgStr(atHandle, 0, 101, pFastConnect->ipV4Address);
+        }
+        if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+            errorCode = writeWifiStaCfgStr(atHandle, 0, 102, pFastConnect->subnetMask);
+        }
+        if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+            errorCode = writeWifiStaCfgStr(atHandle, 0, 103, pFastConnect->gateway);
+        }
+        if ((errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) &&
+            (pFastConnect->dns1[0] != '\0')) {
+            errorCode = writeWifiStaCfgStr(atHandle, 0, 104, pFastConnect->dns1);
+        }
+        if ((errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) &&
+            (pFastConnect->dns2[0] != '\0')) {
+            errorCode = writeWifiStaCfgStr(atHandle, 0, 105, pFastConnect->dns2);
+        }
+    } else {
+        // Set IP mode to DHCP
+        errorCode = writeWifiStaCfgInt(atHandle, 0, 100, 2);
+    }
+
+    return errorCode;
+}
+
+/** Connect as a Wifi station, see uWifiStationConnectFast() */
+static int32_t stationConnect(uDeviceHandle_t devHandle, const char *pSsid,
+                              uWifiAuth_t authentication,
+                              const char *pPassPhrase,
+                              const uWifiStationFastConnect_t *pFastConnect)
+{
+    int32_t errorCode;
+    uShortRangePrivateInstance_t *pInstance;
+
+    errorCode = uShortRangeLock();
+    if (errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) {
+        return errorCode;
+    }
+
+    errorCode = getInstance(devHandle, &pInstance);
+    if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+        uAtClientHandle_t atHandle = pInstance->atHandle;
+
+        // Read connection status
+        int32_t conStatus = readWifiStaStatusInt(atHandle, 3);
+        if (conStatus == 2) {
+            // Wifi already connected. Check if the SSID is the same
+            char ssid[32 + 1];
+            errorCode = (int32_t) U_WIFI_ERROR_ALREADY_CONNECTED;
+            int32_t tmp = readWifiStaStatusString(atHandle, 0, ssid, sizeof(ssid));
+            if (tmp >= 0) {
+                if (strcmp(ssid, pSsid) == 0) {
+                    errorCode = (int32_t) U_WIFI_ERROR_ALREADY_CONNECTED_TO_SSID;
+                }
+            }
+        }
+
+        // Configure Wifi
+        if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+            // Set Wifi STA inactive on start up
+            uPortLog(LOG_TAG "Activating wifi STA mode\n");
+            errorCode = writeWifiStaCfgInt(atHandle, 0, 0, 0);
+        }
+        if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+            // Set SSID
+            errorCode = writeWifiStaCfgStr(atHandle, 0, 2, pSsid);
+        }
+        if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+            // Set authentication
+            errorCode = writeWifiStaCfgInt(atHandle, 0, 5, (int32_t)authentication);
+        }
+        if ((errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) &&
+            (authentication != U_WIFI_AUTH_OPEN)) {
+            // Set PSK/passphrase
+            errorCode = writeWifiStaCfgStr(atHandle, 0, 8, pPassPhrase);
+        }
+        if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+            errorCode = writeWifiStaCfgIpV4(atHandle, pFastConnect);
+        }
+        if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+            // Activate wifi
+            errorCode = writeWifiStaCfgAction(atHandle, 0, STA_ACTION_ACTIVATE);
+        }
+    }
+
+    uShortRangeUnlock();
+
+    return errorCode;
+}
+
+/** Helper function to check a scan result against a filter */
+static bool scanFilterMatch(const uWifiScanFilter_t *pFilter,
+                            const uWifiScanResult_t *pResult)
+{
+    bool match = true;
+
+    if (pFilter != NULL) {
+        if (pFilter->ppSsid != NULL) {
+            match = false;
+            for (size_t x = 0; (x < pFilter->numSsids) && !match; x++) {
+                match = (strcmp(pFilter->ppSsid[x], pResult->ssid) == 0);
+            }
+        }
+        if (match && (pFilter->rssiMinDbm != 0)) {
+            match = (pResult->rssi >= pFilter->rssiMinDbm);
+        }
+        if (match && (pFilter->pChannels != NULL)) {
+            match = false;
+            for (size_t x = 0; (x < pFilter->numChannels) && !match; x++) {
+                match = (pFilter->pChannels[x] == pResult->channel);
+            }
+        }
+    }
+
+    return match;
+}
+
+/** Helper function to add a scan result to a cache, keeping it in
+ * order of signal strength and dropping the weakest if it is full */
+static void scanCacheAdd(uWifiScanCache_t *pCache, const uWifiScanResult_t *pResult)
+{
+    size_t x;
+
+    if (pCache != NULL) {
+        x = pCache->numResults;
+        if (x == U_WIFI_SCAN_CACHE_MAX_NUM_RESULTS) {
+            // Full: will replace the last, if it is weaker
+            x--;
+            if (pCache->results[x].rssi >= pResult->rssi) {
+                x = U_WIFI_SCAN_CACHE_MAX_NUM_RESULTS;
+            }
+        } else {
+            pCache->numResults++;
+        }
+        if (x < U_WIFI_SCAN_CACHE_MAX_NUM_RESULTS) {
+            // Move weaker results down to make room
+            while ((x > 0) && (pCache->results[x - 1].rssi < pResult->rssi)) {
+                pCache->results[x] = pCache->results[x - 1];
+                x--;
+            }
+            pCache->results[x] = *pResult;
+        }
+    }
+}
+
 static void wifiConnectCallback(uAtClientHandle_t atHandle,
                                 void *pParameter)
 {
@@ -542,10 +707,28 @@ int32_t uWifiSetNetworkStatusCallback(uDeviceHandle_t devHandle,
 int32_t uWifiStationConnect(uDeviceHandle_t devHandle, const char *pSsid,
                             uWifiAuth_t authentication,
                             const char *pPassPhrase)
+{
+    return stationConnect(devHandle, pSsid, authentication, pPassPhrase, NULL);
+}
+
+int32_t uWifiStationConnectFast(uDeviceHandle_t devHandle, const char *pSsid,
+                                uWifiAuth_t authentication, const char *pPassPhrase,
+                                const uWifiStationFastConnect_t *pFastConnect)
+{
+    return stationConnect(devHandle, pSsid, authentication, pPassPhrase,
+                          pFastConnect);
+}
+
+int32_t uWifiStationFastConnectGet(uDeviceHandle_t devHandle,
+                                   uWifiStationFastConnect_t *pFastConnect)
 {
     int32_t errorCode;
     uShortRangePrivateInstance_t *pInstance;
 
+    if (pFastConnect == NULL) {
+        return (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    }
+
     errorCode = uShortRangeLock();
     if (errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) {
         return errorCode;
@@ -554,47 +737,47 @@ int32_t uWifiStationConnect(uDeviceHandle_t devHandle, const char *pSsid,
     errorCode = getInstance(devHandle, &pInstance);
     if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
         uAtClientHandle_t atHandle = pInstance->atHandle;
-
+        // Status IDs 101 to 105 of the station interface
+        char *pIpV4Str[] = {pFastConnect->ipV4Address,
+                            pFastConnect->subnetMask,
+                            pFastConnect->gateway,
+                            pFastConnect->dns1,
+                            pFastConnect->dns2
+                           };
+
+        memset(pFastConnect, 0, sizeof(*pFastConnect));
+        errorCode = (int32_t) U_WIFI_ERROR_NOT_FOUND;
         // Read connection status
-        int32_t conStatus = readWifiStaStatusInt(atHandle, 3);
-        if (conStatus == 2) {
-            // Wifi already connected. Check if the SSID is the same
-            char ssid[32 + 1];
-            errorCode = (int32_t) U_WIFI_ERROR_ALREADY_CONNECTED;
-            int32_t tmp = readWifiStaStatusString(atHandle, 0, ssid, sizeof(ssid));
-            if (tmp >= 0) {
-                if (strcmp(ssid, pSsid) == 0) {
-                    errorCode = (int32_t) U_WIFI_ERROR_ALREADY_CONNECTED_TO_SSID;
+        if (readWifiStaStatusInt(atHandle, 3) == 2) {
+            errorCode = readWifiStaStatusString(atHandle, 1, pFastConnect->bssid,
+                                                sizeof(pFastConnect->bssid));
+            if (errorCode >= 0) {
+                pFastConnect->channel = readWifiStaStatusInt(atHandle, 2);
+                errorCode = pFastConnect->channel;
+            }
+            for (size_t x = 0; (errorCode >= 0) &&
+                 (x < sizeof(pIpV4Str) / sizeof(pIpV4Str[0])); x++) {
+                errorCode = readIfaceStatusString(atHandle, 0, 101 + (int32_t) x,
+                                                  pIpV4Str[x], U_WIFI_IPV4_ADDRESS_STR_SIZE);
+            }
+            if (errorCode >= 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                if ((pFastConnect->ipV4Address[0] == '\0') ||
+                    (strcmp(pFastConnect->ipV4Address, "0.0.0.0") == 0)) {
+                    // No lease yet
+                    errorCode = (int32_t) U_WIFI_ERROR_NOT_FOUND;
+                }
+                // Absent DNS servers need not be configured
+                if (strcmp(pFastConnect->dns1, "0.0.0.0") == 0) {
+                    pFastConnect->dns1[0] = '\0';
+                }
+                if (strcmp(pFastConnect->dns2, "0.0.0.0") == 0) {
+                    pFastConnect->dns2[0] = '\0';
                 }
             }
         }
-
-        // Configure Wifi
-        if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
-            // Set Wifi STA inactive on start up
-            uPortLog(LOG_TAG "Activating wifi STA mode\n");
-            errorCode = writeWifiStaCfgInt(atHandle, 0, 0, 0);
-        }
-        if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
-            // Set SSID
-            errorCode = writeWifiStaCfgStr(atHandle, 0, 2, pSsid);
-        }
-        if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
-            // Set authentication
-            errorCode = writeWifiStaCfgInt(atHandle, 0, 5, (int32_t)authentication);
-        }
-        if ((errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) &&
-            (authentication != U_WIFI_AUTH_OPEN)) {
-            // Set PSK/passphrase
-            errorCode = writeWifiStaCfgStr(atHandle, 0, 8, pPassPhrase);
-        }
-        if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
-            // Set IP mode to static IP
-            errorCode = writeWifiStaCfgInt(atHandle, 0, 100, 2);
-        }
-        if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
-            // Activate wifi
-            errorCode = writeWifiStaCfgAction(atHandle, 0, STA_ACTION_ACTIVATE);
+        if (errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) {
+            memset(pFastConnect, 0, sizeof(*pFastConnect));
         }
     }
 
@@ -635,9 +818,24 @@ int32_t uWifiStationDisconnect(uDeviceHandle_t devHandle)
 
 int32_t uWifiStationScan(uDeviceHandle_t devHandle, const char *pSsid,
                          uWifiScanResultCallback_t pCallback)
+{
+    uWifiScanFilter_t filter = U_WIFI_SCAN_FILTER_DEFAULT;
+
+    if (pSsid != NULL) {
+        filter.ppSsid = &pSsid;
+        filter.numSsids = 1;
+    }
+
+    return uWifiStationScanFilter(devHandle, &filter, pCallback);
+}
+
+int32_t uWifiStationScanFilter(uDeviceHandle_t devHandle,
+                               const uWifiScanFilter_t *pFilter,
+                               uWifiScanResultCallback_t pCallback)
 {
     int32_t errorCode;
     uShortRangePrivateInstance_t *pInstance;
+    uWifiScanCache_t *pNewCache;
 
     errorCode = uShortRangeLock();
     if (errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) {
@@ -648,13 +846,23 @@ int32_t uWifiStationScan(uDeviceHandle_t devHandle, const char *pSsid,
     if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
         uAtClientHandle_t atHandle = pInstance->atHandle;
 
+        // The new results are collected separately and replace the
+        // cache only at the end, since the short range lock is
+        // released during the scan; if there is no memory for this
+        // the scan goes ahead without caching
+        pNewCache = (uWifiScanCache_t *) pUPortMalloc(sizeof(uWifiScanCache_t));
+        if (pNewCache != NULL) {
+            pNewCache->numResults = 0;
+        }
+
         uAtClientLock(atHandle);
         // Since the scanning can take some time we release the short range lock here
         // This should be fine since we currently have the AT client lock instead
         uShortRangeUnlock();
-        if (pSsid) {
+        if ((pFilter != NULL) && (pFilter->ppSsid != NULL) && (pFilter->numSsids == 1)) {
+            // Let the module do the filtering
             uAtClientCommandStart(atHandle, "AT+UWSCAN=");
-            uAtClientWriteString(atHandle, pSsid, false);
+            uAtClientWriteString(atHandle, pFilter->ppSsid[0], false);
         } else {
             uAtClientCommandStart(atHandle, "AT+UWSCAN");
         }
@@ -662,18 +870,21 @@ int32_t uWifiStationScan(uDeviceHandle_t devHandle, const char *pSsid,
 
         uAtClientTimeoutSet(atHandle, 10000);
 
-        // Handle the scan results
+        // Handle the scan results as they arrive
         // Loop until we get OK, ERROR or timeout
         while (uAtClientResponseStart(atHandle, "+UWSCAN:") == 0) {
             uWifiScanResult_t scanResult;
             int32_t result;
             char bssid[32];
 
+            memset(scanResult.bssid, 0, sizeof(scanResult.bssid));
             result = uAtClientReadString(atHandle, bssid, sizeof(bssid), false);
-            if (result >= 0) {
+            if ((result >= 0) && (result <= (int32_t) (U_WIFI_BSSID_SIZE * 2))) {
                 if (uHexToBin(bssid, result, (char *)scanResult.bssid) != result / 2) {
                     result = -1;
                 }
+            } else {
+                result = -1;
             }
             if (result < 0) {
                 uPortLog(LOG_TAG "Warning: Failed to parse BSSID");
@@ -689,10 +900,26 @@ int32_t uWifiStationScan(uDeviceHandle_t devHandle, const char *pSsid,
             scanResult.uniCipherBitmask = (uint8_t)uAtClientReadInt(atHandle);
             scanResult.grpCipherBitmask = (uint8_t)uAtClientReadInt(atHandle);
 
-            pCallback(devHandle, &scanResult);
+            scanCacheAdd(pNewCache, &scanResult);
+            if ((pCallback != NULL) && scanFilterMatch(pFilter, &scanResult)) {
+                pCallback(devHandle, &scanResult);
+            }
         }
 
         errorCode = uAtClientUnlock(atHandle);
+
+        if ((errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) && (pNewCache != NULL) &&
+            (uShortRangeLock() == (int32_t) U_ERROR_COMMON_SUCCESS)) {
+            // Replace the cache, provided the instance is still there
+            if (getInstance(devHandle, &pInstance) == (int32_t) U_ERROR_COMMON_SUCCESS) {
+                pNewCache->timeMs = uPortGetTickTimeMs();
+                uPortFree(pInstance->pWifiScanCache);
+                pInstance->pWifiScanCache = pNewCache;
+                pNewCache = NULL;
+            }
+            uShortRangeUnlock();
+        }
+        uPortFree(pNewCache);
     } else {
         uShortRangeUnlock();
     }
@@ -701,4 +928,48 @@ int32_t uWifiStationScan(uDeviceHandle_t devHandle, const char *pSsid,
     return errorCode;
 }
 
+int32_t uWifiStationScanCacheGet(uDeviceHandle_t devHandle,
+                                 const uWifiScanFilter_t *pFilter,
+                                 uWifiScanResult_t *pResults,
+                                 size_t maxNumResults,
+                                 int32_t *pAgeMs)
+{
+    int32_t errorCodeOrCount;
+    uShortRangePrivateInstance_t *pInstance;
+    const uWifiScanCache_t *pCache;
+    size_t count = 0;
+
+    if ((pResults == NULL) && (maxNumResults > 0)) {
+        return (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    }
+
+    errorCodeOrCount = uShortRangeLock();
+    if (errorCodeOrCount != (int32_t) U_ERROR_COMMON_SUCCESS) {
+        return errorCodeOrCount;
+    }
+
+    errorCodeOrCount = getInstance(devHandle, &pInstance);
+    if (errorCodeOrCount == (int32_t) U_ERROR_COMMON_SUCCESS) {
+        errorCodeOrCount = (int32_t) U_WIFI_ERROR_NOT_FOUND;
+        pCache = (const uWifiScanCache_t *) pInstance->pWifiScanCache;
+        if (pCache != NULL) {
+            // The cache is in order of signal strength already
+            for (size_t x = 0; (x < pCache->numResults) && (count < maxNumResults); x++) {
+                if (scanFilterMatch(pFilter, &(pCache->results[x]))) {
+                    *(pResults + count) = pCache->results[x];
+                    count++;
+                }
+            }
+            if (pAgeMs != NULL) {
+                *pAgeMs = uPortGetTickTimeMs() - pCache->timeMs;
+            }
+            errorCodeOrCount = (int32_t) count;
+        }
+    }
+
+    uShortRangeUnlock();
+
+    return errorCodeOrCount;
+}
+
 // End of file
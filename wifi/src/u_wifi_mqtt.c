@@ -76,6 +76,7 @@ typedef struct uWifiMqttTopic_t {
     bool isPublish;
     uMqttQos_t qos;
     bool retain;
+    struct uWifiMqttSession_t *pMqttSession;
     struct uWifiMqttTopic_t *pNext;
 } uWifiMqttTopic_t;
 
@@ -116,21 +117,41 @@ static uPortMutexHandle_t gMqttSessionMutex = NULL;
 static int32_t gCallbackQueue = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
 static int32_t gEdmChannel = -1;
 
+/** The topic using each EDM channel, so that incoming data can be
+ * matched to its topic without searching; protected by
+ * gMqttSessionMutex.
+ */
+static uWifiMqttTopic_t *gpTopicForEdmChannel[256] = {0};
+
+/**
+ * Set the EDM channel of a topic, -1 for none; gMqttSessionMutex
+ * must be locked, if it exists.
+ */
+static void setTopicEdmChannel(uWifiMqttTopic_t *pTopic, int32_t edmChannel)
+{
+    if ((pTopic->edmChannel >= 0) &&
+        (gpTopicForEdmChannel[(uint8_t) pTopic->edmChannel] == pTopic)) {
+        gpTopicForEdmChannel[(uint8_t) pTopic->edmChannel] = NULL;
+    }
+    pTopic->edmChannel = edmChannel;
+    if (edmChannel >= 0) {
+        gpTopicForEdmChannel[(uint8_t) edmChannel] = pTopic;
+    }
+}
+
 /**
  * Fetch the topic string in a given MQTT session associated to particular EDM channel
  */
 static char *getTopicStrForEdmChannel(uWifiMqttSession_t *pMqttSession, int32_t edmChannel)
 {
-    uWifiMqttTopic_t *pTopic;
+    uWifiMqttTopic_t *pTopic = NULL;
     char *pTopicNameStr = NULL;
 
-    for (pTopic = pMqttSession->topicList.pHead; pTopic != NULL; pTopic = pTopic->pNext) {
-
-        if (pTopic->edmChannel == edmChannel) {
-
-            pTopicNameStr = pTopic->pTopicStr;
-
-        }
+    if (edmChannel >= 0) {
+        pTopic = gpTopicForEdmChannel[(uint8_t) edmChannel];
+    }
+    if ((pTopic != NULL) && (pTopic->pMqttSession == pMqttSession)) {
+        pTopicNameStr = pTopic->pTopicStr;
     }
 
     return pTopicNameStr;
@@ -186,6 +207,7 @@ static uWifiMqttTopic_t *pAllocateMqttTopic (uWifiMqttSession_t *pMqttSession, b
             pTopic->edmChannel = -1;
             pTopic->isTopicUnsubscribed = false;
             pTopic->isPublish = isPublish;
+            pTopic->pMqttSession = pMqttSession;
         }
     }
 
@@ -213,6 +235,13 @@ static void freeMqttTopic(uWifiMqttSession_t *pMqttSession, uWifiMqttTopic_t *pT
                 pPrev->pNext = pCurr->pNext;
 
             }
+            if (gMqttSessionMutex != NULL) {
+                U_PORT_MUTEX_LOCK(gMqttSessionMutex);
+                setTopicEdmChannel(pCurr, -1);
+                U_PORT_MUTEX_UNLOCK(gMqttSessionMutex);
+            } else {
+                setTopicEdmChannel(pCurr, -1);
+            }
             uPortFree(pCurr->pTopicStr);
             uPortFree(pCurr);
             break;
@@ -231,6 +260,13 @@ static void freeAllMqttTopics(uWifiMqttSession_t *pMqttSession)
     for (pTemp = pMqttSession->topicList.pHead; pTemp != NULL; pTemp = pNext) {
 
         pNext = pTemp->pNext;
+        if (gMqttSessionMutex != NULL) {
+            U_PORT_MUTEX_LOCK(gMqttSessionMutex);
+            setTopicEdmChannel(pTemp, -1);
+            U_PORT_MUTEX_UNLOCK(gMqttSessionMutex);
+        } else {
+            setTopicEdmChannel(pTemp, -1);
+        }
         uPortFree(pTemp->pTopicStr);
         uPortFree(pTemp);
     }
@@ -503,43 +539,42 @@ static void edmMqttDataCallback(int32_t edmHandle, int32_t edmChannel,
                                 void *pCallbackParameter)
 {
     uWifiMqttSession_t *pMqttSession = NULL;
-    uWifiMqttTopic_t *pTopic;
-    int32_t i;
+    uWifiMqttTopic_t *pTopic = NULL;
     (void) edmHandle;
     (void)pCallbackParameter;
 
     U_PORT_MUTEX_LOCK(gMqttSessionMutex);
 
-    for (i = 0; i < U_WIFI_MQTT_MAX_NUM_CONNECTIONS; i++) {
-
-        pMqttSession = &gMqttSessions[i];
-
-        for (pTopic = pMqttSession->topicList.pHead; pTopic != NULL; pTopic = pTopic->pNext) {
-
-            if ((pTopic->edmChannel == edmChannel) && (!pTopic->isTopicUnsubscribed)) {
-
-                uPortLog("U_WIFI_MQTT: EDM data event for channel %d\n", edmChannel);
-                if (uShortRangePktListAppend(&pMqttSession->rxPkt,
-                                             pBufList) == (int32_t)U_ERROR_COMMON_SUCCESS) {
-                    pMqttSession->unreadMsgsCount = pMqttSession->rxPkt.pktCount;
-                    // Schedule user data pDataCb
-                    if (pMqttSession->pDataCb) {
-                        //lint -save -e785
-                        uCallbackEvent_t event = {
-                            .pDataCb = pMqttSession->pDataCb,
-                            .pDisconnectCb = NULL,
-                            .pCbParam = pMqttSession->pCbParam,
-                            .pMqttSession = pMqttSession
-                        };
-                        //lint -restore
-                        uPortEventQueueSend(gCallbackQueue, &event, sizeof(event));
-                    }
-                } else {
-                    uPortLog("U_WIFI_MQTT: Pkt insert failed\n");
-                    uShortRangePbufListFree(pBufList);
-                }
+    if (edmChannel >= 0) {
+        pTopic = gpTopicForEdmChannel[(uint8_t) edmChannel];
+    }
+    if ((pTopic != NULL) && (!pTopic->isTopicUnsubscribed)) {
+        pMqttSession = pTopic->pMqttSession;
+        uPortLog("U_WIFI_MQTT: EDM data event for channel %d\n", edmChannel);
+        // The pbufs are queued as they are, the only copy
+        // being into the buffer given to uWifiMqttMessageRead()
+        if (uShortRangePktListAppend(&pMqttSession->rxPkt,
+                                     pBufList) == (int32_t)U_ERROR_COMMON_SUCCESS) {
+            pMqttSession->unreadMsgsCount = pMqttSession->rxPkt.pktCount;
+            // Schedule user data pDataCb
+            if (pMqttSession->pDataCb) {
+                //lint -save -e785
+                uCallbackEvent_t event = {
+                    .pDataCb = pMqttSession->pDataCb,
+                    .pDisconnectCb = NULL,
+                    .pCbParam = pMqttSession->pCbParam,
+                    .pMqttSession = pMqttSession
+                };
+                //lint -restore
+                uPortEventQueueSend(gCallbackQueue, &event, sizeof(event));
             }
+        } else {
+            uPortLog("U_WIFI_MQTT: Pkt insert failed\n");
+            uShortRangePbufListFree(pBufList);
         }
+    } else {
+        // No-one wants it
+        uShortRangePbufListFree(pBufList);
     }
 
     U_PORT_MUTEX_UNLOCK(gMqttSessionMutex);
@@ -596,14 +631,14 @@ static void atMqttConnectionCallback(uDeviceHandle_t devHandle,
                 switch (eventType) {
                     case U_SHORT_RANGE_EVENT_CONNECTED:
                         uPortLog("U_WIFI_MQTT: AT+UUDCPC connect event for connHandle %d\n", connHandle);
-                        pTopic->edmChannel = gEdmChannel;
+                        setTopicEdmChannel(pTopic, gEdmChannel);
                         pTopic->peerHandle = connHandle;
                         topicFound = true;
                         break;
                     case U_SHORT_RANGE_EVENT_DISCONNECTED:
                         uPortLog("U_WIFI_MQTT: AT+UUDCPC disconnect event for connHandle %d\n", connHandle);
                         pTopic->peerHandle = -1;
-                        pTopic->edmChannel = -1;
+                        setTopicEdmChannel(pTopic, -1);
                         topicFound = true;
                         pMqttSession->isConnected = false;
                         // Report to user that we are disconnected
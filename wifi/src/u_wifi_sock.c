@@ -40,6 +40,7 @@
 #include "u_assert.h"
 
 #include "u_port_os.h"
+#include "u_port_heap.h"
 #include "u_cfg_sw.h"
 #include "u_port_debug.h"
 #include "u_cfg_os_platform_specific.h"
@@ -79,6 +80,14 @@ typedef enum {
     WIFI_INT_OPT_MAX
 } WifiIntOptId_t;
 
+/** A received datagram, in the receive queue of a UDP socket.
+ */
+typedef struct {
+    uShortRangePbufList_t *pBufList; /**< The buffers the datagram was
+                                          received into, as they are. */
+    uSockAddress_t remoteAddress; /**< Where the datagram came from. */
+} uWifiSockUdpDatagram_t;
+
 typedef struct {
     int32_t sockHandle; /**< The handle of the socket instance
                              -1 if this socket is not in use. */
@@ -96,9 +105,29 @@ typedef struct {
     bool closing;
     uSockAddress_t remoteAddress;
     int32_t localPort;
+    uPortMutexHandle_t rxMutex; /**< Protects sockHandle, pTcpRxBuff and
+                                     the UDP receive queue so that received
+                                     data can be handled without the short
+                                     range lock; exists from uWifiSockInit()
+                                     until uWifiSockDeinit(). */
     uShortRangePbufList_t *pTcpRxBuff;
-    uShortRangePktList_t udpPktList;
+    uWifiSockUdpDatagram_t udpQueue[U_WIFI_SOCK_UDP_QUEUE_DEPTH]; /**< Ring of
+                                                                       received
+                                                                       datagrams. */
+    size_t udpQueueRead; /**< The index of the oldest datagram in udpQueue. */
+    size_t udpQueueCount; /**< The number of datagrams in udpQueue. */
+    uShortRangePbufList_t *pUdpLent; /**< The datagram lent out by
+                                          uWifiSockReceiveFromNoCopy(),
+                                          NULL if there is none. */
+    uint32_t udpDatagramsDropped; /**< Datagrams dropped as udpQueue was full. */
+    uint32_t udpBytesDropped; /**< The bytes in udpDatagramsDropped. */
     int32_t intOpts[WIFI_INT_OPT_MAX];
+    char *pTxCoalesce; /**< Buffer of #U_WIFI_SOCK_MAX_SEGMENT_SIZE_BYTES
+                            holding coalesced writes, NULL if there
+                            are none. */
+    size_t txCoalesceLength; /**< The number of bytes at pTxCoalesce. */
+    uAtClientHandle_t txCoalesceAtHandle; /**< The AT client whose callback
+                                               task flushes pTxCoalesce. */
     uWifiSockCallback_t pAsyncClosedCallback; /**< Set to NULL if socket is not in use. */
     uWifiSockCallback_t pDataCallback; /**< Set to NULL if socket is not in use. */
     uWifiSockCallback_t pClosedCallback; /**< Set to NULL if socket is not in use. */
@@ -134,6 +163,21 @@ static uDeviceHandle_t gInstanceDeviceHandleList[U_WIFI_MAX_INSTANCE_COUNT];
 static uWifiSockSocket_t gSockets[U_WIFI_SOCK_MAX_NUM_SOCKETS];
 static uPingContext_t gPingContext;
 
+/** Timer which flushes coalesced writes, only created if
+ * #U_WIFI_SOCK_TCP_COALESCE_MS is greater than zero.
+ */
+static uPortTimerHandle_t gCoalesceTimer = NULL;
+
+/** True while gCoalesceTimer is running; protected by
+ * uShortRangeLock().
+ */
+static bool gCoalesceTimerActive = false;
+
+/** True if a flush of coalesced writes has been queued and
+ * has not yet run, to avoid queueing more than one.
+ */
+static volatile bool gCoalescePosted = false;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -143,10 +187,95 @@ static uPingContext_t gPingContext;
  * STATIC FUNCTIONS
  * ------------------------------------------------------------- */
 
+// Reset the receive data of a socket, without freeing anything.
+static void clearRxData(uWifiSockSocket_t *pSock)
+{
+    pSock->pTcpRxBuff = NULL;
+    memset((void *)(pSock->udpQueue), 0, sizeof(pSock->udpQueue));
+    pSock->udpQueueRead = 0;
+    pSock->udpQueueCount = 0;
+    pSock->pUdpLent = NULL;
+    pSock->udpDatagramsDropped = 0;
+    pSock->udpBytesDropped = 0;
+}
+
+// Add a datagram to the end of the receive queue of a socket,
+// returning false if the queue is full: rxMutex must be locked.
+static bool udpQueuePush(uWifiSockSocket_t *pSock,
+                         uShortRangePbufList_t *pBufList)
+{
+    bool pushed = false;
+    uWifiSockUdpDatagram_t *pDatagram;
+
+    if (pSock->udpQueueCount < U_WIFI_SOCK_UDP_QUEUE_DEPTH) {
+        pDatagram = &(pSock->udpQueue[(pSock->udpQueueRead + pSock->udpQueueCount) %
+                                                           U_WIFI_SOCK_UDP_QUEUE_DEPTH]);
+        pDatagram->pBufList = pBufList;
+        // At the moment we only receive packets from the address from
+        // first call to uWifiSockSendTo()
+        pDatagram->remoteAddress = pSock->remoteAddress;
+        pSock->udpQueueCount++;
+        pushed = true;
+    }
+
+    return pushed;
+}
+
+// Take the oldest datagram off the receive queue of a socket,
+// returning NULL if there is none: rxMutex must be locked.
+static uShortRangePbufList_t *pUdpQueuePop(uWifiSockSocket_t *pSock,
+                                           uSockAddress_t *pRemoteAddress)
+{
+    uShortRangePbufList_t *pBufList = NULL;
+    uWifiSockUdpDatagram_t *pDatagram;
+
+    if (pSock->udpQueueCount > 0) {
+        pDatagram = &(pSock->udpQueue[pSock->udpQueueRead]);
+        pBufList = pDatagram->pBufList;
+        if (pRemoteAddress != NULL) {
+            *pRemoteAddress = pDatagram->remoteAddress;
+        }
+        pDatagram->pBufList = NULL;
+        pSock->udpQueueRead = (pSock->udpQueueRead + 1) % U_WIFI_SOCK_UDP_QUEUE_DEPTH;
+        pSock->udpQueueCount--;
+    }
+
+    return pBufList;
+}
+
+// Free any received data held by a socket: rxMutex must be locked.
+static void freeRxData(uWifiSockSocket_t *pSock)
+{
+    uShortRangePbufListFree(pSock->pTcpRxBuff);
+    while (pSock->udpQueueCount > 0) {
+        uShortRangePbufListFree(pUdpQueuePop(pSock, NULL));
+    }
+    uShortRangePbufListFree(pSock->pUdpLent);
+    clearRxData(pSock);
+}
+
+// Free any coalesced writes of a socket.
+static void coalesceFree(uWifiSockSocket_t *pSock)
+{
+    uPortFree(pSock->pTxCoalesce);
+    pSock->pTxCoalesce = NULL;
+    pSock->txCoalesceLength = 0;
+}
+
 static void freeSocket(uWifiSockSocket_t *pSock)
 {
     if (pSock != NULL) {
-        pSock->sockHandle = -1;
+        // Any coalesced writes not yet sent are lost
+        coalesceFree(pSock);
+        if (pSock->rxMutex != NULL) {
+            U_PORT_MUTEX_LOCK(pSock->rxMutex);
+            pSock->sockHandle = -1;
+            // Any received data that has not been read is lost
+            freeRxData(pSock);
+            U_PORT_MUTEX_UNLOCK(pSock->rxMutex);
+        } else {
+            pSock->sockHandle = -1;
+        }
         if (pSock->semaphore != NULL) {
             uPortSemaphoreDelete(pSock->semaphore);
             pSock->semaphore = NULL;
@@ -163,18 +292,15 @@ static uWifiSockSocket_t *pAllocateSocket(uDeviceHandle_t devHandle)
         if (gSockets[index].sockHandle == -1) {
             int32_t tmp;
             pSock = &(gSockets[index]);
+            U_PORT_MUTEX_LOCK(pSock->rxMutex);
             pSock->sockHandle = index;
             pSock->devHandle = devHandle;
+            clearRxData(pSock);
+            U_PORT_MUTEX_UNLOCK(pSock->rxMutex);
             pSock->semaphore = NULL;
             tmp = uPortSemaphoreCreate(&(pSock->semaphore), 0, 1);
             if (tmp != (int32_t) U_ERROR_COMMON_SUCCESS) {
                 outOfMemory = true;
-                break;
-            }
-            if (pSock->protocol == U_SOCK_PROTOCOL_TCP) {
-                pSock->pTcpRxBuff = NULL;
-            } else if (pSock->protocol == U_SOCK_PROTOCOL_UDP) {
-                memset((void *)(&pSock->udpPktList), 0, sizeof(uShortRangePktList_t));
             }
             break;
         }
@@ -195,6 +321,16 @@ static void freeAllSockets(void)
     }
 }
 
+static void deleteSocketMutexes(void)
+{
+    for (int32_t index = 0; index < U_WIFI_SOCK_MAX_NUM_SOCKETS; index++) {
+        if (gSockets[index].rxMutex != NULL) {
+            uPortMutexDelete(gSockets[index].rxMutex);
+            gSockets[index].rxMutex = NULL;
+        }
+    }
+}
+
 static inline WifiIntOptId_t getIntOptionId(int32_t level, uint32_t option)
 {
     if (level == U_SOCK_OPT_LEVEL_TCP) {
@@ -290,6 +426,25 @@ static uWifiSockSocket_t *pFindConnectingSocketByRemoteAddress(uDeviceHandle_t d
     return pSock;
 }
 
+// Find a socket and lock its receive data, without taking the
+// short range lock, returning NULL if the socket is not in use;
+// if a socket is returned its rxMutex must be unlocked afterwards.
+static uWifiSockSocket_t *pLockSocketRx(uDeviceHandle_t devHandle, int32_t sockHandle)
+{
+    uWifiSockSocket_t *pSock = NULL;
+
+    if (gInitialised && (sockHandle >= 0) && (sockHandle < U_WIFI_SOCK_MAX_NUM_SOCKETS)) {
+        pSock = &(gSockets[sockHandle]);
+        uPortMutexLock(pSock->rxMutex);
+        if ((pSock->sockHandle != sockHandle) || (pSock->devHandle != devHandle)) {
+            uPortMutexUnlock(pSock->rxMutex);
+            pSock = NULL;
+        }
+    }
+
+    return pSock;
+}
+
 static uWifiSockSocket_t *pFindSocketByEdmChannel(uDeviceHandle_t devHandle, int32_t edmChannel)
 {
     uWifiSockSocket_t *pSock = NULL;
@@ -388,6 +543,155 @@ static int32_t setOptionInt(uWifiSockSocket_t *pSock,
     return U_SOCK_ENONE;
 }
 
+// Send as much as possible of the coalesced writes of a socket,
+// returning U_SOCK_ENONE or negated errno; uShortRangeLock()
+// must be held.
+static int32_t coalesceFlush(const uShortRangePrivateInstance_t *pInstance,
+                             uWifiSockSocket_t *pSock)
+{
+    int32_t errnoLocal = U_SOCK_ENONE;
+    int32_t shortRangeEC;
+
+    if (pSock->txCoalesceLength > 0) {
+        shortRangeEC = uShortRangeEdmStreamWrite(pInstance->streamHandle,
+                                                 pSock->edmChannel,
+                                                 pSock->pTxCoalesce,
+                                                 pSock->txCoalesceLength,
+                                                 U_WIFI_SOCK_WRITE_TIMEOUT_MS);
+        if (shortRangeEC > 0) {
+            pSock->txCoalesceLength -= shortRangeEC;
+            memmove(pSock->pTxCoalesce, pSock->pTxCoalesce + shortRangeEC,
+                    pSock->txCoalesceLength);
+        } else if (shortRangeEC < 0) {
+            errnoLocal = -U_SOCK_ECOMM;
+        }
+        if (pSock->txCoalesceLength == 0) {
+            // All gone, no need to keep the memory
+            coalesceFree(pSock);
+        }
+    }
+
+    return errnoLocal;
+}
+
+// Add a write to the coalesced writes of a socket, returning the
+// number of bytes taken or negated errno; uShortRangeLock() must
+// be held.
+static int32_t coalesceWrite(const uShortRangePrivateInstance_t *pInstance,
+                             uWifiSockSocket_t *pSock,
+                             const uSockIoVec_t *pIoVec, size_t ioVecCount,
+                             size_t size)
+{
+    int32_t errnoLocalOrSize = U_SOCK_ENONE;
+    size_t count = 0;
+    size_t thisSize;
+
+    if (pSock->txCoalesceLength + size > U_WIFI_SOCK_MAX_SEGMENT_SIZE_BYTES) {
+        // Won't fit: send what is there first
+        errnoLocalOrSize = coalesceFlush(pInstance, pSock);
+    }
+    if ((errnoLocalOrSize == U_SOCK_ENONE) && (pSock->pTxCoalesce == NULL)) {
+        pSock->pTxCoalesce = (char *) pUPortMalloc(U_WIFI_SOCK_MAX_SEGMENT_SIZE_BYTES);
+        if (pSock->pTxCoalesce == NULL) {
+            errnoLocalOrSize = -U_SOCK_ENOMEM;
+        }
+    }
+    if (errnoLocalOrSize == U_SOCK_ENONE) {
+        // Take as much as will fit, which may be a partial write
+        // if the module didn't take all of what was there
+        for (size_t x = 0; (x < ioVecCount) &&
+             (pSock->txCoalesceLength < U_WIFI_SOCK_MAX_SEGMENT_SIZE_BYTES); x++) {
+            thisSize = pIoVec[x].dataSizeBytes;
+            if (thisSize > U_WIFI_SOCK_MAX_SEGMENT_SIZE_BYTES - pSock->txCoalesceLength) {
+                thisSize = U_WIFI_SOCK_MAX_SEGMENT_SIZE_BYTES - pSock->txCoalesceLength;
+            }
+            if (thisSize > 0) {
+                memcpy(pSock->pTxCoalesce + pSock->txCoalesceLength,
+                       pIoVec[x].pData, thisSize);
+                pSock->txCoalesceLength += thisSize;
+                count += thisSize;
+            }
+        }
+        pSock->txCoalesceAtHandle = pInstance->atHandle;
+        if (!gCoalesceTimerActive &&
+            (uPortTimerStart(gCoalesceTimer) == (int32_t) U_ERROR_COMMON_SUCCESS)) {
+            gCoalesceTimerActive = true;
+        }
+        if ((pSock->txCoalesceLength == U_WIFI_SOCK_MAX_SEGMENT_SIZE_BYTES) ||
+            !gCoalesceTimerActive) {
+            // Full, or can't wait: any error will be reported
+            // by the next write
+            coalesceFlush(pInstance, pSock);
+        }
+        errnoLocalOrSize = -U_SOCK_EWOULDBLOCK;
+        if (count > 0) {
+            errnoLocalOrSize = (int32_t) count;
+        }
+    }
+
+    return errnoLocalOrSize;
+}
+
+// Flush the coalesced writes of all sockets, called through
+// uAtClientCallback() by coalesceTimerCallback(), stopping
+// gCoalesceTimer if nothing remains.
+static void coalesceService(uAtClientHandle_t atHandle, void *pParameter)
+{
+    uShortRangePrivateInstance_t *pInstance;
+    uWifiSockSocket_t *pSock;
+    bool anyLeft = false;
+
+    (void) atHandle;
+    (void) pParameter;
+
+    gCoalescePosted = false;
+    if (uShortRangeLock() == (int32_t) U_ERROR_COMMON_SUCCESS) {
+        if (gInitialised) {
+            for (int32_t index = 0; index < U_WIFI_SOCK_MAX_NUM_SOCKETS; index++) {
+                pSock = &(gSockets[index]);
+                if ((pSock->sockHandle >= 0) && (pSock->txCoalesceLength > 0)) {
+                    if (getInstance(pSock->devHandle, &pInstance) == U_SOCK_ENONE) {
+                        coalesceFlush(pInstance, pSock);
+                    } else {
+                        // Nowhere for it to go
+                        coalesceFree(pSock);
+                    }
+                    if (pSock->txCoalesceLength > 0) {
+                        anyLeft = true;
+                    }
+                }
+            }
+        }
+        if (!anyLeft && gCoalesceTimerActive) {
+            uPortTimerStop(gCoalesceTimer);
+            gCoalesceTimerActive = false;
+        }
+        uShortRangeUnlock();
+    }
+}
+
+// Callback for gCoalesceTimer, called in the context of the timer
+// task, which moves the flush to the callback task of an AT client
+// that has coalesced writes waiting, since the flush has to wait
+// on uShortRangeLock() and the UART.
+static void coalesceTimerCallback(const uPortTimerHandle_t timerHandle,
+                                  void *pParameter)
+{
+    (void) timerHandle;
+    (void) pParameter;
+
+    // No lock here, coalesceService() checks everything again
+    for (int32_t index = 0; (index < U_WIFI_SOCK_MAX_NUM_SOCKETS) &&
+         !gCoalescePosted; index++) {
+        if ((gSockets[index].txCoalesceLength > 0) &&
+            (gSockets[index].txCoalesceAtHandle != NULL) &&
+            (uAtClientCallback(gSockets[index].txCoalesceAtHandle,
+                               coalesceService, NULL) == 0)) {
+            gCoalescePosted = true;
+        }
+    }
+}
+
 // Convert a short range IP struct to uSockAddress structs
 static void convertToSockAddress(const uShortRangeConnectDataIp_t *pShoAddr,
                                  uint16_t *pLocalPort,
@@ -464,6 +768,8 @@ static void edmIpConnectionCallback(int32_t edmHandle,
             if (pSock && pSock->connected) {
                 sockHandle = pSock->sockHandle;
                 pSock->connected = false;
+                // Coalesced writes can no longer be sent
+                coalesceFree(pSock);
                 pUserClosedCb = pSock->pClosedCallback;
                 pUserAsyncClosedCb = pSock->pAsyncClosedCallback;
                 if (pSock->closing) {
@@ -504,20 +810,32 @@ static void edmIpDataCallback(int32_t edmHandle, int32_t edmChannel,
     uShortRangePrivateInstance_t *pInstance = (uShortRangePrivateInstance_t *) pCallbackParameter;
     // Basic validation
     if (pInstance == NULL || pInstance->atHandle == NULL) {
+        uShortRangePbufListFree(pBufList);
         return;
     }
 
-    U_ASSERT( uShortRangeLock() == (int32_t) U_ERROR_COMMON_SUCCESS );
-
+    // Only the receive data of the socket is locked, not the whole
+    // of short range, so that reading one socket doesn't hold up
+    // writes to another or AT commands
     devHandle = pInstance->devHandle;
     uWifiSockSocket_t *pSock = pFindSocketByEdmChannel(devHandle, edmChannel);
+    if (pSock != NULL) {
+        sockHandle = pSock->sockHandle;
+        pSock = pLockSocketRx(devHandle, sockHandle);
+        if ((pSock != NULL) && (pSock->edmChannel != edmChannel)) {
+            // Lost a race with the socket being closed and reused
+            uPortMutexUnlock(pSock->rxMutex);
+            pSock = NULL;
+        }
+    }
     if (pSock) {
         sockHandle = pSock->sockHandle;
         if (pSock->protocol == U_SOCK_PROTOCOL_UDP) {
 
-            if (uShortRangePktListAppend(&pSock->udpPktList,
-                                         pBufList) != (int32_t)U_ERROR_COMMON_SUCCESS) {
-                uPortLog("U_WIFI_SOCK: UDP pkt insert failed\n");
+            if (!udpQueuePush(pSock, pBufList)) {
+                // Queue full: drop the newest, the reader is behind
+                pSock->udpDatagramsDropped++;
+                pSock->udpBytesDropped += pBufList->totalLen;
                 uShortRangePbufListFree(pBufList);
             }
         } else {
@@ -531,9 +849,12 @@ static void edmIpDataCallback(int32_t edmHandle, int32_t edmChannel,
 
         // Schedule user data callback
         pUserDataCb = pSock->pDataCallback;
-    }
 
-    uShortRangeUnlock();
+        uPortMutexUnlock(pSock->rxMutex);
+    } else {
+        // No-one to give it to
+        uShortRangePbufListFree(pBufList);
+    }
 
     // Call the user callback after the mutex has been unlocked
     if (pUserDataCb) {
@@ -716,9 +1037,30 @@ int32_t uWifiSockInit(void)
         for (int i = 0; i < U_WIFI_MAX_INSTANCE_COUNT; i++) {
             gInstanceDeviceHandleList[i] = NULL;
         }
+        for (int32_t index = 0; (index < U_WIFI_SOCK_MAX_NUM_SOCKETS) &&
+             (errnoLocal == U_SOCK_ENONE); index++) {
+            gSockets[index].rxMutex = NULL;
+            clearRxData(&(gSockets[index]));
+            if (uPortMutexCreate(&(gSockets[index].rxMutex)) != (int32_t) U_ERROR_COMMON_SUCCESS) {
+                errnoLocal = -U_SOCK_ENOMEM;
+            }
+        }
+        if ((errnoLocal == U_SOCK_ENONE) && (U_WIFI_SOCK_TCP_COALESCE_MS > 0)) {
+            // Without the timer writes are simply not coalesced
+            gCoalesceTimerActive = false;
+            gCoalescePosted = false;
+            uPortTimerCreate(&gCoalesceTimer, "wifiSockCoalesce",
+                             coalesceTimerCallback, NULL,
+                             U_WIFI_SOCK_TCP_COALESCE_MS, true);
+        }
         if (errnoLocal == U_SOCK_ENONE) {
             freeAllSockets();
             gInitialised = true;
+        } else {
+            deleteSocketMutexes();
+            if (tmp == (int32_t) U_ERROR_COMMON_SUCCESS) {
+                uPortSemaphoreDelete(gPingContext.semaphore);
+            }
         }
     }
 
@@ -818,6 +1160,12 @@ void uWifiSockDeinit()
         }
 
         freeAllSockets();
+        deleteSocketMutexes();
+        if (gCoalesceTimer != NULL) {
+            uPortTimerDelete(gCoalesceTimer);
+            gCoalesceTimer = NULL;
+            gCoalesceTimerActive = false;
+        }
         uPortSemaphoreDelete(gPingContext.semaphore);
         // Nothing more to do, URCs will have been
         // removed on close
@@ -982,6 +1330,11 @@ int32_t uWifiSockClose(uDeviceHandle_t devHandle,
                 volatile uAtClientHandle_t atHandle = pInstance->atHandle;
                 volatile int32_t connHandle = pSock->connHandle;
 
+                // Coalesced writes go before the close; whatever
+                // the module won't take is lost
+                coalesceFlush(pInstance, pSock);
+                coalesceFree(pSock);
+
                 // We need to release the lock during disconnection phase
                 uShortRangeUnlock();
 
@@ -1106,12 +1459,24 @@ int32_t uWifiSockSetNextLocalPort(uDeviceHandle_t devHandle, int32_t port)
 int32_t uWifiSockWrite(uDeviceHandle_t devHandle,
                        int32_t sockHandle,
                        const void *pData, size_t dataSizeBytes)
+{
+    uSockIoVec_t ioVec;
+
+    ioVec.pData = pData;
+    ioVec.dataSizeBytes = dataSizeBytes;
+
+    return uWifiSockWritev(devHandle, sockHandle, &ioVec, 1);
+}
+
+int32_t uWifiSockWritev(uDeviceHandle_t devHandle,
+                        int32_t sockHandle,
+                        const uSockIoVec_t *pIoVec, size_t ioVecCount)
 {
     int32_t errnoLocal;
     uWifiSockSocket_t *pSock = NULL;
     uShortRangePrivateInstance_t *pInstance = NULL;
 
-    if ((dataSizeBytes == 0) || (pData == NULL)) {
+    if (uSockIoVecSize(pIoVec, ioVecCount) <= 0) {
         return -U_SOCK_EINVAL;
     }
 
@@ -1133,14 +1498,29 @@ int32_t uWifiSockWrite(uDeviceHandle_t devHandle,
         }
     }
     if (errnoLocal == U_SOCK_ENONE) {
-        int32_t shortRangeEC = uShortRangeEdmStreamWrite(pInstance->streamHandle,
-                                                         pSock->edmChannel,
-                                                         pData, dataSizeBytes,
-                                                         U_WIFI_SOCK_WRITE_TIMEOUT_MS);
-        if (shortRangeEC >= 0) {
-            errnoLocal = shortRangeEC;
+        size_t size = (size_t) uSockIoVecSize(pIoVec, ioVecCount);
+        if ((gCoalesceTimer != NULL) &&
+            (pSock->intOpts[WIFI_INT_OPT_TCP_NODELAY] == 0) &&
+            (size < U_WIFI_SOCK_MAX_SEGMENT_SIZE_BYTES)) {
+            errnoLocal = coalesceWrite(pInstance, pSock, pIoVec, ioVecCount, size);
         } else {
-            errnoLocal = U_SOCK_ECOMM;
+            // Anything coalesced must go first to keep the stream in order
+            errnoLocal = coalesceFlush(pInstance, pSock);
+            if ((errnoLocal == U_SOCK_ENONE) && (pSock->txCoalesceLength > 0)) {
+                errnoLocal = -U_SOCK_EWOULDBLOCK;
+            }
+            if (errnoLocal == U_SOCK_ENONE) {
+                // All the pieces go in one EDM data frame
+                int32_t shortRangeEC = uShortRangeEdmStreamWritev(pInstance->streamHandle,
+                                                                  pSock->edmChannel,
+                                                                  pIoVec, ioVecCount,
+                                                                  U_WIFI_SOCK_WRITE_TIMEOUT_MS);
+                if (shortRangeEC >= 0) {
+                    errnoLocal = shortRangeEC;
+                } else {
+                    errnoLocal = -U_SOCK_ECOMM;
+                }
+            }
         }
     }
 
@@ -1155,15 +1535,19 @@ int32_t uWifiSockRead(uDeviceHandle_t devHandle,
 {
     int32_t errnoLocal;
     uWifiSockSocket_t *pSock = NULL;
-    uShortRangePrivateInstance_t *pInstance = NULL;
     uShortRangePbufList_t *pList;
 
-    if (uShortRangeLock() != (int32_t) U_ERROR_COMMON_SUCCESS) {
-        return -U_SOCK_EIO;
+    // The short range lock is not needed to read received data,
+    // only the lock on that data in the socket
+    errnoLocal = -U_SOCK_EFAULT;
+    if (gInitialised) {
+        errnoLocal = -U_SOCK_EBADFD;
+        pSock = pLockSocketRx(devHandle, sockHandle);
+        if (pSock != NULL) {
+            errnoLocal = U_SOCK_ENONE;
+        }
     }
 
-    errnoLocal = getInstanceAndSocket(devHandle, sockHandle, &pInstance, &pSock);
-
     // We only support Read for TCP sockets
     if ((errnoLocal == U_SOCK_ENONE) && (pSock->protocol != U_SOCK_PROTOCOL_TCP)) {
         errnoLocal = -U_SOCK_EOPNOTSUPP;
@@ -1183,7 +1567,9 @@ int32_t uWifiSockRead(uDeviceHandle_t devHandle,
         }
     }
 
-    uShortRangeUnlock();
+    if (pSock != NULL) {
+        uPortMutexUnlock(pSock->rxMutex);
+    }
 
     return errnoLocal;
 }
@@ -1193,6 +1579,19 @@ int32_t uWifiSockSendTo(uDeviceHandle_t devHandle,
                         const uSockAddress_t *pRemoteAddress,
                         const void *pData,
                         size_t dataSizeBytes)
+{
+    uSockIoVec_t ioVec;
+
+    ioVec.pData = pData;
+    ioVec.dataSizeBytes = dataSizeBytes;
+
+    return uWifiSockSendToV(devHandle, sockHandle, pRemoteAddress, &ioVec, 1);
+}
+
+int32_t uWifiSockSendToV(uDeviceHandle_t devHandle,
+                         int32_t sockHandle,
+                         const uSockAddress_t *pRemoteAddress,
+                         const uSockIoVec_t *pIoVec, size_t ioVecCount)
 {
     int32_t errnoLocal;
     uShortRangePrivateInstance_t *pInstance = NULL;
@@ -1273,12 +1672,12 @@ int32_t uWifiSockSendTo(uDeviceHandle_t devHandle,
         }
     }
 
-    // Write the data
+    // Write the data, as one datagram
     if (errnoLocal == U_SOCK_ENONE) {
-        int32_t shortRangeEC = uShortRangeEdmStreamWrite(pInstance->streamHandle,
-                                                         pSock->edmChannel,
-                                                         pData, dataSizeBytes,
-                                                         U_WIFI_SOCK_WRITE_TIMEOUT_MS);
+        int32_t shortRangeEC = uShortRangeEdmStreamWritev(pInstance->streamHandle,
+                                                          pSock->edmChannel,
+                                                          pIoVec, ioVecCount,
+                                                          U_WIFI_SOCK_WRITE_TIMEOUT_MS);
         if (shortRangeEC >= 0) {
             errnoLocal = shortRangeEC;
         } else {
@@ -1297,15 +1696,20 @@ int32_t uWifiSockReceiveFrom(uDeviceHandle_t devHandle,
                              void *pData, size_t dataSizeBytes)
 {
     int32_t errnoLocal;
-    uShortRangePrivateInstance_t *pInstance = NULL;
     uWifiSockSocket_t *pSock = NULL;
+    uShortRangePbufList_t *pList;
 
-    if (uShortRangeLock() != (int32_t) U_ERROR_COMMON_SUCCESS) {
-        return -U_SOCK_EIO;
+    // As for uWifiSockRead(), only the lock on the received data
+    // of the socket is needed
+    errnoLocal = -U_SOCK_EFAULT;
+    if (gInitialised) {
+        errnoLocal = -U_SOCK_EBADFD;
+        pSock = pLockSocketRx(devHandle, sockHandle);
+        if (pSock != NULL) {
+            errnoLocal = U_SOCK_ENONE;
+        }
     }
 
-    errnoLocal = getInstanceAndSocket(devHandle, sockHandle, &pInstance, &pSock);
-
     if ((errnoLocal == U_SOCK_ENONE) && (pSock->connHandle < 0)) {
         // uWifiSockSendTo must have been called first in order to setup the peer
         errnoLocal = -U_SOCK_EUNATCH;
@@ -1318,27 +1722,140 @@ int32_t uWifiSockReceiveFrom(uDeviceHandle_t devHandle,
 
     // Read the data
     if (errnoLocal == U_SOCK_ENONE) {
+        errnoLocal = -U_SOCK_EWOULDBLOCK;
+        if (pData != NULL) {
+            pList = pUdpQueuePop(pSock, pRemoteAddress);
+            if (pList != NULL) {
+                errnoLocal = (int32_t) uShortRangePbufListConsumeData(pList, (char *)pData,
+                                                                      dataSizeBytes);
+                if (pList->totalLen > 0) {
+                    // The rest of the datagram is thrown away
+                    errnoLocal = -U_SOCK_EMSGSIZE;
+                }
+                uShortRangePbufListFree(pList);
+            }
+        }
+    }
 
-        errnoLocal = uShortRangePktListConsumePacket(&pSock->udpPktList, (char *)pData, &dataSizeBytes,
-                                                     NULL);
+    if (pSock != NULL) {
+        uPortMutexUnlock(pSock->rxMutex);
+    }
 
-        if ((errnoLocal == (int32_t)U_ERROR_COMMON_NO_MEMORY) ||
-            (errnoLocal == (int32_t)U_ERROR_COMMON_INVALID_PARAMETER)) {
-            errnoLocal = -U_SOCK_EWOULDBLOCK;
-        } else if (errnoLocal == (int32_t)U_ERROR_COMMON_TEMPORARY_FAILURE) {
-            errnoLocal = -U_SOCK_EMSGSIZE;
-        } else if (errnoLocal == (int32_t)U_ERROR_COMMON_SUCCESS) {
-            errnoLocal = (int32_t)dataSizeBytes;
+    return errnoLocal;
+}
+
+int32_t uWifiSockReceiveFromNoCopy(uDeviceHandle_t devHandle,
+                                   int32_t sockHandle,
+                                   uSockAddress_t *pRemoteAddress,
+                                   uSockIoVec_t *pIoVec,
+                                   size_t *pIoVecCount)
+{
+    int32_t errnoLocal;
+    uWifiSockSocket_t *pSock = NULL;
+    uShortRangePbufList_t *pList;
+    size_t count = 0;
+
+    // As for uWifiSockReceiveFrom(), only the lock on the received
+    // data of the socket is needed
+    errnoLocal = -U_SOCK_EFAULT;
+    if (gInitialised) {
+        errnoLocal = -U_SOCK_EBADFD;
+        pSock = pLockSocketRx(devHandle, sockHandle);
+        if (pSock != NULL) {
+            errnoLocal = U_SOCK_ENONE;
         }
+    }
+
+    if ((errnoLocal == U_SOCK_ENONE) && (pSock->connHandle < 0)) {
+        // uWifiSockSendTo must have been called first in order to setup the peer
+        errnoLocal = -U_SOCK_EUNATCH;
+    }
+
+    if ((errnoLocal == U_SOCK_ENONE) && (pSock->protocol != U_SOCK_PROTOCOL_UDP)) {
+        errnoLocal = -U_SOCK_EOPNOTSUPP;
+    }
 
-        if (pRemoteAddress) {
-            // At the moment we only receive packets from the address from first
-            // call to uWifiSockSendTo()
-            *pRemoteAddress = pSock->remoteAddress;
+    if ((errnoLocal == U_SOCK_ENONE) && ((pIoVec == NULL) || (pIoVecCount == NULL))) {
+        errnoLocal = -U_SOCK_EINVAL;
+    }
+
+    if (errnoLocal == U_SOCK_ENONE) {
+        // Whatever was lent last time is implicitly given back
+        uShortRangePbufListFree(pSock->pUdpLent);
+        pSock->pUdpLent = NULL;
+        errnoLocal = -U_SOCK_EWOULDBLOCK;
+        if (pSock->udpQueueCount > 0) {
+            // Check that the spans will fit before taking the
+            // datagram off the queue
+            pList = pSock->udpQueue[pSock->udpQueueRead].pBufList;
+            for (uShortRangePbuf_t *pBuf = pList->pBufHead; pBuf != NULL; pBuf = pBuf->pNext) {
+                count++;
+            }
+            if (count > *pIoVecCount) {
+                errnoLocal = -U_SOCK_EMSGSIZE;
+            } else {
+                pList = pUdpQueuePop(pSock, pRemoteAddress);
+                count = 0;
+                for (uShortRangePbuf_t *pBuf = pList->pBufHead; pBuf != NULL; pBuf = pBuf->pNext) {
+                    pIoVec[count].pData = pBuf->data;
+                    pIoVec[count].dataSizeBytes = pBuf->length;
+                    count++;
+                }
+                pSock->pUdpLent = pList;
+                errnoLocal = (int32_t) pList->totalLen;
+            }
+            *pIoVecCount = count;
         }
     }
 
-    uShortRangeUnlock();
+    if (pSock != NULL) {
+        uPortMutexUnlock(pSock->rxMutex);
+    }
+
+    return errnoLocal;
+}
+
+int32_t uWifiSockReceiveFromNoCopyRelease(uDeviceHandle_t devHandle,
+                                          int32_t sockHandle)
+{
+    int32_t errnoLocal = -U_SOCK_EFAULT;
+    uWifiSockSocket_t *pSock;
+
+    if (gInitialised) {
+        errnoLocal = -U_SOCK_EBADFD;
+        pSock = pLockSocketRx(devHandle, sockHandle);
+        if (pSock != NULL) {
+            uShortRangePbufListFree(pSock->pUdpLent);
+            pSock->pUdpLent = NULL;
+            errnoLocal = U_SOCK_ENONE;
+            uPortMutexUnlock(pSock->rxMutex);
+        }
+    }
+
+    return errnoLocal;
+}
+
+int32_t uWifiSockUdpQueueStatsGet(uDeviceHandle_t devHandle,
+                                  int32_t sockHandle,
+                                  uWifiSockUdpQueueStats_t *pStats)
+{
+    int32_t errnoLocal = -U_SOCK_EFAULT;
+    uWifiSockSocket_t *pSock;
+
+    if (gInitialised) {
+        errnoLocal = -U_SOCK_EINVAL;
+        if (pStats != NULL) {
+            errnoLocal = -U_SOCK_EBADFD;
+            pSock = pLockSocketRx(devHandle, sockHandle);
+            if (pSock != NULL) {
+                pStats->numDatagramsQueued = pSock->udpQueueCount;
+                pStats->numDatagramsDropped = pSock->udpDatagramsDropped;
+                pStats->numBytesDropped = pSock->udpBytesDropped;
+                errnoLocal = U_SOCK_ENONE;
+                uPortMutexUnlock(pSock->rxMutex);
+            }
+        }
+    }
 
     return errnoLocal;
 }
@@ -382,6 +382,59 @@ static void disconnectWifi()
     TEST_CHECK_TRUE(tmp == 0);
 }
 
+#if U_WIFI_SOCK_TCP_COALESCE_MS > 0
+
+// Write data to the TCP socket in chunks of the given size, each of
+// which should be taken whole.
+static void tcpWriteChunks(const char *pData, size_t size, size_t chunkSize)
+{
+    int32_t returnCode;
+    size_t bytesWritten = 0;
+    size_t bytesToWrite;
+
+    while ((bytesWritten < size) && !TEST_HAS_ERROR()) {
+        bytesToWrite = size - bytesWritten;
+        if (bytesToWrite > chunkSize) {
+            bytesToWrite = chunkSize;
+        }
+        returnCode = uWifiSockWrite(gHandles.devHandle, gSockHandleTcp,
+                                    pData + bytesWritten, bytesToWrite);
+        if (returnCode != (int32_t) bytesToWrite) {
+            U_TEST_PRINT_LINE("uWifiSockWrite() of %d byte(s) returned: %d.",
+                              bytesToWrite, returnCode);
+            TEST_CHECK_TRUE(false);
+        } else {
+            bytesWritten += returnCode;
+        }
+    }
+}
+
+// Read the given amount of data back from the TCP socket.
+static void tcpReadAll(char *pBuffer, size_t size)
+{
+    int32_t returnCode;
+    size_t bytesRead = 0;
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    while ((bytesRead < size) && !TEST_HAS_ERROR() &&
+           (uPortGetTickTimeMs() - startTimeMs < 10000)) {
+        returnCode = uWifiSockRead(gHandles.devHandle, gSockHandleTcp,
+                                   pBuffer + bytesRead, size - bytesRead);
+        if (returnCode > 0) {
+            bytesRead += returnCode;
+        } else if (returnCode == 0) {
+            uPortTaskBlock(100);
+        } else {
+            U_TEST_PRINT_LINE("uWifiSockRead() returned: %d.", returnCode);
+            TEST_CHECK_TRUE(false);
+        }
+    }
+    U_TEST_PRINT_LINE("%d byte(s) of %d echoed over TCP.", bytesRead, size);
+    TEST_CHECK_TRUE(bytesRead == size);
+}
+
+#endif // #if U_WIFI_SOCK_TCP_COALESCE_MS > 0
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -737,6 +790,62 @@ U_PORT_TEST_FUNCTION("[wifiSock]", "wifiSockUDPTest")
                                sizeof(gAllChars)) == 0);
     }
 
+    if (!TEST_HAS_ERROR()) {
+        // Do the same again but receive without a copy
+        uSockIoVec_t ioVec[4];
+        size_t ioVecCount = 0;
+        size_t offset = 0;
+        uWifiSockUdpQueueStats_t stats;
+        U_TEST_PRINT_LINE("sending %d byte(s) again, receiving with no copy...",
+                          sizeof(gAllChars));
+        for (size_t x = 0; !TEST_HAS_ERROR() && (x < U_SOCK_TEST_UDP_RETRIES); x ++) {
+            gDataCallbackCalledUdp = false;
+            returnCode = uWifiSockSendTo(gHandles.devHandle, gSockHandleUdp,
+                                         &remoteAddress,
+                                         gAllChars, sizeof(gAllChars));
+            if (returnCode != sizeof(gAllChars)) {
+                U_TEST_PRINT_LINE("failed to send UDP data on try %d.", x + 1);
+                continue;
+            }
+            for (size_t a = 100; (a > 0) && !gDataCallbackCalledUdp; a--) {
+                uPortTaskBlock(100);
+            }
+            ioVecCount = sizeof(ioVec) / sizeof(ioVec[0]);
+            returnCode = uWifiSockReceiveFromNoCopy(gHandles.devHandle,
+                                                    gSockHandleUdp,
+                                                    &rxAddress,
+                                                    ioVec, &ioVecCount);
+            if (returnCode != sizeof(gAllChars)) {
+                U_TEST_PRINT_LINE("failed to receive UDP echo on try %d.", x + 1);
+                continue;
+            }
+            break;
+        }
+        U_TEST_PRINT_LINE("%d byte(s) echoed over UDP in %d span(s).",
+                          returnCode, ioVecCount);
+        TEST_CHECK_TRUE(returnCode == sizeof(gAllChars));
+        if (returnCode == sizeof(gAllChars)) {
+            TEST_CHECK_TRUE((ioVecCount > 0) && (ioVecCount <= sizeof(ioVec) / sizeof(ioVec[0])));
+            for (size_t x = 0; x < ioVecCount; x++) {
+                TEST_CHECK_TRUE(offset + ioVec[x].dataSizeBytes <= sizeof(gAllChars));
+                if (offset + ioVec[x].dataSizeBytes <= sizeof(gAllChars)) {
+                    TEST_CHECK_TRUE(memcmp(ioVec[x].pData, gAllChars + offset,
+                                           ioVec[x].dataSizeBytes) == 0);
+                }
+                offset += ioVec[x].dataSizeBytes;
+            }
+            TEST_CHECK_TRUE(offset == sizeof(gAllChars));
+        }
+        TEST_CHECK_TRUE(uWifiSockReceiveFromNoCopyRelease(gHandles.devHandle,
+                                                          gSockHandleUdp) == 0);
+        TEST_CHECK_TRUE(uWifiSockUdpQueueStatsGet(gHandles.devHandle, gSockHandleUdp,
+                                                  &stats) == 0);
+        U_TEST_PRINT_LINE("%d datagram(s) queued, %d (%d byte(s)) dropped.",
+                          stats.numDatagramsQueued, stats.numDatagramsDropped,
+                          stats.numBytesDropped);
+        TEST_CHECK_TRUE(stats.numDatagramsQueued <= U_WIFI_SOCK_UDP_QUEUE_DEPTH);
+    }
+
     if (!TEST_HAS_ERROR()) {
         // Socket should still be open
         TEST_CHECK_TRUE(!gClosedCallbackCalledUdp);
@@ -803,6 +912,188 @@ U_PORT_TEST_FUNCTION("[wifiSock]", "wifiSockUDPTest")
 #endif
 }
 
+#if U_WIFI_SOCK_TCP_COALESCE_MS > 0
+/** Test the coalescing of small TCP writes: many small writes are
+ * each taken whole and arrive in order, setting U_SOCK_OPT_TCP_NODELAY
+ * sends what has been coalesced ahead of the next write and closing a
+ * socket with coalesced data pending frees it.
+ */
+U_PORT_TEST_FUNCTION("[wifiSock]", "wifiSockTcpCoalesce")
+{
+    int32_t heapUsed;
+    char *pBuffer;
+    int32_t returnCode;
+    int32_t noDelay;
+    size_t length;
+    uSockAddress_t remoteAddress;
+
+    TEST_CLEAR_ERROR();
+    gDataCallbackCalledTcp = false;
+    gClosedCallbackCalledTcp = false;
+    gAsyncClosedCallbackCalledTcp = false;
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    gWifiStatusMask = 0;
+    gWifiConnected = 0;
+
+    // Malloc a buffer to receive things into.
+    pBuffer = (char *) pUPortMalloc(U_WIFI_SOCK_MAX_SEGMENT_SIZE_BYTES);
+    U_PORT_TEST_ASSERT(pBuffer != NULL);
+
+    // Do the standard preamble
+    returnCode = uWifiTestPrivatePreamble((uWifiModuleType_t) U_CFG_TEST_SHORT_RANGE_MODULE_TYPE,
+                                          &uart,
+                                          &gHandles);
+    TEST_CHECK_TRUE(returnCode == 0);
+
+    // Connect to Wifi AP
+    if (!TEST_HAS_ERROR()) {
+        connectWifi();
+    }
+
+    // Init wifi sockets
+    if (!TEST_HAS_ERROR() && (0 != uWifiSockInit())) {
+        U_TEST_PRINT_LINE("unable to init socket.");
+        TEST_CHECK_TRUE(false);
+    }
+
+    if (!TEST_HAS_ERROR() && (0 != uWifiSockInitInstance(gHandles.devHandle))) {
+        U_TEST_PRINT_LINE("unable to init socket instance.");
+        TEST_CHECK_TRUE(false);
+    }
+
+    // Create a TCP socket and connect it to the echo server
+    if (!TEST_HAS_ERROR()) {
+        gSockHandleTcp = uWifiSockCreate(gHandles.devHandle, U_SOCK_TYPE_STREAM,
+                                         U_SOCK_PROTOCOL_TCP);
+        if (gSockHandleTcp < 0) {
+            U_TEST_PRINT_LINE("unable to create socket, return code: %d.", gSockHandleTcp);
+            TEST_CHECK_TRUE(false);
+        }
+    }
+    if (!TEST_HAS_ERROR()) {
+        uWifiSockRegisterCallbackData(gHandles.devHandle, gSockHandleTcp,
+                                      dataCallbackTcp);
+        uWifiSockRegisterCallbackClosed(gHandles.devHandle, gSockHandleTcp,
+                                        closedCallbackTcp);
+        returnCode = uWifiSockGetHostByName(gHandles.devHandle,
+                                            U_SOCK_TEST_ECHO_TCP_SERVER_DOMAIN_NAME,
+                                            &remoteAddress.ipAddress);
+        remoteAddress.port = U_SOCK_TEST_ECHO_TCP_SERVER_PORT;
+        TEST_CHECK_TRUE(returnCode == 0);
+    }
+    if (!TEST_HAS_ERROR()) {
+        returnCode = uWifiSockConnect(gHandles.devHandle, gSockHandleTcp, &remoteAddress);
+        if (returnCode != 0) {
+            U_TEST_PRINT_LINE("unable to connect socket, return code: %d.", returnCode);
+            TEST_CHECK_TRUE(false);
+        }
+    }
+
+    if (!TEST_HAS_ERROR()) {
+        // Small writes are gathered up, and counted as sent, so
+        // each should be taken whole straight away
+        U_TEST_PRINT_LINE("sending %d byte(s) in 8 byte chunks, coalesced...",
+                          sizeof(gAllChars));
+        tcpWriteChunks(gAllChars, sizeof(gAllChars), 8);
+        //lint -e{668} suppress Possibly passing a null pointer to function memset - we are not!
+        memset(pBuffer, 0, U_WIFI_SOCK_MAX_SEGMENT_SIZE_BYTES);
+        tcpReadAll(pBuffer, sizeof(gAllChars));
+        TEST_CHECK_TRUE(memcmp(pBuffer, gAllChars, sizeof(gAllChars)) == 0);
+    }
+
+    if (!TEST_HAS_ERROR()) {
+        // Leave a little data coalesced, then opt out: the
+        // coalesced data must go out ahead of the next write
+        U_TEST_PRINT_LINE("sending with U_SOCK_OPT_TCP_NODELAY set...");
+        tcpWriteChunks(gAllChars, 10, 10);
+        noDelay = 1;
+        returnCode = uWifiSockOptionSet(gHandles.devHandle, gSockHandleTcp,
+                                        U_SOCK_OPT_LEVEL_TCP, U_SOCK_OPT_TCP_NODELAY,
+                                        (void *) &noDelay, sizeof(noDelay));
+        TEST_CHECK_TRUE(returnCode == 0);
+        noDelay = 0;
+        length = sizeof(noDelay);
+        returnCode = uWifiSockOptionGet(gHandles.devHandle, gSockHandleTcp,
+                                        U_SOCK_OPT_LEVEL_TCP, U_SOCK_OPT_TCP_NODELAY,
+                                        (void *) &noDelay, &length);
+        TEST_CHECK_TRUE((returnCode == 0) && (noDelay == 1));
+        tcpWriteChunks(gAllChars + 10, sizeof(gAllChars) - 10, 8);
+        memset(pBuffer, 0, U_WIFI_SOCK_MAX_SEGMENT_SIZE_BYTES);
+        tcpReadAll(pBuffer, sizeof(gAllChars));
+        TEST_CHECK_TRUE(memcmp(pBuffer, gAllChars, sizeof(gAllChars)) == 0);
+    }
+
+    if (!TEST_HAS_ERROR()) {
+        // Opt back in and leave some data coalesced for the close
+        noDelay = 0;
+        returnCode = uWifiSockOptionSet(gHandles.devHandle, gSockHandleTcp,
+                                        U_SOCK_OPT_LEVEL_TCP, U_SOCK_OPT_TCP_NODELAY,
+                                        (void *) &noDelay, sizeof(noDelay));
+        TEST_CHECK_TRUE(returnCode == 0);
+        tcpWriteChunks(gAllChars, 10, 10);
+    }
+
+    // Close the TCP socket, with the data still pending
+    U_TEST_PRINT_LINE("closing socket with coalesced data pending...");
+    returnCode = uWifiSockClose(gHandles.devHandle, gSockHandleTcp,
+                                &asyncClosedCallbackTcp);
+    if (!TEST_HAS_ERROR()) {
+        if (returnCode != 0) {
+            U_TEST_PRINT_LINE("unable to close socket, return code: %d.", returnCode);
+            TEST_CHECK_TRUE(false);
+        }
+    }
+
+    //Socket cleanup
+    uWifiSockRegisterCallbackData(gHandles.devHandle, gSockHandleTcp,
+                                  NULL);
+    uWifiSockRegisterCallbackClosed(gHandles.devHandle, gSockHandleTcp,
+                                    NULL);
+
+    if (uWifiSockDeinitInstance(gHandles.devHandle) != 0) {
+        U_TEST_PRINT_LINE("unable to deinit socket instance.");
+        TEST_CHECK_TRUE(false);
+    }
+    // Deinit wifi sockets
+    uWifiSockDeinit();
+
+    // Cleanup
+    disconnectWifi();
+    uWifiTestPrivatePostamble(&gHandles);
+
+    // Free memory
+    uPortFree(pBuffer);
+
+    // Now do all assert checking after cleanup
+
+    if (TEST_HAS_ERROR()) {
+        U_TEST_PRINT_LINE(__FILE__ ":%d:FAIL", TEST_GET_ERROR_LINE());
+        U_PORT_TEST_ASSERT(false);
+    }
+
+    U_PORT_TEST_ASSERT_EQUAL(gCallbackErrorNum, 0);
+    U_PORT_TEST_ASSERT(gClosedCallbackCalledTcp);
+
+#ifndef __XTENSA__
+    // Check for memory leaks, which would include the
+    // coalescing buffer not being freed on close
+    // TODO: this if'ed out for ESP32 (xtensa compiler) at
+    // the moment as there is an issue with ESP32 hanging
+    // on to memory in the UART drivers that can't easily be
+    // accounted for.
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+#else
+    (void) heapUsed;
+#endif
+}
+#endif // #if U_WIFI_SOCK_TCP_COALESCE_MS > 0
 
 #endif // U_SHORT_RANGE_TEST_WIFI()
 
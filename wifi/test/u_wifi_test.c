@@ -171,12 +171,18 @@ static void wifiNetworkStatusCallback(uDeviceHandle_t devHandle,
 }
 
 
-static uWifiTestError_t runWifiTest(const char *pSsid, const char *pPassPhrase)
+// Connect, using pFastConnect if not NULL, wait for the network to
+// come up, store the connection parameters in pFastConnectStore if
+// not NULL and then disconnect.
+static uWifiTestError_t runWifiTest(const char *pSsid, const char *pPassPhrase,
+                                    const uWifiStationFastConnect_t *pFastConnect,
+                                    uWifiStationFastConnect_t *pFastConnectStore)
 {
     uWifiTestError_t testError = U_WIFI_TEST_ERROR_NONE;
     uWifiTestError_t connectError = U_WIFI_TEST_ERROR_NONE;
     uWifiTestError_t disconnectError = U_WIFI_TEST_ERROR_NONE;
     int32_t waitCtr = 0;
+    int32_t startTimeMs;
     gWifiStatusMask = 0;
     gWifiConnected = 0;
     gWifiDisconnected = 0;
@@ -196,10 +202,12 @@ static uWifiTestError_t runWifiTest(const char *pSsid, const char *pPassPhrase)
         uWifiSetNetworkStatusCallback(gHandles.devHandle,
                                       wifiNetworkStatusCallback, NULL);
         // Connect to wifi network
-        int32_t res = uWifiStationConnect(gHandles.devHandle,
-                                          pSsid,
-                                          U_WIFI_AUTH_WPA_PSK,
-                                          pPassPhrase);
+        startTimeMs = uPortGetTickTimeMs();
+        int32_t res = uWifiStationConnectFast(gHandles.devHandle,
+                                              pSsid,
+                                              U_WIFI_AUTH_WPA_PSK,
+                                              pPassPhrase,
+                                              pFastConnect);
         if (res == 0) {
             //Wait for connection and IP events.
             //There could be multiple IP events depending on network configuration.
@@ -218,6 +226,16 @@ static uWifiTestError_t runWifiTest(const char *pSsid, const char *pPassPhrase)
                 uPortTaskBlock(1000);
                 waitCtr++;
             }
+            if (!connectError) {
+                U_TEST_PRINT_LINE("connected in %d ms%s.",
+                                  uPortGetTickTimeMs() - startTimeMs,
+                                  (pFastConnect != NULL) ? " using fast connect" : "");
+                if ((pFastConnectStore != NULL) &&
+                    (uWifiStationFastConnectGet(gHandles.devHandle, pFastConnectStore) != 0)) {
+                    U_TEST_PRINT_LINE("unable to get the connection parameters.");
+                    connectError = U_WIFI_TEST_ERROR_IPRECV;
+                }
+            }
         } else {
             connectError = U_WIFI_TEST_ERROR_CONNECT;
         }
@@ -435,17 +453,42 @@ U_PORT_TEST_FUNCTION("[wifi]", "wifiNetworkInitialisation")
 U_PORT_TEST_FUNCTION("[wifi]", "wifiStationConnect")
 {
     uWifiTestError_t testError = runWifiTest(U_PORT_STRINGIFY_QUOTED(U_WIFI_TEST_CFG_SSID),
-                                             U_PORT_STRINGIFY_QUOTED(U_WIFI_TEST_CFG_WPA2_PASSPHRASE));
+                                             U_PORT_STRINGIFY_QUOTED(U_WIFI_TEST_CFG_WPA2_PASSPHRASE),
+                                             NULL, NULL);
     // Handle errors
     U_PORT_TEST_ASSERT(testError == U_WIFI_TEST_ERROR_NONE);
 }
 
+U_PORT_TEST_FUNCTION("[wifi]", "wifiStationConnectFast")
+{
+    uWifiStationFastConnect_t fastConnect;
+
+    // Connect normally, keeping the parameters of the connection
+    uWifiTestError_t testError = runWifiTest(U_PORT_STRINGIFY_QUOTED(U_WIFI_TEST_CFG_SSID),
+                                             U_PORT_STRINGIFY_QUOTED(U_WIFI_TEST_CFG_WPA2_PASSPHRASE),
+                                             NULL, &fastConnect);
+    U_PORT_TEST_ASSERT(testError == U_WIFI_TEST_ERROR_NONE);
+    U_TEST_PRINT_LINE("BSSID %s, channel %d, IP address %s, mask %s, gateway %s.",
+                      fastConnect.bssid, fastConnect.channel,
+                      fastConnect.ipV4Address, fastConnect.subnetMask,
+                      fastConnect.gateway);
+    U_PORT_TEST_ASSERT(fastConnect.ipV4Address[0] != '\0');
+    U_PORT_TEST_ASSERT(fastConnect.channel > 0);
+
+    // Connect again using them
+    testError = runWifiTest(U_PORT_STRINGIFY_QUOTED(U_WIFI_TEST_CFG_SSID),
+                            U_PORT_STRINGIFY_QUOTED(U_WIFI_TEST_CFG_WPA2_PASSPHRASE),
+                            &fastConnect, NULL);
+    U_PORT_TEST_ASSERT(testError == U_WIFI_TEST_ERROR_NONE);
+}
+
 U_PORT_TEST_FUNCTION("[wifi]", "wifiStationConnectWrongSSID")
 {
     gLookForDisconnectReasonBitMask = (1 << U_WIFI_REASON_OUT_OF_RANGE); // (cant find SSID)
     gDisconnectReasonFound = 0;
     uWifiTestError_t testError = runWifiTest("DUMMYSSID",
-                                             U_PORT_STRINGIFY_QUOTED(U_WIFI_TEST_CFG_WPA2_PASSPHRASE));
+                                             U_PORT_STRINGIFY_QUOTED(U_WIFI_TEST_CFG_WPA2_PASSPHRASE),
+                                             NULL, NULL);
 
     // Handle errors
     U_PORT_TEST_ASSERT(testError == U_WIFI_TEST_ERROR_CONNECTED);
@@ -460,7 +503,7 @@ U_PORT_TEST_FUNCTION("[wifi]", "wifiStationConnectWrongPassphrase")
                                       (1 << U_WIFI_REASON_SECURITY_PROBLEM);
     gDisconnectReasonFound = 0;
     uWifiTestError_t testError = runWifiTest(U_PORT_STRINGIFY_QUOTED(U_WIFI_TEST_CFG_SSID),
-                                             "WRONGPASSWD");
+                                             "WRONGPASSWD", NULL, NULL);
     // Handle errors
     U_PORT_TEST_ASSERT(testError == U_WIFI_TEST_ERROR_CONNECTED);
     U_PORT_TEST_ASSERT(gDisconnectReasonFound);
@@ -501,6 +544,44 @@ U_PORT_TEST_FUNCTION("[wifi]", "wifiScan")
     // Basic validation of the result
     U_PORT_TEST_ASSERT(validateScanResult(&gScanResult));
 
+    //----------------------------------------------------------
+    // Find the AP again in the scan cache, and check the filter
+    //----------------------------------------------------------
+    {
+        uWifiScanFilter_t filter = U_WIFI_SCAN_FILTER_DEFAULT;
+        const char *pSsid = U_PORT_STRINGIFY_QUOTED(U_WIFI_TEST_CFG_SSID);
+        int32_t channel = gScanResult.channel;
+        uWifiScanResult_t cached[U_WIFI_SCAN_CACHE_MAX_NUM_RESULTS];
+        int32_t ageMs = -1;
+
+        // Everything, strongest first
+        result = uWifiStationScanCacheGet(gHandles.devHandle, NULL, cached,
+                                          sizeof(cached) / sizeof(cached[0]), &ageMs);
+        U_TEST_PRINT_LINE("%d result(s) in the scan cache, %d ms old.", result, ageMs);
+        U_PORT_TEST_ASSERT(result > 0);
+        U_PORT_TEST_ASSERT(ageMs >= 0);
+        for (int32_t i = 1; i < result; i++) {
+            U_PORT_TEST_ASSERT(cached[i].rssi <= cached[i - 1].rssi);
+        }
+        // Just the test AP
+        filter.ppSsid = &pSsid;
+        filter.numSsids = 1;
+        filter.pChannels = &channel;
+        filter.numChannels = 1;
+        result = uWifiStationScanCacheGet(gHandles.devHandle, &filter, cached,
+                                          sizeof(cached) / sizeof(cached[0]), NULL);
+        U_PORT_TEST_ASSERT(result > 0);
+        for (int32_t i = 0; i < result; i++) {
+            U_PORT_TEST_ASSERT(strcmp(cached[i].ssid, pSsid) == 0);
+            U_PORT_TEST_ASSERT(cached[i].channel == channel);
+        }
+        // Nothing can be stronger than 0 dBm
+        filter.rssiMinDbm = 1;
+        result = uWifiStationScanCacheGet(gHandles.devHandle, &filter, cached,
+                                          sizeof(cached) / sizeof(cached[0]), NULL);
+        U_PORT_TEST_ASSERT(result == 0);
+    }
+
     //----------------------------------------------------------
     // Scan specifically for U_WIFI_TEST_CFG_SSID
     //----------------------------------------------------------